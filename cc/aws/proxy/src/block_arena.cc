@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/block_arena.h"
+
+#include <stdint.h>
+#include <sys/mman.h>
+
+namespace google::scp::proxy {
+
+BlockArena::BlockArena(size_t block_size)
+    : block_size_(block_size), mapped_bytes_(0), huge_page_bytes_(0) {}
+
+BlockArena::~BlockArena() {
+  for (void* chunk : chunks_) {
+    munmap(chunk, kChunkSize);
+  }
+}
+
+void* BlockArena::Allocate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (next_ == end_ && !MapChunk()) {
+    return nullptr;
+  }
+  void* block = next_;
+  next_ += block_size_;
+  return block;
+}
+
+bool BlockArena::MapChunk() {
+  void* chunk = mmap(nullptr, kChunkSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (chunk != MAP_FAILED) {
+    huge_page_bytes_ += kChunkSize;
+  } else {
+    // No huge page reserved. Map twice the size to align the chunk, so that
+    // the kernel can back it with a transparent huge page.
+    void* mapped = mmap(nullptr, 2 * kChunkSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+      return false;
+    }
+    auto start = reinterpret_cast<uintptr_t>(mapped);
+    auto aligned = (start + kChunkSize - 1) & ~(kChunkSize - 1);
+    if (aligned > start) {
+      munmap(mapped, aligned - start);
+    }
+    munmap(reinterpret_cast<void*>(aligned + kChunkSize),
+           start + kChunkSize - aligned);
+    chunk = reinterpret_cast<void*>(aligned);
+    madvise(chunk, kChunkSize, MADV_HUGEPAGE);
+  }
+  chunks_.push_back(chunk);
+  mapped_bytes_ += kChunkSize;
+  next_ = static_cast<char*>(chunk);
+  end_ = next_ + kChunkSize;
+  return true;
+}
+}  // namespace google::scp::proxy
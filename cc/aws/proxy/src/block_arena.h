@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCK_ARENA_H_
+#define BLOCK_ARENA_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace google::scp::proxy {
+// BlockArena carves fixed-size blocks out of large chunks of memory, backed by
+// huge pages where the system has them reserved, or by transparent huge pages
+// otherwise. This keeps the blocks of many buffers on a few TLB entries.
+// Blocks are aligned to their size, and are never given back individually;
+// all the chunks are unmapped when the arena is destroyed.
+class BlockArena {
+ public:
+  // The size of the chunks, that of a huge page on x86-64 and aarch64.
+  static constexpr size_t kChunkSize = 2 * 1024 * 1024;
+
+  // block_size must be a power of 2 no bigger than kChunkSize.
+  explicit BlockArena(size_t block_size);
+  ~BlockArena();
+
+  BlockArena(const BlockArena&) = delete;
+  BlockArena& operator=(const BlockArena&) = delete;
+
+  // Get a new block, or nullptr if out of memory. Thread-safe.
+  void* Allocate();
+
+  // The bytes mapped in total, and those of them on reserved huge pages.
+  size_t mapped_bytes() const { return mapped_bytes_.load(); }
+
+  size_t huge_page_bytes() const { return huge_page_bytes_.load(); }
+
+ private:
+  bool MapChunk();
+
+  const size_t block_size_;
+  std::mutex mutex_;
+  std::vector<void*> chunks_;
+  // The unused space of the last chunk.
+  char* next_ = nullptr;
+  char* end_ = nullptr;
+  std::atomic<size_t> mapped_bytes_;
+  std::atomic<size_t> huge_page_bytes_;
+};
+}  // namespace google::scp::proxy
+
+#endif  // BLOCK_ARENA_H_
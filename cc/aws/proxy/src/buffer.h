@@ -70,8 +70,8 @@ class BasicBuffer {
  public:
   static constexpr size_t kBlockSize = BlockSize;
 
-  // The basic node of the internal singly linked list.
-  // TODO: add memory alignment options.
+  // The basic node of the internal singly linked list. Blocks are aligned to
+  // kBlockSize, by posix_memalign() or by the arena of the freelist.
   struct Block {
     Block* next;    // Pointer to the next block.
     size_t offset;  // Start of the consumable data.
@@ -83,6 +83,8 @@ class BasicBuffer {
 
     Block() : next(nullptr), offset(0), len(0) {}
 
+    // Total size of each block, including the header.
+    static constexpr size_t size = kBlockSize;
     // Total capacity of each block for storing data.
     static constexpr size_t capacity = kBlockSize - sizeof(Block);
 
@@ -210,6 +212,26 @@ class BasicBuffer {
     return ReserveAtLeast<SysBufType>(reserve_size);
   }
 
+  // Like ReserveAtLeast(size&), but write the spaces into the array bufs of
+  // max_bufs elements, without allocating. Less than size is reserved if
+  // max_bufs is reached first. Returns the number of elements written.
+  template <class SysBufType>
+  size_t ReserveAtLeast(size_t& size, SysBufType* bufs, size_t max_bufs) {
+    assert(!reserved_);
+    reserved_ = true;
+    SpaceStepper stepper(*this);
+    size_t reserved_size = 0;
+    size_t num_bufs = 0;
+    while (reserved_size < size && num_bufs < max_bufs) {
+      Block* block = stepper.Next();
+      size_t space_len = block->SpaceLen();
+      bufs[num_bufs++] = MakeSysBuf<SysBufType>(block->SpaceHead(), space_len);
+      reserved_size += space_len;
+    }
+    size = reserved_size;
+    return num_bufs;
+  }
+
   // Commit the produced data with specified size.
   void Commit(size_t size) {
     assert(reserved_);
@@ -238,6 +260,21 @@ class BasicBuffer {
     return ret;
   }
 
+  // Like Peek(), but write the view into the array bufs of max_bufs elements,
+  // without allocating. Returns the number of elements written.
+  template <class SysBufType>
+  size_t Peek(SysBufType* bufs, size_t max_bufs) {
+    assert(!peeked_);
+    peeked_ = true;
+    size_t num_bufs = 0;
+    for (Block* b = head_; b != nullptr && b->DataLen() > 0 &&
+                           num_bufs < max_bufs;
+         b = b->next) {
+      bufs[num_bufs++] = MakeSysBuf<SysBufType>(b->DataHead(), b->DataLen());
+    }
+    return num_bufs;
+  }
+
   // Mark data of certain size as consumed, that's effectively, to "drain" from
   // the front of the buffer.
   void Drain(size_t size) {
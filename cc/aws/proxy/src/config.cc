@@ -31,6 +31,9 @@ Config Config::Parse(int argc, char* argv[]) {
     { "tcp", no_argument, 0, 't'},
     { "port", required_argument, 0, 'p'},
     { "buffer_size", required_argument, 0, 'b'},
+    { "io_uring", no_argument, 0, 'u'},
+    { "metrics_port", required_argument, 0, 'm'},
+    { "context_per_thread", no_argument, 0, 'c'},
     {0, 0, 0, 0}
   };
 
@@ -38,7 +41,7 @@ Config Config::Parse(int argc, char* argv[]) {
 
   while (true) {
     int opt_idx = 0;
-    int c = getopt_long(argc, argv, "tp:b:", long_options, &opt_idx);
+    int c = getopt_long(argc, argv, "tp:b:um:c", long_options, &opt_idx);
     if (c == -1) {
       break;
     }
@@ -50,6 +53,10 @@ Config Config::Parse(int argc, char* argv[]) {
         config.vsock_ = false;
         break;
       }
+      case 'u': {
+        config.io_uring_ = true;
+        break;
+      }
       case 'p': {
         char* endptr;
         std::string port_str(optarg);
@@ -61,6 +68,21 @@ Config Config::Parse(int argc, char* argv[]) {
         config.socks5_port_ = static_cast<uint16_t>(port);
         break;
       }
+      case 'c': {
+        config.context_per_thread_ = true;
+        break;
+      }
+      case 'm': {
+        char* endptr;
+        std::string port_str(optarg);
+        auto port = strtoul(port_str.c_str(), &endptr, 10);
+        if (port > UINT16_MAX) {
+          LogError("ERROR: Invalid metrics port number: ", port_str);
+          exit(1);
+        }
+        config.metrics_port_ = static_cast<uint16_t>(port);
+        break;
+      }
       case 'b': {
         char* endptr;
         std::string bs_str(optarg);
@@ -29,6 +29,9 @@ struct Config {
       : buffer_size_(kDefaultBufferSize),
         socks5_port_(kDefaultPort),
         vsock_(true),
+        io_uring_(false),
+        context_per_thread_(false),
+        metrics_port_(0),
         bad_(false) {}
 
   // Parse the command line arguments and get a Config object.
@@ -40,6 +43,15 @@ struct Config {
   uint16_t socks5_port_;
   // True if listen on vsock. Otherwise on TCP.
   bool vsock_;
+  // True if serve the connections with io_uring, where the kernel supports
+  // it. Otherwise on asio.
+  bool io_uring_;
+  // True if run one io_context per thread, handing each accepted connection
+  // to the one serving the fewest. Otherwise all threads share one.
+  bool context_per_thread_;
+  // Port that the metrics are served on, on the loopback interface. 0 if not
+  // served.
+  uint16_t metrics_port_;
   // If the config is bad.
   bool bad_;
 };
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dns_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+using boost::asio::ip::tcp;
+using boost::system::error_code;
+using std::lock_guard;
+using std::make_shared;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace google::scp::proxy {
+
+DnsCache::DnsCache(const Executor& executor, Clock::duration ttl,
+                   Clock::duration negative_ttl)
+    : executor_(executor),
+      ttl_(ttl),
+      negative_ttl_(negative_ttl),
+      stats_{0, 0, 0} {}
+
+void DnsCache::Resolve(const string& host, Callback callback) {
+  auto now = Clock::now();
+  unique_lock<std::mutex> lock(mutex_);
+  auto it = entries_.find(host);
+  if (it != entries_.end() && it->second.expiry > now) {
+    Entry& entry = it->second;
+    stats_.hits++;
+    if (!entry.resolving && !entry.ec && entry.expiry - now < ttl_ / 4) {
+      stats_.refreshes++;
+      StartResolving(host, entry);
+    }
+    error_code ec = entry.ec;
+    Endpoints endpoints = entry.endpoints;
+    lock.unlock();
+    callback(ec, endpoints);
+    return;
+  }
+  stats_.misses++;
+  if (it == entries_.end()) {
+    Evict(now);
+    it = entries_.emplace(host, Entry()).first;
+  }
+  Entry& entry = it->second;
+  entry.waiters.push_back(std::move(callback));
+  if (!entry.resolving) {
+    StartResolving(host, entry);
+  }
+}
+
+DnsCache::Stats DnsCache::GetStats() const {
+  lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void DnsCache::StartResolving(const string& host, Entry& entry) {
+  entry.resolving = true;
+  auto resolver = make_shared<tcp::resolver>(executor_);
+  resolver->async_resolve(
+      host, "",
+      [this, resolver, host](const error_code& ec,
+                             const tcp::resolver::results_type& results) {
+        ResolveHandler(host, ec, results);
+      });
+}
+
+void DnsCache::ResolveHandler(const string& host, const error_code& ec,
+                              const tcp::resolver::results_type& results) {
+  auto now = Clock::now();
+  unique_lock<std::mutex> lock(mutex_);
+  auto it = entries_.find(host);
+  if (it == entries_.end()) {
+    return;
+  }
+  Entry& entry = it->second;
+  entry.resolving = false;
+  if (!ec && !results.empty()) {
+    entry.ec = error_code();
+    entry.endpoints.clear();
+    for (const auto& result : results) {
+      auto endpoint = result.endpoint();
+      entry.endpoints.emplace_back(endpoint.data(), endpoint.size());
+    }
+    entry.expiry = now + ttl_;
+  } else if (entry.ec || entry.expiry <= now) {
+    // A failed refresh keeps the result until it expires.
+    entry.ec = ec ? ec : boost::asio::error::host_not_found;
+    entry.endpoints.clear();
+    entry.expiry = now + negative_ttl_;
+  }
+  auto waiters = std::move(entry.waiters);
+  entry.waiters.clear();
+  error_code result_ec = entry.ec;
+  Endpoints endpoints = entry.endpoints;
+  lock.unlock();
+  for (auto& waiter : waiters) {
+    waiter(result_ec, endpoints);
+  }
+}
+
+void DnsCache::Evict(Clock::time_point now) {
+  if (entries_.size() < kMaxEntries) {
+    return;
+  }
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (!it->second.resolving && it->second.expiry <= now) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Still full of live names, drop any of them.
+  for (auto it = entries_.begin();
+       entries_.size() >= kMaxEntries && it != entries_.end();) {
+    if (!it->second.resolving) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+}  // namespace google::scp::proxy
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "socket_types.h"
+
+namespace google::scp::proxy {
+// DnsCache resolves the domain names of SOCKS5 CONNECT requests, caching the
+// results, and the failures for a shorter time. getaddrinfo() does not tell
+// the TTLs of the records, so fixed TTLs are used instead. An entry looked up
+// in the last quarter of its TTL is refreshed in the background, while the
+// cached result is still served, so that names in use never expire.
+// Thread-safe. The resolutions run on the given executor, which must not run
+// after the cache is destroyed.
+class DnsCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+  // The resolved addresses, with port 0.
+  using Endpoints = std::vector<Endpoint>;
+  using Callback = std::function<void(const boost::system::error_code& ec,
+                                      const Endpoints& endpoints)>;
+
+  static constexpr Clock::duration kDefaultTtl = std::chrono::seconds(60);
+  static constexpr Clock::duration kDefaultNegativeTtl =
+      std::chrono::seconds(5);
+  // The max number of names cached.
+  static constexpr size_t kMaxEntries = 1024;
+
+  struct Stats {
+    // The lookups served from the cache, and those waiting for a resolution.
+    size_t hits;
+    size_t misses;
+    // The background resolutions of cached names.
+    size_t refreshes;
+  };
+
+  explicit DnsCache(const Executor& executor, Clock::duration ttl = kDefaultTtl,
+                    Clock::duration negative_ttl = kDefaultNegativeTtl);
+
+  // Resolve host, then call callback with the result. callback is called
+  // immediately if the result is cached, otherwise on the executor.
+  void Resolve(const std::string& host, Callback callback);
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    boost::system::error_code ec;
+    Endpoints endpoints;
+    // The time the result expires, default for no result yet.
+    Clock::time_point expiry;
+    bool resolving = false;
+    // The lookups waiting for the resolution.
+    std::vector<Callback> waiters;
+  };
+
+  // Start resolving the host of entry. Requires the lock.
+  void StartResolving(const std::string& host, Entry& entry);
+  void ResolveHandler(
+      const std::string& host, const boost::system::error_code& ec,
+      const boost::asio::ip::tcp::resolver::results_type& results);
+  // Make room for a new entry. Requires the lock.
+  void Evict(Clock::time_point now);
+
+  Executor executor_;
+  const Clock::duration ttl_;
+  const Clock::duration negative_ttl_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  Stats stats_;
+};
+}  // namespace google::scp::proxy
@@ -17,44 +17,92 @@
 #ifndef FREELIST_H_
 #define FREELIST_H_
 
+#include <stddef.h>
+
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include "block_arena.h"
 
 namespace google::scp::proxy {
 // A simple unbounded freelist. Requires T to contain a "next" pointer.
+// Each thread takes and gives back blocks through one of kNumCaches caches,
+// which exchange blocks with the shared pool in batches of kBatchSize, so that
+// threads rarely contend on the pool. New blocks are allocated only when no
+// free block is found in the pool or the caches. Blocks are allocated with
+// BlockType::Alloc(), or carved out of a BlockArena if the freelist is
+// constructed with one.
 template <typename T>
 class Freelist {
  public:
   using BlockType = std::remove_pointer_t<T>;
 
-  Freelist() : head_(nullptr), size_(0) {}
+  // The number of caches. Threads beyond that share them.
+  static constexpr size_t kNumCaches = 16;
+  // The number of blocks moved between a cache and the pool at a time.
+  static constexpr size_t kBatchSize = 32;
+
+  // Memory usage of the freelist.
+  struct Stats {
+    // The blocks allocated, in use or free.
+    size_t allocated_blocks;
+    // The blocks in the freelist.
+    size_t free_blocks;
+    // The bytes mapped by the arena, if any, and those on huge pages.
+    size_t arena_bytes;
+    size_t huge_page_bytes;
+  };
+
+  // With use_arena, the blocks are carved out of a huge-page backed arena,
+  // which requires BlockType::size, a power of 2. The memory is only released
+  // when the freelist is destroyed.
+  explicit Freelist(bool use_arena = false)
+      : pool_head_(nullptr), size_(0), allocated_(0) {
+    if (use_arena) {
+      arena_ = std::make_unique<BlockArena>(BlockType::size);
+    }
+  }
 
   ~Freelist() { Clear(); }
 
-  // Get a new object from the freelist. If none available, BlockType::Alloc()
-  // is called to allocate new block.
+  // Get a new object from the freelist. If none available, a new block is
+  // allocated.
   BlockType* New() {
-    BlockType* old_head = head_.load();
-    if (old_head == nullptr) {
-      return BlockType::Alloc();
+    Cache& cache = caches_[CacheIndex()];
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      if (cache.head == nullptr) {
+        Refill(cache);
+      }
+      if (cache.head == nullptr) {
+        Steal(cache);
+      }
+      if (cache.head != nullptr) {
+        BlockType* ret = cache.head;
+        cache.head = ret->next;
+        cache.count--;
+        size_--;
+        // Do initialization before returning.
+        return new (ret) BlockType();
+      }
     }
-    while (!head_.compare_exchange_weak(old_head, old_head->next,
-                                        std::memory_order_release,
-                                        std::memory_order_relaxed)) {}
-
-    BlockType* ret = old_head;
-    size_--;
-    // Do initialization before returning.
-    return new (ret) BlockType();
+    return Allocate();
   }
 
   // Dispose a block. The block is given back to the freelist.
   void Delete(BlockType* block) {
-    BlockType* new_head = block;
-    new_head->next = head_.load();
-    while (!head_.compare_exchange_weak(new_head->next, new_head,
-                                        std::memory_order_release,
-                                        std::memory_order_relaxed)) {}
+    Cache& cache = caches_[CacheIndex()];
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    block->next = cache.head;
+    cache.head = block;
+    cache.count++;
     size_++;
+    if (cache.count >= 2 * kBatchSize) {
+      Flush(cache, kBatchSize);
+    }
   }
 
   // Dispose a whole block chain. The blocks are given back to the freelist.
@@ -67,35 +115,148 @@ class Freelist {
     for (; tail->next != nullptr; tail = tail->next) {
       ++count;
     }
-    tail->next = head_;
-    BlockType* new_head = head;
-    while (!head_.compare_exchange_weak(tail->next, new_head,
-                                        std::memory_order_release,
-                                        std::memory_order_relaxed)) {}
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    tail->next = pool_head_;
+    pool_head_ = head;
     size_.fetch_add(count);
   }
 
   // Clear all the blocks saved.
   void Clear() {
-    while (head_.load() != nullptr) {
-      BlockType* ptr = New();
-      BlockType::Dealloc(ptr);
+    for (auto& cache : caches_) {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      Release(cache.head);
+      cache.head = nullptr;
+      cache.count = 0;
     }
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    Release(pool_head_);
+    pool_head_ = nullptr;
   }
 
   // Fill the freelist with N blocks.
   void FillN(size_t n) {
     while (n--) {
-      BlockType* block = BlockType::Alloc();
+      BlockType* block = Allocate();
       Delete(block);
     }
   }
 
   size_t Size() const { return size_.load(); }
 
+  Stats GetStats() const {
+    Stats stats;
+    stats.allocated_blocks = allocated_.load();
+    stats.free_blocks = size_.load();
+    stats.arena_bytes = arena_ ? arena_->mapped_bytes() : 0;
+    stats.huge_page_bytes = arena_ ? arena_->huge_page_bytes() : 0;
+    return stats;
+  }
+
  private:
-  std::atomic<BlockType*> head_;
+  struct alignas(64) Cache {
+    std::mutex mutex;
+    BlockType* head = nullptr;
+    size_t count = 0;
+  };
+
+  // The cache of the calling thread.
+  static size_t CacheIndex() {
+    static std::atomic<size_t> next_index(0);
+    thread_local size_t index = next_index.fetch_add(1) % kNumCaches;
+    return index;
+  }
+
+  BlockType* Allocate() {
+    BlockType* block = nullptr;
+    if (arena_) {
+      void* ptr = arena_->Allocate();
+      if (ptr != nullptr) {
+        block = new (ptr) BlockType();
+      }
+    } else {
+      block = BlockType::Alloc();
+    }
+    if (block != nullptr) {
+      allocated_++;
+    }
+    return block;
+  }
+
+  // Take a batch of blocks from the pool. Requires the cache lock.
+  void Refill(Cache& cache) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    BlockType* head = pool_head_;
+    if (head == nullptr) {
+      return;
+    }
+    size_t count = 1;
+    BlockType* tail = head;
+    for (; count < kBatchSize && tail->next != nullptr; tail = tail->next) {
+      ++count;
+    }
+    pool_head_ = tail->next;
+    tail->next = cache.head;
+    cache.head = head;
+    cache.count += count;
+  }
+
+  // Take blocks from the other caches, e.g. those left by exited threads,
+  // rather than allocating new ones. Requires the cache lock.
+  void Steal(Cache& cache) {
+    for (auto& other : caches_) {
+      if (&other == &cache || !other.mutex.try_lock()) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(other.mutex, std::adopt_lock);
+      while (other.head != nullptr && cache.count < kBatchSize) {
+        BlockType* block = other.head;
+        other.head = block->next;
+        other.count--;
+        block->next = cache.head;
+        cache.head = block;
+        cache.count++;
+      }
+      if (cache.count >= kBatchSize) {
+        return;
+      }
+    }
+  }
+
+  // Move the first count blocks of the cache to the pool. Requires the cache
+  // lock.
+  void Flush(Cache& cache, size_t count) {
+    BlockType* head = cache.head;
+    BlockType* tail = head;
+    for (size_t i = 1; i < count; ++i) {
+      tail = tail->next;
+    }
+    cache.head = tail->next;
+    cache.count -= count;
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    tail->next = pool_head_;
+    pool_head_ = head;
+  }
+
+  // Free a chain of blocks. Blocks of the arena are freed with it.
+  void Release(BlockType* head) {
+    while (head != nullptr) {
+      BlockType* next = head->next;
+      if (!arena_) {
+        BlockType::Dealloc(head);
+      }
+      allocated_--;
+      size_--;
+      head = next;
+    }
+  }
+
+  Cache caches_[kNumCaches];
+  std::mutex pool_mutex_;
+  BlockType* pool_head_;
   std::atomic<size_t> size_;
+  std::atomic<size_t> allocated_;
+  std::unique_ptr<BlockArena> arena_;
 };  // Freelist
 }  // namespace google::scp::proxy
 
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/io_uring.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+namespace google::scp::proxy {
+namespace {
+int io_uring_setup(unsigned int entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                   unsigned int flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+}  // namespace
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool IoUring::IsSupported() {
+  // Multishot recv is the most recent of the features used, since Linux 6.0.
+  utsname name;
+  int major = 0;
+  int minor = 0;
+  if (uname(&name) != 0 || sscanf(name.release, "%d.%d", &major, &minor) != 2) {
+    return false;
+  }
+  if (major < 6) {
+    return false;
+  }
+  // io_uring may still be disabled, e.g. by sysctl or seccomp.
+  IoUring ring;
+  return ring.Init(1);
+}
+
+bool IoUring::Init(unsigned int entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  // Leave room for the completions of multishot requests.
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = entries * 4;
+  fd_ = io_uring_setup(entries, &params);
+  if (fd_ < 0) {
+    return false;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap && cq_ring_size_ > sq_ring_size_) {
+    sq_ring_size_ = cq_ring_size_;
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  auto* sq = static_cast<uint8_t*>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sqe_tail_ = *sq_tail_;
+  // The entries are always submitted in order, so that the index array maps
+  // each slot to the entry of the same index.
+  auto* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  for (unsigned int i = 0; i < sq_entries_; ++i) {
+    sq_array[i] = i;
+  }
+
+  auto* cq = static_cast<uint8_t*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  return true;
+}
+
+io_uring_sqe* IoUring::GetSqe() {
+  unsigned int head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (sqe_tail_ - head >= sq_entries_) {
+    Submit();
+    head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) {
+      return nullptr;
+    }
+  }
+  io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+  ++sqe_tail_;
+  memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+int IoUring::Submit(unsigned int wait_nr) {
+  unsigned int to_submit = sqe_tail_ - *sq_tail_;
+  __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+  unsigned int flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+  while (true) {
+    int ret = io_uring_enter(fd_, to_submit, wait_nr, flags);
+    if (ret >= 0) {
+      return ret;
+    }
+    if (errno != EINTR) {
+      return -errno;
+    }
+  }
+}
+}  // namespace google::scp::proxy
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IO_URING_H_
+#define IO_URING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <linux/io_uring.h>
+
+namespace google::scp::proxy {
+// A minimal io_uring instance on top of the raw syscalls. Thread-safety:
+// unsafe, each thread is expected to use its own instance.
+class IoUring {
+ public:
+  IoUring() = default;
+  ~IoUring();
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  // Whether the running kernel supports the io_uring features used by the
+  // proxy, i.e. multishot accept and recv into provided buffers.
+  static bool IsSupported();
+
+  // Set up the rings with at least the given number of submission entries.
+  // Returns false if io_uring is unavailable.
+  bool Init(unsigned int entries);
+
+  // Get a zeroed submission entry, submitting the queued ones first if the
+  // ring is full. Returns nullptr if none is available still.
+  io_uring_sqe* GetSqe();
+
+  // Submit the queued entries, and wait for at least wait_nr completions.
+  // Returns the number of entries submitted, or -errno.
+  int Submit(unsigned int wait_nr = 0);
+
+  // Call handler with each available completion, then mark them seen.
+  template <typename Handler>
+  void ForEachCompletion(Handler&& handler) {
+    unsigned int head = *cq_head_;
+    unsigned int tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      handler(cqes_[head & cq_mask_]);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+ private:
+  int fd_ = -1;
+
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned int* sq_head_ = nullptr;
+  unsigned int* sq_tail_ = nullptr;
+  unsigned int sq_mask_ = 0;
+  unsigned int sq_entries_ = 0;
+  // The tail of the queued entries, published to the kernel on Submit().
+  unsigned int sqe_tail_ = 0;
+
+  unsigned int* cq_head_ = nullptr;
+  unsigned int* cq_tail_ = nullptr;
+  unsigned int cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+};
+}  // namespace google::scp::proxy
+
+#endif  // IO_URING_H_
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+
+using std::string;
+using std::to_string;
+
+namespace google::scp::proxy {
+namespace {
+void RenderHistogram(string& out, const char* name, const char* help,
+                     const Histogram& histogram) {
+  auto snapshot = histogram.GetSnapshot();
+  out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+  out.append("# TYPE ").append(name).append(" histogram\n");
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < Histogram::kNumBuckets; ++i) {
+    cumulative += snapshot.counts[i];
+    char bound[16] = "+Inf";
+    if (i < Histogram::kBounds.size()) {
+      snprintf(bound, sizeof(bound), "%g", Histogram::kBounds[i]);
+    }
+    out.append(name)
+        .append("_bucket{le=\"")
+        .append(bound)
+        .append("\"} ")
+        .append(to_string(cumulative))
+        .append("\n");
+  }
+  char sum[32];
+  snprintf(sum, sizeof(sum), "%.9g", snapshot.sum);
+  out.append(name).append("_sum ").append(sum).append("\n");
+  out.append(name).append("_count ").append(to_string(snapshot.count));
+  out.append("\n");
+}
+}  // namespace
+
+size_t MetricShardIndex() {
+  static std::atomic<size_t> next_index(0);
+  thread_local size_t index = next_index.fetch_add(1) % kMetricShards;
+  return index;
+}
+
+int64_t Counter::Value() const {
+  int64_t value = 0;
+  for (const auto& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+void Histogram::Observe(std::chrono::nanoseconds duration) {
+  double seconds = std::chrono::duration<double>(duration).count();
+  size_t bucket =
+      std::lower_bound(kBounds.begin(), kBounds.end(), seconds) -
+      kBounds.begin();
+  auto& shard = shards_[MetricShardIndex()];
+  shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  shard.sum_ns.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const {
+  Snapshot snapshot{};
+  uint64_t sum_ns = 0;
+  for (const auto& shard : shards_) {
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      uint64_t count = shard.counts[i].load(std::memory_order_relaxed);
+      snapshot.counts[i] += count;
+      snapshot.count += count;
+    }
+    sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+  }
+  snapshot.sum = sum_ns / 1e9;
+  return snapshot;
+}
+
+void ProxyMetrics::Render(string& out) const {
+  RenderMetric(out, "proxy_connections_total", "counter",
+               "Client connections accepted.", connections_total.Value());
+  RenderMetric(out, "proxy_active_connections", "gauge",
+               "Client connections being served.",
+               active_connections.Value());
+  RenderMetric(out, "proxy_handshake_failures_total", "counter",
+               "SOCKS5 handshakes failed.", handshake_failures_total.Value());
+  RenderMetric(out, "proxy_connect_failures_total", "counter",
+               "Connections to destinations failed.",
+               connect_failures_total.Value());
+  RenderMetric(out, "proxy_upstream_bytes_total", "counter",
+               "Bytes forwarded to destinations.",
+               upstream_bytes_total.Value());
+  RenderMetric(out, "proxy_downstream_bytes_total", "counter",
+               "Bytes forwarded to clients.", downstream_bytes_total.Value());
+  RenderMetric(out, "proxy_buffer_full_total", "counter",
+               "Times a connection buffer filled up, pausing reads.",
+               buffer_full_total.Value());
+  RenderMetric(out, "proxy_buffer_high_water_bytes", "gauge",
+               "Largest size of a connection buffer.",
+               buffer_high_water_bytes.Value());
+  RenderHistogram(out, "proxy_handshake_seconds",
+                  "Time to receive SOCKS5 requests.", handshake_seconds);
+  RenderHistogram(out, "proxy_connect_seconds",
+                  "Time to resolve and connect to destinations.",
+                  connect_seconds);
+}
+
+ProxyMetrics& Metrics() {
+  static ProxyMetrics* metrics = new ProxyMetrics();
+  return *metrics;
+}
+
+void RenderMetric(string& out, const char* name, const char* type,
+                  const char* help, int64_t value) {
+  out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+  out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+  out.append(name).append(" ").append(to_string(value)).append("\n");
+}
+}  // namespace google::scp::proxy
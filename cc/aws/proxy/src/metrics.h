@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace google::scp::proxy {
+// The number of shards of each metric. Each thread updates the shard of its
+// own, so that the hot metrics are not contended among threads.
+inline constexpr size_t kMetricShards = 16;
+
+// The shard of the calling thread.
+size_t MetricShardIndex();
+
+// A counter, or a gauge when also given negative deltas.
+class Counter {
+ public:
+  void Add(int64_t delta = 1) {
+    shards_[MetricShardIndex()].value.fetch_add(delta,
+                                                std::memory_order_relaxed);
+  }
+
+  int64_t Value() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<int64_t> value{0};
+  };
+
+  std::array<Shard, kMetricShards> shards_;
+};
+
+// A gauge of the max value recorded.
+class MaxGauge {
+ public:
+  void Record(int64_t value) {
+    int64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(
+                              max, value, std::memory_order_relaxed)) {}
+  }
+
+  int64_t Value() const { return max_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> max_{0};
+};
+
+// A histogram of durations.
+class Histogram {
+ public:
+  static constexpr size_t kNumBuckets = 12;
+  // The upper bounds of the buckets in seconds, but the last unbounded one.
+  static constexpr std::array<double, kNumBuckets - 1> kBounds = {
+      0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+      0.01,   0.025,   0.05,   0.1,   1.0};
+
+  struct Snapshot {
+    // Not cumulative.
+    std::array<uint64_t, kNumBuckets> counts;
+    uint64_t count;
+    double sum;
+  };
+
+  void Observe(std::chrono::nanoseconds duration);
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, kNumBuckets> counts{};
+    std::atomic<uint64_t> sum_ns{0};
+  };
+
+  std::array<Shard, kMetricShards> shards_;
+};
+
+// The metrics of the proxy.
+struct ProxyMetrics {
+  Counter connections_total;
+  Counter active_connections;
+  Counter handshake_failures_total;
+  Counter connect_failures_total;
+  // The bytes written to the destinations, and to the clients.
+  Counter upstream_bytes_total;
+  Counter downstream_bytes_total;
+  // The times a buffer filled up to ProxyBridge::kMaxBufferSize, pausing the
+  // reads, and the largest size of a buffer.
+  Counter buffer_full_total;
+  MaxGauge buffer_high_water_bytes;
+  // From the start of the SOCKS5 handshake to the request of a destination.
+  Histogram handshake_seconds;
+  // From the request of a destination, including name resolution, to the
+  // connection.
+  Histogram connect_seconds;
+
+  // Append the metrics in the Prometheus text format to out.
+  void Render(std::string& out) const;
+};
+
+// The metrics of the process.
+ProxyMetrics& Metrics();
+
+// Append a metric of a single value in the Prometheus text format to out.
+void RenderMetric(std::string& out, const char* name, const char* type,
+                  const char* help, int64_t value);
+}  // namespace google::scp::proxy
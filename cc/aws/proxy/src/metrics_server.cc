@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics_server.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+#include "logging.h"
+
+using boost::asio::ip::tcp;
+using boost::system::error_code;
+using std::make_shared;
+using std::string;
+
+namespace google::scp::proxy {
+namespace {
+struct Session {
+  Session(tcp::socket socket, size_t max_request_size)
+      : sock(std::move(socket)), request(max_request_size) {}
+
+  tcp::socket sock;
+  boost::asio::streambuf request;
+  string response;
+};
+}  // namespace
+
+MetricsServer::MetricsServer(boost::asio::io_context& io_context,
+                             uint16_t port, Renderer renderer)
+    : acceptor_(io_context), port_(port), renderer_(std::move(renderer)) {}
+
+void MetricsServer::Listen() {
+  tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port_);
+  acceptor_.open(endpoint.protocol());
+  acceptor_.set_option(tcp::acceptor::reuse_address(true));
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
+  port_ = acceptor_.local_endpoint().port();
+  StartAsyncAccept();
+}
+
+void MetricsServer::StartAsyncAccept() {
+  acceptor_.async_accept([this](error_code ec, tcp::socket socket) {
+    if (ec == boost::asio::error::operation_aborted) {
+      return;
+    }
+    StartAsyncAccept();
+    if (!ec) {
+      Serve(std::move(socket));
+    }
+  });
+}
+
+void MetricsServer::Serve(tcp::socket socket) {
+  auto session = make_shared<Session>(std::move(socket), kMaxRequestSize);
+  boost::asio::async_read_until(
+      session->sock, session->request, "\r\n\r\n",
+      [this, session](error_code ec, size_t) {
+        if (ec.failed()) {
+          return;
+        }
+        string body;
+        renderer_(body);
+        session->response =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Connection: close\r\n"
+            "Content-Length: " +
+            std::to_string(body.size()) + "\r\n\r\n" + body;
+        boost::asio::async_write(
+            session->sock, boost::asio::buffer(session->response),
+            [session](error_code ec, size_t) {
+              if (ec.failed()) {
+                LogError("Failed to write metrics: ", ec.message());
+                return;
+              }
+              session->sock.shutdown(tcp::socket::shutdown_both, ec);
+            });
+      });
+}
+}  // namespace google::scp::proxy
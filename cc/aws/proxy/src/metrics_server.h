@@ -0,0 +1,55 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+
+#include <boost/asio.hpp>
+
+namespace google::scp::proxy {
+// MetricsServer serves the metrics in the Prometheus text format over HTTP on
+// the loopback interface, for a local agent to scrape. Every request gets the
+// metrics, whatever its path, then the connection is closed.
+class MetricsServer {
+ public:
+  // Append the metrics to the string.
+  using Renderer = std::function<void(std::string&)>;
+
+  MetricsServer(boost::asio::io_context& io_context, uint16_t port,
+                Renderer renderer);
+
+  // Bind and listen on the port, then serve the requests on the io_context.
+  // Throws boost::system::system_error on errors.
+  void Listen();
+
+  uint16_t Port() const { return port_; }
+
+ private:
+  // The max size of the request headers.
+  static constexpr size_t kMaxRequestSize = 8192;
+
+  void StartAsyncAccept();
+  void Serve(boost::asio::ip::tcp::socket socket);
+
+  boost::asio::ip::tcp::acceptor acceptor_;
+  uint16_t port_;
+  Renderer renderer_;
+};
+}  // namespace google::scp::proxy
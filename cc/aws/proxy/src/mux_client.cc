@@ -0,0 +1,54 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+
+#include "logging.h"
+#include "mux_client_server.h"
+#include "protocol.h"
+
+using google::scp::proxy::Endpoint;
+using google::scp::proxy::LogError;
+using google::scp::proxy::LogInfo;
+using google::scp::proxy::MuxClientServer;
+
+// Run in the enclave with PROXY_MUX=1 set for the applications, so that the
+// preload library carries their connections over the multiplexed connections of
+// this process.
+int main(int argc, char* argv[]) {
+  LogInfo("Nitro Enclave Proxy Mux Client (c) Google 2024.");
+  {
+    // Ignore SIGPIPE.
+    struct sigaction act {};
+
+    act.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &act, nullptr);
+  }
+
+  auto addr = GetProxyVsockAddr();
+  Endpoint ep(&addr, sizeof(addr));
+  unsigned int num_connections = kDefaultMuxConnections;
+  EnvGetVal(kMuxConnectionsEnv, num_connections);
+
+  MuxClientServer server(kMuxClientUdsPath, ep, num_connections, 4);
+  if (!server.Init()) {
+    return 1;
+  }
+  server.Run();
+
+  LogError("ERROR: A fatal error has occurred, terminating mux client");
+  return 1;
+}
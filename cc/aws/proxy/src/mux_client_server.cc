@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mux_client_server.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+#include "logging.h"
+#include "socket_types.h"
+
+namespace asio = boost::asio;
+using boost::system::error_code;
+using std::lock_guard;
+using std::make_shared;
+using std::move;
+using std::mutex;
+using std::shared_ptr;
+
+namespace google::scp::proxy {
+bool MuxClientServer::Init() {
+  if (sock_path_.empty()) {
+    LogError("Sock path is empty.");
+    return false;
+  }
+  // Delete the file first.
+  if (unlink(sock_path_.c_str()) != 0 && errno != ENOENT) {
+    LogError("Cannot remove file: ", sock_path_);
+    return false;
+  }
+  Protocol protocol(AF_UNIX, 0);
+  error_code ec;
+  acceptor_.open(protocol, ec);
+  if (ec.failed()) {
+    LogError("Cannot open acceptor: ", ec.message());
+    return false;
+  }
+  Endpoint ep{asio::local::stream_protocol::endpoint(sock_path_)};
+  acceptor_.bind(ep, ec);
+  if (ec.failed()) {
+    LogError("Cannot bind on path: ", sock_path_, ", ", ec.message());
+    return false;
+  }
+  acceptor_.listen(Socket::max_listen_connections, ec);
+  if (ec.failed()) {
+    LogError("Cannot listen on path: ", sock_path_, ", ", ec.message());
+    return false;
+  }
+  StartAsyncAccept();
+  return true;
+}
+
+void MuxClientServer::Run() {
+  if (concurrency_ == 0) {
+    concurrency_ = std::thread::hardware_concurrency();
+  }
+  for (size_t i = 0; i < concurrency_; ++i) {
+    workers_.emplace_back([this]() { io_context_.run(); });
+  }
+  for (auto& w : workers_) {
+    w.join();
+  }
+}
+
+void MuxClientServer::Stop() {
+  io_context_.stop();
+}
+
+void MuxClientServer::StartAsyncAccept() {
+  acceptor_.async_accept([this](error_code ec, Socket socket) {
+    StartAsyncAccept();
+    if (!ec) {
+      GetSession()->OpenStream(move(socket));
+    }
+  });
+}
+
+shared_ptr<MuxSession> MuxClientServer::GetSession() {
+  lock_guard<mutex> lock(sessions_mutex_);
+  auto& session = sessions_[next_session_++ % sessions_.size()];
+  if (!session || session->IsClosed()) {
+    // The streams opened meanwhile are queued until it is connected.
+    session = make_shared<MuxSession>(Socket(io_context_));
+    session->Connect(proxy_endpoint_);
+  }
+  return session;
+}
+
+}  // namespace google::scp::proxy
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mux_session.h"
+#include "socket_types.h"
+
+namespace google::scp::proxy {
+// MuxClientServer runs in the enclave, accepting the connections of the
+// preload library on a UNIX domain socket, and carrying each of them as a
+// stream of one of a few multiplexed connections to the proxy.
+class MuxClientServer {
+ public:
+  MuxClientServer(const std::string& sock_path, Endpoint proxy_endpoint,
+                  size_t num_connections, size_t concurrency)
+      : acceptor_(io_context_),
+        sock_path_(sock_path),
+        proxy_endpoint_(proxy_endpoint),
+        sessions_(num_connections > 0 ? num_connections : 1),
+        concurrency_(concurrency) {}
+
+  bool Init();
+  void Run();
+  void Stop();
+
+ private:
+  void StartAsyncAccept();
+  // Get the next multiplexed connection in turn, reconnecting it if closed.
+  std::shared_ptr<MuxSession> GetSession();
+
+  boost::asio::io_context io_context_;
+  Acceptor acceptor_;
+  std::vector<std::thread> workers_;
+  std::string sock_path_;
+  Endpoint proxy_endpoint_;
+  std::vector<std::shared_ptr<MuxSession>> sessions_;
+  std::mutex sessions_mutex_;
+  size_t next_session_ = 0;
+  size_t concurrency_;
+};
+}  // namespace google::scp::proxy
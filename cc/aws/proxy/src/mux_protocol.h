@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The framing protocol of a multiplexed connection, carrying many streams
+// between the mux client in the enclave and the proxy. Each stream carries the
+// bytes a dedicated connection to the proxy would, starting with the socks5
+// handshake.
+//
+// The client starts the connection with kPreface, which the proxy tells apart
+// from the first byte of a socks5 greeting (0x05). Then both sides send frames,
+// each a 12-byte header in network byte order followed by the payload:
+//
+//   +------+-------+----------+-----------+--------+
+//   | TYPE | FLAGS | RESERVED | STREAM ID | LENGTH |
+//   +------+-------+----------+-----------+--------+
+//   |  1   |   1   |    2     |     4     |   4    |
+//   +------+-------+----------+-----------+--------+
+//
+// A stream is opened by the client sending the first kData frame, possibly
+// empty, of a new stream id, which must be greater than those of the streams
+// opened before.
+// Each side may only send kData payload up to the window of the stream, which
+// starts at kInitialWindowSize and grows by the kWindowUpdate frames of the
+// receiver as it consumes the payload.
+namespace google::scp::proxy::mux {
+
+static constexpr uint8_t kPreface[] = {'S', 'C', 'P', 'M', 'U', 'X', '0', '1'};
+
+enum class FrameType : uint8_t {
+  // LENGTH bytes of payload of the stream.
+  kData = 0x00,
+  // No payload, LENGTH is the number of bytes the window grows by.
+  kWindowUpdate = 0x01,
+  // No payload, the stream is aborted in both directions.
+  kReset = 0x02,
+};
+
+// Set on a kData frame, the sender sends no more data on the stream.
+static constexpr uint8_t kFlagFin = 0x01;
+
+static constexpr size_t kFrameHeaderSize = 12u;
+static constexpr uint32_t kMaxFramePayloadSize = 64u * 1024u;
+static constexpr uint32_t kInitialWindowSize = 256u * 1024u;
+
+struct FrameHeader {
+  FrameType type;
+  uint8_t flags;
+  uint32_t stream_id;
+  uint32_t length;
+};
+
+inline void EncodeFrameHeader(const FrameHeader& header, uint8_t* out) {
+  out[0] = static_cast<uint8_t>(header.type);
+  out[1] = header.flags;
+  out[2] = 0;
+  out[3] = 0;
+  for (int i = 0; i < 4; ++i) {
+    out[4 + i] = static_cast<uint8_t>(header.stream_id >> (24 - 8 * i));
+    out[8 + i] = static_cast<uint8_t>(header.length >> (24 - 8 * i));
+  }
+}
+
+inline FrameHeader DecodeFrameHeader(const uint8_t* in) {
+  FrameHeader header{static_cast<FrameType>(in[0]), in[1], 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    header.stream_id = (header.stream_id << 8) | in[4 + i];
+    header.length = (header.length << 8) | in[8 + i];
+  }
+  return header;
+}
+
+}  // namespace google::scp::proxy::mux
@@ -0,0 +1,395 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mux_session.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include <boost/asio.hpp>
+#include <boost/bind/bind.hpp>
+
+#include "logging.h"
+#include "socket_types.h"
+
+// We need to use boost::bind instead of std::bind, otherwise
+// asio::bind_executors won't work.
+using boost::bind;
+using boost::asio::bind_executor;
+using boost::system::error_code;
+using boost::asio::error::eof;
+using std::make_shared;
+using std::move;
+using std::shared_ptr;
+
+namespace asio = boost::asio;
+namespace placeholders = boost::asio::placeholders;
+
+namespace google::scp::proxy {
+
+using mux::FrameHeader;
+using mux::FrameType;
+using mux::kFlagFin;
+using mux::kFrameHeaderSize;
+using mux::kInitialWindowSize;
+using mux::kMaxFramePayloadSize;
+using mux::kPreface;
+
+void MuxSession::Connect(const Endpoint& endpoint) {
+  auto self = shared_from_this();
+  conn_.async_connect(endpoint,
+                      bind_executor(strand_, [self](const error_code& ec) {
+                        if (ec.failed()) {
+                          LogError("Cannot connect to proxy: ", ec.message());
+                          self->CloseInStrand();
+                          return;
+                        }
+                        self->StartInStrand();
+                      }));
+}
+
+void MuxSession::Start() {
+  asio::post(strand_, bind(&MuxSession::StartInStrand, shared_from_this()));
+}
+
+void MuxSession::OpenStream(Socket stream_sock) {
+  auto sock = make_shared<Socket>(move(stream_sock));
+  auto self = shared_from_this();
+  asio::post(strand_, [self, sock]() {
+    if (self->closed_.load()) {
+      error_code ec;
+      sock->close(ec);
+      return;
+    }
+    auto stream = self->AddStream(move(*sock), self->next_stream_id_++);
+    // Open the stream right away, as the streams must be opened in the order
+    // of their ids, whatever order their data is read in.
+    self->SendFrame(FrameType::kData, 0, stream->id, 0);
+    self->ReadStream(stream);
+  });
+}
+
+void MuxSession::Close() {
+  asio::post(strand_, bind(&MuxSession::CloseInStrand, shared_from_this()));
+}
+
+void MuxSession::StartInStrand() {
+  if (closed_.load()) {
+    return;
+  }
+  connected_ = true;
+  if (is_client_) {
+    // The preface goes before the frames of the streams opened so far.
+    write_buff_.insert(write_buff_.begin(), kPreface,
+                       kPreface + sizeof(kPreface));
+  }
+  StartRead();
+  StartWrite();
+}
+
+void MuxSession::CloseInStrand() {
+  if (closed_.exchange(true)) {
+    return;
+  }
+  error_code ec;
+  conn_.close(ec);
+  for (auto& [id, stream] : streams_) {
+    stream->closed = true;
+    stream->sock.close(ec);
+  }
+  streams_.clear();
+}
+
+void MuxSession::StartRead() {
+  conn_.async_read_some(
+      asio::buffer(read_buff_.data() + read_size_,
+                   read_buff_.size() - read_size_),
+      bind_executor(strand_, bind(&MuxSession::ReadHandler, shared_from_this(),
+                                  placeholders::error,
+                                  placeholders::bytes_transferred)));
+}
+
+void MuxSession::ReadHandler(const error_code& ec, size_t bytes_read) {
+  if (ec.failed() || closed_.load()) {
+    CloseInStrand();
+    return;
+  }
+  read_size_ += bytes_read;
+  size_t offset = 0;
+  if (!is_client_ && !preface_received_) {
+    if (read_size_ < sizeof(kPreface)) {
+      StartRead();
+      return;
+    }
+    if (memcmp(read_buff_.data(), kPreface, sizeof(kPreface)) != 0) {
+      LogError("Invalid mux preface.");
+      CloseInStrand();
+      return;
+    }
+    preface_received_ = true;
+    offset = sizeof(kPreface);
+  }
+  while (read_size_ - offset >= kFrameHeaderSize) {
+    auto header = mux::DecodeFrameHeader(&read_buff_[offset]);
+    size_t payload_size = header.type == FrameType::kData ? header.length : 0;
+    if (payload_size > kMaxFramePayloadSize) {
+      LogError("Mux frame payload too large: ", payload_size);
+      CloseInStrand();
+      return;
+    }
+    if (read_size_ - offset < kFrameHeaderSize + payload_size) {
+      break;
+    }
+    HandleFrame(header, &read_buff_[offset + kFrameHeaderSize]);
+    if (closed_.load()) {
+      return;
+    }
+    offset += kFrameHeaderSize + payload_size;
+  }
+  // Move the incomplete frame to the front.
+  memmove(read_buff_.data(), read_buff_.data() + offset, read_size_ - offset);
+  read_size_ -= offset;
+  StartRead();
+}
+
+void MuxSession::HandleFrame(const FrameHeader& header,
+                             const uint8_t* payload) {
+  if (header.type == FrameType::kData) {
+    HandleData(header, payload);
+    return;
+  }
+  auto it = streams_.find(header.stream_id);
+  // The frames of the streams already removed are dropped.
+  if (it == streams_.end()) {
+    return;
+  }
+  auto stream = it->second;
+  switch (header.type) {
+    case FrameType::kWindowUpdate:
+      stream->send_window += header.length;
+      ReadStream(stream);
+      break;
+    case FrameType::kReset:
+      ResetStream(stream, false);
+      break;
+    default:
+      // Unknown frames are ignored, for forward compatibility.
+      break;
+  }
+}
+
+void MuxSession::HandleData(const FrameHeader& header,
+                            const uint8_t* payload) {
+  shared_ptr<Stream> stream;
+  auto it = streams_.find(header.stream_id);
+  if (it != streams_.end()) {
+    stream = it->second;
+  } else if (!is_client_ && header.stream_id > last_stream_id_) {
+    // A new stream, served through a socket pair like a dedicated connection.
+    asio::local::stream_protocol::socket stream_sock(conn_.get_executor());
+    asio::local::stream_protocol::socket handler_sock(conn_.get_executor());
+    error_code ec;
+    asio::local::connect_pair(stream_sock, handler_sock, ec);
+    last_stream_id_ = header.stream_id;
+    if (ec.failed()) {
+      LogError("Cannot create socket pair: ", ec.message());
+      SendFrame(FrameType::kReset, 0, header.stream_id, 0);
+      return;
+    }
+    stream = AddStream(Socket(move(stream_sock)), header.stream_id);
+    stream_handler_(Socket(move(handler_sock)));
+    ReadStream(stream);
+  } else {
+    // The stream was already removed.
+    return;
+  }
+
+  // The payload received and not acknowledged yet is bounded by the window.
+  size_t unacked_size =
+      stream->pending_write_size + stream->unacked_size + header.length;
+  if (stream->remote_fin || unacked_size > kInitialWindowSize) {
+    LogError("Mux stream ", stream->id, " exceeded its window.");
+    ResetStream(stream, true);
+    return;
+  }
+  if (header.length > 0) {
+    stream->pending_writes.emplace_back(payload, payload + header.length);
+    stream->pending_write_size += header.length;
+  }
+  if (header.flags & kFlagFin) {
+    stream->remote_fin = true;
+  }
+  WriteStream(stream);
+}
+
+void MuxSession::SendFrame(FrameType type, uint8_t flags, uint32_t stream_id,
+                           uint32_t length, const uint8_t* payload) {
+  if (closed_.load()) {
+    return;
+  }
+  uint8_t header[kFrameHeaderSize];
+  mux::EncodeFrameHeader(FrameHeader{type, flags, stream_id, length}, header);
+  write_buff_.insert(write_buff_.end(), header, header + sizeof(header));
+  if (payload != nullptr) {
+    write_buff_.insert(write_buff_.end(), payload, payload + length);
+  }
+  StartWrite();
+}
+
+void MuxSession::StartWrite() {
+  if (writing_ || !connected_ || write_buff_.empty() || closed_.load()) {
+    return;
+  }
+  // Write all the frames queued so far at once, new ones are queued meanwhile.
+  write_buff_.swap(inflight_write_buff_);
+  write_buff_.clear();
+  writing_ = true;
+  asio::async_write(
+      conn_, asio::buffer(inflight_write_buff_),
+      bind_executor(strand_, bind(&MuxSession::WriteHandler, shared_from_this(),
+                                  placeholders::error,
+                                  placeholders::bytes_transferred)));
+}
+
+void MuxSession::WriteHandler(const error_code& ec, size_t bytes_written) {
+  writing_ = false;
+  if (ec.failed()) {
+    CloseInStrand();
+    return;
+  }
+  StartWrite();
+}
+
+shared_ptr<MuxSession::Stream> MuxSession::AddStream(Socket sock,
+                                                     uint32_t id) {
+  auto stream = make_shared<Stream>(move(sock), id);
+  streams_[id] = stream;
+  return stream;
+}
+
+void MuxSession::ReadStream(const shared_ptr<Stream>& stream) {
+  if (stream->reading || stream->closed || stream->local_eof ||
+      stream->send_window == 0) {
+    return;
+  }
+  if (stream->read_buff.empty()) {
+    stream->read_buff.resize(kMaxFramePayloadSize);
+  }
+  size_t read_size = std::min<uint64_t>(kMaxFramePayloadSize,
+                                        stream->send_window);
+  stream->reading = true;
+  stream->sock.async_read_some(
+      asio::buffer(stream->read_buff.data(), read_size),
+      bind_executor(strand_, bind(&MuxSession::StreamReadHandler,
+                                  shared_from_this(), stream,
+                                  placeholders::error,
+                                  placeholders::bytes_transferred)));
+}
+
+void MuxSession::StreamReadHandler(const shared_ptr<Stream>& stream,
+                                   const error_code& ec, size_t bytes_read) {
+  stream->reading = false;
+  if (stream->closed) {
+    return;
+  }
+  if (ec == eof) {
+    SendFrame(FrameType::kData, kFlagFin, stream->id, 0);
+    stream->local_eof = true;
+    MaybeRemoveStream(stream);
+    return;
+  }
+  if (ec.failed()) {
+    ResetStream(stream, true);
+    return;
+  }
+  SendFrame(FrameType::kData, 0, stream->id, bytes_read,
+            stream->read_buff.data());
+  stream->send_window -= bytes_read;
+  ReadStream(stream);
+}
+
+void MuxSession::WriteStream(const shared_ptr<Stream>& stream) {
+  if (stream->writing || stream->closed) {
+    return;
+  }
+  if (stream->pending_writes.empty()) {
+    if (stream->remote_fin && !stream->shutdown_sent) {
+      error_code ec;
+      stream->sock.shutdown(Socket::shutdown_send, ec);
+      stream->shutdown_sent = true;
+      MaybeRemoveStream(stream);
+    }
+    return;
+  }
+  stream->writing = true;
+  asio::async_write(
+      stream->sock, asio::buffer(stream->pending_writes.front()),
+      bind_executor(strand_, bind(&MuxSession::StreamWriteHandler,
+                                  shared_from_this(), stream,
+                                  placeholders::error,
+                                  placeholders::bytes_transferred)));
+}
+
+void MuxSession::StreamWriteHandler(const shared_ptr<Stream>& stream,
+                                    const error_code& ec,
+                                    size_t bytes_written) {
+  stream->writing = false;
+  if (stream->closed) {
+    return;
+  }
+  if (ec.failed()) {
+    ResetStream(stream, true);
+    return;
+  }
+  stream->pending_write_size -= bytes_written;
+  stream->unacked_size += bytes_written;
+  stream->pending_writes.pop_front();
+  // Grow the window of the peer in batches, not on every write.
+  if (stream->unacked_size >= kInitialWindowSize / 2 && !stream->remote_fin) {
+    SendFrame(FrameType::kWindowUpdate, 0, stream->id, stream->unacked_size);
+    stream->unacked_size = 0;
+  }
+  WriteStream(stream);
+}
+
+void MuxSession::ResetStream(const shared_ptr<Stream>& stream,
+                             bool notify_peer) {
+  if (stream->closed) {
+    return;
+  }
+  if (notify_peer) {
+    SendFrame(FrameType::kReset, 0, stream->id, 0);
+  }
+  stream->closed = true;
+  error_code ec;
+  stream->sock.close(ec);
+  streams_.erase(stream->id);
+}
+
+void MuxSession::MaybeRemoveStream(const shared_ptr<Stream>& stream) {
+  if (!stream->local_eof || !stream->shutdown_sent) {
+    return;
+  }
+  stream->closed = true;
+  error_code ec;
+  stream->sock.close(ec);
+  streams_.erase(stream->id);
+}
+
+}  // namespace google::scp::proxy
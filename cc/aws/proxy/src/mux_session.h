@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/strand.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "mux_protocol.h"
+#include "socket_types.h"
+
+namespace google::scp::proxy {
+// MuxSession carries many streams over one multiplexed connection, see
+// mux_protocol.h. Each stream is bridged to a local stream socket: on the
+// client side, a connection accepted from the application; on the proxy side,
+// one end of a socket pair, the other end of which is handed to a stream
+// handler to be served like a dedicated connection. This class is thread safe,
+// all the state is accessed on its strand.
+class MuxSession : public std::enable_shared_from_this<MuxSession> {
+ public:
+  // Serves the socket of a stream opened by the client.
+  using StreamHandler = std::function<void(Socket stream_sock)>;
+
+  // Construct the client side of a multiplexed connection. SocketType can be
+  // any stream socket implementation of boost::asio.
+  template <typename SocketType>
+  explicit MuxSession(SocketType conn)
+      : MuxSession(std::move(conn), true, nullptr) {}
+
+  // Construct the proxy side of a multiplexed connection, calling
+  // stream_handler for each stream opened by the client.
+  template <typename SocketType>
+  MuxSession(SocketType conn, StreamHandler stream_handler)
+      : MuxSession(std::move(conn), false, std::move(stream_handler)) {}
+
+  // Connect the client side to the proxy and start the session.
+  void Connect(const Endpoint& endpoint);
+
+  // Start the session on an already connected socket.
+  void Start();
+
+  // Open a new stream forwarding the traffic of stream_sock. Client side only.
+  // The streams may be opened before the connection is established.
+  void OpenStream(Socket stream_sock);
+
+  // Close the connection, and the sockets of all the streams with it.
+  void Close();
+
+  bool IsClosed() const { return closed_.load(); }
+
+ private:
+  // The buffer holds at least two full frames, so that a frame is never split
+  // by compacting the buffer.
+  static constexpr size_t kReadBufferSize =
+      2 * (mux::kFrameHeaderSize + mux::kMaxFramePayloadSize);
+
+  struct Stream {
+    Stream(Socket sock, uint32_t id) : sock(std::move(sock)), id(id) {}
+
+    Socket sock;
+    const uint32_t id;
+    // The payload received from the peer and not written to sock yet.
+    std::deque<std::vector<uint8_t>> pending_writes;
+    size_t pending_write_size = 0;
+    // The bytes written to sock and not acknowledged to the peer yet.
+    size_t unacked_size = 0;
+    // The bytes the peer is ready to receive.
+    uint64_t send_window = mux::kInitialWindowSize;
+    std::vector<uint8_t> read_buff;
+    bool reading = false;
+    bool writing = false;
+    // Whether sock was read to EOF, and FIN sent to the peer.
+    bool local_eof = false;
+    // Whether the peer sent FIN, and whether sock was shut down after it.
+    bool remote_fin = false;
+    bool shutdown_sent = false;
+    bool closed = false;
+  };
+
+  template <typename SocketType>
+  MuxSession(SocketType conn, bool is_client, StreamHandler stream_handler)
+      : strand_(conn.get_executor()),
+        conn_(std::move(conn)),
+        is_client_(is_client),
+        stream_handler_(std::move(stream_handler)),
+        read_buff_(kReadBufferSize) {}
+
+  void StartInStrand();
+  void CloseInStrand();
+
+  // Read the connection, and handle the received frames.
+  void StartRead();
+  void ReadHandler(const boost::system::error_code& ec, size_t bytes_read);
+  void HandleFrame(const mux::FrameHeader& header, const uint8_t* payload);
+  void HandleData(const mux::FrameHeader& header, const uint8_t* payload);
+
+  // Queue a frame to be written to the connection.
+  void SendFrame(mux::FrameType type, uint8_t flags, uint32_t stream_id,
+                 uint32_t length, const uint8_t* payload = nullptr);
+  void StartWrite();
+  void WriteHandler(const boost::system::error_code& ec, size_t bytes_written);
+
+  std::shared_ptr<Stream> AddStream(Socket sock, uint32_t id);
+  // Read the stream socket as far as the window of the peer allows.
+  void ReadStream(const std::shared_ptr<Stream>& stream);
+  void StreamReadHandler(const std::shared_ptr<Stream>& stream,
+                         const boost::system::error_code& ec,
+                         size_t bytes_read);
+  // Write the received payload to the stream socket.
+  void WriteStream(const std::shared_ptr<Stream>& stream);
+  void StreamWriteHandler(const std::shared_ptr<Stream>& stream,
+                          const boost::system::error_code& ec,
+                          size_t bytes_written);
+  // Abort the stream, telling the peer if notify_peer.
+  void ResetStream(const std::shared_ptr<Stream>& stream, bool notify_peer);
+  // Remove the stream once both directions are finished.
+  void MaybeRemoveStream(const std::shared_ptr<Stream>& stream);
+
+  boost::asio::strand<Executor> strand_;
+  // The multiplexed connection.
+  Socket conn_;
+  const bool is_client_;
+  const StreamHandler stream_handler_;
+  std::unordered_map<uint32_t, std::shared_ptr<Stream>> streams_;
+  // The id of the next stream opened by the client.
+  uint32_t next_stream_id_ = 1;
+  // The id of the last stream opened by the client, on the proxy side.
+  uint32_t last_stream_id_ = 0;
+  std::vector<uint8_t> read_buff_;
+  size_t read_size_ = 0;
+  // The frames queued, and the frames being written to the connection.
+  std::vector<uint8_t> write_buff_;
+  std::vector<uint8_t> inflight_write_buff_;
+  bool connected_ = false;
+  bool preface_received_ = false;
+  bool writing_ = false;
+  std::atomic<bool> closed_ = false;
+};
+
+}  // namespace google::scp::proxy
@@ -18,6 +18,7 @@
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <pthread.h>
 #include <resolv.h>
 #include <sys/epoll.h>
 #include <sys/resource.h>
@@ -30,11 +31,14 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 
 #include "protocol.h"
 #include "socket_vendor_protocol.h"
+#include "warm_connection_pool.h"
 
 namespace socket_vendor = google::scp::proxy::socket_vendor;
+using google::scp::proxy::WarmConnectionPool;
 
 // Define possible interfaces with C linkage so that all the signatures and
 // interfaces are consistent with libc.
@@ -63,6 +67,9 @@ static int (*libc_accept4)(int sockfd, struct sockaddr* addr,
                            socklen_t* addrlen, int flags);
 static int (*libc_epoll_ctl)(int epfd, int op, int fd,
                              struct epoll_event* event);
+// Whether connect() carries the connections as streams of the mux client, in
+// which case they are UNIX domain sockets.
+static bool is_mux_enabled = false;
 // The ioctl() syscall signature contains variadic arguments for historical
 // reasons (i.e. allowing different types without forced casting). However, a
 // real syscall cannot have variadic arguments at all. The real internal
@@ -71,7 +78,9 @@ static int (*libc_epoll_ctl)(int epfd, int op, int fd,
 int ioctl(int fd, unsigned long request, void* argp);
 }
 
-static int socks5_client_connect(int sockfd, const struct sockaddr* addr);
+static int socks5_client_greet(int sockfd);
+static int socks5_client_connect(int sockfd, const struct sockaddr* addr,
+                                 bool is_greeted);
 
 namespace {
 class AutoCloseFd {
@@ -108,6 +117,70 @@ int ConvertToVsock(int sockfd) {
   return flags;
 }
 
+// Connects to the proxy over VSOCK and sends the greeting. Returns the
+// connection, or -1 on failure.
+int MakeWarmConnection() {
+  int fd = socket(AF_VSOCK, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  sockaddr_vm vsock_addr = GetProxyVsockAddr();
+  if (libc_connect(fd, reinterpret_cast<sockaddr*>(&vsock_addr),
+                   sizeof(vsock_addr)) < 0 ||
+      socks5_client_greet(fd) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// The warm connections claimed by connect(). Never destroyed, as its refill
+// thread keeps running until the process exits.
+WarmConnectionPool& GetWarmConnectionPool() {
+  static auto* pool = new WarmConnectionPool(&MakeWarmConnection);
+  return *pool;
+}
+
+// Replace sockfd with a warm connection of the pool, keeping its file
+// descriptor and status flags. Returns false if there is no warm connection.
+bool ReplaceWithWarmConnection(int sockfd) {
+  int warm_fd = GetWarmConnectionPool().Claim();
+  if (warm_fd < 0) {
+    return false;
+  }
+  AutoCloseFd autoclose(warm_fd);
+  int fd_flags = fcntl(sockfd, F_GETFD);
+  if (dup2(warm_fd, sockfd) < 0) {
+    return false;
+  }
+  fcntl(sockfd, F_SETFD, fd_flags);
+  return true;
+}
+
+// Replace sockfd with a new stream of the mux client, keeping its file
+// descriptor and status flags. Returns false if the mux client is not running.
+bool ReplaceWithMuxStream(int sockfd) {
+  int uds_sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (uds_sock < 0) {
+    return false;
+  }
+  AutoCloseFd autoclose(uds_sock);
+  sockaddr_un uds_addr;
+  memset(&uds_addr, 0, sizeof(uds_addr));
+  uds_addr.sun_family = AF_UNIX;
+  memcpy(uds_addr.sun_path, kMuxClientUdsPath, sizeof(kMuxClientUdsPath));
+  if (libc_connect(uds_sock, reinterpret_cast<sockaddr*>(&uds_addr),
+                   sizeof(uds_addr)) < 0) {
+    return false;
+  }
+  int fd_flags = fcntl(sockfd, F_GETFD);
+  if (dup2(uds_sock, sockfd) < 0) {
+    return false;
+  }
+  fcntl(sockfd, F_SETFD, fd_flags);
+  return true;
+}
+
 }  // namespace
 
 void preload_init(void) {
@@ -142,6 +215,15 @@ void preload_init(void) {
       dlsym(RTLD_NEXT, STR(epoll_ctl)));
 #undef _STR
 #undef STR
+  unsigned int mux_enabled = 0;
+  EnvGetVal(kMuxEnabledEnv, mux_enabled);
+  is_mux_enabled = mux_enabled != 0;
+  unsigned int warm_pool_size = kDefaultWarmPoolSize;
+  EnvGetVal(kWarmPoolSizeEnv, warm_pool_size);
+  GetWarmConnectionPool().SetCapacity(warm_pool_size);
+  pthread_atfork([] { GetWarmConnectionPool().BeforeFork(); },
+                 [] { GetWarmConnectionPool().AfterForkInParent(); },
+                 [] { GetWarmConnectionPool().AfterForkInChild(); });
 }
 
 #define EXPORT __attribute__((visibility("default")))
@@ -231,25 +313,31 @@ EXPORT int connect(int sockfd, const struct sockaddr* addr, socklen_t addrlen) {
       (addr->sa_family != AF_INET && addr->sa_family != AF_INET6)) {
     return libc_connect(sockfd, addr, addrlen);
   }
-  int fl = 0;
-  if (sock_domain == AF_VSOCK) {
-    fl = fcntl(sockfd, F_GETFL);
-  } else {
+  int fl = fcntl(sockfd, F_GETFL);
+  // A VSOCK socket was converted by epoll_ctl() and may be in an epoll
+  // instance, so it cannot be replaced with a mux stream or a warm connection.
+  bool is_connected = sock_domain != AF_VSOCK && is_mux_enabled &&
+                      ReplaceWithMuxStream(sockfd);
+  bool is_greeted = !is_connected && sock_domain != AF_VSOCK &&
+                    ReplaceWithWarmConnection(sockfd);
+  if (!is_connected && !is_greeted && sock_domain != AF_VSOCK) {
     fl = ConvertToVsock(sockfd);
   }
   // Set blocking
   fcntl(sockfd, F_SETFL, (fl & ~O_NONBLOCK));
-  sockaddr_vm vsock_addr = GetProxyVsockAddr();
-  if (libc_connect(sockfd, reinterpret_cast<sockaddr*>(&vsock_addr),
-                   sizeof(vsock_addr)) < 0) {
-    fcntl(sockfd, F_SETFL, fl);
-    return -1;
+  if (!is_connected && !is_greeted) {
+    sockaddr_vm vsock_addr = GetProxyVsockAddr();
+    if (libc_connect(sockfd, reinterpret_cast<sockaddr*>(&vsock_addr),
+                     sizeof(vsock_addr)) < 0) {
+      fcntl(sockfd, F_SETFL, fl);
+      return -1;
+    }
   }
   // Here this is a blocking call. This potentially hurts performance on many,
   // frequent, short non-blocking connections. However, without a blocking call
   // here we'd have to hijack select/poll/epoll all together as well, which is
   // far more complicated. They may be added later if needed.
-  ret = socks5_client_connect(sockfd, addr);
+  ret = socks5_client_connect(sockfd, addr, is_greeted);
   // Apply file modes again.
   fcntl(sockfd, F_SETFL, fl);
   return ret;
@@ -265,7 +353,7 @@ EXPORT int setsockopt(int sockfd, int level, int optname, const void* optval,
   if ((level == IPPROTO_TCP || level == IPPROTO_IP || level == IPPROTO_IPV6) &&
       !libc_getsockopt(sockfd, SOL_SOCKET, SO_DOMAIN,
                        static_cast<void*>(&sock_domain), &sock_domain_len) &&
-      sock_domain == AF_VSOCK) {
+      (sock_domain == AF_VSOCK || (is_mux_enabled && sock_domain == AF_UNIX))) {
     return 0;
   }
   return libc_setsockopt(sockfd, level, optname, optval, optlen);
@@ -278,7 +366,7 @@ EXPORT int getsockopt(int sockfd, int level, int optname,
   if ((level == IPPROTO_TCP || level == IPPROTO_IP || level == IPPROTO_IPV6) &&
       !libc_getsockopt(sockfd, SOL_SOCKET, SO_DOMAIN,
                        static_cast<void*>(&sock_domain), &sock_domain_len) &&
-      sock_domain == AF_VSOCK) {
+      (sock_domain == AF_VSOCK || (is_mux_enabled && sock_domain == AF_UNIX))) {
     return 0;
   }
   return libc_getsockopt(sockfd, level, optname, optval, optlen);
@@ -333,12 +421,32 @@ EXPORT int ioctl(int fd, unsigned long request, void* argp) {  // NOLINT
   return ret;
 }
 
-int socks5_client_connect(int sockfd, const struct sockaddr* addr) {
+int socks5_client_greet(int sockfd) {
+  // The client greeting declaring only supporting one auth method "no auth",
+  // and the method selection reply. See socks5_client_connect() below.
+  static const uint8_t greeting[] = {0x05, 0x01, 0x00};
+  static const uint8_t expected_reply[] = {0x05, 0x00};
+  ssize_t ret = send(sockfd, greeting, sizeof(greeting), 0);
+  if (ret != static_cast<ssize_t>(sizeof(greeting))) {
+    return -1;
+  }
+  uint8_t reply[sizeof(expected_reply)];
+  if (recv_all(sockfd, reply, sizeof(reply), 0) !=
+          static_cast<ssize_t>(sizeof(reply)) ||
+      memcmp(reply, expected_reply, sizeof(expected_reply)) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int socks5_client_connect(int sockfd, const struct sockaddr* addr,
+                          bool is_greeted) {
   // To simplify the IO of the handshake process, we simply stuff everything we
   // want to send to server and send all at once.
   // Ref: https://datatracker.ietf.org/doc/html/rfc1928
   // out_buffer here will contain a client greeting declaring only supporting
-  // one auth method "no auth",
+  // one auth method "no auth", unless the greeting is already done by
+  // socks5_client_greet(),
   //     +----+----------+----------+
   //     |VER | NMETHODS | METHODS  |
   //     +----+----------+----------+
@@ -359,6 +467,9 @@ int socks5_client_connect(int sockfd, const struct sockaddr* addr) {
   //      request VER ---------------------      |     |
   //      request CMD ---------------------------      |
   //      request RSV ---------------------------------
+  static constexpr size_t kGreetingSize = 3;
+  // Without the greeting, the request starts the buffer.
+  uint8_t* out_buffer = is_greeted ? &buffer[kGreetingSize] : buffer;
 
   size_t out_idx = 6;
   size_t copied = FillAddrPort(&buffer[out_idx], addr);
@@ -367,13 +478,14 @@ int socks5_client_connect(int sockfd, const struct sockaddr* addr) {
   }
   out_idx += copied;
 
-  size_t out_size = out_idx;
-  ssize_t ret = send(sockfd, buffer, out_size, 0);
+  size_t out_size = out_idx - (out_buffer - buffer);
+  ssize_t ret = send(sockfd, out_buffer, out_size, 0);
   if (ret != static_cast<ssize_t>(out_size)) {
     return -1;
   }
 
-  // Two messages has been sent. Receive replies now. Method selection reply:
+  // Two messages has been sent. Receive replies now. Method selection reply,
+  // unless the greeting is already done:
   //     +----+--------+
   //     |VER | METHOD |
   //     +----+--------+
@@ -386,34 +498,42 @@ int socks5_client_connect(int sockfd, const struct sockaddr* addr) {
   //     | 1  |  1  | X'00' |  1   | Variable |    2     |
   //     +----+-----+-------+------+----------+----------+
 
-  static const uint8_t expected_reply[] = {0x05, 0x00, 0x05, 0x00, 0x00};
-  //                                        |     |     |     |     |
-  //                                VER ----      |     |     |     |
-  //                             METHOD ----------      |     |     |
-  //                                VER ----------------      |     |
-  //                                REP ----------------------      |
-  //                                RSV ----------------------------
+  static const uint8_t full_expected_reply[] = {0x05, 0x00, 0x05, 0x00, 0x00};
+  //                                             |     |     |     |     |
+  //                                     VER ----      |     |     |     |
+  //                                  METHOD ----------      |     |     |
+  //                                     VER ----------------      |     |
+  //                                     REP ----------------------      |
+  //                                     RSV ----------------------------
+  static constexpr size_t kGreetingReplySize = 2;
+  const uint8_t* expected_reply =
+      is_greeted ? &full_expected_reply[kGreetingReplySize]
+                 : full_expected_reply;
+  size_t expected_reply_size =
+      sizeof(full_expected_reply) - (expected_reply - full_expected_reply);
+  // The REP byte is the 2nd byte of the connection request reply.
+  size_t rep_idx = expected_reply_size - 2;
 
   // Reuse buffer here. Recv 2 more bytes to reveal the ATYP byte, and
   // potentially the length byte if the bound address is a domain name (see
   // DST.ADDR definition from rfc1928).
-  ssize_t to_receive = sizeof(expected_reply) + 2;
+  ssize_t to_receive = expected_reply_size + 2;
   ssize_t received = recv_all(sockfd, buffer, to_receive, 0);
   if (received != to_receive) {
     // Not enough data received. No way to proceed.
     return -1;
   }
-  if (memcmp(buffer, expected_reply, sizeof(expected_reply)) != 0) {
+  if (memcmp(buffer, expected_reply, expected_reply_size) != 0) {
     // Some error received. If there's a REP byte indicating errors, return the
     // REP byte inverted.
-    if (buffer[3] != 0) {
-      return -buffer[3];
+    if (buffer[rep_idx] != 0) {
+      return -buffer[rep_idx];
     } else {
       return -1;
     }
   }
-  uint8_t atyp = buffer[sizeof(expected_reply)];
-  uint8_t extra_byte = buffer[sizeof(expected_reply) + 1];
+  uint8_t atyp = buffer[expected_reply_size];
+  uint8_t extra_byte = buffer[expected_reply_size + 1];
   if (atyp == 0x01) {
     // IPv4. 4-byte addr, 2-byte port, and we've already recv'd 1 byte extra.
     to_receive = 4 + 2 - 1;
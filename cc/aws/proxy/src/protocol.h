@@ -23,8 +23,20 @@ static constexpr char kParentCidEnv[] = "PROXY_PARENT_CID";
 static constexpr char kParentPortEnv[] = "PROXY_PARENT_PORT";
 static constexpr unsigned int kDefaultParentCid = 3;
 static constexpr unsigned int kDefaultParentPort = 8888;
+// The number of connections to the proxy the preload library keeps past the
+// SOCKS5 greeting, for connect() to claim. 0 disables the pool.
+static constexpr char kWarmPoolSizeEnv[] = "PROXY_WARM_POOL_SIZE";
+static constexpr unsigned int kDefaultWarmPoolSize = 4;
+
+// When set to non-zero, connect() carries the connections as streams of the
+// mux client, which multiplexes them over a few connections to the proxy.
+static constexpr char kMuxEnabledEnv[] = "PROXY_MUX";
+// The number of multiplexed connections the mux client keeps to the proxy.
+static constexpr char kMuxConnectionsEnv[] = "PROXY_MUX_CONNECTIONS";
+static constexpr unsigned int kDefaultMuxConnections = 4;
 
 static constexpr char kSocketVendorUdsPath[] = "/tmp/socket_vendor.sock";
+static constexpr char kMuxClientUdsPath[] = "/tmp/proxy_mux.sock";
 
 // Given a request/response, fill the address and port. Returns the number of
 // bytes copied into msg.
@@ -16,8 +16,19 @@
 
 #include "proxy_bridge.h"
 
+#include <netinet/in.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <chrono>
 #include <functional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/bind/bind.hpp>
@@ -49,12 +60,22 @@ ProxyBridge::~ProxyBridge() {
           "Destructing connection. UP = ", upstream_size_,
           ", DOWN = ", downstream_size_);
 #endif
+  Metrics().active_connections.Add(-1);
   error_code ec;
   client_sock_.close(ec);
   dest_sock_.close(ec);
+#ifdef __linux__
+  for (auto* pipe : {&upstream_pipe_, &downstream_pipe_}) {
+    if (pipe->active) {
+      close(pipe->read_fd);
+      close(pipe->write_fd);
+    }
+  }
+#endif  // __linux__
 }
 
 void ProxyBridge::PerformSocks5Handshake() {
+  handshake_start_ = std::chrono::steady_clock::now();
   // Start the handshake by reading the client first.
   auto buffer = upstream_buff_.ReserveAtLeast<mutable_buffer>(1);
   client_sock_.async_read_some(
@@ -73,6 +94,10 @@ void ProxyBridge::Socks5HandshakeHandler(const error_code& ec,
 
   while (socks5_state_.state() != Socks5State::kSuccess &&
          socks5_state_.Proceed(upstream_buff_)) {}
+  if (socks5_state_.Failed()) {
+    Metrics().handshake_failures_total.Add();
+    return;
+  }
   // If we need to read more data to proceed, schedule reading.
   if (socks5_state_.InsufficientBuffer(upstream_buff_)) {
     auto buffer = upstream_buff_.ReserveAtLeast<mutable_buffer>(1);
@@ -90,42 +115,63 @@ void ProxyBridge::Socks5HandshakeHandler(const error_code& ec,
 }
 
 void ProxyBridge::ForwardTraffic() {
+#ifdef __linux__
+  SpliceTraffic(upstream_pipe_, upstream_buff_, client_sock_, dest_sock_,
+                client_readable_, dest_writable_, reading_client_,
+                writing_dest_);
+  SpliceTraffic(downstream_pipe_, downstream_buff_, dest_sock_, client_sock_,
+                dest_readable_, client_writable_, reading_dest_,
+                writing_client_);
+  // The buffers are only read into when not splicing, and only written out to
+  // forward the data buffered before splicing.
+  bool buffer_upstream = !upstream_pipe_.enabled;
+  bool buffer_downstream = !downstream_pipe_.enabled;
+#else
+  constexpr bool buffer_upstream = true;
+  constexpr bool buffer_downstream = true;
+#endif  // __linux__
   // Now determine if we need to schedule IO operations.
-  if (!reading_client_ && client_readable_ && dest_writable_ &&
-      upstream_buff_.data_size() < kMaxBufferSize) {
-    auto buffer = upstream_buff_.ReserveAtLeast<mutable_buffer>(kReadSize);
+  if (buffer_upstream && !reading_client_ && client_readable_ &&
+      dest_writable_ && upstream_buff_.data_size() < kMaxBufferSize) {
+    size_t read_size = kReadSize;
+    size_t num_bufs = upstream_buff_.ReserveAtLeast(
+        read_size, upstream_read_bufs_.data(), kMaxSysBufs);
     reading_client_ = true;
     client_sock_.async_read_some(
-        buffer,
+        BufferSequence<mutable_buffer>{upstream_read_bufs_.data(), num_bufs},
         bind_executor(strand_, bind(&ProxyBridge::ClientReadHandler,
                                     shared_from_this(), placeholders::error,
                                     placeholders::bytes_transferred)));
   }
   if (!writing_client_ && client_writable_ &&
       downstream_buff_.data_size() > 0u) {
-    auto buffer = downstream_buff_.Peek<const_buffer>();
+    size_t num_bufs =
+        downstream_buff_.Peek(downstream_write_bufs_.data(), kMaxSysBufs);
     writing_client_ = true;
     client_sock_.async_write_some(
-        buffer,
+        BufferSequence<const_buffer>{downstream_write_bufs_.data(), num_bufs},
         bind_executor(strand_, bind(&ProxyBridge::ClientWriteHandler,
                                     shared_from_this(), placeholders::error,
                                     placeholders::bytes_transferred)));
   }
-  if (!reading_dest_ && dest_readable_ && client_writable_ &&
-      downstream_buff_.data_size() < kMaxBufferSize) {
-    auto buffer = downstream_buff_.ReserveAtLeast<mutable_buffer>(kReadSize);
+  if (buffer_downstream && !reading_dest_ && dest_readable_ &&
+      client_writable_ && downstream_buff_.data_size() < kMaxBufferSize) {
+    size_t read_size = kReadSize;
+    size_t num_bufs = downstream_buff_.ReserveAtLeast(
+        read_size, downstream_read_bufs_.data(), kMaxSysBufs);
     reading_dest_ = true;
     dest_sock_.async_read_some(
-        buffer,
+        BufferSequence<mutable_buffer>{downstream_read_bufs_.data(), num_bufs},
         bind_executor(strand_, bind(&ProxyBridge::DestReadHandler,
                                     shared_from_this(), placeholders::error,
                                     placeholders::bytes_transferred)));
   }
   if (!writing_dest_ && dest_writable_ && upstream_buff_.data_size() > 0u) {
-    auto buffer = upstream_buff_.Peek<const_buffer>();
+    size_t num_bufs =
+        upstream_buff_.Peek(upstream_write_bufs_.data(), kMaxSysBufs);
     writing_dest_ = true;
     dest_sock_.async_write_some(
-        buffer,
+        BufferSequence<const_buffer>{upstream_write_bufs_.data(), num_bufs},
         bind_executor(strand_, bind(&ProxyBridge::DestWriteHandler,
                                     shared_from_this(), placeholders::error,
                                     placeholders::bytes_transferred)));
@@ -135,6 +181,10 @@ void ProxyBridge::ForwardTraffic() {
 void ProxyBridge::ClientReadHandler(const error_code& ec, size_t bytes_read) {
   reading_client_ = false;
   upstream_buff_.Commit(bytes_read);
+  Metrics().buffer_high_water_bytes.Record(upstream_buff_.data_size());
+  if (upstream_buff_.data_size() >= kMaxBufferSize) {
+    Metrics().buffer_full_total.Add();
+  }
   if (ec.failed()) {
     if (ec == eof) {
       LogInfo("[", connection_id_, "]",
@@ -156,6 +206,7 @@ void ProxyBridge::ClientWriteHandler(const error_code& ec,
                                      size_t bytes_written) {
   writing_client_ = false;
   downstream_buff_.Drain(bytes_written);
+  Metrics().downstream_bytes_total.Add(bytes_written);
 #ifndef NDEBUG
   downstream_size_ += bytes_written;
 #endif
@@ -176,6 +227,10 @@ void ProxyBridge::ClientWriteHandler(const error_code& ec,
 void ProxyBridge::DestReadHandler(const error_code& ec, size_t bytes_read) {
   reading_dest_ = false;
   downstream_buff_.Commit(bytes_read);
+  Metrics().buffer_high_water_bytes.Record(downstream_buff_.data_size());
+  if (downstream_buff_.data_size() >= kMaxBufferSize) {
+    Metrics().buffer_full_total.Add();
+  }
   if (ec.failed()) {
     if (ec == eof) {
       LogInfo("[", connection_id_, "]",
@@ -196,6 +251,7 @@ void ProxyBridge::DestReadHandler(const error_code& ec, size_t bytes_read) {
 void ProxyBridge::DestWriteHandler(const error_code& ec, size_t bytes_written) {
   writing_dest_ = false;
   upstream_buff_.Drain(bytes_written);
+  Metrics().upstream_bytes_total.Add(bytes_written);
 #ifndef NDEBUG
   upstream_size_ += bytes_written;
 #endif
@@ -213,18 +269,184 @@ void ProxyBridge::DestWriteHandler(const error_code& ec, size_t bytes_written) {
   ForwardTraffic();
 }
 
+#ifdef __linux__
+void ProxyBridge::SpliceTraffic(SplicePipe& pipe, const Buffer& buff,
+                                Socket& src, Socket& dst, bool& src_readable,
+                                bool& dst_writable, bool& reading_src,
+                                bool& writing_dst) {
+  if (!pipe.active) {
+    // Wait for the buffered data to be forwarded first.
+    if (!pipe.enabled || buff.data_size() > 0u || reading_src ||
+        writing_dst || !src_readable || !dst_writable) {
+      return;
+    }
+    if (!StartSplicing(pipe, src, dst)) {
+      pipe.enabled = false;
+      return;
+    }
+  }
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    if (src_readable && !reading_src && pipe.data_size < pipe.capacity) {
+      ssize_t n = splice(src.native_handle(), nullptr, pipe.write_fd, nullptr,
+                         pipe.capacity - pipe.data_size,
+                         SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n > 0) {
+        pipe.data_size += n;
+        pipe.spliced = true;
+        progress = true;
+      } else if (n == 0) {
+        LogInfo("[", connection_id_, "]",
+                "Connection successfully closed by peer.");
+        src_readable = false;
+      } else if (errno == EAGAIN) {
+        reading_src = true;
+        src.async_wait(Socket::wait_read,
+                       bind_executor(strand_,
+                                     bind(&ProxyBridge::SpliceWaitHandler,
+                                          shared_from_this(), &reading_src,
+                                          &src_readable, placeholders::error)));
+      } else if (errno == EINTR) {
+        progress = true;
+      } else if (!pipe.spliced && (errno == EINVAL || errno == EOPNOTSUPP)) {
+        // The socket does not support splicing, forward through the buffer.
+        LogInfo("[", connection_id_, "]", "Splicing unsupported, fall back.");
+        close(pipe.read_fd);
+        close(pipe.write_fd);
+        pipe.active = false;
+        pipe.enabled = false;
+        return;
+      } else {
+        LogError("[", connection_id_, "]", "Splice read failed with error ",
+                 errno);
+        src_readable = false;
+      }
+    }
+    if (dst_writable && !writing_dst && pipe.data_size > 0u) {
+      ssize_t n = splice(pipe.read_fd, nullptr, dst.native_handle(), nullptr,
+                         pipe.data_size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n > 0) {
+        pipe.data_size -= n;
+        (&pipe == &upstream_pipe_ ? Metrics().upstream_bytes_total
+                                  : Metrics().downstream_bytes_total)
+            .Add(n);
+#ifndef NDEBUG
+        (&pipe == &upstream_pipe_ ? upstream_size_ : downstream_size_) += n;
+#endif
+        progress = true;
+      } else if (n < 0 && errno == EAGAIN) {
+        writing_dst = true;
+        dst.async_wait(Socket::wait_write,
+                       bind_executor(strand_,
+                                     bind(&ProxyBridge::SpliceWaitHandler,
+                                          shared_from_this(), &writing_dst,
+                                          &dst_writable, placeholders::error)));
+      } else if (n < 0 && errno == EINTR) {
+        progress = true;
+      } else {
+        LogError("[", connection_id_, "]", "Splice write failed with error ",
+                 errno);
+        dst_writable = false;
+      }
+    }
+  }
+  error_code shutdown_ec;
+  if (!dst_writable && src_readable) {
+    // Nothing more can be forwarded.
+    src.shutdown(Socket::shutdown_receive, shutdown_ec);
+    src_readable = false;
+  }
+  if (!src_readable && dst_writable && pipe.data_size == 0u) {
+    dst.shutdown(Socket::shutdown_send, shutdown_ec);
+    dst_writable = false;
+  }
+}
+
+bool ProxyBridge::StartSplicing(SplicePipe& pipe, Socket& src, Socket& dst) {
+  int fds[2];
+  if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return false;
+  }
+  // A larger pipe moves more data per splice() call. It is fine to keep the
+  // default size if the limit of the system is lower.
+  fcntl(fds[1], F_SETPIPE_SZ, kMaxBufferSize);
+  int capacity = fcntl(fds[1], F_GETPIPE_SZ);
+  error_code ec;
+  src.native_non_blocking(true, ec);
+  if (!ec.failed()) {
+    dst.native_non_blocking(true, ec);
+  }
+  if (capacity <= 0 || ec.failed()) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  pipe.read_fd = fds[0];
+  pipe.write_fd = fds[1];
+  pipe.capacity = capacity;
+  pipe.active = true;
+  return true;
+}
+
+void ProxyBridge::SpliceWaitHandler(bool* waiting, bool* ready,
+                                    const error_code& ec) {
+  *waiting = false;
+  if (ec.failed()) {
+    *ready = false;
+  }
+  ForwardTraffic();
+}
+#endif  // __linux__
+
 void ProxyBridge::ConnectHandler(const error_code& ec) {
   if (ec.failed()) {
     // TODO: log
+    Metrics().connect_failures_total.Add();
     return;
   }
+  Metrics().connect_seconds.Observe(std::chrono::steady_clock::now() -
+                                    connect_start_);
   if (socks5_state_.ConnectionSucceed()) {
     ForwardTraffic();
   }
 }
 
+void ProxyBridge::ResolveHandler(const error_code& ec,
+                                 const std::vector<Endpoint>& endpoints,
+                                 uint16_t port) {
+  if (ec.failed()) {
+    LogError("[", connection_id_, "]", "Cannot resolve destination: ",
+             ec.message());
+    Metrics().connect_failures_total.Add();
+    return;
+  }
+  std::vector<Endpoint> dest_endpoints(endpoints);
+  for (auto& endpoint : dest_endpoints) {
+    if (endpoint.data()->sa_family == AF_INET) {
+      reinterpret_cast<sockaddr_in*>(endpoint.data())->sin_port = htons(port);
+    } else {
+      reinterpret_cast<sockaddr_in6*>(endpoint.data())->sin6_port =
+          htons(port);
+    }
+  }
+  // Try the addresses in order, until one is connected.
+  boost::asio::async_connect(
+      dest_sock_, dest_endpoints,
+      bind_executor(strand_, [self = shared_from_this()](
+                                 const error_code& ec, const Endpoint&) {
+        self->ConnectHandler(ec);
+      }));
+}
+
+void ProxyBridge::RecordConnectStart() {
+  connect_start_ = std::chrono::steady_clock::now();
+  Metrics().handshake_seconds.Observe(connect_start_ - handshake_start_);
+}
+
 void ProxyBridge::SetSocks5StateCallbacks() {
   socks5_state_.SetConnectCallback([this](const sockaddr* addr, size_t size) {
+    RecordConnectStart();
     Endpoint endpoint(addr, size);
     dest_sock_.async_connect(
         endpoint, bind_executor(strand_, bind(&ProxyBridge::ConnectHandler,
@@ -233,6 +455,21 @@ void ProxyBridge::SetSocks5StateCallbacks() {
     return Socks5State::kStatusInProgress;
   });
 
+  if (dns_cache_ != nullptr) {
+    socks5_state_.SetConnectDomainCallback([this](const std::string& domain,
+                                                  uint16_t port) {
+      RecordConnectStart();
+      dns_cache_->Resolve(domain, [self = shared_from_this(), port](
+                                      const error_code& ec,
+                                      const DnsCache::Endpoints& endpoints) {
+        boost::asio::post(self->strand_, [self, ec, endpoints, port]() {
+          self->ResolveHandler(ec, endpoints, port);
+        });
+      });
+      return Socks5State::kStatusInProgress;
+    });
+  }
+
   socks5_state_.SetResponseCallback([this](const void* data, size_t len) {
     // The responses are supposed to be tiny and we should expect this succeeds
     // immediately.
@@ -18,16 +18,21 @@
 
 #include <stdint.h>
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
 
 #include "acceptor_pool.h"
 #include "buffer.h"
+#include "dns_cache.h"
 #include "logging.h"
+#include "metrics.h"
 #include "socket_types.h"
 #include "socks5_state.h"
 
@@ -40,13 +45,17 @@ class ProxyBridge : public std::enable_shared_from_this<ProxyBridge> {
  public:
   static constexpr size_t kMaxBufferSize = 1024 * 1024;
   static constexpr size_t kReadSize = 64 * 1024;
+  // The max blocks of a buffer read into, or written out, with one syscall.
+  static constexpr size_t kMaxSysBufs = 16;
 
   // Construct a ProxyBridge with a connected client socket. SocketType can be
   // any stream socket implementation of boost::asio.
+  // Domain names are only accepted in CONNECT requests with a dns_cache.
   template <typename SocketType>
   explicit ProxyBridge(
       SocketType client_sock, AcceptorPool* acceptor_pool = nullptr,
-      const std::shared_ptr<Freelist<Buffer::Block>>& freelist = nullptr)
+      const std::shared_ptr<Freelist<Buffer::Block>>& freelist = nullptr,
+      DnsCache* dns_cache = nullptr)
       : connection_id_(connection_id_counter.fetch_add(1)),
         strand_(client_sock.get_executor()),
         client_sock_(std::move(client_sock)),
@@ -57,7 +66,10 @@ class ProxyBridge : public std::enable_shared_from_this<ProxyBridge> {
         upstream_size_(0ul),
         downstream_size_(0ul),
 #endif
-        acceptor_pool_(acceptor_pool) {
+        acceptor_pool_(acceptor_pool),
+        dns_cache_(dns_cache) {
+    Metrics().connections_total.Add();
+    Metrics().active_connections.Add();
     SetSocks5StateCallbacks();
   }
 
@@ -79,6 +91,8 @@ class ProxyBridge : public std::enable_shared_from_this<ProxyBridge> {
         downstream_size_(0ul),
 #endif
         acceptor_pool_(acceptor_pool) {
+    Metrics().connections_total.Add();
+    Metrics().active_connections.Add();
     SetSocks5StateCallbacks();
   }
 
@@ -94,9 +108,16 @@ class ProxyBridge : public std::enable_shared_from_this<ProxyBridge> {
   // To be called when async connect to destination completes.
   void ConnectHandler(const boost::system::error_code& ec);
 
+  // To be called when the domain name of the destination is resolved.
+  void ResolveHandler(const boost::system::error_code& ec,
+                      const std::vector<Endpoint>& endpoints, uint16_t port);
+
   // Set the callback hooks for Socks5State.
   void SetSocks5StateCallbacks();
 
+  // Record the end of the handshake and the start of the connect.
+  void RecordConnectStart();
+
   // Schedule async IO operations for forwarding the traffic.
   void ForwardTraffic();
 
@@ -120,6 +141,51 @@ class ProxyBridge : public std::enable_shared_from_this<ProxyBridge> {
   void StopWaitingInbound(bool client_error = true);
 
  private:
+  // A view of the first count elements of an array of asio buffers, so that
+  // the buffers of an IO operation need no allocating vector.
+  template <typename BufferType>
+  struct BufferSequence {
+    const BufferType* begin() const { return bufs; }
+    const BufferType* end() const { return bufs + count; }
+
+    const BufferType* bufs;
+    size_t count;
+  };
+
+#ifdef __linux__
+  // The pipe through which one direction of the traffic is spliced from one
+  // socket to the other, without copying it through user space.
+  struct SplicePipe {
+    int read_fd = -1;
+    int write_fd = -1;
+    size_t capacity = 0;
+    // The number of bytes in the pipe.
+    size_t data_size = 0;
+    // Whether the direction is to be spliced, false once splicing fails to
+    // start, in which case the direction is forwarded through the buffer.
+    bool enabled = true;
+    // Whether the direction is being spliced.
+    bool active = false;
+    // Whether any byte was spliced.
+    bool spliced = false;
+  };
+
+  // Splice one direction of the traffic once the data buffered for it is
+  // forwarded. The reading and writing flags are set while waiting for the
+  // sockets to be ready.
+  void SpliceTraffic(SplicePipe& pipe, const Buffer& buff, Socket& src,
+                     Socket& dst, bool& src_readable, bool& dst_writable,
+                     bool& reading_src, bool& writing_dst);
+  // Start splicing a direction. Returns false if it is not supported.
+  bool StartSplicing(SplicePipe& pipe, Socket& src, Socket& dst);
+  // The handler for waiting a socket to be ready while splicing.
+  void SpliceWaitHandler(bool* waiting, bool* ready,
+                         const boost::system::error_code& ec);
+
+  SplicePipe upstream_pipe_;
+  SplicePipe downstream_pipe_;
+#endif  // __linux__
+
   static std::atomic<uint64_t> connection_id_counter;
   const uint64_t connection_id_;
 
@@ -134,14 +200,23 @@ class ProxyBridge : public std::enable_shared_from_this<ProxyBridge> {
   Buffer upstream_buff_;
   // The buffer that is read from destination and written to the client.
   Buffer downstream_buff_;
+  // The buffers of the reads and writes in flight, one array per operation.
+  std::array<boost::asio::mutable_buffer, kMaxSysBufs> upstream_read_bufs_;
+  std::array<boost::asio::const_buffer, kMaxSysBufs> upstream_write_bufs_;
+  std::array<boost::asio::mutable_buffer, kMaxSysBufs> downstream_read_bufs_;
+  std::array<boost::asio::const_buffer, kMaxSysBufs> downstream_write_bufs_;
   // The socks5 handshake state.
   Socks5State socks5_state_;
 #ifndef NDEBUG  // Record the number of bytes in debug mode.
   size_t upstream_size_;
   size_t downstream_size_;
 #endif
+  // When the handshake started, and when the destination was requested.
+  std::chrono::steady_clock::time_point handshake_start_;
+  std::chrono::steady_clock::time_point connect_start_;
   boost::asio::cancellation_signal cancel_signal_;
   AcceptorPool* acceptor_pool_;
+  DnsCache* dns_cache_ = nullptr;
   // Flags indicating the state of the proxy connection. We only have 8 of them,
   // so we are using discrete bool instead of a bit field uint64_t. If more
   // flags are needed, we may consider compacting them into a uint32/64_t.
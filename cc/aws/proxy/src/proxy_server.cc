@@ -35,27 +35,58 @@
 
 #include <boost/asio.hpp>
 
+#include "freelist.h"
+#include "io_uring.h"
 #include "logging.h"
+#include "metrics.h"
+#include "mux_protocol.h"
+#include "mux_session.h"
 #include "proxy_bridge.h"
 #include "socket_types.h"
 
+using boost::system::error_code;
+using std::lock_guard;
 using std::make_shared;
+using std::make_unique;
 using std::shared_lock;
 using std::shared_ptr;
 using std::string;
 using std::thread;
 using std::to_string;
+using std::unique_ptr;
 using std::unique_lock;
 using std::vector;
 
 using namespace boost::asio;  // NOLINT
 
 namespace google::scp::proxy {
+namespace {
+// Own object by a shared_ptr, which also holds a reference to load, if any.
+template <typename T>
+shared_ptr<T> WithLoad(T* object, shared_ptr<void> load) {
+  if (!load) {
+    return shared_ptr<T>(object);
+  }
+  return shared_ptr<T>(object,
+                       [load = std::move(load)](T* object) { delete object; });
+}
+}  // namespace
 
 ProxyServer::ProxyServer(const Config& config)
     : acceptor_(io_context_),
+      freelist_(make_shared<Freelist<Buffer::Block>>(/*use_arena=*/true)),
+      dns_cache_(io_context_.get_executor()),
+      stats_timer_(io_context_),
       port_(config.socks5_port_),
-      vsock_(config.vsock_) {}
+      vsock_(config.vsock_),
+      io_uring_(config.io_uring_),
+      context_per_thread_(config.context_per_thread_) {
+  if (config.metrics_port_ != 0) {
+    metrics_server_ = make_unique<MetricsServer>(
+        io_context_, config.metrics_port_,
+        [this](string& out) { RenderMetrics(out); });
+  }
+}
 
 void ProxyServer::BindListen() {
   if (vsock_) {
@@ -95,20 +126,156 @@ void ProxyServer::BindListen() {
       port_ = ntohs(addr->sin6_port);
     }
   }
+  if (metrics_server_) {
+    metrics_server_->Listen();
+    LogInfo("Serving metrics on port ", metrics_server_->Port());
+  }
 }
 
 void ProxyServer::StartAsyncAccept() {
   acceptor_.async_accept([this](boost::system::error_code ec, Socket socket) {
     StartAsyncAccept();
     if (!ec) {
-      auto bridge =
-          make_shared<ProxyBridge>(std::move(socket), &acceptor_pool_);
-      bridge->PerformSocks5Handshake();
+      // Wait for the first byte to tell a multiplexed connection from a
+      // dedicated one.
+      auto sock = make_shared<Socket>(std::move(socket));
+      sock->async_wait(Socket::wait_read, [this, sock](error_code ec) {
+        if (!ec) {
+          HandleConnection(std::move(*sock));
+        }
+      });
+    }
+  });
+}
+
+void ProxyServer::StartBalancedAccept() {
+  WorkerContext* target = contexts_[0].get();
+  for (auto& context : contexts_) {
+    if (context->connections.load(std::memory_order_relaxed) <
+        target->connections.load(std::memory_order_relaxed)) {
+      target = context.get();
+    }
+  }
+  auto sock = make_shared<Socket>(target->io_context);
+  acceptor_.async_accept(*sock, [this, sock, target](error_code ec) {
+    if (ec == error::operation_aborted) {
+      return;
+    }
+    if (ec.failed()) {
+      StartBalancedAccept();
+      return;
+    }
+    // Count the connection before picking the context of the next one.
+    target->connections.fetch_add(1, std::memory_order_relaxed);
+    shared_ptr<void> load(&target->connections, [](std::atomic<int64_t>* n) {
+      n->fetch_sub(1, std::memory_order_relaxed);
+    });
+    StartBalancedAccept();
+    sock->async_wait(Socket::wait_read, [this, sock, load](error_code ec) {
+      if (!ec) {
+        HandleConnection(std::move(*sock), load);
+      }
+    });
+  });
+}
+
+void ProxyServer::HandleConnection(Socket socket, shared_ptr<void> load) {
+  uint8_t first_byte = 0;
+  error_code ec;
+  size_t bytes_read = socket.receive(buffer(&first_byte, 1),
+                                     socket_base::message_peek, ec);
+  if (ec.failed() || bytes_read == 0) {
+    return;
+  }
+  if (first_byte != mux::kPreface[0]) {
+    auto bridge = WithLoad(new ProxyBridge(std::move(socket), &acceptor_pool_,
+                                           freelist_, &dns_cache_),
+                           load);
+    bridge->PerformSocks5Handshake();
+    return;
+  }
+  // Each stream is served like a dedicated connection.
+  auto session = WithLoad(
+      new MuxSession(std::move(socket),
+                     [this, load](Socket stream_sock) {
+                       auto bridge = WithLoad(
+                           new ProxyBridge(std::move(stream_sock),
+                                           &acceptor_pool_, freelist_,
+                                           &dns_cache_),
+                           load);
+                       bridge->PerformSocks5Handshake();
+                     }),
+      load);
+  session->Start();
+}
+
+void ProxyServer::StartStatsTimer() {
+  stats_timer_.expires_after(kStatsInterval);
+  stats_timer_.async_wait([this](error_code ec) {
+    if (ec.failed()) {
+      return;
     }
+    auto stats = BufferStats();
+    LogInfo("Buffer blocks: ", stats.allocated_blocks, " allocated, ",
+            stats.free_blocks, " free. Arena: ", stats.arena_bytes,
+            " bytes mapped, ", stats.huge_page_bytes, " on huge pages.");
+    StartStatsTimer();
   });
 }
 
+void ProxyServer::RenderMetrics(string& out) const {
+  Metrics().Render(out);
+  auto buffer_stats = BufferStats();
+  RenderMetric(out, "proxy_buffer_allocated_blocks", "gauge",
+               "Buffer blocks allocated, in use or free.",
+               buffer_stats.allocated_blocks);
+  RenderMetric(out, "proxy_buffer_free_blocks", "gauge",
+               "Buffer blocks in the freelist.", buffer_stats.free_blocks);
+  RenderMetric(out, "proxy_buffer_arena_bytes", "gauge",
+               "Bytes mapped for buffer blocks.", buffer_stats.arena_bytes);
+  auto dns_stats = dns_cache_.GetStats();
+  RenderMetric(out, "proxy_dns_cache_hits_total", "counter",
+               "Domain names resolved from the cache.", dns_stats.hits);
+  RenderMetric(out, "proxy_dns_cache_misses_total", "counter",
+               "Domain names waiting for a resolution.", dns_stats.misses);
+  auto worker_connections = WorkerConnections();
+  if (worker_connections.empty()) {
+    return;
+  }
+  out.append("# HELP proxy_worker_connections Connections handed to each "
+             "worker context.\n");
+  out.append("# TYPE proxy_worker_connections gauge\n");
+  for (size_t i = 0; i < worker_connections.size(); ++i) {
+    out.append("proxy_worker_connections{worker=\"")
+        .append(to_string(i))
+        .append("\"} ")
+        .append(to_string(worker_connections[i]))
+        .append("\n");
+  }
+}
+
+vector<int64_t> ProxyServer::WorkerConnections() const {
+  lock_guard<std::mutex> lock(workers_mutex_);
+  vector<int64_t> worker_connections;
+  worker_connections.reserve(contexts_.size());
+  for (auto& context : contexts_) {
+    worker_connections.push_back(
+        context->connections.load(std::memory_order_relaxed));
+  }
+  return worker_connections;
+}
+
 void ProxyServer::Stop() {
+  {
+    lock_guard<std::mutex> lock(workers_mutex_);
+    stopped_ = true;
+    for (auto* worker : workers_) {
+      worker->Stop();
+    }
+    for (auto& context : contexts_) {
+      context->io_context.stop();
+    }
+  }
   io_context_.stop();
 }
 
@@ -116,6 +283,17 @@ void ProxyServer::Run(size_t concurrency) {
   if (concurrency == 0) {
     concurrency = std::thread::hardware_concurrency();
   }
+  StartStatsTimer();
+  if (io_uring_) {
+    if (IoUring::IsSupported() && RunUringWorkers(concurrency)) {
+      return;
+    }
+    LogInfo("io_uring is unavailable, using epoll instead.");
+  }
+  if (context_per_thread_) {
+    RunWorkerContexts(concurrency);
+    return;
+  }
   StartAsyncAccept();
   vector<thread> threads;
   threads.reserve(concurrency);
@@ -130,4 +308,68 @@ void ProxyServer::Run(size_t concurrency) {
   }
 }
 
+void ProxyServer::RunWorkerContexts(size_t concurrency) {
+  {
+    lock_guard<std::mutex> lock(workers_mutex_);
+    if (stopped_) {
+      return;
+    }
+    for (auto i = 0u; i < concurrency; ++i) {
+      contexts_.push_back(make_unique<WorkerContext>());
+    }
+  }
+  vector<thread> threads;
+  threads.reserve(concurrency);
+  for (auto i = 0u; i < concurrency; ++i) {
+    threads.emplace_back([&context = *contexts_[i]]() {
+      auto work = make_work_guard(context.io_context);
+      context.io_context.run();
+    });
+    string name = string("worker_") + to_string(i);
+    pthread_setname_np(threads[i].native_handle(), name.c_str());
+  }
+  // Accepting, the timers and name resolution run on io_context_.
+  StartBalancedAccept();
+  io_context_.run();
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+bool ProxyServer::RunUringWorkers(size_t concurrency) {
+  vector<unique_ptr<UringProxyWorker>> workers;
+  for (auto i = 0u; i < concurrency; ++i) {
+    auto worker =
+        make_unique<UringProxyWorker>(acceptor_.native_handle(), freelist_);
+    if (!worker->Init()) {
+      return false;
+    }
+    workers.push_back(std::move(worker));
+  }
+  {
+    lock_guard<std::mutex> lock(workers_mutex_);
+    if (stopped_) {
+      return true;
+    }
+    for (auto& worker : workers) {
+      workers_.push_back(worker.get());
+    }
+  }
+  vector<thread> threads;
+  threads.reserve(concurrency);
+  for (auto i = 0u; i < concurrency; ++i) {
+    threads.emplace_back([&worker = *workers[i]]() { worker.Run(); });
+    string name = string("worker_") + to_string(i);
+    pthread_setname_np(threads[i].native_handle(), name.c_str());
+  }
+  // Only the stats timer runs on the io_context, until Stop().
+  io_context_.run();
+  for (auto& t : threads) {
+    t.join();
+  }
+  lock_guard<std::mutex> lock(workers_mutex_);
+  workers_.clear();
+  return true;
+}
+
 }  // namespace google::scp::proxy
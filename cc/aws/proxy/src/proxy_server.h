@@ -18,23 +18,35 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 
 #include "acceptor_pool.h"
+#include "buffer.h"
 #include "config.h"
+#include "dns_cache.h"
+#include "freelist.h"
+#include "metrics_server.h"
 #include "proxy_bridge.h"
 #include "socket_types.h"
+#include "uring_proxy_worker.h"
 
 namespace google::scp::proxy {
 class ProxyServer {
  public:
+  static constexpr auto kStatsInterval = std::chrono::minutes(10);
+
   explicit ProxyServer(const Config& config);
 
-  // Bind and listen on the port.
+  // Bind and listen on the port, and the metrics port if any.
   void BindListen();
   // Blocking run the proxy. This is intended to be called as a thread.
   void Run(size_t concurrency = 0);
@@ -44,16 +56,65 @@ class ProxyServer {
 
   uint16_t Port() const { return port_; }
 
+  // The memory usage of the buffers of all the connections.
+  Freelist<Buffer::Block>::Stats BufferStats() const {
+    return freelist_->GetStats();
+  }
+
+  // The number of connections handed to each worker context and not closed
+  // yet. Empty unless the connections are served on worker contexts.
+  std::vector<int64_t> WorkerConnections() const;
+
   // Handle a BIND command from a client socket. This essentially
   void HandleBind(uint16_t port, std::shared_ptr<ProxyBridge> bridge);
 
  private:
   void StartAsyncAccept();
+  // Log BufferStats() every kStatsInterval.
+  void StartStatsTimer();
+  // Append Metrics(), BufferStats(), the DNS cache stats and the load of the
+  // worker contexts to out.
+  void RenderMetrics(std::string& out) const;
+  // An io_context served by one thread, with the number of connections handed
+  // to it and not closed yet.
+  struct WorkerContext {
+    std::atomic<int64_t> connections{0};
+    boost::asio::io_context io_context{1};
+  };
+
+  // Accept the next connection onto the WorkerContext serving the fewest.
+  void StartBalancedAccept();
+  // Serve an accepted connection, either dedicated to one client connection,
+  // or multiplexing many, see mux_protocol.h. Each object serving it holds a
+  // reference to load, if any, until destroyed.
+  void HandleConnection(Socket socket, std::shared_ptr<void> load = nullptr);
+  // Serve the connections on one WorkerContext per thread.
+  void RunWorkerContexts(size_t concurrency);
+  // Serve the connections with one UringProxyWorker per thread. Returns false
+  // if the workers cannot be set up.
+  bool RunUringWorkers(size_t concurrency);
+  // The worker contexts, if any. Declared before io_context_, so that they
+  // outlive the sockets of the pending accepts.
+  std::vector<std::unique_ptr<WorkerContext>> contexts_;
   boost::asio::io_context io_context_;
   Acceptor acceptor_;
   // The acceptor pool for handling BIND requests.
   AcceptorPool acceptor_pool_;
+  // The blocks shared by the buffers of all the connections.
+  std::shared_ptr<Freelist<Buffer::Block>> freelist_;
+  // Resolves the domain names requested by all the connections.
+  DnsCache dns_cache_;
+  boost::asio::steady_timer stats_timer_;
+  // The server of the metrics, if a metrics port is configured.
+  std::unique_ptr<MetricsServer> metrics_server_;
   uint16_t port_;
   const bool vsock_;
+  const bool io_uring_;
+  // The running io_uring workers or worker contexts, and whether Stop() was
+  // called.
+  mutable std::mutex workers_mutex_;
+  std::vector<UringProxyWorker*> workers_;
+  bool stopped_ = false;
+  const bool context_per_thread_;
 };
 }  // namespace google::scp::proxy
@@ -21,6 +21,7 @@
 #include <sys/socket.h>
 
 #include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -146,9 +147,13 @@ bool Socks5State::Proceed(Buffer& buffer) {
           state_ = Socks5State::kRequestAddrV4;
           required_size_ = 6;  // 4-byte IPv4 address, 2-byte port
         } else if (atyp == 0x03) {
-          LogError("Unsupported ATYP: 0x03(fqdn)");
-          state_ = Socks5State::kFail;
-          break;
+          if (!connect_domain_callback_) {
+            LogError("Unsupported ATYP: 0x03(fqdn)");
+            state_ = Socks5State::kFail;
+            break;
+          }
+          state_ = Socks5State::kRequestDomainLength;
+          required_size_ = 1;  // 1-byte length of the domain name
         } else if (atyp == 0x04) {
           state_ = Socks5State::kRequestAddrV6;
           required_size_ = 16 + 2;  // 16-byte IPv6 address, 2-byte port
@@ -238,6 +243,37 @@ bool Socks5State::Proceed(Buffer& buffer) {
       state_ = Socks5State::kFail;
       break;
     }
+    case Socks5State::kRequestDomainLength: {
+      uint8_t len = 0;
+      buffer.CopyOut(&len, sizeof(len));
+      if (len == 0) {
+        LogError("Malformed client request. Empty domain name.");
+        state_ = Socks5State::kFail;
+        break;
+      }
+      state_ = Socks5State::kRequestDomain;
+      required_size_ = len + 2;  // The domain name, 2-byte port
+      break;
+    }
+    case Socks5State::kRequestDomain: {
+      std::string domain(required_size_ - 2, '\0');
+      uint16_t port = 0;
+      buffer.CopyOut(domain.data(), domain.size());
+      buffer.CopyOut(&port, sizeof(port));
+      // No matter what, we require no more data from client.
+      required_size_ = 0;
+      auto ret = connect_domain_callback_(domain, ntohs(port));
+      if (ret == kStatusOK) {
+        state_ = Socks5State::kResponse;
+        break;
+      }
+      if (ret == kStatusInProgress) {
+        state_ = Socks5State::kWaitConnect;
+        return false;
+      }
+      state_ = Socks5State::kFail;
+      break;
+    }
     case Socks5State::kRequestBind: {
       uint16_t port = 0;
       // We don't care what address to bind, we'll bind to default [::] anyway.
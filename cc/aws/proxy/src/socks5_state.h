@@ -24,6 +24,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -45,6 +46,8 @@ class Socks5State {
     kRequestHeader,
     kRequestAddrV4,
     kRequestAddrV6,
+    kRequestDomainLength,
+    kRequestDomain,
     kRequestBind,
     kWaitConnect,
     kWaitAccept,
@@ -65,6 +68,10 @@ class Socks5State {
   // Callback to be called when we need to connect to destination.
   using ConnectCallback =
       std::function<CallbackStatus(const sockaddr*, size_t)>;
+  // Callback to be called when we need to connect to destination given by a
+  // domain name, which the application resolves. The port is in host order.
+  using ConnectDomainCallback =
+      std::function<CallbackStatus(const std::string& domain, uint16_t port)>;
   // Callback to be called when we need to obtain address to send in the final
   // response. remote indicate if we request to get the remote address or local
   // address on dest socket.
@@ -91,6 +98,12 @@ class Socks5State {
     connect_callback_ = std::move(callback);
   }
 
+  // Set the callback to be called when we need to connect to destination given
+  // by a domain name. Without it, such requests fail.
+  void SetConnectDomainCallback(ConnectDomainCallback callback) {
+    connect_domain_callback_ = std::move(callback);
+  }
+
   // Set the callback to be called when we need to obtain local address to send
   // in the final response.
   void SetDestAddressCallback(DestAddressCallback callback) {
@@ -136,6 +149,7 @@ class Socks5State {
 
   ResponseCallback response_callback_;
   ConnectCallback connect_callback_;
+  ConnectDomainCallback connect_domain_callback_;
   DestAddressCallback dest_address_callback_;
   BindCallback bind_callback_;
 
@@ -0,0 +1,572 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/uring_proxy_worker.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "proxy/src/logging.h"
+
+using std::make_unique;
+using std::min;
+using std::move;
+using std::shared_ptr;
+
+namespace google::scp::proxy {
+
+UringProxyWorker::UringProxyWorker(
+    int listen_fd, const shared_ptr<Freelist<Buffer::Block>>& freelist)
+    : listen_fd_(listen_fd), freelist_(freelist), running_(true) {}
+
+UringProxyWorker::~UringProxyWorker() {
+  for (auto& [ptr, conn] : connections_) {
+    close(conn->client_fd);
+    if (conn->dest_fd >= 0) {
+      close(conn->dest_fd);
+    }
+  }
+  // The connections hold no buffer past this point.
+  connections_.clear();
+  for (auto* block : buffers_) {
+    freelist_->Delete(block);
+  }
+  if (wake_fd_ >= 0) {
+    close(wake_fd_);
+  }
+}
+
+bool UringProxyWorker::Init() {
+  if (!ring_.Init(kRingEntries)) {
+    LogError("Cannot set up io_uring: ", strerror(errno));
+    return false;
+  }
+  wake_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (wake_fd_ < 0) {
+    LogError("Cannot create eventfd: ", strerror(errno));
+    return false;
+  }
+  buffers_.reserve(kNumBuffers);
+  for (unsigned int i = 0; i < kNumBuffers; ++i) {
+    auto* block = freelist_->New();
+    if (block == nullptr) {
+      return false;
+    }
+    buffers_.push_back(block);
+    ReturnBuffer(i);
+  }
+  return true;
+}
+
+void UringProxyWorker::Run() {
+  ArmAccept();
+  ArmWake();
+  while (running_.load()) {
+    int ret = ring_.Submit(1);
+    if (ret < 0 && ret != -EBUSY) {
+      LogError("io_uring_enter failed with error ", -ret);
+      break;
+    }
+    ring_.ForEachCompletion(
+        [this](const io_uring_cqe& cqe) { HandleCompletion(cqe); });
+  }
+}
+
+void UringProxyWorker::Stop() {
+  running_.store(false);
+  uint64_t value = 1;
+  if (write(wake_fd_, &value, sizeof(value)) < 0) {
+    LogError("Cannot wake io_uring worker: ", strerror(errno));
+  }
+}
+
+void UringProxyWorker::HandleCompletion(const io_uring_cqe& cqe) {
+  auto op = static_cast<Op>(cqe.user_data & kOpMask);
+  void* target = reinterpret_cast<void*>(cqe.user_data & ~kOpMask);
+  switch (op) {
+    case kAccept: {
+      HandleAccept(cqe);
+      return;
+    }
+    case kWake: {
+      if (running_.load()) {
+        ArmWake();
+      }
+      return;
+    }
+    case kRecv: {
+      auto& dir = *static_cast<Direction*>(target);
+      HandleRecv(dir, cqe);
+      MaybeRelease(*dir.conn);
+      return;
+    }
+    case kSend: {
+      auto& dir = *static_cast<Direction*>(target);
+      HandleSend(dir, cqe.res);
+      MaybeRelease(*dir.conn);
+      return;
+    }
+    case kConnect: {
+      auto& conn = *static_cast<Connection*>(target);
+      HandleConnect(conn, cqe.res);
+      MaybeRelease(conn);
+      return;
+    }
+    case kCancel: {
+      auto& conn = *static_cast<Connection*>(target);
+      conn.inflight--;
+      MaybeRelease(conn);
+      return;
+    }
+    case kProvide: {
+      // Only failures are reported.
+      LogError("Cannot provide buffer, error ", -cqe.res);
+      return;
+    }
+  }
+}
+
+void UringProxyWorker::HandleAccept(const io_uring_cqe& cqe) {
+  if ((cqe.flags & IORING_CQE_F_MORE) == 0 && running_.load()) {
+    ArmAccept();
+  }
+  if (cqe.res < 0) {
+    LogError("Accept failed with error ", -cqe.res);
+    return;
+  }
+  auto conn = make_unique<Connection>(freelist_);
+  conn->client_fd = cqe.res;
+  conn->upstream.conn = conn.get();
+  conn->upstream.src_fd = conn->client_fd;
+  conn->downstream.conn = conn.get();
+  conn->downstream.dst_fd = conn->client_fd;
+  SetSocks5StateCallbacks(*conn);
+  Connection* ptr = conn.get();
+  connections_[ptr] = move(conn);
+  Recv(ptr->upstream);
+  MaybeRelease(*ptr);
+}
+
+void UringProxyWorker::HandleRecv(Direction& dir, const io_uring_cqe& cqe) {
+  auto& conn = *dir.conn;
+  bool more = cqe.flags & IORING_CQE_F_MORE;
+  if (!more) {
+    dir.receiving = false;
+    conn.inflight--;
+  }
+  if (cqe.res > 0) {
+    auto buffer_id =
+        static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    free_buffers_--;
+    if (conn.closing || dir.dst_failed) {
+      ReturnBuffer(buffer_id);
+    } else if (!conn.forwarding) {
+      // The handshake is tiny, so it is simply copied.
+      const char* data = buffers_[buffer_id]->buf;
+      for (const auto& iov : conn.handshake_buff.Reserve<iovec>(cqe.res)) {
+        memcpy(iov.iov_base, data, iov.iov_len);
+        data += iov.iov_len;
+      }
+      conn.handshake_buff.Commit(cqe.res);
+      ReturnBuffer(buffer_id);
+      ProceedHandshake(conn);
+    } else {
+      dir.segments.push_back(
+          Segment{buffer_id, 0, static_cast<uint32_t>(cqe.res)});
+      dir.queued_size += cqe.res;
+      Send(dir);
+      if (dir.queued_size >= kMaxQueuedSize) {
+        CancelRecv(dir);
+      }
+    }
+  } else if (cqe.res == -ENOBUFS) {
+    // Resumed once enough buffers are written out.
+    if (!dir.starved) {
+      dir.starved = true;
+      starved_.push_back(&dir);
+    }
+  } else if (cqe.res == -ECANCELED && dir.paused) {
+    // Resumed once the queue drains.
+  } else {
+    if (cqe.res < 0) {
+      LogError("Recv failed with error ", -cqe.res);
+    }
+    dir.src_done = true;
+    if (!conn.forwarding) {
+      Close(conn);
+    }
+    MaybeShutdown(dir);
+  }
+  if (!more && !dir.starved && !dir.paused) {
+    Recv(dir);
+  }
+  ResumeStarved();
+}
+
+void UringProxyWorker::HandleSend(Direction& dir, int result) {
+  auto& conn = *dir.conn;
+  dir.sending = false;
+  conn.inflight--;
+  size_t remaining = result > 0 ? result : 0;
+  (&dir == &conn.upstream ? Metrics().upstream_bytes_total
+                          : Metrics().downstream_bytes_total)
+      .Add(remaining);
+  if (dir.prefix_peeked) {
+    size_t prefix_size = min(remaining, dir.prefix->data_size());
+    dir.prefix->Drain(prefix_size);
+    dir.prefix_peeked = false;
+    remaining -= prefix_size;
+  }
+  while (remaining > 0) {
+    auto& segment = dir.segments.front();
+    if (segment.len <= remaining) {
+      remaining -= segment.len;
+      dir.queued_size -= segment.len;
+      ReturnBuffer(segment.buffer_id);
+      dir.segments.pop_front();
+    } else {
+      segment.offset += remaining;
+      segment.len -= remaining;
+      dir.queued_size -= remaining;
+      remaining = 0;
+    }
+  }
+  if (result < 0) {
+    LogError("Send failed with error ", -result);
+    dir.dst_failed = true;
+    for (auto& segment : dir.segments) {
+      ReturnBuffer(segment.buffer_id);
+    }
+    dir.segments.clear();
+    dir.queued_size = 0;
+    // Nothing more can be forwarded, so stop the source too.
+    shutdown(dir.src_fd, SHUT_RD);
+  }
+  if (dir.paused && dir.queued_size < kMaxQueuedSize / 2) {
+    dir.paused = false;
+    Recv(dir);
+  }
+  Send(dir);
+  MaybeShutdown(dir);
+  ResumeStarved();
+}
+
+void UringProxyWorker::HandleConnect(Connection& conn, int result) {
+  conn.connecting = false;
+  conn.inflight--;
+  if (conn.closing) {
+    return;
+  }
+  if (result < 0) {
+    LogError("Connect failed with error ", -result);
+    Metrics().connect_failures_total.Add();
+    Close(conn);
+    return;
+  }
+  if (!conn.socks5_state.ConnectionSucceed()) {
+    Close(conn);
+    return;
+  }
+  StartForwarding(conn);
+}
+
+void UringProxyWorker::ArmAccept() {
+  auto* sqe = GetSqe(nullptr, kAccept);
+  if (sqe == nullptr) {
+    LogError("Cannot submit accept to io_uring.");
+    return;
+  }
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = listen_fd_;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = SOCK_CLOEXEC;
+}
+
+void UringProxyWorker::ArmWake() {
+  auto* sqe = GetSqe(nullptr, kWake);
+  if (sqe == nullptr) {
+    LogError("Cannot submit wake read to io_uring.");
+    return;
+  }
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = wake_fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+  sqe->len = sizeof(wake_value_);
+}
+
+void UringProxyWorker::Recv(Direction& dir) {
+  if (dir.receiving || dir.src_done || dir.starved || dir.conn->closing) {
+    return;
+  }
+  if (dir.queued_size >= kMaxQueuedSize) {
+    dir.paused = true;
+    return;
+  }
+  auto* sqe = GetSqe(&dir, kRecv);
+  if (sqe == nullptr) {
+    Close(*dir.conn);
+    return;
+  }
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = dir.src_fd;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kBufferGroup;
+  dir.receiving = true;
+  dir.conn->inflight++;
+}
+
+void UringProxyWorker::Send(Direction& dir) {
+  if (dir.sending || dir.dst_failed || dir.conn->closing || dir.dst_fd < 0) {
+    return;
+  }
+  dir.iovs.clear();
+  if (dir.prefix != nullptr && dir.prefix->data_size() > 0) {
+    dir.iovs = dir.prefix->Peek<iovec>();
+    dir.prefix_peeked = true;
+  }
+  for (const auto& segment : dir.segments) {
+    if (dir.iovs.size() >= kMaxIovs) {
+      break;
+    }
+    dir.iovs.push_back(
+        iovec{buffers_[segment.buffer_id]->buf + segment.offset, segment.len});
+  }
+  if (dir.iovs.empty()) {
+    return;
+  }
+  auto* sqe = GetSqe(&dir, kSend);
+  if (sqe == nullptr) {
+    if (dir.prefix_peeked) {
+      dir.prefix->Drain(0);
+      dir.prefix_peeked = false;
+    }
+    Close(*dir.conn);
+    return;
+  }
+  memset(&dir.msg, 0, sizeof(dir.msg));
+  dir.msg.msg_iov = dir.iovs.data();
+  dir.msg.msg_iovlen = dir.iovs.size();
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = dir.dst_fd;
+  sqe->addr = reinterpret_cast<uint64_t>(&dir.msg);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  dir.sending = true;
+  dir.conn->inflight++;
+}
+
+void UringProxyWorker::CancelRecv(Direction& dir) {
+  if (!dir.receiving || dir.paused) {
+    return;
+  }
+  dir.paused = true;
+  auto* sqe = GetSqe(dir.conn, kCancel);
+  if (sqe == nullptr) {
+    return;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->addr = reinterpret_cast<uint64_t>(&dir) | kRecv;
+  dir.conn->inflight++;
+}
+
+void UringProxyWorker::SetSocks5StateCallbacks(Connection& conn) {
+  conn.socks5_state.SetConnectCallback([this, &conn](const sockaddr* addr,
+                                                     size_t size) {
+    if (size > sizeof(conn.dest_addr)) {
+      return Socks5State::kStatusFail;
+    }
+    conn.dest_fd = socket(addr->sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn.dest_fd < 0) {
+      return Socks5State::kStatusFail;
+    }
+    memcpy(&conn.dest_addr, addr, size);
+    conn.dest_addr_len = size;
+    auto* sqe = GetSqe(&conn, kConnect);
+    if (sqe == nullptr) {
+      return Socks5State::kStatusFail;
+    }
+    sqe->opcode = IORING_OP_CONNECT;
+    sqe->fd = conn.dest_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&conn.dest_addr);
+    sqe->off = conn.dest_addr_len;
+    conn.connecting = true;
+    conn.inflight++;
+    return Socks5State::kStatusInProgress;
+  });
+
+  conn.socks5_state.SetResponseCallback([&conn](const void* data,
+                                                size_t len) {
+    // The responses are supposed to be tiny and we should expect this succeeds
+    // immediately.
+    ssize_t sent = send(conn.client_fd, data, len, MSG_NOSIGNAL);
+    if (sent != static_cast<ssize_t>(len)) {
+      return Socks5State::kStatusFail;
+    }
+    return Socks5State::kStatusOK;
+  });
+
+  conn.socks5_state.SetDestAddressCallback(
+      [&conn](sockaddr* addr, size_t* len, bool remote) {
+        sockaddr_storage storage;
+        socklen_t addr_len = sizeof(storage);
+        auto* storage_addr = reinterpret_cast<sockaddr*>(&storage);
+        int ret = remote ? getpeername(conn.dest_fd, storage_addr, &addr_len)
+                         : getsockname(conn.dest_fd, storage_addr, &addr_len);
+        if (ret != 0) {
+          return Socks5State::kStatusFail;
+        }
+        memcpy(addr, &storage, addr_len);
+        *len = addr_len;
+        return Socks5State::kStatusOK;
+      });
+
+  conn.socks5_state.SetBindCallback([](uint16_t& port) {
+    LogError("BIND is not supported with io_uring.");
+    return Socks5State::kStatusFail;
+  });
+}
+
+void UringProxyWorker::ProceedHandshake(Connection& conn) {
+  if (conn.handshake_buff.data_size() > kMaxQueuedSize) {
+    Close(conn);
+    return;
+  }
+  while (conn.socks5_state.state() != Socks5State::kSuccess &&
+         conn.socks5_state.Proceed(conn.handshake_buff)) {}
+  if (conn.socks5_state.Failed()) {
+    Close(conn);
+  }
+}
+
+void UringProxyWorker::StartForwarding(Connection& conn) {
+  conn.forwarding = true;
+  // The data sent by the client right after the handshake goes first.
+  conn.upstream.dst_fd = conn.dest_fd;
+  conn.upstream.prefix = &conn.handshake_buff;
+  conn.downstream.src_fd = conn.dest_fd;
+  Recv(conn.upstream);
+  Recv(conn.downstream);
+  Send(conn.upstream);
+  MaybeShutdown(conn.upstream);
+}
+
+void UringProxyWorker::ReturnBuffer(uint16_t buffer_id) {
+  auto* sqe = GetSqe(nullptr, kProvide);
+  if (sqe == nullptr) {
+    LogError("Cannot submit buffer to io_uring.");
+    return;
+  }
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  sqe->fd = 1;  // The number of buffers.
+  sqe->addr = reinterpret_cast<uint64_t>(buffers_[buffer_id]->buf);
+  sqe->len = Buffer::Block::capacity;
+  sqe->off = buffer_id;
+  sqe->buf_group = kBufferGroup;
+  free_buffers_++;
+}
+
+void UringProxyWorker::ResumeStarved() {
+  // Wait for a good share of the buffers, not to run out again right away.
+  if (starved_.empty() || free_buffers_ < kNumBuffers / 8) {
+    return;
+  }
+  auto starved = move(starved_);
+  starved_.clear();
+  for (auto* dir : starved) {
+    dir->starved = false;
+    Recv(*dir);
+  }
+}
+
+void UringProxyWorker::MaybeShutdown(Direction& dir) {
+  if (!dir.src_done || dir.shutdown_sent || dir.sending || dir.dst_failed ||
+      dir.dst_fd < 0 || dir.queued_size > 0 ||
+      (dir.prefix != nullptr && dir.prefix->data_size() > 0)) {
+    return;
+  }
+  shutdown(dir.dst_fd, SHUT_WR);
+  dir.shutdown_sent = true;
+}
+
+void UringProxyWorker::MaybeRelease(Connection& conn) {
+  if (!conn.closing) {
+    auto is_done = [](const Direction& dir) {
+      return dir.src_done && !dir.receiving && !dir.sending &&
+             (dir.shutdown_sent || dir.dst_failed);
+    };
+    if (!conn.forwarding || !is_done(conn.upstream) ||
+        !is_done(conn.downstream)) {
+      return;
+    }
+    Close(conn);
+  }
+  if (conn.inflight > 0) {
+    return;
+  }
+  for (auto* dir : {&conn.upstream, &conn.downstream}) {
+    for (auto& segment : dir->segments) {
+      ReturnBuffer(segment.buffer_id);
+    }
+    if (dir->starved) {
+      starved_.erase(std::find(starved_.begin(), starved_.end(), dir));
+    }
+  }
+  close(conn.client_fd);
+  if (conn.dest_fd >= 0) {
+    close(conn.dest_fd);
+  }
+  connections_.erase(&conn);
+}
+
+void UringProxyWorker::Close(Connection& conn) {
+  if (conn.closing) {
+    return;
+  }
+  conn.closing = true;
+  // Complete the recvs and sends in flight, the connection is released once
+  // they are all completed.
+  shutdown(conn.client_fd, SHUT_RDWR);
+  if (conn.dest_fd >= 0) {
+    shutdown(conn.dest_fd, SHUT_RDWR);
+  }
+  if (conn.connecting) {
+    auto* sqe = GetSqe(&conn, kCancel);
+    if (sqe != nullptr) {
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->addr = reinterpret_cast<uint64_t>(&conn) | kConnect;
+      conn.inflight++;
+    }
+  }
+}
+
+io_uring_sqe* UringProxyWorker::GetSqe(void* target, Op op) {
+  auto* sqe = ring_.GetSqe();
+  if (sqe != nullptr) {
+    sqe->user_data = reinterpret_cast<uint64_t>(target) | op;
+  }
+  return sqe;
+}
+
+}  // namespace google::scp::proxy
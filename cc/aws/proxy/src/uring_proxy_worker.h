@@ -0,0 +1,186 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef URING_PROXY_WORKER_H_
+#define URING_PROXY_WORKER_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "proxy/src/buffer.h"
+#include "proxy/src/freelist.h"
+#include "proxy/src/io_uring.h"
+#include "proxy/src/metrics.h"
+#include "proxy/src/socks5_state.h"
+
+namespace google::scp::proxy {
+// UringProxyWorker is the io_uring alternative to running ProxyBridge objects
+// on an asio io_context. Each worker owns an io_uring instance, accepting
+// connections from the shared listening socket with a multishot accept, and
+// serving them on its own thread, so that no strand or lock is needed.
+// Forwarded data is received with multishot recv into buffers taken from the
+// Freelist of Buffer blocks and provided to the kernel, then written out of
+// them directly.
+// BIND requests and multiplexed connections (see mux_protocol.h) are not
+// supported.
+class UringProxyWorker {
+ public:
+  // The max bytes received and not yet written out, per direction.
+  static constexpr size_t kMaxQueuedSize = 1024 * 1024;
+
+  UringProxyWorker(int listen_fd,
+                   const std::shared_ptr<Freelist<Buffer::Block>>& freelist);
+  ~UringProxyWorker();
+
+  // Set up the io_uring instance, return false if unavailable.
+  bool Init();
+  // Blocking run the worker until Stop() is called.
+  void Run();
+  // Stop the worker, can be called from any thread.
+  void Stop();
+
+ private:
+  static constexpr unsigned int kRingEntries = 1024;
+  // The number of provided buffers.
+  static constexpr unsigned int kNumBuffers = 4096;
+  static constexpr uint16_t kBufferGroup = 0;
+  static constexpr size_t kMaxIovs = 64;
+
+  // The operations of the submission entries, in the low bits of user_data.
+  enum Op : uint64_t {
+    kAccept = 0,
+    kWake = 1,
+    kRecv = 2,
+    kSend = 3,
+    kConnect = 4,
+    kCancel = 5,
+    kProvide = 6,
+  };
+  static constexpr uint64_t kOpMask = 0x7;
+
+  struct Connection;
+
+  // A received part of a provided buffer.
+  struct Segment {
+    uint16_t buffer_id;
+    uint32_t offset;
+    uint32_t len;
+  };
+
+  // One direction of the traffic of a connection.
+  struct Direction {
+    Connection* conn = nullptr;
+    int src_fd = -1;
+    int dst_fd = -1;
+    // The data received before forwarding started, written out first.
+    Buffer* prefix = nullptr;
+    bool prefix_peeked = false;
+    std::deque<Segment> segments;
+    size_t queued_size = 0;
+    // The scatter-gather list of the send in flight.
+    std::vector<iovec> iovs;
+    msghdr msg{};
+    // Whether a multishot recv is armed, and whether it is paused until the
+    // queue drains, or until buffers are given back to the kernel.
+    bool receiving = false;
+    bool paused = false;
+    bool starved = false;
+    bool sending = false;
+    // Whether src was read to EOF, or failed.
+    bool src_done = false;
+    bool dst_failed = false;
+    bool shutdown_sent = false;
+  };
+
+  struct Connection {
+    int client_fd = -1;
+    int dest_fd = -1;
+    Socks5State socks5_state;
+    // The data received from the client during the handshake.
+    Buffer handshake_buff;
+    sockaddr_storage dest_addr{};
+    socklen_t dest_addr_len = 0;
+    // client_fd -> dest_fd, and dest_fd -> client_fd.
+    Direction upstream;
+    Direction downstream;
+    // The submitted entries not completed yet, the connection can only be
+    // freed when it is 0.
+    int inflight = 0;
+    bool connecting = false;
+    bool forwarding = false;
+    bool closing = false;
+
+    explicit Connection(
+        const std::shared_ptr<Freelist<Buffer::Block>>& freelist)
+        : handshake_buff(freelist) {
+      Metrics().connections_total.Add();
+      Metrics().active_connections.Add();
+    }
+    ~Connection() { Metrics().active_connections.Add(-1); }
+  };
+
+  void HandleCompletion(const io_uring_cqe& cqe);
+  void HandleAccept(const io_uring_cqe& cqe);
+  void HandleRecv(Direction& dir, const io_uring_cqe& cqe);
+  void HandleSend(Direction& dir, int result);
+  void HandleConnect(Connection& conn, int result);
+
+  void ArmAccept();
+  void ArmWake();
+  void Recv(Direction& dir);
+  void Send(Direction& dir);
+  void CancelRecv(Direction& dir);
+
+  void SetSocks5StateCallbacks(Connection& conn);
+  void ProceedHandshake(Connection& conn);
+  void StartForwarding(Connection& conn);
+
+  // Give the buffer back to the kernel.
+  void ReturnBuffer(uint16_t buffer_id);
+  // Resume the recvs lacking buffers.
+  void ResumeStarved();
+  // Half-close the destination once everything from the source is written.
+  void MaybeShutdown(Direction& dir);
+  // Free the connection once both directions are done.
+  void MaybeRelease(Connection& conn);
+  void Close(Connection& conn);
+
+  io_uring_sqe* GetSqe(void* target, Op op);
+
+  const int listen_fd_;
+  std::shared_ptr<Freelist<Buffer::Block>> freelist_;
+  IoUring ring_;
+  // The provided buffers by buffer id.
+  std::vector<Buffer::Block*> buffers_;
+  std::unordered_map<Connection*, std::unique_ptr<Connection>> connections_;
+  // The directions whose recv stopped for lack of buffers.
+  std::vector<Direction*> starved_;
+  // The number of provided buffers owned by the kernel.
+  unsigned int free_buffers_ = 0;
+  int wake_fd_ = -1;
+  uint64_t wake_value_ = 0;
+  std::atomic<bool> running_;
+};
+}  // namespace google::scp::proxy
+
+#endif  // URING_PROXY_WORKER_H_
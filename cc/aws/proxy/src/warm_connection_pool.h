@@ -0,0 +1,161 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace google::scp::proxy {
+// A pool of connections to the proxy that are already past the SOCKS5
+// greeting, so that connect() only has the CONNECT request left to do. The
+// pool is refilled by a background thread, started on the first Claim(), that
+// makes the connections with the given function. A connection idle for longer
+// than kMaxIdleSeconds may have been dropped by the proxy, and is closed
+// instead. The refill thread never exits, so the pool must outlive the
+// process.
+class WarmConnectionPool {
+ public:
+  static constexpr size_t kMaxSize = 64;
+  static constexpr time_t kMaxIdleSeconds = 30;
+  static constexpr unsigned int kRefillRetryDelaySeconds = 1;
+
+  // make_connection returns a new greeted connection, or -1 on failure.
+  explicit WarmConnectionPool(int (*make_connection)())
+      : make_connection_(make_connection) {}
+
+  WarmConnectionPool(const WarmConnectionPool&) = delete;
+  WarmConnectionPool& operator=(const WarmConnectionPool&) = delete;
+
+  // Returns a warm connection, or -1 if there is none.
+  int Claim() {
+    pthread_mutex_lock(&mutex_);
+    if (!is_refill_started_ && capacity_ > 0) {
+      is_refill_started_ = true;
+      pthread_t thread;
+      if (pthread_create(&thread, nullptr, &WarmConnectionPool::Refill,
+                         this) == 0) {
+        pthread_detach(thread);
+      }
+    }
+    int fd = -1;
+    time_t now = Now();
+    while (fd < 0 && size_ > 0) {
+      WarmConnection connection = connections_[--size_];
+      if (now - connection.created_at <= kMaxIdleSeconds &&
+          IsAlive(connection.fd)) {
+        fd = connection.fd;
+      } else {
+        close(connection.fd);
+      }
+    }
+    pthread_cond_signal(&refill_cond_);
+    pthread_mutex_unlock(&mutex_);
+    return fd;
+  }
+
+  // Sets the number of warm connections kept, at most kMaxSize. Must be called
+  // before the first Claim().
+  void SetCapacity(size_t capacity) {
+    capacity_ = capacity < kMaxSize ? capacity : kMaxSize;
+  }
+
+  // Returns the number of warm connections in the pool.
+  size_t Size() {
+    pthread_mutex_lock(&mutex_);
+    size_t size = size_;
+    pthread_mutex_unlock(&mutex_);
+    return size;
+  }
+
+  // The pool is not shared with a forked child: its threads do not survive
+  // the fork, and a connection claimed by both processes would be corrupted.
+  // These are the pthread_atfork() handlers of the pool.
+  void BeforeFork() { pthread_mutex_lock(&mutex_); }
+
+  void AfterForkInParent() { pthread_mutex_unlock(&mutex_); }
+
+  void AfterForkInChild() {
+    for (size_t i = 0; i < size_; i++) {
+      close(connections_[i].fd);
+    }
+    size_ = 0;
+    is_refill_started_ = false;
+    pthread_mutex_init(&mutex_, nullptr);
+    pthread_cond_init(&refill_cond_, nullptr);
+  }
+
+ private:
+  struct WarmConnection {
+    int fd;
+    time_t created_at;
+  };
+
+  static time_t Now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+  }
+
+  // A connection the proxy closed, or wrote to, reads without blocking.
+  static bool IsAlive(int fd) {
+    uint8_t byte;
+    return recv(fd, &byte, sizeof(byte), MSG_PEEK | MSG_DONTWAIT) < 0 &&
+           (errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+
+  static void* Refill(void* arg) {
+    auto* pool = static_cast<WarmConnectionPool*>(arg);
+    while (true) {
+      pthread_mutex_lock(&pool->mutex_);
+      while (pool->size_ >= pool->capacity_) {
+        pthread_cond_wait(&pool->refill_cond_, &pool->mutex_);
+      }
+      pthread_mutex_unlock(&pool->mutex_);
+
+      int fd = pool->make_connection_();
+      if (fd < 0) {
+        // The proxy is unreachable, connect() does the full handshake anyway.
+        sleep(kRefillRetryDelaySeconds);
+        continue;
+      }
+      pthread_mutex_lock(&pool->mutex_);
+      if (pool->size_ < pool->capacity_) {
+        pool->connections_[pool->size_++] = WarmConnection{fd, Now()};
+        fd = -1;
+      }
+      pthread_mutex_unlock(&pool->mutex_);
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    return nullptr;
+  }
+
+  int (*const make_connection_)();
+  pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t refill_cond_ = PTHREAD_COND_INITIALIZER;
+  WarmConnection connections_[kMaxSize];
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+  bool is_refill_started_ = false;
+};
+}  // namespace google::scp::proxy
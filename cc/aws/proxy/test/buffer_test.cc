@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <stdint.h>
+
 #include <memory>
 #include <thread>
 #include <unordered_set>
@@ -113,6 +115,60 @@ TEST(FreelistTest, MultiThreadDeleteChain) {
   EXPECT_EQ(freelist.Size(), 200);
 }
 
+TEST(FreelistTest, Arena) {
+  Freelist<Block> freelist(/*use_arena=*/true);
+  vector<Block*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    Block* block = freelist.New();
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % Block::size, 0);
+    blocks.push_back(block);
+  }
+  auto stats = freelist.GetStats();
+  EXPECT_EQ(stats.allocated_blocks, 1000);
+  EXPECT_EQ(stats.free_blocks, 0);
+  EXPECT_EQ(stats.arena_bytes, BlockArena::kChunkSize);
+
+  for (auto block : blocks) {
+    freelist.Delete(block);
+  }
+  stats = freelist.GetStats();
+  EXPECT_EQ(stats.allocated_blocks, 1000);
+  EXPECT_EQ(stats.free_blocks, 1000);
+  // Freed blocks are reused.
+  freelist.Delete(freelist.New());
+  EXPECT_EQ(freelist.GetStats().allocated_blocks, 1000);
+}
+
+TEST(FreelistTest, BlocksMoveAcrossThreads) {
+  Freelist<Block> freelist;
+  vector<Block*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(freelist.New());
+  }
+  // Blocks freed on one thread are reused by another.
+  thread t1([&]() {
+    for (auto block : blocks) {
+      freelist.Delete(block);
+    }
+  });
+  t1.join();
+  EXPECT_EQ(freelist.Size(), 1000);
+  unordered_set<Block*> freed(blocks.begin(), blocks.end());
+  thread t2([&]() {
+    for (auto& block : blocks) {
+      block = freelist.New();
+      EXPECT_EQ(freed.count(block), 1);
+    }
+  });
+  t2.join();
+  EXPECT_EQ(freelist.Size(), 0);
+  EXPECT_EQ(freelist.GetStats().allocated_blocks, 1000);
+  for (auto block : blocks) {
+    freelist.Delete(block);
+  }
+}
+
 // Tests buffer operations Reserve, Commit, Peek, Drain, and common usage
 // scenarios. A freelist object is reused among the series of tests to make sure
 // the freelist's functionality as well.
@@ -315,5 +371,33 @@ TEST(BufferTest, DrainExactBlockToEmptyBuffer) {
   EXPECT_EQ(sz, buf.data_size());
 }
 
+
+TEST(BufferTest, ReserveAndPeekIntoArray) {
+  TestBuffer buf;
+  TestSysBuf bufs[4];
+  // The reservation stops at the size of the array.
+  size_t size = block_capacity * 10;
+  size_t num_bufs = buf.ReserveAtLeast(size, bufs, 4);
+  EXPECT_EQ(num_bufs, 4);
+  EXPECT_EQ(size, block_capacity * 4);
+  for (size_t i = 0; i < num_bufs; ++i) {
+    EXPECT_EQ(bufs[i].len, block_capacity);
+  }
+  buf.Commit(block_capacity * 3 + 1);
+
+  num_bufs = buf.Peek(bufs, 2);
+  EXPECT_EQ(num_bufs, 2);
+  EXPECT_EQ(bufs[0].len, block_capacity);
+  EXPECT_EQ(bufs[1].len, block_capacity);
+  buf.Drain(block_capacity * 2);
+
+  num_bufs = buf.Peek(bufs, 4);
+  EXPECT_EQ(num_bufs, 2);
+  EXPECT_EQ(bufs[0].len, block_capacity);
+  EXPECT_EQ(bufs[1].len, 1);
+  buf.Drain(block_capacity + 1);
+  EXPECT_EQ(buf.data_size(), 0);
+}
+
 }  // namespace test
 }  // namespace google::scp::proxy
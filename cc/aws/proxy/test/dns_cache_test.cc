@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/dns_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+using boost::system::error_code;
+using std::string;
+using std::chrono::milliseconds;
+
+namespace asio = boost::asio;
+
+namespace google::scp::proxy::test {
+
+class DnsCacheTest : public ::testing::Test {
+ protected:
+  // Resolve host, running the io_context if the result is not cached. Returns
+  // whether the callback was called immediately.
+  bool Resolve(DnsCache& cache, const string& host) {
+    bool called = false;
+    cache.Resolve(host, [this, &called](const error_code& ec,
+                                        const DnsCache::Endpoints& endpoints) {
+      called = true;
+      ec_ = ec;
+      endpoints_ = endpoints;
+    });
+    bool immediate = called;
+    io_context_.restart();
+    while (!called) {
+      io_context_.run_one();
+    }
+    return immediate;
+  }
+
+  asio::io_context io_context_;
+  error_code ec_;
+  DnsCache::Endpoints endpoints_;
+};
+
+TEST_F(DnsCacheTest, CachesResults) {
+  DnsCache cache(io_context_.get_executor());
+  EXPECT_FALSE(Resolve(cache, "localhost"));
+  ASSERT_FALSE(ec_.failed()) << ec_.message();
+  ASSERT_FALSE(endpoints_.empty());
+  auto endpoints = endpoints_;
+
+  EXPECT_TRUE(Resolve(cache, "localhost"));
+  EXPECT_FALSE(ec_.failed());
+  EXPECT_EQ(endpoints_, endpoints);
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.refreshes, 0);
+}
+
+TEST_F(DnsCacheTest, CachesFailures) {
+  DnsCache cache(io_context_.get_executor());
+  EXPECT_FALSE(Resolve(cache, "nonexistent.invalid"));
+  EXPECT_TRUE(ec_.failed());
+  EXPECT_TRUE(endpoints_.empty());
+
+  EXPECT_TRUE(Resolve(cache, "nonexistent.invalid"));
+  EXPECT_TRUE(ec_.failed());
+  EXPECT_EQ(cache.GetStats().hits, 1);
+}
+
+TEST_F(DnsCacheTest, Expires) {
+  DnsCache cache(io_context_.get_executor(), milliseconds(1), milliseconds(1));
+  EXPECT_FALSE(Resolve(cache, "localhost"));
+  std::this_thread::sleep_for(milliseconds(5));
+  EXPECT_FALSE(Resolve(cache, "localhost"));
+  EXPECT_FALSE(ec_.failed());
+  EXPECT_EQ(cache.GetStats().misses, 2);
+}
+
+TEST_F(DnsCacheTest, RefreshesBeforeExpiry) {
+  DnsCache cache(io_context_.get_executor(), milliseconds(400));
+  EXPECT_FALSE(Resolve(cache, "localhost"));
+  std::this_thread::sleep_for(milliseconds(350));
+  // Served from the cache, while refreshing in the background.
+  EXPECT_TRUE(Resolve(cache, "localhost"));
+  io_context_.restart();
+  io_context_.run();
+  std::this_thread::sleep_for(milliseconds(100));
+  // The refreshed entry has not expired.
+  EXPECT_TRUE(Resolve(cache, "localhost"));
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.refreshes, 1);
+}
+}  // namespace google::scp::proxy::test
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "proxy/src/metrics_server.h"
+
+using boost::asio::ip::tcp;
+using std::string;
+using std::thread;
+using std::vector;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace google::scp::proxy::test {
+
+TEST(MetricsTest, CounterSumsThreads) {
+  Counter counter;
+  vector<thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&counter]() {
+      for (int j = 0; j < 1000; ++j) {
+        counter.Add();
+      }
+      counter.Add(-10);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(counter.Value(), 8 * 990);
+}
+
+TEST(MetricsTest, MaxGauge) {
+  MaxGauge gauge;
+  gauge.Record(5);
+  gauge.Record(3);
+  EXPECT_EQ(gauge.Value(), 5);
+  gauge.Record(7);
+  EXPECT_EQ(gauge.Value(), 7);
+}
+
+TEST(MetricsTest, HistogramBuckets) {
+  Histogram histogram;
+  histogram.Observe(microseconds(50));
+  histogram.Observe(microseconds(100));
+  histogram.Observe(milliseconds(30));
+  histogram.Observe(std::chrono::seconds(2));
+  auto snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count, 4u);
+  // The bounds are inclusive.
+  EXPECT_EQ(snapshot.counts[0], 2u);
+  EXPECT_EQ(snapshot.counts[8], 1u);
+  EXPECT_EQ(snapshot.counts[Histogram::kNumBuckets - 1], 1u);
+  EXPECT_NEAR(snapshot.sum, 2.03015, 1e-9);
+}
+
+TEST(MetricsTest, Render) {
+  ProxyMetrics metrics;
+  metrics.upstream_bytes_total.Add(42);
+  metrics.handshake_seconds.Observe(milliseconds(2));
+  string out;
+  metrics.Render(out);
+  EXPECT_NE(out.find("# TYPE proxy_upstream_bytes_total counter\n"
+                     "proxy_upstream_bytes_total 42\n"),
+            string::npos);
+  EXPECT_NE(out.find("# TYPE proxy_handshake_seconds histogram\n"),
+            string::npos);
+  EXPECT_NE(out.find("proxy_handshake_seconds_bucket{le=\"0.001\"} 0\n"),
+            string::npos);
+  EXPECT_NE(out.find("proxy_handshake_seconds_bucket{le=\"0.0025\"} 1\n"),
+            string::npos);
+  EXPECT_NE(out.find("proxy_handshake_seconds_bucket{le=\"+Inf\"} 1\n"),
+            string::npos);
+  EXPECT_NE(out.find("proxy_handshake_seconds_count 1\n"), string::npos);
+}
+
+TEST(MetricsTest, Serve) {
+  boost::asio::io_context io_context;
+  MetricsServer server(io_context, 0,
+                       [](string& out) { out.append("test_metric 1\n"); });
+  server.Listen();
+  ASSERT_NE(server.Port(), 0);
+  thread t([&io_context]() { io_context.run(); });
+
+  tcp::socket sock(io_context);
+  sock.connect(
+      tcp::endpoint(boost::asio::ip::address_v4::loopback(), server.Port()));
+  string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  boost::asio::write(sock, boost::asio::buffer(request));
+  string response;
+  boost::system::error_code ec;
+  boost::asio::read(sock, boost::asio::dynamic_buffer(response), ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+  EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4\r\n"),
+            string::npos);
+  EXPECT_NE(response.find("\r\n\r\ntest_metric 1\n"), string::npos);
+
+  io_context.stop();
+  t.join();
+}
+}  // namespace google::scp::proxy::test
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "proxy/src/mux_session.h"
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "proxy/src/mux_protocol.h"
+
+using boost::system::error_code;
+using std::condition_variable;
+using std::make_shared;
+using std::move;
+using std::mutex;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+using UdsSocket = boost::asio::local::stream_protocol::socket;
+
+namespace asio = boost::asio;
+
+namespace google::scp::proxy::test {
+
+// Collects the sockets of the streams served on the proxy side.
+class StreamCollector {
+ public:
+  MuxSession::StreamHandler Handler() {
+    return [this](Socket sock) {
+      unique_lock<mutex> lock(mutex_);
+      socks_.push_back(make_shared<Socket>(move(sock)));
+      cv_.notify_all();
+    };
+  }
+
+  std::shared_ptr<Socket> Wait(size_t index) {
+    unique_lock<mutex> lock(mutex_);
+    cv_.wait(lock, [&]() { return socks_.size() > index; });
+    return socks_[index];
+  }
+
+ private:
+  mutex mutex_;
+  condition_variable cv_;
+  vector<std::shared_ptr<Socket>> socks_;
+};
+
+TEST(MuxProtocol, FrameHeaderRoundTrip) {
+  mux::FrameHeader header{mux::FrameType::kWindowUpdate, mux::kFlagFin,
+                          0x01020304, 0xa0b0c0d0};
+  uint8_t buff[mux::kFrameHeaderSize];
+  mux::EncodeFrameHeader(header, buff);
+  EXPECT_EQ(buff[0], 0x01);
+  EXPECT_EQ(buff[1], mux::kFlagFin);
+  EXPECT_EQ(buff[4], 0x01);
+  EXPECT_EQ(buff[11], 0xd0);
+
+  auto decoded = mux::DecodeFrameHeader(buff);
+  EXPECT_EQ(decoded.type, header.type);
+  EXPECT_EQ(decoded.flags, header.flags);
+  EXPECT_EQ(decoded.stream_id, header.stream_id);
+  EXPECT_EQ(decoded.length, header.length);
+}
+
+TEST(MuxSession, ForwardTrafficOfManyStreams) {
+  asio::io_context io_context;
+  UdsSocket conn0(io_context);
+  UdsSocket conn1(io_context);
+  asio::local::connect_pair(conn0, conn1);
+  StreamCollector collector;
+  auto client = make_shared<MuxSession>(move(conn0));
+  auto server = make_shared<MuxSession>(move(conn1), collector.Handler());
+  client->Start();
+  server->Start();
+
+  // Each stream sends much more than a window upstream, then gets a reply
+  // downstream after its half closure.
+  constexpr size_t kNumStreams = 4;
+  constexpr size_t kUpstreamSize = 4 * mux::kInitialWindowSize + 123;
+  vector<std::unique_ptr<UdsSocket>> app_socks;
+  for (size_t i = 0; i < kNumStreams; ++i) {
+    app_socks.push_back(std::make_unique<UdsSocket>(io_context));
+    UdsSocket stream_sock(io_context);
+    asio::local::connect_pair(*app_socks.back(), stream_sock);
+    client->OpenStream(Socket(move(stream_sock)));
+  }
+
+  thread worker_thread([&]() { io_context.run(); });
+  vector<thread> app_threads;
+  for (size_t i = 0; i < kNumStreams; ++i) {
+    app_threads.emplace_back([&, i]() {
+      vector<uint8_t> send_buff(kUpstreamSize);
+      for (size_t j = 0; j < kUpstreamSize; ++j) {
+        send_buff[j] = (i + j) & 0xff;
+      }
+      error_code ec;
+      asio::write(*app_socks[i], asio::buffer(send_buff), ec);
+      EXPECT_FALSE(ec.failed());
+      app_socks[i]->shutdown(Socket::shutdown_send, ec);
+
+      uint8_t reply[16];
+      size_t sz = asio::read(*app_socks[i], asio::buffer(reply), ec);
+      EXPECT_EQ(sz, 4);
+      EXPECT_EQ(ec, asio::error::eof);
+      EXPECT_EQ(reply[0], i);
+      app_socks[i]->close();
+    });
+  }
+
+  // The streams are served in whatever order they are opened.
+  for (size_t i = 0; i < kNumStreams; ++i) {
+    auto sock = collector.Wait(i);
+    vector<uint8_t> recv_buff(kUpstreamSize + 1);
+    error_code ec;
+    size_t sz = asio::read(*sock, asio::buffer(recv_buff), ec);
+    ASSERT_EQ(sz, kUpstreamSize);
+    EXPECT_EQ(ec, asio::error::eof);
+    uint8_t stream_index = recv_buff[0];
+    for (size_t j = 0; j < kUpstreamSize; ++j) {
+      ASSERT_EQ(recv_buff[j], (stream_index + j) & 0xff);
+    }
+    uint8_t reply[] = {stream_index, 1, 2, 3};
+    asio::write(*sock, asio::buffer(reply), ec);
+    EXPECT_FALSE(ec.failed());
+    sock->close();
+  }
+
+  for (auto& t : app_threads) {
+    t.join();
+  }
+  client->Close();
+  worker_thread.join();
+  EXPECT_TRUE(client->IsClosed());
+  EXPECT_TRUE(server->IsClosed());
+}
+
+TEST(MuxSession, ClosesStreamsWithConnection) {
+  asio::io_context io_context;
+  UdsSocket conn0(io_context);
+  UdsSocket conn1(io_context);
+  asio::local::connect_pair(conn0, conn1);
+  UdsSocket app_sock(io_context);
+  UdsSocket stream_sock(io_context);
+  asio::local::connect_pair(app_sock, stream_sock);
+  auto client = make_shared<MuxSession>(move(conn0));
+  client->Start();
+  client->OpenStream(Socket(move(stream_sock)));
+
+  thread worker_thread([&]() { io_context.run(); });
+  // Read the preface, then drop the connection.
+  uint8_t preface[sizeof(mux::kPreface)];
+  asio::read(conn1, asio::buffer(preface));
+  EXPECT_EQ(memcmp(preface, mux::kPreface, sizeof(preface)), 0);
+  conn1.close();
+
+  uint8_t buff[16];
+  error_code ec;
+  size_t sz = app_sock.read_some(asio::buffer(buff), ec);
+  EXPECT_TRUE(ec.failed());
+  EXPECT_EQ(sz, 0);
+  worker_thread.join();
+  EXPECT_TRUE(client->IsClosed());
+}
+
+}  // namespace google::scp::proxy::test
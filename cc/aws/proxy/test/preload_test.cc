@@ -26,6 +26,12 @@
 
 #include <linux/vm_sockets.h>
 
+#include <atomic>
+
+#include "proxy/src/warm_connection_pool.h"
+
+using google::scp::proxy::WarmConnectionPool;
+
 class PreloadSyscallTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -70,6 +76,91 @@ TEST_F(PreloadSyscallTest, setsockopt) {
   EXPECT_EQ(rc, 0);
 }
 
+namespace {
+// The peer of the last connection made by MakeSocketPairConnection().
+std::atomic<int> last_peer_fd(-1);
+std::atomic<size_t> failed_connection_count(0);
+std::atomic<size_t> unexpected_connection_count(0);
+
+int MakeSocketPairConnection() {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0) {
+    return -1;
+  }
+  last_peer_fd = fds[1];
+  return fds[0];
+}
+
+int MakeFailedConnection() {
+  failed_connection_count++;
+  return -1;
+}
+
+int MakeUnexpectedConnection() {
+  unexpected_connection_count++;
+  return -1;
+}
+
+// Waits up to 5 seconds for the condition.
+template <typename Condition>
+bool WaitFor(Condition condition) {
+  for (int i = 0; i < 5000 && !condition(); i++) {
+    usleep(1000);
+  }
+  return condition();
+}
+}  // namespace
+
+// The pools are never destroyed, as their refill threads keep running.
+TEST(WarmConnectionPoolTest, ClaimReturnsTheWarmConnections) {
+  auto* pool = new WarmConnectionPool(&MakeSocketPairConnection);
+  pool->SetCapacity(2);
+  // The first claim starts the refill.
+  EXPECT_EQ(pool->Claim(), -1);
+  ASSERT_TRUE(WaitFor([&] { return pool->Size() == 2; }));
+
+  int fd = pool->Claim();
+  ASSERT_GE(fd, 0);
+  EXPECT_EQ(pool->Size(), 1);
+  // The claimed connection is refilled.
+  EXPECT_TRUE(WaitFor([&] { return pool->Size() == 2; }));
+  close(fd);
+}
+
+TEST(WarmConnectionPoolTest, ClaimClosesTheDroppedConnections) {
+  auto* pool = new WarmConnectionPool(&MakeSocketPairConnection);
+  pool->SetCapacity(1);
+  EXPECT_EQ(pool->Claim(), -1);
+  ASSERT_TRUE(WaitFor([&] { return pool->Size() == 1; }));
+
+  // The proxy closed the only warm connection.
+  close(last_peer_fd.exchange(-1));
+  EXPECT_EQ(pool->Claim(), -1);
+
+  // A new warm connection replaces it.
+  ASSERT_TRUE(WaitFor([&] { return pool->Size() == 1; }));
+  int fd = pool->Claim();
+  EXPECT_GE(fd, 0);
+  close(fd);
+}
+
+TEST(WarmConnectionPoolTest, ClaimFailsWhenTheProxyIsUnreachable) {
+  auto* pool = new WarmConnectionPool(&MakeFailedConnection);
+  pool->SetCapacity(1);
+  EXPECT_EQ(pool->Claim(), -1);
+  ASSERT_TRUE(WaitFor([] { return failed_connection_count > 0; }));
+  EXPECT_EQ(pool->Size(), 0);
+  EXPECT_EQ(pool->Claim(), -1);
+}
+
+TEST(WarmConnectionPoolTest, ClaimDoesNotConnectWithoutCapacity) {
+  auto* pool = new WarmConnectionPool(&MakeUnexpectedConnection);
+  pool->SetCapacity(0);
+  EXPECT_EQ(pool->Claim(), -1);
+  usleep(10000);
+  EXPECT_EQ(unexpected_connection_count, 0);
+}
+
 // TODO: add tests for connect(), socks5_connect() when the server side logic is
 // cleaned up, so that we can contain them in unit tests. For now they are
 // tested via e2e tests.
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/asio.hpp>
+
+#include "proxy/src/buffer.h"
+#include "proxy/src/freelist.h"
+#include "proxy/src/io_uring.h"
+#include "proxy/src/proxy_bridge.h"
+#include "proxy/src/socket_types.h"
+#include "proxy/src/uring_proxy_worker.h"
+
+using boost::system::error_code;
+using std::make_shared;
+using std::make_unique;
+using std::shared_ptr;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+using Tcp = boost::asio::ip::tcp;
+
+namespace asio = boost::asio;
+
+namespace google::scp::proxy::test {
+namespace {
+enum Backend : int64_t {
+  // ProxyBridge objects sharing one Freelist, as in ProxyServer.
+  kSharedFreelist = 0,
+  // ProxyBridge objects each with a Freelist of its own, so that the blocks
+  // are not reused across connections.
+  kOwnFreelist = 1,
+  kIoUring = 2,
+};
+
+constexpr size_t kProxyThreads = 2;
+const auto kLoopback = asio::ip::address_v4::loopback();
+
+// A proxy on the loopback interface, serving the connections like
+// ProxyServer::HandleConnection(), and an echo server to connect to through
+// it. ProxyServer always shares one Freelist, so the bridges are driven
+// directly to tell the cost of not reusing the blocks.
+class Harness {
+ public:
+  explicit Harness(Backend backend)
+      : freelist_(make_shared<Freelist<Buffer::Block>>(/*use_arena=*/true)),
+        acceptor_(proxy_context_),
+        echo_acceptor_(echo_context_, Tcp::endpoint(kLoopback, 0)) {
+    Protocol protocol(AF_INET, 0);
+    acceptor_.open(protocol);
+    acceptor_.bind(Endpoint(Tcp::endpoint(kLoopback, 0)));
+    acceptor_.listen();
+    auto ep = acceptor_.local_endpoint();
+    port_ = ntohs(reinterpret_cast<sockaddr_in*>(ep.data())->sin_port);
+    if (backend == kIoUring) {
+      for (size_t i = 0; i < kProxyThreads; ++i) {
+        auto worker = make_unique<UringProxyWorker>(acceptor_.native_handle(),
+                                                    freelist_);
+        if (!worker->Init()) {
+          return;
+        }
+        threads_.emplace_back([&worker = *worker]() { worker.Run(); });
+        workers_.push_back(std::move(worker));
+      }
+    } else {
+      StartAccept(backend == kSharedFreelist ? freelist_ : nullptr);
+      for (size_t i = 0; i < kProxyThreads; ++i) {
+        threads_.emplace_back([this]() { proxy_context_.run(); });
+      }
+    }
+    StartEcho();
+    threads_.emplace_back([this]() { echo_context_.run(); });
+    ready_ = true;
+  }
+
+  bool ready() const { return ready_; }
+
+  // Connect to the echo server through the proxy.
+  Tcp::socket Connect() {
+    Tcp::socket sock(client_context_);
+    sock.connect(Tcp::endpoint(kLoopback, port_));
+    sock.set_option(Tcp::no_delay(true));
+    uint16_t port = echo_acceptor_.local_endpoint().port();
+    uint8_t request[] = {0x05, 0x01, 0x00,        // <- greeting
+                         0x05, 0x01, 0x00, 0x01,  // <- CONNECT IPv4
+                         0x7f, 0x00, 0x00, 0x01,  // <- addr = 127.0.0.1
+                         static_cast<uint8_t>(port >> 8),
+                         static_cast<uint8_t>(port & 0xff)};
+    asio::write(sock, asio::buffer(request));
+    // The greeting response, then the IPv4 connect response.
+    uint8_t resp[2 + 10];
+    asio::read(sock, asio::buffer(resp));
+    return sock;
+  }
+
+ private:
+  void StartAccept(shared_ptr<Freelist<Buffer::Block>> freelist) {
+    acceptor_.async_accept([this, freelist](error_code ec, Socket sock) {
+      if (ec.failed()) {
+        return;
+      }
+      StartAccept(freelist);
+      auto bridge = make_shared<ProxyBridge>(std::move(sock), nullptr,
+                                             freelist);
+      bridge->PerformSocks5Handshake();
+    });
+  }
+
+  void StartEcho() {
+    echo_acceptor_.async_accept([this](error_code ec, Tcp::socket sock) {
+      if (ec.failed()) {
+        return;
+      }
+      StartEcho();
+      sock.set_option(Tcp::no_delay(true));
+      // Echo on a thread of its own, to keep the echo server out of the way.
+      thread([sock = std::move(sock)]() mutable {
+        vector<uint8_t> buf(256 * 1024);
+        error_code ec;
+        while (true) {
+          size_t n = sock.read_some(asio::buffer(buf), ec);
+          if (ec.failed()) {
+            return;
+          }
+          asio::write(sock, asio::buffer(buf.data(), n), ec);
+          if (ec.failed()) {
+            return;
+          }
+        }
+      }).detach();
+    });
+  }
+
+  shared_ptr<Freelist<Buffer::Block>> freelist_;
+  asio::io_context proxy_context_;
+  asio::io_context echo_context_;
+  asio::io_context client_context_;
+  Acceptor acceptor_;
+  Tcp::acceptor echo_acceptor_;
+  uint16_t port_ = 0;
+  vector<unique_ptr<UringProxyWorker>> workers_;
+  vector<thread> threads_;
+  bool ready_ = false;
+};
+
+// The harness of each backend, kept running until exit.
+Harness& GetHarness(const benchmark::State& state) {
+  static Harness* harnesses[3] = {};
+  auto backend = static_cast<Backend>(state.range(0));
+  if (harnesses[backend] == nullptr) {
+    harnesses[backend] = new Harness(backend);
+  }
+  return *harnesses[backend];
+}
+
+bool SkipIfUnavailable(benchmark::State& state, Harness& harness) {
+  if (state.range(0) == kIoUring && !IoUring::IsSupported()) {
+    state.SkipWithError("io_uring is not supported.");
+    return true;
+  }
+  if (!harness.ready()) {
+    state.SkipWithError("The proxy cannot be set up.");
+    return true;
+  }
+  return false;
+}
+}  // namespace
+
+// Echo bulk data through one connection, with state.range(1) bytes in flight.
+void BM_BulkTransfer(benchmark::State& state) {
+  auto& harness = GetHarness(state);
+  if (SkipIfUnavailable(state, harness)) {
+    return;
+  }
+  Tcp::socket sock = harness.Connect();
+  size_t size = state.range(1);
+  vector<uint8_t> send_buf(size, 0x5a);
+  vector<uint8_t> recv_buf(size);
+  for (auto _ : state) {
+    // Write and read concurrently, so that neither side waits for the other.
+    thread writer([&]() { asio::write(sock, asio::buffer(send_buf)); });
+    asio::read(sock, asio::buffer(recv_buf));
+    writer.join();
+  }
+  // Each byte crosses the proxy twice.
+  state.SetBytesProcessed(state.iterations() * size * 2);
+}
+
+// Open a connection through the proxy, with the SOCKS5 handshake, then close.
+void BM_ConnectionSetup(benchmark::State& state) {
+  auto& harness = GetHarness(state);
+  if (SkipIfUnavailable(state, harness)) {
+    return;
+  }
+  for (auto _ : state) {
+    Tcp::socket sock = harness.Connect();
+    // Wait for the proxy to connect the echo server too.
+    uint8_t byte = 0;
+    asio::write(sock, asio::buffer(&byte, 1));
+    asio::read(sock, asio::buffer(&byte, 1));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Round trip a small message through an established connection.
+void BM_SmallMessageRtt(benchmark::State& state) {
+  auto& harness = GetHarness(state);
+  if (SkipIfUnavailable(state, harness)) {
+    return;
+  }
+  Tcp::socket sock = harness.Connect();
+  size_t size = state.range(1);
+  vector<uint8_t> buf(size, 0x5a);
+  for (auto _ : state) {
+    asio::write(sock, asio::buffer(buf));
+    asio::read(sock, asio::buffer(buf));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BulkTransfer)
+    ->ArgNames({"backend", "size"})
+    ->ArgsProduct({{kSharedFreelist, kOwnFreelist, kIoUring},
+                   {64 * 1024, 1024 * 1024}})
+    ->UseRealTime();
+BENCHMARK(BM_ConnectionSetup)
+    ->ArgNames({"backend"})
+    ->DenseRange(kSharedFreelist, kIoUring)
+    ->UseRealTime();
+BENCHMARK(BM_SmallMessageRtt)
+    ->ArgNames({"backend", "size"})
+    ->ArgsProduct({{kSharedFreelist, kOwnFreelist, kIoUring}, {64}})
+    ->UseRealTime();
+}  // namespace google::scp::proxy::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -170,6 +170,71 @@ TEST(ProxyBridge, ForwardTraffic) {
   EXPECT_EQ(ret, -1) << "fd=" << dest_sock_fd << "is still open";
 }
 
+TEST(ProxyBridge, ForwardTrafficBothDirections) {
+  asio::io_context io_context;
+  UdsSocket client_sock0(io_context);
+  UdsSocket client_sock1(io_context);
+  asio::local::connect_pair(client_sock0, client_sock1);
+  // The destination is a TCP connection, as it is for the proxy.
+  asio::ip::tcp::acceptor acceptor(
+      io_context, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),
+                                          0));
+  asio::ip::tcp::socket dest_sock0(io_context);
+  asio::ip::tcp::socket dest_sock1(io_context);
+  dest_sock0.connect(acceptor.local_endpoint());
+  acceptor.accept(dest_sock1);
+
+  {
+    auto bridge =
+        make_shared<ProxyBridge>(move(client_sock1), move(dest_sock1));
+    bridge->ForwardTraffic();
+  }
+
+  constexpr size_t kSize = 10 * 1024 * 1024;
+  auto send_buf = make_unique<uint8_t[]>(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    send_buf[i] = i & 0xff;
+  }
+  // Write one side and read the other, verifying the bytes arrive in order.
+  auto write_and_close = [&](auto& sock) {
+    error_code ec;
+    asio::write(sock, asio::buffer(send_buf.get(), kSize), ec);
+    EXPECT_FALSE(ec.failed());
+    sock.shutdown(Socket::shutdown_send, ec);
+  };
+  auto read_all = [&](auto& sock) {
+    auto recv_buf = make_unique<uint8_t[]>(1024);
+    size_t counter = 0UL;
+    while (true) {
+      error_code ec;
+      auto sz = sock.read_some(asio::buffer(recv_buf.get(), 1024), ec);
+      for (auto i = 0u; i < sz; ++i) {
+        EXPECT_EQ(recv_buf[i], counter++ & 0xff);
+      }
+      if (ec.failed()) {
+        break;
+      }
+    }
+    return counter;
+  };
+
+  thread worker_thread([&]() { io_context.run(); });
+  thread upstream_writer([&]() { write_and_close(client_sock0); });
+  thread downstream_writer([&]() { write_and_close(dest_sock0); });
+  size_t downstream_size = 0;
+  thread downstream_reader(
+      [&]() { downstream_size = read_all(client_sock0); });
+  EXPECT_EQ(read_all(dest_sock0), kSize);
+  downstream_reader.join();
+  EXPECT_EQ(downstream_size, kSize);
+
+  upstream_writer.join();
+  downstream_writer.join();
+  client_sock0.close();
+  dest_sock0.close();
+  worker_thread.join();
+}
+
 TEST(ProxyBridge, InboundConnection) {
   asio::io_context io_context;
   UdsSocket client_sock0(io_context);
@@ -247,4 +312,54 @@ TEST(ProxyBridge, InboundConnection) {
   writer_thread.join();
 }
 
+TEST(ProxyBridge, ConnectDomain) {
+  asio::io_context io_context;
+  UdsSocket client_sock0(io_context);
+  UdsSocket client_sock1(io_context);
+  asio::local::connect_pair(client_sock0, client_sock1);
+  asio::ip::tcp::acceptor acceptor(
+      io_context, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),
+                                          0));
+  DnsCache dns_cache(io_context.get_executor());
+
+  {
+    auto bridge = make_shared<ProxyBridge>(move(client_sock1), nullptr,
+                                           nullptr, &dns_cache);
+    bridge->PerformSocks5Handshake();
+  }
+
+  thread worker_thread([&]() { io_context.run(); });
+
+  uint16_t port = acceptor.local_endpoint().port();
+  uint8_t data[] = {0x05, 0x01, 0x00,        // <- Greeting
+                    0x05, 0x01, 0x00, 0x03,  // <- request header
+                    0x09, 'l',  'o',  'c',   // <- domain = localhost
+                    'a',  'l',  'h',  'o',  's', 't',
+                    static_cast<uint8_t>(port >> 8),
+                    static_cast<uint8_t>(port & 0xff)};
+  asio::write(client_sock0, asio::buffer(data));
+
+  asio::ip::tcp::socket dest_sock(io_context);
+  acceptor.accept(dest_sock);
+  uint8_t buff[64];
+  // Read greeting response
+  asio::read(client_sock0, asio::buffer(buff, 2));
+  // Read connect response
+  asio::read(client_sock0, asio::buffer(buff, 4));
+  EXPECT_EQ(buff[1], 0x00);
+
+  asio::write(dest_sock, asio::buffer("hello", 5));
+  dest_sock.shutdown(asio::ip::tcp::socket::shutdown_send);
+  error_code ec;
+  // The bound address, then the data.
+  size_t sz = asio::read(client_sock0, asio::buffer(buff), ec);
+  ASSERT_GE(sz, 5);
+  EXPECT_EQ(memcmp(buff + sz - 5, "hello", 5), 0);
+  EXPECT_EQ(dns_cache.GetStats().misses, 1);
+
+  client_sock0.close();
+  dest_sock.close();
+  worker_thread.join();
+}
+
 }  // namespace google::scp::proxy::test
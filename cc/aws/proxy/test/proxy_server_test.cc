@@ -0,0 +1,140 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/proxy_server.h"
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "proxy/src/config.h"
+
+using std::function;
+using std::string;
+using std::thread;
+using std::vector;
+using Tcp = boost::asio::ip::tcp;
+
+namespace asio = boost::asio;
+
+namespace google::scp::proxy::test {
+namespace {
+constexpr size_t kWorkerCount = 3;
+
+// Wait up to 10 seconds for condition to hold.
+bool WaitFor(const function<bool()>& condition) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+// The number of threads of the process named like the worker threads.
+size_t CountWorkerThreads() {
+  size_t count = 0;
+  for (const auto& task :
+       std::filesystem::directory_iterator("/proc/self/task")) {
+    std::ifstream comm(task.path() / "comm");
+    string name;
+    std::getline(comm, name);
+    if (name.rfind("worker_", 0) == 0) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+class ProxyServerTest : public ::testing::Test {
+ protected:
+  ProxyServerTest() : server_(MakeConfig()) {}
+
+  static Config MakeConfig() {
+    Config config;
+    config.socks5_port_ = 0;
+    config.vsock_ = false;
+    config.context_per_thread_ = true;
+    return config;
+  }
+
+  // Connect to the proxy and complete the SOCKS5 greeting, so that the
+  // connection is served by a ProxyBridge.
+  Tcp::socket Connect() {
+    Tcp::socket sock(client_context_);
+    sock.connect(Tcp::endpoint(asio::ip::address_v6::loopback(),
+                               server_.Port()));
+    uint8_t greeting[] = {0x05, 0x01, 0x00};
+    asio::write(sock, asio::buffer(greeting));
+    uint8_t resp[2];
+    asio::read(sock, asio::buffer(resp));
+    return sock;
+  }
+
+  // Wait for the connections of the worker contexts to be expected.
+  bool WaitForWorkerConnections(const vector<int64_t>& expected) {
+    return WaitFor(
+        [&]() { return server_.WorkerConnections() == expected; });
+  }
+
+  asio::io_context client_context_;
+  ProxyServer server_;
+};
+
+TEST_F(ProxyServerTest, BalancesConnectionsOnWorkerContexts) {
+  server_.BindListen();
+  thread runner([this]() { server_.Run(kWorkerCount); });
+  ASSERT_TRUE(WaitFor([this]() {
+    return server_.WorkerConnections().size() == kWorkerCount;
+  }));
+  EXPECT_TRUE(WaitFor([]() { return CountWorkerThreads() == kWorkerCount; }));
+
+  // Each connection goes to the context serving the fewest, the first one of
+  // them on a tie.
+  vector<Tcp::socket> socks;
+  socks.push_back(Connect());
+  EXPECT_TRUE(WaitForWorkerConnections({1, 0, 0}));
+  socks.push_back(Connect());
+  EXPECT_TRUE(WaitForWorkerConnections({1, 1, 0}));
+  socks.push_back(Connect());
+  EXPECT_TRUE(WaitForWorkerConnections({1, 1, 1}));
+  socks.push_back(Connect());
+  EXPECT_TRUE(WaitForWorkerConnections({2, 1, 1}));
+
+  // Closing a connection releases it from its context once its bridge closes.
+  socks[1].close();
+  EXPECT_TRUE(WaitForWorkerConnections({2, 0, 1}));
+  socks[3].close();
+  EXPECT_TRUE(WaitForWorkerConnections({1, 0, 1}));
+
+  // Run() returns once Stop() has joined all the worker threads.
+  server_.Stop();
+  runner.join();
+  EXPECT_EQ(CountWorkerThreads(), 0);
+}
+}  // namespace
+}  // namespace google::scp::proxy::test
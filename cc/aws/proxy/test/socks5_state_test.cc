@@ -21,6 +21,8 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <string>
+
 #include "proxy/src/buffer.h"
 #include "proxy/src/proxy_bridge.h"
 
@@ -365,4 +367,54 @@ TEST_F(Socks5StateTest, Bind) {
   EXPECT_TRUE(state.ConnectionSucceed());
 }
 
+TEST_F(Socks5StateTest, ConnectDomain) {
+  BufferUnitType data[] = {0x05, 0x01, 0x00,        // <- Greeting
+                           0x05, 0x01, 0x00, 0x03,  // <- request header
+                           0x07, 'e',  'x',  'a',   // <- domain = example
+                           'm',  'p',  'l',  'e',
+                           0x04, 0x00};  // <- port = 1024
+  AutoCloseSocketPair sockfd;
+  Socks5State state;
+  state.SetResponseCallback([sock = sockfd[0]](const void* data, size_t len) {
+    if (send(sock, data, len, 0) != static_cast<ssize_t>(len)) {
+      return Socks5State::kStatusFail;
+    }
+    return Socks5State::kStatusOK;
+  });
+  std::string domain;
+  uint16_t port = 0;
+  state.SetConnectDomainCallback(
+      [&](const std::string& requested_domain, uint16_t requested_port) {
+        domain = requested_domain;
+        port = requested_port;
+        return Socks5State::kStatusInProgress;
+      });
+
+  Buffer buffer;
+  buffer.CopyIn(data, sizeof(data));
+  state.Proceed(buffer);
+  state.Proceed(buffer);
+  state.Proceed(buffer);
+  EXPECT_EQ(state.state(), Socks5State::kRequestDomainLength);
+  state.Proceed(buffer);
+  EXPECT_EQ(state.state(), Socks5State::kRequestDomain);
+  state.Proceed(buffer);
+  EXPECT_EQ(state.state(), Socks5State::kWaitConnect);
+  EXPECT_EQ(domain, "example");
+  EXPECT_EQ(port, 1024);
+}
+
+TEST_F(Socks5StateTest, ConnectDomainUnsupported) {
+  BufferUnitType data[] = {0x05, 0x01, 0x00,        // <- Greeting
+                           0x05, 0x01, 0x00, 0x03,  // <- request header
+                           0x01, 'a',  0x04, 0x00};  // <- domain, port
+  Socks5State state;
+  Buffer buffer;
+  buffer.CopyIn(data, sizeof(data));
+  state.Proceed(buffer);
+  state.Proceed(buffer);
+  state.Proceed(buffer);
+  EXPECT_EQ(state.state(), Socks5State::kFail);
+}
+
 }  // namespace google::scp::proxy::test
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proxy/src/uring_proxy_worker.h"
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <memory>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "proxy/src/io_uring.h"
+
+using boost::system::error_code;
+using std::make_shared;
+using std::make_unique;
+using std::thread;
+using Tcp = boost::asio::ip::tcp;
+
+namespace asio = boost::asio;
+
+namespace google::scp::proxy::test {
+
+class UringProxyWorkerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!IoUring::IsSupported()) {
+      GTEST_SKIP() << "io_uring is not supported.";
+    }
+    auto localhost = Tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0);
+    listener_ = make_unique<Tcp::acceptor>(io_context_, localhost);
+    dest_acceptor_ = make_unique<Tcp::acceptor>(io_context_, localhost);
+    worker_ = make_unique<UringProxyWorker>(
+        listener_->native_handle(), make_shared<Freelist<Buffer::Block>>());
+    ASSERT_TRUE(worker_->Init());
+    worker_thread_ = thread([this]() { worker_->Run(); });
+  }
+
+  void TearDown() override {
+    if (worker_thread_.joinable()) {
+      worker_->Stop();
+      worker_thread_.join();
+    }
+  }
+
+  // Connect to the worker and send the greeting, returning the greeting
+  // response.
+  Tcp::socket Greet() {
+    Tcp::socket sock(io_context_);
+    sock.connect(listener_->local_endpoint());
+    uint8_t greeting[] = {0x05, 0x01, 0x00};
+    asio::write(sock, asio::buffer(greeting));
+    uint8_t resp[2];
+    asio::read(sock, asio::buffer(resp));
+    EXPECT_EQ(resp[0], 0x05);
+    EXPECT_EQ(resp[1], 0x00);
+    return sock;
+  }
+
+  asio::io_context io_context_;
+  std::unique_ptr<Tcp::acceptor> listener_;
+  std::unique_ptr<Tcp::acceptor> dest_acceptor_;
+  std::unique_ptr<UringProxyWorker> worker_;
+  thread worker_thread_;
+};
+
+TEST_F(UringProxyWorkerTest, ForwardTrafficBothDirections) {
+  Tcp::socket client_sock = Greet();
+  uint16_t port = dest_acceptor_->local_endpoint().port();
+  uint8_t request[] = {0x05, 0x01, 0x00, 0x01,  // <- CONNECT IPv4
+                       0x7f, 0x00, 0x00, 0x01,  // <- addr = 127.0.0.1
+                       static_cast<uint8_t>(port >> 8),
+                       static_cast<uint8_t>(port & 0xff)};
+  asio::write(client_sock, asio::buffer(request));
+  Tcp::socket dest_sock(io_context_);
+  dest_acceptor_->accept(dest_sock);
+  uint8_t resp[10];
+  asio::read(client_sock, asio::buffer(resp));
+  EXPECT_EQ(resp[0], 0x05);
+  EXPECT_EQ(resp[1], 0x00);
+
+  constexpr size_t kSize = 10 * 1024 * 1024;
+  auto send_buf = make_unique<uint8_t[]>(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    send_buf[i] = i & 0xff;
+  }
+  // Write one side and read the other, verifying the bytes arrive in order.
+  auto write_and_close = [&](Tcp::socket& sock) {
+    error_code ec;
+    asio::write(sock, asio::buffer(send_buf.get(), kSize), ec);
+    EXPECT_FALSE(ec.failed());
+    sock.shutdown(Tcp::socket::shutdown_send, ec);
+  };
+  auto read_all = [&](Tcp::socket& sock) {
+    auto recv_buf = make_unique<uint8_t[]>(65536);
+    size_t counter = 0UL;
+    while (true) {
+      error_code ec;
+      auto sz = sock.read_some(asio::buffer(recv_buf.get(), 65536), ec);
+      for (auto i = 0u; i < sz; ++i) {
+        EXPECT_EQ(recv_buf[i], counter++ & 0xff);
+      }
+      if (ec.failed()) {
+        break;
+      }
+    }
+    return counter;
+  };
+
+  thread upstream_writer([&]() { write_and_close(client_sock); });
+  thread downstream_writer([&]() { write_and_close(dest_sock); });
+  size_t downstream_size = 0;
+  thread downstream_reader(
+      [&]() { downstream_size = read_all(client_sock); });
+  EXPECT_EQ(read_all(dest_sock), kSize);
+  downstream_reader.join();
+  EXPECT_EQ(downstream_size, kSize);
+
+  upstream_writer.join();
+  downstream_writer.join();
+}
+
+TEST_F(UringProxyWorkerTest, RejectBind) {
+  Tcp::socket client_sock = Greet();
+  uint8_t request[] = {0x05, 0x02, 0x00, 0x01,  // <- BIND IPv4
+                       0x7f, 0x00, 0x00, 0x01,  // <- addr = 127.0.0.1
+                       0x00, 0x00};             // <- port = 0
+  asio::write(client_sock, asio::buffer(request));
+  uint8_t buff[64];
+  error_code ec;
+  size_t sz = 0;
+  while (!ec.failed()) {
+    sz += client_sock.read_some(asio::buffer(buff), ec);
+  }
+  EXPECT_EQ(ec, asio::error::eof);
+}
+}  // namespace google::scp::proxy::test
@@ -80,7 +80,19 @@ class MockAsyncExecutor : public core::AsyncExecutorInterface {
     return ScheduleFor(work, timestamp, cancellation_callback);
   }
 
+  ExecutionResult ScheduleToShard(const AsyncOperation& work,
+                                  AsyncPriority priority,
+                                  uint64_t shard_key) noexcept override {
+    if (schedule_to_shard_mock) {
+      return schedule_to_shard_mock(work, shard_key);
+    }
+
+    return Schedule(work, priority);
+  }
+
   std::function<ExecutionResult(const AsyncOperation& work)> schedule_mock;
+  std::function<ExecutionResult(const AsyncOperation& work, uint64_t)>
+      schedule_to_shard_mock;
   std::function<ExecutionResult(const AsyncOperation& work, Timestamp,
                                 std::function<bool()>&)>
       schedule_for_mock;
@@ -14,6 +14,7 @@
 
 #include "async_executor.h"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -52,25 +53,62 @@ ExecutionResult AsyncExecutor::Init() noexcept {
     return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_INVALID_QUEUE_CAP);
   }
 
+  auto numa_node_cpus = AsyncExecutorUtils::GetNumaNodeCpus();
+  auto placement = AsyncExecutorUtils::GetThreadPlacement(
+      thread_placement_policy_, thread_count_, numa_node_cpus);
+  if (thread_placement_policy_ == ThreadPlacementPolicy::NumaInterleaved &&
+      numa_node_cpus.size() > 1) {
+    cpu_to_numa_node_ = AsyncExecutorUtils::GetCpuToNumaNodeMap(numa_node_cpus);
+    numa_node_to_executor_indices_.resize(numa_node_cpus.size());
+    for (size_t i = 0; i < thread_count_; ++i) {
+      numa_node_to_executor_indices_[i % numa_node_cpus.size()].push_back(i);
+    }
+  }
+
   for (size_t i = 0; i < thread_count_; ++i) {
-    // TODO We select the CPU affinity just starting at 0 and working our way
-    // up. Should we instead randomly assign the CPUs?
-    size_t cpu_affinity_number = i % std::thread::hardware_concurrency();
-    urgent_task_executor_pool_.push_back(
-        make_shared<SingleThreadPriorityAsyncExecutor>(
-            queue_cap_, drop_tasks_on_stop_, cpu_affinity_number));
+    auto cpu_affinity_number = placement[i];
+    if (scheduled_task_queue_type_ == ScheduledTaskQueueType::TimerWheel) {
+      urgent_task_executor_pool_.push_back(
+          make_shared<SingleThreadTimerWheelAsyncExecutor>(
+              queue_cap_, drop_tasks_on_stop_, cpu_affinity_number));
+    } else {
+      urgent_task_executor_pool_.push_back(
+          make_shared<SingleThreadPriorityAsyncExecutor>(
+              queue_cap_, drop_tasks_on_stop_, cpu_affinity_number,
+              wait_strategy_));
+    }
     auto execution_result = urgent_task_executor_pool_.back()->Init();
     if (!execution_result.Successful()) {
       return execution_result;
     }
     normal_task_executor_pool_.push_back(make_shared<SingleThreadAsyncExecutor>(
-        queue_cap_, drop_tasks_on_stop_, cpu_affinity_number));
+        queue_cap_, drop_tasks_on_stop_, cpu_affinity_number, telemetry_, i,
+        wait_strategy_, task_ordering_policy_));
     execution_result = normal_task_executor_pool_.back()->Init();
     if (!execution_result.Successful()) {
       return execution_result;
     }
   }
 
+  if (task_load_balancing_scheme_ == TaskLoadBalancingScheme::WorkStealing) {
+    if (numa_node_to_executor_indices_.empty()) {
+      for (auto& normal_executor : normal_task_executor_pool_) {
+        normal_executor->SetWorkStealingSiblings(normal_task_executor_pool_);
+      }
+    } else {
+      // Stealing across the nodes would move the work away from its memory.
+      for (const auto& executor_indices : numa_node_to_executor_indices_) {
+        vector<shared_ptr<NormalTaskExecutor>> siblings;
+        for (auto index : executor_indices) {
+          siblings.push_back(normal_task_executor_pool_.at(index));
+        }
+        for (auto& normal_executor : siblings) {
+          normal_executor->SetWorkStealingSiblings(siblings);
+        }
+      }
+    }
+  }
+
   return SuccessExecutionResult();
 }
 
@@ -106,6 +144,15 @@ ExecutionResult AsyncExecutor::Run() noexcept {
                                                     urgent_executor};
   }
 
+  if (telemetry_) {
+    telemetry_->SetQueueDepthProvider([this](vector<size_t>& queue_depths) {
+      queue_depths.clear();
+      for (const auto& normal_executor : normal_task_executor_pool_) {
+        queue_depths.push_back(normal_executor->GetQueueDepth());
+      }
+    });
+  }
+
   running_ = true;
 
   return SuccessExecutionResult();
@@ -118,6 +165,10 @@ ExecutionResult AsyncExecutor::Stop() noexcept {
 
   running_ = false;
 
+  if (telemetry_) {
+    telemetry_->SetQueueDepthProvider(nullptr);
+  }
+
   // Ensures all of thread are waited to finish.
   for (size_t i = 0; i < thread_count_; ++i) {
     auto execution_result = urgent_task_executor_pool_.at(i)->Stop();
@@ -176,14 +227,15 @@ ExecutionResultOr<shared_ptr<TaskExecutorType>> AsyncExecutor::PickTaskExecutor(
   if (task_load_balancing_scheme ==
       TaskLoadBalancingScheme::RoundRobinPerThread) {
     if (task_executor_pool_type == TaskExecutorPoolType::UrgentPool) {
-      auto picked_index =
-          task_counter_urgent_thread_local.fetch_add(1, memory_order_relaxed) %
-          task_executor_pool.size();
+      auto picked_index = ToExecutorIndex(
+          task_counter_urgent_thread_local.fetch_add(1, memory_order_relaxed),
+          task_executor_pool.size());
       return task_executor_pool.at(picked_index);
     } else if (task_executor_pool_type == TaskExecutorPoolType::NotUrgentPool) {
-      auto picked_index = task_counter_not_urgent_thread_local.fetch_add(
-                              1, memory_order_relaxed) %
-                          task_executor_pool.size();
+      auto picked_index = ToExecutorIndex(
+          task_counter_not_urgent_thread_local.fetch_add(1,
+                                                         memory_order_relaxed),
+          task_executor_pool.size());
       return task_executor_pool.at(picked_index);
     } else {
       return FailureExecutionResult(
@@ -192,19 +244,22 @@ ExecutionResultOr<shared_ptr<TaskExecutorType>> AsyncExecutor::PickTaskExecutor(
   }
 
   if (task_load_balancing_scheme == TaskLoadBalancingScheme::Random) {
-    auto picked_index =
-        distribution(random_generator) % task_executor_pool.size();
+    auto picked_index = ToExecutorIndex(distribution(random_generator),
+                                        task_executor_pool.size());
     return task_executor_pool.at(picked_index);
   }
 
-  if (task_load_balancing_scheme == TaskLoadBalancingScheme::RoundRobinGlobal) {
+  // With work stealing, the initial placement is Round Robin and the idle
+  // executors even out the load afterwards.
+  if (task_load_balancing_scheme == TaskLoadBalancingScheme::RoundRobinGlobal ||
+      task_load_balancing_scheme == TaskLoadBalancingScheme::WorkStealing) {
     if (task_executor_pool_type == TaskExecutorPoolType::UrgentPool) {
-      auto picked_index =
-          task_counter_urgent.fetch_add(1) % task_executor_pool.size();
+      auto picked_index = ToExecutorIndex(task_counter_urgent.fetch_add(1),
+                                          task_executor_pool.size());
       return task_executor_pool.at(picked_index);
     } else if (task_executor_pool_type == TaskExecutorPoolType::NotUrgentPool) {
-      auto picked_index =
-          task_counter_not_urgent.fetch_add(1) % task_executor_pool.size();
+      auto picked_index = ToExecutorIndex(task_counter_not_urgent.fetch_add(1),
+                                          task_executor_pool.size());
       return task_executor_pool.at(picked_index);
     } else {
       return FailureExecutionResult(
@@ -216,6 +271,21 @@ ExecutionResultOr<shared_ptr<TaskExecutorType>> AsyncExecutor::PickTaskExecutor(
       errors::SC_ASYNC_EXECUTOR_INVALID_LOAD_BALANCING_TYPE);
 }
 
+size_t AsyncExecutor::ToExecutorIndex(uint64_t counter,
+                                      size_t pool_size) const noexcept {
+  if (!numa_node_to_executor_indices_.empty()) {
+    auto current_cpu = AsyncExecutorUtils::GetCurrentCpu();
+    if (current_cpu.has_value() && *current_cpu < cpu_to_numa_node_.size()) {
+      const auto& executor_indices =
+          numa_node_to_executor_indices_[cpu_to_numa_node_[*current_cpu]];
+      if (!executor_indices.empty()) {
+        return executor_indices[counter % executor_indices.size()];
+      }
+    }
+  }
+  return counter % pool_size;
+}
+
 ExecutionResult AsyncExecutor::Schedule(const AsyncOperation& work,
                                         AsyncPriority priority) noexcept {
   return Schedule(work, priority, AsyncExecutorAffinitySetting::NonAffinitized);
@@ -250,6 +320,38 @@ ExecutionResult AsyncExecutor::Schedule(
       errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
 }
 
+ExecutionResult AsyncExecutor::Schedule(const AsyncOperation& work,
+                                        AsyncPriority priority,
+                                        const AsyncTaskTag& tag) noexcept {
+  // Reading the CPU clock of a thread is a system call, so only the sampled
+  // tasks are wrapped. The counter is per scheduling thread so that producers
+  // do not contend on it.
+  static thread_local uint32_t tagged_task_count = 0;
+  if (tag.component == nullptr || tag.operation == nullptr ||
+      ++tagged_task_count % task_tag_sampling_period_ != 0) {
+    return Schedule(work, priority);
+  }
+
+  return Schedule(
+      [work, tag, task_count = task_tag_sampling_period_,
+       task_tag_stats = task_tag_stats_, telemetry = telemetry_]() {
+        auto start_cpu_time = AsyncExecutorUtils::GetCurrentThreadCpuTime();
+        work();
+        auto cpu_time =
+            (AsyncExecutorUtils::GetCurrentThreadCpuTime() - start_cpu_time) *
+            task_count;
+        task_tag_stats->Record(tag, task_count, cpu_time);
+        if (telemetry) {
+          telemetry->RecordTaggedTask(tag, task_count, cpu_time);
+        }
+      },
+      priority);
+}
+
+vector<AsyncTaskTagStats> AsyncExecutor::GetTaskTagStats() const noexcept {
+  return task_tag_stats_->GetStats();
+}
+
 ExecutionResult AsyncExecutor::ScheduleFor(const AsyncOperation& work,
                                            Timestamp timestamp) noexcept {
   return ScheduleFor(work, timestamp,
@@ -284,4 +386,110 @@ ExecutionResult AsyncExecutor::ScheduleFor(
                                     task_load_balancing_scheme_));
   return task_executor->ScheduleFor(work, timestamp, cancellation_callback);
 }
+
+ExecutionResult AsyncExecutor::ScheduleWithDeadline(
+    const AsyncOperation& work, AsyncPriority priority, Timestamp deadline,
+    const AsyncOperation& on_expired) noexcept {
+  if (!running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  if (priority == AsyncPriority::Urgent) {
+    return AsyncExecutorInterface::ScheduleWithDeadline(work, priority,
+                                                        deadline, on_expired);
+  }
+
+  if (priority == AsyncPriority::Normal || priority == AsyncPriority::High) {
+    ASSIGN_OR_RETURN(
+        auto task_executor,
+        PickTaskExecutor(AsyncExecutorAffinitySetting::NonAffinitized,
+                         normal_task_executor_pool_,
+                         TaskExecutorPoolType::NotUrgentPool,
+                         task_load_balancing_scheme_));
+    return task_executor->ScheduleWithDeadline(work, priority, deadline,
+                                               on_expired);
+  }
+
+  return FailureExecutionResult(
+      errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
+}
+
+ExecutionResult AsyncExecutor::ScheduleToShard(const AsyncOperation& work,
+                                               AsyncPriority priority,
+                                               uint64_t shard_key) noexcept {
+  if (!running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  if (priority == AsyncPriority::Urgent) {
+    auto& task_executor = urgent_task_executor_pool_.at(
+        shard_key % urgent_task_executor_pool_.size());
+    AsyncTask task(work);  // Creates a task for now
+    return task_executor->ScheduleFor(work, task.GetExecutionTimestamp());
+  }
+
+  if (priority == AsyncPriority::Normal || priority == AsyncPriority::High) {
+    auto& task_executor = normal_task_executor_pool_.at(
+        shard_key % normal_task_executor_pool_.size());
+    return task_executor->Schedule(work, priority);
+  }
+
+  return FailureExecutionResult(
+      errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
+}
+
+ExecutionResult AsyncExecutor::ScheduleBatch(
+    absl::Span<const AsyncOperation> works, AsyncPriority priority) noexcept {
+  size_t scheduled_count = 0;
+  return ScheduleBatch(works, priority, scheduled_count);
+}
+
+ExecutionResult AsyncExecutor::ScheduleBatch(
+    absl::Span<const AsyncOperation> works, AsyncPriority priority,
+    size_t& scheduled_count) noexcept {
+  scheduled_count = 0;
+  if (!running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  if (priority == AsyncPriority::Urgent) {
+    return AsyncExecutorInterface::ScheduleBatch(works, priority,
+                                                 scheduled_count);
+  }
+
+  if (priority != AsyncPriority::Normal && priority != AsyncPriority::High) {
+    return FailureExecutionResult(
+        errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
+  }
+
+  static atomic<uint64_t> batch_chunk_counter(0);
+
+  auto chunk_count = std::min(
+      normal_task_executor_pool_.size(),
+      (works.size() + kMinScheduleBatchChunkSize - 1) /
+          kMinScheduleBatchChunkSize);
+  if (chunk_count == 0) {
+    return SuccessExecutionResult();
+  }
+  auto first_chunk = batch_chunk_counter.fetch_add(chunk_count);
+
+  // The chunks are handed over in order and the first failure stops the
+  // batch, so the scheduled tasks are always a prefix of the batch.
+  for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+    auto& task_executor = normal_task_executor_pool_.at(ToExecutorIndex(
+        first_chunk + chunk, normal_task_executor_pool_.size()));
+    // The works are split evenly, the chunks differ in size by one at most.
+    auto chunk_begin = chunk * works.size() / chunk_count;
+    auto chunk_end = (chunk + 1) * works.size() / chunk_count;
+    size_t chunk_scheduled_count = 0;
+    auto execution_result = task_executor->ScheduleBatch(
+        works.subspan(chunk_begin, chunk_end - chunk_begin), priority,
+        chunk_scheduled_count);
+    scheduled_count += chunk_scheduled_count;
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+  return SuccessExecutionResult();
+}
 }  // namespace google::scp::core
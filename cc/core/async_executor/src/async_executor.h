@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
@@ -29,10 +30,16 @@
 #include "core/interface/async_executor_interface.h"
 #include "public/core/interface/execution_result.h"
 
+#include "async_executor_telemetry.h"
+#include "async_executor_utils.h"
 #include "async_task.h"
+#include "async_task_tag_stats_recorder.h"
 #include "error_codes.h"
+#include "executor_wait_strategy.h"
 #include "single_thread_async_executor.h"
 #include "single_thread_priority_async_executor.h"
+#include "single_thread_scheduled_async_executor.h"
+#include "single_thread_timer_wheel_async_executor.h"
 
 static constexpr char kAsyncExecutor[] = "AsyncExecutor";
 
@@ -53,7 +60,31 @@ enum class TaskLoadBalancingScheme {
   /**
    * @brief Random across the executors
    */
-  Random = 2
+  Random = 2,
+  /**
+   * @brief Round Robin across the executors, and idle normal executors steal
+   * pending normal priority tasks from their busy siblings. Urgent executors
+   * are Round Robin only since their tasks are scheduled for a given time.
+   */
+  WorkStealing = 3
+};
+
+/**
+ * @brief Data structure the urgent pool executors use to keep the tasks
+ * scheduled for a given time.
+ */
+enum class ScheduledTaskQueueType {
+  /**
+   * @brief Priority queue ordered by the execution time, guarded by a lock.
+   * Scheduling is O(log n).
+   */
+  PriorityQueue = 0,
+  /**
+   * @brief Hierarchical timing wheel fed by a concurrent intake queue.
+   * Scheduling and cancelling are O(1), tasks run within one tick of their
+   * execution time.
+   */
+  TimerWheel = 1
 };
 
 /**
@@ -78,16 +109,47 @@ class AsyncExecutor : public AsyncExecutorInterface {
    * the tasks during the stop operation.
    * @param task_load_balancing_scheme indicates the type of load balancing
    * scheme to use for the tasks
+   * @param scheduled_task_queue_type indicates the data structure the urgent
+   * executors keep the scheduled tasks in
+   * @param thread_placement_policy indicates how the executor threads are
+   * pinned to the CPUs. With NumaInterleaved, the non-affinitized tasks are
+   * placed on the executors of the caller's NUMA node, and work is only stolen
+   * from the executors of the same node.
+   * @param telemetry an optional sink for the sampled task timings and the
+   * queue depths of the normal executors
+   * @param wait_strategy how the idle executor threads wait for work. The
+   * timer wheel urgent executors always park.
+   * @param task_ordering_policy the order the normal executors run their
+   * normal priority tasks in.
    */
   AsyncExecutor(size_t thread_count, size_t queue_cap,
                 bool drop_tasks_on_stop = false,
                 TaskLoadBalancingScheme task_load_balancing_scheme =
-                    TaskLoadBalancingScheme::RoundRobinGlobal)
+                    TaskLoadBalancingScheme::RoundRobinGlobal,
+                ScheduledTaskQueueType scheduled_task_queue_type =
+                    ScheduledTaskQueueType::PriorityQueue,
+                ThreadPlacementPolicy thread_placement_policy =
+                    ThreadPlacementPolicy::SequentialCpu,
+                std::shared_ptr<AsyncExecutorTelemetryInterface> telemetry =
+                    nullptr,
+                ExecutorWaitStrategy wait_strategy =
+                    ExecutorWaitStrategy::Park(),
+                TaskOrderingPolicy task_ordering_policy =
+                    TaskOrderingPolicy::Fifo)
       : running_(false),
         thread_count_(thread_count),
         queue_cap_(queue_cap),
         drop_tasks_on_stop_(drop_tasks_on_stop),
-        task_load_balancing_scheme_(task_load_balancing_scheme) {}
+        task_load_balancing_scheme_(task_load_balancing_scheme),
+        scheduled_task_queue_type_(scheduled_task_queue_type),
+        thread_placement_policy_(thread_placement_policy),
+        telemetry_(std::move(telemetry)),
+        wait_strategy_(wait_strategy),
+        task_ordering_policy_(task_ordering_policy),
+        task_tag_sampling_period_(
+            telemetry_ ? std::max<uint32_t>(telemetry_->GetSamplingPeriod(), 1)
+                       : kDefaultAsyncExecutorTelemetrySamplingPeriod),
+        task_tag_stats_(std::make_shared<AsyncTaskTagStatsRecorder>()) {}
 
   ExecutionResult Init() noexcept override;
 
@@ -102,6 +164,15 @@ class AsyncExecutor : public AsyncExecutorInterface {
       const AsyncOperation& work, AsyncPriority priority,
       AsyncExecutorAffinitySetting affinity) noexcept override;
 
+  /**
+   * @copydoc AsyncExecutorInterface::Schedule
+   *
+   * Only one tagged task out of the telemetry sampling period is timed with
+   * the CPU clock of its thread, and stands for the whole period in the stats.
+   */
+  ExecutionResult Schedule(const AsyncOperation& work, AsyncPriority priority,
+                           const AsyncTaskTag& tag) noexcept override;
+
   ExecutionResult ScheduleFor(const AsyncOperation& work,
                               Timestamp timestamp) noexcept override;
 
@@ -118,8 +189,46 @@ class AsyncExecutor : public AsyncExecutorInterface {
       TaskCancellationLambda& cancellation_callback,
       AsyncExecutorAffinitySetting affinity) noexcept override;
 
+  /**
+   * @copydoc AsyncExecutorInterface::ScheduleWithDeadline
+   *
+   * Normal and high priority tasks are checked against their deadline by the
+   * normal executors, which run the normal priority ones earliest deadline
+   * first with the EarliestDeadlineFirst task ordering policy. Urgent tasks
+   * are scheduled as Schedule does, and checked when they run.
+   */
+  ExecutionResult ScheduleWithDeadline(
+      const AsyncOperation& work, AsyncPriority priority, Timestamp deadline,
+      const AsyncOperation& on_expired) noexcept override;
+
+  /**
+   * @copydoc AsyncExecutorInterface::ScheduleToShard
+   *
+   * The executor is picked by the shard key alone, regardless of the load
+   * balancing scheme and of the NUMA node of the calling thread.
+   */
+  ExecutionResult ScheduleToShard(const AsyncOperation& work,
+                                  AsyncPriority priority,
+                                  uint64_t shard_key) noexcept override;
+
+  /**
+   * @copydoc AsyncExecutorInterface::ScheduleBatch
+   *
+   * Normal and high priority batches are split in contiguous chunks of at
+   * least kMinScheduleBatchChunkSize tasks, each handed to one executor with a
+   * single signal. Urgent tasks are scheduled one by one.
+   */
+  ExecutionResult ScheduleBatch(absl::Span<const AsyncOperation> works,
+                                AsyncPriority priority,
+                                size_t& scheduled_count) noexcept override;
+
+  ExecutionResult ScheduleBatch(absl::Span<const AsyncOperation> works,
+                                AsyncPriority priority) noexcept override;
+
+  std::vector<AsyncTaskTagStats> GetTaskTagStats() const noexcept override;
+
  protected:
-  using UrgentTaskExecutor = SingleThreadPriorityAsyncExecutor;
+  using UrgentTaskExecutor = SingleThreadScheduledAsyncExecutor;
   using NormalTaskExecutor = SingleThreadAsyncExecutor;
 
   template <class TaskExecutorType>
@@ -129,6 +238,17 @@ class AsyncExecutor : public AsyncExecutorInterface {
       TaskExecutorPoolType task_executor_pool_type,
       TaskLoadBalancingScheme task_load_balancing_scheme);
 
+  /**
+   * @brief Maps a load balancing counter to an executor index. With the
+   * NumaInterleaved placement, only the executors on the NUMA node of the
+   * calling thread are considered.
+   *
+   * @param counter the value of the load balancing counter.
+   * @param pool_size the number of executors in the pool.
+   * @return size_t the index of the executor to use.
+   */
+  size_t ToExecutorIndex(uint64_t counter, size_t pool_size) const noexcept;
+
   /**
    * @brief While it is true, the thread pool will keep listening and
    * picking out work from work queue. While it is false, the thread pool
@@ -154,5 +274,25 @@ class AsyncExecutor : public AsyncExecutorInterface {
   /// Load balancing scheme to distribute incoming tasks on to the thread pool
   /// threads.
   TaskLoadBalancingScheme task_load_balancing_scheme_;
+  /// Data structure the urgent executors keep the scheduled tasks in.
+  ScheduledTaskQueueType scheduled_task_queue_type_;
+  /// Placement of the executor threads over the CPUs.
+  ThreadPlacementPolicy thread_placement_policy_;
+  /// The indices of the executors placed on each NUMA node. Only populated
+  /// with the NumaInterleaved placement on a machine with several nodes.
+  std::vector<std::vector<size_t>> numa_node_to_executor_indices_;
+  /// The NUMA node of each CPU, indexed by CPU.
+  std::vector<size_t> cpu_to_numa_node_;
+  /// Optional sink of the executor telemetry.
+  std::shared_ptr<AsyncExecutorTelemetryInterface> telemetry_;
+  /// How the idle executor threads wait for work.
+  ExecutorWaitStrategy wait_strategy_;
+  /// The order the normal executors run their normal priority tasks in.
+  TaskOrderingPolicy task_ordering_policy_;
+  /// One tagged task out of this many is timed.
+  uint32_t task_tag_sampling_period_;
+  /// The stats of the tagged tasks. Shared with the timed tasks so that they
+  /// do not point back to the executor.
+  std::shared_ptr<AsyncTaskTagStatsRecorder> task_tag_stats_;
 };
 }  // namespace google::scp::core
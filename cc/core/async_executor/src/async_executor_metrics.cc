@@ -0,0 +1,198 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "async_executor_metrics.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "core/interface/type_def.h"
+#include "opentelemetry/context/context.h"
+
+namespace google::scp::core {
+namespace {
+constexpr auto kHistogramType = MetricRouter::InstrumentType::kHistogram;
+}  // namespace
+
+AsyncExecutorMetrics::~AsyncExecutorMetrics() {
+  if (queue_depth_instrument_) {
+    queue_depth_instrument_->RemoveCallback(
+        reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
+            &AsyncExecutorMetrics::ObserveQueueDepthCallback),
+        this);
+  }
+}
+
+ExecutionResult AsyncExecutorMetrics::Init() noexcept {
+  if (!metric_router_) {
+    return SuccessExecutionResult();
+  }
+
+  meter_ = metric_router_->GetOrCreateMeter(kAsyncExecutorMeter);
+
+  // Tasks are expected to wait and run for microseconds to milliseconds.
+  static std::vector<double> kTaskTimeBoundaries = {
+      0.00001, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025,
+      0.005,   0.01,    0.025,  0.05,    0.1,    0.5,   1};
+
+  metric_router_->CreateHistogramViewForInstrument(
+      /*metric_name=*/kAsyncExecutorTaskWaitTimeMetric,
+      /*view_name=*/kAsyncExecutorTaskWaitTimeView,
+      /*instrument_type=*/kHistogramType,
+      /*boundaries=*/kTaskTimeBoundaries,
+      /*version=*/"", /*schema=*/"",
+      /*view_description=*/"Async executor task wait time histogram",
+      /*unit=*/kSecondUnit);
+
+  metric_router_->CreateHistogramViewForInstrument(
+      /*metric_name=*/kAsyncExecutorTaskRunTimeMetric,
+      /*view_name=*/kAsyncExecutorTaskRunTimeView,
+      /*instrument_type=*/kHistogramType,
+      /*boundaries=*/kTaskTimeBoundaries,
+      /*version=*/"", /*schema=*/"",
+      /*view_description=*/"Async executor task run time histogram",
+      /*unit=*/kSecondUnit);
+
+  task_wait_time_histogram_ =
+      std::static_pointer_cast<opentelemetry::metrics::Histogram<double>>(
+          metric_router_->GetOrCreateSyncInstrument(
+              kAsyncExecutorTaskWaitTimeMetric,
+              [&]() -> std::shared_ptr<
+                        opentelemetry::metrics::SynchronousInstrument> {
+                return meter_->CreateDoubleHistogram(
+                    kAsyncExecutorTaskWaitTimeMetric,
+                    "Time between the enqueue and the start of the sampled "
+                    "tasks in seconds",
+                    kSecondUnit);
+              }));
+
+  task_run_time_histogram_ =
+      std::static_pointer_cast<opentelemetry::metrics::Histogram<double>>(
+          metric_router_->GetOrCreateSyncInstrument(
+              kAsyncExecutorTaskRunTimeMetric,
+              [&]() -> std::shared_ptr<
+                        opentelemetry::metrics::SynchronousInstrument> {
+                return meter_->CreateDoubleHistogram(
+                    kAsyncExecutorTaskRunTimeMetric,
+                    "Run time of the sampled tasks in seconds", kSecondUnit);
+              }));
+
+  tagged_task_counter_ =
+      std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
+          metric_router_->GetOrCreateSyncInstrument(
+              kAsyncExecutorTaggedTaskCountMetric,
+              [&]() -> std::shared_ptr<
+                        opentelemetry::metrics::SynchronousInstrument> {
+                return meter_->CreateUInt64Counter(
+                    kAsyncExecutorTaggedTaskCountMetric,
+                    "Estimated number of tasks run for each task tag");
+              }));
+
+  tagged_task_cpu_time_counter_ =
+      std::static_pointer_cast<opentelemetry::metrics::Counter<double>>(
+          metric_router_->GetOrCreateSyncInstrument(
+              kAsyncExecutorTaggedTaskCpuTimeMetric,
+              [&]() -> std::shared_ptr<
+                        opentelemetry::metrics::SynchronousInstrument> {
+                return meter_->CreateDoubleCounter(
+                    kAsyncExecutorTaggedTaskCpuTimeMetric,
+                    "Estimated CPU time of the tasks of each task tag in "
+                    "seconds",
+                    kSecondUnit);
+              }));
+
+  queue_depth_instrument_ = metric_router_->GetOrCreateObservableInstrument(
+      kAsyncExecutorQueueDepthMetric,
+      [&]() -> std::shared_ptr<opentelemetry::metrics::ObservableInstrument> {
+        return meter_->CreateInt64ObservableGauge(
+            kAsyncExecutorQueueDepthMetric,
+            "Number of tasks waiting in the queues of the executor");
+      });
+  queue_depth_instrument_->AddCallback(
+      reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
+          &AsyncExecutorMetrics::ObserveQueueDepthCallback),
+      this);
+
+  return SuccessExecutionResult();
+}
+
+void AsyncExecutorMetrics::RecordTask(
+    size_t executor_index, std::chrono::nanoseconds wait_time,
+    std::chrono::nanoseconds run_time) noexcept {
+  if (!task_wait_time_histogram_ || !task_run_time_histogram_) {
+    return;
+  }
+
+  absl::flat_hash_map<std::string, std::string> label_kv = {
+      {std::string(kAsyncExecutorNameLabel), executor_name_},
+      {std::string(kAsyncExecutorIndexLabel), std::to_string(executor_index)}};
+  opentelemetry::context::Context context;
+  task_wait_time_histogram_->Record(
+      std::chrono::duration<double>(wait_time).count(), label_kv, context);
+  task_run_time_histogram_->Record(
+      std::chrono::duration<double>(run_time).count(), label_kv, context);
+}
+
+void AsyncExecutorMetrics::RecordTaggedTask(
+    const AsyncTaskTag& tag, uint64_t task_count,
+    std::chrono::nanoseconds cpu_time) noexcept {
+  if (!tagged_task_counter_ || !tagged_task_cpu_time_counter_ ||
+      tag.component == nullptr || tag.operation == nullptr) {
+    return;
+  }
+
+  absl::flat_hash_map<std::string, std::string> label_kv = {
+      {std::string(kAsyncExecutorNameLabel), executor_name_},
+      {std::string(kAsyncExecutorTaskComponentLabel), tag.component},
+      {std::string(kAsyncExecutorTaskOperationLabel), tag.operation}};
+  opentelemetry::context::Context context;
+  tagged_task_counter_->Add(task_count, label_kv, context);
+  tagged_task_cpu_time_counter_->Add(
+      std::chrono::duration<double>(cpu_time).count(), label_kv, context);
+}
+
+void AsyncExecutorMetrics::SetQueueDepthProvider(
+    ExecutorQueueDepthProvider queue_depth_provider) noexcept {
+  absl::MutexLock lock(&queue_depth_provider_mutex_);
+  queue_depth_provider_ = std::move(queue_depth_provider);
+}
+
+void AsyncExecutorMetrics::ObserveQueueDepthCallback(
+    opentelemetry::metrics::ObserverResult observer_result,
+    absl::Nonnull<AsyncExecutorMetrics*> self_ptr) {
+  auto observer = std::get<
+      std::shared_ptr<opentelemetry::metrics::ObserverResultT<int64_t>>>(
+      observer_result);
+
+  std::vector<size_t> queue_depths;
+  {
+    absl::MutexLock lock(&self_ptr->queue_depth_provider_mutex_);
+    if (!self_ptr->queue_depth_provider_) {
+      return;
+    }
+    self_ptr->queue_depth_provider_(queue_depths);
+  }
+
+  for (size_t i = 0; i < queue_depths.size(); ++i) {
+    absl::flat_hash_map<std::string, std::string> label_kv = {
+        {std::string(kAsyncExecutorNameLabel), self_ptr->executor_name_},
+        {std::string(kAsyncExecutorIndexLabel), std::to_string(i)}};
+    observer->Observe(static_cast<int64_t>(queue_depths[i]), label_kv);
+  }
+}
+}  // namespace google::scp::core
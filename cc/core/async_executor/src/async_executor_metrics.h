@@ -0,0 +1,142 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "core/telemetry/src/metric/metric_router.h"
+#include "opentelemetry/metrics/async_instruments.h"
+#include "opentelemetry/metrics/meter.h"
+#include "opentelemetry/metrics/observer_result.h"
+#include "opentelemetry/metrics/sync_instruments.h"
+#include "public/core/interface/execution_result.h"
+
+#include "async_executor_telemetry.h"
+
+namespace google::scp::core {
+// Meter
+inline constexpr absl::string_view kAsyncExecutorMeter = "Async Executor";
+
+// View
+inline constexpr absl::string_view kAsyncExecutorTaskWaitTimeView =
+    "Async Executor Task Wait Time";
+inline constexpr absl::string_view kAsyncExecutorTaskRunTimeView =
+    "Async Executor Task Run Time";
+
+// Metrics
+inline constexpr absl::string_view kAsyncExecutorQueueDepthMetric =
+    "async_executor.queue_depth";
+inline constexpr absl::string_view kAsyncExecutorTaskWaitTimeMetric =
+    "async_executor.task.wait_time";
+inline constexpr absl::string_view kAsyncExecutorTaskRunTimeMetric =
+    "async_executor.task.run_time";
+inline constexpr absl::string_view kAsyncExecutorTaggedTaskCountMetric =
+    "async_executor.tagged_task.count";
+inline constexpr absl::string_view kAsyncExecutorTaggedTaskCpuTimeMetric =
+    "async_executor.tagged_task.cpu_time";
+
+// Labels
+inline constexpr absl::string_view kAsyncExecutorNameLabel =
+    "async_executor.name";
+inline constexpr absl::string_view kAsyncExecutorIndexLabel =
+    "async_executor.index";
+inline constexpr absl::string_view kAsyncExecutorTaskComponentLabel =
+    "async_executor.task.component";
+inline constexpr absl::string_view kAsyncExecutorTaskOperationLabel =
+    "async_executor.task.operation";
+
+/**
+ * @brief Exports the AsyncExecutor telemetry through the MetricRouter: a queue
+ * depth gauge per executor, histograms of the enqueue to start latency and of
+ * the run time of the sampled tasks, and counters of the tasks and the CPU
+ * time of each task tag.
+ */
+class AsyncExecutorMetrics : public AsyncExecutorTelemetryInterface {
+ public:
+  /**
+   * @brief Construct a new Async Executor Metrics object.
+   *
+   * @param metric_router the router to create the instruments with.
+   * @param executor_name the name of the AsyncExecutor, reported as a label to
+   * tell the pools of the process apart.
+   * @param sampling_period one task out of this many is timed.
+   */
+  AsyncExecutorMetrics(
+      MetricRouter* metric_router, absl::string_view executor_name,
+      uint32_t sampling_period = kDefaultAsyncExecutorTelemetrySamplingPeriod)
+      : metric_router_(metric_router),
+        executor_name_(executor_name),
+        sampling_period_(sampling_period == 0 ? 1 : sampling_period) {}
+
+  ~AsyncExecutorMetrics();
+
+  /// Creates the instruments. Must be called before the AsyncExecutor runs.
+  ExecutionResult Init() noexcept;
+
+  uint32_t GetSamplingPeriod() const noexcept override {
+    return sampling_period_;
+  }
+
+  void RecordTask(size_t executor_index, std::chrono::nanoseconds wait_time,
+                  std::chrono::nanoseconds run_time) noexcept override;
+
+  void RecordTaggedTask(const AsyncTaskTag& tag, uint64_t task_count,
+                        std::chrono::nanoseconds cpu_time) noexcept override;
+
+  void SetQueueDepthProvider(
+      ExecutorQueueDepthProvider queue_depth_provider) noexcept override;
+
+ private:
+  /// Callback of the queue depth gauge.
+  static void ObserveQueueDepthCallback(
+      opentelemetry::metrics::ObserverResult observer_result,
+      absl::Nonnull<AsyncExecutorMetrics*> self_ptr);
+
+  /// An instance of metric router which will provide APIs to create metrics.
+  MetricRouter* metric_router_;
+  /// The name of the AsyncExecutor.
+  std::string executor_name_;
+  /// One task out of this many is timed.
+  uint32_t sampling_period_;
+  /// OpenTelemetry Meter used for creating and managing metrics.
+  std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+  /// Gauge of the queue depth of each executor.
+  std::shared_ptr<opentelemetry::metrics::ObservableInstrument>
+      queue_depth_instrument_;
+  /// Histogram of the enqueue to start latency of the sampled tasks.
+  std::shared_ptr<opentelemetry::metrics::Histogram<double>>
+      task_wait_time_histogram_;
+  /// Histogram of the run time of the sampled tasks.
+  std::shared_ptr<opentelemetry::metrics::Histogram<double>>
+      task_run_time_histogram_;
+  /// Counter of the tasks of each tag.
+  std::shared_ptr<opentelemetry::metrics::Counter<uint64_t>>
+      tagged_task_counter_;
+  /// Counter of the CPU time of the tasks of each tag.
+  std::shared_ptr<opentelemetry::metrics::Counter<double>>
+      tagged_task_cpu_time_counter_;
+  /// Guards the queue depth provider.
+  absl::Mutex queue_depth_provider_mutex_;
+  /// Provides the queue depths while the AsyncExecutor is running.
+  ExecutorQueueDepthProvider queue_depth_provider_
+      ABSL_GUARDED_BY(queue_depth_provider_mutex_);
+};
+}  // namespace google::scp::core
@@ -0,0 +1,76 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/interface/async_executor_interface.h"
+
+namespace google::scp::core {
+/// By default, one task out of this many is timed.
+static constexpr uint32_t kDefaultAsyncExecutorTelemetrySamplingPeriod = 64;
+
+/// Provides the current queue depth of each executor, indexed by executor.
+using ExecutorQueueDepthProvider =
+    std::function<void(std::vector<size_t>& queue_depths)>;
+
+/**
+ * @brief Sink of the executor telemetry. The executors only time one task out
+ * of GetSamplingPeriod() so that the scheduling path stays cheap, and the queue
+ * depths are pulled by the sink when it needs them.
+ */
+class AsyncExecutorTelemetryInterface {
+ public:
+  virtual ~AsyncExecutorTelemetryInterface() = default;
+
+  /// Returns how many tasks are scheduled for each timed task. At least 1.
+  virtual uint32_t GetSamplingPeriod() const noexcept = 0;
+
+  /**
+   * @brief Records the timings of a sampled task. Called on the executor
+   * thread right after the task ran.
+   *
+   * @param executor_index the index of the executor that ran the task.
+   * @param wait_time the time between the enqueue and the start of the task.
+   * @param run_time the time the task took to run.
+   */
+  virtual void RecordTask(size_t executor_index,
+                          std::chrono::nanoseconds wait_time,
+                          std::chrono::nanoseconds run_time) noexcept = 0;
+
+  /**
+   * @brief Records the CPU time of a sampled tagged task, scaled to the tasks
+   * of the tag it stands for. Called on the executor thread right after the
+   * task ran.
+   *
+   * @param tag the tag the task was scheduled with.
+   * @param task_count the number of tagged tasks the sample stands for.
+   * @param cpu_time the estimated CPU time of those tasks.
+   */
+  virtual void RecordTaggedTask(const AsyncTaskTag& tag, uint64_t task_count,
+                                std::chrono::nanoseconds cpu_time) noexcept {}
+
+  /**
+   * @brief Sets the provider of the queue depths, or clears it with nullptr.
+   *
+   * @param queue_depth_provider the provider of the queue depths.
+   */
+  virtual void SetQueueDepthProvider(
+      ExecutorQueueDepthProvider queue_depth_provider) noexcept = 0;
+};
+}  // namespace google::scp::core
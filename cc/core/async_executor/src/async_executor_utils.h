@@ -14,9 +14,17 @@
 
 #pragma once
 
+#include <sched.h>
+#include <time.h>
+
+#include <cctype>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <optional>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "core/common/global_logger/src/global_logger.h"
 #include "core/common/uuid/src/uuid.h"
@@ -24,6 +32,25 @@
 #include "error_codes.h"
 
 namespace google::scp::core {
+/**
+ * @brief Placement of the threads of a pool over the CPUs of the machine.
+ */
+enum class ThreadPlacementPolicy {
+  /**
+   * @brief Thread i is pinned to CPU i modulo the number of CPUs.
+   */
+  SequentialCpu = 0,
+  /**
+   * @brief Threads are spread over the NUMA nodes round robin, and each thread
+   * is pinned to one CPU of its node. Two pools placed with this policy pin
+   * their threads of the same index to the same CPU.
+   */
+  NumaInterleaved = 1,
+  /**
+   * @brief Threads are not pinned.
+   */
+  Unpinned = 2
+};
 
 class AsyncExecutorUtils {
  public:
@@ -43,7 +70,156 @@ class AsyncExecutorUtils {
     return SuccessExecutionResult();
   }
 
+  /**
+   * @brief Parses a sysfs CPU list such as "0-3,8,10-11".
+   *
+   * @param cpu_list The list to parse.
+   * @param cpus The CPUs of the list, in order.
+   * @return true if the list is well formed.
+   */
+  static inline bool ParseCpuList(const std::string& cpu_list,
+                                  std::vector<size_t>& cpus) noexcept {
+    cpus.clear();
+    size_t position = 0;
+    while (position < cpu_list.size()) {
+      auto end = cpu_list.find(',', position);
+      if (end == std::string::npos) {
+        end = cpu_list.size();
+      }
+      auto range = cpu_list.substr(position, end - position);
+      position = end + 1;
+      while (!range.empty() && isspace(range.back())) {
+        range.pop_back();
+      }
+      if (range.empty()) {
+        continue;
+      }
+      auto dash = range.find('-');
+      size_t first = 0;
+      size_t last = 0;
+      try {
+        first = std::stoul(range.substr(0, dash));
+        last = dash == std::string::npos ? first
+                                         : std::stoul(range.substr(dash + 1));
+      } catch (...) {
+        return false;
+      }
+      if (last < first) {
+        return false;
+      }
+      for (auto cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Returns the CPUs of each online NUMA node, read from sysfs. Falls
+   * back to a single node holding all the CPUs if the topology is not
+   * available.
+   */
+  static inline std::vector<std::vector<size_t>> GetNumaNodeCpus() noexcept {
+    std::vector<std::vector<size_t>> numa_node_cpus;
+    std::vector<size_t> online_nodes;
+    if (ReadCpuListFile(kSysfsNodePath + std::string("online"),
+                        online_nodes)) {
+      for (auto node : online_nodes) {
+        std::vector<size_t> cpus;
+        if (ReadCpuListFile(kSysfsNodePath + std::string("node") +
+                                std::to_string(node) + "/cpulist",
+                            cpus) &&
+            !cpus.empty()) {
+          numa_node_cpus.push_back(std::move(cpus));
+        }
+      }
+    }
+
+    if (numa_node_cpus.empty()) {
+      std::vector<size_t> cpus;
+      for (size_t cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+        cpus.push_back(cpu);
+      }
+      numa_node_cpus.push_back(std::move(cpus));
+    }
+    return numa_node_cpus;
+  }
+
+  /**
+   * @brief Computes the CPU each thread of a pool is pinned to.
+   *
+   * @param placement_policy The placement policy of the pool.
+   * @param thread_count The number of threads in the pool.
+   * @param numa_node_cpus The CPUs of each NUMA node.
+   * @return std::vector<std::optional<size_t>> The CPU of each thread, or
+   * nullopt if the thread is not pinned.
+   */
+  static inline std::vector<std::optional<size_t>> GetThreadPlacement(
+      ThreadPlacementPolicy placement_policy, size_t thread_count,
+      const std::vector<std::vector<size_t>>& numa_node_cpus) noexcept {
+    std::vector<std::optional<size_t>> placement(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+      if (placement_policy == ThreadPlacementPolicy::SequentialCpu) {
+        placement[i] = i % std::thread::hardware_concurrency();
+      } else if (placement_policy == ThreadPlacementPolicy::NumaInterleaved &&
+                 !numa_node_cpus.empty()) {
+        const auto& cpus = numa_node_cpus[i % numa_node_cpus.size()];
+        placement[i] = cpus[(i / numa_node_cpus.size()) % cpus.size()];
+      }
+    }
+    return placement;
+  }
+
+  /**
+   * @brief Returns the NUMA node each CPU belongs to, indexed by CPU.
+   *
+   * @param numa_node_cpus The CPUs of each NUMA node.
+   */
+  static inline std::vector<size_t> GetCpuToNumaNodeMap(
+      const std::vector<std::vector<size_t>>& numa_node_cpus) noexcept {
+    std::vector<size_t> cpu_to_numa_node;
+    for (size_t node = 0; node < numa_node_cpus.size(); ++node) {
+      for (auto cpu : numa_node_cpus[node]) {
+        if (cpu >= cpu_to_numa_node.size()) {
+          cpu_to_numa_node.resize(cpu + 1, 0);
+        }
+        cpu_to_numa_node[cpu] = node;
+      }
+    }
+    return cpu_to_numa_node;
+  }
+
+  /// Returns the CPU the current thread is running on, if known.
+  static inline std::optional<size_t> GetCurrentCpu() noexcept {
+    auto cpu = sched_getcpu();
+    if (cpu < 0) {
+      return std::nullopt;
+    }
+    return static_cast<size_t>(cpu);
+  }
+
+  /// Returns the CPU time the current thread used so far.
+  static inline std::chrono::nanoseconds GetCurrentThreadCpuTime() noexcept {
+    timespec cpu_time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) != 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::seconds(cpu_time.tv_sec) +
+           std::chrono::nanoseconds(cpu_time.tv_nsec);
+  }
+
  private:
+  static inline bool ReadCpuListFile(const std::string& path,
+                                     std::vector<size_t>& cpus) noexcept {
+    std::ifstream file(path);
+    std::string cpu_list;
+    if (!file.is_open() || !std::getline(file, cpu_list)) {
+      return false;
+    }
+    return ParseCpuList(cpu_list, cpus);
+  }
+
+  static constexpr char kSysfsNodePath[] = "/sys/devices/system/node/";
   static constexpr char kAsyncExecutorUtils[] = "AsyncExecutorUtils";
 };
 
@@ -0,0 +1,57 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "async_task_tag_stats_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::scp::core {
+void AsyncTaskTagStatsRecorder::Record(
+    const AsyncTaskTag& tag, uint64_t task_count,
+    std::chrono::nanoseconds cpu_time) noexcept {
+  if (tag.component == nullptr || tag.operation == nullptr) {
+    return;
+  }
+  absl::MutexLock lock(&mutex_);
+  auto& tag_stats = stats_[{tag.component, tag.operation}];
+  tag_stats.task_count += task_count;
+  tag_stats.cpu_time += cpu_time;
+}
+
+std::vector<AsyncTaskTagStats> AsyncTaskTagStatsRecorder::GetStats()
+    const noexcept {
+  std::vector<AsyncTaskTagStats> stats;
+  {
+    absl::MutexLock lock(&mutex_);
+    stats.reserve(stats_.size());
+    for (const auto& [tag, tag_stats] : stats_) {
+      AsyncTaskTagStats entry;
+      entry.component = std::string(tag.first);
+      entry.operation = std::string(tag.second);
+      entry.task_count = tag_stats.task_count;
+      entry.cpu_time = tag_stats.cpu_time;
+      stats.push_back(std::move(entry));
+    }
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const AsyncTaskTagStats& left, const AsyncTaskTagStats& right) {
+              return left.cpu_time > right.cpu_time;
+            });
+  return stats;
+}
+}  // namespace google::scp::core
@@ -0,0 +1,62 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "core/interface/async_executor_interface.h"
+
+namespace google::scp::core {
+/**
+ * @brief Accumulates the task count and the CPU time of the tasks scheduled
+ * with each tag. The tags are keyed by their strings, so that the same tag
+ * defined in several translation units adds up.
+ */
+class AsyncTaskTagStatsRecorder {
+ public:
+  /**
+   * @brief Adds the tasks of a tag.
+   *
+   * @param tag the tag the tasks were scheduled with.
+   * @param task_count the number of tasks.
+   * @param cpu_time the CPU time the tasks took.
+   */
+  void Record(const AsyncTaskTag& tag, uint64_t task_count,
+              std::chrono::nanoseconds cpu_time) noexcept;
+
+  /// Returns the stats of each tag, the ones with the most CPU time first.
+  std::vector<AsyncTaskTagStats> GetStats() const noexcept;
+
+ private:
+  /// The stats accumulated for a tag.
+  struct TagStats {
+    uint64_t task_count = 0;
+    std::chrono::nanoseconds cpu_time = std::chrono::nanoseconds(0);
+  };
+
+  /// Guards the stats.
+  mutable absl::Mutex mutex_;
+  /// The stats of each (component, operation). The strings are static.
+  absl::flat_hash_map<std::pair<absl::string_view, absl::string_view>,
+                      TagStats>
+      stats_ ABSL_GUARDED_BY(mutex_);
+};
+}  // namespace google::scp::core
@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <memory>
+#include <utility>
 
 #include <aws/core/utils/threading/Executor.h>
 
@@ -38,7 +39,8 @@ class AwsAsyncExecutor : public Aws::Utils::Threading::Executor {
 
  protected:
   bool SubmitToThread(std::function<void()>&& task) override {
-    if (async_executor_->Schedule([task]() { task(); },
+    // The SDK task is moved into the operation, it can hold the whole request.
+    if (async_executor_->Schedule(std::move(task),
                                   core::AsyncPriority::Normal) ==
         SuccessExecutionResult()) {
       return true;
@@ -61,4 +61,8 @@ DEFINE_ERROR_CODE(SC_ASYNC_EXECUTOR_INVALID_TASK_POOL_TYPE, SC_ASYNC_EXECUTOR,
 DEFINE_ERROR_CODE(SC_ASYNC_EXECUTOR_UNABLE_TO_SET_AFFINITY, SC_ASYNC_EXECUTOR,
                   0x000A, "Setting CPU affinity failed",
                   HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SC_ASYNC_EXECUTOR_INVALID_TICK_DURATION, SC_ASYNC_EXECUTOR,
+                  0x000B, "The timer wheel tick duration is invalid",
+                  HttpStatusCode::BAD_REQUEST)
 }  // namespace google::scp::core::errors
@@ -0,0 +1,93 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <thread>
+
+namespace google::scp::core {
+/**
+ * @brief How an idle executor thread waits for work. The thread first busy
+ * spins, then yields its time slice, and only then parks on its condition
+ * variable. Spinning trades CPU for not paying the futex wake up latency on
+ * bursty loads.
+ *
+ * The default parks right away.
+ */
+struct ExecutorWaitStrategy {
+  /// Parks as soon as there is no work.
+  static ExecutorWaitStrategy Park() { return ExecutorWaitStrategy(); }
+
+  /**
+   * @brief Spins, then yields, then parks.
+   *
+   * @param spin_iterations the number of times the queue is polled with a CPU
+   * pause in between before yielding.
+   * @param yield_iterations the number of times the queue is polled with a
+   * yield in between before parking.
+   */
+  static ExecutorWaitStrategy SpinThenPark(size_t spin_iterations,
+                                           size_t yield_iterations) {
+    ExecutorWaitStrategy wait_strategy;
+    wait_strategy.spin_iterations = spin_iterations;
+    wait_strategy.yield_iterations = yield_iterations;
+    return wait_strategy;
+  }
+
+  /// Returns true if the thread polls before parking.
+  bool PollsBeforeParking() const noexcept {
+    return spin_iterations > 0 || yield_iterations > 0;
+  }
+
+  /**
+   * @brief Polls the condition with the spin and yield phases of this
+   * strategy.
+   *
+   * @param condition the condition to wait for.
+   * @return true if the condition became true, false if the thread should now
+   * park.
+   */
+  template <class Condition>
+  bool PollUntil(Condition&& condition) const noexcept {
+    for (size_t i = 0; i < spin_iterations; ++i) {
+      if (condition()) {
+        return true;
+      }
+      CpuRelax();
+    }
+    for (size_t i = 0; i < yield_iterations; ++i) {
+      if (condition()) {
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    return condition();
+  }
+
+  /// Hints the CPU that the thread is busy waiting.
+  static inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+  }
+
+  /// Number of polls with a CPU pause in between.
+  size_t spin_iterations = 0;
+  /// Number of polls with a yield in between, after the spinning.
+  size_t yield_iterations = 0;
+};
+}  // namespace google::scp::core
@@ -0,0 +1,305 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "core/common/concurrent_queue/src/concurrent_queue.h"
+#include "core/interface/type_def.h"
+
+namespace google::scp::core {
+/// The default number of bytes a task can store its callable in.
+static constexpr size_t kDefaultAsyncTaskInlineCapacity = 64;
+
+/**
+ * @brief A move-only void() callable which keeps the callables fitting in
+ * kInlineCapacity bytes inline, and falls back to the heap for the bigger
+ * ones.
+ *
+ * @tparam kInlineCapacity The number of bytes available for inline storage.
+ */
+template <size_t kInlineCapacity = kDefaultAsyncTaskInlineCapacity>
+class InlineAsyncOperation {
+ public:
+  static_assert(kInlineCapacity >= sizeof(void*),
+                "The inline capacity must at least fit a pointer.");
+
+  InlineAsyncOperation() noexcept = default;
+
+  template <class Callable,
+            class = std::enable_if_t<!std::is_same_v<
+                std::decay_t<Callable>, InlineAsyncOperation>>>
+  InlineAsyncOperation(Callable&& callable) {  // NOLINT(runtime/explicit)
+    Emplace(std::forward<Callable>(callable));
+  }
+
+  InlineAsyncOperation(InlineAsyncOperation&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  InlineAsyncOperation& operator=(InlineAsyncOperation&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  InlineAsyncOperation(const InlineAsyncOperation&) = delete;
+  InlineAsyncOperation& operator=(const InlineAsyncOperation&) = delete;
+
+  ~InlineAsyncOperation() { Reset(); }
+
+  /**
+   * @brief Replaces the current callable with the given one.
+   *
+   * @param callable The callable to store.
+   */
+  template <class Callable>
+  void Emplace(Callable&& callable) {
+    using CallableType = std::decay_t<Callable>;
+    Reset();
+    if constexpr (FitsInline<CallableType>()) {
+      new (&storage_) CallableType(std::forward<Callable>(callable));
+      vtable_ = &kInlineVTable<CallableType>;
+    } else {
+      *reinterpret_cast<CallableType**>(&storage_) =
+          new CallableType(std::forward<Callable>(callable));
+      vtable_ = &kHeapVTable<CallableType>;
+    }
+  }
+
+  /// Invokes the stored callable. Must not be empty.
+  void operator()() { vtable_->invoke(&storage_); }
+
+  /// Returns true if a callable is stored.
+  explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+  /// Returns true if the stored callable lives in the inline storage.
+  bool IsStoredInline() const noexcept {
+    return vtable_ != nullptr && vtable_->is_inline;
+  }
+
+  /// Destroys the stored callable, if any.
+  void Reset() noexcept {
+    if (vtable_ != nullptr) {
+      vtable_->destroy(&storage_);
+      vtable_ = nullptr;
+    }
+  }
+
+ private:
+  /// Type erased operations on the stored callable.
+  struct VTable {
+    void (*invoke)(void* storage);
+    void (*move)(void* from_storage, void* to_storage) noexcept;
+    void (*destroy)(void* storage) noexcept;
+    bool is_inline;
+  };
+
+  template <class CallableType>
+  static constexpr bool FitsInline() {
+    return sizeof(CallableType) <= kInlineCapacity &&
+           alignof(CallableType) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<CallableType>;
+  }
+
+  template <class CallableType>
+  static constexpr VTable kInlineVTable = {
+      [](void* storage) { (*static_cast<CallableType*>(storage))(); },
+      [](void* from_storage, void* to_storage) noexcept {
+        auto* from = static_cast<CallableType*>(from_storage);
+        new (to_storage) CallableType(std::move(*from));
+        from->~CallableType();
+      },
+      [](void* storage) noexcept {
+        static_cast<CallableType*>(storage)->~CallableType();
+      },
+      true};
+
+  template <class CallableType>
+  static constexpr VTable kHeapVTable = {
+      [](void* storage) { (**static_cast<CallableType**>(storage))(); },
+      [](void* from_storage, void* to_storage) noexcept {
+        *static_cast<CallableType**>(to_storage) =
+            *static_cast<CallableType**>(from_storage);
+      },
+      [](void* storage) noexcept {
+        delete *static_cast<CallableType**>(storage);
+      },
+      false};
+
+  void MoveFrom(InlineAsyncOperation& other) noexcept {
+    if (other.vtable_ != nullptr) {
+      other.vtable_->move(&other.storage_, &storage_);
+      vtable_ = other.vtable_;
+      other.vtable_ = nullptr;
+    }
+  }
+
+  /// The storage of the callable, or of a pointer to it if it is too big.
+  alignas(std::max_align_t) unsigned char storage_[kInlineCapacity];
+  /// The operations of the stored callable. Null if empty.
+  const VTable* vtable_ = nullptr;
+};
+
+/**
+ * @brief A task stored in a reusable node. Unlike AsyncTask, it has no
+ * execution time or cancellation, and it is not reference counted: the
+ * executor owns it from scheduling to execution and then gives it back to its
+ * AsyncTaskPool.
+ *
+ * @tparam kInlineCapacity The number of bytes available to store the callable
+ * inline.
+ */
+template <size_t kInlineCapacity = kDefaultAsyncTaskInlineCapacity>
+class InlineAsyncTask {
+ public:
+  /**
+   * @brief Sets the operation to be executed.
+   *
+   * @param async_operation The operation to be executed.
+   */
+  template <class Callable>
+  void SetOperation(Callable&& async_operation) {
+    async_operation_.Emplace(std::forward<Callable>(async_operation));
+  }
+
+  /// Calls the current task to be executed.
+  void Execute() { async_operation_(); }
+
+  /// Releases the operation so that the node can be reused.
+  void Reset() noexcept {
+    async_operation_.Reset();
+    enqueue_timestamp_ = 0;
+    deadline_ = 0;
+    on_expired_ = nullptr;
+  }
+
+  /**
+   * @brief Sets the deadline after which the task is expired instead of
+   * executed.
+   *
+   * @param deadline the coarse steady clock time in nanoseconds.
+   * @param on_expired the operation called in place of the expired task.
+   */
+  void SetDeadline(Timestamp deadline,
+                   const std::function<void()>& on_expired) {
+    deadline_ = deadline;
+    on_expired_ = on_expired;
+  }
+
+  /// Returns the deadline of the task, or 0 if it has none.
+  Timestamp GetDeadline() const noexcept { return deadline_; }
+
+  /**
+   * @brief Returns true if the task has a deadline which is past.
+   *
+   * @param now the current coarse steady clock time in nanoseconds.
+   */
+  bool IsExpired(Timestamp now) const noexcept {
+    return deadline_ != 0 && now >= deadline_;
+  }
+
+  /// Calls the expiration operation of the task, if any, in place of the task.
+  void Expire() {
+    if (on_expired_) {
+      on_expired_();
+    }
+  }
+
+  /**
+   * @brief Marks the task as sampled for telemetry.
+   *
+   * @param enqueue_timestamp the steady clock time the task was enqueued at.
+   */
+  void SetEnqueueTimestamp(Timestamp enqueue_timestamp) noexcept {
+    enqueue_timestamp_ = enqueue_timestamp;
+  }
+
+  /// Returns the enqueue time of a sampled task, or 0 if it is not sampled.
+  Timestamp GetEnqueueTimestamp() const noexcept { return enqueue_timestamp_; }
+
+ private:
+  /// Async operation to be executed.
+  InlineAsyncOperation<kInlineCapacity> async_operation_;
+  /// The steady clock enqueue time in nanoseconds if sampled, otherwise 0.
+  Timestamp enqueue_timestamp_ = 0;
+  /// The coarse steady clock deadline in nanoseconds, or 0 if there is none.
+  Timestamp deadline_ = 0;
+  /// Called in place of the operation if the task is past its deadline.
+  std::function<void()> on_expired_;
+};
+
+/**
+ * @brief A free list of task nodes, so that scheduling does not need to
+ * allocate once the pool is warm. Acquire and Release are thread-safe.
+ *
+ * @tparam TaskType The type of the pooled task. Must be default constructible
+ * and provide Reset().
+ */
+template <class TaskType>
+class AsyncTaskPool {
+ public:
+  /**
+   * @brief Construct a new Async Task Pool object.
+   *
+   * @param max_pooled_task_count The maximum number of idle nodes kept. Nodes
+   * released beyond that are freed.
+   */
+  explicit AsyncTaskPool(size_t max_pooled_task_count)
+      : free_tasks_(max_pooled_task_count) {}
+
+  AsyncTaskPool(const AsyncTaskPool&) = delete;
+  AsyncTaskPool& operator=(const AsyncTaskPool&) = delete;
+
+  ~AsyncTaskPool() {
+    TaskType* task = nullptr;
+    while (free_tasks_.TryDequeue(task).Successful()) {
+      delete task;
+    }
+  }
+
+  /// Returns an idle node, or a new one if there is none.
+  TaskType* Acquire() {
+    TaskType* task = nullptr;
+    if (free_tasks_.TryDequeue(task).Successful()) {
+      return task;
+    }
+    return new TaskType();
+  }
+
+  /**
+   * @brief Gives the node back to the pool.
+   *
+   * @param task The node, which must not be used by the caller anymore.
+   */
+  void Release(TaskType* task) noexcept {
+    task->Reset();
+    if (!free_tasks_.TryEnqueue(task).Successful()) {
+      delete task;
+    }
+  }
+
+ private:
+  /// The idle nodes.
+  common::ConcurrentQueue<TaskType*> free_tasks_;
+};
+}  // namespace google::scp::core
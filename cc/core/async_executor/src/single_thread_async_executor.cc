@@ -14,41 +14,117 @@
 
 #include "single_thread_async_executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include "async_executor_utils.h"
 #include "error_codes.h"
 #include "typedef.h"
 
-using google::scp::core::common::ConcurrentQueue;
+using google::scp::core::common::TimeProvider;
 using std::atomic;
+using std::greater;
 using std::make_shared;
 using std::make_unique;
+using std::min;
 using std::mutex;
+using std::pop_heap;
+using std::push_heap;
 using std::shared_ptr;
 using std::thread;
 using std::unique_lock;
+using std::vector;
+using std::weak_ptr;
 using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
 
 static constexpr size_t kLockWaitTimeInMilliseconds = 5;
 
 namespace google::scp::core {
+/// The deadline given to the tasks scheduled without one, from the time they
+/// are picked up, with the EarliestDeadlineFirst policy.
+static constexpr Timestamp kDefaultTaskDeadlineInNanoseconds =
+    nanoseconds(seconds(kAsyncContextExpirationDurationInSeconds)).count();
+
+SingleThreadAsyncExecutor::~SingleThreadAsyncExecutor() {
+  // The queues only hold raw task nodes.
+  DropQueuedTasks();
+}
+
 ExecutionResult SingleThreadAsyncExecutor::Init() noexcept {
   if (queue_cap_ <= 0 || queue_cap_ > kMaxQueueCap) {
     return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_INVALID_QUEUE_CAP);
   }
 
-  normal_pri_queue_ =
-      make_shared<ConcurrentQueue<shared_ptr<AsyncTask>>>(queue_cap_);
-  high_pri_queue_ =
-      make_shared<ConcurrentQueue<shared_ptr<AsyncTask>>>(queue_cap_);
+  // Both queues can be full at the same time.
+  task_pool_ = make_unique<AsyncTaskPool<Task>>(
+      min(2 * queue_cap_, kMaxPooledTaskCount));
+  normal_pri_queue_ = make_shared<TaskQueue>(queue_cap_);
+  high_pri_queue_ = make_shared<TaskQueue>(queue_cap_);
   return SuccessExecutionResult();
 };
 
+void SingleThreadAsyncExecutor::DropQueuedTasks() noexcept {
+  Task* task = nullptr;
+  if (normal_pri_queue_) {
+    while (normal_pri_queue_->TryDequeue(task).Successful()) {
+      ReleaseTask(task);
+    }
+  }
+  if (high_pri_queue_) {
+    while (high_pri_queue_->TryDequeue(task).Successful()) {
+      ReleaseTask(task);
+    }
+  }
+  for (auto& deadline_ordered_task : deadline_ordered_tasks_) {
+    ReleaseTask(deadline_ordered_task.task);
+  }
+  deadline_ordered_tasks_.clear();
+  deadline_ordered_task_count_ = 0;
+}
+
+void SingleThreadAsyncExecutor::
+    MoveNormalPriorityTasksToDeadlineOrder() noexcept {
+  if (normal_pri_queue_->Size() == 0) {
+    return;
+  }
+
+  auto now = TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks();
+  Task* task = nullptr;
+  while (deadline_ordered_tasks_.size() < queue_cap_ &&
+         normal_pri_queue_->TryDequeue(task).Successful()) {
+    auto deadline = task->GetDeadline();
+    if (deadline == 0) {
+      deadline = now + kDefaultTaskDeadlineInNanoseconds;
+    }
+    deadline_ordered_tasks_.push_back(
+        {deadline, next_deadline_ordered_sequence_number_++, task});
+    push_heap(deadline_ordered_tasks_.begin(), deadline_ordered_tasks_.end(),
+              greater<DeadlineOrderedTask>());
+  }
+  deadline_ordered_task_count_ = deadline_ordered_tasks_.size();
+}
+
+bool SingleThreadAsyncExecutor::TryDequeueNormalPriorityTask(
+    Task*& task) noexcept {
+  if (deadline_ordered_tasks_.empty()) {
+    return normal_pri_queue_->TryDequeue(task).Successful();
+  }
+
+  pop_heap(deadline_ordered_tasks_.begin(), deadline_ordered_tasks_.end(),
+           greater<DeadlineOrderedTask>());
+  task = deadline_ordered_tasks_.back().task;
+  deadline_ordered_tasks_.pop_back();
+  deadline_ordered_task_count_ = deadline_ordered_tasks_.size();
+  return true;
+}
+
 ExecutionResult SingleThreadAsyncExecutor::Run() noexcept {
   if (is_running_) {
     return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_ALREADY_RUNNING);
@@ -80,33 +156,76 @@ ExecutionResult SingleThreadAsyncExecutor::Run() noexcept {
 void SingleThreadAsyncExecutor::StartWorker() noexcept {
   unique_lock<mutex> thread_lock(mutex_);
 
+  auto has_work_or_stopped = [&]() {
+    return !is_running_ || high_pri_queue_->Size() > 0 ||
+           normal_pri_queue_->Size() > 0 || deadline_ordered_task_count_ > 0;
+  };
+
   while (true) {
-    condition_variable_.wait_for(
-        thread_lock, milliseconds(kLockWaitTimeInMilliseconds), [&]() {
-          return !is_running_ || high_pri_queue_->Size() > 0 ||
-                 normal_pri_queue_->Size() > 0;
-        });
+    // Poll without the lock first so that the producers do not need to wake
+    // the thread up for the work arriving shortly.
+    if (wait_strategy_.PollsBeforeParking() && !has_work_or_stopped()) {
+      thread_lock.unlock();
+      wait_strategy_.PollUntil(has_work_or_stopped);
+      thread_lock.lock();
+    }
+
+    condition_variable_.wait_for(thread_lock,
+                                 milliseconds(kLockWaitTimeInMilliseconds),
+                                 has_work_or_stopped);
 
-    if (normal_pri_queue_->Size() == 0 && high_pri_queue_->Size() == 0) {
+    if (task_ordering_policy_ == TaskOrderingPolicy::EarliestDeadlineFirst) {
+      MoveNormalPriorityTasksToDeadlineOrder();
+    }
+
+    Task* task = nullptr;
+    if (normal_pri_queue_->Size() == 0 && high_pri_queue_->Size() == 0 &&
+        deadline_ordered_tasks_.empty()) {
       if (!is_running_) {
         break;
       }
-      continue;
-    }
-
-    shared_ptr<AsyncTask> task;
-    // The priority is with the high pri tasks.
-    if (!high_pri_queue_->TryDequeue(task).Successful() &&
-        !normal_pri_queue_->TryDequeue(task).Successful()) {
+      // Nothing to do locally, help out the busy siblings if allowed.
+      if (!TryStealFromSiblings(task)) {
+        continue;
+      }
+    } else if (!high_pri_queue_->TryDequeue(task).Successful() &&
+               !TryDequeueNormalPriorityTask(task)) {
+      // The priority is with the high pri tasks.
       continue;
     }
 
     thread_lock.unlock();
-    task->Execute();
+    ExecuteTask(*task);
+    ReleaseTask(task);
     thread_lock.lock();
   }
 }
 
+void SingleThreadAsyncExecutor::ExecuteTask(Task& task) noexcept {
+  // Only the tasks with a deadline read the clock.
+  if (task.GetDeadline() != 0 &&
+      task.IsExpired(
+          TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks())) {
+    task.Expire();
+    return;
+  }
+
+  auto enqueue_timestamp = task.GetEnqueueTimestamp();
+  if (enqueue_timestamp == 0 || !telemetry_) {
+    task.Execute();
+    return;
+  }
+
+  auto start_timestamp =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  task.Execute();
+  auto end_timestamp =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  telemetry_->RecordTask(executor_index_,
+                         nanoseconds(start_timestamp - enqueue_timestamp),
+                         nanoseconds(end_timestamp - start_timestamp));
+}
+
 ExecutionResult SingleThreadAsyncExecutor::Stop() noexcept {
   if (!is_running_) {
     return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
@@ -116,9 +235,7 @@ ExecutionResult SingleThreadAsyncExecutor::Stop() noexcept {
   is_running_ = false;
 
   if (drop_tasks_on_stop_) {
-    shared_ptr<AsyncTask> task;
-    while (normal_pri_queue_->TryDequeue(task).Successful()) {}
-    while (high_pri_queue_->TryDequeue(task).Successful()) {}
+    DropQueuedTasks();
   }
 
   condition_variable_.notify_all();
@@ -135,18 +252,19 @@ ExecutionResult SingleThreadAsyncExecutor::Stop() noexcept {
   return SuccessExecutionResult();
 };
 
-ExecutionResult SingleThreadAsyncExecutor::Schedule(
-    const AsyncOperation& work, AsyncPriority priority) noexcept {
-  if (!is_running_) {
-    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+ExecutionResult SingleThreadAsyncExecutor::EnqueueTask(
+    Task* task, AsyncPriority priority) noexcept {
+  auto execution_result = EnqueueTaskWithoutNotify(task, priority);
+  if (!execution_result.Successful()) {
+    return execution_result;
   }
 
-  if (priority != AsyncPriority::Normal && priority != AsyncPriority::High) {
-    return FailureExecutionResult(
-        errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
-  }
+  condition_variable_.notify_one();
+  return SuccessExecutionResult();
+};
 
-  auto task = make_shared<AsyncTask>(work);
+ExecutionResult SingleThreadAsyncExecutor::EnqueueTaskWithoutNotify(
+    Task* task, AsyncPriority priority) noexcept {
   ExecutionResult execution_result;
   if (priority == AsyncPriority::Normal) {
     execution_result = normal_pri_queue_->TryEnqueue(task);
@@ -155,12 +273,102 @@ ExecutionResult SingleThreadAsyncExecutor::Schedule(
   }
 
   if (!execution_result.Successful()) {
+    ReleaseTask(task);
     return RetryExecutionResult(errors::SC_ASYNC_EXECUTOR_EXCEEDING_QUEUE_CAP);
   }
-
-  condition_variable_.notify_one();
   return SuccessExecutionResult();
-};
+}
+
+ExecutionResult SingleThreadAsyncExecutor::ScheduleWithDeadline(
+    const AsyncOperation& work, AsyncPriority priority, Timestamp deadline,
+    const AsyncOperation& on_expired) noexcept {
+  if (!is_running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  if (priority != AsyncPriority::Normal && priority != AsyncPriority::High) {
+    return FailureExecutionResult(
+        errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
+  }
+
+  auto* task = task_pool_->Acquire();
+  task->SetOperation(work);
+  task->SetDeadline(deadline, on_expired);
+  SampleTask(*task);
+  return EnqueueTask(task, priority);
+}
+
+ExecutionResult SingleThreadAsyncExecutor::ScheduleBatch(
+    absl::Span<const AsyncOperation> works, AsyncPriority priority,
+    size_t& scheduled_count) noexcept {
+  scheduled_count = 0;
+  if (!is_running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  if (priority != AsyncPriority::Normal && priority != AsyncPriority::High) {
+    return FailureExecutionResult(
+        errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
+  }
+
+  ExecutionResult execution_result = SuccessExecutionResult();
+  for (const auto& work : works) {
+    auto* task = task_pool_->Acquire();
+    task->SetOperation(work);
+    SampleTask(*task);
+    execution_result = EnqueueTaskWithoutNotify(task, priority);
+    if (!execution_result.Successful()) {
+      break;
+    }
+    ++scheduled_count;
+  }
+
+  // There is only one worker, so one signal covers the whole batch.
+  if (scheduled_count > 0) {
+    condition_variable_.notify_one();
+  }
+  return execution_result;
+}
+
+void SingleThreadAsyncExecutor::SetWorkStealingSiblings(
+    const vector<shared_ptr<SingleThreadAsyncExecutor>>& siblings) noexcept {
+  work_stealing_siblings_.clear();
+  for (const auto& sibling : siblings) {
+    if (sibling && sibling.get() != this) {
+      work_stealing_siblings_.push_back(sibling);
+    }
+  }
+}
+
+ExecutionResult SingleThreadAsyncExecutor::TryStealNormalPriorityTask(
+    Task*& task) noexcept {
+  if (!normal_pri_queue_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_INITIALIZED);
+  }
+  return normal_pri_queue_->TryDequeue(task);
+}
+
+bool SingleThreadAsyncExecutor::TryStealFromSiblings(Task*& task) noexcept {
+  auto sibling_count = work_stealing_siblings_.size();
+  for (size_t i = 0; i < sibling_count; ++i) {
+    auto sibling =
+        work_stealing_siblings_[(next_steal_index_ + i) % sibling_count]
+            .lock();
+    if (sibling && sibling->TryStealNormalPriorityTask(task).Successful()) {
+      next_steal_index_ = (next_steal_index_ + i + 1) % sibling_count;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t SingleThreadAsyncExecutor::GetQueueDepth() const noexcept {
+  if (!normal_pri_queue_ || !high_pri_queue_) {
+    return 0;
+  }
+  return normal_pri_queue_->Size() + high_pri_queue_->Size() +
+         deadline_ordered_task_count_;
+}
 
 ExecutionResultOr<thread::id> SingleThreadAsyncExecutor::GetThreadId() const {
   if (!is_running_.load()) {
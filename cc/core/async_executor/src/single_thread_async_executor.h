@@ -16,31 +16,87 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "core/common/concurrent_queue/src/concurrent_queue.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/interface/async_executor_interface.h"
 
-#include "async_task.h"
+#include "async_executor_telemetry.h"
+#include "error_codes.h"
+#include "executor_wait_strategy.h"
+#include "inline_async_task.h"
 
 namespace google::scp::core {
+/// The order in which the normal priority tasks of an executor are run.
+enum class TaskOrderingPolicy {
+  /// In the order they were scheduled.
+  Fifo = 0,
+  /**
+   * @brief The earliest deadline first. The tasks without a deadline are
+   * given one kAsyncContextExpirationDurationInSeconds after they are picked
+   * up by the executor thread, so that they are not starved by the tasks with
+   * a deadline. The tasks with the same deadline run in order.
+   */
+  EarliestDeadlineFirst = 1,
+};
+
 /**
  * @brief A single threaded async executor. This executor will have one thread
  * working with one queue.
  */
 class SingleThreadAsyncExecutor : ServiceInterface {
  public:
+  /// The task node type of the queues.
+  using Task = InlineAsyncTask<kDefaultAsyncTaskInlineCapacity>;
+  /// The task queue type. The queues are bounded and on the scheduling path
+  /// of every task, so they use the lock free ring buffer.
+  using TaskQueue = common::ConcurrentQueue<
+      Task*, common::ConcurrentQueueBackend::RingBuffer>;
+
+  /**
+   * @brief Construct a new Single Thread Async Executor object.
+   *
+   * @param queue_cap the maximum size of each work queue.
+   * @param drop_tasks_on_stop indicates whether the pending tasks are dropped
+   * on stop.
+   * @param affinity_cpu_number an optional CPU to pin the thread to.
+   * @param telemetry an optional sink for the timings of the sampled tasks.
+   * @param executor_index the index of the executor reported to the telemetry.
+   * @param wait_strategy how the thread waits for work when idle.
+   * @param task_ordering_policy the order the normal priority tasks are run
+   * in. The high priority tasks are always run first, in order.
+   */
   explicit SingleThreadAsyncExecutor(
       size_t queue_cap, bool drop_tasks_on_stop = false,
-      std::optional<size_t> affinity_cpu_number = std::nullopt)
+      std::optional<size_t> affinity_cpu_number = std::nullopt,
+      std::shared_ptr<AsyncExecutorTelemetryInterface> telemetry = nullptr,
+      size_t executor_index = 0,
+      ExecutorWaitStrategy wait_strategy = ExecutorWaitStrategy::Park(),
+      TaskOrderingPolicy task_ordering_policy = TaskOrderingPolicy::Fifo)
       : is_running_(false),
         worker_thread_started_(false),
         worker_thread_stopped_(false),
         queue_cap_(queue_cap),
         drop_tasks_on_stop_(drop_tasks_on_stop),
-        affinity_cpu_number_(affinity_cpu_number) {}
+        affinity_cpu_number_(affinity_cpu_number),
+        telemetry_(std::move(telemetry)),
+        telemetry_sampling_period_(
+            telemetry_ ? std::max<uint32_t>(telemetry_->GetSamplingPeriod(), 1)
+                       : 0),
+        executor_index_(executor_index),
+        wait_strategy_(wait_strategy),
+        task_ordering_policy_(task_ordering_policy),
+        deadline_ordered_task_count_(0) {}
+
+  ~SingleThreadAsyncExecutor();
 
   ExecutionResult Init() noexcept override;
 
@@ -56,7 +112,64 @@ class SingleThreadAsyncExecutor : ServiceInterface {
    * @return ExecutionResult result of the execution with possible error code.
    */
   ExecutionResult Schedule(const AsyncOperation& work,
-                           AsyncPriority priority) noexcept;
+                           AsyncPriority priority) noexcept {
+    return ScheduleInline(work, priority);
+  }
+
+  /**
+   * @brief Same as above, but stores the callable in the task node directly
+   * instead of wrapping it in an AsyncOperation first. Callables up to
+   * kDefaultAsyncTaskInlineCapacity bytes do not allocate.
+   * @param work the task that needs to be scheduled.
+   * @param priority the priority of the task. Either normal or medium.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  template <class Callable>
+  ExecutionResult ScheduleInline(Callable&& work,
+                                 AsyncPriority priority) noexcept {
+    if (!is_running_) {
+      return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+    }
+
+    if (priority != AsyncPriority::Normal && priority != AsyncPriority::High) {
+      return FailureExecutionResult(
+          errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE);
+    }
+
+    auto* task = task_pool_->Acquire();
+    task->SetOperation(std::forward<Callable>(work));
+    SampleTask(*task);
+    return EnqueueTask(task, priority);
+  }
+
+  /**
+   * @brief Same as Schedule, but the task is dropped and on_expired is called
+   * in its place if it has not started by the deadline. With the
+   * EarliestDeadlineFirst policy, the normal priority tasks are run in the
+   * order of their deadlines.
+   * @param work the task that needs to be scheduled.
+   * @param priority the priority of the task. Either normal or medium.
+   * @param deadline the coarse steady clock time in nanoseconds after which the
+   * task is not executed anymore. 0 for no deadline.
+   * @param on_expired the operation called in place of the expired task.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  ExecutionResult ScheduleWithDeadline(
+      const AsyncOperation& work, AsyncPriority priority, Timestamp deadline,
+      const AsyncOperation& on_expired) noexcept;
+
+  /**
+   * @brief Schedules a batch of tasks with the same priority and signals the
+   * worker once for the whole batch.
+   * @param works the tasks that need to be scheduled.
+   * @param priority the priority of the tasks. Either normal or medium.
+   * @param scheduled_count the number of tasks that were scheduled. On failure,
+   * the tasks after them are not scheduled.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  ExecutionResult ScheduleBatch(absl::Span<const AsyncOperation> works,
+                                AsyncPriority priority,
+                                size_t& scheduled_count) noexcept;
 
   /**
    * @brief Returns the ID of the spawned thread object to enable looking it up
@@ -64,10 +177,135 @@ class SingleThreadAsyncExecutor : ServiceInterface {
    */
   ExecutionResultOr<std::thread::id> GetThreadId() const;
 
+  /**
+   * @brief Sets the sibling executors this executor is allowed to steal normal
+   * priority tasks from once its own queues run dry. Must be called before
+   * Run().
+   *
+   * @param siblings the executors to steal from. The executor itself is
+   * skipped if present.
+   */
+  void SetWorkStealingSiblings(
+      const std::vector<std::shared_ptr<SingleThreadAsyncExecutor>>&
+          siblings) noexcept;
+
+  /**
+   * @brief Takes a pending normal priority task out of this executor's queue on
+   * behalf of an idle sibling executor. With the EarliestDeadlineFirst policy,
+   * only the tasks not yet picked up by the executor thread can be stolen.
+   *
+   * @param task the stolen task, if any.
+   * @return ExecutionResult Success if a task was stolen.
+   */
+  ExecutionResult TryStealNormalPriorityTask(Task*& task) noexcept;
+
+  /// Returns the number of tasks waiting in the queues of this executor.
+  size_t GetQueueDepth() const noexcept;
+
+  /**
+   * @brief Gives an executed or dropped task back to this executor's pool.
+   *
+   * @param task the task to be released.
+   */
+  void ReleaseTask(Task* task) noexcept { task_pool_->Release(task); }
+
  private:
   /// Starts the internal worker thread.
   void StartWorker() noexcept;
 
+  /**
+   * @brief Stamps the enqueue time on one task out of the telemetry sampling
+   * period. The counter is per scheduling thread so that producers do not
+   * contend on it.
+   *
+   * @param task the task being scheduled.
+   */
+  void SampleTask(Task& task) noexcept {
+    if (telemetry_sampling_period_ == 0) {
+      return;
+    }
+    static thread_local uint32_t scheduled_task_count = 0;
+    if (++scheduled_task_count % telemetry_sampling_period_ == 0) {
+      task.SetEnqueueTimestamp(
+          common::TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks());
+    }
+  }
+
+  /**
+   * @brief Runs the task and reports its timings if it was sampled.
+   *
+   * @param task the task to be executed.
+   */
+  void ExecuteTask(Task& task) noexcept;
+
+  /**
+   * @brief Puts the task in the queue of the given priority and signals the
+   * worker.
+   *
+   * @param task the task to be enqueued.
+   * @param priority the priority of the task.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  ExecutionResult EnqueueTask(Task* task, AsyncPriority priority) noexcept;
+
+  /**
+   * @brief Puts the task in the queue of the given priority without signaling
+   * the worker.
+   *
+   * @param task the task to be enqueued. Released on failure.
+   * @param priority the priority of the task.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  ExecutionResult EnqueueTaskWithoutNotify(Task* task,
+                                           AsyncPriority priority) noexcept;
+
+  /// Releases all the tasks left in the queues.
+  void DropQueuedTasks() noexcept;
+
+  /**
+   * @brief Moves the normal priority tasks from the intake queue to the
+   * deadline ordered heap, up to queue_cap_ of them. Must be called by the
+   * worker thread with mutex_ held.
+   */
+  void MoveNormalPriorityTasksToDeadlineOrder() noexcept;
+
+  /**
+   * @brief Takes the next normal priority task to run, the one with the
+   * earliest deadline with the EarliestDeadlineFirst policy. Must be called by
+   * the worker thread with mutex_ held.
+   *
+   * @param task the task, if any.
+   * @return true if there was a task.
+   */
+  bool TryDequeueNormalPriorityTask(Task*& task) noexcept;
+
+  /// A normal priority task in the deadline ordered heap.
+  struct DeadlineOrderedTask {
+    /// The deadline the task is ordered by.
+    Timestamp deadline;
+    /// Breaks the ties between the tasks with the same deadline, in order.
+    uint64_t sequence_number;
+    Task* task;
+
+    /// Orders the heap so that the earliest deadline is on top.
+    bool operator>(const DeadlineOrderedTask& other) const noexcept {
+      if (deadline != other.deadline) {
+        return deadline > other.deadline;
+      }
+      return sequence_number > other.sequence_number;
+    }
+  };
+
+  /**
+   * @brief Tries to steal a normal priority task from one of the sibling
+   * executors, starting from a rotating offset so that idle executors do not
+   * all drain the same sibling.
+   *
+   * @param task the stolen task, if any.
+   * @return true if a task was stolen.
+   */
+  bool TryStealFromSiblings(Task*& task) noexcept;
+
   /**
    * @brief While it is true, the running thread will keep listening and
    * picking out work from work queue. While it is false, the thread will try to
@@ -84,12 +322,32 @@ class SingleThreadAsyncExecutor : ServiceInterface {
   bool drop_tasks_on_stop_;
   /// An optional CPU to have an affinity for.
   std::optional<size_t> affinity_cpu_number_;
+  /// Optional sink of the timings of the sampled tasks.
+  std::shared_ptr<AsyncExecutorTelemetryInterface> telemetry_;
+  /// One task out of this many is timed. 0 if there is no telemetry.
+  uint32_t telemetry_sampling_period_;
+  /// The index of this executor in its pool, reported to the telemetry.
+  size_t executor_index_;
+  /// How the thread waits for work when idle.
+  ExecutorWaitStrategy wait_strategy_;
+  /// The order the normal priority tasks are run in.
+  TaskOrderingPolicy task_ordering_policy_;
+  /**
+   * @brief The normal priority tasks picked up from the intake queue, as a
+   * min heap on their deadlines. Only used with the EarliestDeadlineFirst
+   * policy, and guarded by mutex_.
+   */
+  std::vector<DeadlineOrderedTask> deadline_ordered_tasks_;
+  /// The size of deadline_ordered_tasks_, readable without mutex_.
+  std::atomic<size_t> deadline_ordered_task_count_;
+  /// The sequence number of the next task put in deadline_ordered_tasks_.
+  uint64_t next_deadline_ordered_sequence_number_ = 0;
+  /// Pool of task nodes of this executor.
+  std::unique_ptr<AsyncTaskPool<Task>> task_pool_;
   /// Queue for accepting the incoming normal priority tasks.
-  std::shared_ptr<common::ConcurrentQueue<std::shared_ptr<AsyncTask>>>
-      normal_pri_queue_;
+  std::shared_ptr<TaskQueue> normal_pri_queue_;
   /// Queue for accepting the incoming high priority tasks.
-  std::shared_ptr<common::ConcurrentQueue<std::shared_ptr<AsyncTask>>>
-      high_pri_queue_;
+  std::shared_ptr<TaskQueue> high_pri_queue_;
   /// A unique pointer to the working thread.
   std::unique_ptr<std::thread> working_thread_;
   /// The ID of the working_thread_.
@@ -104,5 +362,13 @@ class SingleThreadAsyncExecutor : ServiceInterface {
    * element is pushed to the queue.
    */
   std::condition_variable condition_variable_;
+  /**
+   * @brief The executors to steal work from when idle. Weak references are
+   * kept since the siblings are owned by the same pool as this executor.
+   */
+  std::vector<std::weak_ptr<SingleThreadAsyncExecutor>>
+      work_stealing_siblings_;
+  /// The sibling index to start the next stealing attempt from.
+  size_t next_steal_index_ = 0;
 };
 }  // namespace google::scp::core
@@ -86,14 +86,28 @@ void SingleThreadPriorityAsyncExecutor::StartWorker() noexcept {
   unique_lock<mutex> thread_lock(mutex_);
   auto wait_timeout_duration_ns = kInfiniteWaitDurationNs;
 
+  auto has_work_or_stopped = [&]() {
+    Timestamp current_timestamp =
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+
+    return !is_running_ || update_wait_time_ ||
+           current_timestamp > next_scheduled_task_timestamp_;
+  };
+
   while (true) {
-    condition_variable_.wait_for(thread_lock, wait_timeout_duration_ns, [&]() {
-      Timestamp current_timestamp =
-          TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+    // Poll without the lock first so that the producers do not need to wake
+    // the thread up for the work arriving shortly. Only done when the queue is
+    // empty, otherwise the thread would poll before each timed wait.
+    if (wait_strategy_.PollsBeforeParking() &&
+        wait_timeout_duration_ns == kInfiniteWaitDurationNs &&
+        !has_work_or_stopped()) {
+      thread_lock.unlock();
+      wait_strategy_.PollUntil(has_work_or_stopped);
+      thread_lock.lock();
+    }
 
-      return !is_running_ || update_wait_time_ ||
-             current_timestamp > next_scheduled_task_timestamp_;
-    });
+    condition_variable_.wait_for(thread_lock, wait_timeout_duration_ns,
+                                 has_work_or_stopped);
 
     if (update_wait_time_) {
       update_wait_time_ = false;
@@ -25,17 +25,21 @@
 #include "core/interface/async_executor_interface.h"
 
 #include "async_task.h"
+#include "executor_wait_strategy.h"
+#include "single_thread_scheduled_async_executor.h"
 
 namespace google::scp::core {
 /**
  * @brief A single threaded priority async executor. This executor will have one
  * thread working with one priority queue.
  */
-class SingleThreadPriorityAsyncExecutor : ServiceInterface {
+class SingleThreadPriorityAsyncExecutor
+    : public SingleThreadScheduledAsyncExecutor {
  public:
   explicit SingleThreadPriorityAsyncExecutor(
       size_t queue_cap, bool drop_tasks_on_stop = false,
-      std::optional<size_t> affinity_cpu_number = std::nullopt)
+      std::optional<size_t> affinity_cpu_number = std::nullopt,
+      ExecutorWaitStrategy wait_strategy = ExecutorWaitStrategy::Park())
       : is_running_(false),
         worker_thread_started_(false),
         worker_thread_stopped_(false),
@@ -43,7 +47,8 @@ class SingleThreadPriorityAsyncExecutor : ServiceInterface {
         next_scheduled_task_timestamp_(UINT64_MAX),
         queue_cap_(queue_cap),
         drop_tasks_on_stop_(drop_tasks_on_stop),
-        affinity_cpu_number_(affinity_cpu_number) {}
+        affinity_cpu_number_(affinity_cpu_number),
+        wait_strategy_(wait_strategy) {}
 
   ExecutionResult Init() noexcept override;
 
@@ -51,35 +56,14 @@ class SingleThreadPriorityAsyncExecutor : ServiceInterface {
 
   ExecutionResult Stop() noexcept override;
 
-  /**
-   * @brief Schedules a task to be executed at a certain time.
-   *
-   * @param work The task that needs to be scheduled.
-   * @param timestamp The timestamp to the task to be executed.
-   * @return ExecutionResult The result of the execution with possible error
-   * code.
-   */
   ExecutionResult ScheduleFor(const AsyncOperation& work,
-                              Timestamp timestamp) noexcept;
+                              Timestamp timestamp) noexcept override;
 
-  /**
-   * @brief Schedules a task to be executed at a certain time.
-   *
-   * @param work The task that needs to be scheduled.
-   * @param timestamp The timestamp to the task to be executed.
-   * @param cancellation_callback The callback to be used for cancelling the
-   * scheduled work.
-   * @return ExecutionResult result of the execution with possible error code.
-   */
   ExecutionResult ScheduleFor(
       const AsyncOperation& work, Timestamp timestamp,
-      std::function<bool()>& cancellation_callback) noexcept;
+      std::function<bool()>& cancellation_callback) noexcept override;
 
-  /**
-   * @brief Returns the ID of the spawned thread object to enable looking it up
-   * via thread IDs later. Will only be populated after Run() is called.
-   */
-  ExecutionResultOr<std::thread::id> GetThreadId() const;
+  ExecutionResultOr<std::thread::id> GetThreadId() const override;
 
  private:
   /// Starts the internal worker thread.
@@ -108,6 +92,8 @@ class SingleThreadPriorityAsyncExecutor : ServiceInterface {
   bool drop_tasks_on_stop_;
   /// An optional CPU to have an affinity for.
   std::optional<size_t> affinity_cpu_number_;
+  /// How the thread waits for work when idle.
+  ExecutorWaitStrategy wait_strategy_;
   /// A unique pointer to the working thread.
   std::unique_ptr<std::thread> working_thread_;
   /// The ID of the working_thread_.
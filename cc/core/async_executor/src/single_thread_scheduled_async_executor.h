@@ -0,0 +1,62 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <thread>
+
+#include "core/interface/async_executor_interface.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core {
+/**
+ * @brief A single threaded executor running tasks at a given time. The urgent
+ * pool of the AsyncExecutor is made of these executors.
+ */
+class SingleThreadScheduledAsyncExecutor : public ServiceInterface {
+ public:
+  virtual ~SingleThreadScheduledAsyncExecutor() = default;
+
+  /**
+   * @brief Schedules a task to be executed at a certain time.
+   *
+   * @param work The task that needs to be scheduled.
+   * @param timestamp The timestamp to the task to be executed.
+   * @return ExecutionResult The result of the execution with possible error
+   * code.
+   */
+  virtual ExecutionResult ScheduleFor(const AsyncOperation& work,
+                                      Timestamp timestamp) noexcept = 0;
+
+  /**
+   * @brief Schedules a task to be executed at a certain time.
+   *
+   * @param work The task that needs to be scheduled.
+   * @param timestamp The timestamp to the task to be executed.
+   * @param cancellation_callback The callback to be used for cancelling the
+   * scheduled work.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  virtual ExecutionResult ScheduleFor(
+      const AsyncOperation& work, Timestamp timestamp,
+      std::function<bool()>& cancellation_callback) noexcept = 0;
+
+  /**
+   * @brief Returns the ID of the spawned thread object to enable looking it up
+   * via thread IDs later. Will only be populated after Run() is called.
+   */
+  virtual ExecutionResultOr<std::thread::id> GetThreadId() const = 0;
+};
+}  // namespace google::scp::core
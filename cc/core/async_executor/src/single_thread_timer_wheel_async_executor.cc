@@ -0,0 +1,356 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "single_thread_timer_wheel_async_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/common/time_provider/src/time_provider.h"
+
+#include "async_executor_utils.h"
+#include "error_codes.h"
+#include "typedef.h"
+
+using google::scp::core::common::ConcurrentQueue;
+using google::scp::core::common::TimeProvider;
+using std::function;
+using std::make_shared;
+using std::make_unique;
+using std::mutex;
+using std::remove_if;
+using std::shared_ptr;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+namespace google::scp::core {
+ExecutionResult SingleThreadTimerWheelAsyncExecutor::Init() noexcept {
+  if (queue_cap_ <= 0 || queue_cap_ > kMaxQueueCap) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_INVALID_QUEUE_CAP);
+  }
+
+  if (tick_duration_ns_ == 0) {
+    return FailureExecutionResult(
+        errors::SC_ASYNC_EXECUTOR_INVALID_TICK_DURATION);
+  }
+
+  intake_queue_ =
+      make_shared<ConcurrentQueue<shared_ptr<AsyncTask>>>(queue_cap_);
+  wheel_.resize(kLevelCount * kSlotsPerLevel);
+  return SuccessExecutionResult();
+};
+
+ExecutionResult SingleThreadTimerWheelAsyncExecutor::Run() noexcept {
+  if (is_running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_ALREADY_RUNNING);
+  }
+
+  if (!intake_queue_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_INITIALIZED);
+  }
+
+  current_tick_ =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() /
+      tick_duration_ns_;
+  is_running_ = true;
+  working_thread_ = make_unique<thread>(
+      [affinity_cpu_number =
+           affinity_cpu_number_](SingleThreadTimerWheelAsyncExecutor* ptr) {
+        if (affinity_cpu_number.has_value()) {
+          // Ignore error.
+          AsyncExecutorUtils::SetAffinity(*affinity_cpu_number);
+        }
+        ptr->worker_thread_started_ = true;
+        ptr->StartWorker();
+        ptr->worker_thread_stopped_ = true;
+      },
+      this);
+  working_thread_id_ = working_thread_->get_id();
+  working_thread_->detach();
+
+  return SuccessExecutionResult();
+}
+
+uint64_t SingleThreadTimerWheelAsyncExecutor::ToTick(
+    Timestamp timestamp) const noexcept {
+  return timestamp / tick_duration_ns_ +
+         (timestamp % tick_duration_ns_ == 0 ? 0 : 1);
+}
+
+void SingleThreadTimerWheelAsyncExecutor::InsertIntoWheel(
+    const shared_ptr<AsyncTask>& task) noexcept {
+  auto expiry_tick = ToTick(task->GetExecutionTimestamp());
+  task_count_in_wheel_++;
+
+  // Overdue tasks go to the slot that is processed next.
+  if (expiry_tick < current_tick_) {
+    GetSlot(0, current_tick_ & kSlotMask).push_back(task);
+    return;
+  }
+
+  auto delta = expiry_tick - current_tick_;
+  for (size_t level = 0; level < kLevelCount; ++level) {
+    auto level_shift = level * kSlotBitsPerLevel;
+    if (level == kLevelCount - 1) {
+      // Too far in the future, park it at the farthest slot and let the
+      // cascades bring it closer.
+      static constexpr uint64_t kMaxDelta =
+          (1ULL << (kLevelCount * kSlotBitsPerLevel)) - 1;
+      if (delta > kMaxDelta) {
+        expiry_tick = current_tick_ + kMaxDelta;
+      }
+    } else if (delta >= (1ULL << (level_shift + kSlotBitsPerLevel))) {
+      continue;
+    }
+    GetSlot(level, (expiry_tick >> level_shift) & kSlotMask).push_back(task);
+    return;
+  }
+}
+
+size_t SingleThreadTimerWheelAsyncExecutor::Cascade(size_t level) noexcept {
+  auto index = (current_tick_ >> (level * kSlotBitsPerLevel)) & kSlotMask;
+  vector<shared_ptr<AsyncTask>> tasks;
+  tasks.swap(GetSlot(level, index));
+  task_count_in_wheel_ -= tasks.size();
+  for (auto& task : tasks) {
+    if (task->IsCancelled()) {
+      pending_task_count_--;
+      continue;
+    }
+    InsertIntoWheel(task);
+  }
+  return index;
+}
+
+void SingleThreadTimerWheelAsyncExecutor::AdvanceTo(
+    uint64_t target_tick,
+    vector<shared_ptr<AsyncTask>>& expired_tasks) noexcept {
+  while (current_tick_ <= target_tick) {
+    if (task_count_in_wheel_ == 0) {
+      // Nothing to cascade or to run on the way.
+      current_tick_ = target_tick + 1;
+      return;
+    }
+
+    auto index = current_tick_ & kSlotMask;
+    if (index == 0) {
+      // A full rotation of a level is done, bring down the next slot of the
+      // coarser level. Stop at the first level that did not wrap around.
+      for (size_t level = 1; level < kLevelCount; ++level) {
+        if (Cascade(level) != 0) {
+          break;
+        }
+      }
+    }
+
+    auto& slot = GetSlot(0, index);
+    task_count_in_wheel_ -= slot.size();
+    for (auto& task : slot) {
+      if (task->IsCancelled()) {
+        pending_task_count_--;
+        continue;
+      }
+      expired_tasks.push_back(std::move(task));
+    }
+    slot.clear();
+    current_tick_++;
+  }
+}
+
+uint64_t SingleThreadTimerWheelAsyncExecutor::GetNextWakeupTick()
+    const noexcept {
+  // The coarse levels are cascaded when the finest level wraps around.
+  if ((current_tick_ & kSlotMask) == 0) {
+    return current_tick_;
+  }
+
+  auto rotation_end_tick = current_tick_ | kSlotMask;
+  for (auto tick = current_tick_; tick <= rotation_end_tick; ++tick) {
+    if (!wheel_[tick & kSlotMask].empty()) {
+      return tick;
+    }
+  }
+  return rotation_end_tick + 1;
+}
+
+void SingleThreadTimerWheelAsyncExecutor::DrainIntakeQueue() noexcept {
+  shared_ptr<AsyncTask> task;
+  while (intake_queue_->TryDequeue(task).Successful()) {
+    if (task->IsCancelled()) {
+      pending_task_count_--;
+      continue;
+    }
+    InsertIntoWheel(task);
+  }
+}
+
+void SingleThreadTimerWheelAsyncExecutor::RemoveCancelledTasks() noexcept {
+  for (auto& slot : wheel_) {
+    auto removed_begin =
+        remove_if(slot.begin(), slot.end(),
+                  [](const shared_ptr<AsyncTask>& task) {
+                    return task->IsCancelled();
+                  });
+    auto removed_count = slot.end() - removed_begin;
+    slot.erase(removed_begin, slot.end());
+    task_count_in_wheel_ -= removed_count;
+    pending_task_count_ -= removed_count;
+  }
+}
+
+void SingleThreadTimerWheelAsyncExecutor::DropAllTasks() noexcept {
+  shared_ptr<AsyncTask> task;
+  while (intake_queue_->TryDequeue(task).Successful()) {
+    pending_task_count_--;
+  }
+  for (auto& slot : wheel_) {
+    pending_task_count_ -= slot.size();
+    slot.clear();
+  }
+  task_count_in_wheel_ = 0;
+}
+
+void SingleThreadTimerWheelAsyncExecutor::StartWorker() noexcept {
+  vector<shared_ptr<AsyncTask>> expired_tasks;
+
+  while (true) {
+    DrainIntakeQueue();
+
+    auto is_stopping = !is_running_.load();
+    if (is_stopping) {
+      if (drop_tasks_on_stop_) {
+        DropAllTasks();
+      } else {
+        // Do not wait on the execution time of cancelled tasks to arrive.
+        RemoveCancelledTasks();
+      }
+      if (task_count_in_wheel_ == 0 && intake_queue_->Size() == 0) {
+        break;
+      }
+    }
+
+    AdvanceTo(TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() /
+                  tick_duration_ns_,
+              expired_tasks);
+    if (!expired_tasks.empty()) {
+      for (auto& task : expired_tasks) {
+        task->Execute();
+      }
+      pending_task_count_ -= expired_tasks.size();
+      expired_tasks.clear();
+      // Time has passed while executing, look at the wheel again.
+      continue;
+    }
+
+    Timestamp next_wakeup_timestamp = UINT64_MAX;
+    if (task_count_in_wheel_ > 0) {
+      next_wakeup_timestamp = GetNextWakeupTick() * tick_duration_ns_;
+    }
+    next_wakeup_timestamp_ = next_wakeup_timestamp;
+    // A producer might have missed the new wake up time.
+    if (intake_queue_->Size() > 0) {
+      continue;
+    }
+
+    unique_lock<mutex> thread_lock(mutex_);
+    auto wait_timeout_duration_ns = kInfiniteWaitDurationNs;
+    if (next_wakeup_timestamp != UINT64_MAX) {
+      Timestamp current_timestamp =
+          TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+      wait_timeout_duration_ns = nanoseconds(0);
+      if (current_timestamp < next_wakeup_timestamp) {
+        wait_timeout_duration_ns =
+            nanoseconds(next_wakeup_timestamp - current_timestamp);
+      }
+    }
+    condition_variable_.wait_for(thread_lock, wait_timeout_duration_ns, [&]() {
+      return update_wait_time_ || (!is_running_ && !is_stopping);
+    });
+    update_wait_time_ = false;
+  }
+}
+
+ExecutionResult SingleThreadTimerWheelAsyncExecutor::Stop() noexcept {
+  if (!is_running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  unique_lock<mutex> thread_lock(mutex_);
+  is_running_ = false;
+  condition_variable_.notify_all();
+  thread_lock.unlock();
+
+  // To ensure stop can happen cleanly, it is required to wait for the thread to
+  // start and exit gracefully. If stop happens before the starting the thread,
+  // there is a chance that Stop returns successful but the thread has not been
+  // killed.
+  while (!(worker_thread_started_.load() && worker_thread_stopped_.load())) {
+    std::this_thread::sleep_for(milliseconds(kSleepDurationMs));
+  }
+
+  return SuccessExecutionResult();
+};
+
+ExecutionResult SingleThreadTimerWheelAsyncExecutor::ScheduleFor(
+    const AsyncOperation& work, Timestamp timestamp) noexcept {
+  function<bool()> cancellation_callback = []() { return false; };
+  return ScheduleFor(work, timestamp, cancellation_callback);
+};
+
+ExecutionResult SingleThreadTimerWheelAsyncExecutor::ScheduleFor(
+    const AsyncOperation& work, Timestamp timestamp,
+    function<bool()>& cancellation_callback) noexcept {
+  if (!is_running_) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+
+  if (pending_task_count_.fetch_add(1) >= queue_cap_) {
+    pending_task_count_--;
+    return RetryExecutionResult(errors::SC_ASYNC_EXECUTOR_EXCEEDING_QUEUE_CAP);
+  }
+
+  auto task = make_shared<AsyncTask>(work, timestamp);
+  if (!intake_queue_->TryEnqueue(task).Successful()) {
+    pending_task_count_--;
+    return RetryExecutionResult(errors::SC_ASYNC_EXECUTOR_EXCEEDING_QUEUE_CAP);
+  }
+  cancellation_callback = [task]() mutable { return task->Cancel(); };
+
+  // Only wake the worker up if it would otherwise sleep past this task, and
+  // nobody has asked for it already.
+  if (timestamp < next_wakeup_timestamp_.load() &&
+      !update_wait_time_.exchange(true)) {
+    unique_lock<mutex> thread_lock(mutex_);
+    condition_variable_.notify_one();
+  }
+  return SuccessExecutionResult();
+};
+
+ExecutionResultOr<thread::id> SingleThreadTimerWheelAsyncExecutor::GetThreadId()
+    const {
+  if (!is_running_.load()) {
+    return FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING);
+  }
+  return working_thread_id_;
+}
+
+}  // namespace google::scp::core
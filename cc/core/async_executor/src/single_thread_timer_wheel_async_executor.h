@@ -0,0 +1,201 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "core/common/concurrent_queue/src/concurrent_queue.h"
+#include "core/interface/async_executor_interface.h"
+
+#include "async_task.h"
+#include "single_thread_scheduled_async_executor.h"
+
+namespace google::scp::core {
+/// The default duration of one tick of the timer wheel.
+static constexpr std::chrono::nanoseconds kDefaultTimerWheelTickDuration =
+    std::chrono::milliseconds(1);
+
+/**
+ * @brief A single threaded async executor keeping the scheduled tasks in a
+ * hierarchical timing wheel instead of a priority queue.
+ *
+ * Producers hand the tasks over through a concurrent intake queue and only take
+ * the lock when the task is due before the worker's next planned wake up, so
+ * scheduling and cancelling are O(1). The worker thread is the only owner of
+ * the wheel: it moves the intake into the wheel slots, cascades the coarse
+ * levels into the finer ones as the time passes and runs the tasks whose tick
+ * has been reached. Cancelled tasks are dropped lazily when their slot is
+ * visited.
+ *
+ * Tasks are never executed before their timestamp, but may be executed up to
+ * one tick after it.
+ */
+class SingleThreadTimerWheelAsyncExecutor
+    : public SingleThreadScheduledAsyncExecutor {
+ public:
+  explicit SingleThreadTimerWheelAsyncExecutor(
+      size_t queue_cap, bool drop_tasks_on_stop = false,
+      std::optional<size_t> affinity_cpu_number = std::nullopt,
+      std::chrono::nanoseconds tick_duration = kDefaultTimerWheelTickDuration)
+      : is_running_(false),
+        worker_thread_started_(false),
+        worker_thread_stopped_(false),
+        update_wait_time_(false),
+        next_wakeup_timestamp_(UINT64_MAX),
+        pending_task_count_(0),
+        queue_cap_(queue_cap),
+        drop_tasks_on_stop_(drop_tasks_on_stop),
+        affinity_cpu_number_(affinity_cpu_number),
+        tick_duration_ns_(tick_duration.count()),
+        current_tick_(0),
+        task_count_in_wheel_(0) {}
+
+  ExecutionResult Init() noexcept override;
+
+  ExecutionResult Run() noexcept override;
+
+  ExecutionResult Stop() noexcept override;
+
+  ExecutionResult ScheduleFor(const AsyncOperation& work,
+                              Timestamp timestamp) noexcept override;
+
+  ExecutionResult ScheduleFor(
+      const AsyncOperation& work, Timestamp timestamp,
+      std::function<bool()>& cancellation_callback) noexcept override;
+
+  ExecutionResultOr<std::thread::id> GetThreadId() const override;
+
+ private:
+  /// Number of bits of the tick used to index the slots of one level.
+  static constexpr size_t kSlotBitsPerLevel = 8;
+  /// Number of slots per level.
+  static constexpr size_t kSlotsPerLevel = 1 << kSlotBitsPerLevel;
+  /// Mask to get the slot index of a level.
+  static constexpr uint64_t kSlotMask = kSlotsPerLevel - 1;
+  /// Number of levels. Tasks farther than 2^32 ticks are re-cascaded.
+  static constexpr size_t kLevelCount = 4;
+
+  /// Starts the internal worker thread.
+  void StartWorker() noexcept;
+
+  /// Moves all the tasks from the intake queue into the wheel.
+  void DrainIntakeQueue() noexcept;
+
+  /**
+   * @brief Places the task in the slot matching its execution tick.
+   *
+   * @param task The task to be placed.
+   */
+  void InsertIntoWheel(const std::shared_ptr<AsyncTask>& task) noexcept;
+
+  /**
+   * @brief Redistributes the slot of the given level which the current tick
+   * points to over the finer levels.
+   *
+   * @param level The level to cascade.
+   * @return size_t The index of the cascaded slot.
+   */
+  size_t Cascade(size_t level) noexcept;
+
+  /**
+   * @brief Advances the wheel up to and including the given tick and collects
+   * the tasks that have expired on the way.
+   *
+   * @param target_tick The tick to advance to.
+   * @param expired_tasks The non-cancelled tasks that are due.
+   */
+  void AdvanceTo(
+      uint64_t target_tick,
+      std::vector<std::shared_ptr<AsyncTask>>& expired_tasks) noexcept;
+
+  /**
+   * @brief Returns the closest tick at which the wheel needs to be looked at,
+   * either to run a task or to cascade the coarse levels.
+   */
+  uint64_t GetNextWakeupTick() const noexcept;
+
+  /// Removes the cancelled tasks from all the slots.
+  void RemoveCancelledTasks() noexcept;
+
+  /// Removes all the tasks from the intake queue and the wheel.
+  void DropAllTasks() noexcept;
+
+  /// Converts a timestamp to the first tick at or after it.
+  uint64_t ToTick(Timestamp timestamp) const noexcept;
+
+  /// Returns the slot of the wheel at the given level and index.
+  std::vector<std::shared_ptr<AsyncTask>>& GetSlot(size_t level,
+                                                   size_t index) noexcept {
+    return wheel_[level * kSlotsPerLevel + index];
+  }
+
+  /**
+   * @brief While it is true, the running thread will keep listening and
+   * picking out work from work queue. While it is false, the thread will try to
+   * finish all the remaining tasks in the queue and then stop.
+   */
+  std::atomic<bool> is_running_;
+  /// Indicates whether the worker thread started.
+  std::atomic<bool> worker_thread_started_;
+  /// Indicates whether the worker thread stopped.
+  std::atomic<bool> worker_thread_stopped_;
+  /// Indicates whether the wait time needs to be updated.
+  std::atomic<bool> update_wait_time_;
+  /**
+   * @brief The timestamp at which the worker plans to wake up next. Producers
+   * only signal the worker for tasks due before it.
+   */
+  std::atomic<Timestamp> next_wakeup_timestamp_;
+  /// Number of tasks accepted and not yet executed or dropped.
+  std::atomic<size_t> pending_task_count_;
+  /// The maximum number of pending tasks.
+  size_t queue_cap_;
+  /// Indicates whether the async executor should ignore the pending tasks.
+  bool drop_tasks_on_stop_;
+  /// An optional CPU to have an affinity for.
+  std::optional<size_t> affinity_cpu_number_;
+  /// The duration of one tick in nanoseconds.
+  uint64_t tick_duration_ns_;
+  /// The next tick to be processed. Only accessed by the worker thread.
+  uint64_t current_tick_;
+  /// Number of tasks placed in the wheel. Only accessed by the worker thread.
+  size_t task_count_in_wheel_;
+  /// The slots of all the levels. Only accessed by the worker thread.
+  std::vector<std::vector<std::shared_ptr<AsyncTask>>> wheel_;
+  /// Queue for accepting the incoming tasks.
+  std::shared_ptr<common::ConcurrentQueue<std::shared_ptr<AsyncTask>>>
+      intake_queue_;
+  /// A unique pointer to the working thread.
+  std::unique_ptr<std::thread> working_thread_;
+  /// The ID of the working_thread_.
+  std::thread::id working_thread_id_;
+  /**
+   * @brief Used in combination with the condition variable for signaling the
+   * thread that an earlier task is pushed to the queue.
+   */
+  std::mutex mutex_;
+  /**
+   * @brief Used in combination with the mutex for signaling the thread that an
+   * earlier task is pushed to the queue.
+   */
+  std::condition_variable condition_variable_;
+};
+}  // namespace google::scp::core
@@ -24,6 +24,10 @@ namespace google::scp::core {
 static constexpr size_t kMaxThreadCount = 10000;
 /// The maximum queue cap could be set.
 static const size_t kMaxQueueCap = UINT_MAX;
+/// The maximum number of idle task nodes an executor keeps for reuse.
+static constexpr size_t kMaxPooledTaskCount = 100000;
+/// The minimum number of tasks of a batch handed to each executor.
+static constexpr size_t kMinScheduleBatchChunkSize = 16;
 /// The sleep interval for shutting down threads in miliseconds.
 static const size_t kSleepDurationMs = 10;
 /// Indicates an infinite wait time.
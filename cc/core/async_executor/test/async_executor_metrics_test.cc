@@ -0,0 +1,171 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/async_executor/src/async_executor_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/async_executor/src/async_executor.h"
+#include "core/telemetry/mock/in_memory_metric_router.h"
+#include "core/telemetry/src/common/metric_utils.h"
+#include "core/test/utils/conditional_wait.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using std::atomic;
+using std::make_shared;
+using std::map;
+using std::string;
+using std::vector;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace google::scp::core::test {
+namespace {
+opentelemetry::sdk::common::OrderedAttributeMap GetExecutorDimensions(
+    const string& executor_name, size_t executor_index) {
+  const map<string, string> label_kv = {
+      {string(kAsyncExecutorNameLabel), executor_name},
+      {string(kAsyncExecutorIndexLabel), std::to_string(executor_index)}};
+  return opentelemetry::sdk::common::OrderedAttributeMap(
+      opentelemetry::common::KeyValueIterableView<map<string, string>>(
+          label_kv));
+}
+}  // namespace
+
+class AsyncExecutorMetricsTest : public testing::Test {
+ protected:
+  AsyncExecutorMetricsTest()
+      : metric_router_(make_shared<InMemoryMetricRouter>()),
+        metrics_(make_shared<AsyncExecutorMetrics>(metric_router_.get(),
+                                                   "test_executor",
+                                                   /*sampling_period=*/1)) {}
+
+  std::shared_ptr<InMemoryMetricRouter> metric_router_;
+  std::shared_ptr<AsyncExecutorMetrics> metrics_;
+};
+
+TEST_F(AsyncExecutorMetricsTest, RecordsTaskTimeHistograms) {
+  EXPECT_SUCCESS(metrics_->Init());
+  metrics_->RecordTask(1, microseconds(50), milliseconds(2));
+  metrics_->RecordTask(1, microseconds(70), milliseconds(3));
+
+  auto data = metric_router_->GetExportedData();
+  auto wait_time_point_data = GetMetricPointData(
+      kAsyncExecutorTaskWaitTimeMetric,
+      GetExecutorDimensions("test_executor", 1), data);
+  ASSERT_TRUE(wait_time_point_data.has_value());
+  auto wait_time_histogram =
+      std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+          wait_time_point_data.value());
+  EXPECT_EQ(wait_time_histogram.count_, 2);
+
+  auto run_time_point_data = GetMetricPointData(
+      kAsyncExecutorTaskRunTimeMetric,
+      GetExecutorDimensions("test_executor", 1), data);
+  ASSERT_TRUE(run_time_point_data.has_value());
+  auto run_time_histogram =
+      std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+          run_time_point_data.value());
+  EXPECT_EQ(run_time_histogram.count_, 2);
+  EXPECT_DOUBLE_EQ(std::get<double>(run_time_histogram.sum_), 0.005);
+}
+
+TEST_F(AsyncExecutorMetricsTest, RecordsTaggedTaskCounters) {
+  EXPECT_SUCCESS(metrics_->Init());
+  AsyncTaskTag tag = {"TestComponent", "TestOperation"};
+  metrics_->RecordTaggedTask(tag, 64, milliseconds(2));
+  metrics_->RecordTaggedTask(tag, 64, milliseconds(3));
+
+  const map<string, string> label_kv = {
+      {string(kAsyncExecutorNameLabel), "test_executor"},
+      {string(kAsyncExecutorTaskComponentLabel), "TestComponent"},
+      {string(kAsyncExecutorTaskOperationLabel), "TestOperation"}};
+  opentelemetry::sdk::common::OrderedAttributeMap dimensions(
+      opentelemetry::common::KeyValueIterableView<map<string, string>>(
+          label_kv));
+  auto data = metric_router_->GetExportedData();
+  auto count_point_data = GetMetricPointData(
+      kAsyncExecutorTaggedTaskCountMetric, dimensions, data);
+  ASSERT_TRUE(count_point_data.has_value());
+  EXPECT_EQ(std::get<int64_t>(
+                std::get<opentelemetry::sdk::metrics::SumPointData>(
+                    count_point_data.value())
+                    .value_),
+            128);
+  auto cpu_time_point_data = GetMetricPointData(
+      kAsyncExecutorTaggedTaskCpuTimeMetric, dimensions, data);
+  ASSERT_TRUE(cpu_time_point_data.has_value());
+  EXPECT_DOUBLE_EQ(std::get<double>(
+                       std::get<opentelemetry::sdk::metrics::SumPointData>(
+                           cpu_time_point_data.value())
+                           .value_),
+                   0.005);
+}
+
+TEST_F(AsyncExecutorMetricsTest, ObservesQueueDepthWhileProviderIsSet) {
+  EXPECT_SUCCESS(metrics_->Init());
+  metrics_->SetQueueDepthProvider(
+      [](vector<size_t>& queue_depths) { queue_depths = {3, 5}; });
+
+  auto data = metric_router_->GetExportedData();
+  for (size_t i = 0; i < 2; ++i) {
+    auto queue_depth_point_data =
+        GetMetricPointData(kAsyncExecutorQueueDepthMetric,
+                           GetExecutorDimensions("test_executor", i), data);
+    ASSERT_TRUE(queue_depth_point_data.has_value());
+    auto queue_depth =
+        std::get<opentelemetry::sdk::metrics::LastValuePointData>(
+            queue_depth_point_data.value());
+    EXPECT_EQ(std::get<int64_t>(queue_depth.value_), i == 0 ? 3 : 5);
+  }
+
+  metrics_->SetQueueDepthProvider(nullptr);
+}
+
+TEST_F(AsyncExecutorMetricsTest, AsyncExecutorReportsSampledTasks) {
+  EXPECT_SUCCESS(metrics_->Init());
+  AsyncExecutor executor(1, 10, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::RoundRobinGlobal,
+                         ScheduledTaskQueueType::PriorityQueue,
+                         ThreadPlacementPolicy::Unpinned, metrics_);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_SUCCESS(
+        executor.Schedule([&]() { count++; }, AsyncPriority::Normal));
+  }
+  WaitUntil([&]() { return count == 5; });
+  EXPECT_SUCCESS(executor.Stop());
+
+  auto data = metric_router_->GetExportedData();
+  auto run_time_point_data = GetMetricPointData(
+      kAsyncExecutorTaskRunTimeMetric,
+      GetExecutorDimensions("test_executor", 0), data);
+  ASSERT_TRUE(run_time_point_data.has_value());
+  auto run_time_histogram =
+      std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+          run_time_point_data.value());
+  EXPECT_EQ(run_time_histogram.count_, 5);
+}
+}  // namespace google::scp::core::test
@@ -20,6 +20,7 @@
 #include <chrono>
 #include <functional>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 
@@ -39,6 +40,7 @@ using std::hash;
 using std::make_shared;
 using std::map;
 using std::mutex;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::thread;
@@ -46,6 +48,7 @@ using std::unique_lock;
 using std::vector;
 using std::chrono::duration_cast;
 using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
 using std::chrono::nanoseconds;
 using std::chrono::seconds;
 using std::this_thread::sleep_for;
@@ -314,6 +317,359 @@ TEST(AsyncExecutorTests, CountWorkSingleThreadUrgentToNormal) {
   executor.Stop();
 }
 
+TEST(AsyncExecutorTests, CountWorkWithTimerWheel) {
+  int queue_cap = 10;
+  AsyncExecutor executor(2, queue_cap, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::RoundRobinGlobal,
+                         ScheduledTaskQueueType::TimerWheel);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(executor.ScheduleFor([&]() { count++; }, 123456));
+    EXPECT_SUCCESS(
+        executor.Schedule([&]() { count++; }, AsyncPriority::Urgent));
+  }
+  // Waits some time to finish the work.
+  WaitUntil([&]() { return count == 2 * queue_cap; });
+  EXPECT_EQ(count, 2 * queue_cap);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, NumaInterleavedPlacementPinsThreads) {
+  int queue_cap = 10;
+  AsyncExecutor executor(2, queue_cap, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::WorkStealing,
+                         ScheduledTaskQueueType::PriorityQueue,
+                         ThreadPlacementPolicy::NumaInterleaved);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  auto expected_placement = AsyncExecutorUtils::GetThreadPlacement(
+      ThreadPlacementPolicy::NumaInterleaved, 2,
+      AsyncExecutorUtils::GetNumaNodeCpus());
+  atomic<int> count(0);
+  atomic<int> pinned_count(0);
+  auto work = [&]() {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    if (CPU_COUNT(&cpuset) == 1 &&
+        (CPU_ISSET(*expected_placement[0], &cpuset) ||
+         CPU_ISSET(*expected_placement[1], &cpuset))) {
+      pinned_count++;
+    }
+    count++;
+  };
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(executor.Schedule(work, AsyncPriority::Normal));
+    EXPECT_SUCCESS(executor.Schedule(work, AsyncPriority::Urgent));
+  }
+  WaitUntil([&]() { return count == 2 * queue_cap; });
+  EXPECT_EQ(pinned_count, 2 * queue_cap);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, UnpinnedPlacementKeepsThreadsUnpinned) {
+  cpu_set_t caller_cpuset;
+  CPU_ZERO(&caller_cpuset);
+  pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &caller_cpuset);
+
+  int queue_cap = 10;
+  AsyncExecutor executor(1, queue_cap, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::RoundRobinGlobal,
+                         ScheduledTaskQueueType::PriorityQueue,
+                         ThreadPlacementPolicy::Unpinned);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<bool> done(false);
+  atomic<bool> same_affinity(false);
+  EXPECT_SUCCESS(executor.Schedule(
+      [&]() {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        same_affinity = CPU_EQUAL(&cpuset, &caller_cpuset);
+        done = true;
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return done.load(); });
+  EXPECT_TRUE(same_affinity);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, ScheduleWithDeadlineDropsExpiredTasks) {
+  AsyncExecutor executor(2, 100, /*drop_tasks_on_stop=*/false,
+                         TaskLoadBalancingScheme::RoundRobinGlobal,
+                         ScheduledTaskQueueType::PriorityQueue,
+                         ThreadPlacementPolicy::SequentialCpu,
+                         /*telemetry=*/nullptr, ExecutorWaitStrategy::Park(),
+                         TaskOrderingPolicy::EarliestDeadlineFirst);
+  auto now =
+      common::TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks();
+  auto future_deadline = now + nanoseconds(seconds(60)).count();
+  EXPECT_THAT(executor.ScheduleWithDeadline([]() {}, AsyncPriority::Normal,
+                                            future_deadline, []() {}),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> executed_count(0);
+  atomic<int> expired_count(0);
+  for (auto priority :
+       {AsyncPriority::Normal, AsyncPriority::High, AsyncPriority::Urgent}) {
+    EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+        [&]() { executed_count++; }, priority, now - 1,
+        [&]() { expired_count++; }));
+    EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+        [&]() { executed_count++; }, priority, future_deadline,
+        [&]() { expired_count++; }));
+  }
+  WaitUntil([&]() { return executed_count + expired_count == 6; });
+  EXPECT_EQ(executed_count, 3);
+  EXPECT_EQ(expired_count, 3);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, ScheduleBatchSpreadsChunksOverExecutors) {
+  size_t thread_count = 4;
+  AsyncExecutor executor(thread_count, 100);
+  vector<AsyncOperation> works(thread_count * kMinScheduleBatchChunkSize);
+  EXPECT_THAT(executor.ScheduleBatch(works, AsyncPriority::Normal),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  mutex thread_ids_mutex;
+  set<thread::id> thread_ids;
+  atomic<size_t> count(0);
+  for (auto& work : works) {
+    work = [&]() {
+      {
+        unique_lock<mutex> lock(thread_ids_mutex);
+        thread_ids.insert(std::this_thread::get_id());
+      }
+      count++;
+    };
+  }
+
+  size_t scheduled_count = 0;
+  EXPECT_SUCCESS(
+      executor.ScheduleBatch(works, AsyncPriority::Normal, scheduled_count));
+  EXPECT_EQ(scheduled_count, works.size());
+  WaitUntil([&]() { return count == works.size(); });
+  EXPECT_EQ(thread_ids.size(), thread_count);
+
+  // Small batches go to a single executor.
+  thread_ids.clear();
+  count = 0;
+  EXPECT_SUCCESS(executor.ScheduleBatch(
+      absl::MakeConstSpan(works).subspan(0, kMinScheduleBatchChunkSize),
+      AsyncPriority::High));
+  WaitUntil([&]() { return count == kMinScheduleBatchChunkSize; });
+  EXPECT_EQ(thread_ids.size(), 1);
+
+  count = 0;
+  EXPECT_SUCCESS(executor.ScheduleBatch(works, AsyncPriority::Urgent,
+                                        scheduled_count));
+  EXPECT_EQ(scheduled_count, works.size());
+  WaitUntil([&]() { return count == works.size(); });
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, ScheduleBatchRunsEachWorkOnceWithUnevenChunks) {
+  // 305 works over 19 executors do not split into chunks of equal size.
+  size_t thread_count = 19;
+  AsyncExecutor executor(thread_count, 100);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  vector<atomic<size_t>> execution_counts(305);
+  vector<AsyncOperation> works;
+  for (auto& execution_count : execution_counts) {
+    works.push_back([&execution_count]() { execution_count++; });
+  }
+  atomic<size_t> count(0);
+  for (auto& work : works) {
+    work = [&count, work]() {
+      work();
+      count++;
+    };
+  }
+
+  size_t scheduled_count = 0;
+  EXPECT_SUCCESS(
+      executor.ScheduleBatch(works, AsyncPriority::Normal, scheduled_count));
+  EXPECT_EQ(scheduled_count, works.size());
+  WaitUntil([&]() { return count == works.size(); });
+  for (auto& execution_count : execution_counts) {
+    EXPECT_EQ(execution_count, 1);
+  }
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, ScheduleToShardRunsAShardOnOneThread) {
+  size_t thread_count = 4;
+  AsyncExecutor executor(thread_count, 100);
+  EXPECT_THAT(executor.ScheduleToShard([]() {}, AsyncPriority::Normal, 0),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  size_t task_count = 100;
+  for (auto priority : {AsyncPriority::Normal, AsyncPriority::Urgent}) {
+    mutex thread_ids_mutex;
+    map<uint64_t, set<thread::id>> shard_thread_ids;
+    atomic<size_t> count(0);
+    for (size_t i = 0; i < task_count; ++i) {
+      uint64_t shard_key = i % thread_count;
+      EXPECT_SUCCESS(executor.ScheduleToShard(
+          [&, shard_key]() {
+            {
+              unique_lock<mutex> lock(thread_ids_mutex);
+              shard_thread_ids[shard_key].insert(std::this_thread::get_id());
+            }
+            count++;
+          },
+          priority, shard_key));
+    }
+    WaitUntil([&]() { return count == task_count; });
+
+    set<thread::id> thread_ids;
+    for (auto& [shard_key, ids] : shard_thread_ids) {
+      EXPECT_EQ(ids.size(), 1);
+      thread_ids.insert(*ids.begin());
+    }
+    EXPECT_EQ(thread_ids.size(), thread_count);
+  }
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+namespace {
+class FakeAsyncExecutorTelemetry : public AsyncExecutorTelemetryInterface {
+ public:
+  uint32_t GetSamplingPeriod() const noexcept override { return 1; }
+
+  void RecordTask(size_t executor_index, nanoseconds,
+                  nanoseconds) noexcept override {
+    unique_lock<mutex> lock(mutex_);
+    recorded_executor_indices.insert(executor_index);
+  }
+
+  void RecordTaggedTask(const AsyncTaskTag& tag, uint64_t task_count,
+                        nanoseconds) noexcept override {
+    unique_lock<mutex> lock(mutex_);
+    recorded_tagged_task_count[tag.operation] += task_count;
+  }
+
+  void SetQueueDepthProvider(
+      ExecutorQueueDepthProvider queue_depth_provider) noexcept override {
+    unique_lock<mutex> lock(mutex_);
+    this->queue_depth_provider = queue_depth_provider;
+  }
+
+  mutex mutex_;
+  set<size_t> recorded_executor_indices;
+  map<string, uint64_t> recorded_tagged_task_count;
+  ExecutorQueueDepthProvider queue_depth_provider;
+};
+}  // namespace
+
+TEST(AsyncExecutorTests, ReportsTelemetryOfNormalExecutors) {
+  auto telemetry = make_shared<FakeAsyncExecutorTelemetry>();
+  AsyncExecutor executor(2, 10, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::RoundRobinGlobal,
+                         ScheduledTaskQueueType::PriorityQueue,
+                         ThreadPlacementPolicy::Unpinned, telemetry);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+  ASSERT_TRUE(telemetry->queue_depth_provider);
+  vector<size_t> queue_depths;
+  telemetry->queue_depth_provider(queue_depths);
+  EXPECT_EQ(queue_depths, (vector<size_t>{0, 0}));
+
+  atomic<int> count(0);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_SUCCESS(executor.Schedule([&]() { count++; }, AsyncPriority::High));
+  }
+  WaitUntil([&]() { return count == 4; });
+  WaitUntil([&]() {
+    unique_lock<mutex> lock(telemetry->mutex_);
+    return telemetry->recorded_executor_indices.size() == 2;
+  });
+  EXPECT_SUCCESS(executor.Stop());
+  EXPECT_FALSE(telemetry->queue_depth_provider);
+}
+
+TEST(AsyncExecutorTests, AccumulatesTheCpuTimeOfTaggedTasks) {
+  static constexpr AsyncTaskTag kBusyTag = {"TestComponent", "Busy"};
+  static constexpr AsyncTaskTag kIdleTag = {"TestComponent", "Idle"};
+  auto telemetry = make_shared<FakeAsyncExecutorTelemetry>();
+  AsyncExecutor executor(2, 10, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::RoundRobinGlobal,
+                         ScheduledTaskQueueType::PriorityQueue,
+                         ThreadPlacementPolicy::Unpinned, telemetry);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_SUCCESS(executor.Schedule(
+        [&]() {
+          auto start = AsyncExecutorUtils::GetCurrentThreadCpuTime();
+          while (AsyncExecutorUtils::GetCurrentThreadCpuTime() - start <
+                 milliseconds(2)) {
+          }
+          count++;
+        },
+        AsyncPriority::Normal, kBusyTag));
+  }
+  EXPECT_SUCCESS(
+      executor.Schedule([&]() { count++; }, AsyncPriority::High, kIdleTag));
+  EXPECT_SUCCESS(executor.Schedule([&]() { count++; }, AsyncPriority::Normal));
+  WaitUntil([&]() {
+    unique_lock<mutex> lock(telemetry->mutex_);
+    return count == 5 && telemetry->recorded_tagged_task_count.size() == 2 &&
+           telemetry->recorded_tagged_task_count["Busy"] == 3;
+  });
+
+  auto stats = executor.GetTaskTagStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].component, "TestComponent");
+  EXPECT_EQ(stats[0].operation, "Busy");
+  EXPECT_EQ(stats[0].task_count, 3);
+  EXPECT_GE(stats[0].cpu_time, milliseconds(6));
+  EXPECT_EQ(stats[1].operation, "Idle");
+  EXPECT_EQ(stats[1].task_count, 1);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(AsyncExecutorTests, SampledTaggedTasksStandForTheSamplingPeriod) {
+  static constexpr AsyncTaskTag kTag = {"TestComponent", "TestOperation"};
+  AsyncExecutor executor(1, 1000);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  // Any run of twice the sampling period has exactly two sampled tasks.
+  atomic<int> count(0);
+  int task_count = 2 * kDefaultAsyncExecutorTelemetrySamplingPeriod;
+  for (int i = 0; i < task_count; i++) {
+    EXPECT_SUCCESS(
+        executor.Schedule([&]() { count++; }, AsyncPriority::Normal, kTag));
+  }
+  WaitUntil([&]() {
+    auto stats = executor.GetTaskTagStats();
+    return count == task_count && stats.size() == 1 &&
+           stats[0].task_count == task_count;
+  });
+  EXPECT_SUCCESS(executor.Stop());
+}
+
 TEST(AsyncExecutorTests, CountWorkMultipleThread) {
   int queue_cap = 50;
   AsyncExecutor executor(10, queue_cap);
@@ -331,6 +687,37 @@ TEST(AsyncExecutorTests, CountWorkMultipleThread) {
   EXPECT_EQ(count, queue_cap);
 }
 
+TEST(AsyncExecutorTests, WorkStealingDoesNotWaitOnBusyExecutor) {
+  int queue_cap = 20;
+  AsyncExecutor executor(2, queue_cap, false /* drop tasks on stop */,
+                         TaskLoadBalancingScheme::WorkStealing);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  // One of the two normal executors gets parked, half of the tasks scheduled
+  // afterwards are queued behind it.
+  atomic<bool> release(false);
+  atomic<bool> blocked(false);
+  EXPECT_SUCCESS(executor.Schedule(
+      [&]() {
+        blocked = true;
+        WaitUntil([&]() { return release.load(); });
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return blocked.load(); });
+
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(
+        executor.Schedule([&]() { count++; }, AsyncPriority::Normal));
+  }
+  WaitUntil([&]() { return count == queue_cap; });
+  EXPECT_EQ(count, queue_cap);
+
+  release = true;
+  EXPECT_SUCCESS(executor.Stop());
+}
+
 TEST(AsyncExecutorTests, AsyncContextCallback) {
   AsyncExecutor executor(1, 10);
   executor.Init();
@@ -435,15 +822,14 @@ class AsyncExecutorAccessor : public AsyncExecutor {
 
   void TestPickTaskExecutorRoundRobinGlobalUrgentPool() {
     int num_executors = 10;
-    vector<shared_ptr<SingleThreadPriorityAsyncExecutor>> task_executor_pool;
+    vector<shared_ptr<UrgentTaskExecutor>> task_executor_pool;
     for (int i = 0; i < num_executors; i++) {
       task_executor_pool.push_back(
           make_shared<SingleThreadPriorityAsyncExecutor>(100 /* queue cap */));
     }
 
     // Run picking executors
-    map<shared_ptr<SingleThreadPriorityAsyncExecutor>, int>
-        task_executor_pool_picked_counts;
+    map<shared_ptr<UrgentTaskExecutor>, int> task_executor_pool_picked_counts;
     for (int i = 0; i < num_executors; i++) {
       auto task_executor_or =
           PickTaskExecutor(AsyncExecutorAffinitySetting::NonAffinitized,
@@ -487,15 +873,14 @@ class AsyncExecutorAccessor : public AsyncExecutor {
 
   void PickTaskExecutorRoundRobinThreadLocalUrgentPool() {
     int num_executors = 10;
-    vector<shared_ptr<SingleThreadPriorityAsyncExecutor>> task_executor_pool;
+    vector<shared_ptr<UrgentTaskExecutor>> task_executor_pool;
     for (int i = 0; i < num_executors; i++) {
       task_executor_pool.push_back(
           make_shared<SingleThreadPriorityAsyncExecutor>(100 /* queue cap */));
     }
 
     // Run picking executors
-    map<shared_ptr<SingleThreadPriorityAsyncExecutor>, int>
-        task_executor_pool_picked_counts;
+    map<shared_ptr<UrgentTaskExecutor>, int> task_executor_pool_picked_counts;
     for (int i = 0; i < num_executors; i++) {
       auto task_executor_or =
           PickTaskExecutor(AsyncExecutorAffinitySetting::NonAffinitized,
@@ -714,8 +1099,7 @@ class AsyncExecutorAccessor : public AsyncExecutor {
     // Scheduling another task with affinity should result in using the same
     // thread.
     atomic<bool> done(false);
-    vector<shared_ptr<SingleThreadPriorityAsyncExecutor>>
-        task_executor_pool;  // unused.
+    vector<shared_ptr<UrgentTaskExecutor>> task_executor_pool;  // unused.
     // Schedule arbitrary work to be done. Using the chosen thread of this work,
     // ensure that picking another executor with affinity chooses this same
     // thread.
@@ -743,8 +1127,7 @@ class AsyncExecutorAccessor : public AsyncExecutor {
     // Scheduling another task with affinity should result in using the same
     // thread.
     atomic<bool> done(false);
-    vector<shared_ptr<SingleThreadPriorityAsyncExecutor>>
-        task_executor_pool;  // unused.
+    vector<shared_ptr<UrgentTaskExecutor>> task_executor_pool;  // unused.
     // Schedule arbitrary work to be done. Using the chosen thread of this work,
     // ensure that picking another executor with affinity chooses this same
     // thread.
@@ -16,6 +16,9 @@
 
 #include <gtest/gtest.h>
 
+#include <optional>
+#include <vector>
+
 #include "public/core/test/interface/execution_result_matchers.h"
 
 namespace google::scp::core::test {
@@ -32,4 +35,50 @@ TEST(AsyncExecutorUtilsTest, BasicTests) {
       ResultIs(FailureExecutionResult(
           errors::SC_ASYNC_EXECUTOR_UNABLE_TO_SET_AFFINITY)));
 }
+
+TEST(AsyncExecutorUtilsTest, ParseCpuList) {
+  std::vector<size_t> cpus;
+  EXPECT_TRUE(AsyncExecutorUtils::ParseCpuList("0-3,8,10-11\n", cpus));
+  EXPECT_EQ(cpus, (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+
+  EXPECT_TRUE(AsyncExecutorUtils::ParseCpuList("", cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_FALSE(AsyncExecutorUtils::ParseCpuList("3-1", cpus));
+  EXPECT_FALSE(AsyncExecutorUtils::ParseCpuList("a-b", cpus));
+}
+
+TEST(AsyncExecutorUtilsTest, GetNumaNodeCpusCoversAllCpus) {
+  auto numa_node_cpus = AsyncExecutorUtils::GetNumaNodeCpus();
+  ASSERT_FALSE(numa_node_cpus.empty());
+  for (const auto& cpus : numa_node_cpus) {
+    EXPECT_FALSE(cpus.empty());
+  }
+}
+
+TEST(AsyncExecutorUtilsTest, NumaInterleavedPlacement) {
+  std::vector<std::vector<size_t>> numa_node_cpus = {{0, 1, 2}, {3, 4, 5}};
+  auto placement = AsyncExecutorUtils::GetThreadPlacement(
+      ThreadPlacementPolicy::NumaInterleaved, 8, numa_node_cpus);
+  std::vector<std::optional<size_t>> expected_placement = {0, 3, 1, 4,
+                                                           2, 5, 0, 3};
+  EXPECT_EQ(placement, expected_placement);
+
+  auto cpu_to_numa_node =
+      AsyncExecutorUtils::GetCpuToNumaNodeMap(numa_node_cpus);
+  EXPECT_EQ(cpu_to_numa_node, (std::vector<size_t>{0, 0, 0, 1, 1, 1}));
+}
+
+TEST(AsyncExecutorUtilsTest, SequentialAndUnpinnedPlacement) {
+  std::vector<std::vector<size_t>> numa_node_cpus = {{0}, {1}};
+  auto placement = AsyncExecutorUtils::GetThreadPlacement(
+      ThreadPlacementPolicy::SequentialCpu, 2, numa_node_cpus);
+  EXPECT_EQ(placement[0], 0 % std::thread::hardware_concurrency());
+  EXPECT_EQ(placement[1], 1 % std::thread::hardware_concurrency());
+
+  placement = AsyncExecutorUtils::GetThreadPlacement(
+      ThreadPlacementPolicy::Unpinned, 2, numa_node_cpus);
+  EXPECT_EQ(placement,
+            (std::vector<std::optional<size_t>>{std::nullopt, std::nullopt}));
+}
 }  // namespace google::scp::core::test
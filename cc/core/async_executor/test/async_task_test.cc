@@ -16,9 +16,17 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <memory>
+
+#include "core/async_executor/src/inline_async_task.h"
 #include "core/common/time_provider/src/time_provider.h"
 
 using google::scp::core::common::TimeProvider;
+using std::array;
+using std::make_shared;
+using std::move;
+using std::shared_ptr;
 
 namespace google::scp::core::test {
 TEST(AsyncTaskTests, BasicTests) {
@@ -31,4 +39,69 @@ TEST(AsyncTaskTests, BasicTests) {
   AsyncTask async_task1(func, 1234);
   EXPECT_EQ(async_task1.GetExecutionTimestamp(), 1234);
 }
+
+TEST(AsyncTaskTests, InlineAsyncOperationStoresSmallCallablesInline) {
+  int count = 0;
+  InlineAsyncOperation<> operation([&count]() { count++; });
+  EXPECT_TRUE(operation);
+  EXPECT_TRUE(operation.IsStoredInline());
+  operation();
+  EXPECT_EQ(count, 1);
+
+  operation.Reset();
+  EXPECT_FALSE(operation);
+}
+
+TEST(AsyncTaskTests, InlineAsyncOperationFallsBackToHeap) {
+  int count = 0;
+  array<char, 128> big_capture = {};
+  InlineAsyncOperation<32> operation([&count, big_capture]() {
+    count += big_capture.size();
+  });
+  EXPECT_FALSE(operation.IsStoredInline());
+  operation();
+  EXPECT_EQ(count, 128);
+}
+
+TEST(AsyncTaskTests, InlineAsyncOperationMoveAndDestroy) {
+  auto captured = make_shared<int>(0);
+  {
+    InlineAsyncOperation<> operation([captured]() { (*captured)++; });
+    EXPECT_EQ(captured.use_count(), 2);
+
+    InlineAsyncOperation<> moved_operation(move(operation));
+    EXPECT_FALSE(operation);
+    moved_operation();
+    EXPECT_EQ(*captured, 1);
+    EXPECT_EQ(captured.use_count(), 2);
+
+    operation = move(moved_operation);
+    operation();
+    EXPECT_EQ(*captured, 2);
+  }
+  // The capture is released with the operation.
+  EXPECT_EQ(captured.use_count(), 1);
+}
+
+TEST(AsyncTaskTests, AsyncTaskPoolReusesNodes) {
+  AsyncTaskPool<InlineAsyncTask<>> pool(1 /* max pooled task count */);
+  auto captured = make_shared<int>(0);
+
+  auto* task = pool.Acquire();
+  task->SetOperation([captured]() { (*captured)++; });
+  task->Execute();
+  EXPECT_EQ(*captured, 1);
+  pool.Release(task);
+  // Releasing resets the operation.
+  EXPECT_EQ(captured.use_count(), 1);
+
+  // The released node is handed out again, the pool is then empty.
+  EXPECT_EQ(pool.Acquire(), task);
+  auto* other_task = pool.Acquire();
+  EXPECT_NE(other_task, task);
+
+  // Only one node fits in the pool, the other one is freed.
+  pool.Release(task);
+  pool.Release(other_task);
+}
 }  // namespace google::scp::core::test
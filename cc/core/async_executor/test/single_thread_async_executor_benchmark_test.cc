@@ -14,7 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <functional>
+#include <new>
 #include <vector>
 
 #include "core/async_executor/src/single_thread_async_executor.h"
@@ -26,6 +28,7 @@ using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::TimeProvider;
 using std::atomic;
+using std::bad_alloc;
 using std::cout;
 using std::endl;
 using std::function;
@@ -38,6 +41,25 @@ using std::chrono::duration_cast;
 using std::chrono::milliseconds;
 using std::this_thread::sleep_for;
 
+// Counts the allocations going through the global operator new of this binary.
+static atomic<size_t> allocation_count(0);
+
+void* operator new(size_t size) {
+  allocation_count++;
+  if (auto* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
 namespace google::scp::core::test {
 class SingleThreadAsyncExecutorBenchmarkTest : public ::testing::Test {
  protected:
@@ -139,4 +161,46 @@ TEST_F(SingleThreadAsyncExecutorBenchmarkTest, PerfTestSmallTaskMixedPriority) {
     threads[i].join();
   }
 }
+
+TEST_F(SingleThreadAsyncExecutorBenchmarkTest, AllocationsPerScheduledTask) {
+  SetUpExecutor();
+  size_t task_count = 100000;
+  atomic<size_t> executed_count(0);
+  auto schedule_tasks = [&](bool use_async_operation) {
+    executed_count = 0;
+    bool all_scheduled = true;
+    auto allocation_count_before = allocation_count.load();
+    for (size_t i = 0; i < task_count; i++) {
+      auto work = [&]() { executed_count++; };
+      auto result = use_async_operation
+                        ? async_executor_->Schedule(work, AsyncPriority::Normal)
+                        : async_executor_->ScheduleInline(
+                              work, AsyncPriority::Normal);
+      all_scheduled = all_scheduled && result.Successful();
+    }
+    while (executed_count != task_count) {
+      sleep_for(milliseconds(5));
+    }
+    EXPECT_TRUE(all_scheduled);
+    return static_cast<double>(allocation_count.load() -
+                               allocation_count_before) /
+           task_count;
+  };
+
+  // Warms the task pool up.
+  schedule_tasks(false /* use async operation */);
+
+  auto inline_allocations_per_task = schedule_tasks(false);
+  auto async_operation_allocations_per_task = schedule_tasks(true);
+  cout << inline_allocations_per_task
+       << " allocations per task scheduled inline" << endl;
+  cout << async_operation_allocations_per_task
+       << " allocations per task scheduled as AsyncOperation" << endl;
+
+  // Scheduling used to allocate the AsyncTask node at the very least.
+  EXPECT_LT(inline_allocations_per_task, 1);
+  EXPECT_LT(async_operation_allocations_per_task, 1);
+
+  EXPECT_SUCCESS(async_executor_->Stop());
+}
 }  // namespace google::scp::core::test
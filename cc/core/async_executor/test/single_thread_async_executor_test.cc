@@ -20,8 +20,10 @@
 #include <chrono>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "core/async_executor/mock/mock_async_executor_with_internals.h"
+#include "core/async_executor/src/async_executor_telemetry.h"
 #include "core/async_executor/src/error_codes.h"
 #include "core/async_executor/src/typedef.h"
 #include "core/common/time_provider/src/time_provider.h"
@@ -35,14 +37,46 @@
 using google::scp::core::common::TimeProvider;
 using std::atomic;
 using std::make_shared;
+using std::shared_ptr;
 using std::string;
 using std::chrono::duration_cast;
 using std::chrono::high_resolution_clock;
 using std::chrono::nanoseconds;
 using std::chrono::seconds;
+using std::vector;
 using testing::Values;
 
 namespace google::scp::core::test {
+namespace {
+class FakeAsyncExecutorTelemetry : public AsyncExecutorTelemetryInterface {
+ public:
+  explicit FakeAsyncExecutorTelemetry(uint32_t sampling_period)
+      : sampling_period_(sampling_period) {}
+
+  uint32_t GetSamplingPeriod() const noexcept override {
+    return sampling_period_;
+  }
+
+  void RecordTask(size_t executor_index, nanoseconds wait_time,
+                  nanoseconds run_time) noexcept override {
+    recorded_executor_index = executor_index;
+    recorded_wait_time_ns += wait_time.count();
+    recorded_run_time_ns += run_time.count();
+    recorded_task_count++;
+  }
+
+  void SetQueueDepthProvider(ExecutorQueueDepthProvider) noexcept override {}
+
+  atomic<size_t> recorded_task_count{0};
+  atomic<size_t> recorded_executor_index{0};
+  atomic<int64_t> recorded_wait_time_ns{0};
+  atomic<int64_t> recorded_run_time_ns{0};
+
+ private:
+  uint32_t sampling_period_;
+};
+}  // namespace
+
 TEST(SingleThreadAsyncExecutorTests, CannotInitWithTooBigQueueCap) {
   SingleThreadAsyncExecutor executor(kMaxQueueCap + 1);
   EXPECT_THAT(executor.Init(),
@@ -137,6 +171,159 @@ TEST(SingleThreadAsyncExecutorTests, ExceedingQueueCapSchedule) {
   executor.Stop();
 }
 
+TEST(SingleThreadAsyncExecutorTests, ScheduleBatch) {
+  SingleThreadAsyncExecutor executor(100);
+  size_t scheduled_count = 0;
+  vector<AsyncOperation> works(50);
+  EXPECT_THAT(executor.ScheduleBatch(works, AsyncPriority::Normal,
+                                     scheduled_count),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<size_t> count(0);
+  for (auto& work : works) {
+    work = [&]() { count++; };
+  }
+  EXPECT_SUCCESS(
+      executor.ScheduleBatch(works, AsyncPriority::Normal, scheduled_count));
+  EXPECT_EQ(scheduled_count, works.size());
+  EXPECT_SUCCESS(
+      executor.ScheduleBatch(works, AsyncPriority::High, scheduled_count));
+  EXPECT_EQ(scheduled_count, works.size());
+  EXPECT_THAT(executor.ScheduleBatch(works, AsyncPriority::Urgent,
+                                     scheduled_count),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_INVALID_PRIORITY_TYPE)));
+  EXPECT_EQ(scheduled_count, 0);
+
+  WaitUntil([&]() { return count == 2 * works.size(); });
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadAsyncExecutorTests, ScheduleBatchStopsAtQueueCap) {
+  size_t queue_cap = 4;
+  SingleThreadAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<bool> blocking_task_started(false);
+  atomic<bool> release_blocking_task(false);
+  EXPECT_SUCCESS(executor.Schedule(
+      [&]() {
+        blocking_task_started = true;
+        WaitUntil([&]() { return release_blocking_task.load(); });
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return blocking_task_started.load(); });
+
+  atomic<size_t> count(0);
+  vector<AsyncOperation> works(10, [&]() { count++; });
+  size_t scheduled_count = 0;
+  EXPECT_THAT(
+      executor.ScheduleBatch(works, AsyncPriority::Normal, scheduled_count),
+      ResultIs(
+          RetryExecutionResult(errors::SC_ASYNC_EXECUTOR_EXCEEDING_QUEUE_CAP)));
+  EXPECT_EQ(scheduled_count, queue_cap);
+
+  release_blocking_task = true;
+  WaitUntil([&]() { return count == queue_cap; });
+  EXPECT_SUCCESS(executor.Stop());
+  EXPECT_EQ(count, queue_cap);
+}
+
+TEST(SingleThreadAsyncExecutorTests, RecordsSampledTaskTimings) {
+  auto telemetry = make_shared<FakeAsyncExecutorTelemetry>(4);
+  SingleThreadAsyncExecutor executor(100, false /* drop_tasks_on_stop */,
+                                     std::nullopt, telemetry,
+                                     7 /* executor_index */);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  // Sampling is counted per scheduling thread, so schedule from a fresh one.
+  atomic<size_t> count(0);
+  std::thread([&]() {
+    for (int i = 0; i < 40; i++) {
+      EXPECT_SUCCESS(executor.Schedule(
+          [&]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            count++;
+          },
+          AsyncPriority::Normal));
+    }
+  }).join();
+  WaitUntil([&]() { return count == 40; });
+  EXPECT_SUCCESS(executor.Stop());
+
+  EXPECT_EQ(telemetry->recorded_task_count, 10);
+  EXPECT_EQ(telemetry->recorded_executor_index, 7);
+  EXPECT_GE(telemetry->recorded_run_time_ns, 10 * 100 * 1000);
+  EXPECT_GT(telemetry->recorded_wait_time_ns, 0);
+}
+
+TEST(SingleThreadAsyncExecutorTests, GetQueueDepth) {
+  SingleThreadAsyncExecutor executor(100);
+  EXPECT_EQ(executor.GetQueueDepth(), 0);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<bool> blocking_task_started(false);
+  atomic<bool> release_blocking_task(false);
+  EXPECT_SUCCESS(executor.Schedule(
+      [&]() {
+        blocking_task_started = true;
+        WaitUntil([&]() { return release_blocking_task.load(); });
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return blocking_task_started.load(); });
+
+  EXPECT_SUCCESS(executor.Schedule([]() {}, AsyncPriority::Normal));
+  EXPECT_SUCCESS(executor.Schedule([]() {}, AsyncPriority::High));
+  EXPECT_EQ(executor.GetQueueDepth(), 2);
+
+  release_blocking_task = true;
+  WaitUntil([&]() { return executor.GetQueueDepth() == 0; });
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadAsyncExecutorTests, WaitStrategyPollUntil) {
+  EXPECT_FALSE(ExecutorWaitStrategy::Park().PollsBeforeParking());
+  auto wait_strategy = ExecutorWaitStrategy::SpinThenPark(10, 5);
+  EXPECT_TRUE(wait_strategy.PollsBeforeParking());
+
+  size_t poll_count = 0;
+  EXPECT_FALSE(wait_strategy.PollUntil([&]() {
+    poll_count++;
+    return false;
+  }));
+  // Every spin and yield iteration polls, plus the final check.
+  EXPECT_EQ(poll_count, 16);
+
+  poll_count = 0;
+  EXPECT_TRUE(wait_strategy.PollUntil([&]() { return ++poll_count == 12; }));
+  EXPECT_EQ(poll_count, 12);
+}
+
+TEST(SingleThreadAsyncExecutorTests, CountWorkWithSpinThenPark) {
+  SingleThreadAsyncExecutor executor(
+      10, false /* drop_tasks_on_stop */, std::nullopt, nullptr, 0,
+      ExecutorWaitStrategy::SpinThenPark(1000, 100));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_SUCCESS(executor.Schedule([&]() { count++; },
+                                     i % 2 == 0 ? AsyncPriority::Normal
+                                                : AsyncPriority::High));
+    // Lets the thread go idle between the tasks.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  WaitUntil([&]() { return count == 10; });
+  EXPECT_SUCCESS(executor.Stop());
+}
+
 TEST(SingleThreadAsyncExecutorTests, CountWorkSingleThread) {
   int queue_cap = 10;
   SingleThreadAsyncExecutor executor(queue_cap);
@@ -298,4 +485,147 @@ TEST(SingleThreadAsyncExecutorTests, FinishWorkWhenStopInMiddle) {
 
   EXPECT_EQ(medium_count + normal_count, queue_cap);
 }
+TEST(SingleThreadAsyncExecutorTests, IdleExecutorStealsFromBusySibling) {
+  int queue_cap = 10;
+  auto busy_executor = make_shared<SingleThreadAsyncExecutor>(queue_cap);
+  auto idle_executor = make_shared<SingleThreadAsyncExecutor>(queue_cap);
+  vector<shared_ptr<SingleThreadAsyncExecutor>> executors = {busy_executor,
+                                                             idle_executor};
+  for (auto& executor : executors) {
+    EXPECT_SUCCESS(executor->Init());
+    executor->SetWorkStealingSiblings(executors);
+    EXPECT_SUCCESS(executor->Run());
+  }
+
+  // Park the busy executor's thread until all the other tasks are done.
+  atomic<bool> release(false);
+  atomic<bool> blocked(false);
+  EXPECT_SUCCESS(busy_executor->Schedule(
+      [&]() {
+        blocked = true;
+        WaitUntil([&]() { return release.load(); });
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return blocked.load(); });
+
+  auto idle_thread_id = *idle_executor->GetThreadId();
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap - 1; i++) {
+    EXPECT_SUCCESS(busy_executor->Schedule(
+        [&]() {
+          EXPECT_EQ(std::this_thread::get_id(), idle_thread_id);
+          count++;
+        },
+        AsyncPriority::Normal));
+  }
+  WaitUntil([&]() { return count == queue_cap - 1; });
+  EXPECT_EQ(count, queue_cap - 1);
+
+  release = true;
+  for (auto& executor : executors) {
+    EXPECT_SUCCESS(executor->Stop());
+  }
+}
+
+TEST(SingleThreadAsyncExecutorTests, HighPriorityTasksAreNotStolen) {
+  int queue_cap = 10;
+  auto busy_executor = make_shared<SingleThreadAsyncExecutor>(queue_cap);
+  auto idle_executor = make_shared<SingleThreadAsyncExecutor>(queue_cap);
+  vector<shared_ptr<SingleThreadAsyncExecutor>> executors = {busy_executor,
+                                                             idle_executor};
+  for (auto& executor : executors) {
+    EXPECT_SUCCESS(executor->Init());
+    executor->SetWorkStealingSiblings(executors);
+    EXPECT_SUCCESS(executor->Run());
+  }
+
+  atomic<bool> release(false);
+  atomic<bool> blocked(false);
+  EXPECT_SUCCESS(busy_executor->Schedule(
+      [&]() {
+        blocked = true;
+        WaitUntil([&]() { return release.load(); });
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return blocked.load(); });
+
+  atomic<int> count(0);
+  EXPECT_SUCCESS(
+      busy_executor->Schedule([&]() { count++; }, AsyncPriority::High));
+  std::this_thread::sleep_for(UNIT_TEST_SHORT_SLEEP_MS);
+  EXPECT_EQ(count, 0);
+
+  release = true;
+  WaitUntil([&]() { return count == 1; });
+  for (auto& executor : executors) {
+    EXPECT_SUCCESS(executor->Stop());
+  }
+}
+
+TEST(SingleThreadAsyncExecutorTests, ExpiredTaskIsNotExecuted) {
+  SingleThreadAsyncExecutor executor(10);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> executed_count(0);
+  atomic<int> expired_count(0);
+  auto now = TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks();
+  EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+      [&]() { executed_count++; }, AsyncPriority::Normal, now - 1,
+      [&]() { expired_count++; }));
+  EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+      [&]() { executed_count++; }, AsyncPriority::High,
+      now + nanoseconds(seconds(60)).count(), [&]() { expired_count++; }));
+  WaitUntil([&]() { return executed_count + expired_count == 2; });
+  EXPECT_EQ(executed_count, 1);
+  EXPECT_EQ(expired_count, 1);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadAsyncExecutorTests, EarliestDeadlineFirst) {
+  SingleThreadAsyncExecutor executor(
+      10, /*drop_tasks_on_stop=*/false, /*affinity_cpu_number=*/std::nullopt,
+      /*telemetry=*/nullptr, /*executor_index=*/0, ExecutorWaitStrategy::Park(),
+      TaskOrderingPolicy::EarliestDeadlineFirst);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<bool> release(false);
+  atomic<bool> blocked(false);
+  EXPECT_SUCCESS(executor.Schedule(
+      [&]() {
+        blocked = true;
+        WaitUntil([&]() { return release.load(); });
+      },
+      AsyncPriority::Normal));
+  WaitUntil([&]() { return blocked.load(); });
+
+  // Queued while the executor is blocked, so that they are ordered together.
+  vector<int> order;
+  auto now = TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks();
+  auto deadline = [now](int offset_in_seconds) {
+    return now + nanoseconds(seconds(offset_in_seconds)).count();
+  };
+  EXPECT_SUCCESS(executor.Schedule([&]() { order.push_back(0); },
+                                   AsyncPriority::Normal));
+  EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+      [&]() { order.push_back(30); }, AsyncPriority::Normal, deadline(30),
+      []() {}));
+  EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+      [&]() { order.push_back(10); }, AsyncPriority::Normal, deadline(10),
+      []() {}));
+  EXPECT_SUCCESS(executor.ScheduleWithDeadline(
+      [&]() { order.push_back(20); }, AsyncPriority::Normal, deadline(20),
+      []() {}));
+  EXPECT_SUCCESS(executor.Schedule([&]() { order.push_back(-1); },
+                                   AsyncPriority::High));
+  EXPECT_EQ(executor.GetQueueDepth(), 5);
+
+  release = true;
+  WaitUntil([&]() { return executor.GetQueueDepth() == 0; });
+  EXPECT_SUCCESS(executor.Stop());
+  // The high priority task first, then the deadlines in order, the task
+  // without a deadline being given the default one.
+  EXPECT_EQ(order, (vector<int>{-1, 10, 20, 30, 0}));
+}
 }  // namespace google::scp::core::test
@@ -144,6 +144,28 @@ TEST(SingleThreadPriorityAsyncExecutorTests, CountWorkSingleThread) {
   EXPECT_SUCCESS(executor.Stop());
 }
 
+TEST(SingleThreadPriorityAsyncExecutorTests, CountWorkWithSpinThenPark) {
+  int queue_cap = 10;
+  SingleThreadPriorityAsyncExecutor executor(
+      queue_cap, false /* drop_tasks_on_stop */, std::nullopt,
+      ExecutorWaitStrategy::SpinThenPark(1000, 100));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(executor.ScheduleFor(
+        [&]() { count++; },
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks()));
+    // Lets the thread go idle between the tasks.
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  WaitUntil([&]() { return count == queue_cap; }, seconds(30));
+  EXPECT_EQ(count, queue_cap);
+
+  EXPECT_SUCCESS(executor.Stop());
+}
+
 class AffinityTest : public testing::TestWithParam<size_t> {
  protected:
   size_t GetCpu() const { return GetParam(); }
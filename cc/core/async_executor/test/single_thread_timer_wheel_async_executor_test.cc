@@ -0,0 +1,327 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/async_executor/src/single_thread_timer_wheel_async_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "core/async_executor/src/async_executor.h"
+#include "core/async_executor/src/error_codes.h"
+#include "core/async_executor/src/typedef.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
+#include "core/test/test_config.h"
+#include "core/test/utils/conditional_wait.h"
+#include "public/core/interface/execution_result.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::common::TimeProvider;
+using std::atomic;
+using std::function;
+using std::make_shared;
+using std::string;
+using std::chrono::duration_cast;
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
+using testing::Values;
+
+namespace google::scp::core::test {
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CannotInitWithTooBigQueueCap) {
+  SingleThreadTimerWheelAsyncExecutor executor(kMaxQueueCap + 1);
+  EXPECT_THAT(executor.Init(),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_INVALID_QUEUE_CAP)));
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CannotInitWithZeroTick) {
+  SingleThreadTimerWheelAsyncExecutor executor(10, false, std::nullopt,
+                                               nanoseconds(0));
+  EXPECT_THAT(executor.Init(),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_ASYNC_EXECUTOR_INVALID_TICK_DURATION)));
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, EmptyWorkQueue) {
+  SingleThreadTimerWheelAsyncExecutor executor(10);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CannotRunTwice) {
+  SingleThreadTimerWheelAsyncExecutor executor(10);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+  EXPECT_THAT(executor.Run(), ResultIs(FailureExecutionResult(
+                                  errors::SC_ASYNC_EXECUTOR_ALREADY_RUNNING)));
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CannotStopTwice) {
+  SingleThreadTimerWheelAsyncExecutor executor(10);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+  EXPECT_SUCCESS(executor.Stop());
+  EXPECT_THAT(
+      executor.Stop(),
+      ResultIs(FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CannotScheduleWorkBeforeRun) {
+  SingleThreadTimerWheelAsyncExecutor executor(10);
+  EXPECT_THAT(
+      executor.ScheduleFor([]() {}, 10000),
+      ResultIs(FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_THAT(
+      executor.ScheduleFor([]() {}, 1000),
+      ResultIs(FailureExecutionResult(errors::SC_ASYNC_EXECUTOR_NOT_RUNNING)));
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CannotRunBeforeInit) {
+  SingleThreadTimerWheelAsyncExecutor executor(10);
+  EXPECT_THAT(executor.Run(), ResultIs(FailureExecutionResult(
+                                  errors::SC_ASYNC_EXECUTOR_NOT_INITIALIZED)));
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, ExceedingQueueCapSchedule) {
+  int queue_cap = 1;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  AsyncTask task;
+  auto two_seconds = duration_cast<nanoseconds>(seconds(2)).count();
+
+  auto schedule_for_timestamp = task.GetExecutionTimestamp() + two_seconds;
+  EXPECT_SUCCESS(executor.ScheduleFor([&]() {}, schedule_for_timestamp));
+  auto result = executor.ScheduleFor([&]() {}, task.GetExecutionTimestamp());
+  EXPECT_THAT(result, ResultIs(RetryExecutionResult(
+                          errors::SC_ASYNC_EXECUTOR_EXCEEDING_QUEUE_CAP)));
+
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, CountWorkSingleThread) {
+  int queue_cap = 10;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(executor.ScheduleFor([&]() { count++; }, 123456));
+  }
+  // Waits some time to finish the work.
+  WaitUntil([&]() { return count == queue_cap; }, seconds(30));
+  EXPECT_EQ(count, queue_cap);
+
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, OrderedTasksExecution) {
+  int queue_cap = 10;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  AsyncTask task;
+  auto half_second = duration_cast<nanoseconds>(milliseconds(500)).count();
+  auto one_second = duration_cast<nanoseconds>(seconds(1)).count();
+  auto two_seconds = duration_cast<nanoseconds>(seconds(2)).count();
+
+  atomic<size_t> counter(0);
+  EXPECT_SUCCESS(
+      executor.ScheduleFor([&]() { EXPECT_EQ(counter++, 2); },
+                           task.GetExecutionTimestamp() + two_seconds));
+  EXPECT_SUCCESS(
+      executor.ScheduleFor([&]() { EXPECT_EQ(counter++, 1); },
+                           task.GetExecutionTimestamp() + one_second));
+  EXPECT_SUCCESS(
+      executor.ScheduleFor([&]() { EXPECT_EQ(counter++, 0); },
+                           task.GetExecutionTimestamp() + half_second));
+
+  WaitUntil([&]() { return counter == 3; }, seconds(30));
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, TasksAreNotExecutedEarly) {
+  int queue_cap = 100;
+  // A small tick makes the tasks span across several levels of the wheel.
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap, false, std::nullopt,
+                                               microseconds(10));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    Timestamp execution_timestamp =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() +
+         microseconds(137 * i))
+            .count();
+    EXPECT_SUCCESS(executor.ScheduleFor(
+        [&, execution_timestamp]() {
+          EXPECT_GE(TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks(),
+                    execution_timestamp);
+          count++;
+        },
+        execution_timestamp));
+  }
+
+  WaitUntil([&]() { return count == queue_cap; }, seconds(30));
+  EXPECT_EQ(count, queue_cap);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, FarTasksAreCascaded) {
+  int queue_cap = 10;
+  // With one microsecond ticks, these tasks land on the third level.
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap, false, std::nullopt,
+                                               microseconds(1));
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<size_t> counter(0);
+  auto now = TimeProvider::GetSteadyTimestampInNanoseconds();
+  EXPECT_SUCCESS(executor.ScheduleFor([&]() { EXPECT_EQ(counter++, 1); },
+                                      (now + milliseconds(150)).count()));
+  EXPECT_SUCCESS(executor.ScheduleFor([&]() { EXPECT_EQ(counter++, 0); },
+                                      (now + milliseconds(70)).count()));
+
+  WaitUntil([&]() { return counter == 2; }, seconds(30));
+  EXPECT_GE(TimeProvider::GetSteadyTimestampInNanoseconds(),
+            now + milliseconds(150));
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, EarlierTaskWakesUpWorker) {
+  int queue_cap = 10;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  function<bool()> cancellation_callback;
+  auto far_ahead_timestamp =
+      (TimeProvider::GetSteadyTimestampInNanoseconds() + hours(1)).count();
+  EXPECT_SUCCESS(executor.ScheduleFor([&]() {}, far_ahead_timestamp,
+                                      cancellation_callback));
+
+  atomic<bool> executed(false);
+  EXPECT_SUCCESS(executor.ScheduleFor([&]() { executed = true; }, 1234));
+  WaitUntil([&]() { return executed.load(); }, seconds(30));
+
+  EXPECT_EQ(cancellation_callback(), true);
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, FinishWorkWhenStopInMiddle) {
+  int queue_cap = 5;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  atomic<int> urgent_count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(executor.ScheduleFor(
+        [&]() {
+          urgent_count++;
+          std::this_thread::sleep_for(UNIT_TEST_SHORT_SLEEP_MS);
+        },
+        1234));
+  }
+  EXPECT_SUCCESS(executor.Stop());
+  EXPECT_EQ(urgent_count, queue_cap);
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, DropTasksOnStop) {
+  int queue_cap = 5;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap,
+                                               true /* drop tasks on stop */);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  for (int i = 0; i < queue_cap; i++) {
+    auto far_ahead_timestamp =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() + hours(24)).count();
+    EXPECT_SUCCESS(executor.ScheduleFor([&]() { EXPECT_EQ(true, false); },
+                                        far_ahead_timestamp));
+  }
+  // This should exit quickly and should not get stuck.
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests, TaskCancellation) {
+  int queue_cap = 3;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  for (int i = 0; i < queue_cap; i++) {
+    function<bool()> cancellation_callback;
+    Timestamp next_clock =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() + milliseconds(500))
+            .count();
+
+    EXPECT_SUCCESS(executor.ScheduleFor([&]() { EXPECT_EQ(true, false); },
+                                        next_clock, cancellation_callback));
+
+    EXPECT_EQ(cancellation_callback(), true);
+  }
+
+  // The cancelled tasks release their spot in the queue once their slot is
+  // visited.
+  std::this_thread::sleep_for(seconds(1));
+  atomic<int> count(0);
+  for (int i = 0; i < queue_cap; i++) {
+    EXPECT_SUCCESS(executor.ScheduleFor([&]() { count++; }, 1234));
+  }
+  WaitUntil([&]() { return count == queue_cap; }, seconds(30));
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+TEST(SingleThreadTimerWheelAsyncExecutorTests,
+     DuringStopDoNotWaitOnCancelledTaskExecutionTimeToArrive) {
+  int queue_cap = 3;
+  SingleThreadTimerWheelAsyncExecutor executor(queue_cap);
+  EXPECT_SUCCESS(executor.Init());
+  EXPECT_SUCCESS(executor.Run());
+
+  for (int i = 0; i < queue_cap; i++) {
+    function<bool()> cancellation_callback;
+    auto far_ahead_timestamp =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() + hours(24)).count();
+
+    EXPECT_SUCCESS(executor.ScheduleFor([&]() { EXPECT_EQ(true, false); },
+                                        far_ahead_timestamp,
+                                        cancellation_callback));
+
+    // Cancel the task
+    EXPECT_EQ(cancellation_callback(), true);
+  }
+  // This should exit quickly and should not get stuck.
+  EXPECT_SUCCESS(executor.Stop());
+}
+
+}  // namespace google::scp::core::test
@@ -18,21 +18,30 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "core/authorization_proxy/src/error_codes.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/http2_client/src/http2_client.h"
+#include "core/utils/src/hashing.h"
 
 using boost::system::error_code;
 using google::scp::core::common::AutoExpiryConcurrentMap;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
+using google::scp::core::utils::CalculateSha256Hash;
 using nghttp2::asio_http2::host_service_from_uri;
 using std::function;
 using std::make_shared;
 using std::make_unique;
 using std::move;
 using std::shared_ptr;
+using std::lock_guard;
+using std::mutex;
 using std::string;
+using std::vector;
 using std::placeholders::_1;
 using std::placeholders::_2;
 using std::placeholders::_3;
@@ -40,6 +49,11 @@ using std::placeholders::_3;
 static constexpr const char kAuthorizationProxy[] = "AuthorizationProxy";
 
 static constexpr int kAuthorizationCacheEntryLifetimeSeconds = 150;
+// The entries hit in their last seconds are authorized again in the
+// background before they expire.
+static constexpr int kAuthorizationCacheEntryRefreshAheadSeconds = 30;
+static constexpr size_t kAuthorizationCacheStripeCount = 16;
+static constexpr size_t kAuthorizationCacheMaxEntries = 100000;
 
 namespace google::scp::core {
 
@@ -81,10 +95,40 @@ AuthorizationProxy::AuthorizationProxy(
     : cache_(kAuthorizationCacheEntryLifetimeSeconds,
              false /* extend_entry_lifetime_on_access */,
              false /* block_entry_while_eviction */,
-             bind(&OnBeforeGarbageCollection, _1, _2, _3), async_executor),
+             bind(&OnBeforeGarbageCollection, _1, _2, _3), async_executor,
+             kAuthorizationCacheStripeCount, true /* index_expirations */),
       server_endpoint_uri_(make_shared<string>(server_endpoint_url)),
       http_client_(http_client),
-      http_helper_(move(http_helper)) {}
+      http_helper_(move(http_helper)) {
+  cache_.SetMemoryBudget(kAuthorizationCacheMaxEntries);
+}
+
+ExecutionResultOr<string> AuthorizationProxy::GetCacheEntryKey(
+    const AuthorizationMetadata& authorization_metadata) noexcept {
+  // The length prefix keeps the identity and the token apart.
+  return CalculateSha256Hash(
+      absl::StrCat(authorization_metadata.claimed_identity.size(), ":",
+                   authorization_metadata.claimed_identity,
+                   authorization_metadata.authorization_token));
+}
+
+ExecutionResultOr<shared_ptr<HttpRequest>>
+AuthorizationProxy::MakeAuthorizationRequest(
+    const AuthorizationMetadata& authorization_metadata) noexcept {
+  auto http_request = make_shared<HttpRequest>();
+  http_request->method = HttpMethod::POST;
+  http_request->path = server_endpoint_uri_;
+  http_request->headers = make_shared<HttpHeaders>();
+
+  auto execution_result =
+      http_helper_->PrepareRequest(authorization_metadata, *http_request);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kAuthorizationProxy, kZeroUuid, execution_result,
+              "Failed adding headers to request");
+    return FailureExecutionResult(errors::SC_AUTHORIZATION_PROXY_BAD_REQUEST);
+  }
+  return http_request;
+}
 
 ExecutionResult AuthorizationProxy::Authorize(
     AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>&
@@ -98,17 +142,20 @@ ExecutionResult AuthorizationProxy::Authorize(
     return FailureExecutionResult(errors::SC_AUTHORIZATION_PROXY_BAD_REQUEST);
   }
 
-  // Q: Is decoded token necessary here?
+  auto cache_entry_key = GetCacheEntryKey(request.authorization_metadata);
+  if (!cache_entry_key.Successful()) {
+    return FailureExecutionResult(errors::SC_AUTHORIZATION_PROXY_BAD_REQUEST);
+  }
+
   shared_ptr<CacheEntry> cache_entry_result;
-  // TODO Current map doesn't allow custom types i.e. AuthorizationMetadata
-  // to be part of key because there is a need to specialise std::hash template
-  // for AuthorizationMetadata, keeping string for now as the key.
-  auto key_value_pair = make_pair(request.authorization_metadata.GetKey(),
-                                  make_shared<CacheEntry>());
+  auto key_value_pair =
+      make_pair(move(*cache_entry_key), make_shared<CacheEntry>());
   auto execution_result = cache_.Insert(key_value_pair, cache_entry_result);
   if (!execution_result.Successful()) {
     if (execution_result.status_code ==
-        errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_ENTRY_BEING_DELETED) {
+            errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_ENTRY_BEING_DELETED ||
+        execution_result.status_code ==
+            errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED) {
       return RetryExecutionResult(execution_result.status_code);
     }
 
@@ -117,52 +164,74 @@ ExecutionResult AuthorizationProxy::Authorize(
       return execution_result;
     }
 
-    if (cache_entry_result->is_loaded) {
+    {
+      lock_guard<mutex> lock(cache_entry_result->lock);
+      if (cache_entry_result->is_abandoned) {
+        return RetryExecutionResult(
+            errors::SC_AUTHORIZATION_PROXY_AUTH_REQUEST_INPROGRESS);
+      }
+      if (!cache_entry_result->is_loaded) {
+        // Completed along with the request loading the entry.
+        cache_entry_result->waiting_contexts.push_back(authorization_context);
+        return SuccessExecutionResult();
+      }
       authorization_context.response =
           make_shared<AuthorizationProxyResponse>();
       authorization_context.response->authorized_metadata =
           cache_entry_result->authorized_metadata;
-      authorization_context.result = SuccessExecutionResult();
-      authorization_context.Finish();
-      return SuccessExecutionResult();
     }
 
-    return RetryExecutionResult(
-        errors::SC_AUTHORIZATION_PROXY_AUTH_REQUEST_INPROGRESS);
+    RefreshCacheEntryIfDue(authorization_context, key_value_pair.first,
+                           cache_entry_result);
+    authorization_context.result = SuccessExecutionResult();
+    authorization_context.Finish();
+    return SuccessExecutionResult();
   }
 
   // Cache entry was not present, inserted.
   execution_result = cache_.DisableEviction(key_value_pair.first);
   if (!execution_result.Successful()) {
-    cache_.Erase(key_value_pair.first);
-    return RetryExecutionResult(
+    auto result = RetryExecutionResult(
         errors::SC_AUTHORIZATION_PROXY_AUTH_REQUEST_INPROGRESS);
+    AbandonCacheEntry(key_value_pair.first, cache_entry_result, result);
+    return result;
   }
 
-  auto http_request = make_shared<HttpRequest>();
-  http_request->method = HttpMethod::POST;
-  http_request->path = server_endpoint_uri_;
-  http_request->headers = make_shared<HttpHeaders>();
+  // The remote request is only needed if the interceptor cannot authorize.
+  auto local_metadata_or =
+      http_helper_->AuthorizeLocally(request.authorization_metadata);
+  if (local_metadata_or.Successful()) {
+    CompleteCacheEntry(cache_entry_result, *local_metadata_or);
+    if (!cache_.EnableEviction(key_value_pair.first).Successful()) {
+      EraseCacheEntry(key_value_pair.first, cache_entry_result);
+    }
+    authorization_context.response = make_shared<AuthorizationProxyResponse>();
+    authorization_context.response->authorized_metadata =
+        move(*local_metadata_or);
+    authorization_context.result = SuccessExecutionResult();
+    authorization_context.Finish();
+    return SuccessExecutionResult();
+  }
 
-  execution_result = http_helper_->PrepareRequest(
-      request.authorization_metadata, *http_request);
-  if (!execution_result.Successful()) {
-    SCP_ERROR(kAuthorizationProxy, kZeroUuid, execution_result,
-              "Failed adding headers to request");
-    cache_.Erase(key_value_pair.first);
-    return FailureExecutionResult(errors::SC_AUTHORIZATION_PROXY_BAD_REQUEST);
+  auto http_request = MakeAuthorizationRequest(request.authorization_metadata);
+  if (!http_request.Successful()) {
+    AbandonCacheEntry(key_value_pair.first, cache_entry_result,
+                      http_request.result());
+    return http_request.result();
   }
 
   AsyncContext<HttpRequest, HttpResponse> http_context(
-      move(http_request),
+      move(*http_request),
       bind(&AuthorizationProxy::HandleAuthorizeResponse, this,
-           authorization_context, key_value_pair.first, _1),
+           authorization_context, key_value_pair.first, cache_entry_result,
+           _1),
       authorization_context);
   auto result = http_client_->PerformRequest(http_context);
   if (!result.Successful()) {
-    cache_.Erase(key_value_pair.first);
-    return RetryExecutionResult(
-        errors::SC_AUTHORIZATION_PROXY_REMOTE_UNAVAILABLE);
+    auto retry_result =
+        RetryExecutionResult(errors::SC_AUTHORIZATION_PROXY_REMOTE_UNAVAILABLE);
+    AbandonCacheEntry(key_value_pair.first, cache_entry_result, retry_result);
+    return retry_result;
   }
 
   return SuccessExecutionResult();
@@ -171,10 +240,10 @@ ExecutionResult AuthorizationProxy::Authorize(
 void AuthorizationProxy::HandleAuthorizeResponse(
     AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>&
         authorization_context,
-    std::string& cache_entry_key,
+    std::string& cache_entry_key, const shared_ptr<CacheEntry>& cache_entry,
     AsyncContext<HttpRequest, HttpResponse>& http_context) {
   if (!http_context.result.Successful()) {
-    cache_.Erase(cache_entry_key);
+    AbandonCacheEntry(cache_entry_key, cache_entry, http_context.result);
     // Bubbling client error up the stack
     authorization_context.result = http_context.result;
     authorization_context.Finish();
@@ -185,7 +254,7 @@ void AuthorizationProxy::HandleAuthorizeResponse(
       authorization_context.request->authorization_metadata,
       *(http_context.response));
   if (!metadata_or.Successful()) {
-    cache_.Erase(cache_entry_key);
+    AbandonCacheEntry(cache_entry_key, cache_entry, metadata_or.result());
     authorization_context.result = metadata_or.result();
     authorization_context.Finish();
     return;
@@ -194,26 +263,122 @@ void AuthorizationProxy::HandleAuthorizeResponse(
   authorization_context.response = make_shared<AuthorizationProxyResponse>();
   authorization_context.response->authorized_metadata = std::move(*metadata_or);
 
-  // Update cache entry
-  shared_ptr<CacheEntry> cache_entry;
-  auto execution_result = cache_.Find(cache_entry_key, cache_entry);
+  CompleteCacheEntry(cache_entry,
+                     authorization_context.response->authorized_metadata);
+  auto execution_result = cache_.EnableEviction(cache_entry_key);
   if (!execution_result.Successful()) {
-    SCP_DEBUG_CONTEXT(kAuthorizationProxy, authorization_context,
-                      "Cannot find the cached entry.");
-    authorization_context.result = SuccessExecutionResult();
-    authorization_context.Finish();
+    EraseCacheEntry(cache_entry_key, cache_entry);
   }
 
-  cache_entry->authorized_metadata =
-      authorization_context.response->authorized_metadata;
-  cache_entry->is_loaded = true;
+  authorization_context.result = SuccessExecutionResult();
+  authorization_context.Finish();
+}
 
-  execution_result = cache_.EnableEviction(cache_entry_key);
-  if (!execution_result.Successful()) {
+void AuthorizationProxy::EraseCacheEntry(
+    string& cache_entry_key, const shared_ptr<CacheEntry>& cache_entry) {
+  // The key may have been erased and loaded again since.
+  shared_ptr<CacheEntry> current_cache_entry;
+  if (cache_.Find(cache_entry_key, current_cache_entry).Successful() &&
+      current_cache_entry == cache_entry) {
     cache_.Erase(cache_entry_key);
   }
+}
 
-  authorization_context.result = SuccessExecutionResult();
-  authorization_context.Finish();
+void AuthorizationProxy::CompleteCacheEntry(
+    const shared_ptr<CacheEntry>& cache_entry,
+    const AuthorizedMetadata& authorized_metadata) {
+  vector<AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>>
+      waiting_contexts;
+  {
+    lock_guard<mutex> lock(cache_entry->lock);
+    cache_entry->authorized_metadata = authorized_metadata;
+    cache_entry->refresh_timestamp =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() +
+         std::chrono::seconds(kAuthorizationCacheEntryLifetimeSeconds -
+                              kAuthorizationCacheEntryRefreshAheadSeconds))
+            .count();
+    cache_entry->is_loaded = true;
+    waiting_contexts.swap(cache_entry->waiting_contexts);
+  }
+
+  for (auto& waiting_context : waiting_contexts) {
+    waiting_context.response = make_shared<AuthorizationProxyResponse>();
+    waiting_context.response->authorized_metadata = authorized_metadata;
+    waiting_context.result = SuccessExecutionResult();
+    waiting_context.Finish();
+  }
+}
+
+void AuthorizationProxy::AbandonCacheEntry(
+    string& cache_entry_key, const shared_ptr<CacheEntry>& cache_entry,
+    const ExecutionResult& execution_result) {
+  vector<AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>>
+      waiting_contexts;
+  {
+    // The requests finding the entry from now on retry instead of waiting.
+    lock_guard<mutex> lock(cache_entry->lock);
+    cache_entry->is_abandoned = true;
+    waiting_contexts.swap(cache_entry->waiting_contexts);
+  }
+  EraseCacheEntry(cache_entry_key, cache_entry);
+
+  for (auto& waiting_context : waiting_contexts) {
+    waiting_context.result = execution_result;
+    waiting_context.Finish();
+  }
+}
+
+void AuthorizationProxy::RefreshCacheEntryIfDue(
+    AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>&
+        authorization_context,
+    const string& cache_entry_key, const shared_ptr<CacheEntry>& cache_entry) {
+  if (TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() <
+          cache_entry->refresh_timestamp ||
+      cache_entry->is_refreshing.exchange(true)) {
+    return;
+  }
+
+  const auto& authorization_metadata =
+      authorization_context.request->authorization_metadata;
+  auto http_request = MakeAuthorizationRequest(authorization_metadata);
+  if (!http_request.Successful()) {
+    cache_entry->is_refreshing = false;
+    return;
+  }
+
+  AsyncContext<HttpRequest, HttpResponse> http_context(
+      move(*http_request),
+      bind(&AuthorizationProxy::HandleRefreshResponse, this,
+           authorization_metadata, cache_entry_key, cache_entry, _1),
+      authorization_context);
+  if (!http_client_->PerformRequest(http_context).Successful()) {
+    cache_entry->is_refreshing = false;
+  }
+}
+
+void AuthorizationProxy::HandleRefreshResponse(
+    const AuthorizationMetadata& authorization_metadata,
+    string& cache_entry_key, const shared_ptr<CacheEntry>& cache_entry,
+    AsyncContext<HttpRequest, HttpResponse>& http_context) {
+  if (!http_context.result.Successful()) {
+    // The entry is kept until it expires if the remote is only unavailable.
+    if (http_context.result.status != ExecutionStatus::Retry) {
+      EraseCacheEntry(cache_entry_key, cache_entry);
+    }
+    cache_entry->is_refreshing = false;
+    return;
+  }
+
+  auto metadata_or = http_helper_->ObtainAuthorizedMetadataFromResponse(
+      authorization_metadata, *(http_context.response));
+  if (!metadata_or.Successful()) {
+    EraseCacheEntry(cache_entry_key, cache_entry);
+    cache_entry->is_refreshing = false;
+    return;
+  }
+
+  CompleteCacheEntry(cache_entry, *metadata_or);
+  cache_.ExtendExpiration(cache_entry_key);
+  cache_entry->is_refreshing = false;
 }
 }  // namespace google::scp::core
@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "core/common/auto_expiry_concurrent_map/src/auto_expiry_concurrent_map.h"
 #include "core/interface/authorization_proxy_interface.h"
@@ -29,7 +32,20 @@ namespace google::scp::core {
 class AuthorizationProxy : public AuthorizationProxyInterface {
  public:
   struct CacheEntry : public LoadableObject {
+    /// Guards the fields below, which a refresh may update.
+    std::mutex lock;
     AuthorizedMetadata authorized_metadata;
+    /// The requests for the same key waiting for the entry to load.
+    std::vector<
+        AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>>
+        waiting_contexts;
+    /// Whether the entry failed to load and is being erased.
+    bool is_abandoned = false;
+    /// The steady time after which a hit refreshes the entry ahead of its
+    /// expiration.
+    std::atomic<Timestamp> refresh_timestamp = 0;
+    /// Whether a refresh of the entry is in flight.
+    std::atomic<bool> is_refreshing = false;
   };
 
   AuthorizationProxy(
@@ -55,12 +71,93 @@ class AuthorizationProxy : public AuthorizationProxyInterface {
    * @param authorization_context The authorization context to perform
    * operation on.
    * @param cache_entry_key key of the entry
+   * @param cache_entry the entry being loaded
    * @param http_context
    */
   void HandleAuthorizeResponse(
       AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>&
           authorization_context,
       std::string& cache_entry_key,
+      const std::shared_ptr<CacheEntry>& cache_entry,
+      AsyncContext<HttpRequest, HttpResponse>& http_context);
+
+  /**
+   * @brief Returns the key of the cache entry of the authorization metadata,
+   * a hash of fixed size instead of a copy of the token.
+   *
+   * @param authorization_metadata The metadata of the request.
+   * @return ExecutionResultOr<std::string> The key.
+   */
+  static ExecutionResultOr<std::string> GetCacheEntryKey(
+      const AuthorizationMetadata& authorization_metadata) noexcept;
+
+  /**
+   * @brief Makes the request to the remote authorizer.
+   *
+   * @param authorization_metadata The metadata to authorize.
+   * @return ExecutionResultOr<std::shared_ptr<HttpRequest>> The request.
+   */
+  ExecutionResultOr<std::shared_ptr<HttpRequest>> MakeAuthorizationRequest(
+      const AuthorizationMetadata& authorization_metadata) noexcept;
+
+  /**
+   * @brief Marks the entry loaded with the authorized metadata and finishes
+   * the requests waiting for it.
+   *
+   * @param cache_entry The entry loaded.
+   * @param authorized_metadata The authorized metadata of the entry.
+   */
+  void CompleteCacheEntry(const std::shared_ptr<CacheEntry>& cache_entry,
+                          const AuthorizedMetadata& authorized_metadata);
+
+  /**
+   * @brief Erases the entry that failed to load and fails the requests waiting
+   * for it with the execution result.
+   *
+   * @param cache_entry_key The key of the entry.
+   * @param cache_entry The entry.
+   * @param execution_result The failure to finish the waiting requests with.
+   */
+  void AbandonCacheEntry(std::string& cache_entry_key,
+                         const std::shared_ptr<CacheEntry>& cache_entry,
+                         const ExecutionResult& execution_result);
+
+  /**
+   * @brief Erases the entry, unless its key was erased and inserted again.
+   *
+   * @param cache_entry_key The key of the entry.
+   * @param cache_entry The entry.
+   */
+  void EraseCacheEntry(std::string& cache_entry_key,
+                       const std::shared_ptr<CacheEntry>& cache_entry);
+
+  /**
+   * @brief Authorizes the metadata of a hot entry again in the background if
+   * the entry is due for a refresh, so that it is extended before it expires
+   * instead of all its requests missing at once.
+   *
+   * @param authorization_context The context of the request hitting the entry.
+   * @param cache_entry_key The key of the entry.
+   * @param cache_entry The entry.
+   */
+  void RefreshCacheEntryIfDue(
+      AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>&
+          authorization_context,
+      const std::string& cache_entry_key,
+      const std::shared_ptr<CacheEntry>& cache_entry);
+
+  /**
+   * @brief The handler of the response of a refresh.
+   *
+   * @param authorization_metadata The metadata refreshed.
+   * @param cache_entry_key The key of the entry.
+   * @param cache_entry The entry.
+   * @param http_context The context of the remote request.
+   */
+  void HandleRefreshResponse(
+      const AuthorizationMetadata& authorization_metadata,
+      std::string& cache_entry_key,
+      const std::shared_ptr<CacheEntry>& cache_entry,
       AsyncContext<HttpRequest, HttpResponse>& http_context);
 
   /// The authorization token cache.
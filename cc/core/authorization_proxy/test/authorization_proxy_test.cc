@@ -46,6 +46,23 @@ class HttpRequestResponseAuthInterceptorMock
               (const AuthorizationMetadata&, const HttpResponse&), (override));
 };
 
+// Authorizes all the requests locally.
+class LocalHttpRequestResponseAuthInterceptorMock
+    : public HttpRequestResponseAuthInterceptorMock {
+ public:
+  explicit LocalHttpRequestResponseAuthInterceptorMock(
+      AuthorizedMetadata authorized_metadata)
+      : authorized_metadata_(std::move(authorized_metadata)) {}
+
+  ExecutionResultOr<AuthorizedMetadata> AuthorizeLocally(
+      const AuthorizationMetadata&) override {
+    return authorized_metadata_;
+  }
+
+ private:
+  AuthorizedMetadata authorized_metadata_;
+};
+
 class HttpClientMock : public HttpClientInterface {
  public:
   MOCK_METHOD(ExecutionResult, PerformRequest,
@@ -234,7 +251,7 @@ TEST_F(AuthorizationProxyTest,
   WaitUntil([&]() { return request_finished.load(); });
 }
 
-TEST_F(AuthorizationProxyTest, AuthorizeReturnsRetryIfRequestInProgress) {
+TEST_F(AuthorizationProxyTest, AuthorizeWaitsForTheRequestInProgress) {
   auto authorization_http_helper =
       std::make_unique<HttpRequestResponseAuthInterceptorMock>();
 
@@ -249,38 +266,40 @@ TEST_F(AuthorizationProxyTest, AuthorizeReturnsRetryIfRequestInProgress) {
   EXPECT_CALL(*authorization_http_helper_mock, PrepareRequest(_, _))
       .WillOnce(Return(SuccessExecutionResult()));
 
+  AsyncContext<HttpRequest, HttpResponse> http_context;
   EXPECT_CALL(*mock_http_client_, PerformRequest)
-      .WillOnce(Return(SuccessExecutionResult()));
-
-  AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>
-      authorization_request1;
-  authorization_request1.request = make_shared<AuthorizationProxyRequest>();
-  authorization_request1.request->authorization_metadata =
-      authorization_metadata_;
-
-  EXPECT_SUCCESS(proxy.Authorize(authorization_request1));
-
-  // Request attempt 2.
-  AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>
-      authorization_request2;
-  authorization_request2.request = make_shared<AuthorizationProxyRequest>();
-  authorization_request2.request->authorization_metadata =
-      authorization_metadata_;
+      .WillOnce([&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        http_context = context;
+        return SuccessExecutionResult();
+      });
 
-  EXPECT_THAT(proxy.Authorize(authorization_request2),
-              ResultIs(RetryExecutionResult(
-                  errors::SC_AUTHORIZATION_PROXY_AUTH_REQUEST_INPROGRESS)));
+  EXPECT_CALL(*authorization_http_helper_mock,
+              ObtainAuthorizedMetadataFromResponse(_, _))
+      .WillOnce(Return(
+          AuthorizedMetadata{authorized_metadata_.authorized_domain}));
 
-  // Request attempt 3.
-  AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>
-      authorization_request3;
-  authorization_request3.request = make_shared<AuthorizationProxyRequest>();
-  authorization_request3.request->authorization_metadata =
-      authorization_metadata_;
+  // All the requests complete with the one remote request.
+  std::atomic<int> requests_finished(0);
+  for (int i = 0; i < 3; i++) {
+    AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>
+        authorization_request;
+    authorization_request.request = make_shared<AuthorizationProxyRequest>();
+    authorization_request.request->authorization_metadata =
+        authorization_metadata_;
+    authorization_request.callback = [&](auto context) {
+      EXPECT_SUCCESS(context.result);
+      EXPECT_EQ(*context.response->authorized_metadata.authorized_domain,
+                *authorized_metadata_.authorized_domain);
+      requests_finished++;
+    };
+    EXPECT_SUCCESS(proxy.Authorize(authorization_request));
+  }
+  EXPECT_EQ(requests_finished.load(), 0);
 
-  EXPECT_THAT(proxy.Authorize(authorization_request3),
-              ResultIs(RetryExecutionResult(
-                  errors::SC_AUTHORIZATION_PROXY_AUTH_REQUEST_INPROGRESS)));
+  http_context.response = make_shared<HttpResponse>();
+  http_context.result = SuccessExecutionResult();
+  http_context.Finish();
+  WaitUntil([&]() { return requests_finished.load() == 3; });
 }
 
 TEST_F(AuthorizationProxyTest,
@@ -363,6 +382,36 @@ TEST_F(AuthorizationProxyTest,
   }
 }
 
+TEST_F(AuthorizationProxyTest, AuthorizeLocallyDoesNotIssueRemoteRequest) {
+  AuthorizationProxy proxy(
+      server_endpoint_, async_executor_, mock_http_client_,
+      std::make_unique<LocalHttpRequestResponseAuthInterceptorMock>(
+          authorized_metadata_));
+  EXPECT_SUCCESS(proxy.Init());
+  EXPECT_SUCCESS(proxy.Run());
+
+  EXPECT_CALL(*mock_http_client_, PerformRequest).Times(0);
+
+  // The locally authorized metadata is also cached.
+  for (int i = 0; i < 2; i++) {
+    std::atomic<bool> request_finished(false);
+    AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>
+        authorization_request;
+    authorization_request.request = make_shared<AuthorizationProxyRequest>();
+    authorization_request.request->authorization_metadata =
+        authorization_metadata_;
+    authorization_request.callback = [&](auto context) {
+      EXPECT_SUCCESS(context.result);
+      EXPECT_EQ(*context.response->authorized_metadata.authorized_domain,
+                *authorized_metadata_.authorized_domain);
+      request_finished = true;
+      return SuccessExecutionResult();
+    };
+    EXPECT_SUCCESS(proxy.Authorize(authorization_request));
+    WaitUntil([&]() { return request_finished.load(); });
+  }
+}
+
 TEST_F(AuthorizationProxyTest,
        AuthorizeReturnsFailureDuringParsingRemoteReponseDoesntCacheReponse) {
   auto authorization_http_helper =
@@ -435,4 +484,79 @@ TEST_F(AuthorizationProxyTest,
   }
 }
 
+class AuthorizationProxyPeer : public AuthorizationProxy {
+ public:
+  using AuthorizationProxy::AuthorizationProxy;
+
+  void MakeCacheEntryDueForRefresh(
+      const AuthorizationMetadata& authorization_metadata) {
+    shared_ptr<CacheEntry> cache_entry;
+    EXPECT_SUCCESS(
+        cache_.Find(*GetCacheEntryKey(authorization_metadata), cache_entry));
+    cache_entry->refresh_timestamp = 0;
+  }
+};
+
+TEST_F(AuthorizationProxyTest, AuthorizeRefreshesCacheEntryDueForRefresh) {
+  auto authorization_http_helper =
+      std::make_unique<HttpRequestResponseAuthInterceptorMock>();
+
+  HttpRequestResponseAuthInterceptorMock* authorization_http_helper_mock =
+      authorization_http_helper.get();
+
+  AuthorizationProxyPeer proxy(server_endpoint_, async_executor_,
+                               mock_http_client_,
+                               std::move(authorization_http_helper));
+  EXPECT_SUCCESS(proxy.Init());
+  EXPECT_SUCCESS(proxy.Run());
+
+  EXPECT_CALL(*authorization_http_helper_mock, PrepareRequest(_, _))
+      .Times(2)
+      .WillRepeatedly(Return(SuccessExecutionResult()));
+
+  EXPECT_CALL(*mock_http_client_, PerformRequest)
+      .Times(2)
+      .WillRepeatedly([](AsyncContext<HttpRequest, HttpResponse>& context) {
+        context.response = make_shared<HttpResponse>();
+        context.result = SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      });
+
+  auto refreshed_domain = make_shared<std::string>("refreshed.com");
+  EXPECT_CALL(*authorization_http_helper_mock,
+              ObtainAuthorizedMetadataFromResponse(_, _))
+      .WillOnce(
+          Return(AuthorizedMetadata{authorized_metadata_.authorized_domain}))
+      .WillOnce(Return(AuthorizedMetadata{refreshed_domain}));
+
+  auto authorize = [&]() {
+    std::atomic<bool> request_finished(false);
+    std::shared_ptr<AuthorizedDomain> authorized_domain;
+    AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>
+        authorization_request;
+    authorization_request.request = make_shared<AuthorizationProxyRequest>();
+    authorization_request.request->authorization_metadata =
+        authorization_metadata_;
+    authorization_request.callback = [&](auto context) {
+      EXPECT_SUCCESS(context.result);
+      authorized_domain =
+          context.response->authorized_metadata.authorized_domain;
+      request_finished = true;
+    };
+    EXPECT_SUCCESS(proxy.Authorize(authorization_request));
+    WaitUntil([&]() { return request_finished.load(); });
+    return *authorized_domain;
+  };
+
+  EXPECT_EQ(authorize(), *authorized_metadata_.authorized_domain);
+
+  // The hit is served from the cache and refreshes the entry.
+  proxy.MakeCacheEntryDueForRefresh(authorization_metadata_);
+  EXPECT_EQ(authorize(), *authorized_metadata_.authorized_domain);
+
+  // The entry is not due for a refresh anymore.
+  EXPECT_EQ(authorize(), *refreshed_domain);
+}
+
 }  // namespace google::scp::core::test
@@ -49,4 +49,29 @@ DEFINE_ERROR_CODE(SC_AUTHORIZATION_SERVICE_AUTH_TOKEN_IS_REFRESHING,
                   SC_AUTHORIZATION_SERVICE, 0x0006,
                   "The authentication token is being refreshed.",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_AUTHORIZATION_SERVICE_SIGNING_KEYS_UNAVAILABLE,
+                  SC_AUTHORIZATION_SERVICE, 0x0007,
+                  "The key the token is signed with is not fetched yet.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
+
+DEFINE_ERROR_CODE(SC_AUTHORIZATION_SERVICE_INVALID_SIGNING_KEYS,
+                  SC_AUTHORIZATION_SERVICE, 0x0008,
+                  "The token signing keys are malformed.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_AUTHORIZATION_SERVICE_INVALID_TOKEN_SIGNATURE,
+                  SC_AUTHORIZATION_SERVICE, 0x0009,
+                  "The signature of the token is invalid.",
+                  HttpStatusCode::FORBIDDEN)
+
+DEFINE_ERROR_CODE(SC_AUTHORIZATION_SERVICE_INVALID_TOKEN_CLAIMS,
+                  SC_AUTHORIZATION_SERVICE, 0x000A,
+                  "The issuer, audience or lifetime of the token is invalid.",
+                  HttpStatusCode::FORBIDDEN)
+
+DEFINE_ERROR_CODE(SC_AUTHORIZATION_SERVICE_LOCAL_AUTHORIZATION_UNAVAILABLE,
+                  SC_AUTHORIZATION_SERVICE, 0x000B,
+                  "The identity of the token was not authorized remotely yet.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
 }  // namespace google::scp::core::errors
@@ -245,12 +245,22 @@ void AwsS3Client::OnListObjectsCallback(
     list_blobs_context.response->blobs->push_back(blob);
   }
 
+  // S3 only returns the next marker of truncated listings with a delimiter,
+  // the last key is where the next page starts otherwise.
+  const auto& list_objects_result = list_objects_outcome.GetResult();
   Blob next_marker;
-  next_marker.blob_name = make_shared<string>(
-      list_objects_outcome.GetResult().GetNextMarker().c_str());
+  next_marker.blob_name =
+      make_shared<string>(list_objects_result.GetNextMarker().c_str());
+  if (next_marker.blob_name->empty() && list_objects_result.GetIsTruncated() &&
+      !list_blobs_context.response->blobs->empty()) {
+    next_marker.blob_name =
+        list_blobs_context.response->blobs->back().blob_name;
+  }
   next_marker.bucket_name = list_blobs_context.request->bucket_name;
   list_blobs_context.response->next_marker =
       make_shared<Blob>(move(next_marker));
+  list_blobs_context.response->is_last_page =
+      !list_objects_result.GetIsTruncated();
 
   list_blobs_context.result = SuccessExecutionResult();
   if (!async_executor_
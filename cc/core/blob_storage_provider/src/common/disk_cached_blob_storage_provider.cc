@@ -0,0 +1,369 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "disk_cached_blob_storage_provider.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/utils/src/hashing.h"
+
+#include "error_codes.h"
+
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::utils::CalculateSha256Hash;
+using std::bind;
+using std::error_code;
+using std::lock_guard;
+using std::make_shared;
+using std::move;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::filesystem::directory_iterator;
+using std::filesystem::file_time_type;
+using std::filesystem::path;
+using std::placeholders::_1;
+
+namespace {
+constexpr char kDiskCachedBlobStorageProvider[] =
+    "DiskCachedBlobStorageProvider";
+// The infix of the files being written.
+constexpr char kTempFileInfix[] = ".tmp";
+}  // namespace
+
+namespace google::scp::core::blob_storage_provider {
+ExecutionResult BlobDiskCache::Init() noexcept {
+  error_code error;
+  std::filesystem::create_directories(options_.directory, error);
+  if (error) {
+    auto execution_result = FailureExecutionResult(
+        errors::SC_BLOB_STORAGE_PROVIDER_DISK_CACHE_INIT_FAILED);
+    SCP_ERROR(kDiskCachedBlobStorageProvider, kZeroUuid, execution_result,
+              "Cannot create the blob disk cache directory %s: %s",
+              options_.directory.c_str(), error.message().c_str());
+    return execution_result;
+  }
+
+  struct File {
+    Entry entry;
+    file_time_type last_write_time;
+  };
+  vector<File> files;
+  for (directory_iterator it(options_.directory, error), end;
+       !error && it != end; it.increment(error)) {
+    error_code file_error;
+    if (!it->is_regular_file(file_error)) {
+      continue;
+    }
+    auto file_name = it->path().filename().string();
+    if (absl::StrContains(file_name, kTempFileInfix)) {
+      // Left over by a write interrupted by a crash.
+      std::filesystem::remove(it->path(), file_error);
+      continue;
+    }
+    File file;
+    file.entry.file_name = move(file_name);
+    file.entry.size_bytes = it->file_size(file_error);
+    if (!file_error) {
+      file.last_write_time = it->last_write_time(file_error);
+    }
+    if (!file_error) {
+      files.push_back(move(file));
+    }
+  }
+  if (error) {
+    auto execution_result = FailureExecutionResult(
+        errors::SC_BLOB_STORAGE_PROVIDER_DISK_CACHE_INIT_FAILED);
+    SCP_ERROR(kDiskCachedBlobStorageProvider, kZeroUuid, execution_result,
+              "Cannot list the blob disk cache directory %s: %s",
+              options_.directory.c_str(), error.message().c_str());
+    return execution_result;
+  }
+
+  std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+    return a.last_write_time > b.last_write_time;
+  });
+  lock_guard<mutex> lock(mutex_);
+  entries_.clear();
+  entries_by_file_name_.clear();
+  size_bytes_ = 0;
+  for (auto& file : files) {
+    size_bytes_ += file.entry.size_bytes;
+    entries_.push_back(move(file.entry));
+    entries_by_file_name_[entries_.back().file_name] =
+        std::prev(entries_.end());
+  }
+  EvictLocked();
+  SCP_INFO(kDiskCachedBlobStorageProvider, kZeroUuid,
+           "Blob disk cache %s has %zu blobs of %zu bytes.",
+           options_.directory.c_str(), entries_.size(), size_bytes_);
+  return SuccessExecutionResult();
+}
+
+bool BlobDiskCache::IsCacheable(const string& blob_name) const noexcept {
+  auto base_name_position = blob_name.rfind('/');
+  absl::string_view base_name(blob_name);
+  if (base_name_position != string::npos) {
+    base_name.remove_prefix(base_name_position + 1);
+  }
+  return std::any_of(options_.cacheable_blob_name_prefixes.begin(),
+                     options_.cacheable_blob_name_prefixes.end(),
+                     [&base_name](const string& prefix) {
+                       return absl::StartsWith(base_name, prefix);
+                     });
+}
+
+string BlobDiskCache::GetFileName(const string& bucket_name,
+                                  const string& blob_name) const noexcept {
+  // Bucket names cannot contain '/', so the key is unambiguous.
+  auto hash = CalculateSha256Hash(absl::StrCat(bucket_name, "/", blob_name));
+  if (!hash.Successful()) {
+    return "";
+  }
+  return absl::BytesToHexString(*hash);
+}
+
+shared_ptr<BytesBuffer> BlobDiskCache::Get(const string& bucket_name,
+                                           const string& blob_name) noexcept {
+  auto file_name = GetFileName(bucket_name, blob_name);
+  {
+    lock_guard<mutex> lock(mutex_);
+    auto entry = entries_by_file_name_.find(file_name);
+    if (file_name.empty() || entry == entries_by_file_name_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, entry->second);
+  }
+
+  // The file may be evicted concurrently, which fails the read.
+  auto file_path = path(options_.directory) / file_name;
+  std::ifstream input_stream(file_path, std::ios::binary | std::ios::ate);
+  auto buffer = make_shared<BytesBuffer>();
+  if (input_stream) {
+    size_t size = input_stream.tellg();
+    input_stream.seekg(0, std::ios::beg);
+    buffer->bytes->resize(size);
+    buffer->length = size;
+    buffer->capacity = size;
+    if (size == 0 ||
+        input_stream.read(reinterpret_cast<char*>(buffer->bytes->data()),
+                          size)) {
+      // Keeps the LRU order across restarts.
+      error_code error;
+      std::filesystem::last_write_time(file_path, file_time_type::clock::now(),
+                                       error);
+      return buffer;
+    }
+  }
+
+  lock_guard<mutex> lock(mutex_);
+  if (auto entry = entries_by_file_name_.find(file_name);
+      entry != entries_by_file_name_.end()) {
+    EraseLocked(entry->second);
+  }
+  return nullptr;
+}
+
+void BlobDiskCache::Put(const string& bucket_name, const string& blob_name,
+                        const BytesBuffer& buffer) noexcept {
+  auto file_name = GetFileName(bucket_name, blob_name);
+  if (file_name.empty() || buffer.length > options_.max_size_bytes) {
+    return;
+  }
+
+  auto file_path = path(options_.directory) / file_name;
+  auto temp_file_path =
+      path(options_.directory) /
+      absl::StrCat(file_name, kTempFileInfix, next_temp_file_id_.fetch_add(1));
+  error_code error;
+  {
+    std::ofstream output_stream(temp_file_path,
+                                std::ios::binary | std::ios::trunc);
+    if (buffer.length > 0) {
+      output_stream.write(reinterpret_cast<const char*>(buffer.bytes->data()),
+                          buffer.length);
+    }
+    output_stream.close();
+    if (!output_stream) {
+      error = std::make_error_code(std::errc::io_error);
+    }
+  }
+  if (!error) {
+    std::filesystem::rename(temp_file_path, file_path, error);
+  }
+  if (error) {
+    SCP_WARNING(kDiskCachedBlobStorageProvider, kZeroUuid,
+                "Cannot cache blob %s/%s: %s", bucket_name.c_str(),
+                blob_name.c_str(), error.message().c_str());
+    std::filesystem::remove(temp_file_path, error);
+    return;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+  if (auto entry = entries_by_file_name_.find(file_name);
+      entry != entries_by_file_name_.end()) {
+    // Replaced by the rename, only the entry is dropped.
+    size_bytes_ -= entry->second->size_bytes;
+    entries_.erase(entry->second);
+    entries_by_file_name_.erase(entry);
+  }
+  entries_.push_front(Entry{file_name, buffer.length});
+  entries_by_file_name_[file_name] = entries_.begin();
+  size_bytes_ += buffer.length;
+  EvictLocked();
+}
+
+void BlobDiskCache::Erase(const string& bucket_name,
+                          const string& blob_name) noexcept {
+  auto file_name = GetFileName(bucket_name, blob_name);
+  lock_guard<mutex> lock(mutex_);
+  if (auto entry = entries_by_file_name_.find(file_name);
+      entry != entries_by_file_name_.end()) {
+    EraseLocked(entry->second);
+  }
+}
+
+size_t BlobDiskCache::GetSizeBytes() noexcept {
+  lock_guard<mutex> lock(mutex_);
+  return size_bytes_;
+}
+
+void BlobDiskCache::EraseLocked(std::list<Entry>::iterator entry) noexcept {
+  error_code error;
+  std::filesystem::remove(path(options_.directory) / entry->file_name, error);
+  size_bytes_ -= entry->size_bytes;
+  entries_by_file_name_.erase(entry->file_name);
+  entries_.erase(entry);
+}
+
+void BlobDiskCache::EvictLocked() noexcept {
+  while (size_bytes_ > options_.max_size_bytes && !entries_.empty()) {
+    EraseLocked(std::prev(entries_.end()));
+  }
+}
+
+ExecutionResult DiskCachedBlobStorageClient::GetBlob(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) noexcept {
+  const auto& request = get_blob_context.request;
+  if (!request || !request->bucket_name || !request->blob_name ||
+      !disk_cache_->IsCacheable(*request->blob_name)) {
+    return blob_storage_client_->GetBlob(get_blob_context);
+  }
+
+  if (auto buffer =
+          disk_cache_->Get(*request->bucket_name, *request->blob_name)) {
+    get_blob_context.response = make_shared<GetBlobResponse>();
+    get_blob_context.response->buffer = move(buffer);
+    get_blob_context.result = SuccessExecutionResult();
+    get_blob_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  AsyncContext<GetBlobRequest, GetBlobResponse> cloud_get_blob_context(
+      request,
+      bind(&DiskCachedBlobStorageClient::OnGetBlobCallback, this,
+           get_blob_context, _1),
+      get_blob_context);
+  return blob_storage_client_->GetBlob(cloud_get_blob_context);
+}
+
+void DiskCachedBlobStorageClient::OnGetBlobCallback(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    AsyncContext<GetBlobRequest, GetBlobResponse>&
+        cloud_get_blob_context) noexcept {
+  if (cloud_get_blob_context.result.Successful() &&
+      cloud_get_blob_context.response &&
+      cloud_get_blob_context.response->buffer) {
+    disk_cache_->Put(*get_blob_context.request->bucket_name,
+                     *get_blob_context.request->blob_name,
+                     *cloud_get_blob_context.response->buffer);
+  }
+  get_blob_context.response = cloud_get_blob_context.response;
+  get_blob_context.result = cloud_get_blob_context.result;
+  get_blob_context.Finish();
+}
+
+ExecutionResult DiskCachedBlobStorageClient::ListBlobs(
+    AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+        list_blobs_context) noexcept {
+  return blob_storage_client_->ListBlobs(list_blobs_context);
+}
+
+ExecutionResult DiskCachedBlobStorageClient::PutBlob(
+    AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) noexcept {
+  const auto& request = put_blob_context.request;
+  if (request && request->bucket_name && request->blob_name) {
+    disk_cache_->Erase(*request->bucket_name, *request->blob_name);
+  }
+  return blob_storage_client_->PutBlob(put_blob_context);
+}
+
+ExecutionResult DiskCachedBlobStorageClient::DeleteBlob(
+    AsyncContext<DeleteBlobRequest, DeleteBlobResponse>&
+        delete_blob_context) noexcept {
+  const auto& request = delete_blob_context.request;
+  if (request && request->bucket_name && request->blob_name) {
+    disk_cache_->Erase(*request->bucket_name, *request->blob_name);
+  }
+  return blob_storage_client_->DeleteBlob(delete_blob_context);
+}
+
+ExecutionResult DiskCachedBlobStorageProvider::Init() noexcept {
+  auto execution_result = blob_storage_provider_->Init();
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  return disk_cache_->Init();
+}
+
+ExecutionResult DiskCachedBlobStorageProvider::Run() noexcept {
+  return blob_storage_provider_->Run();
+}
+
+ExecutionResult DiskCachedBlobStorageProvider::Stop() noexcept {
+  return blob_storage_provider_->Stop();
+}
+
+ExecutionResult DiskCachedBlobStorageProvider::CreateBlobStorageClient(
+    shared_ptr<BlobStorageClientInterface>& blob_storage_client) noexcept {
+  shared_ptr<BlobStorageClientInterface> cloud_blob_storage_client;
+  auto execution_result = blob_storage_provider_->CreateBlobStorageClient(
+      cloud_blob_storage_client);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  blob_storage_client = make_shared<DiskCachedBlobStorageClient>(
+      cloud_blob_storage_client, disk_cache_);
+  return SuccessExecutionResult();
+}
+}  // namespace google::scp::core::blob_storage_provider
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/interface/blob_storage_provider_interface.h"
+
+namespace google::scp::core::blob_storage_provider {
+struct BlobDiskCacheOptions {
+  /// The directory the cached blobs are stored in. It is created if missing.
+  std::string directory;
+  /// The max total size of the cached blobs. The least recently used blobs
+  /// are evicted past it.
+  size_t max_size_bytes = 1ULL << 30;
+  /// Only the blobs whose base name, i.e. the part past the last '/', starts
+  /// with one of these prefixes are cached. These blobs must not be
+  /// overwritten once written, as the cache does not revalidate its entries.
+  std::vector<std::string> cacheable_blob_name_prefixes;
+};
+
+/**
+ * @brief Keeps copies of immutable blobs in a local directory, with a bound
+ * on their total size and LRU eviction.
+ *
+ * Each blob is stored in a file named after the SHA-256 of its bucket and blob
+ * name. The files are written under a temporary name and renamed once
+ * complete, so that the directory is always consistent. Init() rebuilds the
+ * LRU order out of the modification times of the files, which the reads
+ * update, so the cache survives restarts.
+ */
+class BlobDiskCache {
+ public:
+  explicit BlobDiskCache(BlobDiskCacheOptions options)
+      : options_(std::move(options)), size_bytes_(0), next_temp_file_id_(0) {}
+
+  /**
+   * @brief Creates the directory if missing, and indexes the blobs already in
+   * it.
+   *
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Init() noexcept;
+
+  /// Whether the blob is eligible to the cache.
+  bool IsCacheable(const std::string& blob_name) const noexcept;
+
+  /**
+   * @brief Reads a cached blob.
+   *
+   * @return std::shared_ptr<BytesBuffer> The contents of the blob, nullptr if
+   * it is not cached.
+   */
+  std::shared_ptr<BytesBuffer> Get(const std::string& bucket_name,
+                                   const std::string& blob_name) noexcept;
+
+  /// Caches the contents of a blob. A failure to write is only logged.
+  void Put(const std::string& bucket_name, const std::string& blob_name,
+           const BytesBuffer& buffer) noexcept;
+
+  /// Drops a blob from the cache, if cached.
+  void Erase(const std::string& bucket_name,
+             const std::string& blob_name) noexcept;
+
+  /// The total size of the cached blobs.
+  size_t GetSizeBytes() noexcept;
+
+ private:
+  struct Entry {
+    std::string file_name;
+    size_t size_bytes = 0;
+  };
+
+  /// The name of the file of the blob.
+  std::string GetFileName(const std::string& bucket_name,
+                          const std::string& blob_name) const noexcept;
+
+  /// Removes the entry and its file. Must be called with mutex_ held.
+  void EraseLocked(std::list<Entry>::iterator entry) noexcept;
+
+  /// Evicts the least recently used blobs until the size fits. Must be called
+  /// with mutex_ held.
+  void EvictLocked() noexcept;
+
+  const BlobDiskCacheOptions options_;
+  std::mutex mutex_;
+  /// The cached blobs, the most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator>
+      entries_by_file_name_;
+  size_t size_bytes_;
+  /// Makes the temporary file names of concurrent writes unique.
+  std::atomic<uint64_t> next_temp_file_id_;
+};
+
+/**
+ * @brief Serves the reads of the cacheable blobs out of a BlobDiskCache, and
+ * forwards everything else to the wrapped client. The blobs read from the
+ * wrapped client are added to the cache, and the ones written or deleted
+ * through this client are dropped from it.
+ */
+class DiskCachedBlobStorageClient : public BlobStorageClientInterface {
+ public:
+  DiskCachedBlobStorageClient(
+      const std::shared_ptr<BlobStorageClientInterface>& blob_storage_client,
+      const std::shared_ptr<BlobDiskCache>& disk_cache)
+      : blob_storage_client_(blob_storage_client), disk_cache_(disk_cache) {}
+
+  ExecutionResult GetBlob(AsyncContext<GetBlobRequest, GetBlobResponse>&
+                              get_blob_context) noexcept override;
+
+  ExecutionResult ListBlobs(AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+                                list_blobs_context) noexcept override;
+
+  ExecutionResult PutBlob(AsyncContext<PutBlobRequest, PutBlobResponse>&
+                              put_blob_context) noexcept override;
+
+  ExecutionResult DeleteBlob(
+      AsyncContext<DeleteBlobRequest, DeleteBlobResponse>&
+          delete_blob_context) noexcept override;
+
+ protected:
+  /**
+   * @brief Is called when the wrapped client completes a cache miss.
+   *
+   * @param get_blob_context The context of the caller.
+   * @param cloud_get_blob_context The context sent to the wrapped client.
+   */
+  void OnGetBlobCallback(
+      AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+      AsyncContext<GetBlobRequest, GetBlobResponse>&
+          cloud_get_blob_context) noexcept;
+
+  std::shared_ptr<BlobStorageClientInterface> blob_storage_client_;
+  std::shared_ptr<BlobDiskCache> disk_cache_;
+};
+
+/**
+ * @brief Wraps the clients of another provider into DiskCachedBlobStorageClient
+ * instances sharing the same cache. The lifecycle of the wrapped provider is
+ * driven by this one.
+ */
+class DiskCachedBlobStorageProvider : public BlobStorageProviderInterface {
+ public:
+  DiskCachedBlobStorageProvider(
+      const std::shared_ptr<BlobStorageProviderInterface>&
+          blob_storage_provider,
+      const std::shared_ptr<BlobDiskCache>& disk_cache)
+      : blob_storage_provider_(blob_storage_provider),
+        disk_cache_(disk_cache) {}
+
+  ExecutionResult Init() noexcept override;
+
+  ExecutionResult Run() noexcept override;
+
+  ExecutionResult Stop() noexcept override;
+
+  ExecutionResult CreateBlobStorageClient(
+      std::shared_ptr<BlobStorageClientInterface>& blob_storage_client) noexcept
+      override;
+
+ private:
+  std::shared_ptr<BlobStorageProviderInterface> blob_storage_provider_;
+  std::shared_ptr<BlobDiskCache> disk_cache_;
+};
+}  // namespace google::scp::core::blob_storage_provider
@@ -48,4 +48,9 @@ DEFINE_ERROR_CODE(SC_BLOB_STORAGE_PROVIDER_INVALID_ARGS,
                   SC_BLOB_STORAGE_PROVIDER, 0x0005,
                   "Invalid arguments provided.", HttpStatusCode::NOT_FOUND)
 
+DEFINE_ERROR_CODE(SC_BLOB_STORAGE_PROVIDER_DISK_CACHE_INIT_FAILED,
+                  SC_BLOB_STORAGE_PROVIDER, 0x0006,
+                  "The directory of the blob disk cache cannot be used.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
 }  // namespace google::scp::core::errors
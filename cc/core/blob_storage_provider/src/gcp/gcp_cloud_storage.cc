@@ -306,6 +306,9 @@ void GcpCloudStorageClient::ListBlobAsync(
       break;
     }
   }
+  // The iterator ran out of objects otherwise.
+  list_blobs_context.response->is_last_page =
+      list_blobs_context.response->next_marker == nullptr;
   FinishContext(SuccessExecutionResult(), list_blobs_context, async_executor_,
                 async_execution_priority_);
 }
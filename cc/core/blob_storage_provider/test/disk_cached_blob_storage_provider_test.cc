@@ -0,0 +1,194 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "core/blob_storage_provider/src/common/disk_cached_blob_storage_provider.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "core/blob_storage_provider/mock/mock_blob_storage_provider.h"
+#include "core/blob_storage_provider/src/common/error_codes.h"
+#include "core/common/uuid/src/uuid.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::blob_storage_provider::mock::MockBlobStorageClient;
+using google::scp::core::common::ToString;
+using google::scp::core::common::Uuid;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+
+namespace google::scp::core::blob_storage_provider::test {
+namespace {
+constexpr char kBucketName[] = "bucket";
+
+class DiskCachedBlobStorageProviderTest : public testing::Test {
+ protected:
+  DiskCachedBlobStorageProviderTest()
+      : mock_blob_storage_client_(make_shared<MockBlobStorageClient>()),
+        cloud_get_blob_count_(0) {
+    options_.directory =
+        (std::filesystem::temp_directory_path() /
+         ("blob_disk_cache_" + ToString(Uuid::GenerateUuid())))
+            .string();
+    options_.cacheable_blob_name_prefixes = {"journal_", "checkpoint_"};
+    mock_blob_storage_client_->get_blob_mock = [this](auto& get_blob_context) {
+      cloud_get_blob_count_++;
+      get_blob_context.response = make_shared<GetBlobResponse>();
+      get_blob_context.response->buffer = make_shared<BytesBuffer>(
+          "contents of " + *get_blob_context.request->blob_name);
+      get_blob_context.result = SuccessExecutionResult();
+      get_blob_context.Finish();
+      return SuccessExecutionResult();
+    };
+  }
+
+  ~DiskCachedBlobStorageProviderTest() {
+    std::filesystem::remove_all(options_.directory);
+  }
+
+  shared_ptr<DiskCachedBlobStorageClient> CreateClient() {
+    disk_cache_ = make_shared<BlobDiskCache>(options_);
+    EXPECT_SUCCESS(disk_cache_->Init());
+    return make_shared<DiskCachedBlobStorageClient>(mock_blob_storage_client_,
+                                                    disk_cache_);
+  }
+
+  /// Reads the blob and returns its contents, or "" on failure.
+  string GetBlob(BlobStorageClientInterface& client, const string& blob_name) {
+    string contents;
+    AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context;
+    get_blob_context.request = make_shared<GetBlobRequest>();
+    get_blob_context.request->bucket_name = make_shared<string>(kBucketName);
+    get_blob_context.request->blob_name = make_shared<string>(blob_name);
+    get_blob_context.callback = [&contents](auto& context) {
+      if (context.result.Successful()) {
+        const auto& buffer = *context.response->buffer;
+        contents.assign(buffer.bytes->begin(),
+                        buffer.bytes->begin() + buffer.length);
+      }
+    };
+    EXPECT_SUCCESS(client.GetBlob(get_blob_context));
+    return contents;
+  }
+
+  BlobDiskCacheOptions options_;
+  shared_ptr<MockBlobStorageClient> mock_blob_storage_client_;
+  shared_ptr<BlobDiskCache> disk_cache_;
+  std::atomic<size_t> cloud_get_blob_count_;
+};
+
+TEST_F(DiskCachedBlobStorageProviderTest, ServesRepeatedReadsFromDisk) {
+  auto client = CreateClient();
+
+  EXPECT_EQ(GetBlob(*client, "partition/journal_01"),
+            "contents of partition/journal_01");
+  EXPECT_EQ(GetBlob(*client, "partition/journal_01"),
+            "contents of partition/journal_01");
+  EXPECT_EQ(cloud_get_blob_count_, 1);
+}
+
+TEST_F(DiskCachedBlobStorageProviderTest, DoesNotCacheOtherBlobs) {
+  auto client = CreateClient();
+
+  GetBlob(*client, "partition/last_checkpoint");
+  GetBlob(*client, "partition/last_checkpoint");
+  EXPECT_EQ(cloud_get_blob_count_, 2);
+  EXPECT_EQ(disk_cache_->GetSizeBytes(), 0);
+}
+
+TEST_F(DiskCachedBlobStorageProviderTest, DoesNotCacheFailedReads) {
+  auto client = CreateClient();
+  mock_blob_storage_client_->get_blob_mock = [this](auto& get_blob_context) {
+    cloud_get_blob_count_++;
+    get_blob_context.result = FailureExecutionResult(
+        errors::SC_BLOB_STORAGE_PROVIDER_BLOB_PATH_NOT_FOUND);
+    get_blob_context.Finish();
+    return SuccessExecutionResult();
+  };
+
+  EXPECT_EQ(GetBlob(*client, "partition/journal_01"), "");
+  EXPECT_EQ(GetBlob(*client, "partition/journal_01"), "");
+  EXPECT_EQ(cloud_get_blob_count_, 2);
+}
+
+TEST_F(DiskCachedBlobStorageProviderTest, KeepsBlobsAcrossRestarts) {
+  GetBlob(*CreateClient(), "partition/checkpoint_01");
+
+  auto client = CreateClient();
+  EXPECT_EQ(GetBlob(*client, "partition/checkpoint_01"),
+            "contents of partition/checkpoint_01");
+  EXPECT_EQ(cloud_get_blob_count_, 1);
+}
+
+TEST_F(DiskCachedBlobStorageProviderTest, EvictsLeastRecentlyUsedBlobs) {
+  // Fits two of the blobs below.
+  options_.max_size_bytes = 2 * string("contents of journal_01").size();
+  auto client = CreateClient();
+
+  GetBlob(*client, "journal_01");
+  GetBlob(*client, "journal_02");
+  // Makes journal_02 the least recently used one.
+  GetBlob(*client, "journal_01");
+  GetBlob(*client, "journal_03");
+  EXPECT_EQ(cloud_get_blob_count_, 3);
+  EXPECT_EQ(disk_cache_->GetSizeBytes(), options_.max_size_bytes);
+
+  GetBlob(*client, "journal_01");
+  GetBlob(*client, "journal_03");
+  EXPECT_EQ(cloud_get_blob_count_, 3);
+  GetBlob(*client, "journal_02");
+  EXPECT_EQ(cloud_get_blob_count_, 4);
+}
+
+TEST_F(DiskCachedBlobStorageProviderTest, DropsBlobsWrittenOrDeleted) {
+  auto client = CreateClient();
+  mock_blob_storage_client_->put_blob_mock = [](auto& put_blob_context) {
+    put_blob_context.result = SuccessExecutionResult();
+    put_blob_context.Finish();
+    return SuccessExecutionResult();
+  };
+  mock_blob_storage_client_->delete_blob_mock = [](auto& delete_blob_context) {
+    delete_blob_context.result = SuccessExecutionResult();
+    delete_blob_context.Finish();
+    return SuccessExecutionResult();
+  };
+
+  GetBlob(*client, "journal_01");
+  AsyncContext<PutBlobRequest, PutBlobResponse> put_blob_context;
+  put_blob_context.request = make_shared<PutBlobRequest>();
+  put_blob_context.request->bucket_name = make_shared<string>(kBucketName);
+  put_blob_context.request->blob_name = make_shared<string>("journal_01");
+  put_blob_context.request->buffer = make_shared<BytesBuffer>("new contents");
+  EXPECT_SUCCESS(client->PutBlob(put_blob_context));
+  GetBlob(*client, "journal_01");
+  EXPECT_EQ(cloud_get_blob_count_, 2);
+
+  AsyncContext<DeleteBlobRequest, DeleteBlobResponse> delete_blob_context;
+  delete_blob_context.request = make_shared<DeleteBlobRequest>();
+  delete_blob_context.request->bucket_name = make_shared<string>(kBucketName);
+  delete_blob_context.request->blob_name = make_shared<string>("journal_01");
+  EXPECT_SUCCESS(client->DeleteBlob(delete_blob_context));
+  GetBlob(*client, "journal_01");
+  EXPECT_EQ(cloud_get_blob_count_, 3);
+}
+}  // namespace
+}  // namespace google::scp::core::blob_storage_provider::test
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
+
+namespace google::scp::core::common {
+/**
+ * @brief Constructs the context of a sub operation of parent_context, so that
+ * a chain of async operations reads as a sequence of steps instead of a set of
+ * bound member callbacks.
+ *
+ * When the sub operation fails, its result is propagated to the parent context
+ * which is then finished. Otherwise on_success is called with the parent and
+ * the sub operation contexts, and it is responsible for continuing the chain or
+ * finishing the parent.
+ *
+ * @tparam TResponse the response type of the sub operation.
+ * @param parent_context the context of the operation being carried out.
+ * @param request the request of the sub operation.
+ * @param on_success the next step, invocable with
+ * (AsyncContext<TParentRequest, TParentResponse>&,
+ *  AsyncContext<TRequest, TResponse>&).
+ * @return AsyncContext<TRequest, TResponse> the context to hand to the
+ * sub operation.
+ */
+template <typename TResponse, typename TRequest, typename TParentRequest,
+          typename TParentResponse, typename OnSuccess>
+AsyncContext<TRequest, TResponse> ChainAsyncContext(
+    const AsyncContext<TParentRequest, TParentResponse>& parent_context,
+    const std::shared_ptr<TRequest>& request, OnSuccess&& on_success) {
+  return AsyncContext<TRequest, TResponse>(
+      request,
+      [parent_context = parent_context,
+       on_success = std::forward<OnSuccess>(on_success)](
+          AsyncContext<TRequest, TResponse>& context) mutable {
+        if (!context.result.Successful()) {
+          FinishContext(context.result, parent_context);
+          return;
+        }
+        on_success(parent_context, context);
+      },
+      parent_context);
+}
+
+/**
+ * @brief Wraps a callback so that it runs on the given executor instead of the
+ * thread completing the operation, such as an IO thread. The executor is asked
+ * to keep the callback on the calling executor thread if the completion
+ * already happens on one, which saves a hop between threads. If the callback
+ * cannot be scheduled, it runs on the completing thread.
+ *
+ * @param async_executor the executor to resume on.
+ * @param callback the callback to wrap. Its arguments are copied, which for
+ * async contexts only copies their shared state pointers.
+ * @param priority the priority to resume with.
+ * @return a callback invocable with the same arguments.
+ */
+template <typename Callback>
+auto ResumeOnExecutor(
+    const std::shared_ptr<AsyncExecutorInterface>& async_executor,
+    Callback&& callback, AsyncPriority priority = AsyncPriority::High) {
+  return [async_executor, callback = std::forward<Callback>(callback),
+          priority](auto&... args) mutable {
+    auto execution_result = async_executor->Schedule(
+        [callback, args...]() mutable { callback(args...); }, priority,
+        AsyncExecutorAffinitySetting::AffinitizedToCallingAsyncExecutor);
+    if (!execution_result.Successful()) {
+      callback(args...);
+    }
+  };
+}
+}  // namespace google::scp::core::common
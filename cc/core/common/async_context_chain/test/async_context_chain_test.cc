@@ -0,0 +1,159 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/common/async_context_chain/src/async_context_chain.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "core/async_executor/mock/mock_async_executor.h"
+#include "core/interface/async_context.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::AsyncExecutorInterface;
+using google::scp::core::AsyncOperation;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::common::ChainAsyncContext;
+using google::scp::core::common::ResumeOnExecutor;
+using google::scp::core::test::ResultIs;
+using std::function;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+
+namespace google::scp::core::common::test {
+TEST(AsyncContextChainTest, ChildKeepsTheParentIds) {
+  AsyncContext<string, string> parent_context;
+  parent_context.parent_activity_id = Uuid::GenerateUuid();
+  parent_context.correlation_id = Uuid::GenerateUuid();
+
+  auto child_context = ChainAsyncContext<int>(
+      parent_context, make_shared<int>(1),
+      [](AsyncContext<string, string>&, AsyncContext<int, int>&) {});
+
+  EXPECT_EQ(*child_context.request, 1);
+  EXPECT_EQ(child_context.parent_activity_id, parent_context.activity_id);
+  EXPECT_EQ(child_context.correlation_id, parent_context.correlation_id);
+}
+
+TEST(AsyncContextChainTest, FailurePropagatesToTheParent) {
+  size_t parent_callback_count = 0;
+  bool on_success_called = false;
+  AsyncContext<string, string> parent_context(
+      make_shared<string>("request"),
+      [&](AsyncContext<string, string>& context) {
+        EXPECT_THAT(context.result, ResultIs(FailureExecutionResult(1234)));
+        parent_callback_count++;
+      });
+
+  auto child_context = ChainAsyncContext<int>(
+      parent_context, make_shared<int>(1),
+      [&](AsyncContext<string, string>&, AsyncContext<int, int>&) {
+        on_success_called = true;
+      });
+  child_context.result = FailureExecutionResult(1234);
+  child_context.Finish();
+
+  EXPECT_EQ(parent_callback_count, 1);
+  EXPECT_FALSE(on_success_called);
+}
+
+TEST(AsyncContextChainTest, SuccessContinuesTheChain) {
+  size_t parent_callback_count = 0;
+  AsyncContext<string, string> parent_context(
+      make_shared<string>("request"),
+      [&](AsyncContext<string, string>& context) {
+        EXPECT_SUCCESS(context.result);
+        EXPECT_EQ(*context.response, "response 2");
+        parent_callback_count++;
+      });
+
+  auto child_context = ChainAsyncContext<int>(
+      parent_context, make_shared<int>(1),
+      [](AsyncContext<string, string>& parent_context,
+         AsyncContext<int, int>& child_context) {
+        parent_context.response = make_shared<string>(
+            "response " + std::to_string(*child_context.response));
+        FinishContext(SuccessExecutionResult(), parent_context);
+      });
+  child_context.response = make_shared<int>(2);
+  child_context.result = SuccessExecutionResult();
+  child_context.Finish();
+
+  EXPECT_EQ(parent_callback_count, 1);
+}
+
+TEST(AsyncContextChainTest, ResumeOnExecutorSchedulesTheCallback) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  size_t schedule_count = 0;
+  mock_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    schedule_count++;
+    work();
+    return SuccessExecutionResult();
+  };
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+
+  size_t callback_count = 0;
+  AsyncContext<string, string> context(
+      make_shared<string>("request"),
+      ResumeOnExecutor(async_executor,
+                       [&](AsyncContext<string, string>& context) {
+                         EXPECT_EQ(*context.request, "request");
+                         callback_count++;
+                       }));
+  context.result = SuccessExecutionResult();
+  context.Finish();
+
+  EXPECT_EQ(schedule_count, 1);
+  EXPECT_EQ(callback_count, 1);
+}
+
+TEST(AsyncContextChainTest, ResumeOnExecutorRunsInlineIfSchedulingFails) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  mock_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    return FailureExecutionResult(1234);
+  };
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+
+  size_t callback_count = 0;
+  AsyncContext<string, string> parent_context(
+      make_shared<string>("request"),
+      [&](AsyncContext<string, string>& context) {
+        EXPECT_SUCCESS(context.result);
+        callback_count++;
+      });
+
+  auto child_context = ChainAsyncContext<int>(
+      parent_context, make_shared<int>(1),
+      ResumeOnExecutor(async_executor,
+                       [](AsyncContext<string, string>& parent_context,
+                          AsyncContext<int, int>&) {
+                         FinishContext(SuccessExecutionResult(),
+                                       parent_context);
+                       }));
+  child_context.result = SuccessExecutionResult();
+  child_context.Finish();
+
+  EXPECT_EQ(callback_count, 1);
+}
+}  // namespace google::scp::core::common::test
@@ -16,15 +16,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "core/common/auto_expiry_concurrent_map/src/frequency_sketch.h"
 #include "core/common/concurrent_map/src/concurrent_map.h"
 #include "core/common/global_logger/src/global_logger.h"
 #include "core/common/time_provider/src/time_provider.h"
@@ -44,7 +47,28 @@ static constexpr std::chrono::seconds
     kAutoExpiryConcurrentMapStopWaitMaxDurationToWait =
         std::chrono::seconds(10);
 
+/// Once over its memory budget, the map evicts down to this share of it.
+static constexpr size_t kAutoExpiryConcurrentMapEvictionTargetPercent = 90;
+
+/// While none of its entries can be evicted, the map runs at most one eviction
+/// pass per this interval, rather than one per refused insertion.
+static constexpr std::chrono::milliseconds
+    kAutoExpiryConcurrentMapFruitlessEvictionBackoff =
+        std::chrono::milliseconds(100);
+
 namespace google::scp::core::common {
+/// Statistics of one garbage collection pass of an AutoExpiryConcurrentMap.
+struct AutoExpiryConcurrentMapGarbageCollectionStats {
+  /// The time spent picking the entries to evict.
+  std::chrono::nanoseconds duration = std::chrono::nanoseconds(0);
+  /// The number of entries looked at.
+  size_t visited_entry_count = 0;
+  /// The number of entries handed to the eviction callback.
+  size_t evicted_entry_count = 0;
+  /// The number of expired entries kept because they are hot.
+  size_t retained_entry_count = 0;
+};
+
 /**
  * @brief AutoExpiryConcurrentMap provides auto cleanup functionality on
  * top of a concurrent map which is a multi producers and multi consumers map
@@ -61,9 +85,10 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
   struct AutoExpiryConcurrentMapEntry {
     AutoExpiryConcurrentMapEntry(TValue& entry, size_t expiration_in_seconds)
         : entry(entry), being_evicted(false), is_evictable(true) {
-      expiration_time = (TimeProvider::GetSteadyTimestampInNanoseconds() +
-                         std::chrono::seconds(expiration_in_seconds))
-                            .count();
+      expiration_time =
+          (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+           std::chrono::seconds(expiration_in_seconds))
+              .count();
     }
 
     /**
@@ -86,9 +111,10 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
             errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_ENTRY_BEING_DELETED);
       }
 
-      expiration_time = (TimeProvider::GetSteadyTimestampInNanoseconds() +
-                         std::chrono::seconds(expiration_seconds))
-                            .count();
+      expiration_time =
+          (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+           std::chrono::seconds(expiration_seconds))
+              .count();
 
       return SuccessExecutionResult();
     }
@@ -121,6 +147,13 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
     /// Indicates if the entry is evictable.
     bool is_evictable;
 
+    /// The share of the memory budget taken by the entry.
+    size_t weight = 1;
+
+    /// The number of lifetimes the entry was kept for since its last access,
+    /// because it is hot.
+    std::atomic<size_t> retained_lifetime_count{0};
+
     /// Expiration of the entry in the memory
     std::atomic<core::Timestamp> expiration_time;
   };
@@ -137,21 +170,29 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
    * @param on_before_element_deletion_callback The callback to be called
    * right before removing the element from the map.
    * @param async_executor An instance to the async executor.
+   * @param stripe_count The number of independently locked stripes of the
+   * underlying map.
+   * @param index_expirations Keeps the keys bucketed by expiration second so
+   * that the garbage collection only visits the entries that are due, instead
+   * of every key of the map.
    */
   AutoExpiryConcurrentMap(
       size_t map_entry_lifetime_seconds, bool extend_entry_lifetime_on_access,
       bool block_entry_while_eviction,
       std::function<void(TKey&, TValue&, std::function<void(bool)>)>
           on_before_element_deletion_callback,
-      const std::shared_ptr<AsyncExecutorInterface>& async_executor)
-      : map_entry_lifetime_seconds_(map_entry_lifetime_seconds),
+      const std::shared_ptr<AsyncExecutorInterface>& async_executor,
+      size_t stripe_count = 1, bool index_expirations = false)
+      : concurrent_map_(stripe_count),
+        map_entry_lifetime_seconds_(map_entry_lifetime_seconds),
         extend_entry_lifetime_on_access_(extend_entry_lifetime_on_access),
         block_entry_while_eviction_(block_entry_while_eviction),
         on_before_element_deletion_callback_(
             on_before_element_deletion_callback),
         async_executor_(async_executor),
         pending_garbage_collection_callbacks_(0),
-        is_running_(false) {}
+        is_running_(false),
+        index_expirations_(index_expirations) {}
 
   ExecutionResult Init() noexcept override { return SuccessExecutionResult(); }
 
@@ -170,7 +211,7 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
 
     // Wait until scheduled work (if any) is completed
     auto wait_start_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
-    while (pending_garbage_collection_callbacks_ > 0) {
+    while (pending_garbage_collection_callbacks_ > 0 || is_evicting_) {
       std::this_thread::sleep_for(
           kAutoExpiryConcurrentMapStopWaitSleepDuration);
       // If timeout, then return an error.
@@ -212,12 +253,35 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
   virtual ExecutionResult Insert(std::pair<TKey, TValue> key_value,
                                  TValue& out_value) noexcept {
     auto record = std::make_shared<AutoExpiryConcurrentMapEntry>(
-        key_value.second, map_entry_lifetime_seconds_);
+        key_value.second, GetEffectiveEntryLifetimeSeconds());
+
+    if (memory_budget_ > 0) {
+      RecordAccess(key_value.first);
+      record->weight = weigher_ ? weigher_(record->entry) : 1;
+      // A new entry is only admitted while the map is within its budget.
+      if (total_weight_.load() + record->weight >
+          GetEffectiveMemoryBudget()) {
+        std::shared_ptr<AutoExpiryConcurrentMapEntry> existing_record;
+        if (!concurrent_map_.Find(key_value.first, existing_record)
+                 .Successful()) {
+          ScheduleEviction();
+          return FailureExecutionResult(
+              errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED);
+        }
+      }
+    }
 
     auto pair = std::make_pair(key_value.first, record);
     auto execution_result = concurrent_map_.Insert(pair, record);
 
-    if (!execution_result.Successful()) {
+    if (execution_result.Successful()) {
+      IndexExpiration(key_value.first, record);
+      if (memory_budget_ > 0 &&
+          total_weight_.fetch_add(record->weight) + record->weight >
+              GetEffectiveMemoryBudget()) {
+        ScheduleEviction();
+      }
+    } else {
       if (execution_result !=
           FailureExecutionResult(
               core::errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS)) {
@@ -231,8 +295,9 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
       }
 
       if (extend_entry_lifetime_on_access_ && !record->being_evicted) {
-        record->ExtendExpiration(map_entry_lifetime_seconds_);
+        record->ExtendExpiration(GetEffectiveEntryLifetimeSeconds());
       }
+      record->retained_lifetime_count = 0;
     }
 
     out_value = record->entry;
@@ -253,6 +318,7 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
     auto execution_result = concurrent_map_.Find(key, record);
 
     if (execution_result.Successful()) {
+      RecordAccess(key);
       std::shared_lock<std::shared_timed_mutex> lock(record->record_lock);
       if (block_entry_while_eviction_ && record->being_evicted) {
         return FailureExecutionResult(
@@ -260,8 +326,9 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
       }
 
       if (extend_entry_lifetime_on_access_ && !record->being_evicted) {
-        record->ExtendExpiration(map_entry_lifetime_seconds_);
+        record->ExtendExpiration(GetEffectiveEntryLifetimeSeconds());
       }
+      record->retained_lifetime_count = 0;
 
       out_value = record->entry;
     }
@@ -277,7 +344,7 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
    * @return ExecutionResult The execution result of the operation.
    */
   virtual ExecutionResult Erase(TKey& key) noexcept {
-    return concurrent_map_.Erase(key);
+    return EraseEntry(key);
   }
 
   /**
@@ -315,7 +382,7 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
       }
 
       if (extend_entry_lifetime_on_access_) {
-        record->ExtendExpiration(map_entry_lifetime_seconds_);
+        record->ExtendExpiration(GetEffectiveEntryLifetimeSeconds());
       }
 
       record->is_evictable = false;
@@ -340,23 +407,122 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
       }
 
       if (extend_entry_lifetime_on_access_) {
-        record->ExtendExpiration(map_entry_lifetime_seconds_);
+        record->ExtendExpiration(GetEffectiveEntryLifetimeSeconds());
       }
 
       record->is_evictable = true;
+      // The entry can be picked by the next eviction pass right away.
+      last_fruitless_eviction_timestamp_ = 0;
     }
     return execution_result;
   }
 
+  /**
+   * @brief Extends the lifetime of an element in the map provided by the key
+   * by map_entry_lifetime_seconds from now, for instance once its value is
+   * refreshed.
+   *
+   * @param key The key of the element to extend the lifetime of.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult ExtendExpiration(const TKey& key) noexcept {
+    std::shared_ptr<AutoExpiryConcurrentMapEntry> record;
+    auto execution_result = concurrent_map_.Find(key, record);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    return record->ExtendExpiration(GetEffectiveEntryLifetimeSeconds());
+  }
+
+  /**
+   * @brief Bounds the memory of the map. Once the entries weigh more than the
+   * budget, the least frequently used evictable entries are evicted, through
+   * the same deletion callback as the expired ones, down to
+   * kAutoExpiryConcurrentMapEvictionTargetPercent of the budget. The entries
+   * pinned with DisableEviction are never evicted. While the map is full, new
+   * keys are refused with SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED.
+   * Must be called before any insertion.
+   *
+   * @param memory_budget The budget, in entries if there is no weigher,
+   * otherwise in the unit of the weigher, e.g. bytes. 0 means unbounded.
+   * @param weigher Returns the weight of a value.
+   */
+  void SetMemoryBudget(
+      size_t memory_budget,
+      std::function<size_t(const TValue&)> weigher = nullptr) noexcept {
+    memory_budget_ = memory_budget;
+    weigher_ = std::move(weigher);
+    frequency_sketch_.reset();
+    if (memory_budget_ > 0) {
+      frequency_sketch_ = std::make_unique<FrequencySketch>(memory_budget_);
+    }
+  }
+
+  /**
+   * @brief Keeps the hot entries past their expiry, so that a key that goes
+   * quiet between bursts of accesses is not reloaded on the next burst. An
+   * expired entry is kept for another lifetime if its recent access frequency
+   * is at least min_access_frequency, while the map weighs less than
+   * kAutoExpiryConcurrentMapEvictionTargetPercent of its memory budget, and at
+   * most max_retained_lifetimes times in a row without an access. Needs a
+   * memory budget, whose frequency sketch estimates the access frequencies.
+   * Must be called before Run.
+   *
+   * @param min_access_frequency The min estimated recent access count of a hot
+   * entry, at most FrequencySketch::kMaxCount. 0 disables the retention.
+   * @param max_retained_lifetimes The max number of lifetimes an entry is kept
+   * for without an access.
+   */
+  void SetHotEntryRetention(uint8_t min_access_frequency,
+                            size_t max_retained_lifetimes) noexcept {
+    hot_entry_min_access_frequency_ =
+        std::min(min_access_frequency, FrequencySketch::kMaxCount);
+    hot_entry_max_retained_lifetimes_ = max_retained_lifetimes;
+  }
+
+  /**
+   * @brief Scales the memory budget and the entry lifetime down under memory
+   * pressure, e.g. from a memory governor. The entries inserted or accessed
+   * from then on expire after the scaled lifetime, and if the map weighs more
+   * than the scaled budget, an eviction pass brings it back under it. Can be
+   * called at any time.
+   *
+   * @param resource_scale The scale, in (0, 1]. 1 restores the configured
+   * budget and lifetime.
+   */
+  void SetResourceScale(double resource_scale) noexcept {
+    resource_scale_ = std::clamp(resource_scale, 0.0, 1.0);
+    if (memory_budget_ > 0 &&
+        total_weight_.load() > GetEffectiveMemoryBudget()) {
+      ScheduleEviction();
+    }
+  }
+
+  /// Returns the current weight of the entries, if there is a memory budget.
+  size_t GetTotalWeight() noexcept { return total_weight_.load(); }
+
+  /**
+   * @brief Sets the observer of the garbage collection passes, for instance to
+   * export their duration as a metric. Must be called before Run.
+   *
+   * @param garbage_collection_observer Called at the end of each pass, on the
+   * garbage collection thread.
+   */
+  void SetGarbageCollectionObserver(
+      std::function<void(const AutoExpiryConcurrentMapGarbageCollectionStats&)>
+          garbage_collection_observer) noexcept {
+    garbage_collection_observer_ = std::move(garbage_collection_observer);
+  }
+
  protected:
   /**
    * @brief Schedules a round of garbage collection in the next
-   * map_entry_lifetime_seconds_.
+   * entry lifetime, scaled by the resource scale.
    */
   core::ExecutionResult ScheduleGarbageCollection() noexcept {
     Timestamp next_schedule_time =
         (TimeProvider::GetSteadyTimestampInNanoseconds() +
-         std::chrono::seconds(map_entry_lifetime_seconds_))
+         std::chrono::seconds(GetEffectiveEntryLifetimeSeconds()))
             .count();
     sync_mutex.lock();
     if (!is_running_) {
@@ -382,32 +548,63 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
    * alert must be raised.
    */
   void RunGarbageCollector() {
-    std::vector<TKey> keys;
-    auto execution_result = concurrent_map_.Keys(keys);
-    if (!execution_result.Successful()) {
-      // Reschedule
-      ScheduleGarbageCollection();
-      return;
+    auto start_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
+    std::vector<std::pair<TKey, std::shared_ptr<AutoExpiryConcurrentMapEntry>>>
+        candidates;
+    if (index_expirations_) {
+      GetDueEntries(candidates);
+    } else {
+      std::vector<TKey> keys;
+      auto execution_result = concurrent_map_.Keys(keys);
+      if (!execution_result.Successful()) {
+        // Reschedule
+        ScheduleGarbageCollection();
+        return;
+      }
+
+      for (auto key : keys) {
+        std::shared_ptr<AutoExpiryConcurrentMapEntry> value;
+        auto execution_result = concurrent_map_.Find(key, value);
+        if (!execution_result.Successful()) {
+          // TODO: log and continue
+          continue;
+        }
+        candidates.push_back(std::make_pair(key, value));
+      }
     }
 
     std::vector<std::pair<TKey, std::shared_ptr<AutoExpiryConcurrentMapEntry>>>
         elements_to_remove;
+    size_t retained_entry_count = 0;
 
-    for (auto key : keys) {
-      std::shared_ptr<AutoExpiryConcurrentMapEntry> value;
-      auto execution_result = concurrent_map_.Find(key, value);
-      if (!execution_result.Successful()) {
-        // TODO: log and continue
-        continue;
-      }
-
+    for (auto& [key, value] : candidates) {
       std::unique_lock<std::shared_timed_mutex> lock(value->record_lock,
                                                      std::defer_lock);
       if (!lock.try_lock()) {
+        IndexExpiration(key, value);
         continue;
       }
 
       if (!value->is_evictable || !value->IsExpired()) {
+        IndexExpiration(key, value);
+        continue;
+      }
+
+      // The entry is already handed to the deletion callback by an eviction
+      // pass, which indexes it again if it is not deleted.
+      if (value->being_evicted) {
+        continue;
+      }
+
+      if (ShouldRetainHotEntry(key, *value)) {
+        // The record lock is already held, so the expiration is set directly.
+        value->expiration_time =
+            (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+             std::chrono::seconds(GetEffectiveEntryLifetimeSeconds()))
+                .count();
+        ++value->retained_lifetime_count;
+        ++retained_entry_count;
+        IndexExpiration(key, value);
         continue;
       }
 
@@ -415,6 +612,16 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
       elements_to_remove.push_back(std::make_pair(key, value));
     }
 
+    if (garbage_collection_observer_) {
+      AutoExpiryConcurrentMapGarbageCollectionStats stats;
+      stats.duration =
+          TimeProvider::GetSteadyTimestampInNanoseconds() - start_timestamp;
+      stats.visited_entry_count = candidates.size();
+      stats.evicted_entry_count = elements_to_remove.size();
+      stats.retained_entry_count = retained_entry_count;
+      garbage_collection_observer_(stats);
+    }
+
     if (elements_to_remove.size() == 0) {
       ScheduleGarbageCollection();
       return;
@@ -445,7 +652,7 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
       bool can_delete) noexcept {
     if (can_delete) {
       auto key = std::get<0>(key_value_pair);
-      auto execution_result = concurrent_map_.Erase(key);
+      auto execution_result = EraseEntry(key);
       if (!execution_result.Successful()) {
         // TODO: Log this.
         std::unique_lock<std::shared_timed_mutex> lock(
@@ -455,9 +662,14 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
     } else {
       // TODO: Log.
       // Set the loaded flag to true since we dont want to keep it unavailable.
-      std::unique_lock<std::shared_timed_mutex> lock(
-          std::get<1>(key_value_pair)->record_lock);
-      std::get<1>(key_value_pair)->being_evicted = false;
+      {
+        std::unique_lock<std::shared_timed_mutex> lock(
+            std::get<1>(key_value_pair)->record_lock);
+        std::get<1>(key_value_pair)->being_evicted = false;
+      }
+      // The entry stays, so it is looked at again by the next pass.
+      IndexExpiration(std::get<0>(key_value_pair),
+                      std::get<1>(key_value_pair));
     }
 
     // Last callback
@@ -468,10 +680,288 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
     ScheduleGarbageCollection();
   }
 
+  /**
+   * @brief Erases the entry of the key, and releases its weight.
+   *
+   * @param key The key of the entry.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult EraseEntry(const TKey& key) noexcept {
+    std::shared_ptr<AutoExpiryConcurrentMapEntry> record;
+    auto execution_result = concurrent_map_.Erase(key, record);
+    if (execution_result.Successful() && memory_budget_ > 0) {
+      total_weight_.fetch_sub(record->weight);
+    }
+    return execution_result;
+  }
+
+  /// Returns the memory budget scaled by the resource scale, at least 1.
+  size_t GetEffectiveMemoryBudget() noexcept {
+    return std::max<size_t>(
+        1, static_cast<size_t>(memory_budget_ * resource_scale_.load()));
+  }
+
+  /// Returns the entry lifetime scaled by the resource scale, at least 1 unless
+  /// the configured lifetime is 0.
+  size_t GetEffectiveEntryLifetimeSeconds() noexcept {
+    if (map_entry_lifetime_seconds_ == 0) {
+      return 0;
+    }
+    return std::max<size_t>(
+        1, static_cast<size_t>(map_entry_lifetime_seconds_ *
+                               resource_scale_.load()));
+  }
+
+  /// Whether an expired entry is hot enough to be kept for another lifetime.
+  bool ShouldRetainHotEntry(
+      const TKey& key, const AutoExpiryConcurrentMapEntry& record) noexcept {
+    if (hot_entry_min_access_frequency_ == 0 || !frequency_sketch_ ||
+        record.retained_lifetime_count.load() >=
+            hot_entry_max_retained_lifetimes_) {
+      return false;
+    }
+    // Only the room left under the eviction target is used for the hot
+    // entries, so that keeping them does not trigger evictions.
+    if (total_weight_.load() >
+        GetEffectiveMemoryBudget() *
+            kAutoExpiryConcurrentMapEvictionTargetPercent / 100) {
+      return false;
+    }
+    return frequency_sketch_->Estimate(TCompare().hash(key)) >=
+           hot_entry_min_access_frequency_;
+  }
+
+  /// Records an access to the key in the frequency sketch, if any.
+  void RecordAccess(const TKey& key) noexcept {
+    if (frequency_sketch_) {
+      frequency_sketch_->Increment(TCompare().hash(key));
+    }
+  }
+
+  /// Schedules an eviction pass, unless there is one in progress already.
+  void ScheduleEviction() noexcept {
+    // Backs off while the last pass found nothing to evict.
+    auto last_fruitless_eviction_timestamp =
+        last_fruitless_eviction_timestamp_.load();
+    if (last_fruitless_eviction_timestamp != 0 &&
+        TimeProvider::GetSteadyTimestampInNanoseconds().count() -
+                last_fruitless_eviction_timestamp <
+            std::chrono::nanoseconds(
+                kAutoExpiryConcurrentMapFruitlessEvictionBackoff)
+                .count()) {
+      return;
+    }
+
+    bool is_evicting = false;
+    if (!is_evicting_.compare_exchange_strong(is_evicting, true)) {
+      return;
+    }
+
+    sync_mutex.lock();
+    auto is_running = is_running_;
+    sync_mutex.unlock();
+
+    // Stop waits for is_evicting_ to be cleared, so the pass cannot outlive
+    // the map even when it is scheduled while stopping.
+    if (!is_running ||
+        !async_executor_->Schedule([this]() { RunEviction(); },
+                                   AsyncPriority::Normal)
+             .Successful()) {
+      is_evicting_ = false;
+    }
+  }
+
+  /**
+   * @brief Evicts the least frequently used evictable entries until the map
+   * is back to kAutoExpiryConcurrentMapEvictionTargetPercent of its budget.
+   * Among the entries used as often, the heavier and then the sooner to expire
+   * go first.
+   */
+  void RunEviction() noexcept {
+    size_t target_weight =
+        GetEffectiveMemoryBudget() *
+        kAutoExpiryConcurrentMapEvictionTargetPercent / 100;
+    size_t total_weight = total_weight_.load();
+    if (total_weight <= target_weight) {
+      is_evicting_ = false;
+      return;
+    }
+
+    struct EvictionCandidate {
+      TKey key;
+      std::shared_ptr<AutoExpiryConcurrentMapEntry> record;
+      uint8_t frequency;
+      Timestamp expiration_time;
+    };
+
+    std::vector<TKey> keys;
+    concurrent_map_.Keys(keys);
+    std::vector<EvictionCandidate> candidates;
+    candidates.reserve(keys.size());
+    for (auto& key : keys) {
+      std::shared_ptr<AutoExpiryConcurrentMapEntry> record;
+      if (!concurrent_map_.Find(key, record).Successful()) {
+        continue;
+      }
+      candidates.push_back(
+          {key, record, frequency_sketch_->Estimate(TCompare().hash(key)),
+           record->expiration_time.load()});
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const EvictionCandidate& left,
+                 const EvictionCandidate& right) {
+                if (left.frequency != right.frequency) {
+                  return left.frequency < right.frequency;
+                }
+                if (left.record->weight != right.record->weight) {
+                  return left.record->weight > right.record->weight;
+                }
+                return left.expiration_time < right.expiration_time;
+              });
+
+    std::vector<std::pair<TKey, std::shared_ptr<AutoExpiryConcurrentMapEntry>>>
+        elements_to_evict;
+    size_t weight_to_evict = 0;
+    for (auto& candidate : candidates) {
+      if (total_weight - weight_to_evict <= target_weight) {
+        break;
+      }
+
+      std::unique_lock<std::shared_timed_mutex> lock(
+          candidate.record->record_lock, std::defer_lock);
+      if (!lock.try_lock()) {
+        continue;
+      }
+      if (!candidate.record->is_evictable || candidate.record->being_evicted) {
+        continue;
+      }
+
+      candidate.record->being_evicted = true;
+      weight_to_evict += candidate.record->weight;
+      elements_to_evict.push_back(
+          std::make_pair(candidate.key, candidate.record));
+    }
+
+    if (elements_to_evict.size() == 0) {
+      // Every entry is pinned or busy, so the next passes would only go over
+      // the same keys again.
+      last_fruitless_eviction_timestamp_ =
+          TimeProvider::GetSteadyTimestampInNanoseconds().count();
+      is_evicting_ = false;
+      return;
+    }
+    last_fruitless_eviction_timestamp_ = 0;
+
+    pending_eviction_callbacks_ = elements_to_evict.size();
+    for (auto& element_to_evict : elements_to_evict) {
+      auto callback = std::bind(&AutoExpiryConcurrentMap::OnEntryEvicted, this,
+                                element_to_evict, std::placeholders::_1);
+      on_before_element_deletion_callback_(
+          element_to_evict.first, element_to_evict.second->entry, callback);
+    }
+  }
+
+  /**
+   * @brief This is called when an entry picked by the eviction is ready to be
+   * deleted.
+   *
+   * @param key_value_pair The key value pair to be removed.
+   * @param can_delete Indicates whether this element can be removed from the
+   * map.
+   */
+  void OnEntryEvicted(
+      std::pair<TKey, std::shared_ptr<AutoExpiryConcurrentMapEntry>>&
+          key_value_pair,
+      bool can_delete) noexcept {
+    if (!can_delete || !EraseEntry(key_value_pair.first).Successful()) {
+      {
+        std::unique_lock<std::shared_timed_mutex> lock(
+            key_value_pair.second->record_lock);
+        key_value_pair.second->being_evicted = false;
+      }
+      // The garbage collection skipped the entry while it was being evicted.
+      IndexExpiration(key_value_pair.first, key_value_pair.second);
+    }
+
+    if (pending_eviction_callbacks_.fetch_sub(1) != 1) {
+      return;
+    }
+    is_evicting_ = false;
+  }
+
+  /**
+   * @brief Adds the entry to the expiry index under its current expiration
+   * second. Extending the expiration does not move the entry in the index:
+   * the garbage collection indexes it again when it finds it not expired yet.
+   *
+   * @param key The key of the entry.
+   * @param record The entry.
+   */
+  void IndexExpiration(
+      const TKey& key,
+      const std::shared_ptr<AutoExpiryConcurrentMapEntry>& record) noexcept {
+    if (!index_expirations_) {
+      return;
+    }
+
+    auto expiration_second =
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::nanoseconds(record->expiration_time.load()))
+            .count();
+    std::lock_guard lock(expiry_index_mutex_);
+    expiry_index_[expiration_second].emplace_back(key, record);
+  }
+
+  /**
+   * @brief Takes the entries of the expiry index due by now that are still in
+   * the map.
+   *
+   * @param due_entries The entries due.
+   */
+  void GetDueEntries(
+      std::vector<std::pair<
+          TKey, std::shared_ptr<AutoExpiryConcurrentMapEntry>>>& due_entries) {
+    auto current_second = std::chrono::duration_cast<std::chrono::seconds>(
+                              TimeProvider::GetSteadyTimestampInNanoseconds())
+                              .count();
+    ExpiryIndex due_buckets;
+    {
+      std::lock_guard lock(expiry_index_mutex_);
+      auto due_end = expiry_index_.upper_bound(current_second);
+      due_buckets.insert(std::make_move_iterator(expiry_index_.begin()),
+                         std::make_move_iterator(due_end));
+      expiry_index_.erase(expiry_index_.begin(), due_end);
+    }
+
+    for (auto& [expiration_second, bucket] : due_buckets) {
+      for (auto& [key, weak_record] : bucket) {
+        auto record = weak_record.lock();
+        if (!record) {
+          continue;
+        }
+
+        // Skips the entries erased, or erased and inserted again since they
+        // were indexed.
+        std::shared_ptr<AutoExpiryConcurrentMapEntry> current_record;
+        if (!concurrent_map_.Find(key, current_record).Successful() ||
+            current_record != record) {
+          continue;
+        }
+        due_entries.push_back(std::make_pair(key, record));
+      }
+    }
+  }
+
   ConcurrentMap<TKey, std::shared_ptr<AutoExpiryConcurrentMapEntry>, TCompare>
       concurrent_map_;
 
  private:
+  /// The indexed keys of one expiration second.
+  using ExpiryIndexBucket =
+      std::vector<std::pair<TKey, std::weak_ptr<AutoExpiryConcurrentMapEntry>>>;
+  /// The indexed keys by expiration second.
+  using ExpiryIndex = std::map<int64_t, ExpiryIndexBucket>;
+
   /// The map entry lifetime in seconds.
   const size_t map_entry_lifetime_seconds_;
   // Indicates whether to extend the entries lifetime on access.
@@ -491,5 +981,36 @@ class AutoExpiryConcurrentMap : public ServiceInterface {
   std::mutex sync_mutex;
   /// Indicates whther the component stopped
   bool is_running_;
+  /// Indicates whether the garbage collection goes through the expiry index.
+  const bool index_expirations_;
+  /// The keys bucketed by expiration second, if index_expirations_ is set.
+  ExpiryIndex expiry_index_;
+  /// Mutex of the expiry index.
+  std::mutex expiry_index_mutex_;
+  /// The memory budget of the map, 0 if unbounded.
+  size_t memory_budget_ = 0;
+  /// Returns the weight of a value, or null if each entry weighs 1.
+  std::function<size_t(const TValue&)> weigher_;
+  /// The scale applied to the memory budget and the entry lifetime.
+  std::atomic<double> resource_scale_{1.0};
+  /// The total weight of the entries, if there is a memory budget.
+  std::atomic<size_t> total_weight_{0};
+  /// The recent access frequencies of the keys, if there is a memory budget.
+  std::unique_ptr<FrequencySketch> frequency_sketch_;
+  /// The min access frequency of the entries kept past their expiry, 0 if
+  /// none are.
+  uint8_t hot_entry_min_access_frequency_ = 0;
+  /// The max number of lifetimes an entry is kept for without an access.
+  size_t hot_entry_max_retained_lifetimes_ = 0;
+  /// Indicates whether an eviction pass is scheduled or in progress.
+  std::atomic<bool> is_evicting_{false};
+  /// The pending callbacks of the current eviction pass.
+  std::atomic<size_t> pending_eviction_callbacks_{0};
+  /// The steady time in nanoseconds of the last eviction pass that found
+  /// nothing to evict, 0 if the last pass evicted entries.
+  std::atomic<uint64_t> last_fruitless_eviction_timestamp_{0};
+  /// The observer of the garbage collection passes.
+  std::function<void(const AutoExpiryConcurrentMapGarbageCollectionStats&)>
+      garbage_collection_observer_;
 };
 }  // namespace google::scp::core::common
@@ -41,4 +41,10 @@ DEFINE_ERROR_CODE(SC_AUTO_EXPIRY_CONCURRENT_MAP_STOP_INCOMPLETE,
                   "AutoExpiryConcurrentMap properly.",
                   HttpStatusCode::CONFLICT)
 
+DEFINE_ERROR_CODE(SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED,
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP, 0x0006,
+                  "The map is at its memory budget, the entry cannot be "
+                  "inserted.",
+                  HttpStatusCode::TOO_MANY_REQUESTS)
+
 }  // namespace google::scp::core::errors
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace google::scp::core::common {
+/**
+ * @brief Approximates how often keys were accessed recently (TinyLFU), with a
+ * count-min sketch of small saturating counters. All the counters are halved
+ * once enough accesses were recorded, so that the old popularity fades out.
+ *
+ * The counters are updated with relaxed atomics and without retries, so
+ * concurrent increments can be lost. That is fine for an estimate.
+ */
+class FrequencySketch {
+ public:
+  /**
+   * @brief Construct a new Frequency Sketch object.
+   *
+   * @param expected_key_count the number of keys the estimates should be
+   * accurate for.
+   */
+  explicit FrequencySketch(size_t expected_key_count)
+      : width_(RoundUpToPowerOfTwo(expected_key_count)),
+        counters_(std::make_unique<std::atomic<uint8_t>[]>(width_ * kDepth)),
+        sample_size_(width_ * kSampleSizeMultiplier),
+        addition_count_(0) {
+    for (size_t i = 0; i < width_ * kDepth; ++i) {
+      counters_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Records an access to the key.
+   *
+   * @param hash the hash of the key.
+   */
+  void Increment(size_t hash) noexcept {
+    bool incremented = false;
+    for (size_t row = 0; row < kDepth; ++row) {
+      auto& counter = counters_[Index(hash, row)];
+      auto value = counter.load(std::memory_order_relaxed);
+      if (value < kMaxCount) {
+        counter.store(value + 1, std::memory_order_relaxed);
+        incremented = true;
+      }
+    }
+
+    if (!incremented) {
+      return;
+    }
+    if (addition_count_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+        sample_size_) {
+      Reset();
+    }
+  }
+
+  /**
+   * @brief Returns the estimated recent access count of the key, at most
+   * kMaxCount.
+   *
+   * @param hash the hash of the key.
+   */
+  uint8_t Estimate(size_t hash) const noexcept {
+    uint8_t estimate = kMaxCount;
+    for (size_t row = 0; row < kDepth; ++row) {
+      auto value = counters_[Index(hash, row)].load(std::memory_order_relaxed);
+      if (value < estimate) {
+        estimate = value;
+      }
+    }
+    return estimate;
+  }
+
+  /// The maximum value of a counter.
+  static constexpr uint8_t kMaxCount = 15;
+
+ private:
+  /// The number of hash functions, i.e. rows of counters.
+  static constexpr size_t kDepth = 4;
+  /// The counters are halved every width times this many increments.
+  static constexpr size_t kSampleSizeMultiplier = 10;
+
+  static size_t RoundUpToPowerOfTwo(size_t value) noexcept {
+    size_t power = 64;
+    while (power < value) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+  size_t Index(size_t hash, size_t row) const noexcept {
+    static constexpr uint64_t kSeeds[kDepth] = {
+        0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+        0xD6E8FEB86659FD93ull};
+    uint64_t mixed = (static_cast<uint64_t>(hash) + kSeeds[row]) * kSeeds[0];
+    return row * width_ + ((mixed >> 32) & (width_ - 1));
+  }
+
+  /// Halves all the counters.
+  void Reset() noexcept {
+    for (size_t i = 0; i < width_ * kDepth; ++i) {
+      auto value = counters_[i].load(std::memory_order_relaxed);
+      counters_[i].store(value >> 1, std::memory_order_relaxed);
+    }
+    addition_count_.store(0, std::memory_order_relaxed);
+  }
+
+  /// The number of counters per row. A power of two.
+  const size_t width_;
+  /// The kDepth rows of counters.
+  std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+  /// The number of increments between two resets.
+  const size_t sample_size_;
+  /// The number of increments since the last reset.
+  std::atomic<size_t> addition_count_;
+};
+}  // namespace google::scp::core::common
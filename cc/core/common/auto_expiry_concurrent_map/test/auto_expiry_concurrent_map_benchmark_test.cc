@@ -0,0 +1,176 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/async_executor/mock/mock_async_executor.h"
+#include "core/common/auto_expiry_concurrent_map/mock/mock_auto_expiry_concurrent_map.h"
+
+namespace google::scp::core::common::test {
+
+using ::google::scp::core::async_executor::mock::MockAsyncExecutor;
+using ::google::scp::core::common::auto_expiry_concurrent_map::mock::
+    MockAutoExpiryConcurrentMap;
+
+/// The entries not accessed for this long are evicted.
+static constexpr size_t kEntryLifetimeSeconds = 1;
+static constexpr uint64_t kKeyCount = 1 << 16;
+static constexpr std::chrono::milliseconds kGarbageCollectionInterval(10);
+
+static constexpr char kGarbageCollectionPassesKey[] = "gc_passes";
+static constexpr char kMeanGarbageCollectionPauseKey[] = "gc_mean_pause_us";
+static constexpr char kMaxGarbageCollectionPauseKey[] = "gc_max_pause_us";
+static constexpr char kEvictedEntriesKey[] = "gc_evicted_entries";
+
+/**
+ * @brief Runs finds and inserts on a map shared by the threads of the
+ * benchmark, the inserts putting back the entries the garbage collection
+ * evicted.
+ *
+ * The benchmark arguments are the percentage of finds, the stripe count,
+ * whether the expirations are indexed and whether the garbage collection runs.
+ */
+class AutoExpiryConcurrentMapFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    std::shared_ptr<AsyncExecutorInterface> async_executor =
+        std::make_shared<MockAsyncExecutor>();
+    map_ = std::make_unique<MockAutoExpiryConcurrentMap<uint64_t, uint64_t>>(
+        kEntryLifetimeSeconds, true /* extend_entry_lifetime_on_access */,
+        true /* block_entry_while_eviction */,
+        [](uint64_t&, uint64_t&, std::function<void(bool)> should_delete) {
+          should_delete(true);
+        },
+        async_executor, state.range(1), state.range(2) != 0);
+    map_->Init();
+    for (uint64_t key = 0; key < kKeyCount; ++key) {
+      uint64_t value;
+      map_->Insert(std::make_pair(key, key), value);
+    }
+
+    garbage_collection_passes_ = 0;
+    garbage_collection_pause_sum_ = 0;
+    garbage_collection_pause_max_ = 0;
+    evicted_entries_ = 0;
+    map_->SetGarbageCollectionObserver(
+        [this](const AutoExpiryConcurrentMapGarbageCollectionStats& stats) {
+          uint64_t pause = stats.duration.count();
+          garbage_collection_passes_++;
+          garbage_collection_pause_sum_ += pause;
+          evicted_entries_ += stats.evicted_entry_count;
+          auto max = garbage_collection_pause_max_.load();
+          while (pause > max &&
+                 !garbage_collection_pause_max_.compare_exchange_weak(max,
+                                                                      pause)) {
+          }
+        });
+
+    stop_garbage_collection_ = false;
+    if (state.range(3) != 0) {
+      garbage_collection_thread_ = std::thread([this]() {
+        while (!stop_garbage_collection_) {
+          map_->RunGarbageCollector();
+          std::this_thread::sleep_for(kGarbageCollectionInterval);
+        }
+      });
+    }
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    stop_garbage_collection_ = true;
+    if (garbage_collection_thread_.joinable()) {
+      garbage_collection_thread_.join();
+    }
+    map_ = nullptr;
+  }
+
+  std::unique_ptr<MockAutoExpiryConcurrentMap<uint64_t, uint64_t>> map_;
+  std::atomic<bool> stop_garbage_collection_{false};
+  std::thread garbage_collection_thread_;
+  std::atomic<uint64_t> garbage_collection_passes_{0};
+  std::atomic<uint64_t> garbage_collection_pause_sum_{0};
+  std::atomic<uint64_t> garbage_collection_pause_max_{0};
+  std::atomic<uint64_t> evicted_entries_{0};
+};
+
+BENCHMARK_DEFINE_F(AutoExpiryConcurrentMapFixture, FindInsert)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  std::uniform_int_distribution<uint64_t> key_distribution(0, kKeyCount - 1);
+  std::uniform_int_distribution<int64_t> operation_distribution(0, 99);
+  auto find_percentage = state.range(0);
+  for (auto _ : state) {
+    auto key = key_distribution(random);
+    uint64_t value = 0;
+    if (operation_distribution(random) < find_percentage) {
+      benchmark::DoNotOptimize(map_->Find(key, value));
+    } else {
+      benchmark::DoNotOptimize(map_->Insert(std::make_pair(key, key), value));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    auto passes = garbage_collection_passes_.load();
+    state.counters[kGarbageCollectionPassesKey] = passes;
+    state.counters[kMeanGarbageCollectionPauseKey] =
+        passes == 0
+            ? 0
+            : garbage_collection_pause_sum_.load() / passes / 1000.0;
+    state.counters[kMaxGarbageCollectionPauseKey] =
+        garbage_collection_pause_max_.load() / 1000.0;
+    state.counters[kEvictedEntriesKey] = evicted_entries_.load();
+  }
+}
+
+// Read heavy, mixed and write heavy; the stripes; whether the expirations are
+// indexed; and whether the garbage collection runs.
+BENCHMARK_REGISTER_F(AutoExpiryConcurrentMapFixture, FindInsert)
+    ->ArgsProduct({{95, 50, 5}, {1, 16}, {0, 1}, {0, 1}})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK_DEFINE_F(AutoExpiryConcurrentMapFixture, Keys)
+
+(benchmark::State& state) {
+  std::vector<uint64_t> keys;
+  for (auto _ : state) {
+    keys.clear();
+    benchmark::DoNotOptimize(map_->Keys(keys));
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK_REGISTER_F(AutoExpiryConcurrentMapFixture, Keys)
+    ->ArgsProduct({{100}, {1, 16}, {0}, {0}});
+
+}  // namespace google::scp::core::common::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
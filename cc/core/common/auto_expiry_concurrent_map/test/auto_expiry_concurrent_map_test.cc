@@ -37,8 +37,11 @@
 using google::scp::core::AsyncExecutor;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::common::AutoExpiryConcurrentMap;
+using google::scp::core::common::AutoExpiryConcurrentMapGarbageCollectionStats;
 using google::scp::core::common::auto_expiry_concurrent_map::mock::
     MockAutoExpiryConcurrentMap;
+using google::scp::core::errors::
+    SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED;
 using google::scp::core::test::ResultIs;
 using google::scp::core::test::TestTimeoutException;
 using google::scp::core::test::WaitUntil;
@@ -109,9 +112,10 @@ TEST_F(AutoExpiryConcurrentMapTest, InsertingNewElementExtendOnAccessEnabled) {
 
   underlying_entry->being_evicted = false;
 
-  auto current_clock = (TimeProvider::GetSteadyTimestampInNanoseconds() +
-                        seconds(cache_lifetime_))
-                           .count();
+  auto current_clock =
+      (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+       seconds(cache_lifetime_))
+          .count();
 
   EXPECT_THAT(auto_expiry_map.Insert(pair, entry),
               ResultIs(FailureExecutionResult(
@@ -147,9 +151,10 @@ TEST_F(AutoExpiryConcurrentMapTest,
 
   underlying_entry->being_evicted = false;
 
-  auto current_clock = (TimeProvider::GetSteadyTimestampInNanoseconds() +
-                        seconds(cache_lifetime_))
-                           .count();
+  auto current_clock =
+      (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+       seconds(cache_lifetime_))
+          .count();
 
   EXPECT_THAT(auto_expiry_map.Insert(pair, entry),
               ResultIs(FailureExecutionResult(
@@ -231,9 +236,10 @@ TEST_F(AutoExpiryConcurrentMapTest, FindingElementExtendOnAccessEnabled) {
   EXPECT_NE(current_expiration, 0);
   underlying_entry->being_evicted = false;
 
-  auto current_clock = (TimeProvider::GetSteadyTimestampInNanoseconds() +
-                        seconds(cache_lifetime_))
-                           .count();
+  auto current_clock =
+      (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+       seconds(cache_lifetime_))
+          .count();
   EXPECT_SUCCESS(auto_expiry_map.Find(3, entry));
 
   auto_expiry_map.GetUnderlyingConcurrentMap().Find(3, underlying_entry);
@@ -263,9 +269,10 @@ TEST_F(AutoExpiryConcurrentMapTest,
   EXPECT_NE(current_expiration, 0);
   underlying_entry->being_evicted = false;
 
-  auto current_clock = (TimeProvider::GetSteadyTimestampInNanoseconds() +
-                        seconds(cache_lifetime_))
-                           .count();
+  auto current_clock =
+      (TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
+       seconds(cache_lifetime_))
+          .count();
   EXPECT_SUCCESS(auto_expiry_map.Find(3, entry));
 
   auto_expiry_map.GetUnderlyingConcurrentMap().Find(3, underlying_entry);
@@ -452,6 +459,445 @@ TEST_F(AutoExpiryConcurrentMapTest, GarbageCollection) {
   EXPECT_EQ(keys_to_be_deleted[0], 3);
 }
 
+TEST_F(AutoExpiryConcurrentMapTest, GarbageCollectionObserver) {
+  vector<AutoExpiryConcurrentMapGarbageCollectionStats> stats;
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      0, false, true, on_before_element_deletion_callback_,
+      mock_async_executor_);
+  auto_expiry_map.SetGarbageCollectionObserver(
+      [&](const AutoExpiryConcurrentMapGarbageCollectionStats& pass_stats) {
+        stats.push_back(pass_stats);
+      });
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  for (int i = 0; i < 3; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(i, entry), entry));
+  }
+  auto_expiry_map.DisableEviction(0);
+
+  auto_expiry_map.RunGarbageCollector();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].visited_entry_count, 3);
+  EXPECT_EQ(stats[0].evicted_entry_count, 2);
+  EXPECT_GE(stats[0].duration.count(), 0);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, ExpiryIndexOnlyVisitsDueEntries) {
+  vector<int> keys_to_be_deleted;
+  vector<AutoExpiryConcurrentMapGarbageCollectionStats> stats;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+      };
+
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_, /*stripe_count=*/4, /*index_expirations=*/true);
+  auto_expiry_map.SetGarbageCollectionObserver(
+      [&](const AutoExpiryConcurrentMapGarbageCollectionStats& pass_stats) {
+        stats.push_back(pass_stats);
+      });
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  for (int i = 0; i < 10; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(i, entry), entry));
+  }
+
+  auto_expiry_map.RunGarbageCollector();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].visited_entry_count, 0);
+  EXPECT_EQ(keys_to_be_deleted.size(), 0);
+  EXPECT_EQ(auto_expiry_map.Size(), 10);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, ExpiryIndexGarbageCollection) {
+  vector<int> keys_to_be_deleted;
+  vector<function<void(bool)>> deleters;
+  vector<AutoExpiryConcurrentMapGarbageCollectionStats> stats;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+        deleters.push_back(deleter);
+      };
+
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      0, false, true, on_before_element_deletion_callback, mock_async_executor_,
+      /*stripe_count=*/1, /*index_expirations=*/true);
+  auto_expiry_map.SetGarbageCollectionObserver(
+      [&](const AutoExpiryConcurrentMapGarbageCollectionStats& pass_stats) {
+        stats.push_back(pass_stats);
+      });
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(1, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(2, entry), entry));
+  // Erased and inserted again, so only the last insertion is indexed.
+  int key = 3;
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(key, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.Erase(key));
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(key, entry), entry));
+
+  // Key 2 is extended past the pass, so it is indexed again instead.
+  shared_ptr<UnderlyingEntry> underlying_entry;
+  auto_expiry_map.GetUnderlyingConcurrentMap().Find(2, underlying_entry);
+  underlying_entry->expiration_time =
+      (TimeProvider::GetSteadyTimestampInNanoseconds() + seconds(100)).count();
+
+  auto_expiry_map.RunGarbageCollector();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].visited_entry_count, 3);
+  EXPECT_EQ(stats[0].evicted_entry_count, 2);
+  std::sort(keys_to_be_deleted.begin(), keys_to_be_deleted.end());
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({1, 3}));
+
+  // Key 1 cannot be deleted, so the next pass looks at it again.
+  deleters[0](false);
+  deleters[1](true);
+  EXPECT_EQ(auto_expiry_map.Size(), 2);
+
+  keys_to_be_deleted.clear();
+  auto_expiry_map.RunGarbageCollector();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[1].visited_entry_count, 1);
+  EXPECT_EQ(stats[1].evicted_entry_count, 1);
+  EXPECT_EQ(keys_to_be_deleted.size(), 1);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, MemoryBudgetEvictsLeastFrequentlyUsed) {
+  vector<int> keys_to_be_deleted;
+  vector<function<void(bool)>> deleters;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+        deleters.push_back(deleter);
+      };
+
+  AutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(10);
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  for (int i = 0; i < 10; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(i, entry), entry));
+  }
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 10);
+  // Every key but 0 is used again.
+  for (int i = 1; i < 10; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Find(i, entry));
+  }
+  EXPECT_EQ(keys_to_be_deleted.size(), 0);
+
+  // The map is full, so the new key is refused and the eviction starts.
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(10, entry), entry),
+              ResultIs(FailureExecutionResult(
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({0}));
+  // Existing keys can still be accessed.
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(5, entry), entry),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS)));
+
+  deleters[0](true);
+  EXPECT_EQ(auto_expiry_map.Size(), 9);
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 9);
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(10, entry), entry));
+
+  int key = 10;
+  EXPECT_SUCCESS(auto_expiry_map.Erase(key));
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 9);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, MemoryBudgetRespectsPinnedEntries) {
+  vector<int> keys_to_be_deleted;
+  vector<function<void(bool)>> deleters;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+        deleters.push_back(deleter);
+      };
+
+  AutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(2);
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(0, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(1, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.DisableEviction(0));
+  for (int i = 0; i < 5; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Find(1, entry));
+  }
+
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(2, entry), entry),
+              ResultIs(FailureExecutionResult(
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({1}));
+
+  // The entry could not be deleted, so it stays.
+  deleters[0](false);
+  EXPECT_SUCCESS(auto_expiry_map.Find(1, entry));
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 2);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, MemoryBudgetBacksOffWhileAllArePinned) {
+  vector<int> keys_to_be_deleted;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+      };
+  size_t eviction_pass_count = 0;
+  mock_async_executor_->schedule_mock = [&](const AsyncOperation& work) {
+    eviction_pass_count++;
+    work();
+    return SuccessExecutionResult();
+  };
+
+  AutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(1);
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(0, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.DisableEviction(0));
+
+  // Only the first refused key runs a pass, which finds nothing to evict.
+  for (int i = 1; i < 10; i++) {
+    EXPECT_THAT(auto_expiry_map.Insert(make_pair(i, entry), entry),
+                ResultIs(FailureExecutionResult(
+                    SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+  }
+  EXPECT_EQ(eviction_pass_count, 1);
+  EXPECT_EQ(keys_to_be_deleted.size(), 0);
+
+  // Unpinning an entry ends the back off.
+  EXPECT_SUCCESS(auto_expiry_map.EnableEviction(0));
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(10, entry), entry),
+              ResultIs(FailureExecutionResult(
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+  EXPECT_EQ(eviction_pass_count, 2);
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({0}));
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, GarbageCollectionSkipsEntriesBeingEvicted) {
+  vector<int> keys_to_be_deleted;
+  vector<function<void(bool)>> deleters;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+        deleters.push_back(deleter);
+      };
+
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(2);
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(0, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(1, entry), entry));
+  for (int i = 0; i < 5; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Find(1, entry));
+  }
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(2, entry), entry),
+              ResultIs(FailureExecutionResult(
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({0}));
+
+  for (int key : {0, 1}) {
+    shared_ptr<UnderlyingEntry> underlying_entry;
+    auto_expiry_map.GetUnderlyingConcurrentMap().Find(key, underlying_entry);
+    underlying_entry->expiration_time = 0;
+  }
+
+  // The entry being evicted is not handed to the callback a second time.
+  auto_expiry_map.RunGarbageCollector();
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({0, 1}));
+
+  deleters[0](true);
+  deleters[1](true);
+  EXPECT_EQ(auto_expiry_map.Size(), 0);
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 0);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, MemoryBudgetWithWeigher) {
+  vector<function<void(bool)>> deleters;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<string>&,
+          function<void(bool can_delete)> deleter) {
+        deleters.push_back(deleter);
+      };
+
+  AutoExpiryConcurrentMap<int, shared_ptr<string>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(
+      100, [](const shared_ptr<string>& value) { return value->size(); });
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  shared_ptr<string> out_value;
+  EXPECT_SUCCESS(auto_expiry_map.Insert(
+      make_pair(0, make_shared<string>(60, 'a')), out_value));
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 60);
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(1, make_shared<string>(50, 'b')),
+                                     out_value),
+              ResultIs(FailureExecutionResult(
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+  // Within the budget, so nothing is evicted.
+  EXPECT_EQ(deleters.size(), 0);
+
+  EXPECT_SUCCESS(auto_expiry_map.Insert(
+      make_pair(1, make_shared<string>(40, 'b')), out_value));
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 100);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, HotEntryRetentionKeepsHotEntries) {
+  vector<int> keys_to_be_deleted;
+  vector<AutoExpiryConcurrentMapGarbageCollectionStats> stats;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+      };
+
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(10);
+  auto_expiry_map.SetHotEntryRetention(4 /* min_access_frequency */,
+                                       2 /* max_retained_lifetimes */);
+  auto_expiry_map.SetGarbageCollectionObserver(
+      [&](const AutoExpiryConcurrentMapGarbageCollectionStats& pass_stats) {
+        stats.push_back(pass_stats);
+      });
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(0, entry), entry));
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(1, entry), entry));
+  // Only key 0 is hot.
+  for (int i = 0; i < 5; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Find(0, entry));
+  }
+
+  shared_ptr<UnderlyingEntry> hot_entry;
+  shared_ptr<UnderlyingEntry> cold_entry;
+  auto_expiry_map.GetUnderlyingConcurrentMap().Find(0, hot_entry);
+  auto_expiry_map.GetUnderlyingConcurrentMap().Find(1, cold_entry);
+  hot_entry->expiration_time = 0;
+  cold_entry->expiration_time = 0;
+
+  auto_expiry_map.RunGarbageCollector();
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({1}));
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].retained_entry_count, 1);
+  EXPECT_FALSE(hot_entry->IsExpired());
+  // The deletion of the cold entry is left pending.
+  cold_entry->expiration_time = UINT64_MAX;
+
+  // The hot entry is kept for at most 2 lifetimes without an access.
+  hot_entry->expiration_time = 0;
+  auto_expiry_map.RunGarbageCollector();
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({1}));
+  hot_entry->expiration_time = 0;
+  auto_expiry_map.RunGarbageCollector();
+  EXPECT_EQ(keys_to_be_deleted, vector<int>({1, 0}));
+}
+
+TEST_F(AutoExpiryConcurrentMapTest,
+       HotEntryRetentionStaysUnderTheEvictionTarget) {
+  vector<int> keys_to_be_deleted;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+      };
+
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(10);
+  auto_expiry_map.SetHotEntryRetention(1 /* min_access_frequency */,
+                                       10 /* max_retained_lifetimes */);
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  // 10 entries are over 90% of the budget, so none is kept past its expiry.
+  auto entry = make_shared<EmptyEntry>();
+  for (int i = 0; i < 10; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(i, entry), entry));
+    shared_ptr<UnderlyingEntry> underlying_entry;
+    auto_expiry_map.GetUnderlyingConcurrentMap().Find(i, underlying_entry);
+    underlying_entry->expiration_time = 0;
+  }
+
+  auto_expiry_map.RunGarbageCollector();
+  EXPECT_EQ(keys_to_be_deleted.size(), 10);
+}
+
+TEST_F(AutoExpiryConcurrentMapTest, ResourceScaleShrinksBudgetAndLifetime) {
+  vector<int> keys_to_be_deleted;
+  vector<function<void(bool)>> deleters;
+  auto on_before_element_deletion_callback =
+      [&](int& key, shared_ptr<EmptyEntry>&,
+          function<void(bool can_delete)> deleter) {
+        keys_to_be_deleted.push_back(key);
+        deleters.push_back(deleter);
+      };
+
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, true, on_before_element_deletion_callback,
+      mock_async_executor_);
+  auto_expiry_map.SetMemoryBudget(10);
+  EXPECT_SUCCESS(auto_expiry_map.Run());
+
+  auto entry = make_shared<EmptyEntry>();
+  for (int i = 0; i < 8; i++) {
+    EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(i, entry), entry));
+  }
+  EXPECT_EQ(keys_to_be_deleted.size(), 0);
+
+  // Halving the scale brings the map down to 90% of a budget of 5.
+  auto_expiry_map.SetResourceScale(0.5);
+  EXPECT_EQ(keys_to_be_deleted.size(), 4);
+  for (auto& deleter : deleters) {
+    deleter(true);
+  }
+  EXPECT_EQ(auto_expiry_map.GetTotalWeight(), 4);
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(8, entry), entry));
+  EXPECT_THAT(auto_expiry_map.Insert(make_pair(9, entry), entry),
+              ResultIs(FailureExecutionResult(
+                  SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED)));
+
+  // The new entries expire after half of the lifetime.
+  shared_ptr<UnderlyingEntry> underlying_entry;
+  auto_expiry_map.GetUnderlyingConcurrentMap().Find(8, underlying_entry);
+  auto half_lifetime_expiration =
+      (TimeProvider::GetSteadyTimestampInNanoseconds() +
+       seconds(cache_lifetime_ / 2))
+          .count();
+  EXPECT_LE(underlying_entry->expiration_time.load(),
+            half_lifetime_expiration);
+
+  // Restoring the scale restores the budget.
+  auto_expiry_map.SetResourceScale(1);
+  EXPECT_SUCCESS(auto_expiry_map.Insert(make_pair(9, entry), entry));
+}
+
 TEST_F(AutoExpiryConcurrentMapTest, OnRemoveEntryFromCacheLogged) {
   vector<int> keys_to_be_deleted;
   auto on_before_element_deletion_callback_ =
@@ -604,6 +1050,7 @@ TEST(AutoExpiryConcurrentMapDeletionTest, DeletionForExpired) {
   underlying_entry->is_evictable = true;
 
   entry = make_shared<EmptyEntry>();
+  underlying_entry = make_shared<UnderlyingEntry>(entry, 0);
   underlying_pair = make_pair(5, underlying_entry);
   auto_expiry_map.GetUnderlyingConcurrentMap().Insert(underlying_pair,
                                                       underlying_entry);
@@ -639,6 +1086,26 @@ TEST(AutoExpiryConcurrentMapDeletionTest, DeletionForExpired) {
   WaitUntil([&]() { return schedule_for_called; });
 }
 
+TEST_F(AutoExpiryConcurrentMapTest, ExtendExpiration) {
+  MockAutoExpiryConcurrentMap<int, shared_ptr<EmptyEntry>> auto_expiry_map(
+      cache_lifetime_, false, false, on_before_element_deletion_callback_,
+      mock_async_executor_);
+
+  EXPECT_THAT(auto_expiry_map.ExtendExpiration(3),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
+
+  auto entry = make_shared<EmptyEntry>();
+  auto pair = make_pair(3, entry);
+  EXPECT_SUCCESS(auto_expiry_map.Insert(pair, entry));
+
+  shared_ptr<UnderlyingEntry> record;
+  EXPECT_SUCCESS(auto_expiry_map.GetUnderlyingConcurrentMap().Find(3, record));
+  record->expiration_time = 0;
+  EXPECT_SUCCESS(auto_expiry_map.ExtendExpiration(3));
+  EXPECT_FALSE(record->IsExpired());
+}
+
 TEST(AutoExpiryConcurrentMapEntryTest, ExtendEntryExpiration) {
   shared_ptr<EmptyEntry> empty_entry;
   UnderlyingEntry entry(empty_entry, 1);
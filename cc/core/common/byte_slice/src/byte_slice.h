@@ -0,0 +1,220 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/interface/type_def.h"
+
+namespace google::scp::core::common {
+/**
+ * @brief An immutable range of bytes sharing the ownership of its storage.
+ *
+ * Slices of up to kInlineCapacity bytes are stored inline and cost no
+ * allocation. The bytes of larger slices are in a reference counted store,
+ * allocated once along with its reference count, so copying a slice or taking
+ * a sub slice of it copies no bytes. A slice made from a BytesBuffer shares
+ * the vector of the buffer instead of copying its bytes.
+ */
+class ByteSlice {
+ public:
+  /// The size of the slices stored inline, e.g. a serialized Uuid and its
+  /// envelope.
+  static constexpr size_t kInlineCapacity = 40;
+
+  ByteSlice() = default;
+
+  /**
+   * @brief Constructs a slice from a copy of the bytes.
+   *
+   * @param data the bytes.
+   * @param length the number of bytes.
+   */
+  ByteSlice(const Byte* data, size_t length) : length_(length) {
+    if (length <= kInlineCapacity) {
+      CopyInline(data, length);
+      return;
+    }
+    auto* memory = ::operator new(sizeof(Store) + length);
+    store_ = new (memory) Store();
+    auto* store_bytes = reinterpret_cast<Byte*>(store_ + 1);
+    memcpy(store_bytes, data, length);
+    data_ = store_bytes;
+  }
+
+  /**
+   * @brief Constructs a slice from a copy of the string.
+   *
+   * @param bytes the bytes.
+   */
+  explicit ByteSlice(std::string_view bytes)
+      : ByteSlice(bytes.data(), bytes.size()) {}
+
+  /**
+   * @brief Constructs a slice of the used bytes of the buffer, sharing the
+   * vector of the buffer rather than copying it unless the bytes fit inline.
+   *
+   * @param bytes_buffer the buffer.
+   */
+  explicit ByteSlice(const BytesBuffer& bytes_buffer)
+      : length_(bytes_buffer.bytes ? bytes_buffer.length : 0) {
+    if (length_ <= kInlineCapacity) {
+      CopyInline(length_ ? bytes_buffer.bytes->data() : nullptr, length_);
+      return;
+    }
+    store_ = new (::operator new(sizeof(Store))) Store();
+    store_->shared_bytes = bytes_buffer.bytes;
+    data_ = bytes_buffer.bytes->data();
+  }
+
+  ByteSlice(const ByteSlice& other) { *this = other; }
+
+  ByteSlice(ByteSlice&& other) noexcept { *this = std::move(other); }
+
+  ByteSlice& operator=(const ByteSlice& other) {
+    if (this == &other) {
+      return *this;
+    }
+    if (other.store_) {
+      other.store_->reference_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    Release();
+    store_ = other.store_;
+    data_ = other.data_;
+    length_ = other.length_;
+    if (!store_) {
+      memcpy(inline_bytes_, other.inline_bytes_, length_);
+    }
+    return *this;
+  }
+
+  ByteSlice& operator=(ByteSlice&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    Release();
+    store_ = std::exchange(other.store_, nullptr);
+    data_ = std::exchange(other.data_, nullptr);
+    length_ = std::exchange(other.length_, 0);
+    if (!store_) {
+      memcpy(inline_bytes_, other.inline_bytes_, length_);
+    }
+    return *this;
+  }
+
+  ~ByteSlice() { Release(); }
+
+  /// @brief Returns the bytes of the slice.
+  const Byte* data() const { return store_ ? data_ : inline_bytes_; }
+
+  /// @brief Returns the number of bytes of the slice.
+  size_t size() const { return length_; }
+
+  /// @brief Returns whether the slice has no bytes.
+  bool empty() const { return length_ == 0; }
+
+  /// @brief Returns the bytes of the slice, valid for as long as the slice.
+  std::string_view AsStringView() const {
+    return std::string_view(data(), length_);
+  }
+
+  /// @brief Returns a copy of the bytes of the slice.
+  std::string ToString() const { return std::string(data(), length_); }
+
+  /**
+   * @brief Returns the slice of length bytes starting at offset, sharing the
+   * storage of this slice.
+   *
+   * @param offset the offset of the sub slice, at most size().
+   * @param length the length of the sub slice, at most size() - offset.
+   * @return ByteSlice the sub slice.
+   */
+  ByteSlice Subslice(size_t offset, size_t length) const {
+    assert(offset <= length_ && length <= length_ - offset);
+    if (!store_ || length <= kInlineCapacity) {
+      return ByteSlice(data() + offset, length);
+    }
+    ByteSlice subslice(*this);
+    subslice.data_ += offset;
+    subslice.length_ = length;
+    return subslice;
+  }
+
+  /**
+   * @brief Returns a buffer of the bytes of the slice. The buffer shares the
+   * vector the slice was made from when the slice is a prefix of it, and
+   * copies the bytes otherwise.
+   *
+   * @return BytesBuffer the buffer.
+   */
+  BytesBuffer ToBytesBuffer() const {
+    if (store_ && store_->shared_bytes &&
+        data_ == store_->shared_bytes->data()) {
+      BytesBuffer bytes_buffer;
+      bytes_buffer.bytes = store_->shared_bytes;
+      bytes_buffer.capacity = store_->shared_bytes->size();
+      bytes_buffer.length = length_;
+      return bytes_buffer;
+    }
+    BytesBuffer bytes_buffer(length_);
+    memcpy(bytes_buffer.bytes->data(), data(), length_);
+    bytes_buffer.length = length_;
+    return bytes_buffer;
+  }
+
+ private:
+  /// The storage of the slices larger than kInlineCapacity. The bytes follow
+  /// the store in the same allocation, unless they are shared_bytes.
+  struct Store {
+    std::atomic<size_t> reference_count = 1;
+    /// The vector of the BytesBuffer the slice was made from, if any.
+    std::shared_ptr<std::vector<Byte>> shared_bytes;
+  };
+
+  void CopyInline(const Byte* data, size_t length) {
+    if (length > 0) {
+      memcpy(inline_bytes_, data, length);
+    }
+  }
+
+  void Release() {
+    if (store_ &&
+        store_->reference_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      store_->~Store();
+      ::operator delete(store_);
+    }
+    store_ = nullptr;
+  }
+
+  /// The storage of the bytes, nullptr when they are inline.
+  Store* store_ = nullptr;
+  /// The first byte of the slice in the store.
+  const Byte* data_ = nullptr;
+  /// The number of bytes of the slice.
+  size_t length_ = 0;
+  /// The bytes of the slice when it has no store.
+  Byte inline_bytes_[kInlineCapacity];
+};
+}  // namespace google::scp::core::common
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/common/byte_slice/src/byte_slice.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+#include "core/interface/type_def.h"
+
+using google::scp::core::BytesBuffer;
+using std::string;
+
+namespace google::scp::core::common::test {
+TEST(ByteSliceTest, EmptySlice) {
+  ByteSlice slice;
+  EXPECT_TRUE(slice.empty());
+  EXPECT_EQ(slice.ToString(), "");
+  EXPECT_TRUE(ByteSlice(BytesBuffer()).empty());
+  EXPECT_EQ(slice.ToBytesBuffer().length, 0);
+}
+
+TEST(ByteSliceTest, SmallSlicesAreInline) {
+  string bytes(ByteSlice::kInlineCapacity, 'a');
+  ByteSlice slice(bytes);
+  ByteSlice copy(slice);
+  EXPECT_EQ(copy.ToString(), bytes);
+  // Each inline slice has its own bytes.
+  EXPECT_NE(copy.data(), slice.data());
+
+  ByteSlice moved(std::move(copy));
+  EXPECT_EQ(moved.ToString(), bytes);
+  EXPECT_EQ(moved.Subslice(1, 2).ToString(), "aa");
+}
+
+TEST(ByteSliceTest, CopiesAndSubslicesShareTheStore) {
+  string bytes = string(100, 'a') + string(100, 'b');
+  ByteSlice slice(bytes);
+  EXPECT_NE(slice.data(), bytes.data());
+  EXPECT_EQ(slice.ToString(), bytes);
+
+  ByteSlice copy = slice;
+  EXPECT_EQ(copy.data(), slice.data());
+
+  auto subslice = slice.Subslice(50, 100);
+  EXPECT_EQ(subslice.data(), slice.data() + 50);
+  EXPECT_EQ(subslice.ToString(), string(50, 'a') + string(50, 'b'));
+
+  // The store outlives the slice it was made for.
+  slice = ByteSlice();
+  copy = ByteSlice();
+  EXPECT_EQ(subslice.ToString(), string(50, 'a') + string(50, 'b'));
+
+  // Small sub slices are copied inline.
+  auto small_subslice = subslice.Subslice(49, 2);
+  EXPECT_EQ(small_subslice.ToString(), "ab");
+}
+
+TEST(ByteSliceTest, SharesTheVectorOfABytesBuffer) {
+  BytesBuffer bytes_buffer(string(100, 'a'));
+  bytes_buffer.length = 80;
+  ByteSlice slice(bytes_buffer);
+  EXPECT_EQ(slice.data(), bytes_buffer.bytes->data());
+  EXPECT_EQ(slice.size(), 80);
+
+  // A prefix is handed back as a buffer of the same vector.
+  auto prefix_buffer = slice.Subslice(0, 60).ToBytesBuffer();
+  EXPECT_EQ(prefix_buffer.bytes, bytes_buffer.bytes);
+  EXPECT_EQ(prefix_buffer.length, 60);
+  EXPECT_EQ(prefix_buffer.capacity, 100);
+
+  // Other slices are copied.
+  auto suffix_buffer = slice.Subslice(20, 60).ToBytesBuffer();
+  EXPECT_NE(suffix_buffer.bytes, bytes_buffer.bytes);
+  EXPECT_EQ(suffix_buffer.ToString(), string(60, 'a'));
+
+  bytes_buffer.Reset();
+  EXPECT_EQ(slice.ToString(), string(80, 'a'));
+}
+}  // namespace google::scp::core::common::test
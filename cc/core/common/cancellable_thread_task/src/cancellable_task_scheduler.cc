@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cancellable_task_scheduler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "core/common/time_provider/src/time_provider.h"
+
+using std::function;
+using std::mutex;
+using std::unique_lock;
+using std::chrono::nanoseconds;
+
+namespace google::scp::core::common {
+
+CancellableTaskScheduler::CancellableTaskScheduler(size_t thread_count)
+    : is_stopping_(false) {
+  thread_count = std::max<size_t>(1, thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back(&CancellableTaskScheduler::WorkerFunction, this);
+  }
+}
+
+CancellableTaskScheduler::~CancellableTaskScheduler() {
+  {
+    unique_lock lock(mutex_);
+    is_stopping_ = true;
+  }
+  condition_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void CancellableTaskScheduler::Schedule(function<void()> work,
+                                        nanoseconds start_steady_timestamp,
+                                        size_t priority) {
+  {
+    unique_lock lock(mutex_);
+    pending_work_.emplace(start_steady_timestamp,
+                          PendingWork{priority, std::move(work)});
+  }
+  // The new work may be due before the one the threads are waiting on.
+  condition_.notify_one();
+}
+
+size_t CancellableTaskScheduler::GetPendingWorkCount() {
+  unique_lock lock(mutex_);
+  return pending_work_.size();
+}
+
+void CancellableTaskScheduler::WorkerFunction() {
+  unique_lock lock(mutex_);
+  while (!is_stopping_) {
+    if (pending_work_.empty()) {
+      condition_.wait(lock);
+      continue;
+    }
+
+    auto next_work = pending_work_.begin();
+    auto now = TimeProvider::GetSteadyTimestampInNanoseconds();
+    if (next_work->first > now) {
+      condition_.wait_for(lock, next_work->first - now);
+      continue;
+    }
+
+    // Of the due work, run the first with the highest priority.
+    for (auto it = std::next(next_work);
+         it != pending_work_.end() && it->first <= now; ++it) {
+      if (it->second.priority > next_work->second.priority) {
+        next_work = it;
+      }
+    }
+
+    auto work = std::move(next_work->second.work);
+    pending_work_.erase(next_work);
+    lock.unlock();
+    work();
+    lock.lock();
+  }
+}
+
+}  // namespace google::scp::core::common
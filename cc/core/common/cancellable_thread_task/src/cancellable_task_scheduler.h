@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google::scp::core::common {
+/**
+ * @brief Runs delayed work on a fixed set of threads. The pending work is kept
+ * ordered by start time, so a delayed CancellableThreadTask created with a
+ * scheduler costs a queue entry instead of a thread of its own. Of the work
+ * that is due, the one with the highest priority runs first, so that a backlog
+ * of due work drains in priority order.
+ *
+ * The work still pending when the scheduler is destroyed is dropped.
+ */
+class CancellableTaskScheduler {
+ public:
+  /**
+   * @param thread_count the number of threads running the work, which bounds
+   * how many tasks execute at once.
+   */
+  explicit CancellableTaskScheduler(
+      size_t thread_count = std::thread::hardware_concurrency());
+
+  ~CancellableTaskScheduler();
+
+  CancellableTaskScheduler(const CancellableTaskScheduler&) = delete;
+  CancellableTaskScheduler& operator=(const CancellableTaskScheduler&) = delete;
+
+  /**
+   * @brief Schedules the work to run on one of the threads once the steady
+   * clock reaches start_steady_timestamp.
+   *
+   * @param work the work to run.
+   * @param start_steady_timestamp the earliest time to run the work at.
+   * @param priority the work due with a higher priority runs first, the one
+   * with the same priority by start time.
+   */
+  void Schedule(std::function<void()> work,
+                std::chrono::nanoseconds start_steady_timestamp,
+                size_t priority = 0);
+
+  /// @brief Returns the number of scheduled work not yet started.
+  size_t GetPendingWorkCount();
+
+ protected:
+  /// @brief A scheduled work not yet started.
+  struct PendingWork {
+    /// @brief the priority of the work.
+    size_t priority;
+    /// @brief the work to run.
+    std::function<void()> work;
+  };
+
+  /// @brief Runs the due work until the scheduler is destroyed.
+  void WorkerFunction();
+
+  /// @brief Protects the members below.
+  std::mutex mutex_;
+  /// @brief Signaled on new work and on destruction.
+  std::condition_variable condition_;
+  /// @brief The pending work by start time.
+  std::multimap<std::chrono::nanoseconds, PendingWork> pending_work_;
+  /// @brief Whether the scheduler is being destroyed.
+  bool is_stopping_;
+  /// @brief The threads running the work.
+  std::vector<std::thread> threads_;
+};
+}  // namespace google::scp::core::common
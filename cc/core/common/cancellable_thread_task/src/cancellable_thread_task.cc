@@ -16,6 +16,7 @@
 
 #include "cancellable_thread_task.h"
 
+using std::shared_ptr;
 using std::chrono::milliseconds;
 using std::this_thread::sleep_for;
 
@@ -25,38 +26,49 @@ static constexpr milliseconds kStartupDelayWaitLoopIntervalInMilliseconds =
 namespace google::scp::core::common {
 
 bool CancellableThreadTask::IsCancelled() const {
-  return task_state_.load() == TaskState::Cancelled;
+  return task_->task_state.load() == TaskState::Cancelled;
 }
 
 bool CancellableThreadTask::Cancel() {
   TaskState current_state = TaskState::NotStarted;
-  return task_state_.compare_exchange_strong(current_state,
-                                             TaskState::Cancelled);
+  if (!task_->task_state.compare_exchange_strong(current_state,
+                                                 TaskState::Cancelled)) {
+    return false;
+  }
+  // The task will never execute, so its captures are released right away
+  // rather than when the scheduler drops its queue entry.
+  if (scheduler_) {
+    task_->task_lambda = nullptr;
+  }
+  return true;
 }
 
 bool CancellableThreadTask::IsCompleted() const {
-  return task_state_.load() == TaskState::Completed;
+  return task_->task_state.load() == TaskState::Completed;
 }
 
 bool CancellableThreadTask::IsCancellable() const {
-  return task_state_.load() == TaskState::NotStarted;
+  return task_->task_state.load() == TaskState::NotStarted;
 }
 
-void CancellableThreadTask::ThreadFunction() {
+void CancellableThreadTask::ThreadFunction(const shared_ptr<Task>& task) {
   // Wait for the startup delay
   while (TimeProvider::GetSteadyTimestampInNanoseconds() <
-             start_steady_timestamp_ &&
-         task_state_ == TaskState::NotStarted) {
+             task->start_steady_timestamp &&
+         task->task_state == TaskState::NotStarted) {
     sleep_for(kStartupDelayWaitLoopIntervalInMilliseconds);
   }
+  Execute(*task);
+}
 
+void CancellableThreadTask::Execute(Task& task) {
   TaskState current_state = TaskState::NotStarted;
-  if (task_state_.compare_exchange_strong(current_state,
-                                          TaskState::Executing)) {
-    task_lambda_();
+  if (task.task_state.compare_exchange_strong(current_state,
+                                              TaskState::Executing)) {
+    task.task_lambda();
     // When task is executing, no else can change the task_state, no need of
     // CAS.
-    task_state_ = TaskState::Completed;
+    task.task_state = TaskState::Completed;
   }
 }
 
@@ -15,12 +15,14 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <utility>
 
+#include "core/common/cancellable_thread_task/src/cancellable_task_scheduler.h"
 #include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 
@@ -43,20 +45,38 @@ using TaskLambda = std::function<void()>;
 
 /**
  * @brief This is a one-off execution task that executes on a newly spun
- * std::thread. This structure holds an std::thread, so care must be ensured
- * that the thread is joined before destructing the object.
+ * std::thread, or on the threads of a CancellableTaskScheduler if one is
+ * given. In the former case this structure holds an std::thread, so care must
+ * be ensured that the thread is joined before destructing the object.
  */
 class CancellableThreadTask {
  public:
   CancellableThreadTask(
       TaskLambda task_lambda,
       std::chrono::nanoseconds startup_delay = std::chrono::nanoseconds(0))
-      : task_lambda_(std::move(task_lambda)),
-        task_state_(TaskState::NotStarted),
-        start_steady_timestamp_(
-            TimeProvider::GetSteadyTimestampInNanoseconds() +
-            std::chrono::steady_clock::duration(startup_delay)),
-        thread_(std::bind(&CancellableThreadTask::ThreadFunction, this)) {}
+      : task_(std::make_shared<Task>(std::move(task_lambda), startup_delay)),
+        thread_(std::bind(&CancellableThreadTask::ThreadFunction, task_)) {}
+
+  /**
+   * @brief Construct a task executing on the scheduler, which costs no thread
+   * while the task waits for its startup delay.
+   *
+   * @param task_lambda the task.
+   * @param scheduler the scheduler to execute the task on.
+   * @param startup_delay the delay before the task executes.
+   * @param priority the priority of the task on the scheduler, see
+   * CancellableTaskScheduler::Schedule.
+   */
+  CancellableThreadTask(
+      TaskLambda task_lambda,
+      const std::shared_ptr<CancellableTaskScheduler>& scheduler,
+      std::chrono::nanoseconds startup_delay = std::chrono::nanoseconds(0),
+      size_t priority = 0)
+      : task_(std::make_shared<Task>(std::move(task_lambda), startup_delay)),
+        scheduler_(scheduler) {
+    scheduler_->Schedule([task = task_]() { Execute(*task); },
+                         task_->start_steady_timestamp, priority);
+  }
 
   ~CancellableThreadTask() {
     assert(IsCompleted() || IsCancelled());
@@ -97,18 +117,38 @@ class CancellableThreadTask {
   bool IsCancellable() const;
 
  protected:
+  /// @brief The state of the task, shared with the thread or the scheduler
+  /// executing it.
+  struct Task {
+    Task(TaskLambda task_lambda, std::chrono::nanoseconds startup_delay)
+        : task_lambda(std::move(task_lambda)),
+          task_state(TaskState::NotStarted),
+          start_steady_timestamp(
+              TimeProvider::GetSteadyTimestampInNanoseconds() +
+              std::chrono::steady_clock::duration(startup_delay)) {}
+
+    /// @brief lambda that will be executed
+    TaskLambda task_lambda;
+    /// @brief upon task execution, this barrier will be changed from
+    /// 'NotStarted' --> 'Executing'. If the task needs to be cancelled,
+    /// 'NotStarted' --> 'Cancelled' is done instead.
+    std::atomic<TaskState> task_state;
+    /// @brief Task will start at this time.
+    std::chrono::nanoseconds start_steady_timestamp;
+  };
+
   /// @brief Internal function for thread
-  void ThreadFunction();
-
-  /// @brief lambda that will be executed by thread_
-  TaskLambda task_lambda_;
-  /// @brief upon task execution, this barrier will be changed from 'false' -->
-  /// 'true'. If the task needs to be cancelled, the same 'false' --> 'true' is
-  /// done.
-  std::atomic<TaskState> task_state_;
-  /// @brief Task will start at this time.
-  std::chrono::nanoseconds start_steady_timestamp_;
-  /// @brief thread to execute the task
+  static void ThreadFunction(const std::shared_ptr<Task>& task);
+
+  /// @brief Executes the task unless it is cancelled.
+  static void Execute(Task& task);
+
+  /// @brief the task
+  std::shared_ptr<Task> task_;
+  /// @brief thread to execute the task, if there is no scheduler
   std::thread thread_;
+  /// @brief scheduler to execute the task on, kept alive until the task is
+  /// destructed
+  std::shared_ptr<CancellableTaskScheduler> scheduler_;
 };
 }  // namespace google::scp::core::common
@@ -19,6 +19,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/test/utils/conditional_wait.h"
@@ -26,6 +30,13 @@
 
 using google::scp::core::test::WaitUntil;
 using std::atomic;
+using std::make_shared;
+using std::make_unique;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+using std::chrono::milliseconds;
 using std::chrono::duration_cast;
 using std::chrono::seconds;
 using std::this_thread::sleep_for;
@@ -83,4 +94,104 @@ TEST(CancellableThreadTaskTest, CannotCancelWhileExecuting) {
     std::this_thread::yield();
   }
 }
+TEST(CancellableThreadTaskTest, SchedulerTaskWaitsForStartupDelay) {
+  auto scheduler = make_shared<CancellableTaskScheduler>(1);
+  atomic<bool> is_done(false);
+  auto start_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
+  auto end_timestamp = start_timestamp;
+  CancellableThreadTask task(
+      [&is_done, &end_timestamp]() {
+        end_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
+        is_done = true;
+      },
+      scheduler, milliseconds(500));
+  WaitUntil([&is_done]() { return is_done == true; });
+  WaitUntil([&task]() { return task.IsCompleted(); });
+  EXPECT_GE(end_timestamp - start_timestamp, milliseconds(500));
+}
+
+TEST(CancellableThreadTaskTest, SchedulerTaskCanBeCancelled) {
+  auto scheduler = make_shared<CancellableTaskScheduler>(1);
+  auto capture = make_shared<int>(0);
+  CancellableThreadTask task([capture]() {}, scheduler, seconds(10));
+  EXPECT_EQ(scheduler->GetPendingWorkCount(), 1);
+  EXPECT_EQ(capture.use_count(), 2);
+
+  EXPECT_TRUE(task.Cancel());
+  EXPECT_TRUE(task.IsCancelled());
+  EXPECT_FALSE(task.Cancel());
+  // The captures of the cancelled task are released right away.
+  EXPECT_EQ(capture.use_count(), 1);
+}
+
+TEST(CancellableThreadTaskTest, SchedulerRunsTasksByStartTime) {
+  auto scheduler = make_shared<CancellableTaskScheduler>(1);
+  mutex order_mutex;
+  vector<int> order;
+  auto add_to_order = [&order_mutex, &order](int i) {
+    return [&order_mutex, &order, i]() {
+      std::unique_lock lock(order_mutex);
+      order.push_back(i);
+    };
+  };
+  CancellableThreadTask task3(add_to_order(3), scheduler, milliseconds(300));
+  CancellableThreadTask task1(add_to_order(1), scheduler, milliseconds(100));
+  CancellableThreadTask task2(add_to_order(2), scheduler, milliseconds(200));
+  WaitUntil([&]() {
+    return task1.IsCompleted() && task2.IsCompleted() && task3.IsCompleted();
+  });
+  EXPECT_EQ(order, vector<int>({1, 2, 3}));
+}
+
+TEST(CancellableThreadTaskTest, SchedulerRunsDueTasksByPriority) {
+  auto scheduler = make_shared<CancellableTaskScheduler>(1);
+  mutex order_mutex;
+  vector<int> order;
+  auto add_to_order = [&order_mutex, &order](int i) {
+    return [&order_mutex, &order, i]() {
+      std::unique_lock lock(order_mutex);
+      order.push_back(i);
+    };
+  };
+  // Keeps the thread busy until the other tasks are all due.
+  atomic<bool> is_blocked(true);
+  CancellableThreadTask blocking_task(
+      [&is_blocked]() {
+        while (is_blocked) {
+          sleep_for(milliseconds(10));
+        }
+      },
+      scheduler);
+  CancellableThreadTask task1(add_to_order(1), scheduler, milliseconds(0), 1);
+  CancellableThreadTask task3(add_to_order(3), scheduler, milliseconds(0), 3);
+  CancellableThreadTask task2(add_to_order(2), scheduler, milliseconds(0), 2);
+  CancellableThreadTask task4(add_to_order(4), scheduler, seconds(1), 4);
+  sleep_for(milliseconds(100));
+  is_blocked = false;
+  WaitUntil([&]() {
+    return task1.IsCompleted() && task2.IsCompleted() && task3.IsCompleted() &&
+           task4.IsCompleted();
+  });
+  // The task not yet due waits for its start time whatever its priority.
+  EXPECT_EQ(order, vector<int>({3, 2, 1, 4}));
+  EXPECT_TRUE(blocking_task.IsCompleted());
+}
+
+TEST(CancellableThreadTaskTest, SchedulerTasksShareItsThreads) {
+  auto scheduler = make_shared<CancellableTaskScheduler>(2);
+  atomic<size_t> executed_count(0);
+  vector<unique_ptr<CancellableThreadTask>> tasks;
+  for (int i = 0; i < 1000; ++i) {
+    tasks.push_back(make_unique<CancellableThreadTask>(
+        [&executed_count]() { executed_count++; }, scheduler,
+        milliseconds(i % 2 == 0 ? 0 : 100000)));
+  }
+  WaitUntil([&executed_count]() { return executed_count == 500; });
+  for (auto& task : tasks) {
+    if (!task->IsCompleted()) {
+      EXPECT_TRUE(task->Cancel());
+    }
+  }
+  EXPECT_EQ(scheduler->GetPendingWorkCount(), 500);
+}
 }  // namespace google::scp::core::common
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <utility>
@@ -27,9 +29,17 @@
 #include "error_codes.h"
 
 namespace google::scp::core::common {
+/// The number of stripes suited to the maps contended by many threads.
+static constexpr size_t kHighContentionConcurrentMapStripeCount = 16;
+
 /**
  * @brief ConcurrentMap provides multi producers and multi consumers map
  * support to be used generically.
+ *
+ * The map is split into stripes by key hash, each with its own lock, so that
+ * enumerating the keys only ever blocks the writers of the stripe being copied
+ * instead of the whole map. Each stripe costs a few hundred bytes, so only the
+ * maps shared by many threads should use more than one.
  */
 template <class TKey, class TValue,
           typename TCompare = oneapi::tbb::tbb_hash_compare<TKey>>
@@ -39,6 +49,16 @@ class ConcurrentMap {
       ConcurrentMapImpl;
 
  public:
+  /**
+   * @brief Construct a new Concurrent Map object.
+   *
+   * @param stripe_count the number of independently locked stripes. At least
+   * 1.
+   */
+  explicit ConcurrentMap(size_t stripe_count = 1)
+      : stripe_count_(stripe_count == 0 ? 1 : stripe_count),
+        stripes_(std::make_unique<Stripe[]>(stripe_count_)) {}
+
   // TODO: We might need to look into keeping the size constant.
 
   /**
@@ -56,12 +76,13 @@ class ConcurrentMap {
    * @return ExecutionResult The execution result of the operation.
    */
   ExecutionResult Insert(std::pair<TKey, TValue> key_value, TValue& out_value) {
-    std::shared_lock lock(concurrent_map_mutex_);
+    auto& stripe = GetStripe(key_value.first);
+    std::shared_lock lock(stripe.mutex);
 
     typename ConcurrentMapImpl::accessor map_accessor;
     ExecutionResult execution_result = SuccessExecutionResult();
 
-    if (!concurrent_map_.insert(map_accessor, key_value)) {
+    if (!stripe.map.insert(map_accessor, key_value)) {
       execution_result = FailureExecutionResult(
           errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS);
     }
@@ -81,12 +102,13 @@ class ConcurrentMap {
    * @return ExecutionResult The execution result of the operation.
    */
   ExecutionResult Find(const TKey& key, TValue& out_value) {
-    std::shared_lock lock(concurrent_map_mutex_);
+    auto& stripe = GetStripe(key);
+    std::shared_lock lock(stripe.mutex);
 
     typename ConcurrentMapImpl::accessor map_accessor;
     ExecutionResult execution_result = SuccessExecutionResult();
 
-    if (!concurrent_map_.find(map_accessor, key)) {
+    if (!stripe.map.find(map_accessor, key)) {
       execution_result = FailureExecutionResult(
           errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
     } else {
@@ -106,10 +128,11 @@ class ConcurrentMap {
    * @return ExecutionResult The execution result of the operation.
    */
   ExecutionResult Erase(const TKey& key) {
-    std::shared_lock lock(concurrent_map_mutex_);
+    auto& stripe = GetStripe(key);
+    std::shared_lock lock(stripe.mutex);
     ExecutionResult execution_result = SuccessExecutionResult();
 
-    if (!concurrent_map_.erase(key)) {
+    if (!stripe.map.erase(key)) {
       execution_result = FailureExecutionResult(
           errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
     }
@@ -118,18 +141,45 @@ class ConcurrentMap {
   }
 
   /**
-   * @brief Gets all the keys in the current concurrent map. This is a very
-   * expensive operation due to locking.
+   * @brief Erases an element from the map with the provided key, and returns
+   * the erased value.
+   *
+   * @param key The key to be erased from the map.
+   * @param out_value A reference to the erased value.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Erase(const TKey& key, TValue& out_value) {
+    auto& stripe = GetStripe(key);
+    std::shared_lock lock(stripe.mutex);
+
+    typename ConcurrentMapImpl::accessor map_accessor;
+    if (!stripe.map.find(map_accessor, key)) {
+      return FailureExecutionResult(
+          errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
+    }
+
+    out_value = map_accessor->second;
+    stripe.map.erase(map_accessor);
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Gets a snapshot of all the keys in the current concurrent map. The
+   * stripes are copied one at a time, each blocking the writers of that stripe
+   * only, so the snapshot is consistent per stripe but not across stripes.
    *
    * @param keys A vector of the keys to be filled in once looked up.
    * @return ExecutionResult The execution result of the operation.
    */
   ExecutionResult Keys(std::vector<TKey>& keys) {
-    std::unique_lock lock(concurrent_map_mutex_);
-
     keys.clear();
-    for (auto it = concurrent_map_.begin(); it != concurrent_map_.end(); ++it) {
-      keys.push_back(it->first);
+    keys.reserve(Size());
+    for (size_t i = 0; i < stripe_count_; ++i) {
+      auto& stripe = stripes_[i];
+      std::unique_lock lock(stripe.mutex);
+      for (auto it = stripe.map.begin(); it != stripe.map.end(); ++it) {
+        keys.push_back(it->first);
+      }
     }
 
     return SuccessExecutionResult();
@@ -140,13 +190,41 @@ class ConcurrentMap {
    *
    * @return size_t
    */
-  size_t Size() const { return concurrent_map_.size(); }
+  size_t Size() const {
+    size_t size = 0;
+    for (size_t i = 0; i < stripe_count_; ++i) {
+      size += stripes_[i].map.size();
+    }
+    return size;
+  }
+
+  /// Returns the number of independently locked stripes.
+  size_t StripeCount() const { return stripe_count_; }
 
  private:
-  /// Concurrent map implementation.
-  ConcurrentMapImpl concurrent_map_;
+  /// A part of the map with its own lock.
+  struct Stripe {
+    /// Concurrent map implementation.
+    ConcurrentMapImpl map;
+    /// Mutex to prevent write operations during Keys calls.
+    std::shared_mutex mutex;
+  };
+
+  /**
+   * @brief Returns the stripe of the key. The hash is mixed before picking the
+   * stripe because the underlying map buckets on its low bits.
+   */
+  Stripe& GetStripe(const TKey& key) const {
+    if (stripe_count_ == 1) {
+      return stripes_[0];
+    }
+    uint64_t hash = static_cast<uint64_t>(TCompare().hash(key));
+    return stripes_[((hash * 0x9E3779B97F4A7C15ull) >> 32) % stripe_count_];
+  }
 
-  /// Mutex to prevent write operations during Keys calls.
-  mutable std::shared_timed_mutex concurrent_map_mutex_;
+  /// The number of stripes.
+  const size_t stripe_count_;
+  /// The stripes of the map.
+  std::unique_ptr<Stripe[]> stripes_;
 };
 }  // namespace google::scp::core::common
@@ -0,0 +1,133 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/common/concurrent_map/src/concurrent_map.h"
+
+namespace google::scp::core::common::test {
+
+static constexpr char kKeysCallsKey[] = "keys_calls";
+
+/**
+ * @brief Runs finds, inserts and erases on a map shared by the threads of the
+ * benchmark.
+ *
+ * The benchmark arguments are the percentage of finds, the number of keys,
+ * the stripe count and whether another thread keeps listing the keys.
+ */
+class ConcurrentMapFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    key_count_ = state.range(1);
+    map_ = std::make_unique<ConcurrentMap<uint64_t, uint64_t>>(state.range(2));
+    // Half of the keys are present, so the inserts and erases both succeed
+    // about half of the time.
+    for (uint64_t key = 0; key < key_count_; key += 2) {
+      uint64_t value;
+      map_->Insert(std::make_pair(key, key), value);
+    }
+
+    keys_calls_ = 0;
+    stop_listing_keys_ = false;
+    if (state.range(3) != 0) {
+      keys_thread_ = std::thread([this]() {
+        std::vector<uint64_t> keys;
+        while (!stop_listing_keys_) {
+          keys.clear();
+          map_->Keys(keys);
+          keys_calls_++;
+        }
+      });
+    }
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    stop_listing_keys_ = true;
+    if (keys_thread_.joinable()) {
+      keys_thread_.join();
+    }
+    map_ = nullptr;
+  }
+
+  std::unique_ptr<ConcurrentMap<uint64_t, uint64_t>> map_;
+  uint64_t key_count_ = 0;
+  std::atomic<bool> stop_listing_keys_{false};
+  std::atomic<uint64_t> keys_calls_{0};
+  std::thread keys_thread_;
+};
+
+BENCHMARK_DEFINE_F(ConcurrentMapFixture, FindInsertErase)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  std::uniform_int_distribution<uint64_t> key_distribution(0, key_count_ - 1);
+  std::uniform_int_distribution<int64_t> operation_distribution(0, 99);
+  auto find_percentage = state.range(0);
+  for (auto _ : state) {
+    auto key = key_distribution(random);
+    uint64_t value = 0;
+    auto operation = operation_distribution(random);
+    if (operation < find_percentage) {
+      benchmark::DoNotOptimize(map_->Find(key, value));
+    } else if ((operation - find_percentage) % 2 == 0) {
+      benchmark::DoNotOptimize(map_->Insert(std::make_pair(key, key), value));
+    } else {
+      benchmark::DoNotOptimize(map_->Erase(key));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    state.counters[kKeysCallsKey] = keys_calls_.load();
+  }
+}
+
+// Read heavy, mixed and write heavy; the keys; the stripes; and whether the
+// keys are listed along.
+BENCHMARK_REGISTER_F(ConcurrentMapFixture, FindInsertErase)
+    ->ArgsProduct({{95, 50, 5}, {1 << 10, 1 << 20}, {1, 16}, {0, 1}})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK_DEFINE_F(ConcurrentMapFixture, Keys)
+
+(benchmark::State& state) {
+  std::vector<uint64_t> keys;
+  for (auto _ : state) {
+    keys.clear();
+    benchmark::DoNotOptimize(map_->Keys(keys));
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK_REGISTER_F(ConcurrentMapFixture, Keys)
+    ->ArgsProduct({{100}, {1 << 10, 1 << 20}, {1, 16}, {0}});
+
+}  // namespace google::scp::core::common::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <vector>
@@ -83,6 +84,21 @@ TEST_F(ConcurrentMapTests, DeleteNonExistingElement) {
                           errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
 }
 
+TEST_F(ConcurrentMapTests, EraseReturnsTheErasedValue) {
+  ConcurrentMap<int, int> map;
+
+  int value;
+  EXPECT_SUCCESS(map.Insert(make_pair(1, 10), value));
+
+  int erased_value = 0;
+  EXPECT_SUCCESS(map.Erase(1, erased_value));
+  EXPECT_EQ(erased_value, 10);
+
+  EXPECT_THAT(map.Erase(1, erased_value),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
+}
+
 TEST_F(ConcurrentMapTests, FindAnExistingElement) {
   ConcurrentMap<int, int> map;
 
@@ -136,4 +152,79 @@ TEST_F(ConcurrentMapTests, GetKeys) {
     EXPECT_EQ(true, false);
   }
 }
+
+TEST_F(ConcurrentMapTests, StripedMapOperations) {
+  ConcurrentMap<int, int> map(kHighContentionConcurrentMapStripeCount);
+  EXPECT_EQ(map.StripeCount(), kHighContentionConcurrentMapStripeCount);
+
+  for (int i = 0; i < 100; ++i) {
+    int value;
+    EXPECT_SUCCESS(map.Insert(make_pair(i, i * 2), value));
+  }
+  EXPECT_EQ(map.Size(), 100);
+
+  for (int i = 0; i < 100; ++i) {
+    int value;
+    EXPECT_SUCCESS(map.Find(i, value));
+    EXPECT_EQ(value, i * 2);
+  }
+
+  vector<int> keys;
+  EXPECT_SUCCESS(map.Keys(keys));
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ(keys.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(keys[i], i);
+  }
+
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_SUCCESS(map.Erase(i));
+  }
+  EXPECT_EQ(map.Size(), 50);
+}
+
+TEST_F(ConcurrentMapTests, ZeroStripesFallsBackToOne) {
+  ConcurrentMap<int, int> map(0);
+  EXPECT_EQ(map.StripeCount(), 1);
+
+  int value;
+  EXPECT_SUCCESS(map.Insert(make_pair(1, 1), value));
+  EXPECT_SUCCESS(map.Find(1, value));
+}
+
+TEST_F(ConcurrentMapTests, KeysWhileWriting) {
+  ConcurrentMap<Uuid, int, UuidCompare> map(
+      kHighContentionConcurrentMapStripeCount);
+  vector<Uuid> stable_keys;
+  for (int i = 0; i < 100; ++i) {
+    stable_keys.push_back(Uuid::GenerateUuid());
+    int value;
+    EXPECT_SUCCESS(map.Insert(make_pair(stable_keys.back(), i), value));
+  }
+
+  atomic<bool> stop(false);
+  vector<thread> writers;
+  for (int i = 0; i < 4; ++i) {
+    writers.emplace_back([&]() {
+      while (!stop) {
+        auto key = Uuid::GenerateUuid();
+        int value;
+        map.Insert(make_pair(key, 0), value);
+        map.Erase(key);
+      }
+    });
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    vector<Uuid> keys;
+    EXPECT_SUCCESS(map.Keys(keys));
+    EXPECT_GE(keys.size(), stable_keys.size());
+  }
+
+  stop = true;
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  EXPECT_EQ(map.Size(), stable_keys.size());
+}
 }  // namespace google::scp::core::common::test
@@ -18,27 +18,41 @@
 
 #include <atomic>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 #include "oneapi/tbb/concurrent_queue.h"
 
 #include "error_codes.h"
+#include "mpmc_ring_buffer.h"
 
 namespace google::scp::core::common {
+/// The implementations a ConcurrentQueue can be backed by.
+enum class ConcurrentQueueBackend {
+  /// tbb::concurrent_bounded_queue. Allocates as it grows, so it suits queues
+  /// whose max size is a loose upper bound.
+  Tbb = 0,
+  /// MpmcRingBuffer. Lock free and allocation free, but all of the max size
+  /// is allocated upfront.
+  RingBuffer = 1,
+};
+
 /**
  * @brief ConcurrentQueue provides multi producers and multi consumers queue
  * support to be used generically.
+ *
+ * @tparam T the element type.
+ * @tparam backend the queue implementation.
  */
-template <class T>
+template <class T,
+          ConcurrentQueueBackend backend = ConcurrentQueueBackend::Tbb>
 class ConcurrentQueue {
  public:
   /**
    * @brief Construct a new Concurrent Queue object
    * @param max_size Maximum size of the queue
    */
-  explicit ConcurrentQueue(size_t max_size)
-      : queue_(std::make_unique<tbb::concurrent_bounded_queue<T>>()) {
-    queue_->set_capacity(max_size);
-  }
+  explicit ConcurrentQueue(size_t max_size) : queue_(CreateQueue(max_size)) {}
 
   ConcurrentQueue() = delete;
 
@@ -48,7 +62,31 @@ class ConcurrentQueue {
    * @param element the element to be queued.
    */
   ExecutionResult TryEnqueue(const T& element) noexcept {
-    if (!queue_->try_push(element)) {
+    bool pushed;
+    if constexpr (backend == ConcurrentQueueBackend::RingBuffer) {
+      pushed = queue_->TryPush(element);
+    } else {
+      pushed = queue_->try_push(element);
+    }
+    if (!pushed) {
+      return FailureExecutionResult(errors::SC_CONCURRENT_QUEUE_CANNOT_ENQUEUE);
+    }
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Same as above, but moves the element into the queue. The element
+   * is left as is if it cannot be queued.
+   * @param element the element to be queued.
+   */
+  ExecutionResult TryEnqueue(T&& element) noexcept {
+    bool pushed;
+    if constexpr (backend == ConcurrentQueueBackend::RingBuffer) {
+      pushed = queue_->TryPush(std::move(element));
+    } else {
+      pushed = queue_->try_push(std::move(element));
+    }
+    if (!pushed) {
       return FailureExecutionResult(errors::SC_CONCURRENT_QUEUE_CANNOT_ENQUEUE);
     }
     return SuccessExecutionResult();
@@ -61,7 +99,40 @@ class ConcurrentQueue {
    * @return ExecutionResult result of the operation.
    */
   ExecutionResult TryDequeue(T& element) noexcept {
-    if (!queue_->try_pop(element)) {
+    bool popped;
+    if constexpr (backend == ConcurrentQueueBackend::RingBuffer) {
+      popped = queue_->TryPop(element);
+    } else {
+      popped = queue_->try_pop(element);
+    }
+    if (!popped) {
+      return FailureExecutionResult(errors::SC_CONCURRENT_QUEUE_CANNOT_DEQUEUE);
+    }
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Dequeues up to max_count elements that are already in the queue,
+   * without waiting for more. The ring buffer backend claims them in one
+   * operation.
+   * @param elements the dequeued elements are appended to it, oldest first.
+   * @param max_count the maximum number of elements to dequeue.
+   * @return ExecutionResult failure with the proper error code if no element
+   * was dequeued.
+   */
+  ExecutionResult TryDequeueBulk(std::vector<T>& elements,
+                                 size_t max_count) noexcept {
+    size_t count = 0;
+    if constexpr (backend == ConcurrentQueueBackend::RingBuffer) {
+      count = queue_->TryPopBulk(elements, max_count);
+    } else {
+      T element;
+      while (count < max_count && queue_->try_pop(element)) {
+        elements.push_back(std::move(element));
+        count++;
+      }
+    }
+    if (count == 0) {
       return FailureExecutionResult(errors::SC_CONCURRENT_QUEUE_CANNOT_DEQUEUE);
     }
     return SuccessExecutionResult();
@@ -72,10 +143,30 @@ class ConcurrentQueue {
    * the concurrent queue, this value will be approximate.
    * @return size_t number of elements in the queue.
    */
-  size_t Size() noexcept { return queue_->size(); }
+  size_t Size() noexcept {
+    if constexpr (backend == ConcurrentQueueBackend::RingBuffer) {
+      return queue_->Size();
+    } else {
+      return queue_->size();
+    }
+  }
 
  private:
+  using QueueImpl =
+      std::conditional_t<backend == ConcurrentQueueBackend::RingBuffer,
+                         MpmcRingBuffer<T>, tbb::concurrent_bounded_queue<T>>;
+
+  static std::unique_ptr<QueueImpl> CreateQueue(size_t max_size) {
+    if constexpr (backend == ConcurrentQueueBackend::RingBuffer) {
+      return std::make_unique<QueueImpl>(max_size);
+    } else {
+      auto queue = std::make_unique<QueueImpl>();
+      queue->set_capacity(max_size);
+      return queue;
+    }
+  }
+
   /// queue implementation.
-  std::unique_ptr<tbb::concurrent_bounded_queue<T>> queue_;
+  std::unique_ptr<QueueImpl> queue_;
 };
 }  // namespace google::scp::core::common
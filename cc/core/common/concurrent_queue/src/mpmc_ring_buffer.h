@@ -0,0 +1,253 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace google::scp::core::common {
+/// The assumed cache line size, used to keep the hot atomics apart.
+static constexpr size_t kMpmcRingBufferCacheLineSize = 64;
+
+/**
+ * @brief Bounded multi producers and multi consumers queue over a fixed array
+ * of cells (D. Vyukov's bounded MPMC queue). Each cell carries a sequence
+ * number telling whether it is free for the producer of a given lap or holds
+ * an element for the consumer of that lap, so producers and consumers only
+ * contend on their own position counter and never lock or allocate.
+ *
+ * All the cells are allocated upfront, so the capacity should be sized for
+ * the expected backlog rather than as an upper bound.
+ *
+ * @tparam T the element type. Must be default constructible; a dequeued cell
+ * keeps the moved-from element until it is reused.
+ */
+template <class T>
+class MpmcRingBuffer {
+ public:
+  /**
+   * @brief Construct a new Mpmc Ring Buffer object.
+   *
+   * @param capacity the maximum number of elements. A capacity of zero makes
+   * every push fail.
+   */
+  explicit MpmcRingBuffer(size_t capacity)
+      : capacity_(capacity),
+        is_power_of_two_capacity_(capacity != 0 &&
+                                  (capacity & (capacity - 1)) == 0),
+        cells_(std::make_unique<Cell[]>(capacity)) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(FreeSequence(i), std::memory_order_relaxed);
+    }
+    enqueue_position_.store(0, std::memory_order_relaxed);
+    dequeue_position_.store(0, std::memory_order_relaxed);
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+  MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+  /**
+   * @brief Pushes the element if the buffer is not full.
+   *
+   * @param element the element.
+   * @return true if the element was pushed.
+   */
+  bool TryPush(const T& element) noexcept { return Push(element); }
+
+  /// Same as above, but moves the element into the buffer.
+  bool TryPush(T&& element) noexcept { return Push(std::move(element)); }
+
+  /**
+   * @brief Pops the oldest element if there is one.
+   *
+   * @param element set to the popped element.
+   * @return true if an element was popped.
+   */
+  bool TryPop(T& element) noexcept {
+    if (capacity_ == 0) {
+      return false;
+    }
+
+    auto position = dequeue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[Index(position)];
+      auto sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) -
+                  static_cast<intptr_t>(FullSequence(position));
+      if (diff == 0) {
+        if (dequeue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The producer of this lap has not published the cell yet.
+        return false;
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    element = std::move(cell->element);
+    cell->sequence.store(FreeSequence(position + capacity_),
+                         std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pops up to max_count of the oldest elements with a single claim on
+   * the consumer position. Only the run of consecutive published elements is
+   * taken, so an element still being pushed ends the batch instead of being
+   * waited for.
+   *
+   * @param elements the popped elements are appended to it, oldest first.
+   * @param max_count the maximum number of elements to pop.
+   * @return size_t the number of popped elements.
+   */
+  size_t TryPopBulk(std::vector<T>& elements, size_t max_count) noexcept {
+    if (capacity_ == 0 || max_count == 0) {
+      return 0;
+    }
+    if (max_count > capacity_) {
+      max_count = capacity_;
+    }
+
+    auto position = dequeue_position_.load(std::memory_order_relaxed);
+    size_t count;
+    while (true) {
+      count = 0;
+      while (count < max_count &&
+             cells_[Index(position + count)].sequence.load(
+                 std::memory_order_acquire) == FullSequence(position + count)) {
+        ++count;
+      }
+
+      if (count > 0) {
+        if (dequeue_position_.compare_exchange_weak(
+                position, position + count, std::memory_order_relaxed)) {
+          break;
+        }
+        continue;
+      }
+
+      auto sequence =
+          cells_[Index(position)].sequence.load(std::memory_order_acquire);
+      if (static_cast<intptr_t>(sequence) -
+              static_cast<intptr_t>(FullSequence(position)) <
+          0) {
+        return 0;
+      }
+      position = dequeue_position_.load(std::memory_order_relaxed);
+    }
+
+    elements.reserve(elements.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      auto& cell = cells_[Index(position + i)];
+      elements.push_back(std::move(cell.element));
+      cell.sequence.store(FreeSequence(position + i + capacity_),
+                          std::memory_order_release);
+    }
+    return count;
+  }
+
+  /**
+   * @brief Returns the number of elements. Pushes and pops in flight make this
+   * value approximate.
+   */
+  size_t Size() const noexcept {
+    auto dequeue_position = dequeue_position_.load(std::memory_order_relaxed);
+    auto enqueue_position = enqueue_position_.load(std::memory_order_relaxed);
+    if (enqueue_position <= dequeue_position) {
+      return 0;
+    }
+    auto size = enqueue_position - dequeue_position;
+    return size > capacity_ ? capacity_ : size;
+  }
+
+  size_t Capacity() const noexcept { return capacity_; }
+
+ private:
+  struct Cell {
+    /// FreeSequence of the position the cell can be pushed at next, or
+    /// FullSequence of that position once it holds the element pushed there.
+    std::atomic<size_t> sequence;
+    T element;
+  };
+
+  /// Pushes the element, copied or moved into its cell.
+  template <class U>
+  bool Push(U&& element) noexcept {
+    if (capacity_ == 0) {
+      return false;
+    }
+
+    auto position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[Index(position)];
+      auto sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) -
+                  static_cast<intptr_t>(FreeSequence(position));
+      if (diff == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The cell still holds the element of the previous lap.
+        return false;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->element = std::forward<U>(element);
+    cell->sequence.store(FullSequence(position), std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * The sequences are doubled positions, odd once the cell is full, so that a
+   * full cell never looks free for the next lap. With the positions
+   * themselves, a single cell would be ambiguous.
+   */
+  static size_t FreeSequence(size_t position) noexcept { return position * 2; }
+
+  static size_t FullSequence(size_t position) noexcept {
+    return position * 2 + 1;
+  }
+
+  size_t Index(size_t position) const noexcept {
+    return is_power_of_two_capacity_ ? position & (capacity_ - 1)
+                                     : position % capacity_;
+  }
+
+  const size_t capacity_;
+  /// Power of two capacities index the cells with a mask instead of a modulo.
+  const bool is_power_of_two_capacity_;
+  std::unique_ptr<Cell[]> cells_;
+  /// The producer and consumer positions are on their own cache lines so
+  /// that producers and consumers do not invalidate each other's line. The
+  /// alignment also pads the end of the object.
+  alignas(kMpmcRingBufferCacheLineSize) std::atomic<size_t> enqueue_position_;
+  alignas(kMpmcRingBufferCacheLineSize) std::atomic<size_t> dequeue_position_;
+};
+}  // namespace google::scp::core::common
@@ -0,0 +1,125 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/common/concurrent_queue/src/concurrent_queue.h"
+
+namespace google::scp::core::common::test {
+
+static constexpr char kFailedEnqueuesKey[] = "failed_enqueues";
+static constexpr char kFailedDequeuesKey[] = "failed_dequeues";
+
+/**
+ * @brief Runs producers and consumers on a queue shared by the threads of the
+ * benchmark. The even threads produce and the odd threads consume; a single
+ * thread does both in turns.
+ *
+ * The benchmark arguments are the max size of the queue and the elements
+ * dequeued at once, 1 meaning TryDequeue and more meaning TryDequeueBulk.
+ *
+ * @tparam Queue the ConcurrentQueue instantiation.
+ */
+template <class Queue>
+class ConcurrentQueueFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    queue_ = std::make_unique<Queue>(state.range(0));
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    queue_ = nullptr;
+  }
+
+  void ProduceAndConsume(benchmark::State& state) {
+    size_t bulk_size = state.range(1);
+    bool is_producer = state.thread_index() % 2 == 0;
+    bool is_consumer = state.threads() == 1 || !is_producer;
+    std::vector<uint64_t> elements;
+    elements.reserve(bulk_size);
+    int64_t processed = 0;
+    int64_t failed_enqueues = 0;
+    int64_t failed_dequeues = 0;
+    uint64_t element = 0;
+    for (auto _ : state) {
+      if (is_producer) {
+        for (size_t i = 0; i < bulk_size; ++i) {
+          if (queue_->TryEnqueue(element++).Successful()) {
+            processed++;
+          } else {
+            failed_enqueues++;
+          }
+        }
+      }
+      if (!is_consumer) {
+        continue;
+      }
+      if (bulk_size == 1) {
+        if (queue_->TryDequeue(element).Successful()) {
+          processed++;
+        } else {
+          failed_dequeues++;
+        }
+        continue;
+      }
+      elements.clear();
+      if (queue_->TryDequeueBulk(elements, bulk_size).Successful()) {
+        processed += elements.size();
+      } else {
+        failed_dequeues++;
+      }
+    }
+    state.SetItemsProcessed(processed);
+    state.counters[kFailedEnqueuesKey] = failed_enqueues;
+    state.counters[kFailedDequeuesKey] = failed_dequeues;
+  }
+
+  std::unique_ptr<Queue> queue_;
+};
+
+BENCHMARK_TEMPLATE_DEFINE_F(ConcurrentQueueFixture, Tbb,
+                            ConcurrentQueue<uint64_t>)
+
+(benchmark::State& state) { ProduceAndConsume(state); }
+
+BENCHMARK_TEMPLATE_DEFINE_F(
+    ConcurrentQueueFixture, RingBuffer,
+    ConcurrentQueue<uint64_t, ConcurrentQueueBackend::RingBuffer>)
+
+(benchmark::State& state) { ProduceAndConsume(state); }
+
+// The max size of the queue and the elements dequeued at once.
+BENCHMARK_REGISTER_F(ConcurrentQueueFixture, Tbb)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {1, 32}})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK_REGISTER_F(ConcurrentQueueFixture, RingBuffer)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {1, 32}})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+}  // namespace google::scp::core::common::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
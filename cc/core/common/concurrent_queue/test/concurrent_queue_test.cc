@@ -27,6 +27,7 @@
 
 using google::scp::core::ExecutionResult;
 using google::scp::core::common::ConcurrentQueue;
+using google::scp::core::common::ConcurrentQueueBackend;
 using google::scp::core::test::ResultIs;
 using google::scp::core::test::ScpTestBase;
 
@@ -108,4 +109,133 @@ TEST_F(ConcurrentQueueTests, MultiThreadedEnqueue) {
   // the queue size should be empty after all thread done.
   EXPECT_EQ(queue.Size(), 0);
 }
+
+TEST_F(ConcurrentQueueTests, RingBufferErrorOnMaxSize) {
+  ConcurrentQueue<int, ConcurrentQueueBackend::RingBuffer> empty_queue(0);
+  EXPECT_THAT(empty_queue.TryEnqueue(1),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_QUEUE_CANNOT_ENQUEUE)));
+
+  // The capacity is exact, even if it is not a power of two.
+  ConcurrentQueue<int, ConcurrentQueueBackend::RingBuffer> queue(3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_SUCCESS(queue.TryEnqueue(i));
+  }
+  EXPECT_EQ(queue.Size(), 3);
+  EXPECT_THAT(queue.TryEnqueue(3),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_QUEUE_CANNOT_ENQUEUE)));
+}
+
+TEST_F(ConcurrentQueueTests, RingBufferWithASingleElement) {
+  ConcurrentQueue<int, ConcurrentQueueBackend::RingBuffer> queue(1);
+  int element;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_SUCCESS(queue.TryEnqueue(i));
+    EXPECT_THAT(queue.TryEnqueue(i),
+                ResultIs(FailureExecutionResult(
+                    errors::SC_CONCURRENT_QUEUE_CANNOT_ENQUEUE)));
+    EXPECT_SUCCESS(queue.TryDequeue(element));
+    EXPECT_EQ(element, i);
+    EXPECT_THAT(queue.TryDequeue(element),
+                ResultIs(FailureExecutionResult(
+                    errors::SC_CONCURRENT_QUEUE_CANNOT_DEQUEUE)));
+  }
+}
+
+TEST_F(ConcurrentQueueTests, RingBufferKeepsOrderAcrossLaps) {
+  ConcurrentQueue<int, ConcurrentQueueBackend::RingBuffer> queue(4);
+  int element;
+  EXPECT_THAT(queue.TryDequeue(element),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_QUEUE_CANNOT_DEQUEUE)));
+
+  int next_to_enqueue = 0;
+  int next_to_dequeue = 0;
+  for (int lap = 0; lap < 10; ++lap) {
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_SUCCESS(queue.TryEnqueue(next_to_enqueue++));
+    }
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_SUCCESS(queue.TryDequeue(element));
+      EXPECT_EQ(element, next_to_dequeue++);
+    }
+  }
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+template <ConcurrentQueueBackend backend>
+void TestDequeueBulk() {
+  ConcurrentQueue<int, backend> queue(10);
+  vector<int> elements;
+  EXPECT_THAT(queue.TryDequeueBulk(elements, 4),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_CONCURRENT_QUEUE_CANNOT_DEQUEUE)));
+
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_SUCCESS(queue.TryEnqueue(i));
+  }
+  EXPECT_SUCCESS(queue.TryDequeueBulk(elements, 4));
+  EXPECT_EQ(elements, vector<int>({0, 1, 2, 3}));
+
+  // Only what is there is dequeued, and appended to the elements.
+  EXPECT_SUCCESS(queue.TryDequeueBulk(elements, 4));
+  EXPECT_EQ(elements, vector<int>({0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+TEST_F(ConcurrentQueueTests, TryDequeueBulk) {
+  TestDequeueBulk<ConcurrentQueueBackend::Tbb>();
+  TestDequeueBulk<ConcurrentQueueBackend::RingBuffer>();
+}
+
+TEST_F(ConcurrentQueueTests, RingBufferMultiThreadedEnqueueAndBulkDequeue) {
+  constexpr int kProducerCount = 4;
+  constexpr int kElementsPerProducer = 20000;
+  constexpr int kElementCount = kProducerCount * kElementsPerProducer;
+  ConcurrentQueue<int, ConcurrentQueueBackend::RingBuffer> queue(64);
+  vector<atomic<uint8_t>> seen(kElementCount);
+  atomic<int> dequeued_count(0);
+
+  vector<thread> threads;
+  for (int p = 0; p < kProducerCount; ++p) {
+    threads.push_back(thread([p, &queue]() {
+      for (int i = 0; i < kElementsPerProducer; ++i) {
+        auto element = p * kElementsPerProducer + i;
+        while (!queue.TryEnqueue(element).Successful()) {
+          yield();
+        }
+      }
+    }));
+  }
+  for (int c = 0; c < 2; ++c) {
+    threads.push_back(thread([c, &queue, &seen, &dequeued_count]() {
+      vector<int> elements;
+      int element;
+      while (dequeued_count.load() < kElementCount) {
+        elements.clear();
+        if (c == 0) {
+          queue.TryDequeueBulk(elements, 16);
+        } else if (queue.TryDequeue(element).Successful()) {
+          elements.push_back(element);
+        }
+        if (elements.empty()) {
+          yield();
+          continue;
+        }
+        for (auto dequeued : elements) {
+          EXPECT_EQ(seen[dequeued].fetch_add(1), 0);
+        }
+        dequeued_count += elements.size();
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(dequeued_count.load(), kElementCount);
+  EXPECT_EQ(queue.Size(), 0);
+}
 }  // namespace google::scp::core::common::test
@@ -16,6 +16,7 @@
 
 #include "global_logger.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 
@@ -25,10 +26,6 @@ using std::unordered_set;
 
 namespace google::scp::core::common {
 static unique_ptr<LoggerInterface> logger_instance_;
-static unordered_set<LogLevel> enabled_log_levels_ = {
-    LogLevel::kAlert,     LogLevel::kCritical, LogLevel::kDebug,
-    LogLevel::kEmergency, LogLevel::kError,    LogLevel::kInfo,
-    LogLevel::kWarning};
 
 const unique_ptr<LoggerInterface>& GlobalLogger::GetGlobalLogger() {
   return logger_instance_;
@@ -36,14 +33,15 @@ const unique_ptr<LoggerInterface>& GlobalLogger::GetGlobalLogger() {
 
 void GlobalLogger::SetGlobalLogLevels(
     const unordered_set<LogLevel>& log_levels) {
-  enabled_log_levels_ = log_levels;
+  uint32_t enabled_log_levels_mask = 0;
+  for (auto log_level : log_levels) {
+    enabled_log_levels_mask |= ToMask(log_level);
+  }
+  enabled_log_levels_mask_.store(enabled_log_levels_mask,
+                                 std::memory_order_relaxed);
 }
 
 void GlobalLogger::SetGlobalLogger(unique_ptr<LoggerInterface> logger) {
   logger_instance_ = move(logger);
 }
-
-bool GlobalLogger::IsLogLevelEnabled(const LogLevel log_level) {
-  return enabled_log_levels_.find(log_level) != enabled_log_levels_.end();
-}
 }  // namespace google::scp::core::common
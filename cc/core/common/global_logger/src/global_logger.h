@@ -15,7 +15,9 @@
  */
 #pragma once
 
+#include <atomic>
 #include <cstdarg>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -23,17 +25,105 @@
 #include "core/interface/errors.h"
 #include "core/interface/logger_interface.h"
 
+/**
+ * The severity ranks of the log levels, from the most severe to the most
+ * verbose. Unlike the values of LogLevel, they order debug after info.
+ */
+#define SCP_LOG_LEVEL_EMERGENCY 0
+#define SCP_LOG_LEVEL_ALERT 1
+#define SCP_LOG_LEVEL_CRITICAL 2
+#define SCP_LOG_LEVEL_ERROR 3
+#define SCP_LOG_LEVEL_WARNING 4
+#define SCP_LOG_LEVEL_INFO 5
+#define SCP_LOG_LEVEL_DEBUG 6
+
+/**
+ * The severity rank of the most verbose level compiled in, either as a number
+ * or as one of the SCP_LOG_LEVEL_* names. The logs of the more verbose levels
+ * are compiled out of the SCP_* macros, along with their arguments. E.g.
+ * building with -DSCP_MAX_LOG_LEVEL=SCP_LOG_LEVEL_INFO strips the debug logs.
+ * All the levels are compiled in by default.
+ */
+#ifndef SCP_MAX_LOG_LEVEL
+#define SCP_MAX_LOG_LEVEL SCP_LOG_LEVEL_DEBUG
+#endif
+
 namespace google::scp::core::common {
+/// Returns the SCP_LOG_LEVEL_* severity rank of the level. kNone ranks after
+/// all the levels, so it is never compiled in.
+constexpr int GetLogLevelSeverityRank(const LogLevel log_level) {
+  switch (log_level) {
+    case LogLevel::kEmergency:
+      return SCP_LOG_LEVEL_EMERGENCY;
+    case LogLevel::kAlert:
+      return SCP_LOG_LEVEL_ALERT;
+    case LogLevel::kCritical:
+      return SCP_LOG_LEVEL_CRITICAL;
+    case LogLevel::kError:
+      return SCP_LOG_LEVEL_ERROR;
+    case LogLevel::kWarning:
+      return SCP_LOG_LEVEL_WARNING;
+    case LogLevel::kInfo:
+      return SCP_LOG_LEVEL_INFO;
+    case LogLevel::kDebug:
+      return SCP_LOG_LEVEL_DEBUG;
+    default:
+      return SCP_LOG_LEVEL_DEBUG + 1;
+  }
+}
+
 class GlobalLogger {
  public:
   static const std::unique_ptr<core::LoggerInterface>& GetGlobalLogger();
-  static bool IsLogLevelEnabled(const LogLevel log_level);
+
+  /// Whether the level is enabled. Lock free, so that the disabled logs cost
+  /// a single load.
+  static bool IsLogLevelEnabled(const LogLevel log_level) {
+    return (enabled_log_levels_mask_.load(std::memory_order_relaxed) &
+            ToMask(log_level)) != 0;
+  }
+
+  /// Whether the level is enabled and a global logger is set.
+  static bool ShouldLog(const LogLevel log_level) {
+    return IsLogLevelEnabled(log_level) && GetGlobalLogger();
+  }
+
   static void SetGlobalLogLevels(
       const std::unordered_set<LogLevel>& log_levels);
   static void SetGlobalLogger(std::unique_ptr<core::LoggerInterface> logger);
+
+ protected:
+  /// Returns the bit of the level in enabled_log_levels_mask_. kEmergency is
+  /// 0 and the other levels are powers of two, hence the shift.
+  static constexpr uint32_t ToMask(const LogLevel log_level) {
+    return log_level == LogLevel::kEmergency
+               ? 1u
+               : static_cast<uint32_t>(log_level) << 1;
+  }
+
+  /// The enabled levels, one bit per level. All the levels but kNone are
+  /// enabled by default.
+  static inline std::atomic<uint32_t> enabled_log_levels_mask_{
+      ToMask(LogLevel::kEmergency) | ToMask(LogLevel::kAlert) |
+      ToMask(LogLevel::kCritical) | ToMask(LogLevel::kError) |
+      ToMask(LogLevel::kWarning) | ToMask(LogLevel::kDebug) |
+      ToMask(LogLevel::kInfo)};
 };
 }  // namespace google::scp::core::common
 
+/// Whether the level is compiled in. A constant expression, so that the
+/// compiler drops the logs of the levels compiled out.
+#define SCP_IS_LOG_LEVEL_COMPILED_IN(log_level)                      \
+  (google::scp::core::common::GetLogLevelSeverityRank(log_level) <= \
+   (SCP_MAX_LOG_LEVEL))
+
+/// Whether the logs of the level are written. The arguments of the SCP_*
+/// macros are only evaluated when it holds, so it is only needed to guard the
+/// work done for the logs outside of them.
+#define SCP_IS_LOG_LEVEL_ENABLED(log_level)   \
+  (SCP_IS_LOG_LEVEL_COMPILED_IN(log_level) && \
+   google::scp::core::common::GlobalLogger::ShouldLog(log_level))
+
 #define SCP_LOCATION                                                        \
   (std::string(__FILE__) + ":" + __func__ + ":" + std::to_string(__LINE__)) \
       .c_str()
@@ -50,9 +140,7 @@ class GlobalLogger {
 
 #define __SCP_INFO_LOG(component_name, correlation_id, parent_activity_id, \
                        activity_id, message, ...)                          \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&        \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(          \
-          google::scp::core::LogLevel::kInfo)) {                           \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kInfo)) {      \
     google::scp::core::common::GlobalLogger::GetGlobalLogger()->Info(      \
         component_name, correlation_id, parent_activity_id, activity_id,   \
         SCP_LOCATION, message, ##__VA_ARGS__);                             \
@@ -70,9 +158,7 @@ class GlobalLogger {
 
 #define __SCP_DEBUG_LOG(component_name, correlation_id, parent_activity_id, \
                         activity_id, message, ...)                          \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&         \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(           \
-          google::scp::core::LogLevel::kDebug)) {                           \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kDebug)) {      \
     google::scp::core::common::GlobalLogger::GetGlobalLogger()->Debug(      \
         component_name, correlation_id, parent_activity_id, activity_id,    \
         SCP_LOCATION, message, ##__VA_ARGS__);                              \
@@ -90,9 +176,7 @@ class GlobalLogger {
 
 #define __SCP_WARNING_LOG(component_name, correlation_id, parent_activity_id, \
                           activity_id, message, ...)                          \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&           \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(             \
-          google::scp::core::LogLevel::kWarning)) {                           \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kWarning)) {      \
     google::scp::core::common::GlobalLogger::GetGlobalLogger()->Warning(      \
         component_name, correlation_id, parent_activity_id, activity_id,      \
         SCP_LOCATION, message, ##__VA_ARGS__);                                \
@@ -111,9 +195,7 @@ class GlobalLogger {
 
 #define __SCP_ERROR_LOG(component_name, correlation_id, parent_activity_id, \
                         activity_id, execution_result, message, ...)        \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&         \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(           \
-          google::scp::core::LogLevel::kError)) {                           \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kError)) {      \
     auto message_with_error = std::string(message) +                        \
                               std::string(" Failed with: ") +               \
                               google::scp::core::errors::GetErrorMessage(   \
@@ -138,9 +220,7 @@ class GlobalLogger {
 
 #define __SCP_CRITICAL_LOG(component_name, correlation_id, parent_activity_id, \
                            activity_id, execution_result, message, ...)        \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&            \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(              \
-          google::scp::core::LogLevel::kCritical)) {                           \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kCritical)) {      \
     auto message_with_error = std::string(message) +                           \
                               std::string(" Failed with: ") +                  \
                               google::scp::core::errors::GetErrorMessage(      \
@@ -163,9 +243,7 @@ class GlobalLogger {
 
 #define __SCP_ALERT_LOG(component_name, correlation_id, parent_activity_id, \
                         activity_id, execution_result, message, ...)        \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&         \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(           \
-          google::scp::core::LogLevel::kAlert)) {                           \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kAlert)) {      \
     auto message_with_error = std::string(message) +                        \
                               std::string(" Failed with: ") +               \
                               google::scp::core::errors::GetErrorMessage(   \
@@ -191,9 +269,7 @@ class GlobalLogger {
 #define __SCP_EMERGENCY_LOG(component_name, correlation_id,                    \
                             parent_activity_id, activity_id, execution_result, \
                             message, ...)                                      \
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&            \
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(              \
-          google::scp::core::LogLevel::kEmergency)) {                          \
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kEmergency)) {     \
     auto message_with_error = std::string(message) +                           \
                               std::string(" Failed with: ") +                  \
                               google::scp::core::errors::GetErrorMessage(      \
@@ -0,0 +1,145 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/common/global_logger/src/global_logger.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+#include "core/common/uuid/src/uuid.h"
+#include "core/logger/mock/mock_logger.h"
+
+using google::scp::core::LogLevel;
+using google::scp::core::common::GetLogLevelSeverityRank;
+using google::scp::core::common::GlobalLogger;
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::logger::mock::MockLogger;
+using std::make_unique;
+using std::unordered_set;
+
+namespace google::scp::core::test {
+namespace {
+constexpr LogLevel kLogLevels[] = {
+    LogLevel::kEmergency, LogLevel::kAlert, LogLevel::kCritical,
+    LogLevel::kError,     LogLevel::kWarning, LogLevel::kInfo,
+    LogLevel::kDebug};
+
+class GlobalLoggerWithOverrides : public GlobalLogger {
+ public:
+  using GlobalLogger::ToMask;
+
+  static uint32_t GetEnabledLogLevelsMask() {
+    return enabled_log_levels_mask_.load();
+  }
+};
+
+class GlobalLoggerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    auto logger = make_unique<MockLogger>();
+    logger_ = logger.get();
+    GlobalLogger::SetGlobalLogger(std::move(logger));
+  }
+
+  void TearDown() override {
+    GlobalLogger::SetGlobalLogger(nullptr);
+    GlobalLogger::SetGlobalLogLevels(
+        unordered_set<LogLevel>(std::begin(kLogLevels), std::end(kLogLevels)));
+  }
+
+  MockLogger* logger_;
+};
+
+int CountEvaluation(int& evaluation_count) {
+  return ++evaluation_count;
+}
+
+TEST_F(GlobalLoggerTest, ToMaskMapsEachLevelToItsOwnBit) {
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kEmergency), 1u);
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kAlert), 2u);
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kCritical), 4u);
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kError), 8u);
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kWarning), 16u);
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kDebug), 32u);
+  EXPECT_EQ(GlobalLoggerWithOverrides::ToMask(LogLevel::kInfo), 64u);
+}
+
+TEST_F(GlobalLoggerTest, SetGlobalLogLevelsSetsTheBitsOfTheLevels) {
+  GlobalLogger::SetGlobalLogLevels({LogLevel::kEmergency, LogLevel::kError,
+                                    LogLevel::kInfo});
+  EXPECT_EQ(GlobalLoggerWithOverrides::GetEnabledLogLevelsMask(),
+            1u | 8u | 64u);
+
+  GlobalLogger::SetGlobalLogLevels({});
+  EXPECT_EQ(GlobalLoggerWithOverrides::GetEnabledLogLevelsMask(), 0u);
+}
+
+TEST_F(GlobalLoggerTest, IsLogLevelEnabledOnlyForTheSetLevels) {
+  for (auto log_level : kLogLevels) {
+    GlobalLogger::SetGlobalLogLevels({log_level});
+    for (auto other_log_level : kLogLevels) {
+      EXPECT_EQ(GlobalLogger::IsLogLevelEnabled(other_log_level),
+                other_log_level == log_level);
+    }
+  }
+}
+
+TEST_F(GlobalLoggerTest, SeverityRankOrdersDebugAfterInfo) {
+  for (size_t i = 1; i < std::size(kLogLevels); ++i) {
+    EXPECT_LT(GetLogLevelSeverityRank(kLogLevels[i - 1]),
+              GetLogLevelSeverityRank(kLogLevels[i]));
+  }
+  EXPECT_GT(GetLogLevelSeverityRank(LogLevel::kNone),
+            GetLogLevelSeverityRank(LogLevel::kDebug));
+}
+
+TEST_F(GlobalLoggerTest, DisabledLevelDoesNotEvaluateTheArguments) {
+  GlobalLogger::SetGlobalLogLevels({LogLevel::kWarning});
+  int evaluation_count = 0;
+  SCP_INFO("GlobalLoggerTest", kZeroUuid, "Message %d",
+           CountEvaluation(evaluation_count));
+  EXPECT_EQ(evaluation_count, 0);
+  EXPECT_TRUE(logger_->GetMessages().empty());
+
+  SCP_WARNING("GlobalLoggerTest", kZeroUuid, "Message %d",
+              CountEvaluation(evaluation_count));
+  EXPECT_EQ(evaluation_count, 1);
+  EXPECT_EQ(logger_->GetMessages().size(), 1);
+}
+
+TEST_F(GlobalLoggerTest, CompiledOutLevelNeverReachesTheLogger) {
+  // The test is built with -DSCP_MAX_LOG_LEVEL=SCP_LOG_LEVEL_INFO.
+  static_assert(!SCP_IS_LOG_LEVEL_COMPILED_IN(LogLevel::kDebug));
+  static_assert(SCP_IS_LOG_LEVEL_COMPILED_IN(LogLevel::kInfo));
+  static_assert(SCP_IS_LOG_LEVEL_COMPILED_IN(LogLevel::kEmergency));
+
+  int evaluation_count = 0;
+  EXPECT_TRUE(GlobalLogger::IsLogLevelEnabled(LogLevel::kDebug));
+  SCP_DEBUG("GlobalLoggerTest", kZeroUuid, "Message %d",
+            CountEvaluation(evaluation_count));
+  EXPECT_EQ(evaluation_count, 0);
+  EXPECT_TRUE(logger_->GetMessages().empty());
+
+  SCP_INFO("GlobalLoggerTest", kZeroUuid, "Message %d",
+           CountEvaluation(evaluation_count));
+  EXPECT_EQ(evaluation_count, 1);
+  EXPECT_EQ(logger_->GetMessages().size(), 1);
+}
+}  // namespace
+}  // namespace google::scp::core::test
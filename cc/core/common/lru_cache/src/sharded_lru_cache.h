@@ -0,0 +1,318 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+
+namespace google::scp::core::common {
+/// The default number of shards of a ShardedLruCache.
+static constexpr size_t kDefaultLruCacheShardCount = 16;
+
+/// How a ShardedLruCache picks the element to evict.
+enum class LruCacheEvictionPolicy {
+  /// Evicts the least recently used element. Every lookup reorders the shard,
+  /// so lookups take the shard lock exclusively.
+  Lru = 0,
+  /// Approximates LRU with a second chance queue: a lookup only marks the
+  /// element as referenced, and the eviction skips the referenced elements
+  /// once. Lookups only take the shard lock shared.
+  Clock = 1,
+};
+
+/**
+ * @brief Least Recently Used (LRU) cache split into independently locked
+ * shards by key hash, for the caches hit by many threads. Each shard evicts on
+ * its own once it holds its share of the capacity.
+ *
+ * The values are kept behind shared pointers so that lookups hand out a
+ * reference to the value instead of copying it under the lock.
+ *
+ * @tparam TKey
+ * @tparam TVal
+ * @tparam THash the hash of the keys.
+ */
+template <typename TKey, typename TVal, typename THash = absl::Hash<TKey>>
+class ShardedLruCache {
+ public:
+  /**
+   * @brief Construct a new Sharded Lru Cache object.
+   *
+   * @param capacity the maximum number of elements of the cache, spread
+   * evenly over the shards. It is rounded up to a multiple of the shard count.
+   * @param shard_count the number of shards. At least 1.
+   * @param eviction_policy how the elements to evict are picked.
+   */
+  explicit ShardedLruCache(
+      size_t capacity, size_t shard_count = kDefaultLruCacheShardCount,
+      LruCacheEvictionPolicy eviction_policy = LruCacheEvictionPolicy::Lru)
+      : shard_count_(shard_count == 0 ? 1 : shard_count),
+        shard_capacity_((capacity + shard_count_ - 1) / shard_count_),
+        eviction_policy_(eviction_policy),
+        shards_(std::make_unique<Shard[]>(shard_count_)) {}
+
+  ShardedLruCache(const ShardedLruCache&) = delete;
+  ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+  /**
+   * @brief Inserts or replaces the value of the key, and marks it as the most
+   * recently used element of its shard.
+   *
+   * @param key the key.
+   * @param value the value.
+   */
+  void Set(const TKey& key, TVal value) {
+    auto shared_value = std::make_shared<const TVal>(std::move(value));
+    auto& shard = GetShard(key);
+    std::unique_lock lock(shard.mutex);
+
+    auto it = shard.nodes.find(key);
+    if (it != shard.nodes.end()) {
+      auto* node = it->second.get();
+      node->value = std::move(shared_value);
+      shard.MoveToFront(node);
+      return;
+    }
+
+    if (shard_capacity_ == 0) {
+      return;
+    }
+    if (shard.nodes.size() >= shard_capacity_) {
+      EvictOne(shard);
+    }
+
+    auto node = std::make_unique<Node>(key, std::move(shared_value));
+    shard.PushFront(node.get());
+    shard.nodes.emplace(key, std::move(node));
+  }
+
+  /**
+   * @brief Looks the key up and marks it as recently used.
+   *
+   * @param key the key.
+   * @return std::shared_ptr<const TVal> the value, or nullptr if the key is not
+   * cached.
+   */
+  std::shared_ptr<const TVal> Get(const TKey& key) {
+    auto& shard = GetShard(key);
+    if (eviction_policy_ == LruCacheEvictionPolicy::Clock) {
+      std::shared_lock lock(shard.mutex);
+      auto it = shard.nodes.find(key);
+      if (it == shard.nodes.end()) {
+        return nullptr;
+      }
+      it->second->referenced.store(true, std::memory_order_relaxed);
+      return it->second->value;
+    }
+
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.nodes.find(key);
+    if (it == shard.nodes.end()) {
+      return nullptr;
+    }
+    shard.MoveToFront(it->second.get());
+    return it->second->value;
+  }
+
+  /**
+   * @brief Removes the key from the cache.
+   *
+   * @param key the key.
+   * @return true if the key was cached.
+   */
+  bool Erase(const TKey& key) {
+    auto& shard = GetShard(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.nodes.find(key);
+    if (it == shard.nodes.end()) {
+      return false;
+    }
+    shard.Unlink(it->second.get());
+    shard.nodes.erase(it);
+    return true;
+  }
+
+  /// Returns true if the key is cached, without marking it as used.
+  bool Contains(const TKey& key) {
+    auto& shard = GetShard(key);
+    std::shared_lock lock(shard.mutex);
+    return shard.nodes.contains(key);
+  }
+
+  size_t Size() {
+    size_t size = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      std::shared_lock lock(shards_[i].mutex);
+      size += shards_[i].nodes.size();
+    }
+    return size;
+  }
+
+  /// Returns the maximum number of elements, which is the sum of the shard
+  /// capacities.
+  size_t Capacity() { return shard_capacity_ * shard_count_; }
+
+  size_t ShardCount() { return shard_count_; }
+
+  void Clear() {
+    for (size_t i = 0; i < shard_count_; ++i) {
+      std::unique_lock lock(shards_[i].mutex);
+      shards_[i].nodes.clear();
+      shards_[i].head = nullptr;
+      shards_[i].tail = nullptr;
+    }
+  }
+
+  /**
+   * @brief Visits all the elements without copying them and without marking
+   * them as used. The shards are visited one at a time under their shared
+   * lock, so the visitor must not call into the cache.
+   *
+   * @param visitor called with each key and value.
+   */
+  void ForEach(
+      const std::function<void(const TKey&, const TVal&)>& visitor) const {
+    for (size_t i = 0; i < shard_count_; ++i) {
+      std::shared_lock lock(shards_[i].mutex);
+      for (auto& [key, node] : shards_[i].nodes) {
+        visitor(key, *node->value);
+      }
+    }
+  }
+
+  /**
+   * @brief Returns all the elements. Only the shared pointers to the values
+   * are copied.
+   */
+  absl::flat_hash_map<TKey, std::shared_ptr<const TVal>, THash> GetAll() const {
+    absl::flat_hash_map<TKey, std::shared_ptr<const TVal>, THash> result;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      std::shared_lock lock(shards_[i].mutex);
+      for (auto& [key, node] : shards_[i].nodes) {
+        result.emplace(key, node->value);
+      }
+    }
+    return result;
+  }
+
+ private:
+  /// An element of a shard, linked in the shard's intrusive list.
+  struct Node {
+    Node(const TKey& key, std::shared_ptr<const TVal> value)
+        : key(key), value(std::move(value)), referenced(false) {}
+
+    const TKey key;
+    std::shared_ptr<const TVal> value;
+    Node* prev = nullptr;
+    Node* next = nullptr;
+    /// Set by the lookups of the Clock policy, cleared by the eviction.
+    std::atomic<bool> referenced;
+  };
+
+  /**
+   * @brief A part of the cache with its own lock. Fresh elements are at the
+   * head of the list, and the eviction candidate is at the tail.
+   */
+  struct Shard {
+    void PushFront(Node* node) noexcept {
+      node->prev = nullptr;
+      node->next = head;
+      if (head != nullptr) {
+        head->prev = node;
+      }
+      head = node;
+      if (tail == nullptr) {
+        tail = node;
+      }
+    }
+
+    void Unlink(Node* node) noexcept {
+      if (node->prev != nullptr) {
+        node->prev->next = node->next;
+      } else {
+        head = node->next;
+      }
+      if (node->next != nullptr) {
+        node->next->prev = node->prev;
+      } else {
+        tail = node->prev;
+      }
+      node->prev = nullptr;
+      node->next = nullptr;
+    }
+
+    void MoveToFront(Node* node) noexcept {
+      if (head == node) {
+        return;
+      }
+      Unlink(node);
+      PushFront(node);
+    }
+
+    mutable std::shared_mutex mutex;
+    absl::flat_hash_map<TKey, std::unique_ptr<Node>, THash> nodes;
+    Node* head = nullptr;
+    Node* tail = nullptr;
+  };
+
+  /// Evicts one element of the shard. The shard lock must be held.
+  void EvictOne(Shard& shard) noexcept {
+    if (eviction_policy_ == LruCacheEvictionPolicy::Clock) {
+      // Every referenced element gets a second chance, so this stops after at
+      // most one pass over the shard.
+      while (shard.tail != shard.head &&
+             shard.tail->referenced.exchange(false,
+                                             std::memory_order_relaxed)) {
+        shard.MoveToFront(shard.tail);
+      }
+    }
+
+    auto* victim = shard.tail;
+    if (victim == nullptr) {
+      return;
+    }
+    shard.Unlink(victim);
+    shard.nodes.erase(victim->key);
+  }
+
+  /**
+   * @brief Returns the shard of the key. The hash is mixed before picking the
+   * shard so that the shard maps do not all see the same low hash bits.
+   */
+  Shard& GetShard(const TKey& key) const {
+    if (shard_count_ == 1) {
+      return shards_[0];
+    }
+    uint64_t hash = static_cast<uint64_t>(THash()(key));
+    return shards_[((hash * 0x9E3779B97F4A7C15ull) >> 32) % shard_count_];
+  }
+
+  const size_t shard_count_;
+  /// The maximum number of elements of each shard.
+  const size_t shard_capacity_;
+  const LruCacheEvictionPolicy eviction_policy_;
+  std::unique_ptr<Shard[]> shards_;
+};
+}  // namespace google::scp::core::common
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "core/common/lru_cache/src/lru_cache.h"
+#include "core/common/lru_cache/src/sharded_lru_cache.h"
+
+namespace google::scp::core::common::test {
+
+static constexpr char kHitRatioKey[] = "hit_ratio";
+
+/**
+ * @brief Runs gets and sets on an LruCache shared by the threads of the
+ * benchmark. The cache holds every key, as its Get inserts the keys it misses.
+ *
+ * The benchmark arguments are the percentage of gets and the number of keys.
+ */
+class LruCacheFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    key_count_ = state.range(1);
+    cache_ = std::make_unique<LruCache<uint64_t, uint64_t>>(key_count_);
+    for (uint64_t key = 0; key < key_count_; ++key) {
+      cache_->Set(key, key);
+    }
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    cache_ = nullptr;
+  }
+
+  std::unique_ptr<LruCache<uint64_t, uint64_t>> cache_;
+  uint64_t key_count_ = 0;
+};
+
+BENCHMARK_DEFINE_F(LruCacheFixture, GetSet)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  std::uniform_int_distribution<uint64_t> key_distribution(0, key_count_ - 1);
+  std::uniform_int_distribution<int64_t> operation_distribution(0, 99);
+  auto get_percentage = state.range(0);
+  for (auto _ : state) {
+    auto key = key_distribution(random);
+    if (operation_distribution(random) < get_percentage) {
+      benchmark::DoNotOptimize(cache_->Get(key));
+    } else {
+      cache_->Set(key, key);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Read heavy, mixed and write heavy; and the keys.
+BENCHMARK_REGISTER_F(LruCacheFixture, GetSet)
+    ->ArgsProduct({{95, 50, 5}, {1 << 10, 1 << 16}})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+/**
+ * @brief Runs gets and sets on a ShardedLruCache shared by the threads of the
+ * benchmark. The cache holds half of the keys, so that the sets keep evicting.
+ *
+ * The benchmark arguments are the percentage of gets, the number of keys, the
+ * shard count and the eviction policy.
+ */
+class ShardedLruCacheFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    key_count_ = state.range(1);
+    cache_ = std::make_unique<ShardedLruCache<uint64_t, uint64_t>>(
+        key_count_ / 2, state.range(2),
+        static_cast<LruCacheEvictionPolicy>(state.range(3)));
+    for (uint64_t key = 0; key < key_count_; key += 2) {
+      cache_->Set(key, key);
+    }
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    cache_ = nullptr;
+  }
+
+  std::unique_ptr<ShardedLruCache<uint64_t, uint64_t>> cache_;
+  uint64_t key_count_ = 0;
+};
+
+BENCHMARK_DEFINE_F(ShardedLruCacheFixture, GetSet)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  std::uniform_int_distribution<uint64_t> key_distribution(0, key_count_ - 1);
+  std::uniform_int_distribution<int64_t> operation_distribution(0, 99);
+  auto get_percentage = state.range(0);
+  int64_t gets = 0;
+  int64_t hits = 0;
+  for (auto _ : state) {
+    auto key = key_distribution(random);
+    if (operation_distribution(random) < get_percentage) {
+      gets++;
+      if (cache_->Get(key) != nullptr) {
+        hits++;
+      }
+    } else {
+      cache_->Set(key, key);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters[kHitRatioKey] = benchmark::Counter(
+      gets == 0 ? 0 : static_cast<double>(hits) / gets,
+      benchmark::Counter::kAvgThreads);
+}
+
+// Read heavy, mixed and write heavy; the keys; the shards; and LRU or CLOCK
+// eviction.
+BENCHMARK_REGISTER_F(ShardedLruCacheFixture, GetSet)
+    ->ArgsProduct({{95, 50, 5},
+                   {1 << 10, 1 << 16},
+                   {1, 16},
+                   {static_cast<int64_t>(LruCacheEvictionPolicy::Lru),
+                    static_cast<int64_t>(LruCacheEvictionPolicy::Clock)}})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+}  // namespace google::scp::core::common::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
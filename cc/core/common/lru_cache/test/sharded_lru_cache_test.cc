@@ -0,0 +1,211 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/common/lru_cache/src/sharded_lru_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::atomic;
+using std::string;
+using std::thread;
+using std::to_string;
+using std::vector;
+
+namespace google::scp::core::common::test {
+TEST(ShardedLruCacheTest, CanAddAndGetElement) {
+  ShardedLruCache<string, string> cache(10);
+  cache.Set("Some Key", "Some value");
+
+  EXPECT_TRUE(cache.Contains("Some Key"));
+  auto read_value = cache.Get("Some Key");
+  ASSERT_NE(read_value, nullptr);
+  EXPECT_EQ(*read_value, "Some value");
+
+  EXPECT_EQ(cache.Get("Other Key"), nullptr);
+}
+
+TEST(ShardedLruCacheTest, ShouldBeAbleToReplaceAndEraseValues) {
+  ShardedLruCache<string, string> cache(10);
+  cache.Set("Key1", "Value1");
+  auto old_value = cache.Get("Key1");
+  cache.Set("Key1", "NewValue1");
+
+  EXPECT_EQ(*cache.Get("Key1"), "NewValue1");
+  // Values handed out stay valid after being replaced.
+  EXPECT_EQ(*old_value, "Value1");
+  EXPECT_EQ(cache.Size(), 1);
+
+  EXPECT_TRUE(cache.Erase("Key1"));
+  EXPECT_FALSE(cache.Erase("Key1"));
+  EXPECT_FALSE(cache.Contains("Key1"));
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+TEST(ShardedLruCacheTest, ClearShouldEmptyCache) {
+  ShardedLruCache<int, int> cache(100, 4);
+  for (int i = 0; i < 50; i++) {
+    cache.Set(i, i);
+  }
+  EXPECT_EQ(cache.Size(), 50);
+
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0);
+
+  cache.Set(1, 1);
+  EXPECT_EQ(*cache.Get(1), 1);
+}
+
+TEST(ShardedLruCacheTest, ShouldNotExceedCapacity) {
+  ShardedLruCache<int, int> cache(64, 4);
+  EXPECT_EQ(cache.ShardCount(), 4);
+  for (int i = 0; i < 1000; i++) {
+    cache.Set(i, i);
+  }
+  EXPECT_LE(cache.Size(), cache.Capacity());
+  // The most recent element is always kept.
+  EXPECT_TRUE(cache.Contains(999));
+}
+
+TEST(ShardedLruCacheTest, CapacityShouldBeTheSumOfTheShardCapacities) {
+  ShardedLruCache<int, int> cache(10, 4);
+  EXPECT_EQ(cache.Capacity(), 12);
+  for (int i = 0; i < 1000; i++) {
+    cache.Set(i, i);
+  }
+  EXPECT_LE(cache.Size(), cache.Capacity());
+
+  EXPECT_EQ((ShardedLruCache<int, int>(64, 4).Capacity()), 64);
+  EXPECT_EQ((ShardedLruCache<int, int>(0, 4).Capacity()), 0);
+}
+
+TEST(ShardedLruCacheTest, LruPolicyShouldBeAffectedByGets) {
+  ShardedLruCache<string, string> cache(2, 1);
+  cache.Set("Key1", "Value1");
+  cache.Set("Key2", "Value2");
+
+  // Touch key1 so that key2 is the least recently used.
+  EXPECT_EQ(*cache.Get("Key1"), "Value1");
+  cache.Set("Key3", "Value3");
+
+  EXPECT_FALSE(cache.Contains("Key2"));
+  EXPECT_TRUE(cache.Contains("Key1"));
+  EXPECT_TRUE(cache.Contains("Key3"));
+}
+
+TEST(ShardedLruCacheTest, LruPolicyShouldBeAffectedBySets) {
+  ShardedLruCache<string, string> cache(2, 1);
+  cache.Set("Key1", "Value1");
+  cache.Set("Key2", "Value2");
+
+  cache.Set("Key1", "NewValue1");
+  cache.Set("Key3", "Value3");
+
+  EXPECT_FALSE(cache.Contains("Key2"));
+  EXPECT_TRUE(cache.Contains("Key1"));
+  EXPECT_TRUE(cache.Contains("Key3"));
+}
+
+TEST(ShardedLruCacheTest, ClockPolicyGivesReferencedElementsASecondChance) {
+  ShardedLruCache<string, string> cache(3, 1, LruCacheEvictionPolicy::Clock);
+  cache.Set("Key1", "Value1");
+  cache.Set("Key2", "Value2");
+  cache.Set("Key3", "Value3");
+
+  // Key1 is the oldest, but it is referenced so key2 is evicted instead.
+  EXPECT_EQ(*cache.Get("Key1"), "Value1");
+  cache.Set("Key4", "Value4");
+
+  EXPECT_TRUE(cache.Contains("Key1"));
+  EXPECT_FALSE(cache.Contains("Key2"));
+  EXPECT_TRUE(cache.Contains("Key3"));
+  EXPECT_TRUE(cache.Contains("Key4"));
+
+  // Key1 used its second chance, so it goes right after key3.
+  cache.Set("Key5", "Value5");
+  EXPECT_FALSE(cache.Contains("Key3"));
+  EXPECT_TRUE(cache.Contains("Key1"));
+  cache.Set("Key6", "Value6");
+  EXPECT_FALSE(cache.Contains("Key1"));
+}
+
+TEST(ShardedLruCacheTest, ClockPolicyEvictsWhenAllElementsAreReferenced) {
+  ShardedLruCache<int, int> cache(3, 1, LruCacheEvictionPolicy::Clock);
+  for (int i = 0; i < 3; i++) {
+    cache.Set(i, i);
+    cache.Get(i);
+  }
+
+  cache.Set(3, 3);
+  EXPECT_EQ(cache.Size(), 3);
+  EXPECT_FALSE(cache.Contains(0));
+  EXPECT_TRUE(cache.Contains(3));
+}
+
+TEST(ShardedLruCacheTest, ShouldBeAbleToVisitAllItems) {
+  ShardedLruCache<string, string> cache(10, 4);
+  for (int i = 0; i < 5; i++) {
+    cache.Set("Key" + to_string(i), "Value" + to_string(i));
+  }
+
+  size_t visited = 0;
+  cache.ForEach([&](const string& key, const string& value) {
+    EXPECT_EQ(key.substr(3), value.substr(5));
+    visited++;
+  });
+  EXPECT_EQ(visited, 5);
+
+  auto all_items = cache.GetAll();
+  EXPECT_EQ(all_items.size(), 5);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(*all_items["Key" + to_string(i)], "Value" + to_string(i));
+  }
+}
+
+TEST(ShardedLruCacheTest, ConcurrentAccess) {
+  for (auto eviction_policy :
+       {LruCacheEvictionPolicy::Lru, LruCacheEvictionPolicy::Clock}) {
+    ShardedLruCache<int, int> cache(128, 8, eviction_policy);
+    atomic<size_t> mismatches(0);
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < 10000; i++) {
+          int key = (i * 7 + t) % 512;
+          cache.Set(key, key * 2);
+          auto value = cache.Get((key + 1) % 512);
+          if (value != nullptr && *value != ((key + 1) % 512) * 2) {
+            mismatches++;
+          }
+          if (i % 10 == 0) {
+            cache.Erase(key);
+          }
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_LE(cache.Size(), cache.Capacity());
+  }
+}
+}  // namespace google::scp::core::common::test
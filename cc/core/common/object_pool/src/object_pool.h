@@ -0,0 +1,99 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "core/common/concurrent_queue/src/concurrent_queue.h"
+
+namespace google::scp::core::common {
+/**
+ * @brief Recycles the objects of a type across their shared owners. An object
+ * acquired from the pool goes back to it, after being reset, once its last
+ * owner releases it instead of being destroyed, and the later acquisitions
+ * reuse it instead of allocating and constructing a new one.
+ *
+ * The pool can be destroyed while some of its objects are still owned; the
+ * idle objects are then destroyed once the last of those is released.
+ *
+ * @tparam T the object type. Must be default constructible.
+ */
+template <class T>
+class ObjectPool {
+ public:
+  /**
+   * @brief Construct a new Object Pool object.
+   *
+   * @param capacity the maximum number of idle objects kept for reuse. The
+   * objects released while the pool is full are destroyed.
+   * @param reset brings a released object back to its default constructed
+   * state, or the state the acquirers expect.
+   */
+  ObjectPool(size_t capacity, std::function<void(T&)> reset)
+      : idle_objects_(
+            std::make_shared<IdleObjects>(capacity, std::move(reset))) {}
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  /**
+   * @brief Returns an idle object if there is one, or a new one.
+   */
+  std::shared_ptr<T> Acquire() noexcept {
+    T* object = nullptr;
+    if (!idle_objects_->queue.TryDequeue(object).Successful()) {
+      object = new T();
+    }
+
+    return std::shared_ptr<T>(
+        object, [idle_objects = idle_objects_](T* released_object) {
+          idle_objects->reset(*released_object);
+          if (!idle_objects->queue.TryEnqueue(released_object).Successful()) {
+            delete released_object;
+          }
+        });
+  }
+
+  /**
+   * @brief Returns the number of idle objects. Acquisitions and releases in
+   * flight make this value approximate.
+   */
+  size_t IdleCount() noexcept { return idle_objects_->queue.Size(); }
+
+ private:
+  /// Shared with the deleters of the acquired objects, so that the objects
+  /// released after the pool is gone still find it.
+  struct IdleObjects {
+    IdleObjects(size_t capacity, std::function<void(T&)> reset)
+        : queue(capacity), reset(std::move(reset)) {}
+
+    ~IdleObjects() {
+      T* object = nullptr;
+      while (queue.TryDequeue(object).Successful()) {
+        delete object;
+      }
+    }
+
+    ConcurrentQueue<T*, ConcurrentQueueBackend::RingBuffer> queue;
+    std::function<void(T&)> reset;
+  };
+
+  std::shared_ptr<IdleObjects> idle_objects_;
+};
+}  // namespace google::scp::core::common
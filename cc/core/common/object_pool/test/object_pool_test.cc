@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/common/object_pool/src/object_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using std::atomic;
+using std::make_shared;
+using std::shared_ptr;
+using std::thread;
+using std::vector;
+
+namespace google::scp::core::common::test {
+struct PooledObject {
+  PooledObject() { constructed_count++; }
+
+  ~PooledObject() { destroyed_count++; }
+
+  int value = 0;
+
+  static atomic<size_t> constructed_count;
+  static atomic<size_t> destroyed_count;
+};
+
+atomic<size_t> PooledObject::constructed_count{0};
+atomic<size_t> PooledObject::destroyed_count{0};
+
+class ObjectPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    PooledObject::constructed_count = 0;
+    PooledObject::destroyed_count = 0;
+  }
+};
+
+TEST_F(ObjectPoolTest, ReleasedObjectsAreResetAndReused) {
+  ObjectPool<PooledObject> pool(2, [](PooledObject& object) {
+    object.value = 0;
+  });
+
+  auto object = pool.Acquire();
+  auto* address = object.get();
+  object->value = 10;
+  EXPECT_EQ(pool.IdleCount(), 0);
+
+  // The object only goes back to the pool once the last owner releases it.
+  auto other_owner = object;
+  object = nullptr;
+  EXPECT_EQ(pool.IdleCount(), 0);
+  other_owner = nullptr;
+  EXPECT_EQ(pool.IdleCount(), 1);
+
+  object = pool.Acquire();
+  EXPECT_EQ(object.get(), address);
+  EXPECT_EQ(object->value, 0);
+  EXPECT_EQ(pool.IdleCount(), 0);
+  EXPECT_EQ(PooledObject::constructed_count, 1);
+  EXPECT_EQ(PooledObject::destroyed_count, 0);
+}
+
+TEST_F(ObjectPoolTest, ObjectsReleasedWhileFullAreDestroyed) {
+  ObjectPool<PooledObject> pool(1, [](PooledObject&) {});
+
+  auto object_1 = pool.Acquire();
+  auto object_2 = pool.Acquire();
+  EXPECT_NE(object_1.get(), object_2.get());
+  object_1 = nullptr;
+  object_2 = nullptr;
+
+  EXPECT_EQ(pool.IdleCount(), 1);
+  EXPECT_EQ(PooledObject::constructed_count, 2);
+  EXPECT_EQ(PooledObject::destroyed_count, 1);
+}
+
+TEST_F(ObjectPoolTest, ZeroCapacityNeverReuses) {
+  ObjectPool<PooledObject> pool(0, [](PooledObject&) {});
+
+  pool.Acquire();
+  pool.Acquire();
+
+  EXPECT_EQ(pool.IdleCount(), 0);
+  EXPECT_EQ(PooledObject::constructed_count, 2);
+  EXPECT_EQ(PooledObject::destroyed_count, 2);
+}
+
+TEST_F(ObjectPoolTest, ObjectsCanOutliveThePool) {
+  shared_ptr<PooledObject> object;
+  {
+    ObjectPool<PooledObject> pool(2, [](PooledObject&) {});
+    object = pool.Acquire();
+    pool.Acquire();
+  }
+  EXPECT_EQ(PooledObject::destroyed_count, 0);
+
+  object = nullptr;
+  EXPECT_EQ(PooledObject::destroyed_count, 2);
+}
+
+TEST_F(ObjectPoolTest, ConcurrentAcquireAndRelease) {
+  auto pool = make_shared<ObjectPool<PooledObject>>(
+      8, [](PooledObject& object) { object.value = 0; });
+
+  vector<thread> threads;
+  atomic<size_t> dirty_acquisitions(0);
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 10000; ++j) {
+        auto object = pool->Acquire();
+        if (object->value != 0) {
+          dirty_acquisitions++;
+        }
+        object->value = j + 1;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(dirty_acquisitions, 0);
+  pool = nullptr;
+  EXPECT_EQ(PooledObject::constructed_count,
+            PooledObject::destroyed_count.load());
+}
+}  // namespace google::scp::core::common::test
@@ -35,4 +35,8 @@ DEFINE_ERROR_CODE(SC_DISPATCHER_NOT_ENOUGH_TIME_REMAINED_FOR_OPERATION,
                   "Not enough time remaining to continue the operation.",
                   HttpStatusCode::REQUEST_TIMEOUT)
 
+DEFINE_ERROR_CODE(SC_DISPATCHER_RETRY_BUDGET_EXHAUSTED, SC_DISPATCHER, 0x0004,
+                  "The retry budget of the dependency is exhausted.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
+
 }  // namespace google::scp::core::errors
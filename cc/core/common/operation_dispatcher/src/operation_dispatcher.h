@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -25,6 +26,7 @@
 #include "core/interface/streaming_context.h"
 
 #include "error_codes.h"
+#include "retry_budget.h"
 #include "retry_strategy.h"
 
 namespace google::scp::core::common {
@@ -43,11 +45,16 @@ class OperationDispatcher {
    * @param async_executor The async executor instance.
    * @param retry_strategy The retry strategy for dispatch operations in case of
    * Retry status code.
+   * @param retry_budget The retry budget shared with the other dispatchers
+   * calling the same dependency. Retries are not limited if null.
    */
   OperationDispatcher(
       const std::shared_ptr<AsyncExecutorInterface>& async_executor,
-      RetryStrategy retry_strategy)
-      : async_executor_(async_executor), retry_strategy_(retry_strategy) {}
+      RetryStrategy retry_strategy,
+      const std::shared_ptr<RetryBudget>& retry_budget = nullptr)
+      : async_executor_(async_executor),
+        retry_strategy_(retry_strategy),
+        retry_budget_(retry_budget) {}
 
   /**
    * @brief Dispatches an async_context object to the target component with a
@@ -71,6 +78,7 @@ class OperationDispatcher {
         return;
       }
 
+      RecordOutcome(async_context.result);
       original_callback(async_context);
     };
 
@@ -107,6 +115,7 @@ class OperationDispatcher {
                 dispatch_to_target_function);
             return;
           }
+          RecordOutcome(async_context.result);
           original_callback(async_context);
         };
 
@@ -142,6 +151,7 @@ class OperationDispatcher {
                                 dispatch_to_target_function);
               return;
             }
+            RecordOutcome(consumer_streaming_context.result);
           }
           original_callback(consumer_streaming_context, is_finish);
         };
@@ -151,6 +161,13 @@ class OperationDispatcher {
   }
 
  private:
+  /// Returns tokens to the retry budget for a successful operation.
+  void RecordOutcome(const ExecutionResult& result) noexcept {
+    if (retry_budget_ && result.Successful()) {
+      retry_budget_->RecordSuccess();
+    }
+  }
+
   template <class Context>
   void DispatchWithRetry(Context& async_context,
                          const std::function<ExecutionResult(Context&)>&
@@ -170,9 +187,13 @@ class OperationDispatcher {
       return;
     }
 
-    auto back_off_duration_ms =
-        retry_strategy_.GetBackOffDurationInMilliseconds(
-            async_context.retry_count);
+    // The target may ask for a longer back-off than the strategy, e.g. when
+    // it is throttling. The hint only applies to the retry it was given for.
+    auto back_off_duration_ms = std::max(
+        retry_strategy_.GetJitteredBackOffDurationInMilliseconds(
+            async_context.retry_count),
+        async_context.retry_after_ms);
+    async_context.retry_after_ms = 0;
 
     if (async_context.retry_count >=
         retry_strategy_.GetMaximumAllowedRetryCount()) {
@@ -217,6 +238,17 @@ class OperationDispatcher {
       return;
     }
 
+    if (retry_budget_ && !retry_budget_->TryAcquireRetry()) {
+      SCP_ERROR_CONTEXT(kOperationDispatcher, async_context,
+                        async_context.result,
+                        "Retry budget exhausted. Total retries: %lld",
+                        async_context.retry_count);
+      async_context.result = FailureExecutionResult(
+          core::errors::SC_DISPATCHER_RETRY_BUDGET_EXHAUSTED);
+      async_context.Finish();
+      return;
+    }
+
     auto execution_result = async_executor_->ScheduleFor(
         async_operation, current_time + back_off_duration_ns);
     if (!execution_result.Successful()) {
@@ -229,5 +261,7 @@ class OperationDispatcher {
   const std::shared_ptr<AsyncExecutorInterface> async_executor_;
   /// The retry strategy for the dispatcher.
   RetryStrategy retry_strategy_;
+  /// The retry budget for the dispatcher, may be null.
+  const std::shared_ptr<RetryBudget> retry_budget_;
 };
 }  // namespace google::scp::core::common
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace google::scp::core::common {
+
+/// The default number of tokens held by a full retry budget.
+static constexpr size_t kDefaultRetryBudgetMaxTokens = 100;
+/// The default number of tokens a successful operation returns to the budget.
+static constexpr double kDefaultRetryBudgetTokenRatio = 0.1;
+
+/**
+ * @brief A token bucket shared by the operations dispatched to a degraded
+ * dependency, so that their retries do not multiply its load.
+ *
+ * Every retry takes one token and every successful operation returns
+ * token_ratio tokens. Retries are only allowed while more than half of the
+ * tokens are left, which bounds the retries to roughly token_ratio times the
+ * successful operations once the dependency starts failing. Thread-safe.
+ */
+class RetryBudget {
+ public:
+  /**
+   * @brief Construct a new Retry Budget object
+   *
+   * @param max_tokens The number of tokens of a full budget.
+   * @param token_ratio The number of tokens returned per successful operation.
+   */
+  explicit RetryBudget(size_t max_tokens = kDefaultRetryBudgetMaxTokens,
+                       double token_ratio = kDefaultRetryBudgetTokenRatio)
+      : max_milli_tokens_(max_tokens * kMilliTokensPerToken),
+        milli_tokens_per_success_(
+            static_cast<int64_t>(token_ratio * kMilliTokensPerToken)),
+        milli_tokens_(max_milli_tokens_) {}
+
+  /**
+   * @brief Takes a token for a retry.
+   *
+   * @return true if the retry may be issued.
+   * @return false if the budget is depleted and the retry must not be issued.
+   */
+  bool TryAcquireRetry() noexcept {
+    auto milli_tokens = milli_tokens_.load();
+    int64_t remaining;
+    do {
+      remaining = std::max<int64_t>(0, milli_tokens - kMilliTokensPerToken);
+    } while (!milli_tokens_.compare_exchange_weak(milli_tokens, remaining));
+    return milli_tokens > max_milli_tokens_ / 2;
+  }
+
+  /// Returns tokens to the budget for a successful operation.
+  void RecordSuccess() noexcept {
+    auto milli_tokens = milli_tokens_.load();
+    int64_t replenished;
+    do {
+      replenished = std::min<int64_t>(max_milli_tokens_,
+                                      milli_tokens + milli_tokens_per_success_);
+    } while (!milli_tokens_.compare_exchange_weak(milli_tokens, replenished));
+  }
+
+  /// Returns the number of tokens left in the budget.
+  double GetTokens() const noexcept {
+    return static_cast<double>(milli_tokens_.load()) / kMilliTokensPerToken;
+  }
+
+ private:
+  /// Tokens are kept in thousandths so that they fit in an atomic integer.
+  static constexpr int64_t kMilliTokensPerToken = 1000;
+
+  const int64_t max_milli_tokens_;
+  const int64_t milli_tokens_per_success_;
+  std::atomic<int64_t> milli_tokens_;
+};
+}  // namespace google::scp::core::common
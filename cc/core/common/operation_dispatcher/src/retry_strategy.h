@@ -16,14 +16,20 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <random>
 
 #include "core/interface/type_def.h"
 #include "public/core/interface/execution_result.h"
 
 namespace google::scp::core::common {
 
+/// The default fraction of the back-off duration that is randomized, so that
+/// operations failing together do not retry together.
+static constexpr double kDefaultRetryStrategyJitterRatio = 0.2;
+
 /// Types of retry strategy
 enum class RetryStrategyType {
   Linear = 0,
@@ -36,10 +42,12 @@ struct RetryStrategyOptions {
 
   RetryStrategyOptions(RetryStrategyType retry_strategy_type,
                        TimeDuration delay_duration_ms,
-                       size_t maximum_allowed_retry_count)
+                       size_t maximum_allowed_retry_count,
+                       double jitter_ratio = 0)
       : retry_strategy_type(retry_strategy_type),
         delay_duration_ms(delay_duration_ms),
-        maximum_allowed_retry_count(maximum_allowed_retry_count) {}
+        maximum_allowed_retry_count(maximum_allowed_retry_count),
+        jitter_ratio(jitter_ratio) {}
 
   /// The type of the retry strategy, linear or exponential.
   const RetryStrategyType retry_strategy_type;
@@ -49,6 +57,9 @@ struct RetryStrategyOptions {
 
   /// The maximum number of retries that is allowed.
   const size_t maximum_allowed_retry_count;
+
+  /// The fraction of the back-off duration that is randomized.
+  const double jitter_ratio;
 };
 
 /**
@@ -68,18 +79,21 @@ class RetryStrategy {
    * milliseconds.
    * @param maximum_allowed_retry_count The maximum number of retries that is
    * allowed.
+   * @param jitter_ratio The fraction of the back-off duration that is
+   * randomized, 0 for no jitter.
    */
   RetryStrategy(RetryStrategyType retry_strategy_type,
                 TimeDuration delay_duration_ms,
-                size_t maximum_allowed_retry_count)
+                size_t maximum_allowed_retry_count, double jitter_ratio = 0)
       : retry_strategy_type_(retry_strategy_type),
         delay_duration_ms_(delay_duration_ms),
-        maximum_allowed_retry_count_(maximum_allowed_retry_count) {}
+        maximum_allowed_retry_count_(maximum_allowed_retry_count),
+        jitter_ratio_(std::clamp(jitter_ratio, 0.0, 1.0)) {}
 
   explicit RetryStrategy(RetryStrategyOptions options)
-      : retry_strategy_type_(options.retry_strategy_type),
-        delay_duration_ms_(options.delay_duration_ms),
-        maximum_allowed_retry_count_(options.maximum_allowed_retry_count) {}
+      : RetryStrategy(options.retry_strategy_type, options.delay_duration_ms,
+                      options.maximum_allowed_retry_count,
+                      options.jitter_ratio) {}
 
   /**
    * @brief Get the back-off duration in milliseconds for any specific retry
@@ -102,6 +116,24 @@ class RetryStrategy {
     }
   }
 
+  /**
+   * @brief Get the back-off duration in milliseconds for any specific retry
+   * count, shortened by a random amount of up to jitter_ratio of it.
+   *
+   * @param retry_count The number of retries.
+   * @return TimeDuration The back off duration in milliseconds.
+   */
+  TimeDuration GetJitteredBackOffDurationInMilliseconds(size_t retry_count) {
+    auto back_off_duration_ms = GetBackOffDurationInMilliseconds(retry_count);
+    if (jitter_ratio_ == 0 || back_off_duration_ms == 0) {
+      return back_off_duration_ms;
+    }
+
+    thread_local std::mt19937 generator(std::random_device{}());
+    std::uniform_real_distribution<double> jitter(0, jitter_ratio_);
+    return back_off_duration_ms * (1 - jitter(generator));
+  }
+
   /**
    * @brief Returns the maximum allowed retry count.
    *
@@ -116,5 +148,7 @@ class RetryStrategy {
   TimeDuration delay_duration_ms_;
   /// Maximum allowed retry count for the retry strategy.
   size_t maximum_allowed_retry_count_;
+  /// The fraction of the back-off duration that is randomized.
+  double jitter_ratio_;
 };
 }  // namespace google::scp::core::common
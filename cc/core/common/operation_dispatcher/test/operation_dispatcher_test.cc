@@ -23,6 +23,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/async_executor/mock/mock_async_executor.h"
 #include "core/common/operation_dispatcher/src/error_codes.h"
@@ -39,7 +40,10 @@ using std::atomic;
 using std::function;
 using std::make_shared;
 using std::string;
+using std::vector;
+using std::chrono::duration_cast;
 using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
 
 namespace google::scp::core::common::test {
 TEST(OperationDispatcherTests, SuccessfulOperation) {
@@ -383,4 +387,103 @@ TEST(OperationDispatcherTests, RetryOnAcceptance) {
   WaitUntil([&]() { return condition.load(); });
 }
 
+TEST(OperationDispatcherTests, RetryBudgetExhausted) {
+  std::shared_ptr<AsyncExecutorInterface> mock_async_executor =
+      make_shared<MockAsyncExecutor>();
+  RetryStrategy retry_strategy(RetryStrategyType::Exponential, 0, 5);
+  auto retry_budget = make_shared<RetryBudget>(4, 1);
+  OperationDispatcher dispatcher(mock_async_executor, retry_strategy,
+                                 retry_budget);
+
+  atomic<bool> condition(false);
+  AsyncContext<string, string> context;
+  context.callback = [&](AsyncContext<string, string>& context) {
+    EXPECT_THAT(context.result,
+                ResultIs(FailureExecutionResult(
+                    core::errors::SC_DISPATCHER_RETRY_BUDGET_EXHAUSTED)));
+    EXPECT_EQ(context.retry_count, 3);
+    condition = true;
+  };
+
+  function<ExecutionResult(AsyncContext<string, string>&)>
+      dispatch_to_component = [](AsyncContext<string, string>& context) {
+        context.result = RetryExecutionResult(1);
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  dispatcher.Dispatch(context, dispatch_to_component);
+  WaitUntil([&]() { return condition.load(); });
+}
+
+TEST(OperationDispatcherTests, SuccessReplenishesRetryBudget) {
+  std::shared_ptr<AsyncExecutorInterface> mock_async_executor =
+      make_shared<MockAsyncExecutor>();
+  RetryStrategy retry_strategy(RetryStrategyType::Exponential, 0, 5);
+  auto retry_budget = make_shared<RetryBudget>(4, 1);
+  OperationDispatcher dispatcher(mock_async_executor, retry_strategy,
+                                 retry_budget);
+
+  atomic<bool> condition(false);
+  AsyncContext<string, string> context;
+  context.callback = [&](AsyncContext<string, string>& context) {
+    EXPECT_SUCCESS(context.result);
+    condition = true;
+  };
+
+  atomic<size_t> call_count = 0;
+  function<ExecutionResult(AsyncContext<string, string>&)>
+      dispatch_to_component = [&](AsyncContext<string, string>& context) {
+        context.result = ++call_count == 1 ? RetryExecutionResult(1)
+                                           : SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  dispatcher.Dispatch(context, dispatch_to_component);
+  WaitUntil([&]() { return condition.load(); });
+  EXPECT_DOUBLE_EQ(retry_budget->GetTokens(), 4);
+}
+
+TEST(OperationDispatcherTests, RetryAfterHintExtendsBackOff) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  vector<Timestamp> scheduled_timestamps;
+  mock_async_executor->schedule_for_mock =
+      [&](const AsyncOperation& work, Timestamp timestamp,
+          function<bool()>&) {
+        scheduled_timestamps.push_back(timestamp);
+        work();
+        return SuccessExecutionResult();
+      };
+  RetryStrategy retry_strategy(RetryStrategyType::Exponential, 1, 5);
+  OperationDispatcher dispatcher(mock_async_executor, retry_strategy);
+
+  atomic<bool> condition(false);
+  AsyncContext<string, string> context;
+  context.callback = [&](AsyncContext<string, string>& context) {
+    EXPECT_SUCCESS(context.result);
+    condition = true;
+  };
+
+  atomic<size_t> call_count = 0;
+  function<ExecutionResult(AsyncContext<string, string>&)>
+      dispatch_to_component = [&](AsyncContext<string, string>& context) {
+        context.result = SuccessExecutionResult();
+        if (++call_count == 1) {
+          context.result = RetryExecutionResult(1);
+          context.retry_after_ms = 5000;
+        }
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  auto before = TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  dispatcher.Dispatch(context, dispatch_to_component);
+  WaitUntil([&]() { return condition.load(); });
+
+  ASSERT_EQ(scheduled_timestamps.size(), 1);
+  EXPECT_GE(scheduled_timestamps[0],
+            before + duration_cast<nanoseconds>(milliseconds(5000)).count());
+}
+
 }  // namespace google::scp::core::common::test
@@ -0,0 +1,62 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/common/operation_dispatcher/src/retry_budget.h"
+
+#include <gtest/gtest.h>
+
+namespace google::scp::core::common::test {
+TEST(RetryBudgetTests, RetriesAreAllowedUntilHalfTheTokensAreUsed) {
+  RetryBudget retry_budget(10, 0.5);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(retry_budget.TryAcquireRetry());
+  }
+  EXPECT_DOUBLE_EQ(retry_budget.GetTokens(), 5);
+  EXPECT_FALSE(retry_budget.TryAcquireRetry());
+  EXPECT_FALSE(retry_budget.TryAcquireRetry());
+  EXPECT_DOUBLE_EQ(retry_budget.GetTokens(), 3);
+}
+
+TEST(RetryBudgetTests, SuccessesReplenishTheBudget) {
+  RetryBudget retry_budget(10, 0.5);
+  for (int i = 0; i < 6; i++) {
+    retry_budget.TryAcquireRetry();
+  }
+  EXPECT_FALSE(retry_budget.TryAcquireRetry());
+
+  for (int i = 0; i < 4; i++) {
+    retry_budget.RecordSuccess();
+  }
+  EXPECT_DOUBLE_EQ(retry_budget.GetTokens(), 5);
+  EXPECT_FALSE(retry_budget.TryAcquireRetry());
+
+  for (int i = 0; i < 4; i++) {
+    retry_budget.RecordSuccess();
+  }
+  EXPECT_TRUE(retry_budget.TryAcquireRetry());
+}
+
+TEST(RetryBudgetTests, TokensStayWithinBounds) {
+  RetryBudget retry_budget(2, 1);
+  for (int i = 0; i < 5; i++) {
+    retry_budget.RecordSuccess();
+  }
+  EXPECT_DOUBLE_EQ(retry_budget.GetTokens(), 2);
+
+  for (int i = 0; i < 5; i++) {
+    retry_budget.TryAcquireRetry();
+  }
+  EXPECT_DOUBLE_EQ(retry_budget.GetTokens(), 0);
+}
+}  // namespace google::scp::core::common::test
@@ -43,4 +43,20 @@ TEST(RetryStrategyTests, LinearRetryStrategyTest) {
   EXPECT_EQ(retry_strategy.GetMaximumAllowedRetryCount(), 5);
 }
 
+TEST(RetryStrategyTests, JitteredBackOffStaysWithinJitterRatio) {
+  RetryStrategy retry_strategy(RetryStrategyType::Exponential, 1000, 5, 0.2);
+  EXPECT_EQ(retry_strategy.GetJitteredBackOffDurationInMilliseconds(0), 0);
+  for (int i = 0; i < 100; i++) {
+    auto back_off_duration_ms =
+        retry_strategy.GetJitteredBackOffDurationInMilliseconds(3);
+    EXPECT_GE(back_off_duration_ms, 3200);
+    EXPECT_LE(back_off_duration_ms, 4000);
+  }
+}
+
+TEST(RetryStrategyTests, NoJitterByDefault) {
+  RetryStrategy retry_strategy(RetryStrategyType::Linear, 1000, 5);
+  EXPECT_EQ(retry_strategy.GetJitteredBackOffDurationInMilliseconds(2), 2000);
+}
+
 }  // namespace google::scp::core::common::test
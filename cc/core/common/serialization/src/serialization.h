@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -24,6 +26,9 @@
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/type_def.h"
 #include "google/protobuf/any.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/message_lite.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "public/core/interface/execution_result.h"
 
 #include "error_codes.h"
@@ -36,6 +41,21 @@ namespace google::scp::core::common {
 
 class Serialization {
  public:
+  /**
+   * @brief A message enclosing another message, serialized, in a bytes field,
+   * such as the versioned logs of the components.
+   */
+  struct ProtoEnvelope {
+    /// The fields of the envelope, with the bytes field left unset.
+    const google::protobuf::MessageLite* header;
+    /// The number of the bytes field, greater than the numbers of all the
+    /// fields set in header.
+    int body_field_number;
+  };
+
+  /// The maximum number of envelopes around a message.
+  static constexpr size_t kMaxProtoEnvelopes = 4;
+
   /**
    * @brief Used to serialize a T value into bytes buffer.
    *
@@ -203,6 +223,54 @@ class Serialization {
     return SuccessExecutionResult();
   }
 
+  /**
+   * @brief Serializes a message in nested envelopes, each one holding the
+   * serialized next one in its bytes field, in a single pass. The bytes are the
+   * ones of serializing the message, setting it to the bytes field of the
+   * innermost envelope, serializing that envelope and so forth, without the
+   * intermediate buffers and copies.
+   *
+   * @param envelopes The envelopes, from the outermost one.
+   * @param body The message to serialize in the envelopes.
+   * @param bytes_buffer The bytes buffer to serialize the envelopes to.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  static ExecutionResult SerializeEnvelopedProtoMessage(
+      std::initializer_list<ProtoEnvelope> envelopes,
+      const google::protobuf::MessageLite& body,
+      core::BytesBuffer& bytes_buffer) {
+    return SerializeEnvelopedBody(
+        envelopes, body.ByteSizeLong(),
+        [&body](uint8_t* target) {
+          return body.SerializeWithCachedSizesToArray(target);
+        },
+        bytes_buffer);
+  }
+
+  /**
+   * @brief Serializes an already serialized message in nested envelopes in a
+   * single pass, see the overload above.
+   *
+   * @param envelopes The envelopes, from the outermost one.
+   * @param body The serialized message, may be empty.
+   * @param body_length The length of body.
+   * @param bytes_buffer The bytes buffer to serialize the envelopes to.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  static ExecutionResult SerializeEnvelopedProtoMessage(
+      std::initializer_list<ProtoEnvelope> envelopes, const Byte* body,
+      size_t body_length, core::BytesBuffer& bytes_buffer) {
+    return SerializeEnvelopedBody(
+        envelopes, body_length,
+        [body, body_length](uint8_t* target) {
+          if (body_length > 0) {
+            memcpy(target, body, body_length);
+          }
+          return target + body_length;
+        },
+        bytes_buffer);
+  }
+
   template <typename TProtoMessage>
   static ExecutionResult ValidateVersion(const TProtoMessage& proto_message,
                                          Version supported_version) {
@@ -214,6 +282,58 @@ class Serialization {
 
     return SuccessExecutionResult();
   }
+
+ private:
+  template <typename TBodyWriter>
+  static ExecutionResult SerializeEnvelopedBody(
+      std::initializer_list<ProtoEnvelope> envelopes, size_t body_size,
+      const TBodyWriter& write_body, core::BytesBuffer& bytes_buffer) {
+    using google::protobuf::io::CodedOutputStream;
+    using google::protobuf::internal::WireFormatLite;
+
+    if (envelopes.size() > kMaxProtoEnvelopes) {
+      return FailureExecutionResult(
+          errors::SC_SERIALIZATION_INVALID_SERIALIZATION_TYPE);
+    }
+
+    // The sizes of the envelopes, from the outermost one, then of the body.
+    // Like proto3 does, an empty bytes field is not serialized.
+    std::array<size_t, kMaxProtoEnvelopes + 1> sizes;
+    sizes[envelopes.size()] = body_size;
+    for (size_t i = envelopes.size(); i > 0; --i) {
+      const auto& envelope = envelopes.begin()[i - 1];
+      sizes[i - 1] = envelope.header->ByteSizeLong();
+      if (sizes[i] > 0) {
+        sizes[i - 1] +=
+            WireFormatLite::TagSize(envelope.body_field_number,
+                                    WireFormatLite::TYPE_BYTES) +
+            CodedOutputStream::VarintSize64(sizes[i]) + sizes[i];
+      }
+    }
+
+    bytes_buffer = core::BytesBuffer(sizes[0]);
+    auto* begin = reinterpret_cast<uint8_t*>(bytes_buffer.bytes->data());
+    auto* target = begin;
+    for (size_t i = 0; i < envelopes.size(); ++i) {
+      const auto& envelope = envelopes.begin()[i];
+      // The sizes were cached by ByteSizeLong above.
+      target = envelope.header->SerializeWithCachedSizesToArray(target);
+      if (sizes[i + 1] > 0) {
+        target = WireFormatLite::WriteTagToArray(
+            envelope.body_field_number,
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+        target = CodedOutputStream::WriteVarint64ToArray(sizes[i + 1], target);
+      }
+    }
+    target = write_body(target);
+
+    if (static_cast<size_t>(target - begin) != sizes[0]) {
+      return FailureExecutionResult(
+          errors::SC_SERIALIZATION_PROTO_SERIALIZATION_FAILED);
+    }
+    bytes_buffer.length = sizes[0];
+    return SuccessExecutionResult();
+  }
 };
 
 /**
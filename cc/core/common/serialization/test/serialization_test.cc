@@ -29,6 +29,7 @@
 
 using google::protobuf::Message;
 using google::scp::core::common::Uuid;
+using google::scp::core::common::test::serialization::TestEnvelope;
 using google::scp::core::common::test::serialization::TestStringRequest;
 using std::make_shared;
 using std::string;
@@ -332,4 +333,44 @@ TEST(SerializationTests, SerializeVersion) {
       FailureExecutionResult(errors::SC_SERIALIZATION_BUFFER_NOT_READABLE));
 }
 
+TEST(SerializationTests, SerializeEnvelopedProtoMessage) {
+  TestStringRequest body;
+  body.set_request("request");
+  TestEnvelope inner_header;
+  inner_header.set_id(1);
+  TestEnvelope outer_header;
+  outer_header.set_id(2);
+
+  // The bytes of serializing each level into the next one.
+  TestEnvelope inner = inner_header;
+  inner.set_body(body.SerializeAsString());
+  TestEnvelope outer = outer_header;
+  outer.set_body(inner.SerializeAsString());
+  auto expected = outer.SerializeAsString();
+
+  BytesBuffer bytes_buffer;
+  EXPECT_EQ(Serialization::SerializeEnvelopedProtoMessage(
+                {{&outer_header, 2}, {&inner_header, 2}}, body, bytes_buffer),
+            SuccessExecutionResult());
+  EXPECT_EQ(string(bytes_buffer.bytes->data(), bytes_buffer.length), expected);
+
+  auto serialized_body = body.SerializeAsString();
+  EXPECT_EQ(Serialization::SerializeEnvelopedProtoMessage(
+                {{&outer_header, 2}, {&inner_header, 2}},
+                reinterpret_cast<const Byte*>(serialized_body.data()),
+                serialized_body.length(), bytes_buffer),
+            SuccessExecutionResult());
+  EXPECT_EQ(string(bytes_buffer.bytes->data(), bytes_buffer.length), expected);
+
+  // An empty body is not serialized, as proto3 does for empty bytes.
+  inner.clear_body();
+  outer.set_body(inner.SerializeAsString());
+  EXPECT_EQ(Serialization::SerializeEnvelopedProtoMessage(
+                {{&outer_header, 2}, {&inner_header, 2}}, nullptr, 0,
+                bytes_buffer),
+            SuccessExecutionResult());
+  EXPECT_EQ(string(bytes_buffer.bytes->data(), bytes_buffer.length),
+            outer.SerializeAsString());
+}
+
 }  // namespace google::scp::core::common::test
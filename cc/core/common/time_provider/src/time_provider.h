@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <time.h>
+
 #include <chrono>
 
 #include "core/interface/type_def.h"
@@ -61,6 +63,67 @@ class TimeProvider {
     return GetSteadyTimestampInNanoseconds().count();
   }
 
+  /**
+   * @brief Get the wall-clock (system time) of the system in nanoseconds, as of
+   * the last kernel tick. It is cheaper to read than
+   * GetWallTimestampInNanoseconds and trails it by at most
+   * GetCoarseClockPrecision, which suits timestamps compared at a granularity
+   * of seconds, such as expirations.
+   *
+   * @return nanoseconds The timestamp in nanoseconds
+   */
+  static std::chrono::nanoseconds GetCoarseWallTimestampInNanoseconds() {
+#if defined(CLOCK_REALTIME_COARSE)
+    return ReadClock(CLOCK_REALTIME_COARSE);
+#else
+    return GetWallTimestampInNanoseconds();
+#endif
+  }
+
+  /**
+   * @brief Get CPU ticks elapsed since the last reboot in nanoseconds, as of
+   * the last kernel tick. It is on the clock of
+   * GetSteadyTimestampInNanoseconds, cheaper to read and trailing it by at most
+   * GetCoarseClockPrecision, so the two can be compared where the precision
+   * does not matter.
+   *
+   * @return nanoseconds The timestamp in nanoseconds
+   */
+  static std::chrono::nanoseconds GetCoarseSteadyTimestampInNanoseconds() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+    return ReadClock(CLOCK_MONOTONIC_COARSE);
+#else
+    return GetSteadyTimestampInNanoseconds();
+#endif
+  }
+
+  /**
+   * @brief Get CPU ticks elapsed since the last reboot in nanoseconds, as of
+   * the last kernel tick.
+   *
+   * @return Timestamp The timestamp in nanoseconds in ticks format
+   */
+  static Timestamp GetCoarseSteadyTimestampInNanosecondsAsClockTicks() {
+    return GetCoarseSteadyTimestampInNanoseconds().count();
+  }
+
+  /**
+   * @brief Get the precision of the coarse timestamps, the kernel tick, which
+   * is 4 milliseconds on most Linux kernels.
+   *
+   * @return nanoseconds The precision in nanoseconds
+   */
+  static std::chrono::nanoseconds GetCoarseClockPrecision() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+    timespec resolution = {};
+    clock_getres(CLOCK_MONOTONIC_COARSE, &resolution);
+    return std::chrono::seconds(resolution.tv_sec) +
+           std::chrono::nanoseconds(resolution.tv_nsec);
+#else
+    return std::chrono::nanoseconds(1);
+#endif
+  }
+
   /**
    * @brief Get unique wall-clock timestamp of the system. If two or more
    * threads call this function at the same time instant, the function
@@ -100,5 +163,13 @@ class TimeProvider {
                                                      current_timestamp));
     return current_timestamp;
   }
+
+ private:
+  static std::chrono::nanoseconds ReadClock(clockid_t clock_id) {
+    timespec timestamp = {};
+    clock_gettime(clock_id, &timestamp);
+    return std::chrono::seconds(timestamp.tv_sec) +
+           std::chrono::nanoseconds(timestamp.tv_nsec);
+  }
 };
 };  // namespace google::scp::core::common
@@ -90,4 +90,32 @@ TEST(TimeProviderTest,
     }
   }
 }
+
+TEST(TimeProviderTest, CoarseTimestampsTrailPreciseOnesWithinThePrecision) {
+  auto precision = TimeProvider::GetCoarseClockPrecision();
+  EXPECT_GT(precision.count(), 0);
+
+  auto steady_before = TimeProvider::GetSteadyTimestampInNanoseconds();
+  auto coarse_steady = TimeProvider::GetCoarseSteadyTimestampInNanoseconds();
+  auto steady_after = TimeProvider::GetSteadyTimestampInNanoseconds();
+  EXPECT_LE(coarse_steady, steady_after);
+  EXPECT_GE(coarse_steady + 2 * precision, steady_before);
+
+  auto wall_before = TimeProvider::GetWallTimestampInNanoseconds();
+  auto coarse_wall = TimeProvider::GetCoarseWallTimestampInNanoseconds();
+  auto wall_after = TimeProvider::GetWallTimestampInNanoseconds();
+  EXPECT_LE(coarse_wall, wall_after);
+  EXPECT_GE(coarse_wall + 2 * precision, wall_before);
+}
+
+TEST(TimeProviderTest, CoarseSteadyTimestampsDoNotGoBackwards) {
+  auto previous_timestamp =
+      TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks();
+  for (int i = 0; i < 100000; i++) {
+    auto timestamp =
+        TimeProvider::GetCoarseSteadyTimestampInNanosecondsAsClockTicks();
+    EXPECT_GE(timestamp, previous_timestamp);
+    previous_timestamp = timestamp;
+  }
+}
 };  // namespace google::scp::core::common::test
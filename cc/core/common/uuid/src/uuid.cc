@@ -16,151 +16,162 @@
 
 #include "uuid.h"
 
-#include <cctype>
-#include <chrono>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <random>
-#include <sstream>
 #include <string>
 
 #include "core/common/time_provider/src/time_provider.h"
 
 #include "error_codes.h"
 
+using std::array;
 using std::atomic;
-using std::isxdigit;
-using std::mt19937;
+using std::mt19937_64;
 using std::random_device;
 using std::string;
-using std::uniform_int_distribution;
+
+// Number of consecutive high values a thread reserves from the shared clock at
+// once, so that the shared atomic is touched once per block instead of once
+// per generated uuid.
+static constexpr uint64_t kUuidHighBlockSize = 1024;
 
 static constexpr char kHexMap[] = {"0123456789ABCDEF"};
 
+// Length of the guid format 00000000-0000-0000-0000-000000000000.
+static constexpr size_t kUuidStringLength = 36;
+
+// Positions of the dashes of the guid format.
+static constexpr size_t kUuidDashPositions[] = {8, 13, 18, 23};
+
+// Maps every byte to its two upper case hexadecimal digits.
+static constexpr array<array<char, 2>, 256> kByteToHex = []() {
+  array<array<char, 2>, 256> table = {};
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i][0] = kHexMap[i >> 4];
+    table[i][1] = kHexMap[i & 0x0F];
+  }
+  return table;
+}();
+
+// Marks the characters that are not upper case hexadecimal digits.
+static constexpr int8_t kInvalidHexDigit = -1;
+
+// Maps every character to the value of the upper case hexadecimal digit it
+// represents, or to kInvalidHexDigit.
+static constexpr array<int8_t, 256> kHexToValue = []() {
+  array<int8_t, 256> table = {};
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i] = kInvalidHexDigit;
+  }
+  for (int8_t i = 0; i < 16; ++i) {
+    table[static_cast<uint8_t>(kHexMap[i])] = i;
+  }
+  return table;
+}();
+
 namespace google::scp::core::common {
 Uuid Uuid::GenerateUuid() noexcept {
   // TODO: Might want to use GetUniqueWallTimestampInNanoseconds()
   static atomic<Timestamp> current_clock(
       TimeProvider::GetWallTimestampInNanosecondsAsClockTicks());
 
-  uint64_t high = current_clock.fetch_add(1);
-  static random_device random_device_local;
-  static mt19937 random_generator(random_device_local());
-  uniform_int_distribution<uint64_t> distribution;
+  // Every thread hands out the high values of its own block, so the high parts
+  // stay unique across threads while the shared clock is advanced once per
+  // block, and draws the low part from its own generator, which needs no
+  // synchronization.
+  thread_local uint64_t next_high = 0;
+  thread_local uint64_t high_block_end = 0;
+  thread_local mt19937_64 random_generator(random_device{}());
+
+  if (next_high == high_block_end) {
+    next_high = current_clock.fetch_add(kUuidHighBlockSize);
+    high_block_end = next_high + kUuidHighBlockSize;
+  }
 
-  uint64_t low = distribution(random_generator);
+  uint64_t high = next_high++;
+  uint64_t low = random_generator();
   return Uuid{.high = high, .low = low};
 }
 
-void AppendHex(int byte, std::string& string_to_append) {
-  int first_digit = byte >> 4;
-  string_to_append += kHexMap[first_digit];
-
-  int second_digit = byte & 0x0F;
-  string_to_append += kHexMap[second_digit];
+/**
+ * @brief Writes the bytes of value from the most significant one, as two
+ * hexadecimal digits each.
+ */
+static char* WriteHex(uint64_t value, size_t byte_count, char* output) {
+  for (size_t i = byte_count; i > 0; --i) {
+    const auto& digits = kByteToHex[(value >> ((i - 1) * 8)) & 0xFF];
+    *output++ = digits[0];
+    *output++ = digits[1];
+  }
+  return output;
 }
 
-uint64_t ReadHex(const std::string& string_to_read, int offset) {
-  string digits = string_to_read.substr(offset, 2);
-  std::istringstream istrstream(digits);
-
-  int byte = 0;
-  istrstream >> std::hex >> byte;
-  return byte;
+/**
+ * @brief Reads digit_count hexadecimal digits into the low bits of value.
+ *
+ * @return false if any of the characters is not an upper case hexadecimal
+ * digit.
+ */
+static bool ReadHex(const char* input, size_t digit_count, uint64_t& value) {
+  for (size_t i = 0; i < digit_count; ++i) {
+    auto digit = kHexToValue[static_cast<uint8_t>(input[i])];
+    if (digit == kInvalidHexDigit) {
+      return false;
+    }
+    value = (value << 4) | static_cast<uint64_t>(digit);
+  }
+  return true;
 }
 
 std::string ToString(const Uuid& uuid) noexcept {
   // Uuid has two 8 bytes variable, high and low. Printing each byte to a
   // hexadecimal value a guid can be generated.
-  string uuid_string;
-  uuid_string.reserve(36);
-
-  auto high = uuid.high;
-  auto low = uuid.low;
-
   // Guid format is 00000000-0000-0000-0000-000000000000
+  char buffer[kUuidStringLength];
+  auto* output = buffer;
   // 4 bytes
-  AppendHex((high >> 56) & 0xFF, uuid_string);
-  AppendHex((high >> 48) & 0xFF, uuid_string);
-  AppendHex((high >> 40) & 0xFF, uuid_string);
-  AppendHex((high >> 32) & 0xFF, uuid_string);
-
-  uuid_string += "-";
-
+  output = WriteHex(uuid.high >> 32, 4, output);
+  *output++ = '-';
   // 2 bytes
-  AppendHex((high >> 24) & 0xFF, uuid_string);
-  AppendHex((high >> 16) & 0xFF, uuid_string);
-
-  uuid_string += "-";
-
+  output = WriteHex(uuid.high >> 16, 2, output);
+  *output++ = '-';
   // 2 bytes
-  AppendHex((high >> 8) & 0xFF, uuid_string);
-  AppendHex(high & 0xFF, uuid_string);
-
-  uuid_string += "-";
-
+  output = WriteHex(uuid.high, 2, output);
+  *output++ = '-';
   // 2 bytes
-  AppendHex((low >> 56) & 0xFF, uuid_string);
-  AppendHex((low >> 48) & 0xFF, uuid_string);
-
-  uuid_string += "-";
-
+  output = WriteHex(uuid.low >> 48, 2, output);
+  *output++ = '-';
   // 6 bytes
-  AppendHex((low >> 40) & 0xFF, uuid_string);
-  AppendHex((low >> 32) & 0xFF, uuid_string);
-  AppendHex((low >> 24) & 0xFF, uuid_string);
-  AppendHex((low >> 16) & 0xFF, uuid_string);
-  AppendHex((low >> 8) & 0xFF, uuid_string);
-  AppendHex(low & 0xFF, uuid_string);
-
-  return uuid_string;
+  WriteHex(uuid.low, 6, output);
+
+  return string(buffer, kUuidStringLength);
 }
 
 ExecutionResult FromString(const std::string& uuid_string,
                            Uuid& uuid) noexcept {
-  if (uuid_string.length() != 36) {
+  if (uuid_string.length() != kUuidStringLength) {
     return FailureExecutionResult(errors::SC_UUID_INVALID_STRING);
   }
 
-  if (uuid_string[8] != '-' || uuid_string[13] != '-' ||
-      uuid_string[18] != '-' || uuid_string[23] != '-') {
-    return FailureExecutionResult(errors::SC_UUID_INVALID_STRING);
-  }
-
-  for (size_t i = 0; i < uuid_string.length(); ++i) {
-    if (uuid_string[i] == '-') {
-      continue;
-    }
-
-    if (!isxdigit(uuid_string[i])) {
-      return FailureExecutionResult(errors::SC_UUID_INVALID_STRING);
-    }
-
-    if (islower(uuid_string[i])) {
+  for (auto dash_position : kUuidDashPositions) {
+    if (uuid_string[dash_position] != '-') {
       return FailureExecutionResult(errors::SC_UUID_INVALID_STRING);
     }
   }
 
-  uuid.high |= (ReadHex(uuid_string, 0) << 56);
-  uuid.high |= (ReadHex(uuid_string, 2) << 48);
-  uuid.high |= (ReadHex(uuid_string, 4) << 40);
-  uuid.high |= (ReadHex(uuid_string, 6) << 32);
-
-  uuid.high |= (ReadHex(uuid_string, 9) << 24);
-  uuid.high |= (ReadHex(uuid_string, 11) << 16);
-
-  uuid.high |= (ReadHex(uuid_string, 14) << 8);
-  uuid.high |= (ReadHex(uuid_string, 16));
-
-  uuid.low |= (ReadHex(uuid_string, 19) << 56);
-  uuid.low |= (ReadHex(uuid_string, 21) << 48);
-
-  uuid.low |= (ReadHex(uuid_string, 24) << 40);
-  uuid.low |= (ReadHex(uuid_string, 26) << 32);
-  uuid.low |= (ReadHex(uuid_string, 28) << 24);
-  uuid.low |= (ReadHex(uuid_string, 30) << 16);
-  uuid.low |= (ReadHex(uuid_string, 32) << 8);
-  uuid.low |= (ReadHex(uuid_string, 34));
+  const auto* input = uuid_string.data();
+  uint64_t high = 0;
+  uint64_t low = 0;
+  if (!ReadHex(input, 8, high) || !ReadHex(input + 9, 4, high) ||
+      !ReadHex(input + 14, 4, high) || !ReadHex(input + 19, 4, low) ||
+      !ReadHex(input + 24, 12, low)) {
+    return FailureExecutionResult(errors::SC_UUID_INVALID_STRING);
+  }
 
+  uuid.high = high;
+  uuid.low = low;
   return SuccessExecutionResult();
 }
 }  // namespace google::scp::core::common
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/common/uuid/src/uuid.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::common::TimeProvider;
+using std::atomic;
+using std::cout;
+using std::endl;
+using std::string;
+using std::thread;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+namespace google::scp::core::common::test {
+class UuidBenchmarkTest : public ::testing::Test {
+ protected:
+  /// Runs work on thread_count threads at once and returns the nanoseconds
+  /// spent per call.
+  template <typename Work>
+  double MeasureNanosecondsPerCall(size_t thread_count, Work work) {
+    atomic<bool> start = false;
+    vector<thread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&]() {
+        while (!start) {}
+        for (size_t j = 0; j < call_count_per_thread_; ++j) {
+          work();
+        }
+      });
+    }
+
+    auto start_ns = TimeProvider::GetSteadyTimestampInNanoseconds();
+    start = true;
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto end_ns = TimeProvider::GetSteadyTimestampInNanoseconds();
+    return static_cast<double>(
+               duration_cast<nanoseconds>(end_ns - start_ns).count()) /
+           (thread_count * call_count_per_thread_);
+  }
+
+  size_t call_count_per_thread_ = 1000000;
+  atomic<uint64_t> sink_ = 0;
+};
+
+TEST_F(UuidBenchmarkTest, PerfTestGenerateUuid) {
+  GTEST_SKIP();
+  for (size_t thread_count : {1, 4, 16}) {
+    auto nanoseconds_per_call = MeasureNanosecondsPerCall(thread_count, [&]() {
+      auto uuid = Uuid::GenerateUuid();
+      sink_.fetch_add(uuid.low, std::memory_order_relaxed);
+    });
+    cout << thread_count << " threads: " << nanoseconds_per_call
+         << " nanoseconds per GenerateUuid" << endl;
+  }
+}
+
+TEST_F(UuidBenchmarkTest, PerfTestToStringAndFromString) {
+  GTEST_SKIP();
+  auto uuid = Uuid::GenerateUuid();
+  auto nanoseconds_per_call = MeasureNanosecondsPerCall(1, [&]() {
+    auto uuid_string = ToString(uuid);
+    sink_.fetch_add(uuid_string[0], std::memory_order_relaxed);
+  });
+  cout << nanoseconds_per_call << " nanoseconds per ToString" << endl;
+
+  auto uuid_string = ToString(uuid);
+  nanoseconds_per_call = MeasureNanosecondsPerCall(1, [&]() {
+    Uuid parsed_uuid;
+    EXPECT_SUCCESS(FromString(uuid_string, parsed_uuid));
+    sink_.fetch_add(parsed_uuid.low, std::memory_order_relaxed);
+  });
+  cout << nanoseconds_per_call << " nanoseconds per FromString" << endl;
+}
+}  // namespace google::scp::core::common::test
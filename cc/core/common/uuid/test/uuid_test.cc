@@ -18,13 +18,22 @@
 
 #include <gtest/gtest.h>
 
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include "core/common/uuid/src/error_codes.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 
 using google::scp::core::test::ResultIs;
+using std::mutex;
 using std::string;
+using std::thread;
+using std::unique_lock;
+using std::unordered_set;
+using std::vector;
 
 namespace google::scp::core::common::test {
 TEST(UuidTests, UuidGeneration) {
@@ -43,6 +52,50 @@ TEST(UuidTests, UuidToString) {
   EXPECT_EQ(parsed_uuid, uuid);
 }
 
+TEST(UuidTests, UuidGenerationIsUniqueAcrossThreads) {
+  size_t thread_count = 8;
+  size_t uuid_count_per_thread = 10000;
+  mutex uuids_mutex;
+  unordered_set<Uuid, UuidHash> uuids;
+  unordered_set<uint64_t> highs;
+
+  vector<thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&]() {
+      vector<Uuid> generated_uuids;
+      for (size_t j = 0; j < uuid_count_per_thread; ++j) {
+        generated_uuids.push_back(Uuid::GenerateUuid());
+      }
+      unique_lock<mutex> lock(uuids_mutex);
+      for (const auto& uuid : generated_uuids) {
+        uuids.insert(uuid);
+        highs.insert(uuid.high);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(uuids.size(), thread_count * uuid_count_per_thread);
+  // Uuid::operator< only compares the high parts, so they must be unique too.
+  EXPECT_EQ(highs.size(), thread_count * uuid_count_per_thread);
+}
+
+TEST(UuidTests, UuidToStringFormat) {
+  Uuid uuid{.high = 0x0123456789ABCDEF, .low = 0xFEDCBA9876543210};
+  EXPECT_EQ(ToString(uuid), "01234567-89AB-CDEF-FEDC-BA9876543210");
+  EXPECT_EQ(ToString(kZeroUuid), "00000000-0000-0000-0000-000000000000");
+
+  Uuid parsed_uuid{.high = 1, .low = 1};
+  EXPECT_SUCCESS(FromString("01234567-89AB-CDEF-FEDC-BA9876543210",
+                            parsed_uuid));
+  EXPECT_EQ(parsed_uuid, uuid);
+  EXPECT_SUCCESS(FromString("00000000-0000-0000-0000-000000000000",
+                            parsed_uuid));
+  EXPECT_EQ(parsed_uuid, kZeroUuid);
+}
+
 TEST(UuidTests, InvalidUuidString) {
   string uuid_string = "123";
   Uuid parsed_uuid;
@@ -64,5 +117,15 @@ TEST(UuidTests, InvalidUuidString) {
   EXPECT_THAT(
       FromString(uuid_string, parsed_uuid),
       ResultIs(FailureExecutionResult(core::errors::SC_UUID_INVALID_STRING)));
+
+  uuid_string = "3E2A3D09-48ED-A355-D346-AD7DC6CB090G";
+  EXPECT_THAT(
+      FromString(uuid_string, parsed_uuid),
+      ResultIs(FailureExecutionResult(core::errors::SC_UUID_INVALID_STRING)));
+
+  uuid_string = string("3E2A3D09-48ED-A355-D346-AD7DC6CB090") + '\0';
+  EXPECT_THAT(
+      FromString(uuid_string, parsed_uuid),
+      ResultIs(FailureExecutionResult(core::errors::SC_UUID_INVALID_STRING)));
 }
 }  // namespace google::scp::core::common::test
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "cc/core/interface/config_provider_interface.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core {
+/**
+ * @brief Resolves a set of configuration keys once into an immutable, typed
+ * Snapshot and publishes it, so that components which need their configuration
+ * on request paths do not look every key up in the config provider on every
+ * request.
+ *
+ * Reading the current snapshot is a single atomic load. Reload() resolves a
+ * new snapshot from the config provider and publishes it read-copy-update
+ * style: a reader still holding the previous snapshot keeps a valid one, as
+ * published snapshots are only freed along with the publisher. Reloads are
+ * expected to be rare, e.g. on an operator signal, so retaining them is cheap.
+ *
+ * @tparam Snapshot A default constructible struct of the typed values.
+ */
+template <typename Snapshot>
+class ConfigSnapshotPublisher {
+ public:
+  /// Resolves the values of a snapshot from the config provider. A failure
+  /// keeps the current snapshot published.
+  using SnapshotLoader =
+      std::function<ExecutionResult(ConfigProviderInterface&, Snapshot&)>;
+
+  /**
+   * @brief Constructs a new Config Snapshot Publisher object. A default
+   * constructed snapshot is published until the first Reload().
+   *
+   * @param config_provider The config provider to resolve the keys from.
+   * @param snapshot_loader Resolves the values of a snapshot.
+   */
+  ConfigSnapshotPublisher(
+      const std::shared_ptr<ConfigProviderInterface>& config_provider,
+      SnapshotLoader snapshot_loader)
+      : config_provider_(config_provider),
+        snapshot_loader_(std::move(snapshot_loader)),
+        current_snapshot_(nullptr) {
+    Publish(std::make_unique<Snapshot>());
+  }
+
+  /**
+   * @brief Resolves a new snapshot from the config provider and publishes it.
+   *
+   * @return ExecutionResult The result of the snapshot loader.
+   */
+  ExecutionResult Reload() noexcept {
+    auto snapshot = std::make_unique<Snapshot>();
+    auto execution_result = snapshot_loader_(*config_provider_, *snapshot);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    Publish(std::move(snapshot));
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Returns the current snapshot. The reference stays valid for the
+   * lifetime of the publisher, even if a newer snapshot is published.
+   */
+  const Snapshot& Get() const noexcept {
+    return *current_snapshot_.load(std::memory_order_acquire);
+  }
+
+ private:
+  void Publish(std::unique_ptr<Snapshot> snapshot) noexcept {
+    std::unique_lock<std::mutex> lock(publish_mutex_);
+    current_snapshot_.store(snapshot.get(), std::memory_order_release);
+    published_snapshots_.push_back(std::move(snapshot));
+  }
+
+  /// The config provider the snapshots are resolved from.
+  std::shared_ptr<ConfigProviderInterface> config_provider_;
+  /// Resolves the values of a snapshot.
+  SnapshotLoader snapshot_loader_;
+  /// The snapshot handed out to the readers.
+  std::atomic<const Snapshot*> current_snapshot_;
+  /// Serializes the publishing of the snapshots.
+  std::mutex publish_mutex_;
+  /// All the snapshots published so far, kept alive for the readers.
+  std::list<std::unique_ptr<const Snapshot>> published_snapshots_;
+};
+
+/**
+ * @brief Reads the value of key into out if the key is found, and otherwise
+ * keeps the default value of out. Meant for snapshot loaders.
+ */
+template <typename T>
+void GetConfigOrDefault(ConfigProviderInterface& config_provider,
+                        const ConfigKey& key, T& out) noexcept {
+  T value{};
+  if (config_provider.Get(key, value).Successful()) {
+    out = std::move(value);
+  }
+}
+}  // namespace google::scp::core
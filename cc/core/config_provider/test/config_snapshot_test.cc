@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/config_provider/src/config_snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "core/config_provider/mock/mock_config_provider.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::config_provider::mock::MockConfigProvider;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+
+namespace google::scp::core::test {
+
+struct TestConfigSnapshot {
+  bool enabled = false;
+  size_t count = 10;
+  string name = "default";
+};
+
+class ConfigSnapshotTest : public ::testing::Test {
+ protected:
+  ConfigSnapshotTest()
+      : mock_config_provider_(make_shared<MockConfigProvider>()),
+        publisher_(mock_config_provider_,
+                   [](ConfigProviderInterface& config_provider,
+                      TestConfigSnapshot& snapshot) {
+                     GetConfigOrDefault(config_provider, "enabled",
+                                        snapshot.enabled);
+                     GetConfigOrDefault(config_provider, "count",
+                                        snapshot.count);
+                     GetConfigOrDefault(config_provider, "name",
+                                        snapshot.name);
+                     if (snapshot.count == 0) {
+                       return ExecutionResult(FailureExecutionResult(1234));
+                     }
+                     return SuccessExecutionResult();
+                   }) {}
+
+  shared_ptr<MockConfigProvider> mock_config_provider_;
+  ConfigSnapshotPublisher<TestConfigSnapshot> publisher_;
+};
+
+TEST_F(ConfigSnapshotTest, PublishesDefaultsBeforeTheFirstReload) {
+  mock_config_provider_->SetBool("enabled", true);
+
+  EXPECT_FALSE(publisher_.Get().enabled);
+  EXPECT_EQ(publisher_.Get().count, 10);
+  EXPECT_EQ(publisher_.Get().name, "default");
+}
+
+TEST_F(ConfigSnapshotTest, ReloadResolvesTheKeys) {
+  mock_config_provider_->SetBool("enabled", true);
+  mock_config_provider_->SetInt("count", 5);
+  EXPECT_SUCCESS(publisher_.Reload());
+
+  EXPECT_TRUE(publisher_.Get().enabled);
+  EXPECT_EQ(publisher_.Get().count, 5);
+  // Keys that are not found keep their defaults.
+  EXPECT_EQ(publisher_.Get().name, "default");
+}
+
+TEST_F(ConfigSnapshotTest, SnapshotsAreImmutableAcrossReloads) {
+  mock_config_provider_->SetInt("count", 5);
+  EXPECT_SUCCESS(publisher_.Reload());
+  const auto& previous_snapshot = publisher_.Get();
+
+  mock_config_provider_->SetInt("count", 7);
+  // The published snapshot does not change until the next reload.
+  EXPECT_EQ(publisher_.Get().count, 5);
+
+  EXPECT_SUCCESS(publisher_.Reload());
+  EXPECT_EQ(publisher_.Get().count, 7);
+  // A reader holding the previous snapshot still sees its values.
+  EXPECT_EQ(previous_snapshot.count, 5);
+}
+
+TEST_F(ConfigSnapshotTest, FailedReloadKeepsTheCurrentSnapshot) {
+  mock_config_provider_->SetInt("count", 5);
+  EXPECT_SUCCESS(publisher_.Reload());
+
+  mock_config_provider_->SetInt("count", 0);
+  EXPECT_THAT(publisher_.Reload(), ResultIs(FailureExecutionResult(1234)));
+  EXPECT_EQ(publisher_.Get().count, 5);
+}
+
+}  // namespace google::scp::core::test
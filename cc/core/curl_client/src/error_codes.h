@@ -83,4 +83,12 @@ DEFINE_ERROR_CODE(SC_CURL_CLIENT_REQUEST_BAD_REGEX_PARSING, SC_CURL_CLIENT,
                   0x0010, "Response code could not be parsed",
                   HttpStatusCode::BAD_REQUEST);
 
+DEFINE_ERROR_CODE(SC_CURL_CLIENT_CURL_MULTI_ERROR, SC_CURL_CLIENT, 0x0011,
+                  "Adding the request to the CURL multi handle failed",
+                  HttpStatusCode::BAD_REQUEST);
+
+DEFINE_ERROR_CODE(SC_CURL_CLIENT_NOT_RUNNING, SC_CURL_CLIENT, 0x0012,
+                  "The CURL client is not running",
+                  HttpStatusCode::SERVICE_UNAVAILABLE);
+
 }  // namespace google::scp::core::errors
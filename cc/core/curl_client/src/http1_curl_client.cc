@@ -22,6 +22,7 @@
 using google::scp::core::common::RetryStrategy;
 using google::scp::core::common::RetryStrategyType;
 using std::make_shared;
+using std::make_unique;
 using std::move;
 using std::shared_ptr;
 
@@ -35,27 +36,66 @@ Http1CurlClient::Http1CurlClient(
     const shared_ptr<AsyncExecutorInterface>& cpu_async_executor,
     const shared_ptr<AsyncExecutorInterface>& io_async_executor,
     shared_ptr<Http1CurlWrapperProvider> curl_wrapper_provider,
-    common::RetryStrategyOptions retry_strategy_options)
+    common::RetryStrategyOptions retry_strategy_options, bool use_curl_multi)
     : curl_wrapper_provider_(curl_wrapper_provider),
       cpu_async_executor_(cpu_async_executor),
       io_async_executor_(io_async_executor),
       operation_dispatcher_(io_async_executor,
-                            RetryStrategy(retry_strategy_options)) {}
+                            RetryStrategy(retry_strategy_options)) {
+  if (use_curl_multi) {
+    curl_multi_wrapper_ = make_unique<Http1CurlMultiWrapper>();
+  }
+}
 
 ExecutionResult Http1CurlClient::Init() noexcept {
+  if (curl_multi_wrapper_) {
+    return curl_multi_wrapper_->Init();
+  }
   return SuccessExecutionResult();
 }
 
 ExecutionResult Http1CurlClient::Run() noexcept {
+  if (curl_multi_wrapper_) {
+    return curl_multi_wrapper_->Run();
+  }
   return SuccessExecutionResult();
 }
 
 ExecutionResult Http1CurlClient::Stop() noexcept {
+  if (curl_multi_wrapper_) {
+    return curl_multi_wrapper_->Stop();
+  }
   return SuccessExecutionResult();
 }
 
 ExecutionResult Http1CurlClient::PerformRequest(
     AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  if (curl_multi_wrapper_) {
+    // The dispatcher retries the request if the callback finishes the context
+    // with a retry result.
+    operation_dispatcher_.Dispatch<AsyncContext<HttpRequest, HttpResponse>>(
+        http_context, [this](auto& http_context) {
+          return curl_multi_wrapper_->PerformRequest(
+              http_context.request,
+              [this, http_context](
+                  ExecutionResultOr<HttpResponse> response_or) mutable {
+                if (!response_or.Successful()) {
+                  SCP_ERROR_CONTEXT(kHttp1CurlClient, http_context,
+                                    response_or.result(),
+                                    "multi wrapper PerformRequest failed.");
+                  FinishContext(response_or.result(), http_context,
+                                cpu_async_executor_);
+                  return;
+                }
+                http_context.response =
+                    make_shared<HttpResponse>(move(*response_or));
+                FinishContext(SuccessExecutionResult(), http_context,
+                              cpu_async_executor_);
+              });
+        });
+    return SuccessExecutionResult();
+  }
+
   auto wrapper_or = curl_wrapper_provider_->MakeWrapper();
   RETURN_IF_FAILURE(wrapper_or.result());
   operation_dispatcher_.Dispatch<AsyncContext<HttpRequest, HttpResponse>>(
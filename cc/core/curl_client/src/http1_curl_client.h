@@ -25,6 +25,7 @@
 #include "public/core/interface/execution_result.h"
 
 #include "error_codes.h"
+#include "http1_curl_multi_wrapper.h"
 #include "http1_curl_wrapper.h"
 
 namespace google::scp::core {
@@ -42,6 +43,8 @@ class Http1CurlClient : public HttpClientInterface {
    * @param time_duraton_ms delay time duration in ms for http client retry
    * strategy.
    * @param total_retries total retry counts.
+   * @param use_curl_multi whether to perform the requests concurrently on one
+   * CURL multi handle instead of one blocking CURL handle per request.
    */
   explicit Http1CurlClient(
       const std::shared_ptr<AsyncExecutorInterface>& cpu_async_executor,
@@ -51,7 +54,8 @@ class Http1CurlClient : public HttpClientInterface {
       common::RetryStrategyOptions retry_strategy_options =
           common::RetryStrategyOptions(common::RetryStrategyType::Exponential,
                                        kDefaultRetryStrategyDelayInMs,
-                                       kDefaultRetryStrategyMaxRetries));
+                                       kDefaultRetryStrategyMaxRetries),
+      bool use_curl_multi = false);
 
   ExecutionResult Init() noexcept override;
   ExecutionResult Run() noexcept override;
@@ -67,6 +71,8 @@ class Http1CurlClient : public HttpClientInterface {
       io_async_executor_;
   /// Operation dispatcher
   common::OperationDispatcher operation_dispatcher_;
+  /// Performs the requests if the CURL multi backend is used.
+  std::unique_ptr<Http1CurlMultiWrapper> curl_multi_wrapper_;
 };
 
 }  // namespace google::scp::core
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "http1_curl_multi_wrapper.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
+
+#include "error_codes.h"
+
+using google::scp::core::common::kZeroUuid;
+using std::lock_guard;
+using std::make_unique;
+using std::move;
+using std::mutex;
+using std::shared_ptr;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+
+namespace google::scp::core {
+
+namespace {
+
+constexpr char kHttp1CurlMultiWrapper[] = "Http1CurlMultiWrapper";
+// The max time to wait for socket activity, PerformRequest and Stop waking the
+// event thread up earlier.
+constexpr int kPollTimeoutInMs = 1000;
+
+}  // namespace
+
+Http1CurlMultiWrapper::Http1CurlMultiWrapper(size_t max_idle_handles)
+    : max_idle_handles_(max_idle_handles), is_running_(false) {}
+
+ExecutionResult Http1CurlMultiWrapper::Init() noexcept {
+  multi_handle_.reset(curl_multi_init());
+  share_handle_.reset(curl_share_init());
+  if (!multi_handle_ || !share_handle_) {
+    auto result =
+        FailureExecutionResult(errors::SC_CURL_CLIENT_CURL_INIT_ERROR);
+    SCP_ERROR(kHttp1CurlMultiWrapper, kZeroUuid, result,
+              "Failed to create the CURL multi handle.");
+    return result;
+  }
+  // The connections are already shared by the multi handle. The share handle
+  // is only used on the event thread, so it needs no lock callbacks.
+  curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE,
+                    CURL_LOCK_DATA_SSL_SESSION);
+  return SuccessExecutionResult();
+}
+
+ExecutionResult Http1CurlMultiWrapper::Run() noexcept {
+  is_running_ = true;
+  event_thread_ = thread([this]() { RunEventLoop(); });
+  return SuccessExecutionResult();
+}
+
+ExecutionResult Http1CurlMultiWrapper::Stop() noexcept {
+  {
+    // No request is queued once the submitted ones are failed below.
+    lock_guard<mutex> lock(submitted_transfers_lock_);
+    is_running_ = false;
+  }
+  if (!event_thread_.joinable()) {
+    return SuccessExecutionResult();
+  }
+  curl_multi_wakeup(multi_handle_.get());
+  event_thread_.join();
+
+  vector<unique_ptr<Transfer>> transfers;
+  {
+    lock_guard<mutex> lock(submitted_transfers_lock_);
+    transfers.swap(submitted_transfers_);
+  }
+  for (auto& [handle, transfer] : active_transfers_) {
+    curl_multi_remove_handle(multi_handle_.get(), handle);
+    transfers.push_back(move(transfer));
+  }
+  active_transfers_.clear();
+
+  for (auto& transfer : transfers) {
+    transfer->callback(
+        RetryExecutionResult(errors::SC_CURL_CLIENT_NOT_RUNNING));
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult Http1CurlMultiWrapper::PerformRequest(
+    shared_ptr<HttpRequest> request, Callback callback) noexcept {
+  auto transfer = make_unique<Transfer>();
+  transfer->request = move(request);
+  transfer->callback = move(callback);
+  {
+    lock_guard<mutex> lock(submitted_transfers_lock_);
+    if (!is_running_) {
+      return RetryExecutionResult(errors::SC_CURL_CLIENT_NOT_RUNNING);
+    }
+    submitted_transfers_.push_back(move(transfer));
+  }
+  curl_multi_wakeup(multi_handle_.get());
+  return SuccessExecutionResult();
+}
+
+void Http1CurlMultiWrapper::RunEventLoop() noexcept {
+  while (is_running_) {
+    StartSubmittedTransfers();
+
+    int running_transfers = 0;
+    auto multi_result =
+        curl_multi_perform(multi_handle_.get(), &running_transfers);
+    if (multi_result != CURLM_OK) {
+      SCP_ERROR(kHttp1CurlMultiWrapper, kZeroUuid,
+                FailureExecutionResult(errors::SC_CURL_CLIENT_CURL_MULTI_ERROR),
+                "curl_multi_perform failed: %s",
+                curl_multi_strerror(multi_result));
+    }
+    CompleteTransfers();
+
+    curl_multi_poll(multi_handle_.get(), nullptr, 0, kPollTimeoutInMs,
+                    nullptr);
+  }
+}
+
+void Http1CurlMultiWrapper::StartSubmittedTransfers() noexcept {
+  vector<unique_ptr<Transfer>> transfers;
+  {
+    lock_guard<mutex> lock(submitted_transfers_lock_);
+    transfers.swap(submitted_transfers_);
+  }
+
+  for (auto& transfer : transfers) {
+    if (idle_wrappers_.empty()) {
+      auto wrapper_or = Http1CurlWrapper::MakeWrapper();
+      if (!wrapper_or.Successful()) {
+        transfer->callback(wrapper_or.result());
+        continue;
+      }
+      transfer->wrapper = move(*wrapper_or);
+    } else {
+      transfer->wrapper = move(idle_wrappers_.back());
+      idle_wrappers_.pop_back();
+    }
+
+    auto execution_result =
+        transfer->wrapper->SetUpRequest(*transfer->request, transfer->state);
+    if (!execution_result.Successful()) {
+      ReleaseWrapper(move(transfer->wrapper));
+      transfer->callback(execution_result);
+      continue;
+    }
+
+    auto* handle = transfer->wrapper->GetHandle();
+    curl_easy_setopt(handle, CURLOPT_SHARE, share_handle_.get());
+    auto multi_result = curl_multi_add_handle(multi_handle_.get(), handle);
+    if (multi_result != CURLM_OK) {
+      auto result =
+          RetryExecutionResult(errors::SC_CURL_CLIENT_CURL_MULTI_ERROR);
+      SCP_ERROR(kHttp1CurlMultiWrapper, kZeroUuid, result,
+                "curl_multi_add_handle failed: %s",
+                curl_multi_strerror(multi_result));
+      transfer->callback(result);
+      continue;
+    }
+    active_transfers_[handle] = move(transfer);
+  }
+}
+
+void Http1CurlMultiWrapper::CompleteTransfers() noexcept {
+  int queued_messages = 0;
+  while (auto* message =
+             curl_multi_info_read(multi_handle_.get(), &queued_messages)) {
+    if (message->msg != CURLMSG_DONE) {
+      continue;
+    }
+
+    auto* handle = message->easy_handle;
+    auto perform_result = message->data.result;
+    curl_multi_remove_handle(multi_handle_.get(), handle);
+    auto transfer_it = active_transfers_.find(handle);
+    if (transfer_it == active_transfers_.end()) {
+      continue;
+    }
+    auto transfer = move(transfer_it->second);
+    active_transfers_.erase(transfer_it);
+
+    auto response_or =
+        transfer->wrapper->GetResponse(perform_result, transfer->state);
+    ReleaseWrapper(move(transfer->wrapper));
+    transfer->callback(move(response_or));
+  }
+}
+
+void Http1CurlMultiWrapper::ReleaseWrapper(
+    shared_ptr<Http1CurlWrapper> wrapper) noexcept {
+  if (idle_wrappers_.size() < max_idle_handles_) {
+    idle_wrappers_.push_back(move(wrapper));
+  }
+}
+
+}  // namespace google::scp::core
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "core/interface/http_types.h"
+#include "core/interface/service_interface.h"
+#include "public/core/interface/execution_result.h"
+
+#include "http1_curl_wrapper.h"
+
+namespace google::scp::core {
+
+struct CurlMultiHandleDeleter {
+  void operator()(CURLM* ptr) { curl_multi_cleanup(ptr); }
+};
+
+struct CurlShareHandleDeleter {
+  void operator()(CURLSH* ptr) { curl_share_cleanup(ptr); }
+};
+
+// Wrapper around a CURL multi handle performing many HTTP1 requests
+// concurrently on one event thread. The transfers share the connection cache
+// of the multi handle, the DNS cache and the TLS sessions, and the CURL
+// handles are pooled across the requests.
+class Http1CurlMultiWrapper : public ServiceInterface {
+ public:
+  // Is called on the event thread with the response or the failure of the
+  // request, so it must not block.
+  using Callback = std::function<void(ExecutionResultOr<HttpResponse>)>;
+
+  // max_idle_handles is the number of CURL handles kept for reuse once their
+  // transfers complete.
+  explicit Http1CurlMultiWrapper(
+      size_t max_idle_handles = kDefaultMaxIdleHandles);
+
+  ExecutionResult Init() noexcept override;
+  ExecutionResult Run() noexcept override;
+  // Fails the requests still in flight with a retry.
+  ExecutionResult Stop() noexcept override;
+
+  // Queues the request to be performed on the event thread. The callback is
+  // only called if this succeeds.
+  ExecutionResult PerformRequest(std::shared_ptr<HttpRequest> request,
+                                 Callback callback) noexcept;
+
+  static constexpr size_t kDefaultMaxIdleHandles = 64;
+
+ private:
+  // A request and the CURL handle performing it.
+  struct Transfer {
+    std::shared_ptr<HttpRequest> request;
+    Callback callback;
+    std::shared_ptr<Http1CurlWrapper> wrapper;
+    Http1CurlWrapper::RequestState state;
+  };
+
+  // Performs the transfers until stopped.
+  void RunEventLoop() noexcept;
+
+  // Adds the submitted transfers to the multi handle.
+  void StartSubmittedTransfers() noexcept;
+
+  // Calls the callbacks of the completed transfers.
+  void CompleteTransfers() noexcept;
+
+  // Puts the CURL handle of a completed transfer back in the pool.
+  void ReleaseWrapper(std::shared_ptr<Http1CurlWrapper> wrapper) noexcept;
+
+  const size_t max_idle_handles_;
+
+  std::unique_ptr<CURLM, CurlMultiHandleDeleter> multi_handle_;
+
+  std::unique_ptr<CURLSH, CurlShareHandleDeleter> share_handle_;
+
+  // The transfers queued by PerformRequest and not started yet.
+  std::vector<std::unique_ptr<Transfer>> submitted_transfers_;
+
+  // Mutex for the submitted transfers.
+  std::mutex submitted_transfers_lock_;
+
+  // The transfers in flight by CURL handle, only accessed on the event thread,
+  // or once it is stopped.
+  absl::flat_hash_map<CURL*, std::unique_ptr<Transfer>> active_transfers_;
+
+  // The CURL handles free to be reused, only accessed on the event thread.
+  std::vector<std::shared_ptr<Http1CurlWrapper>> idle_wrappers_;
+
+  std::atomic<bool> is_running_;
+
+  std::thread event_thread_;
+};
+
+}  // namespace google::scp::core
@@ -107,26 +107,39 @@ ExecutionResult GetExecutionResultFromCurlError(const string& err_buffer) {
 
 /**
  * @brief Interprets contents as a char* of length byte_size * num_bytes and
- * writes them into output which should be a BytesBuffer*
+ * appends them to the response body of output which should be a
+ * Http1CurlWrapper::RequestState*. The body is sized from the Content-Length
+ * of the response when it is known so that it is not reallocated.
  *
  * https://curl.se/libcurl/c/CURLOPT_WRITEFUNCTION.html
  *
  * @param contents The contents to write to the output
  * @param byte_size The size of each member (char in this case; always 1)
  * @param num_bytes How many members (chars) are in contents
- * @param output A BytesBuffer* to write contents into
+ * @param output A Http1CurlWrapper::RequestState* to write contents into
  * @return size_t The amount of data written
  */
 size_t ResponsePayloadHandler(char* contents, size_t byte_size,
                               size_t num_bytes, void* output) {
-  BytesBuffer* output_buffer = static_cast<BytesBuffer*>(output);
+  auto* state = static_cast<Http1CurlWrapper::RequestState*>(output);
+  BytesBuffer& output_buffer = state->response.body;
   size_t contents_length = byte_size * num_bytes;
-  output_buffer->bytes = make_shared<vector<Byte>>(contents_length);
-  for (size_t i = 0; i < contents_length; i++) {
-    output_buffer->bytes->at(i) = contents[i];
+  size_t required_length = output_buffer.length + contents_length;
+  if (required_length > output_buffer.bytes->size()) {
+    size_t new_size = std::max(required_length, 2 * output_buffer.length);
+    curl_off_t content_length = -1;
+    if (output_buffer.length == 0 &&
+        curl_easy_getinfo(state->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                          &content_length) == CURLE_OK &&
+        content_length > 0) {
+      new_size = std::max(new_size, static_cast<size_t>(content_length));
+    }
+    output_buffer.bytes->resize(new_size);
+    output_buffer.capacity = new_size;
   }
-  output_buffer->length = contents_length;
-  output_buffer->capacity = contents_length;
+  std::copy(contents, contents + contents_length,
+            output_buffer.bytes->begin() + output_buffer.length);
+  output_buffer.length = required_length;
   return contents_length;
 }
 
@@ -191,27 +204,28 @@ size_t ResponseHeaderHandler(char* contents, size_t byte_size, size_t num_bytes,
 }
 
 /**
- * @brief Read the request userdata to contents.
+ * @brief Read the next part of the request body to contents.
  *
  * https://curl.se/libcurl/c/CURLOPT_READFUNCTION.html
  *
  * @param contents The output array to copy userdata into.
  * @param byte_size The size of each member (char in this case; always 1)
  * @param num_bytes How many members (chars) are in contents
- * @param userdata BytesBuffer* of the data to copy into contents
+ * @param userdata Http1CurlWrapper::RequestState* of the body to copy into
+ * contents
  * @return size_t The amount of characters processed.
  */
 size_t RequestReadHandler(char* contents, size_t byte_size, size_t num_bytes,
                           void* userdata) {
-  BytesBuffer* input_buffer = static_cast<BytesBuffer*>(userdata);
-
-  int64_t bytes_to_read = byte_size * num_bytes;
-  if (bytes_to_read > input_buffer->length) {
-    bytes_to_read = input_buffer->length;
-  }
+  auto* state = static_cast<Http1CurlWrapper::RequestState*>(userdata);
+  const BytesBuffer& input_buffer = *state->upload_body;
 
+  size_t bytes_to_read = std::min(byte_size * num_bytes,
+                                  input_buffer.length - state->upload_offset);
   if (bytes_to_read) {
-    memcpy(contents, input_buffer->bytes->data(), bytes_to_read);
+    memcpy(contents, input_buffer.bytes->data() + state->upload_offset,
+           bytes_to_read);
+    state->upload_offset += bytes_to_read;
   }
   return bytes_to_read;
 }
@@ -261,6 +275,7 @@ void Http1CurlWrapper::SetUpPostData(const BytesBuffer& body) {
   if (body.length == 0) {
     return;
   }
+  // CURLOPT_POSTFIELDS does not copy the body, unlike CURLOPT_COPYPOSTFIELDS.
   curl_easy_setopt(curl_.get(), CURLOPT_POSTFIELDS, body.bytes->data());
   // This method of upload supports up to 2GB upload data.
   // See https://curl.se/libcurl/c/CURLOPT_POSTFIELDSIZE_LARGE.html for larger
@@ -268,10 +283,15 @@ void Http1CurlWrapper::SetUpPostData(const BytesBuffer& body) {
   curl_easy_setopt(curl_.get(), CURLOPT_POSTFIELDSIZE, body.length);
 }
 
-void Http1CurlWrapper::SetUpPutData(const BytesBuffer& body) {
+void Http1CurlWrapper::SetUpPutData(const BytesBuffer& body,
+                                    RequestState& state) {
+  // The body is sent in parts straight from the request instead of being
+  // copied upfront.
+  state.upload_body = &body;
+  state.upload_offset = 0;
   curl_easy_setopt(curl_.get(), CURLOPT_READFUNCTION, RequestReadHandler);
 
-  curl_easy_setopt(curl_.get(), CURLOPT_READDATA, &body);
+  curl_easy_setopt(curl_.get(), CURLOPT_READDATA, &state);
 
   curl_easy_setopt(curl_.get(), CURLOPT_INFILESIZE_LARGE, body.length);
 }
@@ -281,9 +301,21 @@ void Http1CurlWrapper::SetUpPutData(const BytesBuffer& body) {
 // body of the response.
 ExecutionResultOr<HttpResponse> Http1CurlWrapper::PerformRequest(
     const HttpRequest& request) {
+  RequestState state;
+  RETURN_IF_FAILURE(SetUpRequest(request, state));
+
+  // Execute the request.
+  return GetResponse(curl_easy_perform(curl_.get()), state);
+}
+
+ExecutionResult Http1CurlWrapper::SetUpRequest(const HttpRequest& request,
+                                               RequestState& state) {
   if (!request.path || request.path->empty()) {
     return FailureExecutionResult(errors::SC_CURL_CLIENT_NO_PATH_SUPPLIED);
   }
+  // The handle may be reused from a previous request.
+  curl_easy_reset(curl_.get());
+  state.handle = curl_.get();
   CURLoption option;
   switch (request.method) {
     case HttpMethod::GET:
@@ -295,7 +327,7 @@ ExecutionResultOr<HttpResponse> Http1CurlWrapper::PerformRequest(
       break;
     case HttpMethod::PUT:
       option = CURLOPT_UPLOAD;
-      SetUpPutData(request.body);
+      SetUpPutData(request.body, state);
       break;
     case HttpMethod::UNKNOWN:
     default:
@@ -305,37 +337,47 @@ ExecutionResultOr<HttpResponse> Http1CurlWrapper::PerformRequest(
 
   auto header_list = AddHeadersToRequest(request.headers);
   RETURN_IF_FAILURE(header_list.result());
+  // No list is returned when there are no headers.
+  if (header_list.has_value()) {
+    state.header_list = move(*header_list);
+  }
   // Build the URL with the escaped path.
   auto uri = GetEscapedUriWithQuery(request);
   RETURN_IF_FAILURE(uri.result());
 
   curl_easy_setopt(curl_.get(), CURLOPT_URL, uri->c_str());
 
-  HttpResponse response;
-  response.headers = make_shared<HttpHeaders>();
-  SetUpResponseHeaderHandler(response.headers.get());
+  state.response.headers = make_shared<HttpHeaders>();
+  SetUpResponseHeaderHandler(state.response.headers.get());
 
   // Add the handler indicating what to do with the returned HTTP response.
   curl_easy_setopt(curl_.get(), CURLOPT_WRITEFUNCTION, ResponsePayloadHandler);
-  curl_easy_setopt(curl_.get(), CURLOPT_WRITEDATA, &response.body);
+  curl_easy_setopt(curl_.get(), CURLOPT_WRITEDATA, &state);
   curl_easy_setopt(curl_.get(), CURLOPT_TIMEOUT, kCurlOptTimeout);
   curl_easy_setopt(curl_.get(), CURLOPT_FAILONERROR, kTrueAsLong);
   // Create a buffer to place any error messages in.
-  string err_str(CURL_ERROR_SIZE, '\0');
-  curl_easy_setopt(curl_.get(), CURLOPT_ERRORBUFFER, err_str.data());
+  state.error_buffer.assign(CURL_ERROR_SIZE, '\0');
+  curl_easy_setopt(curl_.get(), CURLOPT_ERRORBUFFER, state.error_buffer.data());
+  return SuccessExecutionResult();
+}
 
-  // Execute the request.
-  CURLcode perform_res = curl_easy_perform(curl_.get());
-  if (perform_res != CURLE_OK) {
+ExecutionResultOr<HttpResponse> Http1CurlWrapper::GetResponse(
+    CURLcode perform_result, RequestState& state) {
+  if (perform_result != CURLE_OK) {
+    auto& err_str = state.error_buffer;
     auto result = GetExecutionResultFromCurlError(err_str);
     if (err_str.empty()) err_str = "<empty>";
     SCP_ERROR(kHttp1CurlWrapper, kZeroUuid, result,
               "CURL HTTP request failed with error code: %s, message: %s",
-              curl_easy_strerror(perform_res), err_str.c_str());
+              curl_easy_strerror(perform_result), err_str.c_str());
     return result;
   }
-  response.code = errors::HttpStatusCode::OK;
-  return response;
+  state.response.code = errors::HttpStatusCode::OK;
+  // Drop the unused part of the body, which does not reallocate it.
+  auto& body = state.response.body;
+  body.bytes->resize(body.length);
+  body.capacity = body.length;
+  return move(state.response);
 }
 
 Http1CurlWrapper::Http1CurlWrapper(CURL* curl) {
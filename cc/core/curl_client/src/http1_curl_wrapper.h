@@ -42,11 +42,37 @@ class Http1CurlWrapper {
   explicit Http1CurlWrapper(CURL* curl);
   Http1CurlWrapper() = default;
 
+  // The state of a request set up on the CURL handle, which must outlive its
+  // transfer.
+  struct RequestState {
+    std::unique_ptr<curl_slist, CurlListDeleter> header_list;
+    HttpResponse response;
+    std::string error_buffer;
+    // The handle performing the request, to size the response body from its
+    // Content-Length.
+    CURL* handle = nullptr;
+    // The body of a PUT request, read in place, and how much of it was sent.
+    const BytesBuffer* upload_body = nullptr;
+    size_t upload_offset = 0;
+  };
+
   // Performs the request. Logs any error that occurs and returns the status of
   // the request if it failed or an HttpResponse.
   virtual ExecutionResultOr<HttpResponse> PerformRequest(
       const HttpRequest& request);
 
+  // Resets the CURL handle and sets it up for the request, without performing
+  // it. The request must outlive the transfer.
+  ExecutionResult SetUpRequest(const HttpRequest& request, RequestState& state);
+
+  // Returns the response of the request set up on the handle once its transfer
+  // completed with perform_result.
+  ExecutionResultOr<HttpResponse> GetResponse(CURLcode perform_result,
+                                              RequestState& state);
+
+  // The CURL handle, to be added to a CURL multi handle.
+  CURL* GetHandle() { return curl_.get(); }
+
   virtual ~Http1CurlWrapper() = default;
 
  private:
@@ -63,7 +89,7 @@ class Http1CurlWrapper {
   void SetUpPostData(const BytesBuffer& body);
 
   // Sets up the mechanism for uploading the body of a PUT request.
-  void SetUpPutData(const BytesBuffer& body);
+  void SetUpPutData(const BytesBuffer& body, RequestState& state);
 
   std::unique_ptr<CURL, CurlHandleDeleter> curl_;
 };
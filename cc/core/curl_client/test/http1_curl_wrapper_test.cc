@@ -17,7 +17,10 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
+
 #include "core/curl_client/src/error_codes.h"
+#include "core/curl_client/src/http1_curl_multi_wrapper.h"
 #include "core/test/utils/http1_helper/test_http1_server.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 
@@ -26,6 +29,7 @@ using std::get;
 using std::make_shared;
 using std::make_tuple;
 using std::move;
+using std::promise;
 using std::shared_ptr;
 using std::string;
 using std::tuple;
@@ -142,6 +146,30 @@ TEST_F(Http1CurlWrapperTest, PutWorks) {
   EXPECT_EQ(server_.RequestBody(), post_request_body_);
 }
 
+TEST_F(Http1CurlWrapperTest, PutWorksWithLargeBodies) {
+  // Larger than the CURL buffers so that both bodies are sent in parts.
+  string request_body, response_body;
+  for (int i = 0; i < 1 << 20; i++) {
+    request_body.push_back('a' + i % 26);
+    response_body.push_back('A' + i % 26);
+  }
+  HttpRequest request;
+  request.method = HttpMethod::PUT;
+  request.path = make_shared<Uri>(server_.GetPath());
+  request.body = BytesBuffer(request_body);
+
+  server_.SetResponseBody(BytesBuffer(response_body));
+
+  auto response_or = subject_->PerformRequest(request);
+  ASSERT_THAT(response_or, IsSuccessful());
+  EXPECT_EQ(response_or->code, errors::HttpStatusCode::OK);
+  EXPECT_EQ(response_or->body.ToString(), response_body);
+  EXPECT_EQ(response_or->body.bytes->size(), response_body.size());
+
+  EXPECT_EQ(server_.Request().method(), boost::beast::http::verb::put);
+  EXPECT_EQ(server_.RequestBody(), request_body);
+}
+
 TEST_F(Http1CurlWrapperTest, PostWorksWithHeaders) {
   HttpRequest request;
   request.method = HttpMethod::POST;
@@ -253,6 +281,65 @@ TEST_F(Http1CurlWrapperTest, GetPostGetWorks) {
   }
 }
 
+TEST_F(Http1CurlWrapperTest, MultiWrapperReusesHandles) {
+  Http1CurlMultiWrapper multi_wrapper(/*max_idle_handles=*/1);
+  ASSERT_THAT(multi_wrapper.Init(), IsSuccessful());
+  ASSERT_THAT(multi_wrapper.Run(), IsSuccessful());
+
+  auto perform_request = [&multi_wrapper](shared_ptr<HttpRequest> request) {
+    promise<ExecutionResultOr<HttpResponse>> response_promise;
+    auto response_future = response_promise.get_future();
+    EXPECT_THAT(multi_wrapper.PerformRequest(
+                    move(request),
+                    [&response_promise](
+                        ExecutionResultOr<HttpResponse> response_or) {
+                      response_promise.set_value(move(response_or));
+                    }),
+                IsSuccessful());
+    return response_future.get();
+  };
+
+  server_.SetResponseBody(BytesBuffer(response_body_));
+  {
+    auto request = make_shared<HttpRequest>();
+    request->method = HttpMethod::POST;
+    request->path = make_shared<Uri>(server_.GetPath());
+    request->body = BytesBuffer(post_request_body_);
+
+    auto response_or = perform_request(move(request));
+    ASSERT_THAT(response_or, IsSuccessful());
+    EXPECT_EQ(response_or->code, errors::HttpStatusCode::OK);
+    EXPECT_EQ(response_or->body.ToString(), response_body_);
+
+    EXPECT_EQ(server_.Request().method(), boost::beast::http::verb::post);
+    EXPECT_EQ(server_.RequestBody(), post_request_body_);
+  }
+  // The reset handle must not send the body of the previous request.
+  {
+    auto request = make_shared<HttpRequest>();
+    request->method = HttpMethod::GET;
+    request->path = make_shared<Uri>(server_.GetPath());
+
+    auto response_or = perform_request(move(request));
+    ASSERT_THAT(response_or, IsSuccessful());
+    EXPECT_EQ(response_or->code, errors::HttpStatusCode::OK);
+    EXPECT_EQ(response_or->body.ToString(), response_body_);
+
+    EXPECT_EQ(server_.Request().method(), boost::beast::http::verb::get);
+    EXPECT_EQ(server_.RequestBody(), "");
+  }
+
+  EXPECT_THAT(multi_wrapper.Stop(), IsSuccessful());
+
+  auto request = make_shared<HttpRequest>();
+  request->method = HttpMethod::GET;
+  request->path = make_shared<Uri>(server_.GetPath());
+  EXPECT_THAT(multi_wrapper.PerformRequest(
+                  move(request), [](ExecutionResultOr<HttpResponse>) {}),
+              ResultIs(RetryExecutionResult(
+                  errors::SC_CURL_CLIENT_NOT_RUNNING)));
+}
+
 TEST_P(Http1CurlWrapperTest, PropagatesHttpError) {
   HttpRequest request;
   request.method = HttpMethod::GET;
@@ -16,18 +16,35 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
+
+#include <boost/asio.hpp>
 
 #include "core/http2_client/src/http_connection.h"
 
 namespace google::scp::core::http2_client::mock {
 class MockHttpConnection : public HttpConnection {
  public:
+  using HttpConnection::AddPendingNetworkCall;
   using HttpConnection::HttpConnection;
+  using HttpConnection::ReleasePendingNetworkCall;
 
   void CancelPendingCallbacks() noexcept {
-    HttpConnection::CancelPendingCallbacks();
+    // The pending calls are only accessed on the io thread while it runs.
+    if (!worker_ || io_service_->stopped() ||
+        worker_->get_id() == std::this_thread::get_id()) {
+      HttpConnection::CancelPendingCallbacks();
+      return;
+    }
+    std::promise<void> cancelled;
+    boost::asio::post(*io_service_, [this, &cancelled]() {
+      HttpConnection::CancelPendingCallbacks();
+      cancelled.set_value();
+    });
+    cancelled.get_future().wait();
   }
 
   void SetIsDropped() { is_dropped_ = true; }
@@ -38,6 +55,8 @@ class MockHttpConnection : public HttpConnection {
 
   void SetIsReady() { is_ready_ = true; }
 
-  auto& GetPendingNetworkCallbacks() { return pending_network_calls_; }
+  void SetActiveClientRequestsSize(size_t size) {
+    pending_network_call_count_ = size;
+  }
 };
 }  // namespace google::scp::core::http2_client::mock
@@ -33,9 +33,18 @@ class MockHttpConnectionPool : public HttpConnectionPool {
   MockHttpConnectionPool(
       const std::shared_ptr<AsyncExecutorInterface>& async_executor,
       std::shared_ptr<core::MetricRouter> metric_router,
-      size_t max_connection_per_host)
+      size_t max_connection_per_host, size_t min_connection_per_host = 0,
+      size_t scale_up_active_requests_per_connection =
+          kDefaultScaleUpActiveRequestsPerConnection)
       : HttpConnectionPool(async_executor, metric_router,
-                           max_connection_per_host) {}
+                           max_connection_per_host,
+                           kDefaultHttp2ReadTimeoutInSeconds,
+                           min_connection_per_host,
+                           scale_up_active_requests_per_connection) {}
+
+  void SetConnectionScaleDownPeriodInNs(uint64_t period_in_ns) {
+    connection_scale_down_period_in_ns_ = period_in_ns;
+  }
 
   std::shared_ptr<HttpConnection> CreateHttpConnection(
       std::string host, std::string service, bool is_https,
@@ -177,4 +177,7 @@ DEFINE_ERROR_CODE(SC_HTTP2_CLIENT_HTTP_CONNECTION_NOT_READY, SC_HTTP2_CLIENT,
 DEFINE_ERROR_CODE(SC_HTTP2_CLIENT_REQUEST_HEADER_NOT_FOUND, SC_HTTP2_CLIENT,
                   0x00036, "Request header not found.",
                   HttpStatusCode::BAD_REQUEST)
+DEFINE_ERROR_CODE(SC_HTTP2_CLIENT_HTTP_REQUEST_TIMED_OUT, SC_HTTP2_CLIENT,
+                  0x0037, "Http request timed out waiting for the response",
+                  HttpStatusCode::REQUEST_TIMEOUT)
 }  // namespace google::scp::core::errors
@@ -16,16 +16,33 @@
 
 #include "http2_client.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
+#include "cc/core/common/time_provider/src/time_provider.h"
 #include "opentelemetry/metrics/meter.h"
 #include "opentelemetry/metrics/provider.h"
 
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::RetryStrategy;
 using google::scp::core::common::RetryStrategyType;
+using google::scp::core::common::TimeProvider;
+using std::bind;
+using std::lock_guard;
+using std::make_shared;
 using std::make_unique;
+using std::max;
+using std::min;
+using std::mutex;
+using std::nth_element;
 using std::shared_ptr;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::placeholders::_1;
 
 constexpr char kHttpClient[] = "Http2Client";
 
@@ -33,12 +50,19 @@ namespace google::scp::core {
 HttpClient::HttpClient(shared_ptr<AsyncExecutorInterface>& async_executor,
                        HttpClientOptions options,
                        std::shared_ptr<core::MetricRouter> metric_router)
-    : http_connection_pool_(make_unique<HttpConnectionPool>(
+    : async_executor_(async_executor),
+      http_connection_pool_(make_unique<HttpConnectionPool>(
           async_executor, metric_router, options.max_connections_per_host,
-          options.http2_read_timeout_in_sec)),
+          options.http2_read_timeout_in_sec, options.min_connections_per_host,
+          options.scale_up_active_requests_per_connection)),
       operation_dispatcher_(async_executor,
                             RetryStrategy(options.retry_strategy_options)),
-      metric_router_(metric_router) {}
+      metric_router_(metric_router),
+      hedging_min_delay_in_ns_(
+          nanoseconds(milliseconds(options.hedging_min_delay_in_ms)).count()),
+      hedging_delay_in_ns_(hedging_min_delay_in_ns_),
+      response_time_samples_(),
+      response_time_sample_count_(0) {}
 
 ExecutionResult HttpClient::Init() noexcept {
   if (metric_router_) {
@@ -58,6 +82,34 @@ ExecutionResult HttpClient::Stop() noexcept {
 
 ExecutionResult HttpClient::PerformRequest(
     AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  if (hedging_min_delay_in_ns_ > 0 && http_context.request &&
+      http_context.request->is_idempotent) {
+    auto hedged_request = make_shared<HedgedRequest>(http_context);
+    DispatchHedgedRequestAttempt(hedged_request);
+
+    // Sends the request again if it takes longer than most of the recent ones,
+    // the pool picking the least loaded connection for it.
+    auto execution_result = async_executor_->ScheduleFor(
+        [this, hedged_request]() {
+          if (!hedged_request->is_finished.load()) {
+            DispatchHedgedRequestAttempt(hedged_request);
+          }
+        },
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+            hedging_delay_in_ns_.load());
+    if (!execution_result.Successful()) {
+      SCP_DEBUG_CONTEXT(kHttpClient, http_context,
+                        "Cannot schedule the hedged attempt of the request.");
+    }
+    return SuccessExecutionResult();
+  }
+
+  DispatchRequest(http_context);
+  return SuccessExecutionResult();
+}
+
+void HttpClient::DispatchRequest(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
   operation_dispatcher_.Dispatch<AsyncContext<HttpRequest, HttpResponse>>(
       http_context,
       [this](AsyncContext<HttpRequest, HttpResponse>& http_context) mutable {
@@ -75,7 +127,63 @@ ExecutionResult HttpClient::PerformRequest(
 
         return http_connection->Execute(http_context);
       });
+}
 
-  return SuccessExecutionResult();
+void HttpClient::DispatchHedgedRequestAttempt(
+    const shared_ptr<HedgedRequest>& hedged_request) noexcept {
+  hedged_request->pending_attempt_count++;
+  AsyncContext<HttpRequest, HttpResponse> attempt_context(
+      hedged_request->http_context.request,
+      bind(&HttpClient::OnHedgedRequestAttemptCallback, this, hedged_request,
+           TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks(), _1),
+      hedged_request->http_context);
+  attempt_context.expiration_time =
+      hedged_request->http_context.expiration_time;
+  DispatchRequest(attempt_context);
+}
+
+void HttpClient::OnHedgedRequestAttemptCallback(
+    const shared_ptr<HedgedRequest>& hedged_request,
+    Timestamp attempt_start_time_in_ns,
+    AsyncContext<HttpRequest, HttpResponse>& attempt_context) noexcept {
+  auto pending_attempt_count = --hedged_request->pending_attempt_count;
+  if (attempt_context.result.Successful()) {
+    RecordResponseTime(
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() -
+        attempt_start_time_in_ns);
+  } else if (pending_attempt_count > 0) {
+    // Another attempt may still succeed.
+    return;
+  }
+
+  if (hedged_request->is_finished.exchange(true)) {
+    return;
+  }
+
+  auto& http_context = hedged_request->http_context;
+  http_context.response = attempt_context.response;
+  http_context.result = attempt_context.result;
+  http_context.Finish();
+}
+
+void HttpClient::RecordResponseTime(TimeDuration response_time_in_ns) noexcept {
+  vector<TimeDuration> response_times;
+  {
+    lock_guard<mutex> lock(response_time_samples_mutex_);
+    response_time_samples_[response_time_sample_count_++ %
+                           kResponseTimeSampleCount] = response_time_in_ns;
+    if (response_time_sample_count_ % kHedgingDelayUpdateInterval != 0) {
+      return;
+    }
+    response_times.assign(
+        response_time_samples_.begin(),
+        response_time_samples_.begin() +
+            min(response_time_sample_count_, kResponseTimeSampleCount));
+  }
+
+  auto percentile_95 =
+      response_times.begin() + response_times.size() * 95 / 100;
+  nth_element(response_times.begin(), percentile_95, response_times.end());
+  hedging_delay_in_ns_ = max(*percentile_95, hedging_min_delay_in_ns_);
 }
 }  // namespace google::scp::core
@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include "cc/core/interface/async_context.h"
 #include "cc/core/interface/http_client_interface.h"
@@ -38,14 +41,26 @@ struct HttpClientOptions {
             common::RetryStrategyType::Exponential,
             kDefaultRetryStrategyDelayInMs, kDefaultRetryStrategyMaxRetries)),
         max_connections_per_host(kDefaultMaxConnectionsPerHost),
-        http2_read_timeout_in_sec(kDefaultHttp2ReadTimeoutInSeconds) {}
+        http2_read_timeout_in_sec(kDefaultHttp2ReadTimeoutInSeconds),
+        min_connections_per_host(0),
+        scale_up_active_requests_per_connection(
+            kDefaultScaleUpActiveRequestsPerConnection),
+        hedging_min_delay_in_ms(0) {}
 
   HttpClientOptions(common::RetryStrategyOptions retry_strategy_options,
                     size_t max_connections_per_host,
-                    TimeDuration http2_read_timeout_in_sec)
+                    TimeDuration http2_read_timeout_in_sec,
+                    size_t min_connections_per_host = 0,
+                    size_t scale_up_active_requests_per_connection =
+                        kDefaultScaleUpActiveRequestsPerConnection,
+                    TimeDuration hedging_min_delay_in_ms = 0)
       : retry_strategy_options(retry_strategy_options),
         max_connections_per_host(max_connections_per_host),
-        http2_read_timeout_in_sec(http2_read_timeout_in_sec) {}
+        http2_read_timeout_in_sec(http2_read_timeout_in_sec),
+        min_connections_per_host(min_connections_per_host),
+        scale_up_active_requests_per_connection(
+            scale_up_active_requests_per_connection),
+        hedging_min_delay_in_ms(hedging_min_delay_in_ms) {}
 
   /// Retry strategy options.
   const common::RetryStrategyOptions retry_strategy_options;
@@ -53,6 +68,15 @@ struct HttpClientOptions {
   const size_t max_connections_per_host;
   /// nghttp client read timeout.
   const TimeDuration http2_read_timeout_in_sec;
+  /// Min http connections per host, 0 to always use the max.
+  const size_t min_connections_per_host;
+  /// The requests in flight on every connection of a host above which
+  /// another connection is opened.
+  const size_t scale_up_active_requests_per_connection;
+  /// The min time to wait for the response of an idempotent request before
+  /// sending it again, 0 to not hedge the requests. The 95th percentile of the
+  /// recent response times is waited for if longer.
+  const TimeDuration hedging_min_delay_in_ms;
 };
 
 /*! @copydoc HttpClientInterface
@@ -81,6 +105,44 @@ class HttpClient : public HttpClientInterface {
       AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept override;
 
  private:
+  /// The attempts of a hedged request, the first one completing successfully
+  /// or the last one completing finishing the request.
+  struct HedgedRequest {
+    explicit HedgedRequest(
+        const AsyncContext<HttpRequest, HttpResponse>& http_context)
+        : http_context(http_context),
+          is_finished(false),
+          pending_attempt_count(0) {}
+
+    AsyncContext<HttpRequest, HttpResponse> http_context;
+    std::atomic<bool> is_finished;
+    std::atomic<size_t> pending_attempt_count;
+  };
+
+  /// Sends the request on a connection of the pool, retrying it as needed.
+  void DispatchRequest(
+      AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept;
+
+  /// Sends an attempt of the hedged request.
+  void DispatchHedgedRequestAttempt(
+      const std::shared_ptr<HedgedRequest>& hedged_request) noexcept;
+
+  /// Is called when an attempt of the hedged request completes.
+  void OnHedgedRequestAttemptCallback(
+      const std::shared_ptr<HedgedRequest>& hedged_request,
+      Timestamp attempt_start_time_in_ns,
+      AsyncContext<HttpRequest, HttpResponse>& attempt_context) noexcept;
+
+  /// Records the response time of a hedged request attempt, updating the
+  /// hedging delay every kHedgingDelayUpdateInterval samples.
+  void RecordResponseTime(TimeDuration response_time_in_ns) noexcept;
+
+  static constexpr size_t kResponseTimeSampleCount = 256;
+  static constexpr size_t kHedgingDelayUpdateInterval = 32;
+
+  /// An instance of the async executor to schedule the hedged attempts.
+  std::shared_ptr<AsyncExecutorInterface> async_executor_;
+
   /// An instance of the connection pool that is used by the http client.
   std::unique_ptr<HttpConnectionPool> http_connection_pool_;
 
@@ -92,5 +154,20 @@ class HttpClient : public HttpClientInterface {
 
   /// OpenTelemetry Meter used for creating and managing metrics.
   std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+
+  /// The min delay of the hedged attempts, 0 if hedging is disabled.
+  TimeDuration hedging_min_delay_in_ns_;
+
+  /// The delay of the hedged attempts.
+  std::atomic<TimeDuration> hedging_delay_in_ns_;
+
+  /// Guards the response time samples.
+  std::mutex response_time_samples_mutex_;
+
+  /// The recent response times of the hedged request attempts.
+  std::array<TimeDuration, kResponseTimeSampleCount> response_time_samples_;
+
+  /// The number of response times recorded.
+  size_t response_time_sample_count_;
 };
 }  // namespace google::scp::core
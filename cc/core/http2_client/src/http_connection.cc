@@ -27,6 +27,7 @@
 #include <boost/system/error_code.hpp>
 #include <nghttp2/asio_http2.h>
 #include <nghttp2/asio_http2_client.h>
+#include <nghttp2/nghttp2.h>
 
 #include "cc/core/common/global_logger/src/global_logger.h"
 #include "cc/core/common/uuid/src/uuid.h"
@@ -47,14 +48,15 @@ using ::boost::asio::io_context;
 using ::boost::asio::io_service;
 using ::boost::asio::make_work_guard;
 using ::boost::asio::post;
+using ::boost::asio::steady_timer;
 using ::boost::asio::ip::tcp;
 using ::boost::asio::ssl::context;
 using ::boost::posix_time::seconds;
 using ::boost::system::error_code;
 using ::google::scp::core::common::kZeroUuid;
 using ::google::scp::core::common::ToString;
-using ::google::scp::core::common::Uuid;
 using ::google::scp::core::utils::GetEscapedUriWithQuery;
+using ::google::scp::core::utils::MakeBodyDataGenerator;
 using ::nghttp2::asio_http2::header_map;
 using ::nghttp2::asio_http2::client::configure_tls_context;
 using ::nghttp2::asio_http2::client::response;
@@ -95,8 +97,10 @@ HttpConnection::HttpConnection(
       is_https_(is_https),
       http2_read_timeout_in_sec_(http2_read_timeout_in_sec),
       tls_context_(context::sslv23),
+      is_tls_context_configured_(false),
       is_ready_(false),
       is_dropped_(false),
+      pending_network_call_count_(0),
       metric_router_(metric_router) {}
 
 ExecutionResult HttpConnection::Init() noexcept {
@@ -106,16 +110,21 @@ ExecutionResult HttpConnection::Init() noexcept {
         std::make_unique<executor_work_guard<io_context::executor_type>>(
             make_work_guard(io_service_->get_executor()));
 
-    tls_context_.set_default_verify_paths();
-    error_code ec;
-    configure_tls_context(ec, tls_context_);
-    if (ec.failed()) {
-      auto result =
-          FailureExecutionResult(errors::SC_HTTP2_CLIENT_TLS_CTX_ERROR);
-      SCP_ERROR(kHttp2Client, kZeroUuid, result,
-                "Failed to initialize with tls ctx error %s.",
-                ec.message().c_str());
-      return result;
+    // The context outlives the sessions, so a recycled connection does not
+    // load the CA certificates again.
+    if (!is_tls_context_configured_) {
+      tls_context_.set_default_verify_paths();
+      error_code ec;
+      configure_tls_context(ec, tls_context_);
+      if (ec.failed()) {
+        auto result =
+            FailureExecutionResult(errors::SC_HTTP2_CLIENT_TLS_CTX_ERROR);
+        SCP_ERROR(kHttp2Client, kZeroUuid, result,
+                  "Failed to initialize with tls ctx error %s.",
+                  ec.message().c_str());
+        return result;
+      }
+      is_tls_context_configured_ = true;
     }
 
     RETURN_IF_FAILURE(MetricInit());
@@ -341,39 +350,42 @@ void HttpConnection::OnConnectionError() noexcept {
 
     IncrementClientConnectError();
 
-    is_ready_ = false;
+    auto was_ready = is_ready_.exchange(false);
     is_dropped_ = true;
 
     RecordClientConnectionDuration();
 
     CancelPendingCallbacks();
+
+    // A connection that never got established is only retried on demand, so
+    // an unreachable host is not reconnected to in a loop.
+    if (was_ready && on_connection_dropped_callback_) {
+      on_connection_dropped_callback_();
+    }
   });
 }
 
 void HttpConnection::CancelPendingCallbacks() noexcept {
-  std::vector<Uuid> keys;
-  auto execution_result = pending_network_calls_.Keys(keys);
-  if (!execution_result.Successful()) {
-    SCP_ERROR(kHttp2Client, kZeroUuid, execution_result,
-              "Cannot get the list of pending callbacks for the connection.");
-    return;
+  std::vector<AsyncContext<HttpRequest, HttpResponse>> http_contexts;
+  {
+    std::lock_guard lock(submitted_network_calls_lock_);
+    http_contexts.swap(submitted_network_calls_);
   }
+  pending_network_call_count_ -= http_contexts.size();
 
-  for (auto key : keys) {
-    AsyncContext<HttpRequest, HttpResponse> http_context;
-    execution_result = pending_network_calls_.Find(key, http_context);
-
-    if (!execution_result.Successful()) {
-      SCP_ERROR(kHttp2Client, kZeroUuid, execution_result,
-                "Cannot get the callback for the pending call connection.");
-      continue;
-    }
-
-    // If Erase() failed, which means the context has being Finished.
-    if (!pending_network_calls_.Erase(key).Successful()) {
+  for (uint32_t slot = 0; slot < pending_network_calls_.size(); ++slot) {
+    auto& pending_network_call = pending_network_calls_[slot];
+    if (!pending_network_call.is_pending) {
       continue;
     }
+    http_contexts.push_back(pending_network_call.http_context);
+    ReleasePendingNetworkCall(
+        (static_cast<PendingNetworkCallId>(pending_network_call.generation)
+         << 32) |
+        slot);
+  }
 
+  for (auto& http_context : http_contexts) {
     // The http_context should retry if the connection is dropped causing the
     // connection to be recycled.
     if (is_dropped_) {
@@ -390,6 +402,50 @@ void HttpConnection::CancelPendingCallbacks() noexcept {
   }
 }
 
+HttpConnection::PendingNetworkCallId HttpConnection::AddPendingNetworkCall(
+    const AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  uint32_t slot;
+  if (free_pending_network_call_slots_.empty()) {
+    slot = pending_network_calls_.size();
+    pending_network_calls_.emplace_back();
+  } else {
+    slot = free_pending_network_call_slots_.back();
+    free_pending_network_call_slots_.pop_back();
+  }
+
+  auto& pending_network_call = pending_network_calls_[slot];
+  pending_network_call.http_context = http_context;
+  pending_network_call.is_pending = true;
+  return (static_cast<PendingNetworkCallId>(pending_network_call.generation)
+          << 32) |
+         slot;
+}
+
+bool HttpConnection::ReleasePendingNetworkCall(
+    PendingNetworkCallId request_id) noexcept {
+  auto slot = static_cast<uint32_t>(request_id);
+  auto generation = static_cast<uint32_t>(request_id >> 32);
+  if (slot >= pending_network_calls_.size()) {
+    return false;
+  }
+
+  auto& pending_network_call = pending_network_calls_[slot];
+  if (!pending_network_call.is_pending ||
+      pending_network_call.generation != generation) {
+    return false;
+  }
+
+  pending_network_call.is_pending = false;
+  pending_network_call.generation++;
+  // Drops the references to the request, response and callback.
+  pending_network_call.http_context.request = nullptr;
+  pending_network_call.http_context.response = nullptr;
+  pending_network_call.http_context.callback = nullptr;
+  free_pending_network_call_slots_.push_back(slot);
+  pending_network_call_count_--;
+  return true;
+}
+
 void HttpConnection::Reset() noexcept {
   is_ready_ = false;
   is_dropped_ = false;
@@ -397,7 +453,12 @@ void HttpConnection::Reset() noexcept {
 }
 
 size_t HttpConnection::ActiveClientRequestsSize() noexcept {
-  return pending_network_calls_.Size();
+  return pending_network_call_count_.load();
+}
+
+void HttpConnection::SetOnConnectionDroppedCallback(
+    std::function<void()> callback) noexcept {
+  on_connection_dropped_callback_ = std::move(callback);
 }
 
 bool HttpConnection::IsDropped() noexcept {
@@ -418,23 +479,37 @@ ExecutionResult HttpConnection::Execute(
     return failure;
   }
 
-  // This call needs to pass, otherwise there will be orphaned context when
-  // connection drop happens.
-  auto request_id = Uuid::GenerateUuid();
-  auto pair = std::make_pair(request_id, http_context);
-  auto execution_result = pending_network_calls_.Insert(pair, http_context);
-  if (!execution_result.Successful()) {
-    return execution_result;
+  // The context stays reachable by CancelPendingCallbacks until it is
+  // finished, so that it is not orphaned when the connection drops. Only the
+  // first request handed off since the io thread last took them posts.
+  pending_network_call_count_++;
+  bool is_first_submitted;
+  {
+    std::lock_guard lock(submitted_network_calls_lock_);
+    is_first_submitted = submitted_network_calls_.empty();
+    submitted_network_calls_.push_back(http_context);
   }
 
-  post(*io_service_, [this, http_context, request_id]() mutable {
-    SendHttpRequest(request_id, http_context);
-  });
+  if (is_first_submitted) {
+    post(*io_service_, [this]() { SendSubmittedHttpRequests(); });
+  }
   return SuccessExecutionResult();
 }
 
+void HttpConnection::SendSubmittedHttpRequests() noexcept {
+  std::vector<AsyncContext<HttpRequest, HttpResponse>> http_contexts;
+  {
+    std::lock_guard lock(submitted_network_calls_lock_);
+    http_contexts.swap(submitted_network_calls_);
+  }
+
+  for (auto& http_context : http_contexts) {
+    SendHttpRequest(AddPendingNetworkCall(http_context), http_context);
+  }
+}
+
 void HttpConnection::SendHttpRequest(
-    Uuid& request_id,
+    PendingNetworkCallId request_id,
     AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
   std::string method;
   if (http_context.request->method == HttpMethod::GET) {
@@ -442,7 +517,7 @@ void HttpConnection::SendHttpRequest(
   } else if (http_context.request->method == HttpMethod::POST) {
     method = kHttpMethodPostTag;
   } else {
-    if (!pending_network_calls_.Erase(request_id).Successful()) {
+    if (!ReleasePendingNetworkCall(request_id)) {
       return;
     }
 
@@ -462,19 +537,13 @@ void HttpConnection::SendHttpRequest(
     }
   }
 
-  // TODO: handle large data, avoid copy
-  std::string body;
-  if (http_context.request->body.length > 0) {
-    body = {http_context.request->body.bytes->begin(),
-            http_context.request->body.bytes->end()};
-  }
-
   RecordClientRequestBodySize(http_context);
 
   // Erase the header if it is already present.
   headers.erase(kContentLengthHeader);
-  headers.insert({std::string(kContentLengthHeader),
-                  {std::to_string(body.length()), false}});
+  headers.insert(
+      {std::string(kContentLengthHeader),
+       {std::to_string(http_context.request->body.length), false}});
 
   // Erase the header if it is already present.
   headers.erase(kClientActivityIdHeader);
@@ -483,7 +552,7 @@ void HttpConnection::SendHttpRequest(
 
   auto uri = GetEscapedUriWithQuery(*http_context.request);
   if (!uri.Successful()) {
-    if (!pending_network_calls_.Erase(request_id).Successful()) {
+    if (!ReleasePendingNetworkCall(request_id)) {
       return;
     }
 
@@ -496,9 +565,14 @@ void HttpConnection::SendHttpRequest(
   error_code ec;
   std::chrono::time_point<std::chrono::steady_clock> submit_request_time =
       std::chrono::steady_clock::now();
-  auto http_request = session_->submit(ec, method, uri.value(), body, headers);
+  // The body is read in place, it is shared by the request and, for a
+  // forwarded request, by the incoming request it came from.
+  auto http_request =
+      session_->submit(ec, method, uri.value(),
+                       MakeBodyDataGenerator(http_context.request->body),
+                       headers);
   if (ec) {
-    if (!pending_network_calls_.Erase(request_id).Successful()) {
+    if (!ReleasePendingNetworkCall(request_id)) {
       return;
     }
 
@@ -518,17 +592,55 @@ void HttpConnection::SendHttpRequest(
   http_request->on_response(bind(&HttpConnection::OnResponseCallback, this,
                                  http_context, std::placeholders::_1,
                                  submit_request_time));
-  http_request->on_close(bind(&HttpConnection::OnRequestResponseClosed, this,
-                              request_id, http_context, std::placeholders::_1,
-                              submit_request_time));
+
+  // The timer is owned by the stream, to be cancelled once it closes.
+  std::shared_ptr<steady_timer> timeout_timer;
+  if (http_context.request->timeout_in_ms > 0) {
+    timeout_timer = std::make_shared<steady_timer>(
+        *io_service_,
+        std::chrono::milliseconds(http_context.request->timeout_in_ms));
+    timeout_timer->async_wait(bind(&HttpConnection::OnRequestTimedOut, this,
+                                   request_id, http_context, http_request,
+                                   std::placeholders::_1));
+  }
+  http_request->on_close(
+      [this, request_id, http_context, submit_request_time,
+       timeout_timer](uint32_t error_code) mutable {
+        if (timeout_timer) {
+          timeout_timer->cancel();
+        }
+        OnRequestResponseClosed(request_id, http_context, error_code,
+                                submit_request_time);
+      });
+}
+
+void HttpConnection::OnRequestTimedOut(
+    PendingNetworkCallId request_id,
+    AsyncContext<HttpRequest, HttpResponse>& http_context,
+    const nghttp2::asio_http2::client::request* http_request,
+    const error_code& error_code) noexcept {
+  // The request is only still pending, and its stream open, if neither closed
+  // nor cancelled along with the connection.
+  if (error_code || !ReleasePendingNetworkCall(request_id)) {
+    return;
+  }
+
+  http_context.result =
+      RetryExecutionResult(errors::SC_HTTP2_CLIENT_HTTP_REQUEST_TIMED_OUT);
+  SCP_DEBUG_CONTEXT(
+      kHttp2Client, http_context, "Http request timed out after %s ms.",
+      std::to_string(http_context.request->timeout_in_ms).c_str());
+  FinishContext(http_context.result, http_context, async_executor_);
+
+  http_request->cancel(NGHTTP2_CANCEL);
 }
 
 void HttpConnection::OnRequestResponseClosed(
-    Uuid& request_id, AsyncContext<HttpRequest, HttpResponse>& http_context,
-    uint32_t error_code,
+    PendingNetworkCallId request_id,
+    AsyncContext<HttpRequest, HttpResponse>& http_context, uint32_t error_code,
     std::chrono::time_point<std::chrono::steady_clock>
         submit_request_time) noexcept {
-  if (!pending_network_calls_.Erase(request_id).Successful()) {
+  if (!ReleasePendingNetworkCall(request_id)) {
     return;
   }
 
@@ -16,13 +16,15 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <nghttp2/asio_http2_client.h>
 
-#include "cc/core/common/concurrent_map/src/concurrent_map.h"
 #include "cc/core/interface/async_context.h"
 #include "cc/core/interface/async_executor_interface.h"
 #include "cc/core/interface/http_client_interface.h"
@@ -37,6 +39,12 @@ namespace google::scp::core {
 /**
  * @brief HttpConnection uses nghttp2 to establish http2 connections with the
  * remote hosts.
+ *
+ * Every Init resolves the host and makes a full TLS handshake, as the nghttp2
+ * session does both internally and neither takes a resolved endpoint nor
+ * exposes its SSL object for a session to be resumed. Neither is cached, so
+ * HttpConnectionPool recycles the dropped connections in the background to
+ * keep that cost off the requests.
  */
 class HttpConnection : public ServiceInterface {
  public:
@@ -96,7 +104,54 @@ class HttpConnection : public ServiceInterface {
    */
   size_t ActiveClientRequestsSize() noexcept;
 
+  /**
+   * @brief Sets the callback invoked on the io thread once an established
+   * connection is dropped, so that it can be recycled before the next request
+   * needs it. The callback must not stop the connection inline.
+   *
+   * @param callback The callback to invoke.
+   */
+  void SetOnConnectionDroppedCallback(std::function<void()> callback) noexcept;
+
  protected:
+  /// The slot of a pending call in the low 32 bits, and its generation in the
+  /// high ones.
+  using PendingNetworkCallId = uint64_t;
+
+  /// A request sent on the connection, pending until its stream is closed.
+  struct PendingNetworkCall {
+    AsyncContext<HttpRequest, HttpResponse> http_context;
+    /// Bumped every time the slot is released, so that the late callbacks of
+    /// a request cannot release the one reusing its slot.
+    uint32_t generation = 0;
+    bool is_pending = false;
+  };
+
+  /**
+   * @brief Sends the requests handed off by Execute. Is called on the io
+   * thread.
+   */
+  void SendSubmittedHttpRequests() noexcept;
+
+  /**
+   * @brief Adds the request to the pending calls. Is called on the io thread.
+   *
+   * @param http_context The http context of the operation.
+   * @return PendingNetworkCallId The id of the pending call.
+   */
+  PendingNetworkCallId AddPendingNetworkCall(
+      const AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept;
+
+  /**
+   * @brief Removes the request from the pending calls. Is called on the io
+   * thread, and the caller finishing the request is the one it returns true
+   * to.
+   *
+   * @param request_id The id of the pending call.
+   * @return true if the request was still pending.
+   */
+  bool ReleasePendingNetworkCall(PendingNetworkCallId request_id) noexcept;
+
   /**
    * @brief Executes the http requests and sends it over the wire.
    *
@@ -104,25 +159,39 @@ class HttpConnection : public ServiceInterface {
    * @param http_context The http context of the operation.
    */
   void SendHttpRequest(
-      common::Uuid& request_id,
+      PendingNetworkCallId request_id,
       AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept;
 
   /**
    * @brief Is called when the request/response stream is closed either
    * peacefully or with error.
    *
-   * @param request_id The pending call request id to be used to remove the
-   * element from the map.
+   * @param request_id The id of the pending call.
    * @param http_context The http context of the operation.
    * @param error_code The error code of the stream closure operation.
    */
   void OnRequestResponseClosed(
-      common::Uuid& request_id,
+      PendingNetworkCallId request_id,
       AsyncContext<HttpRequest, HttpResponse>& http_context,
       uint32_t error_code,
       std::chrono::time_point<std::chrono::steady_clock>
           submit_request_time) noexcept;
 
+  /**
+   * @brief Is called when the timeout of the request expires or is cancelled.
+   * An expired request is finished with a retry, and its stream cancelled.
+   *
+   * @param request_id The id of the pending call.
+   * @param http_context The http context of the operation.
+   * @param http_request The nghttp2 request of the stream.
+   * @param error_code The error code of the timer.
+   */
+  void OnRequestTimedOut(
+      PendingNetworkCallId request_id,
+      AsyncContext<HttpRequest, HttpResponse>& http_context,
+      const nghttp2::asio_http2::client::request* http_request,
+      const boost::system::error_code& error_code) noexcept;
+
   /**
    * @brief Is called when the response is available to the request issuer.
    *
@@ -158,7 +227,7 @@ class HttpConnection : public ServiceInterface {
 
   /**
    * @brief Cancels all the pending callbacks. This is used during connection
-   * drop or stop.
+   * drop or stop, on the io thread or once it is stopped.
    */
   virtual void CancelPendingCallbacks() noexcept;
 
@@ -273,14 +342,34 @@ class HttpConnection : public ServiceInterface {
   // The tls configuration.
   boost::asio::ssl::context tls_context_;
 
+  // Indicates if the tls configuration is loaded, which is only done once as
+  // loading the CA certificates is costly.
+  bool is_tls_context_configured_;
+
+  // Invoked once an established connection is dropped.
+  std::function<void()> on_connection_dropped_callback_;
+
   // Indicates if the connection is ready to be used.
   std::atomic<bool> is_ready_;
 
   // Indicates if the connection is dropped.
   std::atomic<bool> is_dropped_;
-  common::ConcurrentMap<common::Uuid, AsyncContext<HttpRequest, HttpResponse>,
-                        common::UuidCompare>
-      pending_network_calls_;
+
+  // The requests handed off to the io thread and not sent yet.
+  std::vector<AsyncContext<HttpRequest, HttpResponse>> submitted_network_calls_;
+
+  // Mutex for the requests handed off to the io thread.
+  std::mutex submitted_network_calls_lock_;
+
+  // The requests sent, indexed by slot. Only accessed on the io thread, or
+  // once it is stopped.
+  std::vector<PendingNetworkCall> pending_network_calls_;
+
+  // The slots of the pending calls free to be reused.
+  std::vector<uint32_t> free_pending_network_call_slots_;
+
+  // The number of requests executed and not finished yet.
+  std::atomic<size_t> pending_network_call_count_;
 
  private:
   /**
@@ -16,8 +16,11 @@
  */
 #include "cc/core/http2_client/src/http_connection_pool.h"
 
+#include <chrono>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +30,7 @@
 #include <nghttp2/asio_http2.h>
 
 #include "cc/core/common/global_logger/src/global_logger.h"
+#include "cc/core/common/time_provider/src/time_provider.h"
 #include "cc/core/http2_client/src/error_codes.h"
 #include "cc/core/http2_client/src/http_client_def.h"
 #include "cc/core/http2_client/src/http_connection.h"
@@ -36,12 +40,19 @@
 using boost::algorithm::to_lower;
 using boost::system::error_code;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
 using nghttp2::asio_http2::host_service_from_uri;
 using std::lock_guard;
 using std::make_shared;
+using std::mt19937;
+using std::random_device;
 using std::shared_ptr;
 using std::string;
+using std::uniform_int_distribution;
 using std::vector;
+using std::weak_ptr;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
 
 static constexpr char kHttpsTag[] = "https";
 static constexpr char kHttpTag[] = "http";
@@ -114,8 +125,10 @@ ExecutionResult HttpConnectionPool::Stop() noexcept {
       return execution_result;
     }
 
-    for (auto connection : entry->http_connections) {
-      execution_result = connection->Stop();
+    // The connections never started or already stopped cannot be stopped.
+    lock_guard lock(connection_lock_);
+    for (size_t i = 0; i < entry->started_connection_count; ++i) {
+      execution_result = entry->http_connections[i]->Stop();
       if (!execution_result.Successful()) {
         return execution_result;
       }
@@ -161,40 +174,51 @@ ExecutionResult HttpConnectionPool::GetConnection(
     return FailureExecutionResult(errors::SC_HTTP2_CLIENT_INVALID_URI);
   }
 
-  auto http_connection_entry = make_shared<HttpConnectionPoolEntry>();
-  auto pair = std::make_pair(host + ":" + service, http_connection_entry);
-  if (connections_.Insert(pair, http_connection_entry).Successful()) {
-    for (size_t i = 0; i < max_connections_per_host_; ++i) {
-      auto http_connection = CreateHttpConnection(host, service, is_https,
-                                                  http2_read_timeout_in_sec_);
-      http_connection_entry->http_connections.push_back(http_connection);
-      auto execution_result = http_connection->Init();
+  // The entry is only created once per host, so the common path is a lookup.
+  auto key = host + ":" + service;
+  shared_ptr<HttpConnectionPoolEntry> http_connection_entry;
+  if (!connections_.Find(key, http_connection_entry).Successful()) {
+    http_connection_entry = make_shared<HttpConnectionPoolEntry>();
+    auto pair = std::make_pair(key, http_connection_entry);
+    if (connections_.Insert(pair, http_connection_entry).Successful()) {
+      auto& http_connections = http_connection_entry->http_connections;
+      for (size_t i = 0; i < max_connections_per_host_; ++i) {
+        http_connections.push_back(CreateHttpConnection(
+            host, service, is_https, http2_read_timeout_in_sec_));
+        http_connections.back()->SetOnConnectionDroppedCallback(
+            [this, weak_connection = weak_ptr<HttpConnection>(
+                       http_connections.back())]() {
+              if (auto connection = weak_connection.lock()) {
+                ScheduleRecycleConnection(connection);
+              }
+            });
+      }
 
-      if (!execution_result.Successful()) {
-        // Stop the connections already created before.
-        http_connection_entry->http_connections.pop_back();
-        for (auto& http_connection : http_connection_entry->http_connections) {
-          http_connection->Stop();
+      for (size_t i = 0; i < min_connections_per_host_; ++i) {
+        auto& http_connection = http_connections[i];
+        auto execution_result = http_connection->Init();
+        if (execution_result.Successful()) {
+          execution_result = http_connection->Run();
         }
-        connections_.Erase(pair.first);
-        return execution_result;
-      }
 
-      execution_result = http_connection->Run();
-      if (!execution_result.Successful()) {
-        // Stop the connections already created before.
-        http_connection_entry->http_connections.pop_back();
-        for (auto& http_connection : http_connection_entry->http_connections) {
-          http_connection->Stop();
+        if (!execution_result.Successful()) {
+          // Stop the connections already started before.
+          for (size_t j = 0; j < i; ++j) {
+            http_connections[j]->Stop();
+          }
+          connections_.Erase(pair.first);
+          return execution_result;
         }
-        connections_.Erase(pair.first);
-        return execution_result;
+        SCP_INFO(kHttpConnection, kZeroUuid,
+                 "Successfully initialized a connection %p for %s",
+                 http_connection.get(), pair.first.c_str());
       }
-      SCP_INFO(kHttpConnection, kZeroUuid,
-               "Successfully initialized a connection %p for %s",
-               http_connection.get(), pair.first.c_str());
+      http_connection_entry->active_connection_count =
+          min_connections_per_host_;
+      http_connection_entry->started_connection_count =
+          min_connections_per_host_;
+      http_connection_entry->is_initialized = true;
     }
-    http_connection_entry->is_initialized = true;
   }
 
   if (!http_connection_entry->is_initialized.load()) {
@@ -202,35 +226,132 @@ ExecutionResult HttpConnectionPool::GetConnection(
         errors::SC_HTTP2_CLIENT_NO_CONNECTION_ESTABLISHED);
   }
 
+  // The connections are not added or removed once the entry is initialized,
+  // so they are read without locking.
+  const auto& http_connections = http_connection_entry->http_connections;
+  auto active_connection_count =
+      http_connection_entry->active_connection_count.load();
   auto value = http_connection_entry->order_counter.fetch_add(1);
-  auto connections_index = value % max_connections_per_host_;
-  connection = http_connection_entry->http_connections.at(connections_index);
-
-  if (connection->IsDropped()) {
-    RecycleConnection(connection);
-    // If the current connection is not ready, pick another connection that is
-    // ready. This allows the caller's request execution attempt to not go
-    // waste.
-    if (!connection->IsReady()) {
-      size_t cur_index = connections_index;
-      for (int i = 0; i < http_connection_entry->http_connections.size(); i++) {
-        auto http_connection =
-            http_connection_entry->http_connections[cur_index];
-        if (http_connection->IsReady()) {
-          connection = http_connection;
-          break;
-        }
-        cur_index = (cur_index + 1) % max_connections_per_host_;
+  auto connections_index = value % active_connection_count;
+  connection = http_connections.at(connections_index);
+
+  auto is_dropped = connection->IsDropped();
+  if (is_dropped) {
+    ScheduleRecycleConnection(connection);
+  }
+
+  // Pick the ready connection with the fewest requests in flight, so that a
+  // connection stuck behind slow streams does not get its share of the new
+  // requests. The search starts at the round robin index, which spreads the
+  // requests evenly among the equally loaded connections.
+  auto least_active_requests = std::numeric_limits<size_t>::max();
+  for (size_t i = 0; i < active_connection_count && least_active_requests > 0;
+       ++i) {
+    const auto& http_connection =
+        http_connections[(connections_index + i) % active_connection_count];
+    if (!http_connection->IsReady()) {
+      continue;
+    }
+    auto active_requests = http_connection->ActiveClientRequestsSize();
+    if (active_requests < least_active_requests) {
+      least_active_requests = active_requests;
+      connection = http_connection;
+    }
+  }
+
+  // Return a retry if a dropped connection was picked and none is ready. A
+  // connection still being established is returned as before, executing on
+  // it returns a retry.
+  if (is_dropped && !connection->IsReady()) {
+    return RetryExecutionResult(
+        errors::SC_HTTP2_CLIENT_HTTP_CONNECTION_NOT_READY);
+  }
+
+  ScaleConnections(*http_connection_entry, least_active_requests);
+  return SuccessExecutionResult();
+}
+
+void HttpConnectionPool::ScaleConnections(
+    HttpConnectionPoolEntry& entry, size_t least_active_requests) noexcept {
+  if (min_connections_per_host_ == max_connections_per_host_ ||
+      least_active_requests == std::numeric_limits<size_t>::max()) {
+    return;
+  }
+
+  uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  auto is_saturated =
+      least_active_requests >= scale_up_active_requests_per_connection_;
+  if (is_saturated) {
+    entry.last_scaling_time_in_ns = now;
+    if (entry.active_connection_count.load() >= max_connections_per_host_) {
+      return;
+    }
+  } else if (now < entry.last_scaling_time_in_ns.load() +
+                        connection_scale_down_period_in_ns_) {
+    return;
+  }
+
+  std::unique_lock lock(connection_lock_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+
+  auto active_connection_count = entry.active_connection_count.load();
+  if (is_saturated) {
+    if (active_connection_count >= max_connections_per_host_) {
+      return;
+    }
+    // A draining connection is put back in use as is.
+    if (active_connection_count == entry.started_connection_count) {
+      auto& connection = entry.http_connections[active_connection_count];
+      connection->Reset();
+      auto execution_result = connection->Init();
+      if (execution_result.Successful()) {
+        execution_result = connection->Run();
       }
-      // Return a retry if we are not able to pick a ready connection.
-      if (!connection->IsReady()) {
-        return RetryExecutionResult(
-            errors::SC_HTTP2_CLIENT_HTTP_CONNECTION_NOT_READY);
+      if (!execution_result.Successful()) {
+        SCP_ERROR(kHttpConnection, kZeroUuid, execution_result,
+                  "Cannot start connection %p to scale up.", connection.get());
+        return;
       }
+      entry.started_connection_count++;
     }
+    entry.active_connection_count = active_connection_count + 1;
+    SCP_INFO(kHttpConnection, kZeroUuid,
+             "Scaled up to %zu connections in use.",
+             active_connection_count + 1);
+    return;
   }
 
-  return SuccessExecutionResult();
+  if (now < entry.last_scaling_time_in_ns.load() +
+                 connection_scale_down_period_in_ns_) {
+    return;
+  }
+  entry.last_scaling_time_in_ns = now;
+
+  // The requests picking a connection while it is taken out of use may still
+  // be sent on it, so it is only stopped a scale down period later.
+  if (entry.started_connection_count > active_connection_count) {
+    auto& connection =
+        entry.http_connections[entry.started_connection_count - 1];
+    if (connection->ActiveClientRequestsSize() == 0) {
+      // Resetting it makes a recycle scheduled before a no-op.
+      connection->Stop();
+      connection->Reset();
+      entry.started_connection_count--;
+      SCP_INFO(kHttpConnection, kZeroUuid,
+               "Stopped drained connection %p.", connection.get());
+    }
+  }
+
+  if (active_connection_count > min_connections_per_host_) {
+    entry.active_connection_count = active_connection_count - 1;
+    SCP_INFO(kHttpConnection, kZeroUuid,
+             "Scaled down to %zu connections in use.",
+             active_connection_count - 1);
+  }
 }
 
 void HttpConnectionPool::RecycleConnection(
@@ -250,6 +371,44 @@ void HttpConnectionPool::RecycleConnection(
             "Successfully recycled connection %p", connection.get());
 }
 
+void HttpConnectionPool::ScheduleRecycleConnection(
+    const shared_ptr<HttpConnection>& connection) noexcept {
+  static random_device random_device_local;
+  static mt19937 random_generator(random_device_local());
+  static uniform_int_distribution<uint64_t> distribution(
+      0, kMaxConnectionRecycleDelayInMs);
+
+  uint64_t delay_in_ms;
+  {
+    lock_guard lock(connections_to_recycle_lock_);
+    if (!connections_to_recycle_.insert(connection.get()).second) {
+      return;
+    }
+    delay_in_ms = distribution(random_generator);
+  }
+
+  auto execution_result = async_executor_->ScheduleFor(
+      [this, connection]() {
+        {
+          lock_guard lock(connections_to_recycle_lock_);
+          connections_to_recycle_.erase(connection.get());
+        }
+        if (is_running_.load()) {
+          auto connection_to_recycle = connection;
+          RecycleConnection(connection_to_recycle);
+        }
+      },
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+          nanoseconds(milliseconds(delay_in_ms)).count());
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kHttpConnection, kZeroUuid, execution_result,
+              "Cannot schedule the recycle of connection %p.",
+              connection.get());
+    lock_guard lock(connections_to_recycle_lock_);
+    connections_to_recycle_.erase(connection.get());
+  }
+}
+
 void HttpConnectionPool::ObserveClientActiveRequestsCallback(
     opentelemetry::metrics::ObserverResult observer_result,
     absl::Nonnull<HttpConnectionPool*> self_ptr) {
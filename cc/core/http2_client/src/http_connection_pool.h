@@ -17,9 +17,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_set>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -39,7 +42,14 @@ namespace google::scp::core {
 /**
  * @brief Provides connection pool functionality. Once the object is created,
  * the caller can get a connection to the remote host by calling get connection.
- * The order of the connections is chosen in a round robin fashion.
+ * The ready connection with the fewest requests in flight is chosen, the ties
+ * being broken in a round robin fashion.
+ *
+ * Between the min and max connections per host are in use. One more is opened
+ * when every connection in use has enough requests in flight, and the last one
+ * is taken out of use after a scale down period without that happening. It is
+ * stopped once idle, a scale down period later, unless it is put back in use
+ * before.
  *
  */
 class HttpConnectionPool : public ServiceInterface {
@@ -49,14 +59,28 @@ class HttpConnectionPool : public ServiceInterface {
    * the active connections.
    */
   struct HttpConnectionPoolEntry {
-    HttpConnectionPoolEntry() : is_initialized(false), order_counter(0) {}
-
-    /// The current cached connections.
+    HttpConnectionPoolEntry()
+        : is_initialized(false),
+          order_counter(0),
+          active_connection_count(0),
+          started_connection_count(0),
+          last_scaling_time_in_ns(0) {}
+
+    /// The current cached connections, the max connections per host of them.
     std::vector<std::shared_ptr<HttpConnection>> http_connections;
     /// Indicates whether the entry is initialized.
     std::atomic<bool> is_initialized;
-    /// Is used to apply a round robin fashion selection of the connections.
+    /// Is used to break the ties between the equally loaded connections in a
+    /// round robin fashion.
     std::atomic<uint64_t> order_counter;
+    /// The number of connections in use, the first ones of the cached ones.
+    std::atomic<size_t> active_connection_count;
+    /// The number of connections started, the ones above the connections in
+    /// use draining before being stopped. Only changed under connection_lock_
+    /// once the entry is initialized.
+    size_t started_connection_count;
+    /// The last time the connections in use were all busy or were scaled.
+    std::atomic<uint64_t> last_scaling_time_in_ns;
   };
 
   /// Callback to be used with an OTel ObservableInstrument for client active
@@ -81,15 +105,30 @@ class HttpConnectionPool : public ServiceInterface {
    * @param async_executor An instance of the async executor.
    * @param max_connections_per_host The max number of connections created per
    * host.
+   * @param min_connections_per_host The min number of connections in use per
+   * host, 0 to always use the max.
+   * @param scale_up_active_requests_per_connection The requests in flight on
+   * every connection in use above which another one is opened.
    */
   explicit HttpConnectionPool(
       const std::shared_ptr<AsyncExecutorInterface>& async_executor,
       std::shared_ptr<core::MetricRouter> metric_router,
       size_t max_connections_per_host = kDefaultMaxConnectionsPerHost,
       TimeDuration http2_read_timeout_in_sec =
-          kDefaultHttp2ReadTimeoutInSeconds)
+          kDefaultHttp2ReadTimeoutInSeconds,
+      size_t min_connections_per_host = 0,
+      size_t scale_up_active_requests_per_connection =
+          kDefaultScaleUpActiveRequestsPerConnection)
       : async_executor_(async_executor),
         max_connections_per_host_(max_connections_per_host),
+        min_connections_per_host_(
+            min_connections_per_host == 0
+                ? max_connections_per_host
+                : std::min(min_connections_per_host, max_connections_per_host)),
+        scale_up_active_requests_per_connection_(
+            std::max<size_t>(scale_up_active_requests_per_connection, 1)),
+        connection_scale_down_period_in_ns_(
+            kDefaultConnectionScaleDownPeriodInNs),
         http2_read_timeout_in_sec_(http2_read_timeout_in_sec),
         is_running_(false),
         metric_router_(metric_router) {}
@@ -131,12 +170,44 @@ class HttpConnectionPool : public ServiceInterface {
   virtual void RecycleConnection(
       std::shared_ptr<HttpConnection>& connection) noexcept;
 
+  /**
+   * @brief Recycles the dropped connection in the background after a random
+   * delay of up to kMaxConnectionRecycleDelayInMs, so that no request waits
+   * for the reconnect and the connections dropped together by a network blip
+   * are not all reconnected at once.
+   *
+   * @param connection The connection to be recycled.
+   */
+  void ScheduleRecycleConnection(
+      const std::shared_ptr<HttpConnection>& connection) noexcept;
+
+  /**
+   * @brief Scales the connections in use of a host up or down, and stops the
+   * draining one once idle. Does nothing if another thread is already at it.
+   *
+   * @param entry The connections of the host.
+   * @param least_active_requests The requests in flight on the least busy
+   * connection in use, if any is ready.
+   */
+  void ScaleConnections(HttpConnectionPoolEntry& entry,
+                        size_t least_active_requests) noexcept;
+
   /// Instance of the async executor.
   const std::shared_ptr<AsyncExecutorInterface> async_executor_;
 
   /// Max number of connections per host.
   size_t max_connections_per_host_;
 
+  /// Min number of connections in use per host.
+  size_t min_connections_per_host_;
+
+  /// The requests in flight on every connection in use to open another one.
+  size_t scale_up_active_requests_per_connection_;
+
+  /// The time without every connection busy to take one out of use, and the
+  /// time it is drained for before being stopped.
+  uint64_t connection_scale_down_period_in_ns_;
+
   /// http2 connection read timeout in seconds.
   TimeDuration http2_read_timeout_in_sec_;
 
@@ -147,9 +218,15 @@ class HttpConnectionPool : public ServiceInterface {
 
   /// Indicates whether the connection pool is running.
   std::atomic<bool> is_running_;
-  /// Mutex for recycling connection
+  /// Mutex for recycling and scaling the connections.
   std::mutex connection_lock_;
 
+  /// The connections with a recycle scheduled, so that it is only scheduled
+  /// once however many requests find them dropped.
+  std::unordered_set<HttpConnection*> connections_to_recycle_;
+  /// Mutex for the connections with a recycle scheduled.
+  std::mutex connections_to_recycle_lock_;
+
   /// An instance of metric router which will provide APIs to create metrics.
   std::shared_ptr<core::MetricRouter> metric_router_;
 
@@ -167,5 +244,10 @@ class HttpConnectionPool : public ServiceInterface {
   /// OpenTelemetry Instrument for client address resolution errors.
   std::shared_ptr<opentelemetry::metrics::Counter<uint64_t>>
       client_address_errors_counter_;
+
+ private:
+  static constexpr uint64_t kDefaultConnectionScaleDownPeriodInNs =
+      60ULL * 1000 * 1000 * 1000;
+  static constexpr uint64_t kMaxConnectionRecycleDelayInMs = 50;
 };
 }  // namespace google::scp::core
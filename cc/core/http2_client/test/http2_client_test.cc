@@ -117,6 +117,16 @@ class HttpServer {
       res.end("hello, world\n");
     });
 
+    // Never answers the first request.
+    server.handle("/hang_once", [this](const request& req,
+                                       const response& res) {
+      if (hang_once_request_count_++ == 0) {
+        return;
+      }
+      res.write_head(200);
+      res.end("hello, world\n");
+    });
+
     server.handle(
         "/pingpong_query_param", [](const request& req, const response& res) {
           res.write_head(200, {{"query_param", {req.uri().raw_query.c_str()}}});
@@ -170,6 +180,7 @@ class HttpServer {
 
  private:
   atomic<bool> is_running_{false};
+  atomic<size_t> hang_once_request_count_{0};
   string address_;
   string port_;
   size_t num_threads_;
@@ -429,4 +440,55 @@ TEST_F(HttpClientTestII, ClientFinishesContextWhenServerIsStopped) {
   }
 }
 
+TEST_F(HttpClientTestII, TimedOutRequestIsRetried) {
+  auto request = make_shared<HttpRequest>();
+  request->method = HttpMethod::GET;
+  request->path = make_shared<string>("http://localhost:" +
+                                      std::to_string(server->PortInUse()) +
+                                      "/hang_once");
+  request->timeout_in_ms = 100;
+  promise<void> done;
+  AsyncContext<HttpRequest, HttpResponse> context(
+      move(request), [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        done.set_value();
+      });
+
+  EXPECT_SUCCESS(http_client->PerformRequest(context));
+  // Long before the read timeout of the connection.
+  EXPECT_EQ(done.get_future().wait_for(5s), std::future_status::ready);
+}
+
+TEST_F(HttpClientTestII, IdempotentRequestIsHedged) {
+  auto options = HttpClientOptions(
+      RetryStrategyOptions(RetryStrategyType::Exponential,
+                           kDefaultRetryStrategyDelayInMs,
+                           kDefaultRetryStrategyMaxRetries),
+      kDefaultMaxConnectionsPerHost, kHttp2ReadTimeoutInSeconds,
+      0 /* min_connections_per_host */,
+      kDefaultScaleUpActiveRequestsPerConnection,
+      50 /* hedging_min_delay_in_ms */);
+  HttpClient hedging_http_client(async_executor, options);
+  EXPECT_SUCCESS(hedging_http_client.Init());
+  EXPECT_SUCCESS(hedging_http_client.Run());
+
+  auto request = make_shared<HttpRequest>();
+  request->method = HttpMethod::GET;
+  request->path = make_shared<string>("http://localhost:" +
+                                      std::to_string(server->PortInUse()) +
+                                      "/hang_once");
+  request->is_idempotent = true;
+  promise<void> done;
+  AsyncContext<HttpRequest, HttpResponse> context(
+      move(request), [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        const auto& bytes = *context.response->body.bytes;
+        EXPECT_EQ(string(bytes.begin(), bytes.end()), "hello, world\n");
+        done.set_value();
+      });
+
+  EXPECT_SUCCESS(hedging_http_client.PerformRequest(context));
+  EXPECT_EQ(done.get_future().wait_for(5s), std::future_status::ready);
+  EXPECT_SUCCESS(hedging_http_client.Stop());
+}
 }  // namespace google::scp::core
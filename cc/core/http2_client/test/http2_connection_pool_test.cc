@@ -16,6 +16,7 @@
 #include <gtest/gtest.h>
 
 #include "cc/core/async_executor/mock/mock_async_executor.h"
+#include "cc/core/common/uuid/src/uuid.h"
 #include "cc/core/http2_client/mock/mock_http_connection.h"
 #include "cc/core/http2_client/mock/mock_http_connection_pool_with_overrides.h"
 #include "cc/core/http2_client/src/error_codes.h"
@@ -335,6 +336,161 @@ TEST_F(HttpConnectionPoolTest,
   EXPECT_EQ(connection2, connections[0]);
 }
 
+TEST_F(HttpConnectionPoolTest,
+       GetConnectionReturnsReadyConnectionWithFewestActiveRequests) {
+  std::vector<std::shared_ptr<MockHttpConnection>> mock_connections;
+  connection_pool_->create_connection_override_ =
+      [&, async_executor = async_executor_](
+          std::string host, std::string service, bool is_https) {
+        auto connection = std::make_shared<MockHttpConnection>(
+            async_executor, host, service, is_https, metric_router_.get());
+        connection->SetIsNotDropped();
+        connection->SetIsReady();
+        mock_connections.push_back(connection);
+        std::shared_ptr<HttpConnection> connection_ptr = connection;
+        return connection_ptr;
+      };
+  auto add_active_request = [](MockHttpConnection& connection) {
+    connection.SetActiveClientRequestsSize(
+        connection.ActiveClientRequestsSize() + 1);
+  };
+
+  auto uri = std::make_shared<Uri>("https://www.google.com:80");
+  std::shared_ptr<HttpConnection> connection;
+  ASSERT_SUCCESS(connection_pool_->GetConnection(uri, connection));
+  ASSERT_EQ(mock_connections.size(), num_connections_per_host_);
+  EXPECT_EQ(connection, mock_connections[0]);
+
+  // The round robin pick is skipped when it is busier than the next one.
+  add_active_request(*mock_connections[1]);
+  ASSERT_SUCCESS(connection_pool_->GetConnection(uri, connection));
+  EXPECT_EQ(connection, mock_connections[2]);
+
+  // Only the idle connection is picked, wherever the search starts.
+  for (size_t i = 0; i < num_connections_per_host_; ++i) {
+    if (i != 5) {
+      add_active_request(*mock_connections[i]);
+    }
+  }
+  for (size_t i = 0; i < num_connections_per_host_; ++i) {
+    ASSERT_SUCCESS(connection_pool_->GetConnection(uri, connection));
+    EXPECT_EQ(connection, mock_connections[5]);
+  }
+
+  // Among the equally loaded connections, the round robin pick is kept.
+  add_active_request(*mock_connections[5]);
+  ASSERT_SUCCESS(connection_pool_->GetConnection(uri, connection));
+  EXPECT_EQ(connection, mock_connections[2]);
+}
+
+TEST_F(HttpConnectionPoolTest, GetConnectionScalesConnectionsInUse) {
+  auto connection_pool = std::make_shared<MockHttpConnectionPool>(
+      async_executor_, metric_router_, /*max_connection_per_host=*/2,
+      /*min_connection_per_host=*/1,
+      /*scale_up_active_requests_per_connection=*/2);
+  connection_pool->SetConnectionScaleDownPeriodInNs(0);
+  std::vector<std::shared_ptr<MockHttpConnection>> mock_connections;
+  connection_pool->create_connection_override_ =
+      [&, async_executor = async_executor_](
+          std::string host, std::string service, bool is_https) {
+        auto connection = std::make_shared<MockHttpConnection>(
+            async_executor, host, service, is_https, metric_router_.get());
+        connection->SetIsNotDropped();
+        connection->SetIsReady();
+        mock_connections.push_back(connection);
+        std::shared_ptr<HttpConnection> connection_ptr = connection;
+        return connection_ptr;
+      };
+  auto add_active_requests = [](MockHttpConnection& connection) {
+    connection.SetActiveClientRequestsSize(
+        connection.ActiveClientRequestsSize() + 2);
+  };
+  ASSERT_SUCCESS(connection_pool->Init());
+  ASSERT_SUCCESS(connection_pool->Run());
+
+  auto uri = std::make_shared<Uri>("https://www.google.com:80");
+  std::shared_ptr<HttpConnection> connection;
+  ASSERT_SUCCESS(connection_pool->GetConnection(uri, connection));
+  ASSERT_EQ(mock_connections.size(), 2);
+  EXPECT_EQ(connection, mock_connections[0]);
+
+  // The busy connection gets another one started next to it.
+  add_active_requests(*mock_connections[0]);
+  ASSERT_SUCCESS(connection_pool->GetConnection(uri, connection));
+  EXPECT_EQ(connection, mock_connections[0]);
+  EXPECT_FALSE(mock_connections[1]->IsReady());
+  mock_connections[1]->SetIsReady();
+
+  // The idle connection is picked, then taken out of use but not stopped.
+  ASSERT_SUCCESS(connection_pool->GetConnection(uri, connection));
+  EXPECT_EQ(connection, mock_connections[1]);
+  EXPECT_TRUE(mock_connections[1]->IsReady());
+
+  // Once the connection in use is idle, the drained one is stopped.
+  mock_connections[0]->SetActiveClientRequestsSize(0);
+  ASSERT_SUCCESS(connection_pool->GetConnection(uri, connection));
+  EXPECT_EQ(connection, mock_connections[0]);
+  EXPECT_FALSE(mock_connections[1]->IsReady());
+
+  EXPECT_SUCCESS(connection_pool->Stop());
+}
+
+TEST_F(HttpConnectionPoolTest,
+       GetConnectionSchedulesTheRecycleOfADroppedConnectionOnce) {
+  std::vector<AsyncOperation> scheduled_works;
+  std::dynamic_pointer_cast<MockAsyncExecutor>(async_executor_)
+      ->schedule_for_mock = [&](const AsyncOperation& work, Timestamp,
+                                std::function<bool()>&) {
+    scheduled_works.push_back(work);
+    return SuccessExecutionResult();
+  };
+  std::vector<std::shared_ptr<HttpConnection>> recycled_connections;
+  connection_pool_->recycle_connection_override_ =
+      [&](std::shared_ptr<HttpConnection>& connection) {
+        recycled_connections.push_back(connection);
+      };
+  // All the connections but the last one are dropped.
+  std::atomic<size_t> create_connection_counter(0);
+  connection_pool_->create_connection_override_ =
+      [&, async_executor = async_executor_](
+          std::string host, std::string service, bool is_https) {
+        auto connection = std::make_shared<MockHttpConnection>(
+            async_executor, host, service, is_https, metric_router_.get());
+        if (++create_connection_counter < num_connections_per_host_) {
+          connection->SetIsDropped();
+          connection->SetIsNotReady();
+        } else {
+          connection->SetIsNotDropped();
+          connection->SetIsReady();
+        }
+        std::shared_ptr<HttpConnection> connection_ptr = connection;
+        return connection_ptr;
+      };
+
+  auto uri = std::make_shared<Uri>("https://www.google.com:80");
+  std::shared_ptr<HttpConnection> connection;
+  for (size_t i = 0; i < 2 * num_connections_per_host_; ++i) {
+    ASSERT_SUCCESS(connection_pool_->GetConnection(uri, connection));
+    EXPECT_TRUE(connection->IsReady());
+  }
+
+  // The recycles run in the background, once per dropped connection.
+  EXPECT_TRUE(recycled_connections.empty());
+  ASSERT_EQ(scheduled_works.size(), num_connections_per_host_ - 1);
+  for (auto& work : scheduled_works) {
+    work();
+  }
+  auto connections = connection_pool_->GetConnectionsMap()["www.google.com:80"];
+  ASSERT_EQ(recycled_connections.size(), num_connections_per_host_ - 1);
+  for (size_t i = 0; i < recycled_connections.size(); ++i) {
+    EXPECT_EQ(recycled_connections[i], connections[i]);
+  }
+
+  // A connection still dropped after its recycle gets another one.
+  ASSERT_SUCCESS(connection_pool_->GetConnection(uri, connection));
+  EXPECT_EQ(scheduled_works.size(), num_connections_per_host_);
+}
+
 TEST_F(HttpConnectionPoolTest, TestOpenConnectionsOtelMetric) {
   auto uri1 = std::make_shared<Uri>("https://www.google.com:80");
   auto uri2 = std::make_shared<Uri>("https://www.microsoft.com:80");
@@ -38,7 +38,6 @@
 using ::google::scp::core::AsyncExecutor;
 using ::google::scp::core::SuccessExecutionResult;
 using ::google::scp::core::async_executor::mock::MockAsyncExecutor;
-using ::google::scp::core::common::Uuid;
 using ::google::scp::core::http2_client::mock::MockHttpConnection;
 using ::google::scp::core::test::IsSuccessful;
 using ::google::scp::core::test::ResultIs;
@@ -46,7 +45,6 @@ using ::google::scp::core::test::WaitUntil;
 using ::opentelemetry::sdk::resource::SemanticConventions::
     kHttpResponseStatusCode;
 using ::opentelemetry::sdk::resource::SemanticConventions::kServerAddress;
-using ::testing::IsEmpty;
 
 namespace google::scp::core {
 namespace {
@@ -93,9 +91,7 @@ TEST_F(HttpConnectionTest, SimpleRequest) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -120,8 +116,7 @@ TEST_F(HttpConnectionTest, SimpleRequest) {
 
   counter.Wait();
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   // Test otel client response metric.
   std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
@@ -166,9 +161,7 @@ TEST_F(HttpConnectionTest, CancelCallbacks) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -195,8 +188,7 @@ TEST_F(HttpConnectionTest, CancelCallbacks) {
   execution_result = connection.Execute(http_context);
   EXPECT_SUCCESS(execution_result);
 
-  while (keys.size() == 0) {
-    connection.GetPendingNetworkCallbacks().Keys(keys);
+  while (connection.ActiveClientRequestsSize() == 0) {
     usleep(1000);
   }
 
@@ -205,12 +197,33 @@ TEST_F(HttpConnectionTest, CancelCallbacks) {
   counter.Wait();
   EXPECT_EQ(is_called, true);
 
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   connection.Stop();
 }
 
+TEST_F(HttpConnectionTest, ReleasedSlotIsReusedWithANewGeneration) {
+  auto async_executor = std::make_shared<MockAsyncExecutor>();
+  MockHttpConnection connection(async_executor, /*host=*/"localhost",
+                                std::to_string(server_.ports()[0]),
+                                /*is_https=*/false, metric_router_.get());
+  AsyncContext<HttpRequest, HttpResponse> http_context;
+  connection.SetActiveClientRequestsSize(2);
+
+  auto first_request_id = connection.AddPendingNetworkCall(http_context);
+  EXPECT_TRUE(connection.ReleasePendingNetworkCall(first_request_id));
+  EXPECT_FALSE(connection.ReleasePendingNetworkCall(first_request_id));
+
+  // The late callbacks of the first request leave the second one pending.
+  auto second_request_id = connection.AddPendingNetworkCall(http_context);
+  EXPECT_EQ(static_cast<uint32_t>(second_request_id),
+            static_cast<uint32_t>(first_request_id));
+  EXPECT_FALSE(connection.ReleasePendingNetworkCall(first_request_id));
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 1);
+  EXPECT_TRUE(connection.ReleasePendingNetworkCall(second_request_id));
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
+}
+
 TEST_F(HttpConnectionTest, StopRemovesCallback) {
   server_.handle(/*pattern=*/"/test",
                  [&](const nghttp2::asio_http2::server::request& req,
@@ -225,9 +238,7 @@ TEST_F(HttpConnectionTest, StopRemovesCallback) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -254,8 +265,7 @@ TEST_F(HttpConnectionTest, StopRemovesCallback) {
   execution_result = connection.Execute(http_context);
   EXPECT_SUCCESS(execution_result);
 
-  while (keys.empty()) {
-    connection.GetPendingNetworkCallbacks().Keys(keys);
+  while (connection.ActiveClientRequestsSize() == 0) {
     usleep(1000);
   }
 
@@ -263,8 +273,7 @@ TEST_F(HttpConnectionTest, StopRemovesCallback) {
   connection.Stop();
   counter.Wait();
 
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
   EXPECT_EQ(is_called, true);
 }
 
@@ -310,9 +319,7 @@ TEST_F(HttpConnectionTest, SuccessfulImmediateResponse) {
 
   connection.Stop();
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 }
 
 TEST_F(HttpConnectionTest, ServerThrewInternalServerError) {
@@ -334,9 +341,7 @@ TEST_F(HttpConnectionTest, ServerThrewInternalServerError) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -358,8 +363,7 @@ TEST_F(HttpConnectionTest, ServerThrewInternalServerError) {
   execution_result = connection.Execute(http_context);
   EXPECT_SUCCESS(execution_result);
 
-  while (keys.size() == 0) {
-    connection.GetPendingNetworkCallbacks().Keys(keys);
+  while (connection.ActiveClientRequestsSize() == 0) {
     usleep(1000);
   }
 
@@ -367,8 +371,7 @@ TEST_F(HttpConnectionTest, ServerThrewInternalServerError) {
 
   counter.Wait();
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   // Test otel client response metric.
   std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
@@ -409,9 +412,7 @@ TEST_F(HttpConnectionTest, UnsupportedHttpMethod) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -436,8 +437,7 @@ TEST_F(HttpConnectionTest, UnsupportedHttpMethod) {
 
   counter.Wait();
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 }
 
 TEST_F(HttpConnectionTest, MissingHeadersShouldStillSuccess) {
@@ -459,9 +459,7 @@ TEST_F(HttpConnectionTest, MissingHeadersShouldStillSuccess) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -487,8 +485,7 @@ TEST_F(HttpConnectionTest, MissingHeadersShouldStillSuccess) {
 
   counter.Wait();
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 }
 
 TEST_F(HttpConnectionTest, RequestSubmissionFailure) {
@@ -510,9 +507,7 @@ TEST_F(HttpConnectionTest, RequestSubmissionFailure) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -542,8 +537,7 @@ TEST_F(HttpConnectionTest, RequestSubmissionFailure) {
       test::WaitUntilOrReturn([&]() { return !connection.IsReady(); });
   ASSERT_SUCCESS(execution_result) << "Connection has not be dropped.";
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 }
 
 TEST_F(HttpConnectionTest, ClientServerLatencyMeasurement) {
@@ -565,9 +559,7 @@ TEST_F(HttpConnectionTest, ClientServerLatencyMeasurement) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -593,8 +585,7 @@ TEST_F(HttpConnectionTest, ClientServerLatencyMeasurement) {
   counter.Wait();
 
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   // Test otel metrics.
   std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
@@ -639,9 +630,7 @@ TEST_F(HttpConnectionTest, ClientRequestDurationMeasurement) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -667,8 +656,7 @@ TEST_F(HttpConnectionTest, ClientRequestDurationMeasurement) {
   counter.Wait();
 
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   // Test otel metrics.
   std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
@@ -714,9 +702,7 @@ TEST_F(HttpConnectionTest, ClientConnectionDurationMeasurement) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -742,8 +728,7 @@ TEST_F(HttpConnectionTest, ClientConnectionDurationMeasurement) {
   counter.Wait();
 
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   // Test otel metrics.
   std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
@@ -789,9 +774,7 @@ TEST_F(HttpConnectionTest, ClientConnectionError) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -874,8 +857,7 @@ TEST_F(HttpConnectionTest, ClientConnectionError) {
          "(int64_t)";
 
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 }
 
 TEST_F(HttpConnectionTest, RequestResponseBodySizeMeasurement) {
@@ -897,9 +879,7 @@ TEST_F(HttpConnectionTest, RequestResponseBodySizeMeasurement) {
   ASSERT_TRUE(connection.Init());
   ASSERT_TRUE(connection.Run());
 
-  std::vector<Uuid> keys;
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = std::make_shared<HttpRequest>();
@@ -926,8 +906,7 @@ TEST_F(HttpConnectionTest, RequestResponseBodySizeMeasurement) {
   counter.Wait();
 
   connection.Stop();
-  connection.GetPendingNetworkCallbacks().Keys(keys);
-  EXPECT_THAT(keys, IsEmpty());
+  EXPECT_EQ(connection.ActiveClientRequestsSize(), 0);
 
   // Test otel metrics.
   std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
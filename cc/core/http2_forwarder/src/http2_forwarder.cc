@@ -20,7 +20,6 @@
 #include <utility>
 
 using std::bind;
-using std::make_shared;
 using std::move;
 using std::shared_ptr;
 using std::placeholders::_1;
@@ -64,11 +63,8 @@ void Http2Forwarder::OnHttpResponse(
     return;
   }
   original_context.result = context.result;
-  // Copy the response.
-  original_context.response = make_shared<HttpResponse>();
-  original_context.response->headers = context.response->headers;
-  original_context.response->body = context.response->body;
-  original_context.response->code = context.response->code;
+  // Hand over the response, its headers and body are not copied.
+  original_context.response = move(context.response);
 
   FinishContext(original_context.result, original_context);
 }
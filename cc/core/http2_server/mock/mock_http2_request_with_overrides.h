@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/http2_server/src/http2_request.h"
 
@@ -29,7 +30,12 @@ class MockNgHttp2RequestWithOverrides : public NgHttp2Request {
       const nghttp2::asio_http2::server::request& ng2_request,
       size_t expected_request_body_length_to_receive = 1024)
       : NgHttp2Request(ng2_request) {
-    body = BytesBuffer(expected_request_body_length_to_receive);
+    // Same as UnwrapNgHttp2Request, the chunks are appended to an empty
+    // buffer.
+    body.bytes = std::make_shared<std::vector<Byte>>();
+    body.bytes->reserve(expected_request_body_length_to_receive);
+    body.length = 0;
+    body.capacity = expected_request_body_length_to_receive;
     expected_request_body_length_to_receive_ =
         expected_request_body_length_to_receive;
   }
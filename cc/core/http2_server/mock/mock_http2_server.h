@@ -27,6 +27,8 @@ class MockHttp2Server : public core::HttpServerInterface {
  public:
   MockHttp2Server() {}
 
+  using core::HttpServerInterface::RegisterResourceHandler;
+
   ExecutionResult Init() noexcept override { return SuccessExecutionResult(); }
 
   ExecutionResult Run() noexcept override { return SuccessExecutionResult(); }
@@ -65,4 +65,8 @@ DEFINE_ERROR_CODE(SC_HTTP2_SERVER_FAILED_TO_RESOLVE_ROUTE, SC_HTTP2_SERVER,
 DEFINE_ERROR_CODE(SC_HTTP2_SERVER_FAILED_TO_ROUTE, SC_HTTP2_SERVER, 0x000B,
                   "Http2Server failed to route the request.",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_HTTP2_SERVER_FAILED_TO_COMPRESS_RESPONSE, SC_HTTP2_SERVER,
+                  0x000C, "Http2Server failed to compress the response body.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
 }  // namespace google::scp::core::errors
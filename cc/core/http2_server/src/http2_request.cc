@@ -16,7 +16,6 @@
 
 #include "http2_request.h"
 
-#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -28,9 +27,9 @@
 
 using google::scp::core::http2_server::Http2Utils;
 using std::bind;
-using std::copy;
 using std::make_pair;
 using std::make_shared;
+using std::move;
 using std::string;
 using std::vector;
 using std::placeholders::_1;
@@ -71,9 +70,14 @@ ExecutionResult NgHttp2Request::ReadHeaders() noexcept {
 void NgHttp2Request::OnRequestBodyDataChunkReceived(
     const uint8_t* data, std::size_t length,
     const RequestBodyDataReceivedCallback& callback) noexcept {
+  if (body_chunk_consumer_failed_) {
+    return;
+  }
+  size_t received_length =
+      body_chunk_consumer_ ? consumed_body_length_ : body.length;
   if (length == 0) {
     auto execution_result = SuccessExecutionResult();
-    if (body.length < body.capacity) {
+    if (received_length < body.capacity) {
       execution_result =
           FailureExecutionResult(errors::SC_HTTP2_SERVER_PARTIAL_REQUEST_BODY);
     }
@@ -81,14 +85,25 @@ void NgHttp2Request::OnRequestBodyDataChunkReceived(
     return;
   }
   // Check if we are out of capacity. Avoiding overflow here.
-  if (length > body.capacity || body.length > body.capacity - length) {
+  if (length > body.capacity || received_length > body.capacity - length) {
     auto execution_result =
         FailureExecutionResult(errors::SC_HTTP2_SERVER_PARTIAL_REQUEST_BODY);
     callback(execution_result);
     return;
   }
-  // Otherwise, copy in data.
-  copy(data, data + length, body.bytes->begin() + body.length);
+  if (body_chunk_consumer_) {
+    consumed_body_length_ += length;
+    auto execution_result =
+        body_chunk_consumer_(reinterpret_cast<const Byte*>(data), length);
+    if (!execution_result.Successful()) {
+      body_chunk_consumer_failed_ = true;
+      callback(execution_result);
+    }
+    return;
+  }
+  // Otherwise, append the data. The chunk is only valid for the duration of
+  // this call, so it has to be copied out.
+  body.bytes->insert(body.bytes->end(), data, data + length);
   body.length += length;
 }
 
@@ -120,12 +135,26 @@ ExecutionResult NgHttp2Request::UnwrapNgHttp2Request() noexcept {
           core::errors::SC_HTTP2_SERVER_INVALID_HEADER);
     }
   }
-  body.bytes = make_shared<vector<Byte>>(content_length);
+  // Only reserves the space for the body, the chunks are appended as they are
+  // received. Sizing the vector up front would zero-fill the whole body before
+  // overwriting it, which is measurable for multi-megabyte bodies.
+  body.bytes = make_shared<vector<Byte>>();
+  body.bytes->reserve(content_length);
   body.length = 0;
   body.capacity = content_length;
   return SuccessExecutionResult();
 }
 
+void NgHttp2Request::SetBodyChunkConsumer(HttpBodyChunkConsumer consumer) {
+  body_chunk_consumer_ = std::move(consumer);
+  if (body_chunk_consumer_) {
+    // Nothing is buffered, so the reserved space is released.
+    body.bytes = make_shared<vector<Byte>>();
+  } else {
+    body.bytes->reserve(body.capacity);
+  }
+}
+
 void NgHttp2Request::SetOnRequestBodyDataReceivedCallback(
     const RequestBodyDataReceivedCallback& callback) {
   ng2_request_.on_data(bind(&NgHttp2Request::OnRequestBodyDataChunkReceived,
@@ -65,6 +65,16 @@ class NgHttp2Request : public HttpRequest {
   virtual void SetOnRequestBodyDataReceivedCallback(
       const RequestBodyDataReceivedCallback& callback);
 
+  /**
+   * @brief Set the consumer of the body chunks. The chunks are then handed to
+   * the consumer as they are received instead of being buffered in body, and
+   * a failure of the consumer fails the receipt of the body. Setting an empty
+   * consumer buffers the body again.
+   *
+   * @param consumer The consumer of the body chunks.
+   */
+  void SetBodyChunkConsumer(HttpBodyChunkConsumer consumer);
+
  protected:
   /**
    * @brief Reads the Uri from the ngHttp2Request object.
@@ -102,6 +112,13 @@ class NgHttp2Request : public HttpRequest {
  private:
   /// A ref to the original ng2_request.
   const nghttp2::asio_http2::server::request& ng2_request_;
+  /// The consumer of the body chunks, if the body is not buffered.
+  HttpBodyChunkConsumer body_chunk_consumer_;
+  /// The length of the body handed to body_chunk_consumer_.
+  size_t consumed_body_length_ = 0;
+  /// Whether body_chunk_consumer_ has failed. The remaining chunks are
+  /// dropped.
+  bool body_chunk_consumer_failed_ = false;
 };
 
 }  // namespace google::scp::core
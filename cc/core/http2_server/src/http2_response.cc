@@ -22,6 +22,7 @@
 
 #include <boost/exception/diagnostic_information.hpp>
 
+#include "core/utils/src/http.h"
 #include "public/core/interface/execution_result.h"
 
 using google::scp::core::FailureExecutionResult;
@@ -67,7 +68,8 @@ void NgHttp2Response::Send() noexcept {
   try {
     ng2_response_.write_head(static_cast<int>(code), response_headers);
     if (body.length > 0) {
-      ng2_response_.end(body.ToString());
+      // The body is read in place, the generator keeps its bytes alive.
+      ng2_response_.end(utils::MakeBodyDataGenerator(body));
     } else {
       ng2_response_.end("");
     }
@@ -16,10 +16,15 @@
 
 #include "http2_server.h"
 
+#include <arpa/inet.h>
 #include <nghttp2/asio_http2_server.h>
+#include <nghttp2/asio_http2_server_options.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -60,6 +65,7 @@ using ::google::scp::core::common::Uuid;
 using ::google::scp::core::errors::GetErrorHttpStatusCode;
 using ::google::scp::core::errors::HttpStatusCode;
 using ::google::scp::core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN;
+using ::google::scp::core::http2_server::Http2Utils;
 using ::google::scp::core::utils::Base64Decode;
 using ::google::scp::core::utils::PadBase64Encoding;
 using ::google::scp::cpio::AggregateMetric;
@@ -71,12 +77,25 @@ using ::google::scp::cpio::MetricLabelsBase;
 using ::google::scp::cpio::MetricName;
 using ::google::scp::cpio::MetricUnit;
 using ::nghttp2::asio_http2::server::configure_tls_context_easy;
+using ::nghttp2::asio_http2::server::http2;
 using ::nghttp2::asio_http2::server::request;
 using ::nghttp2::asio_http2::server::response;
+using ::nghttp2::asio_http2::server::session_settings;
+using ::nghttp2::asio_http2::server::set_listen_adopted_socket;
+using ::nghttp2::asio_http2::server::set_listen_reuse_port;
+using ::nghttp2::asio_http2::server::set_listen_session_settings;
 
 static constexpr char kHttp2Server[] = "Http2Server";
 static constexpr size_t kConnectionReadTimeoutInSeconds = 90;
 
+/// Guards the inherited listening sockets.
+std::mutex inherited_listening_sockets_mutex;
+/// The listening sockets set by Http2Server::SetInheritedListeningSockets.
+std::vector<int>& InheritedListeningSockets() {
+  static auto* inherited_listening_sockets = new std::vector<int>();
+  return *inherited_listening_sockets;
+}
+
 static const std::set<HttpStatusCode> kHttpStatusCode4xxMap = {
     HttpStatusCode::BAD_REQUEST,
     HttpStatusCode::UNAUTHORIZED,
@@ -169,6 +188,59 @@ ExecutionResult SetSyncContext(
   }
   return execution_result;
 }
+
+/// Registers the handler of the method of the path in the registry.
+template <typename Handler>
+ExecutionResult RegisterHandler(
+    common::ConcurrentMap<
+        std::string,
+        std::shared_ptr<common::ConcurrentMap<HttpMethod, Handler>>>& registry,
+    HttpMethod http_method, const std::string& path, Handler& handler) {
+  auto verb_to_handler_map =
+      std::make_shared<ConcurrentMap<HttpMethod, Handler>>();
+  auto path_to_map_pair = std::make_pair(path, verb_to_handler_map);
+
+  auto execution_result =
+      registry.Insert(path_to_map_pair, verb_to_handler_map);
+  if (!execution_result.Successful()) {
+    if (execution_result !=
+        FailureExecutionResult(
+            errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS)) {
+      return execution_result;
+    }
+  }
+
+  auto verb_to_handler_pair = std::make_pair(http_method, handler);
+  return verb_to_handler_map->Insert(verb_to_handler_pair, handler);
+}
+
+/// Copies the handlers of the path in the registry, if any, to handlers.
+template <typename Handler>
+ExecutionResult FreezeHandlers(
+    common::ConcurrentMap<
+        std::string,
+        std::shared_ptr<common::ConcurrentMap<HttpMethod, Handler>>>& registry,
+    const std::string& path,
+    absl::flat_hash_map<HttpMethod, Handler>& handlers) {
+  std::shared_ptr<ConcurrentMap<HttpMethod, Handler>> verb_to_handler_map;
+  if (!registry.Find(path, verb_to_handler_map).Successful()) {
+    return SuccessExecutionResult();
+  }
+  std::vector<HttpMethod> methods;
+  auto execution_result = verb_to_handler_map->Keys(methods);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  for (const auto& method : methods) {
+    Handler handler;
+    execution_result = verb_to_handler_map->Find(method, handler);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    handlers.emplace(method, std::move(handler));
+  }
+  return SuccessExecutionResult();
+}
 }  // namespace
 
 ExecutionResult Http2Server::MetricInit() noexcept {
@@ -201,6 +273,14 @@ ExecutionResult Http2Server::MetricStop() noexcept {
   return http_request_metrics_->Stop();
 }
 
+ExecutionResult Http2Server::LoadConfigSnapshot(
+    ConfigProviderInterface& config_provider,
+    Http2ServerConfigSnapshot& snapshot) noexcept {
+  GetConfigOrDefault(config_provider, kHttpServerDnsRoutingEnabled,
+                     snapshot.dns_routing_enabled);
+  return SuccessExecutionResult();
+}
+
 ExecutionResult Http2Server::Init() noexcept {
   if (use_tls_) {
     error_code nghttp2_error_code;
@@ -319,6 +399,11 @@ ExecutionResult Http2Server::Init() noexcept {
   if (config_provider_) {
     config_provider_->Get(kOtelServerMetricsEnabled,
                           otel_server_metrics_enabled_);
+    config_provider_->Get(kHttpServerGzipResponseMinBodyLengthInBytes,
+                          gzip_response_min_body_length_);
+  }
+  if (config_snapshot_publisher_) {
+    config_snapshot_publisher_->Reload();
   }
 
   return SuccessExecutionResult();
@@ -343,55 +428,202 @@ ExecutionResult Http2Server::Run() noexcept {
   if (!execution_result.Successful()) {
     return execution_result;
   }
+  std::vector<std::string> streaming_paths;
+  execution_result = streaming_resource_handlers_.Keys(streaming_paths);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  std::set<std::string> all_paths(paths.begin(), paths.end());
+  all_paths.insert(streaming_paths.begin(), streaming_paths.end());
 
-  for (const auto& path : paths) {
-    // TODO: here we are binding a universal handler, and the real
-    // handler is looked up again inside it. Ideally, we can do the look up
-    // here, and pass the result to std::bind(), to save runtime cost.
-    http2_server_.handle(
-        path, std::bind(&Http2Server::OnHttp2Request, this,
-                        std::placeholders::_1, std::placeholders::_2));
+  additional_http2_servers_.clear();
+  for (size_t i = 1; i < listener_count_; ++i) {
+    additional_http2_servers_.push_back(std::make_unique<http2>());
   }
+  auto listeners = Listeners();
 
-  http2_server_.read_timeout(
-      boost::posix_time::seconds(kConnectionReadTimeoutInSeconds));
-  http2_server_.num_threads(thread_pool_size_);
+  // No handler can be registered anymore, so the handlers of each path are
+  // frozen and bound to its nghttp2 handler.
+  for (const auto& path : all_paths) {
+    auto path_handlers = std::make_shared<PathHandlers>();
+    execution_result =
+        FreezeHandlers(resource_handlers_, path, path_handlers->handlers);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    execution_result = FreezeHandlers(streaming_resource_handlers_, path,
+                                      path_handlers->streaming_handlers);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    execution_result =
+        FreezeHandlers(route_priorities_, path, path_handlers->priorities);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
 
-  error_code nghttp2_error_code;
-  error_code server_listen_and_serve_error_code;
-  const bool asynchronous = true;
+    std::shared_ptr<const PathHandlers> frozen_path_handlers(
+        std::move(path_handlers));
+    for (auto* listener : listeners) {
+      listener->handle(
+          path, std::bind(&Http2Server::OnHttp2Request, this, path,
+                          frozen_path_handlers, std::placeholders::_1,
+                          std::placeholders::_2));
+    }
+  }
 
-  if (use_tls_) {
-    server_listen_and_serve_error_code = http2_server_.listen_and_serve(
-        nghttp2_error_code, tls_context_, host_address_, port_, asynchronous);
-  } else {
-    server_listen_and_serve_error_code = http2_server_.listen_and_serve(
-        nghttp2_error_code, host_address_, port_, asynchronous);
+  // The worker threads are shared out between the listeners.
+  auto threads_per_listener =
+      std::max<size_t>(thread_pool_size_ / listener_count_, 1);
+  for (auto* listener : listeners) {
+    listener->read_timeout(
+        boost::posix_time::seconds(kConnectionReadTimeoutInSeconds));
+    listener->num_threads(threads_per_listener);
   }
 
-  if (server_listen_and_serve_error_code) {
+  RETURN_IF_FAILURE(ListenAndServe());
+
+  PinWorkerThreads();
+  return SuccessExecutionResult();
+}
+
+void Http2Server::SetInheritedListeningSockets(
+    const std::vector<int>& socket_fds) noexcept {
+  std::lock_guard<std::mutex> lock(inherited_listening_sockets_mutex);
+  InheritedListeningSockets() = socket_fds;
+}
+
+int Http2Server::FindInheritedListeningSocket() noexcept {
+  std::lock_guard<std::mutex> lock(inherited_listening_sockets_mutex);
+  for (auto socket_fd : InheritedListeningSockets()) {
+    sockaddr_storage address = {};
+    socklen_t address_length = sizeof(address);
+    if (getsockname(socket_fd, reinterpret_cast<sockaddr*>(&address),
+                    &address_length) != 0) {
+      continue;
+    }
+    uint16_t port = 0;
+    if (address.ss_family == AF_INET6) {
+      port = ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+    } else if (address.ss_family == AF_INET) {
+      port = ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+    }
+    if (port != 0 && std::to_string(port) == port_) {
+      return socket_fd;
+    }
+  }
+  return -1;
+}
+
+ExecutionResult Http2Server::ListenAndServe() noexcept {
+  const bool asynchronous = true;
+  // Only the sockets of the sharded listeners are bound with SO_REUSEPORT.
+  set_listen_reuse_port(listener_count_ > 1);
+  // All the listeners accept on the inherited socket of the port, if any.
+  set_listen_adopted_socket(FindInheritedListeningSocket());
+  session_settings settings;
+  settings.max_concurrent_streams = max_concurrent_streams_;
+  settings.initial_window_size = initial_window_size_;
+  settings.header_table_size = header_table_size_;
+  set_listen_session_settings(settings);
+
+  auto port = port_;
+  size_t started_listener_count = 0;
+  for (auto* listener : Listeners()) {
+    error_code nghttp2_error_code;
+    error_code server_listen_and_serve_error_code;
+    if (use_tls_) {
+      server_listen_and_serve_error_code = listener->listen_and_serve(
+          nghttp2_error_code, tls_context_, host_address_, port, asynchronous);
+    } else {
+      server_listen_and_serve_error_code = listener->listen_and_serve(
+          nghttp2_error_code, host_address_, port, asynchronous);
+    }
+
+    if (server_listen_and_serve_error_code) {
+      break;
+    }
+    ++started_listener_count;
+    // The next listeners are bound to the port picked for the first one, if
+    // any was.
+    if (auto ports = listener->ports(); !ports.empty()) {
+      port = std::to_string(ports.front());
+    }
+  }
+  set_listen_reuse_port(false);
+  set_listen_adopted_socket(-1);
+  set_listen_session_settings(session_settings());
+
+  if (started_listener_count < listener_count_) {
+    if (started_listener_count > 0) {
+      StopListeners(started_listener_count);
+      is_running_ = false;
+    }
     return FailureExecutionResult(
         core::errors::SC_HTTP2_SERVER_INITIALIZATION_FAILED);
   }
-
   return SuccessExecutionResult();
 }
 
-ExecutionResult Http2Server::Stop() noexcept {
-  if (!is_running_) {
-    return FailureExecutionResult(errors::SC_HTTP2_SERVER_ALREADY_STOPPED);
+std::vector<http2*> Http2Server::Listeners() noexcept {
+  std::vector<http2*> listeners = {&http2_server_};
+  for (auto& additional_http2_server : additional_http2_servers_) {
+    listeners.push_back(additional_http2_server.get());
   }
+  return listeners;
+}
 
-  is_running_ = false;
+void Http2Server::StopListeners(size_t listener_count) noexcept {
+  auto listeners = Listeners();
+  listeners.resize(std::min(listener_count, listeners.size()));
   try {
-    http2_server_.stop();
-    for (auto& io_service : http2_server_.io_services()) {
-      io_service->stop();
+    for (auto* listener : listeners) {
+      listener->stop();
+      for (auto& io_service : listener->io_services()) {
+        io_service->stop();
+      }
+    }
+    for (auto* listener : listeners) {
+      listener->join();
     }
-    http2_server_.join();
   } catch (...) {
     // Doing the best to stop, ignore otherwise.
   }
+}
+
+void Http2Server::PinWorkerThreads() noexcept {
+  if (worker_thread_placement_policy_ == ThreadPlacementPolicy::Unpinned) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<boost::asio::io_service>> io_services;
+  for (auto* listener : Listeners()) {
+    const auto& listener_io_services = listener->io_services();
+    io_services.insert(io_services.end(), listener_io_services.begin(),
+                       listener_io_services.end());
+  }
+  auto placement = AsyncExecutorUtils::GetThreadPlacement(
+      worker_thread_placement_policy_, io_services.size(),
+      AsyncExecutorUtils::GetNumaNodeCpus());
+  // Each io_service is run by its own worker thread, so the posted handler
+  // pins the thread it runs on.
+  for (size_t i = 0; i < io_services.size(); ++i) {
+    if (!placement[i].has_value()) {
+      continue;
+    }
+    io_services[i]->post([cpu = *placement[i]]() {
+      AsyncExecutorUtils::SetAffinity(cpu);
+    });
+  }
+}
+
+ExecutionResult Http2Server::Stop() noexcept {
+  if (!is_running_) {
+    return FailureExecutionResult(errors::SC_HTTP2_SERVER_ALREADY_STOPPED);
+  }
+
+  is_running_ = false;
+  StopListeners(listener_count_);
 
   if (metric_client_) {
     return MetricStop();
@@ -409,26 +641,35 @@ ExecutionResult Http2Server::RegisterResourceHandler(
     return FailureExecutionResult(
         errors::SC_HTTP2_SERVER_CANNOT_REGISTER_HANDLER);
   }
-  auto verb_to_handler_map =
-      std::make_shared<ConcurrentMap<HttpMethod, HttpHandler>>();
-  auto path_to_map_pair = std::make_pair(path, verb_to_handler_map);
+  return RegisterHandler(resource_handlers_, http_method, path, handler);
+}
 
-  auto execution_result =
-      resource_handlers_.Insert(path_to_map_pair, verb_to_handler_map);
-  if (!execution_result.Successful()) {
-    if (execution_result !=
-        FailureExecutionResult(
-            errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS)) {
-      return execution_result;
-    }
+ExecutionResult Http2Server::RegisterResourceHandler(
+    HttpMethod http_method, std::string& path, HttpHandler& handler,
+    HttpRoutePriority priority) noexcept {
+  auto execution_result = RegisterResourceHandler(http_method, path, handler);
+  if (!execution_result.Successful() ||
+      priority == HttpRoutePriority::Default) {
+    return execution_result;
   }
+  return RegisterHandler(route_priorities_, http_method, path, priority);
+}
 
-  auto verb_to_handler_pair = std::make_pair(http_method, handler);
-  return verb_to_handler_map->Insert(verb_to_handler_pair, handler);
+ExecutionResult Http2Server::RegisterStreamingResourceHandler(
+    HttpMethod http_method, std::string& path,
+    HttpStreamingHandler& handler) noexcept {
+  if (is_running_) {
+    return FailureExecutionResult(
+        errors::SC_HTTP2_SERVER_CANNOT_REGISTER_HANDLER);
+  }
+  return RegisterHandler(streaming_resource_handlers_, http_method, path,
+                         handler);
 }
 
-void Http2Server::OnHttp2Request(const request& request,
-                                 const response& response) noexcept {
+void Http2Server::OnHttp2Request(
+    const std::string& path,
+    const std::shared_ptr<const PathHandlers>& path_handlers,
+    const request& request, const response& response) noexcept {
   // Timestamp entry_time = GetSteadyTimestampInNanosecondsAsClockTicks;
   std::chrono::time_point<std::chrono::steady_clock> entry_time =
       std::chrono::steady_clock::now();
@@ -474,22 +715,53 @@ void Http2Server::OnHttp2Request(const request& request,
     return;
   }
 
-  // Check if path is registered
-  std::shared_ptr<ConcurrentMap<HttpMethod, HttpHandler>> resource_handler;
-  execution_result = resource_handlers_.Find(
-      http2_context.request->handler_path, resource_handler);
-  if (!execution_result.Successful()) {
-    http2_context.result = execution_result;
+  // nghttp2 also dispatches the sub paths of the paths ending with '/' to
+  // their handler, while only the registered paths are served.
+  if (http2_context.request->handler_path != path) {
+    http2_context.result =
+        FailureExecutionResult(errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
     http2_context.Finish();
     return;
   }
 
   // Check if there is an active handler for the specific method.
   HttpHandler http_handler;
-  execution_result =
-      resource_handler->Find(http2_context.request->method, http_handler);
-  if (!execution_result.Successful()) {
-    http2_context.result = execution_result;
+  const auto& method = http2_context.request->method;
+  if (auto handler = path_handlers->handlers.find(method);
+      handler != path_handlers->handlers.end()) {
+    http_handler = handler->second;
+    auto priority = path_handlers->priorities.find(method);
+    if (control_plane_async_executor_ &&
+        priority != path_handlers->priorities.end() &&
+        priority->second == HttpRoutePriority::ControlPlane) {
+      // The control-plane handlers are not queued behind the data-plane
+      // requests on the server threads.
+      http_handler = [control_plane_async_executor =
+                          control_plane_async_executor_,
+                      control_plane_handler = std::move(http_handler)](
+                         AsyncContext<HttpRequest, HttpResponse>&
+                             http_context) {
+        return control_plane_async_executor->Schedule(
+            [control_plane_handler, http_context]() mutable {
+              auto execution_result = control_plane_handler(http_context);
+              if (!execution_result.Successful()) {
+                http_context.result = execution_result;
+                http_context.Finish();
+              }
+            },
+            AsyncPriority::High);
+      };
+    }
+  } else if (auto streaming_handler =
+                 path_handlers->streaming_handlers.find(method);
+             streaming_handler != path_handlers->streaming_handlers.end()) {
+    auto request_handler = streaming_handler->second(*http2_context.request);
+    http2_context.request->SetBodyChunkConsumer(
+        std::move(request_handler.on_body_chunk));
+    http_handler = std::move(request_handler.on_request);
+  } else {
+    http2_context.result =
+        FailureExecutionResult(errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
     http2_context.Finish();
     return;
   }
@@ -524,7 +796,9 @@ void Http2Server::RouteOrHandleHttp2Request(
           std::bind(&Http2Server::OnHttp2Response, this, std::placeholders::_1,
                     RequestTargetEndpointType::Remote);
       // Perform routing when request data is obtained on the connection. If the
-      // connection is closed, do OnHttp2CleanupRoutedRequest.
+      // connection is closed, do OnHttp2CleanupRoutedRequest. The body is
+      // forwarded as a whole, so it is buffered even for streaming resources.
+      http2_context.request->SetBodyChunkConsumer(nullptr);
       http2_context.request->SetOnRequestBodyDataReceivedCallback(
           std::bind(&Http2Server::OnHttp2RequestDataObtainedRoutedRequest, this,
                     http2_context, *endpoint_info, std::placeholders::_1));
@@ -641,11 +915,8 @@ void Http2Server::HandleHttp2Request(
   std::shared_ptr<AuthorizationProxyInterface>& authorization_proxy_to_use =
       authorization_proxy_;
 
-  bool dns_routing_enabled = false;
-  if (config_provider_ != nullptr &&
-      config_provider_->Get(kHttpServerDnsRoutingEnabled, dns_routing_enabled)
-          .Successful() &&
-      dns_routing_enabled) {
+  if (config_snapshot_publisher_ != nullptr &&
+      config_snapshot_publisher_->Get().dns_routing_enabled) {
     if (aws_authorization_proxy_ != nullptr &&
         UseAwsAuthorizationProxy(
             authorization_context.request->authorization_metadata)) {
@@ -655,6 +926,7 @@ void Http2Server::HandleHttp2Request(
     }
   }
 
+  sync_context->authorization_start_time = std::chrono::steady_clock::now();
   operation_dispatcher_.Dispatch<
       AsyncContext<AuthorizationProxyRequest, AuthorizationProxyResponse>>(
       authorization_context,
@@ -704,6 +976,9 @@ void Http2Server::OnAuthorizationCallback(
         authorization_context.request->authorization_metadata.claimed_identity);
     sync_context->http2_context.request->auth_context.authorized_domain =
         authorization_context.response->authorized_metadata.authorized_domain;
+    sync_context->http2_context.request->auth_context.authorization_duration =
+        std::chrono::steady_clock::now() -
+        sync_context->authorization_start_time;
   }
 
   OnHttp2PendingCallback(authorization_context.result, request_id);
@@ -757,11 +1032,12 @@ void Http2Server::OnHttp2PendingCallback(
       };
 
   // Recording request body length in Bytes - request body is received when code
-  // reaches here.
+  // reaches here, so its length is its capacity. The body of the requests to
+  // streaming resources is not buffered.
   const absl::flat_hash_map<std::string, std::string> label_kv;
   opentelemetry::context::Context context;
-  server_request_body_size_->Record(http_context.request->body.length, label_kv,
-                                    context);
+  server_request_body_size_->Record(http_context.request->body.capacity,
+                                    label_kv, context);
 
   execution_result = sync_context->http_handler(http_context);
   if (!execution_result.Successful()) {
@@ -857,6 +1133,8 @@ void Http2Server::OnHttp2Response(
 
   pbs_transactions_->Add(1, pbs_transaction_label_kv);
 
+  CompressResponseBody(http_context);
+
   // Capture the shared_ptr to keep the response object alive when the work
   // actually starts executing. Do not execute response->Send() on a thread
   // that does not belong to nghttp2response as it could lead to concurrency
@@ -865,6 +1143,33 @@ void Http2Server::OnHttp2Response(
       [response = http_context.response]() { response->Send(); });
 }
 
+void Http2Server::CompressResponseBody(
+    AsyncContext<NgHttp2Request, NgHttp2Response>& http_context) noexcept {
+  auto& response = *http_context.response;
+  if (gzip_response_min_body_length_ == 0 ||
+      response.body.length < gzip_response_min_body_length_ ||
+      !http_context.request->headers ||
+      !Http2Utils::AcceptsGzipEncoding(*http_context.request->headers) ||
+      !response.headers ||
+      response.headers->find("content-encoding") != response.headers->end()) {
+    return;
+  }
+
+  BytesBuffer compressed_body;
+  auto execution_result = Http2Utils::GzipBody(response.body, compressed_body);
+  if (!execution_result.Successful()) {
+    SCP_ERROR_CONTEXT(kHttp2Server, http_context, execution_result,
+                      "Cannot compress the response body, sending it as is.");
+    return;
+  }
+  if (compressed_body.length >= response.body.length) {
+    return;
+  }
+
+  response.body = std::move(compressed_body);
+  response.headers->insert({"content-encoding", "gzip"});
+}
+
 void Http2Server::OnHttp2Cleanup(Uuid activity_id, Uuid request_id,
                                  uint32_t error_code) noexcept {
   auto request_id_str = ToString(request_id);
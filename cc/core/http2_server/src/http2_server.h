@@ -18,15 +18,21 @@
 
 #include <nghttp2/asio_http2_server.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "cc/core/async_executor/src/async_executor_utils.h"
 #include "cc/core/common/concurrent_map/src/concurrent_map.h"
 #include "cc/core/common/operation_dispatcher/src/operation_dispatcher.h"
 #include "cc/core/common/uuid/src/uuid.h"
+#include "cc/core/config_provider/src/config_snapshot.h"
 #include "cc/core/http2_server/src/http2_request.h"
 #include "cc/core/http2_server/src/http2_response.h"
 #include "cc/core/interface/async_executor_interface.h"
@@ -63,7 +69,8 @@ class Http2ServerOptions {
         retry_strategy_options(
             common::RetryStrategyOptions(common::RetryStrategyType::Exponential,
                                          kHttpServerRetryStrategyDelayInMs,
-                                         kDefaultRetryStrategyMaxRetries)) {}
+                                         kDefaultRetryStrategyMaxRetries)),
+        worker_thread_placement_policy(ThreadPlacementPolicy::Unpinned) {}
 
   Http2ServerOptions(
       bool use_tls, std::shared_ptr<std::string> private_key_file,
@@ -71,11 +78,14 @@ class Http2ServerOptions {
       common::RetryStrategyOptions retry_strategy_options =
           common::RetryStrategyOptions(common::RetryStrategyType::Exponential,
                                        kHttpServerRetryStrategyDelayInMs,
-                                       kDefaultRetryStrategyMaxRetries))
+                                       kDefaultRetryStrategyMaxRetries),
+      ThreadPlacementPolicy worker_thread_placement_policy =
+          ThreadPlacementPolicy::Unpinned)
       : use_tls(use_tls),
         private_key_file(move(private_key_file)),
         certificate_chain_file(move(certificate_chain_file)),
-        retry_strategy_options(retry_strategy_options) {}
+        retry_strategy_options(retry_strategy_options),
+        worker_thread_placement_policy(worker_thread_placement_policy) {}
 
   /// Whether to use TLS.
   const bool use_tls;
@@ -85,11 +95,52 @@ class Http2ServerOptions {
   const std::shared_ptr<std::string> certificate_chain_file;
   /// Retry strategy options.
   const common::RetryStrategyOptions retry_strategy_options;
+  /**
+   * @brief Placement of the worker threads over the CPUs. Using the placement
+   * of the AsyncExecutor the requests are handed to pins the worker thread i
+   * on the same CPU as the executor thread i, so the work of a request stays
+   * on one NUMA node.
+   */
+  const ThreadPlacementPolicy worker_thread_placement_policy;
+  /**
+   * @brief The executor lane reserved for the handlers of the control-plane
+   * routes, see HttpRoutePriority. The executor is owned by the caller. If not
+   * set, the control-plane handlers are run on the server threads like the
+   * other ones.
+   */
+  std::shared_ptr<AsyncExecutorInterface> control_plane_async_executor;
+  /**
+   * @brief The number of listeners of the server. Above 1, each listener binds
+   * its own socket to the port with SO_REUSEPORT and runs its share of the
+   * worker threads, so the kernel spreads the connections, and their accepts,
+   * across the listeners. The worker threads are placed in listener order, so
+   * with one thread per listener, the thread of listener i is pinned with the
+   * executor thread i.
+   */
+  size_t listener_count = 1;
+  /// The max number of concurrent streams a client may open per connection.
+  uint32_t max_concurrent_streams = 10000;
+  /**
+   * @brief The initial flow control window of the streams, in bytes. Zero
+   * keeps the default of nghttp2, 64KB.
+   */
+  uint32_t initial_window_size = 0;
+  /**
+   * @brief The size of the header compression table of the server decoder, in
+   * bytes. Zero keeps the default of nghttp2, 4KB.
+   */
+  uint32_t header_table_size = 0;
 
  private:
   static constexpr TimeDuration kHttpServerRetryStrategyDelayInMs = 31;
 };
 
+/// The configuration of Http2Server that is read on every request.
+struct Http2ServerConfigSnapshot {
+  /// Whether requests are authorized by the proxy of the cloud they come from.
+  bool dns_routing_enabled = false;
+};
+
 /*! @copydoc HttpServerInterface
  */
 class Http2Server : public HttpServerInterface {
@@ -122,7 +173,23 @@ class Http2Server : public HttpServerInterface {
         private_key_file_(*options.private_key_file),
         certificate_chain_file_(*options.certificate_chain_file),
         tls_context_(boost::asio::ssl::context::sslv23),
-        request_routing_enabled_(false) {}
+        worker_thread_placement_policy_(options.worker_thread_placement_policy),
+        control_plane_async_executor_(options.control_plane_async_executor),
+        listener_count_(std::max<size_t>(options.listener_count, 1)),
+        max_concurrent_streams_(options.max_concurrent_streams),
+        initial_window_size_(options.initial_window_size),
+        header_table_size_(options.header_table_size),
+        request_routing_enabled_(false),
+        gzip_response_min_body_length_(0) {
+    if (config_provider_) {
+      config_snapshot_publisher_ =
+          std::make_unique<ConfigSnapshotPublisher<Http2ServerConfigSnapshot>>(
+              config_provider_, &Http2Server::LoadConfigSnapshot);
+      // Resolved here as well as in Init, for the requests handled by a server
+      // that is not initialized.
+      config_snapshot_publisher_->Reload();
+    }
+  }
 
   // Construct HTTP Server with Request Routing capabilities.
   Http2Server(
@@ -149,10 +216,34 @@ class Http2Server : public HttpServerInterface {
 
   ExecutionResult Stop() noexcept override;
 
+  /**
+   * @brief Sets the listening sockets opened for the process, e.g. the ones
+   * handed off by the process launcher. The servers started afterwards listen
+   * on the socket bound to their port, if any, instead of binding their own.
+   * The sockets stay owned by the caller.
+   *
+   * @param socket_fds The listening sockets.
+   */
+  static void SetInheritedListeningSockets(
+      const std::vector<int>& socket_fds) noexcept;
+
   ExecutionResult RegisterResourceHandler(
       HttpMethod http_method, std::string& path,
       HttpHandler& handler) noexcept override;
 
+  /// The handlers of the control-plane routes are run on the control-plane
+  /// executor of the options, if any, at high priority.
+  ExecutionResult RegisterResourceHandler(
+      HttpMethod http_method, std::string& path, HttpHandler& handler,
+      HttpRoutePriority priority) noexcept override;
+
+  /// The body of the requests to streaming resources is handed to their
+  /// handler as it is received, unless the requests are routed to another
+  /// endpoint. A method of a path registered both ways is not streamed.
+  ExecutionResult RegisterStreamingResourceHandler(
+      HttpMethod http_method, std::string& path,
+      HttpStreamingHandler& handler) noexcept override;
+
   /**
    * @brief This context is used for the synchronization between two callbacks.
    * The authorization proxy callback and the data receive callback from the
@@ -172,6 +263,8 @@ class Http2Server : public HttpServerInterface {
     HttpHandler http_handler;
     /// Time for entry point of the request.
     std::chrono::time_point<std::chrono::steady_clock> entry_time;
+    /// Time the authorization request was dispatched.
+    std::chrono::time_point<std::chrono::steady_clock> authorization_start_time;
   };
 
   /**
@@ -187,6 +280,19 @@ class Http2Server : public HttpServerInterface {
   };
 
  protected:
+  /// The handlers of a path by http method.
+  struct PathHandlers {
+    absl::flat_hash_map<HttpMethod, HttpHandler> handlers;
+    absl::flat_hash_map<HttpMethod, HttpStreamingHandler> streaming_handlers;
+    /// The priority of the non-default priority handlers.
+    absl::flat_hash_map<HttpMethod, HttpRoutePriority> priorities;
+  };
+
+  /// Resolves the configuration read on every request.
+  static ExecutionResult LoadConfigSnapshot(
+      ConfigProviderInterface& config_provider,
+      Http2ServerConfigSnapshot& snapshot) noexcept;
+
   /// Init http_error_metrics_ instance.
   virtual ExecutionResult MetricInit() noexcept;
   /// Run http_error_metrics_ instance.
@@ -194,14 +300,33 @@ class Http2Server : public HttpServerInterface {
   /// Stop http_error_metrics_ instance.
   virtual ExecutionResult MetricStop() noexcept;
 
+  /// Pins the worker threads according to the worker thread placement policy.
+  void PinWorkerThreads() noexcept;
+
+  /// Starts the listeners. If one fails, the ones started are stopped.
+  ExecutionResult ListenAndServe() noexcept;
+
+  /// Returns the inherited listening socket bound to the port, -1 if none.
+  int FindInheritedListeningSocket() noexcept;
+
+  /// Stops the first listener_count listeners and waits for their threads.
+  void StopListeners(size_t listener_count) noexcept;
+
+  /// Returns the listeners of the server, the first one being http2_server_.
+  std::vector<nghttp2::asio_http2::server::http2*> Listeners() noexcept;
+
   /**
    * @brief A handler for ng2 native request response and converting them to
    * Http2Request and Http2Response behind the scenes.
    *
+   * @param path The path the handler is registered for.
+   * @param path_handlers The handlers of the path.
    * @param request The nghttp2 request.
    * @param response The nghttp2 response.
    */
   virtual void OnHttp2Request(
+      const std::string& path,
+      const std::shared_ptr<const PathHandlers>& path_handlers,
       const nghttp2::asio_http2::server::request& request,
       const nghttp2::asio_http2::server::response& response) noexcept;
 
@@ -323,6 +448,16 @@ class Http2Server : public HttpServerInterface {
   void RecordServerLatency(const common::Uuid& activity_id,
                            const common::Uuid& request_id);
 
+  /**
+   * @brief Gzips the response body if it is large enough and the client
+   * accepts it. The response is sent uncompressed if the compression fails or
+   * does not shrink it.
+   *
+   * @param http_context The context of the request to respond to.
+   */
+  void CompressResponseBody(
+      AsyncContext<NgHttp2Request, NgHttp2Response>& http_context) noexcept;
+
   /// Callback to be used with an OTel ObservableInstrument for active requests.
   static void ObserveActiveRequestsCallback(
       opentelemetry::metrics::ObserverResult observer_result,
@@ -337,15 +472,42 @@ class Http2Server : public HttpServerInterface {
   /// The ngHttp2 http server instance.
   nghttp2::asio_http2::server::http2 http2_server_;
 
+  /// The number of listeners bound to the port.
+  size_t listener_count_;
+  /// The HTTP/2 SETTINGS sent on each connection, see Http2ServerOptions.
+  const uint32_t max_concurrent_streams_;
+  const uint32_t initial_window_size_;
+  const uint32_t header_table_size_;
+
+  /// The listeners beyond http2_server_ when there are several.
+  std::vector<std::unique_ptr<nghttp2::asio_http2::server::http2>>
+      additional_http2_servers_;
+
   /// The total http server thread pool size.
   size_t thread_pool_size_;
 
-  /// Registry of all the paths and handlers.
+  /// Registry of all the paths and handlers. Only used until Run(), which
+  /// freezes the handlers of each path into an immutable PathHandlers bound
+  /// to the nghttp2 handler of the path, so that the requests are dispatched
+  /// without any lookup in a shared table.
   common::ConcurrentMap<
       std::string,
       std::shared_ptr<common::ConcurrentMap<HttpMethod, HttpHandler>>>
       resource_handlers_;
 
+  /// Registry of all the streaming paths and handlers. Only used until Run().
+  common::ConcurrentMap<
+      std::string,
+      std::shared_ptr<common::ConcurrentMap<HttpMethod, HttpStreamingHandler>>>
+      streaming_resource_handlers_;
+
+  /// Registry of the non-default priorities of the handlers. Only used until
+  /// Run().
+  common::ConcurrentMap<
+      std::string,
+      std::shared_ptr<common::ConcurrentMap<HttpMethod, HttpRoutePriority>>>
+      route_priorities_;
+
   /// Registry of all the active requests.
   common::ConcurrentMap<common::Uuid,
                         std::shared_ptr<Http2SynchronizationContext>,
@@ -393,6 +555,12 @@ class Http2Server : public HttpServerInterface {
   /// The TLS context of the server.
   boost::asio::ssl::context tls_context_;
 
+  /// Placement of the worker threads over the CPUs.
+  ThreadPlacementPolicy worker_thread_placement_policy_;
+
+  /// The executor lane of the control-plane handlers, if any.
+  std::shared_ptr<AsyncExecutorInterface> control_plane_async_executor_;
+
   /// @brief Router to forward a request to a remote instance if needed.
   std::shared_ptr<HttpRequestRouterInterface> request_router_;
 
@@ -405,6 +573,14 @@ class Http2Server : public HttpServerInterface {
   /// @brief enables use of adtech site value as authorized_domain.
   bool adtech_site_authorized_domain_enabled_;
 
+  /// @brief The minimum length of the response bodies to gzip, 0 to disable.
+  size_t gzip_response_min_body_length_;
+
+  /// The configuration read on every request, resolved once from the config
+  /// provider. Null if there is no config provider.
+  std::unique_ptr<ConfigSnapshotPublisher<Http2ServerConfigSnapshot>>
+      config_snapshot_publisher_;
+
   /// OpenTelemetry Meter used for creating and managing metrics.
   std::shared_ptr<opentelemetry::metrics::Meter> meter_;
 
@@ -19,10 +19,15 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "core/interface/http_server_interface.h"
 
 #include "error_codes.h"
+#include "zlib.h"
 
 namespace google::scp::core::http2_server {
 class Http2Utils {
@@ -61,6 +66,73 @@ class Http2Utils {
     return SuccessExecutionResult();
   }
 
+  /**
+   * @brief Checks whether the accept-encoding header of the request lists
+   * gzip as acceptable.
+   *
+   * @param headers The map of all the headers.
+   * @return true If the response body can be gzipped.
+   */
+  static bool AcceptsGzipEncoding(const HttpHeaders& headers) noexcept {
+    auto header_iter = headers.find("accept-encoding");
+    if (header_iter == headers.end()) {
+      return false;
+    }
+    for (absl::string_view coding : absl::StrSplit(header_iter->second, ',')) {
+      std::vector<absl::string_view> parameters = absl::StrSplit(coding, ';');
+      if (!absl::EqualsIgnoreCase(absl::StripAsciiWhitespace(parameters[0]),
+                                  "gzip")) {
+        continue;
+      }
+      // A zero quality value, e.g. "gzip;q=0", rejects the coding.
+      for (size_t i = 1; i < parameters.size(); ++i) {
+        auto parameter = absl::StripAsciiWhitespace(parameters[i]);
+        if (absl::ConsumePrefix(&parameter, "q=") &&
+            parameter.find_first_not_of("0.") == absl::string_view::npos) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Compresses the body into a gzip stream.
+   *
+   * @param body The body to compress.
+   * @param compressed_body The gzip stream of the body if the operation was
+   * successful.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  static ExecutionResult GzipBody(const BytesBuffer& body,
+                                  BytesBuffer& compressed_body) noexcept {
+    z_stream stream = {};
+    // 16 added to the window bits selects the gzip wrapper over zlib's.
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, MAX_WBITS + 16,
+                     MAX_MEM_LEVEL - 1, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return FailureExecutionResult(
+          core::errors::SC_HTTP2_SERVER_FAILED_TO_COMPRESS_RESPONSE);
+    }
+
+    BytesBuffer output(deflateBound(&stream, body.length));
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<Byte*>(body.bytes->data()));
+    stream.avail_in = body.length;
+    stream.next_out = reinterpret_cast<Bytef*>(output.bytes->data());
+    stream.avail_out = output.capacity;
+    auto deflate_result = deflate(&stream, Z_FINISH);
+    output.length = stream.total_out;
+    deflateEnd(&stream);
+    if (deflate_result != Z_STREAM_END) {
+      return FailureExecutionResult(
+          core::errors::SC_HTTP2_SERVER_FAILED_TO_COMPRESS_RESPONSE);
+    }
+
+    compressed_body = std::move(output);
+    return SuccessExecutionResult();
+  }
+
  private:
   /**
    * @brief Checks that a string is number.
@@ -0,0 +1,269 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives an Http2Server with an HttpClient over loopback, with and without
+// TLS, and reports the requests per second and the latency percentiles. The
+// TLS certificate is self-signed, like the one of http2_server_test.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/async_executor/src/async_executor.h"
+#include "core/authorization_proxy/src/pass_thru_authorization_proxy.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/config_provider/mock/mock_config_provider.h"
+#include "core/http2_client/src/http2_client.h"
+#include "core/http2_server/src/http2_server.h"
+#include "public/cpio/mock/metric_client/mock_metric_client.h"
+
+namespace google::scp::core::test {
+
+using ::google::scp::core::common::RetryStrategyOptions;
+using ::google::scp::core::common::RetryStrategyType;
+using ::google::scp::core::common::TimeProvider;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::google::scp::cpio::MockMetricClient;
+
+static constexpr char kHostAddress[] = "localhost";
+static constexpr char kPath[] = "/v1/benchmark";
+static constexpr char kPrivateKeyFile[] = "./benchmark_privatekey.pem";
+static constexpr char kCertificateFile[] = "./benchmark_public.crt";
+static constexpr size_t kAsyncExecutorThreadCount = 8;
+static constexpr size_t kAsyncExecutorQueueCap = 100000;
+static constexpr TimeDuration kReadTimeoutInSeconds = 10;
+
+static constexpr char kP50LatencyKey[] = "p50_latency_us";
+static constexpr char kP99LatencyKey[] = "p99_latency_us";
+static constexpr char kFailedRequestsKey[] = "failed_requests";
+
+/// @brief Generates the self-signed certificate of the TLS server once.
+static void GenerateCertificate() {
+  static std::once_flag generated;
+  std::call_once(generated, []() {
+    system("openssl genrsa 2048 > benchmark_privatekey.pem");
+    system(
+        "openssl req -new -key benchmark_privatekey.pem -out "
+        "benchmark_csr.pem -config cc/core/http2_server/test/certs/csr.conf");
+    system(
+        "openssl x509 -req -days 7305 -in benchmark_csr.pem -signkey "
+        "benchmark_privatekey.pem -out benchmark_public.crt");
+  });
+}
+
+static int GenerateRandomPort() {
+  std::random_device random_device;
+  std::mt19937 random_number_engine(random_device());
+  return std::uniform_int_distribution<int>(8000, 60000)(random_number_engine);
+}
+
+/**
+ * @brief Runs a server and a client talking over loopback, for each set of
+ * arguments.
+ *
+ * The benchmark arguments are whether TLS is used, the bytes of the request
+ * and response bodies, the streams kept in flight, the thread pool size of the
+ * server and the max connections per host of the client's connection pool.
+ */
+class Http2ServerFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    bool use_tls = state.range(0) != 0;
+    size_t body_size = state.range(1);
+    max_in_flight_ = state.range(2);
+    size_t thread_pool_size = state.range(3);
+    size_t max_connections_per_host = state.range(4);
+    in_flight_ = 0;
+    failed_requests_ = 0;
+    latencies_.clear();
+
+    if (use_tls) {
+      GenerateCertificate();
+    }
+    body_ = BytesBuffer(std::string(body_size, 'a'));
+    std::string host_address = kHostAddress;
+    std::string port = std::to_string(GenerateRandomPort());
+    url_ = std::make_shared<std::string>(
+        std::string(use_tls ? "https://" : "http://") + host_address + ":" +
+        port + kPath);
+
+    server_async_executor_ = std::make_shared<AsyncExecutor>(
+        kAsyncExecutorThreadCount, kAsyncExecutorQueueCap,
+        true /* drop_tasks_on_stop */);
+    client_async_executor_ = std::make_shared<AsyncExecutor>(
+        kAsyncExecutorThreadCount, kAsyncExecutorQueueCap,
+        true /* drop_tasks_on_stop */);
+    std::shared_ptr<AuthorizationProxyInterface> authorization_proxy =
+        std::make_shared<PassThruAuthorizationProxy>();
+    Http2ServerOptions server_options(
+        use_tls, std::make_shared<std::string>(kPrivateKeyFile),
+        std::make_shared<std::string>(kCertificateFile));
+    auto http2_server = std::make_shared<Http2Server>(
+        host_address, port, thread_pool_size, server_async_executor_,
+        authorization_proxy, /*aws_authorization_proxy=*/nullptr,
+        std::make_shared<MockMetricClient>(),
+        std::make_shared<MockConfigProvider>(), server_options);
+    std::string path = kPath;
+    HttpHandler handler =
+        [this](AsyncContext<HttpRequest, HttpResponse>& context) {
+          context.response->body = body_;
+          context.response->code = errors::HttpStatusCode::OK;
+          context.result = SuccessExecutionResult();
+          context.Finish();
+          return SuccessExecutionResult();
+        };
+    http2_server->RegisterResourceHandler(HttpMethod::POST, path, handler);
+    http_server_ = http2_server;
+
+    HttpClientOptions client_options(
+        RetryStrategyOptions(RetryStrategyType::Linear, 100 /* delay in ms */,
+                             5 /* num retries */),
+        max_connections_per_host, kReadTimeoutInSeconds);
+    http_client_ =
+        std::make_shared<HttpClient>(client_async_executor_, client_options);
+
+    server_async_executor_->Init();
+    client_async_executor_->Init();
+    http_server_->Init();
+    http_client_->Init();
+    server_async_executor_->Run();
+    client_async_executor_->Run();
+    http_server_->Run();
+    http_client_->Run();
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    http_client_->Stop();
+    http_server_->Stop();
+    client_async_executor_->Stop();
+    server_async_executor_->Stop();
+    http_client_ = nullptr;
+    http_server_ = nullptr;
+  }
+
+  /// @brief Sends a request, blocking while the client already has the max
+  /// streams in flight.
+  void SendRequest() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return in_flight_ < max_in_flight_; });
+      in_flight_++;
+    }
+
+    auto request = std::make_shared<HttpRequest>();
+    request->method = HttpMethod::POST;
+    request->path = url_;
+    request->body = body_;
+    auto start_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
+    AsyncContext<HttpRequest, HttpResponse> http_context(
+        std::move(request),
+        [this, start_timestamp](AsyncContext<HttpRequest, HttpResponse>&
+                                    http_context) {
+          auto latency =
+              TimeProvider::GetSteadyTimestampInNanoseconds() - start_timestamp;
+          OnResponse(http_context.result.Successful(), latency);
+        });
+
+    // The connections of the pool may still be getting established.
+    auto execution_result = http_client_->PerformRequest(http_context);
+    while (execution_result.status == ExecutionStatus::Retry) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      execution_result = http_client_->PerformRequest(http_context);
+    }
+    if (!execution_result.Successful()) {
+      OnResponse(false, std::chrono::nanoseconds(0));
+    }
+  }
+
+  void OnResponse(bool is_successful, std::chrono::nanoseconds latency) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (is_successful) {
+        latencies_.push_back(latency.count());
+      } else {
+        failed_requests_++;
+      }
+      in_flight_--;
+    }
+    condition_.notify_all();
+  }
+
+  /// @brief Blocks until every request sent has its response.
+  void WaitForResponses() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return in_flight_ == 0; });
+  }
+
+  /// @brief Returns the latency of the given percentile, in microseconds.
+  double GetLatencyPercentile(double percentile) {
+    if (latencies_.empty()) {
+      return 0;
+    }
+    auto index = static_cast<size_t>(percentile * (latencies_.size() - 1));
+    std::nth_element(latencies_.begin(), latencies_.begin() + index,
+                     latencies_.end());
+    return latencies_[index] / 1000.0;
+  }
+
+  std::shared_ptr<AsyncExecutorInterface> server_async_executor_;
+  std::shared_ptr<AsyncExecutorInterface> client_async_executor_;
+  std::shared_ptr<HttpServerInterface> http_server_;
+  std::shared_ptr<HttpClientInterface> http_client_;
+  std::shared_ptr<std::string> url_;
+  BytesBuffer body_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t max_in_flight_ = 0;
+  size_t in_flight_ = 0;
+  size_t failed_requests_ = 0;
+  std::vector<int64_t> latencies_;
+};
+
+BENCHMARK_DEFINE_F(Http2ServerFixture, PerformRequest)
+
+(benchmark::State& state) {
+  for (auto _ : state) {
+    SendRequest();
+  }
+  WaitForResponses();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  state.SetItemsProcessed(state.iterations());
+  // The body is sent both ways.
+  state.SetBytesProcessed(state.iterations() * body_.length * 2);
+  state.counters[kP50LatencyKey] = GetLatencyPercentile(0.5);
+  state.counters[kP99LatencyKey] = GetLatencyPercentile(0.99);
+  state.counters[kFailedRequestsKey] = failed_requests_;
+}
+
+// TLS, body size, streams in flight, server thread pool size and max
+// connections per host.
+BENCHMARK_REGISTER_F(Http2ServerFixture, PerformRequest)
+    ->ArgsProduct({{0, 1}, {64, 16 << 10}, {1, 64, 256}, {2, 8}, {1, 4}})
+    ->UseRealTime();
+
+}  // namespace google::scp::core::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
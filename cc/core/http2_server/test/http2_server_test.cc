@@ -17,6 +17,9 @@
 #include "core/http2_server/src/http2_server.h"
 
 #include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include <future>
 #include <memory>
@@ -36,11 +39,13 @@
 #include "core/common/uuid/src/uuid.h"
 #include "core/config_provider/mock/mock_config_provider.h"
 #include "core/config_provider/src/env_config_provider.h"
+#include "core/http2_client/src/error_codes.h"
 #include "core/http2_client/src/http2_client.h"
 #include "core/http2_server/mock/mock_http2_request_with_overrides.h"
 #include "core/http2_server/mock/mock_http2_response_with_overrides.h"
 #include "core/http2_server/mock/mock_http2_server_with_overrides.h"
 #include "core/http2_server/src/error_codes.h"
+#include "core/http2_server/src/http2_utils.h"
 #include "core/telemetry/mock/in_memory_metric_router.h"
 #include "core/telemetry/src/common/metric_utils.h"
 #include "core/test/utils/conditional_wait.h"
@@ -63,6 +68,7 @@ using ::google::scp::core::authorization_proxy::mock::MockAuthorizationProxy;
 using ::google::scp::core::common::Uuid;
 using ::google::scp::core::config_provider::mock::MockConfigProvider;
 using ::google::scp::core::errors::HttpStatusCode;
+using ::google::scp::core::http2_server::Http2Utils;
 using ::google::scp::core::http2_server::mock::MockHttp2ServerWithOverrides;
 using ::google::scp::core::http2_server::mock::MockNgHttp2RequestWithOverrides;
 using ::google::scp::core::http2_server::mock::MockNgHttp2ResponseWithOverrides;
@@ -967,6 +973,308 @@ TEST_F(Http2ServerTest, ShouldHandleRequestProperlyWhenTlsIsEnabled) {
   async_executor->Stop();
 }
 
+TEST_F(Http2ServerTest, ControlPlaneHandlersRunOnTheControlPlaneExecutor) {
+  std::string host_address("localhost");
+  std::string port = std::to_string(GenerateRandomIntInRange(8000, 60000));
+  std::shared_ptr<AuthorizationProxyInterface> authorization_proxy =
+      std::make_shared<PassThruAuthorizationProxy>();
+  std::shared_ptr<AsyncExecutorInterface> async_executor =
+      std::make_shared<AsyncExecutor>(8, 10, true);
+  auto control_plane_async_executor = std::make_shared<MockAsyncExecutor>();
+  std::atomic<size_t> control_plane_task_count = 0;
+  control_plane_async_executor->schedule_mock =
+      [&](const AsyncOperation& work) {
+        control_plane_task_count++;
+        work();
+        return SuccessExecutionResult();
+      };
+
+  Http2ServerOptions http2_server_options;
+  http2_server_options.control_plane_async_executor =
+      control_plane_async_executor;
+  Http2Server http_server(host_address, port, 2 /* thread_pool_size */,
+                          async_executor, authorization_proxy,
+                          /*aws_authorization_proxy=*/nullptr,
+                          nullptr /* metric_client */, mock_config_provider_,
+                          http2_server_options);
+
+  HttpHandler handler = [](AsyncContext<HttpRequest, HttpResponse>& context) {
+    context.result = SuccessExecutionResult();
+    context.Finish();
+    return SuccessExecutionResult();
+  };
+  std::string control_plane_path("/control");
+  std::string data_plane_path("/data");
+  EXPECT_SUCCESS(http_server.RegisterResourceHandler(
+      HttpMethod::GET, control_plane_path, handler,
+      HttpRoutePriority::ControlPlane));
+  EXPECT_SUCCESS(http_server.RegisterResourceHandler(
+      HttpMethod::GET, data_plane_path, handler, HttpRoutePriority::Default));
+
+  EXPECT_SUCCESS(http_server.Init());
+  EXPECT_SUCCESS(http_server.Run());
+  HttpClient http_client(async_executor);
+  http_client.Init();
+  http_client.Run();
+  async_executor->Init();
+  async_executor->Run();
+
+  for (const auto& path : {data_plane_path, control_plane_path}) {
+    auto request = std::make_shared<HttpRequest>();
+    request->method = HttpMethod::GET;
+    request->path =
+        std::make_shared<std::string>("http://localhost:" + port + path);
+    std::promise<void> done;
+    AsyncContext<HttpRequest, HttpResponse> context(
+        std::move(request), [&](AsyncContext<HttpRequest, HttpResponse>&
+                                    context) {
+          EXPECT_SUCCESS(context.result);
+          done.set_value();
+        });
+    SubmitUntilSuccess(http_client, context);
+    done.get_future().get();
+  }
+  // Only the handler of the control-plane route is run on the reserved lane.
+  EXPECT_EQ(control_plane_task_count.load(), 1);
+
+  http_client.Stop();
+  http_server.Stop();
+  async_executor->Stop();
+}
+
+TEST_F(Http2ServerTest, ShardedListenersServeOnTheSamePort) {
+  std::string host_address("localhost");
+  std::string port = std::to_string(GenerateRandomIntInRange(8000, 60000));
+  std::shared_ptr<AuthorizationProxyInterface> authorization_proxy =
+      std::make_shared<PassThruAuthorizationProxy>();
+  std::shared_ptr<AsyncExecutorInterface> async_executor =
+      std::make_shared<AsyncExecutor>(8, 10, true);
+
+  Http2ServerOptions http2_server_options;
+  http2_server_options.listener_count = 4;
+  Http2Server http_server(host_address, port, 4 /* thread_pool_size */,
+                          async_executor, authorization_proxy,
+                          /*aws_authorization_proxy=*/nullptr,
+                          nullptr /* metric_client */, mock_config_provider_,
+                          http2_server_options);
+
+  std::atomic<size_t> handled_request_count = 0;
+  HttpHandler handler = [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+    handled_request_count++;
+    context.result = SuccessExecutionResult();
+    context.Finish();
+    return SuccessExecutionResult();
+  };
+  std::string path("/test");
+  EXPECT_SUCCESS(
+      http_server.RegisterResourceHandler(HttpMethod::GET, path, handler));
+
+  EXPECT_SUCCESS(http_server.Init());
+  // All the listeners are bound to the port.
+  EXPECT_SUCCESS(http_server.Run());
+  HttpClient http_client(async_executor);
+  http_client.Init();
+  http_client.Run();
+  async_executor->Init();
+  async_executor->Run();
+
+  for (size_t i = 0; i < 8; ++i) {
+    auto request = std::make_shared<HttpRequest>();
+    request->method = HttpMethod::GET;
+    request->path =
+        std::make_shared<std::string>("http://localhost:" + port + path);
+    std::promise<void> done;
+    AsyncContext<HttpRequest, HttpResponse> context(
+        std::move(request), [&](AsyncContext<HttpRequest, HttpResponse>&
+                                    context) {
+          EXPECT_SUCCESS(context.result);
+          done.set_value();
+        });
+    SubmitUntilSuccess(http_client, context);
+    done.get_future().get();
+  }
+  EXPECT_EQ(handled_request_count.load(), 8);
+
+  http_client.Stop();
+  EXPECT_SUCCESS(http_server.Stop());
+  async_executor->Stop();
+}
+
+TEST_F(Http2ServerTest, ShardedListenersShareAnEphemeralPort) {
+  std::string host_address("localhost");
+  std::string port("0");
+  std::shared_ptr<AuthorizationProxyInterface> authorization_proxy =
+      std::make_shared<PassThruAuthorizationProxy>();
+  std::shared_ptr<AsyncExecutorInterface> async_executor =
+      std::make_shared<MockAsyncExecutor>();
+
+  Http2ServerOptions http2_server_options;
+  http2_server_options.listener_count = 2;
+  Http2Server http_server(host_address, port, 2 /* thread_pool_size */,
+                          async_executor, authorization_proxy,
+                          /*aws_authorization_proxy=*/nullptr,
+                          nullptr /* metric_client */, mock_config_provider_,
+                          http2_server_options);
+
+  // The second listener is bound to the port picked for the first one, which
+  // only succeeds with SO_REUSEPORT.
+  EXPECT_SUCCESS(http_server.Run());
+  EXPECT_SUCCESS(http_server.Stop());
+}
+
+TEST_F(Http2ServerTest, ListensOnTheInheritedListeningSocketOfItsPort) {
+  // A listening socket without SO_REUSEPORT, so that the server cannot bind a
+  // socket of its own to the port.
+  int socket_fd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  ASSERT_GE(socket_fd, 0);
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_addr = in6addr_any;
+  ASSERT_EQ(bind(socket_fd, reinterpret_cast<sockaddr*>(&address),
+                 sizeof(address)),
+            0);
+  ASSERT_EQ(listen(socket_fd, 16), 0);
+  socklen_t address_length = sizeof(address);
+  ASSERT_EQ(getsockname(socket_fd, reinterpret_cast<sockaddr*>(&address),
+                        &address_length),
+            0);
+  std::string port = std::to_string(ntohs(address.sin6_port));
+  Http2Server::SetInheritedListeningSockets({socket_fd});
+
+  std::string host_address("localhost");
+  std::shared_ptr<AuthorizationProxyInterface> authorization_proxy =
+      std::make_shared<PassThruAuthorizationProxy>();
+  std::shared_ptr<AsyncExecutorInterface> async_executor =
+      std::make_shared<AsyncExecutor>(8, 10, true);
+  Http2Server http_server(host_address, port, 2 /* thread_pool_size */,
+                          async_executor, authorization_proxy,
+                          /*aws_authorization_proxy=*/nullptr,
+                          nullptr /* metric_client */, mock_config_provider_);
+  HttpHandler handler = [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+    context.result = SuccessExecutionResult();
+    context.Finish();
+    return SuccessExecutionResult();
+  };
+  std::string path("/test");
+  EXPECT_SUCCESS(
+      http_server.RegisterResourceHandler(HttpMethod::GET, path, handler));
+  EXPECT_SUCCESS(http_server.Init());
+  EXPECT_SUCCESS(http_server.Run());
+  HttpClient http_client(async_executor);
+  http_client.Init();
+  http_client.Run();
+  async_executor->Init();
+  async_executor->Run();
+
+  auto request = std::make_shared<HttpRequest>();
+  request->method = HttpMethod::GET;
+  request->path =
+      std::make_shared<std::string>("http://localhost:" + port + path);
+  std::promise<void> done;
+  AsyncContext<HttpRequest, HttpResponse> context(
+      std::move(request),
+      [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        done.set_value();
+      });
+  SubmitUntilSuccess(http_client, context);
+  done.get_future().get();
+
+  http_client.Stop();
+  EXPECT_SUCCESS(http_server.Stop());
+  async_executor->Stop();
+  Http2Server::SetInheritedListeningSockets({});
+  close(socket_fd);
+}
+
+TEST_F(Http2ServerTest, ServesOnlyTheHandlersRegisteredBeforeRun) {
+  std::string host_address("localhost");
+  std::string port = std::to_string(GenerateRandomIntInRange(8000, 60000));
+  std::shared_ptr<AuthorizationProxyInterface> authorization_proxy =
+      std::make_shared<PassThruAuthorizationProxy>();
+  std::shared_ptr<AsyncExecutorInterface> async_executor =
+      std::make_shared<AsyncExecutor>(8, 10, true);
+  Http2Server http_server(host_address, port, 2 /* thread_pool_size */,
+                          async_executor, authorization_proxy,
+                          /*aws_authorization_proxy=*/nullptr,
+                          nullptr /* metric_client */, mock_config_provider_);
+
+  std::atomic<size_t> handled_request_count = 0;
+  HttpHandler handler = [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+    handled_request_count++;
+    context.result = SuccessExecutionResult();
+    context.Finish();
+    return SuccessExecutionResult();
+  };
+  std::string before_path("/before");
+  EXPECT_SUCCESS(http_server.RegisterResourceHandler(HttpMethod::GET,
+                                                     before_path, handler));
+  EXPECT_SUCCESS(http_server.Init());
+  EXPECT_SUCCESS(http_server.Run());
+
+  // The handlers are frozen once the server runs.
+  std::string after_path("/after");
+  EXPECT_THAT(
+      http_server.RegisterResourceHandler(HttpMethod::GET, after_path, handler),
+      ResultIs(FailureExecutionResult(
+          errors::SC_HTTP2_SERVER_CANNOT_REGISTER_HANDLER)));
+  EXPECT_THAT(http_server.RegisterResourceHandler(HttpMethod::POST,
+                                                  before_path, handler),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_HTTP2_SERVER_CANNOT_REGISTER_HANDLER)));
+  HttpStreamingHandler streaming_handler = [&](const HttpRequest&) {
+    HttpStreamingRequestHandler request_handler;
+    request_handler.on_request = handler;
+    return request_handler;
+  };
+  EXPECT_THAT(http_server.RegisterStreamingResourceHandler(
+                  HttpMethod::GET, after_path, streaming_handler),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_HTTP2_SERVER_CANNOT_REGISTER_HANDLER)));
+
+  HttpClient http_client(async_executor);
+  http_client.Init();
+  http_client.Run();
+  async_executor->Init();
+  async_executor->Run();
+
+  auto before_request = std::make_shared<HttpRequest>();
+  before_request->method = HttpMethod::GET;
+  before_request->path =
+      std::make_shared<std::string>("http://localhost:" + port + before_path);
+  std::promise<void> before_done;
+  AsyncContext<HttpRequest, HttpResponse> before_context(
+      std::move(before_request),
+      [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        before_done.set_value();
+      });
+  SubmitUntilSuccess(http_client, before_context);
+  before_done.get_future().get();
+  EXPECT_EQ(handled_request_count.load(), 1);
+
+  auto after_request = std::make_shared<HttpRequest>();
+  after_request->method = HttpMethod::GET;
+  after_request->path =
+      std::make_shared<std::string>("http://localhost:" + port + after_path);
+  std::promise<void> after_done;
+  AsyncContext<HttpRequest, HttpResponse> after_context(
+      std::move(after_request),
+      [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        EXPECT_THAT(context.result,
+                    ResultIs(FailureExecutionResult(
+                        errors::SC_HTTP2_CLIENT_HTTP_STATUS_NOT_FOUND)));
+        after_done.set_value();
+      });
+  SubmitUntilSuccess(http_client, after_context);
+  after_done.get_future().get();
+  EXPECT_EQ(handled_request_count.load(), 1);
+
+  http_client.Stop();
+  EXPECT_SUCCESS(http_server.Stop());
+  async_executor->Stop();
+}
+
 TEST_F(Http2ServerTest,
        OnBodyDataReceivedWithExtraDataReturnsPartialDataError) {
   {
@@ -1052,5 +1360,96 @@ TEST_F(Http2ServerTest, OnBodyDataReceivedWithLessDataReturnsPartialDataError) {
   }
 }
 
+TEST_F(Http2ServerTest, OnBodyDataReceivedWithChunkConsumerIsNotBuffered) {
+  nghttp2::asio_http2::server::request ng_request;
+  MockNgHttp2RequestWithOverrides request(ng_request, 10 /* body length */);
+
+  std::string consumed_body;
+  request.SetBodyChunkConsumer([&](const Byte* chunk, size_t length) {
+    consumed_body.append(chunk, length);
+    return SuccessExecutionResult();
+  });
+  bool callback_called = false;
+  request.SetOnRequestBodyDataReceivedCallback([&](ExecutionResult result) {
+    EXPECT_SUCCESS(result);
+    callback_called = true;
+  });
+  const std::string body = "0123456789";
+  request.SimulateOnRequestBodyDataReceived(
+      reinterpret_cast<const uint8_t*>(body.data()), 4);
+  request.SimulateOnRequestBodyDataReceived(
+      reinterpret_cast<const uint8_t*>(body.data()) + 4, 6);
+  EXPECT_FALSE(callback_called);
+  request.SimulateOnRequestBodyDataReceived(nullptr, 0);
+
+  EXPECT_TRUE(callback_called);
+  EXPECT_EQ(consumed_body, body);
+  EXPECT_EQ(request.body.length, 0);
+  EXPECT_TRUE(request.body.bytes->empty());
+}
+
+TEST_F(Http2ServerTest, OnBodyDataReceivedWithFailingChunkConsumerFailsOnce) {
+  nghttp2::asio_http2::server::request ng_request;
+  MockNgHttp2RequestWithOverrides request(ng_request, 10 /* body length */);
+
+  size_t consumed_chunk_count = 0;
+  request.SetBodyChunkConsumer([&](const Byte*, size_t) {
+    consumed_chunk_count++;
+    return FailureExecutionResult(errors::SC_HTTP2_SERVER_INVALID_HEADER);
+  });
+  size_t callback_count = 0;
+  request.SetOnRequestBodyDataReceivedCallback([&](ExecutionResult result) {
+    EXPECT_THAT(result, ResultIs(FailureExecutionResult(
+                            errors::SC_HTTP2_SERVER_INVALID_HEADER)));
+    callback_count++;
+  });
+  uint8_t data[5];
+  request.SimulateOnRequestBodyDataReceived(data, 5);
+  request.SimulateOnRequestBodyDataReceived(data, 5);
+  request.SimulateOnRequestBodyDataReceived(data, 0);
+
+  EXPECT_EQ(consumed_chunk_count, 1);
+  EXPECT_EQ(callback_count, 1);
+}
+
+TEST(Http2UtilsTest, AcceptsGzipEncoding) {
+  HttpHeaders headers;
+  EXPECT_FALSE(Http2Utils::AcceptsGzipEncoding(headers));
+
+  for (std::string accept_encoding :
+       {"gzip", "deflate, GZIP", "br;q=1.0, gzip;q=0.5", "gzip;q=0.001"}) {
+    headers = {{"accept-encoding", accept_encoding}};
+    EXPECT_TRUE(Http2Utils::AcceptsGzipEncoding(headers)) << accept_encoding;
+  }
+  for (std::string accept_encoding :
+       {"", "deflate", "br, x-gzip2", "gzip;q=0", "gzip; q=0.0"}) {
+    headers = {{"accept-encoding", accept_encoding}};
+    EXPECT_FALSE(Http2Utils::AcceptsGzipEncoding(headers)) << accept_encoding;
+  }
+}
+
+TEST(Http2UtilsTest, GzipBodyRoundTrips) {
+  std::string body_string;
+  for (int i = 0; i < 1000; ++i) {
+    body_string += "exhausted-budget-key-" + std::to_string(i % 10) + ",";
+  }
+  BytesBuffer body(body_string);
+  BytesBuffer compressed_body;
+  ASSERT_SUCCESS(Http2Utils::GzipBody(body, compressed_body));
+  EXPECT_LT(compressed_body.length, body.length);
+
+  z_stream stream = {};
+  ASSERT_EQ(inflateInit2(&stream, MAX_WBITS + 16), Z_OK);
+  std::string decompressed(body_string.size(), '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(compressed_body.bytes->data());
+  stream.avail_in = compressed_body.length;
+  stream.next_out = reinterpret_cast<Bytef*>(decompressed.data());
+  stream.avail_out = decompressed.size();
+  EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+  EXPECT_EQ(stream.total_out, body_string.size());
+  inflateEnd(&stream);
+  EXPECT_EQ(decompressed, body_string);
+}
+
 }  // namespace
 }  // namespace google::scp::core
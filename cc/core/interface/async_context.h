@@ -105,24 +105,20 @@ struct AsyncContext {
         response(nullptr),
         result(FailureExecutionResult(SC_UNKNOWN)),
         callback(callback),
-        retry_count(0) {
+        retry_count(0),
+        retry_after_ms(0) {
     expiration_time =
-        (common::TimeProvider::GetSteadyTimestampInNanoseconds() +
+        (common::TimeProvider::GetCoarseSteadyTimestampInNanoseconds() +
          std::chrono::seconds(kAsyncContextExpirationDurationInSeconds))
             .count();
   }
 
-  AsyncContext(const AsyncContext& right) {
-    parent_activity_id = right.parent_activity_id;
-    activity_id = right.activity_id;
-    correlation_id = right.correlation_id;
-    request = right.request;
-    response = right.response;
-    result = right.result;
-    callback = right.callback;
-    retry_count = right.retry_count;
-    expiration_time = right.expiration_time;
-  }
+  AsyncContext(const AsyncContext& right) = default;
+  /// Moving takes over the request, response and callback without touching
+  /// their reference counts, where a copy increments and later decrements each.
+  AsyncContext(AsyncContext&& right) = default;
+  AsyncContext& operator=(const AsyncContext& right) = default;
+  AsyncContext& operator=(AsyncContext&& right) = default;
 
   /// Finishes the async operation by calling the callback.
   virtual void Finish() noexcept {
@@ -166,6 +162,10 @@ struct AsyncContext {
   /// The count of retries on the request.
   size_t retry_count;
 
+  /// How long the target component asked to wait before the operation is
+  /// retried, in milliseconds. 0 if it gave no hint.
+  TimeDuration retry_after_ms;
+
   /// The expiration_time time of the async context.
   Timestamp expiration_time;
 };
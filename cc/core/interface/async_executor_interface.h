@@ -16,8 +16,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "core/common/time_provider/src/time_provider.h"
 
 #include "service_interface.h"
 #include "type_def.h"
@@ -88,6 +95,25 @@ enum class AsyncExecutorAffinitySetting {
 
 using TaskCancellationLambda = std::function<bool()>;
 
+/**
+ * @brief Names the component and the operation a task does its work for, so
+ * that the CPU time of the executor threads can be attributed. Both must be
+ * static strings, e.g. literals, since the executors keep pointing to them.
+ */
+struct AsyncTaskTag {
+  const char* component = nullptr;
+  const char* operation = nullptr;
+};
+
+/// The tasks scheduled with a tag and the CPU time they took, estimated from
+/// the sampled ones.
+struct AsyncTaskTagStats {
+  std::string component;
+  std::string operation;
+  uint64_t task_count = 0;
+  std::chrono::nanoseconds cpu_time = std::chrono::nanoseconds(0);
+};
+
 /**
  * @brief AsyncExecutor is the main thread-pool of the service. It controls the
  * number of threads that are used across the application and is capable of
@@ -115,6 +141,18 @@ class AsyncExecutorInterface : public ServiceInterface {
       const AsyncOperation& work, AsyncPriority priority,
       AsyncExecutorAffinitySetting affinity) noexcept = 0;
 
+  /**
+   * @brief Same as above but attributes the CPU time of the task to the given
+   * tag. Implementations that do not keep per tag stats schedule the task as
+   * Schedule does.
+   * @param tag the component and operation the task works for.
+   */
+  virtual ExecutionResult Schedule(const AsyncOperation& work,
+                                   AsyncPriority priority,
+                                   const AsyncTaskTag& tag) noexcept {
+    return Schedule(work, priority);
+  }
+
   /**
    * @brief Schedules a task to be executed after the specified time.
    * NOTE: There is no guarantee in terms of execution of the task at the
@@ -157,5 +195,103 @@ class AsyncExecutorInterface : public ServiceInterface {
       const AsyncOperation& work, Timestamp timestamp,
       TaskCancellationLambda& cancellation_callback,
       AsyncExecutorAffinitySetting affinity) noexcept = 0;
+
+  /**
+   * @brief Schedules a task to be executed before a deadline. A task still
+   * waiting in the queue at its deadline is dropped, and on_expired is called
+   * in its place, so that no CPU is spent on work whose result would come too
+   * late.
+   *
+   * Implementations ordering their queues by deadline run the tasks with the
+   * earliest deadline first. Others schedule the task as Schedule does and
+   * only check the deadline right before running it.
+   *
+   * @param work the task that needs to be scheduled.
+   * @param priority the priority of the task.
+   * @param deadline the coarse steady clock time in nanoseconds after which
+   * the task is not executed anymore, e.g. the expiration_time of an
+   * AsyncContext. 0 for no deadline.
+   * @param on_expired the operation called instead of the task once expired.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  virtual ExecutionResult ScheduleWithDeadline(
+      const AsyncOperation& work, AsyncPriority priority, Timestamp deadline,
+      const AsyncOperation& on_expired) noexcept {
+    return Schedule(
+        [work, deadline, on_expired]() {
+          if (deadline != 0 &&
+              common::TimeProvider::
+                      GetCoarseSteadyTimestampInNanosecondsAsClockTicks() >=
+                  deadline) {
+            if (on_expired) {
+              on_expired();
+            }
+            return;
+          }
+          work();
+        },
+        priority);
+  }
+
+  /**
+   * @brief Schedules a task on the executor thread owning the shard key.
+   * Implementations with per-thread queues run all the tasks of a shard key
+   * on the same thread, in order, so that the state they touch stays in that
+   * thread's cache. Others schedule the task as Schedule does.
+   *
+   * @param work the task that needs to be scheduled.
+   * @param priority the priority of the task.
+   * @param shard_key the key, e.g. a hash, of the state the task works on.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  virtual ExecutionResult ScheduleToShard(const AsyncOperation& work,
+                                          AsyncPriority priority,
+                                          uint64_t shard_key) noexcept {
+    return Schedule(work, priority);
+  }
+
+  /**
+   * @brief Schedules a batch of tasks with the same priority. Implementations
+   * can enqueue the batch with fewer signals to their threads than scheduling
+   * the tasks one by one.
+   *
+   * The tasks are scheduled in order until one fails. On failure, the first
+   * scheduled_count tasks are scheduled and the remaining ones are not.
+   *
+   * @param works the tasks that need to be scheduled.
+   * @param priority the priority of the tasks.
+   * @param scheduled_count the number of tasks that were scheduled.
+   * @return ExecutionResult result of the execution with possible error code.
+   */
+  virtual ExecutionResult ScheduleBatch(absl::Span<const AsyncOperation> works,
+                                        AsyncPriority priority,
+                                        size_t& scheduled_count) noexcept {
+    scheduled_count = 0;
+    for (const auto& work : works) {
+      auto execution_result = Schedule(work, priority);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+      ++scheduled_count;
+    }
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Same as above but without reporting the number of scheduled tasks.
+   */
+  virtual ExecutionResult ScheduleBatch(absl::Span<const AsyncOperation> works,
+                                        AsyncPriority priority) noexcept {
+    size_t scheduled_count = 0;
+    return ScheduleBatch(works, priority, scheduled_count);
+  }
+
+  /**
+   * @brief Returns the stats of the tasks scheduled with a tag, the ones with
+   * the most CPU time first. Empty if the implementation does not keep them.
+   */
+  virtual std::vector<AsyncTaskTagStats> GetTaskTagStats() const noexcept {
+    return {};
+  }
 };
 }  // namespace google::scp::core
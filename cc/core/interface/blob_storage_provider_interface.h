@@ -73,6 +73,12 @@ struct ListBlobsResponse {
    * until marker is null.
    */
   std::shared_ptr<Blob> next_marker;
+  /**
+   * @brief Whether the provider knows that no blob follows the ones of this
+   * page. If not set, a page without next_marker may still not be the last
+   * one, and the caller lists again from its last blob to make sure.
+   */
+  bool is_last_page = false;
 };
 
 /// Represents the put blob request object.
@@ -38,6 +38,10 @@ struct CheckpointLog {
   JournalLogStatus log_status;
   /// The serialized data the need to be stored.
   BytesBuffer bytes_buffer;
+  /// The logs with the same key are stored in the same checkpoint shard, in
+  /// their order. The logs of the default key are stored in the first shard,
+  /// which is replayed first.
+  size_t shard_key = 0;
 };
 
 /**
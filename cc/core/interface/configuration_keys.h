@@ -32,6 +32,33 @@ static constexpr char kTransactionManagerSkipFailedLogsInRecovery[] =
     "google_scp_transaction_manager_skip_failed_logs_in_recovery";
 static constexpr char kPBSJournalServiceFlushIntervalInMilliseconds[] =
     "google_scp_journal_service_flush_interval_in_milliseconds";
+// The maximum number of journal batches written concurrently.
+static constexpr char kPBSJournalServiceMaxConcurrentBlobWrites[] =
+    "google_scp_journal_service_max_concurrent_blob_writes";
+// The journal logs are flushed once this many bytes are pending, or once the
+// oldest of them waited the max latency, whichever comes first.
+static constexpr char kPBSJournalServiceGroupCommitMaxPendingBytes[] =
+    "google_scp_journal_service_group_commit_max_pending_bytes";
+static constexpr char kPBSJournalServiceGroupCommitMaxLatencyInMilliseconds[] =
+    "google_scp_journal_service_group_commit_max_latency_in_milliseconds";
+// The zlib compression level of the journal blobs, from 1 (fastest) to 9
+// (smallest). Zero, the default, writes them uncompressed.
+static constexpr char kPBSJournalServiceBlobCompressionLevel[] =
+    "google_scp_journal_service_blob_compression_level";
+// The maximum number of threads applying the recovered logs of the components
+// subscribed for parallel recovery.
+static constexpr char kPBSJournalServiceRecoveryApplyConcurrency[] =
+    "google_scp_journal_service_recovery_apply_concurrency";
+// With streaming replay, a recovered log is only checked for duplicates against
+// the logs of the journals written this many seconds before its journal.
+static constexpr char kPBSJournalServiceRecoveryDedupWindowInSeconds[] =
+    "google_scp_journal_service_recovery_dedup_window_in_seconds";
+// The directory of the local write-ahead log of the journals. When set, a
+// batch of logs is acknowledged once durable on the local disk, and written to
+// the blob storage in the background. The disk must be replicated and move
+// with the partition. Disabled if not set or empty.
+static constexpr char kPBSJournalServiceLocalWriteAheadLogDirectory[] =
+    "google_scp_journal_service_local_write_ahead_log_directory";
 static constexpr char kTransactionTimeoutInSecondsConfigName[] =
     "google_scp_pbs_transaction_timeout_in_seconds";
 static constexpr char kTransactionResolutionWithRemoteEnabled[] =
@@ -42,16 +69,101 @@ static constexpr char kHTTPServerRequestRoutingEnabled[] =
     "google_scp_http_server_request_routing_enabled";
 static constexpr char kHttpServerDnsRoutingEnabled[] =
     "google_scp_http_server_dns_routing_enabled";
+// The responses of at least this many bytes are gzipped for the clients
+// accepting it. 0, the default, disables the compression.
+static constexpr char kHttpServerGzipResponseMinBodyLengthInBytes[] =
+    "google_scp_http_server_gzip_response_min_body_length_in_bytes";
 static constexpr char kPBSJournalInputStreamEnableBatchReadJournals[] =
     "google_scp_pbs_journal_input_stream_enable_batch_read_journals";
 static constexpr char kPBSJournalInputStreamNumberOfJournalsPerBatch[] =
     "google_scp_pbs_journal_input_stream_number_of_journals_per_batch";
 static constexpr char kPBSJournalInputStreamNumberOfJournalLogsToReturn[] =
     "google_scp_pbs_journal_input_stream_number_of_journal_logs_to_return";
+// With batch reads, read the journals of the next batch while the logs of the
+// current batch are returned.
+static constexpr char kPBSJournalInputStreamEnablePrefetchJournals[] =
+    "google_scp_pbs_journal_input_stream_enable_prefetch_journals";
+// Replays the journals in bounded memory: the journals are read in batches
+// keeping at most the max resident journal blobs in memory, prefetched ones
+// included, and the journal service only remembers the replayed log ids
+// within the dedup window. Implies batch reads.
+static constexpr char kPBSJournalInputStreamEnableStreamingReplay[] =
+    "google_scp_pbs_journal_input_stream_enable_streaming_replay";
+static constexpr char kPBSJournalInputStreamMaxResidentJournalBlobs[] =
+    "google_scp_pbs_journal_input_stream_max_resident_journal_blobs";
+// Lists the journals following the last checkpoint as this many journal id
+// ranges in parallel. 1, the default, lists them sequentially.
+static constexpr char kPBSJournalInputStreamJournalListingShardCount[] =
+    "google_scp_pbs_journal_input_stream_journal_listing_shard_count";
+// Merges the journals following the last checkpoint into segments, which the
+// recoveries read instead. Must stay enabled until a checkpoint covers the
+// segments written while it was.
+static constexpr char kPBSJournalServiceEnableJournalCompaction[] =
+    "google_scp_pbs_journal_service_enable_journal_compaction";
+static constexpr char kPBSJournalServiceJournalsPerCompactedSegment[] =
+    "google_scp_pbs_journal_service_journals_per_compacted_segment";
 static constexpr char kTransactionManagerSkipDuplicateTransactionInRecovery[] =
     "google_scp_transaction_manager_skip_duplicate_transaction_in_recovery";
+// The maximum number of released transaction objects the transaction engine
+// keeps for reuse. Zero, the default, disables the reuse.
+static constexpr char kTransactionManagerTransactionPoolSize[] =
+    "google_scp_transaction_manager_transaction_pool_size";
+// Journals the phase logs of the concurrent transactions together, in a single
+// journal log per batch.
+static constexpr char kTransactionManagerBatchPhaseLogs[] =
+    "google_scp_transaction_manager_batch_phase_logs";
+// Skips journaling the prepare and committed states of the transactions that
+// are not coordinated remotely. Only valid if the prepare phase of the commands
+// does not change any state, so that a transaction recovered before it can
+// simply redo it.
+static constexpr char kTransactionManagerLocalTransactionFastPathEnabled[] =
+    "google_scp_transaction_manager_local_transaction_fast_path_enabled";
+// The maximum number of expired transactions the transaction engine resolves at
+// a time, earliest deadline first. Zero, the default, resolves each one as
+// soon as the garbage collection finds it.
+static constexpr char kTransactionManagerExpiredTransactionBatchSize[] =
+    "google_scp_transaction_manager_expired_transaction_batch_size";
+// Whether the expired transactions resolved at a time inquire their statuses on
+// the remote coordinator in one request per origin rather than one request per
+// transaction. Only applies if the expired transaction batch size is set.
+static constexpr char kTransactionManagerBatchRemoteTransactionStatusEnabled[] =
+    "google_scp_transaction_manager_batch_remote_transaction_status_enabled";
+// One transaction out of this many has the time spent in each stage of its
+// phases recorded. Zero disables the sampling.
+static constexpr char kTransactionManagerTelemetrySamplingPeriod[] =
+    "google_scp_transaction_manager_telemetry_sampling_period";
+// The maximum number of commands of a transaction phase the transaction engine
+// dispatches in parallel on the async executor. Zero, the default, dispatches
+// them one after the other.
+static constexpr char kTransactionManagerCommandDispatchFanOut[] =
+    "google_scp_transaction_manager_command_dispatch_fan_out";
 static constexpr char kSpannerEndpointOverride[] =
     "google_scp_core_spanner_endpoint_override";
+// The session pool and channel settings of the Spanner connection. Unset or
+// zero keeps the default of the client library.
+// The sessions created along with the connection, and kept in the pool.
+static constexpr char kSpannerSessionPoolMinSessions[] =
+    "google_scp_core_spanner_session_pool_min_sessions";
+// The max number of sessions in use per gRPC channel.
+static constexpr char kSpannerSessionPoolMaxSessionsPerChannel[] =
+    "google_scp_core_spanner_session_pool_max_sessions_per_channel";
+// How often the idle sessions are refreshed, in seconds.
+static constexpr char kSpannerSessionPoolKeepAliveIntervalInSeconds[] =
+    "google_scp_core_spanner_session_pool_keep_alive_interval_in_seconds";
+// The number of gRPC channels the sessions are spread over.
+static constexpr char kSpannerNumChannels[] =
+    "google_scp_core_spanner_num_channels";
+// How often the idle gRPC channels send keepalive pings, in milliseconds.
+static constexpr char kSpannerGrpcKeepAliveTimeInMilliseconds[] =
+    "google_scp_core_spanner_grpc_keep_alive_time_in_milliseconds";
+// Whether the read-write transactions are routed to the leader region of a
+// multi-region instance. Unset keeps the default of the client library.
+static constexpr char kSpannerRouteToLeaderEnabled[] =
+    "google_scp_core_spanner_route_to_leader_enabled";
+// Whether a query is run on the Spanner connection at Run(), so that it is
+// ready before serving traffic. Defaults to false.
+static constexpr char kSpannerWarmUpEnabled[] =
+    "google_scp_core_spanner_warm_up_enabled";
 static constexpr char kPBSAdtechSiteAsAuthorizedDomain[] =
     "google_scp_pbs_adtech_site_as_authorized_domain_enabled";
 static constexpr char kOtelServerMetricsEnabled[] =
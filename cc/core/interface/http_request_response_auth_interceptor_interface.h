@@ -49,5 +49,17 @@ class HttpRequestResponseAuthInterceptorInterface {
   virtual ExecutionResultOr<AuthorizedMetadata>
   ObtainAuthorizedMetadataFromResponse(const AuthorizationMetadata&,
                                        const HttpResponse&) = 0;
+
+  /**
+   * @brief Authorizes without a request to the cloud platform if possible, for
+   * instance by verifying a signed token locally.
+   *
+   * @return ExecutionResultOr<AuthorizedMetadata> The authorized metadata, or
+   * a failure if the request is needed.
+   */
+  virtual ExecutionResultOr<AuthorizedMetadata> AuthorizeLocally(
+      const AuthorizationMetadata&) {
+    return FailureExecutionResult(SC_UNKNOWN);
+  }
 };
 }  // namespace google::scp::core
@@ -32,6 +32,41 @@ namespace google::scp::core {
 typedef std::function<ExecutionResult(AsyncContext<HttpRequest, HttpResponse>&)>
     HttpHandler;
 
+/// Type definition for the consumer of the body chunks of a request. The chunk
+/// is only valid for the duration of the call. Returning a failure fails the
+/// request.
+typedef std::function<ExecutionResult(const Byte* chunk, size_t length)>
+    HttpBodyChunkConsumer;
+
+/// Handles a single request to a streaming resource.
+struct HttpStreamingRequestHandler {
+  /// Is invoked with every chunk of the request body as it is received,
+  /// before the request is authorized.
+  HttpBodyChunkConsumer on_body_chunk;
+  /// Is invoked once the whole body has been consumed and the request is
+  /// authorized. The body of the request is not necessarily buffered.
+  HttpHandler on_request;
+};
+
+/// Type definition for the resource handler of a streaming resource. Is
+/// invoked with every request once its headers are received, and creates
+/// the handler of the request.
+typedef std::function<HttpStreamingRequestHandler(const HttpRequest& request)>
+    HttpStreamingHandler;
+
+/// The priority class of the requests to a resource.
+enum class HttpRoutePriority {
+  /// The data-plane requests, e.g. the budget consumption ones.
+  Default = 0,
+  /**
+   * The control-plane requests, e.g. the health checks and the transaction
+   * status and lease calls of the peers. Their handlers are run on an executor
+   * lane reserved for them, if the server has one, so that they are not queued
+   * behind the data-plane requests. They are never shed by admission control.
+   */
+  ControlPlane = 1,
+};
+
 /// Provides HTTP(S) server functionality.
 class HttpServerInterface : public ServiceInterface {
  public:
@@ -48,5 +83,55 @@ class HttpServerInterface : public ServiceInterface {
   virtual ExecutionResult RegisterResourceHandler(
       HttpMethod http_method, std::string& resource_path,
       HttpHandler& handler) noexcept = 0;
+
+  /**
+   * @brief Registers resource handler for http operations of a priority class.
+   *
+   * The default implementation ignores the priority.
+   *
+   * @param http_method The method of the operation.
+   * @param resource_path The resource path in REST format.
+   * @param handler The handler of the specific path.
+   * @param priority The priority class of the requests.
+   * @return ExecutionResult
+   */
+  virtual ExecutionResult RegisterResourceHandler(
+      HttpMethod http_method, std::string& resource_path, HttpHandler& handler,
+      HttpRoutePriority priority) noexcept {
+    return RegisterResourceHandler(http_method, resource_path, handler);
+  }
+
+  /**
+   * @brief Registers resource handler for http operations whose body is
+   * consumed as it is received, instead of being buffered before the handler
+   * is invoked.
+   *
+   * The default implementation buffers the body and hands it to the request
+   * handler as a single chunk.
+   *
+   * @param http_method The method of the operation.
+   * @param resource_path The resource path in REST format.
+   * @param handler The handler of the specific path.
+   * @return ExecutionResult
+   */
+  virtual ExecutionResult RegisterStreamingResourceHandler(
+      HttpMethod http_method, std::string& resource_path,
+      HttpStreamingHandler& handler) noexcept {
+    HttpHandler buffering_handler =
+        [handler](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+          auto request_handler = handler(*http_context.request);
+          const auto& body = http_context.request->body;
+          if (body.bytes && body.length > 0) {
+            auto execution_result =
+                request_handler.on_body_chunk(body.bytes->data(), body.length);
+            if (!execution_result.Successful()) {
+              return execution_result;
+            }
+          }
+          return request_handler.on_request(http_context);
+        };
+    return RegisterResourceHandler(http_method, resource_path,
+                                   buffering_handler);
+  }
 };
 }  // namespace google::scp::core
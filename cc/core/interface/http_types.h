@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <optional>
@@ -42,6 +43,8 @@ typedef std::multimap<std::string, std::string> HttpHeaders;
 
 struct AuthContext {
   std::shared_ptr<std::string> authorized_domain;
+  /// The time spent authorizing the request, 0 if unknown.
+  std::chrono::nanoseconds authorization_duration{0};
 };
 
 /// Http request object.
@@ -64,6 +67,13 @@ struct HttpRequest {
   BytesBuffer body;
   /// Represents the context of authentication and/or authorization.
   AuthContext auth_context;
+  /// The time to wait for the response of an attempt once it is sent, after
+  /// which its stream is cancelled and the attempt is retried. 0 waits up to
+  /// the read timeout of the connection.
+  TimeDuration timeout_in_ms = 0;
+  /// Whether sending the request more than once is harmless, which lets the
+  /// client hedge it.
+  bool is_idempotent = false;
 };
 
 /// Http response object.
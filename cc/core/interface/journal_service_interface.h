@@ -18,7 +18,9 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <unordered_set>
 
 #include "core/common/uuid/src/uuid.h"
 
@@ -78,12 +80,38 @@ struct JournalRecoverRequest {
   /// Should perform Recovery if there is only a checkpoint to be
   /// recovered in the stream but no journals to be recovered.
   bool should_perform_recovery_with_only_checkpoint_in_stream = true;
+  /// Should record which components the recovered logs belong to, e.g., for the
+  /// checkpoint service to only checkpoint the components that changed.
+  bool should_track_recovered_components = false;
+  /// If set, the recovery continues a previous one which processed the
+  /// journals up to this id. The checkpoint is not read and only the journals
+  /// after this one are recovered, e.g., to keep a standby of the partition in
+  /// sync with its journals.
+  std::optional<JournalId> resume_after_journal_id;
+  /// Should not recover the journals after the last one the last checkpoint
+  /// holds the logs of. The journals after it may be persisted out of order,
+  /// so a recovery still tailing the journals of a running partition would
+  /// otherwise skip the ones persisted late.
+  bool should_stop_at_last_checkpointed_journal = false;
+};
+
+/// The components the recovered logs belong to.
+struct JournalRecoveredComponents {
+  /// The components that had logs in the checkpoint.
+  std::unordered_set<common::Uuid, common::UuidHash> checkpoint_component_ids;
+  /// The components that had logs in the journals after the checkpoint.
+  std::unordered_set<common::Uuid, common::UuidHash> journal_component_ids;
 };
 
 /// Represents journal recovery response object.
 struct JournalRecoverResponse {
   /// The id of the last processed journal log.
   JournalId last_processed_journal_id = 0;
+  /// The id of the checkpoint the recovery started from, if any.
+  CheckpointId last_checkpoint_id = kInvalidCheckpointId;
+  /// The components of the recovered logs, only if the request asked to track
+  /// them.
+  std::shared_ptr<JournalRecoveredComponents> recovered_components;
 };
 
 /**
@@ -141,6 +169,27 @@ class JournalServiceInterface : public ServiceInterface {
       const common::Uuid& component_id,
       OnLogRecoveredCallback callback) noexcept = 0;
 
+  /**
+   * @brief Same as SubscribeForRecovery, for the components whose logs can be
+   * applied concurrently with the logs of the other components subscribed this
+   * way. The logs of a component are still applied one at a time and in order,
+   * and the logs of the components subscribed with SubscribeForRecovery are
+   * still applied after all the logs before them and before all the logs after
+   * them.
+   *
+   * The callback must only touch the state of its own component.
+   *
+   * @param component_id The component id, this must be unique between
+   * components.
+   * @param callback The callback in the case of existence of a recovery log.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult SubscribeForParallelRecovery(
+      const common::Uuid& component_id,
+      OnLogRecoveredCallback callback) noexcept {
+    return SubscribeForRecovery(component_id, callback);
+  }
+
   /**
    * @brief During the shutdown, all the components must unsubscribe from the
    * recovery operation to ensure clean transition to the shut down state.
@@ -162,6 +211,51 @@ class JournalServiceInterface : public ServiceInterface {
   virtual ExecutionResult GetLastPersistedJournalId(
       JournalId& journal_id) noexcept = 0;
 
+  /**
+   * @brief Returns the number of logs appended through Log() and the number
+   * of those whose callback was already invoked. The counts are equal when
+   * there is no log in flight.
+   *
+   * @param appended_log_count The number of appended logs.
+   * @param acknowledged_log_count The number of acknowledged logs.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult GetLogCounts(
+      size_t& appended_log_count, size_t& acknowledged_log_count) noexcept = 0;
+
+  /**
+   * @brief Returns the number of bytes of the logs appended through Log().
+   *
+   * @param appended_log_bytes The number of bytes of the appended logs.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult GetAppendedLogBytes(
+      size_t& appended_log_bytes) noexcept = 0;
+
+  /**
+   * @brief Pauses the flushing of the appended logs, and waits for the logs
+   * already flushed to be persisted and acknowledged. Until ResumeFlushing()
+   * is called, the logs keep being appended but none is acknowledged, so the
+   * state applied from the acknowledged logs is exactly the replay of the
+   * journals up to the returned one.
+   *
+   * @param max_wait_in_milliseconds The maximum time to wait for the flushed
+   * logs.
+   * @param last_persisted_journal_id The last persisted journal id to be set.
+   * @return ExecutionResult The execution result of the operation. On
+   * failure, the flushing is not paused.
+   */
+  virtual ExecutionResult PauseFlushing(
+      size_t max_wait_in_milliseconds,
+      JournalId& last_persisted_journal_id) noexcept = 0;
+
+  /**
+   * @brief Resumes the flushing paused by PauseFlushing().
+   *
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult ResumeFlushing() noexcept = 0;
+
   /**
    * @brief Run the recovery metrics without running the journal service
    * component. Since Recover() method maybe invoked even before the
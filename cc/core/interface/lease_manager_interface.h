@@ -273,6 +273,29 @@ class LeasableLockInterface {
   virtual bool IsCurrentLeaseOwner() const noexcept = 0;
 };
 
+/**
+ * @brief Refreshes the leases of several leasable locks at once, so that the
+ * reads and writes of their lease rows can be batched.
+ */
+class LeasableLockBatchRefresherInterface {
+ public:
+  virtual ~LeasableLockBatchRefresherInterface() = default;
+
+  /**
+   * @brief Refreshes the leases on all the locks, as if
+   * LeasableLockInterface::RefreshLease was invoked on each of them.
+   *
+   * @param leasable_locks the locks to refresh the lease on.
+   * @param is_read_only_lease_refresh for each lock, whether the lease should
+   * only be read without acquiring it.
+   * @return std::vector<ExecutionResult> the result of the refresh of each
+   * lock, in the order of the locks.
+   */
+  virtual std::vector<ExecutionResult> RefreshLeases(
+      const std::vector<std::shared_ptr<LeasableLockInterface>>& leasable_locks,
+      const std::vector<bool>& is_read_only_lease_refresh) noexcept = 0;
+};
+
 /**
  * @brief LeaseManagerInterface provides interface for lease acquisition and
  * maintenance.
@@ -77,6 +77,26 @@ struct GetDatabaseItemRequest : SingleDatabaseItemRequest {};
 /// Get database item response object.
 struct GetDatabaseItemResponse : SingleDatabaseItemResponse {};
 
+/// The max number of items in a batch get database items request, as the
+/// batched reads of DynamoDB are limited to 100 keys.
+static constexpr size_t kMaxBatchGetDatabaseItemsSize = 100;
+
+/// Batch get database items request object.
+struct BatchGetDatabaseItemsRequest {
+  /// The items to get. Every item is looked up as with GetDatabaseItem, but
+  /// filtering on attributes is not supported.
+  std::vector<std::shared_ptr<GetDatabaseItemRequest>> items;
+};
+
+/// Batch get database items response object.
+struct BatchGetDatabaseItemsResponse {
+  /// The results of the lookups, in the order of the requested items.
+  std::vector<ExecutionResult> item_results;
+  /// The found items, in the order of the requested items. Only set for the
+  /// lookups that succeeded.
+  std::vector<std::shared_ptr<GetDatabaseItemResponse>> items;
+};
+
 /// Upsert database item request object.
 struct UpsertDatabaseItemRequest : SingleDatabaseItemRequest {
   /// Attributes associated with the upsert record.
@@ -104,6 +124,19 @@ class NoSQLDatabaseProviderInterface : public ServiceInterface {
       AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
           get_database_item_context) noexcept = 0;
 
+  /**
+   * @brief Gets many database records in one round trip to the database. The
+   * operation succeeds as long as the round trip does, and the outcome of
+   * every lookup is in the item results of the response.
+   *
+   * @param batch_get_database_items_context The context object for the
+   * database operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult BatchGetDatabaseItems(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept = 0;
+
   /**
    * @brief Upserts a database record using provided metadta.
    *
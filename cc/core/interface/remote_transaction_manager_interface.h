@@ -42,6 +42,19 @@ class RemoteTransactionManagerInterface : public ServiceInterface {
       AsyncContext<GetTransactionStatusRequest, GetTransactionStatusResponse>&
           get_transaction_status_context) noexcept = 0;
 
+  /**
+   * @brief Inquires the status of many transactions of the same origin from
+   * the remote transaction engine at once.
+   *
+   * @param batch_get_transaction_status_context The batch get transaction
+   * status context.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult BatchGetTransactionStatus(
+      AsyncContext<BatchGetTransactionStatusRequest,
+                   BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept = 0;
+
   /**
    * @brief Executes the requested phase on the remote transaction engine.
    *
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/interface/async_context.h"
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "core/common/time_provider/src/time_provider.h"
+
+using google::scp::core::common::TimeProvider;
+using std::cout;
+using std::endl;
+using std::make_shared;
+using std::string;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+namespace google::scp::core::test {
+using TestContext = AsyncContext<string, string>;
+
+TEST(AsyncContextTest, MoveTakesOverTheRequestResponseAndCallback) {
+  bool called = false;
+  TestContext context(make_shared<string>("request"),
+                      [&](TestContext&) { called = true; });
+  context.response = make_shared<string>("response");
+  context.retry_count = 3;
+  auto activity_id = context.activity_id;
+  auto request = context.request;
+
+  TestContext moved_context(std::move(context));
+  EXPECT_EQ(moved_context.request, request);
+  EXPECT_EQ(request.use_count(), 2);
+  EXPECT_EQ(*moved_context.response, "response");
+  EXPECT_EQ(moved_context.activity_id, activity_id);
+  EXPECT_EQ(moved_context.retry_count, 3);
+
+  TestContext assigned_context;
+  assigned_context = std::move(moved_context);
+  EXPECT_EQ(request.use_count(), 2);
+  assigned_context.result = SuccessExecutionResult();
+  assigned_context.Finish();
+  EXPECT_TRUE(called);
+}
+
+TEST(AsyncContextTest, CopySharesTheRequest) {
+  TestContext context(make_shared<string>("request"), [](TestContext&) {});
+  TestContext copied_context(context);
+  EXPECT_EQ(copied_context.request, context.request);
+  EXPECT_EQ(context.request.use_count(), 2);
+}
+
+TEST(AsyncContextTest, PerfTestCopyAndMovePerHop) {
+  GTEST_SKIP();
+  constexpr size_t kHopCount = 10000000;
+  TestContext context(make_shared<string>("request"), [](TestContext&) {});
+  context.response = make_shared<string>("response");
+
+  // Each hop hands the context to the next stage, as a callback or a
+  // scheduled lambda capturing it would.
+  auto start_ns = TimeProvider::GetSteadyTimestampInNanoseconds();
+  for (size_t i = 0; i < kHopCount; ++i) {
+    TestContext next_context(context);
+    context = next_context;
+  }
+  auto end_ns = TimeProvider::GetSteadyTimestampInNanoseconds();
+  cout << static_cast<double>(
+              duration_cast<nanoseconds>(end_ns - start_ns).count()) /
+              kHopCount
+       << " nanoseconds per copied hop" << endl;
+
+  start_ns = TimeProvider::GetSteadyTimestampInNanoseconds();
+  for (size_t i = 0; i < kHopCount; ++i) {
+    TestContext next_context(std::move(context));
+    context = std::move(next_context);
+  }
+  end_ns = TimeProvider::GetSteadyTimestampInNanoseconds();
+  cout << static_cast<double>(
+              duration_cast<nanoseconds>(end_ns - start_ns).count()) /
+              kHopCount
+       << " nanoseconds per moved hop" << endl;
+  EXPECT_EQ(*context.request, "request");
+}
+}  // namespace google::scp::core::test
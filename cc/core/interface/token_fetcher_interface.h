@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <string>
+
 #include "core/interface/async_context.h"
 #include "core/interface/initializable_interface.h"
 
@@ -23,8 +25,12 @@ namespace google::scp::core {
 /**
  * @brief generic request object, can contain metadata useful for
  * fetching the token.
+ * @param audience audience the token is issued for, the default audience of
+ * the fetcher if empty
  */
-struct FetchTokenRequest {};
+struct FetchTokenRequest {
+  std::string audience;
+};
 
 /**
  * @brief generic response containing queried token and associated metadata
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "core/interface/service_interface.h"
 
@@ -34,6 +35,18 @@ class TokenProviderCacheInterface : public ServiceInterface {
    */
   virtual ExecutionResultOr<std::shared_ptr<Token>> GetToken() noexcept = 0;
 
+  /**
+   * @brief Get cached token for an audience other than the default one.
+   * The token is fetched and kept refreshed from the first call on, which
+   * fails until the token is fetched.
+   * @param audience the audience the token is issued for
+   * @return ExecutionResultOr<std::shared_ptr<Token>> token string
+   */
+  virtual ExecutionResultOr<std::shared_ptr<Token>> GetTokenForAudience(
+      const std::string& audience) noexcept {
+    return FailureExecutionResult(SC_UNKNOWN);
+  }
+
   virtual ~TokenProviderCacheInterface() = default;
 };
 
@@ -186,6 +186,38 @@ struct GetTransactionStatusResponse {
   bool has_failure = false;
 };
 
+/**
+ * @brief Represents the batch get transaction status request object, to
+ * inquire the status of many transactions of the same origin at once.
+ */
+struct BatchGetTransactionStatusRequest {
+  /// The transactions to inquire. Their origin is the one of the batch.
+  std::vector<GetTransactionStatusRequest> transactions;
+  /// The origin of the transactions aka domain name of the caller.
+  std::shared_ptr<std::string> transaction_origin;
+};
+
+/**
+ * @brief The status of one of the transactions of a batch get transaction
+ * status request.
+ */
+struct BatchGetTransactionStatusResult {
+  /// Id of the transaction.
+  core::common::Uuid transaction_id = {};
+  /// The result of the inquiry of this transaction, e.g. not found.
+  ExecutionResult result;
+  /// The status of the transaction, only set if the result is successful.
+  GetTransactionStatusResponse status;
+};
+
+/**
+ * @brief Represents the batch get transaction status response object.
+ */
+struct BatchGetTransactionStatusResponse {
+  /// The statuses, in the order of the transactions of the request.
+  std::vector<BatchGetTransactionStatusResult> results;
+};
+
 /**
  * @brief Represents the Request object of GetStatus API to get details of
  * Transaction Manager (TM) current state
@@ -241,6 +273,18 @@ class TransactionManagerInterface : public ServiceInterface {
   virtual ExecutionResult Checkpoint(
       std::shared_ptr<std::list<CheckpointLog>>& checkpoint_logs) noexcept = 0;
 
+  /**
+   * @brief Creates a checkpoint of the state of the running transaction
+   * manager. The state of a transaction may be ahead of its last journaled
+   * log, but its logs are retried until journaled and their replay is
+   * idempotent, so the checkpoint only needs its journal to be paused.
+   *
+   * @param checkpoint_logs The vector of checkpoint logs.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult CheckpointLive(
+      std::shared_ptr<std::list<CheckpointLog>>& checkpoint_logs) noexcept = 0;
+
   /**
    * @brief Inquires the transaction status.
    *
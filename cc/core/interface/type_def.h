@@ -45,6 +45,7 @@ static constexpr TimeDuration kDefaultAggregatedMetricIntervalMs = 1000;
 /// This structure allows callers to consume partial prefix bytes as specified
 /// by the 'length' field. If 'length' and 'capacity' are the same, this is the
 /// default case and the full buffer will be used.
+/// common::ByteSlice shares parts of a buffer without copying them.
 struct BytesBuffer {
   BytesBuffer() : BytesBuffer(0) {}
 
@@ -67,21 +68,6 @@ struct BytesBuffer {
     length = bytes->size();
   }
 
-  /**
-   * @brief Construct a new Bytes Buffer object with only a certain prefix of
-   * the buffer to be used
-   *
-   * @param bytes_buffer
-   * @param prefix_length_to_use
-   */
-  explicit BytesBuffer(const std::shared_ptr<BytesBuffer>& bytes_buffer,
-                       size_t prefix_length_to_use) {
-    bytes = bytes_buffer->bytes;
-    length = prefix_length_to_use;
-    capacity = bytes_buffer->capacity;
-    assert(prefix_length_to_use <= capacity);
-  }
-
   inline std::string ToString() const {
     return std::string(bytes->data(), length);
   }
@@ -138,6 +124,7 @@ static constexpr TimeDuration kDefaultRetryStrategyDelayInMs = 101;
 
 // The default config value for HttpClientOptions
 static constexpr size_t kDefaultMaxConnectionsPerHost = 2;
+static constexpr size_t kDefaultScaleUpActiveRequestsPerConnection = 100;
 static constexpr TimeDuration kDefaultHttp2ReadTimeoutInSeconds = 60;
 
 // Metrics
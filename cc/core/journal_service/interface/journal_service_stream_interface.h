@@ -18,6 +18,7 @@
 
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "core/common/uuid/src/uuid.h"
@@ -35,6 +36,8 @@ struct JournalStreamReadLogObject {
   common::Uuid log_id;
   /// Status of the log.
   JournalLogStatus log_status;
+  /// Whether the log was read from the checkpoint rather than a journal.
+  bool is_checkpoint_log = false;
   /// Retrieved log from the log stream.
   std::shared_ptr<journal_service::JournalLog> journal_log;
   /// Journal ID of the journal where the log originated from.
@@ -61,6 +64,13 @@ struct JournalStreamReadLogRequest {
   /// Should perform log reads if there is just only a checkpoint to be
   /// read but no journals to be read in the log stream.
   bool should_read_stream_when_only_checkpoint_exists = true;
+  /// If set, the checkpoint is not read and only the journals after this one
+  /// are read. See JournalRecoverRequest.
+  std::optional<JournalId> resume_after_journal_id;
+  /// Should not read the journals after the last one the last checkpoint holds
+  /// the logs of. The last checkpoint metadata is then read even if the read is
+  /// resumed. See JournalRecoverRequest.
+  bool should_stop_at_last_checkpointed_journal = false;
 };
 
 /// Represents the journal stream read response object.
@@ -77,8 +87,14 @@ struct JournalStreamAppendLogRequest {
   common::Uuid log_id;
   /// Status of the log.
   JournalLogStatus log_status;
+  /// Whether the log was read from the checkpoint rather than a journal.
+  bool is_checkpoint_log = false;
   /// Log to be appended to the log stream.
   std::shared_ptr<journal_service::JournalLog> journal_log;
+  /// Optional body of the log. When set, it is written to the log stream as
+  /// the log body of journal_log without being copied into it first, and the
+  /// log body of journal_log must be empty.
+  std::shared_ptr<BytesBuffer> log_body;
 };
 
 /// Represents the journal stream append response.
@@ -149,5 +165,23 @@ class JournalOutputStreamInterface {
    * @return ExecutionResult The execution result of the operation.
    */
   virtual ExecutionResult FlushLogs() noexcept = 0;
+
+  /**
+   * @brief Stops the writes done in the background of the acknowledged logs,
+   * and waits for the ones in flight. No log is written afterwards.
+   *
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult StopBackgroundWrites() noexcept = 0;
+
+  /**
+   * @brief Returns the number of the flushed batches of logs that are not
+   * both persisted and acknowledged yet.
+   *
+   * @param batch_count The number of batches to be set.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult GetUnpersistedBatchCount(
+      size_t& batch_count) noexcept = 0;
 };
 }  // namespace google::scp::core::journal_service
@@ -314,6 +314,10 @@ class MockJournalInputStream : public core::JournalInputStream {
 
   const JournalId& GetLastCheckpointId() { return last_checkpoint_id_; }
 
+  void SetLastCheckpointId(CheckpointId checkpoint_id) {
+    last_checkpoint_id_ = checkpoint_id;
+  }
+
   std::atomic<size_t>& GetTotalJournalsToRead() {
     return total_journals_to_read_;
   }
@@ -37,11 +37,18 @@ class MockJournalOutputStream : public core::JournalOutputStream {
       const std::shared_ptr<AsyncExecutorInterface>& async_executor,
       const std::shared_ptr<BlobStorageClientInterface>&
           blob_storage_provider_client,
-      std::shared_ptr<core::MetricRouter> metric_router)
-      : core::JournalOutputStream(bucket_name, partition_name, async_executor,
-                                  blob_storage_provider_client,
-                                  std::make_shared<cpio::MockAggregateMetric>(),
-                                  metric_router) {}
+      std::shared_ptr<core::MetricRouter> metric_router,
+      size_t max_concurrent_blob_writes =
+          kDefaultJournalMaxConcurrentBlobWrites,
+      size_t blob_compression_level = kJournalBlobCompressionDisabled,
+      const std::shared_ptr<JournalLocalWriteAheadLog>& local_write_ahead_log =
+          nullptr)
+      : core::JournalOutputStream(
+            bucket_name, partition_name, async_executor,
+            blob_storage_provider_client,
+            std::make_shared<cpio::MockAggregateMetric>(), metric_router,
+            max_concurrent_blob_writes, blob_compression_level,
+            local_write_ahead_log) {}
 
   std::function<ExecutionResult(
       AsyncContext<journal_service::JournalStreamAppendLogRequest,
@@ -159,5 +166,9 @@ class MockJournalOutputStream : public core::JournalOutputStream {
   auto& GetPendingLogsCount() { return pending_logs_; }
 
   auto& GetPendingLogs() { return logs_queue_; }
+
+  auto& GetUnbatchedLogs() { return unbatched_logs_; }
+
+  using core::JournalOutputStream::AcquireBlobBuffer;
 };
 }  // namespace google::scp::core::journal_service::mock
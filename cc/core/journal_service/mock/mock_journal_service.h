@@ -32,10 +32,50 @@ class MockJournalService : public JournalServiceInterface {
 
   ExecutionResult GetLastPersistedJournalId(
       JournalId& journal_id) noexcept override {
+    if (get_last_persisted_journal_id_mock) {
+      return get_last_persisted_journal_id_mock(journal_id);
+    }
     journal_id = 0;
     return SuccessExecutionResult();
   }
 
+  ExecutionResult GetLogCounts(
+      size_t& appended_log_count,
+      size_t& acknowledged_log_count) noexcept override {
+    if (get_log_counts_mock) {
+      return get_log_counts_mock(appended_log_count, acknowledged_log_count);
+    }
+    appended_log_count = 0;
+    acknowledged_log_count = 0;
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult GetAppendedLogBytes(
+      size_t& appended_log_bytes) noexcept override {
+    if (get_appended_log_bytes_mock) {
+      return get_appended_log_bytes_mock(appended_log_bytes);
+    }
+    appended_log_bytes = 0;
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult PauseFlushing(
+      size_t max_wait_in_milliseconds,
+      JournalId& last_persisted_journal_id) noexcept override {
+    if (pause_flushing_mock) {
+      return pause_flushing_mock(max_wait_in_milliseconds,
+                                 last_persisted_journal_id);
+    }
+    return GetLastPersistedJournalId(last_persisted_journal_id);
+  }
+
+  ExecutionResult ResumeFlushing() noexcept override {
+    if (resume_flushing_mock) {
+      return resume_flushing_mock();
+    }
+    return SuccessExecutionResult();
+  }
+
   ExecutionResult Log(AsyncContext<JournalLogRequest, JournalLogResponse>&
                           log_context) noexcept override {
     if (log_mock) {
@@ -84,5 +124,15 @@ class MockJournalService : public JournalServiceInterface {
   std::function<ExecutionResult(
       AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&)>
       recover_mock;
+
+  std::function<ExecutionResult(JournalId&)> get_last_persisted_journal_id_mock;
+
+  std::function<ExecutionResult(size_t&, size_t&)> get_log_counts_mock;
+
+  std::function<ExecutionResult(size_t&)> get_appended_log_bytes_mock;
+
+  std::function<ExecutionResult(size_t, JournalId&)> pause_flushing_mock;
+
+  std::function<ExecutionResult()> resume_flushing_mock;
 };
 }  // namespace google::scp::core::journal_service::mock
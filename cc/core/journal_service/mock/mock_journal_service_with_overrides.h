@@ -79,6 +79,21 @@ class MockJournalServiceWithOverrides : public JournalService {
     return subscribers_map_;
   }
 
+  void EnableStreamingReplay(size_t recovery_dedup_window_in_seconds) {
+    enable_streaming_replay_ = true;
+    recovery_dedup_window_in_seconds_ = recovery_dedup_window_in_seconds;
+  }
+
+  void TrackRecoveredComponents() {
+    recovered_components_ = std::make_shared<JournalRecoveredComponents>();
+  }
+
+  std::shared_ptr<JournalRecoveredComponents> GetRecoveredComponents() {
+    return recovered_components_;
+  }
+
+  CheckpointId GetRecoveredCheckpointId() { return recovered_checkpoint_id_; }
+
   virtual void OnJournalStreamReadLogCallback(
       std::shared_ptr<cpio::TimeEvent>& time_event,
       std::shared_ptr<std::unordered_set<std::string>>& replayed_logs,
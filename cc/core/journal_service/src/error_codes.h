@@ -112,4 +112,64 @@ DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_FAILED_TO_FLUSH_BATCH_OF_LOGS,
                   "The batch of logs to flush failed.",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
 
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_BLOB_COMPRESSION_FAILED,
+                  SC_JOURNAL_SERVICE, 0x0015,
+                  "The journal blob could not be compressed.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB,
+                  SC_JOURNAL_SERVICE, 0x0016,
+                  "The compressed journal blob is corrupted.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_CHECKPOINT_CHAIN,
+                  SC_JOURNAL_SERVICE, 0x0017,
+                  "The chain of delta checkpoints is invalid.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_CHECKPOINT_SHARDS,
+                  SC_JOURNAL_SERVICE, 0x0018,
+                  "The shards of the checkpoint are incomplete.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_INIT_FAILED,
+                  SC_JOURNAL_SERVICE, 0x0019,
+                  "The local write-ahead log cannot be initialized.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_WRITE_FAILED,
+                  SC_JOURNAL_SERVICE, 0x001A,
+                  "The journal cannot be written to the local write-ahead log.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_READ_FAILED,
+                  SC_JOURNAL_SERVICE, 0x001B,
+                  "The journal cannot be read from the local write-ahead log.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_JOURNAL_SEGMENT,
+                  SC_JOURNAL_SERVICE, 0x001C,
+                  "A journal segment covers the last processed journal.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_INPUT_STREAM_NO_CHECKPOINTED_JOURNAL,
+                  SC_JOURNAL_SERVICE, 0x001D,
+                  "The last checkpoint metadata has no last processed journal.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_FLUSHING_ALREADY_PAUSED,
+                  SC_JOURNAL_SERVICE, 0x001E,
+                  "The flushing of the journal service is already paused.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_FLUSHING_NOT_PAUSED,
+                  SC_JOURNAL_SERVICE, 0x001F,
+                  "The flushing of the journal service is not paused.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_JOURNAL_SERVICE_FLUSHED_LOGS_NOT_PERSISTED,
+                  SC_JOURNAL_SERVICE, 0x0020,
+                  "The flushed logs were not persisted in time.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
+
 }  // namespace google::scp::core::errors
@@ -0,0 +1,440 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "journal_compactor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/blob_storage_provider/src/common/error_codes.h"
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/interface/async_context.h"
+
+#include "error_codes.h"
+#include "journal_serialization.h"
+#include "journal_utils.h"
+
+using google::scp::core::journal_service::JournalSegment;
+using google::scp::core::journal_service::JournalSegmentManifest;
+using google::scp::core::journal_service::JournalSerialization;
+using google::scp::core::journal_service::JournalUtils;
+using std::make_shared;
+using std::promise;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::hours;
+using std::chrono::nanoseconds;
+
+namespace {
+constexpr char kJournalCompactor[] = "JournalCompactor";
+// The segments ending this long before the journals compacted are removed
+// from the manifest. The journal ids are wall clock timestamps in nanoseconds,
+// and the readers of the partition are expected to be well past them.
+constexpr hours kSegmentManifestRetention(1);
+}  // namespace
+
+namespace google::scp::core {
+JournalCompactor::JournalCompactor(
+    const shared_ptr<string>& bucket_name,
+    const shared_ptr<string>& partition_name,
+    const shared_ptr<BlobStorageClientInterface>& blob_storage_client,
+    size_t journals_per_segment, size_t blob_compression_level,
+    const common::Uuid& activity_id)
+    : bucket_name_(bucket_name),
+      partition_name_(partition_name),
+      blob_storage_client_(blob_storage_client),
+      journals_per_segment_(std::max<size_t>(journals_per_segment, 1)),
+      blob_compression_level_(blob_compression_level),
+      activity_id_(activity_id) {}
+
+ExecutionResult JournalCompactor::Compact(
+    JournalId after_journal_id, JournalId max_journal_id,
+    size_t& compacted_journal_count) noexcept {
+  compacted_journal_count = 0;
+  if (max_journal_id <= after_journal_id) {
+    return SuccessExecutionResult();
+  }
+
+  JournalSegmentManifest manifest;
+  auto execution_result = ReadManifest(manifest);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  JournalId min_retained_journal_id = 0;
+  auto retention = duration_cast<nanoseconds>(kSegmentManifestRetention);
+  if (after_journal_id > static_cast<JournalId>(retention.count())) {
+    min_retained_journal_id = after_journal_id - retention.count();
+  }
+  bool is_manifest_changed = false;
+  JournalSegmentManifest retained_manifest;
+  for (const auto& segment : manifest.segments()) {
+    if (segment.last_journal_id() < min_retained_journal_id) {
+      is_manifest_changed = true;
+      continue;
+    }
+    *retained_manifest.add_segments() = segment;
+  }
+
+  vector<JournalId> journal_ids;
+  execution_result =
+      ListJournalIds(after_journal_id, max_journal_id, journal_ids);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  // The journal blobs left over by a compaction interrupted after writing the
+  // manifest.
+  vector<JournalId> compacted_journal_ids;
+  vector<JournalId> uncompacted_journal_ids;
+  for (auto journal_id : journal_ids) {
+    auto is_compacted = std::any_of(
+        retained_manifest.segments().begin(),
+        retained_manifest.segments().end(),
+        [journal_id](const JournalSegment& segment) {
+          return segment.first_journal_id() <= journal_id &&
+                 journal_id <= segment.last_journal_id();
+        });
+    if (is_compacted) {
+      compacted_journal_ids.push_back(journal_id);
+    } else {
+      uncompacted_journal_ids.push_back(journal_id);
+    }
+  }
+
+  // Only full segments are written, the journals left over are compacted with
+  // the ones written after them.
+  auto segment_count = uncompacted_journal_ids.size() / journals_per_segment_;
+  for (size_t i = 0; i < segment_count; ++i) {
+    vector<JournalId> segment_journal_ids(
+        uncompacted_journal_ids.begin() + i * journals_per_segment_,
+        uncompacted_journal_ids.begin() + (i + 1) * journals_per_segment_);
+    execution_result = WriteSegment(segment_journal_ids);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    auto* segment = retained_manifest.add_segments();
+    segment->set_first_journal_id(segment_journal_ids.front());
+    segment->set_last_journal_id(segment_journal_ids.back());
+    compacted_journal_ids.insert(compacted_journal_ids.end(),
+                                 segment_journal_ids.begin(),
+                                 segment_journal_ids.end());
+    is_manifest_changed = true;
+  }
+
+  if (is_manifest_changed) {
+    size_t byte_size = 0;
+    execution_result = JournalSerialization::CalculateSerializationByteSize(
+        retained_manifest, byte_size);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    auto manifest_buffer = make_shared<BytesBuffer>(byte_size);
+    size_t bytes_serialized = 0;
+    execution_result = JournalSerialization::SerializeJournalSegmentManifest(
+        *manifest_buffer, 0, retained_manifest, bytes_serialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    manifest_buffer->length = bytes_serialized;
+
+    shared_ptr<string> manifest_blob_name;
+    execution_result = JournalUtils::GetBlobFullPath(
+        partition_name_, make_shared<string>(kJournalSegmentManifestBlobName),
+        manifest_blob_name);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    execution_result = PutBlob(manifest_blob_name, manifest_buffer);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+
+  // The journal blobs are only deleted once the manifest has their segments.
+  execution_result = DeleteJournalBlobs(compacted_journal_ids);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  compacted_journal_count = segment_count * journals_per_segment_;
+  SCP_INFO(kJournalCompactor, activity_id_,
+           "Compacted %zu journals into %zu segments, and deleted %zu journal "
+           "blobs. The manifest has %d segments.",
+           compacted_journal_count, segment_count, compacted_journal_ids.size(),
+           retained_manifest.segments_size());
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalCompactor::ReadManifest(
+    JournalSegmentManifest& manifest) noexcept {
+  manifest.Clear();
+  shared_ptr<string> manifest_blob_name;
+  auto execution_result = JournalUtils::GetBlobFullPath(
+      partition_name_, make_shared<string>(kJournalSegmentManifestBlobName),
+      manifest_blob_name);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  shared_ptr<BytesBuffer> manifest_buffer;
+  execution_result = GetBlob(manifest_blob_name, manifest_buffer);
+  if (execution_result ==
+      FailureExecutionResult(
+          errors::SC_BLOB_STORAGE_PROVIDER_BLOB_PATH_NOT_FOUND)) {
+    // No journal was compacted yet.
+    return SuccessExecutionResult();
+  }
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  size_t bytes_deserialized = 0;
+  return JournalSerialization::DeserializeJournalSegmentManifest(
+      *manifest_buffer, 0, manifest, bytes_deserialized);
+}
+
+ExecutionResult JournalCompactor::ListJournalIds(
+    JournalId after_journal_id, JournalId max_journal_id,
+    vector<JournalId>& journal_ids) noexcept {
+  journal_ids.clear();
+  shared_ptr<string> marker;
+  auto execution_result = JournalUtils::CreateJournalBlobName(
+      partition_name_, after_journal_id, marker);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  while (marker) {
+    AsyncContext<ListBlobsRequest, ListBlobsResponse> list_blobs_context;
+    list_blobs_context.parent_activity_id = activity_id_;
+    list_blobs_context.correlation_id = activity_id_;
+    list_blobs_context.request = make_shared<ListBlobsRequest>();
+    list_blobs_context.request->bucket_name = bucket_name_;
+    list_blobs_context.request->marker = marker;
+    execution_result = JournalUtils::GetBlobFullPath(
+        partition_name_, make_shared<string>(kJournalBlobNamePrefix),
+        list_blobs_context.request->blob_name);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    promise<ExecutionResult> list_blobs_execution_result;
+    list_blobs_context.callback =
+        [&](AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+                list_blobs_context) {
+          list_blobs_execution_result.set_value(list_blobs_context.result);
+        };
+    execution_result = blob_storage_client_->ListBlobs(list_blobs_context);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    execution_result = list_blobs_execution_result.get_future().get();
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    marker = nullptr;
+    const auto& response = *list_blobs_context.response;
+    if (!response.blobs || response.blobs->empty()) {
+      break;
+    }
+    for (const auto& blob : *response.blobs) {
+      JournalId journal_id = 0;
+      execution_result = JournalUtils::ExtractJournalId(
+          partition_name_, blob.blob_name, journal_id);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+      if (journal_id <= after_journal_id) {
+        continue;
+      }
+      if (journal_id > max_journal_id) {
+        return SuccessExecutionResult();
+      }
+      journal_ids.push_back(journal_id);
+    }
+
+    if (response.next_marker && response.next_marker->blob_name &&
+        !response.next_marker->blob_name->empty()) {
+      marker = response.next_marker->blob_name;
+    } else if (!response.is_last_page) {
+      marker = response.blobs->back().blob_name;
+    }
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalCompactor::WriteSegment(
+    const vector<JournalId>& journal_ids) noexcept {
+  vector<shared_ptr<BytesBuffer>> journal_buffers;
+  size_t segment_length = 0;
+  for (auto journal_id : journal_ids) {
+    shared_ptr<string> journal_blob_name;
+    auto execution_result = JournalUtils::CreateJournalBlobName(
+        partition_name_, journal_id, journal_blob_name);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    shared_ptr<BytesBuffer> journal_buffer;
+    execution_result = GetBlob(journal_blob_name, journal_buffer);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    if (JournalSerialization::IsCompressedJournalBlob(*journal_buffer)) {
+      auto uncompressed_buffer = make_shared<BytesBuffer>();
+      execution_result = JournalSerialization::DecompressJournalBlob(
+          *journal_buffer, *uncompressed_buffer);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+      journal_buffer = uncompressed_buffer;
+    }
+    segment_length += journal_buffer->length;
+    journal_buffers.push_back(journal_buffer);
+  }
+
+  // The segment is read like a single journal blob with the logs of all the
+  // journals.
+  auto segment_buffer = make_shared<BytesBuffer>(segment_length);
+  for (const auto& journal_buffer : journal_buffers) {
+    if (journal_buffer->length > 0) {
+      std::memcpy(segment_buffer->bytes->data() + segment_buffer->length,
+                  journal_buffer->bytes->data(), journal_buffer->length);
+    }
+    segment_buffer->length += journal_buffer->length;
+  }
+
+  if (blob_compression_level_ > 0) {
+    auto compressed_buffer = make_shared<BytesBuffer>(
+        JournalSerialization::CalculateMaxCompressedJournalBlobByteSize(
+            segment_buffer->length));
+    auto execution_result = JournalSerialization::CompressJournalBlob(
+        *segment_buffer, *compressed_buffer, blob_compression_level_);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    segment_buffer = compressed_buffer;
+  }
+
+  shared_ptr<string> segment_blob_name;
+  auto execution_result = JournalUtils::CreateJournalSegmentBlobName(
+      partition_name_, journal_ids.back(), segment_blob_name);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  return PutBlob(segment_blob_name, segment_buffer);
+}
+
+ExecutionResult JournalCompactor::GetBlob(
+    const shared_ptr<string>& blob_name,
+    shared_ptr<BytesBuffer>& bytes_buffer) noexcept {
+  AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context;
+  get_blob_context.parent_activity_id = activity_id_;
+  get_blob_context.correlation_id = activity_id_;
+  get_blob_context.request = make_shared<GetBlobRequest>();
+  get_blob_context.request->bucket_name = bucket_name_;
+  get_blob_context.request->blob_name = blob_name;
+
+  promise<ExecutionResult> get_blob_execution_result;
+  get_blob_context.callback =
+      [&](AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) {
+        get_blob_execution_result.set_value(get_blob_context.result);
+      };
+  auto execution_result = blob_storage_client_->GetBlob(get_blob_context);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  execution_result = get_blob_execution_result.get_future().get();
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  bytes_buffer = get_blob_context.response->buffer;
+  if (!bytes_buffer) {
+    bytes_buffer = make_shared<BytesBuffer>();
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalCompactor::PutBlob(
+    const shared_ptr<string>& blob_name,
+    const shared_ptr<BytesBuffer>& bytes_buffer) noexcept {
+  AsyncContext<PutBlobRequest, PutBlobResponse> put_blob_context;
+  put_blob_context.parent_activity_id = activity_id_;
+  put_blob_context.correlation_id = activity_id_;
+  put_blob_context.request = make_shared<PutBlobRequest>();
+  put_blob_context.request->bucket_name = bucket_name_;
+  put_blob_context.request->blob_name = blob_name;
+  put_blob_context.request->buffer = bytes_buffer;
+
+  promise<ExecutionResult> put_blob_execution_result;
+  put_blob_context.callback =
+      [&](AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) {
+        put_blob_execution_result.set_value(put_blob_context.result);
+      };
+  auto execution_result = blob_storage_client_->PutBlob(put_blob_context);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  return put_blob_execution_result.get_future().get();
+}
+
+ExecutionResult JournalCompactor::DeleteJournalBlobs(
+    const vector<JournalId>& journal_ids) noexcept {
+  for (auto journal_id : journal_ids) {
+    AsyncContext<DeleteBlobRequest, DeleteBlobResponse> delete_blob_context;
+    delete_blob_context.parent_activity_id = activity_id_;
+    delete_blob_context.correlation_id = activity_id_;
+    delete_blob_context.request = make_shared<DeleteBlobRequest>();
+    delete_blob_context.request->bucket_name = bucket_name_;
+    auto execution_result = JournalUtils::CreateJournalBlobName(
+        partition_name_, journal_id, delete_blob_context.request->blob_name);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    promise<ExecutionResult> delete_blob_execution_result;
+    delete_blob_context.callback =
+        [&](AsyncContext<DeleteBlobRequest, DeleteBlobResponse>&
+                delete_blob_context) {
+          delete_blob_execution_result.set_value(delete_blob_context.result);
+        };
+    execution_result = blob_storage_client_->DeleteBlob(delete_blob_context);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    execution_result = delete_blob_execution_result.get_future().get();
+    if (!execution_result.Successful() &&
+        execution_result !=
+            FailureExecutionResult(
+                errors::SC_BLOB_STORAGE_PROVIDER_BLOB_PATH_NOT_FOUND)) {
+      return execution_result;
+    }
+  }
+  return SuccessExecutionResult();
+}
+}  // namespace google::scp::core
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/uuid/src/uuid.h"
+#include "core/interface/blob_storage_provider_interface.h"
+#include "core/interface/type_def.h"
+#include "core/journal_service/src/proto/journal_service.pb.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core {
+/**
+ * @brief Compacts the journal blobs of a partition into segment blobs, each
+ * holding the journal blobs of consecutive journals, so that a recovery gets
+ * far fewer blobs.
+ *
+ * The segments are recorded in the segment manifest blob of the partition. A
+ * segment is written, then the manifest, and only then the journal blobs it
+ * holds are deleted. A recovery that lists the journal blobs before reading the
+ * manifest therefore always finds each journal in a blob, see
+ * kPBSJournalServiceEnableJournalCompaction.
+ *
+ * The calls block until the blob storage operations are done, and must not
+ * overlap.
+ */
+class JournalCompactor {
+ public:
+  /**
+   * @brief Constructs the compactor.
+   *
+   * @param bucket_name The bucket of the journal blobs.
+   * @param partition_name The partition of the journal blobs.
+   * @param blob_storage_client The blob storage client.
+   * @param journals_per_segment The number of journals of each segment.
+   * @param blob_compression_level The zlib compression level of the segments,
+   * 0 for uncompressed segments.
+   * @param activity_id The activity id of the blob storage operations.
+   */
+  JournalCompactor(
+      const std::shared_ptr<std::string>& bucket_name,
+      const std::shared_ptr<std::string>& partition_name,
+      const std::shared_ptr<BlobStorageClientInterface>& blob_storage_client,
+      size_t journals_per_segment, size_t blob_compression_level,
+      const common::Uuid& activity_id);
+
+  /**
+   * @brief Compacts the journals after a journal id, up to a max journal id,
+   * into full segments. The journals left over are compacted by a later call.
+   *
+   * @param after_journal_id The journals up to this id are not compacted. The
+   * segments that end well before it are removed from the manifest.
+   * @param max_journal_id The id of the last journal that can be compacted.
+   * All the journals up to it must have been written.
+   * @param compacted_journal_count Set to the number of journals compacted.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Compact(JournalId after_journal_id, JournalId max_journal_id,
+                          size_t& compacted_journal_count) noexcept;
+
+ protected:
+  /// Reads the manifest, which is empty if there is no manifest blob.
+  ExecutionResult ReadManifest(
+      journal_service::JournalSegmentManifest& manifest) noexcept;
+
+  /// Lists the ids of the journal blobs in (after_journal_id, max_journal_id],
+  /// in ascending order.
+  ExecutionResult ListJournalIds(JournalId after_journal_id,
+                                 JournalId max_journal_id,
+                                 std::vector<JournalId>& journal_ids) noexcept;
+
+  /// Writes the segment of the journals, in order.
+  ExecutionResult WriteSegment(
+      const std::vector<JournalId>& journal_ids) noexcept;
+
+  /// Reads a blob into the bytes buffer.
+  ExecutionResult GetBlob(const std::shared_ptr<std::string>& blob_name,
+                          std::shared_ptr<BytesBuffer>& bytes_buffer) noexcept;
+
+  /// Writes the bytes buffer to a blob.
+  ExecutionResult PutBlob(
+      const std::shared_ptr<std::string>& blob_name,
+      const std::shared_ptr<BytesBuffer>& bytes_buffer) noexcept;
+
+  /// Deletes the blobs of journals. Deleting a missing blob succeeds.
+  ExecutionResult DeleteJournalBlobs(
+      const std::vector<JournalId>& journal_ids) noexcept;
+
+  /// The bucket of the journal blobs.
+  const std::shared_ptr<std::string> bucket_name_;
+  /// The partition of the journal blobs.
+  const std::shared_ptr<std::string> partition_name_;
+  /// The blob storage client.
+  const std::shared_ptr<BlobStorageClientInterface> blob_storage_client_;
+  /// The number of journals of each segment.
+  const size_t journals_per_segment_;
+  /// The zlib compression level of the segments.
+  const size_t blob_compression_level_;
+  /// The activity id of the blob storage operations.
+  const common::Uuid activity_id_;
+};
+}  // namespace google::scp::core
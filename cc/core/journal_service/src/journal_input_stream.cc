@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <atomic>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <set>
@@ -28,6 +29,8 @@
 
 #include "absl/strings/str_join.h"
 #include "core/blob_storage_provider/src/common/error_codes.h"
+#include "core/common/byte_slice/src/byte_slice.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/interface/type_def.h"
 #include "core/journal_service/interface/journal_service_stream_interface.h"
 #include "core/journal_service/src/journal_serialization.h"
@@ -37,9 +40,12 @@
 
 namespace google::scp::core {
 
+using ::google::scp::core::common::ByteSlice;
+using ::google::scp::core::common::TimeProvider;
 using ::google::scp::core::common::Uuid;
 using ::google::scp::core::journal_service::CheckpointMetadata;
 using ::google::scp::core::journal_service::JournalLog;
+using ::google::scp::core::journal_service::JournalSegmentManifest;
 using ::google::scp::core::journal_service::JournalSerialization;
 using ::google::scp::core::journal_service::JournalStreamReadLogObject;
 using ::google::scp::core::journal_service::JournalStreamReadLogRequest;
@@ -51,6 +57,7 @@ using ::std::bind;
 using ::std::list;
 using ::std::make_shared;
 using ::std::max_element;
+using ::std::min;
 using ::std::move;
 using ::std::set;
 using ::std::shared_ptr;
@@ -80,6 +87,28 @@ static void FinishContextWithResponse(
   FinishContext(SuccessExecutionResult(), context);
 }
 
+/**
+ * @brief Returns the blob to list the page after the supplied one from, or
+ * nullptr if the page is the last one.
+ *
+ * @param list_blobs_response The response of the listing of the page.
+ */
+static shared_ptr<Blob> GetNextListingMarker(
+    const ListBlobsResponse& list_blobs_response) {
+  if (list_blobs_response.next_marker &&
+      list_blobs_response.next_marker->blob_name &&
+      !list_blobs_response.next_marker->blob_name->empty()) {
+    return list_blobs_response.next_marker;
+  }
+  // Unless the provider knows the page is the last one, do one more listing
+  // to be sure that there are no more remaining.
+  if (!list_blobs_response.is_last_page && list_blobs_response.blobs &&
+      !list_blobs_response.blobs->empty()) {
+    return make_shared<Blob>(list_blobs_response.blobs->back());
+  }
+  return nullptr;
+}
+
 bool JournalInputStream::IsJournalBuffersLoadedButNotProcessedYet() {
   return !journal_buffers_.empty() &&
          current_buffer_index_ < journal_buffers_.size();
@@ -136,6 +165,14 @@ ExecutionResult JournalInputStream::ReadLog(
   bool loaded =
       enable_batch_read_journals_ ? journal_ids_loaded_ : journals_loaded_;
   if (!loaded) {
+    // A resumed read already has the state of the checkpoint and the journals
+    // up to the given one, it only lists the journals after it. The last
+    // checkpoint metadata may still bound the journals to read.
+    const auto& request = *journal_stream_read_log_context.request;
+    if (request.resume_after_journal_id.has_value() &&
+        !request.should_stop_at_last_checkpointed_journal) {
+      return ResumeRead(journal_stream_read_log_context);
+    }
     // Kick start Step 1
     return ReadLastCheckpointBlob(journal_stream_read_log_context);
   }
@@ -176,6 +213,10 @@ ExecutionResult JournalInputStream::ReadLog(
     return FailureExecutionResult(
         errors::SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_LISTING);
   }
+  // The next batch may already be in memory, or on its way.
+  if (prefetched_journals_count_ > 0) {
+    return ProcessPrefetchedJournals(journal_stream_read_log_context);
+  }
   if (auto execution_result =
           ReadJournalBlobs(journal_stream_read_log_context, journal_ids_);
       !execution_result.Successful()) {
@@ -226,7 +267,20 @@ void JournalInputStream::OnReadLastCheckpointBlobCallback(
     last_checkpoint_found = false;
   }
 
+  auto& request = journal_stream_read_log_context.request;
+  bool should_stop_at_last_checkpointed_journal =
+      request && request->should_stop_at_last_checkpointed_journal;
   if (!last_checkpoint_found) {
+    if (should_stop_at_last_checkpointed_journal) {
+      auto execution_result = FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_INPUT_STREAM_NO_CHECKPOINTED_JOURNAL);
+      SCP_ERROR_CONTEXT(kJournalInputStream, get_blob_context,
+                        execution_result,
+                        "The last checkpoint blob was not found, no journal "
+                        "can be read.");
+      return FinishContext(execution_result, journal_stream_read_log_context);
+    }
+
     SCP_DEBUG_CONTEXT(kJournalInputStream, get_blob_context,
                       "The last checkpoint blob was not found, listing from "
                       "the beginning.");
@@ -254,8 +308,38 @@ void JournalInputStream::OnReadLastCheckpointBlobCallback(
     return FinishContext(execution_result, journal_stream_read_log_context);
   }
 
+  if (should_stop_at_last_checkpointed_journal) {
+    auto last_checkpointed_journal_id =
+        last_checkpoint_metadata.last_processed_journal_id();
+    if (last_checkpointed_journal_id == kInvalidJournalId) {
+      execution_result = FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_INPUT_STREAM_NO_CHECKPOINTED_JOURNAL);
+      SCP_ERROR_CONTEXT(kJournalInputStream, get_blob_context,
+                        execution_result,
+                        "The last checkpoint metadata has no last processed "
+                        "journal, no journal can be read.");
+      return FinishContext(execution_result, journal_stream_read_log_context);
+    }
+    request->max_journal_id_to_process = min<JournalId>(
+        request->max_journal_id_to_process, last_checkpointed_journal_id);
+    SCP_INFO_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                     "Reading the journals up to the last checkpointed one: "
+                     "%llu.",
+                     request->max_journal_id_to_process);
+    if (request->resume_after_journal_id.has_value()) {
+      execution_result = ResumeRead(journal_stream_read_log_context);
+      if (!execution_result.Successful()) {
+        return FinishContext(execution_result,
+                             journal_stream_read_log_context);
+      }
+      return;
+    }
+  }
+
   // Set the last checkpoint id
   last_checkpoint_id_ = last_checkpoint_metadata.last_checkpoint_id();
+  checkpoint_shard_count_ = std::max<size_t>(
+      1, last_checkpoint_metadata.last_checkpoint_shard_count());
   if (last_checkpoint_id_ == kInvalidJournalId) {
     execution_result = FailureExecutionResult(
         errors::SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_LAST_CHECKPOINT);
@@ -274,6 +358,11 @@ ExecutionResult JournalInputStream::ReadCheckpointBlob(
     AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
         journal_stream_read_log_context,
     CheckpointId checkpoint_id) noexcept {
+  if (checkpoint_shard_count_ > 1) {
+    return ReadCheckpointShardBlobs(journal_stream_read_log_context,
+                                    checkpoint_id);
+  }
+
   Blob checkpoint_blob;
   checkpoint_blob.bucket_name = bucket_name_;
   auto execution_result = JournalUtils::CreateCheckpointBlobName(
@@ -322,32 +411,255 @@ void JournalInputStream::OnReadCheckpointBlobCallback(
     return FinishContext(execution_result, journal_stream_read_log_context);
   }
 
-  last_processed_journal_id_ = checkpoint_metadata.last_processed_journal_id();
-  SCP_INFO_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
-                   "The last journal id read from the last checkpoint metadata "
-                   "is: %llu. Listing all journals after this.",
-                   last_processed_journal_id_);
+  // A checkpoint found by listing the blobs may be missing shards that were
+  // not written.
+  if (std::max<size_t>(1, checkpoint_metadata.shard_count()) !=
+      checkpoint_shard_count_) {
+    execution_result = FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_CHECKPOINT_SHARDS);
+    SCP_ERROR_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                      execution_result,
+                      "The checkpoint has %llu shards but %llu were read.",
+                      checkpoint_metadata.shard_count(),
+                      checkpoint_shard_count_);
+    return FinishContext(execution_result, journal_stream_read_log_context);
+  }
+
+  // The journals to read are the ones after the most recent checkpoint of the
+  // chain, which is the first one read.
+  if (delta_checkpoint_buffers_.empty()) {
+    last_processed_journal_id_ =
+        checkpoint_metadata.last_processed_journal_id();
+    earliest_read_checkpoint_id_ = last_checkpoint_id_;
+  }
 
   // Checkpoint metadata is present at the end of the buffer and is not
   // necessary anymore.
   auto prefix_length_to_consume =
       get_blob_context.response->buffer->length - bytes_deserialized;
-  BytesBuffer checkpoint_buffer(get_blob_context.response->buffer,
-                                prefix_length_to_consume);
+  auto checkpoint_buffer = ByteSlice(*get_blob_context.response->buffer)
+                               .Subslice(0, prefix_length_to_consume)
+                               .ToBytesBuffer();
+
+  // A delta checkpoint only holds the changes on top of its base checkpoint,
+  // so the chain is read back to the full checkpoint it starts from.
+  auto base_checkpoint_id = checkpoint_metadata.base_checkpoint_id();
+  if (base_checkpoint_id != kInvalidCheckpointId) {
+    if (base_checkpoint_id >= earliest_read_checkpoint_id_) {
+      execution_result = FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_CHECKPOINT_CHAIN);
+      SCP_ERROR_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                        execution_result,
+                        "The checkpoint %llu is based on the checkpoint %llu "
+                        "which is not older.",
+                        earliest_read_checkpoint_id_, base_checkpoint_id);
+      return FinishContext(execution_result, journal_stream_read_log_context);
+    }
+
+    delta_checkpoint_buffers_.push_back(checkpoint_buffer);
+    earliest_read_checkpoint_id_ = base_checkpoint_id;
+    checkpoint_shard_count_ = std::max<size_t>(
+        1, checkpoint_metadata.base_checkpoint_shard_count());
+    execution_result =
+        ReadCheckpointBlob(journal_stream_read_log_context, base_checkpoint_id);
+    if (!execution_result.Successful()) {
+      FinishContext(execution_result, journal_stream_read_log_context);
+    }
+    return;
+  }
+
+  if (!delta_checkpoint_buffers_.empty()) {
+    checkpoint_buffer = MergeCheckpointChain(checkpoint_buffer);
+  }
+
+  SCP_INFO_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                   "The last journal id read from the last checkpoint metadata "
+                   "is: %llu. Listing all journals after this. Number of delta "
+                   "checkpoints on top of the full checkpoint: %llu.",
+                   last_processed_journal_id_,
+                   delta_checkpoint_buffers_.size());
+  delta_checkpoint_buffers_.clear();
 
   // Checkpoint data needs to be processed as well.
   // Checkpoint buffer is stored at the index '0' in journal_buffers_
   journal_buffers_.push_back(checkpoint_buffer);
 
+  execution_result =
+      ListJournalsAfterLastProcessedJournal(journal_stream_read_log_context);
+  if (!execution_result.Successful()) {
+    return FinishContext(execution_result, journal_stream_read_log_context);
+  }
+}
+
+ExecutionResult JournalInputStream::ResumeRead(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  last_processed_journal_id_ =
+      *journal_stream_read_log_context.request->resume_after_journal_id;
+  SCP_INFO_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                   "Resuming the read after the journal id: %llu.",
+                   last_processed_journal_id_);
+  return ListJournalsAfterLastProcessedJournal(journal_stream_read_log_context);
+}
+
+ExecutionResult JournalInputStream::ListJournalsAfterLastProcessedJournal(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  if (journal_listing_shard_count_ > 1) {
+    // The journals are not expected after the current time, the last range
+    // gets the ones that are.
+    auto end_journal_id = min<JournalId>(
+        journal_stream_read_log_context.request->max_journal_id_to_process,
+        TimeProvider::GetWallTimestampInNanoseconds().count());
+    return ListJournalShards(journal_stream_read_log_context, end_journal_id);
+  }
+
   shared_ptr<Blob> start_from = make_shared<Blob>();
   JournalUtils::CreateJournalBlobName(
       partition_name_, last_processed_journal_id_, start_from->blob_name);
   start_from->bucket_name = bucket_name_;
-  execution_result = ListJournals(journal_stream_read_log_context, start_from);
+  return ListJournals(journal_stream_read_log_context, start_from);
+}
+
+ExecutionResult JournalInputStream::ReadCheckpointShardBlobs(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    CheckpointId checkpoint_id) noexcept {
+  auto shard_count = checkpoint_shard_count_;
+  checkpoint_shard_buffers_.assign(shard_count, nullptr);
+  is_any_checkpoint_shard_read_failed_ = false;
+  pending_checkpoint_shard_reads_ = shard_count;
+
+  SCP_DEBUG_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                    "Reading %llu shards of the checkpoint %llu.", shard_count,
+                    checkpoint_id);
+
+  for (size_t shard_index = 0; shard_index < shard_count; ++shard_index) {
+    auto get_blob_request = make_shared<GetBlobRequest>();
+    get_blob_request->bucket_name = bucket_name_;
+    auto execution_result = JournalUtils::CreateCheckpointShardBlobName(
+        partition_name_, checkpoint_id, shard_index,
+        get_blob_request->blob_name);
+    if (execution_result.Successful()) {
+      AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
+          get_blob_request,
+          bind(&JournalInputStream::OnReadCheckpointShardBlobCallback, this,
+               journal_stream_read_log_context, shard_index, _1),
+          journal_stream_read_log_context);
+      execution_result =
+          blob_storage_provider_client_->GetBlob(get_blob_context);
+    }
+
+    if (!execution_result.Successful()) {
+      // The shards that are not requested are done. If reads are still in
+      // flight, the last one to finish fails the operation.
+      failed_checkpoint_shard_read_result_ = execution_result;
+      is_any_checkpoint_shard_read_failed_ = true;
+      auto not_requested_shards = shard_count - shard_index;
+      if (pending_checkpoint_shard_reads_.fetch_sub(not_requested_shards) ==
+          not_requested_shards) {
+        return execution_result;
+      }
+      return SuccessExecutionResult();
+    }
+  }
+  return SuccessExecutionResult();
+}
+
+void JournalInputStream::OnReadCheckpointShardBlobCallback(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    size_t shard_index,
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) noexcept {
+  if (!get_blob_context.result.Successful()) {
+    SCP_ERROR_CONTEXT(kJournalInputStream, get_blob_context,
+                      get_blob_context.result,
+                      "Error reading checkpoint shard blob with blob name: %s.",
+                      get_blob_context.request->blob_name->c_str());
+    failed_checkpoint_shard_read_result_ = get_blob_context.result;
+    is_any_checkpoint_shard_read_failed_ = true;
+  } else {
+    checkpoint_shard_buffers_[shard_index] = get_blob_context.response->buffer;
+  }
+
+  if (pending_checkpoint_shard_reads_.fetch_sub(1) != 1) {
+    return;
+  }
 
+  if (is_any_checkpoint_shard_read_failed_) {
+    checkpoint_shard_buffers_.clear();
+    return FinishContext(failed_checkpoint_shard_read_result_.load(),
+                         journal_stream_read_log_context);
+  }
+
+  auto checkpoint_buffer = make_shared<BytesBuffer>();
+  auto execution_result = MergeCheckpointShards(*checkpoint_buffer);
+  checkpoint_shard_buffers_.clear();
   if (!execution_result.Successful()) {
     return FinishContext(execution_result, journal_stream_read_log_context);
   }
+
+  get_blob_context.response = make_shared<GetBlobResponse>();
+  get_blob_context.response->buffer = move(checkpoint_buffer);
+  OnReadCheckpointBlobCallback(journal_stream_read_log_context,
+                               get_blob_context);
+}
+
+ExecutionResult JournalInputStream::MergeCheckpointShards(
+    BytesBuffer& checkpoint_buffer) noexcept {
+  // Every shard ends with the checkpoint metadata, which is only kept once.
+  vector<size_t> shard_log_lengths;
+  size_t metadata_length = 0;
+  size_t length = 0;
+  for (const auto& shard_buffer : checkpoint_shard_buffers_) {
+    CheckpointMetadata checkpoint_metadata;
+    size_t bytes_deserialized = 0;
+    auto execution_result = JournalSerialization::DeserializeCheckpointMetadata(
+        *shard_buffer, 0, checkpoint_metadata, bytes_deserialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    if (shard_log_lengths.empty()) {
+      metadata_length = bytes_deserialized;
+    }
+    shard_log_lengths.push_back(shard_buffer->length - bytes_deserialized);
+    length += shard_log_lengths.back();
+  }
+
+  checkpoint_buffer = BytesBuffer(length + metadata_length);
+  auto output = checkpoint_buffer.bytes->begin();
+  for (size_t i = 0; i < checkpoint_shard_buffers_.size(); ++i) {
+    output = std::copy_n(checkpoint_shard_buffers_[i]->bytes->begin(),
+                         shard_log_lengths[i], output);
+  }
+  std::copy_n(
+      checkpoint_shard_buffers_[0]->bytes->begin() + shard_log_lengths[0],
+      metadata_length, output);
+  checkpoint_buffer.length = length + metadata_length;
+  return SuccessExecutionResult();
+}
+
+BytesBuffer JournalInputStream::MergeCheckpointChain(
+    const BytesBuffer& full_checkpoint_buffer) noexcept {
+  size_t length = full_checkpoint_buffer.length;
+  for (const auto& delta_checkpoint_buffer : delta_checkpoint_buffers_) {
+    length += delta_checkpoint_buffer.length;
+  }
+
+  // The deltas were read from the most recent one, and are replayed after
+  // the full checkpoint from the oldest one.
+  BytesBuffer checkpoint_buffer(length);
+  auto append = [&](const BytesBuffer& bytes_buffer) {
+    std::copy_n(bytes_buffer.bytes->begin(), bytes_buffer.length,
+                checkpoint_buffer.bytes->begin() + checkpoint_buffer.length);
+    checkpoint_buffer.length += bytes_buffer.length;
+  };
+  append(full_checkpoint_buffer);
+  for (auto it = delta_checkpoint_buffers_.rbegin();
+       it != delta_checkpoint_buffers_.rend(); ++it) {
+    append(*it);
+  }
+  return checkpoint_buffer;
 }
 
 ExecutionResult JournalInputStream::ListCheckpoints(
@@ -408,27 +720,18 @@ void JournalInputStream::OnListCheckpointsCallback(
       return FinishContext(execution_result, journal_stream_read_log_context);
     }
 
+    // The shards of a checkpoint are listed as blobs of that checkpoint.
     if (checkpoint_id > last_checkpoint_id_) {
       last_checkpoint_id_ = checkpoint_id;
+      checkpoint_shard_count_ = 1;
+    } else if (checkpoint_id == last_checkpoint_id_) {
+      checkpoint_shard_count_++;
     }
   }
 
   // If there are more checkpoints remaining
-  if (list_blobs_context.response->next_marker &&
-      !list_blobs_context.response->next_marker->blob_name->empty()) {
-    auto execution_result =
-        ListCheckpoints(journal_stream_read_log_context,
-                        list_blobs_context.response->next_marker);
-    if (!execution_result.Successful()) {
-      return FinishContext(execution_result, journal_stream_read_log_context);
-    }
-    return;
-  }
-
-  // Do one more listing to be sure that there are no more remaining.
-  if (!list_blobs_context.response->blobs->empty()) {
-    auto next_marker =
-        make_shared<Blob>(list_blobs_context.response->blobs->back());
+  if (auto next_marker = GetNextListingMarker(*list_blobs_context.response);
+      next_marker) {
     auto execution_result =
         ListCheckpoints(journal_stream_read_log_context, next_marker);
     if (!execution_result.Successful()) {
@@ -532,41 +835,230 @@ void JournalInputStream::OnListJournalsCallback(
     }
   }
 
-  if (!stop_listing) {
-    // If there are more journals remaining
-    if (list_blobs_context.response->next_marker &&
-        list_blobs_context.response->next_marker->blob_name->size() > 0) {
-      auto execution_result =
-          ListJournals(journal_stream_read_log_context,
-                       list_blobs_context.response->next_marker);
-      if (!execution_result.Successful()) {
-        return FinishContext(execution_result, journal_stream_read_log_context);
+  // If there are more journals remaining
+  if (auto next_marker = GetNextListingMarker(*list_blobs_context.response);
+      !stop_listing && next_marker) {
+    auto execution_result =
+        ListJournals(journal_stream_read_log_context, next_marker);
+    if (!execution_result.Successful()) {
+      return FinishContext(execution_result, journal_stream_read_log_context);
+    }
+    return;
+  }
+
+  OnJournalsListed(journal_stream_read_log_context);
+}
+
+ExecutionResult JournalInputStream::ListJournalShards(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    JournalId end_journal_id) noexcept {
+  auto start_journal_id = last_processed_journal_id_;
+  auto shard_count = journal_listing_shard_count_;
+  if (end_journal_id <= start_journal_id ||
+      end_journal_id - start_journal_id < shard_count) {
+    shard_count = 1;
+  }
+  auto shard_length = (end_journal_id - start_journal_id) / shard_count;
+
+  journal_listing_shards_.assign(shard_count, JournalListingShard());
+  for (size_t shard_index = 0; shard_index < shard_count; ++shard_index) {
+    // The last range also gets the journals written after the end id.
+    journal_listing_shards_[shard_index].end_journal_id =
+        shard_index + 1 == shard_count
+            ? std::numeric_limits<JournalId>::max()
+            : start_journal_id + (shard_index + 1) * shard_length;
+  }
+  is_any_journal_listing_shard_failed_ = false;
+  pending_journal_listing_shards_ = shard_count;
+
+  SCP_DEBUG_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                    "Listing the journals after %llu as %llu ranges of %llu "
+                    "ids.",
+                    start_journal_id, shard_count, shard_length);
+
+  for (size_t shard_index = 0; shard_index < shard_count; ++shard_index) {
+    auto start_from = make_shared<Blob>();
+    start_from->bucket_name = bucket_name_;
+    auto execution_result = JournalUtils::CreateJournalBlobName(
+        partition_name_, start_journal_id + shard_index * shard_length,
+        start_from->blob_name);
+    if (execution_result.Successful()) {
+      execution_result = ListJournalShard(journal_stream_read_log_context,
+                                          shard_index, start_from);
+    }
+
+    if (!execution_result.Successful()) {
+      // The ranges that are not requested are done. If listings are still in
+      // flight, the last one to finish fails the operation.
+      failed_journal_listing_shard_result_ = execution_result;
+      is_any_journal_listing_shard_failed_ = true;
+      auto not_requested_shards = shard_count - shard_index;
+      if (pending_journal_listing_shards_.fetch_sub(not_requested_shards) ==
+          not_requested_shards) {
+        journal_listing_shards_.clear();
+        return execution_result;
       }
-      return;
+      return SuccessExecutionResult();
     }
+  }
+  return SuccessExecutionResult();
+}
 
-    // Do one more listing to be sure that there are no more remaining.
-    if (list_blobs_context.response->blobs->size() != 0) {
-      auto next_marker =
-          make_shared<Blob>(list_blobs_context.response->blobs->back());
-      auto execution_result =
-          ListJournals(journal_stream_read_log_context, next_marker);
-      if (!execution_result.Successful()) {
-        return FinishContext(execution_result, journal_stream_read_log_context);
+ExecutionResult JournalInputStream::ListJournalShard(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    size_t shard_index, const shared_ptr<Blob>& start_from) noexcept {
+  ListBlobsRequest list_blobs_request;
+  list_blobs_request.bucket_name = bucket_name_;
+  auto execution_result = JournalUtils::GetBlobFullPath(
+      partition_name_, make_shared<string>(kJournalBlobNamePrefix),
+      list_blobs_request.blob_name);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  list_blobs_request.marker = start_from->blob_name;
+
+  AsyncContext<ListBlobsRequest, ListBlobsResponse> list_blobs_context(
+      make_shared<ListBlobsRequest>(move(list_blobs_request)),
+      bind(&JournalInputStream::OnListJournalShardCallback, this,
+           journal_stream_read_log_context, shard_index, _1),
+      journal_stream_read_log_context);
+
+  return blob_storage_provider_client_->ListBlobs(list_blobs_context);
+}
+
+void JournalInputStream::OnListJournalShardCallback(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    size_t shard_index,
+    AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+        list_blobs_context) noexcept {
+  if (!list_blobs_context.result.Successful()) {
+    SCP_ERROR_CONTEXT(kJournalInputStream, list_blobs_context,
+                      list_blobs_context.result,
+                      "Failed to list the journals of the range %llu",
+                      shard_index);
+    return CompleteJournalListingShard(journal_stream_read_log_context,
+                                       list_blobs_context.result);
+  }
+
+  auto& shard = journal_listing_shards_[shard_index];
+  auto stop_listing = false;
+  for (const auto& journal_blob : *list_blobs_context.response->blobs) {
+    JournalId journal_id = kInvalidJournalId;
+    auto execution_result = JournalUtils::ExtractJournalId(
+        partition_name_, journal_blob.blob_name, journal_id);
+    if (!execution_result.Successful()) {
+      return CompleteJournalListingShard(journal_stream_read_log_context,
+                                         execution_result);
+    }
+
+    // The journals after the range are listed by the next range.
+    const auto& request = *journal_stream_read_log_context.request;
+    if (journal_id > shard.end_journal_id ||
+        journal_id > request.max_journal_id_to_process) {
+      stop_listing = true;
+      break;
+    }
+
+    if (journal_id > last_processed_journal_id_) {
+      shard.journal_ids.push_back(journal_id);
+    }
+
+    // The journals of the range after these ones are not read in this pass.
+    if (shard.journal_ids.size() >= request.max_number_of_journals_to_process) {
+      stop_listing = true;
+      break;
+    }
+  }
+
+  if (auto next_marker = GetNextListingMarker(*list_blobs_context.response);
+      !stop_listing && next_marker) {
+    auto execution_result = ListJournalShard(journal_stream_read_log_context,
+                                             shard_index, next_marker);
+    if (!execution_result.Successful()) {
+      CompleteJournalListingShard(journal_stream_read_log_context,
+                                  execution_result);
+    }
+    return;
+  }
+
+  CompleteJournalListingShard(journal_stream_read_log_context,
+                              SuccessExecutionResult());
+}
+
+void JournalInputStream::CompleteJournalListingShard(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    const ExecutionResult& execution_result) noexcept {
+  if (!execution_result.Successful()) {
+    failed_journal_listing_shard_result_ = execution_result;
+    is_any_journal_listing_shard_failed_ = true;
+  }
+
+  if (pending_journal_listing_shards_.fetch_sub(1) != 1) {
+    return;
+  }
+
+  if (is_any_journal_listing_shard_failed_) {
+    journal_listing_shards_.clear();
+    return FinishContext(failed_journal_listing_shard_result_.load(),
+                         journal_stream_read_log_context);
+  }
+
+  // The ranges are in the order of the ids, and so are their journals.
+  auto max_number_of_journals_to_process =
+      journal_stream_read_log_context.request
+          ->max_number_of_journals_to_process;
+  for (const auto& shard : journal_listing_shards_) {
+    for (auto journal_id : shard.journal_ids) {
+      if (journal_ids_.size() >= max_number_of_journals_to_process) {
+        break;
       }
-      return;
+      journal_ids_.push_back(journal_id);
     }
   }
+  journal_listing_shards_.clear();
+
+  OnJournalsListed(journal_stream_read_log_context);
+}
+
+void JournalInputStream::OnJournalsListed(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  if (enable_journal_segments_ && !journal_segments_loaded_) {
+    auto execution_result =
+        ReadJournalSegmentManifest(journal_stream_read_log_context);
+    if (!execution_result.Successful()) {
+      FinishContext(execution_result, journal_stream_read_log_context);
+    }
+    return;
+  }
 
   if (enable_batch_read_journals_) {
     journal_ids_loaded_ = true;
   }
 
-  if (!journal_ids_.empty()) {
-    // Sort by id
-    // TODO: Q) Is this necessary? This sort can be expensive.
-    sort(journal_ids_.begin(), journal_ids_.end());
+  // Sort by id
+  // TODO: Q) Is this necessary? This sort can be expensive.
+  sort(journal_ids_.begin(), journal_ids_.end());
+  if (enable_journal_segments_) {
+    auto execution_result = ApplyJournalSegments(
+        journal_stream_read_log_context.request->max_journal_id_to_process,
+        journal_stream_read_log_context.request
+            ->max_number_of_journals_to_process);
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                        execution_result,
+                        "Cannot read the journal segments after the last "
+                        "processed journal id %llu.",
+                        last_processed_journal_id_);
+      return FinishContext(execution_result, journal_stream_read_log_context);
+    }
+  }
 
+  if (!journal_ids_.empty()) {
     // TODO: Q) Is this necessary for correctness? can't we pick the last one
     // in the list? Journals are already returned in lexicographical order.
     last_processed_journal_id_ = journal_ids_.back();
@@ -618,6 +1110,129 @@ void JournalInputStream::OnListJournalsCallback(
   }
 }
 
+ExecutionResult JournalInputStream::ReadJournalSegmentManifest(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  GetBlobRequest get_blob_request;
+  get_blob_request.bucket_name = bucket_name_;
+  auto execution_result = JournalUtils::GetBlobFullPath(
+      partition_name_, make_shared<string>(kJournalSegmentManifestBlobName),
+      get_blob_request.blob_name);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
+      make_shared<GetBlobRequest>(move(get_blob_request)),
+      bind(&JournalInputStream::OnReadJournalSegmentManifestCallback, this,
+           journal_stream_read_log_context, _1),
+      journal_stream_read_log_context);
+
+  return blob_storage_provider_client_->GetBlob(get_blob_context);
+}
+
+void JournalInputStream::OnReadJournalSegmentManifestCallback(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context,
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) noexcept {
+  journal_segments_.clear();
+  if (!get_blob_context.result.Successful()) {
+    // Without a manifest, no journal was compacted.
+    if (get_blob_context.result !=
+        FailureExecutionResult(
+            errors::SC_BLOB_STORAGE_PROVIDER_BLOB_PATH_NOT_FOUND)) {
+      SCP_ERROR_CONTEXT(kJournalInputStream, get_blob_context,
+                        get_blob_context.result,
+                        "Error reading the journal segment manifest blob");
+      return FinishContext(get_blob_context.result,
+                           journal_stream_read_log_context);
+    }
+  } else {
+    JournalSegmentManifest journal_segment_manifest;
+    size_t bytes_deserialized = 0;
+    auto execution_result =
+        JournalSerialization::DeserializeJournalSegmentManifest(
+            *get_blob_context.response->buffer, 0, journal_segment_manifest,
+            bytes_deserialized);
+    if (!execution_result.Successful()) {
+      return FinishContext(execution_result, journal_stream_read_log_context);
+    }
+    for (const auto& segment : journal_segment_manifest.segments()) {
+      journal_segments_[segment.last_journal_id()] = segment.first_journal_id();
+    }
+  }
+
+  SCP_INFO_CONTEXT(kJournalInputStream, get_blob_context,
+                   "Read the manifest of %llu journal segments.",
+                   journal_segments_.size());
+  journal_segments_loaded_ = true;
+  OnJournalsListed(journal_stream_read_log_context);
+}
+
+ExecutionResult JournalInputStream::ApplyJournalSegments(
+    JournalId max_journal_id_to_process,
+    size_t max_number_of_journals_to_process) noexcept {
+  // When the listing stopped at the max number of journals, the segments after
+  // the last listed journal are read by the next pass.
+  auto max_first_journal_id = max_journal_id_to_process;
+  if (!journal_ids_.empty() &&
+      journal_ids_.size() >= max_number_of_journals_to_process) {
+    max_first_journal_id = journal_ids_.back();
+  }
+
+  vector<JournalId> journal_ids;
+  journal_ids.reserve(journal_ids_.size());
+  auto journal_id_it = journal_ids_.begin();
+  for (auto segment_it =
+           journal_segments_.upper_bound(last_processed_journal_id_);
+       segment_it != journal_segments_.end(); ++segment_it) {
+    auto last_journal_id = segment_it->first;
+    auto first_journal_id = segment_it->second;
+    // A segment is only read as a whole.
+    if (first_journal_id <= last_processed_journal_id_) {
+      return FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_JOURNAL_SEGMENT);
+    }
+    if (first_journal_id > max_first_journal_id ||
+        last_journal_id > max_journal_id_to_process) {
+      // Neither the segment nor the journals after it are read in this pass.
+      max_first_journal_id = first_journal_id - 1;
+      break;
+    }
+
+    while (journal_id_it != journal_ids_.end() &&
+           *journal_id_it < first_journal_id) {
+      journal_ids.push_back(*journal_id_it++);
+    }
+    // The journals left over by an interrupted compaction are in the segment.
+    while (journal_id_it != journal_ids_.end() &&
+           *journal_id_it <= last_journal_id) {
+      journal_id_it++;
+    }
+    journal_ids.push_back(last_journal_id);
+  }
+  while (journal_id_it != journal_ids_.end() &&
+         *journal_id_it <= max_first_journal_id) {
+    journal_ids.push_back(*journal_id_it++);
+  }
+
+  if (journal_ids.size() > max_number_of_journals_to_process) {
+    journal_ids.resize(max_number_of_journals_to_process);
+  }
+  journal_ids_.swap(journal_ids);
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalInputStream::CreateJournalOrSegmentBlobName(
+    JournalId journal_id, shared_ptr<string>& blob_name) noexcept {
+  if (journal_segments_.find(journal_id) != journal_segments_.end()) {
+    return JournalUtils::CreateJournalSegmentBlobName(partition_name_,
+                                                      journal_id, blob_name);
+  }
+  return JournalUtils::CreateJournalBlobName(partition_name_, journal_id,
+                                             blob_name);
+}
+
 ExecutionResult JournalInputStream::ReadJournalBlobs(
     AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
         journal_stream_read_log_context,
@@ -706,8 +1321,8 @@ ExecutionResult JournalInputStream::ReadJournalBlob(
     JournalId journal_id, size_t buffer_index) noexcept {
   Blob journal_blob;
   journal_blob.bucket_name = bucket_name_;
-  auto execution_result = JournalUtils::CreateJournalBlobName(
-      partition_name_, journal_id, journal_blob.blob_name);
+  auto execution_result =
+      CreateJournalOrSegmentBlobName(journal_id, journal_blob.blob_name);
   if (!execution_result.Successful()) {
     return execution_result;
   }
@@ -730,18 +1345,18 @@ void JournalInputStream::OnReadJournalBlobCallback(
         journal_stream_read_log_context,
     AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
     size_t buffer_index) noexcept {
-  if (!get_blob_context.result.Successful()) {
+  auto execution_result = get_blob_context.result;
+  if (execution_result.Successful()) {
+    execution_result = StoreJournalBlob(*get_blob_context.response,
+                                        journal_buffers_[buffer_index]);
+  }
+  if (!execution_result.Successful()) {
     auto failed = false;
     // Only change if the current status was false.
     if (is_any_journal_read_failed_.compare_exchange_strong(failed, true)) {
       execution_result_of_failed_journal_read_ =
-          FailureExecutionResult(get_blob_context.result.status_code);
+          FailureExecutionResult(execution_result.status_code);
     }
-  } else {
-    BytesBuffer& bytes_buffer = journal_buffers_[buffer_index];
-    bytes_buffer.bytes.swap(get_blob_context.response->buffer->bytes);
-    bytes_buffer.length = get_blob_context.response->buffer->length;
-    bytes_buffer.capacity = get_blob_context.response->buffer->capacity;
   }
 
   // Was it the last callback?
@@ -762,14 +1377,149 @@ void JournalInputStream::OnReadJournalBlobCallback(
   // All of the journals are loaded into the memory.
   journals_loaded_ = true;
 
-  auto execution_result =
-      ProcessLoadedJournals(journal_stream_read_log_context);
+  PrefetchNextJournalBlobs(journal_stream_read_log_context);
+  execution_result = ProcessLoadedJournals(journal_stream_read_log_context);
   if (!execution_result.Successful()) {
     FinishContext(execution_result, journal_stream_read_log_context);
     return;
   }
 }
 
+ExecutionResult JournalInputStream::StoreJournalBlob(
+    GetBlobResponse& get_blob_response, BytesBuffer& bytes_buffer) noexcept {
+  if (JournalSerialization::IsCompressedJournalBlob(
+          *get_blob_response.buffer)) {
+    return JournalSerialization::DecompressJournalBlob(
+        *get_blob_response.buffer, bytes_buffer);
+  }
+  bytes_buffer.bytes.swap(get_blob_response.buffer->bytes);
+  bytes_buffer.length = get_blob_response.buffer->length;
+  bytes_buffer.capacity = get_blob_response.buffer->capacity;
+  return SuccessExecutionResult();
+}
+
+void JournalInputStream::PrefetchNextJournalBlobs(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  if (!enable_batch_read_journals_ || !enable_prefetch_journals_) {
+    return;
+  }
+
+  size_t prefetch_start_index =
+      journal_ids_window_start_index_ + journal_ids_window_length_;
+  if (prefetch_start_index >= journal_ids_.size()) {
+    return;
+  }
+  size_t total_journals_to_prefetch =
+      std::min(number_of_journals_per_batch_,
+               journal_ids_.size() - prefetch_start_index);
+
+  {
+    std::unique_lock lock(prefetch_mutex_);
+    prefetched_journal_buffers_.clear();
+    prefetched_journal_buffers_.resize(total_journals_to_prefetch);
+    prefetched_journals_count_ = total_journals_to_prefetch;
+    pending_prefetch_reads_ = total_journals_to_prefetch;
+    is_any_prefetch_read_failed_ = false;
+  }
+
+  for (size_t i = 0; i < total_journals_to_prefetch; i++) {
+    Blob journal_blob;
+    journal_blob.bucket_name = bucket_name_;
+    auto execution_result = CreateJournalOrSegmentBlobName(
+        journal_ids_[prefetch_start_index + i], journal_blob.blob_name);
+    if (execution_result.Successful()) {
+      GetBlobRequest get_blob_request;
+      get_blob_request.bucket_name = journal_blob.bucket_name;
+      get_blob_request.blob_name = journal_blob.blob_name;
+      AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
+          make_shared<GetBlobRequest>(move(get_blob_request)),
+          bind(&JournalInputStream::OnPrefetchJournalBlobCallback, this, _1, i),
+          journal_stream_read_log_context);
+      execution_result =
+          blob_storage_provider_client_->GetBlob(get_blob_context);
+    }
+    if (!execution_result.Successful()) {
+      CompletePrefetchRead(execution_result);
+    }
+  }
+}
+
+void JournalInputStream::OnPrefetchJournalBlobCallback(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    size_t buffer_index) noexcept {
+  auto execution_result = get_blob_context.result;
+  if (execution_result.Successful()) {
+    execution_result = StoreJournalBlob(
+        *get_blob_context.response, prefetched_journal_buffers_[buffer_index]);
+  }
+  CompletePrefetchRead(execution_result);
+}
+
+void JournalInputStream::CompletePrefetchRead(
+    const ExecutionResult& execution_result) noexcept {
+  std::optional<
+      AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>>
+      journal_stream_read_log_context;
+  {
+    std::unique_lock lock(prefetch_mutex_);
+    if (!execution_result.Successful()) {
+      is_any_prefetch_read_failed_ = true;
+    }
+    if (--pending_prefetch_reads_ > 0 ||
+        !context_waiting_for_prefetch_.has_value()) {
+      return;
+    }
+    journal_stream_read_log_context.swap(context_waiting_for_prefetch_);
+  }
+
+  // A read log operation is waiting for this batch.
+  auto result = InstallPrefetchedJournals(*journal_stream_read_log_context);
+  if (!result.Successful()) {
+    FinishContext(result, *journal_stream_read_log_context);
+  }
+}
+
+ExecutionResult JournalInputStream::ProcessPrefetchedJournals(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  {
+    std::unique_lock lock(prefetch_mutex_);
+    if (pending_prefetch_reads_ > 0) {
+      // The last prefetch read continues the operation.
+      context_waiting_for_prefetch_ = journal_stream_read_log_context;
+      return SuccessExecutionResult();
+    }
+  }
+  return InstallPrefetchedJournals(journal_stream_read_log_context);
+}
+
+ExecutionResult JournalInputStream::InstallPrefetchedJournals(
+    AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
+        journal_stream_read_log_context) noexcept {
+  // No prefetch read is in flight at this point, so the prefetch state can be
+  // used without the lock.
+  auto prefetched_journals_count = prefetched_journals_count_;
+  prefetched_journals_count_ = 0;
+  if (is_any_prefetch_read_failed_) {
+    SCP_DEBUG_CONTEXT(kJournalInputStream, journal_stream_read_log_context,
+                      "Failed to prefetch some of the journals, reading the "
+                      "batch again.");
+    prefetched_journal_buffers_.clear();
+    is_any_prefetch_read_failed_ = false;
+    return ReadJournalBlobs(journal_stream_read_log_context, journal_ids_);
+  }
+
+  journal_buffers_ = move(prefetched_journal_buffers_);
+  prefetched_journal_buffers_.clear();
+  current_buffer_index_ = 0;
+  current_buffer_offset_ = 0;
+  journal_ids_window_length_ = prefetched_journals_count;
+
+  PrefetchNextJournalBlobs(journal_stream_read_log_context);
+  return ProcessLoadedJournals(journal_stream_read_log_context);
+}
+
 ExecutionResult JournalInputStream::ProcessLoadedJournals(
     AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>&
         journal_stream_read_log_context) noexcept {
@@ -820,6 +1570,16 @@ JournalId JournalInputStream::GetCurrentBufferJournalId() {
   return journal_ids_[current_buffer_index_];
 }
 
+bool JournalInputStream::IsCurrentBufferCheckpoint() {
+  // The checkpoint buffer is only at the index '0' of the first window, see
+  // GetCurrentBufferJournalId().
+  if (last_checkpoint_id_ == kInvalidCheckpointId ||
+      current_buffer_index_ != 0) {
+    return false;
+  }
+  return !enable_batch_read_journals_ || journal_ids_window_start_index_ == 0;
+}
+
 ExecutionResult JournalInputStream::ProcessNextJournalLog(
     Timestamp& timestamp, JournalLogStatus& journal_log_status,
     Uuid& component_id, Uuid& log_id, JournalLog& journal_log,
@@ -877,6 +1637,8 @@ ExecutionResult JournalInputStream::ReadJournalLogBatch(
                               journal_stream_read_log_object.log_id,
                               *journal_stream_read_log_object.journal_log,
                               journal_stream_read_log_object.journal_id);
+    journal_stream_read_log_object.is_checkpoint_log =
+        execution_result.Successful() && IsCurrentBufferCheckpoint();
     if (!execution_result.Successful()) {
       if (execution_result ==
           FailureExecutionResult(
@@ -16,8 +16,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -33,6 +37,8 @@ namespace google::scp::core {
 
 static constexpr size_t kDefaultNumberOfJournalsToReadPerBatch = 1000;
 static constexpr size_t kDefaultNumberOfJournalLogsToReturn = 5000;
+static constexpr size_t kDefaultMaxResidentJournalBlobs = 16;
+static constexpr size_t kDefaultJournalListingShardCount = 1;
 
 /*! @copydoc JournalInputStreamInterface
  */
@@ -46,6 +52,9 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
       : journals_loaded_(false),
         last_checkpoint_id_(kInvalidCheckpointId),
         last_processed_journal_id_(kInvalidJournalId),
+        pending_checkpoint_shard_reads_(0),
+        is_any_checkpoint_shard_read_failed_(false),
+        failed_checkpoint_shard_read_result_(SuccessExecutionResult()),
         total_journals_to_read_(0),
         execution_result_of_failed_journal_read_(SuccessExecutionResult()),
         is_any_journal_read_failed_(false),
@@ -59,11 +68,24 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
         journal_ids_window_length_(0),
         enable_batch_read_journals_(false),
         number_of_journals_per_batch_(kDefaultNumberOfJournalsToReadPerBatch),
-        number_of_journal_logs_to_return_(kDefaultNumberOfJournalLogsToReturn) {
+        number_of_journal_logs_to_return_(kDefaultNumberOfJournalLogsToReturn),
+        enable_prefetch_journals_(false),
+        prefetched_journals_count_(0),
+        pending_prefetch_reads_(0),
+        is_any_prefetch_read_failed_(false),
+        journal_listing_shard_count_(kDefaultJournalListingShardCount),
+        pending_journal_listing_shards_(0),
+        is_any_journal_listing_shard_failed_(false),
+        failed_journal_listing_shard_result_(SuccessExecutionResult()),
+        enable_journal_segments_(false) {
     if (!config_provider_->Get(kPBSJournalInputStreamEnableBatchReadJournals,
                                enable_batch_read_journals_)) {
       enable_batch_read_journals_ = false;
     }
+    if (!config_provider_->Get(kPBSJournalInputStreamEnablePrefetchJournals,
+                               enable_prefetch_journals_)) {
+      enable_prefetch_journals_ = false;
+    }
     if (!config_provider_->Get(kPBSJournalInputStreamNumberOfJournalsPerBatch,
                                number_of_journals_per_batch_)) {
       number_of_journals_per_batch_ = kDefaultNumberOfJournalsToReadPerBatch;
@@ -73,6 +95,34 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
             number_of_journal_logs_to_return_)) {
       number_of_journal_logs_to_return_ = kDefaultNumberOfJournalLogsToReturn;
     }
+    if (!config_provider_->Get(kPBSJournalInputStreamJournalListingShardCount,
+                               journal_listing_shard_count_)) {
+      journal_listing_shard_count_ = kDefaultJournalListingShardCount;
+    }
+    if (!config_provider_->Get(kPBSJournalServiceEnableJournalCompaction,
+                               enable_journal_segments_)) {
+      enable_journal_segments_ = false;
+    }
+
+    bool enable_streaming_replay = false;
+    if (!config_provider_->Get(kPBSJournalInputStreamEnableStreamingReplay,
+                               enable_streaming_replay)) {
+      enable_streaming_replay = false;
+    }
+    if (enable_streaming_replay) {
+      size_t max_resident_journal_blobs = kDefaultMaxResidentJournalBlobs;
+      if (!config_provider_->Get(kPBSJournalInputStreamMaxResidentJournalBlobs,
+                                 max_resident_journal_blobs)) {
+        max_resident_journal_blobs = kDefaultMaxResidentJournalBlobs;
+      }
+      // The prefetched batch is resident along with the current one.
+      auto max_journals_per_batch = enable_prefetch_journals_
+                                        ? max_resident_journal_blobs / 2
+                                        : max_resident_journal_blobs;
+      enable_batch_read_journals_ = true;
+      number_of_journals_per_batch_ = std::max<size_t>(
+          1, std::min(number_of_journals_per_batch_, max_journals_per_batch));
+    }
   }
 
   /**
@@ -223,6 +273,30 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
       AsyncContext<ListBlobsRequest, ListBlobsResponse>&
           list_blobs_context) noexcept;
 
+  /**
+   * @brief Resumes the read after the journal of the request, without reading
+   * the checkpoint.
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult ResumeRead(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
+  /**
+   * @brief Lists the journals after last_processed_journal_id_, in shards if
+   * configured, and reads them.
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult ListJournalsAfterLastProcessedJournal(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
   /**
    * @brief Lists all the existing journals and returns the result on the
    * callback.
@@ -253,6 +327,18 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
       AsyncContext<ListBlobsRequest, ListBlobsResponse>&
           list_blobs_context) noexcept;
 
+  /**
+   * @brief Continues the read once the ids of the journals to read are in
+   * journal_ids_, by reading the journals or finishing the operation.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   */
+  virtual void OnJournalsListed(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
   /**
    * @brief Processes the loaded checkpoint (optional) and loaded journal logs
    * to produce a stream of logs and returns back to the caller's context.
@@ -306,6 +392,28 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
   /// Last processed journal id by the previous checkpoint.
   JournalId last_processed_journal_id_;
 
+  /// The delta checkpoints read on top of the full checkpoint, from the most
+  /// recent one.
+  std::vector<BytesBuffer> delta_checkpoint_buffers_;
+
+  /// The id of the oldest checkpoint of the chain read so far.
+  CheckpointId earliest_read_checkpoint_id_ = kInvalidCheckpointId;
+
+  /// The number of blobs the checkpoint to read next is sharded into.
+  size_t checkpoint_shard_count_ = 1;
+
+  /// The shards of the checkpoint being read, by shard index.
+  std::vector<std::shared_ptr<BytesBuffer>> checkpoint_shard_buffers_;
+
+  /// The number of shard reads of the checkpoint being read that did not
+  /// finish yet. The last one to finish continues the read.
+  std::atomic<size_t> pending_checkpoint_shard_reads_;
+
+  /// Whether any shard read of the checkpoint being read failed, and the
+  /// result of the failed read.
+  std::atomic<bool> is_any_checkpoint_shard_read_failed_;
+  std::atomic<ExecutionResult> failed_checkpoint_shard_read_result_;
+
   /// Total number of journal blobs to read. This is used as a counting
   /// semaphore to allow the last callback to execute the async sequence's
   /// continuation.
@@ -346,6 +454,248 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
 
   JournalId GetCurrentBufferJournalId();
 
+  /// Returns true if the current buffer is the checkpoint one.
+  bool IsCurrentBufferCheckpoint();
+
+  /**
+   * @brief Reads all the shards of a sharded checkpoint concurrently. Once
+   * they are all read, they are handed to OnReadCheckpointBlobCallback as a
+   * single checkpoint blob.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param checkpoint_id The id of the checkpoint.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ReadCheckpointShardBlobs(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      CheckpointId checkpoint_id) noexcept;
+
+  /**
+   * @brief When the read operation is completed on a checkpoint shard blob,
+   * this callback will be called.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param shard_index The index of the shard.
+   * @param get_blob_context The context of the read.
+   */
+  void OnReadCheckpointShardBlobCallback(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      size_t shard_index,
+      AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) noexcept;
+
+  /**
+   * @brief Concatenates the logs of the read checkpoint shards, in the shard
+   * order, followed by the metadata of the first shard.
+   *
+   * @param checkpoint_buffer The buffer of the whole checkpoint.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult MergeCheckpointShards(
+      BytesBuffer& checkpoint_buffer) noexcept;
+
+  /**
+   * @brief Concatenates the full checkpoint and the delta checkpoints read on
+   * top of it, in the order to replay them.
+   *
+   * @param full_checkpoint_buffer The buffer of the full checkpoint.
+   * @return BytesBuffer The buffer of the whole chain.
+   */
+  BytesBuffer MergeCheckpointChain(
+      const BytesBuffer& full_checkpoint_buffer) noexcept;
+
+  /**
+   * @brief Stores a read journal blob into the buffer to process it from,
+   * decompressing it if needed.
+   *
+   * @param get_blob_response The response of the read.
+   * @param bytes_buffer The buffer to store the journal blob into.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  static ExecutionResult StoreJournalBlob(GetBlobResponse& get_blob_response,
+                                          BytesBuffer& bytes_buffer) noexcept;
+
+  /**
+   * @brief With batch reads and prefetching enabled, starts reading the
+   * journals of the batch after the one being processed, if there is one.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   */
+  void PrefetchNextJournalBlobs(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
+  /**
+   * @brief Called when the read of a prefetched journal blob is completed.
+   *
+   * @param get_blob_context The context object of the get blob operation.
+   * @param buffer_index The index of the prefetched buffer to store the blob
+   * into.
+   */
+  void OnPrefetchJournalBlobCallback(
+      AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+      size_t buffer_index) noexcept;
+
+  /**
+   * @brief Records the completion of a prefetch read, and continues the read
+   * log operation waiting for the prefetch if it was the last read.
+   *
+   * @param execution_result The execution result of the read.
+   */
+  void CompletePrefetchRead(const ExecutionResult& execution_result) noexcept;
+
+  /**
+   * @brief Processes the prefetched batch of journals once all of them are
+   * read. If a read is still in flight, the operation continues when it
+   * completes. If any read failed, the batch is read again.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ProcessPrefetchedJournals(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
+  /**
+   * @brief Makes the completed prefetched batch the current one and processes
+   * it.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult InstallPrefetchedJournals(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
+  /**
+   * @brief Lists the journals after last_processed_journal_id_ as
+   * journal_listing_shard_count_ ranges of ids in parallel. Each range is
+   * listed from the blob name of its first id, which the zero padded journal
+   * ids keep in the order of the ids. Once all the ranges are listed, the
+   * ids are handed to OnJournalsListed.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param end_journal_id The last journal id of the last bounded range, the
+   * range after it is listed to the end.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ListJournalShards(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      JournalId end_journal_id) noexcept;
+
+  /**
+   * @brief Lists the next page of journals of a range.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param shard_index The index of the range.
+   * @param start_from The blob to start the list operation from.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ListJournalShard(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      size_t shard_index, const std::shared_ptr<Blob>& start_from) noexcept;
+
+  /**
+   * @brief When the listing of a page of journals of a range is completed,
+   * this callback will be called.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param shard_index The index of the range.
+   * @param list_blobs_context The context object of the list blobs operation.
+   */
+  void OnListJournalShardCallback(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      size_t shard_index,
+      AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+          list_blobs_context) noexcept;
+
+  /**
+   * @brief Records the end of the listing of a range. The last range to end
+   * merges the listed ids into journal_ids_ and continues the read.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param execution_result The execution result of the listing of the range.
+   */
+  void CompleteJournalListingShard(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      const ExecutionResult& execution_result) noexcept;
+
+  /**
+   * @brief Reads the manifest of the journal segments, then continues with
+   * OnJournalsListed. The manifest is read after the journals are listed, so
+   * that it has the segments of any journal deleted before the listing.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ReadJournalSegmentManifest(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context) noexcept;
+
+  /**
+   * @brief When the read operation is completed on the manifest of the journal
+   * segments, this callback will be called.
+   *
+   * @param read_journal_input_stream_context The read journal input stream
+   * context for the operation.
+   * @param get_blob_context The context of the read.
+   */
+  void OnReadJournalSegmentManifestCallback(
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>&
+          read_journal_input_stream_context,
+      AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) noexcept;
+
+  /**
+   * @brief Replaces the listed journals held by a segment with the segment,
+   * which is read as a journal with the id of its last journal. The segments
+   * after the listed journals are left to the next pass.
+   *
+   * @param max_journal_id_to_process The max journal id of the request.
+   * @param max_number_of_journals_to_process The max number of journals of the
+   * request.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ApplyJournalSegments(
+      JournalId max_journal_id_to_process,
+      size_t max_number_of_journals_to_process) noexcept;
+
+  /**
+   * @brief Creates the name of the blob to read a journal id from, the one of
+   * its segment if it is read from one.
+   *
+   * @param journal_id The journal id.
+   * @param blob_name The output blob name.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult CreateJournalOrSegmentBlobName(
+      JournalId journal_id, std::shared_ptr<std::string>& blob_name) noexcept;
+
   std::shared_ptr<ConfigProviderInterface> config_provider_;
 
   size_t journal_ids_window_start_index_;
@@ -354,5 +704,64 @@ class JournalInputStream : public journal_service::JournalInputStreamInterface {
   bool enable_batch_read_journals_;
   size_t number_of_journals_per_batch_;
   size_t number_of_journal_logs_to_return_;
+
+  /// Whether the next batch of journals is read while the current one is
+  /// processed. At most one batch is prefetched, which bounds the memory to
+  /// two batches of journals.
+  bool enable_prefetch_journals_;
+
+  /// Guards the prefetch state below, which the prefetch reads update.
+  std::mutex prefetch_mutex_;
+
+  /// The buffers of the prefetched batch of journals.
+  std::vector<BytesBuffer> prefetched_journal_buffers_;
+
+  /// The number of journals of the prefetched batch, zero if there is none.
+  size_t prefetched_journals_count_;
+
+  /// The number of prefetch reads in flight.
+  size_t pending_prefetch_reads_;
+
+  /// Whether any read of the prefetched batch failed.
+  bool is_any_prefetch_read_failed_;
+
+  /// The read log operation waiting for the prefetch reads to complete.
+  std::optional<
+      AsyncContext<journal_service::JournalStreamReadLogRequest,
+                   journal_service::JournalStreamReadLogResponse>>
+      context_waiting_for_prefetch_;
+
+  /// A range of journal ids listed concurrently with the others.
+  struct JournalListingShard {
+    /// The last journal id of the range.
+    JournalId end_journal_id = kInvalidJournalId;
+    /// The ids of the journals to read listed in the range.
+    std::vector<JournalId> journal_ids;
+  };
+
+  /// The number of journal id ranges the journals following the last
+  /// checkpoint are listed as.
+  size_t journal_listing_shard_count_;
+
+  /// The ranges being listed, in the order of their ids.
+  std::vector<JournalListingShard> journal_listing_shards_;
+
+  /// The number of ranges whose listing did not finish yet. The last one to
+  /// finish continues the read.
+  std::atomic<size_t> pending_journal_listing_shards_;
+
+  /// Whether the listing of any range failed, and the result of the failure.
+  std::atomic<bool> is_any_journal_listing_shard_failed_;
+  std::atomic<ExecutionResult> failed_journal_listing_shard_result_;
+
+  /// Whether the journals may be compacted into segments, which are then read
+  /// instead of the journals they hold.
+  bool enable_journal_segments_;
+
+  /// Whether the manifest of the journal segments is read.
+  bool journal_segments_loaded_ = false;
+
+  /// The first journal id of each journal segment, by its last journal id.
+  std::map<JournalId, JournalId> journal_segments_;
 };
 }  // namespace google::scp::core
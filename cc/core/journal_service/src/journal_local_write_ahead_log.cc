@@ -0,0 +1,230 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "journal_local_write_ahead_log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
+
+#include "error_codes.h"
+
+using google::scp::core::common::kZeroUuid;
+using std::error_code;
+using std::make_shared;
+using std::string;
+using std::vector;
+using std::filesystem::directory_iterator;
+using std::filesystem::path;
+
+namespace {
+constexpr char kJournalLocalWriteAheadLog[] = "JournalLocalWriteAheadLog";
+constexpr char kJournalFileExtension[] = ".journal";
+// The extension of the files being written.
+constexpr char kTemporaryFileExtension[] = ".tmp";
+// The age after which a temporary file is of an interrupted write.
+constexpr std::chrono::minutes kTemporaryFileMaxAge(10);
+
+/// Writes all the bytes to the file descriptor, then syncs them.
+bool WriteAndSync(int file_descriptor, const google::scp::core::Byte* bytes,
+                  size_t length) {
+  while (length > 0) {
+    auto written = write(file_descriptor, bytes, length);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    bytes += written;
+    length -= written;
+  }
+  return fsync(file_descriptor) == 0;
+}
+
+/// Syncs the entries of a directory, so that a rename into it is durable.
+bool SyncDirectory(const string& directory) {
+  int file_descriptor = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (file_descriptor < 0) {
+    return false;
+  }
+  bool is_synced = fsync(file_descriptor) == 0;
+  close(file_descriptor);
+  return is_synced;
+}
+}  // namespace
+
+namespace google::scp::core {
+
+JournalLocalWriteAheadLog::JournalLocalWriteAheadLog(
+    const string& directory, const string& partition_name)
+    : directory_((path(directory) / partition_name).string()) {}
+
+ExecutionResult JournalLocalWriteAheadLog::Init() noexcept {
+  error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    auto execution_result = FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_INIT_FAILED);
+    SCP_ERROR(kJournalLocalWriteAheadLog, kZeroUuid, execution_result,
+              "Cannot create the directory %s: %s", directory_.c_str(),
+              error.message().c_str());
+    return execution_result;
+  }
+
+  for (auto it = directory_iterator(directory_, error);
+       !error && it != directory_iterator(); it.increment(error)) {
+    // The log of the partition may also be open in another process, e.g. the
+    // checkpoint service, so only the files not written for a while are left
+    // over by a crash.
+    if (it->path().extension() != kTemporaryFileExtension) {
+      continue;
+    }
+    error_code file_error;
+    auto last_write_time =
+        std::filesystem::last_write_time(it->path(), file_error);
+    if (!file_error && std::filesystem::file_time_type::clock::now() -
+                               last_write_time >
+                           kTemporaryFileMaxAge) {
+      std::filesystem::remove(it->path(), file_error);
+    }
+  }
+  if (error) {
+    auto execution_result = FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_INIT_FAILED);
+    SCP_ERROR(kJournalLocalWriteAheadLog, kZeroUuid, execution_result,
+              "Cannot list the directory %s: %s", directory_.c_str(),
+              error.message().c_str());
+    return execution_result;
+  }
+  return SuccessExecutionResult();
+}
+
+string JournalLocalWriteAheadLog::GetJournalPath(
+    JournalId journal_id) const noexcept {
+  return (path(directory_) / (std::to_string(journal_id) +
+                              kJournalFileExtension))
+      .string();
+}
+
+ExecutionResult JournalLocalWriteAheadLog::Write(
+    JournalId journal_id, const BytesBuffer& bytes_buffer) noexcept {
+  auto journal_path = GetJournalPath(journal_id);
+  auto temporary_path = journal_path + kTemporaryFileExtension;
+  int file_descriptor =
+      open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+           S_IRUSR | S_IWUSR);
+  if (file_descriptor < 0) {
+    return FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_WRITE_FAILED);
+  }
+
+  const Byte* bytes =
+      bytes_buffer.bytes ? bytes_buffer.bytes->data() : nullptr;
+  bool is_written = WriteAndSync(file_descriptor, bytes, bytes_buffer.length);
+  is_written = close(file_descriptor) == 0 && is_written;
+  if (is_written) {
+    is_written = rename(temporary_path.c_str(), journal_path.c_str()) == 0 &&
+                 SyncDirectory(directory_);
+  }
+  if (!is_written) {
+    error_code error;
+    std::filesystem::remove(temporary_path, error);
+    auto execution_result = FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_WRITE_FAILED);
+    SCP_ERROR(kJournalLocalWriteAheadLog, kZeroUuid, execution_result,
+              "Cannot write the journal %s", journal_path.c_str());
+    return execution_result;
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalLocalWriteAheadLog::Read(
+    JournalId journal_id, BytesBuffer& bytes_buffer) noexcept {
+  std::ifstream input_stream(GetJournalPath(journal_id),
+                             std::ios::binary | std::ios::ate);
+  if (!input_stream) {
+    return FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_READ_FAILED);
+  }
+
+  size_t length = input_stream.tellg();
+  input_stream.seekg(0);
+  bytes_buffer.bytes = make_shared<vector<Byte>>(length);
+  if (length > 0 &&
+      !input_stream.read(reinterpret_cast<char*>(bytes_buffer.bytes->data()),
+                         length)) {
+    return FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_READ_FAILED);
+  }
+  bytes_buffer.length = length;
+  bytes_buffer.capacity = length;
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalLocalWriteAheadLog::Remove(
+    JournalId journal_id) noexcept {
+  error_code error;
+  std::filesystem::remove(GetJournalPath(journal_id), error);
+  if (error) {
+    auto execution_result = FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_WRITE_FAILED);
+    SCP_ERROR(kJournalLocalWriteAheadLog, kZeroUuid, execution_result,
+              "Cannot remove the journal %llu: %s", journal_id,
+              error.message().c_str());
+    return execution_result;
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalLocalWriteAheadLog::ListJournalIds(
+    vector<JournalId>& journal_ids) noexcept {
+  journal_ids.clear();
+  error_code error;
+  for (auto it = directory_iterator(directory_, error);
+       !error && it != directory_iterator(); it.increment(error)) {
+    if (it->path().extension() != kJournalFileExtension) {
+      continue;
+    }
+    auto stem = it->path().stem().string();
+    char* end = nullptr;
+    auto journal_id = strtoull(stem.c_str(), &end, 10);
+    if (stem.empty() || *end != '\0') {
+      continue;
+    }
+    journal_ids.push_back(journal_id);
+  }
+  if (error) {
+    return FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_READ_FAILED);
+  }
+
+  std::sort(journal_ids.begin(), journal_ids.end());
+  return SuccessExecutionResult();
+}
+
+}  // namespace google::scp::core
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/interface/type_def.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core {
+/**
+ * @brief Keeps the journal blobs of a partition on the local disk until they
+ * are written to the blob storage, one file per journal id.
+ *
+ * A journal is durable once Write returns: its file is synced, and renamed
+ * from a temporary file so that a crash never leaves a partial journal. The
+ * journals are removed once written to the blob storage, and the ones left
+ * over by a previous run are written to the blob storage before the recovery
+ * reads them from there.
+ *
+ * The journals only survive as long as the local disk does, so they must be
+ * on a disk that is replicated and follows the partition, e.g. a regional
+ * persistent disk.
+ */
+class JournalLocalWriteAheadLog {
+ public:
+  /**
+   * @brief Constructs the log.
+   *
+   * @param directory The directory of the logs of all the partitions.
+   * @param partition_name The partition the journals are of.
+   */
+  JournalLocalWriteAheadLog(const std::string& directory,
+                            const std::string& partition_name);
+
+  /**
+   * @brief Creates the directory of the partition and removes the temporary
+   * files of the writes interrupted by a crash.
+   *
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Init() noexcept;
+
+  /**
+   * @brief Durably writes the blob of a journal.
+   *
+   * @param journal_id The journal id of the blob.
+   * @param bytes_buffer The bytes of the blob.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Write(JournalId journal_id,
+                        const BytesBuffer& bytes_buffer) noexcept;
+
+  /**
+   * @brief Reads the blob of a journal.
+   *
+   * @param journal_id The journal id of the blob.
+   * @param bytes_buffer Set to the bytes of the blob.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Read(JournalId journal_id,
+                       BytesBuffer& bytes_buffer) noexcept;
+
+  /**
+   * @brief Removes the blob of a journal written to the blob storage. Removing
+   * a journal that is not in the log succeeds.
+   *
+   * @param journal_id The journal id of the blob.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult Remove(JournalId journal_id) noexcept;
+
+  /**
+   * @brief Lists the journals in the log.
+   *
+   * @param journal_ids Set to the journal ids, in ascending order.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ListJournalIds(std::vector<JournalId>& journal_ids) noexcept;
+
+ private:
+  /// Returns the path of the file of the journal.
+  std::string GetJournalPath(JournalId journal_id) const noexcept;
+
+  /// The directory of the journals of the partition.
+  const std::string directory_;
+};
+}  // namespace google::scp::core
@@ -20,8 +20,10 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -36,6 +38,7 @@
 #include "core/journal_service/src/journal_serialization.h"
 #include "core/journal_service/src/journal_utils.h"
 #include "google/protobuf/any.pb.h"
+#include "zlib.h"
 
 using google::scp::core::common::SizedOrTimedBytesBuffer;
 using google::scp::core::common::TimeProvider;
@@ -49,12 +52,15 @@ using google::scp::cpio::MetricClientInterface;
 using std::atomic;
 using std::bind;
 using std::list;
+using std::make_move_iterator;
 using std::make_shared;
 using std::move;
+using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::sort;
 using std::string;
+using std::unique_lock;
 using std::vector;
 using std::chrono::milliseconds;
 using std::placeholders::_1;
@@ -63,6 +69,8 @@ using std::placeholders::_3;
 
 static constexpr absl::string_view kJournalOutputStream = "JournalOutputStream";
 static constexpr absl::string_view kJournalService = "JournalService";
+static constexpr google::scp::core::AsyncTaskTag kWriteBatchTaskTag = {
+    "JournalOutputStream", "WriteBatch"};
 
 namespace google::scp::core {
 
@@ -72,8 +80,16 @@ JournalOutputStream::JournalOutputStream(
     const shared_ptr<AsyncExecutorInterface>& async_executor,
     const shared_ptr<BlobStorageClientInterface>& blob_storage_provider_client,
     const shared_ptr<AggregateMetricInterface>& journal_output_count_metric,
-    std::shared_ptr<core::MetricRouter> metric_router)
-    : current_journal_id_(kInvalidJournalId),
+    std::shared_ptr<core::MetricRouter> metric_router,
+    size_t max_concurrent_blob_writes, size_t blob_compression_level,
+    const shared_ptr<JournalLocalWriteAheadLog>& local_write_ahead_log)
+    : max_concurrent_blob_writes_(
+          max_concurrent_blob_writes == 0 ? 1 : max_concurrent_blob_writes),
+      blob_compression_level_(
+          std::min(blob_compression_level,
+                   static_cast<size_t>(Z_BEST_COMPRESSION))),
+      is_acknowledging_(false),
+      current_journal_id_(kInvalidJournalId),
       bucket_name_(bucket_name),
       partition_name_(partition_name),
       async_executor_(async_executor),
@@ -83,30 +99,34 @@ JournalOutputStream::JournalOutputStream(
       last_persisted_journal_id_(kInvalidJournalId),
       pending_logs_(0),
       logs_queue_(INT32_MAX),
+      local_write_ahead_log_(local_write_ahead_log),
+      pending_local_journal_uploads_(0),
+      are_local_journal_uploads_stopped_(false),
+      blob_buffers_pool_(max_concurrent_blob_writes_),
       activity_id_(Uuid::GenerateUuid()) {
   if (metric_router_) {
     meter_ = metric_router_->GetOrCreateMeter(kJournalService);
 
     journal_scheduled_output_stream_count_instrument_ =
-        std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
-            metric_router_->GetOrCreateSyncInstrument(
-                kMetricNameJournalScheduledOutputStreamCount,
-                [&]() -> std::shared_ptr<
-                          opentelemetry::metrics::SynchronousInstrument> {
-                  return meter_->CreateUInt64Counter(
-                      kMetricNameJournalScheduledOutputStreamCount,
-                      "Scheduled journal output stream count");
-                }));
+        metric_router_->GetOrCreateSyncInstrument<
+            opentelemetry::metrics::Counter<uint64_t>>(
+            kMetricNameJournalScheduledOutputStreamCount,
+            [&]() -> std::shared_ptr<
+                      opentelemetry::metrics::SynchronousInstrument> {
+              return meter_->CreateUInt64Counter(
+                  kMetricNameJournalScheduledOutputStreamCount,
+                  "Scheduled journal output stream count");
+            });
     journal_output_stream_count_instrument_ =
-        std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
-            metric_router_->GetOrCreateSyncInstrument(
-                kMetricNameJournalOutputStreamCount,
-                [&]() -> std::shared_ptr<
-                          opentelemetry::metrics::SynchronousInstrument> {
-                  return meter_->CreateUInt64Counter(
-                      kMetricNameJournalOutputStreamCount,
-                      "Journal output stream count");
-                }));
+        metric_router_->GetOrCreateSyncInstrument<
+            opentelemetry::metrics::Counter<uint64_t>>(
+            kMetricNameJournalOutputStreamCount,
+            [&]() -> std::shared_ptr<
+                      opentelemetry::metrics::SynchronousInstrument> {
+              return meter_->CreateUInt64Counter(
+                  kMetricNameJournalOutputStreamCount,
+                  "Journal output stream count");
+            });
   }
 
   // Output activity for log correlation in debugging purposes.
@@ -185,9 +205,14 @@ size_t JournalOutputStream::GetSerializedLogByteSize(
     AsyncContext<journal_service::JournalStreamAppendLogRequest,
                  journal_service::JournalStreamAppendLogResponse>&
         journal_stream_append_log_context) noexcept {
-  return (
-      journal_stream_append_log_context.request->journal_log->ByteSizeLong() +
-      sizeof(uint64_t) + kLogHeaderByteLength);
+  const auto& request = *journal_stream_append_log_context.request;
+  if (request.log_body) {
+    return JournalSerialization::CalculateJournalLogByteSize(
+               *request.journal_log, request.log_body->length) +
+           kLogHeaderByteLength;
+  }
+  return (request.journal_log->ByteSizeLong() + sizeof(uint64_t) +
+          kLogHeaderByteLength);
 }
 
 ExecutionResult JournalOutputStream::SerializeLog(
@@ -219,10 +244,18 @@ ExecutionResult JournalOutputStream::SerializeLog(
   bytes_serialized += current_bytes_serialized;
   current_bytes_serialized = 0;
 
-  execution_result = JournalSerialization::SerializeJournalLog(
-      bytes_buffer, current_buffer_offset,
-      *journal_stream_append_log_context.request->journal_log,
-      current_bytes_serialized);
+  if (journal_stream_append_log_context.request->log_body) {
+    execution_result = JournalSerialization::SerializeJournalLog(
+        bytes_buffer, current_buffer_offset,
+        *journal_stream_append_log_context.request->journal_log,
+        *journal_stream_append_log_context.request->log_body,
+        current_bytes_serialized);
+  } else {
+    execution_result = JournalSerialization::SerializeJournalLog(
+        bytes_buffer, current_buffer_offset,
+        *journal_stream_append_log_context.request->journal_log,
+        current_bytes_serialized);
+  }
 
   if (!execution_result.Successful()) {
     return execution_result;
@@ -232,13 +265,43 @@ ExecutionResult JournalOutputStream::SerializeLog(
   return SuccessExecutionResult();
 }
 
+shared_ptr<BytesBuffer> JournalOutputStream::AcquireBlobBuffer(
+    size_t capacity) noexcept {
+  shared_ptr<vector<Byte>> bytes;
+  if (!blob_buffers_pool_.TryDequeue(bytes).Successful()) {
+    return make_shared<BytesBuffer>(capacity);
+  }
+
+  if (bytes->size() < capacity) {
+    // Nothing to keep from the previous blob.
+    bytes->clear();
+    bytes->resize(capacity);
+  }
+  auto buffer = make_shared<BytesBuffer>();
+  buffer->bytes = move(bytes);
+  buffer->capacity = buffer->bytes->size();
+  buffer->length = 0;
+  return buffer;
+}
+
+void JournalOutputStream::ReleaseBlobBuffer(
+    shared_ptr<vector<Byte>>& bytes) noexcept {
+  if (!bytes || bytes->size() > kMaxPooledJournalBlobBufferByteSize) {
+    return;
+  }
+  // The pool is full when the blobs are written faster than they are
+  // serialized, then the buffer is simply freed.
+  blob_buffers_pool_.TryEnqueue(bytes);
+  bytes.reset();
+}
+
 ExecutionResult JournalOutputStream::WriteJournalBlob(
     BytesBuffer& bytes_buffer, JournalId journal_id,
     std::function<void(ExecutionResult&)> callback) noexcept {
   SCP_DEBUG(
       kJournalOutputStream, activity_id_,
       "Writing journal blob of byte count: '%llu' for batch with ID '%llu'",
-      bytes_buffer.bytes->size(), journal_id);
+      bytes_buffer.length, journal_id);
 
   if (bytes_buffer.length == 0) {
     auto execution_result = SuccessExecutionResult();
@@ -313,19 +376,26 @@ void JournalOutputStream::OnWriteJournalBlobCallback(
 
     if (metric_router_) {
       journal_output_stream_count_instrument_->Add(
-          1, {{kMetricLabelJournalWriteSuccess, false}});
+          1, journal_write_failure_attributes_);
     }
     journal_output_count_metric_->Increment(
         kMetricEventJournalOutputCountWriteJournalFailureCount);
   } else {
     if (metric_router_) {
       journal_output_stream_count_instrument_->Add(
-          1, {{kMetricLabelJournalWriteSuccess, true}});
+          1, journal_write_success_attributes_);
     }
     journal_output_count_metric_->Increment(
         kMetricEventJournalOutputCountWriteJournalSuccessCount);
   }
 
+  // The write is done with the bytes of the blob, unless the blob storage
+  // client kept a reference to them.
+  if (context.request->buffer &&
+      context.request->buffer->bytes.use_count() == 1) {
+    ReleaseBlobBuffer(context.request->buffer->bytes);
+  }
+
   callback(context.result);
 }
 
@@ -343,14 +413,14 @@ void JournalOutputStream::WriteBatch(
     total_size_needed += GetSerializedLogByteSize(*it);
   }
 
-  auto buffer = make_shared<BytesBuffer>(total_size_needed);
+  auto buffer = AcquireBlobBuffer(total_size_needed);
   size_t total_bytes_serialized = 0;
   for (auto it = flush_batch->begin(); it != flush_batch->end(); ++it) {
     size_t local_total_bytes_serialized = 0;
     auto execution_result =
         SerializeLog(*it, *buffer, local_total_bytes_serialized);
     if (!execution_result.Successful()) {
-      NotifyBatch(flush_batch, execution_result);
+      OnBatchWritten(journal_id, flush_batch, execution_result);
       return;
     }
 
@@ -361,15 +431,301 @@ void JournalOutputStream::WriteBatch(
   if (total_size_needed != total_bytes_serialized) {
     auto execution_result = FailureExecutionResult(
         core::errors::SC_JOURNAL_SERVICE_CORRUPTED_BATCH_OF_LOGS);
-    NotifyBatch(flush_batch, execution_result);
+    OnBatchWritten(journal_id, flush_batch, execution_result);
+    return;
+  }
+
+  if (blob_compression_level_ != kJournalBlobCompressionDisabled &&
+      buffer->length > 0) {
+    auto compressed_buffer = AcquireBlobBuffer(
+        JournalSerialization::CalculateMaxCompressedJournalBlobByteSize(
+            buffer->length));
+    auto execution_result = JournalSerialization::CompressJournalBlob(
+        *buffer, *compressed_buffer, static_cast<int>(blob_compression_level_));
+    if (!execution_result.Successful()) {
+      OnBatchWritten(journal_id, flush_batch, execution_result);
+      return;
+    }
+    // Both formats can be read back, so the smaller blob is written.
+    if (compressed_buffer->length < buffer->length) {
+      ReleaseBlobBuffer(buffer->bytes);
+      buffer = compressed_buffer;
+    } else {
+      ReleaseBlobBuffer(compressed_buffer->bytes);
+    }
+  }
+
+  if (local_write_ahead_log_ && buffer->length > 0) {
+    WriteLocalJournal(buffer, journal_id, flush_batch);
     return;
   }
 
   auto execution_result = WriteJournalBlob(
       *buffer, journal_id,
-      bind(&JournalOutputStream::NotifyBatch, this, flush_batch, _1));
+      bind(&JournalOutputStream::OnBatchWritten, this, journal_id,
+           flush_batch, _1));
   if (!execution_result.Successful()) {
+    OnBatchWritten(journal_id, flush_batch, execution_result);
+  }
+}
+
+void JournalOutputStream::WriteLocalJournal(
+    const shared_ptr<BytesBuffer>& buffer, JournalId journal_id,
+    const shared_ptr<list<AsyncContext<JournalStreamAppendLogRequest,
+                                       JournalStreamAppendLogResponse>>>&
+        flush_batch) noexcept {
+  auto execution_result = local_write_ahead_log_->Write(journal_id, *buffer);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kJournalOutputStream, activity_id_, execution_result,
+              "Cannot write the batch with ID '%llu' to the local write-ahead "
+              "log, writing it to the blob storage before acknowledging it.",
+              journal_id);
+    execution_result = WriteJournalBlob(
+        *buffer, journal_id,
+        bind(&JournalOutputStream::OnBatchWritten, this, journal_id,
+             flush_batch, _1));
+    if (!execution_result.Successful()) {
+      OnBatchWritten(journal_id, flush_batch, execution_result);
+    }
+    return;
+  }
+
+  // The journal id is only persisted once the blob storage has the journal,
+  // so that the checkpoints never skip it.
+  pending_local_journal_uploads_++;
+  AcknowledgeBatch(journal_id, flush_batch, execution_result);
+  UploadLocalJournal(buffer, journal_id);
+}
+
+void JournalOutputStream::UploadLocalJournal(
+    const shared_ptr<BytesBuffer>& buffer, JournalId journal_id) noexcept {
+  auto put_blob_request = make_shared<PutBlobRequest>();
+  put_blob_request->bucket_name = bucket_name_;
+  put_blob_request->buffer = buffer;
+  auto execution_result = JournalUtils::CreateJournalBlobName(
+      partition_name_, journal_id, put_blob_request->blob_name);
+  if (execution_result.Successful()) {
+    if (metric_router_) {
+      journal_scheduled_output_stream_count_instrument_->Add(1);
+    }
+    journal_output_count_metric_->Increment(
+        kMetricEventJournalOutputCountWriteJournalScheduledCount);
+
+    AsyncContext<PutBlobRequest, PutBlobResponse> put_blob_context(
+        move(put_blob_request),
+        bind(&JournalOutputStream::OnLocalJournalUploaded, this, journal_id,
+             _1),
+        activity_id_, activity_id_);
+    execution_result = blob_storage_provider_client_->PutBlob(put_blob_context);
+    if (execution_result.Successful()) {
+      return;
+    }
+  }
+
+  AsyncContext<PutBlobRequest, PutBlobResponse> put_blob_context;
+  put_blob_context.request = make_shared<PutBlobRequest>();
+  put_blob_context.request->buffer = buffer;
+  put_blob_context.result = execution_result;
+  OnLocalJournalUploaded(journal_id, put_blob_context);
+}
+
+void JournalOutputStream::OnLocalJournalUploaded(
+    JournalId journal_id,
+    AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) noexcept {
+  if (!put_blob_context.result.Successful()) {
+    SCP_ERROR(kJournalOutputStream, activity_id_, put_blob_context.result,
+              "Failure in writing the journal [%llu] of the local write-ahead "
+              "log to the blob storage, retrying.",
+              journal_id);
+    if (metric_router_) {
+      journal_output_stream_count_instrument_->Add(
+          1, journal_write_failure_attributes_);
+    }
+    journal_output_count_metric_->Increment(
+        kMetricEventJournalOutputCountWriteJournalFailureCount);
+
+    // Once the uploads are stopped, the journal stays in the local log, and is
+    // written to the blob storage by the next recovery of the partition.
+    bool are_uploads_stopped;
+    {
+      std::lock_guard<mutex> lock(local_journal_uploads_mutex_);
+      are_uploads_stopped = are_local_journal_uploads_stopped_;
+      if (!are_uploads_stopped) {
+        scheduled_local_journal_uploads_[journal_id] = nullptr;
+      }
+    }
+    if (are_uploads_stopped) {
+      FinishLocalJournalUpload();
+      return;
+    }
+
+    auto buffer = put_blob_context.request->buffer;
+    TaskCancellationLambda cancellation_callback;
+    auto execution_result = async_executor_->ScheduleFor(
+        [this, buffer, journal_id]() {
+          RetryLocalJournalUpload(buffer, journal_id);
+        },
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+            kLocalJournalUploadRetryDelayInMilliseconds * 1000000,
+        cancellation_callback);
+    {
+      std::lock_guard<mutex> lock(local_journal_uploads_mutex_);
+      auto scheduled_upload = scheduled_local_journal_uploads_.find(journal_id);
+      // The retry may already have run.
+      if (scheduled_upload != scheduled_local_journal_uploads_.end()) {
+        if (execution_result.Successful()) {
+          scheduled_upload->second = move(cancellation_callback);
+        } else {
+          scheduled_local_journal_uploads_.erase(scheduled_upload);
+        }
+      }
+    }
+    if (!execution_result.Successful()) {
+      SCP_CRITICAL(kJournalOutputStream, activity_id_, execution_result,
+                   "Cannot schedule writing again the journal [%llu] of the "
+                   "local write-ahead log.",
+                   journal_id);
+      FinishLocalJournalUpload();
+    }
+    return;
+  }
+
+  shared_ptr<bool> processed;
+  if (journals_to_persist_.Find(journal_id, processed).Successful()) {
+    *processed = true;
+  }
+  if (metric_router_) {
+    journal_output_stream_count_instrument_->Add(
+        1, journal_write_success_attributes_);
+  }
+  journal_output_count_metric_->Increment(
+      kMetricEventJournalOutputCountWriteJournalSuccessCount);
+
+  // A journal left in the local log is only written again to the blob
+  // storage, under the same name.
+  local_write_ahead_log_->Remove(journal_id);
+
+  if (put_blob_context.request->buffer &&
+      put_blob_context.request->buffer->bytes.use_count() == 1) {
+    ReleaseBlobBuffer(put_blob_context.request->buffer->bytes);
+  }
+  FinishLocalJournalUpload();
+}
+
+void JournalOutputStream::RetryLocalJournalUpload(
+    const shared_ptr<BytesBuffer>& buffer, JournalId journal_id) noexcept {
+  bool are_uploads_stopped;
+  {
+    std::lock_guard<mutex> lock(local_journal_uploads_mutex_);
+    scheduled_local_journal_uploads_.erase(journal_id);
+    are_uploads_stopped = are_local_journal_uploads_stopped_;
+  }
+  if (are_uploads_stopped) {
+    FinishLocalJournalUpload();
+    return;
+  }
+  UploadLocalJournal(buffer, journal_id);
+}
+
+void JournalOutputStream::FinishLocalJournalUpload() noexcept {
+  std::lock_guard<mutex> lock(local_journal_uploads_mutex_);
+  pending_local_journal_uploads_--;
+  local_journal_uploads_condition_.notify_all();
+}
+
+ExecutionResult JournalOutputStream::StopBackgroundWrites() noexcept {
+  unique_lock<mutex> lock(local_journal_uploads_mutex_);
+  are_local_journal_uploads_stopped_ = true;
+  for (auto it = scheduled_local_journal_uploads_.begin();
+       it != scheduled_local_journal_uploads_.end();) {
+    // A retry that could not be cancelled runs and sees the uploads stopped.
+    if (it->second && it->second()) {
+      pending_local_journal_uploads_--;
+      it = scheduled_local_journal_uploads_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  SCP_INFO(kJournalOutputStream, activity_id_,
+           "Waiting for '%llu' journals of the local write-ahead log being "
+           "written to the blob storage.",
+           pending_local_journal_uploads_.load());
+  local_journal_uploads_condition_.wait(
+      lock, [this]() { return pending_local_journal_uploads_.load() == 0; });
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalOutputStream::GetUnpersistedBatchCount(
+    size_t& batch_count) noexcept {
+  // The batch being notified is no longer in the unacknowledged batches, and
+  // a journal of the local write-ahead log is acknowledged before it is
+  // persisted.
+  std::lock_guard<mutex> lock(unacknowledged_batches_mutex_);
+  batch_count = unacknowledged_batches_.size() + (is_acknowledging_ ? 1 : 0) +
+                pending_local_journal_uploads_.load();
+  return SuccessExecutionResult();
+}
+
+void JournalOutputStream::OnBatchWritten(
+    JournalId journal_id,
+    const shared_ptr<list<AsyncContext<JournalStreamAppendLogRequest,
+                                       JournalStreamAppendLogResponse>>>&
+        flush_batch,
+    ExecutionResult& execution_result) noexcept {
+  // Nothing is pending for this journal id anymore, even if the batch failed
+  // before its blob could be written.
+  shared_ptr<bool> processed;
+  if (journals_to_persist_.Find(journal_id, processed).Successful()) {
+    *processed = true;
+  }
+
+  AcknowledgeBatch(journal_id, flush_batch, execution_result);
+}
+
+void JournalOutputStream::AcknowledgeBatch(
+    JournalId journal_id,
+    const shared_ptr<list<AsyncContext<JournalStreamAppendLogRequest,
+                                       JournalStreamAppendLogResponse>>>&
+        flush_batch,
+    ExecutionResult& execution_result) noexcept {
+  unique_lock<mutex> lock(unacknowledged_batches_mutex_);
+  auto batch_it = unacknowledged_batches_.find(journal_id);
+  if (batch_it == unacknowledged_batches_.end()) {
+    // Not created by FlushLogs, so there is no order to keep.
+    lock.unlock();
     NotifyBatch(flush_batch, execution_result);
+    return;
+  }
+  batch_it->second.is_written = true;
+  batch_it->second.execution_result = execution_result;
+
+  // The thread notifying the batches picks this one up when it is its turn.
+  if (is_acknowledging_) {
+    return;
+  }
+  is_acknowledging_ = true;
+
+  vector<UnacknowledgedBatch> written_batches;
+  while (true) {
+    while (!unacknowledged_batches_.empty() &&
+           unacknowledged_batches_.begin()->second.is_written) {
+      written_batches.push_back(
+          move(unacknowledged_batches_.begin()->second));
+      unacknowledged_batches_.erase(unacknowledged_batches_.begin());
+    }
+    if (written_batches.empty()) {
+      is_acknowledging_ = false;
+      return;
+    }
+
+    // The callers are notified without the lock, as they may append again.
+    lock.unlock();
+    for (auto& written_batch : written_batches) {
+      NotifyBatch(written_batch.flush_batch, written_batch.execution_result);
+    }
+    written_batches.clear();
+    lock.lock();
   }
 }
 
@@ -395,53 +751,75 @@ void JournalOutputStream::NotifyBatch(
 }
 
 ExecutionResult JournalOutputStream::FlushLogs() noexcept {
-  // One flush at a time
-  create_batch_of_logs_mutex_.lock();
+  // One batch is formed at a time, but the lock is only held to drain the
+  // queue, so the next batch can be formed while this one is written.
+  unique_lock<mutex> batch_lock(create_batch_of_logs_mutex_);
   size_t batch_size = pending_logs_.load();
   if (batch_size == 0) {
-    create_batch_of_logs_mutex_.unlock();
+    return SuccessExecutionResult();
+  }
+
+  // The logs wait in the queue for one of the batches in flight to be
+  // acknowledged.
+  {
+    unique_lock<mutex> acknowledgement_lock(unacknowledged_batches_mutex_);
+    if (unacknowledged_batches_.size() >= max_concurrent_blob_writes_ ||
+        pending_local_journal_uploads_.load() >=
+            kMaxPendingLocalJournalUploads) {
+      return SuccessExecutionResult();
+    }
+  }
+
+  // The logs of the batch that could not be created last time go first. Then
+  // takes the logs that are already queued. Logs still being enqueued go to
+  // the next batch instead of being waited for.
+  vector<AsyncContext<JournalStreamAppendLogRequest,
+                      JournalStreamAppendLogResponse>>
+      dequeued_logs = move(unbatched_logs_);
+  unbatched_logs_.clear();
+  if (batch_size > dequeued_logs.size()) {
+    logs_queue_.TryDequeueBulk(dequeued_logs,
+                               batch_size - dequeued_logs.size());
+  }
+  if (dequeued_logs.empty()) {
     return SuccessExecutionResult();
   }
 
   auto execution_result = CreateNewBuffer();
   if (!execution_result.Successful()) {
-    create_batch_of_logs_mutex_.unlock();
+    // The logs are kept, still counted as pending, to be retried with the
+    // next flush ahead of the logs queued after them.
+    unbatched_logs_ = move(dequeued_logs);
     return execution_result;
   }
-
+  pending_logs_ -= dequeued_logs.size();
   auto current_journal_id = current_journal_id_;
   auto batch_logs =
       make_shared<list<AsyncContext<JournalStreamAppendLogRequest,
-                                    JournalStreamAppendLogResponse>>>();
-  for (size_t i = 0; i < batch_size;) {
-    AsyncContext<JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>
-        context;
-    if (!logs_queue_.TryDequeue(context).Successful()) {
-      // Cannot increment i until we get all the messages.
-      continue;
-    }
-
-    batch_logs->push_back(context);
-    ++i;
+                                    JournalStreamAppendLogResponse>>>(
+          make_move_iterator(dequeued_logs.begin()),
+          make_move_iterator(dequeued_logs.end()));
+  // Registered before the next batch is created, so that the batches are
+  // acknowledged in journal id order.
+  {
+    unique_lock<mutex> acknowledgement_lock(unacknowledged_batches_mutex_);
+    unacknowledged_batches_[current_journal_id].flush_batch = batch_logs;
   }
-
-  pending_logs_ -= batch_size;
+  batch_lock.unlock();
 
   SCP_DEBUG(kJournalOutputStream, activity_id_,
             "Created a batch of logs with ID: '%llu' of size: '%llu'. "
             "Remaining logs in the queue: '%llu'",
             current_journal_id, batch_logs->size(), pending_logs_.load());
 
-  create_batch_of_logs_mutex_.unlock();
-
   execution_result = async_executor_->Schedule(
       [this, batch_logs, current_journal_id]() {
         WriteBatch(batch_logs, current_journal_id);
       },
-      AsyncPriority::Urgent);
+      AsyncPriority::Urgent, kWriteBatchTaskTag);
 
   if (!execution_result.Successful()) {
-    NotifyBatch(batch_logs, execution_result);
+    OnBatchWritten(current_journal_id, batch_logs, execution_result);
   }
 
   return execution_result;
@@ -17,7 +17,9 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -31,7 +33,9 @@
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/blob_storage_provider_interface.h"
 #include "core/interface/journal_service_interface.h"
+#include "core/interface/metrics_def.h"
 #include "core/journal_service/interface/journal_service_stream_interface.h"
+#include "core/journal_service/src/journal_local_write_ahead_log.h"
 #include "core/journal_service/src/proto/journal_service.pb.h"
 #include "core/telemetry/src/metric/metric_router.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
@@ -41,6 +45,23 @@
 #include "public/cpio/utils/metric_aggregation/interface/aggregate_metric_interface.h"
 
 namespace google::scp::core {
+/// The default maximum number of batches being written or waiting for the
+/// earlier batches to be written.
+static constexpr size_t kDefaultJournalMaxConcurrentBlobWrites = 8;
+/// The buffers of the written journal blobs are reused for the next blobs,
+/// unless they are bigger than this.
+static constexpr size_t kMaxPooledJournalBlobBufferByteSize = 4 * 1024 * 1024;
+/// The zlib compression level of the journal blobs that disables the
+/// compression.
+static constexpr size_t kJournalBlobCompressionDisabled = 0;
+/// The maximum number of batches acknowledged from the local write-ahead log
+/// but not written to the blob storage yet. Flushes wait for room, so that the
+/// local log does not grow while the blob storage is unavailable.
+static constexpr size_t kMaxPendingLocalJournalUploads = 64;
+/// The delay before writing again a journal of the local write-ahead log that
+/// could not be written to the blob storage.
+static constexpr TimeDuration kLocalJournalUploadRetryDelayInMilliseconds =
+    1000;
 
 /*! @copydoc JournalOutputStreamInterface
  */
@@ -55,7 +76,12 @@ class JournalOutputStream
           blob_storage_provider_client,
       const std::shared_ptr<cpio::AggregateMetricInterface>&
           journal_output_metric,
-      std::shared_ptr<core::MetricRouter> metric_router);
+      std::shared_ptr<core::MetricRouter> metric_router,
+      size_t max_concurrent_blob_writes =
+          kDefaultJournalMaxConcurrentBlobWrites,
+      size_t blob_compression_level = kJournalBlobCompressionDisabled,
+      const std::shared_ptr<JournalLocalWriteAheadLog>& local_write_ahead_log =
+          nullptr);
 
   ExecutionResult AppendLog(
       AsyncContext<journal_service::JournalStreamAppendLogRequest,
@@ -65,6 +91,17 @@ class JournalOutputStream
   ExecutionResult GetLastPersistedJournalId(
       JournalId& journal_id) noexcept override;
 
+  /**
+   * @brief Stops writing the journals of the local write-ahead log to the blob
+   * storage. The scheduled retries are cancelled and the writes in flight are
+   * waited for, so that the journals of an unloaded partition are only
+   * written by the next recovery. They stay in the local log until then.
+   */
+  ExecutionResult StopBackgroundWrites() noexcept override;
+
+  ExecutionResult GetUnpersistedBatchCount(
+      size_t& batch_count) noexcept override;
+
   ExecutionResult FlushLogs() noexcept override;
 
  protected:
@@ -114,6 +151,23 @@ class JournalOutputStream
       BytesBuffer& bytes_buffer, uint64_t current_journal_id,
       std::function<void(ExecutionResult&)> callback) noexcept;
 
+  /**
+   * @brief Returns an empty buffer of at least the provided capacity for a
+   * journal blob, reusing the buffer of a written blob when one is available.
+   *
+   * @param capacity The capacity needed.
+   * @return std::shared_ptr<BytesBuffer> The buffer.
+   */
+  std::shared_ptr<BytesBuffer> AcquireBlobBuffer(size_t capacity) noexcept;
+
+  /**
+   * @brief Gives the bytes of a written journal blob back, for the next blobs
+   * to be serialized into.
+   *
+   * @param bytes The bytes of the blob.
+   */
+  void ReleaseBlobBuffer(std::shared_ptr<std::vector<Byte>>& bytes) noexcept;
+
   /**
    * @brief Called when write operation on the journal blob is compeleted.
    *
@@ -150,9 +204,132 @@ class JournalOutputStream
           journal_service::JournalStreamAppendLogResponse>>>& flush_batch,
       JournalId journal_id) noexcept;
 
+  /**
+   * @brief Called when the write of a batch is completed, successfully or not.
+   * Marks the journal id as persisted and acknowledges the batch.
+   *
+   * @param journal_id The journal id of the batch.
+   * @param flush_batch The batch of the async contexts.
+   * @param execution_result The execution result of the write.
+   */
+  void OnBatchWritten(
+      JournalId journal_id,
+      const std::shared_ptr<std::list<core::AsyncContext<
+          journal_service::JournalStreamAppendLogRequest,
+          journal_service::JournalStreamAppendLogResponse>>>& flush_batch,
+      ExecutionResult& execution_result) noexcept;
+
+  /**
+   * @brief Acknowledges a written batch. The batches are written
+   * concurrently, but their callers are notified in journal id order: a batch
+   * is only acknowledged once all the earlier batches are, so a caller never
+   * sees its log persisted before the logs appended before it.
+   *
+   * @param journal_id The journal id of the batch.
+   * @param flush_batch The batch of the async contexts.
+   * @param execution_result The execution result of the write.
+   */
+  void AcknowledgeBatch(
+      JournalId journal_id,
+      const std::shared_ptr<std::list<core::AsyncContext<
+          journal_service::JournalStreamAppendLogRequest,
+          journal_service::JournalStreamAppendLogResponse>>>& flush_batch,
+      ExecutionResult& execution_result) noexcept;
+
+  /**
+   * @brief Writes the blob of a batch to the local write-ahead log and
+   * acknowledges the batch, then writes the blob to the blob storage in the
+   * background. The batch is written to the blob storage before being
+   * acknowledged if the local write fails.
+   *
+   * @param buffer The blob of the batch.
+   * @param journal_id The journal id of the batch.
+   * @param flush_batch The batch of the async contexts.
+   */
+  virtual void WriteLocalJournal(
+      const std::shared_ptr<BytesBuffer>& buffer, JournalId journal_id,
+      const std::shared_ptr<std::list<core::AsyncContext<
+          journal_service::JournalStreamAppendLogRequest,
+          journal_service::JournalStreamAppendLogResponse>>>&
+          flush_batch) noexcept;
+
+  /**
+   * @brief Writes a journal of the local write-ahead log to the blob storage.
+   *
+   * @param buffer The blob of the journal.
+   * @param journal_id The journal id.
+   */
+  virtual void UploadLocalJournal(const std::shared_ptr<BytesBuffer>& buffer,
+                                  JournalId journal_id) noexcept;
+
+  /**
+   * @brief Called when a journal of the local write-ahead log is written to
+   * the blob storage. Only then is the journal id persisted and the journal
+   * removed from the local log. The failed writes are retried until they
+   * succeed or the uploads are stopped, as their batches are already
+   * acknowledged.
+   *
+   * @param journal_id The journal id.
+   * @param put_blob_context The context of the put blob operation.
+   */
+  void OnLocalJournalUploaded(
+      JournalId journal_id,
+      AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) noexcept;
+
+  /**
+   * @brief Writes again a journal of the local write-ahead log to the blob
+   * storage, once its retry is due, unless the uploads were stopped.
+   *
+   * @param buffer The blob of the journal.
+   * @param journal_id The journal id.
+   */
+  void RetryLocalJournalUpload(const std::shared_ptr<BytesBuffer>& buffer,
+                               JournalId journal_id) noexcept;
+
+  /// @brief Called when a journal of the local write-ahead log is not pending
+  /// upload anymore, whether written to the blob storage or left in the log.
+  void FinishLocalJournalUpload() noexcept;
+
   // Mutex to synchronize concurrent batch creations of the pending logs.
   std::mutex create_batch_of_logs_mutex_;
 
+  // The logs of the last batch that could not be created, still counted in
+  // pending_logs_. Guarded by create_batch_of_logs_mutex_.
+  std::vector<
+      core::AsyncContext<journal_service::JournalStreamAppendLogRequest,
+                         journal_service::JournalStreamAppendLogResponse>>
+      unbatched_logs_;
+
+  // A batch that was created but whose callers are not notified yet.
+  struct UnacknowledgedBatch {
+    std::shared_ptr<std::list<core::AsyncContext<
+        journal_service::JournalStreamAppendLogRequest,
+        journal_service::JournalStreamAppendLogResponse>>>
+        flush_batch;
+    // Whether the write of the batch is completed.
+    bool is_written = false;
+    // The result of the write, once completed.
+    ExecutionResult execution_result;
+  };
+
+  // The maximum number of unacknowledged batches. Flushes wait for room, so
+  // the logs pile up into bigger batches while the writes are slow.
+  const size_t max_concurrent_blob_writes_;
+
+  // The zlib compression level of the journal blobs, from 1 (fastest) to 9
+  // (smallest), or kJournalBlobCompressionDisabled to write them uncompressed.
+  const size_t blob_compression_level_;
+
+  // Mutex to protect unacknowledged_batches_ and is_acknowledging_.
+  std::mutex unacknowledged_batches_mutex_;
+
+  // The unacknowledged batches in journal id order.
+  std::map<JournalId, UnacknowledgedBatch> unacknowledged_batches_;
+
+  // Whether a thread is notifying the written batches. Only one thread
+  // notifies at a time so that the notifications stay in order.
+  bool is_acknowledging_;
+
   // The current journal id to write the buffers to.
   JournalId current_journal_id_;
 
@@ -188,6 +365,12 @@ class JournalOutputStream
   std::shared_ptr<opentelemetry::metrics::Counter<uint64_t>>
       journal_output_stream_count_instrument_;
 
+  // The attributes of the journal output stream count, bound once.
+  core::MetricAttributes journal_write_success_attributes_{
+      {kMetricLabelJournalWriteSuccess, true}};
+  core::MetricAttributes journal_write_failure_attributes_{
+      {kMetricLabelJournalWriteSuccess, false}};
+
   // The last persisted journal id by the writer.
   JournalId last_persisted_journal_id_;
 
@@ -207,6 +390,33 @@ class JournalOutputStream
                          journal_service::JournalStreamAppendLogResponse>>
       logs_queue_;
 
+  // The local write-ahead log the batches are acknowledged from, or null to
+  // acknowledge them once written to the blob storage.
+  std::shared_ptr<JournalLocalWriteAheadLog> local_write_ahead_log_;
+
+  // The number of journals of the local write-ahead log not written to the
+  // blob storage yet.
+  std::atomic<size_t> pending_local_journal_uploads_;
+
+  // Guards the state of the uploads of the local write-ahead log below.
+  std::mutex local_journal_uploads_mutex_;
+
+  // Notified whenever pending_local_journal_uploads_ decreases.
+  std::condition_variable local_journal_uploads_condition_;
+
+  // Whether StopBackgroundWrites() was called.
+  bool are_local_journal_uploads_stopped_;
+
+  // The retries of the uploads of the local write-ahead log, by journal id,
+  // with the callbacks to cancel them. The callback is empty while the retry
+  // is being scheduled.
+  std::map<JournalId, TaskCancellationLambda> scheduled_local_journal_uploads_;
+
+  // The bytes of the written journal blobs, to serialize the next blobs into
+  // without allocating.
+  core::common::ConcurrentQueue<std::shared_ptr<std::vector<Byte>>>
+      blob_buffers_pool_;
+
   // Parent activity ID for contexts/operations in this class.
   core::common::Uuid activity_id_;
 };
@@ -27,13 +27,32 @@
 #include "core/journal_service/src/error_codes.h"
 #include "core/journal_service/src/proto/journal_service.pb.h"
 #include "google/protobuf/any.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "public/core/interface/execution_result.h"
+#include "zlib.h"
 
 static constexpr uint64_t kCheckpointMetadataMagicNumber = 0x123456789;
 static constexpr size_t kLogHeaderByteLength =
     3 * sizeof(uint64_t) + sizeof(uint16_t) + 4 * sizeof(uint64_t);
 static constexpr google::scp::core::Version kCurrentVersion = {.major = 1,
                                                                .minor = 0};
+/// The version a compressed journal blob starts with. The logs of the
+/// uncompressed blobs start with kCurrentVersion, so the two formats are told
+/// apart by their first bytes.
+static constexpr google::scp::core::Version kCompressedJournalBlobVersion = {
+    .major = 2, .minor = 0};
+/// A compressed journal blob is stored in the following format:
+/// [V-16B][Uncompressed length-8B][zlib stream of the uncompressed blob]
+static constexpr size_t kCompressedJournalBlobHeaderByteLength =
+    2 * sizeof(uint64_t) + sizeof(uint64_t);
+/// Deflate compresses at most 1032:1, so a blob claiming a larger ratio is
+/// corrupted.
+static constexpr uint64_t kMaxJournalBlobCompressionRatio = 1032;
+/// The max uncompressed length of a compressed journal blob, 1GB, bounding
+/// the allocation made to decompress it.
+static constexpr uint64_t kMaxUncompressedJournalBlobByteLength =
+    1024 * 1024 * 1024;
 
 namespace google::scp::core::journal_service {
 
@@ -135,6 +154,24 @@ class JournalSerialization {
                      bytes_serialized);
   }
 
+  /**
+   * @brief Used to serialize a journal segment manifest into a buffer.
+   *
+   * @param bytes_buffer The bytes buffer to serialize the manifest to.
+   * @param buffer_offset The offset to write the manifest to.
+   * @param journal_segment_manifest The manifest to serialize.
+   * @param bytes_serialized Total bytes serialized after this operation.
+   * @return ExecutionResult The Execution results of the operation.
+   */
+  static ExecutionResult SerializeJournalSegmentManifest(
+      BytesBuffer& bytes_buffer, const size_t buffer_offset,
+      const journal_service::JournalSegmentManifest& journal_segment_manifest,
+      size_t& bytes_serialized) {
+    bytes_serialized = 0;
+    return Serialize(bytes_buffer, buffer_offset, journal_segment_manifest,
+                     bytes_serialized);
+  }
+
   /**
    * @brief Used to serialize a checkpoint metadata object into a buffer.
    *
@@ -206,6 +243,222 @@ class JournalSerialization {
                      bytes_serialized);
   }
 
+  /**
+   * @brief Calculates the serialization length of a journal log whose body is
+   * kept apart from the journal log object.
+   *
+   * @param journal_log The journal log object, with an empty log body.
+   * @param log_body_length The length of the log body.
+   * @return size_t Total bytes required for the serialization of the log.
+   */
+  static size_t CalculateJournalLogByteSize(
+      const journal_service::JournalLog& journal_log,
+      const size_t log_body_length) {
+    return sizeof(uint64_t) + journal_log.ByteSizeLong() +
+           LogBodyFieldByteSize(log_body_length);
+  }
+
+  /**
+   * @brief Used to serialize a journal log object into a buffer, with its log
+   * body copied straight from the given buffer instead of from the journal
+   * log object. The serialized bytes are the same as the ones of the journal
+   * log object carrying the log body, so they deserialize the same way.
+   *
+   * @param bytes_buffer The bytes buffer to serialize the journal log to.
+   * @param buffer_offset The offset to write the journal log to.
+   * @param journal_log The journal log object to serialize, with an empty log
+   * body.
+   * @param log_body The log body.
+   * @param bytes_serialized Total bytes serialized after this operation.
+   * @return ExecutionResult The Execution results of the operation.
+   */
+  static ExecutionResult SerializeJournalLog(
+      BytesBuffer& bytes_buffer, const size_t buffer_offset,
+      const journal_service::JournalLog& journal_log,
+      const BytesBuffer& log_body, size_t& bytes_serialized) {
+    bytes_serialized = 0;
+    if (!journal_log.log_body().empty()) {
+      return FailureExecutionResult(
+          errors::SC_SERIALIZATION_PROTO_SERIALIZATION_FAILED);
+    }
+
+    size_t journal_log_byte_size = journal_log.ByteSizeLong();
+    uint64_t serialized_proto_byte_size =
+        journal_log_byte_size + LogBodyFieldByteSize(log_body.length);
+    if (buffer_offset + sizeof(uint64_t) + serialized_proto_byte_size >
+        bytes_buffer.capacity) {
+      return FailureExecutionResult(
+          errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE);
+    }
+
+    size_t current_bytes_serialized = 0;
+    auto execution_result = core::common::Serialization::Serialize(
+        bytes_buffer, buffer_offset, serialized_proto_byte_size,
+        current_bytes_serialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    // The fields of the journal log precede the log body, so the bytes are in
+    // field number order as if the log body was part of the object.
+    auto* data = reinterpret_cast<uint8_t*>(bytes_buffer.bytes->data() +
+                                            buffer_offset +
+                                            current_bytes_serialized);
+    if (!journal_log.SerializeToArray(data, journal_log_byte_size)) {
+      return FailureExecutionResult(
+          errors::SC_SERIALIZATION_PROTO_SERIALIZATION_FAILED);
+    }
+    // Like for the other fields, an empty log body is not serialized.
+    if (log_body.length > 0) {
+      data += journal_log_byte_size;
+      data = google::protobuf::internal::WireFormatLite::WriteTagToArray(
+          journal_service::JournalLog::kLogBodyFieldNumber,
+          google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+          data);
+      data = google::protobuf::io::CodedOutputStream::WriteVarint64ToArray(
+          log_body.length, data);
+      memcpy(data, log_body.bytes->data(), log_body.length);
+    }
+
+    bytes_serialized = sizeof(uint64_t) + serialized_proto_byte_size;
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Returns true if the journal blob is in the compressed format.
+   *
+   * @param bytes_buffer The bytes of the journal blob.
+   */
+  static bool IsCompressedJournalBlob(const BytesBuffer& bytes_buffer) {
+    Version version;
+    size_t bytes_deserialized = 0;
+    return bytes_buffer.length >= kCompressedJournalBlobHeaderByteLength &&
+           core::common::Serialization::Deserialize(bytes_buffer, 0, version,
+                                                    bytes_deserialized)
+               .Successful() &&
+           version == kCompressedJournalBlobVersion;
+  }
+
+  /**
+   * @brief Returns the maximum length of the compressed journal blob of an
+   * uncompressed journal blob.
+   *
+   * @param uncompressed_length The length of the uncompressed blob.
+   */
+  static size_t CalculateMaxCompressedJournalBlobByteSize(
+      const size_t uncompressed_length) {
+    return kCompressedJournalBlobHeaderByteLength +
+           compressBound(uncompressed_length);
+  }
+
+  /**
+   * @brief Compresses a journal blob into the compressed journal blob format.
+   *
+   * @param uncompressed_bytes_buffer The bytes of the journal blob.
+   * @param compressed_bytes_buffer The bytes buffer to write the compressed
+   * journal blob to. Its capacity must be at least
+   * CalculateMaxCompressedJournalBlobByteSize of the journal blob length.
+   * @param compression_level The zlib compression level, from 1 (fastest) to
+   * 9 (smallest).
+   * @return ExecutionResult The Execution results of the operation.
+   */
+  static ExecutionResult CompressJournalBlob(
+      const BytesBuffer& uncompressed_bytes_buffer,
+      BytesBuffer& compressed_bytes_buffer, const int compression_level) {
+    compressed_bytes_buffer.length = 0;
+    size_t bytes_serialized = 0;
+    auto execution_result = core::common::Serialization::Serialize(
+        compressed_bytes_buffer, 0, kCompressedJournalBlobVersion,
+        bytes_serialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    size_t current_bytes_serialized = 0;
+    uint64_t uncompressed_length = uncompressed_bytes_buffer.length;
+    execution_result = core::common::Serialization::Serialize(
+        compressed_bytes_buffer, bytes_serialized, uncompressed_length,
+        current_bytes_serialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    bytes_serialized += current_bytes_serialized;
+
+    uLongf compressed_length =
+        compressed_bytes_buffer.capacity - bytes_serialized;
+    if (compress2(reinterpret_cast<Bytef*>(
+                      compressed_bytes_buffer.bytes->data() + bytes_serialized),
+                  &compressed_length,
+                  reinterpret_cast<const Bytef*>(
+                      uncompressed_bytes_buffer.bytes->data()),
+                  uncompressed_bytes_buffer.length,
+                  compression_level) != Z_OK) {
+      return FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_BLOB_COMPRESSION_FAILED);
+    }
+
+    compressed_bytes_buffer.length = bytes_serialized + compressed_length;
+    return SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Decompresses a journal blob in the compressed journal blob format.
+   *
+   * @param compressed_bytes_buffer The bytes of the compressed journal blob.
+   * @param uncompressed_bytes_buffer The bytes buffer to write the journal blob
+   * to. It is allocated by this function.
+   * @return ExecutionResult The Execution results of the operation. Fails if
+   * the uncompressed length of the blob is above
+   * kMaxUncompressedJournalBlobByteLength or above the max compression ratio.
+   */
+  static ExecutionResult DecompressJournalBlob(
+      const BytesBuffer& compressed_bytes_buffer,
+      BytesBuffer& uncompressed_bytes_buffer) {
+    if (!IsCompressedJournalBlob(compressed_bytes_buffer)) {
+      return FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB);
+    }
+
+    uint64_t uncompressed_length = 0;
+    size_t bytes_deserialized = 0;
+    auto execution_result = core::common::Serialization::Deserialize(
+        compressed_bytes_buffer, 2 * sizeof(uint64_t), uncompressed_length,
+        bytes_deserialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    // The length is read from the blob, so it is bounded before the buffer is
+    // allocated.
+    uint64_t compressed_length =
+        compressed_bytes_buffer.length - kCompressedJournalBlobHeaderByteLength;
+    if (uncompressed_length > kMaxUncompressedJournalBlobByteLength ||
+        uncompressed_length >
+            compressed_length * kMaxJournalBlobCompressionRatio) {
+      return FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB);
+    }
+
+    uncompressed_bytes_buffer = BytesBuffer(uncompressed_length);
+    uLongf decompressed_length = uncompressed_length;
+    if (uncompress(reinterpret_cast<Bytef*>(
+                       uncompressed_bytes_buffer.bytes->data()),
+                   &decompressed_length,
+                   reinterpret_cast<const Bytef*>(
+                       compressed_bytes_buffer.bytes->data() +
+                       kCompressedJournalBlobHeaderByteLength),
+                   compressed_bytes_buffer.length -
+                       kCompressedJournalBlobHeaderByteLength) != Z_OK ||
+        decompressed_length != uncompressed_length) {
+      uncompressed_bytes_buffer = BytesBuffer();
+      return FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB);
+    }
+
+    uncompressed_bytes_buffer.length = uncompressed_length;
+    return SuccessExecutionResult();
+  }
+
   /**
    * @brief Used to serialize a protobuf object into a buffer.
    *
@@ -374,6 +627,24 @@ class JournalSerialization {
                        bytes_deserialized);
   }
 
+  /**
+   * @brief Used to deserialize a journal segment manifest from a buffer.
+   *
+   * @param bytes_buffer The bytes buffer to deserialize the manifest from.
+   * @param buffer_offset The offset to read the manifest from.
+   * @param journal_segment_manifest The deserialized manifest.
+   * @param bytes_deserialized Total bytes deserialized after this operation.
+   * @return ExecutionResult The Execution results of the operation.
+   */
+  static ExecutionResult DeserializeJournalSegmentManifest(
+      const BytesBuffer& bytes_buffer, const size_t buffer_offset,
+      journal_service::JournalSegmentManifest& journal_segment_manifest,
+      size_t& bytes_deserialized) {
+    bytes_deserialized = 0;
+    return Deserialize(bytes_buffer, buffer_offset, journal_segment_manifest,
+                       bytes_deserialized);
+  }
+
   /**
    * @brief Used to deserialize a checkpoint metadata object into a buffer.
    *
@@ -506,6 +777,20 @@ class JournalSerialization {
     return core::common::Serialization::Deserialize<google::protobuf::Message>(
         bytes_buffer, buffer_offset, object_to_deserialize, bytes_deserialized);
   }
+
+ private:
+  /// Returns the serialization length of the log body field of a journal log.
+  static size_t LogBodyFieldByteSize(const size_t log_body_length) {
+    if (log_body_length == 0) {
+      return 0;
+    }
+    return google::protobuf::internal::WireFormatLite::TagSize(
+               journal_service::JournalLog::kLogBodyFieldNumber,
+               google::protobuf::internal::WireFormatLite::TYPE_BYTES) +
+           google::protobuf::io::CodedOutputStream::VarintSize64(
+               log_body_length) +
+           log_body_length;
+  }
 };
 
 /**
@@ -16,20 +16,28 @@
 
 #include "journal_service.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/interface/configuration_keys.h"
 #include "core/interface/metrics_def.h"
 #include "core/journal_service/src/error_codes.h"
 #include "core/journal_service/src/journal_input_stream.h"
 #include "core/journal_service/src/journal_output_stream.h"
 #include "core/journal_service/src/journal_serialization.h"
+#include "core/journal_service/src/journal_utils.h"
 #include "core/journal_service/src/proto/journal_service.pb.h"
 #include "opentelemetry/context/context.h"
 #include "public/cpio/utils/metric_aggregation/interface/simple_metric_interface.h"
@@ -37,13 +45,17 @@
 #include "public/cpio/utils/metric_aggregation/src/simple_metric.h"
 
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
 using google::scp::core::common::Uuid;
+using google::scp::core::common::UuidCompare;
 using google::scp::core::journal_service::JournalLog;
 using google::scp::core::journal_service::JournalSerialization;
 using google::scp::core::journal_service::JournalStreamAppendLogRequest;
 using google::scp::core::journal_service::JournalStreamAppendLogResponse;
+using google::scp::core::journal_service::JournalStreamReadLogObject;
 using google::scp::core::journal_service::JournalStreamReadLogRequest;
 using google::scp::core::journal_service::JournalStreamReadLogResponse;
+using google::scp::core::journal_service::JournalUtils;
 using google::scp::cpio::kCountUnit;
 using google::scp::cpio::kMillisecondsUnit;
 using google::scp::cpio::MetricClientInterface;
@@ -60,20 +72,27 @@ using google::scp::cpio::TimeEvent;
 using std::atomic;
 using std::bind;
 using std::function;
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
 using std::make_unique;
+using std::map;
 using std::shared_ptr;
 using std::string;
 using std::thread;
 using std::to_string;
+using std::unique_lock;
 using std::unordered_set;
 using std::vector;
+using std::chrono::duration_cast;
 using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
 using std::placeholders::_1;
 using std::this_thread::sleep_for;
 
 static constexpr size_t kMaxWaitTimeForFlushMs = 20;
+static constexpr size_t kDefaultGroupCommitMaxPendingBytes = 1024 * 1024;
 
 static constexpr size_t kStartupWaitIntervalMilliseconds = 100;
 
@@ -188,6 +207,10 @@ ExecutionResult JournalService::Stop() noexcept {
     }
     is_running_ = false;
   }
+  {
+    lock_guard<std::mutex> flush_lock(flush_mutex_);
+    flush_condition_.notify_one();
+  }
 
   RETURN_IF_FAILURE(journal_output_count_metric_->Stop());
 
@@ -195,6 +218,12 @@ ExecutionResult JournalService::Stop() noexcept {
     flushing_thread_->join();
   }
 
+  // Nothing is written to the blob storage for the partition afterwards, its
+  // next owner writes what is left in the local write-ahead log.
+  if (journal_output_stream_) {
+    RETURN_IF_FAILURE(journal_output_stream_->StopBackgroundWrites());
+  }
+
   return SuccessExecutionResult();
 }
 
@@ -209,6 +238,113 @@ ExecutionResult JournalService::Recover(
         journal_recover_context) noexcept {
   shared_ptr<TimeEvent> time_event = make_shared<TimeEvent>();
   auto replayed_log_ids = make_shared<unordered_set<string>>();
+  replayed_log_ids_in_journal_order_.clear();
+  recovered_checkpoint_id_ = kInvalidCheckpointId;
+  recovered_components_ = nullptr;
+  if (journal_recover_context.request->should_track_recovered_components) {
+    recovered_components_ = make_shared<JournalRecoveredComponents>();
+  }
+  if (local_write_ahead_log_) {
+    auto journal_ids = make_shared<vector<JournalId>>();
+    auto execution_result =
+        local_write_ahead_log_->ListJournalIds(*journal_ids);
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(kJournalService, journal_recover_context,
+                        execution_result,
+                        "Cannot list the journals of the local write-ahead "
+                        "log.");
+      return execution_result;
+    }
+    if (!journal_ids->empty()) {
+      SCP_INFO_CONTEXT(kJournalService, journal_recover_context,
+                       "Writing '%zu' journals of the local write-ahead log "
+                       "to the blob storage before recovering.",
+                       journal_ids->size());
+      UploadLocalJournals(time_event, replayed_log_ids,
+                          journal_recover_context, std::move(journal_ids), 0);
+      return SuccessExecutionResult();
+    }
+  }
+  return ReadJournalStream(time_event, replayed_log_ids,
+                           journal_recover_context);
+}
+
+void JournalService::UploadLocalJournals(
+    shared_ptr<TimeEvent> time_event,
+    shared_ptr<unordered_set<string>> replayed_log_ids,
+    AsyncContext<JournalRecoverRequest, JournalRecoverResponse>
+        journal_recover_context,
+    shared_ptr<vector<JournalId>> journal_ids, size_t index) noexcept {
+  if (index == journal_ids->size()) {
+    auto execution_result = ReadJournalStream(time_event, replayed_log_ids,
+                                              journal_recover_context);
+    if (!execution_result.Successful()) {
+      journal_recover_context.result = execution_result;
+      journal_recover_context.Finish();
+    }
+    return;
+  }
+
+  auto journal_id = (*journal_ids)[index];
+  auto put_blob_request = make_shared<PutBlobRequest>();
+  put_blob_request->bucket_name = bucket_name_;
+  put_blob_request->buffer = make_shared<BytesBuffer>();
+  auto execution_result =
+      local_write_ahead_log_->Read(journal_id, *put_blob_request->buffer);
+  if (execution_result.Successful()) {
+    execution_result = JournalUtils::CreateJournalBlobName(
+        partition_name_, journal_id, put_blob_request->blob_name);
+  }
+  if (execution_result.Successful()) {
+    AsyncContext<PutBlobRequest, PutBlobResponse> put_blob_context(
+        std::move(put_blob_request),
+        [this, time_event, replayed_log_ids, journal_recover_context,
+         journal_ids, index, journal_id](
+            AsyncContext<PutBlobRequest, PutBlobResponse>&
+                put_blob_context) mutable {
+          auto execution_result = put_blob_context.result;
+          if (execution_result.Successful()) {
+            execution_result = local_write_ahead_log_->Remove(journal_id);
+          }
+          if (!execution_result.Successful()) {
+            SCP_ERROR_CONTEXT(kJournalService, journal_recover_context,
+                              execution_result,
+                              "Cannot write the journal [%llu] of the local "
+                              "write-ahead log to the blob storage.",
+                              journal_id);
+            journal_recover_context.result = execution_result;
+            journal_recover_context.Finish();
+            return;
+          }
+          UploadLocalJournals(time_event, replayed_log_ids,
+                              journal_recover_context, journal_ids, index + 1);
+        },
+        journal_recover_context);
+    execution_result = blob_storage_provider_client_->PutBlob(put_blob_context);
+    if (execution_result.Successful()) {
+      return;
+    }
+  }
+
+  SCP_ERROR_CONTEXT(kJournalService, journal_recover_context, execution_result,
+                    "Cannot write the journal [%llu] of the local write-ahead "
+                    "log to the blob storage.",
+                    journal_id);
+  journal_recover_context.result = execution_result;
+  journal_recover_context.Finish();
+}
+
+ExecutionResult JournalService::ReadJournalStream(
+    shared_ptr<TimeEvent>& time_event,
+    shared_ptr<unordered_set<string>>& replayed_log_ids,
+    AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&
+        journal_recover_context) noexcept {
+  // The stream of a previous recovery is released once done.
+  if (!journal_input_stream_) {
+    journal_input_stream_ = make_shared<JournalInputStream>(
+        bucket_name_, partition_name_, blob_storage_provider_client_,
+        config_provider_);
+  }
   AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
       journal_stream_read_log_context(
           make_shared<JournalStreamReadLogRequest>(),
@@ -223,6 +359,11 @@ ExecutionResult JournalService::Recover(
       ->should_read_stream_when_only_checkpoint_exists =
       journal_recover_context.request
           ->should_perform_recovery_with_only_checkpoint_in_stream;
+  journal_stream_read_log_context.request->resume_after_journal_id =
+      journal_recover_context.request->resume_after_journal_id;
+  journal_stream_read_log_context.request
+      ->should_stop_at_last_checkpointed_journal =
+      journal_recover_context.request->should_stop_at_last_checkpointed_journal;
 
   SCP_INFO(kJournalService, partition_id_,
            "Starting JournalStreamReadLogRequest. Max journal id to process: "
@@ -264,10 +405,15 @@ void JournalService::OnJournalStreamReadLogCallback(
       journal_recover_context.response = make_shared<JournalRecoverResponse>();
       journal_recover_context.response->last_processed_journal_id =
           journal_input_stream_->GetLastProcessedJournalId();
+      journal_recover_context.response->last_checkpoint_id =
+          recovered_checkpoint_id_;
+      journal_recover_context.response->recovered_components =
+          std::move(recovered_components_);
       journal_output_stream_ = make_shared<JournalOutputStream>(
           bucket_name_, partition_name_, async_executor_,
           blob_storage_provider_client_, journal_output_count_metric_,
-          metric_router_);
+          metric_router_, journal_max_concurrent_blob_writes_,
+          journal_blob_compression_level_, local_write_ahead_log_);
       // Set to nullptr to deallocate the stream and its data.
       journal_input_stream_ = nullptr;
     }
@@ -281,6 +427,8 @@ void JournalService::OnJournalStreamReadLogCallback(
 
   JournalId journal_id = kInvalidJournalId;
   size_t journal_log_counter = 0;
+  vector<RecoveredLogGroup> recovered_log_groups;
+  map<Uuid, size_t, UuidCompare> recovered_log_group_indices;
 
   for (const auto& log : *journal_stream_read_log_context.response->read_logs) {
     if (metric_router_) {
@@ -304,9 +452,11 @@ void JournalService::OnJournalStreamReadLogCallback(
       journal_id = log.journal_id;
     }
     journal_log_counter++;
+    if (log.is_checkpoint_log) {
+      recovered_checkpoint_id_ = log.journal_id;
+    }
 
     OnLogRecoveredCallback callback;
-    auto pair = make_pair(log.component_id, callback);
     auto execution_result = subscribers_map_.Find(log.component_id, callback);
     auto component_id_str = core::common::ToString(log.component_id);
     if (!execution_result.Successful()) {
@@ -330,25 +480,59 @@ void JournalService::OnJournalStreamReadLogCallback(
       continue;
     }
 
-    replayed_log_ids->emplace(log_index);
+    if (recovered_components_) {
+      auto& component_ids =
+          log.is_checkpoint_log
+              ? recovered_components_->checkpoint_component_ids
+              : recovered_components_->journal_component_ids;
+      component_ids.insert(log.component_id);
+    }
+
+    auto replayed_log_id = replayed_log_ids->emplace(log_index).first;
+    if (enable_streaming_replay_) {
+      ForgetReplayedLogIdsBefore(*replayed_log_ids, log.journal_id);
+      replayed_log_ids_in_journal_order_.emplace_back(log.journal_id,
+                                                      &*replayed_log_id);
+    }
+
+    // The logs of the parallel recovery subscribers are grouped by component
+    // and applied together, right before the next log of another subscriber.
+    bool is_parallel_recovery_subscriber = false;
+    if (parallel_recovery_subscribers_map_
+            .Find(log.component_id, is_parallel_recovery_subscriber)
+            .Successful()) {
+      auto [it, inserted] = recovered_log_group_indices.try_emplace(
+          log.component_id, recovered_log_groups.size());
+      if (inserted) {
+        recovered_log_groups.push_back(RecoveredLogGroup{callback, {}});
+      }
+      recovered_log_groups[it->second].logs.push_back(&log);
+      continue;
+    }
 
-    auto bytes_buffer = make_shared<BytesBuffer>(log.journal_log->log_body());
     execution_result =
-        callback(bytes_buffer, journal_recover_context.activity_id);
+        ApplyRecoveredLogGroups(recovered_log_groups, journal_recover_context);
+    recovered_log_groups.clear();
+    recovered_log_group_indices.clear();
+    if (execution_result.Successful()) {
+      execution_result =
+          ApplyRecoveredLog(callback, log, journal_recover_context);
+    }
     if (!execution_result.Successful()) {
-      SCP_ERROR_CONTEXT(
-          kJournalService, journal_recover_context, execution_result,
-          "Cannot handle the journal log with id %s for component id %s. "
-          "Checkpoint/Journal ID where this came from: %llu",
-          ToString(log.log_id).c_str(), component_id_str.c_str(),
-          log.journal_id);
-
       journal_recover_context.result = execution_result;
       journal_recover_context.Finish();
       return;
     }
   }
 
+  if (auto execution_result = ApplyRecoveredLogGroups(recovered_log_groups,
+                                                      journal_recover_context);
+      !execution_result.Successful()) {
+    journal_recover_context.result = execution_result;
+    journal_recover_context.Finish();
+    return;
+  }
+
   if (journal_id != kInvalidJournalId) {
     SCP_INFO_CONTEXT(kJournalService, journal_recover_context,
                      "Replayed '%llu' logs from journal with ID: '%llu'",
@@ -394,9 +578,10 @@ ExecutionResult JournalService::Log(
           journal_log_context);
   journal_stream_append_log_context.request->journal_log =
       make_shared<JournalLog>();
-  journal_stream_append_log_context.request->journal_log->set_log_body(
-      journal_log_context.request->data->bytes->data(),
-      journal_log_context.request->data->length);
+  // The serialized log is written to the journal blob straight from the
+  // caller's buffer.
+  journal_stream_append_log_context.request->log_body =
+      journal_log_context.request->data;
   journal_stream_append_log_context.request->component_id =
       journal_log_context.request->component_id;
   journal_stream_append_log_context.request->log_id =
@@ -404,7 +589,29 @@ ExecutionResult JournalService::Log(
   journal_stream_append_log_context.request->log_status =
       journal_log_context.request->log_status;
 
-  return journal_output_stream_->AppendLog(journal_stream_append_log_context);
+  appended_log_count_++;
+  auto execution_result =
+      journal_output_stream_->AppendLog(journal_stream_append_log_context);
+  if (!execution_result.Successful()) {
+    acknowledged_log_count_++;
+    return execution_result;
+  }
+
+  uint64_t no_pending_log = 0;
+  first_pending_log_timestamp_in_nanoseconds_.compare_exchange_strong(
+      no_pending_log,
+      TimeProvider::GetSteadyTimestampInNanoseconds().count());
+  auto log_bytes = journal_log_context.request->data->length;
+  appended_log_bytes_ += log_bytes;
+  auto pending_bytes = pending_flush_bytes_.fetch_add(log_bytes) + log_bytes;
+  // Only the log crossing the threshold wakes the flushing thread up.
+  if (journal_group_commit_max_pending_bytes_ > 0 &&
+      pending_bytes >= journal_group_commit_max_pending_bytes_ &&
+      pending_bytes - log_bytes < journal_group_commit_max_pending_bytes_) {
+    lock_guard<std::mutex> flush_lock(flush_mutex_);
+    flush_condition_.notify_one();
+  }
+  return execution_result;
 }
 
 void JournalService::OnJournalStreamAppendLogCallback(
@@ -413,6 +620,7 @@ void JournalService::OnJournalStreamAppendLogCallback(
         journal_stream_append_log_context) noexcept {
   journal_log_context.result = journal_stream_append_log_context.result;
   journal_log_context.Finish();
+  acknowledged_log_count_++;
 }
 
 ExecutionResult JournalService::SubscribeForRecovery(
@@ -427,6 +635,19 @@ ExecutionResult JournalService::SubscribeForRecovery(
   return execution_result;
 }
 
+ExecutionResult JournalService::SubscribeForParallelRecovery(
+    const Uuid& component_id, OnLogRecoveredCallback callback) noexcept {
+  auto execution_result = SubscribeForRecovery(component_id, callback);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  auto pair = make_pair(component_id, true);
+  bool is_parallel_recovery_subscriber;
+  return parallel_recovery_subscribers_map_.Insert(
+      pair, is_parallel_recovery_subscriber);
+}
+
 ExecutionResult JournalService::UnsubscribeForRecovery(
     const Uuid& component_id) noexcept {
   if (is_running()) {
@@ -435,9 +656,117 @@ ExecutionResult JournalService::UnsubscribeForRecovery(
   }
 
   auto id = component_id;
+  // The component may not be a parallel recovery subscriber.
+  parallel_recovery_subscribers_map_.Erase(id);
   return subscribers_map_.Erase(id);
 }
 
+void JournalService::ForgetReplayedLogIdsBefore(
+    unordered_set<string>& replayed_log_ids, JournalId journal_id) noexcept {
+  // The journal ids are the wall times of the journals in nanoseconds.
+  auto dedup_window_in_nanoseconds =
+      duration_cast<nanoseconds>(
+          std::chrono::seconds(recovery_dedup_window_in_seconds_))
+          .count();
+  while (!replayed_log_ids_in_journal_order_.empty() &&
+         replayed_log_ids_in_journal_order_.front().first +
+                 dedup_window_in_nanoseconds <
+             journal_id) {
+    // The node based set keeps its elements in place, so the pointer is still
+    // the element.
+    replayed_log_ids.erase(replayed_log_ids.find(
+        *replayed_log_ids_in_journal_order_.front().second));
+    replayed_log_ids_in_journal_order_.pop_front();
+  }
+}
+
+ExecutionResult JournalService::ApplyRecoveredLog(
+    const OnLogRecoveredCallback& callback,
+    const JournalStreamReadLogObject& log,
+    AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&
+        journal_recover_context) noexcept {
+  auto bytes_buffer = make_shared<BytesBuffer>(log.journal_log->log_body());
+  auto execution_result =
+      callback(bytes_buffer, journal_recover_context.activity_id);
+  if (!execution_result.Successful()) {
+    SCP_ERROR_CONTEXT(
+        kJournalService, journal_recover_context, execution_result,
+        "Cannot handle the journal log with id %s for component id %s. "
+        "Checkpoint/Journal ID where this came from: %llu",
+        ToString(log.log_id).c_str(), ToString(log.component_id).c_str(),
+        log.journal_id);
+  }
+  return execution_result;
+}
+
+ExecutionResult JournalService::ApplyRecoveredLogGroups(
+    vector<RecoveredLogGroup>& recovered_log_groups,
+    AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&
+        journal_recover_context) noexcept {
+  // The groups are claimed one at a time by the calling thread and by up to
+  // recovery_apply_concurrency_ - 1 helper tasks. The calling thread keeps
+  // claiming groups until none is left, so it does not depend on the helpers
+  // ever running.
+  struct ApplyState {
+    atomic<size_t> next_group_index{0};
+    size_t remaining_groups = 0;
+    ExecutionResult execution_result = SuccessExecutionResult();
+    std::mutex mutex;
+    std::condition_variable condition;
+  };
+  auto apply_state = make_shared<ApplyState>();
+  apply_state->remaining_groups = recovered_log_groups.size();
+  auto groups_count = recovered_log_groups.size();
+  auto* groups = recovered_log_groups.data();
+
+  auto apply_groups = [this, apply_state, groups_count, groups,
+                       journal_recover_context]() mutable {
+    while (true) {
+      auto group_index = apply_state->next_group_index.fetch_add(1);
+      if (group_index >= groups_count) {
+        return;
+      }
+
+      ExecutionResult execution_result;
+      {
+        unique_lock lock(apply_state->mutex);
+        execution_result = apply_state->execution_result;
+      }
+      // After a failure, the remaining groups are only counted down.
+      auto& group = groups[group_index];
+      for (size_t i = 0; execution_result.Successful() && i < group.logs.size();
+           i++) {
+        execution_result = ApplyRecoveredLog(group.callback, *group.logs[i],
+                                             journal_recover_context);
+      }
+
+      unique_lock lock(apply_state->mutex);
+      if (!execution_result.Successful() &&
+          apply_state->execution_result.Successful()) {
+        apply_state->execution_result = execution_result;
+      }
+      if (--apply_state->remaining_groups == 0) {
+        apply_state->condition.notify_all();
+      }
+    }
+  };
+
+  auto threads_count = std::min(recovery_apply_concurrency_, groups_count);
+  for (size_t i = 1; i < threads_count; i++) {
+    // The calling thread applies the groups that the helpers do not get to.
+    if (!async_executor_->Schedule(apply_groups, AsyncPriority::High)
+             .Successful()) {
+      break;
+    }
+  }
+  apply_groups();
+
+  unique_lock lock(apply_state->mutex);
+  apply_state->condition.wait(
+      lock, [&]() { return apply_state->remaining_groups == 0; });
+  return apply_state->execution_result;
+}
+
 ExecutionResult JournalService::GetLastPersistedJournalId(
     JournalId& journal_id) noexcept {
   if (journal_output_stream_ == nullptr) {
@@ -447,13 +776,144 @@ ExecutionResult JournalService::GetLastPersistedJournalId(
   return journal_output_stream_->GetLastPersistedJournalId(journal_id);
 }
 
+ExecutionResult JournalService::GetLogCounts(
+    size_t& appended_log_count, size_t& acknowledged_log_count) noexcept {
+  // The acknowledged count is read first so that it is never ahead of the
+  // appended one.
+  acknowledged_log_count = acknowledged_log_count_.load();
+  appended_log_count = appended_log_count_.load();
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalService::GetAppendedLogBytes(
+    size_t& appended_log_bytes) noexcept {
+  appended_log_bytes = appended_log_bytes_.load();
+  return SuccessExecutionResult();
+}
+
+ExecutionResult JournalService::PauseFlushing(
+    size_t max_wait_in_milliseconds,
+    JournalId& last_persisted_journal_id) noexcept {
+  if (journal_output_stream_ == nullptr) {
+    return FailureExecutionResult(errors::SC_JOURNAL_SERVICE_NO_OUTPUT_STREAM);
+  }
+
+  {
+    unique_lock<std::mutex> flush_lock(flush_mutex_);
+    if (is_flushing_paused_) {
+      return FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_FLUSHING_ALREADY_PAUSED);
+    }
+    is_flushing_paused_ = true;
+    flushing_done_condition_.wait(flush_lock,
+                                  [this]() { return !is_flushing_; });
+  }
+
+  // No batch is flushed anymore, so the ones in flight only complete. The
+  // logs are applied by their callbacks, once their batch is persisted.
+  size_t unpersisted_batch_count = 0;
+  auto execution_result =
+      journal_output_stream_->GetUnpersistedBatchCount(unpersisted_batch_count);
+  for (size_t waited_in_milliseconds = 0;
+       execution_result.Successful() && unpersisted_batch_count > 0 &&
+       waited_in_milliseconds < max_wait_in_milliseconds;
+       ++waited_in_milliseconds) {
+    sleep_for(milliseconds(1));
+    execution_result = journal_output_stream_->GetUnpersistedBatchCount(
+        unpersisted_batch_count);
+  }
+  if (execution_result.Successful() && unpersisted_batch_count > 0) {
+    execution_result = FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_FLUSHED_LOGS_NOT_PERSISTED);
+  }
+  if (execution_result.Successful()) {
+    execution_result = journal_output_stream_->GetLastPersistedJournalId(
+        last_persisted_journal_id);
+  }
+  if (!execution_result.Successful()) {
+    ResumeFlushing();
+  }
+  return execution_result;
+}
+
+ExecutionResult JournalService::ResumeFlushing() noexcept {
+  lock_guard<std::mutex> flush_lock(flush_mutex_);
+  if (!is_flushing_paused_) {
+    return FailureExecutionResult(
+        errors::SC_JOURNAL_SERVICE_FLUSHING_NOT_PAUSED);
+  }
+  is_flushing_paused_ = false;
+  flush_condition_.notify_one();
+  return SuccessExecutionResult();
+}
+
+bool JournalService::ShouldFlushPendingLogs() noexcept {
+  if (journal_group_commit_max_pending_bytes_ > 0 &&
+      pending_flush_bytes_.load() >= journal_group_commit_max_pending_bytes_) {
+    return true;
+  }
+
+  auto first_pending_log_timestamp =
+      first_pending_log_timestamp_in_nanoseconds_.load();
+  return first_pending_log_timestamp != 0 &&
+         TimeProvider::GetSteadyTimestampInNanoseconds().count() -
+                 first_pending_log_timestamp >=
+             static_cast<uint64_t>(
+                 duration_cast<nanoseconds>(
+                     milliseconds(
+                         journal_group_commit_max_latency_in_milliseconds_))
+                     .count());
+}
+
 void JournalService::FlushJournalOutputStream() noexcept {
+  // Group commit: the logs are flushed as soon as enough bytes are pending or
+  // the oldest of them reached the max latency, whichever comes first. At low
+  // load this bounds the latency, and at high load it makes bigger batches.
+  auto max_latency =
+      milliseconds(journal_group_commit_max_latency_in_milliseconds_);
   while (is_running()) {
+    {
+      unique_lock<std::mutex> flush_lock(flush_mutex_);
+      // While paused, the logs keep piling up in the output stream.
+      flush_condition_.wait(flush_lock, [this]() {
+        return !is_running() || !is_flushing_paused_;
+      });
+      auto first_pending_log_timestamp =
+          first_pending_log_timestamp_in_nanoseconds_.load();
+      // With nothing pending, the next log waits at most one max latency.
+      auto deadline =
+          first_pending_log_timestamp == 0
+              ? steady_clock::now() + max_latency
+              : steady_clock::time_point(
+                    duration_cast<steady_clock::duration>(
+                        nanoseconds(first_pending_log_timestamp))) +
+                    max_latency;
+      flush_condition_.wait_until(flush_lock, deadline, [this]() {
+        return !is_running() || is_flushing_paused_ ||
+               ShouldFlushPendingLogs();
+      });
+      if (!is_running()) {
+        break;
+      }
+      if (is_flushing_paused_) {
+        continue;
+      }
+      is_flushing_ = true;
+    }
+
+    // Also flushes when the deadline passed with nothing appended, for the
+    // logs a previous flush left in the output stream.
+    pending_flush_bytes_ = 0;
+    first_pending_log_timestamp_in_nanoseconds_ = 0;
     if (journal_output_stream_) {
       while (!journal_output_stream_->FlushLogs().Successful()) {}
     }
 
-    sleep_for(milliseconds(journal_flush_interval_in_milliseconds_));
+    {
+      lock_guard<std::mutex> flush_lock(flush_mutex_);
+      is_flushing_ = false;
+    }
+    flushing_done_condition_.notify_all();
   }
 }
 
@@ -508,11 +968,84 @@ ExecutionResult JournalService::InitMetricClientInterface() {
     journal_flush_interval_in_milliseconds_ = kMaxWaitTimeForFlushMs;
   }
 
+  // The flush interval is the max latency unless it is configured separately.
+  if (!config_provider_
+           ->Get(kPBSJournalServiceGroupCommitMaxLatencyInMilliseconds,
+                 journal_group_commit_max_latency_in_milliseconds_)
+           .Successful()) {
+    journal_group_commit_max_latency_in_milliseconds_ =
+        journal_flush_interval_in_milliseconds_;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalServiceGroupCommitMaxPendingBytes,
+                 journal_group_commit_max_pending_bytes_)
+           .Successful()) {
+    journal_group_commit_max_pending_bytes_ =
+        kDefaultGroupCommitMaxPendingBytes;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalServiceMaxConcurrentBlobWrites,
+                 journal_max_concurrent_blob_writes_)
+           .Successful()) {
+    journal_max_concurrent_blob_writes_ =
+        kDefaultJournalMaxConcurrentBlobWrites;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalServiceBlobCompressionLevel,
+                 journal_blob_compression_level_)
+           .Successful()) {
+    journal_blob_compression_level_ = kJournalBlobCompressionDisabled;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalInputStreamEnableStreamingReplay,
+                 enable_streaming_replay_)
+           .Successful()) {
+    enable_streaming_replay_ = false;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalServiceRecoveryDedupWindowInSeconds,
+                 recovery_dedup_window_in_seconds_)
+           .Successful()) {
+    recovery_dedup_window_in_seconds_ =
+        kDefaultJournalServiceRecoveryDedupWindowInSeconds;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalServiceRecoveryApplyConcurrency,
+                 recovery_apply_concurrency_)
+           .Successful()) {
+    recovery_apply_concurrency_ =
+        kDefaultJournalServiceRecoveryApplyConcurrency;
+  }
+
+  string local_write_ahead_log_directory;
+  if (config_provider_
+          ->Get(kPBSJournalServiceLocalWriteAheadLogDirectory,
+                local_write_ahead_log_directory)
+          .Successful() &&
+      !local_write_ahead_log_directory.empty()) {
+    local_write_ahead_log_ = make_shared<JournalLocalWriteAheadLog>(
+        local_write_ahead_log_directory, *partition_name_);
+    execution_result = local_write_ahead_log_->Init();
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+
   SCP_INFO(
       kJournalService, partition_id_,
       "Starting Journal Service for Partition with ID: '%s'. Flush interval "
-      "%zu milliseconds, Metric aggregating at every '%llu' ms",
+      "%zu milliseconds, %zu concurrent blob writes, blob compression level "
+      "%zu, local write-ahead log directory '%s', Metric aggregating at every "
+      "'%llu' ms",
       ToString(partition_id_).c_str(), journal_flush_interval_in_milliseconds_,
+      journal_max_concurrent_blob_writes_, journal_blob_compression_level_,
+      local_write_ahead_log_directory.c_str(),
       metric_aggregation_interval_milliseconds);
 
   return execution_result;
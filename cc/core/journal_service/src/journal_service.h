@@ -16,9 +16,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "absl/base/nullability.h"
 #include "core/common/operation_dispatcher/src/operation_dispatcher.h"
@@ -29,6 +35,7 @@
 #include "core/interface/journal_service_interface.h"
 #include "core/interface/partition_types.h"
 #include "core/journal_service/interface/journal_service_stream_interface.h"
+#include "core/journal_service/src/journal_local_write_ahead_log.h"
 #include "core/telemetry/src/metric/metric_router.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
 #include "opentelemetry/metrics/meter.h"
@@ -41,6 +48,12 @@
 static constexpr google::scp::core::TimeDuration
     kJournalServiceRetryStrategyDelayMs = 31;
 static constexpr size_t kJournalServiceRetryStrategyTotalRetries = 12;
+// The default maximum number of threads applying recovered logs concurrently.
+static constexpr size_t kDefaultJournalServiceRecoveryApplyConcurrency = 4;
+// The default window of the recovered logs deduplication with streaming
+// replay. It covers the retries of the failed appends.
+static constexpr size_t kDefaultJournalServiceRecoveryDedupWindowInSeconds =
+    600;
 
 namespace google::scp::core {
 
@@ -67,11 +80,29 @@ class JournalService : public JournalServiceInterface {
             async_executor,
             common::RetryStrategy(common::RetryStrategyType::Exponential,
                                   kJournalServiceRetryStrategyDelayMs,
-                                  kJournalServiceRetryStrategyTotalRetries)),
+                                  kJournalServiceRetryStrategyTotalRetries,
+                                  common::kDefaultRetryStrategyJitterRatio),
+            std::make_shared<common::RetryBudget>()),
         metric_client_(metric_client),
         metric_router_(metric_router),
         config_provider_(config_provider),
-        journal_flush_interval_in_milliseconds_(0) {}
+        journal_flush_interval_in_milliseconds_(0),
+        journal_max_concurrent_blob_writes_(0),
+        journal_blob_compression_level_(0),
+        journal_group_commit_max_pending_bytes_(0),
+        journal_group_commit_max_latency_in_milliseconds_(0),
+        recovery_apply_concurrency_(
+            kDefaultJournalServiceRecoveryApplyConcurrency),
+        enable_streaming_replay_(false),
+        recovery_dedup_window_in_seconds_(
+            kDefaultJournalServiceRecoveryDedupWindowInSeconds),
+        pending_flush_bytes_(0),
+        first_pending_log_timestamp_in_nanoseconds_(0),
+        appended_log_count_(0),
+        acknowledged_log_count_(0),
+        appended_log_bytes_(0),
+        is_flushing_paused_(false),
+        is_flushing_(false) {}
 
   ExecutionResult Init() noexcept override;
 
@@ -94,13 +125,108 @@ class JournalService : public JournalServiceInterface {
       const common::Uuid& component_id,
       OnLogRecoveredCallback callback) noexcept override;
 
+  ExecutionResult SubscribeForParallelRecovery(
+      const common::Uuid& component_id,
+      OnLogRecoveredCallback callback) noexcept override;
+
   ExecutionResult UnsubscribeForRecovery(
       const common::Uuid& component_id) noexcept override;
 
   ExecutionResult GetLastPersistedJournalId(
       JournalId& journal_id) noexcept override;
 
+  ExecutionResult GetLogCounts(
+      size_t& appended_log_count,
+      size_t& acknowledged_log_count) noexcept override;
+
+  ExecutionResult GetAppendedLogBytes(
+      size_t& appended_log_bytes) noexcept override;
+
+  ExecutionResult PauseFlushing(
+      size_t max_wait_in_milliseconds,
+      JournalId& last_persisted_journal_id) noexcept override;
+
+  ExecutionResult ResumeFlushing() noexcept override;
+
  protected:
+  /// The recovered logs of a component subscribed for parallel recovery, in
+  /// order.
+  struct RecoveredLogGroup {
+    OnLogRecoveredCallback callback;
+    std::vector<const journal_service::JournalStreamReadLogObject*> logs;
+  };
+
+  /**
+   * @brief Applies the groups of recovered logs, concurrently with up to
+   * recovery_apply_concurrency_ threads including the calling one. Returns once
+   * all the groups are applied or one of them failed.
+   *
+   * @param recovered_log_groups The groups of logs to apply.
+   * @param journal_recover_context The context of the recovery operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ApplyRecoveredLogGroups(
+      std::vector<RecoveredLogGroup>& recovered_log_groups,
+      AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&
+          journal_recover_context) noexcept;
+
+  /**
+   * @brief Applies a recovered log to its subscriber.
+   *
+   * @param callback The callback of the subscriber.
+   * @param log The recovered log.
+   * @param journal_recover_context The context of the recovery operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ApplyRecoveredLog(
+      const OnLogRecoveredCallback& callback,
+      const journal_service::JournalStreamReadLogObject& log,
+      AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&
+          journal_recover_context) noexcept;
+
+  /**
+   * @brief With streaming replay, forgets the replayed log ids of the
+   * journals older than the dedup window before the given journal.
+   *
+   * @param replayed_log_ids The replayed log ids.
+   * @param journal_id The journal of the log being replayed.
+   */
+  void ForgetReplayedLogIdsBefore(
+      std::unordered_set<std::string>& replayed_log_ids,
+      JournalId journal_id) noexcept;
+
+  /**
+   * @brief Starts reading the journal stream of the recovery.
+   *
+   * @param time_event The time event of the recovery.
+   * @param replayed_logs The logs already replayed by the recovery.
+   * @param journal_recover_context The context of the recovery operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult ReadJournalStream(
+      std::shared_ptr<cpio::TimeEvent>& time_event,
+      std::shared_ptr<std::unordered_set<std::string>>& replayed_logs,
+      AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&
+          journal_recover_context) noexcept;
+
+  /**
+   * @brief Writes the journals left in the local write-ahead log to the blob
+   * storage one at a time, then reads the journal stream of the recovery.
+   *
+   * @param time_event The time event of the recovery.
+   * @param replayed_logs The logs already replayed by the recovery.
+   * @param journal_recover_context The context of the recovery operation.
+   * @param journal_ids The journal ids left in the local write-ahead log.
+   * @param index The index of the next journal id to write.
+   */
+  void UploadLocalJournals(
+      std::shared_ptr<cpio::TimeEvent> time_event,
+      std::shared_ptr<std::unordered_set<std::string>> replayed_logs,
+      AsyncContext<JournalRecoverRequest, JournalRecoverResponse>
+          journal_recover_context,
+      std::shared_ptr<std::vector<JournalId>> journal_ids,
+      size_t index) noexcept;
+
   /**
    * @brief Is called after the read log operation is completed.
    *
@@ -138,6 +264,10 @@ class JournalService : public JournalServiceInterface {
   // Flushes the current output stream.
   virtual void FlushJournalOutputStream() noexcept;
 
+  // Whether the logs appended since the last flush are due to be flushed by
+  // the group commit policy.
+  bool ShouldFlushPendingLogs() noexcept;
+
   bool is_running() {
     std::lock_guard<std::mutex> lock(mutex_);
     return is_running_;
@@ -181,6 +311,10 @@ class JournalService : public JournalServiceInterface {
                         common::UuidCompare>
       subscribers_map_;
 
+  // The subscribers whose logs can be applied concurrently.
+  common::ConcurrentMap<common::Uuid, bool, common::UuidCompare>
+      parallel_recovery_subscribers_map_;
+
   // Metric client instance for custom metric recording.
   std::shared_ptr<cpio::MetricClientInterface> metric_client_;
 
@@ -224,6 +358,68 @@ class JournalService : public JournalServiceInterface {
   // Journal flush interval
   size_t journal_flush_interval_in_milliseconds_;
 
+  // The maximum number of journal batches written concurrently.
+  size_t journal_max_concurrent_blob_writes_;
+
+  // The compression level of the journal blobs, zero if uncompressed.
+  size_t journal_blob_compression_level_;
+
+  // The local write-ahead log of the batches, or null if disabled.
+  std::shared_ptr<JournalLocalWriteAheadLog> local_write_ahead_log_;
+
+  // Group commit: the logs are flushed once this many bytes are pending. Zero
+  // disables the size trigger.
+  size_t journal_group_commit_max_pending_bytes_;
+
+  // Group commit: the logs are flushed once the oldest of them waited this
+  // long.
+  size_t journal_group_commit_max_latency_in_milliseconds_;
+
+  // The maximum number of threads applying recovered logs concurrently.
+  size_t recovery_apply_concurrency_;
+
+  // Whether the replayed log ids are only kept for the dedup window.
+  bool enable_streaming_replay_;
+
+  // With streaming replay, the window of the replayed log ids in seconds.
+  size_t recovery_dedup_window_in_seconds_;
+
+  // With streaming replay, the journal of each replayed log id, oldest first.
+  // The pointers are to the elements of the replayed log ids set.
+  std::deque<std::pair<JournalId, const std::string*>>
+      replayed_log_ids_in_journal_order_;
+
+  // The id of the checkpoint the ongoing recovery started from.
+  CheckpointId recovered_checkpoint_id_ = kInvalidCheckpointId;
+
+  // The components of the logs of the ongoing recovery, if the recovery
+  // request asked to track them.
+  std::shared_ptr<JournalRecoveredComponents> recovered_components_;
+
+  // The bytes of the logs appended since the last flush.
+  std::atomic<size_t> pending_flush_bytes_;
+
+  // The steady clock time of the first log appended since the last flush, or
+  // zero if there is none.
+  std::atomic<uint64_t> first_pending_log_timestamp_in_nanoseconds_;
+
+  // The number of logs appended through Log(), and the number of those whose
+  // callback was invoked.
+  std::atomic<size_t> appended_log_count_;
+  std::atomic<size_t> acknowledged_log_count_;
+  // The number of bytes of the logs appended through Log().
+  std::atomic<size_t> appended_log_bytes_;
+
+  // Wakes the flushing thread up when a flush is due before the deadline.
+  std::mutex flush_mutex_;
+  std::condition_variable flush_condition_;
+  // Whether the flushing is paused by PauseFlushing(), and whether the
+  // flushing thread is flushing. Protected by flush_mutex_.
+  bool is_flushing_paused_;
+  bool is_flushing_;
+  // Notified when the flushing thread is done flushing.
+  std::condition_variable flushing_done_condition_;
+
  private:
   // Initialize MetricClient.
   //
@@ -26,10 +26,14 @@
 
 static constexpr char kCheckpointBlobNamePrefix[] = "checkpoint_";
 static constexpr size_t kCheckpointBlobNamePrefixLength = 11;
+static constexpr char kCheckpointShardBlobNameSeparator[] = "_";
 
 static constexpr char kJournalBlobNamePrefix[] = "journal_";
 static constexpr size_t kJournalBlobNamePrefixLength = 8;
 
+static constexpr char kJournalSegmentBlobNamePrefix[] = "segment_";
+static constexpr char kJournalSegmentManifestBlobName[] = "segment_manifest";
+
 static constexpr size_t kZerosInSuffix = 20;
 
 namespace google::scp::core::journal_service {
@@ -52,6 +56,34 @@ class JournalUtils {
                                       checkpoint_id, checkpoint_blob_name);
   }
 
+  /**
+   * @brief Creates the blob name of a checkpoint shard. The first shard has
+   * the name of an unsharded checkpoint, and the other ones have the shard
+   * index appended to it.
+   *
+   * @param partition_name The partition name to create the blob name.
+   * @param checkpoint_id The checkpoint id to create the blob name.
+   * @param shard_index The index of the shard.
+   * @param checkpoint_shard_blob_name The output blob name.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  static ExecutionResult CreateCheckpointShardBlobName(
+      const std::shared_ptr<std::string>& partition_name,
+      const CheckpointId& checkpoint_id, size_t shard_index,
+      std::shared_ptr<std::string>& checkpoint_shard_blob_name) noexcept {
+    auto execution_result = CreateCheckpointBlobName(
+        partition_name, checkpoint_id, checkpoint_shard_blob_name);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    if (shard_index > 0) {
+      checkpoint_shard_blob_name->append(kCheckpointShardBlobNameSeparator);
+      checkpoint_shard_blob_name->append(std::to_string(shard_index));
+    }
+    return SuccessExecutionResult();
+  }
+
   /**
    * @brief Creates journal blob name.
    *
@@ -68,6 +100,24 @@ class JournalUtils {
                                       journal_id, journal_blob_name);
   }
 
+  /**
+   * @brief Creates the blob name of a journal segment, after the last journal
+   * it holds.
+   *
+   * @param partition_name The partition name to create the blob name.
+   * @param last_journal_id The id of the last journal of the segment.
+   * @param segment_blob_name The output blob name.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  static ExecutionResult CreateJournalSegmentBlobName(
+      const std::shared_ptr<std::string>& partition_name,
+      const JournalId& last_journal_id,
+      std::shared_ptr<std::string>& segment_blob_name) noexcept {
+    return CreateBlobNameWithSuffixId(partition_name,
+                                      kJournalSegmentBlobNamePrefix,
+                                      last_journal_id, segment_blob_name);
+  }
+
   /**
    * @brief Creates a blob with suffix id.
    *
@@ -0,0 +1,215 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/journal_service/src/journal_compactor.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/blob_storage_provider/mock/mock_blob_storage_provider.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/journal_service/src/journal_serialization.h"
+#include "core/journal_service/src/journal_utils.h"
+#include "core/journal_service/src/proto/journal_service.pb.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::blob_storage_provider::mock::MockBlobStorageClient;
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::journal_service::JournalSegmentManifest;
+using google::scp::core::journal_service::JournalSerialization;
+using google::scp::core::journal_service::JournalUtils;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::filesystem::path;
+
+namespace google::scp::core::test {
+
+class JournalCompactorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ =
+        path(testing::TempDir()) /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directories(directory_ / kPartitionName);
+    bucket_name_ = make_shared<string>(directory_.string());
+    partition_name_ = make_shared<string>(kPartitionName);
+    blob_storage_client_ = make_shared<MockBlobStorageClient>();
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  path GetJournalPath(JournalId journal_id) {
+    shared_ptr<string> blob_name;
+    JournalUtils::CreateJournalBlobName(partition_name_, journal_id, blob_name);
+    return directory_ / *blob_name;
+  }
+
+  path GetSegmentPath(JournalId last_journal_id) {
+    shared_ptr<string> blob_name;
+    JournalUtils::CreateJournalSegmentBlobName(partition_name_,
+                                               last_journal_id, blob_name);
+    return directory_ / *blob_name;
+  }
+
+  static void WriteFile(const path& file_path, const string& content) {
+    std::ofstream output_stream(file_path, std::ios::binary);
+    output_stream << content;
+  }
+
+  static string ReadFile(const path& file_path) {
+    std::ifstream input_stream(file_path, std::ios::binary);
+    return string(std::istreambuf_iterator<char>(input_stream), {});
+  }
+
+  void WriteManifest(const JournalSegmentManifest& manifest) {
+    size_t byte_size = 0;
+    JournalSerialization::CalculateSerializationByteSize(manifest, byte_size);
+    BytesBuffer bytes_buffer(byte_size);
+    JournalSerialization::SerializeJournalSegmentManifest(
+        bytes_buffer, 0, manifest, bytes_buffer.length);
+    WriteFile(directory_ / kPartitionName / kJournalSegmentManifestBlobName,
+              bytes_buffer.ToString());
+  }
+
+  JournalSegmentManifest ReadManifest() {
+    JournalSegmentManifest manifest;
+    BytesBuffer bytes_buffer(ReadFile(directory_ / kPartitionName /
+                                      kJournalSegmentManifestBlobName));
+    size_t bytes_deserialized = 0;
+    JournalSerialization::DeserializeJournalSegmentManifest(
+        bytes_buffer, 0, manifest, bytes_deserialized);
+    return manifest;
+  }
+
+  JournalCompactor CreateCompactor(size_t journals_per_segment,
+                                   size_t blob_compression_level = 0) {
+    return JournalCompactor(bucket_name_, partition_name_,
+                            blob_storage_client_, journals_per_segment,
+                            blob_compression_level, kZeroUuid);
+  }
+
+  static constexpr char kPartitionName[] = "partition";
+
+  path directory_;
+  shared_ptr<string> bucket_name_;
+  shared_ptr<string> partition_name_;
+  shared_ptr<MockBlobStorageClient> blob_storage_client_;
+};
+
+TEST_F(JournalCompactorTest, CompactsFullSegmentsAndDeletesTheirJournals) {
+  WriteFile(GetJournalPath(10), "z");
+  WriteFile(GetJournalPath(11), "a");
+  WriteFile(GetJournalPath(12), "b");
+  WriteFile(GetJournalPath(13), "c");
+  WriteFile(GetJournalPath(14), "d");
+  WriteFile(GetJournalPath(15), "e");
+  WriteFile(GetJournalPath(16), "f");
+
+  size_t compacted_journal_count = 0;
+  EXPECT_SUCCESS(CreateCompactor(2).Compact(10, 15, compacted_journal_count));
+  EXPECT_EQ(compacted_journal_count, 4);
+
+  EXPECT_EQ(ReadFile(GetSegmentPath(12)), "ab");
+  EXPECT_EQ(ReadFile(GetSegmentPath(14)), "cd");
+  // The journals up to the last checkpoint, the ones after the max journal id
+  // and the ones short of a full segment are left.
+  EXPECT_TRUE(std::filesystem::exists(GetJournalPath(10)));
+  EXPECT_TRUE(std::filesystem::exists(GetJournalPath(15)));
+  EXPECT_TRUE(std::filesystem::exists(GetJournalPath(16)));
+  for (JournalId journal_id = 11; journal_id <= 14; ++journal_id) {
+    EXPECT_FALSE(std::filesystem::exists(GetJournalPath(journal_id)));
+  }
+
+  auto manifest = ReadManifest();
+  ASSERT_EQ(manifest.segments_size(), 2);
+  EXPECT_EQ(manifest.segments(0).first_journal_id(), 11);
+  EXPECT_EQ(manifest.segments(0).last_journal_id(), 12);
+  EXPECT_EQ(manifest.segments(1).first_journal_id(), 13);
+  EXPECT_EQ(manifest.segments(1).last_journal_id(), 14);
+}
+
+TEST_F(JournalCompactorTest, MergesCompressedJournalsIntoCompressedSegments) {
+  BytesBuffer uncompressed_buffer(string("compressed"));
+  BytesBuffer compressed_buffer(
+      JournalSerialization::CalculateMaxCompressedJournalBlobByteSize(
+          uncompressed_buffer.length));
+  EXPECT_SUCCESS(JournalSerialization::CompressJournalBlob(
+      uncompressed_buffer, compressed_buffer, 6));
+  WriteFile(GetJournalPath(11), compressed_buffer.ToString());
+  WriteFile(GetJournalPath(12), "uncompressed");
+
+  size_t compacted_journal_count = 0;
+  EXPECT_SUCCESS(
+      CreateCompactor(2, 6).Compact(10, 12, compacted_journal_count));
+  EXPECT_EQ(compacted_journal_count, 2);
+
+  BytesBuffer segment_buffer(ReadFile(GetSegmentPath(12)));
+  ASSERT_TRUE(JournalSerialization::IsCompressedJournalBlob(segment_buffer));
+  BytesBuffer decompressed_buffer;
+  EXPECT_SUCCESS(JournalSerialization::DecompressJournalBlob(
+      segment_buffer, decompressed_buffer));
+  EXPECT_EQ(decompressed_buffer.ToString(), "compresseduncompressed");
+}
+
+TEST_F(JournalCompactorTest, JournalsOfCompactedSegmentsAreDeleted) {
+  JournalSegmentManifest manifest;
+  auto* segment = manifest.add_segments();
+  segment->set_first_journal_id(11);
+  segment->set_last_journal_id(12);
+  WriteManifest(manifest);
+  WriteFile(GetSegmentPath(12), "ab");
+  // Left over by a compaction interrupted after writing the manifest.
+  WriteFile(GetJournalPath(11), "a");
+  WriteFile(GetJournalPath(12), "b");
+  WriteFile(GetJournalPath(13), "c");
+
+  size_t compacted_journal_count = 0;
+  EXPECT_SUCCESS(CreateCompactor(2).Compact(10, 13, compacted_journal_count));
+  EXPECT_EQ(compacted_journal_count, 0);
+
+  EXPECT_FALSE(std::filesystem::exists(GetJournalPath(11)));
+  EXPECT_FALSE(std::filesystem::exists(GetJournalPath(12)));
+  EXPECT_TRUE(std::filesystem::exists(GetJournalPath(13)));
+  EXPECT_EQ(ReadManifest().segments_size(), 1);
+}
+
+TEST_F(JournalCompactorTest, JournalsAreKeptIfTheSegmentCannotBeWritten) {
+  WriteFile(GetJournalPath(11), "a");
+  WriteFile(GetJournalPath(12), "b");
+  blob_storage_client_->put_blob_mock =
+      [](AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) {
+        put_blob_context.result = FailureExecutionResult(SC_UNKNOWN);
+        put_blob_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  size_t compacted_journal_count = 0;
+  EXPECT_THAT(CreateCompactor(2).Compact(10, 12, compacted_journal_count),
+              ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+  EXPECT_EQ(compacted_journal_count, 0);
+
+  EXPECT_TRUE(std::filesystem::exists(GetJournalPath(11)));
+  EXPECT_TRUE(std::filesystem::exists(GetJournalPath(12)));
+  EXPECT_FALSE(std::filesystem::exists(directory_ / kPartitionName /
+                                       kJournalSegmentManifestBlobName));
+}
+}  // namespace google::scp::core::test
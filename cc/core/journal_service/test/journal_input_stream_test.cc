@@ -19,6 +19,7 @@
 #include <atomic>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -76,6 +77,7 @@ struct TestCase {
   std::string test_name;
   bool enable_batch_read;
   int seed;
+  bool enable_prefetch = false;
 };
 
 class JournalInputStreamTest : public testing::Test {
@@ -125,15 +127,19 @@ class JournalInputStreamTest : public testing::Test {
 
   ExecutionResult WriteCheckpoint(const JournalLog& journal_log,
                                   JournalId last_processed_journal_id,
-                                  std::string_view file_postfix) {
+                                  std::string_view file_postfix,
+                                  size_t shard_count = 0) {
     return journal_service::test_util::WriteCheckpoint(
         journal_log, last_processed_journal_id, file_postfix,
-        *mock_storage_client_);
+        *mock_storage_client_, shard_count);
   }
 
-  ExecutionResult WriteLastCheckpoint(CheckpointId checkpoint_id) {
+  ExecutionResult WriteLastCheckpoint(CheckpointId checkpoint_id,
+                                      size_t shard_count = 0,
+                                      JournalId last_processed_journal_id = 0) {
     return journal_service::test_util::WriteLastCheckpoint(
-        checkpoint_id, *mock_storage_client_);
+        checkpoint_id, *mock_storage_client_, shard_count,
+        last_processed_journal_id);
   }
 
   AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
@@ -647,6 +653,69 @@ TEST_P(JournalInputStreamTestWithParam,
   ExpectNoMoreLogsToReturn();
 }
 
+TEST_P(JournalInputStreamTestWithParam, ReadLogsWithShardedCheckpoint) {
+  EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/2, /*shard_count=*/3));
+
+  vector<JournalLog> checkpoint_logs(3);
+  for (size_t i = 0; i < checkpoint_logs.size(); ++i) {
+    checkpoint_logs[i].set_type(10 + i);
+    auto file_postfix =
+        i == 0 ? IdToString(2) : absl::StrCat(IdToString(2), "_", i);
+    EXPECT_SUCCESS(WriteCheckpoint(checkpoint_logs[i],
+                                   /*last_processed_journal_id=*/1,
+                                   file_postfix, /*shard_count=*/3));
+  }
+
+  JournalLog journal_log;
+  journal_log.set_type(33);
+  EXPECT_SUCCESS(WriteJournalLog(journal_log, IdToString(3)));
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      context = ReadLogs();
+
+  // The shards are replayed in the shard order.
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  ASSERT_EQ(context.response->read_logs->size(), 4);
+  for (size_t i = 0; i < checkpoint_logs.size(); ++i) {
+    EXPECT_THAT(*context.response->read_logs->at(i).journal_log,
+                EqualsProto(checkpoint_logs[i]));
+    EXPECT_EQ(context.response->read_logs->at(i).journal_id, 2);
+  }
+  EXPECT_THAT(*context.response->read_logs->at(3).journal_log,
+              EqualsProto(journal_log));
+
+  ExpectNoMoreLogsToReturn();
+}
+
+TEST_P(JournalInputStreamTestWithParam,
+       ReadLogsWithListedShardedCheckpointChecksTheShardCount) {
+  JournalLog journal_log;
+  journal_log.set_type(11);
+  EXPECT_SUCCESS(WriteCheckpoint(journal_log, /*last_processed_journal_id=*/1,
+                                 IdToString(2), /*shard_count=*/2));
+  EXPECT_SUCCESS(WriteCheckpoint(journal_log, /*last_processed_journal_id=*/1,
+                                 absl::StrCat(IdToString(2), "_1"),
+                                 /*shard_count=*/2));
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      context = ReadLogs();
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  EXPECT_EQ(context.response->read_logs->size(), 2);
+
+  // A newer checkpoint of which only the first shard was written.
+  EXPECT_SUCCESS(WriteCheckpoint(journal_log, /*last_processed_journal_id=*/1,
+                                 IdToString(3), /*shard_count=*/2));
+  journal_input_stream_ = CreateJournalInputStream();
+  EXPECT_THAT(ReadLogs().result,
+              ResultIs(FailureExecutionResult(
+                  errors::
+                      SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_CHECKPOINT_SHARDS)));
+}
+
 TEST_P(JournalInputStreamTestWithParam,
        ReadLogsWithLastCheckpointPointingAtNonExistCheckpoint) {
   EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/5));
@@ -719,10 +788,18 @@ class JournalInputStreamTestWithRandomSeed
     setenv(kPBSJournalInputStreamEnableBatchReadJournals,
            GetParam().enable_batch_read ? "true" : "false",
            /*replace=*/1);
+    setenv(kPBSJournalInputStreamEnablePrefetchJournals,
+           GetParam().enable_prefetch ? "true" : "false",
+           /*replace=*/1);
 
     JournalInputStreamTest::SetUp();
   }
 
+  void TearDown() override {
+    unsetenv(kPBSJournalInputStreamEnablePrefetchJournals);
+    JournalInputStreamTest::TearDown();
+  }
+
   uint32_t seed_;
 };
 
@@ -734,6 +811,9 @@ INSTANTIATE_TEST_SUITE_P(
         {"EnableBatchReadJournalsRandomSeed3", true, 3},
         {"EnableBatchReadJournalsRandomSeed4", true, 4},
         {"EnableBatchReadJournalsRandomSeed5", true, 5},
+        {"EnablePrefetchJournalsRandomSeed1", true, 1, true},
+        {"EnablePrefetchJournalsRandomSeed2", true, 2, true},
+        {"EnablePrefetchJournalsRandomSeed3", true, 3, true},
         {"DisableBatchReadJournalsRandomSeed1", false, 1},
         {"DisableBatchReadJournalsRandomSeed2", false, 2},
         {"DisableBatchReadJournalsRandomSeed3", false, 3},
@@ -806,6 +886,385 @@ TEST_P(JournalInputStreamTestWithRandomSeed,
   ExpectNoMoreLogsToReturn();
 }
 
+class JournalInputStreamWithPrefetchTest : public JournalInputStreamTest {
+ protected:
+  void SetUp() override {
+    setenv(kPBSJournalInputStreamNumberOfJournalLogsToReturn, "5000",
+           /*replace=*/1);
+    setenv(kPBSJournalInputStreamNumberOfJournalsPerBatch, "2",
+           /*replace=*/1);
+    setenv(kPBSJournalInputStreamEnableBatchReadJournals, "true",
+           /*replace=*/1);
+    setenv(kPBSJournalInputStreamEnablePrefetchJournals, "true",
+           /*replace=*/1);
+
+    JournalInputStreamTest::SetUp();
+
+    for (int i = 1000; i < 1005; i++) {
+      JournalLog journal_log;
+      journal_log.set_type(i);
+      EXPECT_SUCCESS(WriteJournalLog(journal_log, IdToString(i)));
+    }
+  }
+
+  void TearDown() override {
+    unsetenv(kPBSJournalInputStreamEnablePrefetchJournals);
+    JournalInputStreamTest::TearDown();
+  }
+
+  static bool IsJournalBlob(
+      const AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+      JournalId journal_id) {
+    return get_blob_context.request->blob_name->find(IdToString(journal_id)) !=
+           std::string::npos;
+  }
+
+  void ExpectJournalIds(
+      const AsyncContext<JournalStreamReadLogRequest,
+                         JournalStreamReadLogResponse>& context,
+      const vector<JournalId>& journal_ids) {
+    EXPECT_SUCCESS(context.result);
+    ASSERT_TRUE(context.response != nullptr);
+    ASSERT_TRUE(context.response->read_logs != nullptr);
+    ASSERT_EQ(context.response->read_logs->size(), journal_ids.size());
+    for (size_t i = 0; i < journal_ids.size(); i++) {
+      EXPECT_EQ(context.response->read_logs->at(i).journal_id, journal_ids[i]);
+      EXPECT_EQ(context.response->read_logs->at(i).journal_log->type(),
+                journal_ids[i]);
+    }
+  }
+
+  /// Reads the blobs from the files written by the test.
+  MockBlobStorageClient file_storage_client_;
+};
+
+TEST_F(JournalInputStreamWithPrefetchTest, ReadLogsWaitsForPrefetchedJournals) {
+  // The reads of the second batch are held until the test completes them.
+  vector<AsyncContext<GetBlobRequest, GetBlobResponse>> held_contexts;
+  std::mutex held_contexts_mutex;
+  mock_storage_client_->get_blob_mock =
+      [&](AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) {
+        if (IsJournalBlob(get_blob_context, 1002) ||
+            IsJournalBlob(get_blob_context, 1003)) {
+          std::unique_lock lock(held_contexts_mutex);
+          held_contexts.push_back(get_blob_context);
+          return SuccessExecutionResult();
+        }
+        return file_storage_client_.GetBlob(get_blob_context);
+      };
+
+  ExpectJournalIds(ReadLogs(), {1000, 1001});
+  // The second batch was requested along with the first one.
+  EXPECT_EQ(held_contexts.size(), 2);
+
+  atomic<bool> finished(false);
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      callback_context;
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      context;
+  context.request = make_shared<JournalStreamReadLogRequest>();
+  context.callback = [&](AsyncContext<JournalStreamReadLogRequest,
+                                      JournalStreamReadLogResponse>&
+                             journal_stream_read_log_context) {
+    callback_context = journal_stream_read_log_context;
+    finished = true;
+  };
+  EXPECT_SUCCESS(journal_input_stream_->ReadLog(context));
+
+  EXPECT_SUCCESS(file_storage_client_.GetBlob(held_contexts[0]));
+  EXPECT_FALSE(finished);
+  EXPECT_SUCCESS(file_storage_client_.GetBlob(held_contexts[1]));
+  WaitUntil([&]() { return finished.load(); });
+  ExpectJournalIds(callback_context, {1002, 1003});
+
+  ExpectJournalIds(ReadLogs(), {1004});
+  ExpectNoMoreLogsToReturn();
+}
+
+TEST_F(JournalInputStreamWithPrefetchTest,
+       ReadLogsReadsJournalsAgainIfPrefetchFailed) {
+  size_t journal_1002_reads = 0;
+  mock_storage_client_->get_blob_mock =
+      [&](AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) {
+        if (IsJournalBlob(get_blob_context, 1002) &&
+            journal_1002_reads++ == 0) {
+          get_blob_context.result = FailureExecutionResult(1234);
+          get_blob_context.Finish();
+          return SuccessExecutionResult();
+        }
+        return file_storage_client_.GetBlob(get_blob_context);
+      };
+
+  ExpectJournalIds(ReadLogs(), {1000, 1001});
+  ExpectJournalIds(ReadLogs(), {1002, 1003});
+  EXPECT_EQ(journal_1002_reads, 2);
+  ExpectJournalIds(ReadLogs(), {1004});
+  ExpectNoMoreLogsToReturn();
+}
+
+TEST_F(JournalInputStreamTest, StreamingReplayBoundsResidentJournalBlobs) {
+  setenv(kPBSJournalInputStreamNumberOfJournalLogsToReturn, "5000",
+         /*replace=*/1);
+  setenv(kPBSJournalInputStreamNumberOfJournalsPerBatch, "1000",
+         /*replace=*/1);
+  setenv(kPBSJournalInputStreamEnableBatchReadJournals, "false",
+         /*replace=*/1);
+  setenv(kPBSJournalInputStreamEnableStreamingReplay, "true", /*replace=*/1);
+  setenv(kPBSJournalInputStreamMaxResidentJournalBlobs, "2", /*replace=*/1);
+  journal_input_stream_ = CreateJournalInputStream();
+  unsetenv(kPBSJournalInputStreamEnableStreamingReplay);
+  unsetenv(kPBSJournalInputStreamMaxResidentJournalBlobs);
+
+  for (int i = 1000; i < 1005; i++) {
+    JournalLog journal_log;
+    journal_log.set_type(i);
+    EXPECT_SUCCESS(WriteJournalLog(journal_log, IdToString(i)));
+  }
+
+  // The journals are read two at a time.
+  for (auto expected_batch_size : {2, 2, 1}) {
+    auto context = ReadLogs();
+    EXPECT_SUCCESS(context.result);
+    ASSERT_TRUE(context.response != nullptr);
+    ASSERT_TRUE(context.response->read_logs != nullptr);
+    EXPECT_EQ(context.response->read_logs->size(), expected_batch_size);
+  }
+  ExpectNoMoreLogsToReturn();
+}
+
+TEST_F(JournalInputStreamTest, ResumedReadOnlyReadsJournalsAfterTheGivenOne) {
+  setenv(kPBSJournalInputStreamNumberOfJournalLogsToReturn, "5000",
+         /*replace=*/1);
+  setenv(kPBSJournalInputStreamEnableBatchReadJournals, "false",
+         /*replace=*/1);
+  journal_input_stream_ = CreateJournalInputStream();
+
+  EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/1));
+  JournalLog checkpoint_journal_log;
+  checkpoint_journal_log.set_type(1);
+  EXPECT_SUCCESS(WriteCheckpoint(checkpoint_journal_log,
+                                 /*last_processed_journal_id=*/1000,
+                                 IdToString(1)));
+  for (int i = 1001; i < 1005; i++) {
+    JournalLog journal_log;
+    journal_log.set_type(i);
+    EXPECT_SUCCESS(WriteJournalLog(journal_log, IdToString(i)));
+  }
+
+  JournalStreamReadLogRequest request;
+  request.resume_after_journal_id = 1002;
+  auto context = ReadLogs(request);
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  // The checkpoint is not read.
+  ASSERT_EQ(context.response->read_logs->size(), 2);
+  EXPECT_EQ(context.response->read_logs->at(0).journal_log->type(), 1003);
+  EXPECT_EQ(context.response->read_logs->at(1).journal_log->type(), 1004);
+  EXPECT_EQ(journal_input_stream_->GetLastProcessedJournalId(), 1004);
+  ExpectNoMoreLogsToReturn();
+
+  // Nothing was written since.
+  journal_input_stream_ = CreateJournalInputStream();
+  request.resume_after_journal_id = 1004;
+  context = ReadLogs(request);
+  EXPECT_THAT(context.result,
+              ResultIs(FailureExecutionResult(
+                  errors::SC_JOURNAL_SERVICE_INPUT_STREAM_NO_MORE_LOGS_TO_RETURN)));
+  EXPECT_EQ(journal_input_stream_->GetLastProcessedJournalId(), 1004);
+}
+
+TEST_F(JournalInputStreamTest,
+       ReadStoppingAtLastCheckpointedJournalDoesNotSkipLateJournals) {
+  setenv(kPBSJournalInputStreamNumberOfJournalLogsToReturn, "5000",
+         /*replace=*/1);
+  setenv(kPBSJournalInputStreamEnableBatchReadJournals, "false",
+         /*replace=*/1);
+  journal_input_stream_ = CreateJournalInputStream();
+
+  JournalLog checkpoint_journal_log;
+  checkpoint_journal_log.set_type(1);
+  EXPECT_SUCCESS(WriteCheckpoint(checkpoint_journal_log,
+                                 /*last_processed_journal_id=*/1000,
+                                 IdToString(1)));
+  EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/1, /*shard_count=*/0,
+                                     /*last_processed_journal_id=*/1002));
+  // The journal 1003 is persisted after the journal 1004.
+  for (int i : {1001, 1002, 1004}) {
+    JournalLog journal_log;
+    journal_log.set_type(i);
+    EXPECT_SUCCESS(WriteJournalLog(journal_log, IdToString(i)));
+  }
+
+  JournalStreamReadLogRequest request;
+  request.should_stop_at_last_checkpointed_journal = true;
+  auto context = ReadLogs(request);
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  ASSERT_EQ(context.response->read_logs->size(), 3);
+  EXPECT_EQ(context.response->read_logs->at(0).journal_log->type(), 1);
+  EXPECT_EQ(context.response->read_logs->at(1).journal_log->type(), 1001);
+  EXPECT_EQ(context.response->read_logs->at(2).journal_log->type(), 1002);
+  EXPECT_EQ(journal_input_stream_->GetLastProcessedJournalId(), 1002);
+  ExpectNoMoreLogsToReturn();
+
+  JournalLog late_journal_log;
+  late_journal_log.set_type(1003);
+  EXPECT_SUCCESS(WriteJournalLog(late_journal_log, IdToString(1003)));
+  EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/1, /*shard_count=*/0,
+                                     /*last_processed_journal_id=*/1004));
+
+  journal_input_stream_ = CreateJournalInputStream();
+  request.resume_after_journal_id = 1002;
+  context = ReadLogs(request);
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  ASSERT_EQ(context.response->read_logs->size(), 2);
+  EXPECT_EQ(context.response->read_logs->at(0).journal_log->type(), 1003);
+  EXPECT_EQ(context.response->read_logs->at(1).journal_log->type(), 1004);
+  EXPECT_EQ(journal_input_stream_->GetLastProcessedJournalId(), 1004);
+  ExpectNoMoreLogsToReturn();
+}
+
+TEST_F(JournalInputStreamTest,
+       ReadStoppingAtLastCheckpointedJournalFailsIfNoneIsPublished) {
+  journal_input_stream_ = CreateJournalInputStream();
+
+  JournalLog checkpoint_journal_log;
+  checkpoint_journal_log.set_type(1);
+  EXPECT_SUCCESS(WriteCheckpoint(checkpoint_journal_log,
+                                 /*last_processed_journal_id=*/1000,
+                                 IdToString(1)));
+  EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/1));
+
+  JournalStreamReadLogRequest request;
+  request.should_stop_at_last_checkpointed_journal = true;
+  request.resume_after_journal_id = 1000;
+  auto context = ReadLogs(request);
+  EXPECT_THAT(context.result,
+              ResultIs(FailureExecutionResult(
+                  errors::SC_JOURNAL_SERVICE_INPUT_STREAM_NO_CHECKPOINTED_JOURNAL)));
+}
+
+class JournalInputStreamWithShardedListingTest : public JournalInputStreamTest {
+ protected:
+  void SetUp() override {
+    setenv(kPBSJournalInputStreamNumberOfJournalLogsToReturn, "5000",
+           /*replace=*/1);
+    setenv(kPBSJournalInputStreamEnableBatchReadJournals, "false",
+           /*replace=*/1);
+    setenv(kPBSJournalInputStreamJournalListingShardCount, "4",
+           /*replace=*/1);
+
+    JournalInputStreamTest::SetUp();
+
+    EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/1));
+    JournalLog checkpoint_journal_log;
+    checkpoint_journal_log.set_type(1);
+    EXPECT_SUCCESS(WriteCheckpoint(checkpoint_journal_log,
+                                   /*last_processed_journal_id=*/1000,
+                                   IdToString(1)));
+    // The journals 1001 to 1039 are split into the ranges ending at 1010,
+    // 1020, 1030, and the range after.
+    for (int i = 990; i < 1060; i += 3) {
+      JournalLog journal_log;
+      journal_log.set_type(i);
+      EXPECT_SUCCESS(WriteJournalLog(journal_log, IdToString(i)));
+    }
+
+    mock_storage_client_->list_blobs_mock =
+        [&](AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+                list_blobs_context) {
+          if (list_blobs_context.request->blob_name->find("journal_") !=
+              std::string::npos) {
+            std::unique_lock lock(journal_listing_markers_mutex_);
+            journal_listing_markers_.insert(
+                *list_blobs_context.request->marker);
+          }
+          return file_storage_client_.ListBlobs(list_blobs_context);
+        };
+  }
+
+  void TearDown() override {
+    unsetenv(kPBSJournalInputStreamJournalListingShardCount);
+    JournalInputStreamTest::TearDown();
+  }
+
+  static std::string JournalBlobName(JournalId journal_id) {
+    return absl::StrCat(kPartitionName, "/journal_", IdToString(journal_id));
+  }
+
+  /// Lists the blobs from the files written by the test.
+  MockBlobStorageClient file_storage_client_;
+  std::mutex journal_listing_markers_mutex_;
+  set<string> journal_listing_markers_;
+};
+
+TEST_F(JournalInputStreamWithShardedListingTest,
+       ReadLogsListsJournalRangesInParallel) {
+  JournalStreamReadLogRequest request;
+  request.max_journal_id_to_process = 1040;
+  auto context = ReadLogs(request);
+
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  // The checkpoint, then the journals 1002 to 1038.
+  ASSERT_EQ(context.response->read_logs->size(), 14);
+  EXPECT_EQ(context.response->read_logs->at(0).journal_log->type(), 1);
+  for (size_t i = 1; i < context.response->read_logs->size(); i++) {
+    JournalId journal_id = 1002 + (i - 1) * 3;
+    EXPECT_EQ(context.response->read_logs->at(i).journal_id, journal_id);
+    EXPECT_EQ(context.response->read_logs->at(i).journal_log->type(),
+              journal_id);
+  }
+  EXPECT_EQ(journal_input_stream_->GetLastProcessedJournalId(), 1038);
+
+  EXPECT_EQ(journal_listing_markers_,
+            (set<string>{JournalBlobName(1000), JournalBlobName(1010),
+                         JournalBlobName(1020), JournalBlobName(1030)}));
+  ExpectNoMoreLogsToReturn();
+}
+
+TEST_F(JournalInputStreamWithShardedListingTest,
+       ReadLogsKeepsTheFirstJournalsOfTheRanges) {
+  JournalStreamReadLogRequest request;
+  request.max_journal_id_to_process = 1040;
+  request.max_number_of_journals_to_process = 5;
+  auto context = ReadLogs(request);
+
+  EXPECT_SUCCESS(context.result);
+  ASSERT_TRUE(context.response != nullptr);
+  ASSERT_TRUE(context.response->read_logs != nullptr);
+  ASSERT_EQ(context.response->read_logs->size(), 6);
+  EXPECT_EQ(context.response->read_logs->at(1).journal_id, 1002);
+  EXPECT_EQ(context.response->read_logs->at(5).journal_id, 1014);
+  EXPECT_EQ(journal_input_stream_->GetLastProcessedJournalId(), 1014);
+}
+
+TEST_F(JournalInputStreamWithShardedListingTest,
+       ReadLogsFailsIfTheListingOfARangeFails) {
+  mock_storage_client_->list_blobs_mock =
+      [&](AsyncContext<ListBlobsRequest, ListBlobsResponse>&
+              list_blobs_context) {
+        if (list_blobs_context.request->marker &&
+            *list_blobs_context.request->marker == JournalBlobName(1020)) {
+          list_blobs_context.result = FailureExecutionResult(1234);
+          list_blobs_context.Finish();
+          return SuccessExecutionResult();
+        }
+        return file_storage_client_.ListBlobs(list_blobs_context);
+      };
+
+  JournalStreamReadLogRequest request;
+  request.max_journal_id_to_process = 1040;
+  auto context = ReadLogs(request);
+
+  EXPECT_THAT(context.result, ResultIs(FailureExecutionResult(1234)));
+}
+
 TEST_P(JournalInputStreamTestWithParam, ReadLogsCorruptedJournalLog) {
   EXPECT_SUCCESS(WriteLastCheckpoint(/*checkpoint_id=*/1));
 
@@ -1386,6 +1845,126 @@ TEST_P(MockJournalInputStreamTestWithParam, OnReadCheckpointBlobListBlobsFail) {
   }
 }
 
+TEST_P(MockJournalInputStreamTestWithParam,
+       OnReadCheckpointBlobCallbackReadsDeltaCheckpointChain) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+  mock_journal_input_stream.SetLastCheckpointId(300);
+
+  auto create_checkpoint_blob = [](const string& logs,
+                                   JournalId last_processed_journal_id,
+                                   CheckpointId base_checkpoint_id) {
+    AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context;
+    get_blob_context.result = SuccessExecutionResult();
+    get_blob_context.response = make_shared<GetBlobResponse>();
+    get_blob_context.response->buffer = make_shared<BytesBuffer>(1000);
+    auto& buffer = *get_blob_context.response->buffer;
+    std::copy(logs.begin(), logs.end(), buffer.bytes->begin());
+
+    journal_service::CheckpointMetadata checkpoint_metadata;
+    checkpoint_metadata.set_last_processed_journal_id(
+        last_processed_journal_id);
+    checkpoint_metadata.set_base_checkpoint_id(base_checkpoint_id);
+    size_t bytes_serialized = 0;
+    JournalSerialization::SerializeCheckpointMetadata(
+        buffer, logs.size(), checkpoint_metadata, bytes_serialized);
+    buffer.length = logs.size() + bytes_serialized;
+    return get_blob_context;
+  };
+
+  vector<CheckpointId> read_checkpoint_ids;
+  mock_journal_input_stream.read_checkpoint_blob_mock =
+      [&](AsyncContext<journal_service::JournalStreamReadLogRequest,
+                       journal_service::JournalStreamReadLogResponse>&,
+          size_t checkpoint_id) {
+        read_checkpoint_ids.push_back(checkpoint_id);
+        return SuccessExecutionResult();
+      };
+  atomic<bool> condition(false);
+  mock_journal_input_stream.list_journals_mock =
+      [&](AsyncContext<journal_service::JournalStreamReadLogRequest,
+                       journal_service::JournalStreamReadLogResponse>&,
+          std::shared_ptr<Blob>& start_name) {
+        // The journals after the most recent checkpoint are listed, and the
+        // chain is replayed from the full checkpoint.
+        EXPECT_EQ(mock_journal_input_stream.GetLastProcessedJournalId(), 1234);
+        auto& journal_buffers = mock_journal_input_stream.GetJournalBuffers();
+        EXPECT_EQ(journal_buffers.size(), 1);
+        EXPECT_EQ(journal_buffers[0].ToString(), "fullmiddlelatest");
+        condition = true;
+        return SuccessExecutionResult();
+      };
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      journal_stream_read_log_context;
+  auto latest_blob_context = create_checkpoint_blob("latest", 1234, 200);
+  mock_journal_input_stream.OnReadCheckpointBlobCallback(
+      journal_stream_read_log_context, latest_blob_context);
+  auto middle_blob_context = create_checkpoint_blob("middle", 1000, 100);
+  mock_journal_input_stream.OnReadCheckpointBlobCallback(
+      journal_stream_read_log_context, middle_blob_context);
+  EXPECT_EQ(read_checkpoint_ids, (vector<CheckpointId>{200, 100}));
+  EXPECT_FALSE(condition.load());
+
+  auto full_blob_context = create_checkpoint_blob("full", 900, 0);
+  mock_journal_input_stream.OnReadCheckpointBlobCallback(
+      journal_stream_read_log_context, full_blob_context);
+  WaitUntil([&]() { return condition.load(); });
+}
+
+TEST_P(MockJournalInputStreamTestWithParam,
+       OnReadCheckpointBlobCallbackFailsOnCheckpointChainCycle) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+  mock_journal_input_stream.SetLastCheckpointId(300);
+
+  AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context;
+  get_blob_context.result = SuccessExecutionResult();
+  get_blob_context.response = make_shared<GetBlobResponse>();
+  get_blob_context.response->buffer = make_shared<BytesBuffer>(1000);
+
+  // The base of a delta checkpoint must be older than the delta.
+  journal_service::CheckpointMetadata checkpoint_metadata;
+  checkpoint_metadata.set_last_processed_journal_id(1234);
+  checkpoint_metadata.set_base_checkpoint_id(300);
+  size_t bytes_serialized = 0;
+  JournalSerialization::SerializeCheckpointMetadata(
+      *get_blob_context.response->buffer, 0, checkpoint_metadata,
+      bytes_serialized);
+  get_blob_context.response->buffer->length = bytes_serialized;
+
+  atomic<bool> condition(false);
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      journal_stream_read_log_context;
+  journal_stream_read_log_context.callback =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&
+              journal_stream_read_log_context) {
+        EXPECT_THAT(
+            journal_stream_read_log_context.result,
+            ResultIs(FailureExecutionResult(
+                errors::SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_CHECKPOINT_CHAIN)));
+        condition = true;
+      };
+  mock_journal_input_stream.OnReadCheckpointBlobCallback(
+      journal_stream_read_log_context, get_blob_context);
+  WaitUntil([&]() { return condition.load(); });
+}
+
 TEST_P(MockJournalInputStreamTestWithParam, ListCheckpoints) {
   auto bucket_name = make_shared<string>("bucket_name");
   auto partition_name = make_shared<string>("partition_name");
@@ -1893,6 +2472,130 @@ TEST_P(MockJournalInputStreamTestWithParam,
   WaitUntil([&]() { return condition.load(); });
 }
 
+/// Returns a blob storage client reading a segment manifest with the segment
+/// of the journals in [first_journal_id, last_journal_id].
+static shared_ptr<BlobStorageClientInterface> CreateSegmentManifestClient(
+    JournalId first_journal_id, JournalId last_journal_id) {
+  auto mock_storage_client = make_shared<MockBlobStorageClient>();
+  mock_storage_client->get_blob_mock =
+      [first_journal_id, last_journal_id](
+          AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) {
+        EXPECT_EQ(*get_blob_context.request->blob_name,
+                  "partition_name/segment_manifest");
+        journal_service::JournalSegmentManifest manifest;
+        auto* segment = manifest.add_segments();
+        segment->set_first_journal_id(first_journal_id);
+        segment->set_last_journal_id(last_journal_id);
+        size_t byte_size = 0;
+        JournalSerialization::CalculateSerializationByteSize(manifest,
+                                                             byte_size);
+        get_blob_context.response = make_shared<GetBlobResponse>();
+        get_blob_context.response->buffer = make_shared<BytesBuffer>(byte_size);
+        JournalSerialization::SerializeJournalSegmentManifest(
+            *get_blob_context.response->buffer, 0, manifest,
+            get_blob_context.response->buffer->length);
+        get_blob_context.result = SuccessExecutionResult();
+        get_blob_context.Finish();
+        return SuccessExecutionResult();
+      };
+  return mock_storage_client;
+}
+
+/// Returns the listing of the journal blobs of the journal ids.
+static AsyncContext<ListBlobsRequest, ListBlobsResponse> CreateJournalListing(
+    const vector<string>& journal_blob_names) {
+  AsyncContext<ListBlobsRequest, ListBlobsResponse> list_blobs_context;
+  list_blobs_context.result = SuccessExecutionResult();
+  list_blobs_context.response = make_shared<ListBlobsResponse>();
+  list_blobs_context.response->blobs = make_shared<vector<Blob>>();
+  list_blobs_context.response->is_last_page = true;
+  for (const auto& journal_blob_name : journal_blob_names) {
+    Blob blob;
+    blob.blob_name = make_shared<string>(journal_blob_name);
+    list_blobs_context.response->blobs->push_back(blob);
+  }
+  return list_blobs_context;
+}
+
+TEST_P(MockJournalInputStreamTestWithParam,
+       OnListJournalsCallbackReadsSegmentsInsteadOfTheirJournals) {
+  setenv(kPBSJournalServiceEnableJournalCompaction, "true", /*replace=*/1);
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  auto storage_client = CreateSegmentManifestClient(12312, 12315);
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+  unsetenv(kPBSJournalServiceEnableJournalCompaction);
+
+  // The journal 12312 is deleted, and 12315 is not deleted yet.
+  auto list_blobs_context = CreateJournalListing(
+      {"partition_name/journal_12315", "partition_name/journal_12320"});
+
+  atomic<bool> condition(false);
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      journal_stream_read_log_context;
+  journal_stream_read_log_context.request =
+      make_shared<JournalStreamReadLogRequest>();
+  mock_journal_input_stream.read_journal_blobs_mock =
+      [&](AsyncContext<journal_service::JournalStreamReadLogRequest,
+                       journal_service::JournalStreamReadLogResponse>&,
+          vector<uint64_t>& journal_ids) {
+        // The segment is read as the journal 12315.
+        EXPECT_EQ(journal_ids, (vector<uint64_t>{12315, 12320}));
+        EXPECT_EQ(mock_journal_input_stream.GetLastProcessedJournalId(),
+                  12320);
+        return FailureExecutionResult(123);
+      };
+  journal_stream_read_log_context.callback =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&
+              journal_stream_read_log_context) {
+        EXPECT_THAT(journal_stream_read_log_context.result,
+                    ResultIs(FailureExecutionResult(123)));
+        condition = true;
+      };
+  mock_journal_input_stream.OnListJournalsCallback(
+      journal_stream_read_log_context, list_blobs_context);
+  WaitUntil([&]() { return condition.load(); });
+}
+
+TEST_P(MockJournalInputStreamTestWithParam,
+       OnListJournalsCallbackFailsOnSegmentAcrossTheLastProcessedJournal) {
+  setenv(kPBSJournalServiceEnableJournalCompaction, "true", /*replace=*/1);
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  auto storage_client = CreateSegmentManifestClient(12312, 12315);
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+  unsetenv(kPBSJournalServiceEnableJournalCompaction);
+  mock_journal_input_stream.SetLastProcessedJournalId(12313);
+
+  auto list_blobs_context =
+      CreateJournalListing({"partition_name/journal_12320"});
+
+  atomic<bool> condition(false);
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      journal_stream_read_log_context;
+  journal_stream_read_log_context.request =
+      make_shared<JournalStreamReadLogRequest>();
+  journal_stream_read_log_context.callback =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&
+              journal_stream_read_log_context) {
+        EXPECT_THAT(
+            journal_stream_read_log_context.result,
+            ResultIs(FailureExecutionResult(
+                errors::
+                    SC_JOURNAL_SERVICE_INPUT_STREAM_INVALID_JOURNAL_SEGMENT)));
+        condition = true;
+      };
+  mock_journal_input_stream.OnListJournalsCallback(
+      journal_stream_read_log_context, list_blobs_context);
+  WaitUntil([&]() { return condition.load(); });
+}
+
 TEST_P(MockJournalInputStreamTestWithParam,
        OnListJournalsCallbackProperListingWithMaxLoaded) {
   auto bucket_name = make_shared<string>("bucket_name");
@@ -2075,6 +2778,57 @@ TEST_P(MockJournalInputStreamTestWithParam, OnListJournalsCallbackWithMarker) {
   }
 }
 
+TEST_P(MockJournalInputStreamTestWithParam,
+       OnListJournalsCallbackDoesNotListAgainAfterTheLastPage) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+
+  AsyncContext<ListBlobsRequest, ListBlobsResponse> list_blobs_context;
+  list_blobs_context.result = SuccessExecutionResult();
+  list_blobs_context.response = make_shared<ListBlobsResponse>();
+  list_blobs_context.response->blobs = make_shared<vector<Blob>>();
+  Blob blob;
+  blob.bucket_name = bucket_name;
+  blob.blob_name = make_shared<string>(
+      "partition_name/journal_" +
+      journal_service::test_util::JournalIdToString(5));
+  list_blobs_context.response->blobs->push_back(blob);
+  list_blobs_context.response->is_last_page = true;
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      journal_stream_read_log_context;
+  journal_stream_read_log_context.request =
+      make_shared<JournalStreamReadLogRequest>();
+
+  mock_journal_input_stream.list_journals_mock =
+      [&](AsyncContext<journal_service::JournalStreamReadLogRequest,
+                       journal_service::JournalStreamReadLogResponse>&,
+          std::shared_ptr<Blob>& start_from) {
+        ADD_FAILURE() << "Listed again from " << *start_from->blob_name;
+        return FailureExecutionResult(123);
+      };
+
+  vector<uint64_t> read_journal_ids;
+  mock_journal_input_stream.read_journal_blobs_mock =
+      [&](AsyncContext<journal_service::JournalStreamReadLogRequest,
+                       journal_service::JournalStreamReadLogResponse>&,
+          vector<uint64_t>& journal_ids) {
+        read_journal_ids = journal_ids;
+        return SuccessExecutionResult();
+      };
+
+  mock_journal_input_stream.OnListJournalsCallback(
+      journal_stream_read_log_context, list_blobs_context);
+  EXPECT_EQ(read_journal_ids, vector<uint64_t>{5});
+}
+
 TEST_P(MockJournalInputStreamTestWithParam,
        ReadJournalBlobsWithEmptyBlobsList) {
   auto bucket_name = make_shared<string>("bucket_name");
@@ -2298,6 +3052,70 @@ TEST_P(MockJournalInputStreamTestWithParam,
   }
 }
 
+TEST_P(MockJournalInputStreamTestWithParam,
+       OnReadJournalBlobCallbackDecompressesBlobs) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+
+  BytesBuffer uncompressed_bytes_buffer(string(1000, 'a'));
+  AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context;
+  get_blob_context.result = SuccessExecutionResult();
+  get_blob_context.response = make_shared<GetBlobResponse>();
+  get_blob_context.response->buffer = make_shared<BytesBuffer>(
+      JournalSerialization::CalculateMaxCompressedJournalBlobByteSize(
+          uncompressed_bytes_buffer.length));
+  EXPECT_SUCCESS(JournalSerialization::CompressJournalBlob(
+      uncompressed_bytes_buffer, *get_blob_context.response->buffer,
+      /*compression_level=*/1));
+
+  atomic<bool> processed(false);
+  mock_journal_input_stream.process_loaded_journals_mock =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&) {
+        auto& bytes_buffer = mock_journal_input_stream.GetJournalBuffers()[0];
+        EXPECT_EQ(bytes_buffer.ToString(),
+                  uncompressed_bytes_buffer.ToString());
+        processed = true;
+        return SuccessExecutionResult();
+      };
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      journal_stream_read_log_context;
+  mock_journal_input_stream.GetTotalJournalsToRead() = 1;
+  mock_journal_input_stream.GetJournalBuffers().push_back(BytesBuffer());
+  mock_journal_input_stream.OnReadJournalBlobCallback(
+      journal_stream_read_log_context, get_blob_context, 0);
+  EXPECT_TRUE(processed);
+
+  // A corrupted compressed blob fails the read.
+  get_blob_context.response->buffer->length -= 10;
+  atomic<bool> condition(false);
+  journal_stream_read_log_context.callback =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&
+              journal_stream_read_log_context) {
+        EXPECT_THAT(journal_stream_read_log_context.result,
+                    ResultIs(FailureExecutionResult(
+                        errors::SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB)));
+        condition = true;
+      };
+  MockJournalInputStream other_mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+  other_mock_journal_input_stream.GetTotalJournalsToRead() = 1;
+  other_mock_journal_input_stream.GetJournalBuffers().push_back(BytesBuffer());
+  other_mock_journal_input_stream.OnReadJournalBlobCallback(
+      journal_stream_read_log_context, get_blob_context, 0);
+  WaitUntil([&]() { return condition.load(); });
+}
+
 BytesBuffer GenerateLogBytes(size_t count, set<Uuid>& completed_logs,
                              vector<Timestamp>& timestamps,
                              vector<Uuid>& component_ids, vector<Uuid>& log_ids,
@@ -2642,4 +3460,54 @@ TEST_F(MockJournalInputStreamTest, ReadJournalLogBatch) {
   EXPECT_EQ(index, pending_journal_logs.size());
 }
 
+TEST_F(MockJournalInputStreamTest, ReadJournalLogBatchMarksCheckpointLogs) {
+  setenv(kPBSJournalInputStreamEnableBatchReadJournals, "false",
+         /*replace=*/1);
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+  MockJournalInputStream mock_journal_input_stream(
+      bucket_name, partition_name, storage_client,
+      std::make_shared<EnvConfigProvider>());
+  mock_journal_input_stream.SetLastCheckpointId(100);
+
+  // The checkpoint buffer is followed by the buffer of the journal 200.
+  auto& journal_buffers = mock_journal_input_stream.GetJournalBuffers();
+  for (size_t i = 0; i < 2; ++i) {
+    set<Uuid> completed_logs;
+    vector<Uuid> log_ids;
+    vector<JournalLog> journal_logs;
+    vector<Timestamp> timestamps;
+    vector<Uuid> component_ids;
+    journal_buffers.push_back(GenerateLogBytes(
+        5, completed_logs, timestamps, component_ids, log_ids, journal_logs));
+  }
+  mock_journal_input_stream.GetJournalIds().push_back(200);
+
+  size_t checkpoint_log_count = 0;
+  size_t journal_log_count = 0;
+  while (true) {
+    auto batch = make_shared<vector<JournalStreamReadLogObject>>();
+    if (!mock_journal_input_stream.ReadJournalLogBatch(batch).Successful()) {
+      break;
+    }
+
+    for (const auto& log : *batch) {
+      if (log.is_checkpoint_log) {
+        EXPECT_EQ(log.journal_id, 100);
+        EXPECT_EQ(journal_log_count, 0);
+        checkpoint_log_count++;
+      } else {
+        EXPECT_EQ(log.journal_id, 200);
+        journal_log_count++;
+      }
+    }
+  }
+  EXPECT_EQ(checkpoint_log_count, 5);
+  EXPECT_EQ(journal_log_count, 5);
+}
+
 }  // namespace google::scp::core::test
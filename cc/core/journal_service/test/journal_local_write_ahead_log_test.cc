@@ -0,0 +1,132 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/journal_service/src/journal_local_write_ahead_log.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/journal_service/src/error_codes.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using std::make_shared;
+using std::string;
+using std::vector;
+using std::filesystem::path;
+
+namespace google::scp::core::test {
+
+class JournalLocalWriteAheadLogTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ =
+        path(testing::TempDir()) /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  static BytesBuffer CreateBuffer(const string& content) {
+    BytesBuffer bytes_buffer;
+    bytes_buffer.bytes = make_shared<vector<Byte>>(content.begin(),
+                                                   content.end());
+    bytes_buffer.length = content.size();
+    bytes_buffer.capacity = content.size();
+    return bytes_buffer;
+  }
+
+  path directory_;
+};
+
+TEST_F(JournalLocalWriteAheadLogTest, WriteReadAndRemove) {
+  JournalLocalWriteAheadLog log(directory_.string(), "partition");
+  EXPECT_SUCCESS(log.Init());
+
+  EXPECT_SUCCESS(log.Write(200, CreateBuffer("second")));
+  EXPECT_SUCCESS(log.Write(100, CreateBuffer("first")));
+  EXPECT_SUCCESS(log.Write(300, BytesBuffer()));
+
+  vector<JournalId> journal_ids;
+  EXPECT_SUCCESS(log.ListJournalIds(journal_ids));
+  EXPECT_EQ(journal_ids, (vector<JournalId>{100, 200, 300}));
+
+  BytesBuffer bytes_buffer;
+  EXPECT_SUCCESS(log.Read(100, bytes_buffer));
+  EXPECT_EQ(string(bytes_buffer.bytes->begin(),
+                   bytes_buffer.bytes->begin() + bytes_buffer.length),
+            "first");
+  EXPECT_SUCCESS(log.Read(300, bytes_buffer));
+  EXPECT_EQ(bytes_buffer.length, 0);
+
+  EXPECT_SUCCESS(log.Remove(100));
+  // Removing a journal not in the log succeeds.
+  EXPECT_SUCCESS(log.Remove(100));
+  EXPECT_THAT(
+      log.Read(100, bytes_buffer),
+      ResultIs(FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_LOCAL_WRITE_AHEAD_LOG_READ_FAILED)));
+  EXPECT_SUCCESS(log.ListJournalIds(journal_ids));
+  EXPECT_EQ(journal_ids, (vector<JournalId>{200, 300}));
+}
+
+TEST_F(JournalLocalWriteAheadLogTest, JournalsSurviveRestart) {
+  {
+    JournalLocalWriteAheadLog log(directory_.string(), "partition");
+    EXPECT_SUCCESS(log.Init());
+    EXPECT_SUCCESS(log.Write(100, CreateBuffer("first")));
+  }
+
+  JournalLocalWriteAheadLog log(directory_.string(), "partition");
+  EXPECT_SUCCESS(log.Init());
+  vector<JournalId> journal_ids;
+  EXPECT_SUCCESS(log.ListJournalIds(journal_ids));
+  EXPECT_EQ(journal_ids, (vector<JournalId>{100}));
+
+  // The partitions do not share their journals.
+  JournalLocalWriteAheadLog other_log(directory_.string(), "other_partition");
+  EXPECT_SUCCESS(other_log.Init());
+  EXPECT_SUCCESS(other_log.ListJournalIds(journal_ids));
+  EXPECT_TRUE(journal_ids.empty());
+}
+
+TEST_F(JournalLocalWriteAheadLogTest, InitRemovesStaleTemporaryFiles) {
+  auto partition_directory = directory_ / "partition";
+  std::filesystem::create_directories(partition_directory);
+  auto stale_file = partition_directory / "100.journal.tmp";
+  auto recent_file = partition_directory / "200.journal.tmp";
+  std::ofstream(stale_file) << "partial";
+  std::ofstream(recent_file) << "partial";
+  std::filesystem::last_write_time(
+      stale_file, std::filesystem::file_time_type::clock::now() -
+                      std::chrono::hours(1));
+
+  JournalLocalWriteAheadLog log(directory_.string(), "partition");
+  EXPECT_SUCCESS(log.Init());
+  EXPECT_FALSE(std::filesystem::exists(stale_file));
+  // A recent temporary file may be of a write in progress in another process.
+  EXPECT_TRUE(std::filesystem::exists(recent_file));
+
+  vector<JournalId> journal_ids;
+  EXPECT_SUCCESS(log.ListJournalIds(journal_ids));
+  EXPECT_TRUE(journal_ids.empty());
+}
+
+}  // namespace google::scp::core::test
@@ -0,0 +1,295 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives the write path of the journal, JournalService::Log through
+// JournalOutputStream::FlushLogs and WriteBatch, on a blob storage mock which
+// acknowledges the writes after a configurable latency. Reports the logs per
+// second, the batch sizes and the commit latency percentiles.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/async_executor/src/async_executor.h"
+#include "core/blob_storage_provider/mock/mock_blob_storage_provider.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/config_provider/mock/mock_config_provider.h"
+#include "core/interface/configuration_keys.h"
+#include "core/journal_service/mock/mock_journal_service_with_overrides.h"
+#include "core/journal_service/src/journal_output_stream.h"
+#include "public/cpio/mock/metric_client/mock_metric_client.h"
+#include "public/cpio/utils/metric_aggregation/mock/mock_aggregate_metric.h"
+
+namespace google::scp::core::test {
+
+using ::google::scp::core::blob_storage_provider::mock::MockBlobStorageClient;
+using ::google::scp::core::blob_storage_provider::mock::
+    MockBlobStorageProvider;
+using ::google::scp::core::common::TimeProvider;
+using ::google::scp::core::common::Uuid;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::google::scp::core::journal_service::JournalOutputStreamInterface;
+using ::google::scp::core::journal_service::JournalStreamAppendLogRequest;
+using ::google::scp::core::journal_service::JournalStreamAppendLogResponse;
+using ::google::scp::core::journal_service::mock::
+    MockJournalServiceWithOverrides;
+using ::google::scp::cpio::MockAggregateMetric;
+using ::google::scp::cpio::MockMetricClient;
+
+static constexpr char kBucketName[] = "fake_bucket";
+static constexpr char kPartitionName[] = "00000000-0000-0000-0000-000000000000";
+static constexpr size_t kAsyncExecutorThreadCount = 8;
+static constexpr size_t kAsyncExecutorQueueCap = 1 << 20;
+/// The logs each producer keeps in flight at most.
+static constexpr size_t kMaxLogsInFlightPerProducer = 1024;
+
+static constexpr char kBatchesKey[] = "batches";
+static constexpr char kMeanBatchLogsKey[] = "mean_batch_logs";
+static constexpr char kMaxBatchLogsKey[] = "max_batch_logs";
+static constexpr char kMeanBlobBytesKey[] = "mean_blob_bytes";
+static constexpr char kP50LatencyKey[] = "p50_commit_latency_us";
+static constexpr char kP99LatencyKey[] = "p99_commit_latency_us";
+static constexpr char kP999LatencyKey[] = "p999_commit_latency_us";
+static constexpr char kFailedLogsKey[] = "failed_logs";
+
+/// Records the number of logs of each batch written.
+class BatchRecordingJournalOutputStream : public JournalOutputStream {
+ public:
+  using JournalOutputStream::JournalOutputStream;
+
+  std::vector<size_t> GetBatchSizes() {
+    std::lock_guard<std::mutex> lock(batch_sizes_mutex_);
+    return batch_sizes_;
+  }
+
+ protected:
+  void WriteBatch(
+      const std::shared_ptr<
+          std::list<AsyncContext<JournalStreamAppendLogRequest,
+                                 JournalStreamAppendLogResponse>>>& flush_batch,
+      JournalId journal_id) noexcept override {
+    {
+      std::lock_guard<std::mutex> lock(batch_sizes_mutex_);
+      batch_sizes_.push_back(flush_batch->size());
+    }
+    JournalOutputStream::WriteBatch(flush_batch, journal_id);
+  }
+
+  std::mutex batch_sizes_mutex_;
+  std::vector<size_t> batch_sizes_;
+};
+
+/**
+ * @brief Runs a journal service whose output stream writes to a blob storage
+ * mock, the threads of the benchmark producing the logs.
+ *
+ * The benchmark arguments are the bytes of each log, the flush interval in
+ * milliseconds and the latency of the blob writes in milliseconds.
+ */
+class JournalOutputStreamFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    log_body_ = std::make_shared<BytesBuffer>(state.range(0));
+    log_body_->length = state.range(0);
+    auto blob_write_latency = std::chrono::milliseconds(state.range(2));
+    max_in_flight_ = kMaxLogsInFlightPerProducer * state.threads();
+    in_flight_ = 0;
+    failed_logs_ = 0;
+    blob_bytes_ = 0;
+    latencies_.clear();
+
+    async_executor_ = std::make_shared<AsyncExecutor>(kAsyncExecutorThreadCount,
+                                                      kAsyncExecutorQueueCap);
+    async_executor_->Init();
+    async_executor_->Run();
+
+    auto blob_storage_client = std::make_shared<MockBlobStorageClient>();
+    blob_storage_client->put_blob_mock =
+        [this, blob_write_latency](
+            AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) {
+          blob_bytes_ += put_blob_context.request->buffer->length;
+          put_blob_context.result = SuccessExecutionResult();
+          if (blob_write_latency.count() == 0) {
+            put_blob_context.Finish();
+            return SuccessExecutionResult();
+          }
+          auto write_time = (TimeProvider::GetSteadyTimestampInNanoseconds() +
+                             blob_write_latency)
+                                .count();
+          return async_executor_->ScheduleFor(
+              [put_blob_context]() mutable { put_blob_context.Finish(); },
+              write_time);
+        };
+
+    auto bucket_name = std::make_shared<std::string>(kBucketName);
+    auto partition_name = std::make_shared<std::string>(kPartitionName);
+    output_stream_ = std::make_shared<BatchRecordingJournalOutputStream>(
+        bucket_name, partition_name, async_executor_, blob_storage_client,
+        std::make_shared<MockAggregateMetric>(), /*metric_router=*/nullptr);
+
+    auto config_provider = std::make_shared<MockConfigProvider>();
+    config_provider->SetInt(kPBSJournalServiceFlushIntervalInMilliseconds,
+                            state.range(1));
+    config_provider->SetInt(
+        kPBSJournalServiceGroupCommitMaxLatencyInMilliseconds, state.range(1));
+    journal_service_ = std::make_unique<MockJournalServiceWithOverrides>(
+        bucket_name, partition_name, async_executor_,
+        std::make_shared<MockBlobStorageProvider>(),
+        std::make_shared<MockMetricClient>(), /*metric_router=*/nullptr,
+        config_provider);
+    std::shared_ptr<JournalOutputStreamInterface> output_stream =
+        output_stream_;
+    journal_service_->SetOutputStream(output_stream);
+    journal_service_->Init();
+    journal_service_->Run();
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    journal_service_->Stop();
+    async_executor_->Stop();
+    journal_service_ = nullptr;
+    output_stream_ = nullptr;
+  }
+
+  /// @brief Logs the body, blocking while the producers already have the max
+  /// logs in flight.
+  void Log() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return in_flight_ < max_in_flight_; });
+      in_flight_++;
+    }
+
+    auto start_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
+    AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context(
+        std::make_shared<JournalLogRequest>(),
+        [this, start_timestamp](
+            AsyncContext<JournalLogRequest, JournalLogResponse>& context) {
+          auto latency =
+              TimeProvider::GetSteadyTimestampInNanoseconds() - start_timestamp;
+          OnLogged(context.result.Successful(), latency);
+        });
+    journal_log_context.request->component_id = component_id_;
+    journal_log_context.request->log_status = JournalLogStatus::Log;
+    journal_log_context.request->data = log_body_;
+    if (!journal_service_->Log(journal_log_context).Successful()) {
+      OnLogged(false, std::chrono::nanoseconds(0));
+    }
+  }
+
+  void OnLogged(bool is_successful, std::chrono::nanoseconds latency) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (is_successful) {
+        latencies_.push_back(latency.count());
+      } else {
+        failed_logs_++;
+      }
+      in_flight_--;
+    }
+    condition_.notify_all();
+  }
+
+  /// @brief Blocks until every log is acknowledged.
+  void WaitForLogs() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return in_flight_ == 0; });
+  }
+
+  /// @brief Returns the commit latency of the given percentile, in
+  /// microseconds.
+  double GetLatencyPercentile(double percentile) {
+    if (latencies_.empty()) {
+      return 0;
+    }
+    auto index = static_cast<size_t>(percentile * (latencies_.size() - 1));
+    std::nth_element(latencies_.begin(), latencies_.begin() + index,
+                     latencies_.end());
+    return latencies_[index] / 1000.0;
+  }
+
+  std::shared_ptr<AsyncExecutorInterface> async_executor_;
+  std::shared_ptr<BatchRecordingJournalOutputStream> output_stream_;
+  std::unique_ptr<MockJournalServiceWithOverrides> journal_service_;
+  std::shared_ptr<BytesBuffer> log_body_;
+  Uuid component_id_ = Uuid::GenerateUuid();
+  std::atomic<uint64_t> blob_bytes_{0};
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t max_in_flight_ = 0;
+  size_t in_flight_ = 0;
+  size_t failed_logs_ = 0;
+  std::vector<int64_t> latencies_;
+};
+
+BENCHMARK_DEFINE_F(JournalOutputStreamFixture, Log)
+
+(benchmark::State& state) {
+  for (auto _ : state) {
+    Log();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * log_body_->length);
+  if (state.thread_index() != 0) {
+    return;
+  }
+  WaitForLogs();
+
+  auto batch_sizes = output_stream_->GetBatchSizes();
+  size_t batch_logs = 0;
+  size_t max_batch_logs = 0;
+  for (auto batch_size : batch_sizes) {
+    batch_logs += batch_size;
+    max_batch_logs = std::max(max_batch_logs, batch_size);
+  }
+  double batches = batch_sizes.size();
+  state.counters[kBatchesKey] = batches;
+  state.counters[kMeanBatchLogsKey] = batches == 0 ? 0 : batch_logs / batches;
+  state.counters[kMaxBatchLogsKey] = max_batch_logs;
+  state.counters[kMeanBlobBytesKey] =
+      batches == 0 ? 0 : blob_bytes_.load() / batches;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  state.counters[kP50LatencyKey] = GetLatencyPercentile(0.5);
+  state.counters[kP99LatencyKey] = GetLatencyPercentile(0.99);
+  state.counters[kP999LatencyKey] = GetLatencyPercentile(0.999);
+  state.counters[kFailedLogsKey] = failed_logs_;
+}
+
+// Bytes per log, flush interval and blob write latency, both in milliseconds.
+BENCHMARK_REGISTER_F(JournalOutputStreamFixture, Log)
+    ->ArgsProduct({{64, 1024}, {1, 5, 20}, {0, 10, 50}})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace google::scp::core::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
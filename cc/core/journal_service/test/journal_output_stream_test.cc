@@ -14,9 +14,12 @@
 
 #include <gtest/gtest.h>
 
+#include <filesystem>
 #include <functional>
+#include <list>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -44,6 +47,7 @@ using google::scp::core::journal_service::mock::MockJournalOutputStream;
 using google::scp::core::test::WaitUntil;
 using std::atomic;
 using std::function;
+using std::list;
 using std::make_shared;
 using std::move;
 using std::shared_ptr;
@@ -148,6 +152,74 @@ TEST(JournalOutputStreamTests, FlushLogsFailure) {
 
   EXPECT_THAT(mock_journal_output_stream.FlushLogs(),
               ResultIs(FailureExecutionResult(123)));
+  // The logs are kept for the next flush.
+  EXPECT_EQ(mock_journal_output_stream.GetPendingLogsCount().load(), 5);
+  EXPECT_EQ(mock_journal_output_stream.GetPendingLogs().Size(), 0);
+  EXPECT_EQ(mock_journal_output_stream.GetUnbatchedLogs().size(), 5);
+}
+
+TEST(JournalOutputStreamTests, FlushLogsRetriesTheUnbatchedLogsFirst) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  async_executor_mock.schedule_mock = [](auto work) {
+    work();
+    return SuccessExecutionResult();
+  };
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr);
+
+  vector<AsyncContext<JournalStreamAppendLogRequest,
+                      JournalStreamAppendLogResponse>>
+      journal_stream_append_log_contexts(5);
+  for (auto& journal_stream_append_log_context :
+       journal_stream_append_log_contexts) {
+    journal_stream_append_log_context.request =
+        make_shared<JournalStreamAppendLogRequest>();
+    journal_stream_append_log_context.request->journal_log =
+        make_shared<JournalLog>();
+  }
+
+  vector<shared_ptr<JournalStreamAppendLogRequest>> written_requests;
+  mock_journal_output_stream.write_back_mock = [&](auto& flush_batch,
+                                                   auto journal_id) {
+    for (auto& context : *flush_batch) {
+      written_requests.push_back(context.request);
+    }
+  };
+
+  mock_journal_output_stream.create_new_buffer_mock = []() {
+    return FailureExecutionResult(123);
+  };
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_SUCCESS(mock_journal_output_stream.AppendLog(
+        journal_stream_append_log_contexts[i]));
+  }
+  EXPECT_THAT(mock_journal_output_stream.FlushLogs(),
+              ResultIs(FailureExecutionResult(123)));
+
+  mock_journal_output_stream.create_new_buffer_mock = nullptr;
+  for (int i = 3; i < 5; ++i) {
+    EXPECT_SUCCESS(mock_journal_output_stream.AppendLog(
+        journal_stream_append_log_contexts[i]));
+  }
+  EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+
+  // The logs of the failed batch are written before the ones appended later.
+  ASSERT_EQ(written_requests.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(written_requests[i],
+              journal_stream_append_log_contexts[i].request);
+  }
+  EXPECT_EQ(mock_journal_output_stream.GetPendingLogsCount().load(), 0);
+  EXPECT_TRUE(mock_journal_output_stream.GetUnbatchedLogs().empty());
 }
 
 TEST(JournalOutputStreamTests, FlushLogsSchedulingFailure) {
@@ -310,6 +382,331 @@ TEST(JournalOutputStreamTests, WriteBatchWriteBlobFailure) {
   EXPECT_EQ(count, 5);
 }
 
+TEST(JournalOutputStreamTests, WriteBatchCompressesBlobs) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+
+  vector<size_t> compression_levels = {kJournalBlobCompressionDisabled, 6};
+  for (auto compression_level : compression_levels) {
+    MockJournalOutputStream mock_journal_output_stream(
+        bucket_name, partition_name, async_executor, storage_client,
+        /*metric_router=*/nullptr, kDefaultJournalMaxConcurrentBlobWrites,
+        compression_level);
+
+    auto flush_batch = make_shared<list<AsyncContext<
+        JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>>>();
+    size_t uncompressed_length = 0;
+    for (int i = 0; i < 5; ++i) {
+      AsyncContext<JournalStreamAppendLogRequest,
+                   JournalStreamAppendLogResponse>
+          journal_stream_append_log_context;
+      journal_stream_append_log_context.request =
+          make_shared<JournalStreamAppendLogRequest>();
+      journal_stream_append_log_context.request->journal_log =
+          make_shared<JournalLog>();
+      journal_stream_append_log_context.request->log_body =
+          make_shared<BytesBuffer>(string(1000, 'a'));
+      uncompressed_length +=
+          mock_journal_output_stream.GetSerializedLogByteSize(
+              journal_stream_append_log_context);
+      flush_batch->push_back(journal_stream_append_log_context);
+    }
+
+    bool is_called = false;
+    mock_journal_output_stream.write_journal_blob_mock =
+        [&](BytesBuffer& bytes_buffer, uint64_t, auto) {
+          BytesBuffer uncompressed_bytes_buffer = bytes_buffer;
+          if (compression_level == kJournalBlobCompressionDisabled) {
+            EXPECT_FALSE(
+                JournalSerialization::IsCompressedJournalBlob(bytes_buffer));
+          } else {
+            EXPECT_TRUE(
+                JournalSerialization::IsCompressedJournalBlob(bytes_buffer));
+            EXPECT_LT(bytes_buffer.length, uncompressed_length);
+            EXPECT_SUCCESS(JournalSerialization::DecompressJournalBlob(
+                bytes_buffer, uncompressed_bytes_buffer));
+          }
+          EXPECT_EQ(uncompressed_bytes_buffer.length, uncompressed_length);
+
+          JournalLog journal_log;
+          size_t bytes_deserialized = 0;
+          EXPECT_SUCCESS(JournalSerialization::DeserializeJournalLog(
+              uncompressed_bytes_buffer, kLogHeaderByteLength, journal_log,
+              bytes_deserialized));
+          EXPECT_EQ(journal_log.log_body(), string(1000, 'a'));
+          is_called = true;
+          return SuccessExecutionResult();
+        };
+
+    mock_journal_output_stream.WriteBatch(flush_batch, 1);
+    EXPECT_TRUE(is_called);
+  }
+}
+
+TEST(JournalOutputStreamTests, BatchesAreAcknowledgedInOrder) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  async_executor_mock.schedule_mock = [](auto work) {
+    work();
+    return SuccessExecutionResult();
+  };
+
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr);
+  vector<function<void(ExecutionResult&)>> write_callbacks;
+  mock_journal_output_stream.write_journal_blob_mock =
+      [&](auto&, auto, auto callback) {
+        write_callbacks.push_back(callback);
+        return SuccessExecutionResult();
+      };
+
+  vector<int> acknowledged_batches;
+  for (int batch = 0; batch < 3; ++batch) {
+    AsyncContext<JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>
+        journal_stream_append_log_context;
+    journal_stream_append_log_context.request =
+        make_shared<JournalStreamAppendLogRequest>();
+    journal_stream_append_log_context.request->journal_log =
+        make_shared<JournalLog>();
+    journal_stream_append_log_context.callback = [&, batch](auto& context) {
+      acknowledged_batches.push_back(batch);
+    };
+    EXPECT_SUCCESS(mock_journal_output_stream.AppendLog(
+        journal_stream_append_log_context));
+    EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+  }
+  // All the batches are written concurrently.
+  EXPECT_EQ(write_callbacks.size(), 3);
+
+  ExecutionResult result = SuccessExecutionResult();
+  write_callbacks[2](result);
+  write_callbacks[1](result);
+  EXPECT_EQ(acknowledged_batches.size(), 0);
+
+  write_callbacks[0](result);
+  EXPECT_EQ(acknowledged_batches, vector<int>({0, 1, 2}));
+}
+
+TEST(JournalOutputStreamTests, FlushWaitsForRoomForConcurrentWrites) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  async_executor_mock.schedule_mock = [](auto work) {
+    work();
+    return SuccessExecutionResult();
+  };
+
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr, /*max_concurrent_blob_writes=*/1);
+  vector<function<void(ExecutionResult&)>> write_callbacks;
+  mock_journal_output_stream.write_journal_blob_mock =
+      [&](auto&, auto, auto callback) {
+        write_callbacks.push_back(callback);
+        return SuccessExecutionResult();
+      };
+
+  AsyncContext<JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>
+      journal_stream_append_log_context;
+  journal_stream_append_log_context.request =
+      make_shared<JournalStreamAppendLogRequest>();
+  journal_stream_append_log_context.request->journal_log =
+      make_shared<JournalLog>();
+  journal_stream_append_log_context.callback = [](auto&) {};
+
+  EXPECT_SUCCESS(
+      mock_journal_output_stream.AppendLog(journal_stream_append_log_context));
+  EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+  EXPECT_EQ(write_callbacks.size(), 1);
+
+  // The logs stay queued while the first batch is written.
+  EXPECT_SUCCESS(
+      mock_journal_output_stream.AppendLog(journal_stream_append_log_context));
+  EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+  EXPECT_EQ(write_callbacks.size(), 1);
+  EXPECT_EQ(mock_journal_output_stream.GetPendingLogsCount().load(), 1);
+
+  ExecutionResult result = SuccessExecutionResult();
+  write_callbacks[0](result);
+  EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+  EXPECT_EQ(write_callbacks.size(), 2);
+  EXPECT_EQ(mock_journal_output_stream.GetPendingLogsCount().load(), 0);
+}
+
+TEST(JournalOutputStreamTests, BatchesAreAcknowledgedFromLocalWriteAheadLog) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  async_executor_mock.schedule_mock = [](auto work) {
+    work();
+    return SuccessExecutionResult();
+  };
+
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+  auto mock_storage_client = make_shared<MockBlobStorageClient>();
+  vector<AsyncContext<PutBlobRequest, PutBlobResponse>> put_blob_contexts;
+  mock_storage_client->put_blob_mock = [&](auto& put_blob_context) {
+    put_blob_contexts.push_back(put_blob_context);
+    return SuccessExecutionResult();
+  };
+  shared_ptr<BlobStorageClientInterface> storage_client = mock_storage_client;
+
+  auto directory = std::filesystem::path(::testing::TempDir()) /
+                   "journal_output_stream_local_write_ahead_log";
+  std::filesystem::remove_all(directory);
+  auto local_write_ahead_log =
+      make_shared<JournalLocalWriteAheadLog>(directory.string(), "partition");
+  EXPECT_SUCCESS(local_write_ahead_log->Init());
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr, kDefaultJournalMaxConcurrentBlobWrites,
+      kJournalBlobCompressionDisabled, local_write_ahead_log);
+
+  AsyncContext<JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>
+      journal_stream_append_log_context;
+  journal_stream_append_log_context.request =
+      make_shared<JournalStreamAppendLogRequest>();
+  journal_stream_append_log_context.request->journal_log =
+      make_shared<JournalLog>();
+  bool is_acknowledged = false;
+  journal_stream_append_log_context.callback = [&](auto& context) {
+    EXPECT_SUCCESS(context.result);
+    is_acknowledged = true;
+  };
+  EXPECT_SUCCESS(
+      mock_journal_output_stream.AppendLog(journal_stream_append_log_context));
+  EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+
+  // The batch is acknowledged once in the local log, before the blob storage
+  // has it.
+  EXPECT_TRUE(is_acknowledged);
+  EXPECT_EQ(put_blob_contexts.size(), 1);
+  vector<JournalId> journal_ids;
+  EXPECT_SUCCESS(local_write_ahead_log->ListJournalIds(journal_ids));
+  EXPECT_EQ(journal_ids.size(), 1);
+  JournalId journal_id;
+  EXPECT_THAT(
+      mock_journal_output_stream.GetLastPersistedJournalId(journal_id),
+      ResultIs(FailureExecutionResult(
+          core::errors::SC_JOURNAL_SERVICE_NO_NEW_JOURNAL_ID_AVAILABLE)));
+
+  // The journal id is only persisted once the blob storage has the journal.
+  put_blob_contexts[0].result = SuccessExecutionResult();
+  put_blob_contexts[0].Finish();
+  EXPECT_SUCCESS(
+      mock_journal_output_stream.GetLastPersistedJournalId(journal_id));
+  EXPECT_EQ(journal_id, journal_ids[0]);
+  EXPECT_SUCCESS(local_write_ahead_log->ListJournalIds(journal_ids));
+  EXPECT_TRUE(journal_ids.empty());
+  std::filesystem::remove_all(directory);
+}
+
+TEST(JournalOutputStreamTests, StoppingWaitsForLocalJournalUploadRetries) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  async_executor_mock.schedule_mock = [](auto work) {
+    work();
+    return SuccessExecutionResult();
+  };
+  // The first retry is cancelled, the second one is already running when the
+  // uploads are stopped.
+  vector<AsyncOperation> scheduled_retries;
+  atomic<size_t> cancellation_count(0);
+  async_executor_mock.schedule_for_mock =
+      [&](const AsyncOperation& work, Timestamp,
+          function<bool()>& cancellation_callback) {
+        auto is_cancellable = scheduled_retries.empty();
+        scheduled_retries.push_back(work);
+        cancellation_callback = [&, is_cancellable]() {
+          cancellation_count++;
+          return is_cancellable;
+        };
+        return SuccessExecutionResult();
+      };
+
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+  auto mock_storage_client = make_shared<MockBlobStorageClient>();
+  atomic<size_t> put_blob_count(0);
+  mock_storage_client->put_blob_mock = [&](auto&) {
+    put_blob_count++;
+    return FailureExecutionResult(1234);
+  };
+  shared_ptr<BlobStorageClientInterface> storage_client = mock_storage_client;
+
+  auto directory = std::filesystem::path(::testing::TempDir()) /
+                   "journal_output_stream_stopped_local_write_ahead_log";
+  std::filesystem::remove_all(directory);
+  auto local_write_ahead_log =
+      make_shared<JournalLocalWriteAheadLog>(directory.string(), "partition");
+  EXPECT_SUCCESS(local_write_ahead_log->Init());
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr, kDefaultJournalMaxConcurrentBlobWrites,
+      kJournalBlobCompressionDisabled, local_write_ahead_log);
+
+  for (int i = 0; i < 2; ++i) {
+    AsyncContext<JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>
+        journal_stream_append_log_context;
+    journal_stream_append_log_context.request =
+        make_shared<JournalStreamAppendLogRequest>();
+    journal_stream_append_log_context.request->journal_log =
+        make_shared<JournalLog>();
+    journal_stream_append_log_context.callback = [](auto&) {};
+    EXPECT_SUCCESS(mock_journal_output_stream.AppendLog(
+        journal_stream_append_log_context));
+    EXPECT_SUCCESS(mock_journal_output_stream.FlushLogs());
+  }
+  EXPECT_EQ(put_blob_count.load(), 2);
+  ASSERT_EQ(scheduled_retries.size(), 2);
+
+  atomic<bool> is_stopped(false);
+  std::thread stopping_thread([&]() {
+    EXPECT_SUCCESS(mock_journal_output_stream.StopBackgroundWrites());
+    is_stopped = true;
+  });
+  WaitUntil([&]() { return cancellation_count.load() == 2; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(is_stopped.load());
+
+  // The running retry does not write the journal again.
+  scheduled_retries[1]();
+  stopping_thread.join();
+  EXPECT_TRUE(is_stopped.load());
+  EXPECT_EQ(put_blob_count.load(), 2);
+
+  // The journals are written to the blob storage by the next recovery.
+  vector<JournalId> journal_ids;
+  EXPECT_SUCCESS(local_write_ahead_log->ListJournalIds(journal_ids));
+  EXPECT_EQ(journal_ids.size(), 2);
+  std::filesystem::remove_all(directory);
+}
+
 TEST(JournalOutputStreamTests, GetSerializedLogByteSize) {
   auto bucket_name = make_shared<string>("bucket_name");
   auto partition_name = make_shared<string>("partition_name");
@@ -339,6 +736,39 @@ TEST(JournalOutputStreamTests, GetSerializedLogByteSize) {
           sizeof(uint64_t) + kLogHeaderByteLength);
 }
 
+TEST(JournalOutputStreamTests, GetSerializedLogByteSizeWithLogBody) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr);
+
+  AsyncContext<JournalStreamAppendLogRequest, JournalStreamAppendLogResponse>
+      journal_stream_append_log_context;
+  journal_stream_append_log_context.request =
+      make_shared<JournalStreamAppendLogRequest>();
+  journal_stream_append_log_context.request->journal_log =
+      make_shared<JournalLog>();
+  journal_stream_append_log_context.request->log_body =
+      make_shared<BytesBuffer>(string(100, 'a'));
+
+  // Same size as the log with the body copied in.
+  JournalLog journal_log;
+  journal_log.set_log_body(string(100, 'a'));
+  EXPECT_EQ(mock_journal_output_stream.GetSerializedLogByteSize(
+                journal_stream_append_log_context),
+            journal_log.ByteSizeLong() + sizeof(uint64_t) +
+                kLogHeaderByteLength);
+}
+
 TEST(JournalOutputStreamTests, SerializeLog) {
   auto bucket_name = make_shared<string>("bucket_name");
   auto partition_name = make_shared<string>("partition_name");
@@ -480,6 +910,45 @@ TEST(JournalOutputStreamTests, WriteJournalBlob) {
   }
 }
 
+TEST(JournalOutputStreamTests, WrittenBlobBuffersAreReused) {
+  auto bucket_name = make_shared<string>("bucket_name");
+  auto partition_name = make_shared<string>("partition_name");
+  MockAsyncExecutor async_executor_mock;
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutor>(move(async_executor_mock));
+
+  MockBlobStorageClient mock_storage_client;
+  shared_ptr<BlobStorageClientInterface> storage_client =
+      make_shared<MockBlobStorageClient>(move(mock_storage_client));
+
+  MockJournalOutputStream mock_journal_output_stream(
+      bucket_name, partition_name, async_executor, storage_client,
+      /*metric_router=*/nullptr);
+
+  auto buffer = mock_journal_output_stream.AcquireBlobBuffer(1000);
+  EXPECT_EQ(buffer->capacity, 1000);
+  EXPECT_EQ(buffer->length, 0);
+  auto* bytes = buffer->bytes.get();
+
+  AsyncContext<PutBlobRequest, PutBlobResponse> put_blob_context;
+  put_blob_context.request = make_shared<PutBlobRequest>();
+  put_blob_context.request->buffer = buffer;
+  buffer = nullptr;
+  put_blob_context.result = SuccessExecutionResult();
+  mock_journal_output_stream.OnWriteJournalBlobCallback(
+      1, [](ExecutionResult&) {}, put_blob_context);
+
+  // A smaller blob gets the whole buffer of the written one.
+  buffer = mock_journal_output_stream.AcquireBlobBuffer(10);
+  EXPECT_EQ(buffer->bytes.get(), bytes);
+  EXPECT_EQ(buffer->capacity, 1000);
+  EXPECT_EQ(buffer->length, 0);
+
+  // The pool is empty again.
+  EXPECT_NE(mock_journal_output_stream.AcquireBlobBuffer(10)->bytes.get(),
+            bytes);
+}
+
 TEST(JournalOutputStreamTests, WriteEmptyJournalBlob) {
   auto bucket_name = make_shared<string>("bucket_name");
   auto partition_name = make_shared<string>("partition_name");
@@ -16,6 +16,7 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "core/common/uuid/src/uuid.h"
@@ -30,6 +31,7 @@ using google::scp::core::journal_service::JournalLog;
 using google::scp::core::journal_service::JournalSerialization;
 using google::scp::core::journal_service::LastCheckpointMetadata;
 using std::make_shared;
+using std::string;
 using std::vector;
 
 namespace google::scp::core::test {
@@ -305,4 +307,137 @@ TEST(JournalServiceSerializationTests, JournalLogSerialization) {
   EXPECT_EQ(bytes_deserialized, bytes_serialized);
 }
 
+TEST(JournalServiceSerializationTests,
+     JournalLogSerializationWithSeparateLogBody) {
+  for (size_t log_body_length : {0, 10, 300}) {
+    BytesBuffer log_body(string(log_body_length, 'a'));
+    JournalLog journal_log;
+    journal_log.set_type(1234567);
+    JournalLog journal_log_with_body = journal_log;
+    journal_log_with_body.set_log_body(log_body.ToString());
+
+    size_t byte_size_required =
+        JournalSerialization::CalculateJournalLogByteSize(journal_log,
+                                                          log_body.length);
+    size_t expected_byte_size = 0;
+    EXPECT_EQ(JournalSerialization::CalculateSerializationByteSize(
+                  journal_log_with_body, expected_byte_size),
+              SuccessExecutionResult());
+    EXPECT_EQ(byte_size_required, expected_byte_size);
+
+    BytesBuffer bytes_buffer(byte_size_required);
+    size_t bytes_serialized = 0;
+    EXPECT_EQ(
+        JournalSerialization::SerializeJournalLog(
+            bytes_buffer, 0, journal_log, log_body, bytes_serialized),
+        SuccessExecutionResult());
+    EXPECT_EQ(bytes_serialized, byte_size_required);
+    bytes_buffer.length = bytes_serialized;
+
+    // The bytes are the ones of the journal log carrying its body.
+    BytesBuffer expected_bytes_buffer(expected_byte_size);
+    size_t expected_bytes_serialized = 0;
+    EXPECT_EQ(JournalSerialization::SerializeJournalLog(
+                  expected_bytes_buffer, 0, journal_log_with_body,
+                  expected_bytes_serialized),
+              SuccessExecutionResult());
+    EXPECT_EQ(*bytes_buffer.bytes, *expected_bytes_buffer.bytes);
+
+    JournalLog deserialized_journal_log;
+    size_t bytes_deserialized = 0;
+    EXPECT_EQ(JournalSerialization::DeserializeJournalLog(
+                  bytes_buffer, 0, deserialized_journal_log,
+                  bytes_deserialized),
+              SuccessExecutionResult());
+    EXPECT_EQ(bytes_deserialized, bytes_serialized);
+    EXPECT_EQ(deserialized_journal_log.type(), journal_log.type());
+    EXPECT_EQ(deserialized_journal_log.log_body(), log_body.ToString());
+  }
+}
+
+TEST(JournalServiceSerializationTests,
+     JournalLogSerializationWithSeparateLogBodyNeedsRoom) {
+  BytesBuffer log_body(string(10, 'a'));
+  JournalLog journal_log;
+  journal_log.set_type(1234567);
+
+  BytesBuffer bytes_buffer(JournalSerialization::CalculateJournalLogByteSize(
+                               journal_log, log_body.length) -
+                           1);
+  size_t bytes_serialized = 0;
+  EXPECT_EQ(JournalSerialization::SerializeJournalLog(
+                bytes_buffer, 0, journal_log, log_body, bytes_serialized),
+            FailureExecutionResult(
+                errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE));
+  EXPECT_EQ(bytes_serialized, 0);
+}
+
+TEST(JournalServiceSerializationTests, CompressedJournalBlobRoundTrip) {
+  BytesBuffer uncompressed_bytes_buffer(string(10000, 'a'));
+  EXPECT_FALSE(
+      JournalSerialization::IsCompressedJournalBlob(uncompressed_bytes_buffer));
+
+  BytesBuffer compressed_bytes_buffer(
+      JournalSerialization::CalculateMaxCompressedJournalBlobByteSize(
+          uncompressed_bytes_buffer.length));
+  EXPECT_EQ(JournalSerialization::CompressJournalBlob(
+                uncompressed_bytes_buffer, compressed_bytes_buffer,
+                /*compression_level=*/6),
+            SuccessExecutionResult());
+  EXPECT_TRUE(
+      JournalSerialization::IsCompressedJournalBlob(compressed_bytes_buffer));
+  EXPECT_LT(compressed_bytes_buffer.length, uncompressed_bytes_buffer.length);
+
+  BytesBuffer decompressed_bytes_buffer;
+  EXPECT_EQ(JournalSerialization::DecompressJournalBlob(
+                compressed_bytes_buffer, decompressed_bytes_buffer),
+            SuccessExecutionResult());
+  EXPECT_EQ(decompressed_bytes_buffer.ToString(),
+            uncompressed_bytes_buffer.ToString());
+}
+
+TEST(JournalServiceSerializationTests, CorruptedCompressedJournalBlob) {
+  BytesBuffer uncompressed_bytes_buffer(string(10000, 'a'));
+  BytesBuffer compressed_bytes_buffer(
+      JournalSerialization::CalculateMaxCompressedJournalBlobByteSize(
+          uncompressed_bytes_buffer.length));
+  EXPECT_EQ(JournalSerialization::CompressJournalBlob(
+                uncompressed_bytes_buffer, compressed_bytes_buffer,
+                /*compression_level=*/6),
+            SuccessExecutionResult());
+
+  BytesBuffer decompressed_bytes_buffer;
+  compressed_bytes_buffer.length -= 1;
+  EXPECT_EQ(JournalSerialization::DecompressJournalBlob(
+                compressed_bytes_buffer, decompressed_bytes_buffer),
+            FailureExecutionResult(
+                errors::SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB));
+
+  // The uncompressed length is bounded before being allocated.
+  compressed_bytes_buffer.length += 1;
+  for (uint64_t uncompressed_length :
+       {kMaxUncompressedJournalBlobByteLength + 1,
+        (compressed_bytes_buffer.length -
+         kCompressedJournalBlobHeaderByteLength) *
+                kMaxJournalBlobCompressionRatio +
+            1}) {
+    size_t bytes_serialized = 0;
+    EXPECT_EQ(core::common::Serialization::Serialize(
+                  compressed_bytes_buffer, 2 * sizeof(uint64_t),
+                  uncompressed_length, bytes_serialized),
+              SuccessExecutionResult());
+    EXPECT_EQ(JournalSerialization::DecompressJournalBlob(
+                  compressed_bytes_buffer, decompressed_bytes_buffer),
+              FailureExecutionResult(
+                  errors::SC_JOURNAL_SERVICE_CORRUPTED_COMPRESSED_BLOB));
+  }
+
+  // Not enough room for the compressed blob.
+  BytesBuffer small_bytes_buffer(kCompressedJournalBlobHeaderByteLength + 1);
+  EXPECT_EQ(JournalSerialization::CompressJournalBlob(
+                uncompressed_bytes_buffer, small_bytes_buffer,
+                /*compression_level=*/6),
+            FailureExecutionResult(
+                errors::SC_JOURNAL_SERVICE_BLOB_COMPRESSION_FAILED));
+}
 }  // namespace google::scp::core::test
@@ -16,9 +16,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -33,6 +38,7 @@
 #include "core/common/concurrent_map/src/error_codes.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/config_provider/mock/mock_config_provider.h"
+#include "core/interface/configuration_keys.h"
 #include "core/journal_service/mock/mock_journal_input_stream.h"
 #include "core/journal_service/mock/mock_journal_output_stream.h"
 #include "core/journal_service/mock/mock_journal_service_with_overrides.h"
@@ -476,6 +482,240 @@ TEST_F(JournalServiceTests,
   EXPECT_EQ(replayed_logs->size(), 1);
 }
 
+TEST_F(JournalServiceTests,
+       OnJournalStreamReadLogCallbackAppliesParallelSubscribersInOrder) {
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, mock_config_provider_);
+  shared_ptr<BlobStorageClientInterface> blob_storage_client;
+  mock_blob_storage_provider_->CreateBlobStorageClient(blob_storage_client);
+
+  auto mock_input_stream = make_shared<MockJournalInputStream>(
+      bucket_name_, partition_name_, blob_storage_client,
+      std::make_shared<EnvConfigProvider>());
+  absl::Notification notification;
+  mock_input_stream->read_log_mock =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&) {
+        notification.Notify();
+        return SuccessExecutionResult();
+      };
+  shared_ptr<JournalInputStreamInterface> input_stream =
+      static_pointer_cast<JournalInputStreamInterface>(mock_input_stream);
+  journal_service.SetInputStream(input_stream);
+
+  // Components 1 and 2 are recovered in parallel, component 3 in order.
+  std::mutex applied_logs_mutex;
+  vector<string> applied_logs;
+  auto callback = [&](const shared_ptr<BytesBuffer>& bytes_buffer,
+                      const Uuid&) {
+    std::unique_lock lock(applied_logs_mutex);
+    applied_logs.push_back(bytes_buffer->ToString());
+    return SuccessExecutionResult();
+  };
+  Uuid component_ids[] = {Uuid::GenerateUuid(), Uuid::GenerateUuid(),
+                          Uuid::GenerateUuid()};
+  EXPECT_SUCCESS(
+      journal_service.SubscribeForParallelRecovery(component_ids[0], callback));
+  EXPECT_SUCCESS(
+      journal_service.SubscribeForParallelRecovery(component_ids[1], callback));
+  EXPECT_SUCCESS(
+      journal_service.SubscribeForRecovery(component_ids[2], callback));
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      read_log_context;
+  read_log_context.response = make_shared<JournalStreamReadLogResponse>();
+  read_log_context.response->read_logs =
+      make_shared<vector<JournalStreamReadLogObject>>();
+  read_log_context.result = SuccessExecutionResult();
+  // The log bodies are "<component>-<log>".
+  vector<std::pair<size_t, string>> logs = {
+      {0, "0-0"}, {1, "1-0"}, {0, "0-1"}, {0, "0-2"},
+      {2, "2-0"}, {1, "1-1"}, {0, "0-3"}};
+  for (const auto& [component_index, log_body] : logs) {
+    JournalStreamReadLogObject log_object;
+    log_object.log_id = Uuid::GenerateUuid();
+    log_object.component_id = component_ids[component_index];
+    log_object.journal_log = make_shared<JournalLog>();
+    log_object.journal_log->set_log_body(log_body);
+    read_log_context.response->read_logs->push_back(log_object);
+  }
+
+  atomic<bool> recover_failed(false);
+  AsyncContext<JournalRecoverRequest, JournalRecoverResponse>
+      journal_recover_context;
+  journal_recover_context.callback =
+      [&](AsyncContext<JournalRecoverRequest, JournalRecoverResponse>&) {
+        recover_failed = true;
+      };
+  auto time_event = make_shared<TimeEvent>();
+  auto replayed_logs = make_shared<unordered_set<string>>();
+  journal_service.OnJournalStreamReadLogCallback(
+      time_event, replayed_logs, journal_recover_context, read_log_context);
+  notification.WaitForNotification();
+  EXPECT_FALSE(recover_failed);
+
+  ASSERT_EQ(applied_logs.size(), logs.size());
+  auto position = [&](const string& log_body) {
+    return std::find(applied_logs.begin(), applied_logs.end(), log_body) -
+           applied_logs.begin();
+  };
+  // The logs of a component are applied in order.
+  EXPECT_LT(position("0-0"), position("0-1"));
+  EXPECT_LT(position("0-1"), position("0-2"));
+  EXPECT_LT(position("1-0"), position("1-1"));
+  // The log of the ordered component is applied after all the logs before it,
+  // and before all the logs after it.
+  EXPECT_EQ(position("2-0"), 4);
+  EXPECT_GT(position("1-1"), 4);
+  EXPECT_GT(position("0-3"), 4);
+}
+
+TEST_F(JournalServiceTests,
+       OnJournalStreamReadLogCallbackForgetsLogIdsOutsideTheDedupWindow) {
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, mock_config_provider_);
+  journal_service.EnableStreamingReplay(
+      /*recovery_dedup_window_in_seconds=*/5);
+  shared_ptr<BlobStorageClientInterface> blob_storage_client;
+  mock_blob_storage_provider_->CreateBlobStorageClient(blob_storage_client);
+
+  auto mock_input_stream = make_shared<MockJournalInputStream>(
+      bucket_name_, partition_name_, blob_storage_client,
+      std::make_shared<EnvConfigProvider>());
+  atomic<size_t> read_log_count(0);
+  mock_input_stream->read_log_mock =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&) {
+        read_log_count++;
+        return SuccessExecutionResult();
+      };
+  shared_ptr<JournalInputStreamInterface> input_stream =
+      static_pointer_cast<JournalInputStreamInterface>(mock_input_stream);
+  journal_service.SetInputStream(input_stream);
+
+  vector<string> applied_logs;
+  auto component_id = Uuid::GenerateUuid();
+  EXPECT_SUCCESS(journal_service.SubscribeForRecovery(
+      component_id,
+      [&](const shared_ptr<BytesBuffer>& bytes_buffer, const Uuid&) {
+        applied_logs.push_back(bytes_buffer->ToString());
+        return SuccessExecutionResult();
+      }));
+
+  // The journal ids are wall times in nanoseconds.
+  constexpr JournalId kSecond = 1000000000;
+  auto log_id_1 = Uuid::GenerateUuid();
+  auto log_id_2 = Uuid::GenerateUuid();
+  vector<std::tuple<Uuid, JournalId, string>> logs = {
+      {log_id_1, 100 * kSecond, "1"},
+      {log_id_2, 110 * kSecond, "2"},
+      // Within the window of log 2, but not of log 1.
+      {log_id_2, 112 * kSecond, "2"},
+      {log_id_1, 112 * kSecond, "1"}};
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      read_log_context;
+  read_log_context.response = make_shared<JournalStreamReadLogResponse>();
+  read_log_context.response->read_logs =
+      make_shared<vector<JournalStreamReadLogObject>>();
+  read_log_context.result = SuccessExecutionResult();
+  for (const auto& [log_id, journal_id, log_body] : logs) {
+    JournalStreamReadLogObject log_object;
+    log_object.log_id = log_id;
+    log_object.component_id = component_id;
+    log_object.journal_id = journal_id;
+    log_object.journal_log = make_shared<JournalLog>();
+    log_object.journal_log->set_log_body(log_body);
+    read_log_context.response->read_logs->push_back(log_object);
+  }
+
+  AsyncContext<JournalRecoverRequest, JournalRecoverResponse>
+      journal_recover_context;
+  auto time_event = make_shared<TimeEvent>();
+  auto replayed_logs = make_shared<unordered_set<string>>();
+  journal_service.OnJournalStreamReadLogCallback(
+      time_event, replayed_logs, journal_recover_context, read_log_context);
+  WaitUntil([&]() { return read_log_count.load() == 1; });
+
+  EXPECT_EQ(applied_logs, vector<string>({"1", "2", "1"}));
+  EXPECT_EQ(replayed_logs->size(), 2);
+}
+
+TEST_F(JournalServiceTests,
+       OnJournalStreamReadLogCallbackTracksRecoveredComponents) {
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, mock_config_provider_);
+  journal_service.TrackRecoveredComponents();
+  shared_ptr<BlobStorageClientInterface> blob_storage_client;
+  mock_blob_storage_provider_->CreateBlobStorageClient(blob_storage_client);
+
+  auto mock_input_stream = make_shared<MockJournalInputStream>(
+      bucket_name_, partition_name_, blob_storage_client,
+      std::make_shared<EnvConfigProvider>());
+  atomic<size_t> read_log_count(0);
+  mock_input_stream->read_log_mock =
+      [&](AsyncContext<JournalStreamReadLogRequest,
+                       JournalStreamReadLogResponse>&) {
+        read_log_count++;
+        return SuccessExecutionResult();
+      };
+  shared_ptr<JournalInputStreamInterface> input_stream =
+      static_pointer_cast<JournalInputStreamInterface>(mock_input_stream);
+  journal_service.SetInputStream(input_stream);
+
+  auto checkpoint_component_id = Uuid::GenerateUuid();
+  auto journal_component_id = Uuid::GenerateUuid();
+  for (const auto& component_id :
+       {checkpoint_component_id, journal_component_id}) {
+    EXPECT_SUCCESS(journal_service.SubscribeForRecovery(
+        component_id, [](const shared_ptr<BytesBuffer>&, const Uuid&) {
+          return SuccessExecutionResult();
+        }));
+  }
+
+  AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
+      read_log_context;
+  read_log_context.response = make_shared<JournalStreamReadLogResponse>();
+  read_log_context.response->read_logs =
+      make_shared<vector<JournalStreamReadLogObject>>();
+  read_log_context.result = SuccessExecutionResult();
+  vector<std::tuple<Uuid, JournalId, bool>> logs = {
+      {checkpoint_component_id, 100, true},
+      {journal_component_id, 100, true},
+      {journal_component_id, 200, false}};
+  for (const auto& [component_id, journal_id, is_checkpoint_log] : logs) {
+    JournalStreamReadLogObject log_object;
+    log_object.log_id = Uuid::GenerateUuid();
+    log_object.component_id = component_id;
+    log_object.journal_id = journal_id;
+    log_object.is_checkpoint_log = is_checkpoint_log;
+    log_object.journal_log = make_shared<JournalLog>();
+    read_log_context.response->read_logs->push_back(log_object);
+  }
+
+  AsyncContext<JournalRecoverRequest, JournalRecoverResponse>
+      journal_recover_context;
+  auto time_event = make_shared<TimeEvent>();
+  auto replayed_logs = make_shared<unordered_set<string>>();
+  journal_service.OnJournalStreamReadLogCallback(
+      time_event, replayed_logs, journal_recover_context, read_log_context);
+  WaitUntil([&]() { return read_log_count.load() == 1; });
+
+  EXPECT_EQ(journal_service.GetRecoveredCheckpointId(), 100);
+  auto recovered_components = journal_service.GetRecoveredComponents();
+  EXPECT_EQ(recovered_components->checkpoint_component_ids,
+            (unordered_set<Uuid, common::UuidHash>(
+                {checkpoint_component_id, journal_component_id})));
+  EXPECT_EQ(recovered_components->journal_component_ids,
+            (unordered_set<Uuid, common::UuidHash>({journal_component_id})));
+}
+
 TEST_F(JournalServiceTests, OnJournalStreamAppendLogCallback) {
   MockJournalServiceWithOverrides journal_service(
       bucket_name_, partition_name_, async_executor_,
@@ -618,6 +858,242 @@ TEST_F(JournalServiceTests, UnsubscribeForRecovery) {
   }
 }
 
+/// Counts the flushes and drops the logs.
+class FlushCountingJournalOutputStream : public JournalOutputStreamInterface {
+ public:
+  ExecutionResult AppendLog(
+      AsyncContext<JournalStreamAppendLogRequest,
+                   JournalStreamAppendLogResponse>&) noexcept override {
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult GetLastPersistedJournalId(
+      JournalId& journal_id) noexcept override {
+    journal_id = last_persisted_journal_id;
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult FlushLogs() noexcept override {
+    flush_count++;
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult StopBackgroundWrites() noexcept override {
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult GetUnpersistedBatchCount(
+      size_t& batch_count) noexcept override {
+    batch_count = unpersisted_batch_count;
+    return SuccessExecutionResult();
+  }
+
+  atomic<size_t> flush_count{0};
+  atomic<size_t> unpersisted_batch_count{0};
+  JournalId last_persisted_journal_id = 0;
+};
+
+TEST_F(JournalServiceTests, GroupCommitFlushesOnceEnoughBytesArePending) {
+  auto config_provider = make_shared<MockConfigProvider>();
+  config_provider->SetInt(kPBSJournalServiceGroupCommitMaxPendingBytes, 100);
+  // Long enough for the deadline not to trigger the flush.
+  config_provider->SetInt(
+      kPBSJournalServiceGroupCommitMaxLatencyInMilliseconds, 100000);
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, config_provider);
+  auto output_stream = make_shared<FlushCountingJournalOutputStream>();
+  shared_ptr<JournalOutputStreamInterface> output_stream_interface =
+      output_stream;
+  journal_service.SetOutputStream(output_stream_interface);
+  EXPECT_SUCCESS(journal_service.Init());
+  EXPECT_SUCCESS(journal_service.Run());
+
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->data = make_shared<BytesBuffer>(60);
+  journal_log_context.request->data->length = 60;
+
+  EXPECT_SUCCESS(journal_service.Log(journal_log_context));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(output_stream->flush_count.load(), 0);
+
+  EXPECT_SUCCESS(journal_service.Log(journal_log_context));
+  WaitUntil([&]() { return output_stream->flush_count.load() == 1; });
+
+  EXPECT_SUCCESS(journal_service.Stop());
+}
+
+TEST_F(JournalServiceTests, GroupCommitFlushesAtTheDeadline) {
+  auto config_provider = make_shared<MockConfigProvider>();
+  config_provider->SetInt(kPBSJournalServiceGroupCommitMaxPendingBytes,
+                          1000000);
+  config_provider->SetInt(
+      kPBSJournalServiceGroupCommitMaxLatencyInMilliseconds, 10);
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, config_provider);
+  auto output_stream = make_shared<FlushCountingJournalOutputStream>();
+  shared_ptr<JournalOutputStreamInterface> output_stream_interface =
+      output_stream;
+  journal_service.SetOutputStream(output_stream_interface);
+  EXPECT_SUCCESS(journal_service.Init());
+  EXPECT_SUCCESS(journal_service.Run());
+
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->data = make_shared<BytesBuffer>(60);
+  journal_log_context.request->data->length = 60;
+  EXPECT_SUCCESS(journal_service.Log(journal_log_context));
+
+  // Small logs are still flushed once they waited the max latency.
+  WaitUntil([&]() { return output_stream->flush_count.load() > 0; });
+
+  EXPECT_SUCCESS(journal_service.Stop());
+}
+
+class PendingAppendsJournalOutputStream
+    : public JournalOutputStreamInterface {
+ public:
+  ExecutionResult AppendLog(
+      AsyncContext<JournalStreamAppendLogRequest,
+                   JournalStreamAppendLogResponse>& append_log_context) noexcept
+      override {
+    if (!append_log_result.Successful()) {
+      return append_log_result;
+    }
+    pending_appends.push_back(append_log_context);
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult GetLastPersistedJournalId(JournalId&) noexcept override {
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult FlushLogs() noexcept override {
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult StopBackgroundWrites() noexcept override {
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult GetUnpersistedBatchCount(
+      size_t& batch_count) noexcept override {
+    batch_count = 0;
+    return SuccessExecutionResult();
+  }
+
+  ExecutionResult append_log_result = SuccessExecutionResult();
+  vector<AsyncContext<JournalStreamAppendLogRequest,
+                      JournalStreamAppendLogResponse>>
+      pending_appends;
+};
+
+TEST_F(JournalServiceTests, GetLogCountsTracksLogsInFlight) {
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, mock_config_provider_);
+  auto output_stream = make_shared<PendingAppendsJournalOutputStream>();
+  shared_ptr<JournalOutputStreamInterface> output_stream_interface =
+      output_stream;
+  journal_service.SetOutputStream(output_stream_interface);
+
+  size_t appended_log_count = 1;
+  size_t acknowledged_log_count = 1;
+  EXPECT_SUCCESS(journal_service.GetLogCounts(appended_log_count,
+                                              acknowledged_log_count));
+  EXPECT_EQ(appended_log_count, 0);
+  EXPECT_EQ(acknowledged_log_count, 0);
+
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->data = make_shared<BytesBuffer>(60);
+  journal_log_context.request->data->length = 60;
+  journal_log_context.callback =
+      [](AsyncContext<JournalLogRequest, JournalLogResponse>&) {};
+  EXPECT_SUCCESS(journal_service.Log(journal_log_context));
+  EXPECT_SUCCESS(journal_service.Log(journal_log_context));
+  EXPECT_SUCCESS(journal_service.GetLogCounts(appended_log_count,
+                                              acknowledged_log_count));
+  EXPECT_EQ(appended_log_count, 2);
+  EXPECT_EQ(acknowledged_log_count, 0);
+
+  // A log failing to append is not in flight.
+  output_stream->append_log_result = FailureExecutionResult(123);
+  EXPECT_THAT(journal_service.Log(journal_log_context),
+              ResultIs(FailureExecutionResult(123)));
+  EXPECT_SUCCESS(journal_service.GetLogCounts(appended_log_count,
+                                              acknowledged_log_count));
+  EXPECT_EQ(appended_log_count, 3);
+  EXPECT_EQ(acknowledged_log_count, 1);
+
+  for (auto& pending_append : output_stream->pending_appends) {
+    pending_append.result = SuccessExecutionResult();
+    pending_append.Finish();
+  }
+  EXPECT_SUCCESS(journal_service.GetLogCounts(appended_log_count,
+                                              acknowledged_log_count));
+  EXPECT_EQ(appended_log_count, 3);
+  EXPECT_EQ(acknowledged_log_count, 3);
+}
+
+TEST_F(JournalServiceTests, PauseFlushingWaitsForTheFlushedLogs) {
+  auto config_provider = make_shared<MockConfigProvider>();
+  config_provider->SetInt(kPBSJournalServiceGroupCommitMaxPendingBytes,
+                          1000000);
+  config_provider->SetInt(
+      kPBSJournalServiceGroupCommitMaxLatencyInMilliseconds, 10);
+  MockJournalServiceWithOverrides journal_service(
+      bucket_name_, partition_name_, async_executor_,
+      mock_blob_storage_provider_, mock_metric_client_,
+      /*metric_router=*/nullptr, config_provider);
+  auto output_stream = make_shared<FlushCountingJournalOutputStream>();
+  output_stream->last_persisted_journal_id = 5;
+  shared_ptr<JournalOutputStreamInterface> output_stream_interface =
+      output_stream;
+  journal_service.SetOutputStream(output_stream_interface);
+  EXPECT_SUCCESS(journal_service.Init());
+  EXPECT_SUCCESS(journal_service.Run());
+
+  // A flushed batch is not persisted in time.
+  output_stream->unpersisted_batch_count = 1;
+  JournalId last_persisted_journal_id = 0;
+  EXPECT_THAT(
+      journal_service.PauseFlushing(5, last_persisted_journal_id),
+      ResultIs(FailureExecutionResult(
+          errors::SC_JOURNAL_SERVICE_FLUSHED_LOGS_NOT_PERSISTED)));
+  EXPECT_THAT(journal_service.ResumeFlushing(),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_JOURNAL_SERVICE_FLUSHING_NOT_PAUSED)));
+
+  output_stream->unpersisted_batch_count = 0;
+  EXPECT_SUCCESS(journal_service.PauseFlushing(5, last_persisted_journal_id));
+  EXPECT_EQ(last_persisted_journal_id, 5);
+  EXPECT_THAT(journal_service.PauseFlushing(5, last_persisted_journal_id),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_JOURNAL_SERVICE_FLUSHING_ALREADY_PAUSED)));
+
+  // The logs are appended, but not flushed until the flushing resumes.
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->data = make_shared<BytesBuffer>(60);
+  journal_log_context.request->data->length = 60;
+  auto flush_count = output_stream->flush_count.load();
+  EXPECT_SUCCESS(journal_service.Log(journal_log_context));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(output_stream->flush_count.load(), flush_count);
+
+  EXPECT_SUCCESS(journal_service.ResumeFlushing());
+  WaitUntil(
+      [&]() { return output_stream->flush_count.load() > flush_count; });
+
+  EXPECT_SUCCESS(journal_service.Stop());
+}
+
 TEST_F(JournalServiceTests, GetLastPersistedJournalIdWithoutRecovery) {
   MockJournalServiceWithOverrides journal_service(
       bucket_name_, partition_name_, async_executor_,
@@ -42,6 +42,25 @@ TEST(JournalUtilsTests, CreateCheckpointBlobName) {
   EXPECT_EQ(*blob_name, "partition_name/checkpoint_00000000000000010000");
 }
 
+TEST(JournalUtilsTests, CreateCheckpointShardBlobName) {
+  auto partition_name = make_shared<string>("partition_name");
+  shared_ptr<string> blob_name;
+  EXPECT_SUCCESS(JournalUtils::CreateCheckpointShardBlobName(
+      partition_name, 10000, 0, blob_name));
+  EXPECT_EQ(*blob_name, "partition_name/checkpoint_00000000000000010000");
+
+  EXPECT_SUCCESS(JournalUtils::CreateCheckpointShardBlobName(
+      partition_name, 10000, 3, blob_name));
+  EXPECT_EQ(*blob_name, "partition_name/checkpoint_00000000000000010000_3");
+
+  // The shards are listed as blobs of the checkpoint they belong to.
+  CheckpointId checkpoint_id = 0;
+  EXPECT_SUCCESS(
+      JournalUtils::ExtractCheckpointId(partition_name, blob_name,
+                                        checkpoint_id));
+  EXPECT_EQ(checkpoint_id, 10000);
+}
+
 TEST(JournalUtilsTests, CreateJournalBlobName) {
   shared_ptr<string> partition_name;
   shared_ptr<string> blob_name;
@@ -126,7 +126,8 @@ ExecutionResult WriteJournalLogs(
 ExecutionResult WriteCheckpoint(
     const JournalLog& journal_log, JournalId last_processed_journal_id,
     std::string_view file_postfix,
-    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client) {
+    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client,
+    size_t shard_count) {
   auto journal_bytes_buffer = JournalLogToBytesBuffer(journal_log);
   if (!journal_bytes_buffer.Successful()) {
     return journal_bytes_buffer.result();
@@ -134,6 +135,7 @@ ExecutionResult WriteCheckpoint(
 
   CheckpointMetadata checkpoint_metdata;
   checkpoint_metdata.set_last_processed_journal_id(last_processed_journal_id);
+  checkpoint_metdata.set_shard_count(shard_count);
   size_t byte_size_required = 0;
   if (auto result = JournalSerialization::CalculateSerializationByteSize(
           checkpoint_metdata, byte_size_required);
@@ -164,9 +166,13 @@ ExecutionResult WriteCheckpoint(
 
 ExecutionResult WriteLastCheckpoint(
     CheckpointId checkpoint_id,
-    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client) {
+    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client,
+    size_t shard_count, JournalId last_processed_journal_id) {
   LastCheckpointMetadata last_checkpoint_metadata;
   last_checkpoint_metadata.set_last_checkpoint_id(checkpoint_id);
+  last_checkpoint_metadata.set_last_checkpoint_shard_count(shard_count);
+  last_checkpoint_metadata.set_last_processed_journal_id(
+      last_processed_journal_id);
 
   BytesBuffer last_checkpoint_buffer(1000);
   size_t current_bytes_serialized = 0;
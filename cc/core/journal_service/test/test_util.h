@@ -46,11 +46,13 @@ ExecutionResult WriteJournalLogs(
 ExecutionResult WriteCheckpoint(
     const journal_service::JournalLog& journal_log,
     JournalId last_processed_journal_id, std::string_view file_postfix,
-    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client);
+    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client,
+    size_t shard_count = 0);
 
 ExecutionResult WriteLastCheckpoint(
     CheckpointId checkpoint_id,
-    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client);
+    blob_storage_provider::mock::MockBlobStorageClient& mock_storage_client,
+    size_t shard_count = 0, JournalId last_processed_journal_id = 0);
 
 std::string JournalIdToString(uint64_t journal_id);
 AsyncContext<JournalStreamReadLogRequest, JournalStreamReadLogResponse>
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <vector>
+
+#include "core/interface/lease_manager_interface.h"
+
+namespace google::scp::core::lease_manager::mock {
+class MockLeasableLockBatchRefresher
+    : public testing::NiceMock<LeasableLockBatchRefresherInterface> {
+ public:
+  MOCK_METHOD(std::vector<ExecutionResult>, RefreshLeases,
+              ((const std::vector<std::shared_ptr<LeasableLockInterface>>&),
+               (const std::vector<bool>&)),
+              (noexcept, override));
+};
+}  // namespace google::scp::core::lease_manager::mock
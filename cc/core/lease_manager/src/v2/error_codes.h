@@ -80,4 +80,12 @@ DEFINE_ERROR_CODE(SC_LEASE_LIVENESS_ENFORCER_CANNOT_SET_THREAD_PRIORITY,
                   "Cannot set priority of the lease enforcer thread",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
 
+DEFINE_ERROR_CODE(SC_LEASE_REFRESH_DRIVER_ALREADY_RUNNING, SC_LEASE_MANAGER_V2,
+                  0x000F, "Lease refresh driver is already running.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_LEASE_REFRESH_DRIVER_NOT_RUNNING, SC_LEASE_MANAGER_V2,
+                  0x0010, "Lease refresh driver is not running.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
 }  // namespace google::scp::core::errors
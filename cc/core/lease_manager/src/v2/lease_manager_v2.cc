@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <optional>
+#include <unordered_set>
 #include <vector>
 
 #include "core/common/global_logger/src/global_logger.h"
@@ -236,7 +237,9 @@ void LeaseManagerV2::SafeToReleaseLease(
 }
 
 // Should be invoked under lock on lease_preference_manager_mutex_
-void LeaseManagerV2::TryHoldMoreLeases(size_t new_leases_to_hold_count) {
+void LeaseManagerV2::TryHoldMoreLeases(
+    size_t new_leases_to_hold_count,
+    const vector<LeasableLockId>& preferred_lock_ids) {
   // Step 1) Check the ones already set to hold lease and effectively
   // changing the leases to hold count.
   size_t intention_set_count = 0;
@@ -278,11 +281,14 @@ void LeaseManagerV2::TryHoldMoreLeases(size_t new_leases_to_hold_count) {
     return;
   }
 
-  // Step 2) Set the new ones to hold.
-  for (auto& [lock_id, refresher_wrapper] : lease_refreshers_) {
+  // Step 2) Set the new ones to hold, the preferred ones first.
+  for (const auto& lock_id :
+       GetLockIdsInPreferenceOrder(preferred_lock_ids,
+                                   true /* preferred first */)) {
     if (effective_leases_to_hold_count == 0) {
       break;
     }
+    auto& refresher_wrapper = lease_refreshers_.at(lock_id);
     auto no_one_currently_holding_lease =
         !refresher_wrapper.leasable_lock->GetCurrentLeaseOwnerInfo()
              .has_value();
@@ -313,7 +319,9 @@ void LeaseManagerV2::TryHoldMoreLeases(size_t new_leases_to_hold_count) {
 }
 
 // Should be invoked under lock on lease_preference_manager_mutex_
-void LeaseManagerV2::TryReleaseSomeLeases(size_t leases_to_release_count) {
+void LeaseManagerV2::TryReleaseSomeLeases(
+    size_t leases_to_release_count,
+    const vector<LeasableLockId>& preferred_lock_ids) {
   // Step 1) Check the ones already set to release lease and
   // changing the leases to release count accordingly.
   size_t intention_set_count = 0;
@@ -342,11 +350,15 @@ void LeaseManagerV2::TryReleaseSomeLeases(size_t leases_to_release_count) {
   // Step 2) Set the new ones to release by setting the intention to
   // release. Once the lease is deemed to be released via
   // SafeToReleaseLease(), the lease will be released i.e.
-  // RefreshWithNoIntentionToHoldLease will be set on it.
-  for (auto& [lock_id, refresher_wrapper] : lease_refreshers_) {
+  // RefreshWithNoIntentionToHoldLease will be set on it. The preferred ones
+  // are released last.
+  for (const auto& lock_id :
+       GetLockIdsInPreferenceOrder(preferred_lock_ids,
+                                   false /* preferred last */)) {
     if (effective_leases_to_release_count == 0) {
       break;
     }
+    auto& refresher_wrapper = lease_refreshers_.at(lock_id);
     if (refresher_wrapper.lease_refresher_handle->GetLeaseRefreshMode() ==
             LeaseRefreshMode::RefreshWithIntentionToHoldLease &&
         refresher_wrapper.leasable_lock->IsCurrentLeaseOwner()) {
@@ -375,6 +387,29 @@ void LeaseManagerV2::TryReleaseSomeLeases(size_t leases_to_release_count) {
   }
 }
 
+vector<LeasableLockId> LeaseManagerV2::GetLockIdsInPreferenceOrder(
+    const vector<LeasableLockId>& preferred_lock_ids, bool preferred_first) {
+  vector<LeasableLockId> preferred;
+  std::unordered_set<LeasableLockId, common::UuidHash> preferred_set;
+  for (const auto& lock_id : preferred_lock_ids) {
+    if (lease_refreshers_.count(lock_id) > 0 &&
+        preferred_set.insert(lock_id).second) {
+      preferred.push_back(lock_id);
+    }
+  }
+  vector<LeasableLockId> others;
+  for (const auto& [lock_id, _] : lease_refreshers_) {
+    if (preferred_set.count(lock_id) == 0) {
+      others.push_back(lock_id);
+    }
+  }
+
+  auto& first = preferred_first ? preferred : others;
+  auto& last = preferred_first ? others : preferred;
+  first.insert(first.end(), last.begin(), last.end());
+  return move(first);
+}
+
 void LeaseManagerV2::
     RevertTheIntentionToHoldLeaseForLocksWhichCannotBeLeased() {
   // Move back the ones that cannot be leased and changing the leases
@@ -437,13 +472,15 @@ void LeaseManagerV2::PerformLeaseAcquisitionPreferenceManagement() {
       lease_preference_snapshot.maximum_number_of_leases_to_hold) {
     TryHoldMoreLeases(
         lease_preference_snapshot.maximum_number_of_leases_to_hold -
-        leases_held_count);
+            leases_held_count,
+        lease_preference_snapshot.preferred_locks_to_acquire_leases_on);
   } else if (leases_held_count >
              lease_preference_snapshot.maximum_number_of_leases_to_hold) {
     // Should release some leases.
     TryReleaseSomeLeases(
         leases_held_count -
-        lease_preference_snapshot.maximum_number_of_leases_to_hold);
+            lease_preference_snapshot.maximum_number_of_leases_to_hold,
+        lease_preference_snapshot.preferred_locks_to_acquire_leases_on);
   } else {
     // Lease count has met the desired count.
   }
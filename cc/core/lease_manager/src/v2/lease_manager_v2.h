@@ -20,6 +20,7 @@
 #include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_executor_interface.h"
@@ -111,9 +112,21 @@ class LeaseManagerV2 : public LeaseManagerV2Interface,
  protected:
   void LeaseAcquisitionPreferenceManagerThreadFunction();
 
-  void TryHoldMoreLeases(size_t leases_to_hold_count);
+  void TryHoldMoreLeases(
+      size_t leases_to_hold_count,
+      const std::vector<LeasableLockId>& preferred_lock_ids);
 
-  void TryReleaseSomeLeases(size_t number_of_leases_to_release);
+  void TryReleaseSomeLeases(
+      size_t number_of_leases_to_release,
+      const std::vector<LeasableLockId>& preferred_lock_ids);
+
+  /**
+   * @brief Get the IDs of the managed locks, with the preferred ones first if
+   * preferred_first is set, or last otherwise.
+   */
+  std::vector<LeasableLockId> GetLockIdsInPreferenceOrder(
+      const std::vector<LeasableLockId>& preferred_lock_ids,
+      bool preferred_first);
 
   void RevertTheIntentionToHoldLeaseForLocksWhichCannotBeLeased();
 
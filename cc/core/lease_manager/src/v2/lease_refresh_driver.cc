@@ -0,0 +1,142 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lease_refresh_driver.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
+
+#include "error_codes.h"
+#include "lease_refresher.h"
+
+using google::scp::core::common::Uuid;
+using std::make_unique;
+using std::shared_ptr;
+using std::thread;
+using std::vector;
+using std::chrono::milliseconds;
+using std::this_thread::sleep_for;
+
+static constexpr char kLeaseRefreshDriver[] = "LeaseRefreshDriver";
+static constexpr milliseconds kLeaseRefreshInvocationIntervalInMilliseconds =
+    milliseconds(1000);
+
+namespace google::scp::core {
+LeaseRefreshDriver::LeaseRefreshDriver(
+    const shared_ptr<LeasableLockBatchRefresherInterface>&
+        leasable_lock_batch_refresher)
+    : leasable_lock_batch_refresher_(leasable_lock_batch_refresher),
+      is_running_(false),
+      object_activity_id_(Uuid::GenerateUuid()) {}
+
+ExecutionResult LeaseRefreshDriver::Init() noexcept {
+  return SuccessExecutionResult();
+}
+
+ExecutionResult LeaseRefreshDriver::Run() noexcept {
+  if (is_running_) {
+    return FailureExecutionResult(
+        errors::SC_LEASE_REFRESH_DRIVER_ALREADY_RUNNING);
+  }
+  is_running_ = true;
+  lease_refresh_thread_ =
+      make_unique<thread>([this]() { LeaseRefreshThreadFunction(); });
+  return SuccessExecutionResult();
+}
+
+ExecutionResult LeaseRefreshDriver::Stop() noexcept {
+  if (!is_running_) {
+    return FailureExecutionResult(errors::SC_LEASE_REFRESH_DRIVER_NOT_RUNNING);
+  }
+  is_running_ = false;
+  if (lease_refresh_thread_->joinable()) {
+    lease_refresh_thread_->join();
+  }
+  return SuccessExecutionResult();
+}
+
+void LeaseRefreshDriver::RegisterLeaseRefresher(
+    LeaseRefresher* lease_refresher) noexcept {
+  std::unique_lock lock(lease_refreshers_mutex_);
+  lease_refreshers_.push_back(lease_refresher);
+}
+
+void LeaseRefreshDriver::UnregisterLeaseRefresher(
+    LeaseRefresher* lease_refresher) noexcept {
+  std::unique_lock lock(lease_refreshers_mutex_);
+  lease_refreshers_.erase(std::remove(lease_refreshers_.begin(),
+                                      lease_refreshers_.end(), lease_refresher),
+                          lease_refreshers_.end());
+}
+
+void LeaseRefreshDriver::PerformLeaseRefreshRound() noexcept {
+  std::unique_lock lock(lease_refreshers_mutex_);
+  if (lease_refreshers_.empty()) {
+    return;
+  }
+
+  // The refreshes are all started before the leases are refreshed, so the
+  // refresh modes cannot change until the round completes.
+  vector<LeaseRefresher::PendingLeaseRefresh> pending_lease_refreshes;
+  pending_lease_refreshes.reserve(lease_refreshers_.size());
+  vector<shared_ptr<LeasableLockInterface>> leasable_locks;
+  vector<bool> is_read_only_lease_refresh;
+  for (auto* lease_refresher : lease_refreshers_) {
+    pending_lease_refreshes.push_back(lease_refresher->StartLeaseRefresh());
+    const auto& pending_lease_refresh = pending_lease_refreshes.back();
+    if (pending_lease_refresh.perform_lease_refresh) {
+      leasable_locks.push_back(lease_refresher->GetLeasableLock());
+      is_read_only_lease_refresh.push_back(
+          pending_lease_refresh.is_lease_refresh_read_only);
+    }
+  }
+
+  vector<ExecutionResult> results;
+  if (!leasable_locks.empty()) {
+    results = leasable_lock_batch_refresher_->RefreshLeases(
+        leasable_locks, is_read_only_lease_refresh);
+  }
+  // Guards against a batch refresher not returning one result per lock.
+  if (results.size() != leasable_locks.size()) {
+    results.resize(leasable_locks.size(), FailureExecutionResult(SC_UNKNOWN));
+  }
+
+  size_t result_index = 0;
+  for (size_t i = 0; i < lease_refreshers_.size(); i++) {
+    ExecutionResult execution_result = SuccessExecutionResult();
+    if (pending_lease_refreshes[i].perform_lease_refresh) {
+      execution_result = results[result_index++];
+    }
+    lease_refreshers_[i]->CompleteLeaseRefresh(pending_lease_refreshes[i],
+                                               execution_result);
+  }
+
+  SCP_DEBUG(kLeaseRefreshDriver, object_activity_id_,
+            "Refreshed '%llu' leases out of '%llu' locks.",
+            leasable_locks.size(), lease_refreshers_.size());
+}
+
+void LeaseRefreshDriver::LeaseRefreshThreadFunction() {
+  while (is_running_) {
+    PerformLeaseRefreshRound();
+    sleep_for(kLeaseRefreshInvocationIntervalInMilliseconds);
+  }
+}
+}  // namespace google::scp::core
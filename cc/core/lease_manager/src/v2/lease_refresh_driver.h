@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/interface/lease_manager_interface.h"
+#include "core/interface/service_interface.h"
+
+namespace google::scp::core {
+class LeaseRefresher;
+
+/**
+ * @brief Drives the lease refreshes of all the LeaseRefreshers registered on
+ * it from a single worker thread. Every round, the leases of the locks that
+ * need a refresh are refreshed together with the batch refresher, so that the
+ * lock rows are read and written in batches rather than one lock at a time.
+ *
+ * NOTE: The driver has to be running while the refreshers are.
+ */
+class LeaseRefreshDriver : public ServiceInterface {
+ public:
+  explicit LeaseRefreshDriver(
+      const std::shared_ptr<LeasableLockBatchRefresherInterface>&
+          leasable_lock_batch_refresher);
+
+  ExecutionResult Init() noexcept override;
+
+  ExecutionResult Run() noexcept override;
+
+  ExecutionResult Stop() noexcept override;
+
+  /**
+   * @brief Adds the refresher to the ones refreshed every round.
+   */
+  void RegisterLeaseRefresher(LeaseRefresher* lease_refresher) noexcept;
+
+  /**
+   * @brief Removes the refresher from the ones refreshed every round. Once
+   * this returns, the refresher is not used by the driver anymore.
+   */
+  void UnregisterLeaseRefresher(LeaseRefresher* lease_refresher) noexcept;
+
+  /**
+   * @brief Refreshes the leases of all the registered refreshers once.
+   */
+  void PerformLeaseRefreshRound() noexcept;
+
+ protected:
+  void LeaseRefreshThreadFunction();
+
+  /// @brief Refreshes the leases of the locks in batches.
+  std::shared_ptr<LeasableLockBatchRefresherInterface>
+      leasable_lock_batch_refresher_;
+  /// @brief The registered refreshers.
+  std::vector<LeaseRefresher*> lease_refreshers_;
+  /// @brief Guards the registered refreshers, and is held during a round so
+  /// that a refresher is not unregistered while being refreshed.
+  std::mutex lease_refreshers_mutex_;
+  /// @brief Lease refresh thread.
+  std::unique_ptr<std::thread> lease_refresh_thread_;
+  /// @brief Is running?
+  std::atomic<bool> is_running_;
+  /// @brief Activity ID for the lifetime of the object.
+  core::common::Uuid object_activity_id_;
+};
+}  // namespace google::scp::core
@@ -23,6 +23,7 @@
 #include "core/common/uuid/src/uuid.h"
 
 #include "error_codes.h"
+#include "lease_refresh_driver.h"
 
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::TimeProvider;
@@ -44,11 +45,13 @@ namespace google::scp::core {
 LeaseRefresher::LeaseRefresher(
     const LeasableLockId& leasable_lock_id,
     const std::shared_ptr<LeasableLockInterface>& leasable_lock,
-    const std::shared_ptr<LeaseEventSinkInterface>& lease_event_sink)
+    const std::shared_ptr<LeaseEventSinkInterface>& lease_event_sink,
+    const std::shared_ptr<LeaseRefreshDriver>& lease_refresh_driver)
     : leasable_lock_(leasable_lock),
       lease_event_sink_(lease_event_sink),
       prev_lease_refresh_mode_(LeaseRefreshMode::Unknown),
       lease_refresh_mode_(LeaseRefreshMode::RefreshWithNoIntentionToHoldLease),
+      lease_refresh_driver_(lease_refresh_driver),
       last_lease_refresh_timestamp_(
           TimeProvider::GetSteadyTimestampInNanoseconds()),
       is_running_(false),
@@ -65,6 +68,10 @@ ExecutionResult LeaseRefresher::Run() noexcept {
     return FailureExecutionResult(errors::SC_LEASE_REFRESHER_ALREADY_RUNNING);
   }
   is_running_ = true;
+  if (lease_refresh_driver_) {
+    lease_refresh_driver_->RegisterLeaseRefresher(this);
+    return SuccessExecutionResult();
+  }
   // Initiate start on thread and wait until it starts.
   std::atomic<bool> is_thread_started(false);
   lease_refresher_thread_ = make_unique<thread>([this, &is_thread_started]() {
@@ -82,6 +89,10 @@ ExecutionResult LeaseRefresher::Stop() noexcept {
     return FailureExecutionResult(errors::SC_LEASE_REFRESHER_NOT_RUNNING);
   }
   is_running_ = false;
+  if (lease_refresh_driver_) {
+    lease_refresh_driver_->UnregisterLeaseRefresher(this);
+    return SuccessExecutionResult();
+  }
   if (lease_refresher_thread_->joinable()) {
     lease_refresher_thread_->join();
   }
@@ -172,25 +183,42 @@ static LeaseTransitionType PerformLeaseTransitionAndNotifyLeaseEventSink(
 }
 
 ExecutionResult LeaseRefresher::PerformLeaseRefresh() noexcept {
-  std::unique_lock lock(lease_refresh_mutex_);
+  auto pending_lease_refresh = StartLeaseRefresh();
   auto execution_result = SuccessExecutionResult();
-  auto refresh_start_timestamp = duration_cast<milliseconds>(
+  if (pending_lease_refresh.perform_lease_refresh) {
+    execution_result = leasable_lock_->RefreshLease(
+        pending_lease_refresh.is_lease_refresh_read_only);
+  }
+  CompleteLeaseRefresh(pending_lease_refresh, execution_result);
+  return execution_result;
+}
+
+LeaseRefresher::PendingLeaseRefresh
+LeaseRefresher::StartLeaseRefresh() noexcept {
+  PendingLeaseRefresh pending_lease_refresh;
+  pending_lease_refresh.lock = std::unique_lock(lease_refresh_mutex_);
+  pending_lease_refresh.refresh_start_timestamp = duration_cast<milliseconds>(
       TimeProvider::GetSteadyTimestampInNanoseconds());
 
   //
-  // 1) Refresh Lease
+  // 1) Refresh Lease (done by the caller)
   //
-  bool perform_lease_refresh = leasable_lock_->ShouldRefreshLease();
-  if (perform_lease_refresh) {
-    bool is_lease_refresh_read_only =
-        (lease_refresh_mode_ ==
-         LeaseRefreshMode::RefreshWithNoIntentionToHoldLease);
-    execution_result = leasable_lock_->RefreshLease(is_lease_refresh_read_only);
-    if (!execution_result.Successful()) {
-      SCP_ERROR(kLeaseRefresher, object_activity_id_, execution_result,
-                "Cannot refresh lease");
-      // Continue with notifying the sink.
-    }
+  pending_lease_refresh.perform_lease_refresh =
+      leasable_lock_->ShouldRefreshLease();
+  pending_lease_refresh.is_lease_refresh_read_only =
+      (lease_refresh_mode_ ==
+       LeaseRefreshMode::RefreshWithNoIntentionToHoldLease);
+  return pending_lease_refresh;
+}
+
+void LeaseRefresher::CompleteLeaseRefresh(
+    PendingLeaseRefresh& pending_lease_refresh,
+    const ExecutionResult& execution_result) noexcept {
+  bool perform_lease_refresh = pending_lease_refresh.perform_lease_refresh;
+  if (perform_lease_refresh && !execution_result.Successful()) {
+    SCP_ERROR(kLeaseRefresher, object_activity_id_, execution_result,
+              "Cannot refresh lease");
+    // Continue with notifying the sink.
   }
   //
   // 2) Run State Machine and Notify Lease Event Sink (if needed)
@@ -223,10 +251,10 @@ ExecutionResult LeaseRefresher::PerformLeaseRefresh() noexcept {
       ToString(leasable_lock_id_).c_str(), was_lease_owner, is_lease_owner,
       lease_refresh_mode, prev_lease_refresh_mode, lease_owner_info.has_value(),
       ((duration_cast<milliseconds>(last_lease_refresh_timestamp_.load()) -
-        refresh_start_timestamp))
+        pending_lease_refresh.refresh_start_timestamp))
           .count());
 
-  return execution_result;
+  pending_lease_refresh.lock.unlock();
 }
 
 void LeaseRefresher::LeaseRefreshThreadFunction() {
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -23,18 +24,43 @@
 #include "core/interface/lease_manager_interface.h"
 
 namespace google::scp::core {
+class LeaseRefreshDriver;
+
 /**
  * @copydoc LeaseRefresherInterface
  *
- * Automatic lease refresher that employs an internal worker thread.
+ * Automatic lease refresher that employs an internal worker thread, or that is
+ * refreshed by a LeaseRefreshDriver together with the other refreshers
+ * registered on it.
  */
 class LeaseRefresher : public LeaseRefresherInterface,
                        public LeaseRefreshLivenessCheckInterface {
  public:
+  /**
+   * @brief A lease refresh that is started on the refresher, and completed
+   * once the lease is refreshed on the lock.
+   */
+  struct PendingLeaseRefresh {
+    /// @brief Holds the lease refresh mutex until the refresh is completed.
+    std::unique_lock<std::mutex> lock;
+    /// @brief Timestamp of when the refresh started.
+    std::chrono::milliseconds refresh_start_timestamp;
+    /// @brief Whether the lease needs to be refreshed on the lock.
+    bool perform_lease_refresh = false;
+    /// @brief Whether the refresh should not acquire the lease.
+    bool is_lease_refresh_read_only = false;
+  };
+
+  /**
+   * @param lease_refresh_driver if set, the lease is refreshed by the driver
+   * instead of an internal worker thread.
+   */
   LeaseRefresher(
       const LeasableLockId& leasable_lock_id,
       const std::shared_ptr<LeasableLockInterface>& leasable_lock,
-      const std::shared_ptr<LeaseEventSinkInterface>& lease_event_sink);
+      const std::shared_ptr<LeaseEventSinkInterface>& lease_event_sink,
+      const std::shared_ptr<LeaseRefreshDriver>& lease_refresh_driver =
+          nullptr);
 
   ExecutionResult Init() noexcept override;
 
@@ -83,6 +109,29 @@ class LeaseRefresher : public LeaseRefresherInterface,
    */
   ExecutionResult PerformLeaseRefresh() noexcept override;
 
+  /**
+   * @brief Starts a lease refresh, which holds off the other refreshes and the
+   * refresh mode changes until it is completed.
+   */
+  PendingLeaseRefresh StartLeaseRefresh() noexcept;
+
+  /**
+   * @brief Completes a started lease refresh after the lease was refreshed on
+   * the lock (if it had to be), and notifies the lease event sink.
+   *
+   * @param pending_lease_refresh the refresh returned by StartLeaseRefresh().
+   * @param execution_result the result of the refresh of the lease on the
+   * lock.
+   */
+  void CompleteLeaseRefresh(PendingLeaseRefresh& pending_lease_refresh,
+                            const ExecutionResult& execution_result) noexcept;
+
+  /// @brief Returns the leasable lock managed by this refresher.
+  const std::shared_ptr<LeasableLockInterface>& GetLeasableLock()
+      const noexcept {
+    return leasable_lock_;
+  }
+
  protected:
   /**
    * @brief Lease refresh round
@@ -103,7 +152,9 @@ class LeaseRefresher : public LeaseRefresherInterface,
   std::atomic<LeaseRefreshMode> prev_lease_refresh_mode_;
   /// @brief The current mode of lease refresher.
   std::atomic<LeaseRefreshMode> lease_refresh_mode_;
-  /// @brief Lease refresher thread
+  /// @brief Driver refreshing the lease, if any.
+  std::shared_ptr<LeaseRefreshDriver> lease_refresh_driver_;
+  /// @brief Lease refresher thread, if there is no driver.
   std::unique_ptr<std::thread> lease_refresher_thread_;
   /// @brief Lease refresher mutex
   std::mutex lease_refresh_mutex_;
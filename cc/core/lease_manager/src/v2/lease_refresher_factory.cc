@@ -25,6 +25,7 @@ std::shared_ptr<LeaseRefresherInterface> LeaseRefresherFactory::Construct(
     const std::shared_ptr<LeasableLockInterface>& leasable_lock,
     const std::shared_ptr<LeaseEventSinkInterface>& lease_event_sink) noexcept {
   return std::make_shared<LeaseRefresher>(leasable_lock_id, leasable_lock,
-                                          lease_event_sink);
+                                          lease_event_sink,
+                                          lease_refresh_driver_);
 }
 }  // namespace google::scp::core
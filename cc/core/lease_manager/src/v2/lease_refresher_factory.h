@@ -20,16 +20,32 @@
 
 #include "core/interface/lease_manager_interface.h"
 
+#include "lease_refresh_driver.h"
+
 namespace google::scp::core {
 /**
  * @copydoc LeaseRefresherFactoryInterface
  */
 class LeaseRefresherFactory : public LeaseRefresherFactoryInterface {
  public:
+  LeaseRefresherFactory() = default;
+
+  /**
+   * @param lease_refresh_driver if set, the constructed refreshers are
+   * refreshed by the driver instead of a thread of their own.
+   */
+  explicit LeaseRefresherFactory(
+      const std::shared_ptr<LeaseRefreshDriver>& lease_refresh_driver)
+      : lease_refresh_driver_(lease_refresh_driver) {}
+
   std::shared_ptr<LeaseRefresherInterface> Construct(
       const LeasableLockId& leasable_lock_id,
       const std::shared_ptr<LeasableLockInterface>& leasable_lock,
       const std::shared_ptr<LeaseEventSinkInterface>& lease_event_sink) noexcept
       override;
+
+ protected:
+  /// @brief Driver of the constructed refreshers, if any.
+  std::shared_ptr<LeaseRefreshDriver> lease_refresh_driver_;
 };
 }  // namespace google::scp::core
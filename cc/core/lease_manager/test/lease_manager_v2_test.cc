@@ -646,6 +646,59 @@ TEST_F(LeaseManagerV2Test, RefreshModeTryReleaseTwoLeasesAsPerPreference) {
             1);
 }
 
+TEST_F(LeaseManagerV2Test, RefreshModeReleasesTheNonPreferredLeasesFirst) {
+  LeaseManagerV2 lease_manager(move(mock_lease_refresher_factory_));
+  EXPECT_SUCCESS(lease_manager.ManageLeaseOnLock(lock_id_1_, leasable_lock_1_,
+                                                 event_sink_1_));
+  EXPECT_SUCCESS(lease_manager.ManageLeaseOnLock(lock_id_2_, leasable_lock_2_,
+                                                 event_sink_2_));
+  EXPECT_SUCCESS(lease_manager.ManageLeaseOnLock(lock_id_3_, leasable_lock_3_,
+                                                 event_sink_3_));
+  EXPECT_SUCCESS(lease_manager.Init());
+
+  // Set up precondition.
+  mock_lease_refresher_1_->SetLeaseRefreshMode(
+      LeaseRefreshMode::RefreshWithIntentionToHoldLease);
+  mock_lease_refresher_2_->SetLeaseRefreshMode(
+      LeaseRefreshMode::RefreshWithIntentionToHoldLease);
+  mock_lease_refresher_3_->SetLeaseRefreshMode(
+      LeaseRefreshMode::RefreshWithIntentionToHoldLease);
+
+  SetUpMocksForLock(mock_leasable_lock_1_, this_lease_holder_info_);
+  SetUpMocksForLock(mock_leasable_lock_2_, this_lease_holder_info_);
+  SetUpMocksForLock(mock_leasable_lock_3_, this_lease_holder_info_);
+
+  lease_manager.SetLeaseAcquisitionPreference(
+      LeaseAcquisitionPreference{1, {lock_id_2_}});
+  lease_manager.PerformLeaseAcquisitionPreferenceManagement();
+
+  EXPECT_EQ(GetLockSetForAMode(
+                LeaseRefreshMode::RefreshWithIntentionToReleaseTheHeldLease),
+            (vector<LeasableLockId>{lock_id_1_, lock_id_3_}));
+  EXPECT_EQ(
+      GetLockSetForAMode(LeaseRefreshMode::RefreshWithIntentionToHoldLease),
+      vector<LeasableLockId>{lock_id_2_});
+}
+
+TEST_F(LeaseManagerV2Test, RefreshModeHoldsThePreferredLeasesFirst) {
+  LeaseManagerV2 lease_manager(move(mock_lease_refresher_factory_));
+  EXPECT_SUCCESS(lease_manager.ManageLeaseOnLock(lock_id_1_, leasable_lock_1_,
+                                                 event_sink_1_));
+  EXPECT_SUCCESS(lease_manager.ManageLeaseOnLock(lock_id_2_, leasable_lock_2_,
+                                                 event_sink_2_));
+  EXPECT_SUCCESS(lease_manager.ManageLeaseOnLock(lock_id_3_, leasable_lock_3_,
+                                                 event_sink_3_));
+  EXPECT_SUCCESS(lease_manager.Init());
+
+  lease_manager.SetLeaseAcquisitionPreference(
+      LeaseAcquisitionPreference{1, {lock_id_3_}});
+  lease_manager.PerformLeaseAcquisitionPreferenceManagement();
+
+  EXPECT_EQ(
+      GetLockSetForAMode(LeaseRefreshMode::RefreshWithIntentionToHoldLease),
+      vector<LeasableLockId>{lock_id_3_});
+}
+
 TEST_F(LeaseManagerV2Test,
        RefreshModeCompleteReleaseUponSafeToReleaseInvocation) {
   // Private accessor to set the is_running flag to true without actually
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/lease_manager/src/v2/lease_refresh_driver.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "core/lease_manager/mock/mock_leasable_lock_batch_refresher.h"
+#include "core/lease_manager/mock/mock_leasable_lock_gmock.h"
+#include "core/lease_manager/mock/mock_lease_event_sink.h"
+#include "core/lease_manager/src/v2/lease_refresher_factory.h"
+#include "core/test/utils/conditional_wait.h"
+#include "public/core/interface/execution_result.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::lease_manager::mock::MockLeasableLock;
+using google::scp::core::lease_manager::mock::MockLeasableLockBatchRefresher;
+using google::scp::core::lease_manager::mock::MockLeaseEventSink;
+using std::atomic;
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Return;
+
+namespace google::scp::core::test {
+
+class LeaseRefreshDriverTest : public ::testing::Test {
+ protected:
+  LeaseRefreshDriverTest() {
+    mock_batch_refresher_ = make_shared<MockLeasableLockBatchRefresher>();
+    driver_ = make_shared<LeaseRefreshDriver>(mock_batch_refresher_);
+    factory_ = make_shared<LeaseRefresherFactory>(driver_);
+    mock_event_sink_ = make_shared<MockLeaseEventSink>();
+    for (int i = 0; i < 2; i++) {
+      auto mock_lock = make_shared<MockLeasableLock>();
+      ON_CALL(*mock_lock, ShouldRefreshLease()).WillByDefault(Return(true));
+      ON_CALL(*mock_lock, IsCurrentLeaseOwner()).WillByDefault(Return(false));
+      mock_locks_.push_back(mock_lock);
+      locks_.push_back(mock_lock);
+      lock_ids_.push_back({0, static_cast<uint64_t>(i + 1)});
+      refreshers_.push_back(
+          factory_->Construct(lock_ids_.back(), mock_lock, mock_event_sink_));
+      EXPECT_SUCCESS(refreshers_.back()->Init());
+    }
+  }
+
+  shared_ptr<MockLeasableLockBatchRefresher> mock_batch_refresher_;
+  shared_ptr<LeaseRefreshDriver> driver_;
+  shared_ptr<LeaseRefresherFactory> factory_;
+  shared_ptr<MockLeaseEventSink> mock_event_sink_;
+  vector<shared_ptr<MockLeasableLock>> mock_locks_;
+  vector<shared_ptr<LeasableLockInterface>> locks_;
+  vector<LeasableLockId> lock_ids_;
+  vector<shared_ptr<LeaseRefresherInterface>> refreshers_;
+};
+
+TEST_F(LeaseRefreshDriverTest, RefreshesTheLocksNeedingRefreshInOneBatch) {
+  EXPECT_SUCCESS(refreshers_[0]->Run());
+  EXPECT_SUCCESS(refreshers_[1]->Run());
+  EXPECT_SUCCESS(refreshers_[1]->SetLeaseRefreshMode(
+      LeaseRefreshMode::RefreshWithIntentionToHoldLease));
+  EXPECT_CALL(*mock_locks_[0], ShouldRefreshLease()).WillOnce(Return(false));
+  EXPECT_CALL(*mock_locks_[0], RefreshLease).Times(0);
+  EXPECT_CALL(*mock_locks_[1], RefreshLease).Times(0);
+  EXPECT_CALL(*mock_batch_refresher_,
+              RefreshLeases(ElementsAre(Eq(locks_[1])), ElementsAre(false)))
+      .WillOnce(Return(vector<ExecutionResult>{SuccessExecutionResult()}));
+  // Only the refreshed lock goes through a lease transition.
+  EXPECT_CALL(*mock_event_sink_,
+              OnLeaseTransition(Eq(lock_ids_[1]),
+                                LeaseTransitionType::kNotAcquired, _))
+      .Times(1);
+  EXPECT_CALL(*mock_event_sink_, OnLeaseTransition(Eq(lock_ids_[0]), _, _))
+      .Times(0);
+
+  driver_->PerformLeaseRefreshRound();
+
+  EXPECT_SUCCESS(refreshers_[0]->Stop());
+  EXPECT_SUCCESS(refreshers_[1]->Stop());
+}
+
+TEST_F(LeaseRefreshDriverTest, NotifiesLeaseTransitionsOnFailedRefreshes) {
+  EXPECT_SUCCESS(refreshers_[0]->Run());
+  EXPECT_SUCCESS(refreshers_[1]->Run());
+  EXPECT_CALL(*mock_batch_refresher_,
+              RefreshLeases(ElementsAre(Eq(locks_[0]), Eq(locks_[1])),
+                            ElementsAre(true, true)))
+      .WillOnce(Return(vector<ExecutionResult>{
+          SuccessExecutionResult(), FailureExecutionResult(SC_UNKNOWN)}));
+  EXPECT_CALL(*mock_event_sink_,
+              OnLeaseTransition(_, LeaseTransitionType::kNotAcquired, _))
+      .Times(2);
+
+  driver_->PerformLeaseRefreshRound();
+
+  EXPECT_SUCCESS(refreshers_[0]->Stop());
+  EXPECT_SUCCESS(refreshers_[1]->Stop());
+}
+
+TEST_F(LeaseRefreshDriverTest, RefreshesPeriodicallyUntilUnregistered) {
+  atomic<int> refresh_count = 0;
+  ON_CALL(*mock_batch_refresher_, RefreshLeases)
+      .WillByDefault(
+          [&](const vector<shared_ptr<LeasableLockInterface>>& leasable_locks,
+              const vector<bool>&) {
+            refresh_count++;
+            return vector<ExecutionResult>(leasable_locks.size(),
+                                           SuccessExecutionResult());
+          });
+  EXPECT_SUCCESS(driver_->Init());
+  EXPECT_SUCCESS(driver_->Run());
+  EXPECT_SUCCESS(refreshers_[0]->Run());
+  EXPECT_SUCCESS(refreshers_[1]->Run());
+  WaitUntil([&]() { return refresh_count.load() >= 2; });
+
+  EXPECT_SUCCESS(refreshers_[0]->Stop());
+  EXPECT_SUCCESS(refreshers_[1]->Stop());
+  auto count_after_stop = refresh_count.load();
+  driver_->PerformLeaseRefreshRound();
+  EXPECT_EQ(refresh_count.load(), count_after_stop);
+  EXPECT_SUCCESS(driver_->Stop());
+}
+}  // namespace google::scp::core::test
@@ -30,6 +30,10 @@ class MockLogger : public Logger {
  public:
   MockLogger() : Logger(std::make_unique<MockLogProvider>()) {}
 
+  explicit MockLogger(LogRateLimitOptions rate_limit_options)
+      : Logger(std::make_unique<MockLogProvider>(),
+               std::move(rate_limit_options)) {}
+
   std::vector<std::string> GetMessages() {
     return dynamic_cast<MockLogProvider&>(*log_provider_).messages_;
   }
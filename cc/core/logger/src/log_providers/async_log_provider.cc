@@ -0,0 +1,198 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "async_log_provider.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/common/uuid/src/uuid.h"
+
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::Uuid;
+using std::string;
+using std::string_view;
+
+namespace {
+constexpr char kAsyncLogProvider[] = "AsyncLogProvider";
+// How long the writer thread sleeps once the queue is empty.
+constexpr std::chrono::milliseconds kWriterIdleSleep(2);
+// The size of the buffer most messages are formatted in.
+constexpr size_t kFormatBufferSize = 512;
+}  // namespace
+
+namespace google::scp::core::logger {
+namespace {
+// Hands a preformatted message to a provider, which only takes va_list
+// arguments.
+void LogFormatted(LogProviderInterface& log_provider, const LogLevel& level,
+                  const Uuid& correlation_id, const Uuid& parent_activity_id,
+                  const Uuid& activity_id, const string_view& component_name,
+                  const string_view& machine_name,
+                  const string_view& cluster_name, const string_view& location,
+                  const string_view& message, ...) noexcept {
+  va_list args;
+  va_start(args, message);
+  log_provider.Log(level, correlation_id, parent_activity_id, activity_id,
+                   component_name, machine_name, cluster_name, location,
+                   message, args);
+  va_end(args);
+}
+
+string FormatMessage(const string_view& message, va_list args) noexcept {
+  char buffer[kFormatBufferSize];
+  va_list size_args;
+  va_copy(size_args, args);
+  int size = vsnprintf(buffer, sizeof(buffer), message.data(), size_args);
+  va_end(size_args);
+  if (size < 0) {
+    return string(message);
+  }
+  if (static_cast<size_t>(size) < sizeof(buffer)) {
+    return string(buffer, size);
+  }
+  // vsnprintf adds a terminator at the end, so it needs size + 1.
+  string formatted(size + 1, '\0');
+  vsnprintf(formatted.data(), size + 1, message.data(), args);
+  formatted.resize(size);
+  return formatted;
+}
+}  // namespace
+
+AsyncLogProvider::AsyncLogProvider(
+    std::unique_ptr<LogProviderInterface> log_provider,
+    AsyncLogProviderOptions options)
+    : log_provider_(std::move(log_provider)),
+      options_(options),
+      queue_(options.queue_capacity),
+      is_running_(false),
+      dropped_count_(0) {}
+
+AsyncLogProvider::~AsyncLogProvider() {
+  if (is_running_.load()) {
+    Stop();
+  }
+}
+
+ExecutionResult AsyncLogProvider::Init() noexcept {
+  return log_provider_->Init();
+}
+
+ExecutionResult AsyncLogProvider::Run() noexcept {
+  auto execution_result = log_provider_->Run();
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  is_running_ = true;
+  writer_thread_ = std::thread([this]() { WriteQueuedRecords(); });
+  return SuccessExecutionResult();
+}
+
+ExecutionResult AsyncLogProvider::Stop() noexcept {
+  is_running_ = false;
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+  return log_provider_->Stop();
+}
+
+void AsyncLogProvider::Log(const LogLevel& level, const Uuid& correlation_id,
+                           const Uuid& parent_activity_id,
+                           const Uuid& activity_id,
+                           const string_view& component_name,
+                           const string_view& machine_name,
+                           const string_view& cluster_name,
+                           const string_view& location,
+                           const string_view& message, va_list args) noexcept {
+  if (!is_running_.load(std::memory_order_acquire)) {
+    log_provider_->Log(level, correlation_id, parent_activity_id, activity_id,
+                       component_name, machine_name, cluster_name, location,
+                       message, args);
+    return;
+  }
+
+  LogRecord record;
+  record.level = level;
+  record.correlation_id = correlation_id;
+  record.parent_activity_id = parent_activity_id;
+  record.activity_id = activity_id;
+  record.component_name = string(component_name);
+  record.machine_name = string(machine_name);
+  record.cluster_name = string(cluster_name);
+  record.location = string(location);
+  record.message = FormatMessage(message, args);
+
+  while (!queue_.TryEnqueue(std::move(record)).Successful()) {
+    if (options_.overflow_policy == AsyncLogOverflowPolicy::kDrop ||
+        !is_running_.load(std::memory_order_acquire)) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::this_thread::yield();
+  }
+}
+
+void AsyncLogProvider::Write(const LogRecord& record) noexcept {
+  LogFormatted(*log_provider_, record.level, record.correlation_id,
+               record.parent_activity_id, record.activity_id,
+               record.component_name, record.machine_name, record.cluster_name,
+               record.location, "%s", record.message.c_str());
+}
+
+void AsyncLogProvider::WriteDroppedCount() noexcept {
+  size_t dropped_count = dropped_count_.load(std::memory_order_relaxed);
+  if (dropped_count == reported_dropped_count_) {
+    return;
+  }
+  LogFormatted(*log_provider_, LogLevel::kWarning, kZeroUuid, kZeroUuid,
+               kZeroUuid, kAsyncLogProvider, "", "", "",
+               "Dropped %zu log records, the queue was full.",
+               dropped_count - reported_dropped_count_);
+  reported_dropped_count_ = dropped_count;
+}
+
+void AsyncLogProvider::WriteQueuedRecords() noexcept {
+  std::vector<LogRecord> records;
+  records.reserve(options_.max_batch_size);
+  while (true) {
+    // Reads the flag before draining, so that the records queued before
+    // Stop() are all written by the last pass.
+    bool is_running = is_running_.load(std::memory_order_acquire);
+    records.clear();
+    if (queue_.TryDequeueBulk(records, options_.max_batch_size)
+            .Successful()) {
+      for (const auto& record : records) {
+        Write(record);
+      }
+      WriteDroppedCount();
+      continue;
+    }
+
+    WriteDroppedCount();
+    if (!is_running) {
+      return;
+    }
+    std::this_thread::sleep_for(kWriterIdleSleep);
+  }
+}
+}  // namespace google::scp::core::logger
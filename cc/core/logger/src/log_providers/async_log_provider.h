@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/common/concurrent_queue/src/concurrent_queue.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/logger/interface/log_provider_interface.h"
+
+namespace google::scp::core::logger {
+/// What AsyncLogProvider does with the records logged while its queue is full.
+enum class AsyncLogOverflowPolicy {
+  /// Drops the record and counts it. The count is logged once the queue
+  /// drains.
+  kDrop = 0,
+  /// Waits for the writer thread to make room.
+  kBlock = 1,
+};
+
+struct AsyncLogProviderOptions {
+  /// The max number of records waiting to be written.
+  size_t queue_capacity = 16384;
+  /// The max number of records written per wake up of the writer thread.
+  size_t max_batch_size = 512;
+  AsyncLogOverflowPolicy overflow_policy = AsyncLogOverflowPolicy::kDrop;
+};
+
+/**
+ * @brief Takes the writes of another LogProvider off the logging threads.
+ *
+ * The message is formatted on the logging thread, then the record is moved
+ * into a lock free ring buffer, and a writer thread hands the queued records
+ * to the wrapped provider in batches. The timestamps added by the wrapped
+ * provider are thus those of the writes rather than of the logs.
+ *
+ * Before Run() and after Stop(), the records are written synchronously. The
+ * records logged concurrently with Stop() may be lost.
+ */
+class AsyncLogProvider : public LogProviderInterface {
+ public:
+  explicit AsyncLogProvider(std::unique_ptr<LogProviderInterface> log_provider,
+                            AsyncLogProviderOptions options = {});
+
+  ~AsyncLogProvider();
+
+  ExecutionResult Init() noexcept override;
+
+  ExecutionResult Run() noexcept override;
+
+  ExecutionResult Stop() noexcept override;
+
+  void Log(const LogLevel& level, const common::Uuid& correlation_id,
+           const common::Uuid& parent_activity_id,
+           const common::Uuid& activity_id,
+           const std::string_view& component_name,
+           const std::string_view& machine_name,
+           const std::string_view& cluster_name,
+           const std::string_view& location, const std::string_view& message,
+           va_list args) noexcept override;
+
+  /// The number of records dropped since the construction.
+  size_t GetDroppedCount() const noexcept {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct LogRecord {
+    LogLevel level = LogLevel::kNone;
+    common::Uuid correlation_id;
+    common::Uuid parent_activity_id;
+    common::Uuid activity_id;
+    std::string component_name;
+    std::string machine_name;
+    std::string cluster_name;
+    std::string location;
+    /// The formatted message.
+    std::string message;
+  };
+
+  /// Writes the record with the wrapped provider.
+  void Write(const LogRecord& record) noexcept;
+
+  /// Writes the queued records until Stop() is called, then the ones left.
+  void WriteQueuedRecords() noexcept;
+
+  /// Logs the number of records dropped since the last call, if any.
+  void WriteDroppedCount() noexcept;
+
+  std::unique_ptr<LogProviderInterface> log_provider_;
+  const AsyncLogProviderOptions options_;
+  common::ConcurrentQueue<LogRecord, common::ConcurrentQueueBackend::RingBuffer>
+      queue_;
+  std::atomic<bool> is_running_;
+  std::thread writer_thread_;
+  std::atomic<size_t> dropped_count_;
+  /// The part of dropped_count_ already logged. Only used by the writer.
+  size_t reported_dropped_count_ = 0;
+};
+}  // namespace google::scp::core::logger
@@ -16,12 +16,15 @@
 
 #include "logger.h"
 
+#include <chrono>
 #include <cstdarg>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <string_view>
 #include <utility>
 
+#include "absl/synchronization/mutex.h"
 #include "cc/core/interface/logger_interface.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/logger/interface/log_provider_interface.h"
@@ -54,6 +57,10 @@ void Logger::Info(const string_view& component_name, const Uuid& correlation_id,
                   const Uuid& parent_activity_id, const Uuid& activity_id,
                   const string_view& location, const string_view& message,
                   ...) noexcept {
+  if (!ShouldLog(LogLevel::kInfo, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kInfo, correlation_id, parent_activity_id,
@@ -66,6 +73,10 @@ void Logger::Debug(const string_view& component_name,
                    const Uuid& correlation_id, const Uuid& parent_activity_id,
                    const Uuid& activity_id, const string_view& location,
                    const string_view& message, ...) noexcept {
+  if (!ShouldLog(LogLevel::kDebug, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kDebug, correlation_id, parent_activity_id,
@@ -78,6 +89,10 @@ void Logger::Warning(const string_view& component_name,
                      const Uuid& correlation_id, const Uuid& parent_activity_id,
                      const Uuid& activity_id, const string_view& location,
                      const string_view& message, ...) noexcept {
+  if (!ShouldLog(LogLevel::kWarning, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kWarning, correlation_id, parent_activity_id,
@@ -90,6 +105,10 @@ void Logger::Error(const string_view& component_name,
                    const Uuid& correlation_id, const Uuid& parent_activity_id,
                    const Uuid& activity_id, const string_view& location,
                    const string_view& message, ...) noexcept {
+  if (!ShouldLog(LogLevel::kError, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kError, correlation_id, parent_activity_id,
@@ -102,6 +121,10 @@ void Logger::Alert(const string_view& component_name,
                    const Uuid& correlation_id, const Uuid& parent_activity_id,
                    const Uuid& activity_id, const string_view& location,
                    const string_view& message, ...) noexcept {
+  if (!ShouldLog(LogLevel::kAlert, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kAlert, correlation_id, parent_activity_id,
@@ -115,6 +138,10 @@ void Logger::Critical(const string_view& component_name,
                       const Uuid& parent_activity_id, const Uuid& activity_id,
                       const string_view& location, const string_view& message,
                       ...) noexcept {
+  if (!ShouldLog(LogLevel::kCritical, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kCritical, correlation_id, parent_activity_id,
@@ -128,6 +155,10 @@ void Logger::Emergency(const string_view& component_name,
                        const Uuid& parent_activity_id, const Uuid& activity_id,
                        const string_view& location, const string_view& message,
                        ...) noexcept {
+  if (!ShouldLog(LogLevel::kEmergency, component_name, correlation_id,
+                 parent_activity_id, activity_id, location)) {
+    return;
+  }
   va_list args;
   va_start(args, message);
   log_provider_->Log(LogLevel::kEmergency, correlation_id, parent_activity_id,
@@ -136,4 +167,59 @@ void Logger::Emergency(const string_view& component_name,
   va_end(args);
 }
 
+bool Logger::ShouldLog(const LogLevel& level, const string_view& component_name,
+                       const Uuid& correlation_id,
+                       const Uuid& parent_activity_id, const Uuid& activity_id,
+                       const string_view& location) noexcept {
+  auto max_messages = rate_limit_options_.max_messages_per_window.find(level);
+  if (max_messages == rate_limit_options_.max_messages_per_window.end()) {
+    return true;
+  }
+
+  auto key = std::to_string(static_cast<int>(level));
+  key.append("|").append(component_name).append("|").append(location);
+  auto now = std::chrono::steady_clock::now();
+  size_t suppressed_count = 0;
+  {
+    absl::MutexLock lock(&log_counts_mutex_);
+    auto [log_count, inserted] = log_counts_.try_emplace(std::move(key));
+    if (inserted ||
+        now - log_count->second.window_start >= rate_limit_options_.window) {
+      suppressed_count = log_count->second.suppressed_count;
+      log_count->second = LocationLogCount{now};
+    }
+    if (log_count->second.logged_count >= max_messages->second) {
+      log_count->second.suppressed_count++;
+      return false;
+    }
+    log_count->second.logged_count++;
+  }
+
+  // Logged for the first message after the window rather than when the window
+  // ends, so that the locations that stop logging cost nothing.
+  if (suppressed_count > 0) {
+    Log(level, component_name, correlation_id, parent_activity_id, activity_id,
+        location,
+        "Suppressed %zu messages of this location in a %lld ms window",
+        suppressed_count,
+        static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                rate_limit_options_.window)
+                .count()));
+  }
+  return true;
+}
+
+void Logger::Log(const LogLevel& level, const string_view& component_name,
+                 const Uuid& correlation_id, const Uuid& parent_activity_id,
+                 const Uuid& activity_id, const string_view& location,
+                 const string_view& message, ...) noexcept {
+  va_list args;
+  va_start(args, message);
+  log_provider_->Log(level, correlation_id, parent_activity_id, activity_id,
+                     component_name, kDefaultMachineName, kDefaultClusterName,
+                     location, message, args);
+  va_end(args);
+}
+
 }  // namespace google::scp::core::logger
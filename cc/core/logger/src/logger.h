@@ -16,12 +16,16 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/logger_interface.h"
 #include "core/logger/interface/log_provider_interface.h"
@@ -29,13 +33,37 @@
 
 namespace google::scp::core::logger {
 
+/**
+ * @brief Limits the number of messages logged from each location of each
+ * component, so that a dependency outage failing every request does not flood
+ * the log provider with identical messages.
+ */
+struct LogRateLimitOptions {
+  /// The window the messages of a location are counted over.
+  std::chrono::nanoseconds window = std::chrono::seconds(10);
+  /// The max number of messages of a location logged per window, by level. The
+  /// levels that are not in the map are not limited.
+  absl::flat_hash_map<LogLevel, size_t> max_messages_per_window;
+};
+
 /*! @copydoc LoggerInterface
  */
 class Logger : public LoggerInterface {
  public:
   /// Constructs a new Logger object
   explicit Logger(std::unique_ptr<LogProviderInterface> log_provider)
-      : log_provider_(std::move(log_provider)) {}
+      : Logger(std::move(log_provider), LogRateLimitOptions()) {}
+
+  /**
+   * @brief Constructs a new Logger object that drops the messages of a location
+   * over the limit of its level. The first message of the location logged
+   * after a window with dropped messages is preceded by a summary of how many
+   * were dropped.
+   */
+  Logger(std::unique_ptr<LogProviderInterface> log_provider,
+         LogRateLimitOptions rate_limit_options)
+      : log_provider_(std::move(log_provider)),
+        rate_limit_options_(std::move(rate_limit_options)) {}
 
   ExecutionResult Init() noexcept override;
 
@@ -89,7 +117,42 @@ class Logger : public LoggerInterface {
                  const std::string_view& message, ...) noexcept override;
 
  protected:
+  /// The messages of a location in the current window.
+  struct LocationLogCount {
+    /// The start of the window.
+    std::chrono::steady_clock::time_point window_start;
+    /// The number of messages logged in the window.
+    size_t logged_count = 0;
+    /// The number of messages dropped in the window.
+    size_t suppressed_count = 0;
+  };
+
+  /**
+   * @brief Counts a message of the location and returns whether it is under
+   * the limit of its level. Logs the summary of the messages dropped in the
+   * previous window of the location, if any.
+   */
+  bool ShouldLog(const LogLevel& level, const std::string_view& component_name,
+                 const common::Uuid& correlation_id,
+                 const common::Uuid& parent_activity_id,
+                 const common::Uuid& activity_id,
+                 const std::string_view& location) noexcept;
+
+  /// Logs a message to the log provider.
+  void Log(const LogLevel& level, const std::string_view& component_name,
+           const common::Uuid& correlation_id,
+           const common::Uuid& parent_activity_id,
+           const common::Uuid& activity_id, const std::string_view& location,
+           const std::string_view& message, ...) noexcept;
+
   /// A unique pointer to the log provider instance.
   std::unique_ptr<logger::LogProviderInterface> log_provider_;
+  /// The limits of the messages of each location.
+  const LogRateLimitOptions rate_limit_options_;
+  /// Guards log_counts_.
+  absl::Mutex log_counts_mutex_;
+  /// The messages of each level, component and location in the current window.
+  absl::flat_hash_map<std::string, LocationLogCount> log_counts_
+      ABSL_GUARDED_BY(log_counts_mutex_);
 };
 }  // namespace google::scp::core::logger
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/logger/src/log_providers/async_log_provider.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/common/uuid/src/uuid.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::Uuid;
+using std::string;
+using std::string_view;
+
+namespace google::scp::core::logger::test {
+namespace {
+/// Records the formatted messages, and blocks the writes while paused.
+class RecordingLogProvider : public LogProviderInterface {
+ public:
+  ExecutionResult Init() noexcept override { return SuccessExecutionResult(); }
+
+  ExecutionResult Run() noexcept override { return SuccessExecutionResult(); }
+
+  ExecutionResult Stop() noexcept override { return SuccessExecutionResult(); }
+
+  void Log(const LogLevel& level, const Uuid& correlation_id,
+           const Uuid& parent_activity_id, const Uuid& activity_id,
+           const string_view& component_name, const string_view& machine_name,
+           const string_view& cluster_name, const string_view& location,
+           const string_view& message, va_list args) noexcept override {
+    writer_thread_id = std::this_thread::get_id();
+    is_writing = true;
+    while (is_paused) {
+      std::this_thread::yield();
+    }
+    char buffer[256];
+    vsnprintf(buffer, sizeof(buffer), message.data(), args);
+    std::lock_guard<std::mutex> lock(mutex);
+    messages.push_back(string(component_name) + "|" + buffer);
+  }
+
+  std::vector<string> GetMessages() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return messages;
+  }
+
+  std::atomic<bool> is_paused{false};
+  std::atomic<bool> is_writing{false};
+  std::thread::id writer_thread_id;
+
+ private:
+  std::mutex mutex;
+  std::vector<string> messages;
+};
+
+void LogInfo(LogProviderInterface& log_provider, const char* message, ...) {
+  va_list args;
+  va_start(args, message);
+  log_provider.Log(LogLevel::kInfo, kZeroUuid, kZeroUuid, kZeroUuid, "Test",
+                   "", "", "", message, args);
+  va_end(args);
+}
+
+TEST(AsyncLogProviderTest, WritesFormattedRecordsOnWriterThread) {
+  auto recording_provider = std::make_unique<RecordingLogProvider>();
+  auto* recorder = recording_provider.get();
+  AsyncLogProvider log_provider(std::move(recording_provider));
+  EXPECT_SUCCESS(log_provider.Init());
+  EXPECT_SUCCESS(log_provider.Run());
+
+  for (int i = 0; i < 100; ++i) {
+    LogInfo(log_provider, "Record %d %s", i, "with a %s in the argument");
+  }
+  EXPECT_SUCCESS(log_provider.Stop());
+
+  auto messages = recorder->GetMessages();
+  ASSERT_EQ(messages.size(), 100);
+  EXPECT_EQ(messages[0], "Test|Record 0 with a %s in the argument");
+  EXPECT_EQ(messages[99], "Test|Record 99 with a %s in the argument");
+  EXPECT_NE(recorder->writer_thread_id, std::this_thread::get_id());
+  EXPECT_EQ(log_provider.GetDroppedCount(), 0);
+}
+
+TEST(AsyncLogProviderTest, WritesSynchronouslyWhenNotRunning) {
+  auto recording_provider = std::make_unique<RecordingLogProvider>();
+  auto* recorder = recording_provider.get();
+  AsyncLogProvider log_provider(std::move(recording_provider));
+  EXPECT_SUCCESS(log_provider.Init());
+
+  LogInfo(log_provider, "Record %d", 1);
+
+  EXPECT_EQ(recorder->GetMessages(), std::vector<string>{"Test|Record 1"});
+  EXPECT_EQ(recorder->writer_thread_id, std::this_thread::get_id());
+}
+
+TEST(AsyncLogProviderTest, DropsAndCountsRecordsWhenQueueIsFull) {
+  auto recording_provider = std::make_unique<RecordingLogProvider>();
+  auto* recorder = recording_provider.get();
+  recorder->is_paused = true;
+  AsyncLogProviderOptions options;
+  options.queue_capacity = 1;
+  AsyncLogProvider log_provider(std::move(recording_provider), options);
+  EXPECT_SUCCESS(log_provider.Init());
+  EXPECT_SUCCESS(log_provider.Run());
+
+  // The writer takes the first record and waits, the second one fills the
+  // queue, and the third one is dropped.
+  LogInfo(log_provider, "Record %d", 1);
+  while (!recorder->is_writing) {
+    std::this_thread::yield();
+  }
+  LogInfo(log_provider, "Record %d", 2);
+  LogInfo(log_provider, "Record %d", 3);
+  EXPECT_EQ(log_provider.GetDroppedCount(), 1);
+
+  recorder->is_paused = false;
+  EXPECT_SUCCESS(log_provider.Stop());
+
+  // The drop is reported right after the batch being written when it
+  // happened.
+  auto messages = recorder->GetMessages();
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(messages[0], "Test|Record 1");
+  EXPECT_EQ(messages[1],
+            "AsyncLogProvider|Dropped 1 log records, the queue was full.");
+  EXPECT_EQ(messages[2], "Test|Record 2");
+}
+
+TEST(AsyncLogProviderTest, BlocksWhenQueueIsFull) {
+  auto recording_provider = std::make_unique<RecordingLogProvider>();
+  auto* recorder = recording_provider.get();
+  recorder->is_paused = true;
+  AsyncLogProviderOptions options;
+  options.queue_capacity = 1;
+  options.overflow_policy = AsyncLogOverflowPolicy::kBlock;
+  AsyncLogProvider log_provider(std::move(recording_provider), options);
+  EXPECT_SUCCESS(log_provider.Init());
+  EXPECT_SUCCESS(log_provider.Run());
+
+  LogInfo(log_provider, "Record %d", 1);
+  while (!recorder->is_writing) {
+    std::this_thread::yield();
+  }
+  LogInfo(log_provider, "Record %d", 2);
+  std::atomic<bool> is_logged = false;
+  std::thread logging_thread([&]() {
+    LogInfo(log_provider, "Record %d", 3);
+    is_logged = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(is_logged);
+
+  recorder->is_paused = false;
+  logging_thread.join();
+  EXPECT_SUCCESS(log_provider.Stop());
+
+  EXPECT_EQ(recorder->GetMessages(),
+            (std::vector<string>{"Test|Record 1", "Test|Record 2",
+                                 "Test|Record 3"}));
+  EXPECT_EQ(log_provider.GetDroppedCount(), 0);
+}
+}  // namespace
+}  // namespace google::scp::core::logger::test
@@ -18,8 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "core/common/uuid/src/uuid.h"
@@ -31,6 +33,7 @@ using google::scp::core::LogLevel;
 using google::scp::core::common::ToString;
 using google::scp::core::common::Uuid;
 using google::scp::core::logger::FromString;
+using google::scp::core::logger::LogRateLimitOptions;
 using google::scp::core::logger::ToString;
 using google::scp::core::logger::mock::MockLogger;
 using std::string;
@@ -154,6 +157,47 @@ TEST_F(LoggerTests, LogWithArgs) {
                                         "|" + location + "|8: Message 1 error");
 }
 
+TEST_F(LoggerTests, MessagesOverTheLimitOfTheLocationAreSuppressed) {
+  LogRateLimitOptions rate_limit_options;
+  rate_limit_options.window = std::chrono::hours(1);
+  rate_limit_options.max_messages_per_window[LogLevel::kError] = 2;
+  MockLogger logger(rate_limit_options);
+
+  for (int i = 0; i < 5; ++i) {
+    logger.Error(component_name, correlation_id, parent_uuid, uuid, location,
+                 "Message");
+    logger.Error(component_name, correlation_id, parent_uuid, uuid,
+                 "other_location", "Message");
+    logger.Warning(component_name, correlation_id, parent_uuid, uuid, location,
+                   "Message");
+  }
+
+  // 2 errors of each location, and all the warnings.
+  EXPECT_EQ(logger.GetMessages().size(), 9);
+}
+
+TEST_F(LoggerTests, SuppressedMessagesAreSummarizedAfterTheWindow) {
+  LogRateLimitOptions rate_limit_options;
+  rate_limit_options.window = std::chrono::milliseconds(10);
+  rate_limit_options.max_messages_per_window[LogLevel::kError] = 1;
+  MockLogger logger(rate_limit_options);
+
+  for (int i = 0; i < 4; ++i) {
+    logger.Error(component_name, correlation_id, parent_uuid, uuid, location,
+                 "Message");
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  logger.Error(component_name, correlation_id, parent_uuid, uuid, location,
+               "Message");
+
+  auto logs = logger.GetMessages();
+  ASSERT_EQ(logs.size(), 3);
+  EXPECT_NE(logs[1].find("|4: Suppressed 3 messages of this location in a "
+                         "10 ms window"),
+            string::npos);
+  EXPECT_NE(logs[2].find("|4: Message"), string::npos);
+}
+
 TEST_F(LoggerTests, LogLevelToAndFromString) {
   vector<LogLevel> log_levels = {LogLevel::kAlert, LogLevel::kCritical,
                                  LogLevel::kDebug, LogLevel::kEmergency,
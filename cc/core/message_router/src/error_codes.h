@@ -33,4 +33,10 @@ DEFINE_ERROR_CODE(SC_MESSAGE_ROUTER_REQUEST_ALREADY_SUBSCRIBED,
 DEFINE_ERROR_CODE(SC_MESSAGE_ROUTER_REQUEST_NOT_SUBSCRIBED, SC_MESSAGE_ROUTER,
                   0x0002, "The request type is not subscribed",
                   HttpStatusCode::BAD_REQUEST)
+
+/// Defines the error code as 0x0003 when the request cannot be unpacked into
+/// the type it was subscribed for.
+DEFINE_ERROR_CODE(SC_MESSAGE_ROUTER_INVALID_REQUEST, SC_MESSAGE_ROUTER, 0x0003,
+                  "The request cannot be unpacked into its type",
+                  HttpStatusCode::BAD_REQUEST)
 }  // namespace google::scp::core::errors
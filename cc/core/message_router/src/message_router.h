@@ -16,12 +16,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
 
 #include "core/common/concurrent_map/src/concurrent_map.h"
 #include "core/interface/async_context.h"
+#include "absl/strings/str_cat.h"
 #include "core/interface/message_router_interface.h"
 #include "google/protobuf/any.pb.h"
 #include "public/core/interface/execution_result.h"
@@ -55,7 +57,112 @@ class MessageRouter : public MessageRouterInterface<google::protobuf::Any,
   ExecutionResult Subscribe(const RequestTypeId& request_type,
                             const AsyncAction& action) noexcept override;
 
+  /// Type of action function for the messages of a type.
+  template <typename TRequest, typename TResponse>
+  using TypedAsyncAction =
+      typename std::function<void(AsyncContext<TRequest, TResponse>&)>;
+
+  /**
+   * @brief Subscribes the action function for the TRequest messages, routed in
+   * process by OnTypedMessageReceived without packing them into Any, or packed
+   * into Any by OnMessageReceived.
+   *
+   * @tparam TRequest the request message type.
+   * @tparam TResponse the response message type.
+   * @param action the action function, which must finish the context.
+   * @return ExecutionResult the result of the subscription.
+   */
+  template <typename TRequest, typename TResponse>
+  ExecutionResult Subscribe(
+      const TypedAsyncAction<TRequest, TResponse>& action) noexcept {
+    auto typed_action =
+        std::make_shared<TypedAsyncAction<TRequest, TResponse>>(action);
+    std::shared_ptr<void> existing_typed_action;
+    auto result = typed_actions_.Insert(
+        {GetTypeId<TRequest, TResponse>(), typed_action},
+        existing_typed_action);
+    if (!result) {
+      return FailureExecutionResult(
+          errors::SC_MESSAGE_ROUTER_REQUEST_ALREADY_SUBSCRIBED);
+    }
+
+    result = Subscribe(
+        absl::StrCat(kTypeUrlPrefix, TRequest::descriptor()->full_name()),
+        [typed_action](
+            AsyncContext<google::protobuf::Any, google::protobuf::Any>&
+                any_context) {
+          RunWithUnpackedRequest<TRequest, TResponse>(*typed_action,
+                                                      any_context);
+        });
+    if (!result) {
+      typed_actions_.Erase(GetTypeId<TRequest, TResponse>());
+    }
+    return result;
+  }
+
+  /**
+   * @brief Routes the message to the action subscribed for its type, found by
+   * a precomputed integer id of the type instead of its type URL.
+   *
+   * @param context context of the message.
+   */
+  template <typename TRequest, typename TResponse>
+  void OnTypedMessageReceived(
+      AsyncContext<TRequest, TResponse>& context) noexcept {
+    std::shared_ptr<void> typed_action;
+    if (!typed_actions_.Find(GetTypeId<TRequest, TResponse>(), typed_action)) {
+      context.result = FailureExecutionResult(
+          errors::SC_MESSAGE_ROUTER_REQUEST_NOT_SUBSCRIBED);
+      context.Finish();
+      return;
+    }
+    (*std::static_pointer_cast<TypedAsyncAction<TRequest, TResponse>>(
+        typed_action))(context);
+  }
+
  private:
+  /// The prefix of the type URLs Any::PackFrom writes.
+  static constexpr char kTypeUrlPrefix[] = "type.googleapis.com/";
+
+  /// Returns the id of the request and response types, assigned on first use.
+  template <typename TRequest, typename TResponse>
+  static size_t GetTypeId() noexcept {
+    static const size_t type_id = next_type_id_.fetch_add(1);
+    return type_id;
+  }
+
+  /// Runs the typed action on the request unpacked from Any, and packs its
+  /// response back.
+  template <typename TRequest, typename TResponse>
+  static void RunWithUnpackedRequest(
+      const TypedAsyncAction<TRequest, TResponse>& action,
+      AsyncContext<google::protobuf::Any, google::protobuf::Any>&
+          any_context) noexcept {
+    auto request = std::make_shared<TRequest>();
+    if (!any_context.request->UnpackTo(request.get())) {
+      any_context.result =
+          FailureExecutionResult(errors::SC_MESSAGE_ROUTER_INVALID_REQUEST);
+      any_context.Finish();
+      return;
+    }
+
+    AsyncContext<TRequest, TResponse> context(
+        request,
+        [any_context](AsyncContext<TRequest, TResponse>& context) mutable {
+          any_context.result = context.result;
+          if (context.response) {
+            any_context.response = std::make_shared<google::protobuf::Any>();
+            any_context.response->PackFrom(*context.response);
+          }
+          any_context.Finish();
+        },
+        any_context);
+    action(context);
+  }
+
   common::ConcurrentMap<std::string, AsyncAction> actions_;
+  /// The typed actions by the id of their types.
+  common::ConcurrentMap<size_t, std::shared_ptr<void>> typed_actions_;
+  static inline std::atomic<size_t> next_type_id_{0};
 };
 }  // namespace google::scp::core
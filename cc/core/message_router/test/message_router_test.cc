@@ -178,4 +178,103 @@ TEST_F(MessageRouterTest, MultipleSubscriptions) {
   EXPECT_EQ(count_1, 1);
   EXPECT_EQ(count_2, 1);
 }
+
+TEST_F(MessageRouterTest, TypedMessage) {
+  EXPECT_SUCCESS((router_.Subscribe<TestStringRequest, TestStringResponse>(
+      [](AsyncContext<TestStringRequest, TestStringResponse>& context) {
+        context.response = make_shared<TestStringResponse>();
+        context.response->set_response(context.request->request() + "_done");
+        context.result = SuccessExecutionResult();
+        context.Finish();
+      })));
+
+  auto request = make_shared<TestStringRequest>();
+  request->set_request("test_request");
+  atomic<int> count(0);
+  AsyncContext<TestStringRequest, TestStringResponse> context(
+      request,
+      [&](AsyncContext<TestStringRequest, TestStringResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        EXPECT_EQ(context.response->response(), "test_request_done");
+        count++;
+      });
+  router_.OnTypedMessageReceived(context);
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(MessageRouterTest, TypedSubscriptionServesAnyMessages) {
+  EXPECT_SUCCESS((router_.Subscribe<TestStringRequest, TestStringResponse>(
+      [](AsyncContext<TestStringRequest, TestStringResponse>& context) {
+        context.response = make_shared<TestStringResponse>();
+        context.response->set_response(context.request->request() + "_done");
+        context.result = SuccessExecutionResult();
+        context.Finish();
+      })));
+
+  TestStringRequest test_request;
+  test_request.set_request("test_request");
+  auto request = make_shared<Any>();
+  request->PackFrom(test_request);
+  atomic<int> count(0);
+  auto context = make_shared<AsyncContext<Any, Any>>(
+      request, [&](AsyncContext<Any, Any>& context) {
+        EXPECT_SUCCESS(context.result);
+        TestStringResponse response;
+        EXPECT_TRUE(context.response->UnpackTo(&response));
+        EXPECT_EQ(response.response(), "test_request_done");
+        count++;
+      });
+  queue_->TryEnqueue(context);
+
+  WaitUntil([&]() { return count == 1; });
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(MessageRouterTest, TypedSubscriptionConflict) {
+  EXPECT_SUCCESS(
+      router_.Subscribe(any_request_1_.type_url(),
+                        [&](AsyncContext<Any, Any>& context) {}));
+
+  EXPECT_THAT((router_.Subscribe<TestStringRequest, TestStringResponse>(
+                  [](AsyncContext<TestStringRequest, TestStringResponse>&) {})),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_MESSAGE_ROUTER_REQUEST_ALREADY_SUBSCRIBED)));
+
+  // The failed subscription leaves no typed action behind.
+  atomic<int> count(0);
+  AsyncContext<TestStringRequest, TestStringResponse> context(
+      make_shared<TestStringRequest>(),
+      [&](AsyncContext<TestStringRequest, TestStringResponse>& context) {
+        EXPECT_THAT(context.result,
+                    ResultIs(FailureExecutionResult(
+                        errors::SC_MESSAGE_ROUTER_REQUEST_NOT_SUBSCRIBED)));
+        count++;
+      });
+  router_.OnTypedMessageReceived(context);
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(MessageRouterTest, TypedSubscriptionInvalidAnyMessage) {
+  EXPECT_SUCCESS((router_.Subscribe<TestBoolRequest, TestBoolResponse>(
+      [](AsyncContext<TestBoolRequest, TestBoolResponse>& context) {
+        context.result = SuccessExecutionResult();
+        context.Finish();
+      })));
+
+  // A corrupted value under the type URL of the subscription.
+  auto request = make_shared<Any>(any_request_2_);
+  request->set_value("\xff");
+  atomic<int> count(0);
+  auto context = make_shared<AsyncContext<Any, Any>>(
+      request, [&](AsyncContext<Any, Any>& context) {
+        EXPECT_THAT(context.result,
+                    ResultIs(FailureExecutionResult(
+                        errors::SC_MESSAGE_ROUTER_INVALID_REQUEST)));
+        count++;
+      });
+  queue_->TryEnqueue(context);
+
+  WaitUntil([&]() { return count == 1; });
+  EXPECT_EQ(count, 1);
+}
 }  // namespace google::scp::core::test
@@ -78,6 +78,10 @@ class MockNoSQLDatabaseProvider : public NoSQLDatabaseProviderInterface {
   ExecutionResult GetDatabaseItem(
       AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
           get_database_item_context) noexcept override {
+    if (get_database_item_mock) {
+      return get_database_item_mock(get_database_item_context);
+    }
+
     if (!get_database_item_context.request ||
         !get_database_item_context.request->table_name ||
         !get_database_item_context.request->partition_key) {
@@ -191,6 +195,35 @@ class MockNoSQLDatabaseProvider : public NoSQLDatabaseProviderInterface {
     return SuccessExecutionResult();
   }
 
+  ExecutionResult BatchGetDatabaseItems(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept override {
+    if (batch_get_database_items_mock) {
+      return batch_get_database_items_mock(batch_get_database_items_context);
+    }
+
+    batch_get_database_items_context.response =
+        std::make_shared<BatchGetDatabaseItemsResponse>();
+    for (const auto& item : batch_get_database_items_context.request->items) {
+      AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>
+          get_database_item_context;
+      get_database_item_context.request = item;
+      get_database_item_context.callback =
+          [&](AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+                  get_database_item_context) {
+            batch_get_database_items_context.response->item_results.push_back(
+                get_database_item_context.result);
+            batch_get_database_items_context.response->items.push_back(
+                get_database_item_context.response);
+          };
+      GetDatabaseItem(get_database_item_context);
+    }
+
+    batch_get_database_items_context.result = SuccessExecutionResult();
+    batch_get_database_items_context.Finish();
+    return SuccessExecutionResult();
+  }
+
   ExecutionResult UpsertDatabaseItem(
       AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
           upsert_database_item_context) noexcept override {
@@ -423,6 +456,14 @@ class MockNoSQLDatabaseProvider : public NoSQLDatabaseProviderInterface {
 
   std::shared_ptr<InMemoryDatabase> in_memory_db;
 
+  std::function<ExecutionResult(
+      AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&)>
+      get_database_item_mock;
+
+  std::function<ExecutionResult(AsyncContext<BatchGetDatabaseItemsRequest,
+                                             BatchGetDatabaseItemsResponse>&)>
+      batch_get_database_items_mock;
+
   std::function<ExecutionResult(
       AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&)>
       upsert_database_item_mock;
@@ -44,6 +44,11 @@ class MockNoSQLDatabaseProviderNoOverrides
       ((AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&)),
       (noexcept, override));
 
+  MOCK_METHOD(ExecutionResult, BatchGetDatabaseItems,
+              ((AsyncContext<BatchGetDatabaseItemsRequest,
+                             BatchGetDatabaseItemsResponse>&)),
+              (noexcept, override));
+
   MOCK_METHOD(
       ExecutionResult, UpsertDatabaseItem,
       ((AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&)),
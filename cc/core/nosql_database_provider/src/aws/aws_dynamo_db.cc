@@ -17,6 +17,8 @@
 #include "aws_dynamo_db.h"
 
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,6 +26,8 @@
 #include <aws/core/Aws.h>
 #include <aws/core/utils/Outcome.h>
 #include <aws/dynamodb/model/AttributeDefinition.h>
+#include <aws/dynamodb/model/BatchGetItemRequest.h>
+#include <aws/dynamodb/model/KeysAndAttributes.h>
 #include <aws/dynamodb/model/QueryRequest.h>
 #include <aws/dynamodb/model/UpdateItemRequest.h>
 
@@ -41,10 +45,14 @@ using Aws::Client::ClientConfiguration;
 using Aws::DynamoDB::DynamoDBClient;
 using Aws::DynamoDB::DynamoDBError;
 using Aws::DynamoDB::Model::AttributeValue;
+using Aws::DynamoDB::Model::BatchGetItemRequest;
+using Aws::DynamoDB::Model::BatchGetItemResult;
+using Aws::DynamoDB::Model::KeysAndAttributes;
 using Aws::DynamoDB::Model::QueryRequest;
 using Aws::DynamoDB::Model::QueryResult;
 using Aws::DynamoDB::Model::UpdateItemRequest;
 using Aws::DynamoDB::Model::UpdateItemResult;
+using Aws::DynamoDB::Model::ValueType;
 using Aws::Utils::Outcome;
 using google::scp::core::async_executor::aws::AwsAsyncExecutor;
 using google::scp::core::nosql_database_provider::AwsDynamoDBUtils;
@@ -52,6 +60,9 @@ using google::scp::core::nosql_database_provider::NoSQLDatabaseProviderUtils;
 using std::bind;
 using std::make_shared;
 using std::move;
+using std::optional;
+using std::pair;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -65,6 +76,95 @@ static constexpr char kDynamoDB[] = "DynamoDB";
 static constexpr size_t kMaxConcurrentConnections = 1000;
 
 namespace google::scp::core::nosql_database_provider {
+namespace {
+// Appends a length prefixed component to the key of an item, so that different
+// key values can never make the same item key.
+void AppendItemKeyComponent(const String& component, String& item_key) {
+  item_key += std::to_string(component.length()).c_str();
+  item_key += ":";
+  item_key += component;
+}
+
+// Returns the key identifying an item by its table and its key attributes.
+String GetItemKey(const String& table_name,
+                  const AttributeValue& partition_key_value,
+                  const AttributeValue* sort_key_value) {
+  auto get_value_key = [](const AttributeValue& attribute_value) {
+    if (attribute_value.GetType() == ValueType::NUMBER) {
+      return "N" + attribute_value.GetN();
+    }
+    return "S" + attribute_value.GetS();
+  };
+
+  String item_key;
+  AppendItemKeyComponent(table_name, item_key);
+  AppendItemKeyComponent(get_value_key(partition_key_value), item_key);
+  if (sort_key_value) {
+    AppendItemKeyComponent(get_value_key(*sort_key_value), item_key);
+  }
+  return item_key;
+}
+
+// Returns the key identifying a DynamoDB item of a table, or nothing if the
+// item does not carry the key attributes of the table.
+optional<String> GetItemKey(const String& table_name,
+                            const Map<String, AttributeValue>& item,
+                            const pair<String, optional<String>>& key_names) {
+  auto partition_key = item.find(key_names.first);
+  if (partition_key == item.end()) {
+    return std::nullopt;
+  }
+
+  const AttributeValue* sort_key_value = nullptr;
+  if (key_names.second) {
+    auto sort_key = item.find(*key_names.second);
+    if (sort_key == item.end()) {
+      return std::nullopt;
+    }
+    sort_key_value = &sort_key->second;
+  }
+  return GetItemKey(table_name, partition_key->second, sort_key_value);
+}
+
+// Converts a DynamoDB item into the response of its get database item request.
+ExecutionResult ConvertDynamoDBItemToGetDatabaseItemResponse(
+    const GetDatabaseItemRequest& request,
+    const Map<String, AttributeValue>& item,
+    shared_ptr<GetDatabaseItemResponse>& response) {
+  response = make_shared<GetDatabaseItemResponse>();
+  response->table_name = request.table_name;
+  response->partition_key = request.partition_key;
+  response->sort_key = request.sort_key;
+  response->attributes = make_shared<vector<NoSqlDatabaseKeyValuePair>>();
+
+  for (const auto& [attribute_name, dynamo_db_attribute_value] : item) {
+    if (strcmp(attribute_name.c_str(),
+               request.partition_key->attribute_name->c_str()) == 0 ||
+        (request.sort_key &&
+         strcmp(attribute_name.c_str(),
+                request.sort_key->attribute_name->c_str()) == 0)) {
+      continue;
+    }
+
+    NoSQLDatabaseValidAttributeValueTypes attribute_value;
+    auto execution_result = AwsDynamoDBUtils::
+        ConvertDynamoDBTypeToNoSQLDatabaseValidAttributeValueType(
+            dynamo_db_attribute_value, attribute_value);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+
+    NoSqlDatabaseKeyValuePair key_value_pair;
+    key_value_pair.attribute_name = make_shared<string>(attribute_name.c_str());
+    key_value_pair.attribute_value =
+        make_shared<NoSQLDatabaseValidAttributeValueTypes>(
+            move(attribute_value));
+    response->attributes->push_back(key_value_pair);
+  }
+  return SuccessExecutionResult();
+}
+}  // namespace
+
 ExecutionResult AwsDynamoDB::CreateClientConfig() noexcept {
   client_config_ = make_shared<ClientConfiguration>();
   client_config_->maxConnections = kMaxConcurrentConnections;
@@ -210,6 +310,8 @@ void AwsDynamoDB::OnGetDatabaseItemCallback(
     get_database_item_context.result =
         AwsDynamoDBUtils::ConvertDynamoErrorToExecutionResult(
             outcome.GetError().GetErrorType());
+    get_database_item_context.retry_after_ms =
+        AwsDynamoDBUtils::GetRetryAfterInMilliseconds(outcome.GetError());
     if (!async_executor_
              ->Schedule(
                  [get_database_item_context]() mutable {
@@ -302,6 +404,161 @@ void AwsDynamoDB::OnGetDatabaseItemCallback(
   }
 }
 
+ExecutionResult AwsDynamoDB::BatchGetDatabaseItems(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  const auto& items = batch_get_database_items_context.request->items;
+  if (items.empty() || items.size() > kMaxBatchGetDatabaseItemsSize) {
+    return FailureExecutionResult(errors::SC_NO_SQL_DATABASE_INVALID_REQUEST);
+  }
+
+  // DynamoDB rejects the requests with repeated keys, so every key is only
+  // requested once and its item is returned to all the lookups asking for it.
+  Map<String, KeysAndAttributes> request_items;
+  set<String> requested_item_keys;
+  auto item_keys = make_shared<vector<String>>();
+  for (const auto& item : items) {
+    if (!item || !item->table_name || !item->partition_key ||
+        (item->attributes && !item->attributes->empty())) {
+      return FailureExecutionResult(errors::SC_NO_SQL_DATABASE_INVALID_REQUEST);
+    }
+
+    const String table_name(*item->table_name);
+    Map<String, AttributeValue> key;
+    AttributeValue partition_key_value;
+    auto execution_result = AwsDynamoDBUtils::
+        ConvertNoSQLDatabaseValidAttributeValueTypeToDynamoDBType(
+            *item->partition_key->attribute_value, partition_key_value);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    key.emplace(String(*item->partition_key->attribute_name),
+                partition_key_value);
+
+    // Sort key is optional
+    AttributeValue sort_key_value;
+    if (item->sort_key) {
+      execution_result = AwsDynamoDBUtils::
+          ConvertNoSQLDatabaseValidAttributeValueTypeToDynamoDBType(
+              *item->sort_key->attribute_value, sort_key_value);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+      key.emplace(String(*item->sort_key->attribute_name), sort_key_value);
+    }
+
+    item_keys->push_back(
+        GetItemKey(table_name, partition_key_value,
+                   item->sort_key ? &sort_key_value : nullptr));
+    if (requested_item_keys.insert(item_keys->back()).second) {
+      request_items[table_name].AddKeys(key);
+    }
+  }
+
+  BatchGetItemRequest batch_get_item_request;
+  batch_get_item_request.SetRequestItems(request_items);
+
+  dynamo_db_client_->BatchGetItemAsync(
+      batch_get_item_request,
+      bind(&AwsDynamoDB::OnBatchGetDatabaseItemsCallback, this,
+           batch_get_database_items_context, item_keys, _1, _2, _3, _4),
+      nullptr);
+
+  return SuccessExecutionResult();
+}
+
+void AwsDynamoDB::OnBatchGetDatabaseItemsCallback(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context,
+    const shared_ptr<vector<String>>& item_keys,
+    const DynamoDBClient* dynamo_db_client,
+    const BatchGetItemRequest& batch_get_item_request,
+    const Outcome<BatchGetItemResult, DynamoDBError>& outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  if (!outcome.IsSuccess()) {
+    SCP_DEBUG_CONTEXT(
+        kDynamoDB, batch_get_database_items_context,
+        "DynamoDB batch get database items request failed. Error code: %d, "
+        "message: %s",
+        outcome.GetError().GetResponseCode(),
+        outcome.GetError().GetMessage().c_str());
+    batch_get_database_items_context.retry_after_ms =
+        AwsDynamoDBUtils::GetRetryAfterInMilliseconds(outcome.GetError());
+    FinishContext(AwsDynamoDBUtils::ConvertDynamoErrorToExecutionResult(
+                      outcome.GetError().GetErrorType()),
+                  batch_get_database_items_context, async_executor_);
+    return;
+  }
+
+  const auto& items = batch_get_database_items_context.request->items;
+  Map<String, pair<String, optional<String>>> table_key_names;
+  for (const auto& item : items) {
+    optional<String> sort_key_name;
+    if (item->sort_key) {
+      sort_key_name = String(*item->sort_key->attribute_name);
+    }
+    table_key_names.emplace(
+        String(*item->table_name),
+        make_pair(String(*item->partition_key->attribute_name),
+                  move(sort_key_name)));
+  }
+
+  Map<String, const Map<String, AttributeValue>*> returned_items;
+  for (const auto& [table_name, table_items] :
+       outcome.GetResult().GetResponses()) {
+    auto key_names = table_key_names.find(table_name);
+    if (key_names == table_key_names.end()) {
+      continue;
+    }
+    for (const auto& table_item : table_items) {
+      auto item_key = GetItemKey(table_name, table_item, key_names->second);
+      if (item_key) {
+        returned_items.emplace(move(*item_key), &table_item);
+      }
+    }
+  }
+
+  set<String> unprocessed_item_keys;
+  for (const auto& [table_name, keys_and_attributes] :
+       outcome.GetResult().GetUnprocessedKeys()) {
+    auto key_names = table_key_names.find(table_name);
+    if (key_names == table_key_names.end()) {
+      continue;
+    }
+    for (const auto& key : keys_and_attributes.GetKeys()) {
+      auto item_key = GetItemKey(table_name, key, key_names->second);
+      if (item_key) {
+        unprocessed_item_keys.insert(move(*item_key));
+      }
+    }
+  }
+
+  batch_get_database_items_context.response =
+      make_shared<BatchGetDatabaseItemsResponse>();
+  auto& response = *batch_get_database_items_context.response;
+  response.item_results.reserve(items.size());
+  response.items.resize(items.size());
+  for (size_t item_index = 0; item_index < items.size(); ++item_index) {
+    const auto& item_key = item_keys->at(item_index);
+    auto returned_item = returned_items.find(item_key);
+    if (returned_item != returned_items.end()) {
+      response.item_results.push_back(
+          ConvertDynamoDBItemToGetDatabaseItemResponse(
+              *items[item_index], *returned_item->second,
+              response.items[item_index]));
+    } else if (unprocessed_item_keys.count(item_key) > 0) {
+      response.item_results.push_back(
+          RetryExecutionResult(errors::SC_NO_SQL_DATABASE_RETRIABLE_ERROR));
+    } else {
+      response.item_results.push_back(FailureExecutionResult(
+          errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND));
+    }
+  }
+
+  FinishContext(SuccessExecutionResult(), batch_get_database_items_context,
+                async_executor_);
+}
+
 ExecutionResult AwsDynamoDB::UpsertDatabaseItem(
     AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
         upsert_database_item_context) noexcept {
@@ -446,6 +703,8 @@ void AwsDynamoDB::OnUpsertDatabaseItemCallback(
     upsert_database_item_context.result =
         AwsDynamoDBUtils::ConvertDynamoErrorToExecutionResult(
             outcome.GetError().GetErrorType());
+    upsert_database_item_context.retry_after_ms =
+        AwsDynamoDBUtils::GetRetryAfterInMilliseconds(outcome.GetError());
     if (!async_executor_
              ->Schedule(
                  [upsert_database_item_context]() mutable {
@@ -19,10 +19,12 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <aws/core/Aws.h>
 #include <aws/dynamodb/DynamoDBClient.h>
 #include <aws/dynamodb/model/AttributeDefinition.h>
+#include <aws/dynamodb/model/BatchGetItemRequest.h>
 #include <aws/dynamodb/model/QueryRequest.h>
 #include <aws/dynamodb/model/UpdateItemRequest.h>
 
@@ -60,6 +62,17 @@ class AwsDynamoDB : public NoSQLDatabaseProviderInterface {
       AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
           get_database_item_context) noexcept override;
 
+  /**
+   * @copydoc NoSQLDatabaseProviderInterface::BatchGetDatabaseItems
+   *
+   * The items are read with a single BatchGetItem request, which can carry at
+   * most 100 keys. The items that DynamoDB leaves unprocessed get a retriable
+   * result.
+   */
+  ExecutionResult BatchGetDatabaseItems(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept override;
+
   ExecutionResult UpsertDatabaseItem(
       AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
           upsert_database_item_context) noexcept override;
@@ -89,6 +102,30 @@ class AwsDynamoDB : public NoSQLDatabaseProviderInterface {
       const std::shared_ptr<const Aws::Client::AsyncCallerContext>
           async_context) noexcept;
 
+  /**
+   * @brief Is called when the response of batch get item request is ready.
+   *
+   * @param batch_get_database_items_context The context object of the batch
+   * get database items operation.
+   * @param item_keys The keys identifying the requested items, in the order
+   * of the requested items.
+   * @param dynamo_db_client An instance of the dynamo db client.
+   * @param batch_get_item_request The batch get item request object.
+   * @param outcome The outcome of the operation.
+   * @param async_context The async context of the sender. This is not used
+   * based on SCP architecture.
+   */
+  virtual void OnBatchGetDatabaseItemsCallback(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context,
+      const std::shared_ptr<std::vector<Aws::String>>& item_keys,
+      const Aws::DynamoDB::DynamoDBClient* dynamo_db_client,
+      const Aws::DynamoDB::Model::BatchGetItemRequest& batch_get_item_request,
+      const Aws::Utils::Outcome<Aws::DynamoDB::Model::BatchGetItemResult,
+                                Aws::DynamoDB::DynamoDBError>& outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
   /**
    * @brief Is called when the response of upsert item request is ready.
    *
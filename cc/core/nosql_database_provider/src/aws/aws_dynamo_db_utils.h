@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include <cstdlib>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <variant>
 
+#include <aws/core/utils/StringUtils.h>
 #include <aws/dynamodb/DynamoDBClient.h>
 #include <aws/dynamodb/model/AttributeDefinition.h>
 
@@ -29,6 +31,10 @@
 #include "core/nosql_database_provider/src/common/nosql_database_provider_utils.h"
 
 namespace google::scp::core::nosql_database_provider {
+/// The retry-after hint for DynamoDB throttling errors without a Retry-After
+/// header.
+static constexpr TimeDuration kDynamoDBThrottlingRetryAfterMs = 100;
+
 /**
  * @brief Provides utility functions for AWS DynamoDB request flows. Aws uses
  * custom types that need to be converted to SCP types during runtime.
@@ -126,5 +132,36 @@ class AwsDynamoDBUtils {
             errors::SC_NO_SQL_DATABASE_UNRETRIABLE_ERROR);
     }
   }
+
+  /**
+   * @brief Gets how long DynamoDB asked to wait before the failed request is
+   * retried, from the Retry-After header, or a default for throttling errors.
+   *
+   * @param dynamo_db_error The DynamoDB error.
+   * @return TimeDuration The retry-after hint in milliseconds, 0 if none.
+   */
+  static TimeDuration GetRetryAfterInMilliseconds(
+      const Aws::DynamoDB::DynamoDBError& dynamo_db_error) noexcept {
+    for (const auto& [name, value] : dynamo_db_error.GetResponseHeaders()) {
+      if (Aws::Utils::StringUtils::ToLower(name.c_str()) != "retry-after") {
+        continue;
+      }
+      char* end = nullptr;
+      auto retry_after_seconds = std::strtoull(value.c_str(), &end, 10);
+      if (end != value.c_str() && *end == '\0') {
+        return retry_after_seconds * 1000;
+      }
+    }
+
+    switch (dynamo_db_error.GetErrorType()) {
+      case Aws::DynamoDB::DynamoDBErrors::THROTTLING:
+      case Aws::DynamoDB::DynamoDBErrors::SLOW_DOWN:
+      case Aws::DynamoDB::DynamoDBErrors::PROVISIONED_THROUGHPUT_EXCEEDED:
+      case Aws::DynamoDB::DynamoDBErrors::REQUEST_LIMIT_EXCEEDED:
+        return kDynamoDBThrottlingRetryAfterMs;
+      default:
+        return 0;
+    }
+  }
 };
 }  // namespace google::scp::core::nosql_database_provider
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "batching_nosql_database_provider.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "error_codes.h"
+
+using std::bind;
+using std::lock_guard;
+using std::make_shared;
+using std::min;
+using std::move;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+using std::placeholders::_1;
+
+namespace google::scp::core::nosql_database_provider {
+ExecutionResult BatchingNoSQLDatabaseProvider::Init() noexcept {
+  if (max_batch_size_ == 0 || max_outstanding_batches_ == 0) {
+    return FailureExecutionResult(errors::SC_NO_SQL_DATABASE_INVALID_REQUEST);
+  }
+  return nosql_database_provider_->Init();
+}
+
+ExecutionResult BatchingNoSQLDatabaseProvider::Run() noexcept {
+  return nosql_database_provider_->Run();
+}
+
+ExecutionResult BatchingNoSQLDatabaseProvider::Stop() noexcept {
+  return nosql_database_provider_->Stop();
+}
+
+ExecutionResult BatchingNoSQLDatabaseProvider::GetDatabaseItem(
+    AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+        get_database_item_context) noexcept {
+  // The batch lookups cannot filter on attributes.
+  if (max_batch_size_ <= 1 || !get_database_item_context.request ||
+      (get_database_item_context.request->attributes &&
+       !get_database_item_context.request->attributes->empty())) {
+    return nosql_database_provider_->GetDatabaseItem(get_database_item_context);
+  }
+
+  shared_ptr<Batch> batch;
+  {
+    lock_guard<mutex> lock(pending_get_database_item_contexts_lock_);
+    pending_get_database_item_contexts_.push_back(get_database_item_context);
+    if (outstanding_batch_count_ >= max_outstanding_batches_) {
+      // Will be sent as soon as one of the batches in flight completes.
+      return SuccessExecutionResult();
+    }
+    outstanding_batch_count_++;
+    batch = TakeNextBatchLocked();
+  }
+
+  SendBatches(move(batch));
+  return SuccessExecutionResult();
+}
+
+ExecutionResult BatchingNoSQLDatabaseProvider::BatchGetDatabaseItems(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  return nosql_database_provider_->BatchGetDatabaseItems(
+      batch_get_database_items_context);
+}
+
+ExecutionResult BatchingNoSQLDatabaseProvider::UpsertDatabaseItem(
+    AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
+        upsert_database_item_context) noexcept {
+  return nosql_database_provider_->UpsertDatabaseItem(
+      upsert_database_item_context);
+}
+
+shared_ptr<BatchingNoSQLDatabaseProvider::Batch>
+BatchingNoSQLDatabaseProvider::TakeNextBatch() noexcept {
+  lock_guard<mutex> lock(pending_get_database_item_contexts_lock_);
+  if (pending_get_database_item_contexts_.empty()) {
+    outstanding_batch_count_--;
+    return nullptr;
+  }
+  return TakeNextBatchLocked();
+}
+
+shared_ptr<BatchingNoSQLDatabaseProvider::Batch>
+BatchingNoSQLDatabaseProvider::TakeNextBatchLocked() noexcept {
+  auto batch = make_shared<Batch>();
+  auto batch_size =
+      min(max_batch_size_, pending_get_database_item_contexts_.size());
+  batch->get_database_item_contexts.reserve(batch_size);
+  for (size_t i = 0; i < batch_size; ++i) {
+    batch->get_database_item_contexts.push_back(
+        move(pending_get_database_item_contexts_.front()));
+    pending_get_database_item_contexts_.pop_front();
+  }
+  return batch;
+}
+
+void BatchingNoSQLDatabaseProvider::SendBatches(
+    shared_ptr<Batch> batch) noexcept {
+  while (batch) {
+    auto execution_result = SendBatch(batch);
+    if (execution_result.Successful()) {
+      return;
+    }
+
+    auto is_completed = false;
+    if (!batch->is_completed.compare_exchange_strong(is_completed, true)) {
+      // The callback already completed the batch and sent the next one.
+      return;
+    }
+
+    for (auto& get_database_item_context : batch->get_database_item_contexts) {
+      get_database_item_context.result = execution_result;
+      get_database_item_context.Finish();
+    }
+    batch = TakeNextBatch();
+  }
+}
+
+ExecutionResult BatchingNoSQLDatabaseProvider::SendBatch(
+    const shared_ptr<Batch>& batch) noexcept {
+  auto& get_database_item_contexts = batch->get_database_item_contexts;
+  if (get_database_item_contexts.size() == 1) {
+    AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>
+        get_database_item_context(
+            get_database_item_contexts.front().request,
+            bind(&BatchingNoSQLDatabaseProvider::OnGetDatabaseItemCallback,
+                 this, batch, _1),
+            get_database_item_contexts.front());
+    return nosql_database_provider_->GetDatabaseItem(
+        get_database_item_context);
+  }
+
+  auto batch_get_database_items_request =
+      make_shared<BatchGetDatabaseItemsRequest>();
+  batch_get_database_items_request->items.reserve(
+      get_database_item_contexts.size());
+  for (const auto& get_database_item_context : get_database_item_contexts) {
+    batch_get_database_items_request->items.push_back(
+        get_database_item_context.request);
+  }
+
+  AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+      batch_get_database_items_context(
+          move(batch_get_database_items_request),
+          bind(&BatchingNoSQLDatabaseProvider::OnBatchGetDatabaseItemsCallback,
+               this, batch, _1),
+          get_database_item_contexts.front());
+  return nosql_database_provider_->BatchGetDatabaseItems(
+      batch_get_database_items_context);
+}
+
+void BatchingNoSQLDatabaseProvider::OnGetDatabaseItemCallback(
+    const shared_ptr<Batch>& batch,
+    AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+        get_database_item_context) noexcept {
+  auto is_completed = false;
+  if (!batch->is_completed.compare_exchange_strong(is_completed, true)) {
+    return;
+  }
+
+  auto& batched_get_database_item_context =
+      batch->get_database_item_contexts.front();
+  batched_get_database_item_context.response =
+      get_database_item_context.response;
+  batched_get_database_item_context.result = get_database_item_context.result;
+  batched_get_database_item_context.retry_after_ms =
+      get_database_item_context.retry_after_ms;
+  batched_get_database_item_context.Finish();
+
+  SendBatches(TakeNextBatch());
+}
+
+void BatchingNoSQLDatabaseProvider::OnBatchGetDatabaseItemsCallback(
+    const shared_ptr<Batch>& batch,
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  auto is_completed = false;
+  if (!batch->is_completed.compare_exchange_strong(is_completed, true)) {
+    return;
+  }
+
+  auto& get_database_item_contexts = batch->get_database_item_contexts;
+  const auto& response = batch_get_database_items_context.response;
+  for (size_t i = 0; i < get_database_item_contexts.size(); ++i) {
+    auto& get_database_item_context = get_database_item_contexts[i];
+    if (!batch_get_database_items_context.result.Successful()) {
+      get_database_item_context.result =
+          batch_get_database_items_context.result;
+      get_database_item_context.retry_after_ms =
+          batch_get_database_items_context.retry_after_ms;
+    } else if (!response || i >= response->item_results.size() ||
+               i >= response->items.size()) {
+      get_database_item_context.result =
+          FailureExecutionResult(errors::SC_NO_SQL_DATABASE_UNRETRIABLE_ERROR);
+    } else {
+      get_database_item_context.response = response->items[i];
+      get_database_item_context.result = response->item_results[i];
+    }
+    get_database_item_context.Finish();
+  }
+
+  SendBatches(TakeNextBatch());
+}
+}  // namespace google::scp::core::nosql_database_provider
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/interface/nosql_database_provider_interface.h"
+
+namespace google::scp::core::nosql_database_provider {
+/**
+ * @brief Coalesces the get database item requests of many callers into batch
+ * get database items requests to the wrapped provider.
+ *
+ * Up to max_outstanding_batches batches are in flight at any time. The lookups
+ * arriving while that many batches are in flight are queued, and sent as the
+ * next batch as soon as one of the batches completes. A lone lookup is thus
+ * sent right away, and a burst of cache misses over many keys costs a few
+ * round trips instead of one per key.
+ *
+ * The lookups filtering on attributes and the upserts are forwarded to the
+ * wrapped provider as they are. The lifecycle of the wrapped provider is
+ * driven by this one.
+ */
+class BatchingNoSQLDatabaseProvider : public NoSQLDatabaseProviderInterface {
+ public:
+  BatchingNoSQLDatabaseProvider(
+      const std::shared_ptr<NoSQLDatabaseProviderInterface>&
+          nosql_database_provider,
+      size_t max_batch_size, size_t max_outstanding_batches)
+      : nosql_database_provider_(nosql_database_provider),
+        max_batch_size_(
+            std::min(max_batch_size, kMaxBatchGetDatabaseItemsSize)),
+        max_outstanding_batches_(max_outstanding_batches),
+        outstanding_batch_count_(0) {}
+
+  ExecutionResult Init() noexcept override;
+
+  ExecutionResult Run() noexcept override;
+
+  ExecutionResult Stop() noexcept override;
+
+  ExecutionResult GetDatabaseItem(
+      AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+          get_database_item_context) noexcept override;
+
+  ExecutionResult BatchGetDatabaseItems(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept override;
+
+  ExecutionResult UpsertDatabaseItem(
+      AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
+          upsert_database_item_context) noexcept override;
+
+ protected:
+  /// The lookups sent to the wrapped provider together.
+  struct Batch {
+    std::vector<AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>>
+        get_database_item_contexts;
+    /// Set by whoever completes the batch first. The wrapped providers may
+    /// both invoke the callback and return a failure when they cannot
+    /// schedule the operation.
+    std::atomic<bool> is_completed = false;
+  };
+
+  /**
+   * @brief Takes the next batch out of the queued lookups, or releases the
+   * in flight slot of the caller if there is no queued lookup.
+   *
+   * @return std::shared_ptr<Batch> The batch, nullptr if there is none.
+   */
+  std::shared_ptr<Batch> TakeNextBatch() noexcept;
+
+  /**
+   * @brief Takes the next batch out of the queued lookups. Must be called
+   * with pending_get_database_item_contexts_lock_ held and with at least one
+   * queued lookup.
+   *
+   * @return std::shared_ptr<Batch> The batch.
+   */
+  std::shared_ptr<Batch> TakeNextBatchLocked() noexcept;
+
+  /**
+   * @brief Sends the batch to the wrapped provider, and keeps sending the next
+   * batches as long as the wrapped provider fails them synchronously.
+   *
+   * @param batch The batch to send.
+   */
+  void SendBatches(std::shared_ptr<Batch> batch) noexcept;
+
+  /**
+   * @brief Sends a single batch to the wrapped provider. A batch with a single
+   * lookup is sent as a get database item request.
+   *
+   * @param batch The batch to send.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult SendBatch(const std::shared_ptr<Batch>& batch) noexcept;
+
+  /**
+   * @brief Is called when the lookup of a batch with a single lookup is
+   * completed.
+   *
+   * @param batch The completed batch.
+   * @param get_database_item_context The context of the lookup sent to the
+   * wrapped provider.
+   */
+  void OnGetDatabaseItemCallback(
+      const std::shared_ptr<Batch>& batch,
+      AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+          get_database_item_context) noexcept;
+
+  /**
+   * @brief Is called when the batch get database items request of a batch is
+   * completed.
+   *
+   * @param batch The completed batch.
+   * @param batch_get_database_items_context The context of the batch get
+   * database items request sent to the wrapped provider.
+   */
+  void OnBatchGetDatabaseItemsCallback(
+      const std::shared_ptr<Batch>& batch,
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept;
+
+  /// The wrapped provider.
+  const std::shared_ptr<NoSQLDatabaseProviderInterface>
+      nosql_database_provider_;
+  /// The maximum number of lookups in a batch, at most
+  /// kMaxBatchGetDatabaseItemsSize.
+  const size_t max_batch_size_;
+  /// The maximum number of batches in flight.
+  const size_t max_outstanding_batches_;
+  /// Guards the queued lookups and the number of batches in flight.
+  std::mutex pending_get_database_item_contexts_lock_;
+  /// The lookups waiting for a batch to be sent in.
+  std::deque<AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>>
+      pending_get_database_item_contexts_;
+  /// The number of batches in flight.
+  size_t outstanding_batch_count_;
+};
+}  // namespace google::scp::core::nosql_database_provider
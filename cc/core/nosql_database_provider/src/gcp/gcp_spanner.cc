@@ -41,6 +41,8 @@ namespace {
 
 using google::cloud::spanner::Client;
 using google::cloud::spanner::Database;
+using google::cloud::spanner::Key;
+using google::cloud::spanner::KeySet;
 using SpannerJson = google::cloud::spanner::Json;
 using google::cloud::StatusOr;
 using google::cloud::spanner::ExponentialBackoffPolicy;
@@ -156,6 +158,45 @@ ExecutionResult AppendJsonWhereClauses(
   return SuccessExecutionResult();
 }
 
+// Populates the response of a get database item request from the JSON in the
+// Value column of the found row.
+ExecutionResult PopulateGetDatabaseItemResponse(
+    const GetDatabaseItemRequest& request, const string& value,
+    shared_ptr<GetDatabaseItemResponse>& response) {
+  json value_json;
+  try {
+    value_json = json::parse(value);
+  } catch (...) {
+    return FailureExecutionResult(
+        errors::SC_NO_SQL_DATABASE_JSON_FAILED_TO_PARSE);
+  }
+
+  response = make_shared<GetDatabaseItemResponse>();
+  response->table_name = request.table_name;
+  response->partition_key = request.partition_key;
+  response->sort_key = request.sort_key;
+  response->attributes = make_shared<vector<NoSqlDatabaseKeyValuePair>>();
+
+  // Populate response attributes from all of the elements in the Value
+  // column.
+  for (auto& [json_attr_name, json_attr_value] : value_json.items()) {
+    auto attr_value = make_shared<NoSQLDatabaseValidAttributeValueTypes>();
+    if (!GcpSpannerUtils::ConvertJsonTypeToNoSQLDatabaseValidAttributeValueType(
+             json_attr_value, *attr_value)
+             .Successful()) {
+      // If conversion fails, it is likely a list, struct, or other
+      // unsupported type. Continue without failing.
+      // TODO Log this?
+      continue;
+    }
+    NoSqlDatabaseKeyValuePair& key_value_pair =
+        response->attributes->emplace_back();
+    key_value_pair.attribute_name = make_shared<string>(json_attr_name);
+    key_value_pair.attribute_value = attr_value;
+  }
+  return SuccessExecutionResult();
+}
+
 }  // namespace
 
 ExecutionResult GcpSpanner::Init() noexcept {
@@ -239,44 +280,15 @@ void GcpSpanner::GetDatabaseItemAsync(
     return;
   }
 
-  get_database_item_context.response = make_shared<GetDatabaseItemResponse>();
-  get_database_item_context.response->table_name =
-      get_database_item_context.request->table_name;
-  get_database_item_context.response->partition_key =
-      get_database_item_context.request->partition_key;
-  get_database_item_context.response->sort_key =
-      get_database_item_context.request->sort_key;
-  get_database_item_context.response->attributes =
-      make_shared<vector<NoSqlDatabaseKeyValuePair>>();
-
-  json value_json;
-  try {
-    value_json = json::parse(string(*spanner_json_or));
-  } catch (...) {
-    FinishContext(
-        FailureExecutionResult(errors::SC_NO_SQL_DATABASE_JSON_FAILED_TO_PARSE),
-        get_database_item_context, async_executor_, async_execution_priority_);
+  if (auto execution_result = PopulateGetDatabaseItemResponse(
+          *get_database_item_context.request, string(*spanner_json_or),
+          get_database_item_context.response);
+      !execution_result.Successful()) {
+    FinishContext(execution_result, get_database_item_context, async_executor_,
+                  async_execution_priority_);
     return;
   }
 
-  // Populate response attributes from all of the elements in the Value
-  // column.
-  for (auto& [json_attr_name, json_attr_value] : value_json.items()) {
-    auto attr_value = make_shared<NoSQLDatabaseValidAttributeValueTypes>();
-    if (!GcpSpannerUtils::ConvertJsonTypeToNoSQLDatabaseValidAttributeValueType(
-             json_attr_value, *attr_value)
-             .Successful()) {
-      // If conversion fails, it is likely a list, struct, or other
-      // unsupported type. Continue without failing.
-      // TODO Log this?
-      continue;
-    }
-    NoSqlDatabaseKeyValuePair& key_value_pair =
-        get_database_item_context.response->attributes->emplace_back();
-    key_value_pair.attribute_name = make_shared<string>(json_attr_name);
-    key_value_pair.attribute_value = attr_value;
-  }
-
   // Executed on non-IO pool to keep it separate from IO aspects.
   FinishContext(SuccessExecutionResult(), get_database_item_context,
                 async_executor_, async_execution_priority_);
@@ -355,6 +367,141 @@ ExecutionResult GcpSpanner::GetDatabaseItem(
   return SuccessExecutionResult();
 }
 
+ExecutionResult GcpSpanner::BatchGetDatabaseItems(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  const auto& items = batch_get_database_items_context.request->items;
+  if (items.empty()) {
+    return FailureExecutionResult(errors::SC_NO_SQL_DATABASE_INVALID_REQUEST);
+  }
+
+  auto item_keys = make_shared<vector<Key>>();
+  item_keys->reserve(items.size());
+  for (const auto& item : items) {
+    if (!item || !item->table_name || !item->partition_key ||
+        (item->attributes && !item->attributes->empty())) {
+      return FailureExecutionResult(errors::SC_NO_SQL_DATABASE_INVALID_REQUEST);
+    }
+    if (auto execution_result =
+            ValidatePartitionAndSortKey(table_name_to_keys_.get(), *item);
+        !execution_result.Successful()) {
+      return execution_result;
+    }
+
+    auto& item_key = item_keys->emplace_back();
+    Value spanner_part_key_val;
+    RETURN_IF_FAILURE(
+        GcpSpannerUtils::ConvertNoSQLDatabaseAttributeValueTypeToSpannerValue(
+            *item->partition_key->attribute_value, spanner_part_key_val));
+    item_key.push_back(move(spanner_part_key_val));
+
+    // sort_key is optional
+    if (item->sort_key != nullptr) {
+      Value spanner_sort_key_val;
+      RETURN_IF_FAILURE(
+          GcpSpannerUtils::ConvertNoSQLDatabaseAttributeValueTypeToSpannerValue(
+              *item->sort_key->attribute_value, spanner_sort_key_val));
+      item_key.push_back(move(spanner_sort_key_val));
+    }
+  }
+
+  if (auto schedule_result = io_async_executor_->Schedule(
+          bind(&GcpSpanner::BatchGetDatabaseItemsAsync, this,
+               batch_get_database_items_context, item_keys),
+          io_async_execution_priority_);
+      !schedule_result.Successful()) {
+    batch_get_database_items_context.result = schedule_result;
+    batch_get_database_items_context.Finish();
+    return schedule_result;
+  }
+
+  return SuccessExecutionResult();
+}
+
+void GcpSpanner::BatchGetDatabaseItemsAsync(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+        batch_get_database_items_context,
+    shared_ptr<vector<Key>> item_keys) noexcept {
+  const auto& items = batch_get_database_items_context.request->items;
+  auto response = make_shared<BatchGetDatabaseItemsResponse>();
+  response->item_results.resize(
+      items.size(),
+      FailureExecutionResult(
+          errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND));
+  response->items.resize(items.size());
+
+  // A read covers the keys of a single table.
+  unordered_map<string, vector<size_t>> item_indices_per_table;
+  for (size_t item_index = 0; item_index < items.size(); ++item_index) {
+    item_indices_per_table[*items[item_index]->table_name].push_back(
+        item_index);
+  }
+
+  Client spanner_client(*spanner_client_shared_);
+  for (const auto& [table_name, item_indices] : item_indices_per_table) {
+    const auto& first_item = *items[item_indices.front()];
+    vector<string> columns = {*first_item.partition_key->attribute_name};
+    if (first_item.sort_key != nullptr) {
+      columns.push_back(*first_item.sort_key->attribute_name);
+    }
+    const auto key_column_count = columns.size();
+    columns.push_back(kValueColumnName);
+
+    KeySet key_set;
+    for (auto item_index : item_indices) {
+      key_set.AddKey(item_keys->at(item_index));
+    }
+
+    auto row_stream =
+        spanner_client.Read(table_name, move(key_set), move(columns));
+    for (const auto& row : row_stream) {
+      if (!row.ok()) {
+        auto result =
+            GcpSpannerUtils::ConvertCloudSpannerErrorToExecutionResult(
+                row.status().code());
+        SCP_ERROR_CONTEXT(
+            kGcpSpanner, batch_get_database_items_context, result,
+            absl::StrFormat(
+                "Spanner batch get database items request failed. Error code: "
+                "%d, message: %s",
+                row.status().code(), row.status().message()));
+        FinishContext(result, batch_get_database_items_context,
+                      async_executor_, async_execution_priority_);
+        return;
+      }
+
+      Key row_key(row->values().begin(),
+                  row->values().begin() + key_column_count);
+      const auto spanner_json_or =
+          row->get<optional<SpannerJson>>(key_column_count);
+      for (auto item_index : item_indices) {
+        if (item_keys->at(item_index) != row_key) {
+          continue;
+        }
+
+        if (!spanner_json_or.ok()) {
+          response->item_results[item_index] =
+              GcpSpannerUtils::ConvertCloudSpannerErrorToExecutionResult(
+                  spanner_json_or.status().code());
+          continue;
+        }
+
+        string value = "{}";
+        if (spanner_json_or->has_value()) {
+          value = string(**spanner_json_or);
+        }
+        response->item_results[item_index] = PopulateGetDatabaseItemResponse(
+            *items[item_index], value, response->items[item_index]);
+      }
+    }
+  }
+
+  batch_get_database_items_context.response = move(response);
+  // Executed on non-IO pool to keep it separate from IO aspects.
+  FinishContext(SuccessExecutionResult(), batch_get_database_items_context,
+                async_executor_, async_execution_priority_);
+}
+
 ExecutionResultOr<GcpSpanner::UpsertSelectOptions>
 GcpSpanner::UpsertSelectOptions::BuildUpsertSelectOptions(
     const UpsertDatabaseItemRequest& request) {
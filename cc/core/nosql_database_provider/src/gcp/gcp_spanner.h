@@ -29,6 +29,7 @@
 #include "core/interface/config_provider_interface.h"
 #include "core/interface/nosql_database_provider_interface.h"
 #include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/keys.h"
 #include "google/cloud/spanner/mutations.h"
 
 namespace google::scp::core::nosql_database_provider {
@@ -72,6 +73,15 @@ class GcpSpanner : public NoSQLDatabaseProviderInterface {
       AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
           get_database_item_context) noexcept override;
 
+  /**
+   * @copydoc NoSQLDatabaseProviderInterface::BatchGetDatabaseItems
+   *
+   * The items of a table are read with a single read of their key set.
+   */
+  ExecutionResult BatchGetDatabaseItems(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept override;
+
   ExecutionResult UpsertDatabaseItem(
       AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
           upsert_database_item_context) noexcept override;
@@ -110,6 +120,21 @@ class GcpSpanner : public NoSQLDatabaseProviderInterface {
       std::string query,
       google::cloud::spanner::SqlStatement::ParamType params) noexcept;
 
+  /**
+   * @brief Is called by async executor in order to acquire the DB items of a
+   * batch.
+   *
+   * @param batch_get_database_items_context The context object of the batch
+   * get database items operation.
+   * @param item_keys The Spanner keys of the requested items, in the order of
+   * the requested items.
+   */
+  virtual void BatchGetDatabaseItemsAsync(
+      AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+          batch_get_database_items_context,
+      std::shared_ptr<std::vector<google::cloud::spanner::Key>>
+          item_keys) noexcept;
+
   struct UpsertSelectOptions {
     static ExecutionResultOr<UpsertSelectOptions> BuildUpsertSelectOptions(
         const UpsertDatabaseItemRequest& request);
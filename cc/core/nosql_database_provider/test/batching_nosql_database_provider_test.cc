@@ -0,0 +1,240 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/nosql_database_provider/src/common/batching_nosql_database_provider.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/nosql_database_provider/mock/mock_nosql_database_provider.h"
+#include "core/nosql_database_provider/src/common/error_codes.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::BatchGetDatabaseItemsRequest;
+using google::scp::core::BatchGetDatabaseItemsResponse;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::GetDatabaseItemRequest;
+using google::scp::core::GetDatabaseItemResponse;
+using google::scp::core::kMaxBatchGetDatabaseItemsSize;
+using google::scp::core::NoSqlDatabaseKeyValuePair;
+using google::scp::core::NoSQLDatabaseValidAttributeValueTypes;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::nosql_database_provider::BatchingNoSQLDatabaseProvider;
+using google::scp::core::nosql_database_provider::mock::
+    MockNoSQLDatabaseProvider;
+using google::scp::core::test::ResultIs;
+using std::get;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace google::scp::core::nosql_database_provider::test {
+
+class BatchingNoSQLDatabaseProviderTest : public ::testing::Test {
+ protected:
+  BatchingNoSQLDatabaseProviderTest()
+      : mock_nosql_database_provider_(
+            make_shared<MockNoSQLDatabaseProvider>()) {
+    mock_nosql_database_provider_->get_database_item_mock =
+        [&](AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+                context) {
+          get_database_item_contexts_.push_back(context);
+          return SuccessExecutionResult();
+        };
+    mock_nosql_database_provider_->batch_get_database_items_mock =
+        [&](AsyncContext<BatchGetDatabaseItemsRequest,
+                         BatchGetDatabaseItemsResponse>& context) {
+          batch_get_database_items_contexts_.push_back(context);
+          return batch_get_database_items_result_;
+        };
+  }
+
+  // Issues a lookup of the key through the batching provider, recording the
+  // result it completes with.
+  void GetDatabaseItem(BatchingNoSQLDatabaseProvider& provider,
+                       const string& key,
+                       vector<ExecutionResult>& results) {
+    AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse> context;
+    context.request = make_shared<GetDatabaseItemRequest>();
+    context.request->table_name = make_shared<string>("table");
+    context.request->partition_key = make_shared<NoSqlDatabaseKeyValuePair>();
+    context.request->partition_key->attribute_name = make_shared<string>("pk");
+    context.request->partition_key->attribute_value =
+        make_shared<NoSQLDatabaseValidAttributeValueTypes>(key);
+    context.callback =
+        [&](AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+                context) { results.push_back(context.result); };
+    EXPECT_SUCCESS(provider.GetDatabaseItem(context));
+  }
+
+  // Completes a batch with the given item results.
+  static void CompleteBatch(
+      AsyncContext<BatchGetDatabaseItemsRequest,
+                   BatchGetDatabaseItemsResponse>& context,
+      const vector<ExecutionResult>& item_results) {
+    context.response = make_shared<BatchGetDatabaseItemsResponse>();
+    context.response->item_results = item_results;
+    context.response->items.resize(item_results.size());
+    context.result = SuccessExecutionResult();
+    context.Finish();
+  }
+
+  shared_ptr<MockNoSQLDatabaseProvider> mock_nosql_database_provider_;
+  vector<AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>>
+      get_database_item_contexts_;
+  vector<AsyncContext<BatchGetDatabaseItemsRequest,
+                      BatchGetDatabaseItemsResponse>>
+      batch_get_database_items_contexts_;
+  ExecutionResult batch_get_database_items_result_ = SuccessExecutionResult();
+};
+
+TEST_F(BatchingNoSQLDatabaseProviderTest, LoneLookupIsSentRightAway) {
+  BatchingNoSQLDatabaseProvider provider(mock_nosql_database_provider_, 10, 1);
+  vector<ExecutionResult> results;
+  GetDatabaseItem(provider, "key_1", results);
+
+  ASSERT_EQ(get_database_item_contexts_.size(), 1);
+  EXPECT_TRUE(batch_get_database_items_contexts_.empty());
+  EXPECT_TRUE(results.empty());
+
+  get_database_item_contexts_[0].result = SuccessExecutionResult();
+  get_database_item_contexts_[0].Finish();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_SUCCESS(results[0]);
+}
+
+TEST_F(BatchingNoSQLDatabaseProviderTest,
+       LookupsArrivingWhileBatchIsInFlightAreBatched) {
+  BatchingNoSQLDatabaseProvider provider(mock_nosql_database_provider_, 2, 1);
+  vector<ExecutionResult> results;
+  for (auto key : {"key_1", "key_2", "key_3", "key_4"}) {
+    GetDatabaseItem(provider, key, results);
+  }
+  ASSERT_EQ(get_database_item_contexts_.size(), 1);
+  EXPECT_TRUE(batch_get_database_items_contexts_.empty());
+
+  get_database_item_contexts_[0].result = SuccessExecutionResult();
+  get_database_item_contexts_[0].Finish();
+
+  // The queued lookups are sent in batches of at most two.
+  ASSERT_EQ(batch_get_database_items_contexts_.size(), 1);
+  auto& items = batch_get_database_items_contexts_[0].request->items;
+  ASSERT_EQ(items.size(), 2);
+  EXPECT_EQ(get<string>(*items[0]->partition_key->attribute_value), "key_2");
+  EXPECT_EQ(get<string>(*items[1]->partition_key->attribute_value), "key_3");
+
+  CompleteBatch(batch_get_database_items_contexts_[0],
+                {SuccessExecutionResult(),
+                 FailureExecutionResult(
+                     errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)});
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_SUCCESS(results[1]);
+  EXPECT_THAT(results[2],
+              ResultIs(FailureExecutionResult(
+                  errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)));
+
+  // The last lookup is alone in its batch.
+  ASSERT_EQ(get_database_item_contexts_.size(), 2);
+  EXPECT_EQ(get<string>(*get_database_item_contexts_[1]
+                             .request->partition_key->attribute_value),
+            "key_4");
+  get_database_item_contexts_[1].result = SuccessExecutionResult();
+  get_database_item_contexts_[1].Finish();
+
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_SUCCESS(results[3]);
+
+  // Nothing is in flight anymore, so the next lookup is sent right away.
+  GetDatabaseItem(provider, "key_5", results);
+  EXPECT_EQ(get_database_item_contexts_.size(), 3);
+}
+
+TEST_F(BatchingNoSQLDatabaseProviderTest,
+       BatchesAreLimitedToTheMaxBatchGetDatabaseItemsSize) {
+  BatchingNoSQLDatabaseProvider provider(mock_nosql_database_provider_, 500,
+                                         1);
+  vector<ExecutionResult> results;
+  for (size_t i = 0; i < 151; ++i) {
+    GetDatabaseItem(provider, "key_" + std::to_string(i), results);
+  }
+  ASSERT_EQ(get_database_item_contexts_.size(), 1);
+  get_database_item_contexts_[0].result = SuccessExecutionResult();
+  get_database_item_contexts_[0].Finish();
+
+  ASSERT_EQ(batch_get_database_items_contexts_.size(), 1);
+  EXPECT_EQ(batch_get_database_items_contexts_[0].request->items.size(),
+            kMaxBatchGetDatabaseItemsSize);
+  CompleteBatch(batch_get_database_items_contexts_[0],
+                vector<ExecutionResult>(kMaxBatchGetDatabaseItemsSize,
+                                        SuccessExecutionResult()));
+
+  ASSERT_EQ(batch_get_database_items_contexts_.size(), 2);
+  EXPECT_EQ(batch_get_database_items_contexts_[1].request->items.size(), 50);
+  CompleteBatch(batch_get_database_items_contexts_[1],
+                vector<ExecutionResult>(50, SuccessExecutionResult()));
+  EXPECT_EQ(results.size(), 151);
+}
+
+TEST_F(BatchingNoSQLDatabaseProviderTest, FailedBatchFailsAllItsLookups) {
+  BatchingNoSQLDatabaseProvider provider(mock_nosql_database_provider_, 10, 1);
+  vector<ExecutionResult> results;
+  for (auto key : {"key_1", "key_2", "key_3"}) {
+    GetDatabaseItem(provider, key, results);
+  }
+
+  batch_get_database_items_result_ =
+      FailureExecutionResult(errors::SC_NO_SQL_DATABASE_RETRIABLE_ERROR);
+  get_database_item_contexts_[0].result = SuccessExecutionResult();
+  get_database_item_contexts_[0].Finish();
+
+  ASSERT_EQ(batch_get_database_items_contexts_.size(), 1);
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_THAT(results[1], ResultIs(FailureExecutionResult(
+                              errors::SC_NO_SQL_DATABASE_RETRIABLE_ERROR)));
+  EXPECT_THAT(results[2], ResultIs(FailureExecutionResult(
+                              errors::SC_NO_SQL_DATABASE_RETRIABLE_ERROR)));
+
+  // Completing the failed batch afterwards has no effect.
+  CompleteBatch(batch_get_database_items_contexts_[0],
+                {SuccessExecutionResult(), SuccessExecutionResult()});
+  EXPECT_EQ(results.size(), 3);
+
+  GetDatabaseItem(provider, "key_4", results);
+  EXPECT_EQ(get_database_item_contexts_.size(), 2);
+}
+
+TEST_F(BatchingNoSQLDatabaseProviderTest, LookupsFilteringOnAttributesAreSent) {
+  BatchingNoSQLDatabaseProvider provider(mock_nosql_database_provider_, 10, 1);
+  vector<ExecutionResult> results;
+  GetDatabaseItem(provider, "key_1", results);
+
+  AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse> context;
+  context.request = make_shared<GetDatabaseItemRequest>();
+  context.request->attributes = make_shared<vector<NoSqlDatabaseKeyValuePair>>(
+      vector<NoSqlDatabaseKeyValuePair>(1));
+  EXPECT_SUCCESS(provider.GetDatabaseItem(context));
+
+  EXPECT_EQ(get_database_item_contexts_.size(), 2);
+}
+}  // namespace google::scp::core::nosql_database_provider::test
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "core/interface/errors.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core::errors {
+REGISTER_COMPONENT_CODE(SC_MEMORY_GOVERNOR, 0x0F01)
+
+DEFINE_ERROR_CODE(SC_MEMORY_GOVERNOR_INVALID_OPTIONS, SC_MEMORY_GOVERNOR,
+                  0x0001, "The memory governor options are invalid.",
+                  HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SC_MEMORY_GOVERNOR_FAILED_TO_STOP, SC_MEMORY_GOVERNOR,
+                  0x0002, "The memory governor poll could not be cancelled.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+}  // namespace google::scp::core::errors
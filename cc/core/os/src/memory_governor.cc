@@ -0,0 +1,191 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory_governor.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/common/uuid/src/uuid.h"
+
+#include "error_codes.h"
+
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
+using google::scp::core::os::linux::SystemResourceInfoProvider;
+using std::function;
+using std::lock_guard;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+
+static constexpr char kMemoryGovernor[] = "MemoryGovernor";
+
+namespace google::scp::core::os {
+MemoryGovernor::MemoryGovernor(
+    shared_ptr<SystemResourceInfoProvider> system_resource_info_provider,
+    shared_ptr<AsyncExecutorInterface> async_executor,
+    MemoryGovernorOptions options)
+    : system_resource_info_provider_(std::move(system_resource_info_provider)),
+      async_executor_(std::move(async_executor)),
+      options_(std::move(options)),
+      resource_scale_(1.0),
+      should_shed_load_(false),
+      is_running_(false),
+      next_target_id_(0) {}
+
+ExecutionResult MemoryGovernor::Init() noexcept {
+  if (options_.target_available_memory_kb == 0 ||
+      options_.shed_load_available_memory_kb >
+          options_.target_available_memory_kb ||
+      options_.poll_interval.count() <= 0 || options_.learning_rate <= 0 ||
+      options_.min_resource_scale <= 0 || options_.min_resource_scale > 1) {
+    auto execution_result =
+        FailureExecutionResult(errors::SC_MEMORY_GOVERNOR_INVALID_OPTIONS);
+    SCP_ERROR(kMemoryGovernor, kZeroUuid, execution_result,
+              "Invalid memory governor options. Target available memory: "
+              "'%llu' KB, shed load available memory: '%llu' KB",
+              options_.target_available_memory_kb,
+              options_.shed_load_available_memory_kb);
+    return execution_result;
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult MemoryGovernor::Run() noexcept {
+  {
+    lock_guard<mutex> lock(mutex_);
+    is_running_ = true;
+  }
+  // The first poll sizes the caches before they take any traffic.
+  Poll();
+  return SuccessExecutionResult();
+}
+
+ExecutionResult MemoryGovernor::Stop() noexcept {
+  lock_guard<mutex> lock(mutex_);
+  is_running_ = false;
+  if (poll_canceller_ && !poll_canceller_()) {
+    return FailureExecutionResult(errors::SC_MEMORY_GOVERNOR_FAILED_TO_STOP);
+  }
+  poll_canceller_ = nullptr;
+  return SuccessExecutionResult();
+}
+
+size_t MemoryGovernor::RegisterTarget(ResourceScaleCallback callback) noexcept {
+  size_t target_id;
+  {
+    lock_guard<mutex> lock(mutex_);
+    target_id = next_target_id_++;
+    targets_.emplace(target_id, callback);
+  }
+  callback(resource_scale_.load());
+  return target_id;
+}
+
+void MemoryGovernor::UnregisterTarget(size_t target_id) noexcept {
+  lock_guard<mutex> lock(mutex_);
+  targets_.erase(target_id);
+}
+
+void MemoryGovernor::Poll() noexcept {
+  auto available_memory_kb_or =
+      system_resource_info_provider_->GetAvailableMemoryKb();
+  if (!available_memory_kb_or.Successful()) {
+    // The caches keep their current size until the next successful read.
+    SCP_ERROR(kMemoryGovernor, kZeroUuid, available_memory_kb_or.result(),
+              "Cannot read the available memory");
+  } else {
+    auto available_memory_kb = *available_memory_kb_or;
+    auto target = static_cast<double>(options_.target_available_memory_kb);
+    auto relative_error = std::clamp(
+        (static_cast<double>(available_memory_kb) - target) / target, -1.0,
+        1.0);
+    auto resource_scale = resource_scale_.load();
+    auto new_resource_scale =
+        std::clamp(resource_scale + options_.learning_rate * relative_error,
+                   options_.min_resource_scale, 1.0);
+
+    // Once started, load is shed until the host is back to its target, so
+    // that it does not flap around the threshold.
+    if (available_memory_kb < options_.shed_load_available_memory_kb) {
+      if (!should_shed_load_.exchange(true)) {
+        SCP_WARNING(kMemoryGovernor, kZeroUuid,
+                    "Available memory '%llu' KB is below '%llu' KB, shedding "
+                    "load",
+                    available_memory_kb,
+                    options_.shed_load_available_memory_kb);
+      }
+    } else if (available_memory_kb >= options_.target_available_memory_kb) {
+      if (should_shed_load_.exchange(false)) {
+        SCP_INFO(kMemoryGovernor, kZeroUuid,
+                 "Available memory '%llu' KB is back to the target, stopped "
+                 "shedding load",
+                 available_memory_kb);
+      }
+    }
+
+    if (new_resource_scale != resource_scale) {
+      resource_scale_ = new_resource_scale;
+      vector<ResourceScaleCallback> targets;
+      {
+        lock_guard<mutex> lock(mutex_);
+        for (const auto& [target_id, callback] : targets_) {
+          targets.push_back(callback);
+        }
+      }
+      for (auto& callback : targets) {
+        callback(new_resource_scale);
+      }
+    }
+  }
+
+  auto execution_result = SchedulePoll();
+  if (!execution_result.Successful()) {
+    SCP_CRITICAL(kMemoryGovernor, kZeroUuid, execution_result,
+                 "Cannot schedule the next memory poll. The caches will not "
+                 "be resized anymore!");
+  }
+}
+
+ExecutionResult MemoryGovernor::SchedulePoll() noexcept {
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (!is_running_) {
+      return SuccessExecutionResult();
+    }
+  }
+
+  function<bool()> poll_canceller;
+  auto poll_time =
+      (TimeProvider::GetSteadyTimestampInNanoseconds() + options_.poll_interval)
+          .count();
+  RETURN_IF_FAILURE(async_executor_->ScheduleFor([this]() { Poll(); },
+                                                 poll_time, poll_canceller));
+
+  lock_guard<mutex> lock(mutex_);
+  if (!is_running_) {
+    // Stopped while scheduling, so the poll is cancelled here instead.
+    poll_canceller();
+    return SuccessExecutionResult();
+  }
+  poll_canceller_ = std::move(poll_canceller);
+  return SuccessExecutionResult();
+}
+}  // namespace google::scp::core::os
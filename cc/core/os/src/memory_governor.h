@@ -0,0 +1,141 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "core/interface/async_executor_interface.h"
+#include "core/interface/service_interface.h"
+#include "core/os/src/system_resource_info_provider.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core::os {
+
+/// @brief The options of the memory governor.
+struct MemoryGovernorOptions {
+  /// @brief The available memory the governor steers the host to. Above it,
+  /// the caches are progressively restored to their configured sizes.
+  uint64_t target_available_memory_kb = 1024 * 1024;
+  /// @brief The available memory below which load is shed, until the
+  /// available memory is back to the target.
+  uint64_t shed_load_available_memory_kb = 256 * 1024;
+  /// @brief The interval between two reads of the available memory.
+  std::chrono::milliseconds poll_interval = std::chrono::seconds(1);
+  /// @brief The step size of each adjustment of the resource scale.
+  double learning_rate = 0.5;
+  /// @brief The resource scale is never brought below this value.
+  double min_resource_scale = 0.1;
+};
+
+/**
+ * @brief Periodically reads the available memory of the host and sizes the
+ * registered caches, e.g. AutoExpiryConcurrentMap capacities and entry
+ * lifetimes, through a resource scale in [min_resource_scale, 1].
+ *
+ * Each poll takes a gradient step minimizing the squared relative distance of
+ * the available memory to its target: the scale moves by learning_rate times
+ * (available - target) / target, so the caches shrink quickly as the host
+ * nears the target and grow back as memory frees up. If the available memory
+ * still falls below shed_load_available_memory_kb, ShouldShedLoad returns true
+ * so that new work is refused before the OOM killer steps in.
+ */
+class MemoryGovernor : public ServiceInterface {
+ public:
+  /// @brief Applies a new resource scale to a cache.
+  using ResourceScaleCallback = std::function<void(double resource_scale)>;
+
+  /**
+   * @param system_resource_info_provider The provider of the available memory.
+   * @param async_executor The executor to schedule the polls on.
+   * @param options The options of the governor.
+   */
+  MemoryGovernor(
+      std::shared_ptr<linux::SystemResourceInfoProvider>
+          system_resource_info_provider,
+      std::shared_ptr<AsyncExecutorInterface> async_executor,
+      MemoryGovernorOptions options = MemoryGovernorOptions());
+
+  ExecutionResult Init() noexcept override;
+
+  ExecutionResult Run() noexcept override;
+
+  ExecutionResult Stop() noexcept override;
+
+  /**
+   * @brief Registers a cache to be sized by the governor. The callback is
+   * called with the current resource scale right away, and then on every
+   * change of the scale, on the polling thread.
+   *
+   * @param callback Applies the resource scale to the cache.
+   * @return size_t The id to unregister the cache with.
+   */
+  size_t RegisterTarget(ResourceScaleCallback callback) noexcept;
+
+  /// @brief Unregisters the cache registered with the given id.
+  void UnregisterTarget(size_t target_id) noexcept;
+
+  /// @brief Returns the current resource scale.
+  double GetResourceScale() noexcept { return resource_scale_.load(); }
+
+  /// @brief Returns whether new work should be refused to relieve memory.
+  bool ShouldShedLoad() noexcept { return should_shed_load_.load(); }
+
+ protected:
+  /// @brief Reads the available memory and adjusts the resource scale.
+  void Poll() noexcept;
+
+  /// @brief Schedules the next poll after the poll interval.
+  ExecutionResult SchedulePoll() noexcept;
+
+  /// @brief The provider of the available memory.
+  std::shared_ptr<linux::SystemResourceInfoProvider>
+      system_resource_info_provider_;
+
+  /// @brief The executor to schedule the polls on.
+  std::shared_ptr<AsyncExecutorInterface> async_executor_;
+
+  /// @brief The options of the governor.
+  const MemoryGovernorOptions options_;
+
+  /// @brief The current resource scale.
+  std::atomic<double> resource_scale_;
+
+  /// @brief Whether new work should be refused.
+  std::atomic<bool> should_shed_load_;
+
+  /// @brief Protects the members below.
+  std::mutex mutex_;
+
+  /// @brief Whether the polls are scheduled, protected by mutex_
+  bool is_running_;
+
+  /// @brief Cancels the scheduled poll, protected by mutex_
+  std::function<bool()> poll_canceller_;
+
+  /// @brief The registered caches by id, protected by mutex_
+  std::map<size_t, ResourceScaleCallback> targets_;
+
+  /// @brief The id of the next registered cache, protected by mutex_
+  size_t next_target_id_;
+};
+}  // namespace google::scp::core::os
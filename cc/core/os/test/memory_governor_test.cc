@@ -0,0 +1,178 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/os/src/memory_governor.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/async_executor/mock/mock_async_executor.h"
+#include "core/os/src/error_codes.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncOperation;
+using google::scp::core::ExecutionResultOr;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::Timestamp;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::errors::SC_MEMORY_GOVERNOR_INVALID_OPTIONS;
+using google::scp::core::os::linux::SystemResourceInfoProvider;
+using google::scp::core::test::ResultIs;
+using std::function;
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+namespace google::scp::core::os::test {
+class FakeSystemResourceInfoProvider : public SystemResourceInfoProvider {
+ public:
+  ExecutionResultOr<uint64_t> GetAvailableMemoryKb() noexcept override {
+    if (fail) {
+      return FailureExecutionResult(SC_UNKNOWN);
+    }
+    return available_memory_kb;
+  }
+
+  uint64_t available_memory_kb = 0;
+  bool fail = false;
+};
+
+class MemoryGovernorTest : public ::testing::Test {
+ protected:
+  MemoryGovernorTest()
+      : provider_(make_shared<FakeSystemResourceInfoProvider>()),
+        executor_(make_shared<MockAsyncExecutor>()) {
+    executor_->schedule_for_mock = [this](const AsyncOperation& work,
+                                          Timestamp, function<bool()>&
+                                                         canceller) {
+      scheduled_polls_.push_back(work);
+      canceller = [this]() {
+        cancelled_ = true;
+        return true;
+      };
+      return SuccessExecutionResult();
+    };
+    options_.target_available_memory_kb = 1000;
+    options_.shed_load_available_memory_kb = 200;
+    options_.learning_rate = 0.5;
+    options_.min_resource_scale = 0.1;
+  }
+
+  /// Runs the last scheduled poll with the given available memory.
+  void PollWith(uint64_t available_memory_kb) {
+    provider_->available_memory_kb = available_memory_kb;
+    ASSERT_FALSE(scheduled_polls_.empty());
+    auto poll = scheduled_polls_.back();
+    poll();
+  }
+
+  shared_ptr<FakeSystemResourceInfoProvider> provider_;
+  shared_ptr<MockAsyncExecutor> executor_;
+  MemoryGovernorOptions options_;
+  vector<AsyncOperation> scheduled_polls_;
+  bool cancelled_ = false;
+};
+
+TEST_F(MemoryGovernorTest, InitRejectsInvalidOptions) {
+  options_.shed_load_available_memory_kb = 2000;
+  MemoryGovernor governor(provider_, executor_, options_);
+  EXPECT_THAT(governor.Init(), ResultIs(FailureExecutionResult(
+                                   SC_MEMORY_GOVERNOR_INVALID_OPTIONS)));
+}
+
+TEST_F(MemoryGovernorTest, ScalesTargetsWithAvailableMemory) {
+  MemoryGovernor governor(provider_, executor_, options_);
+  vector<double> scales;
+  governor.RegisterTarget([&scales](double scale) { scales.push_back(scale); });
+  EXPECT_EQ(scales, vector<double>({1.0}));
+
+  provider_->available_memory_kb = 1000;
+  EXPECT_SUCCESS(governor.Init());
+  EXPECT_SUCCESS(governor.Run());
+  // At the target, nothing changes.
+  EXPECT_EQ(scales.size(), 1);
+  EXPECT_EQ(scheduled_polls_.size(), 1);
+
+  // Half of the target available, the scale goes down by a quarter.
+  PollWith(500);
+  EXPECT_EQ(scales, vector<double>({1.0, 0.75}));
+  EXPECT_DOUBLE_EQ(governor.GetResourceScale(), 0.75);
+
+  // Memory freed up, the scale goes back up, up to 1.
+  PollWith(2000);
+  EXPECT_EQ(scales, vector<double>({1.0, 0.75, 1.0}));
+  EXPECT_EQ(scheduled_polls_.size(), 3);
+}
+
+TEST_F(MemoryGovernorTest, ScaleIsBoundedByMinResourceScale) {
+  MemoryGovernor governor(provider_, executor_, options_);
+  EXPECT_SUCCESS(governor.Init());
+  EXPECT_SUCCESS(governor.Run());
+  EXPECT_DOUBLE_EQ(governor.GetResourceScale(), 0.5);
+
+  PollWith(0);
+  EXPECT_DOUBLE_EQ(governor.GetResourceScale(), 0.1);
+}
+
+TEST_F(MemoryGovernorTest, ShedsLoadUntilBackToTarget) {
+  provider_->available_memory_kb = 1000;
+  MemoryGovernor governor(provider_, executor_, options_);
+  EXPECT_SUCCESS(governor.Init());
+  EXPECT_SUCCESS(governor.Run());
+  EXPECT_FALSE(governor.ShouldShedLoad());
+
+  PollWith(100);
+  EXPECT_TRUE(governor.ShouldShedLoad());
+  PollWith(500);
+  EXPECT_TRUE(governor.ShouldShedLoad());
+  PollWith(1000);
+  EXPECT_FALSE(governor.ShouldShedLoad());
+}
+
+TEST_F(MemoryGovernorTest, FailedReadKeepsScaleAndPolling) {
+  provider_->available_memory_kb = 500;
+  MemoryGovernor governor(provider_, executor_, options_);
+  EXPECT_SUCCESS(governor.Init());
+  EXPECT_SUCCESS(governor.Run());
+  EXPECT_DOUBLE_EQ(governor.GetResourceScale(), 0.75);
+
+  provider_->fail = true;
+  scheduled_polls_.back()();
+  EXPECT_DOUBLE_EQ(governor.GetResourceScale(), 0.75);
+  EXPECT_EQ(scheduled_polls_.size(), 2);
+}
+
+TEST_F(MemoryGovernorTest, UnregisteredTargetsAndStoppedGovernorAreIdle) {
+  provider_->available_memory_kb = 1000;
+  MemoryGovernor governor(provider_, executor_, options_);
+  int calls = 0;
+  auto target_id = governor.RegisterTarget([&calls](double) { calls++; });
+  EXPECT_SUCCESS(governor.Init());
+  EXPECT_SUCCESS(governor.Run());
+
+  governor.UnregisterTarget(target_id);
+  PollWith(500);
+  EXPECT_EQ(calls, 1);
+
+  EXPECT_SUCCESS(governor.Stop());
+  EXPECT_TRUE(cancelled_);
+  auto scheduled_poll_count = scheduled_polls_.size();
+  PollWith(500);
+  EXPECT_EQ(scheduled_polls_.size(), scheduled_poll_count);
+}
+}  // namespace google::scp::core::os::test
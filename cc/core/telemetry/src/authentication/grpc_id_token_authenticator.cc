@@ -14,12 +14,16 @@
 
 #include "grpc_id_token_authenticator.h"
 
+#include <algorithm>
+#include <chrono>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "core/telemetry/src/authentication/gcp_token_fetcher.h"
 
 namespace google::scp::core {
@@ -29,6 +33,10 @@ namespace google::scp::core {
 // https://cloud.google.com/docs/authentication/token-types#id-lifetime
 inline constexpr std::int32_t kIdTokenValidity = 3000;
 
+// The delay before the background refresh retries a failed token fetch.
+inline constexpr std::chrono::seconds kIdTokenRefreshRetryDelay =
+    std::chrono::seconds(30);
+
 /**
  * @brief Periodically refreshes authentication tokens for gRPC metadata.
  *
@@ -46,50 +54,123 @@ GrpcIdTokenAuthenticator::GrpcIdTokenAuthenticator(
       token_fetcher_(std::move(token_fetcher)),
       expiry_time_(std::chrono::system_clock::now()) {}
 
+GrpcIdTokenAuthenticator::~GrpcIdTokenAuthenticator() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  if (refresh_thread_.joinable()) {
+    refresh_thread_.join();
+  }
+}
+
+void GrpcIdTokenAuthenticator::StartBackgroundRefresh(
+    std::chrono::seconds refresh_ahead) {
+  if (!token_fetcher_ || refresh_thread_.joinable()) {
+    return;
+  }
+  refresh_thread_ = std::thread(&GrpcIdTokenAuthenticator::BackgroundRefresh,
+                                this, refresh_ahead);
+}
+
 grpc::Status GrpcIdTokenAuthenticator::GetMetadata(
     grpc::string_ref service_url, grpc::string_ref method_name,
     const grpc::AuthContext& channel_auth_context,
     std::multimap<grpc::string, grpc::string>* metadata) {
-  // handling token expiry
+  {
+    absl::MutexLock lock(&mutex_);
+    if (std::chrono::system_clock::now() < expiry_time_) {
+      metadata->emplace("authorization", authorization_header_);
+      return grpc::Status::OK;
+    }
+  }
+
+  // handling token expiry, once for all the calls finding it expired.
+  absl::MutexLock fetch_lock(&fetch_mutex_);
   if (IsExpired()) {
-    ExecutionResultOr<std::string> token =
-        token_fetcher_->FetchIdToken(*auth_config_);
-    if (!token.Successful()) {
-      return grpc::Status(grpc::StatusCode::UNKNOWN,
-                          "token_fetcher_->FetchIdToken() failed");
+    grpc::Status status = RefreshToken();
+    if (!status.ok()) {
+      return status;
     }
-    id_token_ = *token;
-    expiry_time_ = std::chrono::system_clock::now() +
-                   std::chrono::seconds(kIdTokenValidity);
   }
+  absl::MutexLock lock(&mutex_);
+  metadata->emplace("authorization", authorization_header_);
+  return grpc::Status::OK;
+}
 
-  metadata->insert(std::make_pair("authorization", "Bearer " + id_token_));
+grpc::Status GrpcIdTokenAuthenticator::RefreshToken() {
+  ExecutionResultOr<std::string> token =
+      token_fetcher_->FetchIdToken(*auth_config_);
+  if (!token.Successful()) {
+    return grpc::Status(grpc::StatusCode::UNKNOWN,
+                        "token_fetcher_->FetchIdToken() failed");
+  }
+  absl::MutexLock lock(&mutex_);
+  id_token_ = std::move(*token);
+  authorization_header_ = absl::StrCat("Bearer ", id_token_);
+  expiry_time_ = std::chrono::system_clock::now() +
+                 std::chrono::seconds(kIdTokenValidity);
   return grpc::Status::OK;
 }
 
+void GrpcIdTokenAuthenticator::BackgroundRefresh(
+    std::chrono::seconds refresh_ahead) {
+  std::chrono::system_clock::time_point next_refresh_time;
+  {
+    absl::MutexLock lock(&mutex_);
+    next_refresh_time = expiry_time_ - refresh_ahead;
+  }
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      auto wait = std::max(next_refresh_time - std::chrono::system_clock::now(),
+                           std::chrono::system_clock::duration::zero());
+      if (mutex_.AwaitWithTimeout(absl::Condition(&stopping_),
+                                  absl::FromChrono(wait))) {
+        return;
+      }
+    }
+
+    absl::MutexLock fetch_lock(&fetch_mutex_);
+    if (RefreshToken().ok()) {
+      absl::MutexLock lock(&mutex_);
+      next_refresh_time = expiry_time_ - refresh_ahead;
+    } else {
+      next_refresh_time =
+          std::chrono::system_clock::now() + kIdTokenRefreshRetryDelay;
+    }
+  }
+}
+
 GrpcAuthConfig* GrpcIdTokenAuthenticator::auth_config() const {
   return auth_config_.get();
 }
 
 void GrpcIdTokenAuthenticator::set_id_token(absl::string_view token) {
+  absl::MutexLock lock(&mutex_);
   id_token_ = token;
+  authorization_header_ = absl::StrCat("Bearer ", id_token_);
 }
 
-const std::string& GrpcIdTokenAuthenticator::id_token() const {
+std::string GrpcIdTokenAuthenticator::id_token() const {
+  absl::MutexLock lock(&mutex_);
   return id_token_;
 }
 
 void GrpcIdTokenAuthenticator::set_expiry_time_for_testing(
     const std::chrono::system_clock::time_point& expiry_time) {
+  absl::MutexLock lock(&mutex_);
   expiry_time_ = expiry_time;
 }
 
-const std::chrono::system_clock::time_point&
-GrpcIdTokenAuthenticator::expiry_time() const {
+std::chrono::system_clock::time_point GrpcIdTokenAuthenticator::expiry_time()
+    const {
+  absl::MutexLock lock(&mutex_);
   return expiry_time_;
 }
 
 bool GrpcIdTokenAuthenticator::IsExpired() const {
+  absl::MutexLock lock(&mutex_);
   return std::chrono::system_clock::now() >= expiry_time_;
 }
 }  // namespace google::scp::core
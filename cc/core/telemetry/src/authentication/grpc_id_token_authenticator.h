@@ -18,7 +18,9 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 
+#include "absl/synchronization/mutex.h"
 #include "cc/core/telemetry/src/authentication/grpc_auth_config.h"
 #include "core/telemetry/src/authentication/token_fetcher.h"
 #include "grpcpp/security/credentials.h"
@@ -35,6 +37,10 @@ namespace google::scp::core {
  * and grpc auth config and will be managing the id token for a particular
  * exporter.
  *
+ * The authorization header is cached with the token. Once the background
+ * refresh is started, the token is refreshed ahead of its expiry by a
+ * background thread, so that the calls never wait for a token fetch.
+ *
  * @note
  * https://grpc.io/docs/guides/auth/#extending-grpc-to-support-other-authentication-mechanisms
  */
@@ -46,6 +52,16 @@ class GrpcIdTokenAuthenticator : public grpc::MetadataCredentialsPlugin {
       std::unique_ptr<GrpcAuthConfig> auth_config,
       std::unique_ptr<TokenFetcher> token_fetcher);
 
+  ~GrpcIdTokenAuthenticator() override;
+
+  /**
+   * @brief Starts refreshing the token in the background, refresh_ahead before
+   * it expires. The token is still fetched by the calls that find it expired,
+   * e.g. while the token fetches fail.
+   */
+  void StartBackgroundRefresh(
+      std::chrono::seconds refresh_ahead = std::chrono::minutes(5));
+
   grpc::Status GetMetadata(
       grpc::string_ref service_url, grpc::string_ref method_name,
       const grpc::AuthContext& channel_auth_context,
@@ -56,20 +72,36 @@ class GrpcIdTokenAuthenticator : public grpc::MetadataCredentialsPlugin {
   // Expiry time of the ID token (for testing purposes)
   void set_expiry_time_for_testing(
       const std::chrono::system_clock::time_point& expiry_time);
-  const std::chrono::system_clock::time_point& expiry_time() const;
+  std::chrono::system_clock::time_point expiry_time() const;
 
   // Checks if the token has expired based on the given duration
   bool IsExpired() const;
 
-  const std::string& id_token() const;
+  std::string id_token() const;
 
   // For testing or storing a generated ID token
   void set_id_token(absl::string_view token);
 
  private:
+  /// Fetches a token and caches it. Must not be called with mutex_ held.
+  grpc::Status RefreshToken();
+
+  /// Refreshes the token ahead of its expiry until stopped.
+  void BackgroundRefresh(std::chrono::seconds refresh_ahead);
+
   std::unique_ptr<GrpcAuthConfig> auth_config_;
   std::unique_ptr<TokenFetcher> token_fetcher_;
-  std::string id_token_;
-  std::chrono::system_clock::time_point expiry_time_;
+  /// Guards the token, its header and its expiry, and stopping_.
+  mutable absl::Mutex mutex_;
+  std::string id_token_ ABSL_GUARDED_BY(mutex_);
+  /// The authorization header of id_token_.
+  std::string authorization_header_ ABSL_GUARDED_BY(mutex_);
+  std::chrono::system_clock::time_point expiry_time_ ABSL_GUARDED_BY(mutex_);
+  /// Whether the background refresh is stopping.
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+  /// Serializes the token fetches.
+  absl::Mutex fetch_mutex_;
+  /// The background refresh thread, if started.
+  std::thread refresh_thread_;
 };
 }  // namespace google::scp::core
@@ -38,6 +38,12 @@ inline constexpr absl::string_view kOtelExporterOtlpEndpointKey =
 inline constexpr absl::string_view kOtelExporterOtlpEndpointValue =
     "127.0.0.1:4317";
 
+// Compression of the OTLP exports, "gzip" or "none"
+// Defaults to gzip
+inline constexpr absl::string_view kOtelExporterOtlpCompressionKey =
+    "google_scp_otel_exporter_otlp_compression";
+inline constexpr absl::string_view kOtelExporterOtlpCompressionValue = "gzip";
+
 // Config to check if we can use otel for metric collection
 inline constexpr absl::string_view kUseOtelForMetricCollectionKey =
     "google_scp_use_otel_for_metric_collection";
@@ -55,6 +61,20 @@ inline constexpr absl::string_view kOtelMetricExportTimeoutMsecKey =
     "google_scp_otel_metric_export_timeout_msec";
 inline constexpr int32_t kOtelMetricExportTimeoutMsecValue = 20000;
 
+// Max number of metric exports queued for the sender thread of the exporter.
+// Once reached, the oldest export is dropped. 0 exports on the metric reader
+// thread.
+// Defaults to 8
+inline constexpr absl::string_view kOtelMetricExportQueueSizeKey =
+    "google_scp_otel_metric_export_queue_size";
+inline constexpr size_t kOtelMetricExportQueueSizeValue = 8;
+
+// Max number of attempts to send a queued metric export
+// Defaults to 3
+inline constexpr absl::string_view kOtelMetricExportMaxAttemptsKey =
+    "google_scp_otel_metric_export_max_attempts";
+inline constexpr size_t kOtelMetricExportMaxAttemptsValue = 3;
+
 // Service Account
 inline constexpr absl::string_view kOtelServiceAccountKey =
     "google_scp_otel_service_account";
@@ -85,6 +85,50 @@ MetricRouter::CreatePeriodicReader(
       std::move(exporter), reader_options);
 }
 
+MetricAttributes::MetricAttributes(
+    std::initializer_list<Attribute> attributes) {
+  // Reserve first, so that the views into strings_ stay valid.
+  size_t num_strings = 0;
+  for (const auto& [key, value] : attributes) {
+    num_strings += 1;
+    if (opentelemetry::nostd::holds_alternative<const char*>(value) ||
+        opentelemetry::nostd::holds_alternative<
+            opentelemetry::nostd::string_view>(value)) {
+      num_strings += 1;
+    }
+  }
+  strings_.reserve(num_strings);
+  attributes_.reserve(attributes.size());
+  for (const auto& [key, value] : attributes) {
+    const std::string& owned_key = strings_.emplace_back(key);
+    opentelemetry::common::AttributeValue owned_value = value;
+    if (opentelemetry::nostd::holds_alternative<const char*>(value)) {
+      owned_value = opentelemetry::nostd::string_view(strings_.emplace_back(
+          opentelemetry::nostd::get<const char*>(value)));
+    } else if (opentelemetry::nostd::holds_alternative<
+                   opentelemetry::nostd::string_view>(value)) {
+      auto view =
+          opentelemetry::nostd::get<opentelemetry::nostd::string_view>(value);
+      owned_value = opentelemetry::nostd::string_view(
+          strings_.emplace_back(view.data(), view.size()));
+    }
+    attributes_.emplace_back(owned_key, owned_value);
+  }
+}
+
+bool MetricAttributes::ForEachKeyValue(
+    opentelemetry::nostd::function_ref<
+        bool(opentelemetry::nostd::string_view,
+             opentelemetry::common::AttributeValue)>
+        callback) const noexcept {
+  for (const auto& [key, value] : attributes_) {
+    if (!callback(key, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::shared_ptr<opentelemetry::metrics::Meter> MetricRouter::GetOrCreateMeter(
     absl::string_view service_name, absl::string_view version,
     absl::string_view schema_url) {
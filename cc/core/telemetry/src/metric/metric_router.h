@@ -14,8 +14,10 @@
 
 #pragma once
 
+#include <initializer_list>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
@@ -23,6 +25,8 @@
 #include "core/common/global_logger/src/global_logger.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/telemetry/src/metric/error_codes.h"
+#include "opentelemetry/common/attribute_value.h"
+#include "opentelemetry/common/key_value_iterable.h"
 #include "opentelemetry/metrics/async_instruments.h"
 #include "opentelemetry/metrics/meter.h"
 #include "opentelemetry/metrics/meter_provider.h"
@@ -39,6 +43,37 @@
  */
 namespace google::scp::core {
 
+/**
+ * @brief A set of attributes bound once, e.g. at MetricInit, and passed as is
+ * each time a point is recorded, so that recording needs no allocation.
+ * String values are copied; array values must outlive the set.
+ */
+class MetricAttributes : public opentelemetry::common::KeyValueIterable {
+ public:
+  using Attribute =
+      std::pair<absl::string_view, opentelemetry::common::AttributeValue>;
+
+  MetricAttributes(std::initializer_list<Attribute> attributes);
+
+  // The attributes point into the owned strings.
+  MetricAttributes(const MetricAttributes&) = delete;
+  MetricAttributes& operator=(const MetricAttributes&) = delete;
+
+  bool ForEachKeyValue(
+      opentelemetry::nostd::function_ref<
+          bool(opentelemetry::nostd::string_view,
+               opentelemetry::common::AttributeValue)>
+          callback) const noexcept override;
+
+  size_t size() const noexcept override { return attributes_.size(); }
+
+ private:
+  std::vector<std::string> strings_;
+  std::vector<std::pair<opentelemetry::nostd::string_view,
+                        opentelemetry::common::AttributeValue>>
+      attributes_;
+};
+
 class MetricRouter {
  public:
   enum class InstrumentType {
@@ -66,6 +101,20 @@ class MetricRouter {
           std::shared_ptr<opentelemetry::metrics::SynchronousInstrument>()>
           instrument_factory);
 
+  // Same as above, but returns the handle of the concrete instrument type,
+  // e.g. opentelemetry::metrics::Counter<uint64_t>, or nullptr if the
+  // instrument cached under metric_name is of another type. Meant to be
+  // resolved once, e.g. at MetricInit, and kept for recording.
+  template <typename Instrument>
+  std::shared_ptr<Instrument> GetOrCreateSyncInstrument(
+      absl::string_view metric_name,
+      absl::AnyInvocable<
+          std::shared_ptr<opentelemetry::metrics::SynchronousInstrument>()>
+          instrument_factory) {
+    return std::dynamic_pointer_cast<Instrument>(
+        GetOrCreateSyncInstrument(metric_name, std::move(instrument_factory)));
+  }
+
   std::shared_ptr<opentelemetry::metrics::ObservableInstrument>
   GetOrCreateObservableInstrument(
       absl::string_view metric_name,
@@ -20,6 +20,8 @@
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "core/common/global_logger/src/global_logger.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/telemetry/src/authentication/gcp_token_fetcher.h"
@@ -32,12 +34,31 @@ namespace google::scp::core {
 inline constexpr absl::string_view kOtlpGrpcAuthedExporter =
     "OtlpGrpcAuthedExporter";
 
+namespace {
+/// Whether an export that failed with the status can be retried.
+bool IsRetryable(const grpc::Status& status) {
+  switch (status.error_code()) {
+    case grpc::StatusCode::CANCELLED:
+    case grpc::StatusCode::DEADLINE_EXCEEDED:
+    case grpc::StatusCode::RESOURCE_EXHAUSTED:
+    case grpc::StatusCode::ABORTED:
+    case grpc::StatusCode::OUT_OF_RANGE:
+    case grpc::StatusCode::UNAVAILABLE:
+    case grpc::StatusCode::DATA_LOSS:
+      return true;
+    default:
+      return false;
+  }
+}
+}  // namespace
+
 /**
  * Creates a gRPC channel using the provided OTLP gRPC client options and a
  * configuration provider.
  *
  * Strips the scheme from the endpoint and sets up channel credentials based on
- * the provided configuration. Returns nullptr if the endpoint is invalid or if
+ * the provided configuration. Compresses the requests if the compression of the
+ * options is "gzip". Returns nullptr if the endpoint is invalid or if
  * there are issues creating the channel.
  */
 ExecutionResultOr<std::shared_ptr<grpc::Channel>>
@@ -62,6 +83,9 @@ OtlpGrpcAuthedMetricExporter::MakeChannel(
       absl::StrCat(url.host_, ":", static_cast<int>(url.port_));
   grpc::ChannelArguments grpc_arguments;
   grpc_arguments.SetUserAgentPrefix(options.user_agent);
+  if (options.compression == "gzip") {
+    grpc_arguments.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
+  }
 
   std::shared_ptr<grpc::ChannelCredentials> channel_credentials =
       grpc::InsecureChannelCredentials();
@@ -69,6 +93,9 @@ OtlpGrpcAuthedMetricExporter::MakeChannel(
   if (grpc_id_token_authenticator &&
       grpc_id_token_authenticator->auth_config() &&
       grpc_id_token_authenticator->auth_config()->IsValid()) {
+    // Refreshes the ID token before it expires, so that the exports do not
+    // wait for the token fetch.
+    grpc_id_token_authenticator->StartBackgroundRefresh();
     auto call_creds = grpc::MetadataCredentialsFromPlugin(
         std::unique_ptr<grpc::MetadataCredentialsPlugin>(
             std::move(grpc_id_token_authenticator)));
@@ -113,12 +140,14 @@ OtlpGrpcAuthedMetricExporter::MakeMetricsServiceStub(
 
 OtlpGrpcAuthedMetricExporter::OtlpGrpcAuthedMetricExporter(
     const opentelemetry::exporter::otlp::OtlpGrpcMetricExporterOptions& options,
-    std::unique_ptr<GrpcIdTokenAuthenticator> grpc_id_token_authenticator)
+    std::unique_ptr<GrpcIdTokenAuthenticator> grpc_id_token_authenticator,
+    OtlpGrpcAuthedMetricExportQueueOptions queue_options)
     : options_(options),
       aggregation_temporality_selector_{
           opentelemetry::exporter::otlp::OtlpMetricUtils::
               ChooseTemporalitySelector(options_.aggregation_temporality)},
-      is_shutdown_(false) {
+      is_shutdown_(false),
+      queue_options_(std::move(queue_options)) {
   auto metrics_service_stub =
       MakeMetricsServiceStub(options_, std::move(grpc_id_token_authenticator));
   if (metrics_service_stub.Successful()) {
@@ -126,6 +155,20 @@ OtlpGrpcAuthedMetricExporter::OtlpGrpcAuthedMetricExporter(
   } else {
     metrics_service_stub_ = nullptr;
   }
+  if (metrics_service_stub_ != nullptr &&
+      queue_options_.max_queued_exports > 0) {
+    sender_thread_ = std::thread([this] { SendQueuedRequests(); });
+  }
+}
+
+OtlpGrpcAuthedMetricExporter::~OtlpGrpcAuthedMetricExporter() {
+  {
+    absl::MutexLock lock(&queue_mutex_);
+    is_sender_stopping_ = true;
+  }
+  if (sender_thread_.joinable()) {
+    sender_thread_.join();
+  }
 }
 
 opentelemetry::sdk::metrics::AggregationTemporality
@@ -158,12 +201,6 @@ opentelemetry::sdk::common::ExportResult OtlpGrpcAuthedMetricExporter::Export(
   opentelemetry::exporter::otlp::OtlpMetricUtils::PopulateRequest(data,
                                                                   &request);
 
-  auto context =
-      opentelemetry::exporter::otlp::OtlpGrpcClient::MakeClientContext(
-          options_);
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse
-      response;
-
   if (metrics_service_stub_ == nullptr) {
     auto execution_result = FailureExecutionResult(SC_TELEMETRY_EXPORT_FAILED);
     SCP_ERROR(kOtlpGrpcAuthedExporter, google::scp::core::common::kZeroUuid,
@@ -174,6 +211,69 @@ opentelemetry::sdk::common::ExportResult OtlpGrpcAuthedMetricExporter::Export(
     return opentelemetry::sdk::common::ExportResult::kFailure;
   }
 
+  if (sender_thread_.joinable()) {
+    absl::MutexLock lock(&queue_mutex_);
+    if (queued_requests_.size() >= queue_options_.max_queued_exports) {
+      queued_requests_.pop_front();
+      ++dropped_export_count_;
+      SCP_WARNING(kOtlpGrpcAuthedExporter,
+                  google::scp::core::common::kZeroUuid,
+                  "[OTLP METRIC GRPC Exporter] The export queue is full, "
+                  "dropped the oldest export. %zu exports dropped so far.",
+                  dropped_export_count_);
+    }
+    queued_requests_.push_back(std::move(request));
+    return opentelemetry::sdk::common::ExportResult::kSuccess;
+  }
+
+  grpc::Status status = SendOnce(std::move(request));
+  if (!status.ok()) {
+    auto execution_result = FailureExecutionResult(SC_TELEMETRY_EXPORT_FAILED);
+    SCP_ERROR(kOtlpGrpcAuthedExporter, google::scp::core::common::kZeroUuid,
+              execution_result,
+              "[OTLP METRIC GRPC Exporter] Export() failed: %s",
+              status.error_message().c_str());
+
+    return opentelemetry::sdk::common::ExportResult::kFailure;
+  }
+  return opentelemetry::sdk::common::ExportResult::kSuccess;
+}
+
+grpc::Status OtlpGrpcAuthedMetricExporter::Send(
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest
+        request) noexcept {
+  grpc::Status status;
+  size_t attempt = 1;
+  while (true) {
+    bool is_last_attempt = attempt >= queue_options_.max_export_attempts;
+    // DelegateExport consumes the request, so only the last attempt moves it.
+    if (is_last_attempt) {
+      status = SendOnce(std::move(request));
+    } else {
+      status = SendOnce(request);
+    }
+    if (status.ok() || is_last_attempt || !IsRetryable(status)) {
+      return status;
+    }
+    absl::MutexLock lock(&queue_mutex_);
+    if (queue_mutex_.AwaitWithTimeout(
+            absl::Condition(&is_sender_stopping_),
+            absl::FromChrono(queue_options_.retry_delay))) {
+      return status;
+    }
+    ++attempt;
+  }
+}
+
+grpc::Status OtlpGrpcAuthedMetricExporter::SendOnce(
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest
+        request) noexcept {
+  auto context =
+      opentelemetry::exporter::otlp::OtlpGrpcClient::MakeClientContext(
+          options_);
+  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse
+      response;
+
   google::protobuf::ArenaOptions arena_options;
   // It's easy to allocate data blocks larger than 1024 when we populate them
   // with basic kresource and attributes.
@@ -184,35 +284,76 @@ opentelemetry::sdk::common::ExportResult OtlpGrpcAuthedMetricExporter::Export(
   std::unique_ptr<google::protobuf::Arena> arena =
       std::make_unique<google::protobuf::Arena>(arena_options);
 
-  grpc::Status status =
-      opentelemetry::exporter::otlp::OtlpGrpcClient::DelegateExport(
-          metrics_service_stub_.get(), std::move(context), std::move(arena),
-          std::move(request), &response);
+  return opentelemetry::exporter::otlp::OtlpGrpcClient::DelegateExport(
+      metrics_service_stub_.get(), std::move(context), std::move(arena),
+      std::move(request), &response);
+}
+
+void OtlpGrpcAuthedMetricExporter::SendQueuedRequests() noexcept {
+  while (true) {
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest
+        request;
+    {
+      absl::MutexLock lock(&queue_mutex_);
+      queue_mutex_.Await(absl::Condition(
+          +[](OtlpGrpcAuthedMetricExporter* exporter) {
+            return exporter->is_sender_stopping_ ||
+                   !exporter->queued_requests_.empty();
+          },
+          this));
+      if (is_sender_stopping_) {
+        return;
+      }
+      request = std::move(queued_requests_.front());
+      queued_requests_.pop_front();
+      is_sending_ = true;
+    }
 
-  if (!status.ok()) {
-    auto execution_result = FailureExecutionResult(SC_TELEMETRY_EXPORT_FAILED);
-    SCP_ERROR(kOtlpGrpcAuthedExporter, google::scp::core::common::kZeroUuid,
-              execution_result,
-              "[OTLP METRIC GRPC Exporter] Export() failed: %s",
-              status.error_message().c_str());
+    grpc::Status status = Send(std::move(request));
+    if (!status.ok()) {
+      auto execution_result =
+          FailureExecutionResult(SC_TELEMETRY_EXPORT_FAILED);
+      SCP_ERROR(kOtlpGrpcAuthedExporter, google::scp::core::common::kZeroUuid,
+                execution_result,
+                "[OTLP METRIC GRPC Exporter] Export() failed: %s",
+                status.error_message().c_str());
+    }
 
-    return opentelemetry::sdk::common::ExportResult::kFailure;
+    absl::MutexLock lock(&queue_mutex_);
+    is_sending_ = false;
   }
-  return opentelemetry::sdk::common::ExportResult::kSuccess;
 }
 
-// Unimplemented, following the reference from the official docs,
-// https://github.com/open-telemetry/opentelemetry-cpp/tree/c7a88c479fba3c7ee039e426ba6085b344a8759a/exporters
 bool OtlpGrpcAuthedMetricExporter::ForceFlush(
-    std::chrono::microseconds) noexcept {
-  return true;
+    std::chrono::microseconds timeout) noexcept {
+  if (!sender_thread_.joinable()) {
+    return true;
+  }
+  absl::MutexLock lock(&queue_mutex_);
+  return queue_mutex_.AwaitWithTimeout(
+      absl::Condition(
+          +[](OtlpGrpcAuthedMetricExporter* exporter) {
+            return exporter->is_sender_stopping_ ||
+                   (exporter->queued_requests_.empty() &&
+                    !exporter->is_sending_);
+          },
+          this),
+      absl::FromChrono(timeout));
 }
 
 bool OtlpGrpcAuthedMetricExporter::Shutdown(
-    std::chrono::microseconds) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  is_shutdown_ = true;
-  return true;
+    std::chrono::microseconds timeout) noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_shutdown_ = true;
+  }
+  // The exports queued before the shutdown are still sent, within the timeout.
+  bool is_flushed = ForceFlush(timeout);
+  {
+    absl::MutexLock lock(&queue_mutex_);
+    is_sender_stopping_ = true;
+  }
+  return is_flushed;
 }
 
 bool OtlpGrpcAuthedMetricExporter::IsShutdown() const noexcept {
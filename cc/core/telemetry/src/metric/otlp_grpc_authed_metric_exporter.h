@@ -15,8 +15,11 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <thread>
 
+#include "absl/synchronization/mutex.h"
 #include "cc/core/interface/config_provider_interface.h"
 #include "cc/core/telemetry/src/authentication/grpc_auth_config.h"
 #include "cc/core/telemetry/src/authentication/grpc_id_token_authenticator.h"
@@ -31,6 +34,18 @@
 
 namespace google::scp::core {
 
+/// The options of the export queue of OtlpGrpcAuthedMetricExporter.
+struct OtlpGrpcAuthedMetricExportQueueOptions {
+  /// The max number of exports waiting to be sent. Once reached, the oldest
+  /// export is dropped. 0 sends the exports on the thread calling Export().
+  size_t max_queued_exports = 0;
+  /// The max number of attempts to send an export, if its failures are
+  /// retryable. Only the queued exports are retried.
+  size_t max_export_attempts = 3;
+  /// The delay between the attempts to send an export.
+  std::chrono::milliseconds retry_delay = std::chrono::seconds(1);
+};
+
 /**
  * The OtlpGrpcAuthedMetricExporter is largely copied from
  OtlpGrpcMetricExporter,
@@ -39,6 +54,11 @@ namespace google::scp::core {
  * Like OtlpGrpcMetricExporter, the OtlpGrpcAuthedMetricExporter exports metric
  * data in OpenTelemetry Protocol (OTLP) format in gRPC; in addition, it fetches
  * GCP ID tokens needed for authentication, and manages their expiry.
+ *
+ * The requests are gzip compressed if the compression of the options is
+ * "gzip". With an export queue, Export() only serializes the metrics and
+ * queues the request, which a sender thread sends, so that a slow collector
+ * never blocks the metric collection.
  */
 class OtlpGrpcAuthedMetricExporter
     : public opentelemetry::sdk::metrics::PushMetricExporter {
@@ -46,7 +66,10 @@ class OtlpGrpcAuthedMetricExporter
   explicit OtlpGrpcAuthedMetricExporter(
       const opentelemetry::exporter::otlp::OtlpGrpcMetricExporterOptions&
           options,
-      std::unique_ptr<GrpcIdTokenAuthenticator> grpc_id_token_authenticator);
+      std::unique_ptr<GrpcIdTokenAuthenticator> grpc_id_token_authenticator,
+      OtlpGrpcAuthedMetricExportQueueOptions queue_options = {});
+
+  ~OtlpGrpcAuthedMetricExporter() override;
 
   opentelemetry::sdk::metrics::AggregationTemporality GetAggregationTemporality(
       opentelemetry::sdk::metrics::InstrumentType instrument_type)
@@ -56,6 +79,7 @@ class OtlpGrpcAuthedMetricExporter
       const opentelemetry::sdk::metrics::ResourceMetrics& data) noexcept
       override;
 
+  /// Waits for the queued exports to be sent, if any.
   bool ForceFlush(std::chrono::microseconds timeout =
                       (std::chrono::microseconds::max)()) noexcept override;
 
@@ -68,6 +92,20 @@ class OtlpGrpcAuthedMetricExporter
  private:
   bool IsShutdown() const noexcept;
 
+  /// Sends the request, retrying the retryable failures up to the max
+  /// attempts of the export queue. Called by the sender thread.
+  grpc::Status Send(
+      opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest
+          request) noexcept;
+
+  /// Sends the request once.
+  grpc::Status SendOnce(
+      opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest
+          request) noexcept;
+
+  /// Sends the queued requests until stopped.
+  void SendQueuedRequests() noexcept;
+
   ExecutionResultOr<std::shared_ptr<grpc::Channel>> MakeChannel(
       const opentelemetry::exporter::otlp::OtlpGrpcClientOptions& options,
       std::unique_ptr<GrpcIdTokenAuthenticator> grpc_id_token_authenticator);
@@ -86,5 +124,20 @@ class OtlpGrpcAuthedMetricExporter
       metrics_service_stub_;
   bool is_shutdown_;
   mutable std::mutex mutex_;
+
+  const OtlpGrpcAuthedMetricExportQueueOptions queue_options_;
+  /// Guards the export queue.
+  absl::Mutex queue_mutex_;
+  std::deque<
+      opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest>
+      queued_requests_ ABSL_GUARDED_BY(queue_mutex_);
+  /// Whether the sender thread is sending a request.
+  bool is_sending_ ABSL_GUARDED_BY(queue_mutex_) = false;
+  /// Whether the sender thread is stopping.
+  bool is_sender_stopping_ ABSL_GUARDED_BY(queue_mutex_) = false;
+  /// The number of exports dropped from the full queue.
+  size_t dropped_export_count_ ABSL_GUARDED_BY(queue_mutex_) = 0;
+  /// The sender thread, if there is an export queue.
+  std::thread sender_thread_;
 };
 }  // namespace google::scp::core
@@ -14,7 +14,9 @@
 
 #include "core/telemetry/src/authentication/grpc_id_token_authenticator.h"
 
+#include <chrono>
 #include <memory>
+#include <thread>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -122,6 +124,30 @@ TEST_F(GrpcIdTokenAuthenticatorTest,
   testing::Mock::VerifyAndClearExpectations(token_fetcher.get());
 }
 
+TEST_F(GrpcIdTokenAuthenticatorTest,
+       StartBackgroundRefresh_RefreshesTokenAheadOfExpiry) {
+  authenticator->set_expiry_time_for_testing(std::chrono::system_clock::now() +
+                                             std::chrono::minutes(5));
+  authenticator->set_id_token("expiring_token");
+
+  // The token expires in less than the refresh ahead duration.
+  authenticator->StartBackgroundRefresh(std::chrono::minutes(10));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (authenticator->id_token() != kExpectedToken &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  FakeAuthContext channel_auth_context;
+  std::multimap<grpc::string, grpc::string> metadata;
+  grpc::Status status =
+      authenticator->GetMetadata("", "", channel_auth_context, &metadata);
+  ASSERT_TRUE(status.ok());
+  auto it = metadata.find("authorization");
+  ASSERT_NE(it, metadata.end());
+  EXPECT_EQ(it->second, "Bearer " + (std::string)kExpectedToken);
+}
+
 TEST_F(GrpcIdTokenAuthenticatorTest, IsExpired_ChecksTokenExpiryCorrectly) {
   // Set token to expire in the future
   authenticator->set_expiry_time_for_testing(std::chrono::system_clock::now() +
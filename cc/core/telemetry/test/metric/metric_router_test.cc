@@ -15,6 +15,8 @@
 #include "core/telemetry/src/metric/metric_router.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "core/config_provider/mock/mock_config_provider.h"
 #include "core/telemetry/mock/in_memory_metric_exporter.h"
@@ -445,5 +447,77 @@ TEST_F(MetricRouterTest,
                                   SC_TELEMETRY_METER_PROVIDER_NOT_INITIALIZED));
 }
 
+TEST_F(MetricRouterTest, GetOrCreateSyncInstrumentReturnsTypedHandle) {
+  auto meter = metric_router_->GetOrCreateMeter("test_service");
+
+  auto counter = metric_router_->GetOrCreateSyncInstrument<
+      opentelemetry::metrics::Counter<uint64_t>>(
+      "typed_counter",
+      [&]() -> std::shared_ptr<opentelemetry::metrics::SynchronousInstrument> {
+        return meter->CreateUInt64Counter("typed_counter");
+      });
+  ASSERT_NE(counter, nullptr);
+
+  // The cached instrument is returned with its own type, and nullptr is
+  // returned for another type.
+  EXPECT_EQ(counter,
+            metric_router_->GetOrCreateSyncInstrument(
+                "typed_counter",
+                [&]() -> std::shared_ptr<
+                          opentelemetry::metrics::SynchronousInstrument> {
+                  return nullptr;
+                }));
+  auto histogram = metric_router_->GetOrCreateSyncInstrument<
+      opentelemetry::metrics::Histogram<double>>(
+      "typed_counter",
+      [&]() -> std::shared_ptr<opentelemetry::metrics::SynchronousInstrument> {
+        return meter->CreateDoubleHistogram("typed_counter");
+      });
+  EXPECT_EQ(histogram, nullptr);
+}
+
+TEST(MetricAttributesTest, OwnsStringValues) {
+  std::string label_key = "label";
+  std::string label_value = "value";
+  MetricAttributes attributes({{label_key, label_value.c_str()},
+                               {"success", true},
+                               {"count", int64_t{2}}});
+  label_key = "other_label";
+  label_value = "other_value";
+
+  EXPECT_EQ(attributes.size(), 3);
+  std::vector<std::string> keys;
+  attributes.ForEachKeyValue(
+      [&](opentelemetry::nostd::string_view key,
+          opentelemetry::common::AttributeValue value) {
+        keys.emplace_back(key.data(), key.size());
+        if (keys.size() == 1) {
+          EXPECT_EQ(
+              opentelemetry::nostd::get<opentelemetry::nostd::string_view>(
+                  value),
+              "value");
+        } else if (keys.size() == 2) {
+          EXPECT_TRUE(opentelemetry::nostd::get<bool>(value));
+        } else {
+          EXPECT_EQ(opentelemetry::nostd::get<int64_t>(value), 2);
+        }
+        return true;
+      });
+  EXPECT_EQ(keys, (std::vector<std::string>{"label", "success", "count"}));
+}
+
+TEST(MetricAttributesTest, StopsWhenCallbackReturnsFalse) {
+  MetricAttributes attributes({{"a", true}, {"b", false}});
+
+  int calls = 0;
+  EXPECT_FALSE(attributes.ForEachKeyValue(
+      [&](opentelemetry::nostd::string_view,
+          opentelemetry::common::AttributeValue) {
+        ++calls;
+        return false;
+      }));
+  EXPECT_EQ(calls, 1);
+}
+
 }  // namespace
 }  // namespace google::scp::core::test
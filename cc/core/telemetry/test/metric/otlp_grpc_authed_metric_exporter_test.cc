@@ -14,6 +14,7 @@
 
 #include "core/telemetry/src/metric/otlp_grpc_authed_metric_exporter.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -57,13 +58,14 @@ class OtlpGrpcAuthedExporterMetricTest : public testing::Test {
   }
 
   std::unique_ptr<OtlpGrpcAuthedMetricExporter> CreateExporter(
-      const std::string& endpoint) {
+      const std::string& endpoint,
+      OtlpGrpcAuthedMetricExportQueueOptions queue_options = {}) {
     opentelemetry::exporter::otlp::OtlpGrpcMetricExporterOptions options;
     options.aggregation_temporality = opentelemetry::exporter::otlp::
         PreferredAggregationTemporality::kUnspecified;
     options.endpoint = endpoint;
     return std::make_unique<OtlpGrpcAuthedMetricExporter>(
-        options, std::move(grpc_id_token_authenticator_));
+        options, std::move(grpc_id_token_authenticator_), queue_options);
   }
 
   std::shared_ptr<config_provider::mock::MockConfigProvider>
@@ -95,5 +97,37 @@ TEST_F(OtlpGrpcAuthedExporterMetricTest, ForceFlushShouldAlwaysReturnTrue) {
       CreateExporter(std::string(kDefaultEndpoint));
   EXPECT_TRUE(exporter->ForceFlush(std::chrono::microseconds::max()));
 }
+
+TEST_F(OtlpGrpcAuthedExporterMetricTest,
+       QueuedExportShouldNotWaitForTheCollector) {
+  OtlpGrpcAuthedMetricExportQueueOptions queue_options;
+  queue_options.max_queued_exports = 1;
+  queue_options.max_export_attempts = 2;
+  queue_options.retry_delay = std::chrono::milliseconds(10);
+  // There is no collector at the endpoint.
+  std::unique_ptr<OtlpGrpcAuthedMetricExporter> exporter =
+      CreateExporter(std::string(kDefaultEndpoint), queue_options);
+
+  auto resource = opentelemetry::sdk::resource::Resource::Create({});
+  auto scope =
+      opentelemetry::sdk::instrumentationscope::InstrumentationScope::Create(
+          "test");
+  opentelemetry::sdk::metrics::ResourceMetrics data;
+  data.resource_ = &resource;
+  opentelemetry::sdk::metrics::ScopeMetrics scope_metrics;
+  scope_metrics.scope_ = scope.get();
+  data.scope_metric_data_.push_back(scope_metrics);
+
+  // The exports are queued, and the ones beyond the queue size dropped.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(exporter->Export(data),
+              opentelemetry::sdk::common::ExportResult::kSuccess);
+  }
+  // The sender thread gives up on the export after the failed attempts.
+  EXPECT_TRUE(exporter->ForceFlush(std::chrono::seconds(30)));
+  EXPECT_TRUE(exporter->Shutdown(std::chrono::seconds(30)));
+  EXPECT_EQ(exporter->Export(data),
+            opentelemetry::sdk::common::ExportResult::kFailure);
+}
 }  // namespace
 }  // namespace google::scp::core
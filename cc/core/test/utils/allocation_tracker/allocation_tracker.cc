@@ -0,0 +1,80 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "allocation_tracker.h"
+
+#include <malloc.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<int64_t> allocated_bytes{0};
+
+void* Allocate(size_t size) {
+  auto* pointer = std::malloc(size == 0 ? 1 : size);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(malloc_usable_size(pointer),
+                            std::memory_order_relaxed);
+  return pointer;
+}
+
+void Deallocate(void* pointer) noexcept {
+  if (!pointer) {
+    return;
+  }
+  allocated_bytes.fetch_sub(malloc_usable_size(pointer),
+                            std::memory_order_relaxed);
+  std::free(pointer);
+}
+}  // namespace
+
+void* operator new(size_t size) {
+  return Allocate(size);
+}
+
+void* operator new[](size_t size) {
+  return Allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  Deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  Deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  Deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  Deallocate(pointer);
+}
+
+namespace google::scp::core::test {
+uint64_t GetAllocationCount() noexcept {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+int64_t GetAllocatedBytes() noexcept {
+  return allocated_bytes.load(std::memory_order_relaxed);
+}
+}  // namespace google::scp::core::test
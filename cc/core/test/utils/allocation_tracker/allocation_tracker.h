@@ -0,0 +1,31 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+namespace google::scp::core::test {
+/**
+ * @brief Returns the number of heap allocations made through operator new by
+ * the process so far.
+ */
+uint64_t GetAllocationCount() noexcept;
+
+/**
+ * @brief Returns the bytes allocated through operator new and not yet
+ * deleted, as sized by the allocator.
+ */
+int64_t GetAllocatedBytes() noexcept;
+}  // namespace google::scp::core::test
@@ -15,7 +15,9 @@
  */
 #include "auto_refresh_token_provider.h"
 
+#include <random>
 #include <string>
+#include <vector>
 
 #include "core/interface/async_context.h"
 #include "core/interface/token_fetcher_interface.h"
@@ -26,11 +28,17 @@ using google::scp::core::FetchTokenRequest;
 using google::scp::core::FetchTokenResponse;
 using google::scp::core::common::TimeProvider;
 using std::make_shared;
+using std::mt19937;
+using std::random_device;
 using std::shared_lock;
 using std::shared_ptr;
 using std::string;
+using std::uniform_real_distribution;
 using std::unique_lock;
 using std::unique_ptr;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
 using std::chrono::seconds;
 using std::placeholders::_1;
 
@@ -38,17 +46,53 @@ static constexpr const char kAutoRefreshTokenProvider[] =
     "AutoRefreshTokenProvider";
 
 namespace google::scp::core {
+AutoRefreshTokenProviderService::AutoRefreshTokenProviderService(
+    unique_ptr<TokenFetcherInterface> token_fetcher,
+    shared_ptr<AsyncExecutorInterface> async_executor,
+    const vector<string>& audiences)
+    : token_fetcher_(std::move(token_fetcher)),
+      async_executor_(async_executor),
+      is_running_(false) {
+  // The default audience is empty.
+  cached_tokens_.emplace("", make_shared<CachedToken>(""));
+  for (const auto& audience : audiences) {
+    cached_tokens_.emplace(audience, make_shared<CachedToken>(audience));
+  }
+}
+
 ExecutionResult AutoRefreshTokenProviderService::Init() noexcept {
   RETURN_IF_FAILURE(token_fetcher_->Init());
   return SuccessExecutionResult();
 }
 
 ExecutionResult AutoRefreshTokenProviderService::Run() noexcept {
-  return RefreshToken();
+  vector<shared_ptr<CachedToken>> cached_tokens;
+  {
+    unique_lock lock(mutex_);
+    is_running_ = true;
+    for (const auto& [audience, cached_token] : cached_tokens_) {
+      cached_tokens.push_back(cached_token);
+    }
+  }
+  // The tokens are fetched in parallel.
+  for (const auto& cached_token : cached_tokens) {
+    RETURN_IF_FAILURE(RefreshToken(cached_token));
+  }
+  return SuccessExecutionResult();
 }
 
 ExecutionResult AutoRefreshTokenProviderService::Stop() noexcept {
-  if (async_task_canceller_ && !async_task_canceller_()) {
+  unique_lock lock(mutex_);
+  is_running_ = false;
+  bool is_stopped = true;
+  for (const auto& [audience, cached_token] : cached_tokens_) {
+    if (cached_token->async_task_canceller &&
+        !cached_token->async_task_canceller()) {
+      is_stopped = false;
+    }
+    cached_token->async_task_canceller = nullptr;
+  }
+  if (!is_stopped) {
     return FailureExecutionResult(
         errors::SC_AUTO_REFRESH_TOKEN_PROVIDER_FAILED_TO_STOP);
   }
@@ -57,59 +101,83 @@ ExecutionResult AutoRefreshTokenProviderService::Stop() noexcept {
 
 ExecutionResultOr<shared_ptr<Token>>
 AutoRefreshTokenProviderService::GetToken() noexcept {
+  return GetTokenForAudience("");
+}
+
+ExecutionResultOr<shared_ptr<Token>>
+AutoRefreshTokenProviderService::GetTokenForAudience(
+    const string& audience) noexcept {
+  {
+    shared_lock lock(mutex_);
+    auto cached_token_it = cached_tokens_.find(audience);
+    if (cached_token_it != cached_tokens_.end()) {
+      return GetUnexpiredToken(*cached_token_it->second);
+    }
+  }
+
+  // The token of a new audience is fetched, and kept refreshed from now on.
+  shared_ptr<CachedToken> cached_token;
+  {
+    unique_lock lock(mutex_);
+    auto [cached_token_it, is_inserted] =
+        cached_tokens_.emplace(audience, make_shared<CachedToken>(audience));
+    if (!is_inserted || !is_running_) {
+      return GetUnexpiredToken(*cached_token_it->second);
+    }
+    cached_token = cached_token_it->second;
+  }
+  auto execution_result = RefreshToken(cached_token);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
   shared_lock lock(mutex_);
-  if (!cached_token_) {
+  return GetUnexpiredToken(*cached_token);
+}
+
+ExecutionResultOr<shared_ptr<Token>>
+AutoRefreshTokenProviderService::GetUnexpiredToken(
+    const CachedToken& cached_token) {
+  if (!cached_token.token ||
+      static_cast<Timestamp>(
+          TimeProvider::GetSteadyTimestampInNanoseconds().count()) >=
+          cached_token.expiry_timestamp) {
     return FailureExecutionResult(
         errors::SC_AUTO_REFRESH_TOKEN_PROVIDER_TOKEN_NOT_AVAILABLE);
   }
-  return cached_token_;
+  return cached_token.token;
 }
 
-ExecutionResult AutoRefreshTokenProviderService::RefreshToken() {
+ExecutionResult AutoRefreshTokenProviderService::RefreshToken(
+    const shared_ptr<CachedToken>& cached_token) {
+  auto request = make_shared<FetchTokenRequest>();
+  request->audience = cached_token->audience;
   AsyncContext<FetchTokenRequest, FetchTokenResponse> get_token_context(
-      make_shared<FetchTokenRequest>(),
-      bind(&AutoRefreshTokenProviderService::OnRefreshTokenCallback, this, _1));
+      request, bind(&AutoRefreshTokenProviderService::OnRefreshTokenCallback,
+                    this, cached_token, _1));
   auto execution_result = token_fetcher_->FetchToken(get_token_context);
   if (!execution_result.Successful()) {
     SCP_CRITICAL_CONTEXT(
         kAutoRefreshTokenProvider, get_token_context, execution_result,
-        "Cannot query token, resetting cached token to empty and "
-        "rescheduling RefreshToken");
-    // Reset the cached token
-    {
-      unique_lock lock(mutex_);
-      cached_token_ = nullptr;
-    }
-    // Schedule Refresh for later
-    return async_executor_->ScheduleFor(
-        [this]() { RefreshToken(); },
-        (TimeProvider::GetSteadyTimestampInNanoseconds() +
-         std::chrono::seconds(1))
-            .count(),
-        async_task_canceller_);
+        "Cannot query token for audience '%s', rescheduling RefreshToken",
+        cached_token->audience.c_str());
+    // Schedule Refresh for later, the cached token is served until it
+    // expires.
+    return ScheduleRefreshToken(cached_token, seconds(1));
   }
   return execution_result;
 }
 
 void AutoRefreshTokenProviderService::OnRefreshTokenCallback(
+    const shared_ptr<CachedToken>& cached_token,
     AsyncContext<FetchTokenRequest, FetchTokenResponse>& get_token_context) {
   if (!get_token_context.result.Successful()) {
-    SCP_ERROR_CONTEXT(kAutoRefreshTokenProvider, get_token_context,
-                      get_token_context.result,
-                      "Cannot query token, resetting cached token to empty and "
-                      "rescheduling RefreshToken");
-    // Reset the cached token
-    {
-      unique_lock lock(mutex_);
-      cached_token_ = nullptr;
-    }
-    // Schedule Refresh for later
-    auto execution_result = async_executor_->ScheduleFor(
-        [this]() { RefreshToken(); },
-        (TimeProvider::GetSteadyTimestampInNanoseconds() +
-         std::chrono::seconds(1))
-            .count(),
-        async_task_canceller_);
+    SCP_ERROR_CONTEXT(
+        kAutoRefreshTokenProvider, get_token_context, get_token_context.result,
+        "Cannot query token for audience '%s', rescheduling RefreshToken",
+        cached_token->audience.c_str());
+    // Schedule Refresh for later, the cached token is served until it
+    // expires.
+    auto execution_result = ScheduleRefreshToken(cached_token, seconds(1));
     if (!execution_result.Successful()) {
       SCP_CRITICAL_CONTEXT(
           kAutoRefreshTokenProvider, get_token_context, execution_result,
@@ -119,21 +187,30 @@ void AutoRefreshTokenProviderService::OnRefreshTokenCallback(
     return;
   }
 
+  nanoseconds token_lifetime = duration_cast<nanoseconds>(
+      get_token_context.response->token_lifetime_in_seconds);
   // Cache the fetched token
   {
     unique_lock lock(mutex_);
-    cached_token_ = make_shared<string>(get_token_context.response->token);
+    cached_token->token =
+        make_shared<string>(get_token_context.response->token);
+    cached_token->expiry_timestamp =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() + token_lifetime)
+            .count();
   }
 
   SCP_INFO_CONTEXT(kAutoRefreshTokenProvider, get_token_context,
-                   "Token Refreshed");
-
-  auto execution_result = async_executor_->ScheduleFor(
-      [this]() { RefreshToken(); },
-      (TimeProvider::GetSteadyTimestampInNanoseconds() +
-       get_token_context.response->token_lifetime_in_seconds)
-          .count(),
-      async_task_canceller_);
+                   "Token Refreshed for audience '%s'",
+                   cached_token->audience.c_str());
+
+  // The token is refreshed ahead of its expiry, the jitter keeping the tokens
+  // of the audiences, and of the instances, from being refreshed at once.
+  static thread_local mt19937 random_generator(random_device{}());
+  uniform_real_distribution<double> distribution(
+      kRefreshLifetimeRatio - kRefreshJitterRatio, kRefreshLifetimeRatio);
+  auto execution_result = ScheduleRefreshToken(
+      cached_token, duration_cast<nanoseconds>(
+                        token_lifetime * distribution(random_generator)));
   if (!execution_result.Successful()) {
     SCP_CRITICAL_CONTEXT(kAutoRefreshTokenProvider, get_token_context,
                          execution_result,
@@ -142,4 +219,22 @@ void AutoRefreshTokenProviderService::OnRefreshTokenCallback(
   }
 }
 
+ExecutionResult AutoRefreshTokenProviderService::ScheduleRefreshToken(
+    const shared_ptr<CachedToken>& cached_token, nanoseconds delay) {
+  unique_lock lock(mutex_);
+  if (!is_running_) {
+    return SuccessExecutionResult();
+  }
+  return async_executor_->ScheduleFor(
+      [this, cached_token]() {
+        {
+          unique_lock lock(mutex_);
+          cached_token->async_task_canceller = nullptr;
+        }
+        RefreshToken(cached_token);
+      },
+      (TimeProvider::GetSteadyTimestampInNanoseconds() + delay).count(),
+      cached_token->async_task_canceller);
+}
+
 }  // namespace google::scp::core
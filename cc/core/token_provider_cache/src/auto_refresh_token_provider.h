@@ -16,23 +16,43 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <shared_mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/token_fetcher_interface.h"
 #include "core/interface/token_provider_cache_interface.h"
 
 namespace google::scp::core {
 
+/**
+ * @brief Caches the tokens of the default audience of the token fetcher and
+ * of any other audience, keeping them refreshed in the background.
+ *
+ * The tokens of all the audiences are fetched in parallel, and refreshed
+ * ahead of their expiry with jitter so that they do not all expire, or get
+ * refreshed, at once. A token is still served while it is refreshed, or
+ * while the refresh is retried, up to its expiry, so that getting a token
+ * does not wait on the token fetcher in the steady state.
+ */
 class AutoRefreshTokenProviderService : public TokenProviderCacheInterface {
  public:
+  /**
+   * @param token_fetcher The fetcher of the tokens.
+   * @param async_executor The executor to schedule the refreshes on.
+   * @param audiences The audiences, other than the default one, to prefetch
+   * the tokens of on Run.
+   */
   AutoRefreshTokenProviderService(
       std::unique_ptr<TokenFetcherInterface> token_fetcher,
-      std::shared_ptr<AsyncExecutorInterface> async_executor)
-      : token_fetcher_(std::move(token_fetcher)),
-        async_executor_(async_executor) {}
+      std::shared_ptr<AsyncExecutorInterface> async_executor,
+      const std::vector<std::string>& audiences = {});
 
   ExecutionResult Init() noexcept override;
 
@@ -42,33 +62,76 @@ class AutoRefreshTokenProviderService : public TokenProviderCacheInterface {
 
   ExecutionResultOr<std::shared_ptr<Token>> GetToken() noexcept override;
 
+  ExecutionResultOr<std::shared_ptr<Token>> GetTokenForAudience(
+      const std::string& audience) noexcept override;
+
+  /// The part of the lifetime of a token after which it is refreshed.
+  static constexpr double kRefreshLifetimeRatio = 0.75;
+
+  /// The max part of the lifetime of a token the refresh is made earlier by.
+  static constexpr double kRefreshJitterRatio = 0.1;
+
  protected:
+  /// @brief The cached token of an audience.
+  struct CachedToken {
+    explicit CachedToken(std::string audience)
+        : audience(std::move(audience)) {}
+
+    const std::string audience;
+
+    /// @brief The token, protected by mutex_
+    std::shared_ptr<Token> token;
+
+    /// @brief The steady time the token expires at, protected by mutex_
+    Timestamp expiry_timestamp = 0;
+
+    /// @brief Token refresh async task cancel lambda, protected by mutex_
+    std::function<bool()> async_task_canceller;
+  };
+
   /**
    * @brief Refresh Token helper
    *
+   * @param cached_token The token to refresh.
    * @return ExecutionResult
    */
-  ExecutionResult RefreshToken();
+  ExecutionResult RefreshToken(
+      const std::shared_ptr<CachedToken>& cached_token);
 
   /**
    * @brief Callback after fetching token from remote
    */
   void OnRefreshTokenCallback(
+      const std::shared_ptr<CachedToken>& cached_token,
       AsyncContext<FetchTokenRequest, FetchTokenResponse>&);
 
+  /**
+   * @brief Schedules the refresh of the token after delay.
+   *
+   * @return ExecutionResult
+   */
+  ExecutionResult ScheduleRefreshToken(
+      const std::shared_ptr<CachedToken>& cached_token,
+      std::chrono::nanoseconds delay);
+
+  /// @brief Returns the token if it is not expired.
+  ExecutionResultOr<std::shared_ptr<Token>> GetUnexpiredToken(
+      const CachedToken& cached_token);
+
   /// @brief Interface object to query token from remote
   std::unique_ptr<TokenFetcherInterface> token_fetcher_;
 
   /// @brief Async executor to execute token query in async manner
   std::shared_ptr<AsyncExecutorInterface> async_executor_;
 
-  /// @brief Token query async task cancel lambda
-  std::function<bool()> async_task_canceller_;
+  /// @brief The tokens by audience, the default audience being empty
+  absl::flat_hash_map<std::string, std::shared_ptr<CachedToken>>
+      cached_tokens_;
 
-  /// @brief Token fetched using token fetcher
-  std::shared_ptr<Token> cached_token_;
-
-  /// @brief Mutex to protect the cached token
+  /// @brief Mutex to protect the cached tokens
   std::shared_mutex mutex_;
+
+  /// @brief Whether the tokens are refreshed, protected by mutex_
+  bool is_running_;
 };
 }  // namespace google::scp::core
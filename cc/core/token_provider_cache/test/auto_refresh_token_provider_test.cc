@@ -17,7 +17,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "core/async_executor/src/async_executor.h"
 #include "core/common/time_provider/src/time_provider.h"
@@ -32,8 +35,12 @@ using std::atomic;
 using std::make_shared;
 using std::make_unique;
 using std::move;
+using std::mutex;
 using std::shared_ptr;
+using std::string;
+using std::unique_lock;
 using std::unique_ptr;
+using std::vector;
 using std::chrono::milliseconds;
 using std::chrono::seconds;
 using std::this_thread::sleep_for;
@@ -254,4 +261,82 @@ TEST_F(AutoRefreshTokenProviderTest, TokenIsCachedAndResetIfTokenFetchFails) {
 
   EXPECT_THAT(token_provider_->Stop(), ResultIs(SuccessExecutionResult()));
 }
+
+TEST_F(AutoRefreshTokenProviderTest, TokenIsServedWhileRefreshFails) {
+  EXPECT_CALL(*token_fetcher_, FetchToken)
+      .WillOnce(
+          [&](AsyncContext<FetchTokenRequest, FetchTokenResponse> context) {
+            context.response = make_shared<FetchTokenResponse>();
+            context.response->token = "abc";
+            context.response->token_lifetime_in_seconds = seconds(2);
+            context.result = SuccessExecutionResult();
+            context.Finish();
+            return SuccessExecutionResult();
+          })
+      .WillRepeatedly(
+          [&](AsyncContext<FetchTokenRequest, FetchTokenResponse> context) {
+            context.result = FailureExecutionResult(1234);
+            context.Finish();
+            return SuccessExecutionResult();
+          });
+
+  EXPECT_THAT(token_provider_->Run(), ResultIs(SuccessExecutionResult()));
+  EXPECT_THAT(token_provider_->GetToken(),
+              IsSuccessfulAndHolds(Pointee(Eq("abc"))));
+
+  // The refresh fails ahead of the expiry, but the token is still valid.
+  sleep_for(milliseconds(1700));
+  EXPECT_THAT(token_provider_->GetToken(),
+              IsSuccessfulAndHolds(Pointee(Eq("abc"))));
+
+  EXPECT_THAT(token_provider_->Stop(), ResultIs(SuccessExecutionResult()));
+}
+
+TEST_F(AutoRefreshTokenProviderTest, AudiencesAreFetchedInParallel) {
+  auto token_fetcher_mock = make_unique<TokenFetcherMock>();
+  auto* token_fetcher = token_fetcher_mock.get();
+  token_provider_ = make_unique<AutoRefreshTokenProviderService>(
+      move(token_fetcher_mock), async_executor_,
+      vector<string>{"audience1", "audience2"});
+
+  mutex contexts_mutex;
+  vector<AsyncContext<FetchTokenRequest, FetchTokenResponse>> contexts;
+  EXPECT_CALL(*token_fetcher, FetchToken)
+      .Times(4)
+      .WillRepeatedly(
+          [&](AsyncContext<FetchTokenRequest, FetchTokenResponse> context) {
+            unique_lock lock(contexts_mutex);
+            contexts.push_back(context);
+            return SuccessExecutionResult();
+          });
+
+  // All the fetches are issued before any completes.
+  EXPECT_THAT(token_provider_->Run(), ResultIs(SuccessExecutionResult()));
+  ASSERT_EQ(contexts.size(), 3);
+  EXPECT_THAT(token_provider_->GetTokenForAudience("audience1"),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_AUTO_REFRESH_TOKEN_PROVIDER_TOKEN_NOT_AVAILABLE)));
+
+  // An audience first asked for is fetched from then on.
+  EXPECT_THAT(token_provider_->GetTokenForAudience("audience3"),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_AUTO_REFRESH_TOKEN_PROVIDER_TOKEN_NOT_AVAILABLE)));
+  ASSERT_EQ(contexts.size(), 4);
+
+  for (auto& context : contexts) {
+    context.response = make_shared<FetchTokenResponse>();
+    context.response->token = "token_of_" + context.request->audience;
+    context.response->token_lifetime_in_seconds = seconds(360);
+    context.result = SuccessExecutionResult();
+    context.Finish();
+  }
+
+  EXPECT_THAT(token_provider_->GetToken(),
+              IsSuccessfulAndHolds(Pointee(Eq("token_of_"))));
+  for (const string& audience : {"audience1", "audience2", "audience3"}) {
+    EXPECT_THAT(token_provider_->GetTokenForAudience(audience),
+                IsSuccessfulAndHolds(Pointee(Eq("token_of_" + audience))));
+  }
+  EXPECT_THAT(token_provider_->Stop(), ResultIs(SuccessExecutionResult()));
+}
 }  // namespace google::scp::core
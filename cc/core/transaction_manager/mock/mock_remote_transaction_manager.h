@@ -55,6 +55,17 @@ class MockRemoteTransactionManager
     return core::SuccessExecutionResult();
   }
 
+  ExecutionResult BatchGetTransactionStatus(
+      AsyncContext<BatchGetTransactionStatusRequest,
+                   BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept override {
+    if (batch_get_transaction_status_mock) {
+      return batch_get_transaction_status_mock(
+          batch_get_transaction_status_context);
+    }
+    return core::SuccessExecutionResult();
+  }
+
   ExecutionResult ExecutePhase(
       AsyncContext<TransactionPhaseRequest, TransactionPhaseResponse>&
           transaction_phase_context) noexcept override {
@@ -72,6 +83,10 @@ class MockRemoteTransactionManager
   std::function<ExecutionResult(
       AsyncContext<GetTransactionStatusRequest, GetTransactionStatusResponse>&)>
       get_transaction_status_mock;
+  std::function<ExecutionResult(
+      AsyncContext<BatchGetTransactionStatusRequest,
+                   BatchGetTransactionStatusResponse>&)>
+      batch_get_transaction_status_mock;
   std::function<ExecutionResult(
       AsyncContext<TransactionPhaseRequest, TransactionPhaseResponse>&)>
       execute_phase_mock;
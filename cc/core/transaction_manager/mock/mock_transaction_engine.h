@@ -115,6 +115,9 @@ class MockTransactionEngine : public core::TransactionEngine {
 
   ExecutionResult ResolveTransaction(
       std::shared_ptr<Transaction>& transaction) noexcept override {
+    if (resolve_transaction_mock) {
+      return resolve_transaction_mock(transaction);
+    }
     return TransactionEngine::ResolveTransaction(transaction);
   }
 
@@ -391,7 +394,7 @@ class MockTransactionEngine : public core::TransactionEngine {
   }
 
   virtual void OnLogTransactionCallback(
-      AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context,
+      AsyncContext<JournalLogRequest, JournalLogResponse>& journal_log_context,
       transaction_manager::TransactionPhase current_phase,
       std::shared_ptr<Transaction>& transaction) noexcept {
     return TransactionEngine::OnLogTransactionCallback(
@@ -399,7 +402,7 @@ class MockTransactionEngine : public core::TransactionEngine {
   }
 
   virtual void OnLogStateAndProceedToNextPhaseCallback(
-      AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context,
+      AsyncContext<JournalLogRequest, JournalLogResponse>& journal_log_context,
       transaction_manager::TransactionPhase current_phase,
       std::shared_ptr<Transaction>& transaction) noexcept {
     return TransactionEngine::OnLogStateAndProceedToNextPhaseCallback(
@@ -530,6 +533,8 @@ class MockTransactionEngine : public core::TransactionEngine {
       on_remote_transaction_not_found;
   std::function<ExecutionResult(std::shared_ptr<Transaction>&)>
       lock_remotely_coordinated_transaction_mock;
+  std::function<ExecutionResult(std::shared_ptr<Transaction>&)>
+      resolve_transaction_mock;
   std::function<ExecutionResult(std::shared_ptr<Transaction>&)>
       unlock_remotely_coordinated_transaction_mock;
 
@@ -51,5 +51,7 @@ class MockTransactionManager : public core::TransactionManager {
   std::atomic<size_t>& GetActiveTransactionsCount() {
     return core::TransactionManager::active_transactions_count_;
   }
+
+  void SetStarted(bool started) { started_ = started; }
 };
 }  // namespace google::scp::core::transaction_manager::mock
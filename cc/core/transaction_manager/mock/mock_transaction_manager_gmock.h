@@ -41,6 +41,10 @@ class MockTransactionManagerGMock : public TransactionManagerInterface {
               ((std::shared_ptr<std::list<CheckpointLog>>&)),
               (noexcept, override));
 
+  MOCK_METHOD(ExecutionResult, CheckpointLive,
+              ((std::shared_ptr<std::list<CheckpointLog>>&)),
+              (noexcept, override));
+
   MOCK_METHOD(ExecutionResult, GetTransactionStatus,
               ((AsyncContext<GetTransactionStatusRequest,
                              GetTransactionStatusResponse>&)),
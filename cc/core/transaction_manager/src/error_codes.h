@@ -197,4 +197,9 @@ DEFINE_ERROR_CODE(SC_TRANSACTION_MANAGER_TRANSACTION_ALREADY_EXISTS,
                   "The entry already exists in the transaction map.",
                   HttpStatusCode::PRECONDITION_FAILED)
 
+DEFINE_ERROR_CODE(SC_TRANSACTION_MANAGER_REQUEST_EXPIRED,
+                  SC_TRANSACTION_MANAGER, 0x0025,
+                  "The request expired before it could be executed.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
+
 }  // namespace google::scp::core::errors
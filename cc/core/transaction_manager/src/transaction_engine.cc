@@ -16,13 +16,18 @@
 
 #include "transaction_engine.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <iterator>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -43,24 +48,35 @@ using google::scp::core::Version;
 using google::scp::core::common::Serialization;
 using google::scp::core::common::TimeProvider;
 using google::scp::core::common::Uuid;
+using google::scp::core::common::UuidHash;
 using google::scp::core::transaction_manager::TransactionPhase;
 using google::scp::core::transaction_manager::proto::TransactionCommandLog_1_0;
 using google::scp::core::transaction_manager::proto::TransactionEngineLog;
 using google::scp::core::transaction_manager::proto::TransactionEngineLog_1_0;
 using google::scp::core::transaction_manager::proto::TransactionLog_1_0;
 using google::scp::core::transaction_manager::proto::TransactionLogType;
+using google::scp::core::transaction_manager::proto::
+    TransactionPhaseBatchLog_1_0;
 using google::scp::core::transaction_manager::proto::TransactionPhaseLog_1_0;
 using google::scp::cpio::MetricClientInterface;
 using std::atomic;
 using std::bind;
 using std::function;
 using std::list;
+using std::lock_guard;
+using std::make_move_iterator;
 using std::make_pair;
 using std::make_shared;
+using std::make_unique;
+using std::map;
+using std::min;
 using std::move;
+using std::mutex;
 using std::shared_ptr;
 using std::string;
+using std::unordered_map;
 using std::vector;
+using std::weak_ptr;
 using std::chrono::milliseconds;
 using std::chrono::seconds;
 using std::placeholders::_1;
@@ -73,6 +89,11 @@ static constexpr Version kCurrentVersion = {.major = 1, .minor = 0};
 // This value MUST NOT change forever.
 static Uuid kTransactionEngineId = {.high = 0xFFFFFFF1, .low = 0x00000004};
 static constexpr char kTransactionEngine[] = "TransactionEngine";
+static constexpr google::scp::core::AsyncTaskTag
+    kDispatchDistributedCommandTaskTag = {kTransactionEngine,
+                                          "DispatchDistributedCommand"};
+/// The max number of transactions in one remote batch status inquiry.
+static constexpr size_t kMaxBatchGetRemoteTransactionStatusSize = 500;
 
 // Transaction Phase Log Strings
 static constexpr char kTransactionPhaseNotStartedStr[] = "NOT_STARTED";
@@ -153,11 +174,14 @@ TransactionEngine::TransactionEngine(
     shared_ptr<JournalServiceInterface>& journal_service,
     shared_ptr<RemoteTransactionManagerInterface>& remote_transaction_manager,
     const shared_ptr<MetricClientInterface>& metric_client,
-    shared_ptr<ConfigProviderInterface> config_provider)
+    shared_ptr<ConfigProviderInterface> config_provider,
+    shared_ptr<MetricRouter> metric_router)
     : TransactionEngine(async_executor, transaction_command_serializer,
                         journal_service, make_shared<TransactionPhaseManager>(),
                         remote_transaction_manager, metric_client,
-                        config_provider) {}
+                        config_provider) {
+  metrics_ = make_unique<TransactionEngineMetrics>(metric_router);
+}
 
 ExecutionResult TransactionEngine::Init() noexcept {
   auto execution_result = active_transactions_map_.Init();
@@ -193,6 +217,67 @@ ExecutionResult TransactionEngine::Init() noexcept {
     transaction_resolution_with_remote_enabled_ = true;
   }
 
+  if (!config_provider_
+           ->Get(kTransactionManagerLocalTransactionFastPathEnabled,
+                 local_transaction_fast_path_enabled_)
+           .Successful()) {
+    local_transaction_fast_path_enabled_ = false;
+  }
+
+  if (!config_provider_
+           ->Get(kTransactionManagerBatchPhaseLogs,
+                 batch_transaction_phase_logs_)
+           .Successful()) {
+    batch_transaction_phase_logs_ = false;
+  }
+
+  if (!config_provider_
+           ->Get(kTransactionManagerExpiredTransactionBatchSize,
+                 expired_transaction_resolution_batch_size_)
+           .Successful()) {
+    expired_transaction_resolution_batch_size_ = 0;
+  }
+
+  if (!config_provider_
+           ->Get(kTransactionManagerBatchRemoteTransactionStatusEnabled,
+                 batch_remote_transaction_status_enabled_)
+           .Successful()) {
+    batch_remote_transaction_status_enabled_ = false;
+  }
+
+  if (!config_provider_
+           ->Get(kTransactionManagerTelemetrySamplingPeriod,
+                 telemetry_sampling_period_)
+           .Successful()) {
+    telemetry_sampling_period_ =
+        kDefaultTransactionEngineTelemetrySamplingPeriod;
+  }
+
+  if (!config_provider_
+           ->Get(kTransactionManagerCommandDispatchFanOut,
+                 command_dispatch_fan_out_)
+           .Successful()) {
+    command_dispatch_fan_out_ = 0;
+  }
+
+  execution_result = metrics_->Init();
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  size_t transaction_pool_size = 0;
+  if (!config_provider_
+           ->Get(kTransactionManagerTransactionPoolSize, transaction_pool_size)
+           .Successful()) {
+    transaction_pool_size = 0;
+  }
+  if (transaction_pool_size > 0) {
+    transaction_pool_ = make_unique<common::ObjectPool<Transaction>>(
+        transaction_pool_size, [](Transaction& transaction) {
+          transaction.Reset();
+        });
+  }
+
   SCP_INFO(
       kTransactionEngine, activity_id_,
       "Initializing Transaction Engine.. Configured Transaction Timeout is "
@@ -287,6 +372,17 @@ ExecutionResult TransactionEngine::Stop() noexcept {
     return execution_result;
   }
 
+  // The garbage collection is stopped, so the expiry index no longer grows.
+  // Drop it and wait for the resolution in progress, if any, to wind down.
+  {
+    lock_guard lock(expired_transactions_mutex_);
+    expired_transactions_.clear();
+    expired_transaction_ids_.clear();
+  }
+  while (is_resolving_expired_transactions_.load()) {
+    sleep_for(milliseconds(kStopTransactionWaitLoopIntervalMilliseconds));
+  }
+
   // Wait for pending activities to finish on the transactions
   vector<Uuid> active_transaction_ids;
   execution_result = active_transactions_map_.Keys(active_transaction_ids);
@@ -369,11 +465,151 @@ void TransactionEngine::OnBeforeGarbageCollection(
   // collection function of the map. The TransactionEngine itself does the
   // deletion explicitly when the transaction moves to a termination phase.
   should_delete_entry(false);
+  if (expired_transaction_resolution_batch_size_ > 0) {
+    IndexExpiredTransaction(transaction);
+    return;
+  }
   ResolveTransaction(transaction);
 }
 
+void TransactionEngine::IndexExpiredTransaction(
+    shared_ptr<Transaction>& transaction) noexcept {
+  if (!transaction->IsExpired() || transaction->blocked ||
+      !transaction_resolution_with_remote_enabled_) {
+    return;
+  }
+
+  {
+    lock_guard lock(expired_transactions_mutex_);
+    if (!expired_transaction_ids_.insert(transaction->id).second) {
+      return;
+    }
+    expired_transactions_.emplace(transaction->expiration_time, transaction);
+  }
+  ScheduleExpiredTransactionsResolution();
+}
+
+void TransactionEngine::ScheduleExpiredTransactionsResolution() noexcept {
+  auto is_resolving = false;
+  if (!is_resolving_expired_transactions_.compare_exchange_strong(
+          is_resolving, true)) {
+    return;
+  }
+
+  auto execution_result =
+      async_executor_->Schedule([this]() { ResolveExpiredTransactions(); },
+                                AsyncPriority::Normal);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kTransactionEngine, activity_id_, execution_result,
+              "Cannot schedule the resolution of the expired transactions.");
+    // The next garbage collection pass indexes the transactions again.
+    lock_guard lock(expired_transactions_mutex_);
+    expired_transactions_.clear();
+    expired_transaction_ids_.clear();
+    is_resolving_expired_transactions_ = false;
+  }
+}
+
+void TransactionEngine::ResolveExpiredTransactions() noexcept {
+  // The transactions of the group by origin, in deadline order.
+  map<string, vector<shared_ptr<Transaction>>> transactions_by_origin;
+  size_t transaction_count = 0;
+  bool has_more_transactions = false;
+  {
+    lock_guard lock(expired_transactions_mutex_);
+    auto current_time =
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+    auto it = expired_transactions_.begin();
+    while (it != expired_transactions_.end() &&
+           transaction_count < expired_transaction_resolution_batch_size_ &&
+           it->first < current_time) {
+      auto transaction = it->second.lock();
+      it = expired_transactions_.erase(it);
+      if (!transaction) {
+        continue;
+      }
+      expired_transaction_ids_.erase(transaction->id);
+
+      // Skips the transactions that ended since they were indexed.
+      shared_ptr<Transaction> active_transaction;
+      if (!active_transactions_map_.Find(transaction->id, active_transaction)
+               .Successful() ||
+          active_transaction != transaction) {
+        continue;
+      }
+
+      auto origin = transaction->transaction_origin
+                        ? *transaction->transaction_origin
+                        : string();
+      transactions_by_origin[origin].push_back(transaction);
+      transaction_count++;
+    }
+    has_more_transactions = !expired_transactions_.empty();
+  }
+
+  for (auto& [origin, transactions] : transactions_by_origin) {
+    if (!batch_remote_transaction_status_enabled_) {
+      for (auto& transaction : transactions) {
+        ResolveTransaction(transaction);
+      }
+      continue;
+    }
+
+    vector<shared_ptr<Transaction>> locked_transactions;
+    for (auto& transaction : transactions) {
+      bool needs_remote_status = false;
+      if (PrepareTransactionResolution(transaction, needs_remote_status)
+              .Successful() &&
+          needs_remote_status) {
+        locked_transactions.push_back(transaction);
+      }
+    }
+    DispatchBatchGetRemoteTransactionStatus(locked_transactions);
+  }
+
+  if (has_more_transactions) {
+    auto execution_result =
+        async_executor_->Schedule([this]() { ResolveExpiredTransactions(); },
+                                  AsyncPriority::Normal);
+    if (execution_result.Successful()) {
+      return;
+    }
+    SCP_ERROR(kTransactionEngine, activity_id_, execution_result,
+              "Cannot schedule the resolution of the expired transactions.");
+    lock_guard lock(expired_transactions_mutex_);
+    expired_transactions_.clear();
+    expired_transaction_ids_.clear();
+  }
+  is_resolving_expired_transactions_ = false;
+
+  // Picks up the transactions indexed after the group was taken.
+  bool has_pending_transactions = false;
+  {
+    lock_guard lock(expired_transactions_mutex_);
+    has_pending_transactions = !expired_transactions_.empty();
+  }
+  if (has_pending_transactions) {
+    ScheduleExpiredTransactionsResolution();
+  }
+}
+
 ExecutionResult TransactionEngine::ResolveTransaction(
     shared_ptr<Transaction>& transaction) noexcept {
+  bool needs_remote_status = false;
+  auto execution_result =
+      PrepareTransactionResolution(transaction, needs_remote_status);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  if (needs_remote_status) {
+    DispatchGetRemoteTransactionStatus(transaction);
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult TransactionEngine::PrepareTransactionResolution(
+    shared_ptr<Transaction>& transaction, bool& needs_remote_status) noexcept {
+  needs_remote_status = false;
   if (!transaction->IsExpired() || transaction->blocked ||
       !transaction_resolution_with_remote_enabled_) {
     return SuccessExecutionResult();
@@ -424,6 +660,12 @@ ExecutionResult TransactionEngine::ResolveTransaction(
     return execution_result;
   }
 
+  needs_remote_status = true;
+  return SuccessExecutionResult();
+}
+
+void TransactionEngine::DispatchGetRemoteTransactionStatus(
+    shared_ptr<Transaction>& transaction) noexcept {
   INFO_CONTEXT_WITH_TRANSACTION_SCP_INFO(transaction->context, transaction,
                                          "Dispatching get transaction status.");
 
@@ -451,8 +693,106 @@ ExecutionResult TransactionEngine::ResolveTransaction(
         return remote_transaction_manager->GetTransactionStatus(
             get_transaction_status_context);
       });
+}
 
-  return SuccessExecutionResult();
+void TransactionEngine::DispatchBatchGetRemoteTransactionStatus(
+    vector<shared_ptr<Transaction>>& transactions) noexcept {
+  for (size_t begin = 0; begin < transactions.size();
+       begin += kMaxBatchGetRemoteTransactionStatusSize) {
+    auto end = min(transactions.size(),
+                   begin + kMaxBatchGetRemoteTransactionStatusSize);
+    vector<shared_ptr<Transaction>> batch(transactions.begin() + begin,
+                                          transactions.begin() + end);
+
+    AsyncContext<BatchGetTransactionStatusRequest,
+                 BatchGetTransactionStatusResponse>
+        batch_get_transaction_status_context(
+            make_shared<BatchGetTransactionStatusRequest>(),
+            bind(&TransactionEngine::OnBatchGetRemoteTransactionStatusCallback,
+                 this, batch, _1),
+            activity_id_);
+    batch_get_transaction_status_context.request->transaction_origin =
+        batch.front()->transaction_origin;
+    for (auto& transaction : batch) {
+      GetTransactionStatusRequest request;
+      request.transaction_id = transaction->id;
+      request.transaction_secret = transaction->transaction_secret;
+      request.transaction_origin = transaction->transaction_origin;
+      batch_get_transaction_status_context.request->transactions.push_back(
+          move(request));
+    }
+
+    SCP_INFO(kTransactionEngine, activity_id_,
+             "Dispatching get transaction status for a batch of %zu "
+             "transactions.",
+             batch.size());
+
+    operation_dispatcher_.Dispatch<
+        AsyncContext<BatchGetTransactionStatusRequest,
+                     BatchGetTransactionStatusResponse>>(
+        batch_get_transaction_status_context,
+        [remote_transaction_manager = remote_transaction_manager_](
+            AsyncContext<BatchGetTransactionStatusRequest,
+                         BatchGetTransactionStatusResponse>&
+                batch_get_transaction_status_context) {
+          return remote_transaction_manager->BatchGetTransactionStatus(
+              batch_get_transaction_status_context);
+        });
+  }
+}
+
+void TransactionEngine::OnBatchGetRemoteTransactionStatusCallback(
+    vector<shared_ptr<Transaction>>& transactions,
+    AsyncContext<BatchGetTransactionStatusRequest,
+                 BatchGetTransactionStatusResponse>&
+        batch_get_transaction_status_context) noexcept {
+  if (!batch_get_transaction_status_context.result.Successful()) {
+    // The remote coordinator may not support batches, the transactions are
+    // still locked and their statuses are inquired one by one.
+    SCP_ERROR_CONTEXT(kTransactionEngine, batch_get_transaction_status_context,
+                      batch_get_transaction_status_context.result,
+                      "Batch get transaction status failed, falling back to "
+                      "the status of each of the %zu transactions.",
+                      transactions.size());
+    for (auto& transaction : transactions) {
+      DispatchGetRemoteTransactionStatus(transaction);
+    }
+    return;
+  }
+
+  unordered_map<Uuid, const BatchGetTransactionStatusResult*, UuidHash>
+      results_by_id;
+  for (const auto& result :
+       batch_get_transaction_status_context.response->results) {
+    results_by_id[result.transaction_id] = &result;
+  }
+
+  for (auto& transaction : transactions) {
+    auto it = results_by_id.find(transaction->id);
+    if (it == results_by_id.end()) {
+      DispatchGetRemoteTransactionStatus(transaction);
+      continue;
+    }
+
+    AsyncContext<GetTransactionStatusRequest, GetTransactionStatusResponse>
+        get_transaction_status_context(
+            make_shared<GetTransactionStatusRequest>(),
+            [](AsyncContext<GetTransactionStatusRequest,
+                            GetTransactionStatusResponse>&) {},
+            transaction->context);
+    get_transaction_status_context.request->transaction_id = transaction->id;
+    get_transaction_status_context.request->transaction_secret =
+        transaction->transaction_secret;
+    get_transaction_status_context.request->transaction_origin =
+        transaction->transaction_origin;
+    get_transaction_status_context.result = it->second->result;
+    if (it->second->result.Successful()) {
+      get_transaction_status_context.response =
+          make_shared<GetTransactionStatusResponse>(it->second->status);
+    }
+    OnGetRemoteTransactionStatusCallback(transaction,
+                                         get_transaction_status_context);
+  }
 }
 
 void TransactionEngine::OnGetRemoteTransactionStatusCallback(
@@ -864,89 +1204,121 @@ ExecutionResult TransactionEngine::OnJournalServiceRecoverCallback(
       return execution_result;
     }
 
-    Uuid transaction_id;
-    transaction_id.high = transaction_phase_log_1_0.id().high();
-    transaction_id.low = transaction_phase_log_1_0.id().low();
-
-    auto target_transaction_phase =
-        ConvertProtoPhaseToPhase(transaction_phase_log_1_0.phase());
-    auto transaction_id_string = common::ToString(transaction_id);
-
-    SCP_DEBUG(
-        kTransactionEngine, activity_id,
-        "Recovering TRANSACTION_PHASE_LOG with phase: %s of transaction %s",
-        TransactionPhaseToString(target_transaction_phase).c_str(),
-        transaction_id_string.c_str());
+    return RecoverTransactionPhaseLog(transaction_phase_log_1_0, activity_id);
+  }
 
-    shared_ptr<Transaction> transaction;
-    auto execution_result =
-        active_transactions_map_.Find(transaction_id, transaction);
+  if (transaction_engine_log_1_0.type() ==
+      TransactionLogType::TRANSACTION_PHASE_BATCH_LOG) {
+    bytes_deserialized = 0;
+    TransactionPhaseBatchLog_1_0 transaction_phase_batch_log_1_0;
+    execution_result =
+        Serialization::DeserializeProtoMessage<TransactionPhaseBatchLog_1_0>(
+            transaction_engine_log_1_0.log_body(),
+            transaction_phase_batch_log_1_0, bytes_deserialized);
     if (!execution_result.Successful()) {
-      // End phase completes transaction recovery and removes transaction from
-      // the active transactions map. If there is retry during End phase,
-      // duplicate logs may occur, ignore them.
-      if ((target_transaction_phase == TransactionPhase::End) ||
-          skip_log_recovery_failures_) {
-        return SuccessExecutionResult();
+      SCP_ERROR(kTransactionEngine, activity_id, execution_result,
+                "Log is corrupted, invalid TransactionPhaseBatchLog_1_0!");
+      return execution_result;
+    }
+
+    for (const auto& transaction_phase_log_1_0 :
+         transaction_phase_batch_log_1_0.phase_logs()) {
+      execution_result =
+          RecoverTransactionPhaseLog(transaction_phase_log_1_0, activity_id);
+      if (!execution_result.Successful()) {
+        return execution_result;
       }
+    }
+    return SuccessExecutionResult();
+  }
+
+  return FailureExecutionResult(
+      errors::SC_TRANSACTION_MANAGER_INVALID_TRANSACTION_LOG);
+}
 
-      // This should never happen. Raise alert.
-      SCP_ALERT(kTransactionEngine, activity_id, execution_result,
-                "Cannot find the transaction with id %s for "
-                "TRANSACTION_PHASE_LOG phase: %s",
-                transaction_id_string.c_str(),
-                TransactionPhaseToString(target_transaction_phase).c_str());
+ExecutionResult TransactionEngine::RecoverTransactionPhaseLog(
+    const TransactionPhaseLog_1_0& transaction_phase_log_1_0,
+    const Uuid& activity_id) noexcept {
+  Uuid transaction_id;
+  transaction_id.high = transaction_phase_log_1_0.id().high();
+  transaction_id.low = transaction_phase_log_1_0.id().low();
 
-      return FailureExecutionResult(
-          errors::SC_TRANSACTION_MANAGER_TRANSACTION_NOT_FOUND);
-    }
+  auto target_transaction_phase =
+      ConvertProtoPhaseToPhase(transaction_phase_log_1_0.phase());
+  auto transaction_id_string = common::ToString(transaction_id);
 
-    if (target_transaction_phase < transaction->current_phase) {
-      // This should never happen. Raise alert.
-      SCP_ALERT(
-          kTransactionEngine, activity_id, execution_result,
-          "TRANSACTION_PHASE_LOG has stale phase %s. "
-          "Current transaction phase is %s",
-          TransactionPhaseToString(target_transaction_phase).c_str(),
-          TransactionPhaseToString(transaction->current_phase.load()).c_str());
-      if (skip_log_recovery_failures_) {
-        return SuccessExecutionResult();
-      }
-      return FailureExecutionResult(
-          errors::SC_TRANSACTION_MANAGER_INVALID_TRANSACTION_LOG);
+  SCP_DEBUG(
+      kTransactionEngine, activity_id,
+      "Recovering TRANSACTION_PHASE_LOG with phase: %s of transaction %s",
+      TransactionPhaseToString(target_transaction_phase).c_str(),
+      transaction_id_string.c_str());
+
+  shared_ptr<Transaction> transaction;
+  auto execution_result =
+      active_transactions_map_.Find(transaction_id, transaction);
+  if (!execution_result.Successful()) {
+    // End phase completes transaction recovery and removes transaction from
+    // the active transactions map. If there is retry during End phase,
+    // duplicate logs may occur, ignore them.
+    if ((target_transaction_phase == TransactionPhase::End) ||
+        skip_log_recovery_failures_) {
+      return SuccessExecutionResult();
     }
 
-    transaction->current_phase = target_transaction_phase;
-    transaction->transaction_failed = transaction_phase_log_1_0.failed();
-    transaction->transaction_execution_result =
-        ExecutionResult(transaction_phase_log_1_0.result());
-    transaction->transaction_execution_result.status_code =
-        transaction_phase_log_1_0.result().status_code();
+    // This should never happen. Raise alert.
+    SCP_ALERT(kTransactionEngine, activity_id, execution_result,
+              "Cannot find the transaction with id %s for "
+              "TRANSACTION_PHASE_LOG phase: %s",
+              transaction_id_string.c_str(),
+              TransactionPhaseToString(target_transaction_phase).c_str());
 
-    SCP_DEBUG(kTransactionEngine, activity_id,
-              "Successfully processed TRANSACTION_PHASE_LOG, recovered "
-              "transaction with ID: %s",
-              transaction_id_string.c_str());
+    return FailureExecutionResult(
+        errors::SC_TRANSACTION_MANAGER_TRANSACTION_NOT_FOUND);
+  }
 
-    // Remove the transaction if the end phase has been recovered.
-    if (transaction->current_phase == TransactionPhase::End) {
-      SCP_INFO(kTransactionEngine, activity_id,
-               "Transaction recovery completed for transaction %s",
-               transaction_id_string.c_str());
-      return active_transactions_map_.Erase(transaction_id);
+  if (target_transaction_phase < transaction->current_phase) {
+    // This should never happen. Raise alert.
+    SCP_ALERT(
+        kTransactionEngine, activity_id, execution_result,
+        "TRANSACTION_PHASE_LOG has stale phase %s. "
+        "Current transaction phase is %s",
+        TransactionPhaseToString(target_transaction_phase).c_str(),
+        TransactionPhaseToString(transaction->current_phase.load()).c_str());
+    if (skip_log_recovery_failures_) {
+      return SuccessExecutionResult();
     }
+    return FailureExecutionResult(
+        errors::SC_TRANSACTION_MANAGER_INVALID_TRANSACTION_LOG);
+  }
 
-    return SuccessExecutionResult();
+  transaction->current_phase = target_transaction_phase;
+  transaction->transaction_failed = transaction_phase_log_1_0.failed();
+  transaction->transaction_execution_result =
+      ExecutionResult(transaction_phase_log_1_0.result());
+  transaction->transaction_execution_result.status_code =
+      transaction_phase_log_1_0.result().status_code();
+
+  SCP_DEBUG(kTransactionEngine, activity_id,
+            "Successfully processed TRANSACTION_PHASE_LOG, recovered "
+            "transaction with ID: %s",
+            transaction_id_string.c_str());
+
+  // Remove the transaction if the end phase has been recovered.
+  if (transaction->current_phase == TransactionPhase::End) {
+    SCP_INFO(kTransactionEngine, activity_id,
+             "Transaction recovery completed for transaction %s",
+             transaction_id_string.c_str());
+    return active_transactions_map_.Erase(transaction_id);
   }
 
-  return FailureExecutionResult(
-      errors::SC_TRANSACTION_MANAGER_INVALID_TRANSACTION_LOG);
+  return SuccessExecutionResult();
 }
 
 ExecutionResult TransactionEngine::InitializeTransaction(
     AsyncContext<TransactionRequest, TransactionResponse>& transaction_context,
     shared_ptr<Transaction>& transaction) {
-  transaction = make_shared<Transaction>();
+  transaction = transaction_pool_ ? transaction_pool_->Acquire()
+                                  : make_shared<Transaction>();
   transaction->id = transaction_context.request->transaction_id;
   transaction->context = transaction_context;
   transaction->current_phase = TransactionPhase::NotStarted;
@@ -979,6 +1351,10 @@ ExecutionResult TransactionEngine::InitializeTransaction(
           .count();
   transaction->last_execution_timestamp =
       TimeProvider::GetWallTimestampInNanosecondsAsClockTicks();
+  transaction->is_sampled =
+      telemetry_sampling_period_ > 0 &&
+      sampled_transaction_counter_.fetch_add(1) % telemetry_sampling_period_ ==
+          0;
   auto pair = make_pair(transaction->id, transaction);
   auto execution_result = active_transactions_map_.Insert(pair, transaction);
   if (!execution_result.Successful()) {
@@ -1133,6 +1509,8 @@ ExecutionResult TransactionEngine::LogTransactionAndProceedToNextPhase(
       bind(&TransactionEngine::OnLogTransactionCallback, this, _1,
            current_phase, transaction);
 
+  StartPhaseStage(transaction);
+
   operation_dispatcher_
       .Dispatch<AsyncContext<JournalLogRequest, JournalLogResponse>>(
           journal_log_context,
@@ -1146,7 +1524,7 @@ ExecutionResult TransactionEngine::LogTransactionAndProceedToNextPhase(
 }
 
 void TransactionEngine::OnLogTransactionCallback(
-    AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context,
+    AsyncContext<JournalLogRequest, JournalLogResponse>& journal_log_context,
     TransactionPhase current_phase,
     shared_ptr<Transaction>& transaction) noexcept {
   if (!journal_log_context.result.Successful()) {
@@ -1164,9 +1542,24 @@ void TransactionEngine::OnLogTransactionCallback(
     return;
   }
 
+  EndPhaseStage(current_phase, kTransactionEngineJournalingStage, transaction);
   ProceedToNextPhase(current_phase, transaction);
 }
 
+void TransactionEngine::PopulateTransactionPhaseLog(
+    shared_ptr<Transaction>& transaction,
+    TransactionPhaseLog_1_0& transaction_phase_log_1_0) noexcept {
+  transaction_phase_log_1_0.mutable_id()->set_high(transaction->id.high);
+  transaction_phase_log_1_0.mutable_id()->set_low(transaction->id.low);
+  transaction_phase_log_1_0.set_phase(
+      ConvertPhaseToProtoPhase(transaction->current_phase.load()));
+  transaction_phase_log_1_0.set_failed(transaction->transaction_failed.load());
+  transaction_phase_log_1_0.mutable_result()->set_status(
+      ToStatusProto(transaction->transaction_execution_result.status));
+  transaction_phase_log_1_0.mutable_result()->set_status_code(
+      transaction->transaction_execution_result.status_code);
+}
+
 ExecutionResult TransactionEngine::SerializeState(
     std::shared_ptr<Transaction>& transaction,
     BytesBuffer& transaction_engine_log_bytes_buffer) noexcept {
@@ -1179,15 +1572,7 @@ ExecutionResult TransactionEngine::SerializeState(
       TransactionLogType::TRANSACTION_PHASE_LOG);
 
   TransactionPhaseLog_1_0 transaction_phase_log_1_0;
-  transaction_phase_log_1_0.mutable_id()->set_high(transaction->id.high);
-  transaction_phase_log_1_0.mutable_id()->set_low(transaction->id.low);
-  transaction_phase_log_1_0.set_phase(
-      ConvertPhaseToProtoPhase(transaction->current_phase.load()));
-  transaction_phase_log_1_0.set_failed(transaction->transaction_failed.load());
-  transaction_phase_log_1_0.mutable_result()->set_status(
-      ToStatusProto(transaction->transaction_execution_result.status));
-  transaction_phase_log_1_0.mutable_result()->set_status_code(
-      transaction->transaction_execution_result.status_code);
+  PopulateTransactionPhaseLog(transaction, transaction_phase_log_1_0);
 
   size_t offset = 0;
   size_t bytes_serialized = 0;
@@ -1252,6 +1637,17 @@ ExecutionResult TransactionEngine::LogState(
     TransactionPhase current_phase, shared_ptr<Transaction>& transaction,
     function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
         callback) noexcept {
+  StartPhaseStage(transaction);
+  if (batch_transaction_phase_logs_) {
+    return LogStateInBatch(transaction, callback);
+  }
+  return LogStateWithoutBatching(transaction, callback);
+}
+
+ExecutionResult TransactionEngine::LogStateWithoutBatching(
+    shared_ptr<Transaction>& transaction,
+    function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
+        callback) noexcept {
   BytesBuffer transaction_engine_log_bytes_buffer;
   auto execution_result =
       SerializeState(transaction, transaction_engine_log_bytes_buffer);
@@ -1282,6 +1678,197 @@ ExecutionResult TransactionEngine::LogState(
   return SuccessExecutionResult();
 }
 
+ExecutionResult TransactionEngine::LogStateInBatch(
+    shared_ptr<Transaction>& transaction,
+    function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
+        callback) noexcept {
+  PendingTransactionPhaseLog pending_transaction_phase_log;
+  pending_transaction_phase_log.transaction = transaction;
+  PopulateTransactionPhaseLog(transaction,
+                              pending_transaction_phase_log.phase_log);
+  pending_transaction_phase_log.callback = move(callback);
+
+  {
+    lock_guard<mutex> lock(pending_transaction_phase_logs_mutex_);
+    pending_transaction_phase_logs_.push_back(
+        move(pending_transaction_phase_log));
+    if (transaction_phase_log_batch_in_flight_) {
+      return SuccessExecutionResult();
+    }
+    transaction_phase_log_batch_in_flight_ = true;
+  }
+
+  LogNextTransactionPhaseLogBatch();
+  return SuccessExecutionResult();
+}
+
+ExecutionResult TransactionEngine::SerializeStateBatch(
+    const TransactionPhaseLogBatch& batch,
+    BytesBuffer& transaction_engine_log_bytes_buffer) noexcept {
+  TransactionEngineLog transaction_engine_log;
+  transaction_engine_log.mutable_version()->set_major(kCurrentVersion.major);
+  transaction_engine_log.mutable_version()->set_minor(kCurrentVersion.minor);
+
+  TransactionEngineLog_1_0 transaction_engine_log_1_0;
+  transaction_engine_log_1_0.set_type(
+      TransactionLogType::TRANSACTION_PHASE_BATCH_LOG);
+
+  TransactionPhaseBatchLog_1_0 transaction_phase_batch_log_1_0;
+  for (const auto& pending_transaction_phase_log : batch) {
+    *transaction_phase_batch_log_1_0.add_phase_logs() =
+        pending_transaction_phase_log.phase_log;
+  }
+
+  size_t offset = 0;
+  size_t bytes_serialized = 0;
+  BytesBuffer transaction_phase_batch_log_1_0_bytes_buffer(
+      transaction_phase_batch_log_1_0.ByteSizeLong());
+  auto execution_result =
+      Serialization::SerializeProtoMessage<TransactionPhaseBatchLog_1_0>(
+          transaction_phase_batch_log_1_0_bytes_buffer, offset,
+          transaction_phase_batch_log_1_0, bytes_serialized);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kTransactionEngine, activity_id_, execution_result,
+              "Cannot serialize the transaction phase batch.");
+    return execution_result;
+  }
+  transaction_phase_batch_log_1_0_bytes_buffer.length = bytes_serialized;
+
+  transaction_engine_log_1_0.set_log_body(
+      transaction_phase_batch_log_1_0_bytes_buffer.bytes->data(),
+      transaction_phase_batch_log_1_0_bytes_buffer.length);
+
+  offset = 0;
+  bytes_serialized = 0;
+  BytesBuffer transaction_engine_log_1_0_bytes_buffer(
+      transaction_engine_log_1_0.ByteSizeLong());
+  execution_result =
+      Serialization::SerializeProtoMessage<TransactionEngineLog_1_0>(
+          transaction_engine_log_1_0_bytes_buffer, offset,
+          transaction_engine_log_1_0, bytes_serialized);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kTransactionEngine, activity_id_, execution_result,
+              "Cannot serialize the transaction engine log 1.0.");
+    return execution_result;
+  }
+  transaction_engine_log_1_0_bytes_buffer.length = bytes_serialized;
+  transaction_engine_log.set_log_body(
+      transaction_engine_log_1_0_bytes_buffer.bytes->data(),
+      transaction_engine_log_1_0_bytes_buffer.length);
+
+  offset = 0;
+  bytes_serialized = 0;
+  transaction_engine_log_bytes_buffer.bytes =
+      make_shared<vector<Byte>>(transaction_engine_log.ByteSizeLong());
+  transaction_engine_log_bytes_buffer.capacity =
+      transaction_engine_log.ByteSizeLong();
+  execution_result = Serialization::SerializeProtoMessage<TransactionEngineLog>(
+      transaction_engine_log_bytes_buffer, offset, transaction_engine_log,
+      bytes_serialized);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kTransactionEngine, activity_id_, execution_result,
+              "Cannot serialize the transaction engine log.");
+    return execution_result;
+  }
+  transaction_engine_log_bytes_buffer.length = bytes_serialized;
+  return SuccessExecutionResult();
+}
+
+void TransactionEngine::LogNextTransactionPhaseLogBatch() noexcept {
+  auto batch = make_shared<TransactionPhaseLogBatch>();
+  {
+    lock_guard<mutex> lock(pending_transaction_phase_logs_mutex_);
+    if (pending_transaction_phase_logs_.empty()) {
+      transaction_phase_log_batch_in_flight_ = false;
+      return;
+    }
+
+    if (pending_transaction_phase_logs_.size() <=
+        kTransactionPhaseLogBatchMaxSize) {
+      batch->swap(pending_transaction_phase_logs_);
+    } else {
+      auto batch_end = pending_transaction_phase_logs_.begin() +
+                       kTransactionPhaseLogBatchMaxSize;
+      batch->assign(
+          make_move_iterator(pending_transaction_phase_logs_.begin()),
+          make_move_iterator(batch_end));
+      pending_transaction_phase_logs_.erase(
+          pending_transaction_phase_logs_.begin(), batch_end);
+    }
+  }
+
+  LogTransactionPhaseLogBatch(batch);
+}
+
+void TransactionEngine::LogTransactionPhaseLogBatch(
+    shared_ptr<TransactionPhaseLogBatch>& batch) noexcept {
+  BytesBuffer transaction_engine_log_bytes_buffer;
+  auto execution_result =
+      SerializeStateBatch(*batch, transaction_engine_log_bytes_buffer);
+  if (!execution_result.Successful()) {
+    // Journal the states of the batch one by one instead.
+    for (auto& pending_transaction_phase_log : *batch) {
+      execution_result =
+          LogStateWithoutBatching(pending_transaction_phase_log.transaction,
+                                  pending_transaction_phase_log.callback);
+      if (!execution_result.Successful()) {
+        ALERT_CONTEXT_WITH_TRANSACTION_SCP_INFO(
+            pending_transaction_phase_log.transaction->context,
+            pending_transaction_phase_log.transaction, execution_result,
+            "Cannot log the transaction state.");
+      }
+    }
+    LogNextTransactionPhaseLogBatch();
+    return;
+  }
+
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.parent_activity_id = activity_id_;
+  journal_log_context.correlation_id = activity_id_;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->component_id = kTransactionEngineId;
+  journal_log_context.request->log_id = Uuid::GenerateUuid();
+  journal_log_context.request->log_status = JournalLogStatus::Log;
+  journal_log_context.request->data =
+      make_shared<BytesBuffer>(transaction_engine_log_bytes_buffer);
+  journal_log_context.callback =
+      bind(&TransactionEngine::OnLogTransactionPhaseLogBatchCallback, this, _1,
+           batch);
+
+  operation_dispatcher_
+      .Dispatch<AsyncContext<JournalLogRequest, JournalLogResponse>>(
+          journal_log_context,
+          [journal_service = journal_service_](
+              AsyncContext<JournalLogRequest, JournalLogResponse>&
+                  journal_log_context) {
+            return journal_service->Log(journal_log_context);
+          });
+}
+
+void TransactionEngine::OnLogTransactionPhaseLogBatchCallback(
+    AsyncContext<JournalLogRequest, JournalLogResponse>& journal_log_context,
+    shared_ptr<TransactionPhaseLogBatch>& batch) noexcept {
+  if (!journal_log_context.result.Successful()) {
+    SCP_ERROR_CONTEXT(kTransactionEngine, journal_log_context,
+                      journal_log_context.result,
+                      "Transaction State batch WAL failed.");
+    operation_dispatcher_
+        .Dispatch<AsyncContext<JournalLogRequest, JournalLogResponse>>(
+            journal_log_context,
+            [journal_service = journal_service_](
+                AsyncContext<JournalLogRequest, JournalLogResponse>&
+                    journal_log_context) {
+              return journal_service->Log(journal_log_context);
+            });
+    return;
+  }
+
+  for (auto& pending_transaction_phase_log : *batch) {
+    pending_transaction_phase_log.callback(journal_log_context);
+  }
+  LogNextTransactionPhaseLogBatch();
+}
+
 ExecutionResult TransactionEngine::LogStateAndProceedToNextPhase(
     TransactionPhase current_phase,
     shared_ptr<Transaction>& transaction) noexcept {
@@ -1319,6 +1906,7 @@ void TransactionEngine::OnLogStateAndProceedToNextPhaseCallback(
     return;
   }
 
+  EndPhaseStage(current_phase, kTransactionEngineJournalingStage, transaction);
   ProceedToNextPhase(current_phase, transaction);
 }
 
@@ -1341,6 +1929,7 @@ void TransactionEngine::OnLogStateAndExecuteDistributedPhaseCallback(
     return;
   }
 
+  EndPhaseStage(current_phase, kTransactionEngineJournalingStage, transaction);
   ExecuteDistributedPhase(current_phase, transaction);
 }
 
@@ -1650,6 +2239,14 @@ void TransactionEngine::ProceedToNextPhaseAfterRecovery(
 void TransactionEngine::ProceedToNextPhase(
     TransactionPhase current_phase,
     shared_ptr<Transaction>& transaction) noexcept {
+  if (transaction->is_sampled && transaction->phase_start_timestamp != 0) {
+    metrics_->RecordPhaseStage(
+        TransactionPhaseToString(current_phase), kTransactionEnginePhaseStage,
+        TimeProvider::GetSteadyTimestampInNanoseconds() -
+            std::chrono::nanoseconds(transaction->phase_start_timestamp));
+    transaction->phase_start_timestamp = 0;
+  }
+
   if (current_phase == TransactionPhase::End) {
     transaction->last_execution_timestamp =
         TimeProvider::GetWallTimestampInNanosecondsAsClockTicks();
@@ -1778,6 +2375,11 @@ void TransactionEngine::ProceedToNextPhase(
 
 void TransactionEngine::ExecuteCurrentPhase(
     shared_ptr<Transaction>& transaction) noexcept {
+  if (transaction->is_sampled) {
+    transaction->phase_start_timestamp =
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  }
+
   switch (transaction->current_phase) {
     case TransactionPhase::Begin:
       BeginTransaction(transaction);
@@ -1815,6 +2417,14 @@ void TransactionEngine::BeginTransaction(
 
 void TransactionEngine::PrepareTransaction(
     shared_ptr<Transaction>& transaction) noexcept {
+  // Nothing is changed before the commit phase, so a local transaction that
+  // crashes before it is recovered at its last journaled phase and prepared
+  // again.
+  if (local_transaction_fast_path_enabled_ &&
+      !transaction->is_coordinated_remotely) {
+    ExecuteDistributedPhase(TransactionPhase::Prepare, transaction);
+    return;
+  }
   LogStateAndExecuteDistributedPhase(TransactionPhase::Prepare, transaction);
 }
 
@@ -1831,6 +2441,13 @@ void TransactionEngine::CommitNotifyTransaction(
 
 void TransactionEngine::CommittedTransaction(
     shared_ptr<Transaction>& transaction) noexcept {
+  // A local transaction recovered before its end phase is notified again,
+  // which the notify phase already has to tolerate.
+  if (local_transaction_fast_path_enabled_ &&
+      !transaction->is_coordinated_remotely) {
+    ProceedToNextPhase(TransactionPhase::Committed, transaction);
+    return;
+  }
   LogStateAndProceedToNextPhase(TransactionPhase::Committed, transaction);
 }
 
@@ -1861,44 +2478,133 @@ void TransactionEngine::UnknownStateTransaction(
 void TransactionEngine::ExecuteDistributedPhase(
     TransactionPhase current_phase,
     shared_ptr<Transaction>& transaction) noexcept {
-  transaction->pending_callbacks =
-      transaction->context.request->commands.size();
+  StartPhaseStage(transaction);
+  auto command_count = transaction->context.request->commands.size();
+  transaction->pending_callbacks = command_count;
+  if (command_dispatch_fan_out_ > 0 && command_count > 1) {
+    // The first commands are claimed before any is dispatched, the next ones
+    // are claimed as the dispatched ones finish.
+    auto fan_out = min(command_dispatch_fan_out_, command_count);
+    transaction->next_command_index = fan_out;
+    for (size_t i = 0; i < fan_out; ++i) {
+      ScheduleDistributedCommand(i, current_phase, transaction);
+    }
+    return;
+  }
+
+  transaction->next_command_index = command_count;
   uint64_t failed_operations = 0;
-  for (size_t i = 0; i < transaction->context.request->commands.size(); ++i) {
+  for (size_t i = 0; i < command_count; ++i) {
     auto command = transaction->context.request->commands.at(i);
     auto execution_result =
         DispatchDistributedCommand(i, current_phase, command, transaction);
     if (!execution_result.Successful()) {
-      auto failed = false;
-
-      if (execution_result.status == ExecutionStatus::Failure) {
-        auto enqueue_execution_result =
-            transaction->current_phase_failed_command_indices.TryEnqueue(i);
-        if (!enqueue_execution_result.Successful()) {
-          ERROR_CONTEXT_WITH_TRANSACTION_SCP_INFO(
-              transaction->context, transaction,
-              FailureExecutionResult(
-                  errors::SC_TRANSACTION_MANAGER_QUEUE_FAILURE),
-              "Failed to insert command index %ld", i);
-        }
-      }
-
-      // Only change if the current status was false.
-      if (transaction->current_phase_failed.compare_exchange_strong(failed,
-                                                                    true)) {
-        transaction->current_phase_execution_result = execution_result;
-      }
-
+      RecordCommandFailure(i, execution_result, transaction);
       failed_operations++;
     }
   }
 
   if (failed_operations > 0 && transaction->pending_callbacks.fetch_sub(
                                    failed_operations) == failed_operations) {
+    EndPhaseStage(current_phase, kTransactionEngineCommandExecutionStage,
+                  transaction);
     ProceedToNextPhase(current_phase, transaction);
   }
 }
 
+void TransactionEngine::DispatchDistributedCommandInParallel(
+    size_t command_index, TransactionPhase current_phase,
+    shared_ptr<Transaction>& transaction) noexcept {
+  auto command_count = transaction->context.request->commands.size();
+  while (command_index < command_count) {
+    auto command = transaction->context.request->commands.at(command_index);
+    auto execution_result = DispatchDistributedCommand(
+        command_index, current_phase, command, transaction);
+    if (execution_result.Successful()) {
+      return;
+    }
+
+    RecordCommandFailure(command_index, execution_result, transaction);
+    auto next_command_index = transaction->next_command_index.fetch_add(1);
+    if (transaction->pending_callbacks.fetch_sub(1) == 1) {
+      EndPhaseStage(current_phase, kTransactionEngineCommandExecutionStage,
+                    transaction);
+      ProceedToNextPhase(current_phase, transaction);
+      return;
+    }
+    command_index = next_command_index;
+  }
+}
+
+void TransactionEngine::ScheduleDistributedCommand(
+    size_t command_index, TransactionPhase current_phase,
+    shared_ptr<Transaction>& transaction) noexcept {
+  auto execution_result = async_executor_->Schedule(
+      [this, command_index, current_phase, transaction]() mutable {
+        DispatchDistributedCommandInParallel(command_index, current_phase,
+                                             transaction);
+      },
+      AsyncPriority::Normal, kDispatchDistributedCommandTaskTag);
+  if (!execution_result.Successful()) {
+    DispatchDistributedCommandInParallel(command_index, current_phase,
+                                         transaction);
+  }
+}
+
+void TransactionEngine::RecordCommandFailure(
+    size_t command_index, const ExecutionResult& execution_result,
+    shared_ptr<Transaction>& transaction) noexcept {
+  if (execution_result.status == ExecutionStatus::Failure) {
+    auto enqueue_execution_result =
+        transaction->current_phase_failed_command_indices.TryEnqueue(
+            command_index);
+    if (!enqueue_execution_result.Successful()) {
+      ERROR_CONTEXT_WITH_TRANSACTION_SCP_INFO(
+          transaction->context, transaction,
+          FailureExecutionResult(errors::SC_TRANSACTION_MANAGER_QUEUE_FAILURE),
+          "Failed to insert command index %ld", command_index);
+    }
+  }
+
+  // Only change if the current status was false.
+  auto failed = false;
+  if (transaction->current_phase_failed.compare_exchange_strong(failed, true)) {
+    transaction->current_phase_execution_result = execution_result;
+  }
+}
+
+void TransactionEngine::StartPhaseStage(
+    shared_ptr<Transaction>& transaction) noexcept {
+  if (!transaction->is_sampled) {
+    return;
+  }
+  transaction->phase_stage_start_timestamp =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+}
+
+void TransactionEngine::EndPhaseStage(
+    TransactionPhase current_phase, absl::string_view stage,
+    shared_ptr<Transaction>& transaction) noexcept {
+  if (!transaction->is_sampled ||
+      transaction->phase_stage_start_timestamp == 0) {
+    return;
+  }
+
+  auto duration =
+      TimeProvider::GetSteadyTimestampInNanoseconds() -
+      std::chrono::nanoseconds(transaction->phase_stage_start_timestamp);
+  transaction->phase_stage_start_timestamp = 0;
+  auto phase = TransactionPhaseToString(current_phase);
+  metrics_->RecordPhaseStage(phase, stage, duration);
+
+  // The transaction context carries the correlation id of the request, so
+  // these logs trace the request through its phases.
+  DEBUG_CONTEXT_WITH_TRANSACTION_SCP_INFO(
+      transaction->context, transaction, "Stage %s of phase %s took %lld ns",
+      string(stage).c_str(), phase.c_str(),
+      static_cast<long long>(duration.count()));
+}
+
 ExecutionResult TransactionEngine::DispatchDistributedCommand(
     size_t command_index, TransactionPhase current_phase,
     shared_ptr<TransactionCommand>& command,
@@ -1945,29 +2651,23 @@ void TransactionEngine::OnPhaseCallback(
   }
 
   if (execution_result.status == ExecutionStatus::Failure) {
-    auto failed = false;
-    auto enqueue_execution_result =
-        transaction->current_phase_failed_command_indices.TryEnqueue(
-            command_index);
-    if (!enqueue_execution_result.Successful()) {
-      ERROR_CONTEXT_WITH_TRANSACTION_SCP_INFO(
-          transaction->context, transaction,
-          FailureExecutionResult(errors::SC_TRANSACTION_MANAGER_QUEUE_FAILURE),
-          "Failed to insert command index %ld", command_index);
-    }
-
-    // Only change if the current status was false.
-    if (transaction->current_phase_failed.compare_exchange_strong(failed,
-                                                                  true)) {
-      transaction->current_phase_execution_result = execution_result;
-    }
+    RecordCommandFailure(command_index, execution_result, transaction);
   }
 
+  // Claimed while this command is still pending, see next_command_index.
+  auto next_command_index = transaction->next_command_index.fetch_add(1);
+
   // Was it the last callback?
   if (transaction->pending_callbacks.fetch_sub(1) != 1) {
+    if (next_command_index < transaction->context.request->commands.size()) {
+      ScheduleDistributedCommand(next_command_index, current_phase,
+                                 transaction);
+    }
     return;
   }
 
+  EndPhaseStage(current_phase, kTransactionEngineCommandExecutionStage,
+                transaction);
   ProceedToNextPhase(current_phase, transaction);
 }
 
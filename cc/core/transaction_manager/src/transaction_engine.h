@@ -19,11 +19,16 @@
 #include <atomic>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "core/common/auto_expiry_concurrent_map/src/auto_expiry_concurrent_map.h"
 #include "core/common/concurrent_queue/src/concurrent_queue.h"
+#include "core/common/object_pool/src/object_pool.h"
 #include "core/common/operation_dispatcher/src/operation_dispatcher.h"
 #include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
@@ -35,9 +40,11 @@
 #include "core/interface/remote_transaction_manager_interface.h"
 #include "core/interface/transaction_command_serializer_interface.h"
 #include "core/interface/transaction_manager_interface.h"
+#include "core/telemetry/src/metric/metric_router.h"
 #include "core/transaction_manager/interface/transaction_engine_interface.h"
 #include "core/transaction_manager/interface/transaction_phase_manager_interface.h"
 #include "core/transaction_manager/src/proto/transaction_engine.pb.h"
+#include "core/transaction_manager/src/transaction_engine_metrics.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
 #include "public/core/interface/execution_result.h"
 #include "public/cpio/interface/metric_client/metric_client_interface.h"
@@ -50,6 +57,7 @@ static constexpr google::scp::core::TimeDuration
 static constexpr size_t kTransactionManagerRetryStrategyTotalRetries = 12;
 static constexpr size_t kTransactionEngineCacheLifetimeSeconds = 30;
 static constexpr size_t kTransactionTimeoutSeconds = 300;
+static constexpr size_t kTransactionPhaseLogBatchMaxSize = 1000;
 
 namespace google::scp::core {
 /**
@@ -65,6 +73,7 @@ struct Transaction : public LoadableObject {
         transaction_execution_result(core::FailureExecutionResult(
             errors::SC_TRANSACTION_MANAGER_NOT_FINISHED)),
         pending_callbacks(0),
+        next_command_index(0),
         transaction_failed(false),
         current_phase_failed(false),
         current_phase_failed_command_indices(INT32_MAX),
@@ -91,6 +100,12 @@ struct Transaction : public LoadableObject {
   /// Number of pending dispatched commands at the current phase.
   std::atomic<size_t> pending_callbacks;
 
+  /// The index of the next command to claim for dispatch at the current
+  /// phase, if the commands are dispatched in parallel. The indices are only
+  /// claimed while the claiming command is still pending, so that the phase
+  /// cannot move on meanwhile.
+  std::atomic<size_t> next_command_index;
+
   /// Indicates whether the transaction failed.
   std::atomic<bool> transaction_failed;
 
@@ -133,6 +148,49 @@ struct Transaction : public LoadableObject {
   /// Indicates if the transaction is blocked and needs manual resolution.
   bool blocked = false;
 
+  /// Indicates whether the time spent in the phases is recorded.
+  bool is_sampled = false;
+
+  /// The steady start timestamp of the current phase, if sampled.
+  Timestamp phase_start_timestamp = 0;
+
+  /// The steady start timestamp of the current stage of the phase, if
+  /// sampled.
+  Timestamp phase_stage_start_timestamp = 0;
+
+  /// Brings the transaction back to its default constructed state, so that it
+  /// can be reused for another transaction.
+  void Reset() noexcept {
+    is_loaded = false;
+    needs_loader = false;
+    id = common::kZeroUuid;
+    context = AsyncContext<TransactionRequest, TransactionResponse>();
+    current_phase = transaction_manager::TransactionPhase::NotStarted;
+    current_phase_execution_result = core::SuccessExecutionResult();
+    transaction_execution_result = core::FailureExecutionResult(
+        errors::SC_TRANSACTION_MANAGER_NOT_FINISHED);
+    pending_callbacks = 0;
+    next_command_index = 0;
+    transaction_failed = false;
+    current_phase_failed = false;
+    size_t command_index;
+    while (current_phase_failed_command_indices.TryDequeue(command_index)
+               .Successful()) {
+    }
+    last_execution_timestamp = 0;
+    is_coordinated_remotely = false;
+    is_waiting_for_remote = false;
+    remote_phase_context =
+        AsyncContext<TransactionPhaseRequest, TransactionPhaseResponse>();
+    transaction_secret = nullptr;
+    transaction_origin = nullptr;
+    expiration_time = 0;
+    blocked = false;
+    is_sampled = false;
+    phase_start_timestamp = 0;
+    phase_stage_start_timestamp = 0;
+  }
+
   /// Indicates whether the transaction is expired.
   bool IsExpired() {
     Timestamp current_time =
@@ -155,7 +213,8 @@ class TransactionEngine
       std::shared_ptr<RemoteTransactionManagerInterface>&
           remote_transaction_manager,
       const std::shared_ptr<cpio::MetricClientInterface>& metric_client,
-      std::shared_ptr<ConfigProviderInterface> config_provider);
+      std::shared_ptr<ConfigProviderInterface> config_provider,
+      std::shared_ptr<MetricRouter> metric_router = nullptr);
 
   ExecutionResult Init() noexcept override;
 
@@ -203,7 +262,8 @@ class TransactionEngine
             std::bind(&TransactionEngine::OnBeforeGarbageCollection, this,
                       std::placeholders::_1, std::placeholders::_2,
                       std::placeholders::_3),
-            async_executor),
+            async_executor, common::kHighContentionConcurrentMapStripeCount,
+            true /* index_expirations */),
         transaction_phase_manager_(transaction_phase_manager),
         remote_transaction_manager_(remote_transaction_manager),
         journal_service_(journal_service),
@@ -221,6 +281,17 @@ class TransactionEngine
         skip_log_recovery_failures_(false),
         transaction_timeout_in_seconds_(kTransactionTimeoutSeconds),
         transaction_resolution_with_remote_enabled_(true),
+        local_transaction_fast_path_enabled_(false),
+        batch_transaction_phase_logs_(false),
+        transaction_phase_log_batch_in_flight_(false),
+        expired_transaction_resolution_batch_size_(0),
+        batch_remote_transaction_status_enabled_(false),
+        is_resolving_expired_transactions_(false),
+        metrics_(std::make_unique<TransactionEngineMetrics>(nullptr)),
+        telemetry_sampling_period_(
+            kDefaultTransactionEngineTelemetrySamplingPeriod),
+        sampled_transaction_counter_(0),
+        command_dispatch_fan_out_(0),
         activity_id_(core::common::Uuid::GenerateUuid()) {}
 
   /**
@@ -275,6 +346,79 @@ class TransactionEngine
   virtual ExecutionResult ResolveTransaction(
       std::shared_ptr<Transaction>& transaction) noexcept;
 
+  /**
+   * @brief Resolves what can be resolved of an expired transaction locally and,
+   * if the transaction is coordinated remotely, locks it for the inquiry of
+   * its status on the remote coordinator.
+   *
+   * @param transaction The transaction object to be resolved.
+   * @param needs_remote_status Set to true if the transaction is locked and
+   * waits for its remote status.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult PrepareTransactionResolution(
+      std::shared_ptr<Transaction>& transaction,
+      bool& needs_remote_status) noexcept;
+
+  /**
+   * @brief Dispatches the inquiry of the status of a locked transaction on the
+   * remote coordinator.
+   *
+   * @param transaction The transaction object to be resolved.
+   */
+  virtual void DispatchGetRemoteTransactionStatus(
+      std::shared_ptr<Transaction>& transaction) noexcept;
+
+  /**
+   * @brief Dispatches the inquiry of the statuses of locked transactions of
+   * the same origin on the remote coordinator, in batches.
+   *
+   * @param transactions The transactions to be resolved.
+   */
+  virtual void DispatchBatchGetRemoteTransactionStatus(
+      std::vector<std::shared_ptr<Transaction>>& transactions) noexcept;
+
+  /**
+   * @brief Is called back when the remote batch transaction status call
+   * completes. Each transaction of the batch proceeds as if its own status
+   * call had completed. If the batch fails as a whole, the statuses are
+   * inquired one by one instead.
+   *
+   * @param transactions The transactions of the batch.
+   * @param batch_get_transaction_status_context The batch get transaction
+   * status context.
+   */
+  virtual void OnBatchGetRemoteTransactionStatusCallback(
+      std::vector<std::shared_ptr<Transaction>>& transactions,
+      AsyncContext<BatchGetTransactionStatusRequest,
+                   BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept;
+
+  /**
+   * @brief Adds an expired transaction to the expiry index, unless it is
+   * already there, and schedules the resolution of the index.
+   *
+   * @param transaction The transaction object to be resolved.
+   */
+  virtual void IndexExpiredTransaction(
+      std::shared_ptr<Transaction>& transaction) noexcept;
+
+  /**
+   * @brief Resolves the next group of at most
+   * expired_transaction_resolution_batch_size_ transactions of the expiry
+   * index, earliest deadline first, and schedules the next group if more are
+   * due. The transactions of the group are resolved per origin, so that the
+   * status lookups to the same remote coordinator are dispatched together, in
+   * batches if batch_remote_transaction_status_enabled_.
+   */
+  virtual void ResolveExpiredTransactions() noexcept;
+
+  /**
+   * @brief Schedules ResolveExpiredTransactions unless it is already
+   * scheduled or running.
+   */
+  virtual void ScheduleExpiredTransactionsResolution() noexcept;
+
   /**
    * @brief Returns true if the local transaction phase is in sync with the
    * remote instance of the transaction. This is crucial for transaction
@@ -405,6 +549,17 @@ class TransactionEngine
       std::shared_ptr<Transaction>& transaction,
       BytesBuffer& output_buffer) noexcept;
 
+  /**
+   * @brief Populates the phase log with the provided transaction state.
+   *
+   * @param transaction The transaction state.
+   * @param transaction_phase_log_1_0 The phase log to populate.
+   */
+  void PopulateTransactionPhaseLog(
+      std::shared_ptr<Transaction>& transaction,
+      transaction_manager::proto::TransactionPhaseLog_1_0&
+          transaction_phase_log_1_0) noexcept;
+
   /**
    * @brief Logs the transaction object and then proceeds to the next phase of
    * the transaction. This is always called before the transaction starts to
@@ -426,7 +581,7 @@ class TransactionEngine
    * @param transaction The transaction object.
    */
   void OnLogTransactionCallback(
-      AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context,
+      AsyncContext<JournalLogRequest, JournalLogResponse>& journal_log_context,
       transaction_manager::TransactionPhase current_phase,
       std::shared_ptr<Transaction>& transaction) noexcept;
 
@@ -443,6 +598,93 @@ class TransactionEngine
       std::shared_ptr<Transaction>& transaction,
       std::function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
           callback) noexcept;
+  /**
+   * @brief Logs the current transaction state in its own journal log.
+   *
+   * @param transaction The current transaction.
+   * @param callback The callback to be called after logging the state.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult LogStateWithoutBatching(
+      std::shared_ptr<Transaction>& transaction,
+      std::function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
+          callback) noexcept;
+
+  /// A transaction state waiting to be journaled with a batch.
+  struct PendingTransactionPhaseLog {
+    /// The transaction whose state is journaled.
+    std::shared_ptr<Transaction> transaction;
+    /// The state of the transaction.
+    transaction_manager::proto::TransactionPhaseLog_1_0 phase_log;
+    /// The callback to be called once the batch is journaled.
+    std::function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
+        callback;
+  };
+
+  using TransactionPhaseLogBatch = std::vector<PendingTransactionPhaseLog>;
+
+  /**
+   * @brief Adds the current transaction state to the pending batch, which is
+   * journaled right away if no batch is being journaled, or after the batch
+   * being journaled otherwise.
+   *
+   * @param transaction The current transaction.
+   * @param callback The callback to be called after logging the state.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult LogStateInBatch(
+      std::shared_ptr<Transaction>& transaction,
+      std::function<void(AsyncContext<JournalLogRequest, JournalLogResponse>&)>
+          callback) noexcept;
+
+  /**
+   * @brief Serializes the transaction states of the batch and writes the output
+   * in the output_buffer.
+   *
+   * @param batch The batch of transaction states to be serialized.
+   * @param output_buffer The output buffer to write the serialized batch to.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual ExecutionResult SerializeStateBatch(
+      const TransactionPhaseLogBatch& batch,
+      BytesBuffer& output_buffer) noexcept;
+
+  /**
+   * @brief Journals the batch of transaction states as a single journal log.
+   *
+   * @param batch The batch of transaction states.
+   */
+  void LogTransactionPhaseLogBatch(
+      std::shared_ptr<TransactionPhaseLogBatch>& batch) noexcept;
+
+  /**
+   * @brief Journals the next pending batch, if any.
+   */
+  void LogNextTransactionPhaseLogBatch() noexcept;
+
+  /**
+   * @brief Is called once the journaling of a batch is completed, and calls
+   * the callbacks of the transaction states of the batch.
+   *
+   * @param journal_log_context The context of log operation.
+   * @param batch The batch of transaction states.
+   */
+  void OnLogTransactionPhaseLogBatchCallback(
+      AsyncContext<JournalLogRequest, JournalLogResponse>& journal_log_context,
+      std::shared_ptr<TransactionPhaseLogBatch>& batch) noexcept;
+
+  /**
+   * @brief Applies a recovered transaction state.
+   *
+   * @param transaction_phase_log_1_0 The recovered transaction state.
+   * @param activity_id ID of the activity for debug logs.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  ExecutionResult RecoverTransactionPhaseLog(
+      const transaction_manager::proto::TransactionPhaseLog_1_0&
+          transaction_phase_log_1_0,
+      const common::Uuid& activity_id) noexcept;
+
   /**
    * @brief Logs the transaction's current state and then proceeds to the next
    * phase of the transaction. This is always called during the transaction
@@ -605,6 +847,62 @@ class TransactionEngine
       transaction_manager::TransactionPhase current_phase,
       std::shared_ptr<Transaction>& transaction) noexcept;
 
+  /**
+   * @brief Dispatches a command of the current phase when the commands are
+   * dispatched in parallel. A command failing to dispatch is counted as done,
+   * and the next command not claimed yet is dispatched in its place.
+   *
+   * @param command_index The index of the command, claimed by the caller.
+   * @param current_phase The current phase of the transaction.
+   * @param transaction The transaction object.
+   */
+  virtual void DispatchDistributedCommandInParallel(
+      size_t command_index, transaction_manager::TransactionPhase current_phase,
+      std::shared_ptr<Transaction>& transaction) noexcept;
+
+  /**
+   * @brief Schedules DispatchDistributedCommandInParallel on the async
+   * executor, or runs it inline if it cannot be scheduled.
+   *
+   * @param command_index The index of the command, claimed by the caller.
+   * @param current_phase The current phase of the transaction.
+   * @param transaction The transaction object.
+   */
+  virtual void ScheduleDistributedCommand(
+      size_t command_index, transaction_manager::TransactionPhase current_phase,
+      std::shared_ptr<Transaction>& transaction) noexcept;
+
+  /**
+   * @brief Records the failure of a command of the current phase.
+   *
+   * @param command_index The index of the failed command.
+   * @param execution_result The execution result of the command.
+   * @param transaction The transaction object.
+   */
+  void RecordCommandFailure(size_t command_index,
+                            const ExecutionResult& execution_result,
+                            std::shared_ptr<Transaction>& transaction) noexcept;
+
+  /**
+   * @brief Starts timing a stage of the current phase of the transaction, if
+   * it is sampled.
+   *
+   * @param transaction The transaction object.
+   */
+  void StartPhaseStage(std::shared_ptr<Transaction>& transaction) noexcept;
+
+  /**
+   * @brief Records the time spent in the stage started last, if the
+   * transaction is sampled.
+   *
+   * @param current_phase The phase the stage belongs to.
+   * @param stage The name of the stage.
+   * @param transaction The transaction object.
+   */
+  void EndPhaseStage(transaction_manager::TransactionPhase current_phase,
+                     absl::string_view stage,
+                     std::shared_ptr<Transaction>& transaction) noexcept;
+
   /**
    * @brief Dispatches the command corresponding to the current phase of the
    * transaction.
@@ -769,6 +1067,60 @@ class TransactionEngine
   /// Is resolution with remote coordinator enabled?
   bool transaction_resolution_with_remote_enabled_;
 
+  /// Recycles the transaction objects once they are released, if enabled.
+  std::unique_ptr<common::ObjectPool<Transaction>> transaction_pool_;
+
+  /// Whether the prepare and committed states of the local transactions are
+  /// not journaled.
+  bool local_transaction_fast_path_enabled_;
+
+  /// Whether the transaction states are journaled in batches.
+  bool batch_transaction_phase_logs_;
+
+  /// Protects the pending transaction states and the in flight indicator.
+  std::mutex pending_transaction_phase_logs_mutex_;
+
+  /// The transaction states waiting for the batch in flight to be journaled.
+  TransactionPhaseLogBatch pending_transaction_phase_logs_;
+
+  /// Whether a batch is being journaled. Only one batch is in flight at a
+  /// time, the states logged meanwhile form the next batch.
+  bool transaction_phase_log_batch_in_flight_;
+
+  /// The maximum number of expired transactions resolved at a time. Zero
+  /// resolves each one as soon as the garbage collection finds it.
+  size_t expired_transaction_resolution_batch_size_;
+
+  /// Whether the expired transactions resolved at a time inquire their remote
+  /// statuses in batches per origin.
+  bool batch_remote_transaction_status_enabled_;
+
+  /// Protects the expiry index.
+  std::mutex expired_transactions_mutex_;
+
+  /// The expired transactions waiting to be resolved, by expiration time.
+  std::multimap<Timestamp, std::weak_ptr<Transaction>> expired_transactions_;
+
+  /// The ids of the transactions in expired_transactions_.
+  std::unordered_set<common::Uuid, common::UuidHash> expired_transaction_ids_;
+
+  /// Whether a resolution of the expiry index is scheduled or running.
+  std::atomic<bool> is_resolving_expired_transactions_;
+
+  /// Records the time the sampled transactions spend in each phase.
+  std::unique_ptr<TransactionEngineMetrics> metrics_;
+
+  /// One transaction out of this many is sampled, none if zero.
+  size_t telemetry_sampling_period_;
+
+  /// The number of transactions considered for sampling.
+  std::atomic<size_t> sampled_transaction_counter_;
+
+  /// The maximum number of commands of a phase dispatched in parallel on the
+  /// async executor. Zero dispatches them one after the other on the calling
+  /// thread.
+  size_t command_dispatch_fan_out_;
+
   /// Activity ID of background activities
   core::common::Uuid activity_id_;
 };
@@ -0,0 +1,79 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "transaction_engine_metrics.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "core/interface/type_def.h"
+#include "opentelemetry/context/context.h"
+
+namespace google::scp::core {
+ExecutionResult TransactionEngineMetrics::Init() noexcept {
+  if (!metric_router_) {
+    return SuccessExecutionResult();
+  }
+
+  meter_ = metric_router_->GetOrCreateMeter(kTransactionEngineMeter);
+
+  // The stages take from sub-milliseconds for the in memory commands to
+  // seconds for the journaling under load.
+  static std::vector<double> kPhaseStageDurationBoundaries = {
+      0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+      0.025,  0.05,    0.1,    0.25,  0.5,    1,     2.5};
+
+  metric_router_->CreateHistogramViewForInstrument(
+      /*metric_name=*/kTransactionEnginePhaseStageDurationMetric,
+      /*view_name=*/kTransactionEnginePhaseStageDurationView,
+      /*instrument_type=*/MetricRouter::InstrumentType::kHistogram,
+      /*boundaries=*/kPhaseStageDurationBoundaries,
+      /*version=*/"", /*schema=*/"",
+      /*view_description=*/"Transaction engine phase stage duration histogram",
+      /*unit=*/kSecondUnit);
+
+  phase_stage_duration_histogram_ =
+      std::static_pointer_cast<opentelemetry::metrics::Histogram<double>>(
+          metric_router_->GetOrCreateSyncInstrument(
+              kTransactionEnginePhaseStageDurationMetric,
+              [&]() -> std::shared_ptr<
+                        opentelemetry::metrics::SynchronousInstrument> {
+                return meter_->CreateDoubleHistogram(
+                    kTransactionEnginePhaseStageDurationMetric,
+                    "Time the sampled transactions spend in each stage of "
+                    "each phase in seconds",
+                    kSecondUnit);
+              }));
+
+  return SuccessExecutionResult();
+}
+
+void TransactionEngineMetrics::RecordPhaseStage(
+    absl::string_view phase, absl::string_view stage,
+    std::chrono::nanoseconds duration) noexcept {
+  if (!phase_stage_duration_histogram_) {
+    return;
+  }
+
+  absl::flat_hash_map<std::string, std::string> label_kv = {
+      {std::string(kTransactionEnginePhaseLabel), std::string(phase)},
+      {std::string(kTransactionEngineStageLabel), std::string(stage)}};
+  opentelemetry::context::Context context;
+  phase_stage_duration_histogram_->Record(
+      std::chrono::duration<double>(duration).count(), label_kv, context);
+}
+}  // namespace google::scp::core
@@ -0,0 +1,100 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/strings/string_view.h"
+#include "core/telemetry/src/metric/metric_router.h"
+#include "opentelemetry/metrics/meter.h"
+#include "opentelemetry/metrics/sync_instruments.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core {
+/// By default, one transaction out of this many is timed.
+static constexpr size_t kDefaultTransactionEngineTelemetrySamplingPeriod = 64;
+
+// Meter
+inline constexpr absl::string_view kTransactionEngineMeter =
+    "Transaction Engine";
+
+// View
+inline constexpr absl::string_view kTransactionEnginePhaseStageDurationView =
+    "Transaction Engine Phase Stage Duration";
+
+// Metrics
+inline constexpr absl::string_view kTransactionEnginePhaseStageDurationMetric =
+    "transaction_engine.phase.stage_duration";
+
+// Labels
+inline constexpr absl::string_view kTransactionEnginePhaseLabel =
+    "transaction_engine.phase";
+inline constexpr absl::string_view kTransactionEngineStageLabel =
+    "transaction_engine.stage";
+
+// Stages
+/// From the journal log of the transaction state to its acknowledgement.
+inline constexpr absl::string_view kTransactionEngineJournalingStage =
+    "journaling";
+/// From the dispatch of the commands of the phase to their last callback.
+inline constexpr absl::string_view kTransactionEngineCommandExecutionStage =
+    "command_execution";
+/// From the start of the phase to the transition to the next one.
+inline constexpr absl::string_view kTransactionEnginePhaseStage = "phase";
+
+/**
+ * @brief Exports the TransactionEngine telemetry through the MetricRouter: a
+ * histogram of the time the sampled transactions spend in each stage of each
+ * phase.
+ */
+class TransactionEngineMetrics {
+ public:
+  /**
+   * @brief Construct a new Transaction Engine Metrics object.
+   *
+   * @param metric_router the router to create the instruments with. Nothing
+   * is recorded if null.
+   */
+  explicit TransactionEngineMetrics(
+      absl::Nullable<std::shared_ptr<MetricRouter>> metric_router)
+      : metric_router_(std::move(metric_router)) {}
+
+  /// Creates the instruments. Must be called before the TransactionEngine
+  /// runs.
+  ExecutionResult Init() noexcept;
+
+  /**
+   * @brief Records the time a sampled transaction spent in a stage of a phase.
+   *
+   * @param phase the name of the phase.
+   * @param stage the name of the stage.
+   * @param duration the time spent in the stage.
+   */
+  void RecordPhaseStage(absl::string_view phase, absl::string_view stage,
+                        std::chrono::nanoseconds duration) noexcept;
+
+ private:
+  /// An instance of metric router which will provide APIs to create metrics.
+  absl::Nullable<std::shared_ptr<MetricRouter>> metric_router_;
+  /// OpenTelemetry Meter used for creating and managing metrics.
+  std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+  /// Histogram of the stage durations of the sampled transactions.
+  std::shared_ptr<opentelemetry::metrics::Histogram<double>>
+      phase_stage_duration_histogram_;
+};
+}  // namespace google::scp::core
@@ -21,7 +21,6 @@
 #include <chrono>
 #include <functional>
 #include <list>
-#include <map>
 #include <memory>
 #include <string>
 #include <thread>
@@ -103,12 +102,9 @@ void TransactionManager::ObserveActiveTransactionsCallback(
   auto observer = std::get<opentelemetry::nostd::shared_ptr<
       opentelemetry::metrics::ObserverResultT<int64_t>>>(observer_result);
 
-  std::map<std::string, std::string> metric_labels = {
-      {kMetricLabelPartitionId, ToString(self_ptr->partition_id_)}};
-
   absl::MutexLock lock(&(self_ptr->transaction_counts_mutex_));
   observer->Observe(self_ptr->max_transactions_since_observed_.load(),
-                    metric_labels);
+                    *self_ptr->partition_metric_attributes_);
   self_ptr->max_transactions_since_observed_.store(0);
 }
 
@@ -148,7 +144,8 @@ TransactionManager::TransactionManager(
           async_executor,
           make_shared<TransactionEngine>(
               async_executor, transaction_command_serializer, journal_service,
-              remote_transaction_manager, metric_client, config_provider),
+              remote_transaction_manager, metric_client, config_provider,
+              metric_router),
           max_concurrent_transactions, metric_client, metric_router,
           config_provider, partition_id) {}
 
@@ -184,25 +181,29 @@ ExecutionResult TransactionManager::Init() noexcept {
                   "Number of currently active transactions");
             });
     received_transactions_instrument_ =
-        std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
-            metric_router_->GetOrCreateSyncInstrument(
-                kMetricNameReceivedTransactions,
-                [&]() -> std::shared_ptr<
-                          opentelemetry::metrics::SynchronousInstrument> {
-                  return meter_->CreateUInt64Counter(
-                      kMetricNameReceivedTransactions,
-                      "Number of received transactions");
-                }));
+        metric_router_->GetOrCreateSyncInstrument<
+            opentelemetry::metrics::Counter<uint64_t>>(
+            kMetricNameReceivedTransactions,
+            [&]() -> std::shared_ptr<
+                      opentelemetry::metrics::SynchronousInstrument> {
+              return meter_->CreateUInt64Counter(
+                  kMetricNameReceivedTransactions,
+                  "Number of received transactions");
+            });
     finished_transactions_instrument_ =
-        std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
-            metric_router_->GetOrCreateSyncInstrument(
-                kMetricNameFinishedTransactions,
-                [&]() -> std::shared_ptr<
-                          opentelemetry::metrics::SynchronousInstrument> {
-                  return meter_->CreateUInt64Counter(
-                      kMetricNameFinishedTransactions,
-                      "Number of finished transactions");
-                }));
+        metric_router_->GetOrCreateSyncInstrument<
+            opentelemetry::metrics::Counter<uint64_t>>(
+            kMetricNameFinishedTransactions,
+            [&]() -> std::shared_ptr<
+                      opentelemetry::metrics::SynchronousInstrument> {
+              return meter_->CreateUInt64Counter(
+                  kMetricNameFinishedTransactions,
+                  "Number of finished transactions");
+            });
+
+    partition_metric_attributes_ = std::make_unique<MetricAttributes>(
+        std::initializer_list<MetricAttributes::Attribute>{
+            {kMetricLabelPartitionId, ToString(partition_id_)}});
 
     active_transactions_instrument_->AddCallback(
         reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
@@ -283,9 +284,7 @@ ExecutionResult TransactionManager::Execute(
 
   function<void()> task = [this, transaction_context]() mutable {
     if (metric_router_) {
-      std::map<std::string, std::string> metric_labels = {
-          {kMetricLabelPartitionId, ToString(partition_id_)}};
-      received_transactions_instrument_->Add(1, metric_labels);
+      received_transactions_instrument_->Add(1, *partition_metric_attributes_);
     }
 
     active_transactions_metric_->Increment(kMetricEventReceivedTransaction);
@@ -302,9 +301,8 @@ ExecutionResult TransactionManager::Execute(
           transaction_context.Finish();
 
           if (metric_router_) {
-            std::map<std::string, std::string> metric_labels = {
-                {kMetricLabelPartitionId, ToString(partition_id_)}};
-            finished_transactions_instrument_->Add(1, metric_labels);
+            finished_transactions_instrument_->Add(
+                1, *partition_metric_attributes_);
           }
 
           active_transactions_metric_->Increment(
@@ -326,8 +324,18 @@ ExecutionResult TransactionManager::Execute(
     }
   };
 
-  auto execution_result =
-      async_executor_->Schedule(task, AsyncPriority::Normal);
+  // A request still queued past its expiration would finish too late for its
+  // caller, so it is failed without spending any work on it.
+  auto execution_result = async_executor_->ScheduleWithDeadline(
+      task, AsyncPriority::Normal, transaction_context.expiration_time,
+      [this, transaction_context]() mutable {
+        transaction_context.result = RetryExecutionResult(
+            errors::SC_TRANSACTION_MANAGER_REQUEST_EXPIRED);
+        transaction_context.Finish();
+        DecrementActiveTransactionsCount(active_transactions_count_,
+                                         max_transactions_since_observed_,
+                                         transaction_counts_mutex_);
+      });
   if (!execution_result.Successful()) {
     DecrementActiveTransactionsCount(active_transactions_count_,
                                      max_transactions_since_observed_,
@@ -360,9 +368,7 @@ ExecutionResult TransactionManager::ExecutePhase(
 
   function<void()> task = [this, transaction_phase_context]() mutable {
     if (metric_router_) {
-      std::map<std::string, std::string> metric_labels = {
-          {kMetricLabelPartitionId, ToString(partition_id_)}};
-      received_transactions_instrument_->Add(1, metric_labels);
+      received_transactions_instrument_->Add(1, *partition_metric_attributes_);
     }
 
     active_transactions_metric_->Increment(kMetricEventReceivedTransaction);
@@ -380,9 +386,8 @@ ExecutionResult TransactionManager::ExecutePhase(
           transaction_phase_context.Finish();
 
           if (metric_router_) {
-            std::map<std::string, std::string> metric_labels = {
-                {kMetricLabelPartitionId, ToString(partition_id_)}};
-            finished_transactions_instrument_->Add(1, metric_labels);
+            finished_transactions_instrument_->Add(
+                1, *partition_metric_attributes_);
           }
 
           active_transactions_metric_->Increment(
@@ -404,8 +409,18 @@ ExecutionResult TransactionManager::ExecutePhase(
     }
   };
 
-  auto execution_result =
-      async_executor_->Schedule(task, AsyncPriority::Normal);
+  // A request still queued past its expiration would finish too late for its
+  // caller, so it is failed without spending any work on it.
+  auto execution_result = async_executor_->ScheduleWithDeadline(
+      task, AsyncPriority::Normal, transaction_phase_context.expiration_time,
+      [this, transaction_phase_context]() mutable {
+        transaction_phase_context.result = RetryExecutionResult(
+            errors::SC_TRANSACTION_MANAGER_REQUEST_EXPIRED);
+        transaction_phase_context.Finish();
+        DecrementActiveTransactionsCount(active_transactions_count_,
+                                         max_transactions_since_observed_,
+                                         transaction_counts_mutex_);
+      });
   if (!execution_result.Successful()) {
     DecrementActiveTransactionsCount(active_transactions_count_,
                                      max_transactions_since_observed_,
@@ -424,6 +439,15 @@ ExecutionResult TransactionManager::Checkpoint(
   return transaction_engine_->Checkpoint(checkpoint_logs);
 }
 
+ExecutionResult TransactionManager::CheckpointLive(
+    shared_ptr<list<CheckpointLog>>& checkpoint_logs) noexcept {
+  if (!started_) {
+    return FailureExecutionResult(errors::SC_TRANSACTION_MANAGER_NOT_STARTED);
+  }
+
+  return transaction_engine_->Checkpoint(checkpoint_logs);
+}
+
 ExecutionResult TransactionManager::GetTransactionStatus(
     AsyncContext<GetTransactionStatusRequest, GetTransactionStatusResponse>&
         get_transaction_status_context) noexcept {
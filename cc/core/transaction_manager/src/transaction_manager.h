@@ -79,6 +79,9 @@ class TransactionManager : public TransactionManagerInterface {
   ExecutionResult Checkpoint(std::shared_ptr<std::list<CheckpointLog>>&
                                  checkpoint_logs) noexcept override;
 
+  ExecutionResult CheckpointLive(std::shared_ptr<std::list<CheckpointLog>>&
+                                     checkpoint_logs) noexcept override;
+
   ExecutionResult GetTransactionStatus(
       AsyncContext<GetTransactionStatusRequest, GetTransactionStatusResponse>&
           get_transaction_status_context) noexcept override;
@@ -188,6 +191,9 @@ class TransactionManager : public TransactionManagerInterface {
   std::shared_ptr<opentelemetry::metrics::Counter<uint64_t>>
       finished_transactions_instrument_;
 
+  // The partition id attribute of the transaction counts, bound once.
+  std::unique_ptr<MetricAttributes> partition_metric_attributes_;
+
   // The AggregateMetric instance for number of active transactions.
   std::shared_ptr<cpio::AggregateMetricInterface> active_transactions_metric_;
 
@@ -0,0 +1,284 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives the TransactionEngine end to end on an in-memory journal, and reports
+// the transactions per second, the mean latency of each phase and the heap
+// allocations per transaction.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "core/async_executor/src/async_executor.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/config_provider/mock/mock_config_provider.h"
+#include "core/journal_service/mock/mock_journal_service.h"
+#include "core/test/utils/allocation_tracker/allocation_tracker.h"
+#include "core/transaction_manager/mock/mock_transaction_command_serializer.h"
+#include "core/transaction_manager/src/transaction_engine.h"
+#include "public/cpio/mock/metric_client/mock_metric_client.h"
+
+namespace google::scp::core::test {
+
+using ::google::scp::core::common::TimeProvider;
+using ::google::scp::core::common::Uuid;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::google::scp::core::journal_service::mock::MockJournalService;
+using ::google::scp::core::transaction_manager::mock::
+    MockTransactionCommandSerializer;
+using ::google::scp::cpio::MockMetricClient;
+
+/// The phases whose latency is reported, in the order they execute.
+enum class BenchmarkPhase : size_t {
+  Begin = 0,
+  Prepare = 1,
+  Commit = 2,
+  Notify = 3,
+  End = 4,
+  Count = 5,
+};
+
+static constexpr char kPhaseLatencyKeys[][24] = {
+    "begin_latency_us", "prepare_latency_us", "commit_latency_us",
+    "notify_latency_us", "end_latency_us"};
+static constexpr char kAllocationsPerTransactionKey[] =
+    "allocations_per_transaction";
+static constexpr char kJournaledBytesPerTransactionKey[] =
+    "journaled_bytes_per_transaction";
+static constexpr size_t kAsyncExecutorQueueCap = 1 << 20;
+
+/// The steady timestamps at which the commands of a transaction first enter
+/// each phase, and at which the transaction finishes.
+struct PhaseTimestamps {
+  void Record(BenchmarkPhase phase) {
+    uint64_t expected = 0;
+    timestamps[static_cast<size_t>(phase)].compare_exchange_strong(
+        expected, TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks());
+  }
+
+  std::atomic<uint64_t> timestamps[static_cast<size_t>(BenchmarkPhase::Count)] =
+      {};
+};
+
+/**
+ * @brief Runs the transaction engine on the real async executor, with an
+ * in-memory journal which acknowledges the logs instead of writing them to
+ * blobs.
+ *
+ * The benchmark arguments are the commands per transaction, the bytes of each
+ * serialized command, the async executor threads and the transactions kept in
+ * flight.
+ */
+class TransactionEngineFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    command_count_ = state.range(0);
+    command_body_size_ = state.range(1);
+    max_in_flight_ = state.range(3);
+    in_flight_ = 0;
+    journaled_bytes_ = 0;
+    for (auto& latency : phase_latency_sum_) {
+      latency = 0;
+    }
+
+    async_executor_ =
+        std::make_shared<AsyncExecutor>(state.range(2), kAsyncExecutorQueueCap);
+    auto journal_service = std::make_shared<MockJournalService>();
+    journal_service->log_mock =
+        [this](AsyncContext<JournalLogRequest, JournalLogResponse>&
+                   log_context) {
+          journaled_bytes_ += log_context.request->data->length;
+          log_context.result = SuccessExecutionResult();
+          log_context.Finish();
+          return SuccessExecutionResult();
+        };
+    journal_service_ = journal_service;
+    auto serializer = std::make_shared<MockTransactionCommandSerializer>();
+    serializer->serialize_mock = [this](const Uuid&,
+                                        const std::shared_ptr<
+                                            TransactionCommand>&,
+                                        BytesBuffer& bytes_buffer) {
+      bytes_buffer = BytesBuffer(command_body_size_);
+      bytes_buffer.length = command_body_size_;
+      return SuccessExecutionResult();
+    };
+    serializer_ = serializer;
+    std::shared_ptr<AsyncExecutorInterface> async_executor = async_executor_;
+    transaction_engine_ = std::make_shared<TransactionEngine>(
+        async_executor, serializer_, journal_service_,
+        remote_transaction_manager_, std::make_shared<MockMetricClient>(),
+        std::make_shared<MockConfigProvider>());
+
+    async_executor_->Init();
+    async_executor_->Run();
+    journal_service_->Init();
+    journal_service_->Run();
+    transaction_engine_->Init();
+    transaction_engine_->Run();
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    transaction_engine_->Stop();
+    journal_service_->Stop();
+    async_executor_->Stop();
+    transaction_engine_ = nullptr;
+  }
+
+  /// @brief Builds a command whose every phase completes synchronously.
+  std::shared_ptr<TransactionCommand> CreateCommand(
+      const std::shared_ptr<PhaseTimestamps>& timestamps) {
+    auto command = std::make_shared<TransactionCommand>();
+    auto action_of = [timestamps](BenchmarkPhase phase) {
+      return [timestamps, phase](TransactionCommandCallback& callback) {
+        timestamps->Record(phase);
+        auto result = SuccessExecutionResult();
+        callback(result);
+        return SuccessExecutionResult();
+      };
+    };
+    command->begin = action_of(BenchmarkPhase::Begin);
+    command->prepare = action_of(BenchmarkPhase::Prepare);
+    command->commit = action_of(BenchmarkPhase::Commit);
+    command->notify = action_of(BenchmarkPhase::Notify);
+    command->abort = action_of(BenchmarkPhase::Notify);
+    command->end = action_of(BenchmarkPhase::End);
+    return command;
+  }
+
+  /// @brief Executes a transaction, blocking while the engine already has the
+  /// maximum transactions in flight.
+  void ExecuteTransaction() {
+    {
+      std::unique_lock<std::mutex> lock(in_flight_mutex_);
+      in_flight_condition_.wait(
+          lock, [this]() { return in_flight_ < max_in_flight_; });
+      in_flight_++;
+    }
+
+    auto timestamps = std::make_shared<PhaseTimestamps>();
+    AsyncContext<TransactionRequest, TransactionResponse> transaction_context;
+    transaction_context.request = std::make_shared<TransactionRequest>();
+    transaction_context.request->transaction_id = Uuid::GenerateUuid();
+    transaction_context.request->timeout_time =
+        (TimeProvider::GetSteadyTimestampInNanoseconds() +
+         std::chrono::seconds(60))
+            .count();
+    for (size_t i = 0; i < command_count_; ++i) {
+      transaction_context.request->commands.push_back(
+          CreateCommand(timestamps));
+    }
+    transaction_context.callback =
+        [this, timestamps](
+            AsyncContext<TransactionRequest, TransactionResponse>& context) {
+          if (!context.result.Successful()) {
+            failed_transactions_++;
+          }
+          OnTransactionFinished(*timestamps);
+        };
+
+    if (!transaction_engine_->Execute(transaction_context).Successful()) {
+      failed_transactions_++;
+      OnTransactionFinished(*timestamps);
+    }
+  }
+
+  /// @brief Adds the phase latencies of the transaction and releases its slot.
+  void OnTransactionFinished(PhaseTimestamps& timestamps) {
+    auto finish_timestamp =
+        TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+    for (size_t i = 0; i < static_cast<size_t>(BenchmarkPhase::Count); ++i) {
+      auto start = timestamps.timestamps[i].load();
+      uint64_t next = i + 1 < static_cast<size_t>(BenchmarkPhase::Count)
+                          ? timestamps.timestamps[i + 1].load()
+                          : finish_timestamp;
+      if (start != 0 && next >= start) {
+        phase_latency_sum_[i] += next - start;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(in_flight_mutex_);
+      in_flight_--;
+    }
+    in_flight_condition_.notify_all();
+  }
+
+  /// @brief Blocks until every transaction executed has finished.
+  void WaitForTransactions() {
+    std::unique_lock<std::mutex> lock(in_flight_mutex_);
+    in_flight_condition_.wait(lock, [this]() { return in_flight_ == 0; });
+  }
+
+  std::shared_ptr<AsyncExecutor> async_executor_;
+  std::shared_ptr<JournalServiceInterface> journal_service_;
+  std::shared_ptr<TransactionCommandSerializerInterface> serializer_;
+  std::shared_ptr<RemoteTransactionManagerInterface>
+      remote_transaction_manager_;
+  std::shared_ptr<TransactionEngine> transaction_engine_;
+
+  size_t command_count_ = 0;
+  size_t command_body_size_ = 0;
+  size_t max_in_flight_ = 0;
+
+  std::mutex in_flight_mutex_;
+  std::condition_variable in_flight_condition_;
+  size_t in_flight_ = 0;
+
+  std::atomic<uint64_t> journaled_bytes_{0};
+
+  std::atomic<uint64_t>
+      phase_latency_sum_[static_cast<size_t>(BenchmarkPhase::Count)] = {};
+  std::atomic<uint64_t> failed_transactions_{0};
+};
+
+BENCHMARK_DEFINE_F(TransactionEngineFixture, Execute)
+
+(benchmark::State& state) {
+  auto allocations_before = GetAllocationCount();
+  for (auto _ : state) {
+    ExecuteTransaction();
+  }
+  WaitForTransactions();
+  auto allocations = GetAllocationCount() - allocations_before;
+
+  if (failed_transactions_ > 0) {
+    state.SkipWithError("Some transactions failed.");
+    return;
+  }
+
+  auto transactions = static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations());
+  for (size_t i = 0; i < static_cast<size_t>(BenchmarkPhase::Count); ++i) {
+    state.counters[kPhaseLatencyKeys[i]] =
+        phase_latency_sum_[i].load() / transactions / 1000;
+  }
+  state.counters[kAllocationsPerTransactionKey] = allocations / transactions;
+  state.counters[kJournaledBytesPerTransactionKey] =
+      journaled_bytes_.load() / transactions;
+}
+
+// Commands per transaction, bytes per command, executor threads and
+// transactions in flight.
+BENCHMARK_REGISTER_F(TransactionEngineFixture, Execute)
+    ->ArgsProduct({{1, 4, 16}, {64, 4096}, {1, 4, 16}, {1, 64}})
+    ->UseRealTime();
+
+}  // namespace google::scp::core::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
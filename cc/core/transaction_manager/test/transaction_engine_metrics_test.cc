@@ -0,0 +1,88 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/transaction_manager/src/transaction_engine_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "core/telemetry/mock/in_memory_metric_router.h"
+#include "core/telemetry/src/common/metric_utils.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using std::make_shared;
+using std::map;
+using std::string;
+using std::chrono::milliseconds;
+
+namespace google::scp::core::test {
+namespace {
+opentelemetry::sdk::common::OrderedAttributeMap GetPhaseStageDimensions(
+    const string& phase, absl::string_view stage) {
+  const map<string, string> label_kv = {
+      {string(kTransactionEnginePhaseLabel), phase},
+      {string(kTransactionEngineStageLabel), string(stage)}};
+  return opentelemetry::sdk::common::OrderedAttributeMap(
+      opentelemetry::common::KeyValueIterableView<map<string, string>>(
+          label_kv));
+}
+
+TEST(TransactionEngineMetricsTest, RecordsPhaseStageHistograms) {
+  auto metric_router = make_shared<InMemoryMetricRouter>();
+  TransactionEngineMetrics metrics(metric_router);
+  EXPECT_SUCCESS(metrics.Init());
+
+  metrics.RecordPhaseStage("COMMIT", kTransactionEngineJournalingStage,
+                           milliseconds(2));
+  metrics.RecordPhaseStage("COMMIT", kTransactionEngineJournalingStage,
+                           milliseconds(3));
+  metrics.RecordPhaseStage("COMMIT", kTransactionEngineCommandExecutionStage,
+                           milliseconds(1));
+
+  auto data = metric_router->GetExportedData();
+  auto journaling_point_data = GetMetricPointData(
+      kTransactionEnginePhaseStageDurationMetric,
+      GetPhaseStageDimensions("COMMIT", kTransactionEngineJournalingStage),
+      data);
+  ASSERT_TRUE(journaling_point_data.has_value());
+  auto journaling_histogram =
+      std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+          journaling_point_data.value());
+  EXPECT_EQ(journaling_histogram.count_, 2);
+  EXPECT_DOUBLE_EQ(std::get<double>(journaling_histogram.sum_), 0.005);
+
+  auto command_execution_point_data =
+      GetMetricPointData(kTransactionEnginePhaseStageDurationMetric,
+                         GetPhaseStageDimensions(
+                             "COMMIT", kTransactionEngineCommandExecutionStage),
+                         data);
+  ASSERT_TRUE(command_execution_point_data.has_value());
+  EXPECT_EQ(std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+                command_execution_point_data.value())
+                .count_,
+            1);
+}
+
+TEST(TransactionEngineMetricsTest, RecordsNothingWithoutMetricRouter) {
+  TransactionEngineMetrics metrics(nullptr);
+  EXPECT_SUCCESS(metrics.Init());
+  metrics.RecordPhaseStage("COMMIT", kTransactionEngineJournalingStage,
+                           milliseconds(2));
+}
+}  // namespace
+}  // namespace google::scp::core::test
@@ -35,6 +35,7 @@
 #include "core/common/serialization/src/error_codes.h"
 #include "core/common/serialization/src/serialization.h"
 #include "core/config_provider/mock/mock_config_provider.h"
+#include "core/http2_client/src/error_codes.h"
 #include "core/interface/configuration_keys.h"
 #include "core/interface/logger_interface.h"
 #include "core/journal_service/mock/mock_journal_service.h"
@@ -573,6 +574,72 @@ TEST_F(TransactionEngineTest, VerifyPrepareOperation) {
   EXPECT_EQ(current_transaction->pending_callbacks, 0);
 }
 
+TEST_F(TransactionEngineTest, LocalTransactionFastPathSkipsJournaling) {
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetBool(
+      kTransactionManagerLocalTransactionFastPathEnabled, true);
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutorWithInternals>(2, 100);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  vector<TransactionPhase> logged_phases;
+  vector<TransactionPhase> executed_phases;
+  mock_transaction_engine.log_state_and_execute_distributed_phase_mock =
+      [&](TransactionPhase phase, shared_ptr<Transaction>&) {
+        logged_phases.push_back(phase);
+        return SuccessExecutionResult();
+      };
+  mock_transaction_engine.log_state_and_proceed_to_next_phase_mock =
+      [&](TransactionPhase phase, shared_ptr<Transaction>&) {
+        logged_phases.push_back(phase);
+        return SuccessExecutionResult();
+      };
+  mock_transaction_engine.execute_distributed_phase_mock =
+      [&](TransactionPhase phase, shared_ptr<Transaction>&) {
+        executed_phases.push_back(phase);
+      };
+  mock_transaction_engine.proceed_to_next_phase_mock =
+      [&](TransactionPhase phase, shared_ptr<Transaction>&) {
+        executed_phases.push_back(phase);
+      };
+
+  auto transaction = make_shared<Transaction>();
+  transaction->is_coordinated_remotely = false;
+  mock_transaction_engine.PrepareTransaction(transaction);
+  mock_transaction_engine.CommitTransaction(transaction);
+  mock_transaction_engine.CommitNotifyTransaction(transaction);
+  mock_transaction_engine.CommittedTransaction(transaction);
+  mock_transaction_engine.EndTransaction(transaction);
+  EXPECT_EQ(logged_phases,
+            vector<TransactionPhase>({TransactionPhase::Commit,
+                                      TransactionPhase::CommitNotify,
+                                      TransactionPhase::End}));
+  EXPECT_EQ(executed_phases,
+            vector<TransactionPhase>(
+                {TransactionPhase::Prepare, TransactionPhase::Committed}));
+
+  // The remotely coordinated transactions journal every phase.
+  logged_phases.clear();
+  executed_phases.clear();
+  transaction->is_coordinated_remotely = true;
+  mock_transaction_engine.PrepareTransaction(transaction);
+  mock_transaction_engine.CommittedTransaction(transaction);
+  EXPECT_EQ(logged_phases,
+            vector<TransactionPhase>(
+                {TransactionPhase::Prepare, TransactionPhase::Committed}));
+  EXPECT_EQ(executed_phases.size(), 0);
+}
+
 void VerifyDispatchedOperations(
     TransactionPhase previous_phase, TransactionPhase current_phase,
     TransactionCommand transaction_command,
@@ -2197,6 +2264,95 @@ TEST_F(TransactionEngineTest,
                   core::errors::SC_TRANSACTION_MANAGER_TRANSACTION_NOT_FOUND)));
 }
 
+TEST_F(TransactionEngineTest, InitializeTransactionReusesReleasedTransactions) {
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetInt(kTransactionManagerTransactionPoolSize, 1);
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutorWithInternals>(2, 100);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  AsyncContext<TransactionRequest, TransactionResponse> transaction_context;
+  transaction_context.request = make_shared<TransactionRequest>();
+  transaction_context.request->transaction_id = Uuid::GenerateUuid();
+  transaction_context.request->is_coordinated_remotely = true;
+  transaction_context.request->transaction_secret = make_shared<string>("1");
+  transaction_context.request->transaction_origin = make_shared<string>("2");
+
+  shared_ptr<Transaction> transaction;
+  EXPECT_SUCCESS(mock_transaction_engine.InitializeTransaction(
+      transaction_context, transaction));
+  auto* transaction_address = transaction.get();
+  transaction->current_phase = TransactionPhase::Commit;
+  transaction->pending_callbacks = 3;
+  transaction->transaction_failed = true;
+  transaction->current_phase_failed = true;
+  transaction->current_phase_failed_command_indices.TryEnqueue(1);
+  transaction->blocked = true;
+
+  EXPECT_SUCCESS(mock_transaction_engine.GetActiveTransactionsMap().Erase(
+      transaction->id));
+  transaction = nullptr;
+
+  // The released transaction is reused for the next one, without any state of
+  // the previous one.
+  transaction_context.request = make_shared<TransactionRequest>();
+  transaction_context.request->transaction_id = Uuid::GenerateUuid();
+  EXPECT_SUCCESS(mock_transaction_engine.InitializeTransaction(
+      transaction_context, transaction));
+  EXPECT_EQ(transaction.get(), transaction_address);
+  EXPECT_EQ(transaction->id, transaction_context.request->transaction_id);
+  EXPECT_EQ(transaction->current_phase, TransactionPhase::NotStarted);
+  EXPECT_EQ(transaction->pending_callbacks, 0);
+  EXPECT_FALSE(transaction->transaction_failed);
+  EXPECT_FALSE(transaction->current_phase_failed);
+  EXPECT_EQ(transaction->current_phase_failed_command_indices.Size(), 0);
+  EXPECT_FALSE(transaction->is_coordinated_remotely);
+  EXPECT_EQ(transaction->transaction_secret, nullptr);
+  EXPECT_EQ(transaction->transaction_origin, nullptr);
+  EXPECT_FALSE(transaction->blocked);
+  EXPECT_TRUE(transaction->is_loaded);
+}
+
+TEST_F(TransactionEngineTest, InitializeTransactionSamplesTransactions) {
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetInt(kTransactionManagerTelemetrySamplingPeriod, 3);
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutorWithInternals>(2, 100);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  vector<bool> sampled;
+  for (int i = 0; i < 6; ++i) {
+    AsyncContext<TransactionRequest, TransactionResponse> transaction_context;
+    transaction_context.request = make_shared<TransactionRequest>();
+    transaction_context.request->transaction_id = Uuid::GenerateUuid();
+    shared_ptr<Transaction> transaction;
+    EXPECT_SUCCESS(mock_transaction_engine.InitializeTransaction(
+        transaction_context, transaction));
+    sampled.push_back(transaction->is_sampled);
+  }
+  EXPECT_EQ(sampled, vector<bool>({true, false, false, true, false, false}));
+}
+
 TEST_F(TransactionEngineTest,
        OnJournalServiceRecoverCallbackTransactionNotFoundOnEndPhase) {
   shared_ptr<JournalServiceInterface> mock_journal_service =
@@ -2581,6 +2737,94 @@ TEST_F(TransactionEngineTest, LogStateAndProceedToNextPhase) {
             SuccessExecutionResult());
 }
 
+TEST_F(TransactionEngineTest, LogStateInBatches) {
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetBool(kTransactionManagerBatchPhaseLogs, true);
+  auto mock_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<AsyncExecutorInterface> async_executor =
+      make_shared<MockAsyncExecutorWithInternals>(2, 100);
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  vector<shared_ptr<Transaction>> transactions;
+  for (int i = 0; i < 3; ++i) {
+    AsyncContext<TransactionRequest, TransactionResponse> transaction_context;
+    transaction_context.request = make_shared<TransactionRequest>();
+    transaction_context.request->transaction_id = Uuid::GenerateUuid();
+    shared_ptr<Transaction> transaction;
+    EXPECT_SUCCESS(mock_transaction_engine.InitializeTransaction(
+        transaction_context, transaction));
+    transaction->current_phase = TransactionPhase::Commit;
+    transactions.push_back(transaction);
+  }
+  transactions[2]->transaction_failed = true;
+
+  vector<AsyncContext<JournalLogRequest, JournalLogResponse>>
+      journal_log_contexts;
+  mock_journal_service->log_mock =
+      [&](AsyncContext<JournalLogRequest, JournalLogResponse>&
+              journal_log_context) {
+        journal_log_contexts.push_back(journal_log_context);
+        return SuccessExecutionResult();
+      };
+  vector<Uuid> proceeded_transaction_ids;
+  mock_transaction_engine.proceed_to_next_phase_mock =
+      [&](TransactionPhase current_phase,
+          shared_ptr<Transaction>& transaction) {
+        EXPECT_EQ(current_phase, TransactionPhase::Commit);
+        proceeded_transaction_ids.push_back(transaction->id);
+      };
+
+  // The first state is journaled right away, the other ones wait for it.
+  for (auto& transaction : transactions) {
+    EXPECT_SUCCESS(mock_transaction_engine.LogStateAndProceedToNextPhase(
+        TransactionPhase::Commit, transaction));
+  }
+  EXPECT_EQ(journal_log_contexts.size(), 1);
+  EXPECT_EQ(proceeded_transaction_ids.size(), 0);
+
+  journal_log_contexts[0].result = SuccessExecutionResult();
+  journal_log_contexts[0].Finish();
+  EXPECT_EQ(proceeded_transaction_ids.size(), 1);
+  EXPECT_EQ(proceeded_transaction_ids[0], transactions[0]->id);
+  EXPECT_EQ(journal_log_contexts.size(), 2);
+
+  // A failed batch is journaled again.
+  journal_log_contexts[1].result = FailureExecutionResult(SC_UNKNOWN);
+  journal_log_contexts[1].Finish();
+  EXPECT_EQ(proceeded_transaction_ids.size(), 1);
+  EXPECT_EQ(journal_log_contexts.size(), 3);
+
+  journal_log_contexts[2].result = SuccessExecutionResult();
+  journal_log_contexts[2].Finish();
+  EXPECT_EQ(proceeded_transaction_ids.size(), 3);
+  EXPECT_EQ(proceeded_transaction_ids[1], transactions[1]->id);
+  EXPECT_EQ(proceeded_transaction_ids[2], transactions[2]->id);
+  EXPECT_EQ(journal_log_contexts.size(), 3);
+
+  // The batch recovers the states of both transactions.
+  for (auto& transaction : transactions) {
+    transaction->current_phase = TransactionPhase::Prepare;
+    transaction->transaction_failed = false;
+  }
+  EXPECT_SUCCESS(mock_transaction_engine.OnJournalServiceRecoverCallback(
+      journal_log_contexts[2].request->data, kDefaultUuid));
+  EXPECT_EQ(transactions[0]->current_phase, TransactionPhase::Prepare);
+  EXPECT_EQ(transactions[1]->current_phase, TransactionPhase::Commit);
+  EXPECT_FALSE(transactions[1]->transaction_failed);
+  EXPECT_EQ(transactions[2]->current_phase, TransactionPhase::Commit);
+  EXPECT_TRUE(transactions[2]->transaction_failed);
+}
+
 TEST_F(TransactionEngineTest, SerializeTransaction) {
   auto mock_journal_service = make_shared<MockJournalService>();
   shared_ptr<JournalServiceInterface> journal_service =
@@ -3059,6 +3303,204 @@ TEST_F(TransactionEngineTest, ResolveNonRemotelyCoordinatedTransaction) {
   }
 }
 
+TEST_F(TransactionEngineTest, ResolveExpiredTransactionsInBatches) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  vector<AsyncOperation> scheduled_work;
+  mock_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    scheduled_work.push_back(work);
+    return SuccessExecutionResult();
+  };
+  auto run_scheduled_work = [&](size_t index) {
+    auto work = scheduled_work[index];
+    work();
+  };
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetInt(kTransactionManagerExpiredTransactionBatchSize,
+                               3);
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  vector<Uuid> resolved_transaction_ids;
+  mock_transaction_engine.resolve_transaction_mock =
+      [&](shared_ptr<Transaction>& transaction) {
+        resolved_transaction_ids.push_back(transaction->id);
+        return SuccessExecutionResult();
+      };
+
+  // The transactions by deadline, the last one already ended.
+  vector<string> origins = {"b.com", "a.com", "b.com", "a.com", "a.com"};
+  vector<shared_ptr<Transaction>> transactions;
+  for (size_t i = 0; i < origins.size(); ++i) {
+    auto transaction = make_shared<Transaction>();
+    transaction->id = Uuid::GenerateUuid();
+    transaction->transaction_origin = make_shared<string>(origins[i]);
+    transaction->expiration_time = i + 1;
+    if (i + 1 < origins.size()) {
+      auto pair = make_pair(transaction->id, transaction);
+      mock_transaction_engine.GetActiveTransactionsMap().Insert(pair,
+                                                                transaction);
+    }
+    transactions.push_back(transaction);
+  }
+
+  // The garbage collection finds them in any order, and more than once.
+  for (auto index : {3, 0, 4, 2, 1, 0}) {
+    mock_transaction_engine.OnBeforeGarbageCollection(
+        transactions[index]->id, transactions[index], [](bool) {});
+  }
+  EXPECT_EQ(resolved_transaction_ids.size(), 0);
+  ASSERT_EQ(scheduled_work.size(), 1);
+
+  // The earliest deadlines first, grouped by origin.
+  run_scheduled_work(0);
+  EXPECT_EQ(resolved_transaction_ids,
+            vector<Uuid>({transactions[1]->id, transactions[0]->id,
+                          transactions[2]->id}));
+  ASSERT_EQ(scheduled_work.size(), 2);
+
+  run_scheduled_work(1);
+  EXPECT_EQ(resolved_transaction_ids.size(), 4);
+  EXPECT_EQ(resolved_transaction_ids[3], transactions[3]->id);
+  EXPECT_EQ(scheduled_work.size(), 2);
+
+  // The next garbage collection pass indexes them again.
+  mock_transaction_engine.OnBeforeGarbageCollection(
+      transactions[0]->id, transactions[0], [](bool) {});
+  ASSERT_EQ(scheduled_work.size(), 3);
+  run_scheduled_work(2);
+  EXPECT_EQ(resolved_transaction_ids.size(), 5);
+  EXPECT_EQ(resolved_transaction_ids[4], transactions[0]->id);
+}
+
+TEST_F(TransactionEngineTest,
+       ResolveExpiredTransactionsWithBatchedRemoteStatus) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  vector<AsyncOperation> scheduled_work;
+  mock_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    scheduled_work.push_back(work);
+    return SuccessExecutionResult();
+  };
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+  auto mock_remote_transaction_manager =
+      make_shared<MockRemoteTransactionManager>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager =
+      mock_remote_transaction_manager;
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetInt(kTransactionManagerExpiredTransactionBatchSize,
+                               10);
+  mock_config_provider->SetBool(
+      kTransactionManagerBatchRemoteTransactionStatusEnabled, true);
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  auto index_expired_transactions = [&]() {
+    vector<shared_ptr<Transaction>> transactions;
+    for (size_t i = 0; i < 3; ++i) {
+      auto transaction = make_shared<Transaction>();
+      transaction->id = Uuid::GenerateUuid();
+      transaction->is_coordinated_remotely = true;
+      transaction->is_waiting_for_remote = true;
+      transaction->transaction_secret = make_shared<string>("secret");
+      transaction->transaction_origin = make_shared<string>("origin.com");
+      transaction->expiration_time = i + 1;
+      auto pair = make_pair(transaction->id, transaction);
+      mock_transaction_engine.GetActiveTransactionsMap().Insert(pair,
+                                                                transaction);
+      mock_transaction_engine.OnBeforeGarbageCollection(
+          transaction->id, transaction, [](bool) {});
+      transactions.push_back(transaction);
+    }
+    return transactions;
+  };
+
+  vector<Uuid> unlocked_transaction_ids;
+  mock_transaction_engine.unlock_remotely_coordinated_transaction_mock =
+      [&](shared_ptr<Transaction>& transaction) {
+        unlocked_transaction_ids.push_back(transaction->id);
+        return SuccessExecutionResult();
+      };
+  vector<Uuid> not_found_transaction_ids;
+  mock_transaction_engine.on_remote_transaction_not_found =
+      [&](auto& transaction, auto& context) {
+        not_found_transaction_ids.push_back(transaction->id);
+      };
+  vector<Uuid> inquired_transaction_ids;
+  mock_remote_transaction_manager->get_transaction_status_mock =
+      [&](AsyncContext<GetTransactionStatusRequest,
+                       GetTransactionStatusResponse>& context) {
+        inquired_transaction_ids.push_back(context.request->transaction_id);
+        return SuccessExecutionResult();
+      };
+
+  // The first is not expired on the remote, the second is not found there and
+  // the third is missing from the response, so it is inquired on its own.
+  auto transactions = index_expired_transactions();
+  size_t batch_count = 0;
+  mock_remote_transaction_manager->batch_get_transaction_status_mock =
+      [&](AsyncContext<BatchGetTransactionStatusRequest,
+                       BatchGetTransactionStatusResponse>& context) {
+        batch_count++;
+        EXPECT_EQ(*context.request->transaction_origin, "origin.com");
+        EXPECT_EQ(context.request->transactions.size(), 3);
+        context.response = make_shared<BatchGetTransactionStatusResponse>();
+        context.response->results.resize(2);
+        context.response->results[0].transaction_id =
+            context.request->transactions[0].transaction_id;
+        context.response->results[0].result = SuccessExecutionResult();
+        context.response->results[0].status.is_expired = false;
+        context.response->results[1].transaction_id =
+            context.request->transactions[1].transaction_id;
+        context.response->results[1].result = FailureExecutionResult(
+            errors::SC_TRANSACTION_MANAGER_TRANSACTION_NOT_FOUND);
+        context.result = SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+  ASSERT_EQ(scheduled_work.size(), 1);
+  scheduled_work[0]();
+  EXPECT_EQ(batch_count, 1);
+  EXPECT_EQ(unlocked_transaction_ids, vector<Uuid>({transactions[0]->id}));
+  EXPECT_EQ(not_found_transaction_ids, vector<Uuid>({transactions[1]->id}));
+  EXPECT_EQ(inquired_transaction_ids, vector<Uuid>({transactions[2]->id}));
+
+  // A remote coordinator without batches has them inquired one by one.
+  inquired_transaction_ids.clear();
+  transactions = index_expired_transactions();
+  mock_remote_transaction_manager->batch_get_transaction_status_mock =
+      [&](AsyncContext<BatchGetTransactionStatusRequest,
+                       BatchGetTransactionStatusResponse>& context) {
+        batch_count++;
+        return FailureExecutionResult(
+            errors::SC_HTTP2_CLIENT_HTTP_STATUS_NOT_FOUND);
+      };
+  ASSERT_EQ(scheduled_work.size(), 2);
+  scheduled_work[1]();
+  EXPECT_EQ(batch_count, 2);
+  EXPECT_EQ(inquired_transaction_ids,
+            vector<Uuid>({transactions[0]->id, transactions[1]->id,
+                          transactions[2]->id}));
+}
+
 TEST_F(TransactionEngineTest,
        ResolveRemotelyCoordinatedTransactionPendingCallback) {
   auto mock_journal_service = make_shared<MockJournalService>();
@@ -4959,6 +5401,79 @@ TEST_F(TransactionEngineTest, ExecuteDistributedPhaseWithDispatchError) {
   EXPECT_EQ(transaction->current_phase_failed_command_indices.Size(), 50);
 }
 
+TEST_F(TransactionEngineTest, ExecuteDistributedPhaseInParallel) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  size_t scheduled_count = 0;
+  mock_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    scheduled_count++;
+    work();
+    return SuccessExecutionResult();
+  };
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetInt(kTransactionManagerCommandDispatchFanOut, 2);
+  MockTransactionEngine mock_transaction_engine(
+      async_executor, mock_transaction_command_serializer, journal_service,
+      remote_transaction_manager, mock_metric_client, mock_config_provider);
+  EXPECT_SUCCESS(mock_transaction_engine.Init());
+
+  size_t proceeded_count = 0;
+  mock_transaction_engine.proceed_to_next_phase_mock =
+      [&](TransactionPhase, shared_ptr<Transaction>&) { proceeded_count++; };
+
+  auto transaction = make_shared<Transaction>();
+  transaction->current_phase = TransactionPhase::Prepare;
+  transaction->context.request = make_shared<TransactionRequest>();
+
+  // The commands hold their callbacks until the test completes them, and the
+  // fourth one fails to dispatch.
+  vector<size_t> dispatched_indices;
+  vector<TransactionCommandCallback> callbacks(5);
+  for (size_t i = 0; i < callbacks.size(); ++i) {
+    TransactionCommand command;
+    command.prepare = [&, index = i](TransactionCommandCallback& callback) {
+      dispatched_indices.push_back(index);
+      if (index == 3) {
+        return ExecutionResult(FailureExecutionResult(123));
+      }
+      callbacks[index] = callback;
+      return SuccessExecutionResult();
+    };
+    transaction->context.request->commands.push_back(
+        make_shared<TransactionCommand>(command));
+  }
+
+  mock_transaction_engine.ExecuteDistributedPhase(TransactionPhase::Prepare,
+                                                  transaction);
+  EXPECT_EQ(dispatched_indices, vector<size_t>({0, 1}));
+  EXPECT_EQ(scheduled_count, 2);
+
+  ExecutionResult execution_result = SuccessExecutionResult();
+  callbacks[1](execution_result);
+  EXPECT_EQ(dispatched_indices, vector<size_t>({0, 1, 2}));
+
+  // The failed dispatch is counted as done and the next command takes its
+  // place.
+  callbacks[2](execution_result);
+  EXPECT_EQ(dispatched_indices, vector<size_t>({0, 1, 2, 3, 4}));
+  EXPECT_EQ(proceeded_count, 0);
+
+  callbacks[4](execution_result);
+  EXPECT_EQ(proceeded_count, 0);
+  callbacks[0](execution_result);
+  EXPECT_EQ(proceeded_count, 1);
+  EXPECT_EQ(transaction->current_phase_failed.load(), true);
+  EXPECT_EQ(transaction->current_phase_failed_command_indices.Size(), 1);
+}
+
 TEST_F(TransactionEngineTest,
        GetPendingTransactionCountReturnsZeroWhenNoTransactions) {
   EXPECT_SUCCESS(mock_transaction_engine_->Init());
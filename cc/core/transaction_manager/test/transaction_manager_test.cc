@@ -320,6 +320,63 @@ TEST_F(TransactionManagerTests, ExecuteValidation) {
   }
 }
 
+TEST_F(TransactionManagerTests, ExpiredRequestIsNotExecuted) {
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer,
+      mock_journal_service, remote_transaction_manager, mock_metric_client);
+  mock_transaction_engine->init_mock = []() {
+    return SuccessExecutionResult();
+  };
+  mock_transaction_engine->run_mock = []() {
+    return SuccessExecutionResult();
+  };
+  mock_transaction_engine->stop_mock = []() {
+    return SuccessExecutionResult();
+  };
+  atomic<bool> transaction_logged = false;
+  mock_transaction_engine->log_transaction_and_proceed_to_next_phase_mock =
+      [&](auto next_phase, auto transaction) {
+        transaction_logged = true;
+        return SuccessExecutionResult();
+      };
+  mock_async_executor->schedule_mock = [](const AsyncOperation& work) {
+    work();
+    return SuccessExecutionResult();
+  };
+  MockTransactionManager transaction_manager(
+      mock_async_executor, mock_transaction_engine, 1000, mock_metric_client);
+  EXPECT_SUCCESS(transaction_manager.Init());
+  EXPECT_SUCCESS(transaction_manager.Run());
+
+  AsyncContext<TransactionRequest, TransactionResponse> transaction_context;
+  transaction_context.request = make_shared<TransactionRequest>();
+  transaction_context.request->transaction_id = Uuid::GenerateUuid();
+  // Already past.
+  transaction_context.expiration_time = 1;
+  atomic<bool> finished = false;
+  transaction_context.callback = [&](auto& context) {
+    EXPECT_THAT(context.result,
+                ResultIs(RetryExecutionResult(
+                    errors::SC_TRANSACTION_MANAGER_REQUEST_EXPIRED)));
+    finished = true;
+  };
+  EXPECT_SUCCESS(transaction_manager.Execute(transaction_context));
+  EXPECT_TRUE(finished);
+  EXPECT_FALSE(transaction_logged);
+  EXPECT_EQ(transaction_manager.GetActiveTransactionsCount(), 0);
+  EXPECT_SUCCESS(transaction_manager.Stop());
+}
+
 TEST_F(TransactionManagerTests, StopValidation) {
   auto mock_metric_client = make_shared<MockMetricClient>();
   auto mock_async_executor = make_shared<MockAsyncExecutor>();
@@ -418,6 +475,44 @@ TEST_F(TransactionManagerTests, CannotCheckpointIfRunning) {
   transaction_manager.Stop();
 }
 
+TEST_F(TransactionManagerTests, CanOnlyCheckpointLiveIfRunning) {
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client);
+  shared_ptr<TransactionEngineInterface> transaction_engine =
+      mock_transaction_engine;
+  mock_transaction_engine->init_mock = []() {
+    return SuccessExecutionResult();
+  };
+  mock_transaction_engine->run_mock = []() { return SuccessExecutionResult(); };
+  mock_transaction_engine->stop_mock = []() {
+    return SuccessExecutionResult();
+  };
+
+  MockTransactionManager transaction_manager(async_executor, transaction_engine,
+                                             1, mock_metric_client);
+  transaction_manager.Init();
+  auto checkpoint_logs = make_shared<list<CheckpointLog>>();
+  EXPECT_THAT(transaction_manager.CheckpointLive(checkpoint_logs),
+              ResultIs(FailureExecutionResult(
+                  errors::SC_TRANSACTION_MANAGER_NOT_STARTED)));
+
+  transaction_manager.Run();
+  EXPECT_SUCCESS(transaction_manager.CheckpointLive(checkpoint_logs));
+
+  transaction_manager.Stop();
+}
+
 TEST_F(TransactionManagerTests,
        GetStatusReturnsFailureIfTransactionManagerHasNotStarted) {
   GetTransactionManagerStatusRequest request;
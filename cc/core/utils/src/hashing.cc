@@ -20,6 +20,7 @@
 #include <string>
 
 #include <openssl/md5.h>
+#include <openssl/sha.h>
 
 #include "core/interface/type_def.h"
 
@@ -59,6 +60,18 @@ ExecutionResultOr<string> CalculateMd5Hash(const string& buffer) {
   return string(reinterpret_cast<char*>(digest_length), MD5_DIGEST_LENGTH);
 }
 
+ExecutionResultOr<string> CalculateSha256Hash(const string& buffer) {
+  if (buffer.length() == 0) {
+    return FailureExecutionResult(errors::SC_CORE_UTILS_INVALID_INPUT);
+  }
+
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const unsigned char*>(buffer.data()),
+         buffer.length(), digest);
+
+  return string(reinterpret_cast<char*>(digest), SHA256_DIGEST_LENGTH);
+}
+
 ExecutionResult CalculateMd5Hash(const BytesBuffer& buffer, string& checksum) {
   ASSIGN_OR_RETURN(checksum, CalculateMd5Hash(buffer));
   return SuccessExecutionResult();
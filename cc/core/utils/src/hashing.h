@@ -34,6 +34,14 @@ ExecutionResultOr<std::string> CalculateMd5Hash(const BytesBuffer& buffer);
 // Same as above but accepts a string.
 ExecutionResultOr<std::string> CalculateMd5Hash(const std::string& buffer);
 
+/**
+ * @brief Calculates SHA-256 hash of the input data as a binary string.
+ *
+ * @param buffer The buffer to calculate the hash.
+ * @return ExecutionResultOr<string> The 32 bytes digest.
+ */
+ExecutionResultOr<std::string> CalculateSha256Hash(const std::string& buffer);
+
 // DEPRECATED, please use the above options.
 ExecutionResult CalculateMd5Hash(const BytesBuffer& buffer,
                                  std::string& checksum);
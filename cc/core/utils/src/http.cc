@@ -15,12 +15,15 @@
  */
 #include "http.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <curl/curl.h>
+#include <nghttp2/nghttp2.h>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
@@ -75,4 +78,19 @@ ExecutionResultOr<absl::string_view> ExtractRequestClaimedIdentity(
   }
   return header_iter->second;
 }
+
+BodyDataGenerator MakeBodyDataGenerator(const BytesBuffer& body) noexcept {
+  return [body, offset = static_cast<size_t>(0)](
+             uint8_t* buffer, size_t length, uint32_t* flags) mutable {
+    auto count = std::min(length, body.length - offset);
+    if (count > 0) {
+      std::memcpy(buffer, body.bytes->data() + offset, count);
+      offset += count;
+    }
+    if (offset == body.length) {
+      *flags |= NGHTTP2_DATA_FLAG_EOF;
+    }
+    return static_cast<ssize_t>(count);
+  };
+}
 }  // namespace google::scp::core::utils
@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <sys/types.h>
+
+#include <cstdint>
+#include <functional>
 #include <string>
 
 #include "core/interface/http_client_interface.h"
@@ -46,4 +50,19 @@ ExecutionResultOr<std::string> GetEscapedUriWithQuery(
  */
 ExecutionResultOr<absl::string_view> ExtractRequestClaimedIdentity(
     const core::HttpHeaders& request_headers) noexcept;
+
+/// The data generator nghttp2 pulls a request or response body from.
+using BodyDataGenerator =
+    std::function<ssize_t(uint8_t* buffer, size_t length, uint32_t* flags)>;
+
+/**
+ * @brief Makes a data generator reading the body in place, so that nghttp2
+ * copies it straight into its frames instead of from a string copy of it. The
+ * generator shares the bytes of the body, which must not change until it has
+ * been read.
+ *
+ * @param body The body to send.
+ * @return BodyDataGenerator The generator of the body.
+ */
+BodyDataGenerator MakeBodyDataGenerator(const BytesBuffer& body) noexcept;
 }  // namespace google::scp::core::utils
@@ -87,4 +87,23 @@ TEST(HashingTest, ValidMD5HashStringOLD) {
   EXPECT_EQ(md5_hash, "!\x87\x9D\x8C\x7Fy\x93j\xCD\xB6\xE2\x86&\xEA\x1B\xD8");
 }
 
+TEST(HashingTest, InvalidSha256HashString) {
+  string empty;
+
+  EXPECT_THAT(
+      CalculateSha256Hash(empty),
+      ResultIs(FailureExecutionResult(errors::SC_CORE_UTILS_INVALID_INPUT)));
+}
+
+TEST(HashingTest, ValidSha256HashString) {
+  // The digest has a null byte.
+  string expected_digest(
+      "\xBA\x78\x16\xBF\x8F\x01\xCF\xEA\x41\x41\x40\xDE\x5D\xAE\x22\x23"
+      "\xB0\x03\x61\xA3\x96\x17\x7A\x9C\xB4\x10\xFF\x61\xF2\x00\x15\xAD",
+      32);
+
+  EXPECT_THAT(CalculateSha256Hash("abc"),
+              IsSuccessfulAndHolds(expected_digest));
+}
+
 }  // namespace google::scp::core::utils::test
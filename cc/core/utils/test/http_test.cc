@@ -14,6 +14,8 @@
 
 #include "cc/core/utils/src/http.h"
 
+#include <nghttp2/nghttp2.h>
+
 #include <algorithm>
 #include <string>
 
@@ -58,4 +60,32 @@ TEST(HttpTest, HeaderFound) {
   EXPECT_TRUE(extraction_result.Successful());
   EXPECT_EQ(extraction_result.value(), claimed_identity);
 }
+
+TEST(HttpTest, BodyDataGeneratorReadsTheBodyInChunks) {
+  std::string body_string = "0123456789";
+  BytesBuffer body(body_string);
+  // Bytes past the length are not part of the body.
+  body.bytes->push_back('X');
+  auto generator = utils::MakeBodyDataGenerator(body);
+
+  std::string generated;
+  uint32_t flags = 0;
+  uint8_t buffer[4];
+  while (!(flags & NGHTTP2_DATA_FLAG_EOF)) {
+    auto count = generator(buffer, sizeof(buffer), &flags);
+    ASSERT_GT(count, 0);
+    generated.append(reinterpret_cast<char*>(buffer), count);
+  }
+  EXPECT_EQ(generated, body_string);
+  // The generator shares the bytes instead of copying them.
+  EXPECT_EQ(body.bytes.use_count(), 2);
+}
+
+TEST(HttpTest, BodyDataGeneratorOfEmptyBody) {
+  auto generator = utils::MakeBodyDataGenerator(BytesBuffer());
+  uint32_t flags = 0;
+  uint8_t buffer[4];
+  EXPECT_EQ(generator(buffer, sizeof(buffer), &flags), 0);
+  EXPECT_TRUE(flags & NGHTTP2_DATA_FLAG_EOF);
+}
 }  // namespace google::scp::core
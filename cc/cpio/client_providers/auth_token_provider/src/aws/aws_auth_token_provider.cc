@@ -56,13 +56,20 @@ constexpr char kTokenServerPath[] = "http://169.254.169.254/latest/api/token";
 constexpr char kTokenTtlInSecondHeader[] =
     "X-aws-ec2-metadata-token-ttl-seconds";
 constexpr int kTokenTtlInSecondHeaderValue = 21600;
+// There is a single session token per instance.
+constexpr char kSessionTokenCacheKey[] = "";
 
 }  // namespace
 
 namespace google::scp::cpio::client_providers {
 AwsAuthTokenProvider::AwsAuthTokenProvider(
     const shared_ptr<HttpClientInterface>& http_client)
-    : http_client_(http_client) {}
+    : http_client_(http_client),
+      session_token_cache_(
+          bind(&AwsAuthTokenProvider::FetchSessionToken, this, _1),
+          [](const GetSessionTokenResponse& response) {
+            return response.token_lifetime_in_seconds;
+          }) {}
 
 ExecutionResult AwsAuthTokenProvider::Init() noexcept {
   if (!http_client_) {
@@ -81,12 +88,19 @@ ExecutionResult AwsAuthTokenProvider::Run() noexcept {
 }
 
 ExecutionResult AwsAuthTokenProvider::Stop() noexcept {
+  session_token_cache_.Stop();
   return SuccessExecutionResult();
 }
 
 ExecutionResult AwsAuthTokenProvider::GetSessionToken(
     AsyncContext<GetSessionTokenRequest, GetSessionTokenResponse>&
         get_token_context) noexcept {
+  return session_token_cache_.Get(kSessionTokenCacheKey, get_token_context);
+}
+
+ExecutionResult AwsAuthTokenProvider::FetchSessionToken(
+    AsyncContext<GetSessionTokenRequest, GetSessionTokenResponse>&
+        get_token_context) noexcept {
   AsyncContext<HttpRequest, HttpResponse> http_context;
   http_context.request = make_shared<HttpRequest>();
   http_context.request->method = HttpMethod::PUT;
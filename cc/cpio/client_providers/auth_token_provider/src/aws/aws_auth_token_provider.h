@@ -22,6 +22,7 @@
 #include "core/interface/async_context.h"
 #include "core/interface/http_client_interface.h"
 #include "cpio/client_providers/interface/auth_token_provider_interface.h"
+#include "cpio/common/src/refresh_ahead_cache.h"
 
 #include "error_codes.h"
 
@@ -49,6 +50,17 @@ class AwsAuthTokenProvider : public AuthTokenProviderInterface {
       override;
 
  private:
+  /**
+   * @brief Fetches a new session token from the metadata server.
+   *
+   * @param get_token_context The context of the get session token
+   * operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult FetchSessionToken(
+      core::AsyncContext<GetSessionTokenRequest, GetSessionTokenResponse>&
+          get_token_context) noexcept;
+
   /**
    * @brief Is called when the get session token operation is completed.
    *
@@ -64,5 +76,9 @@ class AwsAuthTokenProvider : public AuthTokenProviderInterface {
 
   /// Http client for issuing HTTP actions.
   std::shared_ptr<core::HttpClientInterface> http_client_;
+
+  /// The session token, refreshed ahead of its expiry.
+  common::RefreshAheadCache<GetSessionTokenRequest, GetSessionTokenResponse>
+      session_token_cache_;
 };
 }  // namespace google::scp::cpio::client_providers
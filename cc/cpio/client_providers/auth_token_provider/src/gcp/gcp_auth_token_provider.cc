@@ -78,6 +78,8 @@ constexpr char kIdentityServerPath[] =
 constexpr char kMetadataFlavorHeader[] = "Metadata-Flavor";
 constexpr char kMetadataFlavorHeaderValue[] = "Google";
 constexpr char kJsonAccessTokenKey[] = "access_token";
+// There is a single access token for the instance service account.
+constexpr char kSessionTokenCacheKey[] = "";
 constexpr char kJsonTokenExpiryKey[] = "expires_in";
 constexpr char kJsonTokenTypeKey[] = "token_type";
 constexpr char kAudienceParameter[] = "audience=";
@@ -122,7 +124,18 @@ const auto& GetRequiredJWTComponentsForTargetAudienceToken() {
 namespace google::scp::cpio::client_providers {
 GcpAuthTokenProvider::GcpAuthTokenProvider(
     const shared_ptr<HttpClientInterface>& http_client)
-    : http_client_(http_client) {}
+    : http_client_(http_client),
+      session_token_cache_(
+          bind(&GcpAuthTokenProvider::FetchSessionToken, this, _1),
+          [](const GetSessionTokenResponse& response) {
+            return response.token_lifetime_in_seconds;
+          }),
+      target_audience_token_cache_(
+          bind(&GcpAuthTokenProvider::FetchSessionTokenForTargetAudience, this,
+               _1),
+          [](const GetSessionTokenResponse& response) {
+            return response.token_lifetime_in_seconds;
+          }) {}
 
 ExecutionResult GcpAuthTokenProvider::Init() noexcept {
   if (!http_client_) {
@@ -141,12 +154,20 @@ ExecutionResult GcpAuthTokenProvider::Run() noexcept {
 }
 
 ExecutionResult GcpAuthTokenProvider::Stop() noexcept {
+  session_token_cache_.Stop();
+  target_audience_token_cache_.Stop();
   return SuccessExecutionResult();
 }
 
 ExecutionResult GcpAuthTokenProvider::GetSessionToken(
     AsyncContext<GetSessionTokenRequest, GetSessionTokenResponse>&
         get_token_context) noexcept {
+  return session_token_cache_.Get(kSessionTokenCacheKey, get_token_context);
+}
+
+ExecutionResult GcpAuthTokenProvider::FetchSessionToken(
+    AsyncContext<GetSessionTokenRequest, GetSessionTokenResponse>&
+        get_token_context) noexcept {
   // Make a request to the metadata server:
   // The Application is running on a GCP VM which runs as a service account.
   // Services which run on GCP also spin up a local metadata server which can be
@@ -242,6 +263,18 @@ void GcpAuthTokenProvider::OnGetSessionTokenCallback(
 ExecutionResult GcpAuthTokenProvider::GetSessionTokenForTargetAudience(
     AsyncContext<GetSessionTokenForTargetAudienceRequest,
                  GetSessionTokenResponse>& get_token_context) noexcept {
+  if (!get_token_context.request ||
+      !get_token_context.request->token_target_audience_uri) {
+    return FetchSessionTokenForTargetAudience(get_token_context);
+  }
+  return target_audience_token_cache_.Get(
+      *get_token_context.request->token_target_audience_uri,
+      get_token_context);
+}
+
+ExecutionResult GcpAuthTokenProvider::FetchSessionTokenForTargetAudience(
+    AsyncContext<GetSessionTokenForTargetAudienceRequest,
+                 GetSessionTokenResponse>& get_token_context) noexcept {
   // Make a request to the metadata server:
   // The PBS is running on a GCP VM which runs as a service account. Services
   // which run on GCP also spin up a local metadata server which can be
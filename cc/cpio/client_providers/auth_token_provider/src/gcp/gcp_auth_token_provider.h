@@ -22,6 +22,7 @@
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/http_client_interface.h"
 #include "cpio/client_providers/interface/auth_token_provider_interface.h"
+#include "cpio/common/src/refresh_ahead_cache.h"
 
 #include "error_codes.h"
 
@@ -49,6 +50,30 @@ class GcpAuthTokenProvider : public AuthTokenProviderInterface {
       override;
 
  private:
+  /**
+   * @brief Fetches a new access token for the current instance from the
+   * metadata server.
+   *
+   * @param get_token_context The context of the get session token
+   * operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult FetchSessionToken(
+      core::AsyncContext<GetSessionTokenRequest, GetSessionTokenResponse>&
+          get_token_context) noexcept;
+
+  /**
+   * @brief Fetches a new identity token for the target audience from the
+   * metadata server.
+   *
+   * @param get_token_context The context of the get session token
+   * operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult FetchSessionTokenForTargetAudience(
+      core::AsyncContext<GetSessionTokenForTargetAudienceRequest,
+                         GetSessionTokenResponse>& get_token_context) noexcept;
+
   /**
    * @brief Is called when the get session token from current instance operation
    * is completed.
@@ -79,5 +104,14 @@ class GcpAuthTokenProvider : public AuthTokenProviderInterface {
 
   /// HttpClient for issuing HTTP actions.
   std::shared_ptr<core::HttpClientInterface> http_client_;
+
+  /// The access token, refreshed ahead of its expiry.
+  common::RefreshAheadCache<GetSessionTokenRequest, GetSessionTokenResponse>
+      session_token_cache_;
+
+  /// The identity tokens per target audience, refreshed ahead of their expiry.
+  common::RefreshAheadCache<GetSessionTokenForTargetAudienceRequest,
+                            GetSessionTokenResponse>
+      target_audience_token_cache_;
 };
 }  // namespace google::scp::cpio::client_providers
@@ -123,6 +123,31 @@ TEST_F(AwsAuthTokenProviderTest,
   WaitUntil([&finished]() { return finished.load(); });
 }
 
+TEST_F(AwsAuthTokenProviderTest, GetSessionTokenIsServedFromCache) {
+  EXPECT_CALL(*http_client_, PerformRequest).WillOnce([](auto& http_context) {
+    http_context.result = SuccessExecutionResult();
+    http_context.response = make_shared<HttpResponse>();
+    http_context.response->body = BytesBuffer(kHttpResponseMock);
+    http_context.Finish();
+    return SuccessExecutionResult();
+  });
+
+  for (int i = 0; i < 2; i++) {
+    atomic_bool finished(false);
+    fetch_token_context_.callback = [&finished](auto& context) {
+      EXPECT_SUCCESS(context.result);
+      ASSERT_TRUE(context.response);
+      EXPECT_THAT(context.response->session_token,
+                  Pointee(Eq(kHttpResponseMock)));
+      finished = true;
+    };
+    EXPECT_THAT(authorizer_provider_->GetSessionToken(fetch_token_context_),
+                IsSuccessful());
+
+    WaitUntil([&finished]() { return finished.load(); });
+  }
+}
+
 TEST_F(AwsAuthTokenProviderTest, GetSessionTokenFailsIfHttpRequestFails) {
   EXPECT_CALL(*http_client_, PerformRequest).WillOnce([](auto& http_context) {
     http_context.result = FailureExecutionResult(SC_UNKNOWN);
@@ -18,11 +18,13 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <aws/core/Aws.h>
+#include <aws/core/http/HttpResponse.h>
 #include <aws/core/utils/Outcome.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/model/AbortMultipartUploadRequest.h>
@@ -36,6 +38,7 @@
 #include <aws/s3/model/UploadPartRequest.h>
 #include <google/protobuf/util/time_util.h>
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "core/async_executor/src/aws/aws_async_executor.h"
@@ -52,6 +55,7 @@ using Aws::String;
 using Aws::StringStream;
 using Aws::Client::AsyncCallerContext;
 using Aws::Client::ClientConfiguration;
+using Aws::Http::HttpResponseCode;
 using Aws::S3::S3Client;
 using Aws::S3::Model::AbortMultipartUploadOutcome;
 using Aws::S3::Model::AbortMultipartUploadRequest;
@@ -203,6 +207,17 @@ GetObjectRequest MakeGetObjectRequest(const ProtoRequest& proto_request,
   return get_object_request;
 }
 
+// Returns the size of the object from the ContentRange of a ranged
+// GetObject, which is of the form "bytes 0-83886079/1258291200".
+optional<int64_t> GetObjectSize(const String& content_range) {
+  vector<string> parts = absl::StrSplit(content_range, "/");
+  int64_t object_size;
+  if (parts.size() != 2 || !absl::SimpleAtoi(parts[1], &object_size)) {
+    return std::nullopt;
+  }
+  return object_size;
+}
+
 }  // namespace
 
 namespace google::scp::cpio::client_providers {
@@ -244,6 +259,26 @@ ExecutionResult AwsS3ClientProvider::GetBlob(
   const auto& request = *get_blob_context.request;
   RETURN_IF_FAILURE(ValidateGetBlobRequest(get_blob_context));
 
+  if (options_ && options_->get_blob_part_size_bytes > 0) {
+    // Downloads the first part alone, its response has the size of the object.
+    auto tracker = make_shared<GetBlobPartsTracker>(
+        request.has_byte_range() ? request.byte_range().begin_byte_index() : 0,
+        options_->get_blob_part_size_bytes);
+    int64_t end_index = tracker->begin_byte_index + tracker->part_size - 1;
+    if (request.has_byte_range()) {
+      end_index =
+          std::min<int64_t>(end_index, request.byte_range().end_byte_index());
+    }
+    s3_client_->GetObjectAsync(
+        MakeGetObjectRequest(request,
+                             absl::StrCat("bytes=", tracker->begin_byte_index,
+                                          "-", end_index)),
+        bind(&AwsS3ClientProvider::OnGetObjectFirstPartCallback, this,
+             get_blob_context, tracker, _1, _2, _3, _4),
+        nullptr);
+    return SuccessExecutionResult();
+  }
+
   optional<string> range;
   if (request.has_byte_range()) {
     // SetRange is inclusive on both ends.
@@ -299,6 +334,150 @@ void AwsS3ClientProvider::OnGetObjectCallback(
                 AsyncPriority::High);
 }
 
+void AwsS3ClientProvider::OnGetObjectFirstPartCallback(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    shared_ptr<GetBlobPartsTracker> tracker, const S3Client* s3_client,
+    const GetObjectRequest& get_object_request,
+    GetObjectOutcome get_object_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  const auto& request = *get_blob_context.request;
+  if (!get_object_outcome.IsSuccess()) {
+    // The ranges of an empty object are not satisfiable, it is downloaded
+    // in a single request instead.
+    if (!request.has_byte_range() &&
+        get_object_outcome.GetError().GetResponseCode() ==
+            HttpResponseCode::REQUESTED_RANGE_NOT_SATISFIABLE) {
+      s3_client_->GetObjectAsync(
+          MakeGetObjectRequest(request, std::nullopt),
+          bind(&AwsS3ClientProvider::OnGetObjectCallback, this,
+               get_blob_context, _1, _2, _3, _4),
+          nullptr);
+      return;
+    }
+    OnGetObjectCallback(get_blob_context, s3_client, get_object_request,
+                        move(get_object_outcome), async_context);
+    return;
+  }
+
+  auto& result = get_object_outcome.GetResult();
+  size_t content_length = result.GetContentLength();
+  auto object_size = GetObjectSize(result.GetContentRange());
+  if (!object_size.has_value()) {
+    get_blob_context.result =
+        FailureExecutionResult(SC_BLOB_STORAGE_PROVIDER_ERROR_GETTING_BLOB);
+    SCP_ERROR_CONTEXT(kAwsS3Provider, get_blob_context, get_blob_context.result,
+                      "Get blob response has an invalid content range: %s",
+                      result.GetContentRange().c_str());
+    FinishContext(get_blob_context.result, get_blob_context,
+                  cpu_async_executor_, AsyncPriority::High);
+    return;
+  }
+  // If the end index is beyond the size of the object, truncate to the end of
+  // the object.
+  int64_t end_index = *object_size - 1;
+  if (request.has_byte_range()) {
+    end_index =
+        std::min<int64_t>(end_index, request.byte_range().end_byte_index());
+  }
+  tracker->SetLength(end_index + 1 - tracker->begin_byte_index);
+
+  get_blob_context.response = make_shared<GetBlobResponse>();
+  get_blob_context.response->mutable_blob()->mutable_metadata()->CopyFrom(
+      request.blob_metadata());
+  auto& blob_bytes = *get_blob_context.response->mutable_blob()->mutable_data();
+  blob_bytes.resize(tracker->length);
+  tracker->data = blob_bytes.data();
+
+  if (content_length != tracker->GetPartSize(0) ||
+      !result.GetBody().read(tracker->data, content_length)) {
+    get_blob_context.result =
+        FailureExecutionResult(SC_BLOB_STORAGE_PROVIDER_ERROR_GETTING_BLOB);
+    SCP_ERROR_CONTEXT(kAwsS3Provider, get_blob_context, get_blob_context.result,
+                      "Reading the first part of the blob failed");
+    FinishContext(get_blob_context.result, get_blob_context,
+                  cpu_async_executor_, AsyncPriority::High);
+    return;
+  }
+
+  size_t max_concurrent_parts =
+      std::max<size_t>(1, options_->get_blob_max_concurrent_parts);
+  for (size_t i = 0; i < max_concurrent_parts; ++i) {
+    auto part_index = tracker->AcquireNextPart();
+    if (!part_index.has_value()) {
+      break;
+    }
+    GetObjectPart(get_blob_context, tracker, *part_index);
+  }
+  ReleaseGetObjectPart(get_blob_context, *tracker);
+}
+
+void AwsS3ClientProvider::GetObjectPart(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    shared_ptr<GetBlobPartsTracker> tracker, size_t part_index) noexcept {
+  int64_t begin_index =
+      tracker->begin_byte_index + tracker->GetPartOffset(part_index);
+  // SetRange is inclusive on both ends.
+  auto range = absl::StrCat("bytes=", begin_index, "-",
+                            begin_index + tracker->GetPartSize(part_index) - 1);
+  s3_client_->GetObjectAsync(
+      MakeGetObjectRequest(*get_blob_context.request, move(range)),
+      bind(&AwsS3ClientProvider::OnGetObjectPartCallback, this,
+           get_blob_context, tracker, part_index, _1, _2, _3, _4),
+      nullptr);
+}
+
+void AwsS3ClientProvider::OnGetObjectPartCallback(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    shared_ptr<GetBlobPartsTracker> tracker, size_t part_index,
+    const S3Client* s3_client, const GetObjectRequest& get_object_request,
+    GetObjectOutcome get_object_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  if (!get_object_outcome.IsSuccess()) {
+    auto execution_result = AwsS3Utils::ConvertS3ErrorToExecutionResult(
+        get_object_outcome.GetError().GetErrorType());
+    SCP_ERROR_CONTEXT(kAwsS3Provider, get_blob_context, execution_result,
+                      "Get blob part %zu failed. Error code: %d, message: %s",
+                      part_index,
+                      get_object_outcome.GetError().GetResponseCode(),
+                      get_object_outcome.GetError().GetMessage().c_str());
+    tracker->Fail(execution_result);
+    ReleaseGetObjectPart(get_blob_context, *tracker);
+    return;
+  }
+
+  auto& result = get_object_outcome.GetResult();
+  size_t content_length = result.GetContentLength();
+  if (content_length != tracker->GetPartSize(part_index) ||
+      !result.GetBody().read(
+          tracker->data + tracker->GetPartOffset(part_index),
+          content_length)) {
+    auto execution_result =
+        FailureExecutionResult(SC_BLOB_STORAGE_PROVIDER_ERROR_GETTING_BLOB);
+    SCP_ERROR_CONTEXT(kAwsS3Provider, get_blob_context, execution_result,
+                      "Reading part %zu of the blob failed", part_index);
+    tracker->Fail(execution_result);
+    ReleaseGetObjectPart(get_blob_context, *tracker);
+    return;
+  }
+
+  if (auto next_part_index = tracker->AcquireNextPart();
+      next_part_index.has_value()) {
+    GetObjectPart(get_blob_context, tracker, *next_part_index);
+  }
+  ReleaseGetObjectPart(get_blob_context, *tracker);
+}
+
+void AwsS3ClientProvider::ReleaseGetObjectPart(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    GetBlobPartsTracker& tracker) noexcept {
+  if (!tracker.Release()) {
+    return;
+  }
+  get_blob_context.result = tracker.result;
+  FinishContext(get_blob_context.result, get_blob_context, cpu_async_executor_,
+                AsyncPriority::High);
+}
+
 ExecutionResult AwsS3ClientProvider::GetBlobStream(
     ConsumerStreamingContext<GetBlobStreamRequest, GetBlobStreamResponse>&
         get_blob_stream_context) noexcept {
@@ -591,6 +770,24 @@ ExecutionResult AwsS3ClientProvider::PutBlob(
   String bucket_name(request.blob().metadata().bucket_name());
   String blob_name(request.blob().metadata().blob_name());
 
+  if (options_ && options_->put_blob_part_size_bytes > 0) {
+    size_t part_size =
+        std::max(kMinimumPartSize, options_->put_blob_part_size_bytes);
+    if (request.blob().data().size() > part_size) {
+      auto tracker = make_shared<PutBlobPartsTracker>(
+          request.blob().data().size(), part_size);
+      CreateMultipartUploadRequest create_request;
+      create_request.SetBucket(bucket_name);
+      create_request.SetKey(blob_name);
+      s3_client_->CreateMultipartUploadAsync(
+          create_request,
+          bind(&AwsS3ClientProvider::OnCreatePutBlobMultipartUploadCallback,
+               this, put_blob_context, tracker, _1, _2, _3, _4),
+          nullptr);
+      return SuccessExecutionResult();
+    }
+  }
+
   PutObjectRequest put_object_request;
   put_object_request.SetBucket(bucket_name);
   put_object_request.SetKey(blob_name);
@@ -641,6 +838,180 @@ void AwsS3ClientProvider::OnPutObjectCallback(
                 AsyncPriority::High);
 }
 
+void AwsS3ClientProvider::OnCreatePutBlobMultipartUploadCallback(
+    AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context,
+    shared_ptr<PutBlobPartsTracker> tracker, const S3Client* s3_client,
+    const CreateMultipartUploadRequest& create_multipart_upload_request,
+    CreateMultipartUploadOutcome create_multipart_upload_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  if (!create_multipart_upload_outcome.IsSuccess()) {
+    put_blob_context.result = AwsS3Utils::ConvertS3ErrorToExecutionResult(
+        create_multipart_upload_outcome.GetError().GetErrorType());
+    SCP_ERROR_CONTEXT(
+        kAwsS3Provider, put_blob_context, put_blob_context.result,
+        "Create multipart upload request failed. Error code: %d, message: %s",
+        create_multipart_upload_outcome.GetError().GetResponseCode(),
+        create_multipart_upload_outcome.GetError().GetMessage().c_str());
+    FinishContext(put_blob_context.result, put_blob_context,
+                  cpu_async_executor_, AsyncPriority::High);
+    return;
+  }
+  tracker->upload_id =
+      create_multipart_upload_outcome.GetResult().GetUploadId().c_str();
+
+  size_t max_concurrent_parts =
+      std::max<size_t>(1, options_->put_blob_max_concurrent_parts);
+  for (size_t i = 0; i < max_concurrent_parts; ++i) {
+    auto part_index = tracker->AcquireNextPart();
+    if (!part_index.has_value()) {
+      break;
+    }
+    PutObjectPart(put_blob_context, tracker, *part_index);
+  }
+  ReleasePutObjectPart(put_blob_context, tracker);
+}
+
+void AwsS3ClientProvider::PutObjectPart(
+    AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context,
+    shared_ptr<PutBlobPartsTracker> tracker, size_t part_index) noexcept {
+  const auto& metadata = put_blob_context.request->blob().metadata();
+  // Part numbers start at 1.
+  UploadPartRequest part_request;
+  part_request.SetBucket(metadata.bucket_name().c_str());
+  part_request.SetKey(metadata.blob_name().c_str());
+  part_request.SetPartNumber(part_index + 1);
+  part_request.SetUploadId(tracker->upload_id.c_str());
+
+  string data = put_blob_context.request->blob().data().substr(
+      tracker->GetPartOffset(part_index), tracker->GetPartSize(part_index));
+  if (auto md5_result = SetContentMd5(put_blob_context, part_request, data);
+      !md5_result.Successful()) {
+    tracker->Fail(md5_result);
+    ReleasePutObjectPart(put_blob_context, tracker);
+    return;
+  }
+  part_request.SetBody(
+      MakeShared<StringStream>("PutObjectPartStream", move(data)));
+
+  s3_client_->UploadPartAsync(
+      part_request,
+      bind(&AwsS3ClientProvider::OnPutObjectPartCallback, this,
+           put_blob_context, tracker, part_index, _1, _2, _3, _4),
+      nullptr);
+}
+
+void AwsS3ClientProvider::OnPutObjectPartCallback(
+    AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context,
+    shared_ptr<PutBlobPartsTracker> tracker, size_t part_index,
+    const S3Client* s3_client, const UploadPartRequest& upload_part_request,
+    UploadPartOutcome upload_part_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  if (!upload_part_outcome.IsSuccess()) {
+    auto execution_result = AwsS3Utils::ConvertS3ErrorToExecutionResult(
+        upload_part_outcome.GetError().GetErrorType());
+    SCP_ERROR_CONTEXT(kAwsS3Provider, put_blob_context, execution_result,
+                      "Put blob part %zu failed. Error code: %d, message: %s",
+                      part_index,
+                      upload_part_outcome.GetError().GetResponseCode(),
+                      upload_part_outcome.GetError().GetMessage().c_str());
+    tracker->Fail(execution_result);
+    ReleasePutObjectPart(put_blob_context, tracker);
+    return;
+  }
+  if (upload_part_outcome.GetResult().GetETag().empty()) {
+    auto execution_result =
+        FailureExecutionResult(SC_BLOB_STORAGE_PROVIDER_EMPTY_ETAG);
+    SCP_ERROR_CONTEXT(kAwsS3Provider, put_blob_context, execution_result,
+                      "Put blob part %zu returned no ETag", part_index);
+    tracker->Fail(execution_result);
+    ReleasePutObjectPart(put_blob_context, tracker);
+    return;
+  }
+  tracker->etags[part_index] =
+      upload_part_outcome.GetResult().GetETag().c_str();
+
+  if (auto next_part_index = tracker->AcquireNextPart();
+      next_part_index.has_value()) {
+    PutObjectPart(put_blob_context, tracker, *next_part_index);
+  }
+  ReleasePutObjectPart(put_blob_context, tracker);
+}
+
+void AwsS3ClientProvider::ReleasePutObjectPart(
+    AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context,
+    shared_ptr<PutBlobPartsTracker> tracker) noexcept {
+  if (!tracker->Release()) {
+    return;
+  }
+  const auto& metadata = put_blob_context.request->blob().metadata();
+  if (!tracker->result.Successful()) {
+    // The uploaded parts are discarded, the PutBlob finishes with the failure
+    // of the part whatever the outcome of the abort.
+    put_blob_context.result = tracker->result;
+    AbortMultipartUploadRequest abort_request;
+    abort_request.SetBucket(metadata.bucket_name().c_str());
+    abort_request.SetKey(metadata.blob_name().c_str());
+    abort_request.SetUploadId(tracker->upload_id.c_str());
+    s3_client_->AbortMultipartUploadAsync(
+        abort_request,
+        [this, put_blob_context](
+            const S3Client*, const AbortMultipartUploadRequest&,
+            AbortMultipartUploadOutcome abort_multipart_upload_outcome,
+            const shared_ptr<const AsyncCallerContext>&) mutable {
+          if (!abort_multipart_upload_outcome.IsSuccess()) {
+            SCP_ERROR_CONTEXT(
+                kAwsS3Provider, put_blob_context,
+                AwsS3Utils::ConvertS3ErrorToExecutionResult(
+                    abort_multipart_upload_outcome.GetError().GetErrorType()),
+                "Abort multipart upload request failed. Error code: %d, "
+                "message: %s",
+                abort_multipart_upload_outcome.GetError().GetResponseCode(),
+                abort_multipart_upload_outcome.GetError().GetMessage().c_str());
+          }
+          FinishContext(put_blob_context.result, put_blob_context,
+                        cpu_async_executor_, AsyncPriority::High);
+        },
+        nullptr);
+    return;
+  }
+
+  CompletedMultipartUpload completed_multipart_upload;
+  for (size_t i = 0; i < tracker->part_count; ++i) {
+    CompletedPart completed_part;
+    completed_part.SetPartNumber(i + 1);
+    completed_part.SetETag(tracker->etags[i].c_str());
+    completed_multipart_upload.AddParts(move(completed_part));
+  }
+  CompleteMultipartUploadRequest complete_request;
+  complete_request.SetBucket(metadata.bucket_name().c_str());
+  complete_request.SetKey(metadata.blob_name().c_str());
+  complete_request.SetUploadId(tracker->upload_id.c_str());
+  complete_request.WithMultipartUpload(move(completed_multipart_upload));
+  s3_client_->CompleteMultipartUploadAsync(
+      complete_request,
+      [this, put_blob_context](
+          const S3Client*, const CompleteMultipartUploadRequest&,
+          CompleteMultipartUploadOutcome complete_multipart_upload_outcome,
+          const shared_ptr<const AsyncCallerContext>&) mutable {
+        put_blob_context.result = SuccessExecutionResult();
+        if (!complete_multipart_upload_outcome.IsSuccess()) {
+          const auto& error = complete_multipart_upload_outcome.GetError();
+          put_blob_context.result =
+              AwsS3Utils::ConvertS3ErrorToExecutionResult(error.GetErrorType());
+          SCP_ERROR_CONTEXT(
+              kAwsS3Provider, put_blob_context, put_blob_context.result,
+              "Complete multipart upload request failed. Error code: %d, "
+              "message: %s",
+              error.GetResponseCode(), error.GetMessage().c_str());
+        } else {
+          put_blob_context.response = make_shared<PutBlobResponse>();
+        }
+        FinishContext(put_blob_context.result, put_blob_context,
+                      cpu_async_executor_, AsyncPriority::High);
+      },
+      nullptr);
+}
+
 ExecutionResult AwsS3ClientProvider::PutBlobStream(
     ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>&
         put_blob_stream_context) noexcept {
@@ -716,6 +1087,17 @@ void AwsS3ClientProvider::OnCreateMultipartUploadCallback(
   tracker->expiry_time_ns =
       TimeProvider::GetWallTimestampInNanoseconds() + duration;
 
+  if (options_ && options_->put_blob_stream_part_size_bytes > 0) {
+    tracker->parts = make_shared<PutBlobStreamPartsTracker>(
+        std::max(kMinimumPartSize, options_->put_blob_stream_part_size_bytes),
+        options_->put_blob_stream_max_concurrent_parts,
+        tracker->expiry_time_ns);
+    tracker->parts->Append(
+        move(*request.mutable_blob_portion()->mutable_data()));
+    PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+    return;
+  }
+
   if (request.blob_portion().data().size() < kMinimumPartSize) {
     // Not enough data to upload in a part yet.
     // Copy data into a staging variable.
@@ -757,6 +1139,111 @@ void AwsS3ClientProvider::OnCreateMultipartUploadCallback(
       nullptr);
 }
 
+void AwsS3ClientProvider::PumpPutBlobStreamParts(
+    ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>&
+        put_blob_stream_context,
+    shared_ptr<PutBlobStreamTracker> tracker) noexcept {
+  auto& parts = *tracker->parts;
+  auto actions = parts.TakeActions(put_blob_stream_context,
+                                   tracker->bucket_name, tracker->blob_name);
+  // Set when performing the actions fails, so that the failure is acted on.
+  bool is_pump_needed = false;
+
+  for (auto& [part_number, data] : actions.parts_to_upload) {
+    UploadPartRequest part_request;
+    part_request.SetBucket(tracker->bucket_name.c_str());
+    part_request.SetKey(tracker->blob_name.c_str());
+    part_request.SetPartNumber(part_number);
+    part_request.SetUploadId(tracker->upload_id.c_str());
+    if (auto md5_result =
+            SetContentMd5(put_blob_stream_context, part_request, data);
+        !md5_result.Successful()) {
+      parts.OnPartUploaded(part_number, md5_result, "");
+      is_pump_needed = true;
+      continue;
+    }
+    part_request.SetBody(
+        MakeShared<StringStream>("WriteStream::Upload", move(data)));
+    s3_client_->UploadPartAsync(
+        part_request,
+        bind(&AwsS3ClientProvider::OnUploadParallelPartCallback, this,
+             put_blob_stream_context, tracker, _1, _2, _3, _4),
+        nullptr);
+  }
+
+  switch (actions.next_action) {
+    case PutBlobStreamPartsTracker::NextAction::kNone:
+      break;
+    case PutBlobStreamPartsTracker::NextAction::kPoll:
+      if (auto schedule_result = io_async_executor_->ScheduleFor(
+              [this, put_blob_stream_context, tracker]() mutable {
+                tracker->parts->OnPollDone(SuccessExecutionResult());
+                PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+              },
+              (TimeProvider::GetSteadyTimestampInNanoseconds() +
+               kPutBlobRescanTime)
+                  .count());
+          !schedule_result.Successful()) {
+        SCP_ERROR_CONTEXT(kAwsS3Provider, put_blob_stream_context,
+                          schedule_result,
+                          "Put blob stream request failed to be scheduled");
+        parts.OnPollDone(schedule_result);
+        is_pump_needed = true;
+      }
+      break;
+    case PutBlobStreamPartsTracker::NextAction::kComplete:
+      for (const auto& [part_number, etag] : parts.uploaded_parts) {
+        CompletedPart completed_part;
+        completed_part.SetPartNumber(part_number);
+        completed_part.SetETag(etag.c_str());
+        tracker->completed_multipart_upload.AddParts(move(completed_part));
+      }
+      CompleteUpload(put_blob_stream_context, tracker);
+      return;
+    case PutBlobStreamPartsTracker::NextAction::kAbort:
+      put_blob_stream_context.result = *parts.failure;
+      SCP_ERROR_CONTEXT(kAwsS3Provider, put_blob_stream_context,
+                        put_blob_stream_context.result,
+                        "Put blob stream request failed, aborting the upload");
+      AbortUpload(put_blob_stream_context, tracker);
+      return;
+  }
+  if (is_pump_needed) {
+    PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+  }
+}
+
+void AwsS3ClientProvider::OnUploadParallelPartCallback(
+    ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>&
+        put_blob_stream_context,
+    shared_ptr<PutBlobStreamTracker> tracker, const S3Client* s3_client,
+    const UploadPartRequest& upload_part_request,
+    UploadPartOutcome upload_part_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  ExecutionResult result = SuccessExecutionResult();
+  string etag;
+  if (!upload_part_outcome.IsSuccess()) {
+    result = AwsS3Utils::ConvertS3ErrorToExecutionResult(
+        upload_part_outcome.GetError().GetErrorType());
+    SCP_ERROR_CONTEXT(kAwsS3Provider, put_blob_stream_context, result,
+                      "Upload part %d request failed. Error code: %d, "
+                      "message: %s",
+                      upload_part_request.GetPartNumber(),
+                      upload_part_outcome.GetError().GetResponseCode(),
+                      upload_part_outcome.GetError().GetMessage().c_str());
+  } else if (upload_part_outcome.GetResult().GetETag().empty()) {
+    result = FailureExecutionResult(SC_BLOB_STORAGE_PROVIDER_EMPTY_ETAG);
+    SCP_ERROR_CONTEXT(kAwsS3Provider, put_blob_stream_context, result,
+                      "Upload part %d request returned no ETag",
+                      upload_part_request.GetPartNumber());
+  } else {
+    etag = upload_part_outcome.GetResult().GetETag().c_str();
+  }
+  tracker->parts->OnPartUploaded(upload_part_request.GetPartNumber(), result,
+                                 move(etag));
+  PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+}
+
 void AwsS3ClientProvider::ScheduleAnotherPutBlobStreamPoll(
     ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>&
         put_blob_stream_context,
@@ -31,6 +31,9 @@
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/config_provider_interface.h"
 #include "core/interface/streaming_context.h"
+#include "cpio/client_providers/blob_storage_client_provider/src/common/get_blob_parts_tracker.h"
+#include "cpio/client_providers/blob_storage_client_provider/src/common/put_blob_parts_tracker.h"
+#include "cpio/client_providers/blob_storage_client_provider/src/common/put_blob_stream_parts_tracker.h"
 #include "cpio/client_providers/interface/blob_storage_client_provider_interface.h"
 #include "cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "public/cpio/interface/blob_storage_client/type_def.h"
@@ -50,7 +53,8 @@ class AwsS3ClientProvider : public BlobStorageClientProviderInterface {
       const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor,
       std::shared_ptr<AwsS3Factory> s3_factory =
           std::make_shared<AwsS3Factory>())
-      : instance_client_(instance_client),
+      : options_(options),
+        instance_client_(instance_client),
         cpu_async_executor_(cpu_async_executor),
         io_async_executor_(io_async_executor),
         s3_factory_(s3_factory) {}
@@ -114,6 +118,72 @@ class AwsS3ClientProvider : public BlobStorageClientProviderInterface {
       const std::shared_ptr<const Aws::Client::AsyncCallerContext>
           async_context) noexcept;
 
+  /**
+   * @brief Is called when the first part of a GetBlob downloaded in parts is
+   * returned. Sizes the blob and starts the download of the other parts.
+   *
+   * @param get_blob_context The get blob context object.
+   * @param tracker The tracker of the parts.
+   * @param s3_client An instance of the S3 client.
+   * @param get_object_request The get object request.
+   * @param get_object_outcome The get object outcome of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnGetObjectFirstPartCallback(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::GetBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::GetBlobResponse>&
+          get_blob_context,
+      std::shared_ptr<GetBlobPartsTracker> tracker,
+      const Aws::S3::S3Client* s3_client,
+      const Aws::S3::Model::GetObjectRequest& get_object_request,
+      Aws::S3::Model::GetObjectOutcome get_object_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /**
+   * @brief Starts the download of a part of a GetBlob other than the first.
+   *
+   * @param get_blob_context The get blob context object.
+   * @param tracker The tracker of the parts.
+   * @param part_index The index of the part.
+   */
+  void GetObjectPart(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::GetBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::GetBlobResponse>&
+          get_blob_context,
+      std::shared_ptr<GetBlobPartsTracker> tracker,
+      size_t part_index) noexcept;
+
+  /**
+   * @brief Is called when a part other than the first is returned.
+   *
+   * @param get_blob_context The get blob context object.
+   * @param tracker The tracker of the parts.
+   * @param part_index The index of the part.
+   * @param s3_client An instance of the S3 client.
+   * @param get_object_request The get object request.
+   * @param get_object_outcome The get object outcome of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnGetObjectPartCallback(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::GetBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::GetBlobResponse>&
+          get_blob_context,
+      std::shared_ptr<GetBlobPartsTracker> tracker, size_t part_index,
+      const Aws::S3::S3Client* s3_client,
+      const Aws::S3::Model::GetObjectRequest& get_object_request,
+      Aws::S3::Model::GetObjectOutcome get_object_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /// Releases the reference of a part request, and finishes the GetBlob if it
+  /// was the last one.
+  void ReleaseGetObjectPart(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::GetBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::GetBlobResponse>&
+          get_blob_context,
+      GetBlobPartsTracker& tracker) noexcept;
+
   struct GetBlobStreamTracker {
     // What byte indices were just used.
     int64_t last_begin_byte_index, last_end_byte_index;
@@ -186,6 +256,75 @@ class AwsS3ClientProvider : public BlobStorageClientProviderInterface {
       const std::shared_ptr<const Aws::Client::AsyncCallerContext>
           async_context) noexcept;
 
+  /**
+   * @brief Is called when the multipart upload of a PutBlob uploaded in parts
+   * is created. Starts the upload of the parts.
+   *
+   * @param put_blob_context The put blob context object.
+   * @param tracker The tracker of the parts.
+   * @param s3_client An instance of the S3 client.
+   * @param create_multipart_upload_request The create multipart upload request.
+   * @param create_multipart_upload_outcome The create multipart upload outcome
+   * of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnCreatePutBlobMultipartUploadCallback(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::PutBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::PutBlobResponse>&
+          put_blob_context,
+      std::shared_ptr<PutBlobPartsTracker> tracker,
+      const Aws::S3::S3Client* s3_client,
+      const Aws::S3::Model::CreateMultipartUploadRequest&
+          create_multipart_upload_request,
+      Aws::S3::Model::CreateMultipartUploadOutcome
+          create_multipart_upload_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /**
+   * @brief Starts the upload of a part of a PutBlob.
+   *
+   * @param put_blob_context The put blob context object.
+   * @param tracker The tracker of the parts.
+   * @param part_index The index of the part.
+   */
+  void PutObjectPart(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::PutBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::PutBlobResponse>&
+          put_blob_context,
+      std::shared_ptr<PutBlobPartsTracker> tracker,
+      size_t part_index) noexcept;
+
+  /**
+   * @brief Is called when the upload of a part of a PutBlob is done.
+   *
+   * @param put_blob_context The put blob context object.
+   * @param tracker The tracker of the parts.
+   * @param part_index The index of the part.
+   * @param s3_client An instance of the S3 client.
+   * @param upload_part_request The upload part request.
+   * @param upload_part_outcome The upload part outcome of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnPutObjectPartCallback(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::PutBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::PutBlobResponse>&
+          put_blob_context,
+      std::shared_ptr<PutBlobPartsTracker> tracker, size_t part_index,
+      const Aws::S3::S3Client* s3_client,
+      const Aws::S3::Model::UploadPartRequest& upload_part_request,
+      Aws::S3::Model::UploadPartOutcome upload_part_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /// Releases the reference of a part request, and completes or aborts the
+  /// multipart upload of the PutBlob if it was the last one.
+  void ReleasePutObjectPart(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::PutBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::PutBlobResponse>&
+          put_blob_context,
+      std::shared_ptr<PutBlobPartsTracker> tracker) noexcept;
+
   struct PutBlobStreamTracker {
     // The expected bucket and blob name for this upload. If this is different
     // at any point in the upload, the upload fails.
@@ -205,8 +344,48 @@ class AwsS3ClientProvider : public BlobStorageClientProviderInterface {
     // expire.
     std::chrono::nanoseconds expiry_time_ns =
         std::chrono::duration<int64_t>::min();
+    // Set when the parts are uploaded in parallel, in which case it holds the
+    // data and the state of the parts instead of the fields above.
+    std::shared_ptr<PutBlobStreamPartsTracker> parts;
   };
 
+  /**
+   * @brief Takes the next actions of a PutBlobStream uploaded in parallel
+   * parts and performs them.
+   *
+   * @param put_blob_stream_context The put blob stream context object.
+   * @param tracker The tracker of the upload.
+   */
+  void PumpPutBlobStreamParts(
+      core::ProducerStreamingContext<
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamRequest,
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamResponse>&
+          put_blob_stream_context,
+      std::shared_ptr<PutBlobStreamTracker> tracker) noexcept;
+
+  /**
+   * @brief Is called when an UploadPart of a PutBlobStream uploaded in
+   * parallel parts is done.
+   *
+   * @param put_blob_stream_context The put blob stream context object.
+   * @param tracker The tracker of the upload.
+   * @param s3_client An instance of the S3 client.
+   * @param upload_part_request The upload part request.
+   * @param upload_part_outcome The upload part outcome of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnUploadParallelPartCallback(
+      core::ProducerStreamingContext<
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamRequest,
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamResponse>&
+          put_blob_stream_context,
+      std::shared_ptr<PutBlobStreamTracker> tracker,
+      const Aws::S3::S3Client* s3_client,
+      const Aws::S3::Model::UploadPartRequest& upload_part_request,
+      Aws::S3::Model::UploadPartOutcome upload_part_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
   // Schedules another poll for the next message in PutBlobStream.
   void ScheduleAnotherPutBlobStreamPoll(
       core::ProducerStreamingContext<
@@ -369,6 +548,8 @@ class AwsS3ClientProvider : public BlobStorageClientProviderInterface {
   virtual std::shared_ptr<Aws::Client::ClientConfiguration>
   CreateClientConfiguration(const std::string& region) noexcept;
 
+  std::shared_ptr<BlobStorageClientOptions> options_;
+
   std::shared_ptr<InstanceClientProviderInterface> instance_client_;
 
   /// Instances of the async executor for local compute and blocking IO
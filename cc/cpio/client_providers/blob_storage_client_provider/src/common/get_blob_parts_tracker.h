@@ -0,0 +1,102 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Tracks a GetBlob downloaded as ranges of part_size bytes.
+ *
+ * The first part is downloaded alone, as its response carries the size of the
+ * blob. The other ones are then downloaded by at most a fixed number of
+ * requests at once, each request taking the next part once done. Every
+ * request in flight holds a reference, and the one releasing the last
+ * reference finishes the GetBlob.
+ */
+struct GetBlobPartsTracker {
+  GetBlobPartsTracker(int64_t begin_byte_index, size_t part_size)
+      : begin_byte_index(begin_byte_index), part_size(part_size) {}
+
+  /// Sets the number of bytes to download, from the response of the first
+  /// part.
+  void SetLength(size_t new_length) {
+    length = new_length;
+    part_count = (length + part_size - 1) / part_size;
+  }
+
+  /// The offset of the part in the downloaded bytes.
+  size_t GetPartOffset(size_t part_index) const {
+    return part_index * part_size;
+  }
+
+  /// The size of the part, only the last one may be shorter than part_size.
+  size_t GetPartSize(size_t part_index) const {
+    return std::min(part_size, length - GetPartOffset(part_index));
+  }
+
+  /// Takes a reference and the next part to download, if there is any left
+  /// and no part failed.
+  std::optional<size_t> AcquireNextPart() {
+    if (is_failed.load()) {
+      return std::nullopt;
+    }
+    auto part_index = next_part_index.fetch_add(1);
+    if (part_index >= part_count) {
+      return std::nullopt;
+    }
+    pending_count.fetch_add(1);
+    return part_index;
+  }
+
+  /// Records the failure of a part. Only the first failure is kept.
+  void Fail(const core::ExecutionResult& execution_result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!is_failed.exchange(true)) {
+      result = execution_result;
+    }
+  }
+
+  /// Releases a reference. Returns true for the last one, after which result
+  /// holds the outcome of the download.
+  bool Release() { return pending_count.fetch_sub(1) == 1; }
+
+  /// The index of the first downloaded byte in the blob.
+  const int64_t begin_byte_index;
+  /// The size of all the parts but the last one.
+  const size_t part_size;
+  /// The number of bytes to download.
+  size_t length = 0;
+  size_t part_count = 0;
+  /// The buffer of length bytes the parts are written to.
+  char* data = nullptr;
+  /// The first part is downloaded before the tracker is shared.
+  std::atomic<size_t> next_part_index{1};
+  /// The requests in flight, starting with the one for the first part.
+  std::atomic<size_t> pending_count{1};
+  std::atomic<bool> is_failed{false};
+  std::mutex mutex;
+  core::ExecutionResult result = core::SuccessExecutionResult();
+};
+}  // namespace google::scp::cpio::client_providers
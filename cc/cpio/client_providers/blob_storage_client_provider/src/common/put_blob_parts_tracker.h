@@ -0,0 +1,99 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Tracks a PutBlob uploaded as parts of part_size bytes of its data.
+ *
+ * The parts are uploaded by at most a fixed number of requests at once, each
+ * request taking the next part once done. Every request in flight holds a
+ * reference, as does the one starting the upload, and the one releasing the
+ * last reference completes or aborts the upload.
+ */
+struct PutBlobPartsTracker {
+  PutBlobPartsTracker(size_t length, size_t part_size)
+      : length(length),
+        part_size(part_size),
+        part_count((length + part_size - 1) / part_size),
+        etags(part_count) {}
+
+  /// The offset of the part in the data of the blob.
+  size_t GetPartOffset(size_t part_index) const {
+    return part_index * part_size;
+  }
+
+  /// The size of the part, only the last one may be shorter than part_size.
+  size_t GetPartSize(size_t part_index) const {
+    return std::min(part_size, length - GetPartOffset(part_index));
+  }
+
+  /// Takes a reference and the next part to upload, if there is any left and
+  /// no part failed.
+  std::optional<size_t> AcquireNextPart() {
+    if (is_failed.load()) {
+      return std::nullopt;
+    }
+    auto part_index = next_part_index.fetch_add(1);
+    if (part_index >= part_count) {
+      return std::nullopt;
+    }
+    pending_count.fetch_add(1);
+    return part_index;
+  }
+
+  /// Records the failure of a part. Only the first failure is kept.
+  void Fail(const core::ExecutionResult& execution_result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!is_failed.exchange(true)) {
+      result = execution_result;
+    }
+  }
+
+  /// Releases a reference. Returns true for the last one, after which result
+  /// holds the outcome of the part uploads.
+  bool Release() { return pending_count.fetch_sub(1) == 1; }
+
+  /// The number of bytes to upload.
+  const size_t length;
+  /// The size of all the parts but the last one.
+  const size_t part_size;
+  const size_t part_count;
+  /// The id of the multipart upload, set before the parts are uploaded.
+  std::string upload_id;
+  /// The ETags of the uploaded parts, by part index. Each one is only written
+  /// by the request uploading its part.
+  std::vector<std::string> etags;
+  std::atomic<size_t> next_part_index{0};
+  /// The requests in flight, starting with the one starting the upload.
+  std::atomic<size_t> pending_count{1};
+  std::atomic<bool> is_failed{false};
+  std::mutex mutex;
+  core::ExecutionResult result = core::SuccessExecutionResult();
+};
+}  // namespace google::scp::cpio::client_providers
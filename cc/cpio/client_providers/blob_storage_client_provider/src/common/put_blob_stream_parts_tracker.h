@@ -0,0 +1,203 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/common/time_provider/src/time_provider.h"
+#include "cpio/client_providers/blob_storage_client_provider/src/common/error_codes.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Tracks a PutBlobStream uploaded as parts of part_size bytes, with up
+ * to max_concurrent_parts of them in flight.
+ *
+ * The portions of the stream are coalesced into the parts, which are numbered
+ * from 1 in the order of the data. Whenever something happens (a part is
+ * uploaded, a poll is due), the provider calls TakeActions() and performs the
+ * returned actions outside of the lock.
+ */
+struct PutBlobStreamPartsTracker {
+  /// What the provider has to do after TakeActions().
+  enum class NextAction {
+    kNone = 0,
+    /// Schedule a poll for the next portion, then call OnPollDone().
+    kPoll = 1,
+    /// All the parts are uploaded, complete the upload with uploaded_parts.
+    kComplete = 2,
+    /// The upload failed with failure and no part is in flight, discard the
+    /// uploaded parts and finish.
+    kAbort = 3,
+  };
+
+  struct Actions {
+    /// The parts to upload, as their number and their data.
+    std::vector<std::pair<int64_t, std::string>> parts_to_upload;
+    NextAction next_action = NextAction::kNone;
+  };
+
+  PutBlobStreamPartsTracker(size_t part_size, size_t max_concurrent_parts,
+                            std::chrono::nanoseconds expiry_time_ns)
+      : part_size(part_size),
+        max_concurrent_parts(std::max<size_t>(1, max_concurrent_parts)),
+        expiry_time_ns(expiry_time_ns) {}
+
+  /// Adds the data of the first portion.
+  void Append(std::string data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    accumulated_contents.append(data);
+  }
+
+  /**
+   * @brief Takes the queued portions while parts can be uploaded, and returns
+   * what to do next.
+   *
+   * @param context the ProducerStreamingContext of the PutBlobStream.
+   * @param bucket_name the bucket all the portions must be for.
+   * @param blob_name the blob all the portions must be for.
+   */
+  template <typename Context>
+  Actions TakeActions(Context& context, const std::string& bucket_name,
+                      const std::string& blob_name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Actions actions;
+    if (!failure.has_value() && context.IsCancelled()) {
+      failure = core::FailureExecutionResult(
+          core::errors::SC_BLOB_STORAGE_PROVIDER_STREAM_SESSION_CANCELLED);
+    }
+
+    bool is_drained = false;
+    bool is_marked_done = false;
+    while (!failure.has_value()) {
+      while (accumulated_contents.size() >= part_size &&
+             parts_in_flight < max_concurrent_parts) {
+        actions.parts_to_upload.emplace_back(
+            next_part_number++, accumulated_contents.substr(0, part_size));
+        accumulated_contents.erase(0, part_size);
+        parts_in_flight++;
+      }
+      if (parts_in_flight >= max_concurrent_parts) {
+        break;
+      }
+      // Read before the request, the portions are all queued once it is set.
+      is_marked_done = context.IsMarkedDone();
+      auto request = context.TryGetNextRequest();
+      if (request == nullptr) {
+        is_drained = true;
+        break;
+      }
+      if (request->blob_portion().metadata().bucket_name() != bucket_name ||
+          request->blob_portion().metadata().blob_name() != blob_name) {
+        failure = core::FailureExecutionResult(
+            core::errors::SC_BLOB_STORAGE_PROVIDER_INVALID_ARGS);
+        break;
+      }
+      accumulated_contents.append(request->blob_portion().data());
+    }
+
+    if (!failure.has_value() && is_drained) {
+      if (is_marked_done) {
+        // The last part may be smaller than part_size.
+        if (!accumulated_contents.empty()) {
+          actions.parts_to_upload.emplace_back(next_part_number++,
+                                               std::move(accumulated_contents));
+          accumulated_contents.clear();
+          parts_in_flight++;
+        } else if (parts_in_flight == 0 && !is_finishing) {
+          is_finishing = true;
+          actions.next_action = NextAction::kComplete;
+        }
+      } else if (parts_in_flight == 0) {
+        // The uploads in flight poll once done, otherwise a poll is needed.
+        if (core::common::TimeProvider::GetWallTimestampInNanoseconds() >=
+            expiry_time_ns) {
+          failure = core::FailureExecutionResult(
+              core::errors::SC_BLOB_STORAGE_PROVIDER_STREAM_SESSION_EXPIRED);
+        } else if (!is_poll_scheduled) {
+          is_poll_scheduled = true;
+          actions.next_action = NextAction::kPoll;
+        }
+      }
+    }
+
+    if (failure.has_value() && parts_in_flight == 0 && !is_finishing) {
+      is_finishing = true;
+      actions.next_action = NextAction::kAbort;
+    }
+    return actions;
+  }
+
+  /**
+   * @brief Records the outcome of the upload of a part.
+   *
+   * @param part_number the number of the part.
+   * @param result the result of the upload.
+   * @param part_id what identifies the uploaded part to the completion, e.g.
+   * its ETag. Only used on success.
+   */
+  void OnPartUploaded(int64_t part_number, const core::ExecutionResult& result,
+                      std::string part_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    parts_in_flight--;
+    if (!result.Successful()) {
+      if (!failure.has_value()) {
+        failure = result;
+      }
+      return;
+    }
+    uploaded_parts.emplace(part_number, std::move(part_id));
+  }
+
+  /// Records that the scheduled poll is due, or failed to be scheduled.
+  void OnPollDone(const core::ExecutionResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    is_poll_scheduled = false;
+    if (!result.Successful() && !failure.has_value()) {
+      failure = result;
+    }
+  }
+
+  const size_t part_size;
+  const size_t max_concurrent_parts;
+  /// Timestamp in nanoseconds of when this PutBlobStream session should
+  /// expire.
+  const std::chrono::nanoseconds expiry_time_ns;
+
+  std::mutex mutex;
+  /// The data not in a part yet.
+  std::string accumulated_contents;
+  int64_t next_part_number = 1;
+  size_t parts_in_flight = 0;
+  bool is_poll_scheduled = false;
+  /// Whether kComplete or kAbort was returned.
+  bool is_finishing = false;
+  /// The first failure of the upload.
+  std::optional<core::ExecutionResult> failure;
+  /// The ids of the uploaded parts, in the order of their numbers.
+  std::map<int64_t, std::string> uploaded_parts;
+};
+}  // namespace google::scp::cpio::client_providers
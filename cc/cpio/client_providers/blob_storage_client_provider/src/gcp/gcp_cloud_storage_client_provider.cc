@@ -19,15 +19,18 @@
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <google/protobuf/util/time_util.h>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "cc/core/interface/configuration_keys.h"
 #include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_context.h"
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/blob_storage_provider_interface.h"
@@ -37,19 +40,25 @@
 #include "core/utils/src/hashing.h"
 #include "cpio/client_providers/blob_storage_client_provider/src/common/error_codes.h"
 #include "cpio/client_providers/instance_client_provider/src/gcp/gcp_instance_client_utils.h"
+#include "google/cloud/common_options.h"
+#include "google/cloud/grpc_options.h"
 #include "google/cloud/options.h"
 #include "google/cloud/status_or.h"
 #include "google/cloud/storage/client.h"
+#include "google/cloud/storage/grpc_plugin.h"
 #include "google/cloud/storage/object_read_stream.h"
 #include "public/core/interface/execution_result.h"
 #include "public/cpio/interface/blob_storage_client/type_def.h"
 
 #include "gcp_cloud_storage_utils.h"
 
+using google::cloud::EndpointOption;
+using google::cloud::GrpcNumChannelsOption;
 using google::cloud::Options;
 using google::cloud::StatusCode;
 using google::cloud::StatusOr;
 using google::cloud::storage::Client;
+using google::cloud::storage::ComposeSourceObject;
 using google::cloud::storage::ComputeMD5Hash;
 using google::cloud::storage::ConnectionPoolSizeOption;
 using google::cloud::storage::DisableCrc32cChecksum;
@@ -70,6 +79,7 @@ using google::cloud::storage::RetryPolicyOption;
 using google::cloud::storage::StartOffset;
 using google::cloud::storage::StrictIdempotencyPolicy;
 using google::cloud::storage::TransferStallTimeoutOption;
+using google::cloud::storage_experimental::DefaultGrpcClient;
 using google::cmrt::sdk::blob_storage_service::v1::Blob;
 using google::cmrt::sdk::blob_storage_service::v1::BlobMetadata;
 using google::cmrt::sdk::blob_storage_service::v1::DeleteBlobRequest;
@@ -97,6 +107,8 @@ using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::TimeProvider;
+using google::scp::core::common::ToString;
+using google::scp::core::common::Uuid;
 using google::scp::core::errors::SC_BLOB_STORAGE_PROVIDER_ERROR_GETTING_BLOB;
 using google::scp::core::errors::SC_BLOB_STORAGE_PROVIDER_INVALID_ARGS;
 using google::scp::core::errors::SC_BLOB_STORAGE_PROVIDER_RETRIABLE_ERROR;
@@ -132,6 +144,10 @@ constexpr nanoseconds kDefaultStreamKeepaliveNanos =
 constexpr nanoseconds kMaximumStreamKeepaliveNanos =
     duration_cast<nanoseconds>(minutes(10));
 constexpr seconds kPutBlobRescanTime = seconds(5);
+// The endpoint of the gRPC transport through DirectPath.
+constexpr char kDirectPathEndpoint[] = "google-c2p:///storage.googleapis.com";
+// The max number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSourceCount = 32;
 
 bool IsPageTokenObject(const ListBlobsMetadataRequest& list_blobs_request,
                        const ObjectMetadata& obj_metadata) {
@@ -260,6 +276,53 @@ void GcpCloudStorageClientProvider::GetBlobInternal(
   auto& blob_bytes = *get_blob_context.response->mutable_blob()->mutable_data();
   blob_bytes.resize(content_length);
 
+  if (options_ && options_->get_blob_part_size_bytes > 0 &&
+      content_length > options_->get_blob_part_size_bytes) {
+    // The first part is read from blob_stream on this thread, while the other
+    // ones are downloaded in parallel on the other IO threads.
+    auto tracker = make_shared<GetBlobPartsTracker>(
+        get_blob_context.request->has_byte_range()
+            ? get_blob_context.request->byte_range().begin_byte_index()
+            : 0,
+        options_->get_blob_part_size_bytes);
+    tracker->SetLength(content_length);
+    tracker->data = blob_bytes.data();
+    size_t max_concurrent_parts =
+        std::max<size_t>(1, options_->get_blob_max_concurrent_parts);
+    for (size_t i = 1; i < max_concurrent_parts; ++i) {
+      auto part_index = tracker->AcquireNextPart();
+      if (!part_index.has_value()) {
+        break;
+      }
+      if (auto schedule_result = io_async_executor_->Schedule(
+              bind(&GcpCloudStorageClientProvider::GetBlobPartsInternal, this,
+                   get_blob_context, tracker, *part_index),
+              AsyncPriority::Normal);
+          !schedule_result.Successful()) {
+        SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, get_blob_context,
+                          schedule_result,
+                          "Get blob part failed to be scheduled");
+        tracker->Fail(schedule_result);
+        ReleaseGetBlobPart(get_blob_context, *tracker);
+        break;
+      }
+    }
+
+    blob_stream.read(tracker->data, tracker->GetPartSize(0));
+    if (!blob_stream.status().ok()) {
+      auto execution_result =
+          common::GcpUtils::GcpErrorConverter(blob_stream.status());
+      SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, get_blob_context,
+                        execution_result, "Blob stream failed. Message: %s.",
+                        blob_stream.status().message().c_str());
+      tracker->Fail(execution_result);
+    }
+    // The rest of the object is downloaded by the other parts.
+    blob_stream.Close();
+    ReleaseGetBlobPart(get_blob_context, *tracker);
+    return;
+  }
+
   blob_stream.read(blob_bytes.data(), content_length);
   if (!ValidateStream(get_blob_context, blob_stream).Successful()) {
     return;
@@ -269,6 +332,66 @@ void GcpCloudStorageClientProvider::GetBlobInternal(
                 cpu_async_executor_);
 }
 
+void GcpCloudStorageClientProvider::GetBlobPartsInternal(
+    AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context,
+    shared_ptr<GetBlobPartsTracker> tracker, size_t part_index) noexcept {
+  Client cloud_storage_client(*cloud_storage_client_shared_);
+  std::optional<size_t> next_part_index = part_index;
+  while (next_part_index.has_value()) {
+    part_index = *next_part_index;
+    next_part_index = std::nullopt;
+
+    int64_t begin_index =
+        tracker->begin_byte_index + tracker->GetPartOffset(part_index);
+    size_t part_size = tracker->GetPartSize(part_index);
+    // ReadRange is right-open.
+    ObjectReadStream part_stream = cloud_storage_client.ReadObject(
+        get_blob_context.request->blob_metadata().bucket_name(),
+        get_blob_context.request->blob_metadata().blob_name(),
+        DisableCrc32cChecksum(true), EnableMD5Hash(),
+        ReadRange(begin_index, begin_index + part_size));
+    if (part_stream.status().ok()) {
+      part_stream.read(tracker->data + tracker->GetPartOffset(part_index),
+                       part_size);
+    }
+    if (!part_stream.status().ok()) {
+      auto execution_result =
+          common::GcpUtils::GcpErrorConverter(part_stream.status());
+      SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, get_blob_context,
+                        execution_result,
+                        "Get blob part %zu failed. Message: %s.", part_index,
+                        part_stream.status().message().c_str());
+      tracker->Fail(execution_result);
+    } else if (static_cast<size_t>(part_stream.gcount()) != part_size) {
+      auto execution_result =
+          FailureExecutionResult(SC_BLOB_STORAGE_PROVIDER_ERROR_GETTING_BLOB);
+      SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, get_blob_context,
+                        execution_result,
+                        "Get blob part %zu returned %lld bytes out of %zu.",
+                        part_index,
+                        static_cast<long long>(part_stream.gcount()),
+                        part_size);
+      tracker->Fail(execution_result);
+    } else {
+      // Takes the next part before releasing this one, so that the GetBlob
+      // is not finished in between.
+      next_part_index = tracker->AcquireNextPart();
+    }
+    ReleaseGetBlobPart(get_blob_context, *tracker);
+  }
+}
+
+void GcpCloudStorageClientProvider::ReleaseGetBlobPart(
+    AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context,
+    GetBlobPartsTracker& tracker) noexcept {
+  if (!tracker.Release()) {
+    return;
+  }
+  get_blob_context.result = tracker.result;
+  FinishContext(get_blob_context.result, get_blob_context,
+                cpu_async_executor_);
+}
+
 ExecutionResult GcpCloudStorageClientProvider::GetBlobStream(
     ConsumerStreamingContext<GetBlobStreamRequest, GetBlobStreamResponse>&
         get_blob_stream_context) noexcept {
@@ -688,6 +811,19 @@ void GcpCloudStorageClientProvider::InitPutBlobStream(
 
   tracker->bucket_name = request.blob_portion().metadata().bucket_name();
   tracker->blob_name = request.blob_portion().metadata().blob_name();
+  if (options_ && options_->put_blob_stream_part_size_bytes > 0) {
+    // A resumable upload only takes its chunks in order, so the parts are
+    // uploaded as separate objects and composed once all are there.
+    tracker->parts = make_shared<PutBlobStreamPartsTracker>(
+        options_->put_blob_stream_part_size_bytes,
+        options_->put_blob_stream_max_concurrent_parts,
+        tracker->expiry_time_ns);
+    tracker->part_name_prefix = absl::StrCat(
+        tracker->blob_name, ".part-", ToString(Uuid::GenerateUuid()), "-");
+    tracker->parts->Append(request.blob_portion().data());
+    PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+    return;
+  }
   tracker->stream = cloud_storage_client.WriteObject(
       tracker->bucket_name, tracker->blob_name, NewResumableUploadSession());
   // Write the initial data from the first request.
@@ -826,6 +962,157 @@ void GcpCloudStorageClientProvider::PutBlobStreamInternal(
   }
 }
 
+void GcpCloudStorageClientProvider::PumpPutBlobStreamParts(
+    ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>
+        put_blob_stream_context,
+    shared_ptr<PutBlobStreamTracker> tracker) noexcept {
+  auto& parts = *tracker->parts;
+  auto actions = parts.TakeActions(put_blob_stream_context,
+                                   tracker->bucket_name, tracker->blob_name);
+  // Set when performing the actions fails, so that the failure is acted on.
+  bool is_pump_needed = false;
+
+  for (auto& [part_number, data] : actions.parts_to_upload) {
+    if (auto schedule_result = io_async_executor_->Schedule(
+            [this, put_blob_stream_context, tracker, part_number = part_number,
+             data = move(data)]() {
+              UploadPutBlobStreamPart(put_blob_stream_context, tracker,
+                                      part_number, data);
+            },
+            AsyncPriority::Normal);
+        !schedule_result.Successful()) {
+      SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, put_blob_stream_context,
+                        schedule_result,
+                        "Upload of part %lld failed to be scheduled",
+                        part_number);
+      parts.OnPartUploaded(part_number, schedule_result, "");
+      is_pump_needed = true;
+    }
+  }
+
+  switch (actions.next_action) {
+    case PutBlobStreamPartsTracker::NextAction::kNone:
+      break;
+    case PutBlobStreamPartsTracker::NextAction::kPoll:
+      if (auto schedule_result = io_async_executor_->ScheduleFor(
+              [this, put_blob_stream_context, tracker]() {
+                tracker->parts->OnPollDone(SuccessExecutionResult());
+                PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+              },
+              (TimeProvider::GetSteadyTimestampInNanoseconds() +
+               kPutBlobRescanTime)
+                  .count());
+          !schedule_result.Successful()) {
+        SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider,
+                          put_blob_stream_context, schedule_result,
+                          "Put blob stream request failed to be scheduled");
+        parts.OnPollDone(schedule_result);
+        is_pump_needed = true;
+      }
+      break;
+    case PutBlobStreamPartsTracker::NextAction::kComplete:
+      ComposePutBlobStreamParts(put_blob_stream_context, tracker);
+      return;
+    case PutBlobStreamPartsTracker::NextAction::kAbort: {
+      SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, put_blob_stream_context,
+                        *parts.failure,
+                        "Put blob stream request failed, deleting the "
+                        "uploaded parts");
+      Client cloud_storage_client(*cloud_storage_client_shared_);
+      DeletePutBlobStreamParts(put_blob_stream_context, *tracker,
+                               cloud_storage_client);
+      FinishStreamingContext(*parts.failure, put_blob_stream_context,
+                             cpu_async_executor_);
+      return;
+    }
+  }
+  if (is_pump_needed) {
+    PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+  }
+}
+
+void GcpCloudStorageClientProvider::UploadPutBlobStreamPart(
+    ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>
+        put_blob_stream_context,
+    shared_ptr<PutBlobStreamTracker> tracker, int64_t part_number,
+    const string& data) noexcept {
+  Client cloud_storage_client(*cloud_storage_client_shared_);
+  auto part_name = absl::StrCat(tracker->part_name_prefix, part_number);
+  auto object_metadata =
+      cloud_storage_client.InsertObject(tracker->bucket_name, part_name, data,
+                                        MD5HashValue(ComputeMD5Hash(data)));
+  auto result = SuccessExecutionResult();
+  if (!object_metadata) {
+    result = GcpCloudStorageUtils::ConvertCloudStorageErrorToExecutionResult(
+        object_metadata.status().code());
+    SCP_ERROR_CONTEXT(kGcpCloudStorageClientProvider, put_blob_stream_context,
+                      result,
+                      "Upload of part %lld failed. Error code: %d, message: %s",
+                      part_number, object_metadata.status().code(),
+                      object_metadata.status().message().c_str());
+  }
+  tracker->parts->OnPartUploaded(part_number, result, move(part_name));
+  PumpPutBlobStreamParts(put_blob_stream_context, tracker);
+}
+
+void GcpCloudStorageClientProvider::ComposePutBlobStreamParts(
+    ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>
+        put_blob_stream_context,
+    shared_ptr<PutBlobStreamTracker> tracker) noexcept {
+  Client cloud_storage_client(*cloud_storage_client_shared_);
+  auto result = SuccessExecutionResult();
+  // A compose request takes at most kMaxComposeSourceCount objects, so the
+  // blob composed so far is the first source of the next request.
+  vector<ComposeSourceObject> sources;
+  auto part = tracker->parts->uploaded_parts.begin();
+  auto parts_end = tracker->parts->uploaded_parts.end();
+  do {
+    sources.clear();
+    if (part != tracker->parts->uploaded_parts.begin()) {
+      sources.emplace_back().object_name = tracker->blob_name;
+    }
+    for (; part != parts_end && sources.size() < kMaxComposeSourceCount;
+         ++part) {
+      sources.emplace_back().object_name = part->second;
+    }
+    auto object_metadata = cloud_storage_client.ComposeObject(
+        tracker->bucket_name, sources, tracker->blob_name);
+    if (!object_metadata) {
+      result = GcpCloudStorageUtils::ConvertCloudStorageErrorToExecutionResult(
+          object_metadata.status().code());
+      SCP_ERROR_CONTEXT(
+          kGcpCloudStorageClientProvider, put_blob_stream_context, result,
+          "Put blob stream compose failed. Error code: %d, message: %s",
+          object_metadata.status().code(),
+          object_metadata.status().message().c_str());
+      break;
+    }
+  } while (part != parts_end);
+
+  DeletePutBlobStreamParts(put_blob_stream_context, *tracker,
+                           cloud_storage_client);
+  put_blob_stream_context.response = make_shared<PutBlobStreamResponse>();
+  FinishStreamingContext(result, put_blob_stream_context, cpu_async_executor_);
+}
+
+void GcpCloudStorageClientProvider::DeletePutBlobStreamParts(
+    ProducerStreamingContext<PutBlobStreamRequest, PutBlobStreamResponse>&
+        put_blob_stream_context,
+    const PutBlobStreamTracker& tracker,
+    Client& cloud_storage_client) noexcept {
+  for (const auto& [part_number, part_name] : tracker.parts->uploaded_parts) {
+    auto status =
+        cloud_storage_client.DeleteObject(tracker.bucket_name, part_name);
+    if (!status.ok()) {
+      SCP_DEBUG_CONTEXT(kGcpCloudStorageClientProvider,
+                        put_blob_stream_context,
+                        "Deleting part %s failed. Error code: %d, message: %s",
+                        part_name.c_str(), status.code(),
+                        status.message().c_str());
+    }
+  }
+}
+
 ExecutionResult GcpCloudStorageClientProvider::DeleteBlob(
     AsyncContext<DeleteBlobRequest, DeleteBlobResponse>&
         delete_blob_context) noexcept {
@@ -883,6 +1170,16 @@ core::ExecutionResultOr<shared_ptr<Client>>
 GcpCloudStorageFactory::CreateClient(
     shared_ptr<BlobStorageClientOptions> options,
     const string& project_id) noexcept {
+  auto client_config = CreateClientOptions(options, project_id);
+  if (options->use_grpc_transport) {
+    return make_shared<Client>(DefaultGrpcClient(move(client_config)));
+  }
+  return make_shared<Client>(client_config);
+}
+
+Options GcpCloudStorageFactory::CreateClientOptions(
+    shared_ptr<BlobStorageClientOptions> options,
+    const string& project_id) noexcept {
   Options client_config;
   client_config.set<ProjectIdOption>(project_id);
   client_config.set<ConnectionPoolSizeOption>(kMaxConcurrentConnections);
@@ -891,7 +1188,16 @@ GcpCloudStorageFactory::CreateClient(
   client_config.set<IdempotencyPolicyOption>(StrictIdempotencyPolicy().clone());
   client_config.set<TransferStallTimeoutOption>(
       options->transfer_stall_timeout);
-  return make_shared<Client>(client_config);
+  if (options->use_grpc_transport) {
+    if (options->grpc_channel_count > 0) {
+      client_config.set<GrpcNumChannelsOption>(
+          static_cast<int>(options->grpc_channel_count));
+    }
+    if (options->use_direct_path) {
+      client_config.set<EndpointOption>(kDirectPathEndpoint);
+    }
+  }
+  return client_config;
 }
 
 shared_ptr<BlobStorageClientProviderInterface>
@@ -25,9 +25,12 @@
 #include "core/interface/config_provider_interface.h"
 #include "core/interface/streaming_context.h"
 #include "cpio/client_providers/blob_storage_client_provider/src/common/error_codes.h"
+#include "cpio/client_providers/blob_storage_client_provider/src/common/get_blob_parts_tracker.h"
+#include "cpio/client_providers/blob_storage_client_provider/src/common/put_blob_stream_parts_tracker.h"
 #include "cpio/client_providers/interface/blob_storage_client_provider_interface.h"
 #include "cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "cpio/common/src/gcp/gcp_utils.h"
+#include "google/cloud/options.h"
 #include "google/cloud/storage/client.h"
 #include "public/cpio/interface/blob_storage_client/type_def.h"
 
@@ -103,6 +106,30 @@ class GcpCloudStorageClientProvider
                          cmrt::sdk::blob_storage_service::v1::GetBlobResponse>
           get_blob_context) noexcept;
 
+  /**
+   * @brief Downloads parts of a GetBlob, the first one given and then the ones
+   * left until none is.
+   *
+   * @param get_blob_context The get blob context object.
+   * @param tracker The tracker of the parts.
+   * @param part_index The index of the first part to download, acquired from
+   * the tracker.
+   */
+  void GetBlobPartsInternal(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::GetBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::GetBlobResponse>
+          get_blob_context,
+      std::shared_ptr<GetBlobPartsTracker> tracker,
+      size_t part_index) noexcept;
+
+  /// Releases the reference of a part download, and finishes the GetBlob if it
+  /// was the last one.
+  void ReleaseGetBlobPart(
+      core::AsyncContext<cmrt::sdk::blob_storage_service::v1::GetBlobRequest,
+                         cmrt::sdk::blob_storage_service::v1::GetBlobResponse>&
+          get_blob_context,
+      GetBlobPartsTracker& tracker) noexcept;
+
   // Housekeeping object for tracking the progress of a single GetBlobStream.
   struct GetBlobStreamTracker {
     // The stream to read bytes out of.
@@ -178,6 +205,13 @@ class GcpCloudStorageClientProvider
     // expire.
     std::chrono::nanoseconds expiry_time_ns =
         std::chrono::duration<int64_t>::min();
+
+    // If present, the upload is made of parts uploaded in parallel as
+    // temporary objects, which are composed into the blob once all are
+    // uploaded. stream and session_id are then unused.
+    std::shared_ptr<PutBlobStreamPartsTracker> parts;
+    // The names of the temporary objects are this prefix and the part number.
+    std::string part_name_prefix;
   };
 
   void InitPutBlobStream(
@@ -204,6 +238,65 @@ class GcpCloudStorageClientProvider
           put_blob_stream_context,
       std::shared_ptr<PutBlobStreamTracker> tracker) noexcept;
 
+  /**
+   * @brief Uploads the parts the parts tracker hands out, and completes or
+   * aborts the upload once it is time to.
+   *
+   * @param put_blob_stream_context The put blob stream context object.
+   * @param tracker The tracker for this specific upload.
+   */
+  void PumpPutBlobStreamParts(
+      core::ProducerStreamingContext<
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamRequest,
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamResponse>
+          put_blob_stream_context,
+      std::shared_ptr<PutBlobStreamTracker> tracker) noexcept;
+
+  /**
+   * @brief Uploads a part as a temporary object, on the IO executor.
+   *
+   * @param put_blob_stream_context The put blob stream context object.
+   * @param tracker The tracker for this specific upload.
+   * @param part_number The number of the part.
+   * @param data The contents of the part.
+   */
+  void UploadPutBlobStreamPart(
+      core::ProducerStreamingContext<
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamRequest,
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamResponse>
+          put_blob_stream_context,
+      std::shared_ptr<PutBlobStreamTracker> tracker, int64_t part_number,
+      const std::string& data) noexcept;
+
+  /**
+   * @brief Composes the uploaded parts into the blob, then deletes them.
+   *
+   * @param put_blob_stream_context The put blob stream context object.
+   * @param tracker The tracker for this specific upload.
+   */
+  void ComposePutBlobStreamParts(
+      core::ProducerStreamingContext<
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamRequest,
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamResponse>
+          put_blob_stream_context,
+      std::shared_ptr<PutBlobStreamTracker> tracker) noexcept;
+
+  /**
+   * @brief Deletes the temporary objects of the uploaded parts. Failures are
+   * only logged, as the blob itself is not affected.
+   *
+   * @param put_blob_stream_context The put blob stream context object.
+   * @param tracker The tracker for this specific upload.
+   * @param cloud_storage_client The client to delete the objects with.
+   */
+  void DeletePutBlobStreamParts(
+      core::ProducerStreamingContext<
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamRequest,
+          cmrt::sdk::blob_storage_service::v1::PutBlobStreamResponse>&
+          put_blob_stream_context,
+      const PutBlobStreamTracker& tracker,
+      google::cloud::storage::Client& cloud_storage_client) noexcept;
+
   /**
    * @brief Is called when the object is returned from the Cloud Storage
    * DeleteObject callback.
@@ -281,6 +374,17 @@ class GcpCloudStorageFactory {
   CreateClient(std::shared_ptr<BlobStorageClientOptions> options,
                const std::string& project_id) noexcept;
 
+  /**
+   * @brief Creates the options of the client created by CreateClient.
+   *
+   * @param options the blob storage client options.
+   * @param project_id the project of the client.
+   * @return google::cloud::Options
+   */
+  virtual google::cloud::Options CreateClientOptions(
+      std::shared_ptr<BlobStorageClientOptions> options,
+      const std::string& project_id) noexcept;
+
   virtual ~GcpCloudStorageFactory() = default;
 };
 
@@ -585,6 +585,162 @@ TEST_F(AwsS3ClientProviderStreamTest,
   cpu_async_executor->Stop();
 }
 
+TEST_F(AwsS3ClientProviderStreamTest, PutBlobStreamUploadsPartsInParallel) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->put_blob_stream_part_size_bytes = kMinimumPartSize;
+  options->put_blob_stream_max_concurrent_parts = 2;
+  AwsS3ClientProvider provider(options, instance_client_,
+                               make_shared<MockAsyncExecutor>(),
+                               make_shared<MockAsyncExecutor>(), s3_factory_);
+  EXPECT_SUCCESS(provider.Init());
+  EXPECT_SUCCESS(provider.Run());
+
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_bucket_name(kBucketName);
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_blob_name(kBlobName);
+  // The portions are coalesced into parts of kMinimumPartSize.
+  string half_part_a(kMinimumPartSize / 2, 'a');
+  string part_b(kMinimumPartSize, 'b');
+  string half_part_c(kMinimumPartSize / 2, 'c');
+  put_blob_stream_context_.request->mutable_blob_portion()->set_data(
+      half_part_a);
+  auto request2 = *put_blob_stream_context_.request;
+  request2.mutable_blob_portion()->set_data(part_b);
+  auto request3 = *put_blob_stream_context_.request;
+  request3.mutable_blob_portion()->set_data(half_part_c);
+  put_blob_stream_context_.TryPushRequest(move(request2));
+  put_blob_stream_context_.TryPushRequest(move(request3));
+  put_blob_stream_context_.MarkDone();
+
+  put_blob_stream_context_.callback = [this](auto& context) {
+    EXPECT_SUCCESS(context.result);
+    finish_called_ = true;
+  };
+
+  string upload_id = "upload id";
+  EXPECT_CALL(*s3_client_, CreateMultipartUploadAsync(
+                               HasBucketAndKey(kBucketName, kBlobName), _, _))
+      .WillOnce([this, &upload_id](auto request, auto& callback, auto) {
+        CreateMultipartUploadResult result;
+        result.SetUploadId(upload_id);
+        CreateMultipartUploadOutcome outcome(move(result));
+        callback(abstract_client_, request, move(outcome), nullptr);
+      });
+
+  // Holds the uploads, so that both parts are in flight at once.
+  vector<std::pair<UploadPartRequest,
+                   Aws::S3::UploadPartResponseReceivedHandler>>
+      uploads;
+  auto hold_upload = [&uploads](auto request, auto& callback, auto) {
+    uploads.emplace_back(request, callback);
+  };
+  string part1 = half_part_a + part_b.substr(0, kMinimumPartSize / 2);
+  string part2 = part_b.substr(kMinimumPartSize / 2) + half_part_c;
+  EXPECT_CALL(*s3_client_,
+              UploadPartAsync(UploadPartRequestEquals(kBucketName, kBlobName,
+                                                      upload_id, 1, part1),
+                              _, _))
+      .WillOnce(hold_upload);
+  EXPECT_CALL(*s3_client_,
+              UploadPartAsync(UploadPartRequestEquals(kBucketName, kBlobName,
+                                                      upload_id, 2, part2),
+                              _, _))
+      .WillOnce(hold_upload);
+
+  CompletedMultipartUpload upload;
+  upload.AddParts(MakeCompletedPart("tag 1", 1));
+  upload.AddParts(MakeCompletedPart("tag 2", 2));
+  EXPECT_CALL(*s3_client_, CompleteMultipartUploadAsync)
+      .WillOnce([this, &upload](auto request, auto& callback, auto) {
+        // The parts are completed in order, whatever the upload order.
+        EXPECT_THAT(request.GetMultipartUpload().GetParts(),
+                    Pointwise(CompletedPartEquals(), upload.GetParts()));
+        CompleteMultipartUploadResult result;
+        CompleteMultipartUploadOutcome outcome(move(result));
+        callback(abstract_client_, request, outcome, nullptr);
+      });
+
+  EXPECT_SUCCESS(provider.PutBlobStream(put_blob_stream_context_));
+  ASSERT_EQ(uploads.size(), 2);
+
+  // Finishes the second part first.
+  for (int i = 1; i >= 0; --i) {
+    UploadPartResult result;
+    result.SetETag(absl::StrCat("tag ", i + 1));
+    auto& [request, callback] = uploads[i];
+    callback(abstract_client_, request, UploadPartOutcome(move(result)),
+             nullptr);
+  }
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(AwsS3ClientProviderStreamTest,
+       PutBlobStreamAbortsParallelPartsIfAPartFails) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->put_blob_stream_part_size_bytes = kMinimumPartSize;
+  AwsS3ClientProvider provider(options, instance_client_,
+                               make_shared<MockAsyncExecutor>(),
+                               make_shared<MockAsyncExecutor>(), s3_factory_);
+  EXPECT_SUCCESS(provider.Init());
+  EXPECT_SUCCESS(provider.Run());
+
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_bucket_name(kBucketName);
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_blob_name(kBlobName);
+  put_blob_stream_context_.request->mutable_blob_portion()->set_data(
+      string(2 * kMinimumPartSize, 'a'));
+  put_blob_stream_context_.MarkDone();
+
+  put_blob_stream_context_.callback = [this](auto& context) {
+    EXPECT_THAT(
+        context.result,
+        ResultIs(FailureExecutionResult(SC_AWS_INTERNAL_SERVICE_ERROR)));
+    finish_called_ = true;
+  };
+
+  string upload_id = "upload id";
+  EXPECT_CALL(*s3_client_, CreateMultipartUploadAsync)
+      .WillOnce([this, &upload_id](auto request, auto& callback, auto) {
+        CreateMultipartUploadResult result;
+        result.SetUploadId(upload_id);
+        CreateMultipartUploadOutcome outcome(move(result));
+        callback(abstract_client_, request, move(outcome), nullptr);
+      });
+  EXPECT_CALL(*s3_client_, UploadPartAsync)
+      .WillOnce([this](auto request, auto& callback, auto) {
+        UploadPartResult result;
+        result.SetETag("tag 1");
+        callback(abstract_client_, request, UploadPartOutcome(move(result)),
+                 nullptr);
+      })
+      .WillOnce([this](auto request, auto& callback, auto) {
+        AWSError<S3Errors> s3_error(S3Errors::ACCESS_DENIED, false);
+        callback(abstract_client_, request, UploadPartOutcome(s3_error),
+                 nullptr);
+      });
+  EXPECT_CALL(*s3_client_, CompleteMultipartUploadAsync).Times(0);
+  EXPECT_CALL(*s3_client_,
+              AbortMultipartUploadAsync(
+                  HasBucketKeyAndUploadId(kBucketName, kBlobName, upload_id),
+                  _, _))
+      .WillOnce([this](auto request, auto& callback, auto) {
+        AbortMultipartUploadResult result;
+        AbortMultipartUploadOutcome outcome(move(result));
+        callback(abstract_client_, request, move(outcome), nullptr);
+      });
+
+  EXPECT_SUCCESS(provider.PutBlobStream(put_blob_stream_context_));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 TEST_F(AwsS3ClientProviderStreamTest, PutBlobStreamFailsIfCreateFails) {
   put_blob_stream_context_.request->mutable_blob_portion()
       ->mutable_metadata()
@@ -16,18 +16,25 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <aws/s3/S3Client.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/Object.h>
 #include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
+#include "absl/strings/str_cat.h"
 #include "core/async_executor/mock/mock_async_executor.h"
 #include "core/test/utils/conditional_wait.h"
 #include "cpio/client_providers/blob_storage_client_provider/test/aws/mock_s3_client.h"
@@ -43,6 +50,12 @@ using Aws::Vector;
 using Aws::Client::AWSError;
 using Aws::Client::ClientConfiguration;
 using Aws::S3::S3Errors;
+using Aws::S3::Model::AbortMultipartUploadOutcome;
+using Aws::S3::Model::AbortMultipartUploadResult;
+using Aws::S3::Model::CompleteMultipartUploadOutcome;
+using Aws::S3::Model::CompleteMultipartUploadResult;
+using Aws::S3::Model::CreateMultipartUploadOutcome;
+using Aws::S3::Model::CreateMultipartUploadResult;
 using Aws::S3::Model::DeleteObjectOutcome;
 using Aws::S3::Model::DeleteObjectRequest;
 using Aws::S3::Model::DeleteObjectResult;
@@ -56,6 +69,8 @@ using Aws::S3::Model::Object;
 using Aws::S3::Model::PutObjectOutcome;
 using Aws::S3::Model::PutObjectRequest;
 using Aws::S3::Model::PutObjectResult;
+using Aws::S3::Model::UploadPartOutcome;
+using Aws::S3::Model::UploadPartResult;
 using google::cmrt::sdk::blob_storage_service::v1::Blob;
 using google::cmrt::sdk::blob_storage_service::v1::BlobMetadata;
 using google::cmrt::sdk::blob_storage_service::v1::DeleteBlobRequest;
@@ -76,6 +91,7 @@ using google::scp::core::test::WaitUntil;
 using google::scp::cpio::client_providers::mock::MockInstanceClientProvider;
 using google::scp::cpio::client_providers::mock::MockS3Client;
 using std::make_shared;
+using std::map;
 using std::move;
 using std::shared_ptr;
 using std::string;
@@ -290,6 +306,114 @@ TEST_F(AwsS3ClientProviderTest, GetBlobWithByteRange) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(AwsS3ClientProviderTest, GetBlobInParallelParts) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->get_blob_part_size_bytes = 5;
+  options->get_blob_max_concurrent_parts = 2;
+  AwsS3ClientProvider provider(options, instance_client_,
+                               make_shared<MockAsyncExecutor>(),
+                               make_shared<MockAsyncExecutor>(), s3_factory_);
+  EXPECT_SUCCESS(provider.Init());
+  EXPECT_SUCCESS(provider.Run());
+
+  auto bucket_name = "bucket_name";
+  auto blob_name = "blob_name";
+  string blob_data("Hello world!");
+  get_blob_context_.request->mutable_blob_metadata()->set_bucket_name(
+      bucket_name);
+  get_blob_context_.request->mutable_blob_metadata()->set_blob_name(blob_name);
+  get_blob_context_.callback =
+      [this, &blob_data](
+          AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) {
+        EXPECT_SUCCESS(get_blob_context.result);
+        EXPECT_EQ(get_blob_context.response->blob().data(), blob_data);
+        finish_called_ = true;
+      };
+
+  // Returns the requested range of blob_data, which is inclusive on both ends.
+  auto get_range = [&blob_data](size_t begin, size_t end) {
+    return [&blob_data, begin, end](auto, auto callback, auto) {
+      GetObjectRequest get_object_request;
+      GetObjectResult get_object_result;
+      auto input_data = new StringStream("");
+      *input_data << blob_data.substr(begin, end - begin + 1);
+      get_object_result.ReplaceBody(input_data);
+      get_object_result.SetContentLength(end - begin + 1);
+      get_object_result.SetContentRange(
+          absl::StrCat("bytes ", begin, "-", end, "/", blob_data.size()));
+      GetObjectOutcome get_object_outcome(move(get_object_result));
+      callback(nullptr /*s3_client*/, get_object_request,
+               move(get_object_outcome), nullptr /*async_context*/);
+    };
+  };
+  EXPECT_CALL(*s3_client_,
+              GetObjectAsync(
+                  HasBucketKeyAndRange(bucket_name, blob_name, "bytes=0-4"), _,
+                  _))
+      .WillOnce(get_range(0, 4));
+  EXPECT_CALL(*s3_client_,
+              GetObjectAsync(
+                  HasBucketKeyAndRange(bucket_name, blob_name, "bytes=5-9"), _,
+                  _))
+      .WillOnce(get_range(5, 9));
+  EXPECT_CALL(*s3_client_,
+              GetObjectAsync(
+                  HasBucketKeyAndRange(bucket_name, blob_name, "bytes=10-11"),
+                  _, _))
+      .WillOnce(get_range(10, 11));
+
+  EXPECT_SUCCESS(provider.GetBlob(get_blob_context_));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(AwsS3ClientProviderTest, GetBlobInPartsFailsIfAPartFails) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->get_blob_part_size_bytes = 5;
+  AwsS3ClientProvider provider(options, instance_client_,
+                               make_shared<MockAsyncExecutor>(),
+                               make_shared<MockAsyncExecutor>(), s3_factory_);
+  EXPECT_SUCCESS(provider.Init());
+  EXPECT_SUCCESS(provider.Run());
+
+  get_blob_context_.request->mutable_blob_metadata()->set_bucket_name(
+      "bucket_name");
+  get_blob_context_.request->mutable_blob_metadata()->set_blob_name(
+      "blob_name");
+  get_blob_context_.callback =
+      [this](AsyncContext<GetBlobRequest, GetBlobResponse>& get_blob_context) {
+        EXPECT_THAT(
+            get_blob_context.result,
+            ResultIs(FailureExecutionResult(SC_AWS_INTERNAL_SERVICE_ERROR)));
+        finish_called_ = true;
+      };
+
+  EXPECT_CALL(*s3_client_, GetObjectAsync)
+      .WillOnce([](auto, auto callback, auto) {
+        GetObjectRequest get_object_request;
+        GetObjectResult get_object_result;
+        auto input_data = new StringStream("");
+        *input_data << "Hello";
+        get_object_result.ReplaceBody(input_data);
+        get_object_result.SetContentLength(5);
+        get_object_result.SetContentRange("bytes 0-4/12");
+        GetObjectOutcome get_object_outcome(move(get_object_result));
+        callback(nullptr /*s3_client*/, get_object_request,
+                 move(get_object_outcome), nullptr /*async_context*/);
+      })
+      .WillRepeatedly([](auto, auto callback, auto) {
+        GetObjectRequest get_object_request;
+        AWSError<S3Errors> s3_error(S3Errors::ACCESS_DENIED, false);
+        GetObjectOutcome get_object_outcome(s3_error);
+        callback(nullptr /*s3_client*/, get_object_request,
+                 move(get_object_outcome), nullptr /*async_context*/);
+      });
+
+  EXPECT_SUCCESS(provider.GetBlob(get_blob_context_));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 MATCHER_P3(HasBucketPrefixAndMarker, bucket, prefix, marker, "") {
   return ExplainMatchResult(Eq(bucket), arg.GetBucket(), result_listener) &&
          ExplainMatchResult(Eq(prefix), arg.GetPrefix(), result_listener) &&
@@ -503,6 +627,147 @@ TEST_F(AwsS3ClientProviderTest, PutBlobSuccess) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(AwsS3ClientProviderTest, PutBlobInParallelParts) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  // Raised to the 5MiB minimum.
+  options->put_blob_part_size_bytes = 1;
+  options->put_blob_max_concurrent_parts = 2;
+  AwsS3ClientProvider provider(options, instance_client_,
+                               make_shared<MockAsyncExecutor>(),
+                               make_shared<MockAsyncExecutor>(), s3_factory_);
+  EXPECT_SUCCESS(provider.Init());
+  EXPECT_SUCCESS(provider.Run());
+
+  auto bucket_name = "bucket_name";
+  auto blob_name = "blob_name";
+  constexpr size_t kPartSize = 5 << 20;
+  vector<string> parts{string(kPartSize, 'a'), string(kPartSize, 'b'), "c"};
+  put_blob_context_.request->mutable_blob()
+      ->mutable_metadata()
+      ->set_bucket_name(bucket_name);
+  put_blob_context_.request->mutable_blob()->mutable_metadata()->set_blob_name(
+      blob_name);
+  put_blob_context_.request->mutable_blob()->set_data(
+      absl::StrCat(parts[0], parts[1], parts[2]));
+  put_blob_context_.callback =
+      [this](AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) {
+        EXPECT_SUCCESS(put_blob_context.result);
+        EXPECT_NE(put_blob_context.response, nullptr);
+        finish_called_ = true;
+      };
+
+  EXPECT_CALL(*s3_client_, CreateMultipartUploadAsync(
+                               HasBucketAndKey(bucket_name, blob_name), _, _))
+      .WillOnce([](auto request, auto& callback, auto) {
+        CreateMultipartUploadResult result;
+        result.SetUploadId("upload id");
+        CreateMultipartUploadOutcome outcome(move(result));
+        callback(nullptr /*s3_client*/, request, move(outcome),
+                 nullptr /*async_context*/);
+      });
+  std::mutex uploaded_parts_mutex;
+  map<int, string> uploaded_parts;
+  EXPECT_CALL(*s3_client_, UploadPartAsync)
+      .Times(3)
+      .WillRepeatedly([&](auto request, auto& callback, auto) {
+        EXPECT_EQ(request.GetUploadId(), "upload id");
+        {
+          std::lock_guard<std::mutex> lock(uploaded_parts_mutex);
+          uploaded_parts[request.GetPartNumber()] =
+              string(std::istreambuf_iterator<char>(*request.GetBody()), {});
+        }
+        UploadPartResult result;
+        result.SetETag(absl::StrCat("etag ", request.GetPartNumber()));
+        UploadPartOutcome outcome(move(result));
+        callback(nullptr /*s3_client*/, request, move(outcome),
+                 nullptr /*async_context*/);
+      });
+  EXPECT_CALL(*s3_client_, CompleteMultipartUploadAsync)
+      .WillOnce([](auto request, auto& callback, auto) {
+        EXPECT_EQ(request.GetUploadId(), "upload id");
+        const auto& completed_parts = request.GetMultipartUpload().GetParts();
+        EXPECT_EQ(completed_parts.size(), 3);
+        for (size_t i = 0; i < completed_parts.size(); ++i) {
+          EXPECT_EQ(completed_parts[i].GetPartNumber(), i + 1);
+          EXPECT_EQ(completed_parts[i].GetETag(),
+                    absl::StrCat("etag ", i + 1).c_str());
+        }
+        CompleteMultipartUploadResult result;
+        CompleteMultipartUploadOutcome outcome(move(result));
+        callback(nullptr /*s3_client*/, request, move(outcome),
+                 nullptr /*async_context*/);
+      });
+  EXPECT_CALL(*s3_client_, PutObjectAsync).Times(0);
+
+  EXPECT_SUCCESS(provider.PutBlob(put_blob_context_));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+  EXPECT_EQ(uploaded_parts,
+            (map<int, string>{{1, parts[0]}, {2, parts[1]}, {3, parts[2]}}));
+}
+
+TEST_F(AwsS3ClientProviderTest, PutBlobInPartsAbortsIfAPartFails) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->put_blob_part_size_bytes = 5 << 20;
+  AwsS3ClientProvider provider(options, instance_client_,
+                               make_shared<MockAsyncExecutor>(),
+                               make_shared<MockAsyncExecutor>(), s3_factory_);
+  EXPECT_SUCCESS(provider.Init());
+  EXPECT_SUCCESS(provider.Run());
+
+  put_blob_context_.request->mutable_blob()
+      ->mutable_metadata()
+      ->set_bucket_name("bucket_name");
+  put_blob_context_.request->mutable_blob()->mutable_metadata()->set_blob_name(
+      "blob_name");
+  put_blob_context_.request->mutable_blob()->set_data(
+      string((5 << 20) * 3, 'a'));
+  put_blob_context_.callback =
+      [this](AsyncContext<PutBlobRequest, PutBlobResponse>& put_blob_context) {
+        EXPECT_THAT(
+            put_blob_context.result,
+            ResultIs(FailureExecutionResult(SC_AWS_INTERNAL_SERVICE_ERROR)));
+        finish_called_ = true;
+      };
+
+  EXPECT_CALL(*s3_client_, CreateMultipartUploadAsync)
+      .WillOnce([](auto request, auto& callback, auto) {
+        CreateMultipartUploadResult result;
+        result.SetUploadId("upload id");
+        CreateMultipartUploadOutcome outcome(move(result));
+        callback(nullptr /*s3_client*/, request, move(outcome),
+                 nullptr /*async_context*/);
+      });
+  EXPECT_CALL(*s3_client_, UploadPartAsync)
+      .WillRepeatedly([](auto request, auto& callback, auto) {
+        if (request.GetPartNumber() == 2) {
+          AWSError<S3Errors> s3_error(S3Errors::ACCESS_DENIED, false);
+          UploadPartOutcome outcome(s3_error);
+          callback(nullptr /*s3_client*/, request, move(outcome),
+                   nullptr /*async_context*/);
+          return;
+        }
+        UploadPartResult result;
+        result.SetETag("etag");
+        UploadPartOutcome outcome(move(result));
+        callback(nullptr /*s3_client*/, request, move(outcome),
+                 nullptr /*async_context*/);
+      });
+  EXPECT_CALL(*s3_client_, AbortMultipartUploadAsync)
+      .WillOnce([](auto request, auto& callback, auto) {
+        EXPECT_EQ(request.GetUploadId(), "upload id");
+        AbortMultipartUploadResult result;
+        AbortMultipartUploadOutcome outcome(move(result));
+        callback(nullptr /*s3_client*/, request, move(outcome),
+                 nullptr /*async_context*/);
+      });
+  EXPECT_CALL(*s3_client_, CompleteMultipartUploadAsync).Times(0);
+
+  EXPECT_SUCCESS(provider.PutBlob(put_blob_context_));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 TEST_F(AwsS3ClientProviderTest, DeleteBlobFailure) {
   auto bucket_name = "bucket_name";
   auto blob_name = "blob_name";
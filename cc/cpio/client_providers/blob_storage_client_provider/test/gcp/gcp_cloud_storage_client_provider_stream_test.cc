@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -54,6 +55,7 @@ using google::cloud::storage::internal::ConstBuffer;
 using google::cloud::storage::internal::ConstBufferSequence;
 using google::cloud::storage::internal::CreateHashFunction;
 using google::cloud::storage::internal::CreateResumableUploadResponse;
+using google::cloud::storage::internal::EmptyResponse;
 using google::cloud::storage::internal::HttpResponse;
 using google::cloud::storage::internal::ObjectReadSource;
 using google::cloud::storage::internal::QueryResumableUploadResponse;
@@ -106,12 +108,14 @@ using std::this_thread::sleep_for;
 using testing::ByMove;
 using testing::ElementsAre;
 using testing::ElementsAreArray;
+using testing::EndsWith;
 using testing::Eq;
 using testing::ExplainMatchResult;
 using testing::InSequence;
 using testing::NiceMock;
 using testing::Pointwise;
 using testing::Return;
+using testing::StartsWith;
 
 namespace google::scp::cpio::client_providers::test {
 namespace {
@@ -886,5 +890,117 @@ TEST_F(GcpCloudStorageClientProviderStreamTest, PutBlobStreamFailsIfCancelled) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+MATCHER_P2(InsertsPart, part_number, contents, "") {
+  return ExplainMatchResult(Eq(kBucketName), arg.bucket_name(),
+                            result_listener) &&
+         ExplainMatchResult(StartsWith(absl::StrCat(kBlobName, ".part-")),
+                            arg.object_name(), result_listener) &&
+         ExplainMatchResult(EndsWith(absl::StrCat("-", part_number)),
+                            arg.object_name(), result_listener) &&
+         ExplainMatchResult(Eq(contents), arg.contents(), result_listener);
+}
+
+TEST_F(GcpCloudStorageClientProviderStreamTest,
+       PutBlobStreamComposesPartsUploadedInParallel) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->put_blob_stream_part_size_bytes = 4;
+  options->put_blob_stream_max_concurrent_parts = 2;
+  GcpCloudStorageClientProvider client(options, instance_client_,
+                                       make_shared<MockAsyncExecutor>(),
+                                       make_shared<MockAsyncExecutor>(),
+                                       storage_factory_);
+  EXPECT_SUCCESS(client.Init());
+  EXPECT_SUCCESS(client.Run());
+
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_bucket_name(kBucketName);
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_blob_name(kBlobName);
+  put_blob_stream_context_.request->mutable_blob_portion()->set_data(
+      "abcdefghij");
+  put_blob_stream_context_.MarkDone();
+
+  vector<string> part_names;
+  auto record_part = [&part_names](const auto& request) {
+    part_names.push_back(request.object_name());
+    return StatusOr<ObjectMetadata>(ObjectMetadata());
+  };
+  EXPECT_CALL(*mock_client_, CreateResumableUpload).Times(0);
+  EXPECT_CALL(*mock_client_, InsertObjectMedia(InsertsPart(1, "abcd")))
+      .WillOnce(record_part);
+  EXPECT_CALL(*mock_client_, InsertObjectMedia(InsertsPart(2, "efgh")))
+      .WillOnce(record_part);
+  EXPECT_CALL(*mock_client_, InsertObjectMedia(InsertsPart(3, "ij")))
+      .WillOnce(record_part);
+  EXPECT_CALL(*mock_client_, ComposeObject)
+      .WillOnce([&part_names](const auto& request) {
+        EXPECT_EQ(request.bucket_name(), kBucketName);
+        EXPECT_EQ(request.destination_object_name(), kBlobName);
+        vector<string> source_names;
+        for (const auto& source : request.source_objects()) {
+          source_names.push_back(source.object_name);
+        }
+        // The parts are composed in order, whatever the upload order.
+        std::sort(part_names.begin(), part_names.end());
+        EXPECT_EQ(source_names, part_names);
+        return StatusOr<ObjectMetadata>(ObjectMetadata());
+      });
+  EXPECT_CALL(*mock_client_, DeleteObject)
+      .Times(3)
+      .WillRepeatedly(Return(EmptyResponse{}));
+
+  put_blob_stream_context_.callback = [this](auto& context) {
+    EXPECT_SUCCESS(context.result);
+    finish_called_ = true;
+  };
+
+  EXPECT_THAT(client.PutBlobStream(put_blob_stream_context_), IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(GcpCloudStorageClientProviderStreamTest,
+       PutBlobStreamDeletesPartsIfAPartFails) {
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->put_blob_stream_part_size_bytes = 4;
+  GcpCloudStorageClientProvider client(options, instance_client_,
+                                       make_shared<MockAsyncExecutor>(),
+                                       make_shared<MockAsyncExecutor>(),
+                                       storage_factory_);
+  EXPECT_SUCCESS(client.Init());
+  EXPECT_SUCCESS(client.Run());
+
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_bucket_name(kBucketName);
+  put_blob_stream_context_.request->mutable_blob_portion()
+      ->mutable_metadata()
+      ->set_blob_name(kBlobName);
+  put_blob_stream_context_.request->mutable_blob_portion()->set_data(
+      "abcdefgh");
+  put_blob_stream_context_.MarkDone();
+
+  EXPECT_CALL(*mock_client_, InsertObjectMedia(InsertsPart(1, "abcd")))
+      .WillOnce(Return(ObjectMetadata()));
+  EXPECT_CALL(*mock_client_, InsertObjectMedia(InsertsPart(2, "efgh")))
+      .WillOnce(Return(Status(CloudStatusCode::kInvalidArgument, "fail")));
+  EXPECT_CALL(*mock_client_, ComposeObject).Times(0);
+  // Only the uploaded part is deleted.
+  EXPECT_CALL(*mock_client_, DeleteObject).WillOnce(Return(EmptyResponse{}));
+
+  put_blob_stream_context_.callback = [this](auto& context) {
+    EXPECT_THAT(context.result,
+                ResultIs(FailureExecutionResult(
+                    SC_BLOB_STORAGE_PROVIDER_UNRETRIABLE_ERROR)));
+    finish_called_ = true;
+  };
+
+  EXPECT_THAT(client.PutBlobStream(put_blob_stream_context_), IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 }  // namespace
 }  // namespace google::scp::cpio::client_providers::test
@@ -29,12 +29,16 @@
 #include "core/utils/src/hashing.h"
 #include "cpio/client_providers/blob_storage_client_provider/src/common/error_codes.h"
 #include "cpio/client_providers/instance_client_provider/mock/mock_instance_client_provider.h"
+#include "google/cloud/common_options.h"
+#include "google/cloud/grpc_options.h"
 #include "google/cloud/status.h"
 #include "google/cloud/storage/client.h"
 #include "google/cloud/storage/internal/object_requests.h"
 #include "google/cloud/storage/testing/mock_client.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 
+using google::cloud::EndpointOption;
+using google::cloud::GrpcNumChannelsOption;
 using google::cloud::Status;
 using google::cloud::StatusOr;
 using CloudStatusCode = google::cloud::StatusCode;
@@ -45,6 +49,7 @@ using google::cloud::storage::MaxResults;
 using google::cloud::storage::MD5HashValue;
 using google::cloud::storage::ObjectMetadata;
 using google::cloud::storage::Prefix;
+using google::cloud::storage::ProjectIdOption;
 using google::cloud::storage::ReadRange;
 using google::cloud::storage::StartOffset;
 using google::cloud::storage::internal::EmptyResponse;
@@ -897,4 +902,34 @@ TEST_F(GcpCloudStorageClientProviderTest, DeleteBlob) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST(GcpCloudStorageFactoryTest, CreateClientOptionsAppliesTheGrpcOptions) {
+  GcpCloudStorageFactory factory;
+  auto options = make_shared<BlobStorageClientOptions>();
+  options->use_grpc_transport = true;
+  options->use_direct_path = true;
+  options->grpc_channel_count = 8;
+
+  auto client_options = factory.CreateClientOptions(options, "project");
+  EXPECT_EQ(client_options.get<ProjectIdOption>(), "project");
+  EXPECT_EQ(client_options.get<GrpcNumChannelsOption>(), 8);
+  EXPECT_EQ(client_options.get<EndpointOption>(),
+            "google-c2p:///storage.googleapis.com");
+
+  // The library picks the channels and the endpoint when they are not set.
+  options->use_direct_path = false;
+  options->grpc_channel_count = 0;
+  client_options = factory.CreateClientOptions(options, "project");
+  EXPECT_FALSE(client_options.has<GrpcNumChannelsOption>());
+  EXPECT_FALSE(client_options.has<EndpointOption>());
+
+  // The gRPC options do not apply to the JSON transport.
+  options->use_grpc_transport = false;
+  options->use_direct_path = true;
+  options->grpc_channel_count = 8;
+  client_options = factory.CreateClientOptions(options, "project");
+  EXPECT_EQ(client_options.get<ProjectIdOption>(), "project");
+  EXPECT_FALSE(client_options.has<GrpcNumChannelsOption>());
+  EXPECT_FALSE(client_options.has<EndpointOption>());
+}
+
 }  // namespace google::scp::cpio::client_providers::test
@@ -39,6 +39,11 @@ class MockCryptoClientProvider : public CryptoClientProviderInterface {
                   cmrt::sdk::crypto_service::v1::HpkeDecryptRequest,
                   cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>&)),
               (override, noexcept));
+  MOCK_METHOD(core::ExecutionResult, BatchHpkeDecrypt,
+              ((core::AsyncContext<
+                  cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest,
+                  cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse>&)),
+              (override, noexcept));
   MOCK_METHOD(core::ExecutionResult, AeadEncrypt,
               ((core::AsyncContext<
                   cmrt::sdk::crypto_service::v1::AeadEncryptRequest,
@@ -16,6 +16,8 @@
 
 #include "crypto_client_provider.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdint>
 #include <functional>
@@ -36,7 +38,9 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
+#include "core/common/lru_cache/src/sharded_lru_cache.h"
 #include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
 #include "core/interface/service_interface.h"
 #include "core/utils/src/base64.h"
 #include "cpio/client_providers/interface/type_def.h"
@@ -62,6 +66,8 @@ using google::cmrt::sdk::crypto_service::v1::AeadDecryptRequest;
 using google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::AeadEncryptRequest;
 using google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest;
+using google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::HpkeAead;
 using google::cmrt::sdk::crypto_service::v1::HpkeDecryptRequest;
 using google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
@@ -71,13 +77,18 @@ using google::cmrt::sdk::crypto_service::v1::HpkeKdf;
 using google::cmrt::sdk::crypto_service::v1::HpkeKem;
 using google::cmrt::sdk::crypto_service::v1::HpkeParams;
 using google::cmrt::sdk::crypto_service::v1::SecretLength;
+using google::cmrt::sdk::private_key_service::v1::PrivateKey;
 using google::crypto::tink::HpkePrivateKey;
 using google::protobuf::Any;
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncExecutorInterface;
+using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::PublicPrivateKeyPairId;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::common::ShardedLruCache;
 using google::scp::core::errors::SC_CRYPTO_CLIENT_PROVIDER_AEAD_DECRYPT_FAILED;
 using google::scp::core::errors::SC_CRYPTO_CLIENT_PROVIDER_AEAD_ENCRYPT_FAILED;
 using google::scp::core::errors::
@@ -96,6 +107,7 @@ using google::scp::core::errors::SC_CRYPTO_CLIENT_PROVIDER_SECRET_EXPORT_FAILED;
 using google::scp::core::errors::
     SC_CRYPTO_CLIENT_PROVIDER_SPLIT_CIPHERTEXT_FAILED;
 using google::scp::core::utils::Base64Decode;
+using std::atomic;
 using std::bind;
 using std::isxdigit;
 using std::make_shared;
@@ -114,6 +126,8 @@ namespace {
 /// Filename for logging errors
 constexpr char kCryptoClientProvider[] = "CryptoClientProvider";
 constexpr char kDefaultExporterContext[] = "aead key";
+/// How many ciphertexts of a BatchHpkeDecrypt are decrypted per task.
+constexpr size_t kBatchHpkeDecryptChunkSize = 64;
 }  // namespace
 
 namespace google::scp::cpio::client_providers {
@@ -218,6 +232,17 @@ uint64_t GetRandomNumber(int size) {
   return distribution(random_generator) % size;
 }
 
+CryptoClientProvider::CryptoClientProvider(
+    const shared_ptr<CryptoClientOptions>& options,
+    const shared_ptr<AsyncExecutorInterface>& cpu_async_executor)
+    : options_(options), cpu_async_executor_(cpu_async_executor) {
+  if (options_ && options_->hpke_private_key_cache_capacity > 0) {
+    hpke_private_key_cache_ =
+        make_unique<ShardedLruCache<string, ParsedHpkePrivateKey>>(
+            options_->hpke_private_key_cache_capacity);
+  }
+}
+
 ExecutionResult CryptoClientProvider::Init() noexcept {
   return SuccessExecutionResult();
 }
@@ -297,137 +322,234 @@ ExecutionResult CryptoClientProvider::HpkeEncrypt(
   return SuccessExecutionResult();
 }
 
-ExecutionResult CryptoClientProvider::HpkeDecrypt(
-    AsyncContext<HpkeDecryptRequest, HpkeDecryptResponse>&
-        decrypt_context) noexcept {
+template <typename Context>
+ExecutionResultOr<shared_ptr<const CryptoClientProvider::ParsedHpkePrivateKey>>
+CryptoClientProvider::GetHpkePrivateKey(const PrivateKey& private_key,
+                                        Context& context) noexcept {
+  const auto& encoded_private_key = private_key.private_key();
+  if (hpke_private_key_cache_ && !private_key.key_id().empty()) {
+    auto cached_private_key =
+        hpke_private_key_cache_->Get(private_key.key_id());
+    // The key is parsed again if its ID is reused for another key.
+    if (cached_private_key &&
+        cached_private_key->encoded_private_key == encoded_private_key) {
+      return cached_private_key;
+    }
+  }
+
   string decoded_key;
-  auto execution_result = Base64Decode(
-      decrypt_context.request->private_key().private_key(), decoded_key);
+  auto execution_result = Base64Decode(encoded_private_key, decoded_key);
   if (!execution_result.Successful()) {
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error.");
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
 
   auto keyset_reader = BinaryKeysetReader::New(decoded_key);
   if (!keyset_reader.ok()) {
     auto execution_result = FailureExecutionResult(
         SC_CRYPTO_CLIENT_PROVIDER_CANNOT_READ_BINARY_KEY_SET_FROM_PRIVATE_KEY);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error %s.",
                       keyset_reader.status().ToString().c_str());
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
 
   auto keyset_handle = CleartextKeysetHandle::Read(move(*keyset_reader));
   if (!keyset_handle.ok()) {
     auto execution_result = FailureExecutionResult(
         SC_CRYPTO_CLIENT_PROVIDER_CANNOT_CREATE_KEYSET_HANDLE);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error %s.",
                       keyset_handle.status().ToString().c_str());
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
 
   auto keyset = CleartextKeysetHandle::GetKeyset(*keyset_handle.value());
   if (keyset.key_size() != 1) {
     auto execution_result =
         FailureExecutionResult(SC_CRYPTO_CLIENT_PROVIDER_INVALID_KEYSET_SIZE);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error.");
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
-  auto hpke_params = ToHpkeParams(decrypt_context.request->hpke_params(),
-                                  GetExistingHpkeParams(options_->hpke_params));
-  auto splitted_ciphertext = SplitPayload(
-      hpke_params.kem, decrypt_context.request->encrypted_data().ciphertext());
+
+  HpkePrivateKey hpke_private_key;
+  if (!hpke_private_key.ParseFromString(keyset.key(0).key_data().value())) {
+    auto execution_result = FailureExecutionResult(
+        SC_CRYPTO_CLIENT_PROVIDER_PARSE_HPKE_PRIVATE_KEY_FAILED);
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
+                      "Hpke decryption failed with error.");
+    return execution_result;
+  }
+
+  auto parsed_private_key = make_shared<const ParsedHpkePrivateKey>(
+      ParsedHpkePrivateKey{encoded_private_key,
+                           SecretDataFromStringView(
+                               hpke_private_key.private_key())});
+  if (hpke_private_key_cache_ && !private_key.key_id().empty()) {
+    hpke_private_key_cache_->Set(private_key.key_id(), *parsed_private_key);
+  }
+  return parsed_private_key;
+}
+
+template <typename Request, typename Context>
+ExecutionResult CryptoClientProvider::HpkeOpen(
+    const ParsedHpkePrivateKey& private_key,
+    const tink::HpkeParams& hpke_params, const Request& request,
+    const string& ciphertext, HpkeDecryptResponse& response,
+    Context& context) noexcept {
+  auto splitted_ciphertext = SplitPayload(hpke_params.kem, ciphertext);
   if (!splitted_ciphertext.ok()) {
     auto execution_result = FailureExecutionResult(
         SC_CRYPTO_CLIENT_PROVIDER_SPLIT_CIPHERTEXT_FAILED);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error %s.",
                       splitted_ciphertext.status().ToString().c_str());
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
-  }
-
-  HpkePrivateKey private_key;
-  if (!private_key.ParseFromString(keyset.key(0).key_data().value())) {
-    auto execution_result = FailureExecutionResult(
-        SC_CRYPTO_CLIENT_PROVIDER_PARSE_HPKE_PRIVATE_KEY_FAILED);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
-                      "Hpke decryption failed with error.");
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
 
   auto cipher = HpkeContext::SetupRecipient(
-      hpke_params, SecretDataFromStringView(private_key.private_key()),
+      hpke_params, private_key.private_key,
       splitted_ciphertext->encapsulated_key, "" /*Empty applicaion info*/);
-
   if (!cipher.ok()) {
     auto execution_result = FailureExecutionResult(
         SC_CRYPTO_CLIENT_PROVIDER_CREATE_HPKE_CONTEXT_FAILED);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error %s.",
                       cipher.status().ToString().c_str());
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
 
-  auto payload = (*cipher)->Open(splitted_ciphertext->ciphertext,
-                                 decrypt_context.request->shared_info());
+  auto payload =
+      (*cipher)->Open(splitted_ciphertext->ciphertext, request.shared_info());
   if (!payload.ok()) {
     auto execution_result =
         FailureExecutionResult(SC_CRYPTO_CLIENT_PROVIDER_HPKE_DECRYPT_FAILED);
-    SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context, execution_result,
+    SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                       "Hpke decryption failed with error %s.",
                       payload.status().ToString().c_str());
-    decrypt_context.result = execution_result;
-    decrypt_context.Finish();
-    return decrypt_context.result;
+    return execution_result;
   }
 
-  decrypt_context.response = make_shared<HpkeDecryptResponse>();
-  if (decrypt_context.request->is_bidirectional()) {
-    auto secret = (*cipher)->Export(
-        decrypt_context.request->exporter_context().empty()
-            ? kDefaultExporterContext
-            : decrypt_context.request->exporter_context(),
-        GetSecretLength(decrypt_context.request->secret_length()));
+  if (request.is_bidirectional()) {
+    auto secret = (*cipher)->Export(request.exporter_context().empty()
+                                        ? kDefaultExporterContext
+                                        : request.exporter_context(),
+                                    GetSecretLength(request.secret_length()));
     if (!secret.ok()) {
       auto execution_result = FailureExecutionResult(
           SC_CRYPTO_CLIENT_PROVIDER_SECRET_EXPORT_FAILED);
-      SCP_ERROR_CONTEXT(kCryptoClientProvider, decrypt_context,
-                        execution_result,
+      SCP_ERROR_CONTEXT(kCryptoClientProvider, context, execution_result,
                         "Hpke decryption failed with error %s.",
                         secret.status().ToString().c_str());
-      decrypt_context.result = execution_result;
-      decrypt_context.Finish();
-      return decrypt_context.result;
+      return execution_result;
     }
-    decrypt_context.response->set_secret(
-        string(SecretDataAsStringView(*secret)));
+    response.set_secret(string(SecretDataAsStringView(*secret)));
   }
 
-  decrypt_context.response->set_payload(*payload);
+  response.set_payload(move(*payload));
+  return SuccessExecutionResult();
+}
+
+ExecutionResult CryptoClientProvider::HpkeDecrypt(
+    AsyncContext<HpkeDecryptRequest, HpkeDecryptResponse>&
+        decrypt_context) noexcept {
+  auto private_key = GetHpkePrivateKey(decrypt_context.request->private_key(),
+                                       decrypt_context);
+  if (!private_key.Successful()) {
+    decrypt_context.result = private_key.result();
+    decrypt_context.Finish();
+    return decrypt_context.result;
+  }
+
+  auto hpke_params = ToHpkeParams(decrypt_context.request->hpke_params(),
+                                  GetExistingHpkeParams(options_->hpke_params));
+  auto response = make_shared<HpkeDecryptResponse>();
+  auto execution_result = HpkeOpen(
+      **private_key, hpke_params, *decrypt_context.request,
+      decrypt_context.request->encrypted_data().ciphertext(), *response,
+      decrypt_context);
+  if (!execution_result.Successful()) {
+    decrypt_context.result = execution_result;
+    decrypt_context.Finish();
+    return decrypt_context.result;
+  }
+
+  decrypt_context.response = move(response);
   decrypt_context.result = SuccessExecutionResult();
   decrypt_context.Finish();
 
   return SuccessExecutionResult();
 }
 
+ExecutionResult CryptoClientProvider::BatchHpkeDecrypt(
+    AsyncContext<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse>&
+        decrypt_context) noexcept {
+  auto private_key = GetHpkePrivateKey(decrypt_context.request->private_key(),
+                                       decrypt_context);
+  if (!private_key.Successful()) {
+    decrypt_context.result = private_key.result();
+    decrypt_context.Finish();
+    return decrypt_context.result;
+  }
+
+  auto hpke_params = ToHpkeParams(decrypt_context.request->hpke_params(),
+                                  GetExistingHpkeParams(options_->hpke_params));
+  const size_t ciphertext_count =
+      decrypt_context.request->encrypted_data().size();
+  decrypt_context.response = make_shared<BatchHpkeDecryptResponse>();
+  auto& responses = *decrypt_context.response->mutable_responses();
+  responses.Reserve(ciphertext_count);
+  for (size_t i = 0; i < ciphertext_count; ++i) {
+    responses.Add();
+  }
+
+  const size_t chunk_count =
+      (ciphertext_count + kBatchHpkeDecryptChunkSize - 1) /
+      kBatchHpkeDecryptChunkSize;
+  if (chunk_count == 0) {
+    decrypt_context.result = SuccessExecutionResult();
+    decrypt_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  // Every chunk fills its own responses, the last one to be done finishes the
+  // context.
+  auto unfinished_chunk_count = make_shared<atomic<size_t>>(chunk_count);
+  shared_ptr<const ParsedHpkePrivateKey> parsed_private_key =
+      move(*private_key);
+  for (size_t chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+    const size_t begin = chunk_index * kBatchHpkeDecryptChunkSize;
+    const size_t end =
+        std::min(begin + kBatchHpkeDecryptChunkSize, ciphertext_count);
+    auto decrypt_chunk = [this, decrypt_context, parsed_private_key,
+                          hpke_params, unfinished_chunk_count, begin,
+                          end]() mutable {
+      for (size_t i = begin; i < end; ++i) {
+        auto& response = *decrypt_context.response->mutable_responses(i);
+        auto execution_result = HpkeOpen(
+            *parsed_private_key, hpke_params, *decrypt_context.request,
+            decrypt_context.request->encrypted_data(i).ciphertext(), response,
+            decrypt_context);
+        *response.mutable_result() = execution_result.ToProto();
+      }
+      if (unfinished_chunk_count->fetch_sub(1) == 1) {
+        decrypt_context.result = SuccessExecutionResult();
+        decrypt_context.Finish();
+      }
+    };
+    // A chunk that cannot be scheduled is decrypted on the calling thread.
+    if (!cpu_async_executor_ || chunk_count == 1 ||
+        !cpu_async_executor_->Schedule(decrypt_chunk, AsyncPriority::Normal)
+             .Successful()) {
+      decrypt_chunk();
+    }
+  }
+
+  return SuccessExecutionResult();
+}
+
 ExecutionResult CryptoClientProvider::AeadEncrypt(
     AsyncContext<AeadEncryptRequest, AeadEncryptResponse>& context) noexcept {
   SecretData key = SecretDataFromStringView(context.request->secret());
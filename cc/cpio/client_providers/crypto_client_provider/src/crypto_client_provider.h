@@ -17,10 +17,14 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include <tink/hybrid/internal/hpke_context.h>
+#include <tink/util/secret_data.h>
 
+#include "core/common/lru_cache/src/sharded_lru_cache.h"
 #include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
 #include "core/interface/service_interface.h"
 #include "cpio/client_providers/interface/crypto_client_provider_interface.h"
 #include "google/protobuf/any.pb.h"
@@ -37,8 +41,9 @@ namespace google::scp::cpio::client_providers {
 class CryptoClientProvider : public CryptoClientProviderInterface {
  public:
   explicit CryptoClientProvider(
-      const std::shared_ptr<CryptoClientOptions>& options)
-      : options_(options) {}
+      const std::shared_ptr<CryptoClientOptions>& options,
+      const std::shared_ptr<core::AsyncExecutorInterface>& cpu_async_executor =
+          nullptr);
 
   core::ExecutionResult Init() noexcept override;
 
@@ -56,6 +61,12 @@ class CryptoClientProvider : public CryptoClientProviderInterface {
                          cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>&
           context) noexcept override;
 
+  core::ExecutionResult BatchHpkeDecrypt(
+      core::AsyncContext<
+          cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest,
+          cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse>&
+          context) noexcept override;
+
   core::ExecutionResult AeadEncrypt(
       core::AsyncContext<cmrt::sdk::crypto_service::v1::AeadEncryptRequest,
                          cmrt::sdk::crypto_service::v1::AeadEncryptResponse>&
@@ -67,8 +78,56 @@ class CryptoClientProvider : public CryptoClientProviderInterface {
           context) noexcept override;
 
  protected:
+  /// The HPKE private key parsed from a PrivateKey.
+  struct ParsedHpkePrivateKey {
+    /// The PrivateKey the key is parsed from, as base64.
+    std::string encoded_private_key;
+    ::crypto::tink::util::SecretData private_key;
+  };
+
+  /**
+   * @brief Gets the HPKE private key of the PrivateKey, from the cache if it
+   * is parsed already.
+   *
+   * @param private_key the PrivateKey of the request.
+   * @param context the context of the request, for logging.
+   */
+  template <typename Context>
+  core::ExecutionResultOr<std::shared_ptr<const ParsedHpkePrivateKey>>
+  GetHpkePrivateKey(
+      const cmrt::sdk::private_key_service::v1::PrivateKey& private_key,
+      Context& context) noexcept;
+
+  /**
+   * @brief Decrypts a ciphertext with the HPKE private key.
+   *
+   * @param private_key the HPKE private key.
+   * @param hpke_params the HPKE parameters.
+   * @param request the request, only its fields other than the private key and
+   * the encrypted data are used.
+   * @param ciphertext the ciphertext.
+   * @param response the response to set the payload and the secret of.
+   * @param context the context of the request, for logging.
+   */
+  template <typename Request, typename Context>
+  core::ExecutionResult HpkeOpen(
+      const ParsedHpkePrivateKey& private_key,
+      const ::crypto::tink::internal::HpkeParams& hpke_params,
+      const Request& request, const std::string& ciphertext,
+      cmrt::sdk::crypto_service::v1::HpkeDecryptResponse& response,
+      Context& context) noexcept;
+
   /// HpkeParams passed in from configuration which will override the default
   /// params.
   std::shared_ptr<CryptoClientOptions> options_;
+
+  /// Runs the chunks of the batch decryptions concurrently. Null runs them on
+  /// the calling thread.
+  std::shared_ptr<core::AsyncExecutorInterface> cpu_async_executor_;
+
+  /// The parsed HPKE private keys by key ID, null if disabled.
+  std::unique_ptr<
+      core::common::ShardedLruCache<std::string, ParsedHpkePrivateKey>>
+      hpke_private_key_cache_;
 };
 }  // namespace google::scp::cpio::client_providers
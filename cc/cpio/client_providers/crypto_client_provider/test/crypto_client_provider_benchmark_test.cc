@@ -0,0 +1,273 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives the decryptions of a CryptoClientProvider, with the payload sizes of
+// reports and above, and reports the bytes decrypted per second. The keys are
+// the ones of crypto_client_provider_test.
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "absl/strings/escaping.h"
+#include "core/async_executor/src/async_executor.h"
+#include "core/interface/async_context.h"
+#include "core/utils/src/base64.h"
+#include "cpio/client_providers/crypto_client_provider/src/crypto_client_provider.h"
+#include "proto/hpke.pb.h"
+#include "proto/tink.pb.h"
+#include "public/core/interface/execution_result.h"
+#include "public/cpio/interface/crypto_client/type_def.h"
+#include "public/cpio/proto/crypto_service/v1/crypto_service.pb.h"
+
+namespace google::scp::cpio::client_providers::test {
+
+using ::absl::Base64Escape;
+using ::absl::HexStringToBytes;
+using ::google::cmrt::sdk::crypto_service::v1::AeadDecryptRequest;
+using ::google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptRequest;
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest;
+using ::google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptRequest;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptRequest;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
+using ::google::crypto::tink::HpkePrivateKey;
+using ::google::crypto::tink::Keyset;
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::AsyncExecutor;
+using ::google::scp::core::AsyncExecutorInterface;
+using ::google::scp::core::utils::Base64Encode;
+
+static constexpr char kKeyId[] = "key_id";
+static constexpr char kSharedInfo[] = "shared_info";
+static constexpr char kSecret128[] = "000102030405060708090a0b0c0d0e0f";
+static constexpr char kPublicKeyForChacha20[] =
+    "4310ee97d88cc1f088a5576c77ab0cf5c3ac797f3d95139c6c84b5429c59662a";
+static constexpr char kDecryptedPrivateKeyForChacha20[] =
+    "8057991eef8f1f1af18f4a9491d16a1ce333f695d4db8e38da75975c4478e0fb";
+/// The capacity of the parsed private key cache, when it is enabled.
+static constexpr size_t kHpkePrivateKeyCacheCapacity = 16;
+static constexpr size_t kAsyncExecutorThreadCount = 8;
+static constexpr size_t kAsyncExecutorQueueCap = 100000;
+
+/**
+ * @brief Creates a client and the requests decrypting a payload it encrypted,
+ * shared by the threads of the benchmark.
+ *
+ * The benchmark arguments are the payload size and whether the parsed HPKE
+ * private keys are cached. Without the cache, every HPKE decryption decodes the
+ * private key and reconstructs its keyset.
+ */
+class CryptoClientProviderFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    payload_size_ = state.range(0);
+    cpu_async_executor_ = std::make_shared<AsyncExecutor>(
+        kAsyncExecutorThreadCount, kAsyncExecutorQueueCap);
+    cpu_async_executor_->Init();
+    cpu_async_executor_->Run();
+    auto options = std::make_shared<CryptoClientOptions>();
+    options->hpke_private_key_cache_capacity =
+        state.range(1) != 0 ? kHpkePrivateKeyCacheCapacity : 0;
+    client_ = std::make_unique<CryptoClientProvider>(options,
+                                                     cpu_async_executor_);
+    client_->Init();
+    client_->Run();
+
+    std::string payload(payload_size_, 'a');
+    hpke_decrypt_request_ = CreateHpkeDecryptRequest(HpkeEncrypt(payload));
+    aead_decrypt_request_ = std::make_shared<AeadDecryptRequest>();
+    aead_decrypt_request_->set_shared_info(kSharedInfo);
+    aead_decrypt_request_->set_secret(HexStringToBytes(kSecret128));
+    aead_decrypt_request_->mutable_encrypted_data()->set_ciphertext(
+        AeadEncrypt(payload));
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    client_->Stop();
+    cpu_async_executor_->Stop();
+    client_ = nullptr;
+    cpu_async_executor_ = nullptr;
+  }
+
+  std::string HpkeEncrypt(const std::string& payload) {
+    auto request = std::make_shared<HpkeEncryptRequest>();
+    request->mutable_public_key()->set_key_id(kKeyId);
+    request->mutable_public_key()->set_public_key(
+        Base64Escape(HexStringToBytes(kPublicKeyForChacha20)));
+    request->set_shared_info(kSharedInfo);
+    request->set_payload(payload);
+    std::string ciphertext;
+    AsyncContext<HpkeEncryptRequest, HpkeEncryptResponse> context(
+        std::move(request),
+        [&ciphertext](
+            AsyncContext<HpkeEncryptRequest, HpkeEncryptResponse>& context) {
+          if (context.result.Successful()) {
+            ciphertext = context.response->encrypted_data().ciphertext();
+          }
+        });
+    client_->HpkeEncrypt(context);
+    return ciphertext;
+  }
+
+  std::shared_ptr<HpkeDecryptRequest> CreateHpkeDecryptRequest(
+      const std::string& ciphertext) {
+    HpkePrivateKey hpke_private_key;
+    hpke_private_key.set_private_key(
+        HexStringToBytes(kDecryptedPrivateKeyForChacha20));
+    Keyset keyset;
+    keyset.set_primary_key_id(123);
+    keyset.add_key();
+    keyset.mutable_key(0)->set_key_id(456);
+    keyset.mutable_key(0)->mutable_key_data()->set_value(
+        hpke_private_key.SerializeAsString());
+    std::string encoded_private_key;
+    Base64Encode(keyset.SerializeAsString(), encoded_private_key);
+
+    auto request = std::make_shared<HpkeDecryptRequest>();
+    request->mutable_private_key()->set_key_id(kKeyId);
+    request->mutable_private_key()->set_private_key(encoded_private_key);
+    request->set_shared_info(kSharedInfo);
+    request->mutable_encrypted_data()->set_key_id(kKeyId);
+    request->mutable_encrypted_data()->set_ciphertext(ciphertext);
+    return request;
+  }
+
+  std::string AeadEncrypt(const std::string& payload) {
+    auto request = std::make_shared<AeadEncryptRequest>();
+    request->set_shared_info(kSharedInfo);
+    request->set_payload(payload);
+    request->set_secret(HexStringToBytes(kSecret128));
+    std::string ciphertext;
+    AsyncContext<AeadEncryptRequest, AeadEncryptResponse> context(
+        std::move(request),
+        [&ciphertext](
+            AsyncContext<AeadEncryptRequest, AeadEncryptResponse>& context) {
+          if (context.result.Successful()) {
+            ciphertext = context.response->encrypted_data().ciphertext();
+          }
+        });
+    client_->AeadEncrypt(context);
+    return ciphertext;
+  }
+
+  std::shared_ptr<AsyncExecutorInterface> cpu_async_executor_;
+  std::unique_ptr<CryptoClientProvider> client_;
+  size_t payload_size_ = 0;
+  std::shared_ptr<HpkeDecryptRequest> hpke_decrypt_request_;
+  std::shared_ptr<AeadDecryptRequest> aead_decrypt_request_;
+};
+
+BENCHMARK_DEFINE_F(CryptoClientProviderFixture, HpkeDecrypt)
+
+(benchmark::State& state) {
+  for (auto _ : state) {
+    AsyncContext<HpkeDecryptRequest, HpkeDecryptResponse> context(
+        hpke_decrypt_request_,
+        [](AsyncContext<HpkeDecryptRequest, HpkeDecryptResponse>&) {});
+    if (!client_->HpkeDecrypt(context).Successful()) {
+      state.SkipWithError("HpkeDecrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(context.response);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * payload_size_);
+}
+
+// The payload size and whether the private keys are cached.
+BENCHMARK_REGISTER_F(CryptoClientProviderFixture, HpkeDecrypt)
+    ->ArgsProduct({{64, 1 << 10, 16 << 10, 256 << 10}, {0, 1}})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_DEFINE_F(CryptoClientProviderFixture, BatchHpkeDecrypt)
+
+(benchmark::State& state) {
+  auto request = std::make_shared<BatchHpkeDecryptRequest>();
+  *request->mutable_private_key() = hpke_decrypt_request_->private_key();
+  request->set_shared_info(kSharedInfo);
+  for (int64_t i = 0; i < state.range(2); ++i) {
+    *request->add_encrypted_data() = hpke_decrypt_request_->encrypted_data();
+  }
+
+  for (auto _ : state) {
+    std::atomic<bool> finished(false);
+    AsyncContext<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse> context(
+        request,
+        [&finished](AsyncContext<BatchHpkeDecryptRequest,
+                                 BatchHpkeDecryptResponse>&) {
+          finished = true;
+        });
+    if (!client_->BatchHpkeDecrypt(context).Successful()) {
+      state.SkipWithError("BatchHpkeDecrypt failed");
+      break;
+    }
+    // The chunks of the batch are decrypted on the CPU async executor.
+    while (!finished) {
+      std::this_thread::yield();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(2));
+  state.SetBytesProcessed(state.iterations() * state.range(2) * payload_size_);
+}
+
+// The payload size, whether the private keys are cached and the ciphertexts
+// per batch.
+BENCHMARK_REGISTER_F(CryptoClientProviderFixture, BatchHpkeDecrypt)
+    ->ArgsProduct({{64, 1 << 10, 16 << 10}, {0, 1}, {1, 64, 1024}})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_DEFINE_F(CryptoClientProviderFixture, AeadDecrypt)
+
+(benchmark::State& state) {
+  for (auto _ : state) {
+    AsyncContext<AeadDecryptRequest, AeadDecryptResponse> context(
+        aead_decrypt_request_,
+        [](AsyncContext<AeadDecryptRequest, AeadDecryptResponse>&) {});
+    if (!client_->AeadDecrypt(context).Successful()) {
+      state.SkipWithError("AeadDecrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(context.response);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * payload_size_);
+}
+
+// The payload size. The AEAD primitive is always created from the secret of
+// the request, so there is nothing to cache.
+BENCHMARK_REGISTER_F(CryptoClientProviderFixture, AeadDecrypt)
+    ->ArgsProduct({{64, 1 << 10, 16 << 10, 256 << 10}, {0}})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace google::scp::cpio::client_providers::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
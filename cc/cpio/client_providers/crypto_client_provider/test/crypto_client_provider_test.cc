@@ -24,6 +24,7 @@
 #include <tink/util/secret_data.h>
 
 #include "absl/strings/escaping.h"
+#include "core/async_executor/mock/mock_async_executor.h"
 #include "core/interface/async_context.h"
 #include "core/test/scp_test_base.h"
 #include "core/test/utils/conditional_wait.h"
@@ -44,6 +45,8 @@ using google::cmrt::sdk::crypto_service::v1::AeadDecryptRequest;
 using google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::AeadEncryptRequest;
 using google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest;
+using google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::HpkeAead;
 using google::cmrt::sdk::crypto_service::v1::HpkeDecryptRequest;
 using google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
@@ -52,18 +55,23 @@ using google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
 using google::cmrt::sdk::crypto_service::v1::HpkeKdf;
 using google::cmrt::sdk::crypto_service::v1::HpkeKem;
 using google::cmrt::sdk::crypto_service::v1::HpkeParams;
+using google::cmrt::sdk::private_key_service::v1::PrivateKey;
 using google::crypto::tink::HpkePrivateKey;
 using google::crypto::tink::Keyset;
 using google::protobuf::Any;
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
 using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionStatus;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::errors::SC_CORE_UTILS_INVALID_BASE64_ENCODING_LENGTH;
 using google::scp::core::errors::
     SC_CRYPTO_CLIENT_PROVIDER_CANNOT_CREATE_KEYSET_HANDLE;
 using google::scp::core::errors::SC_CRYPTO_CLIENT_PROVIDER_CREATE_AEAD_FAILED;
+using google::scp::core::errors::
+    SC_CRYPTO_CLIENT_PROVIDER_SPLIT_CIPHERTEXT_FAILED;
 using google::scp::core::test::IsSuccessful;
 using google::scp::core::test::ResultIs;
 using google::scp::core::test::ScpTestBase;
@@ -206,6 +214,31 @@ class CryptoClientProviderTest : public ScpTestBase {
         });
   }
 
+  /// Encrypts the payload with the public key for Chacha20.
+  string HpkeEncryptPayload(const string& payload) {
+    auto request = make_shared<HpkeEncryptRequest>();
+    request->mutable_public_key()->set_key_id(kKeyId);
+    request->mutable_public_key()->set_public_key(
+        Base64Escape(HexStringToBytes(kPublicKeyForChacha20)));
+    request->set_shared_info(string(kSharedInfo));
+    request->set_payload(payload);
+    AsyncContext<HpkeEncryptRequest, HpkeEncryptResponse> context(
+        move(request),
+        [](AsyncContext<HpkeEncryptRequest, HpkeEncryptResponse>&) {});
+    EXPECT_SUCCESS(client_->HpkeEncrypt(context));
+    return context.response->encrypted_data().ciphertext();
+  }
+
+  /// The private key for Chacha20.
+  PrivateKey GetHpkePrivateKey() {
+    return CreateHpkeDecryptContext("" /*ciphertext*/,
+                                    false /*is_bidirectional*/, "" /*secret*/,
+                                    SuccessExecutionResult(),
+                                    "" /*exporter_context*/, HpkeParams(),
+                                    HpkeParams())
+        .request->private_key();
+  }
+
   AsyncContext<AeadEncryptRequest, AeadEncryptResponse>
   CreateAeadEncryptContext(string_view secret) {
     auto request = make_shared<AeadEncryptRequest>();
@@ -289,6 +322,92 @@ TEST_F(CryptoClientProviderTest, FailedToDecodePrivateKey) {
   EXPECT_SUCCESS(client_->HpkeEncrypt(encrypt_context));
 }
 
+TEST_F(CryptoClientProviderTest, HpkeDecryptWithPrivateKeyCache) {
+  auto options = make_shared<CryptoClientOptions>();
+  options->hpke_private_key_cache_capacity = 10;
+  client_ = make_unique<CryptoClientProvider>(options);
+
+  auto private_key = GetHpkePrivateKey();
+  for (int i = 0; i < 2; ++i) {
+    auto decrypt_context = CreateHpkeDecryptContext(
+        HpkeEncryptPayload(kPayload), false /*is_bidirectional*/,
+        "" /*secret*/, SuccessExecutionResult(), "" /*exporter_context*/,
+        HpkeParams(), HpkeParams());
+    *decrypt_context.request->mutable_private_key() = private_key;
+    EXPECT_SUCCESS(client_->HpkeDecrypt(decrypt_context));
+  }
+
+  // A different key with the same ID is not served from the cache.
+  auto failure = FailureExecutionResult(
+      SC_CRYPTO_CLIENT_PROVIDER_CANNOT_CREATE_KEYSET_HANDLE);
+  auto decrypt_context = CreateHpkeDecryptContext(
+      HpkeEncryptPayload(kPayload), false /*is_bidirectional*/, "" /*secret*/,
+      failure, "" /*exporter_context*/, HpkeParams(), HpkeParams());
+  EXPECT_THAT(client_->HpkeDecrypt(decrypt_context), ResultIs(failure));
+}
+
+TEST_F(CryptoClientProviderTest, BatchHpkeDecryptSuccess) {
+  auto cpu_async_executor = make_shared<MockAsyncExecutor>();
+  vector<AsyncOperation> scheduled_chunks;
+  cpu_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    scheduled_chunks.push_back(work);
+    return SuccessExecutionResult();
+  };
+  client_ = make_unique<CryptoClientProvider>(
+      make_shared<CryptoClientOptions>(), cpu_async_executor);
+
+  // More ciphertexts than in a chunk, one of them invalid.
+  constexpr int kCiphertextCount = 100;
+  auto request = make_shared<BatchHpkeDecryptRequest>();
+  *request->mutable_private_key() = GetHpkePrivateKey();
+  request->set_shared_info(string(kSharedInfo));
+  for (int i = 0; i < kCiphertextCount; ++i) {
+    request->add_encrypted_data()->set_ciphertext(
+        i == 1 ? "invalid" : HpkeEncryptPayload(kPayload + std::to_string(i)));
+  }
+  atomic<int> finish_count = 0;
+  AsyncContext<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse> context(
+      move(request),
+      [&](AsyncContext<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse>&
+              context) { finish_count++; });
+
+  EXPECT_SUCCESS(client_->BatchHpkeDecrypt(context));
+  ASSERT_EQ(scheduled_chunks.size(), 2);
+  EXPECT_EQ(finish_count.load(), 0);
+  for (auto& chunk : scheduled_chunks) {
+    chunk();
+  }
+
+  EXPECT_EQ(finish_count.load(), 1);
+  EXPECT_SUCCESS(context.result);
+  ASSERT_EQ(context.response->responses().size(), kCiphertextCount);
+  for (int i = 0; i < kCiphertextCount; ++i) {
+    const auto& response = context.response->responses(i);
+    if (i == 1) {
+      EXPECT_THAT(ExecutionResult(response.result()),
+                  ResultIs(FailureExecutionResult(
+                      SC_CRYPTO_CLIENT_PROVIDER_SPLIT_CIPHERTEXT_FAILED)));
+      continue;
+    }
+    EXPECT_SUCCESS(ExecutionResult(response.result()));
+    EXPECT_EQ(response.payload(), kPayload + std::to_string(i));
+  }
+}
+
+TEST_F(CryptoClientProviderTest, BatchHpkeDecryptFailsWithInvalidPrivateKey) {
+  auto request = make_shared<BatchHpkeDecryptRequest>();
+  request->mutable_private_key()->set_private_key("invalid");
+  request->add_encrypted_data()->set_ciphertext(HpkeEncryptPayload(kPayload));
+  AsyncContext<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse> context(
+      move(request),
+      [](AsyncContext<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse>&) {});
+
+  auto failure =
+      FailureExecutionResult(SC_CORE_UTILS_INVALID_BASE64_ENCODING_LENGTH);
+  EXPECT_THAT(client_->BatchHpkeDecrypt(context), ResultIs(failure));
+  EXPECT_THAT(context.result, ResultIs(failure));
+}
+
 TEST_F(CryptoClientProviderTest, AeadEncryptAndDecryptSuccessFor128Secret) {
   auto encrypt_context = CreateAeadEncryptContext(kSecret128);
   EXPECT_SUCCESS(client_->AeadEncrypt(encrypt_context));
@@ -34,6 +34,7 @@
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/http_client_interface.h"
 #include "cpio/common/src/aws/aws_utils.h"
+#include "cpio/client_providers/instance_client_provider/src/common/cached_instance_client_provider.h"
 #include "cpio/common/src/cpio_utils.h"
 #include "public/core/interface/execution_result.h"
 
@@ -544,7 +545,9 @@ InstanceClientProviderFactory::Create(
     const shared_ptr<HttpClientInterface>& http2_client,
     const shared_ptr<AsyncExecutorInterface>& cpu_async_executor,
     const shared_ptr<AsyncExecutorInterface>& io_async_executor) {
-  return make_shared<AwsInstanceClientProvider>(
-      auth_token_provider, http1_client, cpu_async_executor, io_async_executor);
+  return make_shared<CachedInstanceClientProvider>(
+      make_shared<AwsInstanceClientProvider>(auth_token_provider, http1_client,
+                                             cpu_async_executor,
+                                             io_async_executor));
 }
 }  // namespace google::scp::cpio::client_providers
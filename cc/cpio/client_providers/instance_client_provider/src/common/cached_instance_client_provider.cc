@@ -0,0 +1,259 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cached_instance_client_provider.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "core/common/time_provider/src/time_provider.h"
+
+using google::cmrt::sdk::instance_service::v1::
+    GetCurrentInstanceResourceNameRequest;
+using google::cmrt::sdk::instance_service::v1::
+    GetCurrentInstanceResourceNameResponse;
+using google::cmrt::sdk::instance_service::v1::
+    GetInstanceDetailsByResourceNameRequest;
+using google::cmrt::sdk::instance_service::v1::
+    GetInstanceDetailsByResourceNameResponse;
+using google::cmrt::sdk::instance_service::v1::GetTagsByResourceNameRequest;
+using google::cmrt::sdk::instance_service::v1::GetTagsByResourceNameResponse;
+using google::cmrt::sdk::instance_service::v1::InstanceDetails;
+using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FinishContext;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::common::TimeProvider;
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::nullopt;
+using std::optional;
+using std::string;
+using std::chrono::nanoseconds;
+
+namespace google::scp::cpio::client_providers {
+
+ExecutionResult CachedInstanceClientProvider::Init() noexcept {
+  return instance_client_provider_->Init();
+}
+
+ExecutionResult CachedInstanceClientProvider::Run() noexcept {
+  return instance_client_provider_->Run();
+}
+
+ExecutionResult CachedInstanceClientProvider::Stop() noexcept {
+  return instance_client_provider_->Stop();
+}
+
+optional<string>
+CachedInstanceClientProvider::GetCachedResourceName() noexcept {
+  lock_guard<mutex> lock(cache_mutex_);
+  return current_instance_resource_name_;
+}
+
+void CachedInstanceClientProvider::CacheResourceName(
+    const string& resource_name) noexcept {
+  lock_guard<mutex> lock(cache_mutex_);
+  current_instance_resource_name_ = resource_name;
+}
+
+optional<InstanceDetails>
+CachedInstanceClientProvider::GetCachedInstanceDetails(
+    const string& resource_name) noexcept {
+  lock_guard<mutex> lock(cache_mutex_);
+  auto it = instance_details_cache_.find(resource_name);
+  if (it == instance_details_cache_.end()) {
+    return nullopt;
+  }
+  if (TimeProvider::GetSteadyTimestampInNanoseconds() >=
+      it->second.expiration_time) {
+    instance_details_cache_.erase(it);
+    return nullopt;
+  }
+  return it->second.value;
+}
+
+void CachedInstanceClientProvider::CacheInstanceDetails(
+    const string& resource_name,
+    const InstanceDetails& instance_details) noexcept {
+  if (options_.instance_details_ttl <= nanoseconds::zero()) {
+    return;
+  }
+  lock_guard<mutex> lock(cache_mutex_);
+  instance_details_cache_[resource_name] = {
+      instance_details, TimeProvider::GetSteadyTimestampInNanoseconds() +
+                            options_.instance_details_ttl};
+}
+
+optional<GetTagsByResourceNameResponse>
+CachedInstanceClientProvider::GetCachedTags(
+    const string& resource_name) noexcept {
+  lock_guard<mutex> lock(cache_mutex_);
+  auto it = tags_cache_.find(resource_name);
+  if (it == tags_cache_.end()) {
+    return nullopt;
+  }
+  if (TimeProvider::GetSteadyTimestampInNanoseconds() >=
+      it->second.expiration_time) {
+    tags_cache_.erase(it);
+    return nullopt;
+  }
+  return it->second.value;
+}
+
+void CachedInstanceClientProvider::CacheTags(
+    const string& resource_name,
+    const GetTagsByResourceNameResponse& response) noexcept {
+  if (options_.tags_ttl <= nanoseconds::zero()) {
+    return;
+  }
+  lock_guard<mutex> lock(cache_mutex_);
+  tags_cache_[resource_name] = {
+      response,
+      TimeProvider::GetSteadyTimestampInNanoseconds() + options_.tags_ttl};
+}
+
+ExecutionResult CachedInstanceClientProvider::GetCurrentInstanceResourceName(
+    AsyncContext<GetCurrentInstanceResourceNameRequest,
+                 GetCurrentInstanceResourceNameResponse>& context) noexcept {
+  if (auto resource_name = GetCachedResourceName()) {
+    context.response = make_shared<GetCurrentInstanceResourceNameResponse>();
+    context.response->set_instance_resource_name(*resource_name);
+    FinishContext(SuccessExecutionResult(), context);
+    return SuccessExecutionResult();
+  }
+
+  auto provider_context = context;
+  provider_context.callback =
+      [this, context](AsyncContext<GetCurrentInstanceResourceNameRequest,
+                                   GetCurrentInstanceResourceNameResponse>&
+                          provider_context) mutable {
+        if (provider_context.result.Successful() &&
+            provider_context.response) {
+          CacheResourceName(
+              provider_context.response->instance_resource_name());
+        }
+        context.response = provider_context.response;
+        FinishContext(provider_context.result, context);
+      };
+  return instance_client_provider_->GetCurrentInstanceResourceName(
+      provider_context);
+}
+
+ExecutionResult
+CachedInstanceClientProvider::GetCurrentInstanceResourceNameSync(
+    string& resource_name) noexcept {
+  if (auto cached_resource_name = GetCachedResourceName()) {
+    resource_name = *cached_resource_name;
+    return SuccessExecutionResult();
+  }
+
+  auto execution_result =
+      instance_client_provider_->GetCurrentInstanceResourceNameSync(
+          resource_name);
+  if (execution_result.Successful()) {
+    CacheResourceName(resource_name);
+  }
+  return execution_result;
+}
+
+ExecutionResult CachedInstanceClientProvider::GetTagsByResourceName(
+    AsyncContext<GetTagsByResourceNameRequest, GetTagsByResourceNameResponse>&
+        context) noexcept {
+  // The cache is keyed on the request, so there is nothing to look up
+  // without one.
+  if (!context.request) {
+    return instance_client_provider_->GetTagsByResourceName(context);
+  }
+
+  const auto& resource_name = context.request->resource_name();
+  if (auto tags = GetCachedTags(resource_name)) {
+    context.response = make_shared<GetTagsByResourceNameResponse>(*tags);
+    FinishContext(SuccessExecutionResult(), context);
+    return SuccessExecutionResult();
+  }
+
+  auto provider_context = context;
+  provider_context.callback =
+      [this, context, resource_name](
+          AsyncContext<GetTagsByResourceNameRequest,
+                       GetTagsByResourceNameResponse>&
+              provider_context) mutable {
+        if (provider_context.result.Successful() &&
+            provider_context.response) {
+          CacheTags(resource_name, *provider_context.response);
+        }
+        context.response = provider_context.response;
+        FinishContext(provider_context.result, context);
+      };
+  return instance_client_provider_->GetTagsByResourceName(provider_context);
+}
+
+ExecutionResult CachedInstanceClientProvider::GetInstanceDetailsByResourceName(
+    AsyncContext<GetInstanceDetailsByResourceNameRequest,
+                 GetInstanceDetailsByResourceNameResponse>& context) noexcept {
+  if (!context.request) {
+    return instance_client_provider_->GetInstanceDetailsByResourceName(
+        context);
+  }
+
+  const auto& resource_name = context.request->instance_resource_name();
+  if (auto instance_details = GetCachedInstanceDetails(resource_name)) {
+    context.response = make_shared<GetInstanceDetailsByResourceNameResponse>();
+    *context.response->mutable_instance_details() = *instance_details;
+    FinishContext(SuccessExecutionResult(), context);
+    return SuccessExecutionResult();
+  }
+
+  auto provider_context = context;
+  provider_context.callback =
+      [this, context, resource_name](
+          AsyncContext<GetInstanceDetailsByResourceNameRequest,
+                       GetInstanceDetailsByResourceNameResponse>&
+              provider_context) mutable {
+        if (provider_context.result.Successful() &&
+            provider_context.response) {
+          CacheInstanceDetails(resource_name,
+                               provider_context.response->instance_details());
+        }
+        context.response = provider_context.response;
+        FinishContext(provider_context.result, context);
+      };
+  return instance_client_provider_->GetInstanceDetailsByResourceName(
+      provider_context);
+}
+
+ExecutionResult
+CachedInstanceClientProvider::GetInstanceDetailsByResourceNameSync(
+    const string& resource_name, InstanceDetails& instance_details) noexcept {
+  if (auto cached_instance_details = GetCachedInstanceDetails(resource_name)) {
+    instance_details = *cached_instance_details;
+    return SuccessExecutionResult();
+  }
+
+  auto execution_result =
+      instance_client_provider_->GetInstanceDetailsByResourceNameSync(
+          resource_name, instance_details);
+  if (execution_result.Successful()) {
+    CacheInstanceDetails(resource_name, instance_details);
+  }
+  return execution_result;
+}
+}  // namespace google::scp::cpio::client_providers
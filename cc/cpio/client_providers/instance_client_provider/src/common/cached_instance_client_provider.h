@@ -0,0 +1,154 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "cpio/client_providers/interface/instance_client_provider_interface.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::cpio::client_providers {
+
+/// Default TTL of the cached instance details. Instance id and networks never
+/// change for a running instance, only the labels can.
+static constexpr std::chrono::seconds kDefaultInstanceDetailsCacheTtl =
+    std::chrono::hours(1);
+/// Default TTL of the cached tags.
+static constexpr std::chrono::seconds kDefaultInstanceTagsCacheTtl =
+    std::chrono::minutes(5);
+
+/// Options of the CachedInstanceClientProvider. A zero TTL disables the
+/// cache for the corresponding call.
+struct InstanceClientProviderCacheOptions {
+  std::chrono::nanoseconds instance_details_ttl =
+      kDefaultInstanceDetailsCacheTtl;
+  std::chrono::nanoseconds tags_ttl = kDefaultInstanceTagsCacheTtl;
+};
+
+/*! @copydoc InstanceClientProviderInterface
+ *
+ * Wraps a cloud specific InstanceClientProvider and caches its successful
+ * responses so that repeated lookups do not go to the metadata server or the
+ * cloud instance APIs. The current instance resource name is immutable and is
+ * cached for the lifetime of the provider; instance details and tags are
+ * cached per resource name for their configured TTL. Failures are never
+ * cached.
+ */
+class CachedInstanceClientProvider : public InstanceClientProviderInterface {
+ public:
+  explicit CachedInstanceClientProvider(
+      const std::shared_ptr<InstanceClientProviderInterface>&
+          instance_client_provider,
+      const InstanceClientProviderCacheOptions& options =
+          InstanceClientProviderCacheOptions())
+      : instance_client_provider_(instance_client_provider),
+        options_(options) {}
+
+  core::ExecutionResult Init() noexcept override;
+
+  core::ExecutionResult Run() noexcept override;
+
+  core::ExecutionResult Stop() noexcept override;
+
+  core::ExecutionResult GetCurrentInstanceResourceName(
+      core::AsyncContext<cmrt::sdk::instance_service::v1::
+                             GetCurrentInstanceResourceNameRequest,
+                         cmrt::sdk::instance_service::v1::
+                             GetCurrentInstanceResourceNameResponse>&
+          context) noexcept override;
+
+  core::ExecutionResult GetCurrentInstanceResourceNameSync(
+      std::string& resource_name) noexcept override;
+
+  core::ExecutionResult GetTagsByResourceName(
+      core::AsyncContext<
+          cmrt::sdk::instance_service::v1::GetTagsByResourceNameRequest,
+          cmrt::sdk::instance_service::v1::GetTagsByResourceNameResponse>&
+          context) noexcept override;
+
+  core::ExecutionResult GetInstanceDetailsByResourceName(
+      core::AsyncContext<cmrt::sdk::instance_service::v1::
+                             GetInstanceDetailsByResourceNameRequest,
+                         cmrt::sdk::instance_service::v1::
+                             GetInstanceDetailsByResourceNameResponse>&
+          context) noexcept override;
+
+  core::ExecutionResult GetInstanceDetailsByResourceNameSync(
+      const std::string& resource_name,
+      cmrt::sdk::instance_service::v1::InstanceDetails&
+          instance_details) noexcept override;
+
+ private:
+  /// A cached value together with the steady clock time it expires at.
+  template <typename T>
+  struct CacheEntry {
+    T value;
+    std::chrono::nanoseconds expiration_time;
+  };
+
+  /// Returns the cached resource name of the current instance, if any.
+  std::optional<std::string> GetCachedResourceName() noexcept;
+
+  /// Caches the resource name of the current instance.
+  void CacheResourceName(const std::string& resource_name) noexcept;
+
+  /// Returns the cached details of the given instance, if not expired.
+  std::optional<cmrt::sdk::instance_service::v1::InstanceDetails>
+  GetCachedInstanceDetails(const std::string& resource_name) noexcept;
+
+  /// Caches the details of the given instance.
+  void CacheInstanceDetails(
+      const std::string& resource_name,
+      const cmrt::sdk::instance_service::v1::InstanceDetails&
+          instance_details) noexcept;
+
+  /// Returns the cached tags response of the given resource, if not expired.
+  std::optional<cmrt::sdk::instance_service::v1::GetTagsByResourceNameResponse>
+  GetCachedTags(const std::string& resource_name) noexcept;
+
+  /// Caches the tags response of the given resource.
+  void CacheTags(
+      const std::string& resource_name,
+      const cmrt::sdk::instance_service::v1::GetTagsByResourceNameResponse&
+          response) noexcept;
+
+  /// The wrapped cloud specific instance client provider.
+  std::shared_ptr<InstanceClientProviderInterface> instance_client_provider_;
+  /// The cache options.
+  const InstanceClientProviderCacheOptions options_;
+
+  /// Guards all the cached state below.
+  std::mutex cache_mutex_;
+  /// The resource name of the current instance, once resolved.
+  std::optional<std::string> current_instance_resource_name_;
+  /// Instance details keyed by instance resource name.
+  std::unordered_map<
+      std::string,
+      CacheEntry<cmrt::sdk::instance_service::v1::InstanceDetails>>
+      instance_details_cache_;
+  /// Tags responses keyed by resource name.
+  std::unordered_map<std::string,
+                     CacheEntry<cmrt::sdk::instance_service::v1::
+                                    GetTagsByResourceNameResponse>>
+      tags_cache_;
+};
+}  // namespace google::scp::cpio::client_providers
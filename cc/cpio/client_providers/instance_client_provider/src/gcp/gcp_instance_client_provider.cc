@@ -30,6 +30,7 @@
 #include "absl/strings/str_split.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_context.h"
+#include "cpio/client_providers/instance_client_provider/src/common/cached_instance_client_provider.h"
 #include "cpio/common/src/cpio_utils.h"
 
 #include "error_codes.h"
@@ -736,8 +737,9 @@ InstanceClientProviderFactory::Create(
     const shared_ptr<HttpClientInterface>& http2_client,
     const shared_ptr<AsyncExecutorInterface>& async_executor,
     const shared_ptr<AsyncExecutorInterface>& io_async_executor) {
-  return make_shared<GcpInstanceClientProvider>(auth_token_provider,
-                                                http1_client, http2_client);
+  return make_shared<CachedInstanceClientProvider>(
+      make_shared<GcpInstanceClientProvider>(auth_token_provider, http1_client,
+                                             http2_client));
 }
 
 }  // namespace google::scp::cpio::client_providers
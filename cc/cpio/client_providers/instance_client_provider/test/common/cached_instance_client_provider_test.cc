@@ -0,0 +1,256 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cpio/client_providers/instance_client_provider/src/common/cached_instance_client_provider.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "cpio/client_providers/instance_client_provider/mock/mock_instance_client_provider.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::cmrt::sdk::instance_service::v1::
+    GetCurrentInstanceResourceNameRequest;
+using google::cmrt::sdk::instance_service::v1::
+    GetCurrentInstanceResourceNameResponse;
+using google::cmrt::sdk::instance_service::v1::
+    GetInstanceDetailsByResourceNameRequest;
+using google::cmrt::sdk::instance_service::v1::
+    GetInstanceDetailsByResourceNameResponse;
+using google::cmrt::sdk::instance_service::v1::GetTagsByResourceNameRequest;
+using google::cmrt::sdk::instance_service::v1::GetTagsByResourceNameResponse;
+using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::test::IsSuccessful;
+using google::scp::core::test::ResultIs;
+using google::scp::cpio::client_providers::CachedInstanceClientProvider;
+using google::scp::cpio::client_providers::
+    InstanceClientProviderCacheOptions;
+using google::scp::cpio::client_providers::mock::MockInstanceClientProvider;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::chrono::milliseconds;
+using std::this_thread::sleep_for;
+using testing::_;
+using testing::Invoke;
+using testing::Pair;
+using testing::UnorderedElementsAre;
+
+namespace {
+constexpr char kResourceName[] =
+    "//compute.googleapis.com/projects/123456/zones/us-west1/instances/987";
+constexpr char kInstanceId[] = "987";
+}  // namespace
+
+namespace google::scp::cpio::client_providers::test {
+class CachedInstanceClientProviderTest : public testing::Test {
+ protected:
+  CachedInstanceClientProviderTest()
+      : mock_instance_client_provider_(
+            make_shared<MockInstanceClientProvider>()),
+        instance_client_provider_(make_shared<CachedInstanceClientProvider>(
+            mock_instance_client_provider_)) {}
+
+  void ExpectGetResourceName(int times) {
+    EXPECT_CALL(*mock_instance_client_provider_,
+                GetCurrentInstanceResourceName)
+        .Times(times)
+        .WillRepeatedly(Invoke(
+            [](AsyncContext<GetCurrentInstanceResourceNameRequest,
+                            GetCurrentInstanceResourceNameResponse>& context) {
+              context.response =
+                  make_shared<GetCurrentInstanceResourceNameResponse>();
+              context.response->set_instance_resource_name(kResourceName);
+              context.result = SuccessExecutionResult();
+              context.Finish();
+              return SuccessExecutionResult();
+            }));
+  }
+
+  void ExpectGetTags(int times, const string& tag_value) {
+    EXPECT_CALL(*mock_instance_client_provider_, GetTagsByResourceName)
+        .Times(times)
+        .WillRepeatedly(Invoke(
+            [tag_value](AsyncContext<GetTagsByResourceNameRequest,
+                                     GetTagsByResourceNameResponse>& context) {
+              context.response = make_shared<GetTagsByResourceNameResponse>();
+              (*context.response->mutable_tags())["tag"] = tag_value;
+              context.result = SuccessExecutionResult();
+              context.Finish();
+              return SuccessExecutionResult();
+            }));
+  }
+
+  ExecutionResult GetTags(string& tag_value) {
+    ExecutionResult callback_result = FailureExecutionResult(SC_UNKNOWN);
+    AsyncContext<GetTagsByResourceNameRequest, GetTagsByResourceNameResponse>
+        context(make_shared<GetTagsByResourceNameRequest>(),
+                [&](AsyncContext<GetTagsByResourceNameRequest,
+                                 GetTagsByResourceNameResponse>& context) {
+                  callback_result = context.result;
+                  if (context.result.Successful()) {
+                    tag_value = context.response->tags().at("tag");
+                  }
+                });
+    context.request->set_resource_name(kResourceName);
+    auto execution_result =
+        instance_client_provider_->GetTagsByResourceName(context);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    return callback_result;
+  }
+
+  shared_ptr<MockInstanceClientProvider> mock_instance_client_provider_;
+  shared_ptr<CachedInstanceClientProvider> instance_client_provider_;
+};
+
+TEST_F(CachedInstanceClientProviderTest,
+       CurrentInstanceResourceNameIsFetchedOnce) {
+  ExpectGetResourceName(1);
+
+  for (int i = 0; i < 3; i++) {
+    string resource_name;
+    AsyncContext<GetCurrentInstanceResourceNameRequest,
+                 GetCurrentInstanceResourceNameResponse>
+        context(make_shared<GetCurrentInstanceResourceNameRequest>(),
+                [&](AsyncContext<GetCurrentInstanceResourceNameRequest,
+                                 GetCurrentInstanceResourceNameResponse>&
+                        context) {
+                  EXPECT_SUCCESS(context.result);
+                  resource_name = context.response->instance_resource_name();
+                });
+    EXPECT_SUCCESS(
+        instance_client_provider_->GetCurrentInstanceResourceName(context));
+    EXPECT_EQ(resource_name, kResourceName);
+  }
+
+  string resource_name;
+  EXPECT_SUCCESS(
+      instance_client_provider_->GetCurrentInstanceResourceNameSync(
+          resource_name));
+  EXPECT_EQ(resource_name, kResourceName);
+}
+
+TEST_F(CachedInstanceClientProviderTest, FailuresAreNotCached) {
+  EXPECT_CALL(*mock_instance_client_provider_, GetCurrentInstanceResourceName)
+      .WillOnce(Invoke(
+          [](AsyncContext<GetCurrentInstanceResourceNameRequest,
+                          GetCurrentInstanceResourceNameResponse>& context) {
+            context.result = FailureExecutionResult(SC_UNKNOWN);
+            context.Finish();
+            return SuccessExecutionResult();
+          }))
+      .WillOnce(Invoke(
+          [](AsyncContext<GetCurrentInstanceResourceNameRequest,
+                          GetCurrentInstanceResourceNameResponse>& context) {
+            context.response =
+                make_shared<GetCurrentInstanceResourceNameResponse>();
+            context.response->set_instance_resource_name(kResourceName);
+            context.result = SuccessExecutionResult();
+            context.Finish();
+            return SuccessExecutionResult();
+          }));
+
+  for (auto expected_success : {false, true, true}) {
+    ExecutionResult callback_result;
+    AsyncContext<GetCurrentInstanceResourceNameRequest,
+                 GetCurrentInstanceResourceNameResponse>
+        context(make_shared<GetCurrentInstanceResourceNameRequest>(),
+                [&](AsyncContext<GetCurrentInstanceResourceNameRequest,
+                                 GetCurrentInstanceResourceNameResponse>&
+                        context) { callback_result = context.result; });
+    EXPECT_SUCCESS(
+        instance_client_provider_->GetCurrentInstanceResourceName(context));
+    EXPECT_EQ(callback_result.Successful(), expected_success);
+  }
+}
+
+TEST_F(CachedInstanceClientProviderTest, InstanceDetailsAreCachedPerResource) {
+  EXPECT_CALL(*mock_instance_client_provider_,
+              GetInstanceDetailsByResourceName)
+      .Times(2)
+      .WillRepeatedly(Invoke(
+          [](AsyncContext<GetInstanceDetailsByResourceNameRequest,
+                          GetInstanceDetailsByResourceNameResponse>& context) {
+            context.response =
+                make_shared<GetInstanceDetailsByResourceNameResponse>();
+            context.response->mutable_instance_details()->set_instance_id(
+                context.request->instance_resource_name());
+            context.result = SuccessExecutionResult();
+            context.Finish();
+            return SuccessExecutionResult();
+          }));
+
+  for (const auto* resource_name : {kInstanceId, "other", kInstanceId}) {
+    string instance_id;
+    AsyncContext<GetInstanceDetailsByResourceNameRequest,
+                 GetInstanceDetailsByResourceNameResponse>
+        context(make_shared<GetInstanceDetailsByResourceNameRequest>(),
+                [&](AsyncContext<GetInstanceDetailsByResourceNameRequest,
+                                 GetInstanceDetailsByResourceNameResponse>&
+                        context) {
+                  EXPECT_SUCCESS(context.result);
+                  instance_id = context.response->instance_details()
+                                    .instance_id();
+                });
+    context.request->set_instance_resource_name(resource_name);
+    EXPECT_SUCCESS(
+        instance_client_provider_->GetInstanceDetailsByResourceName(context));
+    EXPECT_EQ(instance_id, resource_name);
+  }
+}
+
+TEST_F(CachedInstanceClientProviderTest, TagsAreCachedUntilTtlExpires) {
+  InstanceClientProviderCacheOptions options;
+  options.tags_ttl = milliseconds(100);
+  instance_client_provider_ = make_shared<CachedInstanceClientProvider>(
+      mock_instance_client_provider_, options);
+
+  ExpectGetTags(1, "old");
+  string tag_value;
+  EXPECT_SUCCESS(GetTags(tag_value));
+  EXPECT_EQ(tag_value, "old");
+  EXPECT_SUCCESS(GetTags(tag_value));
+  EXPECT_EQ(tag_value, "old");
+  testing::Mock::VerifyAndClearExpectations(
+      mock_instance_client_provider_.get());
+
+  sleep_for(milliseconds(150));
+  ExpectGetTags(1, "new");
+  EXPECT_SUCCESS(GetTags(tag_value));
+  EXPECT_EQ(tag_value, "new");
+}
+
+TEST_F(CachedInstanceClientProviderTest, ZeroTtlDisablesTagsCache) {
+  InstanceClientProviderCacheOptions options;
+  options.tags_ttl = milliseconds(0);
+  instance_client_provider_ = make_shared<CachedInstanceClientProvider>(
+      mock_instance_client_provider_, options);
+
+  ExpectGetTags(2, "value");
+  string tag_value;
+  EXPECT_SUCCESS(GetTags(tag_value));
+  EXPECT_SUCCESS(GetTags(tag_value));
+  EXPECT_EQ(tag_value, "value");
+}
+}  // namespace google::scp::cpio::client_providers::test
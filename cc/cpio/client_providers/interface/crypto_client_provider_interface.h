@@ -52,6 +52,19 @@ class CryptoClientProviderInterface : public core::ServiceInterface {
                          cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>&
           context) noexcept = 0;
 
+  /**
+   * @brief Decrypts many payloads encrypted with the same private key using
+   * HPKE.
+   *
+   * @param context context of the operation.
+   * @return ExecutionResult result of the operation.
+   */
+  virtual core::ExecutionResult BatchHpkeDecrypt(
+      core::AsyncContext<
+          cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest,
+          cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse>&
+          context) noexcept = 0;
+
   /**
    * @brief Encrypts payload using AEAD.
    *
@@ -91,6 +91,31 @@ class JobClientProviderInterface : public core::ServiceInterface {
           cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutResponse>&
           update_job_visibility_timeout_context) noexcept = 0;
 
+  /**
+   * @brief Update status of many Jobs, reading and writing their items in
+   * batches. The outcome of every update is in its own response.
+   * @param batch_update_job_status_context context of the operation.
+   * @return ExecutionResult result of the operation.
+   */
+  virtual core::ExecutionResult BatchUpdateJobStatus(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse>&
+          batch_update_job_status_context) noexcept = 0;
+
+  /**
+   * @brief Update visibility timeout of many Jobs, in batches of the queue.
+   * The outcome of every update is in its own response.
+   * @param batch_update_job_visibility_timeout_context context of the
+   * operation.
+   * @return ExecutionResult result of the operation.
+   */
+  virtual core::ExecutionResult BatchUpdateJobVisibilityTimeout(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutResponse>&
+          batch_update_job_visibility_timeout_context) noexcept = 0;
+
   /**
    * @brief Deletes the orphaned job from the job queue.
    * @param delete_orphaned_job_context context of the operation.
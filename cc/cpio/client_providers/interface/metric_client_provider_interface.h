@@ -55,6 +55,20 @@ struct MetricBatchingOptions {
    */
   std::chrono::milliseconds batch_recording_time_duration =
       std::chrono::milliseconds(30000);
+  /**
+   * @brief Coalesces the metrics of the same series, i.e. of the same name and
+   * labels, within a batch before pushing them, when enable_batch_recording is
+   * true. On AWS the values are kept as statistic sets, on GCP counts are
+   * summed and other values keep the latest point.
+   */
+  bool enable_metric_aggregation = false;
+  /**
+   * @brief The max number of push calls to the cloud in flight at once. A push
+   * that would exceed it is not sent, and its metrics are dropped with a
+   * failure, so a slow cloud endpoint cannot pile up requests. 0 means no
+   * limit. Only used on GCP.
+   */
+  size_t max_in_flight_requests = 0;
 };
 
 class MetricClientProviderFactory {
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -86,6 +88,35 @@ class NoSQLDatabaseClientProviderInterface : public core::ServiceInterface {
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest,
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse>&
           upsert_database_item_context) noexcept = 0;
+
+  /**
+   * @brief Gets many database records in one round trip. The outcome of every
+   * lookup is in its own response.
+   *
+   * @param batch_get_database_items_context The context object for the
+   * database operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult BatchGetDatabaseItems(
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept = 0;
+
+  /**
+   * @brief Writes many database records in one round trip, each record as a
+   * whole. The outcome of every write is in its own response.
+   *
+   * @param batch_upsert_database_items_context The context object for the
+   * database operation.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult BatchUpsertDatabaseItems(
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>&
+          batch_upsert_database_items_context) noexcept = 0;
 };
 
 // Convenience wrapper around a <string, optional<string>> pair.
@@ -115,6 +146,26 @@ struct NoSQLDatabaseClientOptions {
   // Get* and Upsert*. Nullptr to not validate these fields.
   std::unique_ptr<std::unordered_map<std::string, PartitionAndSortKey>>
       table_name_to_keys;
+  // The session pool and channel settings of the Spanner connection for GCP.
+  // Zero keeps the default of the client library. Unused for AWS.
+  // The sessions created along with the connection, and kept in the pool.
+  size_t spanner_min_sessions = 0;
+  // The max number of sessions in use per gRPC channel.
+  size_t spanner_max_sessions_per_channel = 0;
+  // The number of gRPC channels the sessions are spread over.
+  size_t spanner_num_channels = 0;
+  // How often the idle sessions are refreshed.
+  std::chrono::seconds spanner_session_keep_alive_interval{0};
+  // How often the idle gRPC channels send keepalive pings.
+  std::chrono::milliseconds spanner_grpc_keep_alive_time{0};
+  // Whether Run() runs a query, so that the connection is ready before the
+  // first requests. Unused for AWS.
+  bool spanner_warm_up_enabled = false;
+  // The max number of rows whose value is cached after being upserted, so that
+  // the next upserts of these rows do not read them. Only valid if the
+  // provider is the only writer of the upserted rows. Zero, the default,
+  // disables the cache. Unused for AWS.
+  size_t spanner_upsert_cache_capacity = 0;
 };
 
 class NoSQLDatabaseClientProviderFactory {
@@ -43,6 +43,19 @@ class ParameterClientProviderInterface : public core::ServiceInterface {
           cmrt::sdk::parameter_service::v1::GetParameterRequest,
           cmrt::sdk::parameter_service::v1::GetParameterResponse>&
           context) noexcept = 0;
+
+  /**
+   * @brief Fetches the values of multiple parameters. Parameters which do not
+   * exist are omitted from the response rather than failing the whole call.
+   *
+   * @param context context of the operation.
+   * @return ExecutionResult result of the operation.
+   */
+  virtual core::ExecutionResult GetParameters(
+      core::AsyncContext<
+          cmrt::sdk::parameter_service::v1::GetParametersRequest,
+          cmrt::sdk::parameter_service::v1::GetParametersResponse>&
+          context) noexcept = 0;
 };
 
 class ParameterClientProviderFactory {
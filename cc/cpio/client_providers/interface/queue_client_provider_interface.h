@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -62,6 +64,19 @@ class QueueClientProviderInterface : public core::ServiceInterface {
           cmrt::sdk::queue_service::v1::UpdateMessageVisibilityTimeoutRequest,
           cmrt::sdk::queue_service::v1::UpdateMessageVisibilityTimeoutResponse>&
           update_message_visibility_timeout_context) noexcept = 0;
+  /**
+   * @brief Update visibility timeout of many messages from the queue, with as
+   * few calls to the queue as it allows. Every message gets its own result.
+   * @param batch_update_message_visibility_timeout_context context of the
+   * operation.
+   * @return ExecutionResult result of the operation.
+   */
+  virtual core::ExecutionResult BatchUpdateMessageVisibilityTimeout(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutRequest,
+                         cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutResponse>&
+          batch_update_message_visibility_timeout_context) noexcept = 0;
   /**
    * @brief Delete a message from the queue.
    * @param delete_message_context context of the operation.
@@ -85,6 +100,25 @@ struct QueueClientOptions {
    *
    */
   std::string queue_name;
+
+  /**
+   * @brief The number of messages to prefetch and buffer locally for
+   * GetTopMessage. 0 disables the prefetching.
+   */
+  size_t prefetch_count = 0;
+
+  /**
+   * @brief How long, in seconds, the buffered messages are leased for. Their
+   * leases are extended while they are buffered.
+   */
+  int32_t prefetched_message_visibility_timeout_seconds = 60;
+
+  /**
+   * @brief The maximum number of DeleteMessage calls to the queue in flight.
+   * Beyond it, the deletions are queued and sent in batches. 0 disables the
+   * batching.
+   */
+  size_t max_delete_message_batches_in_flight = 0;
 };
 
 class QueueClientProviderFactory {
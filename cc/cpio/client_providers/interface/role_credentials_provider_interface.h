@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -43,6 +44,10 @@ struct GetRoleCredentialsResponse {
   std::shared_ptr<std::string> access_key_id;
   std::shared_ptr<std::string> access_key_secret;
   std::shared_ptr<std::string> security_token;
+
+  // Time duration in seconds of which the credentials are valid. Zero if
+  // unknown, in which case the credentials are not cached.
+  std::chrono::seconds credentials_lifetime_in_seconds{0};
 };
 
 /// Provides cloud role credentials functionality.
@@ -76,6 +76,20 @@ class MockJobClientProvider : public JobClientProviderInterface {
           cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutResponse>&)),
       (noexcept, override));
 
+  MOCK_METHOD(core::ExecutionResult, BatchUpdateJobStatus,
+              ((core::AsyncContext<
+                  cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest,
+                  cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse>&)),
+              (noexcept, override));
+
+  MOCK_METHOD(
+      core::ExecutionResult, BatchUpdateJobVisibilityTimeout,
+      ((core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutRequest,
+          cmrt::sdk::job_service::v1::
+              BatchUpdateJobVisibilityTimeoutResponse>&)),
+      (noexcept, override));
+
   MOCK_METHOD(
       core::ExecutionResult, DeleteOrphanedJobMessage,
       ((core::AsyncContext<
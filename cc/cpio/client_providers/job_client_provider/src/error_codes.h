@@ -69,6 +69,11 @@ DEFINE_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_DUPLICATE_JOB_ENTRY_CREATION,
                   "Job client failed to create job due to job is already "
                   "created in database with another server job id",
                   HttpStatusCode::BAD_REQUEST)
+DEFINE_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_INVALID_BATCH, SC_JOB_CLIENT_PROVIDER,
+                  0x000C,
+                  "Job client failed to update jobs due to too many or "
+                  "repeated jobs in the batch",
+                  HttpStatusCode::BAD_REQUEST)
 MAP_TO_PUBLIC_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_JOB_CLIENT_OPTIONS_REQUIRED,
                          SC_CPIO_INTERNAL_ERROR)
 MAP_TO_PUBLIC_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_SERIALIZATION_FAILED,
@@ -91,4 +96,6 @@ MAP_TO_PUBLIC_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_JOB_ENTRY_CREATION_FAILED,
                          SC_CPIO_INTERNAL_ERROR)
 MAP_TO_PUBLIC_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_DUPLICATE_JOB_ENTRY_CREATION,
                          SC_CPIO_INVALID_REQUEST)
+MAP_TO_PUBLIC_ERROR_CODE(SC_JOB_CLIENT_PROVIDER_INVALID_BATCH,
+                         SC_CPIO_INVALID_REQUEST)
 }  // namespace google::scp::core::errors
@@ -16,8 +16,16 @@
 
 #include "job_client_provider.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_context.h"
@@ -30,6 +38,12 @@
 #include "error_codes.h"
 #include "job_client_utils.h"
 
+using google::cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest;
+using google::cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse;
+using google::cmrt::sdk::job_service::v1::
+    BatchUpdateJobVisibilityTimeoutRequest;
+using google::cmrt::sdk::job_service::v1::
+    BatchUpdateJobVisibilityTimeoutResponse;
 using google::cmrt::sdk::job_service::v1::DeleteOrphanedJobMessageRequest;
 using google::cmrt::sdk::job_service::v1::DeleteOrphanedJobMessageResponse;
 using google::cmrt::sdk::job_service::v1::GetJobByIdRequest;
@@ -46,17 +60,30 @@ using google::cmrt::sdk::job_service::v1::UpdateJobStatusRequest;
 using google::cmrt::sdk::job_service::v1::UpdateJobStatusResponse;
 using google::cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutRequest;
 using google::cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsResponse;
 using google::cmrt::sdk::nosql_database_service::v1::GetDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::GetDatabaseItemResponse;
 using google::cmrt::sdk::nosql_database_service::v1::ItemAttribute;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutRequest;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutResponse;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageRequest;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageRequest;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageResponse;
 using google::cmrt::sdk::queue_service::v1::GetTopMessageRequest;
 using google::cmrt::sdk::queue_service::v1::GetTopMessageResponse;
+using google::cmrt::sdk::queue_service::v1::QueueMessage;
 using google::cmrt::sdk::queue_service::v1::
     UpdateMessageVisibilityTimeoutRequest;
 using google::cmrt::sdk::queue_service::v1::
@@ -65,6 +92,7 @@ using google::protobuf::Duration;
 using google::protobuf::util::TimeUtil;
 using google::scp::core::AsyncContext;
 using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
@@ -72,6 +100,7 @@ using google::scp::core::common::ToString;
 using google::scp::core::common::Uuid;
 using google::scp::core::errors::
     SC_JOB_CLIENT_PROVIDER_DUPLICATE_JOB_ENTRY_CREATION;
+using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_BATCH;
 using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_DURATION;
 using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_JOB_ITEM;
 using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_JOB_STATUS;
@@ -84,11 +113,17 @@ using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_UPDATION_CONFLICT;
 using google::scp::core::errors::
     SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_CHECKED_FAILED;
 using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND;
+using google::scp::cpio::client_providers::JobClientUtils;
 using std::bind;
 using std::make_shared;
 using std::move;
+using std::nullopt;
+using std::optional;
 using std::shared_ptr;
 using std::string;
+using std::vector;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
 using std::placeholders::_1;
 
 namespace {
@@ -96,9 +131,73 @@ constexpr char kJobClientProvider[] = "JobClientProvider";
 constexpr char kProcessingStartedTimeColumnName[] = "ProcessingStartedTime";
 constexpr int kDefaultRetryCount = 0;
 constexpr int kMaximumVisibilityTimeoutInSeconds = 600;
+// The maximum number of job items read in a batch.
+constexpr size_t kMaxPrefetchedJobsPerBatch = 100;
+// The maximum number of job items written in a batch.
+constexpr size_t kMaxJobsPerBatchUpdate = 25;
 const google::protobuf::Timestamp kDefaultTimestampValue =
     TimeUtil::SecondsToTimestamp(0);
 
+ExecutionResult ValidateUpdateJobStatusRequest(
+    const UpdateJobStatusRequest& request) noexcept {
+  if (request.job_id().empty()) {
+    return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_MISSING_JOB_ID);
+  }
+  if (request.receipt_info().empty() &&
+      (request.job_status() == JobStatus::JOB_STATUS_SUCCESS ||
+       request.job_status() == JobStatus::JOB_STATUS_FAILURE)) {
+    return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_INVALID_RECEIPT_INFO);
+  }
+  return SuccessExecutionResult();
+}
+
+// Gets the retry count of the job once updated to the job status of the
+// request, as long as the update is valid for the job.
+ExecutionResultOr<int> GetRetryCountForUpdateJobStatus(
+    const UpdateJobStatusRequest& request, const Job& job) noexcept {
+  if (job.updated_time() > request.most_recent_updated_time()) {
+    return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_UPDATION_CONFLICT);
+  }
+  RETURN_IF_FAILURE(JobClientUtils::ValidateJobStatus(job.job_status(),
+                                                     request.job_status()));
+  switch (request.job_status()) {
+    // TODO: Add new failure status for retry mechanism.
+    case JobStatus::JOB_STATUS_PROCESSING:
+      return job.retry_count() + 1;
+    case JobStatus::JOB_STATUS_FAILURE:
+    case JobStatus::JOB_STATUS_SUCCESS:
+      return job.retry_count();
+    default:
+      return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_INVALID_JOB_STATUS);
+  }
+}
+
+// Same as above, for the job item read for the job status update.
+ExecutionResultOr<int> GetRetryCountForUpdateJobStatus(
+    const UpdateJobStatusRequest& request,
+    const GetDatabaseItemResponse& get_database_item_response) noexcept {
+  RETURN_IF_FAILURE(ExecutionResult(get_database_item_response.result()));
+  ASSIGN_OR_RETURN(auto job, JobClientUtils::ConvertDatabaseItemToJob(
+                                 get_database_item_response.item()));
+  return GetRetryCountForUpdateJobStatus(request, job);
+}
+
+ExecutionResult ValidateUpdateJobVisibilityTimeoutRequest(
+    const UpdateJobVisibilityTimeoutRequest& request) noexcept {
+  if (request.job_id().empty()) {
+    return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_MISSING_JOB_ID);
+  }
+  const auto& duration = request.duration_to_update();
+  if (duration.seconds() < 0 ||
+      duration.seconds() > kMaximumVisibilityTimeoutInSeconds) {
+    return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_INVALID_DURATION);
+  }
+  if (request.receipt_info().empty()) {
+    return FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_INVALID_RECEIPT_INFO);
+  }
+  return SuccessExecutionResult();
+}
+
 }  // namespace
 
 namespace google::scp::cpio::client_providers {
@@ -122,6 +221,10 @@ ExecutionResult JobClientProvider::Run() noexcept {
 }
 
 ExecutionResult JobClientProvider::Stop() noexcept {
+  // The messages of the buffered jobs become visible again once their lease
+  // expires.
+  std::lock_guard lock(prefetch_mutex_);
+  prefetched_jobs_.clear();
   return SuccessExecutionResult();
 }
 
@@ -241,8 +344,16 @@ void JobClientProvider::OnUpsertNewJobItemCallback(
 ExecutionResult JobClientProvider::GetNextJob(
     AsyncContext<GetNextJobRequest, GetNextJobResponse>&
         get_next_job_context) noexcept {
+  if (job_client_options_->get_next_job_prefetch_count > 0) {
+    GetNextPrefetchedJob(get_next_job_context);
+    return SuccessExecutionResult();
+  }
+
+  auto get_top_message_request = make_shared<GetTopMessageRequest>();
+  get_top_message_request->set_wait_time_seconds(
+      job_client_options_->get_next_job_wait_time_seconds);
   AsyncContext<GetTopMessageRequest, GetTopMessageResponse>
-      get_top_message_context(move(make_shared<GetTopMessageRequest>()),
+      get_top_message_context(move(get_top_message_request),
                               bind(&JobClientProvider::OnGetTopMessageCallback,
                                    this, get_next_job_context, _1),
                               get_next_job_context);
@@ -250,6 +361,261 @@ ExecutionResult JobClientProvider::GetNextJob(
   return queue_client_provider_->GetTopMessage(get_top_message_context);
 }
 
+void JobClientProvider::GetNextPrefetchedJob(
+    AsyncContext<GetNextJobRequest, GetNextJobResponse>&
+        get_next_job_context) noexcept {
+  optional<PrefetchedJob> prefetched_job;
+  bool is_prefetch_needed = false;
+  {
+    std::lock_guard lock(prefetch_mutex_);
+    prefetched_job = PopPrefetchedJob();
+    if (!prefetched_job.has_value()) {
+      waiting_get_next_job_contexts_.push_back(get_next_job_context);
+    }
+    // The buffer is refilled once half of it is handed out.
+    is_prefetch_needed =
+        !is_prefetch_in_flight_ &&
+        (!prefetched_job.has_value() ||
+         prefetched_jobs_.size() <=
+             job_client_options_->get_next_job_prefetch_count / 2);
+    is_prefetch_in_flight_ |= is_prefetch_needed;
+  }
+
+  if (prefetched_job.has_value()) {
+    FinishWithPrefetchedJob(get_next_job_context, move(*prefetched_job));
+  }
+  if (is_prefetch_needed) {
+    PrefetchJobs();
+  }
+}
+
+void JobClientProvider::PrefetchJobs() noexcept {
+  auto get_top_message_request = make_shared<GetTopMessageRequest>();
+  get_top_message_request->set_max_number_of_messages(
+      std::min(job_client_options_->get_next_job_prefetch_count,
+               kMaxPrefetchedJobsPerBatch));
+  get_top_message_request->set_wait_time_seconds(
+      job_client_options_->get_next_job_wait_time_seconds);
+  AsyncContext<GetTopMessageRequest, GetTopMessageResponse>
+      get_top_message_context(
+          move(get_top_message_request),
+          bind(&JobClientProvider::OnPrefetchTopMessagesCallback, this, _1));
+  // The callback handles the failures.
+  queue_client_provider_->GetTopMessage(get_top_message_context);
+}
+
+void JobClientProvider::OnPrefetchTopMessagesCallback(
+    AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+        get_top_message_context) noexcept {
+  if (!get_top_message_context.result.Successful()) {
+    SCP_ERROR_CONTEXT(
+        kJobClientProvider, get_top_message_context,
+        get_top_message_context.result,
+        "Failed to prefetch jobs due to get job messages from queue failed.");
+    FinishPrefetch(get_top_message_context.result, {});
+    return;
+  }
+
+  const auto& response = *get_top_message_context.response;
+  auto messages = make_shared<vector<QueueMessage>>(
+      response.messages().begin(), response.messages().end());
+  if (messages->empty() && !response.message_id().empty()) {
+    auto& message = messages->emplace_back();
+    message.set_message_id(response.message_id());
+    message.set_message_body(response.message_body());
+    message.set_receipt_info(response.receipt_info());
+  }
+  if (messages->empty()) {
+    FinishPrefetch(SuccessExecutionResult(), {});
+    return;
+  }
+
+  // The messages are leased for as long as their jobs may be buffered.
+  const int32_t visibility_timeout_seconds =
+      job_client_options_->prefetched_job_visibility_timeout_seconds;
+  auto lease_expiration_time =
+      steady_clock::now() + seconds(visibility_timeout_seconds);
+  auto batch_get_database_items_request =
+      make_shared<BatchGetDatabaseItemsRequest>();
+  for (const auto& message : *messages) {
+    auto update_request = make_shared<UpdateMessageVisibilityTimeoutRequest>();
+    update_request->set_receipt_info(message.receipt_info());
+    update_request->mutable_message_visibility_timeout()->set_seconds(
+        visibility_timeout_seconds);
+    AsyncContext<UpdateMessageVisibilityTimeoutRequest,
+                 UpdateMessageVisibilityTimeoutResponse>
+        update_message_visibility_timeout_context(
+            move(update_request),
+            [](AsyncContext<UpdateMessageVisibilityTimeoutRequest,
+                            UpdateMessageVisibilityTimeoutResponse>& context) {
+              if (!context.result.Successful()) {
+                SCP_ERROR_CONTEXT(kJobClientProvider, context, context.result,
+                                  "Failed to lease a prefetched job message.");
+              }
+            },
+            get_top_message_context);
+    queue_client_provider_->UpdateMessageVisibilityTimeout(
+        update_message_visibility_timeout_context);
+
+    // The server job ids are checked once the items are read, as batch reads
+    // do not support required attributes.
+    *batch_get_database_items_request->add_requests() =
+        move(*JobClientUtils::CreateGetJobByJobIdRequest(
+            job_table_name_, message.message_body()));
+  }
+
+  AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+      batch_get_database_items_context(
+          move(batch_get_database_items_request),
+          bind(&JobClientProvider::OnPrefetchJobItemsCallback, this, messages,
+               lease_expiration_time, _1),
+          get_top_message_context);
+  nosql_database_client_provider_->BatchGetDatabaseItems(
+      batch_get_database_items_context);
+}
+
+void JobClientProvider::OnPrefetchJobItemsCallback(
+    shared_ptr<vector<QueueMessage>> messages,
+    steady_clock::time_point lease_expiration_time,
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  if (!batch_get_database_items_context.result.Successful()) {
+    SCP_ERROR_CONTEXT(kJobClientProvider, batch_get_database_items_context,
+                      batch_get_database_items_context.result,
+                      "Failed to prefetch jobs due to get jobs from NoSQL "
+                      "database failed.");
+    FinishPrefetch(batch_get_database_items_context.result, {});
+    return;
+  }
+
+  const auto& responses =
+      batch_get_database_items_context.response->responses();
+  vector<PrefetchedJob> prefetched_jobs;
+  prefetched_jobs.reserve(messages->size());
+  for (size_t i = 0; i < messages->size(); ++i) {
+    const auto& message = (*messages)[i];
+    auto& prefetched_job = prefetched_jobs.emplace_back();
+    prefetched_job.receipt_info = message.receipt_info();
+    prefetched_job.lease_expiration_time = lease_expiration_time;
+    prefetched_job.result =
+        i < static_cast<size_t>(responses.size())
+            ? ExecutionResult(responses[i].result())
+            : FailureExecutionResult(
+                  SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
+    if (prefetched_job.result.Successful()) {
+      auto job_or =
+          JobClientUtils::ConvertDatabaseItemToJob(responses[i].item());
+      if (!job_or.Successful()) {
+        prefetched_job.result = job_or.result();
+      } else if (job_or->server_job_id() != message.message_id()) {
+        prefetched_job.result = FailureExecutionResult(
+            SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
+      } else {
+        prefetched_job.job = move(*job_or);
+      }
+    }
+    if (!prefetched_job.result.Successful()) {
+      SCP_ERROR_CONTEXT(kJobClientProvider, batch_get_database_items_context,
+                        prefetched_job.result,
+                        "Failed to prefetch job. Job id: %s, server job id: %s",
+                        message.message_body().c_str(),
+                        message.message_id().c_str());
+    }
+  }
+  FinishPrefetch(SuccessExecutionResult(), move(prefetched_jobs));
+}
+
+void JobClientProvider::FinishPrefetch(
+    const ExecutionResult& result,
+    vector<PrefetchedJob> prefetched_jobs) noexcept {
+  vector<std::pair<AsyncContext<GetNextJobRequest, GetNextJobResponse>,
+                   PrefetchedJob>>
+      handed_out_jobs;
+  vector<AsyncContext<GetNextJobRequest, GetNextJobResponse>>
+      unserved_contexts;
+  bool is_prefetch_needed = false;
+  {
+    std::lock_guard lock(prefetch_mutex_);
+    is_prefetch_in_flight_ = false;
+    const bool has_prefetched_jobs = !prefetched_jobs.empty();
+    for (auto& prefetched_job : prefetched_jobs) {
+      prefetched_jobs_.push_back(move(prefetched_job));
+    }
+
+    size_t served_count = 0;
+    while (served_count < waiting_get_next_job_contexts_.size()) {
+      auto prefetched_job = PopPrefetchedJob();
+      if (!prefetched_job.has_value()) {
+        break;
+      }
+      handed_out_jobs.emplace_back(
+          move(waiting_get_next_job_contexts_[served_count++]),
+          move(*prefetched_job));
+    }
+    waiting_get_next_job_contexts_.erase(
+        waiting_get_next_job_contexts_.begin(),
+        waiting_get_next_job_contexts_.begin() + served_count);
+
+    // The queue may have more jobs for the contexts still waiting if this
+    // prefetch got some.
+    if (!waiting_get_next_job_contexts_.empty()) {
+      if (result.Successful() && has_prefetched_jobs) {
+        is_prefetch_needed = true;
+        is_prefetch_in_flight_ = true;
+      } else {
+        unserved_contexts = move(waiting_get_next_job_contexts_);
+        waiting_get_next_job_contexts_.clear();
+      }
+    }
+  }
+
+  for (auto& [get_next_job_context, prefetched_job] : handed_out_jobs) {
+    FinishWithPrefetchedJob(get_next_job_context, move(prefetched_job));
+  }
+  for (auto& get_next_job_context : unserved_contexts) {
+    if (result.Successful()) {
+      get_next_job_context.response = make_shared<GetNextJobResponse>();
+    }
+    get_next_job_context.result = result;
+    get_next_job_context.Finish();
+  }
+  if (is_prefetch_needed) {
+    PrefetchJobs();
+  }
+}
+
+optional<JobClientProvider::PrefetchedJob>
+JobClientProvider::PopPrefetchedJob() noexcept {
+  const auto min_remaining_lease =
+      seconds(job_client_options_->prefetched_job_visibility_timeout_seconds) /
+      2;
+  const auto now = steady_clock::now();
+  while (!prefetched_jobs_.empty()) {
+    auto prefetched_job = move(prefetched_jobs_.front());
+    prefetched_jobs_.pop_front();
+    if (prefetched_job.lease_expiration_time - now >= min_remaining_lease) {
+      return prefetched_job;
+    }
+  }
+  return nullopt;
+}
+
+void JobClientProvider::FinishWithPrefetchedJob(
+    AsyncContext<GetNextJobRequest, GetNextJobResponse>& get_next_job_context,
+    PrefetchedJob prefetched_job) noexcept {
+  if (!prefetched_job.result.Successful()) {
+    get_next_job_context.result = prefetched_job.result;
+    get_next_job_context.Finish();
+    return;
+  }
+  get_next_job_context.response = make_shared<GetNextJobResponse>();
+  *get_next_job_context.response->mutable_job() = move(prefetched_job.job);
+  get_next_job_context.response->set_receipt_info(
+      move(prefetched_job.receipt_info));
+  get_next_job_context.result = SuccessExecutionResult();
+  get_next_job_context.Finish();
+}
+
 void JobClientProvider::OnGetTopMessageCallback(
     AsyncContext<GetNextJobRequest, GetNextJobResponse>& get_next_job_context,
     AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
@@ -649,60 +1015,21 @@ void JobClientProvider::OnGetJobItemForUpdateJobStatusCallback(
     return;
   }
 
-  if (job_or->updated_time() >
-      update_job_status_context.request->most_recent_updated_time()) {
-    auto execution_result =
-        FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_UPDATION_CONFLICT);
-    SCP_ERROR_CONTEXT(
-        kJobClientProvider, update_job_status_context, execution_result,
-        "Failed to update job status due to job is already updated "
-        "by another request. Job id: %s",
-        job_id.c_str());
-    update_job_status_context.result = execution_result;
-    update_job_status_context.Finish();
-    return;
-  }
-
-  const JobStatus& current_job_status = job_or->job_status();
-  const JobStatus& job_status_in_request =
-      update_job_status_context.request->job_status();
-  auto execution_result = JobClientUtils::ValidateJobStatus(
-      current_job_status, job_status_in_request);
-  if (!execution_result.Successful()) {
+  auto retry_count_or = GetRetryCountForUpdateJobStatus(
+      *update_job_status_context.request, *job_or);
+  if (!retry_count_or.Successful()) {
     SCP_ERROR_CONTEXT(
-        kJobClientProvider, update_job_status_context, execution_result,
-        "Failed to update status due to invalid job status. Job id: "
-        "%s, Current Job status: %s, Job status in request: %s",
-        job_id.c_str(), current_job_status, job_status_in_request);
-    update_job_status_context.result = execution_result;
+        kJobClientProvider, update_job_status_context, retry_count_or.result(),
+        "Failed to update status due to invalid job status update. Job id: "
+        "%s, Current Job status: %d, Job status in request: %d",
+        job_id.c_str(), job_or->job_status(),
+        update_job_status_context.request->job_status());
+    update_job_status_context.result = retry_count_or.result();
     update_job_status_context.Finish();
     return;
   }
 
-  int retry_count = job_or->retry_count();
-  switch (job_status_in_request) {
-    // TODO: Add new failure status for retry mechanism.
-    case JobStatus::JOB_STATUS_PROCESSING:
-      retry_count++;
-    case JobStatus::JOB_STATUS_FAILURE:
-    case JobStatus::JOB_STATUS_SUCCESS: {
-      UpsertUpdatedJobStatusJobItem(update_job_status_context, retry_count);
-      return;
-    }
-    case JobStatus::JOB_STATUS_UNKNOWN:
-    case JobStatus::JOB_STATUS_CREATED:
-    default: {
-      auto execution_result =
-          FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_INVALID_JOB_STATUS);
-      SCP_ERROR_CONTEXT(
-          kJobClientProvider, update_job_status_context, execution_result,
-          "Failed to update status due to invalid job status in the "
-          "request. Job id: %s, Job status: %s",
-          job_id.c_str(), job_status_in_request);
-      update_job_status_context.result = execution_result;
-      update_job_status_context.Finish();
-    }
-  }
+  UpsertUpdatedJobStatusJobItem(update_job_status_context, *retry_count_or);
 }
 
 void JobClientProvider::UpsertUpdatedJobStatusJobItem(
@@ -945,6 +1272,348 @@ void JobClientProvider::OnUpdateMessageVisibilityTimeoutCallback(
   update_job_visibility_timeout_context.Finish();
 }
 
+ExecutionResult JobClientProvider::BatchUpdateJobStatus(
+    AsyncContext<BatchUpdateJobStatusRequest, BatchUpdateJobStatusResponse>&
+        batch_update_job_status_context) noexcept {
+  const auto& requests = batch_update_job_status_context.request->requests();
+  // The items are written in one batch upsert, which takes every item once.
+  bool has_repeated_job = false;
+  std::set<string> job_ids;
+  for (const auto& request : requests) {
+    if (!request.job_id().empty() && !job_ids.insert(request.job_id()).second) {
+      has_repeated_job = true;
+    }
+  }
+  if (requests.size() > kMaxJobsPerBatchUpdate || has_repeated_job) {
+    auto execution_result =
+        FailureExecutionResult(SC_JOB_CLIENT_PROVIDER_INVALID_BATCH);
+    SCP_ERROR_CONTEXT(kJobClientProvider, batch_update_job_status_context,
+                      execution_result,
+                      "Failed to batch update job status due to too many or "
+                      "repeated jobs in the request. Job count: %d",
+                      requests.size());
+    batch_update_job_status_context.result = execution_result;
+    batch_update_job_status_context.Finish();
+    return execution_result;
+  }
+
+  batch_update_job_status_context.response =
+      make_shared<BatchUpdateJobStatusResponse>();
+  auto request_indices = make_shared<vector<size_t>>();
+  auto batch_get_database_items_request =
+      make_shared<BatchGetDatabaseItemsRequest>();
+  for (size_t i = 0; i < static_cast<size_t>(requests.size()); ++i) {
+    auto* response = batch_update_job_status_context.response->add_responses();
+    auto execution_result = ValidateUpdateJobStatusRequest(requests[i]);
+    *response->mutable_result() = execution_result.ToProto();
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(kJobClientProvider, batch_update_job_status_context,
+                        execution_result,
+                        "Failed to batch update status due to invalid request. "
+                        "Job id: %s",
+                        requests[i].job_id().c_str());
+      continue;
+    }
+    request_indices->push_back(i);
+    *batch_get_database_items_request->add_requests() =
+        move(*JobClientUtils::CreateGetJobByJobIdRequest(
+            job_table_name_, requests[i].job_id()));
+  }
+  if (request_indices->empty()) {
+    batch_update_job_status_context.result = SuccessExecutionResult();
+    batch_update_job_status_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+      batch_get_database_items_context(
+          move(batch_get_database_items_request),
+          bind(&JobClientProvider::OnGetJobItemsForBatchUpdateJobStatusCallback,
+               this, batch_update_job_status_context, request_indices, _1),
+          batch_update_job_status_context);
+  return nosql_database_client_provider_->BatchGetDatabaseItems(
+      batch_get_database_items_context);
+}
+
+void JobClientProvider::OnGetJobItemsForBatchUpdateJobStatusCallback(
+    AsyncContext<BatchUpdateJobStatusRequest, BatchUpdateJobStatusResponse>&
+        batch_update_job_status_context,
+    shared_ptr<vector<size_t>> request_indices,
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  if (!batch_get_database_items_context.result.Successful()) {
+    auto execution_result = batch_get_database_items_context.result;
+    SCP_ERROR_CONTEXT(kJobClientProvider, batch_update_job_status_context,
+                      execution_result,
+                      "Failed to batch update job status due to get jobs from "
+                      "NoSQL database failed.");
+    batch_update_job_status_context.result = execution_result;
+    batch_update_job_status_context.Finish();
+    return;
+  }
+
+  const auto& requests = batch_update_job_status_context.request->requests();
+  auto& responses =
+      *batch_update_job_status_context.response->mutable_responses();
+  const auto& item_responses =
+      batch_get_database_items_context.response->responses();
+  const auto update_time = TimeUtil::GetCurrentTime();
+  auto upserted_request_indices = make_shared<vector<size_t>>();
+  auto batch_upsert_database_items_request =
+      make_shared<BatchUpsertDatabaseItemsRequest>();
+  for (size_t i = 0; i < request_indices->size(); ++i) {
+    const auto request_index = (*request_indices)[i];
+    const auto& request = requests[request_index];
+    auto retry_count_or =
+        i < static_cast<size_t>(item_responses.size())
+            ? GetRetryCountForUpdateJobStatus(request, item_responses[i])
+            : ExecutionResultOr<int>(FailureExecutionResult(
+                  SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND));
+    if (!retry_count_or.Successful()) {
+      SCP_ERROR_CONTEXT(kJobClientProvider, batch_update_job_status_context,
+                        retry_count_or.result(),
+                        "Failed to batch update status of job. Job id: %s, Job "
+                        "status in request: %d",
+                        request.job_id().c_str(), request.job_status());
+      *responses[request_index].mutable_result() =
+          retry_count_or.result().ToProto();
+      continue;
+    }
+
+    const int retry_count = *retry_count_or;
+    Job job_for_update;
+    job_for_update.set_job_id(request.job_id());
+    *job_for_update.mutable_updated_time() = update_time;
+    job_for_update.set_job_status(request.job_status());
+    if (request.job_status() == JobStatus::JOB_STATUS_PROCESSING) {
+      *job_for_update.mutable_processing_started_time() = update_time;
+    }
+    job_for_update.set_retry_count(retry_count);
+    // The batch upsert writes the items as a whole.
+    *batch_upsert_database_items_request->add_requests() =
+        move(*JobClientUtils::CreateUpsertJobItemRequest(
+            job_table_name_, item_responses[i].item(), job_for_update));
+
+    auto& response = responses[request_index];
+    response.set_job_status(request.job_status());
+    *response.mutable_updated_time() = update_time;
+    response.set_retry_count(retry_count);
+    upserted_request_indices->push_back(request_index);
+  }
+  if (upserted_request_indices->empty()) {
+    batch_update_job_status_context.result = SuccessExecutionResult();
+    batch_update_job_status_context.Finish();
+    return;
+  }
+
+  AsyncContext<BatchUpsertDatabaseItemsRequest,
+               BatchUpsertDatabaseItemsResponse>
+      batch_upsert_database_items_context(
+          move(batch_upsert_database_items_request),
+          bind(
+              &JobClientProvider::OnBatchUpsertUpdatedJobStatusJobItemsCallback,
+              this, batch_update_job_status_context, upserted_request_indices,
+              _1),
+          batch_update_job_status_context);
+  // The callback handles the failures.
+  nosql_database_client_provider_->BatchUpsertDatabaseItems(
+      batch_upsert_database_items_context);
+}
+
+void JobClientProvider::OnBatchUpsertUpdatedJobStatusJobItemsCallback(
+    AsyncContext<BatchUpdateJobStatusRequest, BatchUpdateJobStatusResponse>&
+        batch_update_job_status_context,
+    shared_ptr<vector<size_t>> request_indices,
+    AsyncContext<BatchUpsertDatabaseItemsRequest,
+                 BatchUpsertDatabaseItemsResponse>&
+        batch_upsert_database_items_context) noexcept {
+  const auto& requests = batch_update_job_status_context.request->requests();
+  auto& responses =
+      *batch_update_job_status_context.response->mutable_responses();
+  vector<size_t> finished_request_indices;
+  for (size_t i = 0; i < request_indices->size(); ++i) {
+    const auto request_index = (*request_indices)[i];
+    ExecutionResult execution_result =
+        batch_upsert_database_items_context.result;
+    if (execution_result.Successful()) {
+      const auto& upsert_responses =
+          batch_upsert_database_items_context.response->responses();
+      execution_result = i < static_cast<size_t>(upsert_responses.size())
+                             ? ExecutionResult(upsert_responses[i].result())
+                             : FailureExecutionResult(
+                                   SC_JOB_CLIENT_PROVIDER_INVALID_JOB_ITEM);
+    }
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(kJobClientProvider, batch_update_job_status_context,
+                        execution_result,
+                        "Failed to batch update job status due to upsert "
+                        "updated job to NoSQL database failed. Job id: %s",
+                        requests[request_index].job_id().c_str());
+      responses[request_index].Clear();
+      *responses[request_index].mutable_result() = execution_result.ToProto();
+      continue;
+    }
+    const auto job_status = requests[request_index].job_status();
+    if (job_status == JobStatus::JOB_STATUS_SUCCESS ||
+        job_status == JobStatus::JOB_STATUS_FAILURE) {
+      finished_request_indices.push_back(request_index);
+    }
+  }
+  if (finished_request_indices.empty()) {
+    batch_update_job_status_context.result = SuccessExecutionResult();
+    batch_update_job_status_context.Finish();
+    return;
+  }
+
+  // The messages are deleted one by one, the queue client groups the deletions
+  // in flight together if it batches them.
+  auto pending_delete_count =
+      make_shared<std::atomic<size_t>>(finished_request_indices.size());
+  for (auto request_index : finished_request_indices) {
+    auto delete_message_request = make_shared<DeleteMessageRequest>();
+    delete_message_request->set_receipt_info(
+        requests[request_index].receipt_info());
+    AsyncContext<DeleteMessageRequest, DeleteMessageResponse>
+        delete_message_context(
+            move(delete_message_request),
+            bind(&JobClientProvider::
+                     OnDeleteJobMessageForBatchUpdatingJobStatusCallback,
+                 this, batch_update_job_status_context, request_index,
+                 pending_delete_count, _1),
+            batch_update_job_status_context);
+    // The callback handles the failures.
+    queue_client_provider_->DeleteMessage(delete_message_context);
+  }
+}
+
+void JobClientProvider::OnDeleteJobMessageForBatchUpdatingJobStatusCallback(
+    AsyncContext<BatchUpdateJobStatusRequest, BatchUpdateJobStatusResponse>&
+        batch_update_job_status_context,
+    size_t request_index, shared_ptr<std::atomic<size_t>> pending_delete_count,
+    AsyncContext<DeleteMessageRequest, DeleteMessageResponse>&
+        delete_message_context) noexcept {
+  if (!delete_message_context.result.Successful()) {
+    auto execution_result = delete_message_context.result;
+    SCP_ERROR_CONTEXT(
+        kJobClientProvider, batch_update_job_status_context, execution_result,
+        "Failed to batch update job status due to job message deletion "
+        "failed. Job id: %s",
+        batch_update_job_status_context.request->requests(request_index)
+            .job_id()
+            .c_str());
+    auto* response =
+        batch_update_job_status_context.response->mutable_responses(
+            request_index);
+    response->Clear();
+    *response->mutable_result() = execution_result.ToProto();
+  }
+  if (pending_delete_count->fetch_sub(1) == 1) {
+    batch_update_job_status_context.result = SuccessExecutionResult();
+    batch_update_job_status_context.Finish();
+  }
+}
+
+ExecutionResult JobClientProvider::BatchUpdateJobVisibilityTimeout(
+    AsyncContext<BatchUpdateJobVisibilityTimeoutRequest,
+                 BatchUpdateJobVisibilityTimeoutResponse>&
+        batch_update_job_visibility_timeout_context) noexcept {
+  const auto& requests =
+      batch_update_job_visibility_timeout_context.request->requests();
+  batch_update_job_visibility_timeout_context.response =
+      make_shared<BatchUpdateJobVisibilityTimeoutResponse>();
+  auto request_indices = make_shared<vector<size_t>>();
+  auto batch_update_message_visibility_timeout_request =
+      make_shared<BatchUpdateMessageVisibilityTimeoutRequest>();
+  for (size_t i = 0; i < static_cast<size_t>(requests.size()); ++i) {
+    auto* response =
+        batch_update_job_visibility_timeout_context.response->add_responses();
+    auto execution_result =
+        ValidateUpdateJobVisibilityTimeoutRequest(requests[i]);
+    *response->mutable_result() = execution_result.ToProto();
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(
+          kJobClientProvider, batch_update_job_visibility_timeout_context,
+          execution_result,
+          "Failed to batch update visibility timeout due to invalid request. "
+          "Job id: %s",
+          requests[i].job_id().c_str());
+      continue;
+    }
+    request_indices->push_back(i);
+    auto* update_request =
+        batch_update_message_visibility_timeout_request->add_requests();
+    *update_request->mutable_message_visibility_timeout() =
+        requests[i].duration_to_update();
+    update_request->set_receipt_info(requests[i].receipt_info());
+  }
+  if (request_indices->empty()) {
+    batch_update_job_visibility_timeout_context.result =
+        SuccessExecutionResult();
+    batch_update_job_visibility_timeout_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+               BatchUpdateMessageVisibilityTimeoutResponse>
+      batch_update_message_visibility_timeout_context(
+          move(batch_update_message_visibility_timeout_request),
+          bind(
+              &JobClientProvider::OnBatchUpdateMessageVisibilityTimeoutCallback,
+              this, batch_update_job_visibility_timeout_context,
+              request_indices, _1),
+          batch_update_job_visibility_timeout_context);
+  return queue_client_provider_->BatchUpdateMessageVisibilityTimeout(
+      batch_update_message_visibility_timeout_context);
+}
+
+void JobClientProvider::OnBatchUpdateMessageVisibilityTimeoutCallback(
+    AsyncContext<BatchUpdateJobVisibilityTimeoutRequest,
+                 BatchUpdateJobVisibilityTimeoutResponse>&
+        batch_update_job_visibility_timeout_context,
+    shared_ptr<vector<size_t>> request_indices,
+    AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+                 BatchUpdateMessageVisibilityTimeoutResponse>&
+        batch_update_message_visibility_timeout_context) noexcept {
+  if (!batch_update_message_visibility_timeout_context.result.Successful()) {
+    auto execution_result =
+        batch_update_message_visibility_timeout_context.result;
+    SCP_ERROR_CONTEXT(
+        kJobClientProvider, batch_update_job_visibility_timeout_context,
+        execution_result,
+        "Failed to batch update job visibility timeout due to update job "
+        "message visibility timeout failed.");
+    batch_update_job_visibility_timeout_context.result = execution_result;
+    batch_update_job_visibility_timeout_context.Finish();
+    return;
+  }
+
+  const auto& requests =
+      batch_update_job_visibility_timeout_context.request->requests();
+  const auto& message_responses =
+      batch_update_message_visibility_timeout_context.response->responses();
+  auto& responses = *batch_update_job_visibility_timeout_context.response
+                         ->mutable_responses();
+  for (size_t i = 0; i < request_indices->size(); ++i) {
+    const auto request_index = (*request_indices)[i];
+    ExecutionResult execution_result =
+        i < static_cast<size_t>(message_responses.size())
+            ? ExecutionResult(message_responses[i].result())
+            : FailureExecutionResult(
+                  SC_JOB_CLIENT_PROVIDER_INVALID_RECEIPT_INFO);
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(
+          kJobClientProvider, batch_update_job_visibility_timeout_context,
+          execution_result,
+          "Failed to batch update job visibility timeout due to update job "
+          "message visibility timeout failed. Job id: %s",
+          requests[request_index].job_id().c_str());
+    }
+    *responses[request_index].mutable_result() = execution_result.ToProto();
+  }
+  batch_update_job_visibility_timeout_context.result = SuccessExecutionResult();
+  batch_update_job_visibility_timeout_context.Finish();
+}
+
 ExecutionResult JobClientProvider::DeleteOrphanedJobMessage(
     AsyncContext<DeleteOrphanedJobMessageRequest,
                  DeleteOrphanedJobMessageResponse>&
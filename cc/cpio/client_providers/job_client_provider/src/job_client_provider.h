@@ -16,9 +16,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "core/interface/async_context.h"
 #include "cpio/client_providers/interface/job_client_provider_interface.h"
@@ -84,6 +90,18 @@ class JobClientProvider : public JobClientProviderInterface {
           cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutResponse>&
           update_job_visibility_timeout_context) noexcept override;
 
+  core::ExecutionResult BatchUpdateJobStatus(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse>&
+          batch_update_job_status_context) noexcept override;
+
+  core::ExecutionResult BatchUpdateJobVisibilityTimeout(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutResponse>&
+          batch_update_job_visibility_timeout_context) noexcept override;
+
   core::ExecutionResult DeleteOrphanedJobMessage(
       core::AsyncContext<
           cmrt::sdk::job_service::v1::DeleteOrphanedJobMessageRequest,
@@ -157,6 +175,91 @@ class JobClientProvider : public JobClientProviderInterface {
           cmrt::sdk::nosql_database_service::v1::GetDatabaseItemResponse>&
           get_database_item_context) noexcept;
 
+  /// A prefetched job, waiting in the buffer to be handed out.
+  struct PrefetchedJob {
+    /// The failure to hand out instead of the job, if the job item could not
+    /// be read.
+    core::ExecutionResult result;
+    cmrt::sdk::job_service::v1::Job job;
+    std::string receipt_info;
+    /// When the lease of the job message expires.
+    std::chrono::steady_clock::time_point lease_expiration_time;
+  };
+
+  /**
+   * @brief Hands out a prefetched job, or waits for the next prefetch.
+   *
+   * @param get_next_job_context the get next job context.
+   */
+  void GetNextPrefetchedJob(
+      core::AsyncContext<cmrt::sdk::job_service::v1::GetNextJobRequest,
+                         cmrt::sdk::job_service::v1::GetNextJobResponse>&
+          get_next_job_context) noexcept;
+
+  /// Prefetches the next jobs into the buffer. Must hold prefetch_mutex_ and
+  /// is_prefetch_in_flight_ must be false.
+  void PrefetchJobs() noexcept;
+
+  /**
+   * @brief Is called when the job messages to prefetch are returned from the
+   * queue. Leases the messages and reads their job items in a batch.
+   *
+   * @param get_top_message_context the get top message context.
+   */
+  void OnPrefetchTopMessagesCallback(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::GetTopMessageRequest,
+                         cmrt::sdk::queue_service::v1::GetTopMessageResponse>&
+          get_top_message_context) noexcept;
+
+  /**
+   * @brief Is called when the job items of the prefetched messages are
+   * returned from the database.
+   *
+   * @param messages the prefetched job messages.
+   * @param lease_expiration_time when the lease of the messages expires.
+   * @param batch_get_database_items_context the batch get database items
+   * context.
+   */
+  void OnPrefetchJobItemsCallback(
+      std::shared_ptr<std::vector<cmrt::sdk::queue_service::v1::QueueMessage>>
+          messages,
+      std::chrono::steady_clock::time_point lease_expiration_time,
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::
+              BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept;
+
+  /**
+   * @brief Ends the prefetch in flight, and hands out the buffered jobs to the
+   * waiting contexts.
+   *
+   * @param result the result of the prefetch.
+   * @param prefetched_jobs the prefetched jobs to buffer.
+   */
+  void FinishPrefetch(const core::ExecutionResult& result,
+                      std::vector<PrefetchedJob> prefetched_jobs) noexcept;
+
+  /**
+   * @brief Pops the next prefetched job whose lease is not about to expire.
+   * Must hold prefetch_mutex_.
+   *
+   * @return the job, or nullopt if there is none.
+   */
+  std::optional<PrefetchedJob> PopPrefetchedJob() noexcept;
+
+  /**
+   * @brief Finishes the get next job context with the prefetched job.
+   *
+   * @param get_next_job_context the get next job context.
+   * @param prefetched_job the prefetched job.
+   */
+  static void FinishWithPrefetchedJob(
+      core::AsyncContext<cmrt::sdk::job_service::v1::GetNextJobRequest,
+                         cmrt::sdk::job_service::v1::GetNextJobResponse>&
+          get_next_job_context,
+      PrefetchedJob prefetched_job) noexcept;
+
   /**
    * @brief Is called when the object is returned from the get job item with job
    * id from database callback.
@@ -312,6 +415,97 @@ class JobClientProvider : public JobClientProviderInterface {
           cmrt::sdk::queue_service::v1::UpdateMessageVisibilityTimeoutResponse>&
           update_message_visibility_timeout_context) noexcept;
 
+  /**
+   * @brief Is called when the job items of a batch job status update are
+   * returned from the database. Checks every update against its job item and
+   * writes the updated items in a batch.
+   *
+   * @param batch_update_job_status_context the batch update job status
+   * context.
+   * @param request_indices the indices of the read job items in the requests.
+   * @param batch_get_database_items_context the batch get database items
+   * context.
+   */
+  void OnGetJobItemsForBatchUpdateJobStatusCallback(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse>&
+          batch_update_job_status_context,
+      std::shared_ptr<std::vector<size_t>> request_indices,
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::
+              BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept;
+
+  /**
+   * @brief Is called when the updated job items of a batch job status update
+   * are written to the database. Deletes the messages of the finished jobs.
+   *
+   * @param batch_update_job_status_context the batch update job status
+   * context.
+   * @param request_indices the indices of the written job items in the
+   * requests.
+   * @param batch_upsert_database_items_context the batch upsert database items
+   * context.
+   */
+  void OnBatchUpsertUpdatedJobStatusJobItemsCallback(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse>&
+          batch_update_job_status_context,
+      std::shared_ptr<std::vector<size_t>> request_indices,
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>&
+          batch_upsert_database_items_context) noexcept;
+
+  /**
+   * @brief Is called when the object is returned from the delete message
+   * callback of a job finished by a batch job status update.
+   *
+   * @param batch_update_job_status_context the batch update job status
+   * context.
+   * @param request_index the index of the job in the requests.
+   * @param pending_delete_count the number of deletions of the batch not
+   * returned yet. The batch is finished by the last one.
+   * @param delete_message_context the delete message context.
+   */
+  void OnDeleteJobMessageForBatchUpdatingJobStatusCallback(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse>&
+          batch_update_job_status_context,
+      size_t request_index,
+      std::shared_ptr<std::atomic<size_t>> pending_delete_count,
+      core::AsyncContext<cmrt::sdk::queue_service::v1::DeleteMessageRequest,
+                         cmrt::sdk::queue_service::v1::DeleteMessageResponse>&
+          delete_message_context) noexcept;
+
+  /**
+   * @brief Is called when the object is returned from the batch update message
+   * visibility timeout callback.
+   *
+   * @param batch_update_job_visibility_timeout_context the batch update job
+   * visibility timeout context.
+   * @param request_indices the indices of the updated messages in the
+   * requests.
+   * @param batch_update_message_visibility_timeout_context the batch update
+   * message visibility timeout context.
+   */
+  void OnBatchUpdateMessageVisibilityTimeoutCallback(
+      core::AsyncContext<
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutRequest,
+          cmrt::sdk::job_service::v1::BatchUpdateJobVisibilityTimeoutResponse>&
+          batch_update_job_visibility_timeout_context,
+      std::shared_ptr<std::vector<size_t>> request_indices,
+      core::AsyncContext<cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutRequest,
+                         cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutResponse>&
+          batch_update_message_visibility_timeout_context) noexcept;
+
   /**
    * @brief Is called when the object is returned from the get job item for
    * deleting orphaned job from database callback.
@@ -379,6 +573,17 @@ class JobClientProvider : public JobClientProviderInterface {
   /// The NoSQL database client provider.
   std::shared_ptr<NoSQLDatabaseClientProviderInterface>
       nosql_database_client_provider_;
+
+  /// Guards the prefetched jobs and the contexts waiting for them.
+  std::mutex prefetch_mutex_;
+  /// The prefetched jobs, in the order of their messages.
+  std::deque<PrefetchedJob> prefetched_jobs_;
+  /// The contexts waiting for the prefetch in flight.
+  std::vector<
+      core::AsyncContext<cmrt::sdk::job_service::v1::GetNextJobRequest,
+                         cmrt::sdk::job_service::v1::GetNextJobResponse>>
+      waiting_get_next_job_contexts_;
+  bool is_prefetch_in_flight_ = false;
 };
 
 }  // namespace google::scp::cpio::client_providers
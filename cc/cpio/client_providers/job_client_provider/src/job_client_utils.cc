@@ -264,6 +264,23 @@ shared_ptr<UpsertDatabaseItemRequest> JobClientUtils::CreateUpsertJobRequest(
   return request;
 }
 
+shared_ptr<UpsertDatabaseItemRequest>
+JobClientUtils::CreateUpsertJobItemRequest(const string& job_table_name,
+                                           const Item& item,
+                                           const Job& job) noexcept {
+  auto request = CreateUpsertJobRequest(job_table_name, job);
+  set<string> updated_attribute_names;
+  for (const auto& attribute : request->new_attributes()) {
+    updated_attribute_names.insert(attribute.name());
+  }
+  for (const auto& attribute : item.attributes()) {
+    if (updated_attribute_names.count(attribute.name()) == 0) {
+      *request->add_new_attributes() = attribute;
+    }
+  }
+  return request;
+}
+
 shared_ptr<GetDatabaseItemRequest> JobClientUtils::CreateGetNextJobRequest(
     const string& job_table_name, const string& job_id,
     const string& server_job_id) noexcept {
@@ -151,6 +151,26 @@ class JobClientUtils {
                          const google::cmrt::sdk::job_service::v1::Job& job,
                          const std::string& job_body_as_string = "") noexcept;
 
+  /**
+   * @brief Create an UpsertDatabaseItemRequest for job update that writes the
+   * job item as a whole, as the batch upserts do. The attributes set by
+   * CreateUpsertJobRequest for the job replace the ones of the item, the other
+   * attributes of the item are kept.
+   *
+   * @param job_table_name The name of the table to upsert.
+   * @param item The job item read from the database.
+   * @param job Job with the fields to update.
+   * @return
+   * google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest
+   * The request for updated job upsertion.
+   */
+  static std::shared_ptr<
+      google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest>
+  CreateUpsertJobItemRequest(
+      const std::string& job_table_name,
+      const google::cmrt::sdk::nosql_database_service::v1::Item& item,
+      const google::cmrt::sdk::job_service::v1::Job& job) noexcept;
+
   /**
    * @brief Create an GetDatabaseItemRequest for get next job from database.
    *
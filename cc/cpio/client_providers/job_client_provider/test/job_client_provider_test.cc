@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "cc/cpio/client_providers/job_client_provider/src/error_codes.h"
 #include "cc/cpio/client_providers/job_client_provider/src/job_client_utils.h"
@@ -33,6 +34,12 @@
 #include "public/core/test/interface/execution_result_matchers.h"
 #include "public/cpio/proto/job_service/v1/job_service.pb.h"
 
+using google::cmrt::sdk::job_service::v1::BatchUpdateJobStatusRequest;
+using google::cmrt::sdk::job_service::v1::BatchUpdateJobStatusResponse;
+using google::cmrt::sdk::job_service::v1::
+    BatchUpdateJobVisibilityTimeoutRequest;
+using google::cmrt::sdk::job_service::v1::
+    BatchUpdateJobVisibilityTimeoutResponse;
 using google::cmrt::sdk::job_service::v1::DeleteOrphanedJobMessageRequest;
 using google::cmrt::sdk::job_service::v1::DeleteOrphanedJobMessageResponse;
 using google::cmrt::sdk::job_service::v1::GetJobByIdRequest;
@@ -49,9 +56,15 @@ using google::cmrt::sdk::job_service::v1::UpdateJobStatusRequest;
 using google::cmrt::sdk::job_service::v1::UpdateJobStatusResponse;
 using google::cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutRequest;
 using google::cmrt::sdk::job_service::v1::UpdateJobVisibilityTimeoutResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsResponse;
 using google::cmrt::sdk::nosql_database_service::v1::GetDatabaseItemResponse;
 using google::cmrt::sdk::nosql_database_service::v1::Item;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutResponse;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageResponse;
 using google::cmrt::sdk::queue_service::v1::GetTopMessageResponse;
@@ -70,6 +83,7 @@ using google::scp::core::errors::SC_CPIO_CLOUD_INVALID_ARGUMENT;
 using google::scp::core::errors::SC_CPIO_CLOUD_REQUEST_TIMEOUT;
 using google::scp::core::errors::SC_CPIO_INTERNAL_ERROR;
 using google::scp::core::errors::SC_CPIO_INVALID_REQUEST;
+using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_BATCH;
 using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_DURATION;
 using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_JOB_ITEM;
 using google::scp::core::errors::SC_JOB_CLIENT_PROVIDER_INVALID_JOB_STATUS;
@@ -103,9 +117,11 @@ using google::scp::cpio::client_providers::mock::MockQueueClientProvider;
 using helloworld::HelloWorld;
 using std::make_shared;
 using std::make_unique;
+using std::move;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::vector;
 using testing::Eq;
 using testing::Ne;
 using testing::NiceMock;
@@ -743,6 +759,132 @@ MATCHER_P2(HasGetDatabaseItemParamsForGetJobById, table_name, job_id, "") {
                             result_listener);
 }
 
+TEST_F(JobClientProviderTest, GetNextJobWithPrefetch) {
+  job_client_options_->get_next_job_prefetch_count = 2;
+  job_client_options_->get_next_job_wait_time_seconds = 10;
+  EXPECT_SUCCESS(job_client_provider_->Init());
+  EXPECT_SUCCESS(job_client_provider_->Run());
+
+  // The second message does not match the server job id of its job item.
+  EXPECT_CALL(*queue_client_provider_, GetTopMessage)
+      .WillOnce([](auto& get_top_message_context) {
+        EXPECT_EQ(get_top_message_context.request->max_number_of_messages(), 2);
+        EXPECT_EQ(get_top_message_context.request->wait_time_seconds(), 10);
+        get_top_message_context.response = make_shared<GetTopMessageResponse>();
+        auto* message = get_top_message_context.response->add_messages();
+        message->set_message_id(kServerJobId);
+        message->set_message_body(kJobId);
+        message->set_receipt_info(kQueueMessageReceiptInfo);
+        message = get_top_message_context.response->add_messages();
+        message->set_message_id(kServerJobId2);
+        message->set_message_body(kJobId);
+        message->set_receipt_info("receipt-info-2");
+        get_top_message_context.result = SuccessExecutionResult();
+        get_top_message_context.Finish();
+        return SuccessExecutionResult();
+      })
+      .WillRepeatedly([](auto& get_top_message_context) {
+        get_top_message_context.response = make_shared<GetTopMessageResponse>();
+        get_top_message_context.result = SuccessExecutionResult();
+        get_top_message_context.Finish();
+        return SuccessExecutionResult();
+      });
+  EXPECT_CALL(*queue_client_provider_, UpdateMessageVisibilityTimeout)
+      .Times(2)
+      .WillRepeatedly([](auto& update_message_visibility_timeout_context) {
+        EXPECT_EQ(update_message_visibility_timeout_context.request
+                      ->message_visibility_timeout()
+                      .seconds(),
+                  120);
+        return SuccessExecutionResult();
+      });
+
+  auto created_time = TimeUtil::GetCurrentTime();
+  auto item = CreateJobAsDatabaseItem(
+      CreateHelloWorldProtoAsAny(), JobStatus::JOB_STATUS_CREATED,
+      created_time, created_time, kDefaultRetryCount,
+      TimeUtil::SecondsToTimestamp(0));
+  EXPECT_CALL(*nosql_database_client_provider_, BatchGetDatabaseItems)
+      .WillOnce([&item](auto& batch_get_database_items_context) {
+        EXPECT_EQ(batch_get_database_items_context.request->requests().size(),
+                  2);
+        batch_get_database_items_context.response =
+            make_shared<BatchGetDatabaseItemsResponse>();
+        for (int i = 0; i < 2; ++i) {
+          auto* response =
+              batch_get_database_items_context.response->add_responses();
+          *response->mutable_result() = SuccessExecutionResult().ToProto();
+          *response->mutable_item() = item;
+        }
+        batch_get_database_items_context.result = SuccessExecutionResult();
+        batch_get_database_items_context.Finish();
+        return SuccessExecutionResult();
+      });
+
+  get_next_job_context_.callback =
+      [this](AsyncContext<GetNextJobRequest, GetNextJobResponse>&
+                 get_next_job_context) {
+        EXPECT_SUCCESS(get_next_job_context.result);
+        EXPECT_EQ(get_next_job_context.response->job().job_id(), kJobId);
+        EXPECT_EQ(get_next_job_context.response->job().server_job_id(),
+                  kServerJobId);
+        EXPECT_EQ(get_next_job_context.response->receipt_info(),
+                  kQueueMessageReceiptInfo);
+        finish_called_ = true;
+      };
+  EXPECT_SUCCESS(job_client_provider_->GetNextJob(get_next_job_context_));
+  WaitUntil([this]() { return finish_called_.load(); });
+
+  // The second job is handed out from the buffer, with its failure.
+  finish_called_ = false;
+  get_next_job_context_.callback =
+      [this](AsyncContext<GetNextJobRequest, GetNextJobResponse>&
+                 get_next_job_context) {
+        EXPECT_THAT(get_next_job_context.result,
+                    ResultIs(FailureExecutionResult(
+                        SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)));
+        finish_called_ = true;
+      };
+  EXPECT_SUCCESS(job_client_provider_->GetNextJob(get_next_job_context_));
+  WaitUntil([this]() { return finish_called_.load(); });
+
+  // The queue is empty.
+  finish_called_ = false;
+  get_next_job_context_.callback =
+      [this](AsyncContext<GetNextJobRequest, GetNextJobResponse>&
+                 get_next_job_context) {
+        EXPECT_SUCCESS(get_next_job_context.result);
+        EXPECT_TRUE(get_next_job_context.response->job().job_id().empty());
+        finish_called_ = true;
+      };
+  EXPECT_SUCCESS(job_client_provider_->GetNextJob(get_next_job_context_));
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(JobClientProviderTest, GetNextJobWithPrefetchFailure) {
+  job_client_options_->get_next_job_prefetch_count = 2;
+  EXPECT_SUCCESS(job_client_provider_->Init());
+  EXPECT_SUCCESS(job_client_provider_->Run());
+
+  EXPECT_CALL(*queue_client_provider_, GetTopMessage)
+      .WillOnce([](auto& get_top_message_context) {
+        get_top_message_context.result =
+            FailureExecutionResult(SC_CPIO_INTERNAL_ERROR);
+        get_top_message_context.Finish();
+        return get_top_message_context.result;
+      });
+
+  get_next_job_context_.callback =
+      [this](AsyncContext<GetNextJobRequest, GetNextJobResponse>&
+                 get_next_job_context) {
+        EXPECT_THAT(get_next_job_context.result,
+                    ResultIs(FailureExecutionResult(SC_CPIO_INTERNAL_ERROR)));
+        finish_called_ = true;
+      };
+  EXPECT_SUCCESS(job_client_provider_->GetNextJob(get_next_job_context_));
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 TEST_F(JobClientProviderTest, GetJobById) {
   EXPECT_SUCCESS(job_client_provider_->Init());
   EXPECT_SUCCESS(job_client_provider_->Run());
@@ -2098,4 +2240,208 @@ TEST_F(JobClientProviderTest,
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(JobClientProviderTest, BatchUpdateJobStatus) {
+  EXPECT_SUCCESS(job_client_provider_->Init());
+  EXPECT_SUCCESS(job_client_provider_->Run());
+
+  // The jobs are finished, processed, missing their id and conflicting.
+  const vector<string> job_ids = {kJobId, "job-id-2", "", "job-id-4"};
+  auto batch_update_job_status_request =
+      make_shared<BatchUpdateJobStatusRequest>();
+  for (const auto& job_id : job_ids) {
+    auto* request = batch_update_job_status_request->add_requests();
+    request->set_job_id(job_id);
+    request->set_job_status(JobStatus::JOB_STATUS_PROCESSING);
+    *request->mutable_most_recent_updated_time() = kLastUpdatedTime;
+  }
+  batch_update_job_status_request->mutable_requests(0)->set_job_status(
+      JobStatus::JOB_STATUS_SUCCESS);
+  batch_update_job_status_request->mutable_requests(0)->set_receipt_info(
+      kQueueMessageReceiptInfo);
+  *batch_update_job_status_request->mutable_requests(3)
+       ->mutable_most_recent_updated_time() = kStaleUpdatedTime;
+
+  EXPECT_CALL(*nosql_database_client_provider_, BatchGetDatabaseItems)
+      .WillOnce([](auto& batch_get_database_items_context) {
+        const auto& requests =
+            batch_get_database_items_context.request->requests();
+        EXPECT_EQ(requests.size(), 3);
+        batch_get_database_items_context.response =
+            make_shared<BatchGetDatabaseItemsResponse>();
+        for (const auto& request : requests) {
+          auto* response =
+              batch_get_database_items_context.response->add_responses();
+          *response->mutable_result() = SuccessExecutionResult().ToProto();
+          *response->mutable_item() = CreateJobAsDatabaseItem(
+              CreateHelloWorldProtoAsAny(), JobStatus::JOB_STATUS_CREATED,
+              kCreatedTime, kLastUpdatedTime, kDefaultRetryCount,
+              kDefaultTimestampValue);
+          *response->mutable_item()->mutable_key() = request.key();
+        }
+        batch_get_database_items_context.result = SuccessExecutionResult();
+        batch_get_database_items_context.Finish();
+        return SuccessExecutionResult();
+      });
+  EXPECT_CALL(*nosql_database_client_provider_, BatchUpsertDatabaseItems)
+      .WillOnce([](auto& batch_upsert_database_items_context) {
+        const auto& requests =
+            batch_upsert_database_items_context.request->requests();
+        EXPECT_EQ(requests.size(), 2);
+        batch_upsert_database_items_context.response =
+            make_shared<BatchUpsertDatabaseItemsResponse>();
+        for (const auto& request : requests) {
+          // The items are written as a whole.
+          EXPECT_EQ(request.new_attributes().size(), 7);
+          *batch_upsert_database_items_context.response->add_responses()
+               ->mutable_result() = SuccessExecutionResult().ToProto();
+        }
+        EXPECT_EQ(requests[0].key().partition_key().value_string(), kJobId);
+        EXPECT_EQ(requests[1].key().partition_key().value_string(),
+                  "job-id-2");
+        batch_upsert_database_items_context.result = SuccessExecutionResult();
+        batch_upsert_database_items_context.Finish();
+        return SuccessExecutionResult();
+      });
+  EXPECT_CALL(*queue_client_provider_,
+              DeleteMessage(HasReceiptInfo(kQueueMessageReceiptInfo)))
+      .WillOnce([](auto& delete_message_context) {
+        delete_message_context.response = make_shared<DeleteMessageResponse>();
+        delete_message_context.result = SuccessExecutionResult();
+        delete_message_context.Finish();
+        return SuccessExecutionResult();
+      });
+
+  AsyncContext<BatchUpdateJobStatusRequest, BatchUpdateJobStatusResponse>
+      batch_update_job_status_context(
+          move(batch_update_job_status_request),
+          [this](AsyncContext<BatchUpdateJobStatusRequest,
+                              BatchUpdateJobStatusResponse>&
+                     batch_update_job_status_context) {
+            EXPECT_SUCCESS(batch_update_job_status_context.result);
+            const auto& responses =
+                batch_update_job_status_context.response->responses();
+            ASSERT_EQ(responses.size(), 4);
+            EXPECT_SUCCESS(ExecutionResult(responses[0].result()));
+            EXPECT_EQ(responses[0].job_status(), JobStatus::JOB_STATUS_SUCCESS);
+            EXPECT_EQ(responses[0].retry_count(), kDefaultRetryCount);
+            EXPECT_SUCCESS(ExecutionResult(responses[1].result()));
+            EXPECT_EQ(responses[1].job_status(),
+                      JobStatus::JOB_STATUS_PROCESSING);
+            EXPECT_EQ(responses[1].retry_count(), kDefaultRetryCount + 1);
+            EXPECT_THAT(ExecutionResult(responses[2].result()),
+                        ResultIs(FailureExecutionResult(
+                            SC_JOB_CLIENT_PROVIDER_MISSING_JOB_ID)));
+            EXPECT_THAT(ExecutionResult(responses[3].result()),
+                        ResultIs(FailureExecutionResult(
+                            SC_JOB_CLIENT_PROVIDER_UPDATION_CONFLICT)));
+            finish_called_ = true;
+          });
+
+  EXPECT_SUCCESS(job_client_provider_->BatchUpdateJobStatus(
+      batch_update_job_status_context));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(JobClientProviderTest, BatchUpdateJobStatusWithRepeatedJobsFailure) {
+  EXPECT_SUCCESS(job_client_provider_->Init());
+  EXPECT_SUCCESS(job_client_provider_->Run());
+
+  auto batch_update_job_status_request =
+      make_shared<BatchUpdateJobStatusRequest>();
+  for (int i = 0; i < 2; ++i) {
+    auto* request = batch_update_job_status_request->add_requests();
+    request->set_job_id(kJobId);
+    request->set_job_status(JobStatus::JOB_STATUS_PROCESSING);
+  }
+  EXPECT_CALL(*nosql_database_client_provider_, BatchGetDatabaseItems)
+      .Times(0);
+
+  AsyncContext<BatchUpdateJobStatusRequest, BatchUpdateJobStatusResponse>
+      batch_update_job_status_context(
+          move(batch_update_job_status_request),
+          [this](AsyncContext<BatchUpdateJobStatusRequest,
+                              BatchUpdateJobStatusResponse>&
+                     batch_update_job_status_context) {
+            EXPECT_THAT(batch_update_job_status_context.result,
+                        ResultIs(FailureExecutionResult(
+                            SC_JOB_CLIENT_PROVIDER_INVALID_BATCH)));
+            finish_called_ = true;
+          });
+
+  EXPECT_THAT(job_client_provider_->BatchUpdateJobStatus(
+                  batch_update_job_status_context),
+              ResultIs(FailureExecutionResult(
+                  SC_JOB_CLIENT_PROVIDER_INVALID_BATCH)));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(JobClientProviderTest, BatchUpdateJobVisibilityTimeout) {
+  EXPECT_SUCCESS(job_client_provider_->Init());
+  EXPECT_SUCCESS(job_client_provider_->Run());
+
+  auto batch_update_job_visibility_timeout_request =
+      make_shared<BatchUpdateJobVisibilityTimeoutRequest>();
+  for (const auto& duration :
+       {kUpdatedVisibilityTimeout, kExceededVisibilityTimeout,
+        kUpdatedVisibilityTimeout}) {
+    auto* request = batch_update_job_visibility_timeout_request->add_requests();
+    request->set_job_id(kJobId);
+    *request->mutable_duration_to_update() = duration;
+    request->set_receipt_info(kQueueMessageReceiptInfo);
+  }
+
+  // The invalid duration is not sent, the last message fails in the queue.
+  EXPECT_CALL(*queue_client_provider_, BatchUpdateMessageVisibilityTimeout)
+      .WillOnce([](auto& batch_update_message_visibility_timeout_context) {
+        const auto& requests =
+            batch_update_message_visibility_timeout_context.request->requests();
+        EXPECT_EQ(requests.size(), 2);
+        EXPECT_EQ(requests[0].receipt_info(), kQueueMessageReceiptInfo);
+        EXPECT_EQ(requests[0].message_visibility_timeout(),
+                  kUpdatedVisibilityTimeout);
+        batch_update_message_visibility_timeout_context.response =
+            make_shared<BatchUpdateMessageVisibilityTimeoutResponse>();
+        *batch_update_message_visibility_timeout_context.response
+             ->add_responses()
+             ->mutable_result() = SuccessExecutionResult().ToProto();
+        *batch_update_message_visibility_timeout_context.response
+             ->add_responses()
+             ->mutable_result() =
+            FailureExecutionResult(SC_CPIO_CLOUD_REQUEST_TIMEOUT).ToProto();
+        batch_update_message_visibility_timeout_context.result =
+            SuccessExecutionResult();
+        batch_update_message_visibility_timeout_context.Finish();
+        return SuccessExecutionResult();
+      });
+
+  AsyncContext<BatchUpdateJobVisibilityTimeoutRequest,
+               BatchUpdateJobVisibilityTimeoutResponse>
+      batch_update_job_visibility_timeout_context(
+          move(batch_update_job_visibility_timeout_request),
+          [this](AsyncContext<BatchUpdateJobVisibilityTimeoutRequest,
+                              BatchUpdateJobVisibilityTimeoutResponse>&
+                     batch_update_job_visibility_timeout_context) {
+            EXPECT_SUCCESS(batch_update_job_visibility_timeout_context.result);
+            const auto& responses =
+                batch_update_job_visibility_timeout_context.response
+                    ->responses();
+            ASSERT_EQ(responses.size(), 3);
+            EXPECT_SUCCESS(ExecutionResult(responses[0].result()));
+            EXPECT_THAT(ExecutionResult(responses[1].result()),
+                        ResultIs(FailureExecutionResult(
+                            SC_JOB_CLIENT_PROVIDER_INVALID_DURATION)));
+            EXPECT_THAT(ExecutionResult(responses[2].result()),
+                        ResultIs(FailureExecutionResult(
+                            SC_CPIO_CLOUD_REQUEST_TIMEOUT)));
+            finish_called_ = true;
+          });
+
+  EXPECT_SUCCESS(job_client_provider_->BatchUpdateJobVisibilityTimeout(
+      batch_update_job_visibility_timeout_context));
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 }  // namespace google::scp::cpio::client_providers::job_client::test
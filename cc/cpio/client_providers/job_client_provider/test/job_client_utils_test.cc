@@ -375,6 +375,40 @@ TEST(JobClientUtilsTest, CreateUpsertJobRequestWithPartialUpdate) {
   EXPECT_THAT(*request, EqualsProto(expected_request));
 }
 
+TEST(JobClientUtilsTest, CreateUpsertJobItemRequest) {
+  Item item;
+  *item.mutable_key()->mutable_partition_key() =
+      JobClientUtils::MakeStringAttribute(kJobsTablePartitionKeyName, kJobId);
+  *item.add_attributes() =
+      JobClientUtils::MakeStringAttribute(kServerJobIdColumnName, kServerJobId);
+  *item.add_attributes() =
+      JobClientUtils::MakeIntAttribute(kJobStatusColumnName, 1);
+  *item.add_attributes() =
+      JobClientUtils::MakeIntAttribute(kRetryCountColumnName, 3);
+
+  Job job;
+  job.set_job_id(kJobId);
+  auto job_status = JobStatus::JOB_STATUS_SUCCESS;
+  job.set_job_status(job_status);
+  job.set_retry_count(4);
+  auto request =
+      JobClientUtils::CreateUpsertJobItemRequest(kJobsTableName, item, job);
+
+  // The attributes of the job come first, then the rest of the item.
+  UpsertDatabaseItemRequest expected_request;
+  expected_request.mutable_key()->set_table_name(kJobsTableName);
+  *expected_request.mutable_key()->mutable_partition_key() =
+      JobClientUtils::MakeStringAttribute(kJobsTablePartitionKeyName, kJobId);
+  *expected_request.add_new_attributes() =
+      JobClientUtils::MakeIntAttribute(kJobStatusColumnName, job_status);
+  *expected_request.add_new_attributes() =
+      JobClientUtils::MakeIntAttribute(kRetryCountColumnName, 4);
+  *expected_request.add_new_attributes() =
+      JobClientUtils::MakeStringAttribute(kServerJobIdColumnName, kServerJobId);
+
+  EXPECT_THAT(*request, EqualsProto(expected_request));
+}
+
 TEST(JobClientUtilsTest, CreatePutJobRequest) {
   auto current_time = TimeUtil::GetCurrentTime();
   auto job_body_input = CreateHelloWorldProtoAsAny(current_time);
@@ -28,8 +28,10 @@ class MockTeeAwsKmsClientProviderWithOverrides
  public:
   MockTeeAwsKmsClientProviderWithOverrides(
       const std::shared_ptr<RoleCredentialsProviderInterface>&
-          credential_provider)
-      : TeeAwsKmsClientProvider(credential_provider) {}
+          credential_provider,
+      const std::shared_ptr<KmsClientOptions>& options =
+          std::make_shared<KmsClientOptions>())
+      : TeeAwsKmsClientProvider(credential_provider, options) {}
 
   core::ExecutionResult DecryptUsingEnclavesKmstoolCli(
       const std::string& command, std::string& plaintext) noexcept override {
@@ -37,6 +39,18 @@ class MockTeeAwsKmsClientProviderWithOverrides
     return core::SuccessExecutionResult();
   }
 
+  core::ExecutionResult DecryptUsingEnclavesKmsClient(
+      const cmrt::sdk::kms_service::v1::DecryptRequest& decrypt_request,
+      const GetRoleCredentialsResponse& credentials,
+      std::string& plaintext) noexcept override {
+    enclaves_kms_client_decrypt_count++;
+    plaintext = returned_plaintext;
+    return enclaves_kms_client_decrypt_result;
+  }
+
   std::string returned_plaintext;
+  size_t enclaves_kms_client_decrypt_count = 0;
+  core::ExecutionResult enclaves_kms_client_decrypt_result =
+      core::SuccessExecutionResult();
 };
 }  // namespace google::scp::cpio::client_providers::mock
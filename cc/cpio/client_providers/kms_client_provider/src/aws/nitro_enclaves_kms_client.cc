@@ -0,0 +1,158 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nitro_enclaves_kms_client.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/error.h>
+#include <aws/common/string.h>
+#include <aws/io/socket.h>
+#include <aws/nitro_enclaves/kms.h>
+#include <aws/nitro_enclaves/nitro_enclaves.h>
+
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/utils/src/base64.h"
+
+#include "tee_error_codes.h"
+
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::errors::
+    SC_TEE_AWS_KMS_CLIENT_PROVIDER_DECRYPTION_FAILED;
+using google::scp::core::errors::
+    SC_TEE_AWS_KMS_CLIENT_PROVIDER_ENCLAVES_KMS_CLIENT_CREATION_FAILED;
+using google::scp::core::utils::Base64Decode;
+using std::lock_guard;
+using std::make_unique;
+using std::mutex;
+using std::string;
+
+/// Filename for logging errors
+static constexpr char kNitroEnclavesKmsClient[] = "NitroEnclavesKmsClient";
+
+/// The vsock proxy to KMS, the default of kmstool_enclave_cli.
+static constexpr char kProxyCid[] = "3";
+static constexpr uint16_t kProxyPort = 8000;
+
+static aws_allocator* GetAllocator() noexcept {
+  static std::once_flag library_initialized;
+  std::call_once(library_initialized,
+                 []() { aws_nitro_enclaves_library_init(nullptr); });
+  return aws_nitro_enclaves_get_allocator();
+}
+
+namespace google::scp::cpio::client_providers {
+NitroEnclavesKmsClient::Client::~Client() {
+  if (kms_client) {
+    aws_nitro_enclaves_kms_client_destroy(kms_client);
+  }
+  aws_string_destroy_secure(security_token);
+  aws_string_destroy_secure(access_key_secret);
+  aws_string_destroy_secure(access_key_id);
+  aws_string_destroy(region);
+}
+
+NitroEnclavesKmsClient::~NitroEnclavesKmsClient() {
+  Clear();
+}
+
+void NitroEnclavesKmsClient::Clear() noexcept {
+  lock_guard<mutex> lock(mutex_);
+  clients_.clear();
+}
+
+ExecutionResult NitroEnclavesKmsClient::Decrypt(
+    const string& region, const string& access_key_id,
+    const string& access_key_secret, const string& security_token,
+    const string& ciphertext, string& plaintext) noexcept {
+  string decoded_ciphertext;
+  auto execution_result = Base64Decode(ciphertext, decoded_ciphertext);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kNitroEnclavesKmsClient, kZeroUuid, execution_result,
+              "Failed to decode the ciphertext.");
+    return execution_result;
+  }
+
+  auto* allocator = GetAllocator();
+  lock_guard<mutex> lock(mutex_);
+  // The session credentials rotate, the client of a region is then replaced.
+  auto credentials_key = access_key_id + ":" + security_token;
+  auto& client = clients_[region];
+  if (!client || client->credentials_key != credentials_key) {
+    client = make_unique<Client>();
+    client->credentials_key = credentials_key;
+    client->region = aws_string_new_from_c_str(allocator, region.c_str());
+    client->access_key_id =
+        aws_string_new_from_c_str(allocator, access_key_id.c_str());
+    client->access_key_secret =
+        aws_string_new_from_c_str(allocator, access_key_secret.c_str());
+    client->security_token =
+        aws_string_new_from_c_str(allocator, security_token.c_str());
+
+    aws_socket_endpoint endpoint = {};
+    snprintf(endpoint.address, sizeof(endpoint.address), "%s", kProxyCid);
+    endpoint.port = kProxyPort;
+    auto* configuration = aws_nitro_enclaves_kms_client_config_default(
+        client->region, &endpoint, AWS_SOCKET_VSOCK, client->access_key_id,
+        client->access_key_secret, client->security_token);
+    if (configuration) {
+      client->kms_client = aws_nitro_enclaves_kms_client_new(configuration);
+      aws_nitro_enclaves_kms_client_config_destroy(configuration);
+    }
+    if (!client->kms_client) {
+      execution_result = FailureExecutionResult(
+          SC_TEE_AWS_KMS_CLIENT_PROVIDER_ENCLAVES_KMS_CLIENT_CREATION_FAILED);
+      SCP_ERROR(kNitroEnclavesKmsClient, kZeroUuid, execution_result,
+                "Failed to create the enclaves KMS client for region %s: %s",
+                region.c_str(), aws_error_str(aws_last_error()));
+      clients_.erase(region);
+      return execution_result;
+    }
+  }
+
+  auto ciphertext_buffer = aws_byte_buf_from_array(
+      reinterpret_cast<const uint8_t*>(decoded_ciphertext.data()),
+      decoded_ciphertext.size());
+  aws_byte_buf plaintext_buffer = {};
+  if (aws_kms_decrypt_blocking(client->kms_client, /*key_id=*/nullptr,
+                               /*encryption_algorithm=*/nullptr,
+                               &ciphertext_buffer,
+                               &plaintext_buffer) != AWS_OP_SUCCESS) {
+    execution_result = FailureExecutionResult(
+        SC_TEE_AWS_KMS_CLIENT_PROVIDER_DECRYPTION_FAILED);
+    SCP_ERROR(kNitroEnclavesKmsClient, kZeroUuid, execution_result,
+              "Failed to decrypt with the enclaves KMS client: %s",
+              aws_error_str(aws_last_error()));
+    // The connection may be broken, the next decryption starts afresh.
+    clients_.erase(region);
+    return execution_result;
+  }
+
+  plaintext.assign(reinterpret_cast<const char*>(plaintext_buffer.buffer),
+                   plaintext_buffer.len);
+  aws_byte_buf_clean_up_secure(&plaintext_buffer);
+  return SuccessExecutionResult();
+}
+}  // namespace google::scp::cpio::client_providers
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "public/core/interface/execution_result.h"
+
+struct aws_nitro_enclaves_kms_client;
+struct aws_string;
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Decrypts with the KMS client of the AWS Nitro Enclaves SDK, in
+ * process.
+ *
+ * The SDK client of a region is kept for as long as the credentials stay the
+ * same, so the attestation key pair it generated and its vsock connection to
+ * the proxy are reused by the following decryptions, where kmstool_enclave_cli
+ * pays for all of them on every call.
+ */
+class NitroEnclavesKmsClient {
+ public:
+  NitroEnclavesKmsClient() = default;
+  ~NitroEnclavesKmsClient();
+
+  NitroEnclavesKmsClient(const NitroEnclavesKmsClient&) = delete;
+  NitroEnclavesKmsClient& operator=(const NitroEnclavesKmsClient&) = delete;
+
+  /**
+   * @brief Decrypts the ciphertext.
+   *
+   * @param region the region of the KMS key.
+   * @param access_key_id the access key id of the credentials.
+   * @param access_key_secret the secret access key of the credentials.
+   * @param security_token the session token of the credentials.
+   * @param ciphertext the base64 encoded ciphertext.
+   * @param[out] plaintext the plaintext.
+   * @return core::ExecutionResult the decryption result.
+   */
+  core::ExecutionResult Decrypt(const std::string& region,
+                                const std::string& access_key_id,
+                                const std::string& access_key_secret,
+                                const std::string& security_token,
+                                const std::string& ciphertext,
+                                std::string& plaintext) noexcept;
+
+  /// @brief Destroys the SDK clients.
+  void Clear() noexcept;
+
+ private:
+  /// An SDK client and the strings it was configured with, which it
+  /// references.
+  struct Client {
+    ~Client();
+
+    aws_string* region = nullptr;
+    aws_string* access_key_id = nullptr;
+    aws_string* access_key_secret = nullptr;
+    aws_string* security_token = nullptr;
+    aws_nitro_enclaves_kms_client* kms_client = nullptr;
+    /// The credentials the client was created with.
+    std::string credentials_key;
+  };
+
+  /// Protects clients_, and serializes the blocking SDK decryptions.
+  std::mutex mutex_;
+  /// The SDK clients by region.
+  std::map<std::string, std::unique_ptr<Client>> clients_;
+};
+}  // namespace google::scp::cpio::client_providers
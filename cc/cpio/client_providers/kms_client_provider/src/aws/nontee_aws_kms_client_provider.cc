@@ -85,12 +85,23 @@ ExecutionResult NonteeAwsKmsClientProvider::Run() noexcept {
 }
 
 ExecutionResult NonteeAwsKmsClientProvider::Stop() noexcept {
+  decrypt_coalescer_.Clear();
   return SuccessExecutionResult();
 }
 
 ExecutionResult NonteeAwsKmsClientProvider::Decrypt(
     core::AsyncContext<DecryptRequest, DecryptResponse>&
         decrypt_context) noexcept {
+  return decrypt_coalescer_.Decrypt(
+      decrypt_context, [this](AsyncContext<DecryptRequest, DecryptResponse>&
+                                  kms_decrypt_context) {
+        return DecryptWithKms(kms_decrypt_context);
+      });
+}
+
+ExecutionResult NonteeAwsKmsClientProvider::DecryptWithKms(
+    core::AsyncContext<DecryptRequest, DecryptResponse>&
+        decrypt_context) noexcept {
   const auto& ciphertext = decrypt_context.request->ciphertext();
   if (ciphertext.empty()) {
     auto execution_result = FailureExecutionResult(
@@ -287,8 +298,8 @@ std::shared_ptr<KmsClientProviderInterface> KmsClientProviderFactory::Create(
         role_credentials_provider,
     const shared_ptr<core::AsyncExecutorInterface>&
         io_async_executor) noexcept {
-  return make_shared<NonteeAwsKmsClientProvider>(role_credentials_provider,
-                                                 io_async_executor);
+  return make_shared<NonteeAwsKmsClientProvider>(
+      role_credentials_provider, io_async_executor, options);
 }
 #endif
 }  // namespace google::scp::cpio::client_providers
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -28,7 +29,9 @@
 #include "core/interface/async_context.h"
 #include "cpio/client_providers/interface/kms_client_provider_interface.h"
 #include "cpio/client_providers/interface/role_credentials_provider_interface.h"
+#include "cpio/client_providers/kms_client_provider/src/common/kms_decrypt_coalescer.h"
 #include "public/core/interface/execution_result.h"
+#include "public/cpio/interface/kms_client/type_def.h"
 
 namespace google::scp::cpio::client_providers {
 /*! @copydoc KmsClientProviderInterface
@@ -43,13 +46,19 @@ class NonteeAwsKmsClientProvider : public KmsClientProviderInterface {
    * @param region the AWS region.
    * @param async_executor the thread pool for batch recording.
    * @param io_async_executor the thread pool for batch recording.
+   * @param options the configurations of the KMS client.
    */
   explicit NonteeAwsKmsClientProvider(
       const std::shared_ptr<RoleCredentialsProviderInterface>&
           role_credentials_provider,
-      const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor)
+      const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor,
+      const std::shared_ptr<KmsClientOptions>& options =
+          std::make_shared<KmsClientOptions>())
       : role_credentials_provider_(role_credentials_provider),
-        io_async_executor_(io_async_executor) {}
+        io_async_executor_(io_async_executor),
+        decrypt_coalescer_(
+            std::chrono::seconds(options->decrypt_result_cache_ttl_seconds),
+            options->decrypt_result_cache_capacity) {}
 
   NonteeAwsKmsClientProvider() = delete;
 
@@ -65,6 +74,17 @@ class NonteeAwsKmsClientProvider : public KmsClientProviderInterface {
           decrypt_context) noexcept override;
 
  protected:
+  /**
+   * @brief Decrypts with KMS, without coalescing.
+   *
+   * @param decrypt_context the context of decrpytion.
+   * @return core::ExecutionResult the decryption results.
+   */
+  core::ExecutionResult DecryptWithKms(
+      core::AsyncContext<cmrt::sdk::kms_service::v1::DecryptRequest,
+                         cmrt::sdk::kms_service::v1::DecryptResponse>&
+          decrypt_context) noexcept;
+
   /**
    * @brief Callback to pass Aead for decryption.
    *
@@ -161,5 +181,8 @@ class NonteeAwsKmsClientProvider : public KmsClientProviderInterface {
 
   /// The instance of the io async executor.
   const std::shared_ptr<core::AsyncExecutorInterface> io_async_executor_;
+
+  /// Coalesces the identical decryptions and caches their plaintexts.
+  KmsDecryptCoalescer decrypt_coalescer_;
 };
 }  // namespace google::scp::cpio::client_providers
@@ -118,12 +118,26 @@ ExecutionResult TeeAwsKmsClientProvider::Run() noexcept {
 }
 
 ExecutionResult TeeAwsKmsClientProvider::Stop() noexcept {
+  decrypt_coalescer_.Clear();
+  if (enclaves_kms_client_) {
+    enclaves_kms_client_->Clear();
+  }
   return SuccessExecutionResult();
 }
 
 ExecutionResult TeeAwsKmsClientProvider::Decrypt(
     core::AsyncContext<DecryptRequest, DecryptResponse>&
         decrypt_context) noexcept {
+  return decrypt_coalescer_.Decrypt(
+      decrypt_context, [this](AsyncContext<DecryptRequest, DecryptResponse>&
+                                  kms_decrypt_context) {
+        return DecryptWithKms(kms_decrypt_context);
+      });
+}
+
+ExecutionResult TeeAwsKmsClientProvider::DecryptWithKms(
+    core::AsyncContext<DecryptRequest, DecryptResponse>&
+        decrypt_context) noexcept {
   const auto& ciphertext = decrypt_context.request->ciphertext();
   if (ciphertext.empty()) {
     auto execution_result = FailureExecutionResult(
@@ -187,6 +201,25 @@ void TeeAwsKmsClientProvider::GetSessionCredentialsCallbackToDecrypt(
   const auto& get_session_credentials_response =
       *get_session_credentials_context.response;
 
+  if (UsesEnclavesKmsClient()) {
+    string plaintext;
+    execution_result = DecryptUsingEnclavesKmsClient(
+        *decrypt_context.request, get_session_credentials_response, plaintext);
+    if (!execution_result.Successful()) {
+      SCP_ERROR_CONTEXT(kTeeAwsKmsClientProvider, decrypt_context,
+                        execution_result,
+                        "Failed to decrypt with the enclaves KMS client.");
+      decrypt_context.result = execution_result;
+      decrypt_context.Finish();
+      return;
+    }
+    decrypt_context.response = make_shared<DecryptResponse>();
+    decrypt_context.response->set_plaintext(move(plaintext));
+    decrypt_context.result = SuccessExecutionResult();
+    decrypt_context.Finish();
+    return;
+  }
+
   string command;
   BuildDecryptCmd(decrypt_context.request->kms_region(),
                   decrypt_context.request->ciphertext(),
@@ -262,6 +295,15 @@ ExecutionResult TeeAwsKmsClientProvider::DecryptUsingEnclavesKmstoolCli(
   return SuccessExecutionResult();
 }
 
+ExecutionResult TeeAwsKmsClientProvider::DecryptUsingEnclavesKmsClient(
+    const DecryptRequest& decrypt_request,
+    const GetRoleCredentialsResponse& credentials, string& plaintext) noexcept {
+  return enclaves_kms_client_->Decrypt(
+      decrypt_request.kms_region(), *credentials.access_key_id,
+      *credentials.access_key_secret, *credentials.security_token,
+      decrypt_request.ciphertext(), plaintext);
+}
+
 #ifndef TEST_CPIO
 std::shared_ptr<KmsClientProviderInterface> KmsClientProviderFactory::Create(
     const shared_ptr<KmsClientOptions>& options,
@@ -269,7 +311,8 @@ std::shared_ptr<KmsClientProviderInterface> KmsClientProviderFactory::Create(
         role_credentials_provider,
     const shared_ptr<core::AsyncExecutorInterface>&
         io_async_executor) noexcept {
-  return make_shared<TeeAwsKmsClientProvider>(role_credentials_provider);
+  return make_shared<TeeAwsKmsClientProvider>(role_credentials_provider,
+                                              options);
 }
 #endif
 }  // namespace google::scp::cpio::client_providers
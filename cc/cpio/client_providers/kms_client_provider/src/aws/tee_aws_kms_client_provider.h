@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -23,7 +24,10 @@
 #include "core/interface/credentials_provider_interface.h"
 #include "cpio/client_providers/interface/kms_client_provider_interface.h"
 #include "cpio/client_providers/interface/role_credentials_provider_interface.h"
+#include "cpio/client_providers/kms_client_provider/src/aws/nitro_enclaves_kms_client.h"
+#include "cpio/client_providers/kms_client_provider/src/common/kms_decrypt_coalescer.h"
 #include "public/core/interface/execution_result.h"
+#include "public/cpio/interface/kms_client/type_def.h"
 
 namespace google::scp::cpio::client_providers {
 /*! @copydoc KmsClientProviderInterface
@@ -34,11 +38,21 @@ class TeeAwsKmsClientProvider : public KmsClientProviderInterface {
    * @brief Constructs a new Aws Enclaves Kms Client Provider.
    *
    * @param credential_provider the credential provider.
+   * @param options the configurations of the KMS client.
    */
   explicit TeeAwsKmsClientProvider(
       const std::shared_ptr<RoleCredentialsProviderInterface>&
-          credential_provider)
-      : credential_provider_(credential_provider) {}
+          credential_provider,
+      const std::shared_ptr<KmsClientOptions>& options =
+          std::make_shared<KmsClientOptions>())
+      : credential_provider_(credential_provider),
+        decrypt_coalescer_(
+            std::chrono::seconds(options->decrypt_result_cache_ttl_seconds),
+            options->decrypt_result_cache_capacity),
+        enclaves_kms_client_(
+            options->enable_in_process_enclaves_decryption
+                ? std::make_unique<NitroEnclavesKmsClient>()
+                : nullptr) {}
 
   TeeAwsKmsClientProvider() = delete;
 
@@ -54,6 +68,17 @@ class TeeAwsKmsClientProvider : public KmsClientProviderInterface {
           decrypt_context) noexcept override;
 
  protected:
+  /**
+   * @brief Decrypts with the KMS tool, without coalescing.
+   *
+   * @param decrypt_context the context of decrpytion.
+   * @return core::ExecutionResult the decryption results.
+   */
+  core::ExecutionResult DecryptWithKms(
+      core::AsyncContext<cmrt::sdk::kms_service::v1::DecryptRequest,
+                         cmrt::sdk::kms_service::v1::DecryptResponse>&
+          decrypt_context) noexcept;
+
   /**
    * @brief Callback to pass session credentials for decryption.
    *
@@ -72,7 +97,31 @@ class TeeAwsKmsClientProvider : public KmsClientProviderInterface {
   virtual core::ExecutionResult DecryptUsingEnclavesKmstoolCli(
       const std::string& command, std::string& plaintext) noexcept;
 
+  /**
+   * @brief Decrypts in process with the Nitro Enclaves SDK.
+   *
+   * @param decrypt_request the decryption request.
+   * @param credentials the session credentials to decrypt with.
+   * @param[out] plaintext the plaintext, not base64 encoded.
+   * @return core::ExecutionResult the decryption result.
+   */
+  virtual core::ExecutionResult DecryptUsingEnclavesKmsClient(
+      const cmrt::sdk::kms_service::v1::DecryptRequest& decrypt_request,
+      const GetRoleCredentialsResponse& credentials,
+      std::string& plaintext) noexcept;
+
+  /// Whether to decrypt in process instead of with the KMS tool.
+  bool UsesEnclavesKmsClient() const noexcept {
+    return enclaves_kms_client_ != nullptr;
+  }
+
   /// Credential provider.
   const std::shared_ptr<RoleCredentialsProviderInterface> credential_provider_;
+
+  /// Coalesces the identical decryptions and caches their plaintexts.
+  KmsDecryptCoalescer decrypt_coalescer_;
+
+  /// Decrypts in process if enable_in_process_enclaves_decryption is set.
+  const std::unique_ptr<NitroEnclavesKmsClient> enclaves_kms_client_;
 };
 }  // namespace google::scp::cpio::client_providers
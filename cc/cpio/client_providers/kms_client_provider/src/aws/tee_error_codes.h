@@ -51,6 +51,12 @@ DEFINE_ERROR_CODE(SC_TEE_AWS_KMS_CLIENT_PROVIDER_KMSTOOL_CLI_EXECUTION_FAILED,
                   "Cannot execute enclaves kmstools cli",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
 
+DEFINE_ERROR_CODE(
+    SC_TEE_AWS_KMS_CLIENT_PROVIDER_ENCLAVES_KMS_CLIENT_CREATION_FAILED,
+    SC_TEE_AWS_KMS_CLIENT_PROVIDER, 0x0008,
+    "Cannot create the enclaves KMS client",
+    HttpStatusCode::INTERNAL_SERVER_ERROR)
+
 MAP_TO_PUBLIC_ERROR_CODE(SC_TEE_AWS_KMS_CLIENT_PROVIDER_ASSUME_ROLE_NOT_FOUND,
                          SC_CPIO_COMPONENT_FAILED_INITIALIZED)
 MAP_TO_PUBLIC_ERROR_CODE(
@@ -67,5 +73,8 @@ MAP_TO_PUBLIC_ERROR_CODE(SC_TEE_AWS_KMS_CLIENT_PROVIDER_DECRYPTION_FAILED,
 MAP_TO_PUBLIC_ERROR_CODE(
     SC_TEE_AWS_KMS_CLIENT_PROVIDER_KMSTOOL_CLI_EXECUTION_FAILED,
     SC_CPIO_INTERNAL_ERROR)
+MAP_TO_PUBLIC_ERROR_CODE(
+    SC_TEE_AWS_KMS_CLIENT_PROVIDER_ENCLAVES_KMS_CLIENT_CREATION_FAILED,
+    SC_CPIO_INTERNAL_ERROR)
 
 }  // namespace google::scp::core::errors
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "kms_decrypt_coalescer.h"
+
+#include <openssl/mem.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using google::cmrt::sdk::kms_service::v1::DecryptResponse;
+using google::scp::core::ExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using std::make_shared;
+using std::move;
+using std::string;
+using std::vector;
+using std::chrono::steady_clock;
+
+namespace google::scp::cpio::client_providers {
+KmsDecryptCoalescer::~KmsDecryptCoalescer() {
+  Clear();
+}
+
+ExecutionResult KmsDecryptCoalescer::Decrypt(
+    DecryptContext& decrypt_context, const DecryptFunction& decrypt) noexcept {
+  auto request_key = decrypt_context.request->SerializeAsString();
+  string cached_plaintext;
+  {
+    std::unique_lock lock(mutex_);
+    if (result_cache_ttl_.count() > 0) {
+      auto it = cached_plaintexts_.find(request_key);
+      if (it != cached_plaintexts_.end() &&
+          it->second.expiration_time > steady_clock::now()) {
+        cached_plaintext = it->second.plaintext;
+        lock.unlock();
+        FinishWithPlaintext(decrypt_context, cached_plaintext);
+        Zeroize(cached_plaintext);
+        return SuccessExecutionResult();
+      }
+    }
+
+    // Only the first identical decryption calls KMS, the others wait for it.
+    auto& waiting_contexts = waiting_contexts_[request_key];
+    waiting_contexts.push_back(decrypt_context);
+    if (waiting_contexts.size() > 1) {
+      return SuccessExecutionResult();
+    }
+  }
+
+  DecryptContext kms_decrypt_context(
+      decrypt_context.request,
+      [this, request_key](DecryptContext& context) {
+        OnDecrypted(request_key, context);
+      },
+      decrypt_context);
+  return decrypt(kms_decrypt_context);
+}
+
+void KmsDecryptCoalescer::OnDecrypted(
+    const string& request_key, DecryptContext& kms_decrypt_context) noexcept {
+  const bool is_decrypted = kms_decrypt_context.result.Successful() &&
+                            kms_decrypt_context.response != nullptr;
+  vector<DecryptContext> waiting_contexts;
+  {
+    std::lock_guard lock(mutex_);
+    if (auto it = waiting_contexts_.find(request_key);
+        it != waiting_contexts_.end()) {
+      waiting_contexts = move(it->second);
+      waiting_contexts_.erase(it);
+    }
+
+    if (is_decrypted && result_cache_ttl_.count() > 0) {
+      auto now = steady_clock::now();
+      EvictExpiredPlaintexts(now);
+      if (cached_plaintexts_.size() < result_cache_capacity_ ||
+          cached_plaintexts_.count(request_key) > 0) {
+        auto& entry = cached_plaintexts_[request_key];
+        Zeroize(entry.plaintext);
+        entry.plaintext = kms_decrypt_context.response->plaintext();
+        entry.expiration_time = now + result_cache_ttl_;
+      }
+    }
+  }
+
+  for (auto& decrypt_context : waiting_contexts) {
+    if (!is_decrypted) {
+      decrypt_context.result = kms_decrypt_context.result;
+      decrypt_context.Finish();
+      continue;
+    }
+    FinishWithPlaintext(decrypt_context,
+                        kms_decrypt_context.response->plaintext());
+  }
+  if (is_decrypted) {
+    Zeroize(*kms_decrypt_context.response->mutable_plaintext());
+  }
+}
+
+void KmsDecryptCoalescer::FinishWithPlaintext(
+    DecryptContext& decrypt_context, const string& plaintext) noexcept {
+  decrypt_context.response = make_shared<DecryptResponse>();
+  decrypt_context.response->set_plaintext(plaintext);
+  decrypt_context.result = SuccessExecutionResult();
+  decrypt_context.Finish();
+}
+
+void KmsDecryptCoalescer::Clear() noexcept {
+  std::lock_guard lock(mutex_);
+  for (auto& [request_key, entry] : cached_plaintexts_) {
+    Zeroize(entry.plaintext);
+  }
+  cached_plaintexts_.clear();
+}
+
+void KmsDecryptCoalescer::Zeroize(string& plaintext) noexcept {
+  OPENSSL_cleanse(plaintext.data(), plaintext.size());
+  plaintext.clear();
+}
+
+void KmsDecryptCoalescer::EvictExpiredPlaintexts(
+    steady_clock::time_point now) noexcept {
+  for (auto it = cached_plaintexts_.begin(); it != cached_plaintexts_.end();) {
+    if (it->second.expiration_time <= now) {
+      Zeroize(it->second.plaintext);
+      it = cached_plaintexts_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+}  // namespace google::scp::cpio::client_providers
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/interface/async_context.h"
+#include "public/core/interface/execution_result.h"
+#include "public/cpio/proto/kms_service/v1/kms_service.pb.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Coalesces the identical decryptions of a KMS client provider into a
+ * single call to KMS, and optionally caches their plaintexts for a short TTL.
+ *
+ * Two decryptions are identical when all the fields of their requests are.
+ * The cached plaintexts are zeroized before being freed. The expired ones are
+ * evicted when plaintexts are inserted.
+ */
+class KmsDecryptCoalescer {
+ public:
+  using DecryptContext =
+      core::AsyncContext<cmrt::sdk::kms_service::v1::DecryptRequest,
+                         cmrt::sdk::kms_service::v1::DecryptResponse>;
+  /// Decrypts with KMS, with the same contract as Decrypt.
+  using DecryptFunction = std::function<core::ExecutionResult(DecryptContext&)>;
+
+  /**
+   * @param result_cache_ttl how long the plaintexts are cached. Zero disables
+   * the cache.
+   * @param result_cache_capacity the maximum number of cached plaintexts.
+   */
+  KmsDecryptCoalescer(std::chrono::seconds result_cache_ttl,
+                      size_t result_cache_capacity)
+      : result_cache_ttl_(result_cache_ttl),
+        result_cache_capacity_(result_cache_capacity) {}
+
+  ~KmsDecryptCoalescer();
+
+  KmsDecryptCoalescer(const KmsDecryptCoalescer&) = delete;
+  KmsDecryptCoalescer& operator=(const KmsDecryptCoalescer&) = delete;
+
+  /**
+   * @brief Finishes the context with the cached plaintext, if any. Otherwise
+   * waits for the identical decryption in flight, or calls decrypt when there
+   * is none.
+   *
+   * @param decrypt_context the context of the decryption.
+   * @param decrypt what decrypts with KMS.
+   * @return core::ExecutionResult the result of decrypt, or success when the
+   * context is served from the cache or waits.
+   */
+  core::ExecutionResult Decrypt(DecryptContext& decrypt_context,
+                                const DecryptFunction& decrypt) noexcept;
+
+  /// Evicts all the cached plaintexts.
+  void Clear() noexcept;
+
+ private:
+  struct CachedPlaintext {
+    std::string plaintext;
+    std::chrono::steady_clock::time_point expiration_time;
+  };
+
+  /// Finishes the contexts waiting for the decryption of the request.
+  void OnDecrypted(const std::string& request_key,
+                   DecryptContext& kms_decrypt_context) noexcept;
+
+  /// Finishes the context with a copy of the plaintext.
+  static void FinishWithPlaintext(DecryptContext& decrypt_context,
+                                  const std::string& plaintext) noexcept;
+
+  /// Zeroizes the plaintext.
+  static void Zeroize(std::string& plaintext) noexcept;
+
+  /// Evicts the expired plaintexts. Must hold mutex_.
+  void EvictExpiredPlaintexts(
+      std::chrono::steady_clock::time_point now) noexcept;
+
+  const std::chrono::seconds result_cache_ttl_;
+  const size_t result_cache_capacity_;
+  std::mutex mutex_;
+  /// The contexts waiting for each decryption in flight, keyed by the
+  /// serialized request.
+  std::unordered_map<std::string, std::vector<DecryptContext>>
+      waiting_contexts_;
+  /// The cached plaintexts, keyed by the serialized request.
+  std::unordered_map<std::string, CachedPlaintext> cached_plaintexts_;
+};
+}  // namespace google::scp::cpio::client_providers
@@ -69,12 +69,23 @@ ExecutionResult GcpKmsClientProvider::Run() noexcept {
 }
 
 ExecutionResult GcpKmsClientProvider::Stop() noexcept {
+  decrypt_coalescer_.Clear();
   return SuccessExecutionResult();
 }
 
 ExecutionResult GcpKmsClientProvider::Decrypt(
     core::AsyncContext<DecryptRequest, DecryptResponse>&
         decrypt_context) noexcept {
+  return decrypt_coalescer_.Decrypt(
+      decrypt_context, [this](AsyncContext<DecryptRequest, DecryptResponse>&
+                                  kms_decrypt_context) {
+        return DecryptWithKms(kms_decrypt_context);
+      });
+}
+
+ExecutionResult GcpKmsClientProvider::DecryptWithKms(
+    core::AsyncContext<DecryptRequest, DecryptResponse>&
+        decrypt_context) noexcept {
   const auto& ciphertext = decrypt_context.request->ciphertext();
   if (ciphertext.empty()) {
     auto execution_result =
@@ -166,7 +177,8 @@ shared_ptr<KmsClientProviderInterface> KmsClientProviderFactory::Create(
     const shared_ptr<RoleCredentialsProviderInterface>&
         role_credentials_provider,
     const shared_ptr<AsyncExecutorInterface>& io_async_executor) noexcept {
-  return make_shared<GcpKmsClientProvider>();
+  return make_shared<GcpKmsClientProvider>(make_shared<GcpKmsAeadProvider>(),
+                                          options);
 }
 #endif
 }  // namespace google::scp::cpio::client_providers
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -23,7 +24,9 @@
 
 #include "core/interface/async_context.h"
 #include "cpio/client_providers/interface/kms_client_provider_interface.h"
+#include "cpio/client_providers/kms_client_provider/src/common/kms_decrypt_coalescer.h"
 #include "public/core/interface/execution_result.h"
+#include "public/cpio/interface/kms_client/type_def.h"
 
 #include "error_codes.h"
 #include "gcp_kms_aead.h"
@@ -37,8 +40,13 @@ class GcpKmsClientProvider : public KmsClientProviderInterface {
  public:
   explicit GcpKmsClientProvider(
       const std::shared_ptr<GcpKmsAeadProvider>& aead_provider =
-          std::make_shared<GcpKmsAeadProvider>())
-      : aead_provider_(aead_provider) {}
+          std::make_shared<GcpKmsAeadProvider>(),
+      const std::shared_ptr<KmsClientOptions>& options =
+          std::make_shared<KmsClientOptions>())
+      : aead_provider_(aead_provider),
+        decrypt_coalescer_(
+            std::chrono::seconds(options->decrypt_result_cache_ttl_seconds),
+            options->decrypt_result_cache_capacity) {}
 
   core::ExecutionResult Init() noexcept override;
 
@@ -52,7 +60,15 @@ class GcpKmsClientProvider : public KmsClientProviderInterface {
           decrypt_context) noexcept override;
 
  private:
+  /// Decrypts with KMS, without coalescing.
+  core::ExecutionResult DecryptWithKms(
+      core::AsyncContext<cmrt::sdk::kms_service::v1::DecryptRequest,
+                         cmrt::sdk::kms_service::v1::DecryptResponse>&
+          decrypt_context) noexcept;
+
   std::shared_ptr<GcpKmsAeadProvider> aead_provider_;
+  /// Coalesces the identical decryptions and caches their plaintexts.
+  KmsDecryptCoalescer decrypt_coalescer_;
 };
 
 /// Provides GcpKmsAead.
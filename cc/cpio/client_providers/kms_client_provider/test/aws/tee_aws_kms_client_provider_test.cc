@@ -238,4 +238,61 @@ TEST_F(TeeAwsKmsClientProviderTest, MissingRegion) {
                   SC_TEE_AWS_KMS_CLIENT_PROVIDER_REGION_NOT_FOUND)));
   WaitUntil([&]() { return condition.load(); });
 }
+TEST_F(TeeAwsKmsClientProviderTest, DecryptsInProcessWhenEnabled) {
+  auto options = make_shared<KmsClientOptions>();
+  options->enable_in_process_enclaves_decryption = true;
+  client_ = make_unique<MockTeeAwsKmsClientProviderWithOverrides>(
+      mock_credentials_provider_, options);
+  EXPECT_SUCCESS(client_->Init());
+  EXPECT_SUCCESS(client_->Run());
+
+  auto kms_decrpyt_request = make_shared<DecryptRequest>();
+  kms_decrpyt_request->set_account_identity(kAssumeRoleArn);
+  kms_decrpyt_request->set_kms_region(kRegion);
+  kms_decrpyt_request->set_ciphertext(kCiphertext);
+  // The SDK returns the plaintext as is, it is not base64 decoded.
+  client_->returned_plaintext = "plaintext";
+  atomic<bool> condition = false;
+
+  AsyncContext<DecryptRequest, DecryptResponse> context(
+      kms_decrpyt_request,
+      [&](AsyncContext<DecryptRequest, DecryptResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        EXPECT_EQ(context.response->plaintext(), "plaintext");
+        condition = true;
+      });
+
+  EXPECT_SUCCESS(client_->Decrypt(context));
+  WaitUntil([&]() { return condition.load(); });
+  EXPECT_EQ(client_->enclaves_kms_client_decrypt_count, 1);
+}
+
+TEST_F(TeeAwsKmsClientProviderTest, FailedToDecryptInProcess) {
+  auto options = make_shared<KmsClientOptions>();
+  options->enable_in_process_enclaves_decryption = true;
+  client_ = make_unique<MockTeeAwsKmsClientProviderWithOverrides>(
+      mock_credentials_provider_, options);
+  EXPECT_SUCCESS(client_->Init());
+  EXPECT_SUCCESS(client_->Run());
+
+  auto kms_decrpyt_request = make_shared<DecryptRequest>();
+  kms_decrpyt_request->set_account_identity(kAssumeRoleArn);
+  kms_decrpyt_request->set_kms_region(kRegion);
+  kms_decrpyt_request->set_ciphertext(kCiphertext);
+  client_->enclaves_kms_client_decrypt_result =
+      FailureExecutionResult(SC_TEE_AWS_KMS_CLIENT_PROVIDER_DECRYPTION_FAILED);
+  atomic<bool> condition = false;
+
+  AsyncContext<DecryptRequest, DecryptResponse> context(
+      kms_decrpyt_request,
+      [&](AsyncContext<DecryptRequest, DecryptResponse>& context) {
+        EXPECT_THAT(context.result,
+                    ResultIs(FailureExecutionResult(
+                        SC_TEE_AWS_KMS_CLIENT_PROVIDER_DECRYPTION_FAILED)));
+        condition = true;
+      });
+
+  EXPECT_SUCCESS(client_->Decrypt(context));
+  WaitUntil([&]() { return condition.load(); });
+}
 }  // namespace google::scp::cpio::client_providers::test
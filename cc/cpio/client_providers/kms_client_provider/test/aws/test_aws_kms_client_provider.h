@@ -36,7 +36,7 @@ class TestAwsKmsClientProvider : public NonteeAwsKmsClientProvider {
           role_credentials_provider,
       const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor)
       : NonteeAwsKmsClientProvider(role_credentials_provider,
-                                   io_async_executor),
+                                   io_async_executor, options),
         test_options_(options) {}
 
  protected:
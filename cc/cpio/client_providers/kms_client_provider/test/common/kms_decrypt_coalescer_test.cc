@@ -0,0 +1,180 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cpio/client_providers/kms_client_provider/src/common/kms_decrypt_coalescer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/interface/async_context.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::cmrt::sdk::kms_service::v1::DecryptRequest;
+using google::cmrt::sdk::kms_service::v1::DecryptResponse;
+using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::test::ResultIs;
+using std::make_shared;
+using std::string;
+using std::vector;
+using std::chrono::seconds;
+
+static constexpr char kCiphertext[] = "ciphertext";
+static constexpr char kPlaintext[] = "plaintext";
+
+namespace google::scp::cpio::client_providers::test {
+class KmsDecryptCoalescerTest : public ::testing::Test {
+ protected:
+  /// Creates a context recording its result and plaintext once finished.
+  AsyncContext<DecryptRequest, DecryptResponse> CreateDecryptContext(
+      const string& ciphertext) {
+    auto request = make_shared<DecryptRequest>();
+    request->set_ciphertext(ciphertext);
+    request->set_key_resource_name("key");
+    return AsyncContext<DecryptRequest, DecryptResponse>(
+        request,
+        [this](AsyncContext<DecryptRequest, DecryptResponse>& context) {
+          results_.push_back(context.result);
+          plaintexts_.push_back(context.response ? context.response->plaintext()
+                                                 : "");
+        });
+  }
+
+  /// Decrypts by recording the context, to be finished later.
+  ExecutionResult RecordKmsDecrypt(
+      AsyncContext<DecryptRequest, DecryptResponse>& context) {
+    kms_contexts_.push_back(context);
+    return SuccessExecutionResult();
+  }
+
+  /// Finishes the recorded KMS decryption with the plaintext.
+  void FinishKmsDecrypt(size_t index, const string& plaintext) {
+    auto& kms_context = kms_contexts_[index];
+    kms_context.response = make_shared<DecryptResponse>();
+    kms_context.response->set_plaintext(plaintext);
+    kms_context.result = SuccessExecutionResult();
+    kms_context.Finish();
+  }
+
+  KmsDecryptCoalescer::DecryptFunction GetKmsDecrypt() {
+    return [this](AsyncContext<DecryptRequest, DecryptResponse>& context) {
+      return RecordKmsDecrypt(context);
+    };
+  }
+
+  vector<AsyncContext<DecryptRequest, DecryptResponse>> kms_contexts_;
+  vector<ExecutionResult> results_;
+  vector<string> plaintexts_;
+};
+
+TEST_F(KmsDecryptCoalescerTest, CoalescesIdenticalDecryptions) {
+  KmsDecryptCoalescer coalescer(seconds(0), 10);
+  auto context = CreateDecryptContext(kCiphertext);
+  auto identical_context = CreateDecryptContext(kCiphertext);
+  auto other_context = CreateDecryptContext("other");
+
+  EXPECT_SUCCESS(coalescer.Decrypt(context, GetKmsDecrypt()));
+  EXPECT_SUCCESS(coalescer.Decrypt(identical_context, GetKmsDecrypt()));
+  EXPECT_SUCCESS(coalescer.Decrypt(other_context, GetKmsDecrypt()));
+  ASSERT_EQ(kms_contexts_.size(), 2);
+  EXPECT_TRUE(results_.empty());
+
+  FinishKmsDecrypt(0, kPlaintext);
+  EXPECT_EQ(plaintexts_, (vector<string>{kPlaintext, kPlaintext}));
+  FinishKmsDecrypt(1, "other plaintext");
+  ASSERT_EQ(results_.size(), 3);
+  for (const auto& result : results_) {
+    EXPECT_SUCCESS(result);
+  }
+  EXPECT_EQ(plaintexts_[2], "other plaintext");
+
+  // Without the cache, a later decryption calls KMS again.
+  EXPECT_SUCCESS(coalescer.Decrypt(context, GetKmsDecrypt()));
+  EXPECT_EQ(kms_contexts_.size(), 3);
+}
+
+TEST_F(KmsDecryptCoalescerTest, PropagatesFailureToWaitingContexts) {
+  KmsDecryptCoalescer coalescer(seconds(60), 10);
+  auto context = CreateDecryptContext(kCiphertext);
+  auto identical_context = CreateDecryptContext(kCiphertext);
+  EXPECT_SUCCESS(coalescer.Decrypt(context, GetKmsDecrypt()));
+  EXPECT_SUCCESS(coalescer.Decrypt(identical_context, GetKmsDecrypt()));
+
+  auto failure = FailureExecutionResult(SC_UNKNOWN);
+  kms_contexts_[0].result = failure;
+  kms_contexts_[0].Finish();
+
+  ASSERT_EQ(results_.size(), 2);
+  EXPECT_THAT(results_[0], ResultIs(failure));
+  EXPECT_THAT(results_[1], ResultIs(failure));
+
+  // Failures are not cached.
+  EXPECT_SUCCESS(coalescer.Decrypt(context, GetKmsDecrypt()));
+  EXPECT_EQ(kms_contexts_.size(), 2);
+}
+
+TEST_F(KmsDecryptCoalescerTest, ReturnsSynchronousFailure) {
+  KmsDecryptCoalescer coalescer(seconds(0), 10);
+  auto context = CreateDecryptContext(kCiphertext);
+  auto failure = FailureExecutionResult(SC_UNKNOWN);
+
+  EXPECT_THAT(coalescer.Decrypt(
+                  context,
+                  [&](AsyncContext<DecryptRequest, DecryptResponse>&
+                          kms_context) -> ExecutionResult {
+                    kms_context.result = failure;
+                    kms_context.Finish();
+                    return failure;
+                  }),
+              ResultIs(failure));
+  ASSERT_EQ(results_.size(), 1);
+  EXPECT_THAT(results_[0], ResultIs(failure));
+
+  // Nothing is left in flight.
+  EXPECT_SUCCESS(coalescer.Decrypt(context, GetKmsDecrypt()));
+  EXPECT_EQ(kms_contexts_.size(), 1);
+}
+
+TEST_F(KmsDecryptCoalescerTest, ServesCachedPlaintexts) {
+  KmsDecryptCoalescer coalescer(seconds(60), 1);
+  auto context = CreateDecryptContext(kCiphertext);
+  EXPECT_SUCCESS(coalescer.Decrypt(context, GetKmsDecrypt()));
+  FinishKmsDecrypt(0, kPlaintext);
+
+  auto cached_context = CreateDecryptContext(kCiphertext);
+  EXPECT_SUCCESS(coalescer.Decrypt(cached_context, GetKmsDecrypt()));
+  EXPECT_EQ(kms_contexts_.size(), 1);
+  EXPECT_EQ(plaintexts_, (vector<string>{kPlaintext, kPlaintext}));
+
+  // The cache is full, so the other plaintext is not cached.
+  auto other_context = CreateDecryptContext("other");
+  EXPECT_SUCCESS(coalescer.Decrypt(other_context, GetKmsDecrypt()));
+  FinishKmsDecrypt(1, "other plaintext");
+  EXPECT_SUCCESS(coalescer.Decrypt(other_context, GetKmsDecrypt()));
+  EXPECT_EQ(kms_contexts_.size(), 3);
+
+  coalescer.Clear();
+  EXPECT_SUCCESS(coalescer.Decrypt(cached_context, GetKmsDecrypt()));
+  EXPECT_EQ(kms_contexts_.size(), 4);
+}
+}  // namespace google::scp::cpio::client_providers::test
@@ -16,7 +16,9 @@
 
 #include "aws_metric_client_provider.h"
 
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -150,6 +152,11 @@ ExecutionResult AwsMetricClientProvider::MetricsBatchPush(
       !metric_batching_options_->metric_namespace.empty()
           ? metric_batching_options_->metric_namespace
           : (*metric_requests_vector)[0].request->metric_namespace();
+  if (metric_batching_options_->enable_batch_recording &&
+      metric_batching_options_->enable_metric_aggregation) {
+    return AggregatedMetricsBatchPush(*metric_requests_vector, name_space);
+  }
+
   request_chunk.SetNamespace(name_space.c_str());
   size_t chunk_payload = 0;
   size_t chunk_size = 0;
@@ -220,6 +227,81 @@ ExecutionResult AwsMetricClientProvider::MetricsBatchPush(
   return SuccessExecutionResult();
 }
 
+ExecutionResult AwsMetricClientProvider::AggregatedMetricsBatchPush(
+    const vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>&
+        metric_requests_vector,
+    const string& name_space) noexcept {
+  auto push = make_shared<AggregatedPush>();
+  vector<MetricDatum> datum_list;
+  for (auto context : metric_requests_vector) {
+    vector<MetricDatum> context_datum_list;
+    auto result = AwsMetricClientUtils::ParseRequestToDatum(
+        context, context_datum_list, kAwsMetricDatumSizeLimit);
+
+    // Skips the context that failed in ParseRequestToDatum().
+    if (!result.Successful()) {
+      SCP_ERROR_CONTEXT(kAwsMetricClientProvider, context, result,
+                        "Invalid metric.");
+      continue;
+    }
+    datum_list.insert(datum_list.end(),
+                      std::make_move_iterator(context_datum_list.begin()),
+                      std::make_move_iterator(context_datum_list.end()));
+    push->contexts.push_back(context);
+  }
+  if (push->contexts.empty()) {
+    return SuccessExecutionResult();
+  }
+
+  // Splits the coalesced datums into requests within the datum count and
+  // payload limits.
+  vector<PutMetricDataRequest> requests;
+  size_t chunk_payload = 0;
+  for (auto& datum : AwsMetricClientUtils::AggregateDatums(datum_list)) {
+    PutMetricDataRequest datum_piece;
+    datum_piece.SetNamespace(name_space.c_str());
+    datum_piece.AddMetricData(datum);
+    auto datum_payload = datum_piece.SerializePayload().length();
+    if (requests.empty() ||
+        requests.back().GetMetricData().size() >= kAwsMetricDatumSizeLimit ||
+        chunk_payload + datum_payload > kAwsPayloadSizeLimit) {
+      requests.emplace_back().SetNamespace(name_space.c_str());
+      chunk_payload = 0;
+    }
+    chunk_payload += datum_payload;
+    requests.back().AddMetricData(std::move(datum));
+  }
+
+  // The requests are sent concurrently, and counted as one push.
+  push->pending_pushes = requests.size();
+  active_push_count_++;
+  for (const auto& request : requests) {
+    cloud_watch_client_->PutMetricDataAsync(
+        request,
+        bind(&AwsMetricClientProvider::OnAggregatedPutMetricDataAsyncCallback,
+             this, push, _1, _2, _3, _4));
+  }
+  return SuccessExecutionResult();
+}
+
+void AwsMetricClientProvider::OnAggregatedPutMetricDataAsyncCallback(
+    const shared_ptr<AggregatedPush>& push, const CloudWatchClient* client,
+    const PutMetricDataRequest& request, const PutMetricDataOutcome& outcome,
+    const shared_ptr<const AsyncCallerContext>& caller_context) noexcept {
+  if (!outcome.IsSuccess()) {
+    std::scoped_lock lock(push->failure_mutex);
+    if (!push->failure) {
+      push->failure = outcome;
+    }
+  }
+  if (push->pending_pushes.fetch_sub(1) != 1) {
+    return;
+  }
+  OnPutMetricDataAsyncCallback(std::move(push->contexts), client, request,
+                               push->failure ? *push->failure : outcome,
+                               caller_context);
+}
+
 void AwsMetricClientProvider::OnPutMetricDataAsyncCallback(
     vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>
         metric_requests_vector,
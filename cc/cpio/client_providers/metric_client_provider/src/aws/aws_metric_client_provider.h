@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -86,6 +89,46 @@ class AwsMetricClientProvider : public MetricClientProvider {
   std::shared_ptr<Aws::CloudWatch::CloudWatchClient> cloud_watch_client_;
 
  private:
+  /// The state of the pushes of one aggregated batch.
+  struct AggregatedPush {
+    /// The contexts of the batch, finished once all the pushes complete.
+    std::vector<
+        core::AsyncContext<cmrt::sdk::metric_service::v1::PutMetricsRequest,
+                           cmrt::sdk::metric_service::v1::PutMetricsResponse>>
+        contexts;
+    std::atomic<size_t> pending_pushes{0};
+    std::mutex failure_mutex;
+    /// The outcome of the first failed push, if any.
+    std::optional<Aws::CloudWatch::Model::PutMetricDataOutcome> failure;
+  };
+
+  /**
+   * @brief Pushes the metrics of the contexts coalesced by series, in as
+   * many concurrent PutMetricData calls as the request limits require.
+   *
+   * @param metric_requests_vector the contexts to push.
+   * @param name_space the namespace of the metrics.
+   * @return core::ExecutionResult
+   */
+  core::ExecutionResult AggregatedMetricsBatchPush(
+      const std::vector<core::AsyncContext<
+          cmrt::sdk::metric_service::v1::PutMetricsRequest,
+          cmrt::sdk::metric_service::v1::PutMetricsResponse>>&
+          metric_requests_vector,
+      const std::string& name_space) noexcept;
+
+  /**
+   * @brief Is called after each AWS PutMetricDataAsync of an aggregated batch
+   * is completed, finishing the contexts after the last one.
+   */
+  void OnAggregatedPutMetricDataAsyncCallback(
+      const std::shared_ptr<AggregatedPush>& push,
+      const Aws::CloudWatch::CloudWatchClient* client,
+      const Aws::CloudWatch::Model::PutMetricDataRequest& request,
+      const Aws::CloudWatch::Model::PutMetricDataOutcome& outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
+          caller_context) noexcept;
+
   /**
    * @brief Is called after AWS PutMetricDataAsync is completed.
    *
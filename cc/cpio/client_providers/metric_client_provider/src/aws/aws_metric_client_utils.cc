@@ -16,14 +16,18 @@
 
 #include "aws_metric_client_utils.h"
 
+#include <algorithm>
 #include <chrono>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <aws/monitoring/CloudWatchClient.h>
 #include <aws/monitoring/CloudWatchErrors.h>
 #include <aws/monitoring/model/PutMetricDataRequest.h>
+#include <aws/monitoring/model/StatisticSet.h>
 #include <google/protobuf/util/time_util.h>
 
 #include "core/interface/async_context.h"
@@ -35,6 +39,7 @@
 using Aws::CloudWatch::Model::Dimension;
 using Aws::CloudWatch::Model::MetricDatum;
 using Aws::CloudWatch::Model::StandardUnit;
+using Aws::CloudWatch::Model::StatisticSet;
 using google::cmrt::sdk::metric_service::v1::MetricUnit;
 using google::cmrt::sdk::metric_service::v1::PutMetricsRequest;
 using google::cmrt::sdk::metric_service::v1::PutMetricsResponse;
@@ -54,6 +59,7 @@ using google::scp::core::errors::
 using google::scp::core::errors::
     SC_AWS_METRIC_CLIENT_PROVIDER_OVERSIZE_DATUM_DIMENSIONS;
 using std::map;
+using std::string;
 using std::vector;
 using std::chrono::duration_cast;
 using std::chrono::hours;
@@ -64,6 +70,8 @@ static constexpr int kTwoWeeksSecondsCount =
     duration_cast<seconds>(hours(24 * 14)).count();
 static constexpr int kTwoHoursSecondsCount =
     duration_cast<seconds>(hours(2)).count();
+// The period CloudWatch aggregates standard resolution metrics by.
+static constexpr int64_t kStandardResolutionMilliseconds = 60 * 1000;
 
 static const map<MetricUnit, StandardUnit> kAwsMetricUnitMap = {
     {MetricUnit::METRIC_UNIT_UNKNOWN, StandardUnit::NOT_SET},
@@ -187,4 +195,84 @@ ExecutionResult AwsMetricClientUtils::ParseRequestToDatum(
   return SuccessExecutionResult();
 }
 
+string AwsMetricClientUtils::GetDatumKey(const MetricDatum& datum) noexcept {
+  vector<std::pair<string, string>> dimensions;
+  dimensions.reserve(datum.GetDimensions().size());
+  for (const auto& dimension : datum.GetDimensions()) {
+    dimensions.emplace_back(dimension.GetName(), dimension.GetValue());
+  }
+  // The dimensions are in the order of the labels map.
+  std::sort(dimensions.begin(), dimensions.end());
+
+  string key = datum.GetMetricName();
+  key += '\0';
+  key += std::to_string(static_cast<int>(datum.GetUnit()));
+  key += '\0';
+  key += std::to_string(datum.GetTimestamp().Millis() /
+                         kStandardResolutionMilliseconds);
+  for (const auto& [name, value] : dimensions) {
+    key += '\0';
+    key += name;
+    key += '=';
+    key += value;
+  }
+  return key;
+}
+
+vector<MetricDatum> AwsMetricClientUtils::AggregateDatums(
+    const vector<MetricDatum>& datum_list) noexcept {
+  struct Series {
+    // The index of the first datum of the series.
+    size_t first;
+    StatisticSet statistics;
+    Aws::Utils::DateTime timestamp;
+  };
+  std::unordered_map<string, size_t> series_indices;
+  vector<Series> series_list;
+  for (size_t i = 0; i < datum_list.size(); ++i) {
+    const auto& datum = datum_list[i];
+    auto value = datum.GetValue();
+    auto [it, inserted] =
+        series_indices.try_emplace(GetDatumKey(datum), series_list.size());
+    if (inserted) {
+      auto& series = series_list.emplace_back();
+      series.first = i;
+      series.statistics.SetSampleCount(1);
+      series.statistics.SetSum(value);
+      series.statistics.SetMinimum(value);
+      series.statistics.SetMaximum(value);
+      series.timestamp = datum.GetTimestamp();
+      continue;
+    }
+
+    auto& series = series_list[it->second];
+    auto& statistics = series.statistics;
+    statistics.SetSampleCount(statistics.GetSampleCount() + 1);
+    statistics.SetSum(statistics.GetSum() + value);
+    statistics.SetMinimum(std::min(statistics.GetMinimum(), value));
+    statistics.SetMaximum(std::max(statistics.GetMaximum(), value));
+    if (datum.GetTimestamp() > series.timestamp) {
+      series.timestamp = datum.GetTimestamp();
+    }
+  }
+
+  vector<MetricDatum> aggregated_list;
+  aggregated_list.reserve(series_list.size());
+  for (const auto& series : series_list) {
+    const auto& first = datum_list[series.first];
+    if (series.statistics.GetSampleCount() == 1) {
+      aggregated_list.push_back(first);
+      continue;
+    }
+    // Value and StatisticValues cannot be both set.
+    auto& aggregated = aggregated_list.emplace_back();
+    aggregated.SetMetricName(first.GetMetricName());
+    aggregated.SetDimensions(first.GetDimensions());
+    aggregated.SetUnit(first.GetUnit());
+    aggregated.SetTimestamp(series.timestamp);
+    aggregated.SetStatisticValues(series.statistics);
+  }
+  return aggregated_list;
+}
+
 }  // namespace google::scp::cpio::client_providers
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <aws/monitoring/CloudWatchClient.h>
@@ -46,6 +47,30 @@ class AwsMetricClientUtils {
           record_metric_context,
       std::vector<Aws::CloudWatch::Model::MetricDatum>& datum_list,
       int request_metric_limit) noexcept;
+
+  /**
+   * @brief Gets the key of the series of the datum, i.e. its name, unit and
+   * dimensions, and the minute of its timestamp, since CloudWatch keeps
+   * standard resolution metrics by the minute.
+   *
+   * @param datum AWS metric datum.
+   * @return std::string the key.
+   */
+  static std::string GetDatumKey(
+      const Aws::CloudWatch::Model::MetricDatum& datum) noexcept;
+
+  /**
+   * @brief Coalesces the datums of the same key into one datum of
+   * StatisticValues, so that CloudWatch computes the same statistics as for
+   * the individual values. A series with a single value is left as is.
+   *
+   * @param datum_list AWS metric datum object list.
+   * @return std::vector<Aws::CloudWatch::Model::MetricDatum> the coalesced
+   * datums, in the order of the first datum of each series.
+   */
+  static std::vector<Aws::CloudWatch::Model::MetricDatum> AggregateDatums(
+      const std::vector<Aws::CloudWatch::Model::MetricDatum>&
+          datum_list) noexcept;
 };
 
 }  // namespace google::scp::cpio::client_providers
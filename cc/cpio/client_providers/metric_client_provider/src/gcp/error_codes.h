@@ -36,6 +36,11 @@ DEFINE_ERROR_CODE(SC_GCP_METRIC_CLIENT_INVALID_METRIC_VALUE,
                   SC_GCP_METRIC_CLIENT, 0x0003,
                   "Failed to parse Gcp custom metric value to double",
                   HttpStatusCode::BAD_REQUEST)
+DEFINE_ERROR_CODE(SC_GCP_METRIC_CLIENT_TOO_MANY_IN_FLIGHT_REQUESTS,
+                  SC_GCP_METRIC_CLIENT, 0x0004,
+                  "Too many CreateTimeSeries requests in flight, the metrics "
+                  "are dropped",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
 
 MAP_TO_PUBLIC_ERROR_CODE(SC_GCP_METRIC_CLIENT_FAILED_WITH_INVALID_TIMESTAMP,
                          SC_CPIO_INVALID_REQUEST)
@@ -43,5 +48,7 @@ MAP_TO_PUBLIC_ERROR_CODE(SC_GCP_METRIC_CLIENT_FAILED_OVERSIZE_METRIC_LABELS,
                          SC_CPIO_INVALID_REQUEST)
 MAP_TO_PUBLIC_ERROR_CODE(SC_GCP_METRIC_CLIENT_INVALID_METRIC_VALUE,
                          SC_CPIO_INVALID_REQUEST)
+MAP_TO_PUBLIC_ERROR_CODE(SC_GCP_METRIC_CLIENT_TOO_MANY_IN_FLIGHT_REQUESTS,
+                         SC_CPIO_CLOUD_REQUEST_LIMIT_REACHED)
 
 }  // namespace google::scp::core::errors
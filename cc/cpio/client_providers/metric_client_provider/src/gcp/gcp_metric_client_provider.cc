@@ -16,7 +16,11 @@
 
 #include "gcp_metric_client_provider.h"
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "core/common/uuid/src/uuid.h"
@@ -33,11 +37,13 @@
 #include "gcp_metric_client_utils.h"
 
 using google::cloud::future;
+using google::cloud::make_ready_future;
 using google::cloud::Status;
 using google::cloud::StatusCode;
 using google::cloud::monitoring::MakeMetricServiceConnection;
 using google::cloud::monitoring::MetricServiceClient;
 using google::cmrt::sdk::metric_service::v1::Metric;
+using google::cmrt::sdk::metric_service::v1::MetricUnit;
 using google::cmrt::sdk::metric_service::v1::PutMetricsRequest;
 using google::cmrt::sdk::metric_service::v1::PutMetricsResponse;
 using google::monitoring::v3::CreateTimeSeriesRequest;
@@ -48,16 +54,16 @@ using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::errors::
+    SC_GCP_METRIC_CLIENT_TOO_MANY_IN_FLIGHT_REQUESTS;
 using google::scp::cpio::client_providers::GcpInstanceClientUtils;
 using google::scp::cpio::client_providers::GcpInstanceResourceNameDetails;
 using google::scp::cpio::client_providers::GcpMetricClientUtils;
 using google::scp::cpio::common::GcpUtils;
-using std::bind;
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
 using std::vector;
-using std::placeholders::_1;
 
 static constexpr char kGcpMetricClientProvider[] = "GcpMetricClientProvider";
 
@@ -115,19 +121,43 @@ ExecutionResult GcpMetricClientProvider::MetricsBatchPush(
   time_series_request.set_name(GcpMetricClientUtils::ConstructProjectName(
       instance_resource_.project_id));
 
-  // Chops the input context_vector to small piece of vector, and
-  // requests_vector is used in callback function to set the response for
-  // requests.
-  auto requests_vector =
-      make_shared<vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>>(
-          kGcpTimeSeriesSizeLimit);
-
   // When batch recording is not enabled, expect the namespace to be set on the
   // request. context_vector won't be empty.
   auto name_space = metric_batching_options_->enable_batch_recording
                         ? metric_batching_options_->metric_namespace
                         : context_vector->back().request->metric_namespace();
 
+  if (metric_batching_options_->enable_batch_recording &&
+      metric_batching_options_->enable_metric_aggregation) {
+    auto execution_result =
+        AggregatedMetricsBatchPush(*context_vector, name_space);
+    context_vector->clear();
+    return execution_result;
+  }
+
+  // Chops the input context_vector to small piece of vector, and
+  // requests_vector is used in callback function to set the response for
+  // requests.
+  auto requests_vector = make_shared<
+      vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>>();
+  requests_vector->reserve(kGcpTimeSeriesSizeLimit);
+  auto push_requests = [&]() {
+    if (!TryReserveInFlightRequests(1)) {
+      DropMetricsPush(*requests_vector);
+    } else {
+      active_push_count_++;
+      metric_client.AsyncCreateTimeSeries(time_series_request)
+          .then([this, requests = *requests_vector](future<Status> outcome) {
+            in_flight_request_count_--;
+            OnAsyncCreateTimeSeriesCallback(requests, std::move(outcome));
+          });
+    }
+
+    // Clear requests_vector and protobuf repeated field.
+    time_series_request.mutable_time_series()->Clear();
+    requests_vector->clear();
+  };
+
   while (!context_vector->empty()) {
     auto context = context_vector->back();
     context_vector->pop_back();
@@ -146,29 +176,155 @@ ExecutionResult GcpMetricClientProvider::MetricsBatchPush(
         instance_resource_.project_id, instance_resource_.instance_id,
         instance_resource_.zone_id, time_series_list);
 
+    // Calls Gcp CreateTimeSeries before time series size exceeds 200.
+    if (!requests_vector->empty() &&
+        time_series_request.time_series().size() + time_series_list.size() >
+            kGcpTimeSeriesSizeLimit) {
+      push_requests();
+    }
+
     requests_vector->push_back(context);
     time_series_request.mutable_time_series()->Add(time_series_list.begin(),
                                                    time_series_list.end());
 
-    // Calls Gcp CreateTimeSeries when time series size equals to 200 or context
-    // vector is empty.
-    if (time_series_request.time_series().size() == kGcpTimeSeriesSizeLimit ||
-        context_vector->empty()) {
-      metric_client.AsyncCreateTimeSeries(time_series_request)
-          .then(std::bind(
-              &GcpMetricClientProvider::OnAsyncCreateTimeSeriesCallback, this,
-              *requests_vector, _1));
-      active_push_count_++;
+    // Calls Gcp CreateTimeSeries when time series size reaches 200.
+    if (time_series_request.time_series().size() >= kGcpTimeSeriesSizeLimit) {
+      push_requests();
+    }
+  }
+
+  // Pushes the remaining time series, even if the last contexts failed in
+  // parsing.
+  if (!requests_vector->empty()) {
+    push_requests();
+  }
+
+  return SuccessExecutionResult();
+}
+
+ExecutionResult GcpMetricClientProvider::AggregatedMetricsBatchPush(
+    const vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>&
+        context_vector,
+    const string& name_space) noexcept {
+  auto push = make_shared<AggregatedPush>();
+  vector<TimeSeries> aggregated_list;
+  std::unordered_map<string, size_t> series_indices;
+  for (auto context : context_vector) {
+    vector<TimeSeries> time_series_list;
+    auto result = GcpMetricClientUtils::ParseRequestToTimeSeries(
+        context, name_space, time_series_list);
+    // Sets the result for the requests that failed in parsing to time series.
+    if (!result.Successful()) {
+      context.result = result;
+      context.Finish();
+      continue;
+    }
 
-      // Clear requests_vector and protobuf repeated field.
-      time_series_request.mutable_time_series()->Clear();
-      requests_vector->clear();
+    // The time series are in the order of the metrics of the request.
+    for (size_t i = 0; i < time_series_list.size(); ++i) {
+      auto [it, inserted] = series_indices.try_emplace(
+          GcpMetricClientUtils::GetTimeSeriesKey(time_series_list[i]),
+          aggregated_list.size());
+      if (inserted) {
+        aggregated_list.push_back(std::move(time_series_list[i]));
+        continue;
+      }
+      GcpMetricClientUtils::MergeTimeSeries(
+          time_series_list[i],
+          context.request->metrics(i).unit() == MetricUnit::METRIC_UNIT_COUNT,
+          aggregated_list[it->second]);
     }
+    push->contexts.push_back(context);
   }
+  if (push->contexts.empty()) {
+    return SuccessExecutionResult();
+  }
+
+  // Add gce_instance resource info to TimeSeries data.
+  GcpMetricClientUtils::AddResourceToTimeSeries(
+      instance_resource_.project_id, instance_resource_.instance_id,
+      instance_resource_.zone_id, aggregated_list);
 
+  // Splits the coalesced time series into requests within the time series
+  // limit.
+  vector<CreateTimeSeriesRequest> requests;
+  for (auto& time_series : aggregated_list) {
+    if (requests.empty() ||
+        requests.back().time_series().size() >= kGcpTimeSeriesSizeLimit) {
+      requests.emplace_back().set_name(
+          GcpMetricClientUtils::ConstructProjectName(
+              instance_resource_.project_id));
+    }
+    *requests.back().add_time_series() = std::move(time_series);
+  }
+
+  // The requests are sent concurrently, and counted as one push. They are all
+  // dropped if they do not fit within the in-flight limit.
+  if (!TryReserveInFlightRequests(requests.size())) {
+    DropMetricsPush(push->contexts);
+    return SuccessExecutionResult();
+  }
+  MetricServiceClient metric_client(*metric_service_client_);
+  push->pending_pushes = requests.size();
+  active_push_count_++;
+  for (const auto& request : requests) {
+    metric_client.AsyncCreateTimeSeries(request).then(
+        [this, push](future<Status> outcome) {
+          OnAggregatedAsyncCreateTimeSeriesCallback(push, std::move(outcome));
+        });
+  }
   return SuccessExecutionResult();
 }
 
+void GcpMetricClientProvider::OnAggregatedAsyncCreateTimeSeriesCallback(
+    const shared_ptr<AggregatedPush>& push, future<Status> outcome) noexcept {
+  in_flight_request_count_--;
+  auto outcome_status = outcome.get();
+  if (!outcome_status.ok()) {
+    std::scoped_lock lock(push->failure_mutex);
+    if (push->failure.ok()) {
+      push->failure = outcome_status;
+    }
+  }
+  if (push->pending_pushes.fetch_sub(1) != 1) {
+    return;
+  }
+  OnAsyncCreateTimeSeriesCallback(std::move(push->contexts),
+                                  make_ready_future(push->failure));
+}
+
+bool GcpMetricClientProvider::TryReserveInFlightRequests(
+    size_t request_count) noexcept {
+  auto max_in_flight_requests =
+      metric_batching_options_->max_in_flight_requests;
+  if (max_in_flight_requests == 0) {
+    in_flight_request_count_ += request_count;
+    return true;
+  }
+  auto in_flight_request_count = in_flight_request_count_.load();
+  do {
+    if (in_flight_request_count + request_count > max_in_flight_requests) {
+      return false;
+    }
+  } while (!in_flight_request_count_.compare_exchange_weak(
+      in_flight_request_count, in_flight_request_count + request_count));
+  return true;
+}
+
+void GcpMetricClientProvider::DropMetricsPush(
+    vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>&
+        metric_requests_vector) noexcept {
+  auto result =
+      FailureExecutionResult(SC_GCP_METRIC_CLIENT_TOO_MANY_IN_FLIGHT_REQUESTS);
+  SCP_ERROR_CONTEXT(kGcpMetricClientProvider, metric_requests_vector.back(),
+                    result, "Dropped the push of %zu metric requests",
+                    metric_requests_vector.size());
+  for (auto& record_metric_context : metric_requests_vector) {
+    record_metric_context.result = result;
+    record_metric_context.Finish();
+  }
+}
+
 // Copy the metric_requests_vector in case it is cleared outside, and it is not
 // expensive to copy the AsyncContext.
 void GcpMetricClientProvider::OnAsyncCreateTimeSeriesCallback(
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -90,8 +92,63 @@ class GcpMetricClientProvider : public MetricClientProvider {
       google::cloud::future<google::cloud::Status> outcome) noexcept;
 
  private:
+  /// The state of the pushes of one aggregated batch.
+  struct AggregatedPush {
+    /// The contexts of the batch, finished once all the pushes complete.
+    std::vector<
+        core::AsyncContext<cmrt::sdk::metric_service::v1::PutMetricsRequest,
+                           cmrt::sdk::metric_service::v1::PutMetricsResponse>>
+        contexts;
+    std::atomic<size_t> pending_pushes{0};
+    std::mutex failure_mutex;
+    /// The status of the first failed push, if any.
+    google::cloud::Status failure;
+  };
+
+  /**
+   * @brief Pushes the metrics of the contexts coalesced by time series, in as
+   * many concurrent CreateTimeSeries calls as the request limit requires.
+   *
+   * @param context_vector the contexts to push.
+   * @param name_space the namespace of the metrics.
+   * @return core::ExecutionResult
+   */
+  core::ExecutionResult AggregatedMetricsBatchPush(
+      const std::vector<core::AsyncContext<
+          cmrt::sdk::metric_service::v1::PutMetricsRequest,
+          cmrt::sdk::metric_service::v1::PutMetricsResponse>>&
+          context_vector,
+      const std::string& name_space) noexcept;
+
+  /**
+   * @brief Is called after each GCP AsyncCreateTimeSeries of an aggregated
+   * batch is completed, finishing the contexts after the last one.
+   */
+  void OnAggregatedAsyncCreateTimeSeriesCallback(
+      const std::shared_ptr<AggregatedPush>& push,
+      google::cloud::future<google::cloud::Status> outcome) noexcept;
+
+  /**
+   * @brief Reserves the in-flight slots of the CreateTimeSeries requests of a
+   * push, within max_in_flight_requests of the batching options.
+   *
+   * @param request_count the number of requests of the push.
+   * @return true if the requests can be sent, false if the push is dropped.
+   */
+  bool TryReserveInFlightRequests(size_t request_count) noexcept;
+
+  /// Finishes the contexts of a push dropped over the in-flight limit.
+  void DropMetricsPush(
+      std::vector<core::AsyncContext<
+          cmrt::sdk::metric_service::v1::PutMetricsRequest,
+          cmrt::sdk::metric_service::v1::PutMetricsResponse>>&
+          metric_requests_vector) noexcept;
+
   GcpInstanceResourceNameDetails instance_resource_;
 
+  /// The number of CreateTimeSeries requests sent and not completed yet.
+  std::atomic<size_t> in_flight_request_count_{0};
+
   /// An Instance of the Gcp metric service client.
   std::shared_ptr<const google::cloud::monitoring::MetricServiceClient>
       metric_service_client_;
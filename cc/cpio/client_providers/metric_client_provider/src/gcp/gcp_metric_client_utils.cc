@@ -16,6 +16,7 @@
 
 #include "gcp_metric_client_utils.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -151,4 +152,44 @@ void GcpMetricClientUtils::AddResourceToTimeSeries(
   }
 }
 
+string GcpMetricClientUtils::GetTimeSeriesKey(
+    const TimeSeries& time_series) noexcept {
+  // The labels are in no particular order in the map.
+  vector<std::pair<string, string>> labels(
+      time_series.metric().labels().begin(),
+      time_series.metric().labels().end());
+  std::sort(labels.begin(), labels.end());
+
+  string key = time_series.metric().type();
+  for (const auto& [name, value] : labels) {
+    key += '\0';
+    key += name;
+    key += '=';
+    key += value;
+  }
+  return key;
+}
+
+void GcpMetricClientUtils::MergeTimeSeries(const TimeSeries& time_series,
+                                           bool is_count,
+                                           TimeSeries& aggregated) noexcept {
+  const auto& point = time_series.points(0);
+  auto* aggregated_point = aggregated.mutable_points(0);
+  // Of the points of the same time, the one merged last wins.
+  bool is_later = point.interval().end_time() >=
+                  aggregated_point->interval().end_time();
+  if (is_count) {
+    aggregated_point->mutable_value()->set_double_value(
+        aggregated_point->value().double_value() +
+        point.value().double_value());
+  } else if (is_later) {
+    aggregated_point->mutable_value()->set_double_value(
+        point.value().double_value());
+  }
+  if (is_later) {
+    *aggregated_point->mutable_interval()->mutable_end_time() =
+        point.interval().end_time();
+  }
+}
+
 }  // namespace google::scp::cpio::client_providers
@@ -66,5 +66,29 @@ class GcpMetricClientUtils {
    * @return std::string Project name.
    */
   static std::string ConstructProjectName(const std::string& project_id);
+
+  /**
+   * @brief Gets the key of the series of the time series, i.e. its metric
+   * type and labels.
+   *
+   * @param time_series Gcp time series.
+   * @return std::string the key.
+   */
+  static std::string GetTimeSeriesKey(
+      const monitoring::v3::TimeSeries& time_series) noexcept;
+
+  /**
+   * @brief Merges the point of time_series into the point of the aggregated
+   * time series of the same key. Cloud Monitoring only takes one point per
+   * time series in a request, so counts are summed, and other values keep
+   * the latest point.
+   *
+   * @param time_series the time series to merge.
+   * @param is_count whether the value is a count.
+   * @param aggregated the aggregated time series.
+   */
+  static void MergeTimeSeries(const monitoring::v3::TimeSeries& time_series,
+                              bool is_count,
+                              monitoring::v3::TimeSeries& aggregated) noexcept;
 };
 }  // namespace google::scp::cpio::client_providers
@@ -98,9 +98,11 @@ class AwsMetricClientProviderTest : public ::testing::Test {
   }
 
   unique_ptr<MockAwsMetricClientProviderOverrides> CreateClient(
-      bool enable_batch_recording) {
+      bool enable_batch_recording, bool enable_metric_aggregation = false) {
     auto metric_batching_options = make_shared<MetricBatchingOptions>();
     metric_batching_options->enable_batch_recording = enable_batch_recording;
+    metric_batching_options->enable_metric_aggregation =
+        enable_metric_aggregation;
     if (enable_batch_recording) {
       metric_batching_options->metric_namespace = kNamespace;
     }
@@ -229,6 +231,66 @@ TEST_F(AwsMetricClientProviderTest, KeepMetricsInTheSameRequest) {
   // Cannot stop the client because the AWS callback is mocked.
 }
 
+TEST_F(AwsMetricClientProviderTest, AggregatesMetricsOfTheSameSeries) {
+  auto client = CreateClient(true, true);
+
+  client->GetInstanceClientProvider()->instance_resource_name =
+      kResourceNameMock;
+  EXPECT_SUCCESS(client->Init());
+  EXPECT_SUCCESS(client->Run());
+
+  atomic<int> put_metric_data_request_count = 0;
+  atomic<int> number_datums_received = 0;
+  atomic<int> number_samples_received = 0;
+  client->GetCloudWatchClient()->put_metric_data_async_mock =
+      [&](const Aws::CloudWatch::Model::PutMetricDataRequest& request,
+          const Aws::CloudWatch::PutMetricDataResponseReceivedHandler& handler,
+          const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
+              context) {
+        EXPECT_EQ(request.GetNamespace(), kNamespace);
+        put_metric_data_request_count += 1;
+        number_datums_received.fetch_add(request.GetMetricData().size());
+        for (const auto& datum : request.GetMetricData()) {
+          number_samples_received.fetch_add(
+              datum.StatisticValuesHasBeenSet()
+                  ? datum.GetStatisticValues().GetSampleCount()
+                  : 1);
+        }
+        handler(nullptr, request, PutMetricDataOutcome(Aws::NoResult()),
+                context);
+      };
+
+  // All the metrics in the same minute, in 1500 series.
+  auto timestamp_in_ms =
+      duration_cast<std::chrono::minutes>(
+          system_clock::now().time_since_epoch())
+          .count() *
+      60 * 1000;
+  atomic<int> context_finish_count = 0;
+  auto requests_vector = make_shared<
+      vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>>();
+  for (auto i = 0; i < 2000; i++) {
+    PutMetricsRequest record_metric_request;
+    SetPutMetricsRequest(record_metric_request, kValue, 1, timestamp_in_ms);
+    (*record_metric_request.mutable_metrics(0)->mutable_labels())["id"] =
+        std::to_string(i % 1500);
+    requests_vector->emplace_back(
+        make_shared<PutMetricsRequest>(record_metric_request),
+        [&](AsyncContext<PutMetricsRequest, PutMetricsResponse>& context) {
+          context_finish_count += 1;
+          EXPECT_SUCCESS(context.result);
+        });
+  }
+
+  EXPECT_SUCCESS(client->MetricsBatchPush(requests_vector));
+  WaitUntil([&]() { return context_finish_count.load() == 2000; });
+  EXPECT_EQ(put_metric_data_request_count.load(), 2);
+  EXPECT_EQ(number_datums_received.load(), 1500);
+  EXPECT_EQ(number_samples_received.load(), 2000);
+
+  // Cannot stop the client because the AWS callback is mocked.
+}
+
 TEST_F(AwsMetricClientProviderTest, OnPutMetricDataAsyncCallbackWithError) {
   auto client = CreateClient(true);
 
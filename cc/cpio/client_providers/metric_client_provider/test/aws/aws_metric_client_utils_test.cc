@@ -240,4 +240,64 @@ TEST_F(AwsMetricClientUtilsTest, ParseRequestToDatumInvalidUnit) {
   EXPECT_TRUE(parse_request_to_datum_is_called);
 }
 
+TEST_F(AwsMetricClientUtilsTest, AggregateDatumsCoalescesSameSeries) {
+  auto timestamp = Aws::Utils::DateTime(system_clock::now());
+  auto make_datum = [&](const string& name, double value,
+                        const string& label) {
+    MetricDatum datum;
+    datum.SetMetricName(name.c_str());
+    datum.SetValue(value);
+    datum.SetUnit(Aws::CloudWatch::Model::StandardUnit::Count);
+    datum.SetTimestamp(timestamp);
+    Dimension dimension;
+    dimension.SetName("label");
+    dimension.SetValue(label.c_str());
+    datum.AddDimensions(dimension);
+    return datum;
+  };
+  vector<MetricDatum> datum_list = {
+      make_datum(kName, 1, "a"), make_datum(kName, 5, "a"),
+      make_datum(kName, 2, "b"), make_datum("other_name", 3, "a"),
+      make_datum(kName, 3, "a")};
+
+  auto aggregated_list = AwsMetricClientUtils::AggregateDatums(datum_list);
+  ASSERT_EQ(aggregated_list.size(), 3);
+
+  const auto& aggregated = aggregated_list[0];
+  EXPECT_EQ(aggregated.GetMetricName(), kName);
+  EXPECT_FALSE(aggregated.ValueHasBeenSet());
+  EXPECT_EQ(aggregated.GetStatisticValues().GetSampleCount(), 3);
+  EXPECT_EQ(aggregated.GetStatisticValues().GetSum(), 9);
+  EXPECT_EQ(aggregated.GetStatisticValues().GetMinimum(), 1);
+  EXPECT_EQ(aggregated.GetStatisticValues().GetMaximum(), 5);
+  EXPECT_EQ(aggregated.GetDimensions().size(), 1);
+
+  // The series of a single value are left as is.
+  EXPECT_EQ(aggregated_list[1].GetValue(), 2);
+  EXPECT_FALSE(aggregated_list[1].StatisticValuesHasBeenSet());
+  EXPECT_EQ(aggregated_list[2].GetMetricName(), "other_name");
+}
+
+TEST_F(AwsMetricClientUtilsTest, GetDatumKeyIgnoresDimensionsOrder) {
+  MetricDatum datum;
+  datum.SetMetricName(kName);
+  Dimension dimension_a;
+  dimension_a.SetName("a");
+  dimension_a.SetValue("1");
+  Dimension dimension_b;
+  dimension_b.SetName("b");
+  dimension_b.SetValue("2");
+  auto other_datum = datum;
+  datum.AddDimensions(dimension_a);
+  datum.AddDimensions(dimension_b);
+  other_datum.AddDimensions(dimension_b);
+  other_datum.AddDimensions(dimension_a);
+
+  EXPECT_EQ(AwsMetricClientUtils::GetDatumKey(datum),
+            AwsMetricClientUtils::GetDatumKey(other_datum));
+  other_datum.SetUnit(Aws::CloudWatch::Model::StandardUnit::Seconds);
+  EXPECT_NE(AwsMetricClientUtils::GetDatumKey(datum),
+            AwsMetricClientUtils::GetDatumKey(other_datum));
+}
+
 }  // namespace google::scp::cpio::client_providers::test
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <google/protobuf/util/time_util.h>
@@ -38,6 +39,7 @@
 #include "public/cpio/proto/metric_service/v1/metric_service.pb.h"
 
 using google::cloud::make_ready_future;
+using google::cloud::promise;
 using google::cloud::Status;
 using google::cloud::StatusCode;
 using google::cloud::monitoring::MetricServiceClient;
@@ -54,6 +56,8 @@ using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::errors::SC_GCP_INVALID_ARGUMENT;
+using google::scp::core::errors::
+    SC_GCP_METRIC_CLIENT_TOO_MANY_IN_FLIGHT_REQUESTS;
 using google::scp::core::test::ResultIs;
 using google::scp::cpio::client_providers::GcpMetricClientUtils;
 using google::scp::cpio::client_providers::mock::
@@ -115,9 +119,13 @@ class GcpMetricClientProviderTest : public ::testing::Test {
   }
 
   unique_ptr<MockGcpMetricClientProviderOverrides> CreateClient(
-      bool enable_batch_recording) {
+      bool enable_batch_recording, bool enable_metric_aggregation = false,
+      size_t max_in_flight_requests = 0) {
     auto metric_batching_options = make_shared<MetricBatchingOptions>();
     metric_batching_options->enable_batch_recording = enable_batch_recording;
+    metric_batching_options->enable_metric_aggregation =
+        enable_metric_aggregation;
+    metric_batching_options->max_in_flight_requests = max_in_flight_requests;
     if (enable_batch_recording) {
       metric_batching_options->metric_namespace = kNamespace;
     }
@@ -273,6 +281,109 @@ TEST_F(GcpMetricClientProviderTest, FailedMetricsBatchPush) {
   EXPECT_EQ(received_metrics, 5);
 }
 
+TEST_F(GcpMetricClientProviderTest, AggregatedMetricsBatchPush) {
+  metric_client_provider_ = CreateClient(true, true);
+  EXPECT_SUCCESS(metric_client_provider_->Init());
+  EXPECT_SUCCESS(metric_client_provider_->Run());
+
+  atomic<int> metric_responses = 0;
+  auto requests_vector = make_shared<
+      vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>>();
+  // 5 requests of the same time series, and 300 of different ones.
+  for (auto i = 0; i < 305; i++) {
+    PutMetricsRequest record_metric_request;
+    SetPutMetricsRequest(record_metric_request);
+    if (i >= 5) {
+      (*record_metric_request.mutable_metrics(0)->mutable_labels())["id"] =
+          std::to_string(i);
+    }
+    requests_vector->emplace_back(
+        make_shared<PutMetricsRequest>(record_metric_request),
+        [&](AsyncContext<PutMetricsRequest, PutMetricsResponse>& context) {
+          metric_responses++;
+          EXPECT_SUCCESS(context.result);
+        });
+  }
+
+  auto metric_name =
+      GcpMetricClientUtils::ConstructProjectName(kProjectIdValue);
+  atomic<int> received_requests = 0;
+  atomic<int> received_metrics = 0;
+  EXPECT_CALL(*connection_,
+              AsyncCreateTimeSeries(RequestEquals(metric_name, kNamespace)))
+      .WillRepeatedly([&](CreateTimeSeriesRequest const& request) {
+        EXPECT_LE(request.time_series().size(), 200);
+        received_requests++;
+        received_metrics.fetch_add(request.time_series().size());
+        return make_ready_future(Status(StatusCode::kOk, ""));
+      });
+
+  auto result = metric_client_provider_->MetricsBatchPush(requests_vector);
+  EXPECT_SUCCESS(result);
+  EXPECT_EQ(received_requests, 2);
+  EXPECT_EQ(received_metrics, 301);
+  EXPECT_EQ(metric_responses, 305);
+}
+
+TEST_F(GcpMetricClientProviderTest, PushesOverTheInFlightLimitAreDropped) {
+  metric_client_provider_ = CreateClient(true, false, 1);
+  EXPECT_SUCCESS(metric_client_provider_->Init());
+  EXPECT_SUCCESS(metric_client_provider_->Run());
+
+  atomic<int> succeeded_responses = 0;
+  atomic<int> dropped_responses = 0;
+  auto create_requests_vector = [&]() {
+    PutMetricsRequest record_metric_request;
+    SetPutMetricsRequest(record_metric_request);
+    auto requests_vector = make_shared<
+        vector<AsyncContext<PutMetricsRequest, PutMetricsResponse>>>();
+    for (auto i = 0; i < 5; i++) {
+      requests_vector->emplace_back(
+          make_shared<PutMetricsRequest>(record_metric_request),
+          [&](AsyncContext<PutMetricsRequest, PutMetricsResponse>& context) {
+            if (context.result.Successful()) {
+              succeeded_responses++;
+              return;
+            }
+            EXPECT_THAT(context.result,
+                        ResultIs(FailureExecutionResult(
+                            SC_GCP_METRIC_CLIENT_TOO_MANY_IN_FLIGHT_REQUESTS)));
+            dropped_responses++;
+          });
+    }
+    return requests_vector;
+  };
+
+  // The first push stays in flight until the promise is satisfied.
+  promise<Status> in_flight_push;
+  atomic<int> received_requests = 0;
+  EXPECT_CALL(*connection_, AsyncCreateTimeSeries)
+      .WillOnce([&](CreateTimeSeriesRequest const& request) {
+        received_requests++;
+        return in_flight_push.get_future();
+      })
+      .WillRepeatedly([&](CreateTimeSeriesRequest const& request) {
+        received_requests++;
+        return make_ready_future(Status(StatusCode::kOk, ""));
+      });
+
+  EXPECT_SUCCESS(
+      metric_client_provider_->MetricsBatchPush(create_requests_vector()));
+  EXPECT_SUCCESS(
+      metric_client_provider_->MetricsBatchPush(create_requests_vector()));
+  EXPECT_EQ(received_requests, 1);
+  EXPECT_EQ(dropped_responses, 5);
+  EXPECT_EQ(succeeded_responses, 0);
+
+  in_flight_push.set_value(Status(StatusCode::kOk, ""));
+  EXPECT_EQ(succeeded_responses, 5);
+  EXPECT_SUCCESS(
+      metric_client_provider_->MetricsBatchPush(create_requests_vector()));
+  EXPECT_EQ(received_requests, 2);
+  EXPECT_EQ(succeeded_responses, 10);
+  EXPECT_EQ(dropped_responses, 5);
+}
+
 TEST_F(GcpMetricClientProviderTest, AsyncCreateTimeSeriesCallback) {
   atomic<int> received_responses = 0;
   PutMetricsRequest record_metric_request;
@@ -208,4 +208,51 @@ TEST(GcpMetricClientUtilsTestII, AddResourceToTimeSeries) {
   }
 }
 
+TEST(GcpMetricClientUtilsTestII, GetTimeSeriesKey) {
+  TimeSeries time_series;
+  time_series.mutable_metric()->set_type("custom.googleapis.com/ns/name");
+  auto* labels = time_series.mutable_metric()->mutable_labels();
+  (*labels)["a"] = "1";
+  (*labels)["b"] = "2";
+  auto other_time_series = time_series;
+
+  EXPECT_EQ(GcpMetricClientUtils::GetTimeSeriesKey(time_series),
+            GcpMetricClientUtils::GetTimeSeriesKey(other_time_series));
+  (*other_time_series.mutable_metric()->mutable_labels())["b"] = "3";
+  EXPECT_NE(GcpMetricClientUtils::GetTimeSeriesKey(time_series),
+            GcpMetricClientUtils::GetTimeSeriesKey(other_time_series));
+}
+
+TEST(GcpMetricClientUtilsTestII, MergeTimeSeries) {
+  auto make_time_series = [](double value, int64_t end_time_in_ms) {
+    TimeSeries time_series;
+    auto* point = time_series.add_points();
+    point->mutable_value()->set_double_value(value);
+    *point->mutable_interval()->mutable_end_time() =
+        TimeUtil::MillisecondsToTimestamp(end_time_in_ms);
+    return time_series;
+  };
+
+  // Counts are summed.
+  auto aggregated = make_time_series(1, 2000);
+  GcpMetricClientUtils::MergeTimeSeries(make_time_series(2, 1000),
+                                        /*is_count=*/true, aggregated);
+  EXPECT_EQ(aggregated.points(0).value().double_value(), 3);
+  EXPECT_EQ(TimeUtil::TimestampToMilliseconds(
+                aggregated.points(0).interval().end_time()),
+            2000);
+
+  // Other values keep the latest point.
+  aggregated = make_time_series(1, 2000);
+  GcpMetricClientUtils::MergeTimeSeries(make_time_series(2, 1000),
+                                        /*is_count=*/false, aggregated);
+  EXPECT_EQ(aggregated.points(0).value().double_value(), 1);
+  GcpMetricClientUtils::MergeTimeSeries(make_time_series(3, 3000),
+                                        /*is_count=*/false, aggregated);
+  EXPECT_EQ(aggregated.points(0).value().double_value(), 3);
+  EXPECT_EQ(TimeUtil::TimestampToMilliseconds(
+                aggregated.points(0).interval().end_time()),
+            3000);
+}
+
 }  // namespace google::scp::cpio::test
@@ -60,6 +60,20 @@ class MockNoSQLDatabaseClientProvider
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest,
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse>&)),
       (noexcept, override));
+
+  MOCK_METHOD(core::ExecutionResult, BatchGetDatabaseItems,
+              ((core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                                       BatchGetDatabaseItemsRequest,
+                                   cmrt::sdk::nosql_database_service::v1::
+                                       BatchGetDatabaseItemsResponse>&)),
+              (noexcept, override));
+
+  MOCK_METHOD(core::ExecutionResult, BatchUpsertDatabaseItems,
+              ((core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                                       BatchUpsertDatabaseItemsRequest,
+                                   cmrt::sdk::nosql_database_service::v1::
+                                       BatchUpsertDatabaseItemsResponse>&)),
+              (noexcept, override));
 };
 
 }  // namespace google::scp::cpio::client_providers::mock
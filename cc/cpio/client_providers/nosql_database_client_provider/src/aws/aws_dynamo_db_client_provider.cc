@@ -16,6 +16,8 @@
 
 #include "aws_dynamo_db_client_provider.h"
 
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,11 +26,18 @@
 #include <aws/core/Aws.h>
 #include <aws/core/utils/Outcome.h>
 #include <aws/dynamodb/model/AttributeDefinition.h>
+#include <aws/dynamodb/model/BatchGetItemRequest.h>
+#include <aws/dynamodb/model/BatchWriteItemRequest.h>
+#include <aws/dynamodb/model/KeysAndAttributes.h>
+#include <aws/dynamodb/model/PutRequest.h>
 #include <aws/dynamodb/model/QueryRequest.h>
 #include <aws/dynamodb/model/UpdateItemRequest.h>
+#include <aws/dynamodb/model/WriteRequest.h>
 
 #include "absl/strings/str_cat.h"
 #include "core/async_executor/src/aws/aws_async_executor.h"
+#include "core/common/operation_dispatcher/src/retry_strategy.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "cpio/client_providers/instance_client_provider/src/aws/aws_instance_client_utils.h"
 #include "cpio/common/src/aws/aws_utils.h"
 
@@ -42,11 +51,27 @@ using Aws::Client::ClientConfiguration;
 using Aws::DynamoDB::DynamoDBClient;
 using Aws::DynamoDB::DynamoDBError;
 using Aws::DynamoDB::Model::AttributeValue;
+using Aws::DynamoDB::Model::BatchGetItemRequest;
+using Aws::DynamoDB::Model::BatchGetItemResult;
+using Aws::DynamoDB::Model::BatchWriteItemRequest;
+using Aws::DynamoDB::Model::BatchWriteItemResult;
+using Aws::DynamoDB::Model::KeysAndAttributes;
+using Aws::DynamoDB::Model::PutRequest;
 using Aws::DynamoDB::Model::QueryRequest;
 using Aws::DynamoDB::Model::QueryResult;
 using Aws::DynamoDB::Model::UpdateItemRequest;
 using Aws::DynamoDB::Model::UpdateItemResult;
+using Aws::DynamoDB::Model::ValueType;
+using Aws::DynamoDB::Model::WriteRequest;
 using Aws::Utils::Outcome;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsResponse;
 using google::cmrt::sdk::nosql_database_service::v1::CreateTableRequest;
 using google::cmrt::sdk::nosql_database_service::v1::CreateTableResponse;
 using google::cmrt::sdk::nosql_database_service::v1::DeleteTableRequest;
@@ -59,18 +84,27 @@ using google::cmrt::sdk::nosql_database_service::v1::ItemKey;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse;
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
 using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::FinishContext;
+using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::TimeDuration;
 using google::scp::core::async_executor::aws::AwsAsyncExecutor;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::RetryStrategy;
+using google::scp::core::common::RetryStrategyType;
+using google::scp::core::common::TimeProvider;
+using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH;
 using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND;
+using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_RETRIABLE_ERROR;
 using google::scp::cpio::client_providers::AwsDynamoDBUtils;
 using google::scp::cpio::client_providers::AwsInstanceClientUtils;
 using std::bind;
+using std::make_pair;
 using std::make_shared;
 using std::move;
 using std::optional;
@@ -78,6 +112,7 @@ using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::vector;
+using std::chrono::milliseconds;
 using std::placeholders::_1;
 using std::placeholders::_2;
 using std::placeholders::_3;
@@ -88,10 +123,112 @@ namespace {
 constexpr size_t kExpressionsInitialByteSize = 1024;
 constexpr char kDynamoDB[] = "DynamoDB";
 constexpr size_t kMaxConcurrentConnections = 1000;
+constexpr size_t kMaxBatchGetItemKeys = 100;
+constexpr size_t kMaxBatchWriteItemRequests = 25;
+// The number of times the items DynamoDB leaves unprocessed are sent again.
+constexpr size_t kMaxBatchRetryCount = 5;
+constexpr TimeDuration kBatchRetryDelayMs = 50;
 
 }  // namespace
 
 namespace google::scp::cpio::client_providers {
+namespace {
+// Appends a length prefixed component to the key of an item, so that different
+// key values can never make the same item key.
+void AppendItemKeyComponent(const String& component, String& item_key) {
+  item_key += std::to_string(component.length()).c_str();
+  item_key += ":";
+  item_key += component;
+}
+
+// Returns the key identifying an item by its table and its key attributes.
+String GetItemKey(const String& table_name,
+                  const AttributeValue& partition_key_value,
+                  const AttributeValue* sort_key_value) {
+  auto get_value_key = [](const AttributeValue& attribute_value) {
+    if (attribute_value.GetType() == ValueType::NUMBER) {
+      return "N" + attribute_value.GetN();
+    }
+    return "S" + attribute_value.GetS();
+  };
+
+  String item_key;
+  AppendItemKeyComponent(table_name, item_key);
+  AppendItemKeyComponent(get_value_key(partition_key_value), item_key);
+  if (sort_key_value) {
+    AppendItemKeyComponent(get_value_key(*sort_key_value), item_key);
+  }
+  return item_key;
+}
+
+// Returns the key identifying a DynamoDB item of a table, or nothing if the
+// item does not carry the key attributes of the table.
+optional<String> GetItemKey(const String& table_name,
+                            const Map<String, AttributeValue>& item,
+                            const pair<String, optional<String>>& key_names) {
+  auto partition_key = item.find(key_names.first);
+  if (partition_key == item.end()) {
+    return std::nullopt;
+  }
+
+  const AttributeValue* sort_key_value = nullptr;
+  if (key_names.second) {
+    auto sort_key = item.find(*key_names.second);
+    if (sort_key == item.end()) {
+      return std::nullopt;
+    }
+    sort_key_value = &sort_key->second;
+  }
+  return GetItemKey(table_name, partition_key->second, sort_key_value);
+}
+
+// Converts the attributes of a DynamoDB item, but the key ones, into item.
+ExecutionResult ConvertDynamoDBItem(
+    const ItemKey& key, const Map<String, AttributeValue>& dynamo_db_item,
+    Item& item) {
+  item.mutable_key()->CopyFrom(key);
+  for (const auto& attribute_key_value_pair : dynamo_db_item) {
+    // If the attribute is the partition or sort key, skip it.
+    if (strcmp(attribute_key_value_pair.first.c_str(),
+               key.partition_key().name().c_str()) == 0 ||
+        (key.has_sort_key() &&
+         strcmp(attribute_key_value_pair.first.c_str(),
+                key.sort_key().name().c_str()) == 0)) {
+      continue;
+    }
+
+    auto attribute_or = AwsDynamoDBUtils::ConvertDynamoDBTypeToItemAttribute(
+        attribute_key_value_pair.second);
+    if (!attribute_or.Successful()) {
+      return attribute_or.result();
+    }
+
+    attribute_or->set_name(attribute_key_value_pair.first.data(),
+                           attribute_key_value_pair.first.size());
+    *item.add_attributes() = move(*attribute_or);
+  }
+  return SuccessExecutionResult();
+}
+
+// Returns the indices of the requests of a batch asking for item of
+// table_name, or nullptr if no request does.
+const vector<size_t>* FindRequestIndices(
+    const Map<String, vector<size_t>>& request_indices,
+    const Map<String, pair<String, optional<String>>>& table_key_names,
+    const String& table_name, const Map<String, AttributeValue>& item) {
+  auto key_names = table_key_names.find(table_name);
+  if (key_names == table_key_names.end()) {
+    return nullptr;
+  }
+  auto item_key = GetItemKey(table_name, item, key_names->second);
+  if (!item_key) {
+    return nullptr;
+  }
+  auto indices = request_indices.find(*item_key);
+  return indices == request_indices.end() ? nullptr : &indices->second;
+}
+}  // namespace
+
 ExecutionResultOr<ClientConfiguration>
 AwsDynamoDBClientProvider::CreateClientConfig() noexcept {
   ClientConfiguration client_config;
@@ -161,9 +298,10 @@ ExecutionResult AwsDynamoDBClientProvider::GetDatabaseItem(
   // Set the table name
   const auto& request_table_name = request.key().table_name();
   String table_name(request_table_name.c_str(), request_table_name.size());
-  get_item_request.SetTableName(table_name);
+  get_item_request.SetTableName(move(table_name));
 
-  const auto key_container_or =
+  // Not const, the key values are moved into the request.
+  auto key_container_or =
       AwsDynamoDBUtils::GetPartitionAndSortKeyValues(get_database_item_context);
   if (!key_container_or.Successful()) {
     get_database_item_context.result = key_container_or.result();
@@ -188,7 +326,7 @@ ExecutionResult AwsDynamoDBClientProvider::GetDatabaseItem(
     attribute_values.emplace(":sort_key",
                              move(*key_container_or->sort_key_val));
   }
-  get_item_request.SetKeyConditionExpression(condition_expression);
+  get_item_request.SetKeyConditionExpression(move(condition_expression));
 
   // Set the filter expression
   if (!request.required_attributes().empty()) {
@@ -233,7 +371,7 @@ void AwsDynamoDBClientProvider::OnGetDatabaseItemCallback(
   const auto& request = *get_database_item_context.request;
   const auto& request_table_name = request.key().table_name();
 
-  auto items = outcome.GetResult().GetItems();
+  const auto& items = outcome.GetResult().GetItems();
   if (items.size() != 1) {
     auto result =
         FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
@@ -244,41 +382,17 @@ void AwsDynamoDBClientProvider::OnGetDatabaseItemCallback(
     FinishContext(result, get_database_item_context, cpu_async_executor_);
     return;
   }
-  const auto& item = items[0];
-  const String partition_key_name(request.key().partition_key().name().c_str(),
-                                  request.key().partition_key().name().size());
-
   get_database_item_context.response = make_shared<GetDatabaseItemResponse>();
-  get_database_item_context.response->mutable_item()->mutable_key()->CopyFrom(
-      request.key());
-
-  for (const auto& attribute_key_value_pair : item) {
-    // If the attribute is the partition or sort key, skip it.
-    if (strcmp(attribute_key_value_pair.first.c_str(),
-               request.key().partition_key().name().c_str()) == 0 ||
-        (request.key().has_sort_key() &&
-         strcmp(attribute_key_value_pair.first.c_str(),
-                request.key().sort_key().name().c_str()) == 0)) {
-      continue;
-    }
-
-    auto attribute_or = AwsDynamoDBUtils::ConvertDynamoDBTypeToItemAttribute(
-        attribute_key_value_pair.second);
-
-    if (!attribute_or.Successful()) {
-      SCP_ERROR_CONTEXT(kDynamoDB, get_database_item_context,
-                        attribute_or.result(),
-                        "Error converting returned DynamoDB attribute to "
-                        "ItemAttribute for table %s",
-                        request_table_name.c_str());
-      FinishContext(attribute_or.result(), get_database_item_context,
-                    cpu_async_executor_);
-      return;
-    }
-
-    attribute_or->set_name(attribute_key_value_pair.first.c_str());
-    *get_database_item_context.response->mutable_item()->add_attributes() =
-        move(*attribute_or);
+  auto result = ConvertDynamoDBItem(
+      request.key(), items[0],
+      *get_database_item_context.response->mutable_item());
+  if (!result.Successful()) {
+    SCP_ERROR_CONTEXT(kDynamoDB, get_database_item_context, result,
+                      "Error converting returned DynamoDB attribute to "
+                      "ItemAttribute for table %s",
+                      request_table_name.c_str());
+    FinishContext(result, get_database_item_context, cpu_async_executor_);
+    return;
   }
 
   FinishContext(SuccessExecutionResult(), get_database_item_context,
@@ -291,11 +405,11 @@ ExecutionResult AwsDynamoDBClientProvider::UpsertDatabaseItem(
   const auto& request = *upsert_database_item_context.request;
   UpdateItemRequest update_item_request;
   // Set the table name
-  const String table_name(request.key().table_name().c_str(),
-                          request.key().table_name().size());
-  update_item_request.SetTableName(table_name);
+  update_item_request.SetTableName(String(request.key().table_name().c_str(),
+                                          request.key().table_name().size()));
 
-  const auto key_container_or = AwsDynamoDBUtils::GetPartitionAndSortKeyValues(
+  // Not const, the key values are moved into the request.
+  auto key_container_or = AwsDynamoDBUtils::GetPartitionAndSortKeyValues(
       upsert_database_item_context);
   if (!key_container_or.Successful()) {
     upsert_database_item_context.result = key_container_or.result();
@@ -348,7 +462,7 @@ ExecutionResult AwsDynamoDBClientProvider::UpsertDatabaseItem(
         update_expression += " , ";
       }
     }
-    update_item_request.SetUpdateExpression(update_expression);
+    update_item_request.SetUpdateExpression(move(update_expression));
   }
 
   // Set the condition expression
@@ -364,7 +478,7 @@ ExecutionResult AwsDynamoDBClientProvider::UpsertDatabaseItem(
     update_item_request.SetConditionExpression(move(*condition_expression_or));
   }
 
-  update_item_request.SetExpressionAttributeValues(attribute_values);
+  update_item_request.SetExpressionAttributeValues(move(attribute_values));
 
   dynamo_db_client_->UpdateItemAsync(
       update_item_request,
@@ -396,6 +510,430 @@ void AwsDynamoDBClientProvider::OnUpsertDatabaseItemCallback(
   FinishContext(result, upsert_database_item_context, cpu_async_executor_);
 }
 
+ExecutionResult AwsDynamoDBClientProvider::BatchGetDatabaseItems(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  const auto& requests = batch_get_database_items_context.request->requests();
+  if (requests.empty() || requests.size() > kMaxBatchGetItemKeys) {
+    auto result =
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH);
+    SCP_ERROR_CONTEXT(kDynamoDB, batch_get_database_items_context, result,
+                      "Batch get database items request has %d items",
+                      requests.size());
+    batch_get_database_items_context.result = result;
+    batch_get_database_items_context.Finish();
+    return result;
+  }
+
+  // DynamoDB rejects the requests with repeated keys, so every key is only
+  // requested once and its item is returned to all the lookups asking for it.
+  auto batch_item_keys = make_shared<BatchItemKeys>();
+  Map<String, KeysAndAttributes> request_items;
+  for (size_t request_index = 0; request_index < requests.size();
+       ++request_index) {
+    const auto& request = requests[request_index];
+    if (!request.required_attributes().empty()) {
+      auto result =
+          FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH);
+      SCP_ERROR_CONTEXT(kDynamoDB, batch_get_database_items_context, result,
+                        "Batch get database items request has required "
+                        "attributes for table %s",
+                        request.key().table_name().c_str());
+      batch_get_database_items_context.result = result;
+      batch_get_database_items_context.Finish();
+      return result;
+    }
+
+    auto key_container_or = AwsDynamoDBUtils::GetPartitionAndSortKeyValues(
+        batch_get_database_items_context, request.key());
+    if (!key_container_or.Successful()) {
+      batch_get_database_items_context.result = key_container_or.result();
+      batch_get_database_items_context.Finish();
+      return key_container_or.result();
+    }
+
+    const String table_name(request.key().table_name().c_str(),
+                            request.key().table_name().size());
+    batch_item_keys->table_key_names.emplace(
+        table_name, make_pair(key_container_or->partition_key_name,
+                              key_container_or->sort_key_name));
+    auto& request_indices =
+        batch_item_keys->request_indices[GetItemKey(
+            table_name, key_container_or->partition_key_val,
+            key_container_or->sort_key_val
+                ? &*key_container_or->sort_key_val
+                : nullptr)];
+    request_indices.push_back(request_index);
+    if (request_indices.size() > 1) {
+      continue;
+    }
+
+    Map<String, AttributeValue> key;
+    key.emplace(move(key_container_or->partition_key_name),
+                move(key_container_or->partition_key_val));
+    // Sort key is optional
+    if (key_container_or->sort_key_name.has_value()) {
+      key.emplace(move(*key_container_or->sort_key_name),
+                  move(*key_container_or->sort_key_val));
+    }
+    request_items[table_name].AddKeys(move(key));
+  }
+
+  // The items not returned by any response are not in the table.
+  batch_get_database_items_context.response =
+      make_shared<BatchGetDatabaseItemsResponse>();
+  for (size_t request_index = 0; request_index < requests.size();
+       ++request_index) {
+    *batch_get_database_items_context.response->add_responses()
+         ->mutable_result() =
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)
+            .ToProto();
+  }
+
+  SendBatchGetItemRequest(batch_get_database_items_context, batch_item_keys,
+                          request_items, 0 /* retry_count */);
+  return SuccessExecutionResult();
+}
+
+void AwsDynamoDBClientProvider::SendBatchGetItemRequest(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context,
+    const shared_ptr<BatchItemKeys>& batch_item_keys,
+    const Map<String, KeysAndAttributes>& request_items,
+    size_t retry_count) noexcept {
+  BatchGetItemRequest batch_get_item_request;
+  batch_get_item_request.SetRequestItems(request_items);
+
+  dynamo_db_client_->BatchGetItemAsync(
+      batch_get_item_request,
+      bind(&AwsDynamoDBClientProvider::OnBatchGetItemCallback, this,
+           batch_get_database_items_context, batch_item_keys, retry_count, _1,
+           _2, _3, _4),
+      nullptr);
+}
+
+void AwsDynamoDBClientProvider::OnBatchGetItemCallback(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context,
+    const shared_ptr<BatchItemKeys>& batch_item_keys, size_t retry_count,
+    const DynamoDBClient* dynamo_db_client,
+    const BatchGetItemRequest& batch_get_item_request,
+    const Outcome<BatchGetItemResult, DynamoDBError>& outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  const auto& requests = batch_get_database_items_context.request->requests();
+  auto& responses =
+      *batch_get_database_items_context.response->mutable_responses();
+  auto set_results = [&](const Map<String, KeysAndAttributes>& request_items,
+                         ExecutionResult result) {
+    for (const auto& [table_name, keys_and_attributes] : request_items) {
+      for (const auto& key : keys_and_attributes.GetKeys()) {
+        const auto* request_indices = FindRequestIndices(
+            batch_item_keys->request_indices, batch_item_keys->table_key_names,
+            table_name, key);
+        if (!request_indices) {
+          continue;
+        }
+        for (auto request_index : *request_indices) {
+          *responses.Mutable(request_index)->mutable_result() =
+              result.ToProto();
+        }
+      }
+    }
+  };
+
+  if (!outcome.IsSuccess()) {
+    auto result = AwsDynamoDBUtils::ConvertDynamoErrorToExecutionResult(
+        outcome.GetError().GetErrorType());
+    SCP_ERROR_CONTEXT(kDynamoDB, batch_get_database_items_context, result,
+                      "Batch get database items request failed. Error code: "
+                      "%d, message: %s",
+                      outcome.GetError().GetResponseCode(),
+                      outcome.GetError().GetMessage().c_str());
+    if (retry_count == 0) {
+      FinishContext(result, batch_get_database_items_context,
+                    cpu_async_executor_);
+      return;
+    }
+    // The items of the previous requests are settled already.
+    set_results(batch_get_item_request.GetRequestItems(), result);
+    FinishContext(SuccessExecutionResult(), batch_get_database_items_context,
+                  cpu_async_executor_);
+    return;
+  }
+
+  for (const auto& [table_name, table_items] :
+       outcome.GetResult().GetResponses()) {
+    for (const auto& table_item : table_items) {
+      const auto* request_indices = FindRequestIndices(
+          batch_item_keys->request_indices, batch_item_keys->table_key_names,
+          table_name, table_item);
+      if (!request_indices) {
+        continue;
+      }
+      for (auto request_index : *request_indices) {
+        auto& response = *responses.Mutable(request_index);
+        auto result = ConvertDynamoDBItem(requests[request_index].key(),
+                                          table_item, *response.mutable_item());
+        if (!result.Successful()) {
+          SCP_ERROR_CONTEXT(kDynamoDB, batch_get_database_items_context,
+                            result,
+                            "Error converting returned DynamoDB attribute to "
+                            "ItemAttribute for table %s",
+                            table_name.c_str());
+          response.clear_item();
+        }
+        *response.mutable_result() = result.ToProto();
+      }
+    }
+  }
+
+  const auto& unprocessed_keys = outcome.GetResult().GetUnprocessedKeys();
+  if (unprocessed_keys.empty()) {
+    FinishContext(SuccessExecutionResult(), batch_get_database_items_context,
+                  cpu_async_executor_);
+    return;
+  }
+
+  if (retry_count < kMaxBatchRetryCount) {
+    auto execution_result = ScheduleBatchRetry(
+        [this, batch_get_database_items_context, batch_item_keys,
+         unprocessed_keys, retry_count]() mutable {
+          SendBatchGetItemRequest(batch_get_database_items_context,
+                                  batch_item_keys, unprocessed_keys,
+                                  retry_count + 1);
+        },
+        retry_count + 1);
+    if (execution_result.Successful()) {
+      return;
+    }
+  }
+
+  auto result =
+      RetryExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_RETRIABLE_ERROR);
+  SCP_ERROR_CONTEXT(kDynamoDB, batch_get_database_items_context, result,
+                    "Batch get database items request left %d tables "
+                    "unprocessed after %d retries",
+                    unprocessed_keys.size(), retry_count);
+  set_results(unprocessed_keys, result);
+  FinishContext(SuccessExecutionResult(), batch_get_database_items_context,
+                cpu_async_executor_);
+}
+
+ExecutionResult AwsDynamoDBClientProvider::BatchUpsertDatabaseItems(
+    AsyncContext<BatchUpsertDatabaseItemsRequest,
+                 BatchUpsertDatabaseItemsResponse>&
+        batch_upsert_database_items_context) noexcept {
+  const auto& requests =
+      batch_upsert_database_items_context.request->requests();
+  auto fail_batch = [&](const char* reason, const string& table_name) {
+    auto result =
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH);
+    SCP_ERROR_CONTEXT(kDynamoDB, batch_upsert_database_items_context, result,
+                      "Invalid batch upsert database items request: %s %s",
+                      reason, table_name.c_str());
+    batch_upsert_database_items_context.result = result;
+    batch_upsert_database_items_context.Finish();
+    return result;
+  };
+  if (requests.empty() || requests.size() > kMaxBatchWriteItemRequests) {
+    return fail_batch("empty or too many items", "");
+  }
+
+  auto batch_item_keys = make_shared<BatchItemKeys>();
+  Map<String, Aws::Vector<WriteRequest>> request_items;
+  for (size_t request_index = 0; request_index < requests.size();
+       ++request_index) {
+    const auto& request = requests[request_index];
+    if (!request.required_attributes().empty()) {
+      return fail_batch("required attributes for table",
+                        request.key().table_name());
+    }
+
+    auto key_container_or = AwsDynamoDBUtils::GetPartitionAndSortKeyValues(
+        batch_upsert_database_items_context, request.key());
+    if (!key_container_or.Successful()) {
+      batch_upsert_database_items_context.result = key_container_or.result();
+      batch_upsert_database_items_context.Finish();
+      return key_container_or.result();
+    }
+
+    // DynamoDB rejects the requests with repeated keys, and the order of
+    // their writes would be undefined anyway.
+    const String table_name(request.key().table_name().c_str(),
+                            request.key().table_name().size());
+    batch_item_keys->table_key_names.emplace(
+        table_name, make_pair(key_container_or->partition_key_name,
+                              key_container_or->sort_key_name));
+    auto& request_indices =
+        batch_item_keys->request_indices[GetItemKey(
+            table_name, key_container_or->partition_key_val,
+            key_container_or->sort_key_val
+                ? &*key_container_or->sort_key_val
+                : nullptr)];
+    if (!request_indices.empty()) {
+      return fail_batch("repeated item for table", request.key().table_name());
+    }
+    request_indices.push_back(request_index);
+
+    Map<String, AttributeValue> item;
+    for (const auto& new_attribute : request.new_attributes()) {
+      auto attribute_value_or =
+          AwsDynamoDBUtils::ConvertItemAttributeToDynamoDBType(new_attribute);
+      if (!attribute_value_or.Successful()) {
+        batch_upsert_database_items_context.result =
+            attribute_value_or.result();
+        SCP_ERROR_CONTEXT(kDynamoDB, batch_upsert_database_items_context,
+                          attribute_value_or.result(),
+                          "Error converting ItemAttribute type for table %s",
+                          request.key().table_name().c_str());
+        batch_upsert_database_items_context.Finish();
+        return attribute_value_or.result();
+      }
+      item[String(new_attribute.name().c_str(), new_attribute.name().size())] =
+          move(*attribute_value_or);
+    }
+    item[move(key_container_or->partition_key_name)] =
+        move(key_container_or->partition_key_val);
+    // Sort key is optional
+    if (key_container_or->sort_key_name.has_value()) {
+      item[move(*key_container_or->sort_key_name)] =
+          move(*key_container_or->sort_key_val);
+    }
+
+    PutRequest put_request;
+    put_request.SetItem(move(item));
+    WriteRequest write_request;
+    write_request.SetPutRequest(move(put_request));
+    request_items[table_name].push_back(move(write_request));
+  }
+
+  // The items not returned as unprocessed are written.
+  batch_upsert_database_items_context.response =
+      make_shared<BatchUpsertDatabaseItemsResponse>();
+  for (size_t request_index = 0; request_index < requests.size();
+       ++request_index) {
+    *batch_upsert_database_items_context.response->add_responses()
+         ->mutable_result() = SuccessExecutionResult().ToProto();
+  }
+
+  SendBatchWriteItemRequest(batch_upsert_database_items_context,
+                            batch_item_keys, request_items,
+                            0 /* retry_count */);
+  return SuccessExecutionResult();
+}
+
+void AwsDynamoDBClientProvider::SendBatchWriteItemRequest(
+    AsyncContext<BatchUpsertDatabaseItemsRequest,
+                 BatchUpsertDatabaseItemsResponse>&
+        batch_upsert_database_items_context,
+    const shared_ptr<BatchItemKeys>& batch_item_keys,
+    const Map<String, Aws::Vector<WriteRequest>>& request_items,
+    size_t retry_count) noexcept {
+  BatchWriteItemRequest batch_write_item_request;
+  batch_write_item_request.SetRequestItems(request_items);
+
+  dynamo_db_client_->BatchWriteItemAsync(
+      batch_write_item_request,
+      bind(&AwsDynamoDBClientProvider::OnBatchWriteItemCallback, this,
+           batch_upsert_database_items_context, batch_item_keys, retry_count,
+           _1, _2, _3, _4),
+      nullptr);
+}
+
+void AwsDynamoDBClientProvider::OnBatchWriteItemCallback(
+    AsyncContext<BatchUpsertDatabaseItemsRequest,
+                 BatchUpsertDatabaseItemsResponse>&
+        batch_upsert_database_items_context,
+    const shared_ptr<BatchItemKeys>& batch_item_keys, size_t retry_count,
+    const DynamoDBClient* dynamo_db_client,
+    const BatchWriteItemRequest& batch_write_item_request,
+    const Outcome<BatchWriteItemResult, DynamoDBError>& outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  auto& responses =
+      *batch_upsert_database_items_context.response->mutable_responses();
+  auto set_results =
+      [&](const Map<String, Aws::Vector<WriteRequest>>& request_items,
+          ExecutionResult result) {
+        for (const auto& [table_name, write_requests] : request_items) {
+          for (const auto& write_request : write_requests) {
+            const auto* request_indices = FindRequestIndices(
+                batch_item_keys->request_indices,
+                batch_item_keys->table_key_names, table_name,
+                write_request.GetPutRequest().GetItem());
+            if (!request_indices) {
+              continue;
+            }
+            for (auto request_index : *request_indices) {
+              *responses.Mutable(request_index)->mutable_result() =
+                  result.ToProto();
+            }
+          }
+        }
+      };
+
+  if (!outcome.IsSuccess()) {
+    auto result = AwsDynamoDBUtils::ConvertDynamoErrorToExecutionResult(
+        outcome.GetError().GetErrorType());
+    SCP_ERROR_CONTEXT(kDynamoDB, batch_upsert_database_items_context, result,
+                      "Batch upsert database items request failed. Error "
+                      "code: %d, message: %s",
+                      outcome.GetError().GetResponseCode(),
+                      outcome.GetError().GetMessage().c_str());
+    if (retry_count == 0) {
+      FinishContext(result, batch_upsert_database_items_context,
+                    cpu_async_executor_);
+      return;
+    }
+    // The items of the previous requests are written already.
+    set_results(batch_write_item_request.GetRequestItems(), result);
+    FinishContext(SuccessExecutionResult(),
+                  batch_upsert_database_items_context, cpu_async_executor_);
+    return;
+  }
+
+  const auto& unprocessed_items = outcome.GetResult().GetUnprocessedItems();
+  if (unprocessed_items.empty()) {
+    FinishContext(SuccessExecutionResult(),
+                  batch_upsert_database_items_context, cpu_async_executor_);
+    return;
+  }
+
+  if (retry_count < kMaxBatchRetryCount) {
+    auto execution_result = ScheduleBatchRetry(
+        [this, batch_upsert_database_items_context, batch_item_keys,
+         unprocessed_items, retry_count]() mutable {
+          SendBatchWriteItemRequest(batch_upsert_database_items_context,
+                                    batch_item_keys, unprocessed_items,
+                                    retry_count + 1);
+        },
+        retry_count + 1);
+    if (execution_result.Successful()) {
+      return;
+    }
+  }
+
+  auto result =
+      RetryExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_RETRIABLE_ERROR);
+  SCP_ERROR_CONTEXT(kDynamoDB, batch_upsert_database_items_context, result,
+                    "Batch upsert database items request left %d tables "
+                    "unprocessed after %d retries",
+                    unprocessed_items.size(), retry_count);
+  set_results(unprocessed_items, result);
+  FinishContext(SuccessExecutionResult(), batch_upsert_database_items_context,
+                cpu_async_executor_);
+}
+
+ExecutionResult AwsDynamoDBClientProvider::ScheduleBatchRetry(
+    const AsyncOperation& retry, size_t retry_count) noexcept {
+  RetryStrategy retry_strategy(RetryStrategyType::Exponential,
+                               kBatchRetryDelayMs, kMaxBatchRetryCount);
+  return cpu_async_executor_->ScheduleFor(
+      retry, (TimeProvider::GetSteadyTimestampInNanoseconds() +
+              milliseconds(retry_strategy.GetBackOffDurationInMilliseconds(
+                  retry_count)))
+                 .count());
+}
+
 ExecutionResultOr<shared_ptr<DynamoDBClient>> DynamoDBFactory::CreateClient(
     const ClientConfiguration& client_config) noexcept {
   return make_shared<DynamoDBClient>(client_config);
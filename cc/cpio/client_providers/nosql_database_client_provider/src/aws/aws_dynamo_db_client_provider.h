@@ -17,12 +17,17 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <aws/core/Aws.h>
 #include <aws/dynamodb/DynamoDBClient.h>
 #include <aws/dynamodb/model/AttributeDefinition.h>
+#include <aws/dynamodb/model/BatchGetItemRequest.h>
+#include <aws/dynamodb/model/BatchWriteItemRequest.h>
 #include <aws/dynamodb/model/QueryRequest.h>
 #include <aws/dynamodb/model/UpdateItemRequest.h>
 
@@ -79,7 +84,142 @@ class AwsDynamoDBClientProvider : public NoSQLDatabaseClientProviderInterface {
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse>&
           upsert_database_item_context) noexcept override;
 
+  /**
+   * @brief Gets the items with BatchGetItem. The keys DynamoDB leaves
+   * unprocessed are requested again with an exponential back off, and the ones
+   * still unprocessed after the last retry get a retriable result.
+   */
+  core::ExecutionResult BatchGetDatabaseItems(
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept override;
+
+  /**
+   * @brief Puts the items with BatchWriteItem. The items DynamoDB leaves
+   * unprocessed are written again with an exponential back off, and the ones
+   * still unprocessed after the last retry get a retriable result.
+   */
+  core::ExecutionResult BatchUpsertDatabaseItems(
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>&
+          batch_upsert_database_items_context) noexcept override;
+
  private:
+  /// Matches the items DynamoDB returns with the requests of a batch.
+  struct BatchItemKeys {
+    /// The indices of the requests of every item, by item key.
+    Aws::Map<Aws::String, std::vector<size_t>> request_indices;
+    /// The partition and optional sort key names of every table.
+    Aws::Map<Aws::String, std::pair<Aws::String, std::optional<Aws::String>>>
+        table_key_names;
+  };
+
+  /**
+   * @brief Sends a BatchGetItem request for request_items.
+   *
+   * @param batch_get_database_items_context The context object of the batch
+   * get database items operation.
+   * @param batch_item_keys The keys of the items of the batch.
+   * @param request_items The keys to get, by table.
+   * @param retry_count The number of BatchGetItem requests sent before.
+   */
+  void SendBatchGetItemRequest(
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context,
+      const std::shared_ptr<BatchItemKeys>& batch_item_keys,
+      const Aws::Map<Aws::String, Aws::DynamoDB::Model::KeysAndAttributes>&
+          request_items,
+      size_t retry_count) noexcept;
+
+  /**
+   * @brief Is called when the response of a BatchGetItem request is ready.
+   *
+   * @param batch_get_database_items_context The context object of the batch
+   * get database items operation.
+   * @param batch_item_keys The keys of the items of the batch.
+   * @param retry_count The number of BatchGetItem requests sent before.
+   * @param dynamo_db_client An instance of the dynamo db client.
+   * @param batch_get_item_request The batch get item request object.
+   * @param outcome The outcome of the operation.
+   * @param async_context The async context of the sender. This is not used
+   * based on SCP architecture.
+   */
+  void OnBatchGetItemCallback(
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context,
+      const std::shared_ptr<BatchItemKeys>& batch_item_keys, size_t retry_count,
+      const Aws::DynamoDB::DynamoDBClient* dynamo_db_client,
+      const Aws::DynamoDB::Model::BatchGetItemRequest& batch_get_item_request,
+      const Aws::Utils::Outcome<Aws::DynamoDB::Model::BatchGetItemResult,
+                                Aws::DynamoDB::DynamoDBError>& outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /**
+   * @brief Sends a BatchWriteItem request for request_items.
+   *
+   * @param batch_upsert_database_items_context The context object of the batch
+   * upsert database items operation.
+   * @param batch_item_keys The keys of the items of the batch.
+   * @param request_items The items to put, by table.
+   * @param retry_count The number of BatchWriteItem requests sent before.
+   */
+  void SendBatchWriteItemRequest(
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>&
+          batch_upsert_database_items_context,
+      const std::shared_ptr<BatchItemKeys>& batch_item_keys,
+      const Aws::Map<Aws::String,
+                     Aws::Vector<Aws::DynamoDB::Model::WriteRequest>>&
+          request_items,
+      size_t retry_count) noexcept;
+
+  /**
+   * @brief Is called when the response of a BatchWriteItem request is ready.
+   *
+   * @param batch_upsert_database_items_context The context object of the batch
+   * upsert database items operation.
+   * @param batch_item_keys The keys of the items of the batch.
+   * @param retry_count The number of BatchWriteItem requests sent before.
+   * @param dynamo_db_client An instance of the dynamo db client.
+   * @param batch_write_item_request The batch write item request object.
+   * @param outcome The outcome of the operation.
+   * @param async_context The async context of the sender. This is not used
+   * based on SCP architecture.
+   */
+  void OnBatchWriteItemCallback(
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>&
+          batch_upsert_database_items_context,
+      const std::shared_ptr<BatchItemKeys>& batch_item_keys, size_t retry_count,
+      const Aws::DynamoDB::DynamoDBClient* dynamo_db_client,
+      const Aws::DynamoDB::Model::BatchWriteItemRequest&
+          batch_write_item_request,
+      const Aws::Utils::Outcome<Aws::DynamoDB::Model::BatchWriteItemResult,
+                                Aws::DynamoDB::DynamoDBError>& outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /**
+   * @brief Runs retry after the back off of the retry_count-th retry of a
+   * batch.
+   *
+   * @return ExecutionResult The result of the scheduling.
+   */
+  core::ExecutionResult ScheduleBatchRetry(
+      const core::AsyncOperation& retry, size_t retry_count) noexcept;
+
   /// Creates ClientConfig to create DynamoDbClient.
   core::ExecutionResultOr<Aws::Client::ClientConfiguration>
   CreateClientConfig() noexcept;
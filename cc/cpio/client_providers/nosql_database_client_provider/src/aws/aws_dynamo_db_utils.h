@@ -122,9 +122,9 @@ class AwsDynamoDBUtils {
         return *int_or;
       }
       if (source_type == Aws::DynamoDB::Model::ValueType::STRING) {
-        Aws::String str = attribute_value.GetS();
+        const Aws::String& str = attribute_value.GetS();
         cmrt::sdk::nosql_database_service::v1::ItemAttribute item_attribute;
-        item_attribute.set_value_string(str.c_str());
+        item_attribute.set_value_string(str.data(), str.size());
         return item_attribute;
       }
     } catch (...) {}
@@ -217,33 +217,47 @@ class AwsDynamoDBUtils {
   template <typename Context>
   static core::ExecutionResultOr<AwsKeyContainer> GetPartitionAndSortKeyValues(
       const Context& context) {
-    const auto& request = *context.request;
-    const auto& request_part_key_name = request.key().partition_key().name();
+    return GetPartitionAndSortKeyValues(context, context.request->key());
+  }
+
+  /**
+   * @brief Get the partition and sort key names and values from key.
+   *
+   * @tparam Context the AsyncContext the key is for, used for logging.
+   * @param context The context key is for.
+   * @param key The key to process.
+   * @return ExecutionResultOr<AwsKeyContainer> The collection of keys parsed
+   * from key.
+   */
+  template <typename Context>
+  static core::ExecutionResultOr<AwsKeyContainer> GetPartitionAndSortKeyValues(
+      const Context& context,
+      const cmrt::sdk::nosql_database_service::v1::ItemKey& key) {
+    const auto& request_part_key_name = key.partition_key().name();
     AwsKeyContainer key_container;
     key_container.partition_key_name = Aws::String(
         request_part_key_name.c_str(), request_part_key_name.size());
     auto part_key_val_or =
-        ConvertItemAttributeToDynamoDBType(request.key().partition_key());
+        ConvertItemAttributeToDynamoDBType(key.partition_key());
     if (!part_key_val_or.Successful()) {
       SCP_ERROR_CONTEXT(kDynamoDbUtils, context, part_key_val_or.result(),
                         "Error converting partition key type for table %s",
-                        request.key().table_name().c_str());
+                        key.table_name().c_str());
       return part_key_val_or.result();
     }
     key_container.partition_key_val = std::move(*part_key_val_or);
 
     // Sort key is optional
-    if (request.key().has_sort_key()) {
+    if (key.has_sort_key()) {
       // Set the sort key
-      const auto& request_sort_key_name = request.key().sort_key().name();
+      const auto& request_sort_key_name = key.sort_key().name();
       key_container.sort_key_name = Aws::String(request_sort_key_name.c_str(),
                                                 request_sort_key_name.size());
-      auto sort_key_val_or =
-          ConvertItemAttributeToDynamoDBType(request.key().sort_key());
+      auto sort_key_val_or = ConvertItemAttributeToDynamoDBType(key.sort_key());
       if (!sort_key_val_or.Successful()) {
         SCP_ERROR_CONTEXT(kDynamoDbUtils, context, sort_key_val_or.result(),
                           "Error converting sort key type for table %s",
-                          request.key().table_name().c_str());
+                          key.table_name().c_str());
         return sort_key_val_or.result();
       }
       key_container.sort_key_val = std::move(*sort_key_val_or);
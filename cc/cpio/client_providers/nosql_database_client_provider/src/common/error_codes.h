@@ -82,6 +82,18 @@ DEFINE_ERROR_CODE(
     "Failed to write to database due to conditional checked failed.",
     HttpStatusCode::BAD_REQUEST)
 
+DEFINE_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH,
+                  SC_NO_SQL_DATABASE_PROVIDER, 0x000D,
+                  "NoSQL Database batch is empty, too large or has repeated "
+                  "or conditional items.",
+                  HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_REPLACE,
+                  SC_NO_SQL_DATABASE_PROVIDER, 0x000E,
+                  "NoSQL Database upsert replacing the existing attributes "
+                  "cannot have required attributes.",
+                  HttpStatusCode::BAD_REQUEST)
+
 MAP_TO_PUBLIC_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_TABLE_NOT_FOUND,
                          SC_CPIO_CLOUD_NOT_FOUND)
 MAP_TO_PUBLIC_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND,
@@ -106,4 +118,8 @@ MAP_TO_PUBLIC_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_UNSET_KEY_TYPE,
                          SC_CPIO_CLOUD_INVALID_ARGUMENT)
 MAP_TO_PUBLIC_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_CHECKED_FAILED,
                          SC_CPIO_CLOUD_INVALID_ARGUMENT)
+MAP_TO_PUBLIC_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH,
+                         SC_CPIO_CLOUD_INVALID_ARGUMENT)
+MAP_TO_PUBLIC_ERROR_CODE(SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_REPLACE,
+                         SC_CPIO_CLOUD_INVALID_ARGUMENT)
 }  // namespace google::scp::core::errors
@@ -16,12 +16,14 @@
 
 #include "gcp_spanner_client_provider.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <google/protobuf/util/message_differencer.h>
 #include <nlohmann/json.hpp>
 
 #include "absl/strings/str_cat.h"
@@ -31,12 +33,14 @@
 #include "cpio/client_providers/instance_client_provider/src/gcp/gcp_instance_client_utils.h"
 #include "cpio/client_providers/nosql_database_client_provider/src/common/error_codes.h"
 #include "cpio/common/src/gcp/gcp_utils.h"
+#include "cpio/common/src/gcp/spanner_connection_options.h"
 #include "public/cpio/proto/nosql_database_service/v1/nosql_database_service.pb.h"
 
 #include "gcp_spanner_utils.h"
 
 using google::cloud::StatusOr;
 using google::cloud::spanner::Client;
+using google::cloud::spanner::CommitResult;
 using google::cloud::spanner::Database;
 using google::cloud::spanner::MakeConnection;
 using google::cloud::spanner::MakeInsertOrUpdateMutation;
@@ -48,6 +52,14 @@ using google::cloud::spanner::Transaction;
 using google::cloud::spanner::Value;
 using google::cloud::spanner_admin::DatabaseAdminClient;
 using google::cloud::spanner_admin::MakeDatabaseAdminConnection;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsResponse;
 using google::cmrt::sdk::nosql_database_service::v1::CreateTableRequest;
 using google::cmrt::sdk::nosql_database_service::v1::CreateTableResponse;
 using google::cmrt::sdk::nosql_database_service::v1::DeleteTableRequest;
@@ -60,6 +72,7 @@ using google::cmrt::sdk::nosql_database_service::v1::ItemKey;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse;
 using google::protobuf::RepeatedPtrField;
+using google::protobuf::util::MessageDifferencer;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
@@ -69,10 +82,14 @@ using google::scp::core::FinishContext;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::errors::GetErrorMessage;
 using google::scp::core::errors::SC_GCP_FAILED_PRECONDITION;
 using google::scp::core::errors::
     SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_CHECKED_FAILED;
+using google::scp::core::errors::
+    SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_REPLACE;
 using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_EMPTY_TABLE_NAME;
+using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH;
 using google::scp::core::errors::
     SC_NO_SQL_DATABASE_PROVIDER_INVALID_PARAMETER_TYPE;
 using google::scp::core::errors::
@@ -90,7 +107,10 @@ using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_UNSET_KEY_TYPE;
 using google::scp::cpio::client_providers::GcpInstanceClientUtils;
 using google::scp::cpio::client_providers::GcpSpannerUtils;
 using google::scp::cpio::client_providers::PartitionAndSortKey;
+using google::scp::cpio::common::ApplySpannerConnectionOptions;
 using google::scp::cpio::common::GcpUtils;
+using google::scp::cpio::common::SpannerConnectionOptions;
+using google::scp::cpio::common::WarmUpSpannerClient;
 using google::spanner::admin::database::v1::UpdateDatabaseDdlRequest;
 using std::bind;
 using std::make_pair;
@@ -121,6 +141,9 @@ constexpr char kSortKeyParamName[] = "sort_key";
 
 constexpr int kValueColumnIndex = 0;
 
+constexpr size_t kMaxBatchGetItems = 100;
+constexpr size_t kMaxBatchUpsertItems = 25;
+
 ExecutionResult ValidateCreateTableRequest(
     AsyncContext<CreateTableRequest, CreateTableResponse>&
         create_table_context) {
@@ -272,6 +295,50 @@ ExecutionResult AppendJsonWhereClauses(const AttributesList& attributes,
   return SuccessExecutionResult();
 }
 
+// Parses the Value column of a row into the attributes of item.
+template <typename Context>
+ExecutionResult ParseValueColumn(Context& context,
+                                 const SpannerJson& spanner_json, Item& item) {
+  json value_json;
+  try {
+    value_json = json::parse(string(spanner_json));
+  } catch (...) {
+    auto result = FailureExecutionResult(
+        SC_NO_SQL_DATABASE_PROVIDER_JSON_FAILED_TO_PARSE);
+    SCP_ERROR_CONTEXT(kGcpSpanner, context, result,
+                      "Spanner parse JSON Value column failed.");
+    return result;
+  }
+
+  // Populate response attributes from all of the elements in the Value
+  // column.
+  for (auto& [json_attr_name, json_attr_value] : value_json.items()) {
+    auto attribute_or =
+        GcpSpannerUtils::ConvertJsonTypeToItemAttribute(json_attr_value);
+    if (!attribute_or.Successful()) {
+      // If conversion fails, it is likely a list, struct, or other
+      // unsupported type. Continue without failing.
+      SCP_ERROR_CONTEXT(kGcpSpanner, context, attribute_or.result(),
+                        "JSON field failed conversion");
+      continue;
+    }
+    attribute_or->set_name(json_attr_name);
+    *item.add_attributes() = move(*attribute_or);
+  }
+  return SuccessExecutionResult();
+}
+
+// Returns the union of the new attributes and of the existing ones, preferring
+// the new attributes.
+json MergeAttributes(json new_attributes, const json& existing_attributes) {
+  for (const auto& [key, val] : existing_attributes.items()) {
+    if (!new_attributes.contains(key)) {
+      new_attributes[key] = val;
+    }
+  }
+  return new_attributes;
+}
+
 }  // namespace
 
 namespace google::scp::cpio::client_providers {
@@ -289,6 +356,10 @@ ExecutionResult GcpSpannerClientProvider::Init() noexcept {
     SCP_ERROR(kGcpSpanner, kZeroUuid, result, "io_async_executor_ is null");
     return result;
   }
+  if (client_options_->spanner_upsert_cache_capacity > 0) {
+    upsert_cache_ = make_unique<GcpSpannerUpsertCache>(
+        client_options_->spanner_upsert_cache_capacity);
+  }
 
   return SuccessExecutionResult();
 }
@@ -306,9 +377,19 @@ ExecutionResult GcpSpannerClientProvider::Run() noexcept {
       "projects/%s/instances/%s/databases/%s", *project_id_or,
       client_options_->instance_name, client_options_->database_name);
 
+  SpannerConnectionOptions connection_options;
+  connection_options.min_sessions = client_options_->spanner_min_sessions;
+  connection_options.max_sessions_per_channel =
+      client_options_->spanner_max_sessions_per_channel;
+  connection_options.num_channels = client_options_->spanner_num_channels;
+  connection_options.session_keep_alive_interval =
+      client_options_->spanner_session_keep_alive_interval;
+  connection_options.grpc_keep_alive_time =
+      client_options_->spanner_grpc_keep_alive_time;
   auto client_or = spanner_factory_->CreateClients(
       *project_id_or, client_options_->instance_name,
-      client_options_->database_name);
+      client_options_->database_name,
+      ApplySpannerConnectionOptions(connection_options));
   if (!client_or.Successful()) {
     SCP_ERROR(kGcpSpanner, kZeroUuid, client_or.result(),
               "Failed creating Spanner clients");
@@ -317,6 +398,16 @@ ExecutionResult GcpSpannerClientProvider::Run() noexcept {
   spanner_client_shared_ = client_or->first;
   spanner_database_client_shared_ = client_or->second;
 
+  if (client_options_->spanner_warm_up_enabled) {
+    // A failure is not fatal, the requests create what they need.
+    if (auto result = WarmUpSpannerClient(*spanner_client_shared_);
+        !result.Successful()) {
+      SCP_WARNING(kGcpSpanner, kZeroUuid,
+                  "Failed warming up the Spanner connection: %s",
+                  GetErrorMessage(result.status_code));
+    }
+  }
+
   return SuccessExecutionResult();
 }
 
@@ -456,35 +547,14 @@ void GcpSpannerClientProvider::GetDatabaseItemAsync(
   get_database_item_context.response->mutable_item()->mutable_key()->CopyFrom(
       get_database_item_context.request->key());
 
-  json value_json;
-  try {
-    value_json = json::parse(string(*spanner_json_or));
-  } catch (...) {
-    auto result = FailureExecutionResult(
-        SC_NO_SQL_DATABASE_PROVIDER_JSON_FAILED_TO_PARSE);
-    SCP_ERROR_CONTEXT(kGcpSpanner, get_database_item_context, result,
-                      "Spanner parse JSON Value column failed.");
+  if (auto result = ParseValueColumn(
+          get_database_item_context, *spanner_json_or,
+          *get_database_item_context.response->mutable_item());
+      !result.Successful()) {
     FinishContext(result, get_database_item_context, cpu_async_executor_);
     return;
   }
 
-  // Populate response attributes from all of the elements in the Value
-  // column.
-  for (auto& [json_attr_name, json_attr_value] : value_json.items()) {
-    auto attribute_or =
-        GcpSpannerUtils::ConvertJsonTypeToItemAttribute(json_attr_value);
-    if (!attribute_or.Successful()) {
-      // If conversion fails, it is likely a list, struct, or other
-      // unsupported type. Continue without failing.
-      SCP_ERROR_CONTEXT(kGcpSpanner, get_database_item_context,
-                        attribute_or.result(), "JSON field failed conversion");
-      continue;
-    }
-    attribute_or->set_name(json_attr_name);
-    *get_database_item_context.response->mutable_item()->add_attributes() =
-        move(*attribute_or);
-  }
-
   FinishContext(SuccessExecutionResult(), get_database_item_context,
                 cpu_async_executor_);
 }
@@ -640,7 +710,7 @@ ExecutionResult GcpSpannerClientProvider::GetMergedJson(
     AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
         upsert_database_item_context,
     RowStream& row_stream, bool enforce_row_existence, json new_attributes,
-    optional<SpannerJson>& spanner_json) {
+    optional<json>& merged_json) {
   auto row_it = row_stream.begin();
   if (!row_it->ok()) {
     auto result = GcpUtils::GcpErrorConverter(row_it->status());
@@ -659,10 +729,10 @@ ExecutionResult GcpSpannerClientProvider::GetMergedJson(
                         "Spanner update failed because row does not exist");
       return result;
     }
-    // There's not existing row - that's OK, set spanner_json to have
+    // There's not existing row - that's OK, set merged_json to have
     // new_attributes.
     if (!new_attributes.empty()) {
-      spanner_json = SpannerJson(new_attributes.dump());
+      merged_json = move(new_attributes);
       return SuccessExecutionResult();
     }
   }
@@ -693,50 +763,48 @@ ExecutionResult GcpSpannerClientProvider::GetMergedJson(
     return result;
   }
 
-  json final_json = move(new_attributes);
-  // Emplace all members from the existing value only if they do not already
-  // exist.
-  for (const auto& [key, val] : existing_json.items()) {
-    if (!final_json.contains(key)) {
-      final_json[key] = val;
-    }
-  }
-
+  json final_json = MergeAttributes(move(new_attributes), existing_json);
   if (!final_json.empty()) {
-    spanner_json = SpannerJson(final_json.dump());
+    merged_json = move(final_json);
   }
   return SuccessExecutionResult();
 }
 
+Mutations GcpSpannerClientProvider::UpsertSelectOptions::BuildUpsertMutations(
+    const string& table_name, const optional<json>& value) const {
+  optional<SpannerJson> spanner_json;
+  if (value.has_value()) {
+    spanner_json = SpannerJson(value->dump());
+  }
+  if (sort_key_val.get<string>().ok()) {
+    // Include the sort_key column value.
+    return Mutations{MakeInsertOrUpdateMutation(table_name, column_names,
+                                                partition_key_val, sort_key_val,
+                                                Value(spanner_json))};
+  }
+  return Mutations{MakeInsertOrUpdateMutation(
+      table_name, column_names, partition_key_val, Value(spanner_json))};
+}
+
 Mutations GcpSpannerClientProvider::UpsertFunctor(
     AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
         upsert_database_item_context,
     Client& client, const UpsertSelectOptions& upsert_select_options,
     bool enforce_row_existence, const nlohmann::json& new_attributes,
     ExecutionResult& prepare_result, const string& table_name,
-    Transaction txn) {
+    optional<json>& merged_json, Transaction txn) {
   auto row_stream =
       client.ExecuteQuery(txn, upsert_select_options.select_statement);
 
-  optional<SpannerJson> spanner_json;
+  // The functor runs again if the transaction aborts.
+  merged_json.reset();
   prepare_result =
       GetMergedJson(upsert_database_item_context, row_stream,
-                    enforce_row_existence, move(new_attributes), spanner_json);
+                    enforce_row_existence, new_attributes, merged_json);
   if (!prepare_result.Successful()) {
     return Mutations{};
   }
-
-  if (upsert_select_options.sort_key_val.get<string>().ok()) {
-    // Include the sort_key column value.
-    return Mutations{MakeInsertOrUpdateMutation(
-        table_name, upsert_select_options.column_names,
-        upsert_select_options.partition_key_val,
-        upsert_select_options.sort_key_val, Value(spanner_json))};
-  } else {
-    return Mutations{MakeInsertOrUpdateMutation(
-        table_name, upsert_select_options.column_names,
-        upsert_select_options.partition_key_val, Value(spanner_json))};
-  }
+  return upsert_select_options.BuildUpsertMutations(table_name, merged_json);
 }
 
 void GcpSpannerClientProvider::UpsertDatabaseItemAsync(
@@ -746,14 +814,53 @@ void GcpSpannerClientProvider::UpsertDatabaseItemAsync(
     nlohmann::json new_attributes) noexcept {
   Client client(*spanner_client_shared_);
 
-  const auto& table_name =
-      upsert_database_item_context.request->key().table_name();
+  const auto& request = *upsert_database_item_context.request;
+  const auto& table_name = request.key().table_name();
+  string row_key;
+  shared_ptr<const json> cached_json;
+  if (upsert_cache_) {
+    row_key = GcpSpannerUpsertCache::GetRowKey(request.key());
+    cached_json = upsert_cache_->Claim(row_key);
+  }
+
+  // The existing value is not read if it is replaced, or if it is cached and
+  // the upsert is not conditional.
   ExecutionResult prepare_result = SuccessExecutionResult();
-  auto commit_result_or = client.Commit(
-      bind(&GcpSpannerClientProvider::UpsertFunctor, this,
-           ref(upsert_database_item_context), ref(client),
-           ref(upsert_select_options), enforce_row_existence,
-           ref(new_attributes), ref(prepare_result), ref(table_name), _1));
+  optional<json> merged_json;
+  StatusOr<CommitResult> commit_result_or;
+  if (request.replace_existing_attributes() ||
+      (cached_json && !enforce_row_existence)) {
+    json final_json =
+        request.replace_existing_attributes()
+            ? move(new_attributes)
+            : MergeAttributes(move(new_attributes), *cached_json);
+    if (!final_json.empty()) {
+      merged_json = move(final_json);
+    }
+    commit_result_or = client.Commit(
+        upsert_select_options.BuildUpsertMutations(table_name, merged_json));
+  } else {
+    commit_result_or = client.Commit(bind(
+        &GcpSpannerClientProvider::UpsertFunctor, this,
+        ref(upsert_database_item_context), ref(client),
+        ref(upsert_select_options), enforce_row_existence,
+        ref(new_attributes), ref(prepare_result), ref(table_name),
+        ref(merged_json), _1));
+  }
+
+  if (upsert_cache_) {
+    // Nothing is written if the preparation fails. The value of the row is
+    // unknown if the commit fails, and not cached if it is null.
+    optional<json> committed_json;
+    if (!prepare_result.Successful()) {
+      if (cached_json) {
+        committed_json = *cached_json;
+      }
+    } else if (commit_result_or.ok()) {
+      committed_json = merged_json;
+    }
+    upsert_cache_->Release(row_key, move(committed_json));
+  }
 
   if (!prepare_result.Successful()) {
     FinishContext(prepare_result, upsert_database_item_context,
@@ -819,6 +926,17 @@ ExecutionResult GcpSpannerClientProvider::UpsertDatabaseItem(
 
   // Row existence should be enforced if attributes is present and non-empty.
   bool enforce_row_existence = !request.required_attributes().empty();
+  if (request.replace_existing_attributes() && enforce_row_existence) {
+    auto result =
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_REPLACE);
+    SCP_ERROR_CONTEXT(kGcpSpanner, upsert_database_item_context, result,
+                      "Upsert replacing the attributes of an item of table %s "
+                      "has required attributes",
+                      request.key().table_name().c_str());
+    upsert_database_item_context.result = result;
+    upsert_database_item_context.Finish();
+    return result;
+  }
 
   json new_attributes;
   for (const auto& new_attr : request.new_attributes()) {
@@ -850,12 +968,415 @@ ExecutionResult GcpSpannerClientProvider::UpsertDatabaseItem(
   return SuccessExecutionResult();
 }
 
+ExecutionResult GcpSpannerClientProvider::BatchGetDatabaseItems(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>&
+        batch_get_database_items_context) noexcept {
+  const auto& requests = batch_get_database_items_context.request->requests();
+  auto fail_batch = [&](ExecutionResult result, const char* reason,
+                        const string& table_name) {
+    SCP_ERROR_CONTEXT(kGcpSpanner, batch_get_database_items_context, result,
+                      "Invalid batch get database items request: %s %s",
+                      reason, table_name.c_str());
+    batch_get_database_items_context.result = result;
+    batch_get_database_items_context.Finish();
+    return result;
+  };
+  if (requests.empty() || requests.size() > kMaxBatchGetItems) {
+    return fail_batch(
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH),
+        "empty or too many items", "");
+  }
+
+  // Build a query per table like:
+  // SELECT BudgetKeyId, Timeframe, IFNULL(Value, JSON '{}')
+  // FROM `BudgetKeys`
+  // WHERE (BudgetKeyId = @partition_key_0 AND Timeframe = @sort_key_0)
+  //    OR (BudgetKeyId = @partition_key_1 AND Timeframe = @sort_key_1)
+  struct TableQuery {
+    string table_name;
+    string partition_key_name;
+    optional<string> sort_key_name;
+    string where_clause;
+    SqlStatement::ParamType params;
+    BatchGetQuery query;
+  };
+  vector<TableQuery> table_queries;
+  unordered_map<string, size_t> table_query_indices;
+  for (size_t request_index = 0; request_index < requests.size();
+       ++request_index) {
+    const auto& request = requests[request_index];
+    const auto& key = request.key();
+    if (!request.required_attributes().empty()) {
+      return fail_batch(
+          FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH),
+          "required attributes for table", key.table_name());
+    }
+    if (auto execution_result = ValidatePartitionAndSortKey(
+            client_options_->table_name_to_keys.get(), key);
+        !execution_result.Successful()) {
+      return fail_batch(execution_result, "invalid key for table",
+                        key.table_name());
+    }
+
+    auto partition_key_val_or =
+        GcpSpannerUtils::ConvertItemAttributeToSpannerValue(
+            key.partition_key());
+    if (!partition_key_val_or.Successful()) {
+      return fail_batch(partition_key_val_or.result(),
+                        "invalid partition key for table", key.table_name());
+    }
+    // sort_key is optional
+    optional<string> sort_key_name;
+    Value sort_key_val;
+    if (key.has_sort_key() && !key.sort_key().name().empty()) {
+      auto sort_key_val_or =
+          GcpSpannerUtils::ConvertItemAttributeToSpannerValue(key.sort_key());
+      if (!sort_key_val_or.Successful()) {
+        return fail_batch(sort_key_val_or.result(),
+                          "invalid sort key for table", key.table_name());
+      }
+      sort_key_name = key.sort_key().name();
+      sort_key_val = move(*sort_key_val_or);
+    }
+
+    auto [table_query_index, is_new_table] =
+        table_query_indices.emplace(key.table_name(), table_queries.size());
+    if (is_new_table) {
+      auto& table_query = table_queries.emplace_back();
+      table_query.table_name = key.table_name();
+      table_query.partition_key_name = key.partition_key().name();
+      table_query.sort_key_name = sort_key_name;
+      table_query.query.has_sort_key = sort_key_name.has_value();
+    }
+    auto& table_query = table_queries[table_query_index->second];
+    if (table_query.partition_key_name != key.partition_key().name() ||
+        table_query.sort_key_name != sort_key_name) {
+      return fail_batch(
+          FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH),
+          "different key names for table", key.table_name());
+    }
+
+    const auto key_index = table_query.query.request_indices.size();
+    auto partition_key_alias =
+        absl::StrCat(kPartitionKeyParamName, "_", key_index);
+    absl::StrAppendFormat(&table_query.where_clause, "%s(%s = @%s",
+                          key_index == 0 ? "" : " OR ",
+                          key.partition_key().name(), partition_key_alias);
+    table_query.params.emplace(move(partition_key_alias),
+                               *partition_key_val_or);
+    if (sort_key_name) {
+      auto sort_key_alias = absl::StrCat(kSortKeyParamName, "_", key_index);
+      absl::StrAppendFormat(&table_query.where_clause, " AND %s = @%s",
+                            *sort_key_name, sort_key_alias);
+      table_query.params.emplace(move(sort_key_alias), sort_key_val);
+    }
+    absl::StrAppend(&table_query.where_clause, ")");
+    table_query.query.request_indices.push_back(request_index);
+    table_query.query.key_values.emplace_back(move(*partition_key_val_or),
+                                              move(sort_key_val));
+  }
+
+  vector<BatchGetQuery> queries;
+  queries.reserve(table_queries.size());
+  for (auto& table_query : table_queries) {
+    string columns = table_query.partition_key_name;
+    if (table_query.sort_key_name) {
+      absl::StrAppend(&columns, ", ", *table_query.sort_key_name);
+    }
+    table_query.query.statement = SqlStatement(
+        absl::StrFormat("SELECT %s, IFNULL(%s, JSON '{}') FROM `%s` WHERE %s",
+                        columns, kValueColumnName, table_query.table_name,
+                        table_query.where_clause),
+        move(table_query.params));
+    queries.push_back(move(table_query.query));
+  }
+
+  if (auto schedule_result = io_async_executor_->Schedule(
+          bind(&GcpSpannerClientProvider::BatchGetDatabaseItemsAsync, this,
+               batch_get_database_items_context, move(queries)),
+          AsyncPriority::Normal);
+      !schedule_result.Successful()) {
+    SCP_ERROR_CONTEXT(kGcpSpanner, batch_get_database_items_context,
+                      schedule_result,
+                      "Error scheduling BatchGetDatabaseItems");
+    batch_get_database_items_context.result = schedule_result;
+    batch_get_database_items_context.Finish();
+    return schedule_result;
+  }
+
+  return SuccessExecutionResult();
+}
+
+void GcpSpannerClientProvider::BatchGetDatabaseItemsAsync(
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+        batch_get_database_items_context,
+    vector<BatchGetQuery> queries) noexcept {
+  Client spanner_client(*spanner_client_shared_);
+  const auto& requests = batch_get_database_items_context.request->requests();
+
+  // The items no row is returned for are not in the table.
+  batch_get_database_items_context.response =
+      make_shared<BatchGetDatabaseItemsResponse>();
+  auto& responses =
+      *batch_get_database_items_context.response->mutable_responses();
+  for (int request_index = 0; request_index < requests.size();
+       ++request_index) {
+    *responses.Add()->mutable_result() =
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)
+            .ToProto();
+  }
+
+  size_t failed_query_count = 0;
+  ExecutionResult query_failure = SuccessExecutionResult();
+  for (auto& query : queries) {
+    const size_t value_column_index = query.has_sort_key ? 2 : 1;
+    vector<bool> is_found(query.request_indices.size(), false);
+    auto row_stream = spanner_client.ExecuteQuery(move(query.statement));
+    bool is_any_row_read = false;
+    for (const auto& row : row_stream) {
+      if (!row.ok()) {
+        auto result = GcpUtils::GcpErrorConverter(row.status());
+        SCP_ERROR_CONTEXT(kGcpSpanner, batch_get_database_items_context,
+                          result,
+                          "Spanner batch get database items request failed "
+                          "for Database %s Table %s",
+                          client_options_->database_name.c_str(),
+                          requests[query.request_indices[0]]
+                              .key()
+                              .table_name()
+                              .c_str());
+        // The items read before the failure are kept.
+        for (size_t key_index = 0; key_index < is_found.size(); ++key_index) {
+          if (!is_found[key_index]) {
+            *responses.Mutable(query.request_indices[key_index])
+                 ->mutable_result() = result.ToProto();
+          }
+        }
+        if (!is_any_row_read) {
+          failed_query_count++;
+          query_failure = result;
+        }
+        break;
+      }
+      is_any_row_read = true;
+
+      const auto partition_key_val_or = row->get(0);
+      const auto sort_key_val_or =
+          query.has_sort_key ? row->get(1) : StatusOr<Value>(Value());
+      if (!partition_key_val_or.ok() || !sort_key_val_or.ok()) {
+        auto result = FailureExecutionResult(
+            SC_NO_SQL_DATABASE_PROVIDER_RECORD_CORRUPTED);
+        SCP_ERROR_CONTEXT(kGcpSpanner, batch_get_database_items_context,
+                          result, "Spanner get key columns failed");
+        continue;
+      }
+      const auto spanner_json_or = row->get<SpannerJson>(value_column_index);
+
+      // A key repeated in the batch matches all the requests asking for it.
+      for (size_t key_index = 0; key_index < query.key_values.size();
+           ++key_index) {
+        const auto& [partition_key_val, sort_key_val] =
+            query.key_values[key_index];
+        if (is_found[key_index] ||
+            !(partition_key_val == *partition_key_val_or) ||
+            (query.has_sort_key && !(sort_key_val == *sort_key_val_or))) {
+          continue;
+        }
+        is_found[key_index] = true;
+
+        const auto request_index = query.request_indices[key_index];
+        auto& response = *responses.Mutable(request_index);
+        response.mutable_item()->mutable_key()->CopyFrom(
+            requests[request_index].key());
+        auto result =
+            spanner_json_or.ok()
+                ? ParseValueColumn(batch_get_database_items_context,
+                                   *spanner_json_or, *response.mutable_item())
+                : GcpUtils::GcpErrorConverter(spanner_json_or.status());
+        if (!result.Successful()) {
+          response.clear_item();
+        }
+        *response.mutable_result() = result.ToProto();
+      }
+    }
+  }
+
+  if (failed_query_count == queries.size()) {
+    FinishContext(query_failure, batch_get_database_items_context,
+                  cpu_async_executor_);
+    return;
+  }
+  FinishContext(SuccessExecutionResult(), batch_get_database_items_context,
+                cpu_async_executor_);
+}
+
+ExecutionResult GcpSpannerClientProvider::BatchUpsertDatabaseItems(
+    AsyncContext<BatchUpsertDatabaseItemsRequest,
+                 BatchUpsertDatabaseItemsResponse>&
+        batch_upsert_database_items_context) noexcept {
+  const auto& requests =
+      batch_upsert_database_items_context.request->requests();
+  auto fail_batch = [&](ExecutionResult result, const char* reason,
+                        const string& table_name) {
+    SCP_ERROR_CONTEXT(kGcpSpanner, batch_upsert_database_items_context, result,
+                      "Invalid batch upsert database items request: %s %s",
+                      reason, table_name.c_str());
+    batch_upsert_database_items_context.result = result;
+    batch_upsert_database_items_context.Finish();
+    return result;
+  };
+  if (requests.empty() || requests.size() > kMaxBatchUpsertItems) {
+    return fail_batch(
+        FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH),
+        "empty or too many items", "");
+  }
+
+  // Every item is written blindly as a whole, so no read is needed:
+  //   InsertOrUpdate(partition_key, sort_key, Value)
+  Mutations mutations;
+  mutations.reserve(requests.size());
+  for (size_t request_index = 0; request_index < requests.size();
+       ++request_index) {
+    const auto& request = requests[request_index];
+    const auto& key = request.key();
+    if (!request.required_attributes().empty()) {
+      return fail_batch(
+          FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH),
+          "required attributes for table", key.table_name());
+    }
+    if (auto execution_result = ValidatePartitionAndSortKey(
+            client_options_->table_name_to_keys.get(), key);
+        !execution_result.Successful()) {
+      return fail_batch(execution_result, "invalid key for table",
+                        key.table_name());
+    }
+    // The outcome of repeated items in a commit would be undefined.
+    for (size_t previous_index = 0; previous_index < request_index;
+         ++previous_index) {
+      if (MessageDifferencer::Equals(requests[previous_index].key(), key)) {
+        return fail_batch(
+            FailureExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH),
+            "repeated item for table", key.table_name());
+      }
+    }
+
+    auto partition_key_val_or =
+        GcpSpannerUtils::ConvertItemAttributeToSpannerValue(
+            key.partition_key());
+    if (!partition_key_val_or.Successful()) {
+      return fail_batch(partition_key_val_or.result(),
+                        "invalid partition key for table", key.table_name());
+    }
+
+    json new_attributes;
+    for (const auto& new_attr : request.new_attributes()) {
+      auto json_attr_or =
+          GcpSpannerUtils::ConvertItemAttributeToJsonType(new_attr);
+      if (!json_attr_or.Successful()) {
+        return fail_batch(json_attr_or.result(),
+                          "invalid attribute for table", key.table_name());
+      }
+      new_attributes[new_attr.name()] = move(*json_attr_or);
+    }
+    optional<SpannerJson> spanner_json;
+    if (!new_attributes.empty()) {
+      spanner_json = SpannerJson(new_attributes.dump());
+    }
+
+    // sort_key is optional
+    if (key.has_sort_key() && !key.sort_key().name().empty()) {
+      auto sort_key_val_or =
+          GcpSpannerUtils::ConvertItemAttributeToSpannerValue(key.sort_key());
+      if (!sort_key_val_or.Successful()) {
+        return fail_batch(sort_key_val_or.result(),
+                          "invalid sort key for table", key.table_name());
+      }
+      mutations.push_back(MakeInsertOrUpdateMutation(
+          key.table_name(),
+          {key.partition_key().name(), key.sort_key().name(),
+           kValueColumnName},
+          move(*partition_key_val_or), move(*sort_key_val_or),
+          Value(spanner_json)));
+    } else {
+      mutations.push_back(MakeInsertOrUpdateMutation(
+          key.table_name(), {key.partition_key().name(), kValueColumnName},
+          move(*partition_key_val_or), Value(spanner_json)));
+    }
+  }
+
+  if (auto schedule_result = io_async_executor_->Schedule(
+          bind(&GcpSpannerClientProvider::BatchUpsertDatabaseItemsAsync, this,
+               batch_upsert_database_items_context, move(mutations)),
+          AsyncPriority::Normal);
+      !schedule_result.Successful()) {
+    SCP_ERROR_CONTEXT(kGcpSpanner, batch_upsert_database_items_context,
+                      schedule_result,
+                      "Error scheduling BatchUpsertDatabaseItems");
+    batch_upsert_database_items_context.result = schedule_result;
+    batch_upsert_database_items_context.Finish();
+    return schedule_result;
+  }
+
+  return SuccessExecutionResult();
+}
+
+void GcpSpannerClientProvider::BatchUpsertDatabaseItemsAsync(
+    AsyncContext<BatchUpsertDatabaseItemsRequest,
+                 BatchUpsertDatabaseItemsResponse>
+        batch_upsert_database_items_context,
+    Mutations mutations) noexcept {
+  Client client(*spanner_client_shared_);
+  // The cached rows are forgotten, as their values are not merged here. The
+  // rows are claimed in order, so that concurrent batches do not deadlock.
+  vector<string> row_keys;
+  if (upsert_cache_) {
+    for (const auto& request :
+         batch_upsert_database_items_context.request->requests()) {
+      row_keys.push_back(GcpSpannerUpsertCache::GetRowKey(request.key()));
+    }
+    std::sort(row_keys.begin(), row_keys.end());
+    for (const auto& row_key : row_keys) {
+      upsert_cache_->Claim(row_key);
+    }
+  }
+  auto commit_result_or = client.Commit(move(mutations));
+  for (const auto& row_key : row_keys) {
+    upsert_cache_->Release(row_key, std::nullopt);
+  }
+  if (!commit_result_or.ok()) {
+    auto result =
+        RetryExecutionResult(SC_NO_SQL_DATABASE_PROVIDER_RETRIABLE_ERROR);
+    SCP_ERROR_CONTEXT(
+        kGcpSpanner, batch_upsert_database_items_context, result,
+        "Spanner batch upsert commit failed. Error code: %d, message: %s",
+        commit_result_or.status().code(),
+        commit_result_or.status().message().c_str());
+    FinishContext(result, batch_upsert_database_items_context,
+                  cpu_async_executor_);
+    return;
+  }
+
+  batch_upsert_database_items_context.response =
+      make_shared<BatchUpsertDatabaseItemsResponse>();
+  for (int request_index = 0;
+       request_index <
+       batch_upsert_database_items_context.request->requests_size();
+       ++request_index) {
+    *batch_upsert_database_items_context.response->add_responses()
+         ->mutable_result() = SuccessExecutionResult().ToProto();
+  }
+  FinishContext(SuccessExecutionResult(), batch_upsert_database_items_context,
+                cpu_async_executor_);
+}
+
 ExecutionResultOr<pair<shared_ptr<Client>, shared_ptr<DatabaseAdminClient>>>
 SpannerFactory::CreateClients(const string& project, const string& instance,
-                              const string& database) noexcept {
+                              const string& database,
+                              google::cloud::Options connection_options)
+    noexcept {
   return make_pair(
-      make_shared<Client>(
-          MakeConnection(Database(project, instance, database))),
+      make_shared<Client>(MakeConnection(Database(project, instance, database),
+                                         move(connection_options))),
       make_shared<DatabaseAdminClient>(MakeDatabaseAdminConnection()));
 }
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -28,6 +29,7 @@
 #include "core/interface/async_executor_interface.h"
 #include "cpio/client_providers/interface/nosql_database_client_provider_interface.h"
 #include "cpio/client_providers/nosql_database_client_provider/src/common/error_codes.h"
+#include "cpio/client_providers/nosql_database_client_provider/src/gcp/gcp_spanner_upsert_cache.h"
 #include "google/cloud/spanner/admin/database_admin_client.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/mutations.h"
@@ -92,6 +94,27 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse>&
           upsert_database_item_context) noexcept override;
 
+  /**
+   * @brief Gets the items with one query per table, whose WHERE clause matches
+   * the keys of all the items of the table.
+   */
+  core::ExecutionResult BatchGetDatabaseItems(
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsResponse>&
+          batch_get_database_items_context) noexcept override;
+
+  /**
+   * @brief Writes the items with the InsertOrUpdate mutations of a single
+   * commit, so either all of them or none are written.
+   */
+  core::ExecutionResult BatchUpsertDatabaseItems(
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>&
+          batch_upsert_database_items_context) noexcept override;
+
  private:
   /**
    * @brief Is called by async executor in order to create the table.
@@ -148,13 +171,19 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
     // respectively.
     google::cloud::spanner::Value partition_key_val, sort_key_val;
 
+    // Builds the InsertOrUpdate mutation writing value to the row, as null if
+    // unset.
+    google::cloud::spanner::Mutations BuildUpsertMutations(
+        const std::string& table_name,
+        const std::optional<nlohmann::json>& value) const;
+
    private:
     UpsertSelectOptions() = default;
   };
 
   /**
    * @brief Extracts the acquired JSON value from row_stream, then merges it
-   * with the json in read_modify_write_options and writes it into spanner_json.
+   * with the json in read_modify_write_options and writes it into merged_json.
    *
    * @param upsert_database_item_context Context used for logging errors.
    * @param row_stream The row stream to read the existing row out of.
@@ -162,7 +191,7 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
    * ensure our select_statement produces a row before proceeding.
    * @param new_attributes A JSON holding the new_attributes we extracted
    * from UpsertDatabaseItemRequest.
-   * @param spanner_json
+   * @param merged_json The merged value, left unset if it is empty.
    * @return ExecutionResult
    */
   core::ExecutionResult GetMergedJson(
@@ -172,9 +201,10 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
           upsert_database_item_context,
       google::cloud::spanner::RowStream& row_stream, bool enforce_row_existence,
       nlohmann::json new_attributes,
-      std::optional<google::cloud::spanner::Json>& spanner_json);
+      std::optional<nlohmann::json>& merged_json);
 
-  // Used to pass to client.Commit when Upserting an item.
+  // Used to pass to client.Commit when Upserting an item. Sets merged_json to
+  // the value it writes.
   google::cloud::spanner::Mutations UpsertFunctor(
       core::AsyncContext<
           cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest,
@@ -184,6 +214,7 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
       const UpsertSelectOptions& upsert_select_options,
       bool enforce_row_existence, const nlohmann::json& new_attributes,
       core::ExecutionResult& prepare_result, const std::string& table_name,
+      std::optional<nlohmann::json>& merged_json,
       google::cloud::spanner::Transaction txn);
 
   /**
@@ -205,6 +236,53 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
       UpsertSelectOptions upsert_select_options, bool enforce_row_existence,
       nlohmann::json new_attributes) noexcept;
 
+  /// The query getting the items of a batch that are in the same table.
+  struct BatchGetQuery {
+    // SELECT <partition key>[, <sort key>], Value FROM the table WHERE the
+    // keys match any of the items.
+    google::cloud::spanner::SqlStatement statement;
+    // Whether the table has a sort key.
+    bool has_sort_key = false;
+    // The indices of the requests for the table.
+    std::vector<size_t> request_indices;
+    // The spanner Values of the partition and sort key of every request in
+    // request_indices. The sort key Value is null without a sort key.
+    std::vector<
+        std::pair<google::cloud::spanner::Value, google::cloud::spanner::Value>>
+        key_values;
+  };
+
+  /**
+   * @brief Is called by async executor in order to acquire the DB items of a
+   * batch.
+   *
+   * @param batch_get_database_items_context The context object of the batch
+   * get database items operation.
+   * @param queries The queries to execute, one per table.
+   */
+  void BatchGetDatabaseItemsAsync(
+      core::AsyncContext<
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsRequest,
+          cmrt::sdk::nosql_database_service::v1::BatchGetDatabaseItemsResponse>
+          batch_get_database_items_context,
+      std::vector<BatchGetQuery> queries) noexcept;
+
+  /**
+   * @brief Is called by async executor in order to write the DB items of a
+   * batch.
+   *
+   * @param batch_upsert_database_items_context The context object of the batch
+   * upsert database items operation.
+   * @param mutations The InsertOrUpdate mutations of the items.
+   */
+  void BatchUpsertDatabaseItemsAsync(
+      core::AsyncContext<cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsRequest,
+                         cmrt::sdk::nosql_database_service::v1::
+                             BatchUpsertDatabaseItemsResponse>
+          batch_upsert_database_items_context,
+      google::cloud::spanner::Mutations mutations) noexcept;
+
   /// Options for the client.
   std::shared_ptr<NoSQLDatabaseClientOptions> client_options_;
 
@@ -228,6 +306,10 @@ class GcpSpannerClientProvider : public NoSQLDatabaseClientProviderInterface {
   std::shared_ptr<const google::cloud::spanner_admin::DatabaseAdminClient>
       spanner_database_client_shared_;
 
+  /// The values of the upserted rows, if
+  /// NoSQLDatabaseClientOptions::spanner_upsert_cache_capacity is set.
+  std::unique_ptr<GcpSpannerUpsertCache> upsert_cache_;
+
   /// spanner_database_client_shared_ expects the database name in the form:
   /// projects/<PROJECT>/instances/<INSTANCE>/databases/<DATABASE>.
   std::string fully_qualified_db_name_;
@@ -243,7 +325,8 @@ class SpannerFactory {
       std::shared_ptr<google::cloud::spanner::Client>,
       std::shared_ptr<google::cloud::spanner_admin::DatabaseAdminClient>>>
   CreateClients(const std::string& project, const std::string& instance,
-                const std::string& database) noexcept;
+                const std::string& database,
+                google::cloud::Options connection_options = {}) noexcept;
 
   virtual ~SpannerFactory() = default;
 };
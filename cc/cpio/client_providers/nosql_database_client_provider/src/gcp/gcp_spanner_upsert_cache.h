@@ -0,0 +1,99 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include "absl/container/flat_hash_set.h"
+#include "core/common/lru_cache/src/sharded_lru_cache.h"
+#include "public/cpio/proto/nosql_database_service/v1/nosql_database_service.pb.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Caches the values of the rows upserted by GcpSpannerClientProvider,
+ * so that the next upserts of a row merge the new attributes with the cached
+ * value instead of reading the row.
+ *
+ * The cached value is current only if the provider is the only writer of the
+ * row, thus the upserts of a row are serialized in process: an upsert claims
+ * the row before reading or writing it, and releases it with the value it
+ * committed, or without a value if the outcome is unknown. An upsert waits
+ * for the one in flight on its row, which takes no longer than a commit.
+ */
+class GcpSpannerUpsertCache {
+ public:
+  explicit GcpSpannerUpsertCache(size_t capacity) : values_(capacity) {}
+
+  /// Returns the key of the row of item_key in the cache.
+  static std::string GetRowKey(
+      const cmrt::sdk::nosql_database_service::v1::ItemKey& item_key) {
+    return item_key.SerializeAsString();
+  }
+
+  /**
+   * @brief Claims the row, once the upsert in flight on it is released.
+   *
+   * @param row_key the key of the row.
+   * @return std::shared_ptr<const nlohmann::json> the value of the row, or
+   * nullptr if it is not cached.
+   */
+  std::shared_ptr<const nlohmann::json> Claim(const std::string& row_key) {
+    std::unique_lock lock(mutex_);
+    row_released_.wait(lock,
+                       [&]() { return !claimed_rows_.contains(row_key); });
+    claimed_rows_.insert(row_key);
+    return values_.Get(row_key);
+  }
+
+  /**
+   * @brief Releases the row claimed by Claim().
+   *
+   * @param row_key the key of the row.
+   * @param value the value committed to the row, or nullopt if the row is to
+   * be read by its next upsert.
+   */
+  void Release(const std::string& row_key,
+               std::optional<nlohmann::json> value) {
+    if (value.has_value()) {
+      values_.Set(row_key, std::move(*value));
+    } else {
+      values_.Erase(row_key);
+    }
+    {
+      std::lock_guard lock(mutex_);
+      claimed_rows_.erase(row_key);
+    }
+    row_released_.notify_all();
+  }
+
+ private:
+  core::common::ShardedLruCache<std::string, nlohmann::json> values_;
+  std::mutex mutex_;
+  std::condition_variable row_released_;
+  /// The rows with an upsert in flight.
+  absl::flat_hash_set<std::string> claimed_rows_;
+};
+}  // namespace google::scp::cpio::client_providers
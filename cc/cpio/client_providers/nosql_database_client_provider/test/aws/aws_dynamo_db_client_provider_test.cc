@@ -44,19 +44,37 @@ using Aws::String;
 using Aws::Client::AsyncCallerContext;
 using Aws::Client::AWSError;
 using Aws::Client::ClientConfiguration;
+using Aws::DynamoDB::BatchGetItemResponseReceivedHandler;
+using Aws::DynamoDB::BatchWriteItemResponseReceivedHandler;
 using Aws::DynamoDB::DynamoDBClient;
 using Aws::DynamoDB::DynamoDBErrors;
 using Aws::DynamoDB::GetItemResponseReceivedHandler;
 using Aws::DynamoDB::QueryResponseReceivedHandler;
 using Aws::DynamoDB::UpdateItemResponseReceivedHandler;
 using Aws::DynamoDB::Model::AttributeValue;
+using Aws::DynamoDB::Model::BatchGetItemOutcome;
+using Aws::DynamoDB::Model::BatchGetItemRequest;
+using Aws::DynamoDB::Model::BatchGetItemResult;
+using Aws::DynamoDB::Model::BatchWriteItemOutcome;
+using Aws::DynamoDB::Model::BatchWriteItemRequest;
+using Aws::DynamoDB::Model::BatchWriteItemResult;
 using Aws::DynamoDB::Model::GetItemRequest;
+using Aws::DynamoDB::Model::KeysAndAttributes;
 using Aws::DynamoDB::Model::QueryOutcome;
 using Aws::DynamoDB::Model::QueryRequest;
 using Aws::DynamoDB::Model::QueryResult;
 using Aws::DynamoDB::Model::UpdateItemOutcome;
 using Aws::DynamoDB::Model::UpdateItemRequest;
 using Aws::DynamoDB::Model::UpdateItemResult;
+using Aws::DynamoDB::Model::WriteRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsResponse;
 using google::cmrt::sdk::nosql_database_service::v1::GetDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::GetDatabaseItemResponse;
 using google::cmrt::sdk::nosql_database_service::v1::ItemAttribute;
@@ -65,11 +83,14 @@ using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutor;
+using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH;
 using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND;
+using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_RETRIABLE_ERROR;
 using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_UNRETRIABLE_ERROR;
 using google::scp::core::test::IsSuccessful;
 using google::scp::core::test::ResultIs;
@@ -120,6 +141,13 @@ ItemAttribute MakeDoubleAttribute(const string& name, double value) {
   return attribute;
 }
 
+ItemKey MakeIntKey(int partition_key_value) {
+  ItemKey key;
+  key.set_table_name(kTableName);
+  *key.mutable_partition_key() = MakeIntAttribute("Col1", partition_key_value);
+  return key;
+}
+
 }  // namespace
 
 namespace google::scp::cpio::client_providers::test {
@@ -143,6 +171,18 @@ class MockDynamoDBClient : public Aws::DynamoDB::DynamoDBClient {
                const Aws::DynamoDB::UpdateItemResponseReceivedHandler&,
                const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
               (const, override));
+
+  MOCK_METHOD(void, BatchGetItemAsync,
+              (const Aws::DynamoDB::Model::BatchGetItemRequest&,
+               const Aws::DynamoDB::BatchGetItemResponseReceivedHandler&,
+               const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
+              (const, override));
+
+  MOCK_METHOD(void, BatchWriteItemAsync,
+              (const Aws::DynamoDB::Model::BatchWriteItemRequest&,
+               const Aws::DynamoDB::BatchWriteItemResponseReceivedHandler&,
+               const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
+              (const, override));
 };
 
 class AwsDynamoDBClientProviderTest : public testing::Test {
@@ -173,6 +213,12 @@ class AwsDynamoDBClientProviderTest : public testing::Test {
       finish_called_ = true;
     };
 
+    batch_get_database_items_context_.request =
+        make_shared<BatchGetDatabaseItemsRequest>();
+
+    batch_upsert_database_items_context_.request =
+        make_shared<BatchUpsertDatabaseItemsRequest>();
+
     EXPECT_SUCCESS(client_provider_.Init());
     EXPECT_SUCCESS(client_provider_.Run());
   }
@@ -187,6 +233,13 @@ class AwsDynamoDBClientProviderTest : public testing::Test {
 
   AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>
       upsert_database_item_context_;
+
+  AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+      batch_get_database_items_context_;
+
+  AsyncContext<BatchUpsertDatabaseItemsRequest,
+               BatchUpsertDatabaseItemsResponse>
+      batch_upsert_database_items_context_;
   // We check that this gets flipped after every call to ensure the context's
   // Finish() is called.
   atomic_bool finish_called_{false};
@@ -635,4 +688,208 @@ TEST_F(AwsDynamoDBClientProviderTest, UpsertDatabaseItemCallbackFailure) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(AwsDynamoDBClientProviderTest,
+       BatchGetDatabaseItemsRequestsKeysOnceAndRetriesUnprocessedKeys) {
+  auto& requests =
+      *batch_get_database_items_context_.request->mutable_requests();
+  for (int partition_key_value : {1, 2, 1, 3}) {
+    *requests.Add()->mutable_key() = MakeIntKey(partition_key_value);
+  }
+
+  EXPECT_CALL(*dynamo_db_, BatchGetItemAsync)
+      .WillOnce([](const auto& batch_get_item_request, const auto& callback,
+                   const auto&) {
+        const auto& request_items = batch_get_item_request.GetRequestItems();
+        ASSERT_EQ(request_items.size(), 1);
+        EXPECT_EQ(request_items.at(kTableName).GetKeys().size(), 3);
+
+        Map<String, AttributeValue> item;
+        item.emplace(String("Col1"), AttributeValue().SetN("1"));
+        item.emplace(String("attr1"), AttributeValue().SetS("one"));
+        BatchGetItemResult result;
+        result.AddResponses(kTableName, {item});
+        KeysAndAttributes unprocessed_keys;
+        Map<String, AttributeValue> key;
+        key.emplace(String("Col1"), AttributeValue().SetN("2"));
+        unprocessed_keys.AddKeys(key);
+        result.AddUnprocessedKeys(kTableName, unprocessed_keys);
+        callback(nullptr /*dynamo_client*/, batch_get_item_request,
+                 BatchGetItemOutcome(result), nullptr /*caller_context*/);
+      })
+      .WillOnce([](const auto& batch_get_item_request, const auto& callback,
+                   const auto&) {
+        const auto& keys =
+            batch_get_item_request.GetRequestItems().at(kTableName).GetKeys();
+        ASSERT_EQ(keys.size(), 1);
+        EXPECT_THAT(keys[0],
+                    UnorderedElementsAre(Pair("Col1", HasNumber("2"))));
+
+        Map<String, AttributeValue> item;
+        item.emplace(String("Col1"), AttributeValue().SetN("2"));
+        item.emplace(String("attr1"), AttributeValue().SetS("two"));
+        BatchGetItemResult result;
+        result.AddResponses(kTableName, {item});
+        callback(nullptr /*dynamo_client*/, batch_get_item_request,
+                 BatchGetItemOutcome(result), nullptr /*caller_context*/);
+      });
+
+  batch_get_database_items_context_.callback =
+      [this](AsyncContext<BatchGetDatabaseItemsRequest,
+                          BatchGetDatabaseItemsResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        const auto& responses = context.response->responses();
+        ASSERT_EQ(responses.size(), 4);
+        for (int index : {0, 2}) {
+          EXPECT_SUCCESS(ExecutionResult(responses[index].result()));
+          EXPECT_THAT(responses[index].item().key().partition_key(),
+                      IsIntAttribute("Col1", 1));
+          EXPECT_THAT(responses[index].item().attributes(),
+                      UnorderedElementsAre(IsStringAttribute("attr1", "one")));
+        }
+        EXPECT_SUCCESS(ExecutionResult(responses[1].result()));
+        EXPECT_THAT(responses[1].item().attributes(),
+                    UnorderedElementsAre(IsStringAttribute("attr1", "two")));
+        EXPECT_THAT(ExecutionResult(responses[3].result()),
+                    ResultIs(FailureExecutionResult(
+                        SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)));
+        finish_called_ = true;
+      };
+
+  EXPECT_THAT(client_provider_.BatchGetDatabaseItems(
+                  batch_get_database_items_context_),
+              IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(AwsDynamoDBClientProviderTest,
+       BatchGetDatabaseItemsGivesRetriableResultsToKeysLeftUnprocessed) {
+  *batch_get_database_items_context_.request->add_requests()->mutable_key() =
+      MakeIntKey(1);
+
+  atomic<size_t> request_count{0};
+  EXPECT_CALL(*dynamo_db_, BatchGetItemAsync)
+      .WillRepeatedly([&request_count](const auto& batch_get_item_request,
+                                       const auto& callback, const auto&) {
+        request_count++;
+        BatchGetItemResult result;
+        result.AddUnprocessedKeys(
+            kTableName,
+            batch_get_item_request.GetRequestItems().at(kTableName));
+        callback(nullptr /*dynamo_client*/, batch_get_item_request,
+                 BatchGetItemOutcome(result), nullptr /*caller_context*/);
+      });
+
+  batch_get_database_items_context_.callback =
+      [this](AsyncContext<BatchGetDatabaseItemsRequest,
+                          BatchGetDatabaseItemsResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        ASSERT_EQ(context.response->responses().size(), 1);
+        EXPECT_THAT(ExecutionResult(context.response->responses(0).result()),
+                    ResultIs(RetryExecutionResult(
+                        SC_NO_SQL_DATABASE_PROVIDER_RETRIABLE_ERROR)));
+        finish_called_ = true;
+      };
+
+  EXPECT_THAT(client_provider_.BatchGetDatabaseItems(
+                  batch_get_database_items_context_),
+              IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+  EXPECT_EQ(request_count.load(), 6);
+}
+
+TEST_F(AwsDynamoDBClientProviderTest,
+       BatchGetDatabaseItemsRejectsRequiredAttributes) {
+  auto& request = *batch_get_database_items_context_.request->add_requests();
+  *request.mutable_key() = MakeIntKey(1);
+  *request.add_required_attributes() = MakeIntAttribute("Attr1", 1);
+
+  EXPECT_CALL(*dynamo_db_, BatchGetItemAsync).Times(0);
+
+  EXPECT_THAT(client_provider_.BatchGetDatabaseItems(
+                  batch_get_database_items_context_),
+              ResultIs(FailureExecutionResult(
+                  SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH)));
+}
+
+TEST_F(AwsDynamoDBClientProviderTest,
+       BatchUpsertDatabaseItemsPutsItemsAndRetriesUnprocessedItems) {
+  for (int partition_key_value : {1, 2}) {
+    auto& request =
+        *batch_upsert_database_items_context_.request->add_requests();
+    *request.mutable_key() = MakeIntKey(partition_key_value);
+    *request.add_new_attributes() =
+        MakeIntAttribute("Attr1", partition_key_value * 10);
+  }
+
+  EXPECT_CALL(*dynamo_db_, BatchWriteItemAsync)
+      .WillOnce([](const auto& batch_write_item_request, const auto& callback,
+                   const auto&) {
+        const auto& write_requests =
+            batch_write_item_request.GetRequestItems().at(kTableName);
+        ASSERT_EQ(write_requests.size(), 2);
+        EXPECT_THAT(write_requests[0].GetPutRequest().GetItem(),
+                    UnorderedElementsAre(Pair("Col1", HasNumber("1")),
+                                         Pair("Attr1", HasNumber("10"))));
+        EXPECT_THAT(write_requests[1].GetPutRequest().GetItem(),
+                    UnorderedElementsAre(Pair("Col1", HasNumber("2")),
+                                         Pair("Attr1", HasNumber("20"))));
+
+        BatchWriteItemResult result;
+        result.AddUnprocessedItems(kTableName, {write_requests[1]});
+        callback(nullptr /*dynamo_client*/, batch_write_item_request,
+                 BatchWriteItemOutcome(result), nullptr /*caller_context*/);
+      })
+      .WillOnce([](const auto& batch_write_item_request, const auto& callback,
+                   const auto&) {
+        const auto& write_requests =
+            batch_write_item_request.GetRequestItems().at(kTableName);
+        ASSERT_EQ(write_requests.size(), 1);
+        EXPECT_THAT(write_requests[0].GetPutRequest().GetItem(),
+                    UnorderedElementsAre(Pair("Col1", HasNumber("2")),
+                                         Pair("Attr1", HasNumber("20"))));
+
+        AWSError<DynamoDBErrors> dynamo_db_error(DynamoDBErrors::BACKUP_IN_USE,
+                                                 false);
+        callback(nullptr /*dynamo_client*/, batch_write_item_request,
+                 BatchWriteItemOutcome(dynamo_db_error),
+                 nullptr /*caller_context*/);
+      });
+
+  batch_upsert_database_items_context_.callback =
+      [this](AsyncContext<BatchUpsertDatabaseItemsRequest,
+                          BatchUpsertDatabaseItemsResponse>& context) {
+        EXPECT_SUCCESS(context.result);
+        ASSERT_EQ(context.response->responses().size(), 2);
+        EXPECT_SUCCESS(
+            ExecutionResult(context.response->responses(0).result()));
+        EXPECT_THAT(ExecutionResult(context.response->responses(1).result()),
+                    ResultIs(FailureExecutionResult(
+                        SC_NO_SQL_DATABASE_PROVIDER_UNRETRIABLE_ERROR)));
+        finish_called_ = true;
+      };
+
+  EXPECT_THAT(client_provider_.BatchUpsertDatabaseItems(
+                  batch_upsert_database_items_context_),
+              IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(AwsDynamoDBClientProviderTest,
+       BatchUpsertDatabaseItemsRejectsRepeatedItems) {
+  for (int i = 0; i < 2; ++i) {
+    *batch_upsert_database_items_context_.request->add_requests()
+         ->mutable_key() = MakeIntKey(1);
+  }
+
+  EXPECT_CALL(*dynamo_db_, BatchWriteItemAsync).Times(0);
+
+  EXPECT_THAT(client_provider_.BatchUpsertDatabaseItems(
+                  batch_upsert_database_items_context_),
+              ResultIs(FailureExecutionResult(
+                  SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH)));
+}
+
 }  // namespace google::scp::cpio::client_providers::test
@@ -113,6 +113,16 @@ TEST(AwsDynamoDBUtilsTests, ConvertDynamoDBTypeToItemAttributeString) {
       IsSuccessfulAndHolds(HasValueString("hello world!")));
 }
 
+TEST(AwsDynamoDBUtilsTests,
+     ConvertDynamoDBTypeToItemAttributeStringWithEmbeddedNull) {
+  AttributeValue attribute_value;
+  attribute_value.SetS(String("hello\0world", 11));
+
+  EXPECT_THAT(
+      AwsDynamoDBUtils::ConvertDynamoDBTypeToItemAttribute(attribute_value),
+      IsSuccessfulAndHolds(HasValueString(std::string("hello\0world", 11))));
+}
+
 void SetValueType(AttributeValue& attribute_value, ValueType type) {
   switch (type) {
     case ValueType::BYTEBUFFER:
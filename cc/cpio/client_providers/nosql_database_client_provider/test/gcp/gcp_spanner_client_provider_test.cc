@@ -35,16 +35,20 @@
 #include "cpio/client_providers/instance_client_provider/mock/mock_instance_client_provider.h"
 #include "cpio/client_providers/nosql_database_client_provider/src/common/error_codes.h"
 #include "cpio/common/src/gcp/error_codes.h"
+#include "google/cloud/grpc_options.h"
 #include "google/cloud/spanner/admin/mocks/mock_database_admin_connection.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/mocks/mock_spanner_connection.h"
 #include "google/cloud/spanner/mocks/row.h"
 #include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/options.h"
 #include "google/cloud/status.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 
 using google::cloud::make_ready_future;
+using google::cloud::GrpcNumChannelsOption;
+using google::cloud::Options;
 using google::cloud::Status;
 using google::cloud::StatusOr;
 using google::cloud::spanner::Client;
@@ -54,6 +58,7 @@ using google::cloud::spanner::MakeInsertOrUpdateMutation;
 using google::cloud::spanner::Mutation;
 using google::cloud::spanner::Row;
 using google::cloud::spanner::RowStream;
+using google::cloud::spanner::SessionPoolMinSessionsOption;
 using google::cloud::spanner::SqlStatement;
 using google::cloud::spanner::Value;
 using google::cloud::spanner_admin::DatabaseAdminClient;
@@ -61,6 +66,14 @@ using google::cloud::spanner_admin_mocks::MockDatabaseAdminConnection;
 using google::cloud::spanner_mocks::MakeRow;
 using google::cloud::spanner_mocks::MockConnection;
 using google::cloud::spanner_mocks::MockResultSetSource;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchGetDatabaseItemsResponse;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsRequest;
+using google::cmrt::sdk::nosql_database_service::v1::
+    BatchUpsertDatabaseItemsResponse;
 using google::cmrt::sdk::nosql_database_service::v1::CreateTableRequest;
 using google::cmrt::sdk::nosql_database_service::v1::CreateTableResponse;
 using google::cmrt::sdk::nosql_database_service::v1::DeleteTableRequest;
@@ -72,6 +85,7 @@ using google::cmrt::sdk::nosql_database_service::v1::ItemKey;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemRequest;
 using google::cmrt::sdk::nosql_database_service::v1::UpsertDatabaseItemResponse;
 using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::RetryExecutionResult;
@@ -80,7 +94,10 @@ using google::scp::core::errors::SC_GCP_INTERNAL_SERVICE_ERROR;
 using google::scp::core::errors::SC_GCP_UNKNOWN;
 using google::scp::core::errors::
     SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_CHECKED_FAILED;
+using google::scp::core::errors::
+    SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_REPLACE;
 using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_EMPTY_TABLE_NAME;
+using google::scp::core::errors::SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH;
 using google::scp::core::errors::
     SC_NO_SQL_DATABASE_PROVIDER_INVALID_PARTITION_KEY_NAME;
 using google::scp::core::errors::
@@ -118,6 +135,7 @@ using testing::NiceMock;
 using testing::NotNull;
 using testing::PrintToString;
 using testing::Return;
+using testing::Truly;
 using testing::UnorderedElementsAre;
 
 namespace {
@@ -171,7 +189,9 @@ class MockSpannerFactory : public SpannerFactory {
  public:
   MOCK_METHOD((ExecutionResultOr<
                   pair<shared_ptr<Client>, shared_ptr<DatabaseAdminClient>>>),
-              CreateClients, (const string&, const string&, const string&),
+              CreateClients,
+              (const string&, const string&, const string&,
+               google::cloud::Options),
               (noexcept, override));
 };
 
@@ -225,6 +245,12 @@ class GcpSpannerTests : public testing::Test {
       finish_called_ = true;
     };
 
+    batch_get_database_items_context_.request =
+        make_shared<BatchGetDatabaseItemsRequest>();
+
+    batch_upsert_database_items_context_.request =
+        make_shared<BatchUpsertDatabaseItemsRequest>();
+
     ON_CALL(*connection_, Commit).WillByDefault(Return(CommitResult{}));
     ON_CALL(*spanner_factory_, CreateClients)
         .WillByDefault(Return(
@@ -250,6 +276,13 @@ class GcpSpannerTests : public testing::Test {
 
   AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>
       upsert_database_item_context_;
+
+  AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+      batch_get_database_items_context_;
+
+  AsyncContext<BatchUpsertDatabaseItemsRequest,
+               BatchUpsertDatabaseItemsResponse>
+      batch_upsert_database_items_context_;
   // We check that this gets flipped after every call to ensure the context's
   // Finish() is called.
   std::atomic_bool finish_called_{false};
@@ -269,6 +302,37 @@ TEST_F(GcpSpannerTests, InitWithGetProjectIdFailure) {
   EXPECT_THAT(gcp_spanner.Run(), ResultIs(FailureExecutionResult(123)));
 }
 
+TEST_F(GcpSpannerTests, RunAppliesConnectionOptionsAndWarmsUp) {
+  auto options = make_shared<NoSQLDatabaseClientOptions>(
+      NoSQLDatabaseClientOptions{"instance", "database", nullptr});
+  options->spanner_min_sessions = 10;
+  options->spanner_num_channels = 2;
+  options->spanner_warm_up_enabled = true;
+  GcpSpannerClientProvider gcp_spanner(
+      options, instance_client_, make_shared<MockAsyncExecutor>(),
+      make_shared<MockAsyncExecutor>(), spanner_factory_);
+
+  auto has_connection_options = [](const Options& connection_options) {
+    return connection_options.get<SessionPoolMinSessionsOption>() == 10 &&
+           connection_options.get<GrpcNumChannelsOption>() == 2;
+  };
+  EXPECT_CALL(*spanner_factory_,
+              CreateClients(_, "instance", "database",
+                            Truly(has_connection_options)))
+      .WillOnce(Return(
+          make_pair(make_shared<Client>(connection_),
+                    make_shared<DatabaseAdminClient>(database_connection_))));
+  auto returned_results = make_unique<MockResultSetSource>();
+  EXPECT_CALL(*returned_results, NextRow)
+      .WillOnce(Return(MakeRow(Json("1"))))
+      .WillRepeatedly(Return(Row()));
+  EXPECT_CALL(*connection_, ExecuteQuery(SqlEqual(SqlStatement("SELECT 1"))))
+      .WillOnce(Return(ByMove(RowStream(std::move(returned_results)))));
+
+  EXPECT_SUCCESS(gcp_spanner.Init());
+  EXPECT_SUCCESS(gcp_spanner.Run());
+}
+
 TEST_F(GcpSpannerTests, CreateTableNoSortKeySuccess) {
   create_table_context_.request->mutable_key()->set_table_name(
       kPartitionLockTableName);
@@ -1171,6 +1235,102 @@ TEST_F(GcpSpannerTests, UpsertItemWithAttributesFailsIfCommitFails) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(GcpSpannerTests, UpsertItemReplacingAttributesDoesNotReadRow) {
+  upsert_database_item_context_.request->mutable_key()->set_table_name(
+      kPartitionLockTableName);
+  upsert_database_item_context_.request->mutable_key()
+      ->mutable_partition_key()
+      ->CopyFrom(MakeStringAttribute(kPartitionLockPartitionKeyName, "3"));
+  upsert_database_item_context_.request->add_new_attributes()->CopyFrom(
+      MakeStringAttribute("token_count", "1"));
+  upsert_database_item_context_.request->set_replace_existing_attributes(true);
+
+  EXPECT_CALL(*connection_, ExecuteQuery).Times(0);
+  Mutation m = MakeInsertOrUpdateMutation(
+      kPartitionLockTableName, {kPartitionLockPartitionKeyName, "Value"},
+      Value("3"), Value(Json("{\"token_count\":\"1\"}")));
+  EXPECT_CALL(*connection_, Commit(FieldsAre(_, UnorderedElementsAre(m), _)))
+      .WillOnce(Return(CommitResult{}));
+
+  upsert_database_item_context_.callback = [this](auto& context) {
+    EXPECT_SUCCESS(context.result);
+    finish_called_ = true;
+  };
+
+  EXPECT_THAT(gcp_spanner_.UpsertDatabaseItem(upsert_database_item_context_),
+              IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(GcpSpannerTests, UpsertItemReplacingAttributesFailsIfConditional) {
+  upsert_database_item_context_.request->mutable_key()->set_table_name(
+      kPartitionLockTableName);
+  upsert_database_item_context_.request->mutable_key()
+      ->mutable_partition_key()
+      ->CopyFrom(MakeStringAttribute(kPartitionLockPartitionKeyName, "3"));
+  upsert_database_item_context_.request->add_required_attributes()->CopyFrom(
+      MakeStringAttribute("token_count", "1"));
+  upsert_database_item_context_.request->set_replace_existing_attributes(true);
+
+  EXPECT_THAT(gcp_spanner_.UpsertDatabaseItem(upsert_database_item_context_),
+              ResultIs(FailureExecutionResult(
+                  SC_NO_SQL_DATABASE_PROVIDER_CONDITIONAL_REPLACE)));
+
+  EXPECT_TRUE(finish_called_);
+}
+
+TEST_F(GcpSpannerTests, UpsertItemWithUpsertCacheReadsRowOnce) {
+  auto options = make_shared<NoSQLDatabaseClientOptions>(
+      NoSQLDatabaseClientOptions{"instance", "database", nullptr});
+  options->spanner_upsert_cache_capacity = 10;
+  GcpSpannerClientProvider gcp_spanner(
+      options, instance_client_, make_shared<MockAsyncExecutor>(),
+      make_shared<MockAsyncExecutor>(), spanner_factory_);
+  EXPECT_SUCCESS(gcp_spanner.Init());
+  EXPECT_SUCCESS(gcp_spanner.Run());
+
+  auto returned_results = make_unique<MockResultSetSource>();
+  EXPECT_CALL(*returned_results, NextRow)
+      .WillOnce(Return(MakeRow(Json(R"""({"other_val": "10"})"""))))
+      .WillRepeatedly(Return(Row()));
+  // Only the first upsert reads the row.
+  EXPECT_CALL(*connection_, ExecuteQuery)
+      .WillOnce(Return(ByMove(RowStream(move(returned_results)))));
+
+  testing::InSequence sequence;
+  for (const auto& token_count : {"1", "2"}) {
+    Mutation m = MakeInsertOrUpdateMutation(
+        kPartitionLockTableName, {kPartitionLockPartitionKeyName, "Value"},
+        Value("3"),
+        Value(Json(absl::StrFormat(
+            "{\"other_val\":\"10\",\"token_count\":\"%s\"}",
+            token_count))));
+    EXPECT_CALL(*connection_,
+                Commit(FieldsAre(_, UnorderedElementsAre(m), _)))
+        .WillOnce(Return(CommitResult{}));
+  }
+
+  for (const auto& token_count : {"1", "2"}) {
+    AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>
+        context;
+    context.request = make_shared<UpsertDatabaseItemRequest>();
+    context.request->mutable_key()->set_table_name(kPartitionLockTableName);
+    context.request->mutable_key()->mutable_partition_key()->CopyFrom(
+        MakeStringAttribute(kPartitionLockPartitionKeyName, "3"));
+    context.request->add_new_attributes()->CopyFrom(
+        MakeStringAttribute("token_count", token_count));
+    std::atomic_bool is_finished{false};
+    context.callback = [&](auto& upsert_context) {
+      EXPECT_SUCCESS(upsert_context.result);
+      is_finished = true;
+    };
+
+    EXPECT_THAT(gcp_spanner.UpsertDatabaseItem(context), IsSuccessful());
+    WaitUntil([&]() { return is_finished.load(); });
+  }
+}
+
 TEST_F(GcpSpannerTests, UpsertItemFailsIfBadPartitionKey) {
   upsert_database_item_context_.request->mutable_key()
       ->mutable_partition_key()
@@ -1196,4 +1356,135 @@ TEST_F(GcpSpannerTests, UpsertItemFailsIfBadSortKey) {
   EXPECT_TRUE(finish_called_);
 }
 
+TEST_F(GcpSpannerTests, BatchGetItemsRunsOneQueryPerTable) {
+  for (const auto& partition_key_value : {"3", "4"}) {
+    auto& key =
+        *batch_get_database_items_context_.request->add_requests()
+             ->mutable_key();
+    key.set_table_name(kBudgetKeyTableName);
+    *key.mutable_partition_key() =
+        MakeStringAttribute(kBudgetKeyPartitionKeyName, partition_key_value);
+    *key.mutable_sort_key() = MakeStringAttribute(kBudgetKeySortKeyName, "2");
+  }
+  auto& lock_key =
+      *batch_get_database_items_context_.request->add_requests()
+           ->mutable_key();
+  lock_key.set_table_name(kPartitionLockTableName);
+  *lock_key.mutable_partition_key() =
+      MakeStringAttribute(kPartitionLockPartitionKeyName, "5");
+
+  SqlStatement::ParamType budget_key_params;
+  budget_key_params.emplace("partition_key_0", "3");
+  budget_key_params.emplace("sort_key_0", "2");
+  budget_key_params.emplace("partition_key_1", "4");
+  budget_key_params.emplace("sort_key_1", "2");
+  SqlStatement budget_key_sql(
+      "SELECT BudgetKeyId, Timeframe, IFNULL(Value, JSON '{}') FROM "
+      "`BudgetKeys` WHERE (BudgetKeyId = @partition_key_0 AND Timeframe = "
+      "@sort_key_0) OR (BudgetKeyId = @partition_key_1 AND Timeframe = "
+      "@sort_key_1)",
+      budget_key_params);
+  auto budget_key_results = make_unique<MockResultSetSource>();
+  EXPECT_CALL(*budget_key_results, NextRow)
+      .WillOnce(Return(MakeRow("4", "2", Json(R"({"token_count": "1"})"))))
+      .WillRepeatedly(Return(Row()));
+  EXPECT_CALL(*connection_, ExecuteQuery(SqlEqual(budget_key_sql)))
+      .WillOnce(Return(ByMove(RowStream(move(budget_key_results)))));
+
+  SqlStatement::ParamType lock_params;
+  lock_params.emplace("partition_key_0", "5");
+  SqlStatement lock_sql(
+      "SELECT LockId, IFNULL(Value, JSON '{}') FROM `PartitionLock` WHERE "
+      "(LockId = @partition_key_0)",
+      lock_params);
+  auto lock_results = make_unique<MockResultSetSource>();
+  EXPECT_CALL(*lock_results, NextRow)
+      .WillOnce(Return(MakeRow("5", Json(R"({"lease_owner": "a"})"))))
+      .WillRepeatedly(Return(Row()));
+  EXPECT_CALL(*connection_, ExecuteQuery(SqlEqual(lock_sql)))
+      .WillOnce(Return(ByMove(RowStream(move(lock_results)))));
+
+  batch_get_database_items_context_.callback = [this](auto& context) {
+    EXPECT_SUCCESS(context.result);
+    ASSERT_THAT(context.response, NotNull());
+    const auto& responses = context.response->responses();
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_THAT(ExecutionResult(responses[0].result()),
+                ResultIs(FailureExecutionResult(
+                    SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND)));
+    EXPECT_SUCCESS(ExecutionResult(responses[1].result()));
+    EXPECT_THAT(responses[1].item().key().partition_key(),
+                IsStringAttribute(kBudgetKeyPartitionKeyName, "4"));
+    EXPECT_THAT(responses[1].item().attributes(),
+                UnorderedElementsAre(IsStringAttribute("token_count", "1")));
+    EXPECT_SUCCESS(ExecutionResult(responses[2].result()));
+    EXPECT_THAT(responses[2].item().attributes(),
+                UnorderedElementsAre(IsStringAttribute("lease_owner", "a")));
+
+    finish_called_ = true;
+  };
+
+  EXPECT_THAT(
+      gcp_spanner_.BatchGetDatabaseItems(batch_get_database_items_context_),
+      IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(GcpSpannerTests, BatchUpsertItemsCommitsAllMutationsAtOnce) {
+  for (const auto& partition_key_value : {"3", "4"}) {
+    auto& request =
+        *batch_upsert_database_items_context_.request->add_requests();
+    request.mutable_key()->set_table_name(kPartitionLockTableName);
+    *request.mutable_key()->mutable_partition_key() = MakeStringAttribute(
+        kPartitionLockPartitionKeyName, partition_key_value);
+    *request.add_new_attributes() = MakeStringAttribute("token_count", "1");
+  }
+
+  // The items are written without being read first.
+  EXPECT_CALL(*connection_, ExecuteQuery).Times(0);
+  Mutation m1 = MakeInsertOrUpdateMutation(
+      kPartitionLockTableName, {kPartitionLockPartitionKeyName, "Value"},
+      Value("3"), Value(Json("{\"token_count\":\"1\"}")));
+  Mutation m2 = MakeInsertOrUpdateMutation(
+      kPartitionLockTableName, {kPartitionLockPartitionKeyName, "Value"},
+      Value("4"), Value(Json("{\"token_count\":\"1\"}")));
+  EXPECT_CALL(*connection_,
+              Commit(FieldsAre(_, UnorderedElementsAre(m1, m2), _)))
+      .WillOnce(Return(CommitResult{}));
+
+  batch_upsert_database_items_context_.callback = [this](auto& context) {
+    EXPECT_SUCCESS(context.result);
+    ASSERT_THAT(context.response, NotNull());
+    ASSERT_EQ(context.response->responses().size(), 2);
+    EXPECT_SUCCESS(ExecutionResult(context.response->responses(0).result()));
+    EXPECT_SUCCESS(ExecutionResult(context.response->responses(1).result()));
+
+    finish_called_ = true;
+  };
+
+  EXPECT_THAT(gcp_spanner_.BatchUpsertDatabaseItems(
+                  batch_upsert_database_items_context_),
+              IsSuccessful());
+
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
+TEST_F(GcpSpannerTests, BatchUpsertItemsFailsIfRepeatedItem) {
+  for (int i = 0; i < 2; ++i) {
+    auto& key = *batch_upsert_database_items_context_.request->add_requests()
+                     ->mutable_key();
+    key.set_table_name(kPartitionLockTableName);
+    *key.mutable_partition_key() =
+        MakeStringAttribute(kPartitionLockPartitionKeyName, "3");
+  }
+
+  EXPECT_CALL(*connection_, Commit).Times(0);
+
+  EXPECT_THAT(gcp_spanner_.BatchUpsertDatabaseItems(
+                  batch_upsert_database_items_context_),
+              ResultIs(FailureExecutionResult(
+                  SC_NO_SQL_DATABASE_PROVIDER_INVALID_BATCH)));
+}
+
 }  // namespace google::scp::cpio::client_providers::test
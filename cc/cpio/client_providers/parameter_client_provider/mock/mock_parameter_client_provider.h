@@ -43,5 +43,11 @@ class MockParameterClientProvider : public ParameterClientProviderInterface {
                   cmrt::sdk::parameter_service::v1::GetParameterRequest,
                   cmrt::sdk::parameter_service::v1::GetParameterResponse>&)),
               (override, noexcept));
+
+  MOCK_METHOD(core::ExecutionResult, GetParameters,
+              ((core::AsyncContext<
+                  cmrt::sdk::parameter_service::v1::GetParametersRequest,
+                  cmrt::sdk::parameter_service::v1::GetParametersResponse>&)),
+              (override, noexcept));
 };
 }  // namespace google::scp::cpio::client_providers::mock
@@ -18,6 +18,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,6 +46,7 @@ using Aws::SSM::Model::GetParametersOutcome;
 using Aws::SSM::Model::GetParametersRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterResponse;
+using google::cmrt::sdk::parameter_service::v1::GetParametersResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::ExecutionResult;
@@ -59,9 +62,12 @@ using google::scp::core::errors::
     SC_AWS_PARAMETER_CLIENT_PROVIDER_PARAMETER_NOT_FOUND;
 using google::scp::cpio::client_providers::AwsInstanceClientUtils;
 using google::scp::cpio::common::CreateClientConfiguration;
+using std::lock_guard;
 using std::make_shared;
 using std::map;
 using std::move;
+using std::mutex;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -73,6 +79,8 @@ using std::placeholders::_4;
 /// Filename for logging errors
 static constexpr char kAwsParameterClientProvider[] =
     "AwsParameterClientProvider";
+/// The maximum number of names SSM GetParameters accepts in one call.
+static constexpr size_t kSsmGetParametersMaxNames = 10;
 
 namespace google::scp::cpio::client_providers {
 shared_ptr<ClientConfiguration>
@@ -176,6 +184,90 @@ void AwsParameterClientProvider::OnGetParametersCallback(
   list_parameters_context.Finish();
 }
 
+ExecutionResult AwsParameterClientProvider::GetParameters(
+    AsyncContext<cmrt::sdk::parameter_service::v1::GetParametersRequest,
+                 GetParametersResponse>& get_parameters_context) noexcept {
+  set<string> parameter_names;
+  for (const auto& parameter_name :
+       get_parameters_context.request->parameter_names()) {
+    if (parameter_name.empty()) {
+      auto execution_result = FailureExecutionResult(
+          SC_AWS_PARAMETER_CLIENT_PROVIDER_INVALID_PARAMETER_NAME);
+      SCP_ERROR_CONTEXT(kAwsParameterClientProvider, get_parameters_context,
+                        execution_result,
+                        "Failed due to an empty parameter name.");
+      get_parameters_context.result = execution_result;
+      get_parameters_context.Finish();
+      return execution_result;
+    }
+    parameter_names.insert(parameter_name);
+  }
+
+  if (parameter_names.empty()) {
+    get_parameters_context.response = make_shared<GetParametersResponse>();
+    get_parameters_context.result = SuccessExecutionResult();
+    get_parameters_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  // SSM limits the number of names per call, so the names are split into
+  // chunks which are all issued at once.
+  vector<GetParametersRequest> requests;
+  for (auto it = parameter_names.begin(); it != parameter_names.end();) {
+    GetParametersRequest request;
+    for (size_t i = 0;
+         i < kSsmGetParametersMaxNames && it != parameter_names.end();
+         ++i, ++it) {
+      request.AddNames(it->c_str());
+    }
+    requests.push_back(move(request));
+  }
+
+  auto batch = make_shared<GetParametersBatch>(requests.size());
+  for (const auto& request : requests) {
+    ssm_client_->GetParametersAsync(
+        request,
+        bind(&AwsParameterClientProvider::OnGetParametersBatchCallback, this,
+             get_parameters_context, batch, _1, _2, _3, _4),
+        nullptr);
+  }
+
+  return SuccessExecutionResult();
+}
+
+void AwsParameterClientProvider::OnGetParametersBatchCallback(
+    AsyncContext<cmrt::sdk::parameter_service::v1::GetParametersRequest,
+                 GetParametersResponse>& get_parameters_context,
+    const shared_ptr<GetParametersBatch>& batch, const Aws::SSM::SSMClient*,
+    const GetParametersRequest&, const GetParametersOutcome& outcome,
+    const shared_ptr<const AsyncCallerContext>&) noexcept {
+  {
+    lock_guard<mutex> lock(batch->mutex);
+    if (!outcome.IsSuccess()) {
+      batch->result = SSMErrorConverter::ConvertSSMError(
+          outcome.GetError().GetErrorType(), outcome.GetError().GetMessage());
+    } else {
+      auto& parameters = *batch->response->mutable_parameters();
+      for (const auto& parameter : outcome.GetResult().GetParameters()) {
+        parameters[parameter.GetName().c_str()] = parameter.GetValue().c_str();
+      }
+    }
+  }
+
+  if (batch->pending_calls.fetch_sub(1) != 1) {
+    return;
+  }
+
+  if (!batch->result.Successful()) {
+    SCP_ERROR_CONTEXT(kAwsParameterClientProvider, get_parameters_context,
+                      batch->result, "Failed to get the parameter values.");
+  } else {
+    get_parameters_context.response = batch->response;
+  }
+  get_parameters_context.result = batch->result;
+  get_parameters_context.Finish();
+}
+
 shared_ptr<SSMClient> SSMClientFactory::CreateSSMClient(
     ClientConfiguration& client_config,
     const shared_ptr<AsyncExecutorInterface>& io_async_executor) noexcept {
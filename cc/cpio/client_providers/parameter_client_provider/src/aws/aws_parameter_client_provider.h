@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -69,7 +71,47 @@ class AwsParameterClientProvider : public ParameterClientProviderInterface {
           cmrt::sdk::parameter_service::v1::GetParameterResponse>&
           context) noexcept override;
 
+  core::ExecutionResult GetParameters(
+      core::AsyncContext<
+          cmrt::sdk::parameter_service::v1::GetParametersRequest,
+          cmrt::sdk::parameter_service::v1::GetParametersResponse>&
+          context) noexcept override;
+
  protected:
+  /// Tracks the SSM GetParameters calls a single GetParameters request is
+  /// split into.
+  struct GetParametersBatch {
+    explicit GetParametersBatch(size_t pending_calls)
+        : pending_calls(pending_calls) {}
+
+    /// The number of SSM calls which have not completed yet.
+    std::atomic<size_t> pending_calls;
+    /// Guards response and result.
+    std::mutex mutex;
+    std::shared_ptr<cmrt::sdk::parameter_service::v1::GetParametersResponse>
+        response = std::make_shared<
+            cmrt::sdk::parameter_service::v1::GetParametersResponse>();
+    core::ExecutionResult result = core::SuccessExecutionResult();
+  };
+
+  /**
+   * @brief Is called after one of the AWS GetParameters calls of a batch is
+   * completed. Finishes the context once all the calls of the batch are done.
+   *
+   * @param get_parameters_context the get parameters operation context.
+   * @param batch the batch the call belongs to.
+   * @param outcome the operation outcome of AWS GetParameters.
+   */
+  virtual void OnGetParametersBatchCallback(
+      core::AsyncContext<
+          cmrt::sdk::parameter_service::v1::GetParametersRequest,
+          cmrt::sdk::parameter_service::v1::GetParametersResponse>&
+          get_parameters_context,
+      const std::shared_ptr<GetParametersBatch>& batch,
+      const Aws::SSM::SSMClient*, const Aws::SSM::Model::GetParametersRequest&,
+      const Aws::SSM::Model::GetParametersOutcome& outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>&) noexcept;
+
   /**
    * @brief Is called after AWS GetParameters call is completed.
    *
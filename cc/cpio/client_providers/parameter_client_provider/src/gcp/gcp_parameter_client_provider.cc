@@ -17,6 +17,8 @@
 #include "gcp_parameter_client_provider.h"
 
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -41,6 +43,8 @@ using google::cloud::secretmanager::v1::AccessSecretVersionRequest;
 using google::cloud::secretmanager::v1::AccessSecretVersionResponse;
 using google::cmrt::sdk::parameter_service::v1::GetParameterRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterResponse;
+using google::cmrt::sdk::parameter_service::v1::GetParametersRequest;
+using google::cmrt::sdk::parameter_service::v1::GetParametersResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
@@ -54,8 +58,11 @@ using google::scp::core::errors::
 using google::scp::cpio::client_providers::GcpInstanceClientUtils;
 using google::scp::cpio::common::GcpUtils;
 using std::bind;
+using std::lock_guard;
 using std::make_shared;
 using std::move;
+using std::mutex;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::placeholders::_1;
@@ -167,6 +174,98 @@ void GcpParameterClientProvider::AsyncGetParameterCallback(
                 async_executor_);
 }
 
+ExecutionResult GcpParameterClientProvider::GetParameters(
+    AsyncContext<GetParametersRequest, GetParametersResponse>&
+        get_parameters_context) noexcept {
+  set<string> parameter_names;
+  for (const auto& parameter_name :
+       get_parameters_context.request->parameter_names()) {
+    if (parameter_name.empty()) {
+      auto execution_result = FailureExecutionResult(
+          SC_GCP_PARAMETER_CLIENT_PROVIDER_INVALID_PARAMETER_NAME);
+      SCP_ERROR_CONTEXT(kGcpParameterClientProvider, get_parameters_context,
+                        execution_result, "Failed due to an empty parameter.");
+      get_parameters_context.result = execution_result;
+      get_parameters_context.Finish();
+      return execution_result;
+    }
+    parameter_names.insert(parameter_name);
+  }
+
+  if (parameter_names.empty()) {
+    get_parameters_context.response = make_shared<GetParametersResponse>();
+    get_parameters_context.result = SuccessExecutionResult();
+    get_parameters_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  // Secret Manager has no batch read, so every secret is accessed in parallel
+  // on the IO executor.
+  auto batch = make_shared<GetParametersBatch>(parameter_names.size());
+  for (const auto& parameter_name : parameter_names) {
+    auto schedule_result = io_async_executor_->Schedule(
+        bind(&GcpParameterClientProvider::AsyncGetParametersCallback, this,
+             get_parameters_context, batch, parameter_name),
+        AsyncPriority::Normal);
+    if (!schedule_result.Successful()) {
+      SCP_ERROR_CONTEXT(kGcpParameterClientProvider, get_parameters_context,
+                        schedule_result,
+                        "Failed to schedule AsyncGetParametersCallback().");
+      {
+        lock_guard<mutex> lock(batch->mutex);
+        batch->result = schedule_result;
+      }
+      FinishGetParametersBatchIfDone(get_parameters_context, batch);
+    }
+  }
+
+  return SuccessExecutionResult();
+}
+
+void GcpParameterClientProvider::AsyncGetParametersCallback(
+    AsyncContext<GetParametersRequest, GetParametersResponse>&
+        get_parameters_context,
+    const shared_ptr<GetParametersBatch>& batch,
+    const string& parameter_name) noexcept {
+  SecretManagerServiceClient client(*sm_client_shared_);
+
+  AccessSecretVersionRequest access_secret_request;
+  access_secret_request.set_name(
+      StrFormat(kGcpSecretNameFormatString, project_id_, parameter_name));
+  auto secret_result = client.AccessSecretVersion(access_secret_request);
+
+  {
+    lock_guard<mutex> lock(batch->mutex);
+    if (secret_result.ok()) {
+      (*batch->response->mutable_parameters())[parameter_name] =
+          secret_result->payload().data();
+    } else if (secret_result.status().code() != StatusCode::kNotFound) {
+      // Missing secrets are left out of the response, any other error fails
+      // the whole batch.
+      batch->result = GcpUtils::GcpErrorConverter(secret_result.status());
+      SCP_ERROR_CONTEXT(kGcpParameterClientProvider, get_parameters_context,
+                        batch->result, "Failed to get parameter with %s",
+                        secret_result.status().message().c_str());
+    }
+  }
+
+  FinishGetParametersBatchIfDone(get_parameters_context, batch);
+}
+
+void GcpParameterClientProvider::FinishGetParametersBatchIfDone(
+    AsyncContext<GetParametersRequest, GetParametersResponse>&
+        get_parameters_context,
+    const shared_ptr<GetParametersBatch>& batch) noexcept {
+  if (batch->pending_calls.fetch_sub(1) != 1) {
+    return;
+  }
+
+  if (batch->result.Successful()) {
+    get_parameters_context.response = batch->response;
+  }
+  FinishContext(batch->result, get_parameters_context, async_executor_);
+}
+
 #ifndef TEST_CPIO
 shared_ptr<ParameterClientProviderInterface>
 ParameterClientProviderFactory::Create(
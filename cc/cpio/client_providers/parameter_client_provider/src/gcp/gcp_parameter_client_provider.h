@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -67,6 +69,12 @@ class GcpParameterClientProvider : public ParameterClientProviderInterface {
           cmrt::sdk::parameter_service::v1::GetParameterResponse>&
           get_parameter_context) noexcept override;
 
+  core::ExecutionResult GetParameters(
+      core::AsyncContext<
+          cmrt::sdk::parameter_service::v1::GetParametersRequest,
+          cmrt::sdk::parameter_service::v1::GetParametersResponse>&
+          get_parameters_context) noexcept override;
+
  protected:
   /**
    * @brief Get the default Secret Manager Service Client object.
@@ -95,6 +103,45 @@ class GcpParameterClientProvider : public ParameterClientProviderInterface {
           access_secret_request) noexcept;
 
   /// Project ID of current instance.
+  /// Tracks the secret accesses a single GetParameters request is split into.
+  struct GetParametersBatch {
+    explicit GetParametersBatch(size_t pending_calls)
+        : pending_calls(pending_calls) {}
+
+    /// The number of secret accesses which have not completed yet.
+    std::atomic<size_t> pending_calls;
+    /// Guards response and result.
+    std::mutex mutex;
+    std::shared_ptr<cmrt::sdk::parameter_service::v1::GetParametersResponse>
+        response = std::make_shared<
+            cmrt::sdk::parameter_service::v1::GetParametersResponse>();
+    core::ExecutionResult result = core::SuccessExecutionResult();
+  };
+
+  /**
+   * @brief Accesses one secret of a GetParameters batch. Finishes the context
+   * once all the secrets of the batch are accessed.
+   *
+   * @param get_parameters_context the get parameters operation context.
+   * @param batch the batch the secret belongs to.
+   * @param parameter_name the name of the parameter to access.
+   */
+  void AsyncGetParametersCallback(
+      core::AsyncContext<
+          cmrt::sdk::parameter_service::v1::GetParametersRequest,
+          cmrt::sdk::parameter_service::v1::GetParametersResponse>&
+          get_parameters_context,
+      const std::shared_ptr<GetParametersBatch>& batch,
+      const std::string& parameter_name) noexcept;
+
+  /// Finishes the context of the batch if the given call was its last one.
+  void FinishGetParametersBatchIfDone(
+      core::AsyncContext<
+          cmrt::sdk::parameter_service::v1::GetParametersRequest,
+          cmrt::sdk::parameter_service::v1::GetParametersResponse>&
+          get_parameters_context,
+      const std::shared_ptr<GetParametersBatch>& batch) noexcept;
+
   std::string project_id_;
 
   /// An instance of the async executor.
@@ -50,6 +50,7 @@ using Aws::SSM::Model::GetParametersResult;
 using Aws::SSM::Model::Parameter;
 using google::cmrt::sdk::parameter_service::v1::GetParameterRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterResponse;
+using google::cmrt::sdk::parameter_service::v1::GetParametersResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::ExecutionStatus;
@@ -76,7 +77,9 @@ using std::string;
 using std::unique_ptr;
 using std::vector;
 using testing::NiceMock;
+using testing::Pair;
 using testing::Return;
+using testing::UnorderedElementsAre;
 
 namespace {
 constexpr char kResourceNameMock[] =
@@ -274,4 +277,60 @@ TEST_F(AwsParameterClientProviderTest, SucceedToFetchParameter) {
   EXPECT_SUCCESS(client_->GetParameter(context1));
   WaitUntil([&]() { return condition.load(); });
 }
+
+TEST_F(AwsParameterClientProviderTest, GetParametersOmitsMissingParameters) {
+  EXPECT_SUCCESS(client_->Init());
+  EXPECT_SUCCESS(client_->Run());
+
+  MockParameters();
+  GetParametersRequest get_parameters_request;
+  get_parameters_request.AddNames(kParameterName);
+  get_parameters_request.AddNames("missing");
+  mock_ssm_client_->get_parameters_request_mock = get_parameters_request;
+
+  atomic<bool> condition = false;
+  auto request =
+      make_shared<cmrt::sdk::parameter_service::v1::GetParametersRequest>();
+  request->add_parameter_names(kParameterName);
+  request->add_parameter_names("missing");
+  request->add_parameter_names(kParameterName);
+  AsyncContext<cmrt::sdk::parameter_service::v1::GetParametersRequest,
+               GetParametersResponse>
+      context(move(request),
+              [&](AsyncContext<
+                  cmrt::sdk::parameter_service::v1::GetParametersRequest,
+                  GetParametersResponse>& context) {
+                EXPECT_SUCCESS(context.result);
+                EXPECT_THAT(context.response->parameters(),
+                            UnorderedElementsAre(
+                                Pair(kParameterName, kParameterValue)));
+                condition = true;
+              });
+  EXPECT_SUCCESS(client_->GetParameters(context));
+  WaitUntil([&]() { return condition.load(); });
+}
+
+TEST_F(AwsParameterClientProviderTest, GetParametersInvalidParameterName) {
+  EXPECT_SUCCESS(client_->Init());
+  EXPECT_SUCCESS(client_->Run());
+
+  auto failure = FailureExecutionResult(
+      SC_AWS_PARAMETER_CLIENT_PROVIDER_INVALID_PARAMETER_NAME);
+  atomic<bool> condition = false;
+  auto request =
+      make_shared<cmrt::sdk::parameter_service::v1::GetParametersRequest>();
+  request->add_parameter_names(kParameterName);
+  request->add_parameter_names("");
+  AsyncContext<cmrt::sdk::parameter_service::v1::GetParametersRequest,
+               GetParametersResponse>
+      context(move(request),
+              [&](AsyncContext<
+                  cmrt::sdk::parameter_service::v1::GetParametersRequest,
+                  GetParametersResponse>& context) {
+                EXPECT_THAT(context.result, ResultIs(failure));
+                condition = true;
+              });
+  EXPECT_THAT(client_->GetParameters(context), ResultIs(failure));
+  WaitUntil([&]() { return condition.load(); });
+}
 }  // namespace google::scp::cpio::client_providers::test
@@ -34,12 +34,14 @@ class MockPrivateKeyClientProviderWithOverrides
  public:
   explicit MockPrivateKeyClientProviderWithOverrides(
       const std::shared_ptr<PrivateKeyClientOptions>&
-          private_key_client_options)
+          private_key_client_options,
+      const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor =
+          nullptr)
       : PrivateKeyClientProvider(
             private_key_client_options,
             std::make_shared<core::http2_client::mock::MockHttpClient>(),
             std::make_shared<MockPrivateKeyFetcherProvider>(),
-            std::make_shared<MockKmsClientProvider>()) {}
+            std::make_shared<MockKmsClientProvider>(), io_async_executor) {}
 
   std::function<core::ExecutionResult(
       core::AsyncContext<
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "private_key_cache.h"
+
+#include <openssl/mem.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using google::cmrt::sdk::private_key_service::v1::PrivateKey;
+using std::string;
+using std::vector;
+using std::chrono::steady_clock;
+
+namespace google::scp::cpio::client_providers {
+PrivateKeyCache::~PrivateKeyCache() {
+  Clear();
+}
+
+PrivateKeyCache::Lookup PrivateKeyCache::Get(const string& key_id) noexcept {
+  std::lock_guard lock(mutex_);
+  Lookup lookup;
+  auto it = entries_.find(key_id);
+  auto now = steady_clock::now();
+  if (it == entries_.end() || it->second.expiration_time <= now) {
+    return lookup;
+  }
+  auto& entry = it->second;
+  lookup.private_key = entry.private_key;
+  if (refresh_ahead_.count() > 0 && !entry.is_refresh_in_flight &&
+      entry.expiration_time - refresh_ahead_ <= now) {
+    entry.is_refresh_in_flight = true;
+    lookup.is_refresh_due = true;
+  }
+  return lookup;
+}
+
+void PrivateKeyCache::Insert(const PrivateKey& private_key) noexcept {
+  std::lock_guard lock(mutex_);
+  auto now = steady_clock::now();
+  EvictExpiredEntries(now);
+  auto& entry = entries_[private_key.key_id()];
+  Zeroize(entry);
+  entry.private_key = private_key;
+  entry.expiration_time = now + ttl_;
+  entry.is_refresh_in_flight = false;
+}
+
+void PrivateKeyCache::AbandonRefresh(const vector<string>& key_ids) noexcept {
+  std::lock_guard lock(mutex_);
+  for (const auto& key_id : key_ids) {
+    if (auto it = entries_.find(key_id); it != entries_.end()) {
+      it->second.is_refresh_in_flight = false;
+    }
+  }
+}
+
+void PrivateKeyCache::Clear() noexcept {
+  std::lock_guard lock(mutex_);
+  for (auto& [key_id, entry] : entries_) {
+    Zeroize(entry);
+  }
+  entries_.clear();
+}
+
+void PrivateKeyCache::Zeroize(Entry& entry) noexcept {
+  auto* private_key = entry.private_key.mutable_private_key();
+  OPENSSL_cleanse(private_key->data(), private_key->size());
+  private_key->clear();
+}
+
+void PrivateKeyCache::EvictExpiredEntries(
+    steady_clock::time_point now) noexcept {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.expiration_time <= now) {
+      Zeroize(it->second);
+      entries_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+}  // namespace google::scp::cpio::client_providers
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "public/cpio/proto/private_key_service/v1/private_key_service.pb.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Caches the private keys reconstructed by PrivateKeyClientProvider,
+ * keyed by their ID, for a TTL.
+ *
+ * The key material of the evicted and expired keys is zeroized before being
+ * freed. The expired keys are evicted when keys are inserted.
+ */
+class PrivateKeyCache {
+ public:
+  /// The result of a lookup.
+  struct Lookup {
+    /// The cached key, unset if it is not cached or is expired.
+    std::optional<cmrt::sdk::private_key_service::v1::PrivateKey> private_key;
+    /// Whether the caller has to refetch the key, as it expires soon. Only
+    /// true for one lookup until the key is inserted again or the refresh is
+    /// abandoned.
+    bool is_refresh_due = false;
+  };
+
+  /**
+   * @param ttl how long the keys are cached.
+   * @param refresh_ahead how long before their expiration the keys are due for
+   * a refresh. Zero never makes them due.
+   */
+  PrivateKeyCache(std::chrono::seconds ttl, std::chrono::seconds refresh_ahead)
+      : ttl_(ttl), refresh_ahead_(refresh_ahead) {}
+
+  ~PrivateKeyCache();
+
+  PrivateKeyCache(const PrivateKeyCache&) = delete;
+  PrivateKeyCache& operator=(const PrivateKeyCache&) = delete;
+
+  /// Looks up the key with the ID.
+  Lookup Get(const std::string& key_id) noexcept;
+
+  /// Caches the key, replacing the one with the same ID.
+  void Insert(const cmrt::sdk::private_key_service::v1::PrivateKey&
+                  private_key) noexcept;
+
+  /// Makes the keys due for a refresh again, after a failed refresh.
+  void AbandonRefresh(const std::vector<std::string>& key_ids) noexcept;
+
+  /// Evicts all the keys.
+  void Clear() noexcept;
+
+ private:
+  struct Entry {
+    cmrt::sdk::private_key_service::v1::PrivateKey private_key;
+    std::chrono::steady_clock::time_point expiration_time;
+    bool is_refresh_in_flight = false;
+  };
+
+  /// Zeroizes the key material of the entry.
+  static void Zeroize(Entry& entry) noexcept;
+
+  /// Evicts the expired entries. Must hold mutex_.
+  void EvictExpiredEntries(std::chrono::steady_clock::time_point now) noexcept;
+
+  const std::chrono::seconds ttl_;
+  const std::chrono::seconds refresh_ahead_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+}  // namespace google::scp::cpio::client_providers
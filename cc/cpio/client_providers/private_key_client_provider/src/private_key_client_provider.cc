@@ -17,7 +17,9 @@
 #include "private_key_client_provider.h"
 
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -32,6 +34,7 @@
 #include "public/cpio/proto/private_key_service/v1/private_key_service.pb.h"
 
 #include "error_codes.h"
+#include "private_key_cache.h"
 #include "private_key_client_utils.h"
 
 using google::cmrt::sdk::kms_service::v1::DecryptRequest;
@@ -41,6 +44,7 @@ using google::cmrt::sdk::private_key_service::v1::ListPrivateKeysResponse;
 using google::cmrt::sdk::private_key_service::v1::PrivateKey;
 using google::protobuf::Any;
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::HttpClientInterface;
@@ -53,6 +57,8 @@ using google::scp::core::utils::Base64Encode;
 using std::atomic;
 using std::bind;
 using std::make_shared;
+using std::make_unique;
+using std::map;
 using std::move;
 using std::shared_ptr;
 using std::string;
@@ -71,6 +77,14 @@ ExecutionResult PrivateKeyClientProvider::Init() noexcept {
   }
   endpoint_count_ = endpoint_list_.size();
 
+  if (private_key_client_options_->private_key_cache_ttl_seconds > 0) {
+    private_key_cache_ = make_unique<PrivateKeyCache>(
+        std::chrono::seconds(
+            private_key_client_options_->private_key_cache_ttl_seconds),
+        std::chrono::seconds(private_key_client_options_
+                                 ->private_key_cache_refresh_ahead_seconds));
+  }
+
   return SuccessExecutionResult();
 }
 
@@ -79,12 +93,117 @@ ExecutionResult PrivateKeyClientProvider::Run() noexcept {
 }
 
 ExecutionResult PrivateKeyClientProvider::Stop() noexcept {
+  if (private_key_cache_) {
+    private_key_cache_->Clear();
+  }
   return SuccessExecutionResult();
 }
 
 ExecutionResult PrivateKeyClientProvider::ListPrivateKeys(
     AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
         list_private_keys_context) noexcept {
+  // Only the keys listed by ID are cached, the keys listed by age change.
+  if (!private_key_cache_ ||
+      list_private_keys_context.request->key_ids().empty()) {
+    return ListPrivateKeysFromEndpoints(list_private_keys_context);
+  }
+
+  auto cached_keys = make_shared<vector<PrivateKey>>();
+  auto uncached_keys_request = make_shared<ListPrivateKeysRequest>();
+  vector<string> key_ids_to_refresh;
+  for (const auto& key_id : list_private_keys_context.request->key_ids()) {
+    auto lookup = private_key_cache_->Get(key_id);
+    if (lookup.private_key.has_value()) {
+      cached_keys->push_back(move(*lookup.private_key));
+    } else {
+      uncached_keys_request->add_key_ids(key_id);
+    }
+    if (lookup.is_refresh_due) {
+      key_ids_to_refresh.push_back(key_id);
+    }
+  }
+  if (!key_ids_to_refresh.empty()) {
+    RefreshCachedPrivateKeys(move(key_ids_to_refresh));
+  }
+
+  // Responds with the keys in the order of their IDs, as the endpoints do.
+  auto finish = [list_private_keys_context, cached_keys](
+                    const ListPrivateKeysResponse* fetched_keys) mutable {
+    map<string, PrivateKey> private_key_id_map;
+    for (auto& private_key : *cached_keys) {
+      private_key_id_map[private_key.key_id()] = move(private_key);
+    }
+    if (fetched_keys != nullptr) {
+      for (const auto& private_key : fetched_keys->private_keys()) {
+        private_key_id_map[private_key.key_id()] = private_key;
+      }
+    }
+    list_private_keys_context.response = make_shared<ListPrivateKeysResponse>();
+    for (auto& [key_id, private_key] : private_key_id_map) {
+      *list_private_keys_context.response->add_private_keys() =
+          move(private_key);
+    }
+    list_private_keys_context.result = SuccessExecutionResult();
+    list_private_keys_context.Finish();
+  };
+  if (uncached_keys_request->key_ids().empty()) {
+    finish(nullptr);
+    return SuccessExecutionResult();
+  }
+
+  AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>
+      uncached_keys_context(
+          move(uncached_keys_request),
+          [this, list_private_keys_context, finish](
+              AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+                  uncached_keys_context) mutable {
+            if (!uncached_keys_context.result.Successful()) {
+              list_private_keys_context.result = uncached_keys_context.result;
+              list_private_keys_context.Finish();
+              return;
+            }
+            for (const auto& private_key :
+                 uncached_keys_context.response->private_keys()) {
+              private_key_cache_->Insert(private_key);
+            }
+            finish(uncached_keys_context.response.get());
+          },
+          list_private_keys_context);
+  return ListPrivateKeysFromEndpoints(uncached_keys_context);
+}
+
+void PrivateKeyClientProvider::RefreshCachedPrivateKeys(
+    vector<string> key_ids) noexcept {
+  auto request = make_shared<ListPrivateKeysRequest>();
+  for (const auto& key_id : key_ids) {
+    request->add_key_ids(key_id);
+  }
+  AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>
+      refresh_context(
+          move(request),
+          [this, key_ids = move(key_ids)](
+              AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+                  refresh_context) {
+            if (!refresh_context.result.Successful()) {
+              // The cached keys are served until they expire, the next
+              // listing retries the refresh.
+              SCP_WARNING_CONTEXT(kPrivateKeyClientProvider, refresh_context,
+                                  "Failed to refresh the cached private keys.");
+              private_key_cache_->AbandonRefresh(key_ids);
+              return;
+            }
+            for (const auto& private_key :
+                 refresh_context.response->private_keys()) {
+              private_key_cache_->Insert(private_key);
+            }
+          });
+  // A failure to send finishes the context.
+  ListPrivateKeysFromEndpoints(refresh_context);
+}
+
+ExecutionResult PrivateKeyClientProvider::ListPrivateKeysFromEndpoints(
+    AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+        list_private_keys_context) noexcept {
   auto list_keys_status = make_shared<ListPrivateKeysStatus>();
   list_keys_status->listing_method =
       list_private_keys_context.request->key_ids().empty()
@@ -265,7 +384,18 @@ void PrivateKeyClientProvider::OnFetchPrivateKeyCallback(
              list_private_keys_context, _1, list_keys_status, endpoints_status,
              encryption_key, uri_index),
         list_private_keys_context);
-    execution_result = kms_client_provider_->Decrypt(decrypt_context);
+    // Starts decrypting each split as soon as it is fetched, without waiting
+    // for the other splits of the response.
+    if (io_async_executor_) {
+      execution_result = io_async_executor_->Schedule(
+          [this, decrypt_context]() mutable {
+            // Decrypt() finishes the context on failure too.
+            kms_client_provider_->Decrypt(decrypt_context);
+          },
+          AsyncPriority::Normal);
+    } else {
+      execution_result = kms_client_provider_->Decrypt(decrypt_context);
+    }
 
     if (!execution_result.Successful()) {
       auto got_failure = false;
@@ -403,7 +533,7 @@ PrivateKeyClientProviderFactory::Create(
     const shared_ptr<RoleCredentialsProviderInterface>&
         role_credentials_provider,
     const shared_ptr<AuthTokenProviderInterface>& auth_token_provider,
-    const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor) {
+    const shared_ptr<core::AsyncExecutorInterface>& io_async_executor) {
   auto kms_client_provider = KmsClientProviderFactory::Create(
       make_shared<KmsClientOptions>(), role_credentials_provider,
       io_async_executor);
@@ -411,7 +541,8 @@ PrivateKeyClientProviderFactory::Create(
       http_client, role_credentials_provider, auth_token_provider);
 
   return make_shared<PrivateKeyClientProvider>(
-      options, http_client, private_key_fetcher, kms_client_provider);
+      options, http_client, private_key_fetcher, kms_client_provider,
+      io_async_executor);
 }
 
 }  // namespace google::scp::cpio::client_providers
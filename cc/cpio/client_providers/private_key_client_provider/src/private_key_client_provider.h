@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
 #include "core/interface/http_client_interface.h"
 #include "core/interface/http_types.h"
 #include "cpio/client_providers/interface/kms_client_provider_interface.h"
@@ -31,6 +32,7 @@
 #include "public/core/interface/execution_result.h"
 
 #include "error_codes.h"
+#include "private_key_cache.h"
 #include "private_key_client_utils.h"
 
 namespace google::scp::cpio::client_providers {
@@ -46,10 +48,13 @@ class PrivateKeyClientProvider : public PrivateKeyClientProviderInterface {
       const std::shared_ptr<core::HttpClientInterface>& http_client,
       const std::shared_ptr<PrivateKeyFetcherProviderInterface>&
           private_key_fetcher,
-      const std::shared_ptr<KmsClientProviderInterface>& kms_client)
+      const std::shared_ptr<KmsClientProviderInterface>& kms_client,
+      const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor =
+          nullptr)
       : private_key_client_options_(private_key_client_options),
         private_key_fetcher_(private_key_fetcher),
-        kms_client_provider_(kms_client) {}
+        kms_client_provider_(kms_client),
+        io_async_executor_(io_async_executor) {}
 
   core::ExecutionResult Init() noexcept override;
 
@@ -128,6 +133,24 @@ class PrivateKeyClientProvider : public PrivateKeyClientProviderInterface {
     std::mutex map_mutex;
   };
 
+  /**
+   * @brief Lists the private keys from the endpoints, without the cache.
+   *
+   * @param context ListPrivateKeys context.
+   */
+  core::ExecutionResult ListPrivateKeysFromEndpoints(
+      core::AsyncContext<
+          cmrt::sdk::private_key_service::v1::ListPrivateKeysRequest,
+          cmrt::sdk::private_key_service::v1::ListPrivateKeysResponse>&
+          context) noexcept;
+
+  /**
+   * @brief Refetches the cached keys in the background, as they expire soon.
+   *
+   * @param key_ids the IDs of the keys.
+   */
+  void RefreshCachedPrivateKeys(std::vector<std::string> key_ids) noexcept;
+
   /**
    * @brief Is called after FetchPrivateKey is completed.
    *
@@ -181,9 +204,16 @@ class PrivateKeyClientProvider : public PrivateKeyClientProviderInterface {
   /// KMS client provider.
   std::shared_ptr<KmsClientProviderInterface> kms_client_provider_;
 
+  /// Runs the KMS decryptions of the key splits concurrently, as they block on
+  /// the remote call. Null runs them on the thread the split is fetched on.
+  std::shared_ptr<core::AsyncExecutorInterface> io_async_executor_;
+
   // This is temp way to collect all endpoints in one vector. Maybe we should
   // change PrivateKeyClientOptions structure to make thing easy.
   std::vector<PrivateKeyVendingEndpoint> endpoint_list_;
   size_t endpoint_count_;
+
+  /// The decrypted private keys listed by ID, null if the cache is disabled.
+  std::unique_ptr<PrivateKeyCache> private_key_cache_;
 };
 }  // namespace google::scp::cpio::client_providers
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cpio/client_providers/private_key_client_provider/src/private_key_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "public/cpio/proto/private_key_service/v1/private_key_service.pb.h"
+
+using google::cmrt::sdk::private_key_service::v1::PrivateKey;
+using std::string;
+using std::chrono::hours;
+using std::chrono::seconds;
+
+namespace google::scp::cpio::client_providers::test {
+namespace {
+PrivateKey MakePrivateKey(const string& key_id, const string& private_key) {
+  PrivateKey key;
+  key.set_key_id(key_id);
+  key.set_private_key(private_key);
+  return key;
+}
+
+TEST(PrivateKeyCacheTest, GetReturnsInsertedKey) {
+  PrivateKeyCache cache(hours(1), seconds(0));
+  EXPECT_FALSE(cache.Get("key_id_1").private_key.has_value());
+
+  cache.Insert(MakePrivateKey("key_id_1", "key1"));
+  cache.Insert(MakePrivateKey("key_id_2", "key2"));
+  cache.Insert(MakePrivateKey("key_id_1", "key1-rotated"));
+
+  auto lookup = cache.Get("key_id_1");
+  ASSERT_TRUE(lookup.private_key.has_value());
+  EXPECT_EQ(lookup.private_key->private_key(), "key1-rotated");
+  EXPECT_FALSE(lookup.is_refresh_due);
+  EXPECT_EQ(cache.Get("key_id_2").private_key->private_key(), "key2");
+}
+
+TEST(PrivateKeyCacheTest, ExpiredKeysAreNotReturned) {
+  PrivateKeyCache cache(seconds(0), seconds(0));
+  cache.Insert(MakePrivateKey("key_id_1", "key1"));
+
+  EXPECT_FALSE(cache.Get("key_id_1").private_key.has_value());
+}
+
+TEST(PrivateKeyCacheTest, RefreshIsDueOnceUntilAbandoned) {
+  PrivateKeyCache cache(hours(1), hours(1));
+  cache.Insert(MakePrivateKey("key_id_1", "key1"));
+
+  auto lookup = cache.Get("key_id_1");
+  EXPECT_TRUE(lookup.private_key.has_value());
+  EXPECT_TRUE(lookup.is_refresh_due);
+  EXPECT_FALSE(cache.Get("key_id_1").is_refresh_due);
+
+  cache.AbandonRefresh({"key_id_1"});
+  EXPECT_TRUE(cache.Get("key_id_1").is_refresh_due);
+
+  cache.Insert(MakePrivateKey("key_id_1", "key1"));
+  EXPECT_TRUE(cache.Get("key_id_1").is_refresh_due);
+}
+
+TEST(PrivateKeyCacheTest, ClearEvictsAllKeys) {
+  PrivateKeyCache cache(hours(1), seconds(0));
+  cache.Insert(MakePrivateKey("key_id_1", "key1"));
+
+  cache.Clear();
+
+  EXPECT_FALSE(cache.Get("key_id_1").private_key.has_value());
+}
+}  // namespace
+}  // namespace google::scp::cpio::client_providers::test
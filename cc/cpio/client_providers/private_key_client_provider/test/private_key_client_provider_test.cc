@@ -26,6 +26,7 @@
 
 #include <google/protobuf/util/time_util.h>
 
+#include "core/async_executor/mock/mock_async_executor.h"
 #include "core/interface/async_context.h"
 #include "core/test/utils/conditional_wait.h"
 #include "core/test/utils/proto_test_utils.h"
@@ -47,6 +48,8 @@ using google::cmrt::sdk::private_key_service::v1::PrivateKey;
 using google::protobuf::Any;
 using google::protobuf::util::TimeUtil;
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
@@ -218,6 +221,8 @@ class PrivateKeyClientProviderTest : public ::testing::Test {
     endpoint_3.service_region = kTestRegion3;
     endpoint_3.private_key_vending_service_endpoint = kTestEndpoint3;
 
+    endpoint_list = {endpoint_1, endpoint_2, endpoint_3};
+
     auto private_key_client_options = make_shared<PrivateKeyClientOptions>();
     private_key_client_options->primary_private_key_vending_endpoint =
         endpoint_1;
@@ -242,6 +247,19 @@ class PrivateKeyClientProviderTest : public ::testing::Test {
     }
   }
 
+  void ResetPrivateKeyClientProvider(
+      const shared_ptr<PrivateKeyClientOptions>& private_key_client_options,
+      const shared_ptr<MockAsyncExecutor>& io_async_executor = nullptr) {
+    private_key_client_provider =
+        make_shared<MockPrivateKeyClientProviderWithOverrides>(
+            private_key_client_options, io_async_executor);
+    mock_private_key_fetcher =
+        private_key_client_provider->GetPrivateKeyFetcherProvider();
+    mock_kms_client = private_key_client_provider->GetKmsClientProvider();
+    EXPECT_SUCCESS(private_key_client_provider->Init());
+    EXPECT_SUCCESS(private_key_client_provider->Run());
+  }
+
   void SetMockKmsClient(const ExecutionResult& mock_result, int8_t call_time) {
     EXPECT_CALL(*mock_kms_client, Decrypt)
         .Times(call_time)
@@ -321,6 +339,7 @@ class PrivateKeyClientProviderTest : public ::testing::Test {
     return expected_keys;
   }
 
+  vector<PrivateKeyVendingEndpoint> endpoint_list;
   shared_ptr<MockPrivateKeyClientProviderWithOverrides>
       private_key_client_provider;
   shared_ptr<MockPrivateKeyFetcherProvider> mock_private_key_fetcher;
@@ -357,6 +376,135 @@ TEST_F(PrivateKeyClientProviderTest, ListPrivateKeysByIdsSuccess) {
   WaitUntil([&]() { return response_count.load() == 1; });
 }
 
+TEST_F(PrivateKeyClientProviderTest, ListPrivateKeysByIdsFromCache) {
+  auto private_key_client_options = make_shared<PrivateKeyClientOptions>();
+  private_key_client_options->primary_private_key_vending_endpoint =
+      endpoint_list[0];
+  private_key_client_options->secondary_private_key_vending_endpoints = {
+      endpoint_list[1], endpoint_list[2]};
+  private_key_client_options->private_key_cache_ttl_seconds = 3600;
+  ResetPrivateKeyClientProvider(private_key_client_options);
+
+  // Only the first listing fetches and decrypts the keys.
+  SetMockKmsClient(SuccessExecutionResult(), 9);
+  SetMockPrivateKeyFetchingClient(kMockSuccessKeyFetchingResults,
+                                  kMockSuccessKeyFetchingResponses);
+  string encoded_private_key;
+  Base64Encode(kTestPrivateKey, encoded_private_key);
+  auto expected_keys = BuildExpectedPrivateKeys(encoded_private_key);
+
+  ListPrivateKeysRequest request;
+  request.add_key_ids(kTestKeyIds[0]);
+  request.add_key_ids(kTestKeyIds[1]);
+  request.add_key_ids(kTestKeyIds[2]);
+  atomic<size_t> response_count = 0;
+  AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse> context(
+      make_shared<ListPrivateKeysRequest>(request),
+      [&](AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+              context) {
+        EXPECT_SUCCESS(context.result);
+        EXPECT_THAT(context.response->private_keys(),
+                    Pointwise(EqualsProto(), expected_keys));
+        response_count.fetch_add(1);
+      });
+  EXPECT_SUCCESS(private_key_client_provider->ListPrivateKeys(context));
+  WaitUntil([&]() { return response_count.load() == 1; });
+
+  ListPrivateKeysRequest cached_request;
+  cached_request.add_key_ids(kTestKeyIds[2]);
+  cached_request.add_key_ids(kTestKeyIds[0]);
+  AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>
+      cached_context(
+          make_shared<ListPrivateKeysRequest>(cached_request),
+          [&](AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+                  context) {
+            EXPECT_SUCCESS(context.result);
+            EXPECT_THAT(context.response->private_keys(),
+                        ElementsAre(EqualsProto(expected_keys[0]),
+                                    EqualsProto(expected_keys[2])));
+            response_count.fetch_add(1);
+          });
+  EXPECT_SUCCESS(private_key_client_provider->ListPrivateKeys(cached_context));
+  EXPECT_EQ(response_count.load(), 2);
+}
+
+TEST_F(PrivateKeyClientProviderTest,
+       ListPrivateKeysDecryptsSplitsOnIoExecutor) {
+  auto private_key_client_options = make_shared<PrivateKeyClientOptions>();
+  private_key_client_options->primary_private_key_vending_endpoint =
+      endpoint_list[0];
+  private_key_client_options->secondary_private_key_vending_endpoints = {
+      endpoint_list[1], endpoint_list[2]};
+  auto io_async_executor = make_shared<MockAsyncExecutor>();
+  vector<AsyncOperation> scheduled_decryptions;
+  io_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+    scheduled_decryptions.push_back(work);
+    return SuccessExecutionResult();
+  };
+  ResetPrivateKeyClientProvider(private_key_client_options, io_async_executor);
+
+  SetMockKmsClient(SuccessExecutionResult(), 9);
+  SetMockPrivateKeyFetchingClient(kMockSuccessKeyFetchingResults,
+                                  kMockSuccessKeyFetchingResponses);
+  ListPrivateKeysRequest request;
+  request.add_key_ids(kTestKeyIds[0]);
+  request.add_key_ids(kTestKeyIds[1]);
+  request.add_key_ids(kTestKeyIds[2]);
+
+  string encoded_private_key;
+  Base64Encode(kTestPrivateKey, encoded_private_key);
+  atomic<size_t> response_count = 0;
+  AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse> context(
+      make_shared<ListPrivateKeysRequest>(request),
+      [&](AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+              context) {
+        auto expected_keys = BuildExpectedPrivateKeys(encoded_private_key);
+        EXPECT_THAT(context.response->private_keys(),
+                    Pointwise(EqualsProto(), expected_keys));
+        EXPECT_SUCCESS(context.result);
+        response_count.fetch_add(1);
+      });
+  EXPECT_SUCCESS(private_key_client_provider->ListPrivateKeys(context));
+
+  // All the splits are fetched without waiting for any decryption.
+  ASSERT_EQ(scheduled_decryptions.size(), 9);
+  EXPECT_EQ(response_count.load(), 0);
+  for (auto& decryption : scheduled_decryptions) {
+    decryption();
+  }
+  EXPECT_EQ(response_count.load(), 1);
+}
+
+TEST_F(PrivateKeyClientProviderTest, FailedToScheduleDecryption) {
+  auto private_key_client_options = make_shared<PrivateKeyClientOptions>();
+  private_key_client_options->primary_private_key_vending_endpoint =
+      endpoint_list[0];
+  private_key_client_options->secondary_private_key_vending_endpoints = {
+      endpoint_list[1], endpoint_list[2]};
+  auto io_async_executor = make_shared<MockAsyncExecutor>();
+  auto schedule_result = FailureExecutionResult(SC_UNKNOWN);
+  io_async_executor->schedule_mock = [&](const AsyncOperation&) {
+    return schedule_result;
+  };
+  ResetPrivateKeyClientProvider(private_key_client_options, io_async_executor);
+
+  SetMockPrivateKeyFetchingClient(kMockSuccessKeyFetchingResults,
+                                  kMockSuccessKeyFetchingResponses);
+  ListPrivateKeysRequest request;
+  request.add_key_ids(kTestKeyIds[0]);
+
+  atomic<size_t> response_count = 0;
+  AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse> context(
+      make_shared<ListPrivateKeysRequest>(request),
+      [&](AsyncContext<ListPrivateKeysRequest, ListPrivateKeysResponse>&
+              context) {
+        EXPECT_THAT(context.result, ResultIs(schedule_result));
+        response_count.fetch_add(1);
+      });
+  EXPECT_SUCCESS(private_key_client_provider->ListPrivateKeys(context));
+  EXPECT_EQ(response_count.load(), 1);
+}
+
 TEST_F(PrivateKeyClientProviderTest, ListPrivateKeysByAgeSuccess) {
   auto mock_result = SuccessExecutionResult();
   SetMockKmsClient(mock_result, 9);
@@ -16,13 +16,16 @@
 
 #include "public_key_client_provider.h"
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
 #include <google/protobuf/util/time_util.h>
 
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_context.h"
 #include "core/interface/http_client_interface.h"
@@ -51,6 +54,7 @@ using google::scp::core::HttpRequest;
 using google::scp::core::HttpResponse;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::Uri;
+using google::scp::core::common::TimeProvider;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::errors::
     SC_PUBLIC_KEY_CLIENT_PROVIDER_ALL_URIS_REQUEST_PERFORM_FAILED;
@@ -116,6 +120,92 @@ ExecutionResult PublicKeyClientProvider::Stop() noexcept {
 ExecutionResult PublicKeyClientProvider::ListPublicKeys(
     AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>&
         public_key_fetching_context) noexcept {
+  if (public_key_client_options_->enable_public_key_cache) {
+    return ListCachedPublicKeys(public_key_fetching_context);
+  }
+  return FetchPublicKeys(public_key_fetching_context);
+}
+
+ExecutionResult PublicKeyClientProvider::ListCachedPublicKeys(
+    AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>&
+        public_key_fetching_context) noexcept {
+  auto now_in_s = std::chrono::duration_cast<std::chrono::seconds>(
+                      TimeProvider::GetWallTimestampInNanoseconds())
+                      .count();
+  shared_ptr<const ListPublicKeysResponse> cached_response;
+  auto should_fetch = false;
+  {
+    std::lock_guard lock(cache_mutex_);
+    if (cached_response_ &&
+        cached_response_->expiration_time().seconds() > now_in_s) {
+      cached_response = cached_response_;
+      // Refreshes ahead of the expiration, the cached keys are served
+      // meanwhile.
+      should_fetch =
+          !is_fetch_in_flight_ &&
+          public_key_client_options_->public_key_cache_refresh_ahead_seconds >
+              0 &&
+          cached_response_->expiration_time().seconds() -
+                  static_cast<int64_t>(
+                      public_key_client_options_
+                          ->public_key_cache_refresh_ahead_seconds) <=
+              now_in_s;
+    } else {
+      waiting_contexts_.push_back(public_key_fetching_context);
+      should_fetch = !is_fetch_in_flight_;
+    }
+    if (should_fetch) {
+      is_fetch_in_flight_ = true;
+    }
+  }
+
+  if (cached_response) {
+    public_key_fetching_context.response =
+        make_shared<ListPublicKeysResponse>(*cached_response);
+    public_key_fetching_context.result = SuccessExecutionResult();
+    public_key_fetching_context.Finish();
+  }
+  if (!should_fetch) {
+    return SuccessExecutionResult();
+  }
+
+  AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse> fetch_context(
+      public_key_fetching_context.request,
+      bind(&PublicKeyClientProvider::OnFetchPublicKeysToCacheCallback, this,
+           _1),
+      public_key_fetching_context);
+  auto execution_result = FetchPublicKeys(fetch_context);
+  // A failed refresh is not the failure of the listing served from the cache.
+  return cached_response ? SuccessExecutionResult() : execution_result;
+}
+
+void PublicKeyClientProvider::OnFetchPublicKeysToCacheCallback(
+    AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>&
+        fetch_context) noexcept {
+  vector<AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>>
+      waiting_contexts;
+  {
+    std::lock_guard lock(cache_mutex_);
+    if (fetch_context.result.Successful()) {
+      cached_response_ = fetch_context.response;
+    }
+    is_fetch_in_flight_ = false;
+    waiting_contexts.swap(waiting_contexts_);
+  }
+
+  for (auto& context : waiting_contexts) {
+    context.result = fetch_context.result;
+    if (fetch_context.result.Successful()) {
+      context.response =
+          make_shared<ListPublicKeysResponse>(*fetch_context.response);
+    }
+    context.Finish();
+  }
+}
+
+ExecutionResult PublicKeyClientProvider::FetchPublicKeys(
+    AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>&
+        public_key_fetching_context) noexcept {
   // Use got_success_result and unfinished_counter to track whether get success
   // response and how many failed responses. Only return one response whether
   // success or failed.
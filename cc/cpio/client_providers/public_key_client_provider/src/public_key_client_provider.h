@@ -17,6 +17,8 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "core/interface/async_context.h"
 #include "core/interface/http_client_interface.h"
@@ -63,6 +65,42 @@ class PublicKeyClientProvider : public PublicKeyClientProviderInterface {
       core::AsyncContext<google::protobuf::Any, google::protobuf::Any>
           context) noexcept;
 
+  /**
+   * @brief Fetches the public keys from all the endpoints in parallel, and
+   * responds with the first success.
+   *
+   * @param public_key_fetching_context public key fetching context.
+   */
+  core::ExecutionResult FetchPublicKeys(
+      core::AsyncContext<
+          cmrt::sdk::public_key_service::v1::ListPublicKeysRequest,
+          cmrt::sdk::public_key_service::v1::ListPublicKeysResponse>&
+          public_key_fetching_context) noexcept;
+
+  /**
+   * @brief Lists the public keys from the cache. On a miss, the context waits
+   * for the fetch in flight, which is started if needed.
+   *
+   * @param public_key_fetching_context public key fetching context.
+   */
+  core::ExecutionResult ListCachedPublicKeys(
+      core::AsyncContext<
+          cmrt::sdk::public_key_service::v1::ListPublicKeysRequest,
+          cmrt::sdk::public_key_service::v1::ListPublicKeysResponse>&
+          public_key_fetching_context) noexcept;
+
+  /**
+   * @brief Is called after the fetch of the public keys to cache is
+   * completed. Caches the keys and finishes the waiting contexts.
+   *
+   * @param fetch_context the fetch context.
+   */
+  void OnFetchPublicKeysToCacheCallback(
+      core::AsyncContext<
+          cmrt::sdk::public_key_service::v1::ListPublicKeysRequest,
+          cmrt::sdk::public_key_service::v1::ListPublicKeysResponse>&
+          fetch_context) noexcept;
+
   /**
    * @brief Is called after http client PerformRequest() is completed.
    *
@@ -86,5 +124,19 @@ class PublicKeyClientProvider : public PublicKeyClientProviderInterface {
 
   /// Configurations for PublicKeyClient.
   std::shared_ptr<PublicKeyClientOptions> public_key_client_options_;
+
+  /// Guards the cache fields below.
+  std::mutex cache_mutex_;
+  /// The last public keys fetched, null until fetched.
+  std::shared_ptr<
+      const cmrt::sdk::public_key_service::v1::ListPublicKeysResponse>
+      cached_response_;
+  /// Whether a fetch of the public keys to cache is in flight.
+  bool is_fetch_in_flight_ = false;
+  /// The contexts that missed the cache, waiting for the fetch in flight.
+  std::vector<core::AsyncContext<
+      cmrt::sdk::public_key_service::v1::ListPublicKeysRequest,
+      cmrt::sdk::public_key_service::v1::ListPublicKeysResponse>>
+      waiting_contexts_;
 };
 }  // namespace google::scp::cpio::client_providers
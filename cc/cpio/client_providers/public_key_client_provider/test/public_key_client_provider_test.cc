@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <ctime>
 #include <functional>
 #include <memory>
 #include <string>
@@ -108,6 +109,34 @@ class PublicKeyClientProviderTestII : public ::testing::Test {
     EXPECT_SUCCESS(public_key_client_->Run());
   }
 
+  void EnablePublicKeyCache(uint64_t refresh_ahead_seconds) {
+    auto public_key_client_options = make_shared<PublicKeyClientOptions>();
+    public_key_client_options->endpoints.emplace_back(kPrivateKeyBaseUri1);
+    public_key_client_options->endpoints.emplace_back(kPrivateKeyBaseUri2);
+    public_key_client_options->enable_public_key_cache = true;
+    public_key_client_options->public_key_cache_refresh_ahead_seconds =
+        refresh_ahead_seconds;
+    public_key_client_ = make_unique<PublicKeyClientProvider>(
+        public_key_client_options, http_client_);
+    EXPECT_SUCCESS(public_key_client_->Init());
+    EXPECT_SUCCESS(public_key_client_->Run());
+  }
+
+  /// A response dated now, valid for the max-age of cache_control. The date is
+  /// in local time, as the parsing of the headers assumes.
+  HttpResponse GetCurrentHttpResponse(const string& cache_control) {
+    auto response = GetValidHttpResponse();
+    auto now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT",
+                  std::localtime(&now));
+    HttpHeaders headers;
+    headers.insert({kPublicKeyHeaderDate, date});
+    headers.insert({kPublicKeyHeaderCacheControl, cache_control});
+    response.headers = make_shared<HttpHeaders>(headers);
+    return response;
+  }
+
   HttpResponse GetValidHttpResponse() {
     HttpResponse response;
     HttpHeaders headers;
@@ -172,6 +201,78 @@ TEST_F(PublicKeyClientProviderTestII, ListPublicKeysSuccess) {
   WaitUntil([&]() { return perform_calls.load() == 2; });
 }
 
+TEST_F(PublicKeyClientProviderTestII, ListPublicKeysFromCache) {
+  EnablePublicKeyCache(0);
+  atomic<int> perform_calls(0);
+  auto success_response = GetCurrentHttpResponse("max-age=3600");
+  http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+        perform_calls++;
+        http_context.response = make_shared<HttpResponse>(success_response);
+        http_context.result = SuccessExecutionResult();
+        http_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  atomic<int> success_callback(0);
+  for (int i = 0; i < 3; ++i) {
+    AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse> context(
+        make_shared<ListPublicKeysRequest>(),
+        [&](AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>&
+                context) {
+          EXPECT_SUCCESS(context.result);
+          ASSERT_EQ(context.response->public_keys().size(), 2);
+          EXPECT_EQ(context.response->public_keys()[0].key_id(), "1234");
+          EXPECT_EQ(context.response->public_keys()[1].key_id(), "5678");
+          success_callback++;
+        });
+    EXPECT_SUCCESS(public_key_client_->ListPublicKeys(context));
+  }
+
+  EXPECT_EQ(success_callback.load(), 3);
+  // Only the first listing fetches from the endpoints.
+  EXPECT_EQ(perform_calls.load(), 2);
+}
+
+TEST_F(PublicKeyClientProviderTestII, ListPublicKeysRefreshesCacheAhead) {
+  EnablePublicKeyCache(7200);
+  atomic<int> perform_calls(0);
+  auto success_response = GetCurrentHttpResponse("max-age=3600");
+  http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+        perform_calls++;
+        http_context.response = make_shared<HttpResponse>(success_response);
+        http_context.result = SuccessExecutionResult();
+        http_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  atomic<int> success_callback(0);
+  AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse> context(
+      make_shared<ListPublicKeysRequest>(),
+      [&](AsyncContext<ListPublicKeysRequest, ListPublicKeysResponse>&
+              context) {
+        EXPECT_SUCCESS(context.result);
+        success_callback++;
+      });
+  EXPECT_SUCCESS(public_key_client_->ListPublicKeys(context));
+  EXPECT_EQ(perform_calls.load(), 2);
+
+  // The keys expire within the refresh-ahead window, so each listing is
+  // served from the cache and refetches the keys.
+  http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+        perform_calls++;
+        auto result = FailureExecutionResult(SC_UNKNOWN);
+        http_context.result = result;
+        http_context.Finish();
+        return result;
+      };
+  EXPECT_SUCCESS(public_key_client_->ListPublicKeys(context));
+  EXPECT_EQ(perform_calls.load(), 4);
+  EXPECT_EQ(success_callback.load(), 2);
+}
+
 TEST_F(PublicKeyClientProviderTestII, ListPublicKeysFailure) {
   ExecutionResult failed_result = FailureExecutionResult(SC_UNKNOWN);
 
@@ -21,8 +21,10 @@
 #include <memory>
 
 #include <aws/sqs/SQSClient.h>
+#include <aws/sqs/model/ChangeMessageVisibilityBatchRequest.h>
 #include <aws/sqs/model/ChangeMessageVisibilityRequest.h>
 #include <aws/sqs/model/CreateQueueRequest.h>
+#include <aws/sqs/model/DeleteMessageBatchRequest.h>
 #include <aws/sqs/model/DeleteMessageRequest.h>
 #include <aws/sqs/model/GetQueueUrlRequest.h>
 #include <aws/sqs/model/ReceiveMessageRequest.h>
@@ -51,11 +53,22 @@ class MockSqsClient : public Aws::SQS::SQSClient {
                const Aws::SQS::ChangeMessageVisibilityResponseReceivedHandler&,
                const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
               (const, override));
+  MOCK_METHOD(
+      void, ChangeMessageVisibilityBatchAsync,
+      (const Aws::SQS::Model::ChangeMessageVisibilityBatchRequest&,
+       const Aws::SQS::ChangeMessageVisibilityBatchResponseReceivedHandler&,
+       const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
+      (const, override));
   MOCK_METHOD(void, DeleteMessageAsync,
               (const Aws::SQS::Model::DeleteMessageRequest&,
                const Aws::SQS::DeleteMessageResponseReceivedHandler&,
                const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
               (const, override));
+  MOCK_METHOD(void, DeleteMessageBatchAsync,
+              (const Aws::SQS::Model::DeleteMessageBatchRequest&,
+               const Aws::SQS::DeleteMessageBatchResponseReceivedHandler&,
+               const std::shared_ptr<const Aws::Client::AsyncCallerContext>&),
+              (const, override));
 };
 
 }  // namespace google::scp::cpio::client_providers::mock
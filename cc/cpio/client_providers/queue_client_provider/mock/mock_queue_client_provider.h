@@ -52,6 +52,14 @@ class MockQueueClientProvider : public QueueClientProviderInterface {
               UpdateMessageVisibilityTimeoutResponse>&)),
       (noexcept, override));
 
+  MOCK_METHOD(
+      core::ExecutionResult, BatchUpdateMessageVisibilityTimeout,
+      ((core::AsyncContext<cmrt::sdk::queue_service::v1::
+                               BatchUpdateMessageVisibilityTimeoutRequest,
+                           cmrt::sdk::queue_service::v1::
+                               BatchUpdateMessageVisibilityTimeoutResponse>&)),
+      (noexcept, override));
+
   MOCK_METHOD(core::ExecutionResult, DeleteMessage,
               ((core::AsyncContext<
                   cmrt::sdk::queue_service::v1::DeleteMessageRequest,
@@ -16,9 +16,15 @@
 
 #include "aws_queue_client_provider.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include <aws/sqs/model/ChangeMessageVisibilityBatchRequest.h>
 #include <aws/sqs/model/ChangeMessageVisibilityRequest.h>
+#include <aws/sqs/model/DeleteMessageBatchRequest.h>
 #include <aws/sqs/model/DeleteMessageRequest.h>
 #include <aws/sqs/model/GetQueueUrlRequest.h>
 #include <aws/sqs/model/ReceiveMessageRequest.h>
@@ -41,7 +47,13 @@ using Aws::Client::ClientConfiguration;
 using Aws::SQS::SQSClient;
 using Aws::SQS::SQSErrors;
 using Aws::SQS::Model::ChangeMessageVisibilityOutcome;
+using Aws::SQS::Model::ChangeMessageVisibilityBatchOutcome;
+using Aws::SQS::Model::ChangeMessageVisibilityBatchRequest;
+using Aws::SQS::Model::ChangeMessageVisibilityBatchRequestEntry;
 using Aws::SQS::Model::ChangeMessageVisibilityRequest;
+using Aws::SQS::Model::DeleteMessageBatchOutcome;
+using Aws::SQS::Model::DeleteMessageBatchRequest;
+using Aws::SQS::Model::DeleteMessageBatchRequestEntry;
 using Aws::SQS::Model::DeleteMessageOutcome;
 using Aws::SQS::Model::GetQueueUrlRequest;
 using Aws::SQS::Model::QueueAttributeName;
@@ -49,6 +61,10 @@ using Aws::SQS::Model::ReceiveMessageOutcome;
 using Aws::SQS::Model::ReceiveMessageRequest;
 using Aws::SQS::Model::SendMessageOutcome;
 using Aws::SQS::Model::SendMessageRequest;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutRequest;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutResponse;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageRequest;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageRequest;
@@ -67,6 +83,8 @@ using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::async_executor::aws::AwsAsyncExecutor;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::errors::
+    SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED;
 using google::scp::core::errors::SC_AWS_QUEUE_CLIENT_PROVIDER_INVALID_MESSAGE;
 using google::scp::core::errors::
     SC_AWS_QUEUE_CLIENT_PROVIDER_INVALID_RECEIPT_INFO;
@@ -82,19 +100,49 @@ using google::scp::cpio::client_providers::AwsInstanceClientUtils;
 using google::scp::cpio::common::CreateClientConfiguration;
 using std::bind;
 using std::make_shared;
+using std::make_unique;
 using std::move;
 using std::shared_ptr;
 using std::string;
 using std::to_string;
+using std::vector;
+using std::chrono::seconds;
 using std::placeholders::_1;
 using std::placeholders::_2;
 using std::placeholders::_3;
 using std::placeholders::_4;
 
 static constexpr char kAwsQueueClientProvider[] = "AwsQueueClientProvider";
-static const uint8_t kMaxNumberOfMessagesReceived = 1;
-static const uint8_t kMaxWaitTimeSeconds = 0;
+static const int kDefaultNumberOfMessagesReceived = 1;
+static const int kMaxNumberOfMessagesReceived = 10;
+static const int kMaxWaitTimeSeconds = 20;
 static const uint16_t kMaxVisibilityTimeoutSeconds = 600;
+/// The maximum number of entries of the SQS batch operations.
+static const size_t kMaxBatchEntries = 10;
+
+/// The number of messages to receive for the request.
+static int GetNumberOfMessagesToReceive(
+    const GetTopMessageRequest& request) noexcept {
+  return request.max_number_of_messages() > 0
+             ? std::min(request.max_number_of_messages(),
+                        kMaxNumberOfMessagesReceived)
+             : kDefaultNumberOfMessagesReceived;
+}
+
+/// Validates the receipt info and the visibility timeout of the request.
+static ExecutionResult ValidateUpdateMessageVisibilityTimeoutRequest(
+    const UpdateMessageVisibilityTimeoutRequest& request) noexcept {
+  if (request.receipt_info().empty()) {
+    return FailureExecutionResult(
+        SC_AWS_QUEUE_CLIENT_PROVIDER_INVALID_RECEIPT_INFO);
+  }
+  const int64_t lifetime = request.message_visibility_timeout().seconds();
+  if (lifetime < 0 || lifetime > kMaxVisibilityTimeoutSeconds) {
+    return FailureExecutionResult(
+        SC_AWS_QUEUE_CLIENT_PROVIDER_INVALID_VISIBILITY_TIMEOUT);
+  }
+  return SuccessExecutionResult();
+}
 
 namespace google::scp::cpio::client_providers {
 ExecutionResult AwsQueueClientProvider::Init() noexcept {
@@ -138,6 +186,28 @@ ExecutionResult AwsQueueClientProvider::Run() noexcept {
   }
   queue_url_ = move(*queue_url_or);
 
+  if (queue_client_options_->prefetch_count > 0) {
+    const int32_t visibility_timeout_seconds = std::clamp<int32_t>(
+        queue_client_options_->prefetched_message_visibility_timeout_seconds,
+        1, kMaxVisibilityTimeoutSeconds);
+    message_prefetcher_ = make_unique<QueueMessagePrefetcher>(
+        queue_client_options_->prefetch_count, kMaxNumberOfMessagesReceived,
+        seconds(visibility_timeout_seconds),
+        [this, visibility_timeout_seconds](
+            AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+                get_top_message_context) {
+          return ReceiveMessages(get_top_message_context,
+                                 visibility_timeout_seconds);
+        },
+        bind(&AwsQueueClientProvider::ExtendMessagesVisibility, this, _1, _2));
+  }
+  if (queue_client_options_->max_delete_message_batches_in_flight > 0) {
+    delete_message_batcher_ = make_unique<DeleteMessageBatcher>(
+        kMaxBatchEntries,
+        queue_client_options_->max_delete_message_batches_in_flight,
+        bind(&AwsQueueClientProvider::DeleteMessageBatch, this, _1));
+  }
+
   return execution_result;
 }
 
@@ -178,6 +248,9 @@ ExecutionResultOr<string> AwsQueueClientProvider::GetQueueUrl() noexcept {
 }
 
 ExecutionResult AwsQueueClientProvider::Stop() noexcept {
+  if (message_prefetcher_) {
+    message_prefetcher_->Clear();
+  }
   return SuccessExecutionResult();
 }
 
@@ -238,10 +311,28 @@ void AwsQueueClientProvider::OnSendMessageCallback(
 ExecutionResult AwsQueueClientProvider::GetTopMessage(
     AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
         get_top_message_context) noexcept {
+  if (message_prefetcher_) {
+    return message_prefetcher_->GetTopMessage(get_top_message_context);
+  }
+  return ReceiveMessages(get_top_message_context,
+                         /*visibility_timeout_seconds=*/0);
+}
+
+ExecutionResult AwsQueueClientProvider::ReceiveMessages(
+    AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+        get_top_message_context,
+    int32_t visibility_timeout_seconds) noexcept {
   ReceiveMessageRequest receive_message_request;
   receive_message_request.SetQueueUrl(queue_url_.c_str());
-  receive_message_request.SetMaxNumberOfMessages(kMaxNumberOfMessagesReceived);
-  receive_message_request.SetWaitTimeSeconds(kMaxWaitTimeSeconds);
+  const auto& request = *get_top_message_context.request;
+  receive_message_request.SetMaxNumberOfMessages(
+      GetNumberOfMessagesToReceive(request));
+  // A positive wait time makes it a long poll.
+  receive_message_request.SetWaitTimeSeconds(
+      std::clamp(request.wait_time_seconds(), 0, kMaxWaitTimeSeconds));
+  if (visibility_timeout_seconds > 0) {
+    receive_message_request.SetVisibilityTimeout(visibility_timeout_seconds);
+  }
   sqs_client_->ReceiveMessageAsync(
       receive_message_request,
       bind(&AwsQueueClientProvider::OnReceiveMessageCallback, this,
@@ -286,7 +377,8 @@ void AwsQueueClientProvider::OnReceiveMessageCallback(
   }
 
   // This should never happen.
-  if (messages.size() > kMaxNumberOfMessagesReceived) {
+  if (messages.size() > static_cast<size_t>(GetNumberOfMessagesToReceive(
+                            *get_top_message_context.request))) {
     execution_result = FailureExecutionResult(
         SC_AWS_QUEUE_CLIENT_PROVIDER_MESSAGES_NUMBER_EXCEEDED);
     SCP_ERROR_CONTEXT(
@@ -299,10 +391,16 @@ void AwsQueueClientProvider::OnReceiveMessageCallback(
     return;
   }
 
-  const auto& message = messages[0];
-  response->set_message_id(message.GetMessageId().c_str());
-  response->set_message_body(message.GetBody().c_str());
-  response->set_receipt_info(message.GetReceiptHandle().c_str());
+  for (const auto& message : messages) {
+    auto* queue_message = response->add_messages();
+    queue_message->set_message_id(message.GetMessageId().c_str());
+    queue_message->set_message_body(message.GetBody().c_str());
+    queue_message->set_receipt_info(message.GetReceiptHandle().c_str());
+  }
+  const auto& message = response->messages(0);
+  response->set_message_id(message.message_id());
+  response->set_message_body(message.message_body());
+  response->set_receipt_info(message.receipt_info());
   get_top_message_context.response = move(response);
   FinishContext(execution_result, get_top_message_context, cpu_async_executor_);
 }
@@ -383,6 +481,165 @@ void AwsQueueClientProvider::OnChangeMessageVisibilityCallback(
                 cpu_async_executor_);
 }
 
+void AwsQueueClientProvider::ExtendMessagesVisibility(
+    const vector<string>& receipt_infos, seconds visibility_timeout) noexcept {
+  for (size_t begin = 0; begin < receipt_infos.size();
+       begin += kMaxBatchEntries) {
+    ChangeMessageVisibilityBatchRequest change_message_visibility_batch_request;
+    change_message_visibility_batch_request.SetQueueUrl(queue_url_.c_str());
+    const size_t end = std::min(begin + kMaxBatchEntries, receipt_infos.size());
+    for (size_t i = begin; i < end; ++i) {
+      ChangeMessageVisibilityBatchRequestEntry entry;
+      entry.SetId(to_string(i - begin).c_str());
+      entry.SetReceiptHandle(receipt_infos[i].c_str());
+      entry.SetVisibilityTimeout(visibility_timeout.count());
+      change_message_visibility_batch_request.AddEntries(move(entry));
+    }
+    sqs_client_->ChangeMessageVisibilityBatchAsync(
+        change_message_visibility_batch_request,
+        bind(&AwsQueueClientProvider::OnChangeMessageVisibilityBatchCallback,
+             this, _1, _2, _3, _4),
+        nullptr);
+  }
+}
+
+void AwsQueueClientProvider::OnChangeMessageVisibilityBatchCallback(
+    const SQSClient* sqs_client,
+    const ChangeMessageVisibilityBatchRequest&
+        change_message_visibility_batch_request,
+    ChangeMessageVisibilityBatchOutcome change_message_visibility_batch_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  // The messages return to the queue once their lease expires.
+  if (!change_message_visibility_batch_outcome.IsSuccess()) {
+    auto error_type =
+        change_message_visibility_batch_outcome.GetError().GetErrorType();
+    auto error_message =
+        change_message_visibility_batch_outcome.GetError().GetMessage().c_str();
+    SCP_ERROR(kAwsQueueClientProvider, kZeroUuid,
+              SqsErrorConverter::ConvertSqsError(error_type),
+              "Failed to extend the visibility of the prefetched messages due "
+              "to AWS SQS service error. Error code: %d, error message: %s",
+              error_type, error_message);
+    return;
+  }
+  for (const auto& failed_entry :
+       change_message_visibility_batch_outcome.GetResult().GetFailed()) {
+    SCP_ERROR(kAwsQueueClientProvider, kZeroUuid,
+              FailureExecutionResult(
+                  SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED),
+              "Failed to extend the visibility of a prefetched message. Error "
+              "code: %s, error message: %s",
+              failed_entry.GetCode().c_str(),
+              failed_entry.GetMessage().c_str());
+  }
+}
+
+ExecutionResult AwsQueueClientProvider::BatchUpdateMessageVisibilityTimeout(
+    AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+                 BatchUpdateMessageVisibilityTimeoutResponse>&
+        batch_update_message_visibility_timeout_context) noexcept {
+  const auto& requests =
+      batch_update_message_visibility_timeout_context.request->requests();
+  auto batch = make_shared<VisibilityTimeoutBatch>();
+  batch->context = batch_update_message_visibility_timeout_context;
+  batch->results.reserve(requests.size());
+  vector<size_t> valid_indices;
+  for (const auto& request : requests) {
+    batch->results.push_back(
+        ValidateUpdateMessageVisibilityTimeoutRequest(request));
+    if (batch->results.back().Successful()) {
+      valid_indices.push_back(batch->results.size() - 1);
+    }
+  }
+  if (valid_indices.empty()) {
+    FinishVisibilityTimeoutBatch(*batch);
+    return SuccessExecutionResult();
+  }
+
+  // The entries are sent with batches of up to the maximum of SQS. Their ids
+  // are the indices of the requests.
+  batch->pending_calls =
+      (valid_indices.size() + kMaxBatchEntries - 1) / kMaxBatchEntries;
+  for (size_t begin = 0; begin < valid_indices.size();
+       begin += kMaxBatchEntries) {
+    ChangeMessageVisibilityBatchRequest change_message_visibility_batch_request;
+    change_message_visibility_batch_request.SetQueueUrl(queue_url_.c_str());
+    const size_t end = std::min(begin + kMaxBatchEntries, valid_indices.size());
+    for (size_t i = begin; i < end; ++i) {
+      const auto& request = requests[valid_indices[i]];
+      ChangeMessageVisibilityBatchRequestEntry entry;
+      entry.SetId(to_string(valid_indices[i]).c_str());
+      entry.SetReceiptHandle(request.receipt_info().c_str());
+      entry.SetVisibilityTimeout(
+          request.message_visibility_timeout().seconds());
+      change_message_visibility_batch_request.AddEntries(move(entry));
+    }
+    sqs_client_->ChangeMessageVisibilityBatchAsync(
+        change_message_visibility_batch_request,
+        bind(&AwsQueueClientProvider::
+                 OnBatchUpdateMessageVisibilityTimeoutCallback,
+             this, batch, _1, _2, _3, _4),
+        nullptr);
+  }
+  return SuccessExecutionResult();
+}
+
+void AwsQueueClientProvider::OnBatchUpdateMessageVisibilityTimeoutCallback(
+    const shared_ptr<VisibilityTimeoutBatch>& batch,
+    const SQSClient* sqs_client,
+    const ChangeMessageVisibilityBatchRequest&
+        change_message_visibility_batch_request,
+    ChangeMessageVisibilityBatchOutcome change_message_visibility_batch_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  // Every call sets the results of its own entries only.
+  if (!change_message_visibility_batch_outcome.IsSuccess()) {
+    auto error_type =
+        change_message_visibility_batch_outcome.GetError().GetErrorType();
+    auto error_message =
+        change_message_visibility_batch_outcome.GetError().GetMessage().c_str();
+    auto execution_result = SqsErrorConverter::ConvertSqsError(error_type);
+    const auto& entries = change_message_visibility_batch_request.GetEntries();
+    SCP_ERROR_CONTEXT(kAwsQueueClientProvider, batch->context, execution_result,
+                      "Failed to change the visibility of %d messages due to "
+                      "AWS SQS service error. Error code: %d, error message: "
+                      "%s",
+                      entries.size(), error_type, error_message);
+    for (const auto& entry : entries) {
+      batch->results[std::stoul(entry.GetId().c_str())] = execution_result;
+    }
+  } else {
+    for (const auto& failed_entry :
+         change_message_visibility_batch_outcome.GetResult().GetFailed()) {
+      const size_t index = std::stoul(failed_entry.GetId().c_str());
+      if (index >= batch->results.size()) {
+        continue;
+      }
+      batch->results[index] = FailureExecutionResult(
+          SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED);
+      SCP_ERROR_CONTEXT(kAwsQueueClientProvider, batch->context,
+                        batch->results[index],
+                        "Failed to change the visibility of a message in the "
+                        "batch. Error code: %s, error message: %s",
+                        failed_entry.GetCode().c_str(),
+                        failed_entry.GetMessage().c_str());
+    }
+  }
+
+  if (batch->pending_calls.fetch_sub(1) == 1) {
+    FinishVisibilityTimeoutBatch(*batch);
+  }
+}
+
+void AwsQueueClientProvider::FinishVisibilityTimeoutBatch(
+    VisibilityTimeoutBatch& batch) noexcept {
+  auto response = make_shared<BatchUpdateMessageVisibilityTimeoutResponse>();
+  for (auto& result : batch.results) {
+    *response->add_responses()->mutable_result() = result.ToProto();
+  }
+  batch.context.response = move(response);
+  FinishContext(SuccessExecutionResult(), batch.context, cpu_async_executor_);
+}
+
 ExecutionResult AwsQueueClientProvider::DeleteMessage(
     AsyncContext<DeleteMessageRequest, DeleteMessageResponse>&
         delete_message_context) noexcept {
@@ -398,6 +655,11 @@ ExecutionResult AwsQueueClientProvider::DeleteMessage(
     return execution_result;
   }
 
+  if (delete_message_batcher_) {
+    delete_message_batcher_->DeleteMessage(delete_message_context);
+    return SuccessExecutionResult();
+  }
+
   Aws::SQS::Model::DeleteMessageRequest delete_message_request;
   delete_message_request.SetQueueUrl(queue_url_.c_str());
   delete_message_request.SetReceiptHandle(receipt_info.c_str());
@@ -433,6 +695,71 @@ void AwsQueueClientProvider::OnDeleteMessageCallback(
   FinishContext(execution_result, delete_message_context, cpu_async_executor_);
 }
 
+void AwsQueueClientProvider::DeleteMessageBatch(
+    vector<DeleteMessageBatcher::DeleteMessageContext>&
+        delete_message_contexts) noexcept {
+  DeleteMessageBatchRequest delete_message_batch_request;
+  delete_message_batch_request.SetQueueUrl(queue_url_.c_str());
+  for (size_t i = 0; i < delete_message_contexts.size(); ++i) {
+    DeleteMessageBatchRequestEntry entry;
+    entry.SetId(to_string(i).c_str());
+    entry.SetReceiptHandle(
+        delete_message_contexts[i].request->receipt_info().c_str());
+    delete_message_batch_request.AddEntries(move(entry));
+  }
+
+  sqs_client_->DeleteMessageBatchAsync(
+      delete_message_batch_request,
+      bind(&AwsQueueClientProvider::OnDeleteMessageBatchCallback, this,
+           delete_message_contexts, _1, _2, _3, _4),
+      nullptr);
+}
+
+void AwsQueueClientProvider::OnDeleteMessageBatchCallback(
+    vector<DeleteMessageBatcher::DeleteMessageContext>& delete_message_contexts,
+    const SQSClient* sqs_client,
+    const DeleteMessageBatchRequest& delete_message_batch_request,
+    DeleteMessageBatchOutcome delete_message_batch_outcome,
+    const shared_ptr<const AsyncCallerContext> async_context) noexcept {
+  vector<ExecutionResult> execution_results(delete_message_contexts.size(),
+                                            SuccessExecutionResult());
+  if (!delete_message_batch_outcome.IsSuccess()) {
+    auto error_type = delete_message_batch_outcome.GetError().GetErrorType();
+    auto error_message =
+        delete_message_batch_outcome.GetError().GetMessage().c_str();
+    auto execution_result = SqsErrorConverter::ConvertSqsError(error_type);
+    SCP_ERROR_CONTEXT(kAwsQueueClientProvider, delete_message_contexts[0],
+                      execution_result,
+                      "Failed to delete %d messages due to AWS SQS service "
+                      "error. Error code: %d, error message: %s",
+                      delete_message_contexts.size(), error_type,
+                      error_message);
+    execution_results.assign(delete_message_contexts.size(), execution_result);
+  } else {
+    for (const auto& failed_entry :
+         delete_message_batch_outcome.GetResult().GetFailed()) {
+      const size_t index = std::stoul(failed_entry.GetId().c_str());
+      if (index >= delete_message_contexts.size()) {
+        continue;
+      }
+      execution_results[index] = FailureExecutionResult(
+          SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED);
+      SCP_ERROR_CONTEXT(kAwsQueueClientProvider, delete_message_contexts[index],
+                        execution_results[index],
+                        "Failed to delete message in the batch. Error code: "
+                        "%s, error message: %s",
+                        failed_entry.GetCode().c_str(),
+                        failed_entry.GetMessage().c_str());
+    }
+  }
+
+  for (size_t i = 0; i < delete_message_contexts.size(); ++i) {
+    FinishContext(execution_results[i], delete_message_contexts[i],
+                  cpu_async_executor_);
+  }
+  delete_message_batcher_->OnBatchDeleted();
+}
+
 shared_ptr<SQSClient> AwsSqsClientFactory::CreateSqsClient(
     const shared_ptr<ClientConfiguration> client_config) noexcept {
   return make_shared<SQSClient>(*client_config);
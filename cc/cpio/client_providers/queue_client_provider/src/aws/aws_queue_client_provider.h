@@ -16,14 +16,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "aws/sqs/SQSClient.h"
 #include "core/interface/async_context.h"
 #include "cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "cpio/client_providers/interface/queue_client_provider_interface.h"
+#include "cpio/client_providers/queue_client_provider/src/common/delete_message_batcher.h"
+#include "cpio/client_providers/queue_client_provider/src/common/queue_message_prefetcher.h"
 #include "public/core/interface/execution_result.h"
 #include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
 
@@ -74,6 +79,13 @@ class AwsQueueClientProvider : public QueueClientProviderInterface {
           cmrt::sdk::queue_service::v1::UpdateMessageVisibilityTimeoutResponse>&
           update_message_visibility_timeout_context) noexcept override;
 
+  core::ExecutionResult BatchUpdateMessageVisibilityTimeout(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutRequest,
+                         cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutResponse>&
+          batch_update_message_visibility_timeout_context) noexcept override;
+
   core::ExecutionResult DeleteMessage(
       core::AsyncContext<cmrt::sdk::queue_service::v1::DeleteMessageRequest,
                          cmrt::sdk::queue_service::v1::DeleteMessageResponse>&
@@ -96,6 +108,128 @@ class AwsQueueClientProvider : public QueueClientProviderInterface {
    */
   core::ExecutionResultOr<std::string> GetQueueUrl() noexcept;
 
+  /**
+   * @brief Receives the messages from SQS, with the same contract as
+   * GetTopMessage.
+   *
+   * @param get_top_message_context The get top message context object.
+   * @param visibility_timeout_seconds How long the messages are invisible to
+   * the other consumers. 0 for the default of the queue.
+   */
+  core::ExecutionResult ReceiveMessages(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::GetTopMessageRequest,
+                         cmrt::sdk::queue_service::v1::GetTopMessageResponse>&
+          get_top_message_context,
+      int32_t visibility_timeout_seconds) noexcept;
+
+  /**
+   * @brief Extends the visibility timeout of the prefetched messages, with
+   * batches of up to the maximum of SQS. The failures are only logged.
+   *
+   * @param receipt_infos The receipt infos of the messages.
+   * @param visibility_timeout The new visibility timeout.
+   */
+  void ExtendMessagesVisibility(
+      const std::vector<std::string>& receipt_infos,
+      std::chrono::seconds visibility_timeout) noexcept;
+
+  /**
+   * @brief Is called when the object is returned from the SQS Change Message
+   * Visibility Batch callback.
+   *
+   * @param sqs_client An instance of the SQS client.
+   * @param change_message_visibility_batch_request The change message
+   * visibility batch request.
+   * @param change_message_visibility_batch_outcome The change message
+   * visibility batch outcome of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnChangeMessageVisibilityBatchCallback(
+      const Aws::SQS::SQSClient* sqs_client,
+      const Aws::SQS::Model::ChangeMessageVisibilityBatchRequest&
+          change_message_visibility_batch_request,
+      Aws::SQS::Model::ChangeMessageVisibilityBatchOutcome
+          change_message_visibility_batch_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /// The state of the SQS calls of one BatchUpdateMessageVisibilityTimeout.
+  struct VisibilityTimeoutBatch {
+    core::AsyncContext<cmrt::sdk::queue_service::v1::
+                           BatchUpdateMessageVisibilityTimeoutRequest,
+                       cmrt::sdk::queue_service::v1::
+                           BatchUpdateMessageVisibilityTimeoutResponse>
+        context;
+    /// The results of the updates, in the order of the requests.
+    std::vector<core::ExecutionResult> results;
+    /// The number of SQS calls not completed yet.
+    std::atomic<size_t> pending_calls{0};
+  };
+
+  /**
+   * @brief Is called when the object is returned from the SQS Change Message
+   * Visibility Batch callback of a BatchUpdateMessageVisibilityTimeout.
+   * Finishes the context after the last call of the batch.
+   *
+   * @param batch The state of the batch.
+   * @param sqs_client An instance of the SQS client.
+   * @param change_message_visibility_batch_request The change message
+   * visibility batch request. The ids of its entries are the indices of the
+   * requests of the batch.
+   * @param change_message_visibility_batch_outcome The change message
+   * visibility batch outcome of the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnBatchUpdateMessageVisibilityTimeoutCallback(
+      const std::shared_ptr<VisibilityTimeoutBatch>& batch,
+      const Aws::SQS::SQSClient* sqs_client,
+      const Aws::SQS::Model::ChangeMessageVisibilityBatchRequest&
+          change_message_visibility_batch_request,
+      Aws::SQS::Model::ChangeMessageVisibilityBatchOutcome
+          change_message_visibility_batch_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
+  /**
+   * @brief Finishes the context of a BatchUpdateMessageVisibilityTimeout with
+   * the results of its updates.
+   *
+   * @param batch The state of the batch.
+   */
+  void FinishVisibilityTimeoutBatch(VisibilityTimeoutBatch& batch) noexcept;
+
+  /**
+   * @brief Deletes the messages of the contexts with one SQS
+   * DeleteMessageBatch call.
+   *
+   * @param delete_message_contexts The delete message context objects.
+   */
+  void DeleteMessageBatch(
+      std::vector<DeleteMessageBatcher::DeleteMessageContext>&
+          delete_message_contexts) noexcept;
+
+  /**
+   * @brief Is called when the object is returned from the SQS Delete Message
+   * Batch callback.
+   *
+   * @param delete_message_contexts The delete message context objects, in the
+   * order of the entries.
+   * @param sqs_client An instance of the SQS client.
+   * @param delete_message_batch_request The delete message batch request.
+   * @param delete_message_batch_outcome The delete message batch outcome of
+   * the async operation.
+   * @param async_context The Aws async context. This arg is not used.
+   */
+  void OnDeleteMessageBatchCallback(
+      std::vector<DeleteMessageBatcher::DeleteMessageContext>&
+          delete_message_contexts,
+      const Aws::SQS::SQSClient* sqs_client,
+      const Aws::SQS::Model::DeleteMessageBatchRequest&
+          delete_message_batch_request,
+      Aws::SQS::Model::DeleteMessageBatchOutcome delete_message_batch_outcome,
+      const std::shared_ptr<const Aws::Client::AsyncCallerContext>
+          async_context) noexcept;
+
   /**
    * @brief Is called when the object is returned from the SQS SendMessage
    * callback.
@@ -203,6 +337,13 @@ class AwsQueueClientProvider : public QueueClientProviderInterface {
 
   /// An Instance of the AWS SQS client.
   std::shared_ptr<Aws::SQS::SQSClient> sqs_client_;
+
+  /// Buffers the prefetched messages. Null unless prefetch_count is set.
+  std::unique_ptr<QueueMessagePrefetcher> message_prefetcher_;
+
+  /// Batches the deletions. Null unless
+  /// max_delete_message_batches_in_flight is set.
+  std::unique_ptr<DeleteMessageBatcher> delete_message_batcher_;
 };
 
 /// Provides AwsSqsClient.
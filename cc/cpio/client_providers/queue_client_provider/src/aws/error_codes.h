@@ -53,6 +53,10 @@ DEFINE_ERROR_CODE(SC_AWS_QUEUE_CLIENT_PROVIDER_MESSAGE_NOT_IN_FLIGHT,
                   "Cannot execute SQS operation due to the message assoicated "
                   "with the receipt info is not in flight",
                   HttpStatusCode::BAD_REQUEST)
+DEFINE_ERROR_CODE(SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED,
+                  SC_AWS_QUEUE_CLIENT_PROVIDER, 0x0008,
+                  "The entry of the message failed in the SQS batch operation",
+                  HttpStatusCode::BAD_REQUEST)
 MAP_TO_PUBLIC_ERROR_CODE(
     SC_AWS_QUEUE_CLIENT_PROVIDER_QUEUE_CLIENT_OPTIONS_REQUIRED,
     SC_CPIO_INTERNAL_ERROR)
@@ -69,4 +73,6 @@ MAP_TO_PUBLIC_ERROR_CODE(
     SC_CPIO_INVALID_REQUEST)
 MAP_TO_PUBLIC_ERROR_CODE(SC_AWS_QUEUE_CLIENT_PROVIDER_MESSAGE_NOT_IN_FLIGHT,
                          SC_CPIO_INVALID_REQUEST)
+MAP_TO_PUBLIC_ERROR_CODE(SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED,
+                         SC_CPIO_INVALID_REQUEST)
 }  // namespace google::scp::core::errors
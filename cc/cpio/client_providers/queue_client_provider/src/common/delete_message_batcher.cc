@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "delete_message_batcher.h"
+
+#include <mutex>
+#include <vector>
+
+using std::vector;
+
+namespace google::scp::cpio::client_providers {
+void DeleteMessageBatcher::DeleteMessage(
+    DeleteMessageContext& delete_message_context) noexcept {
+  vector<DeleteMessageContext> batch;
+  {
+    std::lock_guard lock(mutex_);
+    queued_contexts_.push_back(delete_message_context);
+    batch = TakeBatch();
+  }
+  if (!batch.empty()) {
+    delete_batch_(batch);
+  }
+}
+
+void DeleteMessageBatcher::OnBatchDeleted() noexcept {
+  vector<DeleteMessageContext> batch;
+  {
+    std::lock_guard lock(mutex_);
+    batches_in_flight_--;
+    batch = TakeBatch();
+  }
+  if (!batch.empty()) {
+    delete_batch_(batch);
+  }
+}
+
+vector<DeleteMessageBatcher::DeleteMessageContext>
+DeleteMessageBatcher::TakeBatch() noexcept {
+  vector<DeleteMessageContext> batch;
+  if (queued_contexts_.empty() ||
+      batches_in_flight_ >= max_batches_in_flight_) {
+    return batch;
+  }
+  while (batch.size() < max_batch_size_ && !queued_contexts_.empty()) {
+    batch.push_back(queued_contexts_.front());
+    queued_contexts_.pop_front();
+  }
+  batches_in_flight_++;
+  return batch;
+}
+}  // namespace google::scp::cpio::client_providers
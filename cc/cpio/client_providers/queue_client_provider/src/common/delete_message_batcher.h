@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "core/interface/async_context.h"
+#include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Batches the DeleteMessage calls of a queue client provider.
+ *
+ * The deletions are sent right away while fewer than max_batches_in_flight
+ * batches are in flight. Otherwise they are queued, and sent in batches of up
+ * to max_batch_size as soon as a batch in flight is done. This only delays
+ * the deletions when the queue is the bottleneck.
+ */
+class DeleteMessageBatcher {
+ public:
+  using DeleteMessageContext = core::AsyncContext<
+      cmrt::sdk::queue_service::v1::DeleteMessageRequest,
+      cmrt::sdk::queue_service::v1::DeleteMessageResponse>;
+  /// Deletes the messages of the contexts and finishes all of them, then
+  /// calls OnBatchDeleted().
+  using DeleteBatchFunction =
+      std::function<void(std::vector<DeleteMessageContext>&)>;
+
+  /**
+   * @param max_batch_size the maximum number of messages per batch.
+   * @param max_batches_in_flight the maximum number of batches in flight.
+   * @param delete_batch what deletes a batch of messages.
+   */
+  DeleteMessageBatcher(size_t max_batch_size, size_t max_batches_in_flight,
+                       DeleteBatchFunction delete_batch)
+      : max_batch_size_(max_batch_size),
+        max_batches_in_flight_(max_batches_in_flight),
+        delete_batch_(std::move(delete_batch)) {}
+
+  DeleteMessageBatcher(const DeleteMessageBatcher&) = delete;
+  DeleteMessageBatcher& operator=(const DeleteMessageBatcher&) = delete;
+
+  /// Deletes the message, now or with the next batch.
+  void DeleteMessage(DeleteMessageContext& delete_message_context) noexcept;
+
+  /// Records that a batch is done, and sends the queued deletions if any.
+  void OnBatchDeleted() noexcept;
+
+ private:
+  /// Takes the next batch if one can be sent. Must hold mutex_.
+  std::vector<DeleteMessageContext> TakeBatch() noexcept;
+
+  const size_t max_batch_size_;
+  const size_t max_batches_in_flight_;
+  const DeleteBatchFunction delete_batch_;
+
+  std::mutex mutex_;
+  /// The deletions waiting for a batch.
+  std::deque<DeleteMessageContext> queued_contexts_;
+  size_t batches_in_flight_ = 0;
+};
+}  // namespace google::scp::cpio::client_providers
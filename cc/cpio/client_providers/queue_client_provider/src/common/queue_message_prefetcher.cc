@@ -0,0 +1,189 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "queue_message_prefetcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using google::cmrt::sdk::queue_service::v1::GetTopMessageRequest;
+using google::cmrt::sdk::queue_service::v1::GetTopMessageResponse;
+using google::cmrt::sdk::queue_service::v1::QueueMessage;
+using google::scp::core::ExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using std::make_shared;
+using std::move;
+using std::string;
+using std::vector;
+using std::chrono::steady_clock;
+
+namespace google::scp::cpio::client_providers {
+ExecutionResult QueueMessagePrefetcher::GetTopMessage(
+    GetTopMessageContext& get_top_message_context) noexcept {
+  vector<QueueMessage> messages;
+  vector<string> receipt_infos_to_extend;
+  size_t messages_to_receive = 0;
+  bool is_waiting = false;
+  {
+    std::lock_guard lock(mutex_);
+    receipt_infos_to_extend = RenewLeases(steady_clock::now());
+    messages = PopMessages(get_top_message_context);
+    is_waiting = messages.empty();
+    if (is_waiting) {
+      waiting_contexts_.push_back(get_top_message_context);
+    }
+    messages_to_receive = StartReceiveIfNeeded();
+  }
+
+  if (!receipt_infos_to_extend.empty()) {
+    extend_visibility_(receipt_infos_to_extend, visibility_timeout_);
+  }
+  if (!is_waiting) {
+    FinishWithMessages(get_top_message_context, move(messages));
+  }
+  if (messages_to_receive == 0) {
+    return SuccessExecutionResult();
+  }
+
+  auto request = make_shared<GetTopMessageRequest>();
+  request->set_max_number_of_messages(messages_to_receive);
+  // Only long-poll when the caller waits for the messages.
+  if (is_waiting) {
+    request->set_wait_time_seconds(
+        get_top_message_context.request->wait_time_seconds());
+  }
+  // Leased from now on, the queue may receive the messages a bit later.
+  auto lease_expiration_time = steady_clock::now() + visibility_timeout_;
+  GetTopMessageContext receive_context(
+      move(request),
+      [this, lease_expiration_time](GetTopMessageContext& context) {
+        OnReceived(lease_expiration_time, context);
+      },
+      get_top_message_context);
+  // The failures are reported to the callback of the context.
+  receive_(receive_context);
+  return SuccessExecutionResult();
+}
+
+void QueueMessagePrefetcher::OnReceived(
+    steady_clock::time_point lease_expiration_time,
+    GetTopMessageContext& receive_context) noexcept {
+  vector<GetTopMessageContext> waiting_contexts;
+  vector<vector<QueueMessage>> messages_of_waiting_contexts;
+  {
+    std::lock_guard lock(mutex_);
+    is_receive_in_flight_ = false;
+    if (receive_context.result.Successful() && receive_context.response) {
+      for (const auto& message : receive_context.response->messages()) {
+        buffered_messages_.push_back({message, lease_expiration_time});
+      }
+    }
+    waiting_contexts = move(waiting_contexts_);
+    waiting_contexts_.clear();
+    for (const auto& waiting_context : waiting_contexts) {
+      messages_of_waiting_contexts.push_back(PopMessages(waiting_context));
+    }
+  }
+
+  for (size_t i = 0; i < waiting_contexts.size(); ++i) {
+    auto& waiting_context = waiting_contexts[i];
+    if (!receive_context.result.Successful()) {
+      waiting_context.result = receive_context.result;
+      waiting_context.Finish();
+      continue;
+    }
+    // Like a long poll without messages, when the batch is too small.
+    FinishWithMessages(waiting_context, move(messages_of_waiting_contexts[i]));
+  }
+}
+
+vector<string> QueueMessagePrefetcher::RenewLeases(
+    steady_clock::time_point now) noexcept {
+  vector<string> receipt_infos_to_extend;
+  buffered_messages_.erase(
+      std::remove_if(buffered_messages_.begin(), buffered_messages_.end(),
+                     [now](const BufferedMessage& buffered_message) {
+                       return buffered_message.lease_expiration_time <= now;
+                     }),
+      buffered_messages_.end());
+  for (auto& buffered_message : buffered_messages_) {
+    if (2 * (buffered_message.lease_expiration_time - now) <
+        visibility_timeout_) {
+      receipt_infos_to_extend.push_back(
+          buffered_message.message.receipt_info());
+      buffered_message.lease_expiration_time = now + visibility_timeout_;
+    }
+  }
+  return receipt_infos_to_extend;
+}
+
+vector<QueueMessage> QueueMessagePrefetcher::PopMessages(
+    const GetTopMessageContext& get_top_message_context) noexcept {
+  const size_t max_number_of_messages = std::max(
+      1, get_top_message_context.request->max_number_of_messages());
+  vector<QueueMessage> messages;
+  while (messages.size() < max_number_of_messages &&
+         !buffered_messages_.empty()) {
+    messages.push_back(move(buffered_messages_.front().message));
+    buffered_messages_.pop_front();
+  }
+  return messages;
+}
+
+size_t QueueMessagePrefetcher::StartReceiveIfNeeded() noexcept {
+  if (is_receive_in_flight_ ||
+      buffered_messages_.size() > prefetch_count_ / 2) {
+    return 0;
+  }
+  // Also receives the messages of the waiting contexts.
+  size_t messages_to_receive = std::min(
+      prefetch_count_ - buffered_messages_.size() + waiting_contexts_.size(),
+      max_messages_per_receive_);
+  if (messages_to_receive == 0) {
+    return 0;
+  }
+  is_receive_in_flight_ = true;
+  return messages_to_receive;
+}
+
+void QueueMessagePrefetcher::Clear() noexcept {
+  std::lock_guard lock(mutex_);
+  buffered_messages_.clear();
+}
+
+void QueueMessagePrefetcher::FinishWithMessages(
+    GetTopMessageContext& get_top_message_context,
+    vector<QueueMessage> messages) noexcept {
+  auto response = make_shared<GetTopMessageResponse>();
+  if (!messages.empty()) {
+    response->set_message_id(messages[0].message_id());
+    response->set_message_body(messages[0].message_body());
+    response->set_receipt_info(messages[0].receipt_info());
+  }
+  for (auto& message : messages) {
+    *response->add_messages() = move(message);
+  }
+  get_top_message_context.response = move(response);
+  get_top_message_context.result = SuccessExecutionResult();
+  get_top_message_context.Finish();
+}
+}  // namespace google::scp::cpio::client_providers
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/interface/async_context.h"
+#include "public/core/interface/execution_result.h"
+#include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
+
+namespace google::scp::cpio::client_providers {
+/**
+ * @brief Buffers the messages of a queue client provider locally, so that
+ * most of the GetTopMessage calls are served without a call to the queue.
+ *
+ * The buffer is refilled with batches of messages, leased for the visibility
+ * timeout, whenever it is at most half full. Whenever the buffer is accessed,
+ * the leases of the buffered messages with less than half of the visibility
+ * timeout left are extended, and the expired ones are dropped since the queue
+ * may have delivered them again.
+ */
+class QueueMessagePrefetcher {
+ public:
+  using GetTopMessageContext = core::AsyncContext<
+      cmrt::sdk::queue_service::v1::GetTopMessageRequest,
+      cmrt::sdk::queue_service::v1::GetTopMessageResponse>;
+  /// Receives the messages leased for the visibility timeout, with the same
+  /// contract as GetTopMessage.
+  using ReceiveFunction =
+      std::function<core::ExecutionResult(GetTopMessageContext&)>;
+  /// Extends the visibility timeout of the messages with the receipt infos.
+  /// The outcome is not waited for.
+  using ExtendVisibilityFunction =
+      std::function<void(const std::vector<std::string>& receipt_infos,
+                         std::chrono::seconds visibility_timeout)>;
+
+  /**
+   * @param prefetch_count the number of messages to keep buffered.
+   * @param max_messages_per_receive the maximum number of messages receive
+   * can return.
+   * @param visibility_timeout how long the messages are leased for.
+   * @param receive what receives the messages from the queue.
+   * @param extend_visibility what extends the leases of the messages.
+   */
+  QueueMessagePrefetcher(size_t prefetch_count, size_t max_messages_per_receive,
+                         std::chrono::seconds visibility_timeout,
+                         ReceiveFunction receive,
+                         ExtendVisibilityFunction extend_visibility)
+      : prefetch_count_(prefetch_count),
+        max_messages_per_receive_(max_messages_per_receive),
+        visibility_timeout_(visibility_timeout),
+        receive_(std::move(receive)),
+        extend_visibility_(std::move(extend_visibility)) {}
+
+  QueueMessagePrefetcher(const QueueMessagePrefetcher&) = delete;
+  QueueMessagePrefetcher& operator=(const QueueMessagePrefetcher&) = delete;
+
+  /**
+   * @brief Finishes the context with up to max_number_of_messages buffered
+   * messages. When the buffer is empty, waits for the next receive, which
+   * long-polls for wait_time_seconds.
+   *
+   * @param get_top_message_context the context of the GetTopMessage.
+   * @return core::ExecutionResult always success, the failures of receive are
+   * reported to the waiting contexts.
+   */
+  core::ExecutionResult GetTopMessage(
+      GetTopMessageContext& get_top_message_context) noexcept;
+
+  /// Drops the buffered messages, their leases expire on their own.
+  void Clear() noexcept;
+
+ private:
+  struct BufferedMessage {
+    cmrt::sdk::queue_service::v1::QueueMessage message;
+    std::chrono::steady_clock::time_point lease_expiration_time;
+  };
+
+  /// Finishes the contexts waiting for the receive.
+  void OnReceived(std::chrono::steady_clock::time_point lease_expiration_time,
+                  GetTopMessageContext& receive_context) noexcept;
+
+  /// Drops the expired messages, and renews the leases with less than half
+  /// of the visibility timeout left. Must hold mutex_.
+  std::vector<std::string> RenewLeases(
+      std::chrono::steady_clock::time_point now) noexcept;
+
+  /// Pops up to the number of messages the context requests. Must hold
+  /// mutex_.
+  std::vector<cmrt::sdk::queue_service::v1::QueueMessage> PopMessages(
+      const GetTopMessageContext& get_top_message_context) noexcept;
+
+  /// Starts a receive if the buffer is at most half full and none is in
+  /// flight. Returns the number of messages to receive, 0 if none. Must hold
+  /// mutex_.
+  size_t StartReceiveIfNeeded() noexcept;
+
+  /// Finishes the context with the messages.
+  static void FinishWithMessages(
+      GetTopMessageContext& get_top_message_context,
+      std::vector<cmrt::sdk::queue_service::v1::QueueMessage>
+          messages) noexcept;
+
+  const size_t prefetch_count_;
+  const size_t max_messages_per_receive_;
+  const std::chrono::seconds visibility_timeout_;
+  const ReceiveFunction receive_;
+  const ExtendVisibilityFunction extend_visibility_;
+
+  std::mutex mutex_;
+  /// The buffered messages, the oldest first.
+  std::deque<BufferedMessage> buffered_messages_;
+  /// The contexts waiting for the receive in flight.
+  std::vector<GetTopMessageContext> waiting_contexts_;
+  bool is_receive_in_flight_ = false;
+};
+}  // namespace google::scp::cpio::client_providers
@@ -16,7 +16,12 @@
 
 #include "gcp_queue_client_provider.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
@@ -31,6 +36,10 @@
 #include "error_codes.h"
 
 using absl::StrFormat;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutRequest;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutResponse;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageRequest;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageRequest;
@@ -87,19 +96,41 @@ using grpc::StatusCode;
 using grpc::StubOptions;
 using std::bind;
 using std::make_shared;
+using std::make_unique;
 using std::move;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::vector;
+using std::chrono::seconds;
 using std::placeholders::_1;
+using std::placeholders::_2;
 
 static constexpr char kGcpQueueClientProvider[] = "GcpQueueClientProvider";
 static constexpr char kPubSubEndpointUri[] = "pubsub.googleapis.com";
 static constexpr char kGcpTopicFormatString[] = "projects/%s/topics/%s";
 static constexpr char kGcpSubscriptionFormatString[] =
     "projects/%s/subscriptions/%s";
-static constexpr uint8_t kMaxNumberOfMessagesReceived = 1;
+static constexpr int kDefaultNumberOfMessagesReceived = 1;
 static constexpr uint16_t kMaxAckDeadlineSeconds = 600;
+/// The maximum number of messages per prefetching Pull.
+static constexpr size_t kMaxNumberOfMessagesPrefetched = 1000;
+/// The maximum number of ack ids per Acknowledge or ModifyAckDeadline.
+static constexpr size_t kMaxAckIdsPerRequest = 1000;
+
+/// Validates the receipt info and the visibility timeout of the request.
+static ExecutionResult ValidateUpdateMessageVisibilityTimeoutRequest(
+    const UpdateMessageVisibilityTimeoutRequest& request) noexcept {
+  if (request.receipt_info().empty()) {
+    return FailureExecutionResult(SC_GCP_QUEUE_CLIENT_PROVIDER_INVALID_MESSAGE);
+  }
+  auto lifetime_in_seconds = request.message_visibility_timeout().seconds();
+  if (lifetime_in_seconds < 0 || lifetime_in_seconds > kMaxAckDeadlineSeconds) {
+    return FailureExecutionResult(
+        SC_GCP_QUEUE_CLIENT_PROVIDER_INVALID_VISIBILITY_TIMEOUT);
+  }
+  return SuccessExecutionResult();
+}
 
 namespace google::scp::cpio::client_providers {
 
@@ -121,6 +152,27 @@ ExecutionResult GcpQueueClientProvider::Init() noexcept {
     return execution_result;
   }
 
+  if (queue_client_options_->prefetch_count > 0) {
+    const int32_t ack_deadline_seconds = std::clamp<int32_t>(
+        queue_client_options_->prefetched_message_visibility_timeout_seconds,
+        1, kMaxAckDeadlineSeconds);
+    message_prefetcher_ = make_unique<QueueMessagePrefetcher>(
+        queue_client_options_->prefetch_count, kMaxNumberOfMessagesPrefetched,
+        seconds(ack_deadline_seconds),
+        [this, ack_deadline_seconds](
+            AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+                get_top_message_context) {
+          return ReceiveMessages(get_top_message_context, ack_deadline_seconds);
+        },
+        bind(&GcpQueueClientProvider::ExtendMessagesVisibility, this, _1, _2));
+  }
+  if (queue_client_options_->max_delete_message_batches_in_flight > 0) {
+    delete_message_batcher_ = make_unique<DeleteMessageBatcher>(
+        kMaxAckIdsPerRequest,
+        queue_client_options_->max_delete_message_batches_in_flight,
+        bind(&GcpQueueClientProvider::DeleteMessageBatch, this, _1));
+  }
+
   return SuccessExecutionResult();
 }
 
@@ -163,6 +215,9 @@ ExecutionResult GcpQueueClientProvider::Run() noexcept {
 }
 
 ExecutionResult GcpQueueClientProvider::Stop() noexcept {
+  if (message_prefetcher_) {
+    message_prefetcher_->Clear();
+  }
   return SuccessExecutionResult();
 }
 
@@ -247,9 +302,19 @@ void GcpQueueClientProvider::EnqueueMessageAsync(
 ExecutionResult GcpQueueClientProvider::GetTopMessage(
     AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
         get_top_message_context) noexcept {
+  if (message_prefetcher_) {
+    return message_prefetcher_->GetTopMessage(get_top_message_context);
+  }
+  return ReceiveMessages(get_top_message_context, /*ack_deadline_seconds=*/0);
+}
+
+ExecutionResult GcpQueueClientProvider::ReceiveMessages(
+    AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+        get_top_message_context,
+    int32_t ack_deadline_seconds) noexcept {
   auto execution_result = io_async_executor_->Schedule(
       bind(&GcpQueueClientProvider::GetTopMessageAsync, this,
-           get_top_message_context),
+           get_top_message_context, ack_deadline_seconds),
       AsyncPriority::Normal);
   if (!execution_result.Successful()) {
     get_top_message_context.result = execution_result;
@@ -266,15 +331,33 @@ ExecutionResult GcpQueueClientProvider::GetTopMessage(
 
 void GcpQueueClientProvider::GetTopMessageAsync(
     AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
-        get_top_message_context) noexcept {
+        get_top_message_context,
+    int32_t ack_deadline_seconds) noexcept {
+  const auto& request = *get_top_message_context.request;
   PullRequest pull_request;
   pull_request.set_subscription(subscription_name_);
-  pull_request.set_max_messages(kMaxNumberOfMessagesReceived);
+  pull_request.set_max_messages(request.max_number_of_messages() > 0
+                                    ? request.max_number_of_messages()
+                                    : kDefaultNumberOfMessagesReceived);
   ClientContext client_context;
+  // The pull waits for messages, the deadline bounds how long.
+  if (request.wait_time_seconds() > 0) {
+    client_context.set_deadline(
+        std::chrono::system_clock::now() +
+        std::chrono::seconds(request.wait_time_seconds()));
+  }
   PullResponse pull_response;
   auto status =
       subscriber_stub_->Pull(&client_context, pull_request, &pull_response);
 
+  if (!status.ok() && request.wait_time_seconds() > 0 &&
+      status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+    get_top_message_context.response = make_shared<GetTopMessageResponse>();
+    FinishContext(SuccessExecutionResult(), get_top_message_context,
+                  cpu_async_executor_);
+    return;
+  }
+
   if (!status.ok()) {
     auto execution_result = GcpUtils::GcpErrorConverter(status);
     SCP_ERROR_CONTEXT(
@@ -290,7 +373,7 @@ void GcpQueueClientProvider::GetTopMessageAsync(
   const auto& received_messages = pull_response.received_messages();
 
   // This should never happen.
-  if (received_messages.size() > kMaxNumberOfMessagesReceived) {
+  if (received_messages.size() > pull_request.max_messages()) {
     auto execution_result = FailureExecutionResult(
         SC_GCP_QUEUE_CLIENT_PROVIDER_MESSAGES_NUMBER_EXCEEDED);
     SCP_ERROR_CONTEXT(
@@ -310,17 +393,87 @@ void GcpQueueClientProvider::GetTopMessageAsync(
     return;
   }
 
-  auto received_message = received_messages.at(0);
+  if (ack_deadline_seconds > 0) {
+    vector<string> ack_ids;
+    for (const auto& received_message : received_messages) {
+      ack_ids.push_back(received_message.ack_id());
+    }
+    // The messages are still leased for the deadline of the subscription.
+    auto modify_status = ModifyAckDeadlines(ack_ids, ack_deadline_seconds);
+    if (!modify_status.ok()) {
+      SCP_ERROR_CONTEXT(kGcpQueueClientProvider, get_top_message_context,
+                        GcpUtils::GcpErrorConverter(modify_status),
+                        "Failed to modify the ack deadline of the pulled "
+                        "messages. Subscription: %s",
+                        subscription_name_.c_str());
+    }
+  }
+
   auto response = make_shared<GetTopMessageResponse>();
-  response->set_message_body(received_message.mutable_message()->data());
-  response->set_message_id(received_message.mutable_message()->message_id());
-  response->set_receipt_info(received_message.ack_id());
+  for (const auto& received_message : received_messages) {
+    auto* queue_message = response->add_messages();
+    queue_message->set_message_body(received_message.message().data());
+    queue_message->set_message_id(received_message.message().message_id());
+    queue_message->set_receipt_info(received_message.ack_id());
+  }
+  const auto& message = response->messages(0);
+  response->set_message_body(message.message_body());
+  response->set_message_id(message.message_id());
+  response->set_receipt_info(message.receipt_info());
   get_top_message_context.response = move(response);
 
   FinishContext(SuccessExecutionResult(), get_top_message_context,
                 cpu_async_executor_);
 }
 
+grpc::Status GcpQueueClientProvider::ModifyAckDeadlines(
+    const vector<string>& ack_ids, int32_t ack_deadline_seconds) noexcept {
+  grpc::Status first_failure;
+  for (size_t begin = 0; begin < ack_ids.size();
+       begin += kMaxAckIdsPerRequest) {
+    ModifyAckDeadlineRequest modify_ack_deadline_request;
+    modify_ack_deadline_request.set_subscription(subscription_name_);
+    modify_ack_deadline_request.set_ack_deadline_seconds(ack_deadline_seconds);
+    const size_t end = std::min(begin + kMaxAckIdsPerRequest, ack_ids.size());
+    for (size_t i = begin; i < end; ++i) {
+      modify_ack_deadline_request.add_ack_ids(ack_ids[i]);
+    }
+
+    ClientContext client_context;
+    Empty modify_ack_deadline_response;
+    auto status = subscriber_stub_->ModifyAckDeadline(
+        &client_context, modify_ack_deadline_request,
+        &modify_ack_deadline_response);
+    if (!status.ok() && first_failure.ok()) {
+      first_failure = status;
+    }
+  }
+  return first_failure;
+}
+
+void GcpQueueClientProvider::ExtendMessagesVisibility(
+    const vector<string>& ack_ids, seconds visibility_timeout) noexcept {
+  // The messages return to the subscription once their lease expires.
+  auto execution_result = io_async_executor_->Schedule(
+      [this, ack_ids, visibility_timeout]() {
+        auto status = ModifyAckDeadlines(ack_ids, visibility_timeout.count());
+        if (!status.ok()) {
+          SCP_ERROR(kGcpQueueClientProvider, kZeroUuid,
+                    GcpUtils::GcpErrorConverter(status),
+                    "Failed to extend the ack deadline of the prefetched "
+                    "messages. Subscription: %s",
+                    subscription_name_.c_str());
+        }
+      },
+      AsyncPriority::Normal);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kGcpQueueClientProvider, kZeroUuid, execution_result,
+              "The extension of the ack deadline of the prefetched messages "
+              "failed to be scheduled. Subscription: %s",
+              subscription_name_.c_str());
+  }
+}
+
 ExecutionResult GcpQueueClientProvider::UpdateMessageVisibilityTimeout(
     AsyncContext<UpdateMessageVisibilityTimeoutRequest,
                  UpdateMessageVisibilityTimeoutResponse>&
@@ -413,6 +566,83 @@ void GcpQueueClientProvider::UpdateMessageVisibilityTimeoutAsync(
                 update_message_visibility_timeout_context, cpu_async_executor_);
 }
 
+ExecutionResult GcpQueueClientProvider::BatchUpdateMessageVisibilityTimeout(
+    AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+                 BatchUpdateMessageVisibilityTimeoutResponse>&
+        batch_update_message_visibility_timeout_context) noexcept {
+  vector<ExecutionResult> results;
+  for (const auto& request :
+       batch_update_message_visibility_timeout_context.request->requests()) {
+    results.push_back(ValidateUpdateMessageVisibilityTimeoutRequest(request));
+  }
+
+  auto execution_result = io_async_executor_->Schedule(
+      bind(&GcpQueueClientProvider::BatchUpdateMessageVisibilityTimeoutAsync,
+           this, batch_update_message_visibility_timeout_context,
+           move(results)),
+      AsyncPriority::Normal);
+  if (!execution_result.Successful()) {
+    batch_update_message_visibility_timeout_context.result = execution_result;
+    SCP_ERROR_CONTEXT(kGcpQueueClientProvider,
+                      batch_update_message_visibility_timeout_context,
+                      batch_update_message_visibility_timeout_context.result,
+                      "Batch update message visibility timeout request failed "
+                      "to be scheduled for subscription: %s",
+                      subscription_name_.c_str());
+    batch_update_message_visibility_timeout_context.Finish();
+    return execution_result;
+  }
+  return SuccessExecutionResult();
+}
+
+void GcpQueueClientProvider::BatchUpdateMessageVisibilityTimeoutAsync(
+    AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+                 BatchUpdateMessageVisibilityTimeoutResponse>&
+        batch_update_message_visibility_timeout_context,
+    vector<ExecutionResult> results) noexcept {
+  const auto& requests =
+      batch_update_message_visibility_timeout_context.request->requests();
+  // ModifyAckDeadline sets a single deadline for all of its ack ids.
+  std::map<int32_t, vector<size_t>> indices_by_deadline;
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (results[i].Successful()) {
+      indices_by_deadline[requests[i].message_visibility_timeout().seconds()]
+          .push_back(i);
+    }
+  }
+
+  for (const auto& [ack_deadline_seconds, indices] : indices_by_deadline) {
+    vector<string> ack_ids;
+    ack_ids.reserve(indices.size());
+    for (auto index : indices) {
+      ack_ids.push_back(requests[index].receipt_info());
+    }
+    auto status = ModifyAckDeadlines(ack_ids, ack_deadline_seconds);
+    if (status.ok()) {
+      continue;
+    }
+    auto execution_result = GcpUtils::GcpErrorConverter(status);
+    SCP_ERROR_CONTEXT(kGcpQueueClientProvider,
+                      batch_update_message_visibility_timeout_context,
+                      execution_result,
+                      "Failed to modify the ack deadline of %zu messages due "
+                      "to GCP Pub/Sub service error. Subscription: %s",
+                      ack_ids.size(), subscription_name_.c_str());
+    for (auto index : indices) {
+      results[index] = execution_result;
+    }
+  }
+
+  auto response = make_shared<BatchUpdateMessageVisibilityTimeoutResponse>();
+  for (auto& result : results) {
+    *response->add_responses()->mutable_result() = result.ToProto();
+  }
+  batch_update_message_visibility_timeout_context.response = move(response);
+  FinishContext(SuccessExecutionResult(),
+                batch_update_message_visibility_timeout_context,
+                cpu_async_executor_);
+}
+
 ExecutionResult GcpQueueClientProvider::DeleteMessage(
     AsyncContext<DeleteMessageRequest, DeleteMessageResponse>&
         delete_message_context) noexcept {
@@ -429,6 +659,11 @@ ExecutionResult GcpQueueClientProvider::DeleteMessage(
     return execution_result;
   }
 
+  if (delete_message_batcher_) {
+    delete_message_batcher_->DeleteMessage(delete_message_context);
+    return SuccessExecutionResult();
+  }
+
   auto execution_result = io_async_executor_->Schedule(
       bind(&GcpQueueClientProvider::DeleteMessageAsync, this,
            delete_message_context),
@@ -475,6 +710,63 @@ void GcpQueueClientProvider::DeleteMessageAsync(
                 cpu_async_executor_);
 }
 
+void GcpQueueClientProvider::DeleteMessageBatch(
+    vector<DeleteMessageBatcher::DeleteMessageContext>&
+        delete_message_contexts) noexcept {
+  auto execution_result = io_async_executor_->Schedule(
+      bind(&GcpQueueClientProvider::DeleteMessageBatchAsync, this,
+           delete_message_contexts),
+      AsyncPriority::Normal);
+  if (!execution_result.Successful()) {
+    SCP_ERROR_CONTEXT(kGcpQueueClientProvider, delete_message_contexts[0],
+                      execution_result,
+                      "Delete request of %d messages failed to be scheduled "
+                      "for subscription: %s",
+                      delete_message_contexts.size(),
+                      subscription_name_.c_str());
+    for (auto& delete_message_context : delete_message_contexts) {
+      delete_message_context.result = execution_result;
+      delete_message_context.Finish();
+    }
+    delete_message_batcher_->OnBatchDeleted();
+  }
+}
+
+void GcpQueueClientProvider::DeleteMessageBatchAsync(
+    vector<DeleteMessageBatcher::DeleteMessageContext>&
+        delete_message_contexts) noexcept {
+  AcknowledgeRequest acknowledge_request;
+  acknowledge_request.set_subscription(subscription_name_);
+  for (const auto& delete_message_context : delete_message_contexts) {
+    acknowledge_request.add_ack_ids(
+        delete_message_context.request->receipt_info());
+  }
+
+  ClientContext client_context;
+  Empty acknowledge_response;
+  auto status = subscriber_stub_->Acknowledge(
+      &client_context, acknowledge_request, &acknowledge_response);
+  auto execution_result = SuccessExecutionResult();
+  if (!status.ok()) {
+    execution_result = GcpUtils::GcpErrorConverter(status);
+    SCP_ERROR_CONTEXT(kGcpQueueClientProvider, delete_message_contexts[0],
+                      execution_result,
+                      "Failed to acknowledge %d messages due to GCP Pub/Sub "
+                      "service error. Subscription: %s",
+                      delete_message_contexts.size(),
+                      subscription_name_.c_str());
+  }
+
+  for (auto& delete_message_context : delete_message_contexts) {
+    if (execution_result.Successful()) {
+      delete_message_context.response = make_shared<DeleteMessageResponse>();
+    }
+    FinishContext(execution_result, delete_message_context,
+                  cpu_async_executor_);
+  }
+  delete_message_batcher_->OnBatchDeleted();
+}
+
 shared_ptr<Channel> GcpPubSubStubFactory::GetPubSubChannel(
     const std::shared_ptr<QueueClientOptions>& options) noexcept {
   if (!channel_) {
@@ -16,9 +16,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <google/pubsub/v1/pubsub.grpc.pb.h>
 
@@ -26,6 +28,8 @@
 #include "core/interface/async_executor_interface.h"
 #include "cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "cpio/client_providers/interface/queue_client_provider_interface.h"
+#include "cpio/client_providers/queue_client_provider/src/common/delete_message_batcher.h"
+#include "cpio/client_providers/queue_client_provider/src/common/queue_message_prefetcher.h"
 #include "public/core/interface/execution_result.h"
 #include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
 
@@ -76,6 +80,13 @@ class GcpQueueClientProvider : public QueueClientProviderInterface {
           cmrt::sdk::queue_service::v1::UpdateMessageVisibilityTimeoutResponse>&
           update_message_visibility_timeout_context) noexcept override;
 
+  core::ExecutionResult BatchUpdateMessageVisibilityTimeout(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutRequest,
+                         cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutResponse>&
+          batch_update_message_visibility_timeout_context) noexcept override;
+
   core::ExecutionResult DeleteMessage(
       core::AsyncContext<cmrt::sdk::queue_service::v1::DeleteMessageRequest,
                          cmrt::sdk::queue_service::v1::DeleteMessageResponse>&
@@ -92,15 +103,54 @@ class GcpQueueClientProvider : public QueueClientProviderInterface {
                          cmrt::sdk::queue_service::v1::EnqueueMessageResponse>&
           enqueue_message_context) noexcept;
 
+  /**
+   * @brief Schedules the pull of the messages, with the same contract as
+   * GetTopMessage.
+   *
+   * @param get_top_message_context the get top message context.
+   * @param ack_deadline_seconds the ack deadline to set on the pulled
+   * messages. 0 for the default of the subscription.
+   */
+  core::ExecutionResult ReceiveMessages(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::GetTopMessageRequest,
+                         cmrt::sdk::queue_service::v1::GetTopMessageResponse>&
+          get_top_message_context,
+      int32_t ack_deadline_seconds) noexcept;
+
   /**
    * @brief Is called when the object is returned from the GCP Pull callback.
    *
    * @param get_top_message_context the get top message context.
+   * @param ack_deadline_seconds the ack deadline to set on the pulled
+   * messages. 0 for the default of the subscription.
    */
   void GetTopMessageAsync(
       core::AsyncContext<cmrt::sdk::queue_service::v1::GetTopMessageRequest,
                          cmrt::sdk::queue_service::v1::GetTopMessageResponse>&
-          get_top_message_context) noexcept;
+          get_top_message_context,
+      int32_t ack_deadline_seconds) noexcept;
+
+  /**
+   * @brief Modifies the ack deadline of the messages, with batches of up to
+   * kMaxAckIdsPerRequest ack ids.
+   *
+   * @param ack_ids the ack ids of the messages.
+   * @param ack_deadline_seconds the new ack deadline.
+   * @return grpc::Status the first failure, if any.
+   */
+  grpc::Status ModifyAckDeadlines(const std::vector<std::string>& ack_ids,
+                                  int32_t ack_deadline_seconds) noexcept;
+
+  /**
+   * @brief Schedules the extension of the ack deadline of the prefetched
+   * messages. The failures are only logged.
+   *
+   * @param ack_ids the ack ids of the messages.
+   * @param visibility_timeout the new ack deadline.
+   */
+  void ExtendMessagesVisibility(
+      const std::vector<std::string>& ack_ids,
+      std::chrono::seconds visibility_timeout) noexcept;
 
   /**
    * @brief Is called when the object is returned from the GCP Update Ack
@@ -115,6 +165,23 @@ class GcpQueueClientProvider : public QueueClientProviderInterface {
           cmrt::sdk::queue_service::v1::UpdateMessageVisibilityTimeoutResponse>&
           update_message_visibility_timeout_context) noexcept;
 
+  /**
+   * @brief Modifies the ack deadline of the messages of the valid requests of
+   * a batch, with one GCP ModifyAckDeadline call per distinct deadline.
+   *
+   * @param batch_update_message_visibility_timeout_context the batch update
+   * message visibility timeout context.
+   * @param results the results of the validation of the requests, updated
+   * with the results of the calls.
+   */
+  void BatchUpdateMessageVisibilityTimeoutAsync(
+      core::AsyncContext<cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutRequest,
+                         cmrt::sdk::queue_service::v1::
+                             BatchUpdateMessageVisibilityTimeoutResponse>&
+          batch_update_message_visibility_timeout_context,
+      std::vector<core::ExecutionResult> results) noexcept;
+
   /**
    * @brief Is called when the object is returned from the GCP Acknowledge
    * callback.
@@ -126,6 +193,26 @@ class GcpQueueClientProvider : public QueueClientProviderInterface {
                          cmrt::sdk::queue_service::v1::DeleteMessageResponse>&
           delete_message_context) noexcept;
 
+  /**
+   * @brief Schedules the acknowledgement of the messages of the contexts with
+   * one GCP Acknowledge call.
+   *
+   * @param delete_message_contexts the delete message contexts.
+   */
+  void DeleteMessageBatch(
+      std::vector<DeleteMessageBatcher::DeleteMessageContext>&
+          delete_message_contexts) noexcept;
+
+  /**
+   * @brief Is called when the object is returned from the batched GCP
+   * Acknowledge callback.
+   *
+   * @param delete_message_contexts the delete message contexts.
+   */
+  void DeleteMessageBatchAsync(
+      std::vector<DeleteMessageBatcher::DeleteMessageContext>&
+          delete_message_contexts) noexcept;
+
   /// The configuration for queue client.
   std::shared_ptr<QueueClientOptions> queue_client_options_;
 
@@ -156,6 +243,13 @@ class GcpQueueClientProvider : public QueueClientProviderInterface {
   /// An Instance of the GCP Subscriber stub.
   std::shared_ptr<google::pubsub::v1::Subscriber::StubInterface>
       subscriber_stub_;
+
+  /// Buffers the prefetched messages. Null unless prefetch_count is set.
+  std::unique_ptr<QueueMessagePrefetcher> message_prefetcher_;
+
+  /// Batches the deletions. Null unless
+  /// max_delete_message_batches_in_flight is set.
+  std::unique_ptr<DeleteMessageBatcher> delete_message_batcher_;
 };
 
 /// Provides GCP Pub/Sub stubs.
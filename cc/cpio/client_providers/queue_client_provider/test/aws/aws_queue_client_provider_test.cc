@@ -17,7 +17,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <aws/core/Aws.h>
 #include <aws/sqs/SQSClient.h>
@@ -43,8 +46,14 @@ using Aws::Client::AWSError;
 using Aws::Client::ClientConfiguration;
 using Aws::SQS::SQSClient;
 using Aws::SQS::SQSErrors;
+using Aws::SQS::Model::BatchResultErrorEntry;
+using Aws::SQS::Model::ChangeMessageVisibilityBatchOutcome;
+using Aws::SQS::Model::ChangeMessageVisibilityBatchResult;
 using Aws::SQS::Model::ChangeMessageVisibilityOutcome;
 using Aws::SQS::Model::ChangeMessageVisibilityRequest;
+using Aws::SQS::Model::DeleteMessageBatchOutcome;
+using Aws::SQS::Model::DeleteMessageBatchRequest;
+using Aws::SQS::Model::DeleteMessageBatchResult;
 using Aws::SQS::Model::DeleteMessageOutcome;
 using Aws::SQS::Model::GetQueueUrlOutcome;
 using Aws::SQS::Model::GetQueueUrlResult;
@@ -56,6 +65,10 @@ using Aws::SQS::Model::ReceiveMessageResult;
 using Aws::SQS::Model::SendMessageOutcome;
 using Aws::SQS::Model::SendMessageRequest;
 using Aws::SQS::Model::SendMessageResult;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutRequest;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutResponse;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageRequest;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageRequest;
@@ -73,6 +86,8 @@ using google::scp::core::FailureExecutionResult;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::errors::SC_AWS_INVALID_CREDENTIALS;
 using google::scp::core::errors::SC_AWS_INVALID_REQUEST;
+using google::scp::core::errors::
+    SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED;
 using google::scp::core::errors::
     SC_AWS_QUEUE_CLIENT_PROVIDER_INVALID_RECEIPT_INFO;
 using google::scp::core::errors::
@@ -98,7 +113,10 @@ using std::make_shared;
 using std::make_unique;
 using std::move;
 using std::shared_ptr;
+using std::string;
+using std::to_string;
 using std::unique_ptr;
+using std::vector;
 using testing::_;
 using testing::Eq;
 using testing::NiceMock;
@@ -390,6 +408,54 @@ TEST_F(AwsQueueClientProviderTest, GetTopMessageSuccess) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(AwsQueueClientProviderTest, GetTopMessagesWithLongPoll) {
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  get_top_message_context_.request->set_max_number_of_messages(5);
+  get_top_message_context_.request->set_wait_time_seconds(40);
+  get_top_message_context_.callback =
+      [this](AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+                 get_top_message_context) {
+        EXPECT_SUCCESS(get_top_message_context.result);
+
+        const auto& response = *get_top_message_context.response;
+        EXPECT_EQ(response.message_id(), kMessageId);
+        ASSERT_EQ(response.messages().size(), 2);
+        EXPECT_EQ(response.messages(0).message_id(), kMessageId);
+        EXPECT_EQ(response.messages(0).receipt_info(), kReceiptInfo);
+        EXPECT_EQ(response.messages(1).message_id(), "other id");
+        EXPECT_EQ(response.messages(1).message_body(), "other body");
+        EXPECT_EQ(response.messages(1).receipt_info(), "other receipt");
+        finish_called_ = true;
+      };
+
+  // The wait time is capped at the maximum of SQS.
+  EXPECT_CALL(*mock_sqs_client_,
+              ReceiveMessageAsync(
+                  HasReceiveMessageRequestParams(kQueueUrl, 5, 20), _, _))
+      .WillOnce([](auto, auto callback, auto) {
+        ReceiveMessageRequest receive_message_request;
+        Vector<Message> messages(2);
+        messages[0].SetMessageId(kMessageId);
+        messages[0].SetBody(kMessageBody);
+        messages[0].SetReceiptHandle(kReceiptInfo);
+        messages[1].SetMessageId("other id");
+        messages[1].SetBody("other body");
+        messages[1].SetReceiptHandle("other receipt");
+        ReceiveMessageResult receive_message_result;
+        receive_message_result.SetMessages(messages);
+        ReceiveMessageOutcome receive_message_outcome(
+            move(receive_message_result));
+        callback(nullptr, receive_message_request,
+                 move(receive_message_outcome), nullptr);
+      });
+
+  EXPECT_SUCCESS(
+      queue_client_provider_->GetTopMessage(get_top_message_context_));
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 TEST_F(AwsQueueClientProviderTest, GetTopMessageCallbackFailed) {
   EXPECT_SUCCESS(queue_client_provider_->Init());
   EXPECT_SUCCESS(queue_client_provider_->Run());
@@ -677,4 +743,174 @@ TEST_F(AwsQueueClientProviderTest, DeleteMessageCallbackFailed) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(AwsQueueClientProviderTest, GetTopMessageFromPrefetchedMessages) {
+  queue_client_options_->prefetch_count = 4;
+  queue_client_options_->prefetched_message_visibility_timeout_seconds = 60;
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  // The first receive fills the buffer and serves the caller, the second one
+  // refills the buffer once it is half empty.
+  EXPECT_CALL(*mock_sqs_client_,
+              ReceiveMessageAsync(
+                  HasReceiveMessageRequestParams(kQueueUrl, 5, 0), _, _))
+      .WillOnce([](auto request, auto callback, auto) {
+        EXPECT_EQ(request.GetVisibilityTimeout(), 60);
+        Vector<Message> messages(5);
+        for (size_t i = 0; i < messages.size(); ++i) {
+          messages[i].SetMessageId(("id " + to_string(i)).c_str());
+          messages[i].SetBody(kMessageBody);
+          messages[i].SetReceiptHandle(("receipt " + to_string(i)).c_str());
+        }
+        ReceiveMessageResult receive_message_result;
+        receive_message_result.SetMessages(messages);
+        callback(nullptr, request,
+                 ReceiveMessageOutcome(move(receive_message_result)), nullptr);
+      });
+  EXPECT_CALL(*mock_sqs_client_,
+              ReceiveMessageAsync(
+                  HasReceiveMessageRequestParams(kQueueUrl, 2, 0), _, _))
+      .WillOnce([](auto request, auto callback, auto) {
+        callback(nullptr, request,
+                 ReceiveMessageOutcome(ReceiveMessageResult()), nullptr);
+      });
+
+  for (int i = 0; i < 3; ++i) {
+    finish_called_ = false;
+    get_top_message_context_.callback =
+        [this, i](AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+                      get_top_message_context) {
+          EXPECT_SUCCESS(get_top_message_context.result);
+          EXPECT_EQ(get_top_message_context.response->message_id(),
+                    "id " + to_string(i));
+          EXPECT_EQ(get_top_message_context.response->receipt_info(),
+                    "receipt " + to_string(i));
+          finish_called_ = true;
+        };
+    EXPECT_SUCCESS(
+        queue_client_provider_->GetTopMessage(get_top_message_context_));
+    WaitUntil([this]() { return finish_called_.load(); });
+  }
+}
+
+TEST_F(AwsQueueClientProviderTest, DeleteMessagesInBatchesWhileInFlight) {
+  queue_client_options_->max_delete_message_batches_in_flight = 1;
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  // The first deletion is sent alone, the next two wait for it and are sent
+  // in one batch.
+  Aws::SQS::DeleteMessageBatchResponseReceivedHandler first_callback;
+  DeleteMessageBatchRequest first_request;
+  EXPECT_CALL(*mock_sqs_client_, DeleteMessageBatchAsync)
+      .WillOnce([&](auto request, auto callback, auto) {
+        EXPECT_EQ(request.GetEntries().size(), 1);
+        first_request = request;
+        first_callback = callback;
+      })
+      .WillOnce([](auto request, auto callback, auto) {
+        EXPECT_EQ(request.GetQueueUrl(), kQueueUrl);
+        ASSERT_EQ(request.GetEntries().size(), 2);
+        EXPECT_EQ(request.GetEntries()[0].GetReceiptHandle(), "receipt 1");
+        EXPECT_EQ(request.GetEntries()[1].GetReceiptHandle(), "receipt 2");
+        BatchResultErrorEntry failed_entry;
+        failed_entry.SetId(request.GetEntries()[1].GetId());
+        failed_entry.SetCode("ReceiptHandleIsInvalid");
+        DeleteMessageBatchResult result;
+        result.AddFailed(failed_entry);
+        callback(nullptr, request, DeleteMessageBatchOutcome(move(result)),
+                 nullptr);
+      });
+
+  vector<ExecutionResult> results(3);
+  std::atomic<int> finished_count{0};
+  for (int i = 0; i < 3; ++i) {
+    AsyncContext<DeleteMessageRequest, DeleteMessageResponse> context(
+        make_shared<DeleteMessageRequest>(),
+        [&results, &finished_count, i](auto& context) {
+          results[i] = context.result;
+          finished_count++;
+        });
+    context.request->set_receipt_info("receipt " + to_string(i));
+    EXPECT_SUCCESS(queue_client_provider_->DeleteMessage(context));
+  }
+  EXPECT_EQ(finished_count, 0);
+
+  first_callback(nullptr, first_request,
+                 DeleteMessageBatchOutcome(DeleteMessageBatchResult()),
+                 nullptr);
+  WaitUntil([&finished_count]() { return finished_count.load() == 3; });
+  EXPECT_SUCCESS(results[0]);
+  EXPECT_SUCCESS(results[1]);
+  EXPECT_THAT(results[2],
+              ResultIs(FailureExecutionResult(
+                  SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED)));
+}
+
+TEST_F(AwsQueueClientProviderTest,
+       BatchUpdateMessageVisibilityTimeoutInSqsBatches) {
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  // The second request is invalid, the 11 others take two SQS calls.
+  auto request = make_shared<BatchUpdateMessageVisibilityTimeoutRequest>();
+  for (int i = 0; i < 12; ++i) {
+    auto* update_request = request->add_requests();
+    if (i != 1) {
+      update_request->set_receipt_info("receipt " + to_string(i));
+    }
+    update_request->mutable_message_visibility_timeout()->set_seconds(
+        kVisibilityTimeoutSeconds);
+  }
+
+  std::atomic<int> sqs_calls = 0;
+  EXPECT_CALL(*mock_sqs_client_, ChangeMessageVisibilityBatchAsync)
+      .Times(2)
+      .WillRepeatedly([&](auto request, auto callback, auto) {
+        EXPECT_EQ(request.GetQueueUrl(), kQueueUrl);
+        EXPECT_EQ(request.GetEntries().size(), sqs_calls++ == 0 ? 10 : 1);
+        ChangeMessageVisibilityBatchResult result;
+        for (const auto& entry : request.GetEntries()) {
+          EXPECT_EQ(entry.GetVisibilityTimeout(), kVisibilityTimeoutSeconds);
+          EXPECT_EQ(entry.GetReceiptHandle(),
+                    "receipt " + string(entry.GetId().c_str()));
+          if (entry.GetId() == "5") {
+            BatchResultErrorEntry failed_entry;
+            failed_entry.SetId(entry.GetId());
+            failed_entry.SetCode("ReceiptHandleIsInvalid");
+            result.AddFailed(failed_entry);
+          }
+        }
+        callback(nullptr, request,
+                 ChangeMessageVisibilityBatchOutcome(move(result)), nullptr);
+      });
+
+  AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+               BatchUpdateMessageVisibilityTimeoutResponse>
+      context(move(request), [this](auto& context) {
+        EXPECT_SUCCESS(context.result);
+        const auto& responses = context.response->responses();
+        EXPECT_EQ(responses.size(), 12);
+        for (int i = 0; i < responses.size(); ++i) {
+          ExecutionResult result(responses[i].result());
+          if (i == 1) {
+            EXPECT_THAT(
+                result,
+                ResultIs(FailureExecutionResult(
+                    SC_AWS_QUEUE_CLIENT_PROVIDER_INVALID_RECEIPT_INFO)));
+          } else if (i == 5) {
+            EXPECT_THAT(result,
+                        ResultIs(FailureExecutionResult(
+                            SC_AWS_QUEUE_CLIENT_PROVIDER_BATCH_ENTRY_FAILED)));
+          } else {
+            EXPECT_SUCCESS(result);
+          }
+        }
+        finish_called_ = true;
+      });
+  EXPECT_SUCCESS(
+      queue_client_provider_->BatchUpdateMessageVisibilityTimeout(context));
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 }  // namespace google::scp::cpio::client_providers::test
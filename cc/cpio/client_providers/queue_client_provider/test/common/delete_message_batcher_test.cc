@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cpio/client_providers/queue_client_provider/src/common/delete_message_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "public/core/interface/execution_result.h"
+#include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
+
+using google::cmrt::sdk::queue_service::v1::DeleteMessageRequest;
+using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
+using google::scp::core::AsyncContext;
+using std::make_shared;
+using std::string;
+using std::to_string;
+using std::vector;
+
+namespace google::scp::cpio::client_providers::test {
+namespace {
+using DeleteMessageContext =
+    AsyncContext<DeleteMessageRequest, DeleteMessageResponse>;
+
+/// Returns the receipt infos of the batch.
+vector<string> GetReceiptInfos(const vector<DeleteMessageContext>& batch) {
+  vector<string> receipt_infos;
+  for (const auto& context : batch) {
+    receipt_infos.push_back(context.request->receipt_info());
+  }
+  return receipt_infos;
+}
+
+DeleteMessageContext CreateContext(int message_number) {
+  DeleteMessageContext context(make_shared<DeleteMessageRequest>(),
+                               [](DeleteMessageContext&) {});
+  context.request->set_receipt_info("receipt " + to_string(message_number));
+  return context;
+}
+
+TEST(DeleteMessageBatcherTest, BatchesTheDeletionsQueuedWhileInFlight) {
+  vector<vector<string>> batches;
+  DeleteMessageBatcher batcher(
+      /*max_batch_size=*/2, /*max_batches_in_flight=*/1,
+      [&batches](vector<DeleteMessageContext>& batch) {
+        batches.push_back(GetReceiptInfos(batch));
+      });
+
+  for (int i = 0; i < 4; ++i) {
+    auto context = CreateContext(i);
+    batcher.DeleteMessage(context);
+  }
+  EXPECT_EQ(batches, (vector<vector<string>>{{"receipt 0"}}));
+
+  batcher.OnBatchDeleted();
+  batcher.OnBatchDeleted();
+  batcher.OnBatchDeleted();
+  EXPECT_EQ(batches,
+            (vector<vector<string>>{{"receipt 0"},
+                                    {"receipt 1", "receipt 2"},
+                                    {"receipt 3"}}));
+
+  // Sent right away again once nothing is in flight.
+  auto context = CreateContext(4);
+  batcher.DeleteMessage(context);
+  EXPECT_EQ(batches.back(), (vector<string>{"receipt 4"}));
+}
+
+TEST(DeleteMessageBatcherTest, SendsUpToMaxBatchesInFlight) {
+  vector<vector<string>> batches;
+  DeleteMessageBatcher batcher(
+      /*max_batch_size=*/10, /*max_batches_in_flight=*/2,
+      [&batches](vector<DeleteMessageContext>& batch) {
+        batches.push_back(GetReceiptInfos(batch));
+      });
+
+  for (int i = 0; i < 5; ++i) {
+    auto context = CreateContext(i);
+    batcher.DeleteMessage(context);
+  }
+  EXPECT_EQ(batches,
+            (vector<vector<string>>{{"receipt 0"}, {"receipt 1"}}));
+
+  batcher.OnBatchDeleted();
+  EXPECT_EQ(batches.back(),
+            (vector<string>{"receipt 2", "receipt 3", "receipt 4"}));
+}
+}  // namespace
+}  // namespace google::scp::cpio::client_providers::test
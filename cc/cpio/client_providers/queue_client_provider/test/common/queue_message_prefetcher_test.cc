@@ -0,0 +1,222 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cpio/client_providers/queue_client_provider/src/common/queue_message_prefetcher.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "public/core/interface/execution_result.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+#include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
+
+using google::cmrt::sdk::queue_service::v1::GetTopMessageRequest;
+using google::cmrt::sdk::queue_service::v1::GetTopMessageResponse;
+using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::test::ResultIs;
+using std::make_shared;
+using std::string;
+using std::to_string;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace google::scp::cpio::client_providers::test {
+namespace {
+using GetTopMessageContext =
+    AsyncContext<GetTopMessageRequest, GetTopMessageResponse>;
+
+/// Records the receives, which are finished by the test.
+struct FakeQueue {
+  ExecutionResult Receive(GetTopMessageContext& context) {
+    receive_contexts.push_back(context);
+    return SuccessExecutionResult();
+  }
+
+  void FinishReceive(size_t number_of_messages) {
+    auto context = receive_contexts.back();
+    context.response = make_shared<GetTopMessageResponse>();
+    for (size_t i = 0; i < number_of_messages; ++i) {
+      auto* message = context.response->add_messages();
+      message->set_message_id("id " + to_string(next_message_number));
+      message->set_receipt_info("receipt " + to_string(next_message_number));
+      next_message_number++;
+    }
+    context.result = SuccessExecutionResult();
+    context.Finish();
+  }
+
+  void Extend(const vector<string>& receipt_infos, seconds) {
+    extended_receipt_infos.insert(extended_receipt_infos.end(),
+                                  receipt_infos.begin(), receipt_infos.end());
+  }
+
+  vector<GetTopMessageContext> receive_contexts;
+  vector<string> extended_receipt_infos;
+  int next_message_number = 0;
+};
+
+class QueueMessagePrefetcherTest : public ::testing::Test {
+ protected:
+  QueueMessagePrefetcher CreatePrefetcher(size_t prefetch_count,
+                                          seconds visibility_timeout) {
+    return QueueMessagePrefetcher(
+        prefetch_count, /*max_messages_per_receive=*/10, visibility_timeout,
+        [this](GetTopMessageContext& context) {
+          return fake_queue_.Receive(context);
+        },
+        [this](const vector<string>& receipt_infos, seconds timeout) {
+          fake_queue_.Extend(receipt_infos, timeout);
+        });
+  }
+
+  /// Gets the top message, and records the finished context.
+  void GetTopMessage(QueueMessagePrefetcher& prefetcher,
+                     int32_t max_number_of_messages = 1,
+                     int32_t wait_time_seconds = 0) {
+    auto request = make_shared<GetTopMessageRequest>();
+    request->set_max_number_of_messages(max_number_of_messages);
+    request->set_wait_time_seconds(wait_time_seconds);
+    GetTopMessageContext context(
+        request,
+        [this](GetTopMessageContext& context) {
+          finished_contexts_.push_back(context);
+        });
+    EXPECT_SUCCESS(prefetcher.GetTopMessage(context));
+  }
+
+  FakeQueue fake_queue_;
+  vector<GetTopMessageContext> finished_contexts_;
+};
+
+TEST_F(QueueMessagePrefetcherTest, ServesBufferedMessagesAndRefills) {
+  auto prefetcher = CreatePrefetcher(/*prefetch_count=*/4, seconds(60));
+
+  // The caller waits for the first receive, which fills the buffer too.
+  GetTopMessage(prefetcher, 1, /*wait_time_seconds=*/20);
+  ASSERT_EQ(fake_queue_.receive_contexts.size(), 1);
+  EXPECT_EQ(fake_queue_.receive_contexts[0].request->max_number_of_messages(),
+            5);
+  EXPECT_EQ(fake_queue_.receive_contexts[0].request->wait_time_seconds(), 20);
+  EXPECT_TRUE(finished_contexts_.empty());
+  fake_queue_.FinishReceive(5);
+  ASSERT_EQ(finished_contexts_.size(), 1);
+  EXPECT_EQ(finished_contexts_[0].response->message_id(), "id 0");
+  EXPECT_EQ(finished_contexts_[0].response->receipt_info(), "receipt 0");
+
+  // Served from the buffer, which is refilled once half empty without a long
+  // poll.
+  GetTopMessage(prefetcher, 2, 20);
+  ASSERT_EQ(finished_contexts_.size(), 2);
+  ASSERT_EQ(finished_contexts_[1].response->messages().size(), 2);
+  EXPECT_EQ(finished_contexts_[1].response->messages(0).message_id(), "id 1");
+  EXPECT_EQ(finished_contexts_[1].response->messages(1).message_id(), "id 2");
+  ASSERT_EQ(fake_queue_.receive_contexts.size(), 2);
+  EXPECT_EQ(fake_queue_.receive_contexts[1].request->max_number_of_messages(),
+            2);
+  EXPECT_EQ(fake_queue_.receive_contexts[1].request->wait_time_seconds(), 0);
+
+  // No other receive while one is in flight.
+  GetTopMessage(prefetcher);
+  EXPECT_EQ(fake_queue_.receive_contexts.size(), 2);
+  EXPECT_EQ(finished_contexts_[2].response->message_id(), "id 3");
+  fake_queue_.FinishReceive(2);
+  GetTopMessage(prefetcher);
+  EXPECT_EQ(finished_contexts_[3].response->message_id(), "id 4");
+  EXPECT_TRUE(fake_queue_.extended_receipt_infos.empty());
+}
+
+TEST_F(QueueMessagePrefetcherTest, WaitingContextsGetTheReceiveFailure) {
+  auto prefetcher = CreatePrefetcher(/*prefetch_count=*/4, seconds(60));
+
+  GetTopMessage(prefetcher);
+  GetTopMessage(prefetcher);
+  ASSERT_EQ(fake_queue_.receive_contexts.size(), 1);
+  auto receive_context = fake_queue_.receive_contexts[0];
+  receive_context.result = FailureExecutionResult(1234);
+  receive_context.Finish();
+
+  ASSERT_EQ(finished_contexts_.size(), 2);
+  EXPECT_THAT(finished_contexts_[0].result,
+              ResultIs(FailureExecutionResult(1234)));
+  EXPECT_THAT(finished_contexts_[1].result,
+              ResultIs(FailureExecutionResult(1234)));
+
+  // The next call receives again.
+  GetTopMessage(prefetcher);
+  EXPECT_EQ(fake_queue_.receive_contexts.size(), 2);
+}
+
+TEST_F(QueueMessagePrefetcherTest, WaitingContextsWithoutMessagesGetNone) {
+  auto prefetcher = CreatePrefetcher(/*prefetch_count=*/4, seconds(60));
+
+  GetTopMessage(prefetcher);
+  GetTopMessage(prefetcher);
+  fake_queue_.FinishReceive(1);
+
+  ASSERT_EQ(finished_contexts_.size(), 2);
+  EXPECT_SUCCESS(finished_contexts_[0].result);
+  EXPECT_EQ(finished_contexts_[0].response->message_id(), "id 0");
+  EXPECT_SUCCESS(finished_contexts_[1].result);
+  EXPECT_TRUE(finished_contexts_[1].response->messages().empty());
+}
+
+TEST_F(QueueMessagePrefetcherTest, ExtendsLeasesAndDropsExpiredMessages) {
+  auto prefetcher = CreatePrefetcher(/*prefetch_count=*/4, seconds(1));
+  GetTopMessage(prefetcher);
+  fake_queue_.FinishReceive(5);
+
+  // Less than half of the lease left, the buffered messages are extended.
+  std::this_thread::sleep_for(milliseconds(600));
+  GetTopMessage(prefetcher);
+  EXPECT_EQ(finished_contexts_[1].response->message_id(), "id 1");
+  EXPECT_EQ(fake_queue_.extended_receipt_infos,
+            (vector<string>{"receipt 1", "receipt 2", "receipt 3",
+                            "receipt 4"}));
+
+  // Expired, the rest of the buffer is dropped and received again.
+  std::this_thread::sleep_for(milliseconds(1100));
+  GetTopMessage(prefetcher);
+  ASSERT_EQ(finished_contexts_.size(), 2);
+  ASSERT_EQ(fake_queue_.receive_contexts.size(), 2);
+  fake_queue_.FinishReceive(1);
+  ASSERT_EQ(finished_contexts_.size(), 3);
+  EXPECT_EQ(finished_contexts_[2].response->message_id(), "id 5");
+}
+
+TEST_F(QueueMessagePrefetcherTest, ClearDropsTheBufferedMessages) {
+  auto prefetcher = CreatePrefetcher(/*prefetch_count=*/2, seconds(60));
+  GetTopMessage(prefetcher);
+  fake_queue_.FinishReceive(3);
+  prefetcher.Clear();
+
+  GetTopMessage(prefetcher);
+  EXPECT_EQ(finished_contexts_.size(), 1);
+  fake_queue_.FinishReceive(1);
+  ASSERT_EQ(finished_contexts_.size(), 2);
+  EXPECT_EQ(finished_contexts_[1].response->message_id(), "id 3");
+}
+}  // namespace
+}  // namespace google::scp::cpio::client_providers::test
@@ -16,8 +16,10 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <google/pubsub/v1/pubsub.grpc.pb.h>
 
@@ -33,6 +35,10 @@
 #include "public/core/test/interface/execution_result_matchers.h"
 #include "public/cpio/proto/queue_service/v1/queue_service.pb.h"
 
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutRequest;
+using google::cmrt::sdk::queue_service::v1::
+    BatchUpdateMessageVisibilityTimeoutResponse;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageRequest;
 using google::cmrt::sdk::queue_service::v1::DeleteMessageResponse;
 using google::cmrt::sdk::queue_service::v1::EnqueueMessageRequest;
@@ -46,6 +52,7 @@ using google::cmrt::sdk::queue_service::v1::
 using google::pubsub::v1::Publisher;
 using google::pubsub::v1::Subscriber;
 using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::errors::SC_GCP_ABORTED;
@@ -77,10 +84,13 @@ using grpc::Status;
 using grpc::StatusCode;
 using std::make_shared;
 using std::make_unique;
+using std::move;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::vector;
 using testing::_;
+using testing::ElementsAre;
 using testing::Eq;
 using testing::NiceMock;
 using testing::Return;
@@ -657,4 +667,138 @@ TEST_F(GcpQueueClientProviderTest, DeleteMessageFailureWithPubSubError) {
   WaitUntil([this]() { return finish_called_.load(); });
 }
 
+TEST_F(GcpQueueClientProviderTest,
+       GetTopMessageFromPrefetchedMessagesWithAckDeadline) {
+  queue_client_options_->prefetch_count = 2;
+  queue_client_options_->prefetched_message_visibility_timeout_seconds = 30;
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  // The buffer and the caller are filled with one pull, the other pulls
+  // refill the buffer once it is half empty.
+  EXPECT_CALL(*mock_subscriber_stub_,
+              Pull(_, HasPullParams(kExpectedSubscriptionName, 3), _))
+      .WillOnce([](auto, auto, auto* pull_response) {
+        for (const auto& ack_id : {"ack 0", "ack 1"}) {
+          auto* received_message = pull_response->add_received_messages();
+          received_message->mutable_message()->set_data(kMessageBody);
+          received_message->mutable_message()->set_message_id(ack_id);
+          received_message->set_ack_id(ack_id);
+        }
+        return Status(StatusCode::OK, "");
+      });
+  EXPECT_CALL(*mock_subscriber_stub_,
+              Pull(_, HasPullParams(kExpectedSubscriptionName, 1), _))
+      .WillOnce(Return(Status(StatusCode::OK, "")));
+  EXPECT_CALL(*mock_subscriber_stub_,
+              Pull(_, HasPullParams(kExpectedSubscriptionName, 2), _))
+      .WillOnce(Return(Status(StatusCode::OK, "")));
+  EXPECT_CALL(*mock_subscriber_stub_, ModifyAckDeadline)
+      .WillOnce([](auto, auto& modify_ack_deadline_request, auto) {
+        EXPECT_EQ(modify_ack_deadline_request.ack_deadline_seconds(), 30);
+        EXPECT_THAT(modify_ack_deadline_request.ack_ids(),
+                    ElementsAre("ack 0", "ack 1"));
+        return Status(StatusCode::OK, "");
+      });
+
+  for (const auto& ack_id : {"ack 0", "ack 1"}) {
+    finish_called_ = false;
+    get_top_message_context_.callback =
+        [this, ack_id](
+            AsyncContext<GetTopMessageRequest, GetTopMessageResponse>&
+                get_top_message_context) {
+          EXPECT_SUCCESS(get_top_message_context.result);
+          EXPECT_EQ(get_top_message_context.response->receipt_info(), ack_id);
+          finish_called_ = true;
+        };
+    EXPECT_SUCCESS(
+        queue_client_provider_->GetTopMessage(get_top_message_context_));
+    WaitUntil([this]() { return finish_called_.load(); });
+  }
+}
+
+TEST_F(GcpQueueClientProviderTest, DeleteMessagesInOneAcknowledge) {
+  queue_client_options_->max_delete_message_batches_in_flight = 1;
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  // The deletions queued while the first one is in flight are acknowledged
+  // together.
+  vector<AsyncContext<DeleteMessageRequest, DeleteMessageResponse>> contexts;
+  std::atomic<int> finished_count{0};
+  for (const auto& ack_id : {"ack 0", "ack 1", "ack 2"}) {
+    contexts.emplace_back(make_shared<DeleteMessageRequest>(),
+                          [&finished_count](auto& context) {
+                            EXPECT_SUCCESS(context.result);
+                            finished_count++;
+                          });
+    contexts.back().request->set_receipt_info(ack_id);
+  }
+  EXPECT_CALL(*mock_subscriber_stub_, Acknowledge)
+      .WillOnce([this, &contexts](auto, auto& acknowledge_request, auto) {
+        EXPECT_THAT(acknowledge_request.ack_ids(), ElementsAre("ack 0"));
+        EXPECT_SUCCESS(queue_client_provider_->DeleteMessage(contexts[1]));
+        EXPECT_SUCCESS(queue_client_provider_->DeleteMessage(contexts[2]));
+        return Status(StatusCode::OK, "");
+      })
+      .WillOnce([](auto, auto& acknowledge_request, auto) {
+        EXPECT_THAT(acknowledge_request.ack_ids(),
+                    ElementsAre("ack 1", "ack 2"));
+        return Status(StatusCode::OK, "");
+      });
+
+  EXPECT_SUCCESS(queue_client_provider_->DeleteMessage(contexts[0]));
+  WaitUntil([&finished_count]() { return finished_count.load() == 3; });
+}
+
+TEST_F(GcpQueueClientProviderTest,
+       BatchUpdateMessageVisibilityTimeoutPerAckDeadline) {
+  EXPECT_SUCCESS(queue_client_provider_->Init());
+  EXPECT_SUCCESS(queue_client_provider_->Run());
+
+  auto request = make_shared<BatchUpdateMessageVisibilityTimeoutRequest>();
+  for (const auto& [ack_id, seconds] :
+       vector<std::pair<string, int>>{
+           {"ack 0", 30}, {"ack 1", 60}, {"", 30}, {"ack 3", 30}}) {
+    auto* update_request = request->add_requests();
+    update_request->set_receipt_info(ack_id);
+    update_request->mutable_message_visibility_timeout()->set_seconds(seconds);
+  }
+  // The ack ids with the same deadline are modified together.
+  EXPECT_CALL(*mock_subscriber_stub_, ModifyAckDeadline)
+      .WillOnce([](auto, auto& modify_ack_deadline_request, auto) {
+        EXPECT_EQ(modify_ack_deadline_request.subscription(),
+                  kExpectedSubscriptionName);
+        EXPECT_EQ(modify_ack_deadline_request.ack_deadline_seconds(), 30);
+        EXPECT_THAT(modify_ack_deadline_request.ack_ids(),
+                    ElementsAre("ack 0", "ack 3"));
+        return Status(StatusCode::OK, "");
+      })
+      .WillOnce([](auto, auto& modify_ack_deadline_request, auto) {
+        EXPECT_EQ(modify_ack_deadline_request.ack_deadline_seconds(), 60);
+        EXPECT_THAT(modify_ack_deadline_request.ack_ids(),
+                    ElementsAre("ack 1"));
+        return Status(StatusCode::DATA_LOSS, "");
+      });
+
+  AsyncContext<BatchUpdateMessageVisibilityTimeoutRequest,
+               BatchUpdateMessageVisibilityTimeoutResponse>
+      context(move(request), [this](auto& context) {
+        EXPECT_SUCCESS(context.result);
+        const auto& responses = context.response->responses();
+        ASSERT_EQ(responses.size(), 4);
+        EXPECT_SUCCESS(ExecutionResult(responses[0].result()));
+        EXPECT_THAT(ExecutionResult(responses[1].result()),
+                    ResultIs(FailureExecutionResult(SC_GCP_DATA_LOSS)));
+        EXPECT_THAT(ExecutionResult(responses[2].result()),
+                    ResultIs(FailureExecutionResult(
+                        SC_GCP_QUEUE_CLIENT_PROVIDER_INVALID_MESSAGE)));
+        EXPECT_SUCCESS(ExecutionResult(responses[3].result()));
+        finish_called_ = true;
+      });
+  EXPECT_SUCCESS(
+      queue_client_provider_->BatchUpdateMessageVisibilityTimeout(context));
+  WaitUntil([this]() { return finish_called_.load(); });
+}
+
 }  // namespace google::scp::cpio::client_providers::gcp_queue_client::test
@@ -16,11 +16,13 @@
 
 #include "aws_role_credentials_provider.h"
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include <aws/core/utils/DateTime.h>
 #include <aws/sts/model/AssumeRoleRequest.h>
 
 #include "cc/core/common/uuid/src/uuid.h"
@@ -38,6 +40,7 @@ using Aws::Client::ClientConfiguration;
 using Aws::STS::STSClient;
 using Aws::STS::Model::AssumeRoleOutcome;
 using Aws::STS::Model::AssumeRoleRequest;
+using Aws::Utils::DateTime;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::AsyncPriority;
@@ -54,6 +57,9 @@ using std::make_shared;
 using std::shared_ptr;
 using std::string;
 using std::to_string;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
 using std::placeholders::_1;
 using std::placeholders::_2;
 using std::placeholders::_3;
@@ -110,12 +116,21 @@ ExecutionResult AwsRoleCredentialsProvider::Run() noexcept {
 }
 
 ExecutionResult AwsRoleCredentialsProvider::Stop() noexcept {
+  credentials_cache_.Stop();
   return SuccessExecutionResult();
 }
 
 ExecutionResult AwsRoleCredentialsProvider::GetRoleCredentials(
     AsyncContext<GetRoleCredentialsRequest, GetRoleCredentialsResponse>&
         get_credentials_context) noexcept {
+  return credentials_cache_.Get(
+      *get_credentials_context.request->account_identity,
+      get_credentials_context);
+}
+
+ExecutionResult AwsRoleCredentialsProvider::AssumeRole(
+    AsyncContext<GetRoleCredentialsRequest, GetRoleCredentialsResponse>&
+        get_credentials_context) noexcept {
   AssumeRoleRequest sts_request;
   sts_request.SetRoleArn(*(get_credentials_context.request->account_identity));
   sts_request.SetRoleSessionName(*session_name_);
@@ -174,6 +189,13 @@ void AwsRoleCredentialsProvider::OnGetRoleCredentialsCallback(
                               .GetCredentials()
                               .GetSessionToken()
                               .c_str());
+  const auto& expiration =
+      get_credentials_outcome.GetResult().GetCredentials().GetExpiration();
+  auto lifetime_in_ms = expiration.Millis() - DateTime::Now().Millis();
+  if (lifetime_in_ms > 0) {
+    get_credentials_context.response->credentials_lifetime_in_seconds =
+        duration_cast<seconds>(milliseconds(lifetime_in_ms));
+  }
 
   get_credentials_context.Finish();
 }
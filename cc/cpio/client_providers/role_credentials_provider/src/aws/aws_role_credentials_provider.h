@@ -24,6 +24,7 @@
 #include "core/interface/async_executor_interface.h"
 #include "cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "cpio/client_providers/interface/role_credentials_provider_interface.h"
+#include "cpio/common/src/refresh_ahead_cache.h"
 
 #include "error_codes.h"
 
@@ -38,7 +39,16 @@ class AwsRoleCredentialsProvider : public RoleCredentialsProviderInterface {
       const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor)
       : instance_client_provider_(instance_client_provider),
         cpu_async_executor_(cpu_async_executor),
-        io_async_executor_(io_async_executor) {}
+        io_async_executor_(io_async_executor),
+        credentials_cache_(
+            [this](core::AsyncContext<GetRoleCredentialsRequest,
+                                      GetRoleCredentialsResponse>& context) {
+              return AssumeRole(context);
+            },
+            [](const GetRoleCredentialsResponse& response) {
+              return response.credentials_lifetime_in_seconds;
+            },
+            cpu_async_executor) {}
 
   core::ExecutionResult Init() noexcept override;
 
@@ -51,6 +61,18 @@ class AwsRoleCredentialsProvider : public RoleCredentialsProviderInterface {
           get_credentials_context) noexcept override;
 
  protected:
+  /**
+   * @brief Assumes the role through STS. GetRoleCredentials serves the cached
+   * credentials and only calls this on a miss or to refresh them.
+   *
+   * @param get_credentials_context The context of the get role credentials
+   * operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult AssumeRole(
+      core::AsyncContext<GetRoleCredentialsRequest, GetRoleCredentialsResponse>&
+          get_credentials_context) noexcept;
+
   /**
    * @brief Is called when the get role credentials operation is completed.
    *
@@ -93,5 +115,11 @@ class AwsRoleCredentialsProvider : public RoleCredentialsProviderInterface {
 
   /// The session id.
   std::shared_ptr<std::string> session_name_;
+
+  /// The assumed role credentials per role ARN, refreshed ahead of their
+  /// expiry.
+  common::RefreshAheadCache<GetRoleCredentialsRequest,
+                            GetRoleCredentialsResponse>
+      credentials_cache_;
 };
 }  // namespace google::scp::cpio::client_providers
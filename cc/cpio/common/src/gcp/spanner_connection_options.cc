@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "spanner_connection_options.h"
+
+#include <grpcpp/support/channel_arguments.h>
+
+#include <utility>
+
+#include "google/cloud/grpc_options.h"
+#include "google/cloud/spanner/options.h"
+
+#include "gcp_utils.h"
+
+using google::cloud::GrpcChannelArgumentsNativeOption;
+using google::cloud::GrpcNumChannelsOption;
+using google::cloud::Options;
+using google::cloud::spanner::Client;
+using google::cloud::spanner::RouteToLeaderOption;
+using google::cloud::spanner::SessionPoolKeepAliveIntervalOption;
+using google::cloud::spanner::SessionPoolMaxSessionsPerChannelOption;
+using google::cloud::spanner::SessionPoolMinSessionsOption;
+using google::cloud::spanner::SqlStatement;
+using google::scp::core::ExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+
+namespace {
+constexpr char kWarmUpQuery[] = "SELECT 1";
+}  // namespace
+
+namespace google::scp::cpio::common {
+Options ApplySpannerConnectionOptions(
+    const SpannerConnectionOptions& connection_options,
+    Options options) noexcept {
+  if (connection_options.min_sessions > 0) {
+    options.set<SessionPoolMinSessionsOption>(
+        static_cast<int>(connection_options.min_sessions));
+  }
+  if (connection_options.max_sessions_per_channel > 0) {
+    options.set<SessionPoolMaxSessionsPerChannelOption>(
+        static_cast<int>(connection_options.max_sessions_per_channel));
+  }
+  if (connection_options.num_channels > 0) {
+    options.set<GrpcNumChannelsOption>(
+        static_cast<int>(connection_options.num_channels));
+  }
+  if (connection_options.session_keep_alive_interval.count() > 0) {
+    options.set<SessionPoolKeepAliveIntervalOption>(
+        connection_options.session_keep_alive_interval);
+  }
+  if (connection_options.grpc_keep_alive_time.count() > 0) {
+    // Keeps the arguments already set, e.g. by the caller.
+    auto channel_arguments =
+        std::move(options.lookup<GrpcChannelArgumentsNativeOption>());
+    channel_arguments.SetInt(
+        GRPC_ARG_KEEPALIVE_TIME_MS,
+        static_cast<int>(connection_options.grpc_keep_alive_time.count()));
+    channel_arguments.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+    options.set<GrpcChannelArgumentsNativeOption>(std::move(channel_arguments));
+  }
+  if (connection_options.route_to_leader.has_value()) {
+    options.set<RouteToLeaderOption>(*connection_options.route_to_leader);
+  }
+  return options;
+}
+
+ExecutionResult WarmUpSpannerClient(Client& client) noexcept {
+  for (const auto& row : client.ExecuteQuery(SqlStatement(kWarmUpQuery))) {
+    if (!row.ok()) {
+      return GcpUtils::GcpErrorConverter(row.status());
+    }
+  }
+  return SuccessExecutionResult();
+}
+}  // namespace google::scp::cpio::common
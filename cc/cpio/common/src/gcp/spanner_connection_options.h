@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+#include "google/cloud/options.h"
+#include "google/cloud/spanner/client.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::cpio::common {
+/**
+ * @brief The session pool and channel settings of a Spanner connection. A zero
+ * keeps the default of the client library.
+ */
+struct SpannerConnectionOptions {
+  /// The sessions created along with the connection, and kept in the pool.
+  size_t min_sessions = 0;
+  /// The max number of sessions in use per gRPC channel.
+  size_t max_sessions_per_channel = 0;
+  /// The number of gRPC channels the sessions are spread over.
+  size_t num_channels = 0;
+  /// How often the idle sessions are refreshed, so that Spanner does not
+  /// delete them.
+  std::chrono::seconds session_keep_alive_interval{0};
+  /// How often the gRPC channels send keepalive pings while idle.
+  std::chrono::milliseconds grpc_keep_alive_time{0};
+  /// Whether the read-write transactions are routed to the leader region of a
+  /// multi-region instance, sparing them a hop from the nearest replica.
+  /// Unset keeps the default of the client library.
+  std::optional<bool> route_to_leader;
+};
+
+/**
+ * @brief Sets the Spanner connection options on top of options.
+ *
+ * @param connection_options the settings to set.
+ * @param options the options to set them on.
+ * @return google::cloud::Options the options to make the connection with.
+ */
+google::cloud::Options ApplySpannerConnectionOptions(
+    const SpannerConnectionOptions& connection_options,
+    google::cloud::Options options = {}) noexcept;
+
+/**
+ * @brief Runs a trivial query, so that the sessions and channels of the
+ * connection are ready before it serves traffic.
+ *
+ * @param client the client of the connection.
+ * @return core::ExecutionResult the result of the query.
+ */
+core::ExecutionResult WarmUpSpannerClient(
+    google::cloud::spanner::Client& client) noexcept;
+}  // namespace google::scp::cpio::common
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::cpio::common {
+/**
+ * @brief Caches the responses of an expiring asynchronous fetch (credentials,
+ * session tokens) per key and refreshes them ahead of their expiry.
+ *
+ * Concurrent misses on the same key share a single in-flight fetch. Once a
+ * response is cached, a refresh is started at a jittered fraction of its
+ * lifetime, either scheduled on the async executor or, when there is none,
+ * by the first Get past the refresh point. Until the cached response expires
+ * it keeps being served, including while a refresh is in flight or after a
+ * refresh failed, so callers do not wait on the remote service in steady
+ * state. Responses with a zero lifetime are not cached.
+ */
+template <typename TRequest, typename TResponse>
+class RefreshAheadCache {
+ public:
+  /// Issues the underlying fetch for the given context.
+  using FetchFunction = std::function<core::ExecutionResult(
+      core::AsyncContext<TRequest, TResponse>&)>;
+  /// Returns how long the given response stays valid.
+  using LifetimeFunction =
+      std::function<std::chrono::nanoseconds(const TResponse&)>;
+
+  /// Fraction of the lifetime after which the response is refreshed.
+  static constexpr double kRefreshLifetimeRatio = 0.75;
+  /// Maximum fraction of the lifetime by which the refresh is brought forward
+  /// so that entries fetched together do not refresh together.
+  static constexpr double kRefreshJitterRatio = 0.1;
+  /// Delay before retrying a failed background refresh.
+  static constexpr std::chrono::seconds kRefreshRetryDelay =
+      std::chrono::seconds(1);
+
+  /**
+   * @brief Construct a new Refresh Ahead Cache object
+   *
+   * @param fetch The underlying fetch.
+   * @param lifetime Extracts the lifetime of a fetched response.
+   * @param async_executor Executor to schedule the refreshes on. When null,
+   * refreshes are started lazily by Get.
+   */
+  RefreshAheadCache(
+      FetchFunction fetch, LifetimeFunction lifetime,
+      const std::shared_ptr<core::AsyncExecutorInterface>& async_executor =
+          nullptr)
+      : fetch_(std::move(fetch)),
+        lifetime_(std::move(lifetime)),
+        async_executor_(async_executor),
+        is_running_(true) {}
+
+  ~RefreshAheadCache() { Stop(); }
+
+  /**
+   * @brief Completes the context with the cached response of the key, or
+   * with the result of the in-flight or a newly issued fetch.
+   *
+   * @param key The cache key of the request.
+   * @param context The context to complete.
+   * @return core::ExecutionResult Always successful, the outcome is delivered
+   * through the context callback.
+   */
+  core::ExecutionResult Get(
+      const std::string& key,
+      core::AsyncContext<TRequest, TResponse>& context) noexcept {
+    auto now = core::common::TimeProvider::GetSteadyTimestampInNanoseconds();
+    std::shared_ptr<Entry> entry;
+    std::shared_ptr<TResponse> cached_response;
+    bool start_fetch = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& slot = entries_[key];
+      if (!slot) {
+        slot = std::make_shared<Entry>();
+      }
+      entry = slot;
+      entry->request = context.request;
+
+      if (entry->response && now < entry->expiration_time) {
+        cached_response = entry->response;
+        if (now >= entry->refresh_time && !entry->fetch_in_flight) {
+          entry->fetch_in_flight = true;
+          start_fetch = true;
+        }
+      } else {
+        entry->waiters.push_back(context);
+        if (!entry->fetch_in_flight) {
+          entry->fetch_in_flight = true;
+          start_fetch = true;
+        }
+      }
+    }
+
+    if (start_fetch) {
+      Fetch(entry);
+    }
+
+    if (cached_response) {
+      context.response = std::make_shared<TResponse>(*cached_response);
+      context.result = core::SuccessExecutionResult();
+      context.Finish();
+    }
+    return core::SuccessExecutionResult();
+  }
+
+  /// Cancels the scheduled refreshes. Cached responses stay valid.
+  void Stop() noexcept {
+    std::vector<std::shared_ptr<Entry>> entries;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_running_ = false;
+      for (auto& [key, entry] : entries_) {
+        entries.push_back(entry);
+      }
+    }
+
+    for (auto& entry : entries) {
+      std::function<bool()> canceller;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        canceller = std::move(entry->refresh_canceller);
+        entry->refresh_canceller = nullptr;
+      }
+      if (canceller) {
+        canceller();
+      }
+    }
+  }
+
+ private:
+  /// The cached state of one key.
+  struct Entry {
+    /// The latest request, reused by the background refreshes.
+    std::shared_ptr<TRequest> request;
+    /// The cached response, null until the first successful fetch.
+    std::shared_ptr<TResponse> response;
+    /// Steady timestamps after which the response is refreshed/unusable.
+    std::chrono::nanoseconds refresh_time{0};
+    std::chrono::nanoseconds expiration_time{0};
+    /// Whether a fetch for this key is in flight.
+    bool fetch_in_flight = false;
+    /// Contexts waiting on the in-flight fetch.
+    std::vector<core::AsyncContext<TRequest, TResponse>> waiters;
+    /// Cancels the scheduled refresh, if any.
+    std::function<bool()> refresh_canceller;
+  };
+
+  /// Issues the fetch for the entry. fetch_in_flight must already be set.
+  void Fetch(const std::shared_ptr<Entry>& entry) noexcept {
+    std::shared_ptr<TRequest> request;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      request = entry->request;
+    }
+
+    // Providers may both finish the context and return a failure, so only the
+    // first of the two outcomes completes the fetch.
+    auto completed = std::make_shared<std::atomic<bool>>(false);
+    core::AsyncContext<TRequest, TResponse> fetch_context(
+        request, [this, entry, completed](
+                     core::AsyncContext<TRequest, TResponse>& fetch_context) {
+          if (!completed->exchange(true)) {
+            OnFetched(entry, fetch_context.result, fetch_context.response);
+          }
+        });
+
+    auto execution_result = fetch_(fetch_context);
+    if (!execution_result.Successful() && !completed->exchange(true)) {
+      OnFetched(entry, execution_result, nullptr);
+    }
+  }
+
+  /// Stores the outcome of a fetch and completes the waiting contexts.
+  void OnFetched(const std::shared_ptr<Entry>& entry,
+                 const core::ExecutionResult& result,
+                 const std::shared_ptr<TResponse>& response) noexcept {
+    auto now = core::common::TimeProvider::GetSteadyTimestampInNanoseconds();
+    std::vector<core::AsyncContext<TRequest, TResponse>> waiters;
+    bool schedule_refresh = false;
+    std::chrono::nanoseconds refresh_delay(0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      entry->fetch_in_flight = false;
+      waiters = std::move(entry->waiters);
+      entry->waiters.clear();
+
+      if (result.Successful() && response) {
+        auto lifetime = lifetime_(*response);
+        if (lifetime.count() > 0) {
+          entry->response = response;
+          entry->expiration_time = now + lifetime;
+          refresh_delay = GetRefreshDelay(lifetime);
+          entry->refresh_time = now + refresh_delay;
+          schedule_refresh = true;
+        } else {
+          entry->response = nullptr;
+        }
+      } else if (entry->response && now < entry->expiration_time) {
+        // Keep serving the cached response and retry the refresh shortly.
+        refresh_delay = kRefreshRetryDelay;
+        entry->refresh_time = now + refresh_delay;
+        schedule_refresh = true;
+      }
+
+      schedule_refresh = schedule_refresh && async_executor_ && is_running_;
+    }
+
+    if (schedule_refresh) {
+      ScheduleRefresh(entry, now + refresh_delay);
+    }
+
+    for (auto& waiter : waiters) {
+      waiter.result = result;
+      if (result.Successful() && response) {
+        waiter.response = std::make_shared<TResponse>(*response);
+      }
+      waiter.Finish();
+    }
+  }
+
+  /// Schedules a background refresh of the entry at the given time.
+  void ScheduleRefresh(const std::shared_ptr<Entry>& entry,
+                       std::chrono::nanoseconds refresh_time) noexcept {
+    std::function<bool()> canceller;
+    auto execution_result = async_executor_->ScheduleFor(
+        [this, entry]() {
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry->refresh_canceller = nullptr;
+            if (entry->fetch_in_flight || !is_running_) {
+              return;
+            }
+            entry->fetch_in_flight = true;
+          }
+          Fetch(entry);
+        },
+        refresh_time.count(), canceller);
+    if (!execution_result.Successful()) {
+      // The next Get past the refresh time starts the refresh instead.
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry->refresh_canceller = std::move(canceller);
+  }
+
+  /// Returns the jittered delay after which a response with the given lifetime
+  /// is refreshed.
+  static std::chrono::nanoseconds GetRefreshDelay(
+      std::chrono::nanoseconds lifetime) noexcept {
+    thread_local std::mt19937 generator(std::random_device{}());
+    std::uniform_real_distribution<double> jitter(0, kRefreshJitterRatio);
+    return std::chrono::nanoseconds(static_cast<int64_t>(
+        lifetime.count() * (kRefreshLifetimeRatio - jitter(generator))));
+  }
+
+  FetchFunction fetch_;
+  LifetimeFunction lifetime_;
+  std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
+
+  /// Protects the entries and their state.
+  std::mutex mutex_;
+  bool is_running_;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+};
+}  // namespace google::scp::cpio::common
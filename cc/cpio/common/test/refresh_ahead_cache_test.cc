@@ -0,0 +1,261 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cpio/common/src/refresh_ahead_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/async_executor/mock/mock_async_executor.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::Timestamp;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::common::TimeProvider;
+using google::scp::core::test::IsSuccessful;
+using google::scp::core::test::ResultIs;
+using google::scp::cpio::common::RefreshAheadCache;
+using std::function;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
+using std::this_thread::sleep_for;
+
+namespace {
+constexpr char kKey[] = "key";
+
+struct TestRequest {};
+
+struct TestResponse {
+  string value;
+  nanoseconds lifetime;
+};
+}  // namespace
+
+namespace google::scp::cpio::common::test {
+class RefreshAheadCacheTest : public ::testing::Test {
+ protected:
+  RefreshAheadCacheTest() : executor_(make_shared<MockAsyncExecutor>()) {
+    executor_->schedule_for_mock = [this](const AsyncOperation& work,
+                                          Timestamp timestamp,
+                                          function<bool()>& canceller) {
+      scheduled_work_.push_back(work);
+      scheduled_timestamps_.push_back(timestamp);
+      canceller = [this]() {
+        cancelled_ = true;
+        return true;
+      };
+      return SuccessExecutionResult();
+    };
+  }
+
+  /// Returns a fetch that completes with the given value and lifetime.
+  RefreshAheadCache<TestRequest, TestResponse>::FetchFunction FetchReturning(
+      const string& value, nanoseconds lifetime) {
+    return [this, value, lifetime](
+               AsyncContext<TestRequest, TestResponse>& context) {
+      fetch_count_++;
+      context.response = make_shared<TestResponse>();
+      context.response->value = value + std::to_string(fetch_count_);
+      context.response->lifetime = lifetime;
+      context.result = SuccessExecutionResult();
+      context.Finish();
+      return SuccessExecutionResult();
+    };
+  }
+
+  static nanoseconds GetLifetime(const TestResponse& response) {
+    return response.lifetime;
+  }
+
+  /// Gets the key and returns the value the context completed with.
+  string Get(RefreshAheadCache<TestRequest, TestResponse>& cache) {
+    string value;
+    AsyncContext<TestRequest, TestResponse> context(
+        make_shared<TestRequest>(), [&value](auto& context) {
+          EXPECT_SUCCESS(context.result);
+          value = context.response->value;
+        });
+    EXPECT_SUCCESS(cache.Get(kKey, context));
+    return value;
+  }
+
+  shared_ptr<MockAsyncExecutor> executor_;
+  vector<AsyncOperation> scheduled_work_;
+  vector<Timestamp> scheduled_timestamps_;
+  bool cancelled_ = false;
+  int fetch_count_ = 0;
+};
+
+TEST_F(RefreshAheadCacheTest, ServesCachedResponseUntilRefresh) {
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      FetchReturning("value", hours(1)), GetLifetime, executor_);
+
+  EXPECT_EQ(Get(cache), "value1");
+  EXPECT_EQ(Get(cache), "value1");
+  EXPECT_EQ(fetch_count_, 1);
+}
+
+TEST_F(RefreshAheadCacheTest, ConcurrentMissesShareOneFetch) {
+  vector<AsyncContext<TestRequest, TestResponse>> fetches;
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      [&fetches](AsyncContext<TestRequest, TestResponse>& context) {
+        fetches.push_back(context);
+        return SuccessExecutionResult();
+      },
+      GetLifetime, executor_);
+
+  int completed = 0;
+  vector<AsyncContext<TestRequest, TestResponse>> contexts(3);
+  for (auto& context : contexts) {
+    context.request = make_shared<TestRequest>();
+    context.callback = [&completed](auto& context) {
+      EXPECT_SUCCESS(context.result);
+      EXPECT_EQ(context.response->value, "value");
+      completed++;
+    };
+    EXPECT_SUCCESS(cache.Get(kKey, context));
+  }
+  ASSERT_EQ(fetches.size(), 1);
+  EXPECT_EQ(completed, 0);
+
+  fetches[0].response = make_shared<TestResponse>();
+  fetches[0].response->value = "value";
+  fetches[0].response->lifetime = hours(1);
+  fetches[0].result = SuccessExecutionResult();
+  fetches[0].Finish();
+  EXPECT_EQ(completed, 3);
+}
+
+TEST_F(RefreshAheadCacheTest, SchedulesRefreshAheadOfExpiry) {
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      FetchReturning("value", hours(1)), GetLifetime, executor_);
+
+  auto before = TimeProvider::GetSteadyTimestampInNanoseconds();
+  EXPECT_EQ(Get(cache), "value1");
+  auto after = TimeProvider::GetSteadyTimestampInNanoseconds();
+
+  ASSERT_EQ(scheduled_work_.size(), 1);
+  auto lifetime = nanoseconds(hours(1)).count();
+  EXPECT_GE(scheduled_timestamps_[0], before.count() + lifetime * 0.65);
+  EXPECT_LE(scheduled_timestamps_[0], after.count() + lifetime * 0.75);
+
+  // The scheduled refresh replaces the cached response and schedules the
+  // next one.
+  scheduled_work_[0]();
+  EXPECT_EQ(fetch_count_, 2);
+  EXPECT_EQ(Get(cache), "value2");
+  EXPECT_EQ(scheduled_work_.size(), 2);
+}
+
+TEST_F(RefreshAheadCacheTest, FailedRefreshKeepsServingCachedResponse) {
+  bool fail = false;
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      [this, &fail](AsyncContext<TestRequest, TestResponse>& context) {
+        if (fail) {
+          return ExecutionResult(FailureExecutionResult(SC_UNKNOWN));
+        }
+        return FetchReturning("value", hours(1))(context);
+      },
+      GetLifetime, executor_);
+
+  EXPECT_EQ(Get(cache), "value1");
+  ASSERT_EQ(scheduled_work_.size(), 1);
+
+  fail = true;
+  auto before = TimeProvider::GetSteadyTimestampInNanoseconds();
+  scheduled_work_[0]();
+  EXPECT_EQ(Get(cache), "value1");
+
+  // The refresh is retried shortly.
+  ASSERT_EQ(scheduled_work_.size(), 2);
+  EXPECT_LE(scheduled_timestamps_[1],
+            before.count() + nanoseconds(seconds(2)).count());
+
+  fail = false;
+  scheduled_work_[1]();
+  EXPECT_EQ(Get(cache), "value2");
+}
+
+TEST_F(RefreshAheadCacheTest, FailedFetchCompletesContextOnce) {
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      [](AsyncContext<TestRequest, TestResponse>& context) {
+        context.result = FailureExecutionResult(SC_UNKNOWN);
+        context.Finish();
+        return context.result;
+      },
+      GetLifetime, executor_);
+
+  int completed = 0;
+  AsyncContext<TestRequest, TestResponse> context(
+      make_shared<TestRequest>(), [&completed](auto& context) {
+        EXPECT_THAT(context.result,
+                    ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+        completed++;
+      });
+  EXPECT_SUCCESS(cache.Get(kKey, context));
+  EXPECT_EQ(completed, 1);
+  EXPECT_TRUE(scheduled_work_.empty());
+}
+
+TEST_F(RefreshAheadCacheTest, ZeroLifetimeIsNotCached) {
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      FetchReturning("value", nanoseconds(0)), GetLifetime, executor_);
+
+  EXPECT_EQ(Get(cache), "value1");
+  EXPECT_EQ(Get(cache), "value2");
+  EXPECT_TRUE(scheduled_work_.empty());
+}
+
+TEST_F(RefreshAheadCacheTest, RefreshesLazilyWithoutExecutor) {
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      FetchReturning("value", milliseconds(400)), GetLifetime);
+
+  EXPECT_EQ(Get(cache), "value1");
+  sleep_for(milliseconds(320));
+
+  // Past the refresh point the cached response is still served while the
+  // refresh is started.
+  EXPECT_EQ(Get(cache), "value1");
+  EXPECT_EQ(fetch_count_, 2);
+  EXPECT_EQ(Get(cache), "value2");
+}
+
+TEST_F(RefreshAheadCacheTest, StopCancelsScheduledRefresh) {
+  RefreshAheadCache<TestRequest, TestResponse> cache(
+      FetchReturning("value", hours(1)), GetLifetime, executor_);
+
+  EXPECT_EQ(Get(cache), "value1");
+  cache.Stop();
+  EXPECT_TRUE(cancelled_);
+  EXPECT_EQ(Get(cache), "value1");
+}
+}  // namespace google::scp::cpio::common::test
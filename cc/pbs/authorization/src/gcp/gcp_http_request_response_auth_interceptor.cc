@@ -27,9 +27,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "core/authorization_service/src/error_codes.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/interface/type_def.h"
 #include "core/utils/src/base64.h"
 #include "public/core/interface/execution_result.h"
@@ -43,10 +45,13 @@ using google::scp::core::HttpRequest;
 using google::scp::core::HttpResponse;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::common::TimeProvider;
 using google::scp::core::utils::Base64Decode;
 using google::scp::core::utils::PadBase64Encoding;
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
+using std::mutex;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -135,7 +140,8 @@ ExecutionResult GcpHttpRequestResponseAuthInterceptor::PrepareRequest(
 
 core::ExecutionResultOr<AuthorizedMetadata>
 GcpHttpRequestResponseAuthInterceptor::ObtainAuthorizedMetadataFromResponse(
-    const AuthorizationMetadata&, const HttpResponse& http_response) {
+    const AuthorizationMetadata& authorization_metadata,
+    const HttpResponse& http_response) {
   string body_str = http_response.body.ToString();
   json body_json;
   bool parse_fail = true;
@@ -149,9 +155,65 @@ GcpHttpRequestResponseAuthInterceptor::ObtainAuthorizedMetadataFromResponse(
         core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN);
   }
 
-  return AuthorizedMetadata{
-      .authorized_domain = make_shared<core::AuthorizedDomain>(
-          body_json[kAuthorizedDomain].get<string>())};
+  auto authorized_domain = make_shared<core::AuthorizedDomain>(
+      body_json[kAuthorizedDomain].get<string>());
+
+  if (id_token_verifier_) {
+    // The next tokens of the identity are authorized locally.
+    auto claims_or = id_token_verifier_->Verify(
+        authorization_metadata.authorization_token);
+    if (claims_or.Successful()) {
+      auto expiration_timestamp =
+          TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              kAuthorizedIdentityLifetime)
+              .count();
+      auto& identities = authorized_identities_->identities;
+      lock_guard<mutex> lock(authorized_identities_->mutex);
+      if (identities.size() >= kMaxAuthorizedIdentities) {
+        identities.clear();
+      }
+      identities[GetIdentityKey(authorization_metadata, *claims_or)] =
+          AuthorizedIdentity{authorized_domain, expiration_timestamp};
+    }
+  }
+
+  return AuthorizedMetadata{.authorized_domain = authorized_domain};
+}
+
+core::ExecutionResultOr<AuthorizedMetadata>
+GcpHttpRequestResponseAuthInterceptor::AuthorizeLocally(
+    const AuthorizationMetadata& authorization_metadata) {
+  if (!id_token_verifier_) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_LOCAL_AUTHORIZATION_UNAVAILABLE);
+  }
+  auto claims_or =
+      id_token_verifier_->Verify(authorization_metadata.authorization_token);
+  if (!claims_or.Successful()) {
+    return claims_or.result();
+  }
+
+  const auto& identities = authorized_identities_->identities;
+  lock_guard<mutex> lock(authorized_identities_->mutex);
+  auto identity_it =
+      identities.find(GetIdentityKey(authorization_metadata, *claims_or));
+  if (identity_it == identities.end() ||
+      identity_it->second.expiration_timestamp <
+          TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks()) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_LOCAL_AUTHORIZATION_UNAVAILABLE);
+  }
+  return AuthorizedMetadata{.authorized_domain =
+                                identity_it->second.authorized_domain};
+}
+
+string GcpHttpRequestResponseAuthInterceptor::GetIdentityKey(
+    const AuthorizationMetadata& authorization_metadata,
+    const IdTokenClaims& claims) {
+  // The length prefix keeps the claimed identity and the subject apart.
+  return absl::StrCat(authorization_metadata.claimed_identity.size(), ":",
+                      authorization_metadata.claimed_identity, claims.subject);
 }
 
 }  // namespace google::scp::pbs
@@ -16,15 +16,22 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "core/interface/authorization_proxy_interface.h"
 #include "core/interface/config_provider_interface.h"
 #include "core/interface/configuration_keys.h"
 #include "core/interface/http_request_response_auth_interceptor_interface.h"
 #include "core/interface/http_types.h"
+#include "core/interface/type_def.h"
 #include "public/core/interface/execution_result.h"
 
+#include "gcp_id_token_verifier.h"
+
 namespace google::scp::pbs {
 
 class GcpHttpRequestResponseAuthInterceptor
@@ -36,6 +43,18 @@ class GcpHttpRequestResponseAuthInterceptor
       std::shared_ptr<core::ConfigProviderInterface> config_provider)
       : config_provider_(config_provider) {}
 
+  /**
+   * @brief Also authorizes locally the tokens verified by id_token_verifier,
+   * for the identities the remote authorizer authorized in the last
+   * kAuthorizedIdentityLifetime.
+   */
+  GcpHttpRequestResponseAuthInterceptor(
+      std::shared_ptr<core::ConfigProviderInterface> config_provider,
+      std::shared_ptr<GcpIdTokenVerifier> id_token_verifier)
+      : config_provider_(config_provider),
+        id_token_verifier_(id_token_verifier),
+        authorized_identities_(std::make_shared<AuthorizedIdentities>()) {}
+
   core::ExecutionResult PrepareRequest(
       const core::AuthorizationMetadata& authorization_metadata,
       core::HttpRequest& http_request) override;
@@ -45,8 +64,46 @@ class GcpHttpRequestResponseAuthInterceptor
       const core::AuthorizationMetadata& authorization_metadata,
       const core::HttpResponse& http_response) override;
 
+  core::ExecutionResultOr<core::AuthorizedMetadata> AuthorizeLocally(
+      const core::AuthorizationMetadata& authorization_metadata) override;
+
+  /// How long the domain authorized remotely for an identity is reused for
+  /// its next tokens.
+  static constexpr std::chrono::minutes kAuthorizedIdentityLifetime =
+      std::chrono::minutes(30);
+
+  /// The max number of identities kept, after which they are all dropped.
+  static constexpr size_t kMaxAuthorizedIdentities = 10000;
+
  private:
+  /// A domain authorized remotely.
+  struct AuthorizedIdentity {
+    std::shared_ptr<core::AuthorizedDomain> authorized_domain;
+    /// The steady time after which the domain is authorized remotely again.
+    core::Timestamp expiration_timestamp;
+  };
+
+  /// The domains authorized remotely by identity, shared by the copies.
+  struct AuthorizedIdentities {
+    absl::flat_hash_map<std::string, AuthorizedIdentity> identities;
+    std::mutex mutex;
+  };
+
+  /**
+   * @brief Returns the key of the identity of the verified claims for the
+   * claimed identity.
+   */
+  static std::string GetIdentityKey(
+      const core::AuthorizationMetadata& authorization_metadata,
+      const IdTokenClaims& claims);
+
   std::shared_ptr<core::ConfigProviderInterface> config_provider_;
+
+  /// Verifies the tokens locally, if local authorization is enabled.
+  std::shared_ptr<GcpIdTokenVerifier> id_token_verifier_;
+
+  /// The domains authorized remotely, if local authorization is enabled.
+  std::shared_ptr<AuthorizedIdentities> authorized_identities_;
 };
 
 }  // namespace google::scp::pbs
@@ -0,0 +1,347 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gcp_id_token_verifier.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <openssl/bn.h>
+#include <openssl/rsa.h>
+
+#include "absl/strings/str_split.h"
+#include "core/authorization_service/src/error_codes.h"
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/utils/src/base64.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::HttpClientInterface;
+using google::scp::core::HttpMethod;
+using google::scp::core::HttpRequest;
+using google::scp::core::HttpResponse;
+using google::scp::core::RetryExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
+using google::scp::core::utils::Base64Decode;
+using google::scp::core::utils::PadBase64Encoding;
+using std::bind;
+using std::make_shared;
+using std::move;
+using std::shared_lock;
+using std::shared_mutex;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
+using std::placeholders::_1;
+
+using json = nlohmann::json;
+
+namespace google::scp::pbs {
+namespace {
+
+constexpr char kGcpIdTokenVerifier[] = "GcpIdTokenVerifier";
+
+constexpr size_t kIdTokenParts = 3;
+
+constexpr char kSigningAlgorithm[] = "RS256";
+
+// The keys are not fetched again more often, even for unknown key ids.
+constexpr seconds kMinJwksFetchInterval = seconds(30);
+
+// The tolerated difference between the clocks of the issuer and PBS.
+constexpr seconds kClockSkew = seconds(60);
+
+const vector<string>& GetIssuers() {
+  static const auto* const issuers =
+      new vector<string>{"https://accounts.google.com", "accounts.google.com"};
+  return *issuers;
+}
+
+// Decodes the base64url encoding of the JSON Web Signature (JWS) parts.
+ExecutionResultOr<string> Base64UrlDecode(const string& encoded) {
+  string base64_encoded = encoded;
+  std::replace(base64_encoded.begin(), base64_encoded.end(), '-', '+');
+  std::replace(base64_encoded.begin(), base64_encoded.end(), '_', '/');
+  auto padded_or = PadBase64Encoding(base64_encoded);
+  if (!padded_or.Successful()) {
+    return padded_or.result();
+  }
+  string decoded;
+  auto execution_result = Base64Decode(*padded_or, decoded);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  return decoded;
+}
+
+// Makes the RSA public key of the modulus and exponent of a JSON Web Key.
+shared_ptr<EVP_PKEY> MakeRsaPublicKey(const string& modulus,
+                                      const string& exponent) {
+  auto* n = BN_bin2bn(reinterpret_cast<const uint8_t*>(modulus.data()),
+                      modulus.size(), nullptr);
+  auto* e = BN_bin2bn(reinterpret_cast<const uint8_t*>(exponent.data()),
+                      exponent.size(), nullptr);
+  auto* rsa = RSA_new();
+  if (n == nullptr || e == nullptr || rsa == nullptr ||
+      RSA_set0_key(rsa, n, e, nullptr) != 1) {
+    BN_free(n);
+    BN_free(e);
+    RSA_free(rsa);
+    return nullptr;
+  }
+
+  shared_ptr<EVP_PKEY> key(EVP_PKEY_new(), EVP_PKEY_free);
+  bool is_key_set = key && EVP_PKEY_set1_RSA(key.get(), rsa) == 1;
+  RSA_free(rsa);
+  return is_key_set ? key : nullptr;
+}
+
+bool VerifySignature(EVP_PKEY* key, const string& signed_data,
+                     const string& signature) {
+  shared_ptr<EVP_MD_CTX> context(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+  return context &&
+         EVP_DigestVerifyInit(context.get(), nullptr, EVP_sha256(), nullptr,
+                              key) == 1 &&
+         EVP_DigestVerifyUpdate(context.get(), signed_data.data(),
+                                signed_data.size()) == 1 &&
+         EVP_DigestVerifyFinal(
+             context.get(),
+             reinterpret_cast<const uint8_t*>(signature.data()),
+             signature.size()) == 1;
+}
+
+bool HasAudience(const json& payload, const string& audience) {
+  auto audience_it = payload.find("aud");
+  if (audience_it == payload.end()) {
+    return false;
+  }
+  const auto& audience_claim = *audience_it;
+  if (audience_claim.is_string()) {
+    return audience_claim.get<string>() == audience;
+  }
+  if (audience_claim.is_array()) {
+    return std::any_of(audience_claim.begin(), audience_claim.end(),
+                       [&audience](const json& value) {
+                         return value.is_string() &&
+                                value.get<string>() == audience;
+                       });
+  }
+  return false;
+}
+
+}  // namespace
+
+GcpIdTokenVerifier::GcpIdTokenVerifier(
+    shared_ptr<HttpClientInterface> http_client, string jwks_uri,
+    string audience)
+    : http_client_(move(http_client)),
+      jwks_uri_(make_shared<string>(move(jwks_uri))),
+      audience_(move(audience)),
+      signing_keys_(make_shared<SigningKeys>()),
+      keys_update_timestamp_(0),
+      fetch_timestamp_(0),
+      is_fetching_(false) {}
+
+ExecutionResultOr<IdTokenClaims> GcpIdTokenVerifier::Verify(
+    const string& id_token) noexcept {
+  FetchKeysIfNeeded(false /* has_unknown_key_id */);
+
+  vector<string> parts = absl::StrSplit(id_token, '.');
+  if (parts.size() != kIdTokenParts) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN);
+  }
+
+  auto header_or = Base64UrlDecode(parts[0]);
+  auto payload_or = Base64UrlDecode(parts[1]);
+  auto signature_or = Base64UrlDecode(parts[2]);
+  if (!header_or.Successful() || !payload_or.Successful() ||
+      !signature_or.Successful()) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN);
+  }
+
+  json header, payload;
+  try {
+    header = json::parse(*header_or);
+    payload = json::parse(*payload_or);
+  } catch (...) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN);
+  }
+  if (!header.is_object() || !payload.is_object() ||
+      header.value("alg", "") != kSigningAlgorithm ||
+      !header.contains("kid") || !header["kid"].is_string()) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN);
+  }
+
+  shared_ptr<const SigningKeys> signing_keys;
+  {
+    shared_lock<shared_mutex> lock(signing_keys_mutex_);
+    signing_keys = signing_keys_;
+  }
+  auto key_it = signing_keys->find(header["kid"].get<string>());
+  if (key_it == signing_keys->end()) {
+    FetchKeysIfNeeded(true /* has_unknown_key_id */);
+    return RetryExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_SIGNING_KEYS_UNAVAILABLE);
+  }
+
+  auto signed_data_length = parts[0].size() + 1 + parts[1].size();
+  if (!VerifySignature(key_it->second.get(),
+                       id_token.substr(0, signed_data_length),
+                       *signature_or)) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_INVALID_TOKEN_SIGNATURE);
+  }
+
+  auto now_in_seconds =
+      duration_cast<seconds>(TimeProvider::GetWallTimestampInNanoseconds())
+          .count();
+  const auto& issuers = GetIssuers();
+  if (!payload["iss"].is_string() ||
+      std::find(issuers.begin(), issuers.end(), payload["iss"].get<string>()) ==
+          issuers.end() ||
+      !HasAudience(payload, audience_) ||
+      !payload["exp"].is_number_integer() ||
+      payload["exp"].get<int64_t>() + kClockSkew.count() < now_in_seconds ||
+      !payload["iat"].is_number_integer() ||
+      payload["iat"].get<int64_t>() - kClockSkew.count() > now_in_seconds ||
+      !payload["sub"].is_string()) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_INVALID_TOKEN_CLAIMS);
+  }
+
+  IdTokenClaims claims;
+  claims.subject = payload["sub"].get<string>();
+  if (payload["email"].is_string()) {
+    claims.email = payload["email"].get<string>();
+  }
+  return claims;
+}
+
+ExecutionResult GcpIdTokenVerifier::UpdateKeys(const string& jwks) noexcept {
+  json jwks_json;
+  try {
+    jwks_json = json::parse(jwks);
+  } catch (...) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_INVALID_SIGNING_KEYS);
+  }
+  if (!jwks_json.is_object() || !jwks_json["keys"].is_array()) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_INVALID_SIGNING_KEYS);
+  }
+
+  auto signing_keys = make_shared<SigningKeys>();
+  for (const auto& jwk : jwks_json["keys"]) {
+    // Only the RSA keys can sign RS256 tokens.
+    if (!jwk.is_object() || jwk.value("kty", "") != "RSA" ||
+        !jwk.contains("kid") || !jwk["kid"].is_string() ||
+        !jwk.contains("n") || !jwk["n"].is_string() || !jwk.contains("e") ||
+        !jwk["e"].is_string()) {
+      continue;
+    }
+    auto modulus_or = Base64UrlDecode(jwk["n"].get<string>());
+    auto exponent_or = Base64UrlDecode(jwk["e"].get<string>());
+    if (!modulus_or.Successful() || !exponent_or.Successful()) {
+      continue;
+    }
+    auto key = MakeRsaPublicKey(*modulus_or, *exponent_or);
+    if (key) {
+      signing_keys->emplace(jwk["kid"].get<string>(), move(key));
+    }
+  }
+  if (signing_keys->empty()) {
+    return FailureExecutionResult(
+        core::errors::SC_AUTHORIZATION_SERVICE_INVALID_SIGNING_KEYS);
+  }
+
+  {
+    unique_lock<shared_mutex> lock(signing_keys_mutex_);
+    signing_keys_ = std::move(signing_keys);
+  }
+  keys_update_timestamp_ =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  return SuccessExecutionResult();
+}
+
+void GcpIdTokenVerifier::FetchKeysIfNeeded(bool has_unknown_key_id) noexcept {
+  auto now = TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  auto keys_update_timestamp = keys_update_timestamp_.load();
+  bool are_keys_stale =
+      keys_update_timestamp == 0 ||
+      now - keys_update_timestamp >
+          static_cast<core::Timestamp>(
+              duration_cast<nanoseconds>(kJwksRefreshInterval).count());
+  auto fetch_timestamp = fetch_timestamp_.load();
+  bool can_fetch =
+      fetch_timestamp == 0 ||
+      now - fetch_timestamp >
+          static_cast<core::Timestamp>(
+              duration_cast<nanoseconds>(kMinJwksFetchInterval).count());
+  if ((!are_keys_stale && !has_unknown_key_id) || !can_fetch ||
+      is_fetching_.exchange(true)) {
+    return;
+  }
+  fetch_timestamp_ = now;
+
+  auto http_request = make_shared<HttpRequest>();
+  http_request->method = HttpMethod::GET;
+  http_request->path = jwks_uri_;
+  AsyncContext<HttpRequest, HttpResponse> http_context(
+      move(http_request),
+      bind(&GcpIdTokenVerifier::OnFetchKeysCallback, this, _1));
+  auto execution_result = http_client_->PerformRequest(http_context);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kGcpIdTokenVerifier, kZeroUuid, execution_result,
+              "Failed to fetch the ID token signing keys.");
+    is_fetching_ = false;
+  }
+}
+
+void GcpIdTokenVerifier::OnFetchKeysCallback(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  if (!http_context.result.Successful()) {
+    SCP_ERROR(kGcpIdTokenVerifier, kZeroUuid, http_context.result,
+              "Failed to fetch the ID token signing keys.");
+  } else {
+    auto execution_result = UpdateKeys(http_context.response->body.ToString());
+    if (!execution_result.Successful()) {
+      SCP_ERROR(kGcpIdTokenVerifier, kZeroUuid, execution_result,
+                "Failed to parse the ID token signing keys.");
+    }
+  }
+  is_fetching_ = false;
+}
+
+}  // namespace google::scp::pbs
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+
+#include <openssl/evp.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "core/interface/async_context.h"
+#include "core/interface/http_client_interface.h"
+#include "core/interface/http_types.h"
+#include "core/interface/type_def.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::pbs {
+
+/// The verified claims of an ID token.
+struct IdTokenClaims {
+  std::string subject;
+  std::string email;
+};
+
+/**
+ * @brief Verifies Google signed ID tokens locally, against the JSON Web Key
+ * Set (JWKS) of the issuer.
+ *
+ * The keys are fetched in the background, when they were never fetched, are
+ * older than kJwksRefreshInterval or a token is signed by an unknown key, so
+ * that verifying never waits on the network. Tokens are not verified until
+ * the keys are fetched.
+ */
+class GcpIdTokenVerifier {
+ public:
+  /**
+   * @param http_client The client to fetch the keys with.
+   * @param jwks_uri The URI of the JWKS of the issuer.
+   * @param audience The audience the tokens must be issued for.
+   */
+  GcpIdTokenVerifier(std::shared_ptr<core::HttpClientInterface> http_client,
+                     std::string jwks_uri, std::string audience);
+
+  virtual ~GcpIdTokenVerifier() = default;
+
+  /**
+   * @brief Verifies the RS256 signature, the issuer, the audience and the
+   * lifetime of the token.
+   *
+   * @param id_token The token, as <HEADER>.<PAYLOAD>.<SIGNATURE>.
+   * @return core::ExecutionResultOr<IdTokenClaims> The claims of the token.
+   */
+  virtual core::ExecutionResultOr<IdTokenClaims> Verify(
+      const std::string& id_token) noexcept;
+
+  /**
+   * @brief Replaces the keys with the RSA keys of the JWKS document.
+   *
+   * @param jwks The JWKS document.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult UpdateKeys(const std::string& jwks) noexcept;
+
+  static constexpr std::chrono::seconds kJwksRefreshInterval =
+      std::chrono::hours(1);
+
+ private:
+  using SigningKeys =
+      absl::flat_hash_map<std::string, std::shared_ptr<EVP_PKEY>>;
+
+  /**
+   * @brief Fetches the keys in the background if they are stale, or if the
+   * token has an unknown key id, at most once per kMinJwksFetchInterval.
+   *
+   * @param has_unknown_key_id Whether a token is signed by an unknown key.
+   */
+  void FetchKeysIfNeeded(bool has_unknown_key_id) noexcept;
+
+  /// Is called when the keys are fetched.
+  void OnFetchKeysCallback(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
+  const std::shared_ptr<core::HttpClientInterface> http_client_;
+  const std::shared_ptr<std::string> jwks_uri_;
+  const std::string audience_;
+
+  /// The signing keys by key id, replaced as a whole on each fetch.
+  std::shared_ptr<const SigningKeys> signing_keys_;
+  std::shared_mutex signing_keys_mutex_;
+
+  /// The steady time of the last update of the keys, 0 if never.
+  std::atomic<core::Timestamp> keys_update_timestamp_;
+  /// The steady time of the last fetch of the keys, 0 if never.
+  std::atomic<core::Timestamp> fetch_timestamp_;
+  std::atomic<bool> is_fetching_;
+};
+
+}  // namespace google::scp::pbs
@@ -49,6 +49,7 @@ using ::google::scp::core::FailureExecutionResult;
 using ::google::scp::core::HttpHeaders;
 using ::google::scp::core::HttpRequest;
 using ::google::scp::core::HttpResponse;
+using ::google::scp::core::RetryExecutionResult;
 using ::google::scp::core::SuccessExecutionResult;
 using ::google::scp::core::config_provider::mock::MockConfigProvider;
 using ::google::scp::core::test::IsSuccessful;
@@ -75,6 +76,23 @@ const vector<string>& GetRequiredJWTComponents() {
   return *components;
 }
 
+// Verifies the tokens of the subject of the claims, or fails them all.
+class FakeIdTokenVerifier : public GcpIdTokenVerifier {
+ public:
+  FakeIdTokenVerifier() : GcpIdTokenVerifier(nullptr, "", "") {}
+
+  core::ExecutionResultOr<IdTokenClaims> Verify(
+      const string& id_token) noexcept override {
+    if (!verify_result.Successful()) {
+      return verify_result;
+    }
+    return claims;
+  }
+
+  IdTokenClaims claims{.subject = "subject"};
+  ExecutionResult verify_result = SuccessExecutionResult();
+};
+
 class GcpHttpRequestResponseAuthInterceptorTest : public testing::Test {
  protected:
   GcpHttpRequestResponseAuthInterceptorTest() {
@@ -203,5 +221,63 @@ TEST_F(GcpHttpRequestResponseAuthInterceptorTest,
                   core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN)));
 }
 
+TEST_F(GcpHttpRequestResponseAuthInterceptorTest,
+       AuthorizeLocallyFailsIfDisabled) {
+  EXPECT_THAT(
+      subject_.AuthorizeLocally(authorization_metadata_),
+      ResultIs(FailureExecutionResult(
+          core::errors::
+              SC_AUTHORIZATION_SERVICE_LOCAL_AUTHORIZATION_UNAVAILABLE)));
+}
+
+TEST_F(GcpHttpRequestResponseAuthInterceptorTest,
+       AuthorizeLocallyReusesRemotelyAuthorizedDomain) {
+  auto verifier = make_shared<FakeIdTokenVerifier>();
+  subject_ = GcpHttpRequestResponseAuthInterceptor(
+      make_shared<MockConfigProvider>(), verifier);
+
+  // The identity is not authorized remotely yet.
+  EXPECT_THAT(
+      subject_.AuthorizeLocally(authorization_metadata_),
+      ResultIs(FailureExecutionResult(
+          core::errors::
+              SC_AUTHORIZATION_SERVICE_LOCAL_AUTHORIZATION_UNAVAILABLE)));
+
+  HttpResponse http_response;
+  http_response.body = core::BytesBuffer(R"({"authorized_domain": "domain"})");
+  EXPECT_THAT(subject_.ObtainAuthorizedMetadataFromResponse(
+                  authorization_metadata_, http_response),
+              IsSuccessful());
+
+  EXPECT_THAT(subject_.AuthorizeLocally(authorization_metadata_),
+              IsSuccessfulAndHolds(FieldsAre(Pointee(Eq("domain")))));
+
+  // Another subject, or the same subject claiming another identity, is not.
+  verifier->claims.subject = "other_subject";
+  EXPECT_FALSE(subject_.AuthorizeLocally(authorization_metadata_).Successful());
+  verifier->claims.subject = "subject";
+  authorization_metadata_.claimed_identity = "other_identity";
+  EXPECT_FALSE(subject_.AuthorizeLocally(authorization_metadata_).Successful());
+}
+
+TEST_F(GcpHttpRequestResponseAuthInterceptorTest,
+       AuthorizeLocallyFailsIfTokenIsNotVerified) {
+  auto verifier = make_shared<FakeIdTokenVerifier>();
+  subject_ = GcpHttpRequestResponseAuthInterceptor(
+      make_shared<MockConfigProvider>(), verifier);
+  HttpResponse http_response;
+  http_response.body = core::BytesBuffer(R"({"authorized_domain": "domain"})");
+  EXPECT_THAT(subject_.ObtainAuthorizedMetadataFromResponse(
+                  authorization_metadata_, http_response),
+              IsSuccessful());
+
+  verifier->verify_result = RetryExecutionResult(
+      core::errors::SC_AUTHORIZATION_SERVICE_SIGNING_KEYS_UNAVAILABLE);
+  EXPECT_THAT(
+      subject_.AuthorizeLocally(authorization_metadata_),
+      ResultIs(RetryExecutionResult(
+          core::errors::SC_AUTHORIZATION_SERVICE_SIGNING_KEYS_UNAVAILABLE)));
+}
+
 }  // namespace
 }  // namespace google::scp::pbs
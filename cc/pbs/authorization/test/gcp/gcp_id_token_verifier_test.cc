@@ -0,0 +1,253 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pbs/authorization/src/gcp/gcp_id_token_verifier.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include <openssl/bn.h>
+#include <openssl/rsa.h>
+
+#include "absl/strings/str_cat.h"
+#include "core/authorization_service/src/error_codes.h"
+#include "core/http2_client/mock/mock_http_client.h"
+#include "core/utils/src/base64.h"
+#include "public/core/interface/execution_result.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+namespace google::scp::pbs {
+namespace {
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::BytesBuffer;
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::HttpRequest;
+using ::google::scp::core::HttpResponse;
+using ::google::scp::core::RetryExecutionResult;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::core::http2_client::mock::MockHttpClient;
+using ::google::scp::core::test::IsSuccessful;
+using ::google::scp::core::test::ResultIs;
+using ::google::scp::core::utils::Base64Encode;
+using ::std::atomic;
+using ::std::make_shared;
+using ::std::shared_ptr;
+using ::std::string;
+using ::std::vector;
+
+using json = nlohmann::json;
+
+constexpr char kJwksUri[] = "https://jwks";
+constexpr char kAudience[] = "audience";
+constexpr char kKeyId[] = "key_id";
+
+string Base64UrlEncode(const string& decoded) {
+  string encoded;
+  EXPECT_THAT(Base64Encode(decoded, encoded), IsSuccessful());
+  std::replace(encoded.begin(), encoded.end(), '+', '-');
+  std::replace(encoded.begin(), encoded.end(), '/', '_');
+  encoded.erase(std::remove(encoded.begin(), encoded.end(), '='),
+                encoded.end());
+  return encoded;
+}
+
+string BigNumToString(const BIGNUM* big_num) {
+  string bytes(BN_num_bytes(big_num), '\0');
+  BN_bn2bin(big_num, reinterpret_cast<uint8_t*>(bytes.data()));
+  return bytes;
+}
+
+class GcpIdTokenVerifierTest : public testing::Test {
+ protected:
+  GcpIdTokenVerifierTest()
+      : http_client_(make_shared<MockHttpClient>()),
+        verifier_(http_client_, kJwksUri, kAudience),
+        key_(MakeKey()),
+        other_key_(MakeKey()) {
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count();
+    claims_ = {{"iss", "https://accounts.google.com"},
+               {"aud", kAudience},
+               {"sub", "subject"},
+               {"email", "email"},
+               {"iat", now},
+               {"exp", now + 3600}};
+  }
+
+  static shared_ptr<EVP_PKEY> MakeKey() {
+    shared_ptr<BIGNUM> exponent(BN_new(), BN_free);
+    BN_set_word(exponent.get(), RSA_F4);
+    auto* rsa = RSA_new();
+    RSA_generate_key_ex(rsa, 2048, exponent.get(), nullptr);
+    shared_ptr<EVP_PKEY> key(EVP_PKEY_new(), EVP_PKEY_free);
+    EVP_PKEY_assign_RSA(key.get(), rsa);
+    return key;
+  }
+
+  static string MakeJwks(EVP_PKEY* key, const string& key_id) {
+    const auto* rsa = EVP_PKEY_get0_RSA(key);
+    const BIGNUM* modulus = nullptr;
+    const BIGNUM* exponent = nullptr;
+    RSA_get0_key(rsa, &modulus, &exponent, nullptr);
+    json jwk = {{"kty", "RSA"},
+                {"alg", "RS256"},
+                {"use", "sig"},
+                {"kid", key_id},
+                {"n", Base64UrlEncode(BigNumToString(modulus))},
+                {"e", Base64UrlEncode(BigNumToString(exponent))}};
+    return json{{"keys", json::array({jwk})}}.dump();
+  }
+
+  static string MakeToken(EVP_PKEY* key, const string& key_id,
+                          const json& claims) {
+    json header = {{"alg", "RS256"}, {"typ", "JWT"}, {"kid", key_id}};
+    auto signed_data = absl::StrCat(Base64UrlEncode(header.dump()), ".",
+                                    Base64UrlEncode(claims.dump()));
+
+    shared_ptr<EVP_MD_CTX> context(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    EVP_DigestSignInit(context.get(), nullptr, EVP_sha256(), nullptr, key);
+    size_t signature_length = 0;
+    EVP_DigestSign(context.get(), nullptr, &signature_length,
+                   reinterpret_cast<const uint8_t*>(signed_data.data()),
+                   signed_data.size());
+    string signature(signature_length, '\0');
+    EVP_DigestSign(context.get(), reinterpret_cast<uint8_t*>(signature.data()),
+                   &signature_length,
+                   reinterpret_cast<const uint8_t*>(signed_data.data()),
+                   signed_data.size());
+    signature.resize(signature_length);
+    return absl::StrCat(signed_data, ".", Base64UrlEncode(signature));
+  }
+
+  shared_ptr<MockHttpClient> http_client_;
+  GcpIdTokenVerifier verifier_;
+  shared_ptr<EVP_PKEY> key_;
+  shared_ptr<EVP_PKEY> other_key_;
+  json claims_;
+};
+
+TEST_F(GcpIdTokenVerifierTest, VerifiesTokenSignedByKnownKey) {
+  EXPECT_THAT(verifier_.UpdateKeys(MakeJwks(key_.get(), kKeyId)),
+              IsSuccessful());
+
+  auto claims_or = verifier_.Verify(MakeToken(key_.get(), kKeyId, claims_));
+  ASSERT_THAT(claims_or, IsSuccessful());
+  EXPECT_EQ(claims_or->subject, "subject");
+  EXPECT_EQ(claims_or->email, "email");
+
+  // The audience may also be a list.
+  claims_["aud"] = json::array({"other_audience", kAudience});
+  EXPECT_THAT(verifier_.Verify(MakeToken(key_.get(), kKeyId, claims_)),
+              IsSuccessful());
+}
+
+TEST_F(GcpIdTokenVerifierTest, FailsTokenWithBadSignature) {
+  EXPECT_THAT(verifier_.UpdateKeys(MakeJwks(key_.get(), kKeyId)),
+              IsSuccessful());
+
+  EXPECT_THAT(
+      verifier_.Verify(MakeToken(other_key_.get(), kKeyId, claims_)),
+      ResultIs(FailureExecutionResult(
+          core::errors::SC_AUTHORIZATION_SERVICE_INVALID_TOKEN_SIGNATURE)));
+}
+
+TEST_F(GcpIdTokenVerifierTest, FailsTokenWithBadClaims) {
+  EXPECT_THAT(verifier_.UpdateKeys(MakeJwks(key_.get(), kKeyId)),
+              IsSuccessful());
+
+  vector<json> bad_claims(4, claims_);
+  bad_claims[0]["aud"] = "other_audience";
+  bad_claims[1]["iss"] = "https://issuer";
+  bad_claims[2]["exp"] = claims_["iat"].get<int64_t>() - 3600;
+  bad_claims[3].erase("sub");
+  for (const auto& claims : bad_claims) {
+    EXPECT_THAT(
+        verifier_.Verify(MakeToken(key_.get(), kKeyId, claims)),
+        ResultIs(FailureExecutionResult(
+            core::errors::SC_AUTHORIZATION_SERVICE_INVALID_TOKEN_CLAIMS)));
+  }
+}
+
+TEST_F(GcpIdTokenVerifierTest, FailsMalformedToken) {
+  EXPECT_THAT(verifier_.UpdateKeys(MakeJwks(key_.get(), kKeyId)),
+              IsSuccessful());
+
+  for (const string& token : {"two.parts", "bad.json.web_token", ""}) {
+    EXPECT_THAT(verifier_.Verify(token),
+                ResultIs(FailureExecutionResult(
+                    core::errors::SC_AUTHORIZATION_SERVICE_BAD_TOKEN)));
+  }
+}
+
+TEST_F(GcpIdTokenVerifierTest, FailsInvalidKeys) {
+  for (const string& jwks :
+       {"not json", R"({"keys": "not a list"})", R"({"keys": []})",
+        R"({"keys": [{"kty": "EC", "kid": "key_id"}]})"}) {
+    EXPECT_THAT(
+        verifier_.UpdateKeys(jwks),
+        ResultIs(FailureExecutionResult(
+            core::errors::SC_AUTHORIZATION_SERVICE_INVALID_SIGNING_KEYS)));
+  }
+}
+
+TEST_F(GcpIdTokenVerifierTest, FetchesKeysOfUnknownKeyId) {
+  atomic<size_t> fetch_count = 0;
+  auto jwks = MakeJwks(key_.get(), kKeyId);
+  http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& context) {
+        fetch_count++;
+        EXPECT_EQ(*context.request->path, kJwksUri);
+        context.response = make_shared<HttpResponse>();
+        context.response->body = BytesBuffer(jwks);
+        context.result = SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  // The keys are fetched on the first token and then verify it.
+  auto token = MakeToken(key_.get(), kKeyId, claims_);
+  EXPECT_THAT(verifier_.Verify(token), IsSuccessful());
+  EXPECT_EQ(fetch_count, 1);
+
+  // The fresh keys are not fetched again, even for an unknown key id.
+  EXPECT_THAT(verifier_.Verify(token), IsSuccessful());
+  EXPECT_THAT(
+      verifier_.Verify(MakeToken(key_.get(), "unknown_key_id", claims_)),
+      ResultIs(RetryExecutionResult(
+          core::errors::SC_AUTHORIZATION_SERVICE_SIGNING_KEYS_UNAVAILABLE)));
+  EXPECT_EQ(fetch_count, 1);
+}
+
+TEST_F(GcpIdTokenVerifierTest, RetriesUntilKeysAreFetched) {
+  http_client_->http_get_result_mock = FailureExecutionResult(SC_UNKNOWN);
+
+  EXPECT_THAT(
+      verifier_.Verify(MakeToken(key_.get(), kKeyId, claims_)),
+      ResultIs(RetryExecutionResult(
+          core::errors::SC_AUTHORIZATION_SERVICE_SIGNING_KEYS_UNAVAILABLE)));
+}
+
+}  // namespace
+}  // namespace google::scp::pbs
@@ -218,9 +218,12 @@ ExecutionResult GcpAuthorizationTokenFetcher::FetchToken(
       {string(kMetadataFlavorHeader), string(kMetadataFlavorHeaderValue)});
 
   http_context.request->path = make_shared<Uri>(host_url_);
-  http_context.request->query = make_shared<string>(
-      absl::StrCat(kAudienceParameter, token_target_audience_uri_, "&",
-                   kFormatFullParameter));
+  const auto& audience = fetch_token_context.request &&
+                                !fetch_token_context.request->audience.empty()
+                            ? fetch_token_context.request->audience
+                            : token_target_audience_uri_;
+  http_context.request->query = make_shared<string>(absl::StrCat(
+      kAudienceParameter, audience, "&", kFormatFullParameter));
 
   http_context.callback =
       bind(&GcpAuthorizationTokenFetcher::ProcessHttpResponse, this,
@@ -126,6 +126,30 @@ TEST_F(GcpAuthorizationTokenFetcherTest,
   WaitUntil([&finished]() { return finished.load(); });
 }
 
+TEST_F(GcpAuthorizationTokenFetcherTest, FetchTokenUsesAudienceOfRequest) {
+  EXPECT_CALL(*http_client_, PerformRequest).WillOnce([](auto& http_context) {
+    EXPECT_THAT(http_context.request->query,
+                Pointee(absl::StrCat("audience=", "other_audience",
+                                     "&format=full")));
+    http_context.result = SuccessExecutionResult();
+    http_context.response = make_shared<HttpResponse>();
+    http_context.response->body = BytesBuffer(kBase64EncodedResponse);
+    http_context.Finish();
+    return SuccessExecutionResult();
+  });
+
+  atomic_bool finished(false);
+  fetch_token_context_.request = make_shared<FetchTokenRequest>();
+  fetch_token_context_.request->audience = "other_audience";
+  fetch_token_context_.callback = [&finished](auto& context) {
+    EXPECT_THAT(context.result, IsSuccessful());
+    finished = true;
+  };
+  EXPECT_THAT(subject_->FetchToken(fetch_token_context_), IsSuccessful());
+
+  WaitUntil([&finished]() { return finished.load(); });
+}
+
 TEST_F(GcpAuthorizationTokenFetcherTest, FetchTokenFailsIfHttpRequestFails) {
   EXPECT_CALL(*http_client_, PerformRequest).WillOnce([](auto& http_context) {
     http_context.result =
@@ -87,6 +87,13 @@ class MockBudgetKey : public BudgetKeyInterface {
     return core::SuccessExecutionResult();
   }
 
+  core::ExecutionResult CheckpointDelta(
+      const core::JournalRecoveredComponents& recovered_components,
+      std::shared_ptr<std::list<core::CheckpointLog>>&
+          checkpoint_logs) noexcept {
+    return core::SuccessExecutionResult();
+  }
+
   std::shared_ptr<ConsumeBudgetTransactionProtocolInterface>
       budget_consumption_transaction_protocol;
 
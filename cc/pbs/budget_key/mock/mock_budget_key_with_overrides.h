@@ -59,6 +59,10 @@ class MockBudgetKey : public BudgetKey {
 
   std::function<core::ExecutionResult()> stop_mock;
 
+  std::function<core::ExecutionResult(
+      core::AsyncContext<GetBudgetRequest, GetBudgetResponse>&)>
+      get_budget_mock;
+
   core::ExecutionResult Run() noexcept override {
     return core::SuccessExecutionResult();
   }
@@ -105,6 +109,16 @@ class MockBudgetKey : public BudgetKey {
     return BudgetKey::LoadBudgetKey(load_budget_key_context);
   }
 
+  core::ExecutionResult GetBudget(
+      core::AsyncContext<GetBudgetRequest, GetBudgetResponse>&
+          get_budget_context) noexcept override {
+    if (get_budget_mock) {
+      return get_budget_mock(get_budget_context);
+    }
+
+    return BudgetKey::GetBudget(get_budget_context);
+  }
+
   core::ExecutionResult SerializeBudgetKey(
       core::common::Uuid& budget_key_timeframe_manager_id,
       core::BytesBuffer& budget_key_log_bytes_buffer) noexcept {
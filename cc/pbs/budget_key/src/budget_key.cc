@@ -27,6 +27,7 @@
 #include "pbs/budget_key/src/proto/budget_key.pb.h"
 #include "pbs/budget_key_timeframe_manager/src/budget_key_timeframe_manager.h"
 #include "pbs/budget_key_transaction_protocols/src/consume_budget_transaction_protocol.h"
+#include "pbs/interface/configuration_keys.h"
 
 #include "error_codes.h"
 
@@ -46,6 +47,7 @@ using google::scp::core::NoSQLDatabaseProviderInterface;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::Version;
+using google::scp::core::common::RetryBudget;
 using google::scp::core::common::Serialization;
 using google::scp::core::common::Uuid;
 using google::scp::cpio::MetricClientInterface;
@@ -76,7 +78,8 @@ BudgetKey::BudgetKey(
     const shared_ptr<MetricClientInterface>& metric_client,
     std::shared_ptr<core::MetricRouter> metric_router,
     const shared_ptr<ConfigProviderInterface>& config_provider,
-    const shared_ptr<cpio::AggregateMetricInterface>& budget_key_count_metric)
+    const shared_ptr<cpio::AggregateMetricInterface>& budget_key_count_metric,
+    const shared_ptr<RetryBudget>& retry_budget)
     : name_(name),
       id_(id),
       async_executor_(async_executor),
@@ -85,15 +88,19 @@ BudgetKey::BudgetKey(
           nosql_database_provider_for_background_operations),
       nosql_database_provider_for_live_traffic_(
           nosql_database_provider_for_live_traffic),
-      operation_dispatcher_(async_executor,
-                            core::common::RetryStrategy(
-                                core::common::RetryStrategyType::Exponential,
-                                kBudgetKeyRetryStrategyDelayMs,
-                                kBudgetKeyRetryStrategyTotalRetries)),
+      operation_dispatcher_(
+          async_executor,
+          core::common::RetryStrategy(
+              core::common::RetryStrategyType::Exponential,
+              kBudgetKeyRetryStrategyDelayMs,
+              kBudgetKeyRetryStrategyTotalRetries,
+              core::common::kDefaultRetryStrategyJitterRatio),
+          retry_budget),
       metric_client_(metric_client),
       metric_router_(metric_router),
       config_provider_(config_provider),
-      budget_key_count_metric_(budget_key_count_metric) {}
+      budget_key_count_metric_(budget_key_count_metric),
+      retry_budget_(retry_budget) {}
 
 ExecutionResult BudgetKey::Init() noexcept {
   return journal_service_->SubscribeForRecovery(
@@ -178,14 +185,36 @@ ExecutionResult BudgetKey::OnJournalServiceRecoverCallback(
       name_, timeframe_manager_id, async_executor_, journal_service_,
       nosql_database_provider_for_background_operations_,
       nosql_database_provider_for_live_traffic_, metric_client_, metric_router_,
-      config_provider_, budget_key_count_metric_);
+      config_provider_, budget_key_count_metric_, retry_budget_);
   consume_budget_transaction_protocol_ =
-      make_shared<ConsumeBudgetTransactionProtocol>(
-          budget_key_timeframe_manager_);
+      CreateConsumeBudgetTransactionProtocol();
 
   return budget_key_timeframe_manager_->Init();
 }
 
+shared_ptr<ConsumeBudgetTransactionProtocolInterface>
+BudgetKey::CreateConsumeBudgetTransactionProtocol() noexcept {
+  bool optimistic_consumption_enabled = false;
+  if (!config_provider_ ||
+      !config_provider_
+           ->Get(kBudgetKeyOptimisticConsumptionEnabled,
+                 optimistic_consumption_enabled)
+           .Successful()) {
+    optimistic_consumption_enabled = false;
+  }
+  size_t conflict_max_wait_time_in_milliseconds = 0;
+  if (!config_provider_ ||
+      !config_provider_
+           ->Get(kBudgetKeyTimeframeConflictMaxWaitTimeInMilliseconds,
+                 conflict_max_wait_time_in_milliseconds)
+           .Successful()) {
+    conflict_max_wait_time_in_milliseconds = 0;
+  }
+  return make_shared<ConsumeBudgetTransactionProtocol>(
+      budget_key_timeframe_manager_, optimistic_consumption_enabled,
+      async_executor_, conflict_max_wait_time_in_milliseconds);
+}
+
 ExecutionResult BudgetKey::SerializeBudgetKey(
     Uuid& budget_key_timeframe_manager_id,
     core::BytesBuffer& budget_key_log_bytes_buffer) noexcept {
@@ -305,14 +334,13 @@ void BudgetKey::OnLogLoadBudgetKeyCallback(
       name_, budget_key_timeframe_manager_id, async_executor_, journal_service_,
       nosql_database_provider_for_background_operations_,
       nosql_database_provider_for_live_traffic_, metric_client_, metric_router_,
-      config_provider_, budget_key_count_metric_);
+      config_provider_, budget_key_count_metric_, retry_budget_);
 
   // Initializing metrics in budget_key_timeframe_manager_.
   budget_key_timeframe_manager_->MetricInit();
 
   consume_budget_transaction_protocol_ =
-      make_shared<ConsumeBudgetTransactionProtocol>(
-          budget_key_timeframe_manager_);
+      CreateConsumeBudgetTransactionProtocol();
 
   load_budget_key_context.result = SuccessExecutionResult();
   load_budget_key_context.Finish();
@@ -380,4 +408,20 @@ ExecutionResult BudgetKey::Checkpoint(
   return SuccessExecutionResult();
 }
 
+ExecutionResult BudgetKey::CheckpointDelta(
+    const core::JournalRecoveredComponents& recovered_components,
+    shared_ptr<list<CheckpointLog>>& checkpoint_logs) noexcept {
+  // The budget key log recreates the timeframe manager when replayed, so the
+  // changed budget keys are checkpointed whole, dropping the time groups of
+  // the recovered checkpoint.
+  const auto& journal_component_ids =
+      recovered_components.journal_component_ids;
+  if (recovered_components.checkpoint_component_ids.count(id_) == 0 ||
+      journal_component_ids.count(id_) > 0 ||
+      journal_component_ids.count(GetTimeframeManagerId()) > 0) {
+    return Checkpoint(checkpoint_logs);
+  }
+  return SuccessExecutionResult();
+}
+
 }  // namespace google::scp::pbs
@@ -97,6 +97,8 @@ class BudgetKey : public BudgetKeyInterface {
    * @param metric_client
    * @param config_provider
    * @param budget_key_count_metric Metric to keep count of Budget Key stats.
+   * @param retry_budget Retry budget shared with the other budget keys, may be
+   * null.
    */
   BudgetKey(
       const std::shared_ptr<BudgetKeyName>& name, const core::common::Uuid& id,
@@ -110,7 +112,9 @@ class BudgetKey : public BudgetKeyInterface {
       std::shared_ptr<core::MetricRouter> metric_router,
       const std::shared_ptr<core::ConfigProviderInterface>& config_provider,
       const std::shared_ptr<cpio::AggregateMetricInterface>&
-          budget_key_count_metric);
+          budget_key_count_metric,
+      const std::shared_ptr<core::common::RetryBudget>& retry_budget =
+          nullptr);
 
   /**
    * @brief Constructs a new Budget Key object using customized timeframe
@@ -235,6 +239,11 @@ class BudgetKey : public BudgetKeyInterface {
       std::shared_ptr<std::list<core::CheckpointLog>>& checkpoint_logs) noexcept
       override;
 
+  core::ExecutionResult CheckpointDelta(
+      const core::JournalRecoveredComponents& recovered_components,
+      std::shared_ptr<std::list<core::CheckpointLog>>& checkpoint_logs) noexcept
+      override;
+
  protected:
   /**
    * @brief Serializes the budget key into the provided buffer.
@@ -294,6 +303,16 @@ class BudgetKey : public BudgetKeyInterface {
    */
   core::common::Uuid GetTimeframeManagerId() noexcept;
 
+  /**
+   * @brief Creates the consume budget transaction protocol of the budget key
+   * timeframe manager.
+   *
+   * @return std::shared_ptr<ConsumeBudgetTransactionProtocolInterface> The
+   * protocol.
+   */
+  std::shared_ptr<ConsumeBudgetTransactionProtocolInterface>
+  CreateConsumeBudgetTransactionProtocol() noexcept;
+
   // The name of the current budget key.
   const std::shared_ptr<BudgetKeyName> name_;
 
@@ -344,6 +363,9 @@ class BudgetKey : public BudgetKeyInterface {
 
   // The aggregate metric instance for budget key counters
   std::shared_ptr<cpio::AggregateMetricInterface> budget_key_count_metric_;
+
+  // Retry budget shared with the other budget keys, may be null.
+  std::shared_ptr<core::common::RetryBudget> retry_budget_;
 };
 
 }  // namespace google::scp::pbs
@@ -16,9 +16,16 @@
 
 #include "budget_key_provider.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -29,9 +36,11 @@
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/configuration_keys.h"
 #include "core/interface/journal_service_interface.h"
+#include "google/protobuf/arena.h"
 #include "pbs/budget_key/src/budget_key.h"
 #include "pbs/budget_key/src/error_codes.h"
 #include "pbs/budget_key_provider/src/proto/budget_key_provider.pb.h"
+#include "pbs/interface/configuration_keys.h"
 #include "pbs/interface/metrics_def.h"
 #include "public/cpio/utils/metric_aggregation/interface/simple_metric_interface.h"
 #include "public/cpio/utils/metric_aggregation/src/metric_utils.h"
@@ -39,6 +48,7 @@
 
 #include "error_codes.h"
 
+using google::protobuf::Arena;
 using google::scp::core::AsyncContext;
 using google::scp::core::Byte;
 using google::scp::core::BytesBuffer;
@@ -51,6 +61,7 @@ using google::scp::core::JournalLogStatus;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::Version;
+using google::scp::core::common::AutoExpiryConcurrentMapGarbageCollectionStats;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::Serialization;
 using google::scp::core::common::TimeProvider;
@@ -69,12 +80,19 @@ using google::scp::pbs::budget_key_provider::proto::OperationType;
 using std::bind;
 using std::function;
 using std::list;
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
 using std::move;
+using std::mutex;
 using std::shared_ptr;
 using std::string;
+using std::unordered_map;
 using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::hours;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
 using std::placeholders::_1;
 using std::placeholders::_2;
 using std::this_thread::sleep_for;
@@ -83,11 +101,62 @@ static constexpr Version kCurrentVersion = {.major = 1, .minor = 0};
 // This value MUST NOT change forever.
 static Uuid kBudgetKeyProviderId = {.high = 0xFFFFFFF1, .low = 0x00000002};
 static constexpr char kBudgetKeyProvider[] = "BudgetKeyProvider";
+// The stack memory the arena of a log starts with, enough for the log of a
+// budget key with a long name.
+static constexpr size_t kLogArenaInitialBlockSize = 1024;
+static constexpr nanoseconds kNextDayPrefetchRoundInterval = seconds(1);
+static constexpr nanoseconds kDayDuration = hours(24);
 
 namespace google::scp::pbs {
 
 ExecutionResult BudgetKeyProvider::Init() noexcept {
   RETURN_IF_FAILURE(InitMetricClientInterface());
+  MetricInit();
+
+  size_t cache_max_entry_count = 0;
+  if (config_provider_
+          ->Get(kBudgetKeyProviderCacheMaxEntryCount, cache_max_entry_count)
+          .Successful() &&
+      cache_max_entry_count > 0) {
+    budget_keys_->SetMemoryBudget(cache_max_entry_count);
+
+    size_t hot_key_min_access_count = 0;
+    if (config_provider_
+            ->Get(kBudgetKeyProviderHotKeyMinAccessCount,
+                  hot_key_min_access_count)
+            .Successful() &&
+        hot_key_min_access_count > 0) {
+      size_t hot_key_max_retained_lifetimes =
+          kDefaultBudgetKeyProviderHotKeyMaxRetainedLifetimes;
+      config_provider_->Get(kBudgetKeyProviderHotKeyMaxRetainedLifetimes,
+                            hot_key_max_retained_lifetimes);
+      budget_keys_->SetHotEntryRetention(
+          static_cast<uint8_t>(std::min<size_t>(
+              hot_key_min_access_count, std::numeric_limits<uint8_t>::max())),
+          hot_key_max_retained_lifetimes);
+    }
+  }
+
+  size_t next_day_prefetch_lead_time_in_seconds = 0;
+  if (config_provider_
+          ->Get(kBudgetKeyNextDayPrefetchLeadTimeInSeconds,
+                next_day_prefetch_lead_time_in_seconds)
+          .Successful()) {
+    next_day_prefetch_lead_time_in_nanoseconds_ =
+        std::min(duration_cast<nanoseconds>(
+                     seconds(next_day_prefetch_lead_time_in_seconds)),
+                 kDayDuration)
+            .count();
+  }
+
+  if (!config_provider_
+           ->Get(kBudgetKeyNextDayPrefetchMaxLoadsPerSecond,
+                 next_day_prefetch_max_loads_per_second_)
+           .Successful() ||
+      next_day_prefetch_max_loads_per_second_ == 0) {
+    next_day_prefetch_max_loads_per_second_ =
+        kDefaultBudgetKeyNextDayPrefetchMaxLoadsPerSecond;
+  }
 
   return journal_service_->SubscribeForRecovery(
       kBudgetKeyProviderId,
@@ -130,12 +199,31 @@ ExecutionResult BudgetKeyProvider::Run() noexcept {
     budget_key_provider_pair->needs_loader = true;
   }
 
+  recovered_deleted_budget_keys_.clear();
+
+  // Only the provider serving the traffic loads timeframe groups.
+  if (next_day_prefetch_lead_time_in_nanoseconds_ > 0 &&
+      nosql_database_provider_for_live_traffic_) {
+    lock_guard<mutex> lock(next_day_prefetch_mutex_);
+    is_next_day_prefetch_running_ = true;
+    auto now = TimeProvider::GetWallTimestampInNanoseconds();
+    RETURN_IF_FAILURE(ScheduleNextDayPrefetch(
+        ((now / kDayDuration + 1) * kDayDuration).count()));
+  }
+
   // This line must be executed at the end to ensure keys will not be deleted
   // after the recovery.
   return budget_keys_->Run();
 }
 
 ExecutionResult BudgetKeyProvider::Stop() noexcept {
+  {
+    lock_guard<mutex> lock(next_day_prefetch_mutex_);
+    is_next_day_prefetch_running_ = false;
+    next_day_prefetch_budget_key_names_.clear();
+    next_day_prefetch_cancellation_callback_();
+  }
+
   RETURN_IF_FAILURE(budget_key_count_metric_->Stop());
   RETURN_IF_FAILURE(budget_keys_->Stop());
 
@@ -173,53 +261,39 @@ ExecutionResult BudgetKeyProvider::SerializeBudgetKeyProviderPair(
     shared_ptr<BudgetKeyProviderPair>& budget_key_provider_pair,
     OperationType operation_type,
     BytesBuffer& budget_key_provider_log_bytes_buffer) noexcept {
+  return SerializeBudgetKeyProviderLog(
+      *budget_key_provider_pair->budget_key->GetName(),
+      budget_key_provider_pair->budget_key->GetId(), operation_type,
+      budget_key_provider_log_bytes_buffer);
+}
+
+ExecutionResult BudgetKeyProvider::SerializeBudgetKeyProviderLog(
+    const string& budget_key_name, const Uuid& budget_key_id,
+    OperationType operation_type,
+    BytesBuffer& budget_key_provider_log_bytes_buffer) noexcept {
+  // The logs are short lived, they are built on an arena starting on the
+  // stack.
+  alignas(std::max_align_t) char arena_block[kLogArenaInitialBlockSize];
+  Arena arena(arena_block, sizeof(arena_block));
+
   // Creating the budget key provider log object.
-  BudgetKeyProviderLog budget_key_provider_log;
-  budget_key_provider_log.mutable_version()->set_major(kCurrentVersion.major);
-  budget_key_provider_log.mutable_version()->set_minor(kCurrentVersion.minor);
+  auto* budget_key_provider_log = Arena::Create<BudgetKeyProviderLog>(&arena);
+  budget_key_provider_log->mutable_version()->set_major(kCurrentVersion.major);
+  budget_key_provider_log->mutable_version()->set_minor(kCurrentVersion.minor);
 
   // Creating the budget key provider log v1.0 object.
-  BudgetKeyProviderLog_1_0 budget_key_provider_log_1_0;
-  budget_key_provider_log_1_0.set_budget_key_name(
-      *budget_key_provider_pair->budget_key->GetName());
-  budget_key_provider_log_1_0.set_operation_type(operation_type);
-  budget_key_provider_log_1_0.mutable_id()->set_high(
-      budget_key_provider_pair->budget_key->GetId().high);
-  budget_key_provider_log_1_0.mutable_id()->set_low(
-      budget_key_provider_pair->budget_key->GetId().low);
-
-  // Serialize the budget_key_provider_log_1_0 object.
-  size_t offset = 0;
-  size_t bytes_serialized = 0;
-  BytesBuffer budget_key_provider_log_1_0_bytes_buffer(
-      budget_key_provider_log_1_0.ByteSizeLong());
-  auto execution_result =
-      Serialization::SerializeProtoMessage<BudgetKeyProviderLog_1_0>(
-          budget_key_provider_log_1_0_bytes_buffer, offset,
-          budget_key_provider_log_1_0, bytes_serialized);
-  if (!execution_result.Successful()) {
-    return execution_result;
-  }
-  budget_key_provider_log_1_0_bytes_buffer.length = bytes_serialized;
-
-  // Set the log body of the budget key provider log.
-  budget_key_provider_log.set_log_body(
-      budget_key_provider_log_1_0_bytes_buffer.bytes->data(),
-      budget_key_provider_log_1_0_bytes_buffer.length);
-
-  bytes_serialized = 0;
-  budget_key_provider_log_bytes_buffer.bytes =
-      make_shared<vector<Byte>>(budget_key_provider_log.ByteSizeLong());
-  budget_key_provider_log_bytes_buffer.capacity =
-      budget_key_provider_log.ByteSizeLong();
-  execution_result = Serialization::SerializeProtoMessage<BudgetKeyProviderLog>(
-      budget_key_provider_log_bytes_buffer, offset, budget_key_provider_log,
-      bytes_serialized);
-  if (!execution_result.Successful()) {
-    return execution_result;
-  }
-  budget_key_provider_log_bytes_buffer.length = bytes_serialized;
-  return SuccessExecutionResult();
+  auto* budget_key_provider_log_1_0 =
+      Arena::Create<BudgetKeyProviderLog_1_0>(&arena);
+  budget_key_provider_log_1_0->set_budget_key_name(budget_key_name);
+  budget_key_provider_log_1_0->set_operation_type(operation_type);
+  budget_key_provider_log_1_0->mutable_id()->set_high(budget_key_id.high);
+  budget_key_provider_log_1_0->mutable_id()->set_low(budget_key_id.low);
+
+  // Serialize the budget_key_provider_log_1_0 object as the log body of the
+  // budget key provider log, in a single pass.
+  return Serialization::SerializeEnvelopedProtoMessage(
+      {{budget_key_provider_log, BudgetKeyProviderLog::kLogBodyFieldNumber}},
+      *budget_key_provider_log_1_0, budget_key_provider_log_bytes_buffer);
 }
 
 void BudgetKeyProvider::OnBeforeGarbageCollection(
@@ -340,7 +414,7 @@ ExecutionResult BudgetKeyProvider::OnJournalServiceRecoverCallback(
       budget_key_name, budget_key_id, async_executor_, journal_service_,
       nosql_database_provider_for_background_operations_,
       nosql_database_provider_for_live_traffic_, metric_client_, metric_router_,
-      config_provider_, budget_key_count_metric_);
+      config_provider_, budget_key_count_metric_, retry_budget_);
 
   if (budget_key_provider_log_1_0.operation_type() ==
       OperationType::LOAD_INTO_CACHE) {
@@ -361,12 +435,15 @@ ExecutionResult BudgetKeyProvider::OnJournalServiceRecoverCallback(
 
       budget_key_provider_pair->budget_key = budget_key;
     }
+    budget_key_provider_pair->is_load_logged = true;
 
     return budget_key->Init();
   }
 
   if (budget_key_provider_log_1_0.operation_type() ==
       OperationType::DELETE_FROM_CACHE) {
+    recovered_deleted_budget_keys_[*budget_key_name] = budget_key_id;
+
     shared_ptr<BudgetKeyProviderPair> budget_key_provider_pair;
     execution_result =
         budget_keys_->Find(*budget_key_name, budget_key_provider_pair);
@@ -387,6 +464,105 @@ ExecutionResult BudgetKeyProvider::OnJournalServiceRecoverCallback(
       core::errors::SC_BUDGET_KEY_PROVIDER_INVALID_OPERATION_TYPE);
 }
 
+ExecutionResult BudgetKeyProvider::ScheduleNextDayPrefetch(
+    core::Timestamp day_start) noexcept {
+  auto now = TimeProvider::GetWallTimestampInNanosecondsAsClockTicks();
+  auto prefetch_start = day_start - next_day_prefetch_lead_time_in_nanoseconds_;
+  auto delay = prefetch_start > now ? prefetch_start - now : 0;
+  auto execution_result = async_executor_->ScheduleFor(
+      [this, day_start]() { StartNextDayPrefetch(day_start); },
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() + delay,
+      next_day_prefetch_cancellation_callback_);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kBudgetKeyProvider, activity_id_, execution_result,
+              "Cannot schedule the prefetch of the timeframe groups of the "
+              "day starting at %llu",
+              day_start);
+  }
+  return execution_result;
+}
+
+void BudgetKeyProvider::StartNextDayPrefetch(
+    core::Timestamp day_start) noexcept {
+  lock_guard<mutex> lock(next_day_prefetch_mutex_);
+  if (!is_next_day_prefetch_running_) {
+    return;
+  }
+
+  // The keys in the cache are the ones accessed within the cache lifetime.
+  next_day_prefetch_budget_key_names_.clear();
+  auto execution_result =
+      budget_keys_->Keys(next_day_prefetch_budget_key_names_);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kBudgetKeyProvider, activity_id_, execution_result,
+              "Cannot list the budget keys to prefetch the next day of");
+    next_day_prefetch_budget_key_names_.clear();
+  }
+
+  SCP_INFO(kBudgetKeyProvider, activity_id_,
+           "Prefetching the timeframe groups of the day starting at %llu for "
+           "%zu budget keys",
+           day_start, next_day_prefetch_budget_key_names_.size());
+  PrefetchNextDay(day_start);
+}
+
+void BudgetKeyProvider::PrefetchNextDay(core::Timestamp day_start) noexcept {
+  if (!is_next_day_prefetch_running_) {
+    return;
+  }
+
+  // Once the day has started, the traffic loads the groups left anyway.
+  if (TimeProvider::GetWallTimestampInNanosecondsAsClockTicks() >= day_start) {
+    next_day_prefetch_budget_key_names_.clear();
+  }
+
+  size_t load_count = 0;
+  while (!next_day_prefetch_budget_key_names_.empty() &&
+         load_count < next_day_prefetch_max_loads_per_second_) {
+    auto budget_key_name = move(next_day_prefetch_budget_key_names_.back());
+    next_day_prefetch_budget_key_names_.pop_back();
+
+    shared_ptr<BudgetKeyProviderPair> budget_key_provider_pair;
+    if (!budget_keys_->Find(budget_key_name, budget_key_provider_pair)
+             .Successful() ||
+        !budget_key_provider_pair->is_loaded) {
+      continue;
+    }
+
+    // Getting the budget of any hour of the day loads its timeframe group.
+    AsyncContext<GetBudgetRequest, GetBudgetResponse> get_budget_context(
+        make_shared<GetBudgetRequest>(),
+        [](AsyncContext<GetBudgetRequest, GetBudgetResponse>&) {},
+        activity_id_, activity_id_);
+    get_budget_context.request->time_bucket = day_start;
+    budget_key_provider_pair->budget_key->GetBudget(get_budget_context);
+    load_count++;
+  }
+
+  if (next_day_prefetch_budget_key_names_.empty()) {
+    ScheduleNextDayPrefetch(day_start + kDayDuration.count());
+    return;
+  }
+
+  auto execution_result = async_executor_->ScheduleFor(
+      [this, day_start]() {
+        lock_guard<mutex> lock(next_day_prefetch_mutex_);
+        PrefetchNextDay(day_start);
+      },
+      (TimeProvider::GetSteadyTimestampInNanoseconds() +
+       kNextDayPrefetchRoundInterval)
+          .count(),
+      next_day_prefetch_cancellation_callback_);
+  if (!execution_result.Successful()) {
+    SCP_ERROR(kBudgetKeyProvider, activity_id_, execution_result,
+              "Cannot schedule the next round of the prefetch of the day "
+              "starting at %llu",
+              day_start);
+    next_day_prefetch_budget_key_names_.clear();
+    ScheduleNextDayPrefetch(day_start + kDayDuration.count());
+  }
+}
+
 ExecutionResult BudgetKeyProvider::GetBudgetKey(
     AsyncContext<GetBudgetKeyRequest, GetBudgetKeyResponse>&
         get_budget_key_context) noexcept {
@@ -398,7 +574,7 @@ ExecutionResult BudgetKeyProvider::GetBudgetKey(
       get_budget_key_context.request->budget_key_name, key_id, async_executor_,
       journal_service_, nosql_database_provider_for_background_operations_,
       nosql_database_provider_for_live_traffic_, metric_client_, metric_router_,
-      config_provider_, budget_key_count_metric_);
+      config_provider_, budget_key_count_metric_, retry_budget_);
 
   auto budget_key_pair =
       make_pair(*get_budget_key_context.request->budget_key_name,
@@ -415,12 +591,19 @@ ExecutionResult BudgetKeyProvider::GetBudgetKey(
     if (execution_result.status_code !=
             core::errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_ENTRY_BEING_DELETED &&
         execution_result.status_code !=
-            core::errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS) {
+            core::errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS &&
+        execution_result.status_code !=
+            core::errors::
+                SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED) {
       return execution_result;
     }
 
+    // The cache is full; the eviction makes room for the key shortly.
     if (execution_result.status_code ==
-        core::errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_ENTRY_BEING_DELETED) {
+            core::errors::SC_AUTO_EXPIRY_CONCURRENT_MAP_ENTRY_BEING_DELETED ||
+        execution_result.status_code ==
+            core::errors::
+                SC_AUTO_EXPIRY_CONCURRENT_MAP_MEMORY_BUDGET_EXCEEDED) {
       return RetryExecutionResult(execution_result.status_code);
     }
 
@@ -527,6 +710,7 @@ void BudgetKeyProvider::OnLogLoadBudgetKeyIntoCacheCallback(
     get_budget_key_context.Finish();
     return;
   }
+  budget_key_provider_pair->is_load_logged = true;
 
   AsyncContext<LoadBudgetKeyRequest, LoadBudgetKeyResponse>
       load_budget_key_context;
@@ -598,12 +782,18 @@ ExecutionResult BudgetKeyProvider::Checkpoint(
   SCP_INFO(kBudgetKeyProvider, activity_id_,
            "Number of active budget keys in map to checkpoint: %llu",
            budget_keys.size());
+  vector<shared_ptr<BudgetKeyProviderPair>> budget_key_provider_pairs;
   for (auto budget_key : budget_keys) {
     shared_ptr<BudgetKeyProviderPair> budget_key_provider_pair;
     execution_result = budget_keys_->Find(budget_key, budget_key_provider_pair);
     if (!execution_result.Successful()) {
       return execution_result;
     }
+    budget_key_provider_pairs.push_back(budget_key_provider_pair);
+    // A budget key whose load is not journaled yet is not in any journal.
+    if (!budget_key_provider_pair->is_load_logged) {
+      continue;
+    }
 
     CheckpointLog budget_key_checkpoint_log;
     execution_result = SerializeBudgetKeyProviderPair(
@@ -615,26 +805,128 @@ ExecutionResult BudgetKeyProvider::Checkpoint(
     budget_key_checkpoint_log.component_id = kBudgetKeyProviderId;
     budget_key_checkpoint_log.log_id = Uuid::GenerateUuid();
     budget_key_checkpoint_log.log_status = JournalLogStatus::Log;
+    budget_key_checkpoint_log.shard_key = GetCheckpointShardKey(budget_key);
 
     checkpoint_logs->push_back(move(budget_key_checkpoint_log));
   }
 
-  for (auto budget_key : budget_keys) {
+  for (size_t i = 0; i < budget_keys.size(); ++i) {
+    const auto& budget_key_provider_pair = budget_key_provider_pairs[i];
+    if (!budget_key_provider_pair->is_load_logged) {
+      continue;
+    }
+    auto budget_key_checkpoint_logs = make_shared<list<CheckpointLog>>();
+    execution_result = budget_key_provider_pair->budget_key->Checkpoint(
+        budget_key_checkpoint_logs);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    AppendBudgetKeyCheckpointLogs(budget_keys[i], *budget_key_checkpoint_logs,
+                                  *checkpoint_logs);
+  }
+
+  return SuccessExecutionResult();
+}
+
+ExecutionResult BudgetKeyProvider::CheckpointDelta(
+    const core::JournalRecoveredComponents& recovered_components,
+    shared_ptr<list<CheckpointLog>>& checkpoint_logs) noexcept {
+  vector<string> budget_keys;
+  auto execution_result = budget_keys_->Keys(budget_keys);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  // The budget keys of the recovered checkpoint are the ones with logs in it.
+  // Only the other budget keys need to be loaded into the cache again.
+  vector<shared_ptr<BudgetKeyProviderPair>> budget_key_provider_pairs;
+  vector<shared_ptr<BudgetKeyProviderPair>> budget_key_provider_pairs_to_load;
+  unordered_map<string, Uuid> deleted_budget_keys =
+      recovered_deleted_budget_keys_;
+  for (const auto& budget_key : budget_keys) {
     shared_ptr<BudgetKeyProviderPair> budget_key_provider_pair;
     execution_result = budget_keys_->Find(budget_key, budget_key_provider_pair);
     if (!execution_result.Successful()) {
       return execution_result;
     }
-    execution_result =
-        budget_key_provider_pair->budget_key->Checkpoint(checkpoint_logs);
+
+    if (recovered_components.checkpoint_component_ids.count(
+            budget_key_provider_pair->budget_key->GetId()) > 0) {
+      deleted_budget_keys.erase(budget_key);
+    } else {
+      budget_key_provider_pairs_to_load.push_back(budget_key_provider_pair);
+    }
+    budget_key_provider_pairs.push_back(move(budget_key_provider_pair));
+  }
+
+  // The deletions go first, since a budget key deleted and loaded again has
+  // a new id which cannot be loaded over the one of the recovered checkpoint.
+  for (const auto& [budget_key_name, budget_key_id] : deleted_budget_keys) {
+    CheckpointLog budget_key_checkpoint_log;
+    execution_result = SerializeBudgetKeyProviderLog(
+        budget_key_name, budget_key_id, OperationType::DELETE_FROM_CACHE,
+        budget_key_checkpoint_log.bytes_buffer);
     if (!execution_result.Successful()) {
       return execution_result;
     }
+    budget_key_checkpoint_log.component_id = kBudgetKeyProviderId;
+    budget_key_checkpoint_log.log_id = Uuid::GenerateUuid();
+    budget_key_checkpoint_log.log_status = JournalLogStatus::Log;
+    checkpoint_logs->push_back(move(budget_key_checkpoint_log));
+  }
+
+  for (auto& budget_key_provider_pair : budget_key_provider_pairs_to_load) {
+    CheckpointLog budget_key_checkpoint_log;
+    execution_result = SerializeBudgetKeyProviderPair(
+        budget_key_provider_pair, OperationType::LOAD_INTO_CACHE,
+        budget_key_checkpoint_log.bytes_buffer);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    budget_key_checkpoint_log.component_id = kBudgetKeyProviderId;
+    budget_key_checkpoint_log.log_id = Uuid::GenerateUuid();
+    budget_key_checkpoint_log.log_status = JournalLogStatus::Log;
+    budget_key_checkpoint_log.shard_key =
+        GetCheckpointShardKey(*budget_key_provider_pair->budget_key->GetName());
+    checkpoint_logs->push_back(move(budget_key_checkpoint_log));
+  }
+
+  SCP_INFO(kBudgetKeyProvider, activity_id_,
+           "Number of active budget keys in map: %llu. Budget keys to load: "
+           "%llu, to delete: %llu",
+           budget_key_provider_pairs.size(),
+           budget_key_provider_pairs_to_load.size(),
+           deleted_budget_keys.size());
+  for (auto& budget_key_provider_pair : budget_key_provider_pairs) {
+    auto budget_key_checkpoint_logs = make_shared<list<CheckpointLog>>();
+    execution_result = budget_key_provider_pair->budget_key->CheckpointDelta(
+        recovered_components, budget_key_checkpoint_logs);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    AppendBudgetKeyCheckpointLogs(
+        *budget_key_provider_pair->budget_key->GetName(),
+        *budget_key_checkpoint_logs, *checkpoint_logs);
   }
 
   return SuccessExecutionResult();
 }
 
+size_t BudgetKeyProvider::GetCheckpointShardKey(
+    const string& budget_key_name) noexcept {
+  return std::hash<string>()(budget_key_name);
+}
+
+void BudgetKeyProvider::AppendBudgetKeyCheckpointLogs(
+    const string& budget_key_name, list<CheckpointLog>& budget_key_logs,
+    list<CheckpointLog>& checkpoint_logs) noexcept {
+  auto shard_key = GetCheckpointShardKey(budget_key_name);
+  for (auto& checkpoint_log : budget_key_logs) {
+    checkpoint_log.shard_key = shard_key;
+  }
+  checkpoint_logs.splice(checkpoint_logs.end(), budget_key_logs);
+}
+
 ExecutionResult BudgetKeyProvider::InitMetricClientInterface() {
   size_t metric_aggregation_interval_milliseconds;
   if (!config_provider_
@@ -658,4 +950,48 @@ ExecutionResult BudgetKeyProvider::InitMetricClientInterface() {
   return execution_result;
 }
 
+void BudgetKeyProvider::MetricInit() noexcept {
+  if (!metric_router_) {
+    return;
+  }
+
+  meter_ = metric_router_->GetOrCreateMeter(kBudgetKeyProvider);
+  budget_key_cache_gc_duration_instrument_ =
+      std::static_pointer_cast<opentelemetry::metrics::Histogram<uint64_t>>(
+          metric_router_->GetOrCreateSyncInstrument(
+              kMetricNameBudgetKeyCacheGarbageCollectionDuration,
+              [&]() -> std::shared_ptr<
+                        opentelemetry::metrics::SynchronousInstrument> {
+                return meter_->CreateUInt64Histogram(
+                    kMetricNameBudgetKeyCacheGarbageCollectionDuration,
+                    "Duration of the budget key cache garbage collection "
+                    "passes",
+                    "us");
+              }));
+
+  vector<double> boundaries = {0,     100,    250,    500,    1000,
+                               2500,  5000,   10000,  25000,  50000,
+                               100000, 250000, 500000, 1000000};
+  metric_router_->CreateHistogramViewForInstrument(
+      /*metric_name=*/kMetricNameBudgetKeyCacheGarbageCollectionDuration,
+      /*view_name=*/kMetricNameBudgetKeyCacheGarbageCollectionDuration,
+      /*instrument_type=*/core::MetricRouter::InstrumentType::kHistogram,
+      /*boundaries=*/boundaries,
+      /*version=*/"", /*schema=*/"",
+      /*view_description=*/
+      "Duration of the budget key cache garbage collection passes",
+      /*unit=*/"us");
+
+  budget_keys_->SetGarbageCollectionObserver(
+      [instrument = budget_key_cache_gc_duration_instrument_](
+          const AutoExpiryConcurrentMapGarbageCollectionStats& stats) {
+        opentelemetry::context::Context context;
+        instrument->Record(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                stats.duration)
+                .count(),
+            context);
+      });
+}
+
 }  // namespace google::scp::pbs
@@ -20,8 +20,11 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/base/nullability.h"
 #include "core/common/auto_expiry_concurrent_map/src/auto_expiry_concurrent_map.h"
@@ -34,6 +37,8 @@
 #include "core/interface/partition_types.h"
 #include "core/telemetry/src/metric/metric_router.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
+#include "opentelemetry/metrics/meter.h"
+#include "opentelemetry/metrics/sync_instruments.h"
 #include "pbs/budget_key_provider/src/proto/budget_key_provider.pb.h"
 #include "pbs/interface/budget_key_provider_interface.h"
 #include "public/cpio/interface/metric_client/metric_client_interface.h"
@@ -44,6 +49,9 @@ static constexpr google::scp::core::TimeDuration
     kBudgetKeyProviderRetryStrategyDelayMs = 31;
 static constexpr size_t kBudgetKeyProviderRetryStrategyTotalRetries = 12;
 static constexpr int kBudgetKeyProviderCacheLifetimeSeconds = 300;
+static constexpr size_t kDefaultBudgetKeyProviderHotKeyMaxRetainedLifetimes =
+    12;
+static constexpr size_t kDefaultBudgetKeyNextDayPrefetchMaxLoadsPerSecond = 100;
 
 namespace google::scp::pbs {
 
@@ -51,6 +59,9 @@ namespace google::scp::pbs {
 struct BudgetKeyProviderPair : public core::LoadableObject {
   // A pointer to the budget key.
   std::shared_ptr<BudgetKeyInterface> budget_key;
+  // Whether the load of the budget key into the cache was journaled. The
+  // budget key is in the map before, but is only checkpointed after.
+  std::atomic<bool> is_load_logged{false};
 };
 
 /*! @copydoc BudgetKeyProviderInterface
@@ -99,17 +110,28 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
             std::bind(&BudgetKeyProvider::OnBeforeGarbageCollection, this,
                       std::placeholders::_1, std::placeholders::_2,
                       std::placeholders::_3),
-            async_executor)),
-        operation_dispatcher_(async_executor,
-                              core::common::RetryStrategy(
-                                  core::common::RetryStrategyType::Exponential,
-                                  kBudgetKeyProviderRetryStrategyDelayMs,
-                                  kBudgetKeyProviderRetryStrategyTotalRetries)),
+            async_executor,
+            core::common::kHighContentionConcurrentMapStripeCount,
+            true /* index_expirations */)),
+        retry_budget_(std::make_shared<core::common::RetryBudget>()),
+        operation_dispatcher_(
+            async_executor,
+            core::common::RetryStrategy(
+                core::common::RetryStrategyType::Exponential,
+                kBudgetKeyProviderRetryStrategyDelayMs,
+                kBudgetKeyProviderRetryStrategyTotalRetries,
+                core::common::kDefaultRetryStrategyJitterRatio),
+            retry_budget_),
         metric_client_(metric_client),
         metric_router_(metric_router),
         config_provider_(config_provider),
         partition_id_(partition_id),
-        activity_id_(core::common::Uuid::GenerateUuid()) {}
+        activity_id_(core::common::Uuid::GenerateUuid()),
+        next_day_prefetch_lead_time_in_nanoseconds_(0),
+        next_day_prefetch_max_loads_per_second_(
+            kDefaultBudgetKeyNextDayPrefetchMaxLoadsPerSecond),
+        is_next_day_prefetch_running_(false),
+        next_day_prefetch_cancellation_callback_([]() { return false; }) {}
 
   /**
    * @brief Construct a new Budget Key Provider object for Checkpoint Service
@@ -151,6 +173,29 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
       std::shared_ptr<std::list<core::CheckpointLog>>& checkpoint_logs) noexcept
       override;
 
+  core::ExecutionResult CheckpointDelta(
+      const core::JournalRecoveredComponents& recovered_components,
+      std::shared_ptr<std::list<core::CheckpointLog>>& checkpoint_logs) noexcept
+      override;
+
+  size_t GetCachedBudgetKeysCount() noexcept override {
+    return budget_keys_->Size();
+  }
+
+  void SetResourceScale(double resource_scale) noexcept override {
+    budget_keys_->SetResourceScale(resource_scale);
+  }
+
+  /**
+   * @brief Returns the checkpoint shard key of the logs of a budget key, so
+   * that all the logs of a budget key are stored in the same shard.
+   *
+   * @param budget_key_name The budget key name.
+   * @return size_t The shard key.
+   */
+  static size_t GetCheckpointShardKey(
+      const std::string& budget_key_name) noexcept;
+
  protected:
   /**
    * @brief Serializes the budget key provider pair to the provided buffer.
@@ -166,6 +211,36 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
       budget_key_provider::proto::OperationType operation_type,
       core::BytesBuffer& budget_key_provider_log_bytes_buffer) noexcept;
 
+  /**
+   * @brief Serializes a budget key provider log of the budget key to the
+   * provided buffer.
+   *
+   * @param budget_key_name The name of the budget key.
+   * @param budget_key_id The id of the budget key.
+   * @param operation_type The operation type, insert or remove from cache.
+   * @param budget_key_provider_log_bytes_buffer The output buffer to be used
+   * for serialization.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult SerializeBudgetKeyProviderLog(
+      const std::string& budget_key_name,
+      const core::common::Uuid& budget_key_id,
+      budget_key_provider::proto::OperationType operation_type,
+      core::BytesBuffer& budget_key_provider_log_bytes_buffer) noexcept;
+
+  /**
+   * @brief Moves the checkpoint logs of a budget key at the end of the
+   * checkpoint logs, keyed by the budget key.
+   *
+   * @param budget_key_name The budget key name.
+   * @param budget_key_logs The checkpoint logs of the budget key.
+   * @param checkpoint_logs The checkpoint logs to append to.
+   */
+  static void AppendBudgetKeyCheckpointLogs(
+      const std::string& budget_key_name,
+      std::list<core::CheckpointLog>& budget_key_logs,
+      std::list<core::CheckpointLog>& checkpoint_logs) noexcept;
+
   /**
    * @brief Is Called right before the map garbage collector is trying to remove
    * the element from the map.
@@ -251,6 +326,36 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
       core::AsyncContext<LoadBudgetKeyRequest, LoadBudgetKeyResponse>&
           load_budget_key_context) noexcept;
 
+  /**
+   * @brief Schedules the prefetch of the timeframe groups of a day, to start
+   * the lead time ahead of the day. Must be called with
+   * next_day_prefetch_mutex_ held.
+   *
+   * @param day_start The start of the day, in nanoseconds since epoch.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult ScheduleNextDayPrefetch(
+      core::Timestamp day_start) noexcept;
+
+  /**
+   * @brief Starts the prefetch of the timeframe groups of a day for the budget
+   * keys in the cache.
+   *
+   * @param day_start The start of the day, in nanoseconds since epoch.
+   */
+  void StartNextDayPrefetch(core::Timestamp day_start) noexcept;
+
+  /**
+   * @brief Loads the timeframe groups of a day for the next budget keys left to
+   * prefetch, up to the maximum loads per second, and schedules the next round
+   * a second later. Once all the budget keys are prefetched, or once the day
+   * has started, schedules the prefetch of the following day. Must be called
+   * with next_day_prefetch_mutex_ held.
+   *
+   * @param day_start The start of the day, in nanoseconds since epoch.
+   */
+  void PrefetchNextDay(core::Timestamp day_start) noexcept;
+
   // An instance to the async executor.
   std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
 
@@ -273,6 +378,16 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
       std::string, std::shared_ptr<BudgetKeyProviderPair>>>
       budget_keys_;
 
+  // The ids of the budget keys deleted from the cache by the recovered logs,
+  // by name. Checkpoints on top of the recovered checkpoint replay these
+  // deletions. Cleared when the provider runs.
+  std::unordered_map<std::string, core::common::Uuid>
+      recovered_deleted_budget_keys_;
+
+  // Retry budget shared by the NoSQL operations of the provider and of its
+  // budget keys.
+  std::shared_ptr<core::common::RetryBudget> retry_budget_;
+
   // Operation distpatcher
   core::common::OperationDispatcher operation_dispatcher_;
 
@@ -286,6 +401,14 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
   // metrics.
   absl::Nullable<std::shared_ptr<core::MetricRouter>> metric_router_;
 
+  // The OpenTelemetry Meter used for creating and managing metrics.
+  std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+
+  // The OpenTelemetry Instrument for the duration of the budget key cache
+  // garbage collection passes.
+  std::shared_ptr<opentelemetry::metrics::Histogram<uint64_t>>
+      budget_key_cache_gc_duration_instrument_;
+
   // An instance of the config provider;
   const std::shared_ptr<core::ConfigProviderInterface> config_provider_;
 
@@ -298,10 +421,33 @@ class BudgetKeyProvider : public BudgetKeyProviderInterface {
   // Activity ID
   const core::common::Uuid activity_id_;
 
+  // How long before the start of a day its timeframe groups are prefetched.
+  // Disabled if 0.
+  core::TimeDuration next_day_prefetch_lead_time_in_nanoseconds_;
+
+  // The maximum number of timeframe groups prefetched per second.
+  size_t next_day_prefetch_max_loads_per_second_;
+
+  // Guards the state of the next day prefetch, and keeps its rounds from
+  // running concurrently with Stop.
+  std::mutex next_day_prefetch_mutex_;
+
+  // Whether the next day prefetch is running.
+  bool is_next_day_prefetch_running_;
+
+  // The cancellation callback of the next day prefetch round scheduled.
+  std::function<bool()> next_day_prefetch_cancellation_callback_;
+
+  // The names of the budget keys left to prefetch the next day of.
+  std::vector<std::string> next_day_prefetch_budget_key_names_;
+
  private:
   // Initialize MetricClient.
   //
   core::ExecutionResult InitMetricClientInterface();
+
+  // Initializes the OTel metrics, if metric_router_ is set.
+  void MetricInit() noexcept;
 };
 
 }  // namespace google::scp::pbs
@@ -0,0 +1,531 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the two caches of the budget keys under concurrency: the budget
+// keys of BudgetKeyProvider, and the timeframe groups of
+// BudgetKeyTimeframeManager. The keys are picked from a working set, by a
+// uniform or a zipfian distribution, or are never seen before for the given
+// share of cache misses. The garbage collection of the cache optionally runs
+// along, and the memory each cached key takes is reported.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/async_executor/src/async_executor.h"
+#include "core/common/auto_expiry_concurrent_map/mock/mock_auto_expiry_concurrent_map.h"
+#include "core/common/uuid/src/uuid.h"
+#include "core/config_provider/mock/mock_config_provider.h"
+#include "core/journal_service/mock/mock_journal_service.h"
+#include "core/nosql_database_provider/mock/mock_nosql_database_provider.h"
+#include "core/nosql_database_provider/src/common/error_codes.h"
+#include "core/test/utils/allocation_tracker/allocation_tracker.h"
+#include "pbs/budget_key_provider/src/budget_key_provider.h"
+#include "pbs/budget_key_timeframe_manager/src/budget_key_timeframe_manager.h"
+#include "pbs/interface/configuration_keys.h"
+#include "public/cpio/mock/metric_client/mock_metric_client.h"
+#include "public/cpio/utils/metric_aggregation/mock/mock_aggregate_metric.h"
+
+namespace google::scp::pbs::test {
+
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::AsyncExecutor;
+using ::google::scp::core::AsyncExecutorInterface;
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::ExecutionStatus;
+using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::GetDatabaseItemRequest;
+using ::google::scp::core::GetDatabaseItemResponse;
+using ::google::scp::core::JournalServiceInterface;
+using ::google::scp::core::NoSQLDatabaseProviderInterface;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::core::Timestamp;
+using ::google::scp::core::UpsertDatabaseItemRequest;
+using ::google::scp::core::UpsertDatabaseItemResponse;
+using ::google::scp::core::common::Uuid;
+using ::google::scp::core::common::auto_expiry_concurrent_map::mock::
+    MockAutoExpiryConcurrentMap;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::google::scp::core::journal_service::mock::MockJournalService;
+using ::google::scp::core::nosql_database_provider::mock::
+    MockNoSQLDatabaseProvider;
+using ::google::scp::core::test::GetAllocatedBytes;
+using ::google::scp::cpio::MockAggregateMetric;
+using ::google::scp::cpio::MockMetricClient;
+
+/// The distribution the keys of the working set are picked by.
+enum class KeyDistribution : int64_t {
+  Uniform = 0,
+  Zipfian = 1,
+};
+
+static constexpr double kZipfianExponent = 0.99;
+static constexpr size_t kAsyncExecutorThreadCount = 4;
+static constexpr size_t kAsyncExecutorQueueCap = 1 << 20;
+/// The entries not accessed for this long are collected.
+static constexpr size_t kCacheEntryLifetimeSeconds = 1;
+static constexpr std::chrono::milliseconds kGarbageCollectionInterval(10);
+static constexpr uint64_t kNanosecondsPerDay = 86400000000000;
+/// The first day of the time groups, in 2023.
+static constexpr uint64_t kFirstDay = 19358;
+
+static constexpr char kBytesPerCachedKeyKey[] = "bytes_per_cached_key";
+static constexpr char kRetriesKey[] = "retries";
+static constexpr char kFailuresKey[] = "failures";
+
+/**
+ * @brief Picks the keys of a benchmark by their index. The indices below the
+ * working set size are the cached keys, and the ones above are never picked
+ * twice, to miss the cache.
+ */
+class KeyPicker {
+ public:
+  KeyPicker(KeyDistribution distribution, size_t working_set_size,
+            int64_t miss_percentage)
+      : distribution_(distribution),
+        working_set_size_(working_set_size),
+        miss_percentage_(miss_percentage),
+        next_missing_key_(working_set_size) {
+    if (distribution_ != KeyDistribution::Zipfian) {
+      return;
+    }
+    // The cumulative probabilities of the ranks, the first being the hottest.
+    cumulative_probabilities_.reserve(working_set_size_);
+    double sum = 0;
+    for (size_t rank = 1; rank <= working_set_size_; ++rank) {
+      sum += 1.0 / std::pow(rank, kZipfianExponent);
+      cumulative_probabilities_.push_back(sum);
+    }
+    for (auto& probability : cumulative_probabilities_) {
+      probability /= sum;
+    }
+  }
+
+  size_t Pick(std::mt19937_64& random) {
+    if (std::uniform_int_distribution<int64_t>(0, 99)(random) <
+        miss_percentage_) {
+      return next_missing_key_.fetch_add(1);
+    }
+    if (distribution_ == KeyDistribution::Uniform) {
+      return std::uniform_int_distribution<size_t>(0, working_set_size_ - 1)(
+          random);
+    }
+    auto it = std::lower_bound(
+        cumulative_probabilities_.begin(), cumulative_probabilities_.end(),
+        std::uniform_real_distribution<double>(0, 1)(random));
+    return std::min<size_t>(it - cumulative_probabilities_.begin(),
+                            working_set_size_ - 1);
+  }
+
+  size_t GetWorkingSetSize() const { return working_set_size_; }
+
+ private:
+  const KeyDistribution distribution_;
+  const size_t working_set_size_;
+  const int64_t miss_percentage_;
+  std::vector<double> cumulative_probabilities_;
+  std::atomic<size_t> next_missing_key_;
+};
+
+/**
+ * @brief Runs the operation until it is not retried, and waits for its
+ * callback.
+ *
+ * @param context The context of the operation.
+ * @param operation The operation.
+ * @param retries Incremented on each retry.
+ * @return ExecutionResult The result the operation finished with.
+ */
+template <typename TRequest, typename TResponse, typename TOperation>
+ExecutionResult ExecuteAndWait(AsyncContext<TRequest, TResponse>& context,
+                               TOperation operation, uint64_t& retries) {
+  std::atomic<bool> finished(false);
+  ExecutionResult result;
+  context.callback = [&](AsyncContext<TRequest, TResponse>& context) {
+    result = context.result;
+    finished = true;
+  };
+  while (true) {
+    auto execution_result = operation(context);
+    if (execution_result.status == ExecutionStatus::Retry) {
+      retries++;
+      std::this_thread::yield();
+      continue;
+    }
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    break;
+  }
+  while (!finished.load()) {
+    std::this_thread::yield();
+  }
+  return result;
+}
+
+/// A database which has none of the keys, and takes each write.
+std::shared_ptr<NoSQLDatabaseProviderInterface> CreateEmptyDatabase() {
+  auto nosql_database_provider = std::make_shared<MockNoSQLDatabaseProvider>();
+  nosql_database_provider->get_database_item_mock =
+      [](AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+             context) {
+        context.result = FailureExecutionResult(
+            core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+  nosql_database_provider->upsert_database_item_mock =
+      [](AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>&
+             context) {
+        context.result = SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+  return nosql_database_provider;
+}
+
+/// A timeframe manager whose garbage collection is run by the benchmark.
+class BenchmarkBudgetKeyTimeframeManager : public BudgetKeyTimeframeManager {
+ public:
+  using GroupMap =
+      MockAutoExpiryConcurrentMap<TimeGroup,
+                                  std::shared_ptr<BudgetKeyTimeframeGroup>>;
+
+  BenchmarkBudgetKeyTimeframeManager(
+      const std::shared_ptr<AsyncExecutorInterface>& async_executor,
+      const std::shared_ptr<JournalServiceInterface>& journal_service,
+      const std::shared_ptr<NoSQLDatabaseProviderInterface>&
+          nosql_database_provider,
+      const std::shared_ptr<core::ConfigProviderInterface>& config_provider)
+      : BudgetKeyTimeframeManager(
+            std::make_shared<std::string>("benchmark_budget_key"),
+            Uuid::GenerateUuid(), async_executor, journal_service,
+            nosql_database_provider, std::make_shared<MockMetricClient>(),
+            /*metric_router=*/nullptr, config_provider,
+            std::make_shared<MockAggregateMetric>()) {
+    budget_key_timeframe_groups_ = std::make_unique<GroupMap>(
+        kCacheEntryLifetimeSeconds, true /* extend_entry_lifetime_on_access */,
+        true /* block_entry_while_eviction */,
+        std::bind(
+            &BenchmarkBudgetKeyTimeframeManager::OnBeforeGarbageCollection,
+            this, std::placeholders::_1, std::placeholders::_2,
+            std::placeholders::_3),
+        async_executor);
+  }
+
+  void RunGarbageCollector() {
+    static_cast<GroupMap*>(budget_key_timeframe_groups_.get())
+        ->RunGarbageCollector();
+  }
+};
+
+/// A budget key provider whose garbage collection is run by the benchmark.
+class BenchmarkBudgetKeyProvider : public BudgetKeyProvider {
+ public:
+  using KeyMap =
+      MockAutoExpiryConcurrentMap<std::string,
+                                  std::shared_ptr<BudgetKeyProviderPair>>;
+
+  BenchmarkBudgetKeyProvider(
+      const std::shared_ptr<AsyncExecutorInterface>& async_executor,
+      const std::shared_ptr<JournalServiceInterface>& journal_service,
+      const std::shared_ptr<NoSQLDatabaseProviderInterface>&
+          nosql_database_provider,
+      const std::shared_ptr<core::ConfigProviderInterface>& config_provider)
+      : BudgetKeyProvider(async_executor, journal_service,
+                          nosql_database_provider,
+                          std::make_shared<MockMetricClient>(),
+                          /*metric_router=*/nullptr, config_provider) {
+    budget_keys_ = std::make_unique<KeyMap>(
+        kCacheEntryLifetimeSeconds, true /* extend_entry_lifetime_on_access */,
+        true /* block_entry_while_eviction */,
+        std::bind(&BenchmarkBudgetKeyProvider::OnBeforeGarbageCollection, this,
+                  std::placeholders::_1, std::placeholders::_2,
+                  std::placeholders::_3),
+        async_executor);
+  }
+
+  void RunGarbageCollector() {
+    static_cast<KeyMap*>(budget_keys_.get())->RunGarbageCollector();
+  }
+};
+
+/**
+ * @brief Sets the cache up once for all the threads of a benchmark.
+ *
+ * The benchmark arguments are the key distribution, the working set size, the
+ * percentage of cache misses and whether the garbage collection runs.
+ */
+class BudgetKeyCacheFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    key_picker_ = std::make_unique<KeyPicker>(
+        static_cast<KeyDistribution>(state.range(0)), state.range(1),
+        state.range(2));
+    async_executor_ = std::make_shared<AsyncExecutor>(kAsyncExecutorThreadCount,
+                                                      kAsyncExecutorQueueCap);
+    async_executor_->Init();
+    async_executor_->Run();
+    journal_service_ = std::make_shared<MockJournalService>();
+    nosql_database_provider_ = CreateEmptyDatabase();
+    auto config_provider = std::make_shared<MockConfigProvider>();
+    config_provider->Set(kBudgetKeyTableName, std::string("PBS_BudgetKeys"));
+    config_provider_ = config_provider;
+    CreateCache();
+
+    // Every key of the working set is cached before the benchmark starts.
+    auto allocated_bytes = GetAllocatedBytes();
+    uint64_t retries = 0;
+    for (size_t i = 0; i < key_picker_->GetWorkingSetSize(); ++i) {
+      GetKey(i, retries);
+    }
+    bytes_per_cached_key_ =
+        static_cast<double>(GetAllocatedBytes() - allocated_bytes) /
+        key_picker_->GetWorkingSetSize();
+
+    stop_garbage_collection_ = false;
+    if (state.range(3) != 0) {
+      garbage_collection_thread_ = std::thread([this]() {
+        while (!stop_garbage_collection_) {
+          RunGarbageCollector();
+          std::this_thread::sleep_for(kGarbageCollectionInterval);
+        }
+      });
+    }
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    stop_garbage_collection_ = true;
+    if (garbage_collection_thread_.joinable()) {
+      garbage_collection_thread_.join();
+    }
+    DestroyCache();
+    async_executor_->Stop();
+  }
+
+  /// @brief Creates the cache benchmarked.
+  virtual void CreateCache() = 0;
+
+  /// @brief Destroys the cache benchmarked.
+  virtual void DestroyCache() = 0;
+
+  /// @brief Gets a key from the cache, loading it on a miss.
+  virtual ExecutionResult GetKey(size_t key_index, uint64_t& retries) = 0;
+
+  /// @brief Runs a pass of the garbage collection of the cache.
+  virtual void RunGarbageCollector() = 0;
+
+  /// @brief Reports the counters of a benchmark thread.
+  void ReportCounters(benchmark::State& state, uint64_t retries,
+                      uint64_t failures) {
+    state.SetItemsProcessed(state.iterations());
+    state.counters[kRetriesKey] = retries;
+    state.counters[kFailuresKey] = failures;
+    if (state.thread_index() == 0) {
+      state.counters[kBytesPerCachedKeyKey] = bytes_per_cached_key_;
+    }
+  }
+
+  std::unique_ptr<KeyPicker> key_picker_;
+  std::shared_ptr<AsyncExecutorInterface> async_executor_;
+  std::shared_ptr<JournalServiceInterface> journal_service_;
+  std::shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider_;
+  std::shared_ptr<core::ConfigProviderInterface> config_provider_;
+  double bytes_per_cached_key_ = 0;
+  std::atomic<bool> stop_garbage_collection_{false};
+  std::thread garbage_collection_thread_;
+};
+
+/// Caches the timeframe groups of a budget key, the key being the day.
+class BudgetKeyTimeframeManagerFixture : public BudgetKeyCacheFixture {
+ protected:
+  void CreateCache() override {
+    timeframe_manager_ = std::make_unique<BenchmarkBudgetKeyTimeframeManager>(
+        async_executor_, journal_service_, nosql_database_provider_,
+        config_provider_);
+    timeframe_manager_->Init();
+  }
+
+  void DestroyCache() override {
+    timeframe_manager_->Stop();
+    timeframe_manager_ = nullptr;
+  }
+
+  void RunGarbageCollector() override {
+    timeframe_manager_->RunGarbageCollector();
+  }
+
+  static Timestamp GetReportingTime(size_t key_index) {
+    return (kFirstDay + key_index) * kNanosecondsPerDay;
+  }
+
+  ExecutionResult GetKey(size_t key_index, uint64_t& retries) override {
+    AsyncContext<LoadBudgetKeyTimeframeRequest, LoadBudgetKeyTimeframeResponse>
+        load_context;
+    load_context.request = std::make_shared<LoadBudgetKeyTimeframeRequest>();
+    load_context.request->reporting_times.push_back(
+        GetReportingTime(key_index));
+    return ExecuteAndWait(
+        load_context,
+        [this](AsyncContext<LoadBudgetKeyTimeframeRequest,
+                            LoadBudgetKeyTimeframeResponse>& context) {
+          return timeframe_manager_->Load(context);
+        },
+        retries);
+  }
+
+  ExecutionResult UpdateKey(size_t key_index, uint64_t& retries) {
+    AsyncContext<UpdateBudgetKeyTimeframeRequest,
+                 UpdateBudgetKeyTimeframeResponse>
+        update_context;
+    update_context.request =
+        std::make_shared<UpdateBudgetKeyTimeframeRequest>();
+    BudgetKeyTimeframeUpdateInfo update_info;
+    update_info.reporting_time = GetReportingTime(key_index);
+    update_info.active_token_count = 0;
+    update_info.token_count = kMaxToken;
+    update_context.request->timeframes_to_update.push_back(update_info);
+    return ExecuteAndWait(
+        update_context,
+        [this](AsyncContext<UpdateBudgetKeyTimeframeRequest,
+                            UpdateBudgetKeyTimeframeResponse>& context) {
+          return timeframe_manager_->Update(context);
+        },
+        retries);
+  }
+
+  std::unique_ptr<BenchmarkBudgetKeyTimeframeManager> timeframe_manager_;
+};
+
+/// Caches the budget keys, by name.
+class BudgetKeyProviderFixture : public BudgetKeyCacheFixture {
+ protected:
+  void CreateCache() override {
+    budget_key_provider_ = std::make_unique<BenchmarkBudgetKeyProvider>(
+        async_executor_, journal_service_, nosql_database_provider_,
+        config_provider_);
+    budget_key_provider_->Init();
+  }
+
+  void DestroyCache() override {
+    budget_key_provider_->Stop();
+    budget_key_provider_ = nullptr;
+  }
+
+  void RunGarbageCollector() override {
+    budget_key_provider_->RunGarbageCollector();
+  }
+
+  ExecutionResult GetKey(size_t key_index, uint64_t& retries) override {
+    AsyncContext<GetBudgetKeyRequest, GetBudgetKeyResponse> get_context;
+    get_context.request = std::make_shared<GetBudgetKeyRequest>();
+    get_context.request->budget_key_name = std::make_shared<std::string>(
+        "https://origin.com/budget_key_" + std::to_string(key_index));
+    return ExecuteAndWait(
+        get_context,
+        [this](AsyncContext<GetBudgetKeyRequest, GetBudgetKeyResponse>&
+                   context) {
+          return budget_key_provider_->GetBudgetKey(context);
+        },
+        retries);
+  }
+
+  std::unique_ptr<BenchmarkBudgetKeyProvider> budget_key_provider_;
+};
+
+BENCHMARK_DEFINE_F(BudgetKeyTimeframeManagerFixture, Load)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  uint64_t retries = 0;
+  uint64_t failures = 0;
+  for (auto _ : state) {
+    if (!GetKey(key_picker_->Pick(random), retries).Successful()) {
+      failures++;
+    }
+  }
+  ReportCounters(state, retries, failures);
+}
+
+BENCHMARK_DEFINE_F(BudgetKeyTimeframeManagerFixture, LoadAndUpdate)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  uint64_t retries = 0;
+  uint64_t failures = 0;
+  for (auto _ : state) {
+    auto key_index = key_picker_->Pick(random);
+    // The garbage collection may take the group away in between.
+    if (!GetKey(key_index, retries).Successful() ||
+        !UpdateKey(key_index, retries).Successful()) {
+      failures++;
+    }
+  }
+  ReportCounters(state, retries, failures);
+}
+
+BENCHMARK_DEFINE_F(BudgetKeyProviderFixture, GetBudgetKey)
+
+(benchmark::State& state) {
+  std::mt19937_64 random(state.thread_index());
+  uint64_t retries = 0;
+  uint64_t failures = 0;
+  for (auto _ : state) {
+    if (!GetKey(key_picker_->Pick(random), retries).Successful()) {
+      failures++;
+    }
+  }
+  ReportCounters(state, retries, failures);
+}
+
+// Key distribution, working set size, cache miss percentage and whether the
+// garbage collection runs.
+static void BudgetKeyCacheArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark
+      ->ArgsProduct({{static_cast<int64_t>(KeyDistribution::Uniform),
+                      static_cast<int64_t>(KeyDistribution::Zipfian)},
+                     {1 << 10, 1 << 16},
+                     {0, 1, 10},
+                     {0, 1}})
+      ->Threads(1)
+      ->Threads(4)
+      ->Threads(16)
+      ->UseRealTime();
+}
+
+BENCHMARK_REGISTER_F(BudgetKeyTimeframeManagerFixture, Load)
+    ->Apply(BudgetKeyCacheArguments);
+BENCHMARK_REGISTER_F(BudgetKeyTimeframeManagerFixture, LoadAndUpdate)
+    ->Apply(BudgetKeyCacheArguments);
+BENCHMARK_REGISTER_F(BudgetKeyProviderFixture, GetBudgetKey)
+    ->Apply(BudgetKeyCacheArguments);
+
+}  // namespace google::scp::pbs::test
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <list>
 #include <utility>
@@ -26,6 +27,7 @@
 #include "core/async_executor/src/async_executor.h"
 #include "core/common/concurrent_map/src/error_codes.h"
 #include "core/common/serialization/src/serialization.h"
+#include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/config_provider/mock/mock_config_provider.h"
 #include "core/interface/async_context.h"
@@ -40,6 +42,7 @@
 #include "pbs/budget_key_provider/src/error_codes.h"
 #include "pbs/budget_key_provider/src/proto/budget_key_provider.pb.h"
 #include "pbs/interface/budget_key_interface.h"
+#include "pbs/interface/configuration_keys.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 #include "public/cpio/mock/metric_client/mock_metric_client.h"
 
@@ -58,8 +61,10 @@ using google::scp::core::JournalServiceInterface;
 using google::scp::core::NoSQLDatabaseProviderInterface;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::Timestamp;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::common::Serialization;
+using google::scp::core::common::TimeProvider;
 using google::scp::core::common::Uuid;
 using google::scp::core::config_provider::mock::MockConfigProvider;
 using google::scp::core::journal_service::mock::MockJournalService;
@@ -86,6 +91,8 @@ using std::shared_ptr;
 using std::static_pointer_cast;
 using std::string;
 using std::vector;
+using std::chrono::hours;
+using std::chrono::nanoseconds;
 
 static constexpr Uuid kDefaultUuid = {0, 0};
 
@@ -934,6 +941,7 @@ TEST_F(BudgetKeyProviderTest, Checkpoint) {
       make_shared<BudgetKeyProviderPair>();
   budget_key_provider_pair_1->budget_key = mock_budget_key_1;
   budget_key_provider_pair_1->is_loaded = false;
+  budget_key_provider_pair_1->is_load_logged = true;
   auto budget_key_pair_1 =
       make_pair(*budget_key_name_1, budget_key_provider_pair_1);
   mock_budget_key_provider_->GetBudgetKeys()->Insert(
@@ -954,6 +962,7 @@ TEST_F(BudgetKeyProviderTest, Checkpoint) {
       make_shared<BudgetKeyProviderPair>();
   budget_key_provider_pair_2->budget_key = mock_budget_key_2;
   budget_key_provider_pair_2->is_loaded = false;
+  budget_key_provider_pair_2->is_load_logged = true;
   auto budget_key_pair_2 =
       make_pair(*budget_key_name_2, budget_key_provider_pair_2);
   mock_budget_key_provider_->GetBudgetKeys()->Insert(
@@ -1024,6 +1033,145 @@ TEST_F(BudgetKeyProviderTest, Checkpoint) {
   }
 }
 
+TEST_F(BudgetKeyProviderTest, CheckpointLogsAreShardedByBudgetKey) {
+  vector<string> budget_key_names = {"budget_key_name_1", "budget_key_name_2"};
+  for (const auto& budget_key_name : budget_key_names) {
+    auto mock_budget_key = make_shared<MockBudgetKey>(
+        make_shared<string>(budget_key_name), Uuid::GenerateUuid(),
+        async_executor_, journal_service_, nosql_database_provider_,
+        mock_metric_client_, mock_config_provider_);
+    mock_budget_key->checkpoint_mock =
+        [](shared_ptr<list<CheckpointLog>>& checkpoint_logs) {
+          checkpoint_logs->emplace_back();
+          return SuccessExecutionResult();
+        };
+    auto budget_key_provider_pair = make_shared<BudgetKeyProviderPair>();
+    budget_key_provider_pair->budget_key = mock_budget_key;
+    budget_key_provider_pair->is_load_logged = true;
+    auto budget_key_pair = make_pair(budget_key_name, budget_key_provider_pair);
+    mock_budget_key_provider_->GetBudgetKeys()->Insert(
+        budget_key_pair, budget_key_provider_pair);
+  }
+
+  auto checkpoint_logs = make_shared<list<CheckpointLog>>();
+  EXPECT_SUCCESS(mock_budget_key_provider_->Checkpoint(checkpoint_logs));
+
+  // The load log of each budget key and the logs of the budget key itself
+  // share the shard key of the budget key.
+  ASSERT_EQ(checkpoint_logs->size(), 4);
+  for (const auto& budget_key_name : budget_key_names) {
+    auto shard_key = BudgetKeyProvider::GetCheckpointShardKey(budget_key_name);
+    size_t log_count = 0;
+    for (const auto& checkpoint_log : *checkpoint_logs) {
+      if (checkpoint_log.shard_key == shard_key) {
+        log_count++;
+      }
+    }
+    EXPECT_EQ(log_count, 2);
+  }
+}
+
+TEST_F(BudgetKeyProviderTest, CheckpointSkipsBudgetKeysWhoseLoadIsNotLogged) {
+  bool checkpoint_called = false;
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  auto mock_budget_key = make_shared<MockBudgetKey>(
+      budget_key_name, Uuid::GenerateUuid(), async_executor_, journal_service_,
+      nosql_database_provider_, mock_metric_client_, mock_config_provider_);
+  mock_budget_key->checkpoint_mock = [&](shared_ptr<list<CheckpointLog>>&) {
+    checkpoint_called = true;
+    return SuccessExecutionResult();
+  };
+  auto budget_key_provider_pair = make_shared<BudgetKeyProviderPair>();
+  budget_key_provider_pair->budget_key = mock_budget_key;
+  auto budget_key_pair = make_pair(*budget_key_name, budget_key_provider_pair);
+  mock_budget_key_provider_->GetBudgetKeys()->Insert(budget_key_pair,
+                                                     budget_key_provider_pair);
+
+  // The budget key is in the map before its load is journaled.
+  auto checkpoint_logs = make_shared<list<CheckpointLog>>();
+  EXPECT_SUCCESS(mock_budget_key_provider_->Checkpoint(checkpoint_logs));
+  EXPECT_EQ(checkpoint_logs->size(), 0);
+  EXPECT_FALSE(checkpoint_called);
+
+  budget_key_provider_pair->is_load_logged = true;
+  EXPECT_SUCCESS(mock_budget_key_provider_->Checkpoint(checkpoint_logs));
+  EXPECT_EQ(checkpoint_logs->size(), 1);
+  EXPECT_TRUE(checkpoint_called);
+}
+
+TEST_F(BudgetKeyProviderTest, CheckpointDelta) {
+  auto add_budget_key = [&](const string& name, bool& checkpoint_called) {
+    auto budget_key = make_shared<MockBudgetKey>(
+        make_shared<string>(name), Uuid::GenerateUuid(), async_executor_,
+        journal_service_, nosql_database_provider_, mock_metric_client_,
+        mock_config_provider_);
+    budget_key->checkpoint_mock = [&](shared_ptr<list<CheckpointLog>>&) {
+      checkpoint_called = true;
+      return SuccessExecutionResult();
+    };
+    auto budget_key_provider_pair = make_shared<BudgetKeyProviderPair>();
+    budget_key_provider_pair->budget_key = budget_key;
+    auto budget_key_pair = make_pair(name, budget_key_provider_pair);
+    mock_budget_key_provider_->GetBudgetKeys()->Insert(
+        budget_key_pair, budget_key_provider_pair);
+    return budget_key_provider_pair;
+  };
+
+  // The recovered checkpoint holds the unchanged and the deleted budget keys.
+  bool unchanged_checkpoint_called = false;
+  bool new_checkpoint_called = false;
+  bool deleted_checkpoint_called = false;
+  auto unchanged_budget_key_provider_pair =
+      add_budget_key("unchanged_budget_key", unchanged_checkpoint_called);
+  auto new_budget_key_provider_pair =
+      add_budget_key("new_budget_key", new_checkpoint_called);
+  auto deleted_budget_key_provider_pair =
+      add_budget_key("deleted_budget_key", deleted_checkpoint_called);
+
+  core::JournalRecoveredComponents recovered_components;
+  recovered_components.checkpoint_component_ids.insert(
+      unchanged_budget_key_provider_pair->budget_key->GetId());
+  recovered_components.checkpoint_component_ids.insert(
+      deleted_budget_key_provider_pair->budget_key->GetId());
+
+  BytesBuffer load_bytes_buffer;
+  EXPECT_SUCCESS(mock_budget_key_provider_->SerializeBudgetKeyProviderPair(
+      deleted_budget_key_provider_pair, OperationType::LOAD_INTO_CACHE,
+      load_bytes_buffer));
+  auto delete_bytes_buffer = make_shared<BytesBuffer>();
+  EXPECT_SUCCESS(mock_budget_key_provider_->SerializeBudgetKeyProviderPair(
+      deleted_budget_key_provider_pair, OperationType::DELETE_FROM_CACHE,
+      *delete_bytes_buffer));
+  EXPECT_SUCCESS(mock_budget_key_provider_->OnJournalServiceRecoverCallback(
+      delete_bytes_buffer, kDefaultUuid));
+
+  auto checkpoint_logs = make_shared<list<CheckpointLog>>();
+  EXPECT_SUCCESS(mock_budget_key_provider_->CheckpointDelta(
+      recovered_components, checkpoint_logs));
+
+  EXPECT_FALSE(unchanged_checkpoint_called);
+  EXPECT_TRUE(new_checkpoint_called);
+  ASSERT_EQ(checkpoint_logs->size(), 2);
+
+  // Replaying the delta over the recovered checkpoint deletes the deleted
+  // budget key and loads the new one.
+  auto recovery_budget_key_provider = make_shared<MockBudgetKeyProvider>(
+      async_executor_, journal_service_, nosql_database_provider_,
+      mock_metric_client_, mock_config_provider_);
+  EXPECT_SUCCESS(recovery_budget_key_provider->OnJournalServiceRecoverCallback(
+      make_shared<BytesBuffer>(load_bytes_buffer), kDefaultUuid));
+  for (const auto& checkpoint_log : *checkpoint_logs) {
+    EXPECT_SUCCESS(
+        recovery_budget_key_provider->OnJournalServiceRecoverCallback(
+            make_shared<BytesBuffer>(checkpoint_log.bytes_buffer),
+            kDefaultUuid));
+  }
+
+  vector<string> budget_keys;
+  recovery_budget_key_provider->GetBudgetKeys()->Keys(budget_keys);
+  EXPECT_EQ(budget_keys, vector<string>({"new_budget_key"}));
+}
+
 TEST_F(BudgetKeyProviderTest, CheckpointFailureOnBudgetKeyCheckpoint) {
   shared_ptr<BudgetKeyProviderPair> budget_key_provider_pair =
       make_shared<BudgetKeyProviderPair>();
@@ -1046,6 +1194,7 @@ TEST_F(BudgetKeyProviderTest, CheckpointFailureOnBudgetKeyCheckpoint) {
       make_shared<BudgetKeyProviderPair>();
   budget_key_provider_pair_1->budget_key = mock_budget_key_1;
   budget_key_provider_pair_1->is_loaded = false;
+  budget_key_provider_pair_1->is_load_logged = true;
   auto budget_key_pair_1 =
       make_pair(*budget_key_name_1, budget_key_provider_pair_1);
   mock_budget_key_provider_->GetBudgetKeys()->Insert(
@@ -1103,4 +1252,80 @@ TEST_F(BudgetKeyProviderTest, StopShouldSucceedIfCanStopBudgetKey) {
   EXPECT_SUCCESS(budget_key_provider->Run());
   EXPECT_SUCCESS(budget_key_provider->Stop());
 }
+TEST_F(BudgetKeyProviderTest, PrefetchesTheNextDayOfCachedBudgetKeys) {
+  mock_config_provider_->SetInt(kBudgetKeyNextDayPrefetchLeadTimeInSeconds,
+                                3600);
+  mock_config_provider_->SetInt(kBudgetKeyNextDayPrefetchMaxLoadsPerSecond, 1);
+
+  vector<TimeBucket> prefetched_time_buckets;
+  for (auto name : {"budget_key_1", "budget_key_2"}) {
+    auto budget_key_name = make_shared<BudgetKeyName>(name);
+    auto mock_budget_key = make_shared<MockBudgetKey>(
+        budget_key_name, Uuid::GenerateUuid(), async_executor_,
+        journal_service_, nosql_database_provider_, mock_metric_client_,
+        mock_config_provider_);
+    mock_budget_key->get_budget_mock =
+        [&](AsyncContext<GetBudgetRequest, GetBudgetResponse>&
+                get_budget_context) {
+          prefetched_time_buckets.push_back(
+              get_budget_context.request->time_bucket);
+          return SuccessExecutionResult();
+        };
+    auto budget_key_provider_pair = make_shared<BudgetKeyProviderPair>();
+    budget_key_provider_pair->budget_key = mock_budget_key;
+    auto budget_key_pair =
+        make_pair(*budget_key_name, budget_key_provider_pair);
+    mock_budget_key_provider_->GetBudgetKeys()->Insert(
+        budget_key_pair, budget_key_provider_pair);
+  }
+
+  vector<AsyncOperation> scheduled_works;
+  vector<Timestamp> scheduled_timestamps;
+  mock_async_executor_->schedule_for_mock =
+      [&](const AsyncOperation& work, Timestamp timestamp,
+          function<bool()>& cancellation_callback) {
+        cancellation_callback = []() { return true; };
+        scheduled_works.push_back(work);
+        scheduled_timestamps.push_back(timestamp);
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_SUCCESS(mock_budget_key_provider_->Init());
+  auto steady_now =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  EXPECT_SUCCESS(mock_budget_key_provider_->Run());
+
+  // The prefetch starts within a day, and the garbage collection is scheduled
+  // after it.
+  ASSERT_EQ(scheduled_works.size(), 2);
+  EXPECT_LE(scheduled_timestamps[0] - steady_now,
+            nanoseconds(hours(24)).count());
+
+  // One budget key is prefetched per round.
+  auto prefetch = scheduled_works[0];
+  prefetch();
+  ASSERT_EQ(prefetched_time_buckets.size(), 1);
+  auto day_start = prefetched_time_buckets[0];
+  EXPECT_EQ(day_start % nanoseconds(hours(24)).count(), 0);
+  EXPECT_GT(day_start,
+            TimeProvider::GetWallTimestampInNanosecondsAsClockTicks());
+  ASSERT_EQ(scheduled_works.size(), 3);
+
+  auto next_round = scheduled_works[2];
+  next_round();
+  ASSERT_EQ(prefetched_time_buckets.size(), 2);
+  EXPECT_EQ(prefetched_time_buckets[1], day_start);
+
+  // Then the prefetch of the following day is scheduled.
+  ASSERT_EQ(scheduled_works.size(), 4);
+  EXPECT_GT(scheduled_timestamps[3] - steady_now,
+            nanoseconds(hours(22)).count());
+
+  EXPECT_SUCCESS(mock_budget_key_provider_->Stop());
+
+  // Nothing is prefetched once stopped.
+  auto following_day_prefetch = scheduled_works[3];
+  following_day_prefetch();
+  EXPECT_EQ(prefetched_time_buckets.size(), 2);
+}
 }  // namespace google::scp::pbs::test
@@ -68,6 +68,20 @@ class MockBudgetKeyTimeframeManager
     return update_function(update_budget_key_timeframe_context);
   }
 
+  core::ExecutionResult Reserve(
+      core::AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                         ReserveBudgetKeyTimeframeResponse>&
+          reserve_budget_key_timeframe_context) noexcept override {
+    return reserve_function(reserve_budget_key_timeframe_context);
+  }
+
+  core::ExecutionResult Release(
+      core::AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                         ReleaseBudgetKeyTimeframeResponse>&
+          release_budget_key_timeframe_context) noexcept override {
+    return release_function(release_budget_key_timeframe_context);
+  }
+
   const core::common::Uuid GetId() noexcept { return id; }
 
   core::ExecutionResult Checkpoint(
@@ -91,6 +105,16 @@ class MockBudgetKeyTimeframeManager
                          UpdateBudgetKeyTimeframeResponse>&)>
       update_function;
 
+  std::function<core::ExecutionResult(
+      core::AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                         ReserveBudgetKeyTimeframeResponse>&)>
+      reserve_function;
+
+  std::function<core::ExecutionResult(
+      core::AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                         ReleaseBudgetKeyTimeframeResponse>&)>
+      release_function;
+
   std::function<core::ExecutionResult(
       std::shared_ptr<std::list<core::CheckpointLog>>&)>
       checkpoint_mock;
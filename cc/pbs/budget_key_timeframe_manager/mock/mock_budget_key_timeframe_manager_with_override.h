@@ -155,6 +155,13 @@ class MockBudgetKeyTimeframeManager : public BudgetKeyTimeframeManager {
         should_delete_entry);
   }
 
+  static core::ExecutionResult MaterializeTimeframeGroup(
+      const std::shared_ptr<BudgetKeyTimeframeGroup>&
+          budget_key_timeframe_group) noexcept {
+    return BudgetKeyTimeframeManager::MaterializeTimeframeGroup(
+        budget_key_timeframe_group);
+  }
+
   auto& GetBudgetTimeframeGroups() { return budget_key_timeframe_groups_; }
 
   auto* GetInternalBudgetTimeframeGroups() {
@@ -22,6 +22,9 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <variant>
@@ -65,6 +68,7 @@ using google::scp::core::UpsertDatabaseItemRequest;
 using google::scp::core::UpsertDatabaseItemResponse;
 using google::scp::core::Version;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
 using google::scp::core::common::Uuid;
 using google::scp::pbs::budget_key_timeframe_manager::Serialization;
 using google::scp::pbs::budget_key_timeframe_manager::Utils;
@@ -80,12 +84,19 @@ using google::scp::pbs::budget_key_timeframe_manager::proto::OperationType;
 using std::function;
 using std::get;
 using std::list;
+using std::lock_guard;
 using std::make_shared;
 using std::move;
+using std::mutex;
 using std::shared_ptr;
+using std::pair;
 using std::string;
+using std::unordered_map;
 using std::unordered_set;
 using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
 using std::placeholders::_1;
 using std::placeholders::_2;
 
@@ -151,7 +162,35 @@ ExecutionResult BudgetKeyTimeframeManager::Init() noexcept {
   }
   MetricInit();
 
-  return journal_service_->SubscribeForRecovery(
+  if (!config_provider_
+           ->Get(kBudgetKeyTimeframeManagerLazyRecoveryEnabled,
+                 lazy_recovery_enabled_)
+           .Successful()) {
+    lazy_recovery_enabled_ = false;
+  }
+
+  if (!config_provider_
+           ->Get(kBudgetKeyTimeframeManagerLoadCoalescingEnabled,
+                 load_coalescing_enabled_)
+           .Successful()) {
+    load_coalescing_enabled_ = false;
+  }
+
+  size_t record_not_found_cache_ttl_in_milliseconds = 0;
+  if (!config_provider_
+           ->Get(kBudgetKeyTimeframeManagerRecordNotFoundCacheTtlInMilliseconds,
+                 record_not_found_cache_ttl_in_milliseconds)
+           .Successful()) {
+    record_not_found_cache_ttl_in_milliseconds = 0;
+  }
+  record_not_found_cache_ttl_in_nanoseconds_ =
+      duration_cast<nanoseconds>(
+          milliseconds(record_not_found_cache_ttl_in_milliseconds))
+          .count();
+
+  // The recovery logs only touch the timeframe groups of this manager, so they
+  // can be applied concurrently with the logs of the other managers.
+  return journal_service_->SubscribeForParallelRecovery(
       id_, bind(&BudgetKeyTimeframeManager::OnJournalServiceRecoverCallback,
                 this, _1, _2));
 }
@@ -171,6 +210,32 @@ BudgetKeyTimeframeManager::~BudgetKeyTimeframeManager() {
   }
 }
 
+ExecutionResult BudgetKeyTimeframeManager::MaterializeTimeframeGroup(
+    const shared_ptr<BudgetKeyTimeframeGroup>&
+        budget_key_timeframe_group) noexcept {
+  if (!budget_key_timeframe_group->has_serialized_timeframes.load()) {
+    return SuccessExecutionResult();
+  }
+
+  lock_guard<mutex> lock(
+      budget_key_timeframe_group->serialized_timeframes_mutex);
+  if (!budget_key_timeframe_group->serialized_timeframes) {
+    return SuccessExecutionResult();
+  }
+
+  auto execution_result =
+      Serialization::DeserializeBudgetKeyTimeframeGroupLog_1_0(
+          *budget_key_timeframe_group->serialized_timeframes,
+          *budget_key_timeframe_group);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  budget_key_timeframe_group->serialized_timeframes = nullptr;
+  budget_key_timeframe_group->has_serialized_timeframes = false;
+  return SuccessExecutionResult();
+}
+
 void BudgetKeyTimeframeManager::OnBeforeGarbageCollection(
     TimeGroup& time_group,
     shared_ptr<BudgetKeyTimeframeGroup>& budget_key_timeframe_group,
@@ -180,9 +245,15 @@ void BudgetKeyTimeframeManager::OnBeforeGarbageCollection(
       "Unloading budget key timeframe for budget key %s with time_group %llu",
       budget_key_name_->c_str(), time_group);
 
+  auto execution_result = MaterializeTimeframeGroup(budget_key_timeframe_group);
+  if (!execution_result.Successful()) {
+    should_delete_entry(false);
+    return;
+  }
+
   // Check to see if there is any active transaction id.
   vector<TimeBucket> time_buckets;
-  auto execution_result =
+  execution_result =
       budget_key_timeframe_group->budget_key_timeframes.Keys(time_buckets);
   if (!execution_result.Successful()) {
     should_delete_entry(false);
@@ -197,7 +268,8 @@ void BudgetKeyTimeframeManager::OnBeforeGarbageCollection(
       should_delete_entry(false);
       return;
     }
-    if (budget_key_timeframe->active_transaction_id.load() != kZeroUuid) {
+    if (budget_key_timeframe->active_transaction_id.load() != kZeroUuid ||
+        budget_key_timeframe->reserving_transaction_count.load() != 0) {
       should_delete_entry(false);
       return;
     }
@@ -390,6 +462,8 @@ BudgetKeyTimeframeManager::PopulateLoadBudgetKeyTimeframeResponse(
         load_budget_key_timeframe_request,
     shared_ptr<LoadBudgetKeyTimeframeResponse>&
         load_budget_key_timeframe_response) {
+  RETURN_IF_FAILURE(MaterializeTimeframeGroup(budget_key_timeframe_group));
+
   vector<shared_ptr<BudgetKeyTimeframe>> budget_key_timeframes;
   for (const auto& reporting_time :
        load_budget_key_timeframe_request->reporting_times) {
@@ -423,7 +497,8 @@ ExecutionResult BudgetKeyTimeframeManager::Load(
   // thread will wait on the result. In this case a concurrent map is used. If
   // any thread successfully inserts an entry into the cache it will be the
   // only one which goes to the database. The rest of the threads will retry
-  // until the entry is loaded.
+  // until the entry is loaded, or wait for the load in flight to complete if
+  // load coalescing is enabled.
 
   if (load_budget_key_timeframe_context.request->reporting_times.empty()) {
     return FailureExecutionResult(
@@ -486,8 +561,16 @@ ExecutionResult BudgetKeyTimeframeManager::Load(
 
     if (!should_load) {
       if (!budget_key_timeframe_group->is_loaded) {
-        return RetryExecutionResult(
-            core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_ENTRY_IS_LOADING);
+        if (load_coalescing_enabled_ &&
+            AddPendingLoad(budget_key_timeframe_group,
+                           load_budget_key_timeframe_context)) {
+          return SuccessExecutionResult();
+        }
+
+        if (!budget_key_timeframe_group->is_loaded) {
+          return RetryExecutionResult(
+              core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_ENTRY_IS_LOADING);
+        }
       }
 
       execution_result = PopulateLoadBudgetKeyTimeframeResponse(
@@ -509,14 +592,102 @@ ExecutionResult BudgetKeyTimeframeManager::Load(
     return RetryExecutionResult(execution_result.status_code);
   }
 
-  return LoadTimeframeGroupFromDB(load_budget_key_timeframe_context,
-                                  budget_key_timeframe_group);
+  if (!load_coalescing_enabled_) {
+    return LoadTimeframeGroupFromDB(load_budget_key_timeframe_context,
+                                    budget_key_timeframe_group);
+  }
+
+  // The loads queued while this one is in flight are completed along with it.
+  AsyncContext<LoadBudgetKeyTimeframeRequest, LoadBudgetKeyTimeframeResponse>
+      loader_context = load_budget_key_timeframe_context;
+  loader_context.callback =
+      [this, budget_key_timeframe_group,
+       callback = load_budget_key_timeframe_context.callback](
+          AsyncContext<LoadBudgetKeyTimeframeRequest,
+                       LoadBudgetKeyTimeframeResponse>&
+              loader_context) mutable {
+        if (callback) {
+          callback(loader_context);
+        }
+        CompletePendingLoads(budget_key_timeframe_group, loader_context.result);
+      };
+
+  execution_result =
+      LoadTimeframeGroupFromDB(loader_context, budget_key_timeframe_group);
+  if (!execution_result.Successful()) {
+    budget_key_timeframe_group->needs_loader = true;
+    CompletePendingLoads(budget_key_timeframe_group, execution_result);
+  }
+  return execution_result;
+}
+
+bool BudgetKeyTimeframeManager::AddPendingLoad(
+    const shared_ptr<BudgetKeyTimeframeGroup>& budget_key_timeframe_group,
+    AsyncContext<LoadBudgetKeyTimeframeRequest, LoadBudgetKeyTimeframeResponse>&
+        load_budget_key_timeframe_context) noexcept {
+  // The loader sets is_loaded or needs_loader before completing the queued
+  // loads under the same lock, so no load is queued after they are completed.
+  lock_guard<mutex> lock(
+      budget_key_timeframe_group->pending_load_contexts_mutex);
+  if (budget_key_timeframe_group->is_loaded ||
+      budget_key_timeframe_group->needs_loader) {
+    return false;
+  }
+
+  budget_key_timeframe_group->pending_load_contexts.push_back(
+      load_budget_key_timeframe_context);
+  return true;
+}
+
+void BudgetKeyTimeframeManager::CompletePendingLoads(
+    const shared_ptr<BudgetKeyTimeframeGroup>& budget_key_timeframe_group,
+    const ExecutionResult& execution_result) noexcept {
+  vector<AsyncContext<LoadBudgetKeyTimeframeRequest,
+                      LoadBudgetKeyTimeframeResponse>>
+      pending_load_contexts;
+  {
+    lock_guard<mutex> lock(
+        budget_key_timeframe_group->pending_load_contexts_mutex);
+    pending_load_contexts.swap(
+        budget_key_timeframe_group->pending_load_contexts);
+  }
+
+  for (auto& pending_load_context : pending_load_contexts) {
+    if (execution_result.Successful() &&
+        budget_key_timeframe_group->is_loaded) {
+      pending_load_context.result = PopulateLoadBudgetKeyTimeframeResponse(
+          budget_key_timeframe_group, pending_load_context.request,
+          pending_load_context.response);
+    } else {
+      // The waiting loads retry as they would have without waiting, and one
+      // of them becomes the next loader.
+      pending_load_context.result = RetryExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_ENTRY_IS_LOADING);
+    }
+    pending_load_context.Finish();
+  }
 }
 
 ExecutionResult BudgetKeyTimeframeManager::LoadTimeframeGroupFromDB(
     AsyncContext<LoadBudgetKeyTimeframeRequest, LoadBudgetKeyTimeframeResponse>&
         load_budget_key_timeframe_context,
     shared_ptr<BudgetKeyTimeframeGroup>& budget_key_timeframe_group) noexcept {
+  if (record_not_found_cache_ttl_in_nanoseconds_ > 0 &&
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() <
+          budget_key_timeframe_group->record_not_found_expiry) {
+    // The group was just found missing from the database, and nothing else
+    // writes it while it is loaded here, so the lookup is not repeated.
+    AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>
+        get_database_item_context(make_shared<GetDatabaseItemRequest>(),
+                                  nullptr, load_budget_key_timeframe_context);
+    get_database_item_context.result = FailureExecutionResult(
+        core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
+    OnLoadTimeframeGroupFromDBCallback(load_budget_key_timeframe_context,
+                                       budget_key_timeframe_group,
+                                       get_database_item_context);
+    return SuccessExecutionResult();
+  }
+
   auto time_frame_manager_id_str = core::common::ToString(id_);
   SCP_DEBUG_CONTEXT(
       kBudgetKeyTimeframeManager, load_budget_key_timeframe_context,
@@ -607,6 +778,12 @@ void BudgetKeyTimeframeManager::OnLoadTimeframeGroupFromDBCallback(
   vector<TokenCount> tokens_per_hour;
   if (get_database_item_context.result.status_code ==
       core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND) {
+    auto now = TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+    if (record_not_found_cache_ttl_in_nanoseconds_ > 0 &&
+        now >= budget_key_timeframe_group->record_not_found_expiry) {
+      budget_key_timeframe_group->record_not_found_expiry =
+          now + record_not_found_cache_ttl_in_nanoseconds_;
+    }
     tokens_per_hour = vector<TokenCount>(
         budget_key_timeframe_manager::kHoursPerDay, kMaxToken);
   } else {
@@ -784,6 +961,7 @@ ExecutionResult BudgetKeyTimeframeManager::Update(
   if (!execution_result.Successful()) {
     return execution_result;
   }
+  RETURN_IF_FAILURE(MaterializeTimeframeGroup(budget_key_timeframe_group));
 
   vector<shared_ptr<BudgetKeyTimeframe>> original_budget_key_timeframes;
   vector<shared_ptr<BudgetKeyTimeframe>> budget_key_timeframes_to_journal;
@@ -913,6 +1091,451 @@ void BudgetKeyTimeframeManager::OnLogUpdateCallback(
   update_budget_key_timeframe_context.Finish();
 }
 
+void BudgetKeyTimeframeManager::ReleaseReservedTokens(
+    const TokenReservation& token_reservation, size_t count,
+    bool return_tokens) noexcept {
+  for (size_t i = 0; i < count; i++) {
+    const auto& [budget_key_timeframe, token_count] =
+        token_reservation.reserved_tokens[i];
+    if (return_tokens) {
+      budget_key_timeframe->token_count.fetch_add(token_count);
+    }
+    budget_key_timeframe->reserving_transaction_count.fetch_sub(1);
+  }
+}
+
+ExecutionResult BudgetKeyTimeframeManager::SerializeTokenReservationLog(
+    const TokenReservation& token_reservation, OperationType operation_type,
+    bool return_tokens, BytesBuffer& bytes_buffer) noexcept {
+  vector<pair<TimeBucket, TokenCount>> reserved_tokens;
+  if (operation_type == OperationType::RESERVE_TIMEFRAME_TOKENS) {
+    reserved_tokens.reserve(token_reservation.reserved_tokens.size());
+    for (const auto& [budget_key_timeframe, token_count] :
+         token_reservation.reserved_tokens) {
+      reserved_tokens.emplace_back(budget_key_timeframe->time_bucket_index,
+                                   token_count);
+    }
+  }
+  return Serialization::SerializeBudgetKeyTimeframeReservationLog(
+      token_reservation.time_group, operation_type,
+      token_reservation.transaction_id, reserved_tokens, return_tokens,
+      bytes_buffer);
+}
+
+ExecutionResult BudgetKeyTimeframeManager::Reserve(
+    AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                 ReserveBudgetKeyTimeframeResponse>&
+        reserve_budget_key_timeframe_context) noexcept {
+  const auto& timeframes_to_reserve =
+      reserve_budget_key_timeframe_context.request->timeframes_to_reserve;
+  if (timeframes_to_reserve.empty()) {
+    return FailureExecutionResult(
+        core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_EMPTY_REQUEST);
+  }
+
+  if (reserve_budget_key_timeframe_context.request->transaction_id ==
+      kZeroUuid) {
+    return FailureExecutionResult(
+        core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_TRANSACTION_ID);
+  }
+
+  std::vector<TimeBucket> reporting_times;
+  for (const auto& timeframe : timeframes_to_reserve) {
+    reporting_times.push_back(timeframe.reporting_time);
+  }
+
+  if (Utils::GetUniqueTimeGroups(reporting_times).size() != 1) {
+    return FailureExecutionResult(
+        core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_MULTIPLE_TIMEFRAME_GROUPS);
+  }
+
+  if (Utils::GetUniqueTimeBuckets(reporting_times).size() !=
+      timeframes_to_reserve.size()) {
+    return FailureExecutionResult(
+        core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_REPEATED_TIMEBUCKETS);
+  }
+
+  TimeGroup time_group = Utils::GetTimeGroup(reporting_times.front());
+  shared_ptr<BudgetKeyTimeframeGroup> budget_key_timeframe_group;
+  auto execution_result = budget_key_timeframe_groups_->Find(
+      time_group, budget_key_timeframe_group);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  RETURN_IF_FAILURE(MaterializeTimeframeGroup(budget_key_timeframe_group));
+
+  auto token_reservation = make_shared<TokenReservation>();
+  token_reservation->transaction_id =
+      reserve_budget_key_timeframe_context.request->transaction_id;
+  token_reservation->time_group = time_group;
+  for (const auto& timeframe_to_reserve : timeframes_to_reserve) {
+    shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
+    execution_result = budget_key_timeframe_group->budget_key_timeframes.Find(
+        Utils::GetTimeBucket(timeframe_to_reserve.reporting_time),
+        budget_key_timeframe);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    token_reservation->reserved_tokens.emplace_back(
+        move(budget_key_timeframe), timeframe_to_reserve.token_count);
+  }
+
+  reserve_budget_key_timeframe_context.response =
+      make_shared<ReserveBudgetKeyTimeframeResponse>();
+
+  auto token_reservation_pair =
+      make_pair(token_reservation->transaction_id, token_reservation);
+  shared_ptr<TokenReservation> existing_token_reservation;
+  execution_result = token_reservations_.Insert(token_reservation_pair,
+                                                existing_token_reservation);
+  if (!execution_result.Successful()) {
+    if (execution_result.status_code !=
+        core::errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS) {
+      return execution_result;
+    }
+    // This is a retry. It is done once the previous attempt is journaled.
+    if (existing_token_reservation->state.load() ==
+        TokenReservationState::Logging) {
+      reserve_budget_key_timeframe_context.response->status =
+          BudgetKeyTimeframeReservationStatus::Conflict;
+    }
+    reserve_budget_key_timeframe_context.result = SuccessExecutionResult();
+    reserve_budget_key_timeframe_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  // A timeframe is counted as reserved before its active transaction id is
+  // checked, and a transaction setting the active transaction id checks the
+  // count after setting it, so that at most one of them goes through.
+  // Tokens are only taken off the timeframes before the first one that does
+  // not have enough, the remaining ones are only checked to be reported.
+  size_t reserved_count = 0;
+  bool has_insufficient_budget = false;
+  auto& response = *reserve_budget_key_timeframe_context.response;
+  for (size_t i = 0; i < token_reservation->reserved_tokens.size(); i++) {
+    const auto& [budget_key_timeframe, token_count] =
+        token_reservation->reserved_tokens[i];
+    if (has_insufficient_budget) {
+      if (budget_key_timeframe->token_count.load() < token_count) {
+        response.insufficient_budget_indices.push_back(i);
+      }
+      continue;
+    }
+
+    budget_key_timeframe->reserving_transaction_count.fetch_add(1);
+    if (budget_key_timeframe->active_transaction_id.load() != kZeroUuid) {
+      budget_key_timeframe->reserving_transaction_count.fetch_sub(1);
+      response.status = BudgetKeyTimeframeReservationStatus::Conflict;
+      break;
+    }
+
+    auto available_token_count = budget_key_timeframe->token_count.load();
+    while (available_token_count >= token_count &&
+           !budget_key_timeframe->token_count.compare_exchange_weak(
+               available_token_count, available_token_count - token_count)) {}
+
+    if (available_token_count < token_count) {
+      budget_key_timeframe->reserving_transaction_count.fetch_sub(1);
+      has_insufficient_budget = true;
+      response.insufficient_budget_indices.push_back(i);
+      continue;
+    }
+    reserved_count++;
+  }
+
+  if (response.status == BudgetKeyTimeframeReservationStatus::Conflict ||
+      has_insufficient_budget) {
+    if (has_insufficient_budget) {
+      response.status = BudgetKeyTimeframeReservationStatus::InsufficientBudget;
+    }
+    ReleaseReservedTokens(*token_reservation, reserved_count,
+                          true /* return_tokens */);
+    token_reservations_.Erase(token_reservation->transaction_id);
+    reserve_budget_key_timeframe_context.result = SuccessExecutionResult();
+    reserve_budget_key_timeframe_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  BytesBuffer budget_key_timeframe_manager_log_bytes_buffer;
+  execution_result = SerializeTokenReservationLog(
+      *token_reservation, OperationType::RESERVE_TIMEFRAME_TOKENS,
+      false /* return_tokens */, budget_key_timeframe_manager_log_bytes_buffer);
+  if (execution_result.Successful()) {
+    execution_result =
+        budget_key_timeframe_groups_->DisableEviction(time_group);
+  }
+  if (!execution_result.Successful()) {
+    ReleaseReservedTokens(*token_reservation, reserved_count,
+                          true /* return_tokens */);
+    token_reservations_.Erase(token_reservation->transaction_id);
+    return execution_result;
+  }
+
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.parent_activity_id =
+      reserve_budget_key_timeframe_context.activity_id;
+  journal_log_context.correlation_id =
+      reserve_budget_key_timeframe_context.correlation_id;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->component_id = id_;
+  journal_log_context.request->log_id = Uuid::GenerateUuid();
+  journal_log_context.request->log_status = JournalLogStatus::Log;
+  journal_log_context.request->data = make_shared<BytesBuffer>(
+      move(budget_key_timeframe_manager_log_bytes_buffer));
+  journal_log_context.callback =
+      bind(&BudgetKeyTimeframeManager::OnLogReserveCallback, this,
+           reserve_budget_key_timeframe_context, token_reservation, _1);
+
+  operation_dispatcher_
+      .Dispatch<AsyncContext<JournalLogRequest, JournalLogResponse>>(
+          journal_log_context,
+          [journal_service = journal_service_](
+              AsyncContext<JournalLogRequest, JournalLogResponse>&
+                  journal_log_context) {
+            return journal_service->Log(journal_log_context);
+          });
+
+  return SuccessExecutionResult();
+}
+
+void BudgetKeyTimeframeManager::OnLogReserveCallback(
+    AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                 ReserveBudgetKeyTimeframeResponse>&
+        reserve_budget_key_timeframe_context,
+    shared_ptr<TokenReservation>& token_reservation,
+    AsyncContext<JournalLogRequest, JournalLogResponse>&
+        journal_log_context) noexcept {
+  auto execution_result =
+      budget_key_timeframe_groups_->EnableEviction(
+          token_reservation->time_group);
+  if (!execution_result.Successful()) {
+    SCP_ERROR_CONTEXT(kBudgetKeyTimeframeManager,
+                      reserve_budget_key_timeframe_context, execution_result,
+                      "Cache eviction failed for %s time group %d",
+                      budget_key_name_->c_str(), token_reservation->time_group);
+  }
+
+  if (!journal_log_context.result.Successful()) {
+    ReleaseReservedTokens(*token_reservation,
+                          token_reservation->reserved_tokens.size(),
+                          true /* return_tokens */);
+    token_reservations_.Erase(token_reservation->transaction_id);
+    reserve_budget_key_timeframe_context.result = journal_log_context.result;
+    reserve_budget_key_timeframe_context.Finish();
+    return;
+  }
+
+  token_reservation->state = TokenReservationState::Logged;
+  reserve_budget_key_timeframe_context.result = SuccessExecutionResult();
+  reserve_budget_key_timeframe_context.Finish();
+}
+
+ExecutionResult BudgetKeyTimeframeManager::Release(
+    AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                 ReleaseBudgetKeyTimeframeResponse>&
+        release_budget_key_timeframe_context) noexcept {
+  if (release_budget_key_timeframe_context.request->transaction_id ==
+      kZeroUuid) {
+    return FailureExecutionResult(
+        core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_TRANSACTION_ID);
+  }
+
+  release_budget_key_timeframe_context.response =
+      make_shared<ReleaseBudgetKeyTimeframeResponse>();
+
+  shared_ptr<TokenReservation> token_reservation;
+  auto execution_result = token_reservations_.Find(
+      release_budget_key_timeframe_context.request->transaction_id,
+      token_reservation);
+  if (!execution_result.Successful()) {
+    if (execution_result.status_code !=
+        core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST) {
+      return execution_result;
+    }
+    // Nothing is reserved, or this is a retry of a completed release.
+    release_budget_key_timeframe_context.result = SuccessExecutionResult();
+    release_budget_key_timeframe_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  auto logged_state = TokenReservationState::Logged;
+  if (!token_reservation->state.compare_exchange_strong(
+          logged_state, TokenReservationState::Releasing)) {
+    release_budget_key_timeframe_context.response->status =
+        BudgetKeyTimeframeReservationStatus::Conflict;
+    release_budget_key_timeframe_context.result = SuccessExecutionResult();
+    release_budget_key_timeframe_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  BytesBuffer budget_key_timeframe_manager_log_bytes_buffer;
+  execution_result = SerializeTokenReservationLog(
+      *token_reservation, OperationType::RELEASE_TIMEFRAME_TOKENS,
+      release_budget_key_timeframe_context.request->return_tokens,
+      budget_key_timeframe_manager_log_bytes_buffer);
+  if (execution_result.Successful()) {
+    execution_result = budget_key_timeframe_groups_->DisableEviction(
+        token_reservation->time_group);
+  }
+  if (!execution_result.Successful()) {
+    token_reservation->state = TokenReservationState::Logged;
+    return execution_result;
+  }
+
+  AsyncContext<JournalLogRequest, JournalLogResponse> journal_log_context;
+  journal_log_context.parent_activity_id =
+      release_budget_key_timeframe_context.activity_id;
+  journal_log_context.correlation_id =
+      release_budget_key_timeframe_context.correlation_id;
+  journal_log_context.request = make_shared<JournalLogRequest>();
+  journal_log_context.request->component_id = id_;
+  journal_log_context.request->log_id = Uuid::GenerateUuid();
+  journal_log_context.request->log_status = JournalLogStatus::Log;
+  journal_log_context.request->data = make_shared<BytesBuffer>(
+      move(budget_key_timeframe_manager_log_bytes_buffer));
+  journal_log_context.callback =
+      bind(&BudgetKeyTimeframeManager::OnLogReleaseCallback, this,
+           release_budget_key_timeframe_context, token_reservation, _1);
+
+  operation_dispatcher_
+      .Dispatch<AsyncContext<JournalLogRequest, JournalLogResponse>>(
+          journal_log_context,
+          [journal_service = journal_service_](
+              AsyncContext<JournalLogRequest, JournalLogResponse>&
+                  journal_log_context) {
+            return journal_service->Log(journal_log_context);
+          });
+
+  return SuccessExecutionResult();
+}
+
+void BudgetKeyTimeframeManager::OnLogReleaseCallback(
+    AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                 ReleaseBudgetKeyTimeframeResponse>&
+        release_budget_key_timeframe_context,
+    shared_ptr<TokenReservation>& token_reservation,
+    AsyncContext<JournalLogRequest, JournalLogResponse>&
+        journal_log_context) noexcept {
+  auto execution_result =
+      budget_key_timeframe_groups_->EnableEviction(
+          token_reservation->time_group);
+  if (!execution_result.Successful()) {
+    SCP_ERROR_CONTEXT(kBudgetKeyTimeframeManager,
+                      release_budget_key_timeframe_context, execution_result,
+                      "Cache eviction failed for %s time group %d",
+                      budget_key_name_->c_str(), token_reservation->time_group);
+  }
+
+  if (!journal_log_context.result.Successful()) {
+    token_reservation->state = TokenReservationState::Logged;
+    release_budget_key_timeframe_context.result = journal_log_context.result;
+    release_budget_key_timeframe_context.Finish();
+    return;
+  }
+
+  // The reservation is erased before the timeframes stop counting it, so
+  // that a timeframe can only be held through its active transaction id once
+  // no reservation of it is left.
+  token_reservations_.Erase(token_reservation->transaction_id);
+  ReleaseReservedTokens(
+      *token_reservation, token_reservation->reserved_tokens.size(),
+      release_budget_key_timeframe_context.request->return_tokens);
+
+  release_budget_key_timeframe_context.result = SuccessExecutionResult();
+  release_budget_key_timeframe_context.Finish();
+}
+
+ExecutionResult BudgetKeyTimeframeManager::RecoverTokenReservationLog(
+    const BudgetKeyTimeframeManagerLog_1_0&
+        budget_key_time_frame_manager_log_1_0) noexcept {
+  Uuid transaction_id;
+  vector<pair<TimeBucket, TokenCount>> reserved_tokens;
+  bool return_tokens = false;
+  auto execution_result =
+      Serialization::DeserializeBudgetKeyTimeframeReservationLog_1_0(
+          budget_key_time_frame_manager_log_1_0.log_body(), transaction_id,
+          reserved_tokens, return_tokens);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  if (budget_key_time_frame_manager_log_1_0.operation_type() ==
+      OperationType::RELEASE_TIMEFRAME_TOKENS) {
+    shared_ptr<TokenReservation> token_reservation;
+    execution_result =
+        token_reservations_.Find(transaction_id, token_reservation);
+    if (!execution_result.Successful()) {
+      if (execution_result.status_code !=
+          core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST) {
+        return execution_result;
+      }
+      // The reservation was released before the checkpoint.
+      return SuccessExecutionResult();
+    }
+
+    token_reservations_.Erase(transaction_id);
+    ReleaseReservedTokens(*token_reservation,
+                          token_reservation->reserved_tokens.size(),
+                          return_tokens);
+    return SuccessExecutionResult();
+  }
+
+  if (reserved_tokens.empty()) {
+    return FailureExecutionResult(
+        core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_CORRUPTED_KEY_METADATA);
+  }
+
+  // The reservation is already in the checkpoint.
+  shared_ptr<TokenReservation> existing_token_reservation;
+  if (token_reservations_.Find(transaction_id, existing_token_reservation)
+          .Successful()) {
+    return SuccessExecutionResult();
+  }
+
+  shared_ptr<BudgetKeyTimeframeGroup> budget_key_timeframe_group;
+  execution_result = budget_key_timeframe_groups_->Find(
+      budget_key_time_frame_manager_log_1_0.time_group(),
+      budget_key_timeframe_group);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  RETURN_IF_FAILURE(MaterializeTimeframeGroup(budget_key_timeframe_group));
+
+  auto token_reservation = make_shared<TokenReservation>();
+  token_reservation->transaction_id = transaction_id;
+  token_reservation->time_group =
+      budget_key_time_frame_manager_log_1_0.time_group();
+  token_reservation->state = TokenReservationState::Logged;
+  for (const auto& [time_bucket, token_count] : reserved_tokens) {
+    shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
+    execution_result = budget_key_timeframe_group->budget_key_timeframes.Find(
+        time_bucket, budget_key_timeframe);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    if (budget_key_timeframe->token_count.load() < token_count) {
+      return FailureExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_CORRUPTED_KEY_METADATA);
+    }
+    token_reservation->reserved_tokens.emplace_back(
+        move(budget_key_timeframe), token_count);
+  }
+
+  auto token_reservation_pair = make_pair(transaction_id, token_reservation);
+  execution_result = token_reservations_.Insert(token_reservation_pair,
+                                                existing_token_reservation);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  for (const auto& [budget_key_timeframe, token_count] :
+       token_reservation->reserved_tokens) {
+    budget_key_timeframe->token_count -= token_count;
+    budget_key_timeframe->reserving_transaction_count++;
+  }
+  return SuccessExecutionResult();
+}
+
 ExecutionResult BudgetKeyTimeframeManager::OnJournalServiceRecoverCallback(
     const shared_ptr<BytesBuffer>& bytes_buffer,
     const Uuid& activity_id) noexcept {
@@ -951,11 +1574,25 @@ ExecutionResult BudgetKeyTimeframeManager::OnJournalServiceRecoverCallback(
     auto budget_key_timeframe_group =
         make_shared<BudgetKeyTimeframeGroup>(time_group);
 
-    execution_result = Serialization::DeserializeBudgetKeyTimeframeGroupLog_1_0(
-        budget_key_time_frame_manager_log_1_0.log_body(),
-        budget_key_timeframe_group);
-    if (!execution_result.Successful()) {
-      return execution_result;
+    if (lazy_recovery_enabled_) {
+      if (budget_key_time_frame_manager_log_1_0.log_body().empty()) {
+        return FailureExecutionResult(
+            core::errors::
+                SC_BUDGET_KEY_TIMEFRAME_MANAGER_CORRUPTED_KEY_METADATA);
+      }
+      // The timeframes are parsed on the first access of the group, if any.
+      budget_key_timeframe_group->serialized_timeframes =
+          make_shared<const string>(
+              move(*budget_key_time_frame_manager_log_1_0.mutable_log_body()));
+      budget_key_timeframe_group->has_serialized_timeframes = true;
+    } else {
+      execution_result =
+          Serialization::DeserializeBudgetKeyTimeframeGroupLog_1_0(
+              budget_key_time_frame_manager_log_1_0.log_body(),
+              budget_key_timeframe_group);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
     }
 
     auto budget_key_timeframe_group_pair =
@@ -993,6 +1630,7 @@ ExecutionResult BudgetKeyTimeframeManager::OnJournalServiceRecoverCallback(
     if (!execution_result.Successful()) {
       return execution_result;
     }
+    RETURN_IF_FAILURE(MaterializeTimeframeGroup(budget_key_timeframe_group));
 
     shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
     execution_result = Serialization::DeserializeBudgetKeyTimeframeLog_1_0(
@@ -1027,6 +1665,7 @@ ExecutionResult BudgetKeyTimeframeManager::OnJournalServiceRecoverCallback(
     if (!execution_result.Successful()) {
       return execution_result;
     }
+    RETURN_IF_FAILURE(MaterializeTimeframeGroup(budget_key_timeframe_group));
 
     vector<shared_ptr<BudgetKeyTimeframe>> budget_key_timeframes;
     execution_result = Serialization::DeserializeBatchBudgetKeyTimeframeLog_1_0(
@@ -1065,10 +1704,66 @@ ExecutionResult BudgetKeyTimeframeManager::OnJournalServiceRecoverCallback(
     return SuccessExecutionResult();
   }
 
+  if (budget_key_time_frame_manager_log_1_0.operation_type() ==
+          OperationType::RESERVE_TIMEFRAME_TOKENS ||
+      budget_key_time_frame_manager_log_1_0.operation_type() ==
+          OperationType::RELEASE_TIMEFRAME_TOKENS) {
+    return RecoverTokenReservationLog(budget_key_time_frame_manager_log_1_0);
+  }
+
   return FailureExecutionResult(
       core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_LOG);
 }
 
+ExecutionResult BudgetKeyTimeframeManager::AddReservedTokensToTimeframeGroup(
+    const vector<shared_ptr<TokenReservation>>& token_reservations,
+    shared_ptr<BudgetKeyTimeframeGroup>& budget_key_timeframe_group) noexcept {
+  auto time_group = budget_key_timeframe_group->time_group;
+  auto budget_key_timeframe_group_copy =
+      make_shared<BudgetKeyTimeframeGroup>(time_group);
+
+  vector<TimeBucket> time_buckets;
+  auto execution_result =
+      budget_key_timeframe_group->budget_key_timeframes.Keys(time_buckets);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  for (auto time_bucket : time_buckets) {
+    shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
+    execution_result = budget_key_timeframe_group->budget_key_timeframes.Find(
+        time_bucket, budget_key_timeframe);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    auto budget_key_timeframe_pair =
+        make_pair(time_bucket, budget_key_timeframe);
+    execution_result =
+        budget_key_timeframe_group_copy->budget_key_timeframes.Insert(
+            budget_key_timeframe_pair, budget_key_timeframe);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+
+  for (const auto& token_reservation : token_reservations) {
+    for (const auto& [budget_key_timeframe, token_count] :
+         token_reservation->reserved_tokens) {
+      shared_ptr<BudgetKeyTimeframe> budget_key_timeframe_copy;
+      execution_result =
+          budget_key_timeframe_group_copy->budget_key_timeframes.Find(
+              budget_key_timeframe->time_bucket_index,
+              budget_key_timeframe_copy);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+      budget_key_timeframe_copy->token_count += token_count;
+    }
+  }
+
+  budget_key_timeframe_group = move(budget_key_timeframe_group_copy);
+  return SuccessExecutionResult();
+}
+
 ExecutionResult BudgetKeyTimeframeManager::Checkpoint(
     shared_ptr<list<CheckpointLog>>& checkpoint_logs) noexcept {
   vector<TimeGroup> time_groups;
@@ -1077,6 +1772,22 @@ ExecutionResult BudgetKeyTimeframeManager::Checkpoint(
     return execution_result;
   }
 
+  unordered_map<TimeGroup, vector<shared_ptr<TokenReservation>>>
+      token_reservations_by_time_group;
+  vector<Uuid> transaction_ids;
+  execution_result = token_reservations_.Keys(transaction_ids);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  for (const auto& transaction_id : transaction_ids) {
+    shared_ptr<TokenReservation> token_reservation;
+    if (token_reservations_.Find(transaction_id, token_reservation)
+            .Successful()) {
+      token_reservations_by_time_group[token_reservation->time_group]
+          .push_back(move(token_reservation));
+    }
+  }
+
   for (auto time_group : time_groups) {
     shared_ptr<BudgetKeyTimeframeGroup> budget_key_timeframe_group;
     execution_result = budget_key_timeframe_groups_->Find(
@@ -1084,11 +1795,43 @@ ExecutionResult BudgetKeyTimeframeManager::Checkpoint(
     if (!execution_result.Successful()) {
       return execution_result;
     }
+    // A group being loaded is in the map before its timeframes are read and
+    // journaled.
+    if (!budget_key_timeframe_group->is_loaded) {
+      continue;
+    }
+
+    // A group that was not accessed since its recovery is checkpointed as it
+    // was recovered, without parsing it.
+    shared_ptr<const string> serialized_timeframes;
+    if (budget_key_timeframe_group->has_serialized_timeframes.load()) {
+      lock_guard<mutex> lock(
+          budget_key_timeframe_group->serialized_timeframes_mutex);
+      serialized_timeframes = budget_key_timeframe_group->serialized_timeframes;
+    }
 
     CheckpointLog budget_key_timeframe_metadata_checkpoint_log;
-    execution_result = Serialization::SerializeBudgetKeyTimeframeGroupLog(
-        budget_key_timeframe_group,
-        budget_key_timeframe_metadata_checkpoint_log.bytes_buffer);
+    if (serialized_timeframes) {
+      execution_result = Serialization::SerializeBudgetKeyTimeframeGroupLog(
+          time_group, serialized_timeframes->data(),
+          serialized_timeframes->size(),
+          budget_key_timeframe_metadata_checkpoint_log.bytes_buffer);
+    } else {
+      auto token_reservations_it =
+          token_reservations_by_time_group.find(time_group);
+      if (token_reservations_it != token_reservations_by_time_group.end()) {
+        // The reserved tokens are checkpointed as part of the timeframes,
+        // and taken off again when the reservation logs below are replayed.
+        execution_result = AddReservedTokensToTimeframeGroup(
+            token_reservations_it->second, budget_key_timeframe_group);
+        if (!execution_result.Successful()) {
+          return execution_result;
+        }
+      }
+      execution_result = Serialization::SerializeBudgetKeyTimeframeGroupLog(
+          budget_key_timeframe_group,
+          budget_key_timeframe_metadata_checkpoint_log.bytes_buffer);
+    }
     if (!execution_result.Successful()) {
       return execution_result;
     }
@@ -1099,6 +1842,30 @@ ExecutionResult BudgetKeyTimeframeManager::Checkpoint(
         JournalLogStatus::Log;
     checkpoint_logs->push_back(
         move(budget_key_timeframe_metadata_checkpoint_log));
+
+    auto token_reservations_it =
+        token_reservations_by_time_group.find(time_group);
+    if (token_reservations_it == token_reservations_by_time_group.end()) {
+      continue;
+    }
+    for (const auto& token_reservation : token_reservations_it->second) {
+      // A reservation that is not journaled yet is not checkpointed either.
+      if (token_reservation->state.load() == TokenReservationState::Logging) {
+        continue;
+      }
+      CheckpointLog token_reservation_checkpoint_log;
+      execution_result = SerializeTokenReservationLog(
+          *token_reservation, OperationType::RESERVE_TIMEFRAME_TOKENS,
+          false /* return_tokens */,
+          token_reservation_checkpoint_log.bytes_buffer);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+      token_reservation_checkpoint_log.component_id = id_;
+      token_reservation_checkpoint_log.log_id = Uuid::GenerateUuid();
+      token_reservation_checkpoint_log.log_status = JournalLogStatus::Log;
+      checkpoint_logs->push_back(move(token_reservation_checkpoint_log));
+    }
   }
   return SuccessExecutionResult();
 }
@@ -20,6 +20,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/nullability.h"
@@ -34,6 +35,7 @@
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
 #include "opentelemetry/metrics/meter.h"
 #include "opentelemetry/metrics/sync_instruments.h"
+#include "pbs/budget_key_timeframe_manager/src/proto/budget_key_timeframe_manager.pb.h"
 #include "pbs/interface/budget_key_timeframe_manager_interface.h"
 #include "pbs/interface/type_def.h"
 #include "public/core/interface/execution_result.h"
@@ -83,7 +85,8 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
       std::shared_ptr<core::MetricRouter> metric_router,
       const std::shared_ptr<core::ConfigProviderInterface>& config_provider,
       const std::shared_ptr<cpio::AggregateMetricInterface>&
-          budget_key_count_metric)
+          budget_key_count_metric,
+      const std::shared_ptr<core::common::RetryBudget>& retry_budget = nullptr)
       : budget_key_name_(budget_key_name),
         id_(id),
         async_executor_(async_executor),
@@ -107,11 +110,16 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
             core::common::RetryStrategy(
                 core::common::RetryStrategyType::Exponential,
                 kBudgetKeyTimeframeManagerRetryStrategyDelayMs,
-                kBudgetKeyTimeframeManagerRetryStrategyTotalRetries)),
+                kBudgetKeyTimeframeManagerRetryStrategyTotalRetries,
+                core::common::kDefaultRetryStrategyJitterRatio),
+            retry_budget),
         metric_client_(metric_client),
         metric_router_(metric_router),
         config_provider_(config_provider),
-        budget_key_count_metric_(budget_key_count_metric) {}
+        budget_key_count_metric_(budget_key_count_metric),
+        lazy_recovery_enabled_(false),
+        load_coalescing_enabled_(false),
+        record_not_found_cache_ttl_in_nanoseconds_(0) {}
 
   ~BudgetKeyTimeframeManager();
 
@@ -133,6 +141,16 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
                          UpdateBudgetKeyTimeframeResponse>&
           update_budget_key_timeframe_context) noexcept override;
 
+  core::ExecutionResult Reserve(
+      core::AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                         ReserveBudgetKeyTimeframeResponse>&
+          reserve_budget_key_timeframe_context) noexcept override;
+
+  core::ExecutionResult Release(
+      core::AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                         ReleaseBudgetKeyTimeframeResponse>&
+          release_budget_key_timeframe_context) noexcept override;
+
   const core::common::Uuid GetId() noexcept override { return id_; }
 
   core::ExecutionResult Checkpoint(
@@ -142,6 +160,111 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
   void MetricInit() noexcept override;
 
  protected:
+  /// The state of the tokens reserved by a transaction.
+  enum class TokenReservationState {
+    /// The reservation is being journaled.
+    Logging = 0,
+    /// The reservation is journaled.
+    Logged = 1,
+    /// The release of the reservation is being journaled.
+    Releasing = 2,
+  };
+
+  /// The tokens reserved by a transaction.
+  struct TokenReservation {
+    /// The id of the transaction.
+    core::common::Uuid transaction_id = core::common::kZeroUuid;
+    /// The time group of the reserved timeframes.
+    TimeGroup time_group = 0;
+    /// The timeframes and the number of tokens reserved from each.
+    std::vector<std::pair<std::shared_ptr<BudgetKeyTimeframe>, TokenCount>>
+        reserved_tokens;
+    /// The state of the reservation.
+    std::atomic<TokenReservationState> state = TokenReservationState::Logging;
+  };
+
+  /**
+   * @brief Releases the first count timeframes of a reservation, giving their
+   * tokens back if requested.
+   *
+   * @param token_reservation The reservation to release.
+   * @param count The number of timeframes to release.
+   * @param return_tokens Whether the tokens are given back.
+   */
+  static void ReleaseReservedTokens(const TokenReservation& token_reservation,
+                                    size_t count, bool return_tokens) noexcept;
+
+  /**
+   * @brief Serializes the reservation or the release log of a reservation.
+   *
+   * @param token_reservation The reservation.
+   * @param operation_type Either RESERVE_TIMEFRAME_TOKENS or
+   * RELEASE_TIMEFRAME_TOKENS.
+   * @param return_tokens Whether the tokens are given back on release.
+   * @param bytes_buffer The byte buffer to write the log to.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult SerializeTokenReservationLog(
+      const TokenReservation& token_reservation,
+      budget_key_timeframe_manager::proto::OperationType operation_type,
+      bool return_tokens, core::BytesBuffer& bytes_buffer) noexcept;
+
+  /**
+   * @brief Is called when logging on the reserve operation is completed.
+   *
+   * @param reserve_budget_key_timeframe_context The reserve budget key
+   * timeframe operation context.
+   * @param token_reservation The reservation being logged.
+   * @param journal_log_context The journal log operation context.
+   */
+  virtual void OnLogReserveCallback(
+      core::AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                         ReserveBudgetKeyTimeframeResponse>&
+          reserve_budget_key_timeframe_context,
+      std::shared_ptr<TokenReservation>& token_reservation,
+      core::AsyncContext<core::JournalLogRequest, core::JournalLogResponse>&
+          journal_log_context) noexcept;
+
+  /**
+   * @brief Is called when logging on the release operation is completed.
+   *
+   * @param release_budget_key_timeframe_context The release budget key
+   * timeframe operation context.
+   * @param token_reservation The reservation being released.
+   * @param journal_log_context The journal log operation context.
+   */
+  virtual void OnLogReleaseCallback(
+      core::AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                         ReleaseBudgetKeyTimeframeResponse>&
+          release_budget_key_timeframe_context,
+      std::shared_ptr<TokenReservation>& token_reservation,
+      core::AsyncContext<core::JournalLogRequest, core::JournalLogResponse>&
+          journal_log_context) noexcept;
+
+  /**
+   * @brief Replaces a timeframe group by a copy of it with the tokens of the
+   * reservations given back, to checkpoint it along with the reservations.
+   *
+   * @param token_reservations The reservations of the timeframe group.
+   * @param budget_key_timeframe_group The timeframe group to replace.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult AddReservedTokensToTimeframeGroup(
+      const std::vector<std::shared_ptr<TokenReservation>>& token_reservations,
+      std::shared_ptr<BudgetKeyTimeframeGroup>&
+          budget_key_timeframe_group) noexcept;
+
+  /**
+   * @brief Replays a reservation or a release log.
+   *
+   * @param budget_key_time_frame_manager_log_1_0 The log to replay.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult RecoverTokenReservationLog(
+      const budget_key_timeframe_manager::proto::
+          BudgetKeyTimeframeManagerLog_1_0&
+              budget_key_time_frame_manager_log_1_0) noexcept;
+
   /**
    * @brief Helper function to populate budget key time frames in response
    * w.r.t. time buckets specified in the request
@@ -160,6 +283,17 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
       std::shared_ptr<LoadBudgetKeyTimeframeResponse>&
           load_budget_key_timeframe_response);
 
+  /**
+   * @brief Parses the serialized timeframes of a lazily recovered group into
+   * its timeframes. Does nothing if the group was already materialized.
+   *
+   * @param budget_key_timeframe_group The budget key timeframe group.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult MaterializeTimeframeGroup(
+      const std::shared_ptr<BudgetKeyTimeframeGroup>&
+          budget_key_timeframe_group) noexcept;
+
   /**
    * @brief Is Called right before the map garbage collector is trying to
    * remove the element from the map.
@@ -249,6 +383,34 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
       std::shared_ptr<BudgetKeyTimeframeGroup>& budget_key_timeframe_group,
       std::function<void(bool)> should_delete_entry) noexcept;
 
+  /**
+   * @brief Queues the load to be completed by the load of the group in flight.
+   *
+   * @param budget_key_timeframe_group The budget key time frame group being
+   * loaded.
+   * @param load_budget_key_timeframe_context The load budget key timeframe
+   * context of the operation.
+   * @return true If the load is queued.
+   * @return false If the group is loaded already, or its load failed.
+   */
+  bool AddPendingLoad(
+      const std::shared_ptr<BudgetKeyTimeframeGroup>&
+          budget_key_timeframe_group,
+      core::AsyncContext<LoadBudgetKeyTimeframeRequest,
+                         LoadBudgetKeyTimeframeResponse>&
+          load_budget_key_timeframe_context) noexcept;
+
+  /**
+   * @brief Completes the loads queued on the group once its load is completed.
+   *
+   * @param budget_key_timeframe_group The budget key time frame group loaded.
+   * @param execution_result The execution result of the load.
+   */
+  void CompletePendingLoads(
+      const std::shared_ptr<BudgetKeyTimeframeGroup>&
+          budget_key_timeframe_group,
+      const core::ExecutionResult& execution_result) noexcept;
+
   /**
    * @brief Loads the specific timeframe group from the database.
    *
@@ -310,6 +472,12 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
       TimeGroup, std::shared_ptr<BudgetKeyTimeframeGroup>>>
       budget_key_timeframe_groups_;
 
+  // The tokens reserved by the in-flight transactions, by transaction id.
+  core::common::ConcurrentMap<core::common::Uuid,
+                              std::shared_ptr<TokenReservation>,
+                              core::common::UuidCompare>
+      token_reservations_;
+
   // Operation dispatcher
   core::common::OperationDispatcher operation_dispatcher_;
 
@@ -348,6 +516,16 @@ class BudgetKeyTimeframeManager : public BudgetKeyTimeframeManagerInterface {
 
   // The aggregate metric instance for budget key counters
   std::shared_ptr<cpio::AggregateMetricInterface> budget_key_count_metric_;
+
+  // Whether the recovered timeframe groups are kept serialized until they are
+  // accessed.
+  bool lazy_recovery_enabled_;
+
+  // Whether the loads of a group being loaded wait for the load in flight.
+  bool load_coalescing_enabled_;
+
+  // For how long a group found missing from the database is not read again.
+  core::TimeDuration record_not_found_cache_ttl_in_nanoseconds_;
 };
 
 }  // namespace google::scp::pbs
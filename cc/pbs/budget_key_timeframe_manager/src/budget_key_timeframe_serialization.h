@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -23,6 +25,8 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include "google/protobuf/arena.h"
+
 #include "core/common/serialization/src/serialization.h"
 #include "pbs/budget_key_timeframe_manager/src/proto/budget_key_timeframe_manager.pb.h"
 #include "pbs/interface/budget_key_timeframe_manager_interface.h"
@@ -32,8 +36,20 @@
 #include "error_codes.h"
 
 namespace google::scp::pbs::budget_key_timeframe_manager {
-static constexpr TimeBucket kHoursPerDay = 24;
+static constexpr TimeBucket kHoursPerDay = kBudgetKeyTimeframesPerGroup;
 static constexpr core::Version kCurrentVersion = {.major = 1, .minor = 0};
+/// The numbers of the log_body fields of BudgetKeyTimeframeManagerLog and
+/// BudgetKeyTimeframeManagerLog_1_0.
+static constexpr int kLogBodyFieldNumber =
+    proto::BudgetKeyTimeframeManagerLog::kLogBodyFieldNumber;
+static constexpr int kLogBodyFieldNumber_1_0 =
+    proto::BudgetKeyTimeframeManagerLog_1_0::kLogBodyFieldNumber;
+/// The stack memory the arena of a log starts with, enough for the log of a
+/// full timeframe group so that building a log does not allocate.
+static constexpr size_t kLogArenaInitialBlockSize = 4096;
+struct LogArenaBlock {
+  alignas(std::max_align_t) char data[kLogArenaInitialBlockSize];
+};
 
 class Serialization {
  public:
@@ -51,44 +67,16 @@ class Serialization {
       const TimeGroup& time_group,
       const std::shared_ptr<BudgetKeyTimeframe>& budget_key_timeframe,
       core::BytesBuffer& budget_key_timeframe_log_bytes_buffer) {
-    core::BytesBuffer budget_key_timeframe_log_1_0_bytes_buffer;
-    auto execution_result = SerializeBudgetKeyTimeframeLog_1_0(
-        budget_key_timeframe, budget_key_timeframe_log_1_0_bytes_buffer);
-    if (execution_result != core::SuccessExecutionResult()) {
-      return execution_result;
-    }
-
-    proto::BudgetKeyTimeframeManagerLog_1_0
-        budget_key_timeframe_manager_log_1_0;
-    budget_key_timeframe_manager_log_1_0.set_operation_type(
-        proto::OperationType::UPDATE_TIMEFRAME_RECORD);
-    budget_key_timeframe_manager_log_1_0.set_time_group(time_group);
-
-    budget_key_timeframe_manager_log_1_0.set_log_body(
-        budget_key_timeframe_log_1_0_bytes_buffer.bytes->data(),
-        budget_key_timeframe_log_1_0_bytes_buffer.length);
-
-    core::BytesBuffer budget_key_timeframe_manager_log_1_0_bytes_buffer;
-    execution_result = SerializeBudgetKeyTimeframeManagerLog_1_0(
-        budget_key_timeframe_manager_log_1_0,
-        budget_key_timeframe_manager_log_1_0_bytes_buffer);
-    if (execution_result != core::SuccessExecutionResult()) {
-      return execution_result;
-    }
-
-    proto::BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
-    budget_key_timeframe_manager_log.mutable_version()->set_major(
-        kCurrentVersion.major);
-    budget_key_timeframe_manager_log.mutable_version()->set_minor(
-        kCurrentVersion.minor);
-
-    budget_key_timeframe_manager_log.set_log_body(
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.bytes->data(),
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.length);
-
+    LogArenaBlock arena_block;
+    google::protobuf::Arena arena(arena_block.data, sizeof(arena_block.data));
+    auto* budget_key_timeframe_log_1_0 =
+        google::protobuf::Arena::Create<proto::BudgetKeyTimeframeLog_1_0>(
+            &arena);
+    PopulateBudgetKeyTimeframeLog_1_0(*budget_key_timeframe,
+                                      *budget_key_timeframe_log_1_0);
     return SerializeBudgetKeyTimeframeManagerLog(
-        budget_key_timeframe_manager_log,
-        budget_key_timeframe_log_bytes_buffer);
+        arena, proto::OperationType::UPDATE_TIMEFRAME_RECORD, time_group,
+        *budget_key_timeframe_log_1_0, budget_key_timeframe_log_bytes_buffer);
   }
 
   /**
@@ -110,46 +98,63 @@ class Serialization {
       const std::vector<std::shared_ptr<BudgetKeyTimeframe>>&
           budget_key_timeframes,
       core::BytesBuffer& batch_budget_key_timeframe_log_bytes_buffer) {
-    core::BytesBuffer batch_budget_key_timeframe_log_1_0_bytes_buffer;
-    auto execution_result = SerializeBatchBudgetKeyTimeframeLog_1_0(
-        budget_key_timeframes, batch_budget_key_timeframe_log_1_0_bytes_buffer);
-    if (execution_result != core::SuccessExecutionResult()) {
-      return execution_result;
+    if (budget_key_timeframes.empty()) {
+      return core::FailureExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_LOG);
     }
 
-    proto::BudgetKeyTimeframeManagerLog_1_0
-        budget_key_timeframe_manager_log_1_0;
-    budget_key_timeframe_manager_log_1_0.set_operation_type(
-        proto::OperationType::BATCH_UPDATE_TIMEFRAME_RECORDS_OF_TIMEGROUP);
-    budget_key_timeframe_manager_log_1_0.set_time_group(time_group);
-
-    budget_key_timeframe_manager_log_1_0.set_log_body(
-        batch_budget_key_timeframe_log_1_0_bytes_buffer.bytes->data(),
-        batch_budget_key_timeframe_log_1_0_bytes_buffer.length);
-
-    core::BytesBuffer budget_key_timeframe_manager_log_1_0_bytes_buffer;
-    execution_result = SerializeBudgetKeyTimeframeManagerLog_1_0(
-        budget_key_timeframe_manager_log_1_0,
-        budget_key_timeframe_manager_log_1_0_bytes_buffer);
-    if (execution_result != core::SuccessExecutionResult()) {
-      return execution_result;
+    LogArenaBlock arena_block;
+    google::protobuf::Arena arena(arena_block.data, sizeof(arena_block.data));
+    auto* batch_budget_key_timeframe_log_1_0 =
+        google::protobuf::Arena::Create<proto::BatchBudgetKeyTimeframeLog_1_0>(
+            &arena);
+    for (const auto& budget_key_timeframe : budget_key_timeframes) {
+      PopulateBudgetKeyTimeframeLog_1_0(
+          *budget_key_timeframe,
+          *batch_budget_key_timeframe_log_1_0->add_items());
     }
-
-    proto::BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
-    budget_key_timeframe_manager_log.mutable_version()->set_major(
-        kCurrentVersion.major);
-    budget_key_timeframe_manager_log.mutable_version()->set_minor(
-        kCurrentVersion.minor);
-
-    budget_key_timeframe_manager_log.set_log_body(
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.bytes->data(),
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.length);
-
     return SerializeBudgetKeyTimeframeManagerLog(
-        budget_key_timeframe_manager_log,
+        arena,
+        proto::OperationType::BATCH_UPDATE_TIMEFRAME_RECORDS_OF_TIMEGROUP,
+        time_group, *batch_budget_key_timeframe_log_1_0,
         batch_budget_key_timeframe_log_bytes_buffer);
   }
 
+  /**
+   * @brief Serializes the log of the tokens reserved by a transaction, either
+   * when they are reserved or when they are released.
+   *
+   * @param time_group The time group of the reserved timeframes.
+   * @param operation_type Either RESERVE_TIMEFRAME_TOKENS or
+   * RELEASE_TIMEFRAME_TOKENS.
+   * @param transaction_id The id of the transaction.
+   * @param reserved_tokens The time buckets and the number of tokens reserved
+   * from each, only set for RESERVE_TIMEFRAME_TOKENS.
+   * @param return_tokens Whether the tokens are given back, only set for
+   * RELEASE_TIMEFRAME_TOKENS.
+   * @param budget_key_timeframe_reservation_log_bytes_buffer The byte buffer
+   * to write the data to.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult SerializeBudgetKeyTimeframeReservationLog(
+      const TimeGroup& time_group, proto::OperationType operation_type,
+      const core::common::Uuid& transaction_id,
+      const std::vector<std::pair<TimeBucket, TokenCount>>& reserved_tokens,
+      bool return_tokens,
+      core::BytesBuffer& budget_key_timeframe_reservation_log_bytes_buffer) {
+    LogArenaBlock arena_block;
+    google::protobuf::Arena arena(arena_block.data, sizeof(arena_block.data));
+    auto* budget_key_timeframe_reservation_log_1_0 = google::protobuf::Arena::
+        Create<proto::BudgetKeyTimeframeReservationLog_1_0>(&arena);
+    PopulateBudgetKeyTimeframeReservationLog_1_0(
+        transaction_id, reserved_tokens, return_tokens,
+        *budget_key_timeframe_reservation_log_1_0);
+    return SerializeBudgetKeyTimeframeManagerLog(
+        arena, operation_type, time_group,
+        *budget_key_timeframe_reservation_log_1_0,
+        budget_key_timeframe_reservation_log_bytes_buffer);
+  }
+
   /**
    * @brief Serializes budget key time frame group log.
    *
@@ -163,47 +168,50 @@ class Serialization {
       const std::shared_ptr<BudgetKeyTimeframeGroup>&
           budget_key_timeframe_group,
       core::BytesBuffer& budget_key_timeframe_group_log_bytes_buffer) {
-    // Serialize all the log body
-    core::BytesBuffer budget_key_timeframe_group_log_1_0_buffer;
-    auto execution_result =
-        Serialization::SerializeBudgetKeyTimeframeGroupLog_1_0(
-            budget_key_timeframe_group,
-            budget_key_timeframe_group_log_1_0_buffer);
+    LogArenaBlock arena_block;
+    google::protobuf::Arena arena(arena_block.data, sizeof(arena_block.data));
+    auto* budget_key_timeframe_group_log_1_0 =
+        google::protobuf::Arena::Create<proto::BudgetKeyTimeframeGroupLog_1_0>(
+            &arena);
+    auto execution_result = PopulateBudgetKeyTimeframeGroupLog_1_0(
+        *budget_key_timeframe_group, *budget_key_timeframe_group_log_1_0);
     if (execution_result != core::SuccessExecutionResult()) {
       return execution_result;
     }
+    return SerializeBudgetKeyTimeframeManagerLog(
+        arena, proto::OperationType::INSERT_TIMEGROUP_INTO_CACHE,
+        budget_key_timeframe_group->time_group,
+        *budget_key_timeframe_group_log_1_0,
+        budget_key_timeframe_group_log_bytes_buffer);
+  }
 
+  /**
+   * @brief Serializes budget key time frame group log from the already
+   * serialized timeframes of the group.
+   *
+   * @param time_group The time group of the budget key timeframe group.
+   * @param serialized_timeframes The serialized BudgetKeyTimeframeGroupLog_1_0
+   * of the group.
+   * @param serialized_timeframes_length The length of serialized_timeframes.
+   * @param budget_key_timeframe_group_log_bytes_buffer The byte buffer to write
+   * the data to.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult SerializeBudgetKeyTimeframeGroupLog(
+      TimeGroup time_group, const core::Byte* serialized_timeframes,
+      size_t serialized_timeframes_length,
+      core::BytesBuffer& budget_key_timeframe_group_log_bytes_buffer) {
+    proto::BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
     proto::BudgetKeyTimeframeManagerLog_1_0
         budget_key_timeframe_manager_log_1_0;
-    budget_key_timeframe_manager_log_1_0.set_operation_type(
-        proto::OperationType::INSERT_TIMEGROUP_INTO_CACHE);
-    budget_key_timeframe_manager_log_1_0.set_time_group(
-        budget_key_timeframe_group->time_group);
-
-    budget_key_timeframe_manager_log_1_0.set_log_body(
-        budget_key_timeframe_group_log_1_0_buffer.bytes->data(),
-        budget_key_timeframe_group_log_1_0_buffer.length);
-
-    core::BytesBuffer budget_key_timeframe_manager_log_1_0_bytes_buffer;
-    execution_result = SerializeBudgetKeyTimeframeManagerLog_1_0(
-        budget_key_timeframe_manager_log_1_0,
-        budget_key_timeframe_manager_log_1_0_bytes_buffer);
-    if (execution_result != core::SuccessExecutionResult()) {
-      return execution_result;
-    }
-
-    proto::BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
-    budget_key_timeframe_manager_log.mutable_version()->set_major(
-        kCurrentVersion.major);
-    budget_key_timeframe_manager_log.mutable_version()->set_minor(
-        kCurrentVersion.minor);
-
-    budget_key_timeframe_manager_log.set_log_body(
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.bytes->data(),
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.length);
-
-    return SerializeBudgetKeyTimeframeManagerLog(
+    PopulateBudgetKeyTimeframeManagerLogHeaders(
+        proto::OperationType::INSERT_TIMEGROUP_INTO_CACHE, time_group,
         budget_key_timeframe_manager_log,
+        budget_key_timeframe_manager_log_1_0);
+    return core::common::Serialization::SerializeEnvelopedProtoMessage(
+        {{&budget_key_timeframe_manager_log, kLogBodyFieldNumber},
+         {&budget_key_timeframe_manager_log_1_0, kLogBodyFieldNumber_1_0}},
+        serialized_timeframes, serialized_timeframes_length,
         budget_key_timeframe_group_log_bytes_buffer);
   }
 
@@ -221,34 +229,75 @@ class Serialization {
           budget_key_timeframe_group,
       core::BytesBuffer&
           budget_key_timeframe_manager_group_removal_log_bytes_buffer) {
+    proto::BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
     proto::BudgetKeyTimeframeManagerLog_1_0
         budget_key_timeframe_manager_log_1_0;
-    budget_key_timeframe_manager_log_1_0.set_operation_type(
-        proto::OperationType::REMOVE_TIMEGROUP_FROM_CACHE);
-    budget_key_timeframe_manager_log_1_0.set_time_group(
-        budget_key_timeframe_group->time_group);
-
-    core::BytesBuffer budget_key_timeframe_manager_log_1_0_bytes_buffer;
-    auto execution_result = SerializeBudgetKeyTimeframeManagerLog_1_0(
-        budget_key_timeframe_manager_log_1_0,
-        budget_key_timeframe_manager_log_1_0_bytes_buffer);
-    if (execution_result != core::SuccessExecutionResult()) {
-      return execution_result;
-    }
+    PopulateBudgetKeyTimeframeManagerLogHeaders(
+        proto::OperationType::REMOVE_TIMEGROUP_FROM_CACHE,
+        budget_key_timeframe_group->time_group,
+        budget_key_timeframe_manager_log,
+        budget_key_timeframe_manager_log_1_0);
+    // The removal has no log body.
+    return core::common::Serialization::SerializeEnvelopedProtoMessage(
+        {{&budget_key_timeframe_manager_log, kLogBodyFieldNumber},
+         {&budget_key_timeframe_manager_log_1_0, kLogBodyFieldNumber_1_0}},
+        /*body=*/nullptr, /*body_length=*/0,
+        budget_key_timeframe_manager_group_removal_log_bytes_buffer);
+  }
 
-    proto::BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
+  /**
+   * @brief Serializes a budget key timeframe manager log around its log body,
+   * in a single pass rather than serializing the log body, then the
+   * BudgetKeyTimeframeManagerLog_1_0 enclosing it and then the
+   * BudgetKeyTimeframeManagerLog. The bytes are the same.
+   *
+   * @param arena The arena to create the envelopes on.
+   * @param operation_type The operation type of the log.
+   * @param time_group The time group of the log.
+   * @param log_body The log body, BudgetKeyTimeframeLog_1_0 and so forth
+   * depending on the operation type.
+   * @param budget_key_timeframe_manager_log_bytes_buffer The byte buffer to
+   * write the data to.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult SerializeBudgetKeyTimeframeManagerLog(
+      google::protobuf::Arena& arena, proto::OperationType operation_type,
+      TimeGroup time_group, const google::protobuf::MessageLite& log_body,
+      core::BytesBuffer& budget_key_timeframe_manager_log_bytes_buffer) {
+    auto* budget_key_timeframe_manager_log =
+        google::protobuf::Arena::Create<proto::BudgetKeyTimeframeManagerLog>(
+            &arena);
+    auto* budget_key_timeframe_manager_log_1_0 = google::protobuf::Arena::
+        Create<proto::BudgetKeyTimeframeManagerLog_1_0>(&arena);
+    PopulateBudgetKeyTimeframeManagerLogHeaders(
+        operation_type, time_group, *budget_key_timeframe_manager_log,
+        *budget_key_timeframe_manager_log_1_0);
+    return core::common::Serialization::SerializeEnvelopedProtoMessage(
+        {{budget_key_timeframe_manager_log, kLogBodyFieldNumber},
+         {budget_key_timeframe_manager_log_1_0, kLogBodyFieldNumber_1_0}},
+        log_body, budget_key_timeframe_manager_log_bytes_buffer);
+  }
+
+  /**
+   * @brief Sets the fields of the budget key timeframe manager logs other
+   * than their log bodies.
+   *
+   * @param operation_type The operation type of the log.
+   * @param time_group The time group of the log.
+   * @param budget_key_timeframe_manager_log The outer log.
+   * @param budget_key_timeframe_manager_log_1_0 The inner log.
+   */
+  static void PopulateBudgetKeyTimeframeManagerLogHeaders(
+      proto::OperationType operation_type, TimeGroup time_group,
+      proto::BudgetKeyTimeframeManagerLog& budget_key_timeframe_manager_log,
+      proto::BudgetKeyTimeframeManagerLog_1_0&
+          budget_key_timeframe_manager_log_1_0) noexcept {
     budget_key_timeframe_manager_log.mutable_version()->set_major(
         kCurrentVersion.major);
     budget_key_timeframe_manager_log.mutable_version()->set_minor(
         kCurrentVersion.minor);
-
-    budget_key_timeframe_manager_log.set_log_body(
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.bytes->data(),
-        budget_key_timeframe_manager_log_1_0_bytes_buffer.length);
-
-    return SerializeBudgetKeyTimeframeManagerLog(
-        budget_key_timeframe_manager_log,
-        budget_key_timeframe_manager_group_removal_log_bytes_buffer);
+    budget_key_timeframe_manager_log_1_0.set_operation_type(operation_type);
+    budget_key_timeframe_manager_log_1_0.set_time_group(time_group);
   }
 
   /**
@@ -370,16 +419,8 @@ class Serialization {
       core::BytesBuffer& budget_key_timeframe_log_1_0_bytes_buffer) noexcept {
     // Creating the budget key timeframe log v1.0 object.
     proto::BudgetKeyTimeframeLog_1_0 budget_key_timeframe_log_1_0;
-    budget_key_timeframe_log_1_0.set_active_token_count(
-        budget_key_timeframe->active_token_count);
-    budget_key_timeframe_log_1_0.mutable_active_transaction_id()->set_high(
-        budget_key_timeframe->active_transaction_id.load().high);
-    budget_key_timeframe_log_1_0.mutable_active_transaction_id()->set_low(
-        budget_key_timeframe->active_transaction_id.load().low);
-    budget_key_timeframe_log_1_0.set_time_bucket(
-        budget_key_timeframe->time_bucket_index);
-    budget_key_timeframe_log_1_0.set_token_count(
-        budget_key_timeframe->token_count);
+    PopulateBudgetKeyTimeframeLog_1_0(*budget_key_timeframe,
+                                      budget_key_timeframe_log_1_0);
 
     // Serializing the budget key timeframe log v1.0 object.
     size_t offset = 0;
@@ -419,18 +460,10 @@ class Serialization {
     // Creating the batch budget key timeframe log v1.0 object.
     proto::BatchBudgetKeyTimeframeLog_1_0 batch_budget_key_timeframe_log_1_0;
     for (const auto& budget_key_timeframe : budget_key_timeframes) {
-      auto budget_key_timeframe_log_1_0 =
+      auto* budget_key_timeframe_log_1_0 =
           batch_budget_key_timeframe_log_1_0.add_items();
-      budget_key_timeframe_log_1_0->set_active_token_count(
-          budget_key_timeframe->active_token_count);
-      budget_key_timeframe_log_1_0->mutable_active_transaction_id()->set_high(
-          budget_key_timeframe->active_transaction_id.load().high);
-      budget_key_timeframe_log_1_0->mutable_active_transaction_id()->set_low(
-          budget_key_timeframe->active_transaction_id.load().low);
-      budget_key_timeframe_log_1_0->set_time_bucket(
-          budget_key_timeframe->time_bucket_index);
-      budget_key_timeframe_log_1_0->set_token_count(
-          budget_key_timeframe->token_count);
+      PopulateBudgetKeyTimeframeLog_1_0(*budget_key_timeframe,
+                                        *budget_key_timeframe_log_1_0);
     }
 
     // Serializing the batch budget key timeframe log v1.0 object.
@@ -449,6 +482,95 @@ class Serialization {
     return core::SuccessExecutionResult();
   }
 
+  /**
+   * @brief Serializes the budget key timeframe reservation 1_0 into the
+   * provided buffer.
+   *
+   * @param transaction_id The id of the transaction.
+   * @param reserved_tokens The time buckets and the number of tokens reserved
+   * from each.
+   * @param return_tokens Whether the tokens are given back.
+   * @param budget_key_timeframe_reservation_log_1_0_bytes_buffer The buffer to
+   * write the serialized data to.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult SerializeBudgetKeyTimeframeReservationLog_1_0(
+      const core::common::Uuid& transaction_id,
+      const std::vector<std::pair<TimeBucket, TokenCount>>& reserved_tokens,
+      bool return_tokens,
+      core::BytesBuffer&
+          budget_key_timeframe_reservation_log_1_0_bytes_buffer) noexcept {
+    proto::BudgetKeyTimeframeReservationLog_1_0
+        budget_key_timeframe_reservation_log_1_0;
+    PopulateBudgetKeyTimeframeReservationLog_1_0(
+        transaction_id, reserved_tokens, return_tokens,
+        budget_key_timeframe_reservation_log_1_0);
+
+    size_t offset = 0;
+    size_t bytes_serialized = 0;
+    budget_key_timeframe_reservation_log_1_0_bytes_buffer = core::BytesBuffer(
+        budget_key_timeframe_reservation_log_1_0.ByteSizeLong());
+    auto execution_result = core::common::Serialization::SerializeProtoMessage<
+        proto::BudgetKeyTimeframeReservationLog_1_0>(
+        budget_key_timeframe_reservation_log_1_0_bytes_buffer, offset,
+        budget_key_timeframe_reservation_log_1_0, bytes_serialized);
+    if (execution_result != core::SuccessExecutionResult()) {
+      return execution_result;
+    }
+    budget_key_timeframe_reservation_log_1_0_bytes_buffer.length =
+        bytes_serialized;
+    return core::SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Deserializes budget key timeframe reservation 1_0 object from log.
+   *
+   * @param budget_key_timeframe_reservation_log_1_0_str The buffer to read the
+   * serialized object from.
+   * @param transaction_id The id of the transaction.
+   * @param reserved_tokens The time buckets and the number of tokens reserved
+   * from each.
+   * @param return_tokens Whether the tokens are given back.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult DeserializeBudgetKeyTimeframeReservationLog_1_0(
+      const std::string& budget_key_timeframe_reservation_log_1_0_str,
+      core::common::Uuid& transaction_id,
+      std::vector<std::pair<TimeBucket, TokenCount>>& reserved_tokens,
+      bool& return_tokens) noexcept {
+    proto::BudgetKeyTimeframeReservationLog_1_0
+        budget_key_timeframe_reservation_log_1_0;
+    size_t bytes_deserialized = 0;
+    auto execution_result =
+        core::common::Serialization::DeserializeProtoMessage<
+            proto::BudgetKeyTimeframeReservationLog_1_0>(
+            budget_key_timeframe_reservation_log_1_0_str,
+            budget_key_timeframe_reservation_log_1_0, bytes_deserialized);
+    if (execution_result != core::SuccessExecutionResult()) {
+      return execution_result;
+    }
+
+    transaction_id.high =
+        budget_key_timeframe_reservation_log_1_0.transaction_id().high();
+    transaction_id.low =
+        budget_key_timeframe_reservation_log_1_0.transaction_id().low();
+    if (transaction_id == core::common::kZeroUuid) {
+      return core::FailureExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_LOG);
+    }
+
+    reserved_tokens.clear();
+    for (const auto& item : budget_key_timeframe_reservation_log_1_0.items()) {
+      if (item.token_count() > UINT8_MAX) {
+        return core::FailureExecutionResult(
+            core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_LOG);
+      }
+      reserved_tokens.emplace_back(item.time_bucket(), item.token_count());
+    }
+    return_tokens = budget_key_timeframe_reservation_log_1_0.return_tokens();
+    return core::SuccessExecutionResult();
+  }
+
   /**
    * @brief Deserializes budget key time frame 1_0 object from log.
    *
@@ -557,35 +679,12 @@ class Serialization {
           budget_key_timeframe_group,
       core::BytesBuffer& budget_key_timeframe_group_log_bytes_buffer) noexcept {
     proto::BudgetKeyTimeframeGroupLog_1_0 budget_key_timeframe_group_log_1_0;
-    budget_key_timeframe_group_log_1_0.set_time_group(
-        budget_key_timeframe_group->time_group);
-    std::vector<TimeBucket> time_buckets;
-    auto execution_result =
-        budget_key_timeframe_group->budget_key_timeframes.Keys(time_buckets);
+    auto execution_result = PopulateBudgetKeyTimeframeGroupLog_1_0(
+        *budget_key_timeframe_group, budget_key_timeframe_group_log_1_0);
     if (execution_result != core::SuccessExecutionResult()) {
       return execution_result;
     }
 
-    for (auto time_bucket : time_buckets) {
-      std::shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
-      execution_result = budget_key_timeframe_group->budget_key_timeframes.Find(
-          time_bucket, budget_key_timeframe);
-      if (execution_result != core::SuccessExecutionResult()) {
-        return execution_result;
-      }
-
-      auto loaded_frame = budget_key_timeframe_group_log_1_0.add_items();
-      loaded_frame->set_token_count(budget_key_timeframe->token_count);
-      loaded_frame->set_time_bucket(budget_key_timeframe->time_bucket_index);
-      loaded_frame->set_active_token_count(
-          budget_key_timeframe->active_token_count);
-      loaded_frame->set_time_bucket(budget_key_timeframe->time_bucket_index);
-      loaded_frame->mutable_active_transaction_id()->set_high(
-          budget_key_timeframe->active_transaction_id.load().high);
-      loaded_frame->mutable_active_transaction_id()->set_low(
-          budget_key_timeframe->active_transaction_id.load().low);
-    }
-
     size_t offset = 0;
     size_t bytes_serialized = 0;
     budget_key_timeframe_group_log_bytes_buffer =
@@ -601,6 +700,93 @@ class Serialization {
     return core::SuccessExecutionResult();
   }
 
+  /**
+   * @brief Populates the budget key timeframe 1_0 log of the timeframe.
+   *
+   * @param budget_key_timeframe The budget key timeframe.
+   * @param budget_key_timeframe_log_1_0 The log to populate.
+   */
+  static void PopulateBudgetKeyTimeframeLog_1_0(
+      const BudgetKeyTimeframe& budget_key_timeframe,
+      proto::BudgetKeyTimeframeLog_1_0& budget_key_timeframe_log_1_0) noexcept {
+    budget_key_timeframe_log_1_0.set_active_token_count(
+        budget_key_timeframe.active_token_count);
+    auto active_transaction_id =
+        budget_key_timeframe.active_transaction_id.load();
+    budget_key_timeframe_log_1_0.mutable_active_transaction_id()->set_high(
+        active_transaction_id.high);
+    budget_key_timeframe_log_1_0.mutable_active_transaction_id()->set_low(
+        active_transaction_id.low);
+    budget_key_timeframe_log_1_0.set_time_bucket(
+        budget_key_timeframe.time_bucket_index);
+    budget_key_timeframe_log_1_0.set_token_count(
+        budget_key_timeframe.token_count);
+  }
+
+  /**
+   * @brief Populates the budget key timeframe reservation 1_0 log.
+   *
+   * @param transaction_id The id of the transaction.
+   * @param reserved_tokens The time buckets and the number of tokens reserved
+   * from each.
+   * @param return_tokens Whether the tokens are given back.
+   * @param budget_key_timeframe_reservation_log_1_0 The log to populate.
+   */
+  static void PopulateBudgetKeyTimeframeReservationLog_1_0(
+      const core::common::Uuid& transaction_id,
+      const std::vector<std::pair<TimeBucket, TokenCount>>& reserved_tokens,
+      bool return_tokens,
+      proto::BudgetKeyTimeframeReservationLog_1_0&
+          budget_key_timeframe_reservation_log_1_0) noexcept {
+    budget_key_timeframe_reservation_log_1_0.mutable_transaction_id()->set_high(
+        transaction_id.high);
+    budget_key_timeframe_reservation_log_1_0.mutable_transaction_id()->set_low(
+        transaction_id.low);
+    for (const auto& [time_bucket, token_count] : reserved_tokens) {
+      auto item = budget_key_timeframe_reservation_log_1_0.add_items();
+      item->set_time_bucket(time_bucket);
+      item->set_token_count(token_count);
+    }
+    budget_key_timeframe_reservation_log_1_0.set_return_tokens(return_tokens);
+  }
+
+  /**
+   * @brief Populates the budget key timeframe group 1_0 log of the group.
+   *
+   * @param budget_key_timeframe_group The budget key timeframe group.
+   * @param budget_key_timeframe_group_log_1_0 The log to populate.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult PopulateBudgetKeyTimeframeGroupLog_1_0(
+      BudgetKeyTimeframeGroup& budget_key_timeframe_group,
+      proto::BudgetKeyTimeframeGroupLog_1_0&
+          budget_key_timeframe_group_log_1_0) noexcept {
+    budget_key_timeframe_group_log_1_0.set_time_group(
+        budget_key_timeframe_group.time_group);
+    std::vector<TimeBucket> time_buckets;
+    auto execution_result =
+        budget_key_timeframe_group.budget_key_timeframes.Keys(time_buckets);
+    if (execution_result != core::SuccessExecutionResult()) {
+      return execution_result;
+    }
+
+    budget_key_timeframe_group_log_1_0.mutable_items()->Reserve(
+        time_buckets.size());
+    for (auto time_bucket : time_buckets) {
+      std::shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
+      execution_result = budget_key_timeframe_group.budget_key_timeframes.Find(
+          time_bucket, budget_key_timeframe);
+      if (execution_result != core::SuccessExecutionResult()) {
+        return execution_result;
+      }
+      auto* budget_key_timeframe_log_1_0 =
+          budget_key_timeframe_group_log_1_0.add_items();
+      PopulateBudgetKeyTimeframeLog_1_0(*budget_key_timeframe,
+                                        *budget_key_timeframe_log_1_0);
+    }
+    return core::SuccessExecutionResult();
+  }
+
   /**
    * @brief Deserializes the budget key timeframe group from the provided
    * buffer.
@@ -633,11 +819,53 @@ class Serialization {
 
     budget_key_timeframe_group = std::make_shared<BudgetKeyTimeframeGroup>(
         budget_key_timeframe_group_log_1_0.time_group());
+    return InsertBudgetKeyTimeframes(budget_key_timeframe_group_log_1_0,
+                                     *budget_key_timeframe_group);
+  }
 
-    auto budget_key_timeframe_group_pair =
-        std::make_pair(budget_key_timeframe_group_log_1_0.time_group(),
-                       budget_key_timeframe_group);
+  /**
+   * @brief Deserializes the timeframes of a budget key timeframe group from
+   * the provided buffer into the group.
+   *
+   * @param budget_key_timeframe_group_log_str The buffer containing the
+   * serialized object.
+   * @param budget_key_timeframe_group The group to insert the timeframes into.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult DeserializeBudgetKeyTimeframeGroupLog_1_0(
+      const std::string& budget_key_timeframe_group_log_str,
+      BudgetKeyTimeframeGroup& budget_key_timeframe_group) noexcept {
+    proto::BudgetKeyTimeframeGroupLog_1_0 budget_key_timeframe_group_log_1_0;
+    if (budget_key_timeframe_group_log_str.length() == 0) {
+      return core::FailureExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_CORRUPTED_KEY_METADATA);
+    }
 
+    size_t bytes_deserialized = 0;
+    auto execution_result =
+        core::common::Serialization::DeserializeProtoMessage<
+            proto::BudgetKeyTimeframeGroupLog_1_0>(
+            budget_key_timeframe_group_log_str,
+            budget_key_timeframe_group_log_1_0, bytes_deserialized);
+    if (execution_result != core::SuccessExecutionResult()) {
+      return execution_result;
+    }
+    return InsertBudgetKeyTimeframes(budget_key_timeframe_group_log_1_0,
+                                     budget_key_timeframe_group);
+  }
+
+  /**
+   * @brief Inserts the timeframes of a deserialized budget key timeframe
+   * group log into the group.
+   *
+   * @param budget_key_timeframe_group_log_1_0 The deserialized log.
+   * @param budget_key_timeframe_group The group to insert the timeframes into.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult InsertBudgetKeyTimeframes(
+      const proto::BudgetKeyTimeframeGroupLog_1_0&
+          budget_key_timeframe_group_log_1_0,
+      BudgetKeyTimeframeGroup& budget_key_timeframe_group) noexcept {
     for (int items_index = 0;
          items_index < budget_key_timeframe_group_log_1_0.items().size();
          ++items_index) {
@@ -647,7 +875,7 @@ class Serialization {
       auto budget_key_timeframe_pair =
           std::make_pair(item.time_bucket(), budget_key_timeframe);
       auto execution_result =
-          budget_key_timeframe_group->budget_key_timeframes.Insert(
+          budget_key_timeframe_group.budget_key_timeframes.Insert(
               budget_key_timeframe_pair, budget_key_timeframe);
       if (execution_result != core::SuccessExecutionResult()) {
         if (execution_result.status_code !=
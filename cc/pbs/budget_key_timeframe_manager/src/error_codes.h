@@ -62,4 +62,10 @@ DEFINE_ERROR_CODE(
     "The budget key timeframe manager request does not have unique time "
     "buckets",
     HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_TRANSACTION_ID,
+                  SC_BUDGET_KEY_TIMEFRAME_MANAGER, 0x0009,
+                  "The budget key timeframe manager request has an invalid "
+                  "transaction id.",
+                  HttpStatusCode::BAD_REQUEST)
 }  // namespace google::scp::core::errors
@@ -3330,6 +3330,7 @@ TEST(BudgetKeyTimeframeManagerTest, Checkpoint) {
   auto time_group_1 = Utils::GetTimeGroup(reporting_time_1);
   auto budget_key_timeframe_group_1 =
       make_shared<BudgetKeyTimeframeGroup>(time_group_1);
+  budget_key_timeframe_group_1->is_loaded = true;
   auto timeframe_group_pair_1 =
       make_pair(time_group_1, budget_key_timeframe_group_1);
   budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Insert(
@@ -3348,6 +3349,7 @@ TEST(BudgetKeyTimeframeManagerTest, Checkpoint) {
   auto time_group_2 = Utils::GetTimeGroup(reporting_time_2);
   auto budget_key_timeframe_group_2 =
       make_shared<BudgetKeyTimeframeGroup>(time_group_2);
+  budget_key_timeframe_group_2->is_loaded = true;
   auto timeframe_group_pair_2 =
       make_pair(time_group_2, budget_key_timeframe_group_2);
   budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Insert(
@@ -3464,6 +3466,139 @@ TEST(BudgetKeyTimeframeManagerTest, Checkpoint) {
   }
 }
 
+TEST(BudgetKeyTimeframeManagerTest, CheckpointSkipsGroupsBeingLoaded) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  auto journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  Uuid id = Uuid::GenerateUuid();
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider =
+      make_shared<MockNoSQLDatabaseProviderNoOverrides>();
+
+  MockBudgetKeyTimeframeManager budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+
+  // The group is in the map while its timeframes are read from the database.
+  Timestamp reporting_time = 1660498765350482296;
+  auto time_group = Utils::GetTimeGroup(reporting_time);
+  auto budget_key_timeframe_group =
+      make_shared<BudgetKeyTimeframeGroup>(time_group);
+  auto timeframe_group_pair = make_pair(time_group, budget_key_timeframe_group);
+  budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Insert(
+      timeframe_group_pair, budget_key_timeframe_group);
+
+  auto logs = make_shared<list<CheckpointLog>>();
+  EXPECT_SUCCESS(budget_key_timeframe_manager.Checkpoint(logs));
+  EXPECT_EQ(logs->size(), 0);
+
+  budget_key_timeframe_group->is_loaded = true;
+  EXPECT_SUCCESS(budget_key_timeframe_manager.Checkpoint(logs));
+  EXPECT_EQ(logs->size(), 1);
+}
+
+TEST(BudgetKeyTimeframeManagerTest, LazyRecoveryAndCheckpoint) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  auto lazy_mock_config_provider = make_shared<MockConfigProvider>();
+  lazy_mock_config_provider->SetBool(
+      kBudgetKeyTimeframeManagerLazyRecoveryEnabled, true);
+  auto journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  Uuid id = Uuid::GenerateUuid();
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider =
+      make_shared<MockNoSQLDatabaseProviderNoOverrides>();
+
+  MockBudgetKeyTimeframeManager budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+
+  Timestamp reporting_time = 1660498765350482296;
+  auto time_group = Utils::GetTimeGroup(reporting_time);
+  auto time_bucket = Utils::GetTimeBucket(reporting_time);
+  auto budget_key_timeframe_group =
+      make_shared<BudgetKeyTimeframeGroup>(time_group);
+  budget_key_timeframe_group->is_loaded = true;
+  auto timeframe_group_pair = make_pair(time_group, budget_key_timeframe_group);
+  budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Insert(
+      timeframe_group_pair, budget_key_timeframe_group);
+  auto timeframe = make_shared<BudgetKeyTimeframe>(time_bucket);
+  timeframe->token_count = 23;
+  auto pair = make_pair(time_bucket, timeframe);
+  budget_key_timeframe_group->budget_key_timeframes.Insert(pair, timeframe);
+
+  auto logs = make_shared<list<CheckpointLog>>();
+  EXPECT_EQ(budget_key_timeframe_manager.Checkpoint(logs),
+            SuccessExecutionResult());
+  EXPECT_EQ(logs->size(), 1);
+
+  MockBudgetKeyTimeframeManager lazy_budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      lazy_mock_config_provider);
+  EXPECT_SUCCESS(lazy_budget_key_timeframe_manager.Init());
+  EXPECT_SUCCESS(
+      lazy_budget_key_timeframe_manager.OnJournalServiceRecoverCallback(
+          make_shared<BytesBuffer>(logs->begin()->bytes_buffer),
+          kDefaultUuid));
+
+  // The recovered group keeps its timeframes serialized.
+  shared_ptr<BudgetKeyTimeframeGroup> lazy_budget_key_timeframe_group;
+  EXPECT_SUCCESS(
+      lazy_budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Find(
+          time_group, lazy_budget_key_timeframe_group));
+  EXPECT_TRUE(lazy_budget_key_timeframe_group->has_serialized_timeframes);
+  vector<TimeBucket> time_buckets;
+  lazy_budget_key_timeframe_group->budget_key_timeframes.Keys(time_buckets);
+  EXPECT_EQ(time_buckets.size(), 0);
+
+  // Checkpointing the untouched group does not materialize it, and the
+  // checkpoint recovers to the original timeframes.
+  auto lazy_logs = make_shared<list<CheckpointLog>>();
+  EXPECT_SUCCESS(lazy_budget_key_timeframe_manager.Checkpoint(lazy_logs));
+  EXPECT_EQ(lazy_logs->size(), 1);
+  EXPECT_TRUE(lazy_budget_key_timeframe_group->has_serialized_timeframes);
+
+  MockBudgetKeyTimeframeManager recovery_budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+  EXPECT_SUCCESS(
+      recovery_budget_key_timeframe_manager.OnJournalServiceRecoverCallback(
+          make_shared<BytesBuffer>(lazy_logs->begin()->bytes_buffer),
+          kDefaultUuid));
+  shared_ptr<BudgetKeyTimeframeGroup> recovered_budget_key_timeframe_group;
+  EXPECT_SUCCESS(
+      recovery_budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Find(
+          time_group, recovered_budget_key_timeframe_group));
+  shared_ptr<BudgetKeyTimeframe> recovered_timeframe;
+  EXPECT_SUCCESS(recovered_budget_key_timeframe_group->budget_key_timeframes
+                     .Find(time_bucket, recovered_timeframe));
+  EXPECT_EQ(recovered_timeframe->token_count, 23);
+
+  // The first access materializes the timeframes.
+  EXPECT_SUCCESS(MockBudgetKeyTimeframeManager::MaterializeTimeframeGroup(
+      lazy_budget_key_timeframe_group));
+  EXPECT_FALSE(lazy_budget_key_timeframe_group->has_serialized_timeframes);
+  EXPECT_EQ(lazy_budget_key_timeframe_group->serialized_timeframes, nullptr);
+  shared_ptr<BudgetKeyTimeframe> lazy_timeframe;
+  EXPECT_SUCCESS(lazy_budget_key_timeframe_group->budget_key_timeframes.Find(
+      time_bucket, lazy_timeframe));
+  EXPECT_EQ(lazy_timeframe->token_count, 23);
+}
+
 TEST(BudgetKeyTimeframeManagerTest, CanUnload) {
   auto mock_journal_service = make_shared<MockJournalService>();
   auto mock_metric_client = make_shared<MockMetricClient>();
@@ -3500,7 +3635,7 @@ TEST(BudgetKeyTimeframeManagerTest, CanUnload) {
   timeframe->active_token_count = 1;
   timeframe->token_count = 23;
   timeframe->active_transaction_id = core::common::kZeroUuid;
-  auto pair = make_pair(reporting_time, timeframe);
+  auto pair = make_pair(time_bucket, timeframe);
   timeframe_group->budget_key_timeframes.Insert(pair, timeframe);
 
   EXPECT_EQ(
@@ -3806,4 +3941,449 @@ TEST(BudgetKeyTimeframeManagerTest, OTelReturnsCorrectBudgetKeyUnloads) {
   EXPECT_EQ(std::get<int64_t>(budget_key_unload_sum_point_data.value_), 1);
 }
 
+TEST(BudgetKeyTimeframeManagerTest, BudgetKeyTimeframeArrayInsertFindErase) {
+  BudgetKeyTimeframeGroup budget_key_timeframe_group(0);
+  auto& budget_key_timeframes =
+      budget_key_timeframe_group.budget_key_timeframes;
+
+  vector<TimeBucket> time_buckets;
+  EXPECT_SUCCESS(budget_key_timeframes.Keys(time_buckets));
+  EXPECT_TRUE(time_buckets.empty());
+
+  shared_ptr<BudgetKeyTimeframe> budget_key_timeframe;
+  EXPECT_THAT(budget_key_timeframes.Find(3, budget_key_timeframe),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
+
+  auto timeframe = make_shared<BudgetKeyTimeframe>(3);
+  timeframe->token_count = 7;
+  timeframe->active_token_count = 2;
+  auto active_transaction_id = Uuid::GenerateUuid();
+  timeframe->active_transaction_id = active_transaction_id;
+  auto pair = make_pair(3, timeframe);
+  EXPECT_SUCCESS(budget_key_timeframes.Insert(pair, budget_key_timeframe));
+  EXPECT_EQ(budget_key_timeframe->time_bucket_index, 3);
+  EXPECT_EQ(budget_key_timeframe->token_count, 7);
+  EXPECT_EQ(budget_key_timeframe->active_token_count, 2);
+  EXPECT_EQ(budget_key_timeframe->active_transaction_id.load(),
+            active_transaction_id);
+
+  shared_ptr<BudgetKeyTimeframe> existing_budget_key_timeframe;
+  auto other_pair = make_pair(3, make_shared<BudgetKeyTimeframe>(3));
+  EXPECT_THAT(budget_key_timeframes.Insert(other_pair,
+                                           existing_budget_key_timeframe),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS)));
+  EXPECT_EQ(existing_budget_key_timeframe, budget_key_timeframe);
+
+  shared_ptr<BudgetKeyTimeframe> null_timeframe;
+  auto zeroed_pair = make_pair(23, null_timeframe);
+  shared_ptr<BudgetKeyTimeframe> zeroed_budget_key_timeframe;
+  EXPECT_SUCCESS(
+      budget_key_timeframes.Insert(zeroed_pair, zeroed_budget_key_timeframe));
+  EXPECT_EQ(zeroed_budget_key_timeframe->time_bucket_index, 23);
+  EXPECT_EQ(zeroed_budget_key_timeframe->token_count, 0);
+  EXPECT_EQ(zeroed_budget_key_timeframe->active_transaction_id.load(),
+            core::common::kZeroUuid);
+
+  auto out_of_range_pair = make_pair(24, timeframe);
+  EXPECT_THAT(budget_key_timeframes.Insert(out_of_range_pair,
+                                           existing_budget_key_timeframe),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
+
+  EXPECT_SUCCESS(budget_key_timeframes.Keys(time_buckets));
+  EXPECT_EQ(time_buckets, (vector<TimeBucket>{3, 23}));
+
+  EXPECT_SUCCESS(budget_key_timeframes.Erase(3));
+  EXPECT_THAT(budget_key_timeframes.Erase(3),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
+  EXPECT_THAT(budget_key_timeframes.Find(3, existing_budget_key_timeframe),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST)));
+  EXPECT_SUCCESS(budget_key_timeframes.Keys(time_buckets));
+  EXPECT_EQ(time_buckets, (vector<TimeBucket>{23}));
+
+  // The erased hour is inserted again in its slot, so the holders of the
+  // erased timeframe see the inserted values.
+  timeframe->token_count = 11;
+  EXPECT_SUCCESS(
+      budget_key_timeframes.Insert(pair, existing_budget_key_timeframe));
+  EXPECT_EQ(existing_budget_key_timeframe, budget_key_timeframe);
+  EXPECT_EQ(budget_key_timeframe->token_count, 11);
+}
+
+TEST(BudgetKeyTimeframeManagerTest, ReserveAndRelease) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  vector<BytesBuffer> journaled_logs;
+  mock_journal_service->log_mock =
+      [&](AsyncContext<JournalLogRequest, JournalLogResponse>& log_context) {
+        journaled_logs.push_back(*log_context.request->data);
+        log_context.result = SuccessExecutionResult();
+        log_context.Finish();
+        return SuccessExecutionResult();
+      };
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  auto journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  Uuid id = Uuid::GenerateUuid();
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider =
+      make_shared<MockNoSQLDatabaseProviderNoOverrides>();
+
+  MockBudgetKeyTimeframeManager budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+
+  Timestamp reporting_time = 1660498765350482296;
+  auto time_group = Utils::GetTimeGroup(reporting_time);
+  auto time_bucket = Utils::GetTimeBucket(reporting_time);
+  auto budget_key_timeframe_group =
+      make_shared<BudgetKeyTimeframeGroup>(time_group);
+  budget_key_timeframe_group->is_loaded = true;
+  auto timeframe_group_pair = make_pair(time_group, budget_key_timeframe_group);
+  budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Insert(
+      timeframe_group_pair, budget_key_timeframe_group);
+  auto timeframe = make_shared<BudgetKeyTimeframe>(time_bucket);
+  timeframe->token_count = 5;
+  auto pair = make_pair(time_bucket, timeframe);
+  budget_key_timeframe_group->budget_key_timeframes.Insert(pair, timeframe);
+
+  auto reserve = [&](const Uuid& transaction_id, TokenCount token_count) {
+    AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                 ReserveBudgetKeyTimeframeResponse>
+        reserve_context;
+    reserve_context.request = make_shared<ReserveBudgetKeyTimeframeRequest>();
+    reserve_context.request->transaction_id = transaction_id;
+    reserve_context.request->timeframes_to_reserve.push_back(
+        {.reporting_time = reporting_time, .token_count = token_count});
+    shared_ptr<ReserveBudgetKeyTimeframeResponse> response;
+    reserve_context.callback = [&](auto& reserve_context) {
+      EXPECT_SUCCESS(reserve_context.result);
+      response = reserve_context.response;
+    };
+    EXPECT_SUCCESS(budget_key_timeframe_manager.Reserve(reserve_context));
+    return response;
+  };
+  auto release = [&](const Uuid& transaction_id, bool return_tokens) {
+    AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                 ReleaseBudgetKeyTimeframeResponse>
+        release_context;
+    release_context.request = make_shared<ReleaseBudgetKeyTimeframeRequest>();
+    release_context.request->transaction_id = transaction_id;
+    release_context.request->return_tokens = return_tokens;
+    shared_ptr<ReleaseBudgetKeyTimeframeResponse> response;
+    release_context.callback = [&](auto& release_context) {
+      EXPECT_SUCCESS(release_context.result);
+      response = release_context.response;
+    };
+    EXPECT_SUCCESS(budget_key_timeframe_manager.Release(release_context));
+    return response;
+  };
+
+  // Two transactions reserve tokens of the same timeframe.
+  auto transaction_id_1 = Uuid::GenerateUuid();
+  auto transaction_id_2 = Uuid::GenerateUuid();
+  EXPECT_EQ(reserve(transaction_id_1, 3)->status,
+            BudgetKeyTimeframeReservationStatus::Done);
+  EXPECT_EQ(reserve(transaction_id_2, 1)->status,
+            BudgetKeyTimeframeReservationStatus::Done);
+  EXPECT_EQ(timeframe->token_count, 1);
+  EXPECT_EQ(timeframe->reserving_transaction_count, 2);
+  EXPECT_EQ(journaled_logs.size(), 2);
+
+  // Reserving again for a transaction is a no-op.
+  EXPECT_EQ(reserve(transaction_id_1, 3)->status,
+            BudgetKeyTimeframeReservationStatus::Done);
+  EXPECT_EQ(timeframe->token_count, 1);
+  EXPECT_EQ(journaled_logs.size(), 2);
+
+  auto insufficient_budget_response = reserve(Uuid::GenerateUuid(), 2);
+  EXPECT_EQ(insufficient_budget_response->status,
+            BudgetKeyTimeframeReservationStatus::InsufficientBudget);
+  EXPECT_EQ(insufficient_budget_response->insufficient_budget_indices,
+            (vector<size_t>{0}));
+
+  timeframe->active_transaction_id = Uuid::GenerateUuid();
+  EXPECT_EQ(reserve(Uuid::GenerateUuid(), 1)->status,
+            BudgetKeyTimeframeReservationStatus::Conflict);
+  timeframe->active_transaction_id = core::common::kZeroUuid;
+  EXPECT_EQ(timeframe->token_count, 1);
+  EXPECT_EQ(timeframe->reserving_transaction_count, 2);
+  EXPECT_EQ(journaled_logs.size(), 2);
+
+  // The timeframe cannot be unloaded while tokens are reserved.
+  bool should_delete = true;
+  budget_key_timeframe_manager.OnBeforeGarbageCollection(
+      time_group, budget_key_timeframe_group,
+      [&](bool should_delete_entry) { should_delete = should_delete_entry; });
+  EXPECT_FALSE(should_delete);
+
+  // The checkpoint recovers to the same reservations.
+  auto logs = make_shared<list<CheckpointLog>>();
+  EXPECT_SUCCESS(budget_key_timeframe_manager.Checkpoint(logs));
+  EXPECT_EQ(logs->size(), 3);
+
+  MockBudgetKeyTimeframeManager recovery_budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+  for (const auto& log : *logs) {
+    EXPECT_SUCCESS(
+        recovery_budget_key_timeframe_manager.OnJournalServiceRecoverCallback(
+            make_shared<BytesBuffer>(log.bytes_buffer), kDefaultUuid));
+  }
+  // Replaying a reservation already in the checkpoint is a no-op.
+  EXPECT_SUCCESS(
+      recovery_budget_key_timeframe_manager.OnJournalServiceRecoverCallback(
+          make_shared<BytesBuffer>(journaled_logs[0]), kDefaultUuid));
+  shared_ptr<BudgetKeyTimeframeGroup> recovered_budget_key_timeframe_group;
+  EXPECT_SUCCESS(
+      recovery_budget_key_timeframe_manager.GetBudgetTimeframeGroups()->Find(
+          time_group, recovered_budget_key_timeframe_group));
+  shared_ptr<BudgetKeyTimeframe> recovered_timeframe;
+  EXPECT_SUCCESS(recovered_budget_key_timeframe_group->budget_key_timeframes
+                     .Find(time_bucket, recovered_timeframe));
+  EXPECT_EQ(recovered_timeframe->token_count, 1);
+  EXPECT_EQ(recovered_timeframe->reserving_transaction_count, 2);
+
+  // One transaction consumes its tokens and the other one gives them back.
+  EXPECT_EQ(release(transaction_id_1, false)->status,
+            BudgetKeyTimeframeReservationStatus::Done);
+  EXPECT_EQ(release(transaction_id_2, true)->status,
+            BudgetKeyTimeframeReservationStatus::Done);
+  EXPECT_EQ(timeframe->token_count, 2);
+  EXPECT_EQ(timeframe->reserving_transaction_count, 0);
+  EXPECT_EQ(journaled_logs.size(), 4);
+
+  // Releasing again is a no-op.
+  EXPECT_EQ(release(transaction_id_1, false)->status,
+            BudgetKeyTimeframeReservationStatus::Done);
+  EXPECT_EQ(journaled_logs.size(), 4);
+
+  for (size_t i = 2; i < journaled_logs.size(); i++) {
+    EXPECT_SUCCESS(
+        recovery_budget_key_timeframe_manager.OnJournalServiceRecoverCallback(
+            make_shared<BytesBuffer>(journaled_logs[i]), kDefaultUuid));
+  }
+  EXPECT_EQ(recovered_timeframe->token_count, 2);
+  EXPECT_EQ(recovered_timeframe->reserving_transaction_count, 0);
+}
+
+TEST(BudgetKeyTimeframeManagerTest, ReserveWithInvalidRequestIsDisallowed) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  auto journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider =
+      make_shared<MockNoSQLDatabaseProviderNoOverrides>();
+
+  MockBudgetKeyTimeframeManager budget_key_timeframe_manager(
+      budget_key_name, Uuid::GenerateUuid(), async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+
+  AsyncContext<ReserveBudgetKeyTimeframeRequest,
+               ReserveBudgetKeyTimeframeResponse>
+      reserve_context;
+  reserve_context.request = make_shared<ReserveBudgetKeyTimeframeRequest>();
+  reserve_context.request->transaction_id = Uuid::GenerateUuid();
+  EXPECT_THAT(budget_key_timeframe_manager.Reserve(reserve_context),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_EMPTY_REQUEST)));
+
+  Timestamp reporting_time = 1660498765350482296;
+  reserve_context.request->timeframes_to_reserve.push_back(
+      {.reporting_time = reporting_time, .token_count = 1});
+  reserve_context.request->timeframes_to_reserve.push_back(
+      {.reporting_time = reporting_time, .token_count = 1});
+  EXPECT_THAT(
+      budget_key_timeframe_manager.Reserve(reserve_context),
+      ResultIs(FailureExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_REPEATED_TIMEBUCKETS)));
+
+  reserve_context.request->timeframes_to_reserve.back().reporting_time +=
+      kNanosecondsPerHour * 24;
+  EXPECT_THAT(budget_key_timeframe_manager.Reserve(reserve_context),
+              ResultIs(FailureExecutionResult(
+                  core::errors::
+                      SC_BUDGET_KEY_TIMEFRAME_MANAGER_MULTIPLE_TIMEFRAME_GROUPS)));
+
+  reserve_context.request->transaction_id = core::common::kZeroUuid;
+  EXPECT_THAT(
+      budget_key_timeframe_manager.Reserve(reserve_context),
+      ResultIs(FailureExecutionResult(
+          core::errors::
+              SC_BUDGET_KEY_TIMEFRAME_MANAGER_INVALID_TRANSACTION_ID)));
+}
+
+
+TEST(BudgetKeyTimeframeManagerTest, LoadsOfAGroupBeingLoadedWaitForTheLoad) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->Set(kBudgetKeyTableName, string("PBS_BudgetKeys"));
+  mock_config_provider->SetBool(kBudgetKeyTimeframeManagerLoadCoalescingEnabled,
+                                true);
+  auto journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  Uuid id = Uuid::GenerateUuid();
+  auto mock_nosql_database_provider = make_shared<MockNoSQLDatabaseProvider>();
+  vector<AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>>
+      get_database_item_contexts;
+  mock_nosql_database_provider->get_database_item_mock =
+      [&](AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+              get_database_item_context) {
+        get_database_item_contexts.push_back(get_database_item_context);
+        return SuccessExecutionResult();
+      };
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider =
+      mock_nosql_database_provider;
+  MockBudgetKeyTimeframeManager budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+  EXPECT_SUCCESS(budget_key_timeframe_manager.Init());
+
+  Timestamp reporting_time = 1660498765350482296;
+  vector<ExecutionResult> results;
+  vector<shared_ptr<LoadBudgetKeyTimeframeResponse>> responses;
+  auto load = [&]() {
+    AsyncContext<LoadBudgetKeyTimeframeRequest, LoadBudgetKeyTimeframeResponse>
+        load_budget_key_timeframe_context;
+    load_budget_key_timeframe_context.request =
+        make_shared<LoadBudgetKeyTimeframeRequest>();
+    load_budget_key_timeframe_context.request->reporting_times = {
+        reporting_time};
+    load_budget_key_timeframe_context.callback =
+        [&](AsyncContext<LoadBudgetKeyTimeframeRequest,
+                         LoadBudgetKeyTimeframeResponse>&
+                load_budget_key_timeframe_context) {
+          results.push_back(load_budget_key_timeframe_context.result);
+          responses.push_back(load_budget_key_timeframe_context.response);
+        };
+    return budget_key_timeframe_manager.Load(load_budget_key_timeframe_context);
+  };
+
+  // Only the first load reads the database, the others wait for it.
+  EXPECT_SUCCESS(load());
+  EXPECT_SUCCESS(load());
+  EXPECT_SUCCESS(load());
+  ASSERT_EQ(get_database_item_contexts.size(), 1);
+  EXPECT_TRUE(results.empty());
+
+  get_database_item_contexts[0].result = FailureExecutionResult(
+      core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
+  get_database_item_contexts[0].Finish();
+
+  ASSERT_EQ(results.size(), 3);
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_SUCCESS(results[i]);
+    ASSERT_EQ(responses[i]->budget_key_frames.size(), 1);
+    EXPECT_EQ(responses[i]->budget_key_frames[0]->token_count, kMaxToken);
+  }
+
+  // The group is loaded, so the next load completes right away.
+  EXPECT_SUCCESS(load());
+  EXPECT_EQ(results.size(), 4);
+  EXPECT_EQ(get_database_item_contexts.size(), 1);
+}
+
+TEST(BudgetKeyTimeframeManagerTest, LoadsWaitingForAFailedLoadAreRetried) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->Set(kBudgetKeyTableName, string("PBS_BudgetKeys"));
+  mock_config_provider->SetBool(kBudgetKeyTimeframeManagerLoadCoalescingEnabled,
+                                true);
+  mock_config_provider->SetInt(
+      kBudgetKeyTimeframeManagerRecordNotFoundCacheTtlInMilliseconds, 60000);
+  auto journal_service =
+      static_pointer_cast<JournalServiceInterface>(mock_journal_service);
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto budget_key_name = make_shared<string>("budget_key_name");
+  Uuid id = Uuid::GenerateUuid();
+  auto mock_nosql_database_provider = make_shared<MockNoSQLDatabaseProvider>();
+  vector<AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>>
+      get_database_item_contexts;
+  mock_nosql_database_provider->get_database_item_mock =
+      [&](AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse>&
+              get_database_item_context) {
+        get_database_item_contexts.push_back(get_database_item_context);
+        return SuccessExecutionResult();
+      };
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider =
+      mock_nosql_database_provider;
+  MockBudgetKeyTimeframeManager budget_key_timeframe_manager(
+      budget_key_name, id, async_executor, journal_service,
+      nosql_database_provider, mock_metric_client, /*metric_router=*/nullptr,
+      mock_config_provider);
+  EXPECT_SUCCESS(budget_key_timeframe_manager.Init());
+
+  Timestamp reporting_time = 1660498765350482296;
+  vector<ExecutionResult> results;
+  auto load = [&]() {
+    AsyncContext<LoadBudgetKeyTimeframeRequest, LoadBudgetKeyTimeframeResponse>
+        load_budget_key_timeframe_context;
+    load_budget_key_timeframe_context.request =
+        make_shared<LoadBudgetKeyTimeframeRequest>();
+    load_budget_key_timeframe_context.request->reporting_times = {
+        reporting_time};
+    load_budget_key_timeframe_context.callback =
+        [&](AsyncContext<LoadBudgetKeyTimeframeRequest,
+                         LoadBudgetKeyTimeframeResponse>&
+                load_budget_key_timeframe_context) {
+          results.push_back(load_budget_key_timeframe_context.result);
+        };
+    return budget_key_timeframe_manager.Load(load_budget_key_timeframe_context);
+  };
+
+  mock_journal_service->log_mock =
+      [&](AsyncContext<JournalLogRequest, JournalLogResponse>& log_context) {
+        log_context.result = FailureExecutionResult(123);
+        log_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_SUCCESS(load());
+  EXPECT_SUCCESS(load());
+  ASSERT_EQ(get_database_item_contexts.size(), 1);
+
+  get_database_item_contexts[0].result = FailureExecutionResult(
+      core::errors::SC_NO_SQL_DATABASE_PROVIDER_RECORD_NOT_FOUND);
+  get_database_item_contexts[0].Finish();
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_THAT(results[0], ResultIs(FailureExecutionResult(123)));
+  EXPECT_THAT(
+      results[1],
+      ResultIs(RetryExecutionResult(
+          core::errors::SC_BUDGET_KEY_TIMEFRAME_MANAGER_ENTRY_IS_LOADING)));
+
+  // The group was just found missing from the database, so it is not read
+  // again when reloaded.
+  mock_journal_service->log_mock = nullptr;
+  EXPECT_SUCCESS(load());
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_SUCCESS(results[2]);
+  EXPECT_EQ(get_database_item_contexts.size(), 1);
+}
+
 }  // namespace google::scp::pbs::test
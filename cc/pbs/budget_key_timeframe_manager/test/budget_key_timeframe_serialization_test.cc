@@ -33,6 +33,7 @@
 #include "pbs/budget_key_timeframe_manager/src/budget_key_timeframe_utils.h"
 #include "pbs/budget_key_timeframe_manager/src/error_codes.h"
 #include "pbs/budget_key_timeframe_manager/src/proto/budget_key_timeframe_manager.pb.h"
+#include "public/core/test/interface/execution_result_matchers.h"
 
 using google::scp::core::BytesBuffer;
 using google::scp::core::ExecutionResult;
@@ -220,25 +221,25 @@ TEST(BudgetKeyTimeframeManagerTest,
 
 TEST(BudgetKeyTimeframeManagerTest, SerializeBudgetKeyTimeframeGroupLog_1_0) {
   TimeGroup time_group = 1234;
-  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(1234);
+  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(12);
   budget_key_timeframe->active_token_count = 24;
   budget_key_timeframe->token_count = 13;
   budget_key_timeframe->active_transaction_id = Uuid::GenerateUuid();
 
-  auto budget_key_timeframe_2 = make_shared<BudgetKeyTimeframe>(345);
+  auto budget_key_timeframe_2 = make_shared<BudgetKeyTimeframe>(3);
   budget_key_timeframe_2->active_token_count = 12;
   budget_key_timeframe_2->token_count = 3;
   budget_key_timeframe_2->active_transaction_id = Uuid::GenerateUuid();
 
   auto budget_key_timeframe_group =
       make_shared<BudgetKeyTimeframeGroup>(time_group);
-  auto pair = make_pair(1234, budget_key_timeframe);
+  auto pair = make_pair(12, budget_key_timeframe);
   budget_key_timeframe_group->budget_key_timeframes.Insert(
       pair, budget_key_timeframe);
 
-  auto pair_2 = make_pair(345, budget_key_timeframe_2);
+  auto pair_2 = make_pair(3, budget_key_timeframe_2);
   budget_key_timeframe_group->budget_key_timeframes.Insert(
-      pair, budget_key_timeframe_2);
+      pair_2, budget_key_timeframe_2);
 
   BytesBuffer output_log;
   EXPECT_EQ(Serialization::SerializeBudgetKeyTimeframeGroupLog_1_0(
@@ -389,25 +390,25 @@ TEST(BudgetKeyTimeframeManagerTest, SerializeBatchBudgetKeyTimeframeLog) {
 
 TEST(BudgetKeyTimeframeManagerTest, SerializeBudgetKeyTimeframeGroupLog) {
   TimeGroup time_group = 1234;
-  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(1234);
+  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(12);
   budget_key_timeframe->active_token_count = 24;
   budget_key_timeframe->token_count = 13;
   budget_key_timeframe->active_transaction_id = Uuid::GenerateUuid();
 
-  auto budget_key_timeframe_2 = make_shared<BudgetKeyTimeframe>(345);
+  auto budget_key_timeframe_2 = make_shared<BudgetKeyTimeframe>(3);
   budget_key_timeframe_2->active_token_count = 12;
   budget_key_timeframe_2->token_count = 3;
   budget_key_timeframe_2->active_transaction_id = Uuid::GenerateUuid();
 
   auto budget_key_timeframe_group =
       make_shared<BudgetKeyTimeframeGroup>(time_group);
-  auto pair = make_pair(1234, budget_key_timeframe);
+  auto pair = make_pair(12, budget_key_timeframe);
   budget_key_timeframe_group->budget_key_timeframes.Insert(
       pair, budget_key_timeframe);
 
-  auto pair_2 = make_pair(345, budget_key_timeframe_2);
+  auto pair_2 = make_pair(3, budget_key_timeframe_2);
   budget_key_timeframe_group->budget_key_timeframes.Insert(
-      pair, budget_key_timeframe_2);
+      pair_2, budget_key_timeframe_2);
 
   BytesBuffer output_log;
   EXPECT_EQ(Serialization::SerializeBudgetKeyTimeframeGroupLog(
@@ -465,6 +466,94 @@ TEST(BudgetKeyTimeframeManagerTest, SerializeBudgetKeyTimeframeGroupLog) {
   }
 }
 
+namespace {
+// The log serialized the way it was before the logs were serialized in a
+// single pass, with a log body serialized first.
+string SerializeLogInTwoPasses(OperationType operation_type,
+                               TimeGroup time_group, const string& log_body) {
+  BudgetKeyTimeframeManagerLog_1_0 budget_key_timeframe_manager_log_1_0;
+  budget_key_timeframe_manager_log_1_0.set_operation_type(operation_type);
+  budget_key_timeframe_manager_log_1_0.set_time_group(time_group);
+  budget_key_timeframe_manager_log_1_0.set_log_body(log_body);
+  BudgetKeyTimeframeManagerLog budget_key_timeframe_manager_log;
+  budget_key_timeframe_manager_log.mutable_version()->set_major(1);
+  budget_key_timeframe_manager_log.mutable_version()->set_minor(0);
+  budget_key_timeframe_manager_log.set_log_body(
+      budget_key_timeframe_manager_log_1_0.SerializeAsString());
+  return budget_key_timeframe_manager_log.SerializeAsString();
+}
+
+string ToString(const BytesBuffer& bytes_buffer) {
+  return string(bytes_buffer.bytes->data(), bytes_buffer.length);
+}
+}  // namespace
+
+TEST(BudgetKeyTimeframeManagerTest, SinglePassLogsMatchTwoPassLogs) {
+  TimeGroup time_group = 1234;
+  auto budget_key_timeframe_group =
+      make_shared<BudgetKeyTimeframeGroup>(time_group);
+  vector<shared_ptr<BudgetKeyTimeframe>> budget_key_timeframes;
+  for (TimeBucket time_bucket = 0; time_bucket < 24; ++time_bucket) {
+    auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(time_bucket);
+    budget_key_timeframe->token_count = time_bucket;
+    budget_key_timeframe->active_token_count = 1;
+    budget_key_timeframe->active_transaction_id = Uuid::GenerateUuid();
+    auto pair = make_pair(time_bucket, budget_key_timeframe);
+    EXPECT_SUCCESS(budget_key_timeframe_group->budget_key_timeframes.Insert(
+        pair, budget_key_timeframe));
+    budget_key_timeframes.push_back(budget_key_timeframe);
+  }
+
+  BytesBuffer log_body;
+  BytesBuffer output_log;
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeLog_1_0(
+      budget_key_timeframes[3], log_body));
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeLog(
+      time_group, budget_key_timeframes[3], output_log));
+  EXPECT_EQ(ToString(output_log),
+            SerializeLogInTwoPasses(OperationType::UPDATE_TIMEFRAME_RECORD,
+                                    time_group, ToString(log_body)));
+
+  EXPECT_SUCCESS(Serialization::SerializeBatchBudgetKeyTimeframeLog_1_0(
+      budget_key_timeframes, log_body));
+  EXPECT_SUCCESS(Serialization::SerializeBatchBudgetKeyTimeframeLog(
+      time_group, budget_key_timeframes, output_log));
+  EXPECT_EQ(ToString(output_log),
+            SerializeLogInTwoPasses(
+                OperationType::BATCH_UPDATE_TIMEFRAME_RECORDS_OF_TIMEGROUP,
+                time_group, ToString(log_body)));
+
+  auto transaction_id = Uuid::GenerateUuid();
+  vector<std::pair<TimeBucket, TokenCount>> reserved_tokens = {{1, 2}, {3, 4}};
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeReservationLog_1_0(
+      transaction_id, reserved_tokens, false, log_body));
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeReservationLog(
+      time_group, OperationType::RESERVE_TIMEFRAME_TOKENS, transaction_id,
+      reserved_tokens, false, output_log));
+  EXPECT_EQ(ToString(output_log),
+            SerializeLogInTwoPasses(OperationType::RESERVE_TIMEFRAME_TOKENS,
+                                    time_group, ToString(log_body)));
+
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeGroupLog_1_0(
+      budget_key_timeframe_group, log_body));
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeGroupLog(
+      budget_key_timeframe_group, output_log));
+  EXPECT_EQ(ToString(output_log),
+            SerializeLogInTwoPasses(OperationType::INSERT_TIMEGROUP_INTO_CACHE,
+                                    time_group, ToString(log_body)));
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeGroupLog(
+      time_group, log_body.bytes->data(), log_body.length, output_log));
+  EXPECT_EQ(ToString(output_log),
+            SerializeLogInTwoPasses(OperationType::INSERT_TIMEGROUP_INTO_CACHE,
+                                    time_group, ToString(log_body)));
+
+  EXPECT_SUCCESS(Serialization::SerializeBudgetKeyTimeframeGroupRemoval(
+      budget_key_timeframe_group, output_log));
+  EXPECT_EQ(ToString(output_log),
+            SerializeLogInTwoPasses(OperationType::REMOVE_TIMEGROUP_FROM_CACHE,
+                                    time_group, ""));
+}
+
 TEST(BudgetKeyTimeframeManagerTest, SerializeHourTokensInTimeGroup) {
   for (int i = 0; i < 240; i++) {
     vector<TokenCount> tokens(i, 1);
@@ -290,6 +290,18 @@ void BatchConsumeBudgetTransactionProtocol::OnCommitBudgetKeyLoaded(
       return;
     }
 
+    // Tokens of the timeframe are reserved by other transactions, which only
+    // happens while its active transaction id is not set.
+    if (budget_key_timeframes[i]->reserving_transaction_count.load() != 0) {
+      TransactionProtocolHelpers::ReleaseAcquiredLocksOnTimeframes(
+          commit_batch_consume_budget_context.request->transaction_id,
+          budget_key_timeframes);
+      commit_batch_consume_budget_context.result = RetryExecutionResult(
+          core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
+      commit_batch_consume_budget_context.Finish();
+      return;
+    }
+
     // Budget check needs to happen. There is a chance that a write operation
     // has happened between this request's prepare and commit phases.
     if (budget_key_timeframes[i]->token_count <
@@ -16,10 +16,14 @@
 
 #include "consume_budget_transaction_protocol.h"
 
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
+#include "core/common/time_provider/src/time_provider.h"
+
 #include "error_codes.h"
 
 using google::scp::core::AsyncContext;
@@ -27,10 +31,15 @@ using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::TimeDuration;
 using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
 using std::bind;
+using std::function;
+using std::lock_guard;
 using std::make_shared;
 using std::move;
+using std::mutex;
 using std::shared_ptr;
 using std::string;
 using std::placeholders::_1;
@@ -77,6 +86,14 @@ void ConsumeBudgetTransactionProtocol::OnPrepareBudgetKeyLoaded(
   // 1) Ensure there is no active write operation happening.
   // 2) Enough budget is available for the proposed operation.
   if (budget_key_frame->active_transaction_id.load() != kZeroUuid) {
+    if (WaitForTimeframeRelease(
+            prepare_consume_budget_context.request->time_bucket,
+            budget_key_frame, prepare_consume_budget_context,
+            [this, prepare_consume_budget_context]() mutable {
+              return Prepare(prepare_consume_budget_context);
+            })) {
+      return;
+    }
     prepare_consume_budget_context.result = RetryExecutionResult(
         core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
     prepare_consume_budget_context.Finish();
@@ -146,11 +163,34 @@ void ConsumeBudgetTransactionProtocol::OnCommitBudgetKeyLoaded(
     return;
   }
 
+  if (optimistic_consumption_enabled_) {
+    ReserveTokensForCommit(commit_consume_budget_context);
+    return;
+  }
+
   // If this request can change the active transaction id to the request
   // transaction id, it means no other threads can pass this line. In the case
   // that the request is being retried, this can be done again.
   if (!budget_key_frame->active_transaction_id.compare_exchange_strong(
           zero, transaction_id)) {
+    if (WaitForTimeframeRelease(
+            commit_consume_budget_context.request->time_bucket,
+            budget_key_frame, commit_consume_budget_context,
+            [this, commit_consume_budget_context]() mutable {
+              return Commit(commit_consume_budget_context);
+            })) {
+      return;
+    }
+    commit_consume_budget_context.result = RetryExecutionResult(
+        core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
+    commit_consume_budget_context.Finish();
+    return;
+  }
+
+  // Tokens of the timeframe are reserved by other transactions, which only
+  // happens while its active transaction id is not set.
+  if (budget_key_frame->reserving_transaction_count.load() != 0) {
+    budget_key_frame->active_transaction_id = kZeroUuid;
     commit_consume_budget_context.result = RetryExecutionResult(
         core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
     commit_consume_budget_context.Finish();
@@ -206,6 +246,107 @@ void ConsumeBudgetTransactionProtocol::OnCommitBudgetKeyLoaded(
   }
 }
 
+void ConsumeBudgetTransactionProtocol::ReserveTokensForCommit(
+    AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>&
+        commit_consume_budget_context) noexcept {
+  AsyncContext<ReserveBudgetKeyTimeframeRequest,
+               ReserveBudgetKeyTimeframeResponse>
+      reserve_budget_key_timeframe_context;
+  reserve_budget_key_timeframe_context.parent_activity_id =
+      commit_consume_budget_context.activity_id;
+  reserve_budget_key_timeframe_context.correlation_id =
+      commit_consume_budget_context.correlation_id;
+  reserve_budget_key_timeframe_context.request =
+      make_shared<ReserveBudgetKeyTimeframeRequest>();
+  reserve_budget_key_timeframe_context.request->transaction_id =
+      commit_consume_budget_context.request->transaction_id;
+  BudgetKeyTimeframeReservationInfo timeframe_to_reserve;
+  timeframe_to_reserve.reporting_time =
+      commit_consume_budget_context.request->time_bucket;
+  timeframe_to_reserve.token_count =
+      commit_consume_budget_context.request->token_count;
+  reserve_budget_key_timeframe_context.request->timeframes_to_reserve = {
+      timeframe_to_reserve};
+  reserve_budget_key_timeframe_context.callback =
+      bind(&ConsumeBudgetTransactionProtocol::OnCommitTokensReserved, this,
+           commit_consume_budget_context, _1);
+
+  auto execution_result = budget_key_timeframe_manager_->Reserve(
+      reserve_budget_key_timeframe_context);
+  if (!execution_result.Successful()) {
+    commit_consume_budget_context.result = execution_result;
+    commit_consume_budget_context.Finish();
+    return;
+  }
+}
+
+void ConsumeBudgetTransactionProtocol::OnCommitTokensReserved(
+    AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>&
+        commit_consume_budget_context,
+    AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                 ReserveBudgetKeyTimeframeResponse>&
+        reserve_budget_key_timeframe_context) noexcept {
+  if (!reserve_budget_key_timeframe_context.result.Successful()) {
+    commit_consume_budget_context.result =
+        reserve_budget_key_timeframe_context.result;
+    commit_consume_budget_context.Finish();
+    return;
+  }
+
+  switch (reserve_budget_key_timeframe_context.response->status) {
+    case BudgetKeyTimeframeReservationStatus::Conflict:
+      commit_consume_budget_context.result = RetryExecutionResult(
+          core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
+      break;
+    case BudgetKeyTimeframeReservationStatus::InsufficientBudget:
+      commit_consume_budget_context.result = FailureExecutionResult(
+          core::errors::SC_PBS_BUDGET_KEY_CONSUME_BUDGET_INSUFFICIENT_BUDGET);
+      break;
+    default:
+      commit_consume_budget_context.result = SuccessExecutionResult();
+      break;
+  }
+  commit_consume_budget_context.Finish();
+}
+
+template <typename Request, typename Response>
+void ConsumeBudgetTransactionProtocol::ReleaseReservedTokens(
+    AsyncContext<Request, Response>& context, bool return_tokens) noexcept {
+  AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+               ReleaseBudgetKeyTimeframeResponse>
+      release_budget_key_timeframe_context;
+  release_budget_key_timeframe_context.parent_activity_id = context.activity_id;
+  release_budget_key_timeframe_context.correlation_id = context.correlation_id;
+  release_budget_key_timeframe_context.request =
+      make_shared<ReleaseBudgetKeyTimeframeRequest>();
+  release_budget_key_timeframe_context.request->transaction_id =
+      context.request->transaction_id;
+  release_budget_key_timeframe_context.request->return_tokens = return_tokens;
+  release_budget_key_timeframe_context.callback =
+      [context](AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                             ReleaseBudgetKeyTimeframeResponse>&
+                    release_budget_key_timeframe_context) mutable {
+        if (!release_budget_key_timeframe_context.result.Successful()) {
+          context.result = release_budget_key_timeframe_context.result;
+        } else if (release_budget_key_timeframe_context.response->status ==
+                   BudgetKeyTimeframeReservationStatus::Conflict) {
+          context.result = RetryExecutionResult(
+              core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
+        } else {
+          context.result = SuccessExecutionResult();
+        }
+        context.Finish();
+      };
+
+  auto execution_result = budget_key_timeframe_manager_->Release(
+      release_budget_key_timeframe_context);
+  if (!execution_result.Successful()) {
+    context.result = execution_result;
+    context.Finish();
+    return;
+  }
+}
+
 void ConsumeBudgetTransactionProtocol::OnCommitLogged(
     shared_ptr<BudgetKeyTimeframe>& budget_key_time_frame,
     AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>&
@@ -275,6 +416,11 @@ void ConsumeBudgetTransactionProtocol::OnNotifyBudgetKeyLoaded(
   // and this is a retry operation.
   if (budget_key_time_frame->active_transaction_id.load() !=
       notify_consume_budget_context.request->transaction_id) {
+    if (optimistic_consumption_enabled_) {
+      ReleaseReservedTokens(notify_consume_budget_context,
+                            false /* return_tokens */);
+      return;
+    }
     notify_consume_budget_context.result = SuccessExecutionResult();
     notify_consume_budget_context.Finish();
     return;
@@ -328,9 +474,13 @@ void ConsumeBudgetTransactionProtocol::OnNotifyLogged(
     budget_key_time_frame->active_transaction_id = kZeroUuid;
   }
 
+  auto time_bucket = update_budget_key_timeframe_context.request
+                         ->timeframes_to_update.back()
+                         .reporting_time;
   notify_consume_budget_context.result =
       update_budget_key_timeframe_context.result;
   notify_consume_budget_context.Finish();
+  ResumeTimeframeWaiters(time_bucket, budget_key_time_frame);
 }
 
 ExecutionResult ConsumeBudgetTransactionProtocol::Abort(
@@ -374,6 +524,11 @@ void ConsumeBudgetTransactionProtocol::OnAbortBudgetKeyLoaded(
   // Ensure that the request has arrived with the right transaction id.
   if (budget_key_frame->active_transaction_id.load() !=
       abort_consume_budget_context.request->transaction_id) {
+    if (optimistic_consumption_enabled_) {
+      ReleaseReservedTokens(abort_consume_budget_context,
+                            true /* return_tokens */);
+      return;
+    }
     abort_consume_budget_context.result = SuccessExecutionResult();
     abort_consume_budget_context.Finish();
     return;
@@ -434,9 +589,117 @@ void ConsumeBudgetTransactionProtocol::OnAbortLogged(
     }
   }
 
+  auto time_bucket = update_budget_key_timeframe_context.request
+                         ->timeframes_to_update.back()
+                         .reporting_time;
   abort_consume_budget_context.result =
       update_budget_key_timeframe_context.result;
   abort_consume_budget_context.Finish();
+  ResumeTimeframeWaiters(time_bucket, budget_key_time_frame);
+}
+
+template <typename Request, typename Response>
+bool ConsumeBudgetTransactionProtocol::WaitForTimeframeRelease(
+    TimeBucket time_bucket,
+    const shared_ptr<BudgetKeyTimeframe>& budget_key_timeframe,
+    AsyncContext<Request, Response>& context,
+    function<ExecutionResult()> run_phase) noexcept {
+  if (!async_executor_ || conflict_max_wait_time_in_milliseconds_ == 0) {
+    return false;
+  }
+
+  auto waiter = make_shared<TimeframeWaiter>();
+  waiter->resume = [context, run_phase = move(run_phase)](
+                       bool timed_out) mutable {
+    if (timed_out) {
+      context.result = RetryExecutionResult(
+          core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS);
+      context.Finish();
+      return;
+    }
+
+    auto execution_result = run_phase();
+    if (!execution_result.Successful()) {
+      context.result = execution_result;
+      context.Finish();
+    }
+  };
+
+  auto wait_queues = wait_queues_;
+  TimeDuration max_wait_time_in_nanoseconds =
+      conflict_max_wait_time_in_milliseconds_ * 1000000;
+  auto execution_result = async_executor_->ScheduleFor(
+      [wait_queues, waiter, time_bucket]() {
+        if (waiter->is_resumed.exchange(true)) {
+          return;
+        }
+        {
+          lock_guard<mutex> lock(wait_queues->mutex);
+          auto queue = wait_queues->queues.find(time_bucket);
+          if (queue != wait_queues->queues.end()) {
+            queue->second.remove(waiter);
+            if (queue->second.empty()) {
+              wait_queues->queues.erase(queue);
+            }
+          }
+        }
+        waiter->resume(true /* timed_out */);
+      },
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+          max_wait_time_in_nanoseconds,
+      waiter->cancel_timeout);
+  if (!execution_result.Successful()) {
+    return false;
+  }
+
+  {
+    lock_guard<mutex> lock(wait_queues_->mutex);
+    // The releases resume the waiters after resetting the active transaction
+    // id, so a timeframe released before this check has no one to resume it.
+    if (budget_key_timeframe->active_transaction_id.load() != kZeroUuid) {
+      wait_queues_->queues[time_bucket].push_back(waiter);
+      return true;
+    }
+  }
+
+  if (waiter->is_resumed.exchange(true)) {
+    // Already timed out and finished.
+    return true;
+  }
+  if (waiter->cancel_timeout) {
+    waiter->cancel_timeout();
+  }
+  return false;
+}
+
+void ConsumeBudgetTransactionProtocol::ResumeTimeframeWaiters(
+    TimeBucket time_bucket,
+    const shared_ptr<BudgetKeyTimeframe>& budget_key_timeframe) noexcept {
+  // A resumed prepare phase, or a commit phase without enough budget, leaves
+  // the timeframe released for the next waiter.
+  while (budget_key_timeframe->active_transaction_id.load() == kZeroUuid) {
+    shared_ptr<TimeframeWaiter> waiter;
+    {
+      lock_guard<mutex> lock(wait_queues_->mutex);
+      auto queue = wait_queues_->queues.find(time_bucket);
+      if (queue == wait_queues_->queues.end()) {
+        return;
+      }
+      waiter = queue->second.front();
+      queue->second.pop_front();
+      if (queue->second.empty()) {
+        wait_queues_->queues.erase(queue);
+      }
+    }
+
+    if (waiter->is_resumed.exchange(true)) {
+      continue;
+    }
+    if (waiter->cancel_timeout) {
+      waiter->cancel_timeout();
+    }
+    waiter->resume(false /* timed_out */);
+  }
 }
 
 }  // namespace google::scp::pbs
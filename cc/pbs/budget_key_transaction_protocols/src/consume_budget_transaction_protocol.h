@@ -16,9 +16,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
+#include "core/interface/async_executor_interface.h"
 #include "core/interface/nosql_database_provider_interface.h"
 #include "core/interface/transaction_protocol_interface.h"
 #include "pbs/interface/budget_key_interface.h"
@@ -30,10 +35,35 @@ namespace google::scp::pbs {
 class ConsumeBudgetTransactionProtocol
     : public ConsumeBudgetTransactionProtocolInterface {
  public:
+  /**
+   * @brief Constructs the protocol.
+   *
+   * @param budget_key_timeframe_manager The timeframe manager of the budget
+   * key.
+   * @param optimistic_consumption_enabled Whether the commit phase reserves
+   * the tokens through the timeframe manager, rather than holding the
+   * timeframe through its active transaction id until the notify or the abort
+   * phase.
+   * @param async_executor The async executor timing out the phases waiting for
+   * a timeframe.
+   * @param conflict_max_wait_time_in_milliseconds The max time the prepare and
+   * the commit phases wait in the FIFO queue of a timeframe held by another
+   * transaction before returning a retry. The conflicts are returned to be
+   * retried right away if 0 or without an async executor.
+   */
   ConsumeBudgetTransactionProtocol(
       const std::shared_ptr<BudgetKeyTimeframeManagerInterface>
-          budget_key_timeframe_manager)
-      : budget_key_timeframe_manager_(budget_key_timeframe_manager) {}
+          budget_key_timeframe_manager,
+      bool optimistic_consumption_enabled = false,
+      const std::shared_ptr<core::AsyncExecutorInterface>& async_executor =
+          nullptr,
+      core::TimeDuration conflict_max_wait_time_in_milliseconds = 0)
+      : budget_key_timeframe_manager_(budget_key_timeframe_manager),
+        optimistic_consumption_enabled_(optimistic_consumption_enabled),
+        async_executor_(async_executor),
+        conflict_max_wait_time_in_milliseconds_(
+            conflict_max_wait_time_in_milliseconds),
+        wait_queues_(std::make_shared<TimeframeWaitQueues>()) {}
 
   core::ExecutionResult Prepare(
       core::AsyncContext<PrepareConsumeBudgetRequest,
@@ -176,8 +206,109 @@ class ConsumeBudgetTransactionProtocol
                          UpdateBudgetKeyTimeframeResponse>&
           update_budget_key_timeframe_context) noexcept;
 
+  /**
+   * @brief Reserves the tokens of the commit phase through the timeframe
+   * manager.
+   *
+   * @param commit_consume_budget_context The commit consume budget operation
+   * context.
+   */
+  void ReserveTokensForCommit(
+      core::AsyncContext<CommitConsumeBudgetRequest,
+                         CommitConsumeBudgetResponse>&
+          commit_consume_budget_context) noexcept;
+
+  /**
+   * @brief Is called when the tokens of the commit phase are reserved.
+   *
+   * @param commit_consume_budget_context The commit consume budget operation
+   * context.
+   * @param reserve_budget_key_timeframe_context The reserve budget key
+   * timeframe operation context.
+   */
+  void OnCommitTokensReserved(
+      core::AsyncContext<CommitConsumeBudgetRequest,
+                         CommitConsumeBudgetResponse>&
+          commit_consume_budget_context,
+      core::AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                         ReserveBudgetKeyTimeframeResponse>&
+          reserve_budget_key_timeframe_context) noexcept;
+
+  /**
+   * @brief Releases the tokens reserved in the commit phase, consuming them
+   * on notify and giving them back on abort.
+   *
+   * @param context The notify or the abort consume budget operation context.
+   * @param return_tokens Whether the tokens are given back.
+   */
+  template <typename Request, typename Response>
+  void ReleaseReservedTokens(core::AsyncContext<Request, Response>& context,
+                             bool return_tokens) noexcept;
+
+  /**
+   * @brief Queues a phase behind the transaction holding the timeframe of the
+   * time bucket, to run it again once the timeframe is released, or to finish
+   * it with a retry once the max wait time elapses.
+   *
+   * @param time_bucket The time bucket of the timeframe.
+   * @param budget_key_timeframe The timeframe held by another transaction.
+   * @param context The prepare or the commit consume budget operation context.
+   * @param run_phase Runs the phase of the context again.
+   * @return bool Whether the phase is queued. If not, the conflict is to be
+   * returned to the caller.
+   */
+  template <typename Request, typename Response>
+  bool WaitForTimeframeRelease(
+      TimeBucket time_bucket,
+      const std::shared_ptr<BudgetKeyTimeframe>& budget_key_timeframe,
+      core::AsyncContext<Request, Response>& context,
+      std::function<core::ExecutionResult()> run_phase) noexcept;
+
+  /**
+   * @brief Resumes the phases queued on the timeframe of the time bucket in
+   * FIFO order, until one of them holds the timeframe again.
+   *
+   * @param time_bucket The time bucket of the timeframe.
+   * @param budget_key_timeframe The timeframe released.
+   */
+  void ResumeTimeframeWaiters(
+      TimeBucket time_bucket,
+      const std::shared_ptr<BudgetKeyTimeframe>& budget_key_timeframe) noexcept;
+
  private:
+  /// A phase queued on a timeframe held by another transaction.
+  struct TimeframeWaiter {
+    /// Runs the phase again, or finishes it with a retry if timed out.
+    std::function<void(bool timed_out)> resume;
+    /// Set by whichever of the release and the timeout resumes the phase.
+    std::atomic<bool> is_resumed{false};
+    /// Cancels the timeout of the wait.
+    core::TaskCancellationLambda cancel_timeout;
+  };
+
+  /// The FIFO queues of the phases waiting on the timeframes, by time bucket.
+  /// Shared with the scheduled timeouts.
+  struct TimeframeWaitQueues {
+    std::mutex mutex;
+    std::unordered_map<TimeBucket,
+                       std::list<std::shared_ptr<TimeframeWaiter>>>
+        queues;
+  };
+
+
   const std::shared_ptr<BudgetKeyTimeframeManagerInterface>
       budget_key_timeframe_manager_;
+
+  /// Whether the commit phase reserves the tokens rather than holding the
+  /// timeframe.
+  const bool optimistic_consumption_enabled_;
+
+  /// The async executor timing out the waits on the timeframes.
+  const std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
+
+  /// The max time a phase waits for a timeframe held by another transaction.
+  const core::TimeDuration conflict_max_wait_time_in_milliseconds_;
+
+  std::shared_ptr<TimeframeWaitQueues> wait_queues_;
 };
 }  // namespace google::scp::pbs
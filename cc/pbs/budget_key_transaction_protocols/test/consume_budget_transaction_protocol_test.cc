@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "core/async_executor/mock/mock_async_executor.h"
 #include "core/interface/async_context.h"
 #include "core/test/utils/conditional_wait.h"
 #include "pbs/budget_key_timeframe_manager/mock/mock_budget_key_timeframe_manager.h"
@@ -30,6 +31,9 @@
 #include "public/core/test/interface/execution_result_matchers.h"
 
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
+using google::scp::core::Timestamp;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::RetryExecutionResult;
@@ -43,6 +47,7 @@ using google::scp::pbs::budget_key::mock::
 using google::scp::pbs::buget_key_timeframe_manager::mock::
     MockBudgetKeyTimeframeManager;
 using std::atomic;
+using std::function;
 using std::make_shared;
 using std::move;
 using std::shared_ptr;
@@ -1131,4 +1136,334 @@ TEST(ConsumeBudgetTransactionProtocolTest, OnAbortLogged) {
   }
 }
 
+TEST(ConsumeBudgetTransactionProtocolTest,
+     ConsumeBudgetCommitWithReservedTokensRetries) {
+  auto budget_key_manager = make_shared<MockBudgetKeyTimeframeManager>();
+  atomic<bool> condition(false);
+  auto transaction_protocol =
+      make_shared<ConsumeBudgetTransactionProtocol>(budget_key_manager);
+  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(0);
+  budget_key_timeframe->token_count = 25;
+  budget_key_timeframe->reserving_transaction_count = 1;
+
+  budget_key_manager->load_function =
+      [&](auto& load_budget_key_timeframe_context) {
+        load_budget_key_timeframe_context.response =
+            make_shared<LoadBudgetKeyTimeframeResponse>();
+        load_budget_key_timeframe_context.response->budget_key_frames = {
+            budget_key_timeframe};
+
+        load_budget_key_timeframe_context.result = SuccessExecutionResult();
+        load_budget_key_timeframe_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  CommitConsumeBudgetRequest commit_consume_budget_request{
+      .transaction_id{0, 1}, .time_bucket = 0, .token_count = 10};
+
+  AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>
+      commit_consume_budget_context(
+          make_shared<CommitConsumeBudgetRequest>(
+              move(commit_consume_budget_request)),
+          [&](auto& commit_consume_budget_context) {
+            EXPECT_EQ(
+                commit_consume_budget_context.result,
+                RetryExecutionResult(
+                    core::errors::
+                        SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS));
+            condition = true;
+          });
+
+  EXPECT_EQ(transaction_protocol->Commit(commit_consume_budget_context),
+            SuccessExecutionResult());
+  WaitUntil([&]() { return condition.load(); });
+  EXPECT_EQ(budget_key_timeframe->token_count.load(), 25);
+  EXPECT_EQ(budget_key_timeframe->active_transaction_id.load(),
+            core::common::kZeroUuid);
+}
+
+TEST(ConsumeBudgetTransactionProtocolTest, OptimisticConsumeBudget) {
+  auto budget_key_manager = make_shared<MockBudgetKeyTimeframeManager>();
+  auto transaction_protocol = make_shared<ConsumeBudgetTransactionProtocol>(
+      budget_key_manager, true /* optimistic_consumption_enabled */);
+  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(0);
+  budget_key_timeframe->token_count = 25;
+
+  budget_key_manager->load_function =
+      [&](auto& load_budget_key_timeframe_context) {
+        load_budget_key_timeframe_context.response =
+            make_shared<LoadBudgetKeyTimeframeResponse>();
+        load_budget_key_timeframe_context.response->budget_key_frames = {
+            budget_key_timeframe};
+
+        load_budget_key_timeframe_context.result = SuccessExecutionResult();
+        load_budget_key_timeframe_context.Finish();
+        return SuccessExecutionResult();
+      };
+  budget_key_manager->update_function = [](auto&) {
+    ADD_FAILURE();
+    return FailureExecutionResult(1234);
+  };
+
+  auto reservation_status = BudgetKeyTimeframeReservationStatus::Done;
+  budget_key_manager->reserve_function =
+      [&](AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                       ReserveBudgetKeyTimeframeResponse>& context) {
+        EXPECT_EQ(context.request->transaction_id, Uuid({0, 1}));
+        EXPECT_EQ(context.request->timeframes_to_reserve.size(), 1);
+        EXPECT_EQ(context.request->timeframes_to_reserve[0].reporting_time, 0);
+        EXPECT_EQ(context.request->timeframes_to_reserve[0].token_count, 10);
+        context.response = make_shared<ReserveBudgetKeyTimeframeResponse>();
+        context.response->status = reservation_status;
+        context.result = SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  vector<bool> released_return_tokens;
+  auto release_status = BudgetKeyTimeframeReservationStatus::Done;
+  budget_key_manager->release_function =
+      [&](AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                       ReleaseBudgetKeyTimeframeResponse>& context) {
+        EXPECT_EQ(context.request->transaction_id, Uuid({0, 1}));
+        released_return_tokens.push_back(context.request->return_tokens);
+        context.response = make_shared<ReleaseBudgetKeyTimeframeResponse>();
+        context.response->status = release_status;
+        context.result = SuccessExecutionResult();
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  auto commit = [&](ExecutionResult expected_result) {
+    atomic<bool> condition(false);
+    AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>
+        commit_consume_budget_context(
+            make_shared<CommitConsumeBudgetRequest>(CommitConsumeBudgetRequest{
+                .transaction_id{0, 1}, .time_bucket = 0, .token_count = 10}),
+            [&](auto& commit_consume_budget_context) {
+              EXPECT_EQ(commit_consume_budget_context.result, expected_result);
+              condition = true;
+            });
+    EXPECT_SUCCESS(transaction_protocol->Commit(commit_consume_budget_context));
+    WaitUntil([&]() { return condition.load(); });
+  };
+
+  commit(SuccessExecutionResult());
+  reservation_status = BudgetKeyTimeframeReservationStatus::Conflict;
+  commit(RetryExecutionResult(
+      core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS));
+  reservation_status = BudgetKeyTimeframeReservationStatus::InsufficientBudget;
+  commit(FailureExecutionResult(
+      core::errors::SC_PBS_BUDGET_KEY_CONSUME_BUDGET_INSUFFICIENT_BUDGET));
+  // The timeframe is not held by the transaction.
+  EXPECT_EQ(budget_key_timeframe->active_transaction_id.load(),
+            core::common::kZeroUuid);
+
+  auto notify = [&](ExecutionResult expected_result) {
+    atomic<bool> condition(false);
+    AsyncContext<NotifyConsumeBudgetRequest, NotifyConsumeBudgetResponse>
+        notify_consume_budget_context(
+            make_shared<NotifyConsumeBudgetRequest>(NotifyConsumeBudgetRequest{
+                .transaction_id{0, 1}, .time_bucket = 0}),
+            [&](auto& notify_consume_budget_context) {
+              EXPECT_EQ(notify_consume_budget_context.result, expected_result);
+              condition = true;
+            });
+    EXPECT_SUCCESS(transaction_protocol->Notify(notify_consume_budget_context));
+    WaitUntil([&]() { return condition.load(); });
+  };
+
+  auto abort = [&](ExecutionResult expected_result) {
+    atomic<bool> condition(false);
+    AsyncContext<AbortConsumeBudgetRequest, AbortConsumeBudgetResponse>
+        abort_consume_budget_context(
+            make_shared<AbortConsumeBudgetRequest>(AbortConsumeBudgetRequest{
+                .transaction_id{0, 1}, .time_bucket = 0}),
+            [&](auto& abort_consume_budget_context) {
+              EXPECT_EQ(abort_consume_budget_context.result, expected_result);
+              condition = true;
+            });
+    EXPECT_SUCCESS(transaction_protocol->Abort(abort_consume_budget_context));
+    WaitUntil([&]() { return condition.load(); });
+  };
+
+  notify(SuccessExecutionResult());
+  abort(SuccessExecutionResult());
+  release_status = BudgetKeyTimeframeReservationStatus::Conflict;
+  notify(RetryExecutionResult(
+      core::errors::SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS));
+  EXPECT_EQ(released_return_tokens, (vector<bool>{false, true, false}));
+}
+
+TEST(ConsumeBudgetTransactionProtocolTest,
+     ConsumeBudgetCommitWaitsForTheTimeframeRelease) {
+  auto budget_key_manager = make_shared<MockBudgetKeyTimeframeManager>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  vector<AsyncOperation> timeouts;
+  size_t cancelled_timeouts = 0;
+  mock_async_executor->schedule_for_mock =
+      [&](const AsyncOperation& work, Timestamp,
+          function<bool()>& cancellation_callback) {
+        timeouts.push_back(work);
+        cancellation_callback = [&]() {
+          cancelled_timeouts++;
+          return true;
+        };
+        return SuccessExecutionResult();
+      };
+  auto transaction_protocol = make_shared<ConsumeBudgetTransactionProtocol>(
+      budget_key_manager, false /* optimistic_consumption_enabled */,
+      mock_async_executor, 1000 /* conflict_max_wait_time_in_milliseconds */);
+  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(0);
+  budget_key_timeframe->token_count = 25;
+  budget_key_timeframe->active_transaction_id = {1, 1};
+  budget_key_timeframe->active_token_count = 20;
+
+  budget_key_manager->load_function =
+      [&](auto& load_budget_key_timeframe_context) {
+        load_budget_key_timeframe_context.response =
+            make_shared<LoadBudgetKeyTimeframeResponse>();
+        load_budget_key_timeframe_context.response->budget_key_frames = {
+            budget_key_timeframe};
+
+        load_budget_key_timeframe_context.result = SuccessExecutionResult();
+        load_budget_key_timeframe_context.Finish();
+        return SuccessExecutionResult();
+      };
+  budget_key_manager->update_function =
+      [](core::AsyncContext<UpdateBudgetKeyTimeframeRequest,
+                            UpdateBudgetKeyTimeframeResponse>&
+             update_budget_key_timeframe_context) {
+        update_budget_key_timeframe_context.result = SuccessExecutionResult();
+        update_budget_key_timeframe_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  vector<ExecutionResult> first_results;
+  AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>
+      first_commit_context(
+          make_shared<CommitConsumeBudgetRequest>(CommitConsumeBudgetRequest{
+              .transaction_id{0, 1}, .time_bucket = 0, .token_count = 10}),
+          [&](auto& commit_consume_budget_context) {
+            first_results.push_back(commit_consume_budget_context.result);
+          });
+  vector<ExecutionResult> second_results;
+  AsyncContext<CommitConsumeBudgetRequest, CommitConsumeBudgetResponse>
+      second_commit_context(
+          make_shared<CommitConsumeBudgetRequest>(CommitConsumeBudgetRequest{
+              .transaction_id{0, 2}, .time_bucket = 0, .token_count = 10}),
+          [&](auto& commit_consume_budget_context) {
+            second_results.push_back(commit_consume_budget_context.result);
+          });
+
+  // Both commits wait for the transaction holding the timeframe.
+  EXPECT_SUCCESS(transaction_protocol->Commit(first_commit_context));
+  EXPECT_SUCCESS(transaction_protocol->Commit(second_commit_context));
+  EXPECT_TRUE(first_results.empty());
+  EXPECT_TRUE(second_results.empty());
+  EXPECT_EQ(timeouts.size(), 2);
+
+  // Aborting the holder resumes the first commit only, which then holds the
+  // timeframe.
+  atomic<bool> condition(false);
+  AsyncContext<AbortConsumeBudgetRequest, AbortConsumeBudgetResponse>
+      abort_consume_budget_context(
+          make_shared<AbortConsumeBudgetRequest>(AbortConsumeBudgetRequest{
+              .transaction_id{1, 1}, .time_bucket = 0}),
+          [&](auto& abort_consume_budget_context) {
+            EXPECT_SUCCESS(abort_consume_budget_context.result);
+            condition = true;
+          });
+  EXPECT_SUCCESS(transaction_protocol->Abort(abort_consume_budget_context));
+  WaitUntil([&]() { return condition.load(); });
+  EXPECT_EQ(first_results, (vector<ExecutionResult>{SuccessExecutionResult()}));
+  EXPECT_TRUE(second_results.empty());
+  EXPECT_EQ(cancelled_timeouts, 1);
+  EXPECT_EQ(budget_key_timeframe->active_transaction_id.load(), Uuid({0, 1}));
+  EXPECT_EQ(budget_key_timeframe->active_token_count.load(), 15);
+
+  // The second commit times out, then its timeout of the first commit does
+  // nothing.
+  timeouts[1]();
+  timeouts[0]();
+  EXPECT_EQ(first_results.size(), 1);
+  EXPECT_EQ(second_results,
+            (vector<ExecutionResult>{RetryExecutionResult(
+                core::errors::
+                    SC_PBS_BUDGET_KEY_ACTIVE_TRANSACTION_IN_PROGRESS)}));
+}
+
+TEST(ConsumeBudgetTransactionProtocolTest,
+     ConsumeBudgetPrepareWaitsForTheTimeframeRelease) {
+  auto budget_key_manager = make_shared<MockBudgetKeyTimeframeManager>();
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  mock_async_executor->schedule_for_mock =
+      [&](const AsyncOperation&, Timestamp, function<bool()>&) {
+        return SuccessExecutionResult();
+      };
+  auto transaction_protocol = make_shared<ConsumeBudgetTransactionProtocol>(
+      budget_key_manager, false /* optimistic_consumption_enabled */,
+      mock_async_executor, 1000 /* conflict_max_wait_time_in_milliseconds */);
+  auto budget_key_timeframe = make_shared<BudgetKeyTimeframe>(0);
+  budget_key_timeframe->token_count = 25;
+  budget_key_timeframe->active_transaction_id = {1, 1};
+  budget_key_timeframe->active_token_count = 20;
+
+  budget_key_manager->load_function =
+      [&](auto& load_budget_key_timeframe_context) {
+        load_budget_key_timeframe_context.response =
+            make_shared<LoadBudgetKeyTimeframeResponse>();
+        load_budget_key_timeframe_context.response->budget_key_frames = {
+            budget_key_timeframe};
+
+        load_budget_key_timeframe_context.result = SuccessExecutionResult();
+        load_budget_key_timeframe_context.Finish();
+        return SuccessExecutionResult();
+      };
+  budget_key_manager->update_function =
+      [](core::AsyncContext<UpdateBudgetKeyTimeframeRequest,
+                            UpdateBudgetKeyTimeframeResponse>&
+             update_budget_key_timeframe_context) {
+        update_budget_key_timeframe_context.result = SuccessExecutionResult();
+        update_budget_key_timeframe_context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  vector<ExecutionResult> results;
+  auto prepare = [&](TokenCount token_count) {
+    AsyncContext<PrepareConsumeBudgetRequest, PrepareConsumeBudgetResponse>
+        prepare_consume_budget_context(
+            make_shared<PrepareConsumeBudgetRequest>(
+                PrepareConsumeBudgetRequest{.transaction_id{0, 1},
+                                            .time_bucket = 0,
+                                            .token_count = token_count}),
+            [&](auto& prepare_consume_budget_context) {
+              results.push_back(prepare_consume_budget_context.result);
+            });
+    EXPECT_SUCCESS(
+        transaction_protocol->Prepare(prepare_consume_budget_context));
+  };
+  prepare(10);
+  prepare(30);
+  EXPECT_TRUE(results.empty());
+
+  // The prepare phases do not hold the timeframe, so notifying the holder
+  // resumes all of them.
+  atomic<bool> condition(false);
+  AsyncContext<NotifyConsumeBudgetRequest, NotifyConsumeBudgetResponse>
+      notify_consume_budget_context(
+          make_shared<NotifyConsumeBudgetRequest>(NotifyConsumeBudgetRequest{
+              .transaction_id{1, 1}, .time_bucket = 0}),
+          [&](auto& notify_consume_budget_context) {
+            EXPECT_SUCCESS(notify_consume_budget_context.result);
+            condition = true;
+          });
+  EXPECT_SUCCESS(transaction_protocol->Notify(notify_consume_budget_context));
+  WaitUntil([&]() { return condition.load(); });
+  auto insufficient_budget = FailureExecutionResult(
+      core::errors::SC_PBS_BUDGET_KEY_CONSUME_BUDGET_INSUFFICIENT_BUDGET);
+  EXPECT_EQ(results, (vector<ExecutionResult>{SuccessExecutionResult(),
+                                              insufficient_budget}));
+}
+
 }  // namespace google::scp::pbs::test
@@ -19,6 +19,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "pbs/checkpoint_service/src/checkpoint_service.h"
 
@@ -45,7 +46,8 @@ class MockCheckpointService : public CheckpointService {
   std::function<core::ExecutionResult(core::JournalId last_processed_journal_id,
                                       core::CheckpointId& checkpoint_id,
                                       core::BytesBuffer& last_checkpoint_buffer,
-                                      core::BytesBuffer& checkpoint_buffer)>
+                                      std::vector<core::BytesBuffer>&
+                                          checkpoint_buffers)>
       checkpoint_mock;
   std::function<core::ExecutionResult(
       std::shared_ptr<core::BlobStorageClientInterface>& blob_storage_client,
@@ -55,7 +57,8 @@ class MockCheckpointService : public CheckpointService {
 
   std::function<core::ExecutionResult(core::CheckpointId& checkpoint_id,
                                       core::BytesBuffer& last_checkpoint_buffer,
-                                      core::BytesBuffer& checkpoint_buffer)>
+                                      std::vector<core::BytesBuffer>&
+                                          checkpoint_buffers)>
       store_mock;
 
   virtual core::ExecutionResult RunCheckpointWorker() noexcept {
@@ -82,14 +85,14 @@ class MockCheckpointService : public CheckpointService {
       core::JournalId last_processed_journal_id,
       core::CheckpointId& checkpoint_id,
       core::BytesBuffer& last_checkpoint_buffer,
-      core::BytesBuffer& checkpoint_buffer) noexcept {
+      std::vector<core::BytesBuffer>& checkpoint_buffers) noexcept {
     if (checkpoint_mock) {
       return checkpoint_mock(last_processed_journal_id, checkpoint_id,
-                             last_checkpoint_buffer, checkpoint_buffer);
+                             last_checkpoint_buffer, checkpoint_buffers);
     }
     return CheckpointService::Checkpoint(last_processed_journal_id,
                                          checkpoint_id, last_checkpoint_buffer,
-                                         checkpoint_buffer);
+                                         checkpoint_buffers);
   }
 
   virtual core::ExecutionResult WriteBlob(
@@ -103,15 +106,16 @@ class MockCheckpointService : public CheckpointService {
                                         bytes_buffer);
   }
 
-  core::ExecutionResult Store(core::CheckpointId& checkpoint_id,
-                              core::BytesBuffer& last_checkpoint_buffer,
-                              core::BytesBuffer& checkpoint_buffer) noexcept {
+  core::ExecutionResult Store(
+      core::CheckpointId& checkpoint_id,
+      core::BytesBuffer& last_checkpoint_buffer,
+      std::vector<core::BytesBuffer>& checkpoint_buffers) noexcept {
     if (store_mock) {
       return store_mock(checkpoint_id, last_checkpoint_buffer,
-                        checkpoint_buffer);
+                        checkpoint_buffers);
     }
     return CheckpointService::Store(checkpoint_id, last_checkpoint_buffer,
-                                    checkpoint_buffer);
+                                    checkpoint_buffers);
   }
 
   virtual core::ExecutionResult Shutdown() noexcept {
@@ -147,6 +151,61 @@ class MockCheckpointService : public CheckpointService {
     transaction_manager_ = transaction_manager;
   }
 
+  void SetApplicationJournalService(
+      std::shared_ptr<core::JournalServiceInterface>
+          application_journal_service) {
+    application_journal_service_ = application_journal_service;
+  }
+
+  void EnableLiveSnapshot(
+      std::shared_ptr<pbs::BudgetKeyProviderInterface> live_budget_key_provider,
+      std::shared_ptr<core::TransactionManagerInterface>
+          live_transaction_manager) {
+    live_budget_key_provider_ = live_budget_key_provider;
+    live_transaction_manager_ = live_transaction_manager;
+    enable_live_snapshot_ = true;
+  }
+
   void SetJournalId(core::JournalId id) { last_processed_journal_id_ = id; }
+
+  void SetLastPersistedCheckpointId(core::CheckpointId id) {
+    last_persisted_checkpoint_id_ = id;
+  }
+
+  void SetMaxDeltaCheckpointChainLength(size_t length) {
+    max_delta_checkpoint_chain_length_ = length;
+  }
+
+  void SetCheckpointShardCount(size_t shard_count) {
+    checkpoint_shard_count_ = shard_count;
+  }
+
+  void SetCheckpointRoundTriggers(size_t log_count_threshold,
+                                  size_t log_bytes_threshold,
+                                  size_t max_interval_in_seconds) {
+    checkpoint_log_count_threshold_ = log_count_threshold;
+    checkpoint_log_bytes_threshold_ = log_bytes_threshold;
+    max_checkpointing_interval_in_seconds_ = max_interval_in_seconds;
+  }
+
+  void StartCheckpointRound() noexcept {
+    CheckpointService::StartCheckpointRound();
+  }
+
+  bool IsCheckpointRoundDue() noexcept override {
+    return CheckpointService::IsCheckpointRoundDue();
+  }
+
+  void SetIOAsyncExecutor(
+      std::shared_ptr<core::AsyncExecutorInterface> io_async_executor) {
+    io_async_executor_ = io_async_executor;
+  }
+
+  void SetRecoveredCheckpoint(
+      core::CheckpointId id,
+      std::shared_ptr<core::JournalRecoveredComponents> recovered_components) {
+    recovered_checkpoint_id_ = id;
+    recovered_components_ = recovered_components;
+  }
 };
 }  // namespace google::scp::pbs::checkpoint_service::mock
@@ -17,6 +17,7 @@
 #include "checkpoint_service.h"
 
 // IWYU pragma: no_include <bits/chrono.h>
+#include <algorithm>
 #include <atomic>
 #include <chrono>  // IWYU pragma: keep
 #include <future>
@@ -33,9 +34,11 @@
 #include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_context.h"
+#include "core/interface/configuration_keys.h"
 #include "core/interface/nosql_database_provider_interface.h"
 #include "core/interface/service_interface.h"
 #include "core/journal_service/src/error_codes.h"
+#include "core/journal_service/src/journal_compactor.h"
 #include "core/journal_service/src/journal_serialization.h"
 #include "core/journal_service/src/journal_service.h"
 #include "core/journal_service/src/journal_utils.h"
@@ -51,6 +54,7 @@
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutor;
 using google::scp::core::AsyncExecutorInterface;
+using google::scp::core::AsyncPriority;
 using google::scp::core::BlobStorageClientInterface;
 using google::scp::core::BlobStorageProviderInterface;
 using google::scp::core::Byte;
@@ -61,6 +65,7 @@ using google::scp::core::ConfigProviderInterface;
 using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
+using google::scp::core::JournalCompactor;
 using google::scp::core::JournalId;
 using google::scp::core::JournalRecoverRequest;
 using google::scp::core::JournalRecoverResponse;
@@ -91,6 +96,7 @@ using std::promise;
 using std::shared_ptr;
 using std::string;
 using std::thread;
+using std::vector;
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
 
@@ -100,6 +106,16 @@ static constexpr char kCheckpointService[] = "CheckpointService";
 static constexpr size_t kBufferIncreaseThreshold = 1 * 1024 * 1024;  // 1MB
 static constexpr size_t kDefaultCheckpointIntervalInSeconds = 5;
 static constexpr size_t kDefaultMaxJournalsToCheckpointInEachRun = 1000;
+static constexpr size_t kDefaultMaxDeltaCheckpointChainLength = 0;
+static constexpr size_t kDefaultCheckpointShardCount = 1;
+static constexpr bool kDefaultEnableLiveSnapshot = false;
+static constexpr size_t kLiveSnapshotFlushingPauseMaxWaitInMilliseconds = 100;
+static constexpr bool kDefaultEnableJournalCompaction = false;
+static constexpr size_t kDefaultJournalsPerCompactedSegment = 100;
+static constexpr size_t kDefaultMaxCheckpointingIntervalInSeconds = 300;
+// How often the journal volume is checked, between the checkpointing runs
+// triggered by it.
+static constexpr size_t kCheckpointRoundDuePollIntervalInMilliseconds = 100;
 
 namespace google::scp::pbs {
 ExecutionResult CheckpointService::Init() noexcept {
@@ -118,6 +134,79 @@ ExecutionResult CheckpointService::Init() noexcept {
         kDefaultMaxJournalsToCheckpointInEachRun;
   }
 
+  if (!config_provider_
+           ->Get(kPBSJournalCheckpointingMaxDeltaCheckpointChainLength,
+                 max_delta_checkpoint_chain_length_)
+           .Successful()) {
+    max_delta_checkpoint_chain_length_ = kDefaultMaxDeltaCheckpointChainLength;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalCheckpointingShardCount, checkpoint_shard_count_)
+           .Successful() ||
+      checkpoint_shard_count_ == 0) {
+    checkpoint_shard_count_ = kDefaultCheckpointShardCount;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalCheckpointingEnableLiveSnapshot,
+                 enable_live_snapshot_)
+           .Successful()) {
+    enable_live_snapshot_ = kDefaultEnableLiveSnapshot;
+  }
+  // Without the live components, the checkpoints are always recovered.
+  enable_live_snapshot_ = enable_live_snapshot_ && live_budget_key_provider_ &&
+                          live_transaction_manager_;
+
+  if (!config_provider_
+           ->Get(core::kPBSJournalServiceEnableJournalCompaction,
+                 enable_journal_compaction_)
+           .Successful()) {
+    enable_journal_compaction_ = kDefaultEnableJournalCompaction;
+  }
+
+  if (!config_provider_
+           ->Get(core::kPBSJournalServiceJournalsPerCompactedSegment,
+                 journals_per_compacted_segment_)
+           .Successful() ||
+      journals_per_compacted_segment_ == 0) {
+    journals_per_compacted_segment_ = kDefaultJournalsPerCompactedSegment;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalCheckpointingLogCountThreshold,
+                 checkpoint_log_count_threshold_)
+           .Successful()) {
+    checkpoint_log_count_threshold_ = 0;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalCheckpointingLogBytesThreshold,
+                 checkpoint_log_bytes_threshold_)
+           .Successful()) {
+    checkpoint_log_bytes_threshold_ = 0;
+  }
+
+  if (!config_provider_
+           ->Get(kPBSJournalCheckpointingMaxIntervalInSeconds,
+                 max_checkpointing_interval_in_seconds_)
+           .Successful()) {
+    max_checkpointing_interval_in_seconds_ =
+        kDefaultMaxCheckpointingIntervalInSeconds;
+  }
+  // The checkpointing interval stays the minimum time between the runs.
+  max_checkpointing_interval_in_seconds_ =
+      std::max(max_checkpointing_interval_in_seconds_,
+               checkpointing_interval_in_seconds_);
+
+  // The segments are compressed like the journal blobs.
+  if (!config_provider_
+           ->Get(core::kPBSJournalServiceBlobCompressionLevel,
+                 journal_blob_compression_level_)
+           .Successful()) {
+    journal_blob_compression_level_ = 0;
+  }
+
   if (auto execution_result = FromString(*partition_name_, partition_id_);
       !execution_result.Successful()) {
     SCP_ERROR(kCheckpointService, kZeroUuid, execution_result,
@@ -128,9 +217,17 @@ ExecutionResult CheckpointService::Init() noexcept {
   SCP_INFO(kCheckpointService, partition_id_,
            "Starting Checkpoint Service for Partition with ID: '%s'. "
            "Checkpointing Interval in Seconds: %zu, "
-           "Number of journal entries to process in each checkpoint run: %zu",
+           "Number of journal entries to process in each checkpoint run: %zu, "
+           "Maximum number of delta checkpoints on top of a full checkpoint: "
+           "%zu, Number of checkpoint shards: %zu, Live snapshots enabled: %d, "
+           "Journal compaction enabled: %d, Log count threshold: %zu, Log "
+           "bytes threshold: %zu, Max checkpointing interval in seconds: %zu",
            ToString(partition_id_).c_str(), checkpointing_interval_in_seconds_,
-           max_journals_to_process_in_each_checkpoint_run_);
+           max_journals_to_process_in_each_checkpoint_run_,
+           max_delta_checkpoint_chain_length_, checkpoint_shard_count_,
+           enable_live_snapshot_, enable_journal_compaction_,
+           checkpoint_log_count_threshold_, checkpoint_log_bytes_threshold_,
+           max_checkpointing_interval_in_seconds_);
 
   return SuccessExecutionResult();
 };
@@ -151,6 +248,7 @@ ExecutionResult CheckpointService::Run() noexcept {
                "Starting checkpointing activity for Partition with ID: '%s'",
                ToString(partition_id_).c_str());
 
+      StartCheckpointRound();
       auto execution_result = RunCheckpointWorker();
       Shutdown();
 
@@ -170,9 +268,13 @@ ExecutionResult CheckpointService::Run() noexcept {
         break;
       }
 
-      // If it was successful sleep for the interval.
-      std::this_thread::sleep_for(
-          std::chrono::seconds(checkpointing_interval_in_seconds_));
+      execution_result = CompactJournals();
+      if (!execution_result.Successful()) {
+        SCP_ERROR(kCheckpointService, activity_id_, execution_result,
+                  "Journal compaction failed.");
+      }
+
+      WaitForNextCheckpointRound();
     }
   });
   worker_thread_ = move(checkpoint_thread);
@@ -193,7 +295,78 @@ ExecutionResult CheckpointService::Stop() noexcept {
   return SuccessExecutionResult();
 };
 
+void CheckpointService::StartCheckpointRound() noexcept {
+  round_start_timestamp_ = TimeProvider::GetSteadyTimestampInNanoseconds();
+  size_t acknowledged_log_count = 0;
+  if (!application_journal_service_
+           ->GetLogCounts(round_start_appended_log_count_,
+                          acknowledged_log_count)
+           .Successful()) {
+    round_start_appended_log_count_ = 0;
+  }
+  if (!application_journal_service_
+           ->GetAppendedLogBytes(round_start_appended_log_bytes_)
+           .Successful()) {
+    round_start_appended_log_bytes_ = 0;
+  }
+}
+
+void CheckpointService::WaitForNextCheckpointRound() noexcept {
+  // The checkpointing interval is the minimum time between the runs.
+  std::this_thread::sleep_for(
+      std::chrono::seconds(checkpointing_interval_in_seconds_));
+  if (checkpoint_log_count_threshold_ == 0 &&
+      checkpoint_log_bytes_threshold_ == 0) {
+    return;
+  }
+
+  // An idle partition is not checkpointed again until the max interval, and a
+  // busy one as soon as it journaled enough.
+  while (is_running_ && !IsCheckpointRoundDue()) {
+    std::this_thread::sleep_for(
+        milliseconds(kCheckpointRoundDuePollIntervalInMilliseconds));
+  }
+}
+
+bool CheckpointService::IsCheckpointRoundDue() noexcept {
+  if (TimeProvider::GetSteadyTimestampInNanoseconds() -
+          round_start_timestamp_ >=
+      std::chrono::seconds(max_checkpointing_interval_in_seconds_)) {
+    return true;
+  }
+
+  size_t appended_log_count = 0;
+  size_t acknowledged_log_count = 0;
+  if (checkpoint_log_count_threshold_ > 0 &&
+      application_journal_service_
+          ->GetLogCounts(appended_log_count, acknowledged_log_count)
+          .Successful() &&
+      appended_log_count - round_start_appended_log_count_ >=
+          checkpoint_log_count_threshold_) {
+    return true;
+  }
+
+  size_t appended_log_bytes = 0;
+  return checkpoint_log_bytes_threshold_ > 0 &&
+         application_journal_service_->GetAppendedLogBytes(appended_log_bytes)
+             .Successful() &&
+         appended_log_bytes - round_start_appended_log_bytes_ >=
+             checkpoint_log_bytes_threshold_;
+}
+
 ExecutionResult CheckpointService::RunCheckpointWorker() noexcept {
+  if (enable_live_snapshot_) {
+    auto execution_result = RunLiveSnapshotCheckpoint();
+    if (execution_result.status_code !=
+        core::errors::SC_PBS_CHECKPOINT_SERVICE_PARTITION_NOT_QUIESCENT) {
+      return execution_result;
+    }
+    SCP_INFO(kCheckpointService, activity_id_,
+             "Partition with ID: '%s' is not quiescent. Recovering the "
+             "journals to checkpoint instead.",
+             ToString(partition_id_).c_str());
+  }
+
   auto checkpoint_round_start_timestamp =
       TimeProvider::GetSteadyTimestampInNanoseconds();
   auto execution_result = Bootstrap();
@@ -229,32 +402,45 @@ ExecutionResult CheckpointService::RunCheckpointWorker() noexcept {
       TimeProvider::GetSteadyTimestampInNanoseconds();
 
   CheckpointId checkpoint_id = 0;
-  BytesBuffer checkpoint_buffer(initial_buffer_size_);
+  vector<BytesBuffer> checkpoint_buffers;
   BytesBuffer last_check_point_buffer(initial_buffer_size_);
   execution_result = Checkpoint(last_processed_journal_id, checkpoint_id,
-                                last_check_point_buffer, checkpoint_buffer);
+                                last_check_point_buffer, checkpoint_buffers);
   if (!execution_result.Successful()) {
     return execution_result;
   }
 
+  size_t checkpoint_size = 0;
+  for (const auto& checkpoint_buffer : checkpoint_buffers) {
+    checkpoint_size += checkpoint_buffer.Size();
+  }
+
   SCP_INFO(kCheckpointService, activity_id_,
            "Checkpoint buffer constructed. Size (bytes): '%llu', Time taken to "
            "construct: "
            "'%llu' (ms)",
-           checkpoint_buffer.Size(),
+           checkpoint_size,
            duration_cast<milliseconds>(
                TimeProvider::GetSteadyTimestampInNanoseconds() -
                checkpoint_generation_start_timestamp)
                .count());
 
   execution_result =
-      Store(checkpoint_id, last_check_point_buffer, checkpoint_buffer);
+      Store(checkpoint_id, last_check_point_buffer, checkpoint_buffers);
   if (!execution_result.Successful()) {
     return execution_result;
   }
 
   last_processed_journal_id_ = last_processed_journal_id;
   last_persisted_checkpoint_id_ = checkpoint_id;
+  if (is_pending_checkpoint_delta_) {
+    delta_checkpoint_chain_length_++;
+  } else {
+    delta_checkpoint_chain_length_ = 0;
+    has_transactions_in_checkpoint_chain_ = false;
+  }
+  has_transactions_in_checkpoint_chain_ |=
+      has_transactions_in_pending_checkpoint_;
   SCP_INFO(kCheckpointService, activity_id_,
            "Partition with ID: '%s' Checkpointing Done. "
            "Last processed journal id: '%llu'. Last persisted checkpoint id: "
@@ -269,6 +455,95 @@ ExecutionResult CheckpointService::RunCheckpointWorker() noexcept {
   return Shutdown();
 }
 
+ExecutionResult CheckpointService::RunLiveSnapshotCheckpoint() noexcept {
+  auto checkpoint_round_start_timestamp =
+      TimeProvider::GetSteadyTimestampInNanoseconds();
+
+  // While the flushing is paused, no log is acknowledged, so the state
+  // applied from the logs is exactly the replay of the persisted journals.
+  // The changes made before their logs are journaled are not checkpointed.
+  JournalId last_persisted_journal_id = 0;
+  auto execution_result = application_journal_service_->PauseFlushing(
+      kLiveSnapshotFlushingPauseMaxWaitInMilliseconds,
+      last_persisted_journal_id);
+  if (!execution_result.Successful()) {
+    SCP_INFO(kCheckpointService, activity_id_,
+             "Cannot pause the flushing of the journals of the live "
+             "partition. Not checkpointing.");
+    return FailureExecutionResult(
+        core::errors::SC_PBS_CHECKPOINT_SERVICE_PARTITION_NOT_QUIESCENT);
+  }
+
+  auto checkpoint_logs = make_shared<list<CheckpointLog>>();
+  if (last_persisted_journal_id != last_processed_journal_id_) {
+    execution_result =
+        live_transaction_manager_->CheckpointLive(checkpoint_logs);
+    has_transactions_in_pending_checkpoint_ = !checkpoint_logs->empty();
+    if (execution_result.Successful()) {
+      execution_result = live_budget_key_provider_->Checkpoint(checkpoint_logs);
+    }
+  }
+
+  auto resume_execution_result = application_journal_service_->ResumeFlushing();
+  if (!resume_execution_result.Successful()) {
+    SCP_ERROR(kCheckpointService, activity_id_, resume_execution_result,
+              "Cannot resume the flushing of the journals of the live "
+              "partition.");
+  }
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  if (last_persisted_journal_id == last_processed_journal_id_) {
+    SCP_INFO(kCheckpointService, activity_id_,
+             "Last persisted journal is same as the one authored in the most "
+             "recent checkpointing activity. Nothing new to checkpoint.");
+    return SuccessExecutionResult();
+  }
+
+  if (checkpoint_logs->size() == 0) {
+    SCP_INFO(kCheckpointService, activity_id_,
+             "No checkpoint logs found in the live partition. No new "
+             "checkpoint file will be created.");
+    return FailureExecutionResult(
+        core::errors::SC_PBS_CHECKPOINT_SERVICE_NO_LOGS_TO_PROCESS);
+  }
+
+  is_pending_checkpoint_delta_ = false;
+  CheckpointId checkpoint_id = 0;
+  vector<BytesBuffer> checkpoint_buffers;
+  BytesBuffer last_check_point_buffer(initial_buffer_size_);
+  execution_result = SerializeCheckpoint(
+      last_persisted_journal_id, *checkpoint_logs, checkpoint_id,
+      last_check_point_buffer, checkpoint_buffers);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  execution_result =
+      Store(checkpoint_id, last_check_point_buffer, checkpoint_buffers);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  last_processed_journal_id_ = last_persisted_journal_id;
+  last_persisted_checkpoint_id_ = checkpoint_id;
+  delta_checkpoint_chain_length_ = 0;
+  has_transactions_in_checkpoint_chain_ =
+      has_transactions_in_pending_checkpoint_;
+  SCP_INFO(kCheckpointService, activity_id_,
+           "Partition with ID: '%s' Checkpointing from the live partition "
+           "Done. Last processed journal id: '%llu'. Last persisted checkpoint "
+           "id: '%llu'. Time taken for this checkpoint run: '%llu' (ms)",
+           ToString(partition_id_).c_str(), last_processed_journal_id_,
+           last_persisted_checkpoint_id_,
+           duration_cast<milliseconds>(
+               TimeProvider::GetSteadyTimestampInNanoseconds() -
+               checkpoint_round_start_timestamp)
+               .count());
+  return SuccessExecutionResult();
+}
+
 void CheckpointService::CreateComponents() noexcept {
   async_executor_ = make_shared<AsyncExecutor>(4, 100000);
   io_async_executor_ = make_shared<AsyncExecutor>(8, 100000);
@@ -347,6 +622,10 @@ ExecutionResult CheckpointService::Recover(
   // there is nothing to be checkpointed after recovery.
   recovery_context.request
       ->should_perform_recovery_with_only_checkpoint_in_stream = false;
+  recovery_context.request->should_track_recovered_components =
+      max_delta_checkpoint_chain_length_ > 0;
+  recovered_checkpoint_id_ = core::kInvalidCheckpointId;
+  recovered_components_ = nullptr;
   recovery_context.parent_activity_id = activity_id_;
   recovery_context.correlation_id = activity_id_;
   recovery_context.callback =
@@ -355,6 +634,10 @@ ExecutionResult CheckpointService::Recover(
         if (recovery_context.result.Successful()) {
           last_processed_journal_id =
               recovery_context.response->last_processed_journal_id;
+          recovered_checkpoint_id_ =
+              recovery_context.response->last_checkpoint_id;
+          recovered_components_ =
+              recovery_context.response->recovered_components;
         }
         recovery_execution_result.set_value(recovery_context.result);
       };
@@ -370,24 +653,40 @@ ExecutionResult CheckpointService::Recover(
   return future_result;
 }
 
+bool CheckpointService::CanCheckpointDelta() noexcept {
+  // A delta is only replayed on top of the checkpoint it was built from, so
+  // the recovered checkpoint must be the one this service persisted last.
+  return max_delta_checkpoint_chain_length_ > 0 && recovered_components_ &&
+         recovered_checkpoint_id_ != core::kInvalidCheckpointId &&
+         recovered_checkpoint_id_ == last_persisted_checkpoint_id_ &&
+         delta_checkpoint_chain_length_ < max_delta_checkpoint_chain_length_ &&
+         !has_transactions_in_checkpoint_chain_;
+}
+
 ExecutionResult CheckpointService::Checkpoint(
     JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
     BytesBuffer& last_checkpoint_buffer,
-    BytesBuffer& checkpoint_buffer) noexcept {
-  LastCheckpointMetadata last_checkpoint_metadata;
-  CheckpointMetadata checkpoint_metadata;
+    vector<BytesBuffer>& checkpoint_buffers) noexcept {
   auto checkpoint_logs = make_shared<list<CheckpointLog>>();
   auto execution_result = transaction_manager_->Checkpoint(checkpoint_logs);
   if (!execution_result.Successful()) {
     return execution_result;
   }
 
-  execution_result = budget_key_provider_->Checkpoint(checkpoint_logs);
+  is_pending_checkpoint_delta_ = CanCheckpointDelta();
+  has_transactions_in_pending_checkpoint_ = !checkpoint_logs->empty();
+  if (is_pending_checkpoint_delta_) {
+    execution_result = budget_key_provider_->CheckpointDelta(
+        *recovered_components_, checkpoint_logs);
+  } else {
+    execution_result = budget_key_provider_->Checkpoint(checkpoint_logs);
+  }
   if (!execution_result.Successful()) {
     return execution_result;
   }
 
-  if (checkpoint_logs->size() == 0) {
+  // An empty delta still moves the checkpoint past the recovered journals.
+  if (checkpoint_logs->size() == 0 && !is_pending_checkpoint_delta_) {
     SCP_INFO(
         kCheckpointService, activity_id_,
         "No new checkpoint logs found from transaction manager "
@@ -396,22 +695,54 @@ ExecutionResult CheckpointService::Checkpoint(
         core::errors::SC_PBS_CHECKPOINT_SERVICE_NO_LOGS_TO_PROCESS);
   }
 
+  return SerializeCheckpoint(last_processed_journal_id, *checkpoint_logs,
+                             checkpoint_id, last_checkpoint_buffer,
+                             checkpoint_buffers);
+}
+
+ExecutionResult CheckpointService::SerializeCheckpoint(
+    JournalId last_processed_journal_id,
+    const list<CheckpointLog>& checkpoint_logs, CheckpointId& checkpoint_id,
+    BytesBuffer& last_checkpoint_buffer,
+    vector<BytesBuffer>& checkpoint_buffers) noexcept {
+  LastCheckpointMetadata last_checkpoint_metadata;
+  CheckpointMetadata checkpoint_metadata;
+  if (is_pending_checkpoint_delta_) {
+    checkpoint_metadata.set_base_checkpoint_id(recovered_checkpoint_id_);
+  }
+
   SCP_INFO(kCheckpointService, activity_id_,
-           "Total log count in this checkpoint file: '%llu'",
-           checkpoint_logs->size());
+           "Total log count in this checkpoint file: '%llu'. Base checkpoint "
+           "id: '%llu'",
+           checkpoint_logs.size(), checkpoint_metadata.base_checkpoint_id());
 
   // Unique wall-clock timestamp is used for checkpoint_id
   Timestamp current_clock =
       TimeProvider::GetUniqueWallTimestampInNanoseconds().count();
   checkpoint_id = current_clock;
   last_checkpoint_metadata.set_last_checkpoint_id(checkpoint_id);
+  // The standbys of the partition only tail the journals up to this one.
+  last_checkpoint_metadata.set_last_processed_journal_id(
+      last_processed_journal_id);
+
+  // Each shard is replayed after the previous one, and its logs in their
+  // order. A delta is always based on a checkpoint persisted by this service,
+  // which has the same number of shards.
+  auto shard_count = checkpoint_shard_count_;
+  if (shard_count > 1) {
+    last_checkpoint_metadata.set_last_checkpoint_shard_count(shard_count);
+    checkpoint_metadata.set_shard_count(shard_count);
+    if (is_pending_checkpoint_delta_) {
+      checkpoint_metadata.set_base_checkpoint_shard_count(shard_count);
+    }
+  }
+
   SCP_INFO(kCheckpointService, activity_id_,
            "Last checkpoint id set to '%llu'. This id will be persisted in "
-           "last_checkpoint file",
-           checkpoint_id);
-  size_t current_buffer_offset = 0;
+           "last_checkpoint file. Number of shards: '%zu'",
+           checkpoint_id, shard_count);
   size_t current_bytes_serialized = 0;
-  execution_result = JournalSerialization::SerializeLastCheckpointMetadata(
+  auto execution_result = JournalSerialization::SerializeLastCheckpointMetadata(
       last_checkpoint_buffer, 0, last_checkpoint_metadata,
       current_bytes_serialized);
   if (!execution_result.Successful()) {
@@ -419,90 +750,107 @@ ExecutionResult CheckpointService::Checkpoint(
   }
   last_checkpoint_buffer.length = current_bytes_serialized;
 
-  current_buffer_offset = 0;
-  current_bytes_serialized = 0;
-  for (auto checkpoint_log = checkpoint_logs->begin();
-       checkpoint_log != checkpoint_logs->end(); ++checkpoint_log) {
-    auto successfully_written = false;
-    auto buffer_offset_before_serialization = current_buffer_offset;
-
-    while (!successfully_written) {
-      auto execution_result = JournalSerialization::SerializeLogHeader(
-          checkpoint_buffer, current_buffer_offset, current_clock,
-          checkpoint_log->log_status, checkpoint_log->component_id,
-          checkpoint_log->log_id, current_bytes_serialized);
-
-      if (!execution_result.Successful()) {
-        if (execution_result ==
-            FailureExecutionResult(
-                core::errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE)) {
-          current_buffer_offset = buffer_offset_before_serialization;
-          checkpoint_buffer.bytes->resize(2 * checkpoint_buffer.bytes->size());
-          checkpoint_buffer.capacity = 2 * checkpoint_buffer.capacity;
-          continue;
-        }
-
-        return execution_result;
-      }
+  if (checkpoint_buffers.size() > shard_count) {
+    checkpoint_buffers.erase(checkpoint_buffers.begin() + shard_count,
+                             checkpoint_buffers.end());
+  }
+  while (checkpoint_buffers.size() < shard_count) {
+    checkpoint_buffers.emplace_back(
+        std::max<size_t>(initial_buffer_size_ / shard_count, 1));
+  }
 
-      successfully_written = true;
+  vector<size_t> buffer_offsets(shard_count, 0);
+  for (const auto& checkpoint_log : checkpoint_logs) {
+    auto shard_index = checkpoint_log.shard_key % shard_count;
+    execution_result =
+        SerializeCheckpointLog(checkpoint_log, current_clock,
+                               checkpoint_buffers[shard_index],
+                               buffer_offsets[shard_index]);
+    if (!execution_result.Successful()) {
+      return execution_result;
     }
-
     last_persisted_checkpoint_id_ = checkpoint_id;
-    current_buffer_offset += current_bytes_serialized;
-    current_bytes_serialized = 0;
-
-    JournalLog journal_log;
-    journal_log.set_log_body(checkpoint_log->bytes_buffer.bytes->data(),
-                             checkpoint_log->bytes_buffer.length);
-
-    successfully_written = false;
-    buffer_offset_before_serialization = current_buffer_offset;
-
-    while (!successfully_written) {
-      execution_result = JournalSerialization::SerializeJournalLog(
-          checkpoint_buffer, current_buffer_offset, journal_log,
-          current_bytes_serialized);
-
-      if (!execution_result.Successful()) {
-        if (execution_result ==
-            FailureExecutionResult(
-                core::errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE)) {
-          current_buffer_offset = buffer_offset_before_serialization;
-          checkpoint_buffer.bytes->resize(2 * checkpoint_buffer.bytes->size());
-          checkpoint_buffer.capacity = 2 * checkpoint_buffer.capacity;
-          continue;
-        }
+  }
 
-        return execution_result;
-      }
-      successfully_written = true;
+  checkpoint_metadata.set_last_processed_journal_id(last_processed_journal_id);
+  for (size_t shard_index = 0; shard_index < shard_count; ++shard_index) {
+    auto& checkpoint_buffer = checkpoint_buffers[shard_index];
+    checkpoint_buffer.length = buffer_offsets[shard_index];
+
+    if (checkpoint_buffer.capacity - checkpoint_buffer.length <
+        kBufferIncreaseThreshold) {
+      checkpoint_buffer.bytes->resize(checkpoint_buffer.capacity +
+                                      kBufferIncreaseThreshold);
+      checkpoint_buffer.capacity += kBufferIncreaseThreshold;
     }
 
-    current_buffer_offset += current_bytes_serialized;
     current_bytes_serialized = 0;
+    execution_result = JournalSerialization::SerializeCheckpointMetadata(
+        checkpoint_buffer, checkpoint_buffer.length, checkpoint_metadata,
+        current_bytes_serialized);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    checkpoint_buffer.length += current_bytes_serialized;
   }
+  return execution_result;
+}
+
+ExecutionResult CheckpointService::SerializeCheckpointLog(
+    const CheckpointLog& checkpoint_log, Timestamp timestamp,
+    BytesBuffer& checkpoint_buffer, size_t& buffer_offset) noexcept {
+  size_t current_bytes_serialized = 0;
+  auto successfully_written = false;
+  while (!successfully_written) {
+    auto execution_result = JournalSerialization::SerializeLogHeader(
+        checkpoint_buffer, buffer_offset, timestamp, checkpoint_log.log_status,
+        checkpoint_log.component_id, checkpoint_log.log_id,
+        current_bytes_serialized);
+
+    if (!execution_result.Successful()) {
+      if (execution_result ==
+          FailureExecutionResult(
+              core::errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE)) {
+        checkpoint_buffer.bytes->resize(2 * checkpoint_buffer.bytes->size());
+        checkpoint_buffer.capacity = 2 * checkpoint_buffer.capacity;
+        continue;
+      }
 
-  checkpoint_buffer.length = current_buffer_offset;
+      return execution_result;
+    }
 
-  if (checkpoint_buffer.capacity - checkpoint_buffer.length <
-      kBufferIncreaseThreshold) {
-    checkpoint_buffer.bytes->resize(checkpoint_buffer.capacity +
-                                    kBufferIncreaseThreshold);
-    checkpoint_buffer.capacity += kBufferIncreaseThreshold;
+    successfully_written = true;
   }
 
-  checkpoint_metadata.set_last_processed_journal_id(last_processed_journal_id);
+  buffer_offset += current_bytes_serialized;
   current_bytes_serialized = 0;
-  execution_result = JournalSerialization::SerializeCheckpointMetadata(
-      checkpoint_buffer, current_buffer_offset, checkpoint_metadata,
-      current_bytes_serialized);
-  if (!execution_result.Successful()) {
-    return execution_result;
+
+  JournalLog journal_log;
+  journal_log.set_log_body(checkpoint_log.bytes_buffer.bytes->data(),
+                           checkpoint_log.bytes_buffer.length);
+
+  successfully_written = false;
+  while (!successfully_written) {
+    auto execution_result = JournalSerialization::SerializeJournalLog(
+        checkpoint_buffer, buffer_offset, journal_log,
+        current_bytes_serialized);
+
+    if (!execution_result.Successful()) {
+      if (execution_result ==
+          FailureExecutionResult(
+              core::errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE)) {
+        checkpoint_buffer.bytes->resize(2 * checkpoint_buffer.bytes->size());
+        checkpoint_buffer.capacity = 2 * checkpoint_buffer.capacity;
+        continue;
+      }
+
+      return execution_result;
+    }
+    successfully_written = true;
   }
 
-  checkpoint_buffer.length += current_bytes_serialized;
-  return execution_result;
+  buffer_offset += current_bytes_serialized;
+  return SuccessExecutionResult();
 }
 
 ExecutionResult CheckpointService::WriteBlob(
@@ -530,9 +878,41 @@ ExecutionResult CheckpointService::WriteBlob(
   return put_blob_execution_result.get_future().get();
 }
 
+ExecutionResult CheckpointService::WriteBlobs(
+    shared_ptr<BlobStorageClientInterface>& blob_storage_client,
+    vector<shared_ptr<string>>& blob_names,
+    vector<shared_ptr<BytesBuffer>>& bytes_buffers) noexcept {
+  vector<future<ExecutionResult>> write_blob_results;
+  for (size_t i = 0; i < blob_names.size(); ++i) {
+    auto write_blob_result = make_shared<promise<ExecutionResult>>();
+    write_blob_results.push_back(write_blob_result->get_future());
+    // The references outlive the writes, which are all waited for below.
+    auto write_blob = [this, &blob_storage_client, &blob_names, &bytes_buffers,
+                       write_blob_result, i]() {
+      write_blob_result->set_value(
+          WriteBlob(blob_storage_client, blob_names[i], bytes_buffers[i]));
+    };
+
+    if (blob_names.size() == 1 || !io_async_executor_ ||
+        !io_async_executor_->Schedule(write_blob, AsyncPriority::Normal)
+             .Successful()) {
+      write_blob();
+    }
+  }
+
+  ExecutionResult execution_result = SuccessExecutionResult();
+  for (auto& write_blob_result : write_blob_results) {
+    auto write_blob_execution_result = write_blob_result.get();
+    if (execution_result.Successful()) {
+      execution_result = write_blob_execution_result;
+    }
+  }
+  return execution_result;
+}
+
 ExecutionResult CheckpointService::Store(
     CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
-    BytesBuffer& checkpoint_buffer) noexcept {
+    vector<BytesBuffer>& checkpoint_buffers) noexcept {
   shared_ptr<BlobStorageClientInterface> blob_storage_client;
   auto execution_result =
       blob_storage_provider_->CreateBlobStorageClient(blob_storage_client);
@@ -540,23 +920,33 @@ ExecutionResult CheckpointService::Store(
     return execution_result;
   }
 
-  shared_ptr<string> checkpoint_blob_name;
-  execution_result = JournalUtils::CreateCheckpointBlobName(
-      partition_name_, checkpoint_id, checkpoint_blob_name);
-  if (!execution_result.Successful()) {
-    return execution_result;
+  vector<shared_ptr<string>> checkpoint_blob_names;
+  vector<shared_ptr<BytesBuffer>> checkpoint_buffer_ptrs;
+  for (size_t shard_index = 0; shard_index < checkpoint_buffers.size();
+       ++shard_index) {
+    shared_ptr<string> checkpoint_blob_name;
+    execution_result = JournalUtils::CreateCheckpointShardBlobName(
+        partition_name_, checkpoint_id, shard_index, checkpoint_blob_name);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+    checkpoint_blob_names.push_back(checkpoint_blob_name);
+    checkpoint_buffer_ptrs.push_back(
+        make_shared<BytesBuffer>(checkpoint_buffers[shard_index]));
   }
 
-  auto checkpoint_buffer_ptr = make_shared<BytesBuffer>(checkpoint_buffer);
-  execution_result = WriteBlob(blob_storage_client, checkpoint_blob_name,
-                               checkpoint_buffer_ptr);
+  // The checkpoint is only visible once last_checkpoint points to it, so all
+  // of its shards must be written first.
+  execution_result = WriteBlobs(blob_storage_client, checkpoint_blob_names,
+                                checkpoint_buffer_ptrs);
   if (!execution_result.Successful()) {
     return execution_result;
   }
 
   SCP_INFO(kCheckpointService, activity_id_,
-           "Wrote Checkpoint file with file name : %s",
-           checkpoint_blob_name->c_str());
+           "Wrote Checkpoint file with file name : %s. Number of shards: %zu",
+           checkpoint_blob_names.front()->c_str(),
+           checkpoint_blob_names.size());
   shared_ptr<string> last_checkpoint_blob_name =
       make_shared<string>(kLastCheckpointBlobName);
   shared_ptr<string> last_checkpoint_full_path;
@@ -571,6 +961,54 @@ ExecutionResult CheckpointService::Store(
                    last_checkpoint_buffer_ptr);
 }
 
+ExecutionResult CheckpointService::CompactJournals() noexcept {
+  // Before the first checkpoint, the journals the recovery starts from are not
+  // known.
+  if (!enable_journal_compaction_ || last_persisted_checkpoint_id_ == 0) {
+    return SuccessExecutionResult();
+  }
+
+  // Only the journals that are all written are compacted, so that none is
+  // written in the middle of a segment afterwards.
+  JournalId max_journal_id = 0;
+  auto execution_result =
+      application_journal_service_->GetLastPersistedJournalId(max_journal_id);
+  if (!execution_result.Successful()) {
+    return SuccessExecutionResult();
+  }
+
+  shared_ptr<BlobStorageClientInterface> blob_storage_client;
+  execution_result =
+      blob_storage_provider_->CreateBlobStorageClient(blob_storage_client);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  auto compaction_start_timestamp =
+      TimeProvider::GetSteadyTimestampInNanoseconds();
+  JournalCompactor journal_compactor(
+      bucket_name_, partition_name_, blob_storage_client,
+      journals_per_compacted_segment_, journal_blob_compression_level_,
+      activity_id_);
+  size_t compacted_journal_count = 0;
+  execution_result = journal_compactor.Compact(
+      last_processed_journal_id_, max_journal_id, compacted_journal_count);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  SCP_INFO(kCheckpointService, activity_id_,
+           "Partition with ID: '%s' compacted %zu journals after the journal "
+           "id '%llu'. Time taken: '%llu' (ms)",
+           ToString(partition_id_).c_str(), compacted_journal_count,
+           last_processed_journal_id_,
+           duration_cast<milliseconds>(
+               TimeProvider::GetSteadyTimestampInNanoseconds() -
+               compaction_start_timestamp)
+               .count());
+  return SuccessExecutionResult();
+}
+
 ExecutionResult CheckpointService::Shutdown() noexcept {
   try {
     if (io_async_executor_) {
@@ -593,6 +1031,7 @@ ExecutionResult CheckpointService::Shutdown() noexcept {
   budget_key_provider_ = nullptr;
   transaction_command_serializer_ = nullptr;
   transaction_manager_ = nullptr;
+  recovered_components_ = nullptr;
   return SuccessExecutionResult();
 }
 
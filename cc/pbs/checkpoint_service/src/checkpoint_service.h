@@ -19,9 +19,12 @@
 #include <stddef.h>
 
 #include <atomic>
+#include <chrono>
+#include <list>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_executor_interface.h"
@@ -60,6 +63,36 @@ class CheckpointService : public core::CheckpointServiceInterface {
       const std::shared_ptr<core::BlobStorageProviderInterface>&
           blob_storage_provider,
       size_t initial_buffer_size = kCheckpointInitialBufferSize)
+      : CheckpointService(bucket_name, partition_name, metric_client,
+                          metric_router, config_provider,
+                          application_journal_service, blob_storage_provider,
+                          nullptr /* live_budget_key_provider */,
+                          nullptr /* live_transaction_manager */,
+                          initial_buffer_size) {}
+
+  /**
+   * @brief Construct a new Checkpoint Service object which can also take the
+   * checkpoints from the state of the live partition, see
+   * kPBSJournalCheckpointingEnableLiveSnapshot.
+   *
+   * @param live_budget_key_provider The budget key provider of the partition.
+   * @param live_transaction_manager The transaction manager of the partition.
+   */
+  CheckpointService(
+      std::shared_ptr<std::string>& bucket_name,
+      std::shared_ptr<std::string>& partition_name,
+      const std::shared_ptr<cpio::MetricClientInterface>& metric_client,
+      std::shared_ptr<core::MetricRouter> metric_router,
+      const std::shared_ptr<core::ConfigProviderInterface>& config_provider,
+      const std::shared_ptr<core::JournalServiceInterface>&
+          application_journal_service,
+      const std::shared_ptr<core::BlobStorageProviderInterface>&
+          blob_storage_provider,
+      const std::shared_ptr<pbs::BudgetKeyProviderInterface>&
+          live_budget_key_provider,
+      const std::shared_ptr<core::TransactionManagerInterface>&
+          live_transaction_manager,
+      size_t initial_buffer_size = kCheckpointInitialBufferSize)
       : is_running_(false),
         bucket_name_(bucket_name),
         partition_name_(partition_name),
@@ -71,8 +104,27 @@ class CheckpointService : public core::CheckpointServiceInterface {
         config_provider_(config_provider),
         application_journal_service_(application_journal_service),
         blob_storage_provider_(blob_storage_provider),
+        live_budget_key_provider_(live_budget_key_provider),
+        live_transaction_manager_(live_transaction_manager),
         checkpointing_interval_in_seconds_(0),
-        max_journals_to_process_in_each_checkpoint_run_(0) {}
+        max_journals_to_process_in_each_checkpoint_run_(0),
+        max_delta_checkpoint_chain_length_(0),
+        checkpoint_shard_count_(1),
+        enable_live_snapshot_(false),
+        delta_checkpoint_chain_length_(0),
+        has_transactions_in_checkpoint_chain_(false),
+        recovered_checkpoint_id_(core::kInvalidCheckpointId),
+        is_pending_checkpoint_delta_(false),
+        has_transactions_in_pending_checkpoint_(false),
+        enable_journal_compaction_(false),
+        journals_per_compacted_segment_(0),
+        journal_blob_compression_level_(0),
+        checkpoint_log_count_threshold_(0),
+        checkpoint_log_bytes_threshold_(0),
+        max_checkpointing_interval_in_seconds_(0),
+        round_start_timestamp_(0),
+        round_start_appended_log_count_(0),
+        round_start_appended_log_bytes_(0) {}
 
   core::ExecutionResult Init() noexcept override;
 
@@ -94,6 +146,17 @@ class CheckpointService : public core::CheckpointServiceInterface {
    */
   virtual core::ExecutionResult RunCheckpointWorker() noexcept;
 
+  /**
+   * @brief Checkpoints the state of the live partition, without recovering the
+   * journals. The flushing of the journals is paused while the state is read,
+   * so that it is exactly the replay of the persisted journals.
+   *
+   * @return core::ExecutionResult The execution result of the operation.
+   * SC_PBS_CHECKPOINT_SERVICE_PARTITION_NOT_QUIESCENT if the flushing could
+   * not be paused.
+   */
+  virtual core::ExecutionResult RunLiveSnapshotCheckpoint() noexcept;
+
   /**
    * @brief Initializes and runs all the underlying components.
    *
@@ -118,14 +181,54 @@ class CheckpointService : public core::CheckpointServiceInterface {
    * @param last_processed_journal_id The last processed journal id.
    * @param checkpoint_id The checkpoint id to be created.
    * @param last_checkpoint_buffer The last checkpoint file contents.
-   * @param checkpoint_buffer The current checkpoint file content.
+   * @param checkpoint_buffers The current checkpoint file contents, one per
+   * shard. Missing buffers are created.
    * @return core::ExecutionResult The execution result of the operation.
    */
   virtual core::ExecutionResult Checkpoint(
       core::JournalId last_processed_journal_id,
       core::CheckpointId& checkpoint_id,
       core::BytesBuffer& last_checkpoint_buffer,
-      core::BytesBuffer& checkpoint_buffer) noexcept;
+      std::vector<core::BytesBuffer>& checkpoint_buffers) noexcept;
+
+  /**
+   * @brief Serializes the checkpoint logs into the shard buffers, followed by
+   * the checkpoint metadata, and the last checkpoint metadata.
+   *
+   * @param last_processed_journal_id The last processed journal id.
+   * @param checkpoint_logs The checkpoint logs.
+   * @param checkpoint_id The checkpoint id to be created.
+   * @param last_checkpoint_buffer The last checkpoint file contents.
+   * @param checkpoint_buffers The current checkpoint file contents, one per
+   * shard. Missing buffers are created.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult SerializeCheckpoint(
+      core::JournalId last_processed_journal_id,
+      const std::list<core::CheckpointLog>& checkpoint_logs,
+      core::CheckpointId& checkpoint_id,
+      core::BytesBuffer& last_checkpoint_buffer,
+      std::vector<core::BytesBuffer>& checkpoint_buffers) noexcept;
+
+  /**
+   * @brief Serializes a checkpoint log at the offset of the buffer, growing
+   * the buffer as needed.
+   *
+   * @param checkpoint_log The checkpoint log to serialize.
+   * @param timestamp The timestamp of the log header.
+   * @param checkpoint_buffer The buffer to serialize into.
+   * @param buffer_offset The offset to serialize at, moved past the log.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult SerializeCheckpointLog(
+      const core::CheckpointLog& checkpoint_log, core::Timestamp timestamp,
+      core::BytesBuffer& checkpoint_buffer, size_t& buffer_offset) noexcept;
+
+  /**
+   * @brief Returns true if the recovered state can be checkpointed as a delta
+   * on top of the recovered checkpoint.
+   */
+  virtual bool CanCheckpointDelta() noexcept;
 
   /**
    * @brief Writes a blob into the blob storage service.
@@ -141,17 +244,62 @@ class CheckpointService : public core::CheckpointServiceInterface {
       std::shared_ptr<core::BytesBuffer>& bytes_buffer);
 
   /**
-   * @brief Stores the checkpoint and last_checkpoint blob.
+   * @brief Writes the blobs in parallel on the IO async executor and waits for
+   * all of them.
+   *
+   * @param blob_storage_client The blob storage client.
+   * @param blob_names The blob names to write to.
+   * @param bytes_buffers The bytes to be written to each blob.
+   * @return core::ExecutionResult The execution result of the operation, the
+   * first failure if any.
+   */
+  core::ExecutionResult WriteBlobs(
+      std::shared_ptr<core::BlobStorageClientInterface>& blob_storage_client,
+      std::vector<std::shared_ptr<std::string>>& blob_names,
+      std::vector<std::shared_ptr<core::BytesBuffer>>& bytes_buffers) noexcept;
+
+  /**
+   * @brief Stores the checkpoint shards and then the last_checkpoint blob.
    *
    * @param checkpoint_id The checkpoint id to be written.
    * @param last_checkpoint_buffer The last checkpoint data to be written.
-   * @param checkpoint_buffer The checkpoint data to be written.
+   * @param checkpoint_buffers The checkpoint data to be written, one per
+   * shard.
    * @return core::ExecutionResult The execution result of the operation.
    */
   virtual core::ExecutionResult Store(
       core::CheckpointId& checkpoint_id,
       core::BytesBuffer& last_checkpoint_buffer,
-      core::BytesBuffer& checkpoint_buffer) noexcept;
+      std::vector<core::BytesBuffer>& checkpoint_buffers) noexcept;
+
+  /**
+   * @brief Records the time and the journal volume of the partition at the
+   * start of a checkpointing run.
+   */
+  void StartCheckpointRound() noexcept;
+
+  /**
+   * @brief Waits until the next checkpointing run is due, or the service is
+   * stopped.
+   */
+  virtual void WaitForNextCheckpointRound() noexcept;
+
+  /**
+   * @brief Returns true if the partition journaled enough since the start of
+   * the last checkpointing run to checkpoint again, see
+   * kPBSJournalCheckpointingLogCountThreshold, or if the max interval elapsed.
+   */
+  virtual bool IsCheckpointRoundDue() noexcept;
+
+  /**
+   * @brief Compacts the journals after the last checkpoint into segments, for
+   * the recoveries to read fewer blobs, see
+   * kPBSJournalServiceEnableJournalCompaction. Nothing is compacted before the
+   * first checkpoint of the service.
+   *
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult CompactJournals() noexcept;
 
   /**
    * @brief Shuts down all the components and then nullifies the pointers.
@@ -206,11 +354,59 @@ class CheckpointService : public core::CheckpointServiceInterface {
   core::common::Uuid activity_id_;
   /// An instance of the blob storage provider.
   std::shared_ptr<core::BlobStorageProviderInterface> blob_storage_provider_;
+  /// The budget key provider of the live partition, if any.
+  std::shared_ptr<pbs::BudgetKeyProviderInterface> live_budget_key_provider_;
+  /// The transaction manager of the live partition, if any.
+  std::shared_ptr<core::TransactionManagerInterface> live_transaction_manager_;
   /// Time between checkpointing runs.
   size_t checkpointing_interval_in_seconds_;
   /// Maximum number of journal entries to process in each checkpointing run.
   size_t max_journals_to_process_in_each_checkpoint_run_;
   /// Encapsulating partition ID
   core::PartitionId partition_id_;
+  /// Maximum number of delta checkpoints on top of a full checkpoint. Zero
+  /// disables delta checkpoints.
+  size_t max_delta_checkpoint_chain_length_;
+  /// Number of blobs each checkpoint is split into, by the shard keys of the
+  /// logs.
+  size_t checkpoint_shard_count_;
+  /// Whether the checkpoints are first attempted from the state of the live
+  /// partition.
+  bool enable_live_snapshot_;
+  /// Number of delta checkpoints on top of the last persisted full checkpoint.
+  size_t delta_checkpoint_chain_length_;
+  /// Whether the checkpoints since the last persisted full checkpoint have
+  /// transaction logs. A delta cannot remove the transactions finished since,
+  /// so such a chain is compacted.
+  bool has_transactions_in_checkpoint_chain_;
+  /// The id of the checkpoint the last recovery started from.
+  core::CheckpointId recovered_checkpoint_id_;
+  /// The components of the logs of the last recovery.
+  std::shared_ptr<core::JournalRecoveredComponents> recovered_components_;
+  /// Whether the checkpoint built by the current run is a delta.
+  bool is_pending_checkpoint_delta_;
+  /// Whether the checkpoint built by the current run has transaction logs.
+  bool has_transactions_in_pending_checkpoint_;
+  /// Whether the journals after the last checkpoint are compacted into
+  /// segments between the checkpoints.
+  bool enable_journal_compaction_;
+  /// The number of journals of each compacted segment.
+  size_t journals_per_compacted_segment_;
+  /// The zlib compression level of the compacted segments.
+  size_t journal_blob_compression_level_;
+  /// The number of logs journaled since the start of the last checkpointing
+  /// run that starts the next one. Zero disables the trigger.
+  size_t checkpoint_log_count_threshold_;
+  /// The bytes of logs journaled since the start of the last checkpointing run
+  /// that start the next one. Zero disables the trigger.
+  size_t checkpoint_log_bytes_threshold_;
+  /// The max time between the checkpointing runs, when they are triggered by
+  /// the journal volume.
+  size_t max_checkpointing_interval_in_seconds_;
+  /// The steady time, and the logs journaled by the partition, at the start of
+  /// the last checkpointing run.
+  std::chrono::nanoseconds round_start_timestamp_;
+  size_t round_start_appended_log_count_;
+  size_t round_start_appended_log_bytes_;
 };
 }  // namespace google::scp::pbs
@@ -43,4 +43,9 @@ DEFINE_ERROR_CODE(
     "Last persisted checkpoint Id is invalid. No checkpoint has been persisted "
     "since the start service startup.",
     HttpStatusCode::NO_CONTENT)
+
+DEFINE_ERROR_CODE(SC_PBS_CHECKPOINT_SERVICE_PARTITION_NOT_QUIESCENT,
+                  SC_PBS_CHECKPOINT_SERVICE, 0x0005,
+                  "The partition has logs in flight or pending transactions.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
 }  // namespace google::scp::core::errors
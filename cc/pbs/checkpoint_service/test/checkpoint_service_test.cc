@@ -191,7 +191,8 @@ TEST_F(CheckpointServiceTest, CheckpointFailure) {
 
   mock_checkpoint_service_->checkpoint_mock =
       [](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
-         BytesBuffer& last_checkpoint_buffer, BytesBuffer& checkpoint_buffer) {
+         BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
         return FailureExecutionResult(123);
       };
 
@@ -201,7 +202,9 @@ TEST_F(CheckpointServiceTest, CheckpointFailure) {
   mock_checkpoint_service_->checkpoint_mock =
       [](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
          BytesBuffer& last_checkpoint_buffer,
-         BytesBuffer& checkpoint_buffer) { return RetryExecutionResult(123); };
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return RetryExecutionResult(123);
+      };
 
   EXPECT_EQ(mock_checkpoint_service_->RunCheckpointWorker(),
             RetryExecutionResult(123));
@@ -220,20 +223,24 @@ TEST_F(CheckpointServiceTest, StoreFailure) {
   mock_checkpoint_service_->checkpoint_mock =
       [](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
          BytesBuffer& last_checkpoint_buffer,
-         BytesBuffer& checkpoint_buffer) { return SuccessExecutionResult(); };
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return SuccessExecutionResult();
+      };
 
-  mock_checkpoint_service_->store_mock = [](CheckpointId& checkpoint_id,
-                                            BytesBuffer& last_checkpoint_buffer,
-                                            BytesBuffer& checkpoint_buffer) {
-    return FailureExecutionResult(123);
-  };
+  mock_checkpoint_service_->store_mock =
+      [](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return FailureExecutionResult(123);
+      };
 
   EXPECT_EQ(mock_checkpoint_service_->RunCheckpointWorker(),
             FailureExecutionResult(123));
 
   mock_checkpoint_service_->store_mock =
       [](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
-         BytesBuffer& checkpoint_buffer) { return RetryExecutionResult(123); };
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return RetryExecutionResult(123);
+      };
 
   EXPECT_EQ(mock_checkpoint_service_->RunCheckpointWorker(),
             RetryExecutionResult(123));
@@ -251,16 +258,17 @@ TEST_F(CheckpointServiceTest, GetLastPersistedCheckpointIdFailure) {
 
   mock_checkpoint_service_->checkpoint_mock =
       [](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
-         BytesBuffer& last_checkpoint_buffer, BytesBuffer& checkpoint_buffer) {
+         BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
         checkpoint_id = 123;
         return SuccessExecutionResult();
       };
 
-  mock_checkpoint_service_->store_mock = [](CheckpointId& checkpoint_id,
-                                            BytesBuffer& last_checkpoint_buffer,
-                                            BytesBuffer& checkpoint_buffer) {
-    return FailureExecutionResult(456);
-  };
+  mock_checkpoint_service_->store_mock =
+      [](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return FailureExecutionResult(456);
+      };
 
   mock_checkpoint_service_->shutdown_mock = []() {
     return SuccessExecutionResult();
@@ -296,15 +304,15 @@ TEST_F(CheckpointServiceTest, GetLastPersistedCheckpointIdStaleIfStoreFails) {
   for (int index = 0; index < 2; index++) {
     mock_checkpoint_service_->checkpoint_mock =
         [&](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
-            BytesBuffer& last_checkpoint_buffer,
-            BytesBuffer& checkpoint_buffer) {
+           BytesBuffer& last_checkpoint_buffer,
+           vector<BytesBuffer>& checkpoint_buffers) {
           checkpoint_id = checkpoint_ids.at(index);
           return SuccessExecutionResult();
         };
 
     mock_checkpoint_service_->store_mock =
         [&](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
-            BytesBuffer& checkpoint_buffer) {
+           vector<BytesBuffer>& checkpoint_buffers) {
           return store_mock_results.at(index);
         };
 
@@ -327,14 +335,17 @@ TEST_F(CheckpointServiceTest, ShutdownFailure) {
 
   mock_checkpoint_service_->checkpoint_mock =
       [](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
-         BytesBuffer& last_checkpoint_buffer, BytesBuffer& checkpoint_buffer) {
+         BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
         checkpoint_id = 123;
         return SuccessExecutionResult();
       };
 
   mock_checkpoint_service_->store_mock =
       [](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
-         BytesBuffer& checkpoint_buffer) { return SuccessExecutionResult(); };
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return SuccessExecutionResult();
+      };
 
   mock_checkpoint_service_->shutdown_mock = []() {
     return FailureExecutionResult(123);
@@ -415,13 +426,15 @@ TEST_F(CheckpointServiceTest, Checkpoint) {
   JournalId last_processed_journal_id = 1234;
   CheckpointId checkpoint_id;
   BytesBuffer last_checkpoint_buffer(1);
-  BytesBuffer checkpoint_buffer(1);
+  vector<BytesBuffer> checkpoint_buffers;
+  checkpoint_buffers.emplace_back(1);
+  auto& checkpoint_buffer = checkpoint_buffers.at(0);
   mock_checkpoint_service_->SetBudgetKeyProvider(budget_key_provider);
   mock_checkpoint_service_->SetTransactionManager(transaction_manager);
 
   EXPECT_EQ(mock_checkpoint_service_->Checkpoint(
                 last_processed_journal_id, checkpoint_id,
-                last_checkpoint_buffer, checkpoint_buffer),
+                last_checkpoint_buffer, checkpoint_buffers),
             FailureExecutionResult(
                 core::errors::SC_PBS_CHECKPOINT_SERVICE_NO_LOGS_TO_PROCESS));
 
@@ -454,7 +467,7 @@ TEST_F(CheckpointServiceTest, Checkpoint) {
 
   EXPECT_EQ(mock_checkpoint_service_->Checkpoint(
                 last_processed_journal_id, checkpoint_id,
-                last_checkpoint_buffer, checkpoint_buffer),
+                last_checkpoint_buffer, checkpoint_buffers),
             FailureExecutionResult(
                 core::errors::SC_SERIALIZATION_BUFFER_NOT_WRITABLE));
 
@@ -463,7 +476,7 @@ TEST_F(CheckpointServiceTest, Checkpoint) {
 
   EXPECT_EQ(mock_checkpoint_service_->Checkpoint(
                 last_processed_journal_id, checkpoint_id,
-                last_checkpoint_buffer, checkpoint_buffer),
+                last_checkpoint_buffer, checkpoint_buffers),
             SuccessExecutionResult());
 
   EXPECT_NE(checkpoint_id, 0);
@@ -520,6 +533,450 @@ TEST_F(CheckpointServiceTest, Checkpoint) {
   EXPECT_EQ(total_logs, 4);
 }
 
+TEST_F(CheckpointServiceTest, CheckpointShards) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client_);
+  auto mock_transaction_manager = make_shared<MockTransactionManager>(
+      mock_async_executor, mock_transaction_engine, 1000, mock_metric_client_);
+
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider = nullptr;
+  auto mock_budget_key_provider = make_shared<MockBudgetKeyProvider>(
+      async_executor, mock_journal_service, nosql_database_provider,
+      mock_metric_client_, mock_config_provider_);
+  mock_checkpoint_service_->SetBudgetKeyProvider(
+      static_pointer_cast<BudgetKeyProviderInterface>(
+          mock_budget_key_provider));
+  mock_checkpoint_service_->SetTransactionManager(
+      static_pointer_cast<TransactionManagerInterface>(
+          mock_transaction_manager));
+  mock_checkpoint_service_->SetCheckpointShardCount(2);
+
+  auto transaction_id = Uuid::GenerateUuid();
+  auto transaction = make_shared<Transaction>();
+  transaction->current_phase = TransactionPhase::Commit;
+  transaction->is_coordinated_remotely = true;
+  transaction->is_waiting_for_remote = true;
+  transaction->context.request = make_shared<TransactionRequest>();
+  transaction->context.request->timeout_time = 123456;
+  auto pair = make_pair(transaction_id, transaction);
+  mock_transaction_engine->GetActiveTransactionsMap().Insert(pair, transaction);
+
+  auto budget_key_name = make_shared<BudgetKeyName>("Budget_Key_Name");
+  shared_ptr<BudgetKeyProviderPair> budget_key_provider_pair =
+      make_shared<BudgetKeyProviderPair>();
+  auto mock_budget_key = make_shared<MockBudgetKey>(
+      budget_key_name, Uuid::GenerateUuid(), async_executor,
+      mock_journal_service, nosql_database_provider, mock_metric_client_,
+      mock_config_provider_);
+  budget_key_provider_pair->budget_key =
+      static_pointer_cast<BudgetKeyInterface>(mock_budget_key);
+  budget_key_provider_pair->is_loaded = false;
+  auto budget_key_pair = make_pair(*budget_key_name, budget_key_provider_pair);
+  mock_budget_key_provider->GetBudgetKeys()->Insert(budget_key_pair,
+                                                    budget_key_provider_pair);
+
+  JournalId last_processed_journal_id = 1234;
+  CheckpointId checkpoint_id;
+  BytesBuffer last_checkpoint_buffer(1024);
+  vector<BytesBuffer> checkpoint_buffers;
+  EXPECT_SUCCESS(mock_checkpoint_service_->Checkpoint(
+      last_processed_journal_id, checkpoint_id, last_checkpoint_buffer,
+      checkpoint_buffers));
+  ASSERT_EQ(checkpoint_buffers.size(), 2);
+
+  LastCheckpointMetadata last_checkpoint_metadata;
+  size_t bytes_deserialized = 0;
+  EXPECT_SUCCESS(JournalSerialization::DeserializeLastCheckpointMetadata(
+      last_checkpoint_buffer, 0, last_checkpoint_metadata,
+      bytes_deserialized));
+  EXPECT_EQ(last_checkpoint_metadata.last_checkpoint_id(), checkpoint_id);
+  EXPECT_EQ(last_checkpoint_metadata.last_checkpoint_shard_count(), 2);
+
+  vector<size_t> shard_log_counts;
+  for (auto& checkpoint_buffer : checkpoint_buffers) {
+    CheckpointMetadata checkpoint_metadata;
+    bytes_deserialized = 0;
+    EXPECT_SUCCESS(JournalSerialization::DeserializeCheckpointMetadata(
+        checkpoint_buffer, 0, checkpoint_metadata, bytes_deserialized));
+    EXPECT_EQ(checkpoint_metadata.last_processed_journal_id(),
+              last_processed_journal_id);
+    EXPECT_EQ(checkpoint_metadata.shard_count(), 2);
+    checkpoint_buffer.length -= bytes_deserialized;
+
+    size_t buffer_offset = 0;
+    size_t log_count = 0;
+    while (buffer_offset < checkpoint_buffer.length) {
+      Timestamp timestamp;
+      JournalLogStatus log_status;
+      Uuid component_id;
+      Uuid log_id;
+      bytes_deserialized = 0;
+      EXPECT_SUCCESS(JournalSerialization::DeserializeLogHeader(
+          checkpoint_buffer, buffer_offset, timestamp, log_status,
+          component_id, log_id, bytes_deserialized));
+      buffer_offset += bytes_deserialized;
+
+      JournalLog journal_log;
+      bytes_deserialized = 0;
+      EXPECT_SUCCESS(JournalSerialization::DeserializeJournalLog(
+          checkpoint_buffer, buffer_offset, journal_log, bytes_deserialized));
+      buffer_offset += bytes_deserialized;
+      log_count++;
+    }
+    shard_log_counts.push_back(log_count);
+  }
+
+  // The transaction logs stay in the first shard, and the load log of the
+  // budget key goes to the shard of its name.
+  auto budget_key_shard_index =
+      BudgetKeyProvider::GetCheckpointShardKey(*budget_key_name) % 2;
+  EXPECT_EQ(shard_log_counts[0] + shard_log_counts[1], 4);
+  EXPECT_EQ(shard_log_counts[1], budget_key_shard_index == 1 ? 1 : 0);
+}
+
+TEST_F(CheckpointServiceTest, CheckpointDeltaOnTopOfRecoveredCheckpoint) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      make_shared<MockJournalService>();
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client_);
+  auto mock_transaction_manager = make_shared<MockTransactionManager>(
+      mock_async_executor, mock_transaction_engine, 1000, mock_metric_client_);
+
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider = nullptr;
+  auto mock_budget_key_provider = make_shared<MockBudgetKeyProvider>(
+      async_executor, mock_journal_service, nosql_database_provider,
+      mock_metric_client_, mock_config_provider_);
+  mock_checkpoint_service_->SetBudgetKeyProvider(
+      static_pointer_cast<BudgetKeyProviderInterface>(
+          mock_budget_key_provider));
+  mock_checkpoint_service_->SetTransactionManager(
+      static_pointer_cast<TransactionManagerInterface>(
+          mock_transaction_manager));
+
+  JournalId last_processed_journal_id = 1234;
+  CheckpointId checkpoint_id;
+  BytesBuffer last_checkpoint_buffer(1024);
+  vector<BytesBuffer> checkpoint_buffers;
+  checkpoint_buffers.emplace_back(1);
+  auto& checkpoint_buffer = checkpoint_buffers.at(0);
+
+  // Nothing changed since the recovered checkpoint, but it was not persisted
+  // by this service so there is nothing to build a delta on.
+  mock_checkpoint_service_->SetMaxDeltaCheckpointChainLength(2);
+  mock_checkpoint_service_->SetRecoveredCheckpoint(
+      100, make_shared<core::JournalRecoveredComponents>());
+  mock_checkpoint_service_->SetLastPersistedCheckpointId(99);
+  EXPECT_THAT(mock_checkpoint_service_->Checkpoint(
+                  last_processed_journal_id, checkpoint_id,
+                  last_checkpoint_buffer, checkpoint_buffers),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_PBS_CHECKPOINT_SERVICE_NO_LOGS_TO_PROCESS)));
+
+  mock_checkpoint_service_->SetLastPersistedCheckpointId(100);
+  EXPECT_SUCCESS(mock_checkpoint_service_->Checkpoint(
+      last_processed_journal_id, checkpoint_id, last_checkpoint_buffer,
+      checkpoint_buffers));
+
+  CheckpointMetadata checkpoint_metadata;
+  size_t buffer_offset = 0;
+  size_t bytes_deserialized = 0;
+  EXPECT_SUCCESS(JournalSerialization::DeserializeCheckpointMetadata(
+      checkpoint_buffer, buffer_offset, checkpoint_metadata,
+      bytes_deserialized));
+  EXPECT_EQ(checkpoint_metadata.last_processed_journal_id(),
+            last_processed_journal_id);
+  EXPECT_EQ(checkpoint_metadata.base_checkpoint_id(), 100);
+  // The delta is empty.
+  EXPECT_EQ(checkpoint_buffer.length, bytes_deserialized);
+}
+
+TEST_F(CheckpointServiceTest, LiveSnapshotCheckpoint) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto mock_application_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      mock_application_journal_service;
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client_);
+  auto mock_transaction_manager = make_shared<MockTransactionManager>(
+      mock_async_executor, mock_transaction_engine, 1000, mock_metric_client_);
+  mock_transaction_manager->SetStarted(true);
+
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider = nullptr;
+  auto mock_budget_key_provider = make_shared<MockBudgetKeyProvider>(
+      async_executor, mock_journal_service, nosql_database_provider,
+      mock_metric_client_, mock_config_provider_);
+  auto budget_key_name = make_shared<BudgetKeyName>("Budget_Key_Name");
+  auto budget_key_provider_pair = make_shared<BudgetKeyProviderPair>();
+  budget_key_provider_pair->budget_key = make_shared<MockBudgetKey>(
+      budget_key_name, Uuid::GenerateUuid(), async_executor,
+      mock_journal_service, nosql_database_provider, mock_metric_client_,
+      mock_config_provider_);
+  budget_key_provider_pair->is_load_logged = true;
+  auto budget_key_pair = make_pair(*budget_key_name, budget_key_provider_pair);
+  mock_budget_key_provider->GetBudgetKeys()->Insert(budget_key_pair,
+                                                    budget_key_provider_pair);
+
+  // The checkpoint is taken while the flushing is paused.
+  bool is_flushing_paused = false;
+  size_t pause_count = 0;
+  mock_application_journal_service->pause_flushing_mock =
+      [&](size_t, JournalId& journal_id) {
+        EXPECT_FALSE(is_flushing_paused);
+        is_flushing_paused = true;
+        pause_count++;
+        journal_id = 1234;
+        return SuccessExecutionResult();
+      };
+  mock_application_journal_service->resume_flushing_mock = [&]() {
+    EXPECT_TRUE(is_flushing_paused);
+    is_flushing_paused = false;
+    return SuccessExecutionResult();
+  };
+  mock_checkpoint_service_->SetApplicationJournalService(
+      mock_application_journal_service);
+  mock_checkpoint_service_->EnableLiveSnapshot(
+      static_pointer_cast<BudgetKeyProviderInterface>(mock_budget_key_provider),
+      static_pointer_cast<TransactionManagerInterface>(
+          mock_transaction_manager));
+
+  // The journals are not recovered.
+  mock_checkpoint_service_->bootstrap_mock = []() {
+    return FailureExecutionResult(123);
+  };
+  size_t store_count = 0;
+  CheckpointId stored_checkpoint_id = 0;
+  mock_checkpoint_service_->store_mock =
+      [&](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
+          vector<BytesBuffer>& checkpoint_buffers) {
+        EXPECT_FALSE(is_flushing_paused);
+        store_count++;
+        stored_checkpoint_id = checkpoint_id;
+        LastCheckpointMetadata last_checkpoint_metadata;
+        size_t bytes_deserialized = 0;
+        EXPECT_SUCCESS(JournalSerialization::DeserializeLastCheckpointMetadata(
+            last_checkpoint_buffer, 0, last_checkpoint_metadata,
+            bytes_deserialized));
+        EXPECT_EQ(last_checkpoint_metadata.last_checkpoint_id(),
+                  checkpoint_id);
+        EXPECT_EQ(checkpoint_buffers.size(), 1);
+        EXPECT_GT(checkpoint_buffers[0].length, 0);
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_SUCCESS(mock_checkpoint_service_->RunCheckpointWorker());
+  EXPECT_EQ(store_count, 1);
+  EXPECT_EQ(pause_count, 1);
+  EXPECT_FALSE(is_flushing_paused);
+  EXPECT_NE(stored_checkpoint_id, 0);
+  EXPECT_THAT(mock_checkpoint_service_->GetLastPersistedCheckpointId(),
+              IsSuccessfulAndHolds(stored_checkpoint_id));
+
+  // Nothing was persisted since the snapshot.
+  EXPECT_SUCCESS(mock_checkpoint_service_->RunCheckpointWorker());
+  EXPECT_EQ(store_count, 1);
+  EXPECT_EQ(pause_count, 2);
+  EXPECT_FALSE(is_flushing_paused);
+}
+
+TEST_F(CheckpointServiceTest, LiveSnapshotCheckpointsPendingTransactions) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto mock_application_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      mock_application_journal_service;
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client_);
+  auto mock_transaction_manager = make_shared<MockTransactionManager>(
+      mock_async_executor, mock_transaction_engine, 1000, mock_metric_client_);
+  mock_transaction_manager->SetStarted(true);
+
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider = nullptr;
+  auto mock_budget_key_provider = make_shared<MockBudgetKeyProvider>(
+      async_executor, mock_journal_service, nosql_database_provider,
+      mock_metric_client_, mock_config_provider_);
+
+  // A budget key being loaded is not in the journals yet.
+  auto budget_key_name = make_shared<BudgetKeyName>("Budget_Key_Name");
+  auto budget_key_provider_pair = make_shared<BudgetKeyProviderPair>();
+  budget_key_provider_pair->budget_key = make_shared<MockBudgetKey>(
+      budget_key_name, Uuid::GenerateUuid(), async_executor,
+      mock_journal_service, nosql_database_provider, mock_metric_client_,
+      mock_config_provider_);
+  auto budget_key_pair = make_pair(*budget_key_name, budget_key_provider_pair);
+  mock_budget_key_provider->GetBudgetKeys()->Insert(budget_key_pair,
+                                                    budget_key_provider_pair);
+
+  // The partition serves a transaction.
+  auto transaction_id = Uuid::GenerateUuid();
+  auto transaction = make_shared<Transaction>();
+  transaction->current_phase = TransactionPhase::Commit;
+  transaction->context.request = make_shared<TransactionRequest>();
+  transaction->context.request->timeout_time = 123456;
+  auto pair = make_pair(transaction_id, transaction);
+  mock_transaction_engine->GetActiveTransactionsMap().Insert(pair, transaction);
+
+  mock_application_journal_service->pause_flushing_mock =
+      [](size_t, JournalId& journal_id) {
+        journal_id = 1234;
+        return SuccessExecutionResult();
+      };
+  mock_checkpoint_service_->SetApplicationJournalService(
+      mock_application_journal_service);
+  mock_checkpoint_service_->EnableLiveSnapshot(
+      static_pointer_cast<BudgetKeyProviderInterface>(mock_budget_key_provider),
+      static_pointer_cast<TransactionManagerInterface>(
+          mock_transaction_manager));
+  mock_checkpoint_service_->bootstrap_mock = []() {
+    return FailureExecutionResult(123);
+  };
+  size_t store_count = 0;
+  mock_checkpoint_service_->store_mock =
+      [&](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
+          vector<BytesBuffer>& checkpoint_buffers) {
+        store_count++;
+        EXPECT_EQ(checkpoint_buffers.size(), 1);
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_SUCCESS(mock_checkpoint_service_->RunCheckpointWorker());
+  EXPECT_EQ(store_count, 1);
+}
+
+TEST_F(CheckpointServiceTest, LiveSnapshotFallsBackIfFlushingIsNotPaused) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  auto async_executor =
+      static_pointer_cast<AsyncExecutorInterface>(mock_async_executor);
+  auto mock_application_journal_service = make_shared<MockJournalService>();
+  shared_ptr<JournalServiceInterface> mock_journal_service =
+      mock_application_journal_service;
+  shared_ptr<TransactionCommandSerializerInterface>
+      mock_transaction_command_serializer =
+          make_shared<MockTransactionCommandSerializer>();
+  shared_ptr<RemoteTransactionManagerInterface> remote_transaction_manager;
+  auto mock_transaction_engine = make_shared<MockTransactionEngine>(
+      async_executor, mock_transaction_command_serializer, mock_journal_service,
+      remote_transaction_manager, mock_metric_client_);
+  auto mock_transaction_manager = make_shared<MockTransactionManager>(
+      mock_async_executor, mock_transaction_engine, 1000, mock_metric_client_);
+  mock_transaction_manager->SetStarted(true);
+
+  shared_ptr<NoSQLDatabaseProviderInterface> nosql_database_provider = nullptr;
+  auto mock_budget_key_provider = make_shared<MockBudgetKeyProvider>(
+      async_executor, mock_journal_service, nosql_database_provider,
+      mock_metric_client_, mock_config_provider_);
+
+  // The flushed logs are not persisted in time.
+  mock_application_journal_service->pause_flushing_mock = [](size_t,
+                                                             JournalId&) {
+    return FailureExecutionResult(456);
+  };
+  mock_application_journal_service->resume_flushing_mock = []() {
+    ADD_FAILURE() << "The flushing is not paused.";
+    return SuccessExecutionResult();
+  };
+  mock_checkpoint_service_->SetApplicationJournalService(
+      mock_application_journal_service);
+  mock_checkpoint_service_->EnableLiveSnapshot(
+      static_pointer_cast<BudgetKeyProviderInterface>(mock_budget_key_provider),
+      static_pointer_cast<TransactionManagerInterface>(
+          mock_transaction_manager));
+
+  // Falling back recovers the journals.
+  size_t bootstrap_count = 0;
+  mock_checkpoint_service_->bootstrap_mock = [&]() {
+    bootstrap_count++;
+    return FailureExecutionResult(123);
+  };
+  mock_checkpoint_service_->store_mock =
+      [](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
+        ADD_FAILURE() << "The snapshot must be discarded.";
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_THAT(mock_checkpoint_service_->RunCheckpointWorker(),
+              ResultIs(FailureExecutionResult(123)));
+  EXPECT_EQ(bootstrap_count, 1);
+}
+
+TEST_F(CheckpointServiceTest, CheckpointRoundIsDueOnJournalVolume) {
+  auto mock_journal_service = make_shared<MockJournalService>();
+  std::atomic<size_t> appended_log_count(10);
+  std::atomic<size_t> appended_log_bytes(1000);
+  mock_journal_service->get_log_counts_mock =
+      [&](size_t& log_count, size_t& acknowledged_log_count) {
+        log_count = appended_log_count;
+        acknowledged_log_count = appended_log_count;
+        return SuccessExecutionResult();
+      };
+  mock_journal_service->get_appended_log_bytes_mock = [&](size_t& log_bytes) {
+    log_bytes = appended_log_bytes;
+    return SuccessExecutionResult();
+  };
+  mock_checkpoint_service_->SetApplicationJournalService(mock_journal_service);
+  mock_checkpoint_service_->SetCheckpointRoundTriggers(
+      /*log_count_threshold=*/5, /*log_bytes_threshold=*/500,
+      /*max_interval_in_seconds=*/3600);
+
+  mock_checkpoint_service_->StartCheckpointRound();
+  EXPECT_FALSE(mock_checkpoint_service_->IsCheckpointRoundDue());
+
+  appended_log_count = 14;
+  appended_log_bytes = 1499;
+  EXPECT_FALSE(mock_checkpoint_service_->IsCheckpointRoundDue());
+
+  appended_log_count = 15;
+  EXPECT_TRUE(mock_checkpoint_service_->IsCheckpointRoundDue());
+
+  // The volume is counted from the start of the last round.
+  mock_checkpoint_service_->StartCheckpointRound();
+  EXPECT_FALSE(mock_checkpoint_service_->IsCheckpointRoundDue());
+
+  appended_log_bytes = 1999;
+  EXPECT_TRUE(mock_checkpoint_service_->IsCheckpointRoundDue());
+}
+
+TEST_F(CheckpointServiceTest, CheckpointRoundIsDueAfterTheMaxInterval) {
+  mock_checkpoint_service_->SetCheckpointRoundTriggers(
+      /*log_count_threshold=*/5, /*log_bytes_threshold=*/0,
+      /*max_interval_in_seconds=*/0);
+
+  // An idle partition is still checkpointed every max interval.
+  mock_checkpoint_service_->StartCheckpointRound();
+  EXPECT_TRUE(mock_checkpoint_service_->IsCheckpointRoundDue());
+}
+
 TEST_F(CheckpointServiceTest, WriteBlob) {
   auto mock_blob_storage_client = make_shared<MockBlobStorageClient>();
   auto blob_storage_client =
@@ -566,7 +1023,8 @@ TEST_F(CheckpointServiceTest, StoreBlob) {
     auto blob_name = make_shared<string>("blob_name");
     auto bytes_buffer = make_shared<BytesBuffer>(1);
     BytesBuffer last_checkpoint_buffer(1);
-    BytesBuffer checkpoint_buffer(2);
+    vector<BytesBuffer> checkpoint_buffers;
+    checkpoint_buffers.emplace_back(2);
 
     size_t call_count = 0;
     mock_checkpoint_service_->write_blob_mock =
@@ -588,8 +1046,56 @@ TEST_F(CheckpointServiceTest, StoreBlob) {
 
     CheckpointId checkpoint_id = 123456;
     EXPECT_EQ(mock_checkpoint_service_->Store(
-                  checkpoint_id, last_checkpoint_buffer, checkpoint_buffer),
+                  checkpoint_id, last_checkpoint_buffer, checkpoint_buffers),
+              result);
+  }
+}
+
+TEST_F(CheckpointServiceTest, StoreShardedBlobs) {
+  shared_ptr<BlobStorageProviderInterface> blob_storage_provider =
+      make_shared<MockBlobStorageProvider>();
+  mock_checkpoint_service_->SetBlobStorageProvider(blob_storage_provider);
+  mock_checkpoint_service_->SetIOAsyncExecutor(
+      make_shared<MockAsyncExecutor>());
+
+  vector<ExecutionResult> results = {SuccessExecutionResult(),
+                                     FailureExecutionResult(123)};
+
+  for (const auto& result : results) {
+    BytesBuffer last_checkpoint_buffer(1);
+    vector<BytesBuffer> checkpoint_buffers;
+    checkpoint_buffers.emplace_back(2);
+    checkpoint_buffers.emplace_back(3);
+    checkpoint_buffers.emplace_back(4);
+
+    vector<string> written_blob_names;
+    mock_checkpoint_service_->write_blob_mock =
+        [&](shared_ptr<BlobStorageClientInterface>& blob_storage_client,
+            shared_ptr<string>& blob_name,
+            shared_ptr<BytesBuffer>& bytes_buffer) {
+          written_blob_names.push_back(*blob_name);
+          if (*blob_name ==
+              "partition_name/checkpoint_00000000000000123456_1") {
+            EXPECT_EQ(bytes_buffer->capacity, 3);
+            return result;
+          }
+          return SuccessExecutionResult();
+        };
+
+    CheckpointId checkpoint_id = 123456;
+    EXPECT_EQ(mock_checkpoint_service_->Store(
+                  checkpoint_id, last_checkpoint_buffer, checkpoint_buffers),
               result);
+
+    vector<string> expected_blob_names = {
+        "partition_name/checkpoint_00000000000000123456",
+        "partition_name/checkpoint_00000000000000123456_1",
+        "partition_name/checkpoint_00000000000000123456_2"};
+    // The last checkpoint is only written once all the shards are.
+    if (result.Successful()) {
+      expected_blob_names.push_back("partition_name/last_checkpoint");
+    }
+    EXPECT_EQ(written_blob_names, expected_blob_names);
   }
 }
 
@@ -605,14 +1111,17 @@ TEST_F(CheckpointServiceTest, GetLastPersistedCheckpointId) {
 
   mock_checkpoint_service_->checkpoint_mock =
       [](JournalId last_processed_journal_id, CheckpointId& checkpoint_id,
-         BytesBuffer& last_checkpoint_buffer, BytesBuffer& checkpoint_buffer) {
+         BytesBuffer& last_checkpoint_buffer,
+         vector<BytesBuffer>& checkpoint_buffers) {
         checkpoint_id = 123;
         return SuccessExecutionResult();
       };
 
   mock_checkpoint_service_->store_mock =
       [](CheckpointId& checkpoint_id, BytesBuffer& last_checkpoint_buffer,
-         BytesBuffer& checkpoint_buffer) { return SuccessExecutionResult(); };
+         vector<BytesBuffer>& checkpoint_buffers) {
+        return SuccessExecutionResult();
+      };
 
   mock_checkpoint_service_->shutdown_mock = []() {
     return SuccessExecutionResult();
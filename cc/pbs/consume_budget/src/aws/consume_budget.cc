@@ -0,0 +1,424 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/consume_budget/src/aws/consume_budget.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <aws/core/client/ClientConfiguration.h>
+#include <aws/dynamodb/DynamoDBErrors.h>
+#include <aws/dynamodb/model/AttributeValue.h>
+#include <aws/dynamodb/model/Get.h>
+#include <aws/dynamodb/model/TransactGetItem.h>
+#include <aws/dynamodb/model/TransactGetItemsRequest.h>
+#include <aws/dynamodb/model/TransactWriteItem.h>
+#include <aws/dynamodb/model/TransactWriteItemsRequest.h>
+#include <aws/dynamodb/model/Update.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "cc/core/interface/configuration_keys.h"
+#include "cc/pbs/budget_key_timeframe_manager/src/budget_key_timeframe_serialization.h"
+#include "cc/pbs/budget_key_timeframe_manager/src/budget_key_timeframe_utils.h"
+#include "cc/pbs/consume_budget/src/gcp/error_codes.h"
+#include "cc/pbs/interface/configuration_keys.h"
+#include "cc/pbs/interface/metrics_def.h"
+#include "cc/pbs/interface/type_def.h"
+#include "cc/public/core/interface/errors.h"
+
+namespace google::scp::pbs {
+namespace {
+
+using ::Aws::Client::ClientConfiguration;
+using ::Aws::DynamoDB::DynamoDBClient;
+using ::Aws::DynamoDB::DynamoDBErrors;
+using ::Aws::DynamoDB::Model::AttributeValue;
+using ::Aws::DynamoDB::Model::Get;
+using ::Aws::DynamoDB::Model::TransactGetItem;
+using ::Aws::DynamoDB::Model::TransactGetItemsRequest;
+using ::Aws::DynamoDB::Model::TransactWriteItem;
+using ::Aws::DynamoDB::Model::TransactWriteItemsRequest;
+using ::Aws::DynamoDB::Model::Update;
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::AsyncExecutorInterface;
+using ::google::scp::core::ConfigProviderInterface;
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::ExecutionResultOr;
+using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::kCloudServiceRegion;
+using ::google::scp::core::MetricRouter;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::pbs::budget_key_timeframe_manager::Serialization;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_EXHAUSTED;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_FAIL_TO_COMMIT;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_INITIALIZATION_ERROR;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_PARSING_ERROR;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_TOO_MANY_ROWS;
+
+constexpr absl::string_view kComponentName = "AwsBudgetConsumptionHelper";
+// The attributes of the budget key table, as written by the
+// BudgetKeyTimeframeManager.
+constexpr char kBudgetKeyAttributeName[] = "Budget_Key";
+constexpr char kTimeframeAttributeName[] = "Timeframe";
+constexpr char kTokenCountAttributeName[] = "TokenCount";
+constexpr char kTokenCountAttributeNamePlaceholder[] = "#token_count";
+constexpr char kTokenCountValuePlaceholder[] = ":token_count";
+constexpr char kNewTokenCountValuePlaceholder[] = ":new_token_count";
+// The max number of items of a DynamoDB transaction.
+constexpr size_t kMaxTransactionItemCount = 100;
+constexpr size_t kDefaultMaxTransactionAttempts = 5;
+constexpr size_t kMaxConcurrentConnections = 1000;
+constexpr ::google::scp::core::AsyncTaskTag kConsumeBudgetsTaskTag = {
+    "AwsBudgetConsumptionHelper", "ConsumeBudgets"};
+constexpr ::google::scp::core::AsyncTaskTag kFinishConsumeBudgetsTaskTag = {
+    "AwsBudgetConsumptionHelper", "FinishConsumeBudgets"};
+
+using Row = std::pair<std::string, std::string>;
+
+Row GetRow(const ConsumeBudgetMetadata& metadata) {
+  // GetTimeGroup returns the number of days since epoch
+  return std::make_pair(
+      *metadata.budget_key_name,
+      absl::StrCat(budget_key_timeframe_manager::Utils::GetTimeGroup(
+          metadata.time_bucket)));
+}
+
+// The token counts of a row, as read by the transaction.
+struct RowTokenCounts {
+  // The serialized TokenCount attribute. Empty if the row does not exist.
+  std::string serialized_token_counts;
+  std::vector<TokenCount> token_counts;
+};
+
+// Whether the write transaction failed because of a concurrent write to its
+// rows, in which case the request is attempted again.
+bool IsTransactionConflict(DynamoDBErrors error_type) {
+  return error_type == DynamoDBErrors::TRANSACTION_CANCELED ||
+         error_type == DynamoDBErrors::TRANSACTION_CONFLICT ||
+         error_type == DynamoDBErrors::CONDITIONAL_CHECK_FAILED;
+}
+}  // namespace
+
+AwsBudgetConsumptionHelper::AwsBudgetConsumptionHelper(
+    ConfigProviderInterface* config_provider,
+    AsyncExecutorInterface* async_executor,
+    AsyncExecutorInterface* io_async_executor,
+    std::shared_ptr<DynamoDBClient> dynamo_db_client,
+    std::shared_ptr<MetricRouter> metric_router)
+    : config_provider_(config_provider),
+      async_executor_(async_executor),
+      io_async_executor_(io_async_executor),
+      dynamo_db_client_(std::move(dynamo_db_client)),
+      metric_router_(std::move(metric_router)) {}
+
+ExecutionResultOr<std::shared_ptr<DynamoDBClient>>
+AwsBudgetConsumptionHelper::MakeDynamoDBClientForProd(
+    ConfigProviderInterface& config_provider) {
+  std::string region;
+  if (auto execution_result = config_provider.Get(kCloudServiceRegion, region);
+      !execution_result.Successful()) {
+    return execution_result;
+  }
+
+  ClientConfiguration client_config;
+  client_config.region = region.c_str();
+  // The client is only called synchronously, from the IO threads of the
+  // helper, so it needs no executor of its own.
+  client_config.maxConnections = kMaxConcurrentConnections;
+  return std::make_shared<DynamoDBClient>(client_config);
+}
+
+ExecutionResult AwsBudgetConsumptionHelper::Init() noexcept {
+  if (!dynamo_db_client_) {
+    return FailureExecutionResult(SC_CONSUME_BUDGET_INITIALIZATION_ERROR);
+  }
+  if (auto execution_result =
+          config_provider_->Get(kBudgetKeyTableName, table_name_);
+      !execution_result.Successful()) {
+    return execution_result;
+  }
+
+  if (!config_provider_
+           ->Get(kBudgetConsumptionHelperMaxTransactionAttempts,
+                 max_transaction_attempts_)
+           .Successful() ||
+      max_transaction_attempts_ == 0) {
+    max_transaction_attempts_ = kDefaultMaxTransactionAttempts;
+  }
+
+  if (metric_router_) {
+    meter_ = metric_router_->GetOrCreateMeter(kComponentName);
+    transaction_abort_instrument_ =
+        std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
+            metric_router_->GetOrCreateSyncInstrument(
+                kMetricNameConsumeBudgetTransactionAborts,
+                [&]() -> std::shared_ptr<
+                          opentelemetry::metrics::SynchronousInstrument> {
+                  return meter_->CreateUInt64Counter(
+                      kMetricNameConsumeBudgetTransactionAborts,
+                      "Number of aborted budget consumption transactions");
+                }));
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult AwsBudgetConsumptionHelper::Run() noexcept {
+  return SuccessExecutionResult();
+}
+
+ExecutionResult AwsBudgetConsumptionHelper::Stop() noexcept {
+  return SuccessExecutionResult();
+}
+
+ExecutionResult AwsBudgetConsumptionHelper::ConsumeBudgets(
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>
+        consume_budgets_context) {
+  return io_async_executor_->Schedule(
+      [this, consume_budgets_context]() mutable {
+        ConsumeBudgetsSync(consume_budgets_context);
+        if (!async_executor_->Schedule(
+                [consume_budgets_context]() mutable {
+                  consume_budgets_context.Finish();
+                },
+                google::scp::core::AsyncPriority::Normal,
+                kFinishConsumeBudgetsTaskTag)) {
+          consume_budgets_context.Finish();
+        }
+      },
+      google::scp::core::AsyncPriority::Normal, kConsumeBudgetsTaskTag);
+}
+
+void AwsBudgetConsumptionHelper::ConsumeBudgetsSync(
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>&
+        consume_budgets_context) {
+  const auto& budgets = consume_budgets_context.request->budgets;
+  // The budgets of the different hours of a day share their row, which is
+  // only read and written once.
+  std::vector<Row> rows;
+  absl::flat_hash_map<Row, size_t> row_indices;
+  for (const auto& metadata : budgets) {
+    auto row = GetRow(metadata);
+    if (row_indices.emplace(row, rows.size()).second) {
+      rows.push_back(std::move(row));
+    }
+  }
+  if (rows.size() > kMaxTransactionItemCount) {
+    consume_budgets_context.result =
+        FailureExecutionResult(SC_CONSUME_BUDGET_TOO_MANY_ROWS);
+    SCP_ERROR_CONTEXT(kComponentName, consume_budgets_context,
+                      consume_budgets_context.result,
+                      absl::StrFormat("ConsumeBudgets has %d rows, more than "
+                                      "the %d of a DynamoDB transaction",
+                                      rows.size(), kMaxTransactionItemCount));
+    return;
+  }
+
+  auto commit_start_time = std::chrono::steady_clock::now();
+  size_t abort_count = 0;
+  auto finish = [&](ExecutionResult result) {
+    consume_budgets_context.response->commit_duration =
+        std::chrono::steady_clock::now() - commit_start_time;
+    consume_budgets_context.result = result;
+    if (abort_count > 0) {
+      RecordAborts(*consume_budgets_context.request, abort_count);
+    }
+  };
+
+  TransactGetItemsRequest get_request;
+  for (const auto& [budget_key, timeframe] : rows) {
+    Get get;
+    get.SetTableName(table_name_.c_str());
+    get.AddKey(kBudgetKeyAttributeName,
+               AttributeValue().SetS(budget_key.c_str()));
+    get.AddKey(kTimeframeAttributeName,
+               AttributeValue().SetS(timeframe.c_str()));
+    get_request.AddTransactItems(TransactGetItem().WithGet(std::move(get)));
+  }
+
+  for (size_t attempt = 1; attempt <= max_transaction_attempts_; ++attempt) {
+    auto get_outcome = dynamo_db_client_->TransactGetItems(get_request);
+    if (!get_outcome.IsSuccess()) {
+      SCP_ERROR_CONTEXT(
+          kComponentName, consume_budgets_context,
+          FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT),
+          absl::StrFormat("Reading the budgets failed. Error: %s",
+                          get_outcome.GetError().GetMessage().c_str()));
+      finish(FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT));
+      return;
+    }
+    const auto& responses = get_outcome.GetResult().GetResponses();
+    if (responses.size() != rows.size()) {
+      finish(FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT));
+      return;
+    }
+
+    std::vector<RowTokenCounts> row_token_counts(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      const auto& item = responses[i].GetItem();
+      auto token_count_attribute = item.find(kTokenCountAttributeName);
+      if (item.empty()) {
+        // The row is seen for the first time, with all its budget left.
+        row_token_counts[i].token_counts = std::vector<TokenCount>(
+            budget_key_timeframe_manager::kHoursPerDay, kMaxToken);
+        continue;
+      }
+      if (token_count_attribute == item.end() ||
+          token_count_attribute->second.GetS().empty()) {
+        finish(FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR));
+        return;
+      }
+      row_token_counts[i].serialized_token_counts =
+          token_count_attribute->second.GetS().c_str();
+      if (auto execution_result =
+              Serialization::DeserializeHourTokensInTimeGroup(
+                  row_token_counts[i].serialized_token_counts,
+                  row_token_counts[i].token_counts);
+          !execution_result.Successful()) {
+        finish(FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR));
+        return;
+      }
+    }
+
+    // The budgets are checked against the token counts read, then consumed
+    // one after the other, the budgets of a row adding up.
+    std::vector<size_t> budget_exhausted_indices;
+    for (size_t i = 0; i < budgets.size(); ++i) {
+      auto hour = budget_key_timeframe_manager::Utils::GetTimeBucket(
+          budgets[i].time_bucket);
+      if (row_token_counts[row_indices.at(GetRow(budgets[i]))]
+              .token_counts[hour] < budgets[i].token_count) {
+        budget_exhausted_indices.push_back(i);
+      }
+    }
+    if (!budget_exhausted_indices.empty()) {
+      consume_budgets_context.response->budget_exhausted_indices =
+          std::move(budget_exhausted_indices);
+      SCP_WARNING_CONTEXT(kComponentName, consume_budgets_context,
+                          "ConsumeBudgets failed. Not enough budget.");
+      finish(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED));
+      return;
+    }
+    std::vector<std::vector<TokenCount>> new_token_counts;
+    for (const auto& row : row_token_counts) {
+      new_token_counts.push_back(row.token_counts);
+    }
+    for (const auto& metadata : budgets) {
+      auto hour = budget_key_timeframe_manager::Utils::GetTimeBucket(
+          metadata.time_bucket);
+      auto& token_count =
+          new_token_counts[row_indices.at(GetRow(metadata))][hour];
+      if (token_count < metadata.token_count) {
+        SCP_WARNING_CONTEXT(kComponentName, consume_budgets_context,
+                            "ConsumeBudgets failed. Not enough budget.");
+        finish(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED));
+        return;
+      }
+      token_count -= metadata.token_count;
+    }
+
+    // Each row is written only if it still holds the token counts read.
+    TransactWriteItemsRequest write_request;
+    for (size_t i = 0; i < rows.size(); ++i) {
+      std::string serialized_token_counts;
+      if (auto execution_result = Serialization::SerializeHourTokensInTimeGroup(
+              new_token_counts[i], serialized_token_counts);
+          !execution_result.Successful()) {
+        finish(FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR));
+        return;
+      }
+      Update update;
+      update.SetTableName(table_name_.c_str());
+      update.AddKey(kBudgetKeyAttributeName,
+                    AttributeValue().SetS(rows[i].first.c_str()));
+      update.AddKey(kTimeframeAttributeName,
+                    AttributeValue().SetS(rows[i].second.c_str()));
+      update.SetUpdateExpression(
+          absl::StrCat("SET ", kTokenCountAttributeNamePlaceholder, " = ",
+                       kNewTokenCountValuePlaceholder)
+              .c_str());
+      update.AddExpressionAttributeNames(kTokenCountAttributeNamePlaceholder,
+                                         kTokenCountAttributeName);
+      update.AddExpressionAttributeValues(
+          kNewTokenCountValuePlaceholder,
+          AttributeValue().SetS(serialized_token_counts.c_str()));
+      if (row_token_counts[i].serialized_token_counts.empty()) {
+        update.SetConditionExpression(
+            absl::StrCat("attribute_not_exists(",
+                         kTokenCountAttributeNamePlaceholder, ")")
+                .c_str());
+      } else {
+        update.SetConditionExpression(
+            absl::StrCat(kTokenCountAttributeNamePlaceholder, " = ",
+                         kTokenCountValuePlaceholder)
+                .c_str());
+        update.AddExpressionAttributeValues(
+            kTokenCountValuePlaceholder,
+            AttributeValue().SetS(
+                row_token_counts[i].serialized_token_counts.c_str()));
+      }
+      write_request.AddTransactItems(
+          TransactWriteItem().WithUpdate(std::move(update)));
+    }
+
+    auto write_outcome = dynamo_db_client_->TransactWriteItems(write_request);
+    if (write_outcome.IsSuccess()) {
+      finish(SuccessExecutionResult());
+      return;
+    }
+    if (!IsTransactionConflict(write_outcome.GetError().GetErrorType())) {
+      SCP_ERROR_CONTEXT(
+          kComponentName, consume_budgets_context,
+          FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT),
+          absl::StrFormat("Writing the budgets failed. Error: %s",
+                          write_outcome.GetError().GetMessage().c_str()));
+      finish(FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT));
+      return;
+    }
+    ++abort_count;
+  }
+
+  SCP_ERROR_CONTEXT(kComponentName, consume_budgets_context,
+                    FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT),
+                    absl::StrFormat("ConsumeBudgets conflicted with concurrent "
+                                    "writes %d times",
+                                    max_transaction_attempts_));
+  finish(FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT));
+}
+
+void AwsBudgetConsumptionHelper::RecordAborts(
+    const ConsumeBudgetsRequest& request, size_t abort_count) {
+  if (!transaction_abort_instrument_) {
+    return;
+  }
+
+  absl::flat_hash_set<std::string> budget_key_prefixes;
+  for (const auto& metadata : request.budgets) {
+    absl::string_view budget_key_name = *metadata.budget_key_name;
+    budget_key_prefixes.emplace(
+        budget_key_name.substr(0, budget_key_name.find('/')));
+  }
+  for (const auto& budget_key_prefix : budget_key_prefixes) {
+    transaction_abort_instrument_->Add(
+        abort_count,
+        {{kMetricLabelBudgetKeyPrefix,
+          opentelemetry::nostd::string_view(budget_key_prefix)}});
+  }
+}
+}  // namespace google::scp::pbs
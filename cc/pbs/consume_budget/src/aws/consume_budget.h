@@ -0,0 +1,99 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef CC_PBS_CONSUME_BUDGET_SRC_AWS_CONSUME_BUDGET_H_
+#define CC_PBS_CONSUME_BUDGET_SRC_AWS_CONSUME_BUDGET_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <aws/dynamodb/DynamoDBClient.h>
+
+#include "cc/core/interface/async_context.h"
+#include "cc/core/interface/config_provider_interface.h"
+#include "cc/core/telemetry/src/metric/metric_router.h"
+#include "cc/pbs/interface/consume_budget_interface.h"
+#include "cc/public/core/interface/execution_result.h"
+#include "opentelemetry/metrics/meter.h"
+#include "opentelemetry/metrics/sync_instruments.h"
+
+namespace google::scp::pbs {
+
+// A helper class to consume privacy budgets for a given list of privacy budget
+// keys by writing to AWS DynamoDB.
+//
+// The rows of a request are read with TransactGetItems, and written back with
+// TransactWriteItems, each write being conditioned on the TokenCount attribute
+// it read. A request whose rows changed in between is read and written again.
+// DynamoDB transactions hold at most 100 items, so a request is limited to 100
+// (budget key, timeframe) rows.
+class AwsBudgetConsumptionHelper : public BudgetConsumptionHelperInterface {
+ public:
+  AwsBudgetConsumptionHelper(
+      google::scp::core::ConfigProviderInterface* config_provider,
+      google::scp::core::AsyncExecutorInterface* async_executor,
+      google::scp::core::AsyncExecutorInterface* io_async_executor,
+      std::shared_ptr<Aws::DynamoDB::DynamoDBClient> dynamo_db_client,
+      std::shared_ptr<google::scp::core::MetricRouter> metric_router = nullptr);
+
+  google::scp::core::ExecutionResult Init() noexcept override;
+
+  google::scp::core::ExecutionResult Run() noexcept override;
+
+  google::scp::core::ExecutionResult Stop() noexcept override;
+
+  // Consumes privacy budgets for the given list of privacy budget keys in
+  // consume_budget_context.
+  google::scp::core::ExecutionResult ConsumeBudgets(
+      google::scp::core::AsyncContext<ConsumeBudgetsRequest,
+                                      ConsumeBudgetsResponse>
+          consume_budgets_context) override;
+
+  static google::scp::core::ExecutionResultOr<
+      std::shared_ptr<Aws::DynamoDB::DynamoDBClient>>
+  MakeDynamoDBClientForProd(
+      google::scp::core::ConfigProviderInterface& config_provider);
+
+ private:
+  // Consumes the budgets of the request, setting its result.
+  void ConsumeBudgetsSync(
+      google::scp::core::AsyncContext<ConsumeBudgetsRequest,
+                                      ConsumeBudgetsResponse>&
+          consume_budgets_context);
+
+  // Records the transaction aborts, labeled by the prefix of the budget keys
+  // of the request.
+  void RecordAborts(const ConsumeBudgetsRequest& request, size_t abort_count);
+
+  google::scp::core::ConfigProviderInterface* config_provider_;
+  google::scp::core::AsyncExecutorInterface* async_executor_;
+  google::scp::core::AsyncExecutorInterface* io_async_executor_;
+  std::shared_ptr<Aws::DynamoDB::DynamoDBClient> dynamo_db_client_;
+  std::string table_name_;
+  // How many times a request is attempted when its rows keep changing between
+  // the read and the write.
+  size_t max_transaction_attempts_ = 0;
+
+  // When null, no OTel metric is produced.
+  std::shared_ptr<google::scp::core::MetricRouter> metric_router_;
+  std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+  // Counts the cancelled write transactions.
+  std::shared_ptr<opentelemetry::metrics::Counter<uint64_t>>
+      transaction_abort_instrument_;
+};
+
+}  // namespace google::scp::pbs
+
+#endif  // CC_PBS_CONSUME_BUDGET_SRC_AWS_CONSUME_BUDGET_H_
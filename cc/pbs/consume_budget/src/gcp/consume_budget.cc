@@ -13,7 +13,10 @@
 // limitations under the License.
 #include "cc/pbs/consume_budget/src/gcp/consume_budget.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -22,19 +25,28 @@
 #include <nlohmann/json.hpp>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/optional.h"
+#include "cc/core/common/time_provider/src/time_provider.h"
+#include "cc/core/common/uuid/src/uuid.h"
 #include "cc/core/interface/config_provider_interface.h"
 #include "cc/core/interface/configuration_keys.h"
+#include "cc/cpio/common/src/gcp/spanner_connection_options.h"
 #include "cc/pbs/budget_key_timeframe_manager/src/budget_key_timeframe_serialization.h"
 #include "cc/pbs/budget_key_timeframe_manager/src/budget_key_timeframe_utils.h"
 #include "cc/pbs/consume_budget/src/gcp/error_codes.h"
 #include "cc/pbs/interface/configuration_keys.h"
 #include "cc/pbs/interface/consume_budget_interface.h"
+#include "cc/pbs/interface/metrics_def.h"
 #include "cc/pbs/interface/type_def.h"
 #include "cc/public/core/interface/errors.h"
 #include "cc/public/core/interface/execution_result.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/options.h"
 
 namespace google::scp::pbs {
 namespace {
@@ -46,25 +58,51 @@ using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::ExecutionResultOr;
 using ::google::scp::core::FailureExecutionResult;
 using ::google::scp::core::GetErrorMessage;
+using ::google::scp::core::MetricRouter;
 using ::google::scp::core::kGcpProjectId;
 using ::google::scp::core::kSpannerDatabase;
 using ::google::scp::core::kSpannerEndpointOverride;
+using ::google::scp::core::kSpannerGrpcKeepAliveTimeInMilliseconds;
 using ::google::scp::core::kSpannerInstance;
+using ::google::scp::core::kSpannerNumChannels;
+using ::google::scp::core::kSpannerRouteToLeaderEnabled;
+using ::google::scp::core::kSpannerSessionPoolKeepAliveIntervalInSeconds;
+using ::google::scp::core::kSpannerSessionPoolMaxSessionsPerChannel;
+using ::google::scp::core::kSpannerSessionPoolMinSessions;
+using ::google::scp::core::kSpannerWarmUpEnabled;
 using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::core::common::kZeroUuid;
+using ::google::scp::core::common::TimeProvider;
+using ::google::scp::cpio::common::ApplySpannerConnectionOptions;
+using ::google::scp::cpio::common::SpannerConnectionOptions;
+using ::google::scp::cpio::common::WarmUpSpannerClient;
 using ::google::scp::pbs::budget_key_timeframe_manager::Serialization;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_EXHAUSTED;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_FAIL_TO_COMMIT;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_INITIALIZATION_ERROR;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_PARSING_ERROR;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_TIMEFRAME_EXPIRED;
 namespace spanner = ::google::cloud::spanner;
 
 constexpr absl::string_view kComponentName = "BudgetConsumptionHelper";
 constexpr absl::string_view kBudgetKeySpannerColumnName = "Budget_Key";
 constexpr absl::string_view kTimeframeSpannerColumnName = "Timeframe";
 constexpr absl::string_view kValueSpannerColumnName = "Value";
+constexpr absl::string_view kTokenCountsSpannerColumnName = "Token_Counts";
 constexpr absl::string_view kTokenCountJsonField = "TokenCount";
 constexpr size_t kDefaultTokenCountSize = 24;
 constexpr TokenCount kDefaultPrivacyBudgetCount = 1;
+// Each token count is packed as a little endian 32 bit integer in the
+// Token_Counts column.
+constexpr size_t kPackedTokenCountSize = 4;
+constexpr size_t kDefaultExhaustedRowCacheSize = 100000;
+constexpr absl::string_view kJsonValueFormat = "json";
+constexpr absl::string_view kJsonAndBinaryValueFormat = "json_and_binary";
+constexpr absl::string_view kBinaryValueFormat = "binary";
+constexpr ::google::scp::core::AsyncTaskTag kConsumeQueuedBudgetsTaskTag = {
+    "BudgetConsumptionHelper", "ConsumeQueuedBudgets"};
+constexpr ::google::scp::core::AsyncTaskTag kFinishConsumeBudgetsTaskTag = {
+    "BudgetConsumptionHelper", "FinishConsumeBudgets"};
 
 class PbsPrimaryKey {
  public:
@@ -93,6 +131,13 @@ class PbsPrimaryKey {
   std::string timeframe_;
 };
 
+// The columns holding the token counts of a budget key row. Either may be null
+// while the rows are migrated from one format to the other.
+struct PbsBudgetKeyValue {
+  absl::optional<spanner::Json> json;
+  absl::optional<spanner::Bytes> token_counts;
+};
+
 class PbsBudgetKeyMutation {
  public:
   void ResetTokenCount() {
@@ -101,6 +146,56 @@ class PbsBudgetKeyMutation {
   }
 
   std::tuple<cloud::Status, ExecutionResult> ResetFromSpannerValue(
+      const PbsBudgetKeyValue& value, BudgetKeyValueFormat value_format) {
+    // While PBS instances in the JSON format may still be writing, e.g. during
+    // a rollout or a rollback, they update the Value column only and leave the
+    // Token_Counts column stale. The Value column is then the budget, and the
+    // Token_Counts column only holds the budget of the rows written in the
+    // binary format, whose Value column is null.
+    if (value.token_counts.has_value() &&
+        (value_format == BudgetKeyValueFormat::kBinary ||
+         !value.json.has_value())) {
+      return ResetFromSpannerBytes(*value.token_counts);
+    }
+    if (!value.json.has_value()) {
+      return std::make_tuple(
+          cloud::Status(cloud::StatusCode::kInvalidArgument,
+                        "Both the Value and Token_Counts columns are null "
+                        "while reading from BudgetKey table"),
+          FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR));
+    }
+    return ResetFromSpannerJson(*value.json);
+  }
+
+  std::tuple<cloud::Status, ExecutionResult> ResetFromSpannerBytes(
+      const spanner::Bytes& spanner_bytes) {
+    std::string packed_token_counts = spanner_bytes.get<std::string>();
+    if (packed_token_counts.size() !=
+        kDefaultTokenCountSize * kPackedTokenCountSize) {
+      return std::make_tuple(
+          cloud::Status(
+              cloud::StatusCode::kInvalidArgument,
+              absl::StrCat("Invalid Token_Counts column size while reading "
+                           "from BudgetKey table: ",
+                           packed_token_counts.size())),
+          FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR));
+    }
+
+    token_count_.resize(kDefaultTokenCountSize);
+    for (size_t hour = 0; hour < kDefaultTokenCountSize; ++hour) {
+      uint32_t packed_token_count = 0;
+      for (size_t i = 0; i < kPackedTokenCountSize; ++i) {
+        packed_token_count |=
+            static_cast<uint32_t>(static_cast<uint8_t>(
+                packed_token_counts[hour * kPackedTokenCountSize + i]))
+            << (8 * i);
+      }
+      token_count_[hour] = static_cast<TokenCount>(packed_token_count);
+    }
+    return std::make_tuple(cloud::Status(), SuccessExecutionResult());
+  }
+
+  std::tuple<cloud::Status, ExecutionResult> ResetFromSpannerJson(
       const spanner::Json& spanner_json) {
     nlohmann::json json_value;
     try {
@@ -158,6 +253,21 @@ class PbsBudgetKeyMutation {
                            spanner::Json(json_value.dump()));
   }
 
+  spanner::Bytes ToSpannerBytes() const {
+    std::string packed_token_counts(
+        token_count_.size() * kPackedTokenCountSize, '\0');
+    for (size_t hour = 0; hour < token_count_.size(); ++hour) {
+      auto packed_token_count = static_cast<uint32_t>(token_count_[hour]);
+      for (size_t i = 0; i < kPackedTokenCountSize; ++i) {
+        packed_token_counts[hour * kPackedTokenCountSize + i] =
+            static_cast<char>((packed_token_count >> (8 * i)) & 0xFF);
+      }
+    }
+    return spanner::Bytes(packed_token_counts);
+  }
+
+  const std::vector<TokenCount>& token_count() const { return token_count_; }
+
   int32_t GetTokenCount(size_t hour) const { return token_count_[hour]; }
 
   void SetTokenCount(size_t hour, int32_t count) { token_count_[hour] = count; }
@@ -174,18 +284,45 @@ class PbsBudgetKeyMutation {
   std::vector<TokenCount> token_count_;
 };
 
-cloud::StatusOr<absl::flat_hash_map<PbsPrimaryKey, spanner::Json>>
+std::vector<std::string> GetSpannerColumns(BudgetKeyValueFormat value_format) {
+  std::vector<std::string> columns = {std::string(kBudgetKeySpannerColumnName),
+                                      std::string(kTimeframeSpannerColumnName),
+                                      std::string(kValueSpannerColumnName)};
+  if (value_format != BudgetKeyValueFormat::kJson) {
+    columns.push_back(std::string(kTokenCountsSpannerColumnName));
+  }
+  return columns;
+}
+
+cloud::StatusOr<absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyValue>>
 ReadPrivacyBudgetsForKeys(cloud::spanner::Client client,
                           cloud::spanner::Transaction txn,
                           const std::string& table_name,
-                          const cloud::spanner::KeySet& key_set) {
+                          const cloud::spanner::KeySet& key_set,
+                          BudgetKeyValueFormat value_format,
+                          cloud::Options read_options = {}) {
   spanner::RowStream returned_rows =
       client.Read(std::move(txn), table_name, std::move(key_set),
-                  {std::string(kBudgetKeySpannerColumnName),
-                   std::string(kTimeframeSpannerColumnName),
-                   std::string(kValueSpannerColumnName)});
-  absl::flat_hash_map<PbsPrimaryKey, spanner::Json> results;
-  using RowType = std::tuple<std::string, std::string, spanner::Json>;
+                  GetSpannerColumns(value_format), std::move(read_options));
+  absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyValue> results;
+  if (value_format == BudgetKeyValueFormat::kJson) {
+    using RowType = std::tuple<std::string, std::string, spanner::Json>;
+    for (const auto& row : cloud::spanner::StreamOf<RowType>(returned_rows)) {
+      if (!row) {
+        return row.status();
+      }
+      if (row.status().code() == cloud::StatusCode::kNotFound) {
+        continue;
+      }
+      results.emplace(PbsPrimaryKey{std::get<0>(*row), std::get<1>(*row)},
+                      PbsBudgetKeyValue{std::get<2>(*row), absl::nullopt});
+    }
+    return results;
+  }
+
+  using RowType =
+      std::tuple<std::string, std::string, absl::optional<spanner::Json>,
+                 absl::optional<spanner::Bytes>>;
   for (const auto& row : cloud::spanner::StreamOf<RowType>(returned_rows)) {
     if (!row) {
       return row.status();
@@ -194,36 +331,42 @@ ReadPrivacyBudgetsForKeys(cloud::spanner::Client client,
       continue;
     }
     results.emplace(PbsPrimaryKey{std::get<0>(*row), std::get<1>(*row)},
-                    std::get<2>(*row));
+                    PbsBudgetKeyValue{std::get<2>(*row), std::get<3>(*row)});
   }
   return results;
 }
 
+std::pair<std::string, std::string> GetRow(
+    const ConsumeBudgetMetadata& metadata) {
+  return std::make_pair(
+      *metadata.budget_key_name,
+      absl::StrCat(budget_key_timeframe_manager::Utils::GetTimeGroup(
+          metadata.time_bucket)));
+}
+
+PbsPrimaryKey GetPbsPrimaryKey(const ConsumeBudgetMetadata& metadata) {
+  // GetTimeGroup returns the number of days since epoch
+  return PbsPrimaryKey{
+      *metadata.budget_key_name,
+      absl::StrCat(budget_key_timeframe_manager::Utils::GetTimeGroup(
+          metadata.time_bucket))};
+}
+
+// The budgets of the different hours of a day, within a request or across
+// the requests of a transaction, share their row. Each row is only added to
+// the key set once.
 spanner::KeySet CreateSpannerKeySet(
     const std::vector<ConsumeBudgetMetadata>& budgets_metadata) {
   spanner::KeySet spanner_key_set;
+  absl::flat_hash_set<std::pair<std::string, std::string>> rows;
+  rows.reserve(budgets_metadata.size());
   for (const ConsumeBudgetMetadata& metadata : budgets_metadata) {
-    spanner_key_set.AddKey(spanner::MakeKey(
-        *metadata.budget_key_name,
-        absl::StrCat(budget_key_timeframe_manager::Utils::GetTimeGroup(
-            metadata.time_bucket))));
-  }
-  return spanner_key_set;
-}
-
-std::tuple<cloud::Status, ExecutionResult> CreatePbsMutations(
-    const absl::flat_hash_map<PbsPrimaryKey, spanner::Json>& query_results,
-    absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyMutation>& pbs_mutations) {
-  pbs_mutations.clear();
-  for (const auto& [pbs_primary_key, spanner_json] : query_results) {
-    PbsBudgetKeyMutation& pbs_mutation = pbs_mutations[pbs_primary_key];
-    auto [status, execution_result] =
-        pbs_mutation.ResetFromSpannerValue(spanner_json);
-    if (!status.ok()) {
-      return std::make_tuple(status, execution_result);
+    auto [row, is_inserted] = rows.insert(GetRow(metadata));
+    if (is_inserted) {
+      spanner_key_set.AddKey(spanner::MakeKey(row->first, row->second));
     }
   }
-  return std::make_tuple(cloud::Status(), SuccessExecutionResult());
+  return spanner_key_set;
 }
 
 std::tuple<cloud::Status, ExecutionResult, std::vector<size_t>>
@@ -233,10 +376,7 @@ ValidatePbsMutations(
   std::vector<size_t> budget_exhausted_indices;
   for (int i = 0; i < budgets_metadata.size(); ++i) {
     const ConsumeBudgetMetadata& metadata = budgets_metadata[i];
-    PbsPrimaryKey primary_key{
-        *metadata.budget_key_name,
-        absl::StrCat(budget_key_timeframe_manager::Utils::GetTimeGroup(
-            metadata.time_bucket))};
+    PbsPrimaryKey primary_key = GetPbsPrimaryKey(metadata);
     auto pbs_mutation = pbs_mutations.find(primary_key);
 
     // The privacy budget key is seen for the first time in the database, so the
@@ -269,11 +409,7 @@ std::tuple<cloud::Status, ExecutionResult> UpdatePbsMutationsToConsumeBudgets(
     const std::vector<ConsumeBudgetMetadata>& budgets_metadata,
     absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyMutation>& pbs_mutations) {
   for (const ConsumeBudgetMetadata& metadata : budgets_metadata) {
-    // GetTimeGroup returns the number of days since epoch
-    PbsPrimaryKey primary_key{
-        *metadata.budget_key_name,
-        absl::StrCat(budget_key_timeframe_manager::Utils::GetTimeGroup(
-            metadata.time_bucket))};
+    PbsPrimaryKey primary_key = GetPbsPrimaryKey(metadata);
     auto pbs_mutation = pbs_mutations.find(primary_key);
     if (pbs_mutation == pbs_mutations.end()) {
       PbsBudgetKeyMutation& m = pbs_mutations[primary_key];
@@ -305,31 +441,51 @@ std::tuple<cloud::Status, ExecutionResult> UpdatePbsMutationsToConsumeBudgets(
 std::tuple<cloud::Status, ExecutionResult> CreateSpannerMutations(
     const absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyMutation>&
         pbs_mutations,
-    absl::string_view table_name, spanner::Mutations& mutations) {
+    absl::string_view table_name, BudgetKeyValueFormat value_format,
+    spanner::Mutations& mutations) {
   auto insertion_builder = spanner::InsertMutationBuilder(
-      std::string(table_name), {std::string(kBudgetKeySpannerColumnName),
-                                std::string(kTimeframeSpannerColumnName),
-                                std::string(kValueSpannerColumnName)});
+      std::string(table_name), GetSpannerColumns(value_format));
   bool has_insert = false;
   auto update_builder = spanner::UpdateMutationBuilder(
-      std::string(table_name), {std::string(kBudgetKeySpannerColumnName),
-                                std::string(kTimeframeSpannerColumnName),
-                                std::string(kValueSpannerColumnName)});
+      std::string(table_name), GetSpannerColumns(value_format));
   bool has_update = false;
   for (const auto& [pbs_key, pbs_mutation] : pbs_mutations) {
-    auto [status, execution_result, json] = pbs_mutation.ToSpannerJson();
-    if (!status.ok()) {
-      return std::make_tuple(status, execution_result);
-    }
+    auto emplace_row = [&](auto& builder) -> cloud::Status {
+      if (value_format == BudgetKeyValueFormat::kBinary) {
+        // The Value column is cleared rather than left stale, so that a
+        // rollback to the JSON format fails on the row instead of reading an
+        // old budget.
+        builder.EmplaceRow(pbs_key.budget_key(), pbs_key.timeframe(),
+                           absl::optional<spanner::Json>(),
+                           pbs_mutation.ToSpannerBytes());
+        return cloud::Status();
+      }
+
+      auto [status, execution_result, json] = pbs_mutation.ToSpannerJson();
+      if (!status.ok()) {
+        return status;
+      }
+      if (value_format == BudgetKeyValueFormat::kJsonAndBinary) {
+        builder.EmplaceRow(pbs_key.budget_key(), pbs_key.timeframe(), json,
+                           pbs_mutation.ToSpannerBytes());
+      } else {
+        builder.EmplaceRow(pbs_key.budget_key(), pbs_key.timeframe(), json);
+      }
+      return cloud::Status();
+    };
+
+    cloud::Status status;
     if (pbs_mutation.is_insertion()) {
-      insertion_builder.EmplaceRow(pbs_key.budget_key(), pbs_key.timeframe(),
-                                   json);
+      status = emplace_row(insertion_builder);
       has_insert = true;
     } else {
-      update_builder.EmplaceRow(pbs_key.budget_key(), pbs_key.timeframe(),
-                                json);
+      status = emplace_row(update_builder);
       has_update = true;
     }
+    if (!status.ok()) {
+      return std::make_tuple(
+          status, FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR));
+    }
   }
 
   mutations.clear();
@@ -347,11 +503,13 @@ BudgetConsumptionHelper::BudgetConsumptionHelper(
     ConfigProviderInterface* config_provider,
     AsyncExecutorInterface* async_executor,
     AsyncExecutorInterface* io_async_executor,
-    std::shared_ptr<spanner::Connection> spanner_connection)
+    std::shared_ptr<spanner::Connection> spanner_connection,
+    std::shared_ptr<MetricRouter> metric_router)
     : config_provider_(config_provider),
       async_executor_(async_executor),
       io_async_executor_(io_async_executor),
-      spanner_connection_(std::move(spanner_connection)) {}
+      spanner_connection_(std::move(spanner_connection)),
+      metric_router_(std::move(metric_router)) {}
 
 ExecutionResultOr<std::shared_ptr<cloud::spanner::Connection>>
 BudgetConsumptionHelper::MakeSpannerConnectionForProd(
@@ -383,8 +541,38 @@ BudgetConsumptionHelper::MakeSpannerConnectionForProd(
     options.set<google::cloud::EndpointOption>(endpoint_override);
   }
 
-  return spanner::MakeConnection(spanner::Database(project, instance, database),
-                                 options);
+  // The settings left unset keep the defaults of the client library.
+  SpannerConnectionOptions connection_options;
+  config_provider.Get(kSpannerSessionPoolMinSessions,
+                      connection_options.min_sessions);
+  config_provider.Get(kSpannerSessionPoolMaxSessionsPerChannel,
+                      connection_options.max_sessions_per_channel);
+  config_provider.Get(kSpannerNumChannels, connection_options.num_channels);
+  size_t session_keep_alive_interval_in_seconds = 0;
+  if (config_provider
+          .Get(kSpannerSessionPoolKeepAliveIntervalInSeconds,
+               session_keep_alive_interval_in_seconds)
+          .Successful()) {
+    connection_options.session_keep_alive_interval =
+        std::chrono::seconds(session_keep_alive_interval_in_seconds);
+  }
+  size_t grpc_keep_alive_time_in_milliseconds = 0;
+  if (config_provider
+          .Get(kSpannerGrpcKeepAliveTimeInMilliseconds,
+               grpc_keep_alive_time_in_milliseconds)
+          .Successful()) {
+    connection_options.grpc_keep_alive_time =
+        std::chrono::milliseconds(grpc_keep_alive_time_in_milliseconds);
+  }
+  bool route_to_leader = false;
+  if (config_provider.Get(kSpannerRouteToLeaderEnabled, route_to_leader)
+          .Successful()) {
+    connection_options.route_to_leader = route_to_leader;
+  }
+
+  return spanner::MakeConnection(
+      spanner::Database(project, instance, database),
+      ApplySpannerConnectionOptions(connection_options, std::move(options)));
 }
 
 ExecutionResult BudgetConsumptionHelper::Init() noexcept {
@@ -396,10 +584,136 @@ ExecutionResult BudgetConsumptionHelper::Init() noexcept {
       execution_result != SuccessExecutionResult()) {
     return execution_result;
   }
+
+  if (!config_provider_
+           ->Get(kBudgetConsumptionHelperSerializeRequestsPerRow,
+                 serialize_requests_per_row_)
+           .Successful()) {
+    serialize_requests_per_row_ = false;
+  }
+
+  size_t stale_read_staleness_in_milliseconds = 0;
+  if (config_provider_
+          ->Get(kBudgetConsumptionHelperStaleReadStalenessInMilliseconds,
+                stale_read_staleness_in_milliseconds)
+          .Successful()) {
+    stale_read_staleness_in_nanoseconds_ =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::milliseconds(stale_read_staleness_in_milliseconds))
+            .count();
+  }
+
+  std::string stale_read_directed_read_locations;
+  if (config_provider_
+          ->Get(kBudgetConsumptionHelperStaleReadDirectedReadLocations,
+                stale_read_directed_read_locations)
+          .Successful()) {
+    std::vector<spanner::ReplicaSelection> replica_selections;
+    for (absl::string_view location :
+         absl::StrSplit(stale_read_directed_read_locations, ',',
+                        absl::SkipWhitespace())) {
+      replica_selections.emplace_back(
+          std::string(absl::StripAsciiWhitespace(location)));
+    }
+    if (!replica_selections.empty()) {
+      // The other replicas still serve the reads when none of these can.
+      stale_read_options_.set<spanner::DirectedReadOption>(
+          spanner::IncludeReplicas(std::move(replica_selections),
+                                   /*auto_failover_disabled=*/false));
+    }
+  }
+
+  size_t exhausted_row_cache_ttl_in_seconds = 0;
+  if (config_provider_
+          ->Get(kBudgetConsumptionHelperExhaustedRowCacheTtlInSeconds,
+                exhausted_row_cache_ttl_in_seconds)
+          .Successful()) {
+    exhausted_row_cache_ttl_in_nanoseconds_ =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::seconds(exhausted_row_cache_ttl_in_seconds))
+            .count();
+  }
+
+  if (!config_provider_
+           ->Get(kBudgetConsumptionHelperExhaustedRowCacheSize,
+                 max_exhausted_row_cache_size_)
+           .Successful() ||
+      max_exhausted_row_cache_size_ == 0) {
+    max_exhausted_row_cache_size_ = kDefaultExhaustedRowCacheSize;
+  }
+
+  if (!config_provider_
+           ->Get(kBudgetKeyTimeframeRetentionInDays,
+                 budget_key_timeframe_retention_in_days_)
+           .Successful()) {
+    budget_key_timeframe_retention_in_days_ = 0;
+  }
+
+  if (metric_router_) {
+    meter_ = metric_router_->GetOrCreateMeter(kComponentName);
+    transaction_abort_instrument_ =
+        std::static_pointer_cast<opentelemetry::metrics::Counter<uint64_t>>(
+            metric_router_->GetOrCreateSyncInstrument(
+                kMetricNameConsumeBudgetTransactionAborts,
+                [&]() -> std::shared_ptr<
+                          opentelemetry::metrics::SynchronousInstrument> {
+                  return meter_->CreateUInt64Counter(
+                      kMetricNameConsumeBudgetTransactionAborts,
+                      "Number of aborted budget consumption transactions");
+                }));
+  }
+
+  size_t batching_window_in_milliseconds = 0;
+  if (config_provider_
+          ->Get(kBudgetConsumptionHelperBatchingWindowInMilliseconds,
+                batching_window_in_milliseconds)
+          .Successful()) {
+    batching_window_in_nanoseconds_ =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::milliseconds(batching_window_in_milliseconds))
+            .count();
+  }
+
+  if (!config_provider_
+           ->Get(kBudgetConsumptionHelperMaxRequestsPerTransaction,
+                 max_requests_per_transaction_)
+           .Successful() ||
+      max_requests_per_transaction_ == 0) {
+    max_requests_per_transaction_ = 1;
+  }
+
+  std::string value_format;
+  if (!config_provider_->Get(kBudgetKeyTableValueFormat, value_format)
+           .Successful() ||
+      value_format == kJsonValueFormat) {
+    value_format_ = BudgetKeyValueFormat::kJson;
+  } else if (value_format == kJsonAndBinaryValueFormat) {
+    value_format_ = BudgetKeyValueFormat::kJsonAndBinary;
+  } else if (value_format == kBinaryValueFormat) {
+    value_format_ = BudgetKeyValueFormat::kBinary;
+  } else {
+    return FailureExecutionResult(SC_CONSUME_BUDGET_INITIALIZATION_ERROR);
+  }
   return SuccessExecutionResult();
 }
 
 ExecutionResult BudgetConsumptionHelper::Run() noexcept {
+  bool is_warm_up_enabled = false;
+  if (!config_provider_->Get(kSpannerWarmUpEnabled, is_warm_up_enabled)
+           .Successful() ||
+      !is_warm_up_enabled) {
+    return SuccessExecutionResult();
+  }
+  // The min sessions are created along with the connection, the query makes
+  // sure they and the channels are usable before the first requests. A
+  // failure is not fatal, the requests create what they need.
+  spanner::Client client(spanner_connection_);
+  if (auto execution_result = WarmUpSpannerClient(client);
+      !execution_result.Successful()) {
+    SCP_WARNING(kComponentName, kZeroUuid,
+                "Failed warming up the Spanner connection: %s",
+                GetErrorMessage(execution_result.status_code));
+  }
   return SuccessExecutionResult();
 }
 
@@ -412,12 +726,59 @@ ExecutionResult BudgetConsumptionHelper::ConsumeBudgets(
         consume_budgets_context) {
   // TODO: Check that request is not empty.
   // Return invalid argument
-  if (auto schedule_result = io_async_executor_->Schedule(
-          [this, consume_budgets_context]() {
-            ConsumeBudgetsSyncAndFinishContext(consume_budgets_context);
-          },
-          google::scp::core::AsyncPriority::Normal);
-      !schedule_result.Successful()) {
+  if (budget_key_timeframe_retention_in_days_ > 0) {
+    auto today = budget_key_timeframe_manager::Utils::GetTimeGroup(
+        TimeProvider::GetWallTimestampInNanosecondsAsClockTicks());
+    for (const ConsumeBudgetMetadata& metadata :
+         consume_budgets_context.request->budgets) {
+      if (budget_key_timeframe_manager::Utils::GetTimeGroup(
+              metadata.time_bucket) +
+              budget_key_timeframe_retention_in_days_ <=
+          today) {
+        return FailureExecutionResult(SC_CONSUME_BUDGET_TIMEFRAME_EXPIRED);
+      }
+    }
+  }
+
+  size_t pending_count = 0;
+  {
+    std::lock_guard<std::mutex> lock(pending_consume_budgets_contexts_mutex_);
+    pending_consume_budgets_contexts_.push_back(consume_budgets_context);
+    pending_count = pending_consume_budgets_contexts_.size();
+  }
+
+  // Each scheduled task consumes the budgets of up to
+  // max_requests_per_transaction_ queued requests, so the requests arriving
+  // while all the IO threads wait on Spanner share the next transaction. With
+  // a batching window, only the first request of each batch schedules a task,
+  // delayed by the window for the batch to fill up, and the request filling a
+  // batch schedules one right away. There is thus always at least one task per
+  // batch of queued requests.
+  ExecutionResult schedule_result = SuccessExecutionResult();
+  auto task = [this]() { ConsumeQueuedBudgetsAndFinishContexts(); };
+  if (batching_window_in_nanoseconds_ == 0 ||
+      max_requests_per_transaction_ == 1 ||
+      pending_count % max_requests_per_transaction_ == 0) {
+    schedule_result = io_async_executor_->Schedule(
+        task, google::scp::core::AsyncPriority::Normal,
+        kConsumeQueuedBudgetsTaskTag);
+  } else if (pending_count % max_requests_per_transaction_ == 1) {
+    schedule_result = io_async_executor_->ScheduleFor(
+        task, TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+                  batching_window_in_nanoseconds_);
+  }
+  if (!schedule_result.Successful()) {
+    std::lock_guard<std::mutex> lock(pending_consume_budgets_contexts_mutex_);
+    auto it = std::find_if(
+        pending_consume_budgets_contexts_.begin(),
+        pending_consume_budgets_contexts_.end(), [&](const auto& context) {
+          return context.request == consume_budgets_context.request;
+        });
+    if (it == pending_consume_budgets_contexts_.end()) {
+      // Already taken by the task of another request, which will finish it.
+      return SuccessExecutionResult();
+    }
+    pending_consume_budgets_contexts_.erase(it);
     // Returns the execution result to the caller without calling FinishContext,
     // since the async task is not scheduled successfully
     return schedule_result;
@@ -425,75 +786,284 @@ ExecutionResult BudgetConsumptionHelper::ConsumeBudgets(
   return SuccessExecutionResult();
 }
 
-void BudgetConsumptionHelper::ConsumeBudgetsSyncAndFinishContext(
-    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>
-        consume_budgets_context) {
-  consume_budgets_context.result = ConsumeBudgetsSync(consume_budgets_context);
-  if (!async_executor_->Schedule(
-          [consume_budgets_context]() mutable {
-            consume_budgets_context.Finish();
-          },
-          google::scp::core::AsyncPriority::Normal)) {
-    consume_budgets_context.Finish();
+std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>
+BudgetConsumptionHelper::TakeQueuedRequests() {
+  std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>
+      consume_budgets_contexts;
+  std::lock_guard<std::mutex> lock(pending_consume_budgets_contexts_mutex_);
+  if (!serialize_requests_per_row_) {
+    while (!pending_consume_budgets_contexts_.empty() &&
+           consume_budgets_contexts.size() < max_requests_per_transaction_) {
+      consume_budgets_contexts.push_back(
+          std::move(pending_consume_budgets_contexts_.front()));
+      pending_consume_budgets_contexts_.pop_front();
+    }
+    return consume_budgets_contexts;
   }
+
+  // The rows of the requests left in the queue are blocked as well, so that
+  // the requests on a row reach Spanner in the order they arrived.
+  absl::flat_hash_set<std::pair<std::string, std::string>> taken_rows;
+  absl::flat_hash_set<std::pair<std::string, std::string>> blocked_rows;
+  for (auto it = pending_consume_budgets_contexts_.begin();
+       it != pending_consume_budgets_contexts_.end() &&
+       consume_budgets_contexts.size() < max_requests_per_transaction_;) {
+    std::vector<std::pair<std::string, std::string>> rows;
+    bool is_blocked = false;
+    for (const auto& metadata : it->request->budgets) {
+      rows.push_back(GetRow(metadata));
+      is_blocked = is_blocked || in_flight_rows_.contains(rows.back()) ||
+                   blocked_rows.contains(rows.back());
+    }
+    if (is_blocked) {
+      blocked_rows.insert(rows.begin(), rows.end());
+      ++it;
+      continue;
+    }
+    taken_rows.insert(rows.begin(), rows.end());
+    consume_budgets_contexts.push_back(std::move(*it));
+    it = pending_consume_budgets_contexts_.erase(it);
+  }
+  in_flight_rows_.insert(taken_rows.begin(), taken_rows.end());
+  return consume_budgets_contexts;
 }
 
-ExecutionResult BudgetConsumptionHelper::ConsumeBudgetsSync(
-    const AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>&
-        consume_budgets_context) {
+void BudgetConsumptionHelper::ConsumeQueuedBudgetsAndFinishContexts() {
+  std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>
+      consume_budgets_contexts = TakeQueuedRequests();
+  if (consume_budgets_contexts.empty()) {
+    return;
+  }
+
+  // The requests known to be exhausted are rejected without taking locks.
+  std::vector<bool> is_rejected =
+      RejectExhaustedRequests(consume_budgets_contexts);
+  std::vector<size_t> committed_indices;
+  std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>
+      committed_consume_budgets_contexts;
+  for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+    if (!is_rejected[i]) {
+      committed_indices.push_back(i);
+      committed_consume_budgets_contexts.push_back(consume_budgets_contexts[i]);
+    }
+  }
+  if (!committed_consume_budgets_contexts.empty()) {
+    ConsumeBudgetsSync(committed_consume_budgets_contexts);
+    for (size_t i = 0; i < committed_indices.size(); ++i) {
+      consume_budgets_contexts[committed_indices[i]].result =
+          committed_consume_budgets_contexts[i].result;
+    }
+  }
+
+  if (serialize_requests_per_row_) {
+    bool has_pending_requests = false;
+    {
+      std::lock_guard<std::mutex> lock(pending_consume_budgets_contexts_mutex_);
+      for (const auto& consume_budgets_context : consume_budgets_contexts) {
+        for (const auto& metadata : consume_budgets_context.request->budgets) {
+          in_flight_rows_.erase(GetRow(metadata));
+        }
+      }
+      has_pending_requests = !pending_consume_budgets_contexts_.empty();
+    }
+    // The requests left queued for the rows just released may have no task
+    // left to take them.
+    if (has_pending_requests) {
+      if (auto schedule_result = io_async_executor_->Schedule(
+              [this]() { ConsumeQueuedBudgetsAndFinishContexts(); },
+              google::scp::core::AsyncPriority::Normal,
+              kConsumeQueuedBudgetsTaskTag);
+          !schedule_result.Successful()) {
+        SCP_ERROR(kComponentName, kZeroUuid,
+                  schedule_result,
+                  "Cannot schedule the consumption of the queued budgets.");
+      }
+    }
+  }
+  for (auto& consume_budgets_context : consume_budgets_contexts) {
+    if (!async_executor_->Schedule(
+            [consume_budgets_context]() mutable {
+              consume_budgets_context.Finish();
+            },
+            google::scp::core::AsyncPriority::Normal,
+            kFinishConsumeBudgetsTaskTag)) {
+      consume_budgets_context.Finish();
+    }
+  }
+}
+
+void BudgetConsumptionHelper::ConsumeBudgetsSync(
+    std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>&
+        consume_budgets_contexts) {
   spanner::Client client(spanner_connection_);
-  ExecutionResult captured_execution_result = SuccessExecutionResult();
-  std::vector<size_t> captured_budget_exhausted_indices;
+  // The results of each request, captured by the last run of the transaction.
+  std::vector<cloud::Status> captured_statuses;
+  std::vector<ExecutionResult> captured_execution_results;
+  std::vector<std::vector<size_t>> captured_budget_exhausted_indices;
+  // The token counts left in the rows of the exhausted requests, and whether
+  // the transaction was rolled back without writing anything, in which case
+  // they are the ones read.
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      std::vector<TokenCount>>
+      captured_exhausted_rows;
+  bool captured_is_read_only = false;
+  // The client runs the transaction again each time it is aborted.
+  size_t attempt_count = 0;
+  auto commit_start_time = std::chrono::steady_clock::now();
   auto commit_result = client.Commit(
       [&](spanner::Transaction txn) -> cloud::StatusOr<spanner::Mutations> {
-        spanner::KeySet spanner_key_set =
-            CreateSpannerKeySet(consume_budgets_context.request->budgets);
-        cloud::StatusOr<absl::flat_hash_map<PbsPrimaryKey, spanner::Json>>
-            results = ReadPrivacyBudgetsForKeys(client, txn, table_name_,
-                                                spanner_key_set);
+        attempt_count++;
+        captured_exhausted_rows.clear();
+        captured_is_read_only = false;
+        captured_statuses.assign(consume_budgets_contexts.size(),
+                                 cloud::Status());
+        captured_execution_results.assign(consume_budgets_contexts.size(),
+                                          SuccessExecutionResult());
+        captured_budget_exhausted_indices.assign(
+            consume_budgets_contexts.size(), std::vector<size_t>());
+
+        std::vector<ConsumeBudgetMetadata> all_budgets;
+        for (const auto& consume_budgets_context : consume_budgets_contexts) {
+          all_budgets.insert(all_budgets.end(),
+                             consume_budgets_context.request->budgets.begin(),
+                             consume_budgets_context.request->budgets.end());
+        }
+        spanner::KeySet spanner_key_set = CreateSpannerKeySet(all_budgets);
+        cloud::StatusOr<absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyValue>>
+            results = ReadPrivacyBudgetsForKeys(
+                client, txn, table_name_, spanner_key_set, value_format_);
         if (!results.ok()) {
           return results.status();
         }
 
+        // The rows are parsed one by one so that an unparsable row only fails
+        // the requests consuming its budgets.
         absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyMutation> pbs_mutations;
-        if (auto [status, execution_result] =
-                CreatePbsMutations(*results, pbs_mutations);
-            !status.ok()) {
-          captured_execution_result = execution_result;
-          return status;
+        absl::flat_hash_map<PbsPrimaryKey, std::tuple<cloud::Status,
+                                                      ExecutionResult>>
+            unparsable_rows;
+        for (const auto& [pbs_primary_key, spanner_value] : *results) {
+          PbsBudgetKeyMutation pbs_mutation;
+          auto [status, execution_result] =
+              pbs_mutation.ResetFromSpannerValue(spanner_value, value_format_);
+          if (!status.ok()) {
+            unparsable_rows.emplace(pbs_primary_key,
+                                    std::make_tuple(status, execution_result));
+            continue;
+          }
+          pbs_mutations.emplace(pbs_primary_key, std::move(pbs_mutation));
         }
 
-        if (auto [status, execution_result, budget_exhausted_indices] =
-                ValidatePbsMutations(consume_budgets_context.request->budgets,
-                                     pbs_mutations);
-            !status.ok()) {
-          captured_execution_result = execution_result;
-          captured_budget_exhausted_indices = budget_exhausted_indices;
-          return status;
+        // The requests are applied one after the other, each seeing the
+        // budgets left by the previous ones.
+        absl::flat_hash_set<PbsPrimaryKey> consumed_keys;
+        cloud::Status last_failure_status;
+        bool has_consumed_budgets = false;
+        for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+          const auto& budgets = consume_budgets_contexts[i].request->budgets;
+          bool is_unparsable = false;
+          for (const auto& metadata : budgets) {
+            auto unparsable_row =
+                unparsable_rows.find(GetPbsPrimaryKey(metadata));
+            if (unparsable_row != unparsable_rows.end()) {
+              captured_statuses[i] = last_failure_status =
+                  std::get<0>(unparsable_row->second);
+              captured_execution_results[i] =
+                  std::get<1>(unparsable_row->second);
+              is_unparsable = true;
+              break;
+            }
+          }
+          if (is_unparsable) {
+            continue;
+          }
+
+          if (auto [status, execution_result, budget_exhausted_indices] =
+                  ValidatePbsMutations(budgets, pbs_mutations);
+              !status.ok()) {
+            captured_statuses[i] = last_failure_status = status;
+            captured_execution_results[i] = execution_result;
+            captured_budget_exhausted_indices[i] = budget_exhausted_indices;
+            continue;
+          }
+
+          auto request_mutations = pbs_mutations;
+          if (auto [status, execution_result] =
+                  UpdatePbsMutationsToConsumeBudgets(budgets,
+                                                     request_mutations);
+              !status.ok()) {
+            captured_statuses[i] = last_failure_status = status;
+            captured_execution_results[i] = execution_result;
+            continue;
+          }
+          pbs_mutations = std::move(request_mutations);
+          has_consumed_budgets = true;
+          for (const auto& metadata : budgets) {
+            consumed_keys.insert(GetPbsPrimaryKey(metadata));
+          }
         }
 
-        if (auto [status, execution_result] =
-                UpdatePbsMutationsToConsumeBudgets(
-                    consume_budgets_context.request->budgets, pbs_mutations);
-            !status.ok()) {
-          captured_execution_result = execution_result;
-          return status;
+        for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+          if (captured_execution_results[i].status_code !=
+              SC_CONSUME_BUDGET_EXHAUSTED) {
+            continue;
+          }
+          for (const auto& metadata :
+               consume_budgets_contexts[i].request->budgets) {
+            auto pbs_mutation = pbs_mutations.find(GetPbsPrimaryKey(metadata));
+            if (pbs_mutation != pbs_mutations.end()) {
+              captured_exhausted_rows[GetRow(metadata)] =
+                  pbs_mutation->second.token_count();
+            }
+          }
+        }
+
+        // Rolls the transaction back if no request consumed any budget.
+        if (!has_consumed_budgets) {
+          captured_is_read_only = true;
+          return last_failure_status;
         }
 
+        absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyMutation>
+            consumed_mutations;
+        for (const auto& pbs_primary_key : consumed_keys) {
+          consumed_mutations.emplace(pbs_primary_key,
+                                     pbs_mutations[pbs_primary_key]);
+        }
         spanner::Mutations mutations;
-        if (auto [status, execution_result] =
-                CreateSpannerMutations(pbs_mutations, table_name_, mutations);
+        if (auto [status, execution_result] = CreateSpannerMutations(
+                consumed_mutations, table_name_, value_format_, mutations);
             !status.ok()) {
-          captured_execution_result = execution_result;
+          for (size_t i = 0; i < captured_execution_results.size(); ++i) {
+            if (captured_execution_results[i].Successful()) {
+              captured_execution_results[i] = execution_result;
+            }
+          }
           return status;
         }
         return mutations;
       });
+  std::chrono::nanoseconds commit_duration =
+      std::chrono::steady_clock::now() - commit_start_time;
+  if (attempt_count > 1) {
+    RecordAborts(consume_budgets_contexts, attempt_count - 1);
+  }
+  if (commit_result || captured_is_read_only) {
+    CacheExhaustedRows(captured_exhausted_rows);
+  }
+
+  for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+    auto& consume_budgets_context = consume_budgets_contexts[i];
+    const auto& captured_execution_result = captured_execution_results[i];
+    consume_budgets_context.response->commit_duration = commit_duration;
+    if (commit_result && captured_execution_result.Successful()) {
+      consume_budgets_context.result = SuccessExecutionResult();
+      continue;
+    }
 
-  if (!commit_result) {
     if (captured_execution_result.status_code == SC_CONSUME_BUDGET_EXHAUSTED) {
       consume_budgets_context.response->budget_exhausted_indices =
-          captured_budget_exhausted_indices;
+          captured_budget_exhausted_indices[i];
     }
 
     // If the error status is coming from PBS's application logics, the
@@ -505,24 +1075,169 @@ ExecutionResult BudgetConsumptionHelper::ConsumeBudgetsSync(
         !captured_execution_result.Successful()
             ? captured_execution_result
             : FailureExecutionResult(SC_CONSUME_BUDGET_FAIL_TO_COMMIT);
+    const cloud::Status& status =
+        commit_result ? captured_statuses[i] : commit_result.status();
     if (captured_execution_result.status_code == SC_CONSUME_BUDGET_EXHAUSTED) {
       SCP_WARNING_CONTEXT(
           kComponentName, consume_budgets_context,
           absl::StrFormat("ConsumeBudgets failed. Error code %d, message: %s, "
                           "final_execution_result: %s",
-                          commit_result.status().code(),
-                          commit_result.status().message(),
+                          status.code(), status.message(),
                           google::scp::core::errors::GetErrorMessage(
                               final_execution_result.status_code)));
     } else {
       SCP_ERROR_CONTEXT(
           kComponentName, consume_budgets_context, final_execution_result,
           absl::StrFormat("ConsumeBudgets failed. Error code %d, message: %s",
-                          commit_result.status().code(),
-                          commit_result.status().message()));
+                          status.code(), status.message()));
     }
-    return final_execution_result;
+    consume_budgets_context.result = final_execution_result;
+  }
+}
+
+void BudgetConsumptionHelper::RecordAborts(
+    const std::vector<AsyncContext<ConsumeBudgetsRequest,
+                                   ConsumeBudgetsResponse>>&
+        consume_budgets_contexts,
+    size_t abort_count) {
+  if (!transaction_abort_instrument_) {
+    return;
+  }
+
+  absl::flat_hash_set<std::string> budget_key_prefixes;
+  for (const auto& consume_budgets_context : consume_budgets_contexts) {
+    for (const auto& metadata : consume_budgets_context.request->budgets) {
+      absl::string_view budget_key_name = *metadata.budget_key_name;
+      budget_key_prefixes.emplace(
+          budget_key_name.substr(0, budget_key_name.find('/')));
+    }
+  }
+  for (const auto& budget_key_prefix : budget_key_prefixes) {
+    transaction_abort_instrument_->Add(
+        abort_count,
+        {{kMetricLabelBudgetKeyPrefix,
+          opentelemetry::nostd::string_view(budget_key_prefix)}});
+  }
+}
+
+std::vector<bool> BudgetConsumptionHelper::RejectExhaustedRequests(
+    std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>&
+        consume_budgets_contexts) {
+  std::vector<bool> is_rejected(consume_budgets_contexts.size(), false);
+  auto reject = [&](size_t i, std::vector<size_t> budget_exhausted_indices) {
+    is_rejected[i] = true;
+    consume_budgets_contexts[i].response->budget_exhausted_indices =
+        std::move(budget_exhausted_indices);
+    consume_budgets_contexts[i].result =
+        FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED);
+  };
+
+  if (exhausted_row_cache_ttl_in_nanoseconds_ > 0) {
+    auto now = TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+    std::lock_guard<std::mutex> lock(exhausted_rows_mutex_);
+    for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+      const auto& budgets = consume_budgets_contexts[i].request->budgets;
+      std::vector<size_t> budget_exhausted_indices;
+      for (size_t j = 0; j < budgets.size(); ++j) {
+        auto exhausted_row = exhausted_rows_.find(GetRow(budgets[j]));
+        if (exhausted_row == exhausted_rows_.end()) {
+          continue;
+        }
+        if (exhausted_row->second.expiry <= now) {
+          exhausted_rows_.erase(exhausted_row);
+          continue;
+        }
+        auto hour = budget_key_timeframe_manager::Utils::GetTimeBucket(
+            budgets[j].time_bucket);
+        if (exhausted_row->second.token_counts[hour] <
+            budgets[j].token_count) {
+          budget_exhausted_indices.push_back(j);
+        }
+      }
+      if (!budget_exhausted_indices.empty()) {
+        reject(i, std::move(budget_exhausted_indices));
+      }
+    }
+  }
+
+  if (stale_read_staleness_in_nanoseconds_ == 0) {
+    return is_rejected;
+  }
+
+  std::vector<ConsumeBudgetMetadata> all_budgets;
+  for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+    if (!is_rejected[i]) {
+      const auto& budgets = consume_budgets_contexts[i].request->budgets;
+      all_budgets.insert(all_budgets.end(), budgets.begin(), budgets.end());
+    }
+  }
+  if (all_budgets.empty()) {
+    return is_rejected;
+  }
+
+  // The budgets are only ever consumed, so a request exhausted at a past
+  // snapshot still is. Any failure leaves the decision to the read-write
+  // transaction.
+  spanner::Client client(spanner_connection_);
+  auto results = ReadPrivacyBudgetsForKeys(
+      client,
+      spanner::MakeReadOnlyTransaction(spanner::Transaction::ReadOnlyOptions(
+          std::chrono::nanoseconds(stale_read_staleness_in_nanoseconds_))),
+      table_name_, CreateSpannerKeySet(all_budgets), value_format_,
+      stale_read_options_);
+  if (!results.ok()) {
+    return is_rejected;
+  }
+
+  absl::flat_hash_map<PbsPrimaryKey, PbsBudgetKeyMutation> pbs_mutations;
+  for (const auto& [pbs_primary_key, spanner_value] : *results) {
+    PbsBudgetKeyMutation pbs_mutation;
+    if (auto [status, execution_result] =
+            pbs_mutation.ResetFromSpannerValue(spanner_value, value_format_);
+        status.ok()) {
+      pbs_mutations.emplace(pbs_primary_key, std::move(pbs_mutation));
+    }
+  }
+
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      std::vector<TokenCount>>
+      exhausted_rows;
+  for (size_t i = 0; i < consume_budgets_contexts.size(); ++i) {
+    if (is_rejected[i]) {
+      continue;
+    }
+    const auto& budgets = consume_budgets_contexts[i].request->budgets;
+    if (auto [status, execution_result, budget_exhausted_indices] =
+            ValidatePbsMutations(budgets, pbs_mutations);
+        !status.ok()) {
+      for (size_t j : budget_exhausted_indices) {
+        exhausted_rows[GetRow(budgets[j])] =
+            pbs_mutations.at(GetPbsPrimaryKey(budgets[j])).token_count();
+      }
+      reject(i, budget_exhausted_indices);
+    }
+  }
+  CacheExhaustedRows(exhausted_rows);
+  return is_rejected;
+}
+
+void BudgetConsumptionHelper::CacheExhaustedRows(
+    const absl::flat_hash_map<std::pair<std::string, std::string>,
+                              std::vector<TokenCount>>& exhausted_rows) {
+  if (exhausted_row_cache_ttl_in_nanoseconds_ == 0 || exhausted_rows.empty()) {
+    return;
+  }
+
+  auto expiry = TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() +
+                exhausted_row_cache_ttl_in_nanoseconds_;
+  std::lock_guard<std::mutex> lock(exhausted_rows_mutex_);
+  for (const auto& [row, token_counts] : exhausted_rows) {
+    if (exhausted_rows_.size() >= max_exhausted_row_cache_size_ &&
+        !exhausted_rows_.contains(row)) {
+      // Makes room for the replays of the latest exhausted rows.
+      exhausted_rows_.erase(exhausted_rows_.begin());
+    }
+    exhausted_rows_[row] = ExhaustedRow{token_counts, expiry};
   }
-  return SuccessExecutionResult();
 }
 }  // namespace google::scp::pbs
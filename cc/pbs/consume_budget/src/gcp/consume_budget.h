@@ -14,17 +14,32 @@
 #ifndef CC_PBS_CONSUME_BUDGET_SRC_GCP_CONSUME_BUDGET_H_
 #define CC_PBS_CONSUME_BUDGET_SRC_GCP_CONSUME_BUDGET_H_
 
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "cc/core/interface/async_context.h"
 #include "cc/core/interface/config_provider_interface.h"
+#include "cc/core/telemetry/src/metric/metric_router.h"
 #include "cc/pbs/interface/consume_budget_interface.h"
+#include "cc/pbs/interface/type_def.h"
 #include "cc/public/core/interface/execution_result.h"
 #include "google/cloud/spanner/client.h"
+#include "opentelemetry/metrics/meter.h"
+#include "opentelemetry/metrics/sync_instruments.h"
 
 namespace google::scp::pbs {
 
+// The format the token counts of a budget key are stored in. See
+// kBudgetKeyTableValueFormat.
+enum class BudgetKeyValueFormat { kJson, kJsonAndBinary, kBinary };
+
 // A helper class to consume privacy budgets for a given list of privacy budget
 // keys by writing to GCP Spanner.
 class BudgetConsumptionHelper : public BudgetConsumptionHelperInterface {
@@ -33,7 +48,8 @@ class BudgetConsumptionHelper : public BudgetConsumptionHelperInterface {
       google::scp::core::ConfigProviderInterface* config_provider,
       google::scp::core::AsyncExecutorInterface* async_executor,
       google::scp::core::AsyncExecutorInterface* io_async_executor,
-      std::shared_ptr<cloud::spanner::Connection> spanner_connection);
+      std::shared_ptr<cloud::spanner::Connection> spanner_connection,
+      std::shared_ptr<google::scp::core::MetricRouter> metric_router = nullptr);
 
   google::scp::core::ExecutionResult Init() noexcept override;
 
@@ -54,21 +70,103 @@ class BudgetConsumptionHelper : public BudgetConsumptionHelperInterface {
       google::scp::core::ConfigProviderInterface& config_provider);
 
  private:
-  void ConsumeBudgetsSyncAndFinishContext(
-      google::scp::core::AsyncContext<ConsumeBudgetsRequest,
-                                      ConsumeBudgetsResponse>
-          consume_budgets_context);
+  // Takes up to max_requests_per_transaction_ queued requests, consumes their
+  // budgets in a single transaction and finishes them.
+  void ConsumeQueuedBudgetsAndFinishContexts();
+
+  // Takes the queued requests to consume the budgets of in the next
+  // transaction. When the requests are serialized per row, the requests
+  // touching a row in flight, or a row of an earlier request left in the
+  // queue, stay queued.
+  std::vector<google::scp::core::AsyncContext<ConsumeBudgetsRequest,
+                                              ConsumeBudgetsResponse>>
+  TakeQueuedRequests();
+
+  // Rejects the requests known to be exhausted, from the exhausted row cache
+  // and from a stale read, if enabled. Returns which requests are rejected.
+  std::vector<bool> RejectExhaustedRequests(
+      std::vector<google::scp::core::AsyncContext<ConsumeBudgetsRequest,
+                                                  ConsumeBudgetsResponse>>&
+          consume_budgets_contexts);
+
+  // Caches the token counts left in the rows of exhausted requests, keyed by
+  // (budget key, timeframe).
+  void CacheExhaustedRows(
+      const absl::flat_hash_map<std::pair<std::string, std::string>,
+                                std::vector<TokenCount>>& exhausted_rows);
 
-  google::scp::core::ExecutionResult ConsumeBudgetsSync(
-      const google::scp::core::AsyncContext<ConsumeBudgetsRequest,
-                                            ConsumeBudgetsResponse>&
-          consume_budgets_context);
+  // Records the transaction aborts, labeled by the prefix of the budget keys
+  // of the requests.
+  void RecordAborts(
+      const std::vector<google::scp::core::AsyncContext<
+          ConsumeBudgetsRequest, ConsumeBudgetsResponse>>&
+          consume_budgets_contexts,
+      size_t abort_count);
+
+  // Consumes the budgets of the requests in a single read-write transaction,
+  // setting the result of each request. The requests are applied in order, a
+  // request failing for lack of budget leaving the others unaffected.
+  void ConsumeBudgetsSync(
+      std::vector<google::scp::core::AsyncContext<ConsumeBudgetsRequest,
+                                                  ConsumeBudgetsResponse>>&
+          consume_budgets_contexts);
 
   google::scp::core::ConfigProviderInterface* config_provider_;
   google::scp::core::AsyncExecutorInterface* async_executor_;
   google::scp::core::AsyncExecutorInterface* io_async_executor_;
   std::shared_ptr<cloud::spanner::Connection> spanner_connection_;
   std::string table_name_;
+  BudgetKeyValueFormat value_format_ = BudgetKeyValueFormat::kJson;
+  // The maximum number of requests whose budgets are consumed in the same
+  // transaction.
+  size_t max_requests_per_transaction_ = 1;
+  // How long the first request of a batch waits for the batch to fill up.
+  // Zero disables the waiting.
+  uint64_t batching_window_in_nanoseconds_ = 0;
+  // The requests waiting for an IO thread.
+  std::mutex pending_consume_budgets_contexts_mutex_;
+  std::deque<google::scp::core::AsyncContext<ConsumeBudgetsRequest,
+                                             ConsumeBudgetsResponse>>
+      pending_consume_budgets_contexts_;
+  // Whether the requests touching the same row are kept from reaching Spanner
+  // concurrently, so that they do not abort each other's transactions.
+  bool serialize_requests_per_row_ = false;
+  // The (budget key, timeframe) rows of the transactions in flight, when the
+  // requests are serialized per row. Guarded by
+  // pending_consume_budgets_contexts_mutex_.
+  absl::flat_hash_set<std::pair<std::string, std::string>> in_flight_rows_;
+
+  // The staleness of the snapshot the budgets are checked at before the
+  // read-write transaction. Zero disables the check.
+  uint64_t stale_read_staleness_in_nanoseconds_ = 0;
+  // The options of the stale reads, e.g. the replicas they are directed to.
+  google::cloud::Options stale_read_options_;
+
+  // The budgets of the timeframes older than this many days are rejected, as
+  // their rows may have been deleted by the row deletion policy of the table.
+  // Zero disables the check.
+  size_t budget_key_timeframe_retention_in_days_ = 0;
+
+  // The token counts left in a row, as of a committed state. The budgets are
+  // only ever consumed, so the actual token counts are at most these ones.
+  struct ExhaustedRow {
+    std::vector<TokenCount> token_counts;
+    core::Timestamp expiry;
+  };
+  // How long the rows stay in the exhausted row cache. Zero disables the
+  // cache.
+  uint64_t exhausted_row_cache_ttl_in_nanoseconds_ = 0;
+  size_t max_exhausted_row_cache_size_ = 0;
+  std::mutex exhausted_rows_mutex_;
+  absl::flat_hash_map<std::pair<std::string, std::string>, ExhaustedRow>
+      exhausted_rows_;
+
+  // When null, no OTel metric is produced.
+  std::shared_ptr<google::scp::core::MetricRouter> metric_router_;
+  std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+  // Counts the aborted read-write transactions.
+  std::shared_ptr<opentelemetry::metrics::Counter<uint64_t>>
+      transaction_abort_instrument_;
 };
 
 }  // namespace google::scp::pbs
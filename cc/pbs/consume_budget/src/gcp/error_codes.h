@@ -39,6 +39,18 @@ DEFINE_ERROR_CODE(SC_CONSUME_BUDGET_EXHAUSTED, SC_PBS_CONSUME_BUDGET, 0x0004,
                   "Failed to consume budget because budget is exhausted.",
                   google::scp::core::errors::HttpStatusCode::CONFLICT)
 
+DEFINE_ERROR_CODE(
+    SC_CONSUME_BUDGET_TOO_MANY_ROWS, SC_PBS_CONSUME_BUDGET, 0x0005,
+    "Failed to consume budget because the request has more budget key "
+    "timeframes than a database transaction can hold.",
+    google::scp::core::errors::HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(
+    SC_CONSUME_BUDGET_TIMEFRAME_EXPIRED, SC_PBS_CONSUME_BUDGET, 0x0006,
+    "Failed to consume budget because the timeframe is past the retention "
+    "of the budget key table.",
+    google::scp::core::errors::HttpStatusCode::BAD_REQUEST)
+
 }  // namespace google::scp::pbs::errors
 
 #endif  // CC_PBS_CONSUME_BUDGET_SRC_GCP_ERROR_CODES_H_
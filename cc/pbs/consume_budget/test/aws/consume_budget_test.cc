@@ -0,0 +1,336 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pbs/consume_budget/src/aws/consume_budget.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <aws/core/Aws.h>
+#include <aws/dynamodb/DynamoDBClient.h>
+#include <aws/dynamodb/DynamoDBErrors.h>
+#include <aws/dynamodb/model/TransactGetItemsRequest.h>
+#include <aws/dynamodb/model/TransactWriteItemsRequest.h>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "cc/core/async_executor/src/async_executor.h"
+#include "cc/core/config_provider/mock/mock_config_provider.h"
+#include "cc/pbs/consume_budget/src/gcp/error_codes.h"
+#include "cc/pbs/interface/configuration_keys.h"
+#include "cc/pbs/interface/consume_budget_interface.h"
+#include "cc/public/core/interface/execution_result.h"
+#include "cc/public/core/test/interface/execution_result_matchers.h"
+
+namespace google::scp::pbs {
+namespace {
+
+using ::Aws::InitAPI;
+using ::Aws::SDKOptions;
+using ::Aws::ShutdownAPI;
+using ::Aws::DynamoDB::DynamoDBClient;
+using ::Aws::DynamoDB::DynamoDBErrors;
+using ::Aws::DynamoDB::Model::AttributeValue;
+using ::Aws::DynamoDB::Model::ItemResponse;
+using ::Aws::DynamoDB::Model::TransactGetItemsOutcome;
+using ::Aws::DynamoDB::Model::TransactGetItemsRequest;
+using ::Aws::DynamoDB::Model::TransactGetItemsResult;
+using ::Aws::DynamoDB::Model::TransactWriteItemsOutcome;
+using ::Aws::DynamoDB::Model::TransactWriteItemsRequest;
+using ::Aws::DynamoDB::Model::TransactWriteItemsResult;
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::AsyncExecutor;
+using ::google::scp::core::AsyncExecutorInterface;
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::google::scp::core::test::ResultIs;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_EXHAUSTED;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_FAIL_TO_COMMIT;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_INITIALIZATION_ERROR;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_PARSING_ERROR;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_TOO_MANY_ROWS;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Return;
+
+constexpr size_t kThreadCount = 5;
+constexpr size_t kQueueSize = 100;
+constexpr char kTableName[] = "fake-table-name";
+constexpr char kAllTokens[] =
+    "1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1";
+constexpr char kSecondHourConsumed[] =
+    "1 0 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1";
+// 01:00:01 on the first day since epoch, in nanoseconds.
+constexpr uint64_t kSecondHourTimestamp = 3601000000000;
+
+class MockDynamoDBClient : public DynamoDBClient {
+ public:
+  MOCK_METHOD(TransactGetItemsOutcome, TransactGetItems,
+              (const TransactGetItemsRequest&), (const, override));
+  MOCK_METHOD(TransactWriteItemsOutcome, TransactWriteItems,
+              (const TransactWriteItemsRequest&), (const, override));
+};
+
+// The outcome of reading rows, each holding the given TokenCount, or missing
+// if it is empty.
+TransactGetItemsOutcome GetItemsOutcome(
+    const std::vector<std::string>& token_counts) {
+  TransactGetItemsResult result;
+  for (const auto& token_count : token_counts) {
+    ItemResponse response;
+    if (!token_count.empty()) {
+      response.AddItem("TokenCount",
+                       AttributeValue().SetS(token_count.c_str()));
+    }
+    result.AddResponses(std::move(response));
+  }
+  return TransactGetItemsOutcome(std::move(result));
+}
+
+// The TokenCount a write sets on its i-th row, and the one it is conditioned
+// on, empty if the row must not exist.
+std::pair<std::string, std::string> GetWrite(
+    const TransactWriteItemsRequest& request, size_t i) {
+  const auto& update = request.GetTransactItems()[i].GetUpdate();
+  const auto& values = update.GetExpressionAttributeValues();
+  auto condition_value = values.find(":token_count");
+  return std::make_pair(
+      values.at(":new_token_count").GetS().c_str(),
+      condition_value == values.end() ? ""
+                                      : condition_value->second.GetS().c_str());
+}
+
+class AwsBudgetConsumptionHelperTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    SDKOptions options;
+    InitAPI(options);
+  }
+
+  static void TearDownTestSuite() {
+    SDKOptions options;
+    ShutdownAPI(options);
+  }
+
+  void SetUp() override {
+    mock_dynamo_db_client_ = std::make_shared<MockDynamoDBClient>();
+    async_executor_ = std::make_unique<AsyncExecutor>(kThreadCount, kQueueSize);
+    io_async_executor_ =
+        std::make_unique<AsyncExecutor>(kThreadCount, kQueueSize);
+    mock_config_provider_ = std::make_unique<MockConfigProvider>();
+    mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+    budget_consumption_helper_ = std::make_unique<AwsBudgetConsumptionHelper>(
+        mock_config_provider_.get(), async_executor_.get(),
+        io_async_executor_.get(), mock_dynamo_db_client_);
+    ASSERT_SUCCESS(async_executor_->Init());
+    ASSERT_SUCCESS(io_async_executor_->Init());
+    ASSERT_SUCCESS(budget_consumption_helper_->Init());
+    ASSERT_SUCCESS(async_executor_->Run());
+    ASSERT_SUCCESS(io_async_executor_->Run());
+    ASSERT_SUCCESS(budget_consumption_helper_->Run());
+  }
+
+  void TearDown() override {
+    ASSERT_SUCCESS(budget_consumption_helper_->Stop());
+    ASSERT_SUCCESS(io_async_executor_->Stop());
+    ASSERT_SUCCESS(async_executor_->Stop());
+  }
+
+  // Consumes the budgets and waits for the result.
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> ConsumeBudgets(
+      std::vector<ConsumeBudgetMetadata> budgets) {
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+    context.request = std::make_shared<ConsumeBudgetsRequest>();
+    context.request->budgets = std::move(budgets);
+    context.response = std::make_shared<ConsumeBudgetsResponse>();
+
+    absl::BlockingCounter blocking(1);
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> result_context;
+    context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                        ConsumeBudgetsResponse>& context) {
+      result_context = context;
+      blocking.DecrementCount();
+    };
+    EXPECT_SUCCESS(budget_consumption_helper_->ConsumeBudgets(context));
+    blocking.Wait();
+    return result_context;
+  }
+
+  std::shared_ptr<MockDynamoDBClient> mock_dynamo_db_client_;
+  std::unique_ptr<AsyncExecutorInterface> async_executor_;
+  std::unique_ptr<AsyncExecutorInterface> io_async_executor_;
+  std::unique_ptr<MockConfigProvider> mock_config_provider_;
+  std::unique_ptr<AwsBudgetConsumptionHelper> budget_consumption_helper_;
+};
+
+TEST_F(AwsBudgetConsumptionHelperTest, InitializationFailed) {
+  AwsBudgetConsumptionHelper budget_consumption_helper(
+      mock_config_provider_.get(), async_executor_.get(),
+      io_async_executor_.get(), /*dynamo_db_client=*/nullptr);
+  EXPECT_THAT(
+      budget_consumption_helper.Init(),
+      ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_INITIALIZATION_ERROR)));
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsOnNonExistingRow) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce([](const TransactGetItemsRequest& request) {
+        EXPECT_EQ(request.GetTransactItems().size(), 1);
+        const auto& get = request.GetTransactItems()[0].GetGet();
+        EXPECT_EQ(get.GetTableName(), kTableName);
+        EXPECT_EQ(get.GetKey().at("Budget_Key").GetS(), "fake-key-name");
+        EXPECT_EQ(get.GetKey().at("Timeframe").GetS(), "0");
+        return GetItemsOutcome({""});
+      });
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems)
+      .WillOnce([](const TransactWriteItemsRequest& request) {
+        EXPECT_EQ(request.GetTransactItems().size(), 1);
+        EXPECT_EQ(request.GetTransactItems()[0]
+                      .GetUpdate()
+                      .GetConditionExpression(),
+                  "attribute_not_exists(#token_count)");
+        EXPECT_EQ(GetWrite(request, 0),
+                  std::make_pair(std::string(kSecondHourConsumed),
+                                 std::string()));
+        return TransactWriteItemsOutcome(TransactWriteItemsResult());
+      });
+
+  auto context = ConsumeBudgets({ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1,
+      kSecondHourTimestamp}});
+  EXPECT_SUCCESS(context.result);
+  EXPECT_THAT(context.response->budget_exhausted_indices, IsEmpty());
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsOnExistingRow) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce(Return(GetItemsOutcome({kAllTokens})));
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems)
+      .WillOnce([](const TransactWriteItemsRequest& request) {
+        EXPECT_EQ(GetWrite(request, 0),
+                  std::make_pair(std::string(kSecondHourConsumed),
+                                 std::string(kAllTokens)));
+        return TransactWriteItemsOutcome(TransactWriteItemsResult());
+      });
+
+  auto context = ConsumeBudgets({ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1,
+      kSecondHourTimestamp}});
+  EXPECT_SUCCESS(context.result);
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsOfTheSameRowInOneWrite) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce([](const TransactGetItemsRequest& request) {
+        EXPECT_EQ(request.GetTransactItems().size(), 1);
+        return GetItemsOutcome({kAllTokens});
+      });
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems)
+      .WillOnce([](const TransactWriteItemsRequest& request) {
+        EXPECT_EQ(request.GetTransactItems().size(), 1);
+        EXPECT_EQ(GetWrite(request, 0).first,
+                  "0 0 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1");
+        return TransactWriteItemsOutcome(TransactWriteItemsResult());
+      });
+
+  auto context = ConsumeBudgets(
+      {ConsumeBudgetMetadata{std::make_shared<std::string>("fake-key-name"), 1,
+                             kSecondHourTimestamp},
+       ConsumeBudgetMetadata{std::make_shared<std::string>("fake-key-name"), 1,
+                             1000}});
+  EXPECT_SUCCESS(context.result);
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsWithoutBudget) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce(Return(GetItemsOutcome({kAllTokens, kSecondHourConsumed})));
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems).Times(0);
+
+  auto context = ConsumeBudgets(
+      {ConsumeBudgetMetadata{std::make_shared<std::string>("key-1"), 1,
+                             kSecondHourTimestamp},
+       ConsumeBudgetMetadata{std::make_shared<std::string>("key-2"), 1,
+                             kSecondHourTimestamp}});
+  EXPECT_THAT(context.result,
+              ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED)));
+  EXPECT_THAT(context.response->budget_exhausted_indices, ElementsAre(1));
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsWithInvalidTokenCount) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce(Return(GetItemsOutcome({"1 1 1"})));
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems).Times(0);
+
+  auto context = ConsumeBudgets({ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1,
+      kSecondHourTimestamp}});
+  EXPECT_THAT(context.result, ResultIs(FailureExecutionResult(
+                                  SC_CONSUME_BUDGET_PARSING_ERROR)));
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsRetriesCanceledWrites) {
+  // The row is consumed by another request between the first read and write.
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce(Return(GetItemsOutcome({kAllTokens})))
+      .WillOnce(Return(GetItemsOutcome({kSecondHourConsumed})));
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems)
+      .WillOnce(Return(TransactWriteItemsOutcome(
+          Aws::Client::AWSError<DynamoDBErrors>(
+              DynamoDBErrors::TRANSACTION_CANCELED, false))));
+
+  auto context = ConsumeBudgets({ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1,
+      kSecondHourTimestamp}});
+  EXPECT_THAT(context.result,
+              ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED)));
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsFailsOnOtherErrors) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems)
+      .WillOnce(Return(GetItemsOutcome({kAllTokens})));
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactWriteItems)
+      .WillOnce(Return(TransactWriteItemsOutcome(
+          Aws::Client::AWSError<DynamoDBErrors>(
+              DynamoDBErrors::INTERNAL_SERVER_ERROR, false))));
+
+  auto context = ConsumeBudgets({ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1,
+      kSecondHourTimestamp}});
+  EXPECT_THAT(context.result, ResultIs(FailureExecutionResult(
+                                  SC_CONSUME_BUDGET_FAIL_TO_COMMIT)));
+}
+
+TEST_F(AwsBudgetConsumptionHelperTest, ConsumeBudgetsWithTooManyRows) {
+  EXPECT_CALL(*mock_dynamo_db_client_, TransactGetItems).Times(0);
+
+  std::vector<ConsumeBudgetMetadata> budgets;
+  for (int i = 0; i <= 100; ++i) {
+    budgets.push_back(ConsumeBudgetMetadata{
+        std::make_shared<std::string>(absl::StrCat("key-", i)), 1,
+        kSecondHourTimestamp});
+  }
+  auto context = ConsumeBudgets(std::move(budgets));
+  EXPECT_THAT(context.result, ResultIs(FailureExecutionResult(
+                                  SC_CONSUME_BUDGET_TOO_MANY_ROWS)));
+}
+}  // namespace
+}  // namespace google::scp::pbs
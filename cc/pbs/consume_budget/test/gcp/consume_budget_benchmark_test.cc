@@ -0,0 +1,437 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives the BudgetConsumptionHelper against a fake Spanner connection with a
+// configurable latency, which aborts the transactions whose rows were
+// committed by another transaction since they read them, like Spanner does.
+// Reports the requests per second, the aborts and the latency percentiles.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "cc/core/async_executor/src/async_executor.h"
+#include "cc/core/common/time_provider/src/time_provider.h"
+#include "cc/core/config_provider/mock/mock_config_provider.h"
+#include "cc/pbs/consume_budget/src/gcp/consume_budget.h"
+#include "cc/pbs/interface/configuration_keys.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/spanner/mocks/row.h"
+#include "google/cloud/spanner/results.h"
+#include "google/protobuf/text_format.h"
+
+namespace google::scp::pbs {
+namespace {
+
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::AsyncExecutor;
+using ::google::scp::core::common::TimeProvider;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::testing::_;
+using ::testing::NiceMock;
+namespace spanner = ::google::cloud::spanner;
+namespace spanner_mocks = ::google::cloud::spanner_mocks;
+
+constexpr absl::string_view kTableName = "benchmark-table-name";
+constexpr size_t kThreadCount = 8;
+constexpr size_t kIoThreadCount = 32;
+constexpr size_t kQueueSize = 100000;
+constexpr size_t kMaxRequestsInFlight = 128;
+constexpr size_t kHoursPerDay = 24;
+// Large enough for the budgets to never be exhausted.
+constexpr int32_t kTokenCountPerHour = 1 << 30;
+constexpr std::chrono::milliseconds kSpannerLatency(2);
+// The time bucket of the first hour of the first day, in nanoseconds.
+constexpr uint64_t kNanosecondsPerHour = 3600000000000;
+
+constexpr char kValueFormats[][16] = {"json", "json_and_binary", "binary"};
+
+constexpr char kAbortsPerRequestKey[] = "aborts_per_request";
+constexpr char kCommitsPerRequestKey[] = "commits_per_request";
+constexpr char kP50LatencyKey[] = "p50_latency_us";
+constexpr char kP99LatencyKey[] = "p99_latency_us";
+constexpr char kP999LatencyKey[] = "p999_latency_us";
+constexpr char kFailedRequestsKey[] = "failed_requests";
+
+constexpr absl::string_view kBudgetKeyTableMetadata = R"pb(
+  row_type: {
+    fields: {
+      name: "Budget_Key",
+      type: { code: STRING }
+    }
+    fields: {
+      name: "Timeframe",
+      type: { code: STRING }
+    }
+    fields: {
+      name: "Value",
+      type: { code: JSON }
+    }
+  })pb";
+
+constexpr absl::string_view kBudgetKeyTableWithTokenCountsMetadata = R"pb(
+  row_type: {
+    fields: {
+      name: "Budget_Key",
+      type: { code: STRING }
+    }
+    fields: {
+      name: "Timeframe",
+      type: { code: STRING }
+    }
+    fields: {
+      name: "Value",
+      type: { code: JSON }
+    }
+    fields: {
+      name: "Token_Counts",
+      type: { code: BYTES }
+    }
+  })pb";
+
+// Returns the rows given at construction.
+class FakeResultSetSource : public spanner::ResultSourceInterface {
+ public:
+  FakeResultSetSource(std::vector<spanner::Row> rows,
+                      google::spanner::v1::ResultSetMetadata metadata)
+      : rows_(std::move(rows)), metadata_(std::move(metadata)) {}
+
+  cloud::StatusOr<spanner::Row> NextRow() override {
+    if (next_row_ == rows_.size()) {
+      return spanner::Row();
+    }
+    return std::move(rows_[next_row_++]);
+  }
+
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    return metadata_;
+  }
+
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    return absl::nullopt;
+  }
+
+ private:
+  std::vector<spanner::Row> rows_;
+  size_t next_row_ = 0;
+  google::spanner::v1::ResultSetMetadata metadata_;
+};
+
+// A budget key table where every row exists with plenty of budget. The reads
+// and commits take the given latency, and a commit aborts if a row its
+// transaction read was committed since. The client runs a transaction on a
+// single thread, so the rows read are tracked per thread.
+class FakeBudgetKeyTable {
+ public:
+  FakeBudgetKeyTable(bool has_token_counts_column,
+                     std::chrono::nanoseconds latency)
+      : has_token_counts_column_(has_token_counts_column), latency_(latency) {
+    google::protobuf::TextFormat::ParseFromString(
+        std::string(has_token_counts_column
+                        ? kBudgetKeyTableWithTokenCountsMetadata
+                        : kBudgetKeyTableMetadata),
+        &metadata_);
+    std::string json = R"({"TokenCount":")";
+    std::string packed_token_counts;
+    for (size_t hour = 0; hour < kHoursPerDay; ++hour) {
+      absl::StrAppend(&json, hour == 0 ? "" : " ", kTokenCountPerHour);
+      for (int i = 0; i < 4; ++i) {
+        packed_token_counts.push_back(static_cast<char>(
+            (static_cast<uint32_t>(kTokenCountPerHour) >> (8 * i)) & 0xFF));
+      }
+    }
+    json += R"("})";
+    json_ = spanner::Json(json);
+    token_counts_ = spanner::Bytes(packed_token_counts);
+  }
+
+  spanner::RowStream Read(const spanner::Connection::ReadParams& params) {
+    std::this_thread::sleep_for(latency_);
+    auto key_set = cloud::spanner_internal::ToProto(params.keys);
+    std::vector<spanner::Row> rows;
+    auto& read_rows = GetReadRows();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& key : key_set.keys()) {
+      auto row = std::make_pair(key.values(0).string_value(),
+                                key.values(1).string_value());
+      read_rows.emplace_back(row, versions_[row]);
+      std::vector<std::pair<std::string, spanner::Value>> columns = {
+          {"Budget_Key", spanner::Value(row.first)},
+          {"Timeframe", spanner::Value(row.second)},
+          {"Value", spanner::Value(json_)}};
+      if (has_token_counts_column_) {
+        columns.emplace_back("Token_Counts", spanner::Value(token_counts_));
+      }
+      rows.push_back(spanner_mocks::MakeRow(std::move(columns)));
+    }
+    return spanner::RowStream(
+        std::make_unique<FakeResultSetSource>(std::move(rows), metadata_));
+  }
+
+  cloud::StatusOr<spanner::CommitResult> Commit() {
+    std::this_thread::sleep_for(latency_);
+    auto& read_rows = GetReadRows();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [row, version] : read_rows) {
+      if (versions_[row] != version) {
+        read_rows.clear();
+        aborts_++;
+        return cloud::Status(cloud::StatusCode::kAborted,
+                             "A row was committed since it was read.");
+      }
+    }
+    for (const auto& [row, version] : read_rows) {
+      versions_[row]++;
+    }
+    read_rows.clear();
+    commits_++;
+    return spanner::CommitResult{};
+  }
+
+  cloud::Status Rollback() {
+    GetReadRows().clear();
+    return cloud::Status();
+  }
+
+  std::atomic<uint64_t> aborts_{0};
+  std::atomic<uint64_t> commits_{0};
+
+ private:
+  using ReadRows =
+      std::vector<std::pair<std::pair<std::string, std::string>, uint64_t>>;
+
+  static ReadRows& GetReadRows() {
+    static thread_local ReadRows read_rows;
+    return read_rows;
+  }
+
+  bool has_token_counts_column_;
+  std::chrono::nanoseconds latency_;
+  google::spanner::v1::ResultSetMetadata metadata_;
+  spanner::Json json_;
+  spanner::Bytes token_counts_;
+  std::mutex mutex_;
+  // The number of commits of each (budget key, timeframe) row.
+  absl::flat_hash_map<std::pair<std::string, std::string>, uint64_t> versions_;
+};
+
+/**
+ * @brief Runs the budget consumption helper on real async executors, against
+ * the fake budget key table.
+ *
+ * The benchmark arguments are the value format, the max requests per
+ * transaction, the batching window in milliseconds, whether the requests are
+ * serialized per row, the budgets consumed per request and the number of
+ * budget keys the requests pick theirs from.
+ */
+class BudgetConsumptionHelperFixture : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State& state) override {
+    auto value_format = state.range(0);
+    budgets_per_request_ = state.range(4);
+    key_count_ = state.range(5);
+    in_flight_ = 0;
+    failed_requests_ = 0;
+    latencies_.clear();
+    random_.seed(0);
+
+    table_ = std::make_unique<FakeBudgetKeyTable>(value_format != 0,
+                                                  kSpannerLatency);
+    auto connection =
+        std::make_shared<NiceMock<spanner_mocks::MockConnection>>();
+    ON_CALL(*connection, Read(_))
+        .WillByDefault([this](spanner::Connection::ReadParams params) {
+          return table_->Read(params);
+        });
+    ON_CALL(*connection, Commit(_))
+        .WillByDefault([this](const spanner::Connection::CommitParams&) {
+          return table_->Commit();
+        });
+    ON_CALL(*connection, Rollback(_))
+        .WillByDefault([this](const spanner::Connection::RollbackParams&) {
+          return table_->Rollback();
+        });
+
+    config_provider_ = std::make_unique<MockConfigProvider>();
+    config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+    config_provider_->Set(kBudgetKeyTableValueFormat,
+                          std::string(kValueFormats[value_format]));
+    config_provider_->SetInt(kBudgetConsumptionHelperMaxRequestsPerTransaction,
+                             state.range(1));
+    config_provider_->SetInt(
+        kBudgetConsumptionHelperBatchingWindowInMilliseconds, state.range(2));
+    config_provider_->SetBool(kBudgetConsumptionHelperSerializeRequestsPerRow,
+                              state.range(3) != 0);
+
+    async_executor_ = std::make_unique<AsyncExecutor>(kThreadCount, kQueueSize);
+    io_async_executor_ =
+        std::make_unique<AsyncExecutor>(kIoThreadCount, kQueueSize);
+    budget_consumption_helper_ = std::make_unique<BudgetConsumptionHelper>(
+        config_provider_.get(), async_executor_.get(),
+        io_async_executor_.get(), connection);
+
+    async_executor_->Init();
+    io_async_executor_->Init();
+    budget_consumption_helper_->Init();
+    async_executor_->Run();
+    io_async_executor_->Run();
+    budget_consumption_helper_->Run();
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    budget_consumption_helper_->Stop();
+    io_async_executor_->Stop();
+    async_executor_->Stop();
+    budget_consumption_helper_ = nullptr;
+    table_ = nullptr;
+  }
+
+  /// @brief Builds a request consuming a token of distinct random budget
+  /// keys, each in a random hour of the first day.
+  std::shared_ptr<ConsumeBudgetsRequest> CreateRequest() {
+    std::uniform_int_distribution<size_t> key_distribution(0, key_count_ - 1);
+    std::uniform_int_distribution<uint64_t> hour_distribution(
+        0, kHoursPerDay - 1);
+    std::vector<size_t> keys;
+    while (keys.size() < std::min(budgets_per_request_, key_count_)) {
+      auto key = key_distribution(random_);
+      if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+        keys.push_back(key);
+      }
+    }
+    auto request = std::make_shared<ConsumeBudgetsRequest>();
+    for (auto key : keys) {
+      request->budgets.push_back(ConsumeBudgetMetadata{
+          std::make_shared<std::string>("budget_key_" + std::to_string(key)),
+          1, hour_distribution(random_) * kNanosecondsPerHour});
+    }
+    return request;
+  }
+
+  /// @brief Consumes the budgets of a request, blocking while the maximum
+  /// requests are already in flight.
+  void ConsumeBudgets() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock,
+                      [this]() { return in_flight_ < kMaxRequestsInFlight; });
+      in_flight_++;
+    }
+
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+    context.request = CreateRequest();
+    context.response = std::make_shared<ConsumeBudgetsResponse>();
+    auto start_timestamp = TimeProvider::GetSteadyTimestampInNanoseconds();
+    context.callback =
+        [this, start_timestamp](
+            AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>&
+                context) {
+          auto latency =
+              TimeProvider::GetSteadyTimestampInNanoseconds() - start_timestamp;
+          OnResponse(context.result.Successful(), latency);
+        };
+    if (!budget_consumption_helper_->ConsumeBudgets(context).Successful()) {
+      OnResponse(false, std::chrono::nanoseconds(0));
+    }
+  }
+
+  void OnResponse(bool is_successful, std::chrono::nanoseconds latency) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (is_successful) {
+        latencies_.push_back(latency.count());
+      } else {
+        failed_requests_++;
+      }
+      in_flight_--;
+    }
+    condition_.notify_all();
+  }
+
+  /// @brief Blocks until every request sent has its response.
+  void WaitForResponses() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return in_flight_ == 0; });
+  }
+
+  /// @brief Returns the latency of the given percentile, in microseconds.
+  double GetLatencyPercentile(double percentile) {
+    if (latencies_.empty()) {
+      return 0;
+    }
+    auto index = static_cast<size_t>(percentile * (latencies_.size() - 1));
+    std::nth_element(latencies_.begin(), latencies_.begin() + index,
+                     latencies_.end());
+    return latencies_[index] / 1000.0;
+  }
+
+  std::unique_ptr<FakeBudgetKeyTable> table_;
+  std::unique_ptr<MockConfigProvider> config_provider_;
+  std::unique_ptr<AsyncExecutor> async_executor_;
+  std::unique_ptr<AsyncExecutor> io_async_executor_;
+  std::unique_ptr<BudgetConsumptionHelper> budget_consumption_helper_;
+  size_t budgets_per_request_ = 0;
+  size_t key_count_ = 0;
+  std::mt19937_64 random_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t in_flight_ = 0;
+  size_t failed_requests_ = 0;
+  std::vector<int64_t> latencies_;
+};
+
+BENCHMARK_DEFINE_F(BudgetConsumptionHelperFixture, ConsumeBudgets)
+
+(benchmark::State& state) {
+  for (auto _ : state) {
+    ConsumeBudgets();
+  }
+  WaitForResponses();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto requests = static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations());
+  state.counters[kAbortsPerRequestKey] = table_->aborts_.load() / requests;
+  state.counters[kCommitsPerRequestKey] = table_->commits_.load() / requests;
+  state.counters[kP50LatencyKey] = GetLatencyPercentile(0.5);
+  state.counters[kP99LatencyKey] = GetLatencyPercentile(0.99);
+  state.counters[kP999LatencyKey] = GetLatencyPercentile(0.999);
+  state.counters[kFailedRequestsKey] = failed_requests_;
+}
+
+// Value format, max requests per transaction, batching window, serialization
+// per row, budgets per request and budget keys.
+BENCHMARK_REGISTER_F(BudgetConsumptionHelperFixture, ConsumeBudgets)
+    ->ArgsProduct({{0, 1, 2}, {1, 16}, {0, 2}, {0, 1}, {1, 8}, {64, 1 << 16}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace google::scp::pbs
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -15,9 +15,13 @@
 
 #include <gtest/gtest.h>
 
+#include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/synchronization/blocking_counter.h"
+#include "cc/core/async_executor/mock/mock_async_executor.h"
 #include "cc/core/async_executor/src/async_executor.h"
 #include "cc/core/config_provider/mock/mock_config_provider.h"
 #include "cc/core/interface/configuration_keys.h"
@@ -37,16 +41,27 @@ using ::google::protobuf::TextFormat;
 using ::google::scp::core::AsyncContext;
 using ::google::scp::core::AsyncExecutor;
 using ::google::scp::core::AsyncExecutorInterface;
+using ::google::scp::core::AsyncOperation;
+using ::google::scp::core::async_executor::mock::MockAsyncExecutor;
 using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::FailureExecutionResult;
 using ::google::scp::core::SuccessExecutionResult;
 using ::google::scp::core::config_provider::mock::MockConfigProvider;
 using ::google::scp::core::errors::SC_ASYNC_EXECUTOR_NOT_RUNNING;
 using ::google::scp::core::test::ResultIs;
+using ::google::scp::pbs::kBudgetConsumptionHelperBatchingWindowInMilliseconds;
+using ::google::scp::pbs::kBudgetConsumptionHelperExhaustedRowCacheTtlInSeconds;
+using ::google::scp::pbs::kBudgetConsumptionHelperMaxRequestsPerTransaction;
+using ::google::scp::pbs::kBudgetConsumptionHelperSerializeRequestsPerRow;
+using ::google::scp::pbs::kBudgetConsumptionHelperStaleReadDirectedReadLocations;
+using ::google::scp::pbs::kBudgetConsumptionHelperStaleReadStalenessInMilliseconds;
 using ::google::scp::pbs::kBudgetKeyTableName;
+using ::google::scp::pbs::kBudgetKeyTableValueFormat;
+using ::google::scp::pbs::kBudgetKeyTimeframeRetentionInDays;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_EXHAUSTED;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_INITIALIZATION_ERROR;
 using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_PARSING_ERROR;
+using ::google::scp::pbs::errors::SC_CONSUME_BUDGET_TIMEFRAME_EXPIRED;
 using ::testing::_;
 using ::testing::AllOf;
 using ::testing::ByMove;
@@ -63,6 +78,7 @@ namespace spanner_mocks = ::google::cloud::spanner_mocks;
 constexpr absl::string_view kBudgetKeySpannerColumnName = "Budget_Key";
 constexpr absl::string_view kTimeframeSpannerColumnName = "Timeframe";
 constexpr absl::string_view kValueSpannerColumnName = "Value";
+constexpr absl::string_view kTokenCountsSpannerColumnName = "Token_Counts";
 constexpr size_t kThreadCount = 5;
 constexpr size_t kQueueSize = 100;
 constexpr absl::string_view kTableName = "fake-table-name";
@@ -82,14 +98,47 @@ constexpr absl::string_view kBudgetKeyTableMetadata = R"pb(
     }
   })pb";
 
+constexpr absl::string_view kBudgetKeyTableWithTokenCountsMetadata = R"pb(
+  row_type: {
+    fields: {
+      name: "Budget_Key",
+      type: { code: STRING }
+    }
+    fields: {
+      name: "Timeframe",
+      type: { code: STRING }
+    }
+    fields: {
+      name: "Value",
+      type: { code: JSON }
+    }
+    fields: {
+      name: "Token_Counts",
+      type: { code: BYTES }
+    }
+  })pb";
+
+// Packs the token counts the way the Token_Counts column holds them.
+spanner::Bytes PackTokenCounts(const std::vector<int32_t>& token_counts) {
+  std::string packed_token_counts;
+  for (int32_t token_count : token_counts) {
+    for (int i = 0; i < 4; ++i) {
+      packed_token_counts.push_back(static_cast<char>(
+          (static_cast<uint32_t>(token_count) >> (8 * i)) & 0xFF));
+    }
+  }
+  return spanner::Bytes(packed_token_counts);
+}
+
 std::unique_ptr<spanner_mocks::MockResultSetSource>
-CreatePbsMockResultSetSource() {
+CreatePbsMockResultSetSource(
+    absl::string_view table_metadata = kBudgetKeyTableMetadata) {
   auto source =
       std::make_unique<google::cloud::spanner_mocks::MockResultSetSource>();
 
   google::spanner::v1::ResultSetMetadata metadata;
-  EXPECT_TRUE(TextFormat::ParseFromString(std::string(kBudgetKeyTableMetadata),
-                                          &metadata));
+  EXPECT_TRUE(
+      TextFormat::ParseFromString(std::string(table_metadata), &metadata));
   EXPECT_CALL(*source, Metadata()).WillRepeatedly(Return(metadata));
   return source;
 }
@@ -146,6 +195,16 @@ TEST_F(BudgetConsumptionHelperTest, InitializationFailed) {
       ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_INITIALIZATION_ERROR)));
 }
 
+TEST_F(BudgetConsumptionHelperTest,
+       InitializationWithInvalidValueFormatFailed) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->Set(kBudgetKeyTableValueFormat,
+                             std::string("invalid"));
+  EXPECT_THAT(
+      budget_consumption_helper_->Init(),
+      ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_INITIALIZATION_ERROR)));
+}
+
 TEST_F(BudgetConsumptionHelperTest, ExecutorNotYetRunShouldFail) {
   AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
   EXPECT_THAT(budget_consumption_helper_->ConsumeBudgets(context),
@@ -470,5 +529,525 @@ TEST_F(BudgetConsumptionHelperWithLifecycleTest,
       ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_PARSING_ERROR)));
   EXPECT_THAT(result_context.response->budget_exhausted_indices, IsEmpty());
 }
+
+TEST_F(BudgetConsumptionHelperTest,
+       ConsumeBudgetsReadsValueColumnWhileJsonWritersRemain) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->Set(kBudgetKeyTableValueFormat,
+                             std::string("json_and_binary"));
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  std::unique_ptr<spanner_mocks::MockResultSetSource> source =
+      CreatePbsMockResultSetSource(kBudgetKeyTableWithTokenCountsMetadata);
+
+  // An instance still in the JSON format consumed the budget of the hour 1 in
+  // the Value column, leaving the Token_Counts column stale.
+  std::vector<int32_t> token_counts(24, 1);
+  token_counts[1] = 5;
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(spanner_mocks::MakeRow(
+          {{std::string(kBudgetKeySpannerColumnName),
+            spanner::Value("fake-key-name")},
+           {std::string(kTimeframeSpannerColumnName), spanner::Value("0")},
+           {std::string(kValueSpannerColumnName),
+            spanner::Value(spanner::Json(
+                R"({"TokenCount":"1 0 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"))},
+           {std::string(kTokenCountsSpannerColumnName),
+            spanner::Value(PackTokenCounts(token_counts))}})))
+      .WillRepeatedly(Return(spanner::Row()));
+
+  EXPECT_CALL(*mock_connection_,
+              Read(Field(&spanner::Connection::ReadParams::columns,
+                         ElementsAre(std::string(kBudgetKeySpannerColumnName),
+                                     std::string(kTimeframeSpannerColumnName),
+                                     std::string(kValueSpannerColumnName),
+                                     std::string(
+                                         kTokenCountsSpannerColumnName)))))
+      .WillOnce(Return(ByMove(spanner::RowStream(std::move(source)))));
+
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+  context.request = std::make_shared<ConsumeBudgetsRequest>();
+  context.request->budgets.push_back(ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+  context.response = std::make_shared<ConsumeBudgetsResponse>();
+
+  EXPECT_CALL(*mock_connection_, Commit).Times(0);
+  EXPECT_CALL(*mock_connection_, Rollback).Times(1);
+
+  absl::BlockingCounter blocking(1);
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> result_context;
+  context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                      ConsumeBudgetsResponse>& context) {
+    result_context = context;
+    blocking.DecrementCount();
+  };
+  EXPECT_SUCCESS(budget_consumption_helper_->ConsumeBudgets(context));
+  blocking.Wait();
+
+  EXPECT_THAT(result_context.result,
+              ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED)));
+  EXPECT_THAT(result_context.response->budget_exhausted_indices,
+              ElementsAre(0));
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest,
+       ConsumeBudgetsWritesBothFormatsFromTheValueColumn) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->Set(kBudgetKeyTableValueFormat,
+                             std::string("json_and_binary"));
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  std::unique_ptr<spanner_mocks::MockResultSetSource> source =
+      CreatePbsMockResultSetSource(kBudgetKeyTableWithTokenCountsMetadata);
+
+  // A row not written in binary yet.
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(spanner_mocks::MakeRow(
+          {{std::string(kBudgetKeySpannerColumnName),
+            spanner::Value("fake-key-name")},
+           {std::string(kTimeframeSpannerColumnName), spanner::Value("0")},
+           {std::string(kValueSpannerColumnName),
+            spanner::Value(spanner::Json(
+                R"({"TokenCount":"1 5 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"))},
+           {std::string(kTokenCountsSpannerColumnName),
+            spanner::Value(absl::optional<spanner::Bytes>())}})))
+      .WillRepeatedly(Return(spanner::Row()));
+
+  EXPECT_CALL(*mock_connection_, Read)
+      .WillOnce(Return(ByMove(spanner::RowStream(std::move(source)))));
+
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+  context.request = std::make_shared<ConsumeBudgetsRequest>();
+  context.request->budgets.push_back(ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+  context.response = std::make_shared<ConsumeBudgetsResponse>();
+
+  std::vector<int32_t> token_counts(24, 1);
+  token_counts[1] = 4;
+  spanner::Mutation m =
+      cloud::spanner::UpdateMutationBuilder(
+          std::string(kTableName),
+          {std::string(kBudgetKeySpannerColumnName),
+           std::string(kTimeframeSpannerColumnName),
+           std::string(kValueSpannerColumnName),
+           std::string(kTokenCountsSpannerColumnName)})
+          .EmplaceRow(
+              "fake-key-name", "0",
+              spanner::Json(
+                  R"({"TokenCount":"1 4 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"),
+              PackTokenCounts(token_counts))
+          .Build();
+  EXPECT_CALL(*mock_connection_,
+              Commit(FieldsAre(_, UnorderedElementsAre(m), _)))
+      .WillOnce(Return(spanner::CommitResult{}));
+
+  absl::BlockingCounter blocking(1);
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> result_context;
+  context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                      ConsumeBudgetsResponse>& context) {
+    result_context = context;
+    blocking.DecrementCount();
+  };
+  EXPECT_SUCCESS(budget_consumption_helper_->ConsumeBudgets(context));
+  blocking.Wait();
+
+  EXPECT_SUCCESS(result_context.result);
+  EXPECT_THAT(result_context.response->budget_exhausted_indices, IsEmpty());
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest,
+       ConsumeBudgetsPrefersTokenCountsColumnInBinaryFormat) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->Set(kBudgetKeyTableValueFormat,
+                             std::string("binary"));
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  std::unique_ptr<spanner_mocks::MockResultSetSource> source =
+      CreatePbsMockResultSetSource(kBudgetKeyTableWithTokenCountsMetadata);
+
+  // The row was last written with "json_and_binary", both columns agree but the
+  // Value column is not read.
+  std::vector<int32_t> token_counts(24, 1);
+  token_counts[1] = 5;
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(spanner_mocks::MakeRow(
+          {{std::string(kBudgetKeySpannerColumnName),
+            spanner::Value("fake-key-name")},
+           {std::string(kTimeframeSpannerColumnName), spanner::Value("0")},
+           {std::string(kValueSpannerColumnName),
+            spanner::Value(spanner::Json(R"({"TokenCount":"invalid"})"))},
+           {std::string(kTokenCountsSpannerColumnName),
+            spanner::Value(PackTokenCounts(token_counts))}})))
+      .WillRepeatedly(Return(spanner::Row()));
+
+  EXPECT_CALL(*mock_connection_, Read)
+      .WillOnce(Return(ByMove(spanner::RowStream(std::move(source)))));
+
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+  context.request = std::make_shared<ConsumeBudgetsRequest>();
+  context.request->budgets.push_back(ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+  context.response = std::make_shared<ConsumeBudgetsResponse>();
+
+  token_counts[1] = 4;
+  spanner::Mutation m =
+      cloud::spanner::UpdateMutationBuilder(
+          std::string(kTableName),
+          {std::string(kBudgetKeySpannerColumnName),
+           std::string(kTimeframeSpannerColumnName),
+           std::string(kValueSpannerColumnName),
+           std::string(kTokenCountsSpannerColumnName)})
+          .EmplaceRow("fake-key-name", "0", absl::optional<spanner::Json>(),
+                      PackTokenCounts(token_counts))
+          .Build();
+  EXPECT_CALL(*mock_connection_,
+              Commit(FieldsAre(_, UnorderedElementsAre(m), _)))
+      .WillOnce(Return(spanner::CommitResult{}));
+
+  absl::BlockingCounter blocking(1);
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> result_context;
+  context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                      ConsumeBudgetsResponse>& context) {
+    result_context = context;
+    blocking.DecrementCount();
+  };
+  EXPECT_SUCCESS(budget_consumption_helper_->ConsumeBudgets(context));
+  blocking.Wait();
+
+  EXPECT_SUCCESS(result_context.result);
+  EXPECT_THAT(result_context.response->budget_exhausted_indices, IsEmpty());
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest, ConsumeBudgetsOfQueuedRequestsTogether) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->SetInt(
+      kBudgetConsumptionHelperMaxRequestsPerTransaction, 2);
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  // Holds the IO tasks until both requests are queued.
+  MockAsyncExecutor mock_io_async_executor;
+  std::vector<AsyncOperation> io_tasks;
+  mock_io_async_executor.schedule_mock = [&](const AsyncOperation& work) {
+    io_tasks.push_back(work);
+    return SuccessExecutionResult();
+  };
+  BudgetConsumptionHelper budget_consumption_helper(
+      mock_config_provider_.get(), async_executor_.get(),
+      &mock_io_async_executor, mock_connection_);
+  ASSERT_SUCCESS(budget_consumption_helper.Init());
+
+  std::unique_ptr<spanner_mocks::MockResultSetSource> source =
+      CreatePbsMockResultSetSource();
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(spanner_mocks::MakeRow(
+          {{std::string(kBudgetKeySpannerColumnName),
+            spanner::Value("fake-key-name")},
+           {std::string(kTimeframeSpannerColumnName), spanner::Value("0")},
+           {std::string(kValueSpannerColumnName),
+            spanner::Value(spanner::Json(
+                R"({"TokenCount":"1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"))}})))
+      .WillRepeatedly(Return(spanner::Row()));
+
+  // A single read and a single commit serve both requests, and the row they
+  // share is only read once.
+  spanner::KeySet expected_key_set;
+  expected_key_set.AddKey(spanner::MakeKey("fake-key-name", "0"));
+  EXPECT_CALL(*mock_connection_,
+              Read(Field(&spanner::Connection::ReadParams::keys,
+                         Eq(expected_key_set))))
+      .WillOnce(Return(ByMove(spanner::RowStream(std::move(source)))));
+
+  spanner::Mutation m =
+      cloud::spanner::UpdateMutationBuilder(
+          std::string(kTableName), {std::string(kBudgetKeySpannerColumnName),
+                                    std::string(kTimeframeSpannerColumnName),
+                                    std::string(kValueSpannerColumnName)})
+          .EmplaceRow(
+              "fake-key-name", "0",
+              spanner::Json(
+                  R"({"TokenCount":"1 0 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"))
+          .Build();
+  EXPECT_CALL(*mock_connection_,
+              Commit(FieldsAre(_, UnorderedElementsAre(m), _)))
+      .WillOnce(Return(spanner::CommitResult{}));
+
+  absl::BlockingCounter blocking(2);
+  std::vector<AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>>
+      result_contexts(2);
+  for (size_t i = 0; i < 2; ++i) {
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+    context.request = std::make_shared<ConsumeBudgetsRequest>();
+    context.request->budgets.push_back(ConsumeBudgetMetadata{
+        std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+    context.response = std::make_shared<ConsumeBudgetsResponse>();
+    context.callback = [&, i](AsyncContext<ConsumeBudgetsRequest,
+                                           ConsumeBudgetsResponse>& context) {
+      result_contexts[i] = context;
+      blocking.DecrementCount();
+    };
+    EXPECT_SUCCESS(budget_consumption_helper.ConsumeBudgets(context));
+  }
+
+  ASSERT_EQ(io_tasks.size(), 2);
+  for (auto& io_task : io_tasks) {
+    io_task();
+  }
+  blocking.Wait();
+
+  // The second request sees the budget consumed by the first one.
+  EXPECT_SUCCESS(result_contexts[0].result);
+  EXPECT_THAT(result_contexts[1].result,
+              ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED)));
+  EXPECT_THAT(result_contexts[1].response->budget_exhausted_indices,
+              ElementsAre(0));
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest,
+       FirstRequestOfABatchWaitsForTheBatchingWindow) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->SetInt(
+      kBudgetConsumptionHelperMaxRequestsPerTransaction, 2);
+  mock_config_provider_->SetInt(
+      kBudgetConsumptionHelperBatchingWindowInMilliseconds, 10);
+
+  MockAsyncExecutor mock_io_async_executor;
+  size_t immediate_task_count = 0;
+  mock_io_async_executor.schedule_mock = [&](const AsyncOperation&) {
+    immediate_task_count++;
+    return SuccessExecutionResult();
+  };
+  size_t delayed_task_count = 0;
+  mock_io_async_executor.schedule_for_mock =
+      [&](const AsyncOperation&, core::Timestamp, std::function<bool()>&) {
+        delayed_task_count++;
+        return SuccessExecutionResult();
+      };
+  BudgetConsumptionHelper budget_consumption_helper(
+      mock_config_provider_.get(), async_executor_.get(),
+      &mock_io_async_executor, mock_connection_);
+  ASSERT_SUCCESS(budget_consumption_helper.Init());
+
+  auto consume_budgets = [&]() {
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+    context.request = std::make_shared<ConsumeBudgetsRequest>();
+    context.response = std::make_shared<ConsumeBudgetsResponse>();
+    EXPECT_SUCCESS(budget_consumption_helper.ConsumeBudgets(context));
+  };
+
+  // The first request waits for the batch to fill up.
+  consume_budgets();
+  EXPECT_EQ(delayed_task_count, 1);
+  EXPECT_EQ(immediate_task_count, 0);
+
+  // The request filling the batch sends it right away.
+  consume_budgets();
+  EXPECT_EQ(delayed_task_count, 1);
+  EXPECT_EQ(immediate_task_count, 1);
+
+  // The next request starts a new batch.
+  consume_budgets();
+  EXPECT_EQ(delayed_task_count, 2);
+  EXPECT_EQ(immediate_task_count, 1);
+}
+
+TEST_F(BudgetConsumptionHelperTest, RequestsOnTheSameRowAreSerialized) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->SetBool(
+      kBudgetConsumptionHelperSerializeRequestsPerRow, true);
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  MockAsyncExecutor mock_io_async_executor;
+  // A deque, as the tasks are scheduled while others run.
+  std::deque<AsyncOperation> io_tasks;
+  mock_io_async_executor.schedule_mock = [&](const AsyncOperation& work) {
+    io_tasks.push_back(work);
+    return SuccessExecutionResult();
+  };
+  BudgetConsumptionHelper budget_consumption_helper(
+      mock_config_provider_.get(), async_executor_.get(),
+      &mock_io_async_executor, mock_connection_);
+  ASSERT_SUCCESS(budget_consumption_helper.Init());
+
+  std::vector<std::unique_ptr<spanner_mocks::MockResultSetSource>> sources;
+  for (int i = 0; i < 2; ++i) {
+    sources.push_back(CreatePbsMockResultSetSource());
+    EXPECT_CALL(*sources.back(), NextRow())
+        .WillRepeatedly(Return(spanner::Row()));
+  }
+
+  // The task of the second request runs while the first request is in flight
+  // on the same row.
+  size_t read_count = 0;
+  EXPECT_CALL(*mock_connection_, Read)
+      .WillOnce([&](const spanner::Connection::ReadParams&) {
+        read_count++;
+        io_tasks[1]();
+        EXPECT_EQ(read_count, 1);
+        return spanner::RowStream(std::move(sources[0]));
+      })
+      .WillOnce([&](const spanner::Connection::ReadParams&) {
+        read_count++;
+        return spanner::RowStream(std::move(sources[1]));
+      });
+  EXPECT_CALL(*mock_connection_, Commit)
+      .Times(2)
+      .WillRepeatedly(Return(spanner::CommitResult{}));
+
+  absl::BlockingCounter blocking(2);
+  for (int i = 0; i < 2; ++i) {
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+    context.request = std::make_shared<ConsumeBudgetsRequest>();
+    context.request->budgets.push_back(ConsumeBudgetMetadata{
+        std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+    context.response = std::make_shared<ConsumeBudgetsResponse>();
+    context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                        ConsumeBudgetsResponse>& context) {
+      EXPECT_SUCCESS(context.result);
+      blocking.DecrementCount();
+    };
+    EXPECT_SUCCESS(budget_consumption_helper.ConsumeBudgets(context));
+  }
+
+  ASSERT_EQ(io_tasks.size(), 2);
+  io_tasks[0]();
+
+  // Releasing the row schedules a task for the request left queued.
+  ASSERT_EQ(io_tasks.size(), 3);
+  io_tasks[2]();
+  blocking.Wait();
+  EXPECT_EQ(read_count, 2);
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest,
+       ReplaysOnExhaustedRowsAreRejectedInProcess) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->SetInt(
+      kBudgetConsumptionHelperExhaustedRowCacheTtlInSeconds, 60);
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  std::unique_ptr<spanner_mocks::MockResultSetSource> source =
+      CreatePbsMockResultSetSource();
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(spanner_mocks::MakeRow(
+          {{std::string(kBudgetKeySpannerColumnName),
+            spanner::Value("fake-key-name")},
+           {std::string(kTimeframeSpannerColumnName), spanner::Value("0")},
+           {std::string(kValueSpannerColumnName),
+            spanner::Value(spanner::Json(
+                R"({"TokenCount":"1 0 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"))}})))
+      .WillRepeatedly(Return(spanner::Row()));
+
+  // Only the first request reads the row.
+  EXPECT_CALL(*mock_connection_, Read)
+      .WillOnce(Return(ByMove(spanner::RowStream(std::move(source)))));
+  EXPECT_CALL(*mock_connection_, Commit).Times(0);
+  EXPECT_CALL(*mock_connection_, Rollback).Times(1);
+
+  for (int i = 0; i < 2; ++i) {
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+    context.request = std::make_shared<ConsumeBudgetsRequest>();
+    context.request->budgets.push_back(ConsumeBudgetMetadata{
+        std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+    context.response = std::make_shared<ConsumeBudgetsResponse>();
+
+    absl::BlockingCounter blocking(1);
+    AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> result_context;
+    context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                        ConsumeBudgetsResponse>& context) {
+      result_context = context;
+      blocking.DecrementCount();
+    };
+    EXPECT_SUCCESS(budget_consumption_helper_->ConsumeBudgets(context));
+    blocking.Wait();
+
+    EXPECT_THAT(result_context.result,
+                ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED)));
+    EXPECT_THAT(result_context.response->budget_exhausted_indices,
+                ElementsAre(0));
+  }
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest, StaleReadsAreDirectedToTheLocations) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->SetInt(
+      kBudgetConsumptionHelperStaleReadStalenessInMilliseconds, 10000);
+  mock_config_provider_->Set(
+      kBudgetConsumptionHelperStaleReadDirectedReadLocations,
+      "us-east4, us-east1");
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  std::unique_ptr<spanner_mocks::MockResultSetSource> source =
+      CreatePbsMockResultSetSource();
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(spanner_mocks::MakeRow(
+          {{std::string(kBudgetKeySpannerColumnName),
+            spanner::Value("fake-key-name")},
+           {std::string(kTimeframeSpannerColumnName), spanner::Value("0")},
+           {std::string(kValueSpannerColumnName),
+            spanner::Value(spanner::Json(
+                R"({"TokenCount":"1 0 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1"})"))}})))
+      .WillRepeatedly(Return(spanner::Row()));
+
+  // The request is found exhausted by the stale read, so it is rejected
+  // without a read-write transaction.
+  EXPECT_CALL(*mock_connection_, Read)
+      .WillOnce([&](const spanner::Connection::ReadParams& params) {
+        const auto* include_replicas =
+            absl::get_if<spanner::IncludeReplicas>(
+                &params.directed_read_option);
+        EXPECT_NE(include_replicas, nullptr);
+        if (include_replicas != nullptr) {
+          EXPECT_THAT(include_replicas->replica_selections(),
+                      ElementsAre(spanner::ReplicaSelection("us-east4"),
+                                  spanner::ReplicaSelection("us-east1")));
+          EXPECT_FALSE(include_replicas->auto_failover_disabled());
+        }
+        return spanner::RowStream(std::move(source));
+      });
+  EXPECT_CALL(*mock_connection_, Commit).Times(0);
+
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+  context.request = std::make_shared<ConsumeBudgetsRequest>();
+  context.request->budgets.push_back(ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+  context.response = std::make_shared<ConsumeBudgetsResponse>();
+  absl::BlockingCounter blocking(1);
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> result_context;
+  context.callback = [&](AsyncContext<ConsumeBudgetsRequest,
+                                      ConsumeBudgetsResponse>& context) {
+    result_context = context;
+    blocking.DecrementCount();
+  };
+  EXPECT_SUCCESS(budget_consumption_helper_->ConsumeBudgets(context));
+  blocking.Wait();
+
+  EXPECT_THAT(result_context.result,
+              ResultIs(FailureExecutionResult(SC_CONSUME_BUDGET_EXHAUSTED)));
+  ASSERT_SUCCESS(StopComponents());
+}
+
+TEST_F(BudgetConsumptionHelperTest, BudgetsPastTheRetentionAreRejected) {
+  mock_config_provider_->Set(kBudgetKeyTableName, std::string(kTableName));
+  mock_config_provider_->SetInt(kBudgetKeyTimeframeRetentionInDays, 30);
+  ASSERT_SUCCESS(InitAndRunComponents());
+
+  // The row of the first day since epoch may have been deleted long ago.
+  EXPECT_CALL(*mock_connection_, Read).Times(0);
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse> context;
+  context.request = std::make_shared<ConsumeBudgetsRequest>();
+  context.request->budgets.push_back(ConsumeBudgetMetadata{
+      std::make_shared<std::string>("fake-key-name"), 1, 3601000000000});
+  context.response = std::make_shared<ConsumeBudgetsResponse>();
+  EXPECT_THAT(budget_consumption_helper_->ConsumeBudgets(context),
+              ResultIs(FailureExecutionResult(
+                  SC_CONSUME_BUDGET_TIMEFRAME_EXPIRED)));
+  ASSERT_SUCCESS(StopComponents());
+}
 }  // namespace
 }  // namespace google::scp::pbs
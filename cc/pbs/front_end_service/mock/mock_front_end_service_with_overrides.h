@@ -97,6 +97,15 @@ class MockFrontEndServiceWithOverrides : public FrontEndService {
                                            transaction_context);
   }
 
+  void OnConsumeBudgetTransactionCallback(
+      const std::shared_ptr<cpio::AggregateMetricInterface>& metric_instance,
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>& http_context,
+      core::AsyncContext<core::TransactionRequest, core::TransactionResponse>&
+          transaction_context) noexcept {
+    FrontEndService::OnConsumeBudgetTransactionCallback(
+        metric_instance, http_context, transaction_context);
+  }
+
   std::shared_ptr<cpio::MockAggregateMetric> GetMetricsInstance(
       const std::string& method_name, const std::string& phase) {
     std::shared_ptr<cpio::AggregateMetricInterface> metrics_instance =
@@ -144,6 +153,12 @@ class MockFrontEndServiceWithOverrides : public FrontEndService {
     return FrontEndService::BeginTransaction(http_context);
   }
 
+  core::ExecutionResult ConsumeBudget(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept {
+    return FrontEndService::ConsumeBudget(http_context);
+  }
+
   core::ExecutionResult PrepareTransaction(
       core::AsyncContext<core::HttpRequest, core::HttpResponse>&
           http_context) noexcept {
@@ -180,6 +195,12 @@ class MockFrontEndServiceWithOverrides : public FrontEndService {
     return FrontEndService::GetTransactionStatus(http_context);
   }
 
+  core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept {
+    return FrontEndService::BatchGetTransactionStatus(http_context);
+  }
+
   core::ExecutionResult GetServiceStatus(
       core::AsyncContext<core::HttpRequest, core::HttpResponse>&
           http_context) noexcept {
@@ -0,0 +1,69 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/front_end_service/src/concurrency_limiter.h"
+
+#include <algorithm>
+
+namespace google::scp::pbs {
+
+ConcurrencyLimiter::ConcurrencyLimiter(
+    size_t initial_limit, size_t min_limit, size_t max_limit,
+    core::TimeDuration target_latency_in_nanoseconds, double backoff_ratio)
+    : min_limit_(std::max<size_t>(min_limit, 1)),
+      max_limit_(std::max(max_limit, std::max<size_t>(min_limit, 1))),
+      target_latency_in_nanoseconds_(target_latency_in_nanoseconds),
+      backoff_ratio_(backoff_ratio),
+      limit_(std::clamp(static_cast<double>(initial_limit), min_limit_,
+                        max_limit_)) {}
+
+bool ConcurrencyLimiter::TryAcquire() {
+  absl::MutexLock lock(&mutex_);
+  if (in_flight_count_ >= static_cast<size_t>(limit_)) {
+    return false;
+  }
+  in_flight_count_++;
+  return true;
+}
+
+void ConcurrencyLimiter::Release(core::TimeDuration latency_in_nanoseconds) {
+  absl::MutexLock lock(&mutex_);
+  if (in_flight_count_ > 0) {
+    in_flight_count_--;
+  }
+  if (latency_in_nanoseconds > target_latency_in_nanoseconds_) {
+    limit_ = std::max(limit_ * backoff_ratio_, min_limit_);
+  } else {
+    limit_ = std::min(limit_ + 1 / limit_, max_limit_);
+  }
+}
+
+void ConcurrencyLimiter::ReleaseWithoutSample() {
+  absl::MutexLock lock(&mutex_);
+  if (in_flight_count_ > 0) {
+    in_flight_count_--;
+  }
+}
+
+size_t ConcurrencyLimiter::GetLimit() {
+  absl::MutexLock lock(&mutex_);
+  return static_cast<size_t>(limit_);
+}
+
+size_t ConcurrencyLimiter::GetInFlightCount() {
+  absl::MutexLock lock(&mutex_);
+  return in_flight_count_;
+}
+
+}  // namespace google::scp::pbs
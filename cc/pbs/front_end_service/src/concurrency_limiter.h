@@ -0,0 +1,86 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CC_PBS_FRONT_END_SERVICE_SRC_CONCURRENCY_LIMITER_H_
+#define CC_PBS_FRONT_END_SERVICE_SRC_CONCURRENCY_LIMITER_H_
+
+#include <cstddef>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "cc/core/interface/type_def.h"
+
+namespace google::scp::pbs {
+
+/**
+ * @brief Bounds the number of requests in flight with an additive increase
+ * multiplicative decrease (AIMD) limit.
+ *
+ * Every request completing within the target latency grows the limit by about
+ * one per limit's worth of requests, and every request exceeding it shrinks
+ * the limit by the backoff ratio. Once Spanner slows down and the budget
+ * consumption tasks queue up, the limit thus converges to what can be served
+ * within the target, and the requests above it are rejected up front instead
+ * of timing out on the client after their work is done.
+ */
+class ConcurrencyLimiter {
+ public:
+  ConcurrencyLimiter(size_t initial_limit, size_t min_limit, size_t max_limit,
+                     core::TimeDuration target_latency_in_nanoseconds,
+                     double backoff_ratio = kDefaultBackoffRatio);
+
+  /**
+   * @brief Admits a request if fewer than the limit are in flight. Every
+   * admitted request must be released exactly once.
+   *
+   * @return true if the request is admitted.
+   */
+  bool TryAcquire();
+
+  /**
+   * @brief Releases an admitted request and adjusts the limit based on its
+   * latency.
+   *
+   * @param latency_in_nanoseconds The time from admission to completion.
+   */
+  void Release(core::TimeDuration latency_in_nanoseconds);
+
+  /**
+   * @brief Releases an admitted request that failed before doing any work,
+   * without adjusting the limit.
+   */
+  void ReleaseWithoutSample();
+
+  /// The current limit, rounded down.
+  size_t GetLimit();
+
+  /// The number of admitted requests not released yet.
+  size_t GetInFlightCount();
+
+  static constexpr double kDefaultBackoffRatio = 0.9;
+
+ private:
+  const double min_limit_;
+  const double max_limit_;
+  const core::TimeDuration target_latency_in_nanoseconds_;
+  const double backoff_ratio_;
+
+  absl::Mutex mutex_;
+  double limit_ ABSL_GUARDED_BY(mutex_);
+  size_t in_flight_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace google::scp::pbs
+
+#endif  // CC_PBS_FRONT_END_SERVICE_SRC_CONCURRENCY_LIMITER_H_
@@ -82,4 +82,9 @@ DEFINE_ERROR_CODE(
     "Return 404 by default when GetTransactionStatus is called.",
     HttpStatusCode::NOT_FOUND)
 
+DEFINE_ERROR_CODE(SC_PBS_FRONT_END_SERVICE_REQUEST_SHED,
+                  SC_PBS_FRONT_END_SERVICE, 0x0013,
+                  "The request is rejected since the front end is overloaded.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
+
 }  // namespace google::scp::core::errors
@@ -16,6 +16,7 @@
 
 #include "front_end_service.h"
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <list>
@@ -26,7 +27,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/strings/str_cat.h"
 #include "cc/core/common/global_logger/src/global_logger.h"
 #include "cc/core/common/time_provider/src/time_provider.h"
 #include "cc/core/common/uuid/src/uuid.h"
@@ -52,6 +52,8 @@
 
 namespace google::scp::pbs {
 using ::google::scp::core::AsyncContext;
+using ::google::scp::core::BatchGetTransactionStatusRequest;
+using ::google::scp::core::BatchGetTransactionStatusResponse;
 using ::google::scp::core::Byte;
 using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::ExecutionResultOr;
@@ -64,6 +66,7 @@ using ::google::scp::core::HttpHandler;
 using ::google::scp::core::HttpMethod;
 using ::google::scp::core::HttpRequest;
 using ::google::scp::core::HttpResponse;
+using ::google::scp::core::HttpRoutePriority;
 using ::google::scp::core::kAggregatedMetricIntervalMs;
 using ::google::scp::core::kDefaultAggregatedMetricIntervalMs;
 using ::google::scp::core::SuccessExecutionResult;
@@ -90,6 +93,7 @@ using ::google::scp::cpio::MetricUnit;
 using ::google::scp::pbs::FrontEndUtils;
 using ::opentelemetry::metrics::Counter;
 using ::std::any_of;
+using ::std::atomic;
 using ::std::bind;
 using ::std::dynamic_pointer_cast;
 using ::std::list;
@@ -109,6 +113,8 @@ using ::std::placeholders::_1;
 /// TODO: Use configuration service to make the timeout dynamic.
 static constexpr size_t kTransactionTimeoutMs = 120 * 1000;
 static constexpr char kFrontEndService[] = "FrontEndService";
+/// The max number of transactions whose status is inquired in one batch.
+static constexpr size_t kMaxBatchGetTransactionStatusSize = 1000;
 
 FrontEndService::FrontEndService(
     shared_ptr<core::HttpServerInterface>& http_server,
@@ -186,7 +192,7 @@ ExecutionResult FrontEndService::InitMetricInstances() noexcept {
       kMetricLabelBeginTransaction,    kMetricLabelPrepareTransaction,
       kMetricLabelCommitTransaction,   kMetricLabelAbortTransaction,
       kMetricLabelNotifyTransaction,   kMetricLabelEndTransaction,
-      kMetricLabelGetStatusTransaction};
+      kMetricLabelGetStatusTransaction, kMetricLabelConsumeBudgetTransaction};
 
   list<string> metric_names = {kMetricNameRequests, kMetricNameClientErrors,
                                kMetricNameServerErrors};
@@ -263,15 +269,31 @@ ExecutionResult FrontEndService::Init() noexcept {
   string get_transaction_status_path(kStatusTransactionPath);
   HttpHandler get_transaction_transaction_handler =
       bind(&FrontEndService::GetTransactionStatus, this, _1);
-  http_server_->RegisterResourceHandler(HttpMethod::GET,
-                                        get_transaction_status_path,
-                                        get_transaction_transaction_handler);
+  // The transaction status calls of the coordinators and the peers, and the
+  // service status calls, are control-plane traffic.
+  http_server_->RegisterResourceHandler(
+      HttpMethod::GET, get_transaction_status_path,
+      get_transaction_transaction_handler, HttpRoutePriority::ControlPlane);
+
+  string batch_get_transaction_status_path(kBatchStatusTransactionPath);
+  HttpHandler batch_get_transaction_status_handler =
+      bind(&FrontEndService::BatchGetTransactionStatus, this, _1);
+  http_server_->RegisterResourceHandler(
+      HttpMethod::POST, batch_get_transaction_status_path,
+      batch_get_transaction_status_handler, HttpRoutePriority::ControlPlane);
+
+  string consume_budget_path(kStatusConsumeBudgetPath);
+  HttpHandler consume_budget_handler =
+      bind(&FrontEndService::ConsumeBudget, this, _1);
+  http_server_->RegisterResourceHandler(HttpMethod::POST, consume_budget_path,
+                                        consume_budget_handler);
 
   string service_status_path(kServiceStatusPath);
   HttpHandler service_status_handler =
       bind(&FrontEndService::GetServiceStatus, this, _1);
   http_server_->RegisterResourceHandler(HttpMethod::GET, service_status_path,
-                                        service_status_handler);
+                                        service_status_handler,
+                                        HttpRoutePriority::ControlPlane);
 
   if (!config_provider_
            ->Get(kAggregatedMetricIntervalMs, aggregated_metric_interval_ms_)
@@ -385,9 +407,7 @@ FrontEndService::GenerateConsumeBudgetCommandsWithBatchesPerDay(
   // Generate
   vector<shared_ptr<TransactionCommand>> generated_commands;
   for (auto& budget_key_time_groups : budget_key_time_groups_map) {
-    auto budget_key_name = std::make_shared<std::string>(absl::StrCat(
-        transaction_origin, string("/"), budget_key_time_groups.first));
-    budget_key_name =
+    auto budget_key_name =
         std::make_shared<std::string>(budget_key_time_groups.first);
     for (auto& time_groups : budget_key_time_groups.second) {
       if (time_groups.second.size() > 1) {
@@ -468,8 +488,8 @@ ExecutionResult FrontEndService::BeginTransaction(
   auto transaction_origin = ObtainTransactionOrigin(http_context);
   execution_result = ParseBeginTransactionRequestBody(
       *http_context.request->auth_context.authorized_domain,
-      *transaction_origin, http_context.request->body,
-      consume_budget_metadata_list);
+      *transaction_origin, http_context.request->headers,
+      http_context.request->body, consume_budget_metadata_list);
 
   if (!execution_result.Successful()) {
     client_error_metrics_instance->Increment(reporting_origin_metric_label);
@@ -544,6 +564,122 @@ ExecutionResult FrontEndService::BeginTransaction(
   return execution_result;
 }
 
+ExecutionResult FrontEndService::ConsumeBudget(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  bool disallow_new_transaction_requests = false;
+  auto execution_result = config_provider_->Get(
+      kDisallowNewTransactionRequests, disallow_new_transaction_requests);
+  if (!execution_result.Successful()) {
+    disallow_new_transaction_requests = false;
+  }
+
+  if (disallow_new_transaction_requests) {
+    return FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_BEGIN_TRANSACTION_DISALLOWED);
+  }
+
+  const auto& total_request_metrics_instance =
+      metrics_instances_map_.at(kMetricLabelConsumeBudgetTransaction)
+          .at(kMetricNameRequests);
+  const auto& client_error_metrics_instance =
+      metrics_instances_map_.at(kMetricLabelConsumeBudgetTransaction)
+          .at(kMetricNameClientErrors);
+  const string reporting_origin_metric_label =
+      FrontEndUtils::FrontEndUtils::GetReportingOriginMetricLabel(
+          http_context.request, remote_coordinator_claimed_identity_);
+  total_request_metrics_instance->Increment(reporting_origin_metric_label);
+
+  const absl::flat_hash_map<std::string, std::string>
+      consume_budget_label_kv = {
+          {kMetricLabelTransactionPhase, kMetricLabelConsumeBudgetTransaction},
+          {kMetricLabelKeyReportingOrigin, reporting_origin_metric_label}};
+
+  total_request_counter_->Add(1, consume_budget_label_kv);
+
+  Uuid transaction_id;
+  execution_result = FrontEndUtils::ExtractTransactionId(
+      http_context.request->headers, transaction_id);
+  if (!execution_result.Successful()) {
+    client_error_metrics_instance->Increment(reporting_origin_metric_label);
+    client_error_counter_->Add(1, consume_budget_label_kv);
+    return execution_result;
+  }
+
+  string transaction_secret;
+  execution_result = FrontEndUtils::ExtractTransactionSecret(
+      http_context.request->headers, transaction_secret);
+  if (!execution_result.Successful()) {
+    client_error_metrics_instance->Increment(reporting_origin_metric_label);
+    client_error_counter_->Add(1, consume_budget_label_kv);
+    return execution_result;
+  }
+
+  std::vector<ConsumeBudgetMetadata> consume_budget_metadata_list;
+  auto transaction_origin = ObtainTransactionOrigin(http_context);
+  execution_result = ParseBeginTransactionRequestBody(
+      *http_context.request->auth_context.authorized_domain,
+      *transaction_origin, http_context.request->headers,
+      http_context.request->body, consume_budget_metadata_list);
+  if (!execution_result.Successful()) {
+    client_error_metrics_instance->Increment(reporting_origin_metric_label);
+    client_error_counter_->Add(1, consume_budget_label_kv);
+    return execution_result;
+  }
+
+  if (consume_budget_metadata_list.size() == 0) {
+    client_error_metrics_instance->Increment(reporting_origin_metric_label);
+    client_error_counter_->Add(1, consume_budget_label_kv);
+    return FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_NO_KEYS_AVAILABLE);
+  }
+
+  auto transaction_id_string = ToString(transaction_id);
+  SCP_DEBUG_CONTEXT(kFrontEndService, http_context,
+                    "Consuming budgets in transaction: %s Total Keys: %lld",
+                    transaction_id_string.c_str(),
+                    consume_budget_metadata_list.size());
+
+  auto const& server_error_metrics_instance =
+      metrics_instances_map_.at(kMetricLabelConsumeBudgetTransaction)
+          .at(kMetricNameServerErrors);
+  AsyncContext<TransactionRequest, TransactionResponse> transaction_context(
+      make_shared<TransactionRequest>(),
+      bind(&FrontEndService::OnConsumeBudgetTransactionCallback, this,
+           server_error_metrics_instance, http_context, _1),
+      http_context);
+
+  if (generate_batch_budget_consume_commands_per_day_) {
+    transaction_context.request->commands =
+        GenerateConsumeBudgetCommandsWithBatchesPerDay(
+            consume_budget_metadata_list, *transaction_origin, transaction_id);
+  } else {
+    transaction_context.request->commands = GenerateConsumeBudgetCommands(
+        consume_budget_metadata_list, *transaction_origin, transaction_id);
+  }
+
+  // Unlike the transactions begun by BeginTransaction, all the phases are run
+  // by the transaction manager without waiting for the caller.
+  transaction_context.request->is_coordinated_remotely = false;
+  transaction_context.request->transaction_secret =
+      make_shared<string>(transaction_secret);
+  transaction_context.request->transaction_origin = transaction_origin;
+  transaction_context.request->timeout_time =
+      (TimeProvider::GetSteadyTimestampInNanoseconds() +
+       milliseconds(kTransactionTimeoutMs))
+          .count();
+  transaction_context.request->transaction_id = transaction_id;
+
+  execution_result = transaction_request_router_->Execute(transaction_context);
+  if (!execution_result.Successful()) {
+    SCP_ERROR_CONTEXT(kFrontEndService, http_context, execution_result,
+                      "Failed to execute transaction %s",
+                      transaction_id_string.c_str());
+    client_error_metrics_instance->Increment(reporting_origin_metric_label);
+    client_error_counter_->Add(1, consume_budget_label_kv);
+  }
+  return execution_result;
+}
+
 ExecutionResult FrontEndService::PrepareTransaction(
     AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
   auto const& total_request_metrics_instance =
@@ -988,6 +1124,92 @@ ExecutionResult FrontEndService::GetTransactionStatus(
   return execution_result;
 }
 
+ExecutionResult FrontEndService::BatchGetTransactionStatus(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  const string reporting_origin_metric_label =
+      FrontEndUtils::GetReportingOriginMetricLabel(
+          http_context.request, remote_coordinator_claimed_identity_);
+  const absl::flat_hash_map<std::string, std::string>
+      transaction_status_label_kv = {
+          {kMetricLabelTransactionPhase, kMetricLabelGetStatusTransaction},
+          {kMetricLabelKeyReportingOrigin, reporting_origin_metric_label}};
+  total_request_counter_->Add(1, transaction_status_label_kv);
+
+  BatchGetTransactionStatusRequest batch_request;
+  auto execution_result =
+      FrontEndUtils::DeserializeBatchGetTransactionStatusRequest(
+          http_context.request->body, batch_request);
+  if (execution_result.Successful() &&
+      (batch_request.transactions.empty() ||
+       batch_request.transactions.size() >
+           kMaxBatchGetTransactionStatusSize)) {
+    execution_result = FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+  if (!execution_result.Successful()) {
+    client_error_counter_->Add(1, transaction_status_label_kv);
+    return execution_result;
+  }
+
+  auto transaction_origin = ObtainTransactionOrigin(http_context);
+  SCP_DEBUG_CONTEXT(
+      kFrontEndService, http_context,
+      "Executing BatchGetTransactionStatus for %zu transactions",
+      batch_request.transactions.size());
+
+  // Each of the statuses is written to its own slot, the last inquiry to
+  // complete sends the response.
+  auto batch_response = make_shared<BatchGetTransactionStatusResponse>();
+  batch_response->results.resize(batch_request.transactions.size());
+  auto pending_inquiries =
+      make_shared<atomic<size_t>>(batch_request.transactions.size());
+  auto on_inquiry_completed = [this, http_context, batch_response,
+                               pending_inquiries,
+                               transaction_status_label_kv]() mutable {
+    if (pending_inquiries->fetch_sub(1) != 1) {
+      return;
+    }
+    http_context.result = FrontEndUtils::SerializeBatchGetTransactionStatus(
+        *batch_response, http_context.response->body);
+    if (!http_context.result.Successful()) {
+      server_error_counter_->Add(1, transaction_status_label_kv);
+    }
+    http_context.Finish();
+  };
+
+  for (size_t i = 0; i < batch_request.transactions.size(); ++i) {
+    auto& result = batch_response->results[i];
+    result.transaction_id = batch_request.transactions[i].transaction_id;
+
+    AsyncContext<GetTransactionStatusRequest, GetTransactionStatusResponse>
+        get_transaction_status_context(
+            make_shared<GetTransactionStatusRequest>(
+                move(batch_request.transactions[i])),
+            [batch_response, i, on_inquiry_completed](
+                AsyncContext<GetTransactionStatusRequest,
+                             GetTransactionStatusResponse>&
+                    get_transaction_status_context) mutable {
+              auto& result = batch_response->results[i];
+              result.result = get_transaction_status_context.result;
+              if (result.result.Successful()) {
+                result.status = *get_transaction_status_context.response;
+              }
+              on_inquiry_completed();
+            },
+            http_context);
+    get_transaction_status_context.request->transaction_origin =
+        transaction_origin;
+
+    execution_result =
+        transaction_request_router_->Execute(get_transaction_status_context);
+    if (!execution_result.Successful()) {
+      get_transaction_status_context.result = execution_result;
+      get_transaction_status_context.Finish();
+    }
+  }
+  return SuccessExecutionResult();
+}
+
 /**
  * @brief Returns true any of the provided commands list is a batch
  * command
@@ -1206,6 +1428,68 @@ void FrontEndService::OnTransactionCallback(
   }
 }
 
+void FrontEndService::OnConsumeBudgetTransactionCallback(
+    const shared_ptr<AggregateMetricInterface>& metrics_instance,
+    AsyncContext<HttpRequest, HttpResponse>& http_context,
+    AsyncContext<TransactionRequest, TransactionResponse>&
+        transaction_context) noexcept {
+  auto transaction_id_string =
+      ToString(transaction_context.request->transaction_id);
+  if (!transaction_context.result.Successful()) {
+    SCP_ERROR_CONTEXT(kFrontEndService, http_context,
+                      transaction_context.result,
+                      "Consume budget transaction failed for transaction: %s",
+                      transaction_id_string.c_str());
+
+    if (transaction_context.result.status == core::ExecutionStatus::Failure &&
+        transaction_context.response) {
+      auto local_execution_result =
+          SerializeTransactionFailedCommandIndicesResponse(
+              transaction_context.response->failed_commands_indices,
+              transaction_context.response->failed_commands,
+              http_context.response->body);
+      if (!local_execution_result.Successful()) {
+        // We can log it but should not update the error code getting back to
+        // the client since it will make it confusing for the proper diagnosis
+        // on the transaction execution errors.
+        SCP_ERROR_CONTEXT(kFrontEndService, http_context,
+                          local_execution_result,
+                          "Serialization of the transaction response failed");
+      }
+    }
+
+    const string reporting_origin_metric_label =
+        FrontEndUtils::FrontEndUtils::GetReportingOriginMetricLabel(
+            http_context.request, remote_coordinator_claimed_identity_);
+    const absl::flat_hash_map<std::string, std::string> transaction_label_kv =
+        {{kMetricLabelTransactionPhase, kMetricLabelConsumeBudgetTransaction},
+         {kMetricLabelKeyReportingOrigin, reporting_origin_metric_label}};
+    metrics_instance->Increment(reporting_origin_metric_label);
+    server_error_counter_->Add(1, transaction_label_kv);
+    http_context.result = transaction_context.result;
+    http_context.Finish();
+    return;
+  }
+
+  // The headers of a completed transaction phase, so that the callers of
+  // PrepareTransaction on a FrontEndServiceV2 can call this one alike.
+  static string transaction_id_header(kTransactionIdHeader);
+  static string transaction_last_execution_timestamp_header(
+      kTransactionLastExecutionTimestampHeader);
+  http_context.response->headers->insert(
+      {transaction_id_header, transaction_id_string});
+  http_context.response->headers->insert(
+      {transaction_last_execution_timestamp_header,
+       to_string(transaction_context.response->last_execution_timestamp)});
+
+  SCP_DEBUG_CONTEXT(kFrontEndService, http_context,
+                    "Consume budget transaction completed for transaction: %s",
+                    transaction_id_string.c_str());
+
+  http_context.result = SuccessExecutionResult();
+  http_context.Finish();
+}
+
 ExecutionResult FrontEndService::ExecuteTransactionPhase(
     const shared_ptr<AggregateMetricInterface>& metrics_instance,
     AsyncContext<HttpRequest, HttpResponse>& http_context, Uuid& transaction_id,
@@ -174,6 +174,35 @@ class FrontEndService : public FrontEndServiceInterface {
       core::AsyncContext<core::TransactionRequest, core::TransactionResponse>&
           transaction_context) noexcept;
 
+  /**
+   * @brief Is called when the transaction of a consume budget request, run
+   * end-to-end by the transaction manager, is completed.
+   *
+   * @param metric_instance The metric instance used to track the execution
+   * status.
+   * @param http_context The http context of the operation.
+   * @param transaction_context The transaction context of the operation.
+   */
+  virtual void OnConsumeBudgetTransactionCallback(
+      const std::shared_ptr<cpio::AggregateMetricInterface>& metric_instance,
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>& http_context,
+      core::AsyncContext<core::TransactionRequest, core::TransactionResponse>&
+          transaction_context) noexcept;
+
+  /**
+   * @brief Consumes the budgets of the request in a single round trip. The
+   * transaction is coordinated by the transaction manager of this instance
+   * through all of its phases, so the caller has no two-phase control over
+   * it. The transaction id and secret headers are still required so that the
+   * caller can inquire the status of the transaction if the response is lost.
+   *
+   * @param http_context The http context of the operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult ConsumeBudget(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
   /**
    * @brief Executes the begin transaction phase.
    *
@@ -244,6 +273,19 @@ class FrontEndService : public FrontEndServiceInterface {
       core::AsyncContext<core::HttpRequest, core::HttpResponse>&
           http_context) noexcept;
 
+  /**
+   * @brief Gets the statuses of a batch of transactions of the same origin.
+   * Used by the peer coordinator to resolve many transactions at once, the
+   * status of each transaction is inquired as by GetTransactionStatus and the
+   * response is sent once all of them are known.
+   *
+   * @param http_context The http context of the operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
   /**
    * @brief Gets the current status of PBS service or its components.
    *
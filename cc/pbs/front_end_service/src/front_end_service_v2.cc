@@ -14,6 +14,7 @@
 
 #include "cc/pbs/front_end_service/src/front_end_service_v2.h"
 
+#include <chrono>
 #include <list>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "cc/core/common/global_logger/src/global_logger.h"
+#include "cc/core/common/time_provider/src/time_provider.h"
 #include "cc/core/common/uuid/src/uuid.h"
 #include "cc/core/interface/async_context.h"
 #include "cc/core/interface/async_executor_interface.h"
@@ -34,9 +36,11 @@
 #include "cc/core/interface/logger_interface.h"
 #include "cc/core/interface/type_def.h"
 #include "cc/pbs/consume_budget/src/gcp/error_codes.h"
+#include "cc/pbs/front_end_service/src/concurrency_limiter.h"
 #include "cc/pbs/front_end_service/src/error_codes.h"
 #include "cc/pbs/front_end_service/src/front_end_utils.h"
 #include "cc/pbs/front_end_service/src/metric_initialization.h"
+#include "cc/pbs/front_end_service/src/request_stage_metrics.h"
 #include "cc/pbs/interface/configuration_keys.h"
 #include "cc/pbs/interface/consume_budget_interface.h"
 #include "cc/pbs/interface/front_end_service_interface.h"
@@ -54,17 +58,20 @@ using ::google::scp::core::AsyncExecutorInterface;
 using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::ExecutionResultOr;
 using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::RetryExecutionResult;
 using ::google::scp::core::HttpHandler;
 using ::google::scp::core::HttpHeaders;
 using ::google::scp::core::HttpMethod;
 using ::google::scp::core::HttpRequest;
 using ::google::scp::core::HttpResponse;
+using ::google::scp::core::HttpRoutePriority;
 using ::google::scp::core::HttpServerInterface;
 using ::google::scp::core::kAggregatedMetricIntervalMs;
 using ::google::scp::core::kDefaultAggregatedMetricIntervalMs;
 using ::google::scp::core::SuccessExecutionResult;
 using ::google::scp::core::Timestamp;
 using ::google::scp::core::common::kZeroUuid;
+using ::google::scp::core::common::TimeProvider;
 using ::google::scp::core::common::ToString;
 using ::google::scp::core::common::Uuid;
 using ::google::scp::core::errors::
@@ -72,6 +79,7 @@ using ::google::scp::core::errors::
 using ::google::scp::core::errors::
     SC_PBS_FRONT_END_SERVICE_INITIALIZATION_FAILED;
 using ::google::scp::core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST;
+using ::google::scp::core::errors::SC_PBS_FRONT_END_SERVICE_REQUEST_SHED;
 using ::google::scp::core::errors::
     SC_PBS_FRONT_END_SERVICE_UNABLE_TO_FIND_TRANSACTION_METRICS;
 using ::google::scp::cpio::AggregateMetricInterface;
@@ -82,6 +90,11 @@ using ::google::scp::pbs::FrontEndUtils;
 inline constexpr char kFrontEndService[] = "FrontEndServiceV2";
 inline constexpr char kFakeLastExecutionTimestamp[] = "1234";
 
+constexpr size_t kDefaultAdmissionControlTargetLatencyInMilliseconds = 1000;
+constexpr size_t kDefaultAdmissionControlInitialLimit = 100;
+constexpr size_t kDefaultAdmissionControlMinLimit = 10;
+constexpr size_t kDefaultAdmissionControlMaxLimit = 1000;
+
 ExecutionResultOr<std::shared_ptr<AggregateMetricInterface>>
 FindAggregateMetricInMap(const MetricsMap& metrics_map,
                          absl::string_view metric_label,
@@ -157,6 +170,12 @@ void InsertBackwardCompatibleHeaders(
   http_context.response->headers->insert(
       {kTransactionLastExecutionTimestampHeader, kFakeLastExecutionTimestamp});
 }
+
+std::chrono::nanoseconds ElapsedSince(Timestamp steady_timestamp) {
+  return std::chrono::nanoseconds(
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks() -
+      steady_timestamp);
+}
 }  // namespace
 
 FrontEndServiceV2::FrontEndServiceV2(
@@ -165,14 +184,17 @@ FrontEndServiceV2::FrontEndServiceV2(
     const std::shared_ptr<cpio::MetricClientInterface> metric_client,
     const std::shared_ptr<core::ConfigProviderInterface> config_provider,
     BudgetConsumptionHelperInterface* budget_consumption_helper,
-    std::unique_ptr<MetricInitialization> metric_initialization)
+    std::unique_ptr<MetricInitialization> metric_initialization,
+    std::shared_ptr<core::MetricRouter> metric_router)
     : http_server_(http_server),
       async_executor_(async_executor),
       metric_client_(metric_client),
       config_provider_(config_provider),
       aggregated_metric_interval_ms_(kDefaultAggregatedMetricIntervalMs),
       metric_initialization_(std::move(metric_initialization)),
-      budget_consumption_helper_(budget_consumption_helper) {
+      budget_consumption_helper_(budget_consumption_helper),
+      request_stage_metrics_(std::make_unique<RequestStageMetrics>(
+          std::move(metric_router), config_provider)) {
   meter_ = opentelemetry::metrics::Provider::GetMeterProvider()->GetMeter(
       "Frontend Service v2", "2.0");
   total_request_counter_ = meter_->CreateUInt64Counter(
@@ -183,6 +205,21 @@ FrontEndServiceV2::FrontEndServiceV2(
       kMetricNameServerErrors, "Number of server errors (5xx status codes)");
 }
 
+FrontEndServiceV2::~FrontEndServiceV2() {
+  if (admission_control_limit_instrument_) {
+    admission_control_limit_instrument_->RemoveCallback(
+        reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
+            &FrontEndServiceV2::ObserveAdmissionControlLimitCallback),
+        this);
+  }
+  if (admission_control_in_flight_instrument_) {
+    admission_control_in_flight_instrument_->RemoveCallback(
+        reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
+            &FrontEndServiceV2::ObserveAdmissionControlInFlightCallback),
+        this);
+  }
+}
+
 ExecutionResult FrontEndServiceV2::Init() noexcept {
   ExecutionResult execution_result =
       config_provider_->Get(kRemotePrivacyBudgetServiceClaimedIdentity,
@@ -193,8 +230,11 @@ ExecutionResult FrontEndServiceV2::Init() noexcept {
   std::string health_check_path(kStatusHealthCheckPath);
   HttpHandler health_check_handler =
       absl::bind_front(&FrontEndServiceV2::BeginTransaction, this);
+  // The health checks and the transaction status calls are control-plane
+  // traffic, which is not queued behind the budget consumption requests.
   http_server_->RegisterResourceHandler(HttpMethod::POST, health_check_path,
-                                        health_check_handler);
+                                        health_check_handler,
+                                        HttpRoutePriority::ControlPlane);
 
   std::string consume_budget_path(kStatusConsumeBudgetPath);
   HttpHandler consume_budget_handler =
@@ -241,9 +281,9 @@ ExecutionResult FrontEndServiceV2::Init() noexcept {
   std::string get_transaction_status_path(kStatusTransactionPath);
   HttpHandler get_transaction_transaction_handler =
       absl::bind_front(&FrontEndServiceV2::GetTransactionStatus, this);
-  http_server_->RegisterResourceHandler(HttpMethod::GET,
-                                        get_transaction_status_path,
-                                        get_transaction_transaction_handler);
+  http_server_->RegisterResourceHandler(
+      HttpMethod::GET, get_transaction_status_path,
+      get_transaction_transaction_handler, HttpRoutePriority::ControlPlane);
 
   if (!config_provider_
            ->Get(kAggregatedMetricIntervalMs, aggregated_metric_interval_ms_)
@@ -251,6 +291,63 @@ ExecutionResult FrontEndServiceV2::Init() noexcept {
     aggregated_metric_interval_ms_ = kDefaultAggregatedMetricIntervalMs;
   }
 
+  bool admission_control_enabled = false;
+  if (config_provider_
+          ->Get(kPBSFrontEndAdmissionControlEnabled, admission_control_enabled)
+          .Successful() &&
+      admission_control_enabled) {
+    size_t target_latency_in_milliseconds;
+    if (!config_provider_
+             ->Get(kPBSFrontEndAdmissionControlTargetLatencyInMilliseconds,
+                   target_latency_in_milliseconds)
+             .Successful()) {
+      target_latency_in_milliseconds =
+          kDefaultAdmissionControlTargetLatencyInMilliseconds;
+    }
+    size_t initial_limit;
+    if (!config_provider_
+             ->Get(kPBSFrontEndAdmissionControlInitialLimit, initial_limit)
+             .Successful()) {
+      initial_limit = kDefaultAdmissionControlInitialLimit;
+    }
+    size_t min_limit;
+    if (!config_provider_->Get(kPBSFrontEndAdmissionControlMinLimit, min_limit)
+             .Successful()) {
+      min_limit = kDefaultAdmissionControlMinLimit;
+    }
+    size_t max_limit;
+    if (!config_provider_->Get(kPBSFrontEndAdmissionControlMaxLimit, max_limit)
+             .Successful()) {
+      max_limit = kDefaultAdmissionControlMaxLimit;
+    }
+    concurrency_limiter_ = std::make_unique<ConcurrencyLimiter>(
+        initial_limit, min_limit, max_limit,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::milliseconds(target_latency_in_milliseconds))
+            .count());
+
+    shed_request_counter_ = meter_->CreateUInt64Counter(
+        kMetricNameAdmissionControlShedRequests,
+        "Number of requests rejected by admission control");
+    admission_control_limit_instrument_ = meter_->CreateInt64ObservableGauge(
+        kMetricNameAdmissionControlLimit,
+        "Maximum number of consume budget requests in flight");
+    admission_control_limit_instrument_->AddCallback(
+        reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
+            &FrontEndServiceV2::ObserveAdmissionControlLimitCallback),
+        this);
+    admission_control_in_flight_instrument_ =
+        meter_->CreateInt64ObservableGauge(
+            kMetricNameAdmissionControlInFlight,
+            "Number of consume budget requests in flight");
+    admission_control_in_flight_instrument_->AddCallback(
+        reinterpret_cast<opentelemetry::metrics::ObservableCallbackPtr>(
+            &FrontEndServiceV2::ObserveAdmissionControlInFlightCallback),
+        this);
+  }
+
+  RETURN_IF_FAILURE(request_stage_metrics_->Init());
+
   if (budget_consumption_helper_ == nullptr) {
     auto failure_execution_result =
         FailureExecutionResult(SC_PBS_FRONT_END_SERVICE_INITIALIZATION_FAILED);
@@ -312,6 +409,26 @@ std::shared_ptr<std::string> FrontEndServiceV2::ObtainTransactionOrigin(
   return http_context.request->auth_context.authorized_domain;
 }
 
+void FrontEndServiceV2::ObserveAdmissionControlLimitCallback(
+    opentelemetry::metrics::ObserverResult observer_result,
+    absl::Nonnull<FrontEndServiceV2*> self_ptr) {
+  auto observer = std::get<
+      std::shared_ptr<opentelemetry::metrics::ObserverResultT<int64_t>>>(
+      observer_result);
+  observer->Observe(
+      static_cast<int64_t>(self_ptr->concurrency_limiter_->GetLimit()));
+}
+
+void FrontEndServiceV2::ObserveAdmissionControlInFlightCallback(
+    opentelemetry::metrics::ObserverResult observer_result,
+    absl::Nonnull<FrontEndServiceV2*> self_ptr) {
+  auto observer = std::get<
+      std::shared_ptr<opentelemetry::metrics::ObserverResultT<int64_t>>>(
+      observer_result);
+  observer->Observe(
+      static_cast<int64_t>(self_ptr->concurrency_limiter_->GetInFlightCount()));
+}
+
 ExecutionResult FrontEndServiceV2::ExecuteConsumeBudgetTransaction(
     AsyncContext<ConsumeBudgetTransactionRequest,
                  ConsumeBudgetTransactionResponse>&
@@ -390,6 +507,14 @@ ExecutionResult FrontEndServiceV2::PrepareTransaction(
                                             kMetricLabelPrepareTransaction,
                                             kMetricNameClientErrors));
 
+  if (http_context.request->auth_context.authorization_duration.count() > 0) {
+    request_stage_metrics_->Record(
+        RequestStage::kAuth,
+        http_context.request->auth_context.authorization_duration);
+  }
+
+  Timestamp parse_start_timestamp =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
   ExecutionResultOr<std::string> transaction_id =
       ExtractBackwardCompatibleHeaders(
           http_context, /*should_extract_last_execution_timestamp=*/
@@ -400,34 +525,38 @@ ExecutionResult FrontEndServiceV2::PrepareTransaction(
     return transaction_id.result();
   }
 
-  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>
-      consume_budget_context(
-          std::make_shared<ConsumeBudgetsRequest>(),
-          absl::bind_front(&FrontEndServiceV2::OnConsumeBudgetCallback, this,
-                           http_context, *transaction_id),
-          http_context);
-  consume_budget_context.response = std::make_shared<ConsumeBudgetsResponse>();
+  auto consume_budgets_request = std::make_shared<ConsumeBudgetsRequest>();
   auto transaction_origin = ObtainTransactionOrigin(http_context);
   if (auto execution_result = ParseBeginTransactionRequestBody(
           *http_context.request->auth_context.authorized_domain,
-          *transaction_origin, http_context.request->body,
-          consume_budget_context.request->budgets);
+          *transaction_origin, http_context.request->headers,
+          http_context.request->body, consume_budgets_request->budgets);
       !execution_result.Successful()) {
     client_error_metrics_instance->Increment(reporting_origin_metric_label);
     client_error_counter_->Add(1, prepare_transaction_label_kv);
     return execution_result;
   }
 
-  if (consume_budget_context.request->budgets.size() == 0) {
+  if (consume_budgets_request->budgets.size() == 0) {
     client_error_metrics_instance->Increment(reporting_origin_metric_label);
     client_error_counter_->Add(1, prepare_transaction_label_kv);
     return FailureExecutionResult(
         core::errors::SC_PBS_FRONT_END_SERVICE_NO_KEYS_AVAILABLE);
   }
+  request_stage_metrics_->Record(RequestStage::kParse,
+                                 ElapsedSince(parse_start_timestamp));
 
-  if (google::scp::core::common::GlobalLogger::GetGlobalLogger() &&
-      google::scp::core::common::GlobalLogger::IsLogLevelEnabled(
-          google::scp::core::LogLevel::kDebug)) {
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>
+      consume_budget_context(
+          std::move(consume_budgets_request),
+          absl::bind_front(&FrontEndServiceV2::OnConsumeBudgetCallback, this,
+                           http_context, *transaction_id,
+                           TimeProvider::
+                               GetSteadyTimestampInNanosecondsAsClockTicks()),
+          http_context);
+  consume_budget_context.response = std::make_shared<ConsumeBudgetsResponse>();
+
+  if (SCP_IS_LOG_LEVEL_ENABLED(google::scp::core::LogLevel::kDebug)) {
     SCP_DEBUG_CONTEXT(kFrontEndService, http_context,
                       "Starting Transaction: %s Total Keys: %lld",
                       transaction_id->c_str(),
@@ -446,9 +575,28 @@ ExecutionResult FrontEndServiceV2::PrepareTransaction(
     }
   }
 
+  // Sheds the requests above the limit before they queue up behind the slow
+  // ones. The latency sampled on completion is measured from the creation of
+  // consume_budget_context, so it covers the time spent queued for an IO
+  // thread.
+  if (concurrency_limiter_) {
+    if (!concurrency_limiter_->TryAcquire()) {
+      shed_request_counter_->Add(1, prepare_transaction_label_kv);
+      server_error_counter_->Add(1, prepare_transaction_label_kv);
+      SCP_WARNING_CONTEXT(kFrontEndService, http_context,
+                          "Request shed by admission control. "
+                          "transaction_id: %s.",
+                          transaction_id->c_str());
+      return RetryExecutionResult(SC_PBS_FRONT_END_SERVICE_REQUEST_SHED);
+    }
+  }
+
   if (auto execution_result =
           budget_consumption_helper_->ConsumeBudgets(consume_budget_context);
       !execution_result.Successful()) {
+    if (concurrency_limiter_) {
+      concurrency_limiter_->ReleaseWithoutSample();
+    }
     client_error_metrics_instance->Increment(reporting_origin_metric_label);
     client_error_counter_->Add(1, prepare_transaction_label_kv);
     return execution_result;
@@ -459,9 +607,26 @@ ExecutionResult FrontEndServiceV2::PrepareTransaction(
 
 void FrontEndServiceV2::OnConsumeBudgetCallback(
     AsyncContext<HttpRequest, HttpResponse> http_context,
-    std::string transaction_id,
+    std::string transaction_id, Timestamp admission_timestamp,
     AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>&
         consume_budget_context) {
+  Timestamp response_write_start_timestamp =
+      TimeProvider::GetSteadyTimestampInNanosecondsAsClockTicks();
+  if (concurrency_limiter_) {
+    concurrency_limiter_->Release(response_write_start_timestamp -
+                                  admission_timestamp);
+  }
+  request_stage_metrics_->Record(
+      RequestStage::kConsume,
+      std::chrono::nanoseconds(response_write_start_timestamp -
+                               admission_timestamp));
+  if (consume_budget_context.response &&
+      consume_budget_context.response->commit_duration.count() > 0) {
+    request_stage_metrics_->Record(
+        RequestStage::kSpannerCommit,
+        consume_budget_context.response->commit_duration);
+  }
+
   auto server_error_metrics_instance = FindAggregateMetricInMap(
       metrics_instances_map_, kMetricLabelPrepareTransaction,
       kMetricNameServerErrors);
@@ -538,12 +703,17 @@ void FrontEndServiceV2::OnConsumeBudgetCallback(
             {kMetricLabelKeyReportingOrigin, reporting_origin_metric_label}});
     http_context.result = consume_budget_context.result;
     http_context.Finish();
+    request_stage_metrics_->Record(
+        RequestStage::kResponseWrite,
+        ElapsedSince(response_write_start_timestamp));
     return;
   }
 
   InsertBackwardCompatibleHeaders(http_context);
   http_context.result = consume_budget_context.result;
   http_context.Finish();
+  request_stage_metrics_->Record(RequestStage::kResponseWrite,
+                                 ElapsedSince(response_write_start_timestamp));
 }
 
 [[deprecated(
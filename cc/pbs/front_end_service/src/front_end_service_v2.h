@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 
+#include "absl/base/nullability.h"
 #include "absl/container/flat_hash_map.h"
 #include "cc/core/interface/async_context.h"
 #include "cc/core/interface/async_executor_interface.h"
@@ -25,7 +26,10 @@
 #include "cc/core/interface/http_server_interface.h"
 #include "cc/core/interface/http_types.h"
 #include "cc/core/interface/type_def.h"
+#include "cc/pbs/front_end_service/src/concurrency_limiter.h"
+#include "cc/core/telemetry/src/metric/metric_router.h"
 #include "cc/pbs/front_end_service/src/metric_initialization.h"
+#include "cc/pbs/front_end_service/src/request_stage_metrics.h"
 #include "cc/pbs/interface/consume_budget_interface.h"
 #include "cc/pbs/interface/front_end_service_interface.h"
 #include "cc/public/core/interface/execution_result.h"
@@ -46,7 +50,10 @@ class FrontEndServiceV2 : public FrontEndServiceInterface {
       std::shared_ptr<cpio::MetricClientInterface> metric_client,
       std::shared_ptr<core::ConfigProviderInterface> config_provider,
       BudgetConsumptionHelperInterface* budget_consumption_helper,
-      std::unique_ptr<MetricInitialization> metric_initialization = nullptr);
+      std::unique_ptr<MetricInitialization> metric_initialization = nullptr,
+      std::shared_ptr<core::MetricRouter> metric_router = nullptr);
+
+  ~FrontEndServiceV2();
 
   core::ExecutionResult Init() noexcept override;
   core::ExecutionResult Run() noexcept override;
@@ -90,9 +97,12 @@ class FrontEndServiceV2 : public FrontEndServiceInterface {
       core::AsyncContext<core::HttpRequest, core::HttpResponse>&
           http_context) noexcept;
 
+  // admission_timestamp is the steady time at which the consume budget request
+  // was created, from which the latency sampled by admission control is
+  // measured.
   void OnConsumeBudgetCallback(
       core::AsyncContext<core::HttpRequest, core::HttpResponse> http_context,
-      std::string transaction_id,
+      std::string transaction_id, core::Timestamp admission_timestamp,
       core::AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>&
           consume_budget_context);
 
@@ -114,6 +124,14 @@ class FrontEndServiceV2 : public FrontEndServiceInterface {
       core::AsyncContext<core::HttpRequest, core::HttpResponse>& http_context)
       const;
 
+  /// Callbacks of the admission control gauges.
+  static void ObserveAdmissionControlLimitCallback(
+      opentelemetry::metrics::ObserverResult observer_result,
+      absl::Nonnull<FrontEndServiceV2*> self_ptr);
+  static void ObserveAdmissionControlInFlightCallback(
+      opentelemetry::metrics::ObserverResult observer_result,
+      absl::Nonnull<FrontEndServiceV2*> self_ptr);
+
   // An instance to the http server.
   std::shared_ptr<core::HttpServerInterface> http_server_;
 
@@ -153,6 +171,19 @@ class FrontEndServiceV2 : public FrontEndServiceInterface {
       client_error_counter_;
   std::unique_ptr<opentelemetry::metrics::Counter<uint64_t>>
       server_error_counter_;
+
+  /// Bounds the consume budget requests in flight. Null if admission control
+  /// is disabled.
+  std::unique_ptr<ConcurrencyLimiter> concurrency_limiter_;
+  std::unique_ptr<opentelemetry::metrics::Counter<uint64_t>>
+      shed_request_counter_;
+  std::shared_ptr<opentelemetry::metrics::ObservableInstrument>
+      admission_control_limit_instrument_;
+  std::shared_ptr<opentelemetry::metrics::ObservableInstrument>
+      admission_control_in_flight_instrument_;
+
+  /// The latency histograms of the stages of the consume budget requests.
+  std::unique_ptr<RequestStageMetrics> request_stage_metrics_;
 };
 
 }  // namespace google::scp::pbs
@@ -22,20 +22,27 @@
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <limits>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <google/protobuf/timestamp.pb.h>
 #include <google/protobuf/util/time_util.h>
 #include <nlohmann/json.hpp>
 
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
 #include "cc/core/common/global_logger/src/global_logger.h"
 #include "cc/core/common/uuid/src/uuid.h"
 #include "cc/core/interface/type_def.h"
 #include "cc/pbs/budget_key_timeframe_manager/src/budget_key_timeframe_utils.h"
 #include "cc/pbs/front_end_service/src/error_codes.h"
+#include "cc/pbs/front_end_service/src/proto/begin_transaction_request.pb.h"
 #include "cc/pbs/interface/front_end_service_interface.h"
 #include "cc/pbs/interface/type_def.h"
 #include "cc/public/core/interface/execution_result.h"
@@ -52,6 +59,19 @@ constexpr char kVersion2[] = "2.0";
 constexpr char kHttpPrefix[] = "http://";
 constexpr char kHttpsPrefix[] = "https://";
 
+core::ExecutionResultOr<TimeBucket> ReportingTimestampToTimeBucket(
+    const google::protobuf::Timestamp& reporting_timestamp) {
+  if (reporting_timestamp.seconds() < 0) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST);
+  }
+
+  uint64_t seconds_since_epoch = reporting_timestamp.seconds();
+  std::chrono::nanoseconds reporting_time_nanoseconds =
+      std::chrono::seconds(seconds_since_epoch);
+  return static_cast<uint64_t>(reporting_time_nanoseconds.count());
+}
+
 core::ExecutionResultOr<TimeBucket> ReportingTimeToTimeBucket(
     const std::string& reporting_time) {
   google::protobuf::Timestamp reporting_timestamp;
@@ -60,16 +80,39 @@ core::ExecutionResultOr<TimeBucket> ReportingTimeToTimeBucket(
     return core::FailureExecutionResult(
         core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST);
   }
+  return ReportingTimestampToTimeBucket(reporting_timestamp);
+}
 
-  if (reporting_timestamp.seconds() < 0) {
+// Appends the budget key to the list unless it is a duplicate of an earlier
+// one within the same reporting hour.
+core::ExecutionResult AppendBudgetKey(
+    std::string budget_key_name, TokenCount token_count,
+    const ExecutionResultOr<TimeBucket>& reporting_timestamp,
+    std::unordered_set<std::string>& visited,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) {
+  if (!reporting_timestamp.Successful()) {
+    return reporting_timestamp.result();
+  }
+
+  // TODO: This is a temporary solution to prevent transaction
+  // commands belong to the same reporting hour to execute within the
+  // same transaction. The proper solution is to move this logic to
+  // the transaction commands.
+  TimeGroup time_group =
+      budget_key_timeframe_manager::Utils::GetTimeGroup(*reporting_timestamp);
+  TimeBucket time_bucket =
+      budget_key_timeframe_manager::Utils::GetTimeBucket(*reporting_timestamp);
+  std::string visited_key = absl::StrCat(budget_key_name, "_", time_group, "_",
+                                         time_bucket);
+  if (!visited.emplace(std::move(visited_key)).second) {
     return core::FailureExecutionResult(
         core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST);
   }
 
-  uint64_t seconds_since_epoch = reporting_timestamp.seconds();
-  std::chrono::nanoseconds reporting_time_nanoseconds =
-      std::chrono::seconds(seconds_since_epoch);
-  return static_cast<uint64_t>(reporting_time_nanoseconds.count());
+  consume_budget_metadata_list.emplace_back(ConsumeBudgetMetadata{
+      std::make_shared<std::string>(std::move(budget_key_name)), token_count,
+      *reporting_timestamp});
+  return core::SuccessExecutionResult();
 }
 
 // V1 Request Example:
@@ -109,7 +152,6 @@ core::ExecutionResult ParseBeginTransactionRequestBodyV1(
     for (auto it = transaction_request["t"].begin();
          it != transaction_request["t"].end(); ++it) {
       auto consume_budget_transaction_key = it.value();
-      ConsumeBudgetMetadata consume_budget_metadata;
 
       if (consume_budget_transaction_key.count("key") == 0 ||
           consume_budget_transaction_key.count("token") == 0 ||
@@ -118,41 +160,18 @@ core::ExecutionResult ParseBeginTransactionRequestBodyV1(
             core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
       }
 
-      consume_budget_metadata.budget_key_name =
-          std::make_shared<std::string>(absl::StrCat(
+      auto execution_result = AppendBudgetKey(
+          absl::StrCat(
               transaction_origin, "/",
-              consume_budget_transaction_key.at("key").get<std::string>()));
-      consume_budget_metadata.token_count =
-          consume_budget_transaction_key["token"].get<TokenCount>();
-
-      auto reporting_time =
-          consume_budget_transaction_key["reporting_time"].get<std::string>();
-      auto time_bucket_or = ReportingTimeToTimeBucket(reporting_time);
-      if (!time_bucket_or.Successful()) {
-        return time_bucket_or.result();
-      }
-      consume_budget_metadata.time_bucket = *time_bucket_or;
-
-      // TODO: This is a temporary solution to prevent transaction
-      // commands belong to the same reporting hour to execute within the
-      // same transaction. The proper solution is to move this logic to
-      // the transaction commands.
-      auto time_group = budget_key_timeframe_manager::Utils::GetTimeGroup(
-          consume_budget_metadata.time_bucket);
-      auto time_bucket = budget_key_timeframe_manager::Utils::GetTimeBucket(
-          consume_budget_metadata.time_bucket);
-
-      auto visited_str = *consume_budget_metadata.budget_key_name + "_" +
-                         std::to_string(time_group) + "_" +
-                         std::to_string(time_bucket);
-
-      if (visited.find(visited_str) != visited.end()) {
-        return core::FailureExecutionResult(
-            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST);
+              consume_budget_transaction_key.at("key").get<std::string>()),
+          consume_budget_transaction_key["token"].get<TokenCount>(),
+          ReportingTimeToTimeBucket(
+              consume_budget_transaction_key["reporting_time"]
+                  .get<std::string>()),
+          visited, consume_budget_metadata_list);
+      if (!execution_result.Successful()) {
+        return execution_result;
       }
-
-      visited.emplace(visited_str);
-      consume_budget_metadata_list.push_back(consume_budget_metadata);
     }
   }
 
@@ -241,36 +260,413 @@ core::ExecutionResult ParseBeginTransactionRequestBodyV2(
             core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
       }
 
-      auto budget_key_name = std::make_shared<std::string>(absl::StrCat(
-          reporting_origin, "/", key_it->at("key").get<std::string>()));
-      TokenCount token_count = key_it->at("token").get<TokenCount>();
-      std::string reporting_time =
-          key_it->at("reporting_time").get<std::string>();
-      auto reporting_timestamp = ReportingTimeToTimeBucket(reporting_time);
-      if (!reporting_timestamp.Successful()) {
-        return reporting_timestamp.result();
+      auto execution_result = AppendBudgetKey(
+          absl::StrCat(reporting_origin, "/",
+                       key_it->at("key").get<std::string>()),
+          key_it->at("token").get<TokenCount>(),
+          ReportingTimeToTimeBucket(
+              key_it->at("reporting_time").get<std::string>()),
+          visited, consume_budget_metadata_list);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
+    }
+  }
+
+  if (consume_budget_metadata_list.empty()) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  return core::SuccessExecutionResult();
+}
+
+// A field value of the begin transaction request as decoded by the streaming
+// parser. Only the strings and the numbers are kept, the other values only
+// need to be told apart from them.
+struct RequestFieldValue {
+  enum class Type { kAbsent, kNull, kBoolean, kNumber, kString, kStructured };
+
+  bool IsPresent() const { return type != Type::kAbsent; }
+
+  bool IsString() const { return type == Type::kString; }
+
+  // Whether the value converts to a token count, the same way
+  // nlohmann::json::get<TokenCount>() would.
+  bool IsTokenCount() const {
+    return type == Type::kNumber || type == Type::kBoolean;
+  }
+
+  Type type = Type::kAbsent;
+  std::string string_value;
+  TokenCount token_count = 0;
+};
+
+struct RequestBudgetKey {
+  bool is_object = false;
+  RequestFieldValue key;
+  RequestFieldValue token;
+  RequestFieldValue reporting_time;
+};
+
+struct RequestReportingOrigin {
+  bool is_object = false;
+  RequestFieldValue reporting_origin;
+  bool has_keys = false;
+  std::vector<RequestBudgetKey> keys;
+};
+
+struct BeginTransactionRequest {
+  bool is_object = false;
+  RequestFieldValue version;
+  // The "t" budget keys of the V1 requests.
+  bool has_budget_keys = false;
+  std::vector<RequestBudgetKey> budget_keys;
+  // The "data" reporting origins of the V2 requests.
+  bool has_reporting_origins = false;
+  std::vector<RequestReportingOrigin> reporting_origins;
+};
+
+// Decodes the fields of the begin transaction request out of the parsing
+// events, without building the JSON document. The parts of the body the
+// request does not use are skipped.
+//
+// The elements of "t", "data" and "keys" are the values they are iterated
+// over as JSON documents: the elements of an array, the values of an object,
+// none for null, and the value itself for the other values. The later of
+// duplicated object keys wins, as it does in the JSON documents.
+class BeginTransactionRequestSaxHandler
+    : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  explicit BeginTransactionRequestSaxHandler(BeginTransactionRequest& request)
+      : request_(request) {}
+
+  bool null() override {
+    RequestFieldValue value;
+    value.type = RequestFieldValue::Type::kNull;
+    OnValue(std::move(value), /*is_object=*/false);
+    return true;
+  }
+
+  bool boolean(bool val) override {
+    RequestFieldValue value;
+    value.type = RequestFieldValue::Type::kBoolean;
+    value.token_count = static_cast<TokenCount>(val);
+    OnValue(std::move(value), /*is_object=*/false);
+    return true;
+  }
+
+  bool number_integer(number_integer_t val) override {
+    return OnNumber(static_cast<TokenCount>(val));
+  }
+
+  bool number_unsigned(number_unsigned_t val) override {
+    return OnNumber(static_cast<TokenCount>(val));
+  }
+
+  bool number_float(number_float_t val, const string_t& s) override {
+    return OnNumber(static_cast<TokenCount>(val));
+  }
+
+  bool string(string_t& val) override {
+    RequestFieldValue value;
+    value.type = RequestFieldValue::Type::kString;
+    value.string_value = std::move(val);
+    OnValue(std::move(value), /*is_object=*/false);
+    return true;
+  }
+
+  bool binary(binary_t& val) override {
+    RequestFieldValue value;
+    value.type = RequestFieldValue::Type::kStructured;
+    OnValue(std::move(value), /*is_object=*/false);
+    return true;
+  }
+
+  bool start_object(std::size_t elements) override {
+    return OnContainerStart(/*is_object=*/true);
+  }
+
+  bool key(string_t& val) override {
+    containers_.back().key = std::move(val);
+    return true;
+  }
+
+  bool end_object() override {
+    containers_.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t elements) override {
+    return OnContainerStart(/*is_object=*/false);
+  }
+
+  bool end_array() override {
+    containers_.pop_back();
+    return true;
+  }
+
+  bool parse_error(std::size_t position, const std::string& last_token,
+                   const nlohmann::detail::exception& ex) override {
+    return false;
+  }
+
+ private:
+  enum class ContainerType {
+    kRequest,
+    kBudgetKeys,
+    kBudgetKey,
+    kReportingOrigins,
+    kReportingOrigin,
+    kSkipped,
+  };
+
+  struct Container {
+    ContainerType type;
+    // The key of the object member being parsed.
+    std::string key;
+  };
+
+  bool OnNumber(TokenCount token_count) {
+    RequestFieldValue value;
+    value.type = RequestFieldValue::Type::kNumber;
+    value.token_count = token_count;
+    OnValue(std::move(value), /*is_object=*/false);
+    return true;
+  }
+
+  bool OnContainerStart(bool is_object) {
+    RequestFieldValue value;
+    value.type = RequestFieldValue::Type::kStructured;
+    containers_.push_back({OnValue(std::move(value), is_object), ""});
+    return true;
+  }
+
+  // Records the value in the container being parsed, and returns the type of
+  // the container the value opens if it is an object or an array.
+  ContainerType OnValue(RequestFieldValue&& value, bool is_object) {
+    if (containers_.empty()) {
+      request_.is_object = is_object;
+      return is_object ? ContainerType::kRequest : ContainerType::kSkipped;
+    }
+
+    auto& container = containers_.back();
+    switch (container.type) {
+      case ContainerType::kRequest:
+        if (container.key == "v") {
+          request_.version = std::move(value);
+        } else if (container.key == "t") {
+          request_.has_budget_keys = true;
+          request_.budget_keys.clear();
+          budget_keys_ = &request_.budget_keys;
+          return OnElements(value, request_.budget_keys,
+                            ContainerType::kBudgetKeys);
+        } else if (container.key == "data") {
+          request_.has_reporting_origins = true;
+          request_.reporting_origins.clear();
+          return OnElements(value, request_.reporting_origins,
+                            ContainerType::kReportingOrigins);
+        }
+        return ContainerType::kSkipped;
+      case ContainerType::kBudgetKeys:
+        budget_keys_->emplace_back().is_object = is_object;
+        return is_object ? ContainerType::kBudgetKey : ContainerType::kSkipped;
+      case ContainerType::kBudgetKey: {
+        auto& budget_key = budget_keys_->back();
+        if (container.key == "key") {
+          budget_key.key = std::move(value);
+        } else if (container.key == "token") {
+          budget_key.token = std::move(value);
+        } else if (container.key == "reporting_time") {
+          budget_key.reporting_time = std::move(value);
+        }
+        return ContainerType::kSkipped;
       }
+      case ContainerType::kReportingOrigins:
+        request_.reporting_origins.emplace_back().is_object = is_object;
+        return is_object ? ContainerType::kReportingOrigin
+                         : ContainerType::kSkipped;
+      case ContainerType::kReportingOrigin: {
+        auto& reporting_origin = request_.reporting_origins.back();
+        if (container.key == "reporting_origin") {
+          reporting_origin.reporting_origin = std::move(value);
+        } else if (container.key == "keys") {
+          reporting_origin.has_keys = true;
+          reporting_origin.keys.clear();
+          budget_keys_ = &reporting_origin.keys;
+          return OnElements(value, reporting_origin.keys,
+                            ContainerType::kBudgetKeys);
+        }
+        return ContainerType::kSkipped;
+      }
+      case ContainerType::kSkipped:
+        return ContainerType::kSkipped;
+    }
+    return ContainerType::kSkipped;
+  }
+
+  // Records the value of a field whose elements are iterated over.
+  template <typename Element>
+  static ContainerType OnElements(const RequestFieldValue& value,
+                                  std::vector<Element>& elements,
+                                  ContainerType elements_container_type) {
+    if (value.type == RequestFieldValue::Type::kStructured) {
+      return elements_container_type;
+    }
+    if (value.type != RequestFieldValue::Type::kNull) {
+      // A scalar is iterated over as a single element, which is not an
+      // object.
+      elements.emplace_back();
+    }
+    return ContainerType::kSkipped;
+  }
+
+  BeginTransactionRequest& request_;
+  std::vector<Container> containers_;
+  // The budget keys being parsed, either the "t" ones or the "keys" of the
+  // last reporting origin.
+  std::vector<RequestBudgetKey>* budget_keys_ = nullptr;
+};
+
+// The cache is constructed on the first request, see
+// ReportingOriginToSiteCache.
+ExecutionResultOr<std::string> CachedTransformReportingOriginToSite(
+    const std::string& reporting_origin) {
+  static auto* cache = new ReportingOriginToSiteCache();
+  return cache->TransformReportingOriginToSite(reporting_origin);
+}
+
+// Checks that the reporting origin belongs to the authorized domain and is
+// not a duplicate of an earlier one.
+core::ExecutionResult ValidateReportingOrigin(
+    const std::string& authorized_domain, const std::string& reporting_origin,
+    std::unordered_set<std::string>& visited_reporting_origin,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) {
+  if (reporting_origin.empty()) {
+    consume_budget_metadata_list.clear();
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  ExecutionResultOr<std::string> site =
+      CachedTransformReportingOriginToSite(reporting_origin);
+  if (!site.Successful()) {
+    consume_budget_metadata_list.clear();
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  if (*site != authorized_domain) {
+    SCP_INFO(
+        kFrontEndUtils, core::common::kZeroUuid,
+        absl::StrFormat(
+            "The provided reporting origin does not belong to the authorized "
+            "domain. reporting_origin: %s; authorized_domain: %s",
+            *site, authorized_domain));
+    consume_budget_metadata_list.clear();
+    return core::FailureExecutionResult(
+        core::errors::
+            SC_PBS_FRONT_END_SERVICE_REPORTING_ORIGIN_NOT_BELONG_TO_SITE);
+  }
+
+  if (!visited_reporting_origin.emplace(reporting_origin).second) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST);
+  }
+  return core::SuccessExecutionResult();
+}
+
+// Mirrors ParseBeginTransactionRequestBodyV1 on the decoded request.
+core::ExecutionResult ValidateBeginTransactionRequestV1(
+    const std::string& transaction_origin,
+    const BeginTransactionRequest& request,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) {
+  if (!request.has_budget_keys) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  std::unordered_set<std::string> visited;
+  for (const auto& budget_key : request.budget_keys) {
+    if (!budget_key.is_object || !budget_key.key.IsPresent() ||
+        !budget_key.token.IsPresent() ||
+        !budget_key.reporting_time.IsPresent()) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+    if (!budget_key.key.IsString() || !budget_key.token.IsTokenCount() ||
+        !budget_key.reporting_time.IsString()) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
 
-      // TODO: This is a temporary solution to prevent transaction
-      // commands belong to the same reporting hour to execute within the
-      // same transaction. The proper solution is to move this logic to
-      // the transaction commands.
-      TimeGroup time_group = budget_key_timeframe_manager::Utils::GetTimeGroup(
-          *reporting_timestamp);
-      TimeBucket time_bucket =
-          budget_key_timeframe_manager::Utils::GetTimeBucket(
-              *reporting_timestamp);
-      std::string visited_key =
-          absl::StrCat(*budget_key_name, "_", std::to_string(time_group) + "_",
-                       std::to_string(time_bucket));
-      if (visited.find(visited_key) != visited.end()) {
+    auto execution_result = AppendBudgetKey(
+        absl::StrCat(transaction_origin, "/", budget_key.key.string_value),
+        budget_key.token.token_count,
+        ReportingTimeToTimeBucket(budget_key.reporting_time.string_value),
+        visited, consume_budget_metadata_list);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+  return core::SuccessExecutionResult();
+}
+
+// Mirrors ParseBeginTransactionRequestBodyV2 on the decoded request.
+core::ExecutionResult ValidateBeginTransactionRequestV2(
+    const std::string& authorized_domain,
+    const BeginTransactionRequest& request,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) {
+  if (!request.has_reporting_origins) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  std::unordered_set<std::string> visited;
+  std::unordered_set<std::string> visited_reporting_origin;
+  for (const auto& reporting_origin_keys : request.reporting_origins) {
+    if (!reporting_origin_keys.is_object ||
+        !reporting_origin_keys.reporting_origin.IsPresent() ||
+        !reporting_origin_keys.has_keys) {
+      consume_budget_metadata_list.clear();
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+    if (!reporting_origin_keys.reporting_origin.IsString()) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+    const std::string& reporting_origin =
+        reporting_origin_keys.reporting_origin.string_value;
+    if (auto execution_result = ValidateReportingOrigin(
+            authorized_domain, reporting_origin, visited_reporting_origin,
+            consume_budget_metadata_list);
+        !execution_result.Successful()) {
+      return execution_result;
+    }
+
+    for (const auto& budget_key : reporting_origin_keys.keys) {
+      if (!budget_key.is_object || !budget_key.key.IsPresent() ||
+          !budget_key.token.IsPresent() ||
+          !budget_key.reporting_time.IsPresent()) {
+        consume_budget_metadata_list.clear();
         return core::FailureExecutionResult(
-            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST);
+            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+      }
+      if (!budget_key.key.IsString() || !budget_key.token.IsTokenCount() ||
+          !budget_key.reporting_time.IsString()) {
+        return core::FailureExecutionResult(
+            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
       }
-      visited.emplace(visited_key);
 
-      consume_budget_metadata_list.emplace_back(ConsumeBudgetMetadata{
-          budget_key_name, token_count, *reporting_timestamp});
+      auto execution_result = AppendBudgetKey(
+          absl::StrCat(reporting_origin, "/", budget_key.key.string_value),
+          budget_key.token.token_count,
+          ReportingTimeToTimeBucket(budget_key.reporting_time.string_value),
+          visited, consume_budget_metadata_list);
+      if (!execution_result.Successful()) {
+        return execution_result;
+      }
     }
   }
 
@@ -282,11 +678,163 @@ core::ExecutionResult ParseBeginTransactionRequestBodyV2(
   return core::SuccessExecutionResult();
 }
 
+// Parses the request body in a single pass over its bytes, decoding the
+// consumed budgets straight from the parsing events. Accepts and rejects the
+// same bodies as ParseBeginTransactionRequestBodyFromDocument.
+core::ExecutionResult ParseBeginTransactionRequestBodyStreaming(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
+  try {
+    BeginTransactionRequest request;
+    BeginTransactionRequestSaxHandler handler(request);
+    if (!nlohmann::json::sax_parse(request_body.bytes->begin(),
+                                   request_body.bytes->end(), &handler) ||
+        !request.is_object || !request.version.IsString()) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+
+    if (request.version.string_value == kVersion1) {
+      return ValidateBeginTransactionRequestV1(transaction_origin, request,
+                                               consume_budget_metadata_list);
+    }
+    if (request.version.string_value == kVersion2) {
+      return ValidateBeginTransactionRequestV2(authorized_domain, request,
+                                               consume_budget_metadata_list);
+    }
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  } catch (const std::exception& exception) {
+    SCP_INFO(kFrontEndUtils, core::common::kZeroUuid,
+             absl::StrCat("ParseBeginTransactionRequestBody failed ",
+                          exception.what()));
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+}
+
+// Appends the budget keys decoded from a protobuf body to the list.
+core::ExecutionResult AppendBudgetKeysFromProto(
+    const std::string& origin,
+    const google::protobuf::RepeatedPtrField<
+        front_end_service::proto::BudgetKey>& budget_keys,
+    std::unordered_set<std::string>& visited,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) {
+  for (const auto& budget_key : budget_keys) {
+    if (!budget_key.has_reporting_time() ||
+        budget_key.token() > std::numeric_limits<TokenCount>::max()) {
+      consume_budget_metadata_list.clear();
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+
+    auto execution_result = AppendBudgetKey(
+        absl::StrCat(origin, "/", budget_key.key()),
+        static_cast<TokenCount>(budget_key.token()),
+        ReportingTimestampToTimeBucket(budget_key.reporting_time()), visited,
+        consume_budget_metadata_list);
+    if (!execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+  return core::SuccessExecutionResult();
+}
 }  // namespace
 
 core::ExecutionResult ParseBeginTransactionRequestBody(
     const std::string& authorized_domain, const core::BytesBuffer& request_body,
     std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
+  return ParseBeginTransactionRequestBodyStreaming(
+      authorized_domain, authorized_domain, request_body,
+      consume_budget_metadata_list);
+}
+
+core::ExecutionResult ParseBeginTransactionRequestBody(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
+  return ParseBeginTransactionRequestBodyStreaming(
+      authorized_domain, transaction_origin, request_body,
+      consume_budget_metadata_list);
+}
+
+core::ExecutionResult ParseBeginTransactionRequestBody(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const std::shared_ptr<core::HttpHeaders>& request_headers,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
+  if (request_headers) {
+    auto header_iter = request_headers->find(kContentTypeHeader);
+    if (header_iter != request_headers->end()) {
+      // Ignores the parameters of the media type.
+      absl::string_view content_type = header_iter->second;
+      content_type = content_type.substr(0, content_type.find(';'));
+      if (absl::EqualsIgnoreCase(absl::StripAsciiWhitespace(content_type),
+                                 kProtobufContentType)) {
+        return ParseBeginTransactionRequestBodyFromProto(
+            authorized_domain, transaction_origin, request_body,
+            consume_budget_metadata_list);
+      }
+    }
+  }
+  return ParseBeginTransactionRequestBody(authorized_domain, transaction_origin,
+                                          request_body,
+                                          consume_budget_metadata_list);
+}
+
+core::ExecutionResult ParseBeginTransactionRequestBodyFromProto(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
+  front_end_service::proto::BeginTransactionRequestBody transaction_request;
+  if (!request_body.bytes || request_body.length > request_body.bytes->size() ||
+      !transaction_request.ParseFromArray(request_body.bytes->data(),
+                                          request_body.length)) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  std::unordered_set<std::string> visited;
+  if (transaction_request.version() == kVersion1) {
+    return AppendBudgetKeysFromProto(transaction_origin,
+                                     transaction_request.keys(), visited,
+                                     consume_budget_metadata_list);
+  }
+  if (transaction_request.version() != kVersion2 ||
+      transaction_request.data().empty()) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+
+  std::unordered_set<std::string> visited_reporting_origin;
+  for (const auto& reporting_origin_keys : transaction_request.data()) {
+    const std::string& reporting_origin =
+        reporting_origin_keys.reporting_origin();
+    if (auto execution_result = ValidateReportingOrigin(
+            authorized_domain, reporting_origin, visited_reporting_origin,
+            consume_budget_metadata_list);
+        !execution_result.Successful()) {
+      return execution_result;
+    }
+    if (auto execution_result = AppendBudgetKeysFromProto(
+            reporting_origin, reporting_origin_keys.keys(), visited,
+            consume_budget_metadata_list);
+        !execution_result.Successful()) {
+      return execution_result;
+    }
+  }
+
+  if (consume_budget_metadata_list.empty()) {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  }
+  return core::SuccessExecutionResult();
+}
+
+core::ExecutionResult ParseBeginTransactionRequestBodyFromDocument(
+    const std::string& authorized_domain, const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
   try {
     nlohmann::json transaction_request = nlohmann::json::parse(
         request_body.bytes->begin(), request_body.bytes->end(),
@@ -323,7 +871,7 @@ core::ExecutionResult ParseBeginTransactionRequestBody(
   }
 }
 
-core::ExecutionResult ParseBeginTransactionRequestBody(
+core::ExecutionResult ParseBeginTransactionRequestBodyFromDocument(
     const std::string& authorized_domain, const std::string& transaction_origin,
     const core::BytesBuffer& request_body,
     std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept {
@@ -363,6 +911,47 @@ core::ExecutionResult ParseBeginTransactionRequestBody(
   }
 }
 
+ReportingOriginToSiteCache::ReportingOriginToSiteCache() {
+  auto meter = opentelemetry::metrics::Provider::GetMeterProvider()->GetMeter(
+      kFrontEndUtils, "1.0");
+  hit_counter_ = meter->CreateUInt64Counter(
+      kMetricNameReportingOriginSiteCacheHits,
+      "Number of reporting origins whose site was found in the cache");
+  miss_counter_ = meter->CreateUInt64Counter(
+      kMetricNameReportingOriginSiteCacheMisses,
+      "Number of reporting origins whose site was not found in the cache");
+}
+
+core::ExecutionResultOr<std::string>
+ReportingOriginToSiteCache::TransformReportingOriginToSite(
+    const std::string& reporting_origin) {
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    if (auto it = sites_.find(reporting_origin); it != sites_.end()) {
+      hit_counter_->Add(1);
+      return it->second;
+    }
+  }
+  miss_counter_->Add(1);
+
+  auto site = pbs::TransformReportingOriginToSite(reporting_origin);
+  // The origins that have no site are not cached, they are not expected to be
+  // sent again.
+  if (site.Successful()) {
+    absl::MutexLock lock(&mutex_);
+    if (sites_.size() >= kMaxCachedReportingOriginSites) {
+      sites_.clear();
+    }
+    sites_.emplace(reporting_origin, *site);
+  }
+  return site;
+}
+
+size_t ReportingOriginToSiteCache::Size() {
+  absl::ReaderMutexLock lock(&mutex_);
+  return sites_.size();
+}
+
 core::ExecutionResultOr<std::string> TransformReportingOriginToSite(
     const std::string& reporting_origin) {
   const psl_ctx_t* psl = psl_builtin();
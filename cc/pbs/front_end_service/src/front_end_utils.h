@@ -29,6 +29,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "cc/pbs/front_end_service/src/error_codes.h"
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/http_types.h"
@@ -54,9 +55,63 @@ core::ExecutionResult ParseBeginTransactionRequestBody(
     const core::BytesBuffer& request_body,
     std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept;
 
+// Parse the request body with the decoder of its content type: the protobuf
+// decoder for the kProtobufContentType bodies, the JSON one for the others.
+core::ExecutionResult ParseBeginTransactionRequestBody(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const std::shared_ptr<core::HttpHeaders>& request_headers,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept;
+
+// Parse a request body encoded as a
+// front_end_service::proto::BeginTransactionRequestBody. The bodies are
+// validated the same way as the JSON ones.
+core::ExecutionResult ParseBeginTransactionRequestBodyFromProto(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept;
+
+// Parse the request bodies out of their JSON documents. This is the reference
+// implementation of ParseBeginTransactionRequestBody, which decodes the
+// request bodies in a single streaming pass instead.
+core::ExecutionResult ParseBeginTransactionRequestBodyFromDocument(
+    const std::string& authorized_domain, const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept;
+
+core::ExecutionResult ParseBeginTransactionRequestBodyFromDocument(
+    const std::string& authorized_domain, const std::string& transaction_origin,
+    const core::BytesBuffer& request_body,
+    std::vector<ConsumeBudgetMetadata>& consume_budget_metadata_list) noexcept;
+
 core::ExecutionResultOr<std::string> TransformReportingOriginToSite(
     const std::string& reporting_origin);
 
+// Memoizes TransformReportingOriginToSite. The requests come from a handful
+// of reporting origins, so a small cache serves nearly all of them. Once full,
+// the cache starts over rather than tracking recency.
+//
+// The hit and miss counters are created from the global MeterProvider at
+// construction. The cache of the requests is constructed on the first
+// request, so the MeterProvider must be installed before it.
+class ReportingOriginToSiteCache {
+ public:
+  static constexpr size_t kMaxCachedReportingOriginSites = 1024;
+
+  ReportingOriginToSiteCache();
+
+  core::ExecutionResultOr<std::string> TransformReportingOriginToSite(
+      const std::string& reporting_origin);
+
+  // The number of reporting origins cached.
+  size_t Size();
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::string> sites_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<opentelemetry::metrics::Counter<uint64_t>> hit_counter_;
+  std::unique_ptr<opentelemetry::metrics::Counter<uint64_t>> miss_counter_;
+};
+
 class FrontEndUtils {
  public:
   static core::ExecutionResult SerializeTransactionFailedCommandIndicesResponse(
@@ -293,6 +348,192 @@ class FrontEndUtils {
     return core::SuccessExecutionResult();
   }
 
+  static core::ExecutionResult SerializeBatchGetTransactionStatusRequest(
+      const core::BatchGetTransactionStatusRequest& request,
+      core::BytesBuffer& request_body) noexcept {
+    nlohmann::json json_request;
+    json_request["v"] = "1.0";
+    json_request["transactions"] = nlohmann::json::array();
+    for (const auto& transaction : request.transactions) {
+      nlohmann::json json_transaction;
+      json_transaction["transaction_id"] =
+          core::common::ToString(transaction.transaction_id);
+      json_transaction["transaction_secret"] =
+          transaction.transaction_secret ? *transaction.transaction_secret
+                                         : std::string();
+      json_request["transactions"].push_back(std::move(json_transaction));
+    }
+
+    auto body = json_request.dump();
+    request_body.capacity = body.length();
+    request_body.length = body.length();
+    request_body.bytes =
+        std::make_shared<std::vector<core::Byte>>(body.begin(), body.end());
+    return core::SuccessExecutionResult();
+  }
+
+  static core::ExecutionResult DeserializeBatchGetTransactionStatusRequest(
+      const core::BytesBuffer& request_body,
+      core::BatchGetTransactionStatusRequest& request) noexcept {
+    if (!request_body.bytes || request_body.length == 0) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+    try {
+      auto json_request = nlohmann::json::parse(
+          request_body.bytes->begin(),
+          request_body.bytes->begin() + request_body.length);
+      auto transactions_it = json_request.find("transactions");
+      if (transactions_it == json_request.end() ||
+          !transactions_it->is_array()) {
+        return core::FailureExecutionResult(
+            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+      }
+
+      for (const auto& json_transaction : *transactions_it) {
+        if (json_transaction.find("transaction_id") ==
+                json_transaction.end() ||
+            json_transaction.find("transaction_secret") ==
+                json_transaction.end()) {
+          return core::FailureExecutionResult(
+              core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+        }
+        core::GetTransactionStatusRequest transaction;
+        auto execution_result = core::common::FromString(
+            json_transaction.at("transaction_id").get<std::string>(),
+            transaction.transaction_id);
+        if (!execution_result.Successful()) {
+          return execution_result;
+        }
+        transaction.transaction_secret = std::make_shared<std::string>(
+            json_transaction.at("transaction_secret").get<std::string>());
+        request.transactions.push_back(std::move(transaction));
+      }
+    } catch (...) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+    }
+
+    return core::SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Serializes the statuses of a batch. The status of each transaction
+   * is serialized as by SerializeGetTransactionStatus along with its id and
+   * status code, zero if it was found.
+   */
+  static core::ExecutionResult SerializeBatchGetTransactionStatus(
+      const core::BatchGetTransactionStatusResponse& response,
+      core::BytesBuffer& response_body) noexcept {
+    nlohmann::json json_response;
+    json_response["transactions"] = nlohmann::json::array();
+    for (const auto& result : response.results) {
+      nlohmann::json json_transaction;
+      json_transaction["transaction_id"] =
+          core::common::ToString(result.transaction_id);
+      json_transaction["status_code"] =
+          result.result.Successful() ? 0 : result.result.status_code;
+      if (result.result.Successful()) {
+        json_transaction["is_expired"] = result.status.is_expired;
+        json_transaction["has_failures"] = result.status.has_failure;
+        json_transaction["last_execution_timestamp"] =
+            result.status.last_execution_timestamp;
+        std::string transaction_execution_phase;
+        auto execution_result =
+            ToString(result.status.transaction_execution_phase,
+                     transaction_execution_phase);
+        if (!execution_result.Successful()) {
+          return execution_result;
+        }
+        json_transaction["transaction_execution_phase"] =
+            transaction_execution_phase;
+      }
+      json_response["transactions"].push_back(std::move(json_transaction));
+    }
+
+    auto body = json_response.dump();
+    response_body.capacity = body.length();
+    response_body.length = body.length();
+    response_body.bytes =
+        std::make_shared<std::vector<core::Byte>>(body.begin(), body.end());
+    return core::SuccessExecutionResult();
+  }
+
+  static core::ExecutionResult DeserializeBatchGetTransactionStatus(
+      const core::BytesBuffer& response_body,
+      core::BatchGetTransactionStatusResponse& response) noexcept {
+    if (!response_body.bytes) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_RESPONSE_BODY);
+    }
+    try {
+      auto json_response = nlohmann::json::parse(
+          response_body.bytes->begin(),
+          response_body.bytes->begin() + response_body.length);
+      auto transactions_it = json_response.find("transactions");
+      if (transactions_it == json_response.end() ||
+          !transactions_it->is_array()) {
+        return core::FailureExecutionResult(
+            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_RESPONSE_BODY);
+      }
+
+      for (const auto& json_transaction : *transactions_it) {
+        if (json_transaction.find("transaction_id") ==
+                json_transaction.end() ||
+            json_transaction.find("status_code") == json_transaction.end()) {
+          return core::FailureExecutionResult(
+              core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_RESPONSE_BODY);
+        }
+        core::BatchGetTransactionStatusResult result;
+        auto execution_result = core::common::FromString(
+            json_transaction.at("transaction_id").get<std::string>(),
+            result.transaction_id);
+        if (!execution_result.Successful()) {
+          return execution_result;
+        }
+
+        auto status_code = json_transaction.at("status_code").get<uint64_t>();
+        if (status_code != 0) {
+          result.result = core::FailureExecutionResult(status_code);
+          response.results.push_back(std::move(result));
+          continue;
+        }
+
+        if (json_transaction.find("is_expired") == json_transaction.end() ||
+            json_transaction.find("has_failures") == json_transaction.end() ||
+            json_transaction.find("last_execution_timestamp") ==
+                json_transaction.end() ||
+            json_transaction.find("transaction_execution_phase") ==
+                json_transaction.end()) {
+          return core::FailureExecutionResult(
+              core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_RESPONSE_BODY);
+        }
+        result.result = core::SuccessExecutionResult();
+        result.status.is_expired =
+            json_transaction.at("is_expired").get<bool>();
+        result.status.has_failure =
+            json_transaction.at("has_failures").get<bool>();
+        result.status.last_execution_timestamp =
+            json_transaction.at("last_execution_timestamp").get<uint64_t>();
+        auto transaction_execution_phase =
+            json_transaction.at("transaction_execution_phase")
+                .get<std::string>();
+        execution_result = FromString(
+            transaction_execution_phase,
+            result.status.transaction_execution_phase);
+        if (!execution_result.Successful()) {
+          return execution_result;
+        }
+        response.results.push_back(std::move(result));
+      }
+    } catch (...) {
+      return core::FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_RESPONSE_BODY);
+    }
+
+    return core::SuccessExecutionResult();
+  }
+
   static core::ExecutionResult ToString(
       core::TransactionExecutionPhase transaction_execution_phase,
       std::string& output) noexcept {
@@ -0,0 +1,145 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/front_end_service/src/request_stage_metrics.h"
+
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "cc/core/interface/type_def.h"
+#include "cc/pbs/interface/configuration_keys.h"
+#include "opentelemetry/context/runtime_context.h"
+
+namespace google::scp::pbs {
+namespace {
+
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::kSecondUnit;
+using ::google::scp::core::MetricAttributes;
+using ::google::scp::core::MetricRouter;
+using ::google::scp::core::SuccessExecutionResult;
+
+constexpr RequestStage kRequestStages[] = {
+    RequestStage::kAuth, RequestStage::kParse, RequestStage::kConsume,
+    RequestStage::kSpannerCommit, RequestStage::kResponseWrite};
+
+// The stages take from microseconds for the parsing to seconds for the
+// consumption when Spanner is under load.
+const std::vector<double>& DefaultBoundaries() {
+  static const std::vector<double> kDefaultBoundaries = {
+      0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+      0.025,   0.05,   0.1,     0.25,   0.5,   1,      2.5,   5};
+  return kDefaultBoundaries;
+}
+
+}  // namespace
+
+absl::string_view RequestStageToString(RequestStage stage) noexcept {
+  switch (stage) {
+    case RequestStage::kAuth:
+      return "auth";
+    case RequestStage::kParse:
+      return "parse";
+    case RequestStage::kConsume:
+      return "consume";
+    case RequestStage::kSpannerCommit:
+      return "spanner_commit";
+    case RequestStage::kResponseWrite:
+      return "response_write";
+  }
+  return "unknown";
+}
+
+RequestStageMetrics::RequestStageMetrics(
+    absl::Nullable<std::shared_ptr<MetricRouter>> metric_router,
+    std::shared_ptr<core::ConfigProviderInterface> config_provider)
+    : metric_router_(std::move(metric_router)),
+      config_provider_(std::move(config_provider)) {
+  for (RequestStage stage : kRequestStages) {
+    absl::string_view stage_name = RequestStageToString(stage);
+    stage_attributes_.push_back(std::make_unique<MetricAttributes>(
+        std::initializer_list<MetricAttributes::Attribute>{
+            {kRequestStageLabel,
+             opentelemetry::nostd::string_view(stage_name.data(),
+                                               stage_name.size())}}));
+  }
+}
+
+std::vector<double> RequestStageMetrics::GetBoundaries() noexcept {
+  std::list<size_t> boundaries_in_microseconds;
+  if (!config_provider_ ||
+      !config_provider_
+           ->Get(kPBSRequestStageLatencyBoundariesInMicroseconds,
+                 boundaries_in_microseconds)
+           .Successful() ||
+      boundaries_in_microseconds.empty()) {
+    return DefaultBoundaries();
+  }
+  std::vector<double> boundaries;
+  boundaries.reserve(boundaries_in_microseconds.size());
+  for (size_t boundary : boundaries_in_microseconds) {
+    boundaries.push_back(std::chrono::duration<double>(
+                             std::chrono::microseconds(boundary))
+                             .count());
+  }
+  return boundaries;
+}
+
+ExecutionResult RequestStageMetrics::Init() noexcept {
+  if (!metric_router_) {
+    return SuccessExecutionResult();
+  }
+
+  meter_ = metric_router_->GetOrCreateMeter(kRequestStageMeter);
+
+  metric_router_->CreateHistogramViewForInstrument(
+      /*metric_name=*/kRequestStageDurationMetric,
+      /*view_name=*/kRequestStageDurationView,
+      /*instrument_type=*/MetricRouter::InstrumentType::kHistogram,
+      /*boundaries=*/GetBoundaries(),
+      /*version=*/"", /*schema=*/"",
+      /*view_description=*/"PBS request stage duration histogram",
+      /*unit=*/kSecondUnit);
+
+  stage_duration_histogram_ =
+      metric_router_->GetOrCreateSyncInstrument<
+          opentelemetry::metrics::Histogram<double>>(
+          kRequestStageDurationMetric,
+          [&]() -> std::shared_ptr<
+                    opentelemetry::metrics::SynchronousInstrument> {
+            return meter_->CreateDoubleHistogram(
+                kRequestStageDurationMetric,
+                "Time the consume budget requests spend in each stage of the "
+                "request path in seconds",
+                kSecondUnit);
+          });
+
+  return SuccessExecutionResult();
+}
+
+void RequestStageMetrics::Record(RequestStage stage,
+                                 std::chrono::nanoseconds duration) noexcept {
+  if (!stage_duration_histogram_) {
+    return;
+  }
+
+  stage_duration_histogram_->Record(
+      std::chrono::duration<double>(duration).count(),
+      *stage_attributes_[static_cast<size_t>(stage)],
+      opentelemetry::context::RuntimeContext::GetCurrent());
+}
+
+}  // namespace google::scp::pbs
@@ -0,0 +1,119 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CC_PBS_FRONT_END_SERVICE_SRC_REQUEST_STAGE_METRICS_H_
+#define CC_PBS_FRONT_END_SERVICE_SRC_REQUEST_STAGE_METRICS_H_
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/strings/string_view.h"
+#include "cc/core/interface/config_provider_interface.h"
+#include "cc/core/telemetry/src/metric/metric_router.h"
+#include "cc/public/core/interface/execution_result.h"
+#include "opentelemetry/metrics/meter.h"
+#include "opentelemetry/metrics/sync_instruments.h"
+
+namespace google::scp::pbs {
+
+// Meter, named after the metric so that the view created for it applies.
+inline constexpr absl::string_view kRequestStageMeter =
+    "pbs.request.stage_duration";
+
+// View
+inline constexpr absl::string_view kRequestStageDurationView =
+    "PBS Request Stage Duration";
+
+// Metrics
+inline constexpr absl::string_view kRequestStageDurationMetric =
+    "pbs.request.stage_duration";
+
+// Labels
+inline constexpr absl::string_view kRequestStageLabel = "pbs.request.stage";
+
+/// The stages of a consume budget request.
+enum class RequestStage {
+  /// From the receipt of the request headers to the authorization response.
+  kAuth = 0,
+  /// The extraction of the headers and the parsing of the body.
+  kParse = 1,
+  /// From the dispatch of the budgets to their consumption callback,
+  /// including the time spent queued for an IO thread.
+  kConsume = 2,
+  /// The commit of the Spanner transaction which consumed the budgets,
+  /// including the runs of it which were aborted.
+  kSpannerCommit = 3,
+  /// From the consumption callback to the response being handed to the
+  /// HTTP server for sending.
+  kResponseWrite = 4,
+};
+
+/// Returns the value of kRequestStageLabel for the stage.
+absl::string_view RequestStageToString(RequestStage stage) noexcept;
+
+/**
+ * @brief Exports a histogram of the time the consume budget requests spend in
+ * each stage of the request path through the MetricRouter.
+ *
+ * The points are recorded with the current runtime context, so that with a
+ * span active and the exemplar filter of the MeterProvider set to trace based,
+ * the histogram buckets carry exemplars linking to the trace of the request.
+ */
+class RequestStageMetrics {
+ public:
+  /**
+   * @brief Construct a new Request Stage Metrics object.
+   *
+   * @param metric_router the router to create the instruments with. Nothing
+   * is recorded if null.
+   * @param config_provider the provider of the bucket boundaries.
+   */
+  RequestStageMetrics(
+      absl::Nullable<std::shared_ptr<core::MetricRouter>> metric_router,
+      std::shared_ptr<core::ConfigProviderInterface> config_provider);
+
+  /// Creates the view and the instrument. Must be called before any stage is
+  /// recorded.
+  core::ExecutionResult Init() noexcept;
+
+  /**
+   * @brief Records the time a request spent in a stage.
+   *
+   * @param stage the stage.
+   * @param duration the time spent in the stage.
+   */
+  void Record(RequestStage stage, std::chrono::nanoseconds duration) noexcept;
+
+ private:
+  /// Returns the bucket boundaries in seconds, from the configuration if set.
+  std::vector<double> GetBoundaries() noexcept;
+
+  /// An instance of metric router which will provide APIs to create metrics.
+  absl::Nullable<std::shared_ptr<core::MetricRouter>> metric_router_;
+  /// An instance of the config provider.
+  std::shared_ptr<core::ConfigProviderInterface> config_provider_;
+  /// OpenTelemetry Meter used for creating and managing metrics.
+  std::shared_ptr<opentelemetry::metrics::Meter> meter_;
+  /// Histogram of the stage durations.
+  std::shared_ptr<opentelemetry::metrics::Histogram<double>>
+      stage_duration_histogram_;
+  /// The attributes of each stage, indexed by RequestStage.
+  std::vector<std::unique_ptr<core::MetricAttributes>> stage_attributes_;
+};
+
+}  // namespace google::scp::pbs
+
+#endif  // CC_PBS_FRONT_END_SERVICE_SRC_REQUEST_STAGE_METRICS_H_
@@ -0,0 +1,75 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/front_end_service/src/concurrency_limiter.h"
+
+#include <gtest/gtest.h>
+
+namespace google::scp::pbs {
+namespace {
+
+constexpr core::TimeDuration kTargetLatency = 1000;
+
+TEST(ConcurrencyLimiterTest, RejectsRequestsAboveTheLimit) {
+  ConcurrencyLimiter limiter(2, 1, 10, kTargetLatency);
+  EXPECT_TRUE(limiter.TryAcquire());
+  EXPECT_TRUE(limiter.TryAcquire());
+  EXPECT_FALSE(limiter.TryAcquire());
+  EXPECT_EQ(limiter.GetInFlightCount(), 2);
+
+  limiter.ReleaseWithoutSample();
+  EXPECT_EQ(limiter.GetLimit(), 2);
+  EXPECT_TRUE(limiter.TryAcquire());
+}
+
+TEST(ConcurrencyLimiterTest, GrowsAdditivelyWithinTargetLatency) {
+  ConcurrencyLimiter limiter(2, 1, 10, kTargetLatency);
+  // Each fast request grows the limit by 1/limit, so a whole limit's worth of
+  // them grows it by one.
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(limiter.TryAcquire());
+    limiter.Release(kTargetLatency);
+  }
+  EXPECT_EQ(limiter.GetLimit(), 2);
+  ASSERT_TRUE(limiter.TryAcquire());
+  limiter.Release(kTargetLatency);
+  EXPECT_EQ(limiter.GetLimit(), 3);
+  EXPECT_EQ(limiter.GetInFlightCount(), 0);
+}
+
+TEST(ConcurrencyLimiterTest, BacksOffMultiplicativelyAboveTargetLatency) {
+  ConcurrencyLimiter limiter(10, 2, 10, kTargetLatency, 0.5);
+  ASSERT_TRUE(limiter.TryAcquire());
+  limiter.Release(kTargetLatency + 1);
+  EXPECT_EQ(limiter.GetLimit(), 5);
+  ASSERT_TRUE(limiter.TryAcquire());
+  limiter.Release(kTargetLatency + 1);
+  EXPECT_EQ(limiter.GetLimit(), 2);
+  ASSERT_TRUE(limiter.TryAcquire());
+  limiter.Release(kTargetLatency + 1);
+  EXPECT_EQ(limiter.GetLimit(), 2);
+}
+
+TEST(ConcurrencyLimiterTest, NeverGrowsAboveTheMaxLimit) {
+  ConcurrencyLimiter limiter(20, 1, 3, kTargetLatency);
+  EXPECT_EQ(limiter.GetLimit(), 3);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(limiter.TryAcquire());
+    limiter.Release(0);
+  }
+  EXPECT_EQ(limiter.GetLimit(), 3);
+}
+
+}  // namespace
+}  // namespace google::scp::pbs
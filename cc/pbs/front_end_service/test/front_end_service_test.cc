@@ -40,6 +40,7 @@
 #include "cc/core/test/utils/conditional_wait.h"
 #include "cc/pbs/front_end_service/mock/mock_front_end_service_with_overrides.h"
 #include "cc/pbs/front_end_service/src/error_codes.h"
+#include "cc/pbs/front_end_service/src/front_end_utils.h"
 #include "cc/pbs/interface/configuration_keys.h"
 #include "cc/pbs/partition_request_router/mock/mock_transaction_request_router.h"
 #include "cc/pbs/transactions/mock/mock_consume_budget_command_factory.h"
@@ -56,6 +57,8 @@ namespace google::scp::pbs::test {
 
 using ::google::scp::core::AsyncContext;
 using ::google::scp::core::AsyncExecutorInterface;
+using ::google::scp::core::BatchGetTransactionStatusRequest;
+using ::google::scp::core::BatchGetTransactionStatusResponse;
 using ::google::scp::core::Byte;
 using ::google::scp::core::BytesBuffer;
 using ::google::scp::core::ConfigProviderInterface;
@@ -778,6 +781,146 @@ TEST_F(FrontEndServiceTest, BeginTransactionValidBodySiteAsAuthDomainEnabled) {
   WaitUntil([&]() { return condition.load(); });
 }
 
+TEST_F(FrontEndServiceTest, ConsumeBudgetRunsTheWholeTransaction) {
+  auto mock_metric_client = std::make_shared<MockMetricClient>();
+  auto mock_config_provider = std::make_shared<MockConfigProvider>();
+  auto mock_transaction_request_router = GetMockTransactionRequestRouter();
+  std::shared_ptr<AsyncExecutorInterface> mock_async_executor =
+      make_shared<MockAsyncExecutor>();
+
+  atomic<bool> condition = false;
+  EXPECT_CALL(
+      *mock_transaction_request_router,
+      Execute(An<AsyncContext<TransactionRequest, TransactionResponse>&>()))
+      .WillOnce([&](AsyncContext<TransactionRequest, TransactionResponse>&
+                        transaction_context) {
+        EXPECT_FALSE(transaction_context.request->is_coordinated_remotely);
+        EXPECT_EQ(transaction_context.request->commands.size(), 2);
+        EXPECT_NE(transaction_context.request->timeout_time, 0);
+        EXPECT_EQ(core::common::ToString(
+                      transaction_context.request->transaction_id),
+                  "3E2A3D09-48ED-A355-D346-AD7DC6CB0909");
+        EXPECT_EQ(*transaction_context.request->transaction_secret,
+                  "transaction_secret");
+        EXPECT_EQ(*transaction_context.request->transaction_origin,
+                  "https://origin.foo.com");
+
+        auto command = static_pointer_cast<ConsumeBudgetCommand>(
+            transaction_context.request->commands[0]);
+        EXPECT_EQ(*command->GetBudgetKeyName(),
+                  "https://origin.foo.com/test_key");
+        EXPECT_EQ(command->GetTokenCount(), 10);
+        command = static_pointer_cast<ConsumeBudgetCommand>(
+            transaction_context.request->commands[1]);
+        EXPECT_EQ(*command->GetBudgetKeyName(),
+                  "https://origin.foo.com/test_key_2");
+        EXPECT_EQ(command->GetTokenCount(), 23);
+        condition = true;
+        return SuccessExecutionResult();
+      });
+
+  std::unique_ptr<ConsumeBudgetCommandFactoryInterface>
+      consume_budget_command_factory = GetMockConsumeBudgetCommandFactory();
+  shared_ptr<HttpServerInterface> http2_server =
+      std::make_shared<MockHttp2Server>();
+
+  auto total_request_counter = std::make_unique<MockCounter<uint64_t>>();
+  auto client_error_counter = std::make_unique<MockCounter<uint64_t>>();
+  auto server_error_counter = std::make_unique<MockCounter<uint64_t>>();
+  EXPECT_CALL(
+      *total_request_counter,
+      Add(1, testing::A<const opentelemetry::common::KeyValueIterable&>()))
+      .Times(1);
+  EXPECT_CALL(
+      *client_error_counter,
+      Add(1, testing::A<const opentelemetry::common::KeyValueIterable&>()))
+      .Times(0);
+
+  MockFrontEndServiceWithOverrides front_end_service(
+      http2_server, mock_async_executor,
+      std::move(mock_transaction_request_router),
+      std::move(consume_budget_command_factory), mock_metric_client,
+      mock_config_provider, std::move(total_request_counter),
+      std::move(client_error_counter), std::move(server_error_counter));
+
+  front_end_service.Init();
+  front_end_service.InitMetricInstances();
+  string body_string = GetBeginTransactionHttpRequestBody_Sample();
+  BytesBuffer bytes_buffer;
+  bytes_buffer.bytes =
+      std::make_shared<vector<Byte>>(body_string.begin(), body_string.end());
+  bytes_buffer.capacity = body_string.length();
+  bytes_buffer.length = body_string.length();
+
+  AsyncContext<HttpRequest, HttpResponse> http_context;
+  http_context.request = std::make_shared<HttpRequest>();
+  http_context.request->body = bytes_buffer;
+  http_context.request->headers = std::make_shared<HttpHeaders>();
+  http_context.request->auth_context.authorized_domain =
+      std::make_shared<string>("https://foo.com");
+  http_context.request->headers->insert(
+      {std::string(kTransactionOriginHeader), "https://origin.foo.com"});
+  http_context.request->headers->insert(
+      {std::string(kTransactionIdHeader),
+       "3E2A3D09-48ED-A355-D346-AD7DC6CB0909"});
+  http_context.request->headers->insert({std::string(kTransactionSecretHeader),
+                                         std::string("transaction_secret")});
+  EXPECT_EQ(front_end_service.ConsumeBudget(http_context),
+            SuccessExecutionResult());
+  auto total_request_metric_instance = front_end_service.GetMetricsInstance(
+      kMetricLabelConsumeBudgetTransaction, kMetricNameRequests);
+  EXPECT_EQ(
+      total_request_metric_instance->GetCounter(kMetricLabelValueOperator), 1);
+  WaitUntil([&]() { return condition.load(); });
+}
+
+TEST_F(FrontEndServiceTest, OnConsumeBudgetTransactionCallback) {
+  transaction_context_.response->failed_commands_indices = {1, 2};
+  transaction_context_.response->last_execution_timestamp = 1234567;
+
+  vector<ExecutionResult> results = {SuccessExecutionResult(),
+                                     FailureExecutionResult(123),
+                                     RetryExecutionResult(123)};
+  vector<size_t> expected_server_error_metrics = {0, 1, 1};
+
+  for (int i = 0; i < results.size(); i++) {
+    auto result = results[i];
+    atomic<bool> condition = false;
+    AsyncContext<HttpRequest, HttpResponse> http_context;
+    http_context.response = make_shared<HttpResponse>();
+    http_context.request = make_shared<HttpRequest>();
+    http_context.request->headers = make_shared<HttpHeaders>();
+    http_context.request->auth_context.authorized_domain =
+        make_shared<string>("origin");
+    http_context.response->headers = make_shared<core::HttpHeaders>();
+    http_context.callback =
+        [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+          EXPECT_THAT(http_context.result, ResultIs(result));
+          if (result.Successful()) {
+            EXPECT_EQ(http_context.response->headers
+                          ->find(kTransactionLastExecutionTimestampHeader)
+                          ->second,
+                      "1234567");
+          } else if (result.status == core::ExecutionStatus::Failure) {
+            string body(http_context.response->body.bytes->begin(),
+                        http_context.response->body.bytes->end());
+            EXPECT_EQ(body, R"({"f":[1,2],"v":"1.0"})");
+          } else {
+            EXPECT_EQ(http_context.response->body.length, 0);
+          }
+          condition = true;
+        };
+
+    transaction_context_.result = result;
+    auto mock_metric_transaction = make_shared<MockAggregateMetric>();
+    front_end_service_->OnConsumeBudgetTransactionCallback(
+        mock_metric_transaction, http_context, transaction_context_);
+    WaitUntil([&]() { return condition.load(); });
+    EXPECT_EQ(mock_metric_transaction->GetCounter(kMetricLabelValueOperator),
+              expected_server_error_metrics[i]);
+  }
+}
+
 TEST_F(FrontEndServiceTest, OnTransactionCallbackFailed) {
   atomic<bool> condition = false;
   AsyncContext<HttpRequest, HttpResponse> http_context;
@@ -1680,6 +1823,117 @@ TEST_F(FrontEndServiceTest, GetTransactionStatus) {
   WaitUntil([&]() { return condition.load(); });
 }
 
+TEST_F(FrontEndServiceTest, BatchGetTransactionStatus) {
+  auto mock_metric_client = make_shared<MockMetricClient>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  auto mock_transaction_request_router = GetMockTransactionRequestRouter();
+  auto mock_transaction_request_router_copy =
+      mock_transaction_request_router.get();
+  shared_ptr<AsyncExecutorInterface> mock_async_executor =
+      make_shared<MockAsyncExecutor>();
+  std::unique_ptr<ConsumeBudgetCommandFactoryInterface>
+      consume_budget_command_factory = GetMockConsumeBudgetCommandFactory();
+  shared_ptr<HttpServerInterface> http2_server = make_shared<MockHttp2Server>();
+
+  auto total_request_counter = std::make_unique<MockCounter<uint64_t>>();
+  auto client_error_counter = std::make_unique<MockCounter<uint64_t>>();
+  auto server_error_counter = std::make_unique<MockCounter<uint64_t>>();
+  EXPECT_CALL(
+      *total_request_counter,
+      Add(1, testing::A<const opentelemetry::common::KeyValueIterable&>()))
+      .Times(2);
+  EXPECT_CALL(
+      *client_error_counter,
+      Add(1, testing::A<const opentelemetry::common::KeyValueIterable&>()))
+      .Times(1);
+
+  MockFrontEndServiceWithOverrides front_end_service(
+      http2_server, mock_async_executor,
+      std::move(mock_transaction_request_router),
+      std::move(consume_budget_command_factory), mock_metric_client,
+      mock_config_provider, std::move(total_request_counter),
+      std::move(client_error_counter), std::move(server_error_counter));
+  front_end_service.InitMetricInstances();
+
+  AsyncContext<HttpRequest, HttpResponse> http_context;
+  http_context.request = make_shared<HttpRequest>();
+  http_context.request->headers = make_shared<HttpHeaders>();
+  http_context.request->headers->insert(
+      {string(kTransactionOriginHeader), string("origin.com")});
+  http_context.response = make_shared<HttpResponse>();
+
+  string invalid_body("{\"transactions\":{}}");
+  http_context.request->body.bytes =
+      make_shared<vector<Byte>>(invalid_body.begin(), invalid_body.end());
+  http_context.request->body.length = invalid_body.length();
+  EXPECT_THAT(
+      front_end_service.BatchGetTransactionStatus(http_context),
+      ResultIs(FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY)));
+
+  BatchGetTransactionStatusRequest batch_request;
+  for (int i = 0; i < 2; ++i) {
+    GetTransactionStatusRequest transaction;
+    transaction.transaction_id = Uuid::GenerateUuid();
+    transaction.transaction_secret = make_shared<string>("secret");
+    batch_request.transactions.push_back(transaction);
+  }
+  EXPECT_SUCCESS(FrontEndUtils::SerializeBatchGetTransactionStatusRequest(
+      batch_request, http_context.request->body));
+
+  EXPECT_CALL(*mock_transaction_request_router_copy,
+              Execute(An<AsyncContext<GetTransactionStatusRequest,
+                                      GetTransactionStatusResponse>&>()))
+      .WillOnce(
+          [&](AsyncContext<GetTransactionStatusRequest,
+                           GetTransactionStatusResponse>& transaction_context) {
+            EXPECT_EQ(transaction_context.request->transaction_id,
+                      batch_request.transactions[0].transaction_id);
+            EXPECT_EQ(*transaction_context.request->transaction_secret,
+                      "secret");
+            EXPECT_EQ(*transaction_context.request->transaction_origin,
+                      "origin.com");
+            transaction_context.response =
+                make_shared<GetTransactionStatusResponse>();
+            transaction_context.response->transaction_execution_phase =
+                TransactionExecutionPhase::Commit;
+            transaction_context.response->last_execution_timestamp = 1234;
+            transaction_context.result = SuccessExecutionResult();
+            transaction_context.Finish();
+            return SuccessExecutionResult();
+          })
+      .WillOnce(
+          [&](AsyncContext<GetTransactionStatusRequest,
+                           GetTransactionStatusResponse>& transaction_context) {
+            EXPECT_EQ(transaction_context.request->transaction_id,
+                      batch_request.transactions[1].transaction_id);
+            return FailureExecutionResult(1234);
+          });
+
+  atomic<bool> condition = false;
+  http_context.callback = [&](AsyncContext<HttpRequest, HttpResponse>&
+                                  http_context) {
+    EXPECT_SUCCESS(http_context.result);
+    BatchGetTransactionStatusResponse batch_response;
+    EXPECT_SUCCESS(FrontEndUtils::DeserializeBatchGetTransactionStatus(
+        http_context.response->body, batch_response));
+    EXPECT_EQ(batch_response.results.size(), 2);
+    EXPECT_EQ(batch_response.results[0].transaction_id,
+              batch_request.transactions[0].transaction_id);
+    EXPECT_SUCCESS(batch_response.results[0].result);
+    EXPECT_EQ(batch_response.results[0].status.transaction_execution_phase,
+              TransactionExecutionPhase::Commit);
+    EXPECT_EQ(batch_response.results[0].status.last_execution_timestamp, 1234);
+    EXPECT_EQ(batch_response.results[1].transaction_id,
+              batch_request.transactions[1].transaction_id);
+    EXPECT_THAT(batch_response.results[1].result,
+                ResultIs(FailureExecutionResult(1234)));
+    condition = true;
+  };
+  EXPECT_SUCCESS(front_end_service.BatchGetTransactionStatus(http_context));
+  WaitUntil([&]() { return condition.load(); });
+}
+
 TEST_F(FrontEndServiceTest, OnGetTransactionStatusCallback) {
   auto mock_metric_client = make_shared<MockMetricClient>();
   auto mock_config_provider = make_shared<MockConfigProvider>();
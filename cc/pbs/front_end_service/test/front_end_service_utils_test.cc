@@ -20,15 +20,20 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <variant>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "cc/core/common/uuid/src/error_codes.h"
 #include "cc/core/common/uuid/src/uuid.h"
 #include "cc/core/interface/http_types.h"
 #include "cc/core/interface/transaction_manager_interface.h"
 #include "cc/core/interface/type_def.h"
+#include "cc/core/telemetry/mock/in_memory_metric_router.h"
+#include "cc/core/telemetry/src/common/metric_utils.h"
 #include "cc/pbs/front_end_service/src/error_codes.h"
 #include "cc/pbs/front_end_service/src/front_end_utils.h"
+#include "cc/pbs/front_end_service/src/proto/begin_transaction_request.pb.h"
 #include "cc/pbs/interface/type_def.h"
 #include "cc/public/core/interface/execution_result.h"
 #include "cc/public/core/test/interface/execution_result_matchers.h"
@@ -38,8 +43,10 @@ namespace google::scp::pbs::test {
 using ::google::scp::core::Byte;
 using ::google::scp::core::BytesBuffer;
 using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::GetMetricPointData;
 using ::google::scp::core::GetTransactionStatusResponse;
 using ::google::scp::core::HttpHeaders;
+using ::google::scp::core::InMemoryMetricRouter;
 using ::google::scp::core::SuccessExecutionResult;
 using ::google::scp::core::TransactionExecutionPhase;
 using ::google::scp::core::common::Uuid;
@@ -746,6 +753,219 @@ TEST(ParseBeginTransactionTest,
                 core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST));
 }
 
+TEST(ParseBeginTransactionTest, StreamingParserMatchesDocumentParser) {
+  static constexpr char kKeyA[] =
+      R"({"key": "a", "token": 1, "reporting_time": "2021-12-12T17:20:50Z"})";
+  static constexpr char kKeyB[] =
+      R"({"key": "b", "token": 2.7, "reporting_time": "2021-12-12T18:20:50Z"})";
+  std::vector<std::string> begin_transaction_bodies = {
+      "",
+      "null",
+      "[]",
+      R"("1.0")",
+      "{}",
+      R"({"v": "1.0"})",
+      R"({"v": 1.0, "t": []})",
+      R"({"v": ["1.0"], "t": []})",
+      R"({"v": "1.0", "t": null})",
+      R"({"v": "1.0", "t": []} trailing)",
+      R"({"v": "1.0", "t": "abc"})",
+      R"({"v": "1.0", "t": [null]})",
+      R"({"v": "1.0", "t": [[]]})",
+      absl::StrCat(R"({"v": "1.0", "t": [)", kKeyA, ",", kKeyB, "]}"),
+      absl::StrCat(R"({"t": [)", kKeyA, R"(], "v": "1.0", "extra": {"t": 1}})"),
+      absl::StrCat(R"({"v": "1.0", "t": {"x": )", kKeyA, "}}"),
+      absl::StrCat(R"({"v": "1.0", "t": [)", kKeyA, "], \"t\": [", kKeyB,
+                   "]}"),
+      absl::StrCat(R"({"v": "1.0", "t": [)", kKeyA, ",", kKeyA, "]}"),
+      R"({"v": "1.0", "t": [{"key": "a", "token": true,
+          "reporting_time": "2021-12-12T17:20:50Z"}]})",
+      R"({"v": "1.0", "t": [{"key": 1, "token": 1,
+          "reporting_time": "2021-12-12T17:20:50Z"}]})",
+      R"({"v": "1.0", "t": [{"key": "a", "token": "1",
+          "reporting_time": "2021-12-12T17:20:50Z"}]})",
+      R"({"v": "1.0", "t": [{"key": "a", "token": null,
+          "reporting_time": "2021-12-12T17:20:50Z"}]})",
+      R"({"v": "1.0", "t": [{"key": "a", "token": 1, "reporting_time": 5}]})",
+      R"({"v": "1.0", "t": [{"key": "a", "token": 1,
+          "reporting_time": "invalid"}]})",
+      R"({"v": "1.0", "t": [{"key": "a", "token": 1}]})",
+      R"({"v": "1.0", "t": [{"key": "a", "key": "b", "token": 1,
+          "reporting_time": "2021-12-12T17:20:50Z", "extra": [{"key": 1}]}]})",
+      R"({"v": "2.0"})",
+      R"({"v": "2.0", "data": null})",
+      R"({"v": "2.0", "data": []})",
+      R"({"v": "2.0", "data": [1]})",
+      R"({"v": "2.0", "data": [{"reporting_origin": "https://fake.com"}]})",
+      R"({"v": "2.0", "data": [{"keys": []}]})",
+      R"({"v": "2.0", "data": [{"reporting_origin": "", "keys": []}]})",
+      R"({"v": "2.0", "data": [{"reporting_origin": 1, "keys": []}]})",
+      R"({"v": "2.0", "data": [{"reporting_origin": "https://fake.com",
+          "keys": []}]})",
+      R"({"v": "2.0", "data": [{"reporting_origin": "https://fake.com",
+          "keys": null}]})",
+      R"({"v": "2.0", "data": [{"reporting_origin": "https://fake.com",
+          "keys": "abc"}]})",
+      absl::StrCat(R"({"v": "2.0", "data": [{"reporting_origin":
+          "https://other.com", "keys": [)",
+                   kKeyA, "]}]}"),
+      absl::StrCat(R"({"v": "2.0", "data": [{"reporting_origin":
+          "https://a.fake.com", "keys": [)",
+                   kKeyA, ",", kKeyB, R"(]}, {"reporting_origin":
+          "https://b.fake.com", "keys": {"x": )",
+                   kKeyA, "}}]}"),
+      absl::StrCat(R"({"v": "2.0", "data": [{"keys": [)", kKeyA,
+                   R"(], "reporting_origin": "https://a.fake.com"},
+          {"reporting_origin": "https://a.fake.com", "keys": [)",
+                   kKeyB, "]}]}"),
+      absl::StrCat(R"({"v": "2.0", "data": [{"reporting_origin":
+          "https://a.fake.com", "keys": [)",
+                   kKeyA, ",", kKeyA, "]}]}"),
+      absl::StrCat(R"({"v": "2.0", "data": [{"reporting_origin":
+          "https://a.fake.com", "keys": [)",
+                   kKeyA, R"(, {"key": "c", "token": 1}]}]})"),
+      absl::StrCat(R"({"v": "2.0", "data": [{"reporting_origin":
+          "https://a.fake.com", "keys": [)",
+                   kKeyA, R"(, {"key": [], "token": 1,
+          "reporting_time": "2021-12-12T17:20:50Z"}]}]})"),
+      absl::StrCat(R"({"v": "2.0", "data": [{"reporting_origin":
+          "https://a.fake.com", "keys": [)",
+                   kKeyA, R"(, {"key": "c", "token": 1,
+          "reporting_time": "invalid"}]}]})"),
+      R"({"v": "2.0", "data": [{"reporting_origin": "https://fake.com",
+          "keys": [{"key": "a", "token": 1, "reporting_time":
+          "2021-12-12T17:20:50Z"}], "data": {"keys": 1}}], "v": "2.0"})",
+  };
+
+  for (const auto& begin_transaction_body : begin_transaction_bodies) {
+    SCOPED_TRACE(begin_transaction_body);
+    BytesBuffer bytes_buffer(begin_transaction_body);
+
+    std::vector<ConsumeBudgetMetadata> streaming_list;
+    std::vector<ConsumeBudgetMetadata> document_list;
+    EXPECT_EQ(ParseBeginTransactionRequestBody(
+                  kAuthorizedDomain, kTransactionOriginWithSubdomain,
+                  bytes_buffer, streaming_list),
+              ParseBeginTransactionRequestBodyFromDocument(
+                  kAuthorizedDomain, kTransactionOriginWithSubdomain,
+                  bytes_buffer, document_list));
+    EXPECT_EQ(ParseBeginTransactionRequestBody(kAuthorizedDomain, bytes_buffer,
+                                               streaming_list),
+              ParseBeginTransactionRequestBodyFromDocument(
+                  kAuthorizedDomain, bytes_buffer, document_list));
+
+    ASSERT_EQ(streaming_list.size(), document_list.size());
+    for (size_t i = 0; i < streaming_list.size(); ++i) {
+      EXPECT_EQ(*streaming_list[i].budget_key_name,
+                *document_list[i].budget_key_name);
+      EXPECT_EQ(streaming_list[i].token_count, document_list[i].token_count);
+      EXPECT_EQ(streaming_list[i].time_bucket, document_list[i].time_bucket);
+    }
+  }
+}
+
+TEST(ParseBeginTransactionTest, ParseBeginTransactionProtobufV2RequestSuccess) {
+  front_end_service::proto::BeginTransactionRequestBody transaction_request;
+  transaction_request.set_version("2.0");
+  auto* reporting_origin_keys = transaction_request.add_data();
+  reporting_origin_keys->set_reporting_origin("http://a.fake.com");
+  auto* budget_key = reporting_origin_keys->add_keys();
+  budget_key->set_key("123");
+  budget_key->set_token(1);
+  budget_key->mutable_reporting_time()->set_seconds(1576048850);
+  reporting_origin_keys = transaction_request.add_data();
+  reporting_origin_keys->set_reporting_origin("http://b.fake.com");
+  budget_key = reporting_origin_keys->add_keys();
+  budget_key->set_key("456");
+  budget_key->set_token(2);
+  budget_key->mutable_reporting_time()->set_seconds(1576135250);
+  BytesBuffer bytes_buffer(transaction_request.SerializeAsString());
+
+  auto headers = std::make_shared<HttpHeaders>();
+  headers->insert({kContentTypeHeader, "Application/X-Protobuf; proto=pbs"});
+  std::vector<ConsumeBudgetMetadata> consume_budget_metadata_list;
+  EXPECT_SUCCESS(ParseBeginTransactionRequestBody(
+      kAuthorizedDomain, kTransactionOriginWithoutSubdomain, headers,
+      bytes_buffer, consume_budget_metadata_list));
+  ASSERT_EQ(consume_budget_metadata_list.size(), 2);
+  EXPECT_EQ(*consume_budget_metadata_list[0].budget_key_name,
+            "http://a.fake.com/123");
+  EXPECT_EQ(consume_budget_metadata_list[0].token_count, 1);
+  EXPECT_EQ(consume_budget_metadata_list[0].time_bucket, 1576048850000000000);
+  EXPECT_EQ(*consume_budget_metadata_list[1].budget_key_name,
+            "http://b.fake.com/456");
+  EXPECT_EQ(consume_budget_metadata_list[1].token_count, 2);
+  EXPECT_EQ(consume_budget_metadata_list[1].time_bucket, 1576135250000000000);
+
+  // Without the protobuf content type, the body is decoded as JSON.
+  headers->clear();
+  consume_budget_metadata_list.clear();
+  EXPECT_THAT(
+      ParseBeginTransactionRequestBody(
+          kAuthorizedDomain, kTransactionOriginWithoutSubdomain, headers,
+          bytes_buffer, consume_budget_metadata_list),
+      ResultIs(FailureExecutionResult(
+          core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY)));
+}
+
+TEST(ParseBeginTransactionTest, ParseBeginTransactionProtobufRequestFailures) {
+  auto add_budget_key =
+      [](front_end_service::proto::ReportingOriginBudgetKeys& keys,
+         uint32_t token) {
+        auto* budget_key = keys.add_keys();
+        budget_key->set_key("123");
+        budget_key->set_token(token);
+        budget_key->mutable_reporting_time()->set_seconds(1576048850);
+        return budget_key;
+      };
+  auto invalid_request_body = FailureExecutionResult(
+      core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST_BODY);
+  auto parse = [](const std::string& body) {
+    std::vector<ConsumeBudgetMetadata> consume_budget_metadata_list;
+    return ParseBeginTransactionRequestBodyFromProto(
+        kAuthorizedDomain, kTransactionOriginWithoutSubdomain,
+        BytesBuffer(body), consume_budget_metadata_list);
+  };
+
+  EXPECT_THAT(parse("{\"v\": \"2.0\"}"),
+              ResultIs(invalid_request_body));
+
+  front_end_service::proto::BeginTransactionRequestBody transaction_request;
+  transaction_request.set_version("2.0");
+  EXPECT_THAT(parse(transaction_request.SerializeAsString()),
+              ResultIs(invalid_request_body));
+
+  auto* reporting_origin_keys = transaction_request.add_data();
+  reporting_origin_keys->set_reporting_origin("https://other.com");
+  add_budget_key(*reporting_origin_keys, 1);
+  EXPECT_THAT(
+      parse(transaction_request.SerializeAsString()),
+      ResultIs(FailureExecutionResult(
+          core::errors::
+              SC_PBS_FRONT_END_SERVICE_REPORTING_ORIGIN_NOT_BELONG_TO_SITE)));
+
+  reporting_origin_keys->set_reporting_origin("https://a.fake.com");
+  reporting_origin_keys->mutable_keys(0)->set_token(256);
+  EXPECT_THAT(parse(transaction_request.SerializeAsString()),
+              ResultIs(invalid_request_body));
+
+  reporting_origin_keys->mutable_keys(0)->set_token(1);
+  reporting_origin_keys->mutable_keys(0)->clear_reporting_time();
+  EXPECT_THAT(parse(transaction_request.SerializeAsString()),
+              ResultIs(invalid_request_body));
+
+  reporting_origin_keys->clear_keys();
+  add_budget_key(*reporting_origin_keys, 1);
+  add_budget_key(*reporting_origin_keys, 1);
+  EXPECT_THAT(parse(transaction_request.SerializeAsString()),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REQUEST)));
+
+  reporting_origin_keys->clear_keys();
+  add_budget_key(*reporting_origin_keys, 1);
+  EXPECT_SUCCESS(parse(transaction_request.SerializeAsString()));
+}
+
 TEST(FrontEndUtilsTest, ExtractTransactionId) {
   auto headers = std::make_shared<HttpHeaders>();
   Uuid transaction_id;
@@ -1309,4 +1529,84 @@ TEST(TransformReportingOriginToSite, InvalidSite) {
           core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REPORTING_ORIGIN)));
 }
 
+
+// The value of the counter, 0 if it was never added to.
+int64_t GetCounterValue(const InMemoryMetricRouter& metric_router,
+                        absl::string_view name) {
+  auto data = metric_router.GetExportedData();
+  auto point_data = GetMetricPointData(
+      name, opentelemetry::sdk::common::OrderedAttributeMap(), data);
+  if (!point_data.has_value()) {
+    return 0;
+  }
+  return std::get<int64_t>(
+      std::get<opentelemetry::sdk::metrics::SumPointData>(*point_data).value_);
+}
+
+TEST(ReportingOriginToSiteCache, RepeatedOriginIsServedFromTheCache) {
+  // Installs the global MeterProvider, before the cache is constructed.
+  InMemoryMetricRouter metric_router;
+  ReportingOriginToSiteCache cache;
+
+  auto site = cache.TransformReportingOriginToSite("https://a.google.com");
+  EXPECT_SUCCESS(site.result());
+  EXPECT_EQ(*site, "https://google.com");
+  site = cache.TransformReportingOriginToSite("https://a.google.com");
+  EXPECT_SUCCESS(site.result());
+  EXPECT_EQ(*site, "https://google.com");
+
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(GetCounterValue(metric_router,
+                            kMetricNameReportingOriginSiteCacheHits),
+            1);
+  EXPECT_EQ(GetCounterValue(metric_router,
+                            kMetricNameReportingOriginSiteCacheMisses),
+            1);
+}
+
+TEST(ReportingOriginToSiteCache, OriginWithoutSiteIsNotCached) {
+  InMemoryMetricRouter metric_router;
+  ReportingOriginToSiteCache cache;
+
+  for (int i = 0; i < 2; ++i) {
+    auto site = cache.TransformReportingOriginToSite("******");
+    EXPECT_THAT(
+        site.result(),
+        ResultIs(FailureExecutionResult(
+            core::errors::SC_PBS_FRONT_END_SERVICE_INVALID_REPORTING_ORIGIN)));
+  }
+
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(GetCounterValue(metric_router,
+                            kMetricNameReportingOriginSiteCacheHits),
+            0);
+  EXPECT_EQ(GetCounterValue(metric_router,
+                            kMetricNameReportingOriginSiteCacheMisses),
+            2);
+}
+
+TEST(ReportingOriginToSiteCache, FullCacheStartsOver) {
+  ReportingOriginToSiteCache cache;
+  for (size_t i = 0;
+       i < ReportingOriginToSiteCache::kMaxCachedReportingOriginSites; ++i) {
+    auto site = cache.TransformReportingOriginToSite(
+        absl::StrCat("https://a", i, ".fake.com"));
+    EXPECT_SUCCESS(site.result());
+    EXPECT_EQ(*site, "https://fake.com");
+  }
+  EXPECT_EQ(cache.Size(),
+            ReportingOriginToSiteCache::kMaxCachedReportingOriginSites);
+
+  auto site = cache.TransformReportingOriginToSite("https://a.google.com");
+  EXPECT_SUCCESS(site.result());
+  EXPECT_EQ(*site, "https://google.com");
+  EXPECT_EQ(cache.Size(), 1);
+
+  // The origins cleared from the cache are transformed again.
+  site = cache.TransformReportingOriginToSite("https://a0.fake.com");
+  EXPECT_SUCCESS(site.result());
+  EXPECT_EQ(*site, "https://fake.com");
+  EXPECT_EQ(cache.Size(), 2);
+}
+
 }  // namespace google::scp::pbs::test
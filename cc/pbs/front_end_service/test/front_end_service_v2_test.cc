@@ -694,6 +694,83 @@ TEST(FrontEndServiceV2Test, TestPrepareTransactionBudgetExhausted) {
   EXPECT_THAT(mock_aggregate_metric->GetCounter(kMetricLabelValueOperator), 1);
 }
 
+TEST(FrontEndServiceV2Test, TestPrepareTransactionShedAboveConcurrencyLimit) {
+  auto budget_consumption_helper =
+      std::make_unique<MockBudgetConsumptionHelper>();
+  auto mock_config_provider = std::make_shared<MockConfigProvider>();
+  mock_config_provider->Set(kRemotePrivacyBudgetServiceClaimedIdentity, "123");
+  mock_config_provider->SetBool(kPBSFrontEndAdmissionControlEnabled, true);
+  mock_config_provider->SetInt(kPBSFrontEndAdmissionControlInitialLimit, 1);
+  mock_config_provider->SetInt(kPBSFrontEndAdmissionControlMinLimit, 1);
+  mock_config_provider->SetInt(kPBSFrontEndAdmissionControlMaxLimit, 1);
+  FrontEndServiceV2PeerOptions options;
+  options.budget_consumption_helper = budget_consumption_helper.get();
+  options.config_provider = mock_config_provider;
+
+  FrontEndServiceV2Peer front_end_service_v2_peer =
+      MakeFrontEndServiceV2Peer(options);
+  ASSERT_TRUE(front_end_service_v2_peer.Init());
+
+  auto make_http_context = [] {
+    AsyncContext<HttpRequest, HttpResponse> http_context;
+    http_context.request = std::make_shared<HttpRequest>();
+    http_context.request->body.bytes = std::make_shared<std::vector<Byte>>(
+        kRequestBody.begin(), kRequestBody.end());
+    http_context.request->body.capacity = kRequestBody.length();
+    http_context.request->body.length = kRequestBody.length();
+    InsertCommonHeaders(kTransactionId, kTransactionSecret, kReportingOrigin,
+                        http_context);
+    http_context.response = CreateEmptyResponse();
+    http_context.callback = [](AsyncContext<HttpRequest, HttpResponse>&) {};
+    return http_context;
+  };
+
+  // The first request stays in flight until its budgets are consumed.
+  AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>
+      in_flight_consume_budgets_context;
+  EXPECT_CALL(*budget_consumption_helper, ConsumeBudgets)
+      .Times(2)
+      .WillRepeatedly(
+          [&](AsyncContext<ConsumeBudgetsRequest, ConsumeBudgetsResponse>
+                  context) {
+            in_flight_consume_budgets_context = context;
+            return SuccessExecutionResult();
+          });
+
+  auto http_context = make_http_context();
+  EXPECT_TRUE(front_end_service_v2_peer.PrepareTransaction(http_context));
+
+  http_context = make_http_context();
+  EXPECT_EQ(front_end_service_v2_peer.PrepareTransaction(http_context),
+            core::RetryExecutionResult(
+                core::errors::SC_PBS_FRONT_END_SERVICE_REQUEST_SHED));
+
+  in_flight_consume_budgets_context.result = SuccessExecutionResult();
+  in_flight_consume_budgets_context.Finish();
+
+  http_context = make_http_context();
+  EXPECT_TRUE(front_end_service_v2_peer.PrepareTransaction(http_context));
+
+  std::vector<opentelemetry::sdk::metrics::ResourceMetrics> data =
+      options.metric_router->GetExportedData();
+  const std::map<std::string, std::string> prepare_transaction_label_kv = {
+      {kMetricLabelTransactionPhase, kMetricLabelPrepareTransaction},
+      {kMetricLabelKeyReportingOrigin, kMetricLabelValueOperator},
+  };
+  const opentelemetry::sdk::common::OrderedAttributeMap dimensions(
+      (opentelemetry::common::KeyValueIterableView<
+          std::map<std::string, std::string>>(prepare_transaction_label_kv)));
+  std::optional<opentelemetry::sdk::metrics::PointType>
+      shed_request_metric_point_data = core::GetMetricPointData(
+          kMetricNameAdmissionControlShedRequests, dimensions, data);
+  ASSERT_TRUE(shed_request_metric_point_data.has_value());
+  EXPECT_EQ(std::get<int64_t>(
+                std::get<opentelemetry::sdk::metrics::SumPointData>(
+                    shed_request_metric_point_data.value())
+                    .value_),
+            1);
+}
+
 TEST(FrontEndServiceV2Test, TestCommitTransaction) {
   auto budget_consumption_helper =
       std::make_unique<MockBudgetConsumptionHelper>();
@@ -0,0 +1,90 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/front_end_service/src/request_stage_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "cc/core/config_provider/mock/mock_config_provider.h"
+#include "cc/core/telemetry/mock/in_memory_metric_router.h"
+#include "cc/core/telemetry/src/common/metric_utils.h"
+#include "cc/public/core/test/interface/execution_result_matchers.h"
+
+namespace google::scp::pbs {
+namespace {
+
+using ::google::scp::core::GetMetricPointData;
+using ::google::scp::core::InMemoryMetricRouter;
+using ::google::scp::core::config_provider::mock::MockConfigProvider;
+using ::std::chrono::milliseconds;
+
+opentelemetry::sdk::common::OrderedAttributeMap GetStageDimensions(
+    RequestStage stage) {
+  const std::map<std::string, std::string> label_kv = {
+      {std::string(kRequestStageLabel),
+       std::string(RequestStageToString(stage))}};
+  return opentelemetry::sdk::common::OrderedAttributeMap(
+      opentelemetry::common::KeyValueIterableView<
+          std::map<std::string, std::string>>(label_kv));
+}
+
+TEST(RequestStageMetricsTest, RecordsStageHistograms) {
+  auto metric_router = std::make_shared<InMemoryMetricRouter>();
+  RequestStageMetrics metrics(metric_router,
+                              std::make_shared<MockConfigProvider>());
+  EXPECT_SUCCESS(metrics.Init());
+
+  metrics.Record(RequestStage::kSpannerCommit, milliseconds(20));
+  metrics.Record(RequestStage::kSpannerCommit, milliseconds(30));
+  metrics.Record(RequestStage::kParse, milliseconds(1));
+
+  auto data = metric_router->GetExportedData();
+  auto commit_point_data =
+      GetMetricPointData(kRequestStageDurationMetric,
+                         GetStageDimensions(RequestStage::kSpannerCommit),
+                         data);
+  ASSERT_TRUE(commit_point_data.has_value());
+  auto commit_histogram =
+      std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+          commit_point_data.value());
+  EXPECT_EQ(commit_histogram.count_, 2);
+  EXPECT_DOUBLE_EQ(std::get<double>(commit_histogram.sum_), 0.05);
+
+  auto parse_point_data = GetMetricPointData(
+      kRequestStageDurationMetric, GetStageDimensions(RequestStage::kParse),
+      data);
+  ASSERT_TRUE(parse_point_data.has_value());
+  EXPECT_EQ(std::get<opentelemetry::sdk::metrics::HistogramPointData>(
+                parse_point_data.value())
+                .count_,
+            1);
+
+  EXPECT_FALSE(GetMetricPointData(kRequestStageDurationMetric,
+                                  GetStageDimensions(RequestStage::kAuth), data)
+                   .has_value());
+}
+
+TEST(RequestStageMetricsTest, RecordsNothingWithoutMetricRouter) {
+  RequestStageMetrics metrics(nullptr, std::make_shared<MockConfigProvider>());
+  EXPECT_SUCCESS(metrics.Init());
+  metrics.Record(RequestStage::kConsume, milliseconds(2));
+}
+
+}  // namespace
+}  // namespace google::scp::pbs
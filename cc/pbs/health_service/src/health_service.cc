@@ -47,6 +47,7 @@ using google::scp::core::HttpHandler;
 using google::scp::core::HttpMethod;
 using google::scp::core::HttpRequest;
 using google::scp::core::HttpResponse;
+using google::scp::core::HttpRoutePriority;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::TimeProvider;
@@ -128,7 +129,8 @@ ExecutionResult HealthService::Init() noexcept {
       bind(&HealthService::CheckHealth, this, _1);
   string resource_path("/health");
   http_server_->RegisterResourceHandler(HttpMethod::GET, resource_path,
-                                        check_health_handler);
+                                        check_health_handler,
+                                        HttpRoutePriority::ControlPlane);
 
   if (PerformMemoryAndStorageUsageCheck()) {
     SCP_DEBUG(kServiceName, kZeroUuid,
@@ -24,6 +24,7 @@
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/async_context.h"
 #include "core/interface/checkpoint_service_interface.h"
+#include "core/interface/journal_service_interface.h"
 #include "core/interface/service_interface.h"
 #include "core/interface/transaction_protocol_interface.h"
 
@@ -341,5 +342,18 @@ class BudgetKeyInterface : public core::ServiceInterface {
   virtual core::ExecutionResult Checkpoint(
       std::shared_ptr<std::list<core::CheckpointLog>>&
           checkpoint_logs) noexcept = 0;
+
+  /**
+   * @brief Creates a checkpoint of the budget key only if it changed since the
+   * recovered checkpoint, to be replayed on top of that checkpoint.
+   *
+   * @param recovered_components The components of the recovered logs.
+   * @param checkpoint_logs The vector of checkpoint metadata.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult CheckpointDelta(
+      const core::JournalRecoveredComponents& recovered_components,
+      std::shared_ptr<std::list<core::CheckpointLog>>&
+          checkpoint_logs) noexcept = 0;
 };
 }  // namespace google::scp::pbs
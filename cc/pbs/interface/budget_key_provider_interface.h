@@ -22,6 +22,7 @@
 
 #include "core/interface/async_context.h"
 #include "core/interface/checkpoint_service_interface.h"
+#include "core/interface/journal_service_interface.h"
 #include "core/interface/service_interface.h"
 
 #include "budget_key_interface.h"
@@ -68,5 +69,34 @@ class BudgetKeyProviderInterface : public core::ServiceInterface {
   virtual core::ExecutionResult Checkpoint(
       std::shared_ptr<std::list<core::CheckpointLog>>&
           checkpoint_logs) noexcept = 0;
+
+  /**
+   * @brief Creates a checkpoint of only the budget keys that changed since the
+   * recovered checkpoint, to be replayed on top of that checkpoint.
+   *
+   * @param recovered_components The components of the recovered logs.
+   * @param checkpoint_logs The vector of checkpoint logs.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult CheckpointDelta(
+      const core::JournalRecoveredComponents& recovered_components,
+      std::shared_ptr<std::list<core::CheckpointLog>>&
+          checkpoint_logs) noexcept = 0;
+
+  /**
+   * @brief Returns the number of budget keys currently cached in memory.
+   *
+   * @return size_t The approximate count of the cached budget keys.
+   */
+  virtual size_t GetCachedBudgetKeysCount() noexcept = 0;
+
+  /**
+   * @brief Scales the capacity and the lifetime of the cached budget keys
+   * down under memory pressure.
+   *
+   * @param resource_scale The scale, in (0, 1]. 1 restores the configured
+   * capacity and lifetime.
+   */
+  virtual void SetResourceScale(double resource_scale) noexcept = 0;
 };
 }  // namespace google::scp::pbs
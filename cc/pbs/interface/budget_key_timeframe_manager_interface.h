@@ -17,12 +17,21 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "core/common/auto_expiry_concurrent_map/src/auto_expiry_concurrent_map.h"
+#include "core/common/concurrent_map/src/error_codes.h"
+#include "core/interface/async_context.h"
 #include "core/interface/checkpoint_service_interface.h"
 #include "pbs/interface/budget_key_interface.h"
 #include "pbs/interface/type_def.h"
@@ -38,7 +47,8 @@ struct BudgetKeyTimeframe {
       : time_bucket_index(time_bucket_index),
         token_count(0),
         active_transaction_id(core::common::kZeroUuid),
-        active_token_count(0) {}
+        active_token_count(0),
+        reserving_transaction_count(0) {}
 
   /// This is hour index of time bucket within time group
   const TimeBucket time_bucket_index;
@@ -54,8 +64,234 @@ struct BudgetKeyTimeframe {
    * the value that is proposed by the transaction.
    */
   std::atomic<TokenCount> active_token_count;
+
+  /**
+   * @brief The number of transactions holding tokens reserved from
+   * token_count. A transaction can only set active_transaction_id while there
+   * is none, and can only reserve tokens while active_transaction_id is not
+   * set.
+   */
+  std::atomic<uint32_t> reserving_transaction_count;
+};
+
+/// The number of hourly timeframes of a time group.
+static constexpr TimeBucket kBudgetKeyTimeframesPerGroup = 24;
+
+/// The assumed cache line size, used to keep the timeframes apart.
+static constexpr size_t kBudgetKeyTimeframeCacheLineSize = 64;
+
+/**
+ * @brief The timeframes of a time group, by hour index. Has the Insert, Find,
+ * Erase and Keys semantics of core::common::ConcurrentMap, over a single
+ * allocation of one cache line per hour instead of a hash map of separately
+ * allocated timeframes.
+ *
+ * The slots are allocated on the first insert and a timeframe is constructed
+ * in its slot the first time its hour is inserted. The returned pointers share
+ * the ownership of all the slots, and an erased then inserted hour reuses its
+ * slot, so the holders of the erased timeframe see the inserted values.
+ *
+ * Hour indexes past kBudgetKeyTimeframesPerGroup have no slot: they are never
+ * found and cannot be inserted.
+ */
+class BudgetKeyTimeframeArray {
+ public:
+  BudgetKeyTimeframeArray() = default;
+  BudgetKeyTimeframeArray(const BudgetKeyTimeframeArray&) = delete;
+  BudgetKeyTimeframeArray& operator=(const BudgetKeyTimeframeArray&) = delete;
+
+  /**
+   * @brief Inserts a timeframe with the values of key_value.second, or zeroed
+   * ones if it is null.
+   *
+   * @param key_value The hour index and the timeframe to copy.
+   * @param out_value Set to the inserted timeframe, or to the existing one if
+   * the hour is already present.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult Insert(
+      std::pair<TimeBucket, std::shared_ptr<BudgetKeyTimeframe>> key_value,
+      std::shared_ptr<BudgetKeyTimeframe>& out_value) noexcept {
+    auto time_bucket = key_value.first;
+    if (time_bucket >= kBudgetKeyTimeframesPerGroup) {
+      return core::FailureExecutionResult(
+          core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
+    }
+
+    if (slots_.load(std::memory_order_acquire) == nullptr) {
+      std::call_once(slots_allocated_, [this]() {
+        slots_owner_ = std::shared_ptr<Slot[]>(
+            new Slot[static_cast<size_t>(kBudgetKeyTimeframesPerGroup)]);
+        slots_.store(slots_owner_.get(), std::memory_order_release);
+      });
+    }
+
+    auto& slot = slots_.load(std::memory_order_acquire)[time_bucket];
+    auto state = slot.state.load(std::memory_order_acquire);
+    while (true) {
+      if (state == SlotState::Present) {
+        out_value = GetTimeframe(slot);
+        return core::FailureExecutionResult(
+            core::errors::SC_CONCURRENT_MAP_ENTRY_ALREADY_EXISTS);
+      }
+      if (state == SlotState::Initializing) {
+        std::this_thread::yield();
+        state = slot.state.load(std::memory_order_acquire);
+        continue;
+      }
+      if (slot.state.compare_exchange_weak(state, SlotState::Initializing,
+                                           std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+
+    if (state == SlotState::Unconstructed) {
+      new (slot.storage) BudgetKeyTimeframe(time_bucket);
+    }
+
+    auto* timeframe = slot.Get();
+    if (key_value.second) {
+      const auto& source = *key_value.second;
+      timeframe->token_count = source.token_count.load();
+      timeframe->active_transaction_id = source.active_transaction_id.load();
+      timeframe->active_token_count = source.active_token_count.load();
+      timeframe->reserving_transaction_count =
+          source.reserving_transaction_count.load();
+    } else {
+      timeframe->token_count = 0;
+      timeframe->active_transaction_id = core::common::kZeroUuid;
+      timeframe->active_token_count = 0;
+      timeframe->reserving_transaction_count = 0;
+    }
+    slot.state.store(SlotState::Present, std::memory_order_release);
+
+    out_value = GetTimeframe(slot);
+    return core::SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Finds the timeframe of an hour index.
+   *
+   * @param time_bucket The hour index.
+   * @param out_value Set to the timeframe if found.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult Find(
+      const TimeBucket& time_bucket,
+      std::shared_ptr<BudgetKeyTimeframe>& out_value) noexcept {
+    auto* slot = GetSlot(time_bucket);
+    if (slot == nullptr ||
+        LoadSettledState(*slot) != SlotState::Present) {
+      return core::FailureExecutionResult(
+          core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
+    }
+
+    out_value = GetTimeframe(*slot);
+    return core::SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Erases the timeframe of an hour index.
+   *
+   * @param time_bucket The hour index.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult Erase(const TimeBucket& time_bucket) noexcept {
+    auto* slot = GetSlot(time_bucket);
+    if (slot != nullptr) {
+      auto state = LoadSettledState(*slot);
+      while (state == SlotState::Present) {
+        if (slot->state.compare_exchange_weak(state, SlotState::Erased,
+                                              std::memory_order_acq_rel)) {
+          return core::SuccessExecutionResult();
+        }
+        if (state == SlotState::Initializing) {
+          state = LoadSettledState(*slot);
+        }
+      }
+    }
+
+    return core::FailureExecutionResult(
+        core::errors::SC_CONCURRENT_MAP_ENTRY_DOES_NOT_EXIST);
+  }
+
+  /**
+   * @brief Returns the present hour indexes, in increasing order.
+   *
+   * @param time_buckets Cleared then set to the hour indexes.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult Keys(std::vector<TimeBucket>& time_buckets) noexcept {
+    time_buckets.clear();
+    auto* slots = slots_.load(std::memory_order_acquire);
+    if (slots == nullptr) {
+      return core::SuccessExecutionResult();
+    }
+
+    for (TimeBucket i = 0; i < kBudgetKeyTimeframesPerGroup; ++i) {
+      if (LoadSettledState(slots[i]) == SlotState::Present) {
+        time_buckets.push_back(i);
+      }
+    }
+    return core::SuccessExecutionResult();
+  }
+
+ private:
+  enum class SlotState : uint8_t {
+    /// No timeframe was ever constructed in the slot.
+    Unconstructed = 0,
+    /// A timeframe is being constructed or reset in the slot.
+    Initializing = 1,
+    Present = 2,
+    /// The slot holds the timeframe of an erased hour.
+    Erased = 3,
+  };
+
+  // Erasing a slot does not destroy its timeframe, the pointers handed out
+  // may still be dereferenced.
+  static_assert(std::is_trivially_destructible_v<BudgetKeyTimeframe>);
+
+  struct alignas(kBudgetKeyTimeframeCacheLineSize) Slot {
+    BudgetKeyTimeframe* Get() noexcept {
+      return std::launder(reinterpret_cast<BudgetKeyTimeframe*>(storage));
+    }
+
+    std::atomic<SlotState> state{SlotState::Unconstructed};
+    alignas(BudgetKeyTimeframe) unsigned char storage[sizeof(
+        BudgetKeyTimeframe)];
+  };
+
+  Slot* GetSlot(TimeBucket time_bucket) noexcept {
+    auto* slots = slots_.load(std::memory_order_acquire);
+    if (slots == nullptr || time_bucket >= kBudgetKeyTimeframesPerGroup) {
+      return nullptr;
+    }
+    return &slots[time_bucket];
+  }
+
+  /// Waits out a concurrent insert of the slot.
+  static SlotState LoadSettledState(Slot& slot) noexcept {
+    auto state = slot.state.load(std::memory_order_acquire);
+    while (state == SlotState::Initializing) {
+      std::this_thread::yield();
+      state = slot.state.load(std::memory_order_acquire);
+    }
+    return state;
+  }
+
+  std::shared_ptr<BudgetKeyTimeframe> GetTimeframe(Slot& slot) noexcept {
+    return std::shared_ptr<BudgetKeyTimeframe>(slots_owner_, slot.Get());
+  }
+
+  /// Set once on the first insert, before slots_ is published.
+  std::shared_ptr<Slot[]> slots_owner_;
+  std::atomic<Slot*> slots_{nullptr};
+  std::once_flag slots_allocated_;
 };
 
+struct LoadBudgetKeyTimeframeRequest;
+struct LoadBudgetKeyTimeframeResponse;
+
 /**
  * @brief Responsible to keep the time_groups info.
  */
@@ -66,9 +302,30 @@ struct BudgetKeyTimeframeGroup : public core::LoadableObject {
   /// This is date/time in Timestamp floor to the nearest month.
   const TimeGroup time_group;
 
-  /// A map between the budget keys and time groups.
-  core::common::ConcurrentMap<TimeBucket, std::shared_ptr<BudgetKeyTimeframe>>
-      budget_key_timeframes;
+  /// The timeframes of the time group by hour index.
+  BudgetKeyTimeframeArray budget_key_timeframes;
+
+  /// The serialized timeframes of a group recovered lazily. They are parsed
+  /// into budget_key_timeframes on the first access, and reset then.
+  std::shared_ptr<const std::string> serialized_timeframes;
+
+  /// Whether serialized_timeframes is still to be parsed.
+  std::atomic<bool> has_serialized_timeframes{false};
+
+  /// Guards serialized_timeframes.
+  std::mutex serialized_timeframes_mutex;
+
+  /// The loads waiting for the load of the group in flight to complete.
+  std::vector<core::AsyncContext<LoadBudgetKeyTimeframeRequest,
+                                 LoadBudgetKeyTimeframeResponse>>
+      pending_load_contexts;
+
+  /// Guards pending_load_contexts.
+  std::mutex pending_load_contexts_mutex;
+
+  /// The steady clock time, in nanoseconds, until which the group is known to
+  /// be missing from the database. Zero if not known.
+  std::atomic<core::Timestamp> record_not_found_expiry{0};
 };
 
 /// The request object to load budget key frame(s).
@@ -110,6 +367,60 @@ struct UpdateBudgetKeyTimeframeRequest {
 /// The response object after a budget key timeframe has been updated.
 struct UpdateBudgetKeyTimeframeResponse {};
 
+/// Tokens of a budget key timeframe to reserve.
+struct BudgetKeyTimeframeReservationInfo {
+  /// Timebucket of the reporting timestamp to reserve the tokens of.
+  core::Timestamp reporting_time = 0;
+  /// The number of tokens to reserve.
+  TokenCount token_count = 0;
+};
+
+/// The request object to reserve tokens of budget key timeframe(s).
+struct ReserveBudgetKeyTimeframeRequest {
+  /// The transaction the tokens are reserved for.
+  core::common::Uuid transaction_id = core::common::kZeroUuid;
+  /// Time frame(s) to reserve tokens of.
+  /// Time frame(s) must point to unique time buckets of one time group.
+  std::vector<BudgetKeyTimeframeReservationInfo> timeframes_to_reserve;
+};
+
+/// The outcome of a reservation operation.
+enum class BudgetKeyTimeframeReservationStatus {
+  /// The operation was applied and journaled, or already was.
+  Done = 0,
+  /// A timeframe is held through its active transaction id, or a previous
+  /// attempt on the same transaction is still in progress. The operation can
+  /// be retried.
+  Conflict = 1,
+  /// A timeframe does not have the tokens to reserve.
+  InsufficientBudget = 2,
+};
+
+/// The response object after tokens of budget key timeframe(s) have been
+/// reserved.
+struct ReserveBudgetKeyTimeframeResponse {
+  BudgetKeyTimeframeReservationStatus status =
+      BudgetKeyTimeframeReservationStatus::Done;
+  /// The indices in timeframes_to_reserve that do not have the tokens, if the
+  /// status is InsufficientBudget.
+  std::vector<size_t> insufficient_budget_indices;
+};
+
+/// The request object to release the tokens reserved by a transaction.
+struct ReleaseBudgetKeyTimeframeRequest {
+  /// The transaction the tokens were reserved for.
+  core::common::Uuid transaction_id = core::common::kZeroUuid;
+  /// Whether the reserved tokens are given back to the timeframes, i.e. the
+  /// transaction is aborted, rather than consumed.
+  bool return_tokens = false;
+};
+
+/// The response object after the reserved tokens have been released.
+struct ReleaseBudgetKeyTimeframeResponse {
+  BudgetKeyTimeframeReservationStatus status =
+      BudgetKeyTimeframeReservationStatus::Done;
+};
+
 /**
  * @brief Is responsible to load key time frame related into from the undelying
  * storage for any specific keys.
@@ -153,6 +464,37 @@ class BudgetKeyTimeframeManagerInterface : public core::ServiceInterface {
                          UpdateBudgetKeyTimeframeResponse>&
           update_budget_key_timeframe_context) noexcept = 0;
 
+  /**
+   * @brief Reserves tokens of budget key timeframe(s) for a transaction by
+   * taking them off the token counts, without holding the timeframes through
+   * their active transaction id. Several transactions can so reserve tokens
+   * of the same timeframe as long as it has enough tokens for all of them.
+   * The reservation is journaled before the operation completes, and
+   * reserving again for the same transaction is a no-op.
+   *
+   * @param reserve_budget_key_timeframe_context The context of the reserve
+   * budget key timeframe operation.
+   * @return core::ExecutionResult the execution result of the operation.
+   */
+  virtual core::ExecutionResult Reserve(
+      core::AsyncContext<ReserveBudgetKeyTimeframeRequest,
+                         ReserveBudgetKeyTimeframeResponse>&
+          reserve_budget_key_timeframe_context) noexcept = 0;
+
+  /**
+   * @brief Releases the tokens reserved by a transaction, either consuming
+   * them or giving them back. The release is journaled before the operation
+   * completes, and releasing a transaction without reservation is a no-op.
+   *
+   * @param release_budget_key_timeframe_context The context of the release
+   * budget key timeframe operation.
+   * @return core::ExecutionResult the execution result of the operation.
+   */
+  virtual core::ExecutionResult Release(
+      core::AsyncContext<ReleaseBudgetKeyTimeframeRequest,
+                         ReleaseBudgetKeyTimeframeResponse>&
+          release_budget_key_timeframe_context) noexcept = 0;
+
   /**
    * @brief Returns the id of the current budget key timeframe manager.
    *
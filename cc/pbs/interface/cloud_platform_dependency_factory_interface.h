@@ -128,8 +128,8 @@ class CloudPlatformDependencyFactoryInterface
   virtual std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
   ConstructBudgetConsumptionHelper(
       google::scp::core::AsyncExecutorInterface* async_executor,
-      google::scp::core::AsyncExecutorInterface*
-          io_async_executor) noexcept = 0;
+      google::scp::core::AsyncExecutorInterface* io_async_executor,
+      std::shared_ptr<core::MetricRouter> metric_router) noexcept = 0;
   /**
    * @brief Create a Instance Authorizer object for Instance Metadata client.
    *
@@ -22,14 +22,228 @@
 namespace google::scp::pbs {
 static constexpr char kTotalHttp2ServerThreadsCount[] =
     "google_scp_core_http2server_threads_count";
+// The number of listeners the http server binds to its port with SO_REUSEPORT,
+// sharing out the http server threads. 1, the default, binds one listener.
+static constexpr char kHttp2ServerListenerCount[] =
+    "google_scp_pbs_http2_server_listener_count";
+// The HTTP/2 SETTINGS the http server sends on its connections. The max
+// concurrent streams default to 10000, and zero keeps the default of nghttp2
+// for the initial window size and the header table size, in bytes.
+static constexpr char kHttp2ServerMaxConcurrentStreams[] =
+    "google_scp_pbs_http2_server_max_concurrent_streams";
+static constexpr char kHttp2ServerInitialWindowSize[] =
+    "google_scp_pbs_http2_server_initial_window_size";
+static constexpr char kHttp2ServerHeaderTableSize[] =
+    "google_scp_pbs_http2_server_header_table_size";
 static constexpr char kServiceMetricsNamespace[] =
     "google_scp_pbs_metrics_namespace";
 static constexpr char kServiceMetricsBatchPush[] =
     "google_scp_pbs_metrics_batch_push_enabled";
 static constexpr char kServiceMetricsBatchTimeDurationMs[] =
     "google_scp_pbs_metrics_batch_time_duration_ms";
+static constexpr char kServiceMetricsBatchAggregation[] =
+    "google_scp_pbs_metrics_batch_aggregation_enabled";
+// Optional. The max number of metric push requests to the cloud in flight at
+// once, beyond which pushes are dropped. Unlimited if not set. Only used on
+// GCP.
+static constexpr char kServiceMetricsMaxInFlightRequests[] =
+    "google_scp_pbs_metrics_max_in_flight_requests";
 static constexpr char kBudgetKeyTableName[] =
     "google_scp_pbs_budget_key_table_name";
+// The format the token counts of a budget key are stored in by the Spanner
+// budget consumption helper. One of:
+// "json": in the Value JSON column only (default).
+// "json_and_binary": in both the Value JSON column and the packed
+// Token_Counts BYTES column.
+// "binary": in the Token_Counts column only, the Value column being cleared.
+// With "json_and_binary", the Value column is read first, since instances still
+// in "json" update it alone, and the Token_Counts column only for the rows
+// written in "binary". With "binary", the Token_Counts column is read first,
+// the Value column only for the rows not written in binary yet. Roll out
+// "json_and_binary" everywhere before switching to "binary".
+static constexpr char kBudgetKeyTableValueFormat[] =
+    "google_scp_pbs_budget_key_table_value_format";
+// The maximum number of concurrent requests whose budgets are consumed by the
+// Spanner budget consumption helper in the same read-write transaction. The
+// requests queued while all the IO threads wait on Spanner are grouped into
+// the next transaction. Defaults to 1.
+static constexpr char kBudgetConsumptionHelperMaxRequestsPerTransaction[] =
+    "google_scp_pbs_budget_consumption_max_requests_per_transaction";
+// How long, in milliseconds, the Spanner budget consumption helper waits for
+// concurrent requests to share a transaction with, when the IO threads are
+// idle. Zero, the default, sends every request right away.
+static constexpr char kBudgetConsumptionHelperBatchingWindowInMilliseconds[] =
+    "google_scp_pbs_budget_consumption_batching_window_in_milliseconds";
+// Whether the Spanner budget consumption helper keeps the requests touching
+// the same (budget key, timeframe) row from reaching Spanner concurrently.
+// Such requests wait in process for the transaction in flight on the row,
+// instead of aborting each other in Spanner. Defaults to false.
+static constexpr char kBudgetConsumptionHelperSerializeRequestsPerRow[] =
+    "google_scp_pbs_budget_consumption_serialize_requests_per_row";
+// The staleness, in milliseconds, of the read-only snapshot the Spanner budget
+// consumption helper checks the budgets at before opening a read-write
+// transaction. The requests found exhausted are rejected without taking locks.
+// Zero, the default, disables the check.
+static constexpr char
+    kBudgetConsumptionHelperStaleReadStalenessInMilliseconds[] =
+        "google_scp_pbs_budget_consumption_stale_read_staleness_in_"
+        "milliseconds";
+// The Spanner replica locations, e.g. "us-east4,us-east1", the stale reads of
+// the Spanner budget consumption helper are directed to, in order of
+// preference. Setting the region of the PBS instance spares the stale reads a
+// round trip to the leader region. The other replicas serve the reads when none
+// of these can. Unset, the reads go to the nearest replica.
+static constexpr char kBudgetConsumptionHelperStaleReadDirectedReadLocations[] =
+    "google_scp_pbs_budget_consumption_stale_read_directed_read_locations";
+// How long, in seconds, the Spanner budget consumption helper remembers the
+// token counts of the rows on which requests were found exhausted, to reject
+// their replays in process. Zero, the default, disables the cache.
+static constexpr char kBudgetConsumptionHelperExhaustedRowCacheTtlInSeconds[] =
+    "google_scp_pbs_budget_consumption_exhausted_row_cache_ttl_in_seconds";
+// The maximum number of rows in the exhausted row cache. Defaults to 100000.
+static constexpr char kBudgetConsumptionHelperExhaustedRowCacheSize[] =
+    "google_scp_pbs_budget_consumption_exhausted_row_cache_size";
+// How many days the budget key table keeps the rows of a timeframe, counted
+// from the start of its day, as set by the row deletion policy of the table.
+// The Spanner budget consumption helper rejects the budgets of the timeframes
+// whose rows may be deleted, which would otherwise be consumed again from a
+// full budget. Zero, the default, keeps the rows forever.
+static constexpr char kBudgetKeyTimeframeRetentionInDays[] =
+    "google_scp_pbs_budget_key_timeframe_retention_in_days";
+// How many times the DynamoDB budget consumption helper attempts a request
+// whose rows are changed by a concurrent request between its read and its
+// conditional write. Defaults to 5.
+static constexpr char kBudgetConsumptionHelperMaxTransactionAttempts[] =
+    "google_scp_pbs_budget_consumption_max_transaction_attempts";
+// The maximum number of budget keys kept in memory by a budget key provider.
+// When the cache is full, the least frequently used keys are unloaded and new
+// keys are refused with a retry until there is room. Unbounded if not set.
+static constexpr char kBudgetKeyProviderCacheMaxEntryCount[] =
+    "google_scp_pbs_budget_key_provider_cache_max_entry_count";
+// The min recent access count, at most 15, of a hot budget key, which is kept
+// in memory past its expiry while the cache is below its eviction target.
+// Needs kBudgetKeyProviderCacheMaxEntryCount. Hot keys are not kept if not set
+// or 0.
+static constexpr char kBudgetKeyProviderHotKeyMinAccessCount[] =
+    "google_scp_pbs_budget_key_provider_hot_key_min_access_count";
+// The max number of cache lifetimes a hot budget key is kept for without an
+// access. Defaults to 12.
+static constexpr char kBudgetKeyProviderHotKeyMaxRetainedLifetimes[] =
+    "google_scp_pbs_budget_key_provider_hot_key_max_retained_lifetimes";
+// Whether the timeframe groups recovered from the checkpoints and journals are
+// kept serialized until their first access, rather than parsed during the
+// recovery, to load partitions faster.
+static constexpr char kBudgetKeyTimeframeManagerLazyRecoveryEnabled[] =
+    "google_scp_pbs_budget_key_timeframe_manager_lazy_recovery_enabled";
+// Whether budget consumption reserves the tokens of a timeframe in the commit
+// phase, so that several transactions can consume the budget of the same
+// timeframe concurrently, rather than holding the timeframe from the commit
+// phase until the notify or the abort phase.
+static constexpr char kBudgetKeyOptimisticConsumptionEnabled[] =
+    "google_scp_pbs_budget_key_optimistic_consumption_enabled";
+// The max time in milliseconds the prepare and the commit phases of a budget
+// consumption wait in the FIFO queue of a timeframe held by another
+// transaction, to run as soon as it commits or aborts, before returning a
+// retry. The conflicts are returned to be retried right away if not set or 0.
+static constexpr char kBudgetKeyTimeframeConflictMaxWaitTimeInMilliseconds[] =
+    "google_scp_pbs_budget_key_timeframe_conflict_max_wait_time_in_"
+    "milliseconds";
+// The maximum number of budget key loads coalesced into a single batched read
+// from the database. The loads of the keys missing from memory are sent one by
+// one if not set or set to 1.
+static constexpr char kBudgetKeyLoadMaxBatchSize[] =
+    "google_scp_pbs_budget_key_load_max_batch_size";
+// The maximum number of batched budget key reads in flight. The loads issued
+// while that many reads are in flight wait to be sent in the next batch.
+static constexpr char kBudgetKeyLoadMaxOutstandingBatches[] =
+    "google_scp_pbs_budget_key_load_max_outstanding_batches";
+// The local directory the journal and checkpoint blobs read by this instance
+// are cached in, so that reloading a partition on the same host, e.g. after
+// a restart or a failover back, does not read them again from the blob
+// storage. Disabled if not set or empty.
+static constexpr char kBlobDiskCacheDirectory[] =
+    "google_scp_pbs_blob_disk_cache_directory";
+// The max total size of the blobs in the blob disk cache. The least recently
+// used blobs are evicted past it.
+static constexpr char kBlobDiskCacheMaxSizeInBytes[] =
+    "google_scp_pbs_blob_disk_cache_max_size_in_bytes";
+// How long before the start of each UTC day the timeframe groups of that day
+// start being loaded for the budget keys in the cache, so that the traffic of
+// the new day does not miss on all of them at once. Disabled if not set or set
+// to 0.
+static constexpr char kBudgetKeyNextDayPrefetchLeadTimeInSeconds[] =
+    "google_scp_pbs_budget_key_next_day_prefetch_lead_time_in_seconds";
+// The maximum number of timeframe groups loaded per second ahead of a day.
+static constexpr char kBudgetKeyNextDayPrefetchMaxLoadsPerSecond[] =
+    "google_scp_pbs_budget_key_next_day_prefetch_max_loads_per_second";
+// Whether the loads of a timeframe group issued while the group is being
+// loaded wait for that load to complete, rather than being retried.
+static constexpr char kBudgetKeyTimeframeManagerLoadCoalescingEnabled[] =
+    "google_scp_pbs_budget_key_timeframe_manager_load_coalescing_enabled";
+// For how long a timeframe group found missing from the database is reloaded
+// with the default token counts without reading the database again, if its
+// load fails afterwards. Disabled if not set or set to 0.
+static constexpr char
+    kBudgetKeyTimeframeManagerRecordNotFoundCacheTtlInMilliseconds[] =
+        "google_scp_pbs_budget_key_timeframe_manager_record_not_found_cache_"
+        "ttl_in_milliseconds";
+// Whether the leases of all the partitions and virtual nodes are refreshed
+// together from one thread, with their lock rows read and written in batches,
+// rather than by a thread per lock reading and writing its own row.
+static constexpr char kLeaseRefreshBatchingEnabled[] =
+    "google_scp_pbs_lease_refresh_batching_enabled";
+// Whether the partitions are balanced across the nodes by their load (request
+// rate, cached budget keys) rather than by their count.
+static constexpr char kLoadAwarePartitionBalancingEnabled[] =
+    "google_scp_pbs_load_aware_partition_balancing_enabled";
+// Whether each node keeps a recovered, not yet loaded, standby of the ring
+// predecessor of its partitions, so that their takeover is fast.
+static constexpr char kPartitionWarmStandbyEnabled[] =
+    "google_scp_pbs_partition_warm_standby_enabled";
+// The maximum number of partitions loaded at once, when a node acquires many
+// leases together, the busiest partitions first. Loaded with the threads
+// shared with the partition unloads if not set or 0.
+static constexpr char kPBSPartitionLoadMaxConcurrency[] =
+    "google_scp_pbs_partition_load_max_concurrency";
+// Whether budget keys are mapped to the partitions with a consistent hash ring
+// rather than a modulo of the partition count, so that changing the partition
+// count only moves about 1/N of the keys. All the nodes must agree on this
+// setting, and turning it on remaps the keys of a running deployment just like
+// a change of the partition count would.
+static constexpr char kPartitionNamespaceConsistentHashingEnabled[] =
+    "google_scp_pbs_partition_namespace_consistent_hashing_enabled";
+// Number of virtual nodes each partition places on the consistent hash ring.
+static constexpr char kPartitionNamespaceVirtualNodeCount[] =
+    "google_scp_pbs_partition_namespace_virtual_node_count";
+// Whether the PBS instance initializes and runs the components that do not
+// depend on each other concurrently rather than one at a time.
+static constexpr char kParallelComponentStartupEnabled[] =
+    "google_scp_pbs_parallel_component_startup_enabled";
+// Whether the budget key caches of the partitions are sized to the available
+// memory of the host, and new transactions are refused when it runs low.
+static constexpr char kMemoryGovernorEnabled[] =
+    "google_scp_pbs_memory_governor_enabled";
+// The available memory the memory governor steers the host to, by shrinking
+// the budget key caches.
+static constexpr char kMemoryGovernorTargetAvailableMemoryInKb[] =
+    "google_scp_pbs_memory_governor_target_available_memory_in_kb";
+// The available memory below which new transactions are refused, until the
+// available memory is back to the target.
+static constexpr char kMemoryGovernorShedLoadAvailableMemoryInKb[] =
+    "google_scp_pbs_memory_governor_shed_load_available_memory_in_kb";
+// Whether the phases of the consume budget commands on the same budget key
+// all run on the same async executor thread.
+static constexpr char kBudgetKeyShardRoutingEnabled[] =
+    "google_scp_pbs_budget_key_shard_routing_enabled";
+// Whether the async executor runs the queued normal priority tasks, e.g. the
+// incoming transactions, earliest deadline first instead of in order.
+static constexpr char kAsyncExecutorEarliestDeadlineFirstEnabled[] =
+    "google_scp_pbs_async_executor_earliest_deadline_first_enabled";
+// The number of threads of the async executor reserved for the handlers of the
+// control-plane requests, e.g. the health checks and the transaction status
+// calls. 0 runs them on the http server threads like the other requests.
+static constexpr char kControlPlaneAsyncExecutorThreadsCount[] =
+    "google_scp_pbs_control_plane_async_executor_threads_count";
 static constexpr char kAsyncExecutorQueueSize[] =
     "google_scp_pbs_async_executor_queue_size";
 static constexpr char kAsyncExecutorThreadsCount[] =
@@ -53,6 +267,16 @@ static constexpr char kPrivacyBudgetServiceExternalExposedHostPort[] =
 static constexpr char kPrivacyBudgetServiceHealthPort[] =
     "google_scp_pbs_health_port";
 static constexpr char kAuthServiceEndpoint[] = "google_scp_pbs_auth_endpoint";
+// Whether the ID tokens of the identities already authorized by the auth
+// endpoint are verified and authorized locally, without calling it.
+static constexpr char kAuthLocalIdTokenVerificationEnabled[] =
+    "google_scp_pbs_auth_local_id_token_verification_enabled";
+// The audience of the ID tokens verified locally.
+static constexpr char kAuthIdTokenAudience[] =
+    "google_scp_pbs_auth_id_token_audience";
+// The URI of the keys the ID tokens are signed with, Google's by default.
+static constexpr char kAuthIdTokenJwksUri[] =
+    "google_scp_pbs_auth_id_token_jwks_uri";
 // This is the AWS endpoint used on GCP to authenticate requests that come from
 // AWS PBS to GCP PBS via DNS.
 static constexpr char kAlternateAuthServiceEndpoint[] =
@@ -123,6 +347,32 @@ static constexpr char kRemotePrivacyBudgetServiceAssumeRoleExternalId[] =
 static constexpr char kEnabledLogLevels[] =
     "google_scp_core_enabled_log_levels";
 
+// Whether the logs are written by a background thread instead of the
+// logging threads. Defaults to false.
+static constexpr char kAsyncLoggingEnabled[] =
+    "google_scp_core_async_logging_enabled";
+// Whether the logging threads wait for room when the queue of the
+// background log writer is full, instead of dropping the log. Defaults to
+// false. Only used when kAsyncLoggingEnabled is set.
+static constexpr char kAsyncLoggingBlockOnOverflow[] =
+    "google_scp_core_async_logging_block_on_overflow";
+// The window the messages logged from each location are counted over, see
+// the limits below. Defaults to 10 seconds.
+static constexpr char kLogRateLimitWindowInSeconds[] =
+    "google_scp_core_log_rate_limit_window_in_seconds";
+// The max number of messages of each level logged from each location per
+// window. The messages over the limit are dropped, and their count is logged
+// with the next message of the location after the window. The levels without
+// a limit are not limited; the critical, alert and emergency ones never are.
+static constexpr char kLogRateLimitMaxErrorMessagesPerWindow[] =
+    "google_scp_core_log_rate_limit_max_error_messages_per_window";
+static constexpr char kLogRateLimitMaxWarningMessagesPerWindow[] =
+    "google_scp_core_log_rate_limit_max_warning_messages_per_window";
+static constexpr char kLogRateLimitMaxInfoMessagesPerWindow[] =
+    "google_scp_core_log_rate_limit_max_info_messages_per_window";
+static constexpr char kLogRateLimitMaxDebugMessagesPerWindow[] =
+    "google_scp_core_log_rate_limit_max_debug_messages_per_window";
+
 // HTTP2 Server TLS context
 static constexpr char kHttp2ServerUseTls[] =
     "google_scp_pbs_http2_server_use_tls";
@@ -137,18 +387,89 @@ static constexpr char
     kPBSJournalCheckpointingMaxJournalEntriesToProcessInEachRun[] =
         "google_scp_pbs_journal_checkpointing_max_entries_to_process_in_each_"
         "run";
+// The maximum number of delta checkpoints, which only hold the budget keys
+// changed since the previous checkpoint, written on top of a full checkpoint
+// before compacting them into a full checkpoint again. Zero disables delta
+// checkpoints.
+static constexpr char kPBSJournalCheckpointingMaxDeltaCheckpointChainLength[] =
+    "google_scp_pbs_journal_checkpointing_max_delta_checkpoint_chain_length";
+// The number of blobs each checkpoint is sharded into by budget key. The
+// shards are written and read in parallel.
+static constexpr char kPBSJournalCheckpointingShardCount[] =
+    "google_scp_pbs_journal_checkpointing_shard_count";
+// Whether the checkpoints are taken from the state of the live partition, with
+// the flushing of its journals briefly paused, instead of recovering the
+// journals into a separate copy of the partition.
+static constexpr char kPBSJournalCheckpointingEnableLiveSnapshot[] =
+    "google_scp_pbs_journal_checkpointing_enable_live_snapshot";
+// The number of logs, and the bytes of logs, journaled by the partition since
+// the last checkpointing run that start the next one. Once either is set, the
+// checkpointing interval is the minimum time between the runs, and the runs
+// also start after the max interval below. Zero, the default, disables either
+// trigger, and the runs start every checkpointing interval.
+static constexpr char kPBSJournalCheckpointingLogCountThreshold[] =
+    "google_scp_pbs_journal_checkpointing_log_count_threshold";
+static constexpr char kPBSJournalCheckpointingLogBytesThreshold[] =
+    "google_scp_pbs_journal_checkpointing_log_bytes_threshold";
+static constexpr char kPBSJournalCheckpointingMaxIntervalInSeconds[] =
+    "google_scp_pbs_journal_checkpointing_max_interval_in_seconds";
 
 // Health service
 static constexpr char kPBSHealthServiceEnableMemoryAndStorageCheck[] =
     "google_scp_pbs_health_service_enable_mem_and_storage_check";
 
+// Profiling service
+// Whether the health HTTP server serves CPU and heap profiles in the pprof
+// format on /debug/pprof/profile and /debug/pprof/heap. Off by default, as the
+// health port is not authenticated.
+static constexpr char kPBSProfilingServiceEnabled[] =
+    "google_scp_pbs_profiling_service_enabled";
+// The longest CPU profile a request can ask for.
+static constexpr char kPBSProfilingServiceMaxCpuProfileDurationInSeconds[] =
+    "google_scp_pbs_profiling_service_max_cpu_profile_duration_in_seconds";
+
 // workload generator
 static constexpr char kPBSWorkloadGeneratorMaxHttpRetryCount[] =
     "pbs_workload_generator_max_http_retry_count";
+// Target arrival rate of the open-loop mode. Transactions are issued on a
+// fixed schedule regardless of how many are outstanding; 0 keeps the
+// closed-loop mode.
+static constexpr char kPBSWorkloadGeneratorArrivalRatePerSecond[] =
+    "pbs_workload_generator_arrival_rate_per_second";
+// One of unique, uniform, zipfian or day_boundary.
+static constexpr char kPBSWorkloadGeneratorKeyDistribution[] =
+    "pbs_workload_generator_key_distribution";
+// Number of distinct budget keys the non-unique key distributions draw from.
+static constexpr char kPBSWorkloadGeneratorKeySpaceSize[] =
+    "pbs_workload_generator_key_space_size";
+// If set, the run summary and latency percentiles are written to this path as
+// JSON.
+static constexpr char kPBSWorkloadGeneratorJsonOutputPath[] =
+    "pbs_workload_generator_json_output_path";
 
 // PBS with relaxed consistency
 static constexpr char kPBSRelaxedConsistencyEnabled[] =
     "google_scp_pbs_relaxed_consistency_enabled";
+// Whether the front end bounds the number of consume budget requests in flight
+// and rejects the ones above the limit with a retriable status. The limit
+// grows while the requests complete within the target latency, and shrinks
+// once they exceed it.
+static constexpr char kPBSFrontEndAdmissionControlEnabled[] =
+    "google_scp_pbs_front_end_admission_control_enabled";
+static constexpr char
+    kPBSFrontEndAdmissionControlTargetLatencyInMilliseconds[] =
+        "google_scp_pbs_front_end_admission_control_target_latency_in_"
+        "milliseconds";
+static constexpr char kPBSFrontEndAdmissionControlInitialLimit[] =
+    "google_scp_pbs_front_end_admission_control_initial_limit";
+static constexpr char kPBSFrontEndAdmissionControlMinLimit[] =
+    "google_scp_pbs_front_end_admission_control_min_limit";
+static constexpr char kPBSFrontEndAdmissionControlMaxLimit[] =
+    "google_scp_pbs_front_end_admission_control_max_limit";
+// The bucket boundaries, in microseconds, of the histogram of the time the
+// consume budget requests spend in each stage of the request path.
+static constexpr char kPBSRequestStageLatencyBoundariesInMicroseconds[] =
+    "google_scp_pbs_request_stage_latency_boundaries_in_microseconds";
 
 // Opentelemetry
 static constexpr char kOtelEnabled[] = "google_scp_otel_enabled";
@@ -15,6 +15,7 @@
 #ifndef CC_PBS_INTERFACE_CONSUME_BUDGET_INTERFACE_H_
 #define CC_PBS_INTERFACE_CONSUME_BUDGET_INTERFACE_H_
 
+#include <chrono>
 #include <vector>
 
 #include "cc/core/interface/async_context.h"
@@ -30,6 +31,9 @@ struct ConsumeBudgetsRequest {
 
 struct ConsumeBudgetsResponse {
   std::vector<size_t> budget_exhausted_indices;
+  /// The time spent committing the transaction which consumed the budgets, 0
+  /// if unknown.
+  std::chrono::nanoseconds commit_duration{0};
 };
 
 // A helper class to consume a given list of budgets.
@@ -85,6 +85,26 @@ static constexpr char kMetricEventUnloadFromDBSuccess[] =
     "UnloadFromDB Success";
 static constexpr char kMetricEventUnloadFromDBFailed[] = "UnloadFromDB Failed";
 
+/**
+ * @brief
+ * Budget Key Cache Metrics
+ *  Metric Name: kMetricNameBudgetKeyCacheGarbageCollectionDuration
+ */
+static constexpr char kMetricNameBudgetKeyCacheGarbageCollectionDuration[] =
+    "google.scp.pbs.budget_key_provider.gc_duration";
+
+/**
+ * @brief
+ * Budget Consumption Metrics
+ *  Metric Name: kMetricNameConsumeBudgetTransactionAborts
+ *               Labels: kMetricLabelBudgetKeyPrefix
+ */
+static constexpr char kMetricNameConsumeBudgetTransactionAborts[] =
+    "google.scp.pbs.consume_budget.transaction_aborts";
+
+// The part of the budget key names before the first '/', i.e. the origin.
+static constexpr char kMetricLabelBudgetKeyPrefix[] = "budget_key_prefix";
+
 // Instance Health Metric
 static constexpr char kMetricComponentNameInstanceHealth[] = "Health";
 
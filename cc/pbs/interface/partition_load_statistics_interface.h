@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "core/interface/partition_types.h"
+#include "pbs/interface/pbs_partition_interface.h"
+
+namespace google::scp::pbs {
+/**
+ * @brief Provides the load of the partitions hosted on this node, so that the
+ * partitions can be balanced across the nodes by their load.
+ */
+class PartitionLoadStatisticsInterface {
+ public:
+  virtual ~PartitionLoadStatisticsInterface() = default;
+
+  /**
+   * @brief Get the load of each of the partitions loaded locally.
+   *
+   * @return std::vector<std::pair<core::PartitionId, PartitionLoad>>
+   */
+  virtual std::vector<std::pair<core::PartitionId, PartitionLoad>>
+  GetLocalPartitionsLoad() noexcept = 0;
+
+  /**
+   * @brief Get the number of requests routed to a partition, local or remote,
+   * since it was loaded on this node. For a remote partition, this is the
+   * traffic forwarded to its owner. The count is relaxed.
+   *
+   * @param partition_id
+   * @return size_t 0 if the partition is not loaded.
+   */
+  virtual size_t GetPartitionRoutedRequestsCount(
+      const core::PartitionId& partition_id) noexcept = 0;
+};
+}  // namespace google::scp::pbs
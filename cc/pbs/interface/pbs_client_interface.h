@@ -20,6 +20,14 @@
 #include "pbs/interface/front_end_service_interface.h"
 
 namespace google::scp::pbs {
+/// The encodings of the consume budget transaction request bodies.
+enum class BudgetRequestEncoding {
+  /// JSON bodies.
+  kJson = 0,
+  /// Protobuf bodies, sent with the kProtobufContentType content type.
+  kProtobuf = 1,
+};
+
 /**
  * @brief Provides privacy budget service API layer for a single privacy budget
  * instance.
@@ -39,6 +47,19 @@ class PrivacyBudgetServiceClientInterface : public core::ServiceInterface {
                          core::GetTransactionStatusResponse>&
           get_transaction_status_context) noexcept = 0;
 
+  /**
+   * @brief Inquires the status of many transactions of the same origin from
+   * the remote transaction engine in a single request.
+   *
+   * @param batch_get_transaction_status_context The batch get transaction
+   * status context.
+   * @return ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept = 0;
+
   /**
    * @brief Initiates a new consume budget transaction on a privacy budget
    * service.
@@ -63,5 +84,19 @@ class PrivacyBudgetServiceClientInterface : public core::ServiceInterface {
       core::AsyncContext<core::TransactionPhaseRequest,
                          core::TransactionPhaseResponse>&
           transaction_phase_context) noexcept = 0;
+
+  /**
+   * @brief Consumes the budgets of a transaction on a privacy budget service
+   * in a single request, the service running all the phases of the
+   * transaction itself.
+   *
+   * @param consume_budget_transaction_context The consume budget transaction
+   * context of the operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  virtual core::ExecutionResult ConsumeBudget(
+      core::AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&
+          consume_budget_transaction_context) noexcept = 0;
 };
 }  // namespace google::scp::pbs
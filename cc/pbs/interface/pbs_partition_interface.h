@@ -16,12 +16,25 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "core/interface/async_context.h"
 #include "core/interface/partition_interface.h"
 #include "core/interface/transaction_manager_interface.h"
 
 namespace google::scp::pbs {
 
+/**
+ * @brief Approximate load of a partition. The counts are relaxed and should
+ * be used only for approximate calculations such as load balancing.
+ */
+struct PartitionLoad {
+  /// @brief Requests seen by the partition since it was loaded.
+  size_t requests_seen_count = 0;
+  /// @brief Budget keys currently cached by the partition.
+  size_t cached_budget_keys_count = 0;
+};
+
 /**
  * @brief All requests to this are forwarded to Transaction Manager for
  * execution.
@@ -81,6 +94,26 @@ class PBSPartitionInterface : public core::PartitionInterface {
   virtual core::ExecutionResult GetTransactionManagerStatus(
       const core::GetTransactionManagerStatusRequest& request,
       core::GetTransactionManagerStatusResponse& response) noexcept = 0;
+
+  /**
+   * @brief Get the approximate load of the partition. A partition that is not
+   * loaded has no load.
+   *
+   * @return PartitionLoad
+   */
+  virtual PartitionLoad GetPartitionLoad() noexcept = 0;
+
+  /**
+   * @brief Recovers the partition from its journals without loading it, so
+   * that it serves as a warm standby. Can be called repeatedly to catch up,
+   * each call replays only the journals written since the previous one. A
+   * later Load() then only has to catch up on the latest journals.
+   *
+   * The partition must be initialized and not loaded.
+   *
+   * @return core::ExecutionResult
+   */
+  virtual core::ExecutionResult RecoverAsStandby() noexcept = 0;
 };
 
 }  // namespace google::scp::pbs
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 #include "core/interface/partition_manager_interface.h"
@@ -35,5 +36,14 @@ class PBSPartitionManagerInterface : public core::PartitionManagerInterface {
    */
   virtual core::ExecutionResultOr<std::shared_ptr<PBSPartitionInterface>>
   GetPBSPartition(const core::PartitionId& partition_id) noexcept = 0;
+
+  /**
+   * @brief Get the version of the set of partitions. It increases whenever a
+   * partition is loaded or unloaded, or its address changes, so that the
+   * resolutions of the partitions can be cached until it does.
+   *
+   * @return uint64_t
+   */
+  virtual uint64_t GetPartitionsVersion() noexcept = 0;
 };
 }  // namespace google::scp::pbs
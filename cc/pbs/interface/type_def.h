@@ -33,6 +33,8 @@ static constexpr char kTransactionLastExecutionTimestampHeader[] =
     "x-gscp-transaction-last-execution-timestamp";
 static constexpr char kTransactionOriginHeader[] = "x-gscp-transaction-origin";
 static constexpr char kTransactionSecretHeader[] = "x-gscp-transaction-secret";
+static constexpr char kContentTypeHeader[] = "content-type";
+static constexpr char kProtobufContentType[] = "application/x-protobuf";
 static constexpr char kBeginTransactionPath[] = "/v1/transactions:begin";
 static constexpr char kPrepareTransactionPath[] = "/v1/transactions:prepare";
 static constexpr char kCommitTransactionPath[] = "/v1/transactions:commit";
@@ -40,6 +42,8 @@ static constexpr char kNotifyTransactionPath[] = "/v1/transactions:notify";
 static constexpr char kAbortTransactionPath[] = "/v1/transactions:abort";
 static constexpr char kEndTransactionPath[] = "/v1/transactions:end";
 static constexpr char kStatusTransactionPath[] = "/v1/transactions:status";
+static constexpr char kBatchStatusTransactionPath[] =
+    "/v1/transactions:batch-status";
 static constexpr char kServiceStatusPath[] = "/v1/service:status";
 static constexpr char kStatusHealthCheckPath[] =
     "/v1/transactions:health-check";
@@ -55,6 +59,8 @@ static constexpr char kMetricLabelAbortTransaction[] = "ABORT";
 static constexpr char kMetricLabelNotifyTransaction[] = "NOTIFY";
 static constexpr char kMetricLabelEndTransaction[] = "END";
 static constexpr char kMetricLabelGetStatusTransaction[] = "GET_STATUS";
+static constexpr char kMetricLabelConsumeBudgetTransaction[] =
+    "CONSUME_BUDGET";
 static constexpr char kMetricLabelValueOperator[] = "OPERATOR";
 static constexpr char kMetricLabelValueCoordinator[] = "COORDINATOR";
 static constexpr char kMetricLabelKeyReportingOrigin[] = "reporting_origin";
@@ -67,6 +73,16 @@ static constexpr char kMetricNameClientErrors[] =
     "google.scp.pbs.frontend.client_errors";
 static constexpr char kMetricNameServerErrors[] =
     "google.scp.pbs.frontend.server_errors";
+static constexpr char kMetricNameReportingOriginSiteCacheHits[] =
+    "google.scp.pbs.frontend.reporting_origin_site_cache.hits";
+static constexpr char kMetricNameReportingOriginSiteCacheMisses[] =
+    "google.scp.pbs.frontend.reporting_origin_site_cache.misses";
+static constexpr char kMetricNameAdmissionControlLimit[] =
+    "google.scp.pbs.frontend.admission_control.limit";
+static constexpr char kMetricNameAdmissionControlInFlight[] =
+    "google.scp.pbs.frontend.admission_control.in_flight";
+static constexpr char kMetricNameAdmissionControlShedRequests[] =
+    "google.scp.pbs.frontend.admission_control.shed_requests";
 static constexpr char kMetricNameMemoryUsage[] =
     "google.scp.pbs.health.memory_usage";
 static constexpr char kMetricNameFileSystemStorageUsage[] =
@@ -31,4 +31,12 @@ DEFINE_ERROR_CODE(SC_LEASABLE_LOCK_ACQUISITION_DISALLOWED, SC_LEASABLE_LOCK,
                   0x0002, "Lease acquisition disabled at this time",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
 
+DEFINE_ERROR_CODE(SC_LEASABLE_LOCK_MISSING_FROM_BATCH_READ, SC_LEASABLE_LOCK,
+                  0x0003, "The lock row is missing from the batch read.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_LEASABLE_LOCK_REFRESH_IN_PROGRESS, SC_LEASABLE_LOCK,
+                  0x0004, "A lease refresh is already in progress on the lock.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
 }  // namespace google::scp::core::errors
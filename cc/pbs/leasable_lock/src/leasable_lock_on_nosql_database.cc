@@ -16,30 +16,44 @@
 
 #include "pbs/leasable_lock/src/leasable_lock_on_nosql_database.h"
 
+#include <future>
 #include <memory>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <utility>
 
+#include "core/common/operation_dispatcher/src/retry_strategy.h"
 #include "core/common/time_provider/src/time_provider.h"
 #include "core/common/uuid/src/uuid.h"
 #include "pbs/leasable_lock/src/error_codes.h"
 
+using google::scp::core::AsyncContext;
+using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
+using google::scp::core::GetDatabaseItemRequest;
+using google::scp::core::GetDatabaseItemResponse;
 using google::scp::core::LeaseInfo;
 using google::scp::core::LeaseManagerInterface;
 using google::scp::core::LeaseTransitionType;
+using google::scp::core::NoSqlDatabaseKeyValuePair;
 using google::scp::core::NoSQLDatabaseProviderInterface;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::TimeDuration;
+using google::scp::core::UpsertDatabaseItemRequest;
+using google::scp::core::UpsertDatabaseItemResponse;
+using google::scp::core::common::RetryStrategy;
+using google::scp::core::common::RetryStrategyType;
 using google::scp::core::common::TimeProvider;
 using google::scp::core::common::Uuid;
 using std::atomic;
 using std::get;
 using std::make_shared;
+using std::move;
 using std::mutex;
 using std::optional;
+using std::promise;
 using std::shared_lock;
 using std::shared_mutex;
 using std::shared_ptr;
@@ -61,8 +75,11 @@ LeasableLockOnNoSQLDatabase::LeasableLockOnNoSQLDatabase(
     shared_ptr<NoSQLDatabaseProviderInterface> database,
     LeaseInfo lease_acquirer_info, string table_name, string lock_row_key,
     milliseconds lease_duration_in_milliseconds,
-    uint64_t lease_renewal_threshold_percent_time_left_in_lease) noexcept
+    uint64_t lease_renewal_threshold_percent_time_left_in_lease,
+    shared_ptr<AsyncExecutorInterface> async_executor) noexcept
     : database_(database),
+      is_refresh_in_progress_(false),
+      async_executor_(async_executor),
       lease_acquirer_info_(lease_acquirer_info),
       table_name_(table_name),
       lock_row_key_(lock_row_key),
@@ -73,20 +90,170 @@ LeasableLockOnNoSQLDatabase::LeasableLockOnNoSQLDatabase(
 
 ExecutionResult LeasableLockOnNoSQLDatabase::RefreshLease(
     bool is_read_only_lease_refresh) noexcept {
-  unique_lock<mutex> lock(mutex_);
+  promise<ExecutionResult> refresh_result;
+  auto result = RefreshLeaseAsync(
+      is_read_only_lease_refresh,
+      [&refresh_result](const ExecutionResult& result) {
+        refresh_result.set_value(result);
+      });
+  if (!result.Successful()) {
+    return result;
+  }
+  return refresh_result.get_future().get();
+}
+
+ExecutionResult LeasableLockOnNoSQLDatabase::RefreshLeaseAsync(
+    bool is_read_only_lease_refresh, RefreshLeaseCallback callback) noexcept {
+  if (is_refresh_in_progress_.exchange(true)) {
+    return FailureExecutionResult(
+        core::errors::SC_LEASABLE_LOCK_REFRESH_IN_PROGRESS);
+  }
 
   SCP_INFO(kLeasableLock, activity_id_,
            "LockId: '%s', Starting to refresh the lease.",
            lock_row_key_.c_str());
 
-  LeaseInfoInternal lease_read;
-  auto result = ReadLeaseSynchronouslyFromDatabase(lease_read);
+  auto operation = make_shared<LeaseRefreshOperation>();
+  operation->is_read_only_lease_refresh = is_read_only_lease_refresh;
+  operation->deadline = TimeProvider::GetSteadyTimestampInNanoseconds() +
+                        lease_duration_in_milliseconds_ / 2;
+  operation->callback = move(callback);
+  ReadLease(operation);
+  return SuccessExecutionResult();
+}
+
+void LeasableLockOnNoSQLDatabase::ReadLease(
+    const shared_ptr<LeaseRefreshOperation>& operation) {
+  AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse> context(
+      make_shared<GetDatabaseItemRequest>(),
+      [this, operation](auto& context) {
+        OnLeaseReadCompleted(
+            operation, context.result,
+            context.response ? context.response->attributes : nullptr);
+      });
+  ConstructLockRowKey(*context.request);
+  auto result = database_->GetDatabaseItem(context);
+  if (!result.Successful()) {
+    OnLeaseReadCompleted(operation, result, nullptr);
+  }
+}
+
+void LeasableLockOnNoSQLDatabase::OnLeaseReadCompleted(
+    const shared_ptr<LeaseRefreshOperation>& operation,
+    const ExecutionResult& result,
+    const shared_ptr<vector<NoSqlDatabaseKeyValuePair>>& attributes) {
   if (!result.Successful()) {
     SCP_ERROR(kLeasableLock, activity_id_, result,
               "LockId: '%s', Failed to read the lease.", lock_row_key_.c_str());
-    return result;
+    RetryOrFinishLeaseRefresh(operation, result);
+    return;
+  }
+
+  operation->lease_read = LeaseInfoInternal();
+  auto execution_result = SuccessExecutionResult();
+  if (attributes) {
+    execution_result =
+        ObtainLeaseInfoFromAttributes(attributes, operation->lease_read);
+  }
+  if (!execution_result.Successful()) {
+    FinishLeaseRefresh(operation, execution_result);
+    return;
   }
 
+  optional<LeaseInfoInternal> new_lease;
+  execution_result = OnLeaseRead(operation->lease_read,
+                                 operation->is_read_only_lease_refresh,
+                                 new_lease);
+  if (!execution_result.Successful() || !new_lease.has_value()) {
+    FinishLeaseRefresh(operation, execution_result);
+    return;
+  }
+  operation->new_lease = *new_lease;
+  WriteLease(operation);
+}
+
+void LeasableLockOnNoSQLDatabase::WriteLease(
+    const shared_ptr<LeaseRefreshOperation>& operation) {
+  AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse> context(
+      make_shared<UpsertDatabaseItemRequest>(),
+      [this, operation](auto& context) {
+        OnLeaseWriteCompleted(operation, context.result);
+      });
+  auto result = ConstructLeaseWriteRequest(
+      operation->lease_read, operation->new_lease, *context.request);
+  if (!result.Successful()) {
+    FinishLeaseRefresh(operation, result);
+    return;
+  }
+  result = database_->UpsertDatabaseItem(context);
+  if (!result.Successful()) {
+    OnLeaseWriteCompleted(operation, result);
+  }
+}
+
+void LeasableLockOnNoSQLDatabase::OnLeaseWriteCompleted(
+    const shared_ptr<LeaseRefreshOperation>& operation,
+    const ExecutionResult& result) {
+  auto execution_result =
+      OnLeaseWritten(operation->lease_read, operation->new_lease, result);
+  if (!execution_result.Successful()) {
+    // A write that timed out may still have been applied, so the lease is
+    // read again before being written again.
+    RetryOrFinishLeaseRefresh(operation, execution_result);
+    return;
+  }
+  FinishLeaseRefresh(operation, execution_result);
+}
+
+void LeasableLockOnNoSQLDatabase::RetryOrFinishLeaseRefresh(
+    const shared_ptr<LeaseRefreshOperation>& operation,
+    const ExecutionResult& result) {
+  if (!result.Retryable() ||
+      operation->retry_count >= kLeaseOperationMaxRetryCount) {
+    FinishLeaseRefresh(operation, result);
+    return;
+  }
+
+  RetryStrategy retry_strategy(RetryStrategyType::Exponential,
+                               kLeaseOperationRetryInitialBackOff.count(),
+                               kLeaseOperationMaxRetryCount);
+  operation->retry_count++;
+  auto back_off = milliseconds(
+      retry_strategy.GetBackOffDurationInMilliseconds(operation->retry_count));
+  // The retry is not worth it if it could not complete before the deadline,
+  // assuming it takes as long as its back off.
+  auto now = TimeProvider::GetSteadyTimestampInNanoseconds();
+  if (now + 2 * back_off > operation->deadline) {
+    FinishLeaseRefresh(operation, result);
+    return;
+  }
+
+  SCP_INFO(kLeasableLock, activity_id_,
+           "LockId: '%s', Retrying the lease refresh in '%lld' ms, retry "
+           "'%llu'.",
+           lock_row_key_.c_str(), back_off.count(), operation->retry_count);
+  if (!async_executor_) {
+    ReadLease(operation);
+    return;
+  }
+  auto schedule_result = async_executor_->ScheduleFor(
+      [this, operation]() { ReadLease(operation); },
+      (now + back_off).count());
+  if (!schedule_result.Successful()) {
+    FinishLeaseRefresh(operation, result);
+  }
+}
+
+void LeasableLockOnNoSQLDatabase::FinishLeaseRefresh(
+    const shared_ptr<LeaseRefreshOperation>& operation,
+    const ExecutionResult& result) {
+  is_refresh_in_progress_ = false;
+  operation->callback(result);
+}
+
+ExecutionResult LeasableLockOnNoSQLDatabase::OnLeaseRead(
+    const LeaseInfoInternal& lease_read, bool is_read_only_lease_refresh,
+    optional<LeaseInfoInternal>& new_lease) {
   SCP_INFO(kLeasableLock, activity_id_,
            "LockId: '%s', Read the current lease from lock.",
            lock_row_key_.c_str());
@@ -102,15 +269,17 @@ ExecutionResult LeasableLockOnNoSQLDatabase::RefreshLease(
 
   if (!lease_read.IsLeaseOwner(lease_acquirer_info_.lease_acquirer_id) &&
       !lease_read.IsExpired()) {
+    unique_lock<mutex> lock(mutex_);
     current_lease_ = lease_read;
-    return result;
+    return SuccessExecutionResult();
   }
 
   // If lease should not be acquired, i.e. lease is read only, then return with
   // the read lease.
   if (is_read_only_lease_refresh) {
+    unique_lock<mutex> lock(mutex_);
     current_lease_ = lease_read;
-    return result;
+    return SuccessExecutionResult();
   }
 
   SCP_INFO(kLeasableLock, activity_id_,
@@ -118,12 +287,17 @@ ExecutionResult LeasableLockOnNoSQLDatabase::RefreshLease(
            lock_row_key_.c_str());
 
   // Renew(if owner) or Acquire(if not owner) the lease
-  LeaseInfoInternal new_lease = lease_read;
+  new_lease = lease_read;
   if (!lease_read.IsLeaseOwner(lease_acquirer_info_.lease_acquirer_id)) {
     new_lease = LeaseInfoInternal(lease_acquirer_info_);
   }
-  new_lease.SetExpirationTimestampFromNow(lease_duration_in_milliseconds_);
-  result = WriteLeaseSynchronouslyToDatabase(lease_read, new_lease);
+  new_lease->SetExpirationTimestampFromNow(lease_duration_in_milliseconds_);
+  return SuccessExecutionResult();
+}
+
+ExecutionResult LeasableLockOnNoSQLDatabase::OnLeaseWritten(
+    const LeaseInfoInternal& lease_read, const LeaseInfoInternal& new_lease,
+    const ExecutionResult& result) {
   if (!result.Successful()) {
     SCP_ERROR(kLeasableLock, activity_id_, result,
               "LockId: '%s', Failed to update lease on the database. "
@@ -155,6 +329,7 @@ ExecutionResult LeasableLockOnNoSQLDatabase::RefreshLease(
           duration_cast<milliseconds>(
               TimeProvider::GetWallTimestampInNanoseconds()));
 
+  unique_lock<mutex> lock(mutex_);
   current_lease_ = new_lease;
   return result;
 }
@@ -15,12 +15,15 @@
  */
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "core/interface/async_executor_interface.h"
 #include "core/interface/lease_manager_interface.h"
 #include "core/interface/nosql_database_provider_interface.h"
 #include "pbs/interface/configuration_keys.h"
@@ -32,6 +35,12 @@ constexpr std::chrono::milliseconds kDefaultLeaseDurationInMilliseconds =
 constexpr uint64_t kLeaseRenewalThresholdPercentTimeLeftInLease =
     50;  // Start renewing lease when the remaining lease duration <= 50% of
          // total lease duration.
+/// The initial back off of the retries of the lock row reads and writes,
+/// which doubles on every retry.
+constexpr std::chrono::milliseconds kLeaseOperationRetryInitialBackOff =
+    std::chrono::milliseconds(20);
+/// The most retries of a lease refresh.
+constexpr size_t kLeaseOperationMaxRetryCount = 8;
 
 /**
  * @copydoc core::LeasableLockInterface
@@ -49,6 +58,9 @@ class LeasableLockOnNoSQLDatabase : public core::LeasableLockInterface {
    * needs to be acquired or renewed.
    * @param lease_renewal_threshold_percent_time_left_in_lease_ percentage of
    * time left in lease at which lease renewal should start.
+   * @param async_executor executor to schedule the retries of the lock row
+   * reads and writes on after their back off. If not set, the retries are
+   * sent right away.
    */
   LeasableLockOnNoSQLDatabase(
       std::shared_ptr<core::NoSQLDatabaseProviderInterface> database,
@@ -57,17 +69,47 @@ class LeasableLockOnNoSQLDatabase : public core::LeasableLockInterface {
       std::chrono::milliseconds lease_duration_in_milliseconds =
           kDefaultLeaseDurationInMilliseconds,
       uint64_t lease_renewal_threshold_percent_time_left_in_lease =
-          kLeaseRenewalThresholdPercentTimeLeftInLease) noexcept;
+          kLeaseRenewalThresholdPercentTimeLeftInLease,
+      std::shared_ptr<core::AsyncExecutorInterface> async_executor =
+          nullptr) noexcept;
+
+  /// Invoked with the result of an asynchronous lease refresh.
+  using RefreshLeaseCallback =
+      std::function<void(const core::ExecutionResult&)>;
 
   /**
    * @brief Refreshes lease on the lock present on no-sql database. If the lease
    * refresh fails, an error status code is returned.
    *
+   * This waits for RefreshLeaseAsync to complete.
+   *
    * @return core::ExecutionResult
    */
   core::ExecutionResult RefreshLease(
       bool is_read_only_lease_refresh) noexcept override;
 
+  /**
+   * @brief Refreshes lease on the lock without blocking on the database.
+   *
+   * The lock row is read and then conditionally written, as with
+   * RefreshLease. Retriable failures of either are retried from the read with
+   * exponential back off, for as long as the retry can complete before the
+   * refresh deadline, which is half the lease duration after the start of the
+   * refresh. That keeps a slow database from delaying the completion of the
+   * refresh past what the lease refresh liveness checks allow.
+   *
+   * NOTE: The lock must outlive the refresh.
+   *
+   * @param is_read_only_lease_refresh whether the lease should not be
+   * acquired.
+   * @param callback invoked with the result of the refresh, unless a failure
+   * is returned.
+   * @return core::ExecutionResult failure if a refresh is already in
+   * progress.
+   */
+  core::ExecutionResult RefreshLeaseAsync(
+      bool is_read_only_lease_refresh, RefreshLeaseCallback callback) noexcept;
+
   /**
    * @brief Determines if lease refresh needs to be done based on cached lease
    * information. If there is no cached lease information, this returns true.
@@ -98,6 +140,8 @@ class LeasableLockOnNoSQLDatabase : public core::LeasableLockInterface {
       const noexcept override;
 
  protected:
+  friend class LeasableLockOnNoSQLDatabaseBatchRefresher;
+
   struct LeaseInfoInternal {
     LeaseInfoInternal(
         const core::LeaseInfo& lease_owner_info,
@@ -149,7 +193,82 @@ class LeasableLockOnNoSQLDatabase : public core::LeasableLockInterface {
     bool lease_acquisition_disallowed;
   };
 
+  /// @brief The state of an asynchronous lease refresh.
+  struct LeaseRefreshOperation {
+    bool is_read_only_lease_refresh = false;
+    /// @brief The steady timestamp past which the refresh is not retried.
+    std::chrono::nanoseconds deadline;
+    size_t retry_count = 0;
+    LeaseInfoInternal lease_read;
+    LeaseInfoInternal new_lease;
+    RefreshLeaseCallback callback;
+  };
+
+  /// @brief Reads the lock row of the refresh.
+  void ReadLease(const std::shared_ptr<LeaseRefreshOperation>& operation);
+
+  /// @brief Decides on the lease read, and writes the new lease if needed.
+  void OnLeaseReadCompleted(
+      const std::shared_ptr<LeaseRefreshOperation>& operation,
+      const core::ExecutionResult& result,
+      const std::shared_ptr<std::vector<core::NoSqlDatabaseKeyValuePair>>&
+          attributes);
+
+  /// @brief Conditionally writes the new lease of the refresh.
+  void WriteLease(const std::shared_ptr<LeaseRefreshOperation>& operation);
+
+  /// @brief Completes the refresh once the new lease is written.
+  void OnLeaseWriteCompleted(
+      const std::shared_ptr<LeaseRefreshOperation>& operation,
+      const core::ExecutionResult& result);
+
+  /**
+   * @brief Retries the refresh from the read after its back off if the
+   * failure is retriable and the retry can complete before the deadline,
+   * otherwise completes the refresh with the failure.
+   */
+  void RetryOrFinishLeaseRefresh(
+      const std::shared_ptr<LeaseRefreshOperation>& operation,
+      const core::ExecutionResult& result);
+
+  /// @brief Completes the refresh with the result.
+  void FinishLeaseRefresh(
+      const std::shared_ptr<LeaseRefreshOperation>& operation,
+      const core::ExecutionResult& result);
+
+  /**
+   * @brief Decides what to do with the lease read from the lock row. Either
+   * the read lease becomes the current lease, or new_lease is set to the lease
+   * to conditionally write to the lock row.
+   *
+   * @param lease_read the lease read from the lock row.
+   * @param is_read_only_lease_refresh whether the lease should not be
+   * acquired.
+   * @param new_lease the lease to write, if a write is needed.
+   * @return core::ExecutionResult failure if lease acquisition is disallowed.
+   */
+  core::ExecutionResult OnLeaseRead(
+      const LeaseInfoInternal& lease_read, bool is_read_only_lease_refresh,
+      std::optional<LeaseInfoInternal>& new_lease);
+
+  /**
+   * @brief Makes the written lease the current lease if the write succeeded.
+   *
+   * @param lease_read the lease the write was conditioned on.
+   * @param new_lease the written lease.
+   * @param result the result of the write.
+   * @return core::ExecutionResult the result of the write.
+   */
+  core::ExecutionResult OnLeaseWritten(const LeaseInfoInternal& lease_read,
+                                       const LeaseInfoInternal& new_lease,
+                                       const core::ExecutionResult& result);
+
   // Database helper functions
+  void ConstructLockRowKey(core::SingleDatabaseItemRequest& request);
+  core::ExecutionResult ConstructLeaseWriteRequest(
+      const LeaseInfoInternal& previous_lease,
+      const LeaseInfoInternal& new_lease,
+      core::UpsertDatabaseItemRequest& request);
   core::ExecutionResult WriteLeaseSynchronouslyToDatabase(
       const LeaseInfoInternal& previous_lease,
       const LeaseInfoInternal& new_lease);
@@ -181,6 +300,17 @@ class LeasableLockOnNoSQLDatabase : public core::LeasableLockInterface {
    */
   mutable std::mutex mutex_;
 
+  /**
+   * @brief Whether a lease refresh is in progress. The refreshes of the lock
+   * do not overlap.
+   */
+  std::atomic<bool> is_refresh_in_progress_;
+
+  /**
+   * @brief Executor of the retries after their back off, if set.
+   */
+  std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
+
   /**
    * @brief Identity of the lease acquirer
    */
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pbs/leasable_lock/src/leasable_lock_on_nosql_database_batch_refresher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/uuid/src/uuid.h"
+#include "pbs/leasable_lock/src/error_codes.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::BatchGetDatabaseItemsRequest;
+using google::scp::core::BatchGetDatabaseItemsResponse;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::GetDatabaseItemRequest;
+using google::scp::core::LeasableLockInterface;
+using google::scp::core::NoSQLDatabaseProviderInterface;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::UpsertDatabaseItemRequest;
+using google::scp::core::UpsertDatabaseItemResponse;
+using google::scp::core::common::Uuid;
+using std::atomic;
+using std::dynamic_pointer_cast;
+using std::make_shared;
+using std::map;
+using std::min;
+using std::optional;
+using std::shared_ptr;
+using std::vector;
+using std::chrono::milliseconds;
+using std::this_thread::sleep_for;
+
+static constexpr char kLeasableLockBatchRefresher[] =
+    "LeasableLockBatchRefresher";
+
+namespace {
+/// Waits for the requests that were sent to complete.
+void WaitForRequests(const atomic<size_t>& pending_request_count) {
+  while (pending_request_count > 0) {
+    sleep_for(milliseconds(5));
+  }
+}
+}  // namespace
+
+namespace google::scp::pbs {
+LeasableLockOnNoSQLDatabaseBatchRefresher::
+    LeasableLockOnNoSQLDatabaseBatchRefresher()
+    : activity_id_(Uuid::GenerateUuid()) {}
+
+vector<ExecutionResult>
+LeasableLockOnNoSQLDatabaseBatchRefresher::RefreshLeases(
+    const vector<shared_ptr<LeasableLockInterface>>& leasable_locks,
+    const vector<bool>& is_read_only_lease_refresh) noexcept {
+  vector<ExecutionResult> results(leasable_locks.size(),
+                                  SuccessExecutionResult());
+  vector<size_t> lock_indices;
+  vector<shared_ptr<LeasableLockOnNoSQLDatabase>> locks;
+  for (size_t i = 0; i < leasable_locks.size(); i++) {
+    auto lock =
+        dynamic_pointer_cast<LeasableLockOnNoSQLDatabase>(leasable_locks[i]);
+    if (!lock) {
+      results[i] = leasable_locks[i]->RefreshLease(
+          is_read_only_lease_refresh[i]);
+      continue;
+    }
+    // As with RefreshLease, the refreshes of a lock do not overlap.
+    if (lock->is_refresh_in_progress_.exchange(true)) {
+      results[i] = FailureExecutionResult(
+          core::errors::SC_LEASABLE_LOCK_REFRESH_IN_PROGRESS);
+      continue;
+    }
+    lock_indices.push_back(i);
+    locks.push_back(lock);
+  }
+  if (locks.empty()) {
+    return results;
+  }
+
+  SCP_INFO(kLeasableLockBatchRefresher, activity_id_,
+           "Starting to refresh the leases of '%llu' locks.", locks.size());
+
+  vector<LeaseInfoInternal> leases_read(locks.size());
+  auto read_results = ReadLeases(locks, leases_read);
+
+  vector<size_t> write_indices;
+  vector<shared_ptr<LeasableLockOnNoSQLDatabase>> locks_to_write;
+  vector<LeaseInfoInternal> leases_to_write_on;
+  vector<LeaseInfoInternal> new_leases;
+  for (size_t i = 0; i < locks.size(); i++) {
+    auto& result = results[lock_indices[i]];
+    if (!read_results[i].Successful()) {
+      SCP_ERROR(kLeasableLockBatchRefresher, activity_id_, read_results[i],
+                "LockId: '%s', Failed to read the lease.",
+                locks[i]->lock_row_key_.c_str());
+      result = read_results[i];
+      continue;
+    }
+    optional<LeaseInfoInternal> new_lease;
+    result = locks[i]->OnLeaseRead(
+        leases_read[i], is_read_only_lease_refresh[lock_indices[i]],
+        new_lease);
+    if (result.Successful() && new_lease.has_value()) {
+      write_indices.push_back(i);
+      locks_to_write.push_back(locks[i]);
+      leases_to_write_on.push_back(leases_read[i]);
+      new_leases.push_back(*new_lease);
+    }
+  }
+
+  if (!locks_to_write.empty()) {
+    auto write_results =
+        WriteLeases(locks_to_write, leases_to_write_on, new_leases);
+    for (size_t i = 0; i < locks_to_write.size(); i++) {
+      results[lock_indices[write_indices[i]]] =
+          locks_to_write[i]->OnLeaseWritten(leases_to_write_on[i],
+                                            new_leases[i], write_results[i]);
+    }
+  }
+
+  for (const auto& lock : locks) {
+    lock->is_refresh_in_progress_ = false;
+  }
+  return results;
+}
+
+vector<ExecutionResult> LeasableLockOnNoSQLDatabaseBatchRefresher::ReadLeases(
+    const vector<shared_ptr<LeasableLockOnNoSQLDatabase>>& locks,
+    vector<LeaseInfoInternal>& leases_read) noexcept {
+  vector<ExecutionResult> results(locks.size(), SuccessExecutionResult());
+
+  // The rows of the locks on the same database are read together.
+  map<NoSQLDatabaseProviderInterface*, vector<size_t>> lock_indices_by_database;
+  for (size_t i = 0; i < locks.size(); i++) {
+    lock_indices_by_database[locks[i]->database_.get()].push_back(i);
+  }
+
+  struct BatchRead {
+    shared_ptr<NoSQLDatabaseProviderInterface> database;
+    vector<size_t> lock_indices;
+    AsyncContext<BatchGetDatabaseItemsRequest, BatchGetDatabaseItemsResponse>
+        context;
+  };
+  vector<BatchRead> batch_reads;
+  for (const auto& [database, lock_indices] : lock_indices_by_database) {
+    for (size_t start = 0; start < lock_indices.size();
+         start += kMaxLockRowsPerBatchRead) {
+      auto end = min(start + kMaxLockRowsPerBatchRead, lock_indices.size());
+      BatchRead batch_read;
+      batch_read.database = locks[lock_indices[start]]->database_;
+      batch_read.lock_indices.assign(lock_indices.begin() + start,
+                                     lock_indices.begin() + end);
+      batch_read.context.request = make_shared<BatchGetDatabaseItemsRequest>();
+      for (auto lock_index : batch_read.lock_indices) {
+        auto item = make_shared<GetDatabaseItemRequest>();
+        locks[lock_index]->ConstructLockRowKey(*item);
+        batch_read.context.request->items.push_back(item);
+      }
+      batch_reads.push_back(std::move(batch_read));
+    }
+  }
+
+  atomic<size_t> pending_request_count = batch_reads.size();
+  for (auto& batch_read : batch_reads) {
+    batch_read.context.callback = [&batch_read, &pending_request_count](
+                                      auto& context) {
+      batch_read.context.result = context.result;
+      batch_read.context.response = context.response;
+      pending_request_count--;
+    };
+    auto result =
+        batch_read.database->BatchGetDatabaseItems(batch_read.context);
+    if (!result.Successful()) {
+      batch_read.context.result = result;
+      pending_request_count--;
+    }
+  }
+  WaitForRequests(pending_request_count);
+
+  for (const auto& batch_read : batch_reads) {
+    const auto& response = batch_read.context.response;
+    for (size_t i = 0; i < batch_read.lock_indices.size(); i++) {
+      auto lock_index = batch_read.lock_indices[i];
+      if (!batch_read.context.result.Successful()) {
+        results[lock_index] = batch_read.context.result;
+        continue;
+      }
+      if (!response || response->item_results.size() <= i ||
+          response->items.size() <= i) {
+        results[lock_index] = FailureExecutionResult(
+            core::errors::SC_LEASABLE_LOCK_MISSING_FROM_BATCH_READ);
+        continue;
+      }
+      if (!response->item_results[i].Successful()) {
+        results[lock_index] = response->item_results[i];
+        continue;
+      }
+      if (!response->items[i] || !response->items[i]->attributes) {
+        results[lock_index] = FailureExecutionResult(
+            core::errors::SC_LEASABLE_LOCK_MISSING_FROM_BATCH_READ);
+        continue;
+      }
+      results[lock_index] = locks[lock_index]->ObtainLeaseInfoFromAttributes(
+          response->items[i]->attributes, leases_read[lock_index]);
+    }
+  }
+  return results;
+}
+
+vector<ExecutionResult> LeasableLockOnNoSQLDatabaseBatchRefresher::WriteLeases(
+    const vector<shared_ptr<LeasableLockOnNoSQLDatabase>>& locks,
+    const vector<LeaseInfoInternal>& leases_read,
+    const vector<LeaseInfoInternal>& new_leases) noexcept {
+  vector<ExecutionResult> results(locks.size(), SuccessExecutionResult());
+  vector<AsyncContext<UpsertDatabaseItemRequest, UpsertDatabaseItemResponse>>
+      contexts(locks.size());
+  for (size_t i = 0; i < locks.size(); i++) {
+    contexts[i].request = make_shared<UpsertDatabaseItemRequest>();
+    results[i] = locks[i]->ConstructLeaseWriteRequest(
+        leases_read[i], new_leases[i], *contexts[i].request);
+  }
+
+  // The writes are conditional on the lease read, so they are sent all at
+  // once.
+  atomic<size_t> pending_request_count = 0;
+  for (size_t i = 0; i < locks.size(); i++) {
+    if (!results[i].Successful()) {
+      continue;
+    }
+    contexts[i].callback = [&results, &pending_request_count, i](
+                               auto& context) {
+      results[i] = context.result;
+      pending_request_count--;
+    };
+    pending_request_count++;
+    auto result = locks[i]->database_->UpsertDatabaseItem(contexts[i]);
+    if (!result.Successful()) {
+      results[i] = result;
+      pending_request_count--;
+    }
+  }
+  WaitForRequests(pending_request_count);
+  return results;
+}
+}  // namespace google::scp::pbs
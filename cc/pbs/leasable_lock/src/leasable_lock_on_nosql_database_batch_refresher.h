@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "core/interface/lease_manager_interface.h"
+#include "pbs/leasable_lock/src/leasable_lock_on_nosql_database.h"
+
+namespace google::scp::pbs {
+
+/// The most lock rows read with one batch read, which is what a DynamoDB
+/// BatchGetItem request can carry.
+constexpr size_t kMaxLockRowsPerBatchRead = 100;
+
+/**
+ * @copydoc core::LeasableLockBatchRefresherInterface
+ *
+ * The lock rows of the LeasableLockOnNoSQLDatabase locks are read with batch
+ * reads, one per database (and per kMaxLockRowsPerBatchRead rows), and the
+ * lease renewals are then all written concurrently, instead of one read and
+ * one write after the other for every lock. The refresh of any other lock is
+ * delegated to the lock itself.
+ */
+class LeasableLockOnNoSQLDatabaseBatchRefresher
+    : public core::LeasableLockBatchRefresherInterface {
+ public:
+  LeasableLockOnNoSQLDatabaseBatchRefresher();
+
+  std::vector<core::ExecutionResult> RefreshLeases(
+      const std::vector<std::shared_ptr<core::LeasableLockInterface>>&
+          leasable_locks,
+      const std::vector<bool>& is_read_only_lease_refresh) noexcept override;
+
+ protected:
+  using LeaseInfoInternal = LeasableLockOnNoSQLDatabase::LeaseInfoInternal;
+
+  /**
+   * @brief Reads the lock rows of the locks, in batches.
+   *
+   * @param locks the locks to read the rows of.
+   * @param leases_read the leases read, in the order of the locks.
+   * @return std::vector<core::ExecutionResult> the result of the read of each
+   * lock.
+   */
+  std::vector<core::ExecutionResult> ReadLeases(
+      const std::vector<std::shared_ptr<LeasableLockOnNoSQLDatabase>>& locks,
+      std::vector<LeaseInfoInternal>& leases_read) noexcept;
+
+  /**
+   * @brief Writes the new leases of the locks, all at once.
+   *
+   * @param locks the locks to write the lease of.
+   * @param leases_read the leases read, which the writes are conditioned on.
+   * @param new_leases the leases to write.
+   * @return std::vector<core::ExecutionResult> the result of the write of
+   * each lock.
+   */
+  std::vector<core::ExecutionResult> WriteLeases(
+      const std::vector<std::shared_ptr<LeasableLockOnNoSQLDatabase>>& locks,
+      const std::vector<LeaseInfoInternal>& leases_read,
+      const std::vector<LeaseInfoInternal>& new_leases) noexcept;
+
+  /// @brief Activity ID of the object.
+  const core::common::Uuid activity_id_;
+};
+}  // namespace google::scp::pbs
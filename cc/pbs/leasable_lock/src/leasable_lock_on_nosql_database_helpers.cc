@@ -34,6 +34,7 @@ using google::scp::core::NoSQLDatabaseAttributeName;
 using google::scp::core::NoSqlDatabaseKeyValuePair;
 using google::scp::core::NoSQLDatabaseProviderInterface;
 using google::scp::core::NoSQLDatabaseValidAttributeValueTypes;
+using google::scp::core::SingleDatabaseItemRequest;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::TimeDuration;
 using google::scp::core::UpsertDatabaseItemRequest;
@@ -135,6 +136,34 @@ ExecutionResult LeasableLockOnNoSQLDatabase::ObtainLeaseInfoFromAttributes(
   return SuccessExecutionResult();
 }
 
+void LeasableLockOnNoSQLDatabase::ConstructLockRowKey(
+    SingleDatabaseItemRequest& request) {
+  request.table_name = make_shared<string>(table_name_);
+  request.partition_key = make_shared<NoSqlDatabaseKeyValuePair>();
+  request.partition_key->attribute_name =
+      make_shared<string>(kPBSPartitionLockTableLockIdKeyName);
+  request.partition_key->attribute_value =
+      make_shared<NoSQLDatabaseValidAttributeValueTypes>(lock_row_key_);
+}
+
+ExecutionResult LeasableLockOnNoSQLDatabase::ConstructLeaseWriteRequest(
+    const LeaseInfoInternal& previous_lease, const LeaseInfoInternal& new_lease,
+    UpsertDatabaseItemRequest& request) {
+  ConstructLockRowKey(request);
+
+  // Old attributes (conditional statement)
+  request.attributes = make_shared<vector<NoSqlDatabaseKeyValuePair>>();
+  auto result = ConstructAttributesFromLeaseInfo(previous_lease,
+                                                 request.attributes);
+  if (!result.Successful()) {
+    return result;
+  }
+
+  // New attributes
+  request.new_attributes = make_shared<vector<NoSqlDatabaseKeyValuePair>>();
+  return ConstructAttributesFromLeaseInfo(new_lease, request.new_attributes);
+}
+
 ExecutionResult LeasableLockOnNoSQLDatabase::WriteLeaseSynchronouslyToDatabase(
     const LeaseInfoInternal& previous_lease,
     const LeaseInfoInternal& new_lease) {
@@ -149,28 +178,8 @@ ExecutionResult LeasableLockOnNoSQLDatabase::WriteLeaseSynchronouslyToDatabase(
                         request_executed = true;
                       });
 
-  request_context.request->table_name = make_shared<string>(table_name_);
-  request_context.request->partition_key =
-      make_shared<NoSqlDatabaseKeyValuePair>();
-  request_context.request->partition_key->attribute_name =
-      make_shared<string>(kPBSPartitionLockTableLockIdKeyName);
-  request_context.request->partition_key->attribute_value =
-      make_shared<NoSQLDatabaseValidAttributeValueTypes>(lock_row_key_);
-
-  // Old attributes (conditional statement)
-  request_context.request->attributes =
-      make_shared<vector<NoSqlDatabaseKeyValuePair>>();
-  auto result = ConstructAttributesFromLeaseInfo(
-      previous_lease, request_context.request->attributes);
-  if (!result.Successful()) {
-    return result;
-  }
-
-  // New attributes
-  request_context.request->new_attributes =
-      make_shared<vector<NoSqlDatabaseKeyValuePair>>();
-  result = ConstructAttributesFromLeaseInfo(
-      new_lease, request_context.request->new_attributes);
+  auto result = ConstructLeaseWriteRequest(previous_lease, new_lease,
+                                          *request_context.request);
   if (!result.Successful()) {
     return result;
   }
@@ -203,13 +212,7 @@ ExecutionResult LeasableLockOnNoSQLDatabase::ReadLeaseSynchronouslyFromDatabase(
         request_executed = true;
       });
 
-  request_context.request->table_name = make_shared<string>(table_name_);
-  request_context.request->partition_key =
-      make_shared<NoSqlDatabaseKeyValuePair>();
-  request_context.request->partition_key->attribute_name =
-      make_shared<string>(kPBSPartitionLockTableLockIdKeyName);
-  request_context.request->partition_key->attribute_value =
-      make_shared<NoSQLDatabaseValidAttributeValueTypes>(lock_row_key_);
+  ConstructLockRowKey(*request_context.request);
 
   auto result = database_->GetDatabaseItem(request_context);
   if (!result.Successful()) {
@@ -0,0 +1,222 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pbs/leasable_lock/src/leasable_lock_on_nosql_database_batch_refresher.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/interface/nosql_database_provider_interface.h"
+#include "core/nosql_database_provider/mock/mock_nosql_database_provider_no_overrides.h"
+#include "pbs/leasable_lock/mock/mock_leasable_lock.h"
+#include "pbs/leasable_lock/src/error_codes.h"
+#include "pbs/leasable_lock/src/leasable_lock_on_nosql_database.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::BatchGetDatabaseItemsRequest;
+using google::scp::core::BatchGetDatabaseItemsResponse;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::GetDatabaseItemResponse;
+using google::scp::core::LeasableLockInterface;
+using google::scp::core::LeaseInfo;
+using google::scp::core::NoSQLDatabaseAttributeName;
+using google::scp::core::NoSqlDatabaseKeyValuePair;
+using google::scp::core::NoSQLDatabaseValidAttributeValueTypes;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::UpsertDatabaseItemRequest;
+using google::scp::core::UpsertDatabaseItemResponse;
+using google::scp::core::nosql_database_provider::mock::
+    MockNoSQLDatabaseProviderNoOverrides;
+using google::scp::core::test::ResultIs;
+using google::scp::pbs::leasable_lock::mock::MockLeasableLock;
+using std::get;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::chrono::milliseconds;
+using testing::_;
+
+static constexpr char kPBSPartitionLockTableDefaultName[] =
+    "pbs_partition_lock_table";
+
+namespace google::scp::pbs::test {
+
+/// Builds the attributes of a lock row with an expired lease.
+static shared_ptr<vector<NoSqlDatabaseKeyValuePair>> ExpiredLockRowAttributes(
+    const string& lease_acquisition_disallowed = "false") {
+  return make_shared<vector<NoSqlDatabaseKeyValuePair>>(
+      vector<NoSqlDatabaseKeyValuePair>{
+          {make_shared<NoSQLDatabaseAttributeName>(
+               kPBSPartitionLockTableLeaseOwnerIdAttributeName),
+           make_shared<NoSQLDatabaseValidAttributeValueTypes>("other")},
+          {make_shared<NoSQLDatabaseAttributeName>(
+               kPBSLockTableLeaseOwnerServiceEndpointAddressAttributeName),
+           make_shared<NoSQLDatabaseValidAttributeValueTypes>("10.1.1.9")},
+          {make_shared<NoSQLDatabaseAttributeName>(
+               kPBSPartitionLockTableLeaseExpirationTimestampAttributeName),
+           make_shared<NoSQLDatabaseValidAttributeValueTypes>("0")},
+          {make_shared<NoSQLDatabaseAttributeName>(
+               kPBSLockTableLeaseAcquisitionDisallowedAttributeName),
+           make_shared<NoSQLDatabaseValidAttributeValueTypes>(
+               lease_acquisition_disallowed)}});
+}
+
+class LeasableLockOnNoSQLDatabaseBatchRefresherTest : public ::testing::Test {
+ protected:
+  LeasableLockOnNoSQLDatabaseBatchRefresherTest() {
+    mock_nosql_database_provider_ =
+        make_shared<MockNoSQLDatabaseProviderNoOverrides>();
+    for (int i = 0; i < 3; i++) {
+      locks_.push_back(make_shared<LeasableLockOnNoSQLDatabase>(
+          mock_nosql_database_provider_, lease_acquirer_,
+          kPBSPartitionLockTableDefaultName, std::to_string(i),
+          milliseconds(10000)));
+    }
+  }
+
+  /// Answers the batch reads with the given row attributes of each lock.
+  void ReturnLockRows(
+      const vector<shared_ptr<vector<NoSqlDatabaseKeyValuePair>>>& rows) {
+    EXPECT_CALL(*mock_nosql_database_provider_, BatchGetDatabaseItems)
+        .WillOnce([rows](AsyncContext<BatchGetDatabaseItemsRequest,
+                                      BatchGetDatabaseItemsResponse>& context) {
+          EXPECT_EQ(context.request->items.size(), rows.size());
+          context.response = make_shared<BatchGetDatabaseItemsResponse>();
+          for (size_t i = 0; i < context.request->items.size(); i++) {
+            const auto& item = context.request->items[i];
+            EXPECT_EQ(*item->table_name, kPBSPartitionLockTableDefaultName);
+            EXPECT_EQ(get<string>(*item->partition_key->attribute_value),
+                      std::to_string(i));
+            if (!rows[i]) {
+              context.response->item_results.push_back(
+                  FailureExecutionResult(SC_UNKNOWN));
+              context.response->items.push_back(nullptr);
+              continue;
+            }
+            auto item_response = make_shared<GetDatabaseItemResponse>();
+            item_response->attributes = rows[i];
+            context.response->item_results.push_back(SuccessExecutionResult());
+            context.response->items.push_back(item_response);
+          }
+          context.result = SuccessExecutionResult();
+          context.callback(context);
+          return SuccessExecutionResult();
+        });
+  }
+
+  LeaseInfo lease_acquirer_{"123", "10.1.1.1"};
+  shared_ptr<MockNoSQLDatabaseProviderNoOverrides>
+      mock_nosql_database_provider_;
+  vector<shared_ptr<LeasableLockOnNoSQLDatabase>> locks_;
+  LeasableLockOnNoSQLDatabaseBatchRefresher batch_refresher_;
+};
+
+TEST_F(LeasableLockOnNoSQLDatabaseBatchRefresherTest,
+       ReadsTheLockRowsInOneBatchAndWritesTheRenewals) {
+  ReturnLockRows({ExpiredLockRowAttributes(), ExpiredLockRowAttributes(),
+                  ExpiredLockRowAttributes()});
+  vector<string> written_lock_ids;
+  EXPECT_CALL(*mock_nosql_database_provider_, UpsertDatabaseItem)
+      .Times(2)
+      .WillRepeatedly([&](AsyncContext<UpsertDatabaseItemRequest,
+                                       UpsertDatabaseItemResponse>& context) {
+        written_lock_ids.push_back(
+            get<string>(*context.request->partition_key->attribute_value));
+        // Conditioned on the lease read, and acquiring the lease.
+        EXPECT_EQ(get<string>(*context.request->attributes->at(0)
+                                   .attribute_value),
+                  "other");
+        EXPECT_EQ(get<string>(*context.request->new_attributes->at(0)
+                                   .attribute_value),
+                  lease_acquirer_.lease_acquirer_id);
+        context.result = SuccessExecutionResult();
+        context.callback(context);
+        return SuccessExecutionResult();
+      });
+
+  auto results = batch_refresher_.RefreshLeases(
+      {locks_[0], locks_[1], locks_[2]}, {false, false, true});
+
+  ASSERT_EQ(results.size(), 3);
+  for (const auto& result : results) {
+    EXPECT_SUCCESS(result);
+  }
+  EXPECT_EQ(written_lock_ids, (vector<string>{"0", "1"}));
+  EXPECT_TRUE(locks_[0]->IsCurrentLeaseOwner());
+  EXPECT_TRUE(locks_[1]->IsCurrentLeaseOwner());
+  // The read only refresh does not acquire the expired lease.
+  EXPECT_FALSE(locks_[2]->IsCurrentLeaseOwner());
+  EXPECT_FALSE(locks_[2]->GetCurrentLeaseOwnerInfo().has_value());
+}
+
+TEST_F(LeasableLockOnNoSQLDatabaseBatchRefresherTest,
+       ReturnsTheResultOfEachLock) {
+  ReturnLockRows({nullptr, ExpiredLockRowAttributes("true"),
+                  ExpiredLockRowAttributes()});
+  EXPECT_CALL(*mock_nosql_database_provider_, UpsertDatabaseItem)
+      .WillOnce([&](AsyncContext<UpsertDatabaseItemRequest,
+                                 UpsertDatabaseItemResponse>& context) {
+        context.result = FailureExecutionResult(SC_UNKNOWN);
+        context.callback(context);
+        return SuccessExecutionResult();
+      });
+
+  auto results = batch_refresher_.RefreshLeases(
+      {locks_[0], locks_[1], locks_[2]}, {false, false, false});
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_THAT(results[0], ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+  EXPECT_THAT(results[1],
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_LEASABLE_LOCK_ACQUISITION_DISALLOWED)));
+  EXPECT_THAT(results[2], ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+  EXPECT_FALSE(locks_[2]->IsCurrentLeaseOwner());
+}
+
+TEST_F(LeasableLockOnNoSQLDatabaseBatchRefresherTest,
+       FailsAllTheLocksWhenTheBatchReadFails) {
+  EXPECT_CALL(*mock_nosql_database_provider_, BatchGetDatabaseItems)
+      .WillOnce([](AsyncContext<BatchGetDatabaseItemsRequest,
+                                BatchGetDatabaseItemsResponse>& context) {
+        context.result = FailureExecutionResult(SC_UNKNOWN);
+        context.callback(context);
+        return SuccessExecutionResult();
+      });
+  EXPECT_CALL(*mock_nosql_database_provider_, UpsertDatabaseItem).Times(0);
+
+  auto results =
+      batch_refresher_.RefreshLeases({locks_[0], locks_[1]}, {false, false});
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_THAT(results[0], ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+  EXPECT_THAT(results[1], ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+}
+
+TEST_F(LeasableLockOnNoSQLDatabaseBatchRefresherTest,
+       RefreshesOtherLocksByThemselves) {
+  EXPECT_CALL(*mock_nosql_database_provider_, BatchGetDatabaseItems).Times(0);
+  auto other_lock = make_shared<MockLeasableLock>(1000);
+
+  auto results = batch_refresher_.RefreshLeases({other_lock}, {false});
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_SUCCESS(results[0]);
+}
+}  // namespace google::scp::pbs::test
@@ -34,6 +34,7 @@ using google::scp::core::NoSQLDatabaseAttributeName;
 using google::scp::core::NoSqlDatabaseKeyValuePair;
 using google::scp::core::NoSQLDatabaseProviderInterface;
 using google::scp::core::NoSQLDatabaseValidAttributeValueTypes;
+using google::scp::core::RetryExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::UpsertDatabaseItemRequest;
 using google::scp::core::UpsertDatabaseItemResponse;
@@ -768,4 +769,109 @@ TEST_F(LeasableLockOnNoSQLDatabaseTest, LeaseIsNotWrittenIfReadOnlyIsTrue) {
             lease_acquirer_2_.service_endpoint_address);
 }
 
+TEST_F(LeasableLockOnNoSQLDatabaseTest,
+       RefreshLeaseRetriesRetriableReadFailures) {
+  SetOverridesOnMockNoSQLDatabase(mock_nosql_database_provider_,
+                                  lease_acquirer_1_, milliseconds(0));
+  auto get_database_item = [&](AsyncContext<GetDatabaseItemRequest,
+                                            GetDatabaseItemResponse>& context) {
+    context.result = RetryExecutionResult(SC_UNKNOWN);
+    context.callback(context);
+    return SuccessExecutionResult();
+  };
+  EXPECT_CALL(*mock_nosql_database_provider_, GetDatabaseItem)
+      .WillOnce(get_database_item)
+      .WillOnce(get_database_item)
+      .WillRepeatedly(::testing::DoDefault());
+  EXPECT_CALL(*mock_nosql_database_provider_, UpsertDatabaseItem).Times(1);
+
+  LeasableLockOnNoSQLDatabasePrivate leasable_lock(
+      nosql_database_provider_, lease_acquirer_1_, lease_table_name_,
+      leasable_lock_key_, seconds(10), lease_renewal_percent_time_left_);
+  EXPECT_SUCCESS(
+      leasable_lock.RefreshLease(false /* is_read_only_lease_refresh */));
+  EXPECT_TRUE(leasable_lock.IsCurrentLeaseOwner());
+}
+
+TEST_F(LeasableLockOnNoSQLDatabaseTest,
+       RefreshLeaseReadsAgainAfterRetriableWriteFailure) {
+  SetOverridesOnMockNoSQLDatabase(mock_nosql_database_provider_,
+                                  lease_acquirer_1_, milliseconds(0));
+  EXPECT_CALL(*mock_nosql_database_provider_, GetDatabaseItem).Times(2);
+  EXPECT_CALL(*mock_nosql_database_provider_, UpsertDatabaseItem)
+      .WillOnce([](AsyncContext<UpsertDatabaseItemRequest,
+                                UpsertDatabaseItemResponse>& context) {
+        context.result = RetryExecutionResult(SC_UNKNOWN);
+        context.callback(context);
+        return SuccessExecutionResult();
+      })
+      .WillRepeatedly(::testing::DoDefault());
+
+  LeasableLockOnNoSQLDatabasePrivate leasable_lock(
+      nosql_database_provider_, lease_acquirer_1_, lease_table_name_,
+      leasable_lock_key_, seconds(10), lease_renewal_percent_time_left_);
+  EXPECT_SUCCESS(
+      leasable_lock.RefreshLease(false /* is_read_only_lease_refresh */));
+  EXPECT_TRUE(leasable_lock.IsCurrentLeaseOwner());
+}
+
+TEST_F(LeasableLockOnNoSQLDatabaseTest,
+       RefreshLeaseDoesNotRetryPastTheDeadline) {
+  // The deadline is 50ms after the start, which leaves room for the first
+  // retry after 20ms, but not for the second one after 40ms.
+  std::atomic<size_t> read_count = 0;
+  EXPECT_CALL(*mock_nosql_database_provider_, GetDatabaseItem)
+      .WillRepeatedly([&](AsyncContext<GetDatabaseItemRequest,
+                                       GetDatabaseItemResponse>& context) {
+        read_count++;
+        return RetryExecutionResult(SC_UNKNOWN);
+      });
+
+  LeasableLockOnNoSQLDatabasePrivate leasable_lock(
+      nosql_database_provider_, lease_acquirer_1_, lease_table_name_,
+      leasable_lock_key_, milliseconds(100), lease_renewal_percent_time_left_);
+  EXPECT_THAT(
+      leasable_lock.RefreshLease(false /* is_read_only_lease_refresh */),
+      ResultIs(RetryExecutionResult(SC_UNKNOWN)));
+  EXPECT_EQ(read_count, 2);
+  EXPECT_FALSE(leasable_lock.IsCurrentLeaseOwner());
+}
+
+TEST_F(LeasableLockOnNoSQLDatabaseTest,
+       RefreshLeaseAsyncDoesNotOverlapRefreshes) {
+  SetOverridesOnMockNoSQLDatabase(mock_nosql_database_provider_,
+                                  lease_acquirer_1_, milliseconds(0));
+  AsyncContext<GetDatabaseItemRequest, GetDatabaseItemResponse> read_context;
+  EXPECT_CALL(*mock_nosql_database_provider_, GetDatabaseItem)
+      .WillOnce([&](AsyncContext<GetDatabaseItemRequest,
+                                 GetDatabaseItemResponse>& context) {
+        read_context = context;
+        return SuccessExecutionResult();
+      })
+      .WillRepeatedly(::testing::DoDefault());
+
+  LeasableLockOnNoSQLDatabasePrivate leasable_lock(
+      nosql_database_provider_, lease_acquirer_1_, lease_table_name_,
+      leasable_lock_key_, seconds(10), lease_renewal_percent_time_left_);
+  std::optional<ExecutionResult> refresh_result;
+  EXPECT_SUCCESS(leasable_lock.RefreshLeaseAsync(
+      false /* is_read_only_lease_refresh */,
+      [&](const ExecutionResult& result) { refresh_result = result; }));
+  EXPECT_THAT(leasable_lock.RefreshLeaseAsync(
+                  false /* is_read_only_lease_refresh */,
+                  [](const ExecutionResult&) { FAIL(); }),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_LEASABLE_LOCK_REFRESH_IN_PROGRESS)));
+  EXPECT_FALSE(refresh_result.has_value());
+
+  // The read completes without the lock row, so there is no lease to write.
+  read_context.result = FailureExecutionResult(SC_UNKNOWN);
+  read_context.Finish();
+
+  ASSERT_TRUE(refresh_result.has_value());
+  EXPECT_THAT(*refresh_result, ResultIs(FailureExecutionResult(SC_UNKNOWN)));
+  EXPECT_SUCCESS(
+      leasable_lock.RefreshLease(false /* is_read_only_lease_refresh */));
+}
+
 }  // namespace google::scp::pbs::test
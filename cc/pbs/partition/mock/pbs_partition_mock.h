@@ -59,6 +59,11 @@ class MockPBSPartition : public testing::NiceMock<PBSPartitionInterface> {
                core::GetTransactionManagerStatusResponse& response),
               (override, noexcept));
 
+  MOCK_METHOD(PartitionLoad, GetPartitionLoad, (), (override, noexcept));
+
+  MOCK_METHOD(core::ExecutionResult, RecoverAsStandby, (),
+              (override, noexcept));
+
   std::atomic<core::PartitionLoadUnloadState> partition_state_ =
       core::PartitionLoadUnloadState::Created;
 };
@@ -54,4 +54,8 @@ DEFINE_ERROR_CODE(SC_PBS_PARTITION_IS_REMOTE_CANNOT_HANDLE_REQUEST,
                   "This is a remote partition and request cannot be handled.",
                   HttpStatusCode::SERVICE_UNAVAILABLE)
 
+DEFINE_ERROR_CODE(SC_PBS_PARTITION_SHEDDING_LOAD, SC_PBS_PARTITION, 0x0009,
+                  "PBS partition is shedding load under memory pressure.",
+                  HttpStatusCode::SERVICE_UNAVAILABLE)
+
 }  // namespace google::scp::core::errors
@@ -16,7 +16,10 @@
 
 #include "pbs/partition/src/pbs_partition.h"
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/journal_service_interface.h"
@@ -119,6 +122,22 @@ ExecutionResult PBSPartition::Init() noexcept {
         core::errors::SC_PBS_PARTITION_CANNOT_INITIALIZE);
   }
 
+  RETURN_IF_FAILURE(InitPartitionComponents());
+
+  current_state = PartitionLoadUnloadState::Created;
+  if (!partition_state_.compare_exchange_strong(
+          current_state, PartitionLoadUnloadState::Initialized)) {
+    return FailureExecutionResult(
+        core::errors::SC_PBS_PARTITION_CANNOT_INITIALIZE);
+  }
+
+  SCP_INFO(kPBSPartition, partition_id_, "Initialized Partition with ID: %s",
+           ToString(partition_id_).c_str());
+
+  return SuccessExecutionResult();
+}
+
+ExecutionResult PBSPartition::InitPartitionComponents() {
   std::shared_ptr<std::string> partition_id_str =
       std::make_shared<std::string>(ToString(partition_id_));
 
@@ -130,13 +149,6 @@ ExecutionResult PBSPartition::Init() noexcept {
       partition_dependencies_.metric_router,
       partition_dependencies_.config_provider);
 
-  checkpoint_service_ = std::make_shared<CheckpointService>(
-      partition_journal_bucket_name_, partition_id_str,
-      partition_dependencies_.metric_client,
-      partition_dependencies_.metric_router,
-      partition_dependencies_.config_provider, journal_service_,
-      partition_dependencies_.blob_store_provider_for_checkpoints);
-
   budget_key_provider_ = std::make_shared<BudgetKeyProvider>(
       partition_dependencies_.async_executor, journal_service_,
       partition_dependencies_.nosql_database_provider_for_background_operations,
@@ -158,31 +170,53 @@ ExecutionResult PBSPartition::Init() noexcept {
       partition_dependencies_.metric_router,
       partition_dependencies_.config_provider, partition_id_);
 
+  checkpoint_service_ = std::make_shared<CheckpointService>(
+      partition_journal_bucket_name_, partition_id_str,
+      partition_dependencies_.metric_client,
+      partition_dependencies_.metric_router,
+      partition_dependencies_.config_provider, journal_service_,
+      partition_dependencies_.blob_store_provider_for_checkpoints,
+      budget_key_provider_, transaction_manager_);
+
   INIT_PBS_PARTITION_COMPONENT(journal_service_);
   INIT_PBS_PARTITION_COMPONENT(budget_key_provider_);
   INIT_PBS_PARTITION_COMPONENT(transaction_manager_);
   INIT_PBS_PARTITION_COMPONENT(checkpoint_service_);
 
-  current_state = PartitionLoadUnloadState::Created;
-  if (!partition_state_.compare_exchange_strong(
-          current_state, PartitionLoadUnloadState::Initialized)) {
-    return FailureExecutionResult(
-        core::errors::SC_PBS_PARTITION_CANNOT_INITIALIZE);
-  }
+  return SuccessExecutionResult();
+}
 
-  SCP_INFO(kPBSPartition, partition_id_, "Initialized Partition with ID: %s",
-           partition_id_str->c_str());
+ExecutionResult PBSPartition::RecoverPartition(bool is_standby) {
+  bool is_resumed = last_recovered_journal_id_.has_value();
+  auto execution_result = RecoverPartitionJournals(is_standby);
+  if (execution_result.Successful() || !is_resumed) {
+    return execution_result;
+  }
 
-  return SuccessExecutionResult();
+  // The failed recovery may have replayed some of the journals after the
+  // previous one, and may never succeed, e.g. if the journals were compacted
+  // into a segment across the journal it resumes after. The partition is
+  // recovered from the checkpoint again, with new components.
+  SCP_ERROR(kPBSPartition, partition_id_, execution_result,
+            "Resumed log recovery failed. Recovering from the checkpoint.");
+  last_recovered_journal_id_.reset();
+  RETURN_IF_FAILURE(InitPartitionComponents());
+  return RecoverPartitionJournals(is_standby);
 }
 
-ExecutionResult PBSPartition::RecoverPartition() {
+ExecutionResult PBSPartition::RecoverPartitionJournals(bool is_standby) {
   SCP_INFO(kPBSPartition, partition_id_, "Starting log recovery");
 
   std::atomic<bool> recovery_completed = false;
   std::atomic<bool> recovery_failed = false;
   AsyncContext<JournalRecoverRequest, JournalRecoverResponse> recovery_context;
   recovery_context.request = std::make_shared<JournalRecoverRequest>();
+  recovery_context.request->resume_after_journal_id =
+      last_recovered_journal_id_;
+  // The owner of the partition may still be persisting journals out of order,
+  // a standby only tails the ones known to be all persisted.
+  recovery_context.request->should_stop_at_last_checkpointed_journal =
+      is_standby;
   auto activity_id = Uuid::GenerateUuid();
   recovery_context.parent_activity_id = activity_id;
   recovery_context.correlation_id = activity_id;
@@ -193,6 +227,9 @@ ExecutionResult PBSPartition::RecoverPartition() {
           SCP_CRITICAL(kPBSPartition, partition_id_, recovery_context.result,
                        "Log recovery failed.");
           recovery_failed = true;
+        } else if (recovery_context.response) {
+          last_recovered_journal_id_ =
+              recovery_context.response->last_processed_journal_id;
         }
         recovery_completed = true;
       };
@@ -227,7 +264,29 @@ ExecutionResult PBSPartition::RecoverPartition() {
   return SuccessExecutionResult();
 }
 
+ExecutionResult PBSPartition::RecoverAsStandby() noexcept {
+  std::lock_guard<std::mutex> lock(recovery_mutex_);
+  auto current_state = partition_state_.load();
+  if (current_state != PartitionLoadUnloadState::Initialized) {
+    SCP_INFO(kPBSPartition, partition_id_,
+             "Cannot recover partition as standby at this state. Current "
+             "State is %llu",
+             static_cast<uint64_t>(current_state));
+    return FailureExecutionResult(
+        core::errors::SC_PBS_PARTITION_INVALID_PARTITON_STATE);
+  }
+
+  SCP_INFO(kPBSPartition, partition_id_,
+           "Recovering standby Partition with ID: %s",
+           ToString(partition_id_).c_str());
+
+  return RecoverPartition(/*is_standby=*/true);
+}
+
 ExecutionResult PBSPartition::Load() noexcept {
+  // A standby recovery in progress finishes first, so that this one only
+  // catches up on the journals written since.
+  std::lock_guard<std::mutex> lock(recovery_mutex_);
   auto current_state = PartitionLoadUnloadState::Initialized;
   if (!partition_state_.compare_exchange_strong(
           current_state, PartitionLoadUnloadState::Loading)) {
@@ -244,6 +303,17 @@ ExecutionResult PBSPartition::Load() noexcept {
 
   RUN_PBS_PARTITION_COMPONENT(journal_service_);
   RUN_PBS_PARTITION_COMPONENT(budget_key_provider_);
+  if (partition_dependencies_.memory_governor) {
+    std::weak_ptr<BudgetKeyProviderInterface> budget_key_provider =
+        budget_key_provider_;
+    memory_governor_target_id_ =
+        partition_dependencies_.memory_governor->RegisterTarget(
+            [budget_key_provider](double resource_scale) {
+              if (auto provider = budget_key_provider.lock()) {
+                provider->SetResourceScale(resource_scale);
+              }
+            });
+  }
   RUN_PBS_PARTITION_COMPONENT(transaction_manager_);
   RUN_PBS_PARTITION_COMPONENT(checkpoint_service_);
 
@@ -278,6 +348,11 @@ ExecutionResult PBSPartition::Unload() noexcept {
 
   STOP_PBS_PARTITION_COMPONENT(checkpoint_service_);
   STOP_PBS_PARTITION_COMPONENT(transaction_manager_);
+  if (memory_governor_target_id_) {
+    partition_dependencies_.memory_governor->UnregisterTarget(
+        *memory_governor_target_id_);
+    memory_governor_target_id_.reset();
+  }
   STOP_PBS_PARTITION_COMPONENT(budget_key_provider_);
   STOP_PBS_PARTITION_COMPONENT(journal_service_);
 
@@ -330,9 +405,22 @@ ExecutionResult PBSPartition::ExecuteRequest(
     return RetryExecutionResult(core::errors::SC_PBS_PARTITION_NOT_LOADED);
   }
 
+  // Only new transactions are refused, the phases of the ones in flight
+  // still complete so that their memory is released.
+  if (partition_dependencies_.memory_governor &&
+      partition_dependencies_.memory_governor->ShouldShedLoad()) {
+    return RetryExecutionResult(core::errors::SC_PBS_PARTITION_SHEDDING_LOAD);
+  }
+
   IncrementRequestCount();
 
   // Set budget command dependencies
+  // The commands of a budget key, e.g. one per time bucket, are usually
+  // generated one after the other. The hash of the name is only reused by the
+  // consecutive commands of the same name, a name seen again after another one
+  // is hashed again.
+  std::shared_ptr<BudgetKeyName> previous_budget_key_name;
+  size_t previous_budget_key_shard_key = 0;
   for (auto& command : context.request->commands) {
     auto consume_budget_command =
         std::dynamic_pointer_cast<ConsumeBudgetCommand>(command);
@@ -342,6 +430,19 @@ ExecutionResult PBSPartition::ExecuteRequest(
     }
     consume_budget_command->SetUpCommandExecutionDependencies(
         budget_key_provider_, partition_dependencies_.async_executor);
+    if (partition_dependencies_.budget_key_shard_routing_enabled) {
+      auto budget_key_name = consume_budget_command->GetBudgetKeyName();
+      if (!previous_budget_key_name ||
+          (budget_key_name != previous_budget_key_name &&
+           *budget_key_name != *previous_budget_key_name)) {
+        previous_budget_key_shard_key =
+            std::hash<std::string>()(*budget_key_name);
+        previous_budget_key_name = std::move(budget_key_name);
+      }
+      consume_budget_command->RouteToBudgetKeyShard(
+          partition_dependencies_.async_executor,
+          previous_budget_key_shard_key);
+    }
   }
 
   return transaction_manager_->Execute(context);
@@ -371,6 +472,18 @@ ExecutionResult PBSPartition::GetTransactionManagerStatus(
   return transaction_manager_->GetTransactionManagerStatus(request, response);
 }
 
+PartitionLoad PBSPartition::GetPartitionLoad() noexcept {
+  if (partition_state_ != PartitionLoadUnloadState::Loaded) {
+    return {};
+  }
+  PartitionLoad partition_load;
+  partition_load.requests_seen_count =
+      requests_seen_count_.load(std::memory_order::memory_order_relaxed);
+  partition_load.cached_budget_keys_count =
+      budget_key_provider_->GetCachedBudgetKeysCount();
+  return partition_load;
+}
+
 core::PartitionId PBSPartition::GetPartitionId() const {
   return partition_id_;
 }
@@ -17,15 +17,19 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 
 #include "core/interface/blob_storage_provider_interface.h"
 #include "core/interface/checkpoint_service_interface.h"
 #include "core/interface/config_provider_interface.h"
+#include "core/interface/journal_service_interface.h"
 #include "core/interface/nosql_database_provider_interface.h"
 #include "core/interface/partition_types.h"
 #include "core/interface/remote_transaction_manager_interface.h"
 #include "core/interface/transaction_manager_interface.h"
+#include "core/os/src/memory_governor.h"
 #include "core/telemetry/src/metric/metric_router.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
 #include "pbs/interface/budget_key_provider_interface.h"
@@ -66,6 +70,12 @@ class PBSPartition : public PBSPartitionInterface {
     /// PBS
     std::shared_ptr<core::RemoteTransactionManagerInterface>
         remote_transaction_manager;
+    /// @brief Sizes the budget key cache to the memory of the host and sheds
+    /// new transactions under memory pressure. Optional.
+    std::shared_ptr<core::os::MemoryGovernor> memory_governor;
+    /// @brief Whether the phases of the commands on the same budget key run
+    /// on the same async executor thread.
+    bool budget_key_shard_routing_enabled = false;
   };
 
   PBSPartition(const core::PartitionId& partition_id,
@@ -77,6 +87,8 @@ class PBSPartition : public PBSPartitionInterface {
 
   core::ExecutionResult Load() noexcept override;
 
+  core::ExecutionResult RecoverAsStandby() noexcept override;
+
   core::ExecutionResult Unload() noexcept override;
 
   core::PartitionLoadUnloadState GetPartitionState() noexcept override;
@@ -100,15 +112,37 @@ class PBSPartition : public PBSPartitionInterface {
       const core::GetTransactionManagerStatusRequest& request,
       core::GetTransactionManagerStatusResponse& response) noexcept override;
 
+  PartitionLoad GetPartitionLoad() noexcept override;
+
   core::PartitionId GetPartitionId() const;
 
  protected:
   /**
-   * @brief Perform Log Recovery on the partition synchronously.
+   * @brief Creates and initializes the components of the partition.
+   *
+   * @return core::ExecutionResult
+   */
+  core::ExecutionResult InitPartitionComponents();
+
+  /**
+   * @brief Perform Log Recovery on the partition synchronously. If resuming
+   * the previous recovery fails, the partition is recovered from the
+   * checkpoint again.
    *
+   * @param is_standby Whether the partition is recovered as a standby, i.e.
+   * only up to the last checkpointed journal.
    * @return core::ExecutionResult
    */
-  core::ExecutionResult RecoverPartition();
+  core::ExecutionResult RecoverPartition(bool is_standby = false);
+
+  /**
+   * @brief Recovers the journals after the previous recovery, if any, or from
+   * the checkpoint otherwise.
+   *
+   * @param is_standby Whether the partition is recovered as a standby.
+   * @return core::ExecutionResult
+   */
+  core::ExecutionResult RecoverPartitionJournals(bool is_standby);
 
   void IncrementRequestCount();
 
@@ -144,6 +178,18 @@ class PBSPartition : public PBSPartitionInterface {
   /// counter which becomes eventually consistent and should be used only for
   /// approximate calculations.
   std::atomic<size_t> requests_seen_count_;
+
+  /// @brief Serializes the log recoveries of the partition, i.e. the standby
+  /// recoveries and the one of Load().
+  std::mutex recovery_mutex_;
+
+  /// @brief The last journal processed by the previous log recovery, if any.
+  /// The next recovery only replays the journals after it.
+  std::optional<core::JournalId> last_recovered_journal_id_;
+
+  /// @brief The id of the budget key provider in the memory governor, while
+  /// the partition is loaded.
+  std::optional<size_t> memory_governor_target_id_;
 };
 
 };  // namespace google::scp::pbs
@@ -86,6 +86,13 @@ class RemotePBSPartition : public PBSPartitionInterface {
         core::errors::SC_PBS_PARTITION_IS_REMOTE_CANNOT_HANDLE_REQUEST);
   }
 
+  PartitionLoad GetPartitionLoad() noexcept override { return {}; }
+
+  core::ExecutionResult RecoverAsStandby() noexcept override {
+    return core::FailureExecutionResult(
+        core::errors::SC_PBS_PARTITION_IS_REMOTE_CANNOT_HANDLE_REQUEST);
+  }
+
  protected:
   std::atomic<core::PartitionLoadUnloadState> partition_state_;
 };
@@ -19,6 +19,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "cc/core/interface/metrics_def.h"
 #include "cc/core/telemetry/src/common/metric_utils.h"
 #include "core/async_executor/mock/mock_async_executor.h"
@@ -29,6 +35,7 @@
 #include "core/interface/async_context.h"
 #include "core/interface/partition_interface.h"
 #include "core/nosql_database_provider/mock/mock_nosql_database_provider.h"
+#include "core/os/src/memory_governor.h"
 #include "core/telemetry/mock/in_memory_metric_router.h"
 #include "core/test/utils/conditional_wait.h"
 #include "core/test/utils/logging_utils.h"
@@ -41,7 +48,10 @@
 
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutor;
+using google::scp::core::AsyncOperation;
+using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::GetTransactionManagerStatusRequest;
 using google::scp::core::GetTransactionManagerStatusResponse;
@@ -62,6 +72,8 @@ using google::scp::core::common::Uuid;
 using google::scp::core::config_provider::mock::MockConfigProvider;
 using google::scp::core::nosql_database_provider::mock::
     MockNoSQLDatabaseProvider;
+using google::scp::core::os::MemoryGovernor;
+using google::scp::core::os::linux::SystemResourceInfoProvider;
 using google::scp::core::test::ResultIs;
 using google::scp::core::test::TestLoggingUtils;
 using google::scp::core::test::WaitUntil;
@@ -71,6 +83,38 @@ using google::scp::pbs::ConsumeBudgetCommandRequestInfo;
 static constexpr char kPartitionsBucketName[] = "partitions";
 
 namespace google::scp::pbs::test {
+class FakeSystemResourceInfoProvider : public SystemResourceInfoProvider {
+ public:
+  ExecutionResultOr<uint64_t> GetAvailableMemoryKb() noexcept override {
+    return available_memory_kb;
+  }
+
+  uint64_t available_memory_kb = 0;
+};
+
+// Records the shard key of the work scheduled to a shard, without running it.
+class ShardKeyRecordingAsyncExecutor : public AsyncExecutor {
+ public:
+  using AsyncExecutor::AsyncExecutor;
+
+  ExecutionResult ScheduleToShard(const AsyncOperation& work,
+                                  AsyncPriority priority,
+                                  uint64_t shard_key) noexcept override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shard_keys_.push_back(shard_key);
+    return SuccessExecutionResult();
+  }
+
+  std::vector<uint64_t> GetShardKeys() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return shard_keys_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<uint64_t> shard_keys_;
+};
+
 
 class PBSPartitionTest : public testing::Test {
  protected:
@@ -186,6 +230,46 @@ class PBSPartitionTest : public testing::Test {
     std::filesystem::create_directory(dir);
   }
 
+  // Executes a transaction with a command per budget key name, on a partition
+  // routing the commands to their budget key shard, and returns the shard key
+  // each command is routed to.
+  std::vector<uint64_t> GetBudgetKeyShardKeys(
+      const std::vector<std::shared_ptr<BudgetKeyName>>& budget_key_names) {
+    auto async_executor = std::make_shared<ShardKeyRecordingAsyncExecutor>(
+        4 /* threads */, 10000 /* queue size */, true /* drop_tasks_on_stop */);
+    EXPECT_SUCCESS(async_executor->Init());
+    EXPECT_SUCCESS(async_executor->Run());
+    dependencies_.async_executor = async_executor;
+    dependencies_.budget_key_shard_routing_enabled = true;
+    partition_ = std::make_shared<PBSPartition>(partition_id_, dependencies_,
+                                                journal_bucket_name_,
+                                                transaction_manager_capacity_);
+    EXPECT_SUCCESS(partition_->Init());
+    EXPECT_SUCCESS(partition_->Load());
+
+    auto context = GetSampleTransactionRequestContext();
+    context.request->commands.clear();
+    TimeBucket time_bucket = 100;
+    for (const auto& budget_key_name : budget_key_names) {
+      context.request->commands.push_back(
+          std::make_shared<ConsumeBudgetCommand>(
+              context.request->transaction_id, budget_key_name,
+              ConsumeBudgetCommandRequestInfo(time_bucket++,
+                                              1 /* token count */)));
+    }
+    EXPECT_SUCCESS(partition_->ExecuteRequest(context));
+
+    // The prepare phase of each command is scheduled to its shard.
+    for (auto& command : context.request->commands) {
+      TransactionCommandCallback callback = [](ExecutionResult&) {};
+      EXPECT_SUCCESS(command->prepare(callback));
+    }
+
+    EXPECT_SUCCESS(partition_->Unload());
+    EXPECT_SUCCESS(async_executor->Stop());
+    return async_executor->GetShardKeys();
+  }
+
   void ExecuteAllRequestTypes(ExecutionResult expected_result) {
     EXPECT_THAT(partition_->ExecuteRequest(dummy_transaction_phase_request_),
                 ResultIs(expected_result));
@@ -265,6 +349,19 @@ TEST_F(PBSPartitionTest, PartitionCannotUnloadUntilLoaded) {
   EXPECT_SUCCESS(partition_->Unload());
 }
 
+TEST_F(PBSPartitionTest, StandbyOnlyRecoversOnceTheOwnerCheckpoints) {
+  EXPECT_SUCCESS(partition_->Init());
+
+  // With no checkpoint, no journal of the partition is known to be persisted
+  // along with all of the previous ones.
+  EXPECT_THAT(partition_->RecoverAsStandby(),
+              ResultIs(FailureExecutionResult(
+                  core::errors::SC_PBS_PARTITION_RECOVERY_FAILED)));
+
+  EXPECT_SUCCESS(partition_->Load());
+  EXPECT_SUCCESS(partition_->Unload());
+}
+
 TEST_F(PBSPartitionTest, PartitionAcceptsTransactionPhaseRequestAfterLoad) {
   EXPECT_SUCCESS(partition_->Init());
   EXPECT_SUCCESS(partition_->Load());
@@ -582,4 +679,52 @@ TEST_F(PBSPartitionTest, OTelRetrievesCorrectPartitionIdLabel) {
   EXPECT_SUCCESS(partition_->Unload());
 }
 
+TEST_F(PBSPartitionTest, PartitionShedsNewTransactionsUnderMemoryPressure) {
+  // No memory is available, so the governor sheds load from its first poll.
+  auto memory_governor = std::make_shared<MemoryGovernor>(
+      std::make_shared<FakeSystemResourceInfoProvider>(), async_executor_);
+  EXPECT_SUCCESS(memory_governor->Init());
+  EXPECT_SUCCESS(memory_governor->Run());
+  dependencies_.memory_governor = memory_governor;
+  partition_ = std::make_shared<PBSPartition>(partition_id_, dependencies_,
+                                              journal_bucket_name_,
+                                              transaction_manager_capacity_);
+  EXPECT_SUCCESS(partition_->Init());
+  EXPECT_SUCCESS(partition_->Load());
+
+  EXPECT_THAT(partition_->ExecuteRequest(dummy_transaction_request_),
+              ResultIs(RetryExecutionResult(
+                  core::errors::SC_PBS_PARTITION_SHEDDING_LOAD)));
+  // The phases of the transactions in flight are still executed.
+  EXPECT_SUCCESS(partition_->ExecuteRequest(dummy_transaction_phase_request_));
+
+  EXPECT_SUCCESS(partition_->Unload());
+  EXPECT_SUCCESS(memory_governor->Stop());
+}
+
+
+TEST_F(PBSPartitionTest, InterleavedBudgetKeysWithEqualNamesShareTheirShard) {
+  auto shard_keys = GetBudgetKeyShardKeys(
+      {std::make_shared<BudgetKeyName>("budget_key_a"),
+       std::make_shared<BudgetKeyName>("budget_key_b"),
+       std::make_shared<BudgetKeyName>("budget_key_a")});
+
+  ASSERT_EQ(shard_keys.size(), 3);
+  EXPECT_EQ(shard_keys[0], std::hash<std::string>()("budget_key_a"));
+  EXPECT_EQ(shard_keys[1], std::hash<std::string>()("budget_key_b"));
+  EXPECT_EQ(shard_keys[2], shard_keys[0]);
+}
+
+TEST_F(PBSPartitionTest, InterleavedBudgetKeysWithSharedNameShareTheirShard) {
+  auto budget_key_a = std::make_shared<BudgetKeyName>("budget_key_a");
+  auto shard_keys = GetBudgetKeyShardKeys(
+      {budget_key_a, std::make_shared<BudgetKeyName>("budget_key_b"),
+       budget_key_a});
+
+  ASSERT_EQ(shard_keys.size(), 3);
+  EXPECT_EQ(shard_keys[0], std::hash<std::string>()("budget_key_a"));
+  EXPECT_EQ(shard_keys[1], std::hash<std::string>()("budget_key_b"));
+  EXPECT_EQ(shard_keys[2], shard_keys[0]);
+}
+
 }  // namespace google::scp::pbs::test
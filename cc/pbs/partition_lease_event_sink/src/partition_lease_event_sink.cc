@@ -25,6 +25,7 @@
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/configuration_keys.h"
 #include "core/interface/partition_manager_interface.h"
+#include "pbs/interface/configuration_keys.h"
 
 #include "error_codes.h"
 
@@ -39,6 +40,7 @@ using google::scp::core::PartitionMetadata;
 using google::scp::core::PartitionType;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::TaskCancellationLambda;
+using google::scp::core::common::CancellableTaskScheduler;
 using google::scp::core::common::TaskLambda;
 using google::scp::core::common::TimeProvider;
 using google::scp::core::common::ToString;
@@ -159,15 +161,20 @@ PartitionLeaseEventSink::ScheduledPartitionTaskWrapper::
     ScheduledPartitionTaskWrapper(TaskLambda task_lambda,
                                   PartitionTaskType task_type,
                                   const Uuid& activity_id,
-                                  milliseconds startup_wait_delay)
-    : task_(std::move(task_lambda), startup_wait_delay),
+                                  const shared_ptr<CancellableTaskScheduler>&
+                                      task_scheduler,
+                                  milliseconds startup_wait_delay,
+                                  size_t priority)
+    : task_(std::move(task_lambda), task_scheduler, startup_wait_delay,
+            priority),
       task_type(task_type),
       sink_activity_id(activity_id),
       task_id(Uuid::GenerateUuid()) {
   SCP_INFO(kPartitionLeaseEventSink, activity_id,
            "Starting a task with ID: '%s' for task type: '%d', with a "
-           "startup delay of '%llu' (ms)",
-           ToString(task_id).c_str(), task_type, startup_wait_delay.count());
+           "startup delay of '%llu' (ms) and a priority of '%zu'",
+           ToString(task_id).c_str(), task_type, startup_wait_delay.count(),
+           priority);
 }
 
 void PartitionLeaseEventSink::ScheduledPartitionTaskWrapper::
@@ -216,6 +223,11 @@ PartitionLeaseEventSink::PartitionLeaseEventSink(
       metric_client_(metric_client),
       config_provider_(config_provider),
       object_activity_id_(Uuid::GenerateUuid()),
+      task_scheduler_(make_shared<CancellableTaskScheduler>()),
+      partition_load_task_scheduler_(task_scheduler_),
+      partition_load_statistics_(
+          std::dynamic_pointer_cast<PartitionLoadStatisticsInterface>(
+              partition_manager)),
       partition_bootup_wait_time_in_seconds_(
           partition_bootup_wait_time_in_seconds),
       abort_handler_(abort_handler),
@@ -231,6 +243,15 @@ ExecutionResult PartitionLeaseEventSink::Init() noexcept {
     metric_aggregation_interval_milliseconds_ =
         core::kDefaultAggregatedMetricIntervalMs;
   }
+
+  size_t partition_load_max_concurrency = 0;
+  if (config_provider_
+          ->Get(kPBSPartitionLoadMaxConcurrency, partition_load_max_concurrency)
+          .Successful() &&
+      partition_load_max_concurrency > 0) {
+    partition_load_task_scheduler_ =
+        make_shared<CancellableTaskScheduler>(partition_load_max_concurrency);
+  }
   return SuccessExecutionResult();
 }
 
@@ -412,6 +433,14 @@ void PartitionLeaseEventSink::OnLeaseAcquired(const LeasableLockId& lock_id) {
     partition_tasks_.erase(task_wrapper_it);
   }
 
+  // The requests routed to the remote partition are the traffic the partition
+  // will have once loaded here. Read it before the remote partition is gone.
+  size_t load_priority = 0;
+  if (partition_load_statistics_) {
+    load_priority =
+        partition_load_statistics_->GetPartitionRoutedRequestsCount(lock_id);
+  }
+
   // Unload remote partition. (if present)
   SCP_INFO(kPartitionLeaseEventSink, object_activity_id_,
            "Unloading REMOTE partition (if any) with ID: %s",
@@ -434,7 +463,8 @@ void PartitionLeaseEventSink::OnLeaseAcquired(const LeasableLockId& lock_id) {
       lock_id,
       bind(&PartitionLeaseEventSink::LoadLocalPartitionHelper, this, lock_id),
       PartitionTaskType::Load, object_activity_id_,
-      partition_bootup_wait_time_in_seconds_);
+      partition_load_task_scheduler_, partition_bootup_wait_time_in_seconds_,
+      load_priority);
   if (!is_inserted) {
     execution_result = FailureExecutionResult(
         core::errors::SC_PARTITION_LEASE_EVENT_SINK_CANNOT_EMPLACE_TO_MAP);
@@ -573,7 +603,7 @@ void PartitionLeaseEventSink::OnLeaseRenewed(
       lock_id,
       bind(&PartitionLeaseEventSink::UnloadLocalPartitionHelper, this, lock_id,
            true /* should_notify_lease_manager */),
-      PartitionTaskType::Unload, object_activity_id_);
+      PartitionTaskType::Unload, object_activity_id_, task_scheduler_);
   if (!is_inserted) {
     auto execution_result = FailureExecutionResult(
         core::errors::SC_PARTITION_LEASE_EVENT_SINK_CANNOT_EMPLACE_TO_MAP);
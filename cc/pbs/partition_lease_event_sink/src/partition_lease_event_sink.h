@@ -29,6 +29,7 @@
 #include "core/interface/partition_manager_interface.h"
 #include "core/interface/service_interface.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
+#include "pbs/interface/partition_load_statistics_interface.h"
 #include "public/cpio/interface/metric_client/metric_client_interface.h"
 
 #include "partition_metrics_wrapper.h"
@@ -45,6 +46,12 @@ namespace google::scp::pbs {
  * Before starting to boot up a partition, we must wait for a lease duration
  * worth of time (partition_lease_acquired_bootup_wait_time) to ensure the
  * previous lease owner has given up completely on the partition.
+ *
+ * When kPBSPartitionLoadMaxConcurrency is set, the partitions are loaded on
+ * their own scheduler with that many threads, so that the recoveries of many
+ * partitions acquired at once do not compete for the IO all at the same time.
+ * The partitions that had the most requests routed to them by this node, see
+ * PartitionLoadStatisticsInterface, are then loaded first.
  */
 class PartitionLeaseEventSink : public core::LeaseEventSinkInterface,
                                 public core::ServiceInterface {
@@ -164,11 +171,14 @@ class PartitionLeaseEventSink : public core::LeaseEventSinkInterface,
    * created by this component
    */
   struct ScheduledPartitionTaskWrapper {
-    ScheduledPartitionTaskWrapper(core::common::TaskLambda task_lambda,
-                                  PartitionTaskType task_type,
-                                  const core::common::Uuid& activity_id,
-                                  std::chrono::milliseconds startup_wait_delay =
-                                      std::chrono::milliseconds(0));
+    ScheduledPartitionTaskWrapper(
+        core::common::TaskLambda task_lambda, PartitionTaskType task_type,
+        const core::common::Uuid& activity_id,
+        const std::shared_ptr<core::common::CancellableTaskScheduler>&
+            task_scheduler,
+        std::chrono::milliseconds startup_wait_delay =
+            std::chrono::milliseconds(0),
+        size_t priority = 0);
 
     bool IsTaskDone() const {
       return task_.IsCancelled() || task_.IsCompleted();
@@ -213,6 +223,19 @@ class PartitionLeaseEventSink : public core::LeaseEventSinkInterface,
   /// @brief activity ID of the run
   core::common::Uuid object_activity_id_;
 
+  /// @brief executes the partition tasks, so that the tasks waiting for the
+  /// partition bootup wait time do not hold a thread each
+  std::shared_ptr<core::common::CancellableTaskScheduler> task_scheduler_;
+
+  /// @brief executes the partition load tasks, the task_scheduler_ itself
+  /// unless the load concurrency is limited.
+  std::shared_ptr<core::common::CancellableTaskScheduler>
+      partition_load_task_scheduler_;
+
+  /// @brief the traffic of the partitions, to load the busiest first. Null if
+  /// the partition manager does not provide it.
+  std::shared_ptr<PartitionLoadStatisticsInterface> partition_load_statistics_;
+
   /// @brief set of partition IDs and their current task cancellation hooks
   std::unordered_map<core::common::Uuid, ScheduledPartitionTaskWrapper,
                      core::common::UuidHash>
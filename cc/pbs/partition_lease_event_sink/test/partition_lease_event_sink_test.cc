@@ -19,6 +19,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <mutex>
+#include <vector>
+
 #include "core/async_executor/mock/mock_async_executor.h"
 #include "core/async_executor/src/async_executor.h"
 #include "core/common/concurrent_map/src/error_codes.h"
@@ -27,6 +30,7 @@
 #include "core/lease_manager/mock/mock_lease_release_notification.h"
 #include "core/test/utils/conditional_wait.h"
 #include "core/test/utils/logging_utils.h"
+#include "pbs/interface/configuration_keys.h"
 #include "pbs/partition_manager/mock/pbs_partition_manager_mock.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 #include "public/cpio/mock/metric_client/mock_metric_client.h"
@@ -54,14 +58,27 @@ using google::scp::pbs::partition_manager::mock::MockPBSPartitionManager;
 using std::atomic;
 using std::function;
 using std::make_shared;
+using std::mutex;
 using std::nullopt;
 using std::shared_ptr;
+using std::vector;
 using std::chrono::milliseconds;
 using std::chrono::seconds;
 using std::this_thread::sleep_for;
+using ::testing::_;
 using ::testing::Return;
 
 namespace google::scp::pbs::test {
+class MockPBSPartitionManagerWithLoadStatistics
+    : public MockPBSPartitionManager,
+      public PartitionLoadStatisticsInterface {
+ public:
+  MOCK_METHOD((std::vector<std::pair<PartitionId, PartitionLoad>>),
+              GetLocalPartitionsLoad, (), (noexcept, override));
+  MOCK_METHOD(size_t, GetPartitionRoutedRequestsCount,
+              (const PartitionId& partition_id), (noexcept, override));
+};
+
 class PartitionLeaseEventSinkTest : public ::testing::Test {
  protected:
   PartitionLeaseEventSinkTest() {
@@ -626,4 +643,60 @@ TEST_F(PartitionLeaseEventSinkTest,
   EXPECT_SUCCESS(sink.Stop());
 }
 
+TEST_F(PartitionLeaseEventSinkTest,
+       LimitedConcurrencyLoadsTheBusiestPartitionsFirst) {
+  auto mock_partition_manager =
+      make_shared<MockPBSPartitionManagerWithLoadStatistics>();
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->SetInt(kPBSPartitionLoadMaxConcurrency, 1);
+  PartitionLeaseEventSink sink(
+      mock_partition_manager, async_executor_, lease_release_notification_,
+      metric_client_, mock_config_provider,
+      seconds(0) /* execute immediately */, abort_handler_);
+  EXPECT_SUCCESS(sink.Init());
+  EXPECT_SUCCESS(sink.Run());
+
+  // The partition i had i requests routed to it.
+  vector<PartitionId> partition_ids = {{1, 1}, {3, 3}, {2, 2}, {4, 4}};
+  EXPECT_CALL(*mock_partition_manager, GetPartitionRoutedRequestsCount)
+      .WillRepeatedly(
+          [](const PartitionId& partition_id) { return partition_id.low; });
+  EXPECT_CALL(*mock_partition_manager, UnloadPartition)
+      .WillRepeatedly(Return(SuccessExecutionResult()));
+
+  // The first load keeps the only thread busy until all of the partitions are
+  // acquired.
+  atomic<bool> should_wait(true);
+  mutex loaded_partition_ids_mutex;
+  vector<PartitionId> loaded_partition_ids;
+  EXPECT_CALL(*mock_partition_manager, LoadPartition)
+      .WillRepeatedly([&](const PartitionMetadata& partition_metadata) {
+        while (should_wait) {
+          sleep_for(milliseconds(10));
+        }
+        std::unique_lock lock(loaded_partition_ids_mutex);
+        loaded_partition_ids.push_back(partition_metadata.partition_id);
+        return SuccessExecutionResult();
+      });
+
+  sink.OnLeaseTransition(partition_ids[0], LeaseTransitionType::kAcquired,
+                         nullopt /* nullopt because this is the owner */);
+  sleep_for(milliseconds(100));
+  for (size_t i = 1; i < partition_ids.size(); ++i) {
+    sink.OnLeaseTransition(partition_ids[i], LeaseTransitionType::kAcquired,
+                           nullopt /* nullopt because this is the owner */);
+  }
+  sleep_for(milliseconds(100));
+  should_wait = false;
+
+  WaitUntil([&]() {
+    std::unique_lock lock(loaded_partition_ids_mutex);
+    return loaded_partition_ids.size() == partition_ids.size();
+  });
+  EXPECT_EQ(loaded_partition_ids,
+            vector<PartitionId>({{1, 1}, {4, 4}, {3, 3}, {2, 2}}));
+  EXPECT_EQ(abort_called_, 0);
+
+  EXPECT_SUCCESS(sink.Stop());
+}
 }  // namespace google::scp::pbs::test
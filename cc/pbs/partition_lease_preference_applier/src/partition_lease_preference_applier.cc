@@ -16,9 +16,14 @@
 
 #include "partition_lease_preference_applier.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <optional>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "core/common/global_logger/src/global_logger.h"
 
@@ -26,11 +31,23 @@
 
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
+using google::scp::core::LeasableLockId;
 using google::scp::core::LeaseAcquisitionPreference;
+using google::scp::core::PartitionId;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::Uuid;
+using google::scp::core::common::UuidHash;
+using std::lock_guard;
 using std::make_unique;
+using std::max;
+using std::min;
+using std::mutex;
+using std::nullopt;
+using std::optional;
+using std::pair;
 using std::thread;
+using std::unordered_map;
+using std::vector;
 using std::chrono::milliseconds;
 using std::chrono::seconds;
 using std::this_thread::sleep_for;
@@ -44,6 +61,26 @@ static constexpr milliseconds kDefaultApplierIntervalInMilliseconds =
 static constexpr seconds kDefaultStartupWaitIntervalInMilliseconds =
     seconds(10);
 
+// Below these, the load of the partitions is too low to be worth rebalancing.
+static constexpr double kMinimumMedianRequestsSeenPerRound = 100;
+static constexpr double kMinimumMedianCachedBudgetKeys = 1000;
+
+// Rounds for which partitions have to stay unleased before a node holding its
+// share adopts one, so that the nodes below their share get them first.
+static constexpr size_t kUnleasedPartitionsRoundsBeforeAdoption = 3;
+
+namespace {
+double GetMedian(vector<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  // The lower median, so that a heavy partition stands out of two.
+  auto middle = values.begin() + (values.size() - 1) / 2;
+  std::nth_element(values.begin(), middle, values.end());
+  return *middle;
+}
+}  // namespace
+
 namespace google::scp::pbs {
 
 PartitionLeasePreferenceApplier::PartitionLeasePreferenceApplier(
@@ -56,7 +93,26 @@ PartitionLeasePreferenceApplier::PartitionLeasePreferenceApplier(
       partition_lease_acquisition_preference_(
           partition_lease_acquisition_preference),
       is_running_(false),
-      object_activity_id_(Uuid::GenerateUuid()) {}
+      object_activity_id_(Uuid::GenerateUuid()),
+      median_requests_seen_(kMinimumMedianRequestsSeenPerRound),
+      median_cached_budget_keys_(kMinimumMedianCachedBudgetKeys),
+      previous_virtual_node_count_(0),
+      adopted_partitions_count_(0),
+      is_adopting_partition_(false),
+      unleased_partitions_rounds_count_(0) {}
+
+PartitionLeasePreferenceApplier::PartitionLeasePreferenceApplier(
+    size_t partition_count,
+    std::shared_ptr<core::LeaseStatisticsInterface> virtual_node_lease_stats,
+    std::shared_ptr<core::LeaseAcquisitionPreferenceInterface>
+        partition_lease_acquisition_preference,
+    std::shared_ptr<core::LeaseStatisticsInterface> partition_lease_stats,
+    std::shared_ptr<PartitionLoadStatisticsInterface> partition_load_stats)
+    : PartitionLeasePreferenceApplier(partition_count, virtual_node_lease_stats,
+                                      partition_lease_acquisition_preference) {
+  partition_lease_stats_ = partition_lease_stats;
+  partition_load_stats_ = partition_load_stats;
+}
 
 void PartitionLeasePreferenceApplier::ThreadFunction() {
   sleep_for(kDefaultStartupWaitIntervalInMilliseconds);
@@ -126,14 +182,142 @@ PartitionLeasePreferenceApplier::ApplyLeasePreference() noexcept {
   size_t num_partitions_to_hold = static_cast<size_t>(
       std::ceil(partition_count_ / static_cast<double>(num_vnode_leases_held)));
 
+  vector<LeasableLockId> preferred_partitions;
+  if (partition_load_stats_) {
+    ApplyPartitionLoad(num_vnode_leases_held, num_partitions_to_hold,
+                       preferred_partitions);
+  }
+
   SCP_INFO(kPartitionLeasePreferenceApplier, object_activity_id_,
            "Partition Count: '%llu', Number of VNode Leases Held: '%llu', "
            "Number of Partitions to hold: '%llu'",
            partition_count_, num_vnode_leases_held, num_partitions_to_hold);
 
   return partition_lease_acquisition_preference_->SetLeaseAcquisitionPreference(
-      LeaseAcquisitionPreference{num_partitions_to_hold,
-                                 {} /* no specific locks to hold */});
+      LeaseAcquisitionPreference{num_partitions_to_hold, preferred_partitions});
+}
+
+vector<pair<PartitionId, double>>
+PartitionLeasePreferenceApplier::GetLocalPartitionWeights() noexcept {
+  auto partitions_load = partition_load_stats_->GetLocalPartitionsLoad();
+
+  // The requests seen since the previous round are not known for the
+  // partitions loaded since then.
+  vector<optional<double>> requests_seen;
+  vector<double> known_requests_seen;
+  vector<double> cached_budget_keys;
+  unordered_map<PartitionId, size_t, UuidHash> requests_seen_counts;
+  for (const auto& [partition_id, partition_load] : partitions_load) {
+    requests_seen_counts.emplace(partition_id,
+                                 partition_load.requests_seen_count);
+    auto previous = previous_requests_seen_counts_.find(partition_id);
+    if (previous != previous_requests_seen_counts_.end() &&
+        partition_load.requests_seen_count >= previous->second) {
+      requests_seen.push_back(static_cast<double>(
+          partition_load.requests_seen_count - previous->second));
+      known_requests_seen.push_back(*requests_seen.back());
+    } else {
+      requests_seen.push_back(nullopt);
+    }
+    cached_budget_keys.push_back(
+        static_cast<double>(partition_load.cached_budget_keys_count));
+  }
+  previous_requests_seen_counts_ = std::move(requests_seen_counts);
+
+  // The medians of a single partition would be its own load, the ones of the
+  // previous rounds are kept so that a heavy partition left alone on this node
+  // still stands out.
+  if (known_requests_seen.size() > 1) {
+    median_requests_seen_ = max(GetMedian(std::move(known_requests_seen)),
+                                kMinimumMedianRequestsSeenPerRound);
+  }
+  if (cached_budget_keys.size() > 1) {
+    median_cached_budget_keys_ =
+        max(GetMedian(cached_budget_keys), kMinimumMedianCachedBudgetKeys);
+  }
+
+  vector<pair<PartitionId, double>> partition_weights;
+  for (size_t i = 0; i < partitions_load.size(); i++) {
+    double weight = cached_budget_keys[i] / median_cached_budget_keys_;
+    if (requests_seen[i].has_value()) {
+      weight = max(weight, *requests_seen[i] / median_requests_seen_);
+    }
+    partition_weights.emplace_back(partitions_load[i].first, weight);
+  }
+  return partition_weights;
+}
+
+void PartitionLeasePreferenceApplier::ApplyPartitionLoad(
+    size_t virtual_node_count, size_t& num_partitions_to_hold,
+    vector<LeasableLockId>& preferred_partitions) noexcept {
+  lock_guard<mutex> lock(work_mutex_);
+  if (virtual_node_count != previous_virtual_node_count_) {
+    // The share of the nodes changed, the adopted partitions are rebalanced
+    // as any other.
+    previous_virtual_node_count_ = virtual_node_count;
+    adopted_partitions_count_ = 0;
+    is_adopting_partition_ = false;
+  }
+
+  auto partition_weights = GetLocalPartitionWeights();
+  size_t held_count = partition_weights.size();
+  size_t even_share = num_partitions_to_hold;
+
+  size_t unleased_count = 0;
+  if (partition_lease_stats_) {
+    auto leased_count = partition_lease_stats_->GetCurrentlyLeasedLocksCount();
+    unleased_count =
+        partition_count_ > leased_count ? partition_count_ - leased_count : 0;
+  }
+  unleased_partitions_rounds_count_ =
+      unleased_count > 0 ? unleased_partitions_rounds_count_ + 1 : 0;
+
+  // A partition heavier than the median takes up the share of the partitions
+  // it outweighs.
+  double excess_weight = 0;
+  for (const auto& [_, weight] : partition_weights) {
+    excess_weight += max(0.0, weight - 1);
+  }
+  auto slots_to_give_up =
+      min(even_share - 1, static_cast<size_t>(std::floor(excess_weight)));
+
+  if (slots_to_give_up > 0) {
+    num_partitions_to_hold = even_share - slots_to_give_up;
+    adopted_partitions_count_ = 0;
+    is_adopting_partition_ = false;
+  } else {
+    size_t held_above_share =
+        held_count > even_share ? held_count - even_share : 0;
+    if (is_adopting_partition_) {
+      adopted_partitions_count_ =
+          max(adopted_partitions_count_, held_above_share);
+    }
+    // The adopted partitions that were lost are not held on to.
+    adopted_partitions_count_ =
+        min(adopted_partitions_count_, held_above_share);
+    num_partitions_to_hold = even_share + adopted_partitions_count_;
+    is_adopting_partition_ = unleased_partitions_rounds_count_ >=
+                             kUnleasedPartitionsRoundsBeforeAdoption;
+    if (is_adopting_partition_) {
+      num_partitions_to_hold++;
+    }
+  }
+
+  // Keep the heaviest partitions and release the lighter ones, which are
+  // cheaper to move.
+  std::sort(partition_weights.begin(), partition_weights.end(),
+            [](const auto& left, const auto& right) {
+              return left.second > right.second;
+            });
+  for (size_t i = 0; i < min(num_partitions_to_hold, held_count); i++) {
+    preferred_partitions.push_back(partition_weights[i].first);
+  }
+
+  SCP_INFO(kPartitionLeasePreferenceApplier, object_activity_id_,
+           "Partitions Held: '%llu', Excess Weight: '%.2f', Adopted "
+           "Partitions: '%llu', Unleased Partitions: '%llu'",
+           held_count, excess_weight, adopted_partitions_count_,
+           unleased_count);
 }
 
 }  // namespace google::scp::pbs
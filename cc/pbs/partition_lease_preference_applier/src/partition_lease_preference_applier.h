@@ -19,13 +19,23 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "core/common/uuid/src/uuid.h"
 #include "core/interface/lease_manager_interface.h"
+#include "pbs/interface/partition_load_statistics_interface.h"
 
 namespace google::scp::pbs {
 /**
  * @brief Lease Preference Applier to host equal number of partitions on all of
  * the virtual nodes.
+ *
+ * If the load of the partitions is provided, a partition heavier than the
+ * others takes up the share of the partitions it outweighs so that the nodes
+ * balance by load instead of count. The partitions given up this way are
+ * adopted by the other nodes once they stay unleased for a few rounds.
  */
 class PartitionLeasePreferenceApplier : public core::ServiceInterface {
  public:
@@ -36,6 +46,24 @@ class PartitionLeasePreferenceApplier : public core::ServiceInterface {
       std::shared_ptr<core::LeaseAcquisitionPreferenceInterface>
           partition_lease_acquisition_preference);
 
+  /**
+   * @brief Construct a load aware applier.
+   *
+   * @param partition_lease_statistics lease statistics of the partitions, to
+   * know how many of them are not leased by any of the nodes.
+   * @param partition_load_statistics load of the partitions on this node.
+   */
+  PartitionLeasePreferenceApplier(
+      size_t partition_count,
+      std::shared_ptr<core::LeaseStatisticsInterface>
+          virtual_node_lease_statistics,
+      std::shared_ptr<core::LeaseAcquisitionPreferenceInterface>
+          partition_lease_acquisition_preference,
+      std::shared_ptr<core::LeaseStatisticsInterface>
+          partition_lease_statistics,
+      std::shared_ptr<PartitionLoadStatisticsInterface>
+          partition_load_statistics);
+
   /**
    * @brief Apply partition lease preference with help of information from the
    * virtual node lease statistics.
@@ -53,6 +81,31 @@ class PartitionLeasePreferenceApplier : public core::ServiceInterface {
   void ThreadFunction();
 
  protected:
+  /**
+   * @brief Adjusts the number of partitions to hold by the load of the
+   * partitions on this node, and prefers holding the heaviest of them.
+   *
+   * @param virtual_node_count the number of virtual nodes in the system.
+   * @param num_partitions_to_hold the even share of the partitions, adjusted
+   * in place.
+   * @param preferred_partitions the partitions to keep if some have to be
+   * released.
+   */
+  void ApplyPartitionLoad(
+      size_t virtual_node_count, size_t& num_partitions_to_hold,
+      std::vector<core::LeasableLockId>& preferred_partitions) noexcept;
+
+  /**
+   * @brief Get the weight of each of the partitions on this node, which is its
+   * load relative to the median load of these partitions. The load is the
+   * requests seen since the previous round or the cached budget keys,
+   * whichever is relatively higher.
+   *
+   * @return std::vector<std::pair<core::PartitionId, double>>
+   */
+  std::vector<std::pair<core::PartitionId, double>>
+  GetLocalPartitionWeights() noexcept;
+
   /// @brief Count of partitions in the system
   const size_t partition_count_;
   /// @brief Virtual node lease statistics
@@ -68,6 +121,28 @@ class PartitionLeasePreferenceApplier : public core::ServiceInterface {
   std::mutex work_mutex_;
   /// @brief activity ID of the run
   core::common::Uuid object_activity_id_;
+  /// @brief Partition lease statistics, optional.
+  std::shared_ptr<core::LeaseStatisticsInterface> partition_lease_stats_;
+  /// @brief Load of the partitions on this node. If not set, the partitions
+  /// are balanced by count only.
+  std::shared_ptr<PartitionLoadStatisticsInterface> partition_load_stats_;
+  /// @brief Requests seen count of the local partitions at the previous round.
+  std::unordered_map<core::PartitionId, size_t, core::common::UuidHash>
+      previous_requests_seen_counts_;
+  /// @brief Median requests seen per round by the local partitions.
+  double median_requests_seen_;
+  /// @brief Median cached budget keys of the local partitions.
+  double median_cached_budget_keys_;
+  /// @brief Virtual node count at the previous round.
+  size_t previous_virtual_node_count_;
+  /// @brief Partitions held above the even share because other nodes gave
+  /// them up.
+  size_t adopted_partitions_count_;
+  /// @brief Whether an unleased partition was being adopted in the previous
+  /// round.
+  bool is_adopting_partition_;
+  /// @brief Consecutive rounds in which some partitions were not leased.
+  size_t unleased_partitions_rounds_count_;
 };
 
 }  // namespace google::scp::pbs
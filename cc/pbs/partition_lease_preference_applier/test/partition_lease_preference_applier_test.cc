@@ -19,20 +19,87 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "core/lease_manager/mock/mock_lease_acquistion_preference.h"
 #include "core/lease_manager/mock/mock_lease_statistics.h"
 #include "core/test/utils/conditional_wait.h"
 #include "core/test/utils/logging_utils.h"
+#include "pbs/interface/partition_load_statistics_interface.h"
 #include "public/core/test/interface/execution_result_matchers.h"
 
+using google::scp::core::LeasableLockId;
 using google::scp::core::LeaseAcquisitionPreference;
+using google::scp::core::PartitionId;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::lease_manager::mock::MockLeaseAcquisitionPreference;
 using google::scp::core::lease_manager::mock::MockLeaseStatistics;
 using std::make_shared;
+using std::pair;
+using std::vector;
+using testing::_;
+using testing::DoAll;
 using testing::Return;
+using testing::SaveArg;
+using testing::UnorderedElementsAre;
 
 namespace google::scp::pbs::test {
+class MockPartitionLoadStatistics : public PartitionLoadStatisticsInterface {
+ public:
+  MOCK_METHOD((vector<pair<PartitionId, PartitionLoad>>),
+              GetLocalPartitionsLoad, (), (noexcept, override));
+  MOCK_METHOD(size_t, GetPartitionRoutedRequestsCount,
+              (const PartitionId& partition_id), (noexcept, override));
+};
+
+class LoadAwarePartitionLeasePreferenceApplierTest : public ::testing::Test {
+ protected:
+  LoadAwarePartitionLeasePreferenceApplierTest()
+      : vnode_lease_stats_(make_shared<MockLeaseStatistics>()),
+        partition_lease_stats_(make_shared<MockLeaseStatistics>()),
+        lease_acquisition_preference_(
+            make_shared<MockLeaseAcquisitionPreference>()),
+        partition_load_stats_(make_shared<MockPartitionLoadStatistics>()),
+        applier_(kPartitionCount, vnode_lease_stats_,
+                 lease_acquisition_preference_, partition_lease_stats_,
+                 partition_load_stats_) {
+    ON_CALL(*vnode_lease_stats_, GetCurrentlyLeasedLocksCount)
+        .WillByDefault(Return(3));
+    ON_CALL(*partition_lease_stats_, GetCurrentlyLeasedLocksCount)
+        .WillByDefault(Return(kPartitionCount));
+    ON_CALL(*lease_acquisition_preference_, SetLeaseAcquisitionPreference)
+        .WillByDefault(DoAll(SaveArg<0>(&preference_),
+                             Return(SuccessExecutionResult())));
+  }
+
+  /// Applies the preference with the given requests seen and cached budget
+  /// keys of the local partitions.
+  LeaseAcquisitionPreference Apply(
+      const vector<pair<size_t, size_t>>& partitions_load) {
+    vector<pair<PartitionId, PartitionLoad>> loads;
+    for (size_t i = 0; i < partitions_load.size(); i++) {
+      loads.emplace_back(partition_ids_[i],
+                         PartitionLoad{partitions_load[i].first,
+                                       partitions_load[i].second});
+    }
+    EXPECT_CALL(*partition_load_stats_, GetLocalPartitionsLoad)
+        .WillOnce(Return(loads));
+    EXPECT_SUCCESS(applier_.ApplyLeasePreference());
+    return preference_;
+  }
+
+  static constexpr size_t kPartitionCount = 9;
+  vector<PartitionId> partition_ids_ = {{1, 1}, {2, 2}, {3, 3}, {4, 4}};
+  std::shared_ptr<MockLeaseStatistics> vnode_lease_stats_;
+  std::shared_ptr<MockLeaseStatistics> partition_lease_stats_;
+  std::shared_ptr<MockLeaseAcquisitionPreference>
+      lease_acquisition_preference_;
+  std::shared_ptr<MockPartitionLoadStatistics> partition_load_stats_;
+  PartitionLeasePreferenceApplier applier_;
+  LeaseAcquisitionPreference preference_;
+};
 TEST(PartitionLeasePreferenceApplierTest, NinePartitionsTwoVirtualNodes) {
   auto lease_stats = make_shared<MockLeaseStatistics>();
   auto lease_acquisition_preference =
@@ -86,4 +153,69 @@ TEST(PartitionLeasePreferenceApplierTest, NinePartitionsThreeVirtualNodes) {
       partition_count, lease_stats, lease_acquisition_preference);
   equal_partition_hosting_manager.ApplyLeasePreference();
 }
+
+TEST_F(LoadAwarePartitionLeasePreferenceApplierTest,
+       EvenlyLoadedPartitionsAreBalancedByCount) {
+  auto preference = Apply({{0, 2000}, {0, 2000}, {0, 2000}});
+  EXPECT_EQ(preference.maximum_number_of_leases_to_hold, 3);
+  EXPECT_THAT(preference.preferred_locks_to_acquire_leases_on,
+              UnorderedElementsAre(partition_ids_[0], partition_ids_[1],
+                                   partition_ids_[2]));
+}
+
+TEST_F(LoadAwarePartitionLeasePreferenceApplierTest,
+       PartitionWithManyCachedKeysTakesUpTheShareOfOthers) {
+  auto preference = Apply({{0, 100}, {0, 5000}, {0, 100}});
+  EXPECT_EQ(preference.maximum_number_of_leases_to_hold, 1);
+  EXPECT_EQ(preference.preferred_locks_to_acquire_leases_on,
+            vector<LeasableLockId>{partition_ids_[1]});
+
+  // The heavy partition still stands out once left alone.
+  preference = Apply({{0, 5000}});
+  EXPECT_EQ(preference.maximum_number_of_leases_to_hold, 1);
+}
+
+TEST_F(LoadAwarePartitionLeasePreferenceApplierTest,
+       PartitionWithHighRequestRateTakesUpTheShareOfOthers) {
+  // The request rate is not known in the first round.
+  auto preference = Apply({{1000, 0}, {1000, 0}, {1000, 0}});
+  EXPECT_EQ(preference.maximum_number_of_leases_to_hold, 3);
+
+  preference = Apply({{1100, 0}, {1120, 0}, {1250, 0}});
+  EXPECT_EQ(preference.maximum_number_of_leases_to_hold, 2);
+  EXPECT_EQ(preference.preferred_locks_to_acquire_leases_on,
+            (vector<LeasableLockId>{partition_ids_[2], partition_ids_[1]}));
+}
+
+TEST_F(LoadAwarePartitionLeasePreferenceApplierTest,
+       PartitionsLeftUnleasedAreAdopted) {
+  EXPECT_CALL(*partition_lease_stats_, GetCurrentlyLeasedLocksCount)
+      .WillOnce(Return(kPartitionCount - 1))
+      .WillOnce(Return(kPartitionCount - 1))
+      .WillOnce(Return(kPartitionCount - 1))
+      .WillRepeatedly(Return(kPartitionCount));
+
+  // The nodes below their share get the unleased partitions first.
+  EXPECT_EQ(Apply({{0, 0}, {0, 0}, {0, 0}}).maximum_number_of_leases_to_hold,
+            3);
+  EXPECT_EQ(Apply({{0, 0}, {0, 0}, {0, 0}}).maximum_number_of_leases_to_hold,
+            3);
+  EXPECT_EQ(Apply({{0, 0}, {0, 0}, {0, 0}}).maximum_number_of_leases_to_hold,
+            4);
+
+  // The adopted partition is held on to.
+  EXPECT_EQ(Apply({{0, 0}, {0, 0}, {0, 0}, {0, 0}})
+                .maximum_number_of_leases_to_hold,
+            4);
+  EXPECT_EQ(Apply({{0, 0}, {0, 0}, {0, 0}, {0, 0}})
+                .maximum_number_of_leases_to_hold,
+            4);
+
+  // Until the nodes change.
+  EXPECT_CALL(*vnode_lease_stats_, GetCurrentlyLeasedLocksCount)
+      .WillRepeatedly(Return(4));
+  EXPECT_EQ(Apply({{0, 0}, {0, 0}, {0, 0}, {0, 0}})
+                .maximum_number_of_leases_to_hold,
+            3);
+}
 }  // namespace google::scp::pbs::test
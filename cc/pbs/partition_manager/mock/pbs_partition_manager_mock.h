@@ -55,5 +55,7 @@ class MockPBSPartitionManager : public PBSPartitionManagerInterface {
   MOCK_METHOD((core::ExecutionResultOr<std::shared_ptr<PBSPartitionInterface>>),
               GetPBSPartition, (const core::PartitionId& partition_id),
               (noexcept, override));
+
+  MOCK_METHOD(uint64_t, GetPartitionsVersion, (), (noexcept, override));
 };
 }  // namespace google::scp::pbs::partition_manager::mock
@@ -23,9 +23,11 @@ class PBSPartitionManagerWithOverrides : public PBSPartitionManager {
  public:
   PBSPartitionManagerWithOverrides(
       PBSPartition::Dependencies partition_dependencies,
-      size_t partition_transaction_manager_capacity)
+      size_t partition_transaction_manager_capacity,
+      std::vector<core::PartitionId> standby_partition_ring = {})
       : PBSPartitionManager(partition_dependencies,
-                            partition_transaction_manager_capacity) {}
+                            partition_transaction_manager_capacity,
+                            std::move(standby_partition_ring)) {}
 
   std::shared_ptr<PBSPartitionInterface> ConstructPBSPartition(
       const core::PartitionId& partition_id,
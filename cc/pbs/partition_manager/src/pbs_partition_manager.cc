@@ -16,6 +16,7 @@
 
 #include "pbs/partition_manager/src/pbs_partition_manager.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -38,24 +39,38 @@ using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::ToString;
 using google::scp::pbs::RemotePBSPartition;
+using std::find;
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
+using std::make_unique;
 using std::move;
+using std::mutex;
+using std::pair;
 using std::shared_ptr;
 using std::string;
+using std::thread;
+using std::unique_lock;
 using std::vector;
+using std::chrono::milliseconds;
 
 static constexpr char kPBSPartitionManager[] = "PBSPartitionManager";
+static constexpr milliseconds kStandbyPartitionsRefreshInterval =
+    milliseconds(5000);
 
 namespace google::scp::pbs {
 
 PBSPartitionManager::PBSPartitionManager(
     PBSPartition::Dependencies partition_dependencies,
-    size_t partition_transaction_manager_capacity)
+    size_t partition_transaction_manager_capacity,
+    vector<PartitionId> standby_partition_ring)
     : partition_dependencies_(move(partition_dependencies)),
       partition_transaction_manager_capacity_(
           partition_transaction_manager_capacity),
-      is_running_(false) {}
+      is_running_(false),
+      partitions_version_(0),
+      standby_partition_ring_(move(standby_partition_ring)),
+      standby_refresh_interval_(kStandbyPartitionsRefreshInterval) {}
 
 ExecutionResult PBSPartitionManager::Init() noexcept {
   if (is_running_) {
@@ -85,6 +100,25 @@ ExecutionResult PBSPartitionManager::Run() noexcept {
         core::errors::SC_PBS_PARTITION_MANAGER_ALREADY_RUNNING);
   }
   is_running_ = true;
+  partitions_version_++;
+
+  if (standby_partition_ring_.size() > 1) {
+    SCP_INFO(kPBSPartitionManager, kZeroUuid,
+             "Keeping warm standbys of the partitions in a ring of %llu",
+             standby_partition_ring_.size());
+    // The partitions are loaded only once leased, so the first refresh waits
+    // for an interval as well.
+    standby_refresher_thread_ = make_unique<thread>([this]() {
+      unique_lock<mutex> lock(standby_refresher_mutex_);
+      while (!standby_refresher_condvar_.wait_for(
+          lock, standby_refresh_interval_,
+          [this]() { return !is_running_.load(); })) {
+        lock.unlock();
+        RefreshStandbyPartitions();
+        lock.lock();
+      }
+    });
+  }
   return SuccessExecutionResult();
 }
 
@@ -95,6 +129,25 @@ ExecutionResult PBSPartitionManager::Stop() noexcept {
   }
 
   is_running_ = false;
+  partitions_version_++;
+
+  if (standby_refresher_thread_) {
+    {
+      lock_guard<mutex> lock(standby_refresher_mutex_);
+      standby_refresher_condvar_.notify_all();
+    }
+    if (standby_refresher_thread_->joinable()) {
+      standby_refresher_thread_->join();
+    }
+    standby_refresher_thread_ = nullptr;
+  }
+
+  // The standbys are not loaded, discarding them is enough.
+  vector<PartitionId> standby_partition_ids;
+  RETURN_IF_FAILURE(standby_partitions_map_.Keys(standby_partition_ids));
+  for (const auto& standby_partition_id : standby_partition_ids) {
+    standby_partitions_map_.Erase(standby_partition_id);
+  }
 
   // Unload all of partitions
   vector<core::common::Uuid> loaded_partition_ids;
@@ -126,6 +179,7 @@ ExecutionResult PBSPartitionManager::Stop() noexcept {
       if (loaded_partition_entry->partition_handle->GetPartitionState() ==
           core::PartitionLoadUnloadState::Unloaded) {
         loaded_partitions_map_.Erase(loaded_partition_id);
+        partitions_version_++;
       }
     }
     // Refresh the partitions list
@@ -153,34 +207,55 @@ ExecutionResult PBSPartitionManager::LoadPartition(
         core::errors::SC_PBS_PARTITION_MANAGER_NOT_RUNNING);
   }
 
-  shared_ptr<PBSPartitionInterface> partition = ConstructPBSPartition(
-      partition_metadata.partition_id, partition_metadata.partition_type);
+  // A warm standby of the partition is already initialized and recovered, it
+  // only has to catch up on the latest journals while loading.
+  shared_ptr<PBSPartitionInterface> partition;
+  bool is_standby =
+      partition_metadata.partition_type == PartitionType::Local &&
+      standby_partitions_map_.Find(partition_metadata.partition_id, partition)
+          .Successful() &&
+      standby_partitions_map_.Erase(partition_metadata.partition_id)
+          .Successful();
+  if (is_standby) {
+    SCP_INFO(kPBSPartitionManager, partition_metadata.partition_id,
+             "Loading the partition from its warm standby");
+  } else {
+    partition = ConstructPBSPartition(partition_metadata.partition_id,
+                                      partition_metadata.partition_type);
+  }
   auto partition_map_entry =
       make_shared<PBSPartitionManagerMapEntry>(partition_metadata, partition);
   auto partition_map_pair =
       make_pair(partition_metadata.Id(), partition_map_entry);
   RETURN_IF_FAILURE(
       loaded_partitions_map_.Insert(partition_map_pair, partition_map_entry));
+  partitions_version_++;
 
   // If the partition manager is unloading while this thread is inserting, we
   // must ensure that the partition is discarded since the unloading thread
   // might miss erasing this due to the race.
   if (!is_running_) {
     loaded_partitions_map_.Erase(partition_metadata.partition_id);
+    partitions_version_++;
     return SuccessExecutionResult();
   }
 
-  auto execution_result = partition->Init();
-  if (!execution_result.Successful()) {
-    loaded_partitions_map_.Erase(partition_metadata.partition_id);
-    SCP_ERROR(kPBSPartitionManager, partition_metadata.partition_id,
-              execution_result, "Cannot Load partition");
-    return FailureExecutionResult(core::errors::SC_PBS_PARTITION_LOAD_FAILURE);
+  if (!is_standby) {
+    auto execution_result = partition->Init();
+    if (!execution_result.Successful()) {
+      loaded_partitions_map_.Erase(partition_metadata.partition_id);
+      partitions_version_++;
+      SCP_ERROR(kPBSPartitionManager, partition_metadata.partition_id,
+                execution_result, "Cannot Load partition");
+      return FailureExecutionResult(
+          core::errors::SC_PBS_PARTITION_LOAD_FAILURE);
+    }
   }
 
-  execution_result = partition->Load();
+  auto execution_result = partition->Load();
   if (!execution_result.Successful()) {
     loaded_partitions_map_.Erase(partition_metadata.partition_id);
+    partitions_version_++;
     SCP_ERROR(kPBSPartitionManager, partition_metadata.partition_id,
               execution_result, "Cannot Load partition");
     return FailureExecutionResult(core::errors::SC_PBS_PARTITION_LOAD_FAILURE);
@@ -207,6 +282,7 @@ ExecutionResult PBSPartitionManager::RefreshPartitionAddress(
 
   partition_map_entry->SetPartitionAddress(
       partition_metadata.partition_address_uri);
+  partitions_version_++;
 
   return SuccessExecutionResult();
 }
@@ -223,6 +299,9 @@ PBSPartitionManager::GetPartitionAddress(
   RETURN_IF_FAILURE(
       loaded_partitions_map_.Find(partition_id, partition_map_entry));
 
+  // The address is looked up to route each request of the partition.
+  partition_map_entry->routed_requests_count.fetch_add(
+      1, std::memory_order_relaxed);
   return partition_map_entry->GetPartitionAddress();
 }
 
@@ -264,6 +343,7 @@ ExecutionResult PBSPartitionManager::UnloadPartition(
   // potential load on the same partition to happen concurrently while the
   // unloading is happening.
   RETURN_IF_FAILURE(loaded_partitions_map_.Erase(partition_id));
+  partitions_version_++;
 
   return SuccessExecutionResult();
 }
@@ -296,4 +376,132 @@ PBSPartitionManager::GetPBSPartition(const PartitionId& partition_id) noexcept {
   return partition_map_entry->partition_handle;
 }
 
+uint64_t PBSPartitionManager::GetPartitionsVersion() noexcept {
+  return partitions_version_.load();
+}
+
+vector<pair<PartitionId, PartitionLoad>>
+PBSPartitionManager::GetLocalPartitionsLoad() noexcept {
+  vector<pair<PartitionId, PartitionLoad>> partitions_load;
+  if (!is_running_) {
+    return partitions_load;
+  }
+
+  vector<PartitionId> partition_ids;
+  if (!loaded_partitions_map_.Keys(partition_ids).Successful()) {
+    return partitions_load;
+  }
+  for (const auto& partition_id : partition_ids) {
+    shared_ptr<PBSPartitionManagerMapEntry> partition_map_entry;
+    if (!loaded_partitions_map_.Find(partition_id, partition_map_entry)
+             .Successful() ||
+        partition_map_entry->partition_type != PartitionType::Local) {
+      continue;
+    }
+    auto& partition = partition_map_entry->partition_handle;
+    partitions_load.emplace_back(partition_id, partition->GetPartitionLoad());
+  }
+  return partitions_load;
+}
+
+size_t PBSPartitionManager::GetPartitionRoutedRequestsCount(
+    const PartitionId& partition_id) noexcept {
+  shared_ptr<PBSPartitionManagerMapEntry> partition_map_entry;
+  if (!is_running_ ||
+      !loaded_partitions_map_.Find(partition_id, partition_map_entry)
+           .Successful()) {
+    return 0;
+  }
+  return partition_map_entry->routed_requests_count.load(
+      std::memory_order_relaxed);
+}
+
+vector<PartitionId>
+PBSPartitionManager::GetDesignatedStandbyPartitionIds() noexcept {
+  vector<PartitionId> designated_partition_ids;
+  auto is_local = [this](const PartitionId& partition_id) {
+    shared_ptr<PBSPartitionManagerMapEntry> partition_map_entry;
+    return loaded_partitions_map_.Find(partition_id, partition_map_entry)
+               .Successful() &&
+           partition_map_entry->partition_type == PartitionType::Local;
+  };
+
+  auto ring_size = standby_partition_ring_.size();
+  if (ring_size < 2) {
+    return designated_partition_ids;
+  }
+  for (size_t i = 0; i < ring_size; ++i) {
+    const auto& partition_id = standby_partition_ring_[i];
+    if (!is_local(partition_id) &&
+        is_local(standby_partition_ring_[(i + 1) % ring_size])) {
+      designated_partition_ids.push_back(partition_id);
+    }
+  }
+  return designated_partition_ids;
+}
+
+void PBSPartitionManager::RefreshStandbyPartitions() noexcept {
+  if (!is_running_) {
+    return;
+  }
+
+  auto designated_partition_ids = GetDesignatedStandbyPartitionIds();
+
+  vector<PartitionId> standby_partition_ids;
+  if (standby_partitions_map_.Keys(standby_partition_ids).Successful()) {
+    for (const auto& standby_partition_id : standby_partition_ids) {
+      if (find(designated_partition_ids.begin(), designated_partition_ids.end(),
+               standby_partition_id) == designated_partition_ids.end()) {
+        SCP_INFO(kPBSPartitionManager, standby_partition_id,
+                 "Discarding the standby of the partition");
+        standby_partitions_map_.Erase(standby_partition_id);
+      }
+    }
+  }
+
+  for (const auto& partition_id : designated_partition_ids) {
+    if (!is_running_) {
+      return;
+    }
+
+    shared_ptr<PBSPartitionInterface> standby_partition;
+    if (!standby_partitions_map_.Find(partition_id, standby_partition)
+             .Successful()) {
+      standby_partition = ConstructPBSPartition(partition_id,
+                                                PartitionType::Local);
+      auto execution_result = standby_partition->Init();
+      if (!execution_result.Successful()) {
+        SCP_ERROR(kPBSPartitionManager, partition_id, execution_result,
+                  "Cannot initialize the standby of the partition");
+        continue;
+      }
+      auto standby_pair = make_pair(partition_id, standby_partition);
+      if (!standby_partitions_map_.Insert(standby_pair, standby_partition)
+               .Successful()) {
+        continue;
+      }
+      SCP_INFO(kPBSPartitionManager, partition_id,
+               "Keeping a standby of the partition");
+    }
+
+    // The recovery replays only the journals since the previous one. If the
+    // partition was taken for loading meanwhile, the recovery fails and the
+    // load catches up instead.
+    auto execution_result = standby_partition->RecoverAsStandby();
+    if (!execution_result.Successful()) {
+      shared_ptr<PBSPartitionInterface> current_standby_partition;
+      if (standby_partitions_map_.Find(partition_id, current_standby_partition)
+              .Successful() &&
+          current_standby_partition == standby_partition) {
+        // The standby could not be recovered from the checkpoint either, or
+        // its owner published no journal it can tail yet.
+        SCP_ERROR(kPBSPartitionManager, partition_id, execution_result,
+                  "Cannot recover the standby of the partition, discarding "
+                  "it");
+        standby_partitions_map_.Erase(partition_id);
+      }
+    }
+  }
+}
+
 }  // namespace google::scp::pbs
@@ -16,10 +16,17 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "core/common/concurrent_map/src/concurrent_map.h"
+#include "pbs/interface/partition_load_statistics_interface.h"
 #include "pbs/interface/pbs_partition_manager_interface.h"
 #include "pbs/partition/src/pbs_partition.h"
 #include "pbs/partition_manager/src/pbs_partition_manager_map_entry.h"
@@ -29,10 +36,23 @@ namespace google::scp::pbs {
 /**
  * @copydoc PBSPartitionManagerInterface
  */
-class PBSPartitionManager : public PBSPartitionManagerInterface {
+class PBSPartitionManager : public PBSPartitionManagerInterface,
+                            public PartitionLoadStatisticsInterface {
  public:
-  PBSPartitionManager(PBSPartition::Dependencies partition_dependencies,
-                      size_t partition_transaction_manager_capacity);
+  /**
+   * @brief Construct a new PBSPartitionManager.
+   *
+   * @param partition_dependencies
+   * @param partition_transaction_manager_capacity
+   * @param standby_partition_ring the ordered IDs of all of the partitions of
+   * the cluster. If not empty, a warm standby is kept for each partition whose
+   * successor in this ring is loaded locally but which itself is not, so that
+   * its takeover only has to catch up on the latest journals.
+   */
+  PBSPartitionManager(
+      PBSPartition::Dependencies partition_dependencies,
+      size_t partition_transaction_manager_capacity,
+      std::vector<core::PartitionId> standby_partition_ring = {});
 
   core::ExecutionResult Init() noexcept override;
 
@@ -60,6 +80,22 @@ class PBSPartitionManager : public PBSPartitionManagerInterface {
   core::ExecutionResultOr<std::shared_ptr<PBSPartitionInterface>>
   GetPBSPartition(const core::PartitionId& partition_id) noexcept override;
 
+  uint64_t GetPartitionsVersion() noexcept override;
+
+  std::vector<std::pair<core::PartitionId, PartitionLoad>>
+  GetLocalPartitionsLoad() noexcept override;
+
+  size_t GetPartitionRoutedRequestsCount(
+      const core::PartitionId& partition_id) noexcept override;
+
+  /**
+   * @brief Brings the warm standby partitions in line with the locally loaded
+   * partitions: initializes the standbys newly designated, catches up all of
+   * them on their journals and discards the ones no longer designated. Called
+   * periodically while running if a standby partition ring is configured.
+   */
+  void RefreshStandbyPartitions() noexcept;
+
  protected:
   /**
    * @brief Internal factory method for PBS partition.
@@ -88,5 +124,38 @@ class PBSPartitionManager : public PBSPartitionManagerInterface {
                               std::shared_ptr<PBSPartitionManagerMapEntry>,
                               core::common::UuidCompare>
       loaded_partitions_map_;
+
+  /// @brief Incremented after every change of loaded_partitions_map_ or of
+  /// an address in it, and when running or stopping.
+  std::atomic<uint64_t> partitions_version_;
+
+  /**
+   * @brief Get the IDs of the partitions this node should keep a warm standby
+   * of, i.e. the ring predecessors of the local partitions that are not local
+   * themselves.
+   */
+  std::vector<core::PartitionId> GetDesignatedStandbyPartitionIds() noexcept;
+
+  /// @brief Ordered IDs of all of the partitions, see the constructor.
+  const std::vector<core::PartitionId> standby_partition_ring_;
+
+  /// @brief Map of the warm standby partitions. These are initialized and
+  /// recovered, but not loaded.
+  core::common::ConcurrentMap<core::PartitionId,
+                              std::shared_ptr<PBSPartitionInterface>,
+                              core::common::UuidCompare>
+      standby_partitions_map_;
+
+  /// @brief Thread periodically refreshing the standby partitions.
+  std::unique_ptr<std::thread> standby_refresher_thread_;
+
+  /// @brief Guards the wake up of the standby refresher thread on stop.
+  std::mutex standby_refresher_mutex_;
+
+  /// @brief Signals the standby refresher thread to stop.
+  std::condition_variable standby_refresher_condvar_;
+
+  /// @brief How often the standby partitions are refreshed.
+  std::chrono::milliseconds standby_refresh_interval_;
 };
 }  // namespace google::scp::pbs
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <shared_mutex>
 #include <string>
@@ -50,6 +51,9 @@ struct PBSPartitionManagerMapEntry {
   const core::PartitionId partition_id;
   const core::PartitionType partition_type;
   const std::shared_ptr<PBSPartitionInterface> partition_handle;
+  /// @brief The number of requests routed to the partition, counted on each
+  /// lookup of its address.
+  std::atomic<size_t> routed_requests_count{0};
 
  protected:
   std::shared_ptr<core::PartitionAddressUri> partition_address_uri_;
@@ -195,6 +195,142 @@ TEST_F(PBSPartitionManagerTest, StopUnloadsAllLoadedPartitions) {
   EXPECT_SUCCESS(partition_manager_.Stop());
 }
 
+TEST_F(PBSPartitionManagerTest, GetLocalPartitionsLoadSkipsRemotePartitions) {
+  SetupMocksForAllPartitionMethods(mock_partition_1);
+  SetupMocksForAllPartitionMethods(mock_partition_2);
+  EXPECT_CALL(*mock_partition_1, GetPartitionLoad)
+      .WillOnce(Return(PartitionLoad{10, 20}));
+  EXPECT_CALL(*mock_partition_2, GetPartitionLoad).Times(0);
+
+  EXPECT_TRUE(partition_manager_.GetLocalPartitionsLoad().empty());
+
+  EXPECT_SUCCESS(partition_manager_.Init());
+  EXPECT_SUCCESS(partition_manager_.Run());
+  EXPECT_SUCCESS(partition_manager_.LoadPartition(
+      {mock_partition_1_id, PartitionType::Local, "https://localhost"}));
+  EXPECT_SUCCESS(partition_manager_.LoadPartition(
+      {mock_partition_2_id, PartitionType::Remote, "https://1.1.1.1:9090"}));
+
+  auto partitions_load = partition_manager_.GetLocalPartitionsLoad();
+  ASSERT_EQ(partitions_load.size(), 1);
+  EXPECT_EQ(partitions_load[0].first, mock_partition_1_id);
+  EXPECT_EQ(partitions_load[0].second.requests_seen_count, 10);
+  EXPECT_EQ(partitions_load[0].second.cached_budget_keys_count, 20);
+
+  EXPECT_SUCCESS(partition_manager_.Stop());
+}
+
+TEST_F(PBSPartitionManagerTest, PartitionsVersionIncreasesOnEveryChange) {
+  SetupMocksForAllPartitionMethods(mock_partition_1);
+
+  EXPECT_SUCCESS(partition_manager_.Init());
+  auto version = partition_manager_.GetPartitionsVersion();
+  EXPECT_SUCCESS(partition_manager_.Run());
+  EXPECT_GT(partition_manager_.GetPartitionsVersion(), version);
+
+  version = partition_manager_.GetPartitionsVersion();
+  PartitionMetadata partition_metadata(
+      mock_partition_1_id, PartitionType::Local, "https://localhost");
+  EXPECT_SUCCESS(partition_manager_.LoadPartition(partition_metadata));
+  EXPECT_GT(partition_manager_.GetPartitionsVersion(), version);
+
+  version = partition_manager_.GetPartitionsVersion();
+  EXPECT_SUCCESS(partition_manager_.RefreshPartitionAddress(
+      {mock_partition_1_id, PartitionType::Local, "https://1.1.1.1:9090"}));
+  EXPECT_GT(partition_manager_.GetPartitionsVersion(), version);
+
+  version = partition_manager_.GetPartitionsVersion();
+  EXPECT_SUCCESS(partition_manager_.UnloadPartition(partition_metadata));
+  EXPECT_GT(partition_manager_.GetPartitionsVersion(), version);
+
+  version = partition_manager_.GetPartitionsVersion();
+  EXPECT_SUCCESS(partition_manager_.Stop());
+  EXPECT_GT(partition_manager_.GetPartitionsVersion(), version);
+}
+
+TEST_F(PBSPartitionManagerTest,
+       RefreshStandbyPartitionsKeepsRingPredecessorOfLocalPartitions) {
+  PBSPartitionManagerWithOverrides partition_manager(
+      partition_dependencies_, 1000 /* transaction capacity */,
+      {mock_partition_1_id, mock_partition_2_id});
+  partition_manager.construct_partition_override_ =
+      partition_manager_.construct_partition_override_;
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->Set(kJournalServiceBucketName, "budget");
+  partition_manager.SetConfigProvider(mock_config_provider);
+
+  SetupMocksForAllPartitionMethods(mock_partition_1);
+  SetupMocksForAllPartitionMethods(mock_partition_2);
+  // Partition 1 precedes the local partition 2 in the ring, its standby is
+  // initialized once and recovered on every refresh.
+  EXPECT_CALL(*mock_partition_1, RecoverAsStandby)
+      .Times(2)
+      .WillRepeatedly(Return(SuccessExecutionResult()));
+  EXPECT_CALL(*mock_partition_2, RecoverAsStandby).Times(0);
+
+  EXPECT_SUCCESS(partition_manager.Init());
+  EXPECT_SUCCESS(partition_manager.Run());
+
+  // Nothing is local yet.
+  partition_manager.RefreshStandbyPartitions();
+
+  EXPECT_SUCCESS(partition_manager.LoadPartition(
+      {mock_partition_2_id, PartitionType::Local, "https://localhost"}));
+  partition_manager.RefreshStandbyPartitions();
+  partition_manager.RefreshStandbyPartitions();
+
+  // The standby is loaded without being initialized again.
+  EXPECT_SUCCESS(partition_manager.LoadPartition(
+      {mock_partition_1_id, PartitionType::Local, "https://localhost"}));
+  EXPECT_EQ(mock_partition_1->partition_state_.load(),
+            core::PartitionLoadUnloadState::Loaded);
+
+  // Both partitions are local, no standby is needed anymore.
+  partition_manager.RefreshStandbyPartitions();
+
+  EXPECT_SUCCESS(partition_manager.Stop());
+}
+
+TEST_F(PBSPartitionManagerTest,
+       RefreshStandbyPartitionsDiscardsStandbyFailingToRecover) {
+  PBSPartitionManagerWithOverrides partition_manager(
+      partition_dependencies_, 1000 /* transaction capacity */,
+      {mock_partition_1_id, mock_partition_2_id});
+  auto standby_partitions_constructed = 0;
+  partition_manager.construct_partition_override_ =
+      [&](const PartitionId& partition_id,
+          const PartitionType& partition_type) {
+        if (partition_id == mock_partition_1_id) {
+          standby_partitions_constructed++;
+        }
+        return partition_manager_.construct_partition_override_(
+            partition_id, partition_type);
+      };
+  auto mock_config_provider = make_shared<MockConfigProvider>();
+  mock_config_provider->Set(kJournalServiceBucketName, "budget");
+  partition_manager.SetConfigProvider(mock_config_provider);
+
+  SetupMocksForAllPartitionMethods(mock_partition_2);
+  EXPECT_CALL(*mock_partition_1, Init)
+      .WillRepeatedly(Return(SuccessExecutionResult()));
+  EXPECT_CALL(*mock_partition_1, RecoverAsStandby)
+      .WillOnce(Return(FailureExecutionResult(SC_UNKNOWN)))
+      .WillOnce(Return(SuccessExecutionResult()));
+
+  EXPECT_SUCCESS(partition_manager.Init());
+  EXPECT_SUCCESS(partition_manager.Run());
+  EXPECT_SUCCESS(partition_manager.LoadPartition(
+      {mock_partition_2_id, PartitionType::Local, "https://localhost"}));
+
+  // The failed standby is constructed anew on the next refresh.
+  partition_manager.RefreshStandbyPartitions();
+  EXPECT_EQ(standby_partitions_constructed, 1);
+  partition_manager.RefreshStandbyPartitions();
+  EXPECT_EQ(standby_partitions_constructed, 2);
+
+  EXPECT_SUCCESS(partition_manager.Stop());
+}
+
 TEST_F(PBSPartitionManagerTest, StopFailsIfCannotUnloadPartition) {
   EXPECT_SUCCESS(partition_manager_.Init());
   EXPECT_SUCCESS(partition_manager_.Run());
@@ -373,6 +509,34 @@ TEST_F(PBSPartitionManagerTest, GetPartitionAddress) {
   EXPECT_SUCCESS(partition_manager_.Stop());
 }
 
+TEST_F(PBSPartitionManagerTest, GetPartitionAddressCountsRoutedRequests) {
+  EXPECT_SUCCESS(partition_manager_.Init());
+  EXPECT_SUCCESS(partition_manager_.Run());
+
+  SetupMocksForAllPartitionMethods(mock_partition_2);
+
+  EXPECT_EQ(partition_manager_.GetPartitionRoutedRequestsCount(
+                mock_partition_2_id),
+            0);
+  EXPECT_SUCCESS(partition_manager_.LoadPartition(
+      {mock_partition_2_id, PartitionType::Remote, "https://1.1.1.1:9090"}));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(partition_manager_.GetPartitionAddress(mock_partition_2_id)
+                    .has_value());
+  }
+  EXPECT_EQ(partition_manager_.GetPartitionRoutedRequestsCount(
+                mock_partition_2_id),
+            3);
+
+  EXPECT_SUCCESS(partition_manager_.UnloadPartition(
+      {mock_partition_2_id, PartitionType::Remote, ""}));
+  EXPECT_EQ(partition_manager_.GetPartitionRoutedRequestsCount(
+                mock_partition_2_id),
+            0);
+
+  EXPECT_SUCCESS(partition_manager_.Stop());
+}
+
 TEST_F(PBSPartitionManagerTest, RefreshPartitionAddress) {
   EXPECT_SUCCESS(partition_manager_.Init());
   EXPECT_SUCCESS(partition_manager_.Run());
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pbs/partition_namespace/src/pbs_consistent_hash_partition_namespace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+using google::scp::core::PartitionId;
+using google::scp::core::ResourceId;
+using std::make_pair;
+using std::pair;
+using std::vector;
+
+namespace {
+/// The splitmix64 finalizer. Spreads the bits of the input over the whole
+/// output so that nearby inputs land far apart on the ring.
+uint64_t Mix(uint64_t value) {
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+}  // namespace
+
+namespace google::scp::pbs {
+
+PBSConsistentHashPartitionNamespace::PBSConsistentHashPartitionNamespace(
+    const vector<PartitionId>& partitions, size_t virtual_node_count)
+    : PBSConsistentHashPartitionNamespace(
+          partitions, vector<size_t>(partitions.size(), virtual_node_count)) {}
+
+PBSConsistentHashPartitionNamespace::PBSConsistentHashPartitionNamespace(
+    const vector<PartitionId>& partitions,
+    const vector<size_t>& virtual_node_counts)
+    : PBSPartitionNamespace(partitions) {
+  assert(virtual_node_counts.size() == partitions_.size());
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    const auto& partition_id = partitions_[i];
+    // At least one virtual node, so that every partition can be mapped to.
+    auto virtual_node_count = std::max<size_t>(virtual_node_counts[i], 1);
+    for (size_t j = 0; j < virtual_node_count; ++j) {
+      ring_.push_back(make_pair(
+          Mix(partition_id.high ^ Mix(partition_id.low ^ Mix(j))),
+          partition_id));
+    }
+  }
+  // Ties are broken by the partition id so that every node builds the same
+  // ring.
+  std::sort(ring_.begin(), ring_.end(),
+            [](const pair<uint64_t, PartitionId>& left,
+               const pair<uint64_t, PartitionId>& right) {
+              if (left.first != right.first) {
+                return left.first < right.first;
+              }
+              if (left.second.high != right.second.high) {
+                return left.second.high < right.second.high;
+              }
+              return left.second.low < right.second.low;
+            });
+}
+
+PartitionId PBSConsistentHashPartitionNamespace::MapResourceToPartition(
+    const ResourceId& resource_id) noexcept {
+  uint64_t hash_value = Mix(resource_hasher_(resource_id));
+  auto virtual_node = std::lower_bound(
+      ring_.begin(), ring_.end(), hash_value,
+      [](const pair<uint64_t, PartitionId>& node, uint64_t hash_value) {
+        return node.first < hash_value;
+      });
+  if (virtual_node == ring_.end()) {
+    virtual_node = ring_.begin();
+  }
+  return virtual_node->second;
+}
+}  // namespace google::scp::pbs
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "pbs/partition_namespace/src/pbs_partition_namespace.h"
+
+namespace google::scp::pbs {
+/// Number of virtual nodes each partition places on the hash ring by default.
+inline constexpr size_t kDefaultPartitionNamespaceVirtualNodeCount = 128;
+
+/**
+ * @copydoc PBSPartitionNamespace
+ *
+ * Resources are mapped with a consistent hash ring instead of a modulo of the
+ * partition count. Every partition places a number of virtual nodes on the
+ * ring, derived from its id only, and a resource belongs to the partition of
+ * the first virtual node at or after its hash. Adding or removing one of N
+ * partitions therefore only moves about 1/N of the resources, and the other
+ * partitions keep their cached budget keys. A partition with more virtual
+ * nodes gets a proportionally larger share of the resources.
+ */
+class PBSConsistentHashPartitionNamespace : public PBSPartitionNamespace {
+ public:
+  /**
+   * @param partitions The partitions of the namespace.
+   * @param virtual_node_count The number of virtual nodes of every partition.
+   */
+  PBSConsistentHashPartitionNamespace(
+      const std::vector<core::PartitionId>& partitions,
+      size_t virtual_node_count = kDefaultPartitionNamespaceVirtualNodeCount);
+
+  /**
+   * @param partitions The partitions of the namespace.
+   * @param virtual_node_counts The number of virtual nodes of each partition,
+   * in the order of partitions, to weight their share of the resources.
+   */
+  PBSConsistentHashPartitionNamespace(
+      const std::vector<core::PartitionId>& partitions,
+      const std::vector<size_t>& virtual_node_counts);
+
+  core::PartitionId MapResourceToPartition(
+      const core::ResourceId&) noexcept override;
+
+ protected:
+  /// The virtual nodes of all the partitions, sorted by their hash.
+  std::vector<std::pair<uint64_t, core::PartitionId>> ring_;
+};
+}  // namespace google::scp::pbs
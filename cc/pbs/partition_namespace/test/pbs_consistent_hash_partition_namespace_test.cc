@@ -0,0 +1,153 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pbs/partition_namespace/src/pbs_consistent_hash_partition_namespace.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/uuid/src/uuid.h"
+#include "core/interface/partition_types.h"
+
+using google::scp::core::PartitionId;
+using google::scp::core::ResourceId;
+using google::scp::core::common::UuidHash;
+using std::string;
+using std::to_string;
+using std::unordered_map;
+using std::vector;
+
+namespace google::scp::pbs::test {
+
+static constexpr size_t kResourceCount = 100000;
+
+vector<PartitionId> GetPartitions(size_t partition_count) {
+  vector<PartitionId> partitions;
+  for (size_t i = 1; i <= partition_count; ++i) {
+    partitions.push_back(PartitionId{0, i});
+  }
+  return partitions;
+}
+
+TEST(PBSConsistentHashPartitionNamespaceTest, MapsAllToSinglePartition) {
+  auto partitions = GetPartitions(1);
+  PBSConsistentHashPartitionNamespace partition_namespace(partitions);
+  EXPECT_EQ(partition_namespace.MapResourceToPartition(""), partitions[0]);
+  EXPECT_EQ(partition_namespace.MapResourceToPartition("google.com"),
+            partitions[0]);
+  EXPECT_EQ(partition_namespace.GetPartitions(), partitions);
+}
+
+TEST(PBSConsistentHashPartitionNamespaceTest, MappingIsDeterministic) {
+  auto partitions = GetPartitions(8);
+  PBSConsistentHashPartitionNamespace partition_namespace_1(partitions);
+  // The order of the partitions does not change the ring.
+  vector<PartitionId> reversed_partitions(partitions.rbegin(),
+                                          partitions.rend());
+  PBSConsistentHashPartitionNamespace partition_namespace_2(
+      reversed_partitions);
+  for (size_t i = 0; i < 1000; ++i) {
+    auto resource = "google" + to_string(i) + ".com";
+    EXPECT_EQ(partition_namespace_1.MapResourceToPartition(resource),
+              partition_namespace_2.MapResourceToPartition(resource));
+  }
+}
+
+TEST(PBSConsistentHashPartitionNamespaceTest, SpreadsResourcesEvenly) {
+  auto partitions = GetPartitions(10);
+  PBSConsistentHashPartitionNamespace partition_namespace(partitions);
+  unordered_map<PartitionId, size_t, UuidHash> mapped_counts;
+  for (size_t i = 0; i < kResourceCount; ++i) {
+    mapped_counts[partition_namespace.MapResourceToPartition(to_string(i))]++;
+  }
+
+  ASSERT_EQ(mapped_counts.size(), partitions.size());
+  for (const auto& [partition_id, mapped_count] : mapped_counts) {
+    // Within half of the fair share.
+    EXPECT_GT(mapped_count, kResourceCount / partitions.size() / 2);
+    EXPECT_LT(mapped_count, kResourceCount / partitions.size() * 3 / 2);
+  }
+}
+
+TEST(PBSConsistentHashPartitionNamespaceTest,
+     AddingAPartitionOnlyMovesResourcesToIt) {
+  auto partitions = GetPartitions(9);
+  PBSConsistentHashPartitionNamespace partition_namespace(partitions);
+  auto scaled_partitions = GetPartitions(10);
+  PBSConsistentHashPartitionNamespace scaled_partition_namespace(
+      scaled_partitions);
+
+  size_t moved_count = 0;
+  for (size_t i = 0; i < kResourceCount; ++i) {
+    auto resource = to_string(i);
+    auto partition_id = partition_namespace.MapResourceToPartition(resource);
+    auto scaled_partition_id =
+        scaled_partition_namespace.MapResourceToPartition(resource);
+    if (partition_id != scaled_partition_id) {
+      EXPECT_EQ(scaled_partition_id, scaled_partitions.back());
+      moved_count++;
+    }
+  }
+
+  // About 1/10 of the resources move, where the modulo mapping moves 9/10.
+  EXPECT_GT(moved_count, kResourceCount / 20);
+  EXPECT_LT(moved_count, kResourceCount / 5);
+}
+
+TEST(PBSConsistentHashPartitionNamespaceTest,
+     RemovingAPartitionOnlyMovesItsResources) {
+  auto partitions = GetPartitions(10);
+  PBSConsistentHashPartitionNamespace partition_namespace(partitions);
+  auto removed_partition = partitions[3];
+  auto remaining_partitions = partitions;
+  remaining_partitions.erase(remaining_partitions.begin() + 3);
+  PBSConsistentHashPartitionNamespace remaining_partition_namespace(
+      remaining_partitions);
+
+  for (size_t i = 0; i < kResourceCount; ++i) {
+    auto resource = to_string(i);
+    auto partition_id = partition_namespace.MapResourceToPartition(resource);
+    auto remaining_partition_id =
+        remaining_partition_namespace.MapResourceToPartition(resource);
+    EXPECT_NE(remaining_partition_id, removed_partition);
+    if (partition_id != removed_partition) {
+      EXPECT_EQ(partition_id, remaining_partition_id);
+    }
+  }
+}
+
+TEST(PBSConsistentHashPartitionNamespaceTest,
+     VirtualNodeCountsWeightTheShares) {
+  auto partitions = GetPartitions(2);
+  PBSConsistentHashPartitionNamespace partition_namespace(
+      partitions, vector<size_t>{100, 300});
+  size_t heavy_partition_count = 0;
+  for (size_t i = 0; i < kResourceCount; ++i) {
+    if (partition_namespace.MapResourceToPartition(to_string(i)) ==
+        partitions[1]) {
+      heavy_partition_count++;
+    }
+  }
+
+  // About 3/4 of the resources.
+  EXPECT_GT(heavy_partition_count, kResourceCount * 65 / 100);
+  EXPECT_LT(heavy_partition_count, kResourceCount * 85 / 100);
+}
+
+}  // namespace google::scp::pbs::test
@@ -16,6 +16,9 @@
 
 #include "pbs/partition_request_router/src/transaction_request_router_for_partition.h"
 
+#include <mutex>
+#include <shared_mutex>
+
 #include "pbs/partition_request_router/src/error_codes.h"
 
 using google::scp::core::AsyncContext;
@@ -34,6 +37,9 @@ using google::scp::core::TransactionPhaseResponse;
 using google::scp::core::TransactionRequest;
 using google::scp::core::TransactionResponse;
 using google::scp::core::common::Uuid;
+using std::shared_lock;
+using std::shared_mutex;
+using std::unique_lock;
 
 namespace google::scp::pbs {
 
@@ -41,7 +47,33 @@ ExecutionResultOr<std::shared_ptr<PBSPartitionInterface>>
 TransactionRequestRouterForPartition::GetPartition(
     const ResourceId& resource_id) {
   auto partition_id = partition_namespace_->MapResourceToPartition(resource_id);
-  return partition_manager_->GetPBSPartition(partition_id);
+  // Read before the partition, so that a partition resolved while the
+  // partitions change is cached only for an outdated version.
+  auto partitions_version = partition_manager_->GetPartitionsVersion();
+  {
+    shared_lock<shared_mutex> lock(resolved_partitions_mutex_);
+    if (resolved_partitions_version_ == partitions_version) {
+      auto it = resolved_partitions_.find(partition_id);
+      if (it != resolved_partitions_.end()) {
+        return it->second;
+      }
+    }
+  }
+
+  auto partition_or = partition_manager_->GetPBSPartition(partition_id);
+  if (!partition_or.Successful()) {
+    return partition_or;
+  }
+
+  unique_lock<shared_mutex> lock(resolved_partitions_mutex_);
+  if (resolved_partitions_version_ < partitions_version) {
+    resolved_partitions_.clear();
+    resolved_partitions_version_ = partitions_version;
+  }
+  if (resolved_partitions_version_ == partitions_version) {
+    resolved_partitions_[partition_id] = *partition_or;
+  }
+  return partition_or;
 }
 
 ExecutionResult TransactionRequestRouterForPartition::Execute(
@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <shared_mutex>
+#include <unordered_map>
 
 #include "core/interface/partition_manager_interface.h"
 #include "core/interface/partition_namespace_interface.h"
@@ -33,6 +36,9 @@ namespace google::scp::pbs {
  *
  * Target partition is determined with the help of ReportingOrigin of the
  * transaction request.
+ *
+ * The partitions are resolved once per version of the partition manager's set
+ * of partitions, i.e. until a lease event loads, unloads or moves one of them.
  */
 class TransactionRequestRouterForPartition
     : public core::TransactionRequestRouterInterface {
@@ -42,7 +48,8 @@ class TransactionRequestRouterForPartition
           partition_namespace,
       const std::shared_ptr<PBSPartitionManagerInterface>& partition_manager)
       : partition_namespace_(partition_namespace),
-        partition_manager_(partition_manager) {}
+        partition_manager_(partition_manager),
+        resolved_partitions_version_(0) {}
 
   core::ExecutionResult Execute(
       core::AsyncContext<core::TransactionRequest, core::TransactionResponse>&
@@ -85,5 +92,18 @@ class TransactionRequestRouterForPartition
 
   /// @brief Partition object to be retrieved from
   const std::shared_ptr<PBSPartitionManagerInterface> partition_manager_;
+
+  /// @brief The partitions resolved at resolved_partitions_version_ of the
+  /// partition manager. The partitions failing to resolve are not cached.
+  std::unordered_map<core::PartitionId, std::shared_ptr<PBSPartitionInterface>,
+                     core::common::UuidHash>
+      resolved_partitions_;
+
+  /// @brief The partitions version of the partition manager that the resolved
+  /// partitions are valid for.
+  uint64_t resolved_partitions_version_;
+
+  /// @brief Guards the resolved partitions, which are mostly read.
+  std::shared_mutex resolved_partitions_mutex_;
 };
 }  // namespace google::scp::pbs
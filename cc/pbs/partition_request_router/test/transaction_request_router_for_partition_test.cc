@@ -121,6 +121,58 @@ TEST_F(TransactionRequestRouterForPartitionTest,
               SC_PBS_TRANSACTION_REQUEST_ROUTER_PARTITION_UNAVAILABLE)));
 }
 
+TEST_F(TransactionRequestRouterForPartitionTest,
+       ExecuteTransactionRequestResolvesPartitionOncePerVersion) {
+  EXPECT_CALL(*partition_manager_mock_, GetPartitionsVersion)
+      .WillOnce(Return(1))
+      .WillOnce(Return(1))
+      .WillOnce(Return(2));
+  EXPECT_CALL(*partition_manager_mock_, GetPBSPartition(partition_id_1_))
+      .Times(2)
+      .WillRepeatedly(Return(partition_mock_));
+  EXPECT_CALL(*partition_namespace_mock_, MapResourceToPartition("origin"))
+      .WillRepeatedly(Return(partition_id_1_));
+  EXPECT_CALL(*partition_mock_,
+              ExecuteRequest(
+                  An<AsyncContext<TransactionRequest, TransactionResponse>&>()))
+      .Times(3)
+      .WillRepeatedly(Return(SuccessExecutionResult()));
+
+  AsyncContext<TransactionRequest, TransactionResponse> context(
+      std::make_shared<TransactionRequest>(), [](auto&) {});
+  context.request->transaction_origin = std::make_shared<std::string>("origin");
+  // The second request is served from the cache, the third resolves the
+  // partition again since the partitions changed.
+  EXPECT_SUCCESS(transaction_request_router_->Execute(context));
+  EXPECT_SUCCESS(transaction_request_router_->Execute(context));
+  EXPECT_SUCCESS(transaction_request_router_->Execute(context));
+}
+
+TEST_F(TransactionRequestRouterForPartitionTest,
+       ExecuteTransactionRequestDoesNotCacheUnavailablePartition) {
+  EXPECT_CALL(*partition_manager_mock_, GetPartitionsVersion)
+      .WillRepeatedly(Return(1));
+  EXPECT_CALL(*partition_manager_mock_, GetPBSPartition(partition_id_1_))
+      .WillOnce(Return(FailureExecutionResult(1234)))
+      .WillOnce(Return(partition_mock_));
+  EXPECT_CALL(*partition_namespace_mock_, MapResourceToPartition("origin"))
+      .WillRepeatedly(Return(partition_id_1_));
+  EXPECT_CALL(*partition_mock_,
+              ExecuteRequest(
+                  An<AsyncContext<TransactionRequest, TransactionResponse>&>()))
+      .WillOnce(Return(SuccessExecutionResult()));
+
+  AsyncContext<TransactionRequest, TransactionResponse> context(
+      std::make_shared<TransactionRequest>(), [](auto&) {});
+  context.request->transaction_origin = std::make_shared<std::string>("origin");
+  EXPECT_THAT(
+      transaction_request_router_->Execute(context),
+      ResultIs(FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_REQUEST_ROUTER_PARTITION_UNAVAILABLE)));
+  EXPECT_SUCCESS(transaction_request_router_->Execute(context));
+}
+
 TEST_F(TransactionRequestRouterForPartitionTest,
        ExecuteTransactionPhaseRequest) {
   EXPECT_CALL(*partition_manager_mock_, GetPBSPartition(partition_id_1_))
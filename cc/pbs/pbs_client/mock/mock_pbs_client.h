@@ -56,6 +56,16 @@ class MockPrivacyBudgetServiceClient
     return core::SuccessExecutionResult();
   }
 
+  core::ExecutionResult ConsumeBudget(
+      core::AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&
+          consume_budget_transaction_context) noexcept override {
+    if (consume_budget_mock) {
+      return consume_budget_mock(consume_budget_transaction_context);
+    }
+    return core::SuccessExecutionResult();
+  }
+
   core::ExecutionResult GetTransactionStatus(
       core::AsyncContext<core::GetTransactionStatusRequest,
                          core::GetTransactionStatusResponse>&
@@ -67,11 +77,28 @@ class MockPrivacyBudgetServiceClient
     return core::SuccessExecutionResult();
   }
 
+  core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept override {
+    if (batch_get_transaction_status_mock) {
+      return batch_get_transaction_status_mock(
+          batch_get_transaction_status_context);
+    }
+
+    return core::SuccessExecutionResult();
+  }
+
   std::function<core::ExecutionResult(
       core::AsyncContext<ConsumeBudgetTransactionRequest,
                          ConsumeBudgetTransactionResponse>&)>
       initiate_consume_budget_transaction_mock;
 
+  std::function<core::ExecutionResult(
+      core::AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&)>
+      consume_budget_mock;
+
   std::function<core::ExecutionResult(
       core::AsyncContext<core::TransactionPhaseRequest,
                          core::TransactionPhaseResponse>&)>
@@ -81,5 +108,10 @@ class MockPrivacyBudgetServiceClient
       core::AsyncContext<core::GetTransactionStatusRequest,
                          core::GetTransactionStatusResponse>&)>
       get_transaction_status_mock;
+
+  std::function<core::ExecutionResult(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&)>
+      batch_get_transaction_status_mock;
 };
 }  // namespace google::scp::pbs::client::mock
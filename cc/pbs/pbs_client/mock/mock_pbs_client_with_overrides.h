@@ -63,8 +63,22 @@ class MockPrivacyBudgetServiceClientWithOverrides
         get_transaction_status_context, http_context);
   }
 
+  virtual void OnBatchGetTransactionStatusCallback(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context,
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept {
+    PrivacyBudgetServiceClient::OnBatchGetTransactionStatusCallback(
+        batch_get_transaction_status_context, http_context);
+  }
+
   std::string GetTransactionStatusUrl() { return *get_transaction_status_url_; }
 
+  std::string GetBatchTransactionStatusUrl() {
+    return *batch_get_transaction_status_url_;
+  }
+
   std::string GetExecuteTransactionBeginPhaseUrl() {
     return *begin_consume_budget_transaction_url_;
   }
@@ -31,10 +31,12 @@ class MockClientConsumeBudgetCommand : public ClientConsumeBudgetCommand {
       std::shared_ptr<std::string>& transaction_secret,
       std::shared_ptr<std::vector<ConsumeBudgetMetadata>>& budget_keys,
       std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
-      std::shared_ptr<PrivacyBudgetServiceClientInterface>& pbs_client)
+      std::shared_ptr<PrivacyBudgetServiceClientInterface>& pbs_client,
+      bool consume_in_one_request = false)
       : ClientConsumeBudgetCommand(transaction_id, transaction_secret,
                                    budget_keys, async_executor, pbs_client,
-                                   core::common::kZeroUuid) {}
+                                   core::common::kZeroUuid,
+                                   consume_in_one_request) {}
 
   virtual core::ExecutionResult Begin(
       core::TransactionCommandCallback& callback) noexcept {
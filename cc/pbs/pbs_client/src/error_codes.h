@@ -41,4 +41,10 @@ DEFINE_ERROR_CODE(SC_PBS_CLIENT_NO_BUDGET_KEY_PROVIDED, SC_PBS_CLIENT, 0x0004,
 DEFINE_ERROR_CODE(SC_PBS_CLIENT_INVALID_TRANSACTION_METADATA, SC_PBS_CLIENT,
                   0x0005, "Invalid transaction metadata.",
                   HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SC_PBS_CLIENT_CONSUME_BUDGET_IN_ONE_REQUEST_NOT_ATOMIC,
+                  SC_PBS_CLIENT, 0x0006,
+                  "Consuming the budget in one request is only supported for "
+                  "a single request to a single coordinator.",
+                  HttpStatusCode::BAD_REQUEST)
 }  // namespace google::scp::core::errors
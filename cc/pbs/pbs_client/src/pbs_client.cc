@@ -29,6 +29,7 @@
 #include "core/interface/authorization_service_interface.h"
 #include "core/interface/type_def.h"
 #include "pbs/front_end_service/src/front_end_utils.h"
+#include "pbs/front_end_service/src/proto/begin_transaction_request.pb.h"
 #include "pbs/interface/type_def.h"
 
 #include "error_codes.h"
@@ -37,6 +38,8 @@ using google::protobuf::util::TimeUtil;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::AsyncPriority;
+using google::scp::core::BatchGetTransactionStatusRequest;
+using google::scp::core::BatchGetTransactionStatusResponse;
 using google::scp::core::Byte;
 using google::scp::core::BytesBuffer;
 using google::scp::core::ExecutionResult;
@@ -71,13 +74,17 @@ PrivacyBudgetServiceClient::PrivacyBudgetServiceClient(
     const string& reporting_origin, const string& pbs_endpoint,
     const shared_ptr<HttpClientInterface>& http_client,
     const std::shared_ptr<core::TokenProviderCacheInterface>&
-        authorization_token_provider_cache)
+        authorization_token_provider_cache,
+    BudgetRequestEncoding request_encoding)
     : reporting_origin_(reporting_origin),
       pbs_endpoint_(pbs_endpoint),
       http_client_(http_client),
-      authorization_token_provider_cache_(authorization_token_provider_cache) {
+      authorization_token_provider_cache_(authorization_token_provider_cache),
+      request_encoding_(request_encoding) {
   get_transaction_status_url_ =
       make_shared<string>(pbs_endpoint_ + string(kStatusTransactionPath));
+  batch_get_transaction_status_url_ =
+      make_shared<string>(pbs_endpoint_ + string(kBatchStatusTransactionPath));
   begin_consume_budget_transaction_url_ =
       make_shared<string>(pbs_endpoint_ + string(kBeginTransactionPath));
   prepare_consume_budget_transaction_url_ =
@@ -90,6 +97,8 @@ PrivacyBudgetServiceClient::PrivacyBudgetServiceClient(
       make_shared<string>(pbs_endpoint_ + string(kAbortTransactionPath));
   end_consume_budget_transaction_url_ =
       make_shared<string>(pbs_endpoint_ + string(kEndTransactionPath));
+  consume_budget_url_ =
+      make_shared<string>(pbs_endpoint_ + string(kStatusConsumeBudgetPath));
 }
 
 ExecutionResult PrivacyBudgetServiceClient::Init() noexcept {
@@ -116,6 +125,26 @@ PrivacyBudgetServiceClient::SerializeConsumeBudgetTransactionRequest(
         core::errors::SC_PBS_CLIENT_NO_BUDGET_KEY_PROVIDED);
   }
 
+  if (request_encoding_ == BudgetRequestEncoding::kProtobuf) {
+    front_end_service::proto::BeginTransactionRequestBody transaction_request;
+    transaction_request.set_version("1.0");
+    for (const auto& budget_key :
+         *consume_budget_transaction_request->budget_keys) {
+      auto* proto_budget_key = transaction_request.add_keys();
+      proto_budget_key->set_key(*budget_key.budget_key_name);
+      proto_budget_key->set_token(budget_key.token_count);
+      proto_budget_key->mutable_reporting_time()->set_seconds(
+          std::chrono::duration_cast<seconds>(
+              nanoseconds(budget_key.time_bucket))
+              .count());
+    }
+    if (!transaction_request.SerializeToString(&serialized)) {
+      return FailureExecutionResult(
+          core::errors::SC_PBS_CLIENT_INVALID_TRANSACTION_METADATA);
+    }
+    return SuccessExecutionResult();
+  }
+
   nlohmann::json serialized_body =
       nlohmann::json::parse("{\"v\": \"1.0\", \"t\": []}");
   for (auto budget_key : *consume_budget_transaction_request->budget_keys) {
@@ -201,10 +230,95 @@ void PrivacyBudgetServiceClient::OnGetTransactionStatusCallback(
   get_transaction_status_context.Finish();
 }
 
+ExecutionResult PrivacyBudgetServiceClient::BatchGetTransactionStatus(
+    AsyncContext<BatchGetTransactionStatusRequest,
+                 BatchGetTransactionStatusResponse>&
+        batch_get_transaction_status_context) noexcept {
+  AsyncContext<HttpRequest, HttpResponse> http_context(
+      make_shared<HttpRequest>(),
+      bind(&PrivacyBudgetServiceClient::OnBatchGetTransactionStatusCallback,
+           this, batch_get_transaction_status_context, _1),
+      batch_get_transaction_status_context);
+
+  auto execution_result =
+      FrontEndUtils::SerializeBatchGetTransactionStatusRequest(
+          *batch_get_transaction_status_context.request,
+          http_context.request->body);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+
+  auto auth_token_or = authorization_token_provider_cache_->GetToken();
+  if (!auth_token_or.Successful()) {
+    return auth_token_or.result();
+  }
+
+  http_context.request->path = batch_get_transaction_status_url_;
+  http_context.request->method = HttpMethod::POST;
+  http_context.request->headers = make_shared<HttpHeaders>();
+  http_context.request->headers->insert(
+      {string(core::kAuthHeader), *auth_token_or.value()});
+  http_context.request->headers->insert(
+      {string(core::kClaimedIdentityHeader), reporting_origin_});
+
+  // Transaction origin is optional field and is supplied when a coordinator is
+  // acting on bahalf of remotely coordinated transactions
+  if (batch_get_transaction_status_context.request->transaction_origin) {
+    http_context.request->headers->insert(
+        {string(kTransactionOriginHeader),
+         *batch_get_transaction_status_context.request->transaction_origin});
+  }
+
+  return http_client_->PerformRequest(http_context);
+}
+
+void PrivacyBudgetServiceClient::OnBatchGetTransactionStatusCallback(
+    AsyncContext<BatchGetTransactionStatusRequest,
+                 BatchGetTransactionStatusResponse>&
+        batch_get_transaction_status_context,
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  if (!http_context.result.Successful()) {
+    batch_get_transaction_status_context.result = http_context.result;
+    batch_get_transaction_status_context.Finish();
+    return;
+  }
+
+  batch_get_transaction_status_context.response =
+      make_shared<BatchGetTransactionStatusResponse>();
+  batch_get_transaction_status_context.result =
+      FrontEndUtils::DeserializeBatchGetTransactionStatus(
+          http_context.response->body,
+          *batch_get_transaction_status_context.response);
+  batch_get_transaction_status_context.Finish();
+}
+
 ExecutionResult PrivacyBudgetServiceClient::InitiateConsumeBudgetTransaction(
     AsyncContext<ConsumeBudgetTransactionRequest,
                  ConsumeBudgetTransactionResponse>&
         consume_budget_transaction_context) noexcept {
+  return PerformConsumeBudgetTransactionRequest(
+      consume_budget_transaction_context, begin_consume_budget_transaction_url_,
+      false /* send_last_execution_timestamp */);
+}
+
+ExecutionResult PrivacyBudgetServiceClient::ConsumeBudget(
+    AsyncContext<ConsumeBudgetTransactionRequest,
+                 ConsumeBudgetTransactionResponse>&
+        consume_budget_transaction_context) noexcept {
+  // A FrontEndServiceV2 serves this path as the prepare phase, which requires
+  // the last execution timestamp header even though it does not use it.
+  return PerformConsumeBudgetTransactionRequest(
+      consume_budget_transaction_context, consume_budget_url_,
+      true /* send_last_execution_timestamp */);
+}
+
+ExecutionResult
+PrivacyBudgetServiceClient::PerformConsumeBudgetTransactionRequest(
+    AsyncContext<ConsumeBudgetTransactionRequest,
+                 ConsumeBudgetTransactionResponse>&
+        consume_budget_transaction_context,
+    const shared_ptr<string>& url,
+    bool send_last_execution_timestamp) noexcept {
   string serialized_body;
   auto execution_result = SerializeConsumeBudgetTransactionRequest(
       consume_budget_transaction_context.request, serialized_body);
@@ -219,7 +333,7 @@ ExecutionResult PrivacyBudgetServiceClient::InitiateConsumeBudgetTransaction(
            this, consume_budget_transaction_context, _1),
       consume_budget_transaction_context);
 
-  http_context.request->path = begin_consume_budget_transaction_url_;
+  http_context.request->path = url;
   http_context.request->body = BytesBuffer(serialized_body.length());
   http_context.request->body.bytes =
       make_shared<vector<Byte>>(serialized_body.begin(), serialized_body.end());
@@ -243,6 +357,14 @@ ExecutionResult PrivacyBudgetServiceClient::InitiateConsumeBudgetTransaction(
   http_context.request->headers->insert(
       {string(kTransactionSecretHeader),
        *consume_budget_transaction_context.request->transaction_secret});
+  if (request_encoding_ == BudgetRequestEncoding::kProtobuf) {
+    http_context.request->headers->insert(
+        {string(kContentTypeHeader), string(kProtobufContentType)});
+  }
+  if (send_last_execution_timestamp) {
+    http_context.request->headers->insert(
+        {string(kTransactionLastExecutionTimestampHeader), "0"});
+  }
 
   return http_client_->PerformRequest(http_context);
 }
@@ -43,12 +43,15 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
    * budget service.
    * @param authorization_token_provider_cache The authorization token provider
    * cache to get token from for HTTP requests.
+   * @param request_encoding The encoding of the consume budget transaction
+   * request bodies.
    */
   PrivacyBudgetServiceClient(
       const std::string& reporting_origin, const std::string& pbs_endpoint,
       const std::shared_ptr<core::HttpClientInterface>& http_client,
       const std::shared_ptr<core::TokenProviderCacheInterface>&
-          authorization_token_provider_cache);
+          authorization_token_provider_cache,
+      BudgetRequestEncoding request_encoding = BudgetRequestEncoding::kJson);
 
   core::ExecutionResult Init() noexcept override;
 
@@ -61,6 +64,11 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
                          core::GetTransactionStatusResponse>&
           get_transaction_status_context) noexcept override;
 
+  core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept override;
+
   core::ExecutionResult InitiateConsumeBudgetTransaction(
       core::AsyncContext<ConsumeBudgetTransactionRequest,
                          ConsumeBudgetTransactionResponse>&
@@ -71,7 +79,30 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
                          core::TransactionPhaseResponse>&
           transaction_phase_context) noexcept override;
 
+  core::ExecutionResult ConsumeBudget(
+      core::AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&
+          consume_budget_transaction_context) noexcept override;
+
  protected:
+  /**
+   * @brief Sends the budgets of a consume budget transaction to the given url.
+   * The response is handled by OnInitiateConsumeBudgetTransactionCallback.
+   *
+   * @param consume_budget_transaction_context The consume budget transaction
+   * context of the operation.
+   * @param url The url of the begin or consume budget endpoint.
+   * @param send_last_execution_timestamp Whether the last execution timestamp
+   * header is sent along.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult PerformConsumeBudgetTransactionRequest(
+      core::AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&
+          consume_budget_transaction_context,
+      const std::shared_ptr<std::string>& url,
+      bool send_last_execution_timestamp) noexcept;
+
   /**
    * @brief Is called when the get transaction status operation completes.
    *
@@ -86,6 +117,21 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
       core::AsyncContext<core::HttpRequest, core::HttpResponse>&
           http_context) noexcept;
 
+  /**
+   * @brief Is called when the batch get transaction status operation
+   * completes.
+   *
+   * @param batch_get_transaction_status_context The batch get transaction
+   * status context of the operation.
+   * @param http_context The http context of the http operation.
+   */
+  virtual void OnBatchGetTransactionStatusCallback(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context,
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
   /**
    * @brief Serializes consume budget transaction request to used for the http
    * request.
@@ -135,6 +181,8 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
  protected:
   /// The pre-constructed get transaction status  url.
   std::shared_ptr<std::string> get_transaction_status_url_;
+  /// The batch get transaction status url.
+  std::shared_ptr<std::string> batch_get_transaction_status_url_;
   /// The pre-constructed begin consume budget transaction url.
   std::shared_ptr<std::string> begin_consume_budget_transaction_url_;
   /// The pre-constructed prepare consume budget transaction  url.
@@ -147,6 +195,8 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
   std::shared_ptr<std::string> abort_consume_budget_transaction_url_;
   /// The pre-constructed end consume budget transaction  url.
   std::shared_ptr<std::string> end_consume_budget_transaction_url_;
+  /// The pre-constructed consume budget url.
+  std::shared_ptr<std::string> consume_budget_url_;
 
  private:
   /// The reporting origin
@@ -158,5 +208,7 @@ class PrivacyBudgetServiceClient : public PrivacyBudgetServiceClientInterface {
   /// The auth token provider cache
   const std::shared_ptr<core::TokenProviderCacheInterface>
       authorization_token_provider_cache_;
+  /// The encoding of the consume budget transaction request bodies.
+  const BudgetRequestEncoding request_encoding_;
 };
 }  // namespace google::scp::pbs
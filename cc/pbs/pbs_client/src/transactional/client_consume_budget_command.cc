@@ -56,9 +56,14 @@ ExecutionResult ClientConsumeBudgetCommand::Begin(
   operation_dispatcher_.Dispatch<AsyncContext<
       ConsumeBudgetTransactionRequest, ConsumeBudgetTransactionResponse>>(
       consume_budget_transaction_context,
-      [pbs_client = pbs_client_](AsyncContext<ConsumeBudgetTransactionRequest,
-                                              ConsumeBudgetTransactionResponse>&
-                                     consume_budget_transaction_context) {
+      [pbs_client = pbs_client_,
+       consume_in_one_request = consume_in_one_request_](
+          AsyncContext<ConsumeBudgetTransactionRequest,
+                       ConsumeBudgetTransactionResponse>&
+              consume_budget_transaction_context) {
+        if (consume_in_one_request) {
+          return pbs_client->ConsumeBudget(consume_budget_transaction_context);
+        }
         return pbs_client->InitiateConsumeBudgetTransaction(
             consume_budget_transaction_context);
       });
@@ -123,6 +128,14 @@ ExecutionResult ClientConsumeBudgetCommand::End(
 ExecutionResult ClientConsumeBudgetCommand::ExecuteTransactionPhase(
     TransactionExecutionPhase transaction_execution_phase,
     TransactionCommandCallback& transaction_phase_callback) noexcept {
+  // The transaction on the privacy budget service has already run all of its
+  // phases in Begin.
+  if (consume_in_one_request_) {
+    auto execution_result = SuccessExecutionResult();
+    transaction_phase_callback(execution_result);
+    return SuccessExecutionResult();
+  }
+
   AsyncContext<TransactionPhaseRequest, TransactionPhaseResponse>
       transaction_phase_context(
           make_shared<TransactionPhaseRequest>(),
@@ -48,6 +48,10 @@ class ClientConsumeBudgetCommand : public core::TransactionCommand {
    * transaction.
    * @param budget_keys The budget keys in the transaction.
    * @param pbs_client The privacy budget service client.
+   * @param consume_in_one_request Whether the budgets are consumed by a single
+   * request in the begin phase, the privacy budget service running the phases
+   * of its transaction itself. The other phases then have nothing left to do,
+   * so an abort cannot give back the budgets consumed.
    */
   ClientConsumeBudgetCommand(
       core::common::Uuid& transaction_id,
@@ -55,7 +59,8 @@ class ClientConsumeBudgetCommand : public core::TransactionCommand {
       std::shared_ptr<std::vector<ConsumeBudgetMetadata>>& budget_keys,
       std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
       std::shared_ptr<PrivacyBudgetServiceClientInterface>& pbs_client,
-      const core::common::Uuid& parent_activity_id)
+      const core::common::Uuid& parent_activity_id,
+      bool consume_in_one_request = false)
       : last_execution_timestamp_(UINT64_MAX),
         transaction_id_(transaction_id),
         transaction_secret_(transaction_secret),
@@ -67,7 +72,8 @@ class ClientConsumeBudgetCommand : public core::TransactionCommand {
                 core::common::RetryStrategyType::Exponential,
                 kClientConsumeBudgetCommandRetryStrategyDelayMs,
                 kClientConsumeBudgetCommandRetryStrategyTotalRetries)),
-        parent_activity_id_(parent_activity_id) {
+        parent_activity_id_(parent_activity_id),
+        consume_in_one_request_(consume_in_one_request) {
     begin = std::bind(&ClientConsumeBudgetCommand::Begin, this,
                       std::placeholders::_1);
     prepare = std::bind(&ClientConsumeBudgetCommand::Prepare, this,
@@ -215,6 +221,8 @@ class ClientConsumeBudgetCommand : public core::TransactionCommand {
   core::common::OperationDispatcher operation_dispatcher_;
   /// The parent activity id.
   core::common::Uuid parent_activity_id_;
+  /// Whether the budgets are consumed by a single request in the begin phase.
+  const bool consume_in_one_request_;
 };
 
 }  // namespace google::scp::pbs
@@ -14,6 +14,7 @@
 
 #include "pbs_transactional_client.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -23,9 +24,11 @@
 #include "core/config_provider/mock/mock_config_provider.h"
 #include "core/http2_client/src/http2_client.h"
 #include "core/interface/authorization_service_interface.h"
+#include "core/interface/configuration_keys.h"
 #include "core/journal_service/mock/mock_journal_service.h"
 #include "core/transaction_manager/mock/mock_transaction_command_serializer.h"
 #include "core/transaction_manager/src/transaction_manager.h"
+#include "pbs/pbs_client/src/error_codes.h"
 #include "pbs/pbs_client/src/pbs_client.h"
 #include "public/cpio/mock/metric_client/mock_metric_client.h"
 
@@ -35,7 +38,9 @@ using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::Byte;
 using google::scp::core::BytesBuffer;
+using google::scp::core::ConfigProviderInterface;
 using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
 using google::scp::core::GetTransactionStatusRequest;
 using google::scp::core::GetTransactionStatusResponse;
 using google::scp::core::HttpClient;
@@ -44,8 +49,10 @@ using google::scp::core::HttpHeaders;
 using google::scp::core::HttpMethod;
 using google::scp::core::HttpRequest;
 using google::scp::core::HttpResponse;
+using google::scp::core::kTransactionManagerCommandDispatchFanOut;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::TokenProviderCacheInterface;
+using google::scp::core::TransactionCommand;
 using google::scp::core::TransactionManager;
 using google::scp::core::TransactionRequest;
 using google::scp::core::TransactionResponse;
@@ -58,11 +65,26 @@ using google::scp::cpio::MockMetricClient;
 using std::bind;
 using std::dynamic_pointer_cast;
 using std::make_shared;
+using std::min;
 using std::shared_ptr;
 using std::string;
 using std::vector;
 using std::placeholders::_1;
 
+namespace {
+// Creates the settings of the transaction manager. Each transaction has one
+// command per coordinator, so a fan-out of two dispatches both coordinators'
+// commands of a phase in parallel.
+shared_ptr<ConfigProviderInterface> CreateTransactionManagerConfigProvider(
+    bool parallel_coordinator_phases) {
+  auto config_provider = make_shared<MockConfigProvider>();
+  if (parallel_coordinator_phases) {
+    config_provider->SetInt(kTransactionManagerCommandDispatchFanOut, 2);
+  }
+  return config_provider;
+}
+}  // namespace
+
 namespace google::scp::pbs {
 PrivacyBudgetServiceTransactionalClient::
     PrivacyBudgetServiceTransactionalClient(
@@ -70,12 +92,19 @@ PrivacyBudgetServiceTransactionalClient::
         const shared_ptr<HttpClientInterface>& http_client,
         const shared_ptr<AsyncExecutorInterface>& async_executor,
         const shared_ptr<TokenProviderCacheInterface>&
-            authorization_token_provider_cache)
-    : PrivacyBudgetServiceTransactionalClient(async_executor, http_client) {
+            authorization_token_provider_cache,
+        BudgetRequestEncoding request_encoding,
+        size_t max_budget_keys_per_request, bool consume_budget_in_one_request)
+    : PrivacyBudgetServiceTransactionalClient(
+          async_executor, http_client,
+          CreateTransactionManagerConfigProvider(
+              /*parallel_coordinator_phases=*/false)) {
   pbs1_client_ = make_shared<PrivacyBudgetServiceClient>(
       reporting_origin, pbs_endpoint, http_client_,
-      authorization_token_provider_cache);
+      authorization_token_provider_cache, request_encoding);
   is_single_coordinator_mode = true;
+  max_budget_keys_per_request_ = max_budget_keys_per_request;
+  consume_budget_in_one_request_ = consume_budget_in_one_request;
 }
 
 PrivacyBudgetServiceTransactionalClient::
@@ -85,28 +114,40 @@ PrivacyBudgetServiceTransactionalClient::
         const shared_ptr<HttpClientInterface>& http_client,
         const shared_ptr<AsyncExecutorInterface>& async_executor,
         const shared_ptr<TokenProviderCacheInterface>& pbs1_auth_token_cache,
-        const shared_ptr<TokenProviderCacheInterface>& pbs2_auth_token_cache)
-    : PrivacyBudgetServiceTransactionalClient(async_executor, http_client) {
+        const shared_ptr<TokenProviderCacheInterface>& pbs2_auth_token_cache,
+        BudgetRequestEncoding request_encoding,
+        bool parallel_coordinator_phases, size_t max_budget_keys_per_request,
+        bool consume_budget_in_one_request)
+    : PrivacyBudgetServiceTransactionalClient(
+          async_executor, http_client,
+          CreateTransactionManagerConfigProvider(parallel_coordinator_phases)) {
   pbs1_client_ = make_shared<PrivacyBudgetServiceClient>(
-      reporting_origin, pbs1_endpoint, http_client_, pbs1_auth_token_cache);
+      reporting_origin, pbs1_endpoint, http_client_, pbs1_auth_token_cache,
+      request_encoding);
   pbs2_client_ = make_shared<PrivacyBudgetServiceClient>(
-      reporting_origin, pbs2_endpoint, http_client_, pbs2_auth_token_cache);
+      reporting_origin, pbs2_endpoint, http_client_, pbs2_auth_token_cache,
+      request_encoding);
   is_single_coordinator_mode = false;
+  max_budget_keys_per_request_ = max_budget_keys_per_request;
+  consume_budget_in_one_request_ = consume_budget_in_one_request;
 }
 
 PrivacyBudgetServiceTransactionalClient::
     PrivacyBudgetServiceTransactionalClient(
         const shared_ptr<AsyncExecutorInterface>& async_executor,
-        const shared_ptr<HttpClientInterface>& http_client)
+        const shared_ptr<HttpClientInterface>& http_client,
+        const shared_ptr<ConfigProviderInterface>& config_provider)
     : is_single_coordinator_mode(false),
       async_executor_(async_executor),
       http_client_(http_client),
       max_concurrent_transactions_(100000),
+      max_budget_keys_per_request_(0),
+      consume_budget_in_one_request_(false),
       transaction_command_serializer_(
           make_shared<MockTransactionCommandSerializer>()),
       journal_service_(make_shared<MockJournalService>()),
       metric_client_(make_shared<MockMetricClient>()),
-      config_provider_(make_shared<MockConfigProvider>()),
+      config_provider_(config_provider),
       transaction_manager_(make_shared<TransactionManager>(
           async_executor_, transaction_command_serializer_, journal_service_,
           remote_transaction_manager_, max_concurrent_transactions_,
@@ -121,6 +162,15 @@ PrivacyBudgetServiceTransactionalClient::
 }
 
 ExecutionResult PrivacyBudgetServiceTransactionalClient::Init() noexcept {
+  // The budgets consumed in one request are not rolled back when another
+  // request of the same transaction fails, so the transaction must have a
+  // single request.
+  if (consume_budget_in_one_request_ &&
+      (!is_single_coordinator_mode || max_budget_keys_per_request_ > 0)) {
+    return FailureExecutionResult(
+        core::errors::SC_PBS_CLIENT_CONSUME_BUDGET_IN_ONE_REQUEST_NOT_ATOMIC);
+  }
+
   auto execution_result = pbs1_client_->Init();
   if (!execution_result.Successful()) {
     return execution_result;
@@ -189,25 +239,52 @@ ExecutionResult PrivacyBudgetServiceTransactionalClient::ConsumeBudget(
   transaction_context.request->transaction_secret =
       consume_budget_transaction_context.request->transaction_secret;
 
-  transaction_context.request->commands.push_back(
-      make_shared<ClientConsumeBudgetCommand>(
-          transaction_context.request->transaction_id,
-          transaction_context.request->transaction_secret,
-          consume_budget_transaction_context.request->budget_keys,
-          async_executor_, pbs1_client_,
-          consume_budget_transaction_context.activity_id));
+  transaction_context.request->commands = GenerateConsumeBudgetCommands(
+      *consume_budget_transaction_context.request,
+      consume_budget_transaction_context.activity_id);
 
-  if (!is_single_coordinator_mode) {
-    transaction_context.request->commands.push_back(
-        make_shared<ClientConsumeBudgetCommand>(
-            transaction_context.request->transaction_id,
-            transaction_context.request->transaction_secret,
-            consume_budget_transaction_context.request->budget_keys,
-            async_executor_, pbs2_client_,
-            consume_budget_transaction_context.activity_id));
+  return transaction_manager_->Execute(transaction_context);
+}
+
+vector<shared_ptr<TransactionCommand>>
+PrivacyBudgetServiceTransactionalClient::GenerateConsumeBudgetCommands(
+    const ConsumeBudgetTransactionRequest& consume_budget_transaction_request,
+    const Uuid& parent_activity_id) noexcept {
+  auto transaction_secret =
+      consume_budget_transaction_request.transaction_secret;
+  auto budget_keys = consume_budget_transaction_request.budget_keys;
+  vector<shared_ptr<vector<ConsumeBudgetMetadata>>> budget_keys_per_request;
+  if (max_budget_keys_per_request_ == 0 || !budget_keys ||
+      budget_keys->size() <= max_budget_keys_per_request_) {
+    budget_keys_per_request.push_back(budget_keys);
+  } else {
+    for (size_t begin = 0; begin < budget_keys->size();
+         begin += max_budget_keys_per_request_) {
+      auto end =
+          min(budget_keys->size(), begin + max_budget_keys_per_request_);
+      budget_keys_per_request.push_back(
+          make_shared<vector<ConsumeBudgetMetadata>>(
+              budget_keys->begin() + begin, budget_keys->begin() + end));
+    }
   }
 
-  return transaction_manager_->Execute(transaction_context);
+  vector<shared_ptr<TransactionCommand>> commands;
+  for (size_t i = 0; i < budget_keys_per_request.size(); ++i) {
+    auto transaction_id =
+        i == 0 ? consume_budget_transaction_request.transaction_id
+               : Uuid::GenerateUuid();
+    commands.push_back(make_shared<ClientConsumeBudgetCommand>(
+        transaction_id, transaction_secret, budget_keys_per_request[i],
+        async_executor_, pbs1_client_, parent_activity_id,
+        consume_budget_in_one_request_));
+    if (!is_single_coordinator_mode) {
+      commands.push_back(make_shared<ClientConsumeBudgetCommand>(
+          transaction_id, transaction_secret, budget_keys_per_request[i],
+          async_executor_, pbs2_client_, parent_activity_id,
+          consume_budget_in_one_request_));
+    }
+  }
+  return commands;
 }
 
 ExecutionResult
@@ -17,6 +17,7 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/interface/async_executor_interface.h"
 #include "core/interface/config_provider_interface.h"
@@ -46,13 +47,25 @@ class PrivacyBudgetServiceTransactionalClient
    * @param http_client
    * @param async_executor
    * @param pbs_auth_token_cache
+   * @param request_encoding
+   * @param max_budget_keys_per_request The max number of budget keys sent in
+   * one request, larger transactions are split into requests of at most as
+   * many keys. Zero does not split.
+   * @param consume_budget_in_one_request Whether each request consumes its
+   * budgets in a single round trip, the coordinator running the phases of the
+   * transaction itself, rather than in one round trip per phase. The budgets
+   * are then not rolled back when another request fails, so Init fails if the
+   * transaction can be split into several requests.
    */
   PrivacyBudgetServiceTransactionalClient(
       const std::string& reporting_origin, const std::string& pbs_endpoint,
       const std::shared_ptr<core::HttpClientInterface>& http_client,
       const std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
       const std::shared_ptr<core::TokenProviderCacheInterface>&
-          authorization_token_provider_cache);
+          authorization_token_provider_cache,
+      BudgetRequestEncoding request_encoding = BudgetRequestEncoding::kJson,
+      size_t max_budget_keys_per_request = 0,
+      bool consume_budget_in_one_request = false);
 
   /**
    * @brief Construct a new Privacy Budget Service Transactional Client object
@@ -64,6 +77,18 @@ class PrivacyBudgetServiceTransactionalClient
    * @param async_executor
    * @param pbs1_auth_token_cache
    * @param pbs2_auth_token_cache
+   * @param request_encoding
+   * @param parallel_coordinator_phases Whether each phase is dispatched to both
+   * coordinators in parallel on the async executor rather than to one after
+   * the other from the thread that completed the previous phase.
+   * @param max_budget_keys_per_request The max number of budget keys sent in
+   * one request, larger transactions are split into requests of at most as
+   * many keys. Zero does not split.
+   * @param consume_budget_in_one_request Whether each request consumes its
+   * budgets in a single round trip, the coordinator running the phases of the
+   * transaction itself, rather than in one round trip per phase. The budgets
+   * consumed on one coordinator are then not rolled back when the other one
+   * fails, so Init fails if this is set.
    */
   PrivacyBudgetServiceTransactionalClient(
       const std::string& reporting_origin, const std::string& pbs1_endpoint,
@@ -73,7 +98,11 @@ class PrivacyBudgetServiceTransactionalClient
       const std::shared_ptr<core::TokenProviderCacheInterface>&
           pbs1_auth_token_cache,
       const std::shared_ptr<core::TokenProviderCacheInterface>&
-          pbs2_auth_token_cache);
+          pbs2_auth_token_cache,
+      BudgetRequestEncoding request_encoding = BudgetRequestEncoding::kJson,
+      bool parallel_coordinator_phases = false,
+      size_t max_budget_keys_per_request = 0,
+      bool consume_budget_in_one_request = false);
 
   core::ExecutionResult Init() noexcept override;
 
@@ -99,7 +128,8 @@ class PrivacyBudgetServiceTransactionalClient
  protected:
   PrivacyBudgetServiceTransactionalClient(
       const std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
-      const std::shared_ptr<core::HttpClientInterface>& http_client);
+      const std::shared_ptr<core::HttpClientInterface>& http_client,
+      const std::shared_ptr<core::ConfigProviderInterface>& config_provider);
 
   void OnConsumeBudgetCallback(
       core::AsyncContext<ConsumeBudgetTransactionRequest,
@@ -108,6 +138,23 @@ class PrivacyBudgetServiceTransactionalClient
       core::AsyncContext<core::TransactionRequest, core::TransactionResponse>&
           transaction_context) noexcept;
 
+  /**
+   * @brief Generates the commands of a consume budget transaction, one per
+   * coordinator and per request of at most max_budget_keys_per_request_ keys.
+   * All the requests are part of the same client transaction, so either all or
+   * none of their budgets are consumed. The first request keeps the id of the
+   * transaction and the next ones get ids of their own, shared by both
+   * coordinators.
+   *
+   * @param consume_budget_transaction_request The consume budget request.
+   * @param parent_activity_id The activity id of the consume budget operation.
+   * @return std::vector<std::shared_ptr<core::TransactionCommand>>
+   */
+  std::vector<std::shared_ptr<core::TransactionCommand>>
+  GenerateConsumeBudgetCommands(
+      const ConsumeBudgetTransactionRequest& consume_budget_transaction_request,
+      const core::common::Uuid& parent_activity_id) noexcept;
+
   /// Indicates whether this is a single coordinator client.
   bool is_single_coordinator_mode;
   /// An instance of the async executor.
@@ -120,6 +167,10 @@ class PrivacyBudgetServiceTransactionalClient
   std::shared_ptr<PrivacyBudgetServiceClientInterface> pbs2_client_;
   /// The max number of concurrent transactions.
   size_t max_concurrent_transactions_;
+  /// The max number of budget keys in one request, zero does not split.
+  size_t max_budget_keys_per_request_;
+  /// Whether each request consumes its budgets in a single round trip.
+  bool consume_budget_in_one_request_;
   /// An instance of the transaction command serializer.
   std::shared_ptr<core::TransactionCommandSerializerInterface>
       transaction_command_serializer_;
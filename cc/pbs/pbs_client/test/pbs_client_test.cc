@@ -29,6 +29,7 @@
 #include "core/interface/authorization_service_interface.h"
 #include "core/token_provider_cache/mock/token_provider_cache_mock.h"
 #include "pbs/front_end_service/src/error_codes.h"
+#include "pbs/front_end_service/src/front_end_utils.h"
 #include "pbs/pbs_client/mock/mock_pbs_client_with_overrides.h"
 #include "pbs/pbs_client/src/error_codes.h"
 #include "public/core/test/interface/execution_result_matchers.h"
@@ -36,6 +37,9 @@
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::AsyncOperation;
+using google::scp::core::BatchGetTransactionStatusRequest;
+using google::scp::core::BatchGetTransactionStatusResponse;
+using google::scp::core::BatchGetTransactionStatusResult;
 using google::scp::core::Byte;
 using google::scp::core::BytesBuffer;
 using google::scp::core::ExecutionResult;
@@ -151,6 +155,8 @@ TEST_F(PBSClientTest, ValidateEndpointUrls) {
             "http://www.pbs_endpoint.com/v1/transactions:end");
   EXPECT_EQ(privacy_budget_service_client.GetTransactionStatusUrl(),
             "http://www.pbs_endpoint.com/v1/transactions:status");
+  EXPECT_EQ(privacy_budget_service_client.GetBatchTransactionStatusUrl(),
+            "http://www.pbs_endpoint.com/v1/transactions:batch-status");
 }
 
 TEST_F(PBSClientTest, InitiateConsumeBudgetTransactionHttpClientFailures) {
@@ -283,6 +289,108 @@ TEST_F(PBSClientTest, InitiateConsumeBudgetTransaction) {
   EXPECT_EQ(is_called, true);
 }
 
+TEST_F(PBSClientTest, InitiateConsumeBudgetTransactionWithProtobufEncoding) {
+  PrivacyBudgetServiceClient privacy_budget_service_client(
+      reporting_origin_, pbs_endpoint_, http_client_,
+      auth_token_provider_cache_, BudgetRequestEncoding::kProtobuf);
+
+  AsyncContext<ConsumeBudgetTransactionRequest,
+               ConsumeBudgetTransactionResponse>
+      consume_budget_transaction_context;
+  consume_budget_transaction_context.request =
+      make_shared<ConsumeBudgetTransactionRequest>();
+  consume_budget_transaction_context.request->transaction_id =
+      Uuid::GenerateUuid();
+  consume_budget_transaction_context.request->transaction_secret =
+      make_shared<string>("This is secret");
+
+  auto budget_keys = make_shared<vector<ConsumeBudgetMetadata>>();
+  ConsumeBudgetMetadata metadata;
+  metadata.budget_key_name = make_shared<string>("test_budget_key");
+  metadata.time_bucket = 1576135250000000000;
+  metadata.token_count = 1;
+  budget_keys->push_back(metadata);
+
+  metadata.budget_key_name = make_shared<string>("test_key");
+  metadata.time_bucket = 1686135250000000000;
+  metadata.token_count = 2;
+  budget_keys->push_back(metadata);
+  consume_budget_transaction_context.request->budget_keys = budget_keys;
+
+  bool is_called = false;
+  mock_http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+        EXPECT_EQ(
+            http_context.request->headers->find(string(kContentTypeHeader))
+                ->second,
+            kProtobufContentType);
+
+        // The front end decodes the same budgets out of the body.
+        vector<ConsumeBudgetMetadata> decoded_budget_keys;
+        EXPECT_SUCCESS(ParseBeginTransactionRequestBody(
+            reporting_origin_, reporting_origin_, http_context.request->headers,
+            http_context.request->body, decoded_budget_keys));
+        EXPECT_EQ(decoded_budget_keys.size(), budget_keys->size());
+        for (size_t i = 0; i < decoded_budget_keys.size(); ++i) {
+          EXPECT_EQ(
+              *decoded_budget_keys[i].budget_key_name,
+              reporting_origin_ + "/" + *(*budget_keys)[i].budget_key_name);
+          EXPECT_EQ(decoded_budget_keys[i].token_count,
+                    (*budget_keys)[i].token_count);
+          EXPECT_EQ(decoded_budget_keys[i].time_bucket,
+                    (*budget_keys)[i].time_bucket);
+        }
+        is_called = true;
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_SUCCESS(privacy_budget_service_client.InitiateConsumeBudgetTransaction(
+      consume_budget_transaction_context));
+  EXPECT_TRUE(is_called);
+}
+
+TEST_F(PBSClientTest, ConsumeBudgetSendsTheBudgetsToTheConsumeBudgetPath) {
+  PrivacyBudgetServiceClient privacy_budget_service_client(
+      reporting_origin_, pbs_endpoint_, http_client_,
+      auth_token_provider_cache_);
+
+  AsyncContext<ConsumeBudgetTransactionRequest,
+               ConsumeBudgetTransactionResponse>
+      consume_budget_transaction_context;
+  consume_budget_transaction_context.request =
+      GetSampleConsumeBudgetTransactionRequest();
+
+  bool is_called = false;
+  mock_http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+        EXPECT_EQ(*http_context.request->path,
+                  pbs_endpoint_ + string(kStatusConsumeBudgetPath));
+        EXPECT_EQ(http_context.request->method, HttpMethod::POST);
+        EXPECT_EQ(
+            http_context.request->headers->find(string(kTransactionIdHeader))
+                ->second,
+            ToString(
+                consume_budget_transaction_context.request->transaction_id));
+        EXPECT_NE(http_context.request->headers->find(
+                      string(kTransactionLastExecutionTimestampHeader)),
+                  http_context.request->headers->end());
+
+        vector<ConsumeBudgetMetadata> decoded_budget_keys;
+        EXPECT_SUCCESS(ParseBeginTransactionRequestBody(
+            reporting_origin_, reporting_origin_, http_context.request->headers,
+            http_context.request->body, decoded_budget_keys));
+        EXPECT_EQ(
+            decoded_budget_keys.size(),
+            consume_budget_transaction_context.request->budget_keys->size());
+        is_called = true;
+        return SuccessExecutionResult();
+      };
+
+  EXPECT_SUCCESS(privacy_budget_service_client.ConsumeBudget(
+      consume_budget_transaction_context));
+  EXPECT_TRUE(is_called);
+}
+
 TEST_F(PBSClientTest, OnInitiateConsumeBudgetTransactionCallbackHttpFailure) {
   MockPrivacyBudgetServiceClientWithOverrides privacy_budget_service_client(
       reporting_origin_, pbs_endpoint_, http_client_,
@@ -833,4 +941,121 @@ TEST_F(PBSClientTest, OnGetTransactionStatusCallback) {
   EXPECT_TRUE(is_called);
 }
 
+TEST_F(PBSClientTest, BatchGetTransactionStatus) {
+  PrivacyBudgetServiceClient privacy_budget_service_client(
+      reporting_origin_, pbs_endpoint_, http_client_,
+      auth_token_provider_cache_);
+
+  AsyncContext<BatchGetTransactionStatusRequest,
+               BatchGetTransactionStatusResponse>
+      batch_context;
+  batch_context.request = make_shared<BatchGetTransactionStatusRequest>();
+  batch_context.request->transaction_origin =
+      make_shared<string>("This is transaction origin");
+  for (int i = 0; i < 2; ++i) {
+    GetTransactionStatusRequest transaction;
+    transaction.transaction_id = Uuid::GenerateUuid();
+    transaction.transaction_secret = make_shared<string>("This is secret");
+    batch_context.request->transactions.push_back(transaction);
+  }
+
+  bool is_called = false;
+  mock_http_client_->perform_request_mock =
+      [&](AsyncContext<HttpRequest, HttpResponse>& http_context) {
+        EXPECT_EQ(http_context.request->method, HttpMethod::POST);
+        EXPECT_EQ(*http_context.request->path,
+                  "http://www.pbs_endpoint.com/v1/transactions:batch-status");
+        EXPECT_EQ(http_context.request->headers
+                      ->find(string(core::kClaimedIdentityHeader))
+                      ->second,
+                  reporting_origin_);
+        EXPECT_EQ(
+            http_context.request->headers->find(kTransactionOriginHeader)
+                ->second,
+            "This is transaction origin");
+
+        BatchGetTransactionStatusRequest request;
+        EXPECT_SUCCESS(
+            FrontEndUtils::DeserializeBatchGetTransactionStatusRequest(
+                http_context.request->body, request));
+        EXPECT_EQ(request.transactions.size(), 2);
+        for (size_t i = 0; i < request.transactions.size(); ++i) {
+          EXPECT_EQ(request.transactions[i].transaction_id,
+                    batch_context.request->transactions[i].transaction_id);
+          EXPECT_EQ(*request.transactions[i].transaction_secret,
+                    "This is secret");
+        }
+        is_called = true;
+        return SuccessExecutionResult();
+      };
+  EXPECT_SUCCESS(
+      privacy_budget_service_client.BatchGetTransactionStatus(batch_context));
+  EXPECT_TRUE(is_called);
+}
+
+TEST_F(PBSClientTest, OnBatchGetTransactionStatusCallback) {
+  MockPrivacyBudgetServiceClientWithOverrides privacy_budget_service_client(
+      reporting_origin_, pbs_endpoint_, http_client_,
+      auth_token_provider_cache_);
+
+  AsyncContext<BatchGetTransactionStatusRequest,
+               BatchGetTransactionStatusResponse>
+      batch_context;
+  batch_context.request = make_shared<BatchGetTransactionStatusRequest>();
+  AsyncContext<HttpRequest, HttpResponse> http_context;
+  auto is_called = false;
+  batch_context.callback =
+      [&](AsyncContext<BatchGetTransactionStatusRequest,
+                       BatchGetTransactionStatusResponse>& batch_context) {
+        EXPECT_THAT(batch_context.result,
+                    ResultIs(FailureExecutionResult(1234)));
+        is_called = true;
+      };
+  http_context.result = FailureExecutionResult(1234);
+  privacy_budget_service_client.OnBatchGetTransactionStatusCallback(
+      batch_context, http_context);
+  EXPECT_TRUE(is_called);
+
+  BatchGetTransactionStatusResponse response;
+  BatchGetTransactionStatusResult found;
+  found.transaction_id = Uuid::GenerateUuid();
+  found.result = SuccessExecutionResult();
+  found.status.has_failure = true;
+  found.status.last_execution_timestamp = 1234512313;
+  found.status.transaction_execution_phase = TransactionExecutionPhase::Notify;
+  response.results.push_back(found);
+  BatchGetTransactionStatusResult not_found;
+  not_found.transaction_id = Uuid::GenerateUuid();
+  not_found.result = FailureExecutionResult(1234);
+  response.results.push_back(not_found);
+
+  http_context.result = SuccessExecutionResult();
+  http_context.response = make_shared<HttpResponse>();
+  EXPECT_SUCCESS(FrontEndUtils::SerializeBatchGetTransactionStatus(
+      response, http_context.response->body));
+
+  is_called = false;
+  batch_context.callback =
+      [&](AsyncContext<BatchGetTransactionStatusRequest,
+                       BatchGetTransactionStatusResponse>& batch_context) {
+        EXPECT_SUCCESS(batch_context.result);
+        EXPECT_EQ(batch_context.response->results.size(), 2);
+        const auto& first = batch_context.response->results[0];
+        EXPECT_EQ(first.transaction_id, found.transaction_id);
+        EXPECT_SUCCESS(first.result);
+        EXPECT_EQ(first.status.is_expired, false);
+        EXPECT_EQ(first.status.has_failure, true);
+        EXPECT_EQ(first.status.last_execution_timestamp, 1234512313);
+        EXPECT_EQ(first.status.transaction_execution_phase,
+                  TransactionExecutionPhase::Notify);
+        const auto& second = batch_context.response->results[1];
+        EXPECT_EQ(second.transaction_id, not_found.transaction_id);
+        EXPECT_THAT(second.result, ResultIs(FailureExecutionResult(1234)));
+        is_called = true;
+      };
+  privacy_budget_service_client.OnBatchGetTransactionStatusCallback(
+      batch_context, http_context);
+  EXPECT_TRUE(is_called);
+}
+
 }  // namespace google::scp::pbs::test
@@ -86,6 +86,68 @@ TEST(PBSClientConsumeBudgetCommandTest, Begin) {
   EXPECT_EQ(is_called, true);
 }
 
+TEST(PBSClientConsumeBudgetCommandTest, ConsumeInOneRequest) {
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+  auto transaction_id = Uuid::GenerateUuid();
+  auto transaction_secret = make_shared<string>("this is secret");
+  auto mock_client = make_shared<MockPrivacyBudgetServiceClient>();
+  shared_ptr<PrivacyBudgetServiceClientInterface> client = mock_client;
+  auto budget_keys = make_shared<vector<ConsumeBudgetMetadata>>();
+  ConsumeBudgetMetadata metadata;
+  metadata.budget_key_name = make_shared<string>("test_budget_key");
+  metadata.time_bucket = 12345;
+  metadata.token_count = 1;
+  budget_keys->push_back(metadata);
+  MockClientConsumeBudgetCommand client_consume_budget_command(
+      transaction_id, transaction_secret, budget_keys, async_executor, client,
+      true /* consume_in_one_request */);
+
+  bool is_called = false;
+  mock_client->initiate_consume_budget_transaction_mock =
+      [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                       ConsumeBudgetTransactionResponse>& context) {
+        ADD_FAILURE() << "The transaction must not be begun.";
+        return SuccessExecutionResult();
+      };
+  mock_client->consume_budget_mock =
+      [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                       ConsumeBudgetTransactionResponse>& context) {
+        EXPECT_EQ(context.request->budget_keys->size(), 1);
+        EXPECT_EQ(context.request->transaction_id, transaction_id);
+        EXPECT_EQ(*context.request->transaction_secret, *transaction_secret);
+        is_called = true;
+        return SuccessExecutionResult();
+      };
+  TransactionCommandCallback callback;
+  EXPECT_EQ(client_consume_budget_command.Begin(callback),
+            SuccessExecutionResult());
+  EXPECT_EQ(is_called, true);
+
+  // The other phases complete without any request.
+  mock_client->execute_transaction_phase_mock =
+      [&](AsyncContext<TransactionPhaseRequest, TransactionPhaseResponse>&
+              context) {
+        ADD_FAILURE() << "No phase must be executed remotely.";
+        return SuccessExecutionResult();
+      };
+  for (auto phase :
+       {TransactionExecutionPhase::Prepare, TransactionExecutionPhase::Commit,
+        TransactionExecutionPhase::Notify, TransactionExecutionPhase::Abort,
+        TransactionExecutionPhase::End}) {
+    is_called = false;
+    TransactionCommandCallback phase_callback =
+        [&](ExecutionResult& execution_result) {
+          EXPECT_SUCCESS(execution_result);
+          is_called = true;
+        };
+    EXPECT_EQ(client_consume_budget_command.ExecuteTransactionPhase(
+                  phase, phase_callback),
+              SuccessExecutionResult());
+    EXPECT_EQ(is_called, true);
+  }
+}
+
 TEST(PBSClientConsumeBudgetCommandTest,
      OnInitiateConsumeBudgetTransactionCallback) {
   auto mock_async_executor = make_shared<MockAsyncExecutor>();
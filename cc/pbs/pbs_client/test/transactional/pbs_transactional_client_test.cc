@@ -0,0 +1,312 @@
+
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "pbs/pbs_client/src/transactional/pbs_transactional_client.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/async_executor/mock/mock_async_executor.h"
+#include "core/common/uuid/src/uuid.h"
+#include "pbs/pbs_client/mock/mock_pbs_client.h"
+#include "pbs/pbs_client/src/error_codes.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::AsyncExecutorInterface;
+using google::scp::core::AsyncOperation;
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::HttpClientInterface;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::Timestamp;
+using google::scp::core::TokenProviderCacheInterface;
+using google::scp::core::TransactionCommand;
+using google::scp::core::TransactionCommandCallback;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::common::Uuid;
+using google::scp::core::test::ResultIs;
+using google::scp::pbs::client::mock::MockPrivacyBudgetServiceClient;
+using std::function;
+using std::make_shared;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace google::scp::pbs::test {
+class PrivacyBudgetServiceTransactionalClientWithOverrides
+    : public PrivacyBudgetServiceTransactionalClient {
+ public:
+  using PrivacyBudgetServiceTransactionalClient::
+      PrivacyBudgetServiceTransactionalClient;
+  using PrivacyBudgetServiceTransactionalClient::GenerateConsumeBudgetCommands;
+
+  void SetClients(
+      const shared_ptr<PrivacyBudgetServiceClientInterface>& pbs1_client,
+      const shared_ptr<PrivacyBudgetServiceClientInterface>& pbs2_client) {
+    pbs1_client_ = pbs1_client;
+    pbs2_client_ = pbs2_client;
+  }
+};
+
+class PBSTransactionalClientTest : public ::testing::Test {
+ protected:
+  PBSTransactionalClientTest()
+      : async_executor_(make_shared<MockAsyncExecutor>()),
+        pbs1_client_(make_shared<MockPrivacyBudgetServiceClient>()),
+        pbs2_client_(make_shared<MockPrivacyBudgetServiceClient>()) {
+    request_.transaction_id = Uuid::GenerateUuid();
+    request_.transaction_secret = make_shared<string>("secret");
+    request_.budget_keys = make_shared<vector<ConsumeBudgetMetadata>>();
+    for (size_t i = 0; i < 5; ++i) {
+      ConsumeBudgetMetadata metadata;
+      metadata.budget_key_name = make_shared<string>("key" + std::to_string(i));
+      metadata.time_bucket = i;
+      metadata.token_count = 1;
+      request_.budget_keys->push_back(metadata);
+    }
+
+    // Records the id and the budget keys of each request.
+    pbs1_client_->initiate_consume_budget_transaction_mock =
+        [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>& context) {
+          pbs1_requests_.push_back({context.request->transaction_id,
+                                    *context.request->budget_keys});
+          return SuccessExecutionResult();
+        };
+    pbs2_client_->initiate_consume_budget_transaction_mock =
+        [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>& context) {
+          pbs2_requests_.push_back({context.request->transaction_id,
+                                    *context.request->budget_keys});
+          return SuccessExecutionResult();
+        };
+  }
+
+  void BeginCommands(vector<shared_ptr<TransactionCommand>>& commands) {
+    TransactionCommandCallback callback = [](ExecutionResult&) {};
+    for (auto& command : commands) {
+      EXPECT_SUCCESS(command->begin(callback));
+    }
+  }
+
+  shared_ptr<AsyncExecutorInterface> async_executor_;
+  shared_ptr<HttpClientInterface> http_client_;
+  shared_ptr<TokenProviderCacheInterface> token_provider_cache_;
+  shared_ptr<MockPrivacyBudgetServiceClient> pbs1_client_;
+  shared_ptr<MockPrivacyBudgetServiceClient> pbs2_client_;
+  ConsumeBudgetTransactionRequest request_;
+  vector<pair<Uuid, vector<ConsumeBudgetMetadata>>> pbs1_requests_;
+  vector<pair<Uuid, vector<ConsumeBudgetMetadata>>> pbs2_requests_;
+};
+
+TEST_F(PBSTransactionalClientTest, GenerateConsumeBudgetCommandsWithoutSplit) {
+  PrivacyBudgetServiceTransactionalClientWithOverrides client(
+      "origin.com", "pbs1", "pbs2", http_client_, async_executor_,
+      token_provider_cache_, token_provider_cache_);
+  client.SetClients(pbs1_client_, pbs2_client_);
+
+  auto commands =
+      client.GenerateConsumeBudgetCommands(request_, Uuid::GenerateUuid());
+  ASSERT_EQ(commands.size(), 2);
+  BeginCommands(commands);
+
+  ASSERT_EQ(pbs1_requests_.size(), 1);
+  EXPECT_EQ(pbs1_requests_[0].first, request_.transaction_id);
+  EXPECT_EQ(pbs1_requests_[0].second.size(), 5);
+  ASSERT_EQ(pbs2_requests_.size(), 1);
+  EXPECT_EQ(pbs2_requests_[0].first, request_.transaction_id);
+  EXPECT_EQ(pbs2_requests_[0].second.size(), 5);
+}
+
+TEST_F(PBSTransactionalClientTest, GenerateConsumeBudgetCommandsSplitsKeys) {
+  PrivacyBudgetServiceTransactionalClientWithOverrides client(
+      "origin.com", "pbs1", "pbs2", http_client_, async_executor_,
+      token_provider_cache_, token_provider_cache_,
+      BudgetRequestEncoding::kJson, /*parallel_coordinator_phases=*/false,
+      /*max_budget_keys_per_request=*/2);
+  client.SetClients(pbs1_client_, pbs2_client_);
+
+  auto commands =
+      client.GenerateConsumeBudgetCommands(request_, Uuid::GenerateUuid());
+  ASSERT_EQ(commands.size(), 6);
+  BeginCommands(commands);
+
+  // The keys keep their order across the requests, and both coordinators get
+  // the same requests.
+  vector<size_t> expected_sizes = {2, 2, 1};
+  ASSERT_EQ(pbs1_requests_.size(), 3);
+  ASSERT_EQ(pbs2_requests_.size(), 3);
+  EXPECT_EQ(pbs1_requests_[0].first, request_.transaction_id);
+  EXPECT_NE(pbs1_requests_[1].first, request_.transaction_id);
+  EXPECT_NE(pbs1_requests_[2].first, request_.transaction_id);
+  EXPECT_NE(pbs1_requests_[1].first, pbs1_requests_[2].first);
+  size_t key_index = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(pbs2_requests_[i].first, pbs1_requests_[i].first);
+    ASSERT_EQ(pbs1_requests_[i].second.size(), expected_sizes[i]);
+    ASSERT_EQ(pbs2_requests_[i].second.size(), expected_sizes[i]);
+    for (size_t j = 0; j < expected_sizes[i]; ++j, ++key_index) {
+      EXPECT_EQ(*pbs1_requests_[i].second[j].budget_key_name,
+                *request_.budget_keys->at(key_index).budget_key_name);
+      EXPECT_EQ(*pbs2_requests_[i].second[j].budget_key_name,
+                *request_.budget_keys->at(key_index).budget_key_name);
+    }
+  }
+}
+
+TEST_F(PBSTransactionalClientTest,
+       GenerateConsumeBudgetCommandsSingleCoordinator) {
+  PrivacyBudgetServiceTransactionalClientWithOverrides client(
+      "origin.com", "pbs1", http_client_, async_executor_,
+      token_provider_cache_, BudgetRequestEncoding::kJson,
+      /*max_budget_keys_per_request=*/4);
+  client.SetClients(pbs1_client_, nullptr);
+
+  auto commands =
+      client.GenerateConsumeBudgetCommands(request_, Uuid::GenerateUuid());
+  ASSERT_EQ(commands.size(), 2);
+  BeginCommands(commands);
+
+  ASSERT_EQ(pbs1_requests_.size(), 2);
+  EXPECT_EQ(pbs1_requests_[0].first, request_.transaction_id);
+  EXPECT_EQ(pbs1_requests_[0].second.size(), 4);
+  EXPECT_EQ(pbs1_requests_[1].second.size(), 1);
+  EXPECT_EQ(pbs2_requests_.size(), 0);
+}
+
+TEST_F(PBSTransactionalClientTest, DispatchesTheCoordinatorPhasesInParallel) {
+  for (bool parallel_coordinator_phases : {false, true}) {
+    // The scheduled tasks are run one at a time by the test.
+    vector<AsyncOperation> scheduled_tasks;
+    auto mock_async_executor = make_shared<MockAsyncExecutor>();
+    mock_async_executor->schedule_mock = [&](const AsyncOperation& work) {
+      scheduled_tasks.push_back(work);
+      return SuccessExecutionResult();
+    };
+    mock_async_executor->schedule_for_mock =
+        [](const AsyncOperation&, Timestamp, function<bool()>&) {
+          return SuccessExecutionResult();
+        };
+
+    PrivacyBudgetServiceTransactionalClientWithOverrides client(
+        "origin.com", "pbs1", "pbs2", http_client_, mock_async_executor,
+        token_provider_cache_, token_provider_cache_,
+        BudgetRequestEncoding::kJson, parallel_coordinator_phases);
+    client.SetClients(pbs1_client_, pbs2_client_);
+
+    // Records the task in which each coordinator begins the transaction.
+    size_t current_task = 0;
+    size_t pbs1_task = 0;
+    size_t pbs2_task = 0;
+    pbs1_client_->initiate_consume_budget_transaction_mock =
+        [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&) {
+          pbs1_task = current_task;
+          return SuccessExecutionResult();
+        };
+    pbs2_client_->initiate_consume_budget_transaction_mock =
+        [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&) {
+          pbs2_task = current_task;
+          return SuccessExecutionResult();
+        };
+
+    EXPECT_SUCCESS(client.Init());
+    EXPECT_SUCCESS(client.Run());
+    AsyncContext<ConsumeBudgetTransactionRequest,
+                 ConsumeBudgetTransactionResponse>
+        consume_budget_context(
+            make_shared<ConsumeBudgetTransactionRequest>(request_),
+            [](auto&) {});
+    EXPECT_SUCCESS(client.ConsumeBudget(consume_budget_context));
+    for (size_t i = 0; i < scheduled_tasks.size(); ++i) {
+      current_task = i + 1;
+      auto task = scheduled_tasks[i];
+      task();
+    }
+
+    ASSERT_NE(pbs1_task, 0);
+    ASSERT_NE(pbs2_task, 0);
+    if (parallel_coordinator_phases) {
+      EXPECT_NE(pbs1_task, pbs2_task);
+    } else {
+      EXPECT_EQ(pbs1_task, pbs2_task);
+    }
+  }
+}
+
+TEST_F(PBSTransactionalClientTest,
+       ConsumeBudgetInOneRequestFailsWithSeveralRequests) {
+  // Otherwise the budgets consumed on a coordinator, or by another request,
+  // stay consumed when the other fails.
+  PrivacyBudgetServiceTransactionalClientWithOverrides two_coordinators(
+      "origin.com", "pbs1", "pbs2", http_client_, async_executor_,
+      token_provider_cache_, token_provider_cache_,
+      BudgetRequestEncoding::kJson, /*parallel_coordinator_phases=*/false,
+      /*max_budget_keys_per_request=*/0,
+      /*consume_budget_in_one_request=*/true);
+  EXPECT_THAT(two_coordinators.Init(),
+              ResultIs(FailureExecutionResult(
+                  core::errors::
+                      SC_PBS_CLIENT_CONSUME_BUDGET_IN_ONE_REQUEST_NOT_ATOMIC)));
+
+  PrivacyBudgetServiceTransactionalClientWithOverrides split_requests(
+      "origin.com", "pbs1", http_client_, async_executor_,
+      token_provider_cache_, BudgetRequestEncoding::kJson,
+      /*max_budget_keys_per_request=*/2,
+      /*consume_budget_in_one_request=*/true);
+  EXPECT_THAT(split_requests.Init(),
+              ResultIs(FailureExecutionResult(
+                  core::errors::
+                      SC_PBS_CLIENT_CONSUME_BUDGET_IN_ONE_REQUEST_NOT_ATOMIC)));
+}
+
+TEST_F(PBSTransactionalClientTest,
+       ConsumeBudgetInOneRequestFailureConsumesNoBudget) {
+  PrivacyBudgetServiceTransactionalClientWithOverrides client(
+      "origin.com", "pbs1", http_client_, async_executor_,
+      token_provider_cache_, BudgetRequestEncoding::kJson,
+      /*max_budget_keys_per_request=*/0,
+      /*consume_budget_in_one_request=*/true);
+  client.SetClients(pbs1_client_, nullptr);
+  size_t consume_budget_count = 0;
+  pbs1_client_->consume_budget_mock =
+      [&](AsyncContext<ConsumeBudgetTransactionRequest,
+                       ConsumeBudgetTransactionResponse>& context) {
+        consume_budget_count++;
+        return FailureExecutionResult(123);
+      };
+
+  // The single request of the transaction fails as a whole.
+  auto commands =
+      client.GenerateConsumeBudgetCommands(request_, Uuid::GenerateUuid());
+  ASSERT_EQ(commands.size(), 1);
+  ExecutionResult begin_result = SuccessExecutionResult();
+  TransactionCommandCallback callback = [&](ExecutionResult& execution_result) {
+    begin_result = execution_result;
+  };
+  EXPECT_SUCCESS(commands[0]->begin(callback));
+  EXPECT_THAT(begin_result, ResultIs(FailureExecutionResult(123)));
+  EXPECT_EQ(consume_budget_count, 1);
+  EXPECT_EQ(pbs1_requests_.size(), 0);
+}
+}  // namespace google::scp::pbs::test
@@ -43,6 +43,7 @@
 #include "opentelemetry/sdk/resource/semantic_conventions.h"
 #include "pbs/authorization/src/aws/aws_http_request_response_auth_interceptor.h"
 #include "pbs/authorization_token_fetcher/src/aws/aws_authorization_token_fetcher.h"
+#include "pbs/consume_budget/src/aws/consume_budget.h"
 #include "pbs/interface/configuration_keys.h"
 #include "pbs/interface/pbs_client_interface.h"
 #include "pbs/pbs_client/src/pbs_client.h"
@@ -190,6 +191,18 @@ ExecutionResult AwsDependencyFactory::ReadConfigurations() {
     metrics_batch_push_enabled_ = false;
   }
 
+  // Optional
+  execution_result = config_provider_->Get(
+      kServiceMetricsBatchAggregation, metrics_batch_aggregation_enabled_);
+  if (!execution_result.Successful()) {
+    // If config of metrics_batch_aggregation_enabled not present, coalesce the
+    // metrics of the same series in batch mode.
+    SCP_INFO(kAwsDependencyProvider, kZeroUuid,
+             "%s flag not specified. Aggregating metrics in batch push mode",
+             kServiceMetricsBatchAggregation);
+    metrics_batch_aggregation_enabled_ = true;
+  }
+
   return SuccessExecutionResult();
 }
 
@@ -249,8 +262,17 @@ AwsDependencyFactory::ConstructNoSQLDatabaseClient(
 std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
 AwsDependencyFactory::ConstructBudgetConsumptionHelper(
     core::AsyncExecutorInterface* async_executor,
-    core::AsyncExecutorInterface* io_async_executor) noexcept {
-  return nullptr;
+    core::AsyncExecutorInterface* io_async_executor,
+    std::shared_ptr<core::MetricRouter> metric_router) noexcept {
+  auto dynamo_db_client =
+      pbs::AwsBudgetConsumptionHelper::MakeDynamoDBClientForProd(
+          *config_provider_);
+  if (!dynamo_db_client.result().Successful()) {
+    return nullptr;
+  }
+  return std::make_unique<pbs::AwsBudgetConsumptionHelper>(
+      config_provider_.get(), async_executor, io_async_executor,
+      std::move(*dynamo_db_client), std::move(metric_router));
 }
 
 unique_ptr<cpio::MetricClientInterface>
@@ -263,6 +285,8 @@ AwsDependencyFactory::ConstructMetricClient(
   auto metric_batching_options = make_shared<MetricBatchingOptions>();
   metric_batching_options->metric_namespace = metrics_namespace_;
   metric_batching_options->enable_batch_recording = metrics_batch_push_enabled_;
+  metric_batching_options->enable_metric_aggregation =
+      metrics_batch_aggregation_enabled_;
 
   return make_unique<AwsMetricClientProvider>(
       metric_client_options, instance_client_provider, async_executor,
@@ -381,10 +405,22 @@ std::unique_ptr<core::MetricRouter> AwsDependencyFactory::ConstructMetricRouter(
 
   opentelemetry::exporter::otlp::OtlpGrpcMetricExporterOptions exporter_options;
   exporter_options.endpoint = exporter_path;
+  exporter_options.compression = GetConfigValue(
+      std::string(core::kOtelExporterOtlpCompressionKey),
+      std::string(core::kOtelExporterOtlpCompressionValue), *config_provider_);
+
+  core::OtlpGrpcAuthedMetricExportQueueOptions queue_options;
+  queue_options.max_queued_exports = GetConfigValue(
+      std::string(core::kOtelMetricExportQueueSizeKey),
+      core::kOtelMetricExportQueueSizeValue, *config_provider_);
+  queue_options.max_export_attempts = GetConfigValue(
+      std::string(core::kOtelMetricExportMaxAttemptsKey),
+      core::kOtelMetricExportMaxAttemptsValue, *config_provider_);
 
   std::unique_ptr<opentelemetry::sdk::metrics::PushMetricExporter>
       metric_exporter = std::make_unique<OtlpGrpcAuthedMetricExporter>(
-          exporter_options, std::move(metric_id_token_authenticator));
+          exporter_options, std::move(metric_id_token_authenticator),
+          queue_options);
 
   return std::make_unique<MetricRouter>(config_provider_, std::move(resource),
                                         std::move(metric_exporter));
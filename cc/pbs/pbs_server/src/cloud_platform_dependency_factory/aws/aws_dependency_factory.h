@@ -68,8 +68,8 @@ class AwsDependencyFactory : public CloudPlatformDependencyFactoryInterface {
   std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
   ConstructBudgetConsumptionHelper(
       google::scp::core::AsyncExecutorInterface* async_executor,
-      google::scp::core::AsyncExecutorInterface* io_async_executor) noexcept
-      override;
+      google::scp::core::AsyncExecutorInterface* io_async_executor,
+      std::shared_ptr<core::MetricRouter> metric_router) noexcept override;
 
   std::unique_ptr<cpio::client_providers::AuthTokenProviderInterface>
   ConstructInstanceAuthorizer(std::shared_ptr<core::HttpClientInterface>
@@ -126,6 +126,7 @@ class AwsDependencyFactory : public CloudPlatformDependencyFactoryInterface {
   std::string remote_coordinator_endpoint_;
   std::string remote_coordinator_auth_gateway_endpoint_;
   bool metrics_batch_push_enabled_ = false;
+  bool metrics_batch_aggregation_enabled_ = true;
 };
 
 }  // namespace google::scp::pbs
@@ -140,7 +140,8 @@ AwsIntegrationTestDependencyFactory::ConstructNoSQLDatabaseClient(
 std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
 AwsIntegrationTestDependencyFactory::ConstructBudgetConsumptionHelper(
     core::AsyncExecutorInterface* async_executor,
-    core::AsyncExecutorInterface* io_async_executor) noexcept {
+    core::AsyncExecutorInterface* io_async_executor,
+    std::shared_ptr<core::MetricRouter> metric_router) noexcept {
   return nullptr;
 }
 
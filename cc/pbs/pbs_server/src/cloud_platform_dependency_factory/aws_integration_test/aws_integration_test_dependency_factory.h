@@ -67,8 +67,8 @@ class AwsIntegrationTestDependencyFactory : public AwsDependencyFactory {
   std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
   ConstructBudgetConsumptionHelper(
       google::scp::core::AsyncExecutorInterface* async_executor,
-      google::scp::core::AsyncExecutorInterface* io_async_executor) noexcept
-      override;
+      google::scp::core::AsyncExecutorInterface* io_async_executor,
+      std::shared_ptr<core::MetricRouter> metric_router) noexcept override;
 
   std::unique_ptr<cpio::client_providers::InstanceClientProviderInterface>
   ConstructInstanceMetadataClient(
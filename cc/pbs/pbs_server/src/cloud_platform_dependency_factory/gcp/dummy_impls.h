@@ -164,6 +164,14 @@ class DummyPBSClient : public PrivacyBudgetServiceClientInterface {
     return core::FailureExecutionResult(SC_UNKNOWN);
   }
 
+  core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept override {
+    // Not required for single coordinator testing
+    return core::FailureExecutionResult(SC_UNKNOWN);
+  }
+
   core::ExecutionResult InitiateConsumeBudgetTransaction(
       core::AsyncContext<ConsumeBudgetTransactionRequest,
                          ConsumeBudgetTransactionResponse>&
@@ -180,6 +188,14 @@ class DummyPBSClient : public PrivacyBudgetServiceClientInterface {
     return core::FailureExecutionResult(SC_UNKNOWN);
   }
 
+  core::ExecutionResult ConsumeBudget(
+      core::AsyncContext<ConsumeBudgetTransactionRequest,
+                         ConsumeBudgetTransactionResponse>&
+          consume_budget_transaction_context) noexcept override {
+    // Not required for single coordinator testing
+    return core::FailureExecutionResult(SC_UNKNOWN);
+  }
+
   std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
 };
 }  // namespace google::scp::pbs
@@ -39,6 +39,7 @@
 #include "cc/cpio/client_providers/interface/metric_client_provider_interface.h"
 #include "cc/cpio/client_providers/metric_client_provider/src/gcp/gcp_metric_client_provider.h"
 #include "cc/pbs/authorization/src/gcp/gcp_http_request_response_auth_interceptor.h"
+#include "cc/pbs/authorization/src/gcp/gcp_id_token_verifier.h"
 #include "cc/pbs/authorization_token_fetcher/src/gcp/gcp_authorization_token_fetcher.h"
 #include "cc/pbs/consume_budget/src/gcp/consume_budget.h"
 #include "cc/pbs/interface/configuration_keys.h"
@@ -95,11 +96,14 @@ static constexpr char kBudgetKeyTablePartitionKeyName[] = "Budget_Key";
 static constexpr char kBudgetKeyTableSortKeyName[] = "Timeframe";
 static constexpr char kPartitionLockTablePartitionKeyName[] = "LockId";
 static constexpr TimeDuration kDefaultMetricBatchTimeDuration = 3000;
+static constexpr char kDefaultIdTokenJwksUri[] =
+    "https://www.googleapis.com/oauth2/v3/certs";
 
 GcpDependencyFactory::GcpDependencyFactory(
     std::shared_ptr<ConfigProviderInterface> config_provider)
     : config_provider_(config_provider),
       metrics_batch_push_enabled_(false),
+      metrics_batch_aggregation_enabled_(true),
       metrics_batch_time_duration_ms_(kDefaultMetricBatchTimeDuration) {}
 
 ExecutionResult GcpDependencyFactory::Init() noexcept {
@@ -131,6 +135,26 @@ ExecutionResult GcpDependencyFactory::ReadConfigurations() {
     return execution_result;
   }
 
+  if (!config_provider_
+           ->Get(kAuthLocalIdTokenVerificationEnabled,
+                 local_id_token_verification_enabled_)
+           .Successful()) {
+    local_id_token_verification_enabled_ = false;
+  }
+  if (local_id_token_verification_enabled_) {
+    execution_result =
+        config_provider_->Get(kAuthIdTokenAudience, id_token_audience_);
+    if (!execution_result.Successful()) {
+      SCP_CRITICAL(kGcpDependencyProvider, kZeroUuid, execution_result,
+                   "Failed to read the ID token audience.");
+      return execution_result;
+    }
+    if (!config_provider_->Get(kAuthIdTokenJwksUri, id_token_jwks_uri_)
+             .Successful()) {
+      id_token_jwks_uri_ = kDefaultIdTokenJwksUri;
+    }
+  }
+
   execution_result =
       config_provider_->Get(kServiceMetricsNamespace, metrics_namespace_);
   if (!execution_result.Successful()) {
@@ -150,6 +174,18 @@ ExecutionResult GcpDependencyFactory::ReadConfigurations() {
     metrics_batch_push_enabled_ = false;
   }
 
+  // Optional
+  execution_result = config_provider_->Get(
+      kServiceMetricsBatchAggregation, metrics_batch_aggregation_enabled_);
+  if (!execution_result.Successful()) {
+    // If config of metrics_batch_aggregation_enabled not present, coalesce the
+    // metrics of the same series in batch mode.
+    SCP_INFO(kGcpDependencyProvider, kZeroUuid,
+             "%s flag not specified. Aggregating metrics in batch push mode",
+             kServiceMetricsBatchAggregation);
+    metrics_batch_aggregation_enabled_ = true;
+  }
+
   execution_result = config_provider_->Get(kServiceMetricsBatchTimeDurationMs,
                                            metrics_batch_time_duration_ms_);
   if (!execution_result.Successful()) {
@@ -161,6 +197,17 @@ ExecutionResult GcpDependencyFactory::ReadConfigurations() {
     metrics_batch_time_duration_ms_ = kDefaultMetricBatchTimeDuration;
   }
 
+  // Optional
+  if (!config_provider_
+           ->Get(kServiceMetricsMaxInFlightRequests,
+                 metrics_max_in_flight_requests_)
+           .Successful()) {
+    SCP_INFO(kGcpDependencyProvider, kZeroUuid,
+             "%s flag not specified. Not limiting the metric pushes in flight",
+             kServiceMetricsMaxInFlightRequests);
+    metrics_max_in_flight_requests_ = 0;
+  }
+
   execution_result =
       config_provider_->Get(kRemotePrivacyBudgetServiceClaimedIdentity,
                             reporting_origin_for_remote_coordinator_);
@@ -240,6 +287,14 @@ std::unique_ptr<AuthorizationProxyInterface>
 GcpDependencyFactory::ConstructAuthorizationProxyClient(
     std::shared_ptr<core::AsyncExecutorInterface> async_executor,
     std::shared_ptr<core::HttpClientInterface> http_client) noexcept {
+  if (local_id_token_verification_enabled_) {
+    return std::make_unique<core::AuthorizationProxy>(
+        auth_service_endpoint_, async_executor, http_client,
+        std::make_unique<GcpHttpRequestResponseAuthInterceptor>(
+            config_provider_,
+            std::make_shared<GcpIdTokenVerifier>(
+                http_client, id_token_jwks_uri_, id_token_audience_)));
+  }
   return std::make_unique<core::AuthorizationProxy>(
       auth_service_endpoint_, async_executor, http_client,
       std::make_unique<GcpHttpRequestResponseAuthInterceptor>(
@@ -290,7 +345,8 @@ GcpDependencyFactory::ConstructNoSQLDatabaseClient(
 std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
 GcpDependencyFactory::ConstructBudgetConsumptionHelper(
     google::scp::core::AsyncExecutorInterface* async_executor,
-    google::scp::core::AsyncExecutorInterface* io_async_executor) noexcept {
+    google::scp::core::AsyncExecutorInterface* io_async_executor,
+    std::shared_ptr<core::MetricRouter> metric_router) noexcept {
   google::scp::core::ExecutionResultOr<
       std::shared_ptr<cloud::spanner::Connection>>
       spanner_connection =
@@ -301,7 +357,7 @@ GcpDependencyFactory::ConstructBudgetConsumptionHelper(
   }
   return std::make_unique<pbs::BudgetConsumptionHelper>(
       config_provider_.get(), async_executor, io_async_executor,
-      std::move(*spanner_connection));
+      std::move(*spanner_connection), std::move(metric_router));
 }
 
 std::unique_ptr<cpio::MetricClientInterface>
@@ -314,8 +370,12 @@ GcpDependencyFactory::ConstructMetricClient(
   auto metric_batching_options = std::make_shared<MetricBatchingOptions>();
   metric_batching_options->metric_namespace = metrics_namespace_;
   metric_batching_options->enable_batch_recording = metrics_batch_push_enabled_;
+  metric_batching_options->enable_metric_aggregation =
+      metrics_batch_aggregation_enabled_;
   metric_batching_options->batch_recording_time_duration =
       std::chrono::milliseconds(metrics_batch_time_duration_ms_);
+  metric_batching_options->max_in_flight_requests =
+      metrics_max_in_flight_requests_;
   return std::make_unique<GcpMetricClientProvider>(
       metric_client_options, instance_client_provider, async_executor,
       metric_batching_options);
@@ -395,10 +455,23 @@ std::unique_ptr<core::MetricRouter> GcpDependencyFactory::ConstructMetricRouter(
     opentelemetry::exporter::otlp::OtlpGrpcMetricExporterOptions
         exporter_options;
     exporter_options.endpoint = exporter_path;
+    exporter_options.compression = GetConfigValue(
+        std::string(core::kOtelExporterOtlpCompressionKey),
+        std::string(core::kOtelExporterOtlpCompressionValue),
+        *config_provider_);
+
+    core::OtlpGrpcAuthedMetricExportQueueOptions queue_options;
+    queue_options.max_queued_exports = GetConfigValue(
+        std::string(core::kOtelMetricExportQueueSizeKey),
+        core::kOtelMetricExportQueueSizeValue, *config_provider_);
+    queue_options.max_export_attempts = GetConfigValue(
+        std::string(core::kOtelMetricExportMaxAttemptsKey),
+        core::kOtelMetricExportMaxAttemptsValue, *config_provider_);
 
     std::unique_ptr<opentelemetry::sdk::metrics::PushMetricExporter> exporter =
         std::make_unique<OtlpGrpcAuthedMetricExporter>(
-            exporter_options, std::move(metric_id_token_authenticator));
+            exporter_options, std::move(metric_id_token_authenticator),
+            queue_options);
 
     return std::make_unique<MetricRouter>(config_provider_, std::move(resource),
                                           std::move(exporter));
@@ -71,8 +71,8 @@ class GcpDependencyFactory : public CloudPlatformDependencyFactoryInterface {
   std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
   ConstructBudgetConsumptionHelper(
       google::scp::core::AsyncExecutorInterface* async_executor,
-      google::scp::core::AsyncExecutorInterface* io_async_executor) noexcept
-      override;
+      google::scp::core::AsyncExecutorInterface* io_async_executor,
+      std::shared_ptr<core::MetricRouter> metric_router) noexcept override;
 
   std::unique_ptr<cpio::client_providers::AuthTokenProviderInterface>
   ConstructInstanceAuthorizer(std::shared_ptr<core::HttpClientInterface>
@@ -119,6 +119,10 @@ class GcpDependencyFactory : public CloudPlatformDependencyFactoryInterface {
   std::string budget_key_table_name_;
   std::string partition_lock_table_name_;
   std::string auth_service_endpoint_;
+  // Whether the ID tokens are authorized locally, and how they are verified.
+  bool local_id_token_verification_enabled_ = false;
+  std::string id_token_audience_;
+  std::string id_token_jwks_uri_;
   std::string alternate_auth_service_endpoint_;
   std::string alternate_cloud_service_region_;
 
@@ -130,7 +134,9 @@ class GcpDependencyFactory : public CloudPlatformDependencyFactoryInterface {
 
   std::string metrics_namespace_;
   bool metrics_batch_push_enabled_;
+  bool metrics_batch_aggregation_enabled_;
   core::TimeDuration metrics_batch_time_duration_ms_;
+  size_t metrics_max_in_flight_requests_ = 0;
 };
 
 }  // namespace google::scp::pbs
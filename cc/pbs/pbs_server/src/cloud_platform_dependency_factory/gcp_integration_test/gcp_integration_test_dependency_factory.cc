@@ -162,7 +162,8 @@ GcpIntegrationTestDependencyFactory::ConstructNoSQLDatabaseClient(
 std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
 GcpIntegrationTestDependencyFactory::ConstructBudgetConsumptionHelper(
     google::scp::core::AsyncExecutorInterface* async_executor,
-    google::scp::core::AsyncExecutorInterface* io_async_executor) noexcept {
+    google::scp::core::AsyncExecutorInterface* io_async_executor,
+    std::shared_ptr<core::MetricRouter> metric_router) noexcept {
   google::scp::core::ExecutionResultOr<
       std::shared_ptr<cloud::spanner::Connection>>
       spanner_connection =
@@ -173,7 +174,7 @@ GcpIntegrationTestDependencyFactory::ConstructBudgetConsumptionHelper(
   }
   return std::make_unique<pbs::BudgetConsumptionHelper>(
       config_provider_.get(), async_executor, io_async_executor,
-      std::move(*spanner_connection));
+      std::move(*spanner_connection), std::move(metric_router));
 }
 
 std::unique_ptr<cpio::MetricClientInterface>
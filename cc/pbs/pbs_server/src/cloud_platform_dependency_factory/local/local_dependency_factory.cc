@@ -133,7 +133,8 @@ LocalDependencyFactory::ConstructNoSQLDatabaseClient(
 std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
 LocalDependencyFactory::ConstructBudgetConsumptionHelper(
     core::AsyncExecutorInterface* async_executor,
-    core::AsyncExecutorInterface* io_async_executor) noexcept {
+    core::AsyncExecutorInterface* io_async_executor,
+    std::shared_ptr<core::MetricRouter> metric_router) noexcept {
   google::scp::core::ExecutionResultOr<
       std::shared_ptr<cloud::spanner::Connection>>
       spanner_connection =
@@ -144,7 +145,7 @@ LocalDependencyFactory::ConstructBudgetConsumptionHelper(
   }
   return std::make_unique<pbs::BudgetConsumptionHelper>(
       config_provider_.get(), async_executor, io_async_executor,
-      std::move(*spanner_connection));
+      std::move(*spanner_connection), std::move(metric_router));
 }
 
 std::unique_ptr<cpio::MetricClientInterface>
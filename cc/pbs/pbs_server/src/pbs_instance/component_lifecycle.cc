@@ -0,0 +1,174 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/pbs_server/src/pbs_instance/component_lifecycle.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cc/core/common/global_logger/src/global_logger.h"
+#include "cc/pbs/pbs_server/src/pbs_instance/error_codes.h"
+#include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance_logging.h"
+
+namespace google::scp::pbs {
+
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::core::common::kZeroUuid;
+using ::google::scp::core::errors::SC_PBS_SERVICE_UNKNOWN_COMPONENT_DEPENDENCY;
+using ::std::chrono::duration_cast;
+using ::std::chrono::milliseconds;
+using ::std::chrono::nanoseconds;
+using ::std::chrono::steady_clock;
+
+ExecutionResult ComponentLifecycle::AddComponent(
+    std::string name, core::ServiceInterface* component,
+    const std::vector<std::string>& dependencies) noexcept {
+  size_t stage = 0;
+  for (const auto& dependency : dependencies) {
+    auto it = std::find_if(components_.begin(), components_.end(),
+                           [&](const Component& registered) {
+                             return registered.name == dependency;
+                           });
+    if (it == components_.end()) {
+      auto execution_result =
+          FailureExecutionResult(SC_PBS_SERVICE_UNKNOWN_COMPONENT_DEPENDENCY);
+      SCP_CRITICAL(kPBSInstance, kZeroUuid, execution_result,
+                   "PBS component '%s' depends on unknown component '%s'",
+                   name.c_str(), dependency.c_str());
+      return execution_result;
+    }
+    stage = std::max(stage, it->stage + 1);
+  }
+
+  stage_count_ = std::max(stage_count_, stage + 1);
+  ComponentStartupTiming timing;
+  timing.name = name;
+  components_.push_back(Component{std::move(name), component, stage, timing});
+  return SuccessExecutionResult();
+}
+
+ExecutionResult ComponentLifecycle::Init() noexcept {
+  return RunPhase(Phase::kInit);
+}
+
+ExecutionResult ComponentLifecycle::Run() noexcept {
+  return RunPhase(Phase::kRun);
+}
+
+ExecutionResult ComponentLifecycle::Stop() noexcept {
+  for (auto it = components_.rbegin(); it != components_.rend(); ++it) {
+    if (auto execution_result = it->service->Stop();
+        !execution_result.Successful()) {
+      SCP_CRITICAL(kPBSInstance, kZeroUuid, execution_result,
+                   "PBS component '%s' failed to stop", it->name.c_str());
+      return execution_result;
+    }
+    SCP_INFO(kPBSInstance, kZeroUuid, "PBS component '%s' successfully stopped",
+             it->name.c_str());
+  }
+  return SuccessExecutionResult();
+}
+
+std::vector<ComponentStartupTiming> ComponentLifecycle::GetStartupTimings()
+    const noexcept {
+  std::vector<ComponentStartupTiming> timings;
+  for (const auto& component : components_) {
+    timings.push_back(component.timing);
+  }
+  return timings;
+}
+
+ExecutionResult ComponentLifecycle::RunPhase(Phase phase) noexcept {
+  const char* phase_name = phase == Phase::kInit ? "init" : "run";
+  auto phase_start_time = steady_clock::now();
+
+  if (!parallel_) {
+    for (auto& component : components_) {
+      RETURN_IF_FAILURE(RunComponentPhase(component, phase));
+    }
+  } else {
+    for (size_t stage = 0; stage < stage_count_; ++stage) {
+      auto stage_start_time = steady_clock::now();
+      std::vector<Component*> stage_components;
+      for (auto& component : components_) {
+        if (component.stage == stage) {
+          stage_components.push_back(&component);
+        }
+      }
+
+      // The first component of the stage is handled on this thread.
+      std::vector<ExecutionResult> results(stage_components.size());
+      std::vector<std::thread> threads;
+      for (size_t i = 1; i < stage_components.size(); ++i) {
+        threads.emplace_back([&, i]() {
+          results[i] = RunComponentPhase(*stage_components[i], phase);
+        });
+      }
+      if (!stage_components.empty()) {
+        results[0] = RunComponentPhase(*stage_components[0], phase);
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+
+      SCP_INFO(kPBSInstance, kZeroUuid,
+               "PBS startup stage %zu (%zu components) %s took %lld ms", stage,
+               stage_components.size(), phase_name,
+               duration_cast<milliseconds>(steady_clock::now() -
+                                           stage_start_time)
+                   .count());
+      for (const auto& result : results) {
+        RETURN_IF_FAILURE(result);
+      }
+    }
+  }
+
+  SCP_INFO(kPBSInstance, kZeroUuid, "PBS components %s took %lld ms",
+           phase_name,
+           duration_cast<milliseconds>(steady_clock::now() - phase_start_time)
+               .count());
+  return SuccessExecutionResult();
+}
+
+ExecutionResult ComponentLifecycle::RunComponentPhase(Component& component,
+                                                      Phase phase) noexcept {
+  auto start_time = steady_clock::now();
+  auto execution_result = phase == Phase::kInit ? component.service->Init()
+                                                : component.service->Run();
+  auto duration = duration_cast<nanoseconds>(steady_clock::now() - start_time);
+  if (phase == Phase::kInit) {
+    component.timing.init_duration = duration;
+  } else {
+    component.timing.run_duration = duration;
+  }
+
+  if (!execution_result.Successful()) {
+    SCP_CRITICAL(kPBSInstance, kZeroUuid, execution_result,
+                 "PBS component '%s' failed to %s", component.name.c_str(),
+                 phase == Phase::kInit ? "initialize" : "run");
+    return execution_result;
+  }
+  SCP_INFO(kPBSInstance, kZeroUuid, "PBS component '%s' %s took %lld ms",
+           component.name.c_str(), phase == Phase::kInit ? "init" : "run",
+           duration_cast<milliseconds>(duration).count());
+  return SuccessExecutionResult();
+}
+
+}  // namespace google::scp::pbs
@@ -0,0 +1,86 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CC_PBS_PBS_SERVER_SRC_PBS_INSTANCE_COMPONENT_LIFECYCLE
+#define CC_PBS_PBS_SERVER_SRC_PBS_INSTANCE_COMPONENT_LIFECYCLE
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "cc/core/interface/service_interface.h"
+#include "cc/public/core/interface/execution_result.h"
+
+namespace google::scp::pbs {
+
+// The time a component took to initialize and to run.
+struct ComponentStartupTiming {
+  std::string name;
+  std::chrono::nanoseconds init_duration{0};
+  std::chrono::nanoseconds run_duration{0};
+};
+
+// Brings up the components of a PBS instance following their dependencies.
+//
+// Components are registered in an order where every component comes after its
+// dependencies, and are grouped in stages: a component is in the stage after
+// the last of its dependencies. Init and Run go through the stages in order
+// and, if parallel, handle the components of a stage concurrently, so that the
+// components doing network I/O to start (e.g. token fetches, database
+// sessions) do not wait on each other. Stop goes through the components one at
+// a time in the reverse order of registration.
+class ComponentLifecycle {
+ public:
+  // @param parallel Whether the components of a stage are handled
+  // concurrently. Otherwise they are handled one at a time in the order of
+  // registration, exactly like a serial bring-up.
+  explicit ComponentLifecycle(bool parallel) : parallel_(parallel) {}
+
+  // Registers a component, which must outlive the lifecycle. Fails if one of
+  // the dependencies is not registered yet.
+  core::ExecutionResult AddComponent(
+      std::string name, core::ServiceInterface* component,
+      const std::vector<std::string>& dependencies = {}) noexcept;
+
+  core::ExecutionResult Init() noexcept;
+  core::ExecutionResult Run() noexcept;
+  core::ExecutionResult Stop() noexcept;
+
+  // The timings of the components, in the order of registration.
+  std::vector<ComponentStartupTiming> GetStartupTimings() const noexcept;
+
+ private:
+  enum class Phase { kInit, kRun };
+
+  struct Component {
+    std::string name;
+    core::ServiceInterface* service;
+    size_t stage;
+    ComponentStartupTiming timing;
+  };
+
+  core::ExecutionResult RunPhase(Phase phase) noexcept;
+
+  // Inits or runs a component and records how long it took.
+  core::ExecutionResult RunComponentPhase(Component& component,
+                                          Phase phase) noexcept;
+
+  const bool parallel_;
+  std::vector<Component> components_;
+  size_t stage_count_ = 0;
+};
+
+}  // namespace google::scp::pbs
+
+#endif  // CC_PBS_PBS_SERVER_SRC_PBS_INSTANCE_COMPONENT_LIFECYCLE
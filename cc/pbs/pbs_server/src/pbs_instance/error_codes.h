@@ -56,4 +56,10 @@ DEFINE_ERROR_CODE(SC_PBS_SERVICE_INITIALIZATION_ERROR, SC_PBS_SERVICE, 0x0008,
                   "The PBS service cannot be initialized.",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
 
+DEFINE_ERROR_CODE(SC_PBS_SERVICE_UNKNOWN_COMPONENT_DEPENDENCY, SC_PBS_SERVICE,
+                  0x0009,
+                  "A PBS component depends on a component that is not "
+                  "registered before it.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
 }  // namespace google::scp::core::errors
@@ -24,6 +24,7 @@
 #include "core/common/uuid/src/uuid.h"
 #include "core/interface/config_provider_interface.h"
 #include "pbs/interface/configuration_keys.h"
+#include "pbs/partition_namespace/src/pbs_consistent_hash_partition_namespace.h"
 #include "pbs/pbs_server/src/pbs_instance/pbs_instance_logging.h"
 #include "public/core/interface/execution_result.h"
 
@@ -33,6 +34,13 @@ namespace google::scp::pbs {
 
 inline constexpr int kDefaultLeaseDurationInSeconds = 10;
 inline constexpr int kDefaultVnodeLeaseDurationInSeconds = 20;
+inline constexpr size_t kDefaultBudgetKeyLoadMaxBatchSize = 1;
+inline constexpr size_t kDefaultBudgetKeyLoadMaxOutstandingBatches = 8;
+inline constexpr size_t kDefaultBlobDiskCacheMaxSizeInBytes = 1ULL << 30;
+inline constexpr size_t kDefaultMemoryGovernorTargetAvailableMemoryInKb =
+    1024 * 1024;
+inline constexpr size_t kDefaultMemoryGovernorShedLoadAvailableMemoryInKb =
+    256 * 1024;
 
 /**
  * PBS Instance Configuration Knobs.
@@ -52,8 +60,35 @@ struct PBSInstanceConfig {
   size_t io_async_executor_thread_pool_size = 2000;
   size_t transaction_manager_capacity = 100000;
   size_t http2server_thread_pool_size = 256;
+  size_t http2_server_listener_count = 1;
+  size_t http2_server_max_concurrent_streams = 10000;
+  size_t http2_server_initial_window_size = 0;
+  size_t http2_server_header_table_size = 0;
   size_t async_executor_thread_pool_size_for_lease_db_requests = 2;
   size_t async_executor_queue_size_for_lease_db_requests = 10000;
+  size_t budget_key_load_max_batch_size = kDefaultBudgetKeyLoadMaxBatchSize;
+  size_t budget_key_load_max_outstanding_batches =
+      kDefaultBudgetKeyLoadMaxOutstandingBatches;
+  /// The blob disk cache is disabled if empty.
+  std::string blob_disk_cache_directory;
+  size_t blob_disk_cache_max_size_in_bytes =
+      kDefaultBlobDiskCacheMaxSizeInBytes;
+  bool lease_refresh_batching_enabled = false;
+  bool load_aware_partition_balancing_enabled = false;
+  bool partition_warm_standby_enabled = false;
+  bool partition_namespace_consistent_hashing_enabled = false;
+  size_t partition_namespace_virtual_node_count =
+      kDefaultPartitionNamespaceVirtualNodeCount;
+  bool parallel_component_startup_enabled = false;
+  bool memory_governor_enabled = false;
+  size_t memory_governor_target_available_memory_in_kb =
+      kDefaultMemoryGovernorTargetAvailableMemoryInKb;
+  size_t memory_governor_shed_load_available_memory_in_kb =
+      kDefaultMemoryGovernorShedLoadAvailableMemoryInKb;
+  bool budget_key_shard_routing_enabled = false;
+  bool async_executor_earliest_deadline_first_enabled = false;
+  size_t control_plane_async_executor_thread_pool_size = 2;
+  size_t control_plane_async_executor_queue_size = 10000;
 
   std::shared_ptr<std::string> journal_bucket_name;
   std::shared_ptr<std::string> journal_partition_name;
@@ -197,10 +232,155 @@ GetPBSInstanceConfigFromConfigProvider(
     return execution_result;
   }
 
+  // The http server binds one listener unless configured.
+  if (!config_provider
+           ->Get(kHttp2ServerListenerCount,
+                 pbs_instance_config.http2_server_listener_count)
+           .Successful()) {
+    pbs_instance_config.http2_server_listener_count = 1;
+  }
+
+  // The HTTP/2 SETTINGS are the defaults unless configured.
+  if (!config_provider
+           ->Get(kHttp2ServerMaxConcurrentStreams,
+                 pbs_instance_config.http2_server_max_concurrent_streams)
+           .Successful()) {
+    pbs_instance_config.http2_server_max_concurrent_streams = 10000;
+  }
+  if (!config_provider
+           ->Get(kHttp2ServerInitialWindowSize,
+                 pbs_instance_config.http2_server_initial_window_size)
+           .Successful()) {
+    pbs_instance_config.http2_server_initial_window_size = 0;
+  }
+  if (!config_provider
+           ->Get(kHttp2ServerHeaderTableSize,
+                 pbs_instance_config.http2_server_header_table_size)
+           .Successful()) {
+    pbs_instance_config.http2_server_header_table_size = 0;
+  }
+
   pbs_instance_config.http2_server_private_key_file_path =
       std::make_shared<std::string>("");
   pbs_instance_config.http2_server_certificate_file_path =
       std::make_shared<std::string>("");
+  // Budget key loads are not batched unless configured.
+  if (!config_provider
+           ->Get(kBudgetKeyLoadMaxBatchSize,
+                 pbs_instance_config.budget_key_load_max_batch_size)
+           .Successful()) {
+    pbs_instance_config.budget_key_load_max_batch_size =
+        kDefaultBudgetKeyLoadMaxBatchSize;
+  }
+  if (!config_provider
+           ->Get(kBudgetKeyLoadMaxOutstandingBatches,
+                 pbs_instance_config.budget_key_load_max_outstanding_batches)
+           .Successful()) {
+    pbs_instance_config.budget_key_load_max_outstanding_batches =
+        kDefaultBudgetKeyLoadMaxOutstandingBatches;
+  }
+  // Blobs are not cached on disk unless configured.
+  if (!config_provider
+           ->Get(kBlobDiskCacheDirectory,
+                 pbs_instance_config.blob_disk_cache_directory)
+           .Successful()) {
+    pbs_instance_config.blob_disk_cache_directory.clear();
+  }
+  if (!config_provider
+           ->Get(kBlobDiskCacheMaxSizeInBytes,
+                 pbs_instance_config.blob_disk_cache_max_size_in_bytes)
+           .Successful()) {
+    pbs_instance_config.blob_disk_cache_max_size_in_bytes =
+        kDefaultBlobDiskCacheMaxSizeInBytes;
+  }
+  // Every lock refreshes its own lease unless configured.
+  if (!config_provider
+           ->Get(kLeaseRefreshBatchingEnabled,
+                 pbs_instance_config.lease_refresh_batching_enabled)
+           .Successful()) {
+    pbs_instance_config.lease_refresh_batching_enabled = false;
+  }
+  // The partitions are balanced by count unless configured.
+  if (!config_provider
+           ->Get(kLoadAwarePartitionBalancingEnabled,
+                 pbs_instance_config.load_aware_partition_balancing_enabled)
+           .Successful()) {
+    pbs_instance_config.load_aware_partition_balancing_enabled = false;
+  }
+  // The partitions are recovered only when taken over unless configured.
+  if (!config_provider
+           ->Get(kPartitionWarmStandbyEnabled,
+                 pbs_instance_config.partition_warm_standby_enabled)
+           .Successful()) {
+    pbs_instance_config.partition_warm_standby_enabled = false;
+  }
+  // Budget keys are mapped by a modulo of the partition count unless
+  // configured.
+  if (!config_provider
+           ->Get(kPartitionNamespaceConsistentHashingEnabled,
+                 pbs_instance_config
+                     .partition_namespace_consistent_hashing_enabled)
+           .Successful()) {
+    pbs_instance_config.partition_namespace_consistent_hashing_enabled = false;
+  }
+  if (!config_provider
+           ->Get(kPartitionNamespaceVirtualNodeCount,
+                 pbs_instance_config.partition_namespace_virtual_node_count)
+           .Successful()) {
+    pbs_instance_config.partition_namespace_virtual_node_count =
+        kDefaultPartitionNamespaceVirtualNodeCount;
+  }
+  // The components are started one at a time unless configured.
+  if (!config_provider
+           ->Get(kParallelComponentStartupEnabled,
+                 pbs_instance_config.parallel_component_startup_enabled)
+           .Successful()) {
+    pbs_instance_config.parallel_component_startup_enabled = false;
+  }
+  // The caches keep their configured sizes unless configured.
+  if (!config_provider
+           ->Get(kMemoryGovernorEnabled,
+                 pbs_instance_config.memory_governor_enabled)
+           .Successful()) {
+    pbs_instance_config.memory_governor_enabled = false;
+  }
+  if (!config_provider
+           ->Get(kMemoryGovernorTargetAvailableMemoryInKb,
+                 pbs_instance_config
+                     .memory_governor_target_available_memory_in_kb)
+           .Successful()) {
+    pbs_instance_config.memory_governor_target_available_memory_in_kb =
+        kDefaultMemoryGovernorTargetAvailableMemoryInKb;
+  }
+  if (!config_provider
+           ->Get(kMemoryGovernorShedLoadAvailableMemoryInKb,
+                 pbs_instance_config
+                     .memory_governor_shed_load_available_memory_in_kb)
+           .Successful()) {
+    pbs_instance_config.memory_governor_shed_load_available_memory_in_kb =
+        kDefaultMemoryGovernorShedLoadAvailableMemoryInKb;
+  }
+  if (!config_provider
+           ->Get(kBudgetKeyShardRoutingEnabled,
+                 pbs_instance_config.budget_key_shard_routing_enabled)
+           .Successful()) {
+    pbs_instance_config.budget_key_shard_routing_enabled = false;
+  }
+  if (!config_provider
+           ->Get(kAsyncExecutorEarliestDeadlineFirstEnabled,
+                 pbs_instance_config
+                     .async_executor_earliest_deadline_first_enabled)
+           .Successful()) {
+    pbs_instance_config.async_executor_earliest_deadline_first_enabled = false;
+  }
+  if (!config_provider
+           ->Get(kControlPlaneAsyncExecutorThreadsCount,
+                 pbs_instance_config
+                     .control_plane_async_executor_thread_pool_size)
+           .Successful()) {
+    pbs_instance_config.control_plane_async_executor_thread_pool_size = 2;
+  }
+
   // If the "use tls" key exists, then the path to the private key and
   // certificate must be valid, non-empty strings. Otherwise, we just assume the
   // default of false for "use tls"
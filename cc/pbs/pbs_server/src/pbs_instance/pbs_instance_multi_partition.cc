@@ -32,6 +32,7 @@
 #include "absl/strings/str_split.h"
 #include "core/async_executor/src/async_executor.h"
 #include "core/authorization_proxy/src/pass_thru_authorization_proxy.h"
+#include "core/blob_storage_provider/src/common/disk_cached_blob_storage_provider.h"
 #include "core/common/concurrent_map/src/error_codes.h"
 #include "core/common/global_logger/src/global_logger.h"
 #include "core/common/time_provider/src/time_provider.h"
@@ -44,9 +45,14 @@
 #include "core/interface/configuration_keys.h"
 #include "core/interface/traffic_forwarder_interface.h"
 #include "core/journal_service/src/journal_service.h"
+#include "core/journal_service/src/journal_utils.h"
 #include "core/lease_manager/src/v2/component_lifecycle_lease_event_sink.h"
 #include "core/lease_manager/src/v2/lease_manager_v2.h"
+#include "core/lease_manager/src/v2/lease_refresh_driver.h"
 #include "core/lease_manager/src/v2/lease_refresher_factory.h"
+#include "core/nosql_database_provider/src/common/batching_nosql_database_provider.h"
+#include "core/os/src/linux/system_resource_info_provider_linux.h"
+#include "core/os/src/memory_governor.h"
 #include "core/tcp_traffic_forwarder/src/tcp_traffic_forwarder_socat.h"
 #include "core/transaction_manager/src/transaction_manager.h"
 #include "pbs/budget_key_provider/src/budget_key_provider.h"
@@ -56,6 +62,7 @@
 #include "pbs/health_service/src/health_service.h"
 #include "pbs/interface/configuration_keys.h"
 #include "pbs/leasable_lock/src/leasable_lock_on_nosql_database.h"
+#include "pbs/leasable_lock/src/leasable_lock_on_nosql_database_batch_refresher.h"
 #include "pbs/partition_lease_event_sink/src/partition_lease_event_sink.h"
 #include "pbs/partition_request_router/src/http_request_route_resolver_for_partition.h"
 #include "pbs/partition_request_router/src/transaction_request_router_for_partition.h"
@@ -83,6 +90,7 @@ using google::scp::core::ConfigProvider;
 using google::scp::core::ConfigProviderInterface;
 using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionResultOr;
+using google::scp::core::ExecutorWaitStrategy;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::Http1CurlClient;
 using google::scp::core::Http2Forwarder;
@@ -104,6 +112,7 @@ using google::scp::core::LeaseEventSinkInterface;
 using google::scp::core::LeaseInfo;
 using google::scp::core::LeaseManagerInterface;
 using google::scp::core::LeaseManagerV2;
+using google::scp::core::LeaseRefreshDriver;
 using google::scp::core::LeaseRefresherFactory;
 using google::scp::core::LeaseReleaseNotificationInterface;
 using google::scp::core::LeaseStatisticsInterface;
@@ -115,20 +124,33 @@ using google::scp::core::PartitionMetadata;
 using google::scp::core::PartitionType;
 using google::scp::core::PassThruAuthorizationProxy;
 using google::scp::core::RemoteTransactionManagerInterface;
+using google::scp::core::ScheduledTaskQueueType;
 using google::scp::core::ServiceInterface;
 using google::scp::core::SuccessExecutionResult;
+using google::scp::core::TaskLoadBalancingScheme;
+using google::scp::core::TaskOrderingPolicy;
 using google::scp::core::TCPTrafficForwarderSocat;
+using google::scp::core::ThreadPlacementPolicy;
 using google::scp::core::TrafficForwarderInterface;
 using google::scp::core::TransactionCommandSerializerInterface;
 using google::scp::core::TransactionManager;
 using google::scp::core::TransactionManagerInterface;
 using google::scp::core::TransactionRequestRouterInterface;
+using google::scp::core::blob_storage_provider::BlobDiskCache;
+using google::scp::core::blob_storage_provider::BlobDiskCacheOptions;
+using google::scp::core::blob_storage_provider::DiskCachedBlobStorageProvider;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::common::RetryStrategyOptions;
 using google::scp::core::common::RetryStrategyType;
 using google::scp::core::common::TimeProvider;
 using google::scp::core::common::ToString;
 using google::scp::core::common::Uuid;
+using google::scp::core::journal_service::kCheckpointBlobNamePrefix;
+using google::scp::core::journal_service::kJournalBlobNamePrefix;
+using google::scp::core::nosql_database_provider::BatchingNoSQLDatabaseProvider;
+using google::scp::core::os::MemoryGovernor;
+using google::scp::core::os::MemoryGovernorOptions;
+using google::scp::core::os::linux::SystemResourceInfoProviderLinux;
 using google::scp::pbs::BudgetKeyProvider;
 using google::scp::pbs::BudgetKeyProviderInterface;
 using google::scp::pbs::CheckpointService;
@@ -136,6 +158,7 @@ using google::scp::pbs::FrontEndService;
 using google::scp::pbs::FrontEndServiceInterface;
 using google::scp::pbs::HealthService;
 using google::scp::pbs::LeasableLockOnNoSQLDatabase;
+using google::scp::pbs::LeasableLockOnNoSQLDatabaseBatchRefresher;
 using google::scp::pbs::RemoteTransactionManager;
 using google::scp::pbs::TransactionCommandSerializer;
 using std::atomic;
@@ -256,12 +279,27 @@ static ExecutionResultOr<vector<Uuid>> GetVirtualNodeIds(
 
 ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
   // Core components
+  // The transactions of the partitions are scheduled with the expiration of
+  // their requests, so under overload the ones that can still make it run
+  // first.
   async_executor_ = make_shared<AsyncExecutor>(
       pbs_instance_config_.async_executor_thread_pool_size,
-      pbs_instance_config_.async_executor_queue_size);
+      pbs_instance_config_.async_executor_queue_size,
+      /*drop_tasks_on_stop=*/false, TaskLoadBalancingScheme::RoundRobinGlobal,
+      ScheduledTaskQueueType::PriorityQueue,
+      ThreadPlacementPolicy::SequentialCpu, /*telemetry=*/nullptr,
+      ExecutorWaitStrategy::Park(),
+      pbs_instance_config_.async_executor_earliest_deadline_first_enabled
+          ? TaskOrderingPolicy::EarliestDeadlineFirst
+          : TaskOrderingPolicy::Fifo);
   io_async_executor_ = make_shared<AsyncExecutor>(
       pbs_instance_config_.io_async_executor_thread_pool_size,
       pbs_instance_config_.io_async_executor_queue_size);
+  if (pbs_instance_config_.control_plane_async_executor_thread_pool_size > 0) {
+    control_plane_async_executor_ = make_shared<AsyncExecutor>(
+        pbs_instance_config_.control_plane_async_executor_thread_pool_size,
+        pbs_instance_config_.control_plane_async_executor_queue_size);
+  }
   http1_client_ =
       make_shared<Http1CurlClient>(async_executor_, io_async_executor_);
   http2_client_ = make_shared<HttpClient>(async_executor_);
@@ -317,6 +355,24 @@ ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
       platform_dependency_factory_->ConstructBlobStorageClient(
           async_executor_, io_async_executor_,
           kDefaultAsyncPriorityForCallbackExecution, AsyncPriority::Urgent);
+  // The journal and checkpoint blobs are never overwritten, so the copies
+  // read by this instance can be kept on disk for the next partition loads.
+  if (!pbs_instance_config_.blob_disk_cache_directory.empty()) {
+    BlobDiskCacheOptions blob_disk_cache_options;
+    blob_disk_cache_options.directory =
+        pbs_instance_config_.blob_disk_cache_directory;
+    blob_disk_cache_options.max_size_bytes =
+        pbs_instance_config_.blob_disk_cache_max_size_in_bytes;
+    blob_disk_cache_options.cacheable_blob_name_prefixes = {
+        kJournalBlobNamePrefix, kCheckpointBlobNamePrefix};
+    auto blob_disk_cache = make_shared<BlobDiskCache>(blob_disk_cache_options);
+    blob_storage_provider_for_journal_service_ =
+        make_shared<DiskCachedBlobStorageProvider>(
+            blob_storage_provider_for_journal_service_, blob_disk_cache);
+    blob_storage_provider_for_checkpoint_service_ =
+        make_shared<DiskCachedBlobStorageProvider>(
+            blob_storage_provider_for_checkpoint_service_, blob_disk_cache);
+  }
   nosql_database_provider_for_background_operations_ =
       platform_dependency_factory_->ConstructNoSQLDatabaseClient(
           async_executor_, io_async_executor_,
@@ -325,6 +381,15 @@ ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
       platform_dependency_factory_->ConstructNoSQLDatabaseClient(
           async_executor_, io_async_executor_,
           kDefaultAsyncPriorityForCallbackExecution, AsyncPriority::High);
+  // The loads of the budget keys missing from memory, e.g. the keys of a batch
+  // consumption, are coalesced into batched reads.
+  if (pbs_instance_config_.budget_key_load_max_batch_size > 1) {
+    nosql_database_provider_for_live_traffic_ =
+        make_shared<BatchingNoSQLDatabaseProvider>(
+            nosql_database_provider_for_live_traffic_,
+            pbs_instance_config_.budget_key_load_max_batch_size,
+            pbs_instance_config_.budget_key_load_max_outstanding_batches);
+  }
   remote_transaction_manager_ =
       make_shared<RemoteTransactionManager>(remote_coordinator_pbs_client_);
 
@@ -332,6 +397,13 @@ ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
   // 1. Partition Lease Manager
   // 2. Virtual Node Lease Manager
   auto lease_refresher_factory = make_shared<LeaseRefresherFactory>();
+  if (pbs_instance_config_.lease_refresh_batching_enabled) {
+    auto lease_refresh_driver = make_shared<LeaseRefreshDriver>(
+        make_shared<LeasableLockOnNoSQLDatabaseBatchRefresher>());
+    lease_refresh_driver_ = lease_refresh_driver;
+    lease_refresher_factory =
+        make_shared<LeaseRefresherFactory>(lease_refresh_driver);
+  }
   auto partition_lease_manager_service =
       make_shared<LeaseManagerV2>(lease_refresher_factory);
   partition_lease_manager_service_ = partition_lease_manager_service;
@@ -341,8 +413,22 @@ ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
                                  {} /* no specific preference */});
   vnode_lease_manager_service_ = vnode_lease_manager_service;
 
+  if (pbs_instance_config_.memory_governor_enabled) {
+    MemoryGovernorOptions memory_governor_options;
+    memory_governor_options.target_available_memory_kb =
+        pbs_instance_config_.memory_governor_target_available_memory_in_kb;
+    memory_governor_options.shed_load_available_memory_kb =
+        pbs_instance_config_.memory_governor_shed_load_available_memory_in_kb;
+    memory_governor_ = make_shared<MemoryGovernor>(
+        make_shared<SystemResourceInfoProviderLinux>(), async_executor_,
+        memory_governor_options);
+  }
+
   // Partition Dependencies
   partition_dependencies_.async_executor = async_executor_;
+  partition_dependencies_.memory_governor = memory_governor_;
+  partition_dependencies_.budget_key_shard_routing_enabled =
+      pbs_instance_config_.budget_key_shard_routing_enabled;
   partition_dependencies_.blob_store_provider =
       blob_storage_provider_for_journal_service_;
   partition_dependencies_.blob_store_provider_for_checkpoints =
@@ -357,25 +443,52 @@ ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
       remote_transaction_manager_;
 
   // Partition
+  // With warm standbys, the partition manager needs the ring of all of the
+  // partitions to pick the ones to keep a standby of.
+  vector<PartitionId> standby_partition_ring;
+  if (pbs_instance_config_.partition_warm_standby_enabled) {
+    standby_partition_ring = partition_ids_;
+  }
   partition_manager_ = make_shared<PBSPartitionManager>(
       partition_dependencies_,
-      pbs_instance_config_.transaction_manager_capacity);
+      pbs_instance_config_.transaction_manager_capacity,
+      move(standby_partition_ring));
   partition_lease_event_sink_ = make_shared<PartitionLeaseEventSink>(
       partition_manager_, async_executor_,
       dynamic_pointer_cast<LeaseReleaseNotificationInterface>(
           partition_lease_manager_service),
       metric_client_, config_provider_,
       pbs_instance_config_.partition_lease_duration_in_seconds);
-  partition_namespace_ = make_shared<PBSPartitionNamespace>(partition_ids_);
+  if (pbs_instance_config_.partition_namespace_consistent_hashing_enabled) {
+    partition_namespace_ = make_shared<PBSConsistentHashPartitionNamespace>(
+        partition_ids_,
+        pbs_instance_config_.partition_namespace_virtual_node_count);
+  } else {
+    partition_namespace_ = make_shared<PBSPartitionNamespace>(partition_ids_);
+  }
 
   // Partition Lease Preference Applier
-  partition_lease_preference_applier_ =
-      make_shared<PartitionLeasePreferenceApplier>(
-          partition_ids_.size(),
-          dynamic_pointer_cast<LeaseStatisticsInterface>(
-              vnode_lease_manager_service),
-          dynamic_pointer_cast<LeaseAcquisitionPreferenceInterface>(
-              partition_lease_manager_service));
+  if (pbs_instance_config_.load_aware_partition_balancing_enabled) {
+    partition_lease_preference_applier_ =
+        make_shared<PartitionLeasePreferenceApplier>(
+            partition_ids_.size(),
+            dynamic_pointer_cast<LeaseStatisticsInterface>(
+                vnode_lease_manager_service),
+            dynamic_pointer_cast<LeaseAcquisitionPreferenceInterface>(
+                partition_lease_manager_service),
+            dynamic_pointer_cast<LeaseStatisticsInterface>(
+                partition_lease_manager_service),
+            dynamic_pointer_cast<PartitionLoadStatisticsInterface>(
+                partition_manager_));
+  } else {
+    partition_lease_preference_applier_ =
+        make_shared<PartitionLeasePreferenceApplier>(
+            partition_ids_.size(),
+            dynamic_pointer_cast<LeaseStatisticsInterface>(
+                vnode_lease_manager_service),
+            dynamic_pointer_cast<LeaseAcquisitionPreferenceInterface>(
+                partition_lease_manager_service));
+  }
   vnode_lease_event_sink_ = make_shared<ComponentLifecycleLeaseEventSink>(
       partition_lease_preference_applier_);
 
@@ -385,15 +498,27 @@ ExecutionResult PBSInstanceMultiPartition::ConstructDependencies() noexcept {
       pbs_instance_config_.http2_server_use_tls,
       pbs_instance_config_.http2_server_private_key_file_path,
       pbs_instance_config_.http2_server_certificate_file_path);
+  http2_server_options.control_plane_async_executor =
+      control_plane_async_executor_;
+  http2_server_options.max_concurrent_streams =
+      pbs_instance_config_.http2_server_max_concurrent_streams;
+  http2_server_options.initial_window_size =
+      pbs_instance_config_.http2_server_initial_window_size;
+  http2_server_options.header_table_size =
+      pbs_instance_config_.http2_server_header_table_size;
   request_router_ = make_shared<Http2Forwarder>(http2_client_for_forwarder_);
   request_route_resolver_ = make_shared<HttpRequestRouteResolverForPartition>(
       partition_namespace_, partition_manager_, config_provider_);
+  // Only the budget requests are spread over several listeners.
+  core::Http2ServerOptions sharded_http2_server_options(http2_server_options);
+  sharded_http2_server_options.listener_count =
+      pbs_instance_config_.http2_server_listener_count;
   http_server_ = make_shared<Http2Server>(
       *pbs_instance_config_.host_address, *pbs_instance_config_.host_port,
       pbs_instance_config_.http2server_thread_pool_size, async_executor_,
       authorization_proxy_, /*aws_authorization_proxy=*/nullptr,
       request_router_, request_route_resolver_, metric_client_,
-      config_provider_, http2_server_options);
+      config_provider_, sharded_http2_server_options);
   health_http_server_ = make_shared<Http2Server>(
       *pbs_instance_config_.host_address, *pbs_instance_config_.health_port,
       1 /* one thread needed */, async_executor_,
@@ -424,7 +549,8 @@ PBSInstanceMultiPartition::CreateLeasableLockForPartition(
   return make_shared<LeasableLockOnNoSQLDatabase>(
       nosql_database_provider_for_leasable_lock_, lease_acquirer_info,
       *pbs_instance_config_.partition_lease_table_name, ToString(partition_id),
-      pbs_instance_config_.partition_lease_duration_in_seconds);
+      pbs_instance_config_.partition_lease_duration_in_seconds,
+      kLeaseRenewalThresholdPercentTimeLeftInLease, async_executor_);
 }
 
 shared_ptr<LeasableLockInterface>
@@ -436,7 +562,8 @@ PBSInstanceMultiPartition::CreateLeasableLockForVNode(
   return make_shared<LeasableLockOnNoSQLDatabase>(
       nosql_database_provider_for_leasable_lock_, lease_acquirer_info,
       *pbs_instance_config_.vnode_lease_table_name, ToString(vnode_id),
-      pbs_instance_config_.vnode_lease_duration_in_seconds);
+      pbs_instance_config_.vnode_lease_duration_in_seconds,
+      kLeaseRenewalThresholdPercentTimeLeftInLease, async_executor_);
 }
 
 ExecutionResult PBSInstanceMultiPartition::Init() noexcept {
@@ -463,6 +590,12 @@ ExecutionResult PBSInstanceMultiPartition::Init() noexcept {
 
   INIT_PBS_COMPONENT(async_executor_);
   INIT_PBS_COMPONENT(io_async_executor_);
+  if (control_plane_async_executor_) {
+    INIT_PBS_COMPONENT(control_plane_async_executor_);
+  }
+  if (memory_governor_) {
+    INIT_PBS_COMPONENT(memory_governor_);
+  }
   INIT_PBS_COMPONENT(http2_client_);
   INIT_PBS_COMPONENT(http2_client_for_forwarder_);
   INIT_PBS_COMPONENT(http1_client_);
@@ -486,6 +619,9 @@ ExecutionResult PBSInstanceMultiPartition::Init() noexcept {
   INIT_PBS_COMPONENT(health_http_server_);
   INIT_PBS_COMPONENT(health_service_);
   INIT_PBS_COMPONENT(partition_lease_event_sink_);
+  if (lease_refresh_driver_) {
+    INIT_PBS_COMPONENT(lease_refresh_driver_);
+  }
   INIT_PBS_COMPONENT(partition_lease_manager_service_);
   INIT_PBS_COMPONENT(vnode_lease_manager_service_);
   INIT_PBS_COMPONENT(partition_lease_preference_applier_);
@@ -499,6 +635,12 @@ ExecutionResult PBSInstanceMultiPartition::Run() noexcept {
 
   RUN_PBS_COMPONENT(async_executor_);
   RUN_PBS_COMPONENT(io_async_executor_);
+  if (control_plane_async_executor_) {
+    RUN_PBS_COMPONENT(control_plane_async_executor_);
+  }
+  if (memory_governor_) {
+    RUN_PBS_COMPONENT(memory_governor_);
+  }
   RUN_PBS_COMPONENT(http2_client_);
   RUN_PBS_COMPONENT(http2_client_for_forwarder_);
   RUN_PBS_COMPONENT(http1_client_);
@@ -521,6 +663,9 @@ ExecutionResult PBSInstanceMultiPartition::Run() noexcept {
   RUN_PBS_COMPONENT(health_http_server_);
   RUN_PBS_COMPONENT(health_service_);
   RUN_PBS_COMPONENT(partition_lease_event_sink_);
+  if (lease_refresh_driver_) {
+    RUN_PBS_COMPONENT(lease_refresh_driver_);
+  }
 
   // Lease Manager
   auto [instance_id, instance_ip] = GetInstanceIDAndIPv4Address();
@@ -575,6 +720,9 @@ ExecutionResult PBSInstanceMultiPartition::Stop() noexcept {
   STOP_PBS_COMPONENT(partition_lease_preference_applier_);
   STOP_PBS_COMPONENT(vnode_lease_manager_service_);
   STOP_PBS_COMPONENT(partition_lease_manager_service_);
+  if (lease_refresh_driver_) {
+    STOP_PBS_COMPONENT(lease_refresh_driver_);
+  }
   STOP_PBS_COMPONENT(partition_lease_event_sink_);
   STOP_PBS_COMPONENT(health_http_server_);
   STOP_PBS_COMPONENT(health_service_);
@@ -597,6 +745,12 @@ ExecutionResult PBSInstanceMultiPartition::Stop() noexcept {
   STOP_PBS_COMPONENT(http1_client_);
   STOP_PBS_COMPONENT(http2_client_);
   STOP_PBS_COMPONENT(http2_client_for_forwarder_);
+  if (memory_governor_) {
+    STOP_PBS_COMPONENT(memory_governor_);
+  }
+  if (control_plane_async_executor_) {
+    STOP_PBS_COMPONENT(control_plane_async_executor_);
+  }
   STOP_PBS_COMPONENT(io_async_executor_);
   STOP_PBS_COMPONENT(async_executor_);
 
@@ -44,6 +44,7 @@
 #include "core/interface/traffic_forwarder_interface.h"
 #include "core/interface/transaction_command_serializer_interface.h"
 #include "core/interface/transaction_manager_interface.h"
+#include "core/os/src/memory_governor.h"
 #include "cpio/client_providers/interface/auth_token_provider_interface.h"
 #include "cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
@@ -58,6 +59,7 @@
 #include "pbs/partition_lease_event_sink/src/partition_lease_event_sink.h"
 #include "pbs/partition_lease_preference_applier/src/partition_lease_preference_applier.h"
 #include "pbs/partition_manager/src/pbs_partition_manager.h"
+#include "pbs/partition_namespace/src/pbs_consistent_hash_partition_namespace.h"
 #include "pbs/partition_namespace/src/pbs_partition_namespace.h"
 #include "pbs/partition_request_router/src/http_request_route_resolver_for_partition.h"
 #include "pbs/partition_request_router/src/transaction_request_router_for_partition.h"
@@ -144,6 +146,11 @@ class PBSInstanceMultiPartition : public core::ServiceInterface {
   // Executors
   std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
   std::shared_ptr<core::AsyncExecutorInterface> io_async_executor_;
+  // Runs the handlers of the control-plane requests, if enabled.
+  std::shared_ptr<core::AsyncExecutorInterface> control_plane_async_executor_;
+
+  // Sizes the partition caches to the available memory, if enabled.
+  std::shared_ptr<core::os::MemoryGovernor> memory_governor_;
 
   // Misc. Clients
   std::shared_ptr<cpio::client_providers::InstanceClientProviderInterface>
@@ -159,6 +166,8 @@ class PBSInstanceMultiPartition : public core::ServiceInterface {
       partition_lease_manager_service_;
   std::shared_ptr<core::LeaseManagerV2Interface> vnode_lease_manager_service_;
   std::shared_ptr<core::LeaseEventSinkInterface> vnode_lease_event_sink_;
+  // Refreshes the leases of both lease managers in batches, if enabled.
+  std::shared_ptr<core::ServiceInterface> lease_refresh_driver_;
 
   // Partition Lease Preference Applier
   std::shared_ptr<PartitionLeasePreferenceApplier>
@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "cc/core/async_executor/src/async_executor.h"
+#include "cc/core/async_executor/src/async_executor_metrics.h"
 #include "cc/core/authorization_proxy/src/pass_thru_authorization_proxy.h"
 #include "cc/core/common/global_logger/src/global_logger.h"
 #include "cc/core/config_provider/src/config_provider.h"
@@ -33,11 +34,16 @@
 #include "cc/pbs/pbs_server/src/pbs_instance/error_codes.h"
 #include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance_configuration.h"
 #include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance_logging.h"
+#include "cc/pbs/profiling_service/src/profiling_service.h"
 #include "cc/public/core/interface/execution_result.h"
 
 namespace google::scp::pbs {
 
 using ::google::scp::core::AsyncExecutor;
+using ::google::scp::core::AsyncExecutorMetrics;
+using ::google::scp::core::ScheduledTaskQueueType;
+using ::google::scp::core::TaskLoadBalancingScheme;
+using ::google::scp::core::ThreadPlacementPolicy;
 using ::google::scp::core::ConfigProvider;
 using ::google::scp::core::ConfigProviderInterface;
 using ::google::scp::core::ExecutionResult;
@@ -51,6 +57,7 @@ using ::google::scp::core::common::kZeroUuid;
 using ::google::scp::core::errors::SC_PBS_SERVICE_INITIALIZATION_ERROR;
 using ::google::scp::pbs::FrontEndServiceV2;
 using ::google::scp::pbs::HealthService;
+using ::google::scp::pbs::ProfilingService;
 
 PBSInstanceV3::PBSInstanceV3(
     std::shared_ptr<core::ConfigProviderInterface> config_provider,
@@ -82,12 +89,26 @@ ExecutionResult PBSInstanceV3::CreateComponents() noexcept {
   }
 
   // Construct foundational components.
+  if (metric_router_) {
+    async_executor_metrics_ = std::make_shared<AsyncExecutorMetrics>(
+        metric_router_.get(), "async_executor");
+    io_async_executor_metrics_ = std::make_shared<AsyncExecutorMetrics>(
+        metric_router_.get(), "io_async_executor");
+    INIT_PBS_COMPONENT(async_executor_metrics_);
+    INIT_PBS_COMPONENT(io_async_executor_metrics_);
+  }
   async_executor_ = std::make_shared<AsyncExecutor>(
       pbs_instance_config_.async_executor_thread_pool_size,
-      pbs_instance_config_.async_executor_queue_size);
+      pbs_instance_config_.async_executor_queue_size,
+      /*drop_tasks_on_stop=*/false, TaskLoadBalancingScheme::RoundRobinGlobal,
+      ScheduledTaskQueueType::PriorityQueue,
+      ThreadPlacementPolicy::SequentialCpu, async_executor_metrics_);
   io_async_executor_ = std::make_shared<AsyncExecutor>(
       pbs_instance_config_.io_async_executor_thread_pool_size,
-      pbs_instance_config_.io_async_executor_queue_size);
+      pbs_instance_config_.io_async_executor_queue_size,
+      /*drop_tasks_on_stop=*/false, TaskLoadBalancingScheme::RoundRobinGlobal,
+      ScheduledTaskQueueType::PriorityQueue,
+      ThreadPlacementPolicy::SequentialCpu, io_async_executor_metrics_);
   http1_client_ =
       std::make_shared<Http1CurlClient>(async_executor_, io_async_executor_);
   http2_client_ = std::make_shared<HttpClient>(
@@ -131,10 +152,14 @@ ExecutionResult PBSInstanceV3::CreateComponents() noexcept {
 
   health_service_ = std::make_shared<HealthService>(
       health_http_server_, config_provider_, async_executor_, metric_client_);
+  // Only serves the profiles when enabled by the config.
+  profiling_service_ = std::make_shared<ProfilingService>(
+      health_http_server_, config_provider_, async_executor_,
+      io_async_executor_);
 
   budget_consumption_helper_ =
       cloud_platform_dependency_factory_->ConstructBudgetConsumptionHelper(
-          async_executor_.get(), io_async_executor_.get());
+          async_executor_.get(), io_async_executor_.get(), metric_router_);
   if (budget_consumption_helper_ == nullptr) {
     SCP_WARNING(kPBSInstance, kZeroUuid,
                 "BudgetConsumptionHelper is unavailable.");
@@ -143,11 +168,59 @@ ExecutionResult PBSInstanceV3::CreateComponents() noexcept {
 
   front_end_service_ = std::make_shared<FrontEndServiceV2>(
       http_server_, async_executor_, metric_client_, config_provider_,
-      budget_consumption_helper_.get());
+      budget_consumption_helper_.get(), /*metric_initialization=*/nullptr,
+      metric_router_);
 
   return SuccessExecutionResult();
 }
 
+ExecutionResult PBSInstanceV3::RegisterComponents() noexcept {
+  component_lifecycle_ = std::make_unique<ComponentLifecycle>(
+      pbs_instance_config_.parallel_component_startup_enabled);
+  auto& lifecycle = *component_lifecycle_;
+  RETURN_IF_FAILURE(
+      lifecycle.AddComponent("async_executor_", async_executor_.get()));
+  RETURN_IF_FAILURE(
+      lifecycle.AddComponent("io_async_executor_", io_async_executor_.get()));
+  RETURN_IF_FAILURE(
+      lifecycle.AddComponent("http1_client_", http1_client_.get(),
+                             {"async_executor_", "io_async_executor_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "http2_client_", http2_client_.get(), {"async_executor_"}));
+  RETURN_IF_FAILURE(
+      lifecycle.AddComponent("authorization_proxy_", authorization_proxy_.get(),
+                             {"async_executor_", "http2_client_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "instance_client_provider_", instance_client_provider_.get(),
+      {"async_executor_", "io_async_executor_", "http1_client_",
+       "http2_client_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "metric_client_", metric_client_.get(),
+      {"async_executor_", "io_async_executor_", "instance_client_provider_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "pass_thru_authorization_proxy_", pass_thru_authorization_proxy_.get()));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "http_server_", http_server_.get(),
+      {"async_executor_", "authorization_proxy_", "metric_client_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "health_http_server_", health_http_server_.get(),
+      {"async_executor_", "pass_thru_authorization_proxy_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "health_service_", health_service_.get(),
+      {"async_executor_", "metric_client_", "health_http_server_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "profiling_service_", profiling_service_.get(),
+      {"async_executor_", "health_http_server_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "budget_consumption_helper_", budget_consumption_helper_.get(),
+      {"async_executor_", "io_async_executor_"}));
+  RETURN_IF_FAILURE(lifecycle.AddComponent(
+      "front_end_service_", front_end_service_.get(),
+      {"async_executor_", "metric_client_", "http_server_",
+       "budget_consumption_helper_"}));
+  return SuccessExecutionResult();
+}
+
 ExecutionResult PBSInstanceV3::Init() noexcept {
   SCP_INFO(kPBSInstance, kZeroUuid, "PBSInstanceV3 attempting to initialize.");
 
@@ -157,20 +230,10 @@ ExecutionResult PBSInstanceV3::Init() noexcept {
   SCP_INFO(kPBSInstance, kZeroUuid, "PBSInstanceV3 constructing dependencies.");
   RETURN_IF_FAILURE(CreateComponents());
 
+  RETURN_IF_FAILURE(RegisterComponents());
+
   SCP_INFO(kPBSInstance, kZeroUuid, "PBSInstanceV3 initializing dependencies.");
-  INIT_PBS_COMPONENT(async_executor_);
-  INIT_PBS_COMPONENT(io_async_executor_);
-  INIT_PBS_COMPONENT(http1_client_);
-  INIT_PBS_COMPONENT(http2_client_);
-  INIT_PBS_COMPONENT(authorization_proxy_);
-  INIT_PBS_COMPONENT(instance_client_provider_);
-  INIT_PBS_COMPONENT(metric_client_);
-  INIT_PBS_COMPONENT(pass_thru_authorization_proxy_);
-  INIT_PBS_COMPONENT(http_server_);
-  INIT_PBS_COMPONENT(health_http_server_);
-  INIT_PBS_COMPONENT(health_service_);
-  INIT_PBS_COMPONENT(budget_consumption_helper_);
-  INIT_PBS_COMPONENT(front_end_service_);
+  RETURN_IF_FAILURE(component_lifecycle_->Init());
 
   SCP_INFO(kPBSInstance, kZeroUuid, "PBSInstanceV3 has been initialized.");
 
@@ -181,19 +244,7 @@ ExecutionResult PBSInstanceV3::Run() noexcept {
   SCP_INFO(kPBSInstance, kZeroUuid,
            "PBSInstanceV3 attempting to run components.");
 
-  RUN_PBS_COMPONENT(async_executor_);
-  RUN_PBS_COMPONENT(io_async_executor_);
-  RUN_PBS_COMPONENT(http1_client_);
-  RUN_PBS_COMPONENT(http2_client_);
-  RUN_PBS_COMPONENT(authorization_proxy_);
-  RUN_PBS_COMPONENT(instance_client_provider_);
-  RUN_PBS_COMPONENT(metric_client_);
-  RUN_PBS_COMPONENT(pass_thru_authorization_proxy_);
-  RUN_PBS_COMPONENT(http_server_);
-  RUN_PBS_COMPONENT(health_http_server_);
-  RUN_PBS_COMPONENT(health_service_);
-  RUN_PBS_COMPONENT(budget_consumption_helper_);
-  RUN_PBS_COMPONENT(front_end_service_);
+  RETURN_IF_FAILURE(component_lifecycle_->Run());
 
   SCP_INFO(kPBSInstance, kZeroUuid, "PBSInstanceV3 components have been run.");
 
@@ -204,19 +255,8 @@ ExecutionResult PBSInstanceV3::Stop() noexcept {
   SCP_INFO(kPBSInstance, kZeroUuid,
            "PBSInstanceV3 attempting to stop components.");
 
-  STOP_PBS_COMPONENT(front_end_service_);
-  STOP_PBS_COMPONENT(budget_consumption_helper_);
-  STOP_PBS_COMPONENT(health_service_);
-  STOP_PBS_COMPONENT(health_http_server_);
-  STOP_PBS_COMPONENT(http_server_);
-  STOP_PBS_COMPONENT(pass_thru_authorization_proxy_);
-  STOP_PBS_COMPONENT(metric_client_);
-  STOP_PBS_COMPONENT(instance_client_provider_);
-  STOP_PBS_COMPONENT(authorization_proxy_);
-  STOP_PBS_COMPONENT(http2_client_);
-  STOP_PBS_COMPONENT(http1_client_);
-  STOP_PBS_COMPONENT(io_async_executor_);
-  STOP_PBS_COMPONENT(async_executor_);
+  // In the reverse order of the registration.
+  RETURN_IF_FAILURE(component_lifecycle_->Stop());
 
   SCP_INFO(kPBSInstance, kZeroUuid, "PBSInstanceV3 components have stopped.");
 
@@ -17,6 +17,7 @@
 
 #include <memory>
 
+#include "cc/core/async_executor/src/async_executor_metrics.h"
 #include "cc/core/interface/async_executor_interface.h"
 #include "cc/core/interface/authorization_proxy_interface.h"
 #include "cc/core/interface/config_provider_interface.h"
@@ -28,6 +29,7 @@
 #include "cc/cpio/client_providers/interface/instance_client_provider_interface.h"
 #include "cc/pbs/interface/cloud_platform_dependency_factory_interface.h"
 #include "cc/pbs/interface/consume_budget_interface.h"
+#include "cc/pbs/pbs_server/src/pbs_instance/component_lifecycle.h"
 #include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance_configuration.h"
 #include "cc/public/core/interface/execution_result.h"
 #include "cc/public/cpio/interface/metric_client/metric_client_interface.h"
@@ -47,6 +49,10 @@ class PBSInstanceV3 : public core::ServiceInterface {
  private:
   core::ExecutionResult CreateComponents() noexcept;
 
+  // Registers the components created by CreateComponents with their
+  // dependencies, in the order they are brought up serially.
+  core::ExecutionResult RegisterComponents() noexcept;
+
   std::shared_ptr<core::ConfigProviderInterface> config_provider_;
 
   std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
@@ -64,6 +70,7 @@ class PBSInstanceV3 : public core::ServiceInterface {
   std::shared_ptr<core::HttpServerInterface> http_server_;
   std::shared_ptr<core::HttpServerInterface> health_http_server_;
   std::shared_ptr<core::ServiceInterface> health_service_;
+  std::shared_ptr<core::ServiceInterface> profiling_service_;
   std::unique_ptr<pbs::BudgetConsumptionHelperInterface>
       budget_consumption_helper_;
   std::shared_ptr<pbs::FrontEndServiceInterface> front_end_service_;
@@ -74,6 +81,12 @@ class PBSInstanceV3 : public core::ServiceInterface {
       cloud_platform_dependency_factory_;
 
   std::shared_ptr<core::MetricRouter> metric_router_;
+  /// Telemetry of the executors, only set when OpenTelemetry is enabled.
+  std::shared_ptr<core::AsyncExecutorMetrics> async_executor_metrics_;
+  std::shared_ptr<core::AsyncExecutorMetrics> io_async_executor_metrics_;
+
+  // Inits, runs and stops the components created by CreateComponents.
+  std::unique_ptr<ComponentLifecycle> component_lifecycle_;
 };
 
 }  // namespace google::scp::pbs
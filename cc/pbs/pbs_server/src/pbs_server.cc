@@ -15,17 +15,21 @@
 #include <sys/wait.h>
 
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "absl/debugging/failure_signal_handler.h"
 #include "absl/log/check.h"
 #include "cc/core/common/global_logger/src/global_logger.h"
 #include "cc/core/config_provider/src/env_config_provider.h"
+#include "cc/core/http2_server/src/http2_server.h"
 #include "cc/core/interface/errors.h"
+#include "cc/core/logger/src/log_providers/async_log_provider.h"
 #include "cc/core/logger/src/log_providers/syslog/syslog_log_provider.h"
 #include "cc/core/logger/src/log_utils.h"
 #include "cc/core/logger/src/logger.h"
@@ -35,6 +39,7 @@
 #include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance.h"
 #include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance_multi_partition_platform_wrapper.h"
 #include "cc/pbs/pbs_server/src/pbs_instance/pbs_instance_v3.h"
+#include "cc/process_launcher/socket_handoff/src/socket_handoff.h"
 #include "cc/public/core/interface/execution_result.h"
 
 #if defined(PBS_GCP)
@@ -56,6 +61,7 @@ using ::google::scp::core::EnvConfigProvider;
 using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::ExecutionResultOr;
 using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::Http2Server;
 using ::google::scp::core::LoggerInterface;
 using ::google::scp::core::LogLevel;
 using ::google::scp::core::ServiceInterface;
@@ -64,8 +70,13 @@ using ::google::scp::core::common::GlobalLogger;
 using ::google::scp::core::common::kZeroUuid;
 using ::google::scp::core::errors::GetErrorMessage;
 using ::google::scp::core::errors::INVALID_ENVIROMENT;
+using ::google::scp::core::logger::AsyncLogOverflowPolicy;
+using ::google::scp::core::logger::AsyncLogProvider;
+using ::google::scp::core::logger::AsyncLogProviderOptions;
 using ::google::scp::core::logger::FromString;
 using ::google::scp::core::logger::Logger;
+using ::google::scp::core::logger::LogProviderInterface;
+using ::google::scp::core::logger::LogRateLimitOptions;
 using ::google::scp::core::logger::log_providers::SyslogLogProvider;
 using ::google::scp::pbs::CloudPlatformDependencyFactoryInterface;
 using ::google::scp::pbs::PBSInstance;
@@ -188,8 +199,53 @@ int main(int argc, char** argv) {
     GlobalLogger::SetGlobalLogLevels(log_levels);
   }
 
-  std::unique_ptr<LoggerInterface> logger_ptr =
-      std::make_unique<Logger>(std::make_unique<SyslogLogProvider>());
+  std::unique_ptr<LogProviderInterface> log_provider =
+      std::make_unique<SyslogLogProvider>();
+  bool async_logging_enabled = false;
+  if (config_provider
+          ->Get(google::scp::pbs::kAsyncLoggingEnabled, async_logging_enabled)
+          .Successful() &&
+      async_logging_enabled) {
+    AsyncLogProviderOptions async_log_options;
+    bool block_on_overflow = false;
+    if (config_provider
+            ->Get(google::scp::pbs::kAsyncLoggingBlockOnOverflow,
+                  block_on_overflow)
+            .Successful() &&
+        block_on_overflow) {
+      async_log_options.overflow_policy = AsyncLogOverflowPolicy::kBlock;
+    }
+    log_provider = std::make_unique<AsyncLogProvider>(std::move(log_provider),
+                                                      async_log_options);
+  }
+
+  LogRateLimitOptions log_rate_limit_options;
+  size_t log_rate_limit_window_in_seconds = 0;
+  if (config_provider
+          ->Get(google::scp::pbs::kLogRateLimitWindowInSeconds,
+                log_rate_limit_window_in_seconds)
+          .Successful() &&
+      log_rate_limit_window_in_seconds > 0) {
+    log_rate_limit_options.window =
+        std::chrono::seconds(log_rate_limit_window_in_seconds);
+  }
+  for (const auto& [log_level, max_messages_key] :
+       {std::pair{LogLevel::kError,
+                  google::scp::pbs::kLogRateLimitMaxErrorMessagesPerWindow},
+        std::pair{LogLevel::kWarning,
+                  google::scp::pbs::kLogRateLimitMaxWarningMessagesPerWindow},
+        std::pair{LogLevel::kInfo,
+                  google::scp::pbs::kLogRateLimitMaxInfoMessagesPerWindow},
+        std::pair{LogLevel::kDebug,
+                  google::scp::pbs::kLogRateLimitMaxDebugMessagesPerWindow}}) {
+    size_t max_messages = 0;
+    if (config_provider->Get(max_messages_key, max_messages).Successful()) {
+      log_rate_limit_options.max_messages_per_window[log_level] = max_messages;
+    }
+  }
+
+  std::unique_ptr<LoggerInterface> logger_ptr = std::make_unique<Logger>(
+      std::move(log_provider), std::move(log_rate_limit_options));
   if (!logger_ptr->Init().Successful()) {
     throw std::runtime_error("Cannot initialize logger.");
   }
@@ -198,6 +254,25 @@ int main(int argc, char** argv) {
   }
   GlobalLogger::SetGlobalLogger(std::move(logger_ptr));
 
+  // A process started by the process launcher with listening ports serves
+  // the sockets of the launcher, which keeps them open across hot restarts.
+  bool has_handoff_socket =
+      std::getenv(
+          google::scp::process_launcher::kHandoffSocketFdEnvironmentVariable) !=
+      nullptr;
+  if (has_handoff_socket) {
+    std::vector<int> listening_sockets;
+    auto execution_result =
+        google::scp::process_launcher::SocketHandoff::ReceiveListeningSockets(
+            listening_sockets);
+    if (!execution_result.Successful()) {
+      SCP_ERROR(kPBSServer, kZeroUuid, execution_result,
+                "Failed to receive the listening sockets.");
+      throw std::runtime_error("Cannot receive the listening sockets.");
+    }
+    Http2Server::SetInheritedListeningSockets(listening_sockets);
+  }
+
   bool pbs_partitioning_enabled = false;
   bool pbs_relaxed_consistency_enabled = false;
   if (config_provider
@@ -227,6 +302,14 @@ int main(int argc, char** argv) {
 
   Init(pbs_instance, "PBS_Instance");
   Run(pbs_instance, "PBS_Instance");
+  if (has_handoff_socket) {
+    auto execution_result =
+        google::scp::process_launcher::SocketHandoff::NotifyReady();
+    if (!execution_result.Successful()) {
+      SCP_ERROR(kPBSServer, kZeroUuid, execution_result,
+                "Failed to notify the process launcher of the readiness.");
+    }
+  }
 
   while (true) {
     std::this_thread::sleep_for(std::chrono::minutes(1));
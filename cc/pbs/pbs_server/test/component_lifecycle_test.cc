@@ -0,0 +1,185 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/pbs_server/src/pbs_instance/component_lifecycle.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cc/pbs/pbs_server/src/pbs_instance/error_codes.h"
+#include "cc/public/core/test/interface/execution_result_matchers.h"
+
+namespace google::scp::pbs {
+namespace {
+
+using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::FailureExecutionResult;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::core::errors::SC_PBS_SERVICE_UNKNOWN_COMPONENT_DEPENDENCY;
+using ::google::scp::core::test::ResultIs;
+
+// Records the order of the calls and how many components are in a call at
+// once.
+class FakeComponent : public core::ServiceInterface {
+ public:
+  FakeComponent(std::string name, std::vector<std::string>& calls,
+                std::mutex& calls_mutex, std::atomic<int>& in_flight,
+                std::atomic<int>& max_in_flight)
+      : name_(std::move(name)),
+        calls_(calls),
+        calls_mutex_(calls_mutex),
+        in_flight_(in_flight),
+        max_in_flight_(max_in_flight) {}
+
+  ExecutionResult Init() noexcept override { return Call("init"); }
+
+  ExecutionResult Run() noexcept override { return Call("run"); }
+
+  ExecutionResult Stop() noexcept override { return Call("stop"); }
+
+  ExecutionResult result_ = SuccessExecutionResult();
+
+ private:
+  ExecutionResult Call(const std::string& phase) {
+    auto in_flight = ++in_flight_;
+    auto max_in_flight = max_in_flight_.load();
+    while (in_flight > max_in_flight &&
+           !max_in_flight_.compare_exchange_weak(max_in_flight, in_flight)) {}
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    {
+      std::unique_lock<std::mutex> lock(calls_mutex_);
+      calls_.push_back(phase + " " + name_);
+    }
+    --in_flight_;
+    return result_;
+  }
+
+  std::string name_;
+  std::vector<std::string>& calls_;
+  std::mutex& calls_mutex_;
+  std::atomic<int>& in_flight_;
+  std::atomic<int>& max_in_flight_;
+};
+
+class ComponentLifecycleTest : public ::testing::Test {
+ protected:
+  FakeComponent MakeComponent(const std::string& name) {
+    return FakeComponent(name, calls_, calls_mutex_, in_flight_,
+                         max_in_flight_);
+  }
+
+  size_t IndexOf(const std::string& call) {
+    for (size_t i = 0; i < calls_.size(); ++i) {
+      if (calls_[i] == call) {
+        return i;
+      }
+    }
+    return calls_.size();
+  }
+
+  std::vector<std::string> calls_;
+  std::mutex calls_mutex_;
+  std::atomic<int> in_flight_ = 0;
+  std::atomic<int> max_in_flight_ = 0;
+};
+
+TEST_F(ComponentLifecycleTest, SerialLifecycleFollowsTheRegistrationOrder) {
+  auto executor = MakeComponent("executor");
+  auto client = MakeComponent("client");
+  auto server = MakeComponent("server");
+  ComponentLifecycle lifecycle(/*parallel=*/false);
+  EXPECT_SUCCESS(lifecycle.AddComponent("executor", &executor));
+  EXPECT_SUCCESS(lifecycle.AddComponent("client", &client));
+  EXPECT_SUCCESS(lifecycle.AddComponent("server", &server));
+
+  EXPECT_SUCCESS(lifecycle.Init());
+  EXPECT_SUCCESS(lifecycle.Run());
+  EXPECT_SUCCESS(lifecycle.Stop());
+
+  EXPECT_EQ(calls_, std::vector<std::string>(
+                        {"init executor", "init client", "init server",
+                         "run executor", "run client", "run server",
+                         "stop server", "stop client", "stop executor"}));
+  EXPECT_EQ(max_in_flight_.load(), 1);
+}
+
+TEST_F(ComponentLifecycleTest, ParallelLifecycleRespectsTheDependencies) {
+  auto executor = MakeComponent("executor");
+  auto client_1 = MakeComponent("client_1");
+  auto client_2 = MakeComponent("client_2");
+  auto server = MakeComponent("server");
+  ComponentLifecycle lifecycle(/*parallel=*/true);
+  EXPECT_SUCCESS(lifecycle.AddComponent("executor", &executor));
+  EXPECT_SUCCESS(lifecycle.AddComponent("client_1", &client_1, {"executor"}));
+  EXPECT_SUCCESS(lifecycle.AddComponent("client_2", &client_2, {"executor"}));
+  EXPECT_SUCCESS(
+      lifecycle.AddComponent("server", &server, {"client_1", "client_2"}));
+
+  EXPECT_SUCCESS(lifecycle.Init());
+  EXPECT_SUCCESS(lifecycle.Run());
+
+  // The two clients only depend on the executor and start together.
+  EXPECT_EQ(max_in_flight_.load(), 2);
+  for (const std::string phase : {"init ", "run "}) {
+    EXPECT_LT(IndexOf(phase + "executor"), IndexOf(phase + "client_1"));
+    EXPECT_LT(IndexOf(phase + "executor"), IndexOf(phase + "client_2"));
+    EXPECT_LT(IndexOf(phase + "client_1"), IndexOf(phase + "server"));
+    EXPECT_LT(IndexOf(phase + "client_2"), IndexOf(phase + "server"));
+  }
+  // Every component is initialized before any is run.
+  EXPECT_LT(IndexOf("init server"), IndexOf("run executor"));
+
+  auto timings = lifecycle.GetStartupTimings();
+  ASSERT_EQ(timings.size(), 4);
+  EXPECT_EQ(timings[0].name, "executor");
+  EXPECT_GE(timings[0].init_duration, std::chrono::milliseconds(50));
+  EXPECT_GE(timings[3].run_duration, std::chrono::milliseconds(50));
+
+  calls_.clear();
+  EXPECT_SUCCESS(lifecycle.Stop());
+  EXPECT_EQ(calls_,
+            std::vector<std::string>({"stop server", "stop client_2",
+                                      "stop client_1", "stop executor"}));
+}
+
+TEST_F(ComponentLifecycleTest, ParallelInitStopsAtTheFailingStage) {
+  auto executor = MakeComponent("executor");
+  auto client = MakeComponent("client");
+  auto server = MakeComponent("server");
+  client.result_ = FailureExecutionResult(1234);
+  ComponentLifecycle lifecycle(/*parallel=*/true);
+  EXPECT_SUCCESS(lifecycle.AddComponent("executor", &executor));
+  EXPECT_SUCCESS(lifecycle.AddComponent("client", &client));
+  EXPECT_SUCCESS(lifecycle.AddComponent("server", &server, {"client"}));
+
+  EXPECT_THAT(lifecycle.Init(), ResultIs(FailureExecutionResult(1234)));
+  EXPECT_EQ(IndexOf("init server"), calls_.size());
+}
+
+TEST_F(ComponentLifecycleTest, UnknownDependencyIsRejected) {
+  auto server = MakeComponent("server");
+  ComponentLifecycle lifecycle(/*parallel=*/true);
+  EXPECT_THAT(lifecycle.AddComponent("server", &server, {"client"}),
+              ResultIs(FailureExecutionResult(
+                  SC_PBS_SERVICE_UNKNOWN_COMPONENT_DEPENDENCY)));
+}
+
+}  // namespace
+}  // namespace google::scp::pbs
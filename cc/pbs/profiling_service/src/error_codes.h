@@ -0,0 +1,52 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "core/interface/errors.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core::errors {
+REGISTER_COMPONENT_CODE(SC_PBS_PROFILING_SERVICE, 0x0911)
+DEFINE_ERROR_CODE(SC_PBS_PROFILING_SERVICE_PROFILER_UNAVAILABLE,
+                  SC_PBS_PROFILING_SERVICE, 0x0001,
+                  "The profiler is not linked into the binary.",
+                  HttpStatusCode::NOT_IMPLEMENTED)
+
+DEFINE_ERROR_CODE(SC_PBS_PROFILING_SERVICE_CPU_PROFILE_IN_PROGRESS,
+                  SC_PBS_PROFILING_SERVICE, 0x0002,
+                  "A CPU profile is already being taken.",
+                  HttpStatusCode::CONFLICT)
+
+DEFINE_ERROR_CODE(SC_PBS_PROFILING_SERVICE_INVALID_PROFILE_DURATION,
+                  SC_PBS_PROFILING_SERVICE, 0x0003,
+                  "The duration of the CPU profile is invalid.",
+                  HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SC_PBS_PROFILING_SERVICE_CANNOT_START_CPU_PROFILER,
+                  SC_PBS_PROFILING_SERVICE, 0x0004,
+                  "The CPU profiler could not be started.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_PBS_PROFILING_SERVICE_CANNOT_READ_CPU_PROFILE,
+                  SC_PBS_PROFILING_SERVICE, 0x0005,
+                  "The CPU profile could not be read.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SC_PBS_PROFILING_SERVICE_HEAP_PROFILER_NOT_RUNNING,
+                  SC_PBS_PROFILING_SERVICE, 0x0006,
+                  "The heap profiler is not running. It is started by setting "
+                  "HEAPPROFILE in the environment of the process.",
+                  HttpStatusCode::PRECONDITION_FAILED)
+}  // namespace google::scp::core::errors
@@ -0,0 +1,315 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "profiling_service.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "core/common/global_logger/src/global_logger.h"
+#include "core/common/time_provider/src/time_provider.h"
+#include "core/common/uuid/src/uuid.h"
+#include "pbs/interface/configuration_keys.h"
+
+#include "error_codes.h"
+
+// The gperftools profilers, resolved only when the library is linked in or
+// preloaded.
+extern "C" {
+int ProfilerStart(const char* fname) __attribute__((weak));
+void ProfilerStop() __attribute__((weak));
+char* GetHeapProfile() __attribute__((weak));
+}
+
+using google::scp::core::AsyncContext;
+using google::scp::core::BytesBuffer;
+using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::HttpHandler;
+using google::scp::core::HttpMethod;
+using google::scp::core::HttpRequest;
+using google::scp::core::HttpResponse;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::common::kZeroUuid;
+using google::scp::core::common::TimeProvider;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_CANNOT_READ_CPU_PROFILE;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_CANNOT_START_CPU_PROFILER;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_CPU_PROFILE_IN_PROGRESS;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_HEAP_PROFILER_NOT_RUNNING;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_INVALID_PROFILE_DURATION;
+using google::scp::core::errors::SC_PBS_PROFILING_SERVICE_PROFILER_UNAVAILABLE;
+using std::bind;
+using std::ifstream;
+using std::string;
+using std::stringstream;
+using std::placeholders::_1;
+
+static constexpr char kServiceName[] = "ProfilingService";
+static constexpr char kCpuProfilePath[] = "/debug/pprof/profile";
+static constexpr char kHeapProfilePath[] = "/debug/pprof/heap";
+static constexpr char kTaskTagStatsPath[] = "/debug/executor/tags";
+static constexpr char kCpuProfileDurationQueryParameter[] = "seconds";
+// The defaults of pprof.
+static constexpr size_t kDefaultCpuProfileDurationInSeconds = 30;
+static constexpr size_t kDefaultMaxCpuProfileDurationInSeconds = 300;
+
+namespace google::scp::pbs {
+
+ExecutionResult ProfilingService::Init() noexcept {
+  bool is_enabled = false;
+  if (!config_provider_->Get(kPBSProfilingServiceEnabled, is_enabled)
+           .Successful() ||
+      !is_enabled) {
+    SCP_INFO(kServiceName, kZeroUuid, "Profiling endpoints are disabled.");
+    return SuccessExecutionResult();
+  }
+
+  if (!config_provider_
+           ->Get(kPBSProfilingServiceMaxCpuProfileDurationInSeconds,
+                 max_cpu_profile_duration_in_seconds_)
+           .Successful()) {
+    max_cpu_profile_duration_in_seconds_ =
+        kDefaultMaxCpuProfileDurationInSeconds;
+  }
+
+  HttpHandler cpu_profile_handler =
+      bind(&ProfilingService::ServeCpuProfile, this, _1);
+  string cpu_profile_path(kCpuProfilePath);
+  RETURN_IF_FAILURE(http_server_->RegisterResourceHandler(
+      HttpMethod::GET, cpu_profile_path, cpu_profile_handler));
+
+  HttpHandler heap_profile_handler =
+      bind(&ProfilingService::ServeHeapProfile, this, _1);
+  string heap_profile_path(kHeapProfilePath);
+  RETURN_IF_FAILURE(http_server_->RegisterResourceHandler(
+      HttpMethod::GET, heap_profile_path, heap_profile_handler));
+
+  HttpHandler task_tag_stats_handler =
+      bind(&ProfilingService::ServeTaskTagStats, this, _1);
+  string task_tag_stats_path(kTaskTagStatsPath);
+  RETURN_IF_FAILURE(http_server_->RegisterResourceHandler(
+      HttpMethod::GET, task_tag_stats_path, task_tag_stats_handler));
+
+  SCP_INFO(kServiceName, kZeroUuid,
+           "Serving profiles on %s, %s and %s. CPU profiler available: %d",
+           kCpuProfilePath, kHeapProfilePath, kTaskTagStatsPath,
+           IsCpuProfilerAvailable());
+  return SuccessExecutionResult();
+}
+
+ExecutionResult ProfilingService::Run() noexcept {
+  return SuccessExecutionResult();
+}
+
+ExecutionResult ProfilingService::Stop() noexcept {
+  return SuccessExecutionResult();
+}
+
+ExecutionResultOr<size_t> ProfilingService::GetCpuProfileDurationInSeconds(
+    const HttpRequest& http_request) noexcept {
+  size_t duration_in_seconds = kDefaultCpuProfileDurationInSeconds;
+  if (http_request.query && !http_request.query->empty()) {
+    for (absl::string_view query_part :
+         absl::StrSplit(*http_request.query, "&")) {
+      std::pair<absl::string_view, absl::string_view> name_and_value =
+          absl::StrSplit(query_part, absl::MaxSplits("=", 1));
+      if (name_and_value.first != kCpuProfileDurationQueryParameter) {
+        continue;
+      }
+      if (!absl::SimpleAtoi(name_and_value.second, &duration_in_seconds)) {
+        return FailureExecutionResult(
+            SC_PBS_PROFILING_SERVICE_INVALID_PROFILE_DURATION);
+      }
+    }
+  }
+
+  if (duration_in_seconds == 0 ||
+      duration_in_seconds > max_cpu_profile_duration_in_seconds_) {
+    return FailureExecutionResult(
+        SC_PBS_PROFILING_SERVICE_INVALID_PROFILE_DURATION);
+  }
+  return duration_in_seconds;
+}
+
+ExecutionResult ProfilingService::ServeCpuProfile(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  if (!IsCpuProfilerAvailable()) {
+    http_context.result =
+        FailureExecutionResult(SC_PBS_PROFILING_SERVICE_PROFILER_UNAVAILABLE);
+    http_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  auto duration_in_seconds =
+      GetCpuProfileDurationInSeconds(*http_context.request);
+  if (!duration_in_seconds.Successful()) {
+    http_context.result = duration_in_seconds.result();
+    http_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  bool is_cpu_profiling = false;
+  if (!is_cpu_profiling_.compare_exchange_strong(is_cpu_profiling, true)) {
+    http_context.result = FailureExecutionResult(
+        SC_PBS_PROFILING_SERVICE_CPU_PROFILE_IN_PROGRESS);
+    http_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  auto profile_path =
+      (std::filesystem::temp_directory_path() /
+       absl::StrCat("pbs_cpu_profile_", getpid(), ".prof"))
+          .string();
+  if (!StartCpuProfiler(profile_path)) {
+    is_cpu_profiling_ = false;
+    http_context.result = FailureExecutionResult(
+        SC_PBS_PROFILING_SERVICE_CANNOT_START_CPU_PROFILER);
+    http_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  SCP_INFO_CONTEXT(kServiceName, http_context,
+                   "Profiling the CPU for %zu seconds.", *duration_in_seconds);
+  auto profile_end_time = (TimeProvider::GetSteadyTimestampInNanoseconds() +
+                           std::chrono::seconds(*duration_in_seconds))
+                              .count();
+  auto execution_result = async_executor_->ScheduleFor(
+      [this, http_context, profile_path]() mutable {
+        OnCpuProfileDurationElapsed(http_context, profile_path);
+      },
+      profile_end_time);
+  if (!execution_result.Successful()) {
+    StopCpuProfiler();
+    std::filesystem::remove(profile_path);
+    is_cpu_profiling_ = false;
+    http_context.result = execution_result;
+    http_context.Finish();
+  }
+  return SuccessExecutionResult();
+}
+
+void ProfilingService::OnCpuProfileDurationElapsed(
+    AsyncContext<HttpRequest, HttpResponse>& http_context,
+    const string& profile_path) noexcept {
+  StopCpuProfiler();
+
+  ifstream profile_stream(profile_path, std::ios::binary);
+  bool is_read = profile_stream.is_open();
+  stringstream profile;
+  if (is_read) {
+    profile << profile_stream.rdbuf();
+    profile_stream.close();
+  }
+  std::error_code error_code;
+  std::filesystem::remove(profile_path, error_code);
+  is_cpu_profiling_ = false;
+
+  if (!is_read) {
+    http_context.result = FailureExecutionResult(
+        SC_PBS_PROFILING_SERVICE_CANNOT_READ_CPU_PROFILE);
+    SCP_ERROR_CONTEXT(kServiceName, http_context, http_context.result,
+                      "Cannot read the CPU profile at '%s'",
+                      profile_path.c_str());
+    http_context.Finish();
+    return;
+  }
+
+  http_context.response->body = BytesBuffer(profile.str());
+  http_context.result = SuccessExecutionResult();
+  http_context.Finish();
+}
+
+ExecutionResult ProfilingService::ServeHeapProfile(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  auto heap_profile = CollectHeapProfile();
+  if (!heap_profile.Successful()) {
+    http_context.result = heap_profile.result();
+    http_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  http_context.response->body = BytesBuffer(*heap_profile);
+  http_context.result = SuccessExecutionResult();
+  http_context.Finish();
+  return SuccessExecutionResult();
+}
+
+ExecutionResult ProfilingService::ServeTaskTagStats(
+    AsyncContext<HttpRequest, HttpResponse>& http_context) noexcept {
+  string body = "executor\tcomponent\toperation\ttask_count\tcpu_seconds\n";
+  for (const auto& [executor_name, executor] :
+       {std::make_pair("async_executor", async_executor_.get()),
+        std::make_pair("io_async_executor", io_async_executor_.get())}) {
+    if (executor == nullptr) {
+      continue;
+    }
+    for (const auto& stats : executor->GetTaskTagStats()) {
+      absl::StrAppend(
+          &body, executor_name, "\t", stats.component, "\t", stats.operation,
+          "\t", stats.task_count, "\t",
+          std::chrono::duration<double>(stats.cpu_time).count(), "\n");
+    }
+  }
+
+  http_context.response->body = BytesBuffer(body);
+  http_context.result = SuccessExecutionResult();
+  http_context.Finish();
+  return SuccessExecutionResult();
+}
+
+bool ProfilingService::IsCpuProfilerAvailable() noexcept {
+  return ProfilerStart != nullptr && ProfilerStop != nullptr;
+}
+
+bool ProfilingService::StartCpuProfiler(const string& profile_path) noexcept {
+  return ProfilerStart(profile_path.c_str()) != 0;
+}
+
+void ProfilingService::StopCpuProfiler() noexcept {
+  ProfilerStop();
+}
+
+ExecutionResultOr<string> ProfilingService::CollectHeapProfile() noexcept {
+  if (GetHeapProfile == nullptr) {
+    return FailureExecutionResult(
+        SC_PBS_PROFILING_SERVICE_PROFILER_UNAVAILABLE);
+  }
+  // Null unless the heap profiler is running.
+  char* heap_profile = GetHeapProfile();
+  if (heap_profile == nullptr) {
+    return FailureExecutionResult(
+        SC_PBS_PROFILING_SERVICE_HEAP_PROFILER_NOT_RUNNING);
+  }
+  string profile(heap_profile);
+  free(heap_profile);
+  return profile;
+}
+}  // namespace google::scp::pbs
@@ -0,0 +1,142 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "core/interface/async_context.h"
+#include "core/interface/async_executor_interface.h"
+#include "core/interface/config_provider_interface.h"
+#include "core/interface/http_server_interface.h"
+#include "core/interface/service_interface.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::pbs {
+/**
+ * @brief Serves CPU and heap profiles of the process in the pprof format, for
+ * `pprof http://<host>:<health port>/debug/pprof/profile` to work like it does
+ * against a Go server.
+ *
+ * The profiles are taken with gperftools, which the binary is not linked
+ * against: its functions are only called when the library is linked in or
+ * preloaded, and the requests fail with NOT_IMPLEMENTED otherwise. The heap
+ * profiles also need the heap profiler to be started with HEAPPROFILE.
+ *
+ * It also serves the CPU time the executors attribute to each task tag, see
+ * AsyncExecutorInterface::GetTaskTagStats, on /debug/executor/tags.
+ *
+ * The endpoints are only registered when kPBSProfilingServiceEnabled is set.
+ */
+class ProfilingService : public core::ServiceInterface {
+ public:
+  ProfilingService(
+      const std::shared_ptr<core::HttpServerInterface>& http_server,
+      const std::shared_ptr<core::ConfigProviderInterface>& config_provider,
+      const std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
+      const std::shared_ptr<core::AsyncExecutorInterface>& io_async_executor =
+          nullptr)
+      : http_server_(http_server),
+        config_provider_(config_provider),
+        async_executor_(async_executor),
+        io_async_executor_(io_async_executor),
+        max_cpu_profile_duration_in_seconds_(0),
+        is_cpu_profiling_(false) {}
+
+  core::ExecutionResult Init() noexcept override;
+  core::ExecutionResult Run() noexcept override;
+  core::ExecutionResult Stop() noexcept override;
+
+ protected:
+  /**
+   * @brief Profiles the CPU for the seconds of the `seconds` query parameter,
+   * then responds with the profile. Only one CPU profile is taken at a time.
+   *
+   * @param http_context The http context of the operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult ServeCpuProfile(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
+  /**
+   * @brief Responds with the profile of the allocations live on the heap.
+   *
+   * @param http_context The http context of the operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult ServeHeapProfile(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
+  /**
+   * @brief Responds with the task count and the CPU time of each task tag of
+   * the executors, one tab separated line per tag, the most expensive first.
+   *
+   * @param http_context The http context of the operation.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  core::ExecutionResult ServeTaskTagStats(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>&
+          http_context) noexcept;
+
+  /**
+   * @brief Stops the CPU profiler once the duration of the profile elapsed and
+   * responds with the profile.
+   *
+   * @param http_context The http context of the operation.
+   * @param profile_path The file the profile was written to.
+   */
+  void OnCpuProfileDurationElapsed(
+      core::AsyncContext<core::HttpRequest, core::HttpResponse>& http_context,
+      const std::string& profile_path) noexcept;
+
+  /**
+   * @brief Returns the duration of the CPU profile requested, 30 seconds if
+   * the request does not have one.
+   *
+   * @param http_request The http request.
+   * @return core::ExecutionResultOr<size_t> The duration in seconds.
+   */
+  core::ExecutionResultOr<size_t> GetCpuProfileDurationInSeconds(
+      const core::HttpRequest& http_request) noexcept;
+
+  /// @brief Whether the CPU profiler is linked in.
+  virtual bool IsCpuProfilerAvailable() noexcept;
+
+  /// @brief Starts profiling the CPU to the given file.
+  virtual bool StartCpuProfiler(const std::string& profile_path) noexcept;
+
+  /// @brief Stops profiling the CPU and flushes the profile.
+  virtual void StopCpuProfiler() noexcept;
+
+  /// @brief Returns the heap profile of the heap profiler.
+  virtual core::ExecutionResultOr<std::string> CollectHeapProfile() noexcept;
+
+  // An instance of the http server.
+  std::shared_ptr<core::HttpServerInterface> http_server_;
+  // An instance of the config provider.
+  std::shared_ptr<core::ConfigProviderInterface> config_provider_;
+  // Async executor instance, to respond once the CPU profiles are taken.
+  std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
+  // IO async executor instance, whose task tags are served along.
+  std::shared_ptr<core::AsyncExecutorInterface> io_async_executor_;
+  // The longest CPU profile a request can ask for.
+  size_t max_cpu_profile_duration_in_seconds_;
+  // Whether a CPU profile is being taken.
+  std::atomic<bool> is_cpu_profiling_;
+};
+}  // namespace google::scp::pbs
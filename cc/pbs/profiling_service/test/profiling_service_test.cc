@@ -0,0 +1,272 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pbs/profiling_service/src/profiling_service.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/async_executor/mock/mock_async_executor.h"
+#include "core/config_provider/mock/mock_config_provider.h"
+#include "core/http2_server/mock/mock_http2_server.h"
+#include "pbs/interface/configuration_keys.h"
+#include "pbs/profiling_service/src/error_codes.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
+using google::scp::core::AsyncTaskTagStats;
+using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::HttpHandler;
+using google::scp::core::HttpMethod;
+using google::scp::core::HttpRequest;
+using google::scp::core::HttpResponse;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::Timestamp;
+using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::config_provider::mock::MockConfigProvider;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_CPU_PROFILE_IN_PROGRESS;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_HEAP_PROFILER_NOT_RUNNING;
+using google::scp::core::errors::
+    SC_PBS_PROFILING_SERVICE_INVALID_PROFILE_DURATION;
+using google::scp::core::errors::SC_PBS_PROFILING_SERVICE_PROFILER_UNAVAILABLE;
+using google::scp::core::http2_server::mock::MockHttp2Server;
+using google::scp::core::test::ResultIs;
+using std::make_shared;
+using std::map;
+using std::shared_ptr;
+using std::string;
+
+namespace google::scp::pbs::test {
+
+static constexpr char kCpuProfilePath[] = "/debug/pprof/profile";
+static constexpr char kHeapProfilePath[] = "/debug/pprof/heap";
+static constexpr char kTaskTagStatsPath[] = "/debug/executor/tags";
+static constexpr char kCpuProfile[] = "cpu profile";
+
+class HandlerRecordingHttpServer : public MockHttp2Server {
+ public:
+  core::ExecutionResult RegisterResourceHandler(
+      HttpMethod http_method, string& resource_path,
+      HttpHandler& handler) noexcept override {
+    handlers[resource_path] = handler;
+    return SuccessExecutionResult();
+  }
+
+  map<string, HttpHandler> handlers;
+};
+
+class AsyncExecutorWithTaskTagStats : public MockAsyncExecutor {
+ public:
+  std::vector<AsyncTaskTagStats> GetTaskTagStats() const noexcept override {
+    AsyncTaskTagStats stats;
+    stats.component = "BudgetConsumer";
+    stats.operation = "Consume";
+    stats.task_count = 128;
+    stats.cpu_time = std::chrono::milliseconds(1500);
+    return {stats};
+  }
+};
+
+class ProfilingServiceWithFakeProfilers : public ProfilingService {
+ public:
+  using ProfilingService::ProfilingService;
+
+  bool IsCpuProfilerAvailable() noexcept override {
+    return is_cpu_profiler_available;
+  }
+
+  bool StartCpuProfiler(const string& profile_path) noexcept override {
+    cpu_profile_path = profile_path;
+    return true;
+  }
+
+  void StopCpuProfiler() noexcept override {
+    std::ofstream(cpu_profile_path, std::ios::binary) << kCpuProfile;
+  }
+
+  ExecutionResultOr<string> CollectHeapProfile() noexcept override {
+    return heap_profile;
+  }
+
+  bool is_cpu_profiler_available = true;
+  string cpu_profile_path;
+  ExecutionResultOr<string> heap_profile = string("heap profile");
+};
+
+class ProfilingServiceTest : public ::testing::Test {
+ protected:
+  ProfilingServiceTest()
+      : http_server_(make_shared<HandlerRecordingHttpServer>()),
+        config_provider_(make_shared<MockConfigProvider>()),
+        async_executor_(make_shared<MockAsyncExecutor>()) {
+    config_provider_->SetBool(kPBSProfilingServiceEnabled, true);
+    config_provider_->SetInt(kPBSProfilingServiceMaxCpuProfileDurationInSeconds,
+                             60);
+    async_executor_->schedule_for_mock = [this](const AsyncOperation& work,
+                                                Timestamp timestamp,
+                                                std::function<bool()>&) {
+      scheduled_work_ = work;
+      return SuccessExecutionResult();
+    };
+    profiling_service_ = std::make_unique<ProfilingServiceWithFakeProfilers>(
+        http_server_, config_provider_, async_executor_);
+  }
+
+  AsyncContext<HttpRequest, HttpResponse> CreateContext(
+      const string& query, ExecutionResult& result, bool& finished) {
+    AsyncContext<HttpRequest, HttpResponse> http_context;
+    http_context.request = make_shared<HttpRequest>();
+    http_context.request->query = make_shared<string>(query);
+    http_context.response = make_shared<HttpResponse>();
+    http_context.callback =
+        [&result, &finished](AsyncContext<HttpRequest, HttpResponse>& context) {
+          result = context.result;
+          finished = true;
+        };
+    return http_context;
+  }
+
+  shared_ptr<HandlerRecordingHttpServer> http_server_;
+  shared_ptr<MockConfigProvider> config_provider_;
+  shared_ptr<MockAsyncExecutor> async_executor_;
+  std::unique_ptr<ProfilingServiceWithFakeProfilers> profiling_service_;
+  AsyncOperation scheduled_work_;
+};
+
+TEST_F(ProfilingServiceTest, EndpointsAreNotRegisteredUnlessEnabled) {
+  config_provider_->SetBool(kPBSProfilingServiceEnabled, false);
+  EXPECT_SUCCESS(profiling_service_->Init());
+  EXPECT_TRUE(http_server_->handlers.empty());
+}
+
+TEST_F(ProfilingServiceTest, CpuProfileIsServedOnceTheDurationElapsed) {
+  EXPECT_SUCCESS(profiling_service_->Init());
+  ExecutionResult result;
+  bool finished = false;
+  auto http_context = CreateContext("seconds=2", result, finished);
+  EXPECT_SUCCESS(http_server_->handlers[kCpuProfilePath](http_context));
+  EXPECT_FALSE(finished);
+  ASSERT_TRUE(scheduled_work_);
+
+  scheduled_work_();
+  EXPECT_TRUE(finished);
+  EXPECT_SUCCESS(result);
+  EXPECT_EQ(string(http_context.response->body.bytes->begin(),
+                   http_context.response->body.bytes->end()),
+            kCpuProfile);
+  EXPECT_FALSE(std::filesystem::exists(profiling_service_->cpu_profile_path));
+}
+
+TEST_F(ProfilingServiceTest, OnlyOneCpuProfileIsTakenAtATime) {
+  EXPECT_SUCCESS(profiling_service_->Init());
+  ExecutionResult result;
+  bool finished = false;
+  auto http_context = CreateContext("", result, finished);
+  EXPECT_SUCCESS(http_server_->handlers[kCpuProfilePath](http_context));
+
+  ExecutionResult second_result;
+  bool second_finished = false;
+  auto second_http_context = CreateContext("", second_result, second_finished);
+  EXPECT_SUCCESS(http_server_->handlers[kCpuProfilePath](second_http_context));
+  EXPECT_TRUE(second_finished);
+  EXPECT_THAT(second_result,
+              ResultIs(FailureExecutionResult(
+                  SC_PBS_PROFILING_SERVICE_CPU_PROFILE_IN_PROGRESS)));
+
+  scheduled_work_();
+  EXPECT_SUCCESS(result);
+  second_finished = false;
+  EXPECT_SUCCESS(http_server_->handlers[kCpuProfilePath](second_http_context));
+  EXPECT_FALSE(second_finished);
+  scheduled_work_();
+  EXPECT_SUCCESS(second_result);
+}
+
+TEST_F(ProfilingServiceTest, CpuProfileDurationIsValidated) {
+  EXPECT_SUCCESS(profiling_service_->Init());
+  for (const auto* query : {"seconds=abc", "seconds=0", "seconds=61"}) {
+    ExecutionResult result;
+    bool finished = false;
+    auto http_context = CreateContext(query, result, finished);
+    EXPECT_SUCCESS(http_server_->handlers[kCpuProfilePath](http_context));
+    EXPECT_TRUE(finished);
+    EXPECT_THAT(result,
+                ResultIs(FailureExecutionResult(
+                    SC_PBS_PROFILING_SERVICE_INVALID_PROFILE_DURATION)));
+  }
+  EXPECT_FALSE(scheduled_work_);
+}
+
+TEST_F(ProfilingServiceTest, CpuProfileFailsWithoutTheProfiler) {
+  profiling_service_->is_cpu_profiler_available = false;
+  EXPECT_SUCCESS(profiling_service_->Init());
+  ExecutionResult result;
+  bool finished = false;
+  auto http_context = CreateContext("", result, finished);
+  EXPECT_SUCCESS(http_server_->handlers[kCpuProfilePath](http_context));
+  EXPECT_TRUE(finished);
+  EXPECT_THAT(result, ResultIs(FailureExecutionResult(
+                          SC_PBS_PROFILING_SERVICE_PROFILER_UNAVAILABLE)));
+}
+
+TEST_F(ProfilingServiceTest, HeapProfileIsServed) {
+  EXPECT_SUCCESS(profiling_service_->Init());
+  ExecutionResult result;
+  bool finished = false;
+  auto http_context = CreateContext("", result, finished);
+  EXPECT_SUCCESS(http_server_->handlers[kHeapProfilePath](http_context));
+  EXPECT_TRUE(finished);
+  EXPECT_SUCCESS(result);
+  EXPECT_EQ(string(http_context.response->body.bytes->begin(),
+                   http_context.response->body.bytes->end()),
+            "heap profile");
+
+  profiling_service_->heap_profile = FailureExecutionResult(
+      SC_PBS_PROFILING_SERVICE_HEAP_PROFILER_NOT_RUNNING);
+  finished = false;
+  EXPECT_SUCCESS(http_server_->handlers[kHeapProfilePath](http_context));
+  EXPECT_TRUE(finished);
+  EXPECT_THAT(result, ResultIs(FailureExecutionResult(
+                          SC_PBS_PROFILING_SERVICE_HEAP_PROFILER_NOT_RUNNING)));
+}
+
+TEST_F(ProfilingServiceTest, TaskTagStatsAreServed) {
+  profiling_service_ = std::make_unique<ProfilingServiceWithFakeProfilers>(
+      http_server_, config_provider_, async_executor_,
+      make_shared<AsyncExecutorWithTaskTagStats>());
+  EXPECT_SUCCESS(profiling_service_->Init());
+  ExecutionResult result;
+  bool finished = false;
+  auto http_context = CreateContext("", result, finished);
+  EXPECT_SUCCESS(http_server_->handlers[kTaskTagStatsPath](http_context));
+  EXPECT_TRUE(finished);
+  EXPECT_SUCCESS(result);
+  EXPECT_EQ(string(http_context.response->body.bytes->begin(),
+                   http_context.response->body.bytes->end()),
+            "executor\tcomponent\toperation\ttask_count\tcpu_seconds\n"
+            "io_async_executor\tBudgetConsumer\tConsume\t128\t1.5\n");
+}
+}  // namespace google::scp::pbs::test
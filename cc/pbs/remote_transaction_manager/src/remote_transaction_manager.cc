@@ -31,6 +31,8 @@
 
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
+using google::scp::core::BatchGetTransactionStatusRequest;
+using google::scp::core::BatchGetTransactionStatusResponse;
 using google::scp::core::CredentialsProviderInterface;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
@@ -71,6 +73,14 @@ ExecutionResult RemoteTransactionManager::GetTransactionStatus(
   return pbs_client_->GetTransactionStatus(get_transaction_status_context);
 }
 
+ExecutionResult RemoteTransactionManager::BatchGetTransactionStatus(
+    AsyncContext<BatchGetTransactionStatusRequest,
+                 BatchGetTransactionStatusResponse>&
+        batch_get_transaction_status_context) noexcept {
+  return pbs_client_->BatchGetTransactionStatus(
+      batch_get_transaction_status_context);
+}
+
 ExecutionResult RemoteTransactionManager::ExecutePhase(
     AsyncContext<TransactionPhaseRequest, TransactionPhaseResponse>&
         transaction_phase_context) noexcept {
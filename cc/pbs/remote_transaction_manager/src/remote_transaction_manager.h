@@ -47,6 +47,11 @@ class RemoteTransactionManager
                          core::GetTransactionStatusResponse>&
           get_transaction_status_context) noexcept override;
 
+  core::ExecutionResult BatchGetTransactionStatus(
+      core::AsyncContext<core::BatchGetTransactionStatusRequest,
+                         core::BatchGetTransactionStatusResponse>&
+          batch_get_transaction_status_context) noexcept override;
+
   core::ExecutionResult ExecutePhase(
       core::AsyncContext<core::TransactionPhaseRequest,
                          core::TransactionPhaseResponse>&
@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 
@@ -114,12 +115,14 @@ class FakePBSPartitionManager : public PBSPartitionManagerInterface {
     partitions_[partition_metadata.Id()] = PartitionEntry{
         std::make_shared<string>(partition_metadata.partition_address_uri),
         make_shared<MockPBSPartition>()};
+    partitions_version_++;
     return SuccessExecutionResult();
   }
 
   ExecutionResult UnloadPartition(
       const core::PartitionMetadata& partition_metadata) noexcept override {
     partitions_.erase(partition_metadata.Id());
+    partitions_version_++;
     return SuccessExecutionResult();
   }
 
@@ -127,6 +130,7 @@ class FakePBSPartitionManager : public PBSPartitionManagerInterface {
       const core::PartitionMetadata& partition_metadata) noexcept override {
     partitions_[partition_metadata.Id()].partition_host_uri =
         make_shared<string>(partition_metadata.partition_address_uri);
+    partitions_version_++;
     return SuccessExecutionResult();
   }
 
@@ -151,8 +155,13 @@ class FakePBSPartitionManager : public PBSPartitionManagerInterface {
     return partitions_[partition_id].pbs_partition;
   }
 
+  uint64_t GetPartitionsVersion() noexcept override {
+    return partitions_version_;
+  }
+
  private:
   map<core::PartitionId, PartitionEntry> partitions_;
+  std::atomic<uint64_t> partitions_version_ = 0;
 };
 
 class RequestForwardingIntegrationTest : public testing::Test {
@@ -0,0 +1,146 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Exports the budget key table of a Spanner database to a file, or imports
+// such a file into a budget key table, e.g.
+//
+//   budget_table_transfer --mode=export --project=p --instance=i \
+//     --database=d --file=/tmp/budgets.tsv
+//   budget_table_transfer --mode=import --project=p --instance=i \
+//     --database=d --file=/tmp/budgets.tsv \
+//     --checkpoint_file=/tmp/budgets.checkpoint
+//
+// An interrupted import run again with the same checkpoint file resumes after
+// the last batch it wrote.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/log/initialize.h"
+#include "absl/log/log.h"
+#include "cc/pbs/tools/budget_table_transfer/budget_table_transfer_internal.h"
+#include "google/cloud/spanner/client.h"
+
+ABSL_FLAG(std::string, mode, "", "Either export or import.");
+ABSL_FLAG(std::string, project, "", "The GCP project of the database.");
+ABSL_FLAG(std::string, instance, "", "The Spanner instance of the database.");
+ABSL_FLAG(std::string, database, "", "The Spanner database.");
+ABSL_FLAG(std::string, table_name, "BudgetKey", "The budget key table.");
+ABSL_FLAG(bool, with_token_counts, true,
+          "Whether the table has the Token_Counts column.");
+ABSL_FLAG(std::string, file, "", "The file the rows are exported to.");
+ABSL_FLAG(int, parallelism, 8,
+          "The number of partitions of the table exported at once.");
+ABSL_FLAG(int, rows_per_mutation_group, 2000,
+          "The rows of each mutation group of an import, capped to the "
+          "mutations of a commit.");
+ABSL_FLAG(int, mutation_groups_per_batch, 16,
+          "The mutation groups of each batch write of an import.");
+ABSL_FLAG(std::string, checkpoint_file, "",
+          "The file the progress of an import is kept in, to resume it.");
+
+namespace {
+
+size_t ReadCheckpoint(const std::string& checkpoint_file) {
+  std::ifstream input(checkpoint_file);
+  size_t imported_line_count = 0;
+  if (input >> imported_line_count) {
+    return imported_line_count;
+  }
+  return 0;
+}
+
+// Replaces the checkpoint at once, so that an interruption leaves the previous
+// one.
+void WriteCheckpoint(const std::string& checkpoint_file,
+                     size_t imported_line_count) {
+  std::string temporary_file = checkpoint_file + ".tmp";
+  {
+    std::ofstream output(temporary_file, std::ios::trunc);
+    output << imported_line_count << "\n";
+    QCHECK(output.good()) << "Cannot write " << temporary_file;
+  }
+  QCHECK(std::rename(temporary_file.c_str(), checkpoint_file.c_str()) == 0)
+      << "Cannot write " << checkpoint_file;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+  absl::InitializeLog();
+
+  std::string mode = absl::GetFlag(FLAGS_mode);
+  std::string file = absl::GetFlag(FLAGS_file);
+  QCHECK(mode == "export" || mode == "import")
+      << "--mode must be export or import";
+  QCHECK(!file.empty()) << "--file is required";
+
+  google::cloud::spanner::Client client(google::cloud::spanner::MakeConnection(
+      google::cloud::spanner::Database(absl::GetFlag(FLAGS_project),
+                                       absl::GetFlag(FLAGS_instance),
+                                       absl::GetFlag(FLAGS_database))));
+
+  if (mode == "export") {
+    std::ofstream output(file, std::ios::trunc);
+    QCHECK(output.is_open()) << "Cannot open " << file;
+    google::scp::pbs::ExportOptions options;
+    options.table_name = absl::GetFlag(FLAGS_table_name);
+    options.with_token_counts = absl::GetFlag(FLAGS_with_token_counts);
+    options.parallelism = absl::GetFlag(FLAGS_parallelism);
+    auto row_count =
+        google::scp::pbs::ExportBudgetTable(std::move(client), options, output);
+    output.flush();
+    if (!row_count.ok()) {
+      LOG(ERROR) << "Failed to export the table: " << row_count.status();
+      return 1;
+    }
+    LOG(INFO) << "Exported " << *row_count << " rows";
+    return 0;
+  }
+
+  std::ifstream input(file);
+  QCHECK(input.is_open()) << "Cannot open " << file;
+  std::string checkpoint_file = absl::GetFlag(FLAGS_checkpoint_file);
+  google::scp::pbs::ImportOptions options;
+  options.table_name = absl::GetFlag(FLAGS_table_name);
+  options.with_token_counts = absl::GetFlag(FLAGS_with_token_counts);
+  options.rows_per_mutation_group =
+      absl::GetFlag(FLAGS_rows_per_mutation_group);
+  options.mutation_groups_per_batch =
+      absl::GetFlag(FLAGS_mutation_groups_per_batch);
+  if (!checkpoint_file.empty()) {
+    options.skip_rows = ReadCheckpoint(checkpoint_file);
+    LOG(INFO) << "Resuming after line " << options.skip_rows;
+  }
+  auto row_count = google::scp::pbs::ImportBudgetTable(
+      std::move(client), options, input,
+      [&checkpoint_file](size_t imported_line_count) {
+        if (!checkpoint_file.empty()) {
+          WriteCheckpoint(checkpoint_file, imported_line_count);
+        }
+        LOG(INFO) << "Imported up to line " << imported_line_count;
+      });
+  if (!row_count.ok()) {
+    LOG(ERROR) << "Failed to import the rows: " << row_count.status();
+    return 1;
+  }
+  LOG(INFO) << "Imported " << *row_count << " rows";
+  return 0;
+}
@@ -0,0 +1,306 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/tools/budget_table_transfer/budget_table_transfer_internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "google/cloud/spanner/mutations.h"
+
+namespace google::scp::pbs {
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+
+constexpr char kNullField[] = "\\N";
+constexpr char kBudgetKeyColumnName[] = "Budget_Key";
+constexpr char kTimeframeColumnName[] = "Timeframe";
+constexpr char kValueColumnName[] = "Value";
+constexpr char kTokenCountsColumnName[] = "Token_Counts";
+
+std::vector<std::string> GetColumns(bool with_token_counts) {
+  std::vector<std::string> columns = {kBudgetKeyColumnName,
+                                      kTimeframeColumnName, kValueColumnName};
+  if (with_token_counts) {
+    columns.push_back(kTokenCountsColumnName);
+  }
+  return columns;
+}
+
+absl::Status ToAbslStatus(const google::cloud::Status& status) {
+  return absl::Status(static_cast<absl::StatusCode>(status.code()),
+                      status.message());
+}
+
+std::string FormatField(const std::optional<std::string>& field) {
+  return field.has_value() ? absl::CEscape(*field) : kNullField;
+}
+
+absl::StatusOr<std::optional<std::string>> ParseField(
+    absl::string_view field) {
+  if (field == kNullField) {
+    return std::nullopt;
+  }
+  std::string unescaped;
+  if (std::string error; !absl::CUnescape(field, &unescaped, &error)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid field ", field, ": ", error));
+  }
+  return unescaped;
+}
+
+absl::StatusOr<BudgetKeyRow> GetBudgetKeyRow(const spanner::Row& row,
+                                             bool with_token_counts) {
+  BudgetKeyRow budget_key_row;
+  auto budget_key = row.get<std::string>(0);
+  auto timeframe = row.get<std::string>(1);
+  auto value = row.get<absl::optional<spanner::Json>>(2);
+  if (!budget_key || !timeframe || !value) {
+    return absl::InternalError("Unexpected types of the budget key columns");
+  }
+  budget_key_row.budget_key = *std::move(budget_key);
+  budget_key_row.timeframe = *std::move(timeframe);
+  if (value->has_value()) {
+    budget_key_row.value = std::string(**value);
+  }
+  if (with_token_counts) {
+    auto token_counts = row.get<absl::optional<spanner::Bytes>>(3);
+    if (!token_counts) {
+      return absl::InternalError("Unexpected type of the Token_Counts column");
+    }
+    if (token_counts->has_value()) {
+      budget_key_row.token_counts = (*token_counts)->get<std::string>();
+    }
+  }
+  return budget_key_row;
+}
+
+std::vector<spanner::Value> GetSpannerValues(const BudgetKeyRow& row,
+                                             bool with_token_counts) {
+  std::vector<spanner::Value> values = {
+      spanner::Value(row.budget_key), spanner::Value(row.timeframe),
+      row.value.has_value() ? spanner::Value(spanner::Json(*row.value))
+                            : spanner::MakeNullValue<spanner::Json>()};
+  if (with_token_counts) {
+    values.push_back(row.token_counts.has_value()
+                         ? spanner::Value(spanner::Bytes(*row.token_counts))
+                         : spanner::MakeNullValue<spanner::Bytes>());
+  }
+  return values;
+}
+
+// Writes the mutation groups of the rows, in one batch write. Every group
+// must be committed for the batch to succeed.
+absl::Status WriteBatch(spanner::Client& client, const ImportOptions& options,
+                        const std::vector<std::vector<BudgetKeyRow>>& groups) {
+  auto columns = GetColumns(options.with_token_counts);
+  std::vector<spanner::Mutations> mutation_groups;
+  mutation_groups.reserve(groups.size());
+  for (const auto& group : groups) {
+    spanner::InsertOrUpdateMutationBuilder builder(options.table_name,
+                                                   columns);
+    for (const auto& row : group) {
+      builder.AddRow(GetSpannerValues(row, options.with_token_counts));
+    }
+    mutation_groups.push_back({std::move(builder).Build()});
+  }
+
+  std::vector<bool> committed(groups.size(), false);
+  for (auto& result : client.CommitAtLeastOnce(std::move(mutation_groups))) {
+    if (!result) {
+      return ToAbslStatus(result.status());
+    }
+    if (!result->commit_timestamp) {
+      return ToAbslStatus(result->commit_timestamp.status());
+    }
+    for (size_t index : result->indexes) {
+      committed[index] = true;
+    }
+  }
+  if (std::find(committed.begin(), committed.end(), false) !=
+      committed.end()) {
+    return absl::InternalError("Some mutation groups were not committed");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::string FormatBudgetKeyRow(const BudgetKeyRow& row) {
+  return absl::StrJoin({absl::CEscape(row.budget_key),
+                        absl::CEscape(row.timeframe), FormatField(row.value),
+                        FormatField(row.token_counts)},
+                       "\t");
+}
+
+absl::StatusOr<BudgetKeyRow> ParseBudgetKeyRow(absl::string_view line) {
+  std::vector<absl::string_view> fields = absl::StrSplit(line, '\t');
+  if (fields.size() != 4) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Expected 4 fields, got ", fields.size()));
+  }
+  std::vector<std::optional<std::string>> values;
+  for (absl::string_view field : fields) {
+    auto value = ParseField(field);
+    if (!value.ok()) {
+      return value.status();
+    }
+    values.push_back(*std::move(value));
+  }
+  if (!values[0].has_value() || !values[1].has_value()) {
+    return absl::InvalidArgumentError("The primary key columns cannot be null");
+  }
+  BudgetKeyRow row;
+  row.budget_key = *std::move(values[0]);
+  row.timeframe = *std::move(values[1]);
+  row.value = std::move(values[2]);
+  row.token_counts = std::move(values[3]);
+  return row;
+}
+
+size_t GetRowsPerMutationGroup(size_t requested_rows_per_group,
+                               size_t column_count) {
+  size_t max_rows_per_group =
+      std::max<size_t>(1, kMaxSpannerMutationsPerCommit / column_count);
+  if (requested_rows_per_group == 0) {
+    return max_rows_per_group;
+  }
+  return std::min(requested_rows_per_group, max_rows_per_group);
+}
+
+absl::StatusOr<size_t> ExportBudgetTable(spanner::Client client,
+                                         const ExportOptions& options,
+                                         std::ostream& output) {
+  auto partitions = client.PartitionRead(
+      spanner::MakeReadOnlyTransaction(), options.table_name,
+      spanner::KeySet::All(), GetColumns(options.with_token_counts));
+  if (!partitions) {
+    return ToAbslStatus(partitions.status());
+  }
+
+  std::atomic<size_t> next_partition = 0;
+  std::mutex mutex;
+  size_t row_count = 0;
+  absl::Status status;
+  auto read_partitions = [&]() {
+    for (size_t i = next_partition++; i < partitions->size();
+         i = next_partition++) {
+      // The lines of a partition are written at once, so that the threads
+      // do not interleave them line by line.
+      std::string lines;
+      size_t partition_row_count = 0;
+      for (auto& row : client.Read((*partitions)[i])) {
+        absl::StatusOr<BudgetKeyRow> budget_key_row =
+            ToAbslStatus(row.status());
+        if (row) {
+          budget_key_row = GetBudgetKeyRow(*row, options.with_token_counts);
+        }
+        if (!budget_key_row.ok()) {
+          std::lock_guard<std::mutex> lock(mutex);
+          status.Update(budget_key_row.status());
+          return;
+        }
+        absl::StrAppend(&lines, FormatBudgetKeyRow(*budget_key_row), "\n");
+        partition_row_count++;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!status.ok()) {
+        return;
+      }
+      output << lines;
+      row_count += partition_row_count;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::max<size_t>(1, options.parallelism); ++i) {
+    threads.emplace_back(read_partitions);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (!status.ok()) {
+    return status;
+  }
+  return row_count;
+}
+
+absl::StatusOr<size_t> ImportBudgetTable(
+    spanner::Client client, const ImportOptions& options, std::istream& input,
+    const std::function<void(size_t)>& on_progress) {
+  size_t rows_per_group = GetRowsPerMutationGroup(
+      options.rows_per_mutation_group,
+      GetColumns(options.with_token_counts).size());
+  size_t groups_per_batch =
+      std::max<size_t>(1, options.mutation_groups_per_batch);
+
+  std::vector<std::vector<BudgetKeyRow>> groups;
+  size_t line_count = 0;
+  size_t imported_row_count = 0;
+  size_t batch_row_count = 0;
+  // Writes the rows of the batch, which are all the lines of the input up to
+  // `imported_line_count` not imported yet.
+  auto write_batch = [&](size_t imported_line_count) -> absl::Status {
+    if (groups.empty()) {
+      return absl::OkStatus();
+    }
+    if (auto status = WriteBatch(client, options, groups); !status.ok()) {
+      return status;
+    }
+    groups.clear();
+    imported_row_count += batch_row_count;
+    batch_row_count = 0;
+    on_progress(imported_line_count);
+    return absl::OkStatus();
+  };
+
+  std::string line;
+  while (std::getline(input, line)) {
+    line_count++;
+    if (line_count <= options.skip_rows) {
+      continue;
+    }
+    auto row = ParseBudgetKeyRow(line);
+    if (!row.ok()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Line ", line_count, " is invalid: ", row.status().message()));
+    }
+    if (groups.empty() || groups.back().size() == rows_per_group) {
+      if (groups.size() == groups_per_batch) {
+        if (auto status = write_batch(line_count - 1); !status.ok()) {
+          return status;
+        }
+      }
+      groups.emplace_back();
+    }
+    groups.back().push_back(*std::move(row));
+    batch_row_count++;
+  }
+  if (auto status = write_batch(line_count); !status.ok()) {
+    return status;
+  }
+  return imported_row_count;
+}
+
+}  // namespace google::scp::pbs
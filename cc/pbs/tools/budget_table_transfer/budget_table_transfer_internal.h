@@ -0,0 +1,107 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CC_PBS_TOOLS_BUDGET_TABLE_TRANSFER_BUDGET_TABLE_TRANSFER_INTERNAL_H_
+#define CC_PBS_TOOLS_BUDGET_TABLE_TRANSFER_BUDGET_TABLE_TRANSFER_INTERNAL_H_
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "google/cloud/spanner/client.h"
+
+namespace google::scp::pbs {
+
+// One row of the budget key table.
+struct BudgetKeyRow {
+  std::string budget_key;
+  // The number of days since epoch of the day the row's budgets are in.
+  std::string timeframe;
+  // The Value column, a JSON object with the TokenCount of the hours.
+  std::optional<std::string> value;
+  // The Token_Counts column, the packed token counts of the hours.
+  std::optional<std::string> token_counts;
+
+  bool operator==(const BudgetKeyRow& other) const {
+    return budget_key == other.budget_key && timeframe == other.timeframe &&
+           value == other.value && token_counts == other.token_counts;
+  }
+};
+
+// The max number of mutations of a Spanner commit, each column of each row
+// written counting as one.
+inline constexpr size_t kMaxSpannerMutationsPerCommit = 80000;
+
+// Formats a row as a line of tab separated, C escaped fields, without the
+// newline. A null column is written as \N, which no escaped value can be.
+std::string FormatBudgetKeyRow(const BudgetKeyRow& row);
+
+// Parses a line written by FormatBudgetKeyRow.
+absl::StatusOr<BudgetKeyRow> ParseBudgetKeyRow(absl::string_view line);
+
+// The number of rows of each mutation group of an import, capped for the
+// group to fit in a commit.
+size_t GetRowsPerMutationGroup(size_t requested_rows_per_group,
+                               size_t column_count);
+
+struct ExportOptions {
+  std::string table_name;
+  // Whether the table has the Token_Counts column.
+  bool with_token_counts = true;
+  // The number of partitions read at once.
+  size_t parallelism = 8;
+};
+
+// Writes the rows of the table to `output`, one line per row, in no
+// particular order. The table is split with a partitioned read at a single
+// snapshot, and the partitions are read by `parallelism` threads. Returns the
+// number of rows written.
+absl::StatusOr<size_t> ExportBudgetTable(google::cloud::spanner::Client client,
+                                         const ExportOptions& options,
+                                         std::ostream& output);
+
+struct ImportOptions {
+  std::string table_name;
+  // Whether the table has the Token_Counts column.
+  bool with_token_counts = true;
+  // The rows of each mutation group, see GetRowsPerMutationGroup.
+  size_t rows_per_mutation_group = 2000;
+  // The mutation groups of each batch write.
+  size_t mutation_groups_per_batch = 16;
+  // The number of lines of the input already imported, e.g. by an interrupted
+  // import, which are skipped.
+  size_t skip_rows = 0;
+};
+
+// Imports the rows written by ExportBudgetTable from `input`, with batch
+// writes of up to `mutation_groups_per_batch` groups of rows. The rows are
+// inserted or updated, so a batch written again after a failure leaves the
+// table as if it was written once. `on_progress` is called with the number of
+// lines of the input imported so far after every batch, all its groups being
+// committed. Returns the number of rows imported, not counting the skipped
+// ones.
+absl::StatusOr<size_t> ImportBudgetTable(
+    google::cloud::spanner::Client client, const ImportOptions& options,
+    std::istream& input, const std::function<void(size_t)>& on_progress);
+
+}  // namespace google::scp::pbs
+
+#endif  // CC_PBS_TOOLS_BUDGET_TABLE_TRANSFER_BUDGET_TABLE_TRANSFER_INTERNAL_H_
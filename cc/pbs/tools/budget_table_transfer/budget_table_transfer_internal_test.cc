@@ -0,0 +1,70 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cc/pbs/tools/budget_table_transfer/budget_table_transfer_internal.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "absl/status/status.h"
+
+namespace google::scp::pbs {
+namespace {
+
+TEST(BudgetTableTransferTest, RowsAreFormattedAndParsedBack) {
+  BudgetKeyRow row;
+  row.budget_key = "origin.com/key\twith\ttabs\n";
+  row.timeframe = "19723";
+  row.value = R"({"TokenCount":"1 0 1 1"})";
+  row.token_counts = std::string("\x01\x00\x00\x00\\N", 6);
+
+  std::string line = FormatBudgetKeyRow(row);
+  EXPECT_EQ(line.find('\n'), std::string::npos);
+  auto parsed_row = ParseBudgetKeyRow(line);
+  ASSERT_TRUE(parsed_row.ok()) << parsed_row.status();
+  EXPECT_EQ(*parsed_row, row);
+}
+
+TEST(BudgetTableTransferTest, NullColumnsAreFormattedAndParsedBack) {
+  BudgetKeyRow row;
+  row.budget_key = "origin.com/key";
+  row.timeframe = "19723";
+  row.token_counts = "\\N";
+
+  std::string line = FormatBudgetKeyRow(row);
+  EXPECT_EQ(line, "origin.com/key\t19723\t\\N\t\\\\N");
+  auto parsed_row = ParseBudgetKeyRow(line);
+  ASSERT_TRUE(parsed_row.ok()) << parsed_row.status();
+  EXPECT_EQ(*parsed_row, row);
+}
+
+TEST(BudgetTableTransferTest, InvalidLinesAreNotParsed) {
+  EXPECT_EQ(ParseBudgetKeyRow("origin.com/key\t19723").status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ParseBudgetKeyRow("\\N\t19723\t\\N\t\\N").status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ParseBudgetKeyRow("key\t19723\t\\x\t\\N").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(BudgetTableTransferTest, MutationGroupsFitInACommit) {
+  EXPECT_EQ(GetRowsPerMutationGroup(2000, 4), 2000);
+  EXPECT_EQ(GetRowsPerMutationGroup(50000, 4), 20000);
+  EXPECT_EQ(GetRowsPerMutationGroup(0, 3), 26666);
+}
+
+}  // namespace
+}  // namespace google::scp::pbs
@@ -1,14 +1,27 @@
 #include "cc/pbs/tools/pbs_log_recovery/read_journal_internal.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "absl/flags/internal/path_util.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "cc/core/blob_storage_provider/mock/mock_blob_storage_provider.h"
 #include "cc/core/journal_service/interface/journal_service_stream_interface.h"
+#include "cc/core/journal_service/src/journal_serialization.h"
 #include "cc/core/journal_service/src/proto/journal_service.pb.h"
+#include "cc/core/transaction_manager/src/proto/transaction_engine.pb.h"
+#include "cc/pbs/budget_key_provider/src/proto/budget_key_provider.pb.h"
+#include "core/common/serialization/src/serialization.h"
+#include "core/common/uuid/src/uuid.h"
 #include "core/interface/type_def.h"
 
 namespace google::scp::pbs {
@@ -18,8 +31,163 @@ using ::google::scp::core::BytesBuffer;
 using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::GetBlobRequest;
 using ::google::scp::core::GetBlobResponse;
+using ::google::scp::core::JournalLogStatus;
+using ::google::scp::core::Timestamp;
+using ::google::scp::core::Version;
 using ::google::scp::core::blob_storage_provider::mock::MockBlobStorageClient;
+using ::google::scp::core::common::Serialization;
+using ::google::scp::core::common::ToString;
+using ::google::scp::core::common::Uuid;
 using ::google::scp::core::errors::GetErrorMessage;
+using ::google::scp::core::journal_service::JournalLog;
+using ::google::scp::core::journal_service::JournalSerialization;
+using ::google::scp::core::transaction_manager::proto::TransactionEngineLog;
+using ::google::scp::core::transaction_manager::proto::
+    TransactionEngineLog_1_0;
+using ::google::scp::core::transaction_manager::proto::TransactionLog_1_0;
+using ::google::scp::core::transaction_manager::proto::TransactionLogType;
+using ::google::scp::core::transaction_manager::proto::TransactionPhase_Name;
+using ::google::scp::core::transaction_manager::proto::
+    TransactionPhaseBatchLog_1_0;
+using ::google::scp::core::transaction_manager::proto::TransactionPhaseLog_1_0;
+using ::google::scp::pbs::budget_key_provider::proto::BudgetKeyProviderLog;
+using ::google::scp::pbs::budget_key_provider::proto::BudgetKeyProviderLog_1_0;
+using ::google::scp::pbs::budget_key_provider::proto::OperationType_Name;
+
+namespace {
+
+// The ids the budget key provider and the transaction engine journal with.
+constexpr Uuid kBudgetKeyProviderId = {.high = 0xFFFFFFF1, .low = 0x00000002};
+constexpr Uuid kTransactionEngineId = {.high = 0xFFFFFFF1, .low = 0x00000004};
+constexpr Version kLogVersion = {.major = 1, .minor = 0};
+
+constexpr char kBudgetKeyProviderComponent[] = "budget_key_provider";
+constexpr char kTransactionEngineComponent[] = "transaction_engine";
+constexpr char kBudgetKeyComponent[] = "budget_key";
+constexpr char kUnknownComponent[] = "unknown";
+constexpr char kUndecodableOperation[] = "UNDECODABLE";
+
+std::string ToUuidString(const core::common::proto::Uuid& uuid) {
+  return ToString(Uuid{.high = uuid.high(), .low = uuid.low()});
+}
+
+// Unwraps the versioned log body of the budget key provider and the
+// transaction engine logs.
+template <typename TVersionedLog, typename TLog>
+bool DeserializeVersionedLog(const std::string& log_body, TLog& log) {
+  TVersionedLog versioned_log;
+  size_t bytes_deserialized = 0;
+  return Serialization::DeserializeProtoMessage<TVersionedLog>(
+             log_body, versioned_log, bytes_deserialized)
+             .Successful() &&
+         Serialization::ValidateVersion(versioned_log, kLogVersion)
+             .Successful() &&
+         Serialization::DeserializeProtoMessage<TLog>(
+             versioned_log.log_body(), log, bytes_deserialized)
+             .Successful();
+}
+
+template <typename TProto>
+bool DeserializeLog(const std::string& log_body, TProto& log) {
+  size_t bytes_deserialized = 0;
+  return Serialization::DeserializeProtoMessage<TProto>(log_body, log,
+                                                        bytes_deserialized)
+      .Successful();
+}
+
+void DecodeBudgetKeyProviderLog(const std::string& log_body,
+                                JournalRecord record,
+                                std::vector<JournalRecord>& records) {
+  record.component = kBudgetKeyProviderComponent;
+  BudgetKeyProviderLog_1_0 log;
+  if (!DeserializeVersionedLog<BudgetKeyProviderLog>(log_body, log)) {
+    record.operation = kUndecodableOperation;
+  } else {
+    record.operation = OperationType_Name(log.operation_type());
+    record.budget_key_id = ToUuidString(log.id());
+    record.budget_key_name = log.budget_key_name();
+  }
+  records.push_back(std::move(record));
+}
+
+void DecodeTransactionEngineLog(const std::string& log_body,
+                                JournalRecord record,
+                                std::vector<JournalRecord>& records) {
+  record.component = kTransactionEngineComponent;
+  TransactionEngineLog_1_0 log;
+  if (!DeserializeVersionedLog<TransactionEngineLog>(log_body, log)) {
+    record.operation = kUndecodableOperation;
+    records.push_back(std::move(record));
+    return;
+  }
+
+  auto add_phase_record = [&records](JournalRecord record,
+                                     const TransactionPhaseLog_1_0& phase_log) {
+    record.operation = TransactionPhase_Name(phase_log.phase());
+    if (phase_log.failed()) {
+      absl::StrAppend(&record.operation, "_FAILED");
+    }
+    record.transaction_id = ToUuidString(phase_log.id());
+    records.push_back(std::move(record));
+  };
+
+  switch (log.type()) {
+    case TransactionLogType::TRANSACTION_LOG: {
+      TransactionLog_1_0 transaction_log;
+      if (!DeserializeLog(log.log_body(), transaction_log)) {
+        break;
+      }
+      record.operation = "TRANSACTION";
+      record.transaction_id = ToUuidString(transaction_log.id());
+      records.push_back(std::move(record));
+      return;
+    }
+    case TransactionLogType::TRANSACTION_PHASE_LOG: {
+      TransactionPhaseLog_1_0 phase_log;
+      if (!DeserializeLog(log.log_body(), phase_log)) {
+        break;
+      }
+      add_phase_record(std::move(record), phase_log);
+      return;
+    }
+    case TransactionLogType::TRANSACTION_PHASE_BATCH_LOG: {
+      // One record per transaction of the batch.
+      TransactionPhaseBatchLog_1_0 phase_batch_log;
+      if (!DeserializeLog(log.log_body(), phase_batch_log)) {
+        break;
+      }
+      for (const auto& phase_log : phase_batch_log.phase_logs()) {
+        add_phase_record(record, phase_log);
+      }
+      return;
+    }
+    default:
+      break;
+  }
+  record.operation = kUndecodableOperation;
+  records.push_back(std::move(record));
+}
+
+bool NeedsCsvQuoting(const std::string& field) {
+  return field.find_first_of(",\"\n\r") != std::string::npos;
+}
+
+void WriteCsvField(const std::string& field, std::ostream& output) {
+  if (!NeedsCsvQuoting(field)) {
+    output << field;
+    return;
+  }
+  output << '"';
+  for (char c : field) {
+    if (c == '"') {
+      output << '"';
+    }
+    output << c;
+  }
+  output << '"';
+}
+
+}  // namespace
 
 absl::StatusOr<BytesBuffer> ReadJournalFile(
     MockBlobStorageClient& storage_client, absl::string_view journal_file_path,
@@ -31,11 +199,15 @@ absl::StatusOr<BytesBuffer> ReadJournalFile(
       absl::flags_internal::Basename(journal_file_path));
 
   BytesBuffer journal_bytes_buffer;
+  ExecutionResult get_blob_result = core::SuccessExecutionResult();
   AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
       get_blob_request,
-      [&journal_bytes_buffer,
+      [&journal_bytes_buffer, &get_blob_result,
        &blocker](AsyncContext<GetBlobRequest, GetBlobResponse>& context) {
-        journal_bytes_buffer = *context.response->buffer;
+        get_blob_result = context.result;
+        if (context.result.Successful()) {
+          journal_bytes_buffer = *context.response->buffer;
+        }
         blocker.DecrementCount();
       });
 
@@ -45,8 +217,176 @@ absl::StatusOr<BytesBuffer> ReadJournalFile(
   }
 
   blocker.Wait();
+  if (!get_blob_result.Successful()) {
+    return absl::InternalError(absl::StrCat(
+        journal_file_path, ": ", GetErrorMessage(get_blob_result.status_code)));
+  }
 
   return journal_bytes_buffer;
 }
 
+bool JournalRecordFilter::Matches(const JournalRecord& record) const {
+  return (budget_key_name.empty() ||
+          record.budget_key_name == budget_key_name) &&
+         (transaction_id.empty() || record.transaction_id == transaction_id);
+}
+
+absl::StatusOr<std::vector<JournalRecord>> DecodeJournalFile(
+    absl::string_view journal_file_path,
+    const BytesBuffer& journal_bytes_buffer) {
+  BytesBuffer uncompressed_bytes_buffer;
+  const BytesBuffer* bytes_buffer = &journal_bytes_buffer;
+  if (JournalSerialization::IsCompressedJournalBlob(journal_bytes_buffer)) {
+    auto result = JournalSerialization::DecompressJournalBlob(
+        journal_bytes_buffer, uncompressed_bytes_buffer);
+    if (!result.Successful()) {
+      return absl::DataLossError(absl::StrCat(
+          journal_file_path, ": ", GetErrorMessage(result.status_code)));
+    }
+    bytes_buffer = &uncompressed_bytes_buffer;
+  }
+
+  std::vector<JournalRecord> records;
+  size_t offset = 0;
+  while (offset < bytes_buffer->length) {
+    Timestamp timestamp = 0;
+    JournalLogStatus log_status;
+    Uuid component_id;
+    Uuid log_id;
+    size_t bytes_deserialized = 0;
+    auto result = JournalSerialization::DeserializeLogHeader(
+        *bytes_buffer, offset, timestamp, log_status, component_id, log_id,
+        bytes_deserialized);
+    if (!result.Successful()) {
+      return absl::DataLossError(
+          absl::StrCat(journal_file_path, " at offset ", offset, ": ",
+                       GetErrorMessage(result.status_code)));
+    }
+    offset += bytes_deserialized;
+
+    JournalLog journal_log;
+    result = JournalSerialization::DeserializeJournalLog(
+        *bytes_buffer, offset, journal_log, bytes_deserialized);
+    if (!result.Successful()) {
+      return absl::DataLossError(
+          absl::StrCat(journal_file_path, " at offset ", offset, ": ",
+                       GetErrorMessage(result.status_code)));
+    }
+    offset += bytes_deserialized;
+
+    JournalRecord record;
+    record.journal_file_path = std::string(journal_file_path);
+    record.timestamp = timestamp;
+    record.log_status = static_cast<int>(log_status);
+    record.component_id = ToString(component_id);
+    record.log_id = ToString(log_id);
+    record.log_body_size = journal_log.log_body().size();
+    if (component_id == kBudgetKeyProviderId) {
+      DecodeBudgetKeyProviderLog(journal_log.log_body(), std::move(record),
+                                 records);
+    } else if (component_id == kTransactionEngineId) {
+      DecodeTransactionEngineLog(journal_log.log_body(), std::move(record),
+                                 records);
+    } else {
+      record.component = kUnknownComponent;
+      records.push_back(std::move(record));
+    }
+  }
+  return records;
+}
+
+absl::Status StreamJournalRecords(
+    MockBlobStorageClient& storage_client,
+    const std::vector<std::string>& journal_file_paths, size_t parallelism,
+    const JournalRecordFilter& filter,
+    const std::function<void(const JournalRecord&)>& on_record) {
+  parallelism = std::max<size_t>(1, parallelism);
+  const size_t window_size = 2 * parallelism;
+  // The budget keys loaded so far, by id.
+  std::unordered_map<std::string, std::string> budget_key_names;
+
+  for (size_t window_begin = 0; window_begin < journal_file_paths.size();
+       window_begin += window_size) {
+    size_t window_end =
+        std::min(journal_file_paths.size(), window_begin + window_size);
+    std::vector<absl::StatusOr<std::vector<JournalRecord>>> decoded_files(
+        window_end - window_begin, absl::UnknownError("Not decoded"));
+
+    // The files of the window are downloaded and decoded in parallel.
+    std::atomic<size_t> next_file_index(window_begin);
+    auto decode_files = [&]() {
+      for (size_t i = next_file_index++; i < window_end;
+           i = next_file_index++) {
+        auto journal_bytes_buffer =
+            ReadJournalFile(storage_client, journal_file_paths[i]);
+        if (!journal_bytes_buffer.ok()) {
+          decoded_files[i - window_begin] = journal_bytes_buffer.status();
+          continue;
+        }
+        decoded_files[i - window_begin] =
+            DecodeJournalFile(journal_file_paths[i], *journal_bytes_buffer);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::min(parallelism, window_end - window_begin);
+         ++i) {
+      threads.emplace_back(decode_files);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    // The records are emitted in order, since the budget keys are only known
+    // from the provider logs preceding theirs.
+    for (auto& decoded_file : decoded_files) {
+      if (!decoded_file.ok()) {
+        return decoded_file.status();
+      }
+      for (auto& record : *decoded_file) {
+        if (record.component == kBudgetKeyProviderComponent &&
+            !record.budget_key_id.empty()) {
+          budget_key_names[record.budget_key_id] = record.budget_key_name;
+        } else if (record.component == kUnknownComponent) {
+          auto budget_key_name = budget_key_names.find(record.component_id);
+          if (budget_key_name != budget_key_names.end()) {
+            record.component = kBudgetKeyComponent;
+            record.budget_key_id = record.component_id;
+            record.budget_key_name = budget_key_name->second;
+          }
+        }
+        if (filter.Matches(record)) {
+          on_record(record);
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+void WriteJournalRecordCsvHeader(std::ostream& output) {
+  output << "journal_file_path,timestamp,log_status,component,component_id,"
+            "log_id,operation,budget_key_id,budget_key_name,transaction_id,"
+            "log_body_size\n";
+}
+
+void WriteJournalRecordAsCsv(const JournalRecord& record,
+                             std::ostream& output) {
+  WriteCsvField(record.journal_file_path, output);
+  output << ',' << record.timestamp << ',' << record.log_status << ',';
+  WriteCsvField(record.component, output);
+  output << ',';
+  WriteCsvField(record.component_id, output);
+  output << ',';
+  WriteCsvField(record.log_id, output);
+  output << ',';
+  WriteCsvField(record.operation, output);
+  output << ',';
+  WriteCsvField(record.budget_key_id, output);
+  output << ',';
+  WriteCsvField(record.budget_key_name, output);
+  output << ',';
+  WriteCsvField(record.transaction_id, output);
+  output << ',' << record.log_body_size << '\n';
+}
+
 }  // namespace google::scp::pbs
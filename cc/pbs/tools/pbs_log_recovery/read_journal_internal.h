@@ -1,7 +1,13 @@
 #ifndef CC_PBS_TOOLS_PBS_LOG_RECOVERY_READ_JOURNAL_INTERNAL_H_
 #define CC_PBS_TOOLS_PBS_LOG_RECOVERY_READ_JOURNAL_INTERNAL_H_
 
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "cc/core/blob_storage_provider/mock/mock_blob_storage_provider.h"
@@ -14,6 +20,61 @@ absl::StatusOr<core::BytesBuffer> ReadJournalFile(
     absl::string_view journal_file_path,
     absl::BlockingCounter blocker = absl::BlockingCounter(1));
 
+// One decoded log of a journal.
+struct JournalRecord {
+  // The path of the journal file the log was read from.
+  std::string journal_file_path;
+  uint64_t timestamp = 0;
+  // The JournalLogStatus of the log.
+  int log_status = 0;
+  std::string component_id;
+  std::string log_id;
+  // The component that wrote the log: budget_key_provider,
+  // transaction_engine, budget_key, or unknown.
+  std::string component;
+  // What the log records, e.g. LOAD_INTO_CACHE or COMMIT.
+  std::string operation;
+  // The budget key and transaction the log is about, if known.
+  std::string budget_key_id;
+  std::string budget_key_name;
+  std::string transaction_id;
+  uint64_t log_body_size = 0;
+};
+
+// Keeps the records of a budget key and/or a transaction. Empty fields match
+// every record.
+struct JournalRecordFilter {
+  std::string budget_key_name;
+  std::string transaction_id;
+
+  bool Matches(const JournalRecord& record) const;
+};
+
+// Decodes the logs of a journal file, compressed or not. The budget key of the
+// logs written by the budget keys themselves is not known here, see
+// StreamJournalRecords.
+absl::StatusOr<std::vector<JournalRecord>> DecodeJournalFile(
+    absl::string_view journal_file_path,
+    const core::BytesBuffer& journal_bytes_buffer);
+
+// Reads and decodes the journal files with `parallelism` threads, and calls
+// `on_record` with the records matching `filter`, in the order of the files
+// and of the logs within them. At most 2 * `parallelism` decoded files are
+// held in memory at once. The budget keys loaded by the budget key provider
+// logs are remembered so that the logs of those budget keys are attributed to
+// them.
+absl::Status StreamJournalRecords(
+    core::blob_storage_provider::mock::MockBlobStorageClient& storage_client,
+    const std::vector<std::string>& journal_file_paths, size_t parallelism,
+    const JournalRecordFilter& filter,
+    const std::function<void(const JournalRecord&)>& on_record);
+
+// Writes the CSV header of the journal records.
+void WriteJournalRecordCsvHeader(std::ostream& output);
+
+// Writes a journal record as a CSV row.
+void WriteJournalRecordAsCsv(const JournalRecord& record, std::ostream& output);
+
 }  // namespace google::scp::pbs
 
 #endif  // CC_PBS_TOOLS_PBS_LOG_RECOVERY_READ_JOURNAL_INTERNAL_H_
@@ -4,11 +4,19 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "cc/core/blob_storage_provider/mock/mock_blob_storage_provider.h"
+#include "cc/core/journal_service/src/journal_serialization.h"
+#include "cc/core/transaction_manager/src/proto/transaction_engine.pb.h"
+#include "cc/pbs/budget_key_provider/src/proto/budget_key_provider.pb.h"
 #include "cc/public/core/interface/execution_result.h"
 
 namespace google::scp::pbs {
@@ -17,14 +25,85 @@ namespace {
 using ::google::scp::core::AsyncContext;
 using ::google::scp::core::BytesBuffer;
 using ::google::scp::core::ExecutionResult;
+using ::google::scp::core::FailureExecutionResult;
 using ::google::scp::core::GetBlobRequest;
 using ::google::scp::core::GetBlobResponse;
+using ::google::scp::core::JournalLogStatus;
 using ::google::scp::core::SuccessExecutionResult;
 using ::google::scp::core::blob_storage_provider::mock::MockBlobStorageClient;
+using ::google::scp::core::common::Uuid;
+using ::google::scp::core::journal_service::JournalLog;
+using ::google::scp::core::journal_service::JournalSerialization;
+using ::google::scp::core::transaction_manager::proto::TransactionEngineLog;
+using ::google::scp::core::transaction_manager::proto::
+    TransactionEngineLog_1_0;
+using ::google::scp::core::transaction_manager::proto::TransactionLogType;
+using ::google::scp::core::transaction_manager::proto::TransactionPhase;
+using ::google::scp::core::transaction_manager::proto::
+    TransactionPhaseBatchLog_1_0;
+using ::google::scp::pbs::budget_key_provider::proto::BudgetKeyProviderLog;
+using ::google::scp::pbs::budget_key_provider::proto::BudgetKeyProviderLog_1_0;
+using ::google::scp::pbs::budget_key_provider::proto::OperationType;
 using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Field;
 using ::testing::NotNull;
 using ::testing::Return;
 
+constexpr Uuid kBudgetKeyProviderId = {.high = 0xFFFFFFF1, .low = 0x00000002};
+constexpr Uuid kTransactionEngineId = {.high = 0xFFFFFFF1, .low = 0x00000004};
+constexpr Uuid kBudgetKeyId = {.high = 1, .low = 2};
+
+// Appends a log to a journal.
+void AppendLog(BytesBuffer& journal, const Uuid& component_id,
+               const std::string& log_body) {
+  size_t bytes_serialized = 0;
+  ASSERT_TRUE(JournalSerialization::SerializeLogHeader(
+                  journal, journal.length, /*timestamp=*/1234,
+                  JournalLogStatus::Log, component_id, Uuid::GenerateUuid(),
+                  bytes_serialized)
+                  .Successful());
+  journal.length += bytes_serialized;
+  JournalLog journal_log;
+  journal_log.set_log_body(log_body);
+  ASSERT_TRUE(JournalSerialization::SerializeJournalLog(
+                  journal, journal.length, journal_log, bytes_serialized)
+                  .Successful());
+  journal.length += bytes_serialized;
+}
+
+std::string BudgetKeyLoadLog(const std::string& budget_key_name) {
+  BudgetKeyProviderLog_1_0 log_1_0;
+  log_1_0.set_operation_type(OperationType::LOAD_INTO_CACHE);
+  log_1_0.set_budget_key_name(budget_key_name);
+  log_1_0.mutable_id()->set_high(kBudgetKeyId.high);
+  log_1_0.mutable_id()->set_low(kBudgetKeyId.low);
+  BudgetKeyProviderLog log;
+  log.mutable_version()->set_major(1);
+  log.mutable_version()->set_minor(0);
+  log.set_log_body(log_1_0.SerializeAsString());
+  return log.SerializeAsString();
+}
+
+std::string TransactionPhasesLog(const std::vector<Uuid>& transaction_ids,
+                                 TransactionPhase phase) {
+  TransactionPhaseBatchLog_1_0 batch_log;
+  for (const auto& transaction_id : transaction_ids) {
+    auto* phase_log = batch_log.add_phase_logs();
+    phase_log->mutable_id()->set_high(transaction_id.high);
+    phase_log->mutable_id()->set_low(transaction_id.low);
+    phase_log->set_phase(phase);
+  }
+  TransactionEngineLog_1_0 log_1_0;
+  log_1_0.set_type(TransactionLogType::TRANSACTION_PHASE_BATCH_LOG);
+  log_1_0.set_log_body(batch_log.SerializeAsString());
+  TransactionEngineLog log;
+  log.mutable_version()->set_major(1);
+  log.mutable_version()->set_minor(0);
+  log.set_log_body(log_1_0.SerializeAsString());
+  return log.SerializeAsString();
+}
+
 class TestableMockBlobStorageClient : public MockBlobStorageClient {
  public:
   MOCK_METHOD(ExecutionResult, GetBlob,
@@ -57,5 +136,127 @@ TEST(ReadJournalInternalTest, ReadJournalFileTest) {
   ASSERT_TRUE(journal_bytes_buffer.ok());
 }
 
+TEST(ReadJournalInternalTest, DecodeJournalFileDecodesKnownComponents) {
+  auto transaction_id1 = Uuid::GenerateUuid();
+  auto transaction_id2 = Uuid::GenerateUuid();
+  BytesBuffer journal(4096);
+  AppendLog(journal, kBudgetKeyProviderId, BudgetKeyLoadLog("key"));
+  AppendLog(journal, kTransactionEngineId,
+            TransactionPhasesLog({transaction_id1, transaction_id2},
+                                 TransactionPhase::COMMIT));
+  AppendLog(journal, kBudgetKeyId, "budget key log");
+
+  auto records = DecodeJournalFile("journal", journal);
+  ASSERT_TRUE(records.ok()) << records.status();
+  ASSERT_EQ(records->size(), 4);
+  EXPECT_EQ((*records)[0].component, "budget_key_provider");
+  EXPECT_EQ((*records)[0].operation, "LOAD_INTO_CACHE");
+  EXPECT_EQ((*records)[0].budget_key_name, "key");
+  EXPECT_EQ((*records)[0].budget_key_id, core::common::ToString(kBudgetKeyId));
+  EXPECT_EQ((*records)[0].timestamp, 1234);
+  EXPECT_EQ((*records)[1].operation, "COMMIT");
+  EXPECT_EQ((*records)[1].transaction_id,
+            core::common::ToString(transaction_id1));
+  EXPECT_EQ((*records)[2].transaction_id,
+            core::common::ToString(transaction_id2));
+  EXPECT_EQ((*records)[3].component, "unknown");
+  EXPECT_EQ((*records)[3].log_body_size, 14);
+}
+
+TEST(ReadJournalInternalTest, DecodeJournalFileFailsOnCorruptedJournal) {
+  BytesBuffer journal(16);
+  journal.length = 16;
+  EXPECT_FALSE(DecodeJournalFile("journal", journal).ok());
+}
+
+TEST(ReadJournalInternalTest, StreamJournalRecordsFiltersInOrder) {
+  auto transaction_id = Uuid::GenerateUuid();
+  std::unordered_map<std::string, BytesBuffer> journals;
+  std::vector<std::string> journal_file_paths;
+  for (int i = 0; i < 5; ++i) {
+    BytesBuffer journal(4096);
+    if (i == 0) {
+      AppendLog(journal, kBudgetKeyProviderId, BudgetKeyLoadLog("key"));
+    }
+    AppendLog(journal, kBudgetKeyId, absl::StrCat("log ", i));
+    AppendLog(journal, kTransactionEngineId,
+              TransactionPhasesLog({i == 3 ? transaction_id
+                                           : Uuid::GenerateUuid()},
+                                   TransactionPhase::BEGIN));
+    auto journal_file_path = absl::StrCat("journals/journal_", i);
+    journals[absl::StrCat("journal_", i)] = journal;
+    journal_file_paths.push_back(journal_file_path);
+  }
+  MockBlobStorageClient storage_client;
+  storage_client.get_blob_mock =
+      [&journals](AsyncContext<GetBlobRequest, GetBlobResponse>& context) {
+        auto journal = journals.find(*context.request->blob_name);
+        if (journal == journals.end()) {
+          context.result = FailureExecutionResult(SC_UNKNOWN);
+        } else {
+          context.response = std::make_shared<GetBlobResponse>();
+          context.response->buffer =
+              std::make_shared<BytesBuffer>(journal->second);
+          context.result = SuccessExecutionResult();
+        }
+        context.Finish();
+        return SuccessExecutionResult();
+      };
+
+  // The logs of the budget key are attributed to it once it is loaded.
+  std::vector<JournalRecord> records;
+  JournalRecordFilter filter;
+  filter.budget_key_name = "key";
+  ASSERT_TRUE(StreamJournalRecords(
+                  storage_client, journal_file_paths, /*parallelism=*/2,
+                  filter,
+                  [&records](const JournalRecord& record) {
+                    records.push_back(record);
+                  })
+                  .ok());
+  ASSERT_EQ(records.size(), 6);
+  EXPECT_EQ(records[0].component, "budget_key_provider");
+  for (int i = 1; i < 6; ++i) {
+    EXPECT_EQ(records[i].component, "budget_key");
+    EXPECT_EQ(records[i].journal_file_path, journal_file_paths[i - 1]);
+  }
+
+  records.clear();
+  filter = JournalRecordFilter();
+  filter.transaction_id = core::common::ToString(transaction_id);
+  ASSERT_TRUE(StreamJournalRecords(
+                  storage_client, journal_file_paths, /*parallelism=*/4,
+                  filter,
+                  [&records](const JournalRecord& record) {
+                    records.push_back(record);
+                  })
+                  .ok());
+  EXPECT_THAT(records, ElementsAre(Field(&JournalRecord::journal_file_path,
+                                         journal_file_paths[3])));
+
+  // A missing journal fails the stream.
+  journal_file_paths.push_back("journals/missing");
+  EXPECT_FALSE(StreamJournalRecords(storage_client, journal_file_paths,
+                                    /*parallelism=*/4, JournalRecordFilter(),
+                                    [](const JournalRecord&) {})
+                   .ok());
+}
+
+TEST(ReadJournalInternalTest, WriteJournalRecordAsCsvQuotesFields) {
+  JournalRecord record;
+  record.journal_file_path = "journal";
+  record.timestamp = 1;
+  record.log_status = 1;
+  record.component = "budget_key_provider";
+  record.operation = "LOAD_INTO_CACHE";
+  record.budget_key_name = "origin,\"key\"";
+  record.log_body_size = 10;
+  std::ostringstream output;
+  WriteJournalRecordAsCsv(record, output);
+  EXPECT_EQ(output.str(),
+            "journal,1,1,budget_key_provider,,,LOAD_INTO_CACHE,,"
+            "\"origin,\"\"key\"\"\",,10\n");
+}
+
 }  // namespace
 }  // namespace google::scp::pbs
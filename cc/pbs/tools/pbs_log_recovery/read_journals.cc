@@ -0,0 +1,79 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Decodes local journal files into CSV, e.g.
+//
+//   read_journals --journal_files=/tmp/journal_1,/tmp/journal_2 \
+//     --budget_key_name=origin.com/key --output=/tmp/journals.csv
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/log/initialize.h"
+#include "absl/log/log.h"
+#include "cc/core/blob_storage_provider/mock/mock_blob_storage_provider.h"
+#include "cc/pbs/tools/pbs_log_recovery/read_journal_internal.h"
+
+ABSL_FLAG(std::vector<std::string>, journal_files, {},
+          "The journal files to decode, in the order they were written.");
+ABSL_FLAG(int, parallelism, 8,
+          "The number of journal files downloaded and decoded at once.");
+ABSL_FLAG(std::string, budget_key_name, "",
+          "Only outputs the records of this budget key.");
+ABSL_FLAG(std::string, transaction_id, "",
+          "Only outputs the records of this transaction.");
+ABSL_FLAG(std::string, output, "",
+          "The CSV file to write the records to. Defaults to stdout.");
+
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+  absl::InitializeLog();
+
+  std::ofstream output_file;
+  std::ostream* output = &std::cout;
+  if (!absl::GetFlag(FLAGS_output).empty()) {
+    output_file.open(absl::GetFlag(FLAGS_output));
+    QCHECK(output_file.is_open())
+        << "Cannot open " << absl::GetFlag(FLAGS_output);
+    output = &output_file;
+  }
+
+  google::scp::pbs::JournalRecordFilter filter;
+  filter.budget_key_name = absl::GetFlag(FLAGS_budget_key_name);
+  filter.transaction_id = absl::GetFlag(FLAGS_transaction_id);
+
+  google::scp::core::blob_storage_provider::mock::MockBlobStorageClient
+      storage_client;
+  google::scp::pbs::WriteJournalRecordCsvHeader(*output);
+  size_t record_count = 0;
+  auto status = google::scp::pbs::StreamJournalRecords(
+      storage_client, absl::GetFlag(FLAGS_journal_files),
+      absl::GetFlag(FLAGS_parallelism), filter,
+      [output, &record_count](const google::scp::pbs::JournalRecord& record) {
+        google::scp::pbs::WriteJournalRecordAsCsv(record, *output);
+        record_count++;
+      });
+  output->flush();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to decode the journals: " << status;
+    return 1;
+  }
+  LOG(INFO) << "Wrote " << record_count << " records";
+  return 0;
+}
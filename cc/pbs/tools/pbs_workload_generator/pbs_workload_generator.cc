@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <cmath>
 #include <condition_variable>
 #include <cstdlib>
 #include <filesystem>
@@ -26,6 +28,7 @@
 #include <vector>
 
 #include <aws/core/Aws.h>
+#include <nlohmann/json.hpp>
 
 #include "core/async_executor/src/async_executor.h"
 #include "core/common/concurrent_queue/src/concurrent_queue.h"
@@ -99,24 +102,31 @@ using google::scp::pbs::PrivacyBudgetServiceTransactionalClient;
 using std::atomic;
 using std::condition_variable;
 using std::cout;
+using std::discrete_distribution;
 using std::endl;
 using std::getenv;
 using std::ifstream;
 using std::make_shared;
 using std::make_unique;
 using std::mt19937;
+using std::mt19937_64;
 using std::mutex;
+using std::ofstream;
 using std::random_device;
 using std::runtime_error;
 using std::shared_ptr;
 using std::stoul;
 using std::string;
 using std::to_string;
+using std::uniform_int_distribution;
+using std::uniform_real_distribution;
 using std::unique_lock;
 using std::unique_ptr;
 using std::vector;
 using std::chrono::duration_cast;
+using std::chrono::microseconds;
 using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
 using std::chrono::seconds;
 using std::chrono::steady_clock;
 using std::filesystem::path;
@@ -132,16 +142,164 @@ static constexpr size_t kHttp2ConnectionReadTimeoutInSeconds = 5;
 
 static constexpr char kPBSWorkloadGenerator[] = "PBSWorkloadGenerator";
 
+// Number of distinct budget keys the non-unique key distributions draw from
+// when none is configured.
+static constexpr size_t kDefaultKeySpaceSize = 10000;
+
+// Skew of the zipfian key distribution, the YCSB default.
+static constexpr double kZipfianExponent = 0.99;
+
+// Share of the day_boundary traffic that lands on the last hour of the
+// previous day, the rest is charged to the current time.
+static constexpr double kDayBoundarySpikeFraction = 0.5;
+
+static constexpr uint64_t kNanosecondsPerHour = 3600ULL * 1000 * 1000 * 1000;
+static constexpr uint64_t kNanosecondsPerDay = 24 * kNanosecondsPerHour;
+
 namespace google::scp::pbs {
 
 enum class CloudPlatformType { Invalid = 0, GCP = 1, AWS = 2, Local = 3 };
 
+/// How the budget keys of the generated transactions are picked.
+enum class KeyDistributionType {
+  /// Every budget key is used exactly once.
+  Unique = 0,
+  /// Keys are drawn uniformly from the key space.
+  Uniform = 1,
+  /// Keys are drawn from the key space with a zipfian skew, so a few hot keys
+  /// receive most of the traffic.
+  Zipfian = 2,
+  /// Keys are drawn uniformly, but a share of them is charged to the last
+  /// hour of the previous day, as the reports that arrive right after midnight
+  /// are.
+  DayBoundary = 3
+};
+
 struct AppConfiguration {
   size_t total_transactions;
   size_t keys_per_transaction;
   path config_path;
   int64_t duration_in_seconds;
   CloudPlatformType cloud_platform_type;
+  /// 0 runs closed-loop with total_transactions in flight. Otherwise
+  /// transactions are issued open-loop at this rate and total_transactions
+  /// only caps the number in flight.
+  size_t arrival_rate_per_second = 0;
+  KeyDistributionType key_distribution = KeyDistributionType::Unique;
+  string key_distribution_name = "unique";
+  size_t key_space_size = kDefaultKeySpaceSize;
+  string json_output_path;
+};
+
+/**
+ * @brief Latency histogram with the log-linear bucketing of HdrHistogram.
+ * Values below kSubBucketCount are counted exactly, larger values keep
+ * kSubBucketBits bits of precision, i.e. under 1% of relative error, which is
+ * enough to read the tail percentiles without keeping every sample. Recording
+ * is lock free and can be done from any thread.
+ */
+class LatencyHistogram {
+ public:
+  void Record(uint64_t value) noexcept {
+    counts_[GetBucketIndex(value)]++;
+    total_count_++;
+    sum_ += value;
+    auto max_value = max_value_.load();
+    while (value > max_value &&
+           !max_value_.compare_exchange_weak(max_value, value)) {}
+  }
+
+  uint64_t GetTotalCount() const noexcept { return total_count_.load(); }
+
+  uint64_t GetMaxValue() const noexcept { return max_value_.load(); }
+
+  double GetMean() const noexcept {
+    auto total_count = total_count_.load();
+    if (total_count == 0) {
+      return 0;
+    }
+    return sum_.load() / static_cast<double>(total_count);
+  }
+
+  /**
+   * @brief Returns the upper bound of the bucket holding the given percentile
+   * of the recorded values.
+   *
+   * @param percentile A value in (0, 100].
+   */
+  uint64_t GetValueAtPercentile(double percentile) const noexcept {
+    auto total_count = total_count_.load();
+    if (total_count == 0) {
+      return 0;
+    }
+
+    auto target_count = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(percentile / 100 * total_count)));
+    uint64_t seen_count = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      seen_count += counts_[i].load();
+      if (seen_count >= target_count) {
+        return std::min(GetBucketUpperBound(i), max_value_.load());
+      }
+    }
+    return max_value_.load();
+  }
+
+  nlohmann::json ToJson() const noexcept {
+    nlohmann::json json;
+    json["count"] = GetTotalCount();
+    json["mean"] = GetMean();
+    json["p50"] = GetValueAtPercentile(50);
+    json["p90"] = GetValueAtPercentile(90);
+    json["p99"] = GetValueAtPercentile(99);
+    json["p99_9"] = GetValueAtPercentile(99.9);
+    json["p99_99"] = GetValueAtPercentile(99.99);
+    json["max"] = GetMaxValue();
+    return json;
+  }
+
+ private:
+  static constexpr size_t kSubBucketBits = 7;
+  static constexpr uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+  static constexpr uint64_t kSubBucketHalfCount = kSubBucketCount / 2;
+  /// Covers values up to 2^(kMaxShift + kSubBucketBits), i.e. about 12 days
+  /// in microseconds. Larger values are counted in the last bucket.
+  static constexpr size_t kMaxShift = 33;
+  static constexpr size_t kBucketCount =
+      kSubBucketCount + kMaxShift * kSubBucketHalfCount;
+
+  static size_t GetBucketIndex(uint64_t value) noexcept {
+    if (value < kSubBucketCount) {
+      return value;
+    }
+
+    size_t shift = 0;
+    while ((value >> shift) >= kSubBucketCount) {
+      shift++;
+    }
+    if (shift > kMaxShift) {
+      return kBucketCount - 1;
+    }
+    // value >> shift is in [kSubBucketHalfCount, kSubBucketCount).
+    return kSubBucketCount + (shift - 1) * kSubBucketHalfCount +
+           ((value >> shift) - kSubBucketHalfCount);
+  }
+
+  static uint64_t GetBucketUpperBound(size_t index) noexcept {
+    if (index < kSubBucketCount) {
+      return index;
+    }
+
+    auto offset = index - kSubBucketCount;
+    auto shift = offset / kSubBucketHalfCount + 1;
+    auto sub_bucket = offset % kSubBucketHalfCount + kSubBucketHalfCount;
+    return ((sub_bucket + 1) << shift) - 1;
+  }
+
+  std::array<atomic<uint64_t>, kBucketCount> counts_ = {};
+  atomic<uint64_t> total_count_ = 0;
+  atomic<uint64_t> sum_ = 0;
+  atomic<uint64_t> max_value_ = 0;
 };
 
 struct SingleCoordinatorConfig {
@@ -273,6 +431,76 @@ void ReadMultiCoordinatorConfig(const path& config_path,
   }
 }
 
+/**
+ * @brief Picks the budget key name and time bucket of every budget key of the
+ * generated transactions according to the configured key distribution. Only
+ * used by the producer thread.
+ */
+class BudgetKeyGenerator {
+ public:
+  BudgetKeyGenerator(const AppConfiguration& app_configuration,
+                     const string& key_prefix, atomic<uint64_t>& key_index)
+      : key_distribution_(app_configuration.key_distribution),
+        key_prefix_(key_prefix),
+        key_index_(key_index),
+        generator_(random_device()()),
+        uniform_key_distribution_(
+            0, std::max<size_t>(app_configuration.key_space_size, 1) - 1) {
+    if (key_distribution_ == KeyDistributionType::Zipfian) {
+      vector<double> weights(std::max<size_t>(app_configuration.key_space_size,
+                                              1));
+      for (size_t i = 0; i < weights.size(); ++i) {
+        weights[i] = 1 / std::pow(i + 1, kZipfianExponent);
+      }
+      zipfian_key_distribution_ =
+          discrete_distribution<size_t>(weights.begin(), weights.end());
+    }
+  }
+
+  void Generate(ConsumeBudgetMetadata& metadata) noexcept {
+    metadata.time_bucket =
+        TimeProvider::GetWallTimestampInNanosecondsAsClockTicks();
+
+    switch (key_distribution_) {
+      case KeyDistributionType::Unique:
+        metadata.budget_key_name = make_shared<string>(
+            key_prefix_ + "_" + std::to_string(key_index_.fetch_add(1)));
+        return;
+      case KeyDistributionType::Uniform:
+        metadata.budget_key_name =
+            GetKeyName(uniform_key_distribution_(generator_));
+        return;
+      case KeyDistributionType::Zipfian:
+        metadata.budget_key_name =
+            GetKeyName(zipfian_key_distribution_(generator_));
+        return;
+      case KeyDistributionType::DayBoundary:
+        metadata.budget_key_name =
+            GetKeyName(uniform_key_distribution_(generator_));
+        if (spike_distribution_(generator_) < kDayBoundarySpikeFraction) {
+          auto start_of_day =
+              metadata.time_bucket - metadata.time_bucket % kNanosecondsPerDay;
+          metadata.time_bucket = start_of_day - kNanosecondsPerHour;
+        }
+        return;
+    }
+  }
+
+ private:
+  shared_ptr<string> GetKeyName(size_t key_index) const noexcept {
+    return make_shared<string>(key_prefix_ + "_key_" +
+                               std::to_string(key_index));
+  }
+
+  const KeyDistributionType key_distribution_;
+  const string key_prefix_;
+  atomic<uint64_t>& key_index_;
+  mt19937_64 generator_;
+  uniform_int_distribution<size_t> uniform_key_distribution_;
+  discrete_distribution<size_t> zipfian_key_distribution_;
+  uniform_real_distribution<double> spike_distribution_;
+};
+
 mutex mutex_;
 atomic<bool> is_running_;
 unique_ptr<std::thread> working_thread_;
@@ -285,12 +513,24 @@ size_t total_transactions_;
 atomic<int64_t> current_transaction_count_;
 atomic<size_t> total_executed_;
 atomic<size_t> total_failed_;
+// Transactions the open-loop schedule could not issue because too many were
+// already in flight.
+atomic<size_t> total_dropped_;
+
+// Latency from the moment a transaction was sent, in microseconds.
+LatencyHistogram service_latency_histogram_;
+// Latency from the moment the open-loop schedule intended to send a
+// transaction, in microseconds. A stalled client or server delays the sending
+// of the following transactions as well, and this histogram charges that
+// delay to them instead of omitting it.
+LatencyHistogram intended_latency_histogram_;
 
 atomic<uint64_t> transactions_completed_count_;
 atomic<uint64_t> previous_completed_count_;
 
 string prefix_;  // NOLINT
 atomic<uint64_t> index_;
+unique_ptr<BudgetKeyGenerator> key_generator_;
 
 AsyncContext<ConsumeBudgetTransactionRequest, ConsumeBudgetTransactionResponse>
 CreateConsumeBudgetTransaction(const AppConfiguration& app_configuration) {
@@ -311,14 +551,7 @@ CreateConsumeBudgetTransaction(const AppConfiguration& app_configuration) {
 
   for (size_t j = 0; j < app_configuration.keys_per_transaction; ++j) {
     ConsumeBudgetMetadata metadata;
-
-    val = index_.fetch_add(1);
-    shared_ptr<string> key =
-        make_shared<string>(prefix_ + "_" + std::to_string(val));
-
-    metadata.budget_key_name = key;
-    metadata.time_bucket =
-        TimeProvider::GetWallTimestampInNanosecondsAsClockTicks();
+    key_generator_->Generate(metadata);
     metadata.token_count = 1;
     consume_budget_transaction_context.request->budget_keys->push_back(
         metadata);
@@ -367,10 +600,15 @@ void StartProducerThread(
           CreateConsumeBudgetTransaction(app_configuration);
 
       auto original_callback = consume_budget_transaction_context.callback;
+      auto send_time = steady_clock::now();
       consume_budget_transaction_context.callback =
-          [&, original_callback](AsyncContext<ConsumeBudgetTransactionRequest,
-                                              ConsumeBudgetTransactionResponse>&
-                                     consume_budget_transaction_context) {
+          [&, original_callback,
+           send_time](AsyncContext<ConsumeBudgetTransactionRequest,
+                                   ConsumeBudgetTransactionResponse>&
+                          consume_budget_transaction_context) {
+            service_latency_histogram_.Record(
+                duration_cast<microseconds>(steady_clock::now() - send_time)
+                    .count());
             if (consume_budget_transaction_context.result !=
                 SuccessExecutionResult()) {
               total_failed_++;
@@ -400,6 +638,121 @@ void StartProducerThread(
   }
 }
 
+/**
+ * @brief Issues transactions at a constant arrival rate. Unlike the closed
+ * loop, a slow response does not hold back the next transaction, so the
+ * measured latencies reflect the queueing a client with a fixed traffic rate
+ * would see.
+ */
+void StartOpenLoopProducerThread(
+    const AppConfiguration& app_configuration,
+    const shared_ptr<PrivacyBudgetServiceTransactionalClient>& client) {
+  auto interval =
+      nanoseconds(1000 * 1000 * 1000) /
+      static_cast<int64_t>(app_configuration.arrival_rate_per_second);
+  auto schedule_begin = steady_clock::now();
+
+  for (int64_t i = 0;; ++i) {
+    auto intended_time = schedule_begin + i * interval;
+    {
+      unique_lock<mutex> thread_lock(mutex_);
+      condition_variable_.wait_until(thread_lock, intended_time,
+                                     [&]() { return !is_running_; });
+    }
+    if (!is_running_) {
+      break;
+    }
+
+    if (current_transaction_count_.load() >=
+        static_cast<int64_t>(total_transactions_)) {
+      total_dropped_++;
+      continue;
+    }
+
+    auto consume_budget_transaction_context =
+        CreateConsumeBudgetTransaction(app_configuration);
+
+    auto original_callback = consume_budget_transaction_context.callback;
+    auto send_time = steady_clock::now();
+    consume_budget_transaction_context.callback =
+        [&, original_callback, intended_time,
+         send_time](AsyncContext<ConsumeBudgetTransactionRequest,
+                                 ConsumeBudgetTransactionResponse>&
+                        consume_budget_transaction_context) {
+          auto completion_time = steady_clock::now();
+          service_latency_histogram_.Record(
+              duration_cast<microseconds>(completion_time - send_time)
+                  .count());
+          intended_latency_histogram_.Record(
+              duration_cast<microseconds>(completion_time - intended_time)
+                  .count());
+          if (consume_budget_transaction_context.result !=
+              SuccessExecutionResult()) {
+            total_failed_++;
+          }
+
+          total_executed_++;
+          current_transaction_count_--;
+          transactions_completed_count_++;
+          original_callback(consume_budget_transaction_context);
+        };
+
+    current_transaction_count_++;
+    auto execution_result =
+        client->ConsumeBudget(consume_budget_transaction_context);
+
+    if (!execution_result.Successful()) {
+      SCP_ERROR(kPBSWorkloadGenerator, Uuid::GenerateUuid(), execution_result,
+                "Transaction failed to start");
+      current_transaction_count_--;
+    }
+  }
+}
+
+void PrintLatencyHistogram(const string& name,
+                           const LatencyHistogram& histogram) {
+  cout << name << " Latency (Microseconds): p50: "
+       << histogram.GetValueAtPercentile(50)
+       << " p90: " << histogram.GetValueAtPercentile(90)
+       << " p99: " << histogram.GetValueAtPercentile(99)
+       << " p99.9: " << histogram.GetValueAtPercentile(99.9)
+       << " max: " << histogram.GetMaxValue() << endl;
+}
+
+void WriteJsonSummary(const string& reporting_origin,
+                      const AppConfiguration& app_configuration,
+                      double elapsed_seconds, size_t peak_tps) {
+  bool is_open_loop = app_configuration.arrival_rate_per_second > 0;
+  nlohmann::json summary;
+  summary["reporting_origin"] = reporting_origin;
+  summary["mode"] = is_open_loop ? "open_loop" : "closed_loop";
+  summary["arrival_rate_per_second"] =
+      app_configuration.arrival_rate_per_second;
+  summary["max_transactions_in_flight"] = app_configuration.total_transactions;
+  summary["keys_per_transaction"] = app_configuration.keys_per_transaction;
+  summary["key_distribution"] = app_configuration.key_distribution_name;
+  summary["key_space_size"] = app_configuration.key_space_size;
+  summary["elapsed_seconds"] = elapsed_seconds;
+  summary["total_executed"] = total_executed_.load();
+  summary["total_failed"] = total_failed_.load();
+  summary["total_dropped"] = total_dropped_.load();
+  summary["tps"] = elapsed_seconds > 0
+                       ? total_executed_.load() / elapsed_seconds
+                       : 0;
+  summary["peak_tps"] = peak_tps;
+  summary["service_latency_us"] = service_latency_histogram_.ToJson();
+  if (is_open_loop) {
+    summary["intended_latency_us"] = intended_latency_histogram_.ToJson();
+  }
+
+  ofstream output(app_configuration.json_output_path);
+  if (!output.is_open()) {
+    throw runtime_error("Cannot open the JSON output file.");
+  }
+  output << summary.dump(2) << endl;
+  cout << "Summary written to " << app_configuration.json_output_path << endl;
+}
+
 void RunWorkload(
     const string& reporting_origin, const AppConfiguration& app_configuration,
     const shared_ptr<PrivacyBudgetServiceTransactionalClient>& client) {
@@ -416,11 +769,17 @@ void RunWorkload(
   is_running_ = true;
   total_transactions_ = app_configuration.total_transactions;
   prefix_ = generate_random_string();
+  key_generator_ =
+      make_unique<BudgetKeyGenerator>(app_configuration, prefix_, index_);
 
   cout << "Starting the working thread." << endl;
   working_thread_ =
       make_unique<std::thread>([app_configuration, client]() mutable {
-        StartProducerThread(app_configuration, client);
+        if (app_configuration.arrival_rate_per_second > 0) {
+          StartOpenLoopProducerThread(app_configuration, client);
+        } else {
+          StartProducerThread(app_configuration, client);
+        }
       });
 
   auto begin = steady_clock::now();
@@ -483,6 +842,20 @@ void RunWorkload(
          << "\x1b[0m" << endl;
     cout << "\x1b[33mMax TPS: " << peak_tps << "\x1b[0m" << endl;
   }
+  if (total_dropped_ > 0) {
+    cout << "\x1b[31mTotal Dropped: " << total_dropped_.load() << " \x1b[0m"
+         << endl;
+  }
+  PrintLatencyHistogram("Service", service_latency_histogram_);
+  if (app_configuration.arrival_rate_per_second > 0) {
+    PrintLatencyHistogram("Intended", intended_latency_histogram_);
+  }
+  if (!app_configuration.json_output_path.empty()) {
+    WriteJsonSummary(reporting_origin, app_configuration,
+                     duration_cast<milliseconds>(closing_time - begin).count() /
+                         1000.0,
+                     peak_tps);
+  }
 
   if (display_thread.joinable()) {
     display_thread.join();
@@ -584,6 +957,11 @@ void PrintHelp() {
           "for_how_long_in_seconds "
           "cloud_platform_type i.e. aws/gcp/local"
        << std::endl;
+  cout << "In the open-loop mode, i.e. when "
+          "pbs_workload_generator_arrival_rate_per_second is set, "
+          "number_of_transactions is the maximum number of transactions in "
+          "flight."
+       << std::endl;
 }
 
 void StartLogger() {
@@ -600,6 +978,7 @@ void StartLogger() {
 
 using google::scp::pbs::AppConfiguration;
 using google::scp::pbs::CloudPlatformType;
+using google::scp::pbs::KeyDistributionType;
 
 int main(int argc, char** argv) {
   SDKOptions aws_options;
@@ -642,11 +1021,51 @@ int main(int argc, char** argv) {
     http_request_max_retries_count = kHttp2RequestRetryStrategyMaxRetries;
   }
 
+  if (!config_provider
+           .Get(google::scp::pbs::kPBSWorkloadGeneratorArrivalRatePerSecond,
+                app_configuration.arrival_rate_per_second)
+           .Successful()) {
+    app_configuration.arrival_rate_per_second = 0;
+  }
+  if (!config_provider
+           .Get(google::scp::pbs::kPBSWorkloadGeneratorKeySpaceSize,
+                app_configuration.key_space_size)
+           .Successful()) {
+    app_configuration.key_space_size = kDefaultKeySpaceSize;
+  }
+  if (!config_provider
+           .Get(google::scp::pbs::kPBSWorkloadGeneratorJsonOutputPath,
+                app_configuration.json_output_path)
+           .Successful()) {
+    app_configuration.json_output_path.clear();
+  }
+  if (!config_provider
+           .Get(google::scp::pbs::kPBSWorkloadGeneratorKeyDistribution,
+                app_configuration.key_distribution_name)
+           .Successful()) {
+    app_configuration.key_distribution_name = "unique";
+  }
+  if (app_configuration.key_distribution_name == "unique") {
+    app_configuration.key_distribution = KeyDistributionType::Unique;
+  } else if (app_configuration.key_distribution_name == "uniform") {
+    app_configuration.key_distribution = KeyDistributionType::Uniform;
+  } else if (app_configuration.key_distribution_name == "zipfian") {
+    app_configuration.key_distribution = KeyDistributionType::Zipfian;
+  } else if (app_configuration.key_distribution_name == "day_boundary") {
+    app_configuration.key_distribution = KeyDistributionType::DayBoundary;
+  } else {
+    throw runtime_error("Invalid key distribution.");
+  }
+
   cout << "Config path: " << app_configuration.config_path << endl;
   cout << "Total Txns: " << app_configuration.total_transactions << endl;
   cout << "Keys Per Txn: " << app_configuration.keys_per_transaction << endl;
   cout << "Duration in Seconds: " << app_configuration.duration_in_seconds
        << endl;
+  cout << "Arrival Rate Per Second: "
+       << app_configuration.arrival_rate_per_second << endl;
+  cout << "Key Distribution: " << app_configuration.key_distribution_name
+       << endl;
 
   size_t async_executor_thread_count = std::thread::hardware_concurrency() * 2;
   size_t async_executor_queue_cap = 100000;
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -143,5 +145,208 @@ class BatchConsumeBudgetCommandSerialization {
 
     return core::SuccessExecutionResult();
   }
+
+  /**
+   * @brief Serializes batch consume budget command into a bytes buffer, with
+   * the time buckets delta encoded and the token counts run-length encoded.
+   *
+   * @param transaction_id The id of the transaction that is serializing the
+   * batch consume budget command.
+   * @param transaction_command The batch consume budget transaction command to
+   * be serialized.
+   * @param bytes_buffer The bytes buffer to write the serialized transaction
+   * command to.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult SerializeVersion_1_1(
+      const core::common::Uuid& transaction_id,
+      const std::shared_ptr<core::TransactionCommand>& transaction_command,
+      core::BytesBuffer& bytes_buffer) noexcept {
+    if (transaction_command->command_id != kBatchConsumeBudgetCommandId) {
+      return core::FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_COMMAND_SERIALIZER_INVALID_COMMAND_TYPE);
+    }
+
+    auto batch_consume_budget_command =
+        std::static_pointer_cast<BatchConsumeBudgetCommand>(
+            transaction_command);
+
+    pbs::transactions::proto::BatchConsumeBudgetCommand_1_1
+        batch_consume_budget_command_1_1;
+
+    batch_consume_budget_command_1_1.set_budget_key_name(
+        *batch_consume_budget_command->GetBudgetKeyName());
+
+    const auto& budget_consumptions =
+        batch_consume_budget_command->GetBudgetConsumptions();
+    bool has_request_index =
+        std::any_of(budget_consumptions.begin(), budget_consumptions.end(),
+                    [](const ConsumeBudgetCommandRequestInfo& consumption) {
+                      return consumption.request_index.has_value();
+                    });
+    TimeBucket previous_time_bucket = 0;
+    uint64_t previous_request_index = 0;
+    for (const auto& budget_consumption : budget_consumptions) {
+      // The unsigned differences wrap around, and back on deserialization.
+      AppendToRuns(
+          static_cast<int64_t>(budget_consumption.time_bucket -
+                               previous_time_bucket),
+          *batch_consume_budget_command_1_1.mutable_time_bucket_deltas(),
+          *batch_consume_budget_command_1_1
+               .mutable_time_bucket_delta_run_lengths());
+      previous_time_bucket = budget_consumption.time_bucket;
+
+      AppendToRuns(
+          budget_consumption.token_count,
+          *batch_consume_budget_command_1_1.mutable_token_counts(),
+          *batch_consume_budget_command_1_1.mutable_token_count_run_lengths());
+
+      if (has_request_index) {
+        uint64_t request_index = budget_consumption.request_index.has_value()
+                                     ? *budget_consumption.request_index + 1
+                                     : 0;
+        AppendToRuns(
+            static_cast<int64_t>(request_index - previous_request_index),
+            *batch_consume_budget_command_1_1.mutable_request_index_deltas(),
+            *batch_consume_budget_command_1_1
+                 .mutable_request_index_delta_run_lengths());
+        previous_request_index = request_index;
+      }
+    }
+
+    auto size = batch_consume_budget_command_1_1.ByteSizeLong();
+    bytes_buffer.bytes = std::make_shared<std::vector<core::Byte>>(size);
+    bytes_buffer.capacity = size;
+    bytes_buffer.length = size;
+
+    if (!batch_consume_budget_command_1_1.SerializeToArray(
+            bytes_buffer.bytes->data(), size)) {
+      return core::FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_COMMAND_SERIALIZER_SERIALIZATION_FAILED);
+    }
+
+    return core::SuccessExecutionResult();
+  }
+
+  /**
+   * @brief Deserializes batch consume budget command serialized by
+   * SerializeVersion_1_1 from a bytes buffer.
+   *
+   * @param transaction_id The id of the transaction that is deserializing the
+   * batch consume budget command.
+   * @param bytes_buffer The bytes buffer to read the serialized transaction
+   * command from.
+   * @param transaction_command The batch consume budget transaction command to
+   * be deserialized.
+   * @return core::ExecutionResult The execution result of the operation.
+   */
+  static core::ExecutionResult DeserializeVersion_1_1(
+      const core::common::Uuid& transaction_id,
+      const core::BytesBuffer& bytes_buffer,
+      std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
+      std::shared_ptr<BudgetKeyProviderInterface>& budget_key_provider,
+      std::shared_ptr<core::TransactionCommand>& transaction_command) noexcept {
+    pbs::transactions::proto::BatchConsumeBudgetCommand_1_1
+        batch_consume_budget_command_1_1;
+    if (bytes_buffer.length == 0 ||
+        !batch_consume_budget_command_1_1.ParseFromArray(
+            bytes_buffer.bytes->data(), bytes_buffer.length)) {
+      return core::FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_COMMAND_SERIALIZER_DESERIALIZATION_FAILED);
+    }
+
+    std::vector<int64_t> time_bucket_deltas;
+    std::vector<uint32_t> token_counts;
+    std::vector<int64_t> request_index_deltas;
+    if (!ExpandRuns(
+            batch_consume_budget_command_1_1.time_bucket_deltas(),
+            batch_consume_budget_command_1_1.time_bucket_delta_run_lengths(),
+            time_bucket_deltas) ||
+        !ExpandRuns(batch_consume_budget_command_1_1.token_counts(),
+                    batch_consume_budget_command_1_1.token_count_run_lengths(),
+                    token_counts) ||
+        !ExpandRuns(
+            batch_consume_budget_command_1_1.request_index_deltas(),
+            batch_consume_budget_command_1_1.request_index_delta_run_lengths(),
+            request_index_deltas) ||
+        token_counts.size() != time_bucket_deltas.size() ||
+        (!request_index_deltas.empty() &&
+         request_index_deltas.size() != time_bucket_deltas.size())) {
+      return core::FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_COMMAND_SERIALIZER_DESERIALIZATION_FAILED);
+    }
+
+    auto budget_key_name = std::make_shared<BudgetKeyName>(
+        batch_consume_budget_command_1_1.budget_key_name());
+
+    std::vector<ConsumeBudgetCommandRequestInfo> budget_consumptions;
+    budget_consumptions.reserve(time_bucket_deltas.size());
+    TimeBucket time_bucket = 0;
+    uint64_t request_index = 0;
+    for (size_t i = 0; i < time_bucket_deltas.size(); ++i) {
+      time_bucket += static_cast<TimeBucket>(time_bucket_deltas[i]);
+      if (!request_index_deltas.empty()) {
+        request_index += static_cast<uint64_t>(request_index_deltas[i]);
+      }
+      if (request_index > 0) {
+        budget_consumptions.emplace_back(time_bucket, token_counts[i],
+                                         request_index - 1);
+      } else {
+        budget_consumptions.emplace_back(time_bucket, token_counts[i]);
+      }
+    }
+
+    transaction_command = std::make_shared<BatchConsumeBudgetCommand>(
+        transaction_id, budget_key_name, move(budget_consumptions),
+        async_executor, budget_key_provider);
+
+    return core::SuccessExecutionResult();
+  }
+
+ private:
+  /// Appends the value to the run-length encoded values, extending the last
+  /// run when the value repeats it.
+  template <typename TValue, typename TValues, typename TRunLengths>
+  static void AppendToRuns(TValue value, TValues& values,
+                           TRunLengths& run_lengths) noexcept {
+    if (!values.empty() && values[values.size() - 1] == value &&
+        run_lengths[run_lengths.size() - 1] <
+            std::numeric_limits<uint32_t>::max()) {
+      run_lengths[run_lengths.size() - 1]++;
+      return;
+    }
+    values.Add(value);
+    run_lengths.Add(1);
+  }
+
+  /// Expands the run-length encoded values, returns false if they are
+  /// malformed.
+  template <typename TValue, typename TValues, typename TRunLengths>
+  static bool ExpandRuns(const TValues& values, const TRunLengths& run_lengths,
+                         std::vector<TValue>& expanded_values) noexcept {
+    if (values.size() != run_lengths.size()) {
+      return false;
+    }
+    uint64_t count = 0;
+    for (auto run_length : run_lengths) {
+      count += run_length;
+    }
+    if (count > kMaxExpandedValueCount) {
+      return false;
+    }
+    expanded_values.reserve(count);
+    for (int i = 0; i < values.size(); ++i) {
+      expanded_values.insert(expanded_values.end(), run_lengths[i], values[i]);
+    }
+    return true;
+  }
+
+  /// Bounds the values a run-length encoded field expands to, so a malformed
+  /// log fails instead of exhausting the memory.
+  static constexpr uint64_t kMaxExpandedValueCount = 1 << 24;
 };
 }  // namespace google::scp::pbs
@@ -19,6 +19,7 @@
 #include <memory>
 #include <utility>
 
+#include "core/interface/async_executor_interface.h"
 #include "core/interface/transaction_manager_interface.h"
 
 namespace google::scp::pbs {
@@ -60,6 +61,40 @@ class ConsumeBudgetCommandBase : public core::TransactionCommand {
       const std::shared_ptr<core::AsyncExecutorInterface>&
           async_executor) noexcept = 0;
 
+  /**
+   * @brief Runs the prepare, commit, notify and abort phases of the command on
+   * the executor thread owning the shard key, so that the phases of all the
+   * commands on the same budget key share that thread and its cache. Has no
+   * effect when called again.
+   *
+   * @param async_executor the executor to run the phases on.
+   * @param shard_key the shard key, e.g. the hash of the budget key name.
+   */
+  void RouteToBudgetKeyShard(
+      const std::shared_ptr<core::AsyncExecutorInterface>& async_executor,
+      uint64_t shard_key) noexcept {
+    if (routed_to_budget_key_shard_) {
+      return;
+    }
+    routed_to_budget_key_shard_ = true;
+    for (auto* action : {&prepare, &commit, &notify, &abort}) {
+      if (!*action) {
+        continue;
+      }
+      *action = [async_executor, shard_key, handler = std::move(*action)](
+                    core::TransactionCommandCallback& callback) mutable {
+        return async_executor->ScheduleToShard(
+            [handler, callback]() mutable {
+              auto execution_result = handler(callback);
+              if (!execution_result.Successful()) {
+                callback(execution_result);
+              }
+            },
+            core::AsyncPriority::Normal, shard_key);
+      };
+    }
+  }
+
  protected:
   /// The transaction ID associated with the command.
   const core::common::Uuid transaction_id_;
@@ -72,6 +107,9 @@ class ConsumeBudgetCommandBase : public core::TransactionCommand {
   /// budget_key_provider
   std::unique_ptr<core::common::OperationDispatcher> operation_dispatcher_;
 
+  /// Whether the phases are routed to the executor thread of the budget key.
+  bool routed_to_budget_key_shard_ = false;
+
   /// Command's version
   const core::Version version_ = {.major = 1, .minor = 0};
 };
@@ -114,20 +114,28 @@ ExecutionResult TransactionCommandSerializer::
         const Uuid& transaction_id,
         const shared_ptr<TransactionCommand>& transaction_command,
         TransactionCommandLog_1_0& log) const {
-  // Add other versions of BatchConsumeBudget commands if needed.
-  if (batch_consume_budget_command_version_for_serialization_ !=
-      BatchConsumeBudgetCommandVersion::Version_1_0) {
-    return FailureExecutionResult(
-        core::errors::
-            SC_PBS_TRANSACTION_COMMAND_SERIALIZER_INVALID_COMMAND_VERSION);
-  }
-
   BytesBuffer buffer;
-  CommandType command_type = CommandType::BATCH_CONSUME_BUDGET_COMMAND_1_0;
+  CommandType command_type = CommandType::COMMAND_TYPE_UNKNOWN;
+  ExecutionResult execution_result;
+  switch (batch_consume_budget_command_version_for_serialization_) {
+    case BatchConsumeBudgetCommandVersion::Version_1_1:
+      command_type = CommandType::BATCH_CONSUME_BUDGET_COMMAND_1_1;
+      execution_result =
+          BatchConsumeBudgetCommandSerialization::SerializeVersion_1_1(
+              transaction_id, transaction_command, buffer);
+      break;
+    case BatchConsumeBudgetCommandVersion::Version_1_0:
+      command_type = CommandType::BATCH_CONSUME_BUDGET_COMMAND_1_0;
+      execution_result =
+          BatchConsumeBudgetCommandSerialization::SerializeVersion_1_0(
+              transaction_id, transaction_command, buffer);
+      break;
+    default:
+      execution_result = FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_COMMAND_SERIALIZER_INVALID_COMMAND_VERSION);
+  }
 
-  auto execution_result =
-      BatchConsumeBudgetCommandSerialization::SerializeVersion_1_0(
-          transaction_id, transaction_command, buffer);
   if (!execution_result.Successful()) {
     return execution_result;
   }
@@ -244,6 +252,10 @@ ExecutionResult TransactionCommandSerializer::Deserialize(
       return BatchConsumeBudgetCommandSerialization::DeserializeVersion_1_0(
           transaction_id, command_bytes_buffer, async_executor_,
           budget_key_provider_, transaction_command);
+    case CommandType::BATCH_CONSUME_BUDGET_COMMAND_1_1:
+      return BatchConsumeBudgetCommandSerialization::DeserializeVersion_1_1(
+          transaction_id, command_bytes_buffer, async_executor_,
+          budget_key_provider_, transaction_command);
     default:
       return FailureExecutionResult(
           core::errors::
@@ -47,7 +47,8 @@ class TransactionCommandSerializer
    */
   enum class BatchConsumeBudgetCommandVersion {
     Version_Unknown = 0,
-    Version_1_0 = 1
+    Version_1_0 = 1,
+    Version_1_1 = 2
   };
 
   /**
@@ -166,4 +166,127 @@ TEST(BatchConsumeBudgetCommandSerializationTest,
   EXPECT_TRUE(new_batch_consume_budget_command->GetBudgetConsumptions()[1]
                   .request_index.has_value());
 }
+
+TEST(BatchConsumeBudgetCommandSerializationTest,
+     SerializeDeserializeVersion_1_1) {
+  Uuid transaction_id = Uuid::GenerateUuid();
+  auto budget_key_name = make_shared<BudgetKeyName>("budget_key_name");
+
+  vector<ConsumeBudgetCommandRequestInfo> budget_consumptions;
+  budget_consumptions.emplace_back(300, 2, 10);
+  budget_consumptions.emplace_back(400, 2, 1);
+  budget_consumptions.emplace_back(100, 2);
+  budget_consumptions.emplace_back(200, 4, 0);
+  budget_consumptions.emplace_back(UINT64_MAX, 4, 3);
+
+  shared_ptr<BudgetKeyProviderInterface> budget_key_provider;
+  shared_ptr<AsyncExecutorInterface> async_executor;
+
+  shared_ptr<TransactionCommand> batch_consume_budget_command =
+      make_shared<BatchConsumeBudgetCommand>(
+          transaction_id, budget_key_name, move(budget_consumptions),
+          async_executor, budget_key_provider);
+
+  BytesBuffer bytes_buffer;
+  EXPECT_EQ(BatchConsumeBudgetCommandSerialization::SerializeVersion_1_1(
+                transaction_id, batch_consume_budget_command, bytes_buffer),
+            SuccessExecutionResult());
+
+  shared_ptr<TransactionCommand> deserialized_batch_consume_budget_command;
+  EXPECT_EQ(BatchConsumeBudgetCommandSerialization::DeserializeVersion_1_1(
+                transaction_id, bytes_buffer, async_executor,
+                budget_key_provider, deserialized_batch_consume_budget_command),
+            SuccessExecutionResult());
+
+  auto old_batch_consume_budget_command =
+      static_pointer_cast<BatchConsumeBudgetCommand>(
+          batch_consume_budget_command);
+  auto new_batch_consume_budget_command =
+      static_pointer_cast<BatchConsumeBudgetCommand>(
+          deserialized_batch_consume_budget_command);
+  EXPECT_EQ(*new_batch_consume_budget_command->GetBudgetKeyName(),
+            *old_batch_consume_budget_command->GetBudgetKeyName());
+  EXPECT_EQ(new_batch_consume_budget_command->GetBudgetConsumptions(),
+            old_batch_consume_budget_command->GetBudgetConsumptions());
+  const auto& new_budget_consumptions =
+      new_batch_consume_budget_command->GetBudgetConsumptions();
+  EXPECT_EQ(new_budget_consumptions[0].request_index, 10);
+  EXPECT_FALSE(new_budget_consumptions[2].request_index.has_value());
+  EXPECT_EQ(new_budget_consumptions[3].request_index, 0);
+  EXPECT_EQ(new_budget_consumptions[4].time_bucket, UINT64_MAX);
+}
+
+TEST(BatchConsumeBudgetCommandSerializationTest,
+     SerializeVersion_1_1_IsSmallerForConsecutiveTimeBuckets) {
+  Uuid transaction_id = Uuid::GenerateUuid();
+  auto budget_key_name = make_shared<BudgetKeyName>("budget_key_name");
+  shared_ptr<BudgetKeyProviderInterface> budget_key_provider;
+  shared_ptr<AsyncExecutorInterface> async_executor;
+
+  // A thousand consecutive hours, in nanoseconds, consuming one token each.
+  constexpr uint64_t kHourInNanoseconds = 3600000000000;
+  vector<ConsumeBudgetCommandRequestInfo> budget_consumptions;
+  for (size_t i = 0; i < 1000; ++i) {
+    budget_consumptions.emplace_back(
+        1700000000000000000 + i * kHourInNanoseconds, 1, i);
+  }
+
+  shared_ptr<TransactionCommand> batch_consume_budget_command =
+      make_shared<BatchConsumeBudgetCommand>(
+          transaction_id, budget_key_name, move(budget_consumptions),
+          async_executor, budget_key_provider);
+
+  BytesBuffer bytes_buffer_1_0;
+  EXPECT_EQ(BatchConsumeBudgetCommandSerialization::SerializeVersion_1_0(
+                transaction_id, batch_consume_budget_command, bytes_buffer_1_0),
+            SuccessExecutionResult());
+  BytesBuffer bytes_buffer_1_1;
+  EXPECT_EQ(BatchConsumeBudgetCommandSerialization::SerializeVersion_1_1(
+                transaction_id, batch_consume_budget_command, bytes_buffer_1_1),
+            SuccessExecutionResult());
+  EXPECT_LT(bytes_buffer_1_1.length * 100, bytes_buffer_1_0.length);
+
+  shared_ptr<TransactionCommand> deserialized_batch_consume_budget_command;
+  EXPECT_EQ(BatchConsumeBudgetCommandSerialization::DeserializeVersion_1_1(
+                transaction_id, bytes_buffer_1_1, async_executor,
+                budget_key_provider, deserialized_batch_consume_budget_command),
+            SuccessExecutionResult());
+  EXPECT_EQ(static_pointer_cast<BatchConsumeBudgetCommand>(
+                deserialized_batch_consume_budget_command)
+                ->GetBudgetConsumptions(),
+            static_pointer_cast<BatchConsumeBudgetCommand>(
+                batch_consume_budget_command)
+                ->GetBudgetConsumptions());
+}
+
+TEST(BatchConsumeBudgetCommandSerializationTest,
+     DeserializeVersion_1_1_InconsistentRuns) {
+  Uuid transaction_id = Uuid::GenerateUuid();
+  shared_ptr<AsyncExecutorInterface> async_executor;
+  shared_ptr<BudgetKeyProviderInterface> budget_key_provider;
+
+  pbs::transactions::proto::BatchConsumeBudgetCommand_1_1
+      batch_consume_budget_command_1_1;
+  batch_consume_budget_command_1_1.set_budget_key_name("budget_key_name");
+  batch_consume_budget_command_1_1.add_time_bucket_deltas(100);
+  batch_consume_budget_command_1_1.add_time_bucket_delta_run_lengths(2);
+  batch_consume_budget_command_1_1.add_token_counts(1);
+  batch_consume_budget_command_1_1.add_token_count_run_lengths(3);
+
+  auto serialized = batch_consume_budget_command_1_1.SerializeAsString();
+  BytesBuffer bytes_buffer;
+  bytes_buffer.bytes =
+      make_shared<vector<Byte>>(serialized.begin(), serialized.end());
+  bytes_buffer.length = serialized.size();
+  bytes_buffer.capacity = serialized.size();
+
+  shared_ptr<TransactionCommand> batch_consume_budget_command;
+  EXPECT_EQ(
+      BatchConsumeBudgetCommandSerialization::DeserializeVersion_1_1(
+          transaction_id, bytes_buffer, async_executor, budget_key_provider,
+          batch_consume_budget_command),
+      FailureExecutionResult(
+          core::errors::
+              SC_PBS_TRANSACTION_COMMAND_SERIALIZER_DESERIALIZATION_FAILED));
+}
 }  // namespace google::scp::pbs::test
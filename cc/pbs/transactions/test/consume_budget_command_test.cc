@@ -40,6 +40,7 @@
 #include "public/cpio/mock/metric_client/mock_metric_client.h"
 
 using google::scp::core::AsyncContext;
+using google::scp::core::AsyncOperation;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
@@ -885,4 +886,51 @@ TEST(ConsumeBudgetCommandTest, VerifyGetters) {
   EXPECT_EQ(consume_budget_command.GetVersion().minor, 0);
 }
 
+TEST(ConsumeBudgetCommandTest, RouteToBudgetKeyShard) {
+  Uuid transaction_id = Uuid::GenerateUuid();
+  auto budget_key_name = make_shared<BudgetKeyName>("budget_key_name");
+  auto mock_async_executor = make_shared<MockAsyncExecutor>();
+  shared_ptr<AsyncExecutorInterface> async_executor = mock_async_executor;
+  shared_ptr<BudgetKeyProviderInterface> budget_key_provider;
+  ConsumeBudgetCommand consume_budget_command(
+      transaction_id, budget_key_name, ConsumeBudgetCommandRequestInfo{1, 1},
+      async_executor, budget_key_provider);
+
+  vector<uint64_t> shard_keys;
+  mock_async_executor->schedule_to_shard_mock =
+      [&](const AsyncOperation& work, uint64_t shard_key) {
+        shard_keys.push_back(shard_key);
+        work();
+        return SuccessExecutionResult();
+      };
+  consume_budget_command.prepare = [](TransactionCommandCallback& callback) {
+    auto execution_result = SuccessExecutionResult();
+    callback(execution_result);
+    return SuccessExecutionResult();
+  };
+  consume_budget_command.commit = [](TransactionCommandCallback&) {
+    return FailureExecutionResult(1234);
+  };
+  consume_budget_command.RouteToBudgetKeyShard(async_executor, 42);
+  // Routing again does not wrap the phases twice.
+  consume_budget_command.RouteToBudgetKeyShard(async_executor, 42);
+
+  vector<ExecutionResult> results;
+  TransactionCommandCallback callback =
+      [&](ExecutionResult& execution_result) {
+        results.push_back(execution_result);
+      };
+  EXPECT_SUCCESS(consume_budget_command.prepare(callback));
+  // A phase failing to start reports the failure through the callback.
+  EXPECT_SUCCESS(consume_budget_command.commit(callback));
+  EXPECT_EQ(shard_keys, vector<uint64_t>({42, 42}));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_SUCCESS(results[0]);
+  EXPECT_THAT(results[1], ResultIs(FailureExecutionResult(1234)));
+
+  // The begin and end phases are not routed.
+  EXPECT_SUCCESS(consume_budget_command.begin(callback));
+  EXPECT_EQ(shard_keys.size(), 2);
+}
+
 }  // namespace google::scp::pbs::test
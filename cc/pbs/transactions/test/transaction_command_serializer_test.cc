@@ -395,4 +395,52 @@ TEST(TransactionCommandSerializerTest, BatchConsumeBudgetTransactionCommand) {
             old_batch_consume_budget_command->GetVersion());
 }
 
+TEST(TransactionCommandSerializerTest,
+     BatchConsumeBudgetTransactionCommand_1_1) {
+  Uuid transaction_id = Uuid::GenerateUuid();
+  auto budget_key_name = make_shared<BudgetKeyName>("budget_key_name");
+
+  vector<ConsumeBudgetCommandRequestInfo> budget_consumptions;
+  budget_consumptions.emplace_back(100, 2, 0);
+  budget_consumptions.emplace_back(200, 2, 1);
+
+  shared_ptr<BudgetKeyProviderInterface> budget_key_provider;
+  shared_ptr<AsyncExecutorInterface> async_executor;
+
+  shared_ptr<TransactionCommand> batch_consume_budget_command =
+      make_shared<BatchConsumeBudgetCommand>(
+          transaction_id, budget_key_name, move(budget_consumptions),
+          async_executor, budget_key_provider);
+
+  TransactionCommandSerializer transaction_command_serializer(
+      async_executor, budget_key_provider,
+      TransactionCommandSerializer::ConsumeBudgetCommandVersion::Version_1_0,
+      TransactionCommandSerializer::BatchConsumeBudgetCommandVersion::
+          Version_1_1);
+
+  BytesBuffer bytes_buffer;
+  EXPECT_EQ(transaction_command_serializer.Serialize(
+                transaction_id, batch_consume_budget_command, bytes_buffer),
+            SuccessExecutionResult());
+
+  // A serializer still writing 1.0 reads the 1.1 logs.
+  TransactionCommandSerializer transaction_command_deserializer(
+      async_executor, budget_key_provider);
+  shared_ptr<TransactionCommand> deserialized_consume_budget_command;
+  EXPECT_EQ(
+      transaction_command_deserializer.Deserialize(
+          transaction_id, bytes_buffer, deserialized_consume_budget_command),
+      SuccessExecutionResult());
+
+  auto new_batch_consume_budget_command =
+      static_pointer_cast<BatchConsumeBudgetCommand>(
+          deserialized_consume_budget_command);
+  EXPECT_EQ(new_batch_consume_budget_command->command_id,
+            kBatchConsumeBudgetCommandId);
+  EXPECT_EQ(new_batch_consume_budget_command->GetBudgetConsumptions(),
+            static_pointer_cast<BatchConsumeBudgetCommand>(
+                batch_consume_budget_command)
+                ->GetBudgetConsumptions());
+}
+
 }  // namespace google::scp::pbs::test
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,18 @@ struct ExecutableArgument {
   std::string executable_name;
   std::vector<std::string> command_line_args;
   bool restart = true;
+  /// Whether the process is replaced, without downtime, when the launcher gets
+  /// a SIGHUP. The replacement is started, and the process is only drained
+  /// once the replacement is ready.
+  bool hot_restart = false;
+  /// The ports the launcher listens on, and hands the listening sockets of to
+  /// the process.
+  std::vector<uint16_t> listening_ports;
+  /// How long a hot restart waits for the replacement to be ready.
+  int readiness_timeout_seconds = 60;
+  /// How long a hot restart waits for the replaced process to exit after a
+  /// SIGTERM, before killing it.
+  int drain_timeout_seconds = 30;
 
   void ToExecutableVector(std::vector<char*>& cstring_vec) {
     cstring_vec.reserve(command_line_args.size() + 2);
@@ -74,10 +87,31 @@ class JsonArgParser<ExecutableArgument> {
       if (parsed.contains("restart")) {
         parsed_value.restart = parsed["restart"].get<bool>();
       }
+
+      if (parsed.contains("hot_restart")) {
+        parsed_value.hot_restart = parsed["hot_restart"].get<bool>();
+      }
+
+      if (parsed.contains("listening_ports")) {
+        for (auto& port : parsed["listening_ports"]) {
+          parsed_value.listening_ports.push_back(port);
+        }
+      }
+
+      if (parsed.contains("readiness_timeout_seconds")) {
+        parsed_value.readiness_timeout_seconds =
+            parsed["readiness_timeout_seconds"].get<int>();
+      }
+
+      if (parsed.contains("drain_timeout_seconds")) {
+        parsed_value.drain_timeout_seconds =
+            parsed["drain_timeout_seconds"].get<int>();
+      }
     } catch (std::exception& e) {
       std::cerr << "Failed parsing json with: " << e.what() << std::endl;
       parsed_value.executable_name = std::string();
       parsed_value.command_line_args.clear();
+      parsed_value.listening_ports.clear();
       return google::scp::core::FailureExecutionResult(
           google::scp::core::errors::ARGUMENT_PARSER_INVALID_JSON);
     }
@@ -167,5 +167,29 @@ TEST_F(JsonArgParserTest, SucceedWithFalseShouldRecoverFailuresFlag) {
   EXPECT_EQ("/full/path/to/executable2", parsed_value.executable_name);
   EXPECT_EQ(0, parsed_value.command_line_args.size());
   EXPECT_FALSE(parsed_value.restart);
+  EXPECT_FALSE(parsed_value.hot_restart);
+  EXPECT_EQ(0, parsed_value.listening_ports.size());
+}
+
+TEST_F(JsonArgParserTest, SucceedWithHotRestartOptions) {
+  JsonArgParser<ExecutableArgument> parser;
+  ExecutableArgument parsed_value;
+
+  const char* json_string =
+      "{"
+      "\"executable_name\":\"/full/path/to/executable2\","
+      "\"hot_restart\": true,"
+      "\"listening_ports\": [ 8080, 8081 ],"
+      "\"readiness_timeout_seconds\": 10,"
+      "\"drain_timeout_seconds\": 5"
+      "}";
+
+  auto result = parser.Parse(std::string(json_string), parsed_value);
+
+  EXPECT_SUCCESS(result);
+  EXPECT_TRUE(parsed_value.hot_restart);
+  EXPECT_EQ(std::vector<uint16_t>({8080, 8081}), parsed_value.listening_ports);
+  EXPECT_EQ(10, parsed_value.readiness_timeout_seconds);
+  EXPECT_EQ(5, parsed_value.drain_timeout_seconds);
 }
 }  // namespace google::scp::process_launcher::test
@@ -16,11 +16,18 @@
 
 #include "daemonizer.h"
 
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <string>
+#include <vector>
+
+#include "process_launcher/socket_handoff/src/socket_handoff.h"
 
 #include "error_codes.h"
 
@@ -29,6 +36,8 @@ using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::errors::GetErrorMessage;
 
+using google::scp::core::errors::DAEMONIZER_FAILED_CREATING_LISTENING_SOCKETS;
+using google::scp::core::errors::DAEMONIZER_FAILED_LAUNCHING_PROCESS;
 using google::scp::core::errors::DAEMONIZER_FAILED_PARSING_INPUT;
 using google::scp::core::errors::
     DAEMONIZER_FAILED_WAITING_FOR_LAUNCHED_PROCESSES;
@@ -36,6 +45,12 @@ using google::scp::core::errors::DAEMONIZER_INVALID_INPUT;
 using google::scp::core::errors::DAEMONIZER_UNKNOWN_ERROR;
 
 namespace google::scp::process_launcher {
+std::atomic<bool> Daemonizer::hot_restart_requested_(false);
+
+void Daemonizer::RequestHotRestart() noexcept {
+  hot_restart_requested_ = true;
+}
+
 ExecutionResult Daemonizer::Run() noexcept {
   if (executable_count_ < 1) {
     return FailureExecutionResult(DAEMONIZER_INVALID_INPUT);
@@ -49,6 +64,14 @@ ExecutionResult Daemonizer::Run() noexcept {
     return FailureExecutionResult(DAEMONIZER_FAILED_PARSING_INPUT);
   }
 
+  result = CreateListeningSockets();
+  if (!result.Successful()) {
+    std::cerr << "Failed creating the listening sockets with: "
+              << GetErrorMessage(result.status_code) << std::endl;
+
+    return FailureExecutionResult(DAEMONIZER_FAILED_CREATING_LISTENING_SOCKETS);
+  }
+
   executable_arg_to_launch_set_ =
       std::unordered_set<std::shared_ptr<ExecutableArgument>>(
           executable_args_.begin(), executable_args_.end());
@@ -61,36 +84,32 @@ ExecutionResult Daemonizer::Run() noexcept {
         continue;
       }
 
-      std::vector<char*> cstring_vec;
-      exe_arg->ToExecutableVector(cstring_vec);
-      char** args = cstring_vec.data();
-
       pid_t proc_pid = -1;
-      if ((proc_pid = fork()) == 0) {
-        // Child process context
-        // Execute the input process
-        execvp(exe_arg->executable_name.c_str(), args);
-
-        std::cerr << "Failed to start process ["
-                  << exe_arg->executable_name + "] with error ["
-                  << std::strerror(errno) << "]" << std::endl;
-        exit(-1);
+      if (!LaunchProcess(exe_arg, proc_pid).Successful()) {
+        // Launched again after the next process exit.
+        continue;
       }
 
-      std::cout << "Started process [" << exe_arg->executable_name
-                << "] with pid [" << proc_pid << "]" << std::endl;
-
       pid_to_executable_arg_map_[proc_pid] = exe_arg;
       // Since we launched this process, we remove it from the set
       // of processes to start.
       executable_arg_to_launch_set_.erase(exe_arg);
     }
 
+    if (hot_restart_requested_.exchange(false)) {
+      HotRestartProcesses();
+    }
+
     // Wait for any launched process to exit.
     // This call blocks until a child process exits.
     int exit_status;
     pid_t failed_proc_pid = wait(&exit_status);
 
+    if (failed_proc_pid == -1 && errno == EINTR) {
+      // Interrupted by a signal, e.g. the one requesting a hot restart.
+      continue;
+    }
+
     if (failed_proc_pid == -1) {
       return FailureExecutionResult(
           DAEMONIZER_FAILED_WAITING_FOR_LAUNCHED_PROCESSES);
@@ -123,8 +142,8 @@ ExecutionResult Daemonizer::Run() noexcept {
 
     auto failed_process_arg = pid_to_executable_arg_map_[failed_proc_pid];
     // This PID is no longer valid so we remove the mapping from PID to
-    // executable arg
-    pid_to_executable_arg_map_.erase(failed_proc_pid);
+    // executable arg, and its handoff socket
+    RemoveProcess(failed_proc_pid);
     if (failed_process_arg->restart) {
       // Because this process exited we need to launch it again, so we add its
       // executable arg to the set of processes to launch.
@@ -164,6 +183,173 @@ ExecutionResult Daemonizer::GetExecutableArgs() noexcept {
   return SuccessExecutionResult();
 }
 
+ExecutionResult Daemonizer::CreateListeningSockets() noexcept {
+  for (auto& exe_arg : executable_args_) {
+    for (auto port : exe_arg->listening_ports) {
+      int socket_fd = -1;
+      auto result = SocketHandoff::CreateListeningSocket(port, socket_fd);
+      if (!result.Successful()) {
+        return result;
+      }
+
+      std::cout << "Listening on port [" << port << "] for process ["
+                << exe_arg->executable_name << "]" << std::endl;
+      executable_arg_to_listening_sockets_map_[exe_arg].push_back(socket_fd);
+    }
+  }
+
+  return SuccessExecutionResult();
+}
+
+ExecutionResult Daemonizer::LaunchProcess(
+    const std::shared_ptr<ExecutableArgument>& exe_arg,
+    pid_t& proc_pid) noexcept {
+  std::vector<char*> cstring_vec;
+  exe_arg->ToExecutableVector(cstring_vec);
+  char** args = cstring_vec.data();
+
+  // The process gets one end of the handoff socket, its number in the
+  // environment. The daemonizer end must not leak into other processes.
+  int handoff_sockets[2] = {-1, -1};
+  bool hands_off_sockets =
+      exe_arg->hot_restart || !exe_arg->listening_ports.empty();
+  if (hands_off_sockets &&
+      (socketpair(AF_UNIX, SOCK_STREAM, 0, handoff_sockets) != 0 ||
+       fcntl(handoff_sockets[0], F_SETFD, FD_CLOEXEC) != 0)) {
+    std::cerr << "Failed creating the handoff socket of process ["
+              << exe_arg->executable_name << "] with error ["
+              << std::strerror(errno) << "]" << std::endl;
+    close(handoff_sockets[0]);
+    close(handoff_sockets[1]);
+    return FailureExecutionResult(DAEMONIZER_FAILED_LAUNCHING_PROCESS);
+  }
+
+  if ((proc_pid = fork()) == 0) {
+    // Child process context
+    if (hands_off_sockets) {
+      setenv(kHandoffSocketFdEnvironmentVariable,
+             std::to_string(handoff_sockets[1]).c_str(), /*overwrite=*/1);
+    }
+    // Execute the input process
+    execvp(exe_arg->executable_name.c_str(), args);
+
+    std::cerr << "Failed to start process ["
+              << exe_arg->executable_name + "] with error ["
+              << std::strerror(errno) << "]" << std::endl;
+    exit(-1);
+  }
+
+  if (hands_off_sockets) {
+    close(handoff_sockets[1]);
+  }
+
+  if (proc_pid == -1) {
+    std::cerr << "Failed to fork process [" << exe_arg->executable_name
+              << "] with error [" << std::strerror(errno) << "]" << std::endl;
+    if (hands_off_sockets) {
+      close(handoff_sockets[0]);
+    }
+    return FailureExecutionResult(DAEMONIZER_FAILED_LAUNCHING_PROCESS);
+  }
+
+  std::cout << "Started process [" << exe_arg->executable_name
+            << "] with pid [" << proc_pid << "]" << std::endl;
+
+  if (hands_off_sockets) {
+    pid_to_handoff_socket_map_[proc_pid] = handoff_sockets[0];
+    // The socket buffer holds the message until the process receives it.
+    auto result = SocketHandoff::SendFileDescriptors(
+        handoff_sockets[0], executable_arg_to_listening_sockets_map_[exe_arg]);
+    if (!result.Successful()) {
+      std::cerr << "Failed handing off the listening sockets to process with "
+                   "pid ["
+                << proc_pid << "] with: " << GetErrorMessage(result.status_code)
+                << std::endl;
+    }
+  }
+
+  return SuccessExecutionResult();
+}
+
+void Daemonizer::HotRestartProcesses() noexcept {
+  std::vector<pid_t> proc_pids;
+  for (const auto& [proc_pid, exe_arg] : pid_to_executable_arg_map_) {
+    if (exe_arg->hot_restart) {
+      proc_pids.push_back(proc_pid);
+    }
+  }
+
+  for (auto proc_pid : proc_pids) {
+    auto result = HotRestartProcess(proc_pid);
+    if (!result.Successful()) {
+      std::cerr << "Failed hot restarting process with pid [" << proc_pid
+                << "] with: " << GetErrorMessage(result.status_code)
+                << ". Keeping it running." << std::endl;
+    }
+  }
+}
+
+ExecutionResult Daemonizer::HotRestartProcess(pid_t proc_pid) noexcept {
+  auto exe_arg = pid_to_executable_arg_map_[proc_pid];
+  std::cout << "Hot restarting process [" << exe_arg->executable_name
+            << "] with pid [" << proc_pid << "]" << std::endl;
+
+  pid_t new_proc_pid = -1;
+  auto result = LaunchProcess(exe_arg, new_proc_pid);
+  if (!result.Successful()) {
+    return result;
+  }
+  pid_to_executable_arg_map_[new_proc_pid] = exe_arg;
+
+  result = SocketHandoff::WaitForReady(
+      pid_to_handoff_socket_map_[new_proc_pid],
+      std::chrono::seconds(exe_arg->readiness_timeout_seconds));
+  if (!result.Successful()) {
+    kill(new_proc_pid, SIGKILL);
+    waitpid(new_proc_pid, nullptr, 0);
+    RemoveProcess(new_proc_pid);
+    return result;
+  }
+
+  DrainProcess(proc_pid);
+  RemoveProcess(proc_pid);
+  std::cout << "Process [" << exe_arg->executable_name << "] with pid ["
+            << proc_pid << "] was replaced by pid [" << new_proc_pid << "]"
+            << std::endl;
+  return SuccessExecutionResult();
+}
+
+void Daemonizer::DrainProcess(pid_t proc_pid) noexcept {
+  auto exe_arg = pid_to_executable_arg_map_[proc_pid];
+  kill(proc_pid, SIGTERM);
+
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::seconds(exe_arg->drain_timeout_seconds);
+  while (std::chrono::steady_clock::now() < deadline) {
+    pid_t exited_proc_pid = waitpid(proc_pid, nullptr, WNOHANG);
+    if (exited_proc_pid == proc_pid ||
+        (exited_proc_pid == -1 && errno != EINTR)) {
+      return;
+    }
+    usleep(100 * 1000);
+  }
+
+  std::cout << "Process with pid [" << proc_pid
+            << "] did not exit within its drain timeout. Killing it..."
+            << std::endl;
+  kill(proc_pid, SIGKILL);
+  waitpid(proc_pid, nullptr, 0);
+}
+
+void Daemonizer::RemoveProcess(pid_t proc_pid) noexcept {
+  pid_to_executable_arg_map_.erase(proc_pid);
+  auto handoff_socket = pid_to_handoff_socket_map_.find(proc_pid);
+  if (handoff_socket != pid_to_handoff_socket_map_.end()) {
+    close(handoff_socket->second);
+    pid_to_handoff_socket_map_.erase(handoff_socket);
+  }
+}
+
 bool Daemonizer::ShouldStopRestartingProcesses() noexcept {
   return false;
 }
@@ -50,6 +50,12 @@ class Daemonizer {
    */
   google::scp::core::ExecutionResult Run() noexcept;
 
+  /**
+   * @brief Requests the hot restart of the running processes whose executables
+   * have hot_restart set. Can be called from a signal handler.
+   */
+  static void RequestHotRestart() noexcept;
+
  protected:
   int executable_count_ = 0;
   char** executables_;
@@ -59,6 +65,14 @@ class Daemonizer {
       pid_to_executable_arg_map_;
   std::unordered_set<std::shared_ptr<ExecutableArgument>>
       executable_arg_to_launch_set_;
+  /// The listening sockets of each executable, owned by the daemonizer so that
+  /// they outlive the processes they are handed off to.
+  std::unordered_map<std::shared_ptr<ExecutableArgument>, std::vector<int>>
+      executable_arg_to_listening_sockets_map_;
+  /// The daemonizer end of the handoff socket of each launched process.
+  std::unordered_map<pid_t, int> pid_to_handoff_socket_map_;
+  /// Whether a hot restart was requested.
+  static std::atomic<bool> hot_restart_requested_;
 
   /**
    * @brief Turn input into executable args list
@@ -66,6 +80,52 @@ class Daemonizer {
    */
   google::scp::core::ExecutionResult GetExecutableArgs() noexcept;
 
+  /**
+   * @brief Creates the listening sockets of the executables.
+   */
+  google::scp::core::ExecutionResult CreateListeningSockets() noexcept;
+
+  /**
+   * @brief Launches a process of the executable. The listening sockets of the
+   * executable are handed off to it, if it has any or is hot restarted.
+   *
+   * @param exe_arg The executable.
+   * @param proc_pid Set to the pid of the process.
+   */
+  google::scp::core::ExecutionResult LaunchProcess(
+      const std::shared_ptr<ExecutableArgument>& exe_arg,
+      pid_t& proc_pid) noexcept;
+
+  /**
+   * @brief Hot restarts the running processes whose executables have
+   * hot_restart set, one at a time.
+   */
+  void HotRestartProcesses() noexcept;
+
+  /**
+   * @brief Launches the replacement of a process and waits for it to be ready.
+   * Only then is the process drained. If the replacement is not ready in time,
+   * it is killed and the process is kept.
+   *
+   * @param proc_pid The pid of the process.
+   */
+  google::scp::core::ExecutionResult HotRestartProcess(pid_t proc_pid) noexcept;
+
+  /**
+   * @brief Sends SIGTERM to a process and waits for it to exit, up to the drain
+   * timeout of its executable, before killing it.
+   *
+   * @param proc_pid The pid of the process.
+   */
+  void DrainProcess(pid_t proc_pid) noexcept;
+
+  /**
+   * @brief Forgets a process that exited, and closes its handoff socket.
+   *
+   * @param proc_pid The pid of the process.
+   */
+  void RemoveProcess(pid_t proc_pid) noexcept;
+
   /**
    * @brief Whether the daemonizer should stop restarting processes
    *
@@ -36,4 +36,12 @@ DEFINE_ERROR_CODE(DAEMONIZER_FAILED_WAITING_FOR_LAUNCHED_PROCESSES, DAEMONIZER,
 DEFINE_ERROR_CODE(DAEMONIZER_UNKNOWN_ERROR, DAEMONIZER, 0x0004,
                   "The main processing loop exited with an unknown reason.",
                   HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(DAEMONIZER_FAILED_CREATING_LISTENING_SOCKETS, DAEMONIZER,
+                  0x0005, "Failed creating the listening sockets.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(DAEMONIZER_FAILED_LAUNCHING_PROCESS, DAEMONIZER, 0x0006,
+                  "Failed launching a process.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
 }  // namespace google::scp::core::errors
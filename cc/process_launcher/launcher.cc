@@ -31,6 +31,10 @@ void TerminateSignalHandler(int signal_code) {
   // Do not terminate if termination signals are sent to this.
 }
 
+void HotRestartSignalHandler(int signal_code) {
+  Daemonizer::RequestHotRestart();
+}
+
 int main(int argc, char* argv[]) {
   if (argc < 2) {
     throw std::runtime_error("Must provide at least one argument.");
@@ -39,7 +43,12 @@ int main(int argc, char* argv[]) {
   // Process launcher should not be terminated
   signal(SIGINT, TerminateSignalHandler);
   signal(SIGTERM, TerminateSignalHandler);
-  signal(SIGHUP, TerminateSignalHandler);
+  // SIGHUP hot restarts the processes launched with hot_restart. Without
+  // SA_RESTART, the signal interrupts the wait for the processes to exit.
+  struct sigaction hot_restart_action = {};
+  hot_restart_action.sa_handler = HotRestartSignalHandler;
+  sigemptyset(&hot_restart_action.sa_mask);
+  sigaction(SIGHUP, &hot_restart_action, nullptr);
 
   Daemonizer daemonizer(argc - 1, &argv[1]);
   auto result = daemonizer.Run();
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "core/interface/errors.h"
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::core::errors {
+REGISTER_COMPONENT_CODE(SOCKET_HANDOFF, 0x0303)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_NO_HANDOFF_SOCKET, SOCKET_HANDOFF, 0x0001,
+                  "The process was not launched with a handoff socket.",
+                  HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_TOO_MANY_SOCKETS, SOCKET_HANDOFF, 0x0002,
+                  "Too many sockets to hand off.", HttpStatusCode::BAD_REQUEST)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_SEND_FAILED, SOCKET_HANDOFF, 0x0003,
+                  "Failed sending on the handoff socket.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_RECEIVE_FAILED, SOCKET_HANDOFF, 0x0004,
+                  "Failed receiving on the handoff socket.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_READINESS_TIMEOUT, SOCKET_HANDOFF, 0x0005,
+                  "The launched process did not become ready in time.",
+                  HttpStatusCode::REQUEST_TIMEOUT)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_CLOSED_BEFORE_READY, SOCKET_HANDOFF, 0x0006,
+                  "The launched process closed the handoff socket before it "
+                  "became ready.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+
+DEFINE_ERROR_CODE(SOCKET_HANDOFF_FAILED_CREATING_LISTENING_SOCKET,
+                  SOCKET_HANDOFF, 0x0007,
+                  "Failed creating a listening socket.",
+                  HttpStatusCode::INTERNAL_SERVER_ERROR)
+}  // namespace google::scp::core::errors
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "socket_handoff.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "error_codes.h"
+
+using google::scp::core::ExecutionResult;
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::SuccessExecutionResult;
+using google::scp::core::errors::SOCKET_HANDOFF_CLOSED_BEFORE_READY;
+using google::scp::core::errors::
+    SOCKET_HANDOFF_FAILED_CREATING_LISTENING_SOCKET;
+using google::scp::core::errors::SOCKET_HANDOFF_NO_HANDOFF_SOCKET;
+using google::scp::core::errors::SOCKET_HANDOFF_READINESS_TIMEOUT;
+using google::scp::core::errors::SOCKET_HANDOFF_RECEIVE_FAILED;
+using google::scp::core::errors::SOCKET_HANDOFF_SEND_FAILED;
+using google::scp::core::errors::SOCKET_HANDOFF_TOO_MANY_SOCKETS;
+
+namespace {
+/// The data byte of the message carrying the file descriptors.
+constexpr char kFileDescriptorsMessage = 'F';
+/// The data byte of the message telling that the process is ready.
+constexpr char kReadyMessage = 'R';
+}  // namespace
+
+namespace google::scp::process_launcher {
+ExecutionResult SocketHandoff::CreateListeningSocket(uint16_t port,
+                                                     int& socket_fd) noexcept {
+  // The launcher keeps the socket, so it must not leak into the processes it
+  // launches other than through the handoff.
+  socket_fd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (socket_fd < 0) {
+    std::cerr << "Failed creating a listening socket with error ["
+              << std::strerror(errno) << "]" << std::endl;
+    return FailureExecutionResult(
+        SOCKET_HANDOFF_FAILED_CREATING_LISTENING_SOCKET);
+  }
+
+  int enabled = 1;
+  int disabled = 0;
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_addr = in6addr_any;
+  address.sin6_port = htons(port);
+  // Accepts the IPv4 connections too.
+  if (setsockopt(socket_fd, IPPROTO_IPV6, IPV6_V6ONLY, &disabled,
+                 sizeof(disabled)) != 0 ||
+      setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &enabled,
+                 sizeof(enabled)) != 0 ||
+      bind(socket_fd, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(socket_fd, SOMAXCONN) != 0) {
+    std::cerr << "Failed listening on port [" << port << "] with error ["
+              << std::strerror(errno) << "]" << std::endl;
+    close(socket_fd);
+    socket_fd = -1;
+    return FailureExecutionResult(
+        SOCKET_HANDOFF_FAILED_CREATING_LISTENING_SOCKET);
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult SocketHandoff::SendFileDescriptors(
+    int unix_socket_fd, const std::vector<int>& fds) noexcept {
+  if (fds.size() > kMaxHandedOffSocketCount) {
+    return FailureExecutionResult(SOCKET_HANDOFF_TOO_MANY_SOCKETS);
+  }
+
+  char data = kFileDescriptorsMessage;
+  iovec io_vector = {};
+  io_vector.iov_base = &data;
+  io_vector.iov_len = sizeof(data);
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) *
+                                           kMaxHandedOffSocketCount)] = {};
+  msghdr message = {};
+  message.msg_iov = &io_vector;
+  message.msg_iovlen = 1;
+  // A message must carry data, so an empty list of file descriptors is sent
+  // without control data.
+  if (!fds.empty()) {
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+    cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+    control_message->cmsg_level = SOL_SOCKET;
+    control_message->cmsg_type = SCM_RIGHTS;
+    control_message->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    std::memcpy(CMSG_DATA(control_message), fds.data(),
+                sizeof(int) * fds.size());
+  }
+
+  ssize_t sent = 0;
+  do {
+    sent = sendmsg(unix_socket_fd, &message, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent != sizeof(data)) {
+    return FailureExecutionResult(SOCKET_HANDOFF_SEND_FAILED);
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult SocketHandoff::ReceiveFileDescriptors(
+    int unix_socket_fd, std::vector<int>& fds) noexcept {
+  char data = 0;
+  iovec io_vector = {};
+  io_vector.iov_base = &data;
+  io_vector.iov_len = sizeof(data);
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) *
+                                           kMaxHandedOffSocketCount)] = {};
+  msghdr message = {};
+  message.msg_iov = &io_vector;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  ssize_t received = 0;
+  do {
+    received = recvmsg(unix_socket_fd, &message, 0);
+  } while (received < 0 && errno == EINTR);
+  if (received != sizeof(data) || data != kFileDescriptorsMessage ||
+      (message.msg_flags & MSG_CTRUNC) != 0) {
+    return FailureExecutionResult(SOCKET_HANDOFF_RECEIVE_FAILED);
+  }
+
+  fds.clear();
+  for (cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+       control_message != nullptr;
+       control_message = CMSG_NXTHDR(&message, control_message)) {
+    if (control_message->cmsg_level != SOL_SOCKET ||
+        control_message->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    size_t fd_count =
+        (control_message->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    const int* received_fds =
+        reinterpret_cast<const int*>(CMSG_DATA(control_message));
+    fds.insert(fds.end(), received_fds, received_fds + fd_count);
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult SocketHandoff::SendReady(int unix_socket_fd) noexcept {
+  char data = kReadyMessage;
+  ssize_t sent = 0;
+  do {
+    sent = send(unix_socket_fd, &data, sizeof(data), MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent != sizeof(data)) {
+    return FailureExecutionResult(SOCKET_HANDOFF_SEND_FAILED);
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResult SocketHandoff::WaitForReady(
+    int unix_socket_fd, std::chrono::milliseconds timeout) noexcept {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      return FailureExecutionResult(SOCKET_HANDOFF_READINESS_TIMEOUT);
+    }
+
+    pollfd poll_fd = {};
+    poll_fd.fd = unix_socket_fd;
+    poll_fd.events = POLLIN;
+    int poll_result = poll(&poll_fd, 1, static_cast<int>(remaining.count()));
+    if (poll_result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (poll_result < 0) {
+      return FailureExecutionResult(SOCKET_HANDOFF_RECEIVE_FAILED);
+    }
+    if (poll_result == 0) {
+      return FailureExecutionResult(SOCKET_HANDOFF_READINESS_TIMEOUT);
+    }
+
+    char data = 0;
+    ssize_t received = recv(unix_socket_fd, &data, sizeof(data), 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return FailureExecutionResult(SOCKET_HANDOFF_CLOSED_BEFORE_READY);
+    }
+    if (data == kReadyMessage) {
+      return SuccessExecutionResult();
+    }
+  }
+}
+
+ExecutionResult SocketHandoff::ReceiveListeningSockets(
+    std::vector<int>& listening_sockets) noexcept {
+  int unix_socket_fd = -1;
+  auto execution_result = GetHandoffSocket(unix_socket_fd);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  return ReceiveFileDescriptors(unix_socket_fd, listening_sockets);
+}
+
+ExecutionResult SocketHandoff::NotifyReady() noexcept {
+  int unix_socket_fd = -1;
+  auto execution_result = GetHandoffSocket(unix_socket_fd);
+  if (!execution_result.Successful()) {
+    return execution_result;
+  }
+  execution_result = SendReady(unix_socket_fd);
+  close(unix_socket_fd);
+  unsetenv(kHandoffSocketFdEnvironmentVariable);
+  return execution_result;
+}
+
+ExecutionResult SocketHandoff::GetHandoffSocket(int& unix_socket_fd) noexcept {
+  const char* fd_string = std::getenv(kHandoffSocketFdEnvironmentVariable);
+  if (fd_string == nullptr) {
+    return FailureExecutionResult(SOCKET_HANDOFF_NO_HANDOFF_SOCKET);
+  }
+  char* fd_string_end = nullptr;
+  long fd = std::strtol(fd_string, &fd_string_end, 10);
+  if (fd_string_end == fd_string || *fd_string_end != '\0' || fd < 0) {
+    return FailureExecutionResult(SOCKET_HANDOFF_NO_HANDOFF_SOCKET);
+  }
+  unix_socket_fd = static_cast<int>(fd);
+  return SuccessExecutionResult();
+}
+}  // namespace google::scp::process_launcher
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "public/core/interface/execution_result.h"
+
+namespace google::scp::process_launcher {
+/// The environment variable holding the file descriptor of the handoff socket
+/// of a launched process.
+inline constexpr char kHandoffSocketFdEnvironmentVariable[] =
+    "SCP_PROCESS_LAUNCHER_HANDOFF_FD";
+/// The max number of sockets handed off to a launched process.
+inline constexpr size_t kMaxHandedOffSocketCount = 16;
+
+/**
+ * @brief Hands off the listening sockets of the process launcher to the
+ * processes it launches, over a unix socket pair with SCM_RIGHTS.
+ *
+ * The launcher owns the listening sockets, so they stay open while a process is
+ * replaced, and the connections queue in their backlog instead of being
+ * refused. A launched process receives the sockets with
+ * ReceiveListeningSockets(), and calls NotifyReady() once it serves them. Only
+ * then does a hot restart drain the process being replaced.
+ */
+class SocketHandoff {
+ public:
+  /**
+   * @brief Creates a listening TCP socket on all the addresses of the port.
+   *
+   * @param port The port, 0 for any port.
+   * @param socket_fd Set to the listening socket.
+   */
+  static core::ExecutionResult CreateListeningSocket(uint16_t port,
+                                                     int& socket_fd) noexcept;
+
+  /// Sends the file descriptors over the unix socket, in a single message.
+  static core::ExecutionResult SendFileDescriptors(
+      int unix_socket_fd, const std::vector<int>& fds) noexcept;
+
+  /// Receives the file descriptors of a single message of the unix socket.
+  static core::ExecutionResult ReceiveFileDescriptors(
+      int unix_socket_fd, std::vector<int>& fds) noexcept;
+
+  /// Tells the peer of the unix socket that the process is ready.
+  static core::ExecutionResult SendReady(int unix_socket_fd) noexcept;
+
+  /**
+   * @brief Waits for the peer of the unix socket to be ready.
+   *
+   * @param unix_socket_fd The unix socket.
+   * @param timeout The max time to wait.
+   * @return core::ExecutionResult Fails if the peer times out, or closes the
+   * socket without being ready, e.g. because it exited.
+   */
+  static core::ExecutionResult WaitForReady(
+      int unix_socket_fd, std::chrono::milliseconds timeout) noexcept;
+
+  /**
+   * @brief Receives the listening sockets handed off by the process launcher,
+   * in a process it launched.
+   *
+   * @param listening_sockets Set to the listening sockets, in the order of the
+   * listening ports of the executable.
+   */
+  static core::ExecutionResult ReceiveListeningSockets(
+      std::vector<int>& listening_sockets) noexcept;
+
+  /// Tells the process launcher that the process it launched is ready, and
+  /// closes the handoff socket.
+  static core::ExecutionResult NotifyReady() noexcept;
+
+ private:
+  /// Gets the handoff socket from the environment of a launched process.
+  static core::ExecutionResult GetHandoffSocket(int& unix_socket_fd) noexcept;
+};
+}  // namespace google::scp::process_launcher
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "process_launcher/socket_handoff/src/socket_handoff.h"
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "process_launcher/socket_handoff/src/error_codes.h"
+#include "public/core/interface/execution_result.h"
+#include "public/core/test/interface/execution_result_matchers.h"
+
+using google::scp::core::FailureExecutionResult;
+using google::scp::core::errors::SOCKET_HANDOFF_CLOSED_BEFORE_READY;
+using google::scp::core::errors::SOCKET_HANDOFF_NO_HANDOFF_SOCKET;
+using google::scp::core::errors::SOCKET_HANDOFF_READINESS_TIMEOUT;
+using google::scp::core::errors::SOCKET_HANDOFF_TOO_MANY_SOCKETS;
+using google::scp::core::test::ResultIs;
+
+namespace google::scp::process_launcher::test {
+class SocketHandoffTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, unix_sockets_), 0);
+  }
+
+  void TearDown() override {
+    close(unix_sockets_[0]);
+    close(unix_sockets_[1]);
+  }
+
+  static uint16_t GetPort(int socket_fd) {
+    sockaddr_in6 address = {};
+    socklen_t address_length = sizeof(address);
+    getsockname(socket_fd, reinterpret_cast<sockaddr*>(&address),
+                &address_length);
+    return ntohs(address.sin6_port);
+  }
+
+  int unix_sockets_[2];
+};
+
+TEST_F(SocketHandoffTest, ReceivesTheListeningSocketsSent) {
+  int listening_socket1 = -1;
+  int listening_socket2 = -1;
+  EXPECT_SUCCESS(SocketHandoff::CreateListeningSocket(0, listening_socket1));
+  EXPECT_SUCCESS(SocketHandoff::CreateListeningSocket(0, listening_socket2));
+
+  EXPECT_SUCCESS(SocketHandoff::SendFileDescriptors(
+      unix_sockets_[0], {listening_socket1, listening_socket2}));
+  std::vector<int> received_sockets;
+  EXPECT_SUCCESS(SocketHandoff::ReceiveFileDescriptors(unix_sockets_[1],
+                                                      received_sockets));
+
+  // The received file descriptors are new ones, of the same sockets.
+  ASSERT_EQ(received_sockets.size(), 2);
+  EXPECT_NE(received_sockets[0], listening_socket1);
+  EXPECT_EQ(GetPort(received_sockets[0]), GetPort(listening_socket1));
+  EXPECT_EQ(GetPort(received_sockets[1]), GetPort(listening_socket2));
+  for (int socket_fd : {listening_socket1, listening_socket2,
+                        received_sockets[0], received_sockets[1]}) {
+    close(socket_fd);
+  }
+}
+
+TEST_F(SocketHandoffTest, ReceivesNoFileDescriptorsIfNoneWereSent) {
+  EXPECT_SUCCESS(SocketHandoff::SendFileDescriptors(unix_sockets_[0], {}));
+  std::vector<int> received_fds = {1};
+  EXPECT_SUCCESS(
+      SocketHandoff::ReceiveFileDescriptors(unix_sockets_[1], received_fds));
+  EXPECT_TRUE(received_fds.empty());
+}
+
+TEST_F(SocketHandoffTest, CannotSendTooManyFileDescriptors) {
+  std::vector<int> fds(kMaxHandedOffSocketCount + 1, unix_sockets_[0]);
+  EXPECT_THAT(
+      SocketHandoff::SendFileDescriptors(unix_sockets_[0], fds),
+      ResultIs(FailureExecutionResult(SOCKET_HANDOFF_TOO_MANY_SOCKETS)));
+}
+
+TEST_F(SocketHandoffTest, WaitForReadySucceedsOnceThePeerIsReady) {
+  EXPECT_THAT(SocketHandoff::WaitForReady(unix_sockets_[0],
+                                          std::chrono::milliseconds(10)),
+              ResultIs(FailureExecutionResult(
+                  SOCKET_HANDOFF_READINESS_TIMEOUT)));
+
+  EXPECT_SUCCESS(SocketHandoff::SendReady(unix_sockets_[1]));
+  EXPECT_SUCCESS(SocketHandoff::WaitForReady(unix_sockets_[0],
+                                             std::chrono::seconds(10)));
+}
+
+TEST_F(SocketHandoffTest, WaitForReadyFailsIfThePeerClosesTheSocket) {
+  close(unix_sockets_[1]);
+  unix_sockets_[1] = -1;
+  EXPECT_THAT(
+      SocketHandoff::WaitForReady(unix_sockets_[0], std::chrono::seconds(10)),
+      ResultIs(FailureExecutionResult(SOCKET_HANDOFF_CLOSED_BEFORE_READY)));
+}
+
+TEST_F(SocketHandoffTest, ReceivesTheListeningSocketsOfTheHandoffSocket) {
+  std::vector<int> listening_sockets;
+  unsetenv(kHandoffSocketFdEnvironmentVariable);
+  EXPECT_THAT(
+      SocketHandoff::ReceiveListeningSockets(listening_sockets),
+      ResultIs(FailureExecutionResult(SOCKET_HANDOFF_NO_HANDOFF_SOCKET)));
+
+  int listening_socket = -1;
+  EXPECT_SUCCESS(SocketHandoff::CreateListeningSocket(0, listening_socket));
+  EXPECT_SUCCESS(
+      SocketHandoff::SendFileDescriptors(unix_sockets_[0], {listening_socket}));
+  setenv(kHandoffSocketFdEnvironmentVariable,
+         std::to_string(unix_sockets_[1]).c_str(), /*overwrite=*/1);
+  EXPECT_SUCCESS(SocketHandoff::ReceiveListeningSockets(listening_sockets));
+  ASSERT_EQ(listening_sockets.size(), 1);
+  EXPECT_EQ(GetPort(listening_sockets[0]), GetPort(listening_socket));
+
+  // Notifying the readiness closes the handoff socket.
+  EXPECT_SUCCESS(SocketHandoff::NotifyReady());
+  unix_sockets_[1] = -1;
+  EXPECT_SUCCESS(SocketHandoff::WaitForReady(unix_sockets_[0],
+                                             std::chrono::seconds(10)));
+  EXPECT_EQ(getenv(kHandoffSocketFdEnvironmentVariable), nullptr);
+  close(listening_socket);
+  close(listening_sockets[0]);
+}
+}  // namespace google::scp::process_launcher::test
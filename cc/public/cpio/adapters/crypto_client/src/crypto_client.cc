@@ -24,6 +24,7 @@
 #include "core/interface/errors.h"
 #include "core/utils/src/error_utils.h"
 #include "cpio/client_providers/crypto_client_provider/src/crypto_client_provider.h"
+#include "cpio/client_providers/global_cpio/src/global_cpio.h"
 #include "public/core/interface/execution_result.h"
 #include "public/cpio/adapters/common/adapter_utils.h"
 #include "public/cpio/proto/crypto_service/v1/crypto_service.pb.h"
@@ -32,16 +33,20 @@ using google::cmrt::sdk::crypto_service::v1::AeadDecryptRequest;
 using google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::AeadEncryptRequest;
 using google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest;
+using google::cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::HpkeDecryptRequest;
 using google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
 using google::cmrt::sdk::crypto_service::v1::HpkeEncryptRequest;
 using google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
+using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::ExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::common::kZeroUuid;
 using google::scp::core::utils::ConvertToPublicExecutionResult;
 using google::scp::cpio::client_providers::CryptoClientProvider;
 using google::scp::cpio::client_providers::CryptoClientProviderInterface;
+using google::scp::cpio::client_providers::GlobalCpio;
 using std::bind;
 using std::make_shared;
 using std::make_unique;
@@ -55,7 +60,17 @@ constexpr char kCryptoClient[] = "CryptoClient";
 namespace google::scp::cpio {
 CryptoClient::CryptoClient(const std::shared_ptr<CryptoClientOptions>& options)
     : options_(options) {
-  crypto_client_provider_ = make_shared<CryptoClientProvider>(options_);
+  // CryptoClient does not need CPIO. When it is initialized, the batch
+  // decryptions run on its CPU executor.
+  shared_ptr<AsyncExecutorInterface> cpu_async_executor;
+  if (GlobalCpio::GetGlobalCpio() &&
+      !GlobalCpio::GetGlobalCpio()
+           ->GetCpuAsyncExecutor(cpu_async_executor)
+           .Successful()) {
+    cpu_async_executor = nullptr;
+  }
+  crypto_client_provider_ =
+      make_shared<CryptoClientProvider>(options_, cpu_async_executor);
 }
 
 ExecutionResult CryptoClient::Init() noexcept {
@@ -103,6 +118,15 @@ core::ExecutionResult CryptoClient::HpkeDecrypt(
       request, callback);
 }
 
+core::ExecutionResult CryptoClient::BatchHpkeDecrypt(
+    BatchHpkeDecryptRequest request,
+    Callback<BatchHpkeDecryptResponse> callback) noexcept {
+  return Execute<BatchHpkeDecryptRequest, BatchHpkeDecryptResponse>(
+      bind(&CryptoClientProviderInterface::BatchHpkeDecrypt,
+           crypto_client_provider_, _1),
+      request, callback);
+}
+
 core::ExecutionResult CryptoClient::AeadEncrypt(
     AeadEncryptRequest request,
     Callback<AeadEncryptResponse> callback) noexcept {
@@ -46,6 +46,11 @@ class CryptoClient : public CryptoClientInterface {
       Callback<cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>
           callback) noexcept override;
 
+  core::ExecutionResult BatchHpkeDecrypt(
+      cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest request,
+      Callback<cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse>
+          callback) noexcept override;
+
   core::ExecutionResult AeadEncrypt(
       cmrt::sdk::crypto_service::v1::AeadEncryptRequest request,
       Callback<cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
@@ -32,6 +32,8 @@
 
 using google::cmrt::sdk::parameter_service::v1::GetParameterRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterResponse;
+using google::cmrt::sdk::parameter_service::v1::GetParametersRequest;
+using google::cmrt::sdk::parameter_service::v1::GetParametersResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::ExecutionResult;
@@ -124,6 +126,15 @@ core::ExecutionResult ParameterClient::GetParameter(
       request, callback);
 }
 
+core::ExecutionResult ParameterClient::GetParameters(
+    GetParametersRequest request,
+    Callback<GetParametersResponse> callback) noexcept {
+  return Execute<GetParametersRequest, GetParametersResponse>(
+      bind(&ParameterClientProviderInterface::GetParameters,
+           parameter_client_provider_, _1),
+      request, callback);
+}
+
 std::unique_ptr<ParameterClientInterface> ParameterClientFactory::Create(
     ParameterClientOptions options) {
   return make_unique<ParameterClient>(
@@ -44,6 +44,11 @@ class ParameterClient : public ParameterClientInterface {
       Callback<cmrt::sdk::parameter_service::v1::GetParameterResponse>
           callback) noexcept override;
 
+  core::ExecutionResult GetParameters(
+      cmrt::sdk::parameter_service::v1::GetParametersRequest request,
+      Callback<cmrt::sdk::parameter_service::v1::GetParametersResponse>
+          callback) noexcept override;
+
  protected:
   virtual core::ExecutionResult CreateParameterClientProvider() noexcept;
   std::shared_ptr<client_providers::ParameterClientProviderInterface>
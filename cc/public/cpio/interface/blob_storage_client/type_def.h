@@ -30,6 +30,35 @@ struct BlobStorageClientOptions {
   std::chrono::seconds transfer_stall_timeout = std::chrono::seconds(60 * 2);
   // GCP - How many retries should be used for blob storage operations.
   size_t retry_limit = 3;
+  // GCP - Whether to use the gRPC transport of Cloud Storage instead of its
+  // JSON API.
+  bool use_grpc_transport = false;
+  // GCP - Whether the gRPC transport connects through DirectPath, bypassing
+  // the Google front ends from GCE. Only used with use_grpc_transport.
+  bool use_direct_path = false;
+  // GCP - The number of gRPC channels of the client. 0 keeps the default of
+  // the client library. Only used with use_grpc_transport.
+  size_t grpc_channel_count = 0;
+  // The size in bytes of the ranges GetBlob downloads in parallel. 0 downloads
+  // the blob with a single request.
+  size_t get_blob_part_size_bytes = 0;
+  // The max number of ranges of a single GetBlob downloaded at once. Only used
+  // when get_blob_part_size_bytes is set.
+  size_t get_blob_max_concurrent_parts = 8;
+  // The size in bytes of the parts PutBlobStream coalesces the portions into
+  // and uploads in parallel. 0 uploads the parts one at a time as they are
+  // streamed. Raised to the 5MiB minimum of S3 on AWS.
+  size_t put_blob_stream_part_size_bytes = 0;
+  // The max number of parts of a single PutBlobStream uploaded at once. Only
+  // used when put_blob_stream_part_size_bytes is set.
+  size_t put_blob_stream_max_concurrent_parts = 4;
+  // AWS - The size in bytes of the parts PutBlob uploads the data larger than
+  // it in, in parallel, as a multipart upload. 0 uploads the data with a single
+  // request. Raised to the 5MiB minimum of S3.
+  size_t put_blob_part_size_bytes = 0;
+  // AWS - The max number of parts of a single PutBlob uploaded at once. Only
+  // used when put_blob_part_size_bytes is set.
+  size_t put_blob_max_concurrent_parts = 8;
 
   virtual ~BlobStorageClientOptions() = default;
 };
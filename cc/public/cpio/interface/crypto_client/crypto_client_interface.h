@@ -65,6 +65,20 @@ class CryptoClientInterface : public core::ServiceInterface {
       Callback<cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>
           callback) noexcept = 0;
 
+  /**
+   * @brief Decrypts many payloads encrypted with the same private key using
+   * HPKE. The key is parsed once, and the payloads are decrypted in parallel.
+   *
+   * @param request request for the call.
+   * @param callback callback will be triggered when the call completes
+   * including when the call fails.
+   * @return core::ExecutionResult scheduling result returned synchronously.
+   */
+  virtual core::ExecutionResult BatchHpkeDecrypt(
+      cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest request,
+      Callback<cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse>
+          callback) noexcept = 0;
+
   /**
    * @brief Encrypts payload using Aead.
    *
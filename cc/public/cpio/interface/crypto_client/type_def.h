@@ -17,6 +17,8 @@
 #ifndef SCP_CPIO_INTERFACE_CRYPTO_CLIENT_TYPE_DEF_H_
 #define SCP_CPIO_INTERFACE_CRYPTO_CLIENT_TYPE_DEF_H_
 
+#include <cstddef>
+
 #include "public/cpio/proto/crypto_service/v1/crypto_service.pb.h"
 
 namespace google::scp::cpio {
@@ -27,6 +29,10 @@ struct CryptoClientOptions {
 
   // Parameters to be used for encrypt/decrypt data using HPKE.
   cmrt::sdk::crypto_service::v1::HpkeParams hpke_params;
+
+  // How many parsed HPKE private keys are kept, by key ID, so that the
+  // decryptions with a known key do not parse it again. Zero disables it.
+  size_t hpke_private_key_cache_capacity = 0;
 };
 
 }  // namespace google::scp::cpio
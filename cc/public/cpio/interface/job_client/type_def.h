@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -33,5 +35,19 @@ struct JobClientOptions {
 
   // The Spanner Database to use for GCP. Unused for AWS.
   std::string gcp_spanner_database_name;
+
+  // How many jobs GetNextJob prefetches into a local buffer, their messages
+  // leased and their items read in batches. Zero, the default, gets the jobs
+  // one at a time.
+  size_t get_next_job_prefetch_count = 0;
+
+  // How long GetNextJob waits for a job message when the queue is empty, in
+  // seconds, i.e. a long poll. Zero returns right away.
+  int32_t get_next_job_wait_time_seconds = 0;
+
+  // The visibility timeout of the prefetched job messages while in the
+  // buffer, in seconds. The jobs with less than half of it left are not
+  // handed out, as their messages may be received again.
+  int32_t prefetched_job_visibility_timeout_seconds = 120;
 };
 }  // namespace google::scp::cpio
@@ -17,10 +17,24 @@
 #ifndef SCP_CPIO_INTERFACE_KMS_CLIENT_TYPE_DEF_H_
 #define SCP_CPIO_INTERFACE_KMS_CLIENT_TYPE_DEF_H_
 
+#include <cstddef>
+#include <cstdint>
+
 namespace google::scp::cpio {
 /// Configurations for KmsClient.
 struct KmsClientOptions {
   virtual ~KmsClientOptions() = default;
+
+  /// How long the plaintexts decrypted by KMS are cached in memory, keyed by
+  /// the decryption request, in seconds. Zero, the default, disables the
+  /// cache. Identical concurrent decryptions always share a single KMS call.
+  uint64_t decrypt_result_cache_ttl_seconds = 0;
+  /// The maximum number of cached plaintexts.
+  size_t decrypt_result_cache_capacity = 1000;
+  /// Whether the AWS enclave KMS client decrypts in process with the Nitro
+  /// Enclaves SDK, reusing its attestation key pair and vsock connection,
+  /// instead of running kmstool_enclave_cli for each ciphertext.
+  bool enable_in_process_enclaves_decryption = false;
 };
 }  // namespace google::scp::cpio
 
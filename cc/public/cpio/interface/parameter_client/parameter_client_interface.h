@@ -52,6 +52,20 @@ class ParameterClientInterface : public core::ServiceInterface {
       cmrt::sdk::parameter_service::v1::GetParameterRequest request,
       Callback<cmrt::sdk::parameter_service::v1::GetParameterResponse>
           callback) noexcept = 0;
+
+  /**
+   * @brief Gets parameter values for the given names in as few round trips as
+   * possible. Parameters which do not exist are omitted from the response.
+   *
+   * @param request request for the call.
+   * @param callback callback will be triggered when the call completes
+   * including when the call fails.
+   * @return core::ExecutionResult scheduling result returned synchronously.
+   */
+  virtual core::ExecutionResult GetParameters(
+      cmrt::sdk::parameter_service::v1::GetParametersRequest request,
+      Callback<cmrt::sdk::parameter_service::v1::GetParametersResponse>
+          callback) noexcept = 0;
 };
 
 /// Factory to create ParameterClient.
@@ -17,6 +17,7 @@
 #ifndef SCP_CPIO_INTERFACE_PRIVATE_KEY_CLIENT_TYPE_DEF_H_
 #define SCP_CPIO_INTERFACE_PRIVATE_KEY_CLIENT_TYPE_DEF_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -64,6 +65,12 @@ struct PrivateKeyClientOptions {
   /// This list of endpoints host the remaining parts of the private key.
   std::vector<PrivateKeyVendingEndpoint>
       secondary_private_key_vending_endpoints;
+  /// How long the private keys listed by ID are cached in memory once
+  /// decrypted, in seconds. Zero, the default, disables the cache.
+  uint64_t private_key_cache_ttl_seconds = 0;
+  /// How long before its expiration a cached private key is refetched in the
+  /// background when listed, in seconds. Zero never refetches the keys.
+  uint64_t private_key_cache_refresh_ahead_seconds = 0;
 };
 }  // namespace google::scp::cpio
 
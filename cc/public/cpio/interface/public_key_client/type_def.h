@@ -17,6 +17,7 @@
 #ifndef SCP_CPIO_INTERFACE_PUBLIC_KEY_CLIENT_TYPE_DEF_H_
 #define SCP_CPIO_INTERFACE_PUBLIC_KEY_CLIENT_TYPE_DEF_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,12 @@ struct PublicKeyClientOptions {
   virtual ~PublicKeyClientOptions() = default;
   /// This list of endpoints host the public key.
   std::vector<PublicKeyVendingServiceEndpoint> endpoints;
+  /// Whether the listed public keys are cached until they expire, as told by
+  /// the cache-control header of the endpoints.
+  bool enable_public_key_cache = false;
+  /// How long before their expiration the cached public keys are refetched
+  /// in the background when listed, in seconds. Zero never refetches them.
+  uint64_t public_key_cache_refresh_ahead_seconds = 0;
 };
 
 }  // namespace google::scp::cpio
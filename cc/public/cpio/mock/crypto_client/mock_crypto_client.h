@@ -51,6 +51,12 @@ class MockCryptoClient : public CryptoClientInterface {
        Callback<cmrt::sdk::crypto_service::v1::HpkeDecryptResponse> callback),
       (noexcept, override));
 
+  MOCK_METHOD(core::ExecutionResult, BatchHpkeDecrypt,
+              (cmrt::sdk::crypto_service::v1::BatchHpkeDecryptRequest request,
+               Callback<cmrt::sdk::crypto_service::v1::BatchHpkeDecryptResponse>
+                   callback),
+              (noexcept, override));
+
   MOCK_METHOD(
       core::ExecutionResult, AeadEncrypt,
       (cmrt::sdk::crypto_service::v1::AeadEncryptRequest request,
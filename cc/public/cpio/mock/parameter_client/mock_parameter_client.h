@@ -44,6 +44,13 @@ class MockParameterClient : public ParameterClientInterface {
                Callback<cmrt::sdk::parameter_service::v1::GetParameterResponse>
                    callback),
               (noexcept, override));
+
+  MOCK_METHOD(
+      core::ExecutionResult, GetParameters,
+      (cmrt::sdk::parameter_service::v1::GetParametersRequest request,
+       Callback<cmrt::sdk::parameter_service::v1::GetParametersResponse>
+           callback),
+      (noexcept, override));
 };
 
 }  // namespace google::scp::cpio
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "core/interface/async_context.h"
 #include "public/core/interface/execution_result.h"
@@ -54,6 +55,18 @@ class ConfigurationFetcherInterface {
   virtual core::ExecutionResult GetParameterByNameAsync(
       core::AsyncContext<std::string, std::string> context) noexcept = 0;
 
+  /**
+   * @brief Fetches all the configurations known to the fetcher and the given
+   * parameters in one batch and caches them, so that the getters afterwards
+   * are served without a round trip. Parameters which do not exist are
+   * skipped; getting them later fails as usual.
+   *
+   * @param parameter_names names of additional parameters to prefetch.
+   * @return core::ExecutionResult the result of the prefetch.
+   */
+  virtual core::ExecutionResult PrefetchParameters(
+      std::vector<std::string> parameter_names) noexcept = 0;
+
   /**** Shared configurations start */
   /**
    * @brief Get SharedLogOption.
@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 
 #include <string>
+#include <vector>
 
 #include "public/core/interface/execution_result.h"
 #include "public/cpio/interface/type_def.h"
@@ -37,6 +38,9 @@ class MockConfigurationFetcher : public ConfigurationFetcherInterface {
               ((core::AsyncContext<std::string, std::string>)),
               (noexcept, override));
 
+  MOCK_METHOD(core::ExecutionResult, PrefetchParameters,
+              ((std::vector<std::string>)), (noexcept, override));
+
   MOCK_METHOD(core::ExecutionResultOr<LogOption>, GetSharedLogOption,
               ((GetConfigurationRequest)), (noexcept, override));
 
@@ -17,9 +17,13 @@
 #include "configuration_fetcher.h"
 
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "cc/core/common/uuid/src/uuid.h"
@@ -54,6 +58,8 @@ using google::cmrt::sdk::instance_service::v1::
     GetInstanceDetailsByResourceNameResponse;
 using google::cmrt::sdk::parameter_service::v1::GetParameterRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterResponse;
+using google::cmrt::sdk::parameter_service::v1::GetParametersRequest;
+using google::cmrt::sdk::parameter_service::v1::GetParametersResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::ExecutionResult;
 using google::scp::core::ExecutionResultOr;
@@ -64,10 +70,17 @@ using google::scp::core::errors::SC_CONFIGURATION_FETCHER_CONVERSION_FAILED;
 using google::scp::core::errors::
     SC_CONFIGURATION_FETCHER_ENVIRONMENT_NAME_NOT_FOUND;
 using std::bind;
+using std::function;
+using std::lock_guard;
 using std::make_shared;
 using std::move;
+using std::mutex;
+using std::optional;
+using std::pair;
+using std::promise;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 using std::placeholders::_1;
 using std::placeholders::_2;
 
@@ -77,6 +90,52 @@ constexpr char kEnvNameTag[] = "environment-name";
 }  // namespace
 
 namespace google::scp::cpio {
+namespace {
+/// The parameters behind the typed getters, prefetched by PrefetchParameters.
+constexpr const char* kKnownParameterNames[] = {
+    kSdkClientLogOption,
+    kSharedCpuThreadCount,
+    kSharedCpuThreadPoolQueueCap,
+    kSharedIoThreadCount,
+    kSharedIoThreadPoolQueueCap,
+    kJobClientJobQueueName,
+    kJobClientJobTableName,
+    kGcpJobClientSpannerInstanceName,
+    kGcpJobClientSpannerDatabaseName,
+    kGcpNoSQLDatabaseClientSpannerInstanceName,
+    kGcpNoSQLDatabaseClientSpannerDatabaseName,
+    kQueueClientQueueName,
+    kCryptoClientHpkeKem,
+    kCryptoClientHpkeKdf,
+    kCryptoClientHpkeAead,
+};
+
+/// Builds the cloud parameter name of the given parameter in the given
+/// environment.
+string GetEnvironmentParameterName(const string& environment_name,
+                                   const string& parameter_name) {
+  return absl::StrCat("scp-", environment_name, "-", parameter_name);
+}
+
+/// Calls a method of a public CPIO client and waits for its callback.
+template <typename RequestT, typename ResponseT>
+ExecutionResult CallSync(
+    const function<ExecutionResult(RequestT, Callback<ResponseT>)>& func,
+    RequestT request, ResponseT& response) noexcept {
+  promise<pair<ExecutionResult, ResponseT>> response_promise;
+  auto execution_result =
+      func(move(request),
+           [&](const ExecutionResult& result, ResponseT actual_response) {
+             response_promise.set_value({result, move(actual_response)});
+           });
+  RETURN_IF_FAILURE(execution_result);
+  auto [result, actual_response] = response_promise.get_future().get();
+  RETURN_IF_FAILURE(result);
+  response = move(actual_response);
+  return SuccessExecutionResult();
+}
+}  // namespace
+
 ExecutionResultOr<string> ConfigurationFetcher::GetParameterByName(
     string parameter_name) noexcept {
   string parameter;
@@ -94,6 +153,79 @@ ExecutionResult ConfigurationFetcher::GetParameterByNameAsync(
   return GetConfiguration(context);
 }
 
+ExecutionResult ConfigurationFetcher::PrefetchParameters(
+    vector<string> parameter_names) noexcept {
+  auto environment_name_or = GetEnvironmentName();
+  RETURN_AND_LOG_IF_FAILURE(environment_name_or.result(),
+                            kConfigurationFetcher, kZeroUuid,
+                            "Failed to get the environment name.");
+
+  parameter_names.insert(parameter_names.end(),
+                         std::begin(kKnownParameterNames),
+                         std::end(kKnownParameterNames));
+  GetParametersRequest request;
+  for (const auto& parameter_name : parameter_names) {
+    request.add_parameter_names(
+        GetEnvironmentParameterName(*environment_name_or, parameter_name));
+  }
+
+  GetParametersResponse response;
+  auto execution_result = CallSync<GetParametersRequest, GetParametersResponse>(
+      bind(&ParameterClientInterface::GetParameters, parameter_client_, _1,
+           _2),
+      move(request), response);
+  RETURN_AND_LOG_IF_FAILURE(execution_result, kConfigurationFetcher, kZeroUuid,
+                            "Failed to prefetch %zu parameters.",
+                            parameter_names.size());
+
+  lock_guard<mutex> lock(cache_mutex_);
+  for (const auto& parameter_name : parameter_names) {
+    auto it = response.parameters().find(
+        GetEnvironmentParameterName(*environment_name_or, parameter_name));
+    if (it != response.parameters().end()) {
+      parameter_cache_[parameter_name] = it->second;
+    }
+  }
+  return SuccessExecutionResult();
+}
+
+ExecutionResultOr<string> ConfigurationFetcher::GetEnvironmentName() noexcept {
+  {
+    lock_guard<mutex> lock(cache_mutex_);
+    if (environment_name_) {
+      return *environment_name_;
+    }
+  }
+
+  GetCurrentInstanceResourceNameResponse resource_name_response;
+  RETURN_IF_FAILURE((CallSync<GetCurrentInstanceResourceNameRequest,
+                              GetCurrentInstanceResourceNameResponse>(
+      bind(&InstanceClientInterface::GetCurrentInstanceResourceName,
+           instance_client_, _1, _2),
+      GetCurrentInstanceResourceNameRequest(), resource_name_response)));
+
+  GetInstanceDetailsByResourceNameRequest details_request;
+  details_request.set_instance_resource_name(
+      resource_name_response.instance_resource_name());
+  GetInstanceDetailsByResourceNameResponse details_response;
+  RETURN_IF_FAILURE((CallSync<GetInstanceDetailsByResourceNameRequest,
+                              GetInstanceDetailsByResourceNameResponse>(
+      bind(&InstanceClientInterface::GetInstanceDetailsByResourceName,
+           instance_client_, _1, _2),
+      move(details_request), details_response)));
+
+  const auto& labels = details_response.instance_details().labels();
+  auto it = labels.find(string(kEnvNameTag));
+  if (it == labels.end()) {
+    return FailureExecutionResult(
+        SC_CONFIGURATION_FETCHER_ENVIRONMENT_NAME_NOT_FOUND);
+  }
+
+  lock_guard<mutex> lock(cache_mutex_);
+  environment_name_ = it->second;
+  return it->second;
+}
+
 ExecutionResultOr<LogOption> ConfigurationFetcher::GetSharedLogOption(
     GetConfigurationRequest request) noexcept {
   LogOption parameter;
@@ -444,6 +576,32 @@ AsyncContext<string, string> ConfigurationFetcher::ContextConvertCallback(
 
 core::ExecutionResult ConfigurationFetcher::GetConfiguration(
     AsyncContext<string, string>& get_configuration_context) noexcept {
+  optional<string> parameter_value;
+  optional<string> environment_name;
+  {
+    lock_guard<mutex> lock(cache_mutex_);
+    auto it = parameter_cache_.find(*get_configuration_context.request);
+    if (it != parameter_cache_.end()) {
+      parameter_value = it->second;
+    }
+    environment_name = environment_name_;
+  }
+
+  // The context is finished outside the lock as its callback may well come
+  // back to the fetcher.
+  if (parameter_value) {
+    get_configuration_context.response =
+        make_shared<string>(move(*parameter_value));
+    get_configuration_context.result = SuccessExecutionResult();
+    get_configuration_context.Finish();
+    return SuccessExecutionResult();
+  }
+
+  if (environment_name) {
+    return GetParameterForEnvironment(*environment_name,
+                                      get_configuration_context);
+  }
+
   return instance_client_->GetCurrentInstanceResourceName(
       GetCurrentInstanceResourceNameRequest(),
       bind(&ConfigurationFetcher::GetCurrentInstanceResourceNameCallback, this,
@@ -507,12 +665,13 @@ void ConfigurationFetcher::GetInstanceDetailsByResourceNameCallback(
     return;
   }
 
-  GetParameterRequest request;
-  request.set_parameter_name(absl::StrCat("scp-", it->second, "-",
-                                          *get_configuration_context.request));
-  if (auto result = parameter_client_->GetParameter(
-          move(request), bind(&ConfigurationFetcher::GetParameterCallback, this,
-                              _1, _2, get_configuration_context));
+  {
+    lock_guard<mutex> lock(cache_mutex_);
+    environment_name_ = it->second;
+  }
+
+  if (auto result =
+          GetParameterForEnvironment(it->second, get_configuration_context);
       !result.Successful()) {
     get_configuration_context.result = result;
     SCP_ERROR_CONTEXT(kConfigurationFetcher, get_configuration_context,
@@ -523,6 +682,17 @@ void ConfigurationFetcher::GetInstanceDetailsByResourceNameCallback(
   }
 }
 
+ExecutionResult ConfigurationFetcher::GetParameterForEnvironment(
+    const string& environment_name,
+    AsyncContext<string, string>& get_configuration_context) noexcept {
+  GetParameterRequest request;
+  request.set_parameter_name(GetEnvironmentParameterName(
+      environment_name, *get_configuration_context.request));
+  return parameter_client_->GetParameter(
+      move(request), bind(&ConfigurationFetcher::GetParameterCallback, this, _1,
+                          _2, get_configuration_context));
+}
+
 void ConfigurationFetcher::GetParameterCallback(
     const ExecutionResult& result, GetParameterResponse response,
     AsyncContext<string, string>& get_configuration_context) noexcept {
@@ -536,6 +706,12 @@ void ConfigurationFetcher::GetParameterCallback(
     return;
   }
 
+  {
+    lock_guard<mutex> lock(cache_mutex_);
+    parameter_cache_[*get_configuration_context.request] =
+        response.parameter_value();
+  }
+
   get_configuration_context.result = SuccessExecutionResult();
   get_configuration_context.response =
       make_shared<string>(move(response.parameter_value()));
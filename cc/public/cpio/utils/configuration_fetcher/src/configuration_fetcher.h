@@ -19,7 +19,10 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "core/interface/async_context.h"
@@ -47,6 +50,9 @@ class ConfigurationFetcher : public ConfigurationFetcherInterface {
   core::ExecutionResult GetParameterByNameAsync(
       core::AsyncContext<std::string, std::string> context) noexcept override;
 
+  core::ExecutionResult PrefetchParameters(
+      std::vector<std::string> parameter_names) noexcept override;
+
   core::ExecutionResultOr<LogOption> GetSharedLogOption(
       GetConfigurationRequest request) noexcept override;
 
@@ -182,6 +188,17 @@ class ConfigurationFetcher : public ConfigurationFetcherInterface {
       core::AsyncContext<std::string, std::string>&
           get_configuration_context) noexcept;
 
+  /// Gets the parameter of the given context from the parameter client for
+  /// the given environment.
+  core::ExecutionResult GetParameterForEnvironment(
+      const std::string& environment_name,
+      core::AsyncContext<std::string, std::string>&
+          get_configuration_context) noexcept;
+
+  /// Gets the environment name of the current instance, from the cache if it
+  /// was resolved before.
+  core::ExecutionResultOr<std::string> GetEnvironmentName() noexcept;
+
   void GetParameterCallback(
       const core::ExecutionResult& result,
       cmrt::sdk::parameter_service::v1::GetParameterResponse response,
@@ -190,5 +207,13 @@ class ConfigurationFetcher : public ConfigurationFetcherInterface {
 
   InstanceClientInterface* instance_client_;
   ParameterClientInterface* parameter_client_;
+
+  /// Guards environment_name_ and parameter_cache_.
+  std::mutex cache_mutex_;
+  /// The environment name of the current instance, once resolved.
+  std::optional<std::string> environment_name_;
+  /// Fetched parameter values keyed by the parameter name without the
+  /// environment prefix.
+  std::unordered_map<std::string, std::string> parameter_cache_;
 };
 }  // namespace google::scp::cpio
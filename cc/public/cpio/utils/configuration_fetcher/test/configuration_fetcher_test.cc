@@ -54,6 +54,8 @@ using google::cmrt::sdk::instance_service::v1::
     GetInstanceDetailsByResourceNameResponse;
 using google::cmrt::sdk::parameter_service::v1::GetParameterRequest;
 using google::cmrt::sdk::parameter_service::v1::GetParameterResponse;
+using google::cmrt::sdk::parameter_service::v1::GetParametersRequest;
+using google::cmrt::sdk::parameter_service::v1::GetParametersResponse;
 using google::scp::core::AsyncContext;
 using google::scp::core::ExecutionResult;
 using google::scp::core::FailureExecutionResult;
@@ -715,4 +717,85 @@ TEST_F(ConfigurationFetcherTest, EnvNameNotFound) {
       fetcher_->GetJobClientJobTableNameAsync(get_job_table_context));
   WaitUntil([&]() { return finished.load(); });
 }
+
+TEST_F(ConfigurationFetcherTest, ParameterAndEnvNameAreCached) {
+  ExpectGetCurrentInstanceResourceName(SuccessExecutionResult());
+  ExpectGetInstanceDetails(SuccessExecutionResult(), env_name_tag_);
+  ExpectGetParameter(SuccessExecutionResult(), kJobClientJobTableName,
+                     kTestTable);
+  EXPECT_THAT(fetcher_->GetParameterByName(kJobClientJobTableName),
+              IsSuccessfulAndHolds(kTestTable));
+  EXPECT_THAT(fetcher_->GetParameterByName(kJobClientJobTableName),
+              IsSuccessfulAndHolds(kTestTable));
+
+  // Another parameter only needs the parameter client.
+  ExpectGetParameter(SuccessExecutionResult(), kJobClientJobQueueName,
+                     kTestQueue);
+  EXPECT_THAT(fetcher_->GetParameterByName(kJobClientJobQueueName),
+              IsSuccessfulAndHolds(kTestQueue));
+}
+
+TEST_F(ConfigurationFetcherTest, FailedParameterIsNotCached) {
+  ExpectGetCurrentInstanceResourceName(SuccessExecutionResult());
+  ExpectGetInstanceDetails(SuccessExecutionResult(), env_name_tag_);
+  auto failure = FailureExecutionResult(SC_UNKNOWN);
+  EXPECT_CALL(*mock_parameter_client_, GetParameter)
+      .WillOnce([&failure](GetParameterRequest request,
+                           Callback<GetParameterResponse> callback) {
+        callback(failure, GetParameterResponse());
+        return SuccessExecutionResult();
+      });
+  EXPECT_THAT(fetcher_->GetParameterByName(kJobClientJobTableName).result(),
+              ResultIs(failure));
+
+  ExpectGetParameter(SuccessExecutionResult(), kJobClientJobTableName,
+                     kTestTable);
+  EXPECT_THAT(fetcher_->GetParameterByName(kJobClientJobTableName),
+              IsSuccessfulAndHolds(kTestTable));
+}
+
+TEST_F(ConfigurationFetcherTest, PrefetchParametersServesGettersFromCache) {
+  ExpectGetCurrentInstanceResourceName(SuccessExecutionResult());
+  ExpectGetInstanceDetails(SuccessExecutionResult(), env_name_tag_);
+  EXPECT_CALL(*mock_parameter_client_, GetParameters)
+      .WillOnce([](GetParametersRequest request,
+                   Callback<GetParametersResponse> callback) {
+        GetParametersResponse response;
+        auto& parameters = *response.mutable_parameters();
+        parameters[absl::StrCat("scp-", kEnvName, "-", "custom")] = "value";
+        parameters[absl::StrCat("scp-", kEnvName, "-",
+                                kJobClientJobTableName)] = kTestTable;
+        parameters[absl::StrCat("scp-", kEnvName, "-",
+                                kSharedCpuThreadCount)] =
+            kTestSharedThreadCount;
+        EXPECT_GT(request.parameter_names_size(), 3);
+        callback(SuccessExecutionResult(), move(response));
+        return SuccessExecutionResult();
+      });
+  EXPECT_SUCCESS(fetcher_->PrefetchParameters({"custom"}));
+
+  EXPECT_CALL(*mock_parameter_client_, GetParameter).Times(0);
+  EXPECT_THAT(fetcher_->GetParameterByName("custom"),
+              IsSuccessfulAndHolds("value"));
+  EXPECT_THAT(fetcher_->GetJobClientJobTableName(GetConfigurationRequest()),
+              IsSuccessfulAndHolds(kTestTable));
+  EXPECT_THAT(fetcher_->GetSharedCpuThreadCount(GetConfigurationRequest()),
+              IsSuccessfulAndHolds(10));
+  testing::Mock::VerifyAndClearExpectations(mock_parameter_client_.get());
+
+  // Parameters missing from the batch are still fetched on demand.
+  ExpectGetParameter(SuccessExecutionResult(), kJobClientJobQueueName,
+                     kTestQueue);
+  EXPECT_THAT(fetcher_->GetJobClientJobQueueName(GetConfigurationRequest()),
+              IsSuccessfulAndHolds(kTestQueue));
+}
+
+TEST_F(ConfigurationFetcherTest, PrefetchParametersFailsWithoutEnvName) {
+  ExpectGetCurrentInstanceResourceName(SuccessExecutionResult());
+  ExpectGetInstanceDetails(SuccessExecutionResult(), "invalid_tag");
+  EXPECT_CALL(*mock_parameter_client_, GetParameters).Times(0);
+  EXPECT_THAT(fetcher_->PrefetchParameters({}),
+              ResultIs(FailureExecutionResult(
+                  SC_CONFIGURATION_FETCHER_ENVIRONMENT_NAME_NOT_FOUND)));
+}
 }  // namespace google::scp::cpio
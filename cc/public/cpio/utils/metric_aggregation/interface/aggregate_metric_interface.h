@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -24,6 +26,15 @@
 
 namespace google::scp::cpio {
 
+/**
+ * @brief Identifies a counter of an aggregate metric. It is resolved once from
+ * the event_code by GetEventHandle(), so that incrementing the counter needs
+ * no lookup. The default handle identifies the default counter.
+ */
+struct MetricEventHandle {
+  size_t index = 0;
+};
+
 /**
  * @brief Provides aggregate metric. It records the accumulative number
  * of event in set period, and pushes the metrics data to the cloud server.
@@ -53,5 +64,36 @@ class AggregateMetricInterface : public core::ServiceInterface {
   virtual core::ExecutionResult IncrementBy(
       uint64_t value,
       const std::string& event_code = std::string()) noexcept = 0;
+
+  /**
+   * @brief Get the handle of the metric counter of the event_code, to be
+   * incremented by Increment(MetricEventHandle) and
+   * IncrementBy(uint64_t, MetricEventHandle).
+   *
+   * @param event_code The event_code used to identify the metric counter. If no
+   * event_code provided, the handle is of the default counter.
+   * @return core::ExecutionResultOr<MetricEventHandle>
+   */
+  virtual core::ExecutionResultOr<MetricEventHandle> GetEventHandle(
+      const std::string& event_code = std::string()) noexcept = 0;
+
+  /**
+   * @brief Increment the metric counter of the handle by one.
+   *
+   * @param handle The handle from GetEventHandle().
+   * @return core::ExecutionResult
+   */
+  virtual core::ExecutionResult Increment(
+      MetricEventHandle handle) noexcept = 0;
+
+  /**
+   * @brief Increment the metric counter of the handle by a value.
+   *
+   * @param value The value by which to Increment the counter
+   * @param handle The handle from GetEventHandle().
+   * @return core::ExecutionResult
+   */
+  virtual core::ExecutionResult IncrementBy(
+      uint64_t value, MetricEventHandle handle) noexcept = 0;
 };
 }  // namespace google::scp::cpio
@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "public/core/interface/execution_result.h"
@@ -53,6 +54,30 @@ class MockAggregateMetric : public AggregateMetricInterface {
     return core::SuccessExecutionResult();
   }
 
+  core::ExecutionResultOr<MetricEventHandle> GetEventHandle(
+      const std::string& event_code) noexcept override {
+    if (event_code.empty()) {
+      return MetricEventHandle();
+    }
+    std::unique_lock lock(mutex_);
+    event_codes_.push_back(event_code);
+    return MetricEventHandle{event_codes_.size()};
+  }
+
+  core::ExecutionResult Increment(MetricEventHandle handle) noexcept override {
+    return IncrementBy(1, handle);
+  }
+
+  core::ExecutionResult IncrementBy(
+      uint64_t value, MetricEventHandle handle) noexcept override {
+    std::string event_code;
+    if (handle.index > 0) {
+      std::unique_lock lock(mutex_);
+      event_code = event_codes_[handle.index - 1];
+    }
+    return IncrementBy(value, event_code);
+  }
+
   size_t GetCounter(const std::string& event_code = std::string()) {
     if (event_code.empty() || !metric_count_map_.contains(event_code)) {
       return 0;
@@ -63,5 +88,7 @@ class MockAggregateMetric : public AggregateMetricInterface {
  private:
   std::mutex mutex_;
   absl::flat_hash_map<std::string, size_t> metric_count_map_;
+  /// The event codes of the handles, by the index of the handle minus one.
+  std::vector<std::string> event_codes_;
 };
 }  // namespace google::scp::cpio
@@ -54,20 +54,20 @@ class MockAggregateMetricOverrides : public AggregateMetric {
 
   size_t GetCounter(const std::string& event_code = std::string()) {
     if (event_code.empty()) {
-      return AggregateMetric::counter_.load();
+      return AggregateMetric::counter_.Load();
     }
 
-    auto event = AggregateMetric::event_counters_.find(event_code);
-    if (event != AggregateMetric::event_counters_.end()) {
-      return event->second.load();
+    auto event = AggregateMetric::event_indices_.find(event_code);
+    if (event != AggregateMetric::event_indices_.end()) {
+      return AggregateMetric::event_counters_[event->second].Load();
     }
     return 0;
   }
 
   std::shared_ptr<MetricTag> GetMetricTag(const std::string& event_code) {
-    auto event = AggregateMetric::event_tags_.find(event_code);
-    if (event != AggregateMetric::event_tags_.end()) {
-      return event->second;
+    auto event = AggregateMetric::event_indices_.find(event_code);
+    if (event != AggregateMetric::event_indices_.end()) {
+      return AggregateMetric::event_tags_[event->second];
     }
     return nullptr;
   }
@@ -40,6 +40,7 @@ using google::scp::core::AsyncContext;
 using google::scp::core::AsyncExecutorInterface;
 using google::scp::core::AsyncPriority;
 using google::scp::core::ExecutionResult;
+using google::scp::core::ExecutionResultOr;
 using google::scp::core::FailureExecutionResult;
 using google::scp::core::SuccessExecutionResult;
 using google::scp::core::TimeDuration;
@@ -78,7 +79,7 @@ AggregateMetric::AggregateMetric(
       metric_client_(metric_client),
       metric_info_(metric_info),
       push_interval_duration_in_ms_(push_interval_duration_in_ms),
-      counter_(0),
+      event_counters_(event_code_list ? event_code_list->size() : 0),
       is_running_(false),
       can_accept_incoming_increments_(false),
       object_activity_id_(Uuid::GenerateUuid()) {
@@ -88,8 +89,8 @@ AggregateMetric::AggregateMetric(
       labels[event_code_label_key] = event_code;
       auto tag = make_shared<MetricTag>(nullptr, nullptr,
                                         make_shared<MetricLabels>(labels));
-      event_counters_[event_code] = 0;
-      event_tags_[event_code] = tag;
+      event_indices_[event_code] = event_tags_.size();
+      event_tags_.push_back(tag);
     }
   }
 }
@@ -117,17 +118,17 @@ ExecutionResult AggregateMetric::Stop() noexcept {
   can_accept_incoming_increments_ = false;
 
   // Wait until all of the event counters are flushed.
-  while (counter_.load() > 0) {
+  while (counter_.Load() > 0) {
     SCP_DEBUG(kAggregateMetric, object_activity_id_,
               "Waiting for the counter to be flushed. Current value '%llu'",
-              counter_.load());
+              counter_.Load());
     sleep_for(kStopWaitSleepDuration);
   }
-  for (auto& [_, event_counter] : event_counters_) {
-    while (event_counter.load() > 0) {
+  for (auto& event_counter : event_counters_) {
+    while (event_counter.Load() > 0) {
       SCP_DEBUG(kAggregateMetric, object_activity_id_,
                 "Waiting for the counter to be flushed. Current value '%llu'",
-                event_counter.load());
+                event_counter.Load());
       sleep_for(kStopWaitSleepDuration);
     }
   }
@@ -154,21 +155,45 @@ ExecutionResult AggregateMetric::Increment(const string& event_code) noexcept {
 
 core::ExecutionResult AggregateMetric::IncrementBy(
     uint64_t value, const std::string& event_code) noexcept {
+  auto handle = GetEventHandle(event_code);
+  if (!handle.Successful()) {
+    return handle.result();
+  }
+  return IncrementBy(value, *handle);
+}
+
+ExecutionResultOr<MetricEventHandle> AggregateMetric::GetEventHandle(
+    const string& event_code) noexcept {
+  if (event_code.empty()) {
+    return MetricEventHandle();
+  }
+  auto event = event_indices_.find(event_code);
+  if (event == event_indices_.end()) {
+    return FailureExecutionResult(SC_CUSTOMIZED_METRIC_EVENT_CODE_NOT_EXIST);
+  }
+  return MetricEventHandle{event->second + 1};
+}
+
+ExecutionResult AggregateMetric::Increment(MetricEventHandle handle) noexcept {
+  return IncrementBy(1, handle);
+}
+
+ExecutionResult AggregateMetric::IncrementBy(
+    uint64_t value, MetricEventHandle handle) noexcept {
   if (!can_accept_incoming_increments_) {
     return FailureExecutionResult(
         core::errors::SC_CUSTOMIZED_METRIC_CANNOT_INCREMENT_WHEN_NOT_RUNNING);
   }
 
-  if (event_code.empty()) {
-    counter_ += value;
+  if (handle.index == 0) {
+    counter_.Add(value);
     return SuccessExecutionResult();
   }
 
-  auto event = event_counters_.find(event_code);
-  if (event == event_counters_.end()) {
+  if (handle.index > event_counters_.size()) {
     return FailureExecutionResult(SC_CUSTOMIZED_METRIC_EVENT_CODE_NOT_EXIST);
   }
-  event->second += value;
+  event_counters_[handle.index - 1].Add(value);
   return SuccessExecutionResult();
 }
 
@@ -211,16 +236,15 @@ void AggregateMetric::MetricPushHandler(
 }
 
 void AggregateMetric::RunMetricPush() noexcept {
-  auto value = counter_.exchange(0);
+  auto value = counter_.Exchange();
   if (value > 0) {
     MetricPushHandler(value);
   }
 
-  for (auto event = event_counters_.begin(); event != event_counters_.end();
-       ++event) {
-    auto value = event->second.exchange(0);
+  for (size_t i = 0; i < event_counters_.size(); ++i) {
+    auto value = event_counters_[i].Exchange();
     if (value > 0) {
-      MetricPushHandler(value, event_tags_[event->first]);
+      MetricPushHandler(value, event_tags_[i]);
     }
   }
   return;
@@ -17,11 +17,11 @@
 #pragma once
 
 #include <atomic>
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "core/interface/async_context.h"
 #include "core/interface/async_executor_interface.h"
 #include "cpio/client_providers/interface/metric_client_provider_interface.h"
@@ -32,6 +32,7 @@
 #include "public/cpio/utils/metric_aggregation/interface/type_def.h"
 
 #include "error_codes.h"
+#include "sharded_counter.h"
 
 // 60 seconds
 static constexpr size_t kDefaultAggregateMetricPushIntervalDurationInMs =
@@ -65,6 +66,14 @@ class AggregateMetric : public AggregateMetricInterface {
       uint64_t value,
       const std::string& event_code = std::string()) noexcept override;
 
+  core::ExecutionResultOr<MetricEventHandle> GetEventHandle(
+      const std::string& event_code = std::string()) noexcept override;
+
+  core::ExecutionResult Increment(MetricEventHandle handle) noexcept override;
+
+  core::ExecutionResult IncrementBy(uint64_t value,
+                                    MetricEventHandle handle) noexcept override;
+
  protected:
   /**
    * @brief Runs the actual metric push logic for one counter data.
@@ -92,13 +101,17 @@ class AggregateMetric : public AggregateMetricInterface {
    */
   virtual core::ExecutionResult ScheduleMetricPush() noexcept;
 
-  /// The map contains the event codes paired with its counter. The
-  /// event_counter is associated with the event_code.
-  std::map<std::string, std::atomic<size_t>> event_counters_;
+  /// The map contains the event codes paired with the index of its counter
+  /// in event_counters_ and its metric tag in event_tags_. The handle of the
+  /// event code has the index plus one, 0 being the default counter.
+  absl::flat_hash_map<std::string, size_t> event_indices_;
+
+  /// The counters of the event codes, in the order of the event_code_list.
+  std::vector<ShardedCounter> event_counters_;
 
-  /// The map contains the event codes paired with its metric tag. The metric
-  /// tag has one metric label of event_code.
-  std::map<std::string, std::shared_ptr<MetricTag>> event_tags_;
+  /// The metric tags of the event codes, in the order of the event_code_list.
+  /// The metric tag has one metric label of event_code.
+  std::vector<std::shared_ptr<MetricTag>> event_tags_;
 
   /// An instance to the async executor.
   std::shared_ptr<core::AsyncExecutorInterface> async_executor_;
@@ -115,7 +128,7 @@ class AggregateMetric : public AggregateMetricInterface {
   /// event_code or metric_tag, and it defined by metric_info_ only. When
   /// construct AggregateMetric without event_code_list, this is the only
   /// default counter in AggregateMetric.
-  std::atomic<size_t> counter_;
+  ShardedCounter counter_;
 
   /// The cancellation callback.
   std::function<bool()> current_cancellation_callback_;
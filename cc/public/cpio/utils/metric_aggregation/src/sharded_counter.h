@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace google::scp::cpio {
+/**
+ * @brief A counter striped over cache-line aligned shards. Each thread adds to
+ * the shard of its own, so that the threads incrementing the same counter do
+ * not contend on one cache line. Reading the counter sums all the shards.
+ */
+class ShardedCounter {
+ public:
+  static constexpr size_t kNumShards = 16;
+
+  ShardedCounter() = default;
+  ShardedCounter(const ShardedCounter&) = delete;
+  ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+  void Add(uint64_t value) noexcept {
+    shards_[ShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /// Returns the sum of the shards.
+  size_t Load() const noexcept {
+    size_t sum = 0;
+    for (const auto& shard : shards_) {
+      sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  /**
+   * @brief Resets the shards to 0, returning their sum. Values added
+   * concurrently are either in the sum or kept for the next call, never lost.
+   */
+  size_t Exchange() noexcept {
+    size_t sum = 0;
+    for (auto& shard : shards_) {
+      sum += shard.value.exchange(0, std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<size_t> value{0};
+  };
+
+  /// The shard of the calling thread, assigned round robin to the threads.
+  static size_t ShardIndex() noexcept {
+    static std::atomic<size_t> next_index{0};
+    thread_local size_t index =
+        next_index.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+    return index;
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+}  // namespace google::scp::cpio
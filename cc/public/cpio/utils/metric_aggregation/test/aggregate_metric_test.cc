@@ -51,6 +51,7 @@ using google::scp::core::SuccessExecutionResult;
 using google::scp::core::TimeDuration;
 using google::scp::core::Timestamp;
 using google::scp::core::async_executor::mock::MockAsyncExecutor;
+using google::scp::core::errors::SC_CUSTOMIZED_METRIC_EVENT_CODE_NOT_EXIST;
 using google::scp::core::errors::SC_CUSTOMIZED_METRIC_NOT_RUNNING;
 using google::scp::core::errors::SC_CUSTOMIZED_METRIC_PUSH_CANNOT_SCHEDULE;
 using google::scp::core::test::ResultIs;
@@ -237,6 +238,35 @@ TEST_F(AggregateMetricTest, IncrementBy) {
   }
 }
 
+TEST_F(AggregateMetricTest, IncrementByHandle) {
+  vector<string> event_list = {"QPS", "Errors"};
+  auto aggregate_metric = MockAggregateMetricOverrides(
+      async_executor_, mock_metric_client_, metric_info_,
+      aggregation_time_duration_in_ms_,
+      make_shared<vector<string>>(event_list));
+
+  auto value = 10;
+  for (const auto& code : event_list) {
+    auto handle = aggregate_metric.GetEventHandle(code);
+    ASSERT_SUCCESS(handle.result());
+    EXPECT_SUCCESS(aggregate_metric.Increment(*handle));
+    EXPECT_SUCCESS(aggregate_metric.IncrementBy(value, *handle));
+    EXPECT_EQ(aggregate_metric.GetCounter(code), value + 1);
+  }
+
+  auto default_handle = aggregate_metric.GetEventHandle();
+  ASSERT_SUCCESS(default_handle.result());
+  EXPECT_SUCCESS(aggregate_metric.IncrementBy(value, *default_handle));
+  EXPECT_EQ(aggregate_metric.GetCounter(), value);
+
+  EXPECT_THAT(aggregate_metric.GetEventHandle("Unknown").result(),
+              ResultIs(FailureExecutionResult(
+                  SC_CUSTOMIZED_METRIC_EVENT_CODE_NOT_EXIST)));
+  EXPECT_THAT(aggregate_metric.Increment(MetricEventHandle{3}),
+              ResultIs(FailureExecutionResult(
+                  SC_CUSTOMIZED_METRIC_EVENT_CODE_NOT_EXIST)));
+}
+
 TEST_F(AggregateMetricTest, IncrementByMultipleThreads) {
   vector<string> event_list = {"QPS", "Errors"};
   auto aggregate_metric = MockAggregateMetricOverrides(
@@ -103,6 +103,7 @@ module "pbs_storage" {
   pbs_cloud_storage_journal_bucket_versioning    = var.pbs_cloud_storage_journal_bucket_versioning
   pbs_spanner_instance_processing_units          = var.pbs_spanner_instance_processing_units
   pbs_spanner_database_retention_period          = var.pbs_spanner_database_retention_period
+  pbs_spanner_budget_key_retention_days          = var.pbs_spanner_budget_key_retention_days
   pbs_spanner_database_deletion_protection       = var.pbs_spanner_database_deletion_protection
 }
 
@@ -121,6 +122,7 @@ module "pbs_managed_instance_group_environment" {
   pbs_spanner_database_name             = module.pbs_storage.pbs_spanner_database_name
   pbs_spanner_budget_key_table_name     = module.pbs_storage.pbs_spanner_budget_key_table_name
   pbs_spanner_partition_lock_table_name = module.pbs_storage.pbs_spanner_partition_lock_table_name
+  pbs_spanner_budget_key_retention_days = var.pbs_spanner_budget_key_retention_days
 
   machine_type           = var.machine_type
   root_volume_size_gb    = var.root_volume_size_gb
@@ -94,6 +94,11 @@ variable "pbs_spanner_database_retention_period" {
   nullable    = false
 }
 
+variable "pbs_spanner_budget_key_retention_days" {
+  description = "Days the budget key rows are kept for. Null keeps them forever."
+  type        = number
+}
+
 variable "pbs_spanner_instance_processing_units" {
   description = "Spanner's compute capacity. 1000 processing units = 1 node and must be set as a multiple of 100."
   type        = number
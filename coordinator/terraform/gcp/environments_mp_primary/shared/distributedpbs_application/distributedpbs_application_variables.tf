@@ -111,6 +111,17 @@ variable "pbs_spanner_database_retention_period" {
   default     = "30d"
 }
 
+# When set, the budget key rows are deleted by a Spanner row deletion policy
+# this many days after the start of their timeframe's day, and PBS rejects the
+# budgets of the timeframes whose rows may be deleted. The policy is appended
+# to the database DDL, so once set this must not be changed or unset, which
+# would recreate the database.
+variable "pbs_spanner_budget_key_retention_days" {
+  description = "Days the budget key rows are kept for. Null keeps them forever."
+  type        = number
+  default     = null
+}
+
 variable "pbs_spanner_instance_processing_units" {
   description = "Spanner's compute capacity. 1000 processing units = 1 node and must be set as a multiple of 100."
   type        = number
@@ -33,6 +33,7 @@ module "distributedpbs_application" {
   pbs_auth_spanner_instance_processing_units     = var.pbs_auth_spanner_instance_processing_units
   pbs_auth_spanner_database_deletion_protection  = var.pbs_auth_spanner_database_deletion_protection
   pbs_spanner_database_retention_period          = var.pbs_spanner_database_retention_period
+  pbs_spanner_budget_key_retention_days          = var.pbs_spanner_budget_key_retention_days
   pbs_spanner_instance_processing_units          = var.pbs_spanner_instance_processing_units
   pbs_spanner_database_deletion_protection       = var.pbs_spanner_database_deletion_protection
   auth_cloud_function_handler_path               = var.auth_cloud_function_handler_path
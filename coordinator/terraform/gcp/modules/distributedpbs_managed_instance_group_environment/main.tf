@@ -154,6 +154,11 @@ locals {
       name  = "google_scp_pbs_relaxed_consistency_enabled"
       value = "true"
     },
+    ], var.pbs_spanner_budget_key_retention_days == null ? [] : [
+    {
+      name  = "google_scp_pbs_budget_key_timeframe_retention_in_days"
+      value = tostring(var.pbs_spanner_budget_key_retention_days)
+    },
   ])
 }
 
@@ -82,6 +82,11 @@ variable "pbs_spanner_partition_lock_table_name" {
   nullable    = false
 }
 
+variable "pbs_spanner_budget_key_retention_days" {
+  description = "Days the budget key rows are kept for. Null keeps them forever."
+  type        = number
+}
+
 ################################################################################
 # PBS Container Variables.
 ################################################################################
@@ -82,7 +82,7 @@ resource "google_spanner_database" "pbs_spanner_database" {
 
   # Do not remove DDL statements. You may only append.
   # Terraform apply will replace these resources otherwise.
-  ddl = [
+  ddl = concat([
     <<-EOT
     CREATE TABLE ${local.pbs_spanner_budget_key_table_name} (
       Budget_Key STRING(1024) NOT NULL,
@@ -99,5 +99,25 @@ resource "google_spanner_database" "pbs_spanner_database" {
     )
     PRIMARY KEY (LockId)
     EOT
-  ]
+    ,
+    <<-EOT
+    ALTER TABLE ${local.pbs_spanner_budget_key_table_name}
+      ADD COLUMN Token_Counts BYTES(96)
+    EOT
+    ],
+    # The Timeframe of a budget key row is its number of days since epoch.
+    # Spanner deletes the expired rows in the background, typically within
+    # three days of their expiry.
+    var.pbs_spanner_budget_key_retention_days == null ? [] : [
+      <<-EOT
+      ALTER TABLE ${local.pbs_spanner_budget_key_table_name}
+        ADD COLUMN Timeframe_Start_Time TIMESTAMP
+        AS (TIMESTAMP_SECONDS(SAFE_CAST(Timeframe AS INT64) * 86400)) STORED
+      EOT
+      ,
+      <<-EOT
+      ALTER TABLE ${local.pbs_spanner_budget_key_table_name}
+        ADD ROW DELETION POLICY (OLDER_THAN(Timeframe_Start_Time, INTERVAL ${var.pbs_spanner_budget_key_retention_days} DAY))
+      EOT
+  ])
 }
@@ -44,6 +44,19 @@ variable "pbs_spanner_database_retention_period" {
   nullable    = false
 }
 
+# The row deletion policy is appended to the database DDL, so once set this
+# must not be changed or unset, which would recreate the database.
+variable "pbs_spanner_budget_key_retention_days" {
+  description = "Days the budget key rows are kept for, from the start of their timeframe's day. Null keeps them forever."
+  type        = number
+  default     = null
+
+  validation {
+    condition     = var.pbs_spanner_budget_key_retention_days == null ? true : var.pbs_spanner_budget_key_retention_days >= 1
+    error_message = "The budget key retention must be at least one day."
+  }
+}
+
 variable "pbs_spanner_instance_processing_units" {
   description = "Spanner's compute capacity. 1000 processing units = 1 node and must be set as a multiple of 100."
   type        = number